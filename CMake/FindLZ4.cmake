@@ -0,0 +1,44 @@
+# - Try to find LZ4
+# Once done this will define
+#
+#  LZ4_FOUND - system has LZ4 (with the frame API)
+#  LZ4_INCLUDE_DIRS - the LZ4 include directory
+#  LZ4_LIBRARIES - Link these to use LZ4
+#
+
+if (LZ4_LIBRARIES AND LZ4_INCLUDE_DIRS)
+  set (LZ4_FIND_QUIETLY TRUE)
+endif ()
+
+find_path (LZ4_INCLUDE_DIRS
+    NAMES
+      lz4frame.h
+    PATHS
+      /usr/include
+      /usr/local/include
+      /opt/local/include
+      /opt/include
+      ENV CPATH)
+
+find_library (LZ4_LIBRARIES
+    NAMES
+      lz4
+    PATHS
+      /usr/lib
+      /usr/lib64
+      /usr/local/lib
+      /usr/local/lib64
+      /opt/local/lib
+      /opt/usr/lib64
+      ENV LIBRARY_PATH
+      ENV LD_LIBRARY_PATH)
+
+include (FindPackageHandleStandardArgs)
+
+# handle the QUIETLY and REQUIRED arguments and set LZ4_FOUND to TRUE if all
+# listed variables are TRUE
+FIND_PACKAGE_HANDLE_STANDARD_ARGS(LZ4 DEFAULT_MSG
+    LZ4_LIBRARIES
+    LZ4_INCLUDE_DIRS)
+
+mark_as_advanced(LZ4_INCLUDE_DIRS LZ4_LIBRARIES)
@@ -0,0 +1,44 @@
+# - Try to find zstd
+# Once done this will define
+#
+#  ZSTD_FOUND - system has zstd
+#  ZSTD_INCLUDE_DIRS - the zstd include directory
+#  ZSTD_LIBRARIES - Link these to use zstd
+#
+
+if (ZSTD_LIBRARIES AND ZSTD_INCLUDE_DIRS)
+  set (ZSTD_FIND_QUIETLY TRUE)
+endif ()
+
+find_path (ZSTD_INCLUDE_DIRS
+    NAMES
+      zstd.h
+    PATHS
+      /usr/include
+      /usr/local/include
+      /opt/local/include
+      /opt/include
+      ENV CPATH)
+
+find_library (ZSTD_LIBRARIES
+    NAMES
+      zstd
+    PATHS
+      /usr/lib
+      /usr/lib64
+      /usr/local/lib
+      /usr/local/lib64
+      /opt/local/lib
+      /opt/usr/lib64
+      ENV LIBRARY_PATH
+      ENV LD_LIBRARY_PATH)
+
+include (FindPackageHandleStandardArgs)
+
+# handle the QUIETLY and REQUIRED arguments and set ZSTD_FOUND to TRUE if all
+# listed variables are TRUE
+FIND_PACKAGE_HANDLE_STANDARD_ARGS(ZSTD DEFAULT_MSG
+    ZSTD_LIBRARIES
+    ZSTD_INCLUDE_DIRS)
+
+mark_as_advanced(ZSTD_INCLUDE_DIRS ZSTD_LIBRARIES)
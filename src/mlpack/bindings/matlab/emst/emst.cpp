@@ -8,12 +8,14 @@
 
 #include <mlpack/core.hpp>
 #include <mlpack/methods/emst/dtb.hpp>
+#include <mlpack/bindings/matlab/matlab_util.hpp>
 
 #include <iostream>
 
 using namespace mlpack;
 using namespace mlpack::emst;
 using namespace mlpack::tree;
+using namespace mlpack::bindings::matlab;
 
 // The gateway, required by all mex functions.
 void mexFunction(int nlhs, mxArray *plhs[],
@@ -33,15 +35,10 @@ void mexFunction(int nlhs, mxArray *plhs[],
   const size_t numPoints = mxGetN(prhs[0]);
   const size_t numDimensions = mxGetM(prhs[0]);
 
-  // Converting from mxArray to armadillo matrix.
-  arma::mat dataPoints(numDimensions, numPoints);
-
-  // Set the values.
-  double* mexDataPoints = mxGetPr(prhs[0]);
-  for (int i = 0, n = numPoints * numDimensions; i < n; ++i)
-  {
-    dataPoints(i) = mexDataPoints[i];
-  }
+  // The points are used in place; DualTreeBoruvka only reads them.
+  CheckMatrix(prhs[0], "dataPoints");
+  const arma::mat dataPoints(mxGetPr(prhs[0]), numDimensions, numPoints,
+      false, true);
 
   const bool isBoruvka = (mxGetScalar(prhs[1]) == 1.0);
 
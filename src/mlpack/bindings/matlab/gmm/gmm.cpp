@@ -8,10 +8,12 @@
 
 #include <mlpack/core.hpp>
 #include <mlpack/methods/gmm/gmm.hpp>
+#include <mlpack/bindings/matlab/matlab_util.hpp>
 
 using namespace mlpack;
 using namespace mlpack::gmm;
 using namespace mlpack::util;
+using namespace mlpack::bindings::matlab;
 
 void mexFunction(int nlhs, mxArray *plhs[],
                  int nrhs, const mxArray *prhs[])
@@ -34,15 +36,10 @@ void mexFunction(int nlhs, mxArray *plhs[],
   else
     math::RandomSeed((size_t) std::time(NULL));
 
-  // loading the data
-  double * mexDataPoints = mxGetPr(prhs[0]);
-  size_t numPoints = mxGetN(prhs[0]);
-  size_t numDimensions = mxGetM(prhs[0]);
-  arma::mat dataPoints(numDimensions, numPoints);
-  for (int i = 0, n = numPoints * numDimensions; i < n; ++i)
-  {
-    dataPoints(i) = mexDataPoints[i];
-  }
+  // loading the data; it is used in place, since the GMM only reads it.
+  CheckMatrix(prhs[0], "dataPoints");
+  const arma::mat dataPoints(mxGetPr(prhs[0]), mxGetM(prhs[0]),
+      mxGetN(prhs[0]), false, true);
 
   int gaussians = (int) mxGetScalar(prhs[1]);
   if (gaussians <= 0)
@@ -9,9 +9,11 @@
 #include <mlpack/core.hpp>
 #include <mlpack/methods/kmeans/kmeans.hpp>
 #include <mlpack/methods/kmeans/allow_empty_clusters.hpp>
+#include <mlpack/bindings/matlab/matlab_util.hpp>
 
 using namespace mlpack;
 using namespace mlpack::kmeans;
+using namespace mlpack::bindings::matlab;
 using namespace std;
 
 void mexFunction(int nlhs, mxArray *plhs[],
@@ -82,17 +84,12 @@ void mexFunction(int nlhs, mxArray *plhs[],
   }
   */
 
-  // Load our dataset.
+  // Load our dataset.  It is used in place, since k-means only reads it.
   const size_t numPoints = mxGetN(prhs[0]);
   const size_t numDimensions = mxGetM(prhs[0]);
-  arma::mat dataset(numDimensions, numPoints);
-
-  // setting the values.
-  double * mexDataPoints = mxGetPr(prhs[0]);
-  for (int i = 0, n = numPoints * numDimensions; i < n; ++i)
-  {
-    dataset(i) = mexDataPoints[i];
-  }
+  CheckMatrix(prhs[0], "dataPoints");
+  const arma::mat dataset(mxGetPr(prhs[0]), numDimensions, numPoints, false,
+      true);
 
   // Now create the KMeans object.  Because we could be using different types,
   // it gets a little weird...
@@ -0,0 +1,105 @@
+/**
+ * @file knn.cpp
+ *
+ * MEX function for the MATLAB k-nearest-neighbors binding, which keeps the
+ * model (and its tree) between calls.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "mex.h"
+
+#include <mlpack/core.hpp>
+#include <mlpack/methods/neighbor_search/neighbor_search.hpp>
+#include <mlpack/bindings/matlab/matlab_util.hpp>
+
+using namespace mlpack;
+using namespace mlpack::neighbor;
+using namespace mlpack::bindings::matlab;
+
+// The gateway, required by all mex functions.  It is called as
+//   handle = knn_mex('build', referencePoints)
+//   [distances, neighbors] = knn_mex('search', handle, k[, queryPoints])
+//   knn_mex('free', handle)
+void mexFunction(int nlhs, mxArray *plhs[],
+                 int nrhs, const mxArray *prhs[])
+{
+  if (nrhs < 1 || !mxIsChar(prhs[0]))
+    mexErrMsgTxt("Expecting a command: 'build', 'search' or 'free'.");
+
+  char* commandString = mxArrayToString(prhs[0]);
+  const std::string command(commandString);
+  mxFree(commandString);
+
+  if (command == "build")
+  {
+    if (nrhs != 2 || nlhs != 1)
+      mexErrMsgTxt("Expecting reference points, and one output.");
+
+    // The reference points are only read here: the model copies them once,
+    // into the order of its tree.
+    CheckMatrix(prhs[1], "referencePoints");
+    const arma::mat referenceSet(mxGetPr(prhs[1]), mxGetM(prhs[1]),
+        mxGetN(prhs[1]), false, true);
+
+    plhs[0] = mxCreateDoubleScalar(ModelHandles<KNN>::Add(
+        new KNN(referenceSet)));
+  }
+  else if (command == "search")
+  {
+    if ((nrhs != 3 && nrhs != 4) || nlhs != 2)
+      mexErrMsgTxt("Expecting a model handle, k, optional query points, and "
+          "two outputs.");
+
+    KNN& knn = ModelHandles<KNN>::Get(prhs[1]);
+    const size_t k = (size_t) mxGetScalar(prhs[2]);
+    const size_t numReferences = knn.ReferenceSet().n_cols;
+    if (k == 0 || k > numReferences - ((nrhs == 3) ? 1 : 0))
+      mexErrMsgTxt("Invalid value of k for the reference set.");
+
+    size_t numQueries = numReferences;
+    if (nrhs == 4)
+    {
+      CheckMatrix(prhs[3], "queryPoints");
+      if (mxGetM(prhs[3]) != knn.ReferenceSet().n_rows)
+        mexErrMsgTxt("The query points and the reference points must have "
+            "the same dimensionality.");
+      numQueries = mxGetN(prhs[3]);
+    }
+
+    // The distances are written directly into the output array.
+    plhs[0] = mxCreateDoubleMatrix(k, numQueries, mxREAL);
+    plhs[1] = mxCreateDoubleMatrix(k, numQueries, mxREAL);
+    arma::mat distances(mxGetPr(plhs[0]), k, numQueries, false, true);
+    arma::Mat<size_t> neighbors;
+
+    if (nrhs == 4)
+    {
+      const arma::mat querySet(mxGetPr(prhs[3]), mxGetM(prhs[3]),
+          mxGetN(prhs[3]), false, true);
+      knn.Search(querySet, k, neighbors, distances);
+    }
+    else
+    {
+      knn.Search(k, neighbors, distances);
+    }
+
+    // MATLAB indices start at 1.
+    double* out = mxGetPr(plhs[1]);
+    for (size_t i = 0; i < neighbors.n_elem; ++i)
+      out[i] = (double) neighbors[i] + 1;
+  }
+  else if (command == "free")
+  {
+    if (nrhs != 2)
+      mexErrMsgTxt("Expecting a model handle.");
+
+    ModelHandles<KNN>::Remove(prhs[1]);
+  }
+  else
+  {
+    mexErrMsgTxt("Unknown command; expecting 'build', 'search' or 'free'.");
+  }
+}
@@ -0,0 +1,40 @@
+function varargout = knn(command, varargin)
+%K-Nearest-Neighbors with a persistent model
+%
+%  This program builds a kd-tree on a set of reference points once, and then
+%  finds the k nearest neighbors of any number of sets of query points with it,
+%  without building the tree again.  The model lives in the mex file until it
+%  is freed, or until the mex file is cleared (with 'clear mex').
+%
+%  Unlike the other bindings, the points are the columns of the matrices (as
+%  in mlpack), so that they are used in place, without being transposed or
+%  copied.
+%
+%  Column j of the neighbors output holds the indices of the k nearest
+%  reference points of the query point j, and column j of the distances output
+%  holds the distances to them.
+%
+% Parameters:
+% command         - 'build', 'search' or 'free'.
+% referencePoints - ('build') the reference points, one per column.
+% model           - ('search', 'free') the model returned by 'build'.
+% k               - ('search') the number of neighbors to find.
+% queryPoints     - ('search', optional) the query points, one per column; by
+%                   default, the neighbors of the reference points are found.
+%
+% Examples:
+% model = knn('build', referencePoints);
+% [distances neighbors] = knn('search', model, 5, queryPoints);
+% [distances neighbors] = knn('search', model, 5);
+% knn('free', model);
+
+switch command
+  case 'build'
+    varargout{1} = knn_mex('build', varargin{:});
+  case 'search'
+    [varargout{1} varargout{2}] = knn_mex('search', varargin{:});
+  case 'free'
+    knn_mex('free', varargin{:});
+  otherwise
+    error('Unknown command; expecting ''build'', ''search'' or ''free''.');
+end
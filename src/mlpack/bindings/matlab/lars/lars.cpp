@@ -3,11 +3,13 @@
 #include <mlpack/core.hpp>
 
 #include <mlpack/methods/lars/lars.hpp>
+#include <mlpack/bindings/matlab/matlab_util.hpp>
 
 using namespace arma;
 using namespace std;
 using namespace mlpack;
 using namespace mlpack::regression;
+using namespace mlpack::bindings::matlab;
 
 void mexFunction(int nlhs, mxArray *plhs[],
                  int nrhs, const mxArray *prhs[])
@@ -27,32 +29,29 @@ void mexFunction(int nlhs, mxArray *plhs[],
   double lambda2 = mxGetScalar(prhs[3]);
   bool useCholesky = (mxGetScalar(prhs[3]) == 1.0);
 
-  // loading covariates
-  mat matX(mxGetM(prhs[0]), mxGetN(prhs[0]));
-  double * values = mxGetPr(prhs[0]);
-  for (int i=0, num=mxGetNumberOfElements(prhs[0]); i<num; ++i)
-    matX(i) = values[i];
+  // loading covariates and responses; LARS only reads them, so they are used
+  // in place
+  CheckMatrix(prhs[0], "X");
+  CheckMatrix(prhs[1], "y");
+  const mat matX(mxGetPr(prhs[0]), mxGetM(prhs[0]), mxGetN(prhs[0]), false,
+      true);
 
-  // loading responses
-  mat matY(mxGetM(prhs[1]), mxGetN(prhs[1]));
-  values = mxGetPr(prhs[1]);
-  for (int i=0, num=mxGetNumberOfElements(prhs[1]); i<num; ++i)
-    matY(i) = values[i];
-
-  if (matY.n_cols > 1)
+  if (mxGetN(prhs[1]) > 1)
     mexErrMsgTxt("Only one column or row allowed in responses file!");
 
+  const vec matY(mxGetPr(prhs[1]), mxGetM(prhs[1]), false, true);
+
   if (matY.n_elem != matX.n_rows)
     mexErrMsgTxt("Number of responses must be equal to number of rows of X!");
 
   // Do LARS.
   LARS lars(useCholesky, lambda1, lambda2);
   vec beta;
-  lars.Regress(matX, matY.unsafe_col(0), beta, false /* do not transpose */);
+  lars.Regress(matX, matY, beta, false /* do not transpose */);
 
   // return to matlab
   plhs[0] = mxCreateDoubleMatrix(beta.n_elem, 1, mxREAL);
-  values = mxGetPr(plhs[0]);
+  double* values = mxGetPr(plhs[0]);
   for (int i = 0; i < beta.n_elem; ++i)
     values[i] = beta(i);
 }
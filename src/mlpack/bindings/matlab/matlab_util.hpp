@@ -0,0 +1,141 @@
+/**
+ * @file matlab_util.hpp
+ *
+ * Utilities for the MATLAB bindings: checks for the input arrays that are used
+ * in place, and handles to models that are kept between calls of a mex
+ * function.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_BINDINGS_MATLAB_MATLAB_UTIL_HPP
+#define MLPACK_BINDINGS_MATLAB_MATLAB_UTIL_HPP
+
+#include "mex.h"
+
+#include <mlpack/core.hpp>
+
+#include <map>
+#include <memory>
+
+namespace mlpack {
+namespace bindings {
+namespace matlab {
+
+/**
+ * Check that the given input array is a real, dense matrix of doubles, and
+ * raise a MATLAB error otherwise.  MATLAB stores such a matrix in column-major
+ * order, like Armadillo, so it can be used in place, without a copy:
+ *
+ * @code
+ * CheckMatrix(prhs[0], "dataPoints");
+ * const arma::mat data(mxGetPr(prhs[0]), mxGetM(prhs[0]), mxGetN(prhs[0]),
+ *     false, true);
+ * @endcode
+ *
+ * The input arrays of a mex function must never be modified, so such a matrix
+ * must be const, and only be given to functions that read it or copy it.
+ *
+ * @param array Input array to check.
+ * @param name Name of the input, for the error message.
+ */
+inline void CheckMatrix(const mxArray* array, const char* name)
+{
+  if (!mxIsDouble(array) || mxIsComplex(array) || mxIsSparse(array) ||
+      mxGetNumberOfDimensions(array) != 2)
+  {
+    std::ostringstream error;
+    error << name << " must be a real, dense matrix of doubles.";
+    mexErrMsgTxt(error.str().c_str());
+  }
+}
+
+/**
+ * ModelHandles keeps models alive between calls of a mex function, so that a
+ * model (such as a tree built on a reference set) is built once and used by
+ * many calls.  A model is stored with Add(), which returns a handle (a positive
+ * integer, given to MATLAB as a double), and is found again from its handle
+ * with Get().  A model is deleted by Remove(), or when the mex function is
+ * cleared from memory (then its handles are no longer valid).
+ *
+ * @tparam ModelType Type of the stored models.
+ */
+template<typename ModelType>
+class ModelHandles
+{
+ public:
+  //! Store the given model (which is then owned by ModelHandles), and return
+  //! its handle.
+  static double Add(ModelType* model)
+  {
+    // The models must be deleted before the mex function is unloaded.
+    static bool registered = false;
+    if (!registered)
+    {
+      mexAtExit(&ModelHandles::Clear);
+      registered = true;
+    }
+
+    const size_t handle = ++NextHandle();
+    Models()[handle].reset(model);
+    return (double) handle;
+  }
+
+  //! Get the model of the given handle, or raise a MATLAB error if there is
+  //! no such model.
+  static ModelType& Get(const mxArray* handle)
+  {
+    typename ModelMap::iterator it = Models().find(Handle(handle));
+    if (it == Models().end())
+      mexErrMsgTxt("Invalid model handle (the model was freed or cleared).");
+
+    return *it->second;
+  }
+
+  //! Delete the model of the given handle.
+  static void Remove(const mxArray* handle)
+  {
+    if (Models().erase(Handle(handle)) == 0)
+      mexErrMsgTxt("Invalid model handle (the model was freed or cleared).");
+  }
+
+  //! Delete all the models.
+  static void Clear() { Models().clear(); }
+
+  //! Get the number of stored models.
+  static size_t Size() { return Models().size(); }
+
+ private:
+  typedef std::map<size_t, std::unique_ptr<ModelType>> ModelMap;
+
+  //! Get the handle stored in the given array.
+  static size_t Handle(const mxArray* handle)
+  {
+    if (!mxIsDouble(handle) || mxGetNumberOfElements(handle) != 1)
+      mexErrMsgTxt("A model handle must be a scalar.");
+
+    return (size_t) mxGetScalar(handle);
+  }
+
+  //! The stored models.
+  static ModelMap& Models()
+  {
+    static ModelMap models;
+    return models;
+  }
+
+  //! The last handle given.
+  static size_t& NextHandle()
+  {
+    static size_t handle = 0;
+    return handle;
+  }
+};
+
+} // namespace matlab
+} // namespace bindings
+} // namespace mlpack
+
+#endif
@@ -40,6 +40,7 @@ void Mat<eT>::serialize(Archive& ar, const unsigned int /* version */)
     init_cold();
   }
 
+  mlpack::data::ArchiveAlignment<Archive>::Align(ar);
   ar & make_array(access::rwp(mem), n_elem);
 }
 
@@ -49,6 +49,34 @@
 #include <boost/serialization/nvp.hpp>
 #include <boost/serialization/array.hpp>
 
+namespace mlpack {
+namespace data {
+
+/**
+ * ArchiveAlignment<Archive>::Align() is called by Mat::serialize() just before
+ * the elements of the matrix.  It does nothing, except for the native binary
+ * archive (see core/data/native_archive.hpp), which pads the stream so that
+ * the elements start at an aligned offset.
+ */
+template<typename Archive>
+struct ArchiveAlignment
+{
+  static void Align(Archive& /* ar */) { }
+};
+
+} // namespace data
+} // namespace mlpack
+
+// If the allocations are tracked or the arena allocator is used, Armadillo
+// allocates its memory through the counters of the program timers, which take
+// large blocks from the arena (see ArenaAllocator).
+#if defined(MLPACK_TRACK_ALLOCATIONS) || defined(MLPACK_ARENA_ALLOCATOR)
+  #include <mlpack/core/util/allocation_counters.hpp>
+
+  #define ARMA_ALIEN_MEM_ALLOC_FUNCTION mlpack::AllocationCounters::Allocate
+  #define ARMA_ALIEN_MEM_FREE_FUNCTION mlpack::AllocationCounters::Free
+#endif
+
 #include <armadillo>
 
 namespace arma {
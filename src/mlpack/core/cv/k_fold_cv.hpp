@@ -0,0 +1,221 @@
+/**
+ * @file k_fold_cv.hpp
+ *
+ * The k-fold cross-validation executor, with grid search and successive
+ * halving over the configurations of a learner.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_CV_K_FOLD_CV_HPP
+#define MLPACK_CORE_CV_K_FOLD_CV_HPP
+
+#include <mlpack/core.hpp>
+
+namespace mlpack {
+namespace cv {
+
+/**
+ * KFoldCV splits a dataset into k folds, and trains and evaluates a learner on
+ * each of them: the model is trained on the k - 1 other folds and evaluated on
+ * the fold with the given metric (such as Accuracy or MSE).  GridSearch() does
+ * this for each configuration of a list, and SuccessiveHalving() drops the
+ * worst configurations after evaluating them on a few folds only.
+ *
+ * The points are shuffled once, and stored once along with a copy of the first
+ * k - 2 folds, so that both the validation set and the training set of every
+ * fold are contiguous columns.  They are passed to the learner as matrices
+ * that alias that storage, so no fold is ever copied, and all the threads
+ * share the same data.  The (configuration, fold) pairs are run in parallel
+ * when OpenMP is available, each from a copy of the given model and with its
+ * own random stream (see math::TaskRandomStreamScope()), so the scores don't
+ * depend on the number of threads.
+ *
+ * A learner is given as a trainer: a function (or function object) that
+ * trains the given model with the given configuration, and that may be called
+ * from several threads at once.
+ *
+ * @code
+ * KFoldCV<> cv(10, data, labels);
+ *
+ * std::vector<double> lambdas = { 10.0, 1.0, 0.1, 0.01 };
+ * auto train = [](LogisticRegression<>& model, const double& lambda,
+ *     const arma::mat& data, const arma::Row<size_t>& labels)
+ * {
+ *   model.Lambda() = lambda;
+ *   model.Train(data, labels);
+ * };
+ *
+ * arma::vec scores;
+ * const size_t best = cv.GridSearch<Accuracy>(
+ *     LogisticRegression<>(data.n_rows), lambdas, train, scores, true);
+ * @endcode
+ *
+ * With warmStart set, the configurations are visited in order on each fold
+ * with the same model, so a learner whose training starts from the current
+ * model (such as LogisticRegression along a decreasing lambda path) converges
+ * in fewer iterations.
+ *
+ * @tparam MatType The type of data matrix; it must be dense.
+ * @tparam ResponsesType The type of the labels or responses (a row vector).
+ */
+template<typename MatType = arma::mat,
+         typename ResponsesType = arma::Row<size_t>>
+class KFoldCV
+{
+ public:
+  /**
+   * Split the given dataset into k folds.  The data and the responses are
+   * copied (once).
+   *
+   * @param k Number of folds (at least 2).
+   * @param xs The data points, one per column.
+   * @param ys The labels or responses of the points.
+   * @param shuffle Whether to shuffle the points before splitting them.
+   */
+  KFoldCV(const size_t k,
+          const MatType& xs,
+          const ResponsesType& ys,
+          const bool shuffle = true);
+
+  /**
+   * Train the given model on each fold with the given trainer, and return the
+   * mean of the metric over the folds.  The trainer is called as
+   * train(model, data, responses).
+   *
+   * @tparam MetricType Metric to evaluate the models with.
+   * @param model Model to train a copy of on each fold.
+   * @param train Trainer.
+   */
+  template<typename MetricType, typename ModelType, typename TrainerType>
+  double Evaluate(const ModelType& model, TrainerType train);
+
+  /**
+   * Evaluate each configuration of the given grid on every fold, and return
+   * the index of the best one.  The trainer is called as
+   * train(model, configuration, data, responses).
+   *
+   * @tparam MetricType Metric to evaluate the models with.
+   * @param model Model to train copies of.
+   * @param grid Configurations to evaluate.
+   * @param train Trainer.
+   * @param scores Mean of the metric over the folds, for each configuration.
+   * @param warmStart If true, each fold trains one model through all the
+   *     configurations in order; otherwise, each configuration starts from a
+   *     copy of the given model.
+   */
+  template<typename MetricType,
+           typename ModelType,
+           typename ParametersType,
+           typename TrainerType>
+  size_t GridSearch(const ModelType& model,
+                    const std::vector<ParametersType>& grid,
+                    TrainerType train,
+                    arma::vec& scores,
+                    const bool warmStart = false);
+
+  /**
+   * Evaluate the configurations of the given grid with successive halving:
+   * all of them are evaluated on the first fold, then the best 1 / eta of them
+   * on eta times as many folds, and so on, until one is left (and evaluated on
+   * all the folds) or all the folds have been used.  Then the index of the
+   * best configuration is returned.  So bad configurations are dropped after a
+   * few trainings, and only the good ones are evaluated on all the folds.
+   *
+   * @tparam MetricType Metric to evaluate the models with.
+   * @param model Model to train copies of.
+   * @param grid Configurations to evaluate.
+   * @param train Trainer, called as train(model, configuration, data,
+   *     responses).
+   * @param scores Mean of the metric over the folds each configuration was
+   *     evaluated on.
+   * @param eta Reduction factor of each round (at least 2).
+   */
+  template<typename MetricType,
+           typename ModelType,
+           typename ParametersType,
+           typename TrainerType>
+  size_t SuccessiveHalving(const ModelType& model,
+                           const std::vector<ParametersType>& grid,
+                           TrainerType train,
+                           arma::vec& scores,
+                           const size_t eta = 3);
+
+  //! Get the number of folds.
+  size_t K() const { return k; }
+  //! Get the number of points.
+  size_t NumPoints() const { return numPoints; }
+  //! Get the number of trainings run so far.
+  size_t Trainings() const { return trainings; }
+
+ private:
+  //! A configuration and a fold to evaluate it on.
+  typedef std::pair<size_t, size_t> Task;
+
+  /**
+   * Run the given tasks in parallel, each on a copy of the given model, and
+   * store the score of each in foldScores(configuration, fold).  Exceptions
+   * thrown by the trainer or the metric are rethrown afterwards.
+   */
+  template<typename MetricType,
+           typename ModelType,
+           typename ParametersType,
+           typename TrainerType>
+  void RunTasks(const ModelType& model,
+                const std::vector<ParametersType>& grid,
+                TrainerType& train,
+                const std::vector<Task>& tasks,
+                arma::mat& foldScores);
+
+  //! Train the given model on the training set of the given fold, and
+  //! evaluate it on its validation set.
+  template<typename MetricType,
+           typename ModelType,
+           typename ParametersType,
+           typename TrainerType>
+  double Run(ModelType& model,
+             const ParametersType& parameters,
+             TrainerType& train,
+             const size_t fold) const;
+
+  //! Return the index of the best of the given scores (the first, on ties),
+  //! ignoring NaN scores.
+  template<typename MetricType>
+  static size_t Best(const arma::vec& scores);
+
+  //! Get the first column of the validation set of the given fold.
+  size_t ValidationBegin(const size_t fold) const { return fold * binSize; }
+  //! Get the size of the validation set of the given fold; the last fold
+  //! also holds the remaining points.
+  size_t ValidationSize(const size_t fold) const
+  { return (fold == k - 1) ? numPoints - (k - 1) * binSize : binSize; }
+  //! Get the first column of the training set of the given fold.
+  size_t TrainingBegin(const size_t fold) const
+  { return (fold == k - 1) ? 0 : (fold + 1) * binSize; }
+  //! Get the size of the training set of the given fold.
+  size_t TrainingSize(const size_t fold) const
+  { return numPoints - ValidationSize(fold); }
+
+  //! Number of folds.
+  size_t k;
+  //! Number of points.
+  size_t numPoints;
+  //! Number of points of each fold but the last.
+  size_t binSize;
+  //! The shuffled points, followed by the first k - 2 folds.
+  MatType xs;
+  //! The shuffled responses, followed by those of the first k - 2 folds.
+  ResponsesType ys;
+  //! Number of trainings run so far.
+  size_t trainings;
+};
+
+} // namespace cv
+} // namespace mlpack
+
+// Include implementation.
+#include "k_fold_cv_impl.hpp"
+
+#endif
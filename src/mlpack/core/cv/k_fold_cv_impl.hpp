@@ -0,0 +1,344 @@
+/**
+ * @file k_fold_cv_impl.hpp
+ *
+ * Implementation of the KFoldCV class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_CV_K_FOLD_CV_IMPL_HPP
+#define MLPACK_CORE_CV_K_FOLD_CV_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "k_fold_cv.hpp"
+
+#include <exception>
+
+namespace mlpack {
+namespace cv {
+
+template<typename MatType, typename ResponsesType>
+KFoldCV<MatType, ResponsesType>::KFoldCV(const size_t k,
+                                         const MatType& xs,
+                                         const ResponsesType& ys,
+                                         const bool shuffle) :
+    k(k),
+    numPoints(xs.n_cols),
+    binSize(0),
+    trainings(0)
+{
+  if (k < 2)
+  {
+    throw std::invalid_argument("KFoldCV::KFoldCV(): the number of folds must "
+        "be at least 2");
+  }
+
+  if (xs.n_cols != ys.n_elem)
+  {
+    std::ostringstream error;
+    error << "KFoldCV::KFoldCV(): number of points (" << xs.n_cols << ") "
+        << "does not match number of responses (" << ys.n_elem << ")";
+    throw std::invalid_argument(error.str());
+  }
+
+  if (xs.n_cols < k)
+  {
+    std::ostringstream error;
+    error << "KFoldCV::KFoldCV(): the number of points (" << xs.n_cols << ") "
+        << "must be at least the number of folds (" << k << ")";
+    throw std::invalid_argument(error.str());
+  }
+
+  binSize = numPoints / k;
+
+  // The training set of a fold (but the last) starts after its validation set
+  // and wraps around to the first folds, so these are copied after the points.
+  const size_t total = numPoints + (k - 2) * binSize;
+  arma::uvec order = shuffle ?
+      arma::shuffle(arma::linspace<arma::uvec>(0, numPoints - 1, numPoints)) :
+      arma::linspace<arma::uvec>(0, numPoints - 1, numPoints);
+  if (total > numPoints)
+    order = arma::join_cols(order, order.subvec(0, total - numPoints - 1));
+
+  this->xs = xs.cols(order);
+  this->ys = ys.cols(order);
+}
+
+template<typename MatType, typename ResponsesType>
+template<typename MetricType, typename ModelType, typename TrainerType>
+double KFoldCV<MatType, ResponsesType>::Evaluate(const ModelType& model,
+                                                 TrainerType train)
+{
+  // This is a grid search over a single configuration, which has no
+  // parameters.
+  const std::vector<size_t> grid(1);
+  auto trainer = [&train](ModelType& taskModel, const size_t /* parameters */,
+      const MatType& data, const ResponsesType& responses)
+  {
+    train(taskModel, data, responses);
+  };
+
+  arma::vec scores;
+  GridSearch<MetricType>(model, grid, trainer, scores);
+  return scores[0];
+}
+
+template<typename MatType, typename ResponsesType>
+template<typename MetricType,
+         typename ModelType,
+         typename ParametersType,
+         typename TrainerType>
+size_t KFoldCV<MatType, ResponsesType>::GridSearch(
+    const ModelType& model,
+    const std::vector<ParametersType>& grid,
+    TrainerType train,
+    arma::vec& scores,
+    const bool warmStart)
+{
+  if (grid.empty())
+  {
+    throw std::invalid_argument("KFoldCV::GridSearch(): the grid must not be "
+        "empty");
+  }
+
+  arma::mat foldScores(grid.size(), k);
+  if (warmStart)
+  {
+    // The configurations of a fold must be trained in order, so only the
+    // folds run in parallel.
+    std::vector<std::exception_ptr> errors(k);
+
+#ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables. If we're building for Visual Studio,
+    // use the intmax_t type instead.
+    #pragma omp parallel for schedule(dynamic)
+    for (intmax_t fold = 0; fold < (intmax_t) k; ++fold)
+#else
+    #pragma omp parallel for schedule(dynamic)
+    for (size_t fold = 0; fold < k; ++fold)
+#endif
+    {
+      try
+      {
+        math::TaskRandomStreamScope scope(fold);
+        ModelType foldModel(model);
+        for (size_t c = 0; c < grid.size(); ++c)
+        {
+          foldScores(c, fold) = Run<MetricType>(foldModel, grid[c], train,
+              fold);
+        }
+      }
+      catch (...)
+      {
+        errors[fold] = std::current_exception();
+      }
+    }
+
+    for (size_t fold = 0; fold < k; ++fold)
+      if (errors[fold])
+        std::rethrow_exception(errors[fold]);
+
+    trainings += grid.size() * k;
+  }
+  else
+  {
+    std::vector<Task> tasks;
+    for (size_t c = 0; c < grid.size(); ++c)
+      for (size_t fold = 0; fold < k; ++fold)
+        tasks.push_back(Task(c, fold));
+
+    RunTasks<MetricType>(model, grid, train, tasks, foldScores);
+  }
+
+  scores = arma::mean(foldScores, 1);
+  return Best<MetricType>(scores);
+}
+
+template<typename MatType, typename ResponsesType>
+template<typename MetricType,
+         typename ModelType,
+         typename ParametersType,
+         typename TrainerType>
+size_t KFoldCV<MatType, ResponsesType>::SuccessiveHalving(
+    const ModelType& model,
+    const std::vector<ParametersType>& grid,
+    TrainerType train,
+    arma::vec& scores,
+    const size_t eta)
+{
+  if (grid.empty())
+  {
+    throw std::invalid_argument("KFoldCV::SuccessiveHalving(): the grid must "
+        "not be empty");
+  }
+
+  if (eta < 2)
+  {
+    throw std::invalid_argument("KFoldCV::SuccessiveHalving(): eta must be at "
+        "least 2");
+  }
+
+  arma::mat foldScores(grid.size(), k);
+  scores.set_size(grid.size());
+
+  // The configurations still in the race, and the number of folds each of
+  // them has been evaluated on.
+  std::vector<size_t> survivors(grid.size());
+  for (size_t c = 0; c < grid.size(); ++c)
+    survivors[c] = c;
+  size_t folds = 0;
+  size_t newFolds = 1;
+
+  while (true)
+  {
+    // Evaluate the survivors on the next folds only.
+    const size_t end = std::min(k, folds + newFolds);
+    std::vector<Task> tasks;
+    for (size_t s = 0; s < survivors.size(); ++s)
+      for (size_t fold = folds; fold < end; ++fold)
+        tasks.push_back(Task(survivors[s], fold));
+    RunTasks<MetricType>(model, grid, train, tasks, foldScores);
+
+    newFolds = end * (eta - 1);
+    folds = end;
+    for (size_t s = 0; s < survivors.size(); ++s)
+    {
+      scores[survivors[s]] = arma::accu(foldScores(survivors[s],
+          arma::span(0, folds - 1))) / folds;
+    }
+
+    Log::Info << "KFoldCV::SuccessiveHalving(): evaluated "
+        << survivors.size() << " configurations on " << folds << " folds."
+        << std::endl;
+
+    if (folds == k)
+      break;
+
+    // Keep the best 1 / eta of the survivors; ties keep the earlier ones.  The
+    // last one is evaluated on all the remaining folds.
+    const size_t keep = std::max((size_t) 1, survivors.size() / eta);
+    const bool minimize = MetricType::NeedsMinimization;
+    std::stable_sort(survivors.begin(), survivors.end(),
+        [&scores, minimize](const size_t a, const size_t b)
+        {
+          // NaN scores (from diverged models) go last.
+          if (std::isnan(scores[a]) || std::isnan(scores[b]))
+            return !std::isnan(scores[a]) && std::isnan(scores[b]);
+          return minimize ? (scores[a] < scores[b]) : (scores[a] > scores[b]);
+        });
+    survivors.resize(keep);
+    std::sort(survivors.begin(), survivors.end());
+    if (survivors.size() == 1)
+      newFolds = k - folds;
+  }
+
+  // The survivors were evaluated on the most folds.
+  arma::vec survivorScores(survivors.size());
+  for (size_t s = 0; s < survivors.size(); ++s)
+    survivorScores[s] = scores[survivors[s]];
+  return survivors[Best<MetricType>(survivorScores)];
+}
+
+template<typename MatType, typename ResponsesType>
+template<typename MetricType,
+         typename ModelType,
+         typename ParametersType,
+         typename TrainerType>
+void KFoldCV<MatType, ResponsesType>::RunTasks(
+    const ModelType& model,
+    const std::vector<ParametersType>& grid,
+    TrainerType& train,
+    const std::vector<Task>& tasks,
+    arma::mat& foldScores)
+{
+  // Exceptions can't leave the parallel loop, so they are kept and rethrown
+  // afterwards.
+  std::vector<std::exception_ptr> errors(tasks.size());
+
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables. If we're building for Visual Studio, use
+  // the intmax_t type instead.
+  #pragma omp parallel for schedule(dynamic)
+  for (intmax_t t = 0; t < (intmax_t) tasks.size(); ++t)
+#else
+  #pragma omp parallel for schedule(dynamic)
+  for (size_t t = 0; t < tasks.size(); ++t)
+#endif
+  {
+    const size_t configuration = tasks[t].first;
+    const size_t fold = tasks[t].second;
+    try
+    {
+      math::TaskRandomStreamScope scope(configuration * k + fold);
+      ModelType taskModel(model);
+      foldScores(configuration, fold) = Run<MetricType>(taskModel,
+          grid[configuration], train, fold);
+    }
+    catch (...)
+    {
+      errors[t] = std::current_exception();
+    }
+  }
+
+  for (size_t t = 0; t < tasks.size(); ++t)
+    if (errors[t])
+      std::rethrow_exception(errors[t]);
+
+  trainings += tasks.size();
+}
+
+template<typename MatType, typename ResponsesType>
+template<typename MetricType,
+         typename ModelType,
+         typename ParametersType,
+         typename TrainerType>
+double KFoldCV<MatType, ResponsesType>::Run(
+    ModelType& model,
+    const ParametersType& parameters,
+    TrainerType& train,
+    const size_t fold) const
+{
+  typedef typename MatType::elem_type DataElemType;
+  typedef typename ResponsesType::elem_type ResponsesElemType;
+
+  // These matrices alias the shared storage; they are never modified.
+  const MatType trainingData(const_cast<DataElemType*>(xs.colptr(
+      TrainingBegin(fold))), xs.n_rows, TrainingSize(fold), false, true);
+  const ResponsesType trainingResponses(const_cast<ResponsesElemType*>(
+      ys.memptr() + TrainingBegin(fold)), TrainingSize(fold), false, true);
+  const MatType validationData(const_cast<DataElemType*>(xs.colptr(
+      ValidationBegin(fold))), xs.n_rows, ValidationSize(fold), false, true);
+  const ResponsesType validationResponses(const_cast<ResponsesElemType*>(
+      ys.memptr() + ValidationBegin(fold)), ValidationSize(fold), false, true);
+
+  train(model, parameters, trainingData, trainingResponses);
+  return MetricType::Evaluate(model, validationData, validationResponses);
+}
+
+template<typename MatType, typename ResponsesType>
+template<typename MetricType>
+size_t KFoldCV<MatType, ResponsesType>::Best(const arma::vec& scores)
+{
+  size_t best = scores.n_elem;
+  for (size_t c = 0; c < scores.n_elem; ++c)
+  {
+    if (std::isnan(scores[c]))
+      continue;
+
+    if (best == scores.n_elem ||
+        (MetricType::NeedsMinimization && scores[c] < scores[best]) ||
+        (!MetricType::NeedsMinimization && scores[c] > scores[best]))
+      best = c;
+  }
+
+  return (best == scores.n_elem) ? 0 : best;
+}
+
+} // namespace cv
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,312 @@
+/**
+ * @file arff_parser.cpp
+ *
+ * Implementation of the non-templated parts of ARFFParser.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "arff_parser.hpp"
+#include "csv_parser.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+
+using namespace mlpack;
+using namespace mlpack::data;
+
+ARFFParser::ARFFParser(const std::string& filename, const size_t numChunks) :
+    file(filename),
+    dataBegin(NULL),
+    numPoints(0),
+    sparse(false)
+{
+  ParseHeader();
+
+  const char* end = file.Memory() + file.Size();
+  const size_t size = end - dataBegin;
+
+  size_t n = numChunks;
+  if (n == 0)
+  {
+#ifdef HAS_OPENMP
+    const size_t threads = omp_get_max_threads();
+#else
+    const size_t threads = 1;
+#endif
+    n = std::max((size_t) 1, std::min(4 * threads, size / (1 << 20)));
+  }
+
+  // Each chunk (but the first) starts after the first newline at or after its
+  // share of the @data section, so that every chunk holds whole lines.
+  chunks.resize(n);
+  const char* previous = dataBegin;
+  for (size_t c = 0; c < n; ++c)
+  {
+    chunks[c].begin = previous;
+    if (c + 1 == n)
+    {
+      chunks[c].end = end;
+    }
+    else
+    {
+      const size_t share = std::max((size_t) 1, (c + 1) * size / n);
+      const char* newline = static_cast<const char*>(
+          std::memchr(dataBegin + share - 1, '\n', size - share + 1));
+      chunks[c].end = std::max(previous, (newline == NULL) ? end :
+          newline + 1);
+    }
+    previous = chunks[c].end;
+  }
+
+  // Count the instances of each chunk, and look for sparse ones.
+  std::vector<char> sparseChunks(n, 0);
+  ForEachChunk([&](Chunk& chunk, const size_t index)
+  {
+    chunk.numPoints = 0;
+    ForEachLine(chunk, [&](const size_t, const char* lineBegin, const char*)
+    {
+      ++chunk.numPoints;
+      if (*lineBegin == '{')
+        sparseChunks[index] = 1;
+    });
+  });
+
+  for (size_t c = 0; c < n; ++c)
+  {
+    chunks[c].firstPoint = numPoints;
+    numPoints += chunks[c].numPoints;
+    sparse |= (sparseChunks[c] != 0);
+  }
+}
+
+void ARFFParser::ParseHeader()
+{
+  const char* position = file.Memory();
+  const char* end = position + file.Size();
+  while (position < end)
+  {
+    const char* lineBegin;
+    const char* lineEnd;
+    position = NextLine(position, end, lineBegin, lineEnd);
+
+    // Only the @relation, @attribute and @data lines matter.
+    if (lineBegin == lineEnd || *lineBegin != '@')
+      continue;
+
+    const char* keywordEnd = lineBegin;
+    while (keywordEnd < lineEnd && !std::isspace((unsigned char) *keywordEnd) &&
+           *keywordEnd != '%')
+      ++keywordEnd;
+
+    std::string keyword(lineBegin, keywordEnd);
+    std::transform(keyword.begin(), keyword.end(), keyword.begin(), ::tolower);
+
+    if (keyword == "@relation")
+    {
+      // We don't have anything to do with the name of the dataset.
+      continue;
+    }
+    else if (keyword == "@attribute")
+    {
+      ParseAttribute(keywordEnd, lineEnd);
+    }
+    else if (keyword == "@data")
+    {
+      dataBegin = position;
+      return;
+    }
+    else
+    {
+      throw std::runtime_error("unknown ARFF annotation '" +
+          std::string(lineBegin, keywordEnd) + "' in '" + file.Filename() +
+          "'");
+    }
+  }
+
+  throw std::runtime_error("no @data section found in '" + file.Filename() +
+      "'");
+}
+
+void ARFFParser::ParseAttribute(const char* begin, const char* end)
+{
+  const char* p = begin;
+  while (p < end && std::isspace((unsigned char) *p))
+    ++p;
+
+  // The name is quoted, or runs to the next whitespace.
+  const char* nameBegin = p;
+  if (p < end && (*p == '\'' || *p == '"'))
+  {
+    const char quote = *p;
+    for (++p; p < end && *p != quote; ++p)
+      if (*p == '\\' && p + 1 < end)
+        ++p;
+
+    if (p == end)
+      LineError(begin, "Unterminated attribute name");
+    ++p;
+  }
+  else
+  {
+    while (p < end && !std::isspace((unsigned char) *p))
+      ++p;
+  }
+
+  const char* nameEnd = p;
+  if (nameBegin == nameEnd)
+    LineError(begin, "Missing attribute name");
+
+  Attribute attribute;
+  attribute.name = Unquote(nameBegin, nameEnd) ?
+      Unescape(nameBegin, nameEnd) : std::string(nameBegin, nameEnd);
+
+  while (p < end && std::isspace((unsigned char) *p))
+    ++p;
+
+  if (p < end && *p == '{')
+  {
+    // The declared values of a nominal attribute.
+    attribute.type = NOMINAL;
+    const char* stop = SplitFields(p + 1, end, '}',
+        [&attribute](const char* valueBegin, const char* valueEnd)
+    {
+      if (Unquote(valueBegin, valueEnd))
+      {
+        attribute.values.Insert(Unescape(valueBegin, valueEnd),
+            attribute.values.Size());
+      }
+      else
+      {
+        attribute.values.Insert(valueBegin, valueEnd - valueBegin,
+            attribute.values.Size());
+      }
+    });
+
+    if (stop == end || *stop != '}')
+      LineError(begin, "Unterminated list of nominal values");
+  }
+  else
+  {
+    const char* typeBegin = p;
+    while (p < end && !std::isspace((unsigned char) *p) && *p != '%')
+      ++p;
+
+    std::string type(typeBegin, p);
+    std::transform(type.begin(), type.end(), type.begin(), ::tolower);
+    if (type == "numeric" || type == "integer" || type == "real")
+      attribute.type = NUMERIC;
+    else if (type == "string")
+      attribute.type = STRING;
+    else
+      LineError(begin, "Unsupported type '" + type + "' of attribute '" +
+          attribute.name + "'");
+  }
+
+  attributes.push_back(std::move(attribute));
+}
+
+const char* ARFFParser::NextLine(const char* position,
+                                 const char* end,
+                                 const char*& lineBegin,
+                                 const char*& lineEnd) const
+{
+  const char* newline = static_cast<const char*>(
+      std::memchr(position, '\n', end - position));
+
+  lineBegin = position;
+  lineEnd = (newline == NULL) ? end : newline;
+  while (lineBegin < lineEnd && std::isspace((unsigned char) *lineBegin))
+    ++lineBegin;
+  while (lineEnd > lineBegin && std::isspace((unsigned char) *(lineEnd - 1)))
+    --lineEnd;
+
+  return (newline == NULL) ? end : newline + 1;
+}
+
+double ARFFParser::ParseNumber(const char* lineBegin,
+                               const size_t dimension,
+                               const char* begin,
+                               const char* end,
+                               const bool escaped) const
+{
+  std::string unescaped;
+  if (escaped)
+  {
+    unescaped = Unescape(begin, end);
+    begin = unescaped.data();
+    end = begin + unescaped.size();
+  }
+
+  double value;
+  if (CSVParser::ParseFloat(begin, end, value))
+    return value;
+
+  // Let strtod() read hexadecimal numbers and the like.
+  const std::string token(begin, end);
+  if (!token.empty())
+  {
+    char* last;
+    value = std::strtod(token.c_str(), &last);
+    if (last == token.c_str() + token.size())
+      return value;
+  }
+
+  std::ostringstream oss;
+  if (token == "?")
+    oss << "Missing values ('?') not supported, in attribute " << dimension;
+  else
+    oss << "Parse error of \"" << token << "\" in attribute " << dimension;
+  LineError(lineBegin, oss.str());
+  return 0.0;
+}
+
+bool ARFFParser::Unquote(const char*& begin, const char*& end)
+{
+  if (end - begin < 2 || (*begin != '\'' && *begin != '"') ||
+      *(end - 1) != *begin)
+    return false;
+
+  ++begin;
+  --end;
+  return (std::memchr(begin, '\\', end - begin) != NULL);
+}
+
+std::string ARFFParser::Unescape(const char* begin, const char* end)
+{
+  std::string result;
+  result.reserve(end - begin);
+  for (const char* p = begin; p < end; ++p)
+  {
+    if (*p == '\\' && p + 1 < end)
+    {
+      ++p;
+      result += (*p == 'n') ? '\n' : (*p == 't') ? '\t' : *p;
+    }
+    else
+    {
+      result += *p;
+    }
+  }
+
+  return result;
+}
+
+size_t ARFFParser::LineNumber(const char* position) const
+{
+  const char* memory = file.Memory();
+  return 1 + std::count(memory, position, '\n');
+}
+
+void ARFFParser::LineError(const char* lineBegin,
+                           const std::string& message) const
+{
+  std::ostringstream oss;
+  oss << message << " at line " << LineNumber(lineBegin) << " of '"
+      << file.Filename() << "'.";
+  throw std::runtime_error(oss.str());
+}
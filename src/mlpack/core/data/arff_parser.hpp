@@ -0,0 +1,282 @@
+/**
+ * @file arff_parser.hpp
+ *
+ * A parallel parser of ARFF files, which maps the file into memory, reads the
+ * header once and parses the @data section in chunks.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_ARFF_PARSER_HPP
+#define MLPACK_CORE_DATA_ARFF_PARSER_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include <map>
+
+#include "dataset_mapper.hpp"
+#include "mapped_file.hpp"
+#include "string_map.hpp"
+
+namespace mlpack {
+namespace data {
+
+/**
+ * ARFFParser loads ARFF files into a matrix in parallel.  The file is mapped
+ * into memory with MappedFile, and the header (the @relation and @attribute
+ * declarations, up to @data) is read when the parser is constructed.  The
+ * @data section is then split into chunks at line boundaries; a first pass
+ * counts the instances of each chunk, so that each chunk knows the column its
+ * first instance goes to, and the chunks are parsed in parallel (with OpenMP)
+ * straight into the final matrix.
+ *
+ * Attributes may be numeric (NUMERIC, INTEGER or REAL), strings (STRING) or
+ * nominal ({a, b, c}); string and nominal attributes are categorical.  Each
+ * chunk collects the distinct values of the categorical attributes in a
+ * dictionary of its own, and the dictionaries are merged in file order, so the
+ * mappings are those a serial load would give; the values of a nominal
+ * attribute are mapped in the order they are declared first, so that with
+ * IncrementPolicy the first declared value is 0.
+ *
+ * Values may be quoted with ' or ", with \ escaping the next character, and
+ * an unquoted % starts a comment that runs to the end of the line.  Instances
+ * are either dense (a value for each attribute, separated by commas) or sparse
+ * ({index value, ...}, where attributes that are not given are 0), and both
+ * kinds may be mixed.  Missing values ('?') are not supported.  Errors are
+ * reported with a std::runtime_error that gives the line of the file.
+ */
+class ARFFParser
+{
+ public:
+  /**
+   * Map the given file, read its header, split its @data section into chunks
+   * and count the instances of each chunk.  By default, there are a few
+   * chunks per thread, of at least a megabyte each.  A std::runtime_error is
+   * thrown if the file cannot be mapped or its header is not valid.
+   *
+   * @param filename Name of the file to parse.
+   * @param numChunks Number of chunks to split the @data section into (0 to
+   *     choose it from the number of threads and the size of the file).
+   */
+  ARFFParser(const std::string& filename, const size_t numChunks = 0);
+
+  /**
+   * Parse the instances into the given dense matrix, mapping the categorical
+   * attributes with the given DatasetMapper.  If the DatasetMapper has
+   * dimensionality 0, it is re-initialized with the number of attributes;
+   * otherwise its dimensionality must be the number of attributes, or a
+   * std::invalid_argument is thrown.
+   *
+   * @param matrix Matrix to load into.
+   * @param info DatasetMapper to use while loading.
+   * @param transpose If true, each instance is a column of the matrix
+   *     (default); otherwise, each instance is a row.
+   */
+  template<typename eT, typename PolicyType>
+  void Parse(arma::Mat<eT>& matrix,
+             DatasetMapper<PolicyType>& info,
+             const bool transpose = true);
+
+  /**
+   * Parse the instances into the given sparse matrix, one instance per
+   * column, mapping the categorical attributes with the given DatasetMapper
+   * (as with the dense overload).  Only the nonzero values are held while
+   * parsing, so sparse instances never take the memory of a dense matrix.
+   *
+   * @param matrix Sparse matrix to load into.
+   * @param info DatasetMapper to use while loading.
+   */
+  template<typename eT, typename PolicyType>
+  void Parse(arma::SpMat<eT>& matrix, DatasetMapper<PolicyType>& info);
+
+  //! Get the number of attributes.
+  size_t Dimensionality() const { return attributes.size(); }
+  //! Get the number of instances.
+  size_t NumPoints() const { return numPoints; }
+  //! Get the name of the given attribute.
+  const std::string& Name(const size_t dimension) const
+  { return attributes[dimension].name; }
+  //! Get whether the given attribute is categorical (string or nominal).
+  bool Categorical(const size_t dimension) const
+  { return attributes[dimension].type != NUMERIC; }
+  //! Get whether any instance is given in the sparse format.
+  bool Sparse() const { return sparse; }
+  //! Get the number of chunks the @data section is parsed in.
+  size_t NumChunks() const { return chunks.size(); }
+
+ private:
+  //! The types of attributes.
+  enum AttributeType
+  {
+    NUMERIC,
+    STRING,
+    NOMINAL
+  };
+
+  //! An attribute declared in the header.
+  struct Attribute
+  {
+    //! The name of the attribute.
+    std::string name;
+    //! The type of the attribute.
+    AttributeType type;
+    //! The declared values of a nominal attribute, in order.
+    StringMap<size_t> values;
+  };
+
+  //! A range of whole lines of the @data section.
+  struct Chunk
+  {
+    //! The first character of the chunk.
+    const char* begin;
+    //! One past the last character of the chunk.
+    const char* end;
+    //! The index of the first instance of the chunk.
+    size_t firstPoint;
+    //! The number of instances of the chunk.
+    size_t numPoints;
+  };
+
+  //! The distinct values of a categorical attribute in a chunk (in the order
+  //! they first appear), and where each of them goes.
+  template<typename eT>
+  struct Dictionary
+  {
+    StringMap<size_t> strings;
+    std::vector<std::pair<size_t, size_t>> uses;
+    std::vector<eT> values;
+  };
+
+  //! The dictionaries of a chunk, by attribute.
+  template<typename eT>
+  using Dictionaries = std::map<size_t, Dictionary<eT>>;
+
+  //! Read the header, up to the @data line.
+  void ParseHeader();
+
+  //! Read the @attribute declaration that follows the given position.
+  void ParseAttribute(const char* begin, const char* end);
+
+  /**
+   * Find the line that starts at the given position, without surrounding
+   * whitespace, and return the position after it.
+   */
+  const char* NextLine(const char* position,
+                       const char* end,
+                       const char*& lineBegin,
+                       const char*& lineEnd) const;
+
+  /**
+   * Call f(chunk, index) for each chunk, in parallel.  An exception thrown by
+   * f() is thrown again once all the chunks are done.
+   */
+  template<typename FunctionType>
+  void ForEachChunk(FunctionType f);
+
+  /**
+   * Call f(point, begin, end) for each instance of the chunk, with the index
+   * of the instance in the chunk and its line without surrounding whitespace.
+   * Blank lines and comments are skipped.
+   */
+  template<typename FunctionType>
+  void ForEachLine(const Chunk& chunk, FunctionType f) const;
+
+  /**
+   * Call f(begin, end) for each comma-separated field between the given
+   * positions, without surrounding whitespace, up to an unquoted '%' or
+   * (if stop is given) an unquoted stop character, and return the position
+   * where the scan ended.
+   */
+  template<typename FunctionType>
+  static const char* SplitFields(const char* begin,
+                                 const char* end,
+                                 const char stop,
+                                 FunctionType f);
+
+  /**
+   * Call f(dimension, begin, end, escaped) for each value of the given line
+   * of the @data section (dense or sparse), with the value without its quotes
+   * and whether it holds escaped characters.  A std::runtime_error is thrown
+   * if the line does not give the right attributes.
+   */
+  template<typename FunctionType>
+  void ForEachValue(const char* lineBegin,
+                    const char* lineEnd,
+                    FunctionType f) const;
+
+  /**
+   * Read the value of a numeric attribute, or throw the error for a value
+   * that is not a number.
+   */
+  double ParseNumber(const char* lineBegin,
+                     const size_t dimension,
+                     const char* begin,
+                     const char* end,
+                     const bool escaped) const;
+
+  /**
+   * Add a value of a categorical attribute to the dictionary of its chunk,
+   * noting that it goes to the given place, or throw the error for a value
+   * that is not declared.
+   */
+  template<typename eT>
+  void AddString(Dictionaries<eT>& dictionaries,
+                 const char* lineBegin,
+                 const size_t dimension,
+                 const char* begin,
+                 const char* end,
+                 const bool escaped,
+                 const size_t place) const;
+
+  /**
+   * Reset the given DatasetMapper (or check its dimensionality), and set the
+   * type of each dimension.
+   */
+  template<typename PolicyType>
+  void SetUpMapper(DatasetMapper<PolicyType>& info) const;
+
+  /**
+   * Map the declared values of the nominal attributes and then the strings of
+   * the dictionaries, in file order, and store the mapped value of each
+   * string in the values of its dictionary.
+   */
+  template<typename eT, typename PolicyType>
+  void MapStrings(DatasetMapper<PolicyType>& info,
+                  std::vector<Dictionaries<eT>>& dictionaries) const;
+
+  //! Remove the quotes around the given value, and return whether it holds
+  //! escaped characters.
+  static bool Unquote(const char*& begin, const char*& end);
+
+  //! Get the given value with its escaped characters replaced.
+  static std::string Unescape(const char* begin, const char* end);
+
+  //! Get the line of the file (counting from 1) at the given position.
+  size_t LineNumber(const char* position) const;
+
+  //! Throw an error about the given line.
+  void LineError(const char* lineBegin, const std::string& message) const;
+
+  //! The mapped file.
+  MappedFile file;
+  //! The attributes.
+  std::vector<Attribute> attributes;
+  //! The first character after the @data line.
+  const char* dataBegin;
+  //! The chunks the @data section is parsed in.
+  std::vector<Chunk> chunks;
+  //! The number of instances.
+  size_t numPoints;
+  //! Whether any instance is sparse.
+  bool sparse;
+};
+
+} // namespace data
+} // namespace mlpack
+
+// Include implementation.
+#include "arff_parser_impl.hpp"
+
+#endif
@@ -0,0 +1,421 @@
+/**
+ * @file arff_parser_impl.hpp
+ *
+ * Implementation of the templated parts of ARFFParser.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_ARFF_PARSER_IMPL_HPP
+#define MLPACK_CORE_DATA_ARFF_PARSER_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "arff_parser.hpp"
+#include "csv_parser.hpp"
+
+#include <cctype>
+
+namespace mlpack {
+namespace data {
+
+template<typename eT, typename PolicyType>
+void ARFFParser::Parse(arma::Mat<eT>& matrix,
+                       DatasetMapper<PolicyType>& info,
+                       const bool transpose)
+{
+  SetUpMapper(info);
+
+  // Sparse instances only give their nonzero values.
+  const size_t dimensionality = attributes.size();
+  if (transpose)
+    matrix.set_size(dimensionality, numPoints);
+  else
+    matrix.set_size(numPoints, dimensionality);
+  if (sparse)
+    matrix.zeros();
+
+  eT* values = matrix.memptr();
+  std::vector<Dictionaries<eT>> dictionaries(chunks.size());
+  ForEachChunk([&](Chunk& chunk, const size_t index)
+  {
+    ForEachLine(chunk, [&](const size_t localPoint,
+                           const char* lineBegin,
+                           const char* lineEnd)
+    {
+      const size_t point = chunk.firstPoint + localPoint;
+      ForEachValue(lineBegin, lineEnd, [&](const size_t dimension,
+                                           const char* begin,
+                                           const char* end,
+                                           const bool escaped)
+      {
+        const size_t place = transpose ? point * dimensionality + dimension :
+            dimension * numPoints + point;
+        if (attributes[dimension].type == NUMERIC)
+        {
+          values[place] = eT(ParseNumber(lineBegin, dimension, begin, end,
+              escaped));
+        }
+        else
+        {
+          AddString(dictionaries[index], lineBegin, dimension, begin, end,
+              escaped, place);
+        }
+      });
+    });
+  });
+
+  MapStrings(info, dictionaries);
+
+  // Now write the mapped values.
+  ForEachChunk([&](Chunk& /* chunk */, const size_t index)
+  {
+    for (auto& entry : dictionaries[index])
+    {
+      const Dictionary<eT>& dictionary = entry.second;
+      for (size_t i = 0; i < dictionary.uses.size(); ++i)
+      {
+        values[dictionary.uses[i].first] =
+            dictionary.values[dictionary.uses[i].second];
+      }
+    }
+  });
+}
+
+template<typename eT, typename PolicyType>
+void ARFFParser::Parse(arma::SpMat<eT>& matrix,
+                       DatasetMapper<PolicyType>& info)
+{
+  SetUpMapper(info);
+
+  // Each chunk collects the locations (dimension and instance) of its nonzero
+  // values; the values of categorical attributes are filled in once mapped.
+  std::vector<std::vector<arma::uword>> locations(chunks.size());
+  std::vector<std::vector<eT>> nonzeros(chunks.size());
+  std::vector<Dictionaries<eT>> dictionaries(chunks.size());
+  ForEachChunk([&](Chunk& chunk, const size_t index)
+  {
+    std::vector<arma::uword>& chunkLocations = locations[index];
+    std::vector<eT>& chunkValues = nonzeros[index];
+    ForEachLine(chunk, [&](const size_t localPoint,
+                           const char* lineBegin,
+                           const char* lineEnd)
+    {
+      const size_t point = chunk.firstPoint + localPoint;
+      ForEachValue(lineBegin, lineEnd, [&](const size_t dimension,
+                                           const char* begin,
+                                           const char* end,
+                                           const bool escaped)
+      {
+        if (attributes[dimension].type == NUMERIC)
+        {
+          const eT value = eT(ParseNumber(lineBegin, dimension, begin, end,
+              escaped));
+          if (value == eT(0))
+            return;
+          chunkValues.push_back(value);
+        }
+        else
+        {
+          AddString(dictionaries[index], lineBegin, dimension, begin, end,
+              escaped, chunkValues.size());
+          chunkValues.push_back(eT(0));
+        }
+
+        chunkLocations.push_back(dimension);
+        chunkLocations.push_back(point);
+      });
+    });
+  });
+
+  MapStrings(info, dictionaries);
+
+  std::vector<size_t> offsets(chunks.size() + 1, 0);
+  for (size_t c = 0; c < chunks.size(); ++c)
+    offsets[c + 1] = offsets[c] + nonzeros[c].size();
+
+  arma::umat allLocations(2, offsets.back());
+  arma::Col<eT> allValues(offsets.back());
+  ForEachChunk([&](Chunk& /* chunk */, const size_t index)
+  {
+    std::vector<eT>& chunkValues = nonzeros[index];
+    for (auto& entry : dictionaries[index])
+    {
+      const Dictionary<eT>& dictionary = entry.second;
+      for (size_t i = 0; i < dictionary.uses.size(); ++i)
+      {
+        chunkValues[dictionary.uses[i].first] =
+            dictionary.values[dictionary.uses[i].second];
+      }
+    }
+
+    std::copy(locations[index].begin(), locations[index].end(),
+        allLocations.memptr() + 2 * offsets[index]);
+    std::copy(chunkValues.begin(), chunkValues.end(),
+        allValues.memptr() + offsets[index]);
+
+    // Release the memory of the chunk as soon as it is copied.
+    std::vector<arma::uword>().swap(locations[index]);
+    std::vector<eT>().swap(chunkValues);
+  });
+
+  // Categorical values that are mapped to 0 are dropped here.
+  matrix = arma::SpMat<eT>(allLocations, allValues, attributes.size(),
+      numPoints, true, true);
+}
+
+template<typename FunctionType>
+void ARFFParser::ForEachChunk(FunctionType f)
+{
+  // Exceptions can't leave an OpenMP region, so each chunk keeps its own, and
+  // the first one in file order is thrown afterwards.
+  std::vector<std::string> errors(chunks.size());
+  std::vector<char> failed(chunks.size(), 0);
+
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables. If we're building for Visual Studio, use
+  // the intmax_t type instead.
+  #pragma omp parallel for schedule(dynamic)
+  for (intmax_t c = 0; c < (intmax_t) chunks.size(); ++c)
+#else
+  #pragma omp parallel for schedule(dynamic)
+  for (size_t c = 0; c < chunks.size(); ++c)
+#endif
+  {
+    try
+    {
+      f(chunks[c], (size_t) c);
+    }
+    catch (std::exception& e)
+    {
+      failed[c] = 1;
+      errors[c] = e.what();
+    }
+  }
+
+  for (size_t c = 0; c < chunks.size(); ++c)
+    if (failed[c])
+      throw std::runtime_error(errors[c]);
+}
+
+template<typename FunctionType>
+void ARFFParser::ForEachLine(const Chunk& chunk, FunctionType f) const
+{
+  size_t point = 0;
+  const char* position = chunk.begin;
+  while (position < chunk.end)
+  {
+    const char* lineBegin;
+    const char* lineEnd;
+    position = NextLine(position, chunk.end, lineBegin, lineEnd);
+    if (lineBegin != lineEnd && *lineBegin != '%')
+      f(point++, lineBegin, lineEnd);
+  }
+}
+
+template<typename FunctionType>
+const char* ARFFParser::SplitFields(const char* begin,
+                                    const char* end,
+                                    const char stop,
+                                    FunctionType f)
+{
+  const char* p = begin;
+  while (p < end && std::isspace((unsigned char) *p))
+    ++p;
+  if (p == end || *p == '%' || *p == stop)
+    return p;
+
+  while (true)
+  {
+    while (p < end && std::isspace((unsigned char) *p))
+      ++p;
+    const char* fieldBegin = p;
+
+    // A quoted value may hold separators.
+    if (p < end && (*p == '\'' || *p == '"'))
+    {
+      const char quote = *p;
+      for (++p; p < end && *p != quote; ++p)
+        if (*p == '\\' && p + 1 < end)
+          ++p;
+      if (p < end)
+        ++p;
+    }
+
+    while (p < end && *p != ',' && *p != '%' && *p != stop)
+      ++p;
+
+    const char* fieldEnd = p;
+    while (fieldEnd > fieldBegin &&
+           std::isspace((unsigned char) *(fieldEnd - 1)))
+      --fieldEnd;
+    f(fieldBegin, fieldEnd);
+
+    if (p == end || *p != ',')
+      return p;
+    ++p;
+  }
+}
+
+template<typename FunctionType>
+void ARFFParser::ForEachValue(const char* lineBegin,
+                              const char* lineEnd,
+                              FunctionType f) const
+{
+  const size_t dimensionality = attributes.size();
+  if (*lineBegin == '{')
+  {
+    // Each value of a sparse instance is preceded by the index of its
+    // attribute.
+    const char* stop = SplitFields(lineBegin + 1, lineEnd, '}',
+        [&](const char* begin, const char* end)
+    {
+      const char* p = begin;
+      while (p < end && *p >= '0' && *p <= '9')
+        ++p;
+
+      long long index;
+      if (!CSVParser::ParseInteger(begin, p, false, index) || p == end ||
+          !std::isspace((unsigned char) *p))
+      {
+        LineError(lineBegin, "Malformed sparse value \"" +
+            std::string(begin, end) + "\"");
+      }
+      if ((size_t) index >= dimensionality)
+      {
+        std::ostringstream oss;
+        oss << "Attribute index " << index << " out of range (there are "
+            << dimensionality << " attributes)";
+        LineError(lineBegin, oss.str());
+      }
+
+      while (p < end && std::isspace((unsigned char) *p))
+        ++p;
+      const char* valueBegin = p;
+      const char* valueEnd = end;
+      const bool escaped = Unquote(valueBegin, valueEnd);
+      f((size_t) index, valueBegin, valueEnd, escaped);
+    });
+
+    if (stop == lineEnd || *stop != '}')
+      LineError(lineBegin, "Unterminated sparse instance");
+    return;
+  }
+
+  size_t dimension = 0;
+  SplitFields(lineBegin, lineEnd, '\0', [&](const char* begin, const char* end)
+  {
+    if (dimension == dimensionality)
+      LineError(lineBegin, "Too many columns");
+
+    const bool escaped = Unquote(begin, end);
+    f(dimension++, begin, end, escaped);
+  });
+
+  if (dimension != dimensionality)
+    LineError(lineBegin, "Too few columns");
+}
+
+template<typename eT>
+void ARFFParser::AddString(Dictionaries<eT>& dictionaries,
+                           const char* lineBegin,
+                           const size_t dimension,
+                           const char* begin,
+                           const char* end,
+                           const bool escaped,
+                           const size_t place) const
+{
+  std::string unescaped;
+  if (escaped)
+  {
+    unescaped = Unescape(begin, end);
+    begin = unescaped.data();
+    end = begin + unescaped.size();
+  }
+
+  const Attribute& attribute = attributes[dimension];
+  if (attribute.type == NOMINAL &&
+      attribute.values.Find(begin, end - begin) == NULL)
+  {
+    const std::string token(begin, end);
+    if (token == "?")
+    {
+      LineError(lineBegin, "Missing values ('?') not supported, in "
+          "attribute '" + attribute.name + "'");
+    }
+
+    LineError(lineBegin, "\"" + token + "\" is not a value of nominal "
+        "attribute '" + attribute.name + "'");
+  }
+
+  Dictionary<eT>& dictionary = dictionaries[dimension];
+  const size_t id = dictionary.strings.Insert(begin, end - begin, 0);
+  dictionary.uses.emplace_back(place, id);
+}
+
+template<typename PolicyType>
+void ARFFParser::SetUpMapper(DatasetMapper<PolicyType>& info) const
+{
+  if (info.Dimensionality() == 0)
+  {
+    info = DatasetMapper<PolicyType>(attributes.size());
+  }
+  else if (info.Dimensionality() != attributes.size())
+  {
+    std::ostringstream oss;
+    oss << "data::LoadARFF(): given DatasetInfo has dimensionality "
+        << info.Dimensionality() << ", but data has dimensionality "
+        << attributes.size();
+    throw std::invalid_argument(oss.str());
+  }
+
+  for (size_t i = 0; i < attributes.size(); ++i)
+  {
+    info.Type(i) = (attributes[i].type == NUMERIC) ? Datatype::numeric :
+        Datatype::categorical;
+  }
+}
+
+template<typename eT, typename PolicyType>
+void ARFFParser::MapStrings(DatasetMapper<PolicyType>& info,
+                            std::vector<Dictionaries<eT>>& dictionaries) const
+{
+  if (PolicyType::NeedsFirstPass)
+  {
+    for (size_t d = 0; d < attributes.size(); ++d)
+      for (size_t i = 0; i < attributes[d].values.Size(); ++i)
+        info.template MapFirstPass<eT>(attributes[d].values.String(i), d);
+
+    for (size_t c = 0; c < dictionaries.size(); ++c)
+      for (auto& entry : dictionaries[c])
+        for (size_t i = 0; i < entry.second.strings.Size(); ++i)
+          info.template MapFirstPass<eT>(entry.second.strings.String(i),
+              entry.first);
+  }
+
+  // The declared values of nominal attributes come first.
+  for (size_t d = 0; d < attributes.size(); ++d)
+    for (size_t i = 0; i < attributes[d].values.Size(); ++i)
+      info.template MapString<eT>(attributes[d].values.String(i), d);
+
+  for (size_t c = 0; c < dictionaries.size(); ++c)
+  {
+    for (auto& entry : dictionaries[c])
+    {
+      Dictionary<eT>& dictionary = entry.second;
+      dictionary.values.resize(dictionary.strings.Size());
+      for (size_t i = 0; i < dictionary.strings.Size(); ++i)
+      {
+        dictionary.values[i] = info.template MapString<eT>(
+            dictionary.strings.String(i), entry.first);
+      }
+    }
+  }
+}
+
+} // namespace data
+} // namespace mlpack
+
+#endif
@@ -88,6 +88,64 @@ void Binarize(const arma::Mat<T>& input,
     output(dimension, i) = input(dimension, i) > threshold;
 }
 
+/**
+ * Given a dataset and threshold, set values greater than threshold to 1 and
+ * values less than or equal to the threshold to 0, in place.  This overload
+ * applies the changes to all dimensions, and doesn't allocate anything, so it
+ * can be used on datasets whose copy wouldn't fit in memory.
+ *
+ * @code
+ * arma::Mat<double> input = loadData();
+ * double threshold = 0.5;
+ *
+ * // Binarize the whole Matrix in place.
+ * Binarize<double>(input, threshold);
+ * @endcode
+ *
+ * @param input Matrix to Binarize.
+ * @param threshold Threshold can by any number.
+ */
+template<typename T>
+void Binarize(arma::Mat<T>& input, const double threshold)
+{
+  const int totalElems = static_cast<int>(input.n_elem);
+  T *ptr = input.memptr();
+
+  #pragma omp parallel for
+  for (int i = 0; i < totalElems; ++i)
+    ptr[i] = ptr[i] > threshold;
+}
+
+/**
+ * Given a dataset and threshold, set values of the given dimension greater
+ * than threshold to 1 and values less than or equal to the threshold to 0, in
+ * place.  The other dimensions are not changed.
+ *
+ * @code
+ * arma::Mat<double> input = loadData();
+ * double threshold = 0.5;
+ * size_t dimension = 0;
+ *
+ * // Binarize the first dimension in place.
+ * Binarize<double>(input, threshold, dimension);
+ * @endcode
+ *
+ * @param input Matrix to Binarize.
+ * @param threshold Threshold can by any number.
+ * @param dimension Feature to apply the Binarize function.
+ */
+template<typename T>
+void Binarize(arma::Mat<T>& input,
+              const double threshold,
+              const size_t dimension)
+{
+  const int totalCols = static_cast<int>(input.n_cols);
+
+  #pragma omp parallel for
+  for (int i = 0; i < totalCols; ++i)
+    input(dimension, i) = input(dimension, i) > threshold;
+}
+
 } // namespace data
 } // namespace mlpack
 
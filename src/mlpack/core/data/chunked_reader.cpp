@@ -0,0 +1,336 @@
+/**
+ * @file chunked_reader.cpp
+ *
+ * Implementation of ChunkedReader.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "chunked_reader.hpp"
+#include "extension.hpp"
+
+#include <mlpack/core/math/random.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+using namespace mlpack;
+using namespace mlpack::data;
+
+ChunkedReader::ChunkedReader(const std::string& filename,
+                             const size_t blockSize,
+                             const bool shuffle,
+                             const bool prefetch) :
+    filename(filename),
+    blockSize(blockSize),
+    shuffle(shuffle),
+    prefetch(prefetch),
+    format(TEXT),
+    numPoints(0),
+    dimensionality(0),
+    elements(NULL),
+    elementSize(0),
+#ifdef ARMA_USE_HDF5
+    hdf5File(-1),
+    hdf5Dataset(-1),
+    hdf5Space(-1),
+#endif
+    pass(0),
+    started(false),
+    position(0)
+{
+  if (blockSize == 0)
+  {
+    throw std::invalid_argument("ChunkedReader::ChunkedReader(): the block "
+        "size must be positive");
+  }
+
+  const std::string extension = Extension(filename);
+  if (extension == "csv" || extension == "tsv" || extension == "txt")
+  {
+    format = TEXT;
+    OpenText();
+  }
+  else if (extension == "bin")
+  {
+    format = BINARY;
+    OpenBinary();
+  }
+  else if (extension == "h5" || extension == "hdf5" || extension == "hdf" ||
+           extension == "he5")
+  {
+    format = HDF5;
+    OpenHDF5();
+  }
+  else
+  {
+    throw std::runtime_error("ChunkedReader::ChunkedReader(): unable to "
+        "detect the type of '" + filename + "'; incorrect extension?");
+  }
+}
+
+ChunkedReader::~ChunkedReader()
+{
+  if (worker.joinable())
+    worker.join();
+
+#ifdef ARMA_USE_HDF5
+  if (hdf5Space >= 0)
+    H5Sclose(hdf5Space);
+  if (hdf5Dataset >= 0)
+    H5Dclose(hdf5Dataset);
+  if (hdf5File >= 0)
+    H5Fclose(hdf5File);
+#endif
+}
+
+bool ChunkedReader::Next(arma::mat& block)
+{
+  if (!started)
+  {
+    // Draw the order of a new pass, and start reading its first block.
+    ++pass;
+    order.resize(NumBlocks());
+    for (size_t i = 0; i < order.size(); ++i)
+      order[i] = i;
+
+    if (shuffle)
+      std::shuffle(order.begin(), order.end(), math::randGen);
+
+    started = true;
+    position = 0;
+    if (!order.empty())
+      Fetch(0);
+  }
+
+  if (position == order.size())
+  {
+    started = false;
+    return false;
+  }
+
+  try
+  {
+    Wait();
+  }
+  catch (...)
+  {
+    started = false;
+    throw;
+  }
+
+  block.swap(buffer);
+  if (++position < order.size())
+    Fetch(position);
+
+  return true;
+}
+
+void ChunkedReader::Reset()
+{
+  if (worker.joinable())
+    worker.join();
+
+  error = std::exception_ptr();
+  started = false;
+}
+
+void ChunkedReader::OpenText()
+{
+  // Files with commas are comma-separated; others are separated by
+  // whitespace (which covers tabs).
+  std::ifstream stream(filename);
+  if (!stream.is_open())
+  {
+    throw std::runtime_error("ChunkedReader::ChunkedReader(): cannot open "
+        "file '" + filename + "'");
+  }
+
+  std::string line;
+  while (std::getline(stream, line) &&
+         line.find_first_not_of(" \t\r\v\f") == std::string::npos) { }
+  const CSVParser::SeparatorType separator =
+      (line.find(',') != std::string::npos) ? CSVParser::COMMA :
+      CSVParser::WHITESPACE;
+
+  parser.reset(new CSVParser(filename, separator));
+  parser->IndexBlocks(blockSize);
+  numPoints = parser->NumLines();
+  dimensionality = parser->NumFields();
+}
+
+void ChunkedReader::OpenBinary()
+{
+  file.reset(new MappedFile(filename));
+  const char* memory = file->Memory();
+  const char* end = memory + file->Size();
+
+  // The header is "ARMA_MAT_BIN_FN008" (or FN004 for floats), then a line
+  // with the number of rows and columns.
+  const std::string doubleHeader = "ARMA_MAT_BIN_FN008";
+  const std::string floatHeader = "ARMA_MAT_BIN_FN004";
+  const size_t headerSize = doubleHeader.size();
+  if (file->Size() > headerSize && std::equal(doubleHeader.begin(),
+      doubleHeader.end(), memory))
+  {
+    elementSize = 8;
+  }
+  else if (file->Size() > headerSize && std::equal(floatHeader.begin(),
+      floatHeader.end(), memory))
+  {
+    elementSize = 4;
+  }
+  else
+  {
+    throw std::runtime_error("ChunkedReader::ChunkedReader(): '" + filename +
+        "' is not an Armadillo binary file of doubles or floats");
+  }
+
+  const char* sizeLine = memory + headerSize + 1;
+  const char* sizeEnd = static_cast<const char*>(
+      std::memchr(sizeLine, '\n', end - sizeLine));
+  std::istringstream sizes(std::string(sizeLine, (sizeEnd == NULL) ? end :
+      sizeEnd));
+  size_t rows = 0, cols = 0;
+  if (sizeEnd == NULL || !(sizes >> rows >> cols))
+  {
+    throw std::runtime_error("ChunkedReader::ChunkedReader(): cannot read "
+        "the size of the matrix in '" + filename + "'");
+  }
+
+  // Each row of the stored matrix is a point.
+  elements = sizeEnd + 1;
+  if ((size_t) (end - elements) < rows * cols * elementSize)
+  {
+    throw std::runtime_error("ChunkedReader::ChunkedReader(): '" + filename +
+        "' is truncated");
+  }
+
+  numPoints = rows;
+  dimensionality = cols;
+}
+
+void ChunkedReader::OpenHDF5()
+{
+#ifdef ARMA_USE_HDF5
+  hdf5File = H5Fopen(filename.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+  if (hdf5File >= 0)
+    hdf5Dataset = H5Dopen2(hdf5File, "dataset", H5P_DEFAULT);
+  if (hdf5Dataset >= 0)
+    hdf5Space = H5Dget_space(hdf5Dataset);
+
+  hsize_t dims[2];
+  if (hdf5Space < 0 || H5Sget_simple_extent_ndims(hdf5Space) != 2 ||
+      H5Sget_simple_extent_dims(hdf5Space, dims, NULL) != 2)
+  {
+    throw std::runtime_error("ChunkedReader::ChunkedReader(): cannot read a "
+        "two-dimensional dataset named 'dataset' from '" + filename + "'");
+  }
+
+  // Each row of the dataset is a point.
+  numPoints = dims[0];
+  dimensionality = dims[1];
+#else
+  throw std::runtime_error("ChunkedReader::ChunkedReader(): cannot read '" +
+      filename + "' as HDF5 data, because Armadillo was compiled without HDF5 "
+      "support");
+#endif
+}
+
+void ChunkedReader::ReadBlock(const size_t block, arma::mat& matrix) const
+{
+  const size_t first = block * blockSize;
+  const size_t count = std::min(blockSize, numPoints - first);
+
+  if (format == TEXT)
+  {
+    parser->ParseBlock(block, matrix);
+  }
+  else if (format == BINARY)
+  {
+    // The stored matrix is column-major, so each dimension of the block is a
+    // contiguous range; the elements may not be aligned.
+    matrix.set_size(dimensionality, count);
+    for (size_t d = 0; d < dimensionality; ++d)
+    {
+      const char* source = elements + (d * numPoints + first) * elementSize;
+      for (size_t i = 0; i < count; ++i, source += elementSize)
+      {
+        if (elementSize == 8)
+        {
+          std::memcpy(&matrix(d, i), source, 8);
+        }
+        else
+        {
+          float value;
+          std::memcpy(&value, source, 4);
+          matrix(d, i) = value;
+        }
+      }
+    }
+  }
+  else
+  {
+#ifdef ARMA_USE_HDF5
+    // The rows of the dataset are contiguous, so they are read straight into
+    // the columns of the block.
+    matrix.set_size(dimensionality, count);
+    const hsize_t start[2] = { first, 0 };
+    const hsize_t counts[2] = { count, dimensionality };
+    const hid_t space = H5Scopy(hdf5Space);
+    H5Sselect_hyperslab(space, H5S_SELECT_SET, start, NULL, counts, NULL);
+    const hid_t memory = H5Screate_simple(2, counts, NULL);
+    const herr_t status = H5Dread(hdf5Dataset, H5T_NATIVE_DOUBLE, memory,
+        space, H5P_DEFAULT, matrix.memptr());
+    H5Sclose(memory);
+    H5Sclose(space);
+
+    if (status < 0)
+    {
+      std::ostringstream oss;
+      oss << "ChunkedReader::Next(): cannot read block " << block << " of '"
+          << filename << "'";
+      throw std::runtime_error(oss.str());
+    }
+#endif
+  }
+}
+
+void ChunkedReader::Fetch(const size_t position)
+{
+  if (!prefetch)
+    return;
+
+  const size_t block = order[position];
+  worker = std::thread([this, block]()
+  {
+    try
+    {
+      ReadBlock(block, buffer);
+    }
+    catch (...)
+    {
+      error = std::current_exception();
+    }
+  });
+}
+
+void ChunkedReader::Wait()
+{
+  if (!prefetch)
+  {
+    ReadBlock(order[position], buffer);
+    return;
+  }
+
+  worker.join();
+  if (error)
+  {
+    std::exception_ptr readError = error;
+    error = std::exception_ptr();
+    std::rethrow_exception(readError);
+  }
+}
@@ -0,0 +1,193 @@
+/**
+ * @file chunked_reader.hpp
+ *
+ * A reader that hands out a dataset held in one file as a sequence of blocks
+ * of points, so that algorithms that learn from a stream of points don't have
+ * to load the whole dataset.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_CHUNKED_READER_HPP
+#define MLPACK_CORE_DATA_CHUNKED_READER_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include <exception>
+#include <memory>
+#include <thread>
+
+#include "csv_parser.hpp"
+#include "mapped_file.hpp"
+
+namespace mlpack {
+namespace data {
+
+/**
+ * ChunkedReader reads a dataset from disk in blocks of a fixed number of
+ * points (the last block may be smaller), one point per column, as
+ * data::Load() would give them.  Only the block being read and the block being
+ * used are held in memory, so the dataset can be larger than memory.  The file
+ * can be
+ *
+ *  - a text file (.csv, .tsv or .txt) with one point per line, separated by
+ *    commas or by whitespace; it is mapped into memory and indexed once, so
+ *    each block is parsed straight from the mapped file;
+ *  - an Armadillo binary file (.bin) of doubles or floats, as saved by
+ *    data::Save() (so each row of the stored matrix is a point);
+ *  - an HDF5 file (.h5, .hdf5, .hdf or .he5) whose dataset "dataset" has a
+ *    point in each row, as saved by data::Save(), if Armadillo was built with
+ *    HDF5 support; each block is one read of a range of rows.
+ *
+ * Each pass visits every block once, in file order or in a random order.
+ * With prefetching, the next block is read by a background thread while the
+ * caller uses the current one.  Next() swaps the block into the caller's
+ * matrix instead of copying it, and the memory of the matrix given back is
+ * reused for the next block, so passing the same matrix to each call doesn't
+ * allocate once the first block is read.
+ *
+ * @code
+ * ChunkedReader reader("train.csv", 10000, true);
+ * arma::mat block;
+ * while (reader.Next(block))
+ * {
+ *   // ... use the block ...
+ * }
+ * @endcode
+ *
+ * When Next() returns false the pass is over, and the following call to
+ * Next() starts a new pass (with a new order if the blocks are shuffled).  The
+ * order is drawn from mlpack's random number generator, so it is reproducible
+ * after math::RandomSeed().  An error while reading a block is thrown by the
+ * call to Next() that would have returned it, and ends the pass.
+ */
+class ChunkedReader
+{
+ public:
+  /**
+   * Open the given file and find its blocks.  A std::runtime_error is thrown
+   * if the file can't be read or its format isn't supported.
+   *
+   * @param filename Name of the file to read.
+   * @param blockSize Number of points of each block.
+   * @param shuffle Whether to visit the blocks in a random order.
+   * @param prefetch Whether to read the next block in the background.
+   */
+  ChunkedReader(const std::string& filename,
+                const size_t blockSize,
+                const bool shuffle = false,
+                const bool prefetch = true);
+
+  //! Wait for the background read, and close the file.
+  ~ChunkedReader();
+
+  //! The reader can't be copied, since it owns the file and its thread.
+  ChunkedReader(const ChunkedReader&) = delete;
+  ChunkedReader& operator=(const ChunkedReader&) = delete;
+
+  /**
+   * Get the next block of the pass, waiting for it if it isn't read yet.  The
+   * block is swapped into the given matrix, whose memory is reused for a later
+   * block.  If the pass is over, false is returned and the matrix is left
+   * unchanged; the next call starts a new pass.
+   *
+   * @param block Matrix to store the block into (one point per column).
+   * @return Whether a block was returned.
+   */
+  bool Next(arma::mat& block);
+
+  //! End the current pass, so that the next call to Next() starts a new one.
+  void Reset();
+
+  //! Get the name of the file.
+  const std::string& Filename() const { return filename; }
+  //! Get the number of points of the file.
+  size_t NumPoints() const { return numPoints; }
+  //! Get the dimensionality of the points.
+  size_t Dimensionality() const { return dimensionality; }
+  //! Get the number of points of each block.
+  size_t BlockSize() const { return blockSize; }
+  //! Get the number of blocks.
+  size_t NumBlocks() const { return (numPoints + blockSize - 1) / blockSize; }
+  //! Get the number of the current pass (the first pass is 1), or 0 before
+  //! the first call to Next().
+  size_t Pass() const { return pass; }
+
+ private:
+  //! The formats that can be read.
+  enum FormatType
+  {
+    TEXT,
+    BINARY,
+    HDF5
+  };
+
+  //! Open a text file.
+  void OpenText();
+  //! Open an Armadillo binary file.
+  void OpenBinary();
+  //! Open an HDF5 file.
+  void OpenHDF5();
+
+  //! Read the given block into the given matrix.
+  void ReadBlock(const size_t block, arma::mat& matrix) const;
+
+  //! Start reading the block at the given position of the order.
+  void Fetch(const size_t position);
+
+  //! Wait for the block that is being fetched to be read.
+  void Wait();
+
+  //! The name of the file.
+  std::string filename;
+  //! The number of points of each block.
+  size_t blockSize;
+  //! Whether to shuffle the blocks.
+  bool shuffle;
+  //! Whether to read the next block in the background.
+  bool prefetch;
+
+  //! The format of the file.
+  FormatType format;
+  //! The number of points of the file.
+  size_t numPoints;
+  //! The dimensionality of the points.
+  size_t dimensionality;
+
+  //! The parser of a text file.
+  std::unique_ptr<CSVParser> parser;
+  //! The mapped binary file.
+  std::unique_ptr<MappedFile> file;
+  //! The first element of the matrix of a binary file.
+  const char* elements;
+  //! The size of the elements of a binary file (4 or 8).
+  size_t elementSize;
+
+#ifdef ARMA_USE_HDF5
+  //! The HDF5 file, dataset and dataspace.
+  hid_t hdf5File, hdf5Dataset, hdf5Space;
+#endif
+
+  //! The number of the current pass.
+  size_t pass;
+  //! Whether a pass is in progress.
+  bool started;
+  //! The order of the blocks in the current pass.
+  std::vector<size_t> order;
+  //! The position in the order of the next block to return.
+  size_t position;
+
+  //! The block being fetched.
+  arma::mat buffer;
+  //! The thread reading the block being fetched.
+  std::thread worker;
+  //! The error of the background read, if it failed.
+  std::exception_ptr error;
+};
+
+} // namespace data
+} // namespace mlpack
+
+#endif
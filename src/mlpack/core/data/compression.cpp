@@ -0,0 +1,550 @@
+/**
+ * @file compression.cpp
+ *
+ * Implementation of the compressed streams.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "compression.hpp"
+#include "extension.hpp"
+
+#include <cstring>
+
+#ifdef HAS_ZSTD
+  #include <zstd.h>
+#endif
+#ifdef HAS_LZ4
+  #include <lz4frame.h>
+#endif
+
+using namespace mlpack;
+using namespace mlpack::data;
+
+//! The size of the blocks the data is decompressed into and compressed from.
+static const size_t BlockSize = 1 << 20;
+//! The number of decompressed blocks that may wait for the reader.
+static const size_t MaxBlocks = 4;
+
+Compression mlpack::data::FileCompression(const std::string& filename)
+{
+  const std::string extension = Extension(filename);
+  if (extension == "zst" || extension == "zstd")
+    return Compression::zstd;
+  else if (extension == "lz4")
+    return Compression::lz4;
+  else
+    return Compression::none;
+}
+
+std::string mlpack::data::UncompressedName(const std::string& filename)
+{
+  if (FileCompression(filename) == Compression::none)
+    return filename;
+
+  return filename.substr(0, filename.rfind('.'));
+}
+
+//! Throw the error for a compression that mlpack was compiled without.
+static void Unsupported(const std::string& filename, const char* library)
+{
+  throw std::runtime_error("cannot use '" + filename + "': mlpack was "
+      "compiled without " + library + " support");
+}
+
+struct DecompressionBuffer::Codec
+{
+  Codec(const std::string& filename, const Compression compression) :
+      filename(filename),
+      compression(compression)
+  {
+    if (compression == Compression::zstd)
+    {
+#ifdef HAS_ZSTD
+      zstd = ZSTD_createDStream();
+      ZSTD_initDStream(zstd);
+#else
+      Unsupported(filename, "zstd");
+#endif
+    }
+    else if (compression == Compression::lz4)
+    {
+#ifdef HAS_LZ4
+      if (LZ4F_isError(LZ4F_createDecompressionContext(&lz4, LZ4F_VERSION)))
+        throw std::runtime_error("cannot create an LZ4 decompressor");
+#else
+      Unsupported(filename, "LZ4");
+#endif
+    }
+    else
+    {
+      throw std::invalid_argument("'" + filename + "' is not compressed");
+    }
+  }
+
+  ~Codec()
+  {
+#ifdef HAS_ZSTD
+    if (compression == Compression::zstd)
+      ZSTD_freeDStream(zstd);
+#endif
+#ifdef HAS_LZ4
+    if (compression == Compression::lz4)
+      LZ4F_freeDecompressionContext(lz4);
+#endif
+  }
+
+  /**
+   * Decompress as much of the input as fits in the output, and return 0 if a
+   * frame was just finished (or something else otherwise).
+   */
+  size_t Decompress(const char* in,
+                    const size_t inSize,
+                    size_t& inUsed,
+                    char* out,
+                    const size_t outSize,
+                    size_t& outUsed)
+  {
+    size_t result = 1;
+#if !defined(HAS_ZSTD) && !defined(HAS_LZ4)
+    // There is no Codec to call this without either library.
+    (void) in; (void) inSize; (void) inUsed;
+    (void) out; (void) outSize; (void) outUsed;
+#endif
+#ifdef HAS_ZSTD
+    if (compression == Compression::zstd)
+    {
+      ZSTD_inBuffer inBuffer = { in, inSize, 0 };
+      ZSTD_outBuffer outBuffer = { out, outSize, 0 };
+      result = ZSTD_decompressStream(zstd, &outBuffer, &inBuffer);
+      if (ZSTD_isError(result))
+        Error(ZSTD_getErrorName(result));
+      inUsed = inBuffer.pos;
+      outUsed = outBuffer.pos;
+    }
+#endif
+#ifdef HAS_LZ4
+    if (compression == Compression::lz4)
+    {
+      inUsed = inSize;
+      outUsed = outSize;
+      result = LZ4F_decompress(lz4, out, &outUsed, in, &inUsed, NULL);
+      if (LZ4F_isError(result))
+        Error(LZ4F_getErrorName(result));
+    }
+#endif
+    return result;
+  }
+
+  //! Throw the given error of the decompressor.
+  void Error(const char* message) const
+  {
+    throw std::runtime_error("DecompressionBuffer: cannot decompress '" +
+        filename + "': " + message);
+  }
+
+  std::string filename;
+  Compression compression;
+#ifdef HAS_ZSTD
+  ZSTD_DStream* zstd;
+#endif
+#ifdef HAS_LZ4
+  LZ4F_dctx* lz4;
+#endif
+};
+
+DecompressionBuffer::DecompressionBuffer(const std::string& filename,
+                                         const Compression compression) :
+    filename(filename),
+    file(filename.c_str(), std::ios::binary),
+    finished(false),
+    stopping(false)
+{
+  if (!file.is_open())
+  {
+    throw std::runtime_error("DecompressionBuffer: cannot open file '" +
+        filename + "'");
+  }
+
+  codec.reset(new Codec(filename, compression));
+  worker = std::thread(&DecompressionBuffer::Decompress, this);
+}
+
+DecompressionBuffer::~DecompressionBuffer()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  changed.notify_all();
+  worker.join();
+}
+
+DecompressionBuffer::int_type DecompressionBuffer::underflow()
+{
+  if (gptr() < egptr())
+    return traits_type::to_int_type(*gptr());
+
+  std::unique_lock<std::mutex> lock(mutex);
+  changed.wait(lock, [this]() { return !blocks.empty() || finished; });
+  if (blocks.empty())
+  {
+    if (error)
+      std::rethrow_exception(error);
+    return traits_type::eof();
+  }
+
+  current.swap(blocks.front());
+  blocks.pop_front();
+  lock.unlock();
+  changed.notify_all();
+
+  setg(current.data(), current.data(), current.data() + current.size());
+  return traits_type::to_int_type(*gptr());
+}
+
+void DecompressionBuffer::Decompress()
+{
+  try
+  {
+    std::vector<char> in(BlockSize);
+    std::vector<char> block(BlockSize);
+    size_t inSize = 0, inPosition = 0, filled = 0;
+
+    // Whether the last call ended a frame, and whether it may hold more
+    // output than it had room for.
+    bool frameEnded = true;
+    bool outputFull = false;
+    while (true)
+    {
+      if (inPosition == inSize && !outputFull)
+      {
+        file.read(in.data(), in.size());
+        inSize = (size_t) file.gcount();
+        inPosition = 0;
+        if (inSize == 0)
+        {
+          if (file.bad())
+          {
+            throw std::runtime_error("DecompressionBuffer: cannot read file '"
+                + filename + "'");
+          }
+          break;
+        }
+      }
+
+      // A call that does nothing (after a full block) doesn't change whether
+      // the frame ended.
+      size_t inUsed = 0, outUsed = 0;
+      const bool ended = (codec->Decompress(in.data() + inPosition,
+          inSize - inPosition, inUsed, block.data() + filled,
+          block.size() - filled, outUsed) == 0);
+      if (inUsed > 0 || outUsed > 0)
+        frameEnded = ended;
+      inPosition += inUsed;
+      filled += outUsed;
+
+      outputFull = (filled == block.size());
+      if (outputFull && !Push(block))
+        return;
+      if (outputFull)
+      {
+        block.resize(BlockSize);
+        filled = 0;
+      }
+    }
+
+    if (!frameEnded)
+    {
+      throw std::runtime_error("DecompressionBuffer: '" + filename + "' is "
+          "truncated");
+    }
+
+    block.resize(filled);
+    if (filled > 0 && !Push(block))
+      return;
+  }
+  catch (...)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    error = std::current_exception();
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    finished = true;
+  }
+  changed.notify_all();
+}
+
+bool DecompressionBuffer::Push(std::vector<char>& block)
+{
+  std::unique_lock<std::mutex> lock(mutex);
+  changed.wait(lock, [this]() { return blocks.size() < MaxBlocks ||
+      stopping; });
+  if (stopping)
+    return false;
+
+  blocks.push_back(std::vector<char>());
+  blocks.back().swap(block);
+  lock.unlock();
+  changed.notify_all();
+  return true;
+}
+
+struct CompressionBuffer::Codec
+{
+  Codec(const std::string& filename, const Compression compression) :
+      compression(compression),
+      started(false)
+  {
+    if (compression == Compression::zstd)
+    {
+#ifdef HAS_ZSTD
+      zstd = ZSTD_createCStream();
+      ZSTD_initCStream(zstd, 3);
+#else
+      Unsupported(filename, "zstd");
+#endif
+    }
+    else if (compression == Compression::lz4)
+    {
+#ifdef HAS_LZ4
+      if (LZ4F_isError(LZ4F_createCompressionContext(&lz4, LZ4F_VERSION)))
+        throw std::runtime_error("cannot create an LZ4 compressor");
+      std::memset(&preferences, 0, sizeof(preferences));
+      preferences.frameInfo.contentChecksumFlag = LZ4F_contentChecksumEnabled;
+#else
+      Unsupported(filename, "LZ4");
+#endif
+    }
+    else
+    {
+      throw std::invalid_argument("'" + filename + "' is not compressed");
+    }
+  }
+
+  ~Codec()
+  {
+#ifdef HAS_ZSTD
+    if (compression == Compression::zstd)
+      ZSTD_freeCStream(zstd);
+#endif
+#ifdef HAS_LZ4
+    if (compression == Compression::lz4)
+      LZ4F_freeCompressionContext(lz4);
+#endif
+  }
+
+  //! The size of the output buffer needed to compress a block.
+  size_t OutputSize() const
+  {
+#ifdef HAS_ZSTD
+    if (compression == Compression::zstd)
+      return ZSTD_CStreamOutSize();
+#endif
+#ifdef HAS_LZ4
+    if (compression == Compression::lz4)
+      return LZ4F_compressBound(BlockSize, &preferences) + LZ4F_HEADER_SIZE_MAX;
+#endif
+    return 0;
+  }
+
+  /**
+   * Compress the given data (and finish the frame if end is true), calling
+   * write(data, size) for each piece of compressed data.
+   */
+  template<typename WriteType>
+  void Compress(const char* in,
+                const size_t inSize,
+                const bool end,
+                std::vector<char>& out,
+                WriteType write)
+  {
+#if !defined(HAS_ZSTD) && !defined(HAS_LZ4)
+    // There is no Codec to call this without either library.
+    (void) in; (void) inSize; (void) end; (void) out; (void) write;
+#endif
+#ifdef HAS_ZSTD
+    if (compression == Compression::zstd)
+    {
+      ZSTD_inBuffer inBuffer = { in, inSize, 0 };
+      while (inBuffer.pos < inBuffer.size)
+      {
+        ZSTD_outBuffer outBuffer = { out.data(), out.size(), 0 };
+        const size_t result = ZSTD_compressStream(zstd, &outBuffer, &inBuffer);
+        if (ZSTD_isError(result))
+          throw std::runtime_error(ZSTD_getErrorName(result));
+        write(out.data(), outBuffer.pos);
+      }
+
+      size_t remaining = end ? 1 : 0;
+      while (remaining != 0)
+      {
+        ZSTD_outBuffer outBuffer = { out.data(), out.size(), 0 };
+        remaining = ZSTD_endStream(zstd, &outBuffer);
+        if (ZSTD_isError(remaining))
+          throw std::runtime_error(ZSTD_getErrorName(remaining));
+        write(out.data(), outBuffer.pos);
+      }
+    }
+#endif
+#ifdef HAS_LZ4
+    if (compression == Compression::lz4)
+    {
+      size_t size;
+      if (!started)
+      {
+        size = LZ4F_compressBegin(lz4, out.data(), out.size(), &preferences);
+        if (LZ4F_isError(size))
+          throw std::runtime_error(LZ4F_getErrorName(size));
+        write(out.data(), size);
+        started = true;
+      }
+
+      if (inSize > 0)
+      {
+        size = LZ4F_compressUpdate(lz4, out.data(), out.size(), in, inSize,
+            NULL);
+        if (LZ4F_isError(size))
+          throw std::runtime_error(LZ4F_getErrorName(size));
+        write(out.data(), size);
+      }
+
+      if (end)
+      {
+        size = LZ4F_compressEnd(lz4, out.data(), out.size(), NULL);
+        if (LZ4F_isError(size))
+          throw std::runtime_error(LZ4F_getErrorName(size));
+        write(out.data(), size);
+      }
+    }
+#endif
+  }
+
+  Compression compression;
+  bool started;
+#ifdef HAS_ZSTD
+  ZSTD_CStream* zstd;
+#endif
+#ifdef HAS_LZ4
+  LZ4F_cctx* lz4;
+  LZ4F_preferences_t preferences;
+#endif
+};
+
+CompressionBuffer::CompressionBuffer(const std::string& filename,
+                                     const Compression compression) :
+    filename(filename),
+    file(filename.c_str(), std::ios::binary),
+    input(BlockSize),
+    closed(false)
+{
+  if (!file.is_open())
+  {
+    throw std::runtime_error("CompressionBuffer: cannot open file '" +
+        filename + "' for writing");
+  }
+
+  codec.reset(new Codec(filename, compression));
+  output.resize(codec->OutputSize());
+  setp(input.data(), input.data() + input.size());
+}
+
+CompressionBuffer::~CompressionBuffer()
+{
+  if (!closed)
+  {
+    try
+    {
+      Close();
+    }
+    catch (std::exception& /* e */)
+    {
+      // Nothing can be done about it here.
+    }
+  }
+}
+
+void CompressionBuffer::Close()
+{
+  if (closed)
+    return;
+
+  closed = true;
+  Flush(true);
+  file.close();
+  if (error.empty() && file.fail())
+    error = "CompressionBuffer: cannot write file '" + filename + "'";
+  if (!error.empty())
+    throw std::runtime_error(error);
+}
+
+CompressionBuffer::int_type CompressionBuffer::overflow(int_type c)
+{
+  if (!Flush(false))
+    return traits_type::eof();
+
+  if (!traits_type::eq_int_type(c, traits_type::eof()))
+  {
+    *pptr() = traits_type::to_char_type(c);
+    pbump(1);
+  }
+  return traits_type::not_eof(c);
+}
+
+int CompressionBuffer::sync()
+{
+  return Flush(false) ? 0 : -1;
+}
+
+bool CompressionBuffer::Flush(const bool end)
+{
+  if (!error.empty())
+    return false;
+
+  try
+  {
+    codec->Compress(pbase(), pptr() - pbase(), end, output,
+        [this](const char* data, const size_t size)
+    {
+      if (!file.write(data, size))
+      {
+        throw std::runtime_error("CompressionBuffer: cannot write file '" +
+            filename + "'");
+      }
+    });
+  }
+  catch (std::exception& e)
+  {
+    error = e.what();
+    return false;
+  }
+
+  setp(input.data(), input.data() + input.size());
+  return true;
+}
+
+CompressedInputStream::CompressedInputStream(const std::string& filename) :
+    std::istream(NULL),
+    buffer(filename, FileCompression(filename))
+{
+  rdbuf(&buffer);
+  // Let decompression errors through, rather than only setting badbit.
+  exceptions(std::ios::badbit);
+}
+
+CompressedOutputStream::CompressedOutputStream(const std::string& filename) :
+    std::ostream(NULL),
+    buffer(filename, FileCompression(filename))
+{
+  rdbuf(&buffer);
+}
+
+void CompressedOutputStream::Close()
+{
+  flush();
+  buffer.Close();
+}
@@ -0,0 +1,230 @@
+/**
+ * @file compression.hpp
+ *
+ * Streams that read and write zstd- or LZ4-compressed files, used by
+ * data::Load() and data::Save() for files with a .zst or .lz4 extension.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_COMPRESSION_HPP
+#define MLPACK_CORE_DATA_COMPRESSION_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace mlpack {
+namespace data {
+
+//! The compression of a file.
+enum class Compression
+{
+  none, //!< The file is not compressed.
+  zstd, //!< The file is compressed with zstd (.zst or .zstd).
+  lz4   //!< The file is an LZ4 frame (.lz4).
+};
+
+/**
+ * Get the compression of the given file from its last extension: .zst and
+ * .zstd are zstd, .lz4 is LZ4, and any other extension is no compression.
+ *
+ * @param filename Name of the file.
+ */
+Compression FileCompression(const std::string& filename);
+
+/**
+ * Get the given filename without its compression extension (so that
+ * "model.bin.zst" gives "model.bin"), from which the format of the data can
+ * be found.  A filename without a compression extension is returned as is.
+ *
+ * @param filename Name of the file.
+ */
+std::string UncompressedName(const std::string& filename);
+
+/**
+ * A stream buffer that decompresses a file on a background thread.  The
+ * thread reads the compressed file and decompresses it into blocks of a
+ * megabyte, keeping a few blocks ahead of the reader, so that reading the file
+ * and decompressing it overlap with whatever the reader does with the data.
+ * An error while decompressing is thrown by the read that reaches it.
+ */
+class DecompressionBuffer : public std::streambuf
+{
+ public:
+  /**
+   * Open the given file and start decompressing it.  A std::runtime_error is
+   * thrown if the file can't be opened, or if mlpack was compiled without
+   * support for the compression.
+   *
+   * @param filename Name of the file to read.
+   * @param compression Compression of the file.
+   */
+  DecompressionBuffer(const std::string& filename,
+                      const Compression compression);
+
+  //! Stop the background thread and close the file.
+  ~DecompressionBuffer();
+
+ protected:
+  //! Get the next block.
+  int_type underflow();
+
+ private:
+  //! The state of the decompressor.
+  struct Codec;
+
+  //! Read and decompress the file (on the background thread).
+  void Decompress();
+
+  //! Hand a block to the reader, and return false if it has stopped.
+  bool Push(std::vector<char>& block);
+
+  //! The name of the file.
+  std::string filename;
+  //! The compressed file.
+  std::ifstream file;
+  //! The decompressor.
+  std::unique_ptr<Codec> codec;
+
+  //! The block being read.
+  std::vector<char> current;
+  //! The blocks that are decompressed but not read yet.
+  std::deque<std::vector<char>> blocks;
+  //! Whether the whole file was decompressed (or an error stopped it).
+  bool finished;
+  //! Whether the reader has stopped.
+  bool stopping;
+  //! The error of the background thread, if it failed.
+  std::exception_ptr error;
+
+  //! Guards the blocks and the flags.
+  std::mutex mutex;
+  //! Signals a change of the blocks or the flags.
+  std::condition_variable changed;
+  //! The thread decompressing the file.
+  std::thread worker;
+};
+
+/**
+ * A stream buffer that compresses what is written to it into a file.  The
+ * data is compressed a megabyte at a time; Close() finishes the compressed
+ * frame, and must be called to know whether the file was written.
+ */
+class CompressionBuffer : public std::streambuf
+{
+ public:
+  /**
+   * Create the given file.  A std::runtime_error is thrown if the file can't
+   * be created, or if mlpack was compiled without support for the
+   * compression.
+   *
+   * @param filename Name of the file to write.
+   * @param compression Compression of the file.
+   */
+  CompressionBuffer(const std::string& filename,
+                    const Compression compression);
+
+  //! Close the file, if Close() wasn't called (ignoring any error).
+  ~CompressionBuffer();
+
+  /**
+   * Compress the rest of the data, finish the frame and close the file.  A
+   * std::runtime_error is thrown if anything couldn't be written.
+   */
+  void Close();
+
+ protected:
+  //! Compress the buffered data to make room for more.
+  int_type overflow(int_type c);
+  //! Compress the buffered data.
+  int sync();
+
+ private:
+  //! The state of the compressor.
+  struct Codec;
+
+  //! Compress the buffered data (and finish the frame if end is true), and
+  //! return whether it was written.
+  bool Flush(const bool end);
+
+  //! The name of the file.
+  std::string filename;
+  //! The compressed file.
+  std::ofstream file;
+  //! The compressor.
+  std::unique_ptr<Codec> codec;
+  //! The data waiting to be compressed.
+  std::vector<char> input;
+  //! The compressed data waiting to be written.
+  std::vector<char> output;
+  //! Whether the file is closed.
+  bool closed;
+  //! The first error, if any.
+  std::string error;
+};
+
+/**
+ * An input stream that reads a compressed file (see DecompressionBuffer; the
+ * file is decompressed on a background thread).  Errors are thrown as
+ * std::runtime_error.
+ *
+ * @code
+ * CompressedInputStream stream("model.bin.zst");
+ * boost::archive::binary_iarchive ar(stream);
+ * @endcode
+ */
+class CompressedInputStream : public std::istream
+{
+ public:
+  /**
+   * Open the given compressed file, with the compression given by its
+   * extension (see FileCompression()).  A std::runtime_error is thrown if it
+   * can't be read.
+   *
+   * @param filename Name of the file to read.
+   */
+  CompressedInputStream(const std::string& filename);
+
+ private:
+  //! The buffer decompressing the file.
+  DecompressionBuffer buffer;
+};
+
+/**
+ * An output stream that writes a compressed file (see CompressionBuffer).
+ * Close() must be called when everything is written.
+ */
+class CompressedOutputStream : public std::ostream
+{
+ public:
+  /**
+   * Create the given compressed file, with the compression given by its
+   * extension (see FileCompression()).  A std::runtime_error is thrown if it
+   * can't be created.
+   *
+   * @param filename Name of the file to write.
+   */
+  CompressedOutputStream(const std::string& filename);
+
+  //! Finish the file; a std::runtime_error is thrown if it couldn't be
+  //! written.
+  void Close();
+
+ private:
+  //! The buffer compressing the file.
+  CompressionBuffer buffer;
+};
+
+} // namespace data
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,329 @@
+/**
+ * @file csv_parser.cpp
+ *
+ * Implementation of the non-templated parts of CSVParser.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "csv_parser.hpp"
+
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+using namespace mlpack;
+using namespace mlpack::data;
+
+namespace {
+
+//! Whether the token is the given lowercase word, in any case.
+bool EqualsLowercase(const char* begin, const char* end, const char* word)
+{
+  for (; begin != end && *word != '\0'; ++begin, ++word)
+    if (std::tolower((unsigned char) *begin) != *word)
+      return false;
+
+  return (begin == end && *word == '\0');
+}
+
+} // namespace
+
+CSVParser::CSVParser(const std::string& filename,
+                     const SeparatorType separator,
+                     const size_t numChunks) :
+    CSVParser(MappedFile(filename), separator, numChunks)
+{
+  // Nothing to do.
+}
+
+CSVParser::CSVParser(MappedFile&& mappedFile,
+                     const SeparatorType separator,
+                     const size_t numChunks) :
+    file(std::move(mappedFile)),
+    separator(separator),
+    numLines(0),
+    numFields(0),
+    blockSize(0)
+{
+  const char* memory = file.Memory();
+  const size_t size = file.Size();
+
+  size_t n = numChunks;
+  if (n == 0)
+  {
+#ifdef HAS_OPENMP
+    const size_t threads = omp_get_max_threads();
+#else
+    const size_t threads = 1;
+#endif
+    n = std::max((size_t) 1, std::min(4 * threads, size / (1 << 20)));
+  }
+
+  // Each chunk (but the first) starts after the first newline at or after its
+  // share of the file, so that every chunk holds whole lines.
+  chunks.resize(n);
+  const char* previous = memory;
+  for (size_t c = 0; c < n; ++c)
+  {
+    chunks[c].begin = previous;
+    if (c + 1 == n)
+    {
+      chunks[c].end = memory + size;
+    }
+    else
+    {
+      const size_t share = std::max((size_t) 1, (c + 1) * size / n);
+      const char* newline = static_cast<const char*>(
+          std::memchr(memory + share - 1, '\n', size - share + 1));
+      chunks[c].end = std::max(previous, (newline == NULL) ? memory + size :
+          newline + 1);
+    }
+    previous = chunks[c].end;
+  }
+
+  // Count the lines of each chunk.
+  ForEachChunk([this](Chunk& chunk, const size_t /* index */)
+  {
+    chunk.numLines = 0;
+    ForEachLine(chunk, [&chunk](const size_t, const char*, const char*)
+    {
+      ++chunk.numLines;
+    });
+  });
+
+  for (size_t c = 0; c < n; ++c)
+  {
+    chunks[c].firstLine = numLines;
+    numLines += chunks[c].numLines;
+  }
+
+  // The first line gives the number of fields.
+  const char* position = memory;
+  while (position < memory + size)
+  {
+    const char* lineBegin;
+    const char* lineEnd;
+    position = NextLine(position, memory + size, lineBegin, lineEnd);
+    if (lineBegin != lineEnd)
+    {
+      numFields = SplitLine(lineBegin, lineEnd,
+          [](const size_t, const char*, const char*) { });
+      break;
+    }
+  }
+}
+
+void CSVParser::IndexBlocks(const size_t blockSize)
+{
+  if (blockSize == 0)
+  {
+    throw std::invalid_argument("CSVParser::IndexBlocks(): the block size must "
+        "be positive");
+  }
+
+  this->blockSize = blockSize;
+  blockStarts.assign((numLines + blockSize - 1) / blockSize, NULL);
+  ForEachChunk([this](Chunk& chunk, const size_t /* index */)
+  {
+    ForEachLine(chunk, [this, &chunk](const size_t localLine,
+                                      const char* lineBegin,
+                                      const char* /* lineEnd */)
+    {
+      const size_t line = chunk.firstLine + localLine;
+      if (line % this->blockSize == 0)
+        blockStarts[line / this->blockSize] = lineBegin;
+    });
+  });
+}
+
+const char* CSVParser::NextLine(const char* position,
+                                const char* end,
+                                const char*& lineBegin,
+                                const char*& lineEnd) const
+{
+  const char* newline = static_cast<const char*>(
+      std::memchr(position, '\n', end - position));
+
+  lineBegin = position;
+  lineEnd = (newline == NULL) ? end : newline;
+  while (lineBegin < lineEnd && std::isspace((unsigned char) *lineBegin))
+    ++lineBegin;
+  while (lineEnd > lineBegin && std::isspace((unsigned char) *(lineEnd - 1)))
+    --lineEnd;
+
+  return (newline == NULL) ? end : newline + 1;
+}
+
+bool CSVParser::ParseFloat(const char* begin, const char* end, double& value)
+{
+  // The powers of 10 that are exactly representable as doubles.
+  static const double powers[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7,
+      1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19,
+      1e20, 1e21, 1e22 };
+
+  const char* p = begin;
+  bool negative = false;
+  if (p != end && (*p == '-' || *p == '+'))
+  {
+    negative = (*p == '-');
+    ++p;
+  }
+
+  // strtod() reads "nan", "inf" and "infinity" in any case, so do the same.
+  if (p != end && (*p == 'n' || *p == 'N' || *p == 'i' || *p == 'I'))
+  {
+    if (EqualsLowercase(p, end, "nan"))
+    {
+      value = std::numeric_limits<double>::quiet_NaN();
+      return true;
+    }
+    else if (EqualsLowercase(p, end, "inf") ||
+             EqualsLowercase(p, end, "infinity"))
+    {
+      value = negative ? -std::numeric_limits<double>::infinity() :
+          std::numeric_limits<double>::infinity();
+      return true;
+    }
+
+    return false;
+  }
+
+  // Read up to 19 significant digits, which always fit in 64 bits.
+  unsigned long long mantissa = 0;
+  int exponent = 0;
+  size_t digits = 0;
+  bool anyDigits = false;
+  bool truncated = false;
+  for (; p != end && *p >= '0' && *p <= '9'; ++p)
+  {
+    anyDigits = true;
+    if (digits < 19)
+    {
+      mantissa = 10 * mantissa + (*p - '0');
+      if (mantissa != 0)
+        ++digits;
+    }
+    else
+    {
+      truncated = true;
+    }
+  }
+
+  if (p != end && *p == '.')
+  {
+    for (++p; p != end && *p >= '0' && *p <= '9'; ++p)
+    {
+      anyDigits = true;
+      if (digits < 19)
+      {
+        mantissa = 10 * mantissa + (*p - '0');
+        if (mantissa != 0)
+          ++digits;
+        --exponent;
+      }
+      else
+      {
+        truncated = true;
+      }
+    }
+  }
+
+  if (!anyDigits)
+    return false;
+
+  if (p != end && (*p == 'e' || *p == 'E'))
+  {
+    ++p;
+    bool negativeExponent = false;
+    if (p != end && (*p == '-' || *p == '+'))
+    {
+      negativeExponent = (*p == '-');
+      ++p;
+    }
+
+    if (p == end || *p < '0' || *p > '9')
+      return false;
+
+    int e = 0;
+    for (; p != end && *p >= '0' && *p <= '9'; ++p)
+    {
+      if (e < 100000)
+        e = 10 * e + (*p - '0');
+    }
+    exponent += negativeExponent ? -e : e;
+  }
+
+  if (p != end)
+    return false;
+
+  // If the mantissa and the power of 10 are both exact, their product or
+  // quotient is correctly rounded.
+  if (!truncated && mantissa <= (1ULL << 53) && exponent >= -22 &&
+      exponent <= 22)
+  {
+    double result = double(mantissa);
+    result = (exponent < 0) ? result / powers[-exponent] :
+        result * powers[exponent];
+    value = negative ? -result : result;
+    return true;
+  }
+
+  // Otherwise let strtod() round correctly.
+  const std::string token(begin, end);
+  value = std::strtod(token.c_str(), NULL);
+  return true;
+}
+
+bool CSVParser::ParseInteger(const char* begin,
+                             const char* end,
+                             const bool negative,
+                             long long& value)
+{
+  const char* p = begin;
+  bool isNegative = false;
+  if (negative && p != end && *p == '-')
+  {
+    isNegative = true;
+    ++p;
+  }
+
+  if (p == end || end - p > 18)
+    return false;
+
+  long long result = 0;
+  for (; p != end; ++p)
+  {
+    if (*p < '0' || *p > '9')
+      return false;
+    result = 10 * result + (*p - '0');
+  }
+
+  value = isNegative ? -result : result;
+  return true;
+}
+
+bool CSVParser::ParseSpecial(const char* begin,
+                             const char* end,
+                             double& value)
+{
+  if (begin == end)
+    return false;
+
+  const std::string token(begin, end);
+  char* last;
+  value = std::strtod(token.c_str(), &last);
+  return (last == token.c_str() + token.size());
+}
+
+void CSVParser::FieldsError(const size_t fields, const size_t line) const
+{
+  std::ostringstream oss;
+  oss << "CSVParser: wrong number of dimensions (" << fields << ") on "
+      << "line " << line << " of '" << file.Filename() << "'; should be "
+      << numFields << " dimensions.";
+  throw std::runtime_error(oss.str());
+}
@@ -0,0 +1,283 @@
+/**
+ * @file csv_parser.hpp
+ *
+ * A parallel parser of CSV, TSV and whitespace-separated text files, which
+ * maps the file into memory and parses it in chunks.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_CSV_PARSER_HPP
+#define MLPACK_CORE_DATA_CSV_PARSER_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/util/log.hpp>
+
+#include "dataset_mapper.hpp"
+#include "mapped_file.hpp"
+
+namespace mlpack {
+namespace data {
+
+/**
+ * CSVParser loads delimited text files into a matrix in parallel.  The file is
+ * mapped into memory with MappedFile and split into chunks at line
+ * boundaries.  A first pass counts the lines of each chunk (which only looks
+ * for newlines), so that each chunk knows the column of the matrix its first
+ * line goes to; then the chunks are parsed in parallel (with OpenMP) and the
+ * values are written straight into the final matrix, so no transpose is
+ * needed.
+ *
+ * Each line (a point, when loading transposed) is split at the separator, and
+ * whitespace around each field is ignored; blank lines are skipped.  Every
+ * line must have the same number of fields as the first one; otherwise, a
+ * std::runtime_error is thrown.
+ *
+ * Numbers are read with a parser of plain decimal numbers, which computes the
+ * value exactly when the digits and the exponent are small enough (as most
+ * values of a CSV are) and hands the token to strtod() otherwise.
+ *
+ * With a DatasetMapper, a dimension that has a token that is not a number is
+ * passed to the MapPolicy: each chunk collects the distinct strings of such
+ * dimensions in a dictionary of its own, the dictionaries are merged in file
+ * order (so the mappings are the same as a serial load would give), and the
+ * mapped values are written back in parallel.  Files without such dimensions
+ * are parsed once.
+ */
+class CSVParser
+{
+ public:
+  //! The separator between the fields of a line.
+  enum SeparatorType
+  {
+    COMMA,     //!< Fields separated by ','.
+    TAB,       //!< Fields separated by '\t'.
+    WHITESPACE //!< Fields separated by runs of spaces and tabs.
+  };
+
+  /**
+   * Map the given file, split it into chunks and count the lines of each
+   * chunk.  By default, there are a few chunks per thread (so that a thread
+   * that is done early can take another one), of at least a megabyte each.  A
+   * std::runtime_error is thrown if the file cannot be mapped.
+   *
+   * @param filename Name of the file to parse.
+   * @param separator Separator between the fields of a line.
+   * @param numChunks Number of chunks to split the file into (0 to choose
+   *     it from the number of threads and the size of the file).
+   */
+  CSVParser(const std::string& filename,
+            const SeparatorType separator,
+            const size_t numChunks = 0);
+
+  /**
+   * Parse the given mapped file (for instance, a compressed file that was
+   * already decompressed), which the parser takes.
+   *
+   * @param mappedFile Mapped file to parse.
+   * @param separator Separator between the fields of a line.
+   * @param numChunks Number of chunks to split the file into (0 to choose
+   *     it from the number of threads and the size of the file).
+   */
+  CSVParser(MappedFile&& mappedFile,
+            const SeparatorType separator,
+            const size_t numChunks = 0);
+
+  /**
+   * Parse the file into the given matrix.  Tokens that cannot be read as a
+   * number are set to 0 (as Armadillo does), and a warning is given.  When
+   * loading integers, floating-point tokens are truncated.
+   *
+   * @param matrix Matrix to load into.
+   * @param transpose If true, each line is a column of the matrix (default);
+   *     otherwise, each line is a row.
+   */
+  template<typename eT>
+  void Parse(arma::Mat<eT>& matrix, const bool transpose = true);
+
+  /**
+   * Parse the file into the given matrix, mapping the dimensions that are not
+   * numeric with the given DatasetMapper, which is re-initialized with the
+   * dimensionality of the file.  If transpose is true, each field is a
+   * dimension; otherwise, each line is (as with LoadCSV).
+   *
+   * @param matrix Matrix to load into.
+   * @param info DatasetMapper to use while loading.
+   * @param transpose If true, each line is a column of the matrix (default);
+   *     otherwise, each line is a row.
+   */
+  template<typename eT, typename PolicyType>
+  void Parse(arma::Mat<eT>& matrix,
+             DatasetMapper<PolicyType>& info,
+             const bool transpose = true);
+
+  /**
+   * Prepare the file to be read in blocks of the given number of lines (so
+   * that each block is a batch of points), with ParseBlock().  This records
+   * where each block starts, in parallel.
+   *
+   * @param blockSize Number of lines of each block (the last one may have
+   *     fewer lines).
+   */
+  void IndexBlocks(const size_t blockSize);
+
+  /**
+   * Parse the given block of lines (after IndexBlocks()) into the given
+   * matrix, one line per column.  If the matrix already has the size of the
+   * block, its memory is reused.  Only this block of the file is read, so
+   * blocks can be parsed as they are needed, in any order.
+   *
+   * @param block Index of the block to parse.
+   * @param matrix Matrix to load the block into.
+   */
+  template<typename eT>
+  void ParseBlock(const size_t block, arma::Mat<eT>& matrix) const;
+
+  //! Get the number of blocks given by IndexBlocks() (0 before it's called).
+  size_t NumBlocks() const { return blockStarts.size(); }
+
+  //! Get the number of (non-blank) lines of the file.
+  size_t NumLines() const { return numLines; }
+  //! Get the number of fields of each line.
+  size_t NumFields() const { return numFields; }
+  //! Get the number of chunks the file is parsed in.
+  size_t NumChunks() const { return chunks.size(); }
+
+  /**
+   * Read a decimal number (an optional sign, digits with an optional decimal
+   * point, and an optional exponent) that spans the whole token.  "nan",
+   * "inf" and "infinity" (in any case, with an optional sign) are read too.
+   * Other tokens (like hexadecimal numbers) are not read.
+   *
+   * @param begin Start of the token.
+   * @param end End of the token.
+   * @param value Variable to store the number into.
+   * @return Whether the token is a decimal number.
+   */
+  static bool ParseFloat(const char* begin, const char* end, double& value);
+
+  /**
+   * Read an integer (digits, with a '-' if negative is true) of at most 18
+   * digits that spans the whole token.
+   *
+   * @param begin Start of the token.
+   * @param end End of the token.
+   * @param negative Whether a leading '-' is allowed.
+   * @param value Variable to store the number into.
+   * @return Whether the token is such an integer.
+   */
+  static bool ParseInteger(const char* begin,
+                           const char* end,
+                           const bool negative,
+                           long long& value);
+
+ private:
+  //! A range of whole lines of the file.
+  struct Chunk
+  {
+    //! The first character of the chunk.
+    const char* begin;
+    //! One past the last character of the chunk.
+    const char* end;
+    //! The index of the first line of the chunk in the file.
+    size_t firstLine;
+    //! The number of (non-blank) lines of the chunk.
+    size_t numLines;
+  };
+
+  /**
+   * Find the line that starts at the given position, without surrounding
+   * whitespace, and return the position after it.
+   */
+  const char* NextLine(const char* position,
+                       const char* end,
+                       const char*& lineBegin,
+                       const char*& lineEnd) const;
+
+  /**
+   * Call f(chunk, index) for each chunk, in parallel.  An exception thrown by
+   * f() is thrown again once all the chunks are done.
+   */
+  template<typename FunctionType>
+  void ForEachChunk(FunctionType f);
+
+  /**
+   * Call f(line, begin, end) for each non-blank line of the chunk, with the
+   * index of the line in the chunk and the line without surrounding
+   * whitespace.
+   */
+  template<typename FunctionType>
+  void ForEachLine(const Chunk& chunk, FunctionType f) const;
+
+  /**
+   * Call f(field, begin, end) for each field of the line, with the field
+   * without surrounding whitespace, and return the number of fields.
+   */
+  template<typename FunctionType>
+  size_t SplitLine(const char* begin, const char* end, FunctionType f) const;
+
+  //! Read a token as a number of the given type.
+  template<typename eT>
+  static bool ParseToken(const char* begin, const char* end, eT& value)
+  {
+    return ParseToken(begin, end, value, std::is_floating_point<eT>());
+  }
+
+  //! Read a token as a floating-point number.
+  template<typename eT>
+  static bool ParseToken(const char* begin,
+                         const char* end,
+                         eT& value,
+                         std::true_type /* floating point */);
+
+  //! Read a token as an integer.
+  template<typename eT>
+  static bool ParseToken(const char* begin,
+                         const char* end,
+                         eT& value,
+                         std::false_type /* floating point */);
+
+  //! Read a token that ParseFloat() doesn't read with strtod(), which knows
+  //! hexadecimal numbers.
+  static bool ParseSpecial(const char* begin, const char* end, double& value);
+
+  /**
+   * Parse the numbers of the given line into values[0], values[stride], ...,
+   * and return the number of fields of the line.  Tokens that aren't numbers
+   * are set to 0, and counted in unread.
+   */
+  template<typename eT>
+  size_t ParseValues(const char* lineBegin,
+                     const char* lineEnd,
+                     eT* values,
+                     const size_t stride,
+                     size_t& unread) const;
+
+  //! Throw the error for a line with the wrong number of fields.
+  void FieldsError(const size_t fields, const size_t line) const;
+
+  //! The mapped file.
+  MappedFile file;
+  //! The separator between fields.
+  SeparatorType separator;
+  //! The chunks the file is parsed in.
+  std::vector<Chunk> chunks;
+  //! The number of (non-blank) lines of the file.
+  size_t numLines;
+  //! The number of fields of each line.
+  size_t numFields;
+  //! The number of lines of each block.
+  size_t blockSize;
+  //! The first line of each block.
+  std::vector<const char*> blockStarts;
+};
+
+} // namespace data
+} // namespace mlpack
+
+// Include implementation.
+#include "csv_parser_impl.hpp"
+
+#endif
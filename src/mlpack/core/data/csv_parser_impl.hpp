@@ -0,0 +1,423 @@
+/**
+ * @file csv_parser_impl.hpp
+ *
+ * Implementation of the templated parts of CSVParser.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_CSV_PARSER_IMPL_HPP
+#define MLPACK_CORE_DATA_CSV_PARSER_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "csv_parser.hpp"
+
+#include <cctype>
+#include <cstring>
+#include <map>
+#include <unordered_map>
+
+namespace mlpack {
+namespace data {
+
+template<typename eT>
+void CSVParser::Parse(arma::Mat<eT>& matrix, const bool transpose)
+{
+  if (transpose)
+    matrix.set_size(numFields, numLines);
+  else
+    matrix.set_size(numLines, numFields);
+
+  eT* values = matrix.memptr();
+  std::vector<size_t> unread(chunks.size(), 0);
+
+  ForEachChunk([&](Chunk& chunk, const size_t index)
+  {
+    ForEachLine(chunk, [&](const size_t localLine,
+                           const char* lineBegin,
+                           const char* lineEnd)
+    {
+      const size_t line = chunk.firstLine + localLine;
+      const size_t fields = transpose ?
+          ParseValues(lineBegin, lineEnd, values + line * numFields, 1,
+              unread[index]) :
+          ParseValues(lineBegin, lineEnd, values + line, numLines,
+              unread[index]);
+
+      if (fields != numFields)
+        FieldsError(fields, line + 1);
+    });
+  });
+
+  size_t totalUnread = 0;
+  for (size_t c = 0; c < chunks.size(); ++c)
+    totalUnread += unread[c];
+
+  if (totalUnread > 0)
+  {
+    Log::Warn << "CSVParser::Parse(): " << totalUnread << " values of '"
+        << file.Filename() << "' are not numbers and were set to 0."
+        << std::endl;
+  }
+}
+
+template<typename eT>
+void CSVParser::ParseBlock(const size_t block, arma::Mat<eT>& matrix) const
+{
+  if (block >= blockStarts.size())
+  {
+    std::ostringstream oss;
+    oss << "CSVParser::ParseBlock(): block " << block << " requested, but "
+        << "there are " << blockStarts.size() << " blocks";
+    throw std::invalid_argument(oss.str());
+  }
+
+  const size_t first = block * blockSize;
+  const size_t count = std::min(blockSize, numLines - first);
+  matrix.set_size(numFields, count);
+
+  const char* position = blockStarts[block];
+  const char* end = file.Memory() + file.Size();
+  size_t unread = 0;
+  for (size_t line = 0; line < count; )
+  {
+    const char* lineBegin;
+    const char* lineEnd;
+    position = NextLine(position, end, lineBegin, lineEnd);
+    if (lineBegin == lineEnd)
+      continue;
+
+    const size_t fields = ParseValues(lineBegin, lineEnd, matrix.colptr(line),
+        1, unread);
+    if (fields != numFields)
+      FieldsError(fields, first + line + 1);
+    ++line;
+  }
+
+  if (unread > 0)
+  {
+    Log::Warn << "CSVParser::ParseBlock(): " << unread << " values of '"
+        << file.Filename() << "' are not numbers and were set to 0."
+        << std::endl;
+  }
+}
+
+template<typename eT, typename PolicyType>
+void CSVParser::Parse(arma::Mat<eT>& matrix,
+                      DatasetMapper<PolicyType>& info,
+                      const bool transpose)
+{
+  const size_t dimensionality = transpose ? numFields : numLines;
+  info = DatasetMapper<PolicyType>(dimensionality);
+
+  if (transpose)
+    matrix.set_size(numFields, numLines);
+  else
+    matrix.set_size(numLines, numFields);
+
+  eT* values = matrix.memptr();
+
+  // First read the numbers, and mark the dimensions that have a token that
+  // isn't one.  The marks of a chunk are indexed by field when transposing, and
+  // by the lines of the chunk otherwise.
+  std::vector<std::vector<char>> marks(chunks.size());
+  ForEachChunk([&](Chunk& chunk, const size_t index)
+  {
+    std::vector<char>& mark = marks[index];
+    mark.assign(transpose ? numFields : chunk.numLines, 0);
+
+    ForEachLine(chunk, [&](const size_t localLine,
+                           const char* lineBegin,
+                           const char* lineEnd)
+    {
+      const size_t line = chunk.firstLine + localLine;
+      const size_t fields = SplitLine(lineBegin, lineEnd,
+          [&](const size_t field, const char* begin, const char* end)
+      {
+        if (field >= numFields)
+          return;
+
+        eT& value = transpose ? values[line * numFields + field] :
+            values[field * numLines + line];
+        if (!ParseToken(begin, end, value))
+        {
+          value = eT(0);
+          mark[transpose ? field : localLine] = 1;
+        }
+      });
+
+      if (fields != numFields)
+        FieldsError(fields, line + 1);
+    });
+  });
+
+  std::vector<char> mapped(dimensionality, 0);
+  bool anyMapped = false;
+  for (size_t c = 0; c < chunks.size(); ++c)
+  {
+    for (size_t i = 0; i < marks[c].size(); ++i)
+    {
+      if (marks[c][i])
+      {
+        mapped[transpose ? i : chunks[c].firstLine + i] = 1;
+        anyMapped = true;
+      }
+    }
+  }
+
+  if (!anyMapped)
+    return;
+
+  // The distinct strings of a dimension in a chunk (in the order they first
+  // appear), and where each token of the dimension goes in the matrix.
+  struct Dictionary
+  {
+    StringMap<size_t> strings;
+    std::vector<std::pair<size_t, size_t>> uses;
+    std::vector<eT> values;
+  };
+
+  // Collect the tokens of the mapped dimensions of each chunk.
+  std::vector<std::map<size_t, Dictionary>> dictionaries(chunks.size());
+  ForEachChunk([&](Chunk& chunk, const size_t index)
+  {
+    std::map<size_t, Dictionary>& local = dictionaries[index];
+    ForEachLine(chunk, [&](const size_t localLine,
+                           const char* lineBegin,
+                           const char* lineEnd)
+    {
+      const size_t line = chunk.firstLine + localLine;
+      if (!transpose && !mapped[line])
+        return;
+
+      SplitLine(lineBegin, lineEnd,
+          [&](const size_t field, const char* begin, const char* end)
+      {
+        const size_t dimension = transpose ? field : line;
+        if (!mapped[dimension])
+          return;
+
+        Dictionary& dictionary = local[dimension];
+        const size_t id = dictionary.strings.Insert(begin, end - begin, 0);
+        dictionary.uses.emplace_back(transpose ? line * numFields + field :
+            field * numLines + line, id);
+      });
+    });
+  });
+
+  // Pass the strings to the DatasetMapper in file order, so that the mappings
+  // are the same as those of a serial load.
+  if (PolicyType::NeedsFirstPass)
+  {
+    for (size_t c = 0; c < chunks.size(); ++c)
+      for (auto& entry : dictionaries[c])
+        for (size_t i = 0; i < entry.second.strings.Size(); ++i)
+          info.template MapFirstPass<eT>(entry.second.strings.String(i),
+              entry.first);
+  }
+
+  for (size_t c = 0; c < chunks.size(); ++c)
+  {
+    for (auto& entry : dictionaries[c])
+    {
+      Dictionary& dictionary = entry.second;
+      dictionary.values.resize(dictionary.strings.Size());
+      for (size_t i = 0; i < dictionary.strings.Size(); ++i)
+      {
+        dictionary.values[i] = info.template MapString<eT>(
+            dictionary.strings.String(i), entry.first);
+      }
+    }
+  }
+
+  // Now write the mapped values.
+  ForEachChunk([&](Chunk& /* chunk */, const size_t index)
+  {
+    for (auto& entry : dictionaries[index])
+    {
+      const Dictionary& dictionary = entry.second;
+      for (size_t i = 0; i < dictionary.uses.size(); ++i)
+      {
+        values[dictionary.uses[i].first] =
+            dictionary.values[dictionary.uses[i].second];
+      }
+    }
+  });
+}
+
+template<typename eT>
+size_t CSVParser::ParseValues(const char* lineBegin,
+                              const char* lineEnd,
+                              eT* values,
+                              const size_t stride,
+                              size_t& unread) const
+{
+  return SplitLine(lineBegin, lineEnd,
+      [&](const size_t field, const char* begin, const char* end)
+  {
+    if (field >= numFields)
+      return;
+
+    eT& value = values[field * stride];
+    if (ParseToken(begin, end, value))
+      return;
+
+    // Integers written as floating-point numbers (like labels saved from a
+    // floating-point matrix) are truncated.
+    double special;
+    if (ParseSpecial(begin, end, special) &&
+        (std::is_floating_point<eT>::value ||
+        (special >= (double) std::numeric_limits<eT>::min() &&
+         special < (double) std::numeric_limits<eT>::max())))
+    {
+      value = eT(special);
+    }
+    else
+    {
+      value = eT(0);
+      ++unread;
+    }
+  });
+}
+
+template<typename FunctionType>
+void CSVParser::ForEachChunk(FunctionType f)
+{
+  // Exceptions can't leave an OpenMP region, so each chunk keeps its own, and
+  // the first one in file order is thrown afterwards.
+  std::vector<std::string> errors(chunks.size());
+  std::vector<char> failed(chunks.size(), 0);
+
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables. If we're building for Visual Studio, use
+  // the intmax_t type instead.
+  #pragma omp parallel for schedule(dynamic)
+  for (intmax_t c = 0; c < (intmax_t) chunks.size(); ++c)
+#else
+  #pragma omp parallel for schedule(dynamic)
+  for (size_t c = 0; c < chunks.size(); ++c)
+#endif
+  {
+    try
+    {
+      f(chunks[c], (size_t) c);
+    }
+    catch (std::exception& e)
+    {
+      failed[c] = 1;
+      errors[c] = e.what();
+    }
+  }
+
+  for (size_t c = 0; c < chunks.size(); ++c)
+    if (failed[c])
+      throw std::runtime_error(errors[c]);
+}
+
+template<typename FunctionType>
+void CSVParser::ForEachLine(const Chunk& chunk, FunctionType f) const
+{
+  size_t line = 0;
+  const char* position = chunk.begin;
+  while (position < chunk.end)
+  {
+    const char* lineBegin;
+    const char* lineEnd;
+    position = NextLine(position, chunk.end, lineBegin, lineEnd);
+    if (lineBegin != lineEnd)
+      f(line++, lineBegin, lineEnd);
+  }
+}
+
+template<typename FunctionType>
+size_t CSVParser::SplitLine(const char* begin,
+                            const char* end,
+                            FunctionType f) const
+{
+  size_t field = 0;
+  if (separator == WHITESPACE)
+  {
+    const char* p = begin;
+    while (p < end)
+    {
+      while (p < end && std::isspace((unsigned char) *p))
+        ++p;
+      if (p == end)
+        break;
+
+      const char* tokenBegin = p;
+      while (p < end && !std::isspace((unsigned char) *p))
+        ++p;
+      f(field++, tokenBegin, p);
+    }
+
+    return field;
+  }
+
+  // A separator at the end of the line is followed by an empty field.
+  const char delimiter = (separator == COMMA) ? ',' : '\t';
+  const char* p = begin;
+  while (true)
+  {
+    const char* next = static_cast<const char*>(
+        std::memchr(p, delimiter, end - p));
+    const char* tokenEnd = (next == NULL) ? end : next;
+
+    const char* tokenBegin = p;
+    while (tokenBegin < tokenEnd && std::isspace((unsigned char) *tokenBegin))
+      ++tokenBegin;
+    while (tokenEnd > tokenBegin &&
+           std::isspace((unsigned char) *(tokenEnd - 1)))
+      --tokenEnd;
+    f(field++, tokenBegin, tokenEnd);
+
+    if (next == NULL)
+      break;
+    p = next + 1;
+  }
+
+  return field;
+}
+
+template<typename eT>
+bool CSVParser::ParseToken(const char* begin,
+                           const char* end,
+                           eT& value,
+                           std::true_type /* floating point */)
+{
+  double result;
+  if (!ParseFloat(begin, end, result))
+    return false;
+
+  value = eT(result);
+  return true;
+}
+
+template<typename eT>
+bool CSVParser::ParseToken(const char* begin,
+                           const char* end,
+                           eT& value,
+                           std::false_type /* floating point */)
+{
+  long long result;
+  if (!ParseInteger(begin, end, std::is_signed<eT>::value, result))
+    return false;
+
+  // The token must fit in the type.
+  if ((result < 0) ?
+      (result < (long long) std::numeric_limits<eT>::min()) :
+      ((unsigned long long) result >
+       (unsigned long long) std::numeric_limits<eT>::max()))
+    return false;
+
+  value = eT(result);
+  return true;
+}
+
+} // namespace data
+} // namespace mlpack
+
+#endif
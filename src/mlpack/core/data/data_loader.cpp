@@ -0,0 +1,240 @@
+/**
+ * @file data_loader.cpp
+ *
+ * Implementation of DataLoader.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "data_loader.hpp"
+#include "load.hpp"
+
+#include <mlpack/core/math/random.hpp>
+
+#include <algorithm>
+#include <random>
+
+using namespace mlpack;
+using namespace mlpack::data;
+
+DataLoader::DataLoader(const std::vector<std::string>& shards,
+                       const size_t batchSize,
+                       const ReaderType& reader,
+                       const TransformType& transform,
+                       const size_t threads,
+                       const size_t queueSize,
+                       const bool shuffle) :
+    shards(shards),
+    batchSize(batchSize),
+    reader(reader),
+    transform(transform),
+    threads(threads),
+    queueSize(queueSize),
+    shuffle(shuffle),
+    epoch(0),
+    epochSeed(0),
+    nextShard(0),
+    finishedWorkers(0),
+    stop(false)
+{
+  if (shards.empty())
+    throw std::invalid_argument("DataLoader::DataLoader(): no shards given");
+
+  if (batchSize == 0)
+  {
+    throw std::invalid_argument("DataLoader::DataLoader(): the batch size "
+        "must be positive");
+  }
+
+  if (threads == 0 || queueSize == 0)
+  {
+    throw std::invalid_argument("DataLoader::DataLoader(): the number of "
+        "threads and the queue size must be positive");
+  }
+
+  if (!reader)
+    throw std::invalid_argument("DataLoader::DataLoader(): no reader given");
+}
+
+DataLoader::~DataLoader()
+{
+  Stop();
+}
+
+bool DataLoader::Next(arma::mat& predictors, arma::mat& responses)
+{
+  if (workers.empty())
+    Start();
+
+  std::unique_lock<std::mutex> lock(mutex);
+  ready.wait(lock, [this]() { return !queue.empty() || error ||
+      finishedWorkers == workers.size(); });
+
+  if (error)
+  {
+    std::exception_ptr workerError = error;
+    lock.unlock();
+    Stop();
+    std::rethrow_exception(workerError);
+  }
+
+  if (queue.empty())
+  {
+    // Every shard has been read, and every batch returned.
+    lock.unlock();
+    Stop();
+    return false;
+  }
+
+  predictors = std::move(queue.front().first);
+  responses = std::move(queue.front().second);
+  queue.pop_front();
+  lock.unlock();
+  space.notify_one();
+
+  return true;
+}
+
+DataLoader::ReaderType DataLoader::SplitReader(const size_t responseRows)
+{
+  return [responseRows](const std::string& filename, arma::mat& predictors,
+      arma::mat& responses)
+  {
+    arma::mat shard;
+    if (!data::Load(filename, shard))
+    {
+      std::ostringstream oss;
+      oss << "DataLoader::SplitReader(): cannot load shard '" << filename
+          << "'";
+      throw std::runtime_error(oss.str());
+    }
+
+    if (shard.n_rows <= responseRows)
+    {
+      std::ostringstream oss;
+      oss << "DataLoader::SplitReader(): shard '" << filename << "' has "
+          << shard.n_rows << " rows, but " << responseRows << " rows of "
+          << "responses are expected after the predictors";
+      throw std::invalid_argument(oss.str());
+    }
+
+    const size_t predictorRows = shard.n_rows - responseRows;
+    responses = shard.rows(predictorRows, shard.n_rows - 1);
+    shard.shed_rows(predictorRows, shard.n_rows - 1);
+    predictors = std::move(shard);
+  };
+}
+
+void DataLoader::Start()
+{
+  // The orders are drawn on the calling thread, so that they only depend on
+  // the seed of mlpack's generator.
+  ++epoch;
+  order.resize(shards.size());
+  for (size_t i = 0; i < order.size(); ++i)
+    order[i] = i;
+
+  if (shuffle)
+    std::shuffle(order.begin(), order.end(), math::randGen);
+  epochSeed = math::randGen();
+
+  nextShard = 0;
+  finishedWorkers = 0;
+  stop = false;
+  error = std::exception_ptr();
+  queue.clear();
+
+  for (size_t i = 0; i < std::min(threads, shards.size()); ++i)
+    workers.push_back(std::thread(&DataLoader::Work, this));
+}
+
+void DataLoader::Stop()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stop = true;
+  }
+  space.notify_all();
+
+  for (size_t i = 0; i < workers.size(); ++i)
+    workers[i].join();
+
+  workers.clear();
+  queue.clear();
+}
+
+void DataLoader::Work()
+{
+  try
+  {
+    while (true)
+    {
+      size_t shard;
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stop || nextShard == order.size())
+          break;
+
+        shard = order[nextShard++];
+      }
+
+      arma::mat predictors, responses;
+      reader(shards[shard], predictors, responses);
+      if (predictors.n_cols != responses.n_cols)
+      {
+        std::ostringstream oss;
+        oss << "DataLoader::Next(): shard '" << shards[shard] << "' has "
+            << predictors.n_cols << " predictors but " << responses.n_cols
+            << " responses";
+        throw std::invalid_argument(oss.str());
+      }
+
+      // Each shard has its own generator, so the order of its points doesn't
+      // depend on which thread reads it.
+      arma::uvec points(predictors.n_cols);
+      for (size_t i = 0; i < points.n_elem; ++i)
+        points[i] = i;
+
+      if (shuffle)
+      {
+        std::mt19937 generator(epochSeed + shard);
+        std::shuffle(points.begin(), points.end(), generator);
+      }
+
+      for (size_t begin = 0; begin < points.n_elem; begin += batchSize)
+      {
+        const arma::uvec batchPoints = points.subvec(begin,
+            std::min(begin + batchSize, (size_t) points.n_elem) - 1);
+        arma::mat batchPredictors = predictors.cols(batchPoints);
+        arma::mat batchResponses = responses.cols(batchPoints);
+        if (transform)
+          transform(batchPredictors, batchResponses);
+
+        std::unique_lock<std::mutex> lock(mutex);
+        space.wait(lock, [this]() { return stop ||
+            queue.size() < queueSize; });
+        if (stop)
+          break;
+
+        queue.emplace_back(std::move(batchPredictors),
+            std::move(batchResponses));
+        lock.unlock();
+        ready.notify_one();
+      }
+    }
+  }
+  catch (...)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!error)
+      error = std::current_exception();
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    ++finishedWorkers;
+  }
+  ready.notify_all();
+}
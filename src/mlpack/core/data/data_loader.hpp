@@ -0,0 +1,204 @@
+/**
+ * @file data_loader.hpp
+ *
+ * A loader that reads a dataset held on disk as a set of shards in the
+ * background, and hands it out as a stream of shuffled batches.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_DATA_LOADER_HPP
+#define MLPACK_CORE_DATA_DATA_LOADER_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace mlpack {
+namespace data {
+
+/**
+ * DataLoader streams a dataset that is too large to fit in memory.  The
+ * dataset is given as a list of files (shards), each holding some of the
+ * points; a reader function turns a shard into a matrix of predictors and a
+ * matrix of responses (one point per column), so the shards can be in any
+ * format, and decoding happens as they are read.
+ *
+ * Each pass over the dataset (an epoch) visits the shards in a random order.
+ * Background threads read the shards, shuffle the points of each shard, cut
+ * them into batches, apply an optional transformation to each batch (for
+ * instance, normalization), and push the batches into a bounded queue.  Next()
+ * pops the next ready batch, so reading and preprocessing overlap with
+ * whatever the caller does with the batches, and at most the queued batches
+ * plus one shard per thread are held in memory.
+ *
+ * @code
+ * std::vector<std::string> shards = { "train_0.bin", "train_1.bin" };
+ * // Each shard holds 784 rows of pixels followed by one row of labels.
+ * DataLoader loader(shards, 1024, DataLoader::SplitReader(1),
+ *     [](arma::mat& predictors, arma::mat&) { predictors /= 255.0; });
+ *
+ * arma::mat predictors, responses;
+ * while (loader.Next(predictors, responses))
+ * {
+ *   // ... use the batch ...
+ * }
+ * @endcode
+ *
+ * When Next() returns false the epoch is over, and the following call to
+ * Next() starts a new epoch (with a new order of shards and points).  The
+ * orders are drawn from mlpack's random number generator, so with one thread
+ * the sequence of batches is reproducible after math::RandomSeed(); with more
+ * threads, the batches of the shards being read at once are interleaved in
+ * the order they become ready.  An exception thrown while a shard is read (by
+ * the reader, or because the predictors and responses of a shard don't have
+ * the same number of points) stops the epoch and is rethrown by Next().
+ */
+class DataLoader
+{
+ public:
+  //! The type of the functions that read a shard into predictors and
+  //! responses.
+  typedef std::function<void(const std::string&, arma::mat&, arma::mat&)>
+      ReaderType;
+
+  //! The type of the functions that transform the predictors and responses of
+  //! a batch in place.
+  typedef std::function<void(arma::mat&, arma::mat&)> TransformType;
+
+  /**
+   * Create the loader for the given shards.  Nothing is read until the first
+   * call to Next().
+   *
+   * @param shards Files holding the shards of the dataset.
+   * @param batchSize Number of points of each batch (the last batch of each
+   *     shard may hold fewer points).
+   * @param reader Function that reads a shard.
+   * @param transform Function applied to each batch (none if empty).
+   * @param threads Number of background threads that read shards.
+   * @param queueSize Maximum number of ready batches.
+   * @param shuffle Whether to shuffle the shards and the points of each shard.
+   */
+  DataLoader(const std::vector<std::string>& shards,
+             const size_t batchSize,
+             const ReaderType& reader,
+             const TransformType& transform = TransformType(),
+             const size_t threads = 2,
+             const size_t queueSize = 8,
+             const bool shuffle = true);
+
+  //! Stop the background threads.
+  ~DataLoader();
+
+  //! The loader can't be copied, since it owns its threads.
+  DataLoader(const DataLoader&) = delete;
+  DataLoader& operator=(const DataLoader&) = delete;
+
+  /**
+   * Get the next batch of the epoch, waiting for it if it isn't ready yet.
+   * If the epoch is over, false is returned and the matrices are left
+   * unchanged; the next call starts a new epoch.
+   *
+   * @param predictors Predictors of the batch (one point per column).
+   * @param responses Responses of the batch (one point per column).
+   * @return Whether a batch was returned.
+   */
+  bool Next(arma::mat& predictors, arma::mat& responses);
+
+  /**
+   * Return a reader for shards that data::Load() can load, where the last
+   * rows of each shard are the responses and the others are the predictors.
+   *
+   * @param responseRows Number of rows of the responses.
+   */
+  static ReaderType SplitReader(const size_t responseRows);
+
+  //! Get the shards of the dataset.
+  const std::vector<std::string>& Shards() const { return shards; }
+
+  //! Get the number of points of each batch.
+  size_t BatchSize() const { return batchSize; }
+
+  //! Get the number of the current epoch (the first epoch is 1), or 0 before
+  //! the first call to Next().
+  size_t Epoch() const { return epoch; }
+
+ private:
+  //! Start the threads of a new epoch.
+  void Start();
+
+  //! Stop the threads of the current epoch, and wait for them.
+  void Stop();
+
+  //! Read shards and push their batches until the epoch is over.
+  void Work();
+
+  //! The shards of the dataset.
+  std::vector<std::string> shards;
+
+  //! The number of points of each batch.
+  size_t batchSize;
+
+  //! The function that reads a shard.
+  ReaderType reader;
+
+  //! The function applied to each batch.
+  TransformType transform;
+
+  //! The number of background threads.
+  size_t threads;
+
+  //! The maximum number of ready batches.
+  size_t queueSize;
+
+  //! Whether to shuffle the shards and the points.
+  bool shuffle;
+
+  //! The number of the current epoch.
+  size_t epoch;
+
+  //! The order of the shards in the current epoch.
+  std::vector<size_t> order;
+
+  //! The seed of the order of the points of each shard in the current epoch.
+  size_t epochSeed;
+
+  //! The position of the next shard to read in the order.
+  size_t nextShard;
+
+  //! The background threads of the current epoch.
+  std::vector<std::thread> workers;
+
+  //! The number of threads that have no shards left to read.
+  size_t finishedWorkers;
+
+  //! Whether the threads should stop.
+  bool stop;
+
+  //! The first exception thrown by a thread.
+  std::exception_ptr error;
+
+  //! The ready batches.
+  std::deque<std::pair<arma::mat, arma::mat>> queue;
+
+  //! The lock of the state shared with the threads.
+  std::mutex mutex;
+
+  //! Signalled when a batch is pushed or a thread finishes.
+  std::condition_variable ready;
+
+  //! Signalled when a batch is popped or the threads should stop.
+  std::condition_variable space;
+};
+
+} // namespace data
+} // namespace mlpack
+
+#endif
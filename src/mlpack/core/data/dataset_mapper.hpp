@@ -17,8 +17,8 @@
 
 #include <mlpack/prereqs.hpp>
 #include <unordered_map>
-#include <boost/bimap.hpp>
 
+#include "string_map.hpp"
 #include "map_policies/increment_policy.hpp"
 
 namespace mlpack {
@@ -77,12 +77,13 @@ class DatasetMapper
   /**
    * Return the string that corresponds to a given value in a given dimension.
    * If the string is not a valid mapping in the given dimension, a
-   * std::invalid_argument is thrown.
+   * std::invalid_argument is thrown.  The strings are stored together in one
+   * buffer, so a copy of the string is returned.
    *
    * @param value Mapped value for string.
    * @param dimension Dimension to unmap string from.
    */
-  const std::string& UnmapString(const size_t value, const size_t dimension);
+  std::string UnmapString(const size_t value, const size_t dimension);
 
 
   /**
@@ -119,11 +120,7 @@ class DatasetMapper
    * Serialize the dataset information.
    */
   template<typename Archive>
-  void Serialize(Archive& ar, const unsigned int /* version */)
-  {
-    ar & data::CreateNVP(types, "types");
-    ar & data::CreateNVP(maps, "maps");
-  }
+  void Serialize(Archive& ar, const unsigned int version);
 
   //! Return the policy of the mapper.
   const PolicyType& Policy() const;
@@ -137,13 +134,13 @@ class DatasetMapper
   //! Types of each dimension.
   std::vector<Datatype> types;
 
-  // BiMapType definition
-  using BiMapType = boost::bimap<std::string, typename PolicyType::MappedType>;
+  // StringMapType definition
+  using StringMapType = StringMap<typename PolicyType::MappedType>;
 
   // Mappings from strings to integers.
   // Map entries will only exist for dimensions that are categorical.
-  // MapType = map<dimension, pair<bimap<string, MappedType>, numMappings>>
-  using MapType = std::unordered_map<size_t, std::pair<BiMapType, size_t>>;
+  // MapType = map<dimension, pair<StringMap<MappedType>, numMappings>>
+  using MapType = std::unordered_map<size_t, std::pair<StringMapType, size_t>>;
 
   //! maps object stores string and numerical pairs.
   MapType maps;
@@ -159,6 +156,10 @@ using DatasetInfo = DatasetMapper<data::IncrementPolicy>;
 } // namespace data
 } // namespace mlpack
 
+//! Set the serialization version of the DatasetMapper class.
+BOOST_TEMPLATE_CLASS_VERSION(template<typename PolicyType>,
+    mlpack::data::DatasetMapper<PolicyType>, 1);
+
 #include "dataset_mapper_impl.hpp"
 
 #endif
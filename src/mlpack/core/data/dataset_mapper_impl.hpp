@@ -16,6 +16,11 @@
 // In case it hasn't already been included.
 #include "dataset_mapper.hpp"
 
+#include <algorithm>
+
+// Only needed to load mappings saved by older versions.
+#include <boost/bimap.hpp>
+
 namespace mlpack {
 namespace data {
 
@@ -81,12 +86,14 @@ inline T DatasetMapper<PolicyType>::MapString(const std::string& string,
 
 // Return the string corresponding to a value in a given dimension.
 template<typename PolicyType>
-inline const std::string& DatasetMapper<PolicyType>::UnmapString(
+inline std::string DatasetMapper<PolicyType>::UnmapString(
     const size_t value,
     const size_t dimension)
 {
   // Throw an exception if the value doesn't exist.
-  if (maps[dimension].first.right.count(value) == 0)
+  const StringMapType& map = maps[dimension].first;
+  const size_t index = map.FindValue(value);
+  if (index == map.Size())
   {
     std::ostringstream oss;
     oss << "DatasetMapper<PolicyType>::UnmapString(): value '" << value
@@ -94,7 +101,7 @@ inline const std::string& DatasetMapper<PolicyType>::UnmapString(
     throw std::invalid_argument(oss.str());
   }
 
-  return maps[dimension].first.right.at(value);
+  return map.String(index);
 }
 
 // Return the value corresponding to a string in a given dimension.
@@ -104,7 +111,9 @@ inline typename PolicyType::MappedType DatasetMapper<PolicyType>::UnmapValue(
     const size_t dimension)
 {
   // Throw an exception if the value doesn't exist.
-  if (maps[dimension].first.left.count(string) == 0)
+  const typename PolicyType::MappedType* value =
+      maps[dimension].first.Find(string);
+  if (value == NULL)
   {
     std::ostringstream oss;
     oss << "DatasetMapper<PolicyType>::UnmapValue(): string '" << string
@@ -112,7 +121,7 @@ inline typename PolicyType::MappedType DatasetMapper<PolicyType>::UnmapValue(
     throw std::invalid_argument(oss.str());
   }
 
-  return maps[dimension].first.left.at(string);
+  return *value;
 }
 
 // Get the type of a particular dimension.
@@ -152,6 +161,61 @@ inline size_t DatasetMapper<PolicyType>::Dimensionality() const
   return types.size();
 }
 
+template<typename PolicyType>
+template<typename Archive>
+void DatasetMapper<PolicyType>::Serialize(Archive& ar,
+                                          const unsigned int version)
+{
+  ar & data::CreateNVP(types, "types");
+
+  if (version == 0)
+  {
+    // Older versions held the mappings of each dimension in a boost::bimap;
+    // insert them in the order of their values.
+    using BiMapType = boost::bimap<std::string,
+        typename PolicyType::MappedType>;
+    std::unordered_map<size_t, std::pair<BiMapType, size_t>> oldMaps;
+    ar & data::CreateNVP(oldMaps, "maps");
+
+    maps.clear();
+    for (auto& oldMap : oldMaps)
+    {
+      std::pair<StringMapType, size_t>& map = maps[oldMap.first];
+      for (auto it = oldMap.second.first.right.begin();
+           it != oldMap.second.first.right.end(); ++it)
+        map.first.Insert(it->second, it->first);
+      map.second = oldMap.second.second;
+    }
+
+    return;
+  }
+
+  // Save the dimensions in order, so that archives are the same every time.
+  std::vector<size_t> dimensions;
+  if (Archive::is_saving::value)
+  {
+    for (auto& map : maps)
+      dimensions.push_back(map.first);
+    std::sort(dimensions.begin(), dimensions.end());
+  }
+
+  size_t numMaps = dimensions.size();
+  ar & data::CreateNVP(numMaps, "numMaps");
+  if (Archive::is_loading::value)
+  {
+    maps.clear();
+    dimensions.resize(numMaps);
+  }
+
+  for (size_t i = 0; i < numMaps; ++i)
+  {
+    ar & data::CreateNVP(dimensions[i], "dimension");
+    std::pair<StringMapType, size_t>& map = maps[dimensions[i]];
+    ar & data::CreateNVP(map.first, "mappings");
+    ar & data::CreateNVP(map.second, "numMappings");
+  }
+}
+
 template<typename PolicyType>
 inline const PolicyType& DatasetMapper<PolicyType>::Policy() const
 {
@@ -22,7 +22,8 @@ enum format
   autodetect,
   text,
   xml,
-  binary
+  binary,
+  native //!< Aligned binary archive for the same machine (native_archive.hpp).
 };
 
 } // namespace data
@@ -71,6 +71,48 @@ class CustomImputation
     }
   }
 
+  /**
+   * Replace mappedValues[k] (or NaN) in each dimensions[k] with the custom
+   * value, in one parallel pass over the input.
+   *
+   * @param input Matrix that contains the mapped values.
+   * @param mappedValues Value to get rid of in each dimension.
+   * @param dimensions Indices of the dimensions to impute.
+   * @param columnMajor State of whether the input matrix is columnMajor or not.
+   */
+  void Impute(arma::Mat<T>& input,
+              const std::vector<T>& mappedValues,
+              const std::vector<size_t>& dimensions,
+              const bool columnMajor = true)
+  {
+    if (mappedValues.size() != dimensions.size())
+    {
+      throw std::invalid_argument("CustomImputation::Impute(): there must be "
+          "a mapped value for each dimension");
+    }
+
+    const size_t numPoints = columnMajor ? input.n_cols : input.n_rows;
+#ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables. If we're building for Visual Studio,
+    // use the intmax_t type instead.
+    #pragma omp parallel for schedule(static)
+    for (intmax_t i = 0; i < (intmax_t) numPoints; ++i)
+#else
+    #pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < numPoints; ++i)
+#endif
+    {
+      for (size_t k = 0; k < dimensions.size(); ++k)
+      {
+        T& value = columnMajor ? input(dimensions[k], i) :
+            input(i, dimensions[k]);
+        if (value == mappedValues[k] || std::isnan(value))
+          value = customValue;
+      }
+    }
+  }
+
  private:
   //! A user-defined value that the user wants to replace missing values with.
   T customValue;
@@ -66,6 +66,62 @@ class ListwiseDeletion
       input = input.rows(arma::uvec(colsToKeep));
     }
   }
+
+  /**
+   * Remove every row or column that holds mappedValues[k] (or NaN) in any
+   * dimensions[k], in one parallel pass over the input.
+   *
+   * @param input Matrix that contains the mapped values.
+   * @param mappedValues Value to get rid of in each dimension.
+   * @param dimensions Indices of the dimensions to check.
+   * @param columnMajor State of whether the input matrix is columnMajor or not.
+   */
+  void Impute(arma::Mat<T>& input,
+              const std::vector<T>& mappedValues,
+              const std::vector<size_t>& dimensions,
+              const bool columnMajor = true)
+  {
+    if (mappedValues.size() != dimensions.size())
+    {
+      throw std::invalid_argument("ListwiseDeletion::Impute(): there must be "
+          "a mapped value for each dimension");
+    }
+
+    const size_t numPoints = columnMajor ? input.n_cols : input.n_rows;
+    std::vector<char> keep(numPoints, 1);
+#ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables. If we're building for Visual Studio,
+    // use the intmax_t type instead.
+    #pragma omp parallel for schedule(static)
+    for (intmax_t i = 0; i < (intmax_t) numPoints; ++i)
+#else
+    #pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < numPoints; ++i)
+#endif
+    {
+      for (size_t k = 0; k < dimensions.size(); ++k)
+      {
+        const T value = columnMajor ? input(dimensions[k], i) :
+            input(i, dimensions[k]);
+        if (value == mappedValues[k] || std::isnan(value))
+        {
+          keep[i] = 0;
+          break;
+        }
+      }
+    }
+
+    std::vector<arma::uword> colsToKeep;
+    for (size_t i = 0; i < numPoints; ++i)
+      if (keep[i])
+        colsToKeep.push_back(i);
+
+    if (columnMajor)
+      input = input.cols(arma::uvec(colsToKeep));
+    else
+      input = input.rows(arma::uvec(colsToKeep));
+  }
 }; // class ListwiseDeletion
 
 } // namespace data
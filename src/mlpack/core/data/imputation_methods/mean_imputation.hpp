@@ -96,6 +96,104 @@ class MeanImputation
       input(target.first, target.second) = mean;
     }
   }
+
+  /**
+   * Replace mappedValues[k] (or NaN) in each dimensions[k] with the mean of
+   * that dimension.  The means of all the dimensions are found in one parallel
+   * pass over the input, and the missing values are replaced in a second one,
+   * so this is much faster than imputing each dimension on its own.
+   *
+   * @param input Matrix that contains the mapped values.
+   * @param mappedValues Value to get rid of in each dimension.
+   * @param dimensions Indices of the dimensions to impute.
+   * @param columnMajor State of whether the input matrix is columnMajor or not.
+   */
+  void Impute(arma::Mat<T>& input,
+              const std::vector<T>& mappedValues,
+              const std::vector<size_t>& dimensions,
+              const bool columnMajor = true)
+  {
+    if (mappedValues.size() != dimensions.size())
+    {
+      throw std::invalid_argument("MeanImputation::Impute(): there must be a "
+          "mapped value for each dimension");
+    }
+
+    const size_t numDimensions = dimensions.size();
+    const size_t numPoints = columnMajor ? input.n_cols : input.n_rows;
+
+#ifdef HAS_OPENMP
+    const size_t numThreads = omp_get_max_threads();
+#else
+    const size_t numThreads = 1;
+#endif
+
+    // Each thread sums the valid elements of its points into its own column.
+    arma::mat sums(numDimensions, numThreads, arma::fill::zeros);
+    arma::Mat<size_t> elems(numDimensions, numThreads, arma::fill::zeros);
+
+    #pragma omp parallel num_threads(numThreads)
+    {
+#ifdef HAS_OPENMP
+      const size_t thread = omp_get_thread_num();
+#else
+      const size_t thread = 0;
+#endif
+
+#ifdef _WIN32
+      // Tiny workaround: Visual Studio only implements OpenMP 2.0, which
+      // doesn't support unsigned loop variables. If we're building for Visual
+      // Studio, use the intmax_t type instead.
+      #pragma omp for schedule(static)
+      for (intmax_t i = 0; i < (intmax_t) numPoints; ++i)
+#else
+      #pragma omp for schedule(static)
+      for (size_t i = 0; i < numPoints; ++i)
+#endif
+      {
+        for (size_t k = 0; k < numDimensions; ++k)
+        {
+          const T value = columnMajor ? input(dimensions[k], i) :
+              input(i, dimensions[k]);
+          if (!(value == mappedValues[k] || std::isnan(value)))
+          {
+            sums(k, thread) += value;
+            ++elems(k, thread);
+          }
+        }
+      }
+    }
+
+    // Add the sums of the threads in a fixed order, so that the result
+    // doesn't depend on the scheduling.
+    const arma::Col<size_t> totalElems = arma::sum(elems, 1);
+    for (size_t k = 0; k < numDimensions; ++k)
+    {
+      if (totalElems[k] == 0)
+        Log::Fatal << "it is impossible to calculate mean; no valid elements "
+            << "in dimension " << dimensions[k] << std::endl;
+    }
+    const arma::vec means = arma::sum(sums, 1) /
+        arma::conv_to<arma::vec>::from(totalElems);
+
+    // Now replace the missing values with the means.
+#ifdef _WIN32
+    #pragma omp parallel for schedule(static)
+    for (intmax_t i = 0; i < (intmax_t) numPoints; ++i)
+#else
+    #pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < numPoints; ++i)
+#endif
+    {
+      for (size_t k = 0; k < numDimensions; ++k)
+      {
+        T& value = columnMajor ? input(dimensions[k], i) :
+            input(i, dimensions[k]);
+        if (value == mappedValues[k] || std::isnan(value))
+          value = means[k];
+      }
+    }
+  }
 }; // class MeanImputation
 
 } // namespace data
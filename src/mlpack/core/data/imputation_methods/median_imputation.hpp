@@ -85,6 +85,136 @@ class MedianImputation
        input(target.first, target.second) = median;
     }
   }
+
+  /**
+   * Replace mappedValues[k] (or NaN) in each dimensions[k] with the median of
+   * that dimension.  The valid elements of all the dimensions are collected in
+   * one parallel pass over the input, the medians are selected (in parallel
+   * over the dimensions) without sorting, and the missing values are replaced
+   * in a second pass.
+   *
+   * @param input Matrix that contains the mapped values.
+   * @param mappedValues Value to get rid of in each dimension.
+   * @param dimensions Indices of the dimensions to impute.
+   * @param columnMajor State of whether the input matrix is columnMajor or not.
+   */
+  void Impute(arma::Mat<T>& input,
+              const std::vector<T>& mappedValues,
+              const std::vector<size_t>& dimensions,
+              const bool columnMajor = true)
+  {
+    if (mappedValues.size() != dimensions.size())
+    {
+      throw std::invalid_argument("MedianImputation::Impute(): there must be "
+          "a mapped value for each dimension");
+    }
+
+    const size_t numDimensions = dimensions.size();
+    const size_t numPoints = columnMajor ? input.n_cols : input.n_rows;
+
+#ifdef HAS_OPENMP
+    const size_t numThreads = omp_get_max_threads();
+#else
+    const size_t numThreads = 1;
+#endif
+
+    // Each thread keeps the valid elements of its points, by dimension; the
+    // order of the elements doesn't matter for the median.
+    std::vector<std::vector<std::vector<double>>> threadElems(numThreads,
+        std::vector<std::vector<double>>(numDimensions));
+
+    #pragma omp parallel num_threads(numThreads)
+    {
+#ifdef HAS_OPENMP
+      const size_t thread = omp_get_thread_num();
+#else
+      const size_t thread = 0;
+#endif
+      std::vector<std::vector<double>>& elemsToKeep = threadElems[thread];
+
+#ifdef _WIN32
+      // Tiny workaround: Visual Studio only implements OpenMP 2.0, which
+      // doesn't support unsigned loop variables. If we're building for Visual
+      // Studio, use the intmax_t type instead.
+      #pragma omp for schedule(static)
+      for (intmax_t i = 0; i < (intmax_t) numPoints; ++i)
+#else
+      #pragma omp for schedule(static)
+      for (size_t i = 0; i < numPoints; ++i)
+#endif
+      {
+        for (size_t k = 0; k < numDimensions; ++k)
+        {
+          const T value = columnMajor ? input(dimensions[k], i) :
+              input(i, dimensions[k]);
+          if (!(value == mappedValues[k] || std::isnan(value)))
+            elemsToKeep[k].push_back(value);
+        }
+      }
+    }
+
+    // Gather the elements of each dimension and select the middle ones.
+    std::vector<double> medians(numDimensions);
+    std::vector<char> empty(numDimensions, 0);
+#ifdef _WIN32
+    #pragma omp parallel for schedule(dynamic)
+    for (intmax_t k = 0; k < (intmax_t) numDimensions; ++k)
+#else
+    #pragma omp parallel for schedule(dynamic)
+    for (size_t k = 0; k < numDimensions; ++k)
+#endif
+    {
+      std::vector<double> elems;
+      for (size_t t = 0; t < numThreads; ++t)
+      {
+        elems.insert(elems.end(), threadElems[t][k].begin(),
+            threadElems[t][k].end());
+        std::vector<double>().swap(threadElems[t][k]);
+      }
+
+      if (elems.empty())
+      {
+        empty[k] = 1;
+        continue;
+      }
+
+      // With an even number of elements, the median is the average of the two
+      // middle ones (as with arma::median()).
+      const size_t middle = elems.size() / 2;
+      std::nth_element(elems.begin(), elems.begin() + middle, elems.end());
+      medians[k] = elems[middle];
+      if (elems.size() % 2 == 0)
+      {
+        medians[k] = (medians[k] + *std::max_element(elems.begin(),
+            elems.begin() + middle)) / 2.0;
+      }
+    }
+
+    for (size_t k = 0; k < numDimensions; ++k)
+    {
+      if (empty[k])
+        Log::Fatal << "it is impossible to calculate median; no valid elements "
+            << "in dimension " << dimensions[k] << std::endl;
+    }
+
+    // Now replace the missing values with the medians.
+#ifdef _WIN32
+    #pragma omp parallel for schedule(static)
+    for (intmax_t i = 0; i < (intmax_t) numPoints; ++i)
+#else
+    #pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < numPoints; ++i)
+#endif
+    {
+      for (size_t k = 0; k < numDimensions; ++k)
+      {
+        T& value = columnMajor ? input(dimensions[k], i) :
+            input(i, dimensions[k]);
+        if (value == mappedValues[k] || std::isnan(value))
+          value = medians[k];
+      }
+    }
+  }
 }; // class MedianImputation
 
 } // namespace data
@@ -20,6 +20,7 @@
 
 #include "format.hpp"
 #include "dataset_mapper.hpp"
+#include "matrix_file.hpp"
 
 namespace mlpack {
 namespace data /** Functions to load and save matrices and models. */ {
@@ -40,11 +41,22 @@ namespace data /** Functions to load and save matrices and models. */ {
  *  - Raw binary (raw_binary), denoted by .bin
  *  - Armadillo binary (arma_binary), denoted by .bin
  *  - HDF5, denoted by .hdf, .hdf5, .h5, or .he5
+ *  - mlpack binary matrix, denoted by .mlm
  *
  * If the file extension is not one of those types, an error will be given.
  * This is preferable to Armadillo's default behavior of loading an unknown
  * filetype as raw_binary, which can have very confusing effects.
  *
+ * An mlpack binary matrix file (see SaveMatrixFile()) holds the matrix as it
+ * is held in memory, so it is never transposed, and its element type must
+ * match eT.  To use such a file without loading it at all, map it with the
+ * MappedMatrix overload of Load().
+ *
+ * A file may also be compressed with zstd (.zst) or LZ4 (.lz4), if mlpack was
+ * compiled with the library; the type is then given by the extension before
+ * it (so "data.csv.zst" is compressed CSV).  The file is decompressed into
+ * memory first.  HDF5 files and mlpack binary matrices can't be compressed.
+ *
  * If the parameter 'fatal' is set to true, a std::runtime_error exception will
  * be thrown if the matrix does not load successfully.  The parameter
  * 'transpose' controls whether or not the matrix is transposed after loading.
@@ -95,6 +107,24 @@ extern template bool Load<double>(const std::string&,
                                   const bool,
                                   const bool);
 
+/**
+ * Map an mlpack binary matrix file (.mlm, as written by Save()) into memory,
+ * so that its matrix can be used without being loaded or copied; see
+ * MappedMatrix.  The file must hold elements of type eT.
+ *
+ * If the parameter 'fatal' is set to true, a std::runtime_error exception will
+ * be thrown if the file can't be mapped.
+ *
+ * @param filename Name of file to map.
+ * @param matrix Matrix to map the file into.
+ * @param fatal If an error should be reported as fatal (default false).
+ * @return Boolean value indicating success or failure of the mapping.
+ */
+template<typename eT>
+bool Load(const std::string& filename,
+          MappedMatrix<eT>& matrix,
+          const bool fatal = false);
+
 /**
  * Load a column vector from a file, guessing the filetype from the extension.
  *
@@ -159,6 +189,33 @@ bool Load(const std::string& filename,
           arma::Row<eT>& rowvec,
           const bool fatal = false);
 
+/**
+ * Load a sparse matrix from a file, guessing the filetype from the extension.
+ * This will transpose the matrix at load time (unless the transpose parameter
+ * is set to false), so that each row of the file is a point.  Only the nonzero
+ * values are ever held in memory.  The supported types of files are
+ *
+ *  - sparse ARFF ({index value, ...} instances), denoted by .arff; these are
+ *    never transposed, since each instance is already a point
+ *  - coordinate list (coord_ascii), with a "row column value" line for each
+ *    nonzero value, denoted by .txt, .tsv or .coo
+ *  - Armadillo binary sparse matrix (arma_binary), denoted by .bin
+ *
+ * If the parameter 'fatal' is set to true, a std::runtime_error exception will
+ * be thrown if the matrix does not load successfully.
+ *
+ * @param filename Name of file to load.
+ * @param matrix Sparse matrix to load contents of file into.
+ * @param fatal If an error should be reported as fatal (default false).
+ * @param transpose If true, transpose the matrix after loading.
+ * @return Boolean value indicating success or failure of load.
+ */
+template<typename eT>
+bool Load(const std::string& filename,
+          arma::SpMat<eT>& matrix,
+          const bool fatal = false,
+          const bool transpose = true);
+
 /**
  * Loads a matrix from a file, guessing the filetype from the extension and
  * mapping categorical features with a DatasetMapper object.  This will
@@ -244,11 +301,16 @@ extern template bool Load<double, IncrementPolicy>(
  *  - text, denoted by .txt
  *  - xml, denoted by .xml
  *  - binary, denoted by .bin
+ *  - native binary (see NativeOArchive), denoted by .mlb
  *
  * The format parameter can take any of the values in the 'format' enum:
- * 'format::autodetect', 'format::text', 'format::xml', and 'format::binary'.
+ * 'format::autodetect', 'format::text', 'format::xml', 'format::binary', and
+ * 'format::native'.  The native format is the fastest to save and load large
+ * models, but, like binary, can only be read on the same kind of machine.
  * The autodetect functionality operates on the file extension (so, "file.txt"
- * would be autodetected as text).
+ * would be autodetected as text).  A file compressed with zstd (.zst) or LZ4
+ * (.lz4) is decompressed on a separate thread while it is loaded, and its
+ * format is given by the extension before that (so "model.bin.zst" is binary).
  *
  * The name parameter should be specified to indicate the name of the structure
  * to be loaded.  This should be the same as the name that was used to save the
@@ -272,5 +334,7 @@ bool Load(const std::string& filename,
 #include "load_model_impl.hpp"
 // Include implementation of Load() for vectors.
 #include "load_vec_impl.hpp"
+// Include implementation of Load() for sparse matrices.
+#include "load_sparse_impl.hpp"
 
 #endif
@@ -14,7 +14,7 @@
 
 #include <mlpack/prereqs.hpp>
 #include "dataset_mapper.hpp"
-#include <boost/tokenizer.hpp>
+#include "arff_parser.hpp"
 
 namespace mlpack {
 namespace data {
@@ -23,6 +23,9 @@ namespace data {
  * A utility function to load an ARFF dataset as numeric features (that is, as
  * an Armadillo matrix without any modification).  An exception will be thrown
  * if any features are non-numeric.
+ *
+ * The file is parsed in parallel by ARFFParser, which also reads sparse
+ * instances ({index value, ...}).
  */
 template<typename eT>
 void LoadARFF(const std::string& filename, arma::Mat<eT>& matrix);
@@ -48,10 +51,30 @@ void LoadARFF(const std::string& filename, arma::Mat<eT>& matrix);
  * @param matrix Matrix to load data into.
  * @param info DatasetInfo object; can be default-constructed or pre-existing
  *     from another call to LoadARFF().
+ * @param transpose If true (the default), each instance is a column of the
+ *     matrix; otherwise, each instance is a row.
  */
 template<typename eT, typename PolicyType>
 void LoadARFF(const std::string& filename,
               arma::Mat<eT>& matrix,
+              DatasetMapper<PolicyType>& info,
+              const bool transpose = true);
+
+/**
+ * Load an ARFF dataset into a sparse matrix, one instance per column, mapping
+ * the categorical features like the overload above.  This is meant for sparse
+ * ARFF files ({index value, ...} instances): only the nonzero values are held
+ * while loading, so the dense matrix is never built.  An exception will be
+ * thrown upon failure.
+ *
+ * @param filename Name of ARFF file to load.
+ * @param matrix Sparse matrix to load data into.
+ * @param info DatasetInfo object; can be default-constructed or pre-existing
+ *     from another call to LoadARFF().
+ */
+template<typename eT, typename PolicyType>
+void LoadARFF(const std::string& filename,
+              arma::SpMat<eT>& matrix,
               DatasetMapper<PolicyType>& info);
 
 } // namespace data
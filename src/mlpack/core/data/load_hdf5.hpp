@@ -0,0 +1,47 @@
+/**
+ * @file load_hdf5.hpp
+ *
+ * Load an HDF5 dataset so that its rows are the rows of the matrix.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_LOAD_HDF5_HPP
+#define MLPACK_CORE_DATA_LOAD_HDF5_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#ifdef ARMA_USE_HDF5
+
+namespace mlpack {
+namespace data {
+
+/**
+ * Load the two-dimensional dataset named "dataset" (the name Armadillo saves
+ * with) from an HDF5 file, so that each row of the dataset is a row of the
+ * matrix.  Armadillo loads each row of the dataset into a column instead, so
+ * this is the untransposed load.  The dataset is read in blocks of rows, and
+ * each block is transposed into place, so besides the matrix only one block is
+ * held in memory.
+ *
+ * If the file can't be opened or has no such dataset, false is returned and
+ * the matrix is unchanged, so that the caller can fall back to Armadillo.
+ *
+ * @param filename Name of HDF5 file to load.
+ * @param matrix Matrix to load data into.
+ * @return Whether the dataset was loaded.
+ */
+template<typename eT>
+bool LoadHDF5Rows(const std::string& filename, arma::Mat<eT>& matrix);
+
+} // namespace data
+} // namespace mlpack
+
+// Include implementation.
+#include "load_hdf5_impl.hpp"
+
+#endif
+
+#endif
@@ -0,0 +1,89 @@
+/**
+ * @file load_hdf5_impl.hpp
+ *
+ * Implementation of LoadHDF5Rows().
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_LOAD_HDF5_IMPL_HPP
+#define MLPACK_CORE_DATA_LOAD_HDF5_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "load_hdf5.hpp"
+
+namespace mlpack {
+namespace data {
+
+template<typename eT>
+bool LoadHDF5Rows(const std::string& filename, arma::Mat<eT>& matrix)
+{
+  // Don't let HDF5 print errors while we look for the dataset.
+  H5E_auto2_t errorFunction;
+  void* errorData;
+  H5Eget_auto2(H5E_DEFAULT, &errorFunction, &errorData);
+  H5Eset_auto2(H5E_DEFAULT, NULL, NULL);
+
+  bool success = false;
+  const hid_t file = H5Fopen(filename.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+  if (file >= 0)
+  {
+    const hid_t dataset = H5Dopen2(file, "dataset", H5P_DEFAULT);
+    if (dataset >= 0)
+    {
+      const hid_t space = H5Dget_space(dataset);
+      hsize_t dims[2];
+      if (H5Sget_simple_extent_ndims(space) == 2 &&
+          H5Sget_simple_extent_dims(space, dims, NULL) == 2)
+      {
+        const hid_t type = arma::hdf5_misc::get_hdf5_type<eT>();
+
+        // Blocks of about a million elements.
+        const hsize_t blockRows = std::max((hsize_t) 1,
+            (hsize_t) (1 << 20) / std::max((hsize_t) 1, dims[1]));
+
+        // The rows of a block are contiguous in the file, so they are the
+        // columns of a column-major block.
+        arma::Mat<eT> result(dims[0], dims[1]);
+        arma::Mat<eT> block;
+        success = true;
+        for (hsize_t first = 0; first < dims[0] && success; first += blockRows)
+        {
+          const hsize_t start[2] = { first, 0 };
+          const hsize_t count[2] = { std::min(blockRows, dims[0] - first),
+                                     dims[1] };
+          H5Sselect_hyperslab(space, H5S_SELECT_SET, start, NULL, count,
+              NULL);
+          const hid_t memory = H5Screate_simple(2, count, NULL);
+
+          block.set_size(count[1], count[0]);
+          success = (H5Dread(dataset, type, memory, space, H5P_DEFAULT,
+              block.memptr()) >= 0);
+          H5Sclose(memory);
+
+          if (success && block.n_elem > 0)
+            result.rows(first, first + count[0] - 1) = block.t();
+        }
+
+        H5Tclose(type);
+        if (success)
+          matrix = std::move(result);
+      }
+
+      H5Sclose(space);
+      H5Dclose(dataset);
+    }
+
+    H5Fclose(file);
+  }
+
+  H5Eset_auto2(H5E_DEFAULT, errorFunction, errorData);
+  return success;
+}
+
+} // namespace data
+} // namespace mlpack
+
+#endif
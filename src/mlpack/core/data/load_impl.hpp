@@ -16,17 +16,23 @@
 
 #include <exception>
 #include <algorithm>
+#include <mlpack/core/util/numa.hpp>
 #include <mlpack/core/util/timers.hpp>
 
 #include "load_csv.hpp"
+#include "csv_parser.hpp"
 #include "load.hpp"
 #include "extension.hpp"
+#include "compression.hpp"
 
 #include <boost/algorithm/string/trim.hpp>
 #include <boost/tokenizer.hpp>
 #include <boost/algorithm/string.hpp>
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/stream.hpp>
 
 #include "load_arff.hpp"
+#include "load_hdf5.hpp"
 
 namespace mlpack {
 namespace data {
@@ -94,17 +100,18 @@ bool Load(const std::string& filename,
 {
   Timer::Start("loading_data");
 
-  // Get the extension.
-  std::string extension = Extension(filename);
+  // Get the extension (of the data, if the file is compressed).
+  const bool compressed = (FileCompression(filename) != Compression::none);
+  std::string extension = Extension(UncompressedName(filename));
 
   // Catch nonexistent files by opening the stream ourselves.
-  std::fstream stream;
+  std::fstream fileStream;
 #ifdef  _WIN32 // Always open in binary mode on Windows.
-  stream.open(filename.c_str(), std::fstream::in | std::fstream::binary);
+  fileStream.open(filename.c_str(), std::fstream::in | std::fstream::binary);
 #else
-  stream.open(filename.c_str(), std::fstream::in);
+  fileStream.open(filename.c_str(), std::fstream::in);
 #endif
-  if (!stream.is_open())
+  if (!fileStream.is_open())
   {
     Timer::Stop("loading_data");
     if (fatal)
@@ -116,6 +123,76 @@ bool Load(const std::string& filename,
     return false;
   }
 
+  // mlpack binary matrices are held as they are in memory, so they are
+  // copied straight from the mapped file.
+  if (extension == "mlm")
+  {
+    Log::Info << "Loading '" << filename << "' as mlpack binary matrix.  "
+        << std::flush;
+    try
+    {
+      MappedMatrix<eT> mapped(filename);
+      matrix = mapped.Matrix();
+    }
+    catch (std::exception& e)
+    {
+      Log::Info << std::endl;
+      Timer::Stop("loading_data");
+      if (fatal)
+        Log::Fatal << e.what() << std::endl;
+      else
+        Log::Warn << e.what() << std::endl;
+
+      return false;
+    }
+
+    Log::Info << "Size is " << matrix.n_rows << " x " << matrix.n_cols << ".\n";
+    NUMA::FirstTouch(matrix);
+    Timer::Stop("loading_data");
+    return true;
+  }
+
+  if (compressed && (extension == "h5" || extension == "hdf5" ||
+      extension == "hdf" || extension == "he5"))
+  {
+    Timer::Stop("loading_data");
+    if (fatal)
+      Log::Fatal << "Cannot load HDF5 data from compressed file '" << filename
+          << "'." << std::endl;
+    else
+      Log::Warn << "Cannot load HDF5 data from compressed file '" << filename
+          << "'; load failed." << std::endl;
+
+    return false;
+  }
+
+  // A compressed file is decompressed into memory (on a separate thread, see
+  // MappedFile), and the data is read from there.
+  std::unique_ptr<MappedFile> decompressed;
+  boost::iostreams::stream<boost::iostreams::array_source> memoryStream;
+  if (compressed)
+  {
+    try
+    {
+      decompressed.reset(new MappedFile(filename));
+    }
+    catch (std::exception& e)
+    {
+      Timer::Stop("loading_data");
+      if (fatal)
+        Log::Fatal << e.what() << std::endl;
+      else
+        Log::Warn << e.what() << std::endl;
+
+      return false;
+    }
+
+    memoryStream.open(decompressed->Memory(), decompressed->Size());
+  }
+  std::istream& stream = compressed ?
+      static_cast<std::istream&>(memoryStream) :
+      static_cast<std::istream&>(fileStream);
+
   bool unknownType = false;
   arma::file_type loadType;
   std::string stringType;
@@ -290,9 +367,49 @@ bool Load(const std::string& filename,
     Log::Info << "Loading '" << filename << "' as " << stringType << ".  "
         << std::flush;
 
-  // We can't use the stream if the type is HDF5.
+  // Text files are parsed in parallel by CSVParser, and untransposed HDF5
+  // datasets are read by LoadHDF5Rows(); both write the matrix in the requested
+  // layout, so it doesn't have to be transposed afterwards.  We can't use the
+  // stream if the type is HDF5.
   bool success;
-  if (loadType != arma::hdf5_binary)
+  bool parsed = false;
+  if (loadType == arma::csv_ascii || loadType == arma::raw_ascii)
+  {
+    try
+    {
+      // The parser takes the decompressed data of a compressed file.
+      const CSVParser::SeparatorType separator =
+          (loadType == arma::csv_ascii) ? CSVParser::COMMA :
+          CSVParser::WHITESPACE;
+      std::unique_ptr<CSVParser> parser(compressed ?
+          new CSVParser(std::move(*decompressed), separator) :
+          new CSVParser(filename, separator));
+      parser->Parse(matrix, transpose);
+    }
+    catch (std::exception& e)
+    {
+      Log::Info << std::endl;
+      Timer::Stop("loading_data");
+      if (fatal)
+        Log::Fatal << e.what() << std::endl;
+      else
+        Log::Warn << e.what() << std::endl;
+
+      return false;
+    }
+
+    success = true;
+    parsed = true;
+  }
+#ifdef ARMA_USE_HDF5
+  else if (loadType == arma::hdf5_binary && !transpose &&
+           LoadHDF5Rows(filename, matrix))
+  {
+    success = true;
+    parsed = true;
+  }
+#endif
+  else if (loadType != arma::hdf5_binary)
     success = matrix.load(stream, loadType);
   else
     success = matrix.load(filename, loadType);
@@ -314,21 +431,51 @@ bool Load(const std::string& filename,
 
   // Now transpose the matrix, if necessary.  Armadillo loads HDF5 matrices
   // transposed, so we have to work around that.
-  if (transpose && loadType != arma::hdf5_binary)
+  if (transpose && loadType != arma::hdf5_binary && !parsed)
   {
     inplace_transpose(matrix);
   }
-  else if (!transpose && loadType == arma::hdf5_binary)
+  else if (!transpose && loadType == arma::hdf5_binary && !parsed)
   {
     inplace_transpose(matrix);
   }
 
+  // Spread the matrix over the NUMA nodes, if that is enabled.
+  NUMA::FirstTouch(matrix);
+
   Timer::Stop("loading_data");
 
   // Finally, return the success indicator.
   return success;
 }
 
+template<typename eT>
+bool Load(const std::string& filename,
+          MappedMatrix<eT>& matrix,
+          const bool fatal)
+{
+  Timer::Start("loading_data");
+  try
+  {
+    matrix.Map(filename);
+  }
+  catch (std::exception& e)
+  {
+    Timer::Stop("loading_data");
+    if (fatal)
+      Log::Fatal << e.what() << std::endl;
+    else
+      Log::Warn << e.what() << std::endl;
+
+    return false;
+  }
+
+  Log::Info << "Mapped '" << filename << "' as mlpack binary matrix.  Size is "
+      << matrix.Matrix().n_rows << " x " << matrix.Matrix().n_cols << ".\n";
+  Timer::Stop("loading_data");
+  return true;
+}
+
 // Load with mappings.  Unfortunately we have to implement this ourselves.
 template<typename eT, typename PolicyType>
 bool Load(const std::string& filename,
@@ -340,8 +487,9 @@ bool Load(const std::string& filename,
   // Get the extension and load as necessary.
   Timer::Start("loading_data");
 
-  // Get the extension.
-  std::string extension = Extension(filename);
+  // Get the extension (of the data, if the file is compressed; the parsers
+  // decompress it).
+  std::string extension = Extension(UncompressedName(filename));
 
   // Catch nonexistent files by opening the stream ourselves.
   std::fstream stream;
@@ -364,8 +512,10 @@ bool Load(const std::string& filename,
     Log::Info << "Loading '" << filename << "' as CSV dataset.  " << std::flush;
     try
     {
-      LoadCSV loader(filename);
-      loader.Load(matrix, info, transpose);
+      // The delimiter is given by the extension, as for LoadCSV.
+      CSVParser parser(filename, (extension == "csv") ? CSVParser::COMMA :
+          (extension == "tsv") ? CSVParser::TAB : CSVParser::WHITESPACE);
+      parser.Parse(matrix, info, transpose);
     }
     catch (std::exception& e)
     {
@@ -384,11 +534,7 @@ bool Load(const std::string& filename,
         << std::flush;
     try
     {
-      LoadARFF(filename, matrix, info);
-
-      // We transpose by default.  So, un-transpose if necessary...
-      if (!transpose)
-        inplace_transpose(matrix);
+      LoadARFF(filename, matrix, info, transpose);
     }
     catch (std::exception& e)
     {
@@ -418,6 +564,9 @@ bool Load(const std::string& filename,
   Log::Info << "Size is " << (transpose ? matrix.n_cols : matrix.n_rows)
       << " x " << (transpose ? matrix.n_rows : matrix.n_cols) << ".\n";
 
+  // Spread the matrix over the NUMA nodes, if that is enabled.
+  NUMA::FirstTouch(matrix);
+
   Timer::Stop("loading_data");
 
   return true;
@@ -19,12 +19,14 @@
 #include <mlpack/core/util/timers.hpp>
 
 #include "extension.hpp"
+#include "compression.hpp"
 
 #include <boost/serialization/serialization.hpp>
 #include <boost/algorithm/string/trim.hpp>
 #include <boost/archive/xml_iarchive.hpp>
 #include <boost/archive/text_iarchive.hpp>
 #include <boost/archive/binary_iarchive.hpp>
+#include "native_archive.hpp"
 #include <boost/tokenizer.hpp>
 #include <boost/algorithm/string.hpp>
 
@@ -43,7 +45,7 @@ bool Load(const std::string& filename,
 {
   if (f == format::autodetect)
   {
-    std::string extension = Extension(filename);
+    std::string extension = Extension(UncompressedName(filename));
 
     if (extension == "xml")
       f = format::xml;
@@ -51,6 +53,8 @@ bool Load(const std::string& filename,
       f = format::binary;
     else if (extension == "txt")
       f = format::text;
+    else if (extension == "mlb")
+      f = format::native;
     else
     {
       if (fatal)
@@ -64,18 +68,34 @@ bool Load(const std::string& filename,
     }
   }
 
-  // Now load the given format.
+  // Now load the given format.  A compressed file (.zst or .lz4) is
+  // decompressed on a separate thread while the archive is read.
   std::ifstream ifs;
-#ifdef _WIN32 // Open non-text in binary mode on Windows.
-  if (f == format::binary)
-    ifs.open(filename, std::ifstream::in | std::ifstream::binary);
+  std::unique_ptr<CompressedInputStream> compressedStream;
+  if (FileCompression(filename) != Compression::none)
+  {
+    try
+    {
+      compressedStream.reset(new CompressedInputStream(filename));
+    }
+    catch (std::exception& /* e */)
+    {
+      // The error is given below.
+    }
+  }
   else
-    ifs.open(filename, std::ifstream::in);
+  {
+#ifdef _WIN32 // Open non-text in binary mode on Windows.
+    if (f == format::binary || f == format::native)
+      ifs.open(filename, std::ifstream::in | std::ifstream::binary);
+    else
+      ifs.open(filename, std::ifstream::in);
 #else
-  ifs.open(filename, std::ifstream::in);
+    ifs.open(filename, std::ifstream::in);
 #endif
+  }
 
-  if (!ifs.is_open())
+  if (!ifs.is_open() && !compressedStream)
   {
     if (fatal)
       Log::Fatal << "Unable to open file '" << filename << "' to load object '"
@@ -87,27 +107,35 @@ bool Load(const std::string& filename,
     return false;
   }
 
+  std::istream& stream = compressedStream ?
+      static_cast<std::istream&>(*compressedStream) :
+      static_cast<std::istream&>(ifs);
   try
   {
     if (f == format::xml)
     {
-      boost::archive::xml_iarchive ar(ifs);
+      boost::archive::xml_iarchive ar(stream);
       ar >> CreateNVP(t, name);
     }
     else if (f == format::text)
     {
-      boost::archive::text_iarchive ar(ifs);
+      boost::archive::text_iarchive ar(stream);
       ar >> CreateNVP(t, name);
     }
     else if (f == format::binary)
     {
-      boost::archive::binary_iarchive ar(ifs);
+      boost::archive::binary_iarchive ar(stream);
+      ar >> CreateNVP(t, name);
+    }
+    else if (f == format::native)
+    {
+      NativeIArchive ar(stream);
       ar >> CreateNVP(t, name);
     }
 
     return true;
   }
-  catch (boost::archive::archive_exception& e)
+  catch (std::exception& e)
   {
     if (fatal)
       Log::Fatal << e.what() << std::endl;
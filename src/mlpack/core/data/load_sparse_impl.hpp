@@ -0,0 +1,121 @@
+/**
+ * @file load_sparse_impl.hpp
+ *
+ * Implementation of the Load() overload of load.hpp for sparse matrices.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_LOAD_SPARSE_IMPL_HPP
+#define MLPACK_CORE_DATA_LOAD_SPARSE_IMPL_HPP
+
+// In case it hasn't already been included.
+#include "load.hpp"
+
+#include <mlpack/core/util/timers.hpp>
+#include "extension.hpp"
+#include "load_arff.hpp"
+
+namespace mlpack {
+namespace data {
+
+// Load sparse matrix.
+template<typename eT>
+bool Load(const std::string& filename,
+          arma::SpMat<eT>& matrix,
+          const bool fatal,
+          const bool transpose)
+{
+  Timer::Start("loading_data");
+
+  const std::string extension = Extension(filename);
+
+  bool success = false;
+  std::string type;
+  if (extension == "arff")
+  {
+    // Sparse ARFF files are parsed straight into a sparse matrix, with one
+    // instance per column already.
+    type = "sparse ARFF data";
+    Log::Info << "Loading '" << filename << "' as " << type << ".  "
+        << std::flush;
+    try
+    {
+      DatasetInfo info;
+      LoadARFF(filename, matrix, info);
+      success = true;
+    }
+    catch (std::exception& e)
+    {
+      Log::Info << std::endl;
+      Timer::Stop("loading_data");
+      if (fatal)
+        Log::Fatal << e.what() << std::endl;
+      else
+        Log::Warn << e.what() << std::endl;
+
+      return false;
+    }
+  }
+  else
+  {
+    arma::file_type loadType;
+    if (extension == "txt" || extension == "tsv" || extension == "coo")
+    {
+      loadType = arma::coord_ascii;
+      type = "coordinate list data";
+    }
+    else if (extension == "bin")
+    {
+      loadType = arma::arma_binary;
+      type = "Armadillo binary sparse data";
+    }
+    else
+    {
+      Timer::Stop("loading_data");
+      if (fatal)
+        Log::Fatal << "Unable to determine format of sparse matrix file '"
+            << filename << "'; use .arff, .txt, .tsv, .coo or .bin."
+            << std::endl;
+      else
+        Log::Warn << "Unable to determine format of sparse matrix file '"
+            << filename << "'; use .arff, .txt, .tsv, .coo or .bin.  Load "
+            << "failed." << std::endl;
+
+      return false;
+    }
+
+    Log::Info << "Loading '" << filename << "' as " << type << ".  "
+        << std::flush;
+    success = matrix.load(filename, loadType);
+
+    // The points are the rows of the file.  Transposing a sparse matrix takes
+    // time linear in its number of nonzero values.
+    if (success && transpose)
+      matrix = matrix.t();
+  }
+
+  if (!success)
+  {
+    Log::Info << std::endl;
+    Timer::Stop("loading_data");
+    if (fatal)
+      Log::Fatal << "Loading from '" << filename << "' failed." << std::endl;
+    else
+      Log::Warn << "Loading from '" << filename << "' failed." << std::endl;
+
+    return false;
+  }
+
+  Log::Info << "Size is " << matrix.n_rows << " x " << matrix.n_cols << " ("
+      << matrix.n_nonzero << " nonzero values).\n";
+  Timer::Stop("loading_data");
+  return true;
+}
+
+} // namespace data
+} // namespace mlpack
+
+#endif
@@ -14,7 +14,6 @@
 
 #include <mlpack/prereqs.hpp>
 #include <unordered_map>
-#include <boost/bimap.hpp>
 #include <mlpack/core/data/map_policies/datatype.hpp>
 
 namespace mlpack {
@@ -103,27 +102,26 @@ class IncrementPolicy
 
     // The token must be mapped.
 
-    // If this condition is true, either we have no mapping for the given string
-    // or we have no mappings for the given dimension at all.  In either case,
-    // we create a mapping.
-    if (maps.count(dimension) == 0 ||
-        maps[dimension].first.left.count(string) == 0)
+    // If there is no mapping for the given string (or no mappings for the
+    // given dimension at all), we create a mapping.
+    auto& map = maps[dimension];
+    const MappedType* value = map.first.Find(string);
+    if (value == NULL)
     {
       // This string does not exist yet.
-      size_t& numMappings = maps[dimension].second;
+      size_t& numMappings = map.second;
 
       // Change type of the feature to categorical.
       if (numMappings == 0)
         types[dimension] = Datatype::categorical;
 
-      typedef boost::bimap<std::string, MappedType>::value_type PairType;
-      maps[dimension].first.insert(PairType(string, numMappings));
+      map.first.Insert(string, numMappings);
       return T(numMappings++);
     }
     else
     {
       // This string already exists in the mapping.
-      return maps[dimension].first.left.at(string);
+      return T(*value);
     }
   }
 }; // class IncrementPolicy
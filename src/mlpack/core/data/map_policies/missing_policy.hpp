@@ -14,7 +14,6 @@
 
 #include <mlpack/prereqs.hpp>
 #include <unordered_map>
-#include <boost/bimap.hpp>
 #include <mlpack/core/data/map_policies/datatype.hpp>
 #include <limits>
 
@@ -101,14 +100,12 @@ class MissingPolicy
     {
       // Everything is mapped to NaN.  However we must still keep track of
       // everything that we have mapped, so we add it to the maps if needed.
-      if (maps.count(dimension) == 0 ||
-          maps[dimension].first.left.count(string) == 0)
+      auto& map = maps[dimension];
+      if (map.first.Find(string) == NULL)
       {
         // This string does not exist yet.
-        typedef boost::bimap<std::string, MappedType>::value_type PairType;
-        maps[dimension].first.insert(PairType(string,
-            std::numeric_limits<MappedType>::quiet_NaN()));
-        maps[dimension].second++;
+        map.first.Insert(string, std::numeric_limits<MappedType>::quiet_NaN());
+        map.second++;
       }
 
       return std::numeric_limits<T>::quiet_NaN();
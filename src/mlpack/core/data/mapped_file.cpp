@@ -0,0 +1,133 @@
+/**
+ * @file mapped_file.cpp
+ *
+ * Implementation of MappedFile.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "mapped_file.hpp"
+#include "compression.hpp"
+
+#include <fstream>
+#include <sstream>
+
+#ifndef _WIN32
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <fcntl.h>
+  #include <unistd.h>
+#endif
+
+using namespace mlpack;
+using namespace mlpack::data;
+
+MappedFile::MappedFile(const std::string& filename) :
+    filename(filename),
+    memory(NULL),
+    size(0),
+    mapped(false)
+{
+  if (FileCompression(filename) != Compression::none)
+  {
+    // The decompressed size isn't known in advance, so the buffer grows as the
+    // file is decompressed.
+    CompressedInputStream stream(filename);
+    const size_t blockSize = 1 << 20;
+    do
+    {
+      buffer.resize(size + blockSize);
+      stream.read(buffer.data() + size, blockSize);
+      size += (size_t) stream.gcount();
+    } while (stream);
+
+    buffer.resize(size);
+    memory = buffer.data();
+    return;
+  }
+
+#ifndef _WIN32
+  const int fd = open(filename.c_str(), O_RDONLY);
+  if (fd == -1)
+  {
+    std::ostringstream oss;
+    oss << "MappedFile::MappedFile(): cannot open file '" << filename << "'";
+    throw std::runtime_error(oss.str());
+  }
+
+  struct stat fileInfo;
+  if (fstat(fd, &fileInfo) == -1)
+  {
+    close(fd);
+    std::ostringstream oss;
+    oss << "MappedFile::MappedFile(): cannot stat file '" << filename << "'";
+    throw std::runtime_error(oss.str());
+  }
+
+  size = (size_t) fileInfo.st_size;
+  if (size > 0)
+  {
+    // A private mapping lets callers write to the memory (which copies only the
+    // written pages) without ever modifying the file.
+    void* result = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd,
+        0);
+    if (result == MAP_FAILED)
+    {
+      close(fd);
+      std::ostringstream oss;
+      oss << "MappedFile::MappedFile(): cannot map file '" << filename << "'";
+      throw std::runtime_error(oss.str());
+    }
+
+    memory = static_cast<char*>(result);
+    mapped = true;
+  }
+
+  // The mapping stays valid after the descriptor is closed.
+  close(fd);
+#else
+  std::ifstream stream(filename.c_str(), std::ios::binary | std::ios::ate);
+  if (!stream.is_open())
+  {
+    std::ostringstream oss;
+    oss << "MappedFile::MappedFile(): cannot open file '" << filename << "'";
+    throw std::runtime_error(oss.str());
+  }
+
+  size = (size_t) stream.tellg();
+  stream.seekg(0, std::ios::beg);
+  if (size > 0)
+  {
+    buffer.resize(size);
+    memory = buffer.data();
+    if (!stream.read(memory, size))
+    {
+      std::ostringstream oss;
+      oss << "MappedFile::MappedFile(): cannot read file '" << filename << "'";
+      throw std::runtime_error(oss.str());
+    }
+  }
+#endif
+}
+
+MappedFile::MappedFile(MappedFile&& other) :
+    filename(std::move(other.filename)),
+    memory(other.memory),
+    size(other.size),
+    mapped(other.mapped),
+    buffer(std::move(other.buffer))
+{
+  other.memory = NULL;
+  other.size = 0;
+  other.mapped = false;
+}
+
+MappedFile::~MappedFile()
+{
+#ifndef _WIN32
+  if (mapped)
+    munmap(memory, size);
+#endif
+}
@@ -0,0 +1,77 @@
+/**
+ * @file mapped_file.hpp
+ *
+ * A read-only view of a file on disk that is mapped into memory when the
+ * platform supports it.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_MAPPED_FILE_HPP
+#define MLPACK_CORE_DATA_MAPPED_FILE_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace data {
+
+/**
+ * MappedFile gives access to the contents of a file without reading it into
+ * memory first.  On POSIX systems the file is mapped with mmap() as a private
+ * (copy-on-write) mapping, so pages are loaded lazily on first access, and
+ * several processes mapping the same file share the same physical pages until
+ * one of them writes to a page.  On other systems the file is read into a
+ * buffer.  A compressed file (see FileCompression()) is decompressed into a
+ * buffer, so that the memory holds the decompressed data.
+ *
+ * The memory stays valid until the MappedFile object is destroyed, so any
+ * objects that alias the memory (for instance, Armadillo matrices constructed
+ * with copy_aux_mem = false) must not outlive it.  A MappedFile cannot be
+ * copied, but it can be moved (the memory stays where it is).
+ */
+class MappedFile
+{
+ public:
+  /**
+   * Map the given file into memory.  A std::runtime_error is thrown if the
+   * file cannot be opened or mapped.
+   *
+   * @param filename Name of file to map.
+   */
+  MappedFile(const std::string& filename);
+
+  //! Unmap the file.
+  ~MappedFile();
+
+  MappedFile(const MappedFile& other) = delete;
+  MappedFile& operator=(const MappedFile& other) = delete;
+
+  //! Take the mapping of the given MappedFile, which is left empty.
+  MappedFile(MappedFile&& other);
+
+  //! Get the mapped memory.
+  char* Memory() const { return memory; }
+  //! Get the size of the mapped memory in bytes.
+  size_t Size() const { return size; }
+  //! Get the name of the mapped file.
+  const std::string& Filename() const { return filename; }
+
+ private:
+  //! The name of the mapped file.
+  std::string filename;
+  //! The mapped memory.
+  char* memory;
+  //! The size of the mapped memory.
+  size_t size;
+  //! Whether the memory was obtained with mmap() (otherwise it is a buffer).
+  bool mapped;
+  //! The buffer holding the contents of the file, if it isn't mapped.
+  std::vector<char> buffer;
+};
+
+} // namespace data
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,141 @@
+/**
+ * @file matrix_file.hpp
+ *
+ * The mlpack binary matrix format (.mlm), which stores a matrix exactly as it
+ * is held in memory so that it can be mapped into memory instead of loaded.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_MATRIX_FILE_HPP
+#define MLPACK_CORE_DATA_MATRIX_FILE_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include <memory>
+
+#include "mapped_file.hpp"
+
+namespace mlpack {
+namespace data {
+
+/**
+ * The header at the start of an mlpack binary matrix file.  The elements
+ * follow at dataOffset, in column-major order and in the byte order of the
+ * machine that wrote them, so a matrix of points is stored with one point per
+ * column, as mlpack uses it.
+ */
+struct MatrixFileHeader
+{
+  //! Identifies the file; always "mlpkmat" (with the terminating zero).
+  char magic[8];
+  //! Version of the layout.
+  uint64_t version;
+  //! Kind of the elements: 0 for unsigned integers, 1 for signed integers and
+  //! 2 for floating-point numbers.
+  uint32_t elemKind;
+  //! Size of one element in bytes.
+  uint32_t elemSize;
+  //! Number of rows of the matrix.
+  uint64_t nRows;
+  //! Number of columns of the matrix.
+  uint64_t nCols;
+  //! Alignment of the elements in bytes.
+  uint64_t alignment;
+  //! Offset of the elements from the start of the file.
+  uint64_t dataOffset;
+};
+
+//! Alignment of the elements of an mlpack binary matrix file, in bytes.
+const size_t MatrixFileAlignment = 64;
+
+//! Get the kind of the given element type, as stored in MatrixFileHeader.
+template<typename eT>
+inline uint32_t MatrixFileElemKind()
+{
+  return std::is_floating_point<eT>::value ? 2 :
+      (std::is_signed<eT>::value ? 1 : 0);
+}
+
+/**
+ * Save the given matrix as an mlpack binary matrix file.  A std::runtime_error
+ * is thrown if the file can't be written.
+ *
+ * @param filename Name of file to save to.
+ * @param matrix Matrix to save.
+ */
+template<typename eT>
+void SaveMatrixFile(const std::string& filename, const arma::Mat<eT>& matrix);
+
+/**
+ * A read-only matrix whose elements live in an mlpack binary matrix file mapped
+ * into memory (see MappedFile), so that opening it takes no time and no memory
+ * of its own no matter how large the matrix is.  The pages of the file are
+ * loaded on first access and shared through the page cache, so several
+ * processes using the same file only hold one copy of it.
+ *
+ * Matrix() is an Armadillo matrix that aliases the mapped memory (it is
+ * constructed with copy_aux_mem = false and strict = true), so it can be given
+ * to anything that takes a const arma::Mat<eT>&.  It is valid until the
+ * MappedMatrix is destroyed or mapped to another file; a copy of it owns its
+ * memory.  The file must not be changed while it is mapped.
+ *
+ * @code
+ * data::MappedMatrix<> points("points.mlm");
+ * arma::Row<size_t> assignments;
+ * kmeans::KMeans<> k;
+ * k.Cluster(points.Matrix(), 10, assignments);
+ * @endcode
+ *
+ * @tparam eT Element type; it must have the kind and size of the stored
+ *     elements.
+ */
+template<typename eT = double>
+class MappedMatrix
+{
+ public:
+  //! Create an empty matrix that isn't mapped to any file.
+  MappedMatrix();
+
+  /**
+   * Map the given file.  A std::runtime_error is thrown if the file can't be
+   * mapped, isn't an mlpack binary matrix file, or holds elements of another
+   * type.
+   *
+   * @param filename Name of file to map.
+   */
+  MappedMatrix(const std::string& filename);
+
+  //! The mapping can't be copied; copy Matrix() instead.
+  MappedMatrix(const MappedMatrix&) = delete;
+  MappedMatrix& operator=(const MappedMatrix&) = delete;
+
+  /**
+   * Map the given file, replacing the current mapping.  A std::runtime_error is
+   * thrown if the file can't be used, and then the current mapping is kept.
+   *
+   * @param filename Name of file to map.
+   */
+  void Map(const std::string& filename);
+
+  //! Get the matrix.
+  const arma::Mat<eT>& Matrix() const { return *matrix; }
+  //! Get whether a file is mapped.
+  bool Mapped() const { return (file != NULL); }
+
+ private:
+  //! The mapped file, if any.
+  std::unique_ptr<MappedFile> file;
+  //! The matrix aliasing the mapped elements.
+  std::unique_ptr<arma::Mat<eT>> matrix;
+};
+
+} // namespace data
+} // namespace mlpack
+
+// Include implementation.
+#include "matrix_file_impl.hpp"
+
+#endif
@@ -0,0 +1,111 @@
+/**
+ * @file matrix_file_impl.hpp
+ *
+ * Implementation of SaveMatrixFile() and MappedMatrix.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_MATRIX_FILE_IMPL_HPP
+#define MLPACK_CORE_DATA_MATRIX_FILE_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "matrix_file.hpp"
+
+#include <cstring>
+#include <fstream>
+
+namespace mlpack {
+namespace data {
+
+template<typename eT>
+void SaveMatrixFile(const std::string& filename, const arma::Mat<eT>& matrix)
+{
+  MatrixFileHeader header;
+  std::memset(&header, 0, sizeof(MatrixFileHeader));
+  std::strncpy(header.magic, "mlpkmat", sizeof(header.magic));
+  header.version = 1;
+  header.elemKind = MatrixFileElemKind<eT>();
+  header.elemSize = sizeof(eT);
+  header.nRows = matrix.n_rows;
+  header.nCols = matrix.n_cols;
+  header.alignment = MatrixFileAlignment;
+  header.dataOffset = (sizeof(MatrixFileHeader) + MatrixFileAlignment - 1) /
+      MatrixFileAlignment * MatrixFileAlignment;
+
+  std::ofstream stream(filename.c_str(), std::ios::binary);
+  const std::string padding(header.dataOffset - sizeof(MatrixFileHeader),
+      '\0');
+  stream.write(reinterpret_cast<const char*>(&header),
+      sizeof(MatrixFileHeader));
+  stream.write(padding.data(), padding.size());
+  stream.write(reinterpret_cast<const char*>(matrix.memptr()),
+      sizeof(eT) * matrix.n_elem);
+
+  if (!stream.good())
+  {
+    throw std::runtime_error("SaveMatrixFile(): cannot write file '" +
+        filename + "'");
+  }
+}
+
+template<typename eT>
+MappedMatrix<eT>::MappedMatrix() :
+    matrix(new arma::Mat<eT>())
+{
+  // Nothing to do.
+}
+
+template<typename eT>
+MappedMatrix<eT>::MappedMatrix(const std::string& filename)
+{
+  Map(filename);
+}
+
+template<typename eT>
+void MappedMatrix<eT>::Map(const std::string& filename)
+{
+  std::unique_ptr<MappedFile> newFile(new MappedFile(filename));
+
+  MatrixFileHeader header;
+  if (newFile->Size() >= sizeof(MatrixFileHeader))
+    std::memcpy(&header, newFile->Memory(), sizeof(MatrixFileHeader));
+  if (newFile->Size() < sizeof(MatrixFileHeader) ||
+      std::strncmp(header.magic, "mlpkmat", sizeof(header.magic)) != 0 ||
+      header.version != 1)
+  {
+    throw std::runtime_error("MappedMatrix::Map(): '" + filename + "' is not "
+        "an mlpack binary matrix file");
+  }
+
+  if (header.elemKind != MatrixFileElemKind<eT>() ||
+      header.elemSize != sizeof(eT))
+  {
+    throw std::runtime_error("MappedMatrix::Map(): '" + filename + "' holds "
+        "elements of a different type than the matrix");
+  }
+
+  // Check the size without overflowing.
+  const uint64_t available = (header.dataOffset <= newFile->Size()) ?
+      newFile->Size() - header.dataOffset : 0;
+  if (header.dataOffset % sizeof(eT) != 0 ||
+      header.dataOffset > newFile->Size() || (header.nRows > 0 &&
+      header.nCols > available / sizeof(eT) / header.nRows))
+  {
+    throw std::runtime_error("MappedMatrix::Map(): '" + filename + "' is "
+        "truncated or corrupt");
+  }
+
+  // The matrix must alias the new file before the old one is unmapped.
+  eT* elements = reinterpret_cast<eT*>(newFile->Memory() + header.dataOffset);
+  matrix.reset(new arma::Mat<eT>(elements, header.nRows, header.nCols, false,
+      true));
+  file = std::move(newFile);
+}
+
+} // namespace data
+} // namespace mlpack
+
+#endif
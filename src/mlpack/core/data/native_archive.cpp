@@ -0,0 +1,34 @@
+/**
+ * @file native_archive.cpp
+ *
+ * Instantiation of the boost::archive templates for the native archives.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "native_archive.hpp"
+
+#include <boost/archive/impl/archive_serializer_map.ipp>
+#include <boost/archive/impl/basic_binary_oarchive.ipp>
+#include <boost/archive/impl/basic_binary_iarchive.ipp>
+#include <boost/archive/impl/basic_binary_oprimitive.ipp>
+#include <boost/archive/impl/basic_binary_iprimitive.ipp>
+
+namespace boost {
+namespace archive {
+
+// The boost::serialization library only holds these templates for its own
+// archives.
+template class detail::archive_serializer_map<mlpack::data::NativeOArchive>;
+template class detail::archive_serializer_map<mlpack::data::NativeIArchive>;
+template class basic_binary_oarchive<mlpack::data::NativeOArchive>;
+template class basic_binary_iarchive<mlpack::data::NativeIArchive>;
+template class basic_binary_oprimitive<mlpack::data::NativeOArchive,
+    std::ostream::char_type, std::ostream::traits_type>;
+template class basic_binary_iprimitive<mlpack::data::NativeIArchive,
+    std::istream::char_type, std::istream::traits_type>;
+
+} // namespace archive
+} // namespace boost
@@ -0,0 +1,147 @@
+/**
+ * @file native_archive.hpp
+ *
+ * A binary boost::serialization archive for models that are saved and loaded
+ * on the same kind of machine, which writes the elements of matrices as single
+ * aligned blocks.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_NATIVE_ARCHIVE_HPP
+#define MLPACK_CORE_DATA_NATIVE_ARCHIVE_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include <istream>
+#include <ostream>
+
+#include <boost/archive/binary_oarchive_impl.hpp>
+#include <boost/archive/binary_iarchive_impl.hpp>
+#include <boost/archive/detail/register_archive.hpp>
+
+namespace mlpack {
+namespace data {
+
+/**
+ * NativeOArchive is the archive of format::native.  It is a binary archive
+ * without the header of boost::archive::binary_oarchive (the file starts with
+ * the model) and without codecvt facets on the stream, and the elements of
+ * each matrix start at an offset of the stream that is a multiple of
+ * NativeOArchive::Alignment, so that a matrix is written with one write() of
+ * its memory and can be read back with one read().  Like binary archives, the
+ * files can only be read on machines with the same byte order and type sizes.
+ */
+class NativeOArchive :
+    public boost::archive::binary_oarchive_impl<NativeOArchive,
+        std::ostream::char_type, std::ostream::traits_type>
+{
+ public:
+  //! The alignment of the elements of matrices in the stream, in bytes.
+  static const size_t Alignment = 64;
+
+  /**
+   * Create the archive for the given stream, which should be opened in binary
+   * mode.
+   *
+   * @param stream Stream to write to.
+   */
+  explicit NativeOArchive(std::ostream& stream) :
+      boost::archive::binary_oarchive_impl<NativeOArchive,
+          std::ostream::char_type, std::ostream::traits_type>(stream,
+          boost::archive::no_header | boost::archive::no_codecvt)
+  { }
+
+  /**
+   * Pad the stream so that the next byte is at an offset that is a multiple of
+   * Alignment: one byte holds the number of padding bytes, and the padding
+   * bytes follow.  If the position of the stream is unknown, there are no
+   * padding bytes.
+   */
+  void Align()
+  {
+    const std::streamoff position = this->m_sb.pubseekoff(0,
+        std::ios_base::cur, std::ios_base::out);
+    unsigned char padding = 0;
+    if (position >= 0)
+      padding = (Alignment - ((size_t) position + 1) % Alignment) % Alignment;
+
+    const char zeros[Alignment] = { 0 };
+    this->save_binary(&padding, 1);
+    if (padding > 0)
+      this->save_binary(zeros, padding);
+  }
+
+ private:
+  // The boost::archive base classes call the members of the derived archive.
+  friend class boost::archive::detail::interface_oarchive<NativeOArchive>;
+  friend class boost::archive::basic_binary_oarchive<NativeOArchive>;
+  friend class boost::archive::basic_binary_oprimitive<NativeOArchive,
+      std::ostream::char_type, std::ostream::traits_type>;
+  friend class boost::archive::save_access;
+};
+
+/**
+ * NativeIArchive reads the archives written by NativeOArchive.
+ */
+class NativeIArchive :
+    public boost::archive::binary_iarchive_impl<NativeIArchive,
+        std::istream::char_type, std::istream::traits_type>
+{
+ public:
+  /**
+   * Create the archive for the given stream, which should be opened in binary
+   * mode.
+   *
+   * @param stream Stream to read from.
+   */
+  explicit NativeIArchive(std::istream& stream) :
+      boost::archive::binary_iarchive_impl<NativeIArchive,
+          std::istream::char_type, std::istream::traits_type>(stream,
+          boost::archive::no_header | boost::archive::no_codecvt)
+  { }
+
+  //! Skip the padding written by NativeOArchive::Align().
+  void Align()
+  {
+    unsigned char padding;
+    this->load_binary(&padding, 1);
+
+    char skipped[NativeOArchive::Alignment];
+    if (padding > 0)
+      this->load_binary(skipped, padding);
+  }
+
+ private:
+  // The boost::archive base classes call the members of the derived archive.
+  friend class boost::archive::detail::interface_iarchive<NativeIArchive>;
+  friend class boost::archive::basic_binary_iarchive<NativeIArchive>;
+  friend class boost::archive::basic_binary_iprimitive<NativeIArchive,
+      std::istream::char_type, std::istream::traits_type>;
+  friend class boost::archive::load_access;
+};
+
+//! Matrices are aligned in the native archive.
+template<>
+struct ArchiveAlignment<NativeOArchive>
+{
+  static void Align(NativeOArchive& ar) { ar.Align(); }
+};
+
+//! Matrices are aligned in the native archive.
+template<>
+struct ArchiveAlignment<NativeIArchive>
+{
+  static void Align(NativeIArchive& ar) { ar.Align(); }
+};
+
+} // namespace data
+} // namespace mlpack
+
+// Classes exported with BOOST_CLASS_EXPORT can be saved in the archives.
+BOOST_SERIALIZATION_REGISTER_ARCHIVE(mlpack::data::NativeOArchive)
+BOOST_SERIALIZATION_REGISTER_ARCHIVE(mlpack::data::NativeIArchive)
+
+#endif
@@ -19,6 +19,7 @@
 #include <string>
 
 #include "format.hpp"
+#include "matrix_file.hpp"
 
 namespace mlpack {
 namespace data /** Functions to load and save matrices. */ {
@@ -38,6 +39,16 @@ namespace data /** Functions to load and save matrices. */ {
  *  - Raw binary (raw_binary), denoted by .bin
  *  - Armadillo binary (arma_binary), denoted by .bin
  *  - HDF5 (hdf5_binary), denoted by .hdf5, .hdf, .h5, or .he5
+ *  - mlpack binary matrix, denoted by .mlm
+ *
+ * An mlpack binary matrix file holds the matrix as it is held in memory (so
+ * 'transpose' is ignored for it), and can be mapped into memory instead of
+ * loaded; see MappedMatrix.
+ *
+ * The data is compressed if the filename ends in .zst (zstd) or .lz4 (LZ4), and
+ * mlpack was compiled with the library; the type is then given by the
+ * extension before it (so "data.csv.zst" is compressed CSV).  HDF5 files and
+ * mlpack binary matrices can't be compressed.
  *
  * If the file extension is not one of those types, an error will be given.  If
  * the 'fatal' parameter is set to true, a std::runtime_error exception will be
@@ -69,11 +80,16 @@ bool Save(const std::string& filename,
  *  - text, denoted by .txt
  *  - xml, denoted by .xml
  *  - binary, denoted by .bin
+ *  - native binary (see NativeOArchive), denoted by .mlb
  *
  * The format parameter can take any of the values in the 'format' enum:
- * 'format::autodetect', 'format::text', 'format::xml', and 'format::binary'.
+ * 'format::autodetect', 'format::text', 'format::xml', 'format::binary', and
+ * 'format::native'.  The native format is the fastest to save and load large
+ * models, but, like binary, can only be read on the same kind of machine.
  * The autodetect functionality operates on the file extension (so, "file.txt"
- * would be autodetected as text).
+ * would be autodetected as text).  The model is compressed as it is written if
+ * the filename ends in .zst (zstd) or .lz4 (LZ4), and its format is given by
+ * the extension before that (so "model.bin.zst" is compressed binary).
  *
  * The name parameter should be specified to indicate the name of the structure
  * to be saved.  If Load() is later called on the generated file, the name used
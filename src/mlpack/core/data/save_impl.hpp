@@ -15,11 +15,13 @@
 // In case it hasn't already been included.
 #include "save.hpp"
 #include "extension.hpp"
+#include "compression.hpp"
 
 #include <boost/serialization/serialization.hpp>
 #include <boost/archive/xml_oarchive.hpp>
 #include <boost/archive/text_oarchive.hpp>
 #include <boost/archive/binary_oarchive.hpp>
+#include "native_archive.hpp"
 
 #include "serialization_shim.hpp"
 
@@ -51,8 +53,10 @@ bool Save(const std::string& filename,
 {
   Timer::Start("saving_data");
 
-  // First we will try to discriminate by file extension.
-  std::string extension = Extension(filename);
+  // First we will try to discriminate by file extension (of the data, if the
+  // file is compressed).
+  const bool compressed = (FileCompression(filename) != Compression::none);
+  std::string extension = Extension(UncompressedName(filename));
   if (extension == "")
   {
     Timer::Stop("saving_data");
@@ -66,14 +70,81 @@ bool Save(const std::string& filename,
     return false;
   }
 
-  // Catch errors opening the file.
-  std::fstream stream;
+  // mlpack binary matrices are meant to be mapped, and HDF5 has its own
+  // compression.
+  if (compressed && (extension == "mlm" || extension == "h5" ||
+      extension == "hdf5" || extension == "hdf" || extension == "he5"))
+  {
+    Timer::Stop("saving_data");
+    if (fatal)
+      Log::Fatal << "Cannot save compressed '" << extension << "' data to '"
+          << filename << "'.  Save failed." << std::endl;
+    else
+      Log::Warn << "Cannot save compressed '" << extension << "' data to '"
+          << filename << "'; save failed." << std::endl;
+
+    return false;
+  }
+
+  // mlpack binary matrices are written as they are held in memory.
+  if (extension == "mlm")
+  {
+    Log::Info << "Saving mlpack binary matrix to '" << filename << "'."
+        << std::endl;
+    try
+    {
+      SaveMatrixFile(filename, matrix);
+    }
+    catch (std::exception& e)
+    {
+      Timer::Stop("saving_data");
+      if (fatal)
+        Log::Fatal << e.what() << std::endl;
+      else
+        Log::Warn << e.what() << std::endl;
+
+      return false;
+    }
+
+    Timer::Stop("saving_data");
+    return true;
+  }
+
+  // Catch errors opening the file.  A compressed file is written through a
+  // CompressedOutputStream.
+  std::fstream fileStream;
+  std::unique_ptr<CompressedOutputStream> compressedStream;
+  if (compressed)
+  {
+    try
+    {
+      compressedStream.reset(new CompressedOutputStream(filename));
+    }
+    catch (std::exception& e)
+    {
+      Timer::Stop("saving_data");
+      if (fatal)
+        Log::Fatal << e.what() << std::endl;
+      else
+        Log::Warn << e.what() << std::endl;
+
+      return false;
+    }
+  }
+  else
+  {
 #ifdef  _WIN32 // Always open in binary mode on Windows.
-  stream.open(filename.c_str(), std::fstream::out | std::fstream::binary);
+    fileStream.open(filename.c_str(), std::fstream::out |
+        std::fstream::binary);
 #else
-  stream.open(filename.c_str(), std::fstream::out);
+    fileStream.open(filename.c_str(), std::fstream::out);
 #endif
-  if (!stream.is_open())
+  }
+  std::ostream& stream = compressed ?
+      static_cast<std::ostream&>(*compressedStream) :
+      static_cast<std::ostream&>(fileStream);
+
+  if (!compressed && !fileStream.is_open())
   {
     Timer::Stop("saving_data");
     if (fatal)
@@ -195,6 +266,25 @@ bool Save(const std::string& filename,
     }
   }
 
+  // Finish the compressed file.
+  if (compressed)
+  {
+    try
+    {
+      compressedStream->Close();
+    }
+    catch (std::exception& e)
+    {
+      Timer::Stop("saving_data");
+      if (fatal)
+        Log::Fatal << e.what() << std::endl;
+      else
+        Log::Warn << e.what() << std::endl;
+
+      return false;
+    }
+  }
+
   Timer::Stop("saving_data");
 
   // Finally return success.
@@ -211,7 +301,7 @@ bool Save(const std::string& filename,
 {
   if (f == format::autodetect)
   {
-    std::string extension = Extension(filename);
+    std::string extension = Extension(UncompressedName(filename));
 
     if (extension == "xml")
       f = format::xml;
@@ -219,32 +309,51 @@ bool Save(const std::string& filename,
       f = format::binary;
     else if (extension == "txt")
       f = format::text;
+    else if (extension == "mlb")
+      f = format::native;
     else
     {
       if (fatal)
         Log::Fatal << "Unable to detect type of '" << filename << "'; incorrect"
-            << " extension? (allowed: xml/bin/txt)" << std::endl;
+            << " extension? (allowed: xml/bin/txt/mlb)" << std::endl;
       else
         Log::Warn << "Unable to detect type of '" << filename << "'; save "
-            << "failed.  Incorrect extension? (allowed: xml/bin/txt)"
+            << "failed.  Incorrect extension? (allowed: xml/bin/txt/mlb)"
             << std::endl;
 
       return false;
     }
   }
 
-  // Open the file to save to.
+  // Open the file to save to; a compressed file (.zst or .lz4) is compressed
+  // as the archive is written.
   std::ofstream ofs;
-#ifdef _WIN32
-  if (f == format::binary) // Open non-text types in binary mode on Windows.
-    ofs.open(filename, std::ofstream::out | std::ofstream::binary);
+  std::unique_ptr<CompressedOutputStream> compressedStream;
+  if (FileCompression(filename) != Compression::none)
+  {
+    try
+    {
+      compressedStream.reset(new CompressedOutputStream(filename));
+    }
+    catch (std::exception& /* e */)
+    {
+      // The error is given below.
+    }
+  }
   else
-    ofs.open(filename, std::ofstream::out);
+  {
+#ifdef _WIN32
+    // Open non-text types in binary mode on Windows.
+    if (f == format::binary || f == format::native)
+      ofs.open(filename, std::ofstream::out | std::ofstream::binary);
+    else
+      ofs.open(filename, std::ofstream::out);
 #else
-  ofs.open(filename, std::ofstream::out);
+    ofs.open(filename, std::ofstream::out);
 #endif
+  }
 
-  if (!ofs.is_open())
+  if (!ofs.is_open() && !compressedStream)
   {
     if (fatal)
       Log::Fatal << "Unable to open file '" << filename << "' to save object '"
@@ -256,27 +365,40 @@ bool Save(const std::string& filename,
     return false;
   }
 
+  std::ostream& stream = compressedStream ?
+      static_cast<std::ostream&>(*compressedStream) :
+      static_cast<std::ostream&>(ofs);
   try
   {
+    // Each archive finishes writing when it is destroyed, so the compressed
+    // file is closed after that.
     if (f == format::xml)
     {
-      boost::archive::xml_oarchive ar(ofs);
+      boost::archive::xml_oarchive ar(stream);
       ar << CreateNVP(t, name);
     }
     else if (f == format::text)
     {
-      boost::archive::text_oarchive ar(ofs);
+      boost::archive::text_oarchive ar(stream);
       ar << CreateNVP(t, name);
     }
     else if (f == format::binary)
     {
-      boost::archive::binary_oarchive ar(ofs);
+      boost::archive::binary_oarchive ar(stream);
       ar << CreateNVP(t, name);
     }
+    else if (f == format::native)
+    {
+      NativeOArchive ar(stream);
+      ar << CreateNVP(t, name);
+    }
+
+    if (compressedStream)
+      compressedStream->Close();
 
     return true;
   }
-  catch (boost::archive::archive_exception& e)
+  catch (std::exception& e)
   {
     if (fatal)
       Log::Fatal << e.what() << std::endl;
@@ -3,7 +3,8 @@
  * @author Tham Ngap Wei, Keon Kim
  *
  * Defines Split(), a utility function to split a dataset into a
- * training set and a test set.
+ * training set and a test set, and the functions that split the indices of a
+ * dataset (for splits and cross-validation folds) without copying it.
  *
  * mlpack is free software; you may redistribute it and/or modify it under the
  * terms of the 3-clause BSD license.  You should have received a copy of the
@@ -15,8 +16,238 @@
 
 #include <mlpack/prereqs.hpp>
 
+#include <map>
+
 namespace mlpack {
 namespace data {
+
+/**
+ * Split the indices of a dataset with the given number of points into a
+ * training set and a test set, with the given ratio of points in the test set.
+ * No data is copied; the index sets can be used with arma::Mat::cols() (for
+ * instance, `input.cols(testIndices)`), or by algorithms that train on a set
+ * of indices.  Split() uses these indices, so with the same random seed,
+ * both give the same split.
+ *
+ * @code
+ * arma::uvec trainIndices, testIndices;
+ * // Hold out 30% of the points for the test set.
+ * SplitIndices(input.n_cols, 0.3, trainIndices, testIndices);
+ * @endcode
+ *
+ * @param numPoints Number of points in the dataset.
+ * @param testRatio Percentage of dataset to use for test set (between 0 and 1).
+ * @param trainIndices Vector to store the indices of the training set into.
+ * @param testIndices Vector to store the indices of the test set into.
+ * @param shuffle If false, the training set is the first points and the test
+ *     set the last ones, in order.
+ */
+inline void SplitIndices(const size_t numPoints,
+                         const double testRatio,
+                         arma::uvec& trainIndices,
+                         arma::uvec& testIndices,
+                         const bool shuffle = true)
+{
+  const size_t testSize = static_cast<size_t>(numPoints * testRatio);
+  const size_t trainSize = numPoints - testSize;
+
+  arma::uvec order(numPoints);
+  for (size_t i = 0; i < numPoints; ++i)
+    order[i] = i;
+  if (shuffle)
+    order = arma::shuffle(order);
+
+  trainIndices = order.head(trainSize);
+  testIndices = order.tail(testSize);
+}
+
+/**
+ * Split the indices of a labeled dataset into a training set and a test set,
+ * so that each class has (up to rounding) the given ratio of its points in
+ * the test set.  Each set is shuffled.  As with SplitIndices(), no data is
+ * copied.
+ *
+ * @param labels Labels of the points of the dataset.
+ * @param testRatio Percentage of each class to put in the test set (between 0
+ *     and 1).
+ * @param trainIndices Vector to store the indices of the training set into.
+ * @param testIndices Vector to store the indices of the test set into.
+ */
+template<typename U>
+void StratifiedSplitIndices(const arma::Row<U>& labels,
+                            const double testRatio,
+                            arma::uvec& trainIndices,
+                            arma::uvec& testIndices)
+{
+  std::map<U, std::vector<arma::uword>> classes;
+  for (size_t i = 0; i < labels.n_elem; ++i)
+    classes[labels[i]].push_back(i);
+
+  std::vector<arma::uword> train, test;
+  for (const auto& c : classes)
+  {
+    const arma::uvec points = arma::shuffle(arma::uvec(c.second));
+    const size_t testSize = static_cast<size_t>(points.n_elem * testRatio);
+    for (size_t i = 0; i < points.n_elem; ++i)
+      (i < testSize ? test : train).push_back(points[i]);
+  }
+
+  trainIndices = arma::shuffle(arma::uvec(train));
+  testIndices = arma::shuffle(arma::uvec(test));
+}
+
+/**
+ * Assign each point of a dataset to one of k folds for cross-validation; the
+ * folds differ in size by at most one point.  Use FoldIndices() to get the
+ * training and test indices of each fold.  Since only the fold of each point
+ * is kept, k-fold cross-validation doesn't need any copy of the data.
+ *
+ * @code
+ * const size_t k = 10;
+ * const arma::Row<size_t> folds = KFoldAssignments(input.n_cols, k);
+ * for (size_t fold = 0; fold < k; ++fold)
+ * {
+ *   arma::uvec trainIndices, testIndices;
+ *   FoldIndices(folds, fold, trainIndices, testIndices);
+ *   ...
+ * }
+ * @endcode
+ *
+ * @param numPoints Number of points in the dataset.
+ * @param k Number of folds (at least 2, and at most numPoints).
+ * @param shuffle If false, each fold is a contiguous block of points, in
+ *     order.
+ * @return The fold of each point.
+ */
+inline arma::Row<size_t> KFoldAssignments(const size_t numPoints,
+                                          const size_t k,
+                                          const bool shuffle = true)
+{
+  if (k < 2 || k > numPoints)
+  {
+    std::ostringstream oss;
+    oss << "KFoldAssignments(): cannot make " << k << " folds of " << numPoints
+        << " points";
+    throw std::invalid_argument(oss.str());
+  }
+
+  arma::Row<size_t> folds(numPoints);
+  for (size_t i = 0; i < numPoints; ++i)
+    folds[i] = i * k / numPoints;
+
+  if (shuffle)
+    folds = arma::shuffle(folds);
+
+  return folds;
+}
+
+/**
+ * Assign each point of a labeled dataset to one of k folds for
+ * cross-validation, so that each class is spread evenly over the folds (the
+ * number of points of a class differs by at most one between folds, and so
+ * does the size of the folds).
+ *
+ * @param labels Labels of the points of the dataset.
+ * @param k Number of folds (at least 2, and at most the number of points).
+ * @param shuffle If false, the points of each class are dealt to the folds in
+ *     order; otherwise, in a random order.
+ * @return The fold of each point.
+ */
+template<typename U>
+arma::Row<size_t> StratifiedKFoldAssignments(const arma::Row<U>& labels,
+                                             const size_t k,
+                                             const bool shuffle = true)
+{
+  if (k < 2 || k > labels.n_elem)
+  {
+    std::ostringstream oss;
+    oss << "StratifiedKFoldAssignments(): cannot make " << k << " folds of "
+        << labels.n_elem << " points";
+    throw std::invalid_argument(oss.str());
+  }
+
+  std::map<U, std::vector<arma::uword>> classes;
+  for (size_t i = 0; i < labels.n_elem; ++i)
+    classes[labels[i]].push_back(i);
+
+  // The points of each class are dealt to the folds in turn, starting where
+  // the previous class stopped, so that the folds stay balanced.
+  arma::Row<size_t> folds(labels.n_elem);
+  size_t next = 0;
+  for (const auto& c : classes)
+  {
+    arma::uvec points(c.second);
+    if (shuffle)
+      points = arma::shuffle(points);
+
+    for (size_t i = 0; i < points.n_elem; ++i, ++next)
+      folds[points[i]] = next % k;
+  }
+
+  return folds;
+}
+
+/**
+ * Get the training and test indices of the given fold, from the fold of each
+ * point (as given by KFoldAssignments() or StratifiedKFoldAssignments()).
+ * The test set is the points of the fold, and the training set all the
+ * others; both are in increasing order.
+ *
+ * @param folds Fold of each point.
+ * @param fold Fold to get the indices of.
+ * @param trainIndices Vector to store the indices of the training set into.
+ * @param testIndices Vector to store the indices of the test set into.
+ */
+inline void FoldIndices(const arma::Row<size_t>& folds,
+                        const size_t fold,
+                        arma::uvec& trainIndices,
+                        arma::uvec& testIndices)
+{
+  trainIndices = arma::find(folds != fold);
+  testIndices = arma::find(folds == fold);
+}
+
+/**
+ * Get the training and test indices of the given fold of a time series, where
+ * the points are in time order and a model may only be trained on the past.
+ * The points are split into k + 1 contiguous blocks; fold i (counting from 0)
+ * trains on blocks 0 to i and tests on block i + 1.  Both sets are contiguous
+ * ranges, so instead of the indices, `input.cols(trainIndices.front(),
+ * trainIndices.back())` can be used, and a matrix that aliases the memory of
+ * those columns can be given to an algorithm without copying anything.
+ *
+ * @param numPoints Number of points in the series.
+ * @param k Number of folds (at least 1, and less than numPoints).
+ * @param fold Fold to get the indices of.
+ * @param trainIndices Vector to store the indices of the training set into.
+ * @param testIndices Vector to store the indices of the test set into.
+ */
+inline void TimeSeriesFoldIndices(const size_t numPoints,
+                                  const size_t k,
+                                  const size_t fold,
+                                  arma::uvec& trainIndices,
+                                  arma::uvec& testIndices)
+{
+  if (k < 1 || k >= numPoints || fold >= k)
+  {
+    std::ostringstream oss;
+    oss << "TimeSeriesFoldIndices(): cannot get fold " << fold << " of " << k
+        << " folds of " << numPoints << " points";
+    throw std::invalid_argument(oss.str());
+  }
+
+  const size_t trainEnd = (fold + 1) * numPoints / (k + 1);
+  const size_t testEnd = (fold + 2) * numPoints / (k + 1);
+
+  trainIndices.set_size(trainEnd);
+  for (size_t i = 0; i < trainEnd; ++i)
+    trainIndices[i] = i;
+
+  testIndices.set_size(testEnd - trainEnd);
+  for (size_t i = trainEnd; i < testEnd; ++i)
+    testIndices[i - trainEnd] = i;
+}
+
 /**
  * Given an input dataset and labels, split into a training set and test set.
  * Example usage below.  This overload places the split dataset into the four
@@ -54,28 +285,13 @@ void Split(const arma::Mat<T>& input,
            arma::Row<U>& testLabel,
            const double testRatio)
 {
-  const size_t testSize = static_cast<size_t>(input.n_cols * testRatio);
-  const size_t trainSize = input.n_cols - testSize;
-  trainData.set_size(input.n_rows, trainSize);
-  testData.set_size(input.n_rows, testSize);
-  trainLabel.set_size(trainSize);
-  testLabel.set_size(testSize);
-
-  const arma::Col<size_t> order =
-      arma::shuffle(arma::linspace<arma::Col<size_t>>(0, input.n_cols - 1,
-                                                      input.n_cols));
-
-  for (size_t i = 0; i != trainSize; ++i)
-  {
-    trainData.col(i) = input.col(order[i]);
-    trainLabel(i) = inputLabel(order[i]);
-  }
+  arma::uvec trainIndices, testIndices;
+  SplitIndices(input.n_cols, testRatio, trainIndices, testIndices);
 
-  for (size_t i = 0; i != testSize; ++i)
-  {
-    testData.col(i) = input.col(order[i + trainSize]);
-    testLabel(i) = inputLabel(order[i + trainSize]);
-  }
+  trainData = input.cols(trainIndices);
+  testData = input.cols(testIndices);
+  trainLabel = inputLabel.cols(trainIndices);
+  testLabel = inputLabel.cols(testIndices);
 }
 
 /**
@@ -105,23 +321,11 @@ void Split(const arma::Mat<T>& input,
            arma::Mat<T>& testData,
            const double testRatio)
 {
-  const size_t testSize = static_cast<size_t>(input.n_cols * testRatio);
-  const size_t trainSize = input.n_cols - testSize;
-  trainData.set_size(input.n_rows, trainSize);
-  testData.set_size(input.n_rows, testSize);
-
-  const arma::Col<size_t> order =
-      arma::shuffle(arma::linspace<arma::Col<size_t>>(0, input.n_cols -1,
-                                                      input.n_cols));
+  arma::uvec trainIndices, testIndices;
+  SplitIndices(input.n_cols, testRatio, trainIndices, testIndices);
 
-  for (size_t i = 0; i != trainSize; ++i)
-  {
-    trainData.col(i) = input.col(order[i]);
-  }
-  for (size_t i = 0; i != testSize; ++i)
-  {
-    testData.col(i) = input.col(order[i + trainSize]);
-  }
+  trainData = input.cols(trainIndices);
+  testData = input.cols(testIndices);
 }
 
 /**
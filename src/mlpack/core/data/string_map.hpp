@@ -0,0 +1,143 @@
+/**
+ * @file string_map.hpp
+ *
+ * A flat hash table that interns strings and maps each of them to a value, used
+ * by DatasetMapper to hold the mappings of categorical dimensions.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_STRING_MAP_HPP
+#define MLPACK_CORE_DATA_STRING_MAP_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace data {
+
+/**
+ * StringMap maps strings to values of type MappedType, and values back to
+ * strings.  The characters of all the strings are stored back to back in one
+ * buffer, and the strings are found through an open-addressing hash table with
+ * linear probing, so a lookup doesn't allocate memory and only compares
+ * strings that have the same hash; a lookup can be given a range of
+ * characters instead of a std::string, so the caller doesn't have to build one.
+ *
+ * The strings are numbered in the order they were inserted.  Finding the
+ * string of a value is a lookup in a dense array for integral values below
+ * the number of strings (such as those of IncrementPolicy), and a scan of the
+ * strings for other values (NaN values are equal to each other here, so that
+ * the strings that MissingPolicy maps to NaN can be found).
+ *
+ * @tparam MappedType Type of the values.
+ */
+template<typename MappedType>
+class StringMap
+{
+ public:
+  //! Create an empty map.
+  StringMap();
+
+  /**
+   * Find the value of the given string.
+   *
+   * @param string First character of the string.
+   * @param length Number of characters of the string.
+   * @return The value, or NULL if the string isn't mapped.
+   */
+  const MappedType* Find(const char* string, const size_t length) const;
+
+  //! Find the value of the given string (or NULL if it isn't mapped).
+  const MappedType* Find(const std::string& string) const
+  { return Find(string.data(), string.size()); }
+
+  /**
+   * Map the given string to the given value, unless it is mapped already.
+   *
+   * @param string First character of the string.
+   * @param length Number of characters of the string.
+   * @param value Value to map the string to.
+   * @return The index of the string, in the order of insertion.
+   */
+  size_t Insert(const char* string,
+                const size_t length,
+                const MappedType& value);
+
+  //! Map the given string to the given value, unless it is mapped already, and
+  //! return its index.
+  size_t Insert(const std::string& string, const MappedType& value)
+  { return Insert(string.data(), string.size(), value); }
+
+  /**
+   * Find the first string in the order of insertion that is mapped to the
+   * given value.
+   *
+   * @param value Value to find.
+   * @return Index of the string, or Size() if no string has the value.
+   */
+  size_t FindValue(const MappedType& value) const;
+
+  //! Get the number of strings.
+  size_t Size() const { return entries.size(); }
+  //! Get the string with the given index.
+  std::string String(const size_t index) const
+  {
+    return std::string(arena.data() + entries[index].offset,
+        entries[index].length);
+  }
+  //! Get the value of the string with the given index.
+  const MappedType& Value(const size_t index) const
+  { return entries[index].value; }
+
+  //! Remove all strings.
+  void Clear();
+
+  //! Serialize the map.
+  template<typename Archive>
+  void Serialize(Archive& ar, const unsigned int /* version */);
+
+ private:
+  //! A string of the map.
+  struct Entry
+  {
+    //! Offset of the first character in the arena.
+    size_t offset;
+    //! Number of characters.
+    size_t length;
+    //! Hash of the string.
+    size_t hash;
+    //! Value of the string.
+    MappedType value;
+  };
+
+  //! Hash the given string (FNV-1a).
+  static size_t Hash(const char* string, const size_t length);
+
+  //! Find the slot of the given string, or the empty slot it would go into.
+  size_t Slot(const char* string,
+              const size_t length,
+              const size_t hash) const;
+
+  //! Double the number of slots and re-insert the strings.
+  void Grow();
+
+  //! The characters of all the strings, back to back.
+  std::vector<char> arena;
+  //! The strings, in the order of insertion.
+  std::vector<Entry> entries;
+  //! The hash table: each slot is 0 if empty, or an index into entries plus 1.
+  //! The number of slots is a power of 2.
+  std::vector<size_t> slots;
+  //! The index of the string of each integral value (plus 1, or 0 if none).
+  std::vector<size_t> dense;
+};
+
+} // namespace data
+} // namespace mlpack
+
+// Include implementation.
+#include "string_map_impl.hpp"
+
+#endif
@@ -0,0 +1,208 @@
+/**
+ * @file string_map_impl.hpp
+ *
+ * Implementation of StringMap.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_STRING_MAP_IMPL_HPP
+#define MLPACK_CORE_DATA_STRING_MAP_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "string_map.hpp"
+
+#include <cstring>
+
+namespace mlpack {
+namespace data {
+
+//! Get the index of an integral value in a dense array.
+template<typename T>
+inline bool StringMapDenseIndex(const T& value,
+                                size_t& index,
+                                const std::true_type /* integral */)
+{
+  if (value < T())
+    return false;
+
+  index = (size_t) value;
+  return true;
+}
+
+//! Values that aren't integral have no index in a dense array.
+template<typename T>
+inline bool StringMapDenseIndex(const T& /* value */,
+                                size_t& /* index */,
+                                const std::false_type /* integral */)
+{
+  return false;
+}
+
+template<typename MappedType>
+StringMap<MappedType>::StringMap() :
+    slots(16, 0)
+{
+  // Nothing to do.
+}
+
+template<typename MappedType>
+const MappedType* StringMap<MappedType>::Find(const char* string,
+                                              const size_t length) const
+{
+  const size_t slot = Slot(string, length, Hash(string, length));
+  return (slots[slot] == 0) ? NULL : &entries[slots[slot] - 1].value;
+}
+
+template<typename MappedType>
+size_t StringMap<MappedType>::Insert(const char* string,
+                                     const size_t length,
+                                     const MappedType& value)
+{
+  const size_t hash = Hash(string, length);
+  size_t slot = Slot(string, length, hash);
+  if (slots[slot] != 0)
+    return slots[slot] - 1;
+
+  // Keep at least half of the slots empty, so that probes stay short.
+  if (2 * (entries.size() + 1) > slots.size())
+  {
+    Grow();
+    slot = Slot(string, length, hash);
+  }
+
+  Entry entry;
+  entry.offset = arena.size();
+  entry.length = length;
+  entry.hash = hash;
+  entry.value = value;
+  arena.insert(arena.end(), string, string + length);
+  entries.push_back(entry);
+  slots[slot] = entries.size();
+
+  // Only values below twice the number of strings are kept in the dense
+  // array, so that it stays small; others are found by a scan.
+  size_t index;
+  if (StringMapDenseIndex(value, index, std::is_integral<MappedType>()) &&
+      index < 2 * entries.size())
+  {
+    if (dense.size() <= index)
+      dense.resize(index + 1, 0);
+    if (dense[index] == 0)
+      dense[index] = entries.size();
+  }
+
+  return entries.size() - 1;
+}
+
+template<typename MappedType>
+size_t StringMap<MappedType>::FindValue(const MappedType& value) const
+{
+  size_t index;
+  if (StringMapDenseIndex(value, index, std::is_integral<MappedType>()) &&
+      index < dense.size() && dense[index] != 0)
+    return dense[index] - 1;
+
+  for (size_t i = 0; i < entries.size(); ++i)
+  {
+    const MappedType& other = entries[i].value;
+    if (other == value || (other != other && value != value))
+      return i;
+  }
+
+  return entries.size();
+}
+
+template<typename MappedType>
+void StringMap<MappedType>::Clear()
+{
+  arena.clear();
+  entries.clear();
+  slots.assign(16, 0);
+  dense.clear();
+}
+
+template<typename MappedType>
+template<typename Archive>
+void StringMap<MappedType>::Serialize(Archive& ar,
+                                      const unsigned int /* version */)
+{
+  // The strings and values are saved in the order of insertion; the table is
+  // rebuilt when loading.
+  std::vector<std::string> strings;
+  std::vector<MappedType> values;
+  if (Archive::is_saving::value)
+  {
+    for (size_t i = 0; i < entries.size(); ++i)
+    {
+      strings.push_back(String(i));
+      values.push_back(entries[i].value);
+    }
+  }
+
+  ar & data::CreateNVP(strings, "strings");
+  ar & data::CreateNVP(values, "values");
+
+  if (Archive::is_loading::value)
+  {
+    Clear();
+    for (size_t i = 0; i < strings.size(); ++i)
+      Insert(strings[i], values[i]);
+  }
+}
+
+template<typename MappedType>
+size_t StringMap<MappedType>::Hash(const char* string, const size_t length)
+{
+  uint64_t hash = 14695981039346656037ULL;
+  for (size_t i = 0; i < length; ++i)
+  {
+    hash ^= (unsigned char) string[i];
+    hash *= 1099511628211ULL;
+  }
+
+  // Mix the high bits into the low bits, which pick the slot.
+  return (size_t) (hash ^ (hash >> 32));
+}
+
+template<typename MappedType>
+size_t StringMap<MappedType>::Slot(const char* string,
+                                   const size_t length,
+                                   const size_t hash) const
+{
+  const size_t mask = slots.size() - 1;
+  size_t slot = hash & mask;
+  while (slots[slot] != 0)
+  {
+    const Entry& entry = entries[slots[slot] - 1];
+    if (entry.hash == hash && entry.length == length && (length == 0 ||
+        std::memcmp(arena.data() + entry.offset, string, length) == 0))
+      return slot;
+
+    slot = (slot + 1) & mask;
+  }
+
+  return slot;
+}
+
+template<typename MappedType>
+void StringMap<MappedType>::Grow()
+{
+  slots.assign(2 * slots.size(), 0);
+  const size_t mask = slots.size() - 1;
+  for (size_t i = 0; i < entries.size(); ++i)
+  {
+    size_t slot = entries[i].hash & mask;
+    while (slots[slot] != 0)
+      slot = (slot + 1) & mask;
+
+    slots[slot] = i + 1;
+  }
+}
+
+} // namespace data
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,158 @@
+/**
+ * @file diagonal_gaussian_distribution.cpp
+ *
+ * Implementation of the Gaussian distribution with a diagonal covariance.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "diagonal_gaussian_distribution.hpp"
+#include <mlpack/methods/gmm/positive_definite_constraint.hpp>
+
+using namespace mlpack;
+using namespace mlpack::distribution;
+
+DiagonalGaussianDistribution::DiagonalGaussianDistribution(
+    const arma::vec& mean,
+    const arma::vec& covariance) :
+    mean(mean)
+{
+  Covariance(covariance);
+}
+
+void DiagonalGaussianDistribution::Covariance(const arma::vec& covariance)
+{
+  this->covariance = covariance;
+  InvertCovariance();
+}
+
+void DiagonalGaussianDistribution::Covariance(arma::vec&& covariance)
+{
+  this->covariance = std::move(covariance);
+  InvertCovariance();
+}
+
+void DiagonalGaussianDistribution::InvertCovariance()
+{
+  invCov = 1.0 / covariance;
+  logDetCov = arma::accu(arma::log(covariance));
+}
+
+double DiagonalGaussianDistribution::LogProbability(
+    const arma::vec& observation) const
+{
+  const size_t k = observation.n_elem;
+  const arma::vec diff = observation - mean;
+  return -0.5 * k * log2pi - 0.5 * logDetCov -
+      0.5 * arma::dot(invCov, arma::square(diff));
+}
+
+void DiagonalGaussianDistribution::LogProbability(
+    const arma::mat& x,
+    arma::vec& logProbabilities) const
+{
+  logProbabilities.set_size(x.n_cols);
+  const double logNormalizer = -0.5 * x.n_rows * log2pi - 0.5 * logDetCov;
+  const size_t numBlocks = (x.n_cols + ObservationBlockSize - 1) /
+      ObservationBlockSize;
+
+  // A single block (for instance, when the caller is already processing
+  // blocks in parallel) isn't worth starting threads for.
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables. If we're building for Visual Studio, use
+  // the intmax_t type instead.
+  #pragma omp parallel for if (numBlocks > 1) schedule(static)
+  for (intmax_t b = 0; b < (intmax_t) numBlocks; ++b)
+#else
+  #pragma omp parallel for if (numBlocks > 1) schedule(static)
+  for (size_t b = 0; b < numBlocks; ++b)
+#endif
+  {
+    const size_t begin = b * ObservationBlockSize;
+    const size_t end = std::min(begin + ObservationBlockSize,
+        (size_t) x.n_cols);
+
+    // The Mahalanobis distance of each observation is the sum of its squared
+    // differences to the mean, weighted by the inverse variances.
+    const arma::mat diffs = x.cols(begin, end - 1).each_col() - mean;
+    logProbabilities.subvec(begin, end - 1) = logNormalizer -
+        0.5 * (arma::square(diffs).t() * invCov);
+  }
+}
+
+arma::vec DiagonalGaussianDistribution::Random() const
+{
+  return arma::sqrt(covariance) % arma::randn<arma::vec>(mean.n_elem) + mean;
+}
+
+/**
+ * Estimate the Gaussian distribution directly from the given observations.
+ *
+ * @param observations List of observations.
+ */
+void DiagonalGaussianDistribution::Train(const arma::mat& observations)
+{
+  if (observations.n_cols == 0)
+  {
+    // This will end up just being empty.
+    mean.zeros(0);
+    covariance.zeros(0);
+    InvertCovariance();
+    return;
+  }
+
+  mean = arma::mean(observations, 1);
+
+  // Use the (1 / (n - 1)) normalization so that the variances are unbiased.
+  const arma::mat diffs = observations.each_col() - mean;
+  covariance = arma::sum(arma::square(diffs), 1) /
+      std::max((double) observations.n_cols - 1, 1.0);
+
+  // Ensure that the variances are positive.
+  gmm::PositiveDefiniteConstraint::ApplyConstraint(covariance);
+
+  InvertCovariance();
+}
+
+/**
+ * Estimate the Gaussian distribution from the given observations, taking into
+ * account the probability of each observation actually being from this
+ * distribution.
+ */
+void DiagonalGaussianDistribution::Train(const arma::mat& observations,
+                                         const arma::vec& probabilities)
+{
+  if (observations.n_cols == 0)
+  {
+    // This will end up just being empty.
+    mean.zeros(0);
+    covariance.zeros(0);
+    InvertCovariance();
+    return;
+  }
+
+  const double sumProb = arma::accu(probabilities);
+  if (sumProb == 0)
+  {
+    // Nothing in this Gaussian!  At least set the variances so that they're
+    // invertible.
+    mean.zeros(observations.n_rows);
+    covariance.set_size(observations.n_rows);
+    covariance.fill(1e-50);
+    InvertCovariance();
+    return;
+  }
+
+  mean = observations * probabilities / sumProb;
+
+  const arma::mat diffs = observations.each_col() - mean;
+  covariance = arma::square(diffs) * probabilities / sumProb;
+
+  // Ensure that the variances are positive.
+  gmm::PositiveDefiniteConstraint::ApplyConstraint(covariance);
+
+  InvertCovariance();
+}
@@ -49,6 +49,41 @@ arma::vec DiscreteDistribution::Random() const
   return result;
 }
 
+/**
+ * Calculate the log probability of each observation of the given matrix.
+ */
+void DiscreteDistribution::LogProbability(const arma::mat& x,
+                                          arma::vec& logProbabilities) const
+{
+  if (x.n_rows != probabilities.size())
+  {
+    std::ostringstream oss;
+    oss << "DiscreteDistribution::LogProbability(): observations have "
+        << "dimension " << x.n_rows << " but should have dimension "
+        << probabilities.size();
+    throw std::invalid_argument(oss.str());
+  }
+
+  logProbabilities.zeros(x.n_cols);
+  for (size_t d = 0; d < x.n_rows; ++d)
+  {
+    // Adding 0.5 helps ensure that we cast the floating point to a size_t
+    // correctly.
+    const arma::uvec obs = arma::conv_to<arma::uvec>::from(x.row(d) + 0.5);
+    if (obs.n_elem > 0 && obs.max() >= probabilities[d].n_elem)
+    {
+      std::ostringstream oss;
+      oss << "DiscreteDistribution::LogProbability(): received observation "
+          << obs.max() << " in dimension " << d << "; observation must be in "
+          << "[0, " << probabilities[d].n_elem << "] for this distribution";
+      throw std::invalid_argument(oss.str());
+    }
+
+    const arma::vec logTable = arma::log(probabilities[d]);
+    logProbabilities += logTable.elem(obs);
+  }
+}
+
 /**
  * Estimate the probability distribution directly from the given observations.
  */
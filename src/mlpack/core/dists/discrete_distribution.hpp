@@ -168,6 +168,33 @@ class DiscreteDistribution
     return log(Probability(observation));
   }
 
+  /**
+   * Calculate the probability of each observation (column) of the given
+   * matrix.  A std::invalid_argument is thrown if an observation has the wrong
+   * dimension or is out of bounds.
+   *
+   * @param x List of observations.
+   * @param probabilities Output probabilities for each input observation.
+   */
+  void Probability(const arma::mat& x, arma::vec& probabilities) const
+  {
+    arma::vec logProbabilities;
+    LogProbability(x, logProbabilities);
+    probabilities = arma::exp(logProbabilities);
+  }
+
+  /**
+   * Calculate the log probability of each observation (column) of the given
+   * matrix, as the sum of the log probabilities of each dimension.  A
+   * std::invalid_argument is thrown if an observation has the wrong dimension
+   * or is out of bounds.
+   *
+   * @param x List of observations.
+   * @param logProbabilities Output log probabilities for each input
+   *     observation.
+   */
+  void LogProbability(const arma::mat& x, arma::vec& logProbabilities) const;
+
   /**
    * Return a randomly generated observation (one-dimensional vector; one
    * observation) according to the probability distribution defined by this
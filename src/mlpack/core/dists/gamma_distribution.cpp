@@ -73,21 +73,12 @@ void GammaDistribution::Train(const arma::mat& rdata,
   if (arma::size(rdata) == arma::size(arma::mat()))
     return;
 
-  arma::vec meanLogxVec(rdata.n_rows, arma::fill::zeros);
-  arma::vec meanxVec(rdata.n_rows, arma::fill::zeros);
-  arma::vec logMeanxVec(rdata.n_rows, arma::fill::zeros);
-
-  for (size_t i = 0; i < rdata.n_cols; i++)
-  {
-    meanLogxVec += probabilities(i) * arma::log(rdata.col(i));
-    meanxVec += probabilities(i) * rdata.col(i);
-  }
-
-  double totProbability = arma::accu(probabilities);
-
-  meanLogxVec /= totProbability;
-  meanxVec /= totProbability;
-  logMeanxVec = arma::log(meanxVec);
+  // The weighted means of each dimension are matrix-vector products.
+  const double totProbability = arma::accu(probabilities);
+  const arma::vec meanLogxVec = arma::log(rdata) * probabilities /
+      totProbability;
+  const arma::vec meanxVec = rdata * probabilities / totProbability;
+  const arma::vec logMeanxVec = arma::log(meanxVec);
 
   // Call the statistics-only GammaDistribution::Train() function to fit the
   // parameters. That function does all the work so we're done.
@@ -117,8 +108,20 @@ void GammaDistribution::Train(const arma::vec& logMeanxVec,
   alpha.set_size(ndim);
   beta.set_size(ndim);
 
-  // Treat each dimension (i.e. row) independently.
+  // Treat each dimension (i.e. row) independently, in parallel.  Exceptions
+  // can't leave an OpenMP loop, so each dimension records its error, and the
+  // first one is thrown afterwards.
+  std::vector<int> errors(ndim, 0);
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables. If we're building for Visual Studio, use
+  // the intmax_t type instead.
+  #pragma omp parallel for if (ndim > 1) schedule(dynamic)
+  for (intmax_t row = 0; row < (intmax_t) ndim; ++row)
+#else
+  #pragma omp parallel for if (ndim > 1) schedule(dynamic)
   for (size_t row = 0; row < ndim; ++row)
+#endif
   {
     // Statistics for this row.
     const double meanLogx = meanLogxVec(row);
@@ -142,48 +145,43 @@ void GammaDistribution::Train(const arma::vec& logMeanxVec,
 
       // Protect against division by 0.
       if (denominator == 0)
-        throw std::logic_error("GammaDistribution::Train() attempted division"
-            " by 0.");
+      {
+        errors[row] = 1;
+        break;
+      }
 
       aEst = 1.0 / ((1.0 / aEst) + nominator / denominator);
 
       // Protect against nan values (aEst will be passed to logarithm).
       if (aEst <= 0)
-        throw std::logic_error("GammaDistribution::Train(): estimated invalid "
-            "negative value for parameter alpha!");
+      {
+        errors[row] = 2;
+        break;
+      }
     } while (!Converged(aEst, aOld, tol));
 
     alpha(row) = aEst;
     beta(row) = meanx / aEst;
   }
+
+  for (size_t row = 0; row < ndim; ++row)
+  {
+    if (errors[row] == 1)
+      throw std::logic_error("GammaDistribution::Train() attempted division"
+          " by 0.");
+    else if (errors[row] == 2)
+      throw std::logic_error("GammaDistribution::Train(): estimated invalid "
+          "negative value for parameter alpha!");
+  }
 }
 
 // Returns the probability of the provided observations.
 void GammaDistribution::Probability(const arma::mat& observations,
                                     arma::vec& probabilities) const
 {
-  size_t numObs = observations.n_cols;
-
-  // Set all equal to 1 (multiplication neutral).
-  probabilities.ones(numObs);
-
-  // Compute denominator only once for each dimension.
-  arma::vec denominators(alpha.n_elem);
-  for (size_t d = 0; d < alpha.n_elem; ++d)
-    denominators(d) = std::tgamma(alpha(d)) * std::pow(beta(d), alpha(d));
-
-  // Compute probability of each observation.
-  for (size_t i = 0; i < numObs; ++i)
-  {
-    for (size_t d = 0; d < observations.n_rows; ++d)
-    {
-      // Compute probability using Multiplication Law.
-      double factor = std::exp(-observations(d, i) / beta(d));
-      double numerator = std::pow(observations(d, i), alpha(d) - 1);
-
-      probabilities(i) *= factor * numerator / denominators(d);
-    }
-  }
+  arma::vec logProbabilities;
+  LogProbability(observations, logProbabilities);
+  probabilities = arma::exp(logProbabilities);
 }
 
 // Returns the probability of one observation (x) for one of the Gamma's
@@ -198,28 +196,41 @@ double GammaDistribution::Probability(double x, size_t dim) const
 void GammaDistribution::LogProbability(const arma::mat& observations,
                                        arma::vec& LogProbabilities) const
 {
-  size_t numObs = observations.n_cols;
-
-  // Set all equal to 0 (addition neutral).
-  LogProbabilities.zeros(numObs);
+  const size_t numObs = observations.n_cols;
+  LogProbabilities.set_size(numObs);
 
-  // Compute denominator only once for each dimension.
-  arma::vec denominators(alpha.n_elem);
+  // The log of the denominator of each dimension is summed only once, with
+  // lgamma() so that large alphas don't overflow.
+  double logDenominator = 0.0;
   for (size_t d = 0; d < alpha.n_elem; ++d)
-    denominators(d) = std::tgamma(alpha(d)) * std::pow(beta(d), alpha(d));
-
-  // Compute probability of each observation.
+    logDenominator += std::lgamma(alpha(d)) + alpha(d) * std::log(beta(d));
+
+  // Small batches (such as the observations of one HMM sequence) aren't worth
+  // starting threads for.
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables. If we're building for Visual Studio, use
+  // the intmax_t type instead.
+  #pragma omp parallel for if (numObs >= 1024) schedule(static)
+  for (intmax_t i = 0; i < (intmax_t) numObs; ++i)
+#else
+  #pragma omp parallel for if (numObs >= 1024) schedule(static)
   for (size_t i = 0; i < numObs; ++i)
+#endif
   {
+    // Compute the log probability using the Multiplication Law and Logarithm
+    // addition property.
+    const double* observation = observations.colptr(i);
+    double logProbability = -logDenominator;
     for (size_t d = 0; d < observations.n_rows; ++d)
     {
-      // Compute probability using Multiplication Law and Logarithm addition
-      // property.
-      double factor = std::exp(-observations(d, i) / beta(d));
-      double numerator = std::pow(observations(d, i), alpha(d) - 1);
-
-      LogProbabilities(i) += std::log(numerator * factor / denominators(d));
+      // With alpha = 1, x^(alpha - 1) is 1 even for x = 0.
+      if (alpha(d) != 1.0)
+        logProbability += (alpha(d) - 1) * std::log(observation[d]);
+      logProbability -= observation[d] / beta(d);
     }
+
+    LogProbabilities(i) = logProbability;
   }
 }
 
@@ -111,6 +111,7 @@ class GammaDistribution
     /**
      * This function trains (fits distribution parameters) to a dataset with
      * pre-computed statistics logMeanx, meanLogx, meanx for each dimension.
+     * The dimensions are fitted in parallel when OpenMP is available.
      *
      * @param logMeanxVec Is each dimension's logarithm of the mean
      *     (log(mean(x))).
@@ -163,7 +164,9 @@ class GammaDistribution
      * {-\frac{x}{\beta}})
      *
      * for one dimension. This implementation assumes each dimension is
-     * independent, so the product rule is used.
+     * independent, so the product rule is used.  When OpenMP is available and
+     * there are many observations, the observations are processed in
+     * parallel.
      *
      * @param observations Matrix of observations, one per column.
      * @param logProbabilities column vector of log probabilities, one per
@@ -72,10 +72,46 @@ void GaussianDistribution::FactorCovariance()
 
 double GaussianDistribution::LogProbability(const arma::vec& observation) const
 {
+  // With cov = LL^T, the Mahalanobis distance diff^T cov^-1 diff is z^T z,
+  // where z solves Lz = diff.  The triangular solve costs half as much as a
+  // product with the inverse.
   const size_t k = observation.n_elem;
-  const arma::vec diff = mean - observation;
-  const arma::vec v = (diff.t() * invCov * diff);
-  return -0.5 * k * log2pi - 0.5 * logDetCov - 0.5 * v(0);
+  const arma::vec z = arma::solve(arma::trimatl(covLower), observation - mean);
+  return -0.5 * k * log2pi - 0.5 * logDetCov - 0.5 * arma::dot(z, z);
+}
+
+void GaussianDistribution::LogProbability(const arma::mat& x,
+                                          arma::vec& logProbabilities) const
+{
+  logProbabilities.set_size(x.n_cols);
+  const double logNormalizer = -0.5 * x.n_rows * log2pi - 0.5 * logDetCov;
+  const size_t numBlocks = (x.n_cols + ObservationBlockSize - 1) /
+      ObservationBlockSize;
+
+  // A single block (for instance, when the caller is already processing
+  // blocks in parallel) isn't worth starting threads for.
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables. If we're building for Visual Studio, use
+  // the intmax_t type instead.
+  #pragma omp parallel for if (numBlocks > 1) schedule(static)
+  for (intmax_t b = 0; b < (intmax_t) numBlocks; ++b)
+#else
+  #pragma omp parallel for if (numBlocks > 1) schedule(static)
+  for (size_t b = 0; b < numBlocks; ++b)
+#endif
+  {
+    const size_t begin = b * ObservationBlockSize;
+    const size_t end = std::min(begin + ObservationBlockSize,
+        (size_t) x.n_cols);
+
+    // Column i of z solves Lz = x.col(i) - mean, so the squared norm of each
+    // column of z is the Mahalanobis distance of the observation.
+    const arma::mat diffs = x.cols(begin, end - 1).each_col() - mean;
+    const arma::mat z = arma::solve(arma::trimatl(covLower), diffs);
+    logProbabilities.subvec(begin, end - 1) = logNormalizer -
+        0.5 * arma::sum(arma::square(z), 0).t();
+  }
 }
 
 arma::vec GaussianDistribution::Random() const
@@ -95,8 +95,23 @@ class GaussianDistribution
     probabilities = arma::exp(logProbabilities);
   }
 
+  /**
+   * Calculates the multivariate Gaussian log probability density function for
+   * each data point (column) in the given matrix.  The observations are
+   * processed in blocks of ObservationBlockSize columns, with a triangular
+   * solve against the Cholesky factor of the covariance for each block; when
+   * OpenMP is available and there is more than one block, the blocks are
+   * processed in parallel.
+   *
+   * @param x List of observations.
+   * @param logProbabilities Output log probabilities for each input
+   *     observation.
+   */
   void LogProbability(const arma::mat& x, arma::vec& logProbabilities) const;
 
+  //! The number of observations processed at once by LogProbability().
+  static const size_t ObservationBlockSize = 1024;
+
   /**
    * Return a randomly generated observation according to the probability
    * distribution defined by this object.
@@ -167,35 +182,6 @@ class GaussianDistribution
   void FactorCovariance();
 };
 
-/**
-* Calculates the multivariate Gaussian log probability density function for each
-* data point (column) in the given matrix
-*
-* @param x List of observations.
-* @param probabilities Output log probabilities for each input observation.
-*/
-inline void GaussianDistribution::LogProbability(
-    const arma::mat& x,
-    arma::vec& logProbabilities) const
-{
-  // Column i of 'diffs' is the difference between x.col(i) and the mean.
-  arma::mat diffs = x - (mean * arma::ones<arma::rowvec>(x.n_cols));
-
-  // Now, we only want to calculate the diagonal elements of (diffs' * cov^-1 *
-  // diffs).  We just don't need any of the other elements.  We can calculate
-  // the right hand part of the equation (instead of the left side) so that
-  // later we are referencing columns, not rows -- that is faster.
-  const arma::mat rhs = -0.5 * invCov * diffs;
-  arma::vec logExponents(diffs.n_cols); // We will now fill this.
-  for (size_t i = 0; i < diffs.n_cols; i++)
-    logExponents(i) = accu(diffs.unsafe_col(i) % rhs.unsafe_col(i));
-
-  const size_t k = x.n_rows;
-
-  logProbabilities = -0.5 * k * log2pi - 0.5 * logDetCov + logExponents;
-}
-
-
 } // namespace distribution
 } // namespace mlpack
 
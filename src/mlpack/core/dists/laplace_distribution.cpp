@@ -26,6 +26,37 @@ double LaplaceDistribution::LogProbability(const arma::vec& observation) const
   return -log(2. * scale) - arma::norm(observation - mean, 2) / scale;
 }
 
+/**
+ * Calculate the log probability of each observation of the given matrix.
+ */
+void LaplaceDistribution::LogProbability(const arma::mat& x,
+                                         arma::vec& logProbabilities) const
+{
+  logProbabilities.set_size(x.n_cols);
+  const double logNormalizer = -log(2. * scale);
+
+  // Small batches (such as the observations of one HMM sequence) aren't worth
+  // starting threads for.
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables. If we're building for Visual Studio, use
+  // the intmax_t type instead.
+  #pragma omp parallel for if (x.n_cols >= 1024) schedule(static)
+  for (intmax_t i = 0; i < (intmax_t) x.n_cols; ++i)
+#else
+  #pragma omp parallel for if (x.n_cols >= 1024) schedule(static)
+  for (size_t i = 0; i < x.n_cols; ++i)
+#endif
+  {
+    const double* observation = x.colptr(i);
+    double distance = 0.0;
+    for (size_t d = 0; d < x.n_rows; ++d)
+      distance += (observation[d] - mean[d]) * (observation[d] - mean[d]);
+
+    logProbabilities[i] = logNormalizer - std::sqrt(distance) / scale;
+  }
+}
+
 /**
  * Estimate the Laplace distribution directly from the given observations.
  *
@@ -53,10 +84,7 @@ void LaplaceDistribution::Estimate(const arma::mat& observations)
 
   // The maximum likelihood estimate of the scale parameter is the mean
   // deviation from the mean.
-  scale = 0.0;
-  for (size_t i = 0; i < observations.n_cols; ++i)
-    scale += arma::norm(observations.col(i) - mean, 2);
-  scale /= observations.n_cols;
+  scale = arma::mean(Deviations(observations));
 }
 
 /**
@@ -69,15 +97,20 @@ void LaplaceDistribution::Estimate(const arma::mat& observations,
 {
   // I am not completely sure that this change results in a valid maximum
   // likelihood estimator given probabilities of points.
-  mean.zeros(observations.n_rows);
-  for (size_t i = 0; i < observations.n_cols; ++i)
-    mean += observations.col(i) * probabilities(i);
-  mean /= arma::accu(probabilities);
+  const double totalProbability = arma::accu(probabilities);
+  mean = observations * probabilities / totalProbability;
 
   // This the same formula as the previous function, but here we are multiplying
   // by the probability that the point is actually from this distribution.
-  scale = 0.0;
-  for (size_t i = 0; i < observations.n_cols; ++i)
-    scale += probabilities(i) * arma::norm(observations.col(i) - mean, 2);
-  scale /= arma::accu(probabilities);
+  scale = arma::dot(Deviations(observations), probabilities) /
+      totalProbability;
+}
+
+/**
+ * Compute the distance of each observation to the mean.
+ */
+arma::vec LaplaceDistribution::Deviations(const arma::mat& observations) const
+{
+  return arma::sqrt(arma::sum(arma::square(observations.each_col() - mean),
+      0)).t();
 }
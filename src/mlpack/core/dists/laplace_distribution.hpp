@@ -90,6 +90,31 @@ class LaplaceDistribution
    */
   double LogProbability(const arma::vec& observation) const;
 
+  /**
+   * Calculate the probability of each observation (column) of the given
+   * matrix.
+   *
+   * @param x List of observations.
+   * @param probabilities Output probabilities for each input observation.
+   */
+  void Probability(const arma::mat& x, arma::vec& probabilities) const
+  {
+    arma::vec logProbabilities;
+    LogProbability(x, logProbabilities);
+    probabilities = arma::exp(logProbabilities);
+  }
+
+  /**
+   * Calculate the log probability of each observation (column) of the given
+   * matrix.  When OpenMP is available and there are many observations, the
+   * observations are processed in parallel.
+   *
+   * @param x List of observations.
+   * @param logProbabilities Output log probabilities for each input
+   *     observation.
+   */
+  void LogProbability(const arma::mat& x, arma::vec& logProbabilities) const;
+
   /**
    * Return a randomly generated observation according to the probability
    * distribution defined by this object.  This is inlined for speed.
@@ -130,6 +155,24 @@ class LaplaceDistribution
   void Estimate(const arma::mat& observations,
                 const arma::vec& probabilities);
 
+  /**
+   * Estimate the Laplace distribution directly from the given observations;
+   * this is the same as Estimate(), for code (such as HMM) that calls Train().
+   *
+   * @param observations List of observations.
+   */
+  void Train(const arma::mat& observations) { Estimate(observations); }
+
+  /**
+   * Estimate the Laplace distribution from the given observations, taking into
+   * account the probability of each observation actually being from this
+   * distribution; this is the same as Estimate().
+   */
+  void Train(const arma::mat& observations, const arma::vec& probabilities)
+  {
+    Estimate(observations, probabilities);
+  }
+
   //! Return the mean.
   const arma::vec& Mean() const { return mean; }
   //! Modify the mean.
@@ -151,6 +194,9 @@ class LaplaceDistribution
   }
 
  private:
+  //! Compute the distance of each observation to the mean.
+  arma::vec Deviations(const arma::mat& observations) const;
+
   //! Mean of the distribution.
   arma::vec mean;
   //! Scale parameter of the distribution.
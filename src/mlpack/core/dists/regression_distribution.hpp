@@ -128,6 +128,33 @@ class RegressionDistribution
     return log(Probability(observation));
   }
 
+  /**
+   * Evaluate the probability density function of each observation (column) of
+   * the given matrix.
+   *
+   * @param observations Points to evaluate the probability at.
+   * @param probabilities Output probabilities for each observation.
+   */
+  void Probability(const arma::mat& observations,
+                   arma::vec& probabilities) const
+  {
+    arma::vec logProbabilities;
+    LogProbability(observations, logProbabilities);
+    probabilities = arma::exp(logProbabilities);
+  }
+
+  /**
+   * Evaluate the log probability density function of each observation
+   * (column) of the given matrix: the responses are predicted at once, and the
+   * log probabilities of the residuals are computed by the batch
+   * GaussianDistribution::LogProbability().
+   *
+   * @param observations Points to evaluate the log probability at.
+   * @param logProbabilities Output log probabilities for each observation.
+   */
+  void LogProbability(const arma::mat& observations,
+                      arma::vec& logProbabilities) const;
+
   /**
    * Calculate y_i for each data point in points.
    *
@@ -56,6 +56,10 @@ class KernelTraits<CosineDistance>
 
   //! The cosine kernel doesn't include a squared distance.
   static const bool UsesSquaredDistance = false;
+  //! The cosine kernel is not a function of the inner product only.
+  static const bool IsInnerProductKernel = false;
+  //! The cosine distance is not a function of the distance only.
+  static const bool IsDistanceKernel = false;
 };
 
 } // namespace kernel
@@ -57,6 +57,18 @@ class EpanechnikovKernel
    */
   double Evaluate(const double distance) const;
 
+  /**
+   * Turn a matrix of squared distances into a matrix of kernel evaluations, in
+   * place.
+   *
+   * @param distances Matrix of squared distances.
+   */
+  void EvaluateSquaredDistances(arma::mat& distances) const
+  {
+    distances = arma::clamp(1.0 - inverseBandwidthSquared * distances, 0.0,
+        DBL_MAX);
+  }
+
   /**
    * Evaluate the Gradient of Epanechnikov kernel
    * given that the distance between the two
@@ -111,6 +123,10 @@ class KernelTraits<EpanechnikovKernel>
   static const bool IsNormalized = true;
   //! The Epanechnikov kernel includes a squared distance.
   static const bool UsesSquaredDistance = true;
+  //! The Epanechnikov kernel is not a function of the inner product only.
+  static const bool IsInnerProductKernel = false;
+  //! The Epanechnikov kernel is a function of the distance.
+  static const bool IsDistanceKernel = true;
 };
 
 } // namespace kernel
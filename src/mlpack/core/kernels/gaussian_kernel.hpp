@@ -81,6 +81,18 @@ class GaussianKernel
     return exp(gamma * std::pow(t, 2.0));
   }
 
+  /**
+   * Turn a matrix of squared distances into a matrix of kernel evaluations, in
+   * place.  The exponentials are computed over the whole matrix at once, which
+   * the compiler can vectorize.
+   *
+   * @param distances Matrix of squared distances.
+   */
+  void EvaluateSquaredDistances(arma::mat& distances) const
+  {
+    distances = arma::exp(gamma * distances);
+  }
+
   /**
    * Evaluation of the gradient of Gaussian kernel
    * given the distance between two points.
@@ -171,6 +183,10 @@ class KernelTraits<GaussianKernel>
   static const bool IsNormalized = true;
   //! The Gaussian kernel includes a squared distance.
   static const bool UsesSquaredDistance = true;
+  //! The Gaussian kernel is not a function of the inner product only.
+  static const bool IsInnerProductKernel = false;
+  //! The Gaussian kernel is a function of the distance.
+  static const bool IsDistanceKernel = true;
 };
 
 } // namespace kernel
@@ -13,6 +13,7 @@
 #define MLPACK_CORE_KERNELS_HYPERBOLIC_TANGENT_KERNEL_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <mlpack/core/kernels/kernel_traits.hpp>
 
 namespace mlpack {
 namespace kernel {
@@ -62,6 +63,17 @@ class HyperbolicTangentKernel
     return tanh(scale * arma::dot(a, b) + offset);
   }
 
+  /**
+   * Turn a matrix of inner products <x, y> into a matrix of kernel evaluations
+   * tanh(s <x, y> + t), in place.
+   *
+   * @param products Matrix of inner products.
+   */
+  void EvaluateInnerProducts(arma::mat& products) const
+  {
+    products = arma::tanh(scale * products + offset);
+  }
+
   //! Get scale factor.
   double Scale() const { return scale; }
   //! Modify scale factor.
@@ -85,6 +97,21 @@ class HyperbolicTangentKernel
   double offset;
 };
 
+//! Kernel traits for the hyperbolic tangent kernel.
+template<>
+class KernelTraits<HyperbolicTangentKernel>
+{
+ public:
+  //! The hyperbolic tangent kernel is not normalized.
+  static const bool IsNormalized = false;
+  //! The hyperbolic tangent kernel doesn't include a squared distance.
+  static const bool UsesSquaredDistance = false;
+  //! The hyperbolic tangent kernel is a function of the inner product.
+  static const bool IsInnerProductKernel = true;
+  //! The hyperbolic tangent kernel is not a function of the distance only.
+  static const bool IsDistanceKernel = false;
+};
+
 } // namespace kernel
 } // namespace mlpack
 
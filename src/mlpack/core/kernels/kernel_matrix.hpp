@@ -0,0 +1,220 @@
+/**
+ * @file kernel_matrix.hpp
+ *
+ * Evaluate a kernel between all the points of two sets at once, with a single
+ * matrix product when the kernel allows it.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_KERNELS_KERNEL_MATRIX_HPP
+#define MLPACK_CORE_KERNELS_KERNEL_MATRIX_HPP
+
+#include <mlpack/prereqs.hpp>
+#include "kernel_traits.hpp"
+#include "cosine_distance.hpp"
+
+namespace mlpack {
+namespace kernel {
+
+/**
+ * Compute the kernel evaluations between every column of a and every column of
+ * b: output(i, j) = K(a.col(i), b.col(j)).  For a kernel that is a function of
+ * the inner product only (KernelTraits<>::IsInnerProductKernel), the inner
+ * products are computed with a single matrix product and then passed to
+ * EvaluateInnerProducts().
+ *
+ * @param kernel Kernel to evaluate.
+ * @param a First set of points.
+ * @param b Second set of points.
+ * @param output Matrix to store the evaluations into.
+ */
+template<typename KernelType>
+typename std::enable_if<KernelTraits<KernelType>::IsInnerProductKernel>::type
+KernelMatrix(KernelType& kernel,
+             const arma::mat& a,
+             const arma::mat& b,
+             arma::mat& output)
+{
+  output = a.t() * b;
+  kernel.EvaluateInnerProducts(output);
+}
+
+/**
+ * HasFastKernelMatrix<KernelType>::value is true if KernelMatrix() computes the
+ * evaluations of the given kernel with a matrix product instead of one kernel
+ * evaluation per pair of points.
+ */
+template<typename KernelType>
+struct HasFastKernelMatrix
+{
+  static const bool value = KernelTraits<KernelType>::IsInnerProductKernel ||
+      KernelTraits<KernelType>::IsDistanceKernel ||
+      std::is_same<KernelType, CosineDistance>::value;
+};
+
+/**
+ * Compute the kernel evaluations between every column of a and every column of
+ * b: output(i, j) = K(a.col(i), b.col(j)).  For a kernel of the distance only
+ * (KernelTraits<>::IsDistanceKernel), the squared distances are computed as
+ * ||a_i||^2 + ||b_j||^2 - 2 a_i^T b_j, with a single matrix product, and then
+ * passed to EvaluateSquaredDistances().
+ *
+ * @param kernel Kernel to evaluate.
+ * @param a First set of points.
+ * @param b Second set of points.
+ * @param output Matrix to store the evaluations into.
+ */
+template<typename KernelType>
+typename std::enable_if<!KernelTraits<KernelType>::IsInnerProductKernel &&
+    KernelTraits<KernelType>::IsDistanceKernel>::type
+KernelMatrix(KernelType& kernel,
+             const arma::mat& a,
+             const arma::mat& b,
+             arma::mat& output)
+{
+  const arma::colvec aNorms = arma::sum(arma::square(a), 0).t();
+  const arma::rowvec bNorms = arma::sum(arma::square(b), 0);
+
+  output = -2.0 * (a.t() * b);
+  output.each_col() += aNorms;
+  output.each_row() += bNorms;
+
+  // Rounding can make the squared distance of close points negative.
+  output.transform([](const double d) { return std::max(d, 0.0); });
+  kernel.EvaluateSquaredDistances(output);
+}
+
+/**
+ * Compute the kernel evaluations between every column of a and every column of
+ * b: output(i, j) = K(a.col(i), b.col(j)).  For a kernel of the squared
+ * distance (KernelTraits<>::UsesSquaredDistance), the squared distances are
+ * computed as ||a_i||^2 + ||b_j||^2 - 2 a_i^T b_j, with a single matrix
+ * product, and the kernel is evaluated on the resulting distances.
+ *
+ * @param kernel Kernel to evaluate.
+ * @param a First set of points.
+ * @param b Second set of points.
+ * @param output Matrix to store the evaluations into.
+ */
+template<typename KernelType>
+typename std::enable_if<!KernelTraits<KernelType>::IsInnerProductKernel &&
+    !KernelTraits<KernelType>::IsDistanceKernel &&
+    KernelTraits<KernelType>::UsesSquaredDistance>::type
+KernelMatrix(KernelType& kernel,
+             const arma::mat& a,
+             const arma::mat& b,
+             arma::mat& output)
+{
+  const arma::rowvec aNorms = arma::sum(arma::square(a), 0);
+  const arma::rowvec bNorms = arma::sum(arma::square(b), 0);
+
+  output = a.t() * b;
+  for (size_t j = 0; j < output.n_cols; ++j)
+  {
+    double* evals = output.colptr(j);
+    for (size_t i = 0; i < output.n_rows; ++i)
+    {
+      // Rounding can make the squared distance of close points negative.
+      const double distance = aNorms[i] + bNorms[j] - 2.0 * evals[i];
+      evals[i] = kernel.Evaluate(std::sqrt(std::max(distance, 0.0)));
+    }
+  }
+}
+
+/**
+ * Compute the kernel evaluations between every column of a and every column of
+ * b: output(i, j) = K(a.col(i), b.col(j)), with one kernel evaluation per pair
+ * of points.  The columns of the output are computed in parallel, so
+ * KernelType::Evaluate() must be safe to call from several threads (as it is
+ * for the kernels of mlpack, such as PSpectrumStringKernel).
+ *
+ * @param kernel Kernel to evaluate.
+ * @param a First set of points.
+ * @param b Second set of points.
+ * @param output Matrix to store the evaluations into.
+ */
+template<typename KernelType>
+typename std::enable_if<!KernelTraits<KernelType>::IsInnerProductKernel &&
+    !KernelTraits<KernelType>::IsDistanceKernel &&
+    !KernelTraits<KernelType>::UsesSquaredDistance>::type
+KernelMatrix(KernelType& kernel,
+             const arma::mat& a,
+             const arma::mat& b,
+             arma::mat& output)
+{
+  output.set_size(a.n_cols, b.n_cols);
+
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables. If we're building for Visual Studio, use
+  // the intmax_t type instead.
+  #pragma omp parallel for schedule(dynamic, 16)
+  for (intmax_t j = 0; j < (intmax_t) b.n_cols; ++j)
+#else
+  #pragma omp parallel for schedule(dynamic, 16)
+  for (size_t j = 0; j < b.n_cols; ++j)
+#endif
+  {
+    for (size_t i = 0; i < a.n_cols; ++i)
+      output(i, j) = kernel.Evaluate(a.unsafe_col(i), b.unsafe_col(j));
+  }
+}
+
+/**
+ * Compute the cosine distances between every column of a and every column of
+ * b, as the matrix of inner products divided by the norms of the points.  The
+ * cosine distance to a point of norm 0 is 0.
+ *
+ * @param kernel Cosine distance (it has no parameters).
+ * @param a First set of points.
+ * @param b Second set of points.
+ * @param output Matrix to store the evaluations into.
+ */
+inline void KernelMatrix(CosineDistance& /* kernel */,
+                         const arma::mat& a,
+                         const arma::mat& b,
+                         arma::mat& output)
+{
+  arma::colvec aNorms = arma::sqrt(arma::sum(arma::square(a), 0)).t();
+  arma::rowvec bNorms = arma::sqrt(arma::sum(arma::square(b), 0));
+  aNorms.transform([](const double n) { return (n == 0.0) ? 0.0 : 1.0 / n; });
+  bNorms.transform([](const double n) { return (n == 0.0) ? 0.0 : 1.0 / n; });
+
+  output = a.t() * b;
+  output.each_col() %= aNorms;
+  output.each_row() %= bNorms;
+}
+
+/**
+ * Compute the kernel evaluations between one point and every column of b:
+ * output[j] = K(point, b.col(j)), with the same matrix products as
+ * KernelMatrix().  This is useful to evaluate the kernel of a query against a
+ * block of reference points.
+ *
+ * @param kernel Kernel to evaluate.
+ * @param point Point to evaluate the kernel from.
+ * @param b Set of points.
+ * @param output Vector to store the evaluations into.
+ */
+template<typename KernelType>
+void KernelVector(KernelType& kernel,
+                  const arma::vec& point,
+                  const arma::mat& b,
+                  arma::rowvec& output)
+{
+  // Use the memory of the point without copying it.
+  const arma::mat pointMat(const_cast<double*>(point.memptr()), point.n_elem,
+      1, false, true);
+
+  arma::mat evaluations;
+  KernelMatrix(kernel, pointMat, b, evaluations);
+  output = evaluations;
+}
+
+} // namespace kernel
+} // namespace mlpack
+
+#endif
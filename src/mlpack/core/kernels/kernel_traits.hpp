@@ -36,6 +36,24 @@ class KernelTraits
    * If true, then the kernel include a squared distance, ||x - y||^2 .
    */
   static const bool UsesSquaredDistance = false;
+
+  /**
+   * If true, then the kernel is a function of the inner product only:
+   * K(x, y) = f(x^T y).  Such a kernel must provide a method
+   * EvaluateInnerProducts(arma::mat& products) that replaces each inner product
+   * x^T y in the given matrix with K(x, y), so that many kernel evaluations can
+   * be computed at once from a single matrix product.
+   */
+  static const bool IsInnerProductKernel = false;
+
+  /**
+   * If true, then the kernel is a function of the Euclidean distance only:
+   * K(x, y) = f(||x - y||).  Such a kernel must provide a method
+   * EvaluateSquaredDistances(arma::mat& distances) that replaces each squared
+   * distance ||x - y||^2 in the given matrix with K(x, y), so that many kernel
+   * evaluations can be computed at once from a single matrix product.
+   */
+  static const bool IsDistanceKernel = false;
 };
 
 } // namespace kernel
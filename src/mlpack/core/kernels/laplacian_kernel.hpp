@@ -78,6 +78,17 @@ class LaplacianKernel
     return exp(-t / bandwidth);
   }
 
+  /**
+   * Turn a matrix of squared distances into a matrix of kernel evaluations, in
+   * place.
+   *
+   * @param distances Matrix of squared distances.
+   */
+  void EvaluateSquaredDistances(arma::mat& distances) const
+  {
+    distances = arma::exp(arma::sqrt(distances) / -bandwidth);
+  }
+
   /**
    * Evaluation of the gradient of the Laplacian kernel
    * given the distance between two points.
@@ -117,6 +128,10 @@ class KernelTraits<LaplacianKernel>
   static const bool IsNormalized = true;
   //! The Laplacian kernel doesn't include a squared distance.
   static const bool UsesSquaredDistance = false;
+  //! The Laplacian kernel is not a function of the inner product only.
+  static const bool IsInnerProductKernel = false;
+  //! The Laplacian kernel is a function of the distance.
+  static const bool IsDistanceKernel = true;
 };
 
 } // namespace kernel
@@ -15,6 +15,7 @@
 #define MLPACK_CORE_KERNELS_LINEAR_KERNEL_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <mlpack/core/kernels/kernel_traits.hpp>
 
 namespace mlpack {
 namespace kernel {
@@ -55,11 +56,35 @@ class LinearKernel
     return arma::dot(a, b);
   }
 
+  /**
+   * Turn a matrix of inner products into a matrix of kernel evaluations.  For
+   * the linear kernel, the inner products are the kernel evaluations, so there
+   * is nothing to do.
+   *
+   * @param products Matrix of inner products x^T y.
+   */
+  static void EvaluateInnerProducts(arma::mat& /* products */) { }
+
   //! Serialize the kernel (it has no members... do nothing).
   template<typename Archive>
   void Serialize(Archive& /* ar */, const unsigned int /* version */) { }
 };
 
+//! Kernel traits for the linear kernel.
+template<>
+class KernelTraits<LinearKernel>
+{
+ public:
+  //! The linear kernel is not normalized.
+  static const bool IsNormalized = false;
+  //! The linear kernel doesn't include a squared distance.
+  static const bool UsesSquaredDistance = false;
+  //! The linear kernel is the inner product itself.
+  static const bool IsInnerProductKernel = true;
+  //! The linear kernel is not a function of the distance only.
+  static const bool IsDistanceKernel = false;
+};
+
 } // namespace kernel
 } // namespace mlpack
 
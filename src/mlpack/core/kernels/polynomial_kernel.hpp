@@ -13,6 +13,7 @@
 #define MLPACK_CORE_KERNELS_POLYNOMIAL_KERNEL_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <mlpack/core/kernels/kernel_traits.hpp>
 
 namespace mlpack {
 namespace kernel {
@@ -57,6 +58,17 @@ class PolynomialKernel
     return pow((arma::dot(a, b) + offset), degree);
   }
 
+  /**
+   * Turn a matrix of inner products x^T y into a matrix of kernel evaluations
+   * (x^T y + offset)^degree, in place.
+   *
+   * @param products Matrix of inner products.
+   */
+  void EvaluateInnerProducts(arma::mat& products) const
+  {
+    products = arma::pow(products + offset, degree);
+  }
+
   //! Get the degree of the polynomial.
   const double& Degree() const { return degree; }
   //! Modify the degree of the polynomial.
@@ -82,6 +94,21 @@ class PolynomialKernel
   double offset;
 };
 
+//! Kernel traits for the polynomial kernel.
+template<>
+class KernelTraits<PolynomialKernel>
+{
+ public:
+  //! The polynomial kernel is not normalized.
+  static const bool IsNormalized = false;
+  //! The polynomial kernel doesn't include a squared distance.
+  static const bool UsesSquaredDistance = false;
+  //! The polynomial kernel is a function of the inner product.
+  static const bool IsInnerProductKernel = true;
+  //! The polynomial kernel is not a function of the distance only.
+  static const bool IsDistanceKernel = false;
+};
+
 } // namespace kernel
 } // namespace mlpack
 
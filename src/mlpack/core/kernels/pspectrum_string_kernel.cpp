@@ -15,6 +15,8 @@
  */
 #include "pspectrum_string_kernel.hpp"
 
+#include <algorithm>
+
 using namespace std;
 using namespace mlpack;
 using namespace mlpack::kernel;
@@ -32,57 +34,119 @@ mlpack::kernel::PSpectrumStringKernel::PSpectrumStringKernel(
     datasets(datasets),
     p(p)
 {
-  // We have to assemble the counts of substrings.  This is not a particularly
-  // fast operation, unfortunately, but it only needs to be done once.
-  Log::Info << "Assembling counts of substrings of length " << p << "."
+  // We have to assemble the spectra of the strings.  This only needs to be
+  // done once.
+  Log::Info << "Assembling spectra of substrings of length " << p << "."
       << std::endl;
 
   // Resize for number of datasets.
-  counts.resize(datasets.size());
+  spectra.resize(datasets.size());
 
+  std::string sub;
   for (size_t dataset = 0; dataset < datasets.size(); ++dataset)
   {
     const std::vector<std::string>& set = datasets[dataset];
 
     // Resize for number of strings in dataset.
-    counts[dataset].resize(set.size());
+    spectra[dataset].resize(set.size());
 
     // Inspect each string in the dataset.
     for (size_t index = 0; index < set.size(); ++index)
     {
       // Convenience references.
       const std::string& str = set[index];
-      std::map<std::string, int>& mapping = counts[dataset][index];
+      Spectrum& spectrum = spectra[dataset][index];
+
+      // Collect the identifiers of the valid substrings, then sort them and
+      // merge the duplicates into counts.
+      std::vector<uint64_t> ids;
+      for (size_t start = 0; (start + p) <= str.length(); ++start)
+        if (Substring(str, start, sub))
+          ids.push_back(Identifier(sub));
 
-      size_t start = 0;
-      while ((start + p) <= str.length())
+      std::sort(ids.begin(), ids.end());
+      for (size_t i = 0; i < ids.size(); ++i)
       {
-        string sub = str.substr(start, p);
-
-        // Convert all characters to lowercase.
-        bool invalid = false;
-        for (size_t j = 0; j < p; ++j)
-        {
-          if (!isalnum(sub[j]))
-          {
-            invalid = true;
-            break; // Only consider substrings with alphanumerics.
-          }
-
-          sub[j] = tolower(sub[j]);
-        }
-
-        // Increment position in string.
-        ++start;
-
-        if (!invalid)
-        {
-          // Add to the map.
-          ++mapping[sub];
-        }
+        if (spectrum.empty() || spectrum.back().first != ids[i])
+          spectrum.push_back(std::make_pair(ids[i], 0));
+        ++spectrum.back().second;
       }
+      spectrum.shrink_to_fit();
     }
   }
 
   Log::Info << "Substring extraction complete." << std::endl;
 }
+
+const std::vector<std::vector<std::map<std::string, int> > >&
+PSpectrumStringKernel::Counts() const
+{
+  if (counts.size() != datasets.size())
+  {
+    counts.clear();
+    counts.resize(datasets.size());
+
+    std::string sub;
+    for (size_t dataset = 0; dataset < datasets.size(); ++dataset)
+    {
+      const std::vector<std::string>& set = datasets[dataset];
+      counts[dataset].resize(set.size());
+
+      for (size_t index = 0; index < set.size(); ++index)
+      {
+        const std::string& str = set[index];
+        for (size_t start = 0; (start + p) <= str.length(); ++start)
+          if (Substring(str, start, sub))
+            ++counts[dataset][index][sub];
+      }
+    }
+  }
+
+  return counts;
+}
+
+std::vector<std::vector<std::map<std::string, int> > >&
+PSpectrumStringKernel::Counts()
+{
+  static_cast<const PSpectrumStringKernel&>(*this).Counts();
+  return counts;
+}
+
+bool PSpectrumStringKernel::Substring(const std::string& str,
+                                      const size_t start,
+                                      std::string& sub) const
+{
+  sub = str.substr(start, p);
+
+  // Convert all characters to lowercase.
+  for (size_t j = 0; j < p; ++j)
+  {
+    if (!isalnum(sub[j]))
+      return false; // Only consider substrings with alphanumerics.
+
+    sub[j] = tolower(sub[j]);
+  }
+
+  return true;
+}
+
+uint64_t PSpectrumStringKernel::Identifier(const std::string& sub) const
+{
+  // Short substrings fit in the identifier as they are.
+  if (sub.length() <= 8)
+  {
+    uint64_t id = 0;
+    for (size_t j = 0; j < sub.length(); ++j)
+      id = (id << 8) | (unsigned char) sub[j];
+    return id;
+  }
+
+  // Longer ones are hashed with 64-bit FNV-1a.
+  uint64_t id = 14695981039346656037ULL;
+  for (size_t j = 0; j < sub.length(); ++j)
+  {
+    id ^= (unsigned char) sub[j];
+    id *= 1099511628211ULL;
+  }
+  return id;
+}
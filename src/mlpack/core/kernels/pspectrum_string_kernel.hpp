@@ -18,6 +18,7 @@
 
 #include <map>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <mlpack/prereqs.hpp>
@@ -61,6 +62,14 @@ namespace kernel {
  * the data according to the fake data matrix -- resulting in a meaningless
  * tree.  This kernel was originally written for the FastMKS method; so, at the
  * very least, it will work with that.
+ *
+ * At construction time, each substring of length p is turned into a 64-bit
+ * identifier (the characters themselves if p <= 8, and a hash of them
+ * otherwise), and each string is represented by the sorted array of the
+ * identifiers of its substrings with their counts.  Evaluate() is then a
+ * linear merge of two arrays of integers.  For p > 8, two different
+ * substrings could in theory share an identifier, but with 64-bit hashes this
+ * is very unlikely to happen.
  */
 class PSpectrumStringKernel
 {
@@ -89,12 +98,21 @@ class PSpectrumStringKernel
   template<typename VecType>
   double Evaluate(const VecType& a, const VecType& b) const;
 
-  //! Access the lists of substrings.
-  const std::vector<std::vector<std::map<std::string, int> > >& Counts() const
-  { return counts; }
+  //! The representation of a string: the sorted identifiers of its substrings
+  //! of length p, each with its count.
+  typedef std::vector<std::pair<uint64_t, int> > Spectrum;
+
+  //! Access the spectra of the strings of each dataset.
+  const std::vector<std::vector<Spectrum> >& Spectra() const { return spectra; }
+
+  /**
+   * Access the lists of substrings, as maps from each substring to its count.
+   * They are not used by Evaluate(), so they are only built from the datasets
+   * the first time this is called.
+   */
+  const std::vector<std::vector<std::map<std::string, int> > >& Counts() const;
   //! Modify the lists of substrings.
-  std::vector<std::vector<std::map<std::string, int> > >& Counts()
-  { return counts; }
+  std::vector<std::vector<std::map<std::string, int> > >& Counts();
 
   //! Access the value of p.
   size_t P() const { return p; }
@@ -102,12 +120,26 @@ class PSpectrumStringKernel
   size_t& P() { return p; }
 
  private:
+  /**
+   * Get the lowercase substring of length p of the given string at the given
+   * position; return false if it contains characters that aren't
+   * alphanumeric.
+   */
+  bool Substring(const std::string& str,
+                 const size_t start,
+                 std::string& sub) const;
+
+  //! Get the identifier of the given lowercase substring.
+  uint64_t Identifier(const std::string& sub) const;
+
   //! The datasets.
   const std::vector<std::vector<std::string> >& datasets;
 
-  //! Mappings of the datasets to counts of substrings.  Such a huge structure
-  //! is not wonderful...
-  std::vector<std::vector<std::map<std::string, int> > > counts;
+  //! The spectrum of each string of each dataset.
+  std::vector<std::vector<Spectrum> > spectra;
+
+  //! Mappings of the datasets to counts of substrings, built by Counts().
+  mutable std::vector<std::vector<std::map<std::string, int> > > counts;
 
   //! The value of p to use in calculation.
   size_t p;
@@ -100,6 +100,18 @@ class SphericalKernel
   {
     return (t <= bandwidth) ? 1.0 : 0.0;
   }
+
+  /**
+   * Turn a matrix of squared distances into a matrix of kernel evaluations, in
+   * place.
+   *
+   * @param distances Matrix of squared distances.
+   */
+  void EvaluateSquaredDistances(arma::mat& distances) const
+  {
+    distances.transform([this](const double d)
+        { return (d <= bandwidthSquared) ? 1.0 : 0.0; });
+  }
   double Gradient(double t) {
     return t == bandwidth ? arma::datum::nan : 0.0;
   }
@@ -126,6 +138,10 @@ class KernelTraits<SphericalKernel>
   static const bool IsNormalized = true;
   //! The spherical kernel doesn't include a squared distance.
   static const bool UsesSquaredDistance = false;
+  //! The spherical kernel is not a function of the inner product only.
+  static const bool IsInnerProductKernel = false;
+  //! The spherical kernel is a function of the distance.
+  static const bool IsDistanceKernel = true;
 };
 
 } // namespace kernel
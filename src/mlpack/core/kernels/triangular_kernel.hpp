@@ -63,6 +63,18 @@ class TriangularKernel
     return std::max(0.0, (1 - distance) / bandwidth);
   }
 
+  /**
+   * Turn a matrix of squared distances into a matrix of kernel evaluations, in
+   * place, like Evaluate(a, b).
+   *
+   * @param distances Matrix of squared distances.
+   */
+  void EvaluateSquaredDistances(arma::mat& distances) const
+  {
+    distances = arma::clamp(1.0 - arma::sqrt(distances) / bandwidth, 0.0,
+        DBL_MAX);
+  }
+
   /**
    * Evaluate the gradient of triangular kernel
    * given that the distance between the two
@@ -106,6 +118,10 @@ class KernelTraits<TriangularKernel>
   static const bool IsNormalized = true;
   //! The triangular kernel doesn't include a squared distance.
   static const bool UsesSquaredDistance = false;
+  //! The triangular kernel is not a function of the inner product only.
+  static const bool IsInnerProductKernel = false;
+  //! The triangular kernel is a function of the distance.
+  static const bool IsDistanceKernel = true;
 };
 
 } // namespace kernel
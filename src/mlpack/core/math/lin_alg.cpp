@@ -33,6 +33,39 @@ void mlpack::math::VectorPower(arma::vec& vec, const double power)
   }
 }
 
+/**
+ * Compute the mean of the columns of a matrix.  The columns are summed in
+ * blocks of fixed size, and the sums of the blocks are added in order, so the
+ * result doesn't depend on the number of threads.
+ */
+void mlpack::math::RowMean(const arma::mat& x, arma::vec& mean)
+{
+  const size_t blockSize = 1024;
+  const size_t numBlocks = (x.n_cols + blockSize - 1) / blockSize;
+  arma::mat blockSums(x.n_rows, numBlocks);
+
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables. If we're building for Visual Studio, use
+  // the intmax_t type instead.
+  #pragma omp parallel for schedule(static)
+  for (intmax_t b = 0; b < (intmax_t) numBlocks; ++b)
+#else
+  #pragma omp parallel for schedule(static)
+  for (size_t b = 0; b < numBlocks; ++b)
+#endif
+  {
+    const size_t end = std::min((size_t) x.n_cols, (b + 1) * blockSize);
+    blockSums.col(b) = arma::sum(x.cols(b * blockSize, end - 1), 1);
+  }
+
+  mean.zeros(x.n_rows);
+  for (size_t b = 0; b < numBlocks; ++b)
+    mean += blockSums.col(b);
+  if (x.n_cols > 0)
+    mean /= x.n_cols;
+}
+
 /**
  * Creates a centered matrix, where centering is done by subtracting
  * the sum over the columns (a column vector) from each column of the matrix.
@@ -43,9 +76,113 @@ void mlpack::math::VectorPower(arma::vec& vec, const double power)
 void mlpack::math::Center(const arma::mat& x, arma::mat& xCentered)
 {
   // Get the mean of the elements in each row.
-  arma::vec rowMean = arma::sum(x, 1) / x.n_cols;
+  arma::vec rowMean;
+  RowMean(x, rowMean);
+
+  // If x and xCentered are the same matrix, this does nothing.
+  xCentered.set_size(x.n_rows, x.n_cols);
+
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables. If we're building for Visual Studio, use
+  // the intmax_t type instead.
+  #pragma omp parallel for schedule(static)
+  for (intmax_t i = 0; i < (intmax_t) x.n_cols; ++i)
+#else
+  #pragma omp parallel for schedule(static)
+  for (size_t i = 0; i < x.n_cols; ++i)
+#endif
+  {
+    xCentered.col(i) = x.col(i) - rowMean;
+  }
+}
+
+/**
+ * Center a matrix in place and return the mean.
+ */
+void mlpack::math::CenterInPlace(arma::mat& x, arma::vec& mean)
+{
+  RowMean(x, mean);
+
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables. If we're building for Visual Studio, use
+  // the intmax_t type instead.
+  #pragma omp parallel for schedule(static)
+  for (intmax_t i = 0; i < (intmax_t) x.n_cols; ++i)
+#else
+  #pragma omp parallel for schedule(static)
+  for (size_t i = 0; i < x.n_cols; ++i)
+#endif
+  {
+    x.col(i) -= mean;
+  }
+}
+
+/**
+ * Center a matrix in place.
+ */
+void mlpack::math::CenterInPlace(arma::mat& x)
+{
+  arma::vec mean;
+  CenterInPlace(x, mean);
+}
+
+/**
+ * Compute the covariance matrix of the columns of a matrix, block by block.
+ */
+void mlpack::math::Covariance(const arma::mat& x, arma::mat& covariance)
+{
+  arma::vec mean;
+  RowMean(x, mean);
+
+  // Centering a block before its product keeps the precision of the centered
+  // computation, without a centered copy of the whole matrix.
+  const size_t blockSize = 256;
+  const size_t numBlocks = (x.n_cols + blockSize - 1) / blockSize;
+
+#ifdef HAS_OPENMP
+  const size_t threads = omp_get_max_threads();
+#else
+  const size_t threads = 1;
+#endif
+  std::vector<arma::mat> threadCovariances(threads);
+
+  #pragma omp parallel num_threads(threads)
+  {
+#ifdef HAS_OPENMP
+    const size_t t = omp_get_thread_num();
+#else
+    const size_t t = 0;
+#endif
+    threadCovariances[t].zeros(x.n_rows, x.n_rows);
+    arma::mat block;
+
+#ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables. If we're building for Visual Studio,
+    // use the intmax_t type instead.
+    #pragma omp for schedule(static)
+    for (intmax_t b = 0; b < (intmax_t) numBlocks; ++b)
+#else
+    #pragma omp for schedule(static)
+    for (size_t b = 0; b < numBlocks; ++b)
+#endif
+    {
+      const size_t end = std::min((size_t) x.n_cols, (b + 1) * blockSize);
+      block = x.cols(b * blockSize, end - 1);
+      block.each_col() -= mean;
+
+      // Armadillo computes the product of a matrix with its own transpose
+      // with a symmetric rank-k update (SYRK).
+      threadCovariances[t] += block * block.t();
+    }
+  }
 
-  xCentered = x - arma::repmat(rowMean, 1, x.n_cols);
+  covariance.zeros(x.n_rows, x.n_rows);
+  for (size_t t = 0; t < threads; ++t)
+    covariance += threadCovariances[t];
+  covariance /= (x.n_cols > 1) ? (double) (x.n_cols - 1) : 1.0;
 }
 
 /**
@@ -60,7 +197,7 @@ void mlpack::math::WhitenUsingSVD(const arma::mat& x,
   arma::mat covX, u, v, invSMatrix, temp1;
   arma::vec sVector;
 
-  covX = ccov(x);
+  Covariance(x, covX);
 
   svd(u, sVector, v, covX);
 
@@ -81,11 +218,12 @@ void mlpack::math::WhitenUsingEig(const arma::mat& x,
                                   arma::mat& xWhitened,
                                   arma::mat& whiteningMatrix)
 {
-  arma::mat diag, eigenvectors;
+  arma::mat diag, eigenvectors, covX;
   arma::vec eigenvalues;
 
   // Get eigenvectors of covariance of input matrix.
-  eig_sym(eigenvalues, eigenvectors, ccov(x));
+  Covariance(x, covX);
+  eig_sym(eigenvalues, eigenvectors, covX);
 
   // Generate diagonal matrix using 1 / sqrt(eigenvalues) for each value.
   VectorPower(eigenvalues, -0.5);
@@ -135,7 +273,9 @@ void mlpack::math::Orthogonalize(const arma::mat& x, arma::mat& W)
   // eigendecomposition of the matrix A.
   arma::mat eigenvalues, eigenvectors;
   arma::vec egval;
-  eig_sym(egval, eigenvectors, ccov(x));
+  arma::mat covX;
+  Covariance(x, covX);
+  eig_sym(egval, eigenvectors, covX);
   VectorPower(egval, -0.5);
 
   eigenvalues.zeros(egval.n_elem, egval.n_elem);
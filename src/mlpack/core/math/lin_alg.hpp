@@ -27,15 +27,55 @@ namespace math {
  */
 void VectorPower(arma::vec& vec, const double power);
 
+/**
+ * Compute the mean of the columns of a matrix (the mean of each row) in one
+ * pass, in parallel over blocks of columns.  The result doesn't depend on the
+ * number of threads.
+ *
+ * @param x Input matrix.
+ * @param mean Vector to write the mean into.
+ */
+void RowMean(const arma::mat& x, arma::vec& mean);
+
 /**
  * Creates a centered matrix, where centering is done by subtracting
  * the sum over the columns (a column vector) from each column of the matrix.
+ * The columns are centered in parallel, and x and xCentered may be the same
+ * matrix, in which case no memory is allocated for the result.
  *
  * @param x Input matrix
  * @param xCentered Matrix to write centered output into
  */
 void Center(const arma::mat& x, arma::mat& xCentered);
 
+/**
+ * Center a matrix in place, without a copy of it, and return the mean that was
+ * subtracted from each column.
+ *
+ * @param x Matrix to center.
+ * @param mean Vector to write the mean into.
+ */
+void CenterInPlace(arma::mat& x, arma::vec& mean);
+
+/**
+ * Center a matrix in place, without a copy of it.
+ *
+ * @param x Matrix to center.
+ */
+void CenterInPlace(arma::mat& x);
+
+/**
+ * Compute the covariance matrix of the columns of a matrix, normalized by
+ * N - 1 like arma::ccov(), without a centered copy of the matrix.  The columns
+ * are centered in small blocks, and the product of each block with its
+ * transpose is accumulated by each thread, so the extra memory is a few
+ * blocks and one covariance matrix per thread.
+ *
+ * @param x Input matrix.
+ * @param covariance Matrix to write the covariance into.
+ */
+void Covariance(const arma::mat& x, arma::mat& covariance);
+
 /**
  * Whitens a matrix using the singular value decomposition of the covariance
  * matrix. Whitening means the covariance matrix of the result is the identity
@@ -8,7 +8,9 @@
  * 3-clause BSD license along with mlpack.  If not, see
  * http://www.opensource.org/licenses/BSD-3-Clause for more information.
  */
+#include <atomic>
 #include <random>
+#include <thread>
 #include <mlpack/mlpack_export.hpp>
 
 namespace mlpack {
@@ -20,6 +22,15 @@ MLPACK_EXPORT std::mt19937 randGen;
 MLPACK_EXPORT std::uniform_real_distribution<> randUniformDist(0.0, 1.0);
 // Global normal distribution.
 MLPACK_EXPORT std::normal_distribution<> randNormalDist(0.0, 1.0);
+// Seed of the per-thread random streams.
+MLPACK_EXPORT std::atomic<size_t> randStreamSeed(0);
+// Incremented when the seed of the per-thread random streams changes.
+MLPACK_EXPORT std::atomic<size_t> randStreamGeneration(0);
+// Number of threads given a stream outside of OpenMP parallel regions.
+MLPACK_EXPORT std::atomic<size_t> randStreamThreads(0);
+// The thread that loaded mlpack.
+MLPACK_EXPORT std::thread::id randMainThread =
+    std::this_thread::get_id();
 
 } // namespace math
 } // namespace mlpack
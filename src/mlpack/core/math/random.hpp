@@ -13,7 +13,11 @@
 
 #include <mlpack/prereqs.hpp>
 #include <mlpack/mlpack_export.hpp>
+#include <atomic>
 #include <random>
+#include <thread>
+
+#include "random_stream.hpp"
 
 namespace mlpack {
 namespace math /** Miscellaneous math routines. */ {
@@ -29,6 +33,14 @@ extern MLPACK_EXPORT std::mt19937 randGen;
 extern MLPACK_EXPORT std::uniform_real_distribution<> randUniformDist;
 // Global normal distribution.
 extern MLPACK_EXPORT std::normal_distribution<> randNormalDist;
+// Seed of the per-thread random streams.
+extern MLPACK_EXPORT std::atomic<size_t> randStreamSeed;
+// Incremented when the seed of the per-thread random streams changes.
+extern MLPACK_EXPORT std::atomic<size_t> randStreamGeneration;
+// Number of threads given a stream outside of OpenMP parallel regions.
+extern MLPACK_EXPORT std::atomic<size_t> randStreamThreads;
+// The thread that loaded mlpack.
+extern MLPACK_EXPORT std::thread::id randMainThread;
 
 /**
  * Set the random seed used by the random functions (Random() and RandInt()).
@@ -47,14 +59,124 @@ inline void RandomSeed(const size_t seed)
   // need to set the seed for also.
   arma::arma_rng::set_seed(seed);
 #endif
+
+  // The per-thread streams are restarted the next time they are used.
+  randStreamSeed = seed;
+  ++randStreamGeneration;
+}
+
+/**
+ * Return the index of the random stream of the calling thread.  Inside OpenMP
+ * parallel regions, this is the OpenMP number of the thread.  Outside of them,
+ * it is 0 for the thread that loaded mlpack, and for any other thread (such as
+ * a std::thread) an index that no other thread gets, assigned the first time
+ * the thread asks for it.  These indices never overlap the OpenMP numbers or
+ * the indices of the task streams.
+ */
+inline uint64_t ThreadRandomStreamIndex()
+{
+#ifdef HAS_OPENMP
+  if (omp_in_parallel())
+    return omp_get_thread_num();
+#endif
+
+  if (std::this_thread::get_id() == randMainThread)
+    return 0;
+
+  static thread_local const uint64_t index = (uint64_t(1) << 62) |
+      (uint64_t) randStreamThreads++;
+  return index;
 }
 
 /**
- * Generates a uniform random number between 0 and 1.
+ * Return the random stream of the calling thread.  The stream of a thread has
+ * the seed given to RandomSeed() and ThreadRandomStreamIndex() as its index,
+ * and it is restarted each time RandomSeed() is called.  So threads never
+ * share a generator, and for a fixed seed and a fixed assignment of the work
+ * to the OpenMP threads (such as a static schedule) the numbers are
+ * reproducible.
+ *
+ * The indices of other threads depend on the order in which the threads first
+ * draw numbers, so their numbers aren't reproducible; code that needs them to
+ * be (or that opens parallel regions from several threads at once, whose
+ * OpenMP numbers are the same) should use TaskRandomStreamScope or a
+ * RandomStream of its own.
+ */
+inline RandomStream& ThreadRandomStream()
+{
+  static thread_local RandomStream stream;
+  static thread_local size_t generation = 0;
+  static thread_local bool seeded = false;
+
+  const size_t currentGeneration = randStreamGeneration;
+  if (!seeded || generation != currentGeneration)
+  {
+    stream.Seed(randStreamSeed, ThreadRandomStreamIndex());
+    generation = currentGeneration;
+    seeded = true;
+  }
+
+  return stream;
+}
+
+/**
+ * Return the random stream of the given task.  Unlike the stream of a thread,
+ * the stream of a task depends only on the seed given to RandomSeed() and on
+ * the index of the task, so work split into tasks (such as the blocks of a
+ * parallel loop with a dynamic schedule) gives the same numbers whatever
+ * thread runs each task.  The task streams never overlap the thread streams.
+ *
+ * @param task Index of the task.
+ */
+inline RandomStream TaskRandomStream(const size_t task)
+{
+  return RandomStream(randStreamSeed, (uint64_t(1) << 63) | (uint64_t) task);
+}
+
+/**
+ * While it exists, a TaskRandomStreamScope object replaces the random stream of
+ * the calling thread with the stream of the given task, so that code using the
+ * random functions below (such as a whole k-means or EM run) draws the numbers
+ * of the task.  The stream of the thread is restored on destruction.
+ *
+ * @code
+ * #pragma omp parallel for
+ * for (size_t trial = 0; trial < trials; ++trial)
+ * {
+ *   TaskRandomStreamScope scope(trial);
+ *   RunTrial(trial); // Gives the same result with any number of threads.
+ * }
+ * @endcode
+ */
+class TaskRandomStreamScope
+{
+ public:
+  //! Replace the stream of the calling thread with the stream of the task.
+  explicit TaskRandomStreamScope(const size_t task) :
+      stream(ThreadRandomStream()),
+      threadStream(stream)
+  {
+    stream = TaskRandomStream(task);
+  }
+
+  //! Restore the stream of the calling thread.
+  ~TaskRandomStreamScope() { stream = threadStream; }
+
+ private:
+  //! The stream of the calling thread.
+  RandomStream& stream;
+  //! The state of the stream of the calling thread before the task.
+  RandomStream threadStream;
+};
+
+/**
+ * Generates a uniform random number between 0 and 1.  Like all of the random
+ * functions below, this uses the random stream of the calling thread, so it
+ * can be called from parallel regions.
  */
 inline double Random()
 {
-  return randUniformDist(randGen);
+  return ThreadRandomStream().Random();
 }
 
 /**
@@ -62,7 +184,7 @@ inline double Random()
  */
 inline double Random(const double lo, const double hi)
 {
-  return lo + (hi - lo) * randUniformDist(randGen);
+  return lo + (hi - lo) * ThreadRandomStream().Random();
 }
 
 /**
@@ -70,7 +192,8 @@ inline double Random(const double lo, const double hi)
  */
 inline int RandInt(const int hiExclusive)
 {
-  return (int) std::floor((double) hiExclusive * randUniformDist(randGen));
+  return (int) std::floor((double) hiExclusive *
+      ThreadRandomStream().Random());
 }
 
 /**
@@ -79,7 +202,7 @@ inline int RandInt(const int hiExclusive)
 inline int RandInt(const int lo, const int hiExclusive)
 {
   return lo + (int) std::floor((double) (hiExclusive - lo)
-                               * randUniformDist(randGen));
+                               * ThreadRandomStream().Random());
 }
 
 /**
@@ -87,7 +210,7 @@ inline int RandInt(const int lo, const int hiExclusive)
  */
 inline double RandNormal()
 {
-  return randNormalDist(randGen);
+  return ThreadRandomStream().RandNormal();
 }
 
 /**
@@ -99,22 +222,27 @@ inline double RandNormal()
  */
 inline double RandNormal(const double mean, const double variance)
 {
-  return variance * randNormalDist(randGen) + mean;
+  return variance * ThreadRandomStream().RandNormal() + mean;
 }
 
 /**
- * Obtains no more than maxNumSamples distinct samples. Each sample belongs to
- * [loInclusive, hiExclusive).
+ * Obtains no more than maxNumSamples distinct samples, using the given random
+ * number generator.  Each sample belongs to [loInclusive, hiExclusive).  With
+ * math::randGen as the generator, this gives the same samples as the overload
+ * that does not take a generator.  Giving each thread its own generator makes
+ * it possible to draw samples in parallel.
  *
  * @param loInclusive The lower bound (inclusive).
  * @param hiExclusive The high bound (exclusive).
  * @param maxNumSamples The maximum number of samples to obtain.
  * @param distinctSamples The samples that will be obtained.
+ * @param generator The random number generator to use.
  */
 inline void ObtainDistinctSamples(const size_t loInclusive,
                                   const size_t hiExclusive,
                                   const size_t maxNumSamples,
-                                  arma::uvec& distinctSamples)
+                                  arma::uvec& distinctSamples,
+                                  std::mt19937& generator)
 {
   const size_t samplesRangeSize = hiExclusive - loInclusive;
 
@@ -124,8 +252,10 @@ inline void ObtainDistinctSamples(const size_t loInclusive,
 
     samples.zeros(samplesRangeSize);
 
+    std::uniform_real_distribution<> uniformDist;
     for (size_t i = 0; i < maxNumSamples; i++)
-      samples [ (size_t) math::RandInt(samplesRangeSize) ]++;
+      samples[(size_t) std::floor((double) samplesRangeSize *
+          uniformDist(generator))]++;
 
     distinctSamples = arma::find(samples > 0);
 
@@ -140,6 +270,24 @@ inline void ObtainDistinctSamples(const size_t loInclusive,
   }
 }
 
+/**
+ * Obtains no more than maxNumSamples distinct samples. Each sample belongs to
+ * [loInclusive, hiExclusive).
+ *
+ * @param loInclusive The lower bound (inclusive).
+ * @param hiExclusive The high bound (exclusive).
+ * @param maxNumSamples The maximum number of samples to obtain.
+ * @param distinctSamples The samples that will be obtained.
+ */
+inline void ObtainDistinctSamples(const size_t loInclusive,
+                                  const size_t hiExclusive,
+                                  const size_t maxNumSamples,
+                                  arma::uvec& distinctSamples)
+{
+  ObtainDistinctSamples(loInclusive, hiExclusive, maxNumSamples,
+      distinctSamples, randGen);
+}
+
 } // namespace math
 } // namespace mlpack
 
@@ -0,0 +1,248 @@
+/**
+ * @file random_stream.hpp
+ *
+ * Counter-based random number streams (Philox4x32-10), which give independent
+ * and reproducible streams of random numbers for any number of threads.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_MATH_RANDOM_STREAM_HPP
+#define MLPACK_CORE_MATH_RANDOM_STREAM_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include <cstdint>
+
+namespace mlpack {
+namespace math /** Miscellaneous math routines. */ {
+
+/**
+ * A RandomStream generates random numbers with the Philox4x32-10 counter-based
+ * generator: the i-th block of four 32-bit numbers of a stream is a function
+ * of the seed, the stream index and i only.  So streams with different indices
+ * are independent, a stream can be advanced without generating the numbers it
+ * skips, and a fixed seed gives the same numbers whatever the threads that use
+ * the streams do.  The blocks are generated in bulk when matrices are filled,
+ * in a loop that the compiler can vectorize, since the blocks don't depend on
+ * each other.
+ *
+ * For more information, see the following.
+ *
+ * @code
+ * @inproceedings{salmon2011parallel,
+ *   title     = {Parallel Random Numbers: As Easy as 1, 2, 3},
+ *   author    = {Salmon, John K. and Moraes, Mark A. and Dror, Ron O. and
+ *                Shaw, David E.},
+ *   booktitle = {Proceedings of the International Conference for High
+ *                Performance Computing, Networking, Storage and Analysis},
+ *   year      = {2011}
+ * }
+ * @endcode
+ */
+class RandomStream
+{
+ public:
+  /**
+   * Create the stream with the given index of the given seed.
+   *
+   * @param seed Seed of the generator.
+   * @param stream Index of the stream.
+   */
+  RandomStream(const uint64_t seed = 0, const uint64_t stream = 0)
+  {
+    Seed(seed, stream);
+  }
+
+  /**
+   * Restart the stream as the stream with the given index of the given seed.
+   *
+   * @param seed Seed of the generator.
+   * @param stream Index of the stream.
+   */
+  void Seed(const uint64_t seed, const uint64_t stream)
+  {
+    key[0] = (uint32_t) seed;
+    key[1] = (uint32_t) (seed >> 32);
+    this->stream = stream;
+    counter = 0;
+    used = 4;
+  }
+
+  /**
+   * Generate a block of four 32-bit random numbers.  The block is the one with
+   * the given counter in the stream with the given key and index.
+   *
+   * @param key Key (seed) of the generator.
+   * @param stream Index of the stream.
+   * @param counter Index of the block in the stream.
+   * @param output The four numbers of the block.
+   */
+  static void Block(const uint32_t key[2],
+                    const uint64_t stream,
+                    const uint64_t counter,
+                    uint32_t output[4])
+  {
+    uint32_t c0 = (uint32_t) counter;
+    uint32_t c1 = (uint32_t) (counter >> 32);
+    uint32_t c2 = (uint32_t) stream;
+    uint32_t c3 = (uint32_t) (stream >> 32);
+    uint32_t k0 = key[0];
+    uint32_t k1 = key[1];
+
+    for (size_t round = 0; round < 10; ++round)
+    {
+      const uint64_t p0 = (uint64_t) 0xD2511F53u * c0;
+      const uint64_t p1 = (uint64_t) 0xCD9E8D57u * c2;
+      c0 = (uint32_t) (p1 >> 32) ^ c1 ^ k0;
+      c1 = (uint32_t) p1;
+      c2 = (uint32_t) (p0 >> 32) ^ c3 ^ k1;
+      c3 = (uint32_t) p0;
+
+      k0 += 0x9E3779B9u;
+      k1 += 0xBB67AE85u;
+    }
+
+    output[0] = c0;
+    output[1] = c1;
+    output[2] = c2;
+    output[3] = c3;
+  }
+
+  //! Return a random number in (0, 1).
+  double Random()
+  {
+    if (used == 4)
+    {
+      Block(key, stream, counter++, buffer);
+      used = 0;
+    }
+
+    return ToUniform(buffer[used++]);
+  }
+
+  //! Return a random number of the standard normal distribution.
+  double RandNormal()
+  {
+    // Box-Muller transform of two uniform numbers; the second normal number
+    // it gives is dropped, so that the stream holds no other state than its
+    // counter.
+    const double radius = std::sqrt(-2.0 * std::log(Random()));
+    return radius * std::cos(2.0 * M_PI * Random());
+  }
+
+  /**
+   * Fill the given memory with random numbers uniformly distributed in
+   * (0, 1).  The numbers come from new blocks of the stream.
+   *
+   * @param output Memory to fill.
+   * @param n Number of values to fill.
+   */
+  template<typename eT>
+  void FillUniform(eT* output, const size_t n)
+  {
+    const size_t blocks = n / 4;
+    for (size_t i = 0; i < blocks; ++i)
+    {
+      uint32_t values[4];
+      Block(key, stream, counter + i, values);
+      for (size_t j = 0; j < 4; ++j)
+        output[4 * i + j] = (eT) ToUniform(values[j]);
+    }
+    counter += blocks;
+
+    if (4 * blocks < n)
+    {
+      uint32_t values[4];
+      Block(key, stream, counter++, values);
+      for (size_t j = 0; 4 * blocks + j < n; ++j)
+        output[4 * blocks + j] = (eT) ToUniform(values[j]);
+    }
+  }
+
+  /**
+   * Fill the given memory with random numbers of the standard normal
+   * distribution (with the Box-Muller transform of uniform numbers).
+   *
+   * @param output Memory to fill.
+   * @param n Number of values to fill.
+   */
+  template<typename eT>
+  void FillNormal(eT* output, const size_t n)
+  {
+    // The uniform numbers are generated in bulk, and then transformed in
+    // pairs.
+    const size_t pairs = (n + 1) / 2;
+    uniform.set_size(2 * pairs);
+    FillUniform(uniform.memptr(), uniform.n_elem);
+
+    for (size_t i = 0; i < pairs; ++i)
+    {
+      const double radius = std::sqrt(-2.0 * std::log(uniform[2 * i]));
+      const double angle = 2.0 * M_PI * uniform[2 * i + 1];
+      output[2 * i] = (eT) (radius * std::cos(angle));
+      if (2 * i + 1 < n)
+        output[2 * i + 1] = (eT) (radius * std::sin(angle));
+    }
+  }
+
+  //! Fill the given matrix with random numbers uniformly distributed in (0, 1).
+  template<typename eT>
+  void Randu(arma::Mat<eT>& matrix)
+  {
+    FillUniform(matrix.memptr(), matrix.n_elem);
+  }
+
+  //! Fill the given matrix with random numbers of the standard normal
+  //! distribution.
+  template<typename eT>
+  void Randn(arma::Mat<eT>& matrix)
+  {
+    FillNormal(matrix.memptr(), matrix.n_elem);
+  }
+
+  //! Get the index of the stream.
+  uint64_t Stream() const { return stream; }
+
+  //! Get the index of the next block of the stream.
+  uint64_t Counter() const { return counter; }
+  //! Modify the index of the next block of the stream (to skip or repeat
+  //! blocks).
+  uint64_t& Counter()
+  {
+    used = 4;
+    return counter;
+  }
+
+ private:
+  //! Map the given 32-bit number to (0, 1).
+  static double ToUniform(const uint32_t value)
+  {
+    return (value + 0.5) * 2.3283064365386963e-10;
+  }
+
+  //! The key (the seed) of the generator.
+  uint32_t key[2];
+
+  //! The index of the stream.
+  uint64_t stream;
+
+  //! The index of the next block of the stream.
+  uint64_t counter;
+
+  //! The last block generated by Random().
+  uint32_t buffer[4];
+
+  //! The number of values of the buffer already used.
+  size_t used;
+
+  //! The uniform numbers transformed by FillNormal().
+  arma::vec uniform;
+};
+
+} // namespace math
+} // namespace mlpack
+
+#endif
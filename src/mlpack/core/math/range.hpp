@@ -57,6 +57,15 @@ class RangeType
    */
   inline RangeType(const T lo, const T hi);
 
+  /**
+   * Initialize the range to the bounds of a range with a different element
+   * type (for instance, a float range given by a tree built on float data).
+   *
+   * @param other Range to take the bounds of.
+   */
+  template<typename TT>
+  inline RangeType(const RangeType<TT>& other);
+
   //! Get the lower bound.
   inline T Lo() const { return lo; }
   //! Modify the lower bound.
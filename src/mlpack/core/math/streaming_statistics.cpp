@@ -0,0 +1,411 @@
+/**
+ * @file streaming_statistics.cpp
+ *
+ * Implementation of MomentAccumulator, QuantileSketch and CardinalitySketch.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "streaming_statistics.hpp"
+
+#include <cstring>
+
+using namespace mlpack;
+using namespace mlpack::math;
+
+MomentAccumulator::MomentAccumulator(const size_t dimensionality) :
+    count(0),
+    mean(dimensionality, arma::fill::zeros),
+    m2(dimensionality, arma::fill::zeros),
+    m3(dimensionality, arma::fill::zeros),
+    m4(dimensionality, arma::fill::zeros),
+    min(dimensionality),
+    max(dimensionality)
+{
+  min.fill(std::numeric_limits<double>::infinity());
+  max.fill(-std::numeric_limits<double>::infinity());
+}
+
+void MomentAccumulator::Update(const arma::mat& points)
+{
+  if (mean.n_elem == 0 && count == 0)
+    *this = MomentAccumulator(points.n_rows);
+
+  if (points.n_rows != mean.n_elem)
+  {
+    std::ostringstream oss;
+    oss << "MomentAccumulator::Update(): the points have " << points.n_rows
+        << " dimensions, but the accumulator has " << mean.n_elem;
+    throw std::invalid_argument(oss.str());
+  }
+
+  const size_t dimensionality = points.n_rows;
+  const size_t n = points.n_cols;
+  if (n == 0)
+    return;
+
+#ifdef HAS_OPENMP
+  const size_t numThreads = omp_get_max_threads();
+#else
+  const size_t numThreads = 1;
+#endif
+
+  // The first pass finds the sums, minima and maxima of the block, and the
+  // second pass the sums of the powers of the deviations from the mean of
+  // the block; each thread accumulates its points into its own column.
+  arma::mat sums(dimensionality, numThreads, arma::fill::zeros);
+  arma::mat mins(dimensionality, numThreads);
+  arma::mat maxs(dimensionality, numThreads);
+  mins.fill(std::numeric_limits<double>::infinity());
+  maxs.fill(-std::numeric_limits<double>::infinity());
+
+  #pragma omp parallel num_threads(numThreads)
+  {
+#ifdef HAS_OPENMP
+    const size_t thread = omp_get_thread_num();
+#else
+    const size_t thread = 0;
+#endif
+
+#ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables. If we're building for Visual Studio,
+    // use the intmax_t type instead.
+    #pragma omp for schedule(static)
+    for (intmax_t i = 0; i < (intmax_t) n; ++i)
+#else
+    #pragma omp for schedule(static)
+    for (size_t i = 0; i < n; ++i)
+#endif
+    {
+      for (size_t d = 0; d < dimensionality; ++d)
+      {
+        const double value = points(d, i);
+        sums(d, thread) += value;
+        mins(d, thread) = std::min(mins(d, thread), value);
+        maxs(d, thread) = std::max(maxs(d, thread), value);
+      }
+    }
+  }
+
+  const arma::vec blockMean = arma::sum(sums, 1) / (double) n;
+  for (size_t t = 0; t < numThreads; ++t)
+  {
+    for (size_t d = 0; d < dimensionality; ++d)
+    {
+      min[d] = std::min(min[d], mins(d, t));
+      max[d] = std::max(max[d], maxs(d, t));
+    }
+  }
+
+  arma::mat s2(dimensionality, numThreads, arma::fill::zeros);
+  arma::mat s3(dimensionality, numThreads, arma::fill::zeros);
+  arma::mat s4(dimensionality, numThreads, arma::fill::zeros);
+
+  #pragma omp parallel num_threads(numThreads)
+  {
+#ifdef HAS_OPENMP
+    const size_t thread = omp_get_thread_num();
+#else
+    const size_t thread = 0;
+#endif
+
+#ifdef _WIN32
+    #pragma omp for schedule(static)
+    for (intmax_t i = 0; i < (intmax_t) n; ++i)
+#else
+    #pragma omp for schedule(static)
+    for (size_t i = 0; i < n; ++i)
+#endif
+    {
+      for (size_t d = 0; d < dimensionality; ++d)
+      {
+        const double x = points(d, i) - blockMean[d];
+        const double x2 = x * x;
+        s2(d, thread) += x2;
+        s3(d, thread) += x2 * x;
+        s4(d, thread) += x2 * x2;
+      }
+    }
+  }
+
+  Merge(n, blockMean, arma::sum(s2, 1), arma::sum(s3, 1), arma::sum(s4, 1));
+}
+
+void MomentAccumulator::Merge(const MomentAccumulator& other)
+{
+  if (mean.n_elem == 0 && count == 0)
+  {
+    *this = other;
+    return;
+  }
+
+  if (other.mean.n_elem != mean.n_elem)
+  {
+    std::ostringstream oss;
+    oss << "MomentAccumulator::Merge(): the accumulators have "
+        << other.mean.n_elem << " and " << mean.n_elem << " dimensions";
+    throw std::invalid_argument(oss.str());
+  }
+
+  for (size_t d = 0; d < mean.n_elem; ++d)
+  {
+    min[d] = std::min(min[d], other.min[d]);
+    max[d] = std::max(max[d], other.max[d]);
+  }
+
+  Merge(other.count, other.mean, other.m2, other.m3, other.m4);
+}
+
+void MomentAccumulator::Merge(const size_t countB,
+                              const arma::vec& meanB,
+                              const arma::vec& m2B,
+                              const arma::vec& m3B,
+                              const arma::vec& m4B)
+{
+  if (countB == 0)
+    return;
+
+  if (count == 0)
+  {
+    count = countB;
+    mean = meanB;
+    m2 = m2B;
+    m3 = m3B;
+    m4 = m4B;
+    return;
+  }
+
+  // See Pébay, "Formulas for robust, one-pass parallel computation of
+  // covariances and arbitrary-order statistical moments" (2008).  Each sum is
+  // updated before the lower-order sums it depends on.
+  const double nA = count;
+  const double nB = countB;
+  const double n = nA + nB;
+  const arma::vec delta = meanB - mean;
+  const arma::vec deltaN = delta / n;
+  const arma::vec deltaN2 = deltaN % deltaN;
+
+  m4 += m4B + (nA * nB * (nA * nA - nA * nB + nB * nB)) *
+      (delta % deltaN % deltaN2) + 6.0 * deltaN2 % (nA * nA * m2B +
+      nB * nB * m2) + 4.0 * deltaN % (nA * m3B - nB * m3);
+  m3 += m3B + (nA * nB * (nA - nB)) * (delta % deltaN2) +
+      3.0 * deltaN % (nA * m2B - nB * m2);
+  m2 += m2B + (nA * nB) * (delta % deltaN);
+  mean += nB * deltaN;
+  count += countB;
+}
+
+arma::vec MomentAccumulator::Variance(const bool population) const
+{
+  const double n = count;
+  return m2 / (population ? n : n - 1);
+}
+
+arma::vec MomentAccumulator::Stddev(const bool population) const
+{
+  return arma::sqrt(Variance(population));
+}
+
+arma::vec MomentAccumulator::Skewness(const bool population) const
+{
+  const double n = count;
+  const arma::vec s3 = arma::pow(Stddev(population), 3.0);
+  if (population)
+    return m3 / (n * s3);
+  else
+    return n * m3 / ((n - 1) * (n - 2) * s3);
+}
+
+arma::vec MomentAccumulator::Kurtosis(const bool population) const
+{
+  const double n = count;
+  if (population)
+    return n * m4 / arma::square(m2) - 3.0;
+
+  const arma::vec s4 = arma::square(Variance(false));
+  const double norm3 = (3 * (n - 1) * (n - 1)) / ((n - 2) * (n - 3));
+  const double normC = (n * (n + 1)) / ((n - 1) * (n - 2) * (n - 3));
+  return normC * m4 / s4 - norm3;
+}
+
+QuantileSketch::QuantileSketch(const size_t k) :
+    k(k),
+    count(0),
+    levels(1),
+    offsets(1, 0)
+{
+  if (k < 2)
+    throw std::invalid_argument("QuantileSketch: the capacity must be at "
+        "least 2");
+}
+
+void QuantileSketch::Insert(const double value)
+{
+  levels[0].push_back(value);
+  ++count;
+  if (levels[0].size() >= k)
+    Compact();
+}
+
+void QuantileSketch::Merge(const QuantileSketch& other)
+{
+  if (other.levels.size() > levels.size())
+  {
+    levels.resize(other.levels.size());
+    offsets.resize(other.levels.size(), 0);
+  }
+
+  for (size_t i = 0; i < other.levels.size(); ++i)
+  {
+    levels[i].insert(levels[i].end(), other.levels[i].begin(),
+        other.levels[i].end());
+  }
+  count += other.count;
+
+  Compact();
+}
+
+void QuantileSketch::Compact()
+{
+  for (size_t i = 0; i < levels.size(); ++i)
+  {
+    if (levels[i].size() < k)
+      continue;
+
+    if (i + 1 == levels.size())
+    {
+      levels.emplace_back();
+      offsets.push_back(0);
+    }
+
+    // Each pair of neighbouring values is replaced by one of them with twice
+    // the weight; an odd value out stays in the level.
+    std::vector<double>& level = levels[i];
+    std::sort(level.begin(), level.end());
+    const size_t pairs = level.size() / 2;
+    for (size_t j = 0; j < pairs; ++j)
+      levels[i + 1].push_back(level[2 * j + offsets[i]]);
+    offsets[i] ^= 1;
+
+    if (level.size() % 2 == 1)
+      level.erase(level.begin(), level.end() - 1);
+    else
+      level.clear();
+  }
+}
+
+double QuantileSketch::Quantile(const double q) const
+{
+  if (count == 0)
+    throw std::invalid_argument("QuantileSketch::Quantile(): no values");
+  if (q < 0.0 || q > 1.0)
+    throw std::invalid_argument("QuantileSketch::Quantile(): the quantile "
+        "must be between 0 and 1");
+
+  std::vector<std::pair<double, size_t>> values;
+  for (size_t i = 0; i < levels.size(); ++i)
+    for (size_t j = 0; j < levels[i].size(); ++j)
+      values.emplace_back(levels[i][j], size_t(1) << i);
+  std::sort(values.begin(), values.end());
+
+  // Find the values of ranks lower and lower + 1, where each value of the
+  // sketch covers as many ranks as its weight.
+  const double position = q * (count - 1);
+  const size_t lower = (size_t) std::floor(position);
+  const double fraction = position - lower;
+
+  double lowerValue = values.back().first;
+  double upperValue = values.back().first;
+  bool foundLower = false;
+  size_t rank = 0;
+  for (size_t i = 0; i < values.size(); ++i)
+  {
+    rank += values[i].second;
+    if (!foundLower && rank > lower)
+    {
+      lowerValue = values[i].first;
+      foundLower = true;
+    }
+    if (rank > lower + 1)
+    {
+      upperValue = values[i].first;
+      break;
+    }
+  }
+
+  return lowerValue + fraction * (upperValue - lowerValue);
+}
+
+CardinalitySketch::CardinalitySketch(const size_t precision) :
+    precision(precision)
+{
+  if (precision < 4 || precision > 18)
+    throw std::invalid_argument("CardinalitySketch: the precision must be "
+        "between 4 and 18");
+
+  registers.resize(size_t(1) << precision, 0);
+}
+
+void CardinalitySketch::Insert(const double value)
+{
+  // 0.0 and -0.0 are the same value.
+  const double canonical = (value == 0.0) ? 0.0 : value;
+  uint64_t hash;
+  std::memcpy(&hash, &canonical, sizeof(hash));
+
+  // Mix the bits (with the finalizer of SplitMix64), so that the register and
+  // the leading zeros are independent of the structure of doubles.
+  hash += 0x9E3779B97F4A7C15ULL;
+  hash = (hash ^ (hash >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  hash = (hash ^ (hash >> 27)) * 0x94D049BB133111EBULL;
+  hash ^= (hash >> 31);
+
+  const size_t index = hash >> (64 - precision);
+  uint64_t rest = hash << precision;
+  unsigned char rank = 1;
+  while (rank <= 64 - precision && !(rest & (1ULL << 63)))
+  {
+    ++rank;
+    rest <<= 1;
+  }
+
+  registers[index] = std::max(registers[index], rank);
+}
+
+void CardinalitySketch::Merge(const CardinalitySketch& other)
+{
+  if (other.precision != precision)
+    throw std::invalid_argument("CardinalitySketch::Merge(): the sketches "
+        "have different precisions");
+
+  for (size_t i = 0; i < registers.size(); ++i)
+    registers[i] = std::max(registers[i], other.registers[i]);
+}
+
+double CardinalitySketch::Estimate() const
+{
+  const double m = registers.size();
+  double sum = 0.0;
+  size_t zeros = 0;
+  for (size_t i = 0; i < registers.size(); ++i)
+  {
+    sum += std::ldexp(1.0, -registers[i]);
+    if (registers[i] == 0)
+      ++zeros;
+  }
+
+  const double alpha = (registers.size() == 16) ? 0.673 :
+      (registers.size() == 32) ? 0.697 : (registers.size() == 64) ? 0.709 :
+      0.7213 / (1.0 + 1.079 / m);
+  const double estimate = alpha * m * m / sum;
+
+  // For small cardinalities, linear counting of the empty registers is much
+  // more accurate.
+  if (estimate <= 2.5 * m && zeros > 0)
+    return m * std::log(m / zeros);
+
+  return estimate;
+}
@@ -0,0 +1,207 @@
+/**
+ * @file streaming_statistics.hpp
+ *
+ * Accumulators of statistics that see each point of a dataset once, so that a
+ * dataset can be described from a stream of blocks, in constant memory:
+ * MomentAccumulator (count, mean, variance, skewness, kurtosis, min and max),
+ * QuantileSketch (approximate quantiles) and CardinalitySketch (approximate
+ * number of distinct values).  Each of them can be merged with another one,
+ * so that parts of a dataset can be described in parallel.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_MATH_STREAMING_STATISTICS_HPP
+#define MLPACK_CORE_MATH_STREAMING_STATISTICS_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace math {
+
+/**
+ * MomentAccumulator keeps the count, the mean, the sums of the second, third
+ * and fourth powers of the deviations from the mean, and the minimum and
+ * maximum of each dimension of the points it has seen.  A block of points is
+ * summarized with a parallel pass over it, and the summary is merged into the
+ * accumulator with the pairwise update formulas of Terriberry and Pébay
+ * (which are stable, unlike the sums of the powers of the values), so any
+ * split of a dataset into blocks gives the same statistics up to rounding.
+ *
+ * @code
+ * MomentAccumulator moments;
+ * arma::mat block;
+ * while (reader.Next(block))
+ *   moments.Update(block);
+ * const arma::vec variances = moments.Variance();
+ * @endcode
+ */
+class MomentAccumulator
+{
+ public:
+  /**
+   * Create an accumulator that hasn't seen any point.  The dimensionality is
+   * set by the first call to Update() if it is 0.
+   *
+   * @param dimensionality Dimensionality of the points.
+   */
+  MomentAccumulator(const size_t dimensionality = 0);
+
+  /**
+   * Add the given points (one per column) to the statistics.  A
+   * std::invalid_argument is thrown if their dimensionality is wrong.
+   *
+   * @param points Points to add.
+   */
+  void Update(const arma::mat& points);
+
+  /**
+   * Add the statistics of the given accumulator (of the same dimensionality)
+   * to these.
+   *
+   * @param other Accumulator to merge.
+   */
+  void Merge(const MomentAccumulator& other);
+
+  //! Get the dimensionality of the points.
+  size_t Dimensionality() const { return mean.n_elem; }
+  //! Get the number of points seen.
+  size_t Count() const { return count; }
+  //! Get the mean of each dimension.
+  const arma::vec& Mean() const { return mean; }
+  //! Get the minimum of each dimension.
+  const arma::vec& Min() const { return min; }
+  //! Get the maximum of each dimension.
+  const arma::vec& Max() const { return max; }
+
+  /**
+   * Get the variance of each dimension; the sample variance (normalized by
+   * n - 1) by default, or the population variance (normalized by n).
+   */
+  arma::vec Variance(const bool population = false) const;
+
+  //! Get the standard deviation of each dimension (see Variance()).
+  arma::vec Stddev(const bool population = false) const;
+
+  /**
+   * Get the skewness of each dimension; the sample skewness (adjusted for the
+   * bias of a sample) by default, or the population skewness.
+   */
+  arma::vec Skewness(const bool population = false) const;
+
+  /**
+   * Get the excess kurtosis of each dimension; the sample excess kurtosis
+   * (adjusted for the bias of a sample) by default, or the population excess
+   * kurtosis.
+   */
+  arma::vec Kurtosis(const bool population = false) const;
+
+ private:
+  //! Merge the given statistics of countB points into these.
+  void Merge(const size_t countB,
+             const arma::vec& meanB,
+             const arma::vec& m2B,
+             const arma::vec& m3B,
+             const arma::vec& m4B);
+
+  //! The number of points.
+  size_t count;
+  //! The mean of each dimension.
+  arma::vec mean;
+  //! The sums of the powers of the deviations from the mean.
+  arma::vec m2, m3, m4;
+  //! The minimum and maximum of each dimension.
+  arma::vec min, max;
+};
+
+/**
+ * QuantileSketch gives approximate quantiles of a stream of values, in memory
+ * that only grows with the logarithm of the number of values.  The sketch
+ * keeps levels of at most k values, where each value of level i stands for
+ * 2^i values of the stream; when a level is full it is sorted and every other
+ * value (starting with the first and second value in turn) is promoted to the
+ * next level.  The error of the rank of a quantile is about
+ * n * log2(n / k) / k, and the quantiles are exact while fewer than k values
+ * have been inserted.
+ */
+class QuantileSketch
+{
+ public:
+  /**
+   * Create an empty sketch.
+   *
+   * @param k Capacity of each level (at least 2); a larger capacity gives
+   *     more accurate quantiles.
+   */
+  QuantileSketch(const size_t k = 512);
+
+  //! Add the given value to the sketch.
+  void Insert(const double value);
+
+  //! Add the values of the given sketch to this one.
+  void Merge(const QuantileSketch& other);
+
+  /**
+   * Get the given quantile (between 0 and 1), interpolating between the two
+   * nearest values as arma::median() does for the median.  A
+   * std::invalid_argument is thrown if the sketch is empty.
+   */
+  double Quantile(const double q) const;
+
+  //! Get the number of values inserted.
+  size_t Count() const { return count; }
+
+ private:
+  //! Promote half of the values of each full level to the next level.
+  void Compact();
+
+  //! The capacity of each level.
+  size_t k;
+  //! The number of values inserted.
+  size_t count;
+  //! The values of each level.
+  std::vector<std::vector<double>> levels;
+  //! Which of the two halves each level keeps next.
+  std::vector<char> offsets;
+};
+
+/**
+ * CardinalitySketch estimates the number of distinct values of a stream with
+ * HyperLogLog: each value is hashed into one of 2^precision registers, which
+ * keeps the largest number of leading zeros of the hashes it got.  The
+ * relative error of the estimate is about 1.04 / sqrt(2^precision) (1.6% with
+ * the default precision), and small counts are estimated almost exactly by
+ * counting the empty registers.
+ */
+class CardinalitySketch
+{
+ public:
+  /**
+   * Create an empty sketch.
+   *
+   * @param precision Logarithm of the number of registers (between 4 and 18).
+   */
+  CardinalitySketch(const size_t precision = 12);
+
+  //! Add the given value to the sketch.
+  void Insert(const double value);
+
+  //! Add the values of the given sketch (of the same precision) to this one.
+  void Merge(const CardinalitySketch& other);
+
+  //! Get the estimated number of distinct values.
+  double Estimate() const;
+
+ private:
+  //! The logarithm of the number of registers.
+  size_t precision;
+  //! The registers.
+  std::vector<unsigned char> registers;
+};
+
+} // namespace math
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,136 @@
+/**
+ * @file euclidean_transform.hpp
+ *
+ * Transformations of a dataset under which a metric becomes the Euclidean
+ * distance, so that searches can use the fast L2 code paths.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_METRICS_EUCLIDEAN_TRANSFORM_HPP
+#define MLPACK_CORE_METRICS_EUCLIDEAN_TRANSFORM_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/kernels/cosine_distance.hpp>
+#include "lmetric.hpp"
+#include "ip_metric.hpp"
+#include "mahalanobis_distance.hpp"
+
+namespace mlpack {
+namespace metric {
+
+/**
+ * EuclideanTransform<MetricType> describes a transformation T of the points
+ * such that d(a, b) = ||T(a) - T(b)|| for the given metric d.  When it
+ * exists (IsTransformable is true), a dataset can be transformed once, and a
+ * search with the metric becomes a search with the Euclidean distance
+ * (EuclideanTransform<>::MetricType) on the transformed dataset, which costs
+ * O(d) per distance evaluation and can use the trees that require an LMetric.
+ *
+ * A specialization for a transformable metric provides:
+ *
+ *  - static const bool IsTransformable = true;
+ *  - typedef ... MetricType; the metric to use on the transformed points (with
+ *    the same TakeRoot as the original metric, so distances are identical);
+ *  - a constructor taking the original metric;
+ *  - void Apply(arma::mat& points) const; which transforms each column.
+ *
+ * The general template is for metrics without such a transformation.
+ */
+template<typename OriginalMetricType>
+class EuclideanTransform
+{
+ public:
+  //! The metric can't be turned into the Euclidean distance.
+  static const bool IsTransformable = false;
+};
+
+/**
+ * The Mahalanobis distance with matrix Q = R^T R (R is the Cholesky factor) is
+ * the Euclidean distance between the points multiplied by R.  If Q is only
+ * positive semidefinite (as is the learned matrix of NCA when it has low rank),
+ * R is computed from the eigendecomposition of Q instead.
+ */
+template<bool TakeRoot>
+class EuclideanTransform<MahalanobisDistance<TakeRoot> >
+{
+ public:
+  //! The Mahalanobis distance can be turned into the Euclidean distance.
+  static const bool IsTransformable = true;
+
+  //! The metric to use on the transformed points.
+  typedef LMetric<2, TakeRoot> MetricType;
+
+  /**
+   * Compute the transformation of the given Mahalanobis distance.  If its
+   * covariance is empty (the distance then uses the identity matrix), the
+   * transformation leaves the points as they are.
+   *
+   * @param metric Mahalanobis distance to transform.
+   */
+  explicit EuclideanTransform(const MahalanobisDistance<TakeRoot>& metric)
+  {
+    const arma::mat& q = metric.Covariance();
+    if (q.n_elem == 0)
+      return;
+
+    if (!arma::chol(transformation, q))
+    {
+      arma::vec eigenvalues;
+      arma::mat eigenvectors;
+      arma::eig_sym(eigenvalues, eigenvectors, q);
+      transformation = arma::diagmat(arma::sqrt(arma::clamp(eigenvalues, 0.0,
+          DBL_MAX))) * eigenvectors.t();
+    }
+  }
+
+  //! Transform each column of the given points.
+  void Apply(arma::mat& points) const
+  {
+    if (transformation.n_elem > 0)
+      points = transformation * points;
+  }
+
+  //! Get the matrix R the points are multiplied by (empty for the identity).
+  const arma::mat& Transformation() const { return transformation; }
+
+ private:
+  //! The matrix the points are multiplied by.
+  arma::mat transformation;
+};
+
+/**
+ * The metric induced by the cosine distance, sqrt(K(a, a) + K(b, b) -
+ * 2 K(a, b)) = sqrt(2 - 2 cos(a, b)), is the Euclidean distance between the
+ * points scaled to unit norm.  Points of norm 0 stay at the origin, which is
+ * at distance 1 of every other point, as with the cosine distance.
+ */
+template<>
+class EuclideanTransform<IPMetric<kernel::CosineDistance> >
+{
+ public:
+  //! The cosine metric can be turned into the Euclidean distance.
+  static const bool IsTransformable = true;
+
+  //! The metric to use on the transformed points.
+  typedef EuclideanDistance MetricType;
+
+  //! The transformation has no parameters.
+  explicit EuclideanTransform(const IPMetric<kernel::CosineDistance>& /* m */)
+  { }
+
+  //! Scale each column of the given points to unit norm.
+  void Apply(arma::mat& points) const
+  {
+    arma::rowvec norms = arma::sqrt(arma::sum(arma::square(points), 0));
+    norms.transform([](const double n) { return (n == 0.0) ? 0.0 : 1.0 / n; });
+    points.each_row() %= norms;
+  }
+};
+
+} // namespace metric
+} // namespace mlpack
+
+#endif
@@ -83,6 +83,41 @@ class LMetric
   static typename VecTypeA::elem_type Evaluate(const VecTypeA& a,
                                                const VecTypeB& b);
 
+  /**
+   * Computes the distance between two dense floating-point columns.  This
+   * overload is chosen for columns of a matrix (as returned by col() and
+   * unsafe_col()), which is how tree-based algorithms evaluate their base
+   * cases, and works directly on the memory of the columns (see
+   * EvaluateDense()).
+   *
+   * @param a First column.
+   * @param b Second column.
+   * @return Distance between columns a and b.
+   */
+  template<typename eT>
+  static typename std::enable_if<std::is_floating_point<eT>::value, eT>::type
+  Evaluate(const arma::Col<eT>& a, const arma::Col<eT>& b);
+
+  //! Computes the distance between two dense floating-point columns; see
+  //! above.
+  template<typename eT>
+  static typename std::enable_if<std::is_floating_point<eT>::value, eT>::type
+  Evaluate(const arma::subview_col<eT>& a, const arma::subview_col<eT>& b);
+
+  /**
+   * Computes the distance between two points of the given dimensionality held
+   * in contiguous memory.  For the L1, L2 and L-infinity metrics this is an
+   * unrolled loop with independent partial results, which the compiler can
+   * vectorize with whatever SIMD instructions are enabled.
+   *
+   * @param a Memory holding the first point.
+   * @param b Memory holding the second point.
+   * @param n Dimensionality of the points.
+   * @return Distance between the points.
+   */
+  template<typename eT>
+  static eT EvaluateDense(const eT* a, const eT* b, const size_t n);
+
   //! Serialize the metric (nothing to do).
   template<typename Archive>
   void Serialize(Archive& /* ar */, const unsigned int /* version */) { }
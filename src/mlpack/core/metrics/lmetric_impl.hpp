@@ -106,6 +106,126 @@ typename VecTypeA::elem_type LMetric<INT_MAX, false>::Evaluate(
   return arma::as_scalar(arma::max(arma::abs(a - b)));
 }
 
+// Dense column overloads.
+template<int Power, bool TakeRoot>
+template<typename eT>
+typename std::enable_if<std::is_floating_point<eT>::value, eT>::type
+LMetric<Power, TakeRoot>::Evaluate(const arma::Col<eT>& a,
+                                   const arma::Col<eT>& b)
+{
+  return EvaluateDense(a.memptr(), b.memptr(), a.n_elem);
+}
+
+template<int Power, bool TakeRoot>
+template<typename eT>
+typename std::enable_if<std::is_floating_point<eT>::value, eT>::type
+LMetric<Power, TakeRoot>::Evaluate(const arma::subview_col<eT>& a,
+                                   const arma::subview_col<eT>& b)
+{
+  return EvaluateDense(a.colptr(0), b.colptr(0), a.n_elem);
+}
+
+// Unspecialized implementation for dense memory.
+template<int Power, bool TakeRoot>
+template<typename eT>
+eT LMetric<Power, TakeRoot>::EvaluateDense(const eT* a,
+                                           const eT* b,
+                                           const size_t n)
+{
+  eT sum = 0;
+  for (size_t i = 0; i < n; i++)
+    sum += std::pow(std::abs(a[i] - b[i]), Power);
+
+  if (!TakeRoot)
+    return sum;
+
+  return std::pow(sum, (1.0 / Power));
+}
+
+// The specializations below keep four independent sums, so that the loop has
+// no dependency between consecutive iterations and can be vectorized.
+
+// L1-metric specializations for dense memory; the root doesn't matter.
+template<>
+template<typename eT>
+eT LMetric<1, true>::EvaluateDense(const eT* a, const eT* b, const size_t n)
+{
+  eT sum0 = 0, sum1 = 0, sum2 = 0, sum3 = 0;
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4)
+  {
+    sum0 += std::abs(a[i] - b[i]);
+    sum1 += std::abs(a[i + 1] - b[i + 1]);
+    sum2 += std::abs(a[i + 2] - b[i + 2]);
+    sum3 += std::abs(a[i + 3] - b[i + 3]);
+  }
+  for (; i < n; i++)
+    sum0 += std::abs(a[i] - b[i]);
+
+  return (sum0 + sum1) + (sum2 + sum3);
+}
+
+template<>
+template<typename eT>
+eT LMetric<1, false>::EvaluateDense(const eT* a, const eT* b, const size_t n)
+{
+  return LMetric<1, true>::EvaluateDense(a, b, n);
+}
+
+// L2-metric specializations for dense memory.
+template<>
+template<typename eT>
+eT LMetric<2, false>::EvaluateDense(const eT* a, const eT* b, const size_t n)
+{
+  eT sum0 = 0, sum1 = 0, sum2 = 0, sum3 = 0;
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4)
+  {
+    const eT d0 = a[i] - b[i];
+    const eT d1 = a[i + 1] - b[i + 1];
+    const eT d2 = a[i + 2] - b[i + 2];
+    const eT d3 = a[i + 3] - b[i + 3];
+    sum0 += d0 * d0;
+    sum1 += d1 * d1;
+    sum2 += d2 * d2;
+    sum3 += d3 * d3;
+  }
+  for (; i < n; i++)
+  {
+    const eT d = a[i] - b[i];
+    sum0 += d * d;
+  }
+
+  return (sum0 + sum1) + (sum2 + sum3);
+}
+
+template<>
+template<typename eT>
+eT LMetric<2, true>::EvaluateDense(const eT* a, const eT* b, const size_t n)
+{
+  return std::sqrt(LMetric<2, false>::EvaluateDense(a, b, n));
+}
+
+// L-infinity (Chebyshev distance) specialization for dense memory.
+template<>
+template<typename eT>
+eT LMetric<INT_MAX, false>::EvaluateDense(const eT* a,
+                                          const eT* b,
+                                          const size_t n)
+{
+  eT max0 = 0, max1 = 0;
+  size_t i = 0;
+  for (; i + 2 <= n; i += 2)
+  {
+    max0 = std::max(max0, std::abs(a[i] - b[i]));
+    max1 = std::max(max1, std::abs(a[i + 1] - b[i + 1]));
+  }
+  for (; i < n; i++)
+    max0 = std::max(max0, std::abs(a[i] - b[i]));
+
+  return std::max(max0, max1);
+}
+
 } // namespace metric
 } // namespace mlpack
 
@@ -109,6 +109,16 @@ class AdaDeltaUpdate
   //! Modify the value used to initialise the mean squared gradient parameter.
   double& Epsilon() { return epsilon; }
 
+  //! Serialize the policy and its running averages.
+  template<typename Archive>
+  void Serialize(Archive& ar, const unsigned int /* version */)
+  {
+    ar & data::CreateNVP(rho, "rho");
+    ar & data::CreateNVP(epsilon, "epsilon");
+    ar & data::CreateNVP(meanSquaredGradient, "meanSquaredGradient");
+    ar & data::CreateNVP(meanSquaredGradientDx, "meanSquaredGradientDx");
+  }
+
  private:
   // The smoothing parameter.
   double rho;
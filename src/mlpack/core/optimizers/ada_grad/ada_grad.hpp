@@ -59,8 +59,14 @@ namespace optimization {
  *
  * @tparam DecomposableFunctionType Decomposable objective function type to be
  *         minimized.
+ * @tparam GradType Type of the gradient; with arma::sp_mat, only the
+ *         parameters with a nonzero gradient are updated (see
+ *         mlpack::optimization::SGD).
  */
-template<typename DecomposableFunctionType>
+template<
+    typename DecomposableFunctionType,
+    typename GradType = arma::mat
+>
 class AdaGrad
 {
  public:
@@ -151,9 +157,12 @@ class AdaGrad
 
  private:
   //! The Stochastic Gradient Descent object with AdaGrad policy.
-  SGD<DecomposableFunctionType, AdaGradUpdate> optimizer;
+  SGD<DecomposableFunctionType, AdaGradUpdate, GradType> optimizer;
 };
 
+template<typename DecomposableFunctionType>
+using SparseAdaGrad = AdaGrad<DecomposableFunctionType, arma::sp_mat>;
+
 } // namespace optimization
 } // namespace mlpack
 
@@ -18,13 +18,14 @@
 namespace mlpack {
 namespace optimization {
 
-template<typename DecomposableFunctionType>
-AdaGrad<DecomposableFunctionType>::AdaGrad(DecomposableFunctionType& function,
-                                           const double stepSize,
-                                           const double epsilon,
-                                           const size_t maxIterations,
-                                           const double tolerance,
-                                           const bool shuffle) :
+template<typename DecomposableFunctionType, typename GradType>
+AdaGrad<DecomposableFunctionType, GradType>::AdaGrad(
+    DecomposableFunctionType& function,
+    const double stepSize,
+    const double epsilon,
+    const size_t maxIterations,
+    const double tolerance,
+    const bool shuffle) :
     optimizer(function,
               stepSize,
               maxIterations,
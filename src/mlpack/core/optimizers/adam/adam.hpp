@@ -66,10 +66,14 @@ namespace optimization {
  * @tparam DecomposableFunctionType Decomposable objective function type to be
  *     minimized.
  * @tparam UpdateRule Adam optimizer update rule to be used.
+ * @tparam GradType Type of the gradient; with arma::sp_mat, the moments and
+ *     parameters are updated lazily, only where the gradient is nonzero (see
+ *     mlpack::optimization::AdamUpdate).
  */
 template<
     typename DecomposableFunctionType,
-    typename UpdateRule = AdamUpdate
+    typename UpdateRule = AdamUpdate,
+    typename GradType = arma::mat
 >
 class AdamType
 {
@@ -172,7 +176,7 @@ class AdamType
 
  private:
   //! The Stochastic Gradient Descent object with Adam policy.
-  SGD<DecomposableFunctionType, UpdateRule> optimizer;
+  SGD<DecomposableFunctionType, UpdateRule, GradType> optimizer;
 };
 
 template<typename DecomposableFunctionType>
@@ -181,6 +185,9 @@ using Adam = AdamType<DecomposableFunctionType, AdamUpdate>;
 template<typename DecomposableFunctionType>
 using AdaMax = AdamType<DecomposableFunctionType, AdaMaxUpdate>;
 
+template<typename DecomposableFunctionType>
+using SparseAdam = AdamType<DecomposableFunctionType, AdamUpdate, arma::sp_mat>;
+
 } // namespace optimization
 } // namespace mlpack
 
@@ -21,8 +21,12 @@
 namespace mlpack {
 namespace optimization {
 
-template<typename DecomposableFunctionType, typename UpdateRule>
-AdamType<DecomposableFunctionType, UpdateRule>::AdamType(
+template<
+    typename DecomposableFunctionType,
+    typename UpdateRule,
+    typename GradType
+>
+AdamType<DecomposableFunctionType, UpdateRule, GradType>::AdamType(
     DecomposableFunctionType& function,
     const double stepSize,
     const double beta1,
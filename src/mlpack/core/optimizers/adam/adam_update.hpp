@@ -73,6 +73,7 @@ class AdamUpdate
   {
     m = arma::zeros<arma::mat>(rows, cols);
     v = arma::zeros<arma::mat>(rows, cols);
+    iteration = 0;
   }
 
   /**
@@ -108,6 +109,41 @@ class AdamUpdate
         m / (arma::sqrt(v) + epsilon);
   }
 
+  /**
+   * Lazy update step for Adam with a sparse gradient.  The moment estimates
+   * are decayed and the parameters are updated only where the gradient is
+   * nonzero, so a step costs time proportional to the number of nonzero
+   * entries.  Unlike the dense update, the parameters with a zero gradient
+   * don't keep moving with their momentum, so the result differs from the
+   * dense update unless every parameter has a gradient at every step.
+   *
+   * @param iterate Parameters that minimize the function.
+   * @param stepSize Step size to be used for the given iteration.
+   * @param gradient The sparse gradient matrix.
+   */
+  void Update(arma::mat& iterate,
+              const double stepSize,
+              const arma::sp_mat& gradient)
+  {
+    // Increment the iteration counter variable.
+    ++iteration;
+
+    const double biasCorrection1 = 1.0 - std::pow(beta1, iteration);
+    const double biasCorrection2 = 1.0 - std::pow(beta2, iteration);
+    const double step = stepSize * std::sqrt(biasCorrection2) /
+        biasCorrection1;
+
+    for (arma::sp_mat::const_iterator it = gradient.begin();
+        it != gradient.end(); ++it)
+    {
+      double& mi = m(it.row(), it.col());
+      double& vi = v(it.row(), it.col());
+      mi = beta1 * mi + (1 - beta1) * (*it);
+      vi = beta2 * vi + (1 - beta2) * (*it) * (*it);
+      iterate(it.row(), it.col()) -= step * mi / (std::sqrt(vi) + epsilon);
+    }
+  }
+
   //! Get the value used to initialise the squared gradient parameter.
   double Epsilon() const { return epsilon; }
   //! Modify the value used to initialise the squared gradient parameter.
@@ -123,6 +159,18 @@ class AdamUpdate
   //! Modify the second moment coefficient.
   double& Beta2() { return beta2; }
 
+  //! Serialize the parameters, the moment estimates and the step counter.
+  template<typename Archive>
+  void Serialize(Archive& ar, const unsigned int /* version */)
+  {
+    ar & data::CreateNVP(epsilon, "epsilon");
+    ar & data::CreateNVP(beta1, "beta1");
+    ar & data::CreateNVP(beta2, "beta2");
+    ar & data::CreateNVP(m, "m");
+    ar & data::CreateNVP(v, "v");
+    ar & data::CreateNVP(iteration, "iteration");
+  }
+
  private:
   // The epsilon value used to initialise the squared gradient parameter.
   double epsilon;
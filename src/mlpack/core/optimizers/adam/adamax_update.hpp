@@ -75,6 +75,7 @@ class AdaMaxUpdate
   {
     m = arma::zeros<arma::mat>(rows, cols);
     u = arma::zeros<arma::mat>(rows, cols);
+    iteration = 0;
   }
 
   /**
@@ -120,6 +121,18 @@ class AdaMaxUpdate
   //! Modify the second moment coefficient.
   double& Beta2() { return beta2; }
 
+  //! Serialize the parameters, the moment estimates and the step counter.
+  template<typename Archive>
+  void Serialize(Archive& ar, const unsigned int /* version */)
+  {
+    ar & data::CreateNVP(epsilon, "epsilon");
+    ar & data::CreateNVP(beta1, "beta1");
+    ar & data::CreateNVP(beta2, "beta2");
+    ar & data::CreateNVP(m, "m");
+    ar & data::CreateNVP(u, "u");
+    ar & data::CreateNVP(iteration, "iteration");
+  }
+
  private:
   // The epsilon value used to initialise the squared gradient parameter.
   double epsilon;
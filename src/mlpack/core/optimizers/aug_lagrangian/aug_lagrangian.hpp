@@ -17,12 +17,63 @@
 
 #include <mlpack/prereqs.hpp>
 #include <mlpack/core/optimizers/lbfgs/lbfgs.hpp>
+#include <mlpack/core/util/sfinae_utility.hpp>
 
 #include "aug_lagrangian_function.hpp"
 
 namespace mlpack {
 namespace optimization {
 
+/**
+ * This gives us a HasEvaluateConstraintsCheck<T, U> type (where U is a function
+ * pointer) we can use with SFINAE to catch when a type has an
+ * EvaluateConstraints() function.
+ */
+HAS_MEM_FUNC(EvaluateConstraints, HasEvaluateConstraintsCheck);
+
+/**
+ * Whether the given function implements
+ *
+ * @code
+ * void EvaluateConstraints(const arma::mat& coordinates,
+ *                          arma::vec& constraints) const;
+ * @endcode
+ *
+ * which stores the values of all the constraints at the given coordinates.
+ */
+template<typename FunctionType>
+struct HasEvaluateConstraints
+{
+  static const bool value = HasEvaluateConstraintsCheck<FunctionType,
+      void(FunctionType::*)(const arma::mat&, arma::vec&) const>::value;
+};
+
+//! Evaluate all the constraints with the function's EvaluateConstraints().
+template<typename FunctionType>
+void EvaluateAllConstraints(
+    const FunctionType& function,
+    const arma::mat& coordinates,
+    arma::vec& constraints,
+    const typename std::enable_if_t<HasEvaluateConstraints<
+        FunctionType>::value>* = 0)
+{
+  function.EvaluateConstraints(coordinates, constraints);
+}
+
+//! Evaluate all the constraints one by one.
+template<typename FunctionType>
+void EvaluateAllConstraints(
+    FunctionType& function,
+    const arma::mat& coordinates,
+    arma::vec& constraints,
+    const typename std::enable_if_t<!HasEvaluateConstraints<
+        FunctionType>::value>* = 0)
+{
+  constraints.set_size(function.NumConstraints());
+  for (size_t i = 0; i < function.NumConstraints(); ++i)
+    constraints[i] = function.EvaluateConstraint(i, coordinates);
+}
+
 /**
  * The AugLagrangian class implements the Augmented Lagrangian method of
  * optimization.  In this scheme, a penalty term is added to the Lagrangian.
@@ -43,6 +94,15 @@ namespace optimization {
  * the given coordinates.  Evaluate() should provide the objective function
  * value for the given coordinates.
  *
+ * If evaluating all the constraints at once is cheaper than evaluating them
+ * one by one, the class may also implement
+ *
+ * - void EvaluateConstraints(const arma::mat& coordinates,
+ *        arma::vec& constraints) const;
+ *
+ * (see HasEvaluateConstraints), which is then used for the penalty and the
+ * update of the Lagrange multipliers.
+ *
  * @tparam LagrangianFunction Function which can be optimized by this class.
  */
 template<typename LagrangianFunction>
@@ -65,9 +65,9 @@ bool AugLagrangian<LagrangianFunction>::Optimize(arma::mat& coordinates,
   double lastObjective = function.Evaluate(coordinates);
 
   // Then, calculate the current penalty.
-  double penalty = 0;
-  for (size_t i = 0; i < function.NumConstraints(); i++)
-    penalty += std::pow(function.EvaluateConstraint(i, coordinates), 2);
+  arma::vec constraints;
+  EvaluateAllConstraints(function, coordinates, constraints);
+  double penalty = arma::dot(constraints, constraints);
 
   Log::Debug << "Penalty is " << penalty << " (threshold " << penaltyThreshold
       << ")." << std::endl;
@@ -97,32 +97,16 @@ bool AugLagrangian<LagrangianFunction>::Optimize(arma::mat& coordinates,
     // term is too high, and we update lambda otherwise.
 
     // First, calculate the current penalty.
-    double penalty = 0;
-    for (size_t i = 0; i < function.NumConstraints(); i++)
-    {
-      penalty += std::pow(function.EvaluateConstraint(i, coordinates), 2);
-//      Log::Debug << "Constraint " << i << " is " <<
-//          function.EvaluateConstraint(i, coordinates) << std::endl;
-    }
+    EvaluateAllConstraints(function, coordinates, constraints);
+    penalty = arma::dot(constraints, constraints);
 
     Log::Info << "Penalty is " << penalty << " (threshold "
         << penaltyThreshold << ")." << std::endl;
 
-    for (size_t i = 0; i < function.NumConstraints(); ++i)
-    {
-//      arma::mat tmpgrad;
-//      function.GradientConstraint(i, coordinates, tmpgrad);
-//      Log::Debug << "Gradient of constraint " << i << " is " << std::endl;
-//      Log::Debug << tmpgrad << std::endl;
-    }
-
     if (penalty < penaltyThreshold) // We update lambda.
     {
-      // We use the update: lambda_{k + 1} = lambda_k - sigma * c(coordinates),
-      // but we have to write a loop to do this for each constraint.
-      for (size_t i = 0; i < function.NumConstraints(); i++)
-        augfunc.Lambda()[i] -= augfunc.Sigma() *
-            function.EvaluateConstraint(i, coordinates);
+      // We use the update: lambda_{k + 1} = lambda_k - sigma * c(coordinates).
+      augfunc.Lambda() -= augfunc.Sigma() * constraints;
 
       // We also update the penalty threshold to be a factor of the current
       // penalty.  TODO: this factor should be a parameter (from CLI).  The
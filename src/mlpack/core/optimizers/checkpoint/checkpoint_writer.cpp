@@ -0,0 +1,90 @@
+/**
+ * @file checkpoint_writer.cpp
+ *
+ * Implementation of CheckpointWriter.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "checkpoint_writer.hpp"
+
+using namespace mlpack;
+using namespace mlpack::optimization;
+
+CheckpointWriter::CheckpointWriter() :
+    busy(false),
+    stop(false)
+{
+  // Nothing to do.
+}
+
+CheckpointWriter::~CheckpointWriter()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stop = true;
+  }
+  submitted.notify_one();
+
+  if (worker.joinable())
+    worker.join();
+}
+
+void CheckpointWriter::Submit(JobType newJob)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    job = std::move(newJob);
+    if (!worker.joinable())
+      worker = std::thread(&CheckpointWriter::Work, this);
+  }
+  submitted.notify_one();
+}
+
+void CheckpointWriter::Wait()
+{
+  std::unique_lock<std::mutex> lock(mutex);
+  done.wait(lock, [this]() { return !job && !busy; });
+
+  if (error)
+  {
+    std::exception_ptr jobError = error;
+    error = nullptr;
+    std::rethrow_exception(jobError);
+  }
+}
+
+void CheckpointWriter::Work()
+{
+  std::unique_lock<std::mutex> lock(mutex);
+  while (true)
+  {
+    submitted.wait(lock, [this]() { return job || stop; });
+
+    // The waiting job is run even if the thread should stop.
+    if (!job)
+      return;
+
+    JobType current = std::move(job);
+    job = nullptr;
+    busy = true;
+    lock.unlock();
+
+    try
+    {
+      current();
+    }
+    catch (...)
+    {
+      std::lock_guard<std::mutex> errorLock(mutex);
+      if (!error)
+        error = std::current_exception();
+    }
+
+    lock.lock();
+    busy = false;
+    done.notify_all();
+  }
+}
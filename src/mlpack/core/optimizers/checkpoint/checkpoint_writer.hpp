@@ -0,0 +1,100 @@
+/**
+ * @file checkpoint_writer.hpp
+ *
+ * A background thread that writes the checkpoints of an optimizer.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_OPTIMIZERS_CHECKPOINT_CHECKPOINT_WRITER_HPP
+#define MLPACK_CORE_OPTIMIZERS_CHECKPOINT_CHECKPOINT_WRITER_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace mlpack {
+namespace optimization {
+
+/**
+ * CheckpointWriter runs jobs (the writing of checkpoints) on a background
+ * thread, so that the optimizer can keep training while a checkpoint is
+ * written.  The optimizer copies its state, and submits a job that writes the
+ * copy.  At most one job waits to be run; if a new job is submitted before
+ * the waiting one has started (because the disk is slower than training), the
+ * waiting job is dropped, since the new one holds a more recent state.
+ *
+ * The thread is started with the first job, and the destructor runs the
+ * waiting job (if any) before the thread is stopped, so that the last
+ * checkpoint is never lost.
+ */
+class CheckpointWriter
+{
+ public:
+  //! The type of a job.
+  typedef std::function<void()> JobType;
+
+  //! Create the writer; the thread isn't started until the first job.
+  CheckpointWriter();
+
+  //! Run the waiting job, and stop the thread.
+  ~CheckpointWriter();
+
+  //! The writer can't be copied, since it owns its thread.
+  CheckpointWriter(const CheckpointWriter&) = delete;
+  CheckpointWriter& operator=(const CheckpointWriter&) = delete;
+
+  /**
+   * Submit a job to be run by the background thread.  If a job is already
+   * waiting to be run, it is replaced by this one.
+   *
+   * @param job Job to run.
+   */
+  void Submit(JobType job);
+
+  /**
+   * Wait until the submitted jobs are done.  If a job threw an exception, it
+   * is rethrown here.
+   */
+  void Wait();
+
+ private:
+  //! Run the jobs until the writer is destroyed.
+  void Work();
+
+  //! The background thread.
+  std::thread worker;
+
+  //! The job waiting to be run.
+  JobType job;
+
+  //! Whether a job is being run.
+  bool busy;
+
+  //! Whether the thread should stop.
+  bool stop;
+
+  //! The first exception thrown by a job.
+  std::exception_ptr error;
+
+  //! The lock of the state shared with the thread.
+  std::mutex mutex;
+
+  //! Signalled when a job is submitted or the thread should stop.
+  std::condition_variable submitted;
+
+  //! Signalled when a job is done.
+  std::condition_variable done;
+};
+
+} // namespace optimization
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,167 @@
+/**
+ * @file optimizer_state.hpp
+ *
+ * The state of an optimizer that is saved in a checkpoint, so that training
+ * can be resumed.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_OPTIMIZERS_CHECKPOINT_OPTIMIZER_STATE_HPP
+#define MLPACK_CORE_OPTIMIZERS_CHECKPOINT_OPTIMIZER_STATE_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/data/load.hpp>
+#include <mlpack/core/data/save.hpp>
+
+#include <cstdio>
+
+namespace mlpack {
+namespace optimization {
+
+/**
+ * OptimizerState holds everything an optimizer needs to continue training
+ * where it stopped: the iterate, the current step size, the number of passes
+ * over the data done so far, and the update and decay policies, which hold
+ * the moment estimates, the step counters and the position in the schedule of
+ * the step size.
+ *
+ * The state is saved with data::Save(), so the format of the file is given by
+ * its extension (.xml, .txt or .bin).  The file is written under a temporary
+ * name and then renamed, so a reader (or a job that is preempted while the
+ * checkpoint is written) never sees a partial checkpoint.
+ *
+ * @tparam UpdatePolicyType Update policy of the optimizer.
+ * @tparam DecayPolicyType Decay policy of the optimizer.
+ */
+template<typename UpdatePolicyType, typename DecayPolicyType>
+class OptimizerState
+{
+ public:
+  //! Create an empty state, to be loaded.
+  OptimizerState() : stepSize(0), passes(0) { }
+
+  /**
+   * Create the state from a copy of the state of an optimizer.
+   *
+   * @param iterate The current iterate.
+   * @param stepSize The current step size.
+   * @param passes The number of passes over the data done so far.
+   * @param updatePolicy The update policy of the optimizer.
+   * @param decayPolicy The decay policy of the optimizer.
+   */
+  OptimizerState(const arma::mat& iterate,
+                 const double stepSize,
+                 const size_t passes,
+                 const UpdatePolicyType& updatePolicy,
+                 const DecayPolicyType& decayPolicy) :
+      iterate(iterate),
+      stepSize(stepSize),
+      passes(passes),
+      updatePolicy(updatePolicy),
+      decayPolicy(decayPolicy)
+  { /* Nothing to do. */ }
+
+  /**
+   * Save the state to the given file, replacing the file only once the new
+   * state is completely written.
+   *
+   * @param filename Name of the checkpoint.
+   * @return Whether the state was saved.
+   */
+  bool Save(const std::string& filename)
+  {
+    // Keep the extension, since it gives the format.
+    const size_t dot = filename.rfind('.');
+    const size_t slash = filename.find_last_of("/\\");
+    const std::string tmpFilename = (dot == std::string::npos ||
+        (slash != std::string::npos && dot < slash)) ? filename + ".tmp" :
+        filename.substr(0, dot) + ".tmp" + filename.substr(dot);
+
+    if (!data::Save(tmpFilename, "checkpoint", *this, false))
+      return false;
+
+    #ifdef _WIN32
+    // On Windows rename() doesn't replace an existing file.
+    std::remove(filename.c_str());
+    #endif
+    if (std::rename(tmpFilename.c_str(), filename.c_str()) != 0)
+    {
+      Log::Warn << "Cannot rename '" << tmpFilename << "' to '" << filename
+          << "'; the checkpoint was not saved." << std::endl;
+      return false;
+    }
+
+    return true;
+  }
+
+  /**
+   * Load the state from the given file.
+   *
+   * @param filename Name of the checkpoint.
+   * @return Whether the state was loaded.
+   */
+  bool Load(const std::string& filename)
+  {
+    return data::Load(filename, "checkpoint", *this, false);
+  }
+
+  //! Get the iterate.
+  const arma::mat& Iterate() const { return iterate; }
+  //! Modify the iterate.
+  arma::mat& Iterate() { return iterate; }
+
+  //! Get the step size.
+  double StepSize() const { return stepSize; }
+  //! Modify the step size.
+  double& StepSize() { return stepSize; }
+
+  //! Get the number of passes over the data done so far.
+  size_t Passes() const { return passes; }
+  //! Modify the number of passes over the data done so far.
+  size_t& Passes() { return passes; }
+
+  //! Get the update policy.
+  const UpdatePolicyType& UpdatePolicy() const { return updatePolicy; }
+  //! Modify the update policy.
+  UpdatePolicyType& UpdatePolicy() { return updatePolicy; }
+
+  //! Get the decay policy.
+  const DecayPolicyType& DecayPolicy() const { return decayPolicy; }
+  //! Modify the decay policy.
+  DecayPolicyType& DecayPolicy() { return decayPolicy; }
+
+  //! Serialize the state.
+  template<typename Archive>
+  void Serialize(Archive& ar, const unsigned int /* version */)
+  {
+    ar & data::CreateNVP(iterate, "iterate");
+    ar & data::CreateNVP(stepSize, "stepSize");
+    ar & data::CreateNVP(passes, "passes");
+    ar & data::CreateNVP(updatePolicy, "updatePolicy");
+    ar & data::CreateNVP(decayPolicy, "decayPolicy");
+  }
+
+ private:
+  //! The iterate.
+  arma::mat iterate;
+
+  //! The current step size.
+  double stepSize;
+
+  //! The number of passes over the data done so far.
+  size_t passes;
+
+  //! The update policy.
+  UpdatePolicyType updatePolicy;
+
+  //! The decay policy.
+  DecayPolicyType decayPolicy;
+};
+
+} // namespace optimization
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,244 @@
+/**
+ * @file distributed_function.hpp
+ *
+ * Defines DistributedFunction, which turns a separable function whose points
+ * are sharded across the ranks of an MPI communicator into one function that
+ * the optimizers can be used on.  This file is only usable when mlpack is
+ * configured with USE_MPI.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_OPTIMIZERS_DISTRIBUTED_DISTRIBUTED_FUNCTION_HPP
+#define MLPACK_CORE_OPTIMIZERS_DISTRIBUTED_DISTRIBUTED_FUNCTION_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/optimizers/sgd/batch_function.hpp>
+#include <mpi.h>
+
+namespace mlpack {
+namespace optimization {
+
+/**
+ * DistributedFunction implements synchronous data-parallel optimization: each
+ * rank of the communicator holds a separable function over its own shard of
+ * the points (for instance a LogisticRegressionFunction on the rows of a
+ * dataset it loaded itself), and the DistributedFunction on every rank
+ * behaves like the function over the points of all the shards.  Each
+ * evaluation is collective: every rank evaluates its shard, and the results
+ * are summed with MPI_Allreduce(), so every rank holds the same objective and
+ * gradient and takes the same step.  The optimizer is run on every rank, with
+ * the same parameters.
+ *
+ * The following forms are provided, so DistributedFunction can be used with
+ * L_BFGS, GradientDescent and MiniBatchSGD:
+ *
+ * @code
+ * size_t NumFunctions();
+ * const arma::mat& GetInitialPoint();
+ * double Evaluate(const arma::mat& coordinates);
+ * void Gradient(const arma::mat& coordinates, arma::mat& gradient);
+ * double Evaluate(const arma::mat& coordinates,
+ *                 const size_t begin,
+ *                 const size_t batchSize);
+ * void Gradient(const arma::mat& coordinates,
+ *               const size_t begin,
+ *               arma::mat& gradient,
+ *               const size_t batchSize);
+ * double EvaluateWithGradient(const arma::mat& coordinates,
+ *                             const size_t begin,
+ *                             arma::mat& gradient,
+ *                             const size_t batchSize);
+ * @endcode
+ *
+ * NumFunctions() is the number of points over all ranks.  The batch
+ * [begin, begin + batchSize) is taken proportionally from every shard: a rank
+ * with n of the N points evaluates its points [begin * n / N,
+ * (begin + batchSize) * n / N), so each batch is split between all the ranks
+ * (instead of falling on one of them), and the batches of a pass over the
+ * points cover every shard exactly once.  The local batches use the batch
+ * forms of the shard's function if it has them, and its separable forms
+ * otherwise.  The objective and gradient of a batch are sent in one reduction.
+ *
+ * The members aren't const, so that the optimizers don't split a batch over
+ * several threads (see ParallelEvaluate()), which would interleave the
+ * collective calls of the ranks; the shard's function may still use OpenMP
+ * within a rank.
+ *
+ * The shards are summed, so a term that the shard's function adds once (like
+ * the regularization of LogisticRegressionFunction) is counted once per rank;
+ * either give each rank 1 / NumRanks() of it, or, for functions that average
+ * their points (like SoftmaxRegressionFunction), weight each shard by its
+ * share of the points.  The initial point is broadcast from rank 0, since the
+ * shard functions may pick it at random.  If the optimizer shuffles (like
+ * MiniBatchSGD), the random seed must be the same on every rank, so that the
+ * ranks visit the batches in the same order.
+ *
+ * While the object exists, Log::Info, Log::Warn and Log::Debug are silenced
+ * on every rank but rank 0, so the optimizer only logs once.
+ *
+ * @code
+ * // On every rank:
+ * arma::mat shard;
+ * data::Load("shard_" + std::to_string(rank) + ".csv", shard, true);
+ * arma::Row<size_t> labels = arma::conv_to<arma::Row<size_t>>::from(
+ *     shard.row(shard.n_rows - 1));
+ * shard.shed_row(shard.n_rows - 1);
+ *
+ * LogisticRegressionFunction<> lrf(shard, labels, lambda / numRanks);
+ * DistributedFunction<LogisticRegressionFunction<>> f(lrf);
+ * L_BFGS<DistributedFunction<LogisticRegressionFunction<>>> lbfgs(f);
+ * arma::mat parameters(f.GetInitialPoint());
+ * lbfgs.Optimize(parameters); // The same parameters on every rank.
+ * @endcode
+ *
+ * @tparam FunctionType Separable function over the shard of a rank.
+ */
+template<typename FunctionType>
+class DistributedFunction
+{
+ public:
+  /**
+   * Wrap the function over the shard of this rank, and share the number of
+   * points of each shard and the initial point of rank 0 between all ranks.
+   * This is collective over the communicator.  A std::invalid_argument is
+   * thrown on every rank if there are no points over all ranks.
+   *
+   * @param function Function over the shard of this rank.
+   * @param weighted If true, the objective and gradient of each shard are
+   *     weighted by its share of the points; otherwise, they are summed.
+   * @param comm The MPI communicator holding the shards.
+   */
+  DistributedFunction(FunctionType& function,
+                      const bool weighted = false,
+                      MPI_Comm comm = MPI_COMM_WORLD);
+
+  //! Restore the log streams of this rank.
+  ~DistributedFunction();
+
+  //! The function can't be copied, since it changes the log streams.
+  DistributedFunction(const DistributedFunction&) = delete;
+  DistributedFunction& operator=(const DistributedFunction&) = delete;
+
+  //! Get the number of points over all ranks.
+  size_t NumFunctions() { return numFunctions; }
+
+  //! Get the initial point (the one of rank 0).
+  const arma::mat& GetInitialPoint() { return initialPoint; }
+
+  /**
+   * Evaluate the objective over the points of all ranks.
+   *
+   * @param coordinates The point to evaluate the function at.
+   */
+  double Evaluate(const arma::mat& coordinates);
+
+  /**
+   * Compute the gradient over the points of all ranks.
+   *
+   * @param coordinates The point to evaluate the gradient at.
+   * @param gradient Matrix to store the gradient into.
+   */
+  void Gradient(const arma::mat& coordinates, arma::mat& gradient);
+
+  /**
+   * Evaluate the objective of the batch [begin, begin + batchSize), which is
+   * taken proportionally from the shard of each rank.
+   *
+   * @param coordinates The point to evaluate the function at.
+   * @param begin The first point of the batch.
+   * @param batchSize The number of points of the batch.
+   */
+  double Evaluate(const arma::mat& coordinates,
+                  const size_t begin,
+                  const size_t batchSize);
+
+  /**
+   * Compute the gradient of the batch [begin, begin + batchSize), which is
+   * taken proportionally from the shard of each rank.
+   *
+   * @param coordinates The point to evaluate the gradient at.
+   * @param begin The first point of the batch.
+   * @param gradient Matrix to store the gradient into.
+   * @param batchSize The number of points of the batch.
+   */
+  void Gradient(const arma::mat& coordinates,
+                const size_t begin,
+                arma::mat& gradient,
+                const size_t batchSize);
+
+  /**
+   * Compute the objective and the gradient of the batch
+   * [begin, begin + batchSize) with one reduction.
+   *
+   * @param coordinates The point to evaluate the function at.
+   * @param begin The first point of the batch.
+   * @param gradient Matrix to store the gradient into.
+   * @param batchSize The number of points of the batch.
+   */
+  double EvaluateWithGradient(const arma::mat& coordinates,
+                              const size_t begin,
+                              arma::mat& gradient,
+                              const size_t batchSize);
+
+  //! Get the function over the shard of this rank.
+  const FunctionType& LocalFunction() const { return function; }
+  //! Modify the function over the shard of this rank.
+  FunctionType& LocalFunction() { return function; }
+
+  //! Get the rank of this process in the communicator.
+  int Rank() const { return rank; }
+  //! Get the number of ranks in the communicator.
+  int NumRanks() const { return numRanks; }
+
+  //! Get the number of points of the shard of this rank.
+  size_t LocalNumFunctions() const { return localNumFunctions; }
+  //! Get the weight of the shard of this rank.
+  double Weight() const { return weight; }
+
+ private:
+  //! Get the local part [localBegin, localBegin + localSize) of a batch.
+  void LocalBatch(const size_t begin,
+                  const size_t batchSize,
+                  size_t& localBegin,
+                  size_t& localSize) const;
+
+  //! Sum the local values of all ranks, in place.
+  void Reduce(double* values, const size_t n);
+
+  //! The function over the shard of this rank.
+  FunctionType& function;
+  //! The communicator holding the shards.
+  MPI_Comm comm;
+  //! The rank of this process.
+  int rank;
+  //! The number of ranks.
+  int numRanks;
+
+  //! The number of points of the shard of this rank.
+  size_t localNumFunctions;
+  //! The number of points over all ranks.
+  size_t numFunctions;
+  //! The weight of the shard of this rank.
+  double weight;
+  //! The initial point of rank 0.
+  arma::mat initialPoint;
+
+  //! The buffer holding a gradient and an objective to reduce.
+  arma::vec buffer;
+
+  //! Whether each log stream ignored its input before construction.
+  bool ignoredInfo;
+  bool ignoredWarn;
+  bool ignoredDebug;
+};
+
+} // namespace optimization
+} // namespace mlpack
+
+// Include implementation.
+#include "distributed_function_impl.hpp"
+
+#endif
@@ -0,0 +1,201 @@
+/**
+ * @file distributed_function_impl.hpp
+ *
+ * Implementation of DistributedFunction.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_OPTIMIZERS_DISTRIBUTED_DISTRIBUTED_FUNCTION_IMPL_HPP
+#define MLPACK_CORE_OPTIMIZERS_DISTRIBUTED_DISTRIBUTED_FUNCTION_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "distributed_function.hpp"
+
+namespace mlpack {
+namespace optimization {
+
+template<typename FunctionType>
+DistributedFunction<FunctionType>::DistributedFunction(
+    FunctionType& function,
+    const bool weighted,
+    MPI_Comm comm) :
+    function(function),
+    comm(comm),
+    localNumFunctions(function.NumFunctions()),
+    numFunctions(0),
+    weight(1.0),
+    ignoredInfo(Log::Info.ignoreInput),
+    ignoredWarn(Log::Warn.ignoreInput),
+    ignoredDebug(false)
+{
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &numRanks);
+
+  // Only rank 0 logs.
+  if (rank != 0)
+  {
+    Log::Info.ignoreInput = true;
+    Log::Warn.ignoreInput = true;
+#ifdef DEBUG
+    ignoredDebug = Log::Debug.ignoreInput;
+    Log::Debug.ignoreInput = true;
+#endif
+  }
+
+  unsigned long long localSize = localNumFunctions;
+  unsigned long long totalSize = 0;
+  MPI_Allreduce(&localSize, &totalSize, 1, MPI_UNSIGNED_LONG_LONG, MPI_SUM,
+      comm);
+  numFunctions = totalSize;
+
+  if (numFunctions == 0)
+    throw std::invalid_argument("DistributedFunction: there are no points on "
+        "any rank");
+
+  if (weighted)
+    weight = double(localNumFunctions) / numFunctions;
+
+  // Every rank must start from the same point.
+  initialPoint = function.GetInitialPoint();
+  unsigned long long shape[2] = { initialPoint.n_rows, initialPoint.n_cols };
+  MPI_Bcast(shape, 2, MPI_UNSIGNED_LONG_LONG, 0, comm);
+  initialPoint.set_size(shape[0], shape[1]);
+  MPI_Bcast(initialPoint.memptr(), initialPoint.n_elem, MPI_DOUBLE, 0, comm);
+}
+
+template<typename FunctionType>
+DistributedFunction<FunctionType>::~DistributedFunction()
+{
+  if (rank != 0)
+  {
+    Log::Info.ignoreInput = ignoredInfo;
+    Log::Warn.ignoreInput = ignoredWarn;
+#ifdef DEBUG
+    Log::Debug.ignoreInput = ignoredDebug;
+#endif
+  }
+}
+
+template<typename FunctionType>
+double DistributedFunction<FunctionType>::Evaluate(
+    const arma::mat& coordinates)
+{
+  double objective = weight * function.Evaluate(coordinates);
+  Reduce(&objective, 1);
+  return objective;
+}
+
+template<typename FunctionType>
+void DistributedFunction<FunctionType>::Gradient(const arma::mat& coordinates,
+                                                 arma::mat& gradient)
+{
+  function.Gradient(coordinates, gradient);
+  if (weight != 1.0)
+    gradient *= weight;
+  Reduce(gradient.memptr(), gradient.n_elem);
+}
+
+template<typename FunctionType>
+double DistributedFunction<FunctionType>::Evaluate(
+    const arma::mat& coordinates,
+    const size_t begin,
+    const size_t batchSize)
+{
+  size_t localBegin, localSize;
+  LocalBatch(begin, batchSize, localBegin, localSize);
+
+  double objective = 0;
+  if (localSize > 0)
+  {
+    objective = weight * MiniBatchEvaluate(function, coordinates, localBegin,
+        localSize);
+  }
+
+  Reduce(&objective, 1);
+  return objective;
+}
+
+template<typename FunctionType>
+void DistributedFunction<FunctionType>::Gradient(
+    const arma::mat& coordinates,
+    const size_t begin,
+    arma::mat& gradient,
+    const size_t batchSize)
+{
+  size_t localBegin, localSize;
+  LocalBatch(begin, batchSize, localBegin, localSize);
+
+  // A rank with no points in the batch still takes part in the reduction.
+  if (localSize > 0)
+  {
+    MiniBatchGradient(function, coordinates, localBegin, localSize, gradient);
+    if (weight != 1.0)
+      gradient *= weight;
+  }
+  else
+  {
+    gradient.zeros(coordinates.n_rows, coordinates.n_cols);
+  }
+
+  Reduce(gradient.memptr(), gradient.n_elem);
+}
+
+template<typename FunctionType>
+double DistributedFunction<FunctionType>::EvaluateWithGradient(
+    const arma::mat& coordinates,
+    const size_t begin,
+    arma::mat& gradient,
+    const size_t batchSize)
+{
+  size_t localBegin, localSize;
+  LocalBatch(begin, batchSize, localBegin, localSize);
+
+  // The objective is sent after the gradient, in the same buffer.
+  buffer.set_size(coordinates.n_elem + 1);
+  if (localSize > 0)
+  {
+    arma::mat localGradient(buffer.memptr(), coordinates.n_rows,
+        coordinates.n_cols, false, true);
+    buffer[coordinates.n_elem] = MiniBatchEvaluateWithGradient(function,
+        coordinates, localBegin, localSize, localGradient);
+    if (weight != 1.0)
+      buffer *= weight;
+  }
+  else
+  {
+    buffer.zeros();
+  }
+
+  Reduce(buffer.memptr(), buffer.n_elem);
+
+  gradient = arma::reshape(buffer.head(coordinates.n_elem),
+      coordinates.n_rows, coordinates.n_cols);
+  return buffer[coordinates.n_elem];
+}
+
+template<typename FunctionType>
+void DistributedFunction<FunctionType>::LocalBatch(const size_t begin,
+                                                   const size_t batchSize,
+                                                   size_t& localBegin,
+                                                   size_t& localSize) const
+{
+  // Consecutive batches meet at the same local point, so a pass over the
+  // points of all ranks is a pass over the points of this rank.
+  localBegin = begin * localNumFunctions / numFunctions;
+  localSize = std::min(begin + batchSize, numFunctions) * localNumFunctions /
+      numFunctions - localBegin;
+}
+
+template<typename FunctionType>
+void DistributedFunction<FunctionType>::Reduce(double* values, const size_t n)
+{
+  MPI_Allreduce(MPI_IN_PLACE, values, n, MPI_DOUBLE, MPI_SUM, comm);
+}
+
+} // namespace optimization
+} // namespace mlpack
+
+#endif
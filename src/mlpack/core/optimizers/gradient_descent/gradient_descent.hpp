@@ -39,6 +39,18 @@ namespace optimization {
  * The parameter \f$\epsilon\f$ is specified by the tolerance parameter to the
  * constructor.
  *
+ * A fixed step size has to be small enough for the steepest part of the
+ * function, which makes the rest of the optimization slow.  With the
+ * lineSearch parameter, each iteration instead backtracks from the step size:
+ * the step is multiplied by backtrackingFactor until the Armijo condition
+ *
+ * \f[
+ * F(A_j - \alpha \nabla F(A_j)) \le F(A_j) - c \alpha \| \nabla F(A_j) \|^2
+ * \f]
+ *
+ * holds, where \f$ c \f$ is the armijoConstant parameter.  The objective of the
+ * accepted step is then reused for the convergence check.
+ *
  * For Gradient Descent to work, a FunctionType template parameter is required.
  * This class must implement the following function:
  *
@@ -64,11 +76,23 @@ class GradientDescent
    * @param maxIterations Maximum number of iterations allowed (0 means no
    *     limit).
    * @param tolerance Maximum absolute tolerance to terminate algorithm.
+   * @param lineSearch If true, each step is found by backtracking from the
+   *     step size; otherwise, the step size is used as is.
+   * @param armijoConstant Fraction of the decrease predicted by the gradient
+   *     that a step of the line search must achieve.
+   * @param backtrackingFactor Factor the step is multiplied by when it is
+   *     rejected by the line search.
+   * @param maxLineSearchTrials Maximum number of steps the line search tries
+   *     in one iteration.
    */
   GradientDescent(FunctionType& function,
                   const double stepSize = 0.01,
                   const size_t maxIterations = 100000,
-                  const double tolerance = 1e-5);
+                  const double tolerance = 1e-5,
+                  const bool lineSearch = false,
+                  const double armijoConstant = 1e-4,
+                  const double backtrackingFactor = 0.5,
+                  const size_t maxLineSearchTrials = 50);
 
   /**
    * Optimize the given function using gradient descent.  The given starting
@@ -114,7 +138,44 @@ class GradientDescent
   //! Modify the tolerance for termination.
   double& Tolerance() { return tolerance; }
 
+  //! Get whether or not the steps are found by a line search.
+  bool LineSearch() const { return lineSearch; }
+  //! Modify whether or not the steps are found by a line search.
+  bool& LineSearch() { return lineSearch; }
+
+  //! Get the Armijo constant of the line search.
+  double ArmijoConstant() const { return armijoConstant; }
+  //! Modify the Armijo constant of the line search.
+  double& ArmijoConstant() { return armijoConstant; }
+
+  //! Get the backtracking factor of the line search.
+  double BacktrackingFactor() const { return backtrackingFactor; }
+  //! Modify the backtracking factor of the line search.
+  double& BacktrackingFactor() { return backtrackingFactor; }
+
+  //! Get the maximum number of steps tried by the line search.
+  size_t MaxLineSearchTrials() const { return maxLineSearchTrials; }
+  //! Modify the maximum number of steps tried by the line search.
+  size_t& MaxLineSearchTrials() { return maxLineSearchTrials; }
+
  private:
+  /**
+   * Backtrack from the step size until the Armijo condition holds, and take
+   * that step.  If no step is accepted within the maximum number of trials,
+   * false is returned and the iterate is not changed.
+   *
+   * @param function Function to optimize.
+   * @param iterate Current iterate (will be modified).
+   * @param gradient Gradient at the current iterate.
+   * @param objective Objective at the current iterate; it is set to the
+   *     objective of the accepted step.
+   * @return Whether a step was accepted.
+   */
+  bool LineSearchStep(FunctionType& function,
+                      arma::mat& iterate,
+                      const arma::mat& gradient,
+                      double& objective);
+
   //! The instantiated function.
   FunctionType& function;
 
@@ -126,6 +187,18 @@ class GradientDescent
 
   //! The tolerance for termination.
   double tolerance;
+
+  //! Whether the steps are found by a line search.
+  bool lineSearch;
+
+  //! The Armijo constant of the line search.
+  double armijoConstant;
+
+  //! The backtracking factor of the line search.
+  double backtrackingFactor;
+
+  //! The maximum number of steps tried by the line search.
+  size_t maxLineSearchTrials;
 };
 
 } // namespace optimization
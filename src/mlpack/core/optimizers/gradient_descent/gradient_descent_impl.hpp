@@ -23,11 +23,19 @@ GradientDescent<FunctionType>::GradientDescent(
     FunctionType& function,
     const double stepSize,
     const size_t maxIterations,
-    const double tolerance) :
+    const double tolerance,
+    const bool lineSearch,
+    const double armijoConstant,
+    const double backtrackingFactor,
+    const size_t maxLineSearchTrials) :
     function(function),
     stepSize(stepSize),
     maxIterations(maxIterations),
-    tolerance(tolerance)
+    tolerance(tolerance),
+    lineSearch(lineSearch),
+    armijoConstant(armijoConstant),
+    backtrackingFactor(backtrackingFactor),
+    maxLineSearchTrials(maxLineSearchTrials)
 { /* Nothing to do. */ }
 
 //! Optimize the function (minimize).
@@ -67,6 +75,20 @@ double GradientDescent<FunctionType>::Optimize(
 
     function.Gradient(iterate, gradient);
 
+    // The line search evaluates the objective of the step it takes.
+    if (lineSearch)
+    {
+      if (!LineSearchStep(function, iterate, gradient, overallObjective))
+      {
+        Log::Warn << "Gradient Descent: line search failed to find a step "
+            << "that decreases the objective; terminating optimization."
+            << std::endl;
+        return overallObjective;
+      }
+
+      continue;
+    }
+
     // And update the iterate.
     iterate -= stepSize * gradient;
 
@@ -79,6 +101,37 @@ double GradientDescent<FunctionType>::Optimize(
   return overallObjective;
 }
 
+template<typename FunctionType>
+bool GradientDescent<FunctionType>::LineSearchStep(
+    FunctionType& function,
+    arma::mat& iterate,
+    const arma::mat& gradient,
+    double& objective)
+{
+  // The decrease of the objective predicted by the gradient, per unit of step.
+  const double decrease = armijoConstant * arma::dot(gradient, gradient);
+
+  arma::mat candidate;
+  double step = stepSize;
+  for (size_t trial = 0; trial < maxLineSearchTrials; ++trial)
+  {
+    candidate = iterate - step * gradient;
+    const double candidateObjective = function.Evaluate(candidate);
+
+    // A NaN or infinite objective fails the test too.
+    if (candidateObjective <= objective - step * decrease)
+    {
+      iterate = std::move(candidate);
+      objective = candidateObjective;
+      return true;
+    }
+
+    step *= backtrackingFactor;
+  }
+
+  return false;
+}
+
 } // namespace optimization
 } // namespace mlpack
 
@@ -0,0 +1,220 @@
+/**
+ * @file hogwild_sgd.hpp
+ *
+ * Hogwild!, lock-free parallel mini-batch stochastic gradient descent.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_OPTIMIZERS_HOGWILD_SGD_HOGWILD_SGD_HPP
+#define MLPACK_CORE_OPTIMIZERS_HOGWILD_SGD_HOGWILD_SGD_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include <memory>
+
+namespace mlpack {
+namespace optimization {
+
+/**
+ * Hogwild! is a parallel variant of mini-batch stochastic gradient descent, in
+ * which every thread takes mini-batches from a shared (shuffled) list,
+ * computes the gradient of its mini-batch at the current iterate, and applies
+ * the step to the shared iterate without any locking.  A thread may therefore
+ * compute its gradient while another thread is writing the iterate, and the
+ * concurrent updates may overwrite each other; for sparse or
+ * high-dimensional problems this costs little in convergence and avoids all
+ * synchronization between the threads.
+ *
+ * For more information, please refer to:
+ *
+ * @code
+ * @inproceedings{Recht2011,
+ *   title     = {Hogwild!: A Lock-Free Approach to Parallelizing Stochastic
+ *                Gradient Descent},
+ *   author    = {Benjamin Recht and Christopher Re and Stephen Wright and
+ *                Feng Niu},
+ *   booktitle = {Advances in Neural Information Processing Systems 24
+ *                (NIPS 2011)},
+ *   year      = {2011}
+ * }
+ * @endcode
+ *
+ * Since the threads compute gradients concurrently, the function must give
+ * each thread its own state.  For HogwildSGD to work, the
+ * DecomposableFunctionType must implement
+ *
+ *   size_t NumFunctions();
+ *   double Evaluate(const arma::mat& coordinates, const size_t i);
+ *   void Gradient(const arma::mat& coordinates,
+ *                 const size_t begin,
+ *                 arma::mat& gradient,
+ *                 const size_t batchSize,
+ *                 Workspace& workspace) const;
+ *
+ * where Workspace is a type nested in the function that can be constructed
+ * from the (const) function, and the batch Gradient() is thread-safe as long
+ * as each thread uses its own workspace; it must compute the sum of the
+ * gradients of the functions [begin, begin + batchSize) at the coordinates
+ * being optimized, as they are at the time of the call.  mlpack::ann::FFN
+ * satisfies this, so a network can be trained with
+ *
+ * @code
+ * model.Train<HogwildSGD>(predictors, responses);
+ * @endcode
+ *
+ * (the workspaces of FFN point into the parameters of the network, so the
+ * iterate must be those parameters, as in FFN::Train()).
+ *
+ * Functions whose gradient on each single function is sparse, such as
+ * RegularizedSVDFunction or LogisticRegressionFunction on sparse data, can
+ * instead implement the sparse gradient
+ *
+ *   size_t NumFunctions();
+ *   double Evaluate(const arma::mat& coordinates, const size_t i);
+ *   void Gradient(const arma::mat& coordinates,
+ *                 const size_t i,
+ *                 arma::sp_mat& gradient) const;
+ *
+ * which must be thread-safe.  Then each thread takes a disjoint part of the
+ * shuffled functions of each pass and takes one step per function, writing
+ * only the nonzero coordinates of its gradient, so that a step costs O(nnz)
+ * rather than O(dim) and the threads rarely write the same coordinates; the
+ * batch size is then only used to evaluate the objective between passes.
+ *
+ * @tparam DecomposableFunctionType Decomposable objective function type to be
+ *     minimized.
+ */
+template<typename DecomposableFunctionType>
+class HogwildSGD
+{
+ public:
+  /**
+   * Construct the HogwildSGD optimizer with the given function and parameters.
+   * The defaults here are not necessarily good for the given problem, so it is
+   * suggested that the values used be tailored for the task at hand.  The
+   * maximum number of iterations refers to the maximum number of passes over
+   * the data.
+   *
+   * @param function Function to be optimized (minimized).
+   * @param batchSize Size of each mini-batch.
+   * @param stepSize Step size for each iteration.
+   * @param maxIterations Maximum number of passes over the data (0 means no
+   *     limit).
+   * @param tolerance Maximum absolute tolerance to terminate algorithm.
+   * @param shuffle If true, the mini-batch order is shuffled before each pass;
+   *     otherwise, the mini-batches are handed out in linear order.
+   */
+  HogwildSGD(DecomposableFunctionType& function,
+             const size_t batchSize = 32,
+             const double stepSize = 0.01,
+             const size_t maxIterations = 100,
+             const double tolerance = 1e-5,
+             const bool shuffle = true);
+
+  /**
+   * Optimize the given function using Hogwild!.  The given starting point will
+   * be modified to store the finishing point of the algorithm, and the final
+   * objective value is returned.
+   *
+   * @param function Function to optimize.
+   * @param iterate Starting point (will be modified).
+   * @return Objective value of the final point.
+   */
+  double Optimize(DecomposableFunctionType& function, arma::mat& iterate);
+
+  /**
+   * Optimize the given function using Hogwild!.  The given starting point will
+   * be modified to store the finishing point of the algorithm, and the final
+   * objective value is returned.
+   *
+   * @param iterate Starting point (will be modified).
+   * @return Objective value of the final point.
+   */
+  double Optimize(arma::mat& iterate)
+  {
+    return Optimize(this->function, iterate);
+  }
+
+  //! Get the instantiated function to be optimized.
+  const DecomposableFunctionType& Function() const { return function; }
+  //! Modify the instantiated function.
+  DecomposableFunctionType& Function() { return function; }
+
+  //! Get the batch size.
+  size_t BatchSize() const { return batchSize; }
+  //! Modify the batch size.
+  size_t& BatchSize() { return batchSize; }
+
+  //! Get the step size.
+  double StepSize() const { return stepSize; }
+  //! Modify the step size.
+  double& StepSize() { return stepSize; }
+
+  //! Get the maximum number of passes (0 indicates no limit).
+  size_t MaxIterations() const { return maxIterations; }
+  //! Modify the maximum number of passes (0 indicates no limit).
+  size_t& MaxIterations() { return maxIterations; }
+
+  //! Get the tolerance for termination.
+  double Tolerance() const { return tolerance; }
+  //! Modify the tolerance for termination.
+  double& Tolerance() { return tolerance; }
+
+  //! Get whether or not the mini-batches are shuffled.
+  bool Shuffle() const { return shuffle; }
+  //! Modify whether or not the mini-batches are shuffled.
+  bool& Shuffle() { return shuffle; }
+
+ private:
+  //! Optimize with the batch Gradient() of the function and workspaces.
+  template<typename FunctionType>
+  double Optimize(FunctionType& function,
+                  arma::mat& iterate,
+                  std::false_type /* sparse */);
+
+  //! Optimize with the sparse Gradient() of each function.
+  template<typename FunctionType>
+  double Optimize(FunctionType& function,
+                  arma::mat& iterate,
+                  std::true_type /* sparse */);
+
+  /**
+   * Run the passes over the data, calling the given pass until the objective
+   * converges or the maximum number of passes is reached, and return the final
+   * objective.
+   */
+  template<typename FunctionType, typename PassType>
+  double Iterate(FunctionType& function, arma::mat& iterate, PassType pass);
+
+  //! Get the number of threads of a pass.
+  static size_t NumThreads();
+
+  //! The instantiated function.
+  DecomposableFunctionType& function;
+
+  //! The size of each mini-batch.
+  size_t batchSize;
+
+  //! The step size for each example.
+  double stepSize;
+
+  //! The maximum number of passes over the data.
+  size_t maxIterations;
+
+  //! The tolerance for termination.
+  double tolerance;
+
+  //! Controls whether or not the mini-batches are shuffled.
+  bool shuffle;
+};
+
+} // namespace optimization
+} // namespace mlpack
+
+// Include implementation.
+#include "hogwild_sgd_impl.hpp"
+
+#endif
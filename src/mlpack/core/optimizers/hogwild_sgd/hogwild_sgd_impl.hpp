@@ -0,0 +1,226 @@
+/**
+ * @file hogwild_sgd_impl.hpp
+ *
+ * Implementation of Hogwild!, lock-free parallel mini-batch stochastic
+ * gradient descent.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_OPTIMIZERS_HOGWILD_SGD_HOGWILD_SGD_IMPL_HPP
+#define MLPACK_CORE_OPTIMIZERS_HOGWILD_SGD_HOGWILD_SGD_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "hogwild_sgd.hpp"
+
+#include <mlpack/core/optimizers/sgd/batch_function.hpp>
+
+namespace mlpack {
+namespace optimization {
+
+template<typename DecomposableFunctionType>
+HogwildSGD<DecomposableFunctionType>::HogwildSGD(
+    DecomposableFunctionType& function,
+    const size_t batchSize,
+    const double stepSize,
+    const size_t maxIterations,
+    const double tolerance,
+    const bool shuffle) :
+    function(function),
+    batchSize(batchSize),
+    stepSize(stepSize),
+    maxIterations(maxIterations),
+    tolerance(tolerance),
+    shuffle(shuffle)
+{ /* Nothing to do. */ }
+
+//! Optimize the function (minimize).
+template<typename DecomposableFunctionType>
+double HogwildSGD<DecomposableFunctionType>::Optimize(
+    DecomposableFunctionType& function,
+    arma::mat& iterate)
+{
+  // The function type may be a reference (FFN::Train() passes one).
+  typedef typename std::remove_reference<DecomposableFunctionType>::type
+      FunctionType;
+
+  return Optimize(function, iterate, std::integral_constant<bool,
+      HasSparseGradient<FunctionType>::value>());
+}
+
+//! Optimize the function with the batch Gradient() and a workspace per thread.
+template<typename DecomposableFunctionType>
+template<typename FunctionType>
+double HogwildSGD<DecomposableFunctionType>::Optimize(
+    FunctionType& function,
+    arma::mat& iterate,
+    std::false_type /* sparse */)
+{
+  typedef typename FunctionType::Workspace WorkspaceType;
+
+  // Find the number of functions.
+  const size_t numFunctions = function.NumFunctions();
+  size_t numBatches = numFunctions / batchSize;
+  if (numFunctions % batchSize != 0)
+    ++numBatches; // Capture last few.
+
+  // Batch visitation order.
+  arma::Col<size_t> visitationOrder = arma::linspace<arma::Col<size_t>>(0,
+      (numBatches - 1), numBatches);
+
+  const size_t numThreads = NumThreads();
+
+  // Each thread computes its gradients with its own workspace.  They are
+  // created here, since an exception can't leave a parallel region.
+  std::vector<std::unique_ptr<WorkspaceType>> workspaces;
+  for (size_t t = 0; t < numThreads; ++t)
+    workspaces.emplace_back(new WorkspaceType(function));
+
+  return Iterate(function, iterate, [&]()
+  {
+    if (shuffle)
+      visitationOrder = arma::shuffle(visitationOrder);
+
+    // The threads take the mini-batches of this pass from the shared order,
+    // and update the shared iterate without any locking.
+    #pragma omp parallel num_threads(numThreads)
+    {
+#ifdef HAS_OPENMP
+      const size_t thread = omp_get_thread_num();
+#else
+      const size_t thread = 0;
+#endif
+      const FunctionType& threadFunction = function;
+      arma::mat gradient;
+
+#ifdef _WIN32
+      // Tiny workaround: Visual Studio only implements OpenMP 2.0, which
+      // doesn't support unsigned loop variables. If we're building for Visual
+      // Studio, use the intmax_t type instead.
+      #pragma omp for schedule(dynamic)
+      for (intmax_t b = 0; b < (intmax_t) numBatches; ++b)
+#else
+      #pragma omp for schedule(dynamic)
+      for (size_t b = 0; b < numBatches; ++b)
+#endif
+      {
+        // The last batch may not be a full-size batch.
+        const size_t offset = batchSize * visitationOrder[b];
+        const size_t currentBatchSize = std::min(batchSize,
+            numFunctions - offset);
+        threadFunction.Gradient(iterate, offset, gradient, currentBatchSize,
+            *workspaces[thread]);
+
+        iterate -= (stepSize / currentBatchSize) * gradient;
+      }
+    }
+  });
+}
+
+//! Optimize the function with the sparse Gradient() of each function.
+template<typename DecomposableFunctionType>
+template<typename FunctionType>
+double HogwildSGD<DecomposableFunctionType>::Optimize(
+    FunctionType& function,
+    arma::mat& iterate,
+    std::true_type /* sparse */)
+{
+  const size_t numFunctions = function.NumFunctions();
+  arma::Col<size_t> visitationOrder = arma::linspace<arma::Col<size_t>>(0,
+      (numFunctions - 1), numFunctions);
+
+  const size_t numThreads = NumThreads();
+
+  return Iterate(function, iterate, [&]()
+  {
+    if (shuffle)
+      visitationOrder = arma::shuffle(visitationOrder);
+
+    // Each thread takes a contiguous (so disjoint) block of the shuffled
+    // order, and only writes the coordinates of the iterate that the gradient
+    // of each of its functions touches.
+    #pragma omp parallel num_threads(numThreads)
+    {
+      const FunctionType& threadFunction = function;
+      arma::sp_mat gradient;
+
+#ifdef _WIN32
+      #pragma omp for schedule(static)
+      for (intmax_t j = 0; j < (intmax_t) numFunctions; ++j)
+#else
+      #pragma omp for schedule(static)
+      for (size_t j = 0; j < numFunctions; ++j)
+#endif
+      {
+        threadFunction.Gradient(iterate, visitationOrder[j], gradient);
+
+        for (arma::sp_mat::const_iterator it = gradient.begin();
+            it != gradient.end(); ++it)
+        {
+          iterate(it.row(), it.col()) -= stepSize * (*it);
+        }
+      }
+    }
+  });
+}
+
+template<typename DecomposableFunctionType>
+template<typename FunctionType, typename PassType>
+double HogwildSGD<DecomposableFunctionType>::Iterate(
+    FunctionType& function,
+    arma::mat& iterate,
+    PassType pass)
+{
+  // Calculate the first objective function.
+  double overallObjective = FullEvaluate(function, iterate, batchSize);
+
+  double lastObjective = DBL_MAX;
+  for (size_t i = 1; maxIterations == 0 || i <= maxIterations; ++i)
+  {
+    // Output current objective function.
+    Log::Info << "Hogwild SGD: iteration " << i << ", objective "
+        << overallObjective << "." << std::endl;
+
+    if (std::isnan(overallObjective) || std::isinf(overallObjective))
+    {
+      Log::Warn << "Hogwild SGD: converged to " << overallObjective
+          << "; terminating with failure.  Try a smaller step size?"
+          << std::endl;
+      return overallObjective;
+    }
+
+    if (std::abs(lastObjective - overallObjective) < tolerance)
+    {
+      Log::Info << "Hogwild SGD: minimized within tolerance " << tolerance
+          << "; terminating optimization." << std::endl;
+      return overallObjective;
+    }
+
+    pass();
+
+    lastObjective = overallObjective;
+    overallObjective = FullEvaluate(function, iterate, batchSize);
+  }
+
+  Log::Info << "Hogwild SGD: maximum iterations (" << maxIterations << ") "
+      << "reached; terminating optimization." << std::endl;
+
+  return overallObjective;
+}
+
+template<typename DecomposableFunctionType>
+size_t HogwildSGD<DecomposableFunctionType>::NumThreads()
+{
+#ifdef HAS_OPENMP
+  return omp_get_max_threads();
+#else
+  return 1;
+#endif
+}
+
+} // namespace optimization
+} // namespace mlpack
+
+#endif
@@ -29,6 +29,19 @@ namespace optimization {
  *  - double Evaluate(const arma::mat& coordinates);
  *  - void Gradient(const arma::mat& coordinates, arma::mat& gradient);
  *  - arma::mat& GetInitialPoint();
+ *
+ * If the function is separable and also implements the const batch forms
+ *
+ *  - size_t NumFunctions() const;
+ *  - double Evaluate(const arma::mat& coordinates, const size_t begin,
+ *                    const size_t batchSize) const;
+ *  - void Gradient(const arma::mat& coordinates, const size_t begin,
+ *                  arma::mat& gradient, const size_t batchSize) const;
+ *
+ * (as LogisticRegressionFunction and SoftmaxRegressionFunction do), then with
+ * OpenMP each evaluation of the objective and the gradient is split into one
+ * block of points per thread, and the results of the blocks are summed; see
+ * ParallelEvaluate().
  */
 template<typename FunctionType>
 class L_BFGS
@@ -164,6 +177,13 @@ class L_BFGS
   arma::cube s;
   //! Stores all the y matrices in memory.
   arma::cube y;
+  //! Stores 1 / (y' s) for each position of the memory.
+  arma::vec rho;
+  //! Stores the coefficients of the two-loop recursion for each position of
+  //! the memory.
+  arma::vec alpha;
+  //! Stores the gradients of the blocks of points of a separable function.
+  std::vector<arma::mat> blockGradients;
 
   //! Size of memory for this L-BFGS optimizer.
   size_t numBasis;
@@ -195,6 +215,14 @@ class L_BFGS
    */
   double Evaluate(const arma::mat& iterate);
 
+  /**
+   * Compute the gradient of the function at the given iterate point.
+   *
+   * @param iterate Point to compute the gradient at.
+   * @param gradient Matrix to store the gradient in.
+   */
+  void Gradient(const arma::mat& iterate, arma::mat& gradient);
+
   /**
    * Calculate the scaling factor, gamma, which is used to scale the Hessian
    * approximation matrix.  See method M3 in Section 4 of Liu and Nocedal
@@ -13,6 +13,8 @@
 #ifndef MLPACK_CORE_OPTIMIZERS_LBFGS_LBFGS_IMPL_HPP
 #define MLPACK_CORE_OPTIMIZERS_LBFGS_LBFGS_IMPL_HPP
 
+#include <mlpack/core/optimizers/sgd/batch_function.hpp>
+
 namespace mlpack {
 namespace optimization {
 
@@ -63,6 +65,8 @@ L_BFGS<FunctionType>::L_BFGS(FunctionType& function,
   newIterateTmp.set_size(rows, cols);
   s.set_size(rows, cols, numBasis);
   y.set_size(rows, cols, numBasis);
+  rho.set_size(numBasis);
+  alpha.set_size(numBasis);
 
   // Allocate the pair holding the min iterate information.
   minPointIterate.first.zeros(rows, cols);
@@ -80,7 +84,7 @@ double L_BFGS<FunctionType>::Evaluate(const arma::mat& iterate)
 {
   // Evaluate the function and keep track of the minimum function
   // value encountered during the optimization.
-  double functionValue = function.Evaluate(iterate);
+  double functionValue = ParallelEvaluate(function, iterate);
 
   if (functionValue < minPointIterate.second)
   {
@@ -91,6 +95,17 @@ double L_BFGS<FunctionType>::Evaluate(const arma::mat& iterate)
   return functionValue;
 }
 
+/**
+ * Compute the gradient of the function at the given iterate point, over
+ * several threads if the function is separable.
+ */
+template<typename FunctionType>
+void L_BFGS<FunctionType>::Gradient(const arma::mat& iterate,
+                                    arma::mat& gradient)
+{
+  ParallelGradient(function, iterate, gradient, blockGradients);
+}
+
 /**
  * Calculate the scaling factor gamma which is used to scale the Hessian
  * approximation matrix.  See method M3 in Section 4 of Liu and Nocedal (1989).
@@ -188,7 +203,7 @@ bool L_BFGS<FunctionType>::LineSearch(double& functionValue,
     newIterateTmp = iterate;
     newIterateTmp += stepSize * searchDirection;
     functionValue = Evaluate(newIterateTmp);
-    function.Gradient(newIterateTmp, gradient);
+    Gradient(newIterateTmp, gradient);
     numIterations++;
 
     if (functionValue > initialFunctionValue + stepSize *
@@ -255,21 +270,17 @@ void L_BFGS<FunctionType>::SearchDirection(const arma::mat& gradient,
   searchDirection = gradient;
 
   // See "A Recursive Formula to Compute H * g" in "Updating quasi-Newton
-  // matrices with limited storage" (Nocedal, 1980).
-
-  // Temporary variables.
-  arma::vec rho(numBasis);
-  arma::vec alpha(numBasis);
-
+  // matrices with limited storage" (Nocedal, 1980).  The s and y slices are
+  // used in place, and rho and alpha are stored by position in the memory (rho
+  // is computed once, when the slices are written), so no temporaries are
+  // allocated.
   size_t limit = (numBasis > iterationNum) ? 0 : (iterationNum - numBasis);
   for (size_t i = iterationNum; i != limit; i--)
   {
     int translatedPosition = (i + (numBasis - 1)) % numBasis;
-    rho[iterationNum - i] = 1.0 / arma::dot(y.slice(translatedPosition),
-                                            s.slice(translatedPosition));
-    alpha[iterationNum - i] = rho[iterationNum - i] *
+    alpha[translatedPosition] = rho[translatedPosition] *
         arma::dot(s.slice(translatedPosition), searchDirection);
-    searchDirection -= alpha[iterationNum - i] * y.slice(translatedPosition);
+    searchDirection -= alpha[translatedPosition] * y.slice(translatedPosition);
   }
 
   searchDirection *= scalingFactor;
@@ -277,9 +288,9 @@ void L_BFGS<FunctionType>::SearchDirection(const arma::mat& gradient,
   for (size_t i = limit; i < iterationNum; i++)
   {
     int translatedPosition = i % numBasis;
-    double beta = rho[iterationNum - i - 1] *
+    double beta = rho[translatedPosition] *
         arma::dot(y.slice(translatedPosition), searchDirection);
-    searchDirection += (alpha[iterationNum - i - 1] - beta) *
+    searchDirection += (alpha[translatedPosition] - beta) *
         s.slice(translatedPosition);
   }
 
@@ -310,6 +321,8 @@ void L_BFGS<FunctionType>::UpdateBasisSet(const size_t iterationNum,
   int overwritePos = iterationNum % numBasis;
   s.slice(overwritePos) = iterate - oldIterate;
   y.slice(overwritePos) = gradient - oldGradient;
+  rho[overwritePos] = 1.0 / arma::dot(y.slice(overwritePos),
+                                      s.slice(overwritePos));
 }
 
 /**
@@ -352,6 +365,8 @@ double L_BFGS<FunctionType>::Optimize(arma::mat& iterate)
 
   s.set_size(rows, cols, numBasis);
   y.set_size(rows, cols, numBasis);
+  rho.set_size(numBasis);
+  alpha.set_size(numBasis);
   minPointIterate.second = std::numeric_limits<double>::max();
 
   // The old iterate to be saved.
@@ -376,14 +391,14 @@ double L_BFGS<FunctionType>::Optimize(arma::mat& iterate)
   searchDirection.zeros(iterate.n_rows, iterate.n_cols);
 
   // The initial gradient value.
-  function.Gradient(iterate, gradient);
+  Gradient(iterate, gradient);
 
   // The main optimization loop.
   for (size_t itNum = 0; optimizeUntilConvergence || (itNum != maxIterations);
        ++itNum)
   {
     Log::Debug << "L-BFGS iteration " << itNum << "; objective " <<
-        function.Evaluate(iterate) << ", gradient norm " <<
+        functionValue << ", gradient norm " <<
         arma::norm(gradient, 2) << ", " <<
         ((prevFunctionValue - functionValue) /
          std::max(std::max(fabs(prevFunctionValue), fabs(functionValue)), 1.0))
@@ -455,7 +470,7 @@ double L_BFGS<FunctionType>::Optimize(arma::mat& iterate)
     UpdateBasisSet(itNum, iterate, oldIterate, gradient, oldGradient);
   } // End of the optimization loop.
 
-  return function.Evaluate(iterate);
+  return ParallelEvaluate(function, iterate);
 }
 
 } // namespace optimization
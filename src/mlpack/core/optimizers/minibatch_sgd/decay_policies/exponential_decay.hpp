@@ -0,0 +1,104 @@
+/**
+ * @file exponential_decay.hpp
+ *
+ * Definition of the exponential decay policy, which decays the step size
+ * exponentially with the number of epochs.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_OPTIMIZERS_MINIBATCH_SGD_EXPONENTIAL_DECAY_HPP
+#define MLPACK_CORE_OPTIMIZERS_MINIBATCH_SGD_EXPONENTIAL_DECAY_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace optimization {
+
+/**
+ * The exponential decay policy multiplies the step size by \f$ e^{-k} \f$ at
+ * the end of each epoch, for the decay rate \f$ k \f$, so that with the
+ * initial step size \f$ \alpha_0 \f$ the step size of epoch \f$ t \f$ is
+ *
+ * \f[
+ * \alpha_t = \alpha_0 e^{-k t}.
+ * \f]
+ *
+ * The step size is never decayed below minStepSize.
+ */
+class ExponentialDecay
+{
+ public:
+  /**
+   * Construct the exponential decay policy.
+   *
+   * @param rate Decay rate k.
+   * @param minStepSize Lower bound of the step size.
+   */
+  ExponentialDecay(const double rate = 0.1, const double minStepSize = 0) :
+      rate(rate),
+      minStepSize(minStepSize)
+  { /* Nothing to do. */ }
+
+  /**
+   * This function is called in each iteration after the policy update; the
+   * step size isn't changed within an epoch.
+   *
+   * @param iterate Parameters that minimize the function.
+   * @param stepSize Step size to be used for the given iteration.
+   * @param gradient The gradient matrix.
+   */
+  void Update(arma::mat& /* iterate */,
+              double& /* stepSize */,
+              const arma::mat& /* gradient */)
+  {
+    // Nothing to do here.
+  }
+
+  /**
+   * This function is called at the end of each epoch, and decays the step
+   * size.
+   *
+   * @param iterate Parameters that minimize the function.
+   * @param stepSize Step size to be used for the next epoch.
+   * @param objective Objective of the epoch that just ended.
+   */
+  void EpochUpdate(arma::mat& /* iterate */,
+                   double& stepSize,
+                   const double /* objective */)
+  {
+    stepSize = std::max(stepSize * std::exp(-rate), minStepSize);
+  }
+
+  //! Get the decay rate.
+  double Rate() const { return rate; }
+  //! Modify the decay rate.
+  double& Rate() { return rate; }
+
+  //! Get the lower bound of the step size.
+  double MinStepSize() const { return minStepSize; }
+  //! Modify the lower bound of the step size.
+  double& MinStepSize() { return minStepSize; }
+
+  //! Serialize the policy.
+  template<typename Archive>
+  void Serialize(Archive& ar, const unsigned int /* version */)
+  {
+    ar & data::CreateNVP(rate, "rate");
+    ar & data::CreateNVP(minStepSize, "minStepSize");
+  }
+
+ private:
+  //! The decay rate.
+  double rate;
+
+  //! The lower bound of the step size.
+  double minStepSize;
+};
+
+} // namespace optimization
+} // namespace mlpack
+
+#endif
@@ -42,6 +42,11 @@ class NoDecay
   {
     // Nothing to do here.
   }
+
+  //! Serialize the policy (there is nothing to save).
+  template<typename Archive>
+  void Serialize(Archive& /* ar */, const unsigned int /* version */)
+  { /* Nothing to do. */ }
 };
 
 } // namespace optimization
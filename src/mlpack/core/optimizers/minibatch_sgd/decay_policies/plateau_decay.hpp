@@ -0,0 +1,151 @@
+/**
+ * @file plateau_decay.hpp
+ *
+ * Definition of the plateau decay policy, which decays the step size when the
+ * objective stops improving.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_OPTIMIZERS_MINIBATCH_SGD_DECAY_POLICIES_PLATEAU_DECAY_HPP
+#define MLPACK_CORE_OPTIMIZERS_MINIBATCH_SGD_DECAY_POLICIES_PLATEAU_DECAY_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace optimization {
+
+/**
+ * The plateau decay policy watches the objective of each epoch (the sum of the
+ * objectives of the mini-batches, computed during the epoch), and multiplies
+ * the step size by the factor gamma when the objective hasn't improved on the
+ * best objective seen so far by more than the given relative threshold for
+ * patience epochs in a row.  After a decay, the count starts again, so the
+ * step size is decayed at most once every patience epochs.
+ *
+ * The step size is never decayed below minStepSize.
+ */
+class PlateauDecay
+{
+ public:
+  /**
+   * Construct the plateau decay policy.
+   *
+   * @param patience Number of epochs without improvement before a decay.
+   * @param gamma Factor the step size is multiplied by at each decay.
+   * @param threshold Relative improvement of the best objective that is
+   *     counted as an improvement.
+   * @param minStepSize Lower bound of the step size.
+   */
+  PlateauDecay(const size_t patience = 5,
+               const double gamma = 0.1,
+               const double threshold = 1e-4,
+               const double minStepSize = 0) :
+      patience(patience),
+      gamma(gamma),
+      threshold(threshold),
+      minStepSize(minStepSize),
+      bestObjective(DBL_MAX),
+      badEpochs(0)
+  { /* Nothing to do. */ }
+
+  /**
+   * This function is called in each iteration after the policy update; the
+   * step size isn't changed within an epoch.
+   *
+   * @param iterate Parameters that minimize the function.
+   * @param stepSize Step size to be used for the given iteration.
+   * @param gradient The gradient matrix.
+   */
+  void Update(arma::mat& /* iterate */,
+              double& /* stepSize */,
+              const arma::mat& /* gradient */)
+  {
+    // Nothing to do here.
+  }
+
+  /**
+   * This function is called at the end of each epoch, and decays the step
+   * size if the objective has been on a plateau for patience epochs.
+   *
+   * @param iterate Parameters that minimize the function.
+   * @param stepSize Step size to be used for the next epoch.
+   * @param objective Objective of the epoch that just ended.
+   */
+  void EpochUpdate(arma::mat& /* iterate */,
+                   double& stepSize,
+                   const double objective)
+  {
+    if (objective < bestObjective - threshold * std::abs(bestObjective) ||
+        bestObjective == DBL_MAX)
+    {
+      bestObjective = objective;
+      badEpochs = 0;
+      return;
+    }
+
+    if (++badEpochs >= patience)
+    {
+      stepSize = std::max(stepSize * gamma, minStepSize);
+      badEpochs = 0;
+    }
+  }
+
+  //! Get the number of epochs without improvement before a decay.
+  size_t Patience() const { return patience; }
+  //! Modify the number of epochs without improvement before a decay.
+  size_t& Patience() { return patience; }
+
+  //! Get the decay factor.
+  double Gamma() const { return gamma; }
+  //! Modify the decay factor.
+  double& Gamma() { return gamma; }
+
+  //! Get the relative improvement threshold.
+  double Threshold() const { return threshold; }
+  //! Modify the relative improvement threshold.
+  double& Threshold() { return threshold; }
+
+  //! Get the lower bound of the step size.
+  double MinStepSize() const { return minStepSize; }
+  //! Modify the lower bound of the step size.
+  double& MinStepSize() { return minStepSize; }
+
+  //! Serialize the policy and the best objective seen so far.
+  template<typename Archive>
+  void Serialize(Archive& ar, const unsigned int /* version */)
+  {
+    ar & data::CreateNVP(patience, "patience");
+    ar & data::CreateNVP(gamma, "gamma");
+    ar & data::CreateNVP(threshold, "threshold");
+    ar & data::CreateNVP(minStepSize, "minStepSize");
+    ar & data::CreateNVP(bestObjective, "bestObjective");
+    ar & data::CreateNVP(badEpochs, "badEpochs");
+  }
+
+ private:
+  //! The number of epochs without improvement before a decay.
+  size_t patience;
+
+  //! The decay factor.
+  double gamma;
+
+  //! The relative improvement threshold.
+  double threshold;
+
+  //! The lower bound of the step size.
+  double minStepSize;
+
+  //! The best objective seen so far.
+  double bestObjective;
+
+  //! The number of epochs since the last improvement (or decay).
+  size_t badEpochs;
+};
+
+} // namespace optimization
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,112 @@
+/**
+ * @file step_decay.hpp
+ *
+ * Definition of the step decay policy, which multiplies the step size by a
+ * constant factor every given number of epochs.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_OPTIMIZERS_MINIBATCH_SGD_DECAY_POLICIES_STEP_DECAY_HPP
+#define MLPACK_CORE_OPTIMIZERS_MINIBATCH_SGD_DECAY_POLICIES_STEP_DECAY_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace optimization {
+
+/**
+ * The step decay policy multiplies the step size by the factor gamma after
+ * every stepEpochs passes over the data, so that with the initial step size
+ * \f$ \alpha_0 \f$ the step size of epoch \f$ t \f$ is
+ *
+ * \f[
+ * \alpha_t = \alpha_0 \gamma^{\lfloor t / s \rfloor}.
+ * \f]
+ *
+ * The step size is only changed between epochs (in EpochUpdate()), so every
+ * mini-batch of an epoch uses the same step size.
+ */
+class StepDecay
+{
+ public:
+  /**
+   * Construct the step decay policy.
+   *
+   * @param stepEpochs Number of epochs between two decays of the step size.
+   * @param gamma Factor the step size is multiplied by at each decay.
+   */
+  StepDecay(const size_t stepEpochs = 10, const double gamma = 0.5) :
+      stepEpochs(stepEpochs),
+      gamma(gamma),
+      epoch(0)
+  { /* Nothing to do. */ }
+
+  /**
+   * This function is called in each iteration after the policy update; the
+   * step size isn't changed within an epoch.
+   *
+   * @param iterate Parameters that minimize the function.
+   * @param stepSize Step size to be used for the given iteration.
+   * @param gradient The gradient matrix.
+   */
+  void Update(arma::mat& /* iterate */,
+              double& /* stepSize */,
+              const arma::mat& /* gradient */)
+  {
+    // Nothing to do here.
+  }
+
+  /**
+   * This function is called at the end of each epoch, and decays the step
+   * size every stepEpochs epochs.
+   *
+   * @param iterate Parameters that minimize the function.
+   * @param stepSize Step size to be used for the next epoch.
+   * @param objective Objective of the epoch that just ended.
+   */
+  void EpochUpdate(arma::mat& /* iterate */,
+                   double& stepSize,
+                   const double /* objective */)
+  {
+    ++epoch;
+    if (stepEpochs > 0 && (epoch % stepEpochs) == 0)
+      stepSize *= gamma;
+  }
+
+  //! Get the number of epochs between two decays.
+  size_t StepEpochs() const { return stepEpochs; }
+  //! Modify the number of epochs between two decays.
+  size_t& StepEpochs() { return stepEpochs; }
+
+  //! Get the decay factor.
+  double Gamma() const { return gamma; }
+  //! Modify the decay factor.
+  double& Gamma() { return gamma; }
+
+  //! Serialize the policy and the number of epochs done.
+  template<typename Archive>
+  void Serialize(Archive& ar, const unsigned int /* version */)
+  {
+    ar & data::CreateNVP(stepEpochs, "stepEpochs");
+    ar & data::CreateNVP(gamma, "gamma");
+    ar & data::CreateNVP(epoch, "epoch");
+  }
+
+ private:
+  //! The number of epochs between two decays.
+  size_t stepEpochs;
+
+  //! The decay factor.
+  double gamma;
+
+  //! The number of epochs done.
+  size_t epoch;
+};
+
+} // namespace optimization
+} // namespace mlpack
+
+#endif
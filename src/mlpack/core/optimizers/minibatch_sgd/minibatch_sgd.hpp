@@ -13,12 +13,43 @@
 #define MLPACK_CORE_OPTIMIZERS_MINIBATCH_SGD_MINIBATCH_SGD_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <mlpack/core/util/sfinae_utility.hpp>
 #include <mlpack/core/optimizers/sgd/update_policies/vanilla_update.hpp>
 #include <mlpack/core/optimizers/minibatch_sgd/decay_policies/no_decay.hpp>
+#include "decay_policies/step_decay.hpp"
+#include "decay_policies/exponential_decay.hpp"
+#include "decay_policies/plateau_decay.hpp"
+#include <mlpack/core/optimizers/checkpoint/checkpoint_writer.hpp>
+#include <mlpack/core/optimizers/checkpoint/optimizer_state.hpp>
 
 namespace mlpack {
 namespace optimization {
 
+/**
+ * This gives us a HasEpochUpdateCheck object that we can use to tell whether a
+ * decay policy wants to be told about the end of each pass over the data.
+ */
+HAS_MEM_FUNC(EpochUpdate, HasEpochUpdateCheck);
+
+/**
+ * Whether the given decay policy has a function
+ *
+ * @code
+ * void EpochUpdate(arma::mat& iterate,
+ *                  double& stepSize,
+ *                  const double objective);
+ * @endcode
+ *
+ * which is called at the end of each pass over the data with the objective of
+ * the pass (as StepDecay, ExponentialDecay and PlateauDecay have).
+ */
+template<typename DecayPolicyType>
+struct HasEpochUpdate
+{
+  static const bool value = HasEpochUpdateCheck<DecayPolicyType,
+      void(DecayPolicyType::*)(arma::mat&, double&, const double)>::value;
+};
+
 /**
  * Mini-batch Stochastic Gradient Descent is a technique for minimizing a
  * function which can be expressed as a sum of other functions.  That is,
@@ -69,6 +100,54 @@ namespace optimization {
  * function on the first point in the dataset (presumably, the dataset is held
  * internally in the DecomposableFunctionType).
  *
+ * The class may also implement functions that handle a whole batch of
+ * functions [begin, begin + batchSize) at once, returning (or storing) the sum
+ * of the objectives (or gradients) of the batch:
+ *
+ *   double Evaluate(const arma::mat& coordinates,
+ *                   const size_t begin,
+ *                   const size_t batchSize);
+ *   void Gradient(const arma::mat& coordinates,
+ *                 const size_t begin,
+ *                 arma::mat& gradient,
+ *                 const size_t batchSize);
+ *
+ * If they are available, they are called once per mini-batch instead of once
+ * per function, so that the function can process the batch as one matrix (as
+ * mlpack::ann::FFN does).  The objective of each mini-batch is taken at the
+ * iterate its gradient is computed at, and the sum over a pass is used to
+ * check for convergence; if the function also implements
+ *
+ *   double EvaluateWithGradient(const arma::mat& coordinates,
+ *                               const size_t begin,
+ *                               arma::mat& gradient,
+ *                               const size_t batchSize);
+ *
+ * (as LogisticRegressionFunction does), the objective comes with the gradient
+ * at no extra cost.
+ *
+ * The decay policy can adjust the step size after each mini-batch (in
+ * Update()), and, if it has an EpochUpdate() (see HasEpochUpdate), at the end
+ * of each pass with the objective of the pass; StepDecay, ExponentialDecay
+ * and PlateauDecay use the latter.
+ *
+ * The state of the optimizer (the iterate, the step size, and the moment
+ * estimates and step counters of the update policy and the position in the
+ * schedule of the decay policy) can be saved periodically with Checkpoint();
+ * the checkpoints are written by a background thread, so training doesn't
+ * wait for the disk.  A preempted job can then continue from the last
+ * checkpoint with Resume():
+ *
+ * @code
+ * MiniBatchSGDType<FunctionType, AdamUpdate> optimizer(function);
+ * optimizer.Checkpoint("checkpoint.bin");
+ * arma::mat iterate = function.GetInitialPoint();
+ * optimizer.Resume("checkpoint.bin", iterate); // If a checkpoint exists.
+ * optimizer.Optimize(iterate);
+ * @endcode
+ *
+ * This needs the update and decay policies to implement Serialize().
+ *
  * @tparam DecomposableFunctionType Decomposable objective function type to be
  *     minimized.
  * @tparam update Update policy used during the iterative update process.
@@ -107,6 +186,10 @@ class MiniBatchSGDType
    * @param updatePolicy Instantiated update policy used to adjust the given
    *     parameters.
    * @param decayPolicy Instantiated decay policy used to adjust the step size.
+   * @param resetPolicy If true, the update policy is initialized (and its
+   *     state is lost) on every call to Optimize(); otherwise, it is
+   *     initialized only on the first call, and later calls continue with its
+   *     state.
    */
   MiniBatchSGDType(DecomposableFunctionType& function,
                    const size_t batchSize = 1000,
@@ -115,7 +198,8 @@ class MiniBatchSGDType
                    const double tolerance = 1e-5,
                    const bool shuffle = true,
                    const UpdatePolicyType& updatePolicy = UpdatePolicyType(),
-                   const DecayPolicyType& decayPolicy = DecayPolicyType());
+                   const DecayPolicyType& decayPolicy = DecayPolicyType(),
+                   const bool resetPolicy = true);
 
   /**
    * Optimize the given function using mini-batch SGD.  The given starting point
@@ -141,6 +225,34 @@ class MiniBatchSGDType
     return Optimize(this->function, iterate);
   }
 
+  /**
+   * Save the state of the optimizer to the given file every given number of
+   * passes over the data, and when Optimize() reaches the maximum number of
+   * iterations.  The format of the file is given by its extension (.xml,
+   * .txt or .bin).  The state is copied at the end of the pass and written
+   * by a background thread; if training is faster than the disk, a pending
+   * checkpoint is replaced by the newer one.  Optimize() waits for the last
+   * checkpoint to be written before it returns.  An empty filename turns
+   * checkpointing off.
+   *
+   * @param filename Name of the checkpoint.
+   * @param period Number of passes over the data between checkpoints.
+   */
+  void Checkpoint(const std::string& filename, const size_t period = 1);
+
+  /**
+   * Load the state of the optimizer from the given checkpoint, so that the
+   * next call to Optimize() continues the training where the checkpoint was
+   * taken.  The iterate is set to the iterate of the checkpoint, and
+   * ResetPolicy() is set to false.  If the checkpoint can't be loaded, false
+   * is returned and nothing is changed.
+   *
+   * @param filename Name of the checkpoint.
+   * @param iterate The iterate to continue from (will be modified).
+   * @return Whether the checkpoint was loaded.
+   */
+  bool Resume(const std::string& filename, arma::mat& iterate);
+
   //! Get the instantiated function to be optimized.
   const DecomposableFunctionType& Function() const { return function; }
   //! Modify the instantiated function.
@@ -181,7 +293,42 @@ class MiniBatchSGDType
   //! Modify the decay policy.
   DecayPolicyType& DecayPolicy() { return decayPolicy; }
 
+  //! Get whether or not the update policy is initialized on every call to
+  //! Optimize().
+  bool ResetPolicy() const { return resetPolicy; }
+  //! Modify whether or not the update policy is initialized on every call to
+  //! Optimize().
+  bool& ResetPolicy() { return resetPolicy; }
+
+  //! Get the number of passes over the data done since the update policy was
+  //! initialized.
+  size_t Passes() const { return passes; }
+
  private:
+  //! The type of the state saved in the checkpoints.
+  typedef OptimizerState<UpdatePolicyType, DecayPolicyType> StateType;
+
+  //! Let the decay policy update the step size at the end of a pass.
+  void EpochUpdate(arma::mat& iterate,
+                   const double objective,
+                   std::true_type /* hasEpochUpdate */)
+  {
+    decayPolicy.EpochUpdate(iterate, stepSize, objective);
+  }
+
+  //! The decay policy doesn't look at the passes.
+  void EpochUpdate(arma::mat& /* iterate */,
+                   const double /* objective */,
+                   std::false_type /* hasEpochUpdate */)
+  { /* Nothing to do. */ }
+
+  //! Wait for the checkpoints being written, if any.
+  void WaitForCheckpoints()
+  {
+    if (writer)
+      writer->Wait();
+  }
+
   //! The instantiated function.
   DecomposableFunctionType& function;
 
@@ -206,6 +353,29 @@ class MiniBatchSGDType
 
   //! The decay policy used to update the parameters in each iteration.
   DecayPolicyType decayPolicy;
+
+  //! Whether the update policy is initialized on every call to Optimize().
+  bool resetPolicy;
+
+  //! Whether the update policy has been initialized.
+  bool isInitialized;
+
+  //! The number of passes over the data since the update policy was
+  //! initialized.
+  size_t passes;
+
+  //! The number of passes between checkpoints.
+  size_t checkpointPeriod;
+
+  //! Copy the state and submit the checkpoint to the writer; empty if
+  //! checkpointing is off.  (It is set by Checkpoint(), so that the policies
+  //! only need Serialize() if checkpoints are used.)
+  std::function<void(const MiniBatchSGDType&, const arma::mat&)>
+      checkpointer;
+
+  //! The background thread that writes the checkpoints (shared by copies of
+  //! the optimizer).
+  std::shared_ptr<CheckpointWriter> writer;
 };
 
 template<typename DecomposableFunctionType>
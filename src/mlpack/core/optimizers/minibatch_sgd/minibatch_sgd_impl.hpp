@@ -15,6 +15,8 @@
 // In case it hasn't been included yet.
 #include "minibatch_sgd.hpp"
 
+#include <mlpack/core/optimizers/sgd/batch_function.hpp>
+
 namespace mlpack {
 namespace optimization {
 
@@ -34,7 +36,8 @@ MiniBatchSGDType<
                     const double tolerance,
                     const bool shuffle,
                     const UpdatePolicyType& updatePolicy,
-                    const DecayPolicyType& decayPolicy) :
+                    const DecayPolicyType& decayPolicy,
+                    const bool resetPolicy) :
                     function(function),
                     batchSize(batchSize),
                     stepSize(stepSize),
@@ -42,9 +45,80 @@ MiniBatchSGDType<
                     tolerance(tolerance),
                     shuffle(shuffle),
                     updatePolicy(updatePolicy),
-                    decayPolicy(decayPolicy)
+                    decayPolicy(decayPolicy),
+                    resetPolicy(resetPolicy),
+                    isInitialized(false),
+                    passes(0),
+                    checkpointPeriod(1)
 { /* Nothing to do. */ }
 
+template<
+    typename DecomposableFunctionType,
+    typename UpdatePolicyType,
+    typename DecayPolicyType
+>
+void MiniBatchSGDType<
+    DecomposableFunctionType,
+    UpdatePolicyType,
+    DecayPolicyType
+>::Checkpoint(const std::string& filename, const size_t period)
+{
+  if (filename.empty())
+  {
+    checkpointer = nullptr;
+    return;
+  }
+
+  if (period == 0)
+  {
+    throw std::invalid_argument("MiniBatchSGDType::Checkpoint(): the period "
+        "must be positive");
+  }
+
+  checkpointPeriod = period;
+  if (!writer)
+    writer.reset(new CheckpointWriter());
+
+  checkpointer = [filename](const MiniBatchSGDType& optimizer,
+                            const arma::mat& iterate)
+  {
+    // Copy the state here, so that training can go on while it is written.
+    std::shared_ptr<StateType> state(new StateType(iterate,
+        optimizer.stepSize, optimizer.passes, optimizer.updatePolicy,
+        optimizer.decayPolicy));
+    optimizer.writer->Submit([state, filename]() { state->Save(filename); });
+  };
+}
+
+template<
+    typename DecomposableFunctionType,
+    typename UpdatePolicyType,
+    typename DecayPolicyType
+>
+bool MiniBatchSGDType<
+    DecomposableFunctionType,
+    UpdatePolicyType,
+    DecayPolicyType
+>::Resume(const std::string& filename, arma::mat& iterate)
+{
+  StateType state;
+  if (!state.Load(filename))
+    return false;
+
+  iterate = std::move(state.Iterate());
+  stepSize = state.StepSize();
+  passes = state.Passes();
+  updatePolicy = std::move(state.UpdatePolicy());
+  decayPolicy = std::move(state.DecayPolicy());
+  isInitialized = true;
+  resetPolicy = false;
+
+  Log::Info << "Mini-batch SGD: resuming from '" << filename << "' after "
+      << passes << " passes." << std::endl;
+
+  return true;
+}
+
 //! Optimize the function (minimize).
 template<
     typename DecomposableFunctionType,
@@ -67,20 +141,21 @@ double MiniBatchSGDType<
   arma::Col<size_t> visitationOrder = arma::linspace<arma::Col<size_t>>(0,
       (numBatches - 1), numBatches);
 
-  if (shuffle)
-    visitationOrder = arma::shuffle(visitationOrder);
-
-  // To keep track of where we are and how things are going.
+  // To keep track of where we are and how things are going.  The objective of
+  // a pass is the sum of the objectives of its mini-batches, which are computed
+  // along with their gradients (before each update), so checking for
+  // convergence needs no extra pass over the data.
   size_t currentBatch = 0;
   double overallObjective = 0;
   double lastObjective = DBL_MAX;
 
-  // Calculate the first objective function.
-  for (size_t i = 0; i < numFunctions; ++i)
-    overallObjective += function.Evaluate(iterate, i);
-
-  // Initialize the update policy.
-  updatePolicy.Initialize(iterate.n_rows, iterate.n_cols);
+  // Initialize the update policy, unless we continue from its state.
+  if (resetPolicy || !isInitialized)
+  {
+    updatePolicy.Initialize(iterate.n_rows, iterate.n_cols);
+    isInitialized = true;
+    passes = 0;
+  }
 
   // Now iterate!
   arma::mat gradient(iterate.n_rows, iterate.n_cols);
@@ -89,27 +164,44 @@ double MiniBatchSGDType<
     // Is this iteration the start of a sequence?
     if ((currentBatch % numBatches) == 0)
     {
-      // Output current objective function.
-      Log::Info << "Mini-batch SGD: iteration " << i << ", objective "
-          << overallObjective << "." << std::endl;
-
-      if (std::isnan(overallObjective) || std::isinf(overallObjective))
-      {
-        Log::Warn << "Mini-batch SGD: converged to " << overallObjective
-            << "; terminating with failure.  Try a smaller step size?"
-            << std::endl;
-        return overallObjective;
-      }
-
-      if (std::abs(lastObjective - overallObjective) < tolerance)
+      // Check the pass that just ended, if any.
+      if (i > 1)
       {
-        Log::Info << "Mini-batch SGD: minimized within tolerance " << tolerance
-            << "; terminating optimization." << std::endl;
-        return overallObjective;
+        // Output current objective function.
+        Log::Info << "Mini-batch SGD: iteration " << i << ", objective "
+            << overallObjective << "." << std::endl;
+
+        if (std::isnan(overallObjective) || std::isinf(overallObjective))
+        {
+          Log::Warn << "Mini-batch SGD: converged to " << overallObjective
+              << "; terminating with failure.  Try a smaller step size?"
+              << std::endl;
+          WaitForCheckpoints();
+          return overallObjective;
+        }
+
+        // Update the step size for the next pass, if the decay policy does
+        // that, and save the state at the end of the pass, if requested.
+        EpochUpdate(iterate, overallObjective,
+            std::integral_constant<bool,
+            HasEpochUpdate<DecayPolicyType>::value>());
+
+        ++passes;
+        if (checkpointer && (passes % checkpointPeriod) == 0)
+          checkpointer(*this, iterate);
+
+        if (std::abs(lastObjective - overallObjective) < tolerance)
+        {
+          Log::Info << "Mini-batch SGD: minimized within tolerance "
+              << tolerance << "; terminating optimization." << std::endl;
+          WaitForCheckpoints();
+          return overallObjective;
+        }
+
+        lastObjective = overallObjective;
       }
 
       // Reset the counter variables.
-      lastObjective = overallObjective;
       overallObjective = 0;
       currentBatch = 0;
 
@@ -117,53 +209,15 @@ double MiniBatchSGDType<
         visitationOrder = arma::shuffle(visitationOrder);
     }
 
-    // Evaluate the gradient for this mini-batch.
+    // Evaluate the gradient and the objective for this mini-batch.  The last
+    // batch may not be a full-size batch.
     const size_t offset = batchSize * visitationOrder[currentBatch];
-    function.Gradient(iterate, offset, gradient);
-    if (visitationOrder[currentBatch] != numBatches - 1)
-    {
-      for (size_t j = 1; j < batchSize; ++j)
-      {
-        arma::mat funcGradient;
-        function.Gradient(iterate, offset + j, funcGradient);
-        gradient += funcGradient;
-      }
+    const size_t currentBatchSize = std::min(batchSize, numFunctions - offset);
+    overallObjective += MiniBatchEvaluateWithGradient(function, iterate, offset,
+        currentBatchSize, gradient);
 
-      // Now update the iterate.
-      updatePolicy.Update(iterate, stepSize / batchSize, gradient);
-
-      // Add that to the overall objective function.
-      for (size_t j = 0; j < batchSize; ++j)
-        overallObjective += function.Evaluate(iterate, offset + j);
-    }
-    else
-    {
-      // Handle last batch differently: it's not a full-size batch.
-      const size_t lastBatchSize = numFunctions - offset - 1;
-      for (size_t j = 1; j < lastBatchSize; ++j)
-      {
-        arma::mat funcGradient;
-        function.Gradient(iterate, offset + j, funcGradient);
-        gradient += funcGradient;
-      }
-
-      // Ensure the last batch size isn't zero, to avoid division by zero before
-      // updating.
-      if (lastBatchSize > 0)
-      {
-        // Now update the iterate.
-        updatePolicy.Update(iterate, stepSize / lastBatchSize, gradient);
-      }
-      else
-      {
-        // Now update the iterate.
-        updatePolicy.Update(iterate, stepSize, gradient);
-      }
-
-      // Add that to the overall objective function.
-      for (size_t j = 0; j < lastBatchSize; ++j)
-        overallObjective += function.Evaluate(iterate, offset + j);
-    }
+    // Now update the iterate.
+    updatePolicy.Update(iterate, stepSize / currentBatchSize, gradient);
 
     // Now update the learning rate if requested by the user.
     decayPolicy.Update(iterate, stepSize, gradient);
@@ -172,12 +226,13 @@ double MiniBatchSGDType<
   Log::Info << "Mini-batch SGD: maximum iterations (" << maxIterations << ") "
       << "reached; terminating optimization." << std::endl;
 
-  // Calculate final objective.
-  overallObjective = 0;
-  for (size_t i = 0; i < numFunctions; ++i)
-    overallObjective += function.Evaluate(iterate, i);
+  // Save the final state.
+  if (checkpointer)
+    checkpointer(*this, iterate);
+  WaitForCheckpoints();
 
-  return overallObjective;
+  // Calculate final objective.
+  return FullEvaluate(function, iterate, batchSize);
 }
 
 } // namespace optimization
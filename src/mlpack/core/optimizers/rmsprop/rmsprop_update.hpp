@@ -100,6 +100,15 @@ class RMSPropUpdate
   //! Modify the smoothing parameter.
   double& Alpha() { return alpha; }
 
+  //! Serialize the policy, including the mean squared gradient.
+  template<typename Archive>
+  void Serialize(Archive& ar, const unsigned int /* version */)
+  {
+    ar & data::CreateNVP(epsilon, "epsilon");
+    ar & data::CreateNVP(alpha, "alpha");
+    ar & data::CreateNVP(meanSquaredGradient, "meanSquaredGradient");
+  }
+
  private:
   // The epsilon value used to initialise the squared gradient parameter.
   double epsilon;
@@ -13,12 +13,44 @@
 #define MLPACK_CORE_OPTIMIZERS_SA_SA_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <mlpack/core/math/random_stream.hpp>
+#include <mlpack/core/util/sfinae_utility.hpp>
 
 #include "exponential_schedule.hpp"
 
 namespace mlpack {
 namespace optimization {
 
+/**
+ * This gives us a HasEvaluateDeltaCheck<T, U> type (where U is a function
+ * pointer) we can use with SFINAE to catch when a type has an EvaluateDelta()
+ * function.
+ */
+HAS_MEM_FUNC(EvaluateDelta, HasEvaluateDeltaCheck);
+
+/**
+ * Whether the given function implements
+ *
+ * @code
+ * double EvaluateDelta(const arma::mat& coordinates,
+ *                      const size_t i,
+ *                      const double value);
+ * @endcode
+ *
+ * (const or not), which returns the change of the objective when the
+ * coordinate i of the given point is set to the given value, without the
+ * point being changed.
+ */
+template<typename FunctionType>
+struct HasEvaluateDelta
+{
+  static const bool value =
+      HasEvaluateDeltaCheck<FunctionType, double(FunctionType::*)(
+          const arma::mat&, const size_t, const double)>::value ||
+      HasEvaluateDeltaCheck<FunctionType, double(FunctionType::*)(
+          const arma::mat&, const size_t, const double) const>::value;
+};
+
 /**
  * Simulated Annealing is an stochastic optimization algorithm which is able to
  * deliver near-optimal results quickly without knowing the gradient of the
@@ -55,6 +87,52 @@ namespace optimization {
  * which returns the next temperature given current temperature and the value
  * of the function being optimized.
  *
+ * Since only one coordinate changes at each step, the function may also
+ * implement
+ *
+ *   double EvaluateDelta(const arma::mat& coordinates,
+ *                        const size_t i,
+ *                        const double value);
+ *
+ * which returns the change of the objective when coordinate i is set to the
+ * given value (see HasEvaluateDelta).  If it is available, it is used instead
+ * of Evaluate() for each move, which for many objectives (sums over the
+ * coordinates or over pairs of them) costs a fraction of evaluating the whole
+ * point.  The energy is evaluated again with Evaluate() at every move
+ * control, so that the rounding errors of the changes don't accumulate.
+ *
+ * With more than one chain, SA runs several annealing chains in parallel (one
+ * per OpenMP thread) at a ladder of temperatures: chain c starts at
+ * \f$ T_0 r^c \f$ for the temperature ratio r, and each chain has its own
+ * copy of the cooling schedule, its own move sizes and its own random stream.
+ * Every exchangeSweeps sweeps, neighbouring chains exchange their states with
+ * the probability of parallel tempering,
+ *
+ * \f[
+ * \min \{1, \exp((E_c - E_{c + 1}) (1 / T_c - 1 / T_{c + 1})) \},
+ * \f]
+ *
+ * so that good states found by the hot chains, which explore, move down to the
+ * cold chains, which refine them.  A chain stops when it is frozen or has made
+ * maxIterations moves, and the optimization ends when every chain has stopped;
+ * the lowest-energy state of the chains is returned.  The function must then
+ * be safe to evaluate from several threads at once.
+ *
+ * For more information on parallel tempering, see
+ *
+ * @code
+ * @article{earl2005parallel,
+ *   title   = {Parallel Tempering: Theory, Applications, and New
+ *              Perspectives},
+ *   author  = {Earl, David J. and Deem, Michael W.},
+ *   journal = {Physical Chemistry Chemical Physics},
+ *   volume  = {7},
+ *   number  = {23},
+ *   pages   = {3910--3916},
+ *   year    = {2005}
+ * }
+ * @endcode
+ *
  * @tparam FunctionType objective function type to be minimized.
  * @tparam CoolingScheduleType type for cooling schedule
  */
@@ -80,6 +158,12 @@ class SA
    * @param maxMoveCoef Maximum move size.
    * @param initMoveCoef Initial move size.
    * @param gain Proportional control in feedback move control.
+   * @param chains Number of chains run in parallel (1 runs the classic
+   *      single chain).
+   * @param exchangeSweeps Sweeps between exchanges of the states of the
+   *      chains.
+   * @param temperatureRatio Ratio of the initial temperatures of neighbouring
+   *      chains (in (0, 1]).
    */
   SA(FunctionType& function,
      CoolingScheduleType& coolingSchedule,
@@ -91,7 +175,10 @@ class SA
      const size_t maxToleranceSweep = 3,
      const double maxMoveCoef = 20,
      const double initMoveCoef = 0.3,
-     const double gain = 0.3);
+     const double gain = 0.3,
+     const size_t chains = 1,
+     const size_t exchangeSweeps = 10,
+     const double temperatureRatio = 0.5);
 
   /**
    * Optimize the given function using simulated annealing. The given starting
@@ -153,7 +240,53 @@ class SA
   //! Modify move size of each parameter.
   arma::mat& MoveSize() { return moveSize; }
 
+  //! Get the number of chains.
+  size_t Chains() const { return chains; }
+  //! Modify the number of chains.
+  size_t& Chains() { return chains; }
+
+  //! Get the number of sweeps between exchanges.
+  size_t ExchangeSweeps() const { return exchangeSweeps; }
+  //! Modify the number of sweeps between exchanges.
+  size_t& ExchangeSweeps() { return exchangeSweeps; }
+
+  //! Get the ratio of the temperatures of neighbouring chains.
+  double TemperatureRatio() const { return temperatureRatio; }
+  //! Modify the ratio of the temperatures of neighbouring chains.
+  double& TemperatureRatio() { return temperatureRatio; }
+
  private:
+  /**
+   * The state of one annealing chain.
+   */
+  struct Chain
+  {
+    //! The current point.
+    arma::mat iterate;
+    //! The energy of the current point.
+    double energy;
+    //! The current temperature.
+    double temperature;
+    //! The cooling schedule of the chain.
+    CoolingScheduleType* schedule;
+    //! The move size of each parameter.
+    arma::mat moveSize;
+    //! The accepted moves of each parameter since the last move control.
+    arma::mat accept;
+    //! The parameter to move next.
+    size_t idx;
+    //! The sweeps since the last move control.
+    size_t sweepCounter;
+    //! The number of consecutive moves below the tolerance.
+    size_t frozenCount;
+    //! The number of moves made after the initial moves.
+    size_t iteration;
+    //! Whether the chain has stopped.
+    bool done;
+    //! The random stream of the chain.
+    math::RandomStream random;
+  };
+
   //! The function to be optimized.
   FunctionType& function;
   //! The cooling schedule being used.
@@ -172,6 +305,12 @@ class SA
   size_t maxToleranceSweep;
   //! Proportional control in feedback move control.
   double gain;
+  //! The number of chains.
+  size_t chains;
+  //! The number of sweeps between exchanges.
+  size_t exchangeSweeps;
+  //! The ratio of the initial temperatures of neighbouring chains.
+  double temperatureRatio;
 
   //! Maximum move size of each parameter.
   arma::mat maxMove;
@@ -186,18 +325,34 @@ class SA
    * resets idx and increments sweepCounter. When sweepCounter reaches
    * moveCtrlSweep, it performs MoveControl() and resets sweepCounter.
    *
-   * @param iterate Current optimization position.
-   * @param accept Matrix representing which parameters have had accepted moves.
-   * @param energy Current energy of the system.
-   * @param idx Current parameter to modify.
-   * @param sweepCounter Current counter representing how many sweeps have been
-   *      completed.
+   * @param chain The chain to make the move in.
    */
-  void GenerateMove(arma::mat& iterate,
-                    arma::mat& accept,
-                    double& energy,
-                    size_t& idx,
-                    size_t& sweepCounter);
+  void GenerateMove(Chain& chain);
+
+  /**
+   * Run the given chain for at most the given number of moves, cooling after
+   * each move, until it is frozen or has made maxIterations moves.
+   *
+   * @param chain The chain to run.
+   * @param moves Maximum number of moves to make.
+   */
+  void Anneal(Chain& chain, const size_t moves);
+
+  //! Set coordinate idx of the iterate to the given value and update the
+  //! energy with Evaluate().
+  void Move(arma::mat& iterate,
+            const size_t idx,
+            const double value,
+            double& energy,
+            std::false_type /* delta */);
+
+  //! Update the energy with EvaluateDelta() and set coordinate idx of the
+  //! iterate to the given value.
+  void Move(arma::mat& iterate,
+            const size_t idx,
+            const double value,
+            double& energy,
+            std::true_type /* delta */);
 
   /**
    * MoveControl() uses a proportional feedback control to determine the size
@@ -215,9 +370,10 @@ class SA
    * Technical Report 8816, Yale University, 1988.
    *
    * @param nMoves Number of moves since last call.
-   * @param accept Matrix representing which parameters have had accepted moves.
+   * @param chain The chain whose move sizes are controlled; its matrix of
+   *      accepted moves is reset.
    */
-  void MoveControl(const size_t nMoves, arma::mat& accept);
+  void MoveControl(const size_t nMoves, Chain& chain);
 };
 
 } // namespace optimization
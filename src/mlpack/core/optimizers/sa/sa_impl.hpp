@@ -32,7 +32,10 @@ SA<FunctionType, CoolingScheduleType>::SA(
     const size_t maxToleranceSweep,
     const double maxMoveCoef,
     const double initMoveCoef,
-    const double gain) :
+    const double gain,
+    const size_t chains,
+    const size_t exchangeSweeps,
+    const double temperatureRatio) :
     function(function),
     coolingSchedule(coolingSchedule),
     maxIterations(maxIterations),
@@ -41,7 +44,10 @@ SA<FunctionType, CoolingScheduleType>::SA(
     moveCtrlSweep(moveCtrlSweep),
     tolerance(tolerance),
     maxToleranceSweep(maxToleranceSweep),
-    gain(gain)
+    gain(gain),
+    chains(chains),
+    exchangeSweeps(exchangeSweeps),
+    temperatureRatio(temperatureRatio)
 {
   const size_t rows = function.GetInitialPoint().n_rows;
   const size_t cols = function.GetInitialPoint().n_cols;
@@ -59,51 +65,168 @@ template<
 >
 double SA<FunctionType, CoolingScheduleType>::Optimize(arma::mat &iterate)
 {
-  const size_t rows = function.GetInitialPoint().n_rows;
-  const size_t cols = function.GetInitialPoint().n_cols;
+  if (chains == 0)
+  {
+    throw std::invalid_argument("SA::Optimize(): the number of chains must be "
+        "positive");
+  }
 
-  size_t frozenCount = 0;
-  double energy = function.Evaluate(iterate);
-  double oldEnergy = energy;
   math::RandomSeed(std::time(NULL));
 
-  size_t idx = 0;
-  size_t sweepCounter = 0;
+  // Every chain starts from the given point, at its own temperature.  The
+  // first chain uses the given cooling schedule, and the others use copies of
+  // it.
+  const double energy = function.Evaluate(iterate);
+  const uint64_t seed = math::RandInt(std::numeric_limits<int>::max());
+  std::vector<CoolingScheduleType> schedules(chains - 1, coolingSchedule);
+  std::vector<Chain> state(chains);
+  for (size_t c = 0; c < chains; ++c)
+  {
+    Chain& chain = state[c];
+    chain.iterate = iterate;
+    chain.energy = energy;
+    chain.temperature = temperature * std::pow(temperatureRatio, (double) c);
+    chain.schedule = (c == 0) ? &coolingSchedule : &schedules[c - 1];
+    chain.moveSize = moveSize;
+    chain.accept.zeros(iterate.n_rows, iterate.n_cols);
+    chain.idx = 0;
+    chain.sweepCounter = 0;
+    chain.frozenCount = 0;
+    chain.iteration = 0;
+    chain.done = false;
+    chain.random.Seed(seed, c);
+  }
+
+#ifdef HAS_OPENMP
+  const size_t numThreads = std::min((size_t) omp_get_max_threads(), chains);
+#else
+  const size_t numThreads = 1;
+#endif
+
+  // With one chain (or no exchanges), each chain runs until it stops.
+  const size_t roundMoves = (chains == 1 || exchangeSweeps == 0) ?
+      std::numeric_limits<size_t>::max() : exchangeSweeps * iterate.n_elem;
+
+  size_t exchanges = 0;
+  for (size_t exchangeRound = 0; ; ++exchangeRound)
+  {
+#ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables. If we're building for Visual Studio,
+    // use the intmax_t type instead.
+    #pragma omp parallel for schedule(dynamic) num_threads(numThreads)
+    for (intmax_t c = 0; c < (intmax_t) chains; ++c)
+#else
+    #pragma omp parallel for schedule(dynamic) num_threads(numThreads)
+    for (size_t c = 0; c < chains; ++c)
+#endif
+    {
+      // Initial moves to get rid of dependency of initial states.
+      if (exchangeRound == 0)
+      {
+        for (size_t i = 0; i < initMoves; ++i)
+          GenerateMove(state[c]);
+      }
+
+      Anneal(state[c], roundMoves);
+    }
+
+    bool done = true;
+    for (size_t c = 0; c < chains; ++c)
+      done &= state[c].done;
+    if (done)
+      break;
+
+    // Exchange the states of neighbouring chains; the pairs alternate between
+    // rounds, so that a state can travel along the whole ladder.
+    for (size_t c = exchangeRound % 2; c + 1 < chains; c += 2)
+    {
+      Chain& hot = state[c];
+      Chain& cold = state[c + 1];
+      if (hot.done || cold.done)
+        continue;
+
+      const double exponent = (hot.energy - cold.energy) *
+          (1.0 / hot.temperature - 1.0 / cold.temperature);
+      if (exponent >= 0 || math::Random() < std::exp(exponent))
+      {
+        hot.iterate.swap(cold.iterate);
+        std::swap(hot.energy, cold.energy);
+        ++exchanges;
+      }
+    }
+  }
+
+  size_t best = 0;
+  for (size_t c = 0; c < chains; ++c)
+  {
+    const Chain& chain = state[c];
+    if (chain.frozenCount >= maxToleranceSweep * moveCtrlSweep *
+        iterate.n_elem)
+    {
+      Log::Debug << "SA: chain " << c << " minimized within tolerance "
+          << tolerance << " for " << maxToleranceSweep << " sweeps after "
+          << chain.iteration << " iterations." << std::endl;
+    }
+    else
+    {
+      Log::Debug << "SA: chain " << c << " reached maximum iterations ("
+          << maxIterations << ")." << std::endl;
+    }
+
+    if (chain.energy < state[best].energy)
+      best = c;
+  }
+
+  if (chains > 1)
+  {
+    Log::Debug << "SA: " << exchanges << " exchanges between " << chains
+        << " chains; best chain is " << best << "." << std::endl;
+  }
 
-  arma::mat accept(rows, cols);
-  accept.zeros();
+  // The hottest chain continues the schedule if Optimize() is called again.
+  temperature = state[0].temperature;
+  moveSize = state[0].moveSize;
 
-  // Initial moves to get rid of dependency of initial states.
-  for (size_t i = 0; i < initMoves; ++i)
-    GenerateMove(iterate, accept, energy, idx, sweepCounter);
+  iterate = std::move(state[best].iterate);
+
+  // The changes of the energy may have accumulated rounding errors.
+  if (HasEvaluateDelta<FunctionType>::value)
+    return function.Evaluate(iterate);
+
+  return state[best].energy;
+}
+
+template<
+    typename FunctionType,
+    typename CoolingScheduleType
+>
+void SA<FunctionType, CoolingScheduleType>::Anneal(Chain& chain,
+                                                   const size_t moves)
+{
+  const size_t frozenMoves = maxToleranceSweep * moveCtrlSweep *
+      chain.iterate.n_elem;
 
   // Iterating and cooling.
-  for (size_t i = 0; i != maxIterations; ++i)
+  for (size_t i = 0; i < moves && !chain.done; ++i)
   {
-    oldEnergy = energy;
-    GenerateMove(iterate, accept, energy, idx, sweepCounter);
-    temperature = coolingSchedule.NextTemperature(temperature, energy);
+    const double oldEnergy = chain.energy;
+    GenerateMove(chain);
+    chain.temperature = chain.schedule->NextTemperature(chain.temperature,
+        chain.energy);
+    ++chain.iteration;
 
     // Determine if the optimization has entered (or continues to be in) a
     // frozen state.
-    if (std::abs(energy - oldEnergy) < tolerance)
-      ++frozenCount;
+    if (std::abs(chain.energy - oldEnergy) < tolerance)
+      ++chain.frozenCount;
     else
-      frozenCount = 0;
+      chain.frozenCount = 0;
 
     // Terminate, if possible.
-    if (frozenCount >= maxToleranceSweep * moveCtrlSweep * iterate.n_elem)
-    {
-      Log::Debug << "SA: minimized within tolerance " << tolerance << " for "
-          << maxToleranceSweep << " sweeps after " << i << " iterations; "
-          << "terminating optimization." << std::endl;
-      return energy;
-    }
+    if (chain.frozenCount >= frozenMoves || chain.iteration == maxIterations)
+      chain.done = true;
   }
-
-  Log::Debug << "SA: maximum iterations (" << maxIterations << ") reached; "
-      << "terminating optimization." << std::endl;
-  return energy;
 }
 
 /**
@@ -118,14 +241,11 @@ template<
     typename FunctionType,
     typename CoolingScheduleType
 >
-void SA<FunctionType, CoolingScheduleType>::GenerateMove(
-    arma::mat& iterate,
-    arma::mat& accept,
-    double& energy,
-    size_t& idx,
-    size_t& sweepCounter)
+void SA<FunctionType, CoolingScheduleType>::GenerateMove(Chain& chain)
 {
-  const double prevEnergy = energy;
+  arma::mat& iterate = chain.iterate;
+  const size_t idx = chain.idx;
+  const double prevEnergy = chain.energy;
   const double prevValue = iterate(idx);
 
   // It is possible to use a non-Laplace distribution here, but it is difficult
@@ -133,41 +253,75 @@ void SA<FunctionType, CoolingScheduleType>::GenerateMove(
   // MoveControl() is derived for the Laplace distribution.
 
   // Sample from a Laplace distribution with scale parameter moveSize(idx).
-  const double unif = 2.0 * math::Random() - 1.0;
-  const double move = (unif < 0) ? (moveSize(idx) * std::log(1 + unif)) :
-      (-moveSize(idx) * std::log(1 - unif));
+  const double unif = 2.0 * chain.random.Random() - 1.0;
+  const double move = (unif < 0) ?
+      (chain.moveSize(idx) * std::log(1 + unif)) :
+      (-chain.moveSize(idx) * std::log(1 - unif));
+
+  Move(iterate, idx, prevValue + move, chain.energy,
+      std::integral_constant<bool, HasEvaluateDelta<FunctionType>::value>());
 
-  iterate(idx) += move;
-  energy = function.Evaluate(iterate);
   // According to the Metropolis criterion, accept the move with probability
   // min{1, exp(-(E_new - E_old) / T)}.
-  const double xi = math::Random();
-  const double delta = energy - prevEnergy;
-  const double criterion = std::exp(-delta / temperature);
+  const double xi = chain.random.Random();
+  const double delta = chain.energy - prevEnergy;
+  const double criterion = std::exp(-delta / chain.temperature);
   if (delta <= 0. || criterion > xi)
   {
-    accept(idx) += 1.;
+    chain.accept(idx) += 1.;
   }
   else // Reject the move; restore previous state.
   {
     iterate(idx) = prevValue;
-    energy = prevEnergy;
+    chain.energy = prevEnergy;
   }
 
-  ++idx;
-  if (idx == iterate.n_elem) // Finished with a sweep.
+  ++chain.idx;
+  if (chain.idx == iterate.n_elem) // Finished with a sweep.
   {
-    idx = 0;
-    ++sweepCounter;
+    chain.idx = 0;
+    ++chain.sweepCounter;
   }
 
-  if (sweepCounter == moveCtrlSweep) // Do MoveControl().
+  if (chain.sweepCounter == moveCtrlSweep) // Do MoveControl().
   {
-    MoveControl(moveCtrlSweep, accept);
-    sweepCounter = 0;
+    MoveControl(moveCtrlSweep, chain);
+    chain.sweepCounter = 0;
+
+    // Don't let the rounding errors of the changes of the energy build up.
+    if (HasEvaluateDelta<FunctionType>::value)
+      chain.energy = function.Evaluate(iterate);
   }
 }
 
+template<
+    typename FunctionType,
+    typename CoolingScheduleType
+>
+void SA<FunctionType, CoolingScheduleType>::Move(arma::mat& iterate,
+                                                 const size_t idx,
+                                                 const double value,
+                                                 double& energy,
+                                                 std::false_type /* delta */)
+{
+  iterate(idx) = value;
+  energy = function.Evaluate(iterate);
+}
+
+template<
+    typename FunctionType,
+    typename CoolingScheduleType
+>
+void SA<FunctionType, CoolingScheduleType>::Move(arma::mat& iterate,
+                                                 const size_t idx,
+                                                 const double value,
+                                                 double& energy,
+                                                 std::true_type /* delta */)
+{
+  energy += function.EvaluateDelta(iterate, idx, value);
+  iterate(idx) = value;
+}
+
 /**
  * MoveControl() uses a proportional feedback control to determine the size
  * parameter to pass to the move generation distribution. The target of such
@@ -187,21 +341,24 @@ template<
     typename CoolingScheduleType
 >
 void SA<FunctionType, CoolingScheduleType>::MoveControl(const size_t nMoves,
-                                                        arma::mat& accept)
+                                                        Chain& chain)
 {
   arma::mat target;
-  target.copy_size(accept);
+  target.copy_size(chain.accept);
   target.fill(0.44);
-  moveSize = arma::log(moveSize);
-  moveSize += gain * (accept / (double) nMoves - target);
-  moveSize = arma::exp(moveSize);
+  chain.moveSize = arma::log(chain.moveSize);
+  chain.moveSize += gain * (chain.accept / (double) nMoves - target);
+  chain.moveSize = arma::exp(chain.moveSize);
 
   // To avoid the use of element-wise arma::min(), which is only available in
   // Armadillo after v3.930, we use a for loop here instead.
-  for (size_t i = 0; i < accept.n_elem; ++i)
-    moveSize(i) = (moveSize(i) > maxMove(i)) ? maxMove(i) : moveSize(i);
+  for (size_t i = 0; i < chain.accept.n_elem; ++i)
+  {
+    chain.moveSize(i) = (chain.moveSize(i) > maxMove(i)) ? maxMove(i) :
+        chain.moveSize(i);
+  }
 
-  accept.zeros();
+  chain.accept.zeros();
 }
 
 } // namespace optimization
@@ -0,0 +1,251 @@
+/**
+ * @file saga.hpp
+ *
+ * SAGA, an incremental gradient method with a table of the past gradients of
+ * each function.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_OPTIMIZERS_SAGA_SAGA_HPP
+#define MLPACK_CORE_OPTIMIZERS_SAGA_SAGA_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/util/sfinae_utility.hpp>
+#include <mlpack/core/optimizers/sgd/update_policies/vanilla_update.hpp>
+
+namespace mlpack {
+namespace optimization {
+
+/**
+ * This gives us HasLinearGradientCheck, HasAddLinearGradientCheck and
+ * HasRegularizationGradientCheck objects that we can use to tell whether a
+ * function is a linear model whose gradient table SAGA can store compactly.
+ */
+HAS_MEM_FUNC(LinearGradient, HasLinearGradientCheck);
+HAS_MEM_FUNC(AddLinearGradient, HasAddLinearGradientCheck);
+HAS_MEM_FUNC(RegularizationGradient, HasRegularizationGradientCheck);
+
+/**
+ * Whether the given function is a linear model, that is, the gradient of each
+ * function is a scalar times a fixed vector (the features of its point) plus a
+ * term that doesn't depend on the point (the share of the regularization).
+ * Such a function implements
+ *
+ * @code
+ * double LinearGradient(const arma::mat& coordinates, const size_t i) const;
+ * void AddLinearGradient(const size_t i,
+ *                        const double scale,
+ *                        arma::mat& gradient) const;
+ * void RegularizationGradient(const arma::mat& coordinates,
+ *                             arma::mat& gradient) const;
+ * @endcode
+ *
+ * where LinearGradient() returns the scalar of function i, AddLinearGradient()
+ * adds the scaled features of function i to the gradient, and
+ * RegularizationGradient() stores the point-independent term, so that
+ * Gradient(coordinates, i, gradient) is
+ * RegularizationGradient(coordinates) +
+ * LinearGradient(coordinates, i) * features(i).
+ */
+template<typename FunctionType>
+struct HasLinearGradient
+{
+  static const bool value =
+      HasLinearGradientCheck<FunctionType, double(FunctionType::*)(
+          const arma::mat&, const size_t) const>::value &&
+      HasAddLinearGradientCheck<FunctionType, void(FunctionType::*)(
+          const size_t, const double, arma::mat&) const>::value &&
+      HasRegularizationGradientCheck<FunctionType, void(FunctionType::*)(
+          const arma::mat&, arma::mat&) const>::value;
+};
+
+/**
+ * SAGA minimizes a function which can be expressed as a sum of other
+ * functions,
+ *
+ * \f[
+ * f(A) = \sum_{i = 0}^{n} f_i(A),
+ * \f]
+ *
+ * like SGD, but keeps a table with the last gradient computed for each
+ * function, \f$ g_i \f$, and steps along the gradient of the chosen function
+ * corrected by the table:
+ *
+ * \f[
+ * A_{j + 1} = A_j - \alpha (\nabla f_i(A_j) - g_i +
+ *     \frac{1}{n} \sum_k g_k),
+ * \f]
+ *
+ * after which \f$ g_i \f$ is replaced by \f$ \nabla f_i(A_j) \f$.  Like SVRG it
+ * converges linearly on strongly convex objectives with a constant step size,
+ * but it never needs a full pass over the data to compute a mean gradient.
+ * The steps are taken with the update policy (by default
+ * mlpack::optimization::VanillaUpdate).
+ *
+ * For more information, please refer to:
+ *
+ * @code
+ * @inproceedings{Defazio2014,
+ *   title     = {SAGA: A Fast Incremental Gradient Method With Support for
+ *                Non-Strongly Convex Composite Objectives},
+ *   author    = {Aaron Defazio and Francis Bach and Simon Lacoste-Julien},
+ *   booktitle = {Advances in Neural Information Processing Systems 27
+ *                (NIPS 2014)},
+ *   year      = {2014}
+ * }
+ * @endcode
+ *
+ * For SAGA to work, a DecomposableFunctionType template parameter is required.
+ * This class must implement the same functions as for SGD:
+ *
+ *   size_t NumFunctions();
+ *   double Evaluate(const arma::mat& coordinates, const size_t i);
+ *   void Gradient(const arma::mat& coordinates,
+ *                 const size_t i,
+ *                 arma::mat& gradient);
+ *
+ * The table then holds one full gradient per function.  If the function is a
+ * linear model (see HasLinearGradient), as LogisticRegressionFunction is, the
+ * table holds only one scalar per function and the regularization term is
+ * computed at the current iterate, so the memory of the table is the same as
+ * that of the responses.
+ *
+ * @tparam DecomposableFunctionType Decomposable objective function type to be
+ *     minimized.
+ * @tparam UpdatePolicyType Update policy used to take each step.
+ */
+template<
+    typename DecomposableFunctionType,
+    typename UpdatePolicyType = VanillaUpdate
+>
+class SAGA
+{
+ public:
+  /**
+   * Construct the SAGA optimizer with the given function and parameters.  The
+   * defaults here are not necessarily good for the given problem, so it is
+   * suggested that the values used be tailored to the task at hand.  The
+   * maximum number of iterations refers to the maximum number of passes over
+   * the data.
+   *
+   * @param function Function to be optimized (minimized).
+   * @param stepSize Step size for each iteration.
+   * @param maxIterations Maximum number of passes over the data (0 means no
+   *     limit).
+   * @param tolerance Maximum absolute tolerance to terminate algorithm.
+   * @param shuffle If true, the function order is shuffled before each pass;
+   *     otherwise, each function is visited in linear order.
+   * @param updatePolicy Instantiated update policy used to take the steps.
+   */
+  SAGA(DecomposableFunctionType& function,
+       const double stepSize = 0.01,
+       const size_t maxIterations = 100,
+       const double tolerance = 1e-5,
+       const bool shuffle = true,
+       const UpdatePolicyType updatePolicy = UpdatePolicyType());
+
+  /**
+   * Optimize the given function using SAGA.  The given starting point will be
+   * modified to store the finishing point of the algorithm, and the final
+   * objective value is returned.
+   *
+   * @param function Function to optimize.
+   * @param iterate Starting point (will be modified).
+   * @return Objective value of the final point.
+   */
+  double Optimize(DecomposableFunctionType& function, arma::mat& iterate);
+
+  /**
+   * Optimize the given function using SAGA.  The given starting point will be
+   * modified to store the finishing point of the algorithm, and the final
+   * objective value is returned.
+   *
+   * @param iterate Starting point (will be modified).
+   * @return Objective value of the final point.
+   */
+  double Optimize(arma::mat& iterate)
+  {
+    return Optimize(this->function, iterate);
+  }
+
+  //! Get the instantiated function to be optimized.
+  const DecomposableFunctionType& Function() const { return function; }
+  //! Modify the instantiated function.
+  DecomposableFunctionType& Function() { return function; }
+
+  //! Get the step size.
+  double StepSize() const { return stepSize; }
+  //! Modify the step size.
+  double& StepSize() { return stepSize; }
+
+  //! Get the maximum number of passes (0 indicates no limit).
+  size_t MaxIterations() const { return maxIterations; }
+  //! Modify the maximum number of passes (0 indicates no limit).
+  size_t& MaxIterations() { return maxIterations; }
+
+  //! Get the tolerance for termination.
+  double Tolerance() const { return tolerance; }
+  //! Modify the tolerance for termination.
+  double& Tolerance() { return tolerance; }
+
+  //! Get whether or not the individual functions are shuffled.
+  bool Shuffle() const { return shuffle; }
+  //! Modify whether or not the individual functions are shuffled.
+  bool& Shuffle() { return shuffle; }
+
+  //! Get the update policy.
+  UpdatePolicyType UpdatePolicy() const { return updatePolicy; }
+  //! Modify the update policy.
+  UpdatePolicyType& UpdatePolicy() { return updatePolicy; }
+
+ private:
+  //! Optimize with a table of full gradients.
+  double Optimize(DecomposableFunctionType& function,
+                  arma::mat& iterate,
+                  std::false_type /* linear */);
+
+  //! Optimize with a table of one scalar per function.
+  double Optimize(DecomposableFunctionType& function,
+                  arma::mat& iterate,
+                  std::true_type /* linear */);
+
+  /**
+   * Run the passes over the data, calling the given step with the index of
+   * each function, until the objective converges or the maximum number of
+   * passes is reached, and return the final objective.
+   */
+  template<typename StepType>
+  double Iterate(DecomposableFunctionType& function,
+                 arma::mat& iterate,
+                 StepType step);
+
+  //! The instantiated function.
+  DecomposableFunctionType& function;
+
+  //! The step size for each example.
+  double stepSize;
+
+  //! The maximum number of passes over the data.
+  size_t maxIterations;
+
+  //! The tolerance for termination.
+  double tolerance;
+
+  //! Controls whether or not the individual functions are shuffled when
+  //! iterating.
+  bool shuffle;
+
+  //! The update policy used to take the steps.
+  UpdatePolicyType updatePolicy;
+};
+
+} // namespace optimization
+} // namespace mlpack
+
+// Include implementation.
+#include "saga_impl.hpp"
+
+#endif
@@ -0,0 +1,183 @@
+/**
+ * @file saga_impl.hpp
+ *
+ * Implementation of the SAGA incremental gradient method.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_OPTIMIZERS_SAGA_SAGA_IMPL_HPP
+#define MLPACK_CORE_OPTIMIZERS_SAGA_SAGA_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "saga.hpp"
+
+#include <mlpack/core/optimizers/sgd/batch_function.hpp>
+
+namespace mlpack {
+namespace optimization {
+
+template<typename DecomposableFunctionType, typename UpdatePolicyType>
+SAGA<DecomposableFunctionType, UpdatePolicyType>::SAGA(
+    DecomposableFunctionType& function,
+    const double stepSize,
+    const size_t maxIterations,
+    const double tolerance,
+    const bool shuffle,
+    const UpdatePolicyType updatePolicy) :
+    function(function),
+    stepSize(stepSize),
+    maxIterations(maxIterations),
+    tolerance(tolerance),
+    shuffle(shuffle),
+    updatePolicy(updatePolicy)
+{ /* Nothing to do. */ }
+
+//! Optimize the function (minimize).
+template<typename DecomposableFunctionType, typename UpdatePolicyType>
+double SAGA<DecomposableFunctionType, UpdatePolicyType>::Optimize(
+    DecomposableFunctionType& function,
+    arma::mat& iterate)
+{
+  return Optimize(function, iterate, std::integral_constant<bool,
+      HasLinearGradient<DecomposableFunctionType>::value>());
+}
+
+//! Optimize the function with a table of full gradients.
+template<typename DecomposableFunctionType, typename UpdatePolicyType>
+double SAGA<DecomposableFunctionType, UpdatePolicyType>::Optimize(
+    DecomposableFunctionType& function,
+    arma::mat& iterate,
+    std::false_type /* linear */)
+{
+  const size_t numFunctions = function.NumFunctions();
+
+  // Column i of the table holds the last gradient of function i, and the mean
+  // of the table is kept up to date as the columns are replaced.
+  arma::mat table(iterate.n_elem, numFunctions);
+  arma::mat gradient, meanGradient, direction;
+  meanGradient.zeros(iterate.n_rows, iterate.n_cols);
+  for (size_t i = 0; i < numFunctions; ++i)
+  {
+    function.Gradient(iterate, i, gradient);
+    table.col(i) = arma::vectorise(gradient);
+    meanGradient += gradient;
+  }
+  meanGradient /= numFunctions;
+
+  return Iterate(function, iterate, [&](const size_t f)
+  {
+    // An alias of the column of the table, with the shape of the iterate.
+    arma::mat oldGradient(table.colptr(f), iterate.n_rows, iterate.n_cols,
+        false, true);
+
+    function.Gradient(iterate, f, gradient);
+    gradient -= oldGradient;
+
+    // The step uses the mean of the table before the update.
+    direction = gradient + meanGradient;
+    updatePolicy.Update(iterate, stepSize, direction);
+
+    meanGradient += gradient / numFunctions;
+    oldGradient += gradient;
+  });
+}
+
+//! Optimize the function with a table of one scalar per function.
+template<typename DecomposableFunctionType, typename UpdatePolicyType>
+double SAGA<DecomposableFunctionType, UpdatePolicyType>::Optimize(
+    DecomposableFunctionType& function,
+    arma::mat& iterate,
+    std::true_type /* linear */)
+{
+  const size_t numFunctions = function.NumFunctions();
+
+  // The table holds the last scalar of each function; the mean of the data
+  // terms of the gradients is kept up to date as the scalars are replaced, and
+  // the regularization term is always taken at the current iterate.
+  arma::vec table(numFunctions);
+  arma::mat meanGradient, direction;
+  meanGradient.zeros(iterate.n_rows, iterate.n_cols);
+  for (size_t i = 0; i < numFunctions; ++i)
+  {
+    table[i] = function.LinearGradient(iterate, i);
+    function.AddLinearGradient(i, table[i] / numFunctions, meanGradient);
+  }
+
+  return Iterate(function, iterate, [&](const size_t f)
+  {
+    const double scale = function.LinearGradient(iterate, f);
+    const double delta = scale - table[f];
+
+    // The step uses the mean of the table before the update.
+    function.RegularizationGradient(iterate, direction);
+    direction += meanGradient;
+    function.AddLinearGradient(f, delta, direction);
+    updatePolicy.Update(iterate, stepSize, direction);
+
+    function.AddLinearGradient(f, delta / numFunctions, meanGradient);
+    table[f] = scale;
+  });
+}
+
+template<typename DecomposableFunctionType, typename UpdatePolicyType>
+template<typename StepType>
+double SAGA<DecomposableFunctionType, UpdatePolicyType>::Iterate(
+    DecomposableFunctionType& function,
+    arma::mat& iterate,
+    StepType step)
+{
+  const size_t numFunctions = function.NumFunctions();
+  arma::Col<size_t> visitationOrder = arma::linspace<arma::Col<size_t>>(0,
+      (numFunctions - 1), numFunctions);
+
+  // Calculate the first objective function.
+  double overallObjective = FullEvaluate(function, iterate);
+  double lastObjective = DBL_MAX;
+
+  // Initialize the update policy.
+  updatePolicy.Initialize(iterate.n_rows, iterate.n_cols);
+
+  for (size_t i = 1; maxIterations == 0 || i <= maxIterations; ++i)
+  {
+    // Output current objective function.
+    Log::Info << "SAGA: iteration " << i << ", objective " << overallObjective
+        << "." << std::endl;
+
+    if (std::isnan(overallObjective) || std::isinf(overallObjective))
+    {
+      Log::Warn << "SAGA: converged to " << overallObjective << "; "
+          << "terminating with failure.  Try a smaller step size?"
+          << std::endl;
+      return overallObjective;
+    }
+
+    if (std::abs(lastObjective - overallObjective) < tolerance)
+    {
+      Log::Info << "SAGA: minimized within tolerance " << tolerance << "; "
+          << "terminating optimization." << std::endl;
+      return overallObjective;
+    }
+
+    if (shuffle) // Determine order of visitation.
+      visitationOrder = arma::shuffle(visitationOrder);
+
+    for (size_t j = 0; j < numFunctions; ++j)
+      step(visitationOrder[j]);
+
+    lastObjective = overallObjective;
+    overallObjective = FullEvaluate(function, iterate);
+  }
+
+  Log::Info << "SAGA: maximum iterations (" << maxIterations << ") reached; "
+      << "terminating optimization." << std::endl;
+
+  return overallObjective;
+}
+
+} // namespace optimization
+} // namespace mlpack
+
+#endif
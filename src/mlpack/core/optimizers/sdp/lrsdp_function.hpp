@@ -21,7 +21,13 @@ namespace mlpack {
 namespace optimization {
 
 /**
- * The objective function that LRSDP is trying to optimize.
+ * The objective function that LRSDP is trying to optimize.  The point is the
+ * factor R of the solution R R^T, and R R^T itself (an n x n matrix) is never
+ * formed: Tr(A (R R^T)) is computed from the nonzeros of a sparse A as
+ * sum_{(j, k)} A(j, k) <r_j, r_k> (where r_j is row j of R), which takes
+ * O(nnz(A) r) time for rank r, and from (A R) % R for a dense A.  The values
+ * of the constraints, and their terms of the gradient of the augmented
+ * Lagrangian, are computed in parallel over the constraints with OpenMP.
  */
 template <typename SDPType>
 class LRSDPFunction
@@ -68,6 +74,14 @@ class LRSDPFunction
    */
   double EvaluateConstraint(const size_t index,
                             const arma::mat& coordinates) const;
+
+  /**
+   * Evaluate all the constraints of the LRSDP at the given coordinates, in
+   * parallel.  constraints[i] is set to EvaluateConstraint(i, coordinates).
+   */
+  void EvaluateConstraints(const arma::mat& coordinates,
+                           arma::vec& constraints) const;
+
   /**
    * Evaluate the gradient of a particular constraint of the LRSDP at the given
    * coordinates.
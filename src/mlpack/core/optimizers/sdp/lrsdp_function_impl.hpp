@@ -44,11 +44,105 @@ LRSDPFunction<SDPType>::LRSDPFunction(const size_t numSparseConstraints,
         << "transposed solution." << std::endl;
 }
 
+//! Compute Tr(A (R R^T)) for a sparse A without forming R R^T: each nonzero
+//! A(j, k) adds A(j, k) <r_j, r_k>, where r_j (the row j of R) is the column j
+//! of rt = R^T.
+static inline double Trace(const arma::sp_mat& a,
+                           const arma::mat& /* coordinates */,
+                           const arma::mat& rt)
+{
+  double trace = 0;
+  for (arma::sp_mat::const_iterator it = a.begin(); it != a.end(); ++it)
+    trace += (*it) * arma::dot(rt.col(it.row()), rt.col(it.col()));
+  return trace;
+}
+
+//! Compute Tr(A (R R^T)) for a dense A as the sum of the elements of
+//! (A R) % R, without forming R R^T.
+static inline double Trace(const arma::mat& a,
+                           const arma::mat& coordinates,
+                           const arma::mat& /* rt */)
+{
+  return arma::accu((a * coordinates) % coordinates);
+}
+
+//! Add scale * (A R)^T to gt for a sparse A: each nonzero A(j, k) adds
+//! A(j, k) r_k to the column j.
+static inline void AddProduct(arma::mat& gt,
+                              const double scale,
+                              const arma::sp_mat& a,
+                              const arma::mat& /* coordinates */,
+                              const arma::mat& rt)
+{
+  for (arma::sp_mat::const_iterator it = a.begin(); it != a.end(); ++it)
+    gt.col(it.row()) += (scale * (*it)) * rt.col(it.col());
+}
+
+//! Add scale * (A R)^T to gt for a dense A.
+static inline void AddProduct(arma::mat& gt,
+                              const double scale,
+                              const arma::mat& a,
+                              const arma::mat& coordinates,
+                              const arma::mat& /* rt */)
+{
+  gt += scale * trans(a * coordinates);
+}
+
+//! Get the number of threads to split the constraints of an SDP over.
+static inline size_t ConstraintThreads(const size_t numConstraints)
+{
+#ifdef HAS_OPENMP
+  return std::max((size_t) 1,
+      std::min((size_t) omp_get_max_threads(), numConstraints));
+#else
+  (void) numConstraints;
+  return 1;
+#endif
+}
+
+//! Compute the value Tr(A_i (R R^T)) - b_i of every constraint of the SDP, in
+//! parallel over the constraints.
+template <typename SDPType>
+static inline void
+ConstraintValues(const SDPType& sdp,
+                 const arma::mat& coordinates,
+                 const arma::mat& rt,
+                 arma::vec& values)
+{
+  const size_t numSparse = sdp.NumSparseConstraints();
+  const size_t numConstraints = sdp.NumConstraints();
+  values.set_size(numConstraints);
+
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables. If we're building for Visual Studio, use
+  // the intmax_t type instead.
+  #pragma omp parallel for schedule(guided) \
+      num_threads(ConstraintThreads(numConstraints))
+  for (intmax_t i = 0; i < (intmax_t) numConstraints; ++i)
+#else
+  #pragma omp parallel for schedule(guided) \
+      num_threads(ConstraintThreads(numConstraints))
+  for (size_t i = 0; i < numConstraints; ++i)
+#endif
+  {
+    if ((size_t) i < numSparse)
+    {
+      values[i] = Trace(sdp.SparseA()[i], coordinates, rt) - sdp.SparseB()[i];
+    }
+    else
+    {
+      values[i] = Trace(sdp.DenseA()[i - numSparse], coordinates, rt) -
+          sdp.DenseB()[i - numSparse];
+    }
+  }
+}
+
 template <typename SDPType>
 double LRSDPFunction<SDPType>::Evaluate(const arma::mat& coordinates) const
 {
-  const arma::mat rrt = coordinates * trans(coordinates);
-  return accu(SDP().C() % rrt);
+  const arma::mat rt = trans(coordinates);
+  return Trace(SDP().C(), coordinates, rt);
 }
 
 template <typename SDPType>
@@ -64,11 +158,24 @@ double LRSDPFunction<SDPType>::EvaluateConstraint(
     const size_t index,
     const arma::mat& coordinates) const
 {
-  const arma::mat rrt = coordinates * trans(coordinates);
+  const arma::mat rt = trans(coordinates);
   if (index < SDP().NumSparseConstraints())
-    return accu(SDP().SparseA()[index] % rrt) - SDP().SparseB()[index];
+  {
+    return Trace(SDP().SparseA()[index], coordinates, rt) -
+        SDP().SparseB()[index];
+  }
   const size_t index1 = index - SDP().NumSparseConstraints();
-  return accu(SDP().DenseA()[index1] % rrt) - SDP().DenseB()[index1];
+  return Trace(SDP().DenseA()[index1], coordinates, rt) -
+      SDP().DenseB()[index1];
+}
+
+template <typename SDPType>
+void LRSDPFunction<SDPType>::EvaluateConstraints(
+    const arma::mat& coordinates,
+    arma::vec& constraints) const
+{
+  const arma::mat rt = trans(coordinates);
+  ConstraintValues(SDP(), coordinates, rt, constraints);
 }
 
 template <typename SDPType>
@@ -81,47 +188,6 @@ void LRSDPFunction<SDPType>::GradientConstraint(
       << "for arbitrary optimizers!" << std::endl;
 }
 
-//! Utility function for calculating part of the objective when AugLagrangian is
-//! used with an LRSDPFunction.
-template <typename MatrixType>
-static inline void
-UpdateObjective(double& objective,
-                const arma::mat& rrt,
-                const std::vector<MatrixType>& ais,
-                const arma::vec& bis,
-                const arma::vec& lambda,
-                const size_t lambdaOffset,
-                const double sigma)
-{
-  for (size_t i = 0; i < ais.size(); ++i)
-  {
-    // Take the trace subtracted by the b_i.
-    const double constraint = accu(ais[i] % rrt) - bis[i];
-    objective -= (lambda[lambdaOffset + i] * constraint);
-    objective += (sigma / 2.) * constraint * constraint;
-  }
-}
-
-//! Utility function for calculating part of the gradient when AugLagrangian is
-//! used with an LRSDPFunction.
-template <typename MatrixType>
-static inline void
-UpdateGradient(arma::mat& s,
-               const arma::mat& rrt,
-               const std::vector<MatrixType>& ais,
-               const arma::vec& bis,
-               const arma::vec& lambda,
-               const size_t lambdaOffset,
-               const double sigma)
-{
-  for (size_t i = 0; i < ais.size(); ++i)
-  {
-    const double constraint = accu(ais[i] % rrt) - bis[i];
-    const double y = lambda[lambdaOffset + i] - sigma * constraint;
-    s -= y * ais[i];
-  }
-}
-
 template <typename SDPType>
 static inline double
 EvaluateImpl(const LRSDPFunction<SDPType>& function,
@@ -133,24 +199,21 @@ EvaluateImpl(const LRSDPFunction<SDPType>& function,
   // L(R, y, s) = Tr(C * (R R^T)) -
   //     sum_{i = 1}^{m} (y_i (Tr(A_i * (R R^T)) - b_i)) +
   //     (sigma / 2) * sum_{i = 1}^{m} (Tr(A_i * (R R^T)) - b_i)^2
-
-  // Let's start with the objective: Tr(C * (R R^T)).
-  // Simple, possibly slow solution-- see below for optimization opportunity
-  //
-  // TODO: Note that Tr(C^T * (R R^T)) = Tr( (CR)^T * R ), so
-  // multiplying C*R first, and then taking the trace dot should be more memory
-  // efficient
   //
-  // Similarly for the constraints, taking A*R first should be more efficient
-  const arma::mat rrt = coordinates * trans(coordinates);
-  double objective = accu(function.SDP().C() % rrt);
+  // R R^T is never formed: the traces are taken directly from the nonzeros of
+  // the sparse matrices and the rows of R, and from (A R) % R for the dense
+  // matrices.
+  const arma::mat rt = trans(coordinates);
+  double objective = Trace(function.SDP().C(), coordinates, rt);
 
   // Now each constraint.
-  UpdateObjective(objective, rrt, function.SDP().SparseA(),
-      function.SDP().SparseB(), lambda, 0, sigma);
-  UpdateObjective(objective, rrt, function.SDP().DenseA(),
-      function.SDP().DenseB(), lambda, function.SDP().NumSparseConstraints(),
-      sigma);
+  arma::vec constraints;
+  ConstraintValues(function.SDP(), coordinates, rt, constraints);
+  for (size_t i = 0; i < constraints.n_elem; ++i)
+  {
+    objective -= (lambda[i] * constraints[i]);
+    objective += (sigma / 2.) * constraints[i] * constraints[i];
+  }
 
   return objective;
 }
@@ -168,17 +231,56 @@ GradientImpl(const LRSDPFunction<SDPType>& function,
   //   with
   // S' = C - sum_{i = 1}^{m} y'_i A_i
   // y'_i = y_i - sigma * (Trace(A_i * (R R^T)) - b_i)
-  const arma::mat rrt = coordinates * trans(coordinates);
-  arma::mat s(function.SDP().C());
+  //
+  // S' is never formed either: (S' R)^T is accumulated from the products
+  // (A_i R)^T, which for a sparse A_i only touch the rows of its nonzeros.
+  const SDPType& sdp = function.SDP();
+  const arma::mat rt = trans(coordinates);
+
+  arma::vec constraints;
+  ConstraintValues(sdp, coordinates, rt, constraints);
+
+  const size_t numSparse = sdp.NumSparseConstraints();
+  const size_t numConstraints = sdp.NumConstraints();
+  const size_t numThreads = ConstraintThreads(numConstraints);
+
+  // Each thread accumulates the products of its constraints.
+  std::vector<arma::mat> partials(numThreads);
+  #pragma omp parallel num_threads(numThreads)
+  {
+#ifdef HAS_OPENMP
+    const size_t thread = omp_get_thread_num();
+#else
+    const size_t thread = 0;
+#endif
+    arma::mat& partial = partials[thread];
+    partial.zeros(rt.n_rows, rt.n_cols);
+
+#ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables. If we're building for Visual Studio,
+    // use the intmax_t type instead.
+    #pragma omp for schedule(guided)
+    for (intmax_t i = 0; i < (intmax_t) numConstraints; ++i)
+#else
+    #pragma omp for schedule(guided)
+    for (size_t i = 0; i < numConstraints; ++i)
+#endif
+    {
+      const double y = lambda[i] - sigma * constraints[i];
+      if ((size_t) i < numSparse)
+        AddProduct(partial, -y, sdp.SparseA()[i], coordinates, rt);
+      else
+        AddProduct(partial, -y, sdp.DenseA()[i - numSparse], coordinates, rt);
+    }
+  }
 
-  UpdateGradient(
-      s, rrt, function.SDP().SparseA(), function.SDP().SparseB(),
-      lambda, 0, sigma);
-  UpdateGradient(
-      s, rrt, function.SDP().DenseA(), function.SDP().DenseB(),
-      lambda, function.SDP().NumSparseConstraints(), sigma);
+  arma::mat gt(rt.n_rows, rt.n_cols, arma::fill::zeros);
+  AddProduct(gt, 1.0, sdp.C(), coordinates, rt);
+  for (size_t t = 0; t < numThreads; ++t)
+    gt += partials[t];
 
-  gradient = 2 * s * coordinates;
+  gradient = 2 * trans(gt);
 }
 
 // Template specializations for function and gradient evaluation.
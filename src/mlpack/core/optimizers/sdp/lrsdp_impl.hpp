@@ -26,6 +26,13 @@ LRSDP<SDPType>::LRSDP(const size_t numSparseConstraints,
     augLag(function)
 { }
 
+template <typename SDPType>
+LRSDP<SDPType>::LRSDP(const SDPType& sdp,
+                      const arma::mat& initialPoint) :
+    function(sdp, initialPoint),
+    augLag(function)
+{ }
+
 template <typename SDPType>
 double LRSDP<SDPType>::Optimize(arma::mat& coordinates)
 {
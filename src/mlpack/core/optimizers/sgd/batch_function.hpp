@@ -0,0 +1,428 @@
+/**
+ * @file batch_function.hpp
+ *
+ * Helpers for the SGD-family optimizers, which use the batch Evaluate() and
+ * Gradient() of a separable function when it has them, and otherwise sum over
+ * the points of the batch one at a time, and for the full-batch optimizers,
+ * which can reduce a const batch Evaluate() and Gradient() over threads.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_OPTIMIZERS_SGD_BATCH_FUNCTION_HPP
+#define MLPACK_CORE_OPTIMIZERS_SGD_BATCH_FUNCTION_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/util/sfinae_utility.hpp>
+
+namespace mlpack {
+namespace optimization {
+
+/**
+ * This gives us HasBatchEvaluateCheck and HasBatchGradientCheck objects that we
+ * can use to tell whether or not a function can evaluate its objective and
+ * gradient on a whole batch of points at once.
+ */
+HAS_MEM_FUNC(Evaluate, HasBatchEvaluateCheck);
+HAS_MEM_FUNC(Gradient, HasBatchGradientCheck);
+HAS_MEM_FUNC(EvaluateWithGradient, HasBatchEvaluateWithGradientCheck);
+
+/**
+ * Whether the given function has a batch Evaluate() of the form
+ *
+ * @code
+ * double Evaluate(const arma::mat& coordinates,
+ *                 const size_t begin,
+ *                 const size_t batchSize);
+ * @endcode
+ *
+ * (const or not), which returns the sum of the objectives of the points
+ * [begin, begin + batchSize).
+ */
+template<typename FunctionType>
+struct HasBatchEvaluate
+{
+  static const bool value =
+      HasBatchEvaluateCheck<FunctionType, double(FunctionType::*)(
+          const arma::mat&, const size_t, const size_t)>::value ||
+      HasBatchEvaluateCheck<FunctionType, double(FunctionType::*)(
+          const arma::mat&, const size_t, const size_t) const>::value;
+};
+
+/**
+ * Whether the given function has a batch Gradient() of the form
+ *
+ * @code
+ * void Gradient(const arma::mat& coordinates,
+ *               const size_t begin,
+ *               arma::mat& gradient,
+ *               const size_t batchSize);
+ * @endcode
+ *
+ * (const or not), which stores the sum of the gradients of the points
+ * [begin, begin + batchSize).
+ */
+template<typename FunctionType>
+struct HasBatchGradient
+{
+  static const bool value =
+      HasBatchGradientCheck<FunctionType, void(FunctionType::*)(
+          const arma::mat&, const size_t, arma::mat&, const size_t)>::value ||
+      HasBatchGradientCheck<FunctionType, void(FunctionType::*)(
+          const arma::mat&, const size_t, arma::mat&, const size_t)
+          const>::value;
+};
+
+/**
+ * Whether the given function has a batch EvaluateWithGradient() of the form
+ *
+ * @code
+ * double EvaluateWithGradient(const arma::mat& coordinates,
+ *                             const size_t begin,
+ *                             arma::mat& gradient,
+ *                             const size_t batchSize);
+ * @endcode
+ *
+ * (const or not), which stores the sum of the gradients of the points
+ * [begin, begin + batchSize) and returns the sum of their objectives, sharing
+ * the work the two have in common (the predictions of the model).
+ */
+template<typename FunctionType>
+struct HasBatchEvaluateWithGradient
+{
+  static const bool value =
+      HasBatchEvaluateWithGradientCheck<FunctionType, double(FunctionType::*)(
+          const arma::mat&, const size_t, arma::mat&, const size_t)>::value ||
+      HasBatchEvaluateWithGradientCheck<FunctionType, double(FunctionType::*)(
+          const arma::mat&, const size_t, arma::mat&, const size_t)
+          const>::value;
+};
+
+/**
+ * Whether the given function has a sparse Gradient() of the form
+ *
+ * @code
+ * void Gradient(const arma::mat& coordinates,
+ *               const size_t i,
+ *               arma::sp_mat& gradient) const;
+ * @endcode
+ *
+ * which stores the gradient of the single function i.  Only the const form is
+ * detected, since the optimizers that use it call it from several threads.
+ */
+template<typename FunctionType>
+struct HasSparseGradient
+{
+  static const bool value = HasBatchGradientCheck<FunctionType,
+      void(FunctionType::*)(const arma::mat&, const size_t, arma::sp_mat&)
+      const>::value;
+};
+
+//! Evaluate the objective of the batch with the function's batch Evaluate().
+template<typename DecomposableFunctionType>
+double MiniBatchEvaluate(
+    DecomposableFunctionType& function,
+    const arma::mat& iterate,
+    const size_t begin,
+    const size_t batchSize,
+    const typename std::enable_if_t<HasBatchEvaluate<
+        DecomposableFunctionType>::value>* = 0)
+{
+  return function.Evaluate(iterate, begin, batchSize);
+}
+
+//! Evaluate the objective of the batch one point at a time.
+template<typename DecomposableFunctionType>
+double MiniBatchEvaluate(
+    DecomposableFunctionType& function,
+    const arma::mat& iterate,
+    const size_t begin,
+    const size_t batchSize,
+    const typename std::enable_if_t<!HasBatchEvaluate<
+        DecomposableFunctionType>::value>* = 0)
+{
+  double objective = 0;
+  for (size_t j = begin; j < begin + batchSize; ++j)
+    objective += function.Evaluate(iterate, j);
+
+  return objective;
+}
+
+//! Compute the gradient of the batch with the function's batch Gradient().
+template<typename DecomposableFunctionType>
+void MiniBatchGradient(
+    DecomposableFunctionType& function,
+    const arma::mat& iterate,
+    const size_t begin,
+    const size_t batchSize,
+    arma::mat& gradient,
+    const typename std::enable_if_t<HasBatchGradient<
+        DecomposableFunctionType>::value>* = 0)
+{
+  function.Gradient(iterate, begin, gradient, batchSize);
+}
+
+//! Compute the gradient of the batch as the sum of the gradients of the points.
+template<typename DecomposableFunctionType>
+void MiniBatchGradient(
+    DecomposableFunctionType& function,
+    const arma::mat& iterate,
+    const size_t begin,
+    const size_t batchSize,
+    arma::mat& gradient,
+    const typename std::enable_if_t<!HasBatchGradient<
+        DecomposableFunctionType>::value>* = 0)
+{
+  function.Gradient(iterate, begin, gradient);
+
+  arma::mat funcGradient;
+  for (size_t j = begin + 1; j < begin + batchSize; ++j)
+  {
+    function.Gradient(iterate, j, funcGradient);
+    gradient += funcGradient;
+  }
+}
+
+//! Compute the gradient and the objective of the batch with the function's
+//! batch EvaluateWithGradient().
+template<typename DecomposableFunctionType>
+double MiniBatchEvaluateWithGradient(
+    DecomposableFunctionType& function,
+    const arma::mat& iterate,
+    const size_t begin,
+    const size_t batchSize,
+    arma::mat& gradient,
+    const typename std::enable_if_t<HasBatchEvaluateWithGradient<
+        DecomposableFunctionType>::value>* = 0)
+{
+  return function.EvaluateWithGradient(iterate, begin, gradient, batchSize);
+}
+
+//! Compute the gradient and then the objective of the batch.
+template<typename DecomposableFunctionType>
+double MiniBatchEvaluateWithGradient(
+    DecomposableFunctionType& function,
+    const arma::mat& iterate,
+    const size_t begin,
+    const size_t batchSize,
+    arma::mat& gradient,
+    const typename std::enable_if_t<!HasBatchEvaluateWithGradient<
+        DecomposableFunctionType>::value>* = 0)
+{
+  MiniBatchGradient(function, iterate, begin, batchSize, gradient);
+  return MiniBatchEvaluate(function, iterate, begin, batchSize);
+}
+
+/**
+ * Evaluate the objective of all the points of the function, in batches of the
+ * given size, so that a batch Evaluate() doesn't have to hold the
+ * intermediate results of the whole dataset at once.
+ *
+ * @param function Function to evaluate.
+ * @param iterate Point to evaluate the function at.
+ * @param batchSize Number of points of each batch.
+ */
+template<typename DecomposableFunctionType>
+double FullEvaluate(DecomposableFunctionType& function,
+                    const arma::mat& iterate,
+                    const size_t batchSize = 256)
+{
+  const size_t numFunctions = function.NumFunctions();
+
+  double objective = 0;
+  for (size_t i = 0; i < numFunctions; i += batchSize)
+  {
+    objective += MiniBatchEvaluate(function, iterate, i,
+        std::min(batchSize, numFunctions - i));
+  }
+
+  return objective;
+}
+
+/**
+ * Compute the sum of the gradients of all the points of the function, in
+ * batches of the given size (see FullEvaluate()).
+ *
+ * @param function Function to differentiate.
+ * @param iterate Point to compute the gradient at.
+ * @param gradient Matrix to store the gradient in.
+ * @param batchSize Number of points of each batch.
+ */
+template<typename DecomposableFunctionType>
+void FullGradient(DecomposableFunctionType& function,
+                  const arma::mat& iterate,
+                  arma::mat& gradient,
+                  const size_t batchSize = 256)
+{
+  const size_t numFunctions = function.NumFunctions();
+
+  gradient.zeros(iterate.n_rows, iterate.n_cols);
+  arma::mat batchGradient;
+  for (size_t i = 0; i < numFunctions; i += batchSize)
+  {
+    MiniBatchGradient(function, iterate, i, std::min(batchSize,
+        numFunctions - i), batchGradient);
+    gradient += batchGradient;
+  }
+}
+
+/**
+ * Whether the given function has a const batch Evaluate() (see
+ * HasBatchEvaluate), which can then be called from several threads at once.
+ */
+template<typename FunctionType>
+struct HasConstBatchEvaluate
+{
+  static const bool value = HasBatchEvaluateCheck<FunctionType,
+      double(FunctionType::*)(const arma::mat&, const size_t, const size_t)
+      const>::value;
+};
+
+/**
+ * Whether the given function has a const batch Gradient() (see
+ * HasBatchGradient), which can then be called from several threads at once.
+ */
+template<typename FunctionType>
+struct HasConstBatchGradient
+{
+  static const bool value = HasBatchGradientCheck<FunctionType,
+      void(FunctionType::*)(const arma::mat&, const size_t, arma::mat&,
+      const size_t) const>::value;
+};
+
+//! Get the number of threads to split the points of a function over.
+inline size_t ParallelBlocks(const size_t numFunctions)
+{
+#ifdef HAS_OPENMP
+  return std::min((size_t) omp_get_max_threads(), numFunctions);
+#else
+  (void) numFunctions;
+  return 1;
+#endif
+}
+
+/**
+ * Evaluate the objective of all the points of a separable function with its
+ * const batch Evaluate(), split into one contiguous block of points per
+ * thread, and sum the results.  The objective of the function must be the sum
+ * of the objectives of its batches (as it is for LogisticRegressionFunction and
+ * SoftmaxRegressionFunction, whose batches take their share of the
+ * regularization).  With one thread, the full Evaluate() is called.
+ *
+ * @param function Function to evaluate.
+ * @param iterate Point to evaluate the function at.
+ */
+template<typename FunctionType>
+double ParallelEvaluate(
+    FunctionType& function,
+    const arma::mat& iterate,
+    const typename std::enable_if_t<HasConstBatchEvaluate<
+        FunctionType>::value>* = 0)
+{
+  const size_t numFunctions = function.NumFunctions();
+  const size_t numBlocks = ParallelBlocks(numFunctions);
+  if (numBlocks <= 1)
+    return function.Evaluate(iterate);
+
+  const FunctionType& constFunction = function;
+  double objective = 0;
+
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables. If we're building for Visual Studio, use
+  // the intmax_t type instead.
+  #pragma omp parallel for reduction(+:objective) num_threads(numBlocks)
+  for (intmax_t b = 0; b < (intmax_t) numBlocks; ++b)
+#else
+  #pragma omp parallel for reduction(+:objective) num_threads(numBlocks)
+  for (size_t b = 0; b < numBlocks; ++b)
+#endif
+  {
+    const size_t begin = b * numFunctions / numBlocks;
+    const size_t end = (b + 1) * numFunctions / numBlocks;
+    objective += constFunction.Evaluate(iterate, begin, end - begin);
+  }
+
+  return objective;
+}
+
+//! Evaluate the objective of a function without a const batch Evaluate().
+template<typename FunctionType>
+double ParallelEvaluate(
+    FunctionType& function,
+    const arma::mat& iterate,
+    const typename std::enable_if_t<!HasConstBatchEvaluate<
+        FunctionType>::value>* = 0)
+{
+  return function.Evaluate(iterate);
+}
+
+/**
+ * Compute the gradient of all the points of a separable function with its
+ * const batch Gradient(), split into one contiguous block of points per
+ * thread, and sum the results; see ParallelEvaluate().
+ *
+ * @param function Function to differentiate.
+ * @param iterate Point to compute the gradient at.
+ * @param gradient Matrix to store the gradient in.
+ * @param blockGradients Storage for the gradients of the blocks, kept by the
+ *     caller between calls so that they are only allocated once.
+ */
+template<typename FunctionType>
+void ParallelGradient(
+    FunctionType& function,
+    const arma::mat& iterate,
+    arma::mat& gradient,
+    std::vector<arma::mat>& blockGradients,
+    const typename std::enable_if_t<HasConstBatchGradient<
+        FunctionType>::value>* = 0)
+{
+  const size_t numFunctions = function.NumFunctions();
+  const size_t numBlocks = ParallelBlocks(numFunctions);
+  if (numBlocks <= 1)
+  {
+    function.Gradient(iterate, gradient);
+    return;
+  }
+
+  // The first block is computed straight into the gradient.
+  blockGradients.resize(numBlocks - 1);
+  const FunctionType& constFunction = function;
+
+#ifdef _WIN32
+  #pragma omp parallel for num_threads(numBlocks)
+  for (intmax_t b = 0; b < (intmax_t) numBlocks; ++b)
+#else
+  #pragma omp parallel for num_threads(numBlocks)
+  for (size_t b = 0; b < numBlocks; ++b)
+#endif
+  {
+    const size_t begin = b * numFunctions / numBlocks;
+    const size_t end = (b + 1) * numFunctions / numBlocks;
+    constFunction.Gradient(iterate, begin, (b == 0) ? gradient :
+        blockGradients[b - 1], end - begin);
+  }
+
+  for (size_t b = 0; b < numBlocks - 1; ++b)
+    gradient += blockGradients[b];
+}
+
+//! Compute the gradient of a function without a const batch Gradient().
+template<typename FunctionType>
+void ParallelGradient(
+    FunctionType& function,
+    const arma::mat& iterate,
+    arma::mat& gradient,
+    std::vector<arma::mat>& /* blockGradients */,
+    const typename std::enable_if_t<!HasConstBatchGradient<
+        FunctionType>::value>* = 0)
+{
+  function.Gradient(iterate, gradient);
+}
+
+} // namespace optimization
+} // namespace mlpack
+
+#endif
@@ -68,15 +68,30 @@ namespace optimization {
  * objective function on the first point in the dataset (presumably, the dataset
  * is held internally in the DecomposableFunctionType).
  *
+ * If the class also implements the batch Evaluate() described in
+ * MiniBatchSGD, the objective of the whole dataset (at the start and at the end
+ * of the optimization) is computed with it, a batch of points at a time, rather
+ * than one point at a time.  The optimizers built on SGD (Adam, RMSProp,
+ * AdaDelta, AdaGrad, SMORMS3) do the same.
+ *
+ * With a sparse GradType (arma::sp_mat), the gradient parameter of Gradient()
+ * is an arma::sp_mat, which holds only the nonzero entries of the gradient.
+ *
  * @tparam DecomposableFunctionType Decomposable objective function type to be
  *     minimized.
  * @tparam UpdatePolicyType update policy used by SGD during the iterative update
  *     process. By default vanilla update policy (see
  *     mlpack::optimization::VanillaUpdate) is used.
+ * @tparam GradType Type of the gradient.  With arma::sp_mat, the function
+ *     computes a sparse gradient (see above) and the update policy only
+ *     touches the parameters with a nonzero gradient; this is much cheaper when
+ *     each function only depends on a few parameters, such as the rows of an
+ *     embedding table that a sentence uses.
  */
 template<
     typename DecomposableFunctionType,
-    typename UpdatePolicyType = VanillaUpdate
+    typename UpdatePolicyType = VanillaUpdate,
+    typename GradType = arma::mat
 >
 class SGD
 {
@@ -185,6 +200,9 @@ using StandardSGD = SGD<DecomposableFunctionType, VanillaUpdate>;
 template<typename DecomposableFunctionType>
 using MomentumSGD = SGD<DecomposableFunctionType, MomentumUpdate>;
 
+template<typename DecomposableFunctionType>
+using SparseSGD = SGD<DecomposableFunctionType, VanillaUpdate, arma::sp_mat>;
+
 } // namespace optimization
 } // namespace mlpack
 
@@ -16,6 +16,7 @@
 
 #include <mlpack/methods/regularized_svd/regularized_svd_function.hpp>
 #include <mlpack/core/optimizers/sgd/update_policies/vanilla_update.hpp>
+#include <mlpack/core/optimizers/sgd/batch_function.hpp>
 
 // In case it hasn't been included yet.
 #include "sgd.hpp"
@@ -23,8 +24,12 @@
 namespace mlpack {
 namespace optimization {
 
-template<typename DecomposableFunctionType, typename UpdatePolicyType>
-SGD<DecomposableFunctionType, UpdatePolicyType>::SGD(
+template<
+    typename DecomposableFunctionType,
+    typename UpdatePolicyType,
+    typename GradType
+>
+SGD<DecomposableFunctionType, UpdatePolicyType, GradType>::SGD(
     DecomposableFunctionType& function,
     const double stepSize,
     const size_t maxIterations,
@@ -40,8 +45,12 @@ SGD<DecomposableFunctionType, UpdatePolicyType>::SGD(
 { /* Nothing to do. */ }
 
 //! Optimize the function (minimize).
-template<typename DecomposableFunctionType, typename UpdatePolicyType>
-double SGD<DecomposableFunctionType, UpdatePolicyType>::Optimize(
+template<
+    typename DecomposableFunctionType,
+    typename UpdatePolicyType,
+    typename GradType
+>
+double SGD<DecomposableFunctionType, UpdatePolicyType, GradType>::Optimize(
     DecomposableFunctionType& function,
     arma::mat& iterate)
 {
@@ -56,81 +65,74 @@ double SGD<DecomposableFunctionType, UpdatePolicyType>::Optimize(
         (numFunctions - 1), numFunctions));
   }
 
-  // To keep track of where we are and how things are going.
+  // To keep track of where we are and how things are going.  The objective of
+  // a pass is the sum of the objectives of its functions, each taken at the
+  // iterate its gradient is computed at (as mini-batch SGD does), so checking
+  // for convergence needs no extra pass over the data.
   size_t currentFunction = 0;
   double overallObjective = 0;
   double lastObjective = DBL_MAX;
 
-  // Calculate the first objective function.
-  for (size_t i = 0; i < numFunctions; ++i)
-    overallObjective += function.Evaluate(iterate, i);
-
   // Initialize the update policy.
   updatePolicy.Initialize(iterate.n_rows, iterate.n_cols);
 
   // Now iterate!
-  arma::mat gradient(iterate.n_rows, iterate.n_cols);
+  GradType gradient(iterate.n_rows, iterate.n_cols);
   for (size_t i = 1; i != maxIterations; ++i, ++currentFunction)
   {
     // Is this iteration the start of a sequence?
     if ((currentFunction % numFunctions) == 0)
     {
-      // Output current objective function.
-      Log::Info << "SGD: iteration " << i << ", objective " << overallObjective
-          << "." << std::endl;
-
-      if (std::isnan(overallObjective) || std::isinf(overallObjective))
-      {
-        Log::Warn << "SGD: converged to " << overallObjective << "; terminating"
-            << " with failure.  Try a smaller step size?" << std::endl;
-        return overallObjective;
-      }
-
-      if (std::abs(lastObjective - overallObjective) < tolerance)
+      // Check the pass that just ended, if any.
+      if (i > 1)
       {
-        Log::Info << "SGD: minimized within tolerance " << tolerance << "; "
-            << "terminating optimization." << std::endl;
-        return overallObjective;
+        // Output current objective function.
+        Log::Info << "SGD: iteration " << i << ", objective "
+            << overallObjective << "." << std::endl;
+
+        if (std::isnan(overallObjective) || std::isinf(overallObjective))
+        {
+          Log::Warn << "SGD: converged to " << overallObjective << "; "
+              << "terminating with failure.  Try a smaller step size?"
+              << std::endl;
+          return overallObjective;
+        }
+
+        if (std::abs(lastObjective - overallObjective) < tolerance)
+        {
+          Log::Info << "SGD: minimized within tolerance " << tolerance << "; "
+              << "terminating optimization." << std::endl;
+          return overallObjective;
+        }
+
+        lastObjective = overallObjective;
       }
 
       // Reset the counter variables.
-      lastObjective = overallObjective;
       overallObjective = 0;
       currentFunction = 0;
 
-      if (shuffle) // Determine order of visitation.
+      if (shuffle && i > 1) // Determine order of visitation.
         visitationOrder = arma::shuffle(visitationOrder);
     }
 
-    // Evaluate the gradient for this iteration.
-    if (shuffle)
-      function.Gradient(iterate, visitationOrder[currentFunction], gradient);
-    else
-      function.Gradient(iterate, currentFunction, gradient);
+    const size_t f = shuffle ? visitationOrder[currentFunction] :
+        currentFunction;
+
+    // Add the objective of this function at the current iterate to the
+    // overall objective function, and evaluate its gradient.
+    overallObjective += function.Evaluate(iterate, f);
+    function.Gradient(iterate, f, gradient);
 
     // Use the update policy to take a step.
     updatePolicy.Update(iterate, stepSize, gradient);
-
-    // Now add that to the overall objective function.
-    if (shuffle)
-    {
-      overallObjective += function.Evaluate(iterate,
-          visitationOrder[currentFunction]);
-    }
-    else
-    {
-      overallObjective += function.Evaluate(iterate, currentFunction);
-    }
   }
 
   Log::Info << "SGD: maximum iterations (" << maxIterations << ") reached; "
       << "terminating optimization." << std::endl;
 
   // Calculate final objective.
-  overallObjective = 0;
-  for (size_t i = 0; i < numFunctions; ++i)
-    overallObjective += function.Evaluate(iterate, i);
-  return overallObjective;
+  return FullEvaluate(function, iterate);
 }
 
 } // namespace optimization
@@ -105,6 +105,14 @@ class MomentumUpdate
     iterate += velocity;
   }
 
+  //! Serialize the momentum and the velocity.
+  template<typename Archive>
+  void Serialize(Archive& ar, const unsigned int /* version */)
+  {
+    ar & data::CreateNVP(momentum, "momentum");
+    ar & data::CreateNVP(velocity, "velocity");
+  }
+
  private:
   // The momentum hyperparamter
   double momentum;
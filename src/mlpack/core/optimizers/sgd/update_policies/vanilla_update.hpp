@@ -57,6 +57,29 @@ class VanillaUpdate
     // Perform the vanilla SGD update.
     iterate -= stepSize * gradient;
   }
+
+ /**
+  * Update step for SGD with a sparse gradient.  Only the parameters with a
+  * nonzero gradient are touched, which gives the same result as the dense
+  * update.
+  *
+  * @param iterate Parameters that minimize the function.
+  * @param stepSize Step size to be used for the given iteration.
+  * @param gradient The sparse gradient matrix.
+  */
+  void Update(arma::mat& iterate,
+              const double stepSize,
+              const arma::sp_mat& gradient)
+  {
+    for (arma::sp_mat::const_iterator it = gradient.begin();
+        it != gradient.end(); ++it)
+      iterate(it.row(), it.col()) -= stepSize * (*it);
+  }
+
+  //! Serialize the policy (there is nothing to save).
+  template<typename Archive>
+  void Serialize(Archive& /* ar */, const unsigned int /* version */)
+  { /* Nothing to do. */ }
 };
 
 } // namespace optimization
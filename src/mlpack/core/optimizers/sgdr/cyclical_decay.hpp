@@ -113,6 +113,19 @@ class CyclicalDecay
   //! Modify the restart fraction.
   double& EpochBatches() { return epochBatches; }
 
+  //! Serialize the position in the schedule of restarts.
+  template<typename Archive>
+  void Serialize(Archive& ar, const unsigned int /* version */)
+  {
+    ar & data::CreateNVP(epochRestart, "epochRestart");
+    ar & data::CreateNVP(multFactor, "multFactor");
+    ar & data::CreateNVP(constStepSize, "constStepSize");
+    ar & data::CreateNVP(nextRestart, "nextRestart");
+    ar & data::CreateNVP(batchRestart, "batchRestart");
+    ar & data::CreateNVP(epochBatches, "epochBatches");
+    ar & data::CreateNVP(epoch, "epoch");
+  }
+
  private:
   //! Epoch where decay is applied.
   size_t epochRestart;
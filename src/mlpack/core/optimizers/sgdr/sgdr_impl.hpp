@@ -54,7 +54,10 @@ double SGDR<DecomposableFunctionType, UpdatePolicyType>::Optimize(
 {
   // If a user changed the step size he hasn't update the step size of the
   // cyclical decay instantiation, so we have to do it here.
-  if (optimizer.StepSize() != optimizer.DecayPolicy().StepSize())
+  // (When training is resumed, the step size is the current one of the
+  // schedule, so it is left alone.)
+  if (optimizer.ResetPolicy() &&
+      optimizer.StepSize() != optimizer.DecayPolicy().StepSize())
   {
     optimizer.DecayPolicy().StepSize() = optimizer.StepSize();
   }
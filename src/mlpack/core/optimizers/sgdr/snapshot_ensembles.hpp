@@ -144,6 +144,21 @@ class SnapshotEnsembles
   //! Modify the snapshots.
   std::vector<arma::mat>& Snapshots() { return snapshots; }
 
+  //! Serialize the schedule of restarts and the snapshots taken so far.
+  template<typename Archive>
+  void Serialize(Archive& ar, const unsigned int /* version */)
+  {
+    ar & data::CreateNVP(epochRestart, "epochRestart");
+    ar & data::CreateNVP(multFactor, "multFactor");
+    ar & data::CreateNVP(constStepSize, "constStepSize");
+    ar & data::CreateNVP(nextRestart, "nextRestart");
+    ar & data::CreateNVP(batchRestart, "batchRestart");
+    ar & data::CreateNVP(epochBatches, "epochBatches");
+    ar & data::CreateNVP(epoch, "epoch");
+    ar & data::CreateNVP(snapshotEpochs, "snapshotEpochs");
+    ar & data::CreateNVP(snapshots, "snapshots");
+  }
+
  private:
   //! Epoch where decay is applied.
   size_t epochRestart;
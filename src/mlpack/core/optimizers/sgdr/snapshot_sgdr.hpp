@@ -148,6 +148,40 @@ class SnapshotSGDR
   //! Modify whether or not the individual functions are shuffled.
   bool& Shuffle() { return optimizer.Shuffle(); }
 
+  /**
+   * Save the state of the optimizer (including the position in the schedule
+   * of restarts) to the given file every given number of passes over the
+   * data; see MiniBatchSGDType::Checkpoint().
+   *
+   * @param filename Name of the checkpoint (empty to turn checkpointing off).
+   * @param period Number of passes over the data between checkpoints.
+   */
+  void Checkpoint(const std::string& filename, const size_t period = 1)
+  {
+    optimizer.Checkpoint(filename, period);
+  }
+
+  /**
+   * Load the state of the optimizer from the given checkpoint, so that the
+   * next call to Optimize() continues the training (and the schedule of
+   * restarts) where the checkpoint was taken; see MiniBatchSGDType::Resume().
+   *
+   * @param filename Name of the checkpoint.
+   * @param iterate The iterate to continue from (will be modified).
+   * @return Whether the checkpoint was loaded.
+   */
+  bool Resume(const std::string& filename, arma::mat& iterate)
+  {
+    return optimizer.Resume(filename, iterate);
+  }
+
+  //! Get whether or not the update policy is initialized on every call to
+  //! Optimize().
+  bool ResetPolicy() const { return optimizer.ResetPolicy(); }
+  //! Modify whether or not the update policy is initialized on every call to
+  //! Optimize().
+  bool& ResetPolicy() { return optimizer.ResetPolicy(); }
+
   //! Get the snapshots.
   std::vector<arma::mat> Snapshots() const
   {
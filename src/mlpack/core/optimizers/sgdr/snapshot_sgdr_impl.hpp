@@ -59,7 +59,10 @@ double SnapshotSGDR<DecomposableFunctionType, UpdatePolicyType>::Optimize(
 {
   // If a user changed the step size he hasn't update the step size of the
   // cyclical decay instantiation, so we have to do here.
-  if (optimizer.StepSize() != optimizer.DecayPolicy().StepSize())
+  // (When training is resumed, the step size is the current one of the
+  // schedule, so it is left alone.)
+  if (optimizer.ResetPolicy() &&
+      optimizer.StepSize() != optimizer.DecayPolicy().StepSize())
   {
     optimizer.DecayPolicy().StepSize() = optimizer.StepSize();
   }
@@ -85,9 +88,7 @@ double SnapshotSGDR<DecomposableFunctionType, UpdatePolicyType>::Optimize(
     iterate /= (optimizer.DecayPolicy().Snapshots().size() + 1);
 
     // Calculate final objective.
-    overallObjective = 0;
-    for (size_t i = 0; i < function.NumFunctions(); ++i)
-      overallObjective += function.Evaluate(iterate, i);
+    overallObjective = FullEvaluate(function, iterate, batchSize);
   }
 
   return overallObjective;
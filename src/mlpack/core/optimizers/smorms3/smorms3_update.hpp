@@ -97,6 +97,16 @@ class SMORMS3Update
   //! Modify the value used to initialise the mean squared gradient parameter.
   double& Epsilon() { return epsilon; }
 
+  //! Serialize the policy and its memory.
+  template<typename Archive>
+  void Serialize(Archive& ar, const unsigned int /* version */)
+  {
+    ar & data::CreateNVP(epsilon, "epsilon");
+    ar & data::CreateNVP(mem, "mem");
+    ar & data::CreateNVP(g, "g");
+    ar & data::CreateNVP(g2, "g2");
+  }
+
  private:
   //! The value used to initialise the mean squared gradient parameter.
   double epsilon;
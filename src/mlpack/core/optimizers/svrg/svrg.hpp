@@ -0,0 +1,196 @@
+/**
+ * @file svrg.hpp
+ *
+ * Stochastic variance reduced gradient (SVRG).
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_OPTIMIZERS_SVRG_SVRG_HPP
+#define MLPACK_CORE_OPTIMIZERS_SVRG_SVRG_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/optimizers/sgd/update_policies/vanilla_update.hpp>
+
+namespace mlpack {
+namespace optimization {
+
+/**
+ * Stochastic variance reduced gradient (SVRG) minimizes a function which can
+ * be expressed as a sum of other functions,
+ *
+ * \f[
+ * f(A) = \sum_{i = 0}^{n} f_i(A),
+ * \f]
+ *
+ * like SGD, but corrects the gradient of each function with a snapshot of the
+ * iterate, so that the variance of the steps vanishes as the iterate
+ * converges and a constant step size can be used.  At the start of each outer
+ * iteration the snapshot \f$ \tilde{A} \f$ is taken and the mean of the
+ * gradients \f$ \tilde{\mu} = \frac{1}{n} \sum_i \nabla f_i(\tilde{A}) \f$ is
+ * computed; then each inner iteration takes the step
+ *
+ * \f[
+ * A_{j + 1} = A_j - \alpha (\nabla f_i(A_j) - \nabla f_i(\tilde{A}) +
+ *     \tilde{\mu})
+ * \f]
+ *
+ * through the update policy (by default mlpack::optimization::VanillaUpdate).
+ * For strongly convex objectives, such as logistic or softmax regression with
+ * a regularization term, this converges linearly.
+ *
+ * For more information, please refer to:
+ *
+ * @code
+ * @inproceedings{Johnson2013,
+ *   title     = {Accelerating Stochastic Gradient Descent using Predictive
+ *                Variance Reduction},
+ *   author    = {Rie Johnson and Tong Zhang},
+ *   booktitle = {Advances in Neural Information Processing Systems 26
+ *                (NIPS 2013)},
+ *   year      = {2013}
+ * }
+ * @endcode
+ *
+ * For SVRG to work, a DecomposableFunctionType template parameter is required.
+ * This class must implement the same functions as for SGD:
+ *
+ *   size_t NumFunctions();
+ *   double Evaluate(const arma::mat& coordinates, const size_t i);
+ *   void Gradient(const arma::mat& coordinates,
+ *                 const size_t i,
+ *                 arma::mat& gradient);
+ *
+ * If the function also implements the batch Evaluate() and Gradient()
+ * described in MiniBatchSGD, they are used for the objective and the mean
+ * gradient of the whole dataset.
+ *
+ * @tparam DecomposableFunctionType Decomposable objective function type to be
+ *     minimized.
+ * @tparam UpdatePolicyType Update policy used to take each inner step.
+ */
+template<
+    typename DecomposableFunctionType,
+    typename UpdatePolicyType = VanillaUpdate
+>
+class SVRG
+{
+ public:
+  /**
+   * Construct the SVRG optimizer with the given function and parameters.  The
+   * defaults here are not necessarily good for the given problem, so it is
+   * suggested that the values used be tailored to the task at hand.  The
+   * maximum number of iterations refers to the maximum number of outer
+   * iterations (snapshots).
+   *
+   * @param function Function to be optimized (minimized).
+   * @param stepSize Step size for each inner iteration.
+   * @param maxIterations Maximum number of outer iterations allowed (0 means
+   *     no limit).
+   * @param innerIterations Number of inner iterations of each outer iteration
+   *     (0 means the number of functions, one pass over the data).
+   * @param tolerance Maximum absolute tolerance to terminate algorithm.
+   * @param shuffle If true, the function order is shuffled; otherwise, each
+   *     function is visited in linear order.
+   * @param updatePolicy Instantiated update policy used to take the steps.
+   */
+  SVRG(DecomposableFunctionType& function,
+       const double stepSize = 0.01,
+       const size_t maxIterations = 100,
+       const size_t innerIterations = 0,
+       const double tolerance = 1e-5,
+       const bool shuffle = true,
+       const UpdatePolicyType updatePolicy = UpdatePolicyType());
+
+  /**
+   * Optimize the given function using SVRG.  The given starting point will be
+   * modified to store the finishing point of the algorithm, and the final
+   * objective value is returned.
+   *
+   * @param function Function to optimize.
+   * @param iterate Starting point (will be modified).
+   * @return Objective value of the final point.
+   */
+  double Optimize(DecomposableFunctionType& function, arma::mat& iterate);
+
+  /**
+   * Optimize the given function using SVRG.  The given starting point will be
+   * modified to store the finishing point of the algorithm, and the final
+   * objective value is returned.
+   *
+   * @param iterate Starting point (will be modified).
+   * @return Objective value of the final point.
+   */
+  double Optimize(arma::mat& iterate)
+  {
+    return Optimize(this->function, iterate);
+  }
+
+  //! Get the instantiated function to be optimized.
+  const DecomposableFunctionType& Function() const { return function; }
+  //! Modify the instantiated function.
+  DecomposableFunctionType& Function() { return function; }
+
+  //! Get the step size.
+  double StepSize() const { return stepSize; }
+  //! Modify the step size.
+  double& StepSize() { return stepSize; }
+
+  //! Get the maximum number of outer iterations (0 indicates no limit).
+  size_t MaxIterations() const { return maxIterations; }
+  //! Modify the maximum number of outer iterations (0 indicates no limit).
+  size_t& MaxIterations() { return maxIterations; }
+
+  //! Get the number of inner iterations (0 indicates one pass).
+  size_t InnerIterations() const { return innerIterations; }
+  //! Modify the number of inner iterations (0 indicates one pass).
+  size_t& InnerIterations() { return innerIterations; }
+
+  //! Get the tolerance for termination.
+  double Tolerance() const { return tolerance; }
+  //! Modify the tolerance for termination.
+  double& Tolerance() { return tolerance; }
+
+  //! Get whether or not the individual functions are shuffled.
+  bool Shuffle() const { return shuffle; }
+  //! Modify whether or not the individual functions are shuffled.
+  bool& Shuffle() { return shuffle; }
+
+  //! Get the update policy.
+  UpdatePolicyType UpdatePolicy() const { return updatePolicy; }
+  //! Modify the update policy.
+  UpdatePolicyType& UpdatePolicy() { return updatePolicy; }
+
+ private:
+  //! The instantiated function.
+  DecomposableFunctionType& function;
+
+  //! The step size for each inner iteration.
+  double stepSize;
+
+  //! The maximum number of outer iterations.
+  size_t maxIterations;
+
+  //! The number of inner iterations of each outer iteration.
+  size_t innerIterations;
+
+  //! The tolerance for termination.
+  double tolerance;
+
+  //! Controls whether or not the individual functions are shuffled when
+  //! iterating.
+  bool shuffle;
+
+  //! The update policy used to take the inner steps.
+  UpdatePolicyType updatePolicy;
+};
+
+} // namespace optimization
+} // namespace mlpack
+
+// Include implementation.
+#include "svrg_impl.hpp"
+
+#endif
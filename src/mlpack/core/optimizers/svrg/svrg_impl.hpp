@@ -0,0 +1,124 @@
+/**
+ * @file svrg_impl.hpp
+ *
+ * Implementation of stochastic variance reduced gradient (SVRG).
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_OPTIMIZERS_SVRG_SVRG_IMPL_HPP
+#define MLPACK_CORE_OPTIMIZERS_SVRG_SVRG_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "svrg.hpp"
+
+#include <mlpack/core/optimizers/sgd/batch_function.hpp>
+
+namespace mlpack {
+namespace optimization {
+
+template<typename DecomposableFunctionType, typename UpdatePolicyType>
+SVRG<DecomposableFunctionType, UpdatePolicyType>::SVRG(
+    DecomposableFunctionType& function,
+    const double stepSize,
+    const size_t maxIterations,
+    const size_t innerIterations,
+    const double tolerance,
+    const bool shuffle,
+    const UpdatePolicyType updatePolicy) :
+    function(function),
+    stepSize(stepSize),
+    maxIterations(maxIterations),
+    innerIterations(innerIterations),
+    tolerance(tolerance),
+    shuffle(shuffle),
+    updatePolicy(updatePolicy)
+{ /* Nothing to do. */ }
+
+//! Optimize the function (minimize).
+template<typename DecomposableFunctionType, typename UpdatePolicyType>
+double SVRG<DecomposableFunctionType, UpdatePolicyType>::Optimize(
+    DecomposableFunctionType& function,
+    arma::mat& iterate)
+{
+  // Find the number of functions to use.
+  const size_t numFunctions = function.NumFunctions();
+  const size_t numInner = (innerIterations == 0) ? numFunctions :
+      innerIterations;
+
+  arma::Col<size_t> visitationOrder = arma::linspace<arma::Col<size_t>>(0,
+      (numFunctions - 1), numFunctions);
+
+  // Calculate the first objective function.
+  double overallObjective = FullEvaluate(function, iterate);
+  double lastObjective = DBL_MAX;
+
+  // Initialize the update policy.
+  updatePolicy.Initialize(iterate.n_rows, iterate.n_cols);
+
+  arma::mat snapshot, fullGradient, gradient, snapshotGradient;
+  size_t currentFunction = 0;
+  for (size_t i = 1; maxIterations == 0 || i <= maxIterations; ++i)
+  {
+    // Output current objective function.
+    Log::Info << "SVRG: iteration " << i << ", objective " << overallObjective
+        << "." << std::endl;
+
+    if (std::isnan(overallObjective) || std::isinf(overallObjective))
+    {
+      Log::Warn << "SVRG: converged to " << overallObjective << "; "
+          << "terminating with failure.  Try a smaller step size?"
+          << std::endl;
+      return overallObjective;
+    }
+
+    if (std::abs(lastObjective - overallObjective) < tolerance)
+    {
+      Log::Info << "SVRG: minimized within tolerance " << tolerance << "; "
+          << "terminating optimization." << std::endl;
+      return overallObjective;
+    }
+
+    // Take the snapshot and the mean of its gradients.
+    snapshot = iterate;
+    FullGradient(function, snapshot, fullGradient);
+    fullGradient /= numFunctions;
+
+    for (size_t j = 0; j < numInner; ++j, ++currentFunction)
+    {
+      // Is this the start of a sequence?
+      if ((currentFunction % numFunctions) == 0)
+      {
+        currentFunction = 0;
+        if (shuffle) // Determine order of visitation.
+          visitationOrder = arma::shuffle(visitationOrder);
+      }
+
+      const size_t f = visitationOrder[currentFunction];
+      function.Gradient(iterate, f, gradient);
+      function.Gradient(snapshot, f, snapshotGradient);
+
+      // The variance reduced gradient.
+      gradient -= snapshotGradient;
+      gradient += fullGradient;
+
+      // Use the update policy to take a step.
+      updatePolicy.Update(iterate, stepSize, gradient);
+    }
+
+    lastObjective = overallObjective;
+    overallObjective = FullEvaluate(function, iterate);
+  }
+
+  Log::Info << "SVRG: maximum iterations (" << maxIterations << ") reached; "
+      << "terminating optimization." << std::endl;
+
+  return overallObjective;
+}
+
+} // namespace optimization
+} // namespace mlpack
+
+#endif
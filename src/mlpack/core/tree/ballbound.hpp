@@ -25,15 +25,15 @@ namespace bound {
  * to the Euclidean (L2) distance.
  *
  * @tparam MetricType metric type used in the distance measure.
+ * @tparam ElemType Element type (double/float/int/etc.).
  * @tparam VecType Type of vector (arma::vec or arma::sp_vec or similar).
  */
 template<typename MetricType = metric::LMetric<2, true>,
-         typename VecType = arma::vec>
+         typename ElemType = double,
+         typename VecType = arma::Col<ElemType>>
 class BallBound
 {
  public:
-  //! The underlying data type.
-  typedef typename VecType::elem_type ElemType;
   //! A public version of the vector type.
   typedef VecType Vec;
 
@@ -191,8 +191,8 @@ class BallBound
 };
 
 //! A specialization of BoundTraits for this bound type.
-template<typename MetricType, typename VecType>
-struct BoundTraits<BallBound<MetricType, VecType>>
+template<typename MetricType, typename ElemType, typename VecType>
+struct BoundTraits<BallBound<MetricType, ElemType, VecType>>
 {
   //! These bounds are potentially loose in some dimensions.
   const static bool HasTightBounds = false;
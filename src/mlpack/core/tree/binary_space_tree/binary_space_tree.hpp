@@ -14,7 +14,9 @@
 #include <mlpack/prereqs.hpp>
 
 #include "../statistic.hpp"
+#include "../split_traits.hpp"
 #include "midpoint_split.hpp"
+#include "flat_image.hpp"
 
 namespace mlpack {
 namespace tree /** Trees and tree-building procedures. */ {
@@ -25,9 +27,18 @@ namespace tree /** Trees and tree-building procedures. */ {
  * the constructor with the dataset to build the tree on, and the entire tree
  * will be built.
  *
- * This particular tree does not allow growth, so you cannot add or delete nodes
- * from it.  If you need to add or delete a node, the better procedure is to
- * rebuild the tree entirely.
+ * Points can be added to or removed from the tree with InsertPoint() and
+ * DeletePoint().  To keep these updates local, each node may reserve more
+ * columns of the dataset than it holds points (see Capacity()): the points of
+ * a leaf are the first Count() columns of its range, and the rest is free
+ * space for new points, so the ranges of the other nodes never have to move.
+ * When a leaf is full, the free space of the smallest enclosing subtree that
+ * is sparse enough is spread out again over its leaves, and if there is no
+ * such subtree, the dataset is grown.  A subtree is rebuilt once the number of
+ * points inserted into or removed from it since it was built exceeds half of
+ * its size, so that the tree does not drift too far from the one that would
+ * be built on the same points.  After updates, Dataset() may hold free columns
+ * that are not points of the tree; ShrinkToFit() removes them.
  *
  * This tree does take one runtime parameter in the constructor, which is the
  * max leaf size to be used.
@@ -59,7 +70,7 @@ class BinarySpaceTree
   //! The type of element held in MatType.
   typedef typename MatType::elem_type ElemType;
 
-  typedef SplitType<BoundType<MetricType>, MatType> Split;
+  typedef SplitType<BoundType<MetricType, ElemType>, MatType> Split;
 
  private:
   //! The left child node.
@@ -74,8 +85,15 @@ class BinarySpaceTree
   //! The number of points of the dataset contained in this node (and its
   //! children).
   size_t count;
+  //! The number of columns of the dataset reserved for this node (and its
+  //! children), starting at begin.  This is count, unless points have been
+  //! inserted or removed.
+  size_t capacity;
+  //! The number of points inserted into or removed from this node since it was
+  //! built (or loaded).
+  size_t updates;
   //! The bound object for this node.
-  BoundType<MetricType> bound;
+  BoundType<MetricType, ElemType> bound;
   //! Any extra data contained in the node.
   StatisticType stat;
   //! The distance from the centroid of this node to the centroid of the parent.
@@ -88,6 +106,11 @@ class BinarySpaceTree
   //! The dataset.  If we are the root of the tree, we own the dataset and must
   //! delete it.
   MatType* dataset;
+  //! If this is the root of a compacted tree, the block of memory holding the
+  //! other nodes (see Compact()); otherwise NULL.
+  BinarySpaceTree* nodePool;
+  //! The number of nodes in the node pool.
+  size_t poolSize;
 
  public:
   //! A single-tree traverser for binary space trees; see
@@ -211,7 +234,7 @@ class BinarySpaceTree
   BinarySpaceTree(BinarySpaceTree* parent,
                   const size_t begin,
                   const size_t count,
-                  SplitType<BoundType<MetricType>, MatType>& splitter,
+                  SplitType<BoundType<MetricType, ElemType>, MatType>& splitter,
                   const size_t maxLeafSize = 20);
 
   /**
@@ -237,7 +260,7 @@ class BinarySpaceTree
                   const size_t begin,
                   const size_t count,
                   std::vector<size_t>& oldFromNew,
-                  SplitType<BoundType<MetricType>, MatType>& splitter,
+                  SplitType<BoundType<MetricType, ElemType>, MatType>& splitter,
                   const size_t maxLeafSize = 20);
 
   /**
@@ -266,7 +289,7 @@ class BinarySpaceTree
                   const size_t count,
                   std::vector<size_t>& oldFromNew,
                   std::vector<size_t>& newFromOld,
-                  SplitType<BoundType<MetricType>, MatType>& splitter,
+                  SplitType<BoundType<MetricType, ElemType>, MatType>& splitter,
                   const size_t maxLeafSize = 20);
 
   /**
@@ -293,6 +316,23 @@ class BinarySpaceTree
       Archive& ar,
       const typename std::enable_if_t<Archive::is_loading::value>* = 0);
 
+  /**
+   * Initialize the tree from a flat image written by SaveFlat().  Only the
+   * nodes are allocated: the dataset is not copied, and instead the tree's
+   * dataset aliases the memory of the image.  This makes it possible to load a
+   * tree from a memory-mapped file (see data::MappedFile) almost immediately,
+   * and to share the pages holding the dataset between processes.  The image
+   * must stay valid for the lifetime of the tree, and the dataset cannot be
+   * resized, so InsertPoint() and DeletePoint() cannot be used.
+   *
+   * A std::runtime_error is thrown if the memory does not hold a valid image
+   * with the same element type as this tree.
+   *
+   * @param image Memory holding the image.  Must be aligned to 8 bytes.
+   * @param size Size of the image in bytes.
+   */
+  BinarySpaceTree(char* image, const size_t size);
+
   /**
    * Deletes this node, deallocating the memory for the children and calling
    * their destructors in turn.  This will invalidate any pointers or references
@@ -301,9 +341,9 @@ class BinarySpaceTree
   ~BinarySpaceTree();
 
   //! Return the bound object for this node.
-  const BoundType<MetricType>& Bound() const { return bound; }
+  const BoundType<MetricType, ElemType>& Bound() const { return bound; }
   //! Return the bound object for this node.
-  BoundType<MetricType>& Bound() { return bound; }
+  BoundType<MetricType, ElemType>& Bound() { return bound; }
 
   //! Return the statistic object for this node.
   const StatisticType& Stat() const { return stat; }
@@ -418,7 +458,8 @@ class BinarySpaceTree
   /**
    * Return the index (with reference to the dataset) of a particular descendant
    * of this node.  The index should be greater than zero but less than the
-   * number of descendants.
+   * number of descendants.  If the node has free columns (see Capacity()), this
+   * takes time proportional to the depth of the subtree.
    *
    * @param index Index of the descendant.
    */
@@ -489,18 +530,166 @@ class BinarySpaceTree
   //! Modify the number of points in this subset.
   size_t& Count() { return count; }
 
+  //! Return the number of columns of the dataset reserved for this subset.
+  size_t Capacity() const { return capacity; }
+
   //! Store the center of the bounding region in the given vector.
-  void Center(arma::vec& center) const { bound.Center(center); }
+  void Center(arma::Col<ElemType>& center) const { bound.Center(center); }
+
+  /**
+   * Insert the given point into the tree.  This must be called on the root of
+   * the tree.  The point is added to the leaf whose bound is closest to it, in
+   * a free column of the range of the leaf; if the leaf has none, the free
+   * columns of a subtree around it (or of the whole tree, after the dataset is
+   * grown) are spread out again.  The bounds and statistics of each node on
+   * the path to that leaf are updated.  If the leaf then holds more than
+   * maxLeafSize points it is split, and if a subtree on the path has changed
+   * too much since it was built, the largest such subtree is rebuilt.
+   *
+   * @param point Point to insert.
+   * @param maxLeafSize Maximum number of points held in a leaf.
+   * @return Index of the inserted point in Dataset().
+   */
+  template<typename VecType>
+  size_t InsertPoint(
+      const VecType& point,
+      const size_t maxLeafSize = 20,
+      typename std::enable_if_t<IsVector<VecType>::value>* = 0);
+
+  /**
+   * Insert the given point into the tree, and update the given mapping of old
+   * point indices (as filled by the constructor).  The mapping has one entry
+   * for each column of Dataset(); free columns map to size_t(-1).  The new
+   * point gets the given old index, which is normally its index in the
+   * caller's copy of the data.  See the other overload of InsertPoint() for
+   * more details.
+   *
+   * @param point Point to insert.
+   * @param oldIndex Old index of the new point.
+   * @param oldFromNew Vector holding the old positions for each new point.
+   * @param maxLeafSize Maximum number of points held in a leaf.
+   * @return Index of the inserted point in Dataset().
+   */
+  template<typename VecType>
+  size_t InsertPoint(
+      const VecType& point,
+      const size_t oldIndex,
+      std::vector<size_t>& oldFromNew,
+      const size_t maxLeafSize = 20,
+      typename std::enable_if_t<IsVector<VecType>::value>* = 0);
+
+  /**
+   * Remove the point with the given index in Dataset() from the tree.  This
+   * must be called on the root of the tree.  The last point of the leaf holding
+   * the point takes its column, and the column of that point becomes free; no
+   * other point moves, unless a subtree is rebuilt.  The bounds along the path
+   * to the leaf are recomputed, and the statistics along the path are rebuilt.
+   * If the leaf becomes empty, it is removed from the tree, and if a subtree on
+   * the path has changed too much since it was built, the largest such subtree
+   * is rebuilt with the given maximum leaf size.
+   *
+   * @param index Index of the point to remove in Dataset().
+   * @param maxLeafSize Maximum number of points held in a leaf.
+   * @return false if the point is not held in the tree, true otherwise.
+   */
+  bool DeletePoint(const size_t index, const size_t maxLeafSize = 20);
+
+  /**
+   * Remove the point with the given index in Dataset() from the tree, and
+   * update the given mapping of old point indices (as filled by the
+   * constructor or by InsertPoint()).  The entries of the moved point follow
+   * it, the column that becomes free maps to size_t(-1), and the old indices
+   * of the other points don't change.  See the other overload of
+   * DeletePoint() for more details.
+   *
+   * @param index Index of the point to remove in Dataset().
+   * @param oldFromNew Vector holding the old positions for each new point.
+   * @param maxLeafSize Maximum number of points held in a leaf.
+   * @return false if the point is not held in the tree, true otherwise.
+   */
+  bool DeletePoint(const size_t index,
+                   std::vector<size_t>& oldFromNew,
+                   const size_t maxLeafSize = 20);
+
+  /**
+   * Remove the free columns left in Dataset() by InsertPoint() and
+   * DeletePoint(), so that the points of the tree are the columns of
+   * Dataset() again, in the order of the leaves.  This must be called on the
+   * root of the tree, and takes time linear in the size of the dataset.
+   */
+  void ShrinkToFit();
+
+  /**
+   * Remove the free columns left in Dataset() by InsertPoint() and
+   * DeletePoint(), and update the given mapping of old point indices.  See the
+   * other overload of ShrinkToFit() for more details.
+   *
+   * @param oldFromNew Vector holding the old positions for each new point.
+   */
+  void ShrinkToFit(std::vector<size_t>& oldFromNew);
+
+  /**
+   * Recompute the bounds, the cached distances and the statistics of every node
+   * of this subtree after the points in Dataset() have been moved in place.
+   * The structure of the tree (that is, which points each node holds) is not
+   * changed, so this is much faster than building a new tree; but the bounds
+   * may be looser than those of a new tree if the points have moved far.
+   */
+  void RefitBounds();
+
+  //! The orders in which Compact() can place the nodes of the tree.
+  enum NodeOrder
+  {
+    //! Depth-first (preorder) order: each node is followed by its left
+    //! subtree, then its right subtree.
+    DEPTH_FIRST_ORDER,
+    //! van Emde Boas order: the top half of the tree (by height) is placed
+    //! first, followed by each subtree below it, and each of these is laid out
+    //! recursively in the same way.  This is cache-oblivious: any path from the
+    //! root touches few blocks of memory, whatever the size of the blocks.
+    VAN_EMDE_BOAS_ORDER
+  };
+
+  /**
+   * Move every node of the tree (except this one) into one contiguous block of
+   * memory, placed in the given order, so that traversals touch fewer cache
+   * lines and pages.  This must be called on the root of the tree, after it is
+   * built; it can be called again after the tree has changed, to move any
+   * nodes created by InsertPoint() into the block too.  Any pointers or
+   * references to nodes other than the root are invalidated.
+   *
+   * @param order Order to place the nodes in.
+   */
+  void Compact(const NodeOrder order = VAN_EMDE_BOAS_ORDER);
+
+  //! Return whether the nodes of this tree have been moved into a contiguous
+  //! block of memory with Compact().
+  bool IsCompact() const { return nodePool != NULL; }
 
  private:
+  //! Nodes with at least this many points build their two subtrees as separate
+  //! OpenMP tasks, if the split type allows it.
+  static const size_t ParallelBuildThreshold = 1024;
+
+  /**
+   * Return whether the subtrees of this node should be built in parallel: that
+   * is, whether OpenMP tasks are available, the split type is deterministic
+   * (see SplitTraits), and the node holds at least ParallelBuildThreshold
+   * points.  A tree built in parallel is identical to one built serially,
+   * including the permutation of the dataset.
+   */
+  bool ParallelBuild() const;
+
   /**
    * Splits the current node, assigning its left and right children recursively.
+   * If ParallelBuild() is true and this is called inside a parallel region, the
+   * partition of the node and the two subtrees are computed with OpenMP tasks.
    *
    * @param maxLeafSize Maximum number of points held in a leaf.
    * @param splitter Instantiated SplitType object.
    */
   void SplitNode(const size_t maxLeafSize,
-                 SplitType<BoundType<MetricType>, MatType>& splitter);
+                 SplitType<BoundType<MetricType, ElemType>, MatType>& splitter);
 
   /**
    * Splits the current node, assigning its left and right children recursively.
@@ -512,7 +701,182 @@ class BinarySpaceTree
    */
   void SplitNode(std::vector<size_t>& oldFromNew,
                  const size_t maxLeafSize,
-                 SplitType<BoundType<MetricType>, MatType>& splitter);
+                 SplitType<BoundType<MetricType, ElemType>, MatType>& splitter);
+
+  /**
+   * Insert the given point into the tree; see InsertPoint().
+   *
+   * @param point Point to insert.
+   * @param oldIndex Old index of the new point.
+   * @param oldFromNew Mapping of old point indices to update, or NULL.
+   * @param maxLeafSize Maximum number of points held in a leaf.
+   * @return Index of the inserted point in Dataset().
+   */
+  template<typename VecType>
+  size_t Insert(const VecType& point,
+                const size_t oldIndex,
+                std::vector<size_t>* oldFromNew,
+                const size_t maxLeafSize);
+
+  /**
+   * Remove the given point from the tree; see DeletePoint().
+   *
+   * @param index Index of the point to remove in Dataset().
+   * @param oldFromNew Mapping of old point indices to update, or NULL.
+   * @param maxLeafSize Maximum number of points held in a leaf.
+   * @return false if the point is not held in the tree, true otherwise.
+   */
+  bool Delete(const size_t index,
+              std::vector<size_t>* oldFromNew,
+              const size_t maxLeafSize);
+
+  /**
+   * Find the path from this node to the leaf that a new point should be
+   * inserted into.  The path is returned from the root down.
+   *
+   * @param point Point that will be inserted.
+   * @param path Vector to store the path in.
+   */
+  template<typename VecType>
+  void InsertionPath(const VecType& point,
+                     std::vector<BinarySpaceTree*>& path);
+
+  /**
+   * Find the path from this node to the leaf whose range holds the given
+   * column.  The path is returned from the root down.
+   *
+   * @param index Column of the dataset.
+   * @param path Vector to store the path in.
+   */
+  void DeletionPath(const size_t index, std::vector<BinarySpaceTree*>& path);
+
+  /**
+   * Make room for a new point in the leaf at the end of the given path, which
+   * is full.  Going up the path, the first node whose density (with the new
+   * point) is at most a threshold, which goes from 1 at the leaf down to 3/4 at
+   * the root, has its free columns spread out again over its leaves.  If no
+   * node qualifies, the dataset is grown by half first, and the free columns
+   * of the whole tree are spread out again.  This is the rebalancing of a
+   * packed-memory array, so each insertion moves O(log^2 n) points on average.
+   *
+   * @param path Path from the root to the full leaf.
+   * @param oldFromNew Mapping of old point indices to update, or NULL.
+   */
+  void Reserve(const std::vector<BinarySpaceTree*>& path,
+               std::vector<size_t>* oldFromNew);
+
+  /**
+   * Spread the free columns of this node out over its leaves, in proportion to
+   * the number of points of each leaf.  The given leaf, if any, is counted as
+   * if it held one more point, so it is guaranteed to get a free column.
+   *
+   * @param full Leaf that needs a free column, or NULL.
+   * @param oldFromNew Mapping of old point indices to update, or NULL.
+   */
+  void Spread(const BinarySpaceTree* full, std::vector<size_t>* oldFromNew);
+
+  /**
+   * Set the range of this node, and split it among its children as in
+   * Spread().  The points are not moved.
+   *
+   * @param newBegin The first column of the range.
+   * @param newCapacity The number of columns of the range.
+   * @param full Leaf of this subtree that needs a free column, or NULL.
+   */
+  void AssignCapacity(const size_t newBegin,
+                      const size_t newCapacity,
+                      const BinarySpaceTree* full);
+
+  //! Append the leaves of this subtree to the given vector, from left to right.
+  void CollectLeaves(std::vector<BinarySpaceTree*>& leaves);
+
+  /**
+   * Move the points of the given leaves of this subtree (all of them, in
+   * order) to the front of the range of this node, and set the begin index of
+   * each leaf accordingly.  The ranges of the other nodes are not updated.
+   *
+   * @param leaves Leaves of this subtree, from left to right.
+   * @param oldFromNew Mapping of old point indices to update, or NULL.
+   */
+  void PackLeaves(const std::vector<BinarySpaceTree*>& leaves,
+                  std::vector<size_t>* oldFromNew);
+
+  /**
+   * Move the given number of columns of the dataset (and their entries in the
+   * mapping) from one place to another.  The two ranges may overlap.
+   *
+   * @param from First column to move.
+   * @param to First column to move to.
+   * @param n Number of columns to move.
+   * @param oldFromNew Mapping of old point indices to update, or NULL.
+   */
+  void MoveColumns(const size_t from,
+                   const size_t to,
+                   const size_t n,
+                   std::vector<size_t>* oldFromNew);
+
+  /**
+   * Return whether this node has changed too much since it was built: that
+   * is, whether more points have been inserted into or removed from it than
+   * half of the points it holds.
+   */
+  bool NeedsRebuild() const { return !IsLeaf() && (2 * updates > count); }
+
+  /**
+   * Rebuild this node from its points, which are packed at the front of its
+   * range; the free columns are left at the end, and have to be spread out
+   * with Spread() afterwards.
+   *
+   * @param oldFromNew Mapping of old point indices to update, or NULL.
+   * @param maxLeafSize Maximum number of points held in a leaf.
+   */
+  void Rebuild(std::vector<size_t>* oldFromNew, const size_t maxLeafSize);
+
+  /**
+   * Remove the given empty leaf from the tree; its parent takes over the
+   * children (or the points) of its sibling, and the range of the leaf.
+   *
+   * @param leaf Leaf to remove.  It must have a parent.
+   * @param oldFromNew Mapping of old point indices to update, or NULL.
+   */
+  void RemoveLeaf(BinarySpaceTree* leaf, std::vector<size_t>* oldFromNew);
+
+  /**
+   * Recompute the bound of this node after points have been removed.  For a
+   * leaf, this is recomputed from the points; otherwise, from the bounds of
+   * the children.
+   */
+  void RecomputeBound();
+
+  /**
+   * Update the cached distances of this node and the parent distances of its
+   * children, and rebuild the statistic, after the bound has changed.  The
+   * children must already be up to date.
+   */
+  void RefreshNode();
+
+  /**
+   * Append the nodes in the given number of levels of this subtree to the
+   * given vector in van Emde Boas order.
+   *
+   * @param height Number of levels of the subtree to lay out.
+   * @param order Vector to append the nodes to.
+   */
+  void VanEmdeBoasOrder(const size_t height,
+                        std::vector<BinarySpaceTree*>& order);
+
+  //! Return whether the given node is stored in the node pool of this root.
+  bool InPool(const BinarySpaceTree* node) const;
+
+  /**
+   * Delete every descendant of this node that is not stored in the node pool
+   * of the given root, and unlink the children of this node, so that the nodes
+   * in the pool can be destroyed independently.
+   */
+  void DetachPool(const BinarySpaceTree& root);
+
+  //! Destroy the nodes in the node pool and free its memory.
+  void FreePool();
 
   /**
    * Update the bound of the current node. This method does not take into
@@ -529,7 +893,7 @@ class BinarySpaceTree
    *
    * @param boundToUpdate The bound to update.
    */
-  void UpdateBound(bound::HollowBallBound<MetricType>& boundToUpdate);
+  void UpdateBound(bound::HollowBallBound<MetricType, ElemType>& boundToUpdate);
 
  protected:
   /**
@@ -549,6 +913,18 @@ class BinarySpaceTree
    */
   template<typename Archive>
   void Serialize(Archive& ar, const unsigned int version);
+
+  /**
+   * Write this node and its descendants to the given stream as a flat,
+   * pointer-free image that can be loaded with the BinarySpaceTree(char*,
+   * size_t) constructor.  The image holds a header, the points of the node in
+   * column-major order, a table of nodes in breadth-first order (where the
+   * children are given as indices into the table), and the bounds and
+   * statistics of the nodes.  The stream should be opened in binary mode.
+   *
+   * @param stream Stream to write the image to.
+   */
+  void SaveFlat(std::ostream& stream) const;
 };
 
 } // namespace tree
@@ -16,7 +16,13 @@
 
 #include <mlpack/core/util/cli.hpp>
 #include <mlpack/core/util/log.hpp>
+#include <mlpack/core/util/numa.hpp>
+#include <functional>
+#include <new>
 #include <queue>
+#include <sstream>
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
 
 namespace mlpack {
 namespace tree {
@@ -38,12 +44,22 @@ BinarySpaceTree(
     parent(NULL),
     begin(0), /* This root node starts at index 0, */
     count(data.n_cols), /* and spans all of the dataset. */
+    capacity(data.n_cols),
+    updates(0),
     bound(data.n_rows),
     parentDistance(0), // Parent distance for the root is 0: it has no parent.
-    dataset(new MatType(data)) // Copies the dataset.
+    dataset(new MatType(data)), // Copies the dataset.
+    nodePool(NULL),
+    poolSize(0)
 {
+  // Spread the dataset over the NUMA nodes, if that is enabled; the points
+  // of each subtree end up on the node of the columns they are moved to.
+  NUMA::FirstTouch(*dataset);
+
   // Do the actual splitting of this node.
-  SplitType<BoundType<MetricType>, MatType> splitter;
+  SplitType<BoundType<MetricType, ElemType>, MatType> splitter;
+  #pragma omp parallel if(ParallelBuild())
+  #pragma omp single
   SplitNode(maxLeafSize, splitter);
 
   // Create the statistic depending on if we are a leaf or not.
@@ -66,17 +82,27 @@ BinarySpaceTree(
     parent(NULL),
     begin(0),
     count(data.n_cols),
+    capacity(data.n_cols),
+    updates(0),
     bound(data.n_rows),
     parentDistance(0), // Parent distance for the root is 0: it has no parent.
-    dataset(new MatType(data)) // Copies the dataset.
+    dataset(new MatType(data)), // Copies the dataset.
+    nodePool(NULL),
+    poolSize(0)
 {
   // Initialize oldFromNew correctly.
   oldFromNew.resize(data.n_cols);
   for (size_t i = 0; i < data.n_cols; i++)
     oldFromNew[i] = i; // Fill with unharmed indices.
 
+  // Spread the dataset over the NUMA nodes, if that is enabled; the points
+  // of each subtree end up on the node of the columns they are moved to.
+  NUMA::FirstTouch(*dataset);
+
   // Now do the actual splitting.
-  SplitType<BoundType<MetricType>, MatType> splitter;
+  SplitType<BoundType<MetricType, ElemType>, MatType> splitter;
+  #pragma omp parallel if(ParallelBuild())
+  #pragma omp single
   SplitNode(oldFromNew, maxLeafSize, splitter);
 
   // Create the statistic depending on if we are a leaf or not.
@@ -100,17 +126,27 @@ BinarySpaceTree(
     parent(NULL),
     begin(0),
     count(data.n_cols),
+    capacity(data.n_cols),
+    updates(0),
     bound(data.n_rows),
     parentDistance(0), // Parent distance for the root is 0: it has no parent.
-    dataset(new MatType(data)) // Copies the dataset.
+    dataset(new MatType(data)), // Copies the dataset.
+    nodePool(NULL),
+    poolSize(0)
 {
   // Initialize the oldFromNew vector correctly.
   oldFromNew.resize(data.n_cols);
   for (size_t i = 0; i < data.n_cols; i++)
     oldFromNew[i] = i; // Fill with unharmed indices.
 
+  // Spread the dataset over the NUMA nodes, if that is enabled; the points
+  // of each subtree end up on the node of the columns they are moved to.
+  NUMA::FirstTouch(*dataset);
+
   // Now do the actual splitting.
-  SplitType<BoundType<MetricType>, MatType> splitter;
+  SplitType<BoundType<MetricType, ElemType>, MatType> splitter;
+  #pragma omp parallel if(ParallelBuild())
+  #pragma omp single
   SplitNode(oldFromNew, maxLeafSize, splitter);
 
   // Create the statistic depending on if we are a leaf or not.
@@ -135,12 +171,22 @@ BinarySpaceTree(MatType&& data, const size_t maxLeafSize) :
     parent(NULL),
     begin(0),
     count(data.n_cols),
+    capacity(data.n_cols),
+    updates(0),
     bound(data.n_rows),
     parentDistance(0), // Parent distance for the root is 0: it has no parent.
-    dataset(new MatType(std::move(data)))
+    dataset(new MatType(std::move(data))),
+    nodePool(NULL),
+    poolSize(0)
 {
+  // Spread the dataset over the NUMA nodes, if that is enabled; the points
+  // of each subtree end up on the node of the columns they are moved to.
+  NUMA::FirstTouch(*dataset);
+
   // Do the actual splitting of this node.
-  SplitType<BoundType<MetricType>, MatType> splitter;
+  SplitType<BoundType<MetricType, ElemType>, MatType> splitter;
+  #pragma omp parallel if(ParallelBuild())
+  #pragma omp single
   SplitNode(maxLeafSize, splitter);
 
   // Create the statistic depending on if we are a leaf or not.
@@ -163,17 +209,27 @@ BinarySpaceTree(
     parent(NULL),
     begin(0),
     count(data.n_cols),
+    capacity(data.n_cols),
+    updates(0),
     bound(data.n_rows),
     parentDistance(0), // Parent distance for the root is 0: it has no parent.
-    dataset(new MatType(std::move(data)))
+    dataset(new MatType(std::move(data))),
+    nodePool(NULL),
+    poolSize(0)
 {
   // Initialize oldFromNew correctly.
   oldFromNew.resize(dataset->n_cols);
   for (size_t i = 0; i < dataset->n_cols; i++)
     oldFromNew[i] = i; // Fill with unharmed indices.
 
+  // Spread the dataset over the NUMA nodes, if that is enabled; the points
+  // of each subtree end up on the node of the columns they are moved to.
+  NUMA::FirstTouch(*dataset);
+
   // Now do the actual splitting.
-  SplitType<BoundType<MetricType>, MatType> splitter;
+  SplitType<BoundType<MetricType, ElemType>, MatType> splitter;
+  #pragma omp parallel if(ParallelBuild())
+  #pragma omp single
   SplitNode(oldFromNew, maxLeafSize, splitter);
 
   // Create the statistic depending on if we are a leaf or not.
@@ -197,17 +253,27 @@ BinarySpaceTree(
     parent(NULL),
     begin(0),
     count(data.n_cols),
+    capacity(data.n_cols),
+    updates(0),
     bound(data.n_rows),
     parentDistance(0), // Parent distance for the root is 0: it has no parent.
-    dataset(new MatType(std::move(data)))
+    dataset(new MatType(std::move(data))),
+    nodePool(NULL),
+    poolSize(0)
 {
   // Initialize the oldFromNew vector correctly.
   oldFromNew.resize(dataset->n_cols);
   for (size_t i = 0; i < dataset->n_cols; i++)
     oldFromNew[i] = i; // Fill with unharmed indices.
 
+  // Spread the dataset over the NUMA nodes, if that is enabled; the points
+  // of each subtree end up on the node of the columns they are moved to.
+  NUMA::FirstTouch(*dataset);
+
   // Now do the actual splitting.
-  SplitType<BoundType<MetricType>, MatType> splitter;
+  SplitType<BoundType<MetricType, ElemType>, MatType> splitter;
+  #pragma omp parallel if(ParallelBuild())
+  #pragma omp single
   SplitNode(oldFromNew, maxLeafSize, splitter);
 
   // Create the statistic depending on if we are a leaf or not.
@@ -230,17 +296,23 @@ BinarySpaceTree(
     BinarySpaceTree* parent,
     const size_t begin,
     const size_t count,
-    SplitType<BoundType<MetricType>, MatType>& splitter,
+    SplitType<BoundType<MetricType, ElemType>, MatType>& splitter,
     const size_t maxLeafSize) :
     left(NULL),
     right(NULL),
     parent(parent),
     begin(begin),
     count(count),
+    capacity(count),
+    updates(0),
     bound(parent->Dataset().n_rows),
-    dataset(&parent->Dataset()) // Point to the parent's dataset.
+    dataset(&parent->Dataset()), // Point to the parent's dataset.
+    nodePool(NULL),
+    poolSize(0)
 {
   // Perform the actual splitting.
+  #pragma omp parallel if(ParallelBuild())
+  #pragma omp single
   SplitNode(maxLeafSize, splitter);
 
   // Create the statistic depending on if we are a leaf or not.
@@ -259,21 +331,27 @@ BinarySpaceTree(
     const size_t begin,
     const size_t count,
     std::vector<size_t>& oldFromNew,
-    SplitType<BoundType<MetricType>, MatType>& splitter,
+    SplitType<BoundType<MetricType, ElemType>, MatType>& splitter,
     const size_t maxLeafSize) :
     left(NULL),
     right(NULL),
     parent(parent),
     begin(begin),
     count(count),
+    capacity(count),
+    updates(0),
     bound(parent->Dataset().n_rows),
-    dataset(&parent->Dataset())
+    dataset(&parent->Dataset()),
+    nodePool(NULL),
+    poolSize(0)
 {
   // Hopefully the vector is initialized correctly!  We can't check that
   // entirely but we can do a minor sanity check.
   assert(oldFromNew.size() == dataset->n_cols);
 
   // Perform the actual splitting.
+  #pragma omp parallel if(ParallelBuild())
+  #pragma omp single
   SplitNode(oldFromNew, maxLeafSize, splitter);
 
   // Create the statistic depending on if we are a leaf or not.
@@ -293,21 +371,27 @@ BinarySpaceTree(
     const size_t count,
     std::vector<size_t>& oldFromNew,
     std::vector<size_t>& newFromOld,
-    SplitType<BoundType<MetricType>, MatType>& splitter,
+    SplitType<BoundType<MetricType, ElemType>, MatType>& splitter,
     const size_t maxLeafSize) :
     left(NULL),
     right(NULL),
     parent(parent),
     begin(begin),
     count(count),
+    capacity(count),
+    updates(0),
     bound(parent->Dataset()->n_rows),
-    dataset(&parent->Dataset())
+    dataset(&parent->Dataset()),
+    nodePool(NULL),
+    poolSize(0)
 {
   // Hopefully the vector is initialized correctly!  We can't check that
   // entirely but we can do a minor sanity check.
   Log::Assert(oldFromNew.size() == dataset->n_cols);
 
   // Perform the actual splitting.
+  #pragma omp parallel if(ParallelBuild())
+  #pragma omp single
   SplitNode(oldFromNew, maxLeafSize, splitter);
 
   // Create the statistic depending on if we are a leaf or not.
@@ -337,12 +421,16 @@ BinarySpaceTree(
     parent(other.parent),
     begin(other.begin),
     count(other.count),
+    capacity(other.capacity),
+    updates(other.updates),
     bound(other.bound),
     stat(other.stat),
     parentDistance(other.parentDistance),
     furthestDescendantDistance(other.furthestDescendantDistance),
     // Copy matrix, but only if we are the root.
-    dataset((other.parent == NULL) ? new MatType(*other.dataset) : NULL)
+    dataset((other.parent == NULL) ? new MatType(*other.dataset) : NULL),
+    nodePool(NULL),
+    poolSize(0)
 {
   // Create left and right children (if any).
   if (other.Left())
@@ -395,12 +483,16 @@ BinarySpaceTree(BinarySpaceTree&& other) :
     parent(other.parent),
     begin(other.begin),
     count(other.count),
+    capacity(other.capacity),
+    updates(other.updates),
     bound(std::move(other.bound)),
     stat(std::move(other.stat)),
     parentDistance(other.parentDistance),
     furthestDescendantDistance(other.furthestDescendantDistance),
     minimumBoundDistance(other.minimumBoundDistance),
-    dataset(other.dataset)
+    dataset(other.dataset),
+    nodePool(other.nodePool),
+    poolSize(other.poolSize)
 {
   // Now we are a clone of the other tree.  But we must also clear the other
   // tree's contents, so it doesn't delete anything when it is destructed.
@@ -408,10 +500,14 @@ BinarySpaceTree(BinarySpaceTree&& other) :
   other.right = NULL;
   other.begin = 0;
   other.count = 0;
+  other.capacity = 0;
+  other.updates = 0;
   other.parentDistance = 0.0;
   other.furthestDescendantDistance = 0.0;
   other.minimumBoundDistance = 0.0;
   other.dataset = NULL;
+  other.nodePool = NULL;
+  other.poolSize = 0;
 
   // Set new parent.
   if (left)
@@ -441,6 +537,103 @@ BinarySpaceTree(
   ar >> data::CreateNVP(*this, "tree");
 }
 
+/**
+ * Initialize the tree from a flat image written by SaveFlat().
+ */
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+    BinarySpaceTree(char* image, const size_t size) :
+    BinarySpaceTree() // Create an empty BinarySpaceTree.
+{
+  FlatImageHeader header;
+  if (size < sizeof(FlatImageHeader))
+    throw std::runtime_error("BinarySpaceTree::BinarySpaceTree(): image is "
+        "too small to hold a tree");
+  std::memcpy(&header, image, sizeof(FlatImageHeader));
+
+  if (std::strncmp(header.magic, "mlpkbst", sizeof(header.magic)) != 0 ||
+      header.version != 1)
+    throw std::runtime_error("BinarySpaceTree::BinarySpaceTree(): image was "
+        "not written by BinarySpaceTree::SaveFlat()");
+  if (header.elemSize != sizeof(ElemType))
+    throw std::runtime_error("BinarySpaceTree::BinarySpaceTree(): element type "
+        "of image does not match element type of tree");
+  if (header.numNodes == 0 ||
+      header.dataOffset + header.nRows * header.nCols * sizeof(ElemType) >
+          header.nodeOffset ||
+      header.nodeOffset + header.numNodes * sizeof(FlatImageNode) >
+          header.extraOffset ||
+      header.extraOffset + header.extraSize > size)
+    throw std::runtime_error("BinarySpaceTree::BinarySpaceTree(): image is "
+        "truncated or corrupted");
+
+  // The dataset aliases the image; it can't be reallocated.
+  dataset = new MatType(reinterpret_cast<ElemType*>(image + header.dataOffset),
+      header.nRows, header.nCols, false, true);
+
+  const FlatImageNode* table =
+      reinterpret_cast<const FlatImageNode*>(image + header.nodeOffset);
+  MemoryStreamBuf buffer(image + header.extraOffset, header.extraSize);
+
+  try
+  {
+    boost::archive::binary_iarchive ar(buffer);
+
+    // Children always come after their parent in the table, so each node has
+    // been allocated by the time we reach it.
+    std::vector<BinarySpaceTree*> nodes(header.numNodes, NULL);
+    nodes[0] = this;
+    for (size_t i = 0; i < header.numNodes; ++i)
+    {
+      BinarySpaceTree* node = nodes[i];
+      const FlatImageNode& record = table[i];
+      if (node == NULL || record.begin + record.count > header.nCols ||
+          (record.left != 0 && (record.left <= i ||
+              record.left >= header.numNodes)) ||
+          (record.right != 0 && (record.right <= i ||
+              record.right >= header.numNodes)))
+        throw std::runtime_error("BinarySpaceTree::BinarySpaceTree(): image "
+            "is corrupted");
+
+      node->begin = record.begin;
+      node->count = record.count;
+      node->capacity = record.count;
+      node->parentDistance = record.parentDistance;
+      node->furthestDescendantDistance = record.furthestDescendantDistance;
+      node->minimumBoundDistance = record.minimumBoundDistance;
+      node->dataset = dataset;
+      ar >> data::CreateNVP(node->bound, "bound");
+      ar >> data::CreateNVP(node->stat, "statistic");
+
+      if (record.left != 0)
+      {
+        node->left = new BinarySpaceTree();
+        node->left->parent = node;
+        nodes[record.left] = node->left;
+      }
+      if (record.right != 0)
+      {
+        node->right = new BinarySpaceTree();
+        node->right->parent = node;
+        nodes[record.right] = node->right;
+      }
+    }
+  }
+  catch (...)
+  {
+    // The destructor won't be called, so clean up what we have built.
+    delete left;
+    delete right;
+    delete dataset;
+    throw;
+  }
+}
+
 /**
  * Deletes this node, deallocating the memory for the children and calling their
  * destructors in turn.  This will invalidate any pointers or references to any
@@ -455,6 +648,14 @@ template<typename MetricType,
 BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
     ~BinarySpaceTree()
 {
+  // If this is the root of a compacted tree, the nodes in the pool are
+  // destroyed with the pool.
+  if (nodePool)
+  {
+    DetachPool(*this);
+    FreePool();
+  }
+
   delete left;
   delete right;
 
@@ -719,7 +920,24 @@ template<typename MetricType,
 inline size_t BinarySpaceTree<MetricType, StatisticType, MatType, BoundType,
                               SplitType>::Descendant(const size_t index) const
 {
-  return (begin + index);
+  // The points of a node are contiguous unless it has free columns; then we
+  // have to find the leaf holding the descendant.
+  const BinarySpaceTree* node = this;
+  size_t i = index;
+  while (node->left && node->count != node->capacity)
+  {
+    if (i < node->left->count)
+    {
+      node = node->left;
+    }
+    else
+    {
+      i -= node->left->count;
+      node = node->right;
+    }
+  }
+
+  return (node->begin + i);
 }
 
 /**
@@ -737,6 +955,23 @@ inline size_t BinarySpaceTree<MetricType, StatisticType, MatType, BoundType,
   return (begin + index);
 }
 
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+inline bool BinarySpaceTree<MetricType, StatisticType, MatType, BoundType,
+                            SplitType>::ParallelBuild() const
+{
+#ifdef MLPACK_HAS_OPENMP_TASKS
+  return SplitTraits<Split>::IsDeterministic &&
+      (count >= ParallelBuildThreshold);
+#else
+  return false;
+#endif
+}
+
 template<typename MetricType,
          typename StatisticType,
          typename MatType,
@@ -745,7 +980,7 @@ template<typename MetricType,
              class SplitType>
 void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
     SplitNode(const size_t maxLeafSize,
-              SplitType<BoundType<MetricType>, MatType>& splitter)
+              SplitType<BoundType<MetricType, ElemType>, MatType>& splitter)
 {
   // We need to expand the bounds of this node properly.
   UpdateBound(bound);
@@ -783,13 +1018,30 @@ void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
 
   // Now that we know the split column, we will recursively split the children
   // by calling their constructors (which perform this splitting process).
-  left = new BinarySpaceTree(this, begin, splitCol - begin, splitter,
-      maxLeafSize);
-  right = new BinarySpaceTree(this, splitCol, begin + count - splitCol,
-      splitter, maxLeafSize);
+  // The two children hold disjoint ranges of the dataset, so they can be built
+  // at the same time.
+#ifdef MLPACK_HAS_OPENMP_TASKS
+  if (ParallelBuild())
+  {
+    #pragma omp task shared(splitter)
+    left = new BinarySpaceTree(this, begin, splitCol - begin, splitter,
+        maxLeafSize);
+    #pragma omp task shared(splitter)
+    right = new BinarySpaceTree(this, splitCol, begin + count - splitCol,
+        splitter, maxLeafSize);
+    #pragma omp taskwait
+  }
+  else
+#endif
+  {
+    left = new BinarySpaceTree(this, begin, splitCol - begin, splitter,
+        maxLeafSize);
+    right = new BinarySpaceTree(this, splitCol, begin + count - splitCol,
+        splitter, maxLeafSize);
+  }
 
   // Calculate parent distances for those two nodes.
-  arma::vec center, leftCenter, rightCenter;
+  arma::Col<ElemType> center, leftCenter, rightCenter;
   Center(center);
   left->Center(leftCenter);
   right->Center(rightCenter);
@@ -811,7 +1063,7 @@ template<typename MetricType,
 void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
 SplitNode(std::vector<size_t>& oldFromNew,
           const size_t maxLeafSize,
-          SplitType<BoundType<MetricType>, MatType>& splitter)
+          SplitType<BoundType<MetricType, ElemType>, MatType>& splitter)
 {
   // We need to expand the bounds of this node properly.
   UpdateBound(bound);
@@ -850,13 +1102,30 @@ SplitNode(std::vector<size_t>& oldFromNew,
 
   // Now that we know the split column, we will recursively split the children
   // by calling their constructors (which perform this splitting process).
-  left = new BinarySpaceTree(this, begin, splitCol - begin, oldFromNew,
-      splitter, maxLeafSize);
-  right = new BinarySpaceTree(this, splitCol, begin + count - splitCol,
-      oldFromNew, splitter, maxLeafSize);
+  // The two children hold disjoint ranges of the dataset and of oldFromNew, so
+  // they can be built at the same time.
+#ifdef MLPACK_HAS_OPENMP_TASKS
+  if (ParallelBuild())
+  {
+    #pragma omp task shared(oldFromNew, splitter)
+    left = new BinarySpaceTree(this, begin, splitCol - begin, oldFromNew,
+        splitter, maxLeafSize);
+    #pragma omp task shared(oldFromNew, splitter)
+    right = new BinarySpaceTree(this, splitCol, begin + count - splitCol,
+        oldFromNew, splitter, maxLeafSize);
+    #pragma omp taskwait
+  }
+  else
+#endif
+  {
+    left = new BinarySpaceTree(this, begin, splitCol - begin, oldFromNew,
+        splitter, maxLeafSize);
+    right = new BinarySpaceTree(this, splitCol, begin + count - splitCol,
+        oldFromNew, splitter, maxLeafSize);
+  }
 
   // Calculate parent distances for those two nodes.
-  arma::vec center, leftCenter, rightCenter;
+  arma::Col<ElemType> center, leftCenter, rightCenter;
   Center(center);
   left->Center(leftCenter);
   right->Center(rightCenter);
@@ -890,7 +1159,7 @@ template<typename MetricType,
          template<typename SplitBoundType, typename SplitMatType>
              class SplitType>
 void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
-UpdateBound(bound::HollowBallBound<MetricType>& boundToUpdate)
+UpdateBound(bound::HollowBallBound<MetricType, ElemType>& boundToUpdate)
 {
   if (!parent)
   {
@@ -909,6 +1178,841 @@ UpdateBound(bound::HollowBallBound<MetricType>& boundToUpdate)
     boundToUpdate |= dataset->cols(begin, begin + count - 1);
 }
 
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+template<typename VecType>
+size_t
+BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+InsertPoint(const VecType& point,
+            const size_t maxLeafSize,
+            typename std::enable_if_t<IsVector<VecType>::value>*)
+{
+  return Insert(point, 0, NULL, maxLeafSize);
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+template<typename VecType>
+size_t
+BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+InsertPoint(const VecType& point,
+            const size_t oldIndex,
+            std::vector<size_t>& oldFromNew,
+            const size_t maxLeafSize,
+            typename std::enable_if_t<IsVector<VecType>::value>*)
+{
+  return Insert(point, oldIndex, &oldFromNew, maxLeafSize);
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+bool BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+DeletePoint(const size_t index, const size_t maxLeafSize)
+{
+  return Delete(index, NULL, maxLeafSize);
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+bool BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+DeletePoint(const size_t index,
+            std::vector<size_t>& oldFromNew,
+            const size_t maxLeafSize)
+{
+  return Delete(index, &oldFromNew, maxLeafSize);
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+ShrinkToFit()
+{
+  if (parent != NULL)
+    throw std::invalid_argument("BinarySpaceTree::ShrinkToFit(): only the "
+        "root of a tree can be shrunk");
+
+  if (count == capacity)
+    return;
+
+  std::vector<BinarySpaceTree*> leaves;
+  CollectLeaves(leaves);
+  PackLeaves(leaves, NULL);
+  AssignCapacity(begin, count, NULL);
+  dataset->resize(dataset->n_rows, begin + count);
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+ShrinkToFit(std::vector<size_t>& oldFromNew)
+{
+  if (parent != NULL)
+    throw std::invalid_argument("BinarySpaceTree::ShrinkToFit(): only the "
+        "root of a tree can be shrunk");
+
+  if (count == capacity)
+    return;
+
+  std::vector<BinarySpaceTree*> leaves;
+  CollectLeaves(leaves);
+  PackLeaves(leaves, &oldFromNew);
+  AssignCapacity(begin, count, NULL);
+  dataset->resize(dataset->n_rows, begin + count);
+  oldFromNew.resize(begin + count);
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+RefitBounds()
+{
+  // The bounds of the children are needed first.
+  if (left)
+  {
+    left->RefitBounds();
+    right->RefitBounds();
+  }
+
+  RecomputeBound();
+  RefreshNode();
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+template<typename VecType>
+size_t
+BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+Insert(const VecType& point,
+       const size_t oldIndex,
+       std::vector<size_t>* oldFromNew,
+       const size_t maxLeafSize)
+{
+  std::vector<BinarySpaceTree*> path;
+  InsertionPath(point, path);
+
+  // The point goes in the first free column of the leaf; if there is none, we
+  // have to make room (this moves points, but doesn't change the structure of
+  // the tree).
+  BinarySpaceTree* leaf = path.back();
+  if (leaf->count == leaf->capacity)
+    Reserve(path, oldFromNew);
+
+  size_t index = leaf->begin + leaf->count;
+  dataset->col(index) = point;
+  if (oldFromNew)
+    (*oldFromNew)[index] = oldIndex;
+
+  // Expanding the bounds along the path is enough to keep them valid.
+  for (size_t i = 0; i < path.size(); ++i)
+  {
+    ++path[i]->count;
+    ++path[i]->updates;
+    path[i]->bound |= dataset->cols(index, index);
+  }
+
+  // Rebuild the largest subtree on the path that has changed too much, or else
+  // split the leaf if it holds too many points now.
+  size_t rebuilt = 0;
+  while (rebuilt < path.size() && !path[rebuilt]->NeedsRebuild())
+    ++rebuilt;
+  if (rebuilt == path.size() && leaf->count > maxLeafSize)
+    rebuilt = path.size() - 1;
+
+  if (rebuilt < path.size())
+  {
+    // The nodes below the rebuilt node are gone.
+    BinarySpaceTree* node = path[rebuilt];
+    path.resize(rebuilt + 1);
+
+    const arma::Col<ElemType> inserted = dataset->col(index);
+    node->Rebuild(oldFromNew, maxLeafSize);
+
+    // The points of the node are packed in the order of its leaves now, so the
+    // position of the new point among them gives its index once the free
+    // columns are spread out again.
+    size_t offset = 0;
+    while (offset < node->count)
+    {
+      const size_t col = node->begin + offset;
+      if (oldFromNew ? ((*oldFromNew)[col] == oldIndex) :
+          (arma::accu(dataset->col(col) != inserted) == 0))
+        break;
+      ++offset;
+    }
+
+    node->Spread(NULL, oldFromNew);
+    index = node->Descendant(offset);
+  }
+
+  // Now update the cached distances and statistics from the bottom up.
+  for (size_t i = path.size(); i > 0; --i)
+    path[i - 1]->RefreshNode();
+
+  return index;
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+bool BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+Delete(const size_t index,
+       std::vector<size_t>* oldFromNew,
+       const size_t maxLeafSize)
+{
+  if (index < begin || index >= begin + capacity)
+    return false;
+
+  std::vector<BinarySpaceTree*> path;
+  DeletionPath(index, path);
+
+  // The column may be a free one.
+  BinarySpaceTree* leaf = path.back();
+  if (index >= leaf->begin + leaf->count)
+    return false;
+
+  // The last point of the leaf takes the column of the removed point, and its
+  // own column becomes free.
+  const size_t last = leaf->begin + leaf->count - 1;
+  MoveColumns(last, index, 1, oldFromNew);
+  if (oldFromNew)
+    (*oldFromNew)[last] = size_t(-1);
+
+  for (size_t i = 0; i < path.size(); ++i)
+  {
+    --path[i]->count;
+    ++path[i]->updates;
+  }
+
+  // If the leaf is now empty, remove it.
+  if (leaf->count == 0 && leaf->parent != NULL)
+  {
+    path.pop_back();
+    RemoveLeaf(leaf, oldFromNew);
+  }
+
+  // Rebuild the largest subtree on the path that has changed too much.
+  size_t rebuilt = 0;
+  while (rebuilt < path.size() && !path[rebuilt]->NeedsRebuild())
+    ++rebuilt;
+  if (rebuilt < path.size())
+  {
+    path.resize(rebuilt + 1);
+    path.back()->Rebuild(oldFromNew, maxLeafSize);
+    path.back()->Spread(NULL, oldFromNew);
+  }
+
+  // The bounds may shrink now, so recompute them from the bottom up; the bound
+  // of a rebuilt node is already tight.
+  for (size_t i = path.size(); i > 0; --i)
+  {
+    if (i - 1 != rebuilt)
+      path[i - 1]->RecomputeBound();
+    path[i - 1]->RefreshNode();
+  }
+
+  return true;
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+template<typename VecType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+InsertionPath(const VecType& point, std::vector<BinarySpaceTree*>& path)
+{
+  BinarySpaceTree* node = this;
+  while (true)
+  {
+    path.push_back(node);
+    if (node->IsLeaf())
+      break;
+
+    // Descend into the child whose bound is closest to the point, or the
+    // smaller child if the point is equally close to both.
+    const ElemType leftDistance = node->left->MinDistance(point);
+    const ElemType rightDistance = node->right->MinDistance(point);
+    const bool goLeft = (leftDistance < rightDistance) ||
+        ((leftDistance == rightDistance) &&
+         (node->left->count <= node->right->count));
+
+    node = goLeft ? node->left : node->right;
+  }
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+DeletionPath(const size_t index, std::vector<BinarySpaceTree*>& path)
+{
+  BinarySpaceTree* node = this;
+  while (true)
+  {
+    path.push_back(node);
+    if (node->IsLeaf())
+      break;
+
+    node = (index < node->right->begin) ? node->left : node->right;
+  }
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+Reserve(const std::vector<BinarySpaceTree*>& path,
+        std::vector<size_t>* oldFromNew)
+{
+  // The density threshold of the node at height h above the leaf is
+  // 1 - h / (4 * height), where height is the height of the root.
+  const size_t height = path.size() - 1;
+  for (size_t h = 1; h <= height; ++h)
+  {
+    BinarySpaceTree* node = path[height - h];
+    if (4 * height * (node->count + 1) <= (4 * height - h) * node->capacity)
+    {
+      node->Spread(path.back(), oldFromNew);
+      return;
+    }
+  }
+
+  // The whole tree is too dense, so the dataset has to grow.  Growing it
+  // geometrically keeps the cost of the copies constant per insertion.
+  BinarySpaceTree* root = path.front();
+  const size_t newCapacity = root->count + 1 + (root->count + 1) / 2;
+  dataset->resize(dataset->n_rows, root->begin + newCapacity);
+  if (oldFromNew)
+    oldFromNew->resize(root->begin + newCapacity, size_t(-1));
+
+  root->capacity = newCapacity;
+  root->Spread(path.back(), oldFromNew);
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+Spread(const BinarySpaceTree* full, std::vector<size_t>* oldFromNew)
+{
+  std::vector<BinarySpaceTree*> leaves;
+  CollectLeaves(leaves);
+
+  // First the points are packed to the front of the range, and then they are
+  // moved up to the new ranges of the leaves, starting from the last leaf.
+  // Each pass moves the points in one direction only, so none is overwritten.
+  PackLeaves(leaves, oldFromNew);
+  std::vector<size_t> packedBegins(leaves.size());
+  for (size_t i = 0; i < leaves.size(); ++i)
+    packedBegins[i] = leaves[i]->begin;
+
+  AssignCapacity(begin, capacity, full);
+  for (size_t i = leaves.size(); i > 0; --i)
+  {
+    BinarySpaceTree* leaf = leaves[i - 1];
+    MoveColumns(packedBegins[i - 1], leaf->begin, leaf->count, oldFromNew);
+
+    if (oldFromNew)
+    {
+      for (size_t j = leaf->begin + leaf->count;
+           j < leaf->begin + leaf->capacity; ++j)
+        (*oldFromNew)[j] = size_t(-1);
+    }
+  }
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+AssignCapacity(const size_t newBegin,
+               const size_t newCapacity,
+               const BinarySpaceTree* full)
+{
+  begin = newBegin;
+  capacity = newCapacity;
+  if (IsLeaf())
+    return;
+
+  // Find out which child holds the full leaf, if any.
+  const BinarySpaceTree* child = full;
+  while (child != NULL && child->parent != this)
+    child = child->parent;
+
+  // The free columns are split in proportion to the number of points of each
+  // child, so each child gets at least as many columns as it has points.
+  const size_t leftCount = left->count + ((child == left) ? 1 : 0);
+  const size_t totalCount = count + ((child != NULL) ? 1 : 0);
+  const size_t leftCapacity = leftCount +
+      (newCapacity - totalCount) * leftCount / totalCount;
+
+  left->AssignCapacity(newBegin, leftCapacity, (child == left) ? full : NULL);
+  right->AssignCapacity(newBegin + leftCapacity, newCapacity - leftCapacity,
+      (child == right) ? full : NULL);
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+CollectLeaves(std::vector<BinarySpaceTree*>& leaves)
+{
+  std::vector<BinarySpaceTree*> stack(1, this);
+  while (!stack.empty())
+  {
+    BinarySpaceTree* node = stack.back();
+    stack.pop_back();
+
+    if (node->IsLeaf())
+    {
+      leaves.push_back(node);
+    }
+    else
+    {
+      stack.push_back(node->right);
+      stack.push_back(node->left);
+    }
+  }
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+PackLeaves(const std::vector<BinarySpaceTree*>& leaves,
+           std::vector<size_t>* oldFromNew)
+{
+  size_t packedBegin = begin;
+  for (size_t i = 0; i < leaves.size(); ++i)
+  {
+    MoveColumns(leaves[i]->begin, packedBegin, leaves[i]->count, oldFromNew);
+    leaves[i]->begin = packedBegin;
+    packedBegin += leaves[i]->count;
+  }
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+MoveColumns(const size_t from,
+            const size_t to,
+            const size_t n,
+            std::vector<size_t>* oldFromNew)
+{
+  if (from == to)
+    return;
+
+  // Copy from the front if the columns move down, and from the back otherwise,
+  // so that overlapping ranges work.
+  for (size_t i = 0; i < n; ++i)
+  {
+    const size_t j = (to < from) ? i : (n - 1 - i);
+    dataset->col(to + j) = dataset->col(from + j);
+    if (oldFromNew)
+      (*oldFromNew)[to + j] = (*oldFromNew)[from + j];
+  }
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+Rebuild(std::vector<size_t>* oldFromNew, const size_t maxLeafSize)
+{
+  std::vector<BinarySpaceTree*> leaves;
+  CollectLeaves(leaves);
+  PackLeaves(leaves, oldFromNew);
+
+  // Delete the children; nodes in the node pool of a compacted tree are freed
+  // with the pool.
+  const BinarySpaceTree* root = this;
+  while (root->parent)
+    root = root->parent;
+  DetachPool(*root);
+
+  // Now split the node again, as the constructors do.
+  bound = BoundType<MetricType, ElemType>(dataset->n_rows);
+  updates = 0;
+  SplitType<BoundType<MetricType, ElemType>, MatType> splitter;
+  if (oldFromNew)
+  {
+    #pragma omp parallel if(ParallelBuild())
+    #pragma omp single
+    SplitNode(*oldFromNew, maxLeafSize, splitter);
+  }
+  else
+  {
+    #pragma omp parallel if(ParallelBuild())
+    #pragma omp single
+    SplitNode(maxLeafSize, splitter);
+  }
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+RemoveLeaf(BinarySpaceTree* leaf, std::vector<size_t>* oldFromNew)
+{
+  BinarySpaceTree* node = leaf->parent;
+  BinarySpaceTree* sibling = (node->left == leaf) ? node->right : node->left;
+
+  if (node->left == leaf)
+  {
+    // The range of the leaf comes first, so the points of the first leaf of
+    // the sibling move to the front of it, and the nodes on the left edge of
+    // the sibling take it over.
+    BinarySpaceTree* first = sibling;
+    while (first->left)
+      first = first->left;
+
+    const size_t oldEnd = first->begin + first->count;
+    MoveColumns(first->begin, node->begin, first->count, oldFromNew);
+    if (oldFromNew)
+    {
+      for (size_t i = node->begin + first->count; i < oldEnd; ++i)
+        (*oldFromNew)[i] = size_t(-1);
+    }
+
+    for (BinarySpaceTree* edge = sibling; edge != NULL; edge = edge->left)
+    {
+      edge->begin = node->begin;
+      edge->capacity += leaf->capacity;
+    }
+  }
+  else
+  {
+    // The range of the leaf comes last, so the nodes on the right edge of the
+    // sibling take it over.
+    for (BinarySpaceTree* edge = sibling; edge != NULL; edge = edge->right)
+      edge->capacity += leaf->capacity;
+  }
+
+  // The parent takes over the children of the sibling (which holds all the
+  // points of the parent now).
+  node->left = sibling->left;
+  node->right = sibling->right;
+  if (node->left)
+  {
+    node->left->parent = node;
+    node->right->parent = node;
+  }
+
+  sibling->left = NULL;
+  sibling->right = NULL;
+
+  // Nodes in the node pool of a compacted tree are freed with the pool.
+  const BinarySpaceTree* root = this;
+  while (root->parent)
+    root = root->parent;
+  if (!root->InPool(sibling))
+    delete sibling;
+  if (!root->InPool(leaf))
+    delete leaf;
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+RecomputeBound()
+{
+  bound = BoundType<MetricType, ElemType>(dataset->n_rows);
+  if (IsLeaf())
+  {
+    UpdateBound(bound);
+  }
+  else
+  {
+    bound |= left->bound;
+    bound |= right->bound;
+  }
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+RefreshNode()
+{
+  furthestDescendantDistance = 0.5 * bound.Diameter();
+
+  if (left)
+  {
+    // Calculate parent distances for the children.
+    arma::Col<ElemType> center, leftCenter, rightCenter;
+    Center(center);
+    left->Center(leftCenter);
+    right->Center(rightCenter);
+
+    left->ParentDistance() = MetricType::Evaluate(center, leftCenter);
+    right->ParentDistance() = MetricType::Evaluate(center, rightCenter);
+  }
+
+  // Rebuild the statistic, since the node has changed.
+  stat = StatisticType(*this);
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+    Compact(const NodeOrder order)
+{
+  if (parent != NULL)
+    throw std::invalid_argument("BinarySpaceTree::Compact(): only the root of "
+        "a tree can be compacted");
+
+  // Collect the nodes in the order they will be placed in.  The root is not
+  // moved, so it is left out.
+  std::vector<BinarySpaceTree*> nodes;
+  if (order == DEPTH_FIRST_ORDER)
+  {
+    std::vector<BinarySpaceTree*> stack;
+    if (right)
+      stack.push_back(right);
+    if (left)
+      stack.push_back(left);
+    while (!stack.empty())
+    {
+      BinarySpaceTree* node = stack.back();
+      stack.pop_back();
+      nodes.push_back(node);
+
+      if (node->right)
+        stack.push_back(node->right);
+      if (node->left)
+        stack.push_back(node->left);
+    }
+  }
+  else
+  {
+    // Find the height of the tree.
+    size_t height = 0;
+    std::vector<BinarySpaceTree*> level(1, this);
+    while (!level.empty())
+    {
+      std::vector<BinarySpaceTree*> nextLevel;
+      for (size_t i = 0; i < level.size(); ++i)
+      {
+        if (level[i]->left)
+          nextLevel.push_back(level[i]->left);
+        if (level[i]->right)
+          nextLevel.push_back(level[i]->right);
+      }
+
+      level.swap(nextLevel);
+      ++height;
+    }
+
+    // The root always comes first.
+    VanEmdeBoasOrder(height, nodes);
+    nodes.erase(nodes.begin());
+  }
+
+  BinarySpaceTree* newPool = NULL;
+  if (!nodes.empty())
+  {
+    newPool = static_cast<BinarySpaceTree*>(::operator new(nodes.size() *
+        sizeof(BinarySpaceTree)));
+  }
+
+  // Parents always come before their children, so when a node is moved its
+  // parent has already been moved.  The move constructor points the children
+  // of the node to its new location; the parent is updated here.
+  for (size_t i = 0; i < nodes.size(); ++i)
+  {
+    BinarySpaceTree* node = new (newPool + i)
+        BinarySpaceTree(std::move(*nodes[i]));
+    if (node->parent->left == nodes[i])
+      node->parent->left = node;
+    else
+      node->parent->right = node;
+
+    // The moved-from node holds nothing anymore.
+    if (!InPool(nodes[i]))
+      delete nodes[i];
+  }
+
+  // Any nodes left in the old pool have been moved from, or were removed from
+  // the tree, so they can be destroyed.
+  FreePool();
+  nodePool = newPool;
+  poolSize = nodes.size();
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+    VanEmdeBoasOrder(const size_t height, std::vector<BinarySpaceTree*>& order)
+{
+  if (height == 1)
+  {
+    order.push_back(this);
+    return;
+  }
+
+  // Lay out the top half of the subtree first.
+  const size_t topHeight = height / 2;
+  VanEmdeBoasOrder(topHeight, order);
+
+  // Then lay out each of the subtrees below the top half.
+  std::vector<BinarySpaceTree*> bottomRoots(1, this);
+  for (size_t i = 0; i < topHeight; ++i)
+  {
+    std::vector<BinarySpaceTree*> nextLevel;
+    for (size_t j = 0; j < bottomRoots.size(); ++j)
+    {
+      if (bottomRoots[j]->left)
+        nextLevel.push_back(bottomRoots[j]->left);
+      if (bottomRoots[j]->right)
+        nextLevel.push_back(bottomRoots[j]->right);
+    }
+
+    bottomRoots.swap(nextLevel);
+  }
+
+  for (size_t i = 0; i < bottomRoots.size(); ++i)
+    bottomRoots[i]->VanEmdeBoasOrder(height - topHeight, order);
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+bool BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+    InPool(const BinarySpaceTree* node) const
+{
+  std::less<const BinarySpaceTree*> less;
+  return (nodePool != NULL) && !less(node, nodePool) &&
+      less(node, nodePool + poolSize);
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+    DetachPool(const BinarySpaceTree& root)
+{
+  if (left)
+  {
+    if (root.InPool(left))
+      left->DetachPool(root);
+    else
+      delete left;
+    left = NULL;
+  }
+
+  if (right)
+  {
+    if (root.InPool(right))
+      right->DetachPool(root);
+    else
+      delete right;
+    right = NULL;
+  }
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+    FreePool()
+{
+  for (size_t i = 0; i < poolSize; ++i)
+    nodePool[i].~BinarySpaceTree();
+  ::operator delete(nodePool);
+
+  nodePool = NULL;
+  poolSize = 0;
+}
+
 // Default constructor (private), for boost::serialization.
 template<typename MetricType,
          typename StatisticType,
@@ -923,10 +2027,14 @@ BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
     parent(NULL),
     begin(0),
     count(0),
+    capacity(0),
+    updates(0),
     stat(*this),
     parentDistance(0),
     furthestDescendantDistance(0),
-    dataset(NULL)
+    dataset(NULL),
+    nodePool(NULL),
+    poolSize(0)
 {
   // Nothing to do.
 }
@@ -949,6 +2057,11 @@ void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
   // If we're loading, and we have children, they need to be deleted.
   if (Archive::is_loading::value)
   {
+    if (nodePool)
+    {
+      DetachPool(*this);
+      FreePool();
+    }
     if (left)
       delete left;
     if (right)
@@ -1008,9 +2121,151 @@ void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
       rightParent->Right() = NULL;
       delete rightParent;
     }
+
+    // The capacities are not saved, since the range of each node ends where
+    // the range of the next one starts.
+    if (!parent)
+    {
+      capacity = dataset->n_cols - begin;
+      std::vector<BinarySpaceTree*> stack(1, this);
+      while (!stack.empty())
+      {
+        BinarySpaceTree* node = stack.back();
+        stack.pop_back();
+
+        if (node->left)
+        {
+          node->left->capacity = node->right->begin - node->begin;
+          node->right->capacity = node->begin + node->capacity -
+              node->right->begin;
+          stack.push_back(node->left);
+          stack.push_back(node->right);
+        }
+      }
+    }
   }
 }
 
+/**
+ * Write the tree as a flat image.
+ */
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+    SaveFlat(std::ostream& stream) const
+{
+  // Collect the nodes in breadth-first order, so that children are always
+  // stored after their parent.  The image holds no free columns, so the points
+  // of each node start right after those of the nodes to its left.
+  std::vector<const BinarySpaceTree*> nodes(1, this);
+  std::vector<size_t> packedBegins(1, 0);
+  std::vector<FlatImageNode> table;
+  for (size_t i = 0; i < nodes.size(); ++i)
+  {
+    const BinarySpaceTree* node = nodes[i];
+
+    FlatImageNode record;
+    record.begin = packedBegins[i];
+    record.count = node->count;
+    record.left = 0;
+    record.right = 0;
+    record.parentDistance = node->parentDistance;
+    record.furthestDescendantDistance = node->furthestDescendantDistance;
+    record.minimumBoundDistance = node->minimumBoundDistance;
+    if (node->left)
+    {
+      record.left = nodes.size();
+      nodes.push_back(node->left);
+      packedBegins.push_back(packedBegins[i]);
+    }
+    if (node->right)
+    {
+      record.right = nodes.size();
+      nodes.push_back(node->right);
+      packedBegins.push_back(packedBegins[i] + node->left->count);
+    }
+
+    table.push_back(record);
+  }
+
+  // The bounds and statistics may hold arbitrary types, so they are serialized
+  // in the same order as the table.
+  std::ostringstream extra(std::ios::binary);
+  {
+    boost::archive::binary_oarchive ar(extra);
+    for (size_t i = 0; i < nodes.size(); ++i)
+    {
+      BinarySpaceTree* node = const_cast<BinarySpaceTree*>(nodes[i]);
+      ar << data::CreateNVP(node->bound, "bound");
+      ar << data::CreateNVP(node->stat, "statistic");
+    }
+  }
+  const std::string extraString = extra.str();
+
+  FlatImageHeader header;
+  std::memset(&header, 0, sizeof(FlatImageHeader));
+  std::strncpy(header.magic, "mlpkbst", sizeof(header.magic));
+  header.version = 1;
+  header.elemSize = sizeof(ElemType);
+  header.nRows = dataset->n_rows;
+  header.nCols = count;
+  header.numNodes = nodes.size();
+  header.dataOffset = FlatImageAlign(sizeof(FlatImageHeader));
+  header.nodeOffset = FlatImageAlign(header.dataOffset +
+      header.nRows * header.nCols * sizeof(ElemType));
+  header.extraOffset = FlatImageAlign(header.nodeOffset +
+      header.numNodes * sizeof(FlatImageNode));
+  header.extraSize = extraString.size();
+
+  // Write each section, padding up to its offset.
+  size_t written = 0;
+  const char padding[FlatImageAlignment] = { 0 };
+  auto writeSection = [&](const char* memory, const size_t offset,
+                          const size_t size)
+  {
+    stream.write(padding, offset - written);
+    stream.write(memory, size);
+    written = offset + size;
+  };
+
+  writeSection(reinterpret_cast<const char*>(&header), 0,
+      sizeof(FlatImageHeader));
+
+  // The points are written one leaf after the other, from left to right.
+  size_t dataOffset = header.dataOffset;
+  std::vector<const BinarySpaceTree*> stack(1, this);
+  while (!stack.empty())
+  {
+    const BinarySpaceTree* node = stack.back();
+    stack.pop_back();
+
+    if (node->left)
+    {
+      stack.push_back(node->right);
+      stack.push_back(node->left);
+    }
+    else if (node->count > 0)
+    {
+      const size_t size = header.nRows * node->count * sizeof(ElemType);
+      writeSection(reinterpret_cast<const char*>(dataset->colptr(node->begin)),
+          dataOffset, size);
+      dataOffset += size;
+    }
+  }
+
+  writeSection(reinterpret_cast<const char*>(table.data()), header.nodeOffset,
+      header.numNodes * sizeof(FlatImageNode));
+  writeSection(extraString.data(), header.extraOffset, header.extraSize);
+
+  if (!stream.good())
+    throw std::runtime_error("BinarySpaceTree::SaveFlat(): error writing to "
+        "stream");
+}
+
 } // namespace tree
 } // namespace mlpack
 
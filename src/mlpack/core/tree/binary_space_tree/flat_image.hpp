@@ -0,0 +1,121 @@
+/**
+ * @file flat_image.hpp
+ *
+ * Definitions of the records that make up the flat, pointer-free images of a
+ * BinarySpaceTree written by BinarySpaceTree::SaveFlat(), and of model files
+ * holding such an image.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_BINARY_SPACE_TREE_FLAT_IMAGE_HPP
+#define MLPACK_CORE_TREE_BINARY_SPACE_TREE_FLAT_IMAGE_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <streambuf>
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * The header at the start of a flat tree image.  All offsets are in bytes from
+ * the start of the image, and every section starts at a multiple of
+ * FlatImageAlignment.
+ */
+struct FlatImageHeader
+{
+  //! Identifies the image; always "mlpkbst" (with the terminating zero).
+  char magic[8];
+  //! Version of the layout.
+  uint64_t version;
+  //! Size of one element of the dataset in bytes.
+  uint64_t elemSize;
+  //! Number of rows of the dataset.
+  uint64_t nRows;
+  //! Number of columns of the dataset.
+  uint64_t nCols;
+  //! Number of nodes in the node table.
+  uint64_t numNodes;
+  //! Offset of the dataset, stored in column-major order.
+  uint64_t dataOffset;
+  //! Offset of the node table.
+  uint64_t nodeOffset;
+  //! Offset of the serialized bounds and statistics.
+  uint64_t extraOffset;
+  //! Size of the serialized bounds and statistics.
+  uint64_t extraSize;
+};
+
+/**
+ * One entry of the node table of a flat tree image.  The nodes are stored in
+ * breadth-first order with the root first, so the children of a node always
+ * come after it; a child index of 0 means the child does not exist.
+ */
+struct FlatImageNode
+{
+  //! Index of the first point of the node, relative to the saved node.
+  uint64_t begin;
+  //! Number of points held by the node.
+  uint64_t count;
+  //! Index of the left child in the node table.
+  uint64_t left;
+  //! Index of the right child in the node table.
+  uint64_t right;
+  //! Distance from the centroid of the node to the centroid of its parent.
+  double parentDistance;
+  //! Furthest distance from the centroid to any descendant point.
+  double furthestDescendantDistance;
+  //! Minimum distance from the centroid to the edge of the bound.
+  double minimumBoundDistance;
+};
+
+/**
+ * The header at the start of a flat model file, which holds the flat image of
+ * the model's tree followed by the model's other parameters (serialized with
+ * boost::serialization).  Offsets are in bytes from the start of the file.
+ */
+struct FlatModelHeader
+{
+  //! Identifies the type of model (with the terminating zero).
+  char magic[8];
+  //! Version of the layout.
+  uint64_t version;
+  //! Offset of the tree image.
+  uint64_t treeOffset;
+  //! Offset of the serialized parameters.
+  uint64_t paramsOffset;
+  //! Size of the serialized parameters.
+  uint64_t paramsSize;
+};
+
+//! Alignment of each section of a flat tree image, in bytes.
+const size_t FlatImageAlignment = 64;
+
+//! Round the given offset up to the next multiple of FlatImageAlignment.
+inline size_t FlatImageAlign(const size_t offset)
+{
+  return (offset + FlatImageAlignment - 1) / FlatImageAlignment *
+      FlatImageAlignment;
+}
+
+/**
+ * A read-only std::streambuf over a block of memory, so that sections of a
+ * (possibly memory-mapped) image can be read with boost::serialization without
+ * copying them first.
+ */
+class MemoryStreamBuf : public std::streambuf
+{
+ public:
+  //! Create the buffer over the given memory.
+  MemoryStreamBuf(char* memory, const size_t size)
+  {
+    setg(memory, memory, memory + size);
+  }
+};
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
@@ -15,6 +15,7 @@
 #define MLPACK_CORE_TREE_BINARY_SPACE_TREE_MEAN_SPLIT_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <mlpack/core/tree/split_traits.hpp>
 #include <mlpack/core/tree/perform_split.hpp>
 
 namespace mlpack {
@@ -119,6 +120,17 @@ class MeanSplit
   }
 };
 
+/**
+ * The mean split only depends on the points held in the node, so nodes can be
+ * split in parallel.
+ */
+template<typename BoundType, typename MatType>
+class SplitTraits<MeanSplit<BoundType, MatType>>
+{
+ public:
+  static const bool IsDeterministic = true;
+};
+
 } // namespace tree
 } // namespace mlpack
 
@@ -16,6 +16,7 @@
 #define MLPACK_CORE_TREE_BINARY_SPACE_TREE_MIDPOINT_SPLIT_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <mlpack/core/tree/split_traits.hpp>
 #include <mlpack/core/tree/perform_split.hpp>
 
 namespace mlpack {
@@ -119,6 +120,17 @@ class MidpointSplit
   }
 };
 
+/**
+ * The midpoint split only depends on the bound of the node, so nodes can be
+ * split in parallel.
+ */
+template<typename BoundType, typename MatType>
+class SplitTraits<MidpointSplit<BoundType, MatType>>
+{
+ public:
+  static const bool IsDeterministic = true;
+};
+
 } // namespace tree
 } // namespace mlpack
 
@@ -245,6 +245,21 @@ class TreeTraits<BinarySpaceTree<MetricType, StatisticType, MatType,
   static const bool UniqueNumDescendants = true;
 };
 
+/**
+ * Every BinarySpaceTree can be written as a flat image with SaveFlat().
+ */
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+struct HasFlatImage<BinarySpaceTree<MetricType, StatisticType, MatType,
+                                    BoundType, SplitType>>
+{
+  static const bool value = true;
+};
+
 } // namespace tree
 } // namespace mlpack
 
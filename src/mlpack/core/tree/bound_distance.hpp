@@ -0,0 +1,63 @@
+/**
+ * @file bound_distance.hpp
+ *
+ * Helpers for the distance computations of the bounds that use an LMetric
+ * (HRectBound and CellBound).
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_BOUND_DISTANCE_HPP
+#define MLPACK_CORE_TREE_BOUND_DISTANCE_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace bound {
+
+/**
+ * Raise the given non-negative distance along one dimension to the power of
+ * the metric.  The distance computations of the bounds sum these over the
+ * dimensions, without branches, so that the loops can be vectorized; for
+ * Power = 1 and Power = 2, no call to pow() is made.
+ *
+ * @tparam MetricType LMetric of the bound.
+ * @param value Distance along one dimension.
+ */
+template<typename MetricType, typename ElemType>
+inline ElemType DistancePower(const ElemType value)
+{
+  // The compiler should optimize out this if statement entirely.
+  if (MetricType::Power == 1)
+    return value;
+  else if (MetricType::Power == 2)
+    return value * value;
+  else
+    return std::pow(value, (ElemType) MetricType::Power);
+}
+
+/**
+ * Turn the given sum of powers of the distances along each dimension into a
+ * distance, by taking its Power'th root if the metric takes the root.
+ *
+ * @tparam MetricType LMetric of the bound.
+ * @param sum Sum of the powers of the distances along each dimension.
+ */
+template<typename MetricType, typename ElemType>
+inline ElemType DistanceRoot(const ElemType sum)
+{
+  // The compiler should optimize out this if statement entirely.
+  if (!MetricType::TakeRoot || MetricType::Power == 1)
+    return sum;
+  else if (MetricType::Power == 2)
+    return (ElemType) std::sqrt(sum);
+  else
+    return (ElemType) std::pow((double) sum, 1.0 / (double) MetricType::Power);
+}
+
+} // namespace bound
+} // namespace mlpack
+
+#endif
@@ -38,6 +38,7 @@
 #include <mlpack/core/math/range.hpp>
 #include <mlpack/core/metrics/lmetric.hpp>
 #include "bound_traits.hpp"
+#include "bound_distance.hpp"
 #include "address.hpp"
 
 namespace mlpack {
@@ -11,6 +11,7 @@
  */
 #include "cosine_tree.hpp"
 #include <mlpack/core/util/log.hpp>
+#include <mlpack/core/math/random.hpp>
 
 #include <boost/math/distributions/normal.hpp>
 
@@ -22,18 +23,27 @@ CosineTree::CosineTree(const arma::mat& dataset) :
     parent(NULL),
     left(NULL),
     right(NULL),
-    numColumns(dataset.n_cols)
+    numColumns(dataset.n_cols),
+    basisIndex(0)
 {
   // Initialize sizes of column indices and l2 norms.
   indices.resize(numColumns);
   l2NormsSquared.zeros(numColumns);
 
-  // Set indices and calculate squared norms of the columns.
+  // Set indices and calculate squared norms of the columns, in parallel.
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables. If we're building for Visual Studio, use
+  // the intmax_t type instead.
+  #pragma omp parallel for schedule(static)
+  for (intmax_t i = 0; i < (intmax_t) numColumns; i++)
+#else
+  #pragma omp parallel for schedule(static)
   for (size_t i = 0; i < numColumns; i++)
+#endif
   {
     indices[i] = i;
-    double l2Norm = arma::norm(dataset.col(i), 2);
-    l2NormsSquared(i) = l2Norm * l2Norm;
+    l2NormsSquared(i) = arma::dot(dataset.col(i), dataset.col(i));
   }
 
   // Frobenius norm of columns in the node.
@@ -42,6 +52,7 @@ CosineTree::CosineTree(const arma::mat& dataset) :
   // Calculate centroid of columns in the node.
   CalculateCentroid();
 
+  CalculateDistribution();
   splitPointIndex = ColumnSampleLS();
 }
 
@@ -51,7 +62,8 @@ CosineTree::CosineTree(CosineTree& parentNode,
     parent(&parentNode),
     left(NULL),
     right(NULL),
-    numColumns(subIndices.size())
+    numColumns(subIndices.size()),
+    basisIndex(0)
 {
   // Initialize sizes of column indices and l2 norms.
   indices.resize(numColumns);
@@ -70,16 +82,19 @@ CosineTree::CosineTree(CosineTree& parentNode,
   // Calculate centroid of columns in the node.
   CalculateCentroid();
 
+  CalculateDistribution();
   splitPointIndex = ColumnSampleLS();
 }
 
 CosineTree::CosineTree(const arma::mat& dataset,
                        const double epsilon,
-                       const double delta) :
+                       const double delta,
+                       const size_t splitBatch) :
     dataset(dataset),
     delta(delta),
     left(NULL),
-    right(NULL)
+    right(NULL),
+    basisIndex(0)
 {
   // Declare the cosine tree priority queue.
   CosineNodeQueue treeQueue;
@@ -91,19 +106,33 @@ CosineTree::CosineTree(const arma::mat& dataset,
   root.BasisVector(tempVector);
   treeQueue.push(&root);
 
+  // The basis vectors of the nodes in the queue are also stored as the first
+  // 'basisSize' columns of a matrix, so that the projections onto the basis
+  // are matrix products.  A split node gives its column to its left child.
+  arma::mat basisVectors(dataset.n_rows, 2 * std::max(splitBatch,
+      (size_t) 1), arma::fill::zeros);
+  root.basisIndex = 0;
+  size_t basisSize = 1;
+
   // Initialize Monte Carlo error estimate for comparison.
   double monteCarloError = root.FrobNormSquared();
 
+  std::vector<CosineTree*> splitNodes;
+  std::vector<CosineTree*> children;
   while (monteCarloError > epsilon * root.FrobNormSquared())
   {
-    // Pop node from queue with highest projection error.
-    CosineTree* currentNode;
-    currentNode = treeQueue.top();
-    treeQueue.pop();
-
-    // If the priority is 0, we can't improve anything, and we can assume that
-    // we've done the best we can.
-    if (currentNode->L2Error() == 0.0)
+    // Pop the nodes from the queue with highest projection error.  If the
+    // priority is 0, we can't improve anything, and we can assume that we've
+    // done the best we can.
+    splitNodes.clear();
+    while (splitNodes.size() < std::max(splitBatch, (size_t) 1) &&
+        !treeQueue.empty() && treeQueue.top()->L2Error() != 0.0)
+    {
+      splitNodes.push_back(treeQueue.top());
+      treeQueue.pop();
+    }
+
+    if (splitNodes.empty())
     {
       Log::Warn << "CosineTree::CosineTree(): could not build tree to "
           << "desired relative error " << epsilon << "; failing with estimated "
@@ -112,37 +141,81 @@ CosineTree::CosineTree(const arma::mat& dataset,
       break;
     }
 
-    // Split the node into left and right children.  We assume that this cannot
-    // fail; it might fail if L2Error() is 0, but we have already avoided that
-    // case.
-    currentNode->CosineNodeSplit();
+    // Split the nodes into left and right children, in parallel.
+#ifdef _WIN32
+    #pragma omp parallel for schedule(dynamic)
+    for (intmax_t i = 0; i < (intmax_t) splitNodes.size(); i++)
+#else
+    #pragma omp parallel for schedule(dynamic)
+    for (size_t i = 0; i < splitNodes.size(); i++)
+#endif
+      splitNodes[i]->CosineNodeSplit();
+
+    // Nodes with less than two columns can't be split; their basis vector
+    // stays in the basis and they will not be popped again.
+    children.clear();
+    for (size_t i = 0; i < splitNodes.size(); i++)
+    {
+      CosineTree* node = splitNodes[i];
+      if (!node->Left())
+      {
+        node->L2Error(0.0);
+        treeQueue.push(node);
+        continue;
+      }
+
+      // The left child takes the column of its parent, and the right child a
+      // new one.  Both columns are cleared, so that the parent's basis vector
+      // is no longer part of the basis.
+      if (basisSize == basisVectors.n_cols)
+        basisVectors.resize(dataset.n_rows, 2 * basisVectors.n_cols);
+
+      node->Left()->basisIndex = node->basisIndex;
+      node->Right()->basisIndex = basisSize++;
+      basisVectors.col(node->Left()->basisIndex).zeros();
+      basisVectors.col(node->Right()->basisIndex).zeros();
+
+      children.push_back(node->Left());
+      children.push_back(node->Right());
+    }
 
-    // Obtain pointers to the left and right children of the current node.
-    CosineTree *currentLeft, *currentRight;
-    currentLeft = currentNode->Left();
-    currentRight = currentNode->Right();
+    if (children.empty())
+      continue;
 
-    // Calculate basis vectors of left and right children.
-    arma::vec lBasisVector, rBasisVector;
+    // Calculate basis vectors of the children: orthonormalize their centroids
+    // with respect to the current basis and to each other, all at once.
+    const arma::mat currentBasis(basisVectors.memptr(), dataset.n_rows,
+        basisSize, false, true);
+    arma::mat centroids(dataset.n_rows, children.size());
+    for (size_t i = 0; i < children.size(); i++)
+      centroids.col(i) = children[i]->Centroid();
 
-    ModifiedGramSchmidt(treeQueue, currentLeft->Centroid(), lBasisVector);
-    ModifiedGramSchmidt(treeQueue, currentRight->Centroid(), rBasisVector,
-                        &lBasisVector);
+    BlockGramSchmidt(currentBasis, centroids);
 
     // Add basis vectors to their respective nodes.
-    currentLeft->BasisVector(lBasisVector);
-    currentRight->BasisVector(rBasisVector);
+    for (size_t i = 0; i < children.size(); i++)
+    {
+      arma::vec basisVector = centroids.col(i);
+      children[i]->BasisVector(basisVector);
+      basisVectors.col(children[i]->basisIndex) = basisVector;
+    }
 
-    // Calculate Monte Carlo error estimates for child nodes.
-    MonteCarloError(currentLeft, treeQueue, &lBasisVector, &rBasisVector);
-    MonteCarloError(currentRight, treeQueue, &lBasisVector, &rBasisVector);
+    // Calculate Monte Carlo error estimates for child nodes, in parallel.
+#ifdef _WIN32
+    #pragma omp parallel for schedule(dynamic)
+    for (intmax_t i = 0; i < (intmax_t) children.size(); i++)
+#else
+    #pragma omp parallel for schedule(dynamic)
+    for (size_t i = 0; i < children.size(); i++)
+#endif
+      MonteCarloError(children[i], currentBasis);
 
     // Push child nodes into the priority queue.
-    treeQueue.push(currentLeft);
-    treeQueue.push(currentRight);
+    for (size_t i = 0; i < children.size(); i++)
+      treeQueue.push(children[i]);
 
     // Calculate Monte Carlo error estimate for the root node.
-    monteCarloError = MonteCarloError(&root, treeQueue);
+    monteCarloError = MonteCarloError(&root, currentBasis);
   }
 
   // Construct the subspace basis from the current priority queue.
@@ -195,6 +268,38 @@ double CosineTree::MonteCarloError(CosineTree* node,
                                    CosineNodeQueue& treeQueue,
                                    arma::vec* addBasisVector1,
                                    arma::vec* addBasisVector2)
+{
+  // Set size of basis matrix, depending on whether additional basis vectors
+  // are passed.
+  size_t basisSize;
+  if (addBasisVector1 && addBasisVector2)
+    basisSize = treeQueue.size() + 2;
+  else
+    basisSize = treeQueue.size();
+
+  // Gather the current basis into a matrix.
+  arma::mat basis(node->GetDataset().n_rows, basisSize);
+
+  CosineTree *currentNode;
+  CosineNodeQueue::const_iterator j = treeQueue.begin();
+
+  size_t k = 0;
+  for ( ; j != treeQueue.end(); j++, k++)
+  {
+    currentNode = *j;
+    basis.col(k) = currentNode->BasisVector();
+  }
+  // If two additional vectors are passed, take them into account.
+  if (addBasisVector1 && addBasisVector2)
+  {
+    basis.col(k++) = *addBasisVector1;
+    basis.col(k) = *addBasisVector2;
+  }
+
+  return MonteCarloError(node, basis);
+}
+
+double CosineTree::MonteCarloError(CosineTree* node, const arma::mat& basis)
 {
   std::vector<size_t> sampledIndices;
   arma::vec probabilities;
@@ -204,56 +309,17 @@ double CosineTree::MonteCarloError(CosineTree* node,
   size_t numSamples = log(node->NumColumns()) + 1;
   node->ColumnSamplesLS(sampledIndices, probabilities, numSamples);
 
-  // Get pointer to the original dataset.
-  arma::mat dataset = node->GetDataset();
-
-  // Initialize weighted projection magnitudes as zeros.
-  arma::vec weightedMagnitudes;
-  weightedMagnitudes.zeros(numSamples);
-
-  // Set size of projection vector, depending on whether additional basis
-  // vectors are passed.
-  size_t projectionSize;
-  if (addBasisVector1 && addBasisVector2)
-    projectionSize = treeQueue.size() + 2;
-  else
-    projectionSize = treeQueue.size();
-
-  // For each sample, calculate the weighted projection onto the current basis.
+  // Project all the sampled columns onto the basis at once.
+  const arma::mat& dataset = node->GetDataset();
+  arma::mat samples(dataset.n_rows, numSamples);
   for (size_t i = 0; i < numSamples; i++)
-  {
-    // Initialize projection as a vector of zeros.
-    arma::vec projection;
-    projection.zeros(projectionSize);
-
-    CosineTree *currentNode;
-    CosineNodeQueue::const_iterator j = treeQueue.begin();
+    samples.col(i) = dataset.col(sampledIndices[i]);
 
-    size_t k = 0;
-    // Compute the projection of the sampled vector onto the existing subspace.
-    for ( ; j != treeQueue.end(); j++, k++)
-    {
-      currentNode = *j;
-
-      projection(k) = arma::dot(dataset.col(sampledIndices[i]),
-                                currentNode->BasisVector());
-    }
-    // If two additional vectors are passed, take their projections.
-    if (addBasisVector1 && addBasisVector2)
-    {
-      projection(k++) = arma::dot(dataset.col(sampledIndices[i]),
-                                  *addBasisVector1);
-      projection(k) = arma::dot(dataset.col(sampledIndices[i]),
-                                *addBasisVector2);
-    }
+  const arma::mat projections = basis.t() * samples;
 
-    // Calculate the Frobenius norm squared of the projected vector.
-    double frobProjection = arma::norm(projection, "frob");
-    double frobProjectionSquared = frobProjection * frobProjection;
-
-    // Calculate the weighted projection magnitude.
-    weightedMagnitudes(i) = frobProjectionSquared / probabilities(i);
-  }
+  // Calculate the weighted projection magnitudes.
+  arma::vec weightedMagnitudes =
+      arma::trans(arma::sum(arma::square(projections), 0)) / probabilities;
 
   // Compute mean and standard deviation of the weighted samples.
   double mu = arma::mean(weightedMagnitudes);
@@ -276,6 +342,34 @@ double CosineTree::MonteCarloError(CosineTree* node,
   return (node->FrobNormSquared() - lowerBound);
 }
 
+void CosineTree::BlockGramSchmidt(const arma::mat& basis, arma::mat& vectors)
+{
+  // Remove the projections onto the basis.  Doing it twice makes up for the
+  // loss of orthogonality of a single pass of classical Gram-Schmidt.
+  if (basis.n_cols > 0)
+  {
+    for (size_t pass = 0; pass < 2; pass++)
+      vectors -= basis * (basis.t() * vectors);
+  }
+
+  // Orthonormalize the vectors among themselves.
+  for (size_t i = 0; i < vectors.n_cols; i++)
+  {
+    for (size_t pass = 0; pass < 2; pass++)
+    {
+      for (size_t j = 0; j < i; j++)
+      {
+        vectors.col(i) -= arma::dot(vectors.col(j), vectors.col(i)) *
+            vectors.col(j);
+      }
+    }
+
+    const double norm = arma::norm(vectors.col(i), 2);
+    if (norm)
+      vectors.col(i) /= norm;
+  }
+}
+
 void CosineTree::ConstructBasis(CosineNodeQueue& treeQueue)
 {
   // Initialize basis as matrix of zeros.
@@ -335,25 +429,16 @@ void CosineTree::ColumnSamplesLS(std::vector<size_t>& sampledIndices,
                                  arma::vec& probabilities,
                                  size_t numSamples)
 {
-  // Initialize the cumulative distribution vector size.
-  arma::vec cDistribution;
-  cDistribution.zeros(numColumns + 1);
-
-  // Calculate cumulative length-squared distribution for the node.
-  for (size_t i = 0; i < numColumns; i++)
-  {
-    cDistribution(i + 1) = cDistribution(i) +
-        (l2NormsSquared(i) / frobNormSquared);
-  }
-
   // Initialize sizes of the 'sampledIndices' and 'probabilities' vectors.
   sampledIndices.resize(numSamples);
   probabilities.zeros(numSamples);
 
+  // The cumulative distribution of the node was calculated once, when the node
+  // was created.
   for (size_t i = 0; i < numSamples; i++)
   {
     // Generate a random value for sampling.
-    double randValue = arma::randu();
+    double randValue = math::ThreadRandomStream().Random();
     size_t start = 0, end = numColumns, searchIndex;
 
     // Sample from the distribution and store corresponding probability.
@@ -371,26 +456,15 @@ size_t CosineTree::ColumnSampleLS()
     return 0;
   }
 
-  // Initialize the cumulative distribution vector size.
-  arma::vec cDistribution;
-  cDistribution.zeros(numColumns + 1);
-
-  // Calculate cumulative length-squared distribution for the node.
-  for (size_t i = 0; i < numColumns; i++)
-  {
-    cDistribution(i + 1) = cDistribution(i) +
-        (l2NormsSquared(i) / frobNormSquared);
-  }
-
   // Generate a random value for sampling.
-  double randValue = arma::randu();
+  double randValue = math::ThreadRandomStream().Random();
   size_t start = 0, end = numColumns;
 
   // Sample from the distribution.
   return BinarySearch(cDistribution, randValue, start, end);
 }
 
-size_t CosineTree::BinarySearch(arma::vec& cDistribution,
+size_t CosineTree::BinarySearch(const arma::vec& cDistribution,
                                 double value,
                                 size_t start,
                                 size_t end)
@@ -423,7 +497,13 @@ void CosineTree::CalculateCosines(arma::vec& cosines)
   // Initialize cosine vector as a vector of zeros.
   cosines.zeros(numColumns);
 
+#ifdef _WIN32
+  #pragma omp parallel for schedule(static)
+  for (intmax_t i = 0; i < (intmax_t) numColumns; i++)
+#else
+  #pragma omp parallel for schedule(static)
   for (size_t i = 0; i < numColumns; i++)
+#endif
   {
     // If norm is zero, store cosine value as zero. Else, calculate cosine value
     // between two vectors.
@@ -445,13 +525,48 @@ void CosineTree::CalculateCentroid()
   // Initialize centroid as vector of zeros.
   centroid.zeros(dataset.n_rows);
 
-  // Calculate centroid of columns in the node.
-  for (size_t i = 0; i < numColumns; i++)
+  // Calculate centroid of columns in the node.  Each thread sums the columns
+  // for its own block of rows, so the threads never write to the same entries.
+#ifdef HAS_OPENMP
+  const size_t threads = omp_get_max_threads();
+#else
+  const size_t threads = 1;
+#endif
+  const size_t rowBlock = std::max((size_t) 64,
+      (dataset.n_rows + threads - 1) / threads);
+  const size_t numBlocks = (dataset.n_rows + rowBlock - 1) / rowBlock;
+
+#ifdef _WIN32
+  #pragma omp parallel for schedule(static)
+  for (intmax_t b = 0; b < (intmax_t) numBlocks; b++)
+#else
+  #pragma omp parallel for schedule(static)
+  for (size_t b = 0; b < numBlocks; b++)
+#endif
   {
-    centroid += dataset.col(indices[i]);
+    const size_t begin = b * rowBlock;
+    const size_t end = std::min(begin + rowBlock, (size_t) dataset.n_rows);
+    double* sums = centroid.memptr();
+    for (size_t i = 0; i < numColumns; i++)
+    {
+      const double* column = dataset.colptr(indices[i]);
+      for (size_t r = begin; r < end; r++)
+        sums[r] += column[r];
+    }
   }
   centroid /= numColumns;
 }
 
+void CosineTree::CalculateDistribution()
+{
+  // Calculate cumulative length-squared distribution for the node.
+  cDistribution.zeros(numColumns + 1);
+  for (size_t i = 0; i < numColumns; i++)
+  {
+    cDistribution(i + 1) = cDistribution(i) +
+        (l2NormsSquared(i) / frobNormSquared);
+  }
+}
+
 } // namespace tree
 } // namespace mlpack
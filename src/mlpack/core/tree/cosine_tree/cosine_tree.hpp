@@ -60,13 +60,21 @@ class CosineTree
    * input matrix's projection on the obtained subspace is less than a fraction
    * of the norm of the input matrix.
    *
+   * Up to 'splitBatch' nodes with the largest errors are split at once, in
+   * parallel, and the centroids of all their children are orthonormalized
+   * together (block Gram-Schmidt).  With a batch of one node, this is the
+   * original algorithm; larger batches take fewer steps but may add a few more
+   * basis vectors than needed.
+   *
    * @param dataset Matrix for which the CosineTree is constructed.
    * @param epsilon Error tolerance fraction for calculated subspace.
    * @param delta Cumulative probability for Monte Carlo error lower bound.
+   * @param splitBatch Maximum number of nodes split at each step.
    */
   CosineTree(const arma::mat& dataset,
              const double epsilon,
-             const double delta);
+             const double delta,
+             const size_t splitBatch = 1);
 
   /**
    * Clean up the CosineTree: release allocated memory (including children).
@@ -104,6 +112,30 @@ class CosineTree
                          arma::vec* addBasisVector1 = NULL,
                          arma::vec* addBasisVector2 = NULL);
 
+  /**
+   * Estimates the squared error of the projection of the input node's matrix
+   * onto the subspace spanned by the columns of the given matrix (which must
+   * be orthonormal or zero).  The sampled columns are projected onto the
+   * subspace with a single matrix product.
+   *
+   * @param node Node for which Monte Carlo estimate is calculated.
+   * @param basis Basis vectors of the subspace.
+   */
+  double MonteCarloError(CosineTree* node, const arma::mat& basis);
+
+  /**
+   * Orthonormalize the given vectors with respect to the subspace spanned by
+   * the columns of the given basis, and to each other, with block Gram-Schmidt:
+   * the projections onto the basis are removed twice with matrix products, and
+   * then the vectors are orthonormalized among themselves with modified
+   * Gram-Schmidt.  As in ModifiedGramSchmidt(), vectors are only normalized if
+   * they are not zero.
+   *
+   * @param basis Basis vectors of the subspace (orthonormal or zero).
+   * @param vectors Vectors to orthonormalize, in place.
+   */
+  static void BlockGramSchmidt(const arma::mat& basis, arma::mat& vectors);
+
   /**
    * Constructs the final basis matrix, after the cosine tree construction.
    *
@@ -120,18 +152,19 @@ class CosineTree
 
   /**
    * Sample 'numSamples' points from the Length-Squared distribution of the
-   * cosine node. The function uses 'l2NormsSquared' to calculate the cumulative
-   * probability distribution of the column vectors. The sampling is based on a
-   * randomly generated values in the range [0, 1].
+   * cosine node. The function uses the cumulative probability distribution of
+   * the column vectors, calculated from 'l2NormsSquared' when the node was
+   * created. The sampling is based on a randomly generated values in the range
+   * [0, 1].
    */
   void ColumnSamplesLS(std::vector<size_t>& sampledIndices,
                        arma::vec& probabilities, size_t numSamples);
 
   /**
    * Sample a point from the Length-Squared distribution of the cosine node. The
-   * function uses 'l2NormsSquared' to calculate the cumulative probability
-   * distribution of the column vectors. The sampling is based on a randomly
-   * generated value in the range [0, 1].
+   * function uses the cumulative probability distribution of the column
+   * vectors, calculated from 'l2NormsSquared' when the node was created. The
+   * sampling is based on a randomly generated value in the range [0, 1].
    */
   size_t ColumnSampleLS();
 
@@ -147,7 +180,9 @@ class CosineTree
    * @param start Starting index of the distribution interval to search in.
    * @param end Ending index of the distribution interval to search in.
    */
-  size_t BinarySearch(arma::vec& cDistribution, double value, size_t start,
+  size_t BinarySearch(const arma::vec& cDistribution,
+                      double value,
+                      size_t start,
                       size_t end);
 
   /**
@@ -229,6 +264,8 @@ class CosineTree
   std::vector<size_t> indices;
   //! L2-norm squared of columns in the node.
   arma::vec l2NormsSquared;
+  //! Cumulative length-squared distribution of columns in the node.
+  arma::vec cDistribution;
   //! Centroid of columns of input matrix in the node.
   arma::vec centroid;
   //! Orthonormalized basis vector of the node.
@@ -241,6 +278,12 @@ class CosineTree
   double l2Error;
   //! Frobenius norm squared of columns in the node.
   double frobNormSquared;
+  //! Column of the basis vector of the node in the basis matrix, while the
+  //! tree is constructed.
+  size_t basisIndex;
+
+  //! Calculate the cumulative length-squared distribution of the node.
+  void CalculateDistribution();
 };
 
 class CompareCosineNode
@@ -348,11 +348,12 @@ class CoverTree
   ElemType MinDistance(const CoverTree& other, const ElemType distance) const;
 
   //! Return the minimum distance to another point.
-  ElemType MinDistance(const arma::vec& other) const;
+  ElemType MinDistance(const arma::Col<ElemType>& other) const;
 
   //! Return the minimum distance to another point given that the distance from
   //! the center to the point has already been calculated.
-  ElemType MinDistance(const arma::vec& other, const ElemType distance) const;
+  ElemType MinDistance(const arma::Col<ElemType>& other,
+                       const ElemType distance) const;
 
   //! Return the maximum distance to another node.
   ElemType MaxDistance(const CoverTree& other) const;
@@ -362,11 +363,12 @@ class CoverTree
   ElemType MaxDistance(const CoverTree& other, const ElemType distance) const;
 
   //! Return the maximum distance to another point.
-  ElemType MaxDistance(const arma::vec& other) const;
+  ElemType MaxDistance(const arma::Col<ElemType>& other) const;
 
   //! Return the maximum distance to another point given that the distance from
   //! the center to the point has already been calculated.
-  ElemType MaxDistance(const arma::vec& other, const ElemType distance) const;
+  ElemType MaxDistance(const arma::Col<ElemType>& other,
+                       const ElemType distance) const;
 
   //! Return the minimum and maximum distance to another node.
   math::RangeType<ElemType> RangeDistance(const CoverTree& other) const;
@@ -377,11 +379,12 @@ class CoverTree
                                           const ElemType distance) const;
 
   //! Return the minimum and maximum distance to another point.
-  math::RangeType<ElemType> RangeDistance(const arma::vec& other) const;
+  math::RangeType<ElemType> RangeDistance(
+      const arma::Col<ElemType>& other) const;
 
   //! Return the minimum and maximum distance to another point given that the
   //! point-to-point distance has already been calculated.
-  math::RangeType<ElemType> RangeDistance(const arma::vec& other,
+  math::RangeType<ElemType> RangeDistance(const arma::Col<ElemType>& other,
                                           const ElemType distance) const;
 
   //! Get the parent node.
@@ -409,15 +412,19 @@ class CoverTree
   ElemType MinimumBoundDistance() const { return furthestDescendantDistance; }
 
   //! Get the center of the node and store it in the given vector.
-  void Center(arma::vec& center) const
+  void Center(arma::Col<ElemType>& center) const
   {
-    center = arma::vec(dataset->col(point));
+    center = arma::Col<ElemType>(dataset->col(point));
   }
 
   //! Get the instantiated metric.
   MetricType& Metric() const { return *metric; }
 
  private:
+  //! Point sets with at least this many points have their distances computed
+  //! in parallel during tree building.
+  static const size_t ParallelDistanceThreshold = 4096;
+
   //! Reference to the matrix which this tree is built on.
   const MatType* dataset;
   //! Index of the point in the matrix which this node represents.
@@ -458,7 +465,9 @@ class CoverTree
    * Fill the vector of distances with the distances between the point specified
    * by pointIndex and each point in the indices array.  The distances of the
    * first pointSetSize points in indices are calculated (so, this does not
-   * necessarily need to use all of the points in the arrays).
+   * necessarily need to use all of the points in the arrays).  Large point sets
+   * are split between OpenMP threads; this is where most of the time of tree
+   * building goes.
    *
    * @param pointIndex Point to build the distances for.
    * @param indices List of indices to compute distances for.
@@ -499,7 +508,8 @@ class CoverTree
    * actual contents).
    *
    * The size of any of the four sets can be zero and this method will handle
-   * that case accordingly.
+   * that case accordingly.  The sets are rotated in place, so no memory is
+   * allocated.
    *
    * @param indices List of indices to sort.
    * @param distances List of distances to sort.
@@ -513,6 +523,21 @@ class CoverTree
                       const size_t childUsedSetSize,
                       const size_t farSetSize);
 
+  /**
+   * Move the points in the used set of a child out of the near and far sets
+   * and into the used set.  The child's used set (the childUsedSetSize indices
+   * after the first childFarSetSize indices of childIndices) is sorted, so
+   * that each point of the near and far sets can be looked up quickly.
+   *
+   * @param indices List of indices of this node's point sets.
+   * @param distances List of distances of this node's point sets.
+   * @param nearSetSize Size of the near set; will be updated.
+   * @param farSetSize Size of the far set; will be updated.
+   * @param usedSetSize Size of the used set; will be updated.
+   * @param childIndices List of indices returned by the child.
+   * @param childFarSetSize Number of points in the child's far set.
+   * @param childUsedSetSize Number of points in the child's used set.
+   */
   void MoveToUsedSet(arma::Col<size_t>& indices,
                      arma::vec& distances,
                      size_t& nearSetSize,
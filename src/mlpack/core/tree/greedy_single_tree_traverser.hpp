@@ -15,18 +15,35 @@
 #define MLPACK_CORE_TREE_GREEDY_SINGLE_TREE_TRAVERSER_HPP
 
 #include <mlpack/prereqs.hpp>
+#include "tree_traits.hpp"
 
 namespace mlpack {
 namespace tree {
 
+/**
+ * By default, the traverser follows only the best child of each node, given by
+ * the rules' GetBestChild().  With a beam width B greater than 1, it keeps the
+ * B best nodes of each level instead, ranked by the rules' Score(), and with a
+ * positive backtracking budget, the nodes left out of the beam are visited
+ * afterwards, best first, until that number of base cases has been spent on
+ * them.  A wider beam and a larger budget give better results at the cost of
+ * more base cases; the full single-tree search is the limit.
+ */
 template<typename TreeType, typename RuleType>
 class GreedySingleTreeTraverser
 {
  public:
   /**
    * Instantiate the greedy single tree traverser with the given rule set.
+   *
+   * @param rule The rules of the traversal.
+   * @param beamWidth Number of nodes kept at each level (at least 1).
+   * @param backtrackBudget Number of base cases that may be spent on the nodes
+   *     left out of the beam, for each query point.
    */
-  GreedySingleTreeTraverser(RuleType& rule);
+  GreedySingleTreeTraverser(RuleType& rule,
+                            const size_t beamWidth = 1,
+                            const size_t backtrackBudget = 0);
 
   /**
    * Traverse the tree with the given point.
@@ -40,12 +57,56 @@ class GreedySingleTreeTraverser
   //! Get the number of prunes.
   size_t NumPrunes() const { return numPrunes; }
 
+  //! Get the number of nodes kept at each level.
+  size_t BeamWidth() const { return beamWidth; }
+  //! Modify the number of nodes kept at each level.
+  size_t& BeamWidth() { return beamWidth; }
+
+  //! Get the number of base cases that may be spent on backtracking.
+  size_t BacktrackBudget() const { return backtrackBudget; }
+  //! Modify the number of base cases that may be spent on backtracking.
+  size_t& BacktrackBudget() { return backtrackBudget; }
+
  private:
+  //! A node and its score.
+  typedef std::pair<double, TreeType*> Candidate;
+
+  //! Traverse the tree with a beam, then backtrack.
+  void BeamTraverse(const size_t queryIndex, TreeType& referenceNode);
+
+  /**
+   * Run the base cases with the points of the given node.  If the node was
+   * scored, the base case with its centroid was already computed by Score().
+   */
+  void BaseCases(const size_t queryIndex,
+                 TreeType& referenceNode,
+                 const bool scored);
+
+  /**
+   * Score the children of the given node, and add the ones that aren't pruned
+   * to the given list.
+   */
+  void ScoreChildren(const size_t queryIndex,
+                     TreeType& referenceNode,
+                     std::vector<Candidate>& children);
+
   //! Reference to the rules with which the tree will be traversed.
   RuleType& rule;
 
   //! The number of nodes which have been pruned during traversal.
   size_t numPrunes;
+
+  //! The number of nodes kept at each level.
+  size_t beamWidth;
+  //! The number of base cases that may be spent on backtracking.
+  size_t backtrackBudget;
+
+  //! The nodes of the current level of the beam.
+  std::vector<TreeType*> level;
+  //! The scored children of the current level.
+  std::vector<Candidate> children;
+  //! The nodes left out of the beam (a min-heap on the score).
+  std::vector<Candidate> frontier;
 };
 
 } // namespace tree
@@ -22,9 +22,13 @@ namespace tree {
 
 template<typename TreeType, typename RuleType>
 GreedySingleTreeTraverser<TreeType, RuleType>::GreedySingleTreeTraverser(
-    RuleType& rule) :
+    RuleType& rule,
+    const size_t beamWidth,
+    const size_t backtrackBudget) :
     rule(rule),
-    numPrunes(0)
+    numPrunes(0),
+    beamWidth(beamWidth),
+    backtrackBudget(backtrackBudget)
 { /* Nothing to do. */ }
 
 template<typename TreeType, typename RuleType>
@@ -32,6 +36,12 @@ void GreedySingleTreeTraverser<TreeType, RuleType>::Traverse(
     const size_t queryIndex,
     TreeType& referenceNode)
 {
+  if (beamWidth > 1 || backtrackBudget > 0)
+  {
+    BeamTraverse(queryIndex, referenceNode);
+    return;
+  }
+
   // Run the base case as necessary for all the points in the reference node.
   for (size_t i = 0; i < referenceNode.NumPoints(); ++i)
     rule.BaseCase(queryIndex, referenceNode.Point(i));
@@ -46,6 +56,116 @@ void GreedySingleTreeTraverser<TreeType, RuleType>::Traverse(
   }
 }
 
+template<typename TreeType, typename RuleType>
+void GreedySingleTreeTraverser<TreeType, RuleType>::BeamTraverse(
+    const size_t queryIndex,
+    TreeType& referenceNode)
+{
+  // The frontier is a min-heap on the score.
+  auto scoreLess = [](const Candidate& a, const Candidate& b)
+      { return a.first < b.first; };
+  auto compare = [](const Candidate& a, const Candidate& b)
+      { return a.first > b.first; };
+
+  // Score the root too, so that trees with self-children cache its base case.
+  frontier.clear();
+  level.assign(1, &referenceNode);
+  rule.Score(queryIndex, referenceNode);
+  BaseCases(queryIndex, referenceNode, true);
+
+  while (!level.empty())
+  {
+    children.clear();
+    for (size_t i = 0; i < level.size(); ++i)
+      ScoreChildren(queryIndex, *level[i], children);
+
+    // Keep the best children in the beam; the others may be visited when
+    // backtracking.
+    const size_t kept = std::min(std::max(beamWidth, (size_t) 1),
+        children.size());
+    std::partial_sort(children.begin(), children.begin() + kept,
+        children.end(), scoreLess);
+
+    level.clear();
+    for (size_t i = 0; i < kept; ++i)
+    {
+      level.push_back(children[i].second);
+      BaseCases(queryIndex, *children[i].second, true);
+    }
+
+    for (size_t i = kept; i < children.size(); ++i)
+    {
+      if (backtrackBudget == 0)
+      {
+        ++numPrunes;
+        continue;
+      }
+
+      frontier.push_back(children[i]);
+      std::push_heap(frontier.begin(), frontier.end(), compare);
+    }
+  }
+
+  // Visit the best nodes left out of the beam until the budget is spent.
+  const size_t budgetStart = rule.BaseCases();
+  while (!frontier.empty() && rule.BaseCases() - budgetStart < backtrackBudget)
+  {
+    std::pop_heap(frontier.begin(), frontier.end(), compare);
+    Candidate candidate = frontier.back();
+    frontier.pop_back();
+
+    // The bound may have improved since the node was scored.
+    if (rule.Rescore(queryIndex, *candidate.second, candidate.first) ==
+        DBL_MAX)
+    {
+      ++numPrunes;
+      continue;
+    }
+
+    BaseCases(queryIndex, *candidate.second, true);
+
+    children.clear();
+    ScoreChildren(queryIndex, *candidate.second, children);
+    for (size_t i = 0; i < children.size(); ++i)
+    {
+      frontier.push_back(children[i]);
+      std::push_heap(frontier.begin(), frontier.end(), compare);
+    }
+  }
+
+  numPrunes += frontier.size();
+}
+
+template<typename TreeType, typename RuleType>
+void GreedySingleTreeTraverser<TreeType, RuleType>::BaseCases(
+    const size_t queryIndex,
+    TreeType& referenceNode,
+    const bool scored)
+{
+  // Score() computes the base case with the centroid of trees with
+  // self-children.
+  const size_t first = (scored && TreeTraits<TreeType>::FirstPointIsCentroid &&
+      TreeTraits<TreeType>::HasSelfChildren) ? 1 : 0;
+  for (size_t i = first; i < referenceNode.NumPoints(); ++i)
+    rule.BaseCase(queryIndex, referenceNode.Point(i));
+}
+
+template<typename TreeType, typename RuleType>
+void GreedySingleTreeTraverser<TreeType, RuleType>::ScoreChildren(
+    const size_t queryIndex,
+    TreeType& referenceNode,
+    std::vector<Candidate>& children)
+{
+  for (size_t i = 0; i < referenceNode.NumChildren(); ++i)
+  {
+    const double score = rule.Score(queryIndex, referenceNode.Child(i));
+    if (score == DBL_MAX)
+      ++numPrunes;
+    else
+      children.push_back(Candidate(score, &referenceNode.Child(i)));
+  }
+}
+
 } // namespace tree
 } // namespace mlpack
 
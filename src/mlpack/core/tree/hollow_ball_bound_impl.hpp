@@ -122,9 +122,10 @@ math::RangeType<ElemType> HollowBallBound<TMetricType, ElemType>::operator[](
     const size_t i) const
 {
   if (radii.Hi() < 0)
-    return math::Range();
+    return math::RangeType<ElemType>();
   else
-    return math::Range(center[i] - radii.Hi(), center[i] + radii.Hi());
+    return math::RangeType<ElemType>(center[i] - radii.Hi(),
+                                     center[i] + radii.Hi());
 }
 
 /**
@@ -286,8 +287,8 @@ math::RangeType<ElemType> HollowBallBound<TMetricType, ElemType>::RangeDistance(
     typename std::enable_if_t<IsVector<VecType>::value>* /* junk */) const
 {
   if (radii.Hi() < 0)
-    return math::Range(std::numeric_limits<ElemType>::max(),
-                       std::numeric_limits<ElemType>::max());
+    return math::RangeType<ElemType>(std::numeric_limits<ElemType>::max(),
+                                     std::numeric_limits<ElemType>::max());
   else
   {
     math::RangeType<ElemType> range;
@@ -312,8 +313,8 @@ math::RangeType<ElemType> HollowBallBound<TMetricType, ElemType>::RangeDistance(
     const HollowBallBound& other) const
 {
   if (radii.Hi() < 0)
-    return math::Range(std::numeric_limits<ElemType>::max(),
-                       std::numeric_limits<ElemType>::max());
+    return math::RangeType<ElemType>(std::numeric_limits<ElemType>::max(),
+                                     std::numeric_limits<ElemType>::max());
   else
   {
     math::RangeType<ElemType> range;
@@ -18,6 +18,7 @@
 #include <mlpack/core/math/range.hpp>
 #include <mlpack/core/metrics/lmetric.hpp>
 #include "bound_traits.hpp"
+#include "bound_distance.hpp"
 
 namespace mlpack {
 namespace bound {
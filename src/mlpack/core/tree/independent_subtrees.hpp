@@ -0,0 +1,148 @@
+/**
+ * @file independent_subtrees.hpp
+ *
+ * A utility to split a tree into a set of subtrees that hold disjoint sets of
+ * points.  These subtrees can then be used as independent units of work for
+ * parallel traversals.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_INDEPENDENT_SUBTREES_HPP
+#define MLPACK_CORE_TREE_INDEPENDENT_SUBTREES_HPP
+
+#include <mlpack/prereqs.hpp>
+#include "tree_traits.hpp"
+#include <queue>
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * Split the tree rooted at the given node into a set of subtrees whose
+ * descendant points are disjoint, and which together hold every descendant
+ * point of the node.  The largest subtree is expanded until at least
+ * minSubtrees subtrees are found or no subtree can be expanded any further.
+ *
+ * A node is only expanded if all of its points are also held by its children
+ * (that is, it holds no points itself, or the tree has self-children).  Trees
+ * where the children of a node may share points (that is, trees where
+ * TreeTraits::UniqueNumDescendants is false, like spill trees) are never
+ * expanded, so the root alone is returned.
+ *
+ * The subtrees are returned in decreasing order of size, which is a good order
+ * for dynamic scheduling.
+ *
+ * The nodes that were expanded (that is, the nodes above the subtrees) are
+ * also returned, in an order where each node comes after its parent.  They are
+ * useful for algorithms that have to visit these nodes before or after the
+ * subtrees.
+ *
+ * @param root Root of the tree to split.
+ * @param minSubtrees Minimum number of subtrees to find.
+ * @param subtrees Vector to store the subtrees in.
+ * @param expanded Vector to store the expanded nodes in.
+ */
+template<typename TreeType>
+void IndependentSubtrees(TreeType& root,
+                         const size_t minSubtrees,
+                         std::vector<TreeType*>& subtrees,
+                         std::vector<TreeType*>& expanded)
+{
+  typedef std::pair<size_t, TreeType*> NodeAndSize;
+
+  // Larger nodes are expanded first.
+  struct NodeCmp
+  {
+    bool operator()(const NodeAndSize& a, const NodeAndSize& b) const
+    {
+      return a.first < b.first;
+    }
+  };
+
+  std::priority_queue<NodeAndSize, std::vector<NodeAndSize>, NodeCmp> queue;
+  queue.push(NodeAndSize(root.NumDescendants(), &root));
+
+  // Nodes that can't be expanded any further.
+  std::vector<NodeAndSize> finished;
+  expanded.clear();
+
+  if (!TreeTraits<TreeType>::UniqueNumDescendants)
+  {
+    finished.push_back(queue.top());
+    queue.pop();
+  }
+
+  while (!queue.empty() && (queue.size() + finished.size() < minSubtrees))
+  {
+    TreeType* node = queue.top().second;
+    const size_t size = queue.top().first;
+    queue.pop();
+
+    if (node->IsLeaf() || (!TreeTraits<TreeType>::HasSelfChildren &&
+        node->NumPoints() > 0))
+    {
+      finished.push_back(NodeAndSize(size, node));
+      continue;
+    }
+
+    expanded.push_back(node);
+    for (size_t i = 0; i < node->NumChildren(); ++i)
+      queue.push(NodeAndSize(node->Child(i).NumDescendants(),
+          &node->Child(i)));
+  }
+
+  while (!queue.empty())
+  {
+    finished.push_back(queue.top());
+    queue.pop();
+  }
+
+  std::sort(finished.begin(), finished.end(), [](const NodeAndSize& a,
+      const NodeAndSize& b) { return a.first > b.first; });
+
+  subtrees.clear();
+  subtrees.reserve(finished.size());
+  for (size_t i = 0; i < finished.size(); ++i)
+    subtrees.push_back(finished[i].second);
+}
+
+/**
+ * Split the tree rooted at the given node into a set of subtrees whose
+ * descendant points are disjoint.  See the other overload for details.
+ *
+ * @param root Root of the tree to split.
+ * @param minSubtrees Minimum number of subtrees to find.
+ * @param subtrees Vector to store the subtrees in.
+ */
+template<typename TreeType>
+void IndependentSubtrees(TreeType& root,
+                         const size_t minSubtrees,
+                         std::vector<TreeType*>& subtrees)
+{
+  std::vector<TreeType*> expanded;
+  IndependentSubtrees(root, minSubtrees, subtrees, expanded);
+}
+
+/**
+ * Sort the given subtrees in the order of their points in the dataset (that
+ * is, by the index of their first descendant).  For trees that keep the points
+ * of each node contiguous, like BinarySpaceTree, a static schedule over the
+ * sorted subtrees gives each thread a contiguous range of the dataset, which
+ * is what NUMA placement needs.
+ *
+ * @param subtrees Subtrees to sort.
+ */
+template<typename TreeType>
+void SortByDatasetOrder(std::vector<TreeType*>& subtrees)
+{
+  std::sort(subtrees.begin(), subtrees.end(), [](const TreeType* a,
+      const TreeType* b) { return a->Descendant(0) < b->Descendant(0); });
+}
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
@@ -50,7 +50,7 @@ class Octree
   size_t count;
   //! The minimum bounding rectangle of the points held in the node (and its
   //! children).
-  bound::HRectBound<MetricType> bound;
+  bound::HRectBound<MetricType, ElemType> bound;
   //! The dataset.
   MatType* dataset;
   //! The parent (NULL if this node is the root).
@@ -173,7 +173,7 @@ class Octree
   Octree(Octree* parent,
          const size_t begin,
          const size_t count,
-         const arma::vec& center,
+         const arma::Col<ElemType>& center,
          const double width,
          const size_t maxLeafSize = 20);
 
@@ -201,7 +201,7 @@ class Octree
          const size_t begin,
          const size_t count,
          std::vector<size_t>& oldFromNew,
-         const arma::vec& center,
+         const arma::Col<ElemType>& center,
          const double width,
          const size_t maxLeafSize = 20);
 
@@ -244,9 +244,9 @@ class Octree
   Octree*& Parent() { return parent; }
 
   //! Return the bound object for this node.
-  const bound::HRectBound<MetricType>& Bound() const { return bound; }
+  const bound::HRectBound<MetricType, ElemType>& Bound() const { return bound; }
   //! Modify the bound object for this node.
-  bound::HRectBound<MetricType>& Bound() { return bound; }
+  bound::HRectBound<MetricType, ElemType>& Bound() { return bound; }
 
   //! Return the statistic object for this node.
   const StatisticType& Stat() const { return stat; }
@@ -380,7 +380,7 @@ class Octree
       typename std::enable_if_t<IsVector<VecType>::value>* = 0) const;
 
   //! Store the center of the bounding region in the given vector.
-  void Center(arma::vec& center) const { bound.Center(center); }
+  void Center(arma::Col<ElemType>& center) const { bound.Center(center); }
 
   //! Serialize the tree.
   template<typename Archive>
@@ -399,6 +399,82 @@ class Octree
   friend class boost::serialization::access;
 
  private:
+  //! Nodes with at least this many points build their children as separate
+  //! OpenMP tasks.
+  static const size_t ParallelBuildThreshold = 1024;
+
+  /**
+   * Construct this node as a child of the given parent, from the sorted Morton
+   * codes of the points (see MortonBuild()).
+   *
+   * @param parent Parent of this node.
+   * @param begin Index of point to start tree construction with.
+   * @param count Number of points to use to construct tree.
+   * @param oldFromNew Mappings from old to new.
+   * @param center Center of the node (for splitting).
+   * @param width Width of the node in each dimension.
+   * @param maxLeafSize Maximum number of points in a leaf node.
+   * @param codes Sorted Morton codes of the points.
+   * @param level Level of the node below the root.
+   */
+  Octree(Octree* parent,
+         const size_t begin,
+         const size_t count,
+         std::vector<size_t>& oldFromNew,
+         const arma::Col<ElemType>& center,
+         const double width,
+         const size_t maxLeafSize,
+         const std::vector<uint64_t>& codes,
+         const size_t level);
+
+  /**
+   * Build the tree below this root node in the style of a linear octree.  The
+   * Morton code of each point holds the index of the child that holds the
+   * point at each level below the root (found with the same comparisons as
+   * SplitNode()), so once the points are sorted by code, the points of each
+   * node are contiguous, with its children in order, and the children are
+   * found by binary search on the codes.  The codes are computed in parallel
+   * and radix-sorted once, and the subtrees are built as OpenMP tasks.  The
+   * nodes are the same as SplitNode() would give, but the points of a leaf
+   * may be in a different order; nodes still too large at the last level the
+   * codes hold are split with SplitNode().
+   *
+   * @param center Center of the node.
+   * @param width Width of the current node.
+   * @param oldFromNew Mappings from old to new.
+   * @param maxLeafSize Maximum number of points allowed in a leaf.
+   */
+  void MortonBuild(const arma::Col<ElemType>& center,
+                   const double width,
+                   std::vector<size_t>& oldFromNew,
+                   const size_t maxLeafSize);
+
+  /**
+   * Split the node from the sorted Morton codes of the points.
+   *
+   * @param center Center of the node.
+   * @param width Width of the current node.
+   * @param oldFromNew Mappings from old to new.
+   * @param maxLeafSize Maximum number of points allowed in a leaf.
+   * @param codes Sorted Morton codes of the points.
+   * @param level Level of the node below the root.
+   */
+  void MortonSplitNode(const arma::Col<ElemType>& center,
+                       const double width,
+                       std::vector<size_t>& oldFromNew,
+                       const size_t maxLeafSize,
+                       const std::vector<uint64_t>& codes,
+                       const size_t level);
+
+  /**
+   * Sort the given codes with a parallel radix sort on their lowest bits, and
+   * fill order with the original index of each sorted code.  The sort is
+   * stable.
+   */
+  static void SortByCode(std::vector<uint64_t>& codes,
+                         std::vector<size_t>& order,
+                         const size_t bits);
+
   /**
    * Split the node, using the given center and the given maximum width of this
    * node.
@@ -407,7 +483,7 @@ class Octree
    * @param width Width of the current node.
    * @param maxLeafSize Maximum number of points allowed in a leaf.
    */
-  void SplitNode(const arma::vec& center,
+  void SplitNode(const arma::Col<ElemType>& center,
                  const double width,
                  const size_t maxLeafSize);
 
@@ -420,7 +496,7 @@ class Octree
    * @param oldFromNew Mappings from old to new.
    * @param maxLeafSize Maximum number of points allowed in a leaf.
    */
-  void SplitNode(const arma::vec& center,
+  void SplitNode(const arma::Col<ElemType>& center,
                  const double width,
                  std::vector<size_t>& oldFromNew,
                  const size_t maxLeafSize);
@@ -431,12 +507,12 @@ class Octree
   struct SplitInfo
   {
     //! Create the SplitInfo object.
-    SplitInfo(const size_t d, const arma::vec& c) : d(d), center(c) {}
+    SplitInfo(const size_t d, const arma::Col<ElemType>& c) : d(d), center(c) {}
 
     //! The dimension we are splitting on.
     size_t d;
     //! The center of the node.
-    const arma::vec& center;
+    const arma::Col<ElemType>& center;
 
     template<typename VecType>
     static bool AssignToLeftNode(const VecType& point, const SplitInfo& s)
@@ -34,7 +34,7 @@ Octree<MetricType, StatisticType, MatType>::Octree(const MatType& dataset,
   {
     // Calculate empirical center of data.
     bound |= *this->dataset;
-    arma::vec center;
+    arma::Col<ElemType> center;
     bound.Center(center);
 
     double maxWidth = 0.0;
@@ -42,7 +42,12 @@ Octree<MetricType, StatisticType, MatType>::Octree(const MatType& dataset,
       if (bound[i].Hi() - bound[i].Lo() > maxWidth)
         maxWidth = bound[i].Hi() - bound[i].Lo();
 
-    SplitNode(center, maxWidth, maxLeafSize);
+    // The permutation of the points isn't returned.
+    std::vector<size_t> oldFromNew(count);
+    for (size_t i = 0; i < count; ++i)
+      oldFromNew[i] = i;
+
+    MortonBuild(center, maxWidth, oldFromNew, maxLeafSize);
 
     furthestDescendantDistance = 0.5 * bound.Diameter();
   }
@@ -76,7 +81,7 @@ Octree<MetricType, StatisticType, MatType>::Octree(
   {
     // Calculate empirical center of data.
     bound |= *this->dataset;
-    arma::vec center;
+    arma::Col<ElemType> center;
     bound.Center(center);
 
     double maxWidth = 0.0;
@@ -84,7 +89,7 @@ Octree<MetricType, StatisticType, MatType>::Octree(
       if (bound[i].Hi() - bound[i].Lo() > maxWidth)
         maxWidth = bound[i].Hi() - bound[i].Lo();
 
-    SplitNode(center, maxWidth, oldFromNew, maxLeafSize);
+    MortonBuild(center, maxWidth, oldFromNew, maxLeafSize);
 
     furthestDescendantDistance = 0.5 * bound.Diameter();
   }
@@ -119,7 +124,7 @@ Octree<MetricType, StatisticType, MatType>::Octree(
   {
     // Calculate empirical center of data.
     bound |= *this->dataset;
-    arma::vec center;
+    arma::Col<ElemType> center;
     bound.Center(center);
 
     double maxWidth = 0.0;
@@ -127,7 +132,7 @@ Octree<MetricType, StatisticType, MatType>::Octree(
       if (bound[i].Hi() - bound[i].Lo() > maxWidth)
         maxWidth = bound[i].Hi() - bound[i].Lo();
 
-    SplitNode(center, maxWidth, oldFromNew, maxLeafSize);
+    MortonBuild(center, maxWidth, oldFromNew, maxLeafSize);
 
     furthestDescendantDistance = 0.5 * bound.Diameter();
   }
@@ -160,7 +165,7 @@ Octree<MetricType, StatisticType, MatType>::Octree(MatType&& dataset,
   {
     // Calculate empirical center of data.
     bound |= *this->dataset;
-    arma::vec center;
+    arma::Col<ElemType> center;
     bound.Center(center);
 
     double maxWidth = 0.0;
@@ -168,7 +173,12 @@ Octree<MetricType, StatisticType, MatType>::Octree(MatType&& dataset,
       if (bound[i].Hi() - bound[i].Lo() > maxWidth)
         maxWidth = bound[i].Hi() - bound[i].Lo();
 
-    SplitNode(center, maxWidth, maxLeafSize);
+    // The permutation of the points isn't returned.
+    std::vector<size_t> oldFromNew(count);
+    for (size_t i = 0; i < count; ++i)
+      oldFromNew[i] = i;
+
+    MortonBuild(center, maxWidth, oldFromNew, maxLeafSize);
 
     furthestDescendantDistance = 0.5 * bound.Diameter();
   }
@@ -202,7 +212,7 @@ Octree<MetricType, StatisticType, MatType>::Octree(
   {
     // Calculate empirical center of data.
     bound |= *this->dataset;
-    arma::vec center;
+    arma::Col<ElemType> center;
     bound.Center(center);
 
     double maxWidth = 0.0;
@@ -210,7 +220,7 @@ Octree<MetricType, StatisticType, MatType>::Octree(
       if (bound[i].Hi() - bound[i].Lo() > maxWidth)
         maxWidth = bound[i].Hi() - bound[i].Lo();
 
-    SplitNode(center, maxWidth, oldFromNew, maxLeafSize);
+    MortonBuild(center, maxWidth, oldFromNew, maxLeafSize);
 
     furthestDescendantDistance = 0.5 * bound.Diameter();
   }
@@ -245,7 +255,7 @@ Octree<MetricType, StatisticType, MatType>::Octree(
   {
     // Calculate empirical center of data.
     bound |= *this->dataset;
-    arma::vec center;
+    arma::Col<ElemType> center;
     bound.Center(center);
 
     double maxWidth = 0.0;
@@ -253,7 +263,7 @@ Octree<MetricType, StatisticType, MatType>::Octree(
       if (bound[i].Hi() - bound[i].Lo() > maxWidth)
         maxWidth = bound[i].Hi() - bound[i].Lo();
 
-    SplitNode(center, maxWidth, oldFromNew, maxLeafSize);
+    MortonBuild(center, maxWidth, oldFromNew, maxLeafSize);
 
     furthestDescendantDistance = 0.5 * bound.Diameter();
   }
@@ -277,7 +287,7 @@ Octree<MetricType, StatisticType, MatType>::Octree(
     Octree* parent,
     const size_t begin,
     const size_t count,
-    const arma::vec& center,
+    const arma::Col<ElemType>& center,
     const double width,
     const size_t maxLeafSize) :
     begin(begin),
@@ -294,7 +304,7 @@ Octree<MetricType, StatisticType, MatType>::Octree(
 
   // Calculate the distance from the empirical center of this node to the
   // empirical center of the parent.
-  arma::vec trueCenter, parentCenter;
+  arma::Col<ElemType> trueCenter, parentCenter;
   bound.Center(trueCenter);
   parent->Bound().Center(parentCenter);
   parentDistance = metric.Evaluate(trueCenter, parentCenter);
@@ -312,7 +322,7 @@ Octree<MetricType, StatisticType, MatType>::Octree(
     const size_t begin,
     const size_t count,
     std::vector<size_t>& oldFromNew,
-    const arma::vec& center,
+    const arma::Col<ElemType>& center,
     const double width,
     const size_t maxLeafSize) :
     begin(begin),
@@ -329,7 +339,44 @@ Octree<MetricType, StatisticType, MatType>::Octree(
 
   // Calculate the distance from the empirical center of this node to the
   // empirical center of the parent.
-  arma::vec trueCenter, parentCenter;
+  arma::Col<ElemType> trueCenter, parentCenter;
+  bound.Center(trueCenter);
+  parent->Bound().Center(parentCenter);
+  parentDistance = metric.Evaluate(trueCenter, parentCenter);
+
+  furthestDescendantDistance = 0.5 * bound.Diameter();
+
+  // Initialize the statistic.
+  stat = StatisticType(*this);
+}
+
+//! Construct a child node from the sorted Morton codes.
+template<typename MetricType, typename StatisticType, typename MatType>
+Octree<MetricType, StatisticType, MatType>::Octree(
+    Octree* parent,
+    const size_t begin,
+    const size_t count,
+    std::vector<size_t>& oldFromNew,
+    const arma::Col<ElemType>& center,
+    const double width,
+    const size_t maxLeafSize,
+    const std::vector<uint64_t>& codes,
+    const size_t level) :
+    begin(begin),
+    count(count),
+    bound(parent->dataset->n_rows),
+    dataset(parent->dataset),
+    parent(parent)
+{
+  // Calculate empirical center of data.
+  bound |= dataset->cols(begin, begin + count - 1);
+
+  // Now split the node.
+  MortonSplitNode(center, width, oldFromNew, maxLeafSize, codes, level);
+
+  // Calculate the distance from the empirical center of this node to the
+  // empirical center of the parent.
+  arma::Col<ElemType> trueCenter, parentCenter;
   bound.Center(trueCenter);
   parent->Bound().Center(parentCenter);
   parentDistance = metric.Evaluate(trueCenter, parentCenter);
@@ -706,7 +753,7 @@ void Octree<MetricType, StatisticType, MatType>::Serialize(
 //! Split the node.
 template<typename MetricType, typename StatisticType, typename MatType>
 void Octree<MetricType, StatisticType, MatType>::SplitNode(
-    const arma::vec& center,
+    const arma::Col<ElemType>& center,
     const double width,
     const size_t maxLeafSize)
 {
@@ -780,7 +827,7 @@ void Octree<MetricType, StatisticType, MatType>::SplitNode(
   }
 
   // Now that the dataset is reordered, we can create the children.
-  arma::vec childCenter(center.n_elem);
+  arma::Col<ElemType> childCenter(center.n_elem);
   const double childWidth = width / 2.0;
   for (size_t i = 0; i < childBegins.n_elem - 1; ++i)
   {
@@ -807,7 +854,7 @@ void Octree<MetricType, StatisticType, MatType>::SplitNode(
 //! Split the node, and store mappings.
 template<typename MetricType, typename StatisticType, typename MatType>
 void Octree<MetricType, StatisticType, MatType>::SplitNode(
-    const arma::vec& center,
+    const arma::Col<ElemType>& center,
     const double width,
     std::vector<size_t>& oldFromNew,
     const size_t maxLeafSize)
@@ -882,7 +929,7 @@ void Octree<MetricType, StatisticType, MatType>::SplitNode(
   }
 
   // Now that the dataset is reordered, we can create the children.
-  arma::vec childCenter(center.n_elem);
+  arma::Col<ElemType> childCenter(center.n_elem);
   const double childWidth = width / 2.0;
   for (size_t i = 0; i < childBegins.n_elem - 1; ++i)
   {
@@ -906,6 +953,246 @@ void Octree<MetricType, StatisticType, MatType>::SplitNode(
   }
 }
 
+//! Build the tree from the Morton codes of the points.
+template<typename MetricType, typename StatisticType, typename MatType>
+void Octree<MetricType, StatisticType, MatType>::MortonBuild(
+    const arma::Col<ElemType>& center,
+    const double width,
+    std::vector<size_t>& oldFromNew,
+    const size_t maxLeafSize)
+{
+  if (count <= maxLeafSize)
+    return;
+
+  // A code must hold at least two levels.
+  const size_t dims = dataset->n_rows;
+  if (dims == 0 || dims > 32)
+  {
+    SplitNode(center, width, oldFromNew, maxLeafSize);
+    return;
+  }
+  const size_t levels = 64 / dims;
+
+  // Compute the code of each point: at each level, the index of the child
+  // holding the point, with the same comparisons and centers as SplitNode().
+  std::vector<uint64_t> codes(count);
+
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables. If we're building for Visual Studio, use
+  // the intmax_t type instead.
+  #pragma omp parallel for schedule(static)
+  for (intmax_t i = 0; i < (intmax_t) count; ++i)
+#else
+  #pragma omp parallel for schedule(static)
+  for (size_t i = 0; i < count; ++i)
+#endif
+  {
+    ElemType childCenter[32];
+    for (size_t d = 0; d < dims; ++d)
+      childCenter[d] = center[d];
+
+    const ElemType* point = dataset->colptr(i);
+    double childWidth = width;
+    uint64_t code = 0;
+    for (size_t l = 0; l < levels; ++l)
+    {
+      childWidth /= 2.0;
+      uint64_t child = 0;
+      for (size_t d = 0; d < dims; ++d)
+      {
+        if (point[d] < childCenter[d])
+        {
+          childCenter[d] = childCenter[d] - childWidth;
+        }
+        else
+        {
+          child |= ((uint64_t) 1 << d);
+          childCenter[d] = childCenter[d] + childWidth;
+        }
+      }
+
+      code = (code << dims) | child;
+    }
+
+    codes[i] = code;
+  }
+
+  // Sort the points by code, which puts the points of each node together, with
+  // its children in order.
+  std::vector<size_t> order;
+  SortByCode(codes, order, levels * dims);
+
+  MatType sortedDataset(dims, count);
+  std::vector<size_t> sortedOldFromNew(count);
+
+#ifdef _WIN32
+  #pragma omp parallel for schedule(static)
+  for (intmax_t i = 0; i < (intmax_t) count; ++i)
+#else
+  #pragma omp parallel for schedule(static)
+  for (size_t i = 0; i < count; ++i)
+#endif
+  {
+    sortedDataset.col(i) = dataset->col(order[i]);
+    sortedOldFromNew[i] = oldFromNew[order[i]];
+  }
+
+  *dataset = std::move(sortedDataset);
+  oldFromNew.swap(sortedOldFromNew);
+
+  #pragma omp parallel if(count >= ParallelBuildThreshold)
+  #pragma omp single
+  MortonSplitNode(center, width, oldFromNew, maxLeafSize, codes, 0);
+}
+
+//! Split the node from the sorted Morton codes.
+template<typename MetricType, typename StatisticType, typename MatType>
+void Octree<MetricType, StatisticType, MatType>::MortonSplitNode(
+    const arma::Col<ElemType>& center,
+    const double width,
+    std::vector<size_t>& oldFromNew,
+    const size_t maxLeafSize,
+    const std::vector<uint64_t>& codes,
+    const size_t level)
+{
+  if (count <= maxLeafSize)
+    return;
+
+  // Nodes deeper than the codes are split the usual way.
+  const size_t dims = dataset->n_rows;
+  const size_t levels = 64 / dims;
+  if (level == levels)
+  {
+    SplitNode(center, width, oldFromNew, maxLeafSize);
+    return;
+  }
+
+  // The points of each child are contiguous, in the order of the children; the
+  // end of a child is the first point whose code has a larger prefix.
+  const size_t shift = dims * (levels - level - 1);
+  const uint64_t mask = ((uint64_t) 1 << dims) - 1;
+  std::vector<size_t> childBegins(1, begin);
+  while (childBegins.back() < begin + count)
+  {
+    const uint64_t prefix = codes[childBegins.back()] >> shift;
+    childBegins.push_back(std::upper_bound(codes.begin() + childBegins.back(),
+        codes.begin() + begin + count, prefix,
+        [shift](const uint64_t p, const uint64_t code)
+        {
+          return p < (code >> shift);
+        }) - codes.begin());
+  }
+
+  const size_t numChildren = childBegins.size() - 1;
+  const double childWidth = width / 2.0;
+  std::vector<arma::Col<ElemType>> childCenters(numChildren,
+      arma::Col<ElemType>(center.n_elem));
+  for (size_t c = 0; c < numChildren; ++c)
+  {
+    // Create the correct center.
+    const uint64_t i = (codes[childBegins[c]] >> shift) & mask;
+    for (size_t d = 0; d < center.n_elem; ++d)
+    {
+      // Is the dimension "right" (1) or "left" (0)?
+      if (((i >> d) & 1) == 0)
+        childCenters[c][d] = center[d] - childWidth;
+      else
+        childCenters[c][d] = center[d] + childWidth;
+    }
+  }
+
+  // The children hold disjoint ranges of the dataset and of oldFromNew, so
+  // they can be built at the same time.
+  children.resize(numChildren);
+  for (size_t c = 0; c < numChildren; ++c)
+  {
+#ifdef MLPACK_HAS_OPENMP_TASKS
+    #pragma omp task if(count >= ParallelBuildThreshold) \
+        shared(childBegins, childCenters, oldFromNew, codes)
+#endif
+    children[c] = new Octree(this, childBegins[c],
+        childBegins[c + 1] - childBegins[c], oldFromNew, childCenters[c],
+        childWidth, maxLeafSize, codes, level + 1);
+  }
+#ifdef MLPACK_HAS_OPENMP_TASKS
+  #pragma omp taskwait
+#endif
+}
+
+//! Sort the given codes.
+template<typename MetricType, typename StatisticType, typename MatType>
+void Octree<MetricType, StatisticType, MatType>::SortByCode(
+    std::vector<uint64_t>& codes,
+    std::vector<size_t>& order,
+    const size_t bits)
+{
+  const size_t n = codes.size();
+  order.resize(n);
+  for (size_t i = 0; i < n; ++i)
+    order[i] = i;
+
+  std::vector<uint64_t> sortedCodes(n);
+  std::vector<size_t> sortedOrder(n);
+
+#ifdef HAS_OPENMP
+  const size_t maxThreads = omp_get_max_threads();
+#else
+  const size_t maxThreads = 1;
+#endif
+
+  // Each pass is a stable counting sort on 8 bits of the codes: each thread
+  // counts the digits of its range of points, and then moves them to the
+  // positions given by the counts of all the threads.
+  std::vector<size_t> counts(256 * maxThreads);
+  for (size_t shift = 0; shift < bits; shift += 8)
+  {
+    std::fill(counts.begin(), counts.end(), 0);
+
+    #pragma omp parallel num_threads(maxThreads)
+    {
+#ifdef HAS_OPENMP
+      const size_t thread = omp_get_thread_num();
+      const size_t threads = omp_get_num_threads();
+#else
+      const size_t thread = 0;
+      const size_t threads = 1;
+#endif
+      const size_t first = thread * n / threads;
+      const size_t last = (thread + 1) * n / threads;
+      size_t* threadCounts = counts.data() + 256 * thread;
+
+      for (size_t i = first; i < last; ++i)
+        ++threadCounts[(codes[i] >> shift) & 255];
+
+      #pragma omp barrier
+      #pragma omp single
+      {
+        size_t offset = 0;
+        for (size_t digit = 0; digit < 256; ++digit)
+        {
+          for (size_t t = 0; t < threads; ++t)
+          {
+            const size_t digitCount = counts[256 * t + digit];
+            counts[256 * t + digit] = offset;
+            offset += digitCount;
+          }
+        }
+      }
+
+      for (size_t i = first; i < last; ++i)
+      {
+        const size_t position = threadCounts[(codes[i] >> shift) & 255]++;
+        sortedCodes[position] = codes[i];
+        sortedOrder[position] = order[i];
+      }
+    }
+
+    codes.swap(sortedCodes);
+    order.swap(sortedOrder);
+  }
+}
+
 } // namespace tree
 } // namespace mlpack
 
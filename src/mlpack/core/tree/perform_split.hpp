@@ -16,15 +16,86 @@
 #ifndef MLPACK_CORE_TREE_PERFORM_SPLIT_HPP
 #define MLPACK_CORE_TREE_PERFORM_SPLIT_HPP
 
+#include <mlpack/prereqs.hpp>
+
 namespace mlpack {
 namespace tree /** Trees and tree-building procedures. */ {
 namespace split {
 
+#ifdef MLPACK_HAS_OPENMP_TASKS
+
+/**
+ * Nodes with at least this many points are partitioned in parallel by
+ * PerformSplit(), if it is called inside a parallel region.
+ */
+const size_t ParallelSplitThreshold = 16384;
+
+/**
+ * The parallel version of PerformSplit(), which is meant to be called inside a
+ * parallel region (for instance from an OpenMP task).  First, the side of each
+ * point is found in parallel.  The serial two-pointer loop swaps the i'th point
+ * from the left that belongs to the right subtree with the i'th point from the
+ * right that belongs to the left subtree; those pairs are collected and then
+ * swapped in parallel, so the dataset and oldFromNew end up exactly as they do
+ * with the serial loop.
+ *
+ * @param data The dataset used by the binary space tree.
+ * @param begin Index of the starting point in the dataset that belongs to
+ *    this node.
+ * @param count Number of points in this node.
+ * @param splitInfo The information about the split.
+ * @param oldFromNew Vector of old positions to update along with the dataset,
+ *    or NULL.
+ */
+template<typename MatType, typename SplitType>
+size_t ParallelPerformSplit(MatType& data,
+                            const size_t begin,
+                            const size_t count,
+                            const typename SplitType::SplitInfo& splitInfo,
+                            std::vector<size_t>* oldFromNew)
+{
+  std::vector<char> assignToLeft(count);
+
+  #pragma omp taskloop grainsize(1024) shared(data, splitInfo, assignToLeft)
+  for (size_t i = 0; i < count; ++i)
+    assignToLeft[i] = SplitType::AssignToLeftNode(data.col(begin + i),
+        splitInfo);
+
+  size_t numLeft = 0;
+  for (size_t i = 0; i < count; ++i)
+    numLeft += assignToLeft[i];
+
+  // Points on the left of the split column that belong to the right subtree,
+  // from left to right, and points on the right of the split column that belong
+  // to the left subtree, from right to left.  There are as many of each.
+  std::vector<size_t> wrongLeft, wrongRight;
+  for (size_t i = 0; i < numLeft; ++i)
+    if (!assignToLeft[i])
+      wrongLeft.push_back(begin + i);
+  for (size_t i = count; i > numLeft; --i)
+    if (assignToLeft[i - 1])
+      wrongRight.push_back(begin + i - 1);
+
+  #pragma omp taskloop grainsize(256) shared(data, oldFromNew, wrongLeft, \
+      wrongRight)
+  for (size_t i = 0; i < wrongLeft.size(); ++i)
+  {
+    data.swap_cols(wrongLeft[i], wrongRight[i]);
+    if (oldFromNew)
+      std::swap((*oldFromNew)[wrongLeft[i]], (*oldFromNew)[wrongRight[i]]);
+  }
+
+  return begin + numLeft;
+}
+
+#endif
+
 /**
  * This function implements the default split behavior i.e. it rearranges
  * points according to the split information. The SplitType::AssignToLeftNode()
  * function is used in order to determine the child that contains any particular
- * point.
+ * point.  Large nodes are partitioned with ParallelPerformSplit() when this is
+ * called inside a parallel region; the result is the same.
  *
  * @param data The dataset used by the binary space tree.
  * @param begin Index of the starting point in the dataset that belongs to
@@ -38,6 +109,12 @@ size_t PerformSplit(MatType& data,
                     const size_t count,
                     const typename SplitType::SplitInfo& splitInfo)
 {
+#ifdef MLPACK_HAS_OPENMP_TASKS
+  if (count >= ParallelSplitThreshold && omp_in_parallel())
+    return ParallelPerformSplit<MatType, SplitType>(data, begin, count,
+        splitInfo, NULL);
+#endif
+
   // This method modifies the input dataset.  We loop both from the left and
   // right sides of the points contained in this node.
   size_t left = begin;
@@ -104,6 +181,12 @@ size_t PerformSplit(MatType& data,
                     const typename SplitType::SplitInfo& splitInfo,
                     std::vector<size_t>& oldFromNew)
 {
+#ifdef MLPACK_HAS_OPENMP_TASKS
+  if (count >= ParallelSplitThreshold && omp_in_parallel())
+    return ParallelPerformSplit<MatType, SplitType>(data, begin, count,
+        splitInfo, &oldFromNew);
+#endif
+
   // This method modifies the input dataset.  We loop both from the left and
   // right sides of the points contained in this node.
   size_t left = begin;
@@ -197,6 +197,19 @@ class DiscreteHilbertValue
   template<typename TreeType>
   void UpdateLargestValue(TreeType* node);
 
+  /**
+   * Prepare the local Hilbert values of a node that is built by bulk loading.
+   * Leaf nodes own their local Hilbert values, and other nodes point to the
+   * values of their last child, so the ownership that was guessed by the
+   * constructor is fixed here.  This is called before any point is inserted
+   * into the node.
+   *
+   * @param node The node that is being bulk loaded.
+   * @param isLeaf Whether the node will be a leaf.
+   */
+  template<typename TreeType>
+  void HandleBulkLoad(TreeType* node, const bool isLeaf);
+
   /**
    * This method updates the largest Hilbert value of a leaf node and
    * redistributes the Hilbert values of points according to their new position
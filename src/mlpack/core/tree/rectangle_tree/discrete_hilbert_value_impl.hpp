@@ -50,7 +50,8 @@ DiscreteHilbertValue<TreeElemType>::DiscreteHilbertValue(const TreeType* tree) :
   // Calculate the Hilbert value for all points.
   if (!tree->Parent()) // This is the root node.
     ownsLocalHilbertValues = true;
-  else if (tree->Parent()->Child(0).IsLeaf())
+  else if (tree->Parent()->NumChildren() > 0 &&
+      tree->Parent()->Child(0).IsLeaf())
   {
     // This is a leaf node.
     assert(tree->Parent()->NumChildren() > 0);
@@ -464,6 +465,27 @@ void DiscreteHilbertValue<TreeElemType>::UpdateLargestValue(TreeType* node)
   }
 }
 
+template<typename TreeElemType>
+template<typename TreeType>
+void DiscreteHilbertValue<TreeElemType>::HandleBulkLoad(TreeType* node,
+                                                        const bool isLeaf)
+{
+  if (isLeaf && !ownsLocalHilbertValues)
+  {
+    localHilbertValues = new arma::Mat<HilbertElemType>(
+        node->Dataset().n_rows, node->MaxLeafSize() + 1);
+    ownsLocalHilbertValues = true;
+  }
+  else if (!isLeaf && ownsLocalHilbertValues)
+  {
+    delete localHilbertValues;
+    localHilbertValues = NULL;
+    ownsLocalHilbertValues = false;
+  }
+
+  numValues = 0;
+}
+
 template<typename TreeElemType>
 template<typename TreeType>
 void DiscreteHilbertValue<TreeElemType>::RedistributeHilbertValues(
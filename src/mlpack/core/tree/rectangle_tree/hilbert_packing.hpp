@@ -0,0 +1,70 @@
+/**
+ * @file hilbert_packing.hpp
+ *
+ * Definition of the HilbertPacking class, a packing policy for bulk loading
+ * rectangle type trees by sorting the points along the Hilbert curve.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_RECTANGLE_TREE_HILBERT_PACKING_HPP
+#define MLPACK_CORE_TREE_RECTANGLE_TREE_HILBERT_PACKING_HPP
+
+#include <mlpack/prereqs.hpp>
+#include "discrete_hilbert_value.hpp"
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * A packing policy for bulk loading rectangle type trees (see the bulk loading
+ * constructors of RectangleTree) that sorts the points by their Hilbert values,
+ * as computed by DiscreteHilbertValue, so that each node holds a run of points
+ * that is contiguous along the Hilbert curve.  This is the packing to use for
+ * Hilbert R trees, since the children of each node are then ordered by their
+ * largest Hilbert values, as the Hilbert R tree requires.
+ *
+ * @code
+ * @inproceedings{kamel1993hilbert,
+ *   title={On packing {R}-trees},
+ *   author={Kamel, Ibrahim and Faloutsos, Christos},
+ *   booktitle={Proceedings of the Second International Conference on
+ *       Information and Knowledge Management (CIKM '93)},
+ *   pages={490--499},
+ *   year={1993}
+ * }
+ * @endcode
+ */
+class HilbertPacking
+{
+ public:
+  /**
+   * Arrange the points indices[first, last) so that cutting them into
+   * numGroups consecutive groups gives good nodes, by sorting the points by
+   * their Hilbert values.  Any range of a sorted set of points is already
+   * sorted, so only the first call (on the whole set of points, when the tree
+   * is built) has to sort; later calls on smaller ranges do nothing.
+   *
+   * @param data Dataset the points belong to.
+   * @param indices Indices of the points of the tree.
+   * @param first Index of the first point to arrange in indices.
+   * @param last One past the index of the last point to arrange in indices.
+   * @param numGroups Number of groups to arrange the points into.
+   */
+  template<typename MatType>
+  static void Arrange(const MatType& data,
+                      std::vector<size_t>& indices,
+                      const size_t first,
+                      const size_t last,
+                      const size_t numGroups);
+};
+
+} // namespace tree
+} // namespace mlpack
+
+// Include implementation.
+#include "hilbert_packing_impl.hpp"
+
+#endif
@@ -0,0 +1,51 @@
+/**
+ * @file hilbert_packing_impl.hpp
+ *
+ * Implementation of the HilbertPacking class, a packing policy for bulk loading
+ * rectangle type trees by sorting the points along the Hilbert curve.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_RECTANGLE_TREE_HILBERT_PACKING_IMPL_HPP
+#define MLPACK_CORE_TREE_RECTANGLE_TREE_HILBERT_PACKING_IMPL_HPP
+
+#include "hilbert_packing.hpp"
+
+namespace mlpack {
+namespace tree {
+
+template<typename MatType>
+void HilbertPacking::Arrange(const MatType& data,
+                             std::vector<size_t>& indices,
+                             const size_t first,
+                             const size_t last,
+                             const size_t /* numGroups */)
+{
+  if (first != 0 || last != indices.size())
+    return;
+
+  typedef DiscreteHilbertValue<typename MatType::elem_type> HilbertValue;
+  typedef typename HilbertValue::HilbertElemType HilbertElemType;
+
+  // Compute every Hilbert value once.
+  arma::Mat<HilbertElemType> values(data.n_rows, data.n_cols);
+  for (size_t i = 0; i < data.n_cols; ++i)
+    values.col(i) = HilbertValue::CalculateValue(data.col(i));
+
+  // Hilbert values are compared lexicographically.
+  std::stable_sort(indices.begin(), indices.end(),
+      [&values](const size_t a, const size_t b)
+      {
+        return std::lexicographical_compare(values.colptr(a),
+            values.colptr(a) + values.n_rows, values.colptr(b),
+            values.colptr(b) + values.n_rows);
+      });
+}
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
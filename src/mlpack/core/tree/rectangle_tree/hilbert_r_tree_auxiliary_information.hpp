@@ -117,6 +117,16 @@ class HilbertRTreeAuxiliaryInformation
    */
   bool UpdateAuxiliaryInfo(TreeType* node);
 
+  /**
+   * Prepare the information of a node that is built by bulk loading: leaves
+   * hold the Hilbert values of their points, and other nodes don't.  This is
+   * called before any point is inserted into the node.
+   *
+   * @param node The node that is being bulk loaded.
+   * @param isLeaf Whether the node will be a leaf.
+   */
+  void HandleBulkLoad(TreeType* node, const bool isLeaf);
+
   //! Clear memory.
   void NullifyData();
 
@@ -113,6 +113,17 @@ class NoAuxiliaryInformation
     return false;
   }
 
+  /**
+   * Some tree types require to prepare the information of a node that is
+   * built by bulk loading.  This method is called once it is known whether
+   * the node is a leaf, before any point is inserted into the node.
+   *
+   * @param node The node that is being bulk loaded.
+   * @param isLeaf Whether the node will be a leaf.
+   */
+  void HandleBulkLoad(TreeType* /* node */, const bool /* isLeaf */)
+  { }
+
   /**
    * The R++ tree requires to split the maximum bounding rectangle of a node
    * that is being split. This method is intended for that. This method is only
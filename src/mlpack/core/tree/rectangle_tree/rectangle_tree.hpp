@@ -156,6 +156,61 @@ class RectangleTree
                 const size_t minNumChildren = 2,
                 const size_t firstDataIndex = 0);
 
+  /**
+   * Construct this as the root node of a rectangle type tree by bulk loading
+   * the given dataset, instead of inserting the points one by one.  The tree
+   * is built from the top down: at each node, the PackingType (STRPacking or
+   * HilbertPacking) arranges the points of the node so that consecutive runs
+   * of points form good children, and the points are split evenly between as
+   * few children as possible.  Every leaf is at the same depth, and every
+   * node is at least half full.  The dataset is not modified.
+   *
+   * Bulk loading is supported for R trees, R* trees, X trees and Hilbert R
+   * trees; Hilbert R trees should be bulk loaded with HilbertPacking, so that
+   * the children of every node are ordered by their Hilbert values.  R+ and
+   * R++ trees can't be bulk loaded, since the packed nodes may overlap.
+   *
+   * @param data Dataset from which to create the tree.
+   * @param packing Instantiated packing policy (only its type is used).
+   * @param maxLeafSize Maximum size of each leaf in the tree.
+   * @param minLeafSize Minimum size of each leaf in the tree.
+   * @param maxNumChildren The maximum number of child nodes a non-leaf node may
+   *      have.
+   * @param minNumChildren The minimum number of child nodes a non-leaf node may
+   *      have.
+   */
+  template<typename PackingType, typename = std::enable_if_t<
+      std::is_class<PackingType>::value>>
+  RectangleTree(const MatType& data,
+                const PackingType& packing,
+                const size_t maxLeafSize = 20,
+                const size_t minLeafSize = 8,
+                const size_t maxNumChildren = 5,
+                const size_t minNumChildren = 2);
+
+  /**
+   * Construct this as the root node of a rectangle type tree by bulk loading
+   * the given dataset, taking ownership of the dataset.  See the constructor
+   * above for details.
+   *
+   * @param data Dataset from which to create the tree.
+   * @param packing Instantiated packing policy (only its type is used).
+   * @param maxLeafSize Maximum size of each leaf in the tree.
+   * @param minLeafSize Minimum size of each leaf in the tree.
+   * @param maxNumChildren The maximum number of child nodes a non-leaf node may
+   *      have.
+   * @param minNumChildren The minimum number of child nodes a non-leaf node may
+   *      have.
+   */
+  template<typename PackingType, typename = std::enable_if_t<
+      std::is_class<PackingType>::value>>
+  RectangleTree(MatType&& data,
+                const PackingType& packing,
+                const size_t maxLeafSize = 20,
+                const size_t minLeafSize = 8,
+                const size_t maxNumChildren = 5,
+                const size_t minNumChildren = 2);
+
   /**
    * Construct this as an empty node with the specified parent.  Copying the
    * parameters (maxLeafSize, minLeafSize, maxNumChildren, minNumChildren,
@@ -297,9 +352,9 @@ class RectangleTree
   RectangleTree* FindByBeginCount(size_t begin, size_t count);
 
   //! Return the bound object for this node.
-  const bound::HRectBound<MetricType>& Bound() const { return bound; }
+  const bound::HRectBound<MetricType, ElemType>& Bound() const { return bound; }
   //! Modify the bound object for this node.
-  bound::HRectBound<MetricType>& Bound() { return bound; }
+  bound::HRectBound<MetricType, ElemType>& Bound() { return bound; }
 
   //! Return the statistic object for this node.
   const StatisticType& Stat() const { return stat; }
@@ -350,7 +405,7 @@ class RectangleTree
   MetricType Metric() const { return MetricType(); }
 
   //! Get the centroid of the node and store it in the given vector.
-  void Center(arma::vec& center) { bound.Center(center); }
+  void Center(arma::Col<ElemType>& center) { bound.Center(center); }
 
   //! Return the number of child nodes.  (One level beneath this one only.)
   size_t NumChildren() const { return numChildren; }
@@ -542,6 +597,28 @@ class RectangleTree
    */
   void SplitNode(std::vector<bool>& relevels);
 
+  /**
+   * Bulk load the points indices[first, last) into this (empty) node, which
+   * is at the given level above the leaves.  This is used by the bulk loading
+   * constructors.
+   *
+   * @param indices Indices of all the points of the tree.
+   * @param first Index of the first point of this node in indices.
+   * @param last One past the index of the last point of this node in indices.
+   * @param level Number of levels below this node (0 for a leaf).
+   */
+  template<typename PackingType>
+  void BulkLoad(std::vector<size_t>& indices,
+                const size_t first,
+                const size_t last,
+                const size_t level);
+
+  /**
+   * Compute the number of levels below the root of a bulk loaded tree built
+   * on the dataset of this node.
+   */
+  size_t BulkLoadLevels() const;
+
  protected:
   /**
    * A default constructor.  This is meant to only be used with
@@ -595,7 +672,8 @@ class RectangleTree
    *      shrinking.
    * @return true if the bound needed to be changed, false if it did not.
    */
-  bool ShrinkBoundForBound(const bound::HRectBound<MetricType>& changedBound);
+  bool ShrinkBoundForBound(
+      const bound::HRectBound<MetricType, ElemType>& changedBound);
 
   /**
    * Make an exact copy of this node, pointers and everything.
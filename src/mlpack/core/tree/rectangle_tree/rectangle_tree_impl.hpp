@@ -17,6 +17,7 @@
 
 #include <mlpack/core/util/cli.hpp>
 #include <mlpack/core/util/log.hpp>
+#include <mlpack/core/tree/tree_traits.hpp>
 
 namespace mlpack {
 namespace tree {
@@ -101,6 +102,186 @@ RectangleTree(MatType&& data,
     root->InsertPoint(i);
 }
 
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         typename SplitType,
+         typename DescentType,
+         template<typename> class AuxiliaryInformationType>
+template<typename PackingType, typename>
+RectangleTree<MetricType, StatisticType, MatType, SplitType, DescentType,
+              AuxiliaryInformationType>::
+RectangleTree(const MatType& data,
+              const PackingType& /* packing */,
+              const size_t maxLeafSize,
+              const size_t minLeafSize,
+              const size_t maxNumChildren,
+              const size_t minNumChildren) :
+    maxNumChildren(maxNumChildren),
+    minNumChildren(minNumChildren),
+    numChildren(0),
+    children(maxNumChildren + 1), // Add one to make splitting the node simpler.
+    parent(NULL),
+    begin(0),
+    count(0),
+    numDescendants(0),
+    maxLeafSize(maxLeafSize),
+    minLeafSize(minLeafSize),
+    bound(data.n_rows),
+    parentDistance(0),
+    dataset(new MatType(data)),
+    ownsDataset(true),
+    points(maxLeafSize + 1), // Add one to make splitting the node simpler.
+    auxiliaryInfo(this)
+{
+  static_assert(TreeTraits<RectangleTree>::HasOverlappingChildren,
+      "RectangleTree: R+ and R++ trees can't be bulk loaded.");
+
+  std::vector<size_t> indices(dataset->n_cols);
+  for (size_t i = 0; i < indices.size(); ++i)
+    indices[i] = i;
+
+  BulkLoad<PackingType>(indices, 0, indices.size(), BulkLoadLevels());
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         typename SplitType,
+         typename DescentType,
+         template<typename> class AuxiliaryInformationType>
+template<typename PackingType, typename>
+RectangleTree<MetricType, StatisticType, MatType, SplitType, DescentType,
+              AuxiliaryInformationType>::
+RectangleTree(MatType&& data,
+              const PackingType& /* packing */,
+              const size_t maxLeafSize,
+              const size_t minLeafSize,
+              const size_t maxNumChildren,
+              const size_t minNumChildren) :
+    maxNumChildren(maxNumChildren),
+    minNumChildren(minNumChildren),
+    numChildren(0),
+    children(maxNumChildren + 1), // Add one to make splitting the node simpler.
+    parent(NULL),
+    begin(0),
+    count(0),
+    numDescendants(0),
+    maxLeafSize(maxLeafSize),
+    minLeafSize(minLeafSize),
+    bound(data.n_rows),
+    parentDistance(0),
+    dataset(new MatType(std::move(data))),
+    ownsDataset(true),
+    points(maxLeafSize + 1), // Add one to make splitting the node simpler.
+    auxiliaryInfo(this)
+{
+  static_assert(TreeTraits<RectangleTree>::HasOverlappingChildren,
+      "RectangleTree: R+ and R++ trees can't be bulk loaded.");
+
+  std::vector<size_t> indices(dataset->n_cols);
+  for (size_t i = 0; i < indices.size(); ++i)
+    indices[i] = i;
+
+  BulkLoad<PackingType>(indices, 0, indices.size(), BulkLoadLevels());
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         typename SplitType,
+         typename DescentType,
+         template<typename> class AuxiliaryInformationType>
+template<typename PackingType>
+void RectangleTree<MetricType, StatisticType, MatType, SplitType, DescentType,
+                   AuxiliaryInformationType>::
+BulkLoad(std::vector<size_t>& indices,
+         const size_t first,
+         const size_t last,
+         const size_t level)
+{
+  auxiliaryInfo.HandleBulkLoad(this, level == 0);
+
+  if (level == 0)
+  {
+    // The ancestors get to see each point before the leaf, as in
+    // InsertPoint().
+    std::vector<RectangleTree*> ancestors;
+    for (RectangleTree* node = parent; node != NULL; node = node->parent)
+      ancestors.push_back(node);
+
+    for (size_t i = first; i < last; ++i)
+    {
+      const size_t point = indices[i];
+      for (size_t j = ancestors.size(); j > 0; --j)
+        ancestors[j - 1]->auxiliaryInfo.HandlePointInsertion(ancestors[j - 1],
+            point);
+
+      if (!auxiliaryInfo.HandlePointInsertion(this, point))
+        points[count++] = point;
+
+      bound |= dataset->col(point);
+    }
+
+    numDescendants = last - first;
+    stat = StatisticType(*this);
+    return;
+  }
+
+  // Each child can hold this many points.
+  size_t childCapacity = maxLeafSize;
+  for (size_t i = 1; i < level; ++i)
+    childCapacity *= maxNumChildren;
+
+  // Split the points evenly between as few children as possible.  The first
+  // (n % numGroups) children get one point more.
+  const size_t n = last - first;
+  const size_t numGroups = (n + childCapacity - 1) / childCapacity;
+  PackingType::Arrange(*dataset, indices, first, last, numGroups);
+
+  size_t childFirst = first;
+  for (size_t i = 0; i < numGroups; ++i)
+  {
+    const size_t childLast = childFirst + n / numGroups +
+        (i < n % numGroups ? 1 : 0);
+
+    // The child must be attached before it is filled, so that the auxiliary
+    // information of its ancestors can be updated.
+    RectangleTree* child = new RectangleTree(this);
+    children[numChildren++] = child;
+    child->BulkLoad<PackingType>(indices, childFirst, childLast, level - 1);
+
+    bound |= child->Bound();
+    numDescendants += child->NumDescendants();
+    childFirst = childLast;
+  }
+
+  stat = StatisticType(*this);
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         typename SplitType,
+         typename DescentType,
+         template<typename> class AuxiliaryInformationType>
+size_t RectangleTree<MetricType, StatisticType, MatType, SplitType,
+                     DescentType, AuxiliaryInformationType>::
+BulkLoadLevels() const
+{
+  // Find the smallest number of levels such that the tree can hold every
+  // point.
+  size_t levels = 0;
+  size_t capacity = maxLeafSize;
+  while (capacity < dataset->n_cols)
+  {
+    capacity *= maxNumChildren;
+    ++levels;
+  }
+
+  return levels;
+}
+
 template<typename MetricType,
          typename StatisticType,
          typename MatType,
@@ -1211,7 +1392,7 @@ template<typename MetricType,
          template<typename> class AuxiliaryInformationType>
 bool RectangleTree<MetricType, StatisticType, MatType, SplitType, DescentType,
                    AuxiliaryInformationType>::
-    ShrinkBoundForBound(const bound::HRectBound<MetricType>& /* b */)
+    ShrinkBoundForBound(const bound::HRectBound<MetricType, ElemType>& /* b */)
 {
   // Using the sum is safe since none of the dimensions can increase.
   ElemType sum = 0;
@@ -0,0 +1,82 @@
+/**
+ * @file str_packing.hpp
+ *
+ * Definition of the STRPacking class, a packing policy for bulk loading
+ * rectangle type trees with the Sort-Tile-Recursive algorithm.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_RECTANGLE_TREE_STR_PACKING_HPP
+#define MLPACK_CORE_TREE_RECTANGLE_TREE_STR_PACKING_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * A packing policy for bulk loading rectangle type trees (see the bulk loading
+ * constructors of RectangleTree), based on the Sort-Tile-Recursive algorithm
+ * of Leutenegger, Lopez and Edgington.  To split a node into P children in d
+ * dimensions, the points are sorted along the first dimension and cut into
+ * S = ceil(P^(1 / d)) slabs; each slab is then tiled recursively along the
+ * remaining dimensions, until each tile holds the points of one child.  The
+ * children are therefore boxes that hardly overlap.
+ *
+ * @code
+ * @inproceedings{leutenegger1997str,
+ *   title={{STR}: A simple and efficient algorithm for {R}-tree packing},
+ *   author={Leutenegger, Scott T. and Lopez, Mario A. and Edgington, Jeffrey},
+ *   booktitle={Proceedings of the 13th International Conference on Data
+ *       Engineering (ICDE '97)},
+ *   pages={497--506},
+ *   year={1997}
+ * }
+ * @endcode
+ */
+class STRPacking
+{
+ public:
+  /**
+   * Arrange the points indices[first, last) so that cutting them into
+   * numGroups consecutive groups gives the tiles.  As in RectangleTree, the
+   * groups are of (nearly) equal size, and the first (n % numGroups) groups
+   * get one point more, where n is the number of points.
+   *
+   * @param data Dataset the points belong to.
+   * @param indices Indices of the points of the tree.
+   * @param first Index of the first point to arrange in indices.
+   * @param last One past the index of the last point to arrange in indices.
+   * @param numGroups Number of groups to arrange the points into.
+   */
+  template<typename MatType>
+  static void Arrange(const MatType& data,
+                      std::vector<size_t>& indices,
+                      const size_t first,
+                      const size_t last,
+                      const size_t numGroups);
+
+ private:
+  /**
+   * Tile the points indices[first, last) into numGroups groups, starting with
+   * the given dimension.
+   */
+  template<typename MatType>
+  static void Tile(const MatType& data,
+                   std::vector<size_t>& indices,
+                   const size_t first,
+                   const size_t last,
+                   const size_t numGroups,
+                   const size_t dim);
+};
+
+} // namespace tree
+} // namespace mlpack
+
+// Include implementation.
+#include "str_packing_impl.hpp"
+
+#endif
@@ -0,0 +1,83 @@
+/**
+ * @file str_packing_impl.hpp
+ *
+ * Implementation of the STRPacking class, a packing policy for bulk loading
+ * rectangle type trees with the Sort-Tile-Recursive algorithm.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_RECTANGLE_TREE_STR_PACKING_IMPL_HPP
+#define MLPACK_CORE_TREE_RECTANGLE_TREE_STR_PACKING_IMPL_HPP
+
+#include "str_packing.hpp"
+
+namespace mlpack {
+namespace tree {
+
+template<typename MatType>
+void STRPacking::Arrange(const MatType& data,
+                         std::vector<size_t>& indices,
+                         const size_t first,
+                         const size_t last,
+                         const size_t numGroups)
+{
+  Tile(data, indices, first, last, numGroups, 0);
+}
+
+template<typename MatType>
+void STRPacking::Tile(const MatType& data,
+                      std::vector<size_t>& indices,
+                      const size_t first,
+                      const size_t last,
+                      const size_t numGroups,
+                      const size_t dim)
+{
+  if (numGroups <= 1)
+    return;
+
+  std::sort(indices.begin() + first, indices.begin() + last,
+      [&data, dim](const size_t a, const size_t b)
+      {
+        return data(dim, a) < data(dim, b);
+      });
+
+  // Along the last dimension, the groups are simply consecutive.
+  if (dim + 1 >= data.n_rows)
+    return;
+
+  // The small offset avoids an extra slab when numGroups is an exact power.
+  const size_t remainingDims = data.n_rows - dim;
+  const size_t numSlabs = std::min(numGroups, (size_t) std::ceil(
+      std::pow((double) numGroups, 1.0 / remainingDims) - 1e-9));
+
+  // Each slab takes consecutive groups; the sizes of the groups are the same
+  // as if the points were cut into numGroups groups directly, so the slabs
+  // can be tiled independently.
+  const size_t n = last - first;
+  size_t slabFirst = first;
+  size_t group = 0;
+  for (size_t i = 0; i < numSlabs; ++i)
+  {
+    const size_t slabGroups = numGroups / numSlabs +
+        (i < numGroups % numSlabs ? 1 : 0);
+
+    // The first (n % numGroups) groups have one point more.
+    const size_t largerGroups = std::min(slabGroups,
+        (n % numGroups > group) ? n % numGroups - group : 0);
+    const size_t slabLast = slabFirst + slabGroups * (n / numGroups) +
+        largerGroups;
+
+    Tile(data, indices, slabFirst, slabLast, slabGroups, dim + 1);
+
+    slabFirst = slabLast;
+    group += slabGroups;
+  }
+}
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
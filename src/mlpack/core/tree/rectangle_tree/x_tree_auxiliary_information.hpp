@@ -156,6 +156,17 @@ class XTreeAuxiliaryInformation
     return false;
   }
 
+  /**
+   * Some tree types require to prepare the information of a node that is
+   * built by bulk loading.  A bulk loaded node has no split history, so there
+   * is nothing to do.
+   *
+   * @param node The node that is being bulk loaded.
+   * @param isLeaf Whether the node will be a leaf.
+   */
+  void HandleBulkLoad(TreeType* , const bool)
+  { }
+
   /**
    * Nullify the auxiliary information in order to prevent an invalid free.
    */
@@ -14,6 +14,7 @@
 #define MLPACK_CORE_TREE_SPILL_TREE_MEAN_SPACE_SPLIT_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <mlpack/core/tree/split_traits.hpp>
 #include "hyperplane.hpp"
 
 namespace mlpack {
@@ -41,6 +42,16 @@ class MeanSpaceSplit
       HyperplaneType& hyp);
 };
 
+/**
+ * Like MidpointSpaceSplit, the hyperplane only depends on the node itself.
+ */
+template<typename MetricType, typename MatType>
+class SplitTraits<MeanSpaceSplit<MetricType, MatType>>
+{
+ public:
+  static const bool IsDeterministic = true;
+};
+
 } // namespace tree
 } // namespace mlpack
 
@@ -14,6 +14,7 @@
 #define MLPACK_CORE_TREE_SPILL_TREE_MIDPOINT_SPACE_SPLIT_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <mlpack/core/tree/split_traits.hpp>
 #include "hyperplane.hpp"
 
 namespace mlpack {
@@ -41,6 +42,17 @@ class MidpointSpaceSplit
       HyperplaneType& hyp);
 };
 
+/**
+ * The splitting hyperplane is computed from the bound and the points of the
+ * node alone, so spill tree nodes can be split in parallel.
+ */
+template<typename MetricType, typename MatType>
+class SplitTraits<MidpointSpaceSplit<MetricType, MatType>>
+{
+ public:
+  static const bool IsDeterministic = true;
+};
+
 } // namespace tree
 } // namespace mlpack
 
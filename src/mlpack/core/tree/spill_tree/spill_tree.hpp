@@ -14,6 +14,7 @@
 #include <mlpack/prereqs.hpp>
 #include "../space_split/midpoint_space_split.hpp"
 #include "../statistic.hpp"
+#include "../split_traits.hpp"
 
 namespace mlpack {
 namespace tree /** Trees and tree-building procedures. */ {
@@ -424,8 +425,25 @@ class SpillTree
   void Center(arma::vec& center) { bound.Center(center); }
 
  private:
+  //! Nodes with at least this many points build their two subtrees as separate
+  //! OpenMP tasks, if the split type allows it.
+  static const size_t ParallelBuildThreshold = 1024;
+
+  /**
+   * Return whether the subtrees of a node holding the given number of points
+   * should be built in parallel: that is, whether OpenMP tasks are available,
+   * the split type is deterministic (see SplitTraits), and there are at least
+   * ParallelBuildThreshold points.
+   *
+   * @param numPoints Number of points held by the node.
+   */
+  static bool ParallelBuild(const size_t numPoints);
+
   /**
    * Splits the current node, assigning its left and right children recursively.
+   * If ParallelBuild() is true and this is called inside a parallel region, the
+   * two subtrees are built as OpenMP tasks; each builds its own index list, so
+   * the tree is the same as one built serially.
    *
    * @param points Vector of indexes of points to be included in this node.
    * @param maxLeafSize Maximum number of points held in a leaf.
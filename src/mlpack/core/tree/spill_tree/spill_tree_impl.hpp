@@ -50,6 +50,8 @@ SpillTree(
         dataset->n_cols);
 
   // Do the actual splitting of this node.
+  #pragma omp parallel if(ParallelBuild(points.n_elem))
+  #pragma omp single
   SplitNode(points, maxLeafSize, tau, rho);
 
   // Create the statistic depending on if we are a leaf or not.
@@ -87,6 +89,8 @@ SpillTree(
         dataset->n_cols);
 
   // Do the actual splitting of this node.
+  #pragma omp parallel if(ParallelBuild(points.n_elem))
+  #pragma omp single
   SplitNode(points, maxLeafSize, tau, rho);
 
   // Create the statistic depending on if we are a leaf or not.
@@ -567,6 +571,24 @@ inline size_t SpillTree<MetricType, StatisticType, MatType, HyperplaneType,
   return (size_t() - 1);
 }
 
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename HyperplaneMetricType> class HyperplaneType,
+         template<typename SplitMetricType, typename SplitMatType>
+             class SplitType>
+inline bool SpillTree<MetricType, StatisticType, MatType, HyperplaneType,
+    SplitType>::ParallelBuild(const size_t numPoints)
+{
+#ifdef MLPACK_HAS_OPENMP_TASKS
+  return SplitTraits<SplitType<MetricType, MatType>>::IsDeterministic &&
+      (numPoints >= ParallelBuildThreshold);
+#else
+  (void) numPoints;
+  return false;
+#endif
+}
+
 template<typename MetricType,
          typename StatisticType,
          typename MatType,
@@ -616,8 +638,21 @@ void SpillTree<MetricType, StatisticType, MatType, HyperplaneType, SplitType>::
 
   // Now we will recursively split the children by calling their constructors
   // (which perform this splitting process).
-  left = new SpillTree(this, leftPoints, tau, maxLeafSize, rho);
-  right = new SpillTree(this, rightPoints, tau, maxLeafSize, rho);
+#ifdef MLPACK_HAS_OPENMP_TASKS
+  if (ParallelBuild(leftPoints.n_elem + rightPoints.n_elem))
+  {
+    #pragma omp task shared(leftPoints)
+    left = new SpillTree(this, leftPoints, tau, maxLeafSize, rho);
+    #pragma omp task shared(rightPoints)
+    right = new SpillTree(this, rightPoints, tau, maxLeafSize, rho);
+    #pragma omp taskwait
+  }
+  else
+#endif
+  {
+    left = new SpillTree(this, leftPoints, tau, maxLeafSize, rho);
+    right = new SpillTree(this, rightPoints, tau, maxLeafSize, rho);
+  }
 
   // Update count number, to represent the number of descendant points.
   count = left->NumDescendants() + right->NumDescendants();
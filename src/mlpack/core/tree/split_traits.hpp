@@ -0,0 +1,42 @@
+/**
+ * @file split_traits.hpp
+ *
+ * This file implements the basic, unspecialized SplitTraits class, which
+ * provides information about the classes that split the nodes of binary space
+ * trees and spill trees.  If you create a split class, you may specialize this
+ * class with the characteristics of your split.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_SPLIT_TRAITS_HPP
+#define MLPACK_CORE_TREE_SPLIT_TRAITS_HPP
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * The SplitTraits class provides compile-time information on the
+ * characteristics of a given split type.  The default values are the
+ * conservative ones, so a split type that does not specialize this class is
+ * treated as if it could not be used in parallel.
+ */
+template<typename SplitType>
+class SplitTraits
+{
+ public:
+  /**
+   * This is true if splitting a node neither modifies the split object nor
+   * draws random numbers, so that several nodes can be split at the same time
+   * and the resulting tree does not depend on the order in which the nodes are
+   * split.  Trees are only built in parallel with such split types.
+   */
+  static const bool IsDeterministic = false;
+};
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
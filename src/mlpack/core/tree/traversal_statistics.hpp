@@ -0,0 +1,152 @@
+/**
+ * @file traversal_statistics.hpp
+ *
+ * A summary of the work done by a tree-based search, for all of the tree-based
+ * algorithms.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_TRAVERSAL_STATISTICS_HPP
+#define MLPACK_CORE_TREE_TRAVERSAL_STATISTICS_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <chrono>
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * TraversalStatistics holds the same summary of the work of a search for all
+ * of the tree-based algorithms (NeighborSearch, RangeSearch, RASearch,
+ * FastMKS, DualTreeBoruvka and DualTreeKMeans): the number of base cases and
+ * of calls to Score(), the number of nodes pruned by the traversers, and the
+ * time spent building query trees and traversing.  Each algorithm holds one,
+ * available through its Statistics() method, which is reset at the start of
+ * each search.
+ *
+ * A large number of base cases for each score usually means that the leaves
+ * are too large, and a number of scores close to the number of base cases
+ * that the leaves are too small or the tree prunes badly.
+ */
+class TraversalStatistics
+{
+ public:
+  //! Create empty statistics.
+  TraversalStatistics() { Reset(); }
+
+  //! Forget everything.
+  void Reset()
+  {
+    baseCases = 0;
+    scores = 0;
+    prunes = 0;
+    treeBuildingTime = 0.0;
+    traversalTime = 0.0;
+  }
+
+  /**
+   * Add the base cases and scores counted by the given rules.
+   *
+   * @param rules Rules with BaseCases() and Scores() methods.
+   */
+  template<typename RuleType>
+  void AddRules(const RuleType& rules)
+  {
+    baseCases += rules.BaseCases();
+    scores += rules.Scores();
+  }
+
+  /**
+   * Add the prunes counted by the given traverser.
+   *
+   * @param traverser Traverser with a NumPrunes() method.
+   */
+  template<typename TraverserType>
+  void AddTraverser(const TraverserType& traverser)
+  {
+    prunes += traverser.NumPrunes();
+  }
+
+  //! Add the counts and times of other statistics to these.
+  TraversalStatistics& operator+=(const TraversalStatistics& other)
+  {
+    baseCases += other.baseCases;
+    scores += other.scores;
+    prunes += other.prunes;
+    treeBuildingTime += other.treeBuildingTime;
+    traversalTime += other.traversalTime;
+    return *this;
+  }
+
+  //! Get the number of base cases.
+  size_t BaseCases() const { return baseCases; }
+  //! Modify the number of base cases.
+  size_t& BaseCases() { return baseCases; }
+
+  //! Get the number of calls to Score().
+  size_t Scores() const { return scores; }
+  //! Modify the number of calls to Score().
+  size_t& Scores() { return scores; }
+
+  //! Get the number of nodes pruned by the traversers.
+  size_t Prunes() const { return prunes; }
+  //! Modify the number of nodes pruned by the traversers.
+  size_t& Prunes() { return prunes; }
+
+  //! Get the time spent building query trees, in seconds.
+  double TreeBuildingTime() const { return treeBuildingTime; }
+  //! Modify the time spent building query trees, in seconds.
+  double& TreeBuildingTime() { return treeBuildingTime; }
+
+  //! Get the time spent traversing, in seconds.
+  double TraversalTime() const { return traversalTime; }
+  //! Modify the time spent traversing, in seconds.
+  double& TraversalTime() { return traversalTime; }
+
+  /**
+   * PhaseTimer adds the time from its construction to its destruction to the
+   * given time of a TraversalStatistics object, such as TraversalTime().
+   * Unlike Timer, it can be used from any thread.
+   */
+  class PhaseTimer
+  {
+   public:
+    //! Start timing into the given time.
+    explicit PhaseTimer(double& time) :
+        time(time),
+        start(std::chrono::steady_clock::now()) { }
+
+    //! Add the elapsed time.
+    ~PhaseTimer()
+    {
+      time += std::chrono::duration<double>(std::chrono::steady_clock::now() -
+          start).count();
+    }
+
+   private:
+    //! The time to add to.
+    double& time;
+    //! When the timer started.
+    std::chrono::steady_clock::time_point start;
+  };
+
+ private:
+  //! The number of base cases.
+  size_t baseCases;
+  //! The number of calls to Score().
+  size_t scores;
+  //! The number of pruned nodes.
+  size_t prunes;
+  //! The time spent building query trees.
+  double treeBuildingTime;
+  //! The time spent traversing.
+  double traversalTime;
+};
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
@@ -116,6 +116,19 @@ class TreeTraits
   static const bool UniqueNumDescendants = true;
 };
 
+/**
+ * HasFlatImage is true for tree types that can be written as a flat,
+ * pointer-free image with a SaveFlat(std::ostream&) method, and that can be
+ * constructed from such an image with a (char* image, size_t size)
+ * constructor.  Loading an image doesn't copy the dataset, so this is used to
+ * load models from memory-mapped files.  See BinarySpaceTree::SaveFlat().
+ */
+template<typename TreeType>
+struct HasFlatImage
+{
+  static const bool value = false;
+};
+
 } // namespace tree
 } // namespace mlpack
 
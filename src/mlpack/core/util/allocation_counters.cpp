@@ -0,0 +1,154 @@
+/**
+ * @file allocation_counters.cpp
+ *
+ * Implementation of AllocationCounters.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "allocation_counters.hpp"
+#include "arena_allocator.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+
+using namespace mlpack;
+
+namespace {
+
+// The size of each block and the capacity of its arena block (0 if it comes
+// from malloc()) are stored before it, in a header that keeps the alignment
+// given by malloc().  The header of an arena block is at the end of its first
+// ArenaAllocator::Alignment bytes, so the block keeps the arena's alignment.
+const size_t HeaderSize = 16;
+
+// The number of allocations (and of those from the arena) and of allocated
+// bytes since the start of the program, the memory held, and its peak since
+// the start of the innermost running region.
+std::atomic<size_t> totalAllocations(0);
+std::atomic<size_t> totalArenaAllocations(0);
+std::atomic<size_t> totalBytes(0);
+std::atomic<size_t> current(0);
+std::atomic<size_t> peak(0);
+
+// Raise the peak to the given value, if it is lower.
+void RaisePeak(const size_t value)
+{
+  size_t old = peak.load();
+  while (value > old && !peak.compare_exchange_weak(old, value)) { }
+}
+
+} // anonymous namespace
+
+bool AllocationCounters::Enabled()
+{
+#if defined(MLPACK_TRACK_ALLOCATIONS) || defined(MLPACK_ARENA_ALLOCATOR)
+  return true;
+#else
+  return false;
+#endif
+}
+
+void* AllocationCounters::Allocate(const size_t bytes)
+{
+  char* memory;
+  size_t capacity = 0;
+  const size_t threshold = ArenaAllocator::Threshold();
+  if (threshold != 0 && bytes >= threshold)
+  {
+    char* block = (char*) ArenaAllocator::Allocate(bytes +
+        ArenaAllocator::Alignment, capacity);
+    if (block == NULL)
+      return NULL;
+
+    memory = block + ArenaAllocator::Alignment;
+    ++totalArenaAllocations;
+  }
+  else
+  {
+    char* block = (char*) std::malloc(bytes + HeaderSize);
+    if (block == NULL)
+      return NULL;
+
+    memory = block + HeaderSize;
+  }
+
+  size_t* header = (size_t*) (memory - HeaderSize);
+  header[0] = bytes;
+  header[1] = capacity;
+
+  ++totalAllocations;
+  totalBytes += bytes;
+  RaisePeak(current += bytes);
+  return memory;
+}
+
+void AllocationCounters::Free(void* memory)
+{
+  if (memory == NULL)
+    return;
+
+  const size_t* header = (const size_t*) ((char*) memory - HeaderSize);
+  const size_t capacity = header[1];
+  current -= header[0];
+
+  if (capacity == 0)
+    std::free((char*) memory - HeaderSize);
+  else
+    ArenaAllocator::Free((char*) memory - ArenaAllocator::Alignment, capacity);
+}
+
+void AllocationCounters::Start(const std::string& region)
+{
+  if (!Enabled())
+    return;
+
+  // The peak is measured from the current level; the peak of the enclosing
+  // regions is restored when this one stops.
+  Running& state = running[region];
+  state.allocations = totalAllocations;
+  state.arenaAllocations = totalArenaAllocations;
+  state.bytes = totalBytes;
+  state.current = current;
+  state.outerPeak = peak.exchange(state.current);
+}
+
+void AllocationCounters::Stop(const std::string& region)
+{
+  if (!Enabled())
+    return;
+
+  std::map<std::string, Running>::iterator it = running.find(region);
+  if (it == running.end())
+    return;
+
+  const Running& state = it->second;
+  const size_t regionPeak = peak;
+
+  Counts& count = counts[region];
+  count.allocations += totalAllocations - state.allocations;
+  count.arenaAllocations += totalArenaAllocations - state.arenaAllocations;
+  count.bytes += totalBytes - state.bytes;
+  if (regionPeak > state.current)
+    count.peak = std::max(count.peak, regionPeak - state.current);
+
+  RaisePeak(state.outerPeak);
+  running.erase(it);
+}
+
+void AllocationCounters::Print(std::ostream& stream) const
+{
+  std::map<std::string, Counts>::const_iterator it;
+  for (it = counts.begin(); it != counts.end(); ++it)
+  {
+    stream << "  " << it->first << ": " << it->second.allocations
+        << " allocations";
+    if (it->second.arenaAllocations > 0)
+      stream << " (" << it->second.arenaAllocations << " from the arena)";
+    stream << ", " << it->second.bytes << " bytes, peak " << it->second.peak
+        << " bytes" << std::endl;
+  }
+}
@@ -0,0 +1,129 @@
+/**
+ * @file allocation_counters.hpp
+ *
+ * Counters of the memory allocated by Armadillo in the regions measured by
+ * timers.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_UTILITIES_ALLOCATION_COUNTERS_HPP
+#define MLPACK_CORE_UTILITIES_ALLOCATION_COUNTERS_HPP
+
+#include <cstddef>
+#include <map>
+#include <ostream>
+#include <string>
+
+namespace mlpack {
+
+/**
+ * AllocationCounters counts the memory allocations of Armadillo objects (such
+ * as the temporaries of arma::mat expressions) in named regions, such as the
+ * ones measured by Timer: for each region, the number of allocations, the
+ * number of allocated bytes, and the peak of the memory held by Armadillo
+ * objects above its level at the start of the region are kept.  A new
+ * temporary in an inner loop shows up as a number of allocations that grows
+ * with the number of iterations.
+ *
+ * The allocations are only seen when mlpack (and the program using it) is
+ * built with -DTRACK_ALLOCATIONS=ON or -DARENA_ALLOCATOR=ON, which define
+ * MLPACK_TRACK_ALLOCATIONS or MLPACK_ARENA_ALLOCATOR; then Armadillo allocates
+ * its memory with Allocate() and Free() (see ARMA_ALIEN_MEM_ALLOC_FUNCTION in
+ * arma_extend.hpp), and the large blocks may come from the ArenaAllocator.
+ * Otherwise, Enabled() returns false and nothing is counted.  The allocations
+ * of all the threads are counted, and like for Timer, the counts of a region
+ * that is run more than once are added.
+ *
+ * The counts are printed by mlpack programs, along with their timers, when
+ * the --verbose option is given.
+ */
+class AllocationCounters
+{
+ public:
+  //! Get whether the allocations are counted (that is, whether mlpack was
+  //! built with MLPACK_TRACK_ALLOCATIONS or MLPACK_ARENA_ALLOCATOR).
+  static bool Enabled();
+
+  /**
+   * Allocate the given number of bytes, and count them.  This is used by
+   * Armadillo; the memory must be released with Free().  Blocks of at least
+   * ArenaAllocator::Threshold() bytes (if it isn't 0) are taken from the
+   * arena.  NULL is returned if the memory can't be allocated.
+   *
+   * @param bytes Number of bytes to allocate.
+   */
+  static void* Allocate(const size_t bytes);
+
+  /**
+   * Release memory given by Allocate().
+   *
+   * @param memory Memory to release (may be NULL).
+   */
+  static void Free(void* memory);
+
+  /**
+   * Start counting the allocations of the given region.
+   *
+   * @param region Name of the region.
+   */
+  void Start(const std::string& region);
+
+  /**
+   * Stop counting the allocations of the given region, and add them to its
+   * counts.  This does nothing if the region wasn't started.
+   *
+   * @param region Name of the region.
+   */
+  void Stop(const std::string& region);
+
+  //! The counts of a region.
+  struct Counts
+  {
+    //! Number of allocations.
+    size_t allocations;
+    //! Number of allocations taken from the arena.
+    size_t arenaAllocations;
+    //! Number of allocated bytes.
+    size_t bytes;
+    //! Largest memory held above the level at the start of the region.
+    size_t peak;
+  };
+
+  //! Get the counts of each region.
+  const std::map<std::string, Counts>& RegionCounts() const { return counts; }
+
+  /**
+   * Write the counts of each region, one line per region.
+   *
+   * @param stream Stream to write to.
+   */
+  void Print(std::ostream& stream) const;
+
+ private:
+  //! The state of a running region.
+  struct Running
+  {
+    //! Number of allocations at the start.
+    size_t allocations;
+    //! Number of allocations from the arena at the start.
+    size_t arenaAllocations;
+    //! Number of allocated bytes at the start.
+    size_t bytes;
+    //! Memory held at the start.
+    size_t current;
+    //! Peak of the enclosing regions at the start.
+    size_t outerPeak;
+  };
+
+  //! The running regions.
+  std::map<std::string, Running> running;
+  //! The counts of each region.
+  std::map<std::string, Counts> counts;
+};
+
+} // namespace mlpack
+
+#endif // MLPACK_CORE_UTILITIES_ALLOCATION_COUNTERS_HPP
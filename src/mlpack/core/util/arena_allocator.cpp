@@ -0,0 +1,249 @@
+/**
+ * @file arena_allocator.cpp
+ *
+ * Implementation of ArenaAllocator.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "arena_allocator.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <vector>
+
+#ifdef _WIN32
+  #include <malloc.h>
+#else
+  #include <sys/mman.h>
+  #include <unistd.h>
+#endif
+
+using namespace mlpack;
+
+const size_t ArenaAllocator::Alignment;
+
+namespace {
+
+// The size of the transparent huge pages of x86-64 (and of most other
+// systems).
+const size_t HugePageSize = 2 * 1024 * 1024;
+
+std::atomic<size_t> threshold(0);
+std::atomic<bool> hugePages(false);
+std::atomic<size_t> poolLimit(1024 * 1024 * 1024);
+
+// The released blocks, by size.  pooledBytes is only changed with the lock
+// held.  The pool and its lock are never destroyed, since Armadillo objects
+// with static storage may be freed after them at exit.
+std::mutex& PoolMutex()
+{
+  static std::mutex* poolMutex = new std::mutex();
+  return *poolMutex;
+}
+
+std::multimap<size_t, void*>& Pool()
+{
+  static std::multimap<size_t, void*>* pool =
+      new std::multimap<size_t, void*>();
+  return *pool;
+}
+
+std::atomic<size_t> pooledBytes(0);
+
+std::atomic<size_t> mappedBlocks(0);
+std::atomic<size_t> reusedBlocks(0);
+std::atomic<size_t> heldBytes(0);
+std::atomic<size_t> peakBytes(0);
+
+size_t PageSize()
+{
+#ifdef _WIN32
+  return 4096;
+#else
+  static const size_t pageSize = (size_t) sysconf(_SC_PAGESIZE);
+  return pageSize;
+#endif
+}
+
+// Map a block of the given size from the system, aligned to the huge page size
+// if asked.
+void* MapBlock(const size_t capacity, const bool huge)
+{
+#ifdef _WIN32
+  return _aligned_malloc(capacity, huge ? HugePageSize :
+      ArenaAllocator::Alignment);
+#else
+  // To align the block to a huge page, more is mapped, and the ends are
+  // released.
+  const size_t length = capacity + (huge ? HugePageSize : 0);
+  void* mapped = mmap(NULL, length, PROT_READ | PROT_WRITE,
+      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (mapped == MAP_FAILED)
+    return NULL;
+
+  char* block = (char*) mapped;
+  if (huge)
+  {
+    char* aligned = (char*) (((uintptr_t) block + HugePageSize - 1) &
+        ~((uintptr_t) HugePageSize - 1));
+    if (aligned > block)
+      munmap(block, aligned - block);
+    const size_t tail = (block + length) - (aligned + capacity);
+    if (tail > 0)
+      munmap(aligned + capacity, tail);
+    block = aligned;
+
+  #ifdef MADV_HUGEPAGE
+    // This is only advice; without transparent huge pages, the block is
+    // backed by normal pages.
+    madvise(block, capacity, MADV_HUGEPAGE);
+  #endif
+  }
+
+  return block;
+#endif
+}
+
+void UnmapBlock(void* block, const size_t capacity)
+{
+#ifdef _WIN32
+  (void) capacity;
+  _aligned_free(block);
+#else
+  munmap(block, capacity);
+#endif
+  heldBytes -= capacity;
+}
+
+// Release blocks of the pool to the system until it holds at most the given
+// number of bytes.
+void TrimPool(const size_t limit)
+{
+  std::vector<std::pair<size_t, void*>> released;
+  {
+    std::lock_guard<std::mutex> lock(PoolMutex());
+    std::multimap<size_t, void*>& pool = Pool();
+    while (pooledBytes > limit)
+    {
+      // The largest blocks go first.
+      std::multimap<size_t, void*>::iterator it = std::prev(pool.end());
+      released.push_back(*it);
+      pooledBytes -= it->first;
+      pool.erase(it);
+    }
+  }
+
+  for (size_t i = 0; i < released.size(); ++i)
+    UnmapBlock(released[i].second, released[i].first);
+}
+
+} // anonymous namespace
+
+bool ArenaAllocator::Available()
+{
+#if defined(MLPACK_ARENA_ALLOCATOR) || defined(MLPACK_TRACK_ALLOCATIONS)
+  return true;
+#else
+  return false;
+#endif
+}
+
+void ArenaAllocator::Configure(const size_t newThreshold,
+                               const bool newHugePages,
+                               const size_t newPoolLimit)
+{
+  threshold = newThreshold;
+  hugePages = newHugePages;
+  poolLimit = newPoolLimit;
+  TrimPool(newPoolLimit);
+}
+
+size_t ArenaAllocator::Threshold() { return threshold; }
+
+bool ArenaAllocator::HugePages() { return hugePages; }
+
+size_t ArenaAllocator::PoolLimit() { return poolLimit; }
+
+void* ArenaAllocator::Allocate(const size_t bytes, size_t& capacity)
+{
+  const bool huge = hugePages;
+  const size_t granularity = huge ? HugePageSize : PageSize();
+  capacity = ((bytes + granularity - 1) / granularity) * granularity;
+
+  // A pooled block is taken if it is at most a quarter larger than needed.
+  {
+    std::lock_guard<std::mutex> lock(PoolMutex());
+    std::multimap<size_t, void*>& pool = Pool();
+    std::multimap<size_t, void*>::iterator it = pool.lower_bound(capacity);
+    if (it != pool.end() && it->first <= capacity + capacity / 4)
+    {
+      void* block = it->second;
+      capacity = it->first;
+      pooledBytes -= capacity;
+      pool.erase(it);
+      ++reusedBlocks;
+      return block;
+    }
+  }
+
+  void* block = MapBlock(capacity, huge);
+  if (block == NULL)
+    return NULL;
+
+  ++mappedBlocks;
+  const size_t held = (heldBytes += capacity);
+  size_t peak = peakBytes.load();
+  while (held > peak && !peakBytes.compare_exchange_weak(peak, held)) { }
+
+  return block;
+}
+
+void ArenaAllocator::Free(void* memory, const size_t capacity)
+{
+  if (memory == NULL)
+    return;
+
+  {
+    std::lock_guard<std::mutex> lock(PoolMutex());
+    std::multimap<size_t, void*>& pool = Pool();
+    if (pooledBytes + capacity <= poolLimit)
+    {
+      pool.insert(std::make_pair(capacity, memory));
+      pooledBytes += capacity;
+      return;
+    }
+  }
+
+  UnmapBlock(memory, capacity);
+}
+
+void ArenaAllocator::Trim()
+{
+  TrimPool(0);
+}
+
+ArenaAllocator::Usage ArenaAllocator::CurrentUsage()
+{
+  Usage usage;
+  usage.mappedBlocks = mappedBlocks;
+  usage.reusedBlocks = reusedBlocks;
+  usage.heldBytes = heldBytes;
+  usage.peakBytes = peakBytes;
+  usage.pooledBytes = pooledBytes;
+  return usage;
+}
+
+void ArenaAllocator::Print(std::ostream& stream)
+{
+  const Usage usage = CurrentUsage();
+  stream << "  " << usage.mappedBlocks << " blocks mapped, "
+      << usage.reusedBlocks << " reused from the pool; " << usage.heldBytes
+      << " bytes held (peak " << usage.peakBytes << "), of which "
+      << usage.pooledBytes << " pooled" << std::endl;
+}
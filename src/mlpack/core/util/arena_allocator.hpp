@@ -0,0 +1,123 @@
+/**
+ * @file arena_allocator.hpp
+ *
+ * An allocator of large, aligned blocks of memory backed by (transparent) huge
+ * pages, with a pool of released blocks for reuse.  Armadillo can allocate its
+ * large matrices with it.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_UTILITIES_ARENA_ALLOCATOR_HPP
+#define MLPACK_CORE_UTILITIES_ARENA_ALLOCATOR_HPP
+
+#include <cstddef>
+#include <ostream>
+
+namespace mlpack {
+
+/**
+ * ArenaAllocator gives large blocks of memory mapped directly from the system,
+ * aligned to at least Alignment bytes.  With huge pages, the blocks are
+ * aligned to (and sized in multiples of) 2 MiB and advised to be backed by
+ * transparent huge pages (on Linux), which cuts the TLB misses of traversals
+ * over large datasets.  Released blocks are kept in a pool, up to PoolLimit()
+ * bytes, and given again to allocations of about the same size, so programs
+ * that repeatedly train and free models don't fragment the heap or map the
+ * same memory again.
+ *
+ * When mlpack (and the program using it) is built with -DARENA_ALLOCATOR=ON
+ * (which defines MLPACK_ARENA_ALLOCATOR) or with -DTRACK_ALLOCATIONS=ON,
+ * Armadillo allocates its memory through AllocationCounters::Allocate(), which
+ * takes the blocks of at least Threshold() bytes from the arena.  The
+ * threshold is 0 (so the arena is not used) until Configure() is called; the
+ * mlpack programs call it with their --arena_threshold, --arena_pool and
+ * --huge_pages options, and print the usage of the arena with --verbose.
+ *
+ * All of the functions are thread-safe.
+ */
+class ArenaAllocator
+{
+ public:
+  //! The minimum alignment of the blocks, in bytes.
+  static const size_t Alignment = 64;
+
+  //! Get whether Armadillo's allocations go through the arena (that is,
+  //! whether mlpack was built with the allocation hook).
+  static bool Available();
+
+  /**
+   * Set up the arena.  Blocks already given are not changed; if the pool limit
+   * is lowered, the pool is trimmed.
+   *
+   * @param threshold Size in bytes from which Armadillo's allocations are
+   *     taken from the arena (0 to not use the arena).
+   * @param hugePages Whether to back the blocks with huge pages.
+   * @param poolLimit Largest number of bytes kept in the pool.
+   */
+  static void Configure(const size_t threshold,
+                        const bool hugePages,
+                        const size_t poolLimit);
+
+  //! Get the size from which Armadillo's allocations use the arena (0 if the
+  //! arena isn't used).
+  static size_t Threshold();
+  //! Get whether the blocks are backed by huge pages.
+  static bool HugePages();
+  //! Get the largest number of bytes kept in the pool.
+  static size_t PoolLimit();
+
+  /**
+   * Get a block of at least the given number of bytes, aligned to Alignment
+   * bytes (2 MiB with huge pages), from the pool or from the system.  NULL is
+   * returned if the memory can't be mapped.
+   *
+   * @param bytes Number of bytes needed.
+   * @param capacity Set to the size of the block, which must be given back to
+   *     Free().
+   */
+  static void* Allocate(const size_t bytes, size_t& capacity);
+
+  /**
+   * Release a block given by Allocate() to the pool, or to the system if the
+   * pool is full.
+   *
+   * @param memory Block to release.
+   * @param capacity Size of the block, as given by Allocate().
+   */
+  static void Free(void* memory, const size_t capacity);
+
+  //! Release all of the blocks of the pool to the system.
+  static void Trim();
+
+  //! The usage of the arena since the start of the program.
+  struct Usage
+  {
+    //! Number of blocks mapped from the system.
+    size_t mappedBlocks;
+    //! Number of allocations served from the pool.
+    size_t reusedBlocks;
+    //! Number of bytes held (given out or pooled).
+    size_t heldBytes;
+    //! Largest number of bytes held.
+    size_t peakBytes;
+    //! Number of bytes in the pool.
+    size_t pooledBytes;
+  };
+
+  //! Get the usage of the arena.
+  static Usage CurrentUsage();
+
+  /**
+   * Write the usage of the arena on one line.
+   *
+   * @param stream Stream to write to.
+   */
+  static void Print(std::ostream& stream);
+};
+
+} // namespace mlpack
+
+#endif // MLPACK_CORE_UTILITIES_ARENA_ALLOCATOR_HPP
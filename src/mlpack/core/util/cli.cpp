@@ -16,6 +16,7 @@
 
 #include "cli.hpp"
 #include "log.hpp"
+#include "arena_allocator.hpp"
 
 #include "cli_deleter.hpp" // To make sure we can delete the singleton.
 #include "version.hpp"
@@ -73,6 +74,19 @@ CLI::~CLI()
       Timer::Stop(i);
   }
 
+  // Save the profile, if the user asked for it.  (The option may be missing if
+  // the default options were not added, as in some tests.)
+  const bool profile = parameters.count("profile_file") &&
+      HasParam("profile_file") && !HasParam("help") && !HasParam("info");
+  if (profile)
+    Profiler::WriteTrace(GetParam<std::string>("profile_file"));
+
+  // Save the hardware counters of the timers, if the user asked for them.
+  if (parameters.count("perf_counters_file") &&
+      HasParam("perf_counters_file") && timer.Counters().Enabled() &&
+      !HasParam("help") && !HasParam("info"))
+    timer.Counters().Save(GetParam<std::string>("perf_counters_file"));
+
   // Did the user ask for verbose output?  If so we need to print everything.
   // But only if the user did not ask for help or info.
   if (HasParam("verbose") && !HasParam("help") && !HasParam("info"))
@@ -106,6 +120,36 @@ CLI::~CLI()
       Log::Info << "  " << i << ": ";
       timer.PrintTimer((*it).first);
     }
+
+    if (timer.Counters().Enabled())
+    {
+      std::ostringstream counts;
+      timer.Counters().Print(counts);
+      Log::Info << "Hardware counters of the program timers:" << std::endl
+          << counts.str();
+    }
+
+    if (AllocationCounters::Enabled())
+    {
+      std::ostringstream counts;
+      timer.Allocations().Print(counts);
+      Log::Info << "Armadillo allocations of the program timers:" << std::endl
+          << counts.str();
+    }
+
+    if (ArenaAllocator::Threshold() != 0)
+    {
+      std::ostringstream usage;
+      ArenaAllocator::Print(usage);
+      Log::Info << "Arena allocator:" << std::endl << usage.str();
+    }
+
+    if (profile)
+    {
+      std::ostringstream report;
+      Profiler::Report(report);
+      Log::Info << "Profiled regions:" << std::endl << report.str();
+    }
   }
 
   // Notify the user if we are debugging, but only if we actually parsed the
@@ -324,6 +368,47 @@ void CLI::ParseCommandLine(int argc, char** line)
     Log::Info.ignoreInput = false;
   }
 
+  // Record each profiled region if the user wants a trace of them.
+  if (GetSingleton().parameters.count("profile_file") &&
+      HasParam("profile_file"))
+    Profiler::Enable(true);
+
+  // Count hardware events around the timers if the user asked for them.
+  const bool counters = (GetSingleton().parameters.count("perf_counters") &&
+      HasParam("perf_counters")) ||
+      (GetSingleton().parameters.count("perf_counters_file") &&
+      HasParam("perf_counters_file"));
+  if (counters && !GetSingleton().timer.EnableCounters())
+  {
+    Log::Warn << "Hardware performance counters are not available on this "
+        << "system (on Linux, check /proc/sys/kernel/perf_event_paranoid); "
+        << "they will not be reported." << std::endl;
+  }
+
+  // Set up the arena allocator if the user asked for it.
+  if (GetSingleton().parameters.count("arena_threshold") &&
+      HasParam("arena_threshold"))
+  {
+    const int threshold = GetParam<int>("arena_threshold");
+    const int pool = GetParam<int>("arena_pool");
+    if (threshold < 0 || pool < 0)
+    {
+      Log::Fatal << "Invalid arena settings: --arena_threshold and "
+          << "--arena_pool must not be negative." << std::endl;
+    }
+
+    if (!ArenaAllocator::Available())
+    {
+      Log::Warn << "mlpack was not built with ARENA_ALLOCATOR; "
+          << "--arena_threshold is ignored." << std::endl;
+    }
+    else
+    {
+      ArenaAllocator::Configure(size_t(threshold) * 1024,
+          HasParam("huge_pages"), size_t(pool) * 1024 * 1024);
+    }
+  }
+
   // Notify the user if we are debugging.  This is not done in the constructor
   // because the output streams may not be set up yet.  We also don't want this
   // message twice if the user just asked for help or information.
@@ -512,3 +597,20 @@ PARAM_STRING_IN("info", "Get help on a specific module or option.", "", "");
 PARAM_FLAG("verbose", "Display informational messages and the full list of "
     "parameters and timers at the end of execution.", "v");
 PARAM_FLAG("version", "Display the version of mlpack.", "V");
+PARAM_STRING_IN("profile_file", "If specified, the time spent by each thread "
+    "in each profiled region is saved to this file as a Chrome trace (JSON).",
+    "", "");
+PARAM_FLAG("perf_counters", "If set, hardware performance counters (cycles, "
+    "instructions, last-level cache misses and branch misses) are read around "
+    "each program timer on Linux, and printed with the timers when --verbose "
+    "is given.", "");
+PARAM_STRING_IN("perf_counters_file", "If specified, hardware performance "
+    "counters are read around each program timer on Linux, and saved to this "
+    "file as CSV.", "", "");
+PARAM_INT_IN("arena_threshold", "If mlpack was built with ARENA_ALLOCATOR, "
+    "matrices of at least this many kilobytes are allocated from aligned, "
+    "pooled arenas (0 to not use the arenas).", "", 0);
+PARAM_INT_IN("arena_pool", "Number of megabytes of released arena blocks kept "
+    "for reuse.", "", 1024);
+PARAM_FLAG("huge_pages", "If set, the arena blocks are backed by transparent "
+    "huge pages.", "");
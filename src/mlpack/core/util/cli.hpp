@@ -25,6 +25,7 @@
 #include <mlpack/prereqs.hpp>
 
 #include "timers.hpp"
+#include "profiler.hpp"
 #include "param.hpp"
 
 
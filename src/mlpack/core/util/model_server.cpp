@@ -0,0 +1,124 @@
+/**
+ * @file model_server.cpp
+ *
+ * Implementation of ModelServer.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "model_server.hpp"
+
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+using namespace mlpack;
+using namespace mlpack::util;
+
+ModelServer::ModelServer(std::istream& input, std::ostream& output) :
+    input(input),
+    output(output)
+{
+  // Nothing to do.
+}
+
+size_t ModelServer::Serve(const Handler& handler)
+{
+  size_t requests = 0;
+  while (ReadRequest())
+  {
+    try
+    {
+      handler(request, response);
+      WriteResponse();
+    }
+    catch (std::exception& e)
+    {
+      WriteError(e.what());
+    }
+
+    output.flush();
+    if (!output.good())
+      throw std::runtime_error("ModelServer::Serve(): cannot write response");
+
+    ++requests;
+  }
+
+  return requests;
+}
+
+size_t ModelServer::ServeStandardStreams(const Handler& handler)
+{
+  // Send std::cout to the standard error, and keep its buffer for the
+  // responses.
+  std::streambuf* standardOutput = std::cout.rdbuf(std::cerr.rdbuf());
+  std::ostream output(standardOutput);
+
+  size_t requests;
+  try
+  {
+    ModelServer server(std::cin, output);
+    requests = server.Serve(handler);
+  }
+  catch (...)
+  {
+    std::cout.rdbuf(standardOutput);
+    throw;
+  }
+
+  std::cout.rdbuf(standardOutput);
+  return requests;
+}
+
+bool ModelServer::ReadRequest()
+{
+  uint64_t size[2];
+  input.read((char*) size, sizeof(size));
+  if (input.gcount() == 0 && input.eof())
+    return false;
+  if (!input.good())
+    throw std::runtime_error("ModelServer::Serve(): truncated request header");
+  if (size[0] == 0 && size[1] == 0)
+    return false;
+
+  // set_size() keeps the memory if the size doesn't change.
+  request.set_size(size[0], size[1]);
+  input.read((char*) request.memptr(), sizeof(double) * request.n_elem);
+  if (!input.good() && !(input.eof() && input.gcount() ==
+      std::streamsize(sizeof(double) * request.n_elem)))
+  {
+    std::ostringstream error;
+    error << "ModelServer::Serve(): truncated request (expected "
+        << request.n_elem << " values)";
+    throw std::runtime_error(error.str());
+  }
+
+  return true;
+}
+
+void ModelServer::WriteResponse()
+{
+  Write(0);
+  Write(response.size());
+  for (size_t i = 0; i < response.size(); ++i)
+  {
+    Write(response[i].n_rows);
+    Write(response[i].n_cols);
+    output.write((const char*) response[i].memptr(),
+        sizeof(double) * response[i].n_elem);
+  }
+}
+
+void ModelServer::WriteError(const std::string& message)
+{
+  Write(1);
+  Write(message.size());
+  output.write(message.data(), message.size());
+}
+
+void ModelServer::Write(const uint64_t value)
+{
+  output.write((const char*) &value, sizeof(value));
+}
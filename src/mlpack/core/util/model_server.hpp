@@ -0,0 +1,119 @@
+/**
+ * @file model_server.hpp
+ *
+ * A server that answers many requests to a model loaded once, over a compact
+ * binary protocol.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_UTILITIES_MODEL_SERVER_HPP
+#define MLPACK_CORE_UTILITIES_MODEL_SERVER_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include <functional>
+#include <istream>
+#include <ostream>
+
+namespace mlpack {
+namespace util {
+
+/**
+ * A ModelServer reads requests from an input stream and writes the responses
+ * to an output stream, so that a program can load its model once and then
+ * answer many requests (the --serve option of mlpack_knn and mlpack_nbc).
+ * Each request is a matrix of points, and each response is a list of
+ * matrices, computed by a handler.  The request matrix and the response
+ * matrices are kept between requests, so that requests of the same size don't
+ * allocate memory.
+ *
+ * All numbers are written in the byte order of the machine, as 64-bit
+ * unsigned integers (u64) or 64-bit floating-point numbers (f64).  A request
+ * is:
+ *
+ *  - u64 rows, u64 cols: the size of the matrix; 0 and 0 end the session,
+ *  - rows * cols f64: the matrix, in column-major order.
+ *
+ * A response is a u64 status, then, if the status is 0 (success):
+ *
+ *  - u64 count: the number of matrices,
+ *  - for each matrix, u64 rows, u64 cols and rows * cols f64 in column-major
+ *    order;
+ *
+ * and if the status is 1 (the handler threw an exception):
+ *
+ *  - u64 length, then the error message, in length bytes.
+ *
+ * The session also ends at the end of the input.  The output is flushed after
+ * each response.
+ */
+class ModelServer
+{
+ public:
+  /**
+   * The handler answers one request: it is given the request matrix (which it
+   * may modify or move from) and fills the response matrices (the vector holds
+   * the matrices of the last response).  It may throw an exception to send an
+   * error response.
+   */
+  typedef std::function<void(arma::mat& request,
+                             std::vector<arma::mat>& response)> Handler;
+
+  /**
+   * Create the server for the given streams, which must be binary.
+   *
+   * @param input Stream to read requests from.
+   * @param output Stream to write responses to.
+   */
+  ModelServer(std::istream& input, std::ostream& output);
+
+  /**
+   * Answer requests with the given handler until the session ends.  A
+   * std::runtime_error is thrown if a request is truncated or the output
+   * can't be written.  This returns the number of answered requests.
+   *
+   * @param handler Function that answers each request.
+   */
+  size_t Serve(const Handler& handler);
+
+  /**
+   * Answer requests from the standard input on the standard output, until the
+   * session ends.  While serving, everything written to std::cout (such as
+   * the output of Log) goes to the standard error instead, so that it doesn't
+   * mix with the responses.
+   *
+   * @param handler Function that answers each request.
+   */
+  static size_t ServeStandardStreams(const Handler& handler);
+
+ private:
+  //! Read the next request into the request matrix; return false at the end
+  //! of the session.
+  bool ReadRequest();
+
+  //! Write the response matrices.
+  void WriteResponse();
+
+  //! Write an error response with the given message.
+  void WriteError(const std::string& message);
+
+  //! Write the given number.
+  void Write(const uint64_t value);
+
+  //! The input stream.
+  std::istream& input;
+  //! The output stream.
+  std::ostream& output;
+  //! The matrix of the current request.
+  arma::mat request;
+  //! The matrices of the current response.
+  std::vector<arma::mat> response;
+};
+
+} // namespace util
+} // namespace mlpack
+
+#endif
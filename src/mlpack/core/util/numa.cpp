@@ -0,0 +1,145 @@
+/**
+ * @file numa.cpp
+ *
+ * Implementation of NUMA.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "numa.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+  #include <sched.h>
+#endif
+
+using namespace mlpack;
+
+const size_t NUMA::FirstTouchThreshold;
+
+namespace {
+
+// Read the setting from the environment at startup.
+bool EnabledFromEnvironment()
+{
+  const char* value = std::getenv("MLPACK_NUMA");
+  return (value != NULL) && (std::string(value) == "1");
+}
+
+std::atomic<bool> enabled(EnabledFromEnvironment());
+
+// Parse a list of CPUs like "0-7,16-23".
+std::vector<int> ParseCPUList(const std::string& list)
+{
+  std::vector<int> cpus;
+  std::istringstream stream(list);
+  std::string range;
+  while (std::getline(stream, range, ','))
+  {
+    const size_t dash = range.find('-');
+    const int first = std::atoi(range.substr(0, dash).c_str());
+    const int last = (dash == std::string::npos) ? first :
+        std::atoi(range.substr(dash + 1).c_str());
+    for (int cpu = first; cpu <= last; ++cpu)
+      cpus.push_back(cpu);
+  }
+
+  return cpus;
+}
+
+// The CPUs of each node, read once.  A machine whose nodes can't be read has a
+// single node.
+const std::vector<std::vector<int>>& NodeCPUs()
+{
+  static const std::vector<std::vector<int>> nodes = []()
+  {
+    std::vector<std::vector<int>> result;
+#ifdef __linux__
+    while (true)
+    {
+      std::ostringstream path;
+      path << "/sys/devices/system/node/node" << result.size() << "/cpulist";
+      std::ifstream file(path.str());
+      std::string list;
+      if (!file.is_open() || !std::getline(file, list))
+        break;
+
+      std::vector<int> cpus = ParseCPUList(list);
+      // Nodes without CPUs (memory-only nodes) end the list.
+      if (cpus.empty())
+        break;
+      result.push_back(cpus);
+    }
+#endif
+    return result;
+  }();
+
+  return nodes;
+}
+
+} // anonymous namespace
+
+bool NUMA::Enabled()
+{
+  return enabled;
+}
+
+void NUMA::Enable(const bool enable)
+{
+  enabled = enable;
+}
+
+size_t NUMA::Nodes()
+{
+  return std::max(NodeCPUs().size(), (size_t) 1);
+}
+
+void NUMA::PinThread()
+{
+#if defined(__linux__) && defined(HAS_OPENMP)
+  if (!Enabled() || Nodes() < 2)
+    return;
+
+  const size_t threads = omp_get_num_threads();
+  const size_t node = omp_get_thread_num() * Nodes() / threads;
+
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  const std::vector<int>& cpus = NodeCPUs()[node];
+  for (size_t i = 0; i < cpus.size(); ++i)
+    CPU_SET(cpus[i], &set);
+
+  // If the pinning fails (for instance, the CPUs are outside of the cgroup of
+  // the program), the thread just keeps running where it is.
+  sched_setaffinity(0, sizeof(set), &set);
+#endif
+}
+
+NUMA::LoopSchedule::LoopSchedule(const size_t chunk)
+{
+#ifdef HAS_OPENMP
+  omp_get_schedule(&previousKind, &previousChunk);
+  if (Enabled())
+    omp_set_schedule(omp_sched_static, 0);
+  else
+    omp_set_schedule(omp_sched_dynamic, (int) chunk);
+#else
+  (void) chunk;
+#endif
+}
+
+NUMA::LoopSchedule::~LoopSchedule()
+{
+#ifdef HAS_OPENMP
+  omp_set_schedule(previousKind, previousChunk);
+#endif
+}
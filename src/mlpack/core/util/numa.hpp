@@ -0,0 +1,125 @@
+/**
+ * @file numa.hpp
+ *
+ * Placement of datasets and threads on the nodes of NUMA (multi-socket)
+ * machines.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_UTILITIES_NUMA_HPP
+#define MLPACK_CORE_UTILITIES_NUMA_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+
+/**
+ * NUMA holds the opt-in NUMA placement setting.  On a multi-socket machine,
+ * the memory of a matrix lives on the node of the thread that first wrote it,
+ * which for a loaded dataset or a tree's copy of it is the single loading
+ * thread; parallel algorithms then read most of the dataset through the
+ * interconnect.  When the setting is enabled:
+ *
+ *  - the OpenMP threads are pinned to the CPUs of the nodes, thread t of n
+ *    going to node (t * nodes / n), so that consecutive threads share a node;
+ *  - data::Load() and the construction of BinarySpaceTree copy the dataset
+ *    with FirstTouch(), so that each contiguous range of columns lives on the
+ *    node of the threads that handle it with a static schedule.  The points of
+ *    a subtree are contiguous, so each subtree lives on a single node (apart
+ *    from the subtrees that straddle two ranges);
+ *  - the parallel traversals of NeighborSearch and RangeSearch hand the
+ *    subtrees (or query points) to the threads in dataset order with a static
+ *    schedule (see LoopSchedule), so that each thread mostly reads points on
+ *    its own node.
+ *
+ * The setting is disabled by default, and can be enabled with Enable() or by
+ * setting the MLPACK_NUMA environment variable to 1 before the program starts.
+ * It has no effect on machines with a single node, or without OpenMP.  The
+ * nodes are read from /sys/devices/system/node, so the placement is only done
+ * on Linux; no NUMA library is needed, since Linux places pages on the node of
+ * the thread that first touches them.  Note that the pinning of a thread
+ * outlives the parallel region that pinned it (the OpenMP threads are reused),
+ * so the master thread stays on the first node.
+ */
+class NUMA
+{
+ public:
+  //! Get whether NUMA placement is enabled.
+  static bool Enabled();
+
+  /**
+   * Enable or disable NUMA placement.  Threads that were already pinned stay
+   * pinned.
+   *
+   * @param enable Whether to enable NUMA placement.
+   */
+  static void Enable(const bool enable = true);
+
+  //! Get the number of NUMA nodes of the machine (1 if it isn't known).
+  static size_t Nodes();
+
+  /**
+   * Pin the calling OpenMP thread to the CPUs of its node, if NUMA placement
+   * is enabled and the machine has more than one node.  This is meant to be
+   * called by each thread at the start of a parallel region.
+   */
+  static void PinThread();
+
+  /**
+   * Move the memory of the given matrix so that each contiguous range of
+   * columns lives on the node of the threads that get it with a static
+   * schedule, by copying the matrix in parallel from pinned threads.  This
+   * does nothing if NUMA placement is disabled, if the machine has one node,
+   * if the matrix is smaller than FirstTouchThreshold elements, or if it uses
+   * memory that it doesn't own.
+   *
+   * @param matrix Matrix to place.
+   */
+  template<typename eT>
+  static void FirstTouch(arma::Mat<eT>& matrix);
+
+  //! Other matrix types (such as sparse matrices) are not placed.
+  template<typename MatType>
+  static void FirstTouch(MatType& /* matrix */) { }
+
+  //! The number of elements under which matrices are not placed.
+  static const size_t FirstTouchThreshold = 1 << 16;
+
+  /**
+   * LoopSchedule sets the schedule of the `schedule(runtime)` OpenMP loops
+   * that start while it exists: a static schedule if NUMA placement is
+   * enabled, or a dynamic schedule with the given chunk size otherwise.  The
+   * previous schedule is restored when it is destroyed.
+   */
+  class LoopSchedule
+  {
+   public:
+    /**
+     * Set the runtime schedule.
+     *
+     * @param chunk Chunk size of the dynamic schedule.
+     */
+    LoopSchedule(const size_t chunk = 1);
+
+    //! Restore the previous runtime schedule.
+    ~LoopSchedule();
+
+   private:
+#ifdef HAS_OPENMP
+    //! The previous schedule.
+    omp_sched_t previousKind;
+    //! The previous chunk size.
+    int previousChunk;
+#endif
+  };
+};
+
+} // namespace mlpack
+
+// Include implementation.
+#include "numa_impl.hpp"
+
+#endif // MLPACK_CORE_UTILITIES_NUMA_HPP
@@ -0,0 +1,56 @@
+/**
+ * @file numa_impl.hpp
+ *
+ * Implementation of NUMA::FirstTouch().
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_UTILITIES_NUMA_IMPL_HPP
+#define MLPACK_CORE_UTILITIES_NUMA_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "numa.hpp"
+
+namespace mlpack {
+
+template<typename eT>
+void NUMA::FirstTouch(arma::Mat<eT>& matrix)
+{
+  if (!Enabled() || Nodes() < 2 || matrix.n_elem < FirstTouchThreshold ||
+      matrix.mem_state != 0)
+    return;
+
+  // The memory of a new matrix of this size is not written by Armadillo, so
+  // its pages are placed when the pinned threads copy the columns.
+  arma::Mat<eT> placed;
+  placed.set_size(matrix.n_rows, matrix.n_cols);
+
+  #pragma omp parallel
+  {
+    PinThread();
+
+#ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables. If we're building for Visual Studio,
+    // use the intmax_t type instead.
+    #pragma omp for schedule(static)
+    for (intmax_t i = 0; i < (intmax_t) matrix.n_cols; ++i)
+#else
+    #pragma omp for schedule(static)
+    for (size_t i = 0; i < matrix.n_cols; ++i)
+#endif
+    {
+      std::copy(matrix.colptr(i), matrix.colptr(i) + matrix.n_rows,
+          placed.colptr(i));
+    }
+  }
+
+  matrix.steal_mem(placed);
+}
+
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,203 @@
+/**
+ * @file perf_counters.cpp
+ *
+ * Implementation of PerfCounters.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "perf_counters.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+#ifdef __linux__
+  #include <linux/perf_event.h>
+  #include <sys/syscall.h>
+  #include <unistd.h>
+#endif
+
+using namespace mlpack;
+
+const size_t PerfCounters::NumEvents;
+
+PerfCounters::PerfCounters() : enabled(false), fds(NumEvents, -1)
+{
+  // Nothing to do.
+}
+
+PerfCounters::~PerfCounters()
+{
+#ifdef __linux__
+  for (size_t i = 0; i < NumEvents; ++i)
+    if (fds[i] != -1)
+      close(fds[i]);
+#endif
+}
+
+bool PerfCounters::Enable()
+{
+  if (enabled)
+    return true;
+
+#ifdef __linux__
+  const unsigned long long configs[NumEvents] = {
+      PERF_COUNT_HW_CPU_CYCLES,
+      PERF_COUNT_HW_INSTRUCTIONS,
+      PERF_COUNT_HW_CACHE_MISSES,
+      PERF_COUNT_HW_BRANCH_MISSES };
+
+  for (size_t i = 0; i < NumEvents; ++i)
+  {
+    struct perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = configs[i];
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+
+    // Count the calling thread on any CPU.  The counters run all the time;
+    // regions are measured by the difference of two reads.
+    fds[i] = (int) syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+    if (fds[i] != -1)
+      enabled = true;
+  }
+#endif
+
+  return enabled;
+}
+
+bool PerfCounters::Available(const size_t event) const
+{
+  return (event < NumEvents) && (fds[event] != -1);
+}
+
+std::string PerfCounters::EventName(const size_t event)
+{
+  switch (event)
+  {
+    case 0:
+      return "cycles";
+    case 1:
+      return "instructions";
+    case 2:
+      return "llc_misses";
+    case 3:
+      return "branch_misses";
+    default:
+    {
+      std::ostringstream error;
+      error << "PerfCounters::EventName(): invalid event " << event;
+      throw std::invalid_argument(error.str());
+    }
+  }
+}
+
+void PerfCounters::Read(std::vector<unsigned long long>& values) const
+{
+  values.assign(NumEvents, 0);
+#ifdef __linux__
+  for (size_t i = 0; i < NumEvents; ++i)
+  {
+    if (fds[i] == -1)
+      continue;
+
+    unsigned long long value;
+    if (read(fds[i], &value, sizeof(value)) == (ssize_t) sizeof(value))
+      values[i] = value;
+  }
+#endif
+}
+
+void PerfCounters::Start(const std::string& region)
+{
+  if (!enabled)
+    return;
+
+  Read(startValues[region]);
+}
+
+void PerfCounters::Stop(const std::string& region)
+{
+  if (!enabled)
+    return;
+
+  std::map<std::string, std::vector<unsigned long long>>::iterator it =
+      startValues.find(region);
+  if (it == startValues.end())
+    return;
+
+  std::vector<unsigned long long> values;
+  Read(values);
+
+  std::vector<unsigned long long>& count = counts[region];
+  count.resize(NumEvents, 0);
+  for (size_t i = 0; i < NumEvents; ++i)
+    count[i] += values[i] - it->second[i];
+
+  startValues.erase(it);
+}
+
+void PerfCounters::Print(std::ostream& stream) const
+{
+  std::map<std::string, std::vector<unsigned long long>>::const_iterator it;
+  for (it = counts.begin(); it != counts.end(); ++it)
+  {
+    stream << "  " << it->first << ":";
+    for (size_t i = 0; i < NumEvents; ++i)
+    {
+      stream << " " << EventName(i) << " ";
+      if (Available(i))
+        stream << it->second[i];
+      else
+        stream << "n/a";
+    }
+
+    // The instructions per cycle tell how well the region uses the CPU.
+    if (Available(0) && Available(1) && it->second[0] > 0)
+    {
+      const std::ios::fmtflags flags = stream.flags();
+      const std::streamsize precision = stream.precision();
+      stream << " (" << std::fixed << std::setprecision(2)
+          << ((double) it->second[1] / it->second[0]) << " IPC)";
+      stream.flags(flags);
+      stream.precision(precision);
+    }
+    stream << std::endl;
+  }
+}
+
+void PerfCounters::Save(const std::string& filename) const
+{
+  std::ofstream stream(filename.c_str());
+  if (!stream.is_open())
+  {
+    std::ostringstream error;
+    error << "PerfCounters::Save(): cannot open file '" << filename << "'";
+    throw std::runtime_error(error.str());
+  }
+
+  stream << "region";
+  for (size_t i = 0; i < NumEvents; ++i)
+    stream << "," << EventName(i);
+  stream << std::endl;
+
+  std::map<std::string, std::vector<unsigned long long>>::const_iterator it;
+  for (it = counts.begin(); it != counts.end(); ++it)
+  {
+    stream << it->first;
+    for (size_t i = 0; i < NumEvents; ++i)
+    {
+      stream << ",";
+      if (Available(i))
+        stream << it->second[i];
+    }
+    stream << std::endl;
+  }
+}
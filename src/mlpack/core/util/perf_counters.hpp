@@ -0,0 +1,134 @@
+/**
+ * @file perf_counters.hpp
+ *
+ * Hardware performance counters for the regions measured by timers.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_UTILITIES_PERF_COUNTERS_HPP
+#define MLPACK_CORE_UTILITIES_PERF_COUNTERS_HPP
+
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace mlpack {
+
+/**
+ * PerfCounters counts hardware events (CPU cycles, instructions, last-level
+ * cache misses and branch misses) in named regions, such as the ones measured
+ * by Timer.  On Linux, the counters of the perf_event interface are used; on
+ * other systems, or if the kernel does not allow them (see
+ * /proc/sys/kernel/perf_event_paranoid), Enable() returns false and nothing is
+ * counted.
+ *
+ * Only the events of the thread that called Enable() are counted; work done
+ * by OpenMP worker threads inside a region is not included.  Like for Timer,
+ * the counts of a region that is run more than once are added.
+ *
+ * The counters are used by mlpack programs, around each of their timers, when
+ * the --perf_counters or --perf_counters_file option is given.
+ */
+class PerfCounters
+{
+ public:
+  //! The number of counted events.
+  static const size_t NumEvents = 4;
+
+  //! Create the object; nothing is counted until Enable() is called.
+  PerfCounters();
+
+  //! Close the counters.
+  ~PerfCounters();
+
+  PerfCounters(const PerfCounters&) = delete;
+  PerfCounters& operator=(const PerfCounters&) = delete;
+
+  /**
+   * Open the counters.  This returns false if no counter is available; some
+   * of the events may still be unavailable when it returns true (see
+   * Available()).
+   */
+  bool Enable();
+
+  //! Get whether the counters are open.
+  bool Enabled() const { return enabled; }
+
+  /**
+   * Get whether the given event can be counted.
+   *
+   * @param event Index of the event.
+   */
+  bool Available(const size_t event) const;
+
+  /**
+   * Get the name of the given event.
+   *
+   * @param event Index of the event.
+   */
+  static std::string EventName(const size_t event);
+
+  /**
+   * Start counting the events of the given region.  This does nothing if the
+   * counters aren't enabled.
+   *
+   * @param region Name of the region.
+   */
+  void Start(const std::string& region);
+
+  /**
+   * Stop counting the events of the given region, and add them to its counts.
+   * This does nothing if the counters aren't enabled or the region wasn't
+   * started.
+   *
+   * @param region Name of the region.
+   */
+  void Stop(const std::string& region);
+
+  /**
+   * Get the counts of each region, in the order of the events.  Unavailable
+   * events are counted as 0.
+   */
+  const std::map<std::string, std::vector<unsigned long long>>& Counts() const
+  {
+    return counts;
+  }
+
+  /**
+   * Write the counts of each region, one line per region, along with the
+   * instructions per cycle.
+   *
+   * @param stream Stream to write to.
+   */
+  void Print(std::ostream& stream) const;
+
+  /**
+   * Save the counts of each region to the given file as CSV, with a header
+   * line.  Unavailable events are left empty.  A std::runtime_error is thrown
+   * if the file can't be opened.
+   *
+   * @param filename File to save to.
+   */
+  void Save(const std::string& filename) const;
+
+ private:
+  //! Read the current value of each counter.
+  void Read(std::vector<unsigned long long>& values) const;
+
+  //! Whether the counters are open.
+  bool enabled;
+  //! The file descriptor of each counter, or -1 if it is unavailable.
+  std::vector<int> fds;
+  //! The values of the counters when each running region started.
+  std::map<std::string, std::vector<unsigned long long>> startValues;
+  //! The counts of each region.
+  std::map<std::string, std::vector<unsigned long long>> counts;
+};
+
+} // namespace mlpack
+
+#endif // MLPACK_CORE_UTILITIES_PERF_COUNTERS_HPP
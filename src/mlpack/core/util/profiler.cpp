@@ -0,0 +1,343 @@
+/**
+ * @file profiler.cpp
+ *
+ * Implementation of the profiler.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "profiler.hpp"
+
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+using namespace mlpack;
+using namespace std::chrono;
+
+namespace {
+
+//! One place a region was run from: the region and the path of regions it ran
+//! in.
+struct ProfileNode
+{
+  //! The region, or size_t(-1) for the root.
+  size_t id;
+  //! The nodes of the regions that ran inside of this one.
+  std::vector<size_t> children;
+  //! The total time spent in the region.
+  steady_clock::duration total;
+  //! The number of runs.
+  size_t count;
+};
+
+//! One recorded run of a region.
+struct ProfileEvent
+{
+  //! The region.
+  size_t id;
+  //! When the run started.
+  steady_clock::time_point start;
+  //! How long the run took.
+  steady_clock::duration duration;
+};
+
+//! The measurements of one thread, which only that thread writes.
+struct ThreadProfile
+{
+  //! The tree of nodes; node 0 is the root.
+  std::vector<ProfileNode> nodes;
+  //! The running regions: their nodes and start times.
+  std::vector<std::pair<size_t, steady_clock::time_point>> stack;
+  //! The recorded runs, if tracing.
+  std::vector<ProfileEvent> events;
+
+  ThreadProfile() { Clear(); }
+
+  void Clear()
+  {
+    nodes.assign(1, ProfileNode{ size_t(-1), std::vector<size_t>(),
+        steady_clock::duration::zero(), 0 });
+    stack.clear();
+    events.clear();
+  }
+};
+
+//! The names of the regions and the measurements of all threads.
+struct ProfileRegistry
+{
+  std::mutex mutex;
+  std::vector<std::string> names;
+  std::map<std::string, size_t> ids;
+  //! The profiles are never freed, so that the threads can keep pointers to
+  //! them; the index of a profile is the number of its thread in the reports.
+  std::vector<std::unique_ptr<ThreadProfile>> profiles;
+  //! The time traces are measured from.
+  steady_clock::time_point epoch = steady_clock::now();
+};
+
+ProfileRegistry& Registry()
+{
+  static ProfileRegistry registry;
+  return registry;
+}
+
+//! Get the profile of the calling thread, making it if needed.
+ThreadProfile& LocalProfile()
+{
+  static thread_local ThreadProfile* profile = NULL;
+  if (!profile)
+  {
+    ProfileRegistry& registry = Registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.profiles.emplace_back(new ThreadProfile());
+    profile = registry.profiles.back().get();
+  }
+
+  return *profile;
+}
+
+//! Write the given duration in seconds.
+void PrintDuration(std::ostream& stream, const steady_clock::duration d)
+{
+  const microseconds us = duration_cast<microseconds>(d);
+  stream << (us.count() / 1000000) << "." << std::setw(6) << std::setfill('0')
+      << (us.count() % 1000000) << std::setfill(' ') << "s";
+}
+
+//! Write the children of the given node, indented by depth.
+void ReportNode(std::ostream& stream,
+                const ThreadProfile& profile,
+                const size_t node,
+                const size_t depth,
+                const std::vector<std::string>& names)
+{
+  for (size_t child : profile.nodes[node].children)
+  {
+    const ProfileNode& c = profile.nodes[child];
+    stream << std::string(2 * depth, ' ') << names[c.id] << ": ";
+    PrintDuration(stream, c.total);
+    stream << " (" << c.count << ((c.count == 1) ? " run" : " runs") << ")"
+        << std::endl;
+    ReportNode(stream, profile, child, depth + 1, names);
+  }
+}
+
+//! Escape a string for JSON.
+std::string EscapeJSON(const std::string& str)
+{
+  std::ostringstream oss;
+  for (char c : str)
+  {
+    if (c == '"' || c == '\\')
+      oss << '\\' << c;
+    else if ((unsigned char) c < 0x20)
+      oss << "\\u" << std::hex << std::setw(4) << std::setfill('0') << (int) c
+          << std::dec;
+    else
+      oss << c;
+  }
+  return oss.str();
+}
+
+} // anonymous namespace
+
+std::atomic<bool> Profiler::enabled(false);
+std::atomic<bool> Profiler::tracing(false);
+
+size_t Profiler::Register(const std::string& name)
+{
+  ProfileRegistry& registry = Registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  std::map<std::string, size_t>::const_iterator it = registry.ids.find(name);
+  if (it != registry.ids.end())
+    return it->second;
+
+  registry.names.push_back(name);
+  registry.ids[name] = registry.names.size() - 1;
+  return registry.names.size() - 1;
+}
+
+std::string Profiler::Name(const size_t id)
+{
+  ProfileRegistry& registry = Registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  if (id >= registry.names.size())
+  {
+    std::ostringstream error;
+    error << "Profiler::Name(): no region has identifier " << id;
+    throw std::invalid_argument(error.str());
+  }
+
+  return registry.names[id];
+}
+
+void Profiler::Enable(const bool trace)
+{
+  tracing = trace;
+  enabled = true;
+}
+
+void Profiler::Disable()
+{
+  enabled = false;
+}
+
+void Profiler::Start(const size_t id)
+{
+  ThreadProfile& profile = LocalProfile();
+  const size_t parent = profile.stack.empty() ? 0 : profile.stack.back().first;
+
+  // Find the node of the region under the running region; there are few
+  // children, so a linear search is fine.
+  size_t node = 0;
+  for (size_t child : profile.nodes[parent].children)
+  {
+    if (profile.nodes[child].id == id)
+    {
+      node = child;
+      break;
+    }
+  }
+
+  if (node == 0)
+  {
+    node = profile.nodes.size();
+    profile.nodes.push_back(ProfileNode{ id, std::vector<size_t>(),
+        steady_clock::duration::zero(), 0 });
+    profile.nodes[parent].children.push_back(node);
+  }
+
+  profile.stack.emplace_back(node, steady_clock::now());
+}
+
+void Profiler::Stop(const size_t id)
+{
+  const steady_clock::time_point end = steady_clock::now();
+  ThreadProfile& profile = LocalProfile();
+  if (profile.stack.empty() || profile.nodes[profile.stack.back().first].id !=
+      id)
+  {
+    std::ostringstream error;
+    error << "Profiler::Stop(): region '" << Name(id) << "' is not the last "
+        << "region started by this thread";
+    throw std::runtime_error(error.str());
+  }
+
+  ProfileNode& node = profile.nodes[profile.stack.back().first];
+  const steady_clock::time_point start = profile.stack.back().second;
+  profile.stack.pop_back();
+
+  node.total += end - start;
+  ++node.count;
+  if (tracing.load(std::memory_order_relaxed))
+    profile.events.push_back(ProfileEvent{ id, start, end - start });
+}
+
+microseconds Profiler::Total(const std::string& name)
+{
+  ProfileRegistry& registry = Registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  steady_clock::duration total = steady_clock::duration::zero();
+  std::map<std::string, size_t>::const_iterator it = registry.ids.find(name);
+  if (it == registry.ids.end())
+    return microseconds(0);
+
+  for (const std::unique_ptr<ThreadProfile>& profile : registry.profiles)
+    for (const ProfileNode& node : profile->nodes)
+      if (node.id == it->second)
+        total += node.total;
+
+  return duration_cast<microseconds>(total);
+}
+
+size_t Profiler::Count(const std::string& name)
+{
+  ProfileRegistry& registry = Registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  size_t count = 0;
+  std::map<std::string, size_t>::const_iterator it = registry.ids.find(name);
+  if (it == registry.ids.end())
+    return 0;
+
+  for (const std::unique_ptr<ThreadProfile>& profile : registry.profiles)
+    for (const ProfileNode& node : profile->nodes)
+      if (node.id == it->second)
+        count += node.count;
+
+  return count;
+}
+
+void Profiler::Report(std::ostream& stream)
+{
+  ProfileRegistry& registry = Registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  for (size_t t = 0; t < registry.profiles.size(); ++t)
+  {
+    const ThreadProfile& profile = *registry.profiles[t];
+    if (profile.nodes[0].children.empty())
+      continue;
+
+    stream << "Thread " << t << ":" << std::endl;
+    ReportNode(stream, profile, 0, 1, registry.names);
+  }
+}
+
+void Profiler::WriteTrace(std::ostream& stream)
+{
+  ProfileRegistry& registry = Registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  const std::ios::fmtflags flags = stream.flags();
+  const std::streamsize precision = stream.precision();
+  stream << "{\"traceEvents\":[";
+  bool first = true;
+  for (size_t t = 0; t < registry.profiles.size(); ++t)
+  {
+    for (const ProfileEvent& event : registry.profiles[t]->events)
+    {
+      const double start = duration<double, std::micro>(event.start -
+          registry.epoch).count();
+      const double length = duration<double, std::micro>(
+          event.duration).count();
+
+      stream << (first ? "" : ",") << std::endl << "{\"name\":\""
+          << EscapeJSON(registry.names[event.id]) << "\",\"cat\":\"mlpack\","
+          << "\"ph\":\"X\",\"pid\":0,\"tid\":" << t << ",\"ts\":"
+          << std::fixed << std::setprecision(3) << start << ",\"dur\":"
+          << length << "}";
+      first = false;
+    }
+  }
+  stream << std::endl << "],\"displayTimeUnit\":\"ms\"}" << std::endl;
+  stream.flags(flags);
+  stream.precision(precision);
+}
+
+void Profiler::WriteTrace(const std::string& filename)
+{
+  std::ofstream stream(filename.c_str());
+  if (!stream.is_open())
+  {
+    std::ostringstream error;
+    error << "Profiler::WriteTrace(): cannot open file '" << filename << "'";
+    throw std::runtime_error(error.str());
+  }
+
+  WriteTrace(stream);
+}
+
+void Profiler::Reset()
+{
+  ProfileRegistry& registry = Registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  for (const std::unique_ptr<ThreadProfile>& profile : registry.profiles)
+    profile->Clear();
+  registry.epoch = steady_clock::now();
+}
@@ -0,0 +1,252 @@
+/**
+ * @file profiler.hpp
+ *
+ * A thread-safe profiler of nested regions of code, cheap enough to be used
+ * inside of parallel loops.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_UTILITIES_PROFILER_HPP
+#define MLPACK_CORE_UTILITIES_PROFILER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <ostream>
+#include <string>
+
+namespace mlpack {
+
+/**
+ * The Profiler measures how long each thread spends in regions of code, and
+ * how the regions nest.  Unlike Timer, which looks up a global map of names at
+ * each call and must not be used from more than one thread, each region is
+ * named by a ProfilerTimer, which is registered once, and the times are
+ * accumulated by each thread in its own storage, so the profiler can be used
+ * inside of OpenMP parallel regions.  The times of all threads are only read
+ * when a report is made, which must be done when no profiled region is
+ * running.
+ *
+ * The profiler does nothing until Enable() is called, and then a profiled
+ * region costs a couple of clock reads.  When disabled, a region costs a
+ * single atomic load; if MLPACK_NO_PROFILING is defined, the
+ * MLPACK_PROFILE_SCOPE() macro compiles to nothing at all.
+ *
+ * Regions are usually profiled with MLPACK_PROFILE_SCOPE(), which times the
+ * rest of the enclosing scope:
+ *
+ * @code
+ * void Search(...)
+ * {
+ *   MLPACK_PROFILE_SCOPE("computing_neighbors");
+ *
+ *   #pragma omp parallel for
+ *   for (size_t i = 0; i < n; ++i)
+ *   {
+ *     MLPACK_PROFILE_SCOPE("base_cases");
+ *     ...
+ *   }
+ * }
+ * @endcode
+ *
+ * A region started inside of another one in the same thread is its child in
+ * the report given by Report().  If tracing is enabled, each run of each
+ * region is also recorded, and WriteTrace() saves all of them as a Chrome
+ * trace (a JSON file that chrome://tracing and similar tools can display),
+ * with one row for each thread.  mlpack programs write such a trace when the
+ * --profile_file option is given.
+ */
+class Profiler
+{
+ public:
+  /**
+   * Register a region name and get its identifier.  Registering the same name
+   * again gives the same identifier.  This is thread-safe, but it locks, so it
+   * should be done once for each region (ProfilerTimer does that).
+   *
+   * @param name Name of the region.
+   */
+  static size_t Register(const std::string& name);
+
+  /**
+   * Get the name of a registered region.
+   *
+   * @param id Identifier of the region.
+   */
+  static std::string Name(const size_t id);
+
+  /**
+   * Start profiling.  Regions that are already running when the profiler is
+   * enabled are not measured.
+   *
+   * @param trace Whether to record each run of each region for WriteTrace(),
+   *     and not just the total times.
+   */
+  static void Enable(const bool trace = false);
+
+  //! Stop profiling; regions that are running are still measured until they
+  //! end.
+  static void Disable();
+
+  //! Get whether the profiler is enabled.
+  static bool Enabled() { return enabled.load(std::memory_order_relaxed); }
+
+  //! Get whether each run of each region is recorded.
+  static bool Tracing() { return tracing.load(std::memory_order_relaxed); }
+
+  /**
+   * Start measuring the given region in the calling thread.  Use
+   * ProfilerScope (or MLPACK_PROFILE_SCOPE()) instead of calling this.
+   *
+   * @param id Identifier of the region.
+   */
+  static void Start(const size_t id);
+
+  /**
+   * Stop measuring the given region in the calling thread.  A
+   * std::runtime_error is thrown if it isn't the last region started by the
+   * thread.
+   *
+   * @param id Identifier of the region.
+   */
+  static void Stop(const size_t id);
+
+  /**
+   * Get the total time spent in the given region by all threads, over all of
+   * the places it was run from.  This must not be called while a profiled
+   * region is running.
+   *
+   * @param name Name of the region.
+   */
+  static std::chrono::microseconds Total(const std::string& name);
+
+  /**
+   * Get the number of times the given region was run by all threads.  This
+   * must not be called while a profiled region is running.
+   *
+   * @param name Name of the region.
+   */
+  static size_t Count(const std::string& name);
+
+  /**
+   * Write the time spent in each region by each thread, with nested regions
+   * indented below the region they ran in.  This must not be called while a
+   * profiled region is running.
+   *
+   * @param stream Stream to write to.
+   */
+  static void Report(std::ostream& stream);
+
+  /**
+   * Write each recorded run of each region as a Chrome trace.  This must not
+   * be called while a profiled region is running.
+   *
+   * @param stream Stream to write to.
+   */
+  static void WriteTrace(std::ostream& stream);
+
+  /**
+   * Save each recorded run of each region as a Chrome trace into the given
+   * file.  A std::runtime_error is thrown if the file can't be opened.
+   *
+   * @param filename File to save to.
+   */
+  static void WriteTrace(const std::string& filename);
+
+  /**
+   * Forget all of the measurements (the regions stay registered).  This must
+   * not be called while a profiled region is running.
+   */
+  static void Reset();
+
+ private:
+  //! Whether the profiler is enabled.
+  static std::atomic<bool> enabled;
+  //! Whether each run is recorded.
+  static std::atomic<bool> tracing;
+};
+
+/**
+ * A ProfilerTimer names a profiled region.  It registers its name once, when
+ * it is constructed, so it should be a static object, as made by
+ * MLPACK_PROFILE_SCOPE().
+ */
+class ProfilerTimer
+{
+ public:
+  /**
+   * Register the given region name.
+   *
+   * @param name Name of the region.
+   */
+  explicit ProfilerTimer(const std::string& name) :
+      id(Profiler::Register(name)) { }
+
+  //! Get the identifier of the region.
+  size_t ID() const { return id; }
+
+ private:
+  //! The identifier of the region.
+  size_t id;
+};
+
+/**
+ * A ProfilerScope measures the given region from its construction to its
+ * destruction, if the profiler was enabled when it was constructed.
+ */
+class ProfilerScope
+{
+ public:
+  /**
+   * Start measuring the given region.
+   *
+   * @param timer The region.
+   */
+  explicit ProfilerScope(const ProfilerTimer& timer) :
+      id(timer.ID()),
+      active(Profiler::Enabled())
+  {
+    if (active)
+      Profiler::Start(id);
+  }
+
+  //! Stop measuring the region.
+  ~ProfilerScope()
+  {
+    if (active)
+      Profiler::Stop(id);
+  }
+
+  ProfilerScope(const ProfilerScope&) = delete;
+  ProfilerScope& operator=(const ProfilerScope&) = delete;
+
+ private:
+  //! The identifier of the region.
+  size_t id;
+  //! Whether the region is measured.
+  bool active;
+};
+
+} // namespace mlpack
+
+#define MLPACK_PROFILER_CONCAT_INNER(a, b) a##b
+#define MLPACK_PROFILER_CONCAT(a, b) MLPACK_PROFILER_CONCAT_INNER(a, b)
+
+/**
+ * Profile the rest of the enclosing scope as the region with the given name.
+ * The name is registered the first time the line is run.
+ */
+#ifndef MLPACK_NO_PROFILING
+  #define MLPACK_PROFILE_SCOPE(name) \
+      static const ::mlpack::ProfilerTimer \
+          MLPACK_PROFILER_CONCAT(mlpackProfilerTimer, __LINE__)(name); \
+      const ::mlpack::ProfilerScope \
+          MLPACK_PROFILER_CONCAT(mlpackProfilerScope, __LINE__)( \
+          MLPACK_PROFILER_CONCAT(mlpackProfilerTimer, __LINE__))
+#else
+  #define MLPACK_PROFILE_SCOPE(name)
+#endif
+
+#endif // MLPACK_CORE_UTILITIES_PROFILER_HPP
@@ -17,6 +17,10 @@
 #include <map>
 #include <string>
 
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
+
 using namespace mlpack;
 using namespace std::chrono;
 
@@ -25,6 +29,14 @@ using namespace std::chrono;
  */
 void Timer::Start(const std::string& name)
 {
+#ifdef HAS_OPENMP
+  // The timers aren't shared safely between threads, and concurrent runs of
+  // the same code (for instance the folds of a cross-validation) would start
+  // the same timer twice.
+  if (omp_in_parallel())
+    return;
+#endif
+
   CLI::GetSingleton().timer.StartTimer(name);
 }
 
@@ -33,6 +45,11 @@ void Timer::Start(const std::string& name)
  */
 void Timer::Stop(const std::string& name)
 {
+#ifdef HAS_OPENMP
+  if (omp_in_parallel())
+    return;
+#endif
+
   CLI::GetSingleton().timer.StopTimer(name);
 }
 
@@ -146,6 +163,8 @@ void Timers::StartTimer(const std::string& timerName)
   }
 
   timerStartTime[timerName] = currTime;
+  allocations.Start(timerName);
+  counters.Start(timerName);
 }
 
 void Timers::StopTimer(const std::string& timerName)
@@ -160,9 +179,24 @@ void Timers::StopTimer(const std::string& timerName)
 
   timerState[timerName] = false;
 
+  counters.Stop(timerName);
+  allocations.Stop(timerName);
   high_resolution_clock::time_point currTime = GetTime();
 
   // Calculate the delta time.
   timers[timerName] += duration_cast<microseconds>(currTime -
       timerStartTime[timerName]);
 }
+
+bool Timers::EnableCounters()
+{
+  if (!counters.Enable())
+    return false;
+
+  std::map<std::string, bool>::const_iterator it;
+  for (it = timerState.begin(); it != timerState.end(); ++it)
+    if (it->second)
+      counters.Start(it->first);
+
+  return true;
+}
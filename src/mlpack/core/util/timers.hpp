@@ -17,6 +17,9 @@
 #include <string>
 #include <chrono> // chrono library for cross platform timer calculation
 
+#include "allocation_counters.hpp"
+#include "perf_counters.hpp"
+
 #if defined(_WIN32)
   // uint64_t isn't defined on every windows.
   #if !defined(HAVE_UINT64_T)
@@ -45,7 +48,8 @@ class Timer
    * run, and do not reset.
    *
    * @note A std::runtime_error exception will be thrown if a timer is started
-   * twice.
+   * twice.  Timers are not started or stopped inside OpenMP parallel regions,
+   * where concurrent runs of the same code would overlap.
    *
    * @param name Name of timer to be started.
    */
@@ -120,6 +124,19 @@ class Timers
    */
   bool GetState(std::string timerName);
 
+  /**
+   * Count hardware events around each timer from now on; the timers that are
+   * running are counted from now.  Returns false if the counters aren't
+   * available.
+   */
+  bool EnableCounters();
+
+  //! Get the hardware counters of the timers.
+  const PerfCounters& Counters() const { return counters; }
+
+  //! Get the Armadillo allocation counters of the timers.
+  const AllocationCounters& Allocations() const { return allocations; }
+
  private:
   //! A map of all the timers that are being tracked.
   std::map<std::string, std::chrono::microseconds> timers;
@@ -128,6 +145,10 @@ class Timers
   //! A map for the starting values of the timers.
   std::map<std::string, std::chrono::high_resolution_clock::time_point>
       timerStartTime;
+  //! The hardware counters of the timers, if enabled.
+  PerfCounters counters;
+  //! The Armadillo allocation counters of the timers, if enabled.
+  AllocationCounters allocations;
 
   std::chrono::high_resolution_clock::time_point GetTime();
 };
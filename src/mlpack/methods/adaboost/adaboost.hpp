@@ -31,6 +31,7 @@
 #include <mlpack/prereqs.hpp>
 #include <mlpack/methods/perceptron/perceptron.hpp>
 #include <mlpack/methods/decision_stump/decision_stump.hpp>
+#include "weak_learner_trainer.hpp"
 
 namespace mlpack {
 namespace adaboost {
@@ -147,7 +148,9 @@ class AdaBoost
              const double tolerance = 1e-6);
 
   /**
-   * Classify the given test points.
+   * Classify the given test points.  The points are split into blocks, which
+   * are classified in parallel when OpenMP is available, so the Classify()
+   * function of the weak learners must be safe to call from several threads.
    *
    * @param test Testing data.
    * @param predictedLabels Vector in which to the predicted labels of the test
@@ -85,12 +85,6 @@ void AdaBoost<WeakLearnerType, MatType>::Train(
   // To be used for prediction by the weak learner.
   arma::Row<size_t> predictedLabels(labels.n_cols);
 
-  // Use tempData to modify input data for incorporating weights.
-  MatType tempData(data);
-
-  // This matrix is a helper matrix used to calculate the final hypothesis.
-  arma::mat sumFinalH = arma::zeros<arma::mat>(classes, predictedLabels.n_cols);
-
   // Load the initial weights into a 2-D matrix.
   const double initWeight = 1.0 / double(data.n_cols * classes);
   arma::mat D(classes, data.n_cols);
@@ -99,38 +93,28 @@ void AdaBoost<WeakLearnerType, MatType>::Train(
   // Weights are stored in this row vector.
   arma::rowvec weights(predictedLabels.n_cols);
 
-  // This is the final hypothesis.
-  arma::Row<size_t> finalH(predictedLabels.n_cols);
+  // 1 for the points that the weak learner of the round classifies correctly,
+  // and 0 for the others.
+  arma::rowvec correct(predictedLabels.n_cols);
+
+  // Weak learners that can reuse work between rounds (like decision stumps)
+  // prepare it here.
+  WeakLearnerTrainer<WeakLearnerType, MatType> trainer(other, data, labels);
 
   // Now, start the boosting rounds.
   for (size_t i = 0; i < iterations; i++)
   {
-    // Initialized to zero in every round.  rt is used for calculation of
-    // alphat; it is the weighted error.
-    // rt = (sum) D(i) y(i) ht(xi)
-    rt = 0.0;
-
-    // zt is used for weight normalization.
-    zt = 0.0;
-
     // Build the weight vectors.
     weights = arma::sum(D);
 
     // Use the existing weak learner to train a new one with new weights.
-    WeakLearnerType w(other, tempData, labels, weights);
-    w.Classify(tempData, predictedLabels);
+    WeakLearnerType w = trainer.Train(weights);
+    w.Classify(data, predictedLabels);
+    correct = arma::conv_to<arma::rowvec>::from(predictedLabels == labels);
 
-    // Now from predictedLabels, build ht, the weak hypothesis
-    // buildClassificationMatrix(ht, predictedLabels);
-
-    // Now, calculate alpha(t) using ht.
-    for (size_t j = 0; j < D.n_cols; j++) // instead of D, ht
-    {
-      if (predictedLabels(j) == labels(j))
-        rt += arma::accu(D.col(j));
-      else
-        rt -= arma::accu(D.col(j));
-    }
+    // rt is used for calculation of alphat; it is the weighted error.
+    // rt = (sum) D(i) y(i) ht(xi)
+    rt = 2.0 * arma::dot(weights, correct) - arma::accu(weights);
 
     if ((i > 0) && (std::abs(rt - crt) < tolerance))
       break;
@@ -153,45 +137,13 @@ void AdaBoost<WeakLearnerType, MatType>::Train(
     alpha.push_back(alphat);
     wl.push_back(w);
 
-    // Now start modifying the weights.
-    for (size_t j = 0; j < D.n_cols; j++)
-    {
-      const double expo = exp(alphat);
-      if (predictedLabels(j) == labels(j))
-      {
-        for (size_t k = 0; k < D.n_rows; k++)
-        {
-          // We calculate zt, the normalization constant.
-          D(k, j) /= expo;
-          zt += D(k, j); // * exp(-1 * alphat * yt(j,k) * ht(j,k));
-
-
-          // Add to the final hypothesis matrix.
-          // sumFinalH(k, j) += (alphat * ht(k, j));
-          if (k == labels(j))
-            sumFinalH(k, j) += (alphat); // * ht(k, j));
-          else
-            sumFinalH(k, j) -= (alphat);
-        }
-      }
-      else
-      {
-        for (size_t k = 0; k < D.n_rows; k++)
-        {
-          // We calculate zt, the normalization constant.
-          D(k, j) *= expo;
-          zt += D(k, j);
-
-          // Add to the final hypothesis matrix.
-          if (k == labels(j))
-            sumFinalH(k, j) += alphat; // * ht(k, j));
-          else
-            sumFinalH(k, j) -= alphat;
-        }
-      }
-    }
+    // Now start modifying the weights: the weights of the points classified
+    // correctly are divided by exp(alphat), and the others multiplied by it.
+    const double expo = exp(alphat);
+    D.each_row() %= (1.0 / expo - expo) * correct + expo;
 
-    // Normalize D.
+    // We calculate zt, the normalization constant, and normalize D.
+    zt = arma::accu(D);
     D /= zt;
 
     // Accumulate the value of zt for the Hamming loss bound.
@@ -207,28 +159,45 @@ void AdaBoost<WeakLearnerType, MatType>::Classify(
     const MatType& test,
     arma::Row<size_t>& predictedLabels)
 {
-  arma::Row<size_t> tempPredictedLabels(test.n_cols);
-  arma::mat cMatrix(classes, test.n_cols);
-
-  cMatrix.zeros();
   predictedLabels.set_size(test.n_cols);
 
-  for (size_t i = 0; i < wl.size(); i++)
+  // The points are classified by blocks, so that each block is read by all the
+  // weak learners while it is in the cache, and its votes are small.
+  const size_t blockSize = 1024;
+  const size_t numBlocks = (test.n_cols + blockSize - 1) / blockSize;
+
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables. If we're building for Visual Studio, use
+  // the intmax_t type instead.
+  #pragma omp parallel for schedule(static)
+  for (intmax_t b = 0; b < (intmax_t) numBlocks; ++b)
+#else
+  #pragma omp parallel for schedule(static)
+  for (size_t b = 0; b < numBlocks; ++b)
+#endif
   {
-    wl[i].Classify(test, tempPredictedLabels);
-
-    for (size_t j = 0; j < tempPredictedLabels.n_cols; j++)
-      cMatrix(tempPredictedLabels(j), j) += alpha[i];
-  }
+    const size_t begin = b * blockSize;
+    const size_t end = std::min(begin + blockSize, (size_t) test.n_cols) - 1;
+    const MatType block = test.cols(begin, end);
+
+    // The votes of the weak learners, weighted by their alpha.
+    arma::mat votes(classes, block.n_cols, arma::fill::zeros);
+    arma::Row<size_t> blockLabels;
+    for (size_t i = 0; i < wl.size(); i++)
+    {
+      wl[i].Classify(block, blockLabels);
 
-  arma::colvec cMRow;
-  arma::uword maxIndex = 0;
+      for (size_t j = 0; j < blockLabels.n_elem; j++)
+        votes(blockLabels[j], j) += alpha[i];
+    }
 
-  for (size_t i = 0; i < predictedLabels.n_cols; i++)
-  {
-    cMRow = cMatrix.unsafe_col(i);
-    cMRow.max(maxIndex);
-    predictedLabels(i) = maxIndex;
+    arma::uword maxIndex = 0;
+    for (size_t j = 0; j < votes.n_cols; j++)
+    {
+      votes.col(j).max(maxIndex);
+      predictedLabels[begin + j] = maxIndex;
+    }
   }
 }
 
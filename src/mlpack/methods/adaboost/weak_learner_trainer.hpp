@@ -0,0 +1,101 @@
+/**
+ * @file weak_learner_trainer.hpp
+ *
+ * A helper class that trains the weak learner of each round of AdaBoost.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ADABOOST_WEAK_LEARNER_TRAINER_HPP
+#define MLPACK_METHODS_ADABOOST_WEAK_LEARNER_TRAINER_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/methods/decision_stump/decision_stump.hpp>
+
+namespace mlpack {
+namespace adaboost {
+
+/**
+ * Train weak learners on the same data and labels with different weights, one
+ * per round of AdaBoost.  In general, each weak learner is trained from
+ * scratch with the constructor
+ *
+ * @code
+ * WeakLearnerType(const WeakLearnerType& other,
+ *                 const MatType& data,
+ *                 const arma::Row<size_t>& labels,
+ *                 const arma::rowvec& weights);
+ * @endcode
+ *
+ * but this class may be specialized for weak learners that can reuse work
+ * between rounds.
+ *
+ * @tparam WeakLearnerType Type of the weak learner.
+ * @tparam MatType Type of the data.
+ */
+template<typename WeakLearnerType, typename MatType>
+class WeakLearnerTrainer
+{
+ public:
+  /**
+   * Prepare to train weak learners with the parameters of the given weak
+   * learner on the given data and labels, which must outlive this object.
+   */
+  WeakLearnerTrainer(const WeakLearnerType& other,
+                     const MatType& data,
+                     const arma::Row<size_t>& labels) :
+      other(other), data(data), labels(labels) { }
+
+  //! Train a weak learner with the given weights.
+  WeakLearnerType Train(const arma::rowvec& weights) const
+  {
+    return WeakLearnerType(other, data, labels, weights);
+  }
+
+ private:
+  //! The weak learner to take the parameters from.
+  const WeakLearnerType& other;
+  //! The data to train on.
+  const MatType& data;
+  //! The labels of the data.
+  const arma::Row<size_t>& labels;
+};
+
+/**
+ * Decision stumps are trained with a DecisionStumpIndex of the data, built once
+ * before the first round, so that each round is a linear scan of each
+ * dimension instead of a sort.
+ */
+template<typename MatType>
+class WeakLearnerTrainer<decision_stump::DecisionStump<MatType>, MatType>
+{
+ public:
+  /**
+   * Build the index of the given data and labels, with the parameters of the
+   * given decision stump.
+   */
+  WeakLearnerTrainer(const decision_stump::DecisionStump<MatType>& other,
+                     const MatType& data,
+                     const arma::Row<size_t>& labels) :
+      index(data, labels, other.Classes(), other.BucketSize()) { }
+
+  //! Train a decision stump with the given weights.
+  decision_stump::DecisionStump<MatType> Train(const arma::rowvec& weights)
+      const
+  {
+    decision_stump::DecisionStump<MatType> stump;
+    stump.Train(index, weights);
+    return stump;
+  }
+
+ private:
+  //! The index of the data and labels.
+  decision_stump::DecisionStumpIndex<MatType> index;
+};
+
+} // namespace adaboost
+} // namespace mlpack
+
+#endif
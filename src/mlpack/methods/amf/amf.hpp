@@ -22,6 +22,7 @@
 
 #include <mlpack/methods/amf/update_rules/nmf_mult_dist.hpp>
 #include <mlpack/methods/amf/update_rules/nmf_als.hpp>
+#include <mlpack/methods/amf/update_rules/sparse_als.hpp>
 #include <mlpack/methods/amf/update_rules/svd_batch_learning.hpp>
 #include <mlpack/methods/amf/update_rules/svd_incomplete_incremental_learning.hpp>
 #include <mlpack/methods/amf/update_rules/svd_complete_incremental_learning.hpp>
@@ -31,6 +32,7 @@
 
 #include <mlpack/methods/amf/termination_policies/simple_residue_termination.hpp>
 #include <mlpack/methods/amf/termination_policies/simple_tolerance_termination.hpp>
+#include <mlpack/methods/amf/termination_policies/sparse_residue_termination.hpp>
 
 namespace mlpack {
 namespace amf /** Alternating Matrix Factorization **/ {
@@ -142,6 +144,19 @@ typedef amf::AMF<amf::SimpleResidueTermination,
                  amf::RandomAcolInitialization<>,
                  amf::NMFALSUpdate> NMFALSFactorizer;
 
+/**
+ * SparseALSFactorizer factorizes a sparse matrix of ratings V into two matrices
+ * W and H by alternating least squares over the observed entries of V only.
+ * The residue of SimpleResidueTermination involves every entry of W * H, so
+ * for very large matrices SparseResidueTermination, which only looks at the
+ * observed entries, is the better policy.
+ *
+ * @see SparseALSUpdate
+ */
+typedef amf::AMF<amf::SimpleResidueTermination,
+                 amf::RandomAcolInitialization<>,
+                 amf::SparseALSUpdate> SparseALSFactorizer;
+
 //! Add simple typedefs
 #ifdef MLPACK_USE_CXX11
 
@@ -67,11 +67,15 @@ class SimpleResidueTermination
    */
   bool IsConverged(arma::mat& W, arma::mat& H)
   {
-    // Calculate the norm and compute the residue, but do it by hand, so as to
-    // avoid calculating (W*H), which may be very large.
+    // Calculate the norm and compute the residue, but avoid calculating (W*H),
+    // which may be very large: the squared norm of W * h is h^T (W^T W) h, so
+    // with the small Gram matrix of W this takes O(r^2 m) time instead of
+    // O(n r m).
+    const arma::mat gram = W.t() * W;
+    const arma::rowvec squaredNorms = arma::sum(H % (gram * H));
     double norm = 0.0;
     for (size_t j = 0; j < H.n_cols; ++j)
-      norm += arma::norm(W * H.col(j), "fro");
+      norm += std::sqrt(std::max(squaredNorms[j], 0.0));
     residue = fabs(normOld - norm) / normOld;
 
     // Store the norm.
@@ -13,6 +13,7 @@
 #define _MLPACK_METHODS_AMF_SIMPLE_TOLERANCE_TERMINATION_HPP_INCLUDED
 
 #include <mlpack/prereqs.hpp>
+#include "sparse_residue_termination.hpp"
 
 namespace mlpack {
 namespace amf {
@@ -68,32 +69,9 @@ class SimpleToleranceTermination
    */
   bool IsConverged(arma::mat& W, arma::mat& H)
   {
-    arma::mat WH;
-
-    WH = W * H;
-
-    // compute residue
+    // compute residue over the nonzero entries of V, without forming W * H
     residueOld = residue;
-    size_t n = V->n_rows;
-    size_t m = V->n_cols;
-    double sum = 0;
-    size_t count = 0;
-    for (size_t i = 0; i < n; i++)
-    {
-        for (size_t j = 0; j < m; j++)
-        {
-            double temp = 0;
-            if ((temp = (*V)(i, j)) != 0)
-            {
-                temp = (temp - WH(i, j));
-                temp = temp * temp;
-                sum += temp;
-                count++;
-            }
-        }
-    }
-    residue = sum / count;
-    residue = sqrt(residue);
+    residue = SparseResidueTermination<MatType>::ObservedRMSE(*V, W, H);
 
     // increment iteration count
     iteration++;
@@ -0,0 +1,240 @@
+/**
+ * @file sparse_residue_termination.hpp
+ *
+ * Termination policy used in AMF (Alternating Matrix Factorization), which
+ * measures the error of the factorization on the observed entries only.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_AMF_TERMINATION_POLICIES_SPARSE_RESIDUE_TERMINATION_HPP
+#define MLPACK_METHODS_AMF_TERMINATION_POLICIES_SPARSE_RESIDUE_TERMINATION_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace amf {
+
+/**
+ * This termination policy computes the root mean squared error of W * H on the
+ * nonzero (observed) entries of V, from the rows of W and the columns of H, so
+ * W * H is never formed: a check takes O(nnz(V) r) time instead of the
+ * O(n m r) time of SimpleResidueTermination or SimpleToleranceTermination,
+ * and the columns of V are processed in parallel when OpenMP is available.
+ * To save more time, the error can be checked only every checkInterval
+ * iterations.
+ *
+ * The termination criterion is met when the relative change of the error
+ * between two checks drops below the tolerance, or when the number of
+ * iterations goes above the iteration limit.  This is meant for the
+ * factorization of sparse rating matrices, for instance with SparseALSUpdate.
+ *
+ * @code
+ * SparseResidueTermination<> srt(1e-5, 1000, 5);
+ * AMF<SparseResidueTermination<>, RandomAcolInitialization<>, SparseALSUpdate>
+ *     als(srt);
+ * als.Apply(ratings, 10, w, h);
+ * @endcode
+ *
+ * @see AMF
+ */
+template<typename MatType = arma::sp_mat>
+class SparseResidueTermination
+{
+ public:
+  /**
+   * Construct the SparseResidueTermination object.  0 indicates no iteration
+   * limit.
+   *
+   * @param tolerance Relative change of the error for termination.
+   * @param maxIterations Maximum number of iterations.
+   * @param checkInterval Number of iterations between two checks of the error.
+   */
+  SparseResidueTermination(const double tolerance = 1e-5,
+                           const size_t maxIterations = 10000,
+                           const size_t checkInterval = 1) :
+      tolerance(tolerance),
+      maxIterations(maxIterations),
+      checkInterval(std::max(checkInterval, (size_t) 1)),
+      V(NULL),
+      residue(DBL_MAX),
+      iteration(1)
+  { }
+
+  /**
+   * Initializes the termination policy before starting the factorization.
+   *
+   * @param V Input matrix being factorized.
+   */
+  void Initialize(const MatType& V)
+  {
+    this->V = &V;
+    residue = DBL_MAX;
+    iteration = 1;
+  }
+
+  /**
+   * Check if termination criterion is met.
+   *
+   * @param W Basis matrix of output.
+   * @param H Encoding matrix of output.
+   */
+  bool IsConverged(arma::mat& W, arma::mat& H)
+  {
+    // The first call (before the first update) gives the initial error.
+    const bool check = ((iteration - 1) % checkInterval == 0);
+    iteration++;
+
+    bool converged = false;
+    if (check)
+    {
+      const double residueOld = residue;
+      residue = ObservedRMSE(*V, W, H);
+      converged = (residue == 0.0) ||
+          (std::fabs(residueOld - residue) / residueOld < tolerance);
+
+      Log::Info << "Iteration " << iteration << "; residue " << residue
+          << ".\n";
+    }
+
+    return (converged || (maxIterations != 0 && iteration > maxIterations));
+  }
+
+  /**
+   * Compute the root mean squared error of W * H on the nonzero entries of V.
+   *
+   * @param V Matrix being factorized.
+   * @param W Basis matrix.
+   * @param H Encoding matrix.
+   */
+  static double ObservedRMSE(const MatType& V,
+                             const arma::mat& W,
+                             const arma::mat& H)
+  {
+    // The rows of W are needed, so they are made contiguous.
+    const arma::mat wt = W.t();
+
+    size_t count = 0;
+    const double sum = SquaredError(V, wt, H, count);
+    return (count == 0) ? 0.0 : std::sqrt(sum / count);
+  }
+
+  //! Get current value of residue (the error at the last check).
+  const double& Index() const { return residue; }
+
+  //! Get current iteration count.
+  const size_t& Iteration() const { return iteration; }
+
+  //! Access max iteration count.
+  const size_t& MaxIterations() const { return maxIterations; }
+  size_t& MaxIterations() { return maxIterations; }
+
+  //! Access the tolerance.
+  const double& Tolerance() const { return tolerance; }
+  double& Tolerance() { return tolerance; }
+
+  //! Access the number of iterations between two checks.
+  const size_t& CheckInterval() const { return checkInterval; }
+  size_t& CheckInterval() { return checkInterval; }
+
+ private:
+  //! Compute the sum of the squared errors on the nonzero entries of a sparse
+  //! matrix, and their number.
+  static double SquaredError(const arma::sp_mat& V,
+                             const arma::mat& wt,
+                             const arma::mat& H,
+                             size_t& count)
+  {
+    double sum = 0.0;
+
+#ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables. If we're building for Visual Studio,
+    // use the intmax_t type instead.
+    #pragma omp parallel for schedule(dynamic, 64) reduction(+:sum)
+    for (intmax_t j = 0; j < (intmax_t) V.n_cols; ++j)
+#else
+    #pragma omp parallel for schedule(dynamic, 64) reduction(+:sum)
+    for (size_t j = 0; j < V.n_cols; ++j)
+#endif
+    {
+      const double* h = H.colptr(j);
+      for (size_t k = V.col_ptrs[j]; k < V.col_ptrs[j + 1]; ++k)
+      {
+        const double* w = wt.colptr(V.row_indices[k]);
+        double prediction = 0.0;
+        for (size_t l = 0; l < wt.n_rows; ++l)
+          prediction += w[l] * h[l];
+
+        const double error = V.values[k] - prediction;
+        sum += error * error;
+      }
+    }
+
+    count = V.n_nonzero;
+    return sum;
+  }
+
+  //! Compute the sum of the squared errors on the nonzero entries of a dense
+  //! matrix, and their number.
+  static double SquaredError(const arma::mat& V,
+                             const arma::mat& wt,
+                             const arma::mat& H,
+                             size_t& count)
+  {
+    double sum = 0.0;
+    size_t nonzeros = 0;
+
+#ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables. If we're building for Visual Studio,
+    // use the intmax_t type instead.
+    #pragma omp parallel for schedule(dynamic, 64) reduction(+:sum, nonzeros)
+    for (intmax_t j = 0; j < (intmax_t) V.n_cols; ++j)
+#else
+    #pragma omp parallel for schedule(dynamic, 64) reduction(+:sum, nonzeros)
+    for (size_t j = 0; j < V.n_cols; ++j)
+#endif
+    {
+      const double* h = H.colptr(j);
+      for (size_t i = 0; i < V.n_rows; ++i)
+      {
+        if (V(i, j) == 0.0)
+          continue;
+
+        const double* w = wt.colptr(i);
+        double prediction = 0.0;
+        for (size_t l = 0; l < wt.n_rows; ++l)
+          prediction += w[l] * h[l];
+
+        const double error = V(i, j) - prediction;
+        sum += error * error;
+        ++nonzeros;
+      }
+    }
+
+    count = nonzeros;
+    return sum;
+  }
+
+  //! Relative change of the error for termination.
+  double tolerance;
+  //! Iteration threshold.
+  size_t maxIterations;
+  //! Number of iterations between two checks.
+  size_t checkInterval;
+
+  //! The matrix being factorized.
+  const MatType* V;
+  //! The error at the last check.
+  double residue;
+  //! Current iteration count.
+  size_t iteration;
+}; // class SparseResidueTermination
+
+} // namespace amf
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,224 @@
+/**
+ * @file nmf_mult_div_blocked.hpp
+ *
+ * Blocked, parallel implementation of the multiplicative divergence update
+ * rules for non-negative matrix factorization.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_AMF_UPDATE_RULES_NMF_MULT_DIV_BLOCKED_HPP
+#define MLPACK_METHODS_AMF_UPDATE_RULES_NMF_MULT_DIV_BLOCKED_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace amf {
+
+/**
+ * The multiplicative divergence update rules of
+ * NMFMultiplicativeDivergenceUpdate (Lee and Seung, 2001), computed one block
+ * of columns at a time, with the blocks updated in parallel.  For the update of
+ * H, the block of columns [b, e] of H is
+ *
+ * \f[
+ * H_{a, b:e} \leftarrow H_{a, b:e}
+ * \frac{(W^T (V_{:, b:e} ./ (W H_{:, b:e})))_a}{\sum_i W_{ia}}
+ * \f]
+ *
+ * so each block takes two matrix products, instead of a sum per element of H.
+ * The update of W is the same update on the transposed problem (V^T = H^T
+ * W^T).  If V is sparse, the ratios are only computed at the nonzero entries of
+ * V (the others are zero), so an update takes time in the number of nonzero
+ * entries; V is then stored transposed once, in Initialize(), so that the rows
+ * of V can be read like its columns.  Unlike with
+ * NMFMultiplicativeDivergenceUpdate, sparse matrices don't cause NaNs, unless
+ * W H is zero at a nonzero entry of V.
+ */
+class BlockedNMFMultiplicativeDivergenceUpdate
+{
+ public:
+  /**
+   * Create the update rules with the given block size.
+   *
+   * @param blockSize Number of columns in each block.
+   */
+  BlockedNMFMultiplicativeDivergenceUpdate(const size_t blockSize = 256) :
+      blockSize(blockSize)
+  {
+    // Nothing to do.
+  }
+
+  /**
+   * Initialize the factorization of a sparse matrix: store its transpose.
+   *
+   * @param dataset Input matrix to be factorized.
+   * @param rank Rank of the factorization.
+   */
+  void Initialize(const arma::sp_mat& dataset, const size_t /* rank */)
+  {
+    transposed = dataset.t();
+  }
+
+  /**
+   * Initialize the factorization of a dense matrix.  Nothing needs to be
+   * stored.
+   */
+  template<typename MatType>
+  void Initialize(const MatType& /* dataset */, const size_t /* rank */)
+  {
+    // Nothing to do.
+  }
+
+  /**
+   * The update rule for the basis matrix W of a sparse matrix.
+   *
+   * @param V Input matrix to be factorized.
+   * @param W Basis matrix to be updated.
+   * @param H Encoding matrix.
+   */
+  inline void WUpdate(const arma::sp_mat& /* V */,
+                      arma::mat& W,
+                      const arma::mat& H) const
+  {
+    arma::mat wt = W.t();
+    Update(transposed, H, wt, false);
+    W = wt.t();
+  }
+
+  /**
+   * The update rule for the basis matrix W of a dense matrix.
+   *
+   * @param V Input matrix to be factorized.
+   * @param W Basis matrix to be updated.
+   * @param H Encoding matrix.
+   */
+  template<typename MatType>
+  inline void WUpdate(const MatType& V,
+                      arma::mat& W,
+                      const arma::mat& H) const
+  {
+    arma::mat wt = W.t();
+    Update(V, H, wt, true);
+    W = wt.t();
+  }
+
+  /**
+   * The update rule for the encoding matrix H.
+   *
+   * @param V Input matrix to be factorized.
+   * @param W Basis matrix.
+   * @param H Encoding matrix to be updated.
+   */
+  template<typename MatType>
+  inline void HUpdate(const MatType& V,
+                      const arma::mat& W,
+                      arma::mat& H) const
+  {
+    Update(V, W.t(), H, false);
+  }
+
+  //! Get the number of columns in each block.
+  size_t BlockSize() const { return blockSize; }
+  //! Modify the number of columns in each block.
+  size_t& BlockSize() { return blockSize; }
+
+  //! Serialize the update rules.
+  template<typename Archive>
+  void Serialize(Archive& ar, const unsigned int /* version */)
+  {
+    ar & data::CreateNVP(blockSize, "blockSize");
+  }
+
+ private:
+  /**
+   * Update result, the factor that is multiplied by fixed for the
+   * approximation of data (or of its transpose, if transpose is true).
+   *
+   * @param data Input matrix (or its transpose).
+   * @param fixed Fixed factor, with a column per row of the matrix.
+   * @param result Factor to be updated, with a column per column of the
+   *     matrix.
+   * @param transpose Whether the matrix is the transpose of data.
+   */
+  template<typename MatType>
+  void Update(const MatType& data,
+              const arma::mat& fixed,
+              arma::mat& result,
+              const bool transpose) const
+  {
+    const arma::vec sums = arma::sum(fixed, 1);
+    const size_t numBlocks = (result.n_cols + blockSize - 1) / blockSize;
+
+#ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables. If we're building for Visual Studio,
+    // use the intmax_t type instead.
+    #pragma omp parallel for schedule(dynamic)
+    for (intmax_t b = 0; b < (intmax_t) numBlocks; ++b)
+#else
+    #pragma omp parallel for schedule(dynamic)
+    for (size_t b = 0; b < numBlocks; ++b)
+#endif
+    {
+      const size_t begin = b * blockSize;
+      const size_t end = std::min(begin + blockSize, (size_t) result.n_cols)
+          - 1;
+
+      arma::mat numerator = RatioProduct(data, fixed, result, begin, end,
+          transpose);
+      result.cols(begin, end) %= numerator.each_col() / sums;
+    }
+  }
+
+  //! Compute fixed * (data.cols(begin, end) ./ (fixed^T result.cols(begin,
+  //! end))), with data.rows(begin, end).t() instead if transpose is true.
+  static arma::mat RatioProduct(const arma::mat& data,
+                                const arma::mat& fixed,
+                                const arma::mat& result,
+                                const size_t begin,
+                                const size_t end,
+                                const bool transpose)
+  {
+    const arma::mat approximation = fixed.t() * result.cols(begin, end);
+    if (transpose)
+      return fixed * (data.rows(begin, end).t() / approximation);
+    else
+      return fixed * (data.cols(begin, end) / approximation);
+  }
+
+  //! Compute the same product over the nonzero entries of data only.
+  static arma::mat RatioProduct(const arma::sp_mat& data,
+                                const arma::mat& fixed,
+                                const arma::mat& result,
+                                const size_t begin,
+                                const size_t end,
+                                const bool /* transpose */)
+  {
+    arma::mat product(fixed.n_rows, end - begin + 1, arma::fill::zeros);
+    for (size_t j = begin; j <= end; ++j)
+    {
+      for (size_t k = data.col_ptrs[j]; k < data.col_ptrs[j + 1]; ++k)
+      {
+        const size_t i = data.row_indices[k];
+        const double ratio = data.values[k] /
+            arma::dot(fixed.col(i), result.col(j));
+        product.col(j - begin) += ratio * fixed.col(i);
+      }
+    }
+
+    return product;
+  }
+
+  //! Number of columns in each block.
+  size_t blockSize;
+  //! The transposed input matrix, if it is sparse.
+  arma::sp_mat transposed;
+}; // class BlockedNMFMultiplicativeDivergenceUpdate
+
+} // namespace amf
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,260 @@
+/**
+ * @file sparse_als.hpp
+ *
+ * Update rules for alternating least squares over the observed entries of a
+ * sparse matrix.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_AMF_UPDATE_RULES_SPARSE_ALS_HPP
+#define MLPACK_METHODS_AMF_UPDATE_RULES_SPARSE_ALS_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace amf {
+
+/**
+ * This class implements alternating least squares for a sparse matrix of
+ * ratings, where only the nonzero entries of V are observed.  Each column of H
+ * is the solution of a small regularized least squares problem over the
+ * entries observed in the same column of V, and each row of W the solution of
+ * the same problem over the entries observed in the same row of V; these
+ * problems are independent, so they are solved in parallel.  Without a
+ * confidence (alpha = 0), this is the weighted-lambda-regularization ALS of the
+ * following paper:
+ *
+ * @code
+ * @inproceedings{zhou2008large,
+ *   title={Large-scale parallel collaborative filtering for the Netflix
+ *       prize},
+ *   author={Zhou, Y. and Wilkinson, D. and Schreiber, R. and Pan, R.},
+ *   booktitle={Algorithmic Aspects in Information and Management},
+ *   pages={337--348},
+ *   year={2008}
+ * }
+ * @endcode
+ *
+ * which minimizes
+ *
+ * \f[
+ * \sum_{(i, j) observed} (V_{ij} - W_i H_j)^2 + \lambda (\sum_i n_i \|W_i\|^2 +
+ * \sum_j n_j \|H_j\|^2)
+ * \f]
+ *
+ * where n_i and n_j are the numbers of observed entries of row i and column j.
+ * With a confidence alpha > 0, V holds implicit feedback, and this is the
+ * implicit ALS of Hu, Koren and Volinsky ("Collaborative filtering for implicit
+ * feedback datasets", ICDM 2008): every entry is a preference of 1 (observed)
+ * or 0 (not observed) of confidence 1 + alpha * V_ij.  Then each problem
+ * involves all the rows of the fixed matrix, but the Gram matrix of the fixed
+ * matrix is computed once per update, so each problem still only takes time in
+ * the number of its observed entries.
+ *
+ * The matrix V is stored transposed once, in Initialize(), so that the rows of
+ * V can be read like its columns.
+ */
+class SparseALSUpdate
+{
+ public:
+  /**
+   * Create the update rule with the given parameters.
+   *
+   * @param lambda Regularization parameter.
+   * @param alpha Confidence of the observed entries of implicit feedback; if
+   *     0, the entries of V are explicit ratings.
+   */
+  SparseALSUpdate(const double lambda = 0.1, const double alpha = 0.0) :
+      lambda(lambda),
+      alpha(alpha)
+  {
+    // Nothing to do.
+  }
+
+  /**
+   * Set initial values for the factorization: store the transposed matrix.
+   *
+   * @param dataset Input matrix to be factorized.
+   * @param rank Rank of the factorization.
+   */
+  void Initialize(const arma::sp_mat& dataset, const size_t /* rank */)
+  {
+    transposed = dataset.t();
+  }
+
+  /**
+   * Set initial values for the factorization of a dense matrix, whose nonzero
+   * entries are the observed entries: store it as a sparse matrix, and its
+   * transpose.
+   *
+   * @param dataset Input matrix to be factorized.
+   * @param rank Rank of the factorization.
+   */
+  template<typename MatType>
+  void Initialize(const MatType& dataset, const size_t /* rank */)
+  {
+    ratings = arma::sp_mat(arma::mat(dataset));
+    transposed = ratings.t();
+  }
+
+  /**
+   * The update rule for the basis matrix W: solve for each row of W with H
+   * fixed.
+   *
+   * @param V Input matrix to be factorized.
+   * @param W Basis matrix to be updated.
+   * @param H Encoding matrix.
+   */
+  template<typename MatType>
+  inline void WUpdate(const MatType& /* V */,
+                      arma::mat& W,
+                      const arma::mat& H)
+  {
+    arma::mat wt;
+    Solve(transposed, H, wt);
+    W = wt.t();
+  }
+
+  /**
+   * The update rule for the encoding matrix H: solve for each column of H with
+   * W fixed.
+   *
+   * @param V Input matrix to be factorized.
+   * @param W Basis matrix.
+   * @param H Encoding matrix to be updated.
+   */
+  inline void HUpdate(const arma::sp_mat& V,
+                      const arma::mat& W,
+                      arma::mat& H)
+  {
+    Solve(V, W.t(), H);
+  }
+
+  /**
+   * The update rule for the encoding matrix H of a dense matrix (stored as a
+   * sparse matrix by Initialize()).
+   *
+   * @param V Input matrix to be factorized.
+   * @param W Basis matrix.
+   * @param H Encoding matrix to be updated.
+   */
+  template<typename MatType>
+  inline void HUpdate(const MatType& /* V */,
+                      const arma::mat& W,
+                      arma::mat& H)
+  {
+    Solve(ratings, W.t(), H);
+  }
+
+  //! Get the regularization parameter.
+  double Lambda() const { return lambda; }
+  //! Modify the regularization parameter.
+  double& Lambda() { return lambda; }
+
+  //! Get the confidence of implicit feedback (0 for explicit ratings).
+  double Alpha() const { return alpha; }
+  //! Modify the confidence of implicit feedback (0 for explicit ratings).
+  double& Alpha() { return alpha; }
+
+  //! Serialize the parameters of the update rule.
+  template<typename Archive>
+  void Serialize(Archive& ar, const unsigned int /* version */)
+  {
+    ar & data::CreateNVP(lambda, "lambda");
+    ar & data::CreateNVP(alpha, "alpha");
+  }
+
+ private:
+  /**
+   * Solve for each column of result: column j is the regularized least squares
+   * fit of the observed entries of column j of data, with the rows of data
+   * given by the columns of fixed.
+   *
+   * @param data Observed entries (one problem per column).
+   * @param fixed Fixed factors (one column per row of data).
+   * @param result Matrix to store the solutions into.
+   */
+  void Solve(const arma::sp_mat& data,
+             const arma::mat& fixed,
+             arma::mat& result) const
+  {
+    const size_t r = fixed.n_rows;
+    result.set_size(r, data.n_cols);
+
+    // For implicit feedback, every row of the fixed matrix contributes to
+    // every problem; those contributions are the same for all the problems.
+    arma::mat gram;
+    if (alpha > 0.0)
+      gram = fixed * fixed.t();
+
+#ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables. If we're building for Visual Studio,
+    // use the intmax_t type instead.
+    #pragma omp parallel for schedule(dynamic, 64)
+    for (intmax_t j = 0; j < (intmax_t) data.n_cols; ++j)
+#else
+    #pragma omp parallel for schedule(dynamic, 64)
+    for (size_t j = 0; j < data.n_cols; ++j)
+#endif
+    {
+      // Gather the fixed factors of the observed entries of the column.
+      const size_t begin = data.col_ptrs[j];
+      const size_t n = data.col_ptrs[j + 1] - begin;
+      arma::mat factors(r, n);
+      arma::vec values(n);
+      for (size_t k = 0; k < n; ++k)
+      {
+        factors.col(k) = fixed.col(data.row_indices[begin + k]);
+        values[k] = data.values[begin + k];
+      }
+
+      arma::mat a;
+      arma::vec b;
+      if (alpha > 0.0)
+      {
+        // The observed entries have confidence 1 + alpha * v and preference
+        // 1; the others have confidence 1 and preference 0.
+        a = gram + (factors.each_row() % (alpha * values.t())) * factors.t();
+        b = factors * (1.0 + alpha * values);
+        a.diag() += lambda;
+      }
+      else
+      {
+        if (n == 0)
+        {
+          // Nothing is known about this column.
+          result.col(j).zeros();
+          continue;
+        }
+
+        a = factors * factors.t();
+        b = factors * values;
+        a.diag() += lambda * n;
+      }
+
+      arma::vec solution;
+      if (arma::solve(solution, a, b))
+        result.col(j) = solution;
+      else
+        result.col(j).zeros();
+    }
+  }
+
+  //! Regularization parameter.
+  double lambda;
+  //! Confidence of implicit feedback.
+  double alpha;
+  //! The transposed input matrix.
+  arma::sp_mat transposed;
+  //! The input matrix, if it is dense.
+  arma::sp_mat ratings;
+}; // class SparseALSUpdate
+
+} // namespace amf
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,76 @@
+/**
+ * @file convolution_rule_traits.hpp
+ *
+ * This provides the ConvolutionRuleTraits class, a template class to get
+ * information about the convolution rules used by the Convolution layer.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_CONVOLUTION_RULES_CONVOLUTION_RULE_TRAITS_HPP
+#define MLPACK_METHODS_ANN_CONVOLUTION_RULES_CONVOLUTION_RULE_TRAITS_HPP
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+/**
+ * This is a template class that can provide information about a convolution
+ * rule.  By default, a convolution rule only convolves one input map with one
+ * filter at a time, and the Convolution layer calls it for every pair of input
+ * and output maps.  A rule that lowers all the maps into one matrix product
+ * must specialize this class and set LowersMaps to true; it then has to
+ * provide the static functions
+ *
+ * @code
+ * // Convolve the input maps with the filters, where filter slice
+ * // o * input.n_slices + i belongs to output map o and input map i.
+ * template<typename eT>
+ * static void MapsConvolution(const arma::Cube<eT>& input,
+ *                             const arma::Cube<eT>& filters,
+ *                             arma::Cube<eT>& output,
+ *                             const size_t dW,
+ *                             const size_t dH);
+ *
+ * // Backpropagate the error of the output maps to the (zero-filled) input
+ * // maps.
+ * template<typename eT>
+ * static void MapsBackward(const arma::Cube<eT>& error,
+ *                          const arma::Cube<eT>& filters,
+ *                          arma::Cube<eT>& input,
+ *                          const size_t dW,
+ *                          const size_t dH);
+ *
+ * // Compute the gradient of the filters from the input maps and the error of
+ * // the output maps.
+ * template<typename eT>
+ * static void MapsGradient(const arma::Cube<eT>& input,
+ *                          const arma::Cube<eT>& error,
+ *                          const size_t kW,
+ *                          const size_t kH,
+ *                          const size_t dW,
+ *                          const size_t dH,
+ *                          arma::Cube<eT>& gradient);
+ * @endcode
+ *
+ * where the rows of the maps are strided by dW and the columns by dH.  The
+ * layer keeps one object of its forward rule, so MapsConvolution() may instead
+ * be a non-static member, if the rule keeps state between calls (like the
+ * filter transforms of PlannedFFTConvolution).
+ */
+template<typename ConvolutionRule>
+class ConvolutionRuleTraits
+{
+ public:
+  /**
+   * This is true if the rule convolves all the maps at once with
+   * MapsConvolution(), MapsBackward() and MapsGradient().
+   */
+  static const bool LowersMaps = false;
+};
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,554 @@
+/**
+ * @file im2col_convolution.hpp
+ *
+ * Implementation of the convolution as a matrix product of the patches of the
+ * input (im2col) and the filters, with a Winograd fast path for 3x3 filters.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_CONVOLUTION_RULES_IM2COL_CONVOLUTION_HPP
+#define MLPACK_METHODS_ANN_CONVOLUTION_RULES_IM2COL_CONVOLUTION_HPP
+
+#include <mlpack/prereqs.hpp>
+#include "border_modes.hpp"
+#include "convolution_rule_traits.hpp"
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+/**
+ * Computes the two-dimensional convolution by lowering it to a matrix product.
+ * Every patch of the input that a filter is applied to is copied to a row of a
+ * patch matrix (im2col), so that the convolution with all the filters is one
+ * matrix product of the patch matrix and the matrix of the vectorised filters,
+ * which is computed by BLAS.
+ *
+ * As a convolution rule of the Convolution layer, all the input maps of a
+ * point are lowered into one patch matrix, so that the forward pass, the
+ * backward pass and the gradient are each one matrix product, instead of a
+ * convolution for every pair of input and output maps.  For 3x3 filters with
+ * stride 1, the forward pass uses the Winograd F(2x2, 3x3) algorithm instead,
+ * which needs 16 multiplications for each 2x2 output tile instead of 36.
+ *
+ * The functions on single maps have the same semantics as NaiveConvolution,
+ * so this class can be used wherever NaiveConvolution is.
+ *
+ * FullConvolution: returns the full two-dimensional convolution.
+ * ValidConvolution: returns only those parts of the convolution that are
+ * computed without the zero-padded edges.
+ *
+ * @tparam BorderMode Type of the border mode (FullConvolution or
+ * ValidConvolution).
+ */
+template<typename BorderMode = FullConvolution>
+class Im2ColConvolution
+{
+ public:
+  /*
+   * Perform a convolution (valid mode).
+   *
+   * @param input Input used to perform the convolution.
+   * @param filter Filter used to perform the conolution.
+   * @param output Output data that contains the results of the convolution.
+   * @param dW Stride of filter application in the x direction.
+   * @param dH Stride of filter application in the y direction.
+   */
+  template<typename eT, typename Border = BorderMode>
+  static typename std::enable_if<
+      std::is_same<Border, ValidConvolution>::value, void>::type
+  Convolution(const arma::Mat<eT>& input,
+              const arma::Mat<eT>& filter,
+              arma::Mat<eT>& output,
+              const size_t dW = 1,
+              const size_t dH = 1)
+  {
+    // Use the output size and the strides of NaiveConvolution.
+    const size_t outputRows = (input.n_rows - filter.n_rows + 1) / dW;
+    const size_t outputCols = (input.n_cols - filter.n_cols + 1) / dH;
+
+    const arma::Cube<eT> inputCube(const_cast<eT*>(input.memptr()),
+        input.n_rows, input.n_cols, 1, false, true);
+    arma::Mat<eT> patches;
+    Im2Col(inputCube, filter.n_rows, filter.n_cols, dH, dW, outputRows,
+        outputCols, patches);
+
+    output = arma::reshape(patches * arma::vectorise(filter), outputRows,
+        outputCols);
+  }
+
+  /*
+   * Perform a convolution (full mode).
+   *
+   * @param input Input used to perform the convolution.
+   * @param filter Filter used to perform the conolution.
+   * @param output Output data that contains the results of the convolution.
+   * @param dW Stride of filter application in the x direction.
+   * @param dH Stride of filter application in the y direction.
+   */
+  template<typename eT, typename Border = BorderMode>
+  static typename std::enable_if<
+      std::is_same<Border, FullConvolution>::value, void>::type
+  Convolution(const arma::Mat<eT>& input,
+              const arma::Mat<eT>& filter,
+              arma::Mat<eT>& output,
+              const size_t dW = 1,
+              const size_t dH = 1)
+  {
+    const size_t outputRows = (input.n_rows + 2 * (filter.n_rows - 1)) * dW;
+    const size_t outputCols = (input.n_cols + 2 * (filter.n_cols - 1)) * dH;
+
+    // Pad filter and input to the working output shape.
+    arma::Mat<eT> inputPadded = arma::zeros<arma::Mat<eT> >(outputRows,
+        outputCols);
+    inputPadded.submat(filter.n_rows - 1, filter.n_cols - 1,
+        filter.n_rows - 1 + input.n_rows - 1,
+        filter.n_cols - 1 + input.n_cols - 1) = input;
+
+    Im2ColConvolution<ValidConvolution>::Convolution(inputPadded, filter,
+        output, 1, 1);
+  }
+
+  /*
+   * Perform a convolution using 3rd order tensors.
+   *
+   * @param input Input used to perform the convolution.
+   * @param filter Filter used to perform the conolution.
+   * @param output Output data that contains the results of the convolution.
+   * @param dW Stride of filter application in the x direction.
+   * @param dH Stride of filter application in the y direction.
+   */
+  template<typename eT>
+  static void Convolution(const arma::Cube<eT>& input,
+                          const arma::Cube<eT>& filter,
+                          arma::Cube<eT>& output,
+                          const size_t dW = 1,
+                          const size_t dH = 1)
+  {
+    arma::Mat<eT> convOutput;
+    Im2ColConvolution<BorderMode>::Convolution(input.slice(0),
+        filter.slice(0), convOutput, dW, dH);
+
+    output = arma::Cube<eT>(convOutput.n_rows, convOutput.n_cols,
+        input.n_slices);
+    output.slice(0) = convOutput;
+
+    for (size_t i = 1; i < input.n_slices; i++)
+    {
+      Im2ColConvolution<BorderMode>::Convolution(input.slice(i),
+          filter.slice(i), convOutput, dW, dH);
+      output.slice(i) = convOutput;
+    }
+  }
+
+  /*
+   * Perform a convolution using dense matrix as input and a 3rd order tensors
+   * as filter and output.
+   *
+   * @param input Input used to perform the convolution.
+   * @param filter Filter used to perform the conolution.
+   * @param output Output data that contains the results of the convolution.
+   * @param dW Stride of filter application in the x direction.
+   * @param dH Stride of filter application in the y direction.
+   */
+  template<typename eT>
+  static void Convolution(const arma::Mat<eT>& input,
+                          const arma::Cube<eT>& filter,
+                          arma::Cube<eT>& output,
+                          const size_t dW = 1,
+                          const size_t dH = 1)
+  {
+    arma::Mat<eT> convOutput;
+    Im2ColConvolution<BorderMode>::Convolution(input, filter.slice(0),
+        convOutput, dW, dH);
+
+    output = arma::Cube<eT>(convOutput.n_rows, convOutput.n_cols,
+        filter.n_slices);
+    output.slice(0) = convOutput;
+
+    for (size_t i = 1; i < filter.n_slices; i++)
+    {
+      Im2ColConvolution<BorderMode>::Convolution(input, filter.slice(i),
+          convOutput, dW, dH);
+      output.slice(i) = convOutput;
+    }
+  }
+
+  /*
+   * Perform a convolution using a 3rd order tensors as input and output and a
+   * dense matrix as filter.
+   *
+   * @param input Input used to perform the convolution.
+   * @param filter Filter used to perform the conolution.
+   * @param output Output data that contains the results of the convolution.
+   * @param dW Stride of filter application in the x direction.
+   * @param dH Stride of filter application in the y direction.
+   */
+  template<typename eT>
+  static void Convolution(const arma::Cube<eT>& input,
+                          const arma::Mat<eT>& filter,
+                          arma::Cube<eT>& output,
+                          const size_t dW = 1,
+                          const size_t dH = 1)
+  {
+    arma::Mat<eT> convOutput;
+    Im2ColConvolution<BorderMode>::Convolution(input.slice(0), filter,
+        convOutput, dW, dH);
+
+    output = arma::Cube<eT>(convOutput.n_rows, convOutput.n_cols,
+        input.n_slices);
+    output.slice(0) = convOutput;
+
+    for (size_t i = 1; i < input.n_slices; i++)
+    {
+      Im2ColConvolution<BorderMode>::Convolution(input.slice(i), filter,
+          convOutput, dW, dH);
+      output.slice(i) = convOutput;
+    }
+  }
+
+  /*
+   * Convolve all the input maps with all the filters (valid mode), and sum
+   * the results of each output map over the input maps.  Filter slice
+   * o * input.n_slices + i is applied to input map i for output map o.  The
+   * rows of the input are strided by dW and the columns by dH.
+   *
+   * @param input Input maps, one per slice.
+   * @param filters Filters, one per pair of output and input maps.
+   * @param output Output maps, one per slice.
+   * @param dW Stride of filter application in the x direction.
+   * @param dH Stride of filter application in the y direction.
+   */
+  template<typename eT>
+  static void MapsConvolution(const arma::Cube<eT>& input,
+                              const arma::Cube<eT>& filters,
+                              arma::Cube<eT>& output,
+                              const size_t dW = 1,
+                              const size_t dH = 1)
+  {
+    const size_t outSize = filters.n_slices / input.n_slices;
+    const size_t outputRows = (input.n_rows - filters.n_rows) / dW + 1;
+    const size_t outputCols = (input.n_cols - filters.n_cols) / dH + 1;
+
+    if (filters.n_rows == 3 && filters.n_cols == 3 && dW == 1 && dH == 1)
+    {
+      Winograd(input, filters, output);
+      return;
+    }
+
+    arma::Mat<eT> patches;
+    Im2Col(input, filters.n_rows, filters.n_cols, dW, dH, outputRows,
+        outputCols, patches);
+
+    // The filters of output map o are contiguous, in the order of the columns
+    // of the patch matrix.
+    const arma::Mat<eT> filterMatrix(const_cast<eT*>(filters.memptr()),
+        filters.n_rows * filters.n_cols * input.n_slices, outSize, false,
+        true);
+
+    output.set_size(outputRows, outputCols, outSize);
+    arma::Mat<eT> outputMatrix(output.memptr(), outputRows * outputCols,
+        outSize, false, true);
+    outputMatrix = patches * filterMatrix;
+  }
+
+  /*
+   * Backpropagate the error of the output maps of MapsConvolution() to the
+   * input maps.  The given input maps must have the size of the input of the
+   * forward pass; they are overwritten.
+   *
+   * @param error Error of the output maps, one per slice.
+   * @param filters Filters, one per pair of output and input maps.
+   * @param input Error of the input maps, one per slice.
+   * @param dW Stride of filter application in the x direction.
+   * @param dH Stride of filter application in the y direction.
+   */
+  template<typename eT>
+  static void MapsBackward(const arma::Cube<eT>& error,
+                           const arma::Cube<eT>& filters,
+                           arma::Cube<eT>& input,
+                           const size_t dW = 1,
+                           const size_t dH = 1)
+  {
+    const arma::Mat<eT> errorMatrix(const_cast<eT*>(error.memptr()),
+        error.n_rows * error.n_cols, error.n_slices, false, true);
+    const arma::Mat<eT> filterMatrix(const_cast<eT*>(filters.memptr()),
+        filters.n_rows * filters.n_cols * input.n_slices, error.n_slices,
+        false, true);
+
+    // The error of each patch, scattered back to the input.
+    const arma::Mat<eT> patches = errorMatrix * filterMatrix.t();
+    input.zeros();
+    Col2Im(patches, filters.n_rows, filters.n_cols, dW, dH, error.n_rows,
+        error.n_cols, input);
+  }
+
+  /*
+   * Compute the gradient of the filters of MapsConvolution() from the input
+   * maps and the error of the output maps.
+   *
+   * @param input Input maps of the forward pass, one per slice.
+   * @param error Error of the output maps, one per slice.
+   * @param kW Width of the filters.
+   * @param kH Height of the filters.
+   * @param dW Stride of filter application in the x direction.
+   * @param dH Stride of filter application in the y direction.
+   * @param gradient Gradient of the filters, one per pair of output and input
+   *     maps.
+   */
+  template<typename eT>
+  static void MapsGradient(const arma::Cube<eT>& input,
+                           const arma::Cube<eT>& error,
+                           const size_t kW,
+                           const size_t kH,
+                           const size_t dW,
+                           const size_t dH,
+                           arma::Cube<eT>& gradient)
+  {
+    arma::Mat<eT> patches;
+    Im2Col(input, kW, kH, dW, dH, error.n_rows, error.n_cols, patches);
+
+    const arma::Mat<eT> errorMatrix(const_cast<eT*>(error.memptr()),
+        error.n_rows * error.n_cols, error.n_slices, false, true);
+
+    gradient.set_size(kW, kH, input.n_slices * error.n_slices);
+    arma::Mat<eT> gradientMatrix(gradient.memptr(), kW * kH * input.n_slices,
+        error.n_slices, false, true);
+    gradientMatrix = patches.t() * errorMatrix;
+  }
+
+ private:
+  /*
+   * Copy the patches of the input maps to the rows of the patch matrix: row
+   * i + j * outputRows holds the patch of output element (i, j), and column
+   * ki + kj * kRows + s * kRows * kCols holds element (ki, kj) of the patches
+   * of input map s.
+   *
+   * @param input Input maps, one per slice.
+   * @param kRows Number of rows of the filters.
+   * @param kCols Number of columns of the filters.
+   * @param rowStride Stride of the patches along the rows.
+   * @param colStride Stride of the patches along the columns.
+   * @param outputRows Number of rows of the output.
+   * @param outputCols Number of columns of the output.
+   * @param patches Matrix to store the patches in.
+   */
+  template<typename eT>
+  static void Im2Col(const arma::Cube<eT>& input,
+                     const size_t kRows,
+                     const size_t kCols,
+                     const size_t rowStride,
+                     const size_t colStride,
+                     const size_t outputRows,
+                     const size_t outputCols,
+                     arma::Mat<eT>& patches)
+  {
+    patches.set_size(outputRows * outputCols, kRows * kCols * input.n_slices);
+
+    for (size_t s = 0, c = 0; s < input.n_slices; ++s)
+    {
+      for (size_t kj = 0; kj < kCols; ++kj)
+      {
+        for (size_t ki = 0; ki < kRows; ++ki, ++c)
+        {
+          eT* patchesPtr = patches.colptr(c);
+          for (size_t j = 0; j < outputCols; ++j)
+          {
+            const eT* inputPtr = input.slice_colptr(s, j * colStride + kj) +
+                ki;
+            for (size_t i = 0; i < outputRows; ++i, ++patchesPtr)
+              *patchesPtr = inputPtr[i * rowStride];
+          }
+        }
+      }
+    }
+  }
+
+  /*
+   * Add the rows of the patch matrix to the input maps they were copied from
+   * by Im2Col().
+   *
+   * @param patches Patch matrix.
+   * @param kRows Number of rows of the filters.
+   * @param kCols Number of columns of the filters.
+   * @param rowStride Stride of the patches along the rows.
+   * @param colStride Stride of the patches along the columns.
+   * @param outputRows Number of rows of the output.
+   * @param outputCols Number of columns of the output.
+   * @param input Input maps to add the patches to.
+   */
+  template<typename eT>
+  static void Col2Im(const arma::Mat<eT>& patches,
+                     const size_t kRows,
+                     const size_t kCols,
+                     const size_t rowStride,
+                     const size_t colStride,
+                     const size_t outputRows,
+                     const size_t outputCols,
+                     arma::Cube<eT>& input)
+  {
+    for (size_t s = 0, c = 0; s < input.n_slices; ++s)
+    {
+      for (size_t kj = 0; kj < kCols; ++kj)
+      {
+        for (size_t ki = 0; ki < kRows; ++ki, ++c)
+        {
+          const eT* patchesPtr = patches.colptr(c);
+          for (size_t j = 0; j < outputCols; ++j)
+          {
+            eT* inputPtr = input.slice_colptr(s, j * colStride + kj) + ki;
+            for (size_t i = 0; i < outputRows; ++i, ++patchesPtr)
+              inputPtr[i * rowStride] += *patchesPtr;
+          }
+        }
+      }
+    }
+  }
+
+  /*
+   * Compute MapsConvolution() for 3x3 filters with stride 1 with the Winograd
+   * F(2x2, 3x3) algorithm.  Each 4x4 input tile d and filter g are transformed
+   * to B^T d B and G g G^T; for each of the 16 elements of the transformed
+   * tiles, the products summed over the input maps are one matrix product of
+   * the transformed filters and the transformed tiles; and the 2x2 output
+   * tiles are A^T m A of the results m.  The tiles past the edges of the input
+   * are padded with zeros.
+   *
+   * @param input Input maps, one per slice.
+   * @param filters 3x3 filters, one per pair of output and input maps.
+   * @param output Output maps, one per slice.
+   */
+  template<typename eT>
+  static void Winograd(const arma::Cube<eT>& input,
+                       const arma::Cube<eT>& filters,
+                       arma::Cube<eT>& output)
+  {
+    const size_t inSize = input.n_slices;
+    const size_t outSize = filters.n_slices / inSize;
+    const size_t outputRows = input.n_rows - 2;
+    const size_t outputCols = input.n_cols - 2;
+    const size_t tileRows = (outputRows + 1) / 2;
+    const size_t tileCols = (outputCols + 1) / 2;
+    const size_t tiles = tileRows * tileCols;
+
+    // Transform the filters: u = G g G^T.
+    arma::Cube<eT> u(outSize, inSize, 16);
+    for (size_t o = 0; o < outSize; ++o)
+    {
+      for (size_t m = 0; m < inSize; ++m)
+      {
+        const arma::Mat<eT>& g = filters.slice(o * inSize + m);
+        eT t[4][3];
+        for (size_t b = 0; b < 3; ++b)
+        {
+          t[0][b] = g(0, b);
+          t[1][b] = (g(0, b) + g(1, b) + g(2, b)) / 2;
+          t[2][b] = (g(0, b) - g(1, b) + g(2, b)) / 2;
+          t[3][b] = g(2, b);
+        }
+
+        for (size_t a = 0; a < 4; ++a)
+        {
+          u(o, m, a) = t[a][0];
+          u(o, m, a + 4) = (t[a][0] + t[a][1] + t[a][2]) / 2;
+          u(o, m, a + 8) = (t[a][0] - t[a][1] + t[a][2]) / 2;
+          u(o, m, a + 12) = t[a][2];
+        }
+      }
+    }
+
+    // Transform the input tiles: v = B^T d B.
+    arma::Cube<eT> v(inSize, tiles, 16);
+    for (size_t m = 0; m < inSize; ++m)
+    {
+      for (size_t tc = 0, tile = 0; tc < tileCols; ++tc)
+      {
+        for (size_t tr = 0; tr < tileRows; ++tr, ++tile)
+        {
+          eT d[4][4];
+          for (size_t b = 0; b < 4; ++b)
+          {
+            const size_t col = 2 * tc + b;
+            for (size_t a = 0; a < 4; ++a)
+            {
+              const size_t row = 2 * tr + a;
+              d[a][b] = (row < input.n_rows && col < input.n_cols) ?
+                  input(row, col, m) : 0;
+            }
+          }
+
+          eT t[4][4];
+          for (size_t b = 0; b < 4; ++b)
+          {
+            t[0][b] = d[0][b] - d[2][b];
+            t[1][b] = d[1][b] + d[2][b];
+            t[2][b] = d[2][b] - d[1][b];
+            t[3][b] = d[1][b] - d[3][b];
+          }
+
+          for (size_t a = 0; a < 4; ++a)
+          {
+            v(m, tile, a) = t[a][0] - t[a][2];
+            v(m, tile, a + 4) = t[a][1] + t[a][2];
+            v(m, tile, a + 8) = t[a][2] - t[a][1];
+            v(m, tile, a + 12) = t[a][1] - t[a][3];
+          }
+        }
+      }
+    }
+
+    // Multiply the transformed filters and tiles, summing over the input maps.
+    arma::Cube<eT> products(outSize, tiles, 16);
+    for (size_t k = 0; k < 16; ++k)
+      products.slice(k) = u.slice(k) * v.slice(k);
+
+    // Transform the products back to the output tiles: y = A^T m A.
+    output.set_size(outputRows, outputCols, outSize);
+    for (size_t o = 0; o < outSize; ++o)
+    {
+      for (size_t tc = 0, tile = 0; tc < tileCols; ++tc)
+      {
+        for (size_t tr = 0; tr < tileRows; ++tr, ++tile)
+        {
+          eT s[2][4];
+          for (size_t b = 0; b < 4; ++b)
+          {
+            const eT m0 = products(o, tile, 4 * b);
+            const eT m1 = products(o, tile, 4 * b + 1);
+            const eT m2 = products(o, tile, 4 * b + 2);
+            const eT m3 = products(o, tile, 4 * b + 3);
+            s[0][b] = m0 + m1 + m2;
+            s[1][b] = m1 - m2 - m3;
+          }
+
+          for (size_t a = 0; a < 2; ++a)
+          {
+            const size_t row = 2 * tr + a;
+            if (row >= outputRows)
+              continue;
+
+            output(row, 2 * tc, o) = s[a][0] + s[a][1] + s[a][2];
+            if (2 * tc + 1 < outputCols)
+              output(row, 2 * tc + 1, o) = s[a][1] - s[a][2] - s[a][3];
+          }
+        }
+      }
+    }
+  }
+};  // class Im2ColConvolution
+
+//! Im2ColConvolution lowers all the maps of the Convolution layer into one
+//! matrix product.
+template<typename BorderMode>
+class ConvolutionRuleTraits<Im2ColConvolution<BorderMode> >
+{
+ public:
+  static const bool LowersMaps = true;
+};
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
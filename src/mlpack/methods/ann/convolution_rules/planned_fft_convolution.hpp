@@ -0,0 +1,244 @@
+/**
+ * @file planned_fft_convolution.hpp
+ *
+ * Implementation of the convolution of all the maps of a Convolution layer
+ * through fft, with cached filter transforms.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_CONVOLUTION_RULES_PLANNED_FFT_CONVOLUTION_HPP
+#define MLPACK_METHODS_ANN_CONVOLUTION_RULES_PLANNED_FFT_CONVOLUTION_HPP
+
+#include <mlpack/prereqs.hpp>
+#include "border_modes.hpp"
+#include "convolution_rule_traits.hpp"
+#include "im2col_convolution.hpp"
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+/**
+ * Computes the convolutions of a Convolution layer (valid mode, with the
+ * semantics of NaiveConvolution) through fft, for all the maps at once.  The
+ * transform size is the input size rounded up to a product of 2, 3 and 5, and
+ * the input maps are copied into a zero-padded buffer that is kept between
+ * calls.  Each input map is transformed once, the products with the filters of
+ * each output map are summed in the frequency domain, and each output map is
+ * transformed back once, so a forward pass takes inSize + outSize transforms
+ * instead of three for every pair of input and output maps.
+ *
+ * The transforms of the filters are cached, and only recomputed when the
+ * filters (compared by value) or the size of the input change, so during
+ * inference, or between the updates of the weights, they cost nothing.  The
+ * cache holds outSize * inSize transforms of the size of the input maps.
+ *
+ * Since the cost of the transforms doesn't depend on the filter size, this is
+ * much faster than NaiveConvolution for large filters.  Strided convolutions
+ * are computed with unit stride and subsampled.  MapsBackward() and
+ * MapsGradient() are those of Im2ColConvolution.
+ *
+ * @code
+ * Convolution<PlannedFFTConvolution, NaiveConvolution<FullConvolution>,
+ *     NaiveConvolution<ValidConvolution> > layer(3, 16, 11, 11);
+ * @endcode
+ */
+class PlannedFFTConvolution
+{
+ public:
+  //! Create the PlannedFFTConvolution object, with nothing cached.
+  PlannedFFTConvolution() :
+      inputRows(0),
+      inputCols(0),
+      filterTransforms(0)
+  { /* Nothing to do. */ }
+
+  /*
+   * Convolve all the input maps with all the filters (valid mode), and sum
+   * the results of each output map over the input maps.  Filter slice
+   * o * input.n_slices + i is applied to input map i for output map o.  The
+   * rows of the input are strided by dW and the columns by dH.
+   *
+   * @param input Input maps, one per slice.
+   * @param filters Filters, one per pair of output and input maps.
+   * @param output Output maps, one per slice.
+   * @param dW Stride of filter application in the x direction.
+   * @param dH Stride of filter application in the y direction.
+   */
+  void MapsConvolution(const arma::cube& input,
+                       const arma::cube& filters,
+                       arma::cube& output,
+                       const size_t dW = 1,
+                       const size_t dH = 1)
+  {
+    const size_t inSize = input.n_slices;
+    const size_t outSize = filters.n_slices / inSize;
+    const size_t outputRows = (input.n_rows - filters.n_rows) / dW + 1;
+    const size_t outputCols = (input.n_cols - filters.n_cols) / dH + 1;
+
+    Plan(input.n_rows, input.n_cols, filters);
+
+    // Transform each input map once.
+    inputSpectra.set_size(paddedInput.n_rows, paddedInput.n_cols, inSize);
+    for (size_t i = 0; i < inSize; ++i)
+    {
+      paddedInput.submat(0, 0, input.n_rows - 1, input.n_cols - 1) =
+          input.slice(i);
+      inputSpectra.slice(i) = arma::fft2(paddedInput);
+    }
+
+    // Sum the products of each output map in the frequency domain.  The
+    // filter transforms are conjugated, so the products are correlations, and
+    // with the transform at least as large as the input, the valid part
+    // doesn't wrap around.
+    output.set_size(outputRows, outputCols, outSize);
+    arma::cx_mat spectrum;
+    for (size_t o = 0; o < outSize; ++o)
+    {
+      spectrum = inputSpectra.slice(0) % filterSpectra.slice(o * inSize);
+      for (size_t i = 1; i < inSize; ++i)
+        spectrum += inputSpectra.slice(i) % filterSpectra.slice(o * inSize + i);
+
+      const arma::mat correlation = arma::real(arma::ifft2(spectrum));
+      for (size_t c = 0; c < outputCols; ++c)
+        for (size_t r = 0; r < outputRows; ++r)
+          output(r, c, o) = correlation(r * dW, c * dH);
+    }
+  }
+
+  /*
+   * Backpropagate the error of the output maps of MapsConvolution() to the
+   * input maps, with Im2ColConvolution.
+   *
+   * @param error Error of the output maps, one per slice.
+   * @param filters Filters, one per pair of output and input maps.
+   * @param input Error of the input maps, one per slice.
+   * @param dW Stride of filter application in the x direction.
+   * @param dH Stride of filter application in the y direction.
+   */
+  template<typename eT>
+  static void MapsBackward(const arma::Cube<eT>& error,
+                           const arma::Cube<eT>& filters,
+                           arma::Cube<eT>& input,
+                           const size_t dW = 1,
+                           const size_t dH = 1)
+  {
+    Im2ColConvolution<ValidConvolution>::MapsBackward(error, filters, input,
+        dW, dH);
+  }
+
+  /*
+   * Compute the gradient of the filters of MapsConvolution() from the input
+   * maps and the error of the output maps, with Im2ColConvolution.
+   *
+   * @param input Input maps of the forward pass, one per slice.
+   * @param error Error of the output maps, one per slice.
+   * @param kW Width of the filters.
+   * @param kH Height of the filters.
+   * @param dW Stride of filter application in the x direction.
+   * @param dH Stride of filter application in the y direction.
+   * @param gradient Gradient of the filters, one per pair of output and input
+   *     maps.
+   */
+  template<typename eT>
+  static void MapsGradient(const arma::Cube<eT>& input,
+                           const arma::Cube<eT>& error,
+                           const size_t kW,
+                           const size_t kH,
+                           const size_t dW,
+                           const size_t dH,
+                           arma::Cube<eT>& gradient)
+  {
+    Im2ColConvolution<ValidConvolution>::MapsGradient(input, error, kW, kH,
+        dW, dH, gradient);
+  }
+
+  //! Get the number of times the filter transforms were computed.
+  size_t FilterTransforms() const { return filterTransforms; }
+
+  //! Return the smallest product of 2, 3 and 5 that is at least n.
+  static size_t TransformSize(const size_t n)
+  {
+    for (size_t size = std::max(n, (size_t) 1); ; ++size)
+    {
+      size_t m = size;
+      while (m % 2 == 0) m /= 2;
+      while (m % 3 == 0) m /= 3;
+      while (m % 5 == 0) m /= 5;
+      if (m == 1)
+        return size;
+    }
+  }
+
+ private:
+  /*
+   * Prepare the padded input buffer for inputs of the given size, and compute
+   * the transforms of the filters, unless they are cached.
+   *
+   * @param rows Number of rows of the input maps.
+   * @param cols Number of columns of the input maps.
+   * @param filters Filters, one per pair of output and input maps.
+   */
+  void Plan(const size_t rows, const size_t cols, const arma::cube& filters)
+  {
+    if (rows != inputRows || cols != inputCols)
+    {
+      // The padding must be zero, so the buffer is reset whenever the input
+      // size changes.
+      inputRows = rows;
+      inputCols = cols;
+      paddedInput.zeros(TransformSize(rows), TransformSize(cols));
+      cachedFilters.reset();
+    }
+
+    if (filters.n_rows == cachedFilters.n_rows &&
+        filters.n_cols == cachedFilters.n_cols &&
+        filters.n_slices == cachedFilters.n_slices &&
+        std::equal(filters.begin(), filters.end(), cachedFilters.begin()))
+      return;
+
+    cachedFilters = filters;
+    filterSpectra.set_size(paddedInput.n_rows, paddedInput.n_cols,
+        filters.n_slices);
+    arma::mat paddedFilter(paddedInput.n_rows, paddedInput.n_cols,
+        arma::fill::zeros);
+    for (size_t s = 0; s < filters.n_slices; ++s)
+    {
+      paddedFilter.submat(0, 0, filters.n_rows - 1, filters.n_cols - 1) =
+          filters.slice(s);
+      filterSpectra.slice(s) = arma::conj(arma::fft2(paddedFilter));
+    }
+    ++filterTransforms;
+  }
+
+  //! Number of rows of the input maps of the plan.
+  size_t inputRows;
+  //! Number of columns of the input maps of the plan.
+  size_t inputCols;
+  //! The zero-padded buffer the input maps are copied into.
+  arma::mat paddedInput;
+  //! The transforms of the input maps.
+  arma::cx_cube inputSpectra;
+  //! The filters whose transforms are cached.
+  arma::cube cachedFilters;
+  //! The conjugated transforms of the filters.
+  arma::cx_cube filterSpectra;
+  //! Number of times the filter transforms were computed.
+  size_t filterTransforms;
+};  // class PlannedFFTConvolution
+
+//! PlannedFFTConvolution convolves all the maps of the Convolution layer at
+//! once.
+template<>
+class ConvolutionRuleTraits<PlannedFFTConvolution>
+{
+ public:
+  static const bool LowersMaps = true;
+};
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
@@ -15,8 +15,11 @@
 
 #include <mlpack/prereqs.hpp>
 
+#include <memory>
+
 #include "visitor/delete_visitor.hpp"
 #include "visitor/delta_visitor.hpp"
+#include "visitor/lstm_layout_visitor.hpp"
 #include "visitor/output_height_visitor.hpp"
 #include "visitor/output_parameter_visitor.hpp"
 #include "visitor/output_width_visitor.hpp"
@@ -25,17 +28,48 @@
 #include "visitor/copy_visitor.hpp"
 
 #include "init_rules/network_init.hpp"
+#include "layer_profiler.hpp"
 
 #include <mlpack/methods/ann/layer/layer_types.hpp>
 #include <mlpack/methods/ann/init_rules/random_init.hpp>
 #include <mlpack/core/optimizers/rmsprop/rmsprop.hpp>
+#include <mlpack/core/data/data_loader.hpp>
 
 namespace mlpack {
 namespace ann /** Artificial Neural Network. */ {
 
+template<typename OutputLayerType, typename InitializationRuleType>
+class QuantizedFFN;
+
 /**
  * Implementation of a standard feed forward network.
  *
+ * Once the input size of the layers is set (after the first pass), the
+ * deterministic passes of Predict() and Evaluate() run a fused plan of the
+ * network, made the first time the network is switched to deterministic mode:
+ * Dropout modules that pass their input through unchanged are left out,
+ * DropConnect modules are replaced by the modules they hold, and a Linear
+ * module followed by a sigmoid, identity, tanh or rectifier layer applies the
+ * bias and the activation (and the scaling of a Dropout module after them) to
+ * each block of its output right after the matrix product.  With the
+ * NegativeLogLikelihood output layer, the loss of a last LogSoftMax module is
+ * computed from its input directly, without its output.
+ *
+ * If CheckpointInterval() is set to k > 0, the training passes only keep the
+ * outputs of every k-th layer (the checkpoints) and of the last k layers.
+ * The backward pass then goes through the network in segments of k layers,
+ * from the last one: the outputs of a segment are recomputed from the
+ * checkpoint before it, and its deltas and gradients are computed and freed
+ * before the segment before it is recomputed.  With k about the square root
+ * of the number of layers, the activation memory drops from O(L) to
+ * O(sqrt(L)), for about one more forward pass.  The random numbers of the
+ * forward pass are replayed for the recomputed segments, so Dropout and
+ * DropConnect draw the same masks again; a module that holds other modules
+ * (such as Sequential) is one layer, whose inner outputs are freed and
+ * recomputed with it.  Recurrent modules (LSTM, Recurrent and
+ * RecurrentAttention) move to the next time step on each forward pass, so the
+ * checkpointed passes throw an exception if the network holds one.
+ *
  * @tparam OutputLayerType The output layer type used to evaluate the network.
  * @tparam InitializationRuleType Rule used to initialize the weight matrix.
  */
@@ -49,6 +83,65 @@ class FFN
   //! Convenience typedef for the internal model construction.
   using NetworkType = FFN<OutputLayerType, InitializationRuleType>;
 
+  /**
+   * A Workspace holds the state of the passes of the const, thread-safe
+   * Predict() and Gradient(): a copy of the layers of a trained network, whose
+   * weights point into the parameters of the network instead of copies of
+   * them, and whose output parameters, deltas and gradients hold the state of
+   * the passes.  Each thread predicting with (or computing gradients of) the
+   * same network must use its own workspace; the workspace can be reused for
+   * any number of calls.
+   *
+   * The workspace is only valid as long as the parameters of the network are
+   * not reallocated, so it must be created again after the network is trained,
+   * reset or loaded.  Networks with modules that hold other modules (such as
+   * Sequential or Concat) are not supported, since the copies of these modules
+   * share the modules they hold.
+   */
+  class Workspace
+  {
+   public:
+    /**
+     * Create a workspace for the given trained network.  An exception is
+     * thrown if the network has no parameters or holds modules that hold
+     * other modules.
+     *
+     * @param network Trained network to predict with.
+     */
+    Workspace(const FFN& network);
+
+    //! Destructor to release the copies of the layers.
+    ~Workspace();
+
+    //! The workspace can't be copied, since it owns its layers.
+    Workspace(const Workspace&) = delete;
+    Workspace& operator=(const Workspace&) = delete;
+
+   private:
+    //! The network that the workspace was created for.
+    const FFN* owner;
+    //! The copies of the layers of the network.
+    std::vector<LayerTypes> network;
+    //! The input width.
+    size_t width;
+    //! The input height.
+    size_t height;
+    //! Whether the input size of the layers has been set.
+    bool reset;
+    //! Whether the copies of the layers are in deterministic mode.
+    bool deterministic;
+    //! The copy of the output layer of the network.
+    OutputLayerType outputLayer;
+    //! The input of the current pass.
+    arma::mat input;
+    //! The error of the current backward pass.
+    arma::mat error;
+    //! The gradient of one point, if the layers don't support batches.
+    arma::mat gradient;
+
+    friend class FFN;
+  };
+
   /**
    * Create the FFN object with the given predictors and responses set (this is
    * the set that is used to train the network) and the given optimizer.
@@ -131,10 +224,37 @@ class FFN
   >
   void Train(const arma::mat& predictors, const arma::mat& responses);
 
+  /**
+   * Train the feedforward network on the batches of the given loader for the
+   * given number of epochs, using the given optimizer.  The dataset doesn't
+   * have to fit in memory: while the optimizer runs on one batch, the loader
+   * reads and prepares the next batches in the background.
+   *
+   * Each batch is optimized like the dataset given to the other overloads of
+   * Train(), so the optimizer should usually make a single pass over a batch
+   * (for instance, MiniBatchSGD with as many iterations as it has mini-batches
+   * in a batch of the loader).  The state of the optimizer (such as the
+   * moments of Adam) starts anew with each batch, so batches of the loader
+   * should hold many mini-batches of the optimizer.
+   *
+   * @tparam OptimizerType Type of optimizer to use to train the model.
+   * @param loader Loader of the batches of training data.
+   * @param optimizer Instantiated optimizer used to train the model.
+   * @param epochs Number of passes over the data of the loader.
+   */
+  template<
+      template<typename, typename...> class OptimizerType,
+      typename... OptimizerTypeArgs
+  >
+  void Train(data::DataLoader& loader,
+             OptimizerType<NetworkType, OptimizerTypeArgs...>& optimizer,
+             const size_t epochs = 1);
+
   /**
    * Predict the responses to a given set of predictors. The responses will
    * reflect the output of the given output layer as returned by the
-   * output layer function.
+   * output layer function.  If every layer of the network supports batches,
+   * the predictors are passed through the network in blocks of columns.
    *
    * @param predictors Input predictors.
    * @param results Matrix to put output predictions of responses into.
@@ -142,17 +262,59 @@ class FFN
   void Predict(const arma::mat& predictors, arma::mat& results);
 
   /**
-   * Evaluate the feedforward network with the given parameters. This function
-   * is usually called by the optimizer to train the model.
+   * Predict the responses to a given set of predictors, using the given
+   * workspace for the forward passes.  This doesn't modify the network, so
+   * many threads can predict with one trained network at once, as long as
+   * each one has its own workspace.  If every layer of the network supports
+   * batches, the predictors are passed through the layers in blocks of
+   * columns.
+   *
+   * @code
+   * // Each thread creates (and keeps) a workspace for the shared network.
+   * FFN<>::Workspace workspace(model);
+   * model.Predict(predictors, results, workspace);
+   * @endcode
+   *
+   * @param predictors Input predictors.
+   * @param results Matrix to put output predictions of responses into.
+   * @param workspace Workspace created for this network.
+   */
+  void Predict(const arma::mat& predictors,
+               arma::mat& results,
+               Workspace& workspace) const;
+
+  /**
+   * Evaluate the feedforward network with the given parameters, in
+   * deterministic mode. This function is usually called by the optimizer to
+   * train the model.
+   *
+   * @param parameters Matrix model parameters.
+   * @param i Index of point to use for objective function evaluation.
+   */
+  double Evaluate(const arma::mat& parameters, const size_t i)
+  {
+    return EvaluatePoint(parameters, i, true);
+  }
+
+  /**
+   * Evaluate the feedforward network with the given parameters, in the given
+   * mode.  This overload only accepts a bool for the mode (it is a template
+   * for that reason), so that Evaluate(parameters, 0, 20) calls the batch
+   * overload instead of being ambiguous with this one.
    *
    * @param parameters Matrix model parameters.
    * @param i Index of point to use for objective function evaluation.
    * @param deterministic Whether or not to train or test the model. Note some
    *        layer act differently in training or testing mode.
    */
+  template<typename BoolType,
+           typename = std::enable_if_t<std::is_same<BoolType, bool>::value>>
   double Evaluate(const arma::mat& parameters,
                   const size_t i,
-                  const bool deterministic = true);
+                  const BoolType deterministic)
+  {
+    return EvaluatePoint(parameters, i, deterministic);
+  }
 
   /**
    * Evaluate the gradient of the feedforward network with the given parameters,
@@ -167,6 +329,105 @@ class FFN
                 const size_t i,
                 arma::mat& gradient);
 
+  /**
+   * Evaluate the gradient of the feedforward network with the given parameters
+   * with respect to only one point in the dataset, as a sparse matrix.  The
+   * modules with a sparse gradient mode (such as Lookup) only compute the
+   * columns of their weights that the point uses, so the cost of a step with
+   * an embedding table doesn't depend on the size of the vocabulary.  This is
+   * used by the sparse optimizers (SparseSGD, SparseAdam, SparseAdaGrad).
+   * Modules inside modules that hold other modules always have a dense
+   * gradient.
+   *
+   * @param parameters Matrix of the model parameters to be optimized.
+   * @param i Index of points to use for objective function gradient evaluation.
+   * @param gradient Sparse matrix to output gradient into.
+   */
+  void Gradient(const arma::mat& parameters,
+                const size_t i,
+                arma::sp_mat& gradient);
+
+  /**
+   * Evaluate the feedforward network with the given parameters on the batch of
+   * points [begin, begin + batchSize), and return the sum of the objective over
+   * the points.  If every layer of the network supports batches (see
+   * LayerTraits::SupportsBatches), the whole batch is passed through the
+   * network as one matrix; otherwise the points are evaluated one by one.
+   *
+   * @param parameters Matrix model parameters.
+   * @param begin Index of the first point of the batch.
+   * @param batchSize Number of points in the batch.
+   * @param deterministic Whether or not to train or test the model. Note some
+   *        layer act differently in training or testing mode.
+   */
+  double Evaluate(const arma::mat& parameters,
+                  const size_t begin,
+                  const size_t batchSize,
+                  const bool deterministic);
+
+  /**
+   * Evaluate the feedforward network with the given parameters on the batch of
+   * points [begin, begin + batchSize) in deterministic mode.  This is called by
+   * optimizers that handle mini-batches, such as MiniBatchSGD.
+   *
+   * @param parameters Matrix model parameters.
+   * @param begin Index of the first point of the batch.
+   * @param batchSize Number of points in the batch.
+   */
+  double Evaluate(const arma::mat& parameters,
+                  const size_t begin,
+                  const size_t batchSize)
+  {
+    return Evaluate(parameters, begin, batchSize, true);
+  }
+
+  /**
+   * Evaluate the gradient of the feedforward network with the given parameters
+   * with respect to the batch of points [begin, begin + batchSize); this is
+   * the sum of the gradients of the points.  If every layer of the network
+   * supports batches, the batch is passed forward and backward through the
+   * network as one matrix, so the gradients of the weights are matrix-matrix
+   * products.
+   *
+   * If Replicas() is more than 1, the batch is split into that many shards,
+   * and the gradient of each shard is computed on its own thread by a replica
+   * of the network (a Workspace); the gradients of the shards are then summed
+   * with a tree reduction.  This works with any optimizer that calls this
+   * function, such as MiniBatchSGD.  Networks with modules that hold other
+   * modules aren't replicated.
+   *
+   * @param parameters Matrix of the model parameters to be optimized.
+   * @param begin Index of the first point of the batch.
+   * @param gradient Matrix to output gradient into.
+   * @param batchSize Number of points in the batch.
+   */
+  void Gradient(const arma::mat& parameters,
+                const size_t begin,
+                arma::mat& gradient,
+                const size_t batchSize);
+
+  /**
+   * Evaluate the gradient of the feedforward network with respect to the batch
+   * of points [begin, begin + batchSize), using the given workspace for the
+   * passes.  This doesn't modify the network, so many threads can compute
+   * gradients of one network at once, as long as each one has its own
+   * workspace.  The layers of the workspace point into the parameters of the
+   * network, so the gradient is always taken at the current parameters of the
+   * network, even while other threads update them (as in HogwildSGD).
+   *
+   * @param parameters Matrix of the model parameters (ignored; the parameters
+   *     of the network are used).
+   * @param begin Index of the first point of the batch.
+   * @param gradient Matrix to output gradient into.
+   * @param batchSize Number of points in the batch.
+   * @param workspace Workspace created for this network.
+   */
+  void Gradient(const arma::mat& parameters,
+                const size_t begin,
+                arma::mat& gradient,
+                const size_t batchSize,
+                Workspace& workspace) const;
+
   /**
    * Compute the gradient of the feedforward network based on given input and target.
    *
@@ -195,6 +456,27 @@ class FFN
   //! Return the number of separable functions (the number of predictor points).
   size_t NumFunctions() const { return numFunctions; }
 
+  //! Get the number of replicas that the batch gradient is sharded across.
+  size_t Replicas() const { return replicas; }
+  //! Modify the number of replicas that the batch gradient is sharded across
+  //! (1 computes the gradient in the network itself).
+  size_t& Replicas() { return replicas; }
+
+  //! Get the number of layers between two checkpoints of the training passes
+  //! (0 if every output is kept).
+  size_t CheckpointInterval() const { return checkpointInterval; }
+  //! Modify the number of layers between two checkpoints of the training
+  //! passes (0 keeps every output).
+  size_t& CheckpointInterval() { return checkpointInterval; }
+
+  //! Get the profiler of the layers of the network.
+  const LayerProfiler& Profiler() const { return profiler; }
+  //! Modify the profiler of the layers of the network.  Once it is enabled, it
+  //! records the training passes of the layers of the network; the fused
+  //! deterministic passes and the passes of replicas and workspaces aren't
+  //! recorded.
+  LayerProfiler& Profiler() { return profiler; }
+
   //! Return the initial point for the optimization.
   const arma::mat& Parameters() const { return parameter; }
   //! Modify the initial point for the optimization.
@@ -207,7 +489,7 @@ class FFN
 
   //! Serialize the model.
   template<typename Archive>
-  void Serialize(Archive& ar, const unsigned int /* version */);
+  void Serialize(Archive& ar, const unsigned int version);
 
  private:
   // Helper functions.
@@ -215,9 +497,83 @@ class FFN
    * The Forward algorithm (part of the Forward-Backward algorithm).  Computes
    * forward probabilities for each module.
    *
+   * In deterministic mode, the fused plan of the network is run (see
+   * FusedForward()).  If mergeLoss is true and the loss of the last LogSoftMax
+   * module is merged with the output layer, the LogSoftMax isn't run, and its
+   * input is returned instead (see mergedLoss).
+   *
    * @param input Data sequence to compute probabilities for.
+   * @param mergeLoss Whether the caller computes the merged loss.
+   * @return The output of the network.
+   */
+  arma::mat& Forward(arma::mat&& input, const bool mergeLoss = false);
+
+  /**
+   * Pass the given input forward through the given layers, and set the input
+   * size of the layers if it has not been set yet.  This is used both for the
+   * layers of the network and for those of a workspace.
+   *
+   * @param network Layers to pass the input through.
+   * @param input Input of the first layer.
+   * @param reset Whether the input size of the layers has been set; if not, it
+   *     is set, and reset is set to true.
+   * @param width Input width (modified when the input size is set).
+   * @param height Input height (modified when the input size is set).
+   * @param profiler Profiler to record the passes with (none if NULL).
+   */
+  static void Forward(std::vector<LayerTypes>& network,
+                      arma::mat&& input,
+                      bool& reset,
+                      size_t& width,
+                      size_t& height,
+                      LayerProfiler* profiler = NULL);
+
+  /**
+   * Make the fused plan of the deterministic passes of the network: the
+   * Dropout modules that don't scale their input are left out, the DropConnect
+   * modules are replaced by the modules they hold, and each Linear module
+   * followed by a sigmoid, identity, tanh or rectifier layer is fused with it
+   * (and with the scaling of a Dropout module after them).
+   */
+  void PlanFusion();
+
+  /**
+   * Pass the given input through the fused plan, alternating the outputs of
+   * the steps between two buffers, and return the output of the last step.
+   *
+   * @param input Input of the first step.
+   * @param skipLast Whether to stop before the last step (and return its
+   *     input).
    */
-  void Forward(arma::mat&& input);
+  arma::mat& FusedForward(arma::mat&& input, const bool skipLast);
+
+  /**
+   * Return the negative log likelihood of the given targets under the log
+   * softmax of the given input, as the NegativeLogLikelihood of the output of
+   * a LogSoftMax module, without computing that output.
+   *
+   * @param input Input of the LogSoftMax module (one point per column).
+   * @param target Target classes (one per column).
+   */
+  static double LogSoftMaxLoss(const arma::mat& input, const arma::mat& target);
+
+  //! Add the bias to each column of a block of the output of a Linear module,
+  //! apply the activation function and scale the result, in place.
+  template<typename ActivationFunction>
+  static void BiasActivation(double* output,
+                             const size_t rows,
+                             const size_t cols,
+                             const double* bias,
+                             const double scale);
+
+  //! The function that finishes a block of the output of a fused Linear step.
+  typedef void (*EpilogueFunction)(double*, const size_t, const size_t,
+                                   const double*, const double);
+
+  /**
+   * Return whether every given layer can process a batch of points at once.
+   */
+  static bool SupportsBatches(const std::vector<LayerTypes>& network);
 
   /**
    * Prepare the network for the given data.
@@ -228,18 +584,102 @@ class FFN
    */
   void ResetData(const arma::mat& predictors, const arma::mat& responses);
 
+  /**
+   * Pass the point of the given index forward through the network, and return
+   * its objective.  The point is left as the current input and target, for
+   * the backward pass of Gradient().
+   *
+   * @param parameters Matrix model parameters.
+   * @param i Index of the point.
+   * @param deterministic Whether or not to train or test the model.
+   */
+  double EvaluatePoint(const arma::mat& parameters,
+                       const size_t i,
+                       const bool deterministic);
+
   /**
    * The Backward algorithm (part of the Forward-Backward algorithm). Computes
    * backward pass for module.
    */
   void Backward();
 
+  /**
+   * Pass the given error of the output backward through the given layers.
+   * This is used both for the layers of the network and for those of a
+   * workspace.
+   *
+   * @param network Layers to pass the error through.
+   * @param error Error of the output of the last layer.
+   * @param profiler Profiler to record the passes with (none if NULL).
+   */
+  static void Backward(std::vector<LayerTypes>& network,
+                       arma::mat& error,
+                       LayerProfiler* profiler = NULL);
+
+  /**
+   * Pass the given input through the layer with the given index, and set the
+   * input size of the layer first if it has not been set yet.
+   *
+   * @param i Index of the layer.
+   * @param input Input of the layer.
+   */
+  void ForwardLayer(const size_t i, arma::mat&& input);
+
+  /**
+   * Pass the given input forward through the network, and only keep the
+   * outputs of the checkpoints and of the last segment.
+   *
+   * @param input Input of the first layer.
+   */
+  void CheckpointedForward(arma::mat&& input);
+
+  /**
+   * Compute the deltas and the gradients of the layers after a checkpointed
+   * forward pass, one segment at a time from the last, recomputing the
+   * outputs of each segment before.
+   */
+  void CheckpointedBackward();
+
   /**
    * Iterate through all layer modules and update the the gradient using the
    * layer defined optimizer.
    */
   void Gradient();
 
+  /**
+   * Compute the gradients of the given layers, after the forward pass of the
+   * given input and the backward pass of the given error.
+   *
+   * @param network Layers to compute the gradients of.
+   * @param input Input of the first layer.
+   * @param error Error of the output of the last layer.
+   * @param profiler Profiler to record the passes with (none if NULL).
+   */
+  static void Gradient(std::vector<LayerTypes>& network,
+                       arma::mat& input,
+                       arma::mat& error,
+                       LayerProfiler* profiler = NULL);
+
+  /**
+   * Shard the batch of points [begin, begin + batchSize) across the replicas,
+   * compute the gradient of each shard with its replica in parallel, and sum
+   * the gradients of the replicas with a tree reduction.
+   *
+   * @param begin Index of the first point of the batch.
+   * @param gradient Matrix to output gradient into.
+   * @param batchSize Number of points in the batch.
+   */
+  void ReplicaGradient(const size_t begin,
+                       arma::mat& gradient,
+                       const size_t batchSize);
+
+  /**
+   * Create the workspaces of the replicas if they don't match the number of
+   * replicas or the parameters of the network.  Return false if the network
+   * can't be replicated (because it has modules that hold other modules).
+   */
+  bool ResetReplicas();
+
   /**
    * Reset the module status by setting the current deterministic parameter
    * for all modules that implement the Deterministic function.
@@ -251,6 +691,37 @@ class FFN
    */
   void ResetGradients(arma::mat& gradient);
 
+  /**
+   * Point the output parameter and the delta of each layer into the arena, as
+   * planned by PlanBuffers().  Deterministic passes don't run the backward
+   * pass, so they alternate the output parameters between two buffers;
+   * otherwise every buffer has its own place in the arena, since the backward
+   * pass and the gradient need all of them.
+   */
+  void UseBuffers();
+
+  /**
+   * Plan the buffers of the layers for passes with the given batch size, from
+   * the shapes of the output parameters of the layers after a pass with that
+   * batch size.  The arena only grows, so no memory is allocated when the
+   * buffers are planned again for a batch size seen before.
+   *
+   * @param batchSize Number of points (columns) of the planned passes.
+   */
+  void PlanBuffers(const size_t batchSize);
+
+  /**
+   * Detach the output parameters and the deltas of the layers from the arena,
+   * before a pass that doesn't match the planned batch size.
+   */
+  void ReleaseBuffers();
+
+  /**
+   * Return whether every layer of the network can process a batch of points at
+   * once.
+   */
+  bool SupportsBatches() const;
+
   /**
    * Swap the content of this network with given network.
    *
@@ -322,6 +793,9 @@ class FFN
   //! The current evaluation mode (training or testing).
   bool deterministic;
 
+  //! The profiler of the layers.
+  LayerProfiler profiler;
+
   //! Locally-stored delta object.
   arma::mat delta;
 
@@ -334,13 +808,102 @@ class FFN
   //! Locally-stored gradient parameter.
   arma::mat gradient;
 
+  //! The dense gradient that the sparse Gradient() passes write into; only the
+  //! blocks of the modules without a sparse gradient are zeroed for each pass.
+  arma::mat sparseGradientBuffer;
+
   //! Locally-stored copy visitor
   CopyVisitor copyVisitor;
+
+  //! Memory for the planned output parameters and deltas of the layers.
+  arma::vec arena;
+
+  //! The batch size that the layer buffers are planned for (0 if none).
+  size_t plannedBatchSize;
+
+  //! The planned shape of the buffers of each layer: the rows and columns of
+  //! the output parameter, then those of the delta.
+  arma::Mat<size_t> bufferShapes;
+
+  //! The offsets in the arena of the buffers of each layer: the output
+  //! parameter and the delta for training passes, then the output parameter
+  //! for deterministic passes.
+  arma::Mat<size_t> bufferOffsets;
+
+  //! The number of replicas that the batch gradient is sharded across.
+  size_t replicas;
+
+  //! The workspaces of the replicas (created by ResetReplicas()).
+  std::vector<std::unique_ptr<Workspace>> replicaWorkspaces;
+
+  //! The gradients of the shards of the replicas other than the first one.
+  std::vector<arma::mat> replicaGradients;
+
+  //! The parameters that the workspaces of the replicas point into.
+  const double* replicaParameters;
+
+  //! The modules run by the fused deterministic passes (owned by the network).
+  std::vector<LayerTypes> fusedNetwork;
+
+  //! The epilogue of each fused step (NULL if the module runs on its own).
+  std::vector<EpilogueFunction> fusedEpilogues;
+
+  //! The scale of the output of each fused step (that of a Dropout module
+  //! merged into it, or 1).
+  std::vector<double> fusedScales;
+
+  //! The number of modules the fused plan was made for (0 if there is none).
+  size_t fusedSize;
+
+  //! Whether the loss of the last fused step (a LogSoftMax) can be merged with
+  //! the output layer.
+  bool fusedLoss;
+
+  //! Whether the last pass stopped before the LogSoftMax of a merged loss.
+  bool mergedLoss;
+
+  //! The buffers that the fused steps alternate their outputs between.
+  arma::mat fusedBuffers[2];
+
+  //! The number of layers between two checkpoints (0 for no checkpoints).
+  size_t checkpointInterval;
+
+  //! Whether the last forward pass only kept the outputs of the checkpoints.
+  bool checkpointed;
+
+  //! The counter of the random stream at the start of each segment of the
+  //! last checkpointed forward pass.
+  std::vector<uint64_t> checkpointCounters;
+
+  //! The counter of the random stream after the last checkpointed forward
+  //! pass.
+  uint64_t checkpointEndCounter;
+
+  //! The quantized counterpart reads the layers and the parameters.
+  friend class QuantizedFFN<OutputLayerType, InitializationRuleType>;
 }; // class FFN
 
 } // namespace ann
 } // namespace mlpack
 
+//! Set the serialization version of the FFN class (version 1 stores the
+//! parameters of LSTM layers in the stacked layout).
+//! This is BOOST_TEMPLATE_CLASS_VERSION() written out, as in lstm.hpp.
+namespace boost {
+namespace serialization {
+
+template<typename OutputLayerType, typename InitializationRuleType>
+struct version<mlpack::data::SecondShim<
+    mlpack::ann::FFN<OutputLayerType, InitializationRuleType>>>
+{
+  typedef mpl::int_<1> type;
+  typedef mpl::integral_c_tag tag;
+  BOOST_STATIC_CONSTANT(int, value = version::type::value);
+};
+
+} // namespace serialization
+} // namespace boost
+
 // Include implementation.
 #include "ffn_impl.hpp"
 
@@ -16,12 +16,22 @@
 #include "ffn.hpp"
 
 #include "visitor/forward_visitor.hpp"
+#include "visitor/batch_support_visitor.hpp"
 #include "visitor/backward_visitor.hpp"
 #include "visitor/deterministic_set_visitor.hpp"
 #include "visitor/gradient_set_visitor.hpp"
 #include "visitor/gradient_visitor.hpp"
+#include "visitor/has_model_visitor.hpp"
+#include "visitor/recurrent_check_visitor.hpp"
+#include "visitor/release_output_visitor.hpp"
 #include "visitor/set_input_height_visitor.hpp"
 #include "visitor/set_input_width_visitor.hpp"
+#include "visitor/sparse_gradient_visitor.hpp"
+
+#include "layer/dropconnect.hpp"
+#include "layer/linear.hpp"
+
+#include <mlpack/core/math/random.hpp>
 
 namespace mlpack {
 namespace ann /** Artificial Neural Network. */ {
@@ -34,7 +44,16 @@ FFN<OutputLayerType, InitializationRuleType>::FFN(
     initializeRule(initializeRule),
     width(0),
     height(0),
-    reset(false)
+    reset(false),
+    plannedBatchSize(0),
+    replicas(1),
+    replicaParameters(NULL),
+    fusedSize(0),
+    fusedLoss(false),
+    mergedLoss(false),
+    checkpointInterval(0),
+    checkpointed(false),
+    checkpointEndCounter(0)
 {
   /* Nothing to do here */
 }
@@ -49,7 +68,16 @@ FFN<OutputLayerType, InitializationRuleType>::FFN(
     initializeRule(initializeRule),
     width(0),
     height(0),
-    reset(false)
+    reset(false),
+    plannedBatchSize(0),
+    replicas(1),
+    replicaParameters(NULL),
+    fusedSize(0),
+    fusedLoss(false),
+    mergedLoss(false),
+    checkpointInterval(0),
+    checkpointed(false),
+    checkpointEndCounter(0)
 {
   numFunctions = responses.n_cols;
 
@@ -132,6 +160,45 @@ void FFN<OutputLayerType, InitializationRuleType>::Train(
       << "." << std::endl;
 }
 
+template<typename OutputLayerType, typename InitializationRuleType>
+template<
+    template<typename, typename...> class OptimizerType,
+    typename... OptimizerTypeArgs
+>
+void FFN<OutputLayerType, InitializationRuleType>::Train(
+    data::DataLoader& loader,
+    OptimizerType<NetworkType, OptimizerTypeArgs...>& optimizer,
+    const size_t epochs)
+{
+  this->deterministic = true;
+  ResetDeterministic();
+
+  if (!reset)
+  {
+    ResetParameters();
+  }
+
+  // Train the model on each batch as it becomes ready.
+  Timer::Start("ffn_optimization");
+  arma::mat batchPredictors, batchResponses;
+  for (size_t epoch = 0; epoch < epochs; ++epoch)
+  {
+    double objective = 0;
+    while (loader.Next(batchPredictors, batchResponses))
+    {
+      numFunctions = batchResponses.n_cols;
+      predictors = std::move(batchPredictors);
+      responses = std::move(batchResponses);
+
+      objective += optimizer.Optimize(parameter);
+    }
+
+    Log::Info << "FFN::Train(): objective of epoch " << (epoch + 1)
+        << " is " << objective << "." << std::endl;
+  }
+  Timer::Stop("ffn_optimization");
+}
+
 template<typename OutputLayerType, typename InitializationRuleType>
 void FFN<OutputLayerType, InitializationRuleType>::Predict(
     const arma::mat& predictors, arma::mat& results)
@@ -147,26 +214,133 @@ void FFN<OutputLayerType, InitializationRuleType>::Predict(
     ResetDeterministic();
   }
 
+  if (SupportsBatches())
+  {
+    // Pass the predictors through the network in blocks of columns.
+    const size_t blockSize = 256;
+    for (size_t begin = 0; begin < predictors.n_cols; begin += blockSize)
+    {
+      const size_t end = std::min(begin + blockSize, (size_t) predictors.n_cols)
+          - 1;
+      const arma::mat& output = Forward(arma::mat(predictors.cols(begin,
+          end)));
+      if (begin == 0)
+        results.set_size(output.n_rows, predictors.n_cols);
+      results.cols(begin, end) = output;
+    }
+
+    return;
+  }
+
   arma::mat resultsTemp;
-  Forward(std::move(predictors.col(0)));
-  resultsTemp = boost::apply_visitor(outputParameterVisitor,
-      network.back()).col(0);
+  resultsTemp = Forward(std::move(predictors.col(0))).col(0);
 
   results = arma::mat(resultsTemp.n_elem, predictors.n_cols);
   results.col(0) = resultsTemp.col(0);
 
   for (size_t i = 1; i < predictors.n_cols; i++)
   {
-    Forward(std::move(predictors.col(i)));
-
-    resultsTemp = boost::apply_visitor(outputParameterVisitor,
-        network.back());
+    resultsTemp = Forward(std::move(predictors.col(i)));
     results.col(i) = resultsTemp.col(0);
   }
 }
 
 template<typename OutputLayerType, typename InitializationRuleType>
-double FFN<OutputLayerType, InitializationRuleType>::Evaluate(
+void FFN<OutputLayerType, InitializationRuleType>::Predict(
+    const arma::mat& predictors,
+    arma::mat& results,
+    Workspace& workspace) const
+{
+  if (workspace.owner != this)
+  {
+    throw std::invalid_argument("FFN::Predict(): the workspace was not "
+        "created for this network");
+  }
+
+  if (!workspace.deterministic)
+  {
+    workspace.deterministic = true;
+    DeterministicSetVisitor deterministicSetVisitor(true);
+    std::for_each(workspace.network.begin(), workspace.network.end(),
+        boost::apply_visitor(deterministicSetVisitor));
+  }
+
+  OutputParameterVisitor outputParameterVisitor;
+
+  // Pass the predictors through the layers of the workspace in blocks of
+  // columns, or one column at a time if some layer doesn't support batches.
+  const size_t blockSize = SupportsBatches(workspace.network) ? 256 : 1;
+  for (size_t begin = 0; begin < predictors.n_cols; begin += blockSize)
+  {
+    const size_t end = std::min(begin + blockSize, (size_t) predictors.n_cols)
+        - 1;
+    Forward(workspace.network, arma::mat(predictors.cols(begin, end)),
+        workspace.reset, workspace.width, workspace.height);
+
+    const arma::mat& output = boost::apply_visitor(outputParameterVisitor,
+        workspace.network.back());
+    if (begin == 0)
+      results.set_size(output.n_rows, predictors.n_cols);
+    results.cols(begin, end) = output;
+  }
+}
+
+template<typename OutputLayerType, typename InitializationRuleType>
+FFN<OutputLayerType, InitializationRuleType>::Workspace::Workspace(
+    const FFN& network) :
+    owner(&network),
+    width(network.width),
+    height(network.height),
+    reset(network.reset),
+    deterministic(true),
+    outputLayer(network.outputLayer)
+{
+  if (network.parameter.is_empty())
+  {
+    throw std::invalid_argument("FFN::Workspace::Workspace(): the network has "
+        "no parameters; train it first");
+  }
+
+  for (size_t i = 0; i < network.network.size(); ++i)
+  {
+    if (boost::apply_visitor(HasModelVisitor(), network.network[i]))
+    {
+      throw std::invalid_argument("FFN::Workspace::Workspace(): modules that "
+          "hold other modules are not supported");
+    }
+  }
+
+  // The copies of the layers only read the parameters of the network, so they
+  // can point into them.
+  arma::mat& parameter = const_cast<arma::mat&>(network.parameter);
+  CopyVisitor copyVisitor;
+  ResetVisitor resetVisitor;
+  size_t offset = 0;
+  for (size_t i = 0; i < network.network.size(); ++i)
+  {
+    this->network.push_back(boost::apply_visitor(copyVisitor,
+        network.network[i]));
+
+    offset += boost::apply_visitor(WeightSetVisitor(std::move(parameter),
+        offset), this->network[i]);
+    boost::apply_visitor(resetVisitor, this->network[i]);
+  }
+
+  DeterministicSetVisitor deterministicSetVisitor(true);
+  std::for_each(this->network.begin(), this->network.end(),
+      boost::apply_visitor(deterministicSetVisitor));
+}
+
+template<typename OutputLayerType, typename InitializationRuleType>
+FFN<OutputLayerType, InitializationRuleType>::Workspace::~Workspace()
+{
+  DeleteVisitor deleteVisitor;
+  std::for_each(network.begin(), network.end(),
+      boost::apply_visitor(deleteVisitor));
+}
+
+template<typename OutputLayerType, typename InitializationRuleType>
+double FFN<OutputLayerType, InitializationRuleType>::EvaluatePoint(
     const arma::mat& /* parameters */, const size_t i, const bool deterministic)
 {
   if (parameter.is_empty())
@@ -183,9 +357,11 @@ double FFN<OutputLayerType, InitializationRuleType>::Evaluate(
   currentInput = predictors.unsafe_col(i);
   currentTarget = responses.unsafe_col(i);
 
-  Forward(std::move(currentInput));
-  double res = outputLayer.Forward(std::move(boost::apply_visitor(
-      outputParameterVisitor, network.back())), std::move(currentTarget));
+  arma::mat& output = Forward(std::move(currentInput), true);
+  if (mergedLoss)
+    return LogSoftMaxLoss(output, currentTarget);
+
+  double res = outputLayer.Forward(std::move(output), std::move(currentTarget));
 
   return res;
 }
@@ -208,16 +384,341 @@ void FFN<OutputLayerType, InitializationRuleType>::Gradient(
     gradient.zeros();
   }
 
-  Evaluate(parameters, i, false);
+  EvaluatePoint(parameters, i, false);
+
+  outputLayer.Backward(std::move(boost::apply_visitor(outputParameterVisitor,
+      network.back())), std::move(currentTarget), std::move(error));
+
+  ResetGradients(gradient);
+  Backward();
+  Gradient();
+}
+
+template<typename OutputLayerType, typename InitializationRuleType>
+void FFN<OutputLayerType, InitializationRuleType>::Gradient(
+    const arma::mat& parameters, const size_t i, arma::sp_mat& gradient)
+{
+  if (parameter.is_empty())
+    ResetParameters();
+
+  if (sparseGradientBuffer.n_elem != parameter.n_elem)
+    sparseGradientBuffer.zeros(parameter.n_rows, parameter.n_cols);
+
+  // The modules with a sparse gradient zero the columns they write, so only
+  // the blocks of the other modules are zeroed.
+  arma::uvec columns;
+  size_t rows = 0;
+  size_t offset = 0;
+  for (size_t l = 0; l < network.size(); ++l)
+  {
+    const size_t weights = boost::apply_visitor(weightSizeVisitor,
+        network[l]);
+    if (weights > 0 && !boost::apply_visitor(SparseGradientVisitor(columns,
+        rows), network[l]))
+    {
+      sparseGradientBuffer.rows(offset, offset + weights - 1).zeros();
+    }
+
+    offset += weights;
+  }
+
+  EvaluatePoint(parameters, i, false);
 
   outputLayer.Backward(std::move(boost::apply_visitor(outputParameterVisitor,
       network.back())), std::move(currentTarget), std::move(error));
 
+  ResetGradients(sparseGradientBuffer);
   Backward();
+  Gradient();
+
+  // Collect the written entries: the used columns of the modules with a sparse
+  // gradient, and the whole blocks of the others.
+  std::vector<arma::uword> indices;
+  offset = 0;
+  for (size_t l = 0; l < network.size(); ++l)
+  {
+    const size_t weights = boost::apply_visitor(weightSizeVisitor,
+        network[l]);
+    if (boost::apply_visitor(SparseGradientVisitor(columns, rows),
+        network[l]))
+    {
+      for (size_t c = 0; c < columns.n_elem; ++c)
+        for (size_t r = 0; r < rows; ++r)
+          indices.push_back(offset + columns[c] * rows + r);
+    }
+    else
+    {
+      for (size_t k = 0; k < weights; ++k)
+        indices.push_back(offset + k);
+    }
+
+    offset += weights;
+  }
+
+  // The indices are increasing, since the offsets and columns are sorted.
+  arma::umat locations = arma::zeros<arma::umat>(2, indices.size());
+  arma::vec values(indices.size());
+  for (size_t k = 0; k < indices.size(); ++k)
+  {
+    locations(0, k) = indices[k];
+    values[k] = sparseGradientBuffer[indices[k]];
+  }
+
+  gradient = arma::sp_mat(locations, values, parameter.n_rows,
+      parameter.n_cols, false, true);
+}
+
+template<typename OutputLayerType, typename InitializationRuleType>
+double FFN<OutputLayerType, InitializationRuleType>::Evaluate(
+    const arma::mat& parameters,
+    const size_t begin,
+    const size_t batchSize,
+    const bool deterministic)
+{
+  if (!SupportsBatches())
+  {
+    double res = 0;
+    for (size_t i = begin; i < begin + batchSize; ++i)
+      res += EvaluatePoint(parameters, i, deterministic);
+
+    return res;
+  }
+
+  if (parameter.is_empty())
+  {
+    ResetParameters();
+  }
+
+  if (deterministic != this->deterministic)
+  {
+    this->deterministic = deterministic;
+    ResetDeterministic();
+  }
+
+  currentInput = predictors.cols(begin, begin + batchSize - 1);
+  currentTarget = responses.cols(begin, begin + batchSize - 1);
+
+  const arma::mat& output = Forward(std::move(currentInput), true);
+  if (mergedLoss)
+    return LogSoftMaxLoss(output, currentTarget);
+
+  // The output layer may not be separable over the columns (for instance, the
+  // mean squared error averages over all of them), so each point is evaluated
+  // on its own, as in the single point case.
+  double res = 0;
+  for (size_t i = 0; i < batchSize; ++i)
+  {
+    res += outputLayer.Forward(std::move(arma::mat(output.col(i))),
+        std::move(arma::mat(currentTarget.col(i))));
+  }
+
+  return res;
+}
+
+template<typename OutputLayerType, typename InitializationRuleType>
+void FFN<OutputLayerType, InitializationRuleType>::Gradient(
+    const arma::mat& parameters,
+    const size_t begin,
+    arma::mat& gradient,
+    const size_t batchSize)
+{
+  if (replicas > 1 && batchSize > 1 && ResetReplicas())
+  {
+    ReplicaGradient(begin, gradient, batchSize);
+    return;
+  }
+
+  if (!SupportsBatches())
+  {
+    Gradient(parameters, begin, gradient);
+
+    arma::mat pointGradient;
+    for (size_t i = begin + 1; i < begin + batchSize; ++i)
+    {
+      Gradient(parameters, i, pointGradient);
+      gradient += pointGradient;
+    }
+
+    return;
+  }
+
+  if (gradient.is_empty())
+  {
+    if (parameter.is_empty())
+    {
+      ResetParameters();
+    }
+
+    gradient = arma::zeros<arma::mat>(parameter.n_rows, parameter.n_cols);
+  }
+  else
+  {
+    gradient.zeros();
+  }
+
+  Evaluate(parameters, begin, batchSize, false);
+
+  const arma::mat& output = boost::apply_visitor(outputParameterVisitor,
+      network.back());
+  error.set_size(output.n_rows, batchSize);
+  arma::mat pointError;
+  for (size_t i = 0; i < batchSize; ++i)
+  {
+    outputLayer.Backward(std::move(arma::mat(output.col(i))),
+        std::move(arma::mat(currentTarget.col(i))), std::move(pointError));
+    error.col(i) = pointError;
+  }
+
+  // The layers sum the gradients of the points of the batch.
   ResetGradients(gradient);
+  Backward();
   Gradient();
 }
 
+template<typename OutputLayerType, typename InitializationRuleType>
+void FFN<OutputLayerType, InitializationRuleType>::Gradient(
+    const arma::mat& /* parameters */,
+    const size_t begin,
+    arma::mat& gradient,
+    const size_t batchSize,
+    Workspace& workspace) const
+{
+  if (workspace.owner != this)
+  {
+    throw std::invalid_argument("FFN::Gradient(): the workspace was not "
+        "created for this network");
+  }
+
+  if (workspace.deterministic)
+  {
+    workspace.deterministic = false;
+    DeterministicSetVisitor deterministicSetVisitor(false);
+    std::for_each(workspace.network.begin(), workspace.network.end(),
+        boost::apply_visitor(deterministicSetVisitor));
+  }
+
+  OutputParameterVisitor outputParameterVisitor;
+
+  // If some layer doesn't support batches, the points are passed through the
+  // layers one at a time, and their gradients are added up.
+  const size_t blockSize = SupportsBatches(workspace.network) ? batchSize : 1;
+  arma::mat& blockGradient = (blockSize == batchSize) ? gradient :
+      workspace.gradient;
+
+  gradient.zeros(parameter.n_rows, parameter.n_cols);
+  if (blockSize != batchSize)
+    blockGradient.zeros(parameter.n_rows, parameter.n_cols);
+
+  size_t offset = 0;
+  for (size_t i = 0; i < workspace.network.size(); ++i)
+  {
+    offset += boost::apply_visitor(GradientSetVisitor(std::move(blockGradient),
+        offset), workspace.network[i]);
+  }
+
+  arma::mat pointError;
+  for (size_t block = begin; block < begin + batchSize; block += blockSize)
+  {
+    workspace.input = predictors.cols(block, block + blockSize - 1);
+    Forward(workspace.network, std::move(workspace.input), workspace.reset,
+        workspace.width, workspace.height);
+
+    const arma::mat& output = boost::apply_visitor(outputParameterVisitor,
+        workspace.network.back());
+    workspace.error.set_size(output.n_rows, blockSize);
+    for (size_t i = 0; i < blockSize; ++i)
+    {
+      workspace.outputLayer.Backward(std::move(arma::mat(output.col(i))),
+          std::move(arma::mat(responses.col(block + i))),
+          std::move(pointError));
+      workspace.error.col(i) = pointError;
+    }
+
+    Backward(workspace.network, workspace.error);
+    Gradient(workspace.network, workspace.input, workspace.error);
+
+    if (blockSize != batchSize)
+      gradient += blockGradient;
+  }
+}
+
+template<typename OutputLayerType, typename InitializationRuleType>
+void FFN<OutputLayerType, InitializationRuleType>::ReplicaGradient(
+    const size_t begin,
+    arma::mat& gradient,
+    const size_t batchSize)
+{
+  // The first replica computes the gradient of its shard into the given
+  // gradient, and the others into their own.
+  const size_t numReplicas = std::min(replicas, batchSize);
+  std::vector<arma::mat*> shardGradients(numReplicas, &gradient);
+  for (size_t r = 1; r < numReplicas; ++r)
+    shardGradients[r] = &replicaGradients[r];
+
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables. If we're building for Visual Studio, use
+  // the intmax_t type instead.
+  #pragma omp parallel for num_threads(numReplicas) schedule(static)
+  for (intmax_t r = 0; r < (intmax_t) numReplicas; ++r)
+#else
+  #pragma omp parallel for num_threads(numReplicas) schedule(static)
+  for (size_t r = 0; r < numReplicas; ++r)
+#endif
+  {
+    const size_t shardBegin = begin + (r * batchSize) / numReplicas;
+    const size_t shardEnd = begin + ((r + 1) * batchSize) / numReplicas;
+    Gradient(parameter, shardBegin, *shardGradients[r], shardEnd - shardBegin,
+        *replicaWorkspaces[r]);
+  }
+
+  // Sum the gradients with a tree reduction: in each round, every replica
+  // whose index is a multiple of twice the stride adds the gradient of the
+  // replica one stride further, so there are only log2(numReplicas) rounds of
+  // parallel additions.
+  for (size_t stride = 1; stride < numReplicas; stride *= 2)
+  {
+#ifdef _WIN32
+    #pragma omp parallel for num_threads(numReplicas) schedule(static)
+    for (intmax_t r = 0; r < (intmax_t) (numReplicas - stride);
+        r += 2 * stride)
+#else
+    #pragma omp parallel for num_threads(numReplicas) schedule(static)
+    for (size_t r = 0; r < numReplicas - stride; r += 2 * stride)
+#endif
+    {
+      *shardGradients[r] += *shardGradients[r + stride];
+    }
+  }
+}
+
+template<typename OutputLayerType, typename InitializationRuleType>
+bool FFN<OutputLayerType, InitializationRuleType>::ResetReplicas()
+{
+  for (size_t i = 0; i < network.size(); ++i)
+  {
+    if (boost::apply_visitor(HasModelVisitor(), network[i]))
+      return false;
+  }
+
+  if (parameter.is_empty())
+  {
+    ResetParameters();
+  }
+
+  if (replicaWorkspaces.size() == replicas &&
+      replicaParameters == parameter.memptr())
+    return true;
+
+  replicaWorkspaces.clear();
+  for (size_t r = 0; r < replicas; ++r)
+    replicaWorkspaces.emplace_back(new Workspace(*this));
+
+  replicaGradients.resize(replicas);
+  replicaParameters = parameter.memptr();
+  return true;
+}
+
 template<typename OutputLayerType, typename InitializationRuleType>
 arma::mat FFN<OutputLayerType, InitializationRuleType>::Gradient(
   const arma::mat& predictors, const arma::mat& responses)
@@ -233,6 +734,11 @@ void FFN<OutputLayerType, InitializationRuleType>::ResetParameters()
 {
   ResetDeterministic();
 
+  // The network may have changed, so the buffers are planned again and the
+  // replicas are created again.
+  ReleaseBuffers();
+  replicaWorkspaces.clear();
+
   // Reset the network parameter with the given initialization rule.
   NetworkInitialization<InitializationRuleType> networkInit(initializeRule);
   networkInit.Initialize(network, parameter);
@@ -259,12 +765,491 @@ void FFN<OutputLayerType, InitializationRuleType>::ResetGradients(
 }
 
 template<typename OutputLayerType, typename InitializationRuleType>
-void FFN<OutputLayerType, InitializationRuleType>::Forward(arma::mat&& input)
+bool FFN<OutputLayerType, InitializationRuleType>::SupportsBatches() const
 {
+  return SupportsBatches(network);
+}
+
+template<typename OutputLayerType, typename InitializationRuleType>
+bool FFN<OutputLayerType, InitializationRuleType>::SupportsBatches(
+    const std::vector<LayerTypes>& network)
+{
+  for (size_t i = 0; i < network.size(); ++i)
+  {
+    if (!boost::apply_visitor(BatchSupportVisitor(), network[i]))
+      return false;
+  }
+
+  return true;
+}
+
+template<typename OutputLayerType, typename InitializationRuleType>
+arma::mat& FFN<OutputLayerType, InitializationRuleType>::Forward(
+    arma::mat&& input, const bool mergeLoss)
+{
+  // The fused plan is only run once the input size of the layers is set.
+  mergedLoss = false;
+  checkpointed = false;
+  if (deterministic && reset)
+  {
+    if (fusedSize != network.size())
+      PlanFusion();
+
+    mergedLoss = mergeLoss && fusedLoss;
+    return FusedForward(std::move(input), mergedLoss);
+  }
+
+  // The checkpointed passes free most outputs, so they don't use the planned
+  // buffers.
+  if (checkpointInterval > 0 && !deterministic)
+  {
+    if (plannedBatchSize != 0)
+      ReleaseBuffers();
+
+    CheckpointedForward(std::move(input));
+    return boost::apply_visitor(outputParameterVisitor, network.back());
+  }
+
+  // The buffers are planned from the shapes of the first pass with a new batch
+  // size, and the following passes with that batch size reuse them.
+  const size_t batchSize = input.n_cols;
+  const bool planned = (batchSize == plannedBatchSize) &&
+      (bufferShapes.n_cols == network.size());
+  if (planned)
+    UseBuffers();
+  else
+    ReleaseBuffers();
+
+  Forward(network, std::move(input), reset, width, height,
+      profiler.Enabled() ? &profiler : NULL);
+
+  if (!planned)
+    PlanBuffers(batchSize);
+
+  return boost::apply_visitor(outputParameterVisitor, network.back());
+}
+
+template<typename OutputLayerType, typename InitializationRuleType>
+void FFN<OutputLayerType, InitializationRuleType>::ForwardLayer(
+    const size_t i, arma::mat&& input)
+{
+  if (!reset && i > 0)
+  {
+    boost::apply_visitor(SetInputWidthVisitor(width), network[i]);
+    boost::apply_visitor(SetInputHeightVisitor(height), network[i]);
+  }
+
+  arma::mat& output = boost::apply_visitor(outputParameterVisitor, network[i]);
+  if (profiler.Enabled())
+    profiler.Start();
+
+  boost::apply_visitor(ForwardVisitor(std::move(input), std::move(output)),
+      network[i]);
+
+  if (profiler.Enabled())
+    profiler.Stop(i, LayerProfiler::FORWARD, network[i], input, output);
+
+  if (!reset)
+  {
+    if (boost::apply_visitor(outputWidthVisitor, network[i]) != 0)
+      width = boost::apply_visitor(outputWidthVisitor, network[i]);
+
+    if (boost::apply_visitor(outputHeightVisitor, network[i]) != 0)
+      height = boost::apply_visitor(outputHeightVisitor, network[i]);
+  }
+}
+
+template<typename OutputLayerType, typename InitializationRuleType>
+void FFN<OutputLayerType, InitializationRuleType>::CheckpointedForward(
+    arma::mat&& input)
+{
+  // Recurrent modules move to the next time step on each forward pass, so the
+  // recomputed segments would change their state.
+  for (size_t i = 0; i < network.size(); ++i)
+  {
+    if (boost::apply_visitor(RecurrentCheckVisitor(), network[i]))
+    {
+      throw std::invalid_argument("FFN::Forward(): checkpointed passes don't "
+          "support recurrent modules; set CheckpointInterval() to 0");
+    }
+  }
+
+  const size_t layers = network.size();
+  const size_t lastSegment = ((layers - 1) / checkpointInterval) *
+      checkpointInterval;
+  checkpointCounters.resize(lastSegment / checkpointInterval + 1);
+
+  // The counters of the random stream let the recomputed passes draw the same
+  // numbers (such as the masks of Dropout).
+  const math::RandomStream& stream = math::ThreadRandomStream();
+  for (size_t i = 0; i < layers; ++i)
+  {
+    if (i % checkpointInterval == 0)
+      checkpointCounters[i / checkpointInterval] = stream.Counter();
+
+    ForwardLayer(i, std::move((i == 0) ? input : boost::apply_visitor(
+        outputParameterVisitor, network[i - 1])));
+
+    // The input of the layer is not needed until its segment is recomputed,
+    // unless it is a checkpoint or in the last segment.
+    if (i > 0 && i - 1 < lastSegment && i % checkpointInterval != 0)
+      boost::apply_visitor(ReleaseOutputVisitor(), network[i - 1]);
+  }
+
+  checkpointEndCounter = stream.Counter();
+  reset = true;
+  checkpointed = true;
+}
+
+template<typename OutputLayerType, typename InitializationRuleType>
+void FFN<OutputLayerType, InitializationRuleType>::CheckpointedBackward()
+{
+  const size_t layers = network.size();
+  const size_t segments = (layers - 1) / checkpointInterval + 1;
+  LayerProfiler* layerProfiler = profiler.Enabled() ? &profiler : NULL;
+
+  for (size_t s = segments; s > 0; --s)
+  {
+    const size_t begin = (s - 1) * checkpointInterval;
+    const size_t end = std::min(begin + checkpointInterval, layers);
+
+    // The outputs of the last segment were kept; the others are recomputed
+    // from the checkpoint before them, with the same random numbers.
+    if (s < segments)
+    {
+      math::ThreadRandomStream().Counter() = checkpointCounters[s - 1];
+      for (size_t i = begin; i < end; ++i)
+      {
+        ForwardLayer(i, std::move((i == 0) ? currentInput :
+            boost::apply_visitor(outputParameterVisitor, network[i - 1])));
+      }
+    }
+
+    for (size_t i = end; i-- > begin; )
+    {
+      arma::mat& gy = (i == layers - 1) ? error :
+          boost::apply_visitor(deltaVisitor, network[i + 1]);
+
+      // As in Backward(), the first layer has no delta to compute.
+      if (i > 0 || layers == 1)
+      {
+        arma::mat& output = boost::apply_visitor(outputParameterVisitor,
+            network[i]);
+        arma::mat& g = boost::apply_visitor(deltaVisitor, network[i]);
+        if (layerProfiler)
+          layerProfiler->Start();
+
+        boost::apply_visitor(BackwardVisitor(std::move(output), std::move(gy),
+            std::move(g)), network[i]);
+
+        if (layerProfiler)
+          layerProfiler->Stop(i, LayerProfiler::BACKWARD, network[i], gy, g);
+      }
+
+      arma::mat& input = (i == 0) ? currentInput :
+          boost::apply_visitor(outputParameterVisitor, network[i - 1]);
+      if (layerProfiler)
+        layerProfiler->Start();
+
+      boost::apply_visitor(GradientVisitor(std::move(input), std::move(gy)),
+          network[i]);
+
+      if (layerProfiler)
+      {
+        layerProfiler->Stop(i, LayerProfiler::GRADIENT, network[i], input,
+            gy);
+      }
+    }
+
+    // Only the delta of the first layer of the segment is still needed, by
+    // the segment before it; the output of the last layer is kept for the
+    // caller.
+    for (size_t i = begin; i < end; ++i)
+    {
+      if (i < layers - 1)
+      {
+        boost::apply_visitor(ReleaseOutputVisitor(), network[i]);
+        boost::apply_visitor(deltaVisitor, network[i + 1]).reset();
+      }
+    }
+  }
+
+  math::ThreadRandomStream().Counter() = checkpointEndCounter;
+}
+
+template<typename OutputLayerType, typename InitializationRuleType>
+void FFN<OutputLayerType, InitializationRuleType>::PlanFusion()
+{
+  // Leave out the modules that deterministic passes don't need.
+  std::vector<LayerTypes> layers;
+  for (size_t i = 0; i < network.size(); ++i)
+  {
+    if (Dropout<>** dropout = boost::get<Dropout<>*>(&network[i]))
+    {
+      if (!(*dropout)->Rescale())
+        continue;
+    }
+    else if (DropConnect<>** dropConnect =
+        boost::get<DropConnect<>*>(&network[i]))
+    {
+      layers.push_back((*dropConnect)->Model().front());
+      continue;
+    }
+
+    layers.push_back(network[i]);
+  }
+
+  fusedNetwork.clear();
+  fusedEpilogues.clear();
+  fusedScales.clear();
+  for (size_t i = 0; i < layers.size(); ++i)
+  {
+    EpilogueFunction epilogue = NULL;
+    if (boost::get<Linear<>*>(&layers[i]) && i + 1 < layers.size())
+    {
+      if (boost::get<ReLULayer<>*>(&layers[i + 1]))
+        epilogue = &BiasActivation<RectifierFunction>;
+      else if (boost::get<SigmoidLayer<>*>(&layers[i + 1]))
+        epilogue = &BiasActivation<LogisticFunction>;
+      else if (boost::get<TanHLayer<>*>(&layers[i + 1]))
+        epilogue = &BiasActivation<TanhFunction>;
+      else if (boost::get<IdentityLayer<>*>(&layers[i + 1]))
+        epilogue = &BiasActivation<IdentityFunction>;
+    }
+
+    fusedNetwork.push_back(layers[i]);
+    fusedEpilogues.push_back(epilogue);
+    fusedScales.push_back(1.0);
+
+    // The activation layer is part of the fused step, and so is the scaling of
+    // a following Dropout module.
+    if (epilogue != NULL)
+    {
+      ++i;
+      Dropout<>** dropout = (i + 1 < layers.size()) ?
+          boost::get<Dropout<>*>(&layers[i + 1]) : NULL;
+      if (dropout != NULL)
+      {
+        fusedScales.back() = 1.0 / (1.0 - (*dropout)->Ratio());
+        ++i;
+      }
+    }
+  }
+
+  fusedLoss = std::is_same<OutputLayerType, NegativeLogLikelihood<> >::value &&
+      !fusedNetwork.empty() && boost::get<LogSoftMax<>*>(&fusedNetwork.back());
+  fusedSize = network.size();
+}
+
+template<typename OutputLayerType, typename InitializationRuleType>
+arma::mat& FFN<OutputLayerType, InitializationRuleType>::FusedForward(
+    arma::mat&& input, const bool skipLast)
+{
+  const size_t steps = fusedNetwork.size() - (skipLast ? 1 : 0);
+  if (steps == 0)
+  {
+    fusedBuffers[0] = input;
+    return fusedBuffers[0];
+  }
+
+  arma::mat* stepInput = &input;
+  for (size_t i = 0; i < steps; ++i)
+  {
+    arma::mat& output = fusedBuffers[i % 2];
+    if (fusedEpilogues[i] != NULL)
+    {
+      // The blocks of the output are finished while they are still in the
+      // cache, instead of in separate passes over the whole output.
+      const Linear<>& linear = *boost::get<Linear<>*>(fusedNetwork[i]);
+      const arma::mat& weight = linear.Weight();
+      output.set_size(weight.n_rows, stepInput->n_cols);
+
+      const size_t blockSize = std::max((size_t) 1,
+          (size_t) (32768 / weight.n_rows));
+      for (size_t begin = 0; begin < output.n_cols; begin += blockSize)
+      {
+        const size_t cols = std::min(blockSize, (size_t) output.n_cols - begin);
+        const arma::mat inputBlock(stepInput->colptr(begin), stepInput->n_rows,
+            cols, false, true);
+        arma::mat outputBlock(output.colptr(begin), output.n_rows, cols, false,
+            true);
+        outputBlock = weight * inputBlock;
+
+        fusedEpilogues[i](outputBlock.memptr(), output.n_rows, cols,
+            linear.Bias().memptr(), fusedScales[i]);
+      }
+    }
+    else
+    {
+      boost::apply_visitor(ForwardVisitor(std::move(*stepInput),
+          std::move(output)), fusedNetwork[i]);
+    }
+
+    stepInput = &output;
+  }
+
+  return *stepInput;
+}
+
+template<typename OutputLayerType, typename InitializationRuleType>
+double FFN<OutputLayerType, InitializationRuleType>::LogSoftMaxLoss(
+    const arma::mat& input, const arma::mat& target)
+{
+  // The negative of the log softmax of the target class, with the same
+  // approximation of the exponential as LogSoftMax.
+  double loss = 0;
+  for (size_t i = 0; i < input.n_cols; ++i)
+  {
+    const double* column = input.colptr(i);
+    const double maxInput = arma::max(input.col(i));
+
+    double sum = 0;
+    for (size_t j = 0; j < input.n_rows; ++j)
+      sum += LogSoftMax<>::ExpNegative(maxInput - column[j]);
+
+    const size_t currentTarget = target(i) - 1;
+    Log::Assert(currentTarget < input.n_rows, "Target class out of range.");
+    loss -= column[currentTarget] - (maxInput + std::log(sum));
+  }
+
+  return loss;
+}
+
+template<typename OutputLayerType, typename InitializationRuleType>
+template<typename ActivationFunction>
+void FFN<OutputLayerType, InitializationRuleType>::BiasActivation(
+    double* output,
+    const size_t rows,
+    const size_t cols,
+    const double* bias,
+    const double scale)
+{
+  for (size_t j = 0; j < cols; ++j, output += rows)
+    for (size_t i = 0; i < rows; ++i)
+      output[i] = scale * ActivationFunction::Fn(output[i] + bias[i]);
+}
+
+template<typename OutputLayerType, typename InitializationRuleType>
+void FFN<OutputLayerType, InitializationRuleType>::UseBuffers()
+{
+  const size_t outputRow = deterministic ? 2 : 0;
+  for (size_t i = 0; i < network.size(); ++i)
+  {
+    boost::apply_visitor(outputParameterVisitor, network[i]) =
+        arma::mat(arena.memptr() + bufferOffsets(outputRow, i),
+        bufferShapes(0, i), bufferShapes(1, i), false, false);
+
+    if (!deterministic && bufferShapes(2, i) * bufferShapes(3, i) > 0)
+    {
+      boost::apply_visitor(deltaVisitor, network[i]) =
+          arma::mat(arena.memptr() + bufferOffsets(1, i), bufferShapes(2, i),
+          bufferShapes(3, i), false, false);
+    }
+  }
+}
+
+template<typename OutputLayerType, typename InitializationRuleType>
+void FFN<OutputLayerType, InitializationRuleType>::PlanBuffers(
+    const size_t batchSize)
+{
+  // Keep the buffers aligned like the arena itself.
+  const size_t alignment = 8;
+  auto aligned = [alignment](const size_t n)
+  {
+    return ((n + alignment - 1) / alignment) * alignment;
+  };
+
+  bufferShapes.set_size(4, network.size());
+  bufferOffsets.set_size(3, network.size());
+
+  // The delta of a layer has the shape of its input.  The first layer doesn't
+  // compute its delta, so it doesn't get a buffer.
+  size_t maxOutputSize = 0;
+  for (size_t i = 0; i < network.size(); ++i)
+  {
+    const arma::mat& output = boost::apply_visitor(outputParameterVisitor,
+        network[i]);
+    bufferShapes(0, i) = output.n_rows;
+    bufferShapes(1, i) = output.n_cols;
+    bufferShapes(2, i) = (i == 0) ? 0 : bufferShapes(0, i - 1);
+    bufferShapes(3, i) = (i == 0) ? 0 : bufferShapes(1, i - 1);
+    maxOutputSize = std::max(maxOutputSize, (size_t) output.n_elem);
+  }
+
+  size_t offset = 0;
+  for (size_t i = 0; i < network.size(); ++i)
+  {
+    bufferOffsets(0, i) = offset;
+    offset += aligned(bufferShapes(0, i) * bufferShapes(1, i));
+  }
+  for (size_t i = 0; i < network.size(); ++i)
+  {
+    bufferOffsets(1, i) = offset;
+    offset += aligned(bufferShapes(2, i) * bufferShapes(3, i));
+  }
+  for (size_t i = 0; i < network.size(); ++i)
+    bufferOffsets(2, i) = (i % 2) * aligned(maxOutputSize);
+
+  // No layer points into the arena anymore (see ReleaseBuffers()), so it can
+  // be reallocated.
+  const size_t size = std::max(offset, 2 * aligned(maxOutputSize));
+  if (arena.n_elem < size)
+    arena.set_size(size);
+
+  plannedBatchSize = batchSize;
+}
+
+template<typename OutputLayerType, typename InitializationRuleType>
+void FFN<OutputLayerType, InitializationRuleType>::ReleaseBuffers()
+{
+  if (plannedBatchSize == 0)
+    return;
+
+  // Resetting a matrix that points into the arena leaves it empty, and it
+  // allocates its own memory the next time it is filled.
+  const double* begin = arena.memptr();
+  const double* end = arena.memptr() + arena.n_elem;
+  for (size_t i = 0; i < network.size(); ++i)
+  {
+    arma::mat& output = boost::apply_visitor(outputParameterVisitor,
+        network[i]);
+    if (output.memptr() >= begin && output.memptr() < end)
+      output.reset();
+
+    arma::mat& delta = boost::apply_visitor(deltaVisitor, network[i]);
+    if (delta.memptr() >= begin && delta.memptr() < end)
+      delta.reset();
+  }
+
+  plannedBatchSize = 0;
+}
+
+template<typename OutputLayerType, typename InitializationRuleType>
+void FFN<OutputLayerType, InitializationRuleType>::Forward(
+    std::vector<LayerTypes>& network,
+    arma::mat&& input,
+    bool& reset,
+    size_t& width,
+    size_t& height,
+    LayerProfiler* profiler)
+{
+  OutputParameterVisitor outputParameterVisitor;
+  OutputWidthVisitor outputWidthVisitor;
+  OutputHeightVisitor outputHeightVisitor;
+
+  if (profiler)
+    profiler->Start();
+
   boost::apply_visitor(ForwardVisitor(std::move(input), std::move(
       boost::apply_visitor(outputParameterVisitor, network.front()))),
       network.front());
 
+  if (profiler)
+  {
+    profiler->Stop(0, LayerProfiler::FORWARD, network.front(), input,
+        boost::apply_visitor(outputParameterVisitor, network.front()));
+  }
+
   if (!reset)
   {
     if (boost::apply_visitor(outputWidthVisitor, network.front()) != 0)
@@ -289,10 +1274,20 @@ void FFN<OutputLayerType, InitializationRuleType>::Forward(arma::mat&& input)
       boost::apply_visitor(SetInputHeightVisitor(height), network[i]);
     }
 
+    if (profiler)
+      profiler->Start();
+
     boost::apply_visitor(ForwardVisitor(std::move(boost::apply_visitor(
         outputParameterVisitor, network[i - 1])), std::move(
         boost::apply_visitor(outputParameterVisitor, network[i]))), network[i]);
 
+    if (profiler)
+    {
+      profiler->Stop(i, LayerProfiler::FORWARD, network[i],
+          boost::apply_visitor(outputParameterVisitor, network[i - 1]),
+          boost::apply_visitor(outputParameterVisitor, network[i]));
+    }
+
     if (!reset)
     {
       // Get the output width.
@@ -318,42 +1313,126 @@ void FFN<OutputLayerType, InitializationRuleType>::Forward(arma::mat&& input)
 template<typename OutputLayerType, typename InitializationRuleType>
 void FFN<OutputLayerType, InitializationRuleType>::Backward()
 {
+  if (checkpointed)
+    CheckpointedBackward();
+  else
+    Backward(network, error, profiler.Enabled() ? &profiler : NULL);
+}
+
+template<typename OutputLayerType, typename InitializationRuleType>
+void FFN<OutputLayerType, InitializationRuleType>::Backward(
+    std::vector<LayerTypes>& network,
+    arma::mat& error,
+    LayerProfiler* profiler)
+{
+  OutputParameterVisitor outputParameterVisitor;
+  DeltaVisitor deltaVisitor;
+
+  if (profiler)
+    profiler->Start();
+
   boost::apply_visitor(BackwardVisitor(std::move(boost::apply_visitor(
       outputParameterVisitor, network.back())), std::move(error), std::move(
       boost::apply_visitor(deltaVisitor, network.back()))), network.back());
 
+  if (profiler)
+  {
+    profiler->Stop(network.size() - 1, LayerProfiler::BACKWARD,
+        network.back(), error, boost::apply_visitor(deltaVisitor,
+        network.back()));
+  }
+
   for (size_t i = 2; i < network.size(); ++i)
   {
+    const size_t layer = network.size() - i;
+    if (profiler)
+      profiler->Start();
+
     boost::apply_visitor(BackwardVisitor(std::move(boost::apply_visitor(
-        outputParameterVisitor, network[network.size() - i])), std::move(
-        boost::apply_visitor(deltaVisitor, network[network.size() - i + 1])),
-        std::move(boost::apply_visitor(deltaVisitor,
-        network[network.size() - i]))), network[network.size() - i]);
+        outputParameterVisitor, network[layer])), std::move(
+        boost::apply_visitor(deltaVisitor, network[layer + 1])),
+        std::move(boost::apply_visitor(deltaVisitor, network[layer]))),
+        network[layer]);
+
+    if (profiler)
+    {
+      profiler->Stop(layer, LayerProfiler::BACKWARD, network[layer],
+          boost::apply_visitor(deltaVisitor, network[layer + 1]),
+          boost::apply_visitor(deltaVisitor, network[layer]));
+    }
   }
 }
 
 template<typename OutputLayerType, typename InitializationRuleType>
 void FFN<OutputLayerType, InitializationRuleType>::Gradient()
 {
-  boost::apply_visitor(GradientVisitor(std::move(currentInput), std::move(
+  // After a checkpointed forward pass, the gradients are computed by
+  // Backward(), segment by segment.
+  if (!checkpointed)
+  {
+    Gradient(network, currentInput, error,
+        profiler.Enabled() ? &profiler : NULL);
+  }
+}
+
+template<typename OutputLayerType, typename InitializationRuleType>
+void FFN<OutputLayerType, InitializationRuleType>::Gradient(
+    std::vector<LayerTypes>& network,
+    arma::mat& input,
+    arma::mat& error,
+    LayerProfiler* profiler)
+{
+  OutputParameterVisitor outputParameterVisitor;
+  DeltaVisitor deltaVisitor;
+
+  if (profiler)
+    profiler->Start();
+
+  boost::apply_visitor(GradientVisitor(std::move(input), std::move(
       boost::apply_visitor(deltaVisitor, network[1]))), network.front());
 
+  if (profiler)
+  {
+    profiler->Stop(0, LayerProfiler::GRADIENT, network.front(), input,
+        boost::apply_visitor(deltaVisitor, network[1]));
+  }
+
   for (size_t i = 1; i < network.size() - 1; ++i)
   {
+    if (profiler)
+      profiler->Start();
+
     boost::apply_visitor(GradientVisitor(std::move(boost::apply_visitor(
         outputParameterVisitor, network[i - 1])), std::move(
         boost::apply_visitor(deltaVisitor, network[i + 1]))), network[i]);
+
+    if (profiler)
+    {
+      profiler->Stop(i, LayerProfiler::GRADIENT, network[i],
+          boost::apply_visitor(outputParameterVisitor, network[i - 1]),
+          boost::apply_visitor(deltaVisitor, network[i + 1]));
+    }
   }
 
+  if (profiler)
+    profiler->Start();
+
   boost::apply_visitor(GradientVisitor(std::move(boost::apply_visitor(
       outputParameterVisitor, network[network.size() - 2])), std::move(error)),
       network[network.size() - 1]);
+
+  if (profiler)
+  {
+    profiler->Stop(network.size() - 1, LayerProfiler::GRADIENT,
+        network.back(), boost::apply_visitor(outputParameterVisitor,
+        network[network.size() - 2]), error);
+  }
 }
 
 template<typename OutputLayerType, typename InitializationRuleType>
 template<typename Archive>
 void FFN<OutputLayerType, InitializationRuleType>::Serialize(
-    Archive& ar, const unsigned int /* version */)
+    Archive& ar, const unsigned int version)
 {
   ar & data::CreateNVP(parameter, "parameter");
   ar & data::CreateNVP(width, "width");
@@ -365,6 +1444,17 @@ void FFN<OutputLayerType, InitializationRuleType>::Serialize(
   if (Archive::is_loading::value)
   {
     reset = false;
+    ReleaseBuffers();
+    replicaWorkspaces.clear();
+
+    // Before version 1 the LSTM layers laid out their parameters differently.
+    if (version == 0)
+    {
+      size_t offset = 0;
+      for (size_t i = 0; i < network.size(); ++i)
+        offset += boost::apply_visitor(LSTMLayoutVisitor(parameter, offset),
+            network[i]);
+    }
 
     size_t offset = 0;
     for (size_t i = 0; i < network.size(); ++i)
@@ -380,6 +1470,13 @@ void FFN<OutputLayerType, InitializationRuleType>::Serialize(
 template<typename OutputLayerType, typename InitializationRuleType>
 void FFN<OutputLayerType, InitializationRuleType>::Swap(FFN& network)
 {
+  // The arenas stay with their networks, so the layers are detached from them.
+  // The replicas are created for their networks, so they are dropped.
+  ReleaseBuffers();
+  network.ReleaseBuffers();
+  replicaWorkspaces.clear();
+  network.replicaWorkspaces.clear();
+
   std::swap(outputLayer, network.outputLayer);
   std::swap(initializeRule, network.initializeRule);
   std::swap(width, network.width);
@@ -398,6 +1495,15 @@ void FFN<OutputLayerType, InitializationRuleType>::Swap(FFN& network)
   std::swap(inputParameter, network.inputParameter);
   std::swap(outputParameter, network.outputParameter);
   std::swap(gradient, network.gradient);
+  std::swap(replicas, network.replicas);
+  std::swap(checkpointInterval, network.checkpointInterval);
+
+  // The fused plans are made again for the swapped layers, and the next
+  // backward passes follow new forward passes.
+  fusedSize = 0;
+  network.fusedSize = 0;
+  checkpointed = false;
+  network.checkpointed = false;
 };
 
 template<typename OutputLayerType, typename InitializationRuleType>
@@ -419,7 +1525,16 @@ FFN<OutputLayerType, InitializationRuleType>::FFN(
     delta(network.delta),
     inputParameter(network.inputParameter),
     outputParameter(network.outputParameter),
-    gradient(network.gradient)
+    gradient(network.gradient),
+    plannedBatchSize(0),
+    replicas(network.replicas),
+    replicaParameters(NULL),
+    fusedSize(0),
+    fusedLoss(false),
+    mergedLoss(false),
+    checkpointInterval(network.checkpointInterval),
+    checkpointed(false),
+    checkpointEndCounter(0)
 {
   // Build new layers according to source network
   for (size_t i = 0; i < network.network.size(); ++i)
@@ -448,8 +1563,21 @@ FFN<OutputLayerType, InitializationRuleType>::FFN(
     delta(std::move(network.delta)),
     inputParameter(std::move(network.inputParameter)),
     outputParameter(std::move(network.outputParameter)),
-    gradient(std::move(network.gradient))
+    gradient(std::move(network.gradient)),
+    plannedBatchSize(0),
+    replicas(network.replicas),
+    replicaParameters(NULL),
+    fusedSize(0),
+    fusedLoss(false),
+    mergedLoss(false),
+    checkpointInterval(network.checkpointInterval),
+    checkpointed(false),
+    checkpointEndCounter(0)
 {
+  // The layers must not point into the arena of the other network, and the
+  // replicas of the other network belong to it.
+  network.ReleaseBuffers();
+  network.replicaWorkspaces.clear();
   this->network = std::move(network.network);
 };
 
@@ -14,6 +14,7 @@
 #define MLPACK_METHODS_ANN_LAYER_BASE_LAYER_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <mlpack/methods/ann/layer/layer_traits.hpp>
 #include <mlpack/methods/ann/activation_functions/logistic_function.hpp>
 #include <mlpack/methods/ann/activation_functions/identity_function.hpp>
 #include <mlpack/methods/ann/activation_functions/rectifier_function.hpp>
@@ -168,6 +169,16 @@ template <
 using TanHLayer = BaseLayer<
     ActivationFunction, InputDataType, OutputDataType>;
 
+//! Activation layers can process a batch of points at once.
+template<
+    class ActivationFunction,
+    typename InputDataType,
+    typename OutputDataType
+>
+class LayerTraits<BaseLayer<ActivationFunction, InputDataType,
+    OutputDataType> > : public BatchLayerTraits
+{ };
+
 } // namespace ann
 } // namespace mlpack
 
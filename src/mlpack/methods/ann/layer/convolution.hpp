@@ -18,6 +18,9 @@
 #include <mlpack/methods/ann/convolution_rules/naive_convolution.hpp>
 #include <mlpack/methods/ann/convolution_rules/fft_convolution.hpp>
 #include <mlpack/methods/ann/convolution_rules/svd_convolution.hpp>
+#include <mlpack/methods/ann/convolution_rules/im2col_convolution.hpp>
+#include <mlpack/methods/ann/convolution_rules/planned_fft_convolution.hpp>
+#include <mlpack/methods/ann/convolution_rules/convolution_rule_traits.hpp>
 
 #include "layer_types.hpp"
 
@@ -28,6 +31,11 @@ namespace ann /** Artificial Neural Network. */ {
  * Implementation of the Convolution class. The Convolution class represents a
  * single layer of a neural network.
  *
+ * The convolution rules are called for every pair of input and output maps,
+ * unless ConvolutionRuleTraits says that they lower all the maps into one
+ * matrix product (like Im2ColConvolution), in which case each of the forward
+ * pass, the backward pass and the gradient convolves all the maps at once.
+ *
  * @tparam ForwardConvolutionRule Convolution to perform forward process.
  * @tparam BackwardConvolutionRule Convolution to perform backward process.
  * @tparam GradientConvolutionRule Convolution to calculate gradient.
@@ -161,6 +169,23 @@ class Convolution
   //! Modify the output height.
   size_t& OutputHeight() { return outputHeight; }
 
+  //! Get the number of input maps.
+  size_t InputSize() const { return inSize; }
+  //! Get the number of output maps.
+  size_t OutputSize() const { return outSize; }
+  //! Get the filter width.
+  size_t KernelWidth() const { return kW; }
+  //! Get the filter height.
+  size_t KernelHeight() const { return kH; }
+  //! Get the stride in x-direction.
+  size_t StrideWidth() const { return dW; }
+  //! Get the stride in y-direction.
+  size_t StrideHeight() const { return dH; }
+  //! Get the padding width.
+  size_t PadWidth() const { return padW; }
+  //! Get the padding height.
+  size_t PadHeight() const { return padH; }
+
   /**
    * Serialize the layer
    */
@@ -185,6 +210,73 @@ class Convolution
     return std::floor(size + p * 2 - k) / s + 1;
   }
 
+  /*
+   * Convolve the input maps with the filters into outputTemp, one pair of
+   * input and output maps at a time.
+   *
+   * @param input The (padded) input maps.
+   * @param wConv The width of the output maps.
+   * @param hConv The height of the output maps.
+   */
+  template<typename eT, typename Rule = ForwardConvolutionRule>
+  typename std::enable_if<!ConvolutionRuleTraits<Rule>::LowersMaps>::type
+  ForwardMaps(const arma::Cube<eT>& input,
+              const size_t wConv,
+              const size_t hConv);
+
+  /*
+   * Convolve all the input maps with the filters into outputTemp at once.
+   *
+   * @param input The (padded) input maps.
+   * @param wConv The width of the output maps.
+   * @param hConv The height of the output maps.
+   */
+  template<typename eT, typename Rule = ForwardConvolutionRule>
+  typename std::enable_if<ConvolutionRuleTraits<Rule>::LowersMaps>::type
+  ForwardMaps(const arma::Cube<eT>& input,
+              const size_t wConv,
+              const size_t hConv);
+
+  /*
+   * Backpropagate the error of the output maps into gTemp, one pair of input
+   * and output maps at a time.
+   *
+   * @param mappedError The error of the output maps.
+   */
+  template<typename eT, typename Rule = BackwardConvolutionRule>
+  typename std::enable_if<!ConvolutionRuleTraits<Rule>::LowersMaps>::type
+  BackwardMaps(const arma::Cube<eT>& mappedError);
+
+  /*
+   * Backpropagate the error of the output maps into gTemp at once.
+   *
+   * @param mappedError The error of the output maps.
+   */
+  template<typename eT, typename Rule = BackwardConvolutionRule>
+  typename std::enable_if<ConvolutionRuleTraits<Rule>::LowersMaps>::type
+  BackwardMaps(const arma::Cube<eT>& mappedError);
+
+  /*
+   * Calculate the gradient of the filters and the bias, one pair of input and
+   * output maps at a time.
+   *
+   * @param error The calculated error.
+   * @param gradient The calculated gradient.
+   */
+  template<typename eT, typename Rule = GradientConvolutionRule>
+  typename std::enable_if<!ConvolutionRuleTraits<Rule>::LowersMaps>::type
+  GradientMaps(arma::Mat<eT>& error, arma::Mat<eT>& gradient);
+
+  /*
+   * Calculate the gradient of the filters and the bias at once.
+   *
+   * @param error The calculated error.
+   * @param gradient The calculated gradient.
+   */
+  template<typename eT, typename Rule = GradientConvolutionRule>
+  typename std::enable_if<ConvolutionRuleTraits<Rule>::LowersMaps>::type
+  GradientMaps(arma::Mat<eT>& error, arma::Mat<eT>& gradient);
+
   /*
    * Rotates a 3rd-order tensor counterclockwise by 180 degrees.
    *
@@ -309,6 +401,9 @@ class Convolution
   //! Locally-stored transformed output parameter.
   arma::cube outputTemp;
 
+  //! Locally-stored forward convolution rule, for rules that keep state.
+  ForwardConvolutionRule forwardRule;
+
   //! Locally-stored transformed input parameter.
   arma::cube inputTemp;
 
@@ -123,30 +123,13 @@ void Convolution<
   size_t wConv = ConvOutSize(inputWidth, kW, dW, padW);
   size_t hConv = ConvOutSize(inputHeight, kH, dH, padH);
 
-  outputTemp = arma::zeros<arma::Cube<eT> >(wConv, hConv, outSize);
-
-  for (size_t outMap = 0, outMapIdx = 0; outMap < outSize; outMap++)
-  {
-    for (size_t inMap = 0; inMap < inSize; inMap++, outMapIdx++)
-    {
-      arma::Mat<eT> convOutput;
-
-      if (padW != 0 || padH != 0)
-      {
-        ForwardConvolutionRule::Convolution(inputPaddedTemp.slice(inMap),
-            weight.slice(outMapIdx), convOutput, dW, dH);
-      }
-      else
-      {
-        ForwardConvolutionRule::Convolution(inputTemp.slice(inMap),
-            weight.slice(outMapIdx), convOutput, dW, dH);
-      }
-
-      outputTemp.slice(outMap) += convOutput;
-    }
+  if (padW != 0 || padH != 0)
+    ForwardMaps(inputPaddedTemp, wConv, hConv);
+  else
+    ForwardMaps(inputTemp, wConv, hConv);
 
+  for (size_t outMap = 0; outMap < outSize; outMap++)
     outputTemp.slice(outMap) += bias(outMap);
-  }
 
   output = arma::Mat<eT>(outputTemp.memptr(), outputTemp.n_elem, 1);
 
@@ -173,6 +156,107 @@ void Convolution<
 {
   arma::cube mappedError = arma::cube(gy.memptr(),
         outputWidth, outputHeight, outSize);
+  BackwardMaps(mappedError);
+
+  g = arma::mat(gTemp.memptr(), gTemp.n_elem, 1);
+}
+
+template<
+    typename ForwardConvolutionRule,
+    typename BackwardConvolutionRule,
+    typename GradientConvolutionRule,
+    typename InputDataType,
+    typename OutputDataType
+>
+template<typename eT>
+void Convolution<
+    ForwardConvolutionRule,
+    BackwardConvolutionRule,
+    GradientConvolutionRule,
+    InputDataType,
+    OutputDataType
+>::Gradient(
+    const arma::Mat<eT>&& /* input */,
+    arma::Mat<eT>&& error,
+    arma::Mat<eT>&& gradient)
+{
+  GradientMaps(error, gradient);
+}
+
+template<
+    typename ForwardConvolutionRule,
+    typename BackwardConvolutionRule,
+    typename GradientConvolutionRule,
+    typename InputDataType,
+    typename OutputDataType
+>
+template<typename eT, typename Rule>
+typename std::enable_if<!ConvolutionRuleTraits<Rule>::LowersMaps>::type
+Convolution<
+    ForwardConvolutionRule,
+    BackwardConvolutionRule,
+    GradientConvolutionRule,
+    InputDataType,
+    OutputDataType
+>::ForwardMaps(
+    const arma::Cube<eT>& input, const size_t wConv, const size_t hConv)
+{
+  outputTemp = arma::zeros<arma::Cube<eT> >(wConv, hConv, outSize);
+
+  for (size_t outMap = 0, outMapIdx = 0; outMap < outSize; outMap++)
+  {
+    for (size_t inMap = 0; inMap < inSize; inMap++, outMapIdx++)
+    {
+      arma::Mat<eT> convOutput;
+      ForwardConvolutionRule::Convolution(input.slice(inMap),
+          weight.slice(outMapIdx), convOutput, dW, dH);
+
+      outputTemp.slice(outMap) += convOutput;
+    }
+  }
+}
+
+template<
+    typename ForwardConvolutionRule,
+    typename BackwardConvolutionRule,
+    typename GradientConvolutionRule,
+    typename InputDataType,
+    typename OutputDataType
+>
+template<typename eT, typename Rule>
+typename std::enable_if<ConvolutionRuleTraits<Rule>::LowersMaps>::type
+Convolution<
+    ForwardConvolutionRule,
+    BackwardConvolutionRule,
+    GradientConvolutionRule,
+    InputDataType,
+    OutputDataType
+>::ForwardMaps(
+    const arma::Cube<eT>& input,
+    const size_t /* wConv */,
+    const size_t /* hConv */)
+{
+  forwardRule.MapsConvolution(input, weight, outputTemp, dW, dH);
+}
+
+template<
+    typename ForwardConvolutionRule,
+    typename BackwardConvolutionRule,
+    typename GradientConvolutionRule,
+    typename InputDataType,
+    typename OutputDataType
+>
+template<typename eT, typename Rule>
+typename std::enable_if<!ConvolutionRuleTraits<Rule>::LowersMaps>::type
+Convolution<
+    ForwardConvolutionRule,
+    BackwardConvolutionRule,
+    GradientConvolutionRule,
+    InputDataType,
+    OutputDataType
+>::BackwardMaps(
+    const arma::Cube<eT>& mappedError)
+{
   gTemp = arma::zeros<arma::Cube<eT> >(inputTemp.n_rows,
       inputTemp.n_cols, inputTemp.n_slices);
 
@@ -200,8 +284,41 @@ void Convolution<
       }
     }
   }
+}
 
-  g = arma::mat(gTemp.memptr(), gTemp.n_elem, 1);
+template<
+    typename ForwardConvolutionRule,
+    typename BackwardConvolutionRule,
+    typename GradientConvolutionRule,
+    typename InputDataType,
+    typename OutputDataType
+>
+template<typename eT, typename Rule>
+typename std::enable_if<ConvolutionRuleTraits<Rule>::LowersMaps>::type
+Convolution<
+    ForwardConvolutionRule,
+    BackwardConvolutionRule,
+    GradientConvolutionRule,
+    InputDataType,
+    OutputDataType
+>::BackwardMaps(
+    const arma::Cube<eT>& mappedError)
+{
+  if (padW != 0 || padH != 0)
+  {
+    // Backpropagate to the padded input, and drop the padding.
+    arma::Cube<eT> paddedError(inputPaddedTemp.n_rows,
+        inputPaddedTemp.n_cols, inputPaddedTemp.n_slices);
+    Rule::MapsBackward(mappedError, weight, paddedError, dW, dH);
+
+    gTemp = paddedError.tube(padW, padH, padW + inputTemp.n_rows - 1,
+        padH + inputTemp.n_cols - 1);
+  }
+  else
+  {
+    gTemp.set_size(inputTemp.n_rows, inputTemp.n_cols, inputTemp.n_slices);
+    Rule::MapsBackward(mappedError, weight, gTemp, dW, dH);
+  }
 }
 
 template<
@@ -211,17 +328,16 @@ template<
     typename InputDataType,
     typename OutputDataType
 >
-template<typename eT>
-void Convolution<
+template<typename eT, typename Rule>
+typename std::enable_if<!ConvolutionRuleTraits<Rule>::LowersMaps>::type
+Convolution<
     ForwardConvolutionRule,
     BackwardConvolutionRule,
     GradientConvolutionRule,
     InputDataType,
     OutputDataType
->::Gradient(
-    const arma::Mat<eT>&& /* input */,
-    arma::Mat<eT>&& error,
-    arma::Mat<eT>&& gradient)
+>::GradientMaps(
+    arma::Mat<eT>& error, arma::Mat<eT>& gradient)
 {
   arma::cube mappedError;
   if (padW != 0 && padH != 0)
@@ -291,6 +407,47 @@ void Convolution<
       gradientTemp.memptr(), gradientTemp.n_elem, 1, false, false);
 }
 
+template<
+    typename ForwardConvolutionRule,
+    typename BackwardConvolutionRule,
+    typename GradientConvolutionRule,
+    typename InputDataType,
+    typename OutputDataType
+>
+template<typename eT, typename Rule>
+typename std::enable_if<ConvolutionRuleTraits<Rule>::LowersMaps>::type
+Convolution<
+    ForwardConvolutionRule,
+    BackwardConvolutionRule,
+    GradientConvolutionRule,
+    InputDataType,
+    OutputDataType
+>::GradientMaps(
+    arma::Mat<eT>& error, arma::Mat<eT>& gradient)
+{
+  const arma::Cube<eT> mappedError(error.memptr(), outputWidth, outputHeight,
+      outSize, false, true);
+
+  if (padW != 0 || padH != 0)
+  {
+    Rule::MapsGradient(inputPaddedTemp, mappedError, kW, kH, dW, dH,
+        gradientTemp);
+  }
+  else
+  {
+    Rule::MapsGradient(inputTemp, mappedError, kW, kH, dW, dH, gradientTemp);
+  }
+
+  for (size_t outMap = 0; outMap < outSize; outMap++)
+  {
+    gradient.submat(weight.n_elem + outMap, 0,
+        weight.n_elem + outMap, 0) = arma::accu(mappedError.slice(outMap));
+  }
+
+  gradient.submat(0, 0, weight.n_elem - 1, 0) = arma::Mat<eT>(
+      gradientTemp.memptr(), gradientTemp.n_elem, 1, false, false);
+}
+
 template<
     typename ForwardConvolutionRule,
     typename BackwardConvolutionRule,
@@ -15,6 +15,7 @@
 #define MLPACK_METHODS_ANN_LAYER_DROPCONNECT_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <mlpack/core/math/random.hpp>
 
 #include "layer_types.hpp"
 #include "add_merge.hpp"
@@ -71,7 +71,8 @@ void DropConnect<InputDataType, OutputDataType>::Forward(
 
     // Scale with input / (1 - ratio) and set values to zero with
     // probability ratio.
-    mask = arma::randu<arma::Mat<eT> >(denoise.n_rows, denoise.n_cols);
+    mask.set_size(denoise.n_rows, denoise.n_cols);
+    math::ThreadRandomStream().Randu(mask);
     mask.transform([&](double val) { return (val > ratio); });
 
     boost::apply_visitor(ParametersSetVisitor(std::move(denoise % mask)),
@@ -14,6 +14,9 @@
 #define MLPACK_METHODS_ANN_LAYER_DROPOUT_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <mlpack/core/math/random.hpp>
+
+#include "layer_traits.hpp"
 
 namespace mlpack {
 namespace ann /** Artificial Neural Network. */ {
@@ -151,6 +154,12 @@ class Dropout
   bool rescale;
 }; // class Dropout
 
+//! Dropout layers can process a batch of points at once.
+template<typename InputDataType, typename OutputDataType>
+class LayerTraits<Dropout<InputDataType, OutputDataType> > :
+    public BatchLayerTraits
+{ };
+
 } // namespace ann
 } // namespace mlpack
 
@@ -28,6 +28,8 @@
 
 #include <mlpack/prereqs.hpp>
 
+#include "layer_traits.hpp"
+
 namespace mlpack {
 namespace ann /** Artificial Neural Network. */ {
 
@@ -191,6 +193,12 @@ class ELU
   double alpha;
 }; // class ELU
 
+//! ELU layers can process a batch of points at once.
+template<typename InputDataType, typename OutputDataType>
+class LayerTraits<ELU<InputDataType, OutputDataType> > :
+    public BatchLayerTraits
+{ };
+
 } // namespace ann
 } // namespace mlpack
 
@@ -70,6 +70,21 @@ class MeanPoolingRule
  * (down-scaled cropped images) of increasing scale around a given location in a
  * given image.
  *
+ * The input is either one image and its location, as a matrix whose first
+ * column is the image and whose second column starts with the x and y
+ * coordinates of the location (in [-1, 1]), or a batch of points, one per
+ * column, each holding an image followed by its location.  The output holds
+ * one glimpse per point: depth patches of size x size for each of the inSize
+ * channels of the image, each patch being a crop around the location,
+ * averaged (scale 2) or resampled down to the glimpse size.
+ *
+ * Since the pixels each element of a patch is computed from only depend on
+ * the corner of the crop, they are computed once as index maps, and the
+ * glimpses of a batch are gathered in one pass over its points, without
+ * padding the images.  The backward pass scatters the error with the same
+ * maps; the locations get no gradient, as they are trained by a REINFORCE
+ * module.
+ *
  * @tparam InputDataType Type of the input data (arma::colvec, arma::mat,
  *         arma::sp_mat or arma::cube).
  * @tparam OutputDataType Type of the output data (arma::colvec, arma::mat,
@@ -176,190 +191,29 @@ class Glimpse
   void Serialize(Archive& ar, const unsigned int /* version */);
 
  private:
-  /*
-   * Transform the given input by changing rows to columns.
-   *
-   * @param w The input matrix used to perform the transformation.
-   */
-  void Transform(arma::mat& w)
-  {
-    arma::mat t = w;
-
-    for (size_t i = 0, k = 0; i < w.n_elem; k++)
-    {
-      for (size_t j = 0; j < w.n_cols; j++, i++)
-      {
-        w(k, j) = t(i);
-      }
-    }
-  }
-
-  /*
-   * Transform the given input by changing rows to columns.
-   *
-   * @param w The input matrix used to perform the transformation.
-   */
-  void Transform(arma::cube& w)
-  {
-    for (size_t i = 0; i < w.n_slices; i++)
-    {
-      arma::mat t = w.slice(i);
-      Transform(t);
-      w.slice(i) = t;
-    }
-  }
-
   /**
-   * Apply pooling to the input and store the results to the output parameter.
-   *
-   * @param kSize the kernel size used to perform the pooling operation.
-   * @param input The input to be apply the pooling rule.
-   * @param output The pooled result.
+   * Build the index maps of the glimpses: for each patch and each element of
+   * the glimpse, the pixels of the patch it is computed from (relative to the
+   * corner of the patch), and their weights.
    */
-  template<typename eT>
-  void Pooling(const size_t kSize,
-               const arma::Mat<eT>& input,
-               arma::Mat<eT>& output)
-  {
-    const size_t rStep = kSize;
-    const size_t cStep = kSize;
-
-    for (size_t j = 0; j < input.n_cols; j += cStep)
-    {
-      for (size_t i = 0; i < input.n_rows; i += rStep)
-      {
-        output(i / rStep, j / cStep) += pooling.Pooling(
-            input(arma::span(i, i + rStep - 1), arma::span(j, j + cStep - 1)));
-      }
-    }
-  }
+  void BuildMaps();
 
   /**
-   * Apply unpooling to the input and store the results.
+   * Compute the corner of the given patch of the glimpse at the given
+   * location, in coordinates of the (unpadded) image; the corner may be
+   * outside the image.
    *
-   * @param input The input to be apply the unpooling rule.
-   * @param error The error used to perform the unpooling operation.
-   * @param output The pooled result.
+   * @param x Row coordinate of the location, in [-1, 1].
+   * @param y Column coordinate of the location, in [-1, 1].
+   * @param patch Index of the patch.
+   * @param row The row of the corner.
+   * @param col The column of the corner.
    */
-  template<typename eT>
-  void Unpooling(const arma::Mat<eT>& input,
-                 const arma::Mat<eT>& error,
-                 arma::Mat<eT>& output)
-  {
-    const size_t rStep = input.n_rows / error.n_rows;
-    const size_t cStep = input.n_cols / error.n_cols;
-
-    arma::Mat<eT> unpooledError;
-    for (size_t j = 0; j < input.n_cols; j += cStep)
-    {
-      for (size_t i = 0; i < input.n_rows; i += rStep)
-      {
-        const arma::Mat<eT>& inputArea = input(arma::span(i, i + rStep - 1),
-                                               arma::span(j, j + cStep - 1));
-
-        pooling.Unpooling(inputArea, error(i / rStep, j / cStep),
-            unpooledError);
-
-        output(arma::span(i, i + rStep - 1),
-            arma::span(j, j + cStep - 1)) += unpooledError;
-      }
-    }
-  }
-
-  /**
-   * Apply ReSampling to the input and store the results in the output
-   * parameter.
-   *
-   * @param input The input to be apply the ReSampling rule.
-   * @param output The pooled result.
-   */
-  template<typename eT>
-  void ReSampling(const arma::Mat<eT>& input, arma::Mat<eT>& output)
-  {
-    double wRatio = (double) (input.n_rows - 1) / (size - 1);
-    double hRatio = (double) (input.n_cols - 1) / (size - 1);
-
-    double iWidth = input.n_rows - 1;
-    double iHeight = input.n_cols - 1;
-
-    for (size_t y = 0; y < size; y++)
-    {
-      for (size_t x = 0; x < size; x++)
-      {
-        double ix = wRatio * x;
-        double iy = hRatio * y;
-
-        // Get the 4 nearest neighbors.
-        double ixNw = std::floor(ix);
-        double iyNw = std::floor(iy);
-        double ixNe = ixNw + 1;
-        double iySw = iyNw + 1;
-
-        // Get surfaces to each neighbor.
-        double se = (ix - ixNw) * (iy - iyNw);
-        double sw = (ixNe - ix) * (iy - iyNw);
-        double ne = (ix - ixNw) * (iySw - iy);
-        double nw = (ixNe - ix) * (iySw - iy);
-
-        // Calculate the weighted sum.
-        output(y, x) = input(iyNw, ixNw) * nw +
-            input(iyNw, std::min(ixNe,  iWidth)) * ne +
-            input(std::min(iySw, iHeight), ixNw) * sw +
-            input(std::min(iySw, iHeight), std::min(ixNe, iWidth)) * se;
-      }
-    }
-  }
-
-  /**
-   * Apply DownwardReSampling to the input and store the results into the output
-   * parameter.
-   *
-   * @param input The input to be apply the DownwardReSampling rule.
-   * @param error The error used to perform the DownwardReSampling operation.
-   * @param output The DownwardReSampled result.
-   */
-  template<typename eT>
-  void DownwardReSampling(const arma::Mat<eT>& input,
-                          const arma::Mat<eT>& error,
-                          arma::Mat<eT>& output)
-  {
-    double iWidth = input.n_rows - 1;
-    double iHeight = input.n_cols - 1;
-
-    double wRatio = iWidth / (size - 1);
-    double hRatio = iHeight / (size - 1);
-
-    for (size_t y = 0; y < size; y++)
-    {
-      for (size_t x = 0; x < size; x++)
-      {
-        double ix = wRatio * x;
-        double iy = hRatio * y;
-
-        // Get the 4 nearest neighbors.
-        double ixNw = std::floor(ix);
-        double iyNw = std::floor(iy);
-        double ixNe = ixNw + 1;
-        double iySw = iyNw + 1;
-
-        // Get surfaces to each neighbor.
-        double se = (ix - ixNw) * (iy - iyNw);
-        double sw = (ixNe - ix) * (iy - iyNw);
-        double ne = (ix - ixNw) * (iySw - iy);
-        double nw = (ixNe - ix) * (iySw - iy);
-
-        double ograd = error(y, x);
-
-        output(iyNw, ixNw) = output(iyNw, ixNw) + nw * ograd;
-        output(iyNw, std::min(ixNe, iWidth)) = output(iyNw,
-            std::min(ixNe, iWidth)) + ne * ograd;
-        output(std::min(iySw, iHeight), ixNw) = output(std::min(iySw, iHeight),
-            ixNw) + sw * ograd;
-        output(std::min(iySw, iHeight), std::min(ixNe, iWidth)) = output(
-            std::min(iySw, iHeight), std::min(ixNe, iWidth)) + se * ograd;
-      }
-    }
-  }
+  void Corner(const double x,
+              const double y,
+              const size_t patch,
+              ptrdiff_t& row,
+              ptrdiff_t& col) const;
 
   //! The size of the input units.
   size_t inSize;
@@ -394,26 +248,40 @@ class Glimpse
   //! Locally-stored output parameter object.
   OutputDataType outputParameter;
 
-  //! Locally-stored depth of the input.
-  size_t inputDepth;
+  //! Locally-stored number of rows of the input.
+  size_t inputRows;
 
-  //! Locally-stored transformed input parameter.
-  arma::cube inputTemp;
+  //! Locally-stored number of columns of the input.
+  size_t inputCols;
 
-  //! Locally-stored transformed output parameter.
-  arma::cube outputTemp;
-
-  //! The x and y coordinate of the center of the output glimpse.
+  //! The x and y coordinate of the center of the output glimpse (one column
+  //! per point).
   arma::mat location;
 
-  //! Locally-stored object to perform the mean pooling operation.
-  MeanPoolingRule pooling;
-
   //! Location-stored module location parameter.
   std::vector<arma::mat> locationParameter;
 
-  //! Location-stored transformed gradient paramter.
-  arma::cube gTemp;
+  //! The input width the index maps were built for.
+  size_t mapWidth;
+
+  //! The size of each patch before it is scaled down.
+  std::vector<size_t> patchSize;
+
+  //! The start of the map entries of each element of each patch.
+  std::vector<size_t> mapStart;
+
+  //! The row of the pixel of each map entry, relative to the corner.
+  std::vector<size_t> mapRow;
+
+  //! The column of the pixel of each map entry, relative to the corner.
+  std::vector<size_t> mapCol;
+
+  //! The offset of the pixel of each map entry in an image, relative to the
+  //! corner.
+  std::vector<size_t> mapOffset;
+
+  //! The weight of each map entry.
+  std::vector<double> mapWeight;
 
   //! If true use maximum a posteriori during the forward pass.
   bool deterministic;
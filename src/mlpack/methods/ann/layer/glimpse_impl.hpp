@@ -28,7 +28,13 @@ Glimpse<InputDataType, OutputDataType>::Glimpse(
     depth(depth),
     scale(scale),
     inputWidth(inputWidth),
-    inputHeight(inputHeight)
+    inputHeight(inputHeight),
+    outputWidth(0),
+    outputHeight(0),
+    inputRows(0),
+    inputCols(0),
+    mapWidth(0),
+    deterministic(false)
 {
   // Nothing to do here.
 }
@@ -38,83 +44,78 @@ template<typename eT>
 void Glimpse<InputDataType, OutputDataType>::Forward(
     const arma::Mat<eT>&& input, arma::Mat<eT>&& output)
 {
-  inputTemp = arma::cube(input.colptr(0), inputWidth, inputHeight, inSize);
-  outputTemp = arma::Cube<eT>(size, size, depth * inputTemp.n_slices);
+  if (mapStart.empty() || mapWidth != inputWidth)
+    BuildMaps();
 
-  location = input.submat(0, 1, 1, 1);
+  // A single image holds its location in the second column, and the points of
+  // a batch hold it after the image.
+  const size_t imageSize = inputWidth * inputHeight;
+  const size_t channelsSize = imageSize * inSize;
+  if (input.n_rows == channelsSize)
+    location = input.submat(0, 1, 1, 1);
+  else
+    location = input.rows(channelsSize, channelsSize + 1);
+
+  inputRows = input.n_rows;
+  inputCols = input.n_cols;
 
   if (!deterministic)
   {
     locationParameter.push_back(location);
   }
 
-  inputDepth = inputTemp.n_slices / inSize;
-
-  for (size_t inputIdx = 0; inputIdx < inSize; inputIdx++)
+  const size_t patchElements = size * size;
+  output.set_size(patchElements * depth * inSize, location.n_cols);
+  for (size_t n = 0; n < location.n_cols; ++n)
   {
-    for (size_t depthIdx = 0, glimpseSize = size;
-        depthIdx < depth; depthIdx++, glimpseSize *= scale)
+    const eT* image = input.colptr(n);
+    eT* glimpse = output.colptr(n);
+    for (size_t d = 0; d < depth; ++d)
     {
-      size_t padSize = std::floor((glimpseSize - 1) / 2);
-
-      arma::Cube<eT> inputPadded = arma::zeros<arma::Cube<eT> >(
-          inputTemp.n_rows + padSize * 2, inputTemp.n_cols + padSize * 2,
-          inputTemp.n_slices / inSize);
-
-      inputPadded.tube(padSize, padSize, padSize + inputTemp.n_rows - 1,
-          padSize + inputTemp.n_cols - 1) = inputTemp.subcube(0, 0,
-          inputIdx * inputDepth, inputTemp.n_rows - 1, inputTemp.n_cols - 1,
-          (inputIdx + 1) * inputDepth - 1);
+      ptrdiff_t row, col;
+      Corner(location(0, n), location(1, n), d, row, col);
 
-      size_t h = inputPadded.n_rows - glimpseSize;
-      size_t w = inputPadded.n_cols - glimpseSize;
+      // Only the crops that stick out of the image need bounds checks.
+      const bool inside = (row >= 0) && (col >= 0) &&
+          (row + (ptrdiff_t) patchSize[d] <= (ptrdiff_t) inputWidth) &&
+          (col + (ptrdiff_t) patchSize[d] <= (ptrdiff_t) inputHeight);
 
-      size_t x = std::min(h, (size_t) std::max(0.0,
-          (location(0, inputIdx) + 1) / 2.0 * h));
-      size_t y = std::min(w, (size_t) std::max(0.0,
-          (location(1, inputIdx) + 1) / 2.0 * w));
-
-      if (depthIdx == 0)
+      const size_t* start = &mapStart[d * patchElements];
+      for (size_t c = 0; c < inSize; ++c)
       {
-        for (size_t j = (inputIdx + depthIdx), paddedSlice = 0;
-            j < outputTemp.n_slices; j += (inSize * depth), paddedSlice++)
+        const eT* channel = image + c * imageSize;
+        eT* patch = glimpse + (d * inSize + c) * patchElements;
+        for (size_t e = 0; e < patchElements; ++e)
         {
-          outputTemp.slice(j) = inputPadded.subcube(x, y,
-              paddedSlice, x + glimpseSize - 1, y + glimpseSize - 1,
-              paddedSlice);
-        }
-      }
-      else
-      {
-        for (size_t j = (inputIdx + depthIdx * (depth - 1)), paddedSlice = 0;
-            j < outputTemp.n_slices; j += (inSize * depth), paddedSlice++)
-        {
-          arma::Mat<eT> poolingInput = inputPadded.subcube(x, y,
-              paddedSlice, x + glimpseSize - 1, y + glimpseSize - 1,
-              paddedSlice);
-
-          if (scale == 2)
+          eT value = 0;
+          if (inside)
           {
-            Pooling(glimpseSize / size, poolingInput, outputTemp.slice(j));
+            const eT* corner = channel + row + col * inputWidth;
+            for (size_t k = start[e]; k < start[e + 1]; ++k)
+              value += mapWeight[k] * corner[mapOffset[k]];
           }
           else
           {
-            ReSampling(poolingInput, outputTemp.slice(j));
+            for (size_t k = start[e]; k < start[e + 1]; ++k)
+            {
+              const ptrdiff_t r = row + (ptrdiff_t) mapRow[k];
+              const ptrdiff_t q = col + (ptrdiff_t) mapCol[k];
+              if (r >= 0 && q >= 0 && r < (ptrdiff_t) inputWidth &&
+                  q < (ptrdiff_t) inputHeight)
+              {
+                value += mapWeight[k] * channel[r + q * inputWidth];
+              }
+            }
           }
+
+          patch[e] = value;
         }
       }
     }
   }
 
-  for (size_t i = 0; i < outputTemp.n_slices; ++i)
-  {
-    outputTemp.slice(i) = arma::trans(outputTemp.slice(i));
-  }
-
-  output = arma::Mat<eT>(outputTemp.memptr(), outputTemp.n_elem, 1);
-
-  outputWidth = outputTemp.n_rows;
-  outputHeight = outputTemp.n_cols;
+  outputWidth = size;
+  outputHeight = size;
 }
 
 template<typename InputDataType, typename OutputDataType>
@@ -122,87 +123,153 @@ template<typename eT>
 void Glimpse<InputDataType, OutputDataType>::Backward(
     const arma::Mat<eT>&& /* input */, arma::Mat<eT>&& gy, arma::Mat<eT>&& g)
 {
-  // Generate a cube using the backpropagated error matrix.
-  arma::Cube<eT> mappedError = arma::zeros<arma::cube>(outputWidth,
-      outputHeight, 1);
-
   location = locationParameter.back();
   locationParameter.pop_back();
 
-  for (size_t s = 0, j = 0; s < mappedError.n_slices; s+= gy.n_cols, j++)
+  // The error of each element of a patch goes back to the pixels it was
+  // computed from; the locations get no error.
+  const size_t imageSize = inputWidth * inputHeight;
+  const size_t patchElements = size * size;
+  g.zeros(inputRows, inputCols);
+  for (size_t n = 0; n < location.n_cols; ++n)
   {
-    for (size_t i = 0; i < gy.n_cols; i++)
+    eT* image = g.colptr(n);
+    const eT* error = gy.colptr(n);
+    for (size_t d = 0; d < depth; ++d)
     {
-      mappedError.slice(s + i) = arma::Mat<eT>(gy.memptr(),
-          outputWidth, outputHeight);
-    }
-  }
+      ptrdiff_t row, col;
+      Corner(location(0, n), location(1, n), d, row, col);
 
-  gTemp = arma::zeros<arma::cube>(inputTemp.n_rows, inputTemp.n_cols,
-      inputTemp.n_slices);
+      const bool inside = (row >= 0) && (col >= 0) &&
+          (row + (ptrdiff_t) patchSize[d] <= (ptrdiff_t) inputWidth) &&
+          (col + (ptrdiff_t) patchSize[d] <= (ptrdiff_t) inputHeight);
 
-  for (size_t inputIdx = 0; inputIdx < inSize; inputIdx++)
-  {
-    for (size_t depthIdx = 0, glimpseSize = size;
-        depthIdx < depth; depthIdx++, glimpseSize *= scale)
-    {
-      size_t padSize = std::floor((glimpseSize - 1) / 2);
-
-      arma::Cube<eT> inputPadded = arma::zeros<arma::Cube<eT> >(
-          inputTemp.n_rows + padSize * 2, inputTemp.n_cols +
-          padSize * 2, inputTemp.n_slices / inSize);
-
-      size_t h = inputPadded.n_rows - glimpseSize;
-      size_t w = inputPadded.n_cols - glimpseSize;
-
-      size_t x = std::min(h, (size_t) std::max(0.0,
-          (location(0, inputIdx) + 1) / 2.0 * h));
-      size_t y = std::min(w, (size_t) std::max(0.0,
-          (location(1, inputIdx) + 1) / 2.0 * w));
-
-      if (depthIdx == 0)
-      {
-        for (size_t j = (inputIdx + depthIdx), paddedSlice = 0;
-            j < mappedError.n_slices; j += (inSize * depth), paddedSlice++)
-        {
-          inputPadded.subcube(x, y,
-              paddedSlice, x + glimpseSize - 1, y + glimpseSize - 1,
-              paddedSlice) = mappedError.slice(j);
-        }
-      }
-      else
+      const size_t* start = &mapStart[d * patchElements];
+      for (size_t c = 0; c < inSize; ++c)
       {
-        for (size_t j = (inputIdx + depthIdx * (depth - 1)), paddedSlice = 0;
-            j < mappedError.n_slices; j += (inSize * depth), paddedSlice++)
+        eT* channel = image + c * imageSize;
+        const eT* patch = error + (d * inSize + c) * patchElements;
+        for (size_t e = 0; e < patchElements; ++e)
         {
-          arma::Mat<eT> poolingOutput = inputPadded.subcube(x, y,
-               paddedSlice, x + glimpseSize - 1, y + glimpseSize - 1,
-               paddedSlice);
-
-          if (scale == 2)
+          if (inside)
           {
-            Unpooling(inputTemp.slice(paddedSlice), mappedError.slice(j),
-                poolingOutput);
+            eT* corner = channel + row + col * inputWidth;
+            for (size_t k = start[e]; k < start[e + 1]; ++k)
+              corner[mapOffset[k]] += mapWeight[k] * patch[e];
           }
           else
           {
-            DownwardReSampling(inputTemp.slice(paddedSlice),
-                mappedError.slice(j), poolingOutput);
+            for (size_t k = start[e]; k < start[e + 1]; ++k)
+            {
+              const ptrdiff_t r = row + (ptrdiff_t) mapRow[k];
+              const ptrdiff_t q = col + (ptrdiff_t) mapCol[k];
+              if (r >= 0 && q >= 0 && r < (ptrdiff_t) inputWidth &&
+                  q < (ptrdiff_t) inputHeight)
+              {
+                channel[r + q * inputWidth] += mapWeight[k] * patch[e];
+              }
+            }
           }
-
-          inputPadded.subcube(x, y,
-              paddedSlice, x + glimpseSize - 1, y + glimpseSize - 1,
-              paddedSlice) = poolingOutput;
         }
       }
+    }
+  }
+}
+
+template<typename InputDataType, typename OutputDataType>
+void Glimpse<InputDataType, OutputDataType>::BuildMaps()
+{
+  patchSize.resize(depth);
+  mapStart.assign(1, 0);
+  mapRow.clear();
+  mapCol.clear();
+  mapOffset.clear();
+  mapWeight.clear();
+
+  const size_t width = inputWidth;
+  auto add = [&](const size_t r, const size_t c, const double weight)
+  {
+    mapRow.push_back(r);
+    mapCol.push_back(c);
+    mapOffset.push_back(r + c * width);
+    mapWeight.push_back(weight);
+  };
+
+  // Each element of a patch is stored in row-major order.
+  for (size_t d = 0; d < depth; ++d)
+  {
+    patchSize[d] = (d == 0) ? size : patchSize[d - 1] * scale;
+    const size_t crop = patchSize[d];
+
+    for (size_t p = 0; p < size; ++p)
+    {
+      for (size_t q = 0; q < size; ++q)
+      {
+        if (d == 0)
+        {
+          // The first patch is the crop itself.
+          add(p, q, 1.0);
+        }
+        else if (scale == 2)
+        {
+          // The mean of each block of the crop.
+          const size_t k = crop / size;
+          for (size_t j = 0; j < k; ++j)
+            for (size_t i = 0; i < k; ++i)
+              add(p * k + i, q * k + j, 1.0 / (k * k));
+        }
+        else
+        {
+          // The bilinear interpolation of the 4 nearest pixels of the crop.
+          const double ratio = (size > 1) ? (double) (crop - 1) / (size - 1) :
+              0.0;
+          const double last = crop - 1;
+          const double ix = ratio * q;
+          const double iy = ratio * p;
+
+          const double ixNw = std::floor(ix);
+          const double iyNw = std::floor(iy);
+          const double ixNe = ixNw + 1;
+          const double iySw = iyNw + 1;
+
+          const size_t top = iyNw;
+          const size_t left = ixNw;
+          const size_t bottom = std::min(iySw, last);
+          const size_t right = std::min(ixNe, last);
+
+          add(top, left, (ixNe - ix) * (iySw - iy));
+          add(top, right, (ix - ixNw) * (iySw - iy));
+          add(bottom, left, (ixNe - ix) * (iy - iyNw));
+          add(bottom, right, (ix - ixNw) * (iy - iyNw));
+        }
 
-      gTemp += inputPadded.tube(padSize, padSize, padSize +
-          inputTemp.n_rows - 1, padSize + inputTemp.n_cols - 1);
+        mapStart.push_back(mapRow.size());
+      }
     }
   }
 
-  Transform(gTemp);
-  g = arma::mat(gTemp.memptr(), gTemp.n_elem, 1);
+  mapWidth = inputWidth;
+}
+
+template<typename InputDataType, typename OutputDataType>
+void Glimpse<InputDataType, OutputDataType>::Corner(
+    const double x,
+    const double y,
+    const size_t patch,
+    ptrdiff_t& row,
+    ptrdiff_t& col) const
+{
+  // The location is mapped to the corners of the crops that fit in the image
+  // padded with zeros on each side.
+  const ptrdiff_t crop = patchSize[patch];
+  const ptrdiff_t padSize = (crop - 1) / 2;
+  const ptrdiff_t h = std::max((ptrdiff_t) inputWidth + 2 * padSize - crop,
+      (ptrdiff_t) 0);
+  const ptrdiff_t w = std::max((ptrdiff_t) inputHeight + 2 * padSize - crop,
+      (ptrdiff_t) 0);
+
+  row = std::min(h, (ptrdiff_t) std::max(0.0, (x + 1) / 2.0 * h)) - padSize;
+  col = std::min(w, (ptrdiff_t) std::max(0.0, (y + 1) / 2.0 * w)) - padSize;
 }
 
 template<typename InputDataType, typename OutputDataType>
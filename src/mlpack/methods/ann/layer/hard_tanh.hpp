@@ -14,6 +14,8 @@
 
 #include <mlpack/prereqs.hpp>
 
+#include "layer_traits.hpp"
+
 namespace mlpack {
 namespace ann /** Artificial Neural Network. */ {
 
@@ -131,6 +133,12 @@ class HardTanH
   double minValue;
 }; // class HardTanH
 
+//! HardTanH layers can process a batch of points at once.
+template<typename InputDataType, typename OutputDataType>
+class LayerTraits<HardTanH<InputDataType, OutputDataType> > :
+    public BatchLayerTraits
+{ };
+
 } // namespace ann
 } // namespace mlpack
 
@@ -53,6 +53,29 @@ class LayerTraits
    * This is true if the layer is a connection layer.
    **/
   static const bool IsConnection = false;
+
+  /**
+   * This is true if the layer can process a batch of points (one point per
+   * column of the input) at once, summing the gradient of its parameters over
+   * the points of the batch.
+   */
+  static const bool SupportsBatches = false;
+};
+
+/**
+ * The traits of a simple layer that can process a batch of points at once: the
+ * default LayerTraits, except for SupportsBatches.  The LayerTraits
+ * specialization of such a layer can just inherit from this class.
+ */
+class BatchLayerTraits
+{
+ public:
+  static const bool IsBinary = false;
+  static const bool IsOutputLayer = false;
+  static const bool IsBiasLayer = false;
+  static const bool IsLSTMLayer = false;
+  static const bool IsConnection = false;
+  static const bool SupportsBatches = true;
 };
 
 // This gives us a HasGradientCheck<T, U> type (where U is a function pointer)
@@ -98,7 +121,12 @@ HAS_MEM_FUNC(InputHeight, HasInputHeight);
 
 // This gives us a HasRho<T, U> type (where U is a function pointer) we
 // can use with SFINAE to catch when a type has a Rho() function.
-HAS_MEM_FUNC(InputHeight, HasRho);
+HAS_MEM_FUNC(Rho, HasRho);
+
+// This gives us a HasSparseGradientCheck<T, U> type (where U is a function
+// pointer) we can use with SFINAE to catch when a type has a SparseGradient()
+// function.
+HAS_MEM_FUNC(SparseGradient, HasSparseGradientCheck);
 
 } // namespace ann
 } // namespace mlpack
@@ -16,6 +16,8 @@
 
 #include <mlpack/prereqs.hpp>
 
+#include "layer_traits.hpp"
+
 namespace mlpack {
 namespace ann /** Artificial Neural Network. */ {
 
@@ -167,6 +169,12 @@ class LeakyReLU
   double alpha;
 }; // class LeakyReLU
 
+//! LeakyReLU layers can process a batch of points at once.
+template<typename InputDataType, typename OutputDataType>
+class LayerTraits<LeakyReLU<InputDataType, OutputDataType> > :
+    public BatchLayerTraits
+{ };
+
 } // namespace ann
 } // namespace mlpack
 
@@ -15,6 +15,7 @@
 
 #include <mlpack/prereqs.hpp>
 
+#include "layer_traits.hpp"
 #include "layer_types.hpp"
 
 namespace mlpack {
@@ -113,6 +114,16 @@ class Linear
   //! Modify the gradient.
   OutputDataType& Gradient() { return gradient; }
 
+  //! Get the weight of the layer (a view of the parameters).
+  OutputDataType const& Weight() const { return weight; }
+  //! Get the bias of the layer (a view of the parameters).
+  OutputDataType const& Bias() const { return bias; }
+
+  //! Get the number of input units.
+  size_t InputSize() const { return inSize; }
+  //! Get the number of output units.
+  size_t OutputSize() const { return outSize; }
+
   /**
    * Serialize the layer
    */
@@ -148,6 +159,12 @@ class Linear
   OutputDataType outputParameter;
 }; // class Linear
 
+//! Linear layers can process a batch of points at once.
+template<typename InputDataType, typename OutputDataType>
+class LayerTraits<Linear<InputDataType, OutputDataType> > :
+    public BatchLayerTraits
+{ };
+
 } // namespace ann
 } // namespace mlpack
 
@@ -15,6 +15,7 @@
 
 #include <mlpack/prereqs.hpp>
 
+#include "layer_traits.hpp"
 #include "layer_types.hpp"
 
 namespace mlpack {
@@ -112,6 +113,11 @@ class LinearNoBias
   //! Modify the gradient.
   OutputDataType& Gradient() { return gradient; }
 
+  //! Get the number of input units.
+  size_t InputSize() const { return inSize; }
+  //! Get the number of output units.
+  size_t OutputSize() const { return outSize; }
+
   /**
    * Serialize the layer
    */
@@ -144,6 +150,12 @@ class LinearNoBias
   OutputDataType outputParameter;
 }; // class LinearNoBias
 
+//! LinearNoBias layers can process a batch of points at once.
+template<typename InputDataType, typename OutputDataType>
+class LayerTraits<LinearNoBias<InputDataType, OutputDataType> > :
+    public BatchLayerTraits
+{ };
+
 } // namespace ann
 } // namespace mlpack
 
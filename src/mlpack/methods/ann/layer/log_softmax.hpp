@@ -14,6 +14,8 @@
 
 #include <mlpack/prereqs.hpp>
 
+#include "layer_traits.hpp"
+
 namespace mlpack {
 namespace ann /** Artificial Neural Network. */ {
 
@@ -51,6 +53,35 @@ class LogSoftMax
   template<typename InputType, typename OutputType>
   void Forward(const InputType&& input, OutputType&& output);
 
+  /**
+   * Fast approximation of exp(-x) for x positive, as used by Forward().  The
+   * accuracy is about 0.00001 lower than that of std::exp().  Credits go to
+   * Leon Bottou.
+   *
+   * @param x Non-negative value.
+   */
+  static double ExpNegative(const double x)
+  {
+    static constexpr double A0 = 1.0;
+    static constexpr double A1 = 0.125;
+    static constexpr double A2 = 0.0078125;
+    static constexpr double A3 = 0.00032552083;
+    static constexpr double A4 = 1.0172526e-5;
+
+    if (x < 13.0)
+    {
+      double y = A0 + x * (A1 + x * (A2 + x * (A3 + x * A4)));
+      y *= y;
+      y *= y;
+      y *= y;
+      y = 1 / y;
+
+      return y;
+    }
+
+    return 0.0;
+  }
+
   /**
    * Ordinary feed backward pass of a neural network, calculating the function
    * f(x) by propagating x backwards trough f. Using the results from the feed
@@ -97,6 +128,12 @@ class LogSoftMax
   OutputDataType outputParameter;
 }; // class LogSoftmax
 
+//! LogSoftMax layers can process a batch of points at once.
+template<typename InputDataType, typename OutputDataType>
+class LayerTraits<LogSoftMax<InputDataType, OutputDataType> > :
+    public BatchLayerTraits
+{ };
+
 } // namespace ann
 } // namespace mlpack
 
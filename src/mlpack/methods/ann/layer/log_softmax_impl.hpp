@@ -29,35 +29,15 @@ template<typename InputType, typename OutputType>
 void LogSoftMax<InputDataType, OutputDataType>::Forward(
     const InputType&& input, OutputType&& output)
 {
-  arma::mat maxInput = arma::repmat(arma::max(input), input.n_rows, 1);
+  OutputDataType maxInput = arma::repmat(arma::max(input), input.n_rows, 1);
   output = (maxInput - input);
 
-  // Approximation of the hyperbolic tangent. The acuracy however is
-  // about 0.00001 lower as using tanh. Credits go to Leon Bottou.
-  output.transform([](double x)
-  {
-    //! Fast approximation of exp(-x) for x positive.
-    static constexpr double A0 = 1.0;
-    static constexpr double A1 = 0.125;
-    static constexpr double A2 = 0.0078125;
-    static constexpr double A3 = 0.00032552083;
-    static constexpr double A4 = 1.0172526e-5;
+  // Approximation of the exponential of the non-positive differences.
+  output.transform([](double x) { return ExpNegative(x); });
 
-    if (x < 13.0)
-    {
-      double y = A0 + x * (A1 + x * (A2 + x * (A3 + x * A4)));
-      y *= y;
-      y *= y;
-      y *= y;
-      y = 1 / y;
-
-      return y;
-    }
-
-    return 0.0;
-  });
-
-  output = input - (maxInput + std::log(arma::accu(output)));
+  // Normalize each column (each point of the batch) separately.
+  output = input - (maxInput + arma::repmat(arma::log(arma::sum(output)),
+      input.n_rows, 1));
 }
 
 template<typename InputDataType, typename OutputDataType>
@@ -67,7 +47,7 @@ void LogSoftMax<InputDataType, OutputDataType>::Backward(
     arma::Mat<eT>&& gy,
     arma::Mat<eT>&& g)
 {
-  g = gy - arma::exp(input) * arma::accu(gy);
+  g = gy - arma::exp(input) % arma::repmat(arma::sum(gy), gy.n_rows, 1);
 }
 
 template<typename InputDataType, typename OutputDataType>
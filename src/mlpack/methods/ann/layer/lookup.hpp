@@ -70,6 +70,9 @@ class Lookup
 
   /*
    * Calculate the gradient using the output delta and the input activation.
+   * The gradient of a word used more than once is the sum of its errors.  In
+   * sparse gradient mode, only the columns of the used words are written (and
+   * zeroed first), and the other columns are left as they are.
    *
    * @param input The input parameter used for calculating the gradient.
    * @param error The calculated error.
@@ -105,6 +108,14 @@ class Lookup
   //! Modify the gradient.
   OutputDataType& Gradient() { return gradient; }
 
+  //! Get whether Gradient() only writes the columns of the used words.
+  bool SparseGradient() const { return sparseGradient; }
+  //! Modify whether Gradient() only writes the columns of the used words.
+  bool& SparseGradient() { return sparseGradient; }
+
+  //! Get the (sorted) columns of the weights used by the last Gradient() call.
+  arma::uvec const& GradientColumns() const { return gradientColumns; }
+
   /**
    * Serialize the layer
    */
@@ -127,6 +138,12 @@ class Lookup
   //! Locally-stored gradient object.
   OutputDataType gradient;
 
+  //! Whether Gradient() only writes the columns of the used words.
+  bool sparseGradient;
+
+  //! The columns of the weights used by the last Gradient() call.
+  arma::uvec gradientColumns;
+
   //! Locally-stored input parameter object.
   InputDataType inputParameter;
 
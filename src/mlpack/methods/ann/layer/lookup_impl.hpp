@@ -24,7 +24,8 @@ Lookup<InputDataType, OutputDataType>::Lookup(
     const size_t inSize,
     const size_t outSize) :
     inSize(inSize),
-    outSize(outSize)
+    outSize(outSize),
+    sparseGradient(false)
 {
   weights.set_size(outSize, inSize);
 }
@@ -54,8 +55,16 @@ void Lookup<InputDataType, OutputDataType>::Gradient(
     arma::Mat<eT>&& error,
     arma::Mat<eT>&& gradient)
 {
-  gradient = arma::zeros<arma::Mat<eT> >(weights.n_rows, weights.n_cols);
-  gradient.cols(arma::conv_to<arma::uvec>::from(input) - 1) = error;
+  const arma::uvec columns = arma::conv_to<arma::uvec>::from(input) - 1;
+  gradientColumns = arma::unique(columns);
+
+  if (sparseGradient)
+    gradient.cols(gradientColumns).zeros();
+  else
+    gradient = arma::zeros<arma::Mat<eT> >(weights.n_rows, weights.n_cols);
+
+  for (size_t i = 0; i < columns.n_elem; ++i)
+    gradient.col(columns[i]) += error.col(i);
 }
 
 template<typename InputDataType, typename OutputDataType>
@@ -15,14 +15,7 @@
 
 #include <mlpack/prereqs.hpp>
 
-#include <boost/ptr_container/ptr_vector.hpp>
-
-#include "../visitor/delta_visitor.hpp"
-#include "../visitor/output_parameter_visitor.hpp"
-
 #include "layer_types.hpp"
-#include "add_merge.hpp"
-#include "sequential.hpp"
 
 namespace mlpack {
 namespace ann /** Artificial Neural Network. */ {
@@ -30,9 +23,18 @@ namespace ann /** Artificial Neural Network. */ {
 /**
  * An implementation of a lstm network layer.
  *
- * This class allows specification of the type of the activation functions used
- * for the gates and cells and also of the type of the function used to
- * initialize and update the peephole weights.
+ * The four gates (input gate, hidden state, forget gate and output gate) of
+ * each step are computed by one product of the stacked 4 * outSize x
+ * (inSize + outSize) weight matrix with the stacked input and previous output,
+ * followed by one loop that applies the gate nonlinearities and updates the
+ * cell and the output.  The input may hold a batch of points, one per column.
+ * For backpropagation through time, only the activated gates and the cell of
+ * each of the rho steps are stored; the outputs are recomputed from them.
+ *
+ * The state is reset every rho steps (the length of a sequence).  Backward()
+ * starts from the last step passed to Forward() and goes back one step per
+ * call, so the backward pass may stop before the start of the sequence and be
+ * resumed after more forward steps (truncated backpropagation through time).
  *
  * @tparam InputDataType Type of the input data (arma::colvec, arma::mat,
  *         arma::sp_mat or arma::cube).
@@ -58,6 +60,11 @@ class LSTM
    */
   LSTM(const size_t inSize, const size_t outSize, const size_t rho);
 
+  /*
+   * Set the weight and bias term.
+   */
+  void Reset();
+
   /**
    * Ordinary feed forward pass of a neural network, evaluating the function
    * f(x) by propagating the activity forward through f.
@@ -92,7 +99,7 @@ class LSTM
   template<typename eT>
   void Gradient(arma::Mat<eT>&& input,
                 arma::Mat<eT>&& /* error */,
-                arma::Mat<eT>&& /* gradient */);
+                arma::Mat<eT>&& gradient);
 
   //! The value of the deterministic parameter.
   bool Deterministic() const { return deterministic; }
@@ -104,6 +111,12 @@ class LSTM
   //! Modify the maximum number of steps to backpropagate through time (BPTT).
   size_t& Rho() { return rho; }
 
+  //! Get the input size.
+  size_t InputSize() const { return inSize; }
+
+  //! Get the output size.
+  size_t OutputSize() const { return outSize; }
+
   //! Get the parameters.
   OutputDataType const& Parameters() const { return weights; }
   //! Modify the parameters.
@@ -129,14 +142,11 @@ class LSTM
   //! Modify the gradient.
   OutputDataType& Gradient() { return gradient; }
 
-  //! Get the model modules.
-  std::vector<LayerTypes>& Model() { return network; }
-
   /**
    * Serialize the layer
    */
   template<typename Archive>
-  void Serialize(Archive& ar, const unsigned int /* version */);
+  void Serialize(Archive& ar, const unsigned int version);
 
  private:
   //! Locally-stored number of input units.
@@ -151,44 +161,11 @@ class LSTM
   //! Locally-stored weight object.
   OutputDataType weights;
 
-  //! Locally-stored previous output.
-  arma::mat prevOutput;
-
-  //! Locally-stored previous cell state.
-  arma::mat prevCell;
-
-  //! Locally-stored input 2 gate module.
-  LayerTypes input2GateModule;
-
-  //! Locally-stored output 2 gate module.
-  LayerTypes output2GateModule;
-
-  //! Locally-stored input gate module.
-  LayerTypes inputGateModule;
-
-  //! Locally-stored hidden state module.
-  LayerTypes hiddenStateModule;
+  //! Locally-stored stacked weight parameters of the four gates.
+  OutputDataType weight;
 
-  //! Locally-stored forget gate module.
-  LayerTypes forgetGateModule;
-
-  //! Locally-stored output gate module.
-  LayerTypes outputGateModule;
-
-  //! Locally-stored cell module.
-  LayerTypes cellModule;
-
-  //! Locally-stored cell activation module.
-  LayerTypes cellActivationModule;
-
-  //! Locally-stored output parameter visitor.
-  OutputParameterVisitor outputParameterVisitor;
-
-  //! Locally-stored delta visitor.
-  DeltaVisitor deltaVisitor;
-
-  //! Locally-stored list of network modules.
-  std::vector<LayerTypes> network;
+  //! Locally-stored bias term parameters of the four gates.
+  OutputDataType bias;
 
   //! Locally-stored number of forward steps.
   size_t forwardStep;
@@ -199,20 +176,31 @@ class LSTM
   //! Locally-stored number of gradient steps.
   size_t gradientStep;
 
-  //! Locally-stored cell parameters.
-  std::vector<arma::mat> cellParameter;
+  //! Locally-stored index of the last forward step of the sequence.
+  size_t lastStep;
+
+  //! Locally-stored number of points in the batch of the current sequence.
+  size_t batchSize;
 
-  //! Locally-stored output parameters.
-  std::vector<arma::mat> outParameter;
+  //! Locally-stored stacked input and previous output of the current step.
+  arma::mat inputState;
 
-  //! Locally-stored previous error.
-  arma::mat prevError;
+  //! Locally-stored activated gates of each step, one block of columns per
+  //! step.
+  arma::mat gateActivations;
 
-  //! Locally-stored cell activation error.
-  arma::mat cellActivationError;
+  //! Locally-stored initial cell, followed by the cell of each step.
+  arma::mat cellState;
 
-  //! Locally-stored foget gate error.
-  arma::mat forgetGateError;
+  //! Locally-stored error of the gates (before the nonlinearities) of the
+  //! current backward step.
+  arma::mat gateError;
+
+  //! Locally-stored error of the previous output.
+  arma::mat recurrentError;
+
+  //! Locally-stored error of the previous cell.
+  arma::mat cellError;
 
   //! If true dropout and scaling is disabled, see notes above.
   bool deterministic;
@@ -233,6 +221,24 @@ class LSTM
 } // namespace ann
 } // namespace mlpack
 
+//! Set the serialization version of the LSTM class (version 1 stacks the
+//! weights of the gates).  BOOST_TEMPLATE_CLASS_VERSION() can't take the
+//! signature of a template with two parameters, so it is written out here.
+namespace boost {
+namespace serialization {
+
+template<typename InputDataType, typename OutputDataType>
+struct version<mlpack::data::SecondShim<
+    mlpack::ann::LSTM<InputDataType, OutputDataType>>>
+{
+  typedef mpl::int_<1> type;
+  typedef mpl::integral_c_tag tag;
+  BOOST_STATIC_CONSTANT(int, value = version::type::value);
+};
+
+} // namespace serialization
+} // namespace boost
+
 // Include implementation.
 #include "lstm_impl.hpp"
 
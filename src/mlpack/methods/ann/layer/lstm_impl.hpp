@@ -14,11 +14,7 @@
 #define MLPACK_METHODS_ANN_LAYER_LSTM_IMPL_HPP
 
 // In case it hasn't yet been included.
-#include "linear.hpp"
-
-#include "../visitor/forward_visitor.hpp"
-#include "../visitor/backward_visitor.hpp"
-#include "../visitor/gradient_visitor.hpp"
+#include "lstm.hpp"
 
 namespace mlpack {
 namespace ann /** Artificial Neural Network. */ {
@@ -40,37 +36,20 @@ LSTM<InputDataType, OutputDataType>::LSTM(
     forwardStep(0),
     backwardStep(0),
     gradientStep(0),
+    lastStep(0),
+    batchSize(0),
     deterministic(false)
 {
-  input2GateModule = new Linear<>(inSize, 4 * outSize);
-  output2GateModule = new LinearNoBias<>(outSize, 4 * outSize);
-
-  network.push_back(input2GateModule);
-  network.push_back(output2GateModule);
-
-  inputGateModule = new SigmoidLayer<>();
-  hiddenStateModule = new TanHLayer<>();
-  forgetGateModule = new SigmoidLayer<>();
-  outputGateModule = new SigmoidLayer<>();
-
-  network.push_back(inputGateModule);
-  network.push_back(hiddenStateModule);
-  network.push_back(forgetGateModule);
-  network.push_back(outputGateModule);
-
-  cellModule = new IdentityLayer<>();
-  cellActivationModule = new TanHLayer<>();
-
-  network.push_back(cellModule);
-  network.push_back(cellActivationModule);
-
-  prevOutput = arma::zeros<arma::mat>(outSize, 1);
-  prevCell = arma::zeros<arma::mat>(outSize, 1);
-  prevError = arma::zeros<arma::mat>(4 * outSize, 1);
-  cellActivationError = arma::zeros<arma::mat>(outSize, 1);
+  weights.set_size(4 * outSize * (inSize + outSize) + 4 * outSize, 1);
+}
 
-  cellParameter.reserve(rho);
-  outParameter.reserve(rho);
+template<typename InputDataType, typename OutputDataType>
+void LSTM<InputDataType, OutputDataType>::Reset()
+{
+  weight = arma::mat(weights.memptr(), 4 * outSize, inSize + outSize, false,
+      false);
+  bias = arma::mat(weights.memptr() + weight.n_elem, 4 * outSize, 1, false,
+      false);
 }
 
 template<typename InputDataType, typename OutputDataType>
@@ -78,67 +57,58 @@ template<typename eT>
 void LSTM<InputDataType, OutputDataType>::Forward(
     arma::Mat<eT>&& input, arma::Mat<eT>&& output)
 {
-  if (!deterministic)
+  // Each sequence starts with a zero cell and a zero output.
+  if (forwardStep == 0)
   {
-    cellParameter.push_back(prevCell);
-    outParameter.push_back(prevOutput);
+    batchSize = input.n_cols;
+    gateActivations.set_size(4 * outSize, rho * batchSize);
+    cellState.set_size(outSize, (rho + 1) * batchSize);
+    cellState.cols(0, batchSize - 1).zeros();
+    inputState.zeros(inSize + outSize, batchSize);
   }
 
-  boost::apply_visitor(ForwardVisitor(std::move(input), std::move(
-      boost::apply_visitor(outputParameterVisitor, input2GateModule))),
-      input2GateModule);
-
-  boost::apply_visitor(ForwardVisitor(std::move(prevOutput), std::move(
-      boost::apply_visitor(outputParameterVisitor, output2GateModule))),
-      output2GateModule);
-
-  output = boost::apply_visitor(outputParameterVisitor, input2GateModule) +
-      boost::apply_visitor(outputParameterVisitor, output2GateModule);
+  // All four gates of all the points of the batch in one product.
+  inputState.rows(0, inSize - 1) = input;
+  arma::mat gates(gateActivations.colptr(forwardStep * batchSize),
+      4 * outSize, batchSize, false, true);
+  gates = weight * inputState;
+  gates.each_col() += bias;
 
-  boost::apply_visitor(ForwardVisitor(std::move(output.submat(
-      0, 0, 1 * outSize - 1, 0)), std::move(boost::apply_visitor(
-      outputParameterVisitor, inputGateModule))), inputGateModule);
-
-  boost::apply_visitor(ForwardVisitor(std::move(output.submat(
-      1 * outSize, 0, 2 * outSize - 1, 0)), std::move(boost::apply_visitor(
-      outputParameterVisitor, hiddenStateModule))), hiddenStateModule);
-
-  boost::apply_visitor(ForwardVisitor(std::move(output.submat(
-      2 * outSize, 0, 3 * outSize - 1, 0)), std::move(boost::apply_visitor(
-      outputParameterVisitor, forgetGateModule))), forgetGateModule);
-
-  boost::apply_visitor(ForwardVisitor(std::move(output.submat(
-      3 * outSize, 0, 4 * outSize - 1, 0)), std::move(boost::apply_visitor(
-      outputParameterVisitor, outputGateModule))), outputGateModule);
-
-  // Update the cell (nextCell): cmul1 + cmul2
-  // where cmul1 is input gate * hidden state and
-  // cmul2 is forget gate * cell (prevCell).
-  prevCell = (boost::apply_visitor(outputParameterVisitor,
-      inputGateModule) % boost::apply_visitor(outputParameterVisitor,
-      hiddenStateModule)) + (boost::apply_visitor(outputParameterVisitor,
-      forgetGateModule) % prevCell);
-
-  boost::apply_visitor(ForwardVisitor(std::move(prevCell), std::move(
-      boost::apply_visitor(outputParameterVisitor, cellModule))), cellModule);
-
-  boost::apply_visitor(ForwardVisitor(std::move(boost::apply_visitor(
-      outputParameterVisitor, cellModule)), std::move(boost::apply_visitor(
-      outputParameterVisitor, cellActivationModule))), cellActivationModule);
+  output.set_size(outSize, batchSize);
+  for (size_t j = 0; j < batchSize; ++j)
+  {
+    double* gate = gates.colptr(j);
+    const double* prevCell = cellState.colptr(forwardStep * batchSize + j);
+    double* cell = cellState.colptr((forwardStep + 1) * batchSize + j);
+    eT* outputPtr = output.colptr(j);
+
+    for (size_t k = 0; k < outSize; ++k)
+    {
+      const double inputGate = 1.0 / (1.0 + std::exp(-gate[k]));
+      const double hiddenState = std::tanh(gate[outSize + k]);
+      const double forgetGate = 1.0 / (1.0 + std::exp(-gate[2 * outSize + k]));
+      const double outputGate = 1.0 / (1.0 + std::exp(-gate[3 * outSize + k]));
+
+      gate[k] = inputGate;
+      gate[outSize + k] = hiddenState;
+      gate[2 * outSize + k] = forgetGate;
+      gate[3 * outSize + k] = outputGate;
+
+      cell[k] = inputGate * hiddenState + forgetGate * prevCell[k];
+      outputPtr[k] = outputGate * std::tanh(cell[k]);
+    }
+  }
 
-  output = boost::apply_visitor(outputParameterVisitor,
-      cellActivationModule) % boost::apply_visitor(outputParameterVisitor,
-      outputGateModule);
+  inputState.rows(inSize, inSize + outSize - 1) = output;
 
-  prevOutput = output;
+  // The next backward pass starts from this step.
+  lastStep = forwardStep;
+  backwardStep = 0;
+  gradientStep = 0;
 
   forwardStep++;
   if (forwardStep == rho)
-  {
     forwardStep = 0;
-    prevOutput.zeros();
-    prevCell.zeros();
-  }
 }
 
 template<typename InputDataType, typename OutputDataType>
@@ -146,89 +116,56 @@ template<typename eT>
 void LSTM<InputDataType, OutputDataType>::Backward(
   const arma::Mat<eT>&& /* input */, arma::Mat<eT>&& gy, arma::Mat<eT>&& g)
 {
-  if (backwardStep > 0)
+  // The steps are backpropagated from the last forward step backwards; the
+  // error of the output and of the cell after that step is zero.
+  const size_t step = lastStep - backwardStep;
+  if (backwardStep == 0)
   {
-    gy += boost::apply_visitor(deltaVisitor, output2GateModule);
+    recurrentError.zeros(outSize, batchSize);
+    cellError.zeros(outSize, batchSize);
   }
 
-  arma::mat g1 = boost::apply_visitor(outputParameterVisitor,
-      cellActivationModule) % gy;
-
-  arma::mat g2 = boost::apply_visitor(outputParameterVisitor,
-      outputGateModule) % gy;
-
-  boost::apply_visitor(BackwardVisitor(std::move(boost::apply_visitor(
-      outputParameterVisitor, cellActivationModule)), std::move(g2),
-      std::move(boost::apply_visitor(deltaVisitor, cellActivationModule))),
-      cellActivationModule);
-
-  cellActivationError = boost::apply_visitor(deltaVisitor,
-      cellActivationModule);
-
-  if (backwardStep > 0)
+  gateError.set_size(4 * outSize, batchSize);
+  for (size_t j = 0; j < batchSize; ++j)
   {
-    cellActivationError += forgetGateError;
+    const double* gate = gateActivations.colptr(step * batchSize + j);
+    const double* prevCell = cellState.colptr(step * batchSize + j);
+    const double* cell = cellState.colptr((step + 1) * batchSize + j);
+    const eT* gyPtr = gy.colptr(j);
+    double* error = gateError.colptr(j);
+    const double* recurrent = recurrentError.colptr(j);
+    double* cellErrorPtr = cellError.colptr(j);
+
+    for (size_t k = 0; k < outSize; ++k)
+    {
+      const double inputGate = gate[k];
+      const double hiddenState = gate[outSize + k];
+      const double forgetGate = gate[2 * outSize + k];
+      const double outputGate = gate[3 * outSize + k];
+      const double cellActivation = std::tanh(cell[k]);
+
+      const double outputError = gyPtr[k] + recurrent[k];
+      const double cellErrorValue = outputError * outputGate *
+          (1.0 - cellActivation * cellActivation) + cellErrorPtr[k];
+
+      error[k] = cellErrorValue * hiddenState * inputGate * (1.0 - inputGate);
+      error[outSize + k] = cellErrorValue * inputGate *
+          (1.0 - hiddenState * hiddenState);
+      error[2 * outSize + k] = cellErrorValue * prevCell[k] * forgetGate *
+          (1.0 - forgetGate);
+      error[3 * outSize + k] = outputError * cellActivation * outputGate *
+          (1.0 - outputGate);
+
+      cellErrorPtr[k] = cellErrorValue * forgetGate;
+    }
   }
 
-  arma::mat g4 = boost::apply_visitor(outputParameterVisitor,
-      inputGateModule) % cellActivationError;
-
-  arma::mat g5 = boost::apply_visitor(outputParameterVisitor,
-      hiddenStateModule) % cellActivationError;
-
-  forgetGateError = boost::apply_visitor(outputParameterVisitor,
-      forgetGateModule) % cellActivationError;
-
-  arma::mat g7 = cellParameter[cellParameter.size() -
-      backwardStep - 1] % cellActivationError;
-
-  boost::apply_visitor(BackwardVisitor(std::move(boost::apply_visitor(
-      outputParameterVisitor, inputGateModule)), std::move(g5),
-      std::move(boost::apply_visitor(deltaVisitor, inputGateModule))),
-      inputGateModule);
-
-  boost::apply_visitor(BackwardVisitor(std::move(boost::apply_visitor(
-      outputParameterVisitor, hiddenStateModule)), std::move(g4),
-      std::move(boost::apply_visitor(deltaVisitor, hiddenStateModule))),
-      hiddenStateModule);
-
-  boost::apply_visitor(BackwardVisitor(std::move(boost::apply_visitor(
-      outputParameterVisitor, forgetGateModule)), std::move(g7),
-      std::move(boost::apply_visitor(deltaVisitor, forgetGateModule))),
-      forgetGateModule);
-
-  boost::apply_visitor(BackwardVisitor(std::move(boost::apply_visitor(
-      outputParameterVisitor, outputGateModule)), std::move(g1),
-      std::move(boost::apply_visitor(deltaVisitor, outputGateModule))),
-      outputGateModule);
-
-  prevError.submat(0, 0, 1 * outSize - 1, 0) = boost::apply_visitor(
-      deltaVisitor, inputGateModule);
-  prevError.submat(1 * outSize, 0, 2 * outSize - 1, 0) = boost::apply_visitor(
-      deltaVisitor, hiddenStateModule);
-  prevError.submat(2 * outSize, 0, 3 * outSize - 1, 0) = boost::apply_visitor(
-      deltaVisitor, forgetGateModule);
-  prevError.submat(3 * outSize, 0, 4 * outSize - 1, 0) = boost::apply_visitor(
-      deltaVisitor, outputGateModule);
-
-  boost::apply_visitor(BackwardVisitor(std::move(boost::apply_visitor(
-      outputParameterVisitor, input2GateModule)), std::move(prevError),
-      std::move(boost::apply_visitor(deltaVisitor, input2GateModule))),
-      input2GateModule);
-
-  boost::apply_visitor(BackwardVisitor(std::move(boost::apply_visitor(
-      outputParameterVisitor, output2GateModule)), std::move(prevError),
-      std::move(boost::apply_visitor(deltaVisitor, output2GateModule))),
-      output2GateModule);
+  // The error of the input and of the previous output in one product.
+  const arma::mat stackedError = weight.t() * gateError;
+  g = stackedError.rows(0, inSize - 1);
+  recurrentError = stackedError.rows(inSize, inSize + outSize - 1);
 
   backwardStep++;
-  if (backwardStep == rho)
-  {
-    backwardStep = 0;
-    cellParameter.clear();
-  }
-
-  g = boost::apply_visitor(deltaVisitor, input2GateModule);
 }
 
 template<typename InputDataType, typename OutputDataType>
@@ -236,32 +173,48 @@ template<typename eT>
 void LSTM<InputDataType, OutputDataType>::Gradient(
     arma::Mat<eT>&& input,
     arma::Mat<eT>&& /* error */,
-    arma::Mat<eT>&& /* gradient */)
+    arma::Mat<eT>&& gradient)
 {
-  boost::apply_visitor(GradientVisitor(std::move(input), std::move(prevError)),
-      input2GateModule);
+  const size_t step = lastStep - gradientStep;
 
-  boost::apply_visitor(GradientVisitor(
-      std::move(outParameter[outParameter.size() - gradientStep - 1]),
-      std::move(prevError)), output2GateModule);
-
-  gradientStep++;
-  if (gradientStep == rho)
+  // Recompute the previous output from the stored gates and cells.
+  arma::mat stackedInput(inSize + outSize, batchSize);
+  stackedInput.rows(0, inSize - 1) = input;
+  if (step == 0)
   {
-    gradientStep = 0;
-    outParameter.clear();
+    stackedInput.rows(inSize, inSize + outSize - 1).zeros();
   }
+  else
+  {
+    stackedInput.rows(inSize, inSize + outSize - 1) =
+        gateActivations.submat(3 * outSize, (step - 1) * batchSize,
+        4 * outSize - 1, step * batchSize - 1) % arma::tanh(
+        cellState.cols(step * batchSize, (step + 1) * batchSize - 1));
+  }
+
+  gradient.submat(0, 0, weight.n_elem - 1, 0) = arma::vectorise(
+      gateError * stackedInput.t());
+  gradient.submat(weight.n_elem, 0, gradient.n_elem - 1, 0) =
+      arma::sum(gateError, 1);
+
+  gradientStep++;
 }
 
 template<typename InputDataType, typename OutputDataType>
 template<typename Archive>
 void LSTM<InputDataType, OutputDataType>::Serialize(
-    Archive& ar, const unsigned int /* version */)
+    Archive& ar, const unsigned int version)
 {
   ar & data::CreateNVP(weights, "weights");
   ar & data::CreateNVP(inSize, "inSize");
   ar & data::CreateNVP(outSize, "outSize");
   ar & data::CreateNVP(rho, "rho");
+
+  // Before version 1 the weights were held by a Linear and a LinearNoBias
+  // module, so the weights of the layer itself are empty.  The network that
+  // holds the layer places its parameters (see LSTMLayoutVisitor).
+  if (Archive::is_loading::value && version == 0)
+    weights.set_size(4 * outSize * (inSize + outSize) + 4 * outSize, 1);
 }
 
 } // namespace ann
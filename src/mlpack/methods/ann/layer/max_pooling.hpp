@@ -15,6 +15,8 @@
 
 #include <mlpack/prereqs.hpp>
 
+#include "layer_traits.hpp"
+
 namespace mlpack {
 namespace ann /** Artificial Neural Network. */ {
 
@@ -38,7 +40,12 @@ class MaxPoolingRule
 };
 
 /**
- * Implementation of the MaxPooling layer.
+ * Implementation of the MaxPooling layer.  The input holds the maps one after
+ * the other, each stored column-major with inputWidth rows, and may hold a
+ * batch of points, one per column; all the maps of the batch are pooled in one
+ * pass over the memory.  The 2x2 and 3x3 windows have their own unrolled
+ * kernels.  For the backward pass, only the position of the maximum within
+ * each window is stored.
  *
  * @tparam InputDataType Type of the input data (arma::colvec, arma::mat,
  *         arma::sp_mat or arma::cube).
@@ -141,55 +148,91 @@ class MaxPooling
   void Serialize(Archive& ar, const unsigned int /* version */);
 
  private:
- /**
-   * Apply pooling to the input and store the results.
+  /**
+   * Apply max pooling to the given maps, stored one after the other, and store
+   * the position of the maximum within each window if indices is not NULL.
+   * If FixedWidth and FixedHeight are not 0, they are the size of the
+   * windows, and every window must lie within the input; the loops over a
+   * window then have a fixed length, so that they can be unrolled.
    *
-   * @param input The input to be apply the pooling rule.
-   * @param output The pooled result.
-   * @param poolingIndices The pooled indices.
+   * @param input The maps to pool.
+   * @param output The pooled maps.
+   * @param indices The position of each maximum within its window, or NULL.
+   * @param maps The number of maps.
    */
-  template<typename eT>
-  void PoolingOperation(const arma::Mat<eT>& input,
-                        arma::Mat<eT>& output,
-                        arma::Mat<eT>& poolingIndices)
+  template<size_t FixedWidth, size_t FixedHeight, typename eT>
+  void PoolingOperation(const eT* input,
+                        eT* output,
+                        unsigned short* indices,
+                        const size_t maps)
   {
-    for (size_t j = 0, colidx = 0; j < output.n_cols; ++j, colidx += dW)
+    const size_t windowWidth = FixedWidth ? FixedWidth : kW - offset;
+    const size_t windowHeight = FixedHeight ? FixedHeight : kH - offset;
+
+    for (size_t s = 0; s < maps; ++s, input += inputWidth * inputHeight)
     {
-      for (size_t i = 0, rowidx = 0; i < output.n_rows; ++i, rowidx += dH)
+      for (size_t j = 0, colidx = 0; j < outputHeight; ++j, colidx += dH)
       {
-        arma::mat subInput = input(arma::span(rowidx, rowidx + kW - 1 - offset),
-            arma::span(colidx, colidx + kH - 1 - offset));
-
-        const size_t idx = pooling.Pooling(subInput);
-        output(i, j) = subInput(idx);
+        const size_t cols = FixedHeight ? FixedHeight :
+            std::min(windowHeight, inputHeight - colidx);
 
-        if (!deterministic)
+        for (size_t i = 0, rowidx = 0; i < outputWidth; ++i, rowidx += dW)
         {
-          arma::Mat<size_t> subIndices = indices(arma::span(rowidx,
-              rowidx + kW - 1 - offset),
-              arma::span(colidx, colidx + kH - 1 - offset));
-
-          poolingIndices(i, j) = subIndices(idx);
+          const size_t rows = FixedWidth ? FixedWidth :
+              std::min(windowWidth, inputWidth - rowidx);
+          const eT* window = input + rowidx + colidx * inputWidth;
+
+          // The first maximum in column-major order is taken.
+          eT maximum = window[0];
+          size_t position = 0;
+          for (size_t kj = 0; kj < cols; ++kj)
+          {
+            for (size_t ki = 0; ki < rows; ++ki)
+            {
+              if (window[ki + kj * inputWidth] > maximum)
+              {
+                maximum = window[ki + kj * inputWidth];
+                position = ki + kj * windowWidth;
+              }
+            }
+          }
+
+          *output++ = maximum;
+          if (indices)
+            *indices++ = (unsigned short) position;
         }
       }
     }
   }
 
   /**
-   * Apply unpooling to the input and store the results.
+   * Apply unpooling to the error of the given maps and add the results to the
+   * output, using the positions of the maxima stored by PoolingOperation().
    *
    * @param error The backward error.
-   * @param output The pooled result.
-   * @param poolingIndices The pooled indices.
+   * @param output The unpooled error, which must be initialized.
+   * @param indices The position of each maximum within its window.
+   * @param maps The number of maps.
    */
   template<typename eT>
-  void Unpooling(const arma::Mat<eT>& error,
-                 arma::Mat<eT>& output,
-                 arma::Mat<eT>& poolingIndices)
+  void Unpooling(const eT* error,
+                 eT* output,
+                 const unsigned short* indices,
+                 const size_t maps)
   {
-    for (size_t i = 0; i < poolingIndices.n_elem; ++i)
+    const size_t windowWidth = kW - offset;
+
+    for (size_t s = 0; s < maps; ++s, output += inputWidth * inputHeight)
     {
-      output(poolingIndices(i)) += error(i);
+      for (size_t j = 0, colidx = 0; j < outputHeight; ++j, colidx += dH)
+      {
+        for (size_t i = 0, rowidx = 0; i < outputWidth; ++i, rowidx += dW)
+        {
+          const size_t position = *indices++;
+          output[rowidx + position % windowWidth +
+              (colidx + position / windowWidth) * inputWidth] += *error++;
+        }
+      }
     }
   }
 
@@ -211,9 +254,6 @@ class MaxPooling
   //! Locally-stored height of the stride operation.
   size_t dH;
 
-  //! Locally-stored reset parameter used to initialize the module once.
-  bool reset;
-
   //! Rounding operation used.
   bool floor;
 
@@ -235,18 +275,6 @@ class MaxPooling
   //! If true use maximum a posteriori during the forward pass.
   bool deterministic;
 
-  //! Locally-stored output parameter.
-  arma::cube outputTemp;
-
-  //! Locally-stored transformed input parameter.
-  arma::cube inputTemp;
-
-  //! Locally-stored transformed output parameter.
-  arma::cube gTemp;
-
-  //! Locally-stored pooling strategy.
-  MaxPoolingRule pooling;
-
   //! Locally-stored delta object.
   OutputDataType delta;
 
@@ -259,16 +287,16 @@ class MaxPooling
   //! Locally-stored output parameter object.
   OutputDataType outputParameter;
 
-  //! Locally-stored indices matrix parameter.
-  arma::Mat<size_t> indices;
-
-  //! Locally-stored indices column parameter.
-  arma::Col<size_t> indicesCol;
-
-  //! Locally-stored pooling indicies.
-  std::vector<arma::cube> poolingIndices;
+  //! Locally-stored positions of the maxima of each forward pass.
+  std::vector<std::vector<unsigned short> > poolingIndices;
 }; // class MaxPooling
 
+//! MaxPooling layers can process a batch of points at once.
+template<typename InputDataType, typename OutputDataType>
+class LayerTraits<MaxPooling<InputDataType, OutputDataType> > :
+    public BatchLayerTraits
+{ };
+
 } // namespace ann
 } // namespace mlpack
 
@@ -36,7 +36,6 @@ MaxPooling<InputDataType, OutputDataType>::MaxPooling(
     kH(kH),
     dW(dW),
     dH(dH),
-    reset(false),
     floor(floor),
     offset(0),
     inputWidth(0),
@@ -45,7 +44,12 @@ MaxPooling<InputDataType, OutputDataType>::MaxPooling(
     outputHeight(0),
     deterministic(false)
 {
-  // Nothing to do here.
+  // The positions of the maxima are stored as unsigned shorts.
+  if (kW * kH > 65536)
+  {
+    throw std::invalid_argument("MaxPooling::MaxPooling(): the pooling window "
+        "must have at most 65536 elements");
+  }
 }
 
 template<typename InputDataType, typename OutputDataType>
@@ -54,7 +58,6 @@ void MaxPooling<InputDataType, OutputDataType>::Forward(
   const arma::Mat<eT>&& input, arma::Mat<eT>&& output)
 {
   const size_t slices = input.n_elem / (inputWidth * inputHeight);
-  inputTemp = arma::cube(input.memptr(), inputWidth, inputHeight, slices);
 
   if (floor)
   {
@@ -69,44 +72,37 @@ void MaxPooling<InputDataType, OutputDataType>::Forward(
     offset = 1;
   }
 
-  outputTemp = arma::zeros<arma::Cube<eT> >(outputWidth, outputHeight,
-      slices);
+  output.set_size(outputWidth * outputHeight * slices / input.n_cols,
+      input.n_cols);
 
+  unsigned short* indices = NULL;
   if (!deterministic)
   {
-    poolingIndices.push_back(outputTemp);
+    poolingIndices.push_back(std::vector<unsigned short>(output.n_elem));
+    indices = poolingIndices.back().data();
   }
 
-  if (!reset)
-  {
-    size_t elements = inputWidth * inputHeight;
-    indicesCol = arma::linspace<arma::Col<size_t> >(0, (elements - 1),
-        elements);
-
-    indices = arma::Mat<size_t>(indicesCol.memptr(), inputWidth, inputHeight);
+  // The unrolled kernels can only be used if every window lies within the
+  // input.
+  const size_t windowWidth = kW - offset;
+  const size_t windowHeight = kH - offset;
+  const bool fits = (outputWidth - 1) * dW + windowWidth <= inputWidth &&
+      (outputHeight - 1) * dH + windowHeight <= inputHeight;
 
-    reset = true;
+  if (fits && windowWidth == 2 && windowHeight == 2)
+  {
+    PoolingOperation<2, 2>(input.memptr(), output.memptr(), indices, slices);
   }
-
-  for (size_t s = 0; s < inputTemp.n_slices; s++)
+  else if (fits && windowWidth == 3 && windowHeight == 3)
   {
-    if (!deterministic)
-    {
-      PoolingOperation(inputTemp.slice(s), outputTemp.slice(s),
-        poolingIndices.back().slice(s));
-    }
-    else
-    {
-      PoolingOperation(inputTemp.slice(s), outputTemp.slice(s),
-          inputTemp.slice(s));
-    }
+    PoolingOperation<3, 3>(input.memptr(), output.memptr(), indices, slices);
+  }
+  else
+  {
+    PoolingOperation<0, 0>(input.memptr(), output.memptr(), indices, slices);
   }
 
-  output = arma::Mat<eT>(outputTemp.memptr(), outputTemp.n_elem, 1);
-
-  outputWidth = outputTemp.n_rows;
-  outputHeight = outputTemp.n_cols;
-  outSize = slices;
+  outSize = slices / input.n_cols;
 }
 
 template<typename InputDataType, typename OutputDataType>
@@ -114,21 +110,13 @@ template<typename eT>
 void MaxPooling<InputDataType, OutputDataType>::Backward(
     const arma::Mat<eT>&& /* input */, arma::Mat<eT>&& gy, arma::Mat<eT>&& g)
 {
-  arma::cube mappedError = arma::cube(gy.memptr(), outputWidth,
-      outputHeight, outSize);
+  const size_t points = gy.n_elem / (outputWidth * outputHeight * outSize);
+  g.zeros(inputWidth * inputHeight * outSize, points);
 
-  gTemp = arma::zeros<arma::cube>(inputTemp.n_rows,
-      inputTemp.n_cols, inputTemp.n_slices);
-
-  for (size_t s = 0; s < mappedError.n_slices; s++)
-  {
-    Unpooling(mappedError.slice(s), gTemp.slice(s),
-        poolingIndices.back().slice(s));
-  }
+  Unpooling(gy.memptr(), g.memptr(), poolingIndices.back().data(),
+      outSize * points);
 
   poolingIndices.pop_back();
-
-  g = arma::mat(gTemp.memptr(), gTemp.n_elem, 1);
 }
 
 template<typename InputDataType, typename OutputDataType>
@@ -15,11 +15,16 @@
 
 #include <mlpack/prereqs.hpp>
 
+#include "layer_traits.hpp"
+
 namespace mlpack {
 namespace ann /** Artificial Neural Network. */ {
 
 /**
- * Implementation of the MeanPooling.
+ * Implementation of the MeanPooling.  The input holds the maps one after the
+ * other, each stored column-major with inputWidth rows, and may hold a batch
+ * of points, one per column; all the maps of the batch are pooled in one pass
+ * over the memory.  The 2x2 and 3x3 windows have their own unrolled kernels.
  *
  * @tparam InputDataType Type of the input data (arma::colvec, arma::mat,
  *         arma::sp_mat or arma::cube).
@@ -122,57 +127,75 @@ class MeanPooling
 
  private:
   /**
-   * Apply pooling to the input and store the results.
+   * Apply mean pooling to the given maps, stored one after the other.  If
+   * FixedWidth and FixedHeight are not 0, they are the size of the windows,
+   * and every window must lie within the input; the loops over a window then
+   * have a fixed length, so that they can be unrolled.
    *
-   * @param input The input to be apply the pooling rule.
-   * @param output The pooled result.
+   * @param input The maps to pool.
+   * @param output The pooled maps.
+   * @param maps The number of maps.
    */
-  template<typename eT>
-  void Pooling(const arma::Mat<eT>& input, arma::Mat<eT>& output)
+  template<size_t FixedWidth, size_t FixedHeight, typename eT>
+  void Pooling(const eT* input, eT* output, const size_t maps)
   {
-    const size_t rStep = kW;
-    const size_t cStep = kH;
+    const size_t windowWidth = FixedWidth ? FixedWidth : kW - offset;
+    const size_t windowHeight = FixedHeight ? FixedHeight : kH - offset;
 
-    for (size_t j = 0, colidx = 0; j < output.n_cols; ++j, colidx += dH)
+    for (size_t s = 0; s < maps; ++s, input += inputWidth * inputHeight)
     {
-      for (size_t i = 0, rowidx = 0; i < output.n_rows; ++i, rowidx += dW)
+      for (size_t j = 0, colidx = 0; j < outputHeight; ++j, colidx += dH)
       {
-        arma::mat subInput = input(
-            arma::span(rowidx, rowidx + rStep - 1 - offset),
-            arma::span(colidx, colidx + cStep - 1 - offset));
-
-        output(i, j) = arma::mean(arma::mean(subInput));
+        const size_t cols = FixedHeight ? FixedHeight :
+            std::min(windowHeight, inputHeight - colidx);
+
+        for (size_t i = 0, rowidx = 0; i < outputWidth; ++i, rowidx += dW)
+        {
+          const size_t rows = FixedWidth ? FixedWidth :
+              std::min(windowWidth, inputWidth - rowidx);
+          const eT* window = input + rowidx + colidx * inputWidth;
+
+          eT sum = 0;
+          for (size_t kj = 0; kj < cols; ++kj)
+            for (size_t ki = 0; ki < rows; ++ki)
+              sum += window[ki + kj * inputWidth];
+
+          *output++ = sum / (rows * cols);
+        }
       }
     }
   }
 
   /**
-   * Apply unpooling to the input and store the results.
+   * Apply unpooling to the error of the given maps and add the results to the
+   * output: the error of each window is spread evenly over the window.
    *
-   * @param input The input to be apply the unpooling rule.
-   * @param output The pooled result.
+   * @param error The backward error.
+   * @param output The unpooled error, which must be initialized.
+   * @param maps The number of maps.
    */
   template<typename eT>
-  void Unpooling(const arma::Mat<eT>& input,
-                 const arma::Mat<eT>& error,
-                 arma::Mat<eT>& output)
+  void Unpooling(const eT* error, eT* output, const size_t maps)
   {
-    const size_t rStep = input.n_rows / error.n_rows - offset;
-    const size_t cStep = input.n_cols / error.n_cols - offset;
+    const size_t windowWidth = kW - offset;
+    const size_t windowHeight = kH - offset;
 
-    arma::Mat<eT> unpooledError;
-    for (size_t j = 0; j < input.n_cols - cStep; j += cStep)
+    for (size_t s = 0; s < maps; ++s, output += inputWidth * inputHeight)
     {
-      for (size_t i = 0; i < input.n_rows - rStep; i += rStep)
+      for (size_t j = 0, colidx = 0; j < outputHeight; ++j, colidx += dH)
       {
-        const arma::Mat<eT>& inputArea = input(arma::span(i, i + rStep - 1),
-            arma::span(j, j + cStep - 1));
-
-        unpooledError = arma::Mat<eT>(inputArea.n_rows, inputArea.n_cols);
-        unpooledError.fill(error(i / rStep, j / cStep) / inputArea.n_elem);
-
-        output(arma::span(i, i + rStep - 1 - offset),
-            arma::span(j, j + cStep - 1 - offset)) += unpooledError;
+        const size_t cols = std::min(windowHeight, inputHeight - colidx);
+
+        for (size_t i = 0, rowidx = 0; i < outputWidth; ++i, rowidx += dW)
+        {
+          const size_t rows = std::min(windowWidth, inputWidth - rowidx);
+          const eT value = *error++ / (rows * cols);
+
+          eT* window = output + rowidx + colidx * inputWidth;
+          for (size_t kj = 0; kj < cols; ++kj)
+            for (size_t ki = 0; ki < rows; ++ki)
+              window[ki + kj * inputWidth] += value;
+        }
       }
     }
   }
@@ -207,9 +230,6 @@ class MeanPooling
   //! Locally-stored output height.
   size_t outputHeight;
 
-  //! Locally-stored reset parameter used to initialize the module once.
-  bool reset;
-
   //! Rounding operation used.
   bool floor;
 
@@ -219,15 +239,6 @@ class MeanPooling
   //! Locally-stored stored rounding offset.
   size_t offset;
 
-  //! Locally-stored output parameter.
-  arma::cube outputTemp;
-
-  //! Locally-stored transformed input parameter.
-  arma::cube inputTemp;
-
-  //! Locally-stored transformed output parameter.
-  arma::cube gTemp;
-
   //! Locally-stored delta object.
   OutputDataType delta;
 
@@ -241,6 +252,12 @@ class MeanPooling
   OutputDataType outputParameter;
 }; // class MeanPooling
 
+//! MeanPooling layers can process a batch of points at once.
+template<typename InputDataType, typename OutputDataType>
+class LayerTraits<MeanPooling<InputDataType, OutputDataType> > :
+    public BatchLayerTraits
+{ };
+
 
 } // namespace ann
 } // namespace mlpack
@@ -40,7 +40,6 @@ MeanPooling<InputDataType, OutputDataType>::MeanPooling(
     inputHeight(0),
     outputWidth(0),
     outputHeight(0),
-    reset(false),
     floor(floor),
     deterministic(false),
     offset(0)
@@ -53,8 +52,7 @@ template<typename eT>
 void MeanPooling<InputDataType, OutputDataType>::Forward(
     const arma::Mat<eT>&& input, arma::Mat<eT>&& output)
 {
-  size_t slices = input.n_elem / (inputWidth * inputHeight);
-  inputTemp = arma::cube(input.memptr(), inputWidth, inputHeight, slices);
+  const size_t slices = input.n_elem / (inputWidth * inputHeight);
 
   if (floor)
   {
@@ -71,17 +69,24 @@ void MeanPooling<InputDataType, OutputDataType>::Forward(
     offset = 1;
   }
 
-  outputTemp = arma::zeros<arma::Cube<eT> >(outputWidth, outputHeight,
-      slices);
+  output.set_size(outputWidth * outputHeight * slices / input.n_cols,
+      input.n_cols);
 
-  for (size_t s = 0; s < inputTemp.n_slices; s++)
-    Pooling(inputTemp.slice(s), outputTemp.slice(s));
+  // The unrolled kernels can only be used if every window lies within the
+  // input.
+  const size_t windowWidth = kW - offset;
+  const size_t windowHeight = kH - offset;
+  const bool fits = (outputWidth - 1) * dW + windowWidth <= inputWidth &&
+      (outputHeight - 1) * dH + windowHeight <= inputHeight;
 
-  output = arma::Mat<eT>(outputTemp.memptr(), outputTemp.n_elem, 1);
+  if (fits && windowWidth == 2 && windowHeight == 2)
+    Pooling<2, 2>(input.memptr(), output.memptr(), slices);
+  else if (fits && windowWidth == 3 && windowHeight == 3)
+    Pooling<3, 3>(input.memptr(), output.memptr(), slices);
+  else
+    Pooling<0, 0>(input.memptr(), output.memptr(), slices);
 
-  outputWidth = outputTemp.n_rows;
-  outputHeight = outputTemp.n_cols;
-  outSize = slices;
+  outSize = slices / input.n_cols;
 }
 
 template<typename InputDataType, typename OutputDataType>
@@ -91,18 +96,10 @@ void MeanPooling<InputDataType, OutputDataType>::Backward(
   arma::Mat<eT>&& gy,
   arma::Mat<eT>&& g)
 {
-  arma::cube mappedError = arma::cube(gy.memptr(), outputWidth,
-      outputHeight, outSize);
-
-  gTemp = arma::zeros<arma::cube>(inputTemp.n_rows,
-      inputTemp.n_cols, inputTemp.n_slices);
-
-  for (size_t s = 0; s < mappedError.n_slices; s++)
-  {
-    Unpooling(inputTemp.slice(s), mappedError.slice(s), gTemp.slice(s));
-  }
+  const size_t points = gy.n_elem / (outputWidth * outputHeight * outSize);
+  g.zeros(inputWidth * inputHeight * outSize, points);
 
-  g = arma::mat(gTemp.memptr(), gTemp.n_elem, 1);
+  Unpooling(gy.memptr(), g.memptr(), outSize * points);
 }
 
 template<typename InputDataType, typename OutputDataType>
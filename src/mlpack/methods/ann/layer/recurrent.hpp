@@ -106,6 +106,11 @@ class Recurrent
   //! Modify the value of the deterministic parameter.
   bool& Deterministic() { return deterministic; }
 
+  //! Get the maximum number of steps to backpropagate through time (BPTT).
+  size_t Rho() const { return rho; }
+  //! Modify the maximum number of steps to backpropagate through time (BPTT).
+  size_t& Rho() { return rho; }
+
   //! Get the parameters.
   OutputDataType const& Parameters() const { return parameters; }
   //! Modify the parameters.
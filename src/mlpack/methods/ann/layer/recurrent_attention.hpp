@@ -43,6 +43,11 @@ namespace ann /** Artificial Neural Network. */ {
  * }
  * @endcode
  *
+ * The module processes a whole batch of images (one per column) at once: at
+ * each step, the recurrent module gets the images followed by the locations
+ * chosen by the action module (the batched input of the Glimpse layer), so
+ * the layers of both modules run one matrix product per step for the batch.
+ *
  * @tparam InputDataType Type of the input data (arma::colvec, arma::mat,
  *         arma::sp_mat or arma::cube).
  * @tparam OutputDataType Type of the output data (arma::colvec, arma::mat,
@@ -249,6 +254,13 @@ class RecurrentAttention
   //! Locally-stored initial action input.
   arma::mat initialInput;
 
+  //! Locally-stored input of the recurrent module: the images of the batch
+  //! followed by their locations.
+  arma::mat glimpseInput;
+
+  //! Locally-stored number of rows of the input.
+  size_t inputRows;
+
   //! Locally-stored reset visitor.
   ResetVisitor resetVisitor;
 
@@ -39,7 +39,8 @@ RecurrentAttention<InputDataType, OutputDataType>::RecurrentAttention(
     rho(rho),
     forwardStep(0),
     backwardStep(0),
-    deterministic(false)
+    deterministic(false),
+    inputRows(0)
 {
   network.push_back(rnnModule);
   network.push_back(actionModule);
@@ -50,12 +51,14 @@ template<typename eT>
 void RecurrentAttention<InputDataType, OutputDataType>::Forward(
     arma::Mat<eT>&& input, arma::Mat<eT>&& output)
 {
-  // Initialize the action input.
-  if (initialInput.is_empty())
+  // Initialize the action input, one column per point of the batch.
+  if (initialInput.n_rows != outSize || initialInput.n_cols != input.n_cols)
   {
-    initialInput = arma::zeros(outSize, input.n_cols);
+    initialInput.zeros(outSize, input.n_cols);
   }
 
+  inputRows = input.n_rows;
+
   // Propagate through the action and recurrent module.
   for (forwardStep = 0; forwardStep < rho; ++forwardStep)
   {
@@ -72,12 +75,17 @@ void RecurrentAttention<InputDataType, OutputDataType>::Forward(
           outputParameterVisitor, actionModule))), actionModule);
     }
 
-    // Initialize the glimpse input.
-    arma::mat glimpseInput = arma::zeros(input.n_elem, 2);
-    glimpseInput.col(0) = input;
-    glimpseInput.submat(0, 1, boost::apply_visitor(outputParameterVisitor,
-        actionModule).n_elem - 1, 1) = boost::apply_visitor(
-        outputParameterVisitor, actionModule);
+    // The glimpse input of each point holds its image followed by the location
+    // chosen by the action module, so each step processes the whole batch at
+    // once; the images are only copied in the first step.
+    const arma::mat& location = boost::apply_visitor(outputParameterVisitor,
+        actionModule);
+    if (forwardStep == 0)
+    {
+      glimpseInput.set_size(input.n_rows + location.n_rows, input.n_cols);
+      glimpseInput.rows(0, input.n_rows - 1) = input;
+    }
+    glimpseInput.rows(input.n_rows, glimpseInput.n_rows - 1) = location;
 
     boost::apply_visitor(ForwardVisitor(std::move(glimpseInput),
         std::move(boost::apply_visitor(outputParameterVisitor, rnnModule))),
@@ -115,11 +123,15 @@ void RecurrentAttention<InputDataType, OutputDataType>::Backward(
 
     intermediateGradient = arma::zeros(weights, 1);
     attentionGradient = arma::zeros(weights, 1);
+  }
 
-    // Initialize the action error.
-    actionError = arma::zeros(
-      boost::apply_visitor(outputParameterVisitor, actionModule).n_rows,
-      boost::apply_visitor(outputParameterVisitor, actionModule).n_cols);
+  // Initialize the action error for the size of the batch.
+  const arma::mat& actionOutput = boost::apply_visitor(outputParameterVisitor,
+      actionModule);
+  if (actionError.n_rows != actionOutput.n_rows ||
+      actionError.n_cols != actionOutput.n_cols)
+  {
+    actionError.zeros(actionOutput.n_rows, actionOutput.n_cols);
   }
 
   // Propagate the attention gradients.
@@ -168,13 +180,15 @@ void RecurrentAttention<InputDataType, OutputDataType>::Backward(
         outputParameterVisitor, rnnModule)), std::move(recurrentError),
         std::move(rnnDelta)), rnnModule);
 
+    // The error of the images is the part of the delta of the glimpse input
+    // before the locations.
     if (backwardStep == 0)
     {
-      g = rnnDelta.col(1);
+      g = rnnDelta.rows(0, inputRows - 1);
     }
     else
     {
-      g += rnnDelta.col(1);
+      g += rnnDelta.rows(0, inputRows - 1);
     }
 
     IntermediateGradient();
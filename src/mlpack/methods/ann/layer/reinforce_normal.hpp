@@ -9,6 +9,7 @@
 #define MLPACK_METHODS_ANN_LAYER_REINFORCE_NORMAL_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <mlpack/core/math/random.hpp>
 
 namespace mlpack {
 namespace ann /** Artificial Neural Network. */ {
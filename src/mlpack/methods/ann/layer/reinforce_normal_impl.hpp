@@ -29,8 +29,9 @@ void ReinforceNormal<InputDataType, OutputDataType>::Forward(
   if (!deterministic)
   {
     // Multiply by standard deviations and re-center the means to the mean.
-    output = arma::randn<arma::Mat<eT> >(input.n_rows, input.n_cols) *
-        stdev + input;
+    output.set_size(input.n_rows, input.n_cols);
+    math::ThreadRandomStream().Randn(output);
+    output = output * stdev + input;
 
     moduleInputParameter.push_back(input);
   }
@@ -0,0 +1,184 @@
+/**
+ * @file layer_profiler.hpp
+ *
+ * Definition of the LayerProfiler class, which records the time spent in each
+ * layer of a network during training.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_LAYER_PROFILER_HPP
+#define MLPACK_METHODS_ANN_LAYER_PROFILER_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include <chrono>
+
+#include "visitor/layer_name_visitor.hpp"
+#include "visitor/output_height_visitor.hpp"
+#include "visitor/output_width_visitor.hpp"
+#include "visitor/weight_size_visitor.hpp"
+
+#include <mlpack/methods/ann/layer/layer_types.hpp>
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+/**
+ * A LayerProfiler records, for each layer of a network, the time spent in its
+ * forward, backward and gradient passes, together with estimates of the
+ * floating point operations and the bytes of memory they touch, summed over
+ * all the passes since the profiler was enabled.  Unlike the global Timer, a
+ * record costs two reads of a steady clock and a few additions, so the
+ * profiler can be left enabled for whole training runs; when it is disabled,
+ * the passes only check a flag.
+ *
+ * The estimates come from the shape of the data: a pass of a layer with
+ * weights takes two operations (a multiplication and an addition) per weight,
+ * per point and per element of an output map (one element for layers without
+ * maps), and a pass of a layer without weights takes one operation per output
+ * element.  The bytes are those of the input, the output and the weights.
+ *
+ * @code
+ * model.Profiler().Enable(true);
+ * model.Train(trainData, trainLabels, optimizer);
+ * model.Profiler().Report(std::cout);
+ *
+ * std::ofstream trace("trace.json");
+ * model.Profiler().ChromeTrace(trace);
+ * @endcode
+ *
+ * The trace can be opened with chrome://tracing; it holds one event per pass
+ * of a layer, so it is only recorded if asked for when the profiler is
+ * enabled.
+ */
+class LayerProfiler
+{
+ public:
+  //! The passes of a layer.
+  enum Phase
+  {
+    FORWARD = 0,
+    BACKWARD = 1,
+    GRADIENT = 2
+  };
+
+  //! The totals of one layer.
+  struct LayerRecord
+  {
+    //! The name of the class of the layer.
+    std::string name;
+    //! The number of passes of each phase.
+    size_t calls[3];
+    //! The time spent in each phase, in seconds.
+    double time[3];
+    //! The estimated floating point operations of each phase.
+    double flops[3];
+    //! The estimated bytes touched by each phase.
+    double bytes[3];
+  };
+
+  //! Create a disabled profiler.
+  LayerProfiler();
+
+  /**
+   * Start recording passes.  The records already made are kept.
+   *
+   * @param trace Whether to also record each pass for ChromeTrace().
+   */
+  void Enable(const bool trace = false);
+
+  //! Stop recording passes.
+  void Disable() { enabled = false; }
+
+  //! Get whether passes are recorded.
+  bool Enabled() const { return enabled; }
+
+  //! Forget all records.
+  void Reset();
+
+  //! Start timing a pass.
+  void Start() { start = Clock::now(); }
+
+  /**
+   * Record the pass of the given layer started by the last call to Start().
+   *
+   * @param index Index of the layer in the network.
+   * @param phase Phase of the pass.
+   * @param layer The layer.
+   * @param input Input of the pass.
+   * @param output Output of the pass.
+   */
+  void Stop(const size_t index,
+            const Phase phase,
+            LayerTypes& layer,
+            const arma::mat& input,
+            const arma::mat& output);
+
+  //! Get the records of the layers, in the order of the network.
+  const std::vector<LayerRecord>& Records() const { return records; }
+
+  /**
+   * Write a table of the records of the layers: for each layer, the number of
+   * passes, the total time of each phase, the share of the total time and the
+   * achieved floating point and memory rates.
+   *
+   * @param stream Stream to write the table to.
+   */
+  void Report(std::ostream& stream) const;
+
+  /**
+   * Write the recorded passes as a trace in the Chrome trace event format (a
+   * JSON object), with one complete event per pass.  The trace is empty
+   * unless the profiler was enabled with tracing.
+   *
+   * @param stream Stream to write the trace to.
+   */
+  void ChromeTrace(std::ostream& stream) const;
+
+ private:
+  //! The clock of the records.
+  typedef std::chrono::steady_clock Clock;
+
+  //! One recorded pass.
+  struct TraceEvent
+  {
+    //! The index of the layer.
+    size_t index;
+    //! The phase of the pass.
+    Phase phase;
+    //! The start of the pass, in microseconds since the profiler was
+    //! enabled.
+    double start;
+    //! The duration of the pass, in microseconds.
+    double duration;
+  };
+
+  //! Whether passes are recorded.
+  bool enabled;
+
+  //! Whether each pass is recorded for the trace.
+  bool trace;
+
+  //! The time the profiler was first enabled.
+  Clock::time_point origin;
+
+  //! The start of the current pass.
+  Clock::time_point start;
+
+  //! The records of the layers.
+  std::vector<LayerRecord> records;
+
+  //! The recorded passes.
+  std::vector<TraceEvent> events;
+};
+
+} // namespace ann
+} // namespace mlpack
+
+// Include implementation.
+#include "layer_profiler_impl.hpp"
+
+#endif
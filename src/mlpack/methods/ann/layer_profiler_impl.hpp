@@ -0,0 +1,167 @@
+/**
+ * @file layer_profiler_impl.hpp
+ *
+ * Implementation of the LayerProfiler class, which records the time spent in
+ * each layer of a network during training.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_LAYER_PROFILER_IMPL_HPP
+#define MLPACK_METHODS_ANN_LAYER_PROFILER_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "layer_profiler.hpp"
+
+#include <iomanip>
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+inline LayerProfiler::LayerProfiler() :
+    enabled(false),
+    trace(false),
+    origin(Clock::now())
+{
+  // Nothing to do here.
+}
+
+inline void LayerProfiler::Enable(const bool trace)
+{
+  if (records.empty() && events.empty())
+    origin = Clock::now();
+
+  this->trace = trace;
+  enabled = true;
+}
+
+inline void LayerProfiler::Reset()
+{
+  records.clear();
+  events.clear();
+  origin = Clock::now();
+}
+
+inline void LayerProfiler::Stop(const size_t index,
+                                const Phase phase,
+                                LayerTypes& layer,
+                                const arma::mat& input,
+                                const arma::mat& output)
+{
+  const Clock::time_point end = Clock::now();
+
+  if (records.size() <= index)
+    records.resize(index + 1);
+
+  LayerRecord& record = records[index];
+  if (record.name.empty())
+    record.name = boost::apply_visitor(LayerNameVisitor(), layer);
+
+  const double seconds = std::chrono::duration<double>(end - start).count();
+
+  // The weights are used once per element of the output maps of the layer.
+  const size_t weights = boost::apply_visitor(WeightSizeVisitor(), layer);
+  const size_t width = boost::apply_visitor(OutputWidthVisitor(), layer);
+  const size_t height = boost::apply_visitor(OutputHeightVisitor(), layer);
+  const double mapSize = (width > 0 && height > 0) ? (double) width * height :
+      1.0;
+
+  double flops = 0;
+  if (weights > 0)
+    flops = 2.0 * weights * input.n_cols * mapSize;
+  else if (phase != GRADIENT)
+    flops = output.n_elem;
+
+  ++record.calls[phase];
+  record.time[phase] += seconds;
+  record.flops[phase] += flops;
+  record.bytes[phase] += sizeof(double) *
+      ((double) input.n_elem + output.n_elem + weights);
+
+  if (trace)
+  {
+    TraceEvent event;
+    event.index = index;
+    event.phase = phase;
+    event.start = std::chrono::duration<double, std::micro>(start - origin)
+        .count();
+    event.duration = 1e6 * seconds;
+    events.push_back(event);
+  }
+}
+
+inline void LayerProfiler::Report(std::ostream& stream) const
+{
+  double totalTime = 0;
+  for (size_t i = 0; i < records.size(); ++i)
+    totalTime += records[i].time[0] + records[i].time[1] + records[i].time[2];
+
+  const std::ios::fmtflags flags = stream.flags();
+  const std::streamsize precision = stream.precision();
+  stream << std::fixed << std::setprecision(3);
+
+  stream << std::setw(6) << "layer" << "  " << std::left << std::setw(20)
+      << "name" << std::right << std::setw(10) << "passes" << std::setw(14)
+      << "forward (ms)" << std::setw(15) << "backward (ms)" << std::setw(15)
+      << "gradient (ms)" << std::setw(9) << "share" << std::setw(10)
+      << "GFLOP/s" << std::setw(9) << "GB/s" << std::endl;
+
+  for (size_t i = 0; i < records.size(); ++i)
+  {
+    // Layers that were never passed through have no record.
+    const LayerRecord& record = records[i];
+    if (record.name.empty())
+      continue;
+
+    const double time = record.time[0] + record.time[1] + record.time[2];
+    const double flops = record.flops[0] + record.flops[1] + record.flops[2];
+    const double bytes = record.bytes[0] + record.bytes[1] + record.bytes[2];
+
+    stream << std::setw(6) << i << "  " << std::left << std::setw(20)
+        << record.name << std::right << std::setw(10) << record.calls[FORWARD]
+        << std::setw(14) << 1e3 * record.time[FORWARD] << std::setw(15)
+        << 1e3 * record.time[BACKWARD] << std::setw(15)
+        << 1e3 * record.time[GRADIENT] << std::setw(8)
+        << ((totalTime > 0) ? 100.0 * time / totalTime : 0.0) << "%"
+        << std::setw(10) << ((time > 0) ? 1e-9 * flops / time : 0.0)
+        << std::setw(9) << ((time > 0) ? 1e-9 * bytes / time : 0.0)
+        << std::endl;
+  }
+
+  stream << "total time: " << 1e3 * totalTime << " ms" << std::endl;
+
+  stream.flags(flags);
+  stream.precision(precision);
+}
+
+inline void LayerProfiler::ChromeTrace(std::ostream& stream) const
+{
+  static const char* phaseNames[3] = { "forward", "backward", "gradient" };
+
+  const std::ios::fmtflags flags = stream.flags();
+  const std::streamsize precision = stream.precision();
+  stream << std::fixed << std::setprecision(3);
+
+  stream << "{\"traceEvents\": [";
+  for (size_t i = 0; i < events.size(); ++i)
+  {
+    const TraceEvent& event = events[i];
+    stream << ((i == 0) ? "\n" : ",\n") << "  {\"name\": \""
+        << records[event.index].name << "\", \"cat\": \""
+        << phaseNames[event.phase] << "\", \"ph\": \"X\", \"ts\": "
+        << event.start << ", \"dur\": " << event.duration
+        << ", \"pid\": 0, \"tid\": 0, \"args\": {\"layer\": " << event.index
+        << "}}";
+  }
+  stream << "\n], \"displayTimeUnit\": \"ms\"}" << std::endl;
+
+  stream.flags(flags);
+  stream.precision(precision);
+}
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
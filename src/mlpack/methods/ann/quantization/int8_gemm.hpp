@@ -0,0 +1,113 @@
+/**
+ * @file int8_gemm.hpp
+ *
+ * Matrix product of 8-bit integer matrices with 32-bit accumulation, and the
+ * conversions between real and 8-bit values used by the quantized layers.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_QUANTIZATION_INT8_GEMM_HPP
+#define MLPACK_METHODS_ANN_QUANTIZATION_INT8_GEMM_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+/**
+ * Compute output = a^T * b for 8-bit matrices a and b, accumulating in 32-bit
+ * integers: output(i, j) is the dot product of column i of a and column j of
+ * b.  Both operands are read along their columns, so the inner loop runs over
+ * contiguous memory and is vectorized by the compiler.  A product of two
+ * values in [-127, 127] is at most 2^14 in magnitude, so the sums don't
+ * overflow for columns of fewer than 2^17 elements.
+ *
+ * @param a Left operand (k x m).
+ * @param b Right operand (k x n).
+ * @param output Product (m x n).
+ */
+inline void Int8Gemm(const arma::Mat<arma::s8>& a,
+                     const arma::Mat<arma::s8>& b,
+                     arma::Mat<arma::s32>& output)
+{
+  output.set_size(a.n_cols, b.n_cols);
+
+  const size_t k = a.n_rows;
+  for (size_t j = 0; j < b.n_cols; ++j)
+  {
+    const arma::s8* bCol = b.colptr(j);
+    arma::s32* outputCol = output.colptr(j);
+
+    // Four columns of a at a time, so each element of b is loaded once for
+    // four products.
+    size_t i = 0;
+    for (; i + 4 <= a.n_cols; i += 4)
+    {
+      const arma::s8* a0 = a.colptr(i);
+      const arma::s8* a1 = a.colptr(i + 1);
+      const arma::s8* a2 = a.colptr(i + 2);
+      const arma::s8* a3 = a.colptr(i + 3);
+
+      arma::s32 sum0 = 0, sum1 = 0, sum2 = 0, sum3 = 0;
+      for (size_t l = 0; l < k; ++l)
+      {
+        const arma::s32 value = bCol[l];
+        sum0 += a0[l] * value;
+        sum1 += a1[l] * value;
+        sum2 += a2[l] * value;
+        sum3 += a3[l] * value;
+      }
+
+      outputCol[i] = sum0;
+      outputCol[i + 1] = sum1;
+      outputCol[i + 2] = sum2;
+      outputCol[i + 3] = sum3;
+    }
+
+    for (; i < a.n_cols; ++i)
+    {
+      const arma::s8* aCol = a.colptr(i);
+      arma::s32 sum = 0;
+      for (size_t l = 0; l < k; ++l)
+        sum += aCol[l] * (arma::s32) bCol[l];
+
+      outputCol[i] = sum;
+    }
+  }
+}
+
+/**
+ * Round the given value to the nearest integer in [-127, 127] (the symmetric
+ * range of an 8-bit value).
+ */
+inline arma::s8 SaturateInt8(const double value)
+{
+  return (arma::s8) std::max(-127.0, std::min(127.0, std::round(value)));
+}
+
+/**
+ * Quantize the given real values to 8-bit values of the given scale (the real
+ * value of one step), with saturation.
+ *
+ * @param input Real values.
+ * @param scale Scale of the 8-bit values.
+ * @param output Quantized values.
+ */
+template<typename eT>
+void QuantizeInt8(const arma::Mat<eT>& input,
+                  const double scale,
+                  arma::Mat<arma::s8>& output)
+{
+  output.set_size(input.n_rows, input.n_cols);
+  const double inverse = 1.0 / scale;
+  for (size_t i = 0; i < input.n_elem; ++i)
+    output[i] = SaturateInt8(input[i] * inverse);
+}
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,206 @@
+/**
+ * @file quantized_layer.hpp
+ *
+ * Definition of the QuantizedLayer class, the 8-bit counterpart of a Linear,
+ * LinearNoBias or Convolution layer for inference.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_QUANTIZATION_QUANTIZED_LAYER_HPP
+#define MLPACK_METHODS_ANN_QUANTIZATION_QUANTIZED_LAYER_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include "int8_gemm.hpp"
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+/**
+ * A QuantizedLayer computes the forward pass of a trained Linear, LinearNoBias
+ * or Convolution layer with 8-bit weights and inputs.  The weights are
+ * quantized symmetrically with one scale for the whole layer (the largest
+ * absolute weight maps to 127), and the input with the scale given by the
+ * calibration (the largest absolute input seen maps to 127).  The products are
+ * accumulated in 32-bit integers, together with the bias quantized to the
+ * scale of the products, so the accumulator times OutputScale() is the real
+ * output of the layer.
+ *
+ * A convolution is lowered to a product of 8-bit matrices by copying the
+ * patches of each input point into the columns of a matrix (with the zero
+ * padding of the layer), in the same order as the filters of the layer.
+ */
+class QuantizedLayer
+{
+ public:
+  //! Create an empty layer (for loading).
+  QuantizedLayer();
+
+  /**
+   * Create the quantized counterpart of a fully connected layer.  The weights
+   * are set by Quantize().
+   *
+   * @param inSize Number of input units.
+   * @param outSize Number of output units.
+   * @param hasBias Whether the layer has a bias (Linear) or not
+   *     (LinearNoBias).
+   */
+  QuantizedLayer(const size_t inSize, const size_t outSize, const bool hasBias);
+
+  /**
+   * Create the quantized counterpart of a convolution layer.  The weights are
+   * set by Quantize().
+   *
+   * @param inSize Number of input maps.
+   * @param outSize Number of output maps.
+   * @param kW Width of the filters.
+   * @param kH Height of the filters.
+   * @param dW Stride of the filters in x-direction.
+   * @param dH Stride of the filters in y-direction.
+   * @param padW Padding of the input in x-direction.
+   * @param padH Padding of the input in y-direction.
+   * @param inputWidth Width of the input maps.
+   * @param inputHeight Height of the input maps.
+   */
+  QuantizedLayer(const size_t inSize,
+                 const size_t outSize,
+                 const size_t kW,
+                 const size_t kH,
+                 const size_t dW,
+                 const size_t dH,
+                 const size_t padW,
+                 const size_t padH,
+                 const size_t inputWidth,
+                 const size_t inputHeight);
+
+  /**
+   * Quantize the given trained parameters of the layer, in the layout of the
+   * Parameters() of the layer it stands for.
+   *
+   * @param parameters Parameters of the layer.
+   * @param inputScale The real value of one step of the quantized input.
+   */
+  void Quantize(const arma::mat& parameters, const double inputScale);
+
+  /**
+   * Quantize the given real input of the layer (one point per column).
+   *
+   * @param input Real input.
+   * @param output Quantized input.
+   */
+  void QuantizeInput(const arma::mat& input, arma::Mat<arma::s8>& output) const
+  {
+    QuantizeInt8(input, inputScale, output);
+  }
+
+  /**
+   * Requantize the given accumulator of the previous layer, whose values have
+   * the given scale, to the quantized input of this layer.
+   *
+   * @param accumulator Accumulator of the previous layer.
+   * @param scale Output scale of the previous layer.
+   * @param output Quantized input.
+   */
+  void RequantizeInput(const arma::Mat<arma::s32>& accumulator,
+                       const double scale,
+                       arma::Mat<arma::s8>& output) const
+  {
+    QuantizeInt8(accumulator, inputScale / scale, output);
+  }
+
+  /**
+   * Compute the accumulator of the given quantized input (one point per
+   * column).
+   *
+   * @param input Quantized input.
+   * @param output Accumulator of the output (one point per column).
+   */
+  void Forward(const arma::Mat<arma::s8>& input,
+               arma::Mat<arma::s32>& output) const;
+
+  //! Get the real value of one step of the quantized input.
+  double InputScale() const { return inputScale; }
+  //! Get the real value of one step of the accumulator.
+  double OutputScale() const { return weightScale * inputScale; }
+
+  //! Get the quantized weights (one column per output unit or map).
+  const arma::Mat<arma::s8>& Weights() const { return weight; }
+
+  //! Get the output width (0 for fully connected layers).
+  size_t OutputWidth() const { return outputWidth; }
+  //! Get the output height (0 for fully connected layers).
+  size_t OutputHeight() const { return outputHeight; }
+
+  /**
+   * Serialize the layer.
+   */
+  template<typename Archive>
+  void Serialize(Archive& ar, const unsigned int /* version */);
+
+ private:
+  //! Copy the patches of the given input point (with padding) into the columns
+  //! of the patch matrix.
+  void Im2Col(const arma::s8* input, arma::Mat<arma::s8>& patches) const;
+
+  //! Number of input units or maps.
+  size_t inSize;
+
+  //! Number of output units or maps.
+  size_t outSize;
+
+  //! Filter width (0 for fully connected layers).
+  size_t kW;
+
+  //! Filter height.
+  size_t kH;
+
+  //! Stride in x-direction.
+  size_t dW;
+
+  //! Stride in y-direction.
+  size_t dH;
+
+  //! Padding in x-direction.
+  size_t padW;
+
+  //! Padding in y-direction.
+  size_t padH;
+
+  //! Input width.
+  size_t inputWidth;
+
+  //! Input height.
+  size_t inputHeight;
+
+  //! Output width.
+  size_t outputWidth;
+
+  //! Output height.
+  size_t outputHeight;
+
+  //! Whether the layer has a bias.
+  bool hasBias;
+
+  //! The real value of one step of the quantized weights.
+  double weightScale;
+
+  //! The real value of one step of the quantized input.
+  double inputScale;
+
+  //! The quantized weights, one column per output unit or map.
+  arma::Mat<arma::s8> weight;
+
+  //! The bias, in steps of the accumulator.
+  arma::Col<arma::s32> bias;
+}; // class QuantizedLayer
+
+} // namespace ann
+} // namespace mlpack
+
+// Include implementation.
+#include "quantized_layer_impl.hpp"
+
+#endif
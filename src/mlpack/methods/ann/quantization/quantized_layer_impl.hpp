@@ -0,0 +1,226 @@
+/**
+ * @file quantized_layer_impl.hpp
+ *
+ * Implementation of the QuantizedLayer class, the 8-bit counterpart of a
+ * Linear, LinearNoBias or Convolution layer for inference.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_QUANTIZATION_QUANTIZED_LAYER_IMPL_HPP
+#define MLPACK_METHODS_ANN_QUANTIZATION_QUANTIZED_LAYER_IMPL_HPP
+
+// In case it hasn't yet been included.
+#include "quantized_layer.hpp"
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+inline QuantizedLayer::QuantizedLayer() :
+    inSize(0),
+    outSize(0),
+    kW(0),
+    kH(0),
+    dW(1),
+    dH(1),
+    padW(0),
+    padH(0),
+    inputWidth(0),
+    inputHeight(0),
+    outputWidth(0),
+    outputHeight(0),
+    hasBias(false),
+    weightScale(1),
+    inputScale(1)
+{
+  // Nothing to do here.
+}
+
+inline QuantizedLayer::QuantizedLayer(const size_t inSize,
+                                      const size_t outSize,
+                                      const bool hasBias) :
+    inSize(inSize),
+    outSize(outSize),
+    kW(0),
+    kH(0),
+    dW(1),
+    dH(1),
+    padW(0),
+    padH(0),
+    inputWidth(0),
+    inputHeight(0),
+    outputWidth(0),
+    outputHeight(0),
+    hasBias(hasBias),
+    weightScale(1),
+    inputScale(1)
+{
+  // Nothing to do here.
+}
+
+inline QuantizedLayer::QuantizedLayer(const size_t inSize,
+                                      const size_t outSize,
+                                      const size_t kW,
+                                      const size_t kH,
+                                      const size_t dW,
+                                      const size_t dH,
+                                      const size_t padW,
+                                      const size_t padH,
+                                      const size_t inputWidth,
+                                      const size_t inputHeight) :
+    inSize(inSize),
+    outSize(outSize),
+    kW(kW),
+    kH(kH),
+    dW(dW),
+    dH(dH),
+    padW(padW),
+    padH(padH),
+    inputWidth(inputWidth),
+    inputHeight(inputHeight),
+    outputWidth((inputWidth + 2 * padW - kW) / dW + 1),
+    outputHeight((inputHeight + 2 * padH - kH) / dH + 1),
+    hasBias(true),
+    weightScale(1),
+    inputScale(1)
+{
+  // Nothing to do here.
+}
+
+inline void QuantizedLayer::Quantize(const arma::mat& parameters,
+                                     const double inputScale)
+{
+  this->inputScale = inputScale;
+
+  // The weights come first in the parameters of all three layers, followed by
+  // the bias (one value per output unit or map).
+  const size_t weights = parameters.n_elem - (hasBias ? outSize : 0);
+  const double maxWeight = (weights == 0) ? 0.0 :
+      arma::abs(parameters.rows(0, weights - 1)).max();
+  weightScale = (maxWeight > 0) ? maxWeight / 127.0 : 1.0;
+
+  if (kW == 0)
+  {
+    // The weights of a fully connected layer are an outSize x inSize matrix;
+    // each output unit is a column of the quantized weights.
+    const arma::mat layerWeight(const_cast<double*>(parameters.memptr()),
+        outSize, inSize, false, true);
+    QuantizeInt8(arma::mat(layerWeight.t()), weightScale, weight);
+  }
+  else
+  {
+    // The filters of output map o (one per input map) are contiguous.
+    const arma::mat filters(const_cast<double*>(parameters.memptr()),
+        kW * kH * inSize, outSize, false, true);
+    QuantizeInt8(filters, weightScale, weight);
+  }
+
+  bias.reset();
+  if (hasBias)
+  {
+    const double scale = OutputScale();
+    bias.set_size(outSize);
+    for (size_t i = 0; i < outSize; ++i)
+    {
+      const double value = std::round(parameters[weights + i] / scale);
+      bias[i] = (arma::s32) std::max(-2147483647.0, std::min(2147483647.0,
+          value));
+    }
+  }
+}
+
+inline void QuantizedLayer::Forward(const arma::Mat<arma::s8>& input,
+                                    arma::Mat<arma::s32>& output) const
+{
+  if (kW == 0)
+  {
+    Int8Gemm(weight, input, output);
+    if (hasBias)
+      output.each_col() += bias;
+
+    return;
+  }
+
+  // Each point is lowered to a matrix of patches; the product with the
+  // filters holds one output map per column, which is the layout of the
+  // output of the layer.
+  const size_t mapSize = outputWidth * outputHeight;
+  output.set_size(mapSize * outSize, input.n_cols);
+
+  arma::Mat<arma::s8> patches;
+  arma::Mat<arma::s32> maps;
+  for (size_t i = 0; i < input.n_cols; ++i)
+  {
+    Im2Col(input.colptr(i), patches);
+    Int8Gemm(patches, weight, maps);
+
+    arma::s32* outputPtr = output.colptr(i);
+    for (size_t o = 0; o < outSize; ++o)
+    {
+      const arma::s32* mapPtr = maps.colptr(o);
+      for (size_t j = 0; j < mapSize; ++j)
+        outputPtr[o * mapSize + j] = mapPtr[j] + bias[o];
+    }
+  }
+}
+
+inline void QuantizedLayer::Im2Col(const arma::s8* input,
+                                   arma::Mat<arma::s8>& patches) const
+{
+  // Column i + j * outputWidth holds the patch of output element (i, j), and
+  // row ki + kj * kW + s * kW * kH holds element (ki, kj) of input map s.
+  patches.set_size(kW * kH * inSize, outputWidth * outputHeight);
+
+  arma::s8* patchPtr = patches.memptr();
+  for (size_t j = 0; j < outputHeight; ++j)
+  {
+    for (size_t i = 0; i < outputWidth; ++i)
+    {
+      for (size_t s = 0; s < inSize; ++s)
+      {
+        const arma::s8* map = input + s * inputWidth * inputHeight;
+        for (size_t kj = 0; kj < kH; ++kj)
+        {
+          // The input coordinates, shifted by the padding.
+          const size_t y = j * dH + kj;
+          const bool rowInside = (y >= padH) && (y - padH < inputHeight);
+          for (size_t ki = 0; ki < kW; ++ki, ++patchPtr)
+          {
+            const size_t x = i * dW + ki;
+            *patchPtr = (rowInside && x >= padW && x - padW < inputWidth) ?
+                map[(x - padW) + (y - padH) * inputWidth] : 0;
+          }
+        }
+      }
+    }
+  }
+}
+
+template<typename Archive>
+void QuantizedLayer::Serialize(Archive& ar, const unsigned int /* version */)
+{
+  ar & data::CreateNVP(inSize, "inSize");
+  ar & data::CreateNVP(outSize, "outSize");
+  ar & data::CreateNVP(kW, "kW");
+  ar & data::CreateNVP(kH, "kH");
+  ar & data::CreateNVP(dW, "dW");
+  ar & data::CreateNVP(dH, "dH");
+  ar & data::CreateNVP(padW, "padW");
+  ar & data::CreateNVP(padH, "padH");
+  ar & data::CreateNVP(inputWidth, "inputWidth");
+  ar & data::CreateNVP(inputHeight, "inputHeight");
+  ar & data::CreateNVP(outputWidth, "outputWidth");
+  ar & data::CreateNVP(outputHeight, "outputHeight");
+  ar & data::CreateNVP(hasBias, "hasBias");
+  ar & data::CreateNVP(weightScale, "weightScale");
+  ar & data::CreateNVP(inputScale, "inputScale");
+  ar & data::CreateNVP(weight, "weight");
+  ar & data::CreateNVP(bias, "bias");
+}
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,72 @@
+/**
+ * @file quantized_layer_visitor.hpp
+ *
+ * This file provides an abstraction to create the QuantizedLayer counterpart
+ * of the layers that have one.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_QUANTIZATION_QUANTIZED_LAYER_VISITOR_HPP
+#define MLPACK_METHODS_ANN_QUANTIZATION_QUANTIZED_LAYER_VISITOR_HPP
+
+#include <mlpack/methods/ann/layer/layer_types.hpp>
+#include <mlpack/methods/ann/layer/convolution.hpp>
+#include <mlpack/methods/ann/layer/linear.hpp>
+#include <mlpack/methods/ann/layer/linear_no_bias.hpp>
+
+#include "quantized_layer.hpp"
+
+#include <boost/variant.hpp>
+
+namespace mlpack {
+namespace ann {
+
+/**
+ * QuantizedLayerVisitor creates the QuantizedLayer counterpart (without
+ * weights) of the given module, if it is a Linear, LinearNoBias or
+ * Convolution layer, and returns whether it did.
+ */
+class QuantizedLayerVisitor : public boost::static_visitor<bool>
+{
+ public:
+  //! Store the counterpart into the given quantized layer.
+  QuantizedLayerVisitor(QuantizedLayer& quantizedLayer);
+
+  //! Modules without a counterpart.
+  template<typename LayerType>
+  bool operator()(LayerType* layer) const;
+
+  //! Create the counterpart of a Linear layer.
+  template<typename InputDataType, typename OutputDataType>
+  bool operator()(Linear<InputDataType, OutputDataType>* layer) const;
+
+  //! Create the counterpart of a LinearNoBias layer.
+  template<typename InputDataType, typename OutputDataType>
+  bool operator()(LinearNoBias<InputDataType, OutputDataType>* layer) const;
+
+  //! Create the counterpart of a Convolution layer.
+  template<
+      typename ForwardConvolutionRule,
+      typename BackwardConvolutionRule,
+      typename GradientConvolutionRule,
+      typename InputDataType,
+      typename OutputDataType
+  >
+  bool operator()(Convolution<ForwardConvolutionRule, BackwardConvolutionRule,
+      GradientConvolutionRule, InputDataType, OutputDataType>* layer) const;
+
+ private:
+  //! The quantized layer to store the counterpart into.
+  QuantizedLayer& quantizedLayer;
+};
+
+} // namespace ann
+} // namespace mlpack
+
+// Include implementation.
+#include "quantized_layer_visitor_impl.hpp"
+
+#endif
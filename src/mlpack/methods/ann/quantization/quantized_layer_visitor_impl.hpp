@@ -0,0 +1,74 @@
+/**
+ * @file quantized_layer_visitor_impl.hpp
+ *
+ * Implementation of the QuantizedLayerVisitor class, which creates the
+ * QuantizedLayer counterpart of the layers that have one.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_QUANTIZATION_QUANTIZED_LAYER_VISITOR_IMPL_HPP
+#define MLPACK_METHODS_ANN_QUANTIZATION_QUANTIZED_LAYER_VISITOR_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "quantized_layer_visitor.hpp"
+
+namespace mlpack {
+namespace ann {
+
+//! QuantizedLayerVisitor visitor class.
+inline QuantizedLayerVisitor::QuantizedLayerVisitor(
+    QuantizedLayer& quantizedLayer) :
+    quantizedLayer(quantizedLayer)
+{
+  /* Nothing to do here. */
+}
+
+template<typename LayerType>
+inline bool QuantizedLayerVisitor::operator()(LayerType* /* layer */) const
+{
+  return false;
+}
+
+template<typename InputDataType, typename OutputDataType>
+inline bool QuantizedLayerVisitor::operator()(
+    Linear<InputDataType, OutputDataType>* layer) const
+{
+  quantizedLayer = QuantizedLayer(layer->InputSize(), layer->OutputSize(),
+      true);
+  return true;
+}
+
+template<typename InputDataType, typename OutputDataType>
+inline bool QuantizedLayerVisitor::operator()(
+    LinearNoBias<InputDataType, OutputDataType>* layer) const
+{
+  quantizedLayer = QuantizedLayer(layer->InputSize(), layer->OutputSize(),
+      false);
+  return true;
+}
+
+template<
+    typename ForwardConvolutionRule,
+    typename BackwardConvolutionRule,
+    typename GradientConvolutionRule,
+    typename InputDataType,
+    typename OutputDataType
+>
+inline bool QuantizedLayerVisitor::operator()(
+    Convolution<ForwardConvolutionRule, BackwardConvolutionRule,
+    GradientConvolutionRule, InputDataType, OutputDataType>* layer) const
+{
+  quantizedLayer = QuantizedLayer(layer->InputSize(), layer->OutputSize(),
+      layer->KernelWidth(), layer->KernelHeight(), layer->StrideWidth(),
+      layer->StrideHeight(), layer->PadWidth(), layer->PadHeight(),
+      layer->InputWidth(), layer->InputHeight());
+  return true;
+}
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,170 @@
+/**
+ * @file quantized_ffn.hpp
+ *
+ * Definition of the QuantizedFFN class, the 8-bit inference counterpart of a
+ * trained feed forward network.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_QUANTIZED_FFN_HPP
+#define MLPACK_METHODS_ANN_QUANTIZED_FFN_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include "ffn.hpp"
+
+#include "quantization/quantized_layer.hpp"
+#include "quantization/quantized_layer_visitor.hpp"
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+/**
+ * Post-training quantization of a feed forward network for inference.  The
+ * Linear, LinearNoBias and Convolution layers of a trained FFN are replaced by
+ * QuantizedLayers: their weights are stored as 8-bit integers with one scale
+ * per layer, their inputs are quantized with a per-layer scale calibrated on
+ * sample data (the largest absolute input seen by the layer), and the forward
+ * pass multiplies 8-bit matrices with 32-bit accumulation.  The output of a
+ * quantized layer that feeds another quantized layer is requantized directly
+ * to the input scale of the next layer; otherwise it is converted back to
+ * real values for the other layers, which run as before.
+ *
+ * The quantized network is independent of the network it was created from.
+ * It is serialized compactly: the quantized layers store 8-bit weights, and
+ * only the other layers store real parameters.  The layers themselves aren't
+ * serialized (as for FFN), so a quantized network is loaded into one created
+ * from a network with the same layers:
+ *
+ * @code
+ * FFN<> model;
+ * // ... add layers, and train the model ...
+ * QuantizedFFN<> quantized(model, calibrationData);
+ * data::Save("model.xml", "model", quantized);
+ *
+ * FFN<> sameLayers;
+ * // ... add the same layers (the model doesn't need to be trained) ...
+ * QuantizedFFN<> loaded(sameLayers);
+ * data::Load("model.xml", "model", loaded);
+ * loaded.Predict(testData, predictions);
+ * @endcode
+ *
+ * @tparam OutputLayerType The output layer type of the network.
+ * @tparam InitializationRuleType The initialization rule of the network.
+ */
+template<
+  typename OutputLayerType = NegativeLogLikelihood<>,
+  typename InitializationRuleType = RandomInitialization
+>
+class QuantizedFFN
+{
+ public:
+  //! The type of the networks that can be quantized.
+  using NetworkType = FFN<OutputLayerType, InitializationRuleType>;
+
+  /**
+   * Create a quantized network with the layers of the given network, but
+   * without weights, to load a quantized network into.  An exception is
+   * thrown if the network holds modules that hold other modules.
+   *
+   * @param network Network with the layers of the quantized network.
+   */
+  QuantizedFFN(const NetworkType& network);
+
+  /**
+   * Quantize the given trained network, calibrating the scales of the inputs
+   * of the quantized layers on the given data.  The calibration data should
+   * be representative of the data to predict (the training set, or a sample
+   * of it).  An exception is thrown if the network has no parameters or holds
+   * modules that hold other modules.
+   *
+   * @param network Trained network to quantize.
+   * @param calibrationData Input data to calibrate the scales on.
+   */
+  QuantizedFFN(const NetworkType& network, const arma::mat& calibrationData);
+
+  //! Destructor to release the layers.
+  ~QuantizedFFN();
+
+  //! The quantized network can't be copied, since it owns its layers.
+  QuantizedFFN(const QuantizedFFN&) = delete;
+  QuantizedFFN& operator=(const QuantizedFFN&) = delete;
+
+  /**
+   * Predict the responses to a given set of predictors.  If every layer that
+   * isn't quantized supports batches, the predictors are passed through the
+   * network in blocks of columns.
+   *
+   * @param predictors Input predictors.
+   * @param results Matrix to put output predictions of responses into.
+   */
+  void Predict(const arma::mat& predictors, arma::mat& results);
+
+  //! Get the quantized layers, in the order of the network.
+  const std::vector<QuantizedLayer>& QuantizedLayers() const
+  {
+    return quantizedLayers;
+  }
+
+  //! Get the parameters of the layers that aren't quantized.
+  const arma::mat& Parameters() const { return parameter; }
+
+  /**
+   * Serialize the quantized network.
+   */
+  template<typename Archive>
+  void Serialize(Archive& ar, const unsigned int /* version */);
+
+ private:
+  //! Calibrate the input scales on the given data, and quantize the weights of
+  //! the given network.
+  void Calibrate(const NetworkType& network, const arma::mat& calibrationData);
+
+  //! Point the weights of the layers that aren't quantized into the
+  //! parameters, and reset them.
+  void ResetWeights();
+
+  //! Pass the given input (replaced by the output) through the layers.
+  void Forward(arma::mat& input);
+
+  //! The layers that aren't quantized, in the order of the network.
+  std::vector<LayerTypes> network;
+
+  //! The quantized layers, in the order of the network.
+  std::vector<QuantizedLayer> quantizedLayers;
+
+  //! Whether each layer of the original network is quantized.
+  std::vector<bool> isQuantized;
+
+  //! The parameters of the layers that aren't quantized.
+  arma::mat parameter;
+
+  //! The input width.
+  size_t width;
+
+  //! The input height.
+  size_t height;
+
+  //! Whether the input size of the layers has been set.
+  bool reset;
+
+  //! Locally-stored output parameter visitor.
+  OutputParameterVisitor outputParameterVisitor;
+
+  //! Locally-stored output width visitor.
+  OutputWidthVisitor outputWidthVisitor;
+
+  //! Locally-stored output height visitor.
+  OutputHeightVisitor outputHeightVisitor;
+}; // class QuantizedFFN
+
+} // namespace ann
+} // namespace mlpack
+
+// Include implementation.
+#include "quantized_ffn_impl.hpp"
+
+#endif
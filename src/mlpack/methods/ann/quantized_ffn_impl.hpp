@@ -0,0 +1,328 @@
+/**
+ * @file quantized_ffn_impl.hpp
+ *
+ * Implementation of the QuantizedFFN class, the 8-bit inference counterpart of
+ * a trained feed forward network.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_QUANTIZED_FFN_IMPL_HPP
+#define MLPACK_METHODS_ANN_QUANTIZED_FFN_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "quantized_ffn.hpp"
+
+#include "visitor/deterministic_set_visitor.hpp"
+#include "visitor/forward_visitor.hpp"
+#include "visitor/has_model_visitor.hpp"
+#include "visitor/set_input_height_visitor.hpp"
+#include "visitor/set_input_width_visitor.hpp"
+#include "visitor/weight_set_visitor.hpp"
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+template<typename OutputLayerType, typename InitializationRuleType>
+QuantizedFFN<OutputLayerType, InitializationRuleType>::QuantizedFFN(
+    const NetworkType& network) :
+    width(network.width),
+    height(network.height),
+    reset(false)
+{
+  for (size_t i = 0; i < network.network.size(); ++i)
+  {
+    if (boost::apply_visitor(HasModelVisitor(), network.network[i]))
+    {
+      throw std::invalid_argument("QuantizedFFN::QuantizedFFN(): modules "
+          "that hold other modules are not supported");
+    }
+  }
+
+  // The layers with a quantized counterpart are replaced by it, and the others
+  // are copied.
+  CopyVisitor copyVisitor;
+  WeightSizeVisitor weightSizeVisitor;
+  size_t weights = 0;
+  for (size_t i = 0; i < network.network.size(); ++i)
+  {
+    QuantizedLayer quantizedLayer;
+    if (boost::apply_visitor(QuantizedLayerVisitor(quantizedLayer),
+        network.network[i]))
+    {
+      quantizedLayers.push_back(quantizedLayer);
+      isQuantized.push_back(true);
+    }
+    else
+    {
+      this->network.push_back(boost::apply_visitor(copyVisitor,
+          network.network[i]));
+      weights += boost::apply_visitor(weightSizeVisitor,
+          this->network.back());
+      isQuantized.push_back(false);
+    }
+  }
+
+  parameter.zeros(weights, 1);
+  ResetWeights();
+
+  DeterministicSetVisitor deterministicSetVisitor(true);
+  std::for_each(this->network.begin(), this->network.end(),
+      boost::apply_visitor(deterministicSetVisitor));
+}
+
+template<typename OutputLayerType, typename InitializationRuleType>
+QuantizedFFN<OutputLayerType, InitializationRuleType>::QuantizedFFN(
+    const NetworkType& network, const arma::mat& calibrationData) :
+    QuantizedFFN(network)
+{
+  Calibrate(network, calibrationData);
+}
+
+template<typename OutputLayerType, typename InitializationRuleType>
+QuantizedFFN<OutputLayerType, InitializationRuleType>::~QuantizedFFN()
+{
+  DeleteVisitor deleteVisitor;
+  std::for_each(network.begin(), network.end(),
+      boost::apply_visitor(deleteVisitor));
+}
+
+template<typename OutputLayerType, typename InitializationRuleType>
+void QuantizedFFN<OutputLayerType, InitializationRuleType>::Calibrate(
+    const NetworkType& network, const arma::mat& calibrationData)
+{
+  if (network.parameter.is_empty())
+  {
+    throw std::invalid_argument("QuantizedFFN::QuantizedFFN(): the network "
+        "has no parameters; train it first");
+  }
+
+  if (calibrationData.n_cols == 0)
+  {
+    throw std::invalid_argument("QuantizedFFN::QuantizedFFN(): no "
+        "calibration data given");
+  }
+
+  // Copies of all layers for the calibration passes in double precision.  The
+  // copies only read the parameters of the network, so they can point into
+  // them.
+  arma::mat& networkParameter = const_cast<arma::mat&>(network.parameter);
+  std::vector<LayerTypes> layers;
+  CopyVisitor copyVisitor;
+  ResetVisitor resetVisitor;
+  size_t offset = 0;
+  for (size_t i = 0; i < network.network.size(); ++i)
+  {
+    layers.push_back(boost::apply_visitor(copyVisitor, network.network[i]));
+
+    offset += boost::apply_visitor(WeightSetVisitor(std::move(
+        networkParameter), offset), layers[i]);
+    boost::apply_visitor(resetVisitor, layers[i]);
+  }
+
+  DeterministicSetVisitor deterministicSetVisitor(true);
+  std::for_each(layers.begin(), layers.end(),
+      boost::apply_visitor(deterministicSetVisitor));
+
+  // The largest absolute input of each layer.
+  arma::vec maxInput = arma::zeros<arma::vec>(layers.size());
+  bool calibrationReset = network.reset;
+  size_t calibrationWidth = network.width;
+  size_t calibrationHeight = network.height;
+  const size_t blockSize = NetworkType::SupportsBatches(layers) ? 256 : 1;
+  for (size_t begin = 0; begin < calibrationData.n_cols; begin += blockSize)
+  {
+    const size_t end = std::min(begin + blockSize,
+        (size_t) calibrationData.n_cols) - 1;
+    arma::mat input = calibrationData.cols(begin, end);
+    maxInput[0] = std::max(maxInput[0], arma::abs(input).max());
+
+    NetworkType::Forward(layers, std::move(input), calibrationReset,
+        calibrationWidth, calibrationHeight);
+
+    for (size_t i = 1; i < layers.size(); ++i)
+    {
+      maxInput[i] = std::max(maxInput[i], arma::abs(boost::apply_visitor(
+          outputParameterVisitor, layers[i - 1])).max());
+    }
+  }
+
+  // Quantize the weights of the quantized layers (whose input size is known
+  // now), and copy those of the others.
+  WeightSizeVisitor weightSizeVisitor;
+  offset = 0;
+  for (size_t i = 0, q = 0, kept = 0; i < layers.size(); ++i)
+  {
+    const size_t weights = boost::apply_visitor(weightSizeVisitor, layers[i]);
+    if (isQuantized[i])
+    {
+      boost::apply_visitor(QuantizedLayerVisitor(quantizedLayers[q]),
+          layers[i]);
+
+      const arma::mat layerParameters(networkParameter.memptr() + offset,
+          weights, 1, false, true);
+      quantizedLayers[q++].Quantize(layerParameters, (maxInput[i] > 0) ?
+          maxInput[i] / 127.0 : 1.0);
+    }
+    else if (weights > 0)
+    {
+      parameter.rows(kept, kept + weights - 1) =
+          networkParameter.rows(offset, offset + weights - 1);
+      kept += weights;
+    }
+
+    offset += weights;
+  }
+
+  DeleteVisitor deleteVisitor;
+  std::for_each(layers.begin(), layers.end(),
+      boost::apply_visitor(deleteVisitor));
+}
+
+template<typename OutputLayerType, typename InitializationRuleType>
+void QuantizedFFN<OutputLayerType, InitializationRuleType>::ResetWeights()
+{
+  ResetVisitor resetVisitor;
+  size_t offset = 0;
+  for (size_t i = 0; i < network.size(); ++i)
+  {
+    offset += boost::apply_visitor(WeightSetVisitor(std::move(parameter),
+        offset), network[i]);
+    boost::apply_visitor(resetVisitor, network[i]);
+  }
+}
+
+template<typename OutputLayerType, typename InitializationRuleType>
+void QuantizedFFN<OutputLayerType, InitializationRuleType>::Predict(
+    const arma::mat& predictors, arma::mat& results)
+{
+  // The quantized layers process any number of points at once.
+  const size_t blockSize = NetworkType::SupportsBatches(network) ? 256 : 1;
+  for (size_t begin = 0; begin < predictors.n_cols; begin += blockSize)
+  {
+    const size_t end = std::min(begin + blockSize, (size_t) predictors.n_cols)
+        - 1;
+    arma::mat output = predictors.cols(begin, end);
+    Forward(output);
+
+    if (begin == 0)
+      results.set_size(output.n_rows, predictors.n_cols);
+    results.cols(begin, end) = output;
+  }
+}
+
+template<typename OutputLayerType, typename InitializationRuleType>
+void QuantizedFFN<OutputLayerType, InitializationRuleType>::Forward(
+    arma::mat& input)
+{
+  // The quantized input of the current layer, if the previous layer was
+  // quantized too.
+  arma::Mat<arma::s8> quantizedInput;
+  bool quantized = false;
+  arma::Mat<arma::s32> accumulator;
+
+  for (size_t i = 0, k = 0, q = 0; i < isQuantized.size(); ++i)
+  {
+    size_t outputWidth, outputHeight;
+    if (isQuantized[i])
+    {
+      const QuantizedLayer& layer = quantizedLayers[q++];
+      if (!quantized)
+        layer.QuantizeInput(input, quantizedInput);
+
+      layer.Forward(quantizedInput, accumulator);
+
+      // Requantize the accumulator directly for a following quantized layer.
+      quantized = (i + 1 < isQuantized.size()) && isQuantized[i + 1];
+      if (quantized)
+      {
+        quantizedLayers[q].RequantizeInput(accumulator, layer.OutputScale(),
+            quantizedInput);
+      }
+      else
+      {
+        input = layer.OutputScale() *
+            arma::conv_to<arma::mat>::from(accumulator);
+      }
+
+      outputWidth = layer.OutputWidth();
+      outputHeight = layer.OutputHeight();
+    }
+    else
+    {
+      LayerTypes& layer = network[k++];
+      if (!reset && i > 0)
+      {
+        boost::apply_visitor(SetInputWidthVisitor(width), layer);
+        boost::apply_visitor(SetInputHeightVisitor(height), layer);
+      }
+
+      arma::mat& output = boost::apply_visitor(outputParameterVisitor, layer);
+      boost::apply_visitor(ForwardVisitor(std::move(input), std::move(output)),
+          layer);
+      input = output;
+
+      outputWidth = boost::apply_visitor(outputWidthVisitor, layer);
+      outputHeight = boost::apply_visitor(outputHeightVisitor, layer);
+    }
+
+    if (!reset)
+    {
+      if (outputWidth != 0)
+        width = outputWidth;
+
+      if (outputHeight != 0)
+        height = outputHeight;
+    }
+  }
+
+  reset = true;
+}
+
+template<typename OutputLayerType, typename InitializationRuleType>
+template<typename Archive>
+void QuantizedFFN<OutputLayerType, InitializationRuleType>::Serialize(
+    Archive& ar, const unsigned int /* version */)
+{
+  ar & data::CreateNVP(parameter, "parameter");
+  ar & data::CreateNVP(width, "width");
+  ar & data::CreateNVP(height, "height");
+
+  size_t numQuantized = quantizedLayers.size();
+  ar & data::CreateNVP(numQuantized, "numQuantized");
+
+  if (Archive::is_loading::value)
+  {
+    WeightSizeVisitor weightSizeVisitor;
+    size_t weights = 0;
+    for (size_t i = 0; i < network.size(); ++i)
+      weights += boost::apply_visitor(weightSizeVisitor, network[i]);
+
+    if (numQuantized != quantizedLayers.size() || weights != parameter.n_elem)
+    {
+      throw std::invalid_argument("QuantizedFFN::Serialize(): the quantized "
+          "network was saved from a network with other layers");
+    }
+  }
+
+  for (size_t i = 0; i < quantizedLayers.size(); ++i)
+  {
+    std::ostringstream name;
+    name << "quantizedLayer" << i;
+    ar & data::CreateNVP(quantizedLayers[i], name.str());
+  }
+
+  // If we are loading, we need to point the weights into the parameters.
+  if (Archive::is_loading::value)
+  {
+    reset = false;
+    ResetWeights();
+  }
+}
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
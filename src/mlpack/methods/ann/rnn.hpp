@@ -16,6 +16,7 @@
 
 #include "visitor/delete_visitor.hpp"
 #include "visitor/delta_visitor.hpp"
+#include "visitor/lstm_layout_visitor.hpp"
 #include "visitor/output_parameter_visitor.hpp"
 #include "visitor/reset_visitor.hpp"
 
@@ -24,6 +25,7 @@
 #include <mlpack/methods/ann/layer/layer_types.hpp>
 #include <mlpack/methods/ann/init_rules/random_init.hpp>
 #include <mlpack/core/optimizers/sgd/sgd.hpp>
+#include <mlpack/core/data/data_loader.hpp>
 
 namespace mlpack {
 namespace ann /** Artificial Neural Network. */ {
@@ -126,15 +128,47 @@ class RNN
   >
   void Train(const arma::mat& predictors, const arma::mat& responses);
 
+  /**
+   * Train the recurrent neural network on the batches of the given loader for
+   * the given number of epochs, using the given optimizer.  The dataset
+   * doesn't have to fit in memory: while the optimizer runs on one batch, the
+   * loader reads and prepares the next batches in the background.
+   *
+   * Each batch is optimized like the dataset given to the other overloads of
+   * Train(), so the optimizer should usually make a single pass over a batch
+   * (for instance, MiniBatchSGD with as many iterations as it has mini-batches
+   * in a batch of the loader).  The state of the optimizer (such as the
+   * moments of Adam) starts anew with each batch, so batches of the loader
+   * should hold many mini-batches of the optimizer.
+   *
+   * @tparam OptimizerType Type of optimizer to use to train the model.
+   * @param loader Loader of the batches of training data.
+   * @param optimizer Instantiated optimizer used to train the model.
+   * @param epochs Number of passes over the data of the loader.
+   */
+  template<
+      template<typename, typename...> class OptimizerType,
+      typename... OptimizerTypeArgs
+  >
+  void Train(data::DataLoader& loader,
+             OptimizerType<NetworkType, OptimizerTypeArgs...>& optimizer,
+             const size_t epochs = 1);
+
   /**
    * Predict the responses to a given set of predictors. The responses will
    * reflect the output of the given output layer as returned by the
-   * output layer function.
+   * output layer function.  If the lengths of the sequences are given, the
+   * steps after the end of each sequence are padding; their predictions are
+   * zero.
    *
    * @param predictors Input predictors.
    * @param results Matrix to put output predictions of responses into.
+   * @param sequenceLengths Number of steps of each sequence (optional; by
+   *     default every sequence has rho steps).
    */
-  void Predict(const arma::mat& predictors, arma::mat& results);
+  void Predict(const arma::mat& predictors,
+               arma::mat& results,
+               const arma::Row<size_t>& sequenceLengths = arma::Row<size_t>());
 
   /**
    * Evaluate the recurrent neural network with the given parameters. This
@@ -186,6 +220,31 @@ class RNN
    */
   void Add(LayerTypes layer) { network.push_back(layer); }
 
+  /**
+   * Get the lengths of the training sequences.  Each column of the predictors
+   * and responses holds rho steps; if the lengths are given, only the first
+   * SequenceLengths()[i] steps of sequence i are used, and the other steps are
+   * padding.  If empty (the default), every sequence has rho steps.  The
+   * recurrent layers are given the length of each sequence through their
+   * Rho() function.
+   */
+  const arma::Row<size_t>& SequenceLengths() const { return sequenceLengths; }
+  //! Modify the lengths of the training sequences.
+  arma::Row<size_t>& SequenceLengths() { return sequenceLengths; }
+
+  /**
+   * Get the number of steps of truncated backpropagation through time (BPTT).
+   * If not 0, each sequence is processed in chunks of this many steps: the
+   * forward pass of a chunk continues from the state at the end of the last
+   * chunk, but the error is only backpropagated within the chunk, so only the
+   * activations of one chunk are stored.  If 0 (the default), the error is
+   * backpropagated through the whole sequence.  Truncation needs recurrent
+   * layers whose backward pass starts from the last forward step, like LSTM.
+   */
+  size_t BPTTSteps() const { return bpttSteps; }
+  //! Modify the number of steps of truncated backpropagation through time.
+  size_t& BPTTSteps() { return bpttSteps; }
+
   //! Return the number of separable functions (the number of predictor points).
   size_t NumFunctions() const { return numFunctions; }
 
@@ -196,7 +255,7 @@ class RNN
 
   //! Serialize the model.
   template<typename Archive>
-  void Serialize(Archive& ar, const unsigned int /* version */);
+  void Serialize(Archive& ar, const unsigned int version);
 
  private:
   // Helper functions.
@@ -225,8 +284,19 @@ class RNN
    *
    * @param predictors Input predictors.
    * @param results Vector to put output prediction of a response into.
+   * @param length Number of steps of the sequence.
+   */
+  void SinglePredict(const arma::mat& predictors,
+                     arma::mat& results,
+                     const size_t length);
+
+  /**
+   * Get the length of the given training sequence, and give it to the
+   * recurrent layers if the sequence lengths are set.
+   *
+   * @param i Index of the training sequence.
    */
-  void SinglePredict(const arma::mat& predictors, arma::mat& results);
+  size_t ResetSequenceLength(const size_t i);
 
   /**
    * Reset the module infomration (weights/parameters).
@@ -284,6 +354,12 @@ class RNN
   //! The number of separable functions (the number of predictor points).
   size_t numFunctions;
 
+  //! The lengths of the training sequences (empty if all have rho steps).
+  arma::Row<size_t> sequenceLengths;
+
+  //! The number of steps of truncated BPTT (0 for no truncation).
+  size_t bpttSteps;
+
   //! The current error for the backward pass.
   arma::mat error;
 
@@ -315,6 +391,24 @@ class RNN
 } // namespace ann
 } // namespace mlpack
 
+//! Set the serialization version of the RNN class (version 1 stores the
+//! parameters of LSTM layers in the stacked layout).
+//! This is BOOST_TEMPLATE_CLASS_VERSION() written out, as in lstm.hpp.
+namespace boost {
+namespace serialization {
+
+template<typename OutputLayerType, typename InitializationRuleType>
+struct version<mlpack::data::SecondShim<
+    mlpack::ann::RNN<OutputLayerType, InitializationRuleType>>>
+{
+  typedef mpl::int_<1> type;
+  typedef mpl::integral_c_tag tag;
+  BOOST_STATIC_CONSTANT(int, value = version::type::value);
+};
+
+} // namespace serialization
+} // namespace boost
+
 // Include implementation.
 #include "rnn_impl.hpp"
 
@@ -22,6 +22,7 @@
 #include "visitor/deterministic_set_visitor.hpp"
 #include "visitor/gradient_set_visitor.hpp"
 #include "visitor/gradient_visitor.hpp"
+#include "visitor/rho_set_visitor.hpp"
 
 namespace mlpack {
 namespace ann /** Artificial Neural Network. */ {
@@ -40,7 +41,8 @@ RNN<OutputLayerType, InitializationRuleType>::RNN(
     outputSize(0),
     targetSize(0),
     reset(false),
-    single(single)
+    single(single),
+    bpttSteps(0)
 {
   /* Nothing to do here */
 }
@@ -60,7 +62,8 @@ RNN<OutputLayerType, InitializationRuleType>::RNN(
     outputSize(0),
     targetSize(0),
     reset(false),
-    single(single)
+    single(single),
+    bpttSteps(0)
 {
   numFunctions = responses.n_cols;
 
@@ -143,9 +146,51 @@ void RNN<OutputLayerType, InitializationRuleType>::Train(
       << "." << std::endl;
 }
 
+template<typename OutputLayerType, typename InitializationRuleType>
+template<
+    template<typename, typename...> class OptimizerType,
+    typename... OptimizerTypeArgs
+>
+void RNN<OutputLayerType, InitializationRuleType>::Train(
+    data::DataLoader& loader,
+    OptimizerType<NetworkType, OptimizerTypeArgs...>& optimizer,
+    const size_t epochs)
+{
+  this->deterministic = true;
+  ResetDeterministic();
+
+  if (!reset)
+  {
+    ResetParameters();
+    reset = true;
+  }
+
+  // Train the model on each batch as it becomes ready.
+  Timer::Start("rnn_optimization");
+  arma::mat batchPredictors, batchResponses;
+  for (size_t epoch = 0; epoch < epochs; ++epoch)
+  {
+    double objective = 0;
+    while (loader.Next(batchPredictors, batchResponses))
+    {
+      numFunctions = batchResponses.n_cols;
+      predictors = std::move(batchPredictors);
+      responses = std::move(batchResponses);
+
+      objective += optimizer.Optimize(parameter);
+    }
+
+    Log::Info << "RNN::Train(): objective of epoch " << (epoch + 1)
+        << " is " << objective << "." << std::endl;
+  }
+  Timer::Stop("rnn_optimization");
+}
+
 template<typename OutputLayerType, typename InitializationRuleType>
 void RNN<OutputLayerType, InitializationRuleType>::Predict(
-    const arma::mat& predictors, arma::mat& results)
+    const arma::mat& predictors,
+    arma::mat& results,
+    const arma::Row<size_t>& sequenceLengths)
 {
   if (parameter.is_empty())
   {
@@ -163,16 +208,26 @@ void RNN<OutputLayerType, InitializationRuleType>::Predict(
 
   for (size_t i = 0; i < predictors.n_cols; i++)
   {
-    SinglePredict(predictors.col(i), resultsTemp);
+    size_t length = rho;
+    if (!sequenceLengths.is_empty())
+    {
+      length = sequenceLengths[i];
+      RhoSetVisitor rhoSetVisitor(length);
+      std::for_each(network.begin(), network.end(),
+          boost::apply_visitor(rhoSetVisitor));
+    }
+
+    resultsTemp.zeros();
+    SinglePredict(predictors.col(i), resultsTemp, length);
     results.col(i) = resultsTemp;
   }
 }
 
 template<typename OutputLayerType, typename InitializationRuleType>
 void RNN<OutputLayerType, InitializationRuleType>::SinglePredict(
-    const arma::mat& predictors, arma::mat& results)
+    const arma::mat& predictors, arma::mat& results, const size_t length)
 {
-  for (size_t seqNum = 0; seqNum < rho; ++seqNum)
+  for (size_t seqNum = 0; seqNum < length; ++seqNum)
   {
     currentInput = predictors.rows(seqNum * inputSize,
         (seqNum + 1) * inputSize - 1);
@@ -209,9 +264,10 @@ double RNN<OutputLayerType, InitializationRuleType>::Evaluate(
     targetSize = target.n_elem / rho;
   }
 
+  const size_t length = ResetSequenceLength(i);
   double performance = 0;
 
-  for (size_t seqNum = 0; seqNum < rho; ++seqNum)
+  for (size_t seqNum = 0; seqNum < length; ++seqNum)
   {
     currentInput = input.rows(seqNum * inputSize, (seqNum + 1) * inputSize - 1);
     arma::mat currentTarget = target.rows(seqNum * targetSize,
@@ -243,16 +299,16 @@ double RNN<OutputLayerType, InitializationRuleType>::Evaluate(
 
 template<typename OutputLayerType, typename InitializationRuleType>
 void RNN<OutputLayerType, InitializationRuleType>::Gradient(
-    const arma::mat& parameters, const size_t i, arma::mat& gradient)
+    const arma::mat& /* parameters */, const size_t i, arma::mat& gradient)
 {
-  if (gradient.is_empty())
+  if (parameter.is_empty())
   {
-    if (parameter.is_empty())
-    {
-      ResetParameters();
-      reset = true;
-    }
+    ResetParameters();
+    reset = true;
+  }
 
+  if (gradient.is_empty())
+  {
     gradient = arma::zeros<arma::mat>(parameter.n_rows, parameter.n_cols);
   }
   else
@@ -260,7 +316,11 @@ void RNN<OutputLayerType, InitializationRuleType>::Gradient(
     gradient.zeros();
   }
 
-  Evaluate(parameters, i, false);
+  if (deterministic)
+  {
+    deterministic = false;
+    ResetDeterministic();
+  }
 
   arma::mat currentGradient = arma::zeros<arma::mat>(parameter.n_rows,
       parameter.n_cols);
@@ -271,38 +331,91 @@ void RNN<OutputLayerType, InitializationRuleType>::Gradient(
   arma::mat target = arma::mat(responses.colptr(i), responses.n_rows,
       1, false, true);
 
-  for (size_t seqNum = 0; seqNum < rho; ++seqNum)
+  if (!inputSize)
   {
-    currentGradient.zeros();
+    inputSize = input.n_elem / rho;
+    targetSize = target.n_elem / rho;
+  }
 
-    arma::mat currentTarget = target.rows((rho - seqNum - 1) * targetSize,
-        (rho - seqNum) * targetSize - 1);
-    currentInput = input.rows((rho - seqNum - 1) * inputSize,
-        (rho - seqNum) * inputSize - 1);
+  // Without truncation, the whole sequence is one chunk.
+  const size_t length = ResetSequenceLength(i);
+  const size_t chunkSize = (bpttSteps == 0) ? length : bpttSteps;
 
-    for (size_t l = 0; l < network.size(); ++l)
-    {
-      boost::apply_visitor(LoadOutputParameterVisitor(
-          std::move(moduleOutputParameter)), network[network.size() - 1 - l]);
-    }
+  for (size_t start = 0; start < length; start += chunkSize)
+  {
+    const size_t end = std::min(start + chunkSize, length);
 
-    if (single && seqNum > 0)
+    // Forward the steps of the chunk, and save the outputs of every step.
+    for (size_t seqNum = start; seqNum < end; ++seqNum)
     {
-      error.zeros();
+      currentInput = input.rows(seqNum * inputSize,
+          (seqNum + 1) * inputSize - 1);
+      Forward(std::move(currentInput));
+
+      for (size_t l = 0; l < network.size(); ++l)
+      {
+        boost::apply_visitor(SaveOutputParameterVisitor(
+            std::move(moduleOutputParameter)), network[l]);
+      }
     }
-    else
+
+    // Backpropagate from the last step of the chunk to its first step.
+    for (size_t seqNum = end; seqNum > start; --seqNum)
     {
-      outputLayer.Backward(std::move(boost::apply_visitor(
-          outputParameterVisitor, network.back())), std::move(currentTarget),
-          std::move(error));
+      currentGradient.zeros();
+
+      arma::mat currentTarget = target.rows((seqNum - 1) * targetSize,
+          seqNum * targetSize - 1);
+      currentInput = input.rows((seqNum - 1) * inputSize,
+          seqNum * inputSize - 1);
+
+      for (size_t l = 0; l < network.size(); ++l)
+      {
+        boost::apply_visitor(LoadOutputParameterVisitor(
+            std::move(moduleOutputParameter)),
+            network[network.size() - 1 - l]);
+      }
+
+      if (single && seqNum != length)
+      {
+        const arma::mat& output = boost::apply_visitor(outputParameterVisitor,
+            network.back());
+        error.zeros(output.n_rows, output.n_cols);
+      }
+      else
+      {
+        outputLayer.Backward(std::move(boost::apply_visitor(
+            outputParameterVisitor, network.back())), std::move(currentTarget),
+            std::move(error));
+      }
+
+      Backward();
+      Gradient();
+      gradient += currentGradient;
     }
+  }
 
-    Backward();
-    Gradient();
-    gradient += currentGradient;
+  if (!outputSize)
+  {
+    outputSize = boost::apply_visitor(outputParameterVisitor,
+        network.back()).n_elem;
   }
 }
 
+template<typename OutputLayerType, typename InitializationRuleType>
+size_t RNN<OutputLayerType, InitializationRuleType>::ResetSequenceLength(
+    const size_t i)
+{
+  if (sequenceLengths.is_empty())
+    return rho;
+
+  RhoSetVisitor rhoSetVisitor(sequenceLengths[i]);
+  std::for_each(network.begin(), network.end(),
+      boost::apply_visitor(rhoSetVisitor));
+
+  return sequenceLengths[i];
+}
+
 template<typename OutputLayerType, typename InitializationRuleType>
 void RNN<OutputLayerType, InitializationRuleType>::ResetParameters()
 {
@@ -386,7 +499,7 @@ void RNN<OutputLayerType, InitializationRuleType>::Gradient()
 template<typename OutputLayerType, typename InitializationRuleType>
 template<typename Archive>
 void RNN<OutputLayerType, InitializationRuleType>::Serialize(
-    Archive& ar, const unsigned int /* version */)
+    Archive& ar, const unsigned int version)
 {
   ar & data::CreateNVP(parameter, "parameter");
   ar & data::CreateNVP(rho, "rho");
@@ -401,6 +514,15 @@ void RNN<OutputLayerType, InitializationRuleType>::Serialize(
   {
     reset = false;
 
+    // Before version 1 the LSTM layers laid out their parameters differently.
+    if (version == 0)
+    {
+      size_t offset = 0;
+      for (LayerTypes& layer : network)
+        offset += boost::apply_visitor(LSTMLayoutVisitor(parameter, offset),
+            layer);
+    }
+
     size_t offset = 0;
     for (LayerTypes& layer : network)
     {
@@ -0,0 +1,667 @@
+/**
+ * @file static_ffn.hpp
+ *
+ * Definition of the StaticFFN class, a feed forward neural network whose
+ * layers are fixed at compile time.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_STATIC_FFN_HPP
+#define MLPACK_METHODS_ANN_STATIC_FFN_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include "visitor/deterministic_set_visitor.hpp"
+#include "visitor/output_height_visitor.hpp"
+#include "visitor/output_width_visitor.hpp"
+#include "visitor/reset_visitor.hpp"
+#include "visitor/set_input_height_visitor.hpp"
+#include "visitor/set_input_width_visitor.hpp"
+
+#include "init_rules/init_rules_traits.hpp"
+
+#include <mlpack/methods/ann/layer/layer_types.hpp>
+#include <mlpack/methods/ann/layer/layer_traits.hpp>
+#include <mlpack/methods/ann/init_rules/random_init.hpp>
+#include <mlpack/core/optimizers/rmsprop/rmsprop.hpp>
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+/**
+ * Implementation of a feed forward network whose layers are given as template
+ * parameters, instead of being added at run time as in FFN.  The layers are
+ * held by value in a std::tuple, and each pass over them is unrolled at compile
+ * time, so every call to a layer is a direct (and inlinable) call instead of a
+ * dispatch through the LayerTypes variant, and the layers are not allocated
+ * one by one on the heap.  This matters for small networks, where the cost of
+ * the dispatch is a large part of the cost of a pass.
+ *
+ * The layers are the same classes as those of FFN, and the visitors of FFN
+ * are applied to them directly to handle the functions that only some layers
+ * implement, so a StaticFFN computes the same as the FFN with the same layers.
+ * Modules that hold other modules (such as Sequential) are not supported.
+ *
+ * The layers may use another matrix type than arma::mat, such as arma::fmat
+ * for single precision (the matrix type is that of the output parameter of
+ * the first layer, and all layers and the output layer must use it).  The
+ * optimizers work on double precision, so the parameters given to them
+ * (Parameters()) stay the double precision master weights, and the layers
+ * hold a single precision copy of them that is refreshed before each pass;
+ * the data, the activations and the gradients of the layers are single
+ * precision, and the gradient is converted to double precision for the
+ * optimizer.  This halves the memory traffic of the passes, while the small
+ * updates of the optimizer aren't lost to rounding.
+ *
+ * @code
+ * StaticFFN<NegativeLogLikelihood<arma::fmat, arma::fmat>,
+ *     RandomInitialization, Linear<arma::fmat, arma::fmat>,
+ *     SigmoidLayer<arma::fmat, arma::fmat>, Linear<arma::fmat, arma::fmat>,
+ *     LogSoftMax<arma::fmat, arma::fmat>> model(...);
+ * @endcode
+ *
+ * @code
+ * StaticFFN<NegativeLogLikelihood<>, RandomInitialization, Linear<>,
+ *     ReLULayer<>, Linear<>, LogSoftMax<>> model(Linear<>(10, 20),
+ *     ReLULayer<>(), Linear<>(20, 3), LogSoftMax<>());
+ * model.Train(predictors, responses);
+ * @endcode
+ *
+ * @tparam OutputLayerType The output layer type used to evaluate the network.
+ * @tparam InitializationRuleType Rule used to initialize the weight matrix.
+ * @tparam Layers The types of the layers of the network, in order.
+ */
+template<
+  typename OutputLayerType,
+  typename InitializationRuleType,
+  typename... Layers
+>
+class StaticFFN
+{
+  static_assert(sizeof...(Layers) >= 2,
+      "StaticFFN needs at least two layers");
+
+ public:
+  //! Convenience typedef for the internal model construction.
+  using NetworkType = StaticFFN<OutputLayerType, InitializationRuleType,
+      Layers...>;
+
+  //! The number of layers of the network.
+  static const size_t NumLayers = sizeof...(Layers);
+
+  //! The type of the layer of the given index.
+  template<size_t I>
+  using LayerType = typename std::tuple_element<I, std::tuple<Layers...>>::type;
+
+  //! The matrix type of the layers (that of the output of the first layer).
+  typedef typename std::decay<decltype(
+      std::declval<LayerType<0>&>().OutputParameter())>::type MatType;
+
+  //! The element type of the layers.
+  typedef typename MatType::elem_type ElemType;
+
+  /**
+   * Create the network from the given layers, which are moved into the
+   * network.
+   *
+   * @param layers The layers of the network, in order.
+   */
+  StaticFFN(Layers... layers);
+
+  /**
+   * Create the network from the given layers, which are moved into the
+   * network, with the given output layer and initialization rule.
+   *
+   * @param layers The layers of the network.
+   * @param outputLayer Output layer used to evaluate the network.
+   * @param initializeRule Instantiated InitializationRule object for
+   *        initializing the network parameter.
+   */
+  StaticFFN(std::tuple<Layers...> layers,
+            OutputLayerType outputLayer,
+            InitializationRuleType initializeRule = InitializationRuleType());
+
+  //! Copy constructor; the weights of the copied layers point into the copied
+  //! parameters.
+  StaticFFN(const StaticFFN& network);
+
+  //! Move constructor.
+  StaticFFN(StaticFFN&& network);
+
+  //! Copy/move assignment operator.
+  StaticFFN& operator=(StaticFFN network);
+
+  /**
+   * Train the network on the given input data using the given optimizer.
+   * This will use the existing model parameters as a starting point for the
+   * optimization.
+   *
+   * @tparam OptimizerType Type of optimizer to use to train the model.
+   * @param predictors Input training variables.
+   * @param responses Outputs results from input training variables.
+   * @param optimizer Instantiated optimizer used to train the model.
+   */
+  template<
+      template<typename, typename...> class OptimizerType =
+          mlpack::optimization::RMSProp,
+      typename... OptimizerTypeArgs
+  >
+  void Train(const arma::mat& predictors,
+             const arma::mat& responses,
+             OptimizerType<NetworkType, OptimizerTypeArgs...>& optimizer);
+
+  /**
+   * Train the network on the given input data.  By default, the RMSProp
+   * optimization algorithm is used, but others can be specified (such as
+   * mlpack::optimization::SGD).  This will use the existing model parameters
+   * as a starting point for the optimization.
+   *
+   * @tparam OptimizerType Type of optimizer to use to train the model.
+   * @param predictors Input training variables.
+   * @param responses Outputs results from input training variables.
+   */
+  template<
+      template<typename...> class OptimizerType = mlpack::optimization::RMSProp
+  >
+  void Train(const arma::mat& predictors, const arma::mat& responses);
+
+  /**
+   * Predict the responses to a given set of predictors.  If every layer
+   * supports batches, the predictors are passed through the network in blocks
+   * of columns.  The predictors and the results may have another element type
+   * than the layers; they are converted.
+   *
+   * @param predictors Input predictors.
+   * @param results Matrix to put output predictions of responses into.
+   */
+  template<typename eT>
+  void Predict(const arma::Mat<eT>& predictors, arma::Mat<eT>& results);
+
+  /**
+   * Evaluate the network with the given parameters on the point of the given
+   * index, in deterministic mode.
+   *
+   * @param parameters Matrix model parameters.
+   * @param i Index of point to use for objective function evaluation.
+   */
+  double Evaluate(const arma::mat& parameters, const size_t i)
+  {
+    return Evaluate(parameters, i, 1, true);
+  }
+
+  /**
+   * Evaluate the network with the given parameters on the point of the given
+   * index, in the given mode.  As for FFN, this overload only accepts a bool
+   * for the mode, so that it isn't ambiguous with the batch overloads.
+   *
+   * @param parameters Matrix model parameters.
+   * @param i Index of point to use for objective function evaluation.
+   * @param deterministic Whether or not to train or test the model. Note some
+   *        layer act differently in training or testing mode.
+   */
+  template<typename BoolType,
+           typename = std::enable_if_t<std::is_same<BoolType, bool>::value>>
+  double Evaluate(const arma::mat& parameters,
+                  const size_t i,
+                  const BoolType deterministic)
+  {
+    return Evaluate(parameters, i, 1, deterministic);
+  }
+
+  /**
+   * Evaluate the gradient of the network with the given parameters and with
+   * respect to the point of the given index.
+   *
+   * @param parameters Matrix of the model parameters to be optimized.
+   * @param i Index of points to use for objective function gradient evaluation.
+   * @param gradient Matrix to output gradient into.
+   */
+  void Gradient(const arma::mat& parameters,
+                const size_t i,
+                arma::mat& gradient)
+  {
+    Gradient(parameters, i, gradient, 1);
+  }
+
+  /**
+   * Evaluate the network with the given parameters on the batch of points
+   * [begin, begin + batchSize), and return the sum of the objective over the
+   * points.  If every layer supports batches, the whole batch is passed
+   * through the network as one matrix.
+   *
+   * @param parameters Matrix model parameters.
+   * @param begin Index of the first point of the batch.
+   * @param batchSize Number of points in the batch.
+   * @param deterministic Whether or not to train or test the model.
+   */
+  double Evaluate(const arma::mat& parameters,
+                  const size_t begin,
+                  const size_t batchSize,
+                  const bool deterministic);
+
+  /**
+   * Evaluate the network with the given parameters on the batch of points
+   * [begin, begin + batchSize) in deterministic mode.
+   *
+   * @param parameters Matrix model parameters.
+   * @param begin Index of the first point of the batch.
+   * @param batchSize Number of points in the batch.
+   */
+  double Evaluate(const arma::mat& parameters,
+                  const size_t begin,
+                  const size_t batchSize)
+  {
+    return Evaluate(parameters, begin, batchSize, true);
+  }
+
+  /**
+   * Evaluate the gradient of the network with the given parameters with
+   * respect to the batch of points [begin, begin + batchSize); this is the sum
+   * of the gradients of the points.
+   *
+   * @param parameters Matrix of the model parameters to be optimized.
+   * @param begin Index of the first point of the batch.
+   * @param gradient Matrix to output gradient into.
+   * @param batchSize Number of points in the batch.
+   */
+  void Gradient(const arma::mat& parameters,
+                const size_t begin,
+                arma::mat& gradient,
+                const size_t batchSize);
+
+  //! Get the layer of the given index.
+  template<size_t I>
+  const LayerType<I>& Layer() const { return std::get<I>(network); }
+  //! Modify the layer of the given index.
+  template<size_t I>
+  LayerType<I>& Layer() { return std::get<I>(network); }
+
+  //! Return the number of separable functions (the number of predictor points).
+  size_t NumFunctions() const { return numFunctions; }
+
+  //! Return the initial point for the optimization.
+  const arma::mat& Parameters() const { return parameter; }
+  //! Modify the initial point for the optimization.
+  arma::mat& Parameters() { return parameter; }
+
+  /**
+   * Reset the weights of the layers with the initialization rule.
+   */
+  void ResetParameters();
+
+  //! Serialize the model.
+  template<typename Archive>
+  void Serialize(Archive& ar, const unsigned int /* version */);
+
+ private:
+  //! Whether every layer of Ts can process a batch of points at once.
+  template<typename... Ts>
+  struct BatchSupport { static const bool value = true; };
+  template<typename T, typename... Ts>
+  struct BatchSupport<T, Ts...>
+  {
+    static const bool value = LayerTraits<T>::SupportsBatches &&
+        BatchSupport<Ts...>::value;
+  };
+
+  //! Prepare the network for the given data.
+  void ResetData(const arma::mat& predictors, const arma::mat& responses);
+
+  //! Point the weights of the layers into their parameters, and reset them.
+  void ResetWeights();
+
+  //! Make the parameters of the layers match the master parameters.
+  void SyncParameters()
+  {
+    SyncParameters(std::is_same<ElemType, double>());
+  }
+
+  //! The layers use the master parameters themselves.
+  void SyncParameters(std::true_type)
+  {
+    if (layerParameter.memptr() != parameter.memptr() ||
+        layerParameter.n_elem != parameter.n_elem)
+    {
+      layerParameter = MatType(parameter.memptr(), parameter.n_rows,
+          parameter.n_cols, false, false);
+      SetWeights<0>(0);
+    }
+  }
+
+  //! The layers use a converted copy of the master parameters.
+  void SyncParameters(std::false_type)
+  {
+    if (layerParameter.n_elem != parameter.n_elem)
+    {
+      layerParameter.set_size(parameter.n_rows, parameter.n_cols);
+      SetWeights<0>(0);
+    }
+
+    std::copy(parameter.begin(), parameter.end(), layerParameter.begin());
+  }
+
+  /**
+   * Point the gradients of the layers into the given gradient, if the layers
+   * use double precision and direct is true, and return whether they do;
+   * otherwise the gradients of the layers get their own memory.
+   */
+  bool UseGradient(arma::mat& gradient, const bool direct)
+  {
+    return UseGradient(gradient, direct, std::is_same<ElemType, double>());
+  }
+
+  bool UseGradient(arma::mat& gradient, const bool direct, std::true_type)
+  {
+    if (direct)
+    {
+      layerGradient = MatType(gradient.memptr(), gradient.n_rows,
+          gradient.n_cols, false, false);
+    }
+    else
+    {
+      // A new matrix, since resizing an alias of the same size would keep the
+      // alias.
+      layerGradient = arma::zeros<MatType>(gradient.n_rows, gradient.n_cols);
+    }
+
+    SetGradients<0>(0);
+    return direct;
+  }
+
+  bool UseGradient(arma::mat& gradient, const bool /* direct */,
+                   std::false_type)
+  {
+    layerGradient.zeros(gradient.n_rows, gradient.n_cols);
+    SetGradients<0>(0);
+    return false;
+  }
+
+  //! Set the deterministic mode of the layers.
+  void ResetDeterministic();
+
+  //! Pass the given input forward through the layers.
+  void Forward(MatType&& input);
+
+  //! Pass the current error backward through the layers, and compute the
+  //! gradients of the layers for the current input.
+  void Backward();
+
+  //! Return the number of weights of the given layer.
+  template<typename T>
+  typename std::enable_if<
+      HasParametersCheck<T, MatType&(T::*)()>::value, size_t>::type
+  LayerWeightSize(T& layer)
+  {
+    return layer.Parameters().n_elem;
+  }
+
+  template<typename T>
+  typename std::enable_if<
+      !HasParametersCheck<T, MatType&(T::*)()>::value, size_t>::type
+  LayerWeightSize(T& /* layer */)
+  {
+    return 0;
+  }
+
+  //! Point the weights of the given layer into the parameters of the layers,
+  //! at the given offset, and return their number.
+  template<typename T>
+  typename std::enable_if<
+      HasParametersCheck<T, MatType&(T::*)()>::value, size_t>::type
+  LayerWeights(T& layer, const size_t offset)
+  {
+    layer.Parameters() = MatType(layerParameter.memptr() + offset,
+        layer.Parameters().n_rows, layer.Parameters().n_cols, false, false);
+    return layer.Parameters().n_elem;
+  }
+
+  template<typename T>
+  typename std::enable_if<
+      !HasParametersCheck<T, MatType&(T::*)()>::value, size_t>::type
+  LayerWeights(T& /* layer */, const size_t /* offset */)
+  {
+    return 0;
+  }
+
+  //! Point the gradient of the given layer into the gradient of the layers,
+  //! at the given offset, and return its size.
+  template<typename T>
+  typename std::enable_if<
+      HasGradientCheck<T, MatType&(T::*)()>::value, size_t>::type
+  LayerGradientBuffer(T& layer, const size_t offset)
+  {
+    layer.Gradient() = MatType(layerGradient.memptr() + offset,
+        layer.Parameters().n_rows, layer.Parameters().n_cols, false, false);
+    return layer.Parameters().n_elem;
+  }
+
+  template<typename T>
+  typename std::enable_if<
+      !HasGradientCheck<T, MatType&(T::*)()>::value, size_t>::type
+  LayerGradientBuffer(T& /* layer */, const size_t /* offset */)
+  {
+    return 0;
+  }
+
+  //! Compute the gradient of the given layer, given its input and the delta
+  //! of the next layer (or the error of the output).
+  template<typename T>
+  typename std::enable_if<
+      HasGradientCheck<T, MatType&(T::*)()>::value, void>::type
+  LayerGradient(T& layer, MatType& input, MatType& delta)
+  {
+    layer.Gradient(std::move(input), std::move(delta),
+        std::move(layer.Gradient()));
+  }
+
+  template<typename T>
+  typename std::enable_if<
+      !HasGradientCheck<T, MatType&(T::*)()>::value, void>::type
+  LayerGradient(T& /* layer */, MatType& /* input */, MatType& /* delta */)
+  {
+    /* Nothing to do here. */
+  }
+
+  //! Return the number of weights of the layers from the given one on.
+  template<size_t I>
+  typename std::enable_if<(I < NumLayers), size_t>::type WeightSize()
+  {
+    return LayerWeightSize(std::get<I>(network)) + WeightSize<I + 1>();
+  }
+
+  template<size_t I>
+  typename std::enable_if<(I == NumLayers), size_t>::type WeightSize()
+  {
+    return 0;
+  }
+
+  //! Initialize the master parameters of the layers from the given one on,
+  //! starting at the given offset.
+  template<size_t I>
+  typename std::enable_if<(I < NumLayers), void>::type
+  InitializeLayers(const size_t offset)
+  {
+    const size_t weight = LayerWeightSize(std::get<I>(network));
+    arma::mat tmp = arma::mat(parameter.memptr() + offset, weight, 1, false,
+        false);
+    initializeRule.Initialize(tmp, tmp.n_elem, 1);
+
+    InitializeLayers<I + 1>(offset + weight);
+  }
+
+  template<size_t I>
+  typename std::enable_if<(I == NumLayers), void>::type
+  InitializeLayers(const size_t /* offset */) { }
+
+  //! Point the weights of the layers from the given one on into the
+  //! parameters of the layers, starting at the given offset, and reset the
+  //! layers.
+  template<size_t I>
+  typename std::enable_if<(I < NumLayers), void>::type
+  SetWeights(const size_t offset)
+  {
+    auto& layer = std::get<I>(network);
+    const size_t weight = LayerWeights(layer, offset);
+    ResetVisitor()(&layer);
+
+    SetWeights<I + 1>(offset + weight);
+  }
+
+  template<size_t I>
+  typename std::enable_if<(I == NumLayers), void>::type
+  SetWeights(const size_t /* offset */) { }
+
+  //! Point the gradients of the layers from the given one on into the
+  //! gradient of the layers, starting at the given offset.
+  template<size_t I>
+  typename std::enable_if<(I < NumLayers), void>::type
+  SetGradients(const size_t offset)
+  {
+    const size_t weight = LayerGradientBuffer(std::get<I>(network), offset);
+    SetGradients<I + 1>(offset + weight);
+  }
+
+  template<size_t I>
+  typename std::enable_if<(I == NumLayers), void>::type
+  SetGradients(const size_t /* offset */) { }
+
+  //! Set the deterministic mode of the layers from the given one on.
+  template<size_t I>
+  typename std::enable_if<(I < NumLayers), void>::type SetDeterministic()
+  {
+    DeterministicSetVisitor(deterministic)(&std::get<I>(network));
+    SetDeterministic<I + 1>();
+  }
+
+  template<size_t I>
+  typename std::enable_if<(I == NumLayers), void>::type SetDeterministic() { }
+
+  //! Pass the output of the previous layer forward through the layers from
+  //! the given one on.
+  template<size_t I>
+  typename std::enable_if<(I < NumLayers), void>::type ForwardLayers()
+  {
+    auto& layer = std::get<I>(network);
+    if (!reset)
+    {
+      SetInputWidthVisitor(width)(&layer);
+      SetInputHeightVisitor(height)(&layer);
+    }
+
+    layer.Forward(std::move(std::get<I - 1>(network).OutputParameter()),
+        std::move(layer.OutputParameter()));
+    if (!reset)
+      ResetInputSize<I>();
+
+    ForwardLayers<I + 1>();
+  }
+
+  template<size_t I>
+  typename std::enable_if<(I == NumLayers), void>::type ForwardLayers() { }
+
+  //! Pass the delta of the next layer backward through the layers from the
+  //! given one down to the second one (the first layer has no delta).
+  template<size_t I>
+  typename std::enable_if<(I > 0), void>::type BackwardLayers()
+  {
+    auto& layer = std::get<I>(network);
+    layer.Backward(std::move(layer.OutputParameter()), std::move(
+        std::get<I + 1>(network).Delta()), std::move(layer.Delta()));
+
+    BackwardLayers<I - 1>();
+  }
+
+  template<size_t I>
+  typename std::enable_if<(I == 0), void>::type BackwardLayers() { }
+
+  //! Compute the gradients of the layers from the given one up to the last
+  //! one (exclusive).
+  template<size_t I>
+  typename std::enable_if<(I < NumLayers - 1), void>::type GradientLayers()
+  {
+    LayerGradient(std::get<I>(network), std::get<I - 1>(network).
+        OutputParameter(), std::get<I + 1>(network).Delta());
+
+    GradientLayers<I + 1>();
+  }
+
+  template<size_t I>
+  typename std::enable_if<(I == NumLayers - 1), void>::type GradientLayers()
+  { }
+
+  //! Get the output size of the given layer, if it has one, as the input size
+  //! of the next layer.
+  template<size_t I>
+  void ResetInputSize()
+  {
+    auto& layer = std::get<I>(network);
+    const size_t outputWidth = OutputWidthVisitor()(&layer);
+    if (outputWidth != 0)
+      width = outputWidth;
+
+    const size_t outputHeight = OutputHeightVisitor()(&layer);
+    if (outputHeight != 0)
+      height = outputHeight;
+  }
+
+  //! The layers of the network.
+  std::tuple<Layers...> network;
+
+  //! Instantiated outputlayer used to evaluate the network.
+  OutputLayerType outputLayer;
+
+  //! Instantiated InitializationRule object for initializing the network
+  //! parameter.
+  InitializationRuleType initializeRule;
+
+  //! The input width.
+  size_t width;
+
+  //! The input height.
+  size_t height;
+
+  //! Whether the input size of the layers has been set.
+  bool reset;
+
+  //! The matrix of data points (predictors).
+  MatType predictors;
+
+  //! The matrix of responses to the input data points.
+  MatType responses;
+
+  //! Matrix of (trained) parameters: the master weights of the optimizer.
+  arma::mat parameter;
+
+  //! The parameters that the weights of the layers point into (the master
+  //! parameters themselves, if the layers use double precision).
+  MatType layerParameter;
+
+  //! The gradient that the gradients of the layers point into.
+  MatType layerGradient;
+
+  //! The number of separable functions (the number of predictor points).
+  size_t numFunctions;
+
+  //! The current error for the backward pass.
+  MatType error;
+
+  //! The current input of the forward/backward pass.
+  MatType currentInput;
+
+  //! The current target of the forward/backward pass.
+  MatType currentTarget;
+
+  //! The current evaluation mode (training or testing).
+  bool deterministic;
+}; // class StaticFFN
+
+} // namespace ann
+} // namespace mlpack
+
+// Include implementation.
+#include "static_ffn_impl.hpp"
+
+#endif
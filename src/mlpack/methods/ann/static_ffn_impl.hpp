@@ -0,0 +1,407 @@
+/**
+ * @file static_ffn_impl.hpp
+ *
+ * Implementation of the StaticFFN class, a feed forward neural network whose
+ * layers are fixed at compile time.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_STATIC_FFN_IMPL_HPP
+#define MLPACK_METHODS_ANN_STATIC_FFN_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "static_ffn.hpp"
+
+namespace mlpack {
+namespace ann /** Artificial Neural Network. */ {
+
+template<typename OutputLayerType,
+         typename InitializationRuleType,
+         typename... Layers>
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::StaticFFN(
+    Layers... layers) :
+    network(std::move(layers)...),
+    width(0),
+    height(0),
+    reset(false),
+    numFunctions(0),
+    deterministic(true)
+{
+  /* Nothing to do here */
+}
+
+template<typename OutputLayerType,
+         typename InitializationRuleType,
+         typename... Layers>
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::StaticFFN(
+    std::tuple<Layers...> layers,
+    OutputLayerType outputLayer,
+    InitializationRuleType initializeRule) :
+    network(std::move(layers)),
+    outputLayer(std::move(outputLayer)),
+    initializeRule(initializeRule),
+    width(0),
+    height(0),
+    reset(false),
+    numFunctions(0),
+    deterministic(true)
+{
+  /* Nothing to do here */
+}
+
+template<typename OutputLayerType,
+         typename InitializationRuleType,
+         typename... Layers>
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::StaticFFN(
+    const StaticFFN& network) :
+    network(network.network),
+    outputLayer(network.outputLayer),
+    initializeRule(network.initializeRule),
+    width(network.width),
+    height(network.height),
+    reset(network.reset),
+    predictors(network.predictors),
+    responses(network.responses),
+    parameter(network.parameter),
+    numFunctions(network.numFunctions),
+    deterministic(network.deterministic)
+{
+  // The weights of the copied layers still point into the parameters of the
+  // layers of the other network.
+  if (!parameter.is_empty())
+    ResetWeights();
+}
+
+template<typename OutputLayerType,
+         typename InitializationRuleType,
+         typename... Layers>
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::StaticFFN(
+    StaticFFN&& network) :
+    network(std::move(network.network)),
+    outputLayer(std::move(network.outputLayer)),
+    initializeRule(std::move(network.initializeRule)),
+    width(network.width),
+    height(network.height),
+    reset(network.reset),
+    predictors(std::move(network.predictors)),
+    responses(std::move(network.responses)),
+    parameter(std::move(network.parameter)),
+    numFunctions(network.numFunctions),
+    deterministic(network.deterministic)
+{
+  // Small matrices are copied instead of moved, so the weights are pointed
+  // into the parameters again.
+  if (!parameter.is_empty())
+    ResetWeights();
+}
+
+template<typename OutputLayerType,
+         typename InitializationRuleType,
+         typename... Layers>
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>&
+StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::operator=(
+    StaticFFN network)
+{
+  this->network = std::move(network.network);
+  outputLayer = std::move(network.outputLayer);
+  initializeRule = std::move(network.initializeRule);
+  width = network.width;
+  height = network.height;
+  reset = network.reset;
+  predictors = std::move(network.predictors);
+  responses = std::move(network.responses);
+  parameter = std::move(network.parameter);
+  numFunctions = network.numFunctions;
+  deterministic = network.deterministic;
+
+  if (!parameter.is_empty())
+    ResetWeights();
+
+  return *this;
+}
+
+template<typename OutputLayerType,
+         typename InitializationRuleType,
+         typename... Layers>
+void StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::ResetData(
+    const arma::mat& predictors, const arma::mat& responses)
+{
+  numFunctions = responses.n_cols;
+  this->predictors = arma::conv_to<MatType>::from(predictors);
+  this->responses = arma::conv_to<MatType>::from(responses);
+  deterministic = true;
+  ResetDeterministic();
+
+  if (parameter.is_empty())
+    ResetParameters();
+}
+
+template<typename OutputLayerType,
+         typename InitializationRuleType,
+         typename... Layers>
+template<
+    template<typename, typename...> class OptimizerType,
+    typename... OptimizerTypeArgs
+>
+void StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::Train(
+      const arma::mat& predictors,
+      const arma::mat& responses,
+      OptimizerType<NetworkType, OptimizerTypeArgs...>& optimizer)
+{
+  ResetData(predictors, responses);
+
+  // Train the model.
+  Timer::Start("static_ffn_optimization");
+  const double out = optimizer.Optimize(parameter);
+  Timer::Stop("static_ffn_optimization");
+
+  Log::Info << "StaticFFN::Train(): final objective of trained model is "
+      << out << "." << std::endl;
+}
+
+template<typename OutputLayerType,
+         typename InitializationRuleType,
+         typename... Layers>
+template<template<typename...> class OptimizerType>
+void StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::Train(
+    const arma::mat& predictors, const arma::mat& responses)
+{
+  ResetData(predictors, responses);
+
+  OptimizerType<decltype(*this)> optimizer(*this);
+
+  // Train the model.
+  Timer::Start("static_ffn_optimization");
+  const double out = optimizer.Optimize(parameter);
+  Timer::Stop("static_ffn_optimization");
+
+  Log::Info << "StaticFFN::Train(): final objective of trained model is "
+      << out << "." << std::endl;
+}
+
+template<typename OutputLayerType,
+         typename InitializationRuleType,
+         typename... Layers>
+template<typename eT>
+void StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::Predict(
+    const arma::Mat<eT>& predictors, arma::Mat<eT>& results)
+{
+  if (parameter.is_empty())
+    ResetParameters();
+  SyncParameters();
+
+  if (!deterministic)
+  {
+    deterministic = true;
+    ResetDeterministic();
+  }
+
+  const size_t blockSize = BatchSupport<Layers...>::value ? 256 : 1;
+  for (size_t begin = 0; begin < predictors.n_cols; begin += blockSize)
+  {
+    const size_t end = std::min(begin + blockSize, (size_t) predictors.n_cols)
+        - 1;
+    Forward(arma::conv_to<MatType>::from(predictors.cols(begin, end)));
+
+    const MatType& output = std::get<NumLayers - 1>(network).
+        OutputParameter();
+    if (begin == 0)
+      results.set_size(output.n_rows, predictors.n_cols);
+    results.cols(begin, end) = arma::conv_to<arma::Mat<eT>>::from(output);
+  }
+}
+
+template<typename OutputLayerType,
+         typename InitializationRuleType,
+         typename... Layers>
+double StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::Evaluate(
+    const arma::mat& /* parameters */,
+    const size_t begin,
+    const size_t batchSize,
+    const bool deterministic)
+{
+  if (parameter.is_empty())
+    ResetParameters();
+  SyncParameters();
+
+  if (deterministic != this->deterministic)
+  {
+    this->deterministic = deterministic;
+    ResetDeterministic();
+  }
+
+  // If some layer doesn't support batches, the points are passed through the
+  // network one at a time.
+  const size_t blockSize = BatchSupport<Layers...>::value ? batchSize : 1;
+  double res = 0;
+  for (size_t block = begin; block < begin + batchSize; block += blockSize)
+  {
+    currentInput = predictors.cols(block, block + blockSize - 1);
+    currentTarget = responses.cols(block, block + blockSize - 1);
+    Forward(std::move(currentInput));
+
+    // The output layer may not be separable over the columns, so each point
+    // is evaluated on its own.
+    const MatType& output = std::get<NumLayers - 1>(network).
+        OutputParameter();
+    for (size_t i = 0; i < blockSize; ++i)
+    {
+      res += outputLayer.Forward(std::move(MatType(output.col(i))),
+          std::move(MatType(currentTarget.col(i))));
+    }
+  }
+
+  return res;
+}
+
+template<typename OutputLayerType,
+         typename InitializationRuleType,
+         typename... Layers>
+void StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::Gradient(
+    const arma::mat& /* parameters */,
+    const size_t begin,
+    arma::mat& gradient,
+    const size_t batchSize)
+{
+  if (parameter.is_empty())
+    ResetParameters();
+  SyncParameters();
+
+  if (deterministic)
+  {
+    deterministic = false;
+    ResetDeterministic();
+  }
+
+  // If some layer doesn't support batches, the points are passed through the
+  // network one at a time, and their gradients are added up.  The layers
+  // write the gradient of a whole batch directly into the given gradient if
+  // they use double precision.
+  const size_t blockSize = BatchSupport<Layers...>::value ? batchSize : 1;
+  gradient.zeros(parameter.n_rows, parameter.n_cols);
+  const bool direct = UseGradient(gradient, blockSize == batchSize);
+
+  MatType pointError;
+  for (size_t block = begin; block < begin + batchSize; block += blockSize)
+  {
+    currentInput = predictors.cols(block, block + blockSize - 1);
+    currentTarget = responses.cols(block, block + blockSize - 1);
+    Forward(std::move(currentInput));
+
+    const MatType& output = std::get<NumLayers - 1>(network).
+        OutputParameter();
+    error.set_size(output.n_rows, blockSize);
+    for (size_t i = 0; i < blockSize; ++i)
+    {
+      outputLayer.Backward(std::move(MatType(output.col(i))),
+          std::move(MatType(currentTarget.col(i))), std::move(pointError));
+      error.col(i) = pointError;
+    }
+
+    Backward();
+
+    if (!direct)
+      gradient += arma::conv_to<arma::mat>::from(layerGradient);
+  }
+}
+
+template<typename OutputLayerType,
+         typename InitializationRuleType,
+         typename... Layers>
+void StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::
+ResetParameters()
+{
+  ResetDeterministic();
+
+  parameter.set_size(WeightSize<0>(), 1);
+
+  // Initialize the network layer by layer or the complete network.
+  if (ann::InitTraits<InitializationRuleType>::UseLayer)
+    InitializeLayers<0>(0);
+  else
+    initializeRule.Initialize(parameter, parameter.n_elem, 1);
+
+  ResetWeights();
+}
+
+template<typename OutputLayerType,
+         typename InitializationRuleType,
+         typename... Layers>
+void StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::
+ResetWeights()
+{
+  layerParameter.reset();
+  SyncParameters();
+}
+
+template<typename OutputLayerType,
+         typename InitializationRuleType,
+         typename... Layers>
+void StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::
+ResetDeterministic()
+{
+  SetDeterministic<0>();
+}
+
+template<typename OutputLayerType,
+         typename InitializationRuleType,
+         typename... Layers>
+void StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::Forward(
+    MatType&& input)
+{
+  auto& first = std::get<0>(network);
+  first.Forward(std::move(input), std::move(first.OutputParameter()));
+  if (!reset)
+    ResetInputSize<0>();
+
+  ForwardLayers<1>();
+  reset = true;
+}
+
+template<typename OutputLayerType,
+         typename InitializationRuleType,
+         typename... Layers>
+void StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::Backward()
+{
+  // The last layer gets the error of the output layer, and each layer before
+  // it (except the first one) the delta of the layer after it.
+  auto& last = std::get<NumLayers - 1>(network);
+  last.Backward(std::move(last.OutputParameter()), std::move(error),
+      std::move(last.Delta()));
+  BackwardLayers<NumLayers - 2>();
+
+  // The first layer sees the input of the network, and the last layer the
+  // error of the output layer.
+  auto& first = std::get<0>(network);
+  LayerGradient(first, currentInput, std::get<1>(network).Delta());
+  GradientLayers<1>();
+  LayerGradient(last, std::get<NumLayers - 2>(network).OutputParameter(),
+      error);
+}
+
+template<typename OutputLayerType,
+         typename InitializationRuleType,
+         typename... Layers>
+template<typename Archive>
+void StaticFFN<OutputLayerType, InitializationRuleType, Layers...>::Serialize(
+    Archive& ar, const unsigned int /* version */)
+{
+  ar & data::CreateNVP(parameter, "parameter");
+  ar & data::CreateNVP(width, "width");
+  ar & data::CreateNVP(height, "height");
+
+  // If we are loading, we need to initialize the weights.
+  if (Archive::is_loading::value)
+  {
+    reset = false;
+    ResetWeights();
+  }
+}
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
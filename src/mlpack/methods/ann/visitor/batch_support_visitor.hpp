@@ -0,0 +1,41 @@
+/**
+ * @file batch_support_visitor.hpp
+ *
+ * This file provides an abstraction for the SupportsBatches layer trait of
+ * different layers.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_VISITOR_BATCH_SUPPORT_VISITOR_HPP
+#define MLPACK_METHODS_ANN_VISITOR_BATCH_SUPPORT_VISITOR_HPP
+
+#include <mlpack/methods/ann/layer/layer_traits.hpp>
+#include <mlpack/methods/ann/layer/layer_types.hpp>
+
+#include <boost/variant.hpp>
+
+namespace mlpack {
+namespace ann {
+
+/**
+ * BatchSupportVisitor returns whether the given module can process a batch of
+ * points (one per column) at once, as given by LayerTraits::SupportsBatches.
+ */
+class BatchSupportVisitor : public boost::static_visitor<bool>
+{
+ public:
+  //! Return whether the module supports batches.
+  template<typename LayerType>
+  bool operator()(LayerType* layer) const;
+};
+
+} // namespace ann
+} // namespace mlpack
+
+// Include implementation.
+#include "batch_support_visitor_impl.hpp"
+
+#endif
@@ -0,0 +1,41 @@
+/**
+ * @file has_model_visitor.hpp
+ *
+ * This file provides an abstraction to check whether a module holds other
+ * modules (through the Model() function).
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_VISITOR_HAS_MODEL_VISITOR_HPP
+#define MLPACK_METHODS_ANN_VISITOR_HAS_MODEL_VISITOR_HPP
+
+#include <mlpack/methods/ann/layer/layer_traits.hpp>
+#include <mlpack/methods/ann/layer/layer_types.hpp>
+
+#include <boost/variant.hpp>
+
+namespace mlpack {
+namespace ann {
+
+/**
+ * HasModelVisitor returns whether the given module implements the Model()
+ * function, that is, whether it holds other modules.
+ */
+class HasModelVisitor : public boost::static_visitor<bool>
+{
+ public:
+  //! Return whether the module implements the Model() function.
+  template<typename LayerType>
+  bool operator()(LayerType* layer) const;
+};
+
+} // namespace ann
+} // namespace mlpack
+
+// Include implementation.
+#include "has_model_visitor_impl.hpp"
+
+#endif
@@ -0,0 +1,31 @@
+/**
+ * @file has_model_visitor_impl.hpp
+ *
+ * Implementation of the Model() check abstraction.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_VISITOR_HAS_MODEL_VISITOR_IMPL_HPP
+#define MLPACK_METHODS_ANN_VISITOR_HAS_MODEL_VISITOR_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "has_model_visitor.hpp"
+
+namespace mlpack {
+namespace ann {
+
+//! HasModelVisitor visitor class.
+template<typename LayerType>
+inline bool HasModelVisitor::operator()(LayerType* /* layer */) const
+{
+  return HasModelCheck<LayerType,
+      std::vector<LayerTypes>&(LayerType::*)()>::value;
+}
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
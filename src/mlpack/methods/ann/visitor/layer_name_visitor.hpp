@@ -0,0 +1,55 @@
+/**
+ * @file layer_name_visitor.hpp
+ *
+ * This file provides the name of the type of any layer, for reports about the
+ * layers of a network.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_VISITOR_LAYER_NAME_VISITOR_HPP
+#define MLPACK_METHODS_ANN_VISITOR_LAYER_NAME_VISITOR_HPP
+
+#include <mlpack/methods/ann/layer/layer_types.hpp>
+
+#include <boost/variant.hpp>
+
+namespace mlpack {
+namespace ann {
+
+/**
+ * LayerNameVisitor returns the name of the class of the given module, without
+ * its namespace and template parameters (for instance, "Linear").  The name of
+ * a BaseLayer is the name of its activation function (for instance,
+ * "RectifierFunction" for a ReLULayer).
+ */
+class LayerNameVisitor : public boost::static_visitor<std::string>
+{
+ public:
+  //! Return the name of the class of the module.
+  template<typename LayerType>
+  std::string operator()(LayerType* layer) const;
+
+  //! Return the name of the activation function of the module.
+  template<typename ActivationFunction,
+           typename InputDataType,
+           typename OutputDataType>
+  std::string operator()(BaseLayer<ActivationFunction, InputDataType,
+      OutputDataType>* layer) const;
+
+ private:
+  //! Return the name of the given class, without its namespace and template
+  //! parameters.
+  template<typename T>
+  static std::string ClassName();
+};
+
+} // namespace ann
+} // namespace mlpack
+
+// Include implementation.
+#include "layer_name_visitor_impl.hpp"
+
+#endif
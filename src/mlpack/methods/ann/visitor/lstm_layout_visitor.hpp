@@ -0,0 +1,74 @@
+/**
+ * @file lstm_layout_visitor.hpp
+ *
+ * This file provides a visitor that converts the parameters of the LSTM layers
+ * of a network from the layout of old models to the stacked layout.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_VISITOR_LSTM_LAYOUT_VISITOR_HPP
+#define MLPACK_METHODS_ANN_VISITOR_LSTM_LAYOUT_VISITOR_HPP
+
+#include <mlpack/methods/ann/layer/layer_traits.hpp>
+#include <mlpack/methods/ann/layer/layer_types.hpp>
+
+#include <boost/variant.hpp>
+
+namespace mlpack {
+namespace ann {
+
+/**
+ * LSTMLayoutVisitor rearranges the parameters of the LSTM layers in the given
+ * parameters set, which are laid out as in models saved before the LSTM layer
+ * stacked its weights: the weights and the biases of the input (a Linear
+ * module), followed by the recurrent weights (a LinearNoBias module).  They
+ * are rearranged in place into the stacked layout of LSTM::Parameters(): the
+ * input and recurrent weights, followed by the biases.  The parameters of the
+ * other layers are left as they are.
+ */
+class LSTMLayoutVisitor : public boost::static_visitor<size_t>
+{
+ public:
+  //! Rearrange the parameters set, starting at the given offset.
+  LSTMLayoutVisitor(arma::mat& weight, const size_t offset = 0);
+
+  //! Rearrange the parameters of the LSTM layer, and return their number.
+  size_t operator()(LSTM<arma::mat, arma::mat>* layer) const;
+
+  //! Rearrange the parameters of the LSTM layers the module holds, and return
+  //! the number of parameters of the module.
+  template<typename LayerType>
+  size_t operator()(LayerType* layer) const;
+
+ private:
+  //! The parameters set.
+  arma::mat& weight;
+
+  //! The offset of the module in the parameters set.
+  size_t offset;
+
+  //! Return the number of parameters if the module doesn't implement the
+  //! Model() function.
+  template<typename T>
+  typename std::enable_if<
+      !HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, size_t>::type
+  LayerSize(T* layer) const;
+
+  //! Rearrange the parameters of the modules the module holds, and return the
+  //! number of parameters if the module implements the Model() function.
+  template<typename T>
+  typename std::enable_if<
+      HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, size_t>::type
+  LayerSize(T* layer) const;
+};
+
+} // namespace ann
+} // namespace mlpack
+
+// Include implementation.
+#include "lstm_layout_visitor_impl.hpp"
+
+#endif
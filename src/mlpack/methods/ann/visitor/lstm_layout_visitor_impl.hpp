@@ -0,0 +1,92 @@
+/**
+ * @file lstm_layout_visitor_impl.hpp
+ *
+ * Implementation of the LSTM parameter layout conversion.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_VISITOR_LSTM_LAYOUT_VISITOR_IMPL_HPP
+#define MLPACK_METHODS_ANN_VISITOR_LSTM_LAYOUT_VISITOR_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "lstm_layout_visitor.hpp"
+
+#include <mlpack/methods/ann/layer/lstm.hpp>
+#include "weight_size_visitor.hpp"
+
+namespace mlpack {
+namespace ann {
+
+//! LSTMLayoutVisitor visitor class.
+inline LSTMLayoutVisitor::LSTMLayoutVisitor(arma::mat& weight,
+                                            const size_t offset) :
+    weight(weight),
+    offset(offset)
+{
+  /* Nothing to do here. */
+}
+
+inline size_t LSTMLayoutVisitor::operator()(
+    LSTM<arma::mat, arma::mat>* layer) const
+{
+  const size_t inputWeights = 4 * layer->OutputSize() * layer->InputSize();
+  const size_t recurrentWeights = 4 * layer->OutputSize() * layer->OutputSize();
+  const size_t biases = 4 * layer->OutputSize();
+
+  // The input weights stay where they are; the recurrent weights move in front
+  // of the biases.
+  double* parameters = weight.memptr() + offset;
+  const arma::vec bias(parameters + inputWeights, biases);
+  std::copy(parameters + inputWeights + biases,
+      parameters + inputWeights + biases + recurrentWeights,
+      parameters + inputWeights);
+  std::copy(bias.begin(), bias.end(),
+      parameters + inputWeights + recurrentWeights);
+
+  return inputWeights + recurrentWeights + biases;
+}
+
+template<typename LayerType>
+inline size_t LSTMLayoutVisitor::operator()(LayerType* layer) const
+{
+  return LayerSize(layer);
+}
+
+template<typename T>
+inline typename std::enable_if<
+    !HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, size_t>::type
+LSTMLayoutVisitor::LayerSize(T* layer) const
+{
+  return WeightSizeVisitor()(layer);
+}
+
+template<typename T>
+inline typename std::enable_if<
+    HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, size_t>::type
+LSTMLayoutVisitor::LayerSize(T* layer) const
+{
+  // The parameters of the module itself come before those of the modules it
+  // holds, as in WeightSetVisitor.
+  size_t modelOffset = WeightSizeVisitor()(layer);
+  for (size_t i = 0; i < layer->Model().size(); ++i)
+  {
+    modelOffset -= boost::apply_visitor(WeightSizeVisitor(),
+        layer->Model()[i]);
+  }
+
+  for (size_t i = 0; i < layer->Model().size(); ++i)
+  {
+    modelOffset += boost::apply_visitor(LSTMLayoutVisitor(weight,
+        offset + modelOffset), layer->Model()[i]);
+  }
+
+  return modelOffset;
+}
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
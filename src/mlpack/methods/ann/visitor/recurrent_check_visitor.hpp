@@ -0,0 +1,67 @@
+/**
+ * @file recurrent_check_visitor.hpp
+ *
+ * This file provides an abstraction to check whether a module steps through
+ * time on each forward pass.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_VISITOR_RECURRENT_CHECK_VISITOR_HPP
+#define MLPACK_METHODS_ANN_VISITOR_RECURRENT_CHECK_VISITOR_HPP
+
+#include <mlpack/methods/ann/layer/layer_traits.hpp>
+#include <mlpack/methods/ann/layer/layer_types.hpp>
+
+#include <boost/variant.hpp>
+
+namespace mlpack {
+namespace ann {
+
+/**
+ * RecurrentCheckVisitor returns whether the given module, or one of the
+ * modules it holds, is a recurrent module (LSTM, Recurrent or
+ * RecurrentAttention).  These modules keep the state of the time steps and
+ * move to the next step on each forward pass, so a forward pass can't be run
+ * again without changing their state.
+ */
+class RecurrentCheckVisitor : public boost::static_visitor<bool>
+{
+ public:
+  //! Return true for the LSTM module.
+  bool operator()(LSTM<arma::mat, arma::mat>* layer) const;
+
+  //! Return true for the Recurrent module.
+  bool operator()(Recurrent<arma::mat, arma::mat>* layer) const;
+
+  //! Return true for the RecurrentAttention module.
+  bool operator()(RecurrentAttention<arma::mat, arma::mat>* layer) const;
+
+  //! Return whether the module holds a recurrent module.
+  template<typename LayerType>
+  bool operator()(LayerType* layer) const;
+
+ private:
+  //! Return false if the module doesn't implement the Model() function.
+  template<typename T>
+  typename std::enable_if<
+      !HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, bool>::type
+  ModelCheck(T* layer) const;
+
+  //! Return whether one of the modules the module holds is a recurrent module
+  //! if the module implements the Model() function.
+  template<typename T>
+  typename std::enable_if<
+      HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, bool>::type
+  ModelCheck(T* layer) const;
+};
+
+} // namespace ann
+} // namespace mlpack
+
+// Include implementation.
+#include "recurrent_check_visitor_impl.hpp"
+
+#endif
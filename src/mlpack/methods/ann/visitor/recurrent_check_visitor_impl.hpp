@@ -0,0 +1,70 @@
+/**
+ * @file recurrent_check_visitor_impl.hpp
+ *
+ * Implementation of the recurrent module check abstraction.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_VISITOR_RECURRENT_CHECK_VISITOR_IMPL_HPP
+#define MLPACK_METHODS_ANN_VISITOR_RECURRENT_CHECK_VISITOR_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "recurrent_check_visitor.hpp"
+
+namespace mlpack {
+namespace ann {
+
+//! RecurrentCheckVisitor visitor class.
+inline bool RecurrentCheckVisitor::operator()(
+    LSTM<arma::mat, arma::mat>* /* layer */) const
+{
+  return true;
+}
+
+inline bool RecurrentCheckVisitor::operator()(
+    Recurrent<arma::mat, arma::mat>* /* layer */) const
+{
+  return true;
+}
+
+inline bool RecurrentCheckVisitor::operator()(
+    RecurrentAttention<arma::mat, arma::mat>* /* layer */) const
+{
+  return true;
+}
+
+template<typename LayerType>
+inline bool RecurrentCheckVisitor::operator()(LayerType* layer) const
+{
+  return ModelCheck(layer);
+}
+
+template<typename T>
+inline typename std::enable_if<
+    !HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, bool>::type
+RecurrentCheckVisitor::ModelCheck(T* /* layer */) const
+{
+  return false;
+}
+
+template<typename T>
+inline typename std::enable_if<
+    HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, bool>::type
+RecurrentCheckVisitor::ModelCheck(T* layer) const
+{
+  for (size_t i = 0; i < layer->Model().size(); ++i)
+  {
+    if (boost::apply_visitor(RecurrentCheckVisitor(), layer->Model()[i]))
+      return true;
+  }
+
+  return false;
+}
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,56 @@
+/**
+ * @file release_output_visitor.hpp
+ *
+ * This file provides an abstraction to release the output parameters of
+ * different layers (and of the layers they hold).
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_VISITOR_RELEASE_OUTPUT_VISITOR_HPP
+#define MLPACK_METHODS_ANN_VISITOR_RELEASE_OUTPUT_VISITOR_HPP
+
+#include <mlpack/methods/ann/layer/layer_traits.hpp>
+#include <mlpack/methods/ann/layer/layer_types.hpp>
+
+#include <boost/variant.hpp>
+
+namespace mlpack {
+namespace ann {
+
+/**
+ * ReleaseOutputVisitor frees the memory of the output parameter of the given
+ * module, and of the output parameters of the modules it holds (if it
+ * implements the Model() function).  The next forward pass of the module sets
+ * them again.
+ */
+class ReleaseOutputVisitor : public boost::static_visitor<void>
+{
+ public:
+  //! Release the output parameters of the module.
+  template<typename LayerType>
+  void operator()(LayerType* layer) const;
+
+ private:
+  //! Do nothing if the module doesn't implement the Model() function.
+  template<typename T>
+  typename std::enable_if<
+      !HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, void>::type
+  LayerModel(T* layer) const;
+
+  //! Release the output parameters of the modules held by the module.
+  template<typename T>
+  typename std::enable_if<
+      HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, void>::type
+  LayerModel(T* layer) const;
+};
+
+} // namespace ann
+} // namespace mlpack
+
+// Include implementation.
+#include "release_output_visitor_impl.hpp"
+
+#endif
@@ -0,0 +1,48 @@
+/**
+ * @file release_output_visitor_impl.hpp
+ *
+ * Implementation of the ReleaseOutputVisitor class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_VISITOR_RELEASE_OUTPUT_VISITOR_IMPL_HPP
+#define MLPACK_METHODS_ANN_VISITOR_RELEASE_OUTPUT_VISITOR_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "release_output_visitor.hpp"
+
+namespace mlpack {
+namespace ann {
+
+//! ReleaseOutputVisitor visitor class.
+template<typename LayerType>
+inline void ReleaseOutputVisitor::operator()(LayerType* layer) const
+{
+  layer->OutputParameter().reset();
+  LayerModel(layer);
+}
+
+template<typename T>
+inline typename std::enable_if<
+    !HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, void>::type
+ReleaseOutputVisitor::LayerModel(T* /* layer */) const
+{
+  /* Nothing to do here. */
+}
+
+template<typename T>
+inline typename std::enable_if<
+    HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, void>::type
+ReleaseOutputVisitor::LayerModel(T* layer) const
+{
+  for (size_t i = 0; i < layer->Model().size(); ++i)
+    boost::apply_visitor(ReleaseOutputVisitor(), layer->Model()[i]);
+}
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,78 @@
+/**
+ * @file rho_set_visitor.hpp
+ *
+ * This file provides an abstraction for the Rho() function for different
+ * layers and automatically directs any parameter to the right layer type.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_VISITOR_RHO_SET_VISITOR_HPP
+#define MLPACK_METHODS_ANN_VISITOR_RHO_SET_VISITOR_HPP
+
+#include <mlpack/methods/ann/layer/layer_traits.hpp>
+#include <mlpack/methods/ann/layer/layer_types.hpp>
+
+#include <boost/variant.hpp>
+
+namespace mlpack {
+namespace ann {
+
+/**
+ * RhoSetVisitor sets the number of steps of the sequence (the rho parameter)
+ * of the recurrent layers, given the length of the next sequence.
+ */
+class RhoSetVisitor : public boost::static_visitor<void>
+{
+ public:
+  //! Set the rho parameter given the length of the sequence.
+  RhoSetVisitor(const size_t rho);
+
+  //! Set the rho parameter.
+  template<typename LayerType>
+  void operator()(LayerType* layer) const;
+
+ private:
+  //! The length of the sequence.
+  const size_t rho;
+
+  //! Set the rho parameter if the module implements the Rho() and Model()
+  //! function.
+  template<typename T>
+  typename std::enable_if<
+      HasRho<T, size_t&(T::*)()>::value &&
+      HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, void>::type
+  LayerRho(T* layer) const;
+
+  //! Set the rho parameter if the module implements the Model() function.
+  template<typename T>
+  typename std::enable_if<
+      !HasRho<T, size_t&(T::*)()>::value &&
+      HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, void>::type
+  LayerRho(T* layer) const;
+
+  //! Set the rho parameter if the module implements the Rho() function.
+  template<typename T>
+  typename std::enable_if<
+      HasRho<T, size_t&(T::*)()>::value &&
+      !HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, void>::type
+  LayerRho(T* layer) const;
+
+  //! Do not set the rho parameter if the module doesn't implement the Rho() or
+  //! Model() function.
+  template<typename T>
+  typename std::enable_if<
+      !HasRho<T, size_t&(T::*)()>::value &&
+      !HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, void>::type
+  LayerRho(T* layer) const;
+};
+
+} // namespace ann
+} // namespace mlpack
+
+// Include implementation.
+#include "rho_set_visitor_impl.hpp"
+
+#endif
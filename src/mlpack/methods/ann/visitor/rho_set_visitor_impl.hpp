@@ -0,0 +1,75 @@
+/**
+ * @file rho_set_visitor_impl.hpp
+ *
+ * Implementation of the Rho() function layer abstraction.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_VISITOR_RHO_SET_VISITOR_IMPL_HPP
+#define MLPACK_METHODS_ANN_VISITOR_RHO_SET_VISITOR_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "rho_set_visitor.hpp"
+
+namespace mlpack {
+namespace ann {
+
+//! RhoSetVisitor visitor class.
+inline RhoSetVisitor::RhoSetVisitor(const size_t rho) : rho(rho)
+{
+  /* Nothing to do here. */
+}
+
+template<typename LayerType>
+inline void RhoSetVisitor::operator()(LayerType* layer) const
+{
+  LayerRho(layer);
+}
+
+template<typename T>
+inline typename std::enable_if<
+    HasRho<T, size_t&(T::*)()>::value &&
+    HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, void>::type
+RhoSetVisitor::LayerRho(T* layer) const
+{
+  layer->Rho() = rho;
+
+  for (size_t i = 0; i < layer->Model().size(); ++i)
+    boost::apply_visitor(RhoSetVisitor(rho), layer->Model()[i]);
+}
+
+template<typename T>
+inline typename std::enable_if<
+    !HasRho<T, size_t&(T::*)()>::value &&
+    HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, void>::type
+RhoSetVisitor::LayerRho(T* layer) const
+{
+  for (size_t i = 0; i < layer->Model().size(); ++i)
+    boost::apply_visitor(RhoSetVisitor(rho), layer->Model()[i]);
+}
+
+template<typename T>
+inline typename std::enable_if<
+    HasRho<T, size_t&(T::*)()>::value &&
+    !HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, void>::type
+RhoSetVisitor::LayerRho(T* layer) const
+{
+  layer->Rho() = rho;
+}
+
+template<typename T>
+inline typename std::enable_if<
+    !HasRho<T, size_t&(T::*)()>::value &&
+    !HasModelCheck<T, std::vector<LayerTypes>&(T::*)()>::value, void>::type
+RhoSetVisitor::LayerRho(T* /* input */) const
+{
+  /* Nothing to do here. */
+}
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
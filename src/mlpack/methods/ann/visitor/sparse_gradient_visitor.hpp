@@ -0,0 +1,69 @@
+/**
+ * @file sparse_gradient_visitor.hpp
+ *
+ * This file provides an abstraction for the SparseGradient() and
+ * GradientColumns() functions for different layers and automatically directs
+ * any parameter to the right layer type.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_VISITOR_SPARSE_GRADIENT_VISITOR_HPP
+#define MLPACK_METHODS_ANN_VISITOR_SPARSE_GRADIENT_VISITOR_HPP
+
+#include <mlpack/methods/ann/layer/layer_traits.hpp>
+#include <mlpack/methods/ann/layer/layer_types.hpp>
+
+#include <boost/variant.hpp>
+
+namespace mlpack {
+namespace ann {
+
+/**
+ * SparseGradientVisitor switches the modules that implement the
+ * SparseGradient() function to sparse gradient mode (where Gradient() only
+ * writes the columns of the weights the input used), and returns whether the
+ * given module is such a module.  For these modules, the columns written by the
+ * last Gradient() call and the number of rows of the weights are stored.
+ */
+class SparseGradientVisitor : public boost::static_visitor<bool>
+{
+ public:
+  //! Store the columns written by the last Gradient() call and the number of
+  //! rows of the weights of the visited module.
+  SparseGradientVisitor(arma::uvec& columns, size_t& rows);
+
+  //! Switch the module to sparse gradient mode, if it has one.
+  template<typename LayerType>
+  bool operator()(LayerType* layer) const;
+
+ private:
+  //! The columns written by the last Gradient() call.
+  arma::uvec& columns;
+
+  //! The number of rows of the weights.
+  size_t& rows;
+
+  //! Switch the module to sparse gradient mode if it implements the
+  //! SparseGradient() function.
+  template<typename T>
+  typename std::enable_if<
+      HasSparseGradientCheck<T, bool&(T::*)()>::value, bool>::type
+  LayerSparseGradient(T* layer) const;
+
+  //! Do nothing if the module doesn't implement the SparseGradient() function.
+  template<typename T>
+  typename std::enable_if<
+      !HasSparseGradientCheck<T, bool&(T::*)()>::value, bool>::type
+  LayerSparseGradient(T* layer) const;
+};
+
+} // namespace ann
+} // namespace mlpack
+
+// Include implementation.
+#include "sparse_gradient_visitor_impl.hpp"
+
+#endif
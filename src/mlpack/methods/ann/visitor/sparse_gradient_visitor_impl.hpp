@@ -0,0 +1,58 @@
+/**
+ * @file sparse_gradient_visitor_impl.hpp
+ *
+ * Implementation of the SparseGradient() and GradientColumns() function layer
+ * abstraction.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_ANN_VISITOR_SPARSE_GRADIENT_VISITOR_IMPL_HPP
+#define MLPACK_METHODS_ANN_VISITOR_SPARSE_GRADIENT_VISITOR_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "sparse_gradient_visitor.hpp"
+
+namespace mlpack {
+namespace ann {
+
+//! SparseGradientVisitor visitor class.
+inline SparseGradientVisitor::SparseGradientVisitor(arma::uvec& columns,
+                                                    size_t& rows) :
+    columns(columns),
+    rows(rows)
+{
+  /* Nothing to do here. */
+}
+
+template<typename LayerType>
+inline bool SparseGradientVisitor::operator()(LayerType* layer) const
+{
+  return LayerSparseGradient(layer);
+}
+
+template<typename T>
+inline typename std::enable_if<
+    HasSparseGradientCheck<T, bool&(T::*)()>::value, bool>::type
+SparseGradientVisitor::LayerSparseGradient(T* layer) const
+{
+  layer->SparseGradient() = true;
+  columns = layer->GradientColumns();
+  rows = layer->Parameters().n_rows;
+  return true;
+}
+
+template<typename T>
+inline typename std::enable_if<
+    !HasSparseGradientCheck<T, bool&(T::*)()>::value, bool>::type
+SparseGradientVisitor::LayerSparseGradient(T* /* layer */) const
+{
+  return false;
+}
+
+} // namespace ann
+} // namespace mlpack
+
+#endif
@@ -64,6 +64,8 @@ PARAM_INT_IN("num_tables", "Number of hash tables to use.", "t", 5);
 PARAM_INT_IN("num_projections", "Number of projections to use in each hash "
     "table.", "p", 5);
 PARAM_STRING_IN("algorithm", "Algorithm to use: 'ds' or 'qdafn'.", "a", "ds");
+PARAM_INT_IN("threads", "Number of threads to use for search (if 0, the "
+    "OpenMP default is used).", "T", 0);
 
 PARAM_UMATRIX_OUT("neighbors", "Matrix to save neighbor indices to.", "n");
 PARAM_MATRIX_OUT("distances", "Matrix to save furthest neighbor distances to.",
@@ -144,6 +146,11 @@ int main(int argc, char** argv)
         << CLI::GetParam<int>("num_projections") << "); must be greater than 0!"
         << endl;
 
+  const int threads = CLI::GetParam<int>("threads");
+  if (threads < 0)
+    Log::Fatal << "Invalid number of threads: " << threads << ".  Must be 0 or "
+        << "greater." << endl;
+
   if (CLI::HasParam("calculate_error") && !CLI::HasParam("k"))
     Log::Warn << "--calculate_error ignored because --k is not specified."
         << endl;
@@ -210,6 +217,7 @@ int main(int argc, char** argv)
       Timer::Start("drusilla_select_search");
       Log::Info << "Searching for " << k << " furthest neighbors with "
           << "DrusillaSelect..." << endl;
+      m.ds.NumThreads() = size_t(threads);
       m.ds.Search(set, k, neighbors, distances);
       Timer::Stop("drusilla_select_search");
     }
@@ -218,6 +226,7 @@ int main(int argc, char** argv)
       Timer::Start("qdafn_search");
       Log::Info << "Searching for " << k << " furthest neighbors with "
           << "QDAFN..." << endl;
+      m.qdafn.NumThreads() = size_t(threads);
       m.qdafn.Search(set, k, neighbors, distances);
       Timer::Stop("qdafn_search");
     }
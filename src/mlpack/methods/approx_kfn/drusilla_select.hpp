@@ -81,7 +81,8 @@ class DrusillaSelect
    * NeighborSearch and LSHSearch classes.  That is, each column in the
    * neighbors and distances matrices will refer to a single query point, and
    * the k'th row in that column will refer to the k'th candidate neighbor or
-   * distance for that query point.
+   * distance for that query point.  The query points are searched in parallel
+   * if OpenMP is available.
    *
    * @param querySet Set of query points to search.
    * @param k Number of furthest neighbors to search for.
@@ -109,6 +110,12 @@ class DrusillaSelect
   //! Modify the indices of points in the candidate set.  Be careful!
   arma::Col<size_t>& CandidateIndices() { return candidateIndices; }
 
+  //! Get the number of threads used for search (0 means the OpenMP default).
+  size_t NumThreads() const { return numThreads; }
+  //! Modify the number of threads used for search (0 means the OpenMP
+  //! default, and 1 disables parallel search).
+  size_t& NumThreads() { return numThreads; }
+
  private:
   //! The reference set.
   MatType candidateSet;
@@ -119,6 +126,12 @@ class DrusillaSelect
   size_t l;
   //! The number of points in each projection.
   size_t m;
+
+  //! The number of threads to use for search (0 means the OpenMP default).
+  size_t numThreads;
+
+  //! Get the number of threads to search with.
+  size_t Threads() const;
 };
 
 } // namespace neighbor
@@ -16,9 +16,7 @@
 #include "drusilla_select.hpp"
 
 #include <queue>
-#include <mlpack/methods/neighbor_search/neighbor_search_rules.hpp>
-#include <mlpack/methods/neighbor_search/sort_policies/furthest_neighbor_sort.hpp>
-#include <mlpack/core/tree/binary_space_tree.hpp>
+#include <mlpack/core/metrics/lmetric.hpp>
 #include <algorithm>
 
 namespace mlpack {
@@ -32,7 +30,8 @@ DrusillaSelect<MatType>::DrusillaSelect(const MatType& referenceSet,
     candidateSet(referenceSet.n_cols, l * m),
     candidateIndices(l * m),
     l(l),
-    m(m)
+    m(m),
+    numThreads(0)
 {
   if (l == 0)
     throw std::invalid_argument("DrusillaSelect::DrusillaSelect(): invalid "
@@ -50,7 +49,8 @@ DrusillaSelect<MatType>::DrusillaSelect(const size_t l, const size_t m) :
     candidateSet(0, l * m),
     candidateIndices(l * m),
     l(l),
-    m(m)
+    m(m),
+    numThreads(0)
 {
   if (l == 0)
     throw std::invalid_argument("DrusillaSelect::DrusillaSelect(): invalid "
@@ -179,23 +179,54 @@ void DrusillaSelect<MatType>::Search(const MatType& querySet,
     throw std::invalid_argument("DrusillaSelect::Search(): requested k is "
         "greater than number of points in candidate set!  Increase l or m.");
 
-  // We'll use the NeighborSearchRules class to perform our brute-force search.
-  // Note that we aren't using trees for our search, so we can use 'int' as a
-  // TreeType.
-  metric::EuclideanDistance metric;
-  NeighborSearchRules<FurthestNeighborSort, metric::EuclideanDistance,
-      tree::KDTree<metric::EuclideanDistance, tree::EmptyStatistic, MatType>>
-      rules(candidateSet, querySet, k, metric, 0, false);
+  neighbors.set_size(k, querySet.n_cols);
+  distances.set_size(k, querySet.n_cols);
 
-  for (size_t q = 0; q < querySet.n_cols; ++q)
-    for (size_t r = 0; r < candidateSet.n_cols; ++r)
-      rules.BaseCase(q, r);
+  // Candidates are ordered by decreasing distance; ties are broken by index,
+  // so the results don't depend on the number of threads.
+  typedef std::pair<double, size_t> Candidate;
+  struct CandidateCmp
+  {
+    bool operator()(const Candidate& c1, const Candidate& c2) const
+    {
+      return (c1.first > c2.first) ||
+          ((c1.first == c2.first) && (c1.second < c2.second));
+    }
+  };
+
+  #pragma omp parallel num_threads(Threads())
+  {
+    // The distances to every candidate, reused for each query point.
+    std::vector<Candidate> candidates(candidateSet.n_cols);
 
-  rules.GetResults(neighbors, distances);
+#ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables. If we're building for Visual Studio,
+    // use the intmax_t type instead.
+    #pragma omp for schedule(dynamic, 16)
+    for (intmax_t q = 0; q < (intmax_t) querySet.n_cols; ++q)
+#else
+    #pragma omp for schedule(dynamic, 16)
+    for (size_t q = 0; q < querySet.n_cols; ++q)
+#endif
+    {
+      for (size_t r = 0; r < candidateSet.n_cols; ++r)
+      {
+        candidates[r] = std::make_pair(metric::EuclideanDistance::Evaluate(
+            querySet.col(q), candidateSet.col(r)), r);
+      }
 
-  // Map the neighbors back to their original indices in the reference set.
-  for (size_t i = 0; i < neighbors.n_elem; ++i)
-    neighbors[i] = candidateIndices[neighbors[i]];
+      // Keep the k furthest candidates, and map them back to their original
+      // indices in the reference set.
+      std::partial_sort(candidates.begin(), candidates.begin() + k,
+          candidates.end(), CandidateCmp());
+      for (size_t j = 0; j < k; ++j)
+      {
+        neighbors(j, q) = candidateIndices[candidates[j].second];
+        distances(j, q) = candidates[j].first;
+      }
+    }
+  }
 }
 
 //! Serialize the model.
@@ -212,6 +243,16 @@ void DrusillaSelect<MatType>::Serialize(Archive& ar,
   ar & CreateNVP(m, "m");
 }
 
+template<typename MatType>
+size_t DrusillaSelect<MatType>::Threads() const
+{
+#ifdef HAS_OPENMP
+  return (numThreads == 0) ? omp_get_max_threads() : numThreads;
+#else
+  return 1;
+#endif
+}
+
 } // namespace neighbor
 } // namespace mlpack
 
@@ -72,7 +72,9 @@ class QDAFN
    * Search for the k furthest neighbors of the given query set.  (The query set
    * can contain just one point, that is okay.)  The results will be stored in
    * the given neighbors and distances matrices, in the same format as the
-   * mlpack NeighborSearch and LSHSearch classes.
+   * mlpack NeighborSearch and LSHSearch classes.  The query points are
+   * projected onto all the lines at once, and are then searched in parallel if
+   * OpenMP is available.
    */
   void Search(const MatType& querySet,
               const size_t k,
@@ -81,15 +83,26 @@ class QDAFN
 
   //! Serialize the model.
   template<typename Archive>
-  void Serialize(Archive& ar, const unsigned int /* version */);
+  void Serialize(Archive& ar, const unsigned int version);
 
   //! Get the number of projections.
-  size_t NumProjections() const { return candidateSet.size(); }
+  size_t NumProjections() const { return l; }
 
-  //! Get the candidate set for the given projection table.
-  const MatType& CandidateSet(const size_t t) const { return candidateSet[t]; }
-  //! Modify the candidate set for the given projection table.  Careful!
-  MatType& CandidateSet(const size_t t) { return candidateSet[t]; }
+  //! Get the candidate sets of all the projection tables, one after another.
+  const MatType& CandidateSet() const { return candidateSet; }
+  //! Modify the candidate sets of all the projection tables.  Careful!
+  MatType& CandidateSet() { return candidateSet; }
+  //! Get a copy of the candidate set for the given projection table.
+  MatType CandidateSet(const size_t t) const
+  {
+    return candidateSet.cols(t * m, (t + 1) * m - 1);
+  }
+
+  //! Get the number of threads used for search (0 means the OpenMP default).
+  size_t NumThreads() const { return numThreads; }
+  //! Modify the number of threads used for search (0 means the OpenMP
+  //! default, and 1 disables parallel search).
+  size_t& NumThreads() { return numThreads; }
 
  private:
   //! The number of projections.
@@ -106,13 +119,24 @@ class QDAFN
   //! Values of a_i * x for each point in S.
   arma::mat sValues;
 
-  // Candidate sets; one element in the vector for each table.
-  std::vector<MatType> candidateSet;
+  //! Candidate sets of all the tables; the candidate set of table t is held
+  //! in columns t * m to (t + 1) * m - 1.
+  MatType candidateSet;
+
+  //! The number of threads to use for search (0 means the OpenMP default).
+  size_t numThreads;
+
+  //! Get the number of threads to search with.
+  size_t Threads() const;
 };
 
 } // namespace neighbor
 } // namespace mlpack
 
+//! Set the serialization version of the QDAFN class.
+BOOST_TEMPLATE_CLASS_VERSION(template<typename MatType>,
+    mlpack::neighbor::QDAFN<MatType>, 1);
+
 // Include implementation.
 #include "qdafn_impl.hpp"
 
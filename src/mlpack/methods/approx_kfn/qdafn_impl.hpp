@@ -23,7 +23,10 @@ namespace neighbor {
 
 // Non-training constructor.
 template<typename MatType>
-QDAFN<MatType>::QDAFN(const size_t l, const size_t m) : l(l), m(m)
+QDAFN<MatType>::QDAFN(const size_t l, const size_t m) :
+    l(l),
+    m(m),
+    numThreads(0)
 {
   if (l == 0)
     throw std::invalid_argument("QDAFN::QDAFN(): l must be greater than 0!");
@@ -37,7 +40,8 @@ QDAFN<MatType>::QDAFN(const MatType& referenceSet,
                       const size_t l,
                       const size_t m) :
     l(l),
-    m(m)
+    m(m),
+    numThreads(0)
 {
   if (l == 0)
     throw std::invalid_argument("QDAFN::QDAFN(): l must be greater than 0!");
@@ -73,10 +77,9 @@ void QDAFN<MatType>::Train(const MatType& referenceSet,
   // Loop over each projection and find the top m elements.
   sIndices.set_size(m, l);
   sValues.set_size(m, l);
-  candidateSet.resize(l);
+  candidateSet.set_size(referenceSet.n_rows, l * m);
   for (size_t i = 0; i < l; ++i)
   {
-    candidateSet[i].set_size(referenceSet.n_rows, m);
     arma::uvec sortedIndices = arma::sort_index(projections.col(i), "descend");
 
     // Grab the top m elements.
@@ -84,7 +87,7 @@ void QDAFN<MatType>::Train(const MatType& referenceSet,
     {
       sIndices(j, i) = sortedIndices[j];
       sValues(j, i) = projections(sortedIndices[j], i);
-      candidateSet[i].col(j) = referenceSet.col(sortedIndices[j]);
+      candidateSet.col(i * m + j) = referenceSet.col(sortedIndices[j]);
     }
   }
 }
@@ -104,19 +107,27 @@ void QDAFN<MatType>::Search(const MatType& querySet,
   neighbors.fill(size_t() - 1);
   distances.zeros(k, querySet.n_cols);
 
+  // Project all the query points onto all the lines at once.
+  const arma::mat queryProjections = lines.t() * querySet;
+
   // Search for each point.
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables. If we're building for Visual Studio, use
+  // the intmax_t type instead.
+  #pragma omp parallel for schedule(dynamic, 16) num_threads(Threads())
+  for (intmax_t q = 0; q < (intmax_t) querySet.n_cols; ++q)
+#else
+  #pragma omp parallel for schedule(dynamic, 16) num_threads(Threads())
   for (size_t q = 0; q < querySet.n_cols; ++q)
+#endif
   {
     // Initialize a priority queue.
     // The size_t represents the index of the table, and the double represents
     // the value of l_i * S_i - l_i * query (see line 6 of Algorithm 1).
     std::priority_queue<std::pair<double, size_t>> queue;
     for (size_t i = 0; i < l; ++i)
-    {
-      const double val = sValues(0, i) - arma::dot(querySet.col(q),
-          lines.col(i));
-      queue.push(std::make_pair(val, i));
-    }
+      queue.push(std::make_pair(sValues(0, i) - queryProjections(i, q), i));
 
     // To track where we are in each S table, we keep the next index to look at
     // in each table (they start at 0).
@@ -129,7 +140,7 @@ void QDAFN<MatType>::Search(const MatType& querySet,
         resultsQueue(std::less<std::pair<double, size_t>>(), std::move(v));
     for (size_t i = 0; i < m; ++i)
     {
-      std::pair<size_t, double> p = queue.top();
+      const std::pair<double, size_t> p = queue.top();
       queue.pop();
 
       // Get index of reference point to look at.
@@ -137,7 +148,7 @@ void QDAFN<MatType>::Search(const MatType& querySet,
 
       // Calculate distance from query point.
       const double dist = mlpack::metric::EuclideanDistance::Evaluate(
-          querySet.col(q), candidateSet[p.second].col(tableIndex));
+          querySet.col(q), candidateSet.col(p.second * m + tableIndex));
 
       // Is this neighbor good enough to insert into the results?
       if (dist > resultsQueue.top().first)
@@ -146,14 +157,13 @@ void QDAFN<MatType>::Search(const MatType& querySet,
         resultsQueue.push(std::make_pair(dist, sIndices(tableIndex, p.second)));
       }
 
-      // Now (line 14) get the next element and insert into the queue.  Do this
-      // by adjusting the previous value.  Don't insert anything if we are at
-      // the end of the search, though.
+      // Now (line 14) get the next element and insert into the queue.  Don't
+      // insert anything if we are at the end of the search, though.
       if (i < m - 1)
       {
         tableLocations[p.second]++;
-        const double val = p.first - sValues(tableIndex, p.second) +
-            sValues(tableIndex + 1, p.second);
+        const double val = sValues(tableIndex + 1, p.second) -
+            queryProjections(p.second, q);
 
         queue.push(std::make_pair(val, p.second));
       }
@@ -171,7 +181,7 @@ void QDAFN<MatType>::Search(const MatType& querySet,
 
 template<typename MatType>
 template<typename Archive>
-void QDAFN<MatType>::Serialize(Archive& ar, const unsigned int /* version */)
+void QDAFN<MatType>::Serialize(Archive& ar, const unsigned int version)
 {
   using data::CreateNVP;
 
@@ -181,9 +191,31 @@ void QDAFN<MatType>::Serialize(Archive& ar, const unsigned int /* version */)
   ar & CreateNVP(projections, "projections");
   ar & CreateNVP(sIndices, "sIndices");
   ar & CreateNVP(sValues, "sValues");
-  if (Archive::is_loading::value)
-    candidateSet.clear();
-  ar & CreateNVP(candidateSet, "candidateSet");
+
+  // Before version 1, the candidate set of each table was held separately.
+  if (version == 0)
+  {
+    std::vector<MatType> tableCandidates;
+    ar & CreateNVP(tableCandidates, "candidateSet");
+
+    candidateSet.set_size(lines.n_rows, l * m);
+    for (size_t i = 0; i < tableCandidates.size(); ++i)
+      candidateSet.cols(i * m, (i + 1) * m - 1) = tableCandidates[i];
+  }
+  else
+  {
+    ar & CreateNVP(candidateSet, "candidateSet");
+  }
+}
+
+template<typename MatType>
+size_t QDAFN<MatType>::Threads() const
+{
+#ifdef HAS_OPENMP
+  return (numThreads == 0) ? omp_get_max_threads() : numThreads;
+#else
+  return 1;
+#endif
 }
 
 } // namespace neighbor
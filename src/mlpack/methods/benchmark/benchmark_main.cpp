@@ -0,0 +1,494 @@
+/**
+ * @file benchmark_main.cpp
+ *
+ * An end-to-end benchmark of the core methods of mlpack: k-nearest-neighbor
+ * search, k-means clustering, GMM training and decision tree training are run
+ * on synthetic and given datasets, at several sizes and numbers of threads,
+ * and the wall time, the time of each phase, the peak memory and the
+ * throughput of each run are saved as JSON, to be compared between releases.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/util/cli.hpp>
+#include <mlpack/core/util/numa.hpp>
+#include <mlpack/core/util/version.hpp>
+
+#include <mlpack/methods/neighbor_search/neighbor_search.hpp>
+#include <mlpack/methods/kmeans/kmeans.hpp>
+#include <mlpack/methods/gmm/gmm.hpp>
+#include <mlpack/methods/decision_tree/decision_tree.hpp>
+
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#ifndef _WIN32
+  #include <sys/resource.h>
+#endif
+
+using namespace std;
+using namespace mlpack;
+using namespace mlpack::neighbor;
+using namespace mlpack::kmeans;
+using namespace mlpack::gmm;
+using namespace mlpack::tree;
+
+PROGRAM_INFO("End-to-end Benchmark",
+    "This program benchmarks the core methods of mlpack, as they are run by "
+    "the mlpack_knn, mlpack_kmeans, mlpack_gmm_train and mlpack_decision_tree "
+    "programs.  The benchmarks are given with --benchmarks (-b); by default, "
+    "all of 'knn', 'kmeans', 'gmm_train' and 'decision_tree' are run.  Each "
+    "benchmark is run:"
+    "\n\n"
+    " - on synthetic datasets (a mixture of --classes (-c) Gaussians in "
+    "--dimensions (-d) dimensions) with each number of points of --sizes (-S), "
+    "and on each dataset of --datasets (-D) (the labels of the points, needed "
+    "by the decision tree, are given with --labels (-L), one file per "
+    "dataset; without them, the decision tree isn't run on the datasets),\n"
+    " - with each number of threads of --threads (-t) (by default, 1 and the "
+    "maximum number of threads)."
+    "\n\n"
+    "For each run, the following are saved:"
+    "\n\n"
+    " - the wall time of the run (wall_time, in seconds),\n"
+    " - the time of each phase, from the timers of mlpack (phases, in seconds: "
+    "'training' and 'prediction' for all the methods, and 'tree_building' and "
+    "'computing_neighbors' for the neighbor search),\n"
+    " - the peak resident memory of the run (peak_rss, in bytes; on Linux the "
+    "peak is reset before each run, elsewhere it is the peak of the program so "
+    "far, and it is 0 on Windows),\n"
+    " - the number of points processed per second (throughput)."
+    "\n\n"
+    "Each run is repeated --trials (-T) times and the fastest one is saved.  "
+    "The random seed is fixed (--seed (-s)) and reset before each run, so all "
+    "the runs of a dataset do the same work.  The results are saved as JSON to "
+    "--output_file (-o), or printed if no file is given; for example,"
+    "\n\n"
+    "$ mlpack_benchmark --sizes 10000 100000 --threads 1 4 -o results.json"
+    "\n\n"
+    "On multi-socket machines, the --numa (-N) flag enables NUMA placement of "
+    "the datasets and threads (as the MLPACK_NUMA environment variable does "
+    "for all programs); comparing the scaling over the numbers of threads with "
+    "and without it shows how much the remote memory accesses cost.");
+
+PARAM_VECTOR_IN(string, "benchmarks", "Benchmarks to run (by default, all of "
+    "them).", "b");
+PARAM_VECTOR_IN(int, "sizes", "Numbers of points of the synthetic datasets "
+    "(by default, 10000 and 100000).", "S");
+PARAM_INT_IN("dimensions", "Dimensionality of the synthetic datasets.", "d",
+    10);
+PARAM_INT_IN("classes", "Number of classes (Gaussians) of the synthetic "
+    "datasets; also the number of clusters of k-means and of Gaussians of the "
+    "GMM.", "c", 8);
+PARAM_VECTOR_IN(string, "datasets", "Files holding other datasets to run on.",
+    "D");
+PARAM_VECTOR_IN(string, "labels", "Files holding the labels of the datasets of "
+    "--datasets, in the same order.", "L");
+PARAM_VECTOR_IN(int, "threads", "Numbers of threads to run with (by default, "
+    "1 and the maximum number of threads).", "t");
+
+PARAM_INT_IN("k", "Number of nearest neighbors to find.", "k", 5);
+PARAM_INT_IN("max_iterations", "Number of iterations of k-means and of the EM "
+    "algorithm of the GMM.", "n", 10);
+PARAM_INT_IN("minimum_leaf_size", "Minimum number of points in a leaf of the "
+    "decision tree.", "m", 10);
+PARAM_INT_IN("trials", "Number of times each run is repeated.", "T", 3);
+
+PARAM_STRING_IN("output_file", "File to save the results to (JSON).", "o", "");
+PARAM_INT_IN("seed", "Random seed.", "s", 42);
+PARAM_FLAG("numa", "Spread the datasets and the threads over the NUMA nodes of "
+    "the machine.", "N");
+
+// The timers of mlpack that are saved as phases.  The timers are additive, so
+// the time of a phase in a run is the increase of its timer.
+static const char* phaseNames[] = { "training", "prediction", "tree_building",
+    "computing_neighbors" };
+static const size_t numPhases = 4;
+
+// A dataset to run the benchmarks on.
+struct Dataset
+{
+  string name;
+  arma::mat points;
+  arma::Row<size_t> labels;
+  size_t numClasses;
+};
+
+// The measurements of a run.
+struct Run
+{
+  double wallTime;
+  arma::vec phases;
+  size_t peakMemory;
+};
+
+// Return the number of seconds since the given time.
+static double SecondsSince(const chrono::steady_clock::time_point& start)
+{
+  return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+// Reset the peak resident memory of the program, if the system allows it.
+static void ResetPeakMemory()
+{
+#ifdef __linux__
+  // Writing 5 to clear_refs resets the peak resident memory (VmHWM) to the
+  // current resident memory.
+  ofstream clearRefs("/proc/self/clear_refs");
+  if (clearRefs.is_open())
+    clearRefs << "5";
+#endif
+}
+
+// Get the peak resident memory of the program, in bytes.
+static size_t PeakMemory()
+{
+#ifdef __linux__
+  ifstream status("/proc/self/status");
+  string line;
+  while (getline(status, line))
+    if (line.compare(0, 6, "VmHWM:") == 0)
+      return 1024 * strtoull(line.c_str() + 6, NULL, 10);
+#endif
+
+#if defined(_WIN32)
+  return 0;
+#else
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0)
+    return 0;
+
+  #ifdef __APPLE__
+    return usage.ru_maxrss;
+  #else
+    return 1024 * usage.ru_maxrss;
+  #endif
+#endif
+}
+
+// Get the current values of the phase timers, in seconds.
+static arma::vec PhaseTimes()
+{
+  arma::vec times(numPhases);
+  for (size_t p = 0; p < numPhases; ++p)
+    times[p] = Timer::Get(phaseNames[p]).count() / 1e6;
+  return times;
+}
+
+// Generate a mixture of Gaussians with unit covariance, whose means are
+// uniformly spread in a cube; the label of a point is its Gaussian.
+static void GenerateDataset(const size_t points,
+                            const size_t dimensions,
+                            const size_t classes,
+                            Dataset& dataset)
+{
+  const arma::mat means = 10.0 * arma::randu<arma::mat>(dimensions, classes);
+
+  dataset.name = "synthetic";
+  dataset.points.randn(dimensions, points);
+  dataset.labels.set_size(points);
+  dataset.numClasses = classes;
+  for (size_t i = 0; i < points; ++i)
+  {
+    dataset.labels[i] = i % classes;
+    dataset.points.col(i) += means.col(dataset.labels[i]);
+  }
+}
+
+// Run the given benchmark once on the given dataset.
+static Run RunBenchmark(const string& benchmark, const Dataset& dataset)
+{
+  const size_t k = (size_t) CLI::GetParam<int>("k");
+  const size_t clusters = (size_t) CLI::GetParam<int>("classes");
+  const size_t maxIterations = (size_t) CLI::GetParam<int>("max_iterations");
+  const size_t minimumLeafSize =
+      (size_t) CLI::GetParam<int>("minimum_leaf_size");
+
+  Run run;
+  ResetPeakMemory();
+  const arma::vec startPhases = PhaseTimes();
+  const chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+  if (benchmark == "knn")
+  {
+    Timer::Start("training");
+    KNN knn(dataset.points);
+    Timer::Stop("training");
+
+    arma::Mat<size_t> neighbors;
+    arma::mat distances;
+    Timer::Start("prediction");
+    knn.Search(k, neighbors, distances);
+    Timer::Stop("prediction");
+  }
+  else if (benchmark == "kmeans")
+  {
+    KMeans<> kmeans(maxIterations);
+    arma::Row<size_t> assignments;
+    arma::mat centroids;
+    Timer::Start("training");
+    kmeans.Cluster(dataset.points, clusters, assignments, centroids);
+    Timer::Stop("training");
+  }
+  else if (benchmark == "gmm_train")
+  {
+    GMM gmm(clusters, dataset.points.n_rows);
+    arma::Row<size_t> labels;
+    Timer::Start("training");
+    gmm.Train(dataset.points, 1, false, EMFit<>(maxIterations));
+    Timer::Stop("training");
+
+    Timer::Start("prediction");
+    gmm.Classify(dataset.points, labels);
+    Timer::Stop("prediction");
+  }
+  else // benchmark == "decision_tree"
+  {
+    DecisionTree<> tree;
+    arma::Row<size_t> predictions;
+    Timer::Start("training");
+    tree.Train(dataset.points, dataset.labels, dataset.numClasses,
+        minimumLeafSize);
+    Timer::Stop("training");
+
+    Timer::Start("prediction");
+    tree.Classify(dataset.points, predictions);
+    Timer::Stop("prediction");
+  }
+
+  run.wallTime = SecondsSince(start);
+  run.phases = PhaseTimes() - startPhases;
+  run.peakMemory = PeakMemory();
+  return run;
+}
+
+// Escape the given string for JSON.
+static string Quote(const string& s)
+{
+  ostringstream quoted;
+  quoted << '"';
+  for (size_t i = 0; i < s.size(); ++i)
+  {
+    if (s[i] == '"' || s[i] == '\\')
+      quoted << '\\' << s[i];
+    else if ((unsigned char) s[i] < 0x20)
+      quoted << "\\u00" << "0123456789abcdef"[s[i] >> 4]
+          << "0123456789abcdef"[s[i] & 0xf];
+    else
+      quoted << s[i];
+  }
+  quoted << '"';
+  return quoted.str();
+}
+
+int main(int argc, char** argv)
+{
+  CLI::ParseCommandLine(argc, argv);
+
+  // Sanity checks on the parameters.
+  vector<string> benchmarks = CLI::GetParam<vector<string>>("benchmarks");
+  if (benchmarks.empty())
+    benchmarks = { "knn", "kmeans", "gmm_train", "decision_tree" };
+  for (size_t b = 0; b < benchmarks.size(); ++b)
+    if (benchmarks[b] != "knn" && benchmarks[b] != "kmeans" &&
+        benchmarks[b] != "gmm_train" && benchmarks[b] != "decision_tree")
+      Log::Fatal << "Unknown benchmark '" << benchmarks[b] << "'; valid "
+          << "choices are 'knn', 'kmeans', 'gmm_train' and 'decision_tree'."
+          << endl;
+
+  vector<int> sizes = CLI::GetParam<vector<int>>("sizes");
+  if (!CLI::HasParam("sizes"))
+    sizes = { 10000, 100000 };
+  for (size_t s = 0; s < sizes.size(); ++s)
+    if (sizes[s] < 1)
+      Log::Fatal << "Invalid size: " << sizes[s] << ".  Must be greater than "
+          << "0." << endl;
+
+  const int dimensions = CLI::GetParam<int>("dimensions");
+  if (dimensions < 1)
+    Log::Fatal << "Invalid dimensionality: " << dimensions << ".  Must be "
+        << "greater than 0." << endl;
+
+  const int classes = CLI::GetParam<int>("classes");
+  if (classes < 1)
+    Log::Fatal << "Invalid number of classes: " << classes << ".  Must be "
+        << "greater than 0." << endl;
+
+  const int k = CLI::GetParam<int>("k");
+  if (k < 1)
+    Log::Fatal << "Invalid k: " << k << ".  Must be greater than 0." << endl;
+
+  const int maxIterations = CLI::GetParam<int>("max_iterations");
+  if (maxIterations < 1)
+    Log::Fatal << "Invalid number of iterations: " << maxIterations << ".  "
+        << "Must be greater than 0." << endl;
+
+  const int minimumLeafSize = CLI::GetParam<int>("minimum_leaf_size");
+  if (minimumLeafSize < 1)
+    Log::Fatal << "Invalid minimum leaf size: " << minimumLeafSize << ".  "
+        << "Must be greater than 0." << endl;
+
+  const int trials = CLI::GetParam<int>("trials");
+  if (trials < 1)
+    Log::Fatal << "Invalid number of trials: " << trials << ".  Must be "
+        << "greater than 0." << endl;
+
+  const vector<string> datasetFiles =
+      CLI::GetParam<vector<string>>("datasets");
+  const vector<string> labelsFiles = CLI::GetParam<vector<string>>("labels");
+  if (!labelsFiles.empty() && labelsFiles.size() != datasetFiles.size())
+    Log::Fatal << "The number of labels files (" << labelsFiles.size() << ") "
+        << "must match the number of datasets (" << datasetFiles.size() << ")."
+        << endl;
+
+#ifdef HAS_OPENMP
+  const int maxThreads = omp_get_max_threads();
+#else
+  const int maxThreads = 1;
+#endif
+  vector<int> threads = CLI::GetParam<vector<int>>("threads");
+  if (!CLI::HasParam("threads"))
+  {
+    threads = { 1 };
+    if (maxThreads > 1)
+      threads.push_back(maxThreads);
+  }
+  for (size_t t = 0; t < threads.size(); ++t)
+  {
+    if (threads[t] < 1)
+      Log::Fatal << "Invalid number of threads: " << threads[t] << ".  Must "
+          << "be greater than 0." << endl;
+#ifndef HAS_OPENMP
+    if (threads[t] > 1)
+      Log::Fatal << "Invalid number of threads: " << threads[t] << ".  mlpack "
+          << "was built without OpenMP, so only 1 thread can be used." << endl;
+#endif
+  }
+
+  const string outputFile = CLI::GetParam<string>("output_file");
+  ofstream output;
+  if (outputFile != "")
+  {
+    output.open(outputFile.c_str());
+    if (!output.is_open())
+      Log::Fatal << "Could not open output file '" << outputFile << "'!"
+          << endl;
+  }
+
+  const size_t seed = (size_t) CLI::GetParam<int>("seed");
+
+  if (CLI::HasParam("numa"))
+    NUMA::Enable();
+
+  // The datasets are made or loaded one at a time, to keep the memory of the
+  // runs comparable.
+  ostringstream json;
+  json.precision(10);
+  json << "{" << endl
+      << "  \"version\": " << Quote(util::GetVersion()) << "," << endl
+      << "  \"max_threads\": " << maxThreads << "," << endl
+      << "  \"numa\": " << (NUMA::Enabled() ? "true" : "false") << "," << endl
+      << "  \"numa_nodes\": " << NUMA::Nodes() << "," << endl
+      << "  \"seed\": " << seed << "," << endl
+      << "  \"trials\": " << trials << "," << endl
+      << "  \"results\": [";
+
+  bool first = true;
+  for (size_t d = 0; d < sizes.size() + datasetFiles.size(); ++d)
+  {
+    Dataset dataset;
+    math::RandomSeed(seed);
+    if (d < sizes.size())
+    {
+      GenerateDataset(sizes[d], dimensions, classes, dataset);
+      NUMA::FirstTouch(dataset.points);
+    }
+    else
+    {
+      const size_t f = d - sizes.size();
+      dataset.name = datasetFiles[f];
+      data::Load(datasetFiles[f], dataset.points, true);
+      if (!labelsFiles.empty())
+      {
+        data::Load(labelsFiles[f], dataset.labels, true);
+        if (dataset.labels.n_elem != dataset.points.n_cols)
+          Log::Fatal << "The labels file '" << labelsFiles[f] << "' has "
+              << dataset.labels.n_elem << " labels, but the dataset has "
+              << dataset.points.n_cols << " points." << endl;
+        dataset.numClasses = arma::max(dataset.labels) + 1;
+      }
+    }
+
+    for (size_t b = 0; b < benchmarks.size(); ++b)
+    {
+      if (benchmarks[b] == "decision_tree" && dataset.labels.is_empty())
+      {
+        Log::Warn << "Skipping the decision tree on '" << dataset.name << "', "
+            << "which has no labels." << endl;
+        continue;
+      }
+      if (benchmarks[b] == "knn" && size_t(k) >= dataset.points.n_cols)
+      {
+        Log::Warn << "Skipping the neighbor search on '" << dataset.name
+            << "', which has " << dataset.points.n_cols << " points only."
+            << endl;
+        continue;
+      }
+
+      for (size_t t = 0; t < threads.size(); ++t)
+      {
+#ifdef HAS_OPENMP
+        omp_set_num_threads(threads[t]);
+#endif
+        Log::Info << "Running '" << benchmarks[b] << "' on '" << dataset.name
+            << "' (" << dataset.points.n_cols << " points) with " << threads[t]
+            << " threads." << endl;
+
+        Run best;
+        best.wallTime = DBL_MAX;
+        for (int trial = 0; trial < trials; ++trial)
+        {
+          math::RandomSeed(seed);
+          const Run run = RunBenchmark(benchmarks[b], dataset);
+          if (run.wallTime < best.wallTime)
+            best = run;
+        }
+
+        json << (first ? "" : ",") << endl
+            << "    {" << endl
+            << "      \"benchmark\": " << Quote(benchmarks[b]) << "," << endl
+            << "      \"dataset\": " << Quote(dataset.name) << "," << endl
+            << "      \"points\": " << dataset.points.n_cols << "," << endl
+            << "      \"dimensions\": " << dataset.points.n_rows << "," << endl
+            << "      \"threads\": " << threads[t] << "," << endl
+            << "      \"wall_time\": " << best.wallTime << "," << endl
+            << "      \"phases\": {";
+        for (size_t p = 0; p < numPhases; ++p)
+        {
+          json << (p == 0 ? " " : ", ") << Quote(phaseNames[p]) << ": "
+              << best.phases[p];
+        }
+        json << " }," << endl
+            << "      \"peak_rss\": " << best.peakMemory << "," << endl
+            << "      \"throughput\": "
+            << dataset.points.n_cols / best.wallTime << endl
+            << "    }";
+        first = false;
+      }
+    }
+  }
+
+  json << endl << "  ]" << endl << "}" << endl;
+
+  if (outputFile != "")
+    output << json.str();
+  else
+    cout << json.str();
+
+  CLI::Destroy();
+}
@@ -15,15 +15,18 @@
 namespace mlpack {
 namespace svd {
 
-RandomizedBlockKrylovSVD::RandomizedBlockKrylovSVD(const arma::mat& data,
-                                                   arma::mat& u,
-                                                   arma::vec& s,
-                                                   arma::mat& v,
-                                                   const size_t maxIterations,
-                                                   const size_t rank,
-                                                   const size_t blockSize) :
+RandomizedBlockKrylovSVD::RandomizedBlockKrylovSVD(
+    const arma::mat& data,
+    arma::mat& u,
+    arma::vec& s,
+    arma::mat& v,
+    const size_t maxIterations,
+    const size_t rank,
+    const size_t blockSize,
+    const RandomSketch::SketchType sketchType) :
     maxIterations(maxIterations),
-    blockSize(blockSize)
+    blockSize(blockSize),
+    sketchType(sketchType)
 {
   if (rank == 0)
   {
@@ -35,10 +38,13 @@ RandomizedBlockKrylovSVD::RandomizedBlockKrylovSVD(const arma::mat& data,
   }
 }
 
-RandomizedBlockKrylovSVD::RandomizedBlockKrylovSVD(const size_t maxIterations,
-                                                   const size_t blockSize) :
+RandomizedBlockKrylovSVD::RandomizedBlockKrylovSVD(
+    const size_t maxIterations,
+    const size_t blockSize,
+    const RandomSketch::SketchType sketchType) :
     maxIterations(maxIterations),
-    blockSize(blockSize)
+    blockSize(blockSize),
+    sketchType(sketchType)
 {
   /* Nothing to do here */
 }
@@ -56,16 +62,22 @@ void RandomizedBlockKrylovSVD::Apply(const arma::mat& data,
     blockSize = rank + 10;
   }
 
-  // Random block initialization.
-  arma::mat G = arma::randn(data.n_cols, blockSize);
-
   // Construct and orthonormalize Krylov subspace.
   arma::mat K(data.n_rows, blockSize * (maxIterations + 1));
 
+  // The products of each iteration are written into these workspaces, so they
+  // are allocated only once.
+  arma::mat product, projection(data.n_cols, blockSize);
+
+  // Random block initialization.
+  RandomSketch sketch(sketchType);
+  sketch.Reset(data.n_cols, blockSize);
+  sketch.Apply(data, product);
+
   // Create a working matrix using data from writable auxiliary memory
   // (K matrix). Doing so avoids an uncessary copy in upcoming step.
   block = arma::mat(K.memptr(), data.n_rows, blockSize, false, false);
-  arma::qr_econ(block, R, data * G);
+  arma::qr_econ(block, R, product);
 
   for (size_t blockOffset = block.n_elem; blockOffset < K.n_elem;
       blockOffset += block.n_elem)
@@ -74,7 +86,9 @@ void RandomizedBlockKrylovSVD::Apply(const arma::mat& data,
     blockIteration = arma::mat(K.memptr() + blockOffset, block.n_rows,
         block.n_cols, false, false);
 
-    arma::qr_econ(blockIteration, R, data * (data.t() * block));
+    projection = data.t() * block;
+    product = data * projection;
+    arma::qr_econ(blockIteration, R, product);
 
     // Update working matrix for the next iteration.
     block = arma::mat(K.memptr() + blockOffset, block.n_rows, block.n_cols,
@@ -14,6 +14,7 @@
 #define MLPACK_METHODS_BLOCK_KRYLOV_SVD_RANDOMIZED_BLOCK_KRYLOV_SVD_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <mlpack/methods/randomized_svd/random_sketch.hpp>
 
 namespace mlpack {
 namespace svd {
@@ -39,6 +40,10 @@ namespace svd {
  * }
  * @endcode
  *
+ * The random starting block is a RandomSketch (a Gaussian matrix drawn in
+ * parallel, or a sparse CountSketch matrix), and the products of each Krylov
+ * iteration are written into the same preallocated workspaces.
+ *
  * An example of how to use the interface is shown below:
  *
  * @code
@@ -69,6 +74,7 @@ class RandomizedBlockKrylovSVD
    *        (Default: 2).
    * @param rank Rank of the approximation (Default: number of rows.)
    * @param blockSize The block size, must be >= rank (Default: rank + 10).
+   * @param sketchType The kind of random starting block.
    */
   RandomizedBlockKrylovSVD(const arma::mat& data,
                            arma::mat& u,
@@ -76,7 +82,9 @@ class RandomizedBlockKrylovSVD
                            arma::mat& v,
                            const size_t maxIterations = 2,
                            const size_t rank = 0,
-                           const size_t blockSize = 0);
+                           const size_t blockSize = 0,
+                           const RandomSketch::SketchType sketchType =
+                               RandomSketch::GAUSSIAN);
 
   /**
    * Create object for the randomized block krylov SVD method.
@@ -84,9 +92,12 @@ class RandomizedBlockKrylovSVD
    * @param maxIterations Number of iterations for the power method
    *        (Default: 2).
    * @param blockSize The block size, must be >= rank (Default: rank + 10).
+   * @param sketchType The kind of random starting block.
    */
   RandomizedBlockKrylovSVD(const size_t maxIterations = 2,
-                           const size_t blockSize = 0);
+                           const size_t blockSize = 0,
+                           const RandomSketch::SketchType sketchType =
+                               RandomSketch::GAUSSIAN);
 
   /**
    * Apply Principal Component Analysis to the provided data set using the
@@ -114,12 +125,20 @@ class RandomizedBlockKrylovSVD
   //! Modify the block size.
   size_t& BlockSize() { return blockSize; }
 
+  //! Get the kind of random starting block.
+  RandomSketch::SketchType SketchType() const { return sketchType; }
+  //! Modify the kind of random starting block.
+  RandomSketch::SketchType& SketchType() { return sketchType; }
+
  private:
   //! Locally stored number of iterations for the power method.
   size_t maxIterations;
 
   //! The block size value.
   size_t blockSize;
+
+  //! The kind of random starting block.
+  RandomSketch::SketchType sketchType;
 };
 
 } // namespace svd
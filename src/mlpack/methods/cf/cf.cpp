@@ -15,7 +15,7 @@
  */
 #include "cf.hpp"
 
-#include <queue>
+#include <algorithm>
 
 namespace mlpack {
 namespace cf {
@@ -24,7 +24,9 @@ namespace cf {
 CF::CF(const size_t numUsersForSimilarity,
        const size_t rank) :
     numUsersForSimilarity(numUsersForSimilarity),
-    rank(rank)
+    rank(rank),
+    itemFastMKS(false, true),
+    itemIndex(EXHAUSTIVE_ITEM_SEARCH)
 {
   // Validate neighbourhood size.
   if (numUsersForSimilarity < 1)
@@ -37,7 +39,8 @@ CF::CF(const size_t numUsersForSimilarity,
 }
 
 void CF::GetRecommendations(const size_t numRecs,
-                            arma::Mat<size_t>& recommendations)
+                            arma::Mat<size_t>& recommendations,
+                            const ItemSearchMode itemSearch)
 {
   // Generate list of users.  Maybe it would be more efficient to pass an empty
   // users list, and then have the other overload of GetRecommendations() assume
@@ -47,92 +50,159 @@ void CF::GetRecommendations(const size_t numRecs,
       cleanedData.n_cols - 1, cleanedData.n_cols);
 
   // Call the main overload for recommendations.
-  GetRecommendations(numRecs, recommendations, users);
+  GetRecommendations(numRecs, recommendations, users, itemSearch);
 }
 
 void CF::GetRecommendations(const size_t numRecs,
                             arma::Mat<size_t>& recommendations,
-                            const arma::Col<size_t>& users)
+                            const arma::Col<size_t>& users,
+                            const ItemSearchMode itemSearch)
 {
-  // We want to avoid calculating the full rating matrix, so we will do nearest
-  // neighbor search only on the H matrix, using the observation that if the
-  // rating matrix X = W*H, then d(X.col(i), X.col(j)) = d(W H.col(i), W
-  // H.col(j)).  This can be seen as nearest neighbor search on the H matrix
-  // with the Mahalanobis distance where M^{-1} = W^T W.  So, we'll decompose
-  // M^{-1} = L L^T (the Cholesky decomposition), and then multiply H by L^T.
-  // Then we can perform nearest neighbor search.
-  arma::mat l = arma::chol(w.t() * w);
-  arma::mat stretchedH = l * h; // Due to the Armadillo API, l is L^T.
-
-  // Now, we will use the decomposed w and h matrices to estimate what the user
-  // would have rated items as, and then pick the best items.
-
-  // Temporarily store feature vector of queried users.
-  arma::mat query(stretchedH.n_rows, users.n_elem);
-
-  // Select feature vectors of queried users.
-  for (size_t i = 0; i < users.n_elem; i++)
-    query.col(i) = stretchedH.col(users(i));
-
-  // Temporary storage for neighborhood of the queried users.
-  arma::Mat<size_t> neighborhood;
+  if (itemSearch != EXHAUSTIVE_ITEM_SEARCH)
+    BuildItemIndex(itemSearch);
 
   // Calculate the neighborhood of the queried users.
-  // This should be a templatized option.
-  neighbor::KNN a(stretchedH);
+  arma::Mat<size_t> neighborhood;
   arma::mat resultingDistances; // Temporary storage.
-  a.Search(query, numUsersForSimilarity, neighborhood, resultingDistances);
+  userIndex.Search(UserQueries(users), numUsersForSimilarity, neighborhood,
+      resultingDistances);
+
+  // Since the estimated ratings of a user are W times its column of H, the
+  // average of the estimated ratings of the neighborhood is W times the average
+  // of their columns of H.  So the averages of a block of users are one matrix
+  // product, and the blocks are small enough that their averages take about
+  // 64MB.
+  const size_t numItems = cleanedData.n_rows;
+  const size_t blockSize = std::max((size_t) 1, std::min((size_t) users.n_elem,
+      (size_t(1) << 23) / std::max((size_t) 1, numItems)));
 
-  // Generate recommendations for each query user by finding the maximum numRecs
-  // elements in the averages matrix.
   recommendations.set_size(numRecs, users.n_elem);
-  arma::mat values(numRecs, users.n_elem);
-
-  for (size_t i = 0; i < users.n_elem; i++)
+  std::vector<char> incomplete(users.n_elem, 0);
+  for (size_t begin = 0; begin < users.n_elem; begin += blockSize)
   {
-    // First, calculate average of neighborhood values.
-    arma::vec averages;
-    averages.zeros(cleanedData.n_rows);
-
-    for (size_t j = 0; j < neighborhood.n_rows; ++j)
-      averages += w * h.col(neighborhood(j, i));
-    averages /= neighborhood.n_rows;
-
-    // Let's build the list of candidate recomendations for the given user.
-    // Default candidate: the smallest possible value and invalid item number.
-    const Candidate def = std::make_pair(-DBL_MAX, cleanedData.n_rows);
-    std::vector<Candidate> vect(numRecs, def);
-    typedef std::priority_queue<Candidate, std::vector<Candidate>, CandidateCmp>
-        CandidateList;
-    CandidateList pqueue(CandidateCmp(), std::move(vect));
-
-    // Look through the averages column corresponding to the current user.
-    for (size_t j = 0; j < averages.n_rows; ++j)
+    const size_t count = std::min(blockSize, users.n_elem - begin);
+    arma::mat averageH(h.n_rows, count, arma::fill::zeros);
+
+#ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables. If we're building for Visual Studio,
+    // use the intmax_t type instead.
+    #pragma omp parallel for schedule(static)
+    for (intmax_t i = 0; i < (intmax_t) count; ++i)
+#else
+    #pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < count; ++i)
+#endif
     {
-      // Ensure that the user hasn't already rated the item.
-      if (cleanedData(j, users(i)) != 0.0)
-        continue; // The user already rated the item.
+      for (size_t j = 0; j < neighborhood.n_rows; ++j)
+        averageH.col(i) += h.col(neighborhood(j, begin + i));
+      averageH.col(i) /= neighborhood.n_rows;
+    }
 
+    // Either estimate the rating of every item, or find the best items with
+    // the item index; in that case enough of them are found that at least
+    // numRecs are unrated.
+    arma::mat averages;
+    arma::Mat<size_t> bestItems;
+    if (itemSearch == EXHAUSTIVE_ITEM_SEARCH)
+    {
+      averages = w * averageH;
+    }
+    else
+    {
+      size_t maxRated = 0;
+      for (size_t i = 0; i < count; ++i)
+      {
+        const size_t user = users(begin + i);
+        maxRated = std::max(maxRated, (size_t) (cleanedData.col_ptrs[user + 1] -
+            cleanedData.col_ptrs[user]));
+      }
 
-      // Is the estimated value better than the worst candidate?
-      if (averages[i] > pqueue.top().first)
+      const size_t k = std::min(numItems, numRecs + maxRated);
+      arma::mat values; // Temporary storage.
+      if (itemSearch == FASTMKS_ITEM_SEARCH)
       {
-        Candidate c = std::make_pair(averages[j], j);
-        pqueue.pop();
-        pqueue.push(c);
+        itemFastMKS.Search(averageH, k, bestItems, values);
+      }
+      else
+      {
+        // The queries get a last coordinate of 0 (see BuildItemIndex()).
+        const arma::mat queries = arma::join_cols(averageH,
+            arma::zeros<arma::rowvec>(count));
+        itemLSH.Search(queries, k, bestItems, values);
       }
     }
 
-    for (size_t p = 1; p <= numRecs; p++)
+    // Pick the best items of each user in the block, among the items it hasn't
+    // rated.
+#ifdef _WIN32
+    #pragma omp parallel for schedule(dynamic)
+    for (intmax_t i = 0; i < (intmax_t) count; ++i)
+#else
+    #pragma omp parallel for schedule(dynamic)
+    for (size_t i = 0; i < count; ++i)
+#endif
     {
-      recommendations(numRecs - p, i) = pqueue.top().second;
-      values(numRecs - p, i) = pqueue.top().first;
-      pqueue.pop();
+      const size_t user = users(begin + i);
+
+      // The rated items of the user are the sorted row indices of its column.
+      const arma::uword* rated = cleanedData.row_indices +
+          cleanedData.col_ptrs[user];
+      const arma::uword* ratedEnd = cleanedData.row_indices +
+          cleanedData.col_ptrs[user + 1];
+
+      size_t found = 0;
+      if (itemSearch == EXHAUSTIVE_ITEM_SEARCH)
+      {
+        std::vector<Candidate> candidates;
+        candidates.reserve(numItems - (ratedEnd - rated));
+        for (size_t j = 0; j < numItems; ++j)
+        {
+          if (rated != ratedEnd && *rated == j)
+          {
+            ++rated; // The user already rated the item.
+            continue;
+          }
+
+          candidates.push_back(std::make_pair(averages(j, i), j));
+        }
+
+        found = std::min(numRecs, (size_t) candidates.size());
+        std::partial_sort(candidates.begin(), candidates.begin() + found,
+            candidates.end(), CandidateCmp());
+
+        for (size_t p = 0; p < found; ++p)
+          recommendations(p, begin + i) = candidates[p].second;
+      }
+      else
+      {
+        // The items found are in order, best first; an approximate search
+        // marks the items it didn't find with the number of items.
+        for (size_t j = 0; j < bestItems.n_rows && found < numRecs; ++j)
+        {
+          const size_t item = bestItems(j, i);
+          if (item >= numItems || std::binary_search(rated, ratedEnd,
+              (arma::uword) item))
+            continue;
+
+          recommendations(found++, begin + i) = item;
+        }
+      }
+
+      // Fill in the recommendations we were not able to come up with with an
+      // invalid item number.
+      for (size_t p = found; p < numRecs; ++p)
+        recommendations(p, begin + i) = numItems;
+      if (found < numRecs)
+        incomplete[begin + i] = 1;
     }
+  }
 
-    // If we were not able to come up with enough recommendations, issue a
-    // warning.
-    if (recommendations(numRecs - 1, i) == def.second)
+  // If we were not able to come up with enough recommendations, issue a
+  // warning.
+  for (size_t i = 0; i < users.n_elem; ++i)
+  {
+    if (incomplete[i])
       Log::Warn << "Could not provide " << numRecs << " recommendations "
           << "for user " << users(i) << " (not enough un-rated items)!"
           << std::endl;
@@ -144,32 +214,14 @@ double CF::Predict(const size_t user, const size_t item) const
 {
   // First, we need to find the nearest neighbors of the given user.
   // We'll use the same technique as for GetRecommendations().
-
-  // We want to avoid calculating the full rating matrix, so we will do nearest
-  // neighbor search only on the H matrix, using the observation that if the
-  // rating matrix X = W*H, then d(X.col(i), X.col(j)) = d(W H.col(i), W
-  // H.col(j)).  This can be seen as nearest neighbor search on the H matrix
-  // with the Mahalanobis distance where M^{-1} = W^T W.  So, we'll decompose
-  // M^{-1} = L L^T (the Cholesky decomposition), and then multiply H by L^T.
-  // Then we can perform nearest neighbor search.
-  arma::mat l = arma::chol(w.t() * w);
-  arma::mat stretchedH = l * h; // Due to the Armadillo API, l is L^T.
-
-  // Now, we will use the decomposed w and h matrices to estimate what the user
-  // would have rated items as, and then pick the best items.
-
-  // Temporarily store feature vector of queried users.
-  arma::mat query = stretchedH.col(user);
+  arma::Col<size_t> users(1);
+  users[0] = user;
 
   // Temporary storage for neighborhood of the queried users.
   arma::Mat<size_t> neighborhood;
-
-  // Calculate the neighborhood of the queried users.
-  // This should be a templatized option.
-  neighbor::KNN a(stretchedH, neighbor::SINGLE_TREE_MODE);
   arma::mat resultingDistances; // Temporary storage.
-
-  a.Search(query, numUsersForSimilarity, neighborhood, resultingDistances);
+  userIndex.Search(UserQueries(users), numUsersForSimilarity, neighborhood,
+      resultingDistances);
 
   double rating = 0; // We'll take the average of neighborhood values.
 
@@ -184,10 +236,6 @@ double CF::Predict(const size_t user, const size_t item) const
 void CF::Predict(const arma::Mat<size_t>& combinations,
                  arma::vec& predictions) const
 {
-  // First, for nearest neighbor search, stretch the H matrix.
-  arma::mat l = arma::chol(w.t() * w);
-  arma::mat stretchedH = l * h; // Due to the Armadillo API, l is L^T.
-
   // Now, we must determine those query indices we need to find the nearest
   // neighbors for.  This is easiest if we just sort the combinations matrix.
   arma::Mat<size_t> sortedCombinations(combinations.n_rows,
@@ -199,17 +247,11 @@ void CF::Predict(const arma::Mat<size_t>& combinations,
   // Now, we have to get the list of unique users we will be searching for.
   arma::Col<size_t> users = arma::unique(combinations.row(0).t());
 
-  // Assemble our query matrix from the stretchedH matrix.
-  arma::mat queries(stretchedH.n_rows, users.n_elem);
-  for (size_t i = 0; i < queries.n_cols; ++i)
-    queries.col(i) = stretchedH.col(users[i]);
-
   // Now calculate the neighborhood of these users.
-  neighbor::KNN a(stretchedH);
   arma::mat distances;
   arma::Mat<size_t> neighborhood;
-
-  a.Search(queries, numUsersForSimilarity, neighborhood, distances);
+  userIndex.Search(UserQueries(users), numUsersForSimilarity, neighborhood,
+      distances);
 
   // Now that we have the neighborhoods we need, calculate the predictions.
   predictions.set_size(combinations.n_cols);
@@ -234,6 +276,175 @@ void CF::Predict(const arma::Mat<size_t>& combinations,
   }
 }
 
+void CF::BuildUserIndex()
+{
+  // We want to avoid calculating the full rating matrix, so we will do nearest
+  // neighbor search only on the H matrix, using the observation that if the
+  // rating matrix X = W*H, then d(X.col(i), X.col(j)) = d(W H.col(i), W
+  // H.col(j)).  This can be seen as nearest neighbor search on the H matrix
+  // with the Mahalanobis distance where M^{-1} = W^T W.  So, we'll decompose
+  // M^{-1} = L L^T (the Cholesky decomposition), and then multiply H by L^T.
+  // Then we can perform nearest neighbor search.
+  arma::mat l = arma::chol(w.t() * w);
+  arma::mat stretchedH = l * h; // Due to the Armadillo API, l is L^T.
+
+  Timer::Start("cf_user_index");
+  userIndex.Train(std::move(stretchedH));
+  Timer::Stop("cf_user_index");
+
+  // Any item index was built for other factors.
+  itemIndex = EXHAUSTIVE_ITEM_SEARCH;
+}
+
+void CF::BuildItemIndex(const ItemSearchMode itemSearch)
+{
+  if (itemIndex == itemSearch)
+    return;
+
+  Timer::Start("cf_item_index");
+  if (itemSearch == FASTMKS_ITEM_SEARCH)
+  {
+    // The tree owns its copy of the items.
+    itemFastMKS.Naive() = false;
+    itemFastMKS.Train(new fastmks::FastMKS<kernel::LinearKernel>::Tree(
+        arma::mat(w.t())));
+  }
+  else
+  {
+    // Append sqrt(M^2 - |x|^2) to each item x, where M is the largest norm of
+    // the items, so that all the items have norm M.  Then for a query q with a
+    // last coordinate of 0, |q - x|^2 = |q|^2 + M^2 - 2 q^T x, so the nearest
+    // items are the items with the largest inner product (Bachrach et al.,
+    // "Speeding up the Xbox recommender system using a Euclidean
+    // transformation for inner-product spaces", 2014).
+    arma::mat items(w.n_cols + 1, w.n_rows);
+    items.head_rows(w.n_cols) = w.t();
+    const arma::rowvec norms = arma::sum(arma::square(w.t()), 0);
+    items.row(w.n_cols) = arma::sqrt(norms.max() - norms);
+
+    // LSHSearch only keeps a pointer to the dataset it is trained on, but its
+    // copy owns a copy of the dataset.
+    neighbor::LSHSearch<> lsh(items, 10, 30);
+    itemLSH = lsh;
+  }
+  Timer::Stop("cf_item_index");
+
+  itemIndex = itemSearch;
+}
+
+arma::mat CF::UserQueries(const arma::Col<size_t>& users) const
+{
+  // Building the tree of the index may have reordered the points of the
+  // stretched H matrix.
+  const arma::mat& stretchedH = userIndex.ReferenceSet();
+  const std::vector<size_t>& oldFromNew = userIndex.OldFromNewReferences();
+  std::vector<size_t> newFromOld(oldFromNew.size());
+  for (size_t i = 0; i < oldFromNew.size(); ++i)
+    newFromOld[oldFromNew[i]] = i;
+
+  arma::mat queries(stretchedH.n_rows, users.n_elem);
+  for (size_t i = 0; i < users.n_elem; ++i)
+  {
+    queries.col(i) = stretchedH.col(newFromOld.empty() ? users[i] :
+        newFromOld[users[i]]);
+  }
+
+  return queries;
+}
+
+void CF::Update(const arma::mat& data,
+                const size_t iterations,
+                const double lambda)
+{
+  if (w.n_elem == 0)
+    throw std::invalid_argument("CF::Update(): the model is not trained");
+
+  if (data.n_cols == 0)
+    return;
+
+  // The rating matrix grows to hold the new users and items, whose factors
+  // start at zero.
+  const size_t numItems = std::max((size_t) cleanedData.n_rows,
+      (size_t) arma::max(data.row(1)) + 1);
+  const size_t numUsers = std::max((size_t) cleanedData.n_cols,
+      (size_t) arma::max(data.row(0)) + 1);
+  cleanedData.resize(numItems, numUsers);
+  w.resize(numItems, w.n_cols);
+  h.resize(h.n_rows, numUsers);
+
+  // Replace the ratings that are given again, and add the others.
+  arma::umat locations(2, data.n_cols);
+  for (size_t i = 0; i < data.n_cols; ++i)
+  {
+    locations(0, i) = (arma::uword) data(1, i);
+    locations(1, i) = (arma::uword) data(0, i);
+    if (data(2, i) == 0)
+      Log::Warn << "User rating of 0 ignored for user " << locations(1, i)
+          << ", item " << locations(0, i) << "." << std::endl;
+  }
+  const arma::sp_mat ratings(locations, data.row(2).t(), numItems, numUsers);
+  cleanedData = cleanedData - cleanedData % arma::spones(ratings) + ratings;
+
+  const arma::uvec users = arma::unique(locations.row(1).t());
+  const arma::uvec items = arma::unique(locations.row(0).t());
+
+  Timer::Start("cf_update");
+  const arma::sp_mat itemRatings = cleanedData.t();
+  for (size_t i = 0; i < iterations; ++i)
+  {
+    SolveColumns(cleanedData, w.t(), users, lambda, h);
+
+    arma::mat wt = w.t();
+    SolveColumns(itemRatings, h, items, lambda, wt);
+    w = wt.t();
+  }
+  Timer::Stop("cf_update");
+
+  BuildUserIndex();
+}
+
+void CF::SolveColumns(const arma::sp_mat& data,
+                      const arma::mat& fixed,
+                      const arma::uvec& columns,
+                      const double lambda,
+                      arma::mat& result)
+{
+  const size_t r = fixed.n_rows;
+
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables. If we're building for Visual Studio, use
+  // the intmax_t type instead.
+  #pragma omp parallel for schedule(dynamic, 16)
+  for (intmax_t c = 0; c < (intmax_t) columns.n_elem; ++c)
+#else
+  #pragma omp parallel for schedule(dynamic, 16)
+  for (size_t c = 0; c < columns.n_elem; ++c)
+#endif
+  {
+    const size_t j = columns[c];
+    const size_t begin = data.col_ptrs[j];
+    const size_t n = data.col_ptrs[j + 1] - begin;
+    if (n == 0)
+      continue;
+
+    arma::mat factors(r, n);
+    arma::vec values(n);
+    for (size_t k = 0; k < n; ++k)
+    {
+      factors.col(k) = fixed.col(data.row_indices[begin + k]);
+      values[k] = data.values[begin + k];
+    }
+
+    arma::mat a = factors * factors.t();
+    a.diag() += lambda * n;
+
+    arma::vec solution;
+    if (arma::solve(solution, a, factors * values))
+      result.col(j) = solution;
+  }
+}
+
 void CF::CleanData(const arma::mat& data, arma::sp_mat& cleanedData)
 {
   // Generate list of locations for batch insert constructor for sparse
@@ -18,6 +18,9 @@
 
 #include <mlpack/prereqs.hpp>
 #include <mlpack/methods/neighbor_search/neighbor_search.hpp>
+#include <mlpack/methods/fastmks/fastmks.hpp>
+#include <mlpack/methods/lsh/lsh_search.hpp>
+#include <mlpack/core/kernels/linear_kernel.hpp>
 #include <mlpack/methods/amf/amf.hpp>
 #include <mlpack/methods/amf/update_rules/nmf_als.hpp>
 #include <mlpack/methods/amf/termination_policies/simple_residue_termination.hpp>
@@ -45,6 +48,25 @@ struct FactorizerTraits
   static const bool UsesCoordinateList = false;
 };
 
+/**
+ * How CF::GetRecommendations() finds the items with the highest estimated
+ * rating for a user.  The estimated rating of an item is the inner product of
+ * its row of W with the average column of H of the user's neighborhood, so the
+ * best items are the answer of a maximum inner product search over the rows of
+ * W.
+ */
+enum ItemSearchMode
+{
+  //! Estimate the rating of every item (exact, linear in the items).
+  EXHAUSTIVE_ITEM_SEARCH,
+  //! Search a cover tree of the items with FastMKS and the linear kernel
+  //! (exact).
+  FASTMKS_ITEM_SEARCH,
+  //! Search an LSH index of the items, after reducing the inner product search
+  //! to a nearest neighbor search (approximate).
+  LSH_ITEM_SEARCH
+};
+
 /**
  * This class implements Collaborative Filtering (CF). This implementation
  * presently supports Alternating Least Squares (ALS) for collaborative
@@ -161,6 +183,32 @@ class CF
              const typename std::enable_if_t<
                  !FactorizerTraits<FactorizerType>::UsesCoordinateList>* = 0);
 
+  /**
+   * Update the trained model with new ratings, without factorizing the whole
+   * rating matrix again.  The new ratings are given as a coordinate list like
+   * the data given to Train(); they may rate new items or be given by new
+   * users (whose indices follow the existing ones), and a new rating of an
+   * already rated item replaces the previous rating.
+   *
+   * Only the factors of the users and items that have new ratings are changed.
+   * Each iteration solves for the updated users (columns of H) with W fixed,
+   * and then for the updated items (rows of W) with H fixed, each by the
+   * regularized least squares fit of all its ratings (as in SparseALSUpdate);
+   * the factors of new users and items start at zero, so the first iteration
+   * folds them into the model, and the next ones refine the updated factors
+   * from their current values.  The solved factors are not constrained to be
+   * non-negative, even if the model was trained with NMF.  The user index is
+   * then rebuilt.
+   *
+   * @param data New ratings (coordinate list).
+   * @param iterations Number of iterations over the updated factors.
+   * @param lambda Regularization parameter; each solved vector is penalized
+   *     by lambda times its number of ratings.
+   */
+  void Update(const arma::mat& data,
+              const size_t iterations = 3,
+              const double lambda = 0.01);
+
   //! Sets number of users for calculating similarity.
   void NumUsersForSimilarity(const size_t num)
   {
@@ -199,13 +247,28 @@ class CF
   const arma::sp_mat& CleanedData() const { return cleanedData; }
 
   /**
-   * Generates the given number of recommendations for all users.
+   * Generates the given number of recommendations for all users.  The
+   * recommendations of each user are the items it hasn't rated with the
+   * highest average rating by its neighborhood, best first; if a user has
+   * rated too many items, the missing recommendations are set to the number
+   * of items.
+   *
+   * The neighborhoods come from the nearest neighbor index built by Train(),
+   * and the averaged ratings are computed a block of users at a time (one
+   * matrix product per block), with the best items of each user chosen in
+   * parallel.  With FASTMKS_ITEM_SEARCH or LSH_ITEM_SEARCH, the best items
+   * are found with an index of the items instead of estimating the rating of
+   * every item (see ItemSearchMode); the index is built by the first call
+   * that needs it, and kept until the model is trained again.
    *
    * @param numRecs Number of Recommendations
    * @param recommendations Matrix to save recommendations into.
+   * @param itemSearch How to find the best items of each user.
    */
-  void GetRecommendations(const size_t numRecs,
-                          arma::Mat<size_t>& recommendations);
+  void GetRecommendations(
+      const size_t numRecs,
+      arma::Mat<size_t>& recommendations,
+      const ItemSearchMode itemSearch = EXHAUSTIVE_ITEM_SEARCH);
 
   /**
    * Generates the given number of recommendations for the specified users.
@@ -213,10 +276,13 @@ class CF
    * @param numRecs Number of Recommendations
    * @param recommendations Matrix to save recommendations
    * @param users Users for which recommendations are to be generated
+   * @param itemSearch How to find the best items of each user.
    */
-  void GetRecommendations(const size_t numRecs,
-                          arma::Mat<size_t>& recommendations,
-                          const arma::Col<size_t>& users);
+  void GetRecommendations(
+      const size_t numRecs,
+      arma::Mat<size_t>& recommendations,
+      const arma::Col<size_t>& users,
+      const ItemSearchMode itemSearch = EXHAUSTIVE_ITEM_SEARCH);
 
   //! Converts the User, Item, Value Matrix to User-Item Table
   static void CleanData(const arma::mat& data, arma::sp_mat& cleanedData);
@@ -261,6 +327,37 @@ class CF
   arma::mat h;
   //! Cleaned data matrix.
   arma::sp_mat cleanedData;
+  //! Nearest neighbor index of the users, built on the stretched H matrix by
+  //! Train(); Search() updates its statistics, so it is mutable for Predict().
+  mutable neighbor::KNN userIndex;
+
+  //! Build the nearest neighbor index of the users from w and h.
+  void BuildUserIndex();
+
+  //! Get the stretched H matrix of the given users (their points in the
+  //! user index).
+  arma::mat UserQueries(const arma::Col<size_t>& users) const;
+
+  //! Index of the items (the columns of W^T) for FASTMKS_ITEM_SEARCH.
+  fastmks::FastMKS<kernel::LinearKernel> itemFastMKS;
+  //! Index of the items for LSH_ITEM_SEARCH (see BuildItemIndex()).
+  neighbor::LSHSearch<> itemLSH;
+  //! Which item index is built (EXHAUSTIVE_ITEM_SEARCH if none is).
+  ItemSearchMode itemIndex;
+
+  //! Build the item index for the given search, if it isn't built yet.
+  void BuildItemIndex(const ItemSearchMode itemSearch);
+
+  /**
+   * Solve for the given columns of result: column j is the regularized least
+   * squares fit of the ratings in column j of data, with the rows of data given
+   * by the columns of fixed.  A column without ratings is left unchanged.
+   */
+  static void SolveColumns(const arma::sp_mat& data,
+                           const arma::mat& fixed,
+                           const arma::uvec& columns,
+                           const double lambda,
+                           arma::mat& result);
 
   //! Candidate represents a possible recommendation (value, item).
   typedef std::pair<double, size_t> Candidate;
@@ -277,6 +374,10 @@ class CF
 } // namespace cf
 } // namespace mlpack
 
+//! Set the serialization version of the CF class (version 1 stores the user
+//! index).
+BOOST_CLASS_VERSION(mlpack::cf::CF, 1);
+
 // Include implementation of templated functions.
 #include "cf_impl.hpp"
 
@@ -59,7 +59,9 @@ CF::CF(const arma::mat& data,
        const size_t numUsersForSimilarity,
        const size_t rank) :
     numUsersForSimilarity(numUsersForSimilarity),
-    rank(rank)
+    rank(rank),
+    itemFastMKS(false, true),
+    itemIndex(EXHAUSTIVE_ITEM_SEARCH)
 {
   // Validate neighbourhood size.
   if (numUsersForSimilarity < 1)
@@ -84,7 +86,9 @@ CF::CF(const arma::sp_mat& data,
        const typename std::enable_if_t<
            !FactorizerTraits<FactorizerType>::UsesCoordinateList>*) :
     numUsersForSimilarity(numUsersForSimilarity),
-    rank(rank)
+    rank(rank),
+    itemFastMKS(false, true),
+    itemIndex(EXHAUSTIVE_ITEM_SEARCH)
 {
   // Validate neighbourhood size.
   if (numUsersForSimilarity < 1)
@@ -123,6 +127,10 @@ void CF::Train(const arma::mat& data, FactorizerType factorizer)
   Timer::Start("cf_factorization");
   ApplyFactorizer(factorizer, data, cleanedData, this->rank, w, h);
   Timer::Stop("cf_factorization");
+
+  // The neighborhoods of the users only depend on the factorization, so
+  // index the users once for all later searches.
+  BuildUserIndex();
 }
 
 template<typename FactorizerType>
@@ -151,14 +159,15 @@ void CF::Train(const arma::sp_mat& data,
   Timer::Start("cf_factorization");
   factorizer.Apply(cleanedData, this->rank, w, h);
   Timer::Stop("cf_factorization");
+
+  BuildUserIndex();
 }
 
 //! Serialize the model.
 template<typename Archive>
-void CF::Serialize(Archive& ar, const unsigned int /* version */)
+void CF::Serialize(Archive& ar, const unsigned int version)
 {
-  // This model is simple; just serialize all the members.  No special handling
-  // required.
+  // This model is simple; just serialize all the members.
   using data::CreateNVP;
 
   ar & CreateNVP(numUsersForSimilarity, "numUsersForSimilarity");
@@ -166,6 +175,17 @@ void CF::Serialize(Archive& ar, const unsigned int /* version */)
   ar & CreateNVP(w, "w");
   ar & CreateNVP(h, "h");
   ar & CreateNVP(cleanedData, "cleanedData");
+
+  // Backward compatibility: older versions of CF didn't store the user index,
+  // so it has to be built.
+  if (version > 0)
+    ar & CreateNVP(userIndex, "userIndex");
+  else if (Archive::is_loading::value)
+    BuildUserIndex();
+
+  // The item indices aren't stored; they are built again when needed.
+  if (Archive::is_loading::value)
+    itemIndex = EXHAUSTIVE_ITEM_SEARCH;
 }
 
 } // namespace cf
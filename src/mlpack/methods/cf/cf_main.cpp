@@ -15,6 +15,7 @@
 #include <mlpack/core/math/random.hpp>
 #include <mlpack/methods/amf/amf.hpp>
 #include <mlpack/methods/regularized_svd/regularized_svd.hpp>
+#include <mlpack/methods/regularized_svd/parallel_regularized_svd.hpp>
 #include <mlpack/methods/amf/termination_policies/max_iteration_termination.hpp>
 #include "cf.hpp"
 
@@ -47,19 +48,31 @@ PROGRAM_INFO("Collaborating Filtering", "This program performs collaborative "
     "--recommendations (-r) parameter, and the number of similar users (the "
     "size of the neighborhood) to be considered when generating recommendations"
     " can be specified with the --neighborhood (-n) option."
+    "  For a large catalog of items, --item_search (-S) 'fastmks' or 'lsh' "
+    "finds the best items of each user with an index of the items instead of "
+    "estimating the rating of every item."
     "\n\n"
     "For performing the matrix decomposition, the following optimization "
     "algorithms can be specified via the --algorithm (-a) parameter: "
     "\n"
     "'RegSVD' -- Regularized SVD using a SGD optimizer\n"
+    "'ParallelRegSVD' -- Regularized SVD using block-stratified parallel SGD "
+    "(DSGD)\n"
+    "'HogwildRegSVD' -- Regularized SVD using lock-free parallel SGD "
+    "(Hogwild!)\n"
     "'NMF' -- Non-negative matrix factorization with alternating least squares "
     "update rules\n"
+    "'ALS' -- Regularized alternating least squares over the observed ratings "
+    "only, solved in parallel (use --iteration_only_termination for very "
+    "large datasets)\n"
     "'BatchSVD' -- SVD batch learning\n"
     "'SVDIncompleteIncremental' -- SVD incomplete incremental learning\n"
     "'SVDCompleteIncremental' -- SVD complete incremental learning\n"
     "\n"
     "A trained model may be saved to a file with the --output_model_file (-M) "
-    "parameter.");
+    "parameter.  New ratings, possibly of new users or new items, may be "
+    "folded into a loaded model with the --new_ratings_file (-u) parameter; "
+    "only the factors of the users and items with new ratings are updated.");
 
 // Parameters for training a model.
 PARAM_MATRIX_IN("training", "Input dataset to perform CF on.", "t");
@@ -82,6 +95,9 @@ PARAM_DOUBLE_IN("min_residue", "Residue required to terminate the factorization"
 // Load/save a model.
 PARAM_MODEL_IN(CF, "input_model", "Trained CF model to load.", "m");
 PARAM_MODEL_OUT(CF, "output_model", "Output for trained CF model.", "M");
+PARAM_MATRIX_IN("new_ratings", "New ratings (in the same format as the "
+    "training set) to fold into the model given with --input_model_file before "
+    "using it, without training it again.", "u");
 
 // Query settings.
 PARAM_UMATRIX_IN("query", "List of query users for which recommendations should"
@@ -92,6 +108,10 @@ PARAM_UMATRIX_OUT("output", "Matrix that will store output recommendations.",
     "o");
 PARAM_INT_IN("recommendations", "Number of recommendations to generate for each"
     " query user.", "c", 5);
+PARAM_STRING_IN("item_search", "How to find the best items for each user: "
+    "'exhaustive' (estimate the rating of every item), 'fastmks' (exact "
+    "search with a cover tree of the items) or 'lsh' (approximate search with "
+    "an LSH index of the items).", "S", "exhaustive");
 
 PARAM_INT_IN("seed", "Set the random seed (0 uses std::time(NULL)).", "s", 0);
 
@@ -99,6 +119,16 @@ void ComputeRecommendations(CF& cf,
                             const size_t numRecs,
                             arma::Mat<size_t>& recommendations)
 {
+  const string itemSearchName = CLI::GetParam<string>("item_search");
+  ItemSearchMode itemSearch = EXHAUSTIVE_ITEM_SEARCH;
+  if (itemSearchName == "fastmks")
+    itemSearch = FASTMKS_ITEM_SEARCH;
+  else if (itemSearchName == "lsh")
+    itemSearch = LSH_ITEM_SEARCH;
+  else if (itemSearchName != "exhaustive")
+    Log::Fatal << "Invalid item search '" << itemSearchName << "'.  Choices "
+        << "are 'exhaustive', 'fastmks' and 'lsh'." << endl;
+
   // Reading users.
   if (CLI::HasParam("query"))
   {
@@ -112,12 +142,13 @@ void ComputeRecommendations(CF& cf,
 
     Log::Info << "Generating recommendations for " << users.n_elem << " users."
         << endl;
-    cf.GetRecommendations(numRecs, recommendations, users.row(0).t());
+    cf.GetRecommendations(numRecs, recommendations, users.row(0).t(),
+        itemSearch);
   }
   else
   {
     Log::Info << "Generating recommendations for all users." << endl;
-    cf.GetRecommendations(numRecs, recommendations);
+    cf.GetRecommendations(numRecs, recommendations, itemSearch);
   }
 }
 
@@ -199,6 +230,12 @@ void AssembleFactorizerType(const std::string& algorithm,
           FactorizerType;
       PerformAction(FactorizerType(mit), dataset, rank);
     }
+    else if (algorithm == "ALS")
+    {
+      typedef AMF<MaxIterationTermination, RandomInitialization,
+          SparseALSUpdate> FactorizerType;
+      PerformAction(FactorizerType(mit), dataset, rank);
+    }
     else if (algorithm == "BatchSVD")
     {
       typedef AMF<MaxIterationTermination, RandomInitialization,
@@ -217,10 +254,11 @@ void AssembleFactorizerType(const std::string& algorithm,
           SVDCompleteIncrementalLearning<arma::sp_mat>> FactorizerType;
       PerformAction(FactorizerType(mit), dataset, rank);
     }
-    else if (algorithm == "RegSVD")
+    else if (algorithm == "RegSVD" || algorithm == "ParallelRegSVD" ||
+        algorithm == "HogwildRegSVD")
     {
-      Log::Fatal << "--iteration_only_termination not supported with 'RegSVD' "
-          << "algorithm!" << endl;
+      Log::Fatal << "--iteration_only_termination not supported with '"
+          << algorithm << "' algorithm!" << endl;
     }
   }
   else
@@ -231,6 +269,8 @@ void AssembleFactorizerType(const std::string& algorithm,
     SimpleResidueTermination srt(minResidue, maxIterations);
     if (algorithm == "NMF")
       PerformAction(NMFALSFactorizer(srt), dataset, rank);
+    else if (algorithm == "ALS")
+      PerformAction(SparseALSFactorizer(srt), dataset, rank);
     else if (algorithm == "BatchSVD")
       PerformAction(SVDBatchFactorizer(srt), dataset, rank);
     else if (algorithm == "SVDIncompleteIncremental")
@@ -240,6 +280,11 @@ void AssembleFactorizerType(const std::string& algorithm,
       PerformAction(SparseSVDCompleteIncrementalFactorizer(srt), dataset, rank);
     else if (algorithm == "RegSVD")
       PerformAction(RegularizedSVD<>(maxIterations), dataset, rank);
+    else if (algorithm == "ParallelRegSVD")
+      PerformAction(ParallelRegularizedSVD(maxIterations), dataset, rank);
+    else if (algorithm == "HogwildRegSVD")
+      PerformAction(ParallelRegularizedSVD(maxIterations, 0.01, 0.02, false),
+          dataset, rank);
   }
 }
 
@@ -271,6 +316,10 @@ int main(int argc, char** argv)
     Log::Warn << "Neither --output_file nor --output_model_file are specified; "
         << "no output will be saved." << endl;
 
+  if (CLI::HasParam("new_ratings") && !CLI::HasParam("input_model"))
+    Log::Fatal << "--new_ratings_file can only be used with "
+        << "--input_model_file!" << endl;
+
   if (CLI::HasParam("output") && !(CLI::HasParam("query") ||
       CLI::HasParam("all_user_recommendations")))
     Log::Warn << "--output_file is ignored because neither --query_file nor "
@@ -295,13 +344,17 @@ int main(int argc, char** argv)
 
     // Issue an error if an invalid factorizer is used.
     if (algo != "NMF" &&
+        algo != "ALS" &&
         algo != "BatchSVD" &&
         algo != "SVDIncompleteIncremental" &&
         algo != "SVDCompleteIncremental" &&
-        algo != "RegSVD")
+        algo != "RegSVD" &&
+        algo != "ParallelRegSVD" &&
+        algo != "HogwildRegSVD")
       Log::Fatal << "Invalid decomposition algorithm.  Choices are 'NMF', "
-          << "'BatchSVD', 'SVDIncompleteIncremental', 'SVDCompleteIncremental',"
-          << " and 'RegSVD'." << endl;
+          << "'ALS', 'BatchSVD', 'SVDIncompleteIncremental', "
+          << "'SVDCompleteIncremental', 'RegSVD', 'ParallelRegSVD', and "
+          << "'HogwildRegSVD'." << endl;
 
     // Issue a warning if the user provided a minimum residue but it will be
     // ignored.
@@ -319,6 +372,12 @@ int main(int argc, char** argv)
     // Load an input model.
     CF c = std::move(CLI::GetParam<CF>("input_model"));
 
+    if (CLI::HasParam("new_ratings"))
+    {
+      Log::Info << "Updating the model with new ratings..." << endl;
+      c.Update(std::move(CLI::GetParam<arma::mat>("new_ratings")));
+    }
+
     PerformAction(c);
   }
 
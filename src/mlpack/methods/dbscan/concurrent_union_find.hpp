@@ -0,0 +1,106 @@
+/**
+ * @file concurrent_union_find.hpp
+ *
+ * A union-find structure that several threads may use at once without any
+ * locks.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_DBSCAN_CONCURRENT_UNION_FIND_HPP
+#define MLPACK_METHODS_DBSCAN_CONCURRENT_UNION_FIND_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <atomic>
+
+namespace mlpack {
+namespace dbscan {
+
+/**
+ * A union-find structure that tracks the components of a graph, like
+ * emst::UnionFind, but where Find() and Union() may be called by any number of
+ * threads at once without taking a lock.
+ *
+ * Union() links two roots with an atomic compare-and-swap; if another thread
+ * has linked one of them in the meantime, the roots are found again and the
+ * link is retried.  The root with the larger index is always linked under the
+ * root with the smaller index, so the root of each component is its smallest
+ * element, whatever the order in which the unions were made.  Find() compresses
+ * paths by path halving, which is safe under concurrent use because the parent
+ * of an element is only ever replaced by one of its ancestors.
+ */
+class ConcurrentUnionFind
+{
+ public:
+  //! Construct the object with the given size; each element is its own
+  //! component.
+  ConcurrentUnionFind(const size_t size) : parent(size)
+  {
+    for (size_t i = 0; i < size; ++i)
+      parent[i].store(i, std::memory_order_relaxed);
+  }
+
+  /**
+   * Return the root of the component containing the given element, which is
+   * the smallest element of the component once all unions are done.
+   *
+   * @param x Element to find the component of.
+   * @return The root of the component containing x.
+   */
+  size_t Find(size_t x)
+  {
+    size_t p = parent[x].load(std::memory_order_relaxed);
+    while (p != x)
+    {
+      // Point x to its grandparent, to keep the paths short.
+      const size_t grandparent = parent[p].load(std::memory_order_relaxed);
+      if (grandparent != p)
+        parent[x].store(grandparent, std::memory_order_relaxed);
+
+      x = p;
+      p = grandparent;
+    }
+
+    return x;
+  }
+
+  /**
+   * Unite the components containing the two given elements.
+   *
+   * @param x One element.
+   * @param y The other element.
+   */
+  void Union(size_t x, size_t y)
+  {
+    while (true)
+    {
+      x = Find(x);
+      y = Find(y);
+      if (x == y)
+        return;
+
+      // Link the larger root under the smaller one.  This fails if the larger
+      // root has been linked by another thread since it was found.
+      if (x < y)
+        std::swap(x, y);
+      size_t expected = x;
+      if (parent[x].compare_exchange_strong(expected, y,
+          std::memory_order_relaxed))
+        return;
+    }
+  }
+
+  //! Return the number of elements.
+  size_t Size() const { return parent.size(); }
+
+ private:
+  //! The parent of each element; roots are their own parents.
+  std::vector<std::atomic<size_t>> parent;
+};
+
+} // namespace dbscan
+} // namespace mlpack
+
+#endif
@@ -15,8 +15,9 @@
 
 #include <mlpack/core.hpp>
 #include <mlpack/methods/range_search/range_search.hpp>
-#include <mlpack/methods/emst/union_find.hpp>
 #include "random_point_selection.hpp"
+#include "dbscan_callbacks.hpp"
+#include "grid_range_search.hpp"
 #include <boost/dynamic_bitset.hpp>
 
 namespace mlpack {
@@ -43,7 +44,21 @@ namespace dbscan {
  * range search technique used and the point selection strategy by means of
  * template parameters.
  *
- * @tparam RangeSearchType Class to use for range searching.
+ * A point is a core point if at least minPoints points (including itself) are
+ * within epsilon of it.  Core points within epsilon of each other are in the
+ * same cluster, and every other point within epsilon of a core point is a
+ * border point of the cluster of the core point with the smallest index; all
+ * remaining points are noise.  This is computed with two range searches over
+ * the dataset, neither of which stores any neighbors: the first counts the
+ * neighbors of each point, and the second unites the core points in a
+ * union-find structure.  When OpenMP is available, the range searches run in
+ * parallel (see range::RangeSearch) and the results are processed by each
+ * thread as they are found, with a lock-free union-find structure.
+ *
+ * @tparam RangeSearchType Class to use for range searching.  Its Search()
+ *      methods must accept a callback that is called with each result; see
+ *      range::RangeSearch.  GridRangeSearch is much faster for low-dimensional
+ *      data.
  * @tparam PointSelectionPolicy Strategy for selecting next point to cluster
  *      with.
  */
@@ -56,8 +71,8 @@ class DBSCAN
    * Construct the DBSCAN object with the given parameters.  The batchMode
    * parameter should be set to false in the case where RAM issues will be
    * encountered (i.e. if the dataset is very large or if epsilon is large).
-   * When batchMode is false, each point will be searched iteratively, which
-   * could be slower but will use less memory.
+   * When batchMode is false, blocks of points will be searched one after the
+   * other, which could be slower but will use less memory.
    *
    * @param epsilon Size of range query.
    * @param minPoints Minimum number of points for each cluster.
@@ -119,7 +134,8 @@ class DBSCAN
   //! itself) for the point to be a core-point.
   size_t minPoints;
 
-  //! Whether or not to perform the search in batch mode.  If false, single
+  //! Whether or not to perform the search in batch mode.  If false, blocks of
+  //! points are searched one after the other.
   bool batchMode;
 
   //! Instantiated range search policy.
@@ -128,32 +144,21 @@ class DBSCAN
   //! Instantiated point selection policy.
   PointSelectionPolicy pointSelector;
 
-  /**
-   * Performs DBSCAN clustering on the data, returning the number of clusters and
-   * also the list of cluster assignments.  This searches each point iteratively,
-   * and can save on RAM usage.  It may be slower than the batch search with a
-   * dual-tree algorithm.
-   *
-   * @param data Dataset to cluster.
-   * @param assignments Assignments for each point.
-   * @param uf UnionFind structure that will be modified.
-   */
-  template<typename MatType>
-  void PointwiseCluster(const MatType& data,
-                        emst::UnionFind& uf);
+  //! The number of points searched at once when batchMode is false.
+  static const size_t PointBlockSize = 10000;
 
   /**
-   * Performs DBSCAN clustering on the data, returning number of clusters
-   * and also the list of cluster assignments.  This can perform search in batch,
-   * so it is well suited for dual-tree or naive search.
+   * Search for the neighborhood of every point with the given callback.  If
+   * batchMode is true, all points are searched at once; otherwise, blocks of
+   * PointBlockSize points are searched one after the other, which uses less
+   * memory.
    *
    * @param data Dataset to cluster.
-   * @param assignments Assignments for each point.
-   * @param uf UnionFind structure that will be modified.
+   * @param callback Callback to pass the results to; its QueryOffset() is set
+   *     to the index of the first point of each search.
    */
-  template<typename MatType>
-  void BatchCluster(const MatType& data,
-                    emst::UnionFind& uf);
+  template<typename MatType, typename CallbackType>
+  void SearchNeighborhoods(const MatType& data, CallbackType& callback);
 };
 
 } // namespace dbscan
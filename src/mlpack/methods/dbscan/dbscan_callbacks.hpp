@@ -0,0 +1,195 @@
+/**
+ * @file dbscan_callbacks.hpp
+ *
+ * Range search callbacks used by DBSCAN: one that counts the neighbors of each
+ * point, to find the core points, and one that unites each core point with the
+ * points in its neighborhood.  Neither stores any neighbors, and both may be
+ * called by several threads at once.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_DBSCAN_DBSCAN_CALLBACKS_HPP
+#define MLPACK_METHODS_DBSCAN_DBSCAN_CALLBACKS_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/methods/range_search/range_search_callbacks.hpp>
+#include "concurrent_union_find.hpp"
+
+namespace mlpack {
+namespace dbscan {
+
+/**
+ * A range search callback that counts the neighbors of each query point.  The
+ * query indices of the results are offset by a fixed amount, so that blocks of
+ * points can be searched separately.  Only whether a point has at least
+ * MaxCount() neighbors matters, so a search that knows about this callback
+ * (like GridRangeSearch) may stop counting the neighbors of a point once it
+ * has found that many, and may add whole groups of neighbors at once with
+ * AddCount().  range::RangeSearch adds the points of reference nodes that are
+ * entirely in the range with AddNode().
+ */
+class NeighborCountCallback
+{
+ public:
+  /**
+   * Create the callback.
+   *
+   * @param counts Number of neighbors of each point.
+   * @param maxCount Number of neighbors above which counts don't matter.
+   * @param queryOffset Amount to add to each query index.
+   */
+  NeighborCountCallback(std::vector<std::atomic<size_t>>& counts,
+                        const size_t maxCount = SIZE_MAX,
+                        const size_t queryOffset = 0) :
+      counts(counts),
+      maxCount(maxCount),
+      queryOffset(queryOffset)
+  { }
+
+  //! Get the number of neighbors above which counts don't matter.
+  size_t MaxCount() const { return maxCount; }
+
+  //! Get the amount added to each query index.
+  size_t QueryOffset() const { return queryOffset; }
+  //! Modify the amount added to each query index.
+  size_t& QueryOffset() { return queryOffset; }
+
+  //! Count the given result.
+  void operator()(const size_t queryIndex,
+                  const size_t /* referenceIndex */,
+                  const double /* distance */)
+  {
+    counts[queryOffset + queryIndex].fetch_add(1, std::memory_order_relaxed);
+  }
+
+  //! Add the given number of neighbors to the count of the given query point.
+  void AddCount(const size_t queryIndex, const size_t count)
+  {
+    counts[queryOffset + queryIndex].fetch_add(count,
+        std::memory_order_relaxed);
+  }
+
+  //! Add all the points of a node to the count of the given query point.
+  bool AddNode(const size_t queryIndex,
+               const size_t numPoints,
+               const math::Range& /* distances */)
+  {
+    AddCount(queryIndex, numPoints);
+    return true;
+  }
+
+ private:
+  //! The number of neighbors of each point.
+  std::vector<std::atomic<size_t>>& counts;
+  //! The number of neighbors above which counts don't matter.
+  size_t maxCount;
+  //! The amount to add to each query index.
+  size_t queryOffset;
+};
+
+/**
+ * A range search callback that builds the DBSCAN clusters.  Each core point is
+ * united with every core point in its neighborhood.  Each non-core point in
+ * the neighborhood of a core point is a border point; it is attached to the
+ * core point in its neighborhood with the smallest index, so that the result
+ * doesn't depend on the order of the results.  The query indices of the results
+ * are offset by a fixed amount, like for NeighborCountCallback.
+ */
+class CoreUnionCallback
+{
+ public:
+  /**
+   * Create the callback.
+   *
+   * @param core Whether each point is a core point.
+   * @param uf Components of the core points.
+   * @param borderCore For each non-core point, the smallest index of a core
+   *     point in its neighborhood found so far (SIZE_MAX if there is none).
+   * @param queryOffset Amount to add to each query index.
+   */
+  CoreUnionCallback(const std::vector<char>& core,
+                    ConcurrentUnionFind& uf,
+                    std::vector<std::atomic<size_t>>& borderCore,
+                    const size_t queryOffset = 0) :
+      core(core),
+      uf(uf),
+      borderCore(borderCore),
+      queryOffset(queryOffset)
+  { }
+
+  //! Get the amount added to each query index.
+  size_t QueryOffset() const { return queryOffset; }
+  //! Modify the amount added to each query index.
+  size_t& QueryOffset() { return queryOffset; }
+
+  //! Get whether each point is a core point.
+  const std::vector<char>& Core() const { return core; }
+  //! Get the components of the core points.
+  ConcurrentUnionFind& Components() { return uf; }
+  //! Get the core point each border point is attached to.
+  std::vector<std::atomic<size_t>>& BorderCore() { return borderCore; }
+
+  //! Unite or attach the points of the given result.
+  void operator()(const size_t queryIndex,
+                  const size_t referenceIndex,
+                  const double /* distance */)
+  {
+    const size_t query = queryOffset + queryIndex;
+    if (!core[query])
+      return;
+
+    if (core[referenceIndex])
+    {
+      uf.Union(query, referenceIndex);
+    }
+    else
+    {
+      // Keep the smallest core point index.
+      size_t current = borderCore[referenceIndex].load(
+          std::memory_order_relaxed);
+      while (query < current && !borderCore[referenceIndex]
+          .compare_exchange_weak(current, query, std::memory_order_relaxed))
+      { }
+    }
+  }
+
+ private:
+  //! Whether each point is a core point.
+  const std::vector<char>& core;
+  //! The components of the core points.
+  ConcurrentUnionFind& uf;
+  //! The core point each border point is attached to.
+  std::vector<std::atomic<size_t>>& borderCore;
+  //! The amount to add to each query index.
+  size_t queryOffset;
+};
+
+} // namespace dbscan
+
+namespace range {
+
+//! NeighborCountCallback only makes atomic updates, so it may be called by
+//! several threads at once, and it only needs the number of points of a node.
+template<>
+struct RangeSearchCallbackTraits<dbscan::NeighborCountCallback>
+{
+  static const bool IsThreadSafe = true;
+  static const bool TakesNodes = true;
+};
+
+//! CoreUnionCallback only makes atomic updates, so it may be called by several
+//! threads at once.
+template<>
+struct RangeSearchCallbackTraits<dbscan::CoreUnionCallback>
+{
+  static const bool IsThreadSafe = true;
+  static const bool TakesNodes = false;
+};
+
+} // namespace range
+} // namespace mlpack
+
+#endif
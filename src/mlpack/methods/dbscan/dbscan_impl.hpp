@@ -100,40 +100,57 @@ size_t DBSCAN<RangeSearchType, PointSelectionPolicy>::Cluster(
     const MatType& data,
     arma::Row<size_t>& assignments)
 {
-  // Initialize the UnionFind object.
-  emst::UnionFind uf(data.n_cols);
   rangeSearch.Train(data);
 
-  if (batchMode)
-    BatchCluster(data, uf);
-  else
-    PointwiseCluster(data, uf);
+  // First count the points in the epsilon-neighborhood of each point, to find
+  // the core points.  The counts are reused afterwards to hold the core point
+  // each border point is attached to.
+  std::vector<std::atomic<size_t>> counts(data.n_cols);
+  for (size_t i = 0; i < data.n_cols; ++i)
+    counts[i].store(0, std::memory_order_relaxed);
 
-  // Now set assignments.
-  assignments.set_size(data.n_cols);
+  Log::Info << "Finding core points." << std::endl;
+  NeighborCountCallback countNeighbors(counts, minPoints);
+  SearchNeighborhoods(data, countNeighbors);
+
+  std::vector<char> core(data.n_cols);
+  size_t numCore = 0;
   for (size_t i = 0; i < data.n_cols; ++i)
-    assignments[i] = uf.Find(i);
+  {
+    core[i] = (counts[i].load(std::memory_order_relaxed) >= minPoints);
+    numCore += core[i];
+    counts[i].store(SIZE_MAX, std::memory_order_relaxed);
+  }
+  Log::Info << numCore << " core points found." << std::endl;
 
-  // Get a count of all clusters.
-  const size_t numClusters = arma::max(assignments) + 1;
-  arma::Col<size_t> counts(numClusters, arma::fill::zeros);
-  for (size_t i = 0; i < assignments.n_elem; ++i)
-    counts[assignments[i]]++;
+  // Now unite the core points with their neighbors.
+  ConcurrentUnionFind uf(data.n_cols);
+  CoreUnionCallback uniteNeighbors(core, uf, counts);
+  SearchNeighborhoods(data, uniteNeighbors);
 
-  // Now assign clusters to new indices.
+  // The root of each cluster is its core point with the smallest index, so
+  // clusters are numbered in the order of their first core point.
+  assignments.set_size(data.n_cols);
   size_t currentCluster = 0;
-  arma::Col<size_t> newAssignments(numClusters);
-  for (size_t i = 0; i < counts.n_elem; ++i)
+  for (size_t i = 0; i < data.n_cols; ++i)
   {
-    if (counts[i] >= minPoints)
-      newAssignments[i] = currentCluster++;
-    else
-      newAssignments[i] = SIZE_MAX;
+    if (!core[i])
+      continue;
+
+    const size_t root = uf.Find(i);
+    assignments[i] = (root == i) ? currentCluster++ : assignments[root];
   }
 
-  // Now reassign.
-  for (size_t i = 0; i < assignments.n_elem; ++i)
-    assignments[i] = newAssignments[assignments[i]];
+  // Border points get the cluster of their core point; everything else is
+  // noise.
+  for (size_t i = 0; i < data.n_cols; ++i)
+  {
+    if (core[i])
+      continue;
+
+    const size_t owner = counts[i].load(std::memory_order_relaxed);
+    assignments[i] = (owner == SIZE_MAX) ? SIZE_MAX : assignments[owner];
+  }
 
   Log::Info << currentCluster << " clusters found." << std::endl;
 
@@ -141,60 +158,34 @@ size_t DBSCAN<RangeSearchType, PointSelectionPolicy>::Cluster(
 }
 
 /**
- * Performs DBSCAN clustering on the data, returning the number of clusters and
- * also the list of cluster assignments.  This searches each point iteratively,
- * and can save on RAM usage.  It may be slower than the batch search with a
- * dual-tree algorithm.
+ * Search for the neighborhood of every point, either all at once or in blocks
+ * of points.
  */
 template<typename RangeSearchType, typename PointSelectionPolicy>
-template<typename MatType>
-void DBSCAN<RangeSearchType, PointSelectionPolicy>::PointwiseCluster(
+template<typename MatType, typename CallbackType>
+void DBSCAN<RangeSearchType, PointSelectionPolicy>::SearchNeighborhoods(
     const MatType& data,
-    emst::UnionFind& uf)
+    CallbackType& callback)
 {
-  std::vector<std::vector<size_t>> neighbors;
-  std::vector<std::vector<double>> distances;
-
-  for (size_t i = 0; i < data.n_cols; ++i)
+  if (batchMode)
   {
-    if (i % 10000 == 0 && i > 0)
-      Log::Info << "DBSCAN clustering on point " << i << "..." << std::endl;
-
-    // Do the range search for only this point.
-    rangeSearch.Search(data.col(i), math::Range(0.0, epsilon), neighbors,
-        distances);
-
-    // Union to all neighbors.
-    for (size_t j = 0; j < neighbors[0].size(); ++j)
-      uf.Union(i, neighbors[0][j]);
+    Log::Info << "Performing range search." << std::endl;
+    callback.QueryOffset() = 0;
+    rangeSearch.Search(data, math::Range(0.0, epsilon), callback);
+    Log::Info << "Range search complete." << std::endl;
+    return;
   }
-}
 
-/**
- * Performs DBSCAN clustering on the data, returning number of clusters
- * and also the list of cluster assignments.  This can perform search in batch,
- * naive search).
- */
-template<typename RangeSearchType, typename PointSelectionPolicy>
-template<typename MatType>
-void DBSCAN<RangeSearchType, PointSelectionPolicy>::BatchCluster(
-    const MatType& data,
-    emst::UnionFind& uf)
-{
-  // For each point, find the points in epsilon-nighborhood and their distances.
-  std::vector<std::vector<size_t>> neighbors;
-  std::vector<std::vector<double>> distances;
-  Log::Info << "Performing range search." << std::endl;
-  rangeSearch.Train(data);
-  rangeSearch.Search(data, math::Range(0.0, epsilon), neighbors, distances);
-  Log::Info << "Range search complete." << std::endl;
-
-  // Now loop over all points.
-  for (size_t i = 0; i < data.n_cols; ++i)
+  for (size_t begin = 0; begin < data.n_cols; begin += PointBlockSize)
   {
-    // Union to all neighbors.
-    for (size_t j = 0; j < neighbors[i].size(); ++j)
-      uf.Union(i, neighbors[i][j]);
+    if (begin > 0)
+      Log::Info << "DBSCAN clustering on point " << begin << "..." << std::endl;
+
+    // Search only for this block of points.
+    const size_t end = std::min(begin + PointBlockSize, (size_t) data.n_cols);
+    const MatType block = data.cols(begin, end - 1);
+    callback.QueryOffset() = begin;
+    rangeSearch.Search(block, math::Range(0.0, epsilon), callback);
   }
 }
 
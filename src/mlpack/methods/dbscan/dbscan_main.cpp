@@ -29,21 +29,27 @@ PROGRAM_INFO("DBSCAN clustering",
     "\n\n"
     "The input dataset to be clustered may be specified with the --input_file "
     "option, the radius of each range search may be specified with the "
-    "--epsilon option, and the minimum number of points in a cluster may be "
-    "specified with the --min_size option."
+    "--epsilon option, and the minimum number of points within epsilon of a "
+    "core point (including itself) may be specified with the --min_size "
+    "option.  Core points within epsilon of each other are in the same "
+    "cluster, other points within epsilon of a core point join its cluster, "
+    "and all remaining points are noise."
     "\n\n"
     "The output of the clustering may be saved as --assignments_file or "
     "--centroids_file; --assignments_file will save the cluster assignments of "
     "each point, and --centroids_file will save the centroids of each cluster."
     "\n\n"
     "The range search may be controlled with the --tree_type, --single_mode, "
-    "and --naive parameters.  The --tree_type parameter can control the type of"
-    " tree used for range search; this can take a variety of values: 'kd', 'r',"
-    " 'r-star', 'x', 'hilbert-r', 'r-plus', 'r-plus-plus', 'cover', 'ball'. "
+    "--naive, and --grid parameters.  The --tree_type parameter can control "
+    "the type of tree used for range search; this can take a variety of "
+    "values: 'kd', 'r', 'r-star', 'x', 'hilbert-r', 'r-plus', 'r-plus-plus', "
+    "'cover', 'ball'.  "
     "The --single_mode option will force single-tree search (as opposed to the "
     "default dual-tree search).  --single_mode can be useful when the RAM usage"
     " of batch search is too high.  The --naive option will force brute-force "
-    "range search."
+    "range search.  The --grid option will bucket the points into a grid of "
+    "cells instead of building a tree; this is much faster for low-dimensional "
+    "data (up to 6 dimensions), such as 2-D or 3-D spatial points."
     "\n\n"
     "An example usage to run DBSCAN on the dataset in input.csv with a radius "
     "of 0.5 and a minimum cluster size of 5 is given below:"
@@ -56,7 +62,8 @@ PARAM_UROW_OUT("assignments", "Output vector for assignments of each "
 PARAM_MATRIX_OUT("centroids", "Matrix to save output centroids to.", "C");
 
 PARAM_DOUBLE_IN("epsilon", "Radius of each range search.", "e", 1.0);
-PARAM_INT_IN("min_size", "Minimum number of points for a cluster.", "m", 5);
+PARAM_INT_IN("min_size", "Minimum number of points within epsilon of a core "
+    "point.", "m", 5);
 
 PARAM_STRING_IN("tree_type", "If using single-tree or dual-tree search, the "
     "type of tree to use ('kd', 'r', 'r-star', 'x', 'hilbert-r', 'r-plus', "
@@ -65,14 +72,13 @@ PARAM_FLAG("single_mode", "If set, single-tree range search (not dual-tree) "
     "will be used.", "S");
 PARAM_FLAG("naive", "If set, brute-force range search (not tree-based) "
     "will be used.", "N");
+PARAM_FLAG("grid", "If set, grid-based range search (not tree-based) will be "
+    "used; this is only possible for low-dimensional data.", "g");
 
 // Actually run the clustering, and process the output.
 template<typename RangeSearchType>
-void RunDBSCAN(RangeSearchType rs = RangeSearchType())
+void RunDBSCAN(RangeSearchType rs)
 {
-  if (CLI::HasParam("single_mode"))
-    rs.SingleMode() = true;
-
   // Load dataset.
   arma::mat dataset = std::move(CLI::GetParam<arma::mat>("input"));
 
@@ -101,6 +107,17 @@ void RunDBSCAN(RangeSearchType rs = RangeSearchType())
     CLI::GetParam<arma::Row<size_t>>("assignments") = std::move(assignments);
 }
 
+// Run the clustering with tree-based range search.
+template<typename RangeSearchType>
+void RunTreeDBSCAN()
+{
+  RangeSearchType rs;
+  if (CLI::HasParam("single_mode"))
+    rs.SingleMode() = true;
+
+  RunDBSCAN(rs);
+}
+
 int main(int argc, char** argv)
 {
   CLI::ParseCommandLine(argc, argv);
@@ -109,35 +126,57 @@ int main(int argc, char** argv)
     Log::Warn << "Neither --assignments_file nor --centroids_file are "
         << "specified; no output will be saved!" << endl;
 
+  if (CLI::HasParam("naive") && CLI::HasParam("grid"))
+    Log::Fatal << "Only one of --naive and --grid may be specified!" << endl;
+
   if (CLI::HasParam("single_mode") && CLI::HasParam("naive"))
     Log::Warn << "--single_mode ignored because --naive is specified." << endl;
 
-  // Fire off naive search if needed.
+  if (CLI::HasParam("tree_type") && CLI::HasParam("grid"))
+    Log::Warn << "--tree_type ignored because --grid is specified." << endl;
+
+  // Fire off naive or grid-based search if needed.
+  const string treeType = CLI::GetParam<string>("tree_type");
   if (CLI::HasParam("naive"))
   {
     RangeSearch<> rs(true);
     RunDBSCAN(rs);
   }
-
-  const string treeType = CLI::GetParam<string>("tree_type");
-  if (treeType == "kd")
-    RunDBSCAN<RangeSearch<>>();
+  else if (CLI::HasParam("grid"))
+  {
+    try
+    {
+      RunDBSCAN(GridRangeSearch());
+    }
+    catch (std::invalid_argument& e)
+    {
+      Log::Fatal << e.what() << endl;
+    }
+  }
+  else if (treeType == "kd")
+    RunTreeDBSCAN<RangeSearch<>>();
   else if (treeType == "cover")
-    RunDBSCAN<RangeSearch<EuclideanDistance, arma::mat, StandardCoverTree>>();
+  {
+    RunTreeDBSCAN<RangeSearch<EuclideanDistance, arma::mat,
+        StandardCoverTree>>();
+  }
   else if (treeType == "r")
-    RunDBSCAN<RangeSearch<EuclideanDistance, arma::mat, RTree>>();
+    RunTreeDBSCAN<RangeSearch<EuclideanDistance, arma::mat, RTree>>();
   else if (treeType == "r-star")
-    RunDBSCAN<RangeSearch<EuclideanDistance, arma::mat, RStarTree>>();
+    RunTreeDBSCAN<RangeSearch<EuclideanDistance, arma::mat, RStarTree>>();
   else if (treeType == "x")
-    RunDBSCAN<RangeSearch<EuclideanDistance, arma::mat, XTree>>();
+    RunTreeDBSCAN<RangeSearch<EuclideanDistance, arma::mat, XTree>>();
   else if (treeType == "hilbert-r")
-    RunDBSCAN<RangeSearch<EuclideanDistance, arma::mat, HilbertRTree>>();
+    RunTreeDBSCAN<RangeSearch<EuclideanDistance, arma::mat, HilbertRTree>>();
   else if (treeType == "r-plus")
-    RunDBSCAN<RangeSearch<EuclideanDistance, arma::mat, RPlusTree>>();
+    RunTreeDBSCAN<RangeSearch<EuclideanDistance, arma::mat, RPlusTree>>();
   else if (treeType == "r-plus-plus")
-    RunDBSCAN<RangeSearch<EuclideanDistance, arma::mat, RPlusPlusTree>>();
+  {
+    RunTreeDBSCAN<RangeSearch<EuclideanDistance, arma::mat,
+        RPlusPlusTree>>();
+  }
   else if (treeType == "ball")
-    RunDBSCAN<RangeSearch<EuclideanDistance, arma::mat, BallTree>>();
+    RunTreeDBSCAN<RangeSearch<EuclideanDistance, arma::mat, BallTree>>();
   else
   {
     Log::Fatal << "Unknown tree type specified!  Valid choices are 'kd', "
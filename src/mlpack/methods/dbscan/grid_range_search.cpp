@@ -0,0 +1,367 @@
+/**
+ * @file grid_range_search.cpp
+ *
+ * Implementation of the grid-based range search for DBSCAN.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "grid_range_search.hpp"
+
+using namespace mlpack;
+using namespace mlpack::dbscan;
+
+GridRangeSearch::GridRangeSearch(const size_t numThreads) :
+    referenceSet(NULL),
+    gridRange(0.0),
+    cellSize(0.0),
+    maxOffset(0),
+    baseCases(0),
+    numThreads(numThreads)
+{
+  // Nothing to do.
+}
+
+void GridRangeSearch::Train(const arma::mat& referenceSet)
+{
+  if (referenceSet.n_rows == 0 || referenceSet.n_rows > MaxDimensionality)
+  {
+    std::ostringstream oss;
+    oss << "GridRangeSearch::Train(): data has " << referenceSet.n_rows
+        << " dimensions, but only 1 to " << MaxDimensionality << " dimensions "
+        << "are supported";
+    throw std::invalid_argument(oss.str());
+  }
+
+  this->referenceSet = &referenceSet;
+  baseCases = 0;
+
+  // The grid is built at the next search.
+  gridRange = 0.0;
+  cellStarts.clear();
+  cellPoints.clear();
+  cellIndices.clear();
+}
+
+void GridRangeSearch::Search(const arma::mat& querySet,
+                             const math::Range& range,
+                             NeighborCountCallback& callback)
+{
+  if (range.Lo() > 0.0)
+  {
+    SearchAll(querySet, range, callback);
+    return;
+  }
+
+  BuildGrid(range.Hi());
+
+  const size_t dimensionality = referenceSet->n_rows;
+  const double squaredRange = range.Hi() * range.Hi();
+  const size_t maxCount = callback.MaxCount();
+  const size_t numNeighbors = neighborOffsets.size() / dimensionality;
+  size_t totalBaseCases = 0;
+
+  #pragma omp parallel num_threads(Threads()) reduction(+:totalBaseCases)
+  {
+    std::vector<long long> coordinates(dimensionality);
+
+#ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables. If we're building for Visual Studio,
+    // use the intmax_t type instead.
+    #pragma omp for schedule(dynamic, QueryBlockSize)
+    for (intmax_t q = 0; q < (intmax_t) querySet.n_cols; ++q)
+#else
+    #pragma omp for schedule(dynamic, QueryBlockSize)
+    for (size_t q = 0; q < querySet.n_cols; ++q)
+#endif
+    {
+      const double* query = querySet.colptr(q);
+      Coordinates(query, coordinates.data());
+
+      size_t count = 0;
+      for (size_t n = 0; n < numNeighbors && count < maxCount; ++n)
+      {
+        const size_t cell = NeighborCell(coordinates.data(), n);
+        if (cell == SIZE_MAX)
+          continue;
+
+        // Every point of the cell of the query point is within range.
+        if (n == 0)
+        {
+          count += cellStarts[cell + 1] - cellStarts[cell];
+          continue;
+        }
+
+        for (size_t i = cellStarts[cell]; i < cellStarts[cell + 1] &&
+            count < maxCount; ++i)
+        {
+          const double* reference = referenceSet->colptr(cellPoints[i]);
+          double distance = 0.0;
+          for (size_t d = 0; d < dimensionality; ++d)
+            distance += (query[d] - reference[d]) * (query[d] - reference[d]);
+
+          ++totalBaseCases;
+          if (distance <= squaredRange)
+            ++count;
+        }
+      }
+
+      callback.AddCount(q, count);
+    }
+  }
+
+  baseCases += totalBaseCases;
+}
+
+void GridRangeSearch::Search(const arma::mat& querySet,
+                             const math::Range& range,
+                             CoreUnionCallback& callback)
+{
+  if (range.Lo() > 0.0)
+  {
+    SearchAll(querySet, range, callback);
+    return;
+  }
+
+  BuildGrid(range.Hi());
+
+  const size_t dimensionality = referenceSet->n_rows;
+  const double squaredRange = range.Hi() * range.Hi();
+  const size_t numNeighbors = neighborOffsets.size() / dimensionality;
+  const std::vector<char>& core = callback.Core();
+  ConcurrentUnionFind& uf = callback.Components();
+  std::vector<std::atomic<size_t>>& borderCore = callback.BorderCore();
+  size_t totalBaseCases = 0;
+
+  #pragma omp parallel num_threads(Threads()) reduction(+:totalBaseCases)
+  {
+    std::vector<long long> coordinates(dimensionality);
+
+#ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables. If we're building for Visual Studio,
+    // use the intmax_t type instead.
+    #pragma omp for schedule(dynamic, QueryBlockSize)
+    for (intmax_t q = 0; q < (intmax_t) querySet.n_cols; ++q)
+#else
+    #pragma omp for schedule(dynamic, QueryBlockSize)
+    for (size_t q = 0; q < querySet.n_cols; ++q)
+#endif
+    {
+      const size_t point = callback.QueryOffset() + q;
+      const double* query = querySet.colptr(q);
+      Coordinates(query, coordinates.data());
+
+      // A core point only has to be united with one core point of each cell,
+      // because the core points of a cell are all united with the first one.
+      // A non-core point is attached to the core point with the smallest index
+      // within range, so it has to check all core points of each cell.
+      size_t owner = SIZE_MAX;
+      for (size_t n = 0; n < numNeighbors; ++n)
+      {
+        const size_t cell = NeighborCell(coordinates.data(), n);
+        if (cell == SIZE_MAX)
+          continue;
+
+        for (size_t i = cellStarts[cell]; i < cellStarts[cell + 1]; ++i)
+        {
+          const size_t reference = cellPoints[i];
+          if (!core[reference] || (!core[point] && reference >= owner))
+            continue;
+
+          // Every point of the cell of the query point is within range.
+          if (n != 0)
+          {
+            const double* r = referenceSet->colptr(reference);
+            double distance = 0.0;
+            for (size_t d = 0; d < dimensionality; ++d)
+              distance += (query[d] - r[d]) * (query[d] - r[d]);
+
+            ++totalBaseCases;
+            if (distance > squaredRange)
+              continue;
+          }
+
+          if (core[point])
+          {
+            uf.Union(point, reference);
+            break;
+          }
+
+          owner = reference;
+        }
+      }
+
+      // Only this thread handles this point, so nothing else writes its owner.
+      if (!core[point])
+        borderCore[point].store(owner, std::memory_order_relaxed);
+    }
+  }
+
+  baseCases += totalBaseCases;
+}
+
+void GridRangeSearch::BuildGrid(const double range)
+{
+  if (!(range > 0.0) || range == std::numeric_limits<double>::infinity())
+  {
+    std::ostringstream oss;
+    oss << "GridRangeSearch::Search(): the upper end of the range (" << range
+        << ") must be positive and finite";
+    throw std::invalid_argument(oss.str());
+  }
+
+  if (referenceSet == NULL)
+    throw std::invalid_argument("GridRangeSearch::Search(): Train() must be "
+        "called before searching");
+
+  if (range == gridRange)
+    return;
+
+  const arma::mat& data = *referenceSet;
+  const size_t dimensionality = data.n_rows;
+  gridRange = range;
+  cellSize = range / std::sqrt((double) dimensionality);
+
+  // Find the size of the grid.
+  gridCells.assign(dimensionality, 1);
+  if (data.n_cols > 0)
+  {
+    lowerBound = arma::min(data, 1);
+    const arma::vec upperBound = arma::max(data, 1);
+    double totalCells = 1.0;
+    for (size_t d = 0; d < dimensionality; ++d)
+    {
+      const double cells = std::floor((upperBound[d] - lowerBound[d]) /
+          cellSize) + 1.0;
+      totalCells *= cells;
+      gridCells[d] = (long long) std::min(cells, 1e18);
+    }
+
+    // The keys of the cells must fit in a size_t.
+    if (totalCells > 1e18)
+    {
+      gridRange = 0.0;
+      std::ostringstream oss;
+      oss << "GridRangeSearch::Search(): the range (" << range << ") is too "
+          << "small for the extent of the data";
+      throw std::invalid_argument(oss.str());
+    }
+  }
+  else
+  {
+    lowerBound.zeros(dimensionality);
+  }
+
+  // A point in a neighboring cell can be within range only if the gaps between
+  // the two cells along each dimension (|offset| - 1 cells) are short enough;
+  // since the diagonal of a cell is the range, this is when the sum of their
+  // squares is at most the dimensionality.
+  maxOffset = (long long) std::floor(1.0 +
+      std::sqrt((double) dimensionality));
+  neighborOffsets.assign(dimensionality, 0);
+  std::vector<long long> offset(dimensionality, -maxOffset);
+  while (true)
+  {
+    long long gaps = 0;
+    bool zero = true;
+    for (size_t d = 0; d < dimensionality; ++d)
+    {
+      const long long gap = std::max(std::abs(offset[d]) - 1, 0LL);
+      gaps += gap * gap;
+      zero &= (offset[d] == 0);
+    }
+
+    if (!zero && gaps <= (long long) dimensionality)
+      neighborOffsets.insert(neighborOffsets.end(), offset.begin(),
+          offset.end());
+
+    // Go to the next offset.
+    size_t d = 0;
+    while (d < dimensionality && offset[d] == maxOffset)
+      offset[d++] = -maxOffset;
+    if (d == dimensionality)
+      break;
+    ++offset[d];
+  }
+
+  // Sort the points by the key of their cell, so that the points of each cell
+  // are contiguous and in increasing order.
+  std::vector<std::pair<size_t, size_t>> keys(data.n_cols);
+  std::vector<long long> coordinates(dimensionality);
+  for (size_t i = 0; i < data.n_cols; ++i)
+  {
+    Coordinates(data.colptr(i), coordinates.data());
+    size_t key = 0;
+    for (size_t d = dimensionality; d > 0; --d)
+      key = key * gridCells[d - 1] + coordinates[d - 1];
+    keys[i] = std::make_pair(key, i);
+  }
+  std::sort(keys.begin(), keys.end());
+
+  cellIndices.clear();
+  cellStarts.clear();
+  cellPoints.resize(data.n_cols);
+  for (size_t i = 0; i < keys.size(); ++i)
+  {
+    if (i == 0 || keys[i].first != keys[i - 1].first)
+    {
+      cellIndices[keys[i].first] = cellStarts.size();
+      cellStarts.push_back(i);
+    }
+
+    cellPoints[i] = keys[i].second;
+  }
+  cellStarts.push_back(keys.size());
+
+  Log::Info << "Built grid with " << NumCells() << " non-empty cells of side "
+      << cellSize << "." << std::endl;
+}
+
+void GridRangeSearch::Coordinates(const double* point,
+                                  long long* coordinates) const
+{
+  // Coordinates far outside of the grid are clamped, so that they can't
+  // overflow; no cell near them holds any points anyway.
+  const double limit = (double) (maxOffset + 1);
+  for (size_t d = 0; d < referenceSet->n_rows; ++d)
+  {
+    const double coordinate = std::floor((point[d] - lowerBound[d]) /
+        cellSize);
+    coordinates[d] = (long long) std::max(-limit,
+        std::min(coordinate, (double) gridCells[d] + limit));
+  }
+}
+
+size_t GridRangeSearch::NeighborCell(const long long* coordinates,
+                                     const size_t neighbor) const
+{
+  const size_t dimensionality = referenceSet->n_rows;
+  const long long* offset = &neighborOffsets[neighbor * dimensionality];
+
+  size_t key = 0;
+  for (size_t d = dimensionality; d > 0; --d)
+  {
+    const long long coordinate = coordinates[d - 1] + offset[d - 1];
+    if (coordinate < 0 || coordinate >= gridCells[d - 1])
+      return SIZE_MAX;
+
+    key = key * gridCells[d - 1] + coordinate;
+  }
+
+  std::unordered_map<size_t, size_t>::const_iterator it =
+      cellIndices.find(key);
+  return (it == cellIndices.end()) ? SIZE_MAX : it->second;
+}
+
+size_t GridRangeSearch::Threads() const
+{
+#ifdef HAS_OPENMP
+  return (numThreads == 0) ? omp_get_max_threads() : numThreads;
+#else
+  return 1;
+#endif
+}
@@ -0,0 +1,205 @@
+/**
+ * @file grid_range_search.hpp
+ *
+ * A range search policy for DBSCAN that buckets the points into a grid of
+ * cells instead of building a tree.  This is much faster than tree-based range
+ * search for low-dimensional data, such as 2-D or 3-D spatial points.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_DBSCAN_GRID_RANGE_SEARCH_HPP
+#define MLPACK_METHODS_DBSCAN_GRID_RANGE_SEARCH_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/math/range.hpp>
+#include <mlpack/methods/range_search/range_search_callbacks.hpp>
+#include "dbscan_callbacks.hpp"
+#include <unordered_map>
+
+namespace mlpack {
+namespace dbscan {
+
+/**
+ * A Euclidean range search that buckets the reference points into a grid of
+ * cubic cells with side r / sqrt(d), where r is the upper end of the search
+ * range and d is the dimensionality; the grid is built at the first search
+ * with a new range.  The diagonal of a cell is then exactly r, so all points
+ * of a cell are within r of each other, and only the cells that are near
+ * enough to hold points within r of a query point have to be checked.  The
+ * non-empty cells are looked up in a hash table, so the memory used only
+ * depends on the number of points.
+ *
+ * It can be used as the RangeSearchType of DBSCAN, and it knows about the
+ * callbacks DBSCAN uses:
+ *
+ *  - When counting neighbors with NeighborCountCallback, every point of a cell
+ *    is counted without computing any distances, so a cell with at least
+ *    MaxCount() points makes all of its points core points at once; the
+ *    neighboring cells are only checked until enough neighbors are found.
+ *
+ *  - When uniting core points with CoreUnionCallback, each core point is united
+ *    with the first core point of its own cell, and with the first core point
+ *    within range in each neighboring cell, since the core points of a cell
+ *    all end up in the same cluster.  Each non-core point looks for the core
+ *    point with the smallest index within range itself, which gives the same
+ *    clusters as the callback would.
+ *
+ * Any other callback gets every result, as with range::RangeSearch.  The query
+ * points are searched in parallel when OpenMP is available; callbacks that
+ * aren't thread-safe (see range::RangeSearchCallbackTraits) get the results one
+ * thread at a time.
+ *
+ * The number of neighboring cells grows exponentially with the dimensionality,
+ * so this is only suited to low-dimensional data; a std::invalid_argument is
+ * thrown for data with more than MaxDimensionality dimensions.
+ */
+class GridRangeSearch
+{
+ public:
+  //! The largest dimensionality that is supported.
+  static const size_t MaxDimensionality = 6;
+
+  /**
+   * Create the object.  Train() must be called before any search.
+   *
+   * @param numThreads Number of threads searches run with (0 means the OpenMP
+   *     default).
+   */
+  GridRangeSearch(const size_t numThreads = 0);
+
+  /**
+   * Set the reference set to search, which must not be destroyed or modified
+   * while this object is used.  A std::invalid_argument is thrown if it has
+   * no dimensions or more than MaxDimensionality dimensions.
+   *
+   * @param referenceSet Points to search.
+   */
+  void Train(const arma::mat& referenceSet);
+
+  /**
+   * Search for all reference points whose Euclidean distance from each query
+   * point is in the given range, and pass each result to the callback as
+   * callback(queryIndex, referenceIndex, distance).  A std::invalid_argument is
+   * thrown if the upper end of the range isn't positive and finite.
+   *
+   * @param querySet Points to search for.
+   * @param range Range of distances to search.
+   * @param callback Callback to pass the results to.
+   */
+  template<typename CallbackType>
+  void Search(const arma::mat& querySet,
+              const math::Range& range,
+              CallbackType& callback);
+
+  /**
+   * Count the neighbors of each query point, up to the MaxCount() of the
+   * callback; see the class documentation.  If the lower end of the range isn't
+   * 0, every result is passed to the callback instead.
+   *
+   * @param querySet Points to count the neighbors of.
+   * @param range Range of distances to search.
+   * @param callback Callback to add the counts to.
+   */
+  void Search(const arma::mat& querySet,
+              const math::Range& range,
+              NeighborCountCallback& callback);
+
+  /**
+   * Unite the core points within range of each other and attach the other
+   * points to the core points within range of them; see the class
+   * documentation.  The query points must be the points of the reference set
+   * whose indices start at the QueryOffset() of the callback.  If the lower end
+   * of the range isn't 0, every result is passed to the callback instead.
+   *
+   * @param querySet Points to unite or attach.
+   * @param range Range of distances to search.
+   * @param callback Callback holding the core points and their components.
+   */
+  void Search(const arma::mat& querySet,
+              const math::Range& range,
+              CoreUnionCallback& callback);
+
+  //! Get the number of non-empty cells of the grid (0 if it isn't built yet).
+  size_t NumCells() const { return cellStarts.empty() ? 0 :
+      cellStarts.size() - 1; }
+
+  //! Get the number of distances computed since the last Train().
+  size_t BaseCases() const { return baseCases; }
+
+  //! Get the number of threads searches run with (0 means the OpenMP default).
+  size_t NumThreads() const { return numThreads; }
+  //! Modify the number of threads searches run with (0 means the OpenMP
+  //! default).
+  size_t& NumThreads() { return numThreads; }
+
+ private:
+  //! The reference set.
+  const arma::mat* referenceSet;
+  //! The range the grid was built for (the upper end of the search range).
+  double gridRange;
+  //! The side of each cell.
+  double cellSize;
+  //! The lower corner of the grid.
+  arma::vec lowerBound;
+  //! The number of cells of the grid along each dimension.
+  std::vector<long long> gridCells;
+  //! The largest offset of a neighboring cell along any dimension.
+  long long maxOffset;
+  //! The offsets of the neighboring cells, d values per cell; the cell itself
+  //! comes first.
+  std::vector<long long> neighborOffsets;
+  //! The index of each non-empty cell, by the key of its coordinates.
+  std::unordered_map<size_t, size_t> cellIndices;
+  //! The points of cell i are cellPoints[cellStarts[i]] to
+  //! cellPoints[cellStarts[i + 1] - 1], in increasing order.
+  std::vector<size_t> cellStarts;
+  //! The indices of the points of each cell.
+  std::vector<size_t> cellPoints;
+  //! The number of distances computed.
+  size_t baseCases;
+  //! The number of threads searches run with.
+  size_t numThreads;
+
+  //! The number of query points each thread takes at once.
+  static const size_t QueryBlockSize = 256;
+
+  //! Build the grid for the given range, unless it is already built for it.
+  void BuildGrid(const double range);
+
+  //! Compute the cell coordinates of the given point.
+  void Coordinates(const double* point, long long* coordinates) const;
+
+  //! Return the index of the given neighbor of the cell with the given
+  //! coordinates, or SIZE_MAX if that cell is empty.
+  size_t NeighborCell(const long long* coordinates,
+                      const size_t neighbor) const;
+
+  //! Return the number of threads to use.
+  size_t Threads() const;
+
+  //! Pass every result to the callback.
+  template<typename CallbackType>
+  void SearchAll(const arma::mat& querySet,
+                 const math::Range& range,
+                 CallbackType& callback);
+
+  //! Pass every result of the given query points to the callback, and return
+  //! the number of distances computed.
+  template<typename CallbackType>
+  size_t SearchQueries(const arma::mat& querySet,
+                       const math::Range& range,
+                       const size_t begin,
+                       const size_t end,
+                       CallbackType& callback) const;
+};
+
+} // namespace dbscan
+} // namespace mlpack
+
+// Include implementation.
+#include "grid_range_search_impl.hpp"
+
+#endif
@@ -0,0 +1,129 @@
+/**
+ * @file grid_range_search_impl.hpp
+ *
+ * Implementation of the templated methods of GridRangeSearch.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_DBSCAN_GRID_RANGE_SEARCH_IMPL_HPP
+#define MLPACK_METHODS_DBSCAN_GRID_RANGE_SEARCH_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "grid_range_search.hpp"
+
+namespace mlpack {
+namespace dbscan {
+
+template<typename CallbackType>
+void GridRangeSearch::Search(const arma::mat& querySet,
+                             const math::Range& range,
+                             CallbackType& callback)
+{
+  SearchAll(querySet, range, callback);
+}
+
+template<typename CallbackType>
+void GridRangeSearch::SearchAll(const arma::mat& querySet,
+                                const math::Range& range,
+                                CallbackType& callback)
+{
+  BuildGrid(range.Hi());
+
+  const size_t threads = Threads();
+  const size_t numBlocks = (querySet.n_cols + QueryBlockSize - 1) /
+      QueryBlockSize;
+  if (threads <= 1 || numBlocks <= 1)
+  {
+    baseCases += SearchQueries(querySet, range, 0, querySet.n_cols, callback);
+    return;
+  }
+
+  size_t totalBaseCases = 0;
+
+  #pragma omp parallel num_threads(threads) reduction(+:totalBaseCases)
+  {
+    // Each thread holds the results of a block in its own buffer, unless the
+    // callback may be called by several threads at once.
+    range::RangeSearchBufferCallback buffer;
+
+#ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables. If we're building for Visual Studio,
+    // use the intmax_t type instead.
+    #pragma omp for schedule(dynamic)
+    for (intmax_t b = 0; b < (intmax_t) numBlocks; ++b)
+#else
+    #pragma omp for schedule(dynamic)
+    for (size_t b = 0; b < numBlocks; ++b)
+#endif
+    {
+      const size_t begin = b * QueryBlockSize;
+      const size_t end = std::min(begin + QueryBlockSize,
+          (size_t) querySet.n_cols);
+
+      if (range::RangeSearchCallbackTraits<CallbackType>::IsThreadSafe)
+      {
+        totalBaseCases += SearchQueries(querySet, range, begin, end, callback);
+      }
+      else
+      {
+        totalBaseCases += SearchQueries(querySet, range, begin, end, buffer);
+
+        // Only one thread at a time may pass results to the callback.
+        #pragma omp critical(GridRangeSearchFlushResults)
+        buffer.Flush(callback);
+      }
+    }
+  }
+
+  baseCases += totalBaseCases;
+}
+
+template<typename CallbackType>
+size_t GridRangeSearch::SearchQueries(const arma::mat& querySet,
+                                      const math::Range& range,
+                                      const size_t begin,
+                                      const size_t end,
+                                      CallbackType& callback) const
+{
+  const size_t dimensionality = referenceSet->n_rows;
+  const size_t numNeighbors = neighborOffsets.size() / dimensionality;
+  std::vector<long long> coordinates(dimensionality);
+  size_t distances = 0;
+
+  for (size_t q = begin; q < end; ++q)
+  {
+    const double* query = querySet.colptr(q);
+    Coordinates(query, coordinates.data());
+
+    for (size_t n = 0; n < numNeighbors; ++n)
+    {
+      const size_t cell = NeighborCell(coordinates.data(), n);
+      if (cell == SIZE_MAX)
+        continue;
+
+      for (size_t i = cellStarts[cell]; i < cellStarts[cell + 1]; ++i)
+      {
+        const double* reference = referenceSet->colptr(cellPoints[i]);
+        double distance = 0.0;
+        for (size_t d = 0; d < dimensionality; ++d)
+          distance += (query[d] - reference[d]) * (query[d] - reference[d]);
+        distance = std::sqrt(distance);
+
+        ++distances;
+        if (range.Contains(distance))
+          callback(q, cellPoints[i], distance);
+      }
+    }
+  }
+
+  return distances;
+}
+
+} // namespace dbscan
+} // namespace mlpack
+
+#endif
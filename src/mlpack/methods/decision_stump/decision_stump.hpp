@@ -17,6 +17,10 @@
 namespace mlpack {
 namespace decision_stump {
 
+// Forward declaration.
+template<typename MatType>
+class DecisionStumpIndex;
+
 /**
  * This class implements a decision stump. It constructs a single level
  * decision tree, i.e., a decision stump. It uses entropy to decide splitting
@@ -103,6 +107,21 @@ class DecisionStump
              const size_t classes,
              const size_t bucketSize);
 
+  /**
+   * Train the decision stump with the given weights on the data and labels the
+   * given index was built on.  This gives the same stump as the weighted
+   * Train(), but everything that doesn't depend on the weights (sorting the
+   * dimensions, finding the buckets, and finding the bins of the stump that
+   * splits each dimension) was done when the index was built, so training is
+   * a linear scan of each dimension.  This is useful when many stumps are
+   * trained on the same data with different weights, as in boosting.
+   *
+   * @param index Index of the data and labels to train on.
+   * @param weights Weights for each point in the dataset.
+   */
+  void Train(const DecisionStumpIndex<MatType>& index,
+             const arma::rowvec& weights);
+
   /**
    * Classification function. After training, classify test, and put the
    * predicted classes in predictedLabels.
@@ -128,11 +147,19 @@ class DecisionStump
   //! Modify the labels for each split bin (be careful!).
   arma::Col<size_t>& BinLabels() { return binLabels; }
 
+  //! Get the number of classes.
+  size_t Classes() const { return classes; }
+  //! Get the minimum number of points in a bucket.
+  size_t BucketSize() const { return bucketSize; }
+
   //! Serialize the decision stump.
   template<typename Archive>
   void Serialize(Archive& ar, const unsigned int /* version */);
 
  private:
+  // The index trains stumps on each dimension.
+  friend class DecisionStumpIndex<MatType>;
+
   //! The number of classes (we must store this for boosting).
   size_t classes;
   //! The minimum number of points in a bucket.
@@ -156,7 +183,32 @@ class DecisionStump
   template<bool UseWeights, typename VecType>
   double SetupSplitDimension(const VecType& dimension,
                              const arma::Row<size_t>& labels,
-                             const arma::rowvec& weightD);
+                             const arma::rowvec& weightD) const;
+
+  /**
+   * Split the sorted labels of a dimension into buckets of at least bucketSize
+   * points (except the last), ending where the label changes.
+   *
+   * @param sortedLabels Labels of the points, sorted by the dimension.
+   * @param bucketEnds This will be filled with the index of the last point of
+   *     each bucket.
+   */
+  void Buckets(const arma::Row<size_t>& sortedLabels,
+               std::vector<size_t>& bucketEnds) const;
+
+  /**
+   * Calculate the entropy of a split of a dimension into the given buckets.
+   *
+   * @param sortedLabels Labels of the points, sorted by the dimension.
+   * @param sortedWeights Weights of the points, sorted by the dimension
+   *     (ignored if UseWeights is false).
+   * @param bucketEnds The index of the last point of each bucket.
+   * @tparam UseWeights Whether we need to run a weighted Decision Stump.
+   */
+  template<bool UseWeights>
+  double BucketEntropy(const arma::Row<size_t>& sortedLabels,
+                       const arma::rowvec& sortedWeights,
+                       const std::vector<size_t>& bucketEnds) const;
 
   /**
    * After having decided the dimension on which to split, train on that
@@ -182,7 +234,7 @@ class DecisionStump
    *      element.
    */
   template<typename VecType>
-  double CountMostFreq(const VecType& subCols);
+  double CountMostFreq(const VecType& subCols) const;
 
   /**
    * Returns 1 if all the values of featureRow are not same.
@@ -190,7 +242,7 @@ class DecisionStump
    * @param featureRow The dimension which is checked for identical values.
    */
   template<typename VecType>
-  int IsDistinct(const VecType& featureRow);
+  int IsDistinct(const VecType& featureRow) const;
 
   /**
    * Calculate the entropy of the given dimension.
@@ -203,7 +255,7 @@ class DecisionStump
    */
   template<bool UseWeights, typename VecType, typename WeightVecType>
   double CalculateEntropy(const VecType& labels,
-                          const WeightVecType& weights);
+                          const WeightVecType& weights) const;
 
   /**
    * Train the decision stump on the given data and labels.
@@ -225,4 +277,7 @@ class DecisionStump
 
 #include "decision_stump_impl.hpp"
 
+// Include the index, which uses the stump.
+#include "decision_stump_index.hpp"
+
 #endif
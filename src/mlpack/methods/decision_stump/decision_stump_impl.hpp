@@ -105,20 +105,39 @@ void DecisionStump<MatType>::Train(const MatType& data,
 {
   // If classLabels are not all identical, proceed with training.
   size_t bestDim = 0;
-  double entropy;
   const double rootEntropy = CalculateEntropy<UseWeights>(labels, weights);
 
+  // For each dimension with non-identical values, treat it as a potential
+  // splitting dimension and calculate entropy if split on it.  The dimensions
+  // are independent, so they are searched in parallel.
+  arma::vec entropies(data.n_rows);
+  std::vector<int> distinct(data.n_rows);
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables. If we're building for Visual Studio, use
+  // the intmax_t type instead.
+  #pragma omp parallel for
+  for (intmax_t i = 0; i < (intmax_t) data.n_rows; i++)
+#else
+  #pragma omp parallel for
+  for (size_t i = 0; i < data.n_rows; i++)
+#endif
+  {
+    distinct[i] = IsDistinct(data.row(i));
+    if (distinct[i])
+    {
+      entropies[i] = SetupSplitDimension<UseWeights>(data.row(i), labels,
+          weights);
+    }
+  }
+
   double gain, bestGain = 0.0;
   for (size_t i = 0; i < data.n_rows; i++)
   {
     // Go through each dimension of the data.
-    if (IsDistinct(data.row(i)))
+    if (distinct[i])
     {
-      // For each dimension with non-identical values, treat it as a potential
-      // splitting dimension and calculate entropy if split on it.
-      entropy = SetupSplitDimension<UseWeights>(data.row(i), labels, weights);
-
-      gain = rootEntropy - entropy;
+      gain = rootEntropy - entropies[i];
       // Find the dimension with the best entropy so that the gain is
       // maximized.
 
@@ -133,10 +152,76 @@ void DecisionStump<MatType>::Train(const MatType& data,
   }
   splitDimension = bestDim;
 
-  // Once the splitting column/dimension has been decided, train on it.
+  // Once the splitting column/dimension has been decided, train on it.  Clear
+  // the bins of any previous training first.
+  split.reset();
+  binLabels.reset();
   TrainOnDim(data.row(splitDimension), labels);
 }
 
+/**
+ * Train the decision stump with the given weights, using the given index.
+ */
+template<typename MatType>
+void DecisionStump<MatType>::Train(const DecisionStumpIndex<MatType>& index,
+                                   const arma::rowvec& weights)
+{
+  classes = index.classes;
+  bucketSize = index.bucketSize;
+
+  // This is the same search as Train(), but the sorted order and the buckets
+  // of each dimension come from the index.
+  const size_t dimensionality = index.stumps.size();
+  const double rootEntropy = CalculateEntropy<true>(index.labels, weights);
+  arma::vec entropies(dimensionality);
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables. If we're building for Visual Studio, use
+  // the intmax_t type instead.
+  #pragma omp parallel for
+  for (intmax_t i = 0; i < (intmax_t) dimensionality; i++)
+#else
+  #pragma omp parallel for
+  for (size_t i = 0; i < dimensionality; i++)
+#endif
+  {
+    if (index.distinct[i])
+    {
+      const arma::uvec& sortedIndex = index.sortedIndices[i];
+      arma::Row<size_t> sortedLabels(sortedIndex.n_elem);
+      arma::rowvec sortedWeights(sortedIndex.n_elem);
+      for (size_t j = 0; j < sortedIndex.n_elem; j++)
+      {
+        sortedLabels(j) = index.labels(sortedIndex(j));
+        sortedWeights(j) = weights(sortedIndex(j));
+      }
+
+      entropies[i] = BucketEntropy<true>(sortedLabels, sortedWeights,
+          index.bucketEnds[i]);
+    }
+  }
+
+  size_t bestDim = 0;
+  double gain, bestGain = 0.0;
+  for (size_t i = 0; i < dimensionality; i++)
+  {
+    if (index.distinct[i])
+    {
+      gain = rootEntropy - entropies[i];
+      if (gain < bestGain)
+      {
+        bestDim = i;
+        bestGain = gain;
+      }
+    }
+  }
+
+  // The bins of the stump on each dimension don't depend on the weights.
+  splitDimension = bestDim;
+  split = index.stumps[bestDim].split;
+  binLabels = index.stumps[bestDim].binLabels;
+}
+
 /**
  * Classification function. After training, classify test, and put the predicted
  * classes in predictedLabels.
@@ -225,11 +310,8 @@ template<bool UseWeights, typename VecType>
 double DecisionStump<MatType>::SetupSplitDimension(
     const VecType& dimension,
     const arma::Row<size_t>& labels,
-    const arma::rowvec& weights)
+    const arma::rowvec& weights) const
 {
-  size_t i, count, begin, end;
-  double entropy = 0.0;
-
   // Store the indices of the sorted dimension to build a vector of sorted
   // labels.  This sort is stable.
   arma::uvec sortedIndexDim = arma::stable_sort_index(dimension.t());
@@ -237,7 +319,7 @@ double DecisionStump<MatType>::SetupSplitDimension(
   arma::Row<size_t> sortedLabels(dimension.n_elem);
   arma::rowvec sortedWeights(dimension.n_elem);
 
-  for (i = 0; i < dimension.n_elem; i++)
+  for (size_t i = 0; i < dimension.n_elem; i++)
   {
     sortedLabels(i) = labels(sortedIndexDim(i));
 
@@ -246,6 +328,24 @@ double DecisionStump<MatType>::SetupSplitDimension(
       sortedWeights(i) = weights(sortedIndexDim(i));
   }
 
+  std::vector<size_t> bucketEnds;
+  Buckets(sortedLabels, bucketEnds);
+  return BucketEntropy<UseWeights>(sortedLabels, sortedWeights, bucketEnds);
+}
+
+/**
+ * Split the sorted labels of a dimension into buckets.
+ *
+ * @param sortedLabels Labels of the points, sorted by the dimension.
+ * @param bucketEnds Vector to store the index of the last point of each bucket.
+ */
+template<typename MatType>
+void DecisionStump<MatType>::Buckets(const arma::Row<size_t>& sortedLabels,
+                                     std::vector<size_t>& bucketEnds) const
+{
+  size_t i, count, begin, end;
+  bucketEnds.clear();
+
   i = 0;
   count = 0;
 
@@ -258,14 +358,7 @@ double DecisionStump<MatType>::SetupSplitDimension(
     {
       // If we're at the end, then don't worry about the bucket size; just take
       // this as the last bin.
-      begin = i - count + 1;
-      end = i;
-
-      // Use ratioEl to calculate the ratio of elements in this split.
-      const double ratioEl = ((double) (end - begin + 1) / sortedLabels.n_elem);
-
-      entropy += ratioEl * CalculateEntropy<UseWeights>(
-          sortedLabels.subvec(begin, end), sortedWeights.subvec(begin, end));
+      bucketEnds.push_back(i);
       i++;
     }
     else if (sortedLabels(i) != sortedLabels(i + 1))
@@ -286,13 +379,9 @@ double DecisionStump<MatType>::SetupSplitDimension(
       else
       {
         // If it is not, then take the bucket size as the value of count.
-        begin = i - count + 1;
         end = i;
       }
-      const double ratioEl = ((double) (end - begin + 1) / sortedLabels.n_elem);
-
-      entropy += ratioEl * CalculateEntropy<UseWeights>(
-          sortedLabels.subvec(begin, end), sortedWeights.subvec(begin, end));
+      bucketEnds.push_back(end);
 
       i = end + 1;
       count = 0;
@@ -300,6 +389,35 @@ double DecisionStump<MatType>::SetupSplitDimension(
     else
       i++;
   }
+}
+
+/**
+ * Calculate the entropy of a split into the given buckets.
+ *
+ * @param sortedLabels Labels of the points, sorted by the dimension.
+ * @param sortedWeights Weights of the points, sorted by the dimension.
+ * @param bucketEnds The index of the last point of each bucket.
+ */
+template<typename MatType>
+template<bool UseWeights>
+double DecisionStump<MatType>::BucketEntropy(
+    const arma::Row<size_t>& sortedLabels,
+    const arma::rowvec& sortedWeights,
+    const std::vector<size_t>& bucketEnds) const
+{
+  double entropy = 0.0;
+  size_t begin = 0;
+  for (size_t i = 0; i < bucketEnds.size(); i++)
+  {
+    const size_t end = bucketEnds[i];
+
+    // Use ratioEl to calculate the ratio of elements in this split.
+    const double ratioEl = ((double) (end - begin + 1) / sortedLabels.n_elem);
+
+    entropy += ratioEl * CalculateEntropy<UseWeights>(
+        sortedLabels.subvec(begin, end), sortedWeights.subvec(begin, end));
+    begin = end + 1;
+  }
   return entropy;
 }
 
@@ -315,68 +433,32 @@ template<typename VecType>
 void DecisionStump<MatType>::TrainOnDim(const VecType& dimension,
                                         const arma::Row<size_t>& labels)
 {
-  size_t i, count, begin, end;
-
   typename MatType::row_type sortedSplitDim = arma::sort(dimension);
   arma::uvec sortedSplitIndexDim = arma::stable_sort_index(dimension.t());
   arma::Row<size_t> sortedLabels(dimension.n_elem);
   sortedLabels.fill(0);
 
-  for (i = 0; i < dimension.n_elem; i++)
+  for (size_t i = 0; i < dimension.n_elem; i++)
     sortedLabels(i) = labels(sortedSplitIndexDim(i));
 
-  arma::rowvec subCols;
-  double mostFreq;
-  i = 0;
-  count = 0;
-  while (i < sortedLabels.n_elem)
+  // Each bucket becomes a bin, labeled with the most frequent label in it.
+  std::vector<size_t> bucketEnds;
+  Buckets(sortedLabels, bucketEnds);
+  size_t begin = 0;
+  for (size_t i = 0; i < bucketEnds.size(); i++)
   {
-    count++;
-    if (i == sortedLabels.n_elem - 1)
-    {
-      begin = i - count + 1;
-      end = i;
+    const size_t end = bucketEnds[i];
 
-      mostFreq = CountMostFreq(sortedLabels.cols(begin, end));
+    // Find the most frequent element in the bucket so as to assign a label to
+    // the bucket.
+    const double mostFreq = CountMostFreq(sortedLabels.cols(begin, end));
 
-      split.resize(split.n_elem + 1);
-      split(split.n_elem - 1) = sortedSplitDim(begin);
-      binLabels.resize(binLabels.n_elem + 1);
-      binLabels(binLabels.n_elem - 1) = mostFreq;
+    split.resize(split.n_elem + 1);
+    split(split.n_elem - 1) = sortedSplitDim(begin);
+    binLabels.resize(binLabels.n_elem + 1);
+    binLabels(binLabels.n_elem - 1) = mostFreq;
 
-      i++;
-    }
-    else if (sortedLabels(i) != sortedLabels(i + 1))
-    {
-      if (count < bucketSize)
-      {
-        // Test for different values of bucketSize, especially extreme cases.
-        begin = i - count + 1;
-        end = begin + bucketSize - 1;
-
-        if (end > sortedLabels.n_elem - 1)
-          end = sortedLabels.n_elem - 1;
-      }
-      else
-      {
-        begin = i - count + 1;
-        end = i;
-      }
-
-      // Find the most frequent element in subCols so as to assign a label to
-      // the bucket of subCols.
-      mostFreq = CountMostFreq(sortedLabels.cols(begin, end));
-
-      split.resize(split.n_elem + 1);
-      split(split.n_elem - 1) = sortedSplitDim(begin);
-      binLabels.resize(binLabels.n_elem + 1);
-      binLabels(binLabels.n_elem - 1) = mostFreq;
-
-      i = end + 1;
-      count = 0;
-    }
-    else
-      i++;
+    begin = end + 1;
   }
 
   // Now trim the split matrix so that buckets one after the after which point
@@ -406,7 +488,7 @@ void DecisionStump<MatType>::MergeRanges()
 
 template<typename MatType>
 template<typename VecType>
-double DecisionStump<MatType>::CountMostFreq(const VecType& subCols)
+double DecisionStump<MatType>::CountMostFreq(const VecType& subCols) const
 {
   // We'll create a map of elements and the number of times that each element is
   // seen.
@@ -445,7 +527,7 @@ double DecisionStump<MatType>::CountMostFreq(const VecType& subCols)
  */
 template<typename MatType>
 template<typename VecType>
-int DecisionStump<MatType>::IsDistinct(const VecType& featureRow)
+int DecisionStump<MatType>::IsDistinct(const VecType& featureRow) const
 {
   typename VecType::elem_type val = featureRow(0);
   for (size_t i = 1; i < featureRow.n_elem; ++i)
@@ -464,7 +546,7 @@ template<typename MatType>
 template<bool UseWeights, typename VecType, typename WeightVecType>
 double DecisionStump<MatType>::CalculateEntropy(
     const VecType& labels,
-    const WeightVecType& weights)
+    const WeightVecType& weights) const
 {
   double entropy = 0.0;
   size_t j;
@@ -0,0 +1,83 @@
+/**
+ * @file decision_stump_index.hpp
+ *
+ * Definition of the DecisionStumpIndex class, which holds everything about a
+ * dataset that training a decision stump on it needs, except the weights.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_DECISION_STUMP_DECISION_STUMP_INDEX_HPP
+#define MLPACK_METHODS_DECISION_STUMP_DECISION_STUMP_INDEX_HPP
+
+#include <mlpack/prereqs.hpp>
+#include "decision_stump.hpp"
+
+namespace mlpack {
+namespace decision_stump {
+
+/**
+ * An index of a dataset and its labels for training weighted decision stumps,
+ * as in boosting.  For each dimension, the index holds the sorted order of the
+ * points, the buckets the sorted labels are split into, and the stump that
+ * splits the dimension; none of these depend on the weights.  Training a stump
+ * with DecisionStump::Train(index, weights) then only computes the weighted
+ * entropy of the buckets of each dimension, with one linear scan per
+ * dimension, instead of sorting every dimension again.
+ *
+ * The index takes memory for one index per point and dimension (the size of
+ * the dataset).  It is built in parallel over the dimensions.
+ *
+ * @tparam MatType Type of matrix that is being used (sparse or dense).
+ */
+template<typename MatType = arma::mat>
+class DecisionStumpIndex
+{
+ public:
+  /**
+   * Build the index of the given data and labels.
+   *
+   * @param data Dataset to index.
+   * @param labels Labels of the dataset.
+   * @param classes Number of distinct classes in labels.
+   * @param bucketSize Minimum size of bucket when splitting.
+   */
+  DecisionStumpIndex(const MatType& data,
+                     const arma::Row<size_t>& labels,
+                     const size_t classes,
+                     const size_t bucketSize = 10);
+
+  //! Get the number of classes.
+  size_t Classes() const { return classes; }
+  //! Get the minimum number of points in a bucket.
+  size_t BucketSize() const { return bucketSize; }
+
+ private:
+  // The decision stump reads the index to train.
+  friend class DecisionStump<MatType>;
+
+  //! The number of classes.
+  size_t classes;
+  //! The minimum number of points in a bucket.
+  size_t bucketSize;
+  //! The labels of the points.
+  arma::Row<size_t> labels;
+  //! The indices of the points, in stable sorted order, for each dimension.
+  std::vector<arma::uvec> sortedIndices;
+  //! The index of the last point of each bucket, for each dimension.
+  std::vector<std::vector<size_t>> bucketEnds;
+  //! Whether the values of each dimension are not all identical.
+  std::vector<int> distinct;
+  //! The stump that splits each dimension.
+  std::vector<DecisionStump<MatType>> stumps;
+};
+
+} // namespace decision_stump
+} // namespace mlpack
+
+// Include implementation.
+#include "decision_stump_index_impl.hpp"
+
+#endif
@@ -0,0 +1,68 @@
+/**
+ * @file decision_stump_index_impl.hpp
+ *
+ * Implementation of the DecisionStumpIndex class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_DECISION_STUMP_DECISION_STUMP_INDEX_IMPL_HPP
+#define MLPACK_METHODS_DECISION_STUMP_DECISION_STUMP_INDEX_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "decision_stump_index.hpp"
+
+namespace mlpack {
+namespace decision_stump {
+
+template<typename MatType>
+DecisionStumpIndex<MatType>::DecisionStumpIndex(
+    const MatType& data,
+    const arma::Row<size_t>& labels,
+    const size_t classes,
+    const size_t bucketSize) :
+    classes(classes),
+    bucketSize(bucketSize),
+    labels(labels),
+    sortedIndices(data.n_rows),
+    bucketEnds(data.n_rows),
+    distinct(data.n_rows),
+    stumps(data.n_rows)
+{
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables. If we're building for Visual Studio, use
+  // the intmax_t type instead.
+  #pragma omp parallel for
+  for (intmax_t i = 0; i < (intmax_t) data.n_rows; i++)
+#else
+  #pragma omp parallel for
+  for (size_t i = 0; i < data.n_rows; i++)
+#endif
+  {
+    DecisionStump<MatType>& stump = stumps[i];
+    stump.classes = classes;
+    stump.bucketSize = bucketSize;
+    stump.splitDimension = i;
+    stump.split.reset();
+    stump.binLabels.reset();
+
+    // The sort is stable, as in DecisionStump::Train().
+    distinct[i] = stump.IsDistinct(data.row(i));
+    sortedIndices[i] = arma::stable_sort_index(data.row(i).t());
+
+    arma::Row<size_t> sortedLabels(data.n_cols);
+    for (size_t j = 0; j < data.n_cols; j++)
+      sortedLabels(j) = labels(sortedIndices[i](j));
+    stump.Buckets(sortedLabels, bucketEnds[i]);
+
+    stump.TrainOnDim(data.row(i), labels);
+  }
+}
+
+} // namespace decision_stump
+} // namespace mlpack
+
+#endif
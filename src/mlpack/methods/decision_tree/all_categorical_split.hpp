@@ -85,6 +85,23 @@ class AllCategoricalSplit
       const ElemType& point,
       const arma::Col<ElemType>& classProbabilities,
       const AuxiliarySplitInfo<ElemType>& /* aux */);
+
+  /**
+   * Get the split as a list of split points, for FlatTree.  A categorical split
+   * has none, since a point goes to the child whose index is its category.
+   *
+   * @param classProbabilities (Unused) auxiliary information for the split.
+   * @param aux (Unused) auxiliary information for the split.
+   * @param splitPoints (Unused) split points.
+   * @return false, since the child of a point is its category.
+   */
+  template<typename ElemType>
+  static bool SplitPoints(const arma::Col<ElemType>& /* classProbabilities */,
+                          const AuxiliarySplitInfo<ElemType>& /* aux */,
+                          arma::Col<ElemType>& /* splitPoints */)
+  {
+    return false;
+  }
 };
 
 } // namespace tree
@@ -20,7 +20,14 @@ class AllDimensionSelect
   /**
    * Construct the AllDimensionSelect object for the given number of dimensions.
    */
-  AllDimensionSelect(const size_t dimensions) : i(0), dimensions(dimensions) { }
+  AllDimensionSelect(const size_t dimensions = 0) :
+      i(0), dimensions(dimensions) { }
+
+  /**
+   * Set the number of dimensions to select from.  DecisionTree calls this at
+   * each node before Begin().
+   */
+  void Dimensions(const size_t dimensions) { this->dimensions = dimensions; }
 
   /**
    * Get the first dimension to select from.
@@ -45,7 +52,7 @@ class AllDimensionSelect
   //! The current dimension we are looking at.
   size_t i;
   //! The number of dimensions to select from.
-  const size_t dimensions;
+  size_t dimensions;
 };
 
 } // namespace tree
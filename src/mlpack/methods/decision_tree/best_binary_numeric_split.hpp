@@ -83,6 +83,25 @@ class BestBinaryNumericSplit
       const ElemType& point,
       const arma::Col<ElemType>& classProbabilities,
       const AuxiliarySplitInfo<ElemType>& /* aux */);
+
+  /**
+   * Get the split as a list of split points, for FlatTree: a point goes to the
+   * child whose index is the number of split points less than its value.  For
+   * this split, that is the one split point.
+   *
+   * @param classProbabilities Auxiliary information for the split.
+   * @param aux (Unused) auxiliary information for the split.
+   * @param splitPoints This will be filled with the split points.
+   * @return true, since the split is described by its split points.
+   */
+  template<typename ElemType>
+  static bool SplitPoints(const arma::Col<ElemType>& classProbabilities,
+                          const AuxiliarySplitInfo<ElemType>& /* aux */,
+                          arma::Col<ElemType>& splitPoints)
+  {
+    splitPoints = classProbabilities.subvec(0, 0);
+    return true;
+  }
 };
 
 } // namespace tree
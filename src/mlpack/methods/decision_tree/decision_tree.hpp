@@ -16,8 +16,11 @@
 #include <mlpack/prereqs.hpp>
 #include "gini_gain.hpp"
 #include "best_binary_numeric_split.hpp"
+#include "histogram_numeric_split.hpp"
 #include "all_categorical_split.hpp"
 #include "all_dimension_select.hpp"
+#include "multiple_random_dimension_select.hpp"
+#include "flat_tree.hpp"
 #include <type_traits>
 
 namespace mlpack {
@@ -188,13 +191,17 @@ class DecisionTree :
    * @param numClasses Number of classes in the dataset.
    * @param weights Weights of all the labels
    * @param minimumLeafSize Minimum number of points in each leaf node.
+   * @param dimensionSelector Instantiated dimension selection policy, which
+   *      chooses the dimensions to search for a split at each node.
    */
   template<typename MatType, typename LabelsType>
   void Train(MatType&& data,
              const data::DatasetInfo& datasetInfo,
              LabelsType&& labels,
              const size_t numClasses,
-             const size_t minimumLeafSize = 10);
+             const size_t minimumLeafSize = 10,
+             DimensionSelectionType dimensionSelector =
+                 DimensionSelectionType());
 
   /**
    * Train the decision tree on the given data, assuming that all dimensions are
@@ -207,12 +214,16 @@ class DecisionTree :
    * @param numClasses Number of classes in the dataset.
    * @param weights Weights of all the labels
    * @param minimumLeafSize Minimum number of points in each leaf node.
+   * @param dimensionSelector Instantiated dimension selection policy, which
+   *      chooses the dimensions to search for a split at each node.
    */
   template<typename MatType, typename LabelsType>
   void Train(MatType&& data,
              LabelsType&& labels,
              const size_t numClasses,
-             const size_t minimumLeafSize = 10);
+             const size_t minimumLeafSize = 10,
+             DimensionSelectionType dimensionSelector =
+                 DimensionSelectionType());
 
   /**
    * Train the decision tree on the given weighted data.  This will overwrite
@@ -227,6 +238,8 @@ class DecisionTree :
    * @param numClasses Number of classes in the dataset.
    * @param weights Weights of all the labels
    * @param minimumLeafSize Minimum number of points in each leaf node.
+   * @param dimensionSelector Instantiated dimension selection policy, which
+   *      chooses the dimensions to search for a split at each node.
    */
   template<typename MatType, typename LabelsType, typename WeightsType>
   void Train(MatType&& data,
@@ -235,6 +248,8 @@ class DecisionTree :
              const size_t numClasses,
              WeightsType&& weights,
              const size_t minimumLeafSize = 10,
+             DimensionSelectionType dimensionSelector =
+                 DimensionSelectionType(),
              const std::enable_if_t<arma::is_arma_type<typename
                  std::remove_reference<WeightsType>::type>::value>* = 0);
 
@@ -249,6 +264,8 @@ class DecisionTree :
    * @param numClasses Number of classes in the dataset.
    * @param weights Weights of all the labels
    * @param minimumLeafSize Minimum number of points in each leaf node.
+   * @param dimensionSelector Instantiated dimension selection policy, which
+   *      chooses the dimensions to search for a split at each node.
    */
   template<typename MatType, typename LabelsType, typename WeightsType>
   void Train(MatType&& data,
@@ -256,6 +273,8 @@ class DecisionTree :
              const size_t numClasses,
              WeightsType&& weights,
              const size_t minimumLeafSize = 10,
+             DimensionSelectionType dimensionSelector =
+                 DimensionSelectionType(),
              const std::enable_if_t<arma::is_arma_type<typename
                  std::remove_reference<WeightsType>::type>::value>* = 0);
 
@@ -332,6 +351,20 @@ class DecisionTree :
   template<typename VecType>
   size_t CalculateDirection(const VecType& point) const;
 
+  //! Get the dimension this node splits on (if it is not a leaf).
+  size_t SplitDimension() const { return splitDimension; }
+
+  /**
+   * Given that this node is not a leaf, get its split as a list of split
+   * points: a point goes to the child whose index is the number of split points
+   * less than its value in the split dimension.  This is used by FlatTree.
+   *
+   * @param splitPoints This will be filled with the split points.
+   * @return false if the split is categorical and the child of a point is its
+   *     category instead, in which case splitPoints is not used.
+   */
+  bool SplitPoints(arma::Col<ElemType>& splitPoints) const;
+
  private:
   //! The vector of children.
   std::vector<DecisionTree*> children;
@@ -357,6 +390,20 @@ class DecisionTree :
   typedef typename CategoricalSplit::template AuxiliarySplitInfo<ElemType>
       CategoricalAuxiliarySplitInfo;
 
+  //! Nodes with at least this many points evaluate their dimensions and train
+  //! their children as separate OpenMP tasks.
+  static const size_t ParallelTrainThreshold = 1024;
+
+  /**
+   * Return whether a node with the given number of points should be trained in
+   * parallel: that is, whether OpenMP tasks are available, the dimension
+   * selection policy is AllDimensionSelect (other policies may draw random
+   * numbers, which must happen in order), and the node holds at least
+   * ParallelTrainThreshold points.  A tree trained in parallel is identical to
+   * one trained serially.
+   */
+  static bool ParallelTrain(const size_t count);
+
   /**
    * Calculate the class probabilities of the given labels.
    */
@@ -370,6 +417,10 @@ class DecisionTree :
    * avoiding unnecessary copies during training.  This function is called to
    * train children.
    *
+   * If ParallelTrain() is true and this is called inside a parallel region,
+   * the dimensions are evaluated and the children are trained with OpenMP
+   * tasks.
+   *
    * @param data Dataset to train on.
    * @param begin Index of the starting point in the dataset that belongs to
    *      this node.
@@ -378,6 +429,7 @@ class DecisionTree :
    * @param labels Labels for each training point.
    * @param numClasses Number of classes in the dataset.
    * @param minimumLeafSize Minimum number of points in each leaf node.
+   * @param dimensionSelector Dimension selection policy for this node.
    */
   template<bool UseWeights, typename MatType>
   void Train(MatType& data,
@@ -387,13 +439,19 @@ class DecisionTree :
              arma::Row<size_t>& labels,
              const size_t numClasses,
              arma::rowvec& weights,
-             const size_t minimumLeafSize = 10);
+             const size_t minimumLeafSize = 10,
+             DimensionSelectionType dimensionSelector =
+                 DimensionSelectionType());
 
   /**
    * Corresponding to the public Train() method, this method is designed for
    * avoiding unnecessary copies during training.  This method is called for
    * training children.
    *
+   * If ParallelTrain() is true and this is called inside a parallel region,
+   * the dimensions are evaluated and the children are trained with OpenMP
+   * tasks.
+   *
    * @param data Dataset to train on.
    * @param begin Index of the starting point in the dataset that belongs to
    *      this node.
@@ -401,6 +459,7 @@ class DecisionTree :
    * @param labels Labels for each training point.
    * @param numClasses Number of classes in the dataset.
    * @param minimumLeafSize Minimum number of points in each leaf node.
+   * @param dimensionSelector Dimension selection policy for this node.
    */
   template<bool UseWeights, typename MatType>
   void Train(MatType& data,
@@ -409,7 +468,9 @@ class DecisionTree :
              arma::Row<size_t>& labels,
              const size_t numClasses,
              arma::rowvec& weights,
-             const size_t minimumLeafSize = 10);
+             const size_t minimumLeafSize = 10,
+             DimensionSelectionType dimensionSelector =
+                 DimensionSelectionType());
 };
 
 /**
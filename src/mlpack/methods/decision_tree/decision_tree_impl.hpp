@@ -43,6 +43,10 @@ DecisionTree<FitnessFunction,
 
   // Pass off work to the Train() method.
   arma::rowvec weights; // Fake weights, not used.
+  // Large trees are trained by a team of threads that share the work as
+  // tasks.
+  #pragma omp parallel if(ParallelTrain(tmpData.n_cols))
+  #pragma omp single
   Train<false>(tmpData, 0, tmpData.n_cols, datasetInfo, tmpLabels, numClasses,
       weights, minimumLeafSize);
 }
@@ -73,6 +77,10 @@ DecisionTree<FitnessFunction,
 
   // Pass off work to the Train() method.
   arma::rowvec weights; // Fake weights, not used.
+  // Large trees are trained by a team of threads that share the work as
+  // tasks.
+  #pragma omp parallel if(ParallelTrain(tmpData.n_cols))
+  #pragma omp single
   Train<false>(tmpData, 0, tmpData.n_cols, tmpLabels, numClasses, weights,
       minimumLeafSize);
 }
@@ -111,6 +119,10 @@ DecisionTree<FitnessFunction,
   TrueWeightsType tmpWeights(std::forward<WeightsType>(weights));
 
   // Pass off work to the weighted Train() method.
+  // Large trees are trained by a team of threads that share the work as
+  // tasks.
+  #pragma omp parallel if(ParallelTrain(tmpData.n_cols))
+  #pragma omp single
   Train<true>(tmpData, 0, tmpData.n_cols, datasetInfo, tmpLabels, numClasses,
       tmpWeights, minimumLeafSize);
 }
@@ -148,6 +160,10 @@ DecisionTree<FitnessFunction,
   TrueWeightsType tmpWeights(std::forward<WeightsType>(weights));
 
   // Pass off work to the weighted Train() method.
+  // Large trees are trained by a team of threads that share the work as
+  // tasks.
+  #pragma omp parallel if(ParallelTrain(tmpData.n_cols))
+  #pragma omp single
   Train<true>(tmpData, 0, tmpData.n_cols, tmpLabels, numClasses, tmpWeights,
       minimumLeafSize);
 }
@@ -337,7 +353,8 @@ void DecisionTree<FitnessFunction,
                                       const data::DatasetInfo& datasetInfo,
                                       LabelsType&& labels,
                                       const size_t numClasses,
-                                      const size_t minimumLeafSize)
+                                      const size_t minimumLeafSize,
+                                      DimensionSelectionType dimensionSelector)
 {
   // Sanity check on data.
   if (data.n_cols != labels.n_elem)
@@ -358,8 +375,12 @@ void DecisionTree<FitnessFunction,
 
   // Pass off work to the Train() method.
   arma::rowvec weights; // Fake weights, not used.
+  // Large trees are trained by a team of threads that share the work as
+  // tasks.
+  #pragma omp parallel if(ParallelTrain(tmpData.n_cols))
+  #pragma omp single
   Train<false>(tmpData, 0, tmpData.n_cols, datasetInfo, tmpLabels, numClasses,
-      minimumLeafSize);
+      weights, minimumLeafSize, dimensionSelector);
 }
 
 //! Train on the given data, assuming all dimensions are numeric.
@@ -378,7 +399,8 @@ void DecisionTree<FitnessFunction,
                   NoRecursion>::Train(MatType&& data,
                                       LabelsType&& labels,
                                       const size_t numClasses,
-                                      const size_t minimumLeafSize)
+                                      const size_t minimumLeafSize,
+                                      DimensionSelectionType dimensionSelector)
 {
   // Sanity check on data.
   if (data.n_cols != labels.n_elem)
@@ -399,8 +421,12 @@ void DecisionTree<FitnessFunction,
 
   // Pass off work to the Train() method.
   arma::rowvec weights; // Fake weights, not used.
+  // Large trees are trained by a team of threads that share the work as
+  // tasks.
+  #pragma omp parallel if(ParallelTrain(tmpData.n_cols))
+  #pragma omp single
   Train<false>(tmpData, 0, tmpData.n_cols, tmpLabels, numClasses, weights,
-      minimumLeafSize);
+      minimumLeafSize, dimensionSelector);
 }
 
 //! Train on the given weighted data.
@@ -422,6 +448,7 @@ void DecisionTree<FitnessFunction,
                                       const size_t numClasses,
                                       WeightsType&& weights,
                                       const size_t minimumLeafSize,
+                                      DimensionSelectionType dimensionSelector,
                                       const std::enable_if_t<arma::is_arma_type<
                                           typename std::remove_reference<
                                           WeightsType>::type>::value>*)
@@ -446,8 +473,12 @@ void DecisionTree<FitnessFunction,
   TrueWeightsType tmpWeights(std::forward<WeightsType>(weights));
 
   // Pass off work to the Train() method.
+  // Large trees are trained by a team of threads that share the work as
+  // tasks.
+  #pragma omp parallel if(ParallelTrain(tmpData.n_cols))
+  #pragma omp single
   Train<true>(tmpData, 0, tmpData.n_cols, datasetInfo, tmpLabels, numClasses,
-      tmpWeights, minimumLeafSize);
+      tmpWeights, minimumLeafSize, dimensionSelector);
 }
 
 //! Train on the given weighted data.
@@ -468,6 +499,7 @@ void DecisionTree<FitnessFunction,
                                       const size_t numClasses,
                                       WeightsType&& weights,
                                       const size_t minimumLeafSize,
+                                      DimensionSelectionType dimensionSelector,
                                       const std::enable_if_t<arma::is_arma_type<
                                           typename std::remove_reference<
                                           WeightsType>::type>::value>*)
@@ -492,8 +524,12 @@ void DecisionTree<FitnessFunction,
   TrueWeightsType tmpWeights(std::forward<WeightsType>(weights));
 
   // Pass off work to the Train() method.
+  // Large trees are trained by a team of threads that share the work as
+  // tasks.
+  #pragma omp parallel if(ParallelTrain(tmpData.n_cols))
+  #pragma omp single
   Train<true>(tmpData, 0, tmpData.n_cols, tmpLabels, numClasses, tmpWeights,
-      minimumLeafSize);
+      minimumLeafSize, dimensionSelector);
 }
 
 //! Train on the given data.
@@ -516,7 +552,8 @@ void DecisionTree<FitnessFunction,
                                       arma::Row<size_t>& labels,
                                       const size_t numClasses,
                                       arma::rowvec& weights,
-                                      const size_t minimumLeafSize)
+                                      const size_t minimumLeafSize,
+                                      DimensionSelectionType dimensionSelector)
 {
   // Clear children if needed.
   for (size_t i = 0; i < children.size(); ++i)
@@ -533,45 +570,112 @@ void DecisionTree<FitnessFunction,
       numClasses,
       UseWeights ? weights.subvec(begin, begin + count - 1) : weights);
   size_t bestDim = datasetInfo.Dimensionality(); // This means "no split".
-  DimensionSelectionType dimensions(datasetInfo.Dimensionality());
-  for (size_t i = dimensions.Begin(); i != dimensions.End();
-       i = dimensions.Next())
+#ifdef MLPACK_HAS_OPENMP_TASKS
+  if (ParallelTrain(count))
   {
-    double dimGain = -DBL_MAX;
-    if (datasetInfo.Type(i) == data::Datatype::categorical)
-    {
-      dimGain = CategoricalSplit::template SplitIfBetter<UseWeights>(bestGain,
-          data.cols(begin, begin + count - 1).row(i),
-          datasetInfo.NumMappings(i),
-          labels.subvec(begin, begin + count - 1),
-          numClasses,
-          UseWeights ? weights.subvec(begin, begin + count - 1) : weights,
-          minimumLeafSize,
-          classProbabilities,
-          *this);
-    }
-    else if (datasetInfo.Type(i) == data::Datatype::numeric)
+    // Evaluate each dimension on its own task against the gain of the unsplit
+    // node.  A split policy finds the same split in a dimension for any gain
+    // that it improves on, so taking the improvements in order gives the same
+    // split as the serial loop below.
+    const size_t dims = datasetInfo.Dimensionality();
+    std::vector<double> dimGains(dims, -DBL_MAX);
+    std::vector<arma::vec> dimClassProbabilities(dims);
+    std::vector<NumericAuxiliarySplitInfo> numericAux(dims);
+    std::vector<CategoricalAuxiliarySplitInfo> categoricalAux(dims);
+    const double nodeGain = bestGain;
+
+    #pragma omp taskloop grainsize(1) shared(data, datasetInfo, labels, \
+        weights, dimGains, dimClassProbabilities, numericAux, categoricalAux)
+    for (size_t i = 0; i < dims; ++i)
     {
-      dimGain = NumericSplit::template SplitIfBetter<UseWeights>(bestGain,
-          data.cols(begin, begin + count - 1).row(i),
-          labels.subvec(begin, begin + count - 1),
-          numClasses,
-          UseWeights ? weights.subvec(begin, begin + count - 1) : weights,
-          minimumLeafSize,
-          classProbabilities,
-          *this);
+      if (datasetInfo.Type(i) == data::Datatype::categorical)
+      {
+        dimGains[i] = CategoricalSplit::template SplitIfBetter<UseWeights>(
+            nodeGain,
+            data.cols(begin, begin + count - 1).row(i),
+            datasetInfo.NumMappings(i),
+            labels.subvec(begin, begin + count - 1),
+            numClasses,
+            UseWeights ? weights.subvec(begin, begin + count - 1) : weights,
+            minimumLeafSize,
+            dimClassProbabilities[i],
+            categoricalAux[i]);
+      }
+      else if (datasetInfo.Type(i) == data::Datatype::numeric)
+      {
+        dimGains[i] = NumericSplit::template SplitIfBetter<UseWeights>(
+            nodeGain,
+            data.cols(begin, begin + count - 1).row(i),
+            labels.subvec(begin, begin + count - 1),
+            numClasses,
+            UseWeights ? weights.subvec(begin, begin + count - 1) : weights,
+            minimumLeafSize,
+            dimClassProbabilities[i],
+            numericAux[i]);
+      }
     }
 
-    // Was there an improvement?  If so mark that it's the new best dimension.
-    if (dimGain > bestGain)
+    for (size_t i = 0; i < dims; ++i)
     {
-      bestDim = i;
-      bestGain = dimGain;
+      if (dimGains[i] > bestGain)
+      {
+        bestDim = i;
+        bestGain = dimGains[i];
+        classProbabilities = std::move(dimClassProbabilities[i]);
+        if (datasetInfo.Type(i) == data::Datatype::categorical)
+          CategoricalAuxiliarySplitInfo::operator=(categoricalAux[i]);
+        else
+          NumericAuxiliarySplitInfo::operator=(numericAux[i]);
+      }
+
+      // If the gain is the best possible, no need to keep looking.
+      if (bestGain == 0.0)
+        break;
     }
+  }
+  else
+#endif
+  {
+    dimensionSelector.Dimensions(datasetInfo.Dimensionality());
+    for (size_t i = dimensionSelector.Begin(); i != dimensionSelector.End();
+         i = dimensionSelector.Next())
+    {
+      double dimGain = -DBL_MAX;
+      if (datasetInfo.Type(i) == data::Datatype::categorical)
+      {
+        dimGain = CategoricalSplit::template SplitIfBetter<UseWeights>(bestGain,
+            data.cols(begin, begin + count - 1).row(i),
+            datasetInfo.NumMappings(i),
+            labels.subvec(begin, begin + count - 1),
+            numClasses,
+            UseWeights ? weights.subvec(begin, begin + count - 1) : weights,
+            minimumLeafSize,
+            classProbabilities,
+            *this);
+      }
+      else if (datasetInfo.Type(i) == data::Datatype::numeric)
+      {
+        dimGain = NumericSplit::template SplitIfBetter<UseWeights>(bestGain,
+            data.cols(begin, begin + count - 1).row(i),
+            labels.subvec(begin, begin + count - 1),
+            numClasses,
+            UseWeights ? weights.subvec(begin, begin + count - 1) : weights,
+            minimumLeafSize,
+            classProbabilities,
+            *this);
+      }
+
+      // Was there an improvement?  If so mark that it's the new best dimension.
+      if (dimGain > bestGain)
+      {
+        bestDim = i;
+        bestGain = dimGain;
+      }
 
-    // If the gain is the best possible, no need to keep looking.
-    if (bestGain == 0.0)
-      break;
+      // If the gain is the best possible, no need to keep looking.
+      if (bestGain == 0.0)
+        break;
+    }
   }
 
   // Did we split or not?  If so, then split the data and create the children.
@@ -611,10 +715,11 @@ void DecisionTree<FitnessFunction,
 
     // Split into children.
     size_t currentCol = begin;
+    std::vector<size_t> childBegins(numChildren + 1);
     for (size_t i = 0; i < numChildren; ++i)
     {
-      size_t currentChildBegin = currentCol;
-      for (size_t j = currentChildBegin; j < begin + count; ++j)
+      childBegins[i] = currentCol;
+      for (size_t j = childBegins[i]; j < begin + count; ++j)
       {
         if (childAssignments[j - begin] == i)
         {
@@ -627,22 +732,26 @@ void DecisionTree<FitnessFunction,
         }
       }
 
-      // Now build the child recursively.
-      DecisionTree* child = new DecisionTree();
-      if (NoRecursion)
-      {
-        child->Train<UseWeights>(data, currentChildBegin,
-            currentCol - currentChildBegin, datasetInfo, labels, numClasses,
-            weights, currentCol - currentChildBegin);
-      }
-      else
-      {
-        child->Train<UseWeights>(data, currentChildBegin,
-            currentCol - currentChildBegin, datasetInfo, labels, numClasses,
-            weights, minimumLeafSize);
-      }
-      children.push_back(child);
+      children.push_back(new DecisionTree());
+    }
+    childBegins[numChildren] = currentCol;
+
+    // Now build the children recursively.  Each child holds its own range of
+    // the points, so the children of large nodes are trained as separate tasks.
+    for (size_t i = 0; i < numChildren; ++i)
+    {
+      const size_t childCount = childBegins[i + 1] - childBegins[i];
+#ifdef MLPACK_HAS_OPENMP_TASKS
+      #pragma omp task if(ParallelTrain(childCount)) shared(data, datasetInfo, \
+          labels, weights)
+#endif
+      children[i]->Train<UseWeights>(data, childBegins[i], childCount,
+          datasetInfo, labels, numClasses, weights,
+          NoRecursion ? childCount : minimumLeafSize, dimensionSelector);
     }
+#ifdef MLPACK_HAS_OPENMP_TASKS
+    #pragma omp taskwait
+#endif
   }
   else
   {
@@ -677,7 +786,8 @@ void DecisionTree<FitnessFunction,
                                       arma::Row<size_t>& labels,
                                       const size_t numClasses,
                                       arma::rowvec& weights,
-                                      const size_t minimumLeafSize)
+                                      const size_t minimumLeafSize,
+                                      DimensionSelectionType dimensionSelector)
 {
   // Clear children if needed.
   for (size_t i = 0; i < children.size(); ++i)
@@ -697,29 +807,77 @@ void DecisionTree<FitnessFunction,
       numClasses,
       UseWeights ? weights.subvec(begin, begin + count - 1) : weights);
   size_t bestDim = data.n_rows; // This means "no split".
-  for (size_t i = 0; i < data.n_rows; ++i)
+#ifdef MLPACK_HAS_OPENMP_TASKS
+  if (ParallelTrain(count))
   {
-    const double dimGain = NumericSplitType<FitnessFunction>::template
-        SplitIfBetter<UseWeights>(bestGain,
-                                  data.cols(begin, begin + count - 1).row(i),
-                                  labels.cols(begin, begin + count - 1),
-                                  numClasses,
-                                  UseWeights ?
-                                      weights.cols(begin, begin + count - 1) :
-                                      weights,
-                                  minimumLeafSize,
-                                  classProbabilities,
-                                  *this);
-
-    if (dimGain > bestGain)
+    // Evaluate each dimension on its own task against the gain of the unsplit
+    // node, and take the improvements in order; see the other Train() overload.
+    std::vector<double> dimGains(data.n_rows);
+    std::vector<arma::vec> dimClassProbabilities(data.n_rows);
+    std::vector<NumericAuxiliarySplitInfo> numericAux(data.n_rows);
+    const double nodeGain = bestGain;
+
+    #pragma omp taskloop grainsize(1) shared(data, labels, weights, dimGains, \
+        dimClassProbabilities, numericAux)
+    for (size_t i = 0; i < data.n_rows; ++i)
     {
-      bestDim = i;
-      bestGain = dimGain;
+      dimGains[i] = NumericSplitType<FitnessFunction>::template
+          SplitIfBetter<UseWeights>(nodeGain,
+                                    data.cols(begin, begin + count - 1).row(i),
+                                    labels.cols(begin, begin + count - 1),
+                                    numClasses,
+                                    UseWeights ?
+                                        weights.cols(begin, begin + count - 1) :
+                                        weights,
+                                    minimumLeafSize,
+                                    dimClassProbabilities[i],
+                                    numericAux[i]);
+    }
+
+    for (size_t i = 0; i < data.n_rows; ++i)
+    {
+      if (dimGains[i] > bestGain)
+      {
+        bestDim = i;
+        bestGain = dimGains[i];
+        classProbabilities = std::move(dimClassProbabilities[i]);
+        NumericAuxiliarySplitInfo::operator=(numericAux[i]);
+      }
+
+      // If the gain is the best possible, no need to keep looking.
+      if (bestGain == 0.0)
+        break;
     }
+  }
+  else
+#endif
+  {
+    dimensionSelector.Dimensions(data.n_rows);
+    for (size_t i = dimensionSelector.Begin(); i != dimensionSelector.End();
+         i = dimensionSelector.Next())
+    {
+      const double dimGain = NumericSplitType<FitnessFunction>::template
+          SplitIfBetter<UseWeights>(bestGain,
+                                    data.cols(begin, begin + count - 1).row(i),
+                                    labels.cols(begin, begin + count - 1),
+                                    numClasses,
+                                    UseWeights ?
+                                        weights.cols(begin, begin + count - 1) :
+                                        weights,
+                                    minimumLeafSize,
+                                    classProbabilities,
+                                    *this);
+
+      if (dimGain > bestGain)
+      {
+        bestDim = i;
+        bestGain = dimGain;
+      }
 
-    // If the gain is the best possible, no need to keep looking.
-    if (bestGain == 0.0)
-      break;
+      // If the gain is the best possible, no need to keep looking.
+      if (bestGain == 0.0)
+        break;
+    }
   }
 
   // Did we split or not?  If so, then split the data and create the children.
@@ -746,10 +904,11 @@ void DecisionTree<FitnessFunction,
       childCounts[childAssignments[j - begin]]++;
 
     size_t currentCol = begin;
+    std::vector<size_t> childBegins(numChildren + 1);
     for (size_t i = 0; i < numChildren; ++i)
     {
-      size_t currentChildBegin = currentCol;
-      for (size_t j = currentChildBegin; j < begin + count; ++j)
+      childBegins[i] = currentCol;
+      for (size_t j = childBegins[i]; j < begin + count; ++j)
       {
         if (childAssignments[j - begin] == i)
         {
@@ -762,22 +921,26 @@ void DecisionTree<FitnessFunction,
         }
       }
 
-      // Now build the child recursively.
-      DecisionTree* child = new DecisionTree();
-      if (NoRecursion)
-      {
-        child->Train<UseWeights>(data, currentChildBegin,
-            currentCol - currentChildBegin, labels, numClasses, weights,
-            currentCol - currentChildBegin);
-      }
-      else
-      {
-        child->Train<UseWeights>(data, currentChildBegin,
-            currentCol - currentChildBegin, labels, numClasses, weights,
-            minimumLeafSize);
-      }
-      children.push_back(child);
+      children.push_back(new DecisionTree());
+    }
+    childBegins[numChildren] = currentCol;
+
+    // Now build the children recursively.  Each child holds its own range of
+    // the points, so the children of large nodes are trained as separate tasks.
+    for (size_t i = 0; i < numChildren; ++i)
+    {
+      const size_t childCount = childBegins[i + 1] - childBegins[i];
+#ifdef MLPACK_HAS_OPENMP_TASKS
+      #pragma omp task if(ParallelTrain(childCount)) shared(data, labels, \
+          weights)
+#endif
+      children[i]->Train<UseWeights>(data, childBegins[i], childCount,
+          labels, numClasses, weights,
+          NoRecursion ? childCount : minimumLeafSize, dimensionSelector);
     }
+#ifdef MLPACK_HAS_OPENMP_TASKS
+    #pragma omp taskwait
+#endif
   }
   else
   {
@@ -983,6 +1146,50 @@ size_t DecisionTree<FitnessFunction,
         classProbabilities, *this);
 }
 
+template<typename FitnessFunction,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType,
+         typename DimensionSelectionType,
+         typename ElemType,
+         bool NoRecursion>
+bool DecisionTree<FitnessFunction,
+                  NumericSplitType,
+                  CategoricalSplitType,
+                  DimensionSelectionType,
+                  ElemType,
+                  NoRecursion>::SplitPoints(
+    arma::Col<ElemType>& splitPoints) const
+{
+  if ((data::Datatype) dimensionTypeOrMajorityClass ==
+      data::Datatype::categorical)
+    return CategoricalSplit::SplitPoints(classProbabilities, *this,
+        splitPoints);
+  else
+    return NumericSplit::SplitPoints(classProbabilities, *this, splitPoints);
+}
+
+template<typename FitnessFunction,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType,
+         typename DimensionSelectionType,
+         typename ElemType,
+         bool NoRecursion>
+inline bool DecisionTree<FitnessFunction,
+                         NumericSplitType,
+                         CategoricalSplitType,
+                         DimensionSelectionType,
+                         ElemType,
+                         NoRecursion>::ParallelTrain(const size_t count)
+{
+#ifdef MLPACK_HAS_OPENMP_TASKS
+  return std::is_same<DimensionSelectionType, AllDimensionSelect>::value &&
+      (count >= ParallelTrainThreshold);
+#else
+  (void) count;
+  return false;
+#endif
+}
+
 template<typename FitnessFunction,
          template<typename> class NumericSplitType,
          template<typename> class CategoricalSplitType,
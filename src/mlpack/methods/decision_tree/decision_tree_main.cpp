@@ -42,7 +42,13 @@ PROGRAM_INFO("Decision tree",
     "for each test point may be stored into the file specified by the "
     "--predictions_file (-p) option.  Class probabilities for each prediction "
     "will be stored in the file specified by the --probabilities_file (-P) "
-    "option.");
+    "option."
+    "\n\n"
+    "To find the split of each node, the values of each dimension are put into "
+    "a histogram of at most 256 bins, and only splits between bins are "
+    "considered; this is much faster than trying every split on large "
+    "datasets.  If a node has at most 256 distinct values in a dimension, each "
+    "value has its own bin and the best split is found exactly.");
 
 // Datasets.
 PARAM_MATRIX_IN("training", "Matrix of training points.", "t");
@@ -64,14 +70,19 @@ PARAM_UROW_OUT("predictions", "Class predictions for each test point.", "p");
 
 /**
  * This is the class that we will serialize.  It is a pretty simple wrapper
- * around DecisionTree<>.  In order to support categoricals, it will need to
- * also hold and serialize a DatasetInfo.
+ * around DecisionTree, using histogram-based numeric splits.  (The split type
+ * does not change the serialized tree, so models saved with the default
+ * BestBinaryNumericSplit can still be loaded.)  In order to support
+ * categoricals, it will need to also hold and serialize a DatasetInfo.
  */
 class DecisionTreeModel
 {
  public:
+  //! The type of the tree.
+  typedef DecisionTree<GiniGain, HistogramNumericSplit> TreeType;
+
   // The tree itself, left public for direct access by this program.
-  DecisionTree<> tree;
+  TreeType tree;
 
   // Create the model.
   DecisionTreeModel() { /* Nothing to do. */ }
@@ -155,12 +166,13 @@ int main(int argc, char** argv)
     {
       arma::Row<double> weights =
           std::move(CLI::GetParam<arma::Mat<double>>("weights"));
-      model.tree = DecisionTree<>(dataset, labels, numClasses,
+      model.tree = DecisionTreeModel::TreeType(dataset, labels, numClasses,
           weights, minLeafSize);
     }
     else
     {
-      model.tree = DecisionTree<>(dataset, labels, numClasses, minLeafSize);
+      model.tree = DecisionTreeModel::TreeType(dataset, labels, numClasses,
+          minLeafSize);
     }
 
     // Do we need to print training error?
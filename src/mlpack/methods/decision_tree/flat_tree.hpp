@@ -0,0 +1,180 @@
+/**
+ * @file flat_tree.hpp
+ *
+ * A trained decision tree stored as a flat table of nodes, for fast
+ * classification.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_DECISION_TREE_FLAT_TREE_HPP
+#define MLPACK_METHODS_DECISION_TREE_FLAT_TREE_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/util/sfinae_utility.hpp>
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * FlatTree holds a copy of a trained DecisionTree or HoeffdingTree as a table
+ * of nodes in breadth-first order, with one array for each field of the nodes
+ * (split dimension, threshold, children, leaf class), instead of a tree of
+ * nodes linked by pointers.  The children of each node are consecutive in the
+ * table.  Binary numeric splits are taken with a comparison and a conditional
+ * move; leaves point to themselves, so a point that has reached a leaf stays
+ * there.  That way, the batch Classify() can move a block of points down the
+ * tree in lockstep, one level at a time, without branching on where each
+ * point is.  The FlatTree classifies points exactly as the tree it was built
+ * from, and it is not changed if that tree is trained again.
+ *
+ * @code
+ * DecisionTree<> tree(data, labels, numClasses);
+ * FlatTree<> flatTree(tree);
+ * flatTree.Classify(testData, predictions);
+ * @endcode
+ *
+ * The tree must provide NumChildren(), Child(), SplitDimension(), and
+ * SplitPoints(), where SplitPoints() gives the split of a node as a list of
+ * split points: a point goes to the child whose index is the number of split
+ * points less than its value, or, if SplitPoints() returns false, to the child
+ * whose index is its (categorical) value.  The class predictions and
+ * probabilities of the leaves are those of the tree: for a DecisionTree, the
+ * probability of each class, and for a HoeffdingTree, the probability of the
+ * majority class.
+ *
+ * @tparam ElemType Type of the elements of the data (floating-point).
+ */
+template<typename ElemType = double>
+class FlatTree
+{
+ public:
+  //! The number of points that move down the tree in lockstep in the batch
+  //! Classify().
+  static const size_t BlockSize = 64;
+
+  /**
+   * Construct an empty FlatTree, which classifies every point as class 0.
+   */
+  FlatTree();
+
+  /**
+   * Build the FlatTree from the given trained tree.
+   *
+   * @param tree Tree to copy.
+   */
+  template<typename TreeType>
+  explicit FlatTree(const TreeType& tree);
+
+  /**
+   * Classify the given point.  The predicted label is returned.
+   *
+   * @param point Point to classify.
+   */
+  template<typename VecType>
+  size_t Classify(const VecType& point) const;
+
+  /**
+   * Classify the given point and also return the probabilities of its leaf.
+   *
+   * @param point Point to classify.
+   * @param prediction This will be set to the predicted class of the point.
+   * @param probabilities This will be filled with the probabilities of the
+   *      leaf the point falls into.
+   */
+  template<typename VecType>
+  void Classify(const VecType& point,
+                size_t& prediction,
+                arma::vec& probabilities) const;
+
+  /**
+   * Classify the given points, block by block, in parallel with OpenMP.
+   *
+   * @param data Set of points to classify.
+   * @param predictions This will be filled with predictions for each point.
+   */
+  template<typename MatType>
+  void Classify(const MatType& data, arma::Row<size_t>& predictions) const;
+
+  /**
+   * Classify the given points and also return the probabilities of their
+   * leaves, one column per point.
+   *
+   * @param data Set of points to classify.
+   * @param predictions This will be filled with predictions for each point.
+   * @param probabilities This will be filled with the probabilities of the
+   *      leaf of each point.
+   */
+  template<typename MatType>
+  void Classify(const MatType& data,
+                arma::Row<size_t>& predictions,
+                arma::mat& probabilities) const;
+
+  //! Get the number of nodes.
+  size_t NumNodes() const { return dimensions.n_elem; }
+  //! Get the depth of the tree (0 if the root is a leaf).
+  size_t Depth() const { return depth; }
+
+  /**
+   * Serialize the FlatTree.
+   */
+  template<typename Archive>
+  void Serialize(Archive& ar, const unsigned int /* version */);
+
+ private:
+  //! The kinds of split of each node; leaves are binary splits whose children
+  //! are the leaf itself.
+  enum SplitType
+  {
+    BinarySplit = 0,
+    CategoricalSplit = 1,
+    MultipleSplit = 2
+  };
+
+  //! The kind of split of each node.
+  arma::Col<size_t> types;
+  //! The dimension each node splits on (0 for leaves).
+  arma::Col<size_t> dimensions;
+  //! The split point of each binary split; points with values less than or
+  //! equal to it go left.  Leaves hold 0, since both children are the leaf.
+  arma::Col<ElemType> thresholds;
+  //! The first child of each node (the left child of binary splits), or the
+  //! node itself for leaves.
+  arma::Col<size_t> lefts;
+  //! The right child of each binary split, or the node itself for leaves.
+  arma::Col<size_t> rights;
+  //! The beginning of the split points of each multiple split in splitPoints.
+  arma::Col<size_t> splitPointBegins;
+  //! The end of the split points of each multiple split in splitPoints.
+  arma::Col<size_t> splitPointEnds;
+  //! The split points of all the multiple splits.
+  arma::Col<ElemType> splitPoints;
+  //! The predicted class of each leaf (0 for other nodes).
+  arma::Row<size_t> classes;
+  //! The probabilities of each leaf, one column per node.
+  arma::mat probabilities;
+  //! The number of levels below the root.
+  size_t depth;
+
+  /**
+   * Get the node that a point goes to after the given node, given its value in
+   * the split dimension of the node.  Leaves return themselves.
+   */
+  size_t Next(const size_t node, const ElemType value) const;
+
+  /**
+   * Find the leaf of each point of the dataset.
+   */
+  template<typename MatType>
+  void Leaves(const MatType& data, arma::Row<size_t>& leaves) const;
+};
+
+} // namespace tree
+} // namespace mlpack
+
+// Include implementation.
+#include "flat_tree_impl.hpp"
+
+#endif
@@ -0,0 +1,294 @@
+/**
+ * @file flat_tree_impl.hpp
+ *
+ * Implementation of FlatTree, a trained decision tree stored as a flat table
+ * of nodes.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_DECISION_TREE_FLAT_TREE_IMPL_HPP
+#define MLPACK_METHODS_DECISION_TREE_FLAT_TREE_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "flat_tree.hpp"
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * This gives us a HasMajorityProbabilityCheck object that we can use to tell
+ * whether or not a tree has a MajorityProbability() function, like
+ * HoeffdingTree.
+ */
+HAS_MEM_FUNC(MajorityProbability, HasMajorityProbabilityCheck);
+
+//! Get the prediction and probabilities of a leaf of a tree that only knows
+//! the probability of its majority class.
+template<typename TreeType>
+void FlatTreeLeaf(
+    const TreeType& leaf,
+    size_t& prediction,
+    arma::vec& probabilities,
+    const typename std::enable_if_t<HasMajorityProbabilityCheck<TreeType,
+        double(TreeType::*)() const>::value>* = 0)
+{
+  prediction = leaf.MajorityClass();
+  probabilities.set_size(1);
+  probabilities[0] = leaf.MajorityProbability();
+}
+
+//! Get the prediction and class probabilities of a leaf of a tree; the point
+//! to classify is not used since the node is a leaf.
+template<typename TreeType>
+void FlatTreeLeaf(
+    const TreeType& leaf,
+    size_t& prediction,
+    arma::vec& probabilities,
+    const typename std::enable_if_t<!HasMajorityProbabilityCheck<TreeType,
+        double(TreeType::*)() const>::value>* = 0)
+{
+  leaf.Classify(arma::vec(), prediction, probabilities);
+}
+
+template<typename ElemType>
+FlatTree<ElemType>::FlatTree() :
+    types(1, arma::fill::zeros),
+    dimensions(1, arma::fill::zeros),
+    thresholds(1, arma::fill::zeros),
+    lefts(1, arma::fill::zeros),
+    rights(1, arma::fill::zeros),
+    splitPointBegins(1, arma::fill::zeros),
+    splitPointEnds(1, arma::fill::zeros),
+    classes(1, arma::fill::zeros),
+    probabilities(1, 1, arma::fill::ones),
+    depth(0)
+{
+  // Nothing to do.
+}
+
+template<typename ElemType>
+template<typename TreeType>
+FlatTree<ElemType>::FlatTree(const TreeType& tree) :
+    depth(0)
+{
+  // Collect the nodes in breadth-first order, so that the children of each
+  // node are consecutive.  The last node is then one of the deepest.
+  std::vector<const TreeType*> nodes(1, &tree);
+  std::vector<size_t> levels(1, 0);
+  for (size_t i = 0; i < nodes.size(); ++i)
+  {
+    for (size_t j = 0; j < nodes[i]->NumChildren(); ++j)
+    {
+      nodes.push_back(&nodes[i]->Child(j));
+      levels.push_back(levels[i] + 1);
+    }
+  }
+  depth = levels.back();
+
+  const size_t numNodes = nodes.size();
+  types.zeros(numNodes);
+  dimensions.zeros(numNodes);
+  thresholds.zeros(numNodes);
+  lefts.set_size(numNodes);
+  rights.set_size(numNodes);
+  splitPointBegins.zeros(numNodes);
+  splitPointEnds.zeros(numNodes);
+  classes.zeros(numNodes);
+
+  std::vector<ElemType> allSplitPoints;
+  std::vector<arma::vec> leafProbabilities(numNodes);
+  size_t numProbabilities = 0;
+  size_t firstChild = 1;
+  arma::Col<ElemType> nodeSplitPoints;
+  for (size_t i = 0; i < numNodes; ++i)
+  {
+    const TreeType& node = *nodes[i];
+    if (node.NumChildren() == 0)
+    {
+      // Leaves are binary splits whose children are the leaf itself.
+      lefts[i] = i;
+      rights[i] = i;
+      FlatTreeLeaf(node, classes[i], leafProbabilities[i]);
+      numProbabilities = std::max(numProbabilities,
+          (size_t) leafProbabilities[i].n_elem);
+      continue;
+    }
+
+    dimensions[i] = node.SplitDimension();
+    lefts[i] = firstChild;
+    rights[i] = firstChild;
+    if (!node.SplitPoints(nodeSplitPoints))
+    {
+      types[i] = CategoricalSplit;
+    }
+    else if (nodeSplitPoints.n_elem == 1 && node.NumChildren() == 2)
+    {
+      types[i] = BinarySplit;
+      thresholds[i] = nodeSplitPoints[0];
+      rights[i] = firstChild + 1;
+    }
+    else
+    {
+      types[i] = MultipleSplit;
+      splitPointBegins[i] = allSplitPoints.size();
+      allSplitPoints.insert(allSplitPoints.end(), nodeSplitPoints.begin(),
+          nodeSplitPoints.end());
+      splitPointEnds[i] = allSplitPoints.size();
+    }
+
+    firstChild += node.NumChildren();
+  }
+
+  splitPoints = arma::Col<ElemType>(allSplitPoints);
+  probabilities.zeros(numProbabilities, numNodes);
+  for (size_t i = 0; i < numNodes; ++i)
+  {
+    if (leafProbabilities[i].n_elem == numProbabilities)
+      probabilities.col(i) = leafProbabilities[i];
+  }
+}
+
+template<typename ElemType>
+template<typename VecType>
+size_t FlatTree<ElemType>::Classify(const VecType& point) const
+{
+  size_t node = 0;
+  while (lefts[node] != node)
+    node = Next(node, point[dimensions[node]]);
+
+  return classes[node];
+}
+
+template<typename ElemType>
+template<typename VecType>
+void FlatTree<ElemType>::Classify(const VecType& point,
+                                  size_t& prediction,
+                                  arma::vec& probabilities) const
+{
+  size_t node = 0;
+  while (lefts[node] != node)
+    node = Next(node, point[dimensions[node]]);
+
+  prediction = classes[node];
+  probabilities = this->probabilities.col(node);
+}
+
+template<typename ElemType>
+template<typename MatType>
+void FlatTree<ElemType>::Classify(const MatType& data,
+                                  arma::Row<size_t>& predictions) const
+{
+  arma::Row<size_t> leaves;
+  Leaves(data, leaves);
+
+  predictions.set_size(data.n_cols);
+  for (size_t i = 0; i < data.n_cols; ++i)
+    predictions[i] = classes[leaves[i]];
+}
+
+template<typename ElemType>
+template<typename MatType>
+void FlatTree<ElemType>::Classify(const MatType& data,
+                                  arma::Row<size_t>& predictions,
+                                  arma::mat& probabilities) const
+{
+  arma::Row<size_t> leaves;
+  Leaves(data, leaves);
+
+  predictions.set_size(data.n_cols);
+  probabilities.set_size(this->probabilities.n_rows, data.n_cols);
+  for (size_t i = 0; i < data.n_cols; ++i)
+  {
+    predictions[i] = classes[leaves[i]];
+    probabilities.col(i) = this->probabilities.col(leaves[i]);
+  }
+}
+
+template<typename ElemType>
+template<typename Archive>
+void FlatTree<ElemType>::Serialize(Archive& ar,
+                                   const unsigned int /* version */)
+{
+  using data::CreateNVP;
+
+  ar & CreateNVP(types, "types");
+  ar & CreateNVP(dimensions, "dimensions");
+  ar & CreateNVP(thresholds, "thresholds");
+  ar & CreateNVP(lefts, "lefts");
+  ar & CreateNVP(rights, "rights");
+  ar & CreateNVP(splitPointBegins, "splitPointBegins");
+  ar & CreateNVP(splitPointEnds, "splitPointEnds");
+  ar & CreateNVP(splitPoints, "splitPoints");
+  ar & CreateNVP(classes, "classes");
+  ar & CreateNVP(probabilities, "probabilities");
+  ar & CreateNVP(depth, "depth");
+}
+
+template<typename ElemType>
+inline size_t FlatTree<ElemType>::Next(const size_t node,
+                                       const ElemType value) const
+{
+  // This is the case for numeric trees, and for leaves; the comparison usually
+  // compiles to a conditional move.
+  if (types[node] == BinarySplit)
+    return (value <= thresholds[node]) ? lefts[node] : rights[node];
+
+  if (types[node] == CategoricalSplit)
+    return lefts[node] + (size_t) value;
+
+  // Count the split points less than the value.
+  size_t child = lefts[node];
+  for (size_t j = splitPointBegins[node]; j < splitPointEnds[node]; ++j)
+    child += (splitPoints[j] < value) ? 1 : 0;
+
+  return child;
+}
+
+template<typename ElemType>
+template<typename MatType>
+void FlatTree<ElemType>::Leaves(const MatType& data,
+                                arma::Row<size_t>& leaves) const
+{
+  leaves.zeros(data.n_cols);
+  const size_t numBlocks = (data.n_cols + BlockSize - 1) / BlockSize;
+
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables. If we're building for Visual Studio, use
+  // the intmax_t type instead.
+  #pragma omp parallel for
+  for (intmax_t block = 0; block < (intmax_t) numBlocks; ++block)
+#else
+  #pragma omp parallel for
+  for (size_t block = 0; block < numBlocks; ++block)
+#endif
+  {
+    const size_t begin = block * BlockSize;
+    const size_t end = std::min(begin + BlockSize, (size_t) data.n_cols);
+
+    // Move every point of the block down one level at a time.  Points in
+    // leaves stay where they are, so we can stop once no point moves.
+    for (size_t level = 0; level < depth; ++level)
+    {
+      bool moved = false;
+      for (size_t i = begin; i < end; ++i)
+      {
+        const size_t node = leaves[i];
+        const size_t next = Next(node, data(dimensions[node], i));
+        moved |= (next != node);
+        leaves[i] = next;
+      }
+
+      if (!moved)
+        break;
+    }
+  }
+}
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
@@ -86,6 +86,30 @@ class GiniGain
     return -impurity;
   }
 
+  /**
+   * Evaluate the Gini impurity of a set of points, given the (possibly
+   * weighted) number of points of each class.  This is only needed by
+   * HistogramNumericSplit.
+   *
+   * @param counts Number of points of each class.
+   * @param total Sum of counts.
+   */
+  static double EvaluateCounts(const arma::vec& counts, const double total)
+  {
+    // Corner case: if there are no points, the impurity is zero.
+    if (total == 0.0)
+      return 0.0;
+
+    double impurity = 0.0;
+    for (size_t i = 0; i < counts.n_elem; ++i)
+    {
+      const double f = counts[i] / total;
+      impurity += f * (1.0 - f);
+    }
+
+    return -impurity;
+  }
+
   /**
    * Return the range of the Gini impurity for the given number of classes.
    * (That is, the difference between the maximum possible value and the minimum
@@ -0,0 +1,153 @@
+/**
+ * @file histogram_numeric_split.hpp
+ *
+ * A tree splitter that finds the best binary numeric split from a histogram of
+ * the values, instead of sorting them.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_DECISION_TREE_HISTOGRAM_NUMERIC_SPLIT_HPP
+#define MLPACK_METHODS_DECISION_TREE_HISTOGRAM_NUMERIC_SPLIT_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * The HistogramNumericSplit is a splitting function for decision trees that
+ * searches a numeric dimension for the best binary split between the bins of a
+ * histogram of the values, in the style of LightGBM.  The values are put into
+ * at most MaxBins bins, whose boundaries are quantiles of a sample of at most
+ * SampleSize values, and the (possibly weighted) number of points of each class
+ * in each bin is counted.  The class counts of the left child of each candidate
+ * split are then the running sum of the bins, and those of the right child are
+ * the counts of the node minus those of the left child.
+ *
+ * Finding a split costs time linear in the number of points (plus the cost of
+ * sorting the sample and of a scan over the bins), instead of the sort of all
+ * the points and the copies of their labels in BestBinaryNumericSplit.  If the
+ * sample holds all the values of the node and there are at most MaxBins
+ * distinct values, each value has its own bin, and the split is exactly the
+ * one BestBinaryNumericSplit finds.
+ *
+ * The fitness function must provide, in addition to Evaluate(), the static
+ * function
+ *
+ * @code
+ * // Evaluate the fitness of a set of points with the given (possibly
+ * // weighted) number of points of each class, summing to total.
+ * static double EvaluateCounts(const arma::vec& counts, const double total);
+ * @endcode
+ *
+ * @tparam FitnessFunction Fitness function to use to calculate gain.
+ */
+template<typename FitnessFunction>
+class HistogramNumericSplit
+{
+ public:
+  //! The maximum number of bins of the histogram.
+  static const size_t MaxBins = 256;
+  //! The maximum number of values used to find the boundaries of the bins.
+  static const size_t SampleSize = 16 * MaxBins;
+
+  // No extra info needed for split.
+  template<typename ElemType>
+  class AuxiliarySplitInfo { };
+
+  /**
+   * Check if we can split a node.  If we can split a node in a way that
+   * improves on 'bestGain', then we return the improved gain.  Otherwise we
+   * return the value 'bestGain'.  If a split is made, then classProbabilities
+   * and aux may be modified.
+   *
+   * @param bestGain Best gain seen so far (we'll only split if we find gain
+   *      better than this).
+   * @param data The dimension of data points to check for a split in.
+   * @param labels Labels for each point.
+   * @param numClasses Number of classes in the dataset.
+   * @param weights Weights of each point (ignored if UseWeights is false).
+   * @param minimumLeafSize Minimum number of points in a leaf node for
+   *      splitting.
+   * @param classProbabilities Class probabilities vector, which may be filled
+   *      with split information a successful split.
+   * @param aux Auxiliary split information, which may be modified on a
+   *      successful split.
+   */
+  template<bool UseWeights, typename VecType, typename WeightVecType>
+  static double SplitIfBetter(
+      const double bestGain,
+      const VecType& data,
+      const arma::Row<size_t>& labels,
+      const size_t numClasses,
+      const WeightVecType& weights,
+      const size_t minimumLeafSize,
+      arma::Col<typename VecType::elem_type>& classProbabilities,
+      AuxiliarySplitInfo<typename VecType::elem_type>& aux);
+
+  /**
+   * Returns 2, since the binary split always has two children.
+   */
+  template<typename ElemType>
+  static size_t NumChildren(const arma::Col<ElemType>& /* classProbabilities */,
+                            const AuxiliarySplitInfo<ElemType>& /* aux */)
+  {
+    return 2;
+  }
+
+  /**
+   * Given a point, calculate which child it should go to (left or right).
+   *
+   * @param point Point to calculate direction of.
+   * @param classProbabilities Auxiliary information for the split.
+   * @param aux (Unused) auxiliary information for the split.
+   */
+  template<typename ElemType>
+  static size_t CalculateDirection(
+      const ElemType& point,
+      const arma::Col<ElemType>& classProbabilities,
+      const AuxiliarySplitInfo<ElemType>& /* aux */);
+
+  /**
+   * Get the split as a list of split points, for FlatTree: a point goes to the
+   * child whose index is the number of split points less than its value.  For
+   * this split, that is the one split point.
+   *
+   * @param classProbabilities Auxiliary information for the split.
+   * @param aux (Unused) auxiliary information for the split.
+   * @param splitPoints This will be filled with the split points.
+   * @return true, since the split is described by its split points.
+   */
+  template<typename ElemType>
+  static bool SplitPoints(const arma::Col<ElemType>& classProbabilities,
+                          const AuxiliarySplitInfo<ElemType>& /* aux */,
+                          arma::Col<ElemType>& splitPoints)
+  {
+    splitPoints = classProbabilities.subvec(0, 0);
+    return true;
+  }
+
+ private:
+  /**
+   * Compute the upper boundaries of the bins of the histogram of the given
+   * values: bin i holds the values in (boundaries[i - 1], boundaries[i]], and
+   * the last bin also holds every larger value.
+   *
+   * @param data Values to compute the bins of.
+   * @param boundaries Vector to store the sorted boundaries in.
+   */
+  template<typename VecType>
+  static void Boundaries(const VecType& data,
+                         std::vector<typename VecType::elem_type>& boundaries);
+};
+
+} // namespace tree
+} // namespace mlpack
+
+// Include implementation.
+#include "histogram_numeric_split_impl.hpp"
+
+#endif
@@ -0,0 +1,165 @@
+/**
+ * @file histogram_numeric_split_impl.hpp
+ *
+ * Implementation of strategy that finds the best binary numeric split from a
+ * histogram of the values.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_DECISION_TREE_HISTOGRAM_NUMERIC_SPLIT_IMPL_HPP
+#define MLPACK_METHODS_DECISION_TREE_HISTOGRAM_NUMERIC_SPLIT_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "histogram_numeric_split.hpp"
+
+namespace mlpack {
+namespace tree {
+
+template<typename FitnessFunction>
+template<bool UseWeights, typename VecType, typename WeightVecType>
+double HistogramNumericSplit<FitnessFunction>::SplitIfBetter(
+    const double bestGain,
+    const VecType& data,
+    const arma::Row<size_t>& labels,
+    const size_t numClasses,
+    const WeightVecType& weights,
+    const size_t minimumLeafSize,
+    arma::Col<typename VecType::elem_type>& classProbabilities,
+    AuxiliarySplitInfo<typename VecType::elem_type>& /* aux */)
+{
+  typedef typename VecType::elem_type ElemType;
+
+  // First sanity check: if we don't have enough points, we can't split.
+  if (data.n_elem < (minimumLeafSize * 2) || data.n_elem < 2)
+    return bestGain;
+
+  std::vector<ElemType> boundaries;
+  Boundaries(data, boundaries);
+  const size_t numBins = boundaries.size();
+
+  // Count the points of each class in each bin, and keep the extent of the
+  // values in each bin, so that the split point can be put between them.
+  arma::mat binCounts(numClasses, numBins, arma::fill::zeros);
+  std::vector<size_t> binSizes(numBins, 0);
+  std::vector<ElemType> binMin(numBins, std::numeric_limits<ElemType>::max());
+  std::vector<ElemType> binMax(numBins,
+      std::numeric_limits<ElemType>::lowest());
+  for (size_t i = 0; i < data.n_elem; ++i)
+  {
+    const ElemType value = data[i];
+    size_t bin = std::lower_bound(boundaries.begin(), boundaries.end(), value) -
+        boundaries.begin();
+    if (bin == numBins)
+      bin = numBins - 1;
+
+    binCounts(labels[i], bin) += UseWeights ? weights[i] : 1.0;
+    ++binSizes[bin];
+    binMin[bin] = std::min(binMin[bin], value);
+    binMax[bin] = std::max(binMax[bin], value);
+  }
+
+  const arma::vec totalCounts = arma::sum(binCounts, 1);
+  const double total = arma::accu(totalCounts);
+  if (total == 0.0)
+    return bestGain;
+
+  // Scan the candidate splits between consecutive non-empty bins.  Also, force
+  // a minimum leaf size of 1 (empty children don't make sense).
+  double bestFoundGain = bestGain;
+  const size_t minimum = std::max(minimumLeafSize, (size_t) 1);
+  arma::vec leftCounts(numClasses, arma::fill::zeros);
+  size_t leftSize = 0;
+  size_t previousBin = 0;
+  for (size_t bin = 0; bin < numBins; ++bin)
+  {
+    if (binSizes[bin] == 0)
+      continue;
+
+    if (leftSize >= minimum && data.n_elem - leftSize >= minimum)
+    {
+      // The right child gets the counts that aren't in the left child.
+      const double leftTotal = arma::accu(leftCounts);
+      const double rightTotal = total - leftTotal;
+      const double leftGain = FitnessFunction::EvaluateCounts(leftCounts,
+          leftTotal);
+      const double rightGain = FitnessFunction::EvaluateCounts(
+          totalCounts - leftCounts, rightTotal);
+      const double gain = (leftTotal / total) * leftGain +
+          (rightTotal / total) * rightGain;
+
+      // Corner case: is this the best possible split?  If so, no split will
+      // be better, so just take this one.  The actual split value is halfway
+      // between the values on either side of it.
+      if (gain == 0.0 || gain > bestFoundGain)
+      {
+        bestFoundGain = gain;
+        classProbabilities.set_size(1);
+        classProbabilities[0] = (binMax[previousBin] + binMin[bin]) / 2.0;
+
+        if (gain == 0.0)
+          return gain;
+      }
+    }
+
+    leftCounts += binCounts.col(bin);
+    leftSize += binSizes[bin];
+    previousBin = bin;
+  }
+
+  return bestFoundGain;
+}
+
+template<typename FitnessFunction>
+template<typename ElemType>
+size_t HistogramNumericSplit<FitnessFunction>::CalculateDirection(
+    const ElemType& point,
+    const arma::Col<ElemType>& classProbabilities,
+    const AuxiliarySplitInfo<ElemType>& /* aux */)
+{
+  if (point <= classProbabilities[0])
+    return 0; // Go left.
+  else
+    return 1; // Go right.
+}
+
+template<typename FitnessFunction>
+template<typename VecType>
+void HistogramNumericSplit<FitnessFunction>::Boundaries(
+    const VecType& data,
+    std::vector<typename VecType::elem_type>& boundaries)
+{
+  typedef typename VecType::elem_type ElemType;
+
+  // Take evenly spaced values as the sample, so that the bins don't depend on
+  // the random seed.
+  const size_t stride = (data.n_elem + SampleSize - 1) / SampleSize;
+  std::vector<ElemType> sample;
+  sample.reserve(data.n_elem / stride + 1);
+  for (size_t i = 0; i < data.n_elem; i += stride)
+    sample.push_back(data[i]);
+  std::sort(sample.begin(), sample.end());
+
+  // If there are few enough distinct values, each gets its own bin.
+  boundaries.assign(sample.begin(), sample.end());
+  boundaries.erase(std::unique(boundaries.begin(), boundaries.end()),
+      boundaries.end());
+  if (boundaries.size() <= MaxBins)
+    return;
+
+  // Otherwise, the boundaries are quantiles of the sample.
+  boundaries.clear();
+  for (size_t i = 1; i <= MaxBins; ++i)
+  {
+    const ElemType boundary = sample[(i * sample.size()) / MaxBins - 1];
+    if (boundaries.empty() || boundary != boundaries.back())
+      boundaries.push_back(boundary);
+  }
+}
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
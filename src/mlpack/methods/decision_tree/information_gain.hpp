@@ -84,6 +84,31 @@ class InformationGain
     return gain;
   }
 
+  /**
+   * Calculate the information gain of a set of points, given the (possibly
+   * weighted) number of points of each class.  This is only needed by
+   * HistogramNumericSplit.
+   *
+   * @param counts Number of points of each class.
+   * @param total Sum of counts.
+   */
+  static double EvaluateCounts(const arma::vec& counts, const double total)
+  {
+    // Corner case: return 0 if there are no points.
+    if (total == 0.0)
+      return 0.0;
+
+    double gain = 0.0;
+    for (size_t i = 0; i < counts.n_elem; ++i)
+    {
+      const double f = counts[i] / total;
+      if (f > 0.0)
+        gain += f * std::log2(f);
+    }
+
+    return gain;
+  }
+
   /**
    * Return the range of the information gain for the given number of classes.
    * (That is, the difference between the maximum possible value and the minimum
@@ -0,0 +1,114 @@
+/**
+ * @file multiple_random_dimension_select.hpp
+ *
+ * Selects a random subset of the dimensions for a split.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_DECISION_TREE_MULTIPLE_RANDOM_DIMENSION_SELECT_HPP
+#define MLPACK_METHODS_DECISION_TREE_MULTIPLE_RANDOM_DIMENSION_SELECT_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/math/random.hpp>
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * This dimension selection policy allows only a random subset of the
+ * dimensions to be selected for splitting at each node, as in random forests
+ * (the random subspace method).  A new subset is drawn every time Begin() is
+ * called.  The random numbers come from math::randGen unless another generator
+ * is given with Generator(); copies of the object share the generator.
+ */
+class MultipleRandomDimensionSelect
+{
+ public:
+  /**
+   * Construct the MultipleRandomDimensionSelect object, which selects the
+   * given number of dimensions at each node.  If numDimensions is 0, the
+   * square root of the number of dimensions (rounded down, and at least 1) is
+   * used.
+   *
+   * @param numDimensions Number of dimensions to select at each node.
+   */
+  MultipleRandomDimensionSelect(const size_t numDimensions = 0) :
+      numDimensions(numDimensions),
+      dimensions(0),
+      i(0),
+      generator(&math::randGen)
+  { }
+
+  /**
+   * Set the number of dimensions to select from.  DecisionTree calls this at
+   * each node before Begin().
+   */
+  void Dimensions(const size_t dimensions) { this->dimensions = dimensions; }
+
+  /**
+   * Set the random number generator used to select the dimensions.  It must
+   * outlive every use of this object and of its copies.
+   */
+  void Generator(std::mt19937& generator) { this->generator = &generator; }
+
+  /**
+   * Draw a new random subset of the dimensions, and get the first dimension
+   * to select from.
+   */
+  size_t Begin()
+  {
+    size_t selected = (numDimensions == 0) ?
+        (size_t) std::sqrt((double) dimensions) : numDimensions;
+    selected = std::min(std::max(selected, (size_t) 1), dimensions);
+
+    // Draw the subset with a partial Fisher-Yates shuffle of all dimensions.
+    std::vector<size_t> all(dimensions);
+    for (size_t j = 0; j < dimensions; ++j)
+      all[j] = j;
+
+    std::uniform_real_distribution<> uniformDist;
+    values.resize(selected);
+    for (size_t j = 0; j < selected; ++j)
+    {
+      const size_t k = j + (size_t) std::floor((double) (dimensions - j) *
+          uniformDist(*generator));
+      std::swap(all[j], all[k]);
+      values[j] = all[j];
+    }
+
+    // The sentinel marks the end of the selected dimensions.
+    values.push_back(End());
+    i = 0;
+    return values[0];
+  }
+
+  /**
+   * Get the last dimension to select from.
+   */
+  size_t End() const { return size_t(-1); }
+
+  /**
+   * Get the next dimension.
+   */
+  size_t Next() { return values[++i]; }
+
+ private:
+  //! The number of dimensions to select at each node (0 means square root).
+  size_t numDimensions;
+  //! The number of dimensions to select from.
+  size_t dimensions;
+  //! The selected dimensions, followed by End().
+  std::vector<size_t> values;
+  //! The index of the current dimension.
+  size_t i;
+  //! The random number generator to select the dimensions with.
+  std::mt19937* generator;
+};
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
@@ -54,6 +54,10 @@ void PrintVariableImportance(const DTree<MatType, TagType>* dtree,
  * of folds.  Optionally, give a filename to print the unpruned tree to.  This
  * initializes a tree on the heap, so you are responsible for deleting it.
  *
+ * The points are sorted in each dimension once, and every tree (including
+ * those of the folds, which are grown in parallel with OpenMP) is grown from
+ * the sorted indices, so the dataset is neither modified nor copied.
+ *
  * @param dataset Dataset for the tree to use.
  * @param folds Number of folds to use for cross-validation.
  * @param useVolumeReg If true, use volume regularization.
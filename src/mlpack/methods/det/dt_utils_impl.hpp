@@ -113,6 +113,11 @@ DTree<MatType, TagType>* Trainer(MatType& dataset,
                                  const size_t minLeafSize,
                                  const std::string unprunedTreeOutput)
 {
+  // Sort the points in each dimension once; all the trees are grown from the
+  // sorted indices, so neither the dataset nor a fold of it is ever copied.
+  arma::Mat<size_t> sortedIndices;
+  DTree<MatType, TagType>::SortIndices(dataset, sortedIndices);
+
   // Initialize the tree.
   DTree<MatType, TagType> dtree(dataset);
 
@@ -121,17 +126,18 @@ DTree<MatType, TagType>* Trainer(MatType& dataset,
   for (size_t i = 0; i < oldFromNew.n_elem; i++)
     oldFromNew[i] = i;
 
-  // Save the dataset since it would be modified while growing the tree.
-  MatType newDataset(dataset);
-
   // Growing the tree
   double oldAlpha = 0.0;
-  double alpha = dtree.Grow(newDataset, oldFromNew, useVolumeReg, maxLeafSize,
-      minLeafSize);
+  double alpha = dtree.Grow(dataset, sortedIndices, oldFromNew, useVolumeReg,
+      maxLeafSize, minLeafSize);
 
   Log::Info << dtree.SubtreeLeaves() << " leaf nodes in the tree using full "
       << "dataset; minimum alpha: " << alpha << "." << std::endl;
 
+  // Keep the unpruned tree, which is pruned with the optimal alpha at the end.
+  DTree<MatType, TagType>* dtreeOpt = new DTree<MatType, TagType>(dtree);
+  const double dtreeOptAlpha = alpha;
+
   // Compute densities for the training points in the full tree, if we were
   // asked for this.
   if (unprunedTreeOutput != "")
@@ -179,7 +185,6 @@ DTree<MatType, TagType>* Trainer(MatType& dataset,
   Log::Info << prunedSequence.size() << " trees in the sequence; maximum alpha:"
       << " " << oldAlpha << "." << std::endl;
 
-  MatType cvData(dataset);
   const size_t testSize = dataset.n_cols / folds;
 
   arma::vec regularizationConstants(prunedSequence.size());
@@ -191,47 +196,49 @@ DTree<MatType, TagType>* Trainer(MatType& dataset,
   // implementation.
 #ifdef _WIN32
   #pragma omp parallel for default(none) \
-      shared(cvData, prunedSequence, regularizationConstants)
+      shared(dataset, sortedIndices, prunedSequence, regularizationConstants)
   for (intmax_t fold = 0; fold < (intmax_t) folds; fold++)
 #else
   #pragma omp parallel for default(none) \
-      shared(cvData, prunedSequence, regularizationConstants)
+      shared(dataset, sortedIndices, prunedSequence, regularizationConstants)
   for (size_t fold = 0; fold < folds; fold++)
 #endif
   {
-    // Break up data into train and test sets.
+    // Break up data into train and test sets: the test set is the points from
+    // start to end - 1, and the training set is all the others.
     const size_t start = fold * testSize;
     const size_t end = std::min((size_t) (fold + 1)
-                                * testSize, (size_t) cvData.n_cols);
+                                * testSize, (size_t) dataset.n_cols);
 
-    MatType test = cvData.cols(start, end - 1);
-    MatType train(cvData.n_rows, cvData.n_cols - test.n_cols);
-
-    if (start == 0 && end < cvData.n_cols)
-    {
-      train.cols(0, train.n_cols - 1) = cvData.cols(end, cvData.n_cols - 1);
-    }
-    else if (start > 0 && end == cvData.n_cols)
-    {
-      train.cols(0, train.n_cols - 1) = cvData.cols(0, start - 1);
-    }
-    else
+    arma::Col<size_t> cvOldFromNew(dataset.n_cols - (end - start));
+    for (size_t i = 0; i < start; ++i)
+      cvOldFromNew[i] = i;
+    for (size_t i = end; i < dataset.n_cols; ++i)
+      cvOldFromNew[start + i - end] = i;
+
+    // The bounding box of the training set is given by the first and the last
+    // training point in the sorted indices of each dimension.
+    typename DTree<MatType, TagType>::StatType maxVals(dataset.n_rows);
+    typename DTree<MatType, TagType>::StatType minVals(dataset.n_rows);
+    for (size_t dim = 0; dim < dataset.n_rows; ++dim)
     {
-      train.cols(0, start - 1) = cvData.cols(0, start - 1);
-      train.cols(start, train.n_cols - 1) = cvData.cols(end, cvData.n_cols - 1);
-    }
+      const size_t* indices = sortedIndices.colptr(dim);
 
-    // Initialize the tree.
-    DTree<MatType, TagType> cvDTree(train);
+      size_t first = 0;
+      while (indices[first] >= start && indices[first] < end)
+        ++first;
+      size_t last = dataset.n_cols - 1;
+      while (indices[last] >= start && indices[last] < end)
+        --last;
 
-    // Getting ready to grow the tree...
-    arma::Col<size_t> cvOldFromNew(train.n_cols);
-    for (size_t i = 0; i < cvOldFromNew.n_elem; i++)
-      cvOldFromNew[i] = i;
+      minVals[dim] = dataset(dim, indices[first]);
+      maxVals[dim] = dataset(dim, indices[last]);
+    }
 
-    // Grow the tree.
-    cvDTree.Grow(train, cvOldFromNew, useVolumeReg, maxLeafSize,
-        minLeafSize);
+    // Initialize and grow the tree.
+    DTree<MatType, TagType> cvDTree(maxVals, minVals, cvOldFromNew.n_elem);
+    cvDTree.Grow(dataset, sortedIndices, cvOldFromNew, useVolumeReg,
+        maxLeafSize, minLeafSize);
 
     // Sequentially prune with all the values of available alphas and adding
     // values for test values.  Don't enter this loop if there are less than two
@@ -243,32 +250,32 @@ DTree<MatType, TagType>* Trainer(MatType& dataset,
     {
       // Compute test values for this state of the tree.
       double cvVal = 0.0;
-      for (size_t j = 0; j < test.n_cols; j++)
+      for (size_t j = start; j < end; j++)
       {
-        arma::vec testPoint = test.unsafe_col(j);
+        arma::vec testPoint = dataset.unsafe_col(j);
         cvVal += cvDTree.ComputeValue(testPoint);
       }
 
       // Update the cv regularization constant.
-      cvRegularizationConstants[i] += 2.0 * cvVal / (double) cvData.n_cols;
+      cvRegularizationConstants[i] += 2.0 * cvVal / (double) dataset.n_cols;
 
       // Determine the new alpha value and prune accordingly.
       double cvOldAlpha = 0.5 * (prunedSequence[i + 1].first
                                  + prunedSequence[i + 2].first);
-      cvDTree.PruneAndUpdate(cvOldAlpha, train.n_cols, useVolumeReg);
+      cvDTree.PruneAndUpdate(cvOldAlpha, cvOldFromNew.n_elem, useVolumeReg);
     }
 
     // Compute test values for this state of the tree.
     double cvVal = 0.0;
-    for (size_t i = 0; i < test.n_cols; ++i)
+    for (size_t i = start; i < end; ++i)
     {
-      typename MatType::vec_type testPoint = test.unsafe_col(i);
+      typename MatType::vec_type testPoint = dataset.unsafe_col(i);
       cvVal += cvDTree.ComputeValue(testPoint);
     }
 
     if (prunedSequence.size() > 2)
       cvRegularizationConstants[prunedSequence.size() - 2] += 2.0 * cvVal
-        / (double) cvData.n_cols;
+        / (double) dataset.n_cols;
 
     #pragma omp critical(DTreeCVUpdate)
     regularizationConstants += cvRegularizationConstants;
@@ -294,29 +301,15 @@ DTree<MatType, TagType>* Trainer(MatType& dataset,
 
   Log::Info << "Optimal alpha: " << optimalAlpha << "." << std::endl;
 
-  // Initialize the tree.
-  DTree<MatType, TagType>* dtreeOpt = new DTree<MatType, TagType>(dataset);
-
-  // Getting ready to grow the tree...
-  for (size_t i = 0; i < oldFromNew.n_elem; i++)
-    oldFromNew[i] = i;
-
-  // Save the dataset since it would be modified while growing the tree.
-  newDataset = dataset;
-
-  // Grow the tree.
+  // Start again from the unpruned tree.
   oldAlpha = -DBL_MAX;
-  alpha = dtreeOpt->Grow(newDataset,
-                         oldFromNew,
-                         useVolumeReg,
-                         maxLeafSize,
-                         minLeafSize);
+  alpha = dtreeOptAlpha;
 
   // Prune with optimal alpha.
   while ((oldAlpha < optimalAlpha) && (dtreeOpt->SubtreeLeaves() > 1))
   {
     oldAlpha = alpha;
-    alpha = dtreeOpt->PruneAndUpdate(oldAlpha, newDataset.n_cols, useVolumeReg);
+    alpha = dtreeOpt->PruneAndUpdate(oldAlpha, dataset.n_cols, useVolumeReg);
 
     // Some sanity checks.
     Log::Assert((alpha < std::numeric_limits<double>::max()) ||
@@ -162,6 +162,52 @@ class DTree
               const size_t maxLeafSize = 10,
               const size_t minLeafSize = 5);
 
+  /**
+   * Greedily expand the tree, like the other overload of Grow(), but without
+   * modifying the dataset and without sorting the points of each node.
+   * Instead, the tree is grown from the given indices of the points of the
+   * dataset sorted in each dimension (see SortIndices()), one level at a time,
+   * with a single scan of the sorted indices of each dimension per level.  Only the points of the dataset whose indices are in
+   * oldFromNew are used, so many trees (for instance, one for each
+   * cross-validation fold) can be grown on subsets of the same dataset at once
+   * with the same sorted indices; besides the tree, growing takes only a few
+   * integers of memory per point of the dataset.  The tree is the same as the
+   * one the other overload of Grow() builds on the same points.
+   *
+   * The bounding box of this node must be that of the given points, and the
+   * node must hold exactly that many points (as with the DTree(maxVals,
+   * minVals, totalPoints) constructor).  On return, oldFromNew is reordered so
+   * that the points of each node are oldFromNew[Start()] to
+   * oldFromNew[End() - 1].
+   *
+   * @param data Dataset to build tree on.
+   * @param sortedIndices Indices of the points of the dataset sorted in each
+   *     dimension, one column per dimension, as given by SortIndices().
+   * @param oldFromNew Indices of the points of the dataset to build the tree
+   *     on; they will be reordered.
+   * @param useVolReg If true, volume regularization is used.
+   * @param maxLeafSize Maximum size of a leaf.
+   * @param minLeafSize Minimum size of a leaf.
+   */
+  double Grow(const MatType& data,
+              const arma::Mat<size_t>& sortedIndices,
+              arma::Col<size_t>& oldFromNew,
+              const bool useVolReg = false,
+              const size_t maxLeafSize = 10,
+              const size_t minLeafSize = 5);
+
+  /**
+   * Sort the indices of the points of the dataset in each dimension, for the
+   * overload of Grow() that takes sorted indices.  The dimensions are sorted in
+   * parallel with OpenMP.
+   *
+   * @param data Dataset to sort.
+   * @param sortedIndices Matrix to store the sorted indices in, one column per
+   *     dimension.
+   */
+  static void SortIndices(const MatType& data,
+                          arma::Mat<size_t>& sortedIndices);
+
   /**
    * Perform alpha pruning on a tree.  Returns the new value of alpha.
    *
@@ -181,6 +227,20 @@ class DTree
    */
   double ComputeValue(const VecType& query) const;
 
+  /**
+   * Compute the density estimate of each of the given query points, as
+   * ComputeValue() would for each of them.  The tree is first flattened into
+   * a contiguous array of nodes in depth-first order (a left child follows its
+   * parent, so each node only stores its split and the offset of its right
+   * child, and each leaf its log density), which takes one pass over the
+   * nodes.  Then the points descend that array without recursion, in parallel
+   * when OpenMP is available.  This should be called on the root of the tree.
+   *
+   * @param queries Points to estimate the density of, one per column.
+   * @param values Vector to store the density estimate of each point in.
+   */
+  void ComputeValue(const MatType& queries, arma::vec& values) const;
+
   /**
    * Index the buckets for possible usage later; this results in every leaf in
    * the tree having a specific tag (accessible with BucketTag()).  This
@@ -335,6 +395,79 @@ class DTree
                    const size_t splitDim,
                    const ElemType splitValue,
                    arma::Col<size_t>& oldFromNew) const;
+
+  //! The best split of a node found by FindSplits().
+  struct NodeSplit
+  {
+    //! Whether a split was found.
+    bool found;
+    //! The splitting dimension.
+    size_t dim;
+    //! The split value.
+    ElemType value;
+    //! The log-negative-error of the split.
+    double error;
+    //! The log-negative-error of the left child.
+    double leftError;
+    //! The log-negative-error of the right child.
+    double rightError;
+  };
+
+  /**
+   * Find the best split of each of the given nodes, with one scan of the
+   * sorted indices of each dimension.  nodeOf holds the index in the level of
+   * the node holding each point of the dataset, or size_t(-1).
+   */
+  static void FindSplits(const MatType& data,
+                         const arma::Mat<size_t>& sortedIndices,
+                         const std::vector<size_t>& nodeOf,
+                         const std::vector<DTree*>& level,
+                         const size_t totalPoints,
+                         const size_t minLeafSize,
+                         std::vector<NodeSplit>& splits);
+
+  /**
+   * Compute the ratio of points in this node and the log of its volume.
+   */
+  void ComputeRatioAndVolume(const size_t totalPoints);
+
+  /**
+   * Give the nodes of the subtree their ranges of points in depth-first
+   * order, starting at newStart, and compute their statistics with
+   * UpdateSubtree().  The sizes of the nodes must be set.
+   */
+  double LayOut(const size_t newStart,
+                const size_t totalPoints,
+                const bool useVolReg);
+
+  /**
+   * Compute the error and the upper alpha of the subtree once its children
+   * are grown, and return the minimum of g_k(t) over the subtree (given the
+   * minimums leftG and rightG of the children).
+   */
+  double UpdateSubtree(const double leftG,
+                       const double rightG,
+                       const size_t totalPoints,
+                       const bool useVolReg);
+
+  //! A node of the flattened tree used by the batch ComputeValue().
+  struct FlatNode
+  {
+    //! The split dimension of the node.
+    size_t splitDim;
+    //! The split value of the node.
+    ElemType splitValue;
+    //! The index of the right child of the node (the left child follows the
+    //! node), or 0 for a leaf.
+    size_t right;
+    //! The log density of the leaf.
+    double logDensity;
+  };
+
+  /**
+   * Append the nodes of the subtree to the given array in depth-first order.
+   */
+  void Flatten(std::vector<FlatNode>& nodes) const;
 };
 
 } // namespace det
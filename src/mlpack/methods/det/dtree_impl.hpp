@@ -524,8 +524,11 @@ bool DTree<MatType, TagType>::FindSplit(const MatType& data,
       - 2 * std::log((double) data.n_cols)
       - volumeWithoutDim;
 
+    // Prefer the lowest dimension on ties, so that the split does not depend on
+    // the order of the threads.
 #pragma omp critical(DTreeFindUpdate)
-    if ((actualMinDimError > minError) && dimSplitFound)
+    if (dimSplitFound && ((actualMinDimError > minError) || (splitFound &&
+        actualMinDimError == minError && (size_t) dim < splitDim)))
     {
       // Calculate actual error (in logspace) by adding terms back to our
       // estimate.
@@ -588,16 +591,9 @@ double DTree<MatType, TagType>::Grow(MatType& data,
   Log::Assert(data.n_rows == maxVals.n_elem);
   Log::Assert(data.n_rows == minVals.n_elem);
 
-  double leftG, rightG;
+  double leftG = 0.0, rightG = 0.0;
 
-  // Compute points ratio.
-  ratio = (double) (end - start) / (double) oldFromNew.n_elem;
-
-  // Compute the log of the volume of the node.
-  logVolume = 0;
-  for (size_t i = 0; i < maxVals.n_elem; ++i)
-    if (maxVals[i] - minVals[i] > 0.0)
-      logVolume += std::log(maxVals[i] - minVals[i]);
+  ComputeRatioAndVolume(oldFromNew.n_elem);
 
   // Check if node is large enough to split.
   if ((size_t) (end - start) > maxLeafSize)
@@ -633,34 +629,377 @@ double DTree<MatType, TagType>::Grow(MatType& data,
                          minLeafSize);
       rightG = right->Grow(data, oldFromNew, useVolReg, maxLeafSize,
                            minLeafSize);
+    }
+  }
+  else
+  {
+    // We can make this a leaf node.
+    Log::Assert((size_t) (end - start) >= minLeafSize);
+  }
 
-      // Store values of R(T~) and |T~|.
-      subtreeLeaves = left->SubtreeLeaves() + right->SubtreeLeaves();
+  return UpdateSubtree(leftG, rightG, data.n_cols, useVolReg);
+}
 
-      // Find the log negative error of the subtree leaves.  This is kind of an
-      // odd one because we don't want to represent the error in non-log-space,
-      // but we have to calculate log(E_l + E_r).  So we multiply E_l and E_r by
-      // V_t (remember E_l has an inverse relationship to the volume of the
-      // nodes) and then subtract log(V_t) at the end of the whole expression.
-      // As a result we do leave log-space, but the largest quantity we
-      // represent is on the order of (V_t / V_i) where V_i is the smallest leaf
-      // node below this node, which depends heavily on the depth of the tree.
-      subtreeLeavesLogNegError = std::log(
-          std::exp(logVolume + left->SubtreeLeavesLogNegError()) +
-          std::exp(logVolume + right->SubtreeLeavesLogNegError()))
-          - logVolume;
+// Greedily expand the tree, breadth-first, from presorted indices.
+template <typename MatType, typename TagType>
+double DTree<MatType, TagType>::Grow(const MatType& data,
+                                     const arma::Mat<size_t>& sortedIndices,
+                                     arma::Col<size_t>& oldFromNew,
+                                     const bool useVolReg,
+                                     const size_t maxLeafSize,
+                                     const size_t minLeafSize)
+{
+  Log::Assert(data.n_rows == maxVals.n_elem);
+  Log::Assert(data.n_rows == minVals.n_elem);
+  Log::Assert(sortedIndices.n_rows == data.n_cols);
+  Log::Assert(sortedIndices.n_cols == data.n_rows);
+  Log::Assert((size_t) (end - start) == oldFromNew.n_elem);
+
+  const size_t totalPoints = oldFromNew.n_elem;
+  const size_t none = size_t(-1);
+
+  // For each point of the dataset, the node being grown that holds it, or none
+  // if the point is in a leaf (or is not one of the points to grow on).  The
+  // nodes are indices into 'created' (for nodes just created) or into 'level'
+  // (for nodes being split).  These are the only per-point structures we need,
+  // so that many trees can be grown at once from the same sorted indices.
+  std::vector<size_t> nodeOf(data.n_cols, none);
+  // For each point, the leaf that holds it, as an index into 'leaves'.
+  std::vector<size_t> leafOf(data.n_cols, none);
+  std::vector<DTree*> leaves;
+
+  std::vector<DTree*> created(1, this);
+  std::vector<DTree*> level;
+  for (size_t i = 0; i < oldFromNew.n_elem; ++i)
+    nodeOf[oldFromNew[i]] = 0;
+
+  while (!created.empty())
+  {
+    // Nodes large enough to split are split in this level; the others are
+    // leaves.
+    std::vector<size_t> levelIndex(created.size(), none);
+    std::vector<size_t> leafIndex(created.size(), none);
+    level.clear();
+    for (size_t i = 0; i < created.size(); ++i)
+    {
+      DTree* node = created[i];
+      node->ComputeRatioAndVolume(totalPoints);
+      if ((size_t) (node->end - node->start) > maxLeafSize)
+      {
+        levelIndex[i] = level.size();
+        level.push_back(node);
+      }
+      else
+      {
+        Log::Assert((size_t) (node->end - node->start) >= minLeafSize);
+        leafIndex[i] = leaves.size();
+        leaves.push_back(node);
+      }
     }
-    else
+
+    for (size_t i = 0; i < oldFromNew.n_elem; ++i)
     {
-      // No split found so make a leaf out of it.
-      subtreeLeaves = 1;
-      subtreeLeavesLogNegError = logNegError;
+      const size_t point = oldFromNew[i];
+      if (nodeOf[point] == none)
+        continue;
+
+      if (leafIndex[nodeOf[point]] != none)
+        leafOf[point] = leafIndex[nodeOf[point]];
+      nodeOf[point] = levelIndex[nodeOf[point]];
+    }
+
+    if (level.empty())
+      break;
+
+    std::vector<NodeSplit> splits;
+    FindSplits(data, sortedIndices, nodeOf, level, totalPoints, minLeafSize,
+        splits);
+
+    // Create the children of the nodes that are split.  Their sizes are
+    // counted when the points are moved to them.
+    created.clear();
+    std::vector<size_t> leftIndex(level.size(), none);
+    std::vector<size_t> levelLeaf(level.size(), none);
+    for (size_t i = 0; i < level.size(); ++i)
+    {
+      DTree* node = level[i];
+      const NodeSplit& split = splits[i];
+      if (!split.found)
+      {
+        levelLeaf[i] = leaves.size();
+        leaves.push_back(node);
+        continue;
+      }
+
+      StatType maxValsL(node->maxVals);
+      StatType minValsR(node->minVals);
+      maxValsL[split.dim] = split.value;
+      minValsR[split.dim] = split.value;
+
+      node->splitValue = split.value;
+      node->splitDim = split.dim;
+      node->left = new DTree(maxValsL, node->minVals, 0, 0, split.leftError);
+      node->right = new DTree(node->maxVals, minValsR, 0, 0, split.rightError);
+
+      leftIndex[i] = created.size();
+      created.push_back(node->left);
+      created.push_back(node->right);
+    }
+
+    for (size_t i = 0; i < oldFromNew.n_elem; ++i)
+    {
+      const size_t point = oldFromNew[i];
+      const size_t node = nodeOf[point];
+      if (node == none)
+        continue;
+
+      if (leftIndex[node] == none)
+      {
+        leafOf[point] = levelLeaf[node];
+        nodeOf[point] = none;
+      }
+      else
+      {
+        const DTree* parent = level[node];
+        const size_t child = leftIndex[node] +
+            ((data(parent->splitDim, point) <= parent->splitValue) ? 0 : 1);
+        nodeOf[point] = child;
+        ++created[child]->end;
+      }
     }
   }
+
+  // Now that the tree is built, give each node its range of points, in the
+  // same depth-first order as the other Grow(), and reorder oldFromNew to
+  // match.
+  const double alpha = LayOut(start, totalPoints, useVolReg);
+
+  std::vector<size_t> next(leaves.size());
+  for (size_t i = 0; i < leaves.size(); ++i)
+    next[i] = leaves[i]->start;
+
+  const arma::Col<size_t> points(oldFromNew);
+  for (size_t i = 0; i < points.n_elem; ++i)
+    oldFromNew[next[leafOf[points[i]]]++] = points[i];
+
+  return alpha;
+}
+
+template <typename MatType, typename TagType>
+void DTree<MatType, TagType>::SortIndices(const MatType& data,
+                                          arma::Mat<size_t>& sortedIndices)
+{
+  sortedIndices.set_size(data.n_cols, data.n_rows);
+
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables. If we're building for Visual Studio, use
+  // the intmax_t type instead.
+#ifdef _WIN32
+  #pragma omp parallel for default(shared)
+  for (intmax_t dim = 0; dim < (intmax_t) data.n_rows; ++dim)
+#else
+  #pragma omp parallel for default(shared)
+  for (size_t dim = 0; dim < data.n_rows; ++dim)
+#endif
+  {
+    std::vector<ElemType> values(data.n_cols);
+    for (size_t i = 0; i < data.n_cols; ++i)
+      values[i] = data(dim, i);
+
+    size_t* indices = sortedIndices.colptr(dim);
+    for (size_t i = 0; i < data.n_cols; ++i)
+      indices[i] = i;
+
+    std::stable_sort(indices, indices + data.n_cols,
+        [&values](const size_t a, const size_t b)
+        {
+          return values[a] < values[b];
+        });
+  }
+}
+
+template <typename MatType, typename TagType>
+void DTree<MatType, TagType>::ComputeRatioAndVolume(const size_t totalPoints)
+{
+  // Compute points ratio.
+  ratio = (double) (end - start) / (double) totalPoints;
+
+  // Compute the log of the volume of the node.
+  logVolume = 0;
+  for (size_t i = 0; i < maxVals.n_elem; ++i)
+    if (maxVals[i] - minVals[i] > 0.0)
+      logVolume += std::log(maxVals[i] - minVals[i]);
+}
+
+// This finds the best split of each node of the level at once, with one scan
+// of the points of each dimension in sorted order.  The splits considered and
+// the one chosen are the same as in FindSplit().
+template <typename MatType, typename TagType>
+void DTree<MatType, TagType>::FindSplits(
+    const MatType& data,
+    const arma::Mat<size_t>& sortedIndices,
+    const std::vector<size_t>& nodeOf,
+    const std::vector<DTree*>& level,
+    const size_t totalPoints,
+    const size_t minLeafSize,
+    std::vector<NodeSplit>& splits)
+{
+  const size_t none = size_t(-1);
+
+  splits.resize(level.size());
+  for (size_t i = 0; i < level.size(); ++i)
+  {
+    splits[i].found = false;
+    splits[i].dim = 0;
+    splits[i].value = 0.0;
+    splits[i].error = level[i]->logNegError;
+    splits[i].leftError = 0.0;
+    splits[i].rightError = 0.0;
+  }
+
+#ifdef _WIN32
+  #pragma omp parallel for default(shared)
+  for (intmax_t dim = 0; dim < (intmax_t) data.n_rows; ++dim)
+#else
+  #pragma omp parallel for default(shared)
+  for (size_t dim = 0; dim < data.n_rows; ++dim)
+#endif
+  {
+    // The state of the scan of each node in this dimension: the number of its
+    // points seen so far, the value of the last of them, and the best split.
+    std::vector<size_t> seen(level.size(), 0);
+    std::vector<ElemType> last(level.size(), 0.0);
+    std::vector<double> minDimError(level.size());
+    std::vector<double> dimLeftError(level.size(), 0.0);
+    std::vector<double> dimRightError(level.size(), 0.0);
+    std::vector<ElemType> dimSplitValue(level.size(), 0.0);
+    std::vector<char> dimSplitFound(level.size(), 0);
+    for (size_t i = 0; i < level.size(); ++i)
+    {
+      const size_t points = level[i]->end - level[i]->start;
+      minDimError[i] = std::pow(points, 2.0) /
+          (level[i]->maxVals[dim] - level[i]->minVals[dim]);
+    }
+
+    const size_t* indices = sortedIndices.colptr(dim);
+    for (size_t j = 0; j < data.n_cols; ++j)
+    {
+      const size_t point = indices[j];
+      const size_t i = nodeOf[point];
+      if (i == none)
+        continue;
+
+      const ElemType value = data(dim, point);
+      const size_t points = level[i]->end - level[i]->start;
+
+      // A split between the last point and this one puts 'position' points on
+      // the left.
+      const size_t position = seen[i]++;
+      if (position > 0 && position >= minLeafSize &&
+          position + minLeafSize <= points)
+      {
+        const ElemType split = (last[i] + value) / 2.0;
+        const ElemType min = level[i]->minVals[dim];
+        const ElemType max = level[i]->maxVals[dim];
+
+        if ((split != last[i]) && (split - min > 0.0) && (max - split > 0.0))
+        {
+          const double negLeftError = std::pow(position, 2.0) / (split - min);
+          const double negRightError = std::pow(points - position, 2.0) /
+              (max - split);
+
+          if ((negLeftError + negRightError) >= minDimError[i])
+          {
+            minDimError[i] = negLeftError + negRightError;
+            dimLeftError[i] = negLeftError;
+            dimRightError[i] = negRightError;
+            dimSplitValue[i] = split;
+            dimSplitFound[i] = 1;
+          }
+        }
+      }
+
+      last[i] = value;
+    }
+
+    // Keep the best split of each node, preferring the lowest dimension on
+    // ties, so that the result does not depend on the order of the threads.
+    #pragma omp critical(DTreeFindSplitsUpdate)
+    for (size_t i = 0; i < level.size(); ++i)
+    {
+      const ElemType min = level[i]->minVals[dim];
+      const ElemType max = level[i]->maxVals[dim];
+      if (!dimSplitFound[i] || (max - min == 0.0))
+        continue;
+
+      const double volumeWithoutDim = level[i]->logVolume -
+          std::log(max - min);
+      const double actualMinDimError = std::log(minDimError[i])
+          - 2 * std::log((double) totalPoints)
+          - volumeWithoutDim;
+
+      NodeSplit& best = splits[i];
+      if ((actualMinDimError > best.error) || (best.found &&
+          actualMinDimError == best.error && (size_t) dim < best.dim))
+      {
+        best.found = true;
+        best.dim = dim;
+        best.value = dimSplitValue[i];
+        best.error = actualMinDimError;
+        best.leftError = std::log(dimLeftError[i])
+            - 2 * std::log((double) totalPoints) - volumeWithoutDim;
+        best.rightError = std::log(dimRightError[i])
+            - 2 * std::log((double) totalPoints) - volumeWithoutDim;
+      }
+    }
+  }
+}
+
+template <typename MatType, typename TagType>
+double DTree<MatType, TagType>::LayOut(const size_t newStart,
+                                       const size_t totalPoints,
+                                       const bool useVolReg)
+{
+  end = newStart + (end - start);
+  start = newStart;
+
+  double leftG = 0.0, rightG = 0.0;
+  if (left != NULL)
+  {
+    leftG = left->LayOut(start, totalPoints, useVolReg);
+    rightG = right->LayOut(left->end, totalPoints, useVolReg);
+  }
+
+  return UpdateSubtree(leftG, rightG, totalPoints, useVolReg);
+}
+
+template <typename MatType, typename TagType>
+double DTree<MatType, TagType>::UpdateSubtree(const double leftG,
+                                              const double rightG,
+                                              const size_t totalPoints,
+                                              const bool useVolReg)
+{
+  if (left != NULL)
+  {
+    // Store values of R(T~) and |T~|.
+    subtreeLeaves = left->SubtreeLeaves() + right->SubtreeLeaves();
+
+    // Find the log negative error of the subtree leaves.  This is kind of an
+    // odd one because we don't want to represent the error in non-log-space,
+    // but we have to calculate log(E_l + E_r).  So we multiply E_l and E_r by
+    // V_t (remember E_l has an inverse relationship to the volume of the
+    // nodes) and then subtract log(V_t) at the end of the whole expression.
+    // As a result we do leave log-space, but the largest quantity we
+    // represent is on the order of (V_t / V_i) where V_i is the smallest leaf
+    // node below this node, which depends heavily on the depth of the tree.
+    subtreeLeavesLogNegError = std::log(
+        std::exp(logVolume + left->SubtreeLeavesLogNegError()) +
+        std::exp(logVolume + right->SubtreeLeavesLogNegError()))
+        - logVolume;
+  }
   else
   {
-    // We can make this a leaf node.
-    Log::Assert((size_t) (end - start) >= minLeafSize);
+    // No split was made so this is a leaf.
     subtreeLeaves = 1;
     subtreeLeavesLogNegError = logNegError;
   }
@@ -687,7 +1026,7 @@ double DTree<MatType, TagType>::Grow(MatType& data,
 
     if (left->SubtreeLeaves() > 1)
     {
-      const double exponent = 2 * std::log((double) data.n_cols) + logVolume +
+      const double exponent = 2 * std::log((double) totalPoints) + logVolume +
           left->AlphaUpper();
 
       // Whether or not this will overflow is highly dependent on the depth of
@@ -697,14 +1036,14 @@ double DTree<MatType, TagType>::Grow(MatType& data,
 
     if (right->SubtreeLeaves() > 1)
     {
-      const double exponent = 2 * std::log((double) data.n_cols)
+      const double exponent = 2 * std::log((double) totalPoints)
         + logVolume
         + right->AlphaUpper();
 
       tmpAlphaSum += std::exp(exponent);
     }
 
-    alphaUpper = std::log(tmpAlphaSum) - 2 * std::log((double) data.n_cols)
+    alphaUpper = std::log(tmpAlphaSum) - 2 * std::log((double) totalPoints)
       - logVolume;
 
     double gT;
@@ -881,6 +1220,75 @@ double DTree<MatType, TagType>::ComputeValue(const VecType& query) const
   return 0.0;
 }
 
+template <typename MatType, typename TagType>
+void DTree<MatType, TagType>::ComputeValue(const MatType& queries,
+                                           arma::vec& values) const
+{
+  Log::Assert(queries.n_rows == maxVals.n_elem);
+
+  std::vector<FlatNode> nodes;
+  Flatten(nodes);
+
+  values.set_size(queries.n_cols);
+
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables. If we're building for Visual Studio, use
+  // the intmax_t type instead.
+#ifdef _WIN32
+  #pragma omp parallel for schedule(static)
+  for (intmax_t i = 0; i < (intmax_t) queries.n_cols; ++i)
+#else
+  #pragma omp parallel for schedule(static)
+  for (size_t i = 0; i < queries.n_cols; ++i)
+#endif
+  {
+    // Points out of the range of the root have no density.
+    bool withinRange = true;
+    for (size_t d = 0; root && withinRange && d < queries.n_rows; ++d)
+    {
+      const ElemType value = queries(d, i);
+      withinRange = (value >= minVals[d]) && (value <= maxVals[d]);
+    }
+
+    if (!withinRange)
+    {
+      values[i] = 0.0;
+      continue;
+    }
+
+    size_t node = 0;
+    while (nodes[node].right != 0)
+    {
+      node = (queries(nodes[node].splitDim, i) <= nodes[node].splitValue) ?
+          node + 1 : nodes[node].right;
+    }
+
+    values[i] = std::exp(nodes[node].logDensity);
+  }
+}
+
+template <typename MatType, typename TagType>
+void DTree<MatType, TagType>::Flatten(std::vector<FlatNode>& nodes) const
+{
+  const size_t index = nodes.size();
+  nodes.push_back(FlatNode());
+  nodes[index].splitDim = splitDim;
+  nodes[index].splitValue = splitValue;
+  nodes[index].right = 0;
+  nodes[index].logDensity = 0.0;
+
+  if (subtreeLeaves == 1)
+  {
+    nodes[index].logDensity = std::log(ratio) - logVolume;
+  }
+  else
+  {
+    left->Flatten(nodes);
+    nodes[index].right = nodes.size();
+    right->Flatten(nodes);
+  }
+}
+
 // Index the buckets for possible usage later.
 template <typename MatType, typename TagType>
 TagType DTree<MatType, TagType>::TagTree(const TagType& tag)
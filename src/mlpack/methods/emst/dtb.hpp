@@ -32,6 +32,8 @@
 #include <mlpack/core/metrics/lmetric.hpp>
 
 #include <mlpack/core/tree/binary_space_tree.hpp>
+#include <mlpack/core/tree/independent_subtrees.hpp>
+#include <mlpack/core/tree/traversal_statistics.hpp>
 
 namespace mlpack {
 namespace emst /** Euclidean Minimum Spanning Trees. */ {
@@ -68,6 +70,14 @@ namespace emst /** Euclidean Minimum Spanning Trees. */ {
  * More advanced usage of the class can use different types of trees, pass in an
  * already-built tree, or compute the MST using the O(n^2) naive algorithm.
  *
+ * The search for the nearest neighbor of each component in each round is run
+ * in parallel with OpenMP: the tree is split into subtrees with disjoint sets
+ * of points, and each thread traverses its query subtrees against the whole
+ * tree, storing the candidate edges it finds in its own arrays.  After the
+ * traversal, the candidates of all threads are merged.  Each thread's arrays
+ * hold an entry for every point, so the parallel search needs (24 bytes times
+ * the number of points) of extra memory per thread.
+ *
  * @tparam MetricType The metric to use.
  * @tparam MatType The type of data matrix to use.
  * @tparam TreeType Type of tree to use.  This should follow the TreeType policy
@@ -98,6 +108,11 @@ class DualTreeBoruvka
 
   //! Indicates whether or not O(n^2) naive mode will be used.
   bool naive;
+  //! The number of threads to use for each round (0 means the OpenMP
+  //! default).
+  size_t numThreads;
+  //! Relative approximation error of each edge (0 for the exact MST).
+  double epsilon;
 
   //! Edges.
   std::vector<EdgePair> edges; // We must use vector with non-numerical types.
@@ -112,9 +127,19 @@ class DualTreeBoruvka
   //! List of edge distances.
   arma::vec neighborsDistances;
 
+  //! Candidate edge nodes in each component found by each thread.
+  std::vector<arma::Col<size_t>> threadNeighborsInComponent;
+  //! Candidate edge nodes outside each component found by each thread.
+  std::vector<arma::Col<size_t>> threadNeighborsOutComponent;
+  //! Candidate edge distances of each component found by each thread.
+  std::vector<arma::vec> threadNeighborsDistances;
+
   //! Total distance of the tree.
   double totalDist;
 
+  //! The statistics of the last call to ComputeMST().
+  tree::TraversalStatistics statistics;
+
   //! The instantiated metric.
   MetricType metric;
 
@@ -176,7 +201,41 @@ class DualTreeBoruvka
    */
   void ComputeMST(arma::mat& results);
 
+  //! Get the number of threads used for each round (0 means the OpenMP
+  //! default).
+  size_t NumThreads() const { return numThreads; }
+  //! Modify the number of threads used for each round (0 means the OpenMP
+  //! default, and 1 disables parallel search).
+  size_t& NumThreads() { return numThreads; }
+
+  //! Get the relative approximation error (0 means the exact MST is found).
+  double Epsilon() const { return epsilon; }
+  /**
+   * Modify the relative approximation error.  If epsilon is greater than 0,
+   * the tree-based search may add, for each component in each round, an edge
+   * that is up to (1 + epsilon) times longer than its shortest edge to another
+   * component, in exchange for more pruning.  The result is a spanning tree
+   * whose edges are each at most (1 + epsilon) times longer than needed.  This
+   * has no effect in naive mode.
+   */
+  double& Epsilon() { return epsilon; }
+
+  //! Get the statistics of the last call to ComputeMST(), over all rounds.
+  const tree::TraversalStatistics& Statistics() const { return statistics; }
+
  private:
+  /**
+   * Find the nearest neighbor of each component by traversing each of the
+   * given query subtrees against the whole tree in parallel, then merge the
+   * candidate edges found by each thread into neighborsDistances,
+   * neighborsInComponent and neighborsOutComponent.
+   *
+   * @param subtrees Subtrees of the tree with disjoint sets of points.
+   * @param rules Rules whose base case and score counts are updated.
+   */
+  template<typename RuleType>
+  void DualTreeTraverse(const std::vector<Tree*>& subtrees, RuleType& rules);
+
   /**
    * Adds a single edge to the edge list
    */
@@ -57,6 +57,8 @@ DualTreeBoruvka<MetricType, MatType, TreeType>::DualTreeBoruvka(
     data(naive ? dataset : tree->Dataset()),
     ownTree(!naive),
     naive(naive),
+    numThreads(0),
+    epsilon(0.0),
     connections(dataset.n_cols),
     totalDist(0.0),
     metric(metric)
@@ -82,6 +84,8 @@ DualTreeBoruvka<MetricType, MatType, TreeType>::DualTreeBoruvka(
     data(tree->Dataset()),
     ownTree(false),
     naive(false),
+    numThreads(0),
+    epsilon(0.0),
     connections(data.n_cols),
     totalDist(0.0),
     metric(metric)
@@ -119,26 +123,69 @@ template<
 void DualTreeBoruvka<MetricType, MatType, TreeType>::ComputeMST(
     arma::mat& results)
 {
+  if (epsilon < 0.0)
+    throw std::invalid_argument("DualTreeBoruvka::ComputeMST(): epsilon must be "
+        "non-negative");
+
   Timer::Start("emst/mst_computation");
 
   totalDist = 0; // Reset distance.
+  statistics.Reset();
 
   typedef DTBRules<MetricType, Tree> RuleType;
   RuleType rules(data, connections, neighborsDistances, neighborsInComponent,
-                 neighborsOutComponent, metric);
-  while (edges.size() < (data.n_cols - 1))
+                 neighborsOutComponent, metric, epsilon);
+
+#ifdef HAS_OPENMP
+  const size_t threads = (numThreads == 0) ? omp_get_max_threads() :
+      numThreads;
+#else
+  const size_t threads = 1;
+#endif
+
+  // Split the tree into subtrees with disjoint sets of points, which are
+  // searched in parallel in each round.  Ask for more subtrees than threads, so
+  // that the dynamic schedule can balance the work.  The tree doesn't change
+  // between rounds, so this only needs to be done once.
+  std::vector<Tree*> subtrees;
+  if (!naive && threads > 1)
+    tree::IndependentSubtrees(*tree, 8 * threads, subtrees);
+
+  if (subtrees.size() > 1)
   {
-    if (naive)
+    threadNeighborsInComponent.resize(threads);
+    threadNeighborsOutComponent.resize(threads);
+    threadNeighborsDistances.resize(threads);
+    for (size_t t = 0; t < threads; ++t)
     {
-      // Full O(N^2) traversal.
-      for (size_t i = 0; i < data.n_cols; ++i)
-        for (size_t j = 0; j < data.n_cols; ++j)
-          rules.BaseCase(i, j);
+      threadNeighborsInComponent[t].set_size(data.n_cols);
+      threadNeighborsOutComponent[t].set_size(data.n_cols);
+      threadNeighborsDistances[t].set_size(data.n_cols);
+      threadNeighborsDistances[t].fill(DBL_MAX);
     }
-    else
+  }
+
+  while (edges.size() < (data.n_cols - 1))
+  {
     {
-      typename Tree::template DualTreeTraverser<RuleType> traverser(rules);
-      traverser.Traverse(*tree, *tree);
+      tree::TraversalStatistics::PhaseTimer timer(statistics.TraversalTime());
+      if (naive)
+      {
+        // Full O(N^2) traversal.
+        for (size_t i = 0; i < data.n_cols; ++i)
+          for (size_t j = 0; j < data.n_cols; ++j)
+            rules.BaseCase(i, j);
+      }
+      else if (subtrees.size() > 1)
+      {
+        DualTreeTraverse(subtrees, rules);
+      }
+      else
+      {
+        typename Tree::template DualTreeTraverser<RuleType> traverser(rules);
+        traverser.Traverse(*tree, *tree);
+        statistics.AddTraverser(traverser);
+      }
     }
 
     AddAllEdges();
@@ -154,13 +201,107 @@ void DualTreeBoruvka<MetricType, MatType, TreeType>::ComputeMST(
     }
   }
 
+  statistics.AddRules(rules);
+
   Timer::Stop("emst/mst_computation");
 
+  // Release the memory of the per-thread candidates.
+  threadNeighborsInComponent.clear();
+  threadNeighborsOutComponent.clear();
+  threadNeighborsDistances.clear();
+
   EmitResults(results);
 
   Log::Info << "Total spanning tree length: " << totalDist << std::endl;
 }
 
+/**
+ * Traverse the query subtrees in parallel, then merge the candidate edges of
+ * each thread.
+ */
+template<
+    typename MetricType,
+    typename MatType,
+    template<typename TreeMetricType,
+             typename TreeStatType,
+             typename TreeMatType> class TreeType>
+template<typename RuleType>
+void DualTreeBoruvka<MetricType, MatType, TreeType>::DualTreeTraverse(
+    const std::vector<Tree*>& subtrees,
+    RuleType& rules)
+{
+  const size_t threads = threadNeighborsDistances.size();
+
+  size_t totalScores = 0;
+  size_t totalBaseCases = 0;
+  size_t totalPrunes = 0;
+
+  #pragma omp parallel num_threads(threads) reduction(+:totalScores, \
+      totalBaseCases, totalPrunes)
+  {
+#ifdef HAS_OPENMP
+    const size_t t = omp_get_thread_num();
+#else
+    const size_t t = 0;
+#endif
+
+    // Each thread stores its candidate edges in its own arrays, because the
+    // points of a component may be spread over several subtrees.  The bounds
+    // stored in the query nodes are not shared, because the subtrees hold
+    // disjoint sets of nodes, and the component memberships of the reference
+    // nodes don't change during a round.
+    MetricType threadMetric(metric);
+    RuleType threadRules(data, connections, threadNeighborsDistances[t],
+        threadNeighborsInComponent[t], threadNeighborsOutComponent[t],
+        threadMetric, epsilon);
+
+#ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables. If we're building for Visual Studio,
+    // use the intmax_t type instead.
+    #pragma omp for schedule(dynamic)
+    for (intmax_t i = 0; i < (intmax_t) subtrees.size(); ++i)
+#else
+    #pragma omp for schedule(dynamic)
+    for (size_t i = 0; i < subtrees.size(); ++i)
+#endif
+    {
+      typename Tree::template DualTreeTraverser<RuleType>
+          traverser(threadRules);
+      traverser.Traverse(*subtrees[i], *tree);
+      totalPrunes += traverser.NumPrunes();
+    }
+
+    totalScores += threadRules.Scores();
+    totalBaseCases += threadRules.BaseCases();
+
+    // Now merge the candidates of all threads; each thread merges a part of
+    // the components.
+#ifdef _WIN32
+    #pragma omp for
+    for (intmax_t i = 0; i < (intmax_t) data.n_cols; ++i)
+#else
+    #pragma omp for
+    for (size_t i = 0; i < data.n_cols; ++i)
+#endif
+    {
+      for (size_t j = 0; j < threads; ++j)
+      {
+        if (threadNeighborsDistances[j][i] < neighborsDistances[i])
+        {
+          neighborsDistances[i] = threadNeighborsDistances[j][i];
+          neighborsInComponent[i] = threadNeighborsInComponent[j][i];
+          neighborsOutComponent[i] = threadNeighborsOutComponent[j][i];
+        }
+      }
+    }
+  }
+
+  rules.Scores() += totalScores;
+  rules.BaseCases() += totalBaseCases;
+  statistics.Prunes() += totalPrunes;
+}
+
 /**
  * Adds a single edge to the edge list
  */
@@ -321,6 +462,9 @@ void DualTreeBoruvka<MetricType, MatType, TreeType>::Cleanup()
   for (size_t i = 0; i < data.n_cols; i++)
     neighborsDistances[i] = DBL_MAX;
 
+  for (size_t t = 0; t < threadNeighborsDistances.size(); ++t)
+    threadNeighborsDistances[t].fill(DBL_MAX);
+
   if (!naive)
     CleanupHelper(tree);
 }
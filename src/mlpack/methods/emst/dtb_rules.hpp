@@ -23,12 +23,27 @@ template<typename MetricType, typename TreeType>
 class DTBRules
 {
  public:
+  /**
+   * Construct the rules.  If epsilon is greater than 0, a node combination is
+   * pruned as soon as it can't give a candidate edge that is shorter than the
+   * current candidate divided by (1 + epsilon), so each edge found for a
+   * component is at most (1 + epsilon) times longer than its shortest edge.
+   *
+   * @param dataSet The data points.
+   * @param connections The components found so far.
+   * @param neighborsDistances Candidate edge distance of each component.
+   * @param neighborsInComponent Candidate edge point in each component.
+   * @param neighborsOutComponent Candidate edge point outside each component.
+   * @param metric The instantiated metric.
+   * @param epsilon Relative approximation error (0 for exact search).
+   */
   DTBRules(const arma::mat& dataSet,
            UnionFind& connections,
            arma::vec& neighborsDistances,
            arma::Col<size_t>& neighborsInComponent,
            arma::Col<size_t>& neighborsOutComponent,
-           MetricType& metric);
+           MetricType& metric,
+           const double epsilon = 0.0);
 
   double BaseCase(const size_t queryIndex, const size_t referenceIndex);
 
@@ -118,6 +133,16 @@ class DTBRules
   //! The instantiated metric.
   MetricType& metric;
 
+  //! The factor 1 / (1 + epsilon) that candidate distances are scaled by
+  //! before they are used for pruning.
+  double boundFactor;
+
+  //! Scale the given candidate distance for pruning.
+  double PruneBound(const double bound) const
+  {
+    return (bound == DBL_MAX) ? DBL_MAX : bound * boundFactor;
+  }
+
   /**
    * Update the bound for the given query node.
    */
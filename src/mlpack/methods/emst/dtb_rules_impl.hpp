@@ -22,7 +22,8 @@ DTBRules(const arma::mat& dataSet,
          arma::vec& neighborsDistances,
          arma::Col<size_t>& neighborsInComponent,
          arma::Col<size_t>& neighborsOutComponent,
-         MetricType& metric)
+         MetricType& metric,
+         const double epsilon)
 :
   dataSet(dataSet),
   connections(connections),
@@ -30,6 +31,7 @@ DTBRules(const arma::mat& dataSet,
   neighborsInComponent(neighborsInComponent),
   neighborsOutComponent(neighborsOutComponent),
   metric(metric),
+  boundFactor(1.0 / (1.0 + epsilon)),
   baseCases(0),
   scores(0)
 {
@@ -93,7 +95,7 @@ double DTBRules<MetricType, TreeType>::Score(const size_t queryIndex,
 
   // If all the points in the reference node are farther than the candidate
   // nearest neighbor for the query's component, we prune.
-  return neighborsDistances[queryComponentIndex] < distance
+  return PruneBound(neighborsDistances[queryComponentIndex]) < distance
       ? DBL_MAX : distance;
 }
 
@@ -104,8 +106,9 @@ double DTBRules<MetricType, TreeType>::Rescore(const size_t queryIndex,
 {
   // We don't need to check component membership again, because it can't
   // change inside a single iteration.
-  return (oldScore > neighborsDistances[connections.Find(queryIndex)])
-      ? DBL_MAX : oldScore;
+  const size_t queryComponentIndex = connections.Find(queryIndex);
+  return (oldScore > PruneBound(neighborsDistances[queryComponentIndex])) ?
+      DBL_MAX : oldScore;
 }
 
 template<typename MetricType, typename TreeType>
@@ -121,7 +124,7 @@ double DTBRules<MetricType, TreeType>::Score(TreeType& queryNode,
 
   ++scores;
   const double distance = queryNode.MinDistance(referenceNode);
-  const double bound = CalculateBound(queryNode);
+  const double bound = PruneBound(CalculateBound(queryNode));
 
   // If all the points in the reference node are farther than the candidate
   // nearest neighbor for all queries in the node, we prune.
@@ -133,7 +136,7 @@ double DTBRules<MetricType, TreeType>::Rescore(TreeType& queryNode,
                                                TreeType& /* referenceNode */,
                                                const double oldScore) const
 {
-  const double bound = CalculateBound(queryNode);
+  const double bound = PruneBound(CalculateBound(queryNode));
   return (oldScore > bound) ? DBL_MAX : oldScore;
 }
 
@@ -25,6 +25,7 @@
  * http://www.opensource.org/licenses/BSD-3-Clause for more information.
  */
 #include "dtb.hpp"
+#include "single_linkage.hpp"
 
 #include <mlpack/prereqs.hpp>
 #include <mlpack/core/util/cli.hpp>
@@ -36,7 +37,20 @@ PROGRAM_INFO("Fast Euclidean Minimum Spanning Tree", "This program can compute "
     "The output is saved in a three-column matrix, where each row indicates an "
     "edge.  The first column corresponds to the lesser index of the edge; the "
     "second column corresponds to the greater index of the edge; and the third "
-    "column corresponds to the distance between the two points.");
+    "column corresponds to the distance between the two points."
+    "\n\n"
+    "If --epsilon is given, the tree-based search finds an approximate MST, "
+    "where each edge is at most (1 + epsilon) times longer than needed, in "
+    "less time."
+    "\n\n"
+    "The MST can also be turned into a single-linkage hierarchical clustering.  "
+    "The dendrogram can be saved with --dendrogram_file; it has one row per "
+    "merge, in order of increasing distance, holding the two merged clusters, "
+    "the distance and the size of the new cluster.  Clusters 0 to (n - 1) are "
+    "the points, and the cluster created by the merge in row i is cluster "
+    "n + i.  A flat clustering can be saved with --assignments_file, by cutting "
+    "the dendrogram either at a distance (--cut_distance) or into a number of "
+    "clusters (--clusters).");
 
 PARAM_MATRIX_IN_REQ("input", "Input data matrix.", "i");
 PARAM_MATRIX_OUT("output", "Output data.  Stored as an edge list.", "o");
@@ -44,6 +58,18 @@ PARAM_FLAG("naive", "Compute the MST using O(n^2) naive algorithm.", "n");
 PARAM_INT_IN("leaf_size", "Leaf size in the kd-tree.  One-element leaves give "
     "the empirically best performance, but at the cost of greater memory "
     "requirements.", "l", 1);
+PARAM_INT_IN("threads", "Number of threads to use for the tree-based search "
+    "(if 0, the OpenMP default is used).", "t", 0);
+PARAM_DOUBLE_IN("epsilon", "Relative approximation error of each edge of the "
+    "MST (0 for the exact MST).", "e", 0.0);
+
+// Single-linkage clustering output.
+PARAM_MATRIX_OUT("dendrogram", "Output single-linkage dendrogram.", "d");
+PARAM_DOUBLE_IN("cut_distance", "Cut the dendrogram at this distance for "
+    "--assignments_file.", "D", 0.0);
+PARAM_INT_IN("clusters", "Cut the dendrogram into this number of clusters for "
+    "--assignments_file.", "c", 0);
+PARAM_UROW_OUT("assignments", "Output cluster assignment of each point.", "a");
 
 using namespace mlpack;
 using namespace mlpack::emst;
@@ -55,11 +81,36 @@ int main(int argc, char* argv[])
 {
   CLI::ParseCommandLine(argc, argv);
 
-  if (!CLI::HasParam("output"))
-    Log::Warn << "--output_file is not specified, so no output will be saved!"
+  if (!CLI::HasParam("output") && !CLI::HasParam("dendrogram") &&
+      !CLI::HasParam("assignments"))
+  {
+    Log::Warn << "None of --output_file, --dendrogram_file, or "
+        << "--assignments_file are specified, so no output will be saved!"
+        << endl;
+  }
+
+  if (CLI::HasParam("assignments") && (CLI::HasParam("cut_distance") ==
+      CLI::HasParam("clusters")))
+  {
+    Log::Fatal << "Exactly one of --cut_distance and --clusters must be given "
+        << "with --assignments_file." << endl;
+  }
+  if (!CLI::HasParam("assignments") && (CLI::HasParam("cut_distance") ||
+      CLI::HasParam("clusters")))
+  {
+    Log::Warn << "--cut_distance and --clusters are ignored because "
+        << "--assignments_file is not specified." << endl;
+  }
+
+  const double epsilon = CLI::GetParam<double>("epsilon");
+  if (epsilon < 0)
+    Log::Fatal << "Invalid epsilon: " << epsilon << ".  Must be 0 or greater."
         << endl;
+  if (CLI::HasParam("epsilon") && CLI::GetParam<bool>("naive"))
+    Log::Warn << "--epsilon ignored because --naive is present." << endl;
 
   arma::mat dataPoints = std::move(CLI::GetParam<arma::mat>("input"));
+  arma::mat mst;
 
   // Do naive computation if necessary.
   if (CLI::GetParam<bool>("naive"))
@@ -68,11 +119,7 @@ int main(int argc, char* argv[])
 
     DualTreeBoruvka<> naive(dataPoints, true);
 
-    arma::mat naiveResults;
-    naive.ComputeMST(naiveResults);
-
-    if (CLI::HasParam("output"))
-      CLI::GetParam<arma::mat>("output") = std::move(naiveResults);
+    naive.ComputeMST(mst);
   }
   else
   {
@@ -89,6 +136,11 @@ int main(int argc, char* argv[])
     // by hand.
     const size_t leafSize = (size_t) CLI::GetParam<int>("leaf_size");
 
+    const int threads = CLI::GetParam<int>("threads");
+    if (threads < 0)
+      Log::Fatal << "Invalid number of threads: " << threads << ".  Must be 0 "
+          << "or greater." << endl;
+
     Timer::Start("tree_building");
     std::vector<size_t> oldFromNew;
     KDTree<EuclideanDistance, DTBStat, arma::mat> tree(dataPoints, oldFromNew,
@@ -97,6 +149,8 @@ int main(int argc, char* argv[])
     Timer::Stop("tree_building");
 
     DualTreeBoruvka<> dtb(&tree, metric);
+    dtb.NumThreads() = size_t(threads);
+    dtb.Epsilon() = epsilon;
 
     // Run the DTB algorithm.
     Log::Info << "Calculating minimum spanning tree." << endl;
@@ -104,7 +158,7 @@ int main(int argc, char* argv[])
     dtb.ComputeMST(results);
 
     // Unmap the results.
-    arma::mat unmappedResults(results.n_rows, results.n_cols);
+    mst.set_size(results.n_rows, results.n_cols);
     for (size_t i = 0; i < results.n_cols; ++i)
     {
       const size_t indexA = oldFromNew[size_t(results(0, i))];
@@ -112,19 +166,51 @@ int main(int argc, char* argv[])
 
       if (indexA < indexB)
       {
-        unmappedResults(0, i) = indexA;
-        unmappedResults(1, i) = indexB;
+        mst(0, i) = indexA;
+        mst(1, i) = indexB;
       }
       else
       {
-        unmappedResults(0, i) = indexB;
-        unmappedResults(1, i) = indexA;
+        mst(0, i) = indexB;
+        mst(1, i) = indexA;
       }
 
-      unmappedResults(2, i) = results(2, i);
+      mst(2, i) = results(2, i);
     }
+  }
 
-    if (CLI::HasParam("output"))
-      CLI::GetParam<arma::mat>("output") = std::move(unmappedResults);
+  // Build the single-linkage clustering, if requested.
+  if (CLI::HasParam("dendrogram"))
+  {
+    arma::mat dendrogram;
+    SingleLinkageDendrogram(mst, dendrogram);
+    CLI::GetParam<arma::mat>("dendrogram") = std::move(dendrogram);
   }
+
+  if (CLI::HasParam("assignments"))
+  {
+    arma::Row<size_t> assignments;
+    if (CLI::HasParam("cut_distance"))
+    {
+      const size_t numClusters = CutAtDistance(mst,
+          CLI::GetParam<double>("cut_distance"), assignments);
+      Log::Info << numClusters << " clusters found." << endl;
+    }
+    else
+    {
+      const int clusters = CLI::GetParam<int>("clusters");
+      if (clusters <= 0 || size_t(clusters) > mst.n_cols + 1)
+      {
+        Log::Fatal << "Invalid number of clusters: " << clusters << ".  Must "
+            << "be between 1 and the number of points." << endl;
+      }
+
+      CutToClusters(mst, size_t(clusters), assignments);
+    }
+
+    CLI::GetParam<arma::Row<size_t>>("assignments") = std::move(assignments);
+  }
+
+  if (CLI::HasParam("output"))
+    CLI::GetParam<arma::mat>("output") = std::move(mst);
 }
@@ -0,0 +1,153 @@
+/**
+ * @file single_linkage.cpp
+ *
+ * Implementation of the single-linkage clustering functions, which work on the
+ * minimum spanning tree of a set of points.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "single_linkage.hpp"
+#include "union_find.hpp"
+
+namespace mlpack {
+namespace emst {
+
+//! Make sure the given matrix looks like an MST, and return the number of
+//! points it spans.
+static size_t CheckMST(const arma::mat& mst, const std::string& function)
+{
+  if (mst.n_rows != 3)
+  {
+    std::ostringstream oss;
+    oss << function << "(): the MST must have 3 rows, but it has " << mst.n_rows
+        << " rows";
+    throw std::invalid_argument(oss.str());
+  }
+
+  const size_t numPoints = mst.n_cols + 1;
+  for (size_t i = 0; i < mst.n_cols; ++i)
+  {
+    if (mst(0, i) < 0 || mst(0, i) >= numPoints || mst(1, i) < 0 ||
+        mst(1, i) >= numPoints)
+    {
+      std::ostringstream oss;
+      oss << function << "(): edge " << i << " has a point index that is not "
+          << "between 0 and " << (numPoints - 1);
+      throw std::invalid_argument(oss.str());
+    }
+  }
+
+  return numPoints;
+}
+
+//! Label the components of the given structure in order of their lowest point
+//! index, and return the number of components.
+static size_t LabelComponents(UnionFind& components,
+                              const size_t numPoints,
+                              arma::Row<size_t>& assignments)
+{
+  assignments.set_size(numPoints);
+
+  // The label of each root, once it has been seen.
+  arma::Col<size_t> labels(numPoints);
+  labels.fill(size_t(-1));
+
+  size_t numClusters = 0;
+  for (size_t i = 0; i < numPoints; ++i)
+  {
+    const size_t root = components.Find(i);
+    if (labels[root] == size_t(-1))
+      labels[root] = numClusters++;
+
+    assignments[i] = labels[root];
+  }
+
+  return numClusters;
+}
+
+void SingleLinkageDendrogram(const arma::mat& mst, arma::mat& dendrogram)
+{
+  const size_t numPoints = CheckMST(mst, "SingleLinkageDendrogram");
+
+  // Merge the clusters in order of increasing edge length.
+  const arma::uvec order = arma::stable_sort_index(mst.row(2));
+
+  UnionFind components(numPoints);
+  // The dendrogram cluster and the size of the cluster of each root.
+  arma::Col<size_t> clusters(numPoints);
+  arma::Col<size_t> sizes(numPoints);
+  for (size_t i = 0; i < numPoints; ++i)
+  {
+    clusters[i] = i;
+    sizes[i] = 1;
+  }
+
+  dendrogram.set_size(4, mst.n_cols);
+  for (size_t i = 0; i < mst.n_cols; ++i)
+  {
+    const size_t edge = order[i];
+    const size_t rootA = components.Find((size_t) mst(0, edge));
+    const size_t rootB = components.Find((size_t) mst(1, edge));
+    if (rootA == rootB)
+    {
+      std::ostringstream oss;
+      oss << "SingleLinkageDendrogram(): edge " << edge << " creates a cycle; "
+          << "the given matrix is not a spanning tree";
+      throw std::invalid_argument(oss.str());
+    }
+
+    const size_t size = sizes[rootA] + sizes[rootB];
+    dendrogram(0, i) = std::min(clusters[rootA], clusters[rootB]);
+    dendrogram(1, i) = std::max(clusters[rootA], clusters[rootB]);
+    dendrogram(2, i) = mst(2, edge);
+    dendrogram(3, i) = size;
+
+    components.Union(rootA, rootB);
+    const size_t root = components.Find(rootA);
+    clusters[root] = numPoints + i;
+    sizes[root] = size;
+  }
+}
+
+size_t CutAtDistance(const arma::mat& mst,
+                     const double distance,
+                     arma::Row<size_t>& assignments)
+{
+  const size_t numPoints = CheckMST(mst, "CutAtDistance");
+
+  UnionFind components(numPoints);
+  for (size_t i = 0; i < mst.n_cols; ++i)
+    if (mst(2, i) <= distance)
+      components.Union((size_t) mst(0, i), (size_t) mst(1, i));
+
+  return LabelComponents(components, numPoints, assignments);
+}
+
+void CutToClusters(const arma::mat& mst,
+                   const size_t numClusters,
+                   arma::Row<size_t>& assignments)
+{
+  const size_t numPoints = CheckMST(mst, "CutToClusters");
+  if (numClusters == 0 || numClusters > numPoints)
+  {
+    std::ostringstream oss;
+    oss << "CutToClusters(): the number of clusters must be between 1 and the "
+        << "number of points (" << numPoints << "), but it is " << numClusters;
+    throw std::invalid_argument(oss.str());
+  }
+
+  // Keep the shortest (n - numClusters) edges.
+  const arma::uvec order = arma::stable_sort_index(mst.row(2));
+
+  UnionFind components(numPoints);
+  for (size_t i = 0; i < numPoints - numClusters; ++i)
+    components.Union((size_t) mst(0, order[i]), (size_t) mst(1, order[i]));
+
+  LabelComponents(components, numPoints, assignments);
+}
+
+} // namespace emst
+} // namespace mlpack
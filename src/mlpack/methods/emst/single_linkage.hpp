@@ -0,0 +1,72 @@
+/**
+ * @file single_linkage.hpp
+ *
+ * Functions that turn a minimum spanning tree, as computed by
+ * DualTreeBoruvka, into a single-linkage hierarchical clustering: the full
+ * dendrogram, or a flat clustering found by cutting the dendrogram.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_EMST_SINGLE_LINKAGE_HPP
+#define MLPACK_METHODS_EMST_SINGLE_LINKAGE_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace emst {
+
+/**
+ * Build the single-linkage dendrogram of a set of points from its minimum
+ * spanning tree.  The MST must be given in the format returned by
+ * DualTreeBoruvka::ComputeMST(): one column per edge, holding the two point
+ * indices and the length of the edge.  The edges don't need to be sorted.
+ *
+ * The dendrogram has one column per merge, in order of increasing distance.
+ * Clusters 0 to (n - 1) are the single points, and the cluster created by the
+ * merge in column i has index n + i.  Each column holds the indices of the two
+ * merged clusters (the lesser first), the distance at which they are merged,
+ * and the number of points in the new cluster.  This is the linkage matrix
+ * format of SciPy, transposed.
+ *
+ * @param mst Minimum spanning tree of n points (3 x (n - 1)).
+ * @param dendrogram Matrix to store the dendrogram in (4 x (n - 1)).
+ */
+void SingleLinkageDendrogram(const arma::mat& mst, arma::mat& dendrogram);
+
+/**
+ * Compute the flat clustering found by cutting the single-linkage dendrogram at
+ * the given distance: two points are in the same cluster if they are joined by
+ * a path of MST edges that are no longer than the distance.  The clusters are
+ * numbered in order of their lowest point index.
+ *
+ * @param mst Minimum spanning tree of n points (3 x (n - 1)).
+ * @param distance Distance to cut the dendrogram at.
+ * @param assignments Vector to store the cluster of each point in.
+ * @return The number of clusters.
+ */
+size_t CutAtDistance(const arma::mat& mst,
+                     const double distance,
+                     arma::Row<size_t>& assignments);
+
+/**
+ * Compute the flat clustering with the given number of clusters found by
+ * cutting the single-linkage dendrogram: the longest (numClusters - 1) edges of
+ * the MST are removed, and each remaining connected component is a cluster.
+ * The clusters are numbered in order of their lowest point index.  If several
+ * edges have the same length, the ones that come first in the MST are kept.
+ *
+ * @param mst Minimum spanning tree of n points (3 x (n - 1)).
+ * @param numClusters Number of clusters (between 1 and n).
+ * @param assignments Vector to store the cluster of each point in.
+ */
+void CutToClusters(const arma::mat& mst,
+                   const size_t numClusters,
+                   arma::Row<size_t>& assignments);
+
+} // namespace emst
+} // namespace mlpack
+
+#endif
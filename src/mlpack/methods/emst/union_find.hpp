@@ -16,6 +16,7 @@
 #define MLPACK_METHODS_EMST_UNION_FIND_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <atomic>
 
 namespace mlpack {
 namespace emst {
@@ -26,11 +27,20 @@ namespace emst {
  * initially in its own component.  Calling Union(x, y) unites the components
  * indexed by x and y.  Find(x) returns the index of the component containing
  * point x.
+ *
+ * Find() and Union() may be called by several threads at once.  Find() does not
+ * take any lock: the parents are stored as atomic values, and paths are
+ * compressed by path halving (each visited element is pointed to its
+ * grandparent), which is safe under concurrent use because an element's parent
+ * is only ever replaced by one of its ancestors.  Union() is serialized, so the
+ * choice of the new root (by rank) is the same as in a serial run.
  */
 class UnionFind
 {
  private:
-  arma::Col<size_t> parent;
+  //! The parent of each element; roots are their own parents.
+  std::vector<std::atomic<size_t>> parent;
+  //! The rank of each root.  Only accessed by Union().
   arma::ivec rank;
 
  public:
@@ -39,7 +49,7 @@ class UnionFind
   {
     for (size_t i = 0; i < size; ++i)
     {
-      parent[i] = i;
+      parent[i].store(i, std::memory_order_relaxed);
       rank[i] = 0;
     }
   }
@@ -53,18 +63,22 @@ class UnionFind
    * @param x the component to be found
    * @return The index of the component containing x
    */
-  size_t Find(const size_t x)
+  size_t Find(size_t x)
   {
-    if (parent[x] == x)
-    {
-      return x;
-    }
-    else
+    size_t p = parent[x].load(std::memory_order_relaxed);
+    while (p != x)
     {
-      // This ensures that the tree has a small depth
-      parent[x] = Find(parent[x]);
-      return parent[x];
+      // Point x to its grandparent; this ensures that the tree has a small
+      // depth.
+      const size_t grandparent = parent[p].load(std::memory_order_relaxed);
+      if (grandparent != p)
+        parent[x].store(grandparent, std::memory_order_relaxed);
+
+      x = p;
+      p = grandparent;
     }
+
+    return x;
   }
 
   /**
@@ -75,25 +89,28 @@ class UnionFind
    */
   void Union(const size_t x, const size_t y)
   {
-    const size_t xRoot = Find(x);
-    const size_t yRoot = Find(y);
-
-    if (xRoot == yRoot)
+    #pragma omp critical(UnionFindUnion)
     {
-      return;
-    }
-    else if (rank[xRoot] == rank[yRoot])
-    {
-      parent[yRoot] = parent[xRoot];
-      rank[xRoot] = rank[xRoot] + 1;
-    }
-    else if (rank[xRoot] > rank[yRoot])
-    {
-      parent[yRoot] = xRoot;
-    }
-    else
-    {
-      parent[xRoot] = yRoot;
+      const size_t xRoot = Find(x);
+      const size_t yRoot = Find(y);
+
+      if (xRoot == yRoot)
+      {
+        // Nothing to do.
+      }
+      else if (rank[xRoot] == rank[yRoot])
+      {
+        parent[yRoot].store(xRoot, std::memory_order_relaxed);
+        rank[xRoot] = rank[xRoot] + 1;
+      }
+      else if (rank[xRoot] > rank[yRoot])
+      {
+        parent[yRoot].store(xRoot, std::memory_order_relaxed);
+      }
+      else
+      {
+        parent[xRoot].store(yRoot, std::memory_order_relaxed);
+      }
     }
   }
 }; // class UnionFind
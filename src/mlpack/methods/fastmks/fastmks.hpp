@@ -15,8 +15,11 @@
 
 #include <mlpack/prereqs.hpp>
 #include <mlpack/core/metrics/ip_metric.hpp>
+#include <mlpack/core/kernels/kernel_traits.hpp>
+#include <mlpack/core/kernels/kernel_matrix.hpp>
 #include "fastmks_stat.hpp"
 #include <mlpack/core/tree/cover_tree.hpp>
+#include <mlpack/core/tree/traversal_statistics.hpp>
 #include <queue>
 
 namespace mlpack {
@@ -48,6 +51,17 @@ namespace fastmks /** Fast max-kernel search. */ {
  * on points in the dataset (and not centroids of regions or anything like
  * that).
  *
+ * Naive (brute-force) search is run in parallel over the query points.  If the
+ * kernel is a function of the inner product only (that is, if
+ * KernelTraits<KernelType>::IsInnerProductKernel is true, as for the linear,
+ * polynomial and hyperbolic tangent kernels), naive search computes the kernel
+ * values between blocks of query points and blocks of reference points with a
+ * single matrix product, so that most of the work is done by BLAS.  Tree-based
+ * search is not parallel, because the rules store bounds in the tree nodes
+ * during the traversal.  The self-kernels of the reference points are computed
+ * once and reused by every tree-based search, until the model is trained
+ * again.
+ *
  * @tparam KernelType Type of kernel to run FastMKS with.
  * @tparam MatType Type of data matrix (usually arma::mat).
  * @tparam TreeType Type of tree to run FastMKS with; it must satisfy the
@@ -248,6 +262,17 @@ class FastMKS
   //! Modify whether or not brute-force (naive) search is used.
   bool& Naive() { return naive; }
 
+  //! Get the number of threads used for naive search (0 means the OpenMP
+  //! default).
+  size_t NumThreads() const { return numThreads; }
+  //! Modify the number of threads used for naive search (0 means the OpenMP
+  //! default, and 1 disables parallel search).
+  size_t& NumThreads() { return numThreads; }
+
+  //! Get the statistics of the traversal (base cases, scores, prunes and
+  //! times) of the last search.
+  const tree::TraversalStatistics& Statistics() const { return statistics; }
+
   //! Serialize the model.
   template<typename Archive>
   void Serialize(Archive& ar, const unsigned int /* version */);
@@ -267,10 +292,71 @@ class FastMKS
   bool singleMode;
   //! If true, naive (brute-force) search is used.
   bool naive;
+  //! The number of threads to use for naive search (0 means the OpenMP
+  //! default).
+  size_t numThreads;
 
   //! The instantiated inner-product metric induced by the given kernel.
   metric::IPMetric<KernelType> metric;
 
+  //! The statistics of the last search.
+  tree::TraversalStatistics statistics;
+
+  //! The square roots of the self-kernels of the reference points, computed by
+  //! ReferenceSelfKernels() when first needed.  Empty if they have not been
+  //! computed for the current reference set yet.
+  arma::vec referenceSelfKernels;
+
+  //! Return the square roots of the self-kernels of the reference points,
+  //! computing them if necessary.
+  const arma::vec& ReferenceSelfKernels();
+
+  //! Return the number of threads to use for naive search.
+  size_t Threads() const;
+
+  /**
+   * Find the k points in the reference set with maximum kernel value to each
+   * point of the query set by brute force, in parallel over the query points.
+   * This version is used for kernels that kernel::KernelMatrix() evaluates
+   * with matrix products (kernels of the inner product or of the distance
+   * only, and the cosine distance); it computes the kernel values between
+   * blocks of points at once.
+   *
+   * @param querySet Set of query points.
+   * @param k Number of maximum kernels to find.
+   * @param indices Matrix to store resulting indices in (k x n).
+   * @param kernels Matrix to store resulting kernel values in (k x n).
+   * @param sameSet If true, the query set is the reference set, and no point
+   *     is returned as its own candidate.
+   */
+  template<typename KT = KernelType>
+  typename std::enable_if<kernel::HasFastKernelMatrix<KT>::value>::type
+  BruteForceSearch(const MatType& querySet,
+                   const size_t k,
+                   arma::Mat<size_t>& indices,
+                   arma::mat& kernels,
+                   const bool sameSet);
+
+  /**
+   * Find the k points in the reference set with maximum kernel value to each
+   * point of the query set by brute force, in parallel over the query points.
+   * This version evaluates the kernel for one pair of points at a time.
+   *
+   * @param querySet Set of query points.
+   * @param k Number of maximum kernels to find.
+   * @param indices Matrix to store resulting indices in (k x n).
+   * @param kernels Matrix to store resulting kernel values in (k x n).
+   * @param sameSet If true, the query set is the reference set, and no point
+   *     is returned as its own candidate.
+   */
+  template<typename KT = KernelType>
+  typename std::enable_if<!kernel::HasFastKernelMatrix<KT>::value>::type
+  BruteForceSearch(const MatType& querySet,
+                   const size_t k,
+                   arma::Mat<size_t>& indices,
+                   arma::mat& kernels,
+                   const bool sameSet);
+
   //! Candidate represents a possible candidate point (value, index).
   typedef std::pair<double, size_t> Candidate;
 
@@ -35,7 +35,8 @@ FastMKS<KernelType, MatType, TreeType>::FastMKS(const bool singleMode,
     treeOwner(true),
     setOwner(true),
     singleMode(singleMode),
-    naive(naive)
+    naive(naive),
+    numThreads(0)
 {
   Timer::Start("tree_building");
   if (!naive)
@@ -58,7 +59,8 @@ FastMKS<KernelType, MatType, TreeType>::FastMKS(
     treeOwner(true),
     setOwner(false),
     singleMode(singleMode),
-    naive(naive)
+    naive(naive),
+    numThreads(0)
 {
   Timer::Start("tree_building");
   if (!naive)
@@ -82,6 +84,7 @@ FastMKS<KernelType, MatType, TreeType>::FastMKS(const MatType& referenceSet,
     setOwner(false),
     singleMode(singleMode),
     naive(naive),
+    numThreads(0),
     metric(kernel)
 {
   Timer::Start("tree_building");
@@ -107,6 +110,7 @@ FastMKS<KernelType, MatType, TreeType>::FastMKS(Tree* referenceTree,
     setOwner(false),
     singleMode(singleMode),
     naive(false),
+    numThreads(0),
     metric(referenceTree->Metric())
 {
   // Nothing to do.
@@ -124,7 +128,9 @@ FastMKS<KernelType, MatType, TreeType>::FastMKS(const FastMKS& other) :
     setOwner(other.referenceTree == NULL),
     singleMode(other.singleMode),
     naive(other.naive),
-    metric(other.metric)
+    numThreads(other.numThreads),
+    metric(other.metric),
+    referenceSelfKernels(other.referenceSelfKernels)
 {
   // Set reference set correctly.
   if (referenceTree)
@@ -145,7 +151,9 @@ FastMKS<KernelType, MatType, TreeType>::FastMKS(FastMKS&& other) :
     setOwner(other.setOwner),
     singleMode(other.singleMode),
     naive(other.naive),
-    metric(std::move(other.metric))
+    numThreads(other.numThreads),
+    metric(std::move(other.metric)),
+    referenceSelfKernels(std::move(other.referenceSelfKernels))
 {
   // Clear information from the other.
   other.referenceSet = NULL;
@@ -189,6 +197,11 @@ FastMKS<KernelType, MatType, TreeType>::operator=(const FastMKS& other)
 
   singleMode = other.singleMode;
   naive = other.naive;
+  numThreads = other.numThreads;
+  metric = other.metric;
+  referenceSelfKernels = other.referenceSelfKernels;
+
+  return *this;
 }
 
 template<typename KernelType,
@@ -217,6 +230,7 @@ void FastMKS<KernelType, MatType, TreeType>::Train(const MatType& referenceSet)
 
   this->referenceSet = &referenceSet;
   this->setOwner = false;
+  referenceSelfKernels.reset();
 
   if (!naive)
   {
@@ -241,6 +255,7 @@ void FastMKS<KernelType, MatType, TreeType>::Train(const MatType& referenceSet,
   this->referenceSet = &referenceSet;
   this->metric = metric::IPMetric<KernelType>(kernel);
   this->setOwner = false;
+  referenceSelfKernels.reset();
 
   if (!naive)
   {
@@ -268,6 +283,7 @@ void FastMKS<KernelType, MatType, TreeType>::Train(Tree* tree)
   this->referenceSet = &tree->Dataset();
   this->metric = metric::IPMetric<KernelType>(tree->Metric().Kernel());
   this->setOwner = false;
+  referenceSelfKernels.reset();
 
   if (treeOwner && referenceTree)
     delete referenceTree;
@@ -296,6 +312,7 @@ void FastMKS<KernelType, MatType, TreeType>::Search(
   }
 
   Timer::Start("computing_products");
+  statistics.Reset();
 
   // No remapping will be necessary because we are using the cover tree.
   indices.set_size(k, querySet.n_cols);
@@ -304,33 +321,11 @@ void FastMKS<KernelType, MatType, TreeType>::Search(
   // Naive implementation.
   if (naive)
   {
-    // Simple double loop.  Stupid, slow, but a good benchmark.
-    for (size_t q = 0; q < querySet.n_cols; ++q)
     {
-      const Candidate def = std::make_pair(-DBL_MAX, size_t() - 1);
-      std::vector<Candidate> cList(k, def);
-      CandidateList pqueue(CandidateCmp(), std::move(cList));
-
-      for (size_t r = 0; r < referenceSet->n_cols; ++r)
-      {
-        const double eval = metric.Kernel().Evaluate(querySet.col(q),
-                                                     referenceSet->col(r));
-
-        if (eval > pqueue.top().first)
-        {
-          Candidate c = std::make_pair(eval, r);
-          pqueue.pop();
-          pqueue.push(c);
-        }
-      }
-
-      for (size_t j = 1; j <= k; j++)
-      {
-        indices(k - j, q) = pqueue.top().second;
-        kernels(k - j, q) = pqueue.top().first;
-        pqueue.pop();
-      }
+      tree::TraversalStatistics::PhaseTimer timer(statistics.TraversalTime());
+      BruteForceSearch(querySet, k, indices, kernels, false);
     }
+    statistics.BaseCases() = querySet.n_cols * referenceSet->n_cols;
 
     Timer::Stop("computing_products");
 
@@ -340,15 +335,21 @@ void FastMKS<KernelType, MatType, TreeType>::Search(
   // Single-tree implementation.
   if (singleMode)
   {
-    // Create rules object (this will store the results).  This constructor
-    // precalculates each self-kernel value.
+    // Create rules object (this will store the results).  The reference
+    // self-kernels are cached; the query self-kernels are computed here.
     typedef FastMKSRules<KernelType, Tree> RuleType;
-    RuleType rules(*referenceSet, querySet, k, metric.Kernel());
+    RuleType rules(*referenceSet, querySet, k, metric.Kernel(),
+        &ReferenceSelfKernels());
 
     typename Tree::template SingleTreeTraverser<RuleType> traverser(rules);
 
-    for (size_t i = 0; i < querySet.n_cols; ++i)
-      traverser.Traverse(i, *referenceTree);
+    {
+      tree::TraversalStatistics::PhaseTimer timer(statistics.TraversalTime());
+      for (size_t i = 0; i < querySet.n_cols; ++i)
+        traverser.Traverse(i, *referenceTree);
+    }
+    statistics.AddRules(rules);
+    statistics.AddTraverser(traverser);
 
     Log::Info << rules.BaseCases() << " base cases." << std::endl;
     Log::Info << rules.Scores() << " scores." << std::endl;
@@ -363,10 +364,17 @@ void FastMKS<KernelType, MatType, TreeType>::Search(
   // assuming it doesn't map anything...
   Timer::Stop("computing_products");
   Timer::Start("tree_building");
-  Tree queryTree(querySet);
+  double treeBuildingTime = 0.0;
+  Tree* queryTree;
+  {
+    tree::TraversalStatistics::PhaseTimer timer(treeBuildingTime);
+    queryTree = new Tree(querySet);
+  }
   Timer::Stop("tree_building");
 
-  Search(&queryTree, k, indices, kernels);
+  Search(queryTree, k, indices, kernels);
+  statistics.TreeBuildingTime() += treeBuildingTime;
+  delete queryTree;
 }
 
 template<typename KernelType,
@@ -400,12 +408,19 @@ void FastMKS<KernelType, MatType, TreeType>::Search(
   kernels.set_size(k, queryTree->Dataset().n_cols);
 
   Timer::Start("computing_products");
+  statistics.Reset();
   typedef FastMKSRules<KernelType, Tree> RuleType;
-  RuleType rules(*referenceSet, queryTree->Dataset(), k, metric.Kernel());
+  RuleType rules(*referenceSet, queryTree->Dataset(), k, metric.Kernel(),
+      &ReferenceSelfKernels());
 
   typename Tree::template DualTreeTraverser<RuleType> traverser(rules);
 
-  traverser.Traverse(*queryTree, *referenceTree);
+  {
+    tree::TraversalStatistics::PhaseTimer timer(statistics.TraversalTime());
+    traverser.Traverse(*queryTree, *referenceTree);
+  }
+  statistics.AddRules(rules);
+  statistics.AddTraverser(traverser);
 
   Log::Info << rules.BaseCases() << " base cases." << std::endl;
   Log::Info << rules.Scores() << " scores." << std::endl;
@@ -427,42 +442,18 @@ void FastMKS<KernelType, MatType, TreeType>::Search(
 {
   // No remapping will be necessary because we are using the cover tree.
   Timer::Start("computing_products");
+  statistics.Reset();
   indices.set_size(k, referenceSet->n_cols);
   kernels.set_size(k, referenceSet->n_cols);
 
   // Naive implementation.
   if (naive)
   {
-    // Simple double loop.  Stupid, slow, but a good benchmark.
-    for (size_t q = 0; q < referenceSet->n_cols; ++q)
     {
-      const Candidate def = std::make_pair(-DBL_MAX, size_t() - 1);
-      std::vector<Candidate> cList(k, def);
-      CandidateList pqueue(CandidateCmp(), std::move(cList));
-
-      for (size_t r = 0; r < referenceSet->n_cols; ++r)
-      {
-        if (q == r)
-          continue; // Don't return the point as its own candidate.
-
-        const double eval = metric.Kernel().Evaluate(referenceSet->col(q),
-                                                     referenceSet->col(r));
-
-        if (eval > pqueue.top().first)
-        {
-          Candidate c = std::make_pair(eval, r);
-          pqueue.pop();
-          pqueue.push(c);
-        }
-      }
-
-      for (size_t j = 1; j <= k; j++)
-      {
-        indices(k - j, q) = pqueue.top().second;
-        kernels(k - j, q) = pqueue.top().first;
-        pqueue.pop();
-      }
+      tree::TraversalStatistics::PhaseTimer timer(statistics.TraversalTime());
+      BruteForceSearch(*referenceSet, k, indices, kernels, true);
     }
+    statistics.BaseCases() = referenceSet->n_cols * referenceSet->n_cols;
 
     Timer::Stop("computing_products");
 
@@ -472,15 +463,21 @@ void FastMKS<KernelType, MatType, TreeType>::Search(
   // Single-tree implementation.
   if (singleMode)
   {
-    // Create rules object (this will store the results).  This constructor
-    // precalculates each self-kernel value.
+    // Create rules object (this will store the results).  The cached
+    // self-kernels are used for both the query and the reference points.
     typedef FastMKSRules<KernelType, Tree> RuleType;
-    RuleType rules(*referenceSet, *referenceSet, k, metric.Kernel());
+    RuleType rules(*referenceSet, *referenceSet, k, metric.Kernel(),
+        &ReferenceSelfKernels());
 
     typename Tree::template SingleTreeTraverser<RuleType> traverser(rules);
 
-    for (size_t i = 0; i < referenceSet->n_cols; ++i)
-      traverser.Traverse(i, *referenceTree);
+    {
+      tree::TraversalStatistics::PhaseTimer timer(statistics.TraversalTime());
+      for (size_t i = 0; i < referenceSet->n_cols; ++i)
+        traverser.Traverse(i, *referenceTree);
+    }
+    statistics.AddRules(rules);
+    statistics.AddTraverser(traverser);
 
     // Save the number of pruned nodes.
     const size_t numPrunes = traverser.NumPrunes();
@@ -502,6 +499,189 @@ void FastMKS<KernelType, MatType, TreeType>::Search(
   Search(referenceTree, k, indices, kernels);
 }
 
+template<typename KernelType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+const arma::vec&
+FastMKS<KernelType, MatType, TreeType>::ReferenceSelfKernels()
+{
+  if (referenceSelfKernels.n_elem != referenceSet->n_cols)
+  {
+    referenceSelfKernels.set_size(referenceSet->n_cols);
+    for (size_t i = 0; i < referenceSet->n_cols; ++i)
+      referenceSelfKernels[i] = sqrt(metric.Kernel().Evaluate(
+          referenceSet->col(i), referenceSet->col(i)));
+  }
+
+  return referenceSelfKernels;
+}
+
+template<typename KernelType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+size_t FastMKS<KernelType, MatType, TreeType>::Threads() const
+{
+#ifdef HAS_OPENMP
+  return (numThreads == 0) ? omp_get_max_threads() : numThreads;
+#else
+  return 1;
+#endif
+}
+
+template<typename KernelType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+template<typename KT>
+typename std::enable_if<kernel::HasFastKernelMatrix<KT>::value>::type
+FastMKS<KernelType, MatType, TreeType>::BruteForceSearch(
+    const MatType& querySet,
+    const size_t k,
+    arma::Mat<size_t>& indices,
+    arma::mat& kernels,
+    const bool sameSet)
+{
+  // The query points are split into blocks, which are the units of work of
+  // the threads.  Each block is compared with one block of reference points at
+  // a time, so the matrix of kernel values stays small.
+  const size_t queryBlockSize = 256;
+  const size_t referenceBlockSize = 2048;
+  const size_t numBlocks = (querySet.n_cols + queryBlockSize - 1) /
+      queryBlockSize;
+
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables. If we're building for Visual Studio, use
+  // the intmax_t type instead.
+  #pragma omp parallel for schedule(dynamic) num_threads(Threads())
+  for (intmax_t b = 0; b < (intmax_t) numBlocks; ++b)
+#else
+  #pragma omp parallel for schedule(dynamic) num_threads(Threads())
+  for (size_t b = 0; b < numBlocks; ++b)
+#endif
+  {
+    const size_t queryBegin = (size_t) b * queryBlockSize;
+    const size_t queryEnd = std::min(queryBegin + queryBlockSize,
+        (size_t) querySet.n_cols);
+
+    const Candidate def = std::make_pair(-DBL_MAX, size_t() - 1);
+    std::vector<Candidate> cList(k, def);
+    std::vector<CandidateList> pqueues(queryEnd - queryBegin,
+        CandidateList(CandidateCmp(), cList));
+
+    // Use the memory of the query block without copying it.
+    const arma::mat queryBlock(const_cast<double*>(querySet.colptr(queryBegin)),
+        querySet.n_rows, queryEnd - queryBegin, false, true);
+
+    arma::mat products;
+    for (size_t referenceBegin = 0; referenceBegin < referenceSet->n_cols;
+         referenceBegin += referenceBlockSize)
+    {
+      const size_t referenceEnd = std::min(referenceBegin + referenceBlockSize,
+          (size_t) referenceSet->n_cols);
+
+      // products(r, q) holds K(q, r) for the points of the two blocks.
+      const arma::mat referenceBlock(
+          const_cast<double*>(referenceSet->colptr(referenceBegin)),
+          referenceSet->n_rows, referenceEnd - referenceBegin, false, true);
+      kernel::KernelMatrix(metric.Kernel(), referenceBlock, queryBlock,
+          products);
+
+      for (size_t q = queryBegin; q < queryEnd; ++q)
+      {
+        CandidateList& pqueue = pqueues[q - queryBegin];
+        const double* evals = products.colptr(q - queryBegin);
+        for (size_t r = referenceBegin; r < referenceEnd; ++r)
+        {
+          if (sameSet && q == r)
+            continue; // Don't return the point as its own candidate.
+
+          const double eval = evals[r - referenceBegin];
+          if (eval > pqueue.top().first)
+          {
+            Candidate c = std::make_pair(eval, r);
+            pqueue.pop();
+            pqueue.push(c);
+          }
+        }
+      }
+    }
+
+    // Each block writes its own columns of the results.
+    for (size_t q = queryBegin; q < queryEnd; ++q)
+    {
+      CandidateList& pqueue = pqueues[q - queryBegin];
+      for (size_t j = 1; j <= k; j++)
+      {
+        indices(k - j, q) = pqueue.top().second;
+        kernels(k - j, q) = pqueue.top().first;
+        pqueue.pop();
+      }
+    }
+  }
+}
+
+template<typename KernelType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+template<typename KT>
+typename std::enable_if<!kernel::HasFastKernelMatrix<KT>::value>::type
+FastMKS<KernelType, MatType, TreeType>::BruteForceSearch(
+    const MatType& querySet,
+    const size_t k,
+    arma::Mat<size_t>& indices,
+    arma::mat& kernels,
+    const bool sameSet)
+{
+  // Simple double loop.  Stupid, slow, but a good benchmark.  Each query point
+  // is independent, so the outer loop is run in parallel.
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables. If we're building for Visual Studio, use
+  // the intmax_t type instead.
+  #pragma omp parallel for schedule(dynamic, 16) num_threads(Threads())
+  for (intmax_t q = 0; q < (intmax_t) querySet.n_cols; ++q)
+#else
+  #pragma omp parallel for schedule(dynamic, 16) num_threads(Threads())
+  for (size_t q = 0; q < querySet.n_cols; ++q)
+#endif
+  {
+    const Candidate def = std::make_pair(-DBL_MAX, size_t() - 1);
+    std::vector<Candidate> cList(k, def);
+    CandidateList pqueue(CandidateCmp(), std::move(cList));
+
+    for (size_t r = 0; r < referenceSet->n_cols; ++r)
+    {
+      if (sameSet && (size_t) q == r)
+        continue; // Don't return the point as its own candidate.
+
+      const double eval = metric.Kernel().Evaluate(querySet.col(q),
+                                                   referenceSet->col(r));
+
+      if (eval > pqueue.top().first)
+      {
+        Candidate c = std::make_pair(eval, r);
+        pqueue.pop();
+        pqueue.push(c);
+      }
+    }
+
+    for (size_t j = 1; j <= k; j++)
+    {
+      indices(k - j, q) = pqueue.top().second;
+      kernels(k - j, q) = pqueue.top().first;
+      pqueue.pop();
+    }
+  }
+}
+
 //! Serialize the model.
 template<typename KernelType,
          typename MatType,
@@ -519,6 +699,10 @@ void FastMKS<KernelType, MatType, TreeType>::Serialize(
   ar & CreateNVP(naive, "naive");
   ar & CreateNVP(singleMode, "singleMode");
 
+  // The cached self-kernels are not serialized.
+  if (Archive::is_loading::value)
+    referenceSelfKernels.reset();
+
   // If we are doing naive search, serialize the dataset.  Otherwise we
   // serialize the tree.
   if (naive)
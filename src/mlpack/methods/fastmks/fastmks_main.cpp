@@ -72,6 +72,8 @@ PARAM_INT_IN("k", "Number of maximum kernels to find.", "k", 0);
 PARAM_FLAG("naive", "If true, O(n^2) naive mode is used for computation.", "N");
 PARAM_FLAG("single", "If true, single-tree search is used (as opposed to "
     "dual-tree search.", "S");
+PARAM_INT_IN("threads", "Number of threads to use for naive search (if 0, the "
+    "OpenMP default is used).", "T", 0);
 
 PARAM_MATRIX_OUT("kernels", "Output matrix of kernels.", "p");
 PARAM_UMATRIX_OUT("indices", "Output matrix of indices.", "i");
@@ -136,6 +138,11 @@ int main(int argc, char** argv)
   if (CLI::HasParam("naive") && CLI::HasParam("single"))
     Log::Warn << "--single ignored because --naive is present." << endl;
 
+  const int threads = CLI::GetParam<int>("threads");
+  if (threads < 0)
+    Log::Fatal << "Invalid number of threads: " << threads << ".  Must be 0 or "
+        << "greater." << endl;
+
   FastMKSModel model;
   arma::mat referenceData;
   if (CLI::HasParam("reference"))
@@ -211,6 +218,7 @@ int main(int argc, char** argv)
   // Set search preferences.
   model.Naive() = CLI::HasParam("naive");
   model.SingleMode() = CLI::HasParam("single");
+  model.NumThreads() = size_t(threads);
 
   // Should we do search?
   if (CLI::HasParam("k"))
@@ -42,11 +42,16 @@ class FastMKSRules
    * @param querySet Set of query data.
    * @param k Number of candidates to search for.
    * @param kernel Kernel to run FastMKS with.
+   * @param referenceSelfKernels If given, the precomputed square roots of the
+   *     self-kernels of the reference points, which are used instead of being
+   *     computed again.  The vector must outlive the rules object.  If the
+   *     query set is the reference set, they are used for the query points too.
    */
   FastMKSRules(const typename TreeType::Mat& referenceSet,
                const typename TreeType::Mat& querySet,
                const size_t k,
-               KernelType& kernel);
+               KernelType& kernel,
+               const arma::vec* referenceSelfKernels = NULL);
 
   /**
    * Store the list of candidates for each query point in the given matrices.
@@ -23,7 +23,8 @@ FastMKSRules<KernelType, TreeType>::FastMKSRules(
     const typename TreeType::Mat& referenceSet,
     const typename TreeType::Mat& querySet,
     const size_t k,
-    KernelType& kernel) :
+    KernelType& kernel,
+    const arma::vec* referenceSelfKernels) :
     referenceSet(referenceSet),
     querySet(querySet),
     k(k),
@@ -34,16 +35,34 @@ FastMKSRules<KernelType, TreeType>::FastMKSRules(
     baseCases(0),
     scores(0)
 {
-  // Precompute each self-kernel.
-  queryKernels.set_size(querySet.n_cols);
-  for (size_t i = 0; i < querySet.n_cols; ++i)
-    queryKernels[i] = sqrt(kernel.Evaluate(querySet.col(i),
-                                           querySet.col(i)));
-
-  referenceKernels.set_size(referenceSet.n_cols);
-  for (size_t i = 0; i < referenceSet.n_cols; ++i)
-    referenceKernels[i] = sqrt(kernel.Evaluate(referenceSet.col(i),
-                                               referenceSet.col(i)));
+  // Precompute each self-kernel, unless the reference self-kernels were
+  // given; in that case we only make an alias of them.
+  if (referenceSelfKernels)
+  {
+    referenceKernels = arma::vec(const_cast<double*>(
+        referenceSelfKernels->memptr()), referenceSelfKernels->n_elem, false,
+        false);
+  }
+  else
+  {
+    referenceKernels.set_size(referenceSet.n_cols);
+    for (size_t i = 0; i < referenceSet.n_cols; ++i)
+      referenceKernels[i] = sqrt(kernel.Evaluate(referenceSet.col(i),
+                                                 referenceSet.col(i)));
+  }
+
+  if (referenceSelfKernels && (&querySet == &referenceSet))
+  {
+    queryKernels = arma::vec(referenceKernels.memptr(), referenceKernels.n_elem,
+        false, false);
+  }
+  else
+  {
+    queryKernels.set_size(querySet.n_cols);
+    for (size_t i = 0; i < querySet.n_cols; ++i)
+      queryKernels[i] = sqrt(kernel.Evaluate(querySet.col(i),
+                                             querySet.col(i)));
+  }
 
   // Set to invalid memory, so that the first node combination does not try to
   // dereference null pointers.
@@ -0,0 +1,171 @@
+/**
+ * @file diagonal_em_fit.hpp
+ *
+ * Utility class to fit a GMM with diagonal covariances (a DiagonalGMM) using
+ * the EM algorithm.  Used by DiagonalGMM::Train<>().
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_GMM_DIAGONAL_EM_FIT_HPP
+#define MLPACK_METHODS_GMM_DIAGONAL_EM_FIT_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/dists/diagonal_gaussian_distribution.hpp>
+
+// Default clustering mechanism.
+#include <mlpack/methods/kmeans/kmeans.hpp>
+// Constraint on the variances.
+#include "positive_definite_constraint.hpp"
+
+namespace mlpack {
+namespace gmm {
+
+/**
+ * This class fits a GMM with diagonal covariances to observations using the EM
+ * algorithm, like EMFit does for full covariances.  The sufficient statistics
+ * of each component are the sum of its responsibilities, and the weighted sums
+ * of the observations and of their squares (centered on the current mean), so
+ * they take O(d) memory per component instead of the O(d^2) of a scatter
+ * matrix.  The responsibilities are computed in log-space and accumulated
+ * directly into the statistics, and blocks of observations are processed in
+ * parallel when OpenMP is available.  The variances are constrained as by
+ * PositiveDefiniteConstraint.
+ *
+ * The initial clustering mechanism (by default, KMeans) must implement the
+ * following method:
+ *
+ *  - void Cluster(const arma::mat& observations,
+ *                 const size_t clusters,
+ *                 arma::Row<size_t>& assignments);
+ */
+template<typename InitialClusteringType = kmeans::KMeans<>>
+class DiagonalEMFit
+{
+ public:
+  /**
+   * Construct the DiagonalEMFit object, optionally passing an
+   * InitialClusteringType object (just in case it needs to store state).
+   * Setting the maximum number of iterations to 0 means that the EM algorithm
+   * will iterate until convergence (with the given tolerance).
+   *
+   * @param maxIterations Maximum number of iterations for EM.
+   * @param tolerance Log-likelihood tolerance required for convergence.
+   * @param clusterer Object which will perform the initial clustering.
+   */
+  DiagonalEMFit(const size_t maxIterations = 300,
+                const double tolerance = 1e-10,
+                InitialClusteringType clusterer = InitialClusteringType());
+
+  /**
+   * Fit the observations to a GMM with diagonal covariances using the EM
+   * algorithm.  The size of the vectors (indicating the number of components)
+   * must already be set.  Optionally, if useInitialModel is set to true, then
+   * the given model is used as the initial model, instead of using the
+   * InitialClusteringType::Cluster() option.
+   *
+   * @param observations List of observations to train on.
+   * @param dists Vector to store the trained components in.
+   * @param weights Vector to store a priori weights in.
+   * @param useInitialModel If true, the given model is used for the initial
+   *      clustering.
+   */
+  void Estimate(const arma::mat& observations,
+                std::vector<distribution::DiagonalGaussianDistribution>& dists,
+                arma::vec& weights,
+                const bool useInitialModel = false);
+
+  /**
+   * Fit the observations to a GMM with diagonal covariances using the EM
+   * algorithm, taking into account the probabilities of each point being from
+   * this mixture.  The size of the vectors (indicating the number of
+   * components) must already be set.
+   *
+   * @param observations List of observations to train on.
+   * @param probabilities Probability of each point being from this model.
+   * @param dists Vector to store the trained components in.
+   * @param weights Vector to store a priori weights in.
+   * @param useInitialModel If true, the given model is used for the initial
+   *      clustering.
+   */
+  void Estimate(const arma::mat& observations,
+                const arma::vec& probabilities,
+                std::vector<distribution::DiagonalGaussianDistribution>& dists,
+                arma::vec& weights,
+                const bool useInitialModel = false);
+
+  //! Get the clusterer.
+  const InitialClusteringType& Clusterer() const { return clusterer; }
+  //! Modify the clusterer.
+  InitialClusteringType& Clusterer() { return clusterer; }
+
+  //! Get the maximum number of iterations of the EM algorithm.
+  size_t MaxIterations() const { return maxIterations; }
+  //! Modify the maximum number of iterations of the EM algorithm.
+  size_t& MaxIterations() { return maxIterations; }
+
+  //! Get the tolerance for the convergence of the EM algorithm.
+  double Tolerance() const { return tolerance; }
+  //! Modify the tolerance for the convergence of the EM algorithm.
+  double& Tolerance() { return tolerance; }
+
+  //! Serialize the fitter.
+  template<typename Archive>
+  void Serialize(Archive& ar, const unsigned int version);
+
+  //! The number of observations each thread processes at once.
+  static const size_t ObservationBlockSize = 1024;
+
+ private:
+  /**
+   * Run the clusterer, and then turn the cluster assignments into Gaussians.
+   * The vectors must be already set to the number of clusters.
+   *
+   * @param observations List of observations.
+   * @param dists Vector to store the components in.
+   * @param weights Vector to store a priori weights in.
+   */
+  void InitialClustering(
+      const arma::mat& observations,
+      std::vector<distribution::DiagonalGaussianDistribution>& dists,
+      arma::vec& weights);
+
+  /**
+   * Run one iteration of the EM algorithm, updating the model.
+   *
+   * @param observations List of observations.
+   * @param probabilities Probability of each observation being from this
+   *     model, or NULL if they are all 1.
+   * @param dists Components of the model.
+   * @param weights A priori weights of the components.
+   * @return The log-likelihood of the model before the update.
+   */
+  double Iterate(const arma::mat& observations,
+                 const arma::vec* probabilities,
+                 std::vector<distribution::DiagonalGaussianDistribution>& dists,
+                 arma::vec& weights);
+
+  //! Run the EM algorithm until convergence; this is the body of both
+  //! overloads of Estimate().
+  void Fit(const arma::mat& observations,
+           const arma::vec* probabilities,
+           std::vector<distribution::DiagonalGaussianDistribution>& dists,
+           arma::vec& weights);
+
+  //! Maximum iterations of EM algorithm.
+  size_t maxIterations;
+  //! Tolerance for convergence of EM.
+  double tolerance;
+  //! Object which will perform the clustering.
+  InitialClusteringType clusterer;
+};
+
+} // namespace gmm
+} // namespace mlpack
+
+// Include implementation.
+#include "diagonal_em_fit_impl.hpp"
+
+#endif
@@ -0,0 +1,310 @@
+/**
+ * @file diagonal_em_fit_impl.hpp
+ *
+ * Implementation of the EM algorithm for fitting GMMs with diagonal
+ * covariances.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_GMM_DIAGONAL_EM_FIT_IMPL_HPP
+#define MLPACK_METHODS_GMM_DIAGONAL_EM_FIT_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "diagonal_em_fit.hpp"
+
+namespace mlpack {
+namespace gmm {
+
+//! Constructor.
+template<typename InitialClusteringType>
+DiagonalEMFit<InitialClusteringType>::DiagonalEMFit(
+    const size_t maxIterations,
+    const double tolerance,
+    InitialClusteringType clusterer) :
+    maxIterations(maxIterations),
+    tolerance(tolerance),
+    clusterer(clusterer)
+{ /* Nothing to do. */ }
+
+template<typename InitialClusteringType>
+void DiagonalEMFit<InitialClusteringType>::Estimate(
+    const arma::mat& observations,
+    std::vector<distribution::DiagonalGaussianDistribution>& dists,
+    arma::vec& weights,
+    const bool useInitialModel)
+{
+  // Only perform initial clustering if the user wanted it.
+  if (!useInitialModel)
+    InitialClustering(observations, dists, weights);
+
+  Fit(observations, NULL, dists, weights);
+}
+
+template<typename InitialClusteringType>
+void DiagonalEMFit<InitialClusteringType>::Estimate(
+    const arma::mat& observations,
+    const arma::vec& probabilities,
+    std::vector<distribution::DiagonalGaussianDistribution>& dists,
+    arma::vec& weights,
+    const bool useInitialModel)
+{
+  if (!useInitialModel)
+    InitialClustering(observations, dists, weights);
+
+  Fit(observations, &probabilities, dists, weights);
+}
+
+template<typename InitialClusteringType>
+void DiagonalEMFit<InitialClusteringType>::Fit(
+    const arma::mat& observations,
+    const arma::vec* probabilities,
+    std::vector<distribution::DiagonalGaussianDistribution>& dists,
+    arma::vec& weights)
+{
+  // Each iteration computes the log-likelihood of the model it starts from, so
+  // the convergence check lags one update behind.
+  double lOld = -DBL_MAX;
+  size_t iteration = 1;
+  while (iteration != maxIterations)
+  {
+    const double l = Iterate(observations, probabilities, dists, weights);
+    if (iteration == 1)
+    {
+      Log::Debug << "DiagonalEMFit::Estimate(): initial clustering "
+          << "log-likelihood: " << l << std::endl;
+    }
+    else
+    {
+      Log::Info << "DiagonalEMFit::Estimate(): iteration " << iteration
+          << ", log-likelihood " << l << "." << std::endl;
+    }
+
+    if (std::abs(l - lOld) <= tolerance)
+      break;
+
+    lOld = l;
+    iteration++;
+  }
+}
+
+template<typename InitialClusteringType>
+double DiagonalEMFit<InitialClusteringType>::Iterate(
+    const arma::mat& observations,
+    const arma::vec* probabilities,
+    std::vector<distribution::DiagonalGaussianDistribution>& dists,
+    arma::vec& weights)
+{
+  const size_t components = dists.size();
+  const arma::vec logWeights = arma::log(weights);
+
+  // The statistics are centered on the current means, which keeps the sums of
+  // squares accurate when the data is far from the origin.
+  arma::mat centers(observations.n_rows, components);
+  for (size_t k = 0; k < components; ++k)
+    centers.col(k) = dists[k].Mean();
+
+  arma::vec totals(components, arma::fill::zeros);
+  arma::mat sums(observations.n_rows, components, arma::fill::zeros);
+  arma::mat squares(observations.n_rows, components, arma::fill::zeros);
+
+#ifdef HAS_OPENMP
+  const size_t numThreads = omp_get_max_threads();
+#else
+  const size_t numThreads = 1;
+#endif
+
+  // The first thread accumulates into the statistics above, and every other
+  // thread into its own copies, which are added together afterwards.
+  std::vector<arma::vec> threadTotals(numThreads - 1,
+      arma::vec(components, arma::fill::zeros));
+  std::vector<arma::mat> threadSums(numThreads - 1,
+      arma::mat(observations.n_rows, components, arma::fill::zeros));
+  std::vector<arma::mat> threadSquares(numThreads - 1,
+      arma::mat(observations.n_rows, components, arma::fill::zeros));
+  std::vector<double> threadLogLikelihoods(numThreads, 0.0);
+  size_t zeroLikelihoods = 0;
+
+  const size_t numBlocks = (observations.n_cols + ObservationBlockSize - 1) /
+      ObservationBlockSize;
+
+  #pragma omp parallel num_threads(numThreads) reduction(+:zeroLikelihoods)
+  {
+#ifdef HAS_OPENMP
+    const size_t thread = omp_get_thread_num();
+#else
+    const size_t thread = 0;
+#endif
+    arma::vec& localTotals = (thread == 0) ? totals : threadTotals[thread - 1];
+    arma::mat& localSums = (thread == 0) ? sums : threadSums[thread - 1];
+    arma::mat& localSquares = (thread == 0) ? squares :
+        threadSquares[thread - 1];
+
+    arma::vec logProbabilities;
+
+    // Every block costs the same, and a fixed split of the blocks between the
+    // threads keeps the results reproducible.
+#ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables. If we're building for Visual Studio,
+    // use the intmax_t type instead.
+    #pragma omp for schedule(static)
+    for (intmax_t b = 0; b < (intmax_t) numBlocks; ++b)
+#else
+    #pragma omp for schedule(static)
+    for (size_t b = 0; b < numBlocks; ++b)
+#endif
+    {
+      const size_t begin = b * ObservationBlockSize;
+      const size_t end = std::min(begin + ObservationBlockSize,
+          (size_t) observations.n_cols);
+      const arma::mat block = observations.cols(begin, end - 1);
+
+      // The log of the weighted probability of each observation of the block
+      // under each component.
+      arma::mat responsibilities(components, block.n_cols);
+      for (size_t k = 0; k < components; ++k)
+      {
+        dists[k].LogProbability(block, logProbabilities);
+        responsibilities.row(k) = logWeights[k] + logProbabilities.t();
+      }
+
+      // Normalize each column with the log-sum-exp trick.
+      for (size_t j = 0; j < block.n_cols; ++j)
+      {
+        const double maxLog = responsibilities.col(j).max();
+        if (maxLog == -std::numeric_limits<double>::infinity())
+        {
+          // The observation has no probability under any component, so it
+          // contributes nothing to the statistics.
+          ++zeroLikelihoods;
+          threadLogLikelihoods[thread] += maxLog;
+          responsibilities.col(j).zeros();
+          continue;
+        }
+
+        const double logLikelihood = maxLog + std::log(arma::accu(
+            arma::exp(responsibilities.col(j) - maxLog)));
+        threadLogLikelihoods[thread] += logLikelihood;
+        responsibilities.col(j) = arma::exp(responsibilities.col(j) -
+            logLikelihood);
+
+        if (probabilities)
+          responsibilities.col(j) *= (*probabilities)[begin + j];
+      }
+
+      localTotals += arma::sum(responsibilities, 1);
+      for (size_t k = 0; k < components; ++k)
+      {
+        const arma::mat centered = block.each_col() - centers.col(k);
+        localSums.col(k) += centered * responsibilities.row(k).t();
+        localSquares.col(k) += arma::square(centered) *
+            responsibilities.row(k).t();
+      }
+    }
+  }
+
+  // Add the statistics of the other threads, in a fixed order so that the
+  // result doesn't depend on the scheduling.
+  double logLikelihood = threadLogLikelihoods[0];
+  for (size_t t = 0; t < numThreads - 1; ++t)
+  {
+    totals += threadTotals[t];
+    sums += threadSums[t];
+    squares += threadSquares[t];
+    logLikelihood += threadLogLikelihoods[t + 1];
+  }
+
+  if (zeroLikelihoods > 0)
+  {
+    Log::Info << "The likelihood of " << zeroLikelihoods << " points is 0!  "
+        << "They are probably outliers." << std::endl;
+  }
+
+  // Compute the new model.  A component whose responsibilities sum to 0 is
+  // left unchanged.
+  for (size_t k = 0; k < components; ++k)
+  {
+    if (totals[k] == 0.0)
+      continue;
+
+    // The mean, relative to the center.
+    const arma::vec shift = sums.col(k) / totals[k];
+    arma::vec covariance = squares.col(k) / totals[k] - arma::square(shift);
+    dists[k].Mean() = centers.col(k) + shift;
+
+    PositiveDefiniteConstraint::ApplyConstraint(covariance);
+    dists[k].Covariance(std::move(covariance));
+  }
+
+  weights = totals / (probabilities ? arma::accu(*probabilities) :
+      (double) observations.n_cols);
+
+  return logLikelihood;
+}
+
+template<typename InitialClusteringType>
+void DiagonalEMFit<InitialClusteringType>::InitialClustering(
+    const arma::mat& observations,
+    std::vector<distribution::DiagonalGaussianDistribution>& dists,
+    arma::vec& weights)
+{
+  // Assignments from clustering.
+  arma::Row<size_t> assignments;
+
+  // Run clustering algorithm.
+  clusterer.Cluster(observations, dists.size(), assignments);
+
+  arma::mat means(observations.n_rows, dists.size(), arma::fill::zeros);
+  arma::mat covs(observations.n_rows, dists.size(), arma::fill::zeros);
+
+  // From the assignments, generate our means and weights.
+  weights.zeros(dists.size());
+  for (size_t i = 0; i < observations.n_cols; ++i)
+  {
+    means.col(assignments[i]) += observations.col(i);
+    weights[assignments[i]]++;
+  }
+
+  for (size_t k = 0; k < dists.size(); ++k)
+    means.col(k) /= (weights[k] > 1) ? weights[k] : 1;
+
+  // Then the variances, around the means.
+  for (size_t i = 0; i < observations.n_cols; ++i)
+  {
+    covs.col(assignments[i]) += arma::square(observations.col(i) -
+        means.col(assignments[i]));
+  }
+
+  for (size_t k = 0; k < dists.size(); ++k)
+  {
+    arma::vec covariance = covs.col(k) / ((weights[k] > 1) ? weights[k] : 1);
+    PositiveDefiniteConstraint::ApplyConstraint(covariance);
+
+    dists[k].Mean() = means.col(k);
+    dists[k].Covariance(std::move(covariance));
+  }
+
+  // Finally, normalize weights.
+  weights /= arma::accu(weights);
+}
+
+template<typename InitialClusteringType>
+template<typename Archive>
+void DiagonalEMFit<InitialClusteringType>::Serialize(
+    Archive& ar,
+    const unsigned int /* version */)
+{
+  using data::CreateNVP;
+
+  ar & CreateNVP(maxIterations, "maxIterations");
+  ar & CreateNVP(tolerance, "tolerance");
+  ar & CreateNVP(clusterer, "clusterer");
+}
+
+} // namespace gmm
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,165 @@
+/**
+ * @file diagonal_gmm.cpp
+ *
+ * Implementation of the non-template methods of DiagonalGMM.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "diagonal_gmm.hpp"
+
+namespace mlpack {
+namespace gmm {
+
+DiagonalGMM::DiagonalGMM(const size_t gaussians, const size_t dimensionality) :
+    gaussians(gaussians),
+    dimensionality(dimensionality),
+    dists(gaussians,
+        distribution::DiagonalGaussianDistribution(dimensionality)),
+    weights(gaussians)
+{
+  // Set equal weights.  Technically this model is still valid, but only barely.
+  weights.fill(1.0 / gaussians);
+}
+
+double DiagonalGMM::Probability(const arma::vec& observation) const
+{
+  // Sum the probability for each Gaussian in our mixture (and we have to
+  // multiply by the prior for each Gaussian too).
+  double sum = 0;
+  for (size_t i = 0; i < gaussians; i++)
+    sum += weights[i] * dists[i].Probability(observation);
+
+  return sum;
+}
+
+double DiagonalGMM::Probability(const arma::vec& observation,
+                                const size_t component) const
+{
+  return weights[component] * dists[component].Probability(observation);
+}
+
+arma::vec DiagonalGMM::Random() const
+{
+  // Determine which Gaussian it will be coming from.
+  double gaussRand = math::Random();
+  size_t gaussian = 0;
+
+  double sumProb = 0;
+  for (size_t g = 0; g < gaussians; g++)
+  {
+    sumProb += weights(g);
+    if (gaussRand <= sumProb)
+    {
+      gaussian = g;
+      break;
+    }
+  }
+
+  return dists[gaussian].Random();
+}
+
+void DiagonalGMM::Classify(const arma::mat& observations,
+                           arma::Row<size_t>& labels) const
+{
+  LogProbability(observations, dists, weights, NULL, &labels);
+}
+
+double DiagonalGMM::LogLikelihood(
+    const arma::mat& observations,
+    const std::vector<distribution::DiagonalGaussianDistribution>& distsL,
+    const arma::vec& weightsL) const
+{
+  arma::vec logProbabilities;
+  LogProbability(observations, distsL, weightsL, &logProbabilities, NULL);
+  return arma::accu(logProbabilities);
+}
+
+void DiagonalGMM::LogProbability(const arma::mat& observations,
+                                 arma::vec& logProbabilities) const
+{
+  LogProbability(observations, dists, weights, &logProbabilities, NULL);
+}
+
+void DiagonalGMM::Probability(const arma::mat& observations,
+                              arma::vec& probabilities) const
+{
+  LogProbability(observations, dists, weights, &probabilities, NULL);
+  probabilities = arma::exp(probabilities);
+}
+
+void DiagonalGMM::LogProbability(
+    const arma::mat& observations,
+    const std::vector<distribution::DiagonalGaussianDistribution>& distsL,
+    const arma::vec& weightsL,
+    arma::vec* logProbabilities,
+    arma::Row<size_t>* labels)
+{
+  const size_t blockSize =
+      distribution::DiagonalGaussianDistribution::ObservationBlockSize;
+  const size_t numBlocks = (observations.n_cols + blockSize - 1) / blockSize;
+  const arma::vec logWeights = arma::log(weightsL);
+  if (logProbabilities)
+    logProbabilities->set_size(observations.n_cols);
+  if (labels)
+    labels->set_size(observations.n_cols);
+
+  // Each block is no larger than the blocks of
+  // DiagonalGaussianDistribution::LogProbability(), so that it doesn't start
+  // threads of its own.
+  #pragma omp parallel if (numBlocks > 1)
+  {
+    arma::vec componentLogProbabilities;
+    arma::mat blockLogProbabilities;
+
+#ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables. If we're building for Visual Studio,
+    // use the intmax_t type instead.
+    #pragma omp for schedule(static)
+    for (intmax_t b = 0; b < (intmax_t) numBlocks; ++b)
+#else
+    #pragma omp for schedule(static)
+    for (size_t b = 0; b < numBlocks; ++b)
+#endif
+    {
+      const size_t begin = b * blockSize;
+      const size_t end = std::min(begin + blockSize,
+          (size_t) observations.n_cols);
+      const arma::mat block = observations.cols(begin, end - 1);
+
+      blockLogProbabilities.set_size(distsL.size(), block.n_cols);
+      for (size_t k = 0; k < distsL.size(); ++k)
+      {
+        distsL[k].LogProbability(block, componentLogProbabilities);
+        blockLogProbabilities.row(k) = logWeights[k] +
+            componentLogProbabilities.t();
+      }
+
+      for (size_t j = 0; j < block.n_cols; ++j)
+      {
+        arma::uword best = 0;
+        const double maxLog = blockLogProbabilities.col(j).max(best);
+        if (labels)
+          (*labels)[begin + j] = best;
+        if (!logProbabilities)
+          continue;
+
+        // Sum over the components with the log-sum-exp trick.
+        if (maxLog == -std::numeric_limits<double>::infinity())
+        {
+          (*logProbabilities)[begin + j] = maxLog;
+          continue;
+        }
+
+        (*logProbabilities)[begin + j] = maxLog + std::log(arma::accu(
+            arma::exp(blockLogProbabilities.col(j) - maxLog)));
+      }
+    }
+  }
+}
+
+} // namespace gmm
+} // namespace mlpack
@@ -0,0 +1,264 @@
+/**
+ * @file diagonal_gmm.hpp
+ *
+ * Defines a Gaussian mixture model whose components have diagonal
+ * covariances, and estimates the parameters of the model.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_GMM_DIAGONAL_GMM_HPP
+#define MLPACK_METHODS_GMM_DIAGONAL_GMM_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/dists/diagonal_gaussian_distribution.hpp>
+
+// This is the default fitting method class.
+#include "diagonal_em_fit.hpp"
+
+namespace mlpack {
+namespace gmm {
+
+/**
+ * A Gaussian Mixture Model whose components have diagonal covariances.  This
+ * is the same model as a GMM trained with the DiagonalConstraint, but each
+ * component (a DiagonalGaussianDistribution) stores only its mean and its
+ * variances, so the model takes O(kd) memory instead of O(kd^2), and the
+ * log probability of an observation under a component costs O(d) instead of
+ * O(d^2).  With hundreds of dimensions, this makes both the model and the
+ * E-step of EM smaller by about a factor of d.
+ *
+ * The FittingType template class of Train() must provide the same functions as
+ * for GMM, with std::vector<distribution::DiagonalGaussianDistribution>
+ * components; the default is DiagonalEMFit.
+ *
+ * Example use:
+ *
+ * @code
+ * // Set up a mixture of 1024 Gaussians in a 512-dimensional space.
+ * DiagonalGMM g(1024, 512);
+ *
+ * // Train the GMM given the data observations, using the default EM fitting
+ * // mechanism.
+ * g.Train(data);
+ *
+ * // Get the log probability of each observation under this GMM.
+ * arma::vec logProbabilities;
+ * g.LogProbability(observations, logProbabilities);
+ * @endcode
+ */
+class DiagonalGMM
+{
+ private:
+  //! The number of Gaussians in the model.
+  size_t gaussians;
+  //! The dimensionality of the model.
+  size_t dimensionality;
+
+  //! Vector of Gaussians
+  std::vector<distribution::DiagonalGaussianDistribution> dists;
+
+  //! Vector of a priori weights for each Gaussian.
+  arma::vec weights;
+
+ public:
+  /**
+   * Create an empty Gaussian Mixture Model, with zero gaussians.
+   */
+  DiagonalGMM() :
+      gaussians(0),
+      dimensionality(0)
+  { /* Nothing to do. */ }
+
+  /**
+   * Create a GMM with the given number of Gaussians, each of which have the
+   * specified dimensionality.  The means will be set to 0 and the variances to
+   * 1.
+   *
+   * @param gaussians Number of Gaussians in this GMM.
+   * @param dimensionality Dimensionality of each Gaussian.
+   */
+  DiagonalGMM(const size_t gaussians, const size_t dimensionality);
+
+  /**
+   * Create a GMM with the given dists and weights.
+   *
+   * @param dists Distributions of the model.
+   * @param weights Weights of the model.
+   */
+  DiagonalGMM(
+      const std::vector<distribution::DiagonalGaussianDistribution>& dists,
+      const arma::vec& weights) :
+      gaussians(dists.size()),
+      dimensionality((!dists.empty()) ? dists[0].Mean().n_elem : 0),
+      dists(dists),
+      weights(weights) { /* Nothing to do. */ }
+
+  //! Return the number of gaussians in the model.
+  size_t Gaussians() const { return gaussians; }
+  //! Return the dimensionality of the model.
+  size_t Dimensionality() const { return dimensionality; }
+
+  /**
+   * Return a const reference to a component distribution.
+   *
+   * @param i index of component.
+   */
+  const distribution::DiagonalGaussianDistribution& Component(size_t i) const
+  { return dists[i]; }
+  /**
+   * Return a reference to a component distribution.
+   *
+   * @param i index of component.
+   */
+  distribution::DiagonalGaussianDistribution& Component(size_t i)
+  { return dists[i]; }
+
+  //! Return a const reference to the a priori weights of each Gaussian.
+  const arma::vec& Weights() const { return weights; }
+  //! Return a reference to the a priori weights of each Gaussian.
+  arma::vec& Weights() { return weights; }
+
+  /**
+   * Return the probability that the given observation came from this
+   * distribution.
+   *
+   * @param observation Observation to evaluate the probability of.
+   */
+  double Probability(const arma::vec& observation) const;
+
+  /**
+   * Return the probability that the given observation came from the given
+   * Gaussian component in this distribution.
+   *
+   * @param observation Observation to evaluate the probability of.
+   * @param component Index of the component of the GMM to be considered.
+   */
+  double Probability(const arma::vec& observation,
+                     const size_t component) const;
+
+  /**
+   * Compute the log probability of each of the given observations (columns)
+   * under this GMM.  The observations are processed in blocks, in parallel
+   * when OpenMP is available, and summed over the components with the
+   * log-sum-exp trick.
+   *
+   * @param observations List of observations.
+   * @param logProbabilities Output log probability of each observation.
+   */
+  void LogProbability(const arma::mat& observations,
+                      arma::vec& logProbabilities) const;
+
+  /**
+   * Compute the probability of each of the given observations (columns) under
+   * this GMM.  This is the exponential of LogProbability().
+   *
+   * @param observations List of observations.
+   * @param probabilities Output probability of each observation.
+   */
+  void Probability(const arma::mat& observations,
+                   arma::vec& probabilities) const;
+
+  /**
+   * Return a randomly generated observation according to the probability
+   * distribution defined by this object.
+   *
+   * @return Random observation from this GMM.
+   */
+  arma::vec Random() const;
+
+  /**
+   * Estimate the probability distribution directly from the given observations,
+   * using the given algorithm in the FittingType class to fit the data.  The
+   * fitting is performed 'trials' times (in parallel when OpenMP is available,
+   * as for GMM::Train()), and the model with the greatest log-likelihood is
+   * kept.
+   *
+   * @tparam FittingType The type of fitting method which should be used
+   *     (DiagonalEMFit<> is suggested).
+   * @param observations Observations of the model.
+   * @param trials Number of trials to perform; the model in these trials with
+   *      the greatest log-likelihood will be selected.
+   * @param useExistingModel If true, the existing model is used as an initial
+   *      model for the estimation.
+   * @return The log-likelihood of the best fit.
+   */
+  template<typename FittingType = DiagonalEMFit<>>
+  double Train(const arma::mat& observations,
+               const size_t trials = 1,
+               const bool useExistingModel = false,
+               FittingType fitter = FittingType());
+
+  /**
+   * Estimate the probability distribution directly from the given observations,
+   * taking into account the probability of each observation actually being from
+   * this distribution, and using the given algorithm in the FittingType class
+   * to fit the data.  The fitting is performed 'trials' times, and the model
+   * with the greatest log-likelihood is kept.
+   *
+   * @param observations Observations of the model.
+   * @param probabilities Probability of each observation being from this
+   *     distribution.
+   * @param trials Number of trials to perform; the model in these trials with
+   *     the greatest log-likelihood will be selected.
+   * @param useExistingModel If true, the existing model is used as an initial
+   *     model for the estimation.
+   * @return The log-likelihood of the best fit.
+   */
+  template<typename FittingType = DiagonalEMFit<>>
+  double Train(const arma::mat& observations,
+               const arma::vec& probabilities,
+               const size_t trials = 1,
+               const bool useExistingModel = false,
+               FittingType fitter = FittingType());
+
+  /**
+   * Classify the given observations as being from an individual component in
+   * this GMM: each label is the component with the greatest weighted
+   * probability, between 0 and (Gaussians() - 1).
+   *
+   * @param observations List of observations to classify.
+   * @param labels Object which will be filled with labels.
+   */
+  void Classify(const arma::mat& observations,
+                arma::Row<size_t>& labels) const;
+
+  /**
+   * Serialize the GMM.
+   */
+  template<typename Archive>
+  void Serialize(Archive& ar, const unsigned int /* version */);
+
+ private:
+  /**
+   * Compute the log-likelihood of the given observations under the given
+   * model.  This is used by Train().
+   */
+  double LogLikelihood(
+      const arma::mat& observations,
+      const std::vector<distribution::DiagonalGaussianDistribution>& distsL,
+      const arma::vec& weightsL) const;
+
+  /**
+   * For each of the given observations, compute its log probability under the
+   * given model (if logProbabilities isn't NULL) and the component with the
+   * greatest weighted probability (if labels isn't NULL).  This is used by
+   * LogProbability(), Classify() and LogLikelihood().
+   */
+  static void LogProbability(
+      const arma::mat& observations,
+      const std::vector<distribution::DiagonalGaussianDistribution>& distsL,
+      const arma::vec& weightsL,
+      arma::vec* logProbabilities,
+      arma::Row<size_t>* labels);
+};
+
+} // namespace gmm
+} // namespace mlpack
+
+// Include implementation.
+#include "diagonal_gmm_impl.hpp"
+
+#endif
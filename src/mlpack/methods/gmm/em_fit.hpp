@@ -21,6 +21,7 @@
 #include <mlpack/methods/kmeans/kmeans.hpp>
 // Default covariance matrix constraint.
 #include "positive_definite_constraint.hpp"
+#include "em_statistics.hpp"
 
 namespace mlpack {
 namespace gmm {
@@ -148,19 +149,29 @@ class EMFit
                          arma::vec& weights);
 
   /**
-   * Calculate the log-likelihood of a model.  Yes, this is reimplemented in the
-   * GMM code.  Intuition suggests that the log-likelihood is not the best way
-   * to determine if the EM algorithm has converged.
+   * Run one iteration of the EM algorithm, updating the model.  The
+   * responsibilities are accumulated into EMStatistics, so no matrix of
+   * responsibilities for all observations is ever held in memory, and blocks
+   * of observations are processed in parallel when OpenMP is available.
    *
-   * @param data Data matrix.
-   * @param means Vector of means.
-   * @param covariances Vector of covariance matrices.
-   * @param weights Vector of a priori weights.
+   * @param observations List of observations.
+   * @param probabilities Probability of each observation being from this
+   *     model, or NULL if they are all 1.
+   * @param dists Components of the model.
+   * @param weights A priori weights of the components.
+   * @return The log-likelihood of the model before the update.
    */
-  double LogLikelihood(const arma::mat& data,
-                       const std::vector<distribution::GaussianDistribution>&
-                           dists,
-                       const arma::vec& weights) const;
+  double Iterate(const arma::mat& observations,
+                 const arma::vec* probabilities,
+                 std::vector<distribution::GaussianDistribution>& dists,
+                 arma::vec& weights);
+
+  //! Run the EM algorithm until convergence; this is the body of both
+  //! overloads of Estimate().
+  void Fit(const arma::mat& observations,
+           const arma::vec* probabilities,
+           std::vector<distribution::GaussianDistribution>& dists,
+           arma::vec& weights);
 
   //! Maximum iterations of EM algorithm.
   size_t maxIterations;
@@ -0,0 +1,183 @@
+/**
+ * @file em_statistics.cpp
+ *
+ * Implementation of the sufficient statistics accumulated by the EM algorithm.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "em_statistics.hpp"
+
+using namespace mlpack;
+using namespace mlpack::gmm;
+using namespace mlpack::distribution;
+
+void EMStatistics::Reset(const arma::mat& centers)
+{
+  this->centers = centers;
+  totals.zeros(centers.n_cols);
+  sums.zeros(centers.n_rows, centers.n_cols);
+  scatters.zeros(centers.n_rows, centers.n_rows, centers.n_cols);
+}
+
+void EMStatistics::Reset(const std::vector<GaussianDistribution>& dists)
+{
+  arma::mat means(dists.empty() ? 0 : dists[0].Dimensionality(),
+      dists.size());
+  for (size_t k = 0; k < dists.size(); ++k)
+    means.col(k) = dists[k].Mean();
+
+  Reset(means);
+}
+
+void EMStatistics::Reset(const std::vector<GaussianDistribution>& dists,
+                         const arma::vec& weights)
+{
+  // Centered on the means, the sums are 0 and the scatter matrices are the
+  // weighted covariances.
+  Reset(dists);
+  totals = weights / arma::accu(weights);
+  for (size_t k = 0; k < dists.size(); ++k)
+    scatters.slice(k) = totals[k] * dists[k].Covariance();
+}
+
+double EMStatistics::Accumulate(const arma::mat& observations,
+                                const arma::vec* probabilities,
+                                const std::vector<GaussianDistribution>& dists,
+                                const arma::vec& weights)
+{
+  const size_t components = dists.size();
+  const arma::vec logWeights = arma::log(weights);
+
+#ifdef HAS_OPENMP
+  const size_t numThreads = omp_get_max_threads();
+#else
+  const size_t numThreads = 1;
+#endif
+
+  // The first thread accumulates into these statistics, and every other
+  // thread into its own copies, which are added together afterwards.
+  std::vector<arma::vec> threadTotals(numThreads - 1,
+      arma::vec(totals.n_elem, arma::fill::zeros));
+  std::vector<arma::mat> threadSums(numThreads - 1,
+      arma::mat(sums.n_rows, sums.n_cols, arma::fill::zeros));
+  std::vector<arma::cube> threadScatters(numThreads - 1,
+      arma::cube(scatters.n_rows, scatters.n_cols, scatters.n_slices,
+      arma::fill::zeros));
+  std::vector<double> threadLogLikelihoods(numThreads, 0.0);
+  size_t zeroLikelihoods = 0;
+
+  const size_t numBlocks = (observations.n_cols + ObservationBlockSize - 1) /
+      ObservationBlockSize;
+
+  #pragma omp parallel num_threads(numThreads) reduction(+:zeroLikelihoods)
+  {
+#ifdef HAS_OPENMP
+    const size_t thread = omp_get_thread_num();
+#else
+    const size_t thread = 0;
+#endif
+    arma::vec& localTotals = (thread == 0) ? totals : threadTotals[thread - 1];
+    arma::mat& localSums = (thread == 0) ? sums : threadSums[thread - 1];
+    arma::cube& localScatters = (thread == 0) ? scatters :
+        threadScatters[thread - 1];
+
+    arma::vec logProbabilities;
+
+    // Every block costs the same, and a fixed split of the blocks between the
+    // threads keeps the results reproducible.
+#ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables. If we're building for Visual Studio,
+    // use the intmax_t type instead.
+    #pragma omp for schedule(static)
+    for (intmax_t b = 0; b < (intmax_t) numBlocks; ++b)
+#else
+    #pragma omp for schedule(static)
+    for (size_t b = 0; b < numBlocks; ++b)
+#endif
+    {
+      const size_t begin = b * ObservationBlockSize;
+      const size_t end = std::min(begin + ObservationBlockSize,
+          (size_t) observations.n_cols);
+      const arma::mat block = observations.cols(begin, end - 1);
+
+      // The log of the weighted probability of each observation of the block
+      // under each component.
+      arma::mat responsibilities(components, block.n_cols);
+      for (size_t k = 0; k < components; ++k)
+      {
+        dists[k].LogProbability(block, logProbabilities);
+        responsibilities.row(k) = logWeights[k] + logProbabilities.t();
+      }
+
+      // Normalize each column with the log-sum-exp trick.
+      for (size_t j = 0; j < block.n_cols; ++j)
+      {
+        const double maxLog = responsibilities.col(j).max();
+        if (maxLog == -std::numeric_limits<double>::infinity())
+        {
+          // The observation has no probability under any component, so it
+          // contributes nothing to the statistics.
+          ++zeroLikelihoods;
+          threadLogLikelihoods[thread] += maxLog;
+          responsibilities.col(j).zeros();
+          continue;
+        }
+
+        const double logLikelihood = maxLog + std::log(arma::accu(
+            arma::exp(responsibilities.col(j) - maxLog)));
+        threadLogLikelihoods[thread] += logLikelihood;
+        responsibilities.col(j) = arma::exp(responsibilities.col(j) -
+            logLikelihood);
+
+        if (probabilities)
+          responsibilities.col(j) *= (*probabilities)[begin + j];
+      }
+
+      localTotals += arma::sum(responsibilities, 1);
+      for (size_t k = 0; k < components; ++k)
+      {
+        const arma::mat centered = block.each_col() - centers.col(k);
+        localSums.col(k) += centered * responsibilities.row(k).t();
+        localScatters.slice(k) += (centered.each_row() %
+            responsibilities.row(k)) * centered.t();
+      }
+    }
+  }
+
+  // Add the statistics of the other threads, in a fixed order so that the
+  // result doesn't depend on the scheduling.
+  double logLikelihood = threadLogLikelihoods[0];
+  for (size_t t = 0; t < numThreads - 1; ++t)
+  {
+    totals += threadTotals[t];
+    sums += threadSums[t];
+    scatters += threadScatters[t];
+    logLikelihood += threadLogLikelihoods[t + 1];
+  }
+
+  if (zeroLikelihoods > 0)
+  {
+    Log::Info << "The likelihood of " << zeroLikelihoods << " points is 0!  "
+        << "They are probably outliers." << std::endl;
+  }
+
+  return logLikelihood;
+}
+
+void EMStatistics::Scale(const double factor)
+{
+  totals *= factor;
+  sums *= factor;
+  scatters *= factor;
+}
+
+void EMStatistics::Add(const EMStatistics& other, const double factor)
+{
+  totals += factor * other.totals;
+  sums += factor * other.sums;
+  scatters += factor * other.scatters;
+}
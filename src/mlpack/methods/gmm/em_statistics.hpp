@@ -0,0 +1,178 @@
+/**
+ * @file em_statistics.hpp
+ *
+ * The sufficient statistics of a Gaussian mixture model that the EM algorithm
+ * accumulates over observations, and from which it computes the next model.
+ * Used by EMFit and OnlineEMFit.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_GMM_EM_STATISTICS_HPP
+#define MLPACK_METHODS_GMM_EM_STATISTICS_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/dists/gaussian_distribution.hpp>
+
+namespace mlpack {
+namespace gmm {
+
+/**
+ * The sufficient statistics of the components of a Gaussian mixture model:
+ * for each component, the sum of its responsibilities for the observations,
+ * the weighted sum of the observations minus a center, and the weighted
+ * scatter matrix of the observations around that center.  The centers are
+ * fixed when the statistics are reset; centering the observations on points
+ * near the means (usually the current means) keeps the scatter matrices
+ * accurate when the data is far from the origin.
+ *
+ * Accumulate() computes the responsibilities in log-space (with the log-sum-exp
+ * trick, so that observations far from every component don't underflow) and
+ * adds them to the statistics directly, so no matrix of responsibilities for
+ * all observations is ever held in memory.  When OpenMP is available, blocks
+ * of observations are processed in parallel, each thread with its own
+ * statistics, which are added together in a fixed order.
+ */
+class EMStatistics
+{
+ public:
+  //! Create empty statistics; Reset() must be called before they are used.
+  EMStatistics() { }
+
+  /**
+   * Reset the statistics to zero, centered on the given points.
+   *
+   * @param centers One center for each component.
+   */
+  void Reset(const arma::mat& centers);
+
+  /**
+   * Reset the statistics to zero, centered on the means of the given
+   * components.
+   *
+   * @param dists Components of the model.
+   */
+  void Reset(const std::vector<distribution::GaussianDistribution>& dists);
+
+  /**
+   * Set the statistics to those of the given model, that is, to the
+   * statistics from which Maximize() computes the same model again, with the
+   * responsibilities summing to 1.
+   *
+   * @param dists Components of the model.
+   * @param weights A priori weights of the components.
+   */
+  void Reset(const std::vector<distribution::GaussianDistribution>& dists,
+             const arma::vec& weights);
+
+  /**
+   * Add the statistics of the given observations under the given model (the
+   * expectation step of EM).
+   *
+   * @param observations List of observations.
+   * @param probabilities Probability of each observation being from this
+   *     model, or NULL if they are all 1.
+   * @param dists Components of the model.
+   * @param weights A priori weights of the components.
+   * @return The log-likelihood of the observations under the model.
+   */
+  double Accumulate(const arma::mat& observations,
+                    const arma::vec* probabilities,
+                    const std::vector<distribution::GaussianDistribution>&
+                        dists,
+                    const arma::vec& weights);
+
+  //! Multiply all the statistics by the given factor.
+  void Scale(const double factor);
+
+  /**
+   * Add the given statistics, multiplied by the given factor.  They must have
+   * the same centers.
+   *
+   * @param other Statistics to add.
+   * @param factor Factor to multiply them by.
+   */
+  void Add(const EMStatistics& other, const double factor);
+
+  /**
+   * Compute the model from the statistics (the maximization step of EM).  A
+   * component whose responsibilities sum to 0 is left unchanged.
+   *
+   * @param constraint Constraint to apply to each covariance matrix.
+   * @param dists Components to store the model in.
+   * @param weights Vector to store the a priori weights in.
+   * @param total Total weight of the observations; the weight of each
+   *     component is the sum of its responsibilities divided by this.
+   */
+  template<typename CovarianceConstraintPolicy>
+  void Maximize(CovarianceConstraintPolicy& constraint,
+                std::vector<distribution::GaussianDistribution>& dists,
+                arma::vec& weights,
+                const double total) const;
+
+  //! Get the centers of the statistics.
+  const arma::mat& Centers() const { return centers; }
+  //! Get the sum of the responsibilities of each component.
+  const arma::vec& Totals() const { return totals; }
+  //! Get the weighted sums of the observations minus the centers.
+  const arma::mat& Sums() const { return sums; }
+  //! Get the weighted scatter matrices of the observations around the
+  //! centers.
+  const arma::cube& Scatters() const { return scatters; }
+
+  //! Serialize the statistics.
+  template<typename Archive>
+  void Serialize(Archive& ar, const unsigned int /* version */)
+  {
+    ar & data::CreateNVP(centers, "centers");
+    ar & data::CreateNVP(totals, "totals");
+    ar & data::CreateNVP(sums, "sums");
+    ar & data::CreateNVP(scatters, "scatters");
+  }
+
+  //! The number of observations each thread processes at once.
+  static const size_t ObservationBlockSize = 1024;
+
+ private:
+  //! The center of each component.
+  arma::mat centers;
+  //! The sum of the responsibilities of each component.
+  arma::vec totals;
+  //! The weighted sum of the observations minus the center, per component.
+  arma::mat sums;
+  //! The weighted scatter matrix around the center, per component.
+  arma::cube scatters;
+};
+
+template<typename CovarianceConstraintPolicy>
+void EMStatistics::Maximize(
+    CovarianceConstraintPolicy& constraint,
+    std::vector<distribution::GaussianDistribution>& dists,
+    arma::vec& weights,
+    const double total) const
+{
+  for (size_t k = 0; k < dists.size(); ++k)
+  {
+    // Don't update if there's no probability of the Gaussian having points.
+    if (totals[k] == 0.0)
+      continue;
+
+    // The mean, relative to the center.
+    const arma::vec shift = sums.col(k) / totals[k];
+    arma::mat covariance = scatters.slice(k) / totals[k] - shift * shift.t();
+    dists[k].Mean() = centers.col(k) + shift;
+
+    // Apply covariance constraint.
+    constraint.ApplyConstraint(covariance);
+    dists[k].Covariance(std::move(covariance));
+  }
+
+  weights = totals / total;
+}
+
+} // namespace gmm
+} // namespace mlpack
+
+#endif
@@ -137,20 +137,83 @@ double GMM::LogLikelihood(
     const std::vector<distribution::GaussianDistribution>& distsL,
     const arma::vec& weightsL) const
 {
-  double loglikelihood = 0;
-  arma::vec phis;
-  arma::mat likelihoods(gaussians, data.n_cols);
+  arma::vec logProbabilities;
+  LogProbability(data, distsL, weightsL, logProbabilities);
+  return arma::accu(logProbabilities);
+}
 
-  for (size_t i = 0; i < gaussians; i++)
+void GMM::LogProbability(const arma::mat& observations,
+                         arma::vec& logProbabilities) const
+{
+  LogProbability(observations, dists, weights, logProbabilities);
+}
+
+void GMM::Probability(const arma::mat& observations,
+                      arma::vec& probabilities) const
+{
+  LogProbability(observations, dists, weights, probabilities);
+  probabilities = arma::exp(probabilities);
+}
+
+void GMM::LogProbability(
+    const arma::mat& observations,
+    const std::vector<distribution::GaussianDistribution>& distsL,
+    const arma::vec& weightsL,
+    arma::vec& logProbabilities)
+{
+  const size_t blockSize =
+      distribution::GaussianDistribution::ObservationBlockSize;
+  const size_t numBlocks = (observations.n_cols + blockSize - 1) / blockSize;
+  const arma::vec logWeights = arma::log(weightsL);
+  logProbabilities.set_size(observations.n_cols);
+
+  // Each block is no larger than the blocks of
+  // GaussianDistribution::LogProbability(), so that it doesn't start threads
+  // of its own.
+  #pragma omp parallel if (numBlocks > 1)
   {
-    distsL[i].Probability(data, phis);
-    likelihoods.row(i) = weightsL(i) * trans(phis);
-  }
+    arma::vec componentLogProbabilities;
+    arma::mat blockLogProbabilities;
+
+#ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables. If we're building for Visual Studio,
+    // use the intmax_t type instead.
+    #pragma omp for schedule(static)
+    for (intmax_t b = 0; b < (intmax_t) numBlocks; ++b)
+#else
+    #pragma omp for schedule(static)
+    for (size_t b = 0; b < numBlocks; ++b)
+#endif
+    {
+      const size_t begin = b * blockSize;
+      const size_t end = std::min(begin + blockSize,
+          (size_t) observations.n_cols);
+      const arma::mat block = observations.cols(begin, end - 1);
+
+      blockLogProbabilities.set_size(distsL.size(), block.n_cols);
+      for (size_t k = 0; k < distsL.size(); ++k)
+      {
+        distsL[k].LogProbability(block, componentLogProbabilities);
+        blockLogProbabilities.row(k) = logWeights[k] +
+            componentLogProbabilities.t();
+      }
 
-  // Now sum over every point.
-  for (size_t j = 0; j < data.n_cols; j++)
-    loglikelihood += log(accu(likelihoods.col(j)));
-  return loglikelihood;
+      // Sum over the components with the log-sum-exp trick.
+      for (size_t j = 0; j < block.n_cols; ++j)
+      {
+        const double maxLog = blockLogProbabilities.col(j).max();
+        if (maxLog == -std::numeric_limits<double>::infinity())
+        {
+          logProbabilities[begin + j] = maxLog;
+          continue;
+        }
+
+        logProbabilities[begin + j] = maxLog + std::log(arma::accu(
+            arma::exp(blockLogProbabilities.col(j) - maxLog)));
+      }
+    }
+  }
 }
 
 } // namespace gmm
@@ -175,6 +175,31 @@ class GMM
   double Probability(const arma::vec& observation,
                      const size_t component) const;
 
+  /**
+   * Compute the log probability of each of the given observations (columns)
+   * under this GMM.  The observations are processed in blocks, in parallel
+   * when OpenMP is available; for each block, the log probabilities under all
+   * of the components are computed with triangular solves against the cached
+   * Cholesky factors of their covariances, and summed over the components
+   * with the log-sum-exp trick, so that observations far from every
+   * component don't underflow.
+   *
+   * @param observations List of observations.
+   * @param logProbabilities Output log probability of each observation.
+   */
+  void LogProbability(const arma::mat& observations,
+                      arma::vec& logProbabilities) const;
+
+  /**
+   * Compute the probability of each of the given observations (columns) under
+   * this GMM.  This is the exponential of LogProbability().
+   *
+   * @param observations List of observations.
+   * @param probabilities Output probability of each observation.
+   */
+  void Probability(const arma::mat& observations,
+                   arma::vec& probabilities) const;
+
   /**
    * Return a randomly generated observation according to the probability
    * distribution defined by this object.
@@ -190,6 +215,9 @@ class GMM
    * The fitting will be performed 'trials' times; from these trials, the model
    * with the greatest log-likelihood will be selected.  By default, only one
    * trial is performed.  The log-likelihood of the best fitting is returned.
+   * Several trials are run in parallel when OpenMP is available, each with its
+   * own copy of the fitter and its own random stream (see
+   * math::TaskRandomStream()).
    *
    * Optionally, the existing model can be used as an initial model for the
    * estimation by setting 'useExistingModel' to true.  If the fitting procedure
@@ -220,6 +248,9 @@ class GMM
    * The fitting will be performed 'trials' times; from these trials, the model
    * with the greatest log-likelihood will be selected.  By default, only one
    * trial is performed.  The log-likelihood of the best fitting is returned.
+   * Several trials are run in parallel when OpenMP is available, each with its
+   * own copy of the fitter and its own random stream (see
+   * math::TaskRandomStream()).
    *
    * Optionally, the existing model can be used as an initial model for the
    * estimation by setting 'useExistingModel' to true.  If the fitting procedure
@@ -281,6 +312,21 @@ class GMM
       const arma::mat& dataPoints,
       const std::vector<distribution::GaussianDistribution>& distsL,
       const arma::vec& weights) const;
+
+  /**
+   * Compute the log probability of each of the given observations under the
+   * given model.  This is used by LogProbability() and LogLikelihood().
+   *
+   * @param observations List of observations.
+   * @param distsL Components of the model.
+   * @param weightsL Weights of the model.
+   * @param logProbabilities Output log probability of each observation.
+   */
+  static void LogProbability(
+      const arma::mat& observations,
+      const std::vector<distribution::GaussianDistribution>& distsL,
+      const arma::vec& weightsL,
+      arma::vec& logProbabilities);
 };
 
 } // namespace gmm
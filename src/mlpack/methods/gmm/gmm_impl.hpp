@@ -17,6 +17,8 @@
 // In case it hasn't already been included.
 #include "gmm.hpp"
 
+#include <mlpack/core/math/random.hpp>
+
 namespace mlpack {
 namespace gmm {
 
@@ -44,55 +46,50 @@ double GMM::Train(const arma::mat& observations,
     if (trials == 0)
       return -DBL_MAX; // It's what they asked for...
 
-    // If each trial must start from the same initial location, we must save it.
-    std::vector<distribution::GaussianDistribution> distsOrig;
-    arma::vec weightsOrig;
-    if (useExistingModel)
+    // The trials are run in parallel.  Each starts from the existing model (if
+    // requested), with its own copy of the fitter and its own random stream
+    // (see math::TaskRandomStream()), so the result depends on the random seed
+    // but not on the number of threads.
+    std::vector<std::vector<distribution::GaussianDistribution>> trialDists(
+        trials, useExistingModel ? dists :
+        std::vector<distribution::GaussianDistribution>(gaussians,
+        distribution::GaussianDistribution(dimensionality)));
+    std::vector<arma::vec> trialWeights(trials, useExistingModel ? weights :
+        arma::vec(gaussians));
+    arma::vec likelihoods(trials);
+
+#ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables. If we're building for Visual Studio,
+    // use the intmax_t type instead.
+    #pragma omp parallel for schedule(dynamic)
+    for (intmax_t trial = 0; trial < (intmax_t) trials; ++trial)
+#else
+    #pragma omp parallel for schedule(dynamic)
+    for (size_t trial = 0; trial < trials; ++trial)
+#endif
     {
-      distsOrig = dists;
-      weightsOrig = weights;
+      math::TaskRandomStreamScope scope(trial);
+      FittingType trialFitter(fitter);
+      trialFitter.Estimate(observations, trialDists[trial],
+          trialWeights[trial], useExistingModel);
+      likelihoods[trial] = LogLikelihood(observations, trialDists[trial],
+          trialWeights[trial]);
     }
 
-    // We need to keep temporary copies.  We'll do the first training into the
-    // actual model position, so that if it's the best we don't need to copy it.
-    fitter.Estimate(observations, dists, weights, useExistingModel);
-
-    bestLikelihood = LogLikelihood(observations, dists, weights);
-
-    Log::Info << "GMM::Train(): Log-likelihood of trial 0 is "
-        << bestLikelihood << "." << std::endl;
-
-    // Now the temporary model.
-    std::vector<distribution::GaussianDistribution> distsTrial(gaussians,
-        distribution::GaussianDistribution(dimensionality));
-    arma::vec weightsTrial(gaussians);
-
-    for (size_t trial = 1; trial < trials; ++trial)
+    // Keep the best trial; ties go to the first one.
+    size_t best = 0;
+    for (size_t trial = 0; trial < trials; ++trial)
     {
-      if (useExistingModel)
-      {
-        distsTrial = distsOrig;
-        weightsTrial = weightsOrig;
-      }
-
-      fitter.Estimate(observations, distsTrial, weightsTrial, useExistingModel);
-
-      // Check to see if the log-likelihood of this one is better.
-      double newLikelihood = LogLikelihood(observations, distsTrial,
-          weightsTrial);
-
       Log::Info << "GMM::Train(): Log-likelihood of trial " << trial << " is "
-          << newLikelihood << "." << std::endl;
-
-      if (newLikelihood > bestLikelihood)
-      {
-        // Save new likelihood and copy new model.
-        bestLikelihood = newLikelihood;
-
-        dists = distsTrial;
-        weights = weightsTrial;
-      }
+          << likelihoods[trial] << "." << std::endl;
+      if (likelihoods[trial] > likelihoods[best])
+        best = trial;
     }
+
+    bestLikelihood = likelihoods[best];
+    dists = std::move(trialDists[best]);
+    weights = std::move(trialWeights[best]);
   }
 
   // Report final log-likelihood and return it.
@@ -128,57 +125,50 @@ double GMM::Train(const arma::mat& observations,
     if (trials == 0)
       return -DBL_MAX; // It's what they asked for...
 
-    // If each trial must start from the same initial location, we must save it.
-    std::vector<distribution::GaussianDistribution> distsOrig;
-    arma::vec weightsOrig;
-    if (useExistingModel)
+    // The trials are run in parallel.  Each starts from the existing model (if
+    // requested), with its own copy of the fitter and its own random stream
+    // (see math::TaskRandomStream()), so the result depends on the random seed
+    // but not on the number of threads.
+    std::vector<std::vector<distribution::GaussianDistribution>> trialDists(
+        trials, useExistingModel ? dists :
+        std::vector<distribution::GaussianDistribution>(gaussians,
+        distribution::GaussianDistribution(dimensionality)));
+    std::vector<arma::vec> trialWeights(trials, useExistingModel ? weights :
+        arma::vec(gaussians));
+    arma::vec likelihoods(trials);
+
+#ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables. If we're building for Visual Studio,
+    // use the intmax_t type instead.
+    #pragma omp parallel for schedule(dynamic)
+    for (intmax_t trial = 0; trial < (intmax_t) trials; ++trial)
+#else
+    #pragma omp parallel for schedule(dynamic)
+    for (size_t trial = 0; trial < trials; ++trial)
+#endif
     {
-      distsOrig = dists;
-      weightsOrig = weights;
+      math::TaskRandomStreamScope scope(trial);
+      FittingType trialFitter(fitter);
+      trialFitter.Estimate(observations, probabilities, trialDists[trial],
+          trialWeights[trial], useExistingModel);
+      likelihoods[trial] = LogLikelihood(observations, trialDists[trial],
+          trialWeights[trial]);
     }
 
-    // We need to keep temporary copies.  We'll do the first training into the
-    // actual model position, so that if it's the best we don't need to copy it.
-    fitter.Estimate(observations, probabilities, dists, weights,
-        useExistingModel);
-
-    bestLikelihood = LogLikelihood(observations, dists, weights);
-
-    Log::Debug << "GMM::Train(): Log-likelihood of trial 0 is "
-        << bestLikelihood << "." << std::endl;
-
-    // Now the temporary model.
-    std::vector<distribution::GaussianDistribution> distsTrial(gaussians,
-        distribution::GaussianDistribution(dimensionality));
-    arma::vec weightsTrial(gaussians);
-
-    for (size_t trial = 1; trial < trials; ++trial)
+    // Keep the best trial; ties go to the first one.
+    size_t best = 0;
+    for (size_t trial = 0; trial < trials; ++trial)
     {
-      if (useExistingModel)
-      {
-        distsTrial = distsOrig;
-        weightsTrial = weightsOrig;
-      }
-
-      fitter.Estimate(observations, probabilities, distsTrial, weightsTrial,
-          useExistingModel);
-
-      // Check to see if the log-likelihood of this one is better.
-      double newLikelihood = LogLikelihood(observations, distsTrial,
-          weightsTrial);
-
       Log::Debug << "GMM::Train(): Log-likelihood of trial " << trial << " is "
-          << newLikelihood << "." << std::endl;
-
-      if (newLikelihood > bestLikelihood)
-      {
-        // Save new likelihood and copy new model.
-        bestLikelihood = newLikelihood;
-
-        dists = distsTrial;
-        weights = weightsTrial;
-      }
+          << likelihoods[trial] << "." << std::endl;
+      if (likelihoods[trial] > likelihoods[best])
+        best = trial;
     }
+
+    bestLikelihood = likelihoods[best];
+    dists = std::move(trialDists[best]);
+    weights = std::move(trialWeights[best]);
   }
 
   // Report final log-likelihood and return it.
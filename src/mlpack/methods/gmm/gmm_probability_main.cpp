@@ -43,12 +43,16 @@ int main(int argc, char** argv)
 
   arma::mat dataset = std::move(CLI::GetParam<arma::mat>("input"));
 
-  // Now calculate the probabilities.
-  arma::rowvec probabilities(dataset.n_cols);
-  for (size_t i = 0; i < dataset.n_cols; ++i)
-    probabilities[i] = gmm.Probability(dataset.unsafe_col(i));
+  if (dataset.n_rows != gmm.Dimensionality())
+    Log::Fatal << "Input data (with --input_file) has dimensionality "
+        << dataset.n_rows << ", but the model (given with --input_model_file) "
+        << "has dimensionality " << gmm.Dimensionality() << "!" << endl;
+
+  // Now calculate the probabilities of all the points at once.
+  arma::vec probabilities;
+  gmm.Probability(dataset, probabilities);
 
   // And save the result.
   if (CLI::HasParam("output"))
-    CLI::GetParam<arma::mat>("output") = std::move(probabilities);
+    CLI::GetParam<arma::mat>("output") = probabilities.t();
 }
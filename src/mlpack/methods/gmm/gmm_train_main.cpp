@@ -14,6 +14,7 @@
 
 #include "gmm.hpp"
 #include "no_constraint.hpp"
+#include "online_em_fit.hpp"
 
 #include <mlpack/methods/kmeans/refined_start.hpp>
 
@@ -43,7 +44,21 @@ PROGRAM_INFO("Gaussian Mixture Model (GMM) Training",
     "cause the program to crash."
     "\n\n"
     "Optionally, multiple trials may be performed, by specifying the --trials "
-    "option.  The model with greatest log-likelihood will be taken.");
+    "option.  The model with greatest log-likelihood will be taken.  The "
+    "trials are run in parallel when mlpack is built with OpenMP."
+    "\n\n"
+    "For datasets too large to hold in memory, the --online (-o) flag trains "
+    "the model with stepwise (online) EM instead: the input file, which must "
+    "be a text file with one point per line, is read in batches of "
+    "--batch_size (-b) points, and each batch moves the model towards it with "
+    "a step size that decays as (t + 2)^(-k), where t is the number of batches "
+    "processed and k is given with --step_decay (-k).  --max_iterations gives "
+    "the number of batches, and the file is read again from the start when "
+    "its end is reached.  With --checkpoint_interval (-c), the model is saved "
+    "to the output model file every given number of batches, and training can "
+    "be resumed by passing that file as the input model.  The --trials, "
+    "--tolerance, --noise and refined start options are ignored in online "
+    "mode.");
 
 // Parameters for training.
 PARAM_MATRIX_IN_REQ("input", "The training data on which the model will be "
@@ -73,11 +88,131 @@ PARAM_DOUBLE_IN("percentage", "If using --refined_start, specify the percentage"
     " of the dataset used for each sampling (should be between 0.0 and 1.0).",
     "p", 0.02);
 
+// Parameters for online EM.
+PARAM_FLAG("online", "Train with stepwise (online) EM on batches read from the "
+    "input file.", "o");
+PARAM_INT_IN("batch_size", "Number of points in each batch (use when --online "
+    "is specified).", "b", 1000);
+PARAM_DOUBLE_IN("step_decay", "Decay of the step size of online EM (between "
+    "0.5 and 1; use when --online is specified).", "k", 0.6);
+PARAM_INT_IN("checkpoint_interval", "If using --online, save the model to the "
+    "output model file every given number of batches (0 saves it only at the "
+    "end).", "c", 0);
+
 // Parameters for model saving/loading.
 PARAM_MODEL_IN(GMM, "input_model", "Initial input GMM model to start training "
     "with.", "m");
 PARAM_MODEL_OUT(GMM, "output_model", "Output for trained GMM model.", "M");
 
+// Train the model with the given covariance constraint using online EM,
+// reading batches from the input file and saving a checkpoint of the model
+// every --checkpoint_interval batches.
+template<typename CovarianceConstraintPolicy>
+void TrainOnline(const size_t gaussians,
+                 const size_t batchSize,
+                 const size_t maxIterations,
+                 const double stepDecay,
+                 const size_t checkpointInterval)
+{
+  const string inputFile = CLI::GetUnmappedParam<arma::mat>("input");
+  ifstream stream(inputFile.c_str());
+  if (!stream.is_open())
+    Log::Fatal << "Cannot open input file '" << inputFile << "'!" << endl;
+
+  StreamBatchSource source(stream);
+
+  std::vector<distribution::GaussianDistribution> dists(gaussians);
+  arma::vec weights(gaussians);
+  bool useInitialModel = false;
+  if (CLI::HasParam("input_model"))
+  {
+    GMM& inputModel = CLI::GetParam<GMM>("input_model");
+    if (inputModel.Gaussians() != gaussians)
+      Log::Fatal << "The initial model (given with --input_model_file) has "
+          << inputModel.Gaussians() << " Gaussians, but --gaussians is "
+          << gaussians << "!" << endl;
+
+    for (size_t i = 0; i < gaussians; ++i)
+      dists[i] = inputModel.Component(i);
+    weights = inputModel.Weights();
+    useInitialModel = true;
+  }
+
+  OnlineEMFit<CovarianceConstraintPolicy> em(batchSize, maxIterations, 2.0,
+      stepDecay);
+
+  // Process the batches in chunks of checkpointInterval batches, and save the
+  // model after each chunk.
+  const size_t chunkSize = (checkpointInterval == 0) ? maxIterations :
+      checkpointInterval;
+  Timer::Start("em");
+  try
+  {
+    for (size_t done = 0; done < maxIterations; done += chunkSize)
+    {
+      em.MaxIterations() = std::min(chunkSize, maxIterations - done);
+      em.Estimate(source, dists, weights, useInitialModel);
+      useInitialModel = true;
+
+      if (checkpointInterval != 0 && done + chunkSize < maxIterations &&
+          CLI::HasParam("output_model"))
+      {
+        Timer::Stop("em");
+        const string outputFile = CLI::GetUnmappedParam<GMM>("output_model");
+        GMM checkpoint(dists, weights);
+        data::Save(outputFile, "model", checkpoint);
+        Log::Info << "Saved model after " << done + chunkSize << " batches to '"
+            << outputFile << "'." << endl;
+        Timer::Start("em");
+      }
+    }
+  }
+  catch (std::exception& e)
+  {
+    Log::Fatal << "Online EM failed: " << e.what() << endl;
+  }
+  Timer::Stop("em");
+
+  if (CLI::HasParam("output_model"))
+    CLI::GetParam<GMM>("output_model") = GMM(dists, weights);
+}
+
+// Check the online EM parameters and train with online EM.
+void TrainOnline(const size_t gaussians)
+{
+  const int batchSize = CLI::GetParam<int>("batch_size");
+  if (batchSize <= 0)
+    Log::Fatal << "Invalid batch size (" << batchSize << ")! Must be greater "
+        << "than 0." << endl;
+
+  const int maxIterations = CLI::GetParam<int>("max_iterations");
+  if (maxIterations <= 0)
+    Log::Fatal << "Invalid number of iterations (" << maxIterations << ")! "
+        << "Online EM needs a number of batches greater than 0." << endl;
+
+  const double stepDecay = CLI::GetParam<double>("step_decay");
+  if (stepDecay <= 0.5 || stepDecay > 1.0)
+    Log::Fatal << "Step decay (" << stepDecay << ") must be greater than 0.5 "
+        << "and less than or equal to 1.0!" << endl;
+
+  const int checkpointInterval = CLI::GetParam<int>("checkpoint_interval");
+  if (checkpointInterval < 0)
+    Log::Fatal << "Invalid checkpoint interval (" << checkpointInterval
+        << ")! Must be 0 or greater." << endl;
+
+  if (CLI::HasParam("trials") || CLI::HasParam("tolerance") ||
+      CLI::HasParam("noise") || CLI::HasParam("refined_start"))
+    Log::Warn << "--trials, --tolerance, --noise and --refined_start are "
+        << "ignored when --online is specified." << endl;
+
+  if (CLI::HasParam("no_force_positive"))
+    TrainOnline<NoConstraint>(gaussians, batchSize, maxIterations, stepDecay,
+        checkpointInterval);
+  else
+    TrainOnline<PositiveDefiniteConstraint>(gaussians, batchSize,
+        maxIterations, stepDecay, checkpointInterval);
+}
+
 int main(int argc, char* argv[])
 {
   CLI::ParseCommandLine(argc, argv);
@@ -99,6 +234,13 @@ int main(int argc, char* argv[])
     Log::Warn << "--output_model_file is not specified, so no model will be "
         << "saved!" << endl;
 
+  if (CLI::HasParam("online"))
+  {
+    TrainOnline((size_t) gaussians);
+    CLI::Destroy();
+    return 0;
+  }
+
   arma::mat dataPoints = std::move(CLI::GetParam<arma::mat>("input"));
 
   // Do we need to add noise to the dataset?
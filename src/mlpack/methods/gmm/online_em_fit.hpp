@@ -0,0 +1,198 @@
+/**
+ * @file online_em_fit.hpp
+ *
+ * Utility class to fit a GMM with stepwise (online) EM on mini-batches of
+ * observations, so that the observations never have to be held in memory at
+ * once.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_GMM_ONLINE_EM_FIT_HPP
+#define MLPACK_METHODS_GMM_ONLINE_EM_FIT_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/dists/gaussian_distribution.hpp>
+#include <mlpack/methods/kmeans/batch_sources.hpp>
+#include "em_fit.hpp"
+#include "em_statistics.hpp"
+#include "positive_definite_constraint.hpp"
+
+namespace mlpack {
+namespace gmm {
+
+/**
+ * This class fits a GMM with stepwise EM (Cappé and Moulines, "Online EM
+ * algorithm for latent data models", 2009; Liang and Klein, "Online EM for
+ * unsupervised models", 2009).  Each step takes a mini-batch of observations,
+ * computes its sufficient statistics under the current model, and moves the
+ * running statistics towards them with the step size
+ *
+ *   eta_t = (t + stepOffset)^(-stepDecay),
+ *
+ * where t is the number of steps taken so far; the model is then computed
+ * from the running statistics, as in the maximization step of EM.  The step
+ * size must decay with 0.5 < stepDecay <= 1 for the model to converge.  Each
+ * step costs time proportional to the batch size, and only one batch is held
+ * in memory at a time.
+ *
+ * The observations are read from a batch source, like the ones of
+ * kmeans::MiniBatchKMeans (kmeans::MatrixBatchSource,
+ * kmeans::StreamBatchSource and kmeans::ChunkedBatchSource), which must provide
+ * the method
+ *
+ * @code
+ * size_t NextBatch(const size_t batchSize, arma::mat& batch);
+ * @endcode
+ *
+ * If no initial model is given, the model is initialized by running EMFit on
+ * the first batch.  The running statistics and the number of steps are kept
+ * between calls to Estimate() and serialized with the object, so training can
+ * be checkpointed and resumed.  Without them (for instance, when resuming from
+ * a saved GMM only), the statistics are initialized from the given model.
+ *
+ * This class can also be used as the FittingType of GMM::Train().
+ *
+ * @tparam CovarianceConstraintPolicy Constraint to apply to the covariance
+ *     matrices.
+ */
+template<typename CovarianceConstraintPolicy = PositiveDefiniteConstraint>
+class OnlineEMFit
+{
+ public:
+  /**
+   * Create the OnlineEMFit object.  A std::invalid_argument is thrown if the
+   * batch size is 0, if the step offset is negative, or if the step decay
+   * isn't in (0.5, 1].
+   *
+   * @param batchSize Number of observations in each batch.
+   * @param maxIterations Number of batches to process in each call to
+   *     Estimate().
+   * @param stepOffset Offset of the step size schedule; larger values make
+   *     the first steps smaller.
+   * @param stepDecay Decay of the step size schedule.
+   * @param constraint Constraint to apply to the covariance matrices.
+   */
+  OnlineEMFit(const size_t batchSize = 1000,
+              const size_t maxIterations = 100,
+              const double stepOffset = 2.0,
+              const double stepDecay = 0.6,
+              CovarianceConstraintPolicy constraint =
+                  CovarianceConstraintPolicy());
+
+  /**
+   * Fit the observations given by the batch source to a GMM.  The size of the
+   * vector of components (indicating the number of components) must already be
+   * set.  If useInitialModel is true, the given model is the initial model, and
+   * training continues from the running statistics if there are any (see
+   * Reset()); otherwise, the model is initialized from the first batch, which
+   * counts as the first step and also sets the dimensionality of the
+   * components.  Estimation stops early if the source runs out
+   * of observations.  A std::invalid_argument is thrown if the source has no
+   * observations or if their dimensionality doesn't match the model.
+   *
+   * @param source Source of batches of observations.
+   * @param dists Vector of components to train.
+   * @param weights Vector of a priori weights to train.
+   * @param useInitialModel If true, the given model is the initial model.
+   */
+  template<typename BatchSourceType>
+  void Estimate(BatchSourceType& source,
+                std::vector<distribution::GaussianDistribution>& dists,
+                arma::vec& weights,
+                const bool useInitialModel = false);
+
+  /**
+   * Fit the given observations to a GMM by sampling batches from them (with
+   * kmeans::MatrixBatchSource).  This has the same signature as
+   * EMFit::Estimate(), so that OnlineEMFit can be used with GMM::Train().
+   *
+   * @param observations Observations to train on.
+   * @param dists Vector of components to train.
+   * @param weights Vector of a priori weights to train.
+   * @param useInitialModel If true, the given model is the initial model.
+   */
+  void Estimate(const arma::mat& observations,
+                std::vector<distribution::GaussianDistribution>& dists,
+                arma::vec& weights,
+                const bool useInitialModel = false);
+
+  /**
+   * Forget the running statistics and the number of steps, so that the next
+   * call to Estimate() starts again from its initial model.
+   */
+  void Reset();
+
+  //! Get the batch size.
+  size_t BatchSize() const { return batchSize; }
+  //! Modify the batch size.
+  size_t& BatchSize() { return batchSize; }
+
+  //! Get the number of batches processed in each call to Estimate().
+  size_t MaxIterations() const { return maxIterations; }
+  //! Modify the number of batches processed in each call to Estimate().
+  size_t& MaxIterations() { return maxIterations; }
+
+  //! Get the offset of the step size schedule.
+  double StepOffset() const { return stepOffset; }
+  //! Modify the offset of the step size schedule.
+  double& StepOffset() { return stepOffset; }
+
+  //! Get the decay of the step size schedule.
+  double StepDecay() const { return stepDecay; }
+  //! Modify the decay of the step size schedule.
+  double& StepDecay() { return stepDecay; }
+
+  //! Get the number of steps taken since the statistics were initialized.
+  size_t Steps() const { return steps; }
+
+  //! Get the running statistics.
+  const EMStatistics& Statistics() const { return statistics; }
+
+  //! Get the covariance constraint policy class.
+  const CovarianceConstraintPolicy& Constraint() const { return constraint; }
+  //! Modify the covariance constraint policy class.
+  CovarianceConstraintPolicy& Constraint() { return constraint; }
+
+  //! Serialize the fitter, including the running statistics.
+  template<typename Archive>
+  void Serialize(Archive& ar, const unsigned int version);
+
+ private:
+  //! Number of observations in each batch.
+  size_t batchSize;
+  //! Number of batches processed in each call to Estimate().
+  size_t maxIterations;
+  //! Offset of the step size schedule.
+  double stepOffset;
+  //! Decay of the step size schedule.
+  double stepDecay;
+  //! Object which applies constraints to the covariance matrix.
+  CovarianceConstraintPolicy constraint;
+  //! The number of steps taken since the statistics were initialized.
+  size_t steps;
+  //! The running statistics, averaged over observations.
+  EMStatistics statistics;
+
+  /**
+   * Take one step with the given batch, and update the model.
+   *
+   * @param batch Batch of observations.
+   * @param dists Components of the model.
+   * @param weights A priori weights of the components.
+   * @return The log-likelihood of the batch under the model before the update.
+   */
+  double Step(const arma::mat& batch,
+              std::vector<distribution::GaussianDistribution>& dists,
+              arma::vec& weights);
+};
+
+} // namespace gmm
+} // namespace mlpack
+
+// Include implementation.
+#include "online_em_fit_impl.hpp"
+
+#endif
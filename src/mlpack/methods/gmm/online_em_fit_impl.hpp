@@ -0,0 +1,189 @@
+/**
+ * @file online_em_fit_impl.hpp
+ *
+ * Implementation of stepwise (online) EM for fitting GMMs.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_GMM_ONLINE_EM_FIT_IMPL_HPP
+#define MLPACK_METHODS_GMM_ONLINE_EM_FIT_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "online_em_fit.hpp"
+
+namespace mlpack {
+namespace gmm {
+
+//! Constructor.
+template<typename CovarianceConstraintPolicy>
+OnlineEMFit<CovarianceConstraintPolicy>::OnlineEMFit(
+    const size_t batchSize,
+    const size_t maxIterations,
+    const double stepOffset,
+    const double stepDecay,
+    CovarianceConstraintPolicy constraint) :
+    batchSize(batchSize),
+    maxIterations(maxIterations),
+    stepOffset(stepOffset),
+    stepDecay(stepDecay),
+    constraint(constraint),
+    steps(0)
+{
+  if (batchSize == 0)
+    throw std::invalid_argument("OnlineEMFit::OnlineEMFit(): batch size must "
+        "be greater than 0");
+
+  if (stepOffset < 0.0)
+  {
+    std::ostringstream oss;
+    oss << "OnlineEMFit::OnlineEMFit(): step offset (" << stepOffset << ") "
+        << "must not be negative";
+    throw std::invalid_argument(oss.str());
+  }
+
+  if (stepDecay <= 0.5 || stepDecay > 1.0)
+  {
+    std::ostringstream oss;
+    oss << "OnlineEMFit::OnlineEMFit(): step decay (" << stepDecay << ") must "
+        << "be greater than 0.5 and at most 1";
+    throw std::invalid_argument(oss.str());
+  }
+}
+
+template<typename CovarianceConstraintPolicy>
+template<typename BatchSourceType>
+void OnlineEMFit<CovarianceConstraintPolicy>::Estimate(
+    BatchSourceType& source,
+    std::vector<distribution::GaussianDistribution>& dists,
+    arma::vec& weights,
+    const bool useInitialModel)
+{
+  arma::mat batch;
+  for (size_t iteration = 0; iteration < maxIterations; ++iteration)
+  {
+    if (source.NextBatch(batchSize, batch) == 0)
+    {
+      if (iteration == 0)
+        throw std::invalid_argument("OnlineEMFit::Estimate(): no observations "
+            "to train on");
+
+      Log::Info << "OnlineEMFit::Estimate(): out of observations after "
+          << iteration << " batches." << std::endl;
+      break;
+    }
+
+    if (iteration == 0)
+    {
+      if (!useInitialModel)
+      {
+        // Initialize the model from the first batch, which also gives the
+        // dimensionality of the model.
+        if (dists.empty() || dists[0].Dimensionality() != batch.n_rows)
+        {
+          dists.assign(dists.size(),
+              distribution::GaussianDistribution(batch.n_rows));
+        }
+        weights.set_size(dists.size());
+
+        EMFit<kmeans::KMeans<>, CovarianceConstraintPolicy> initialFit(300,
+            1e-10, kmeans::KMeans<>(), constraint);
+        initialFit.Estimate(batch, dists, weights);
+        statistics.Reset(dists, weights);
+        steps = 1;
+        continue;
+      }
+
+      if (dists.empty() || batch.n_rows != dists[0].Dimensionality())
+      {
+        std::ostringstream oss;
+        oss << "OnlineEMFit::Estimate(): observations have dimensionality "
+            << batch.n_rows << ", but the model has dimensionality "
+            << (dists.empty() ? 0 : dists[0].Dimensionality());
+        throw std::invalid_argument(oss.str());
+      }
+
+      // Without running statistics for a model of this size, start from the
+      // statistics of the given model.
+      if (steps == 0 || statistics.Centers().n_cols != dists.size() ||
+          statistics.Centers().n_rows != batch.n_rows)
+      {
+        statistics.Reset(dists, weights);
+        steps = 1;
+      }
+    }
+
+    const double logLikelihood = Step(batch, dists, weights);
+    Log::Info << "OnlineEMFit::Estimate(): batch " << iteration << ", "
+        << "average log-likelihood " << logLikelihood / batch.n_cols << "."
+        << std::endl;
+  }
+}
+
+template<typename CovarianceConstraintPolicy>
+void OnlineEMFit<CovarianceConstraintPolicy>::Estimate(
+    const arma::mat& observations,
+    std::vector<distribution::GaussianDistribution>& dists,
+    arma::vec& weights,
+    const bool useInitialModel)
+{
+  kmeans::MatrixBatchSource<> source(observations);
+  Estimate(source, dists, weights, useInitialModel);
+}
+
+template<typename CovarianceConstraintPolicy>
+void OnlineEMFit<CovarianceConstraintPolicy>::Reset()
+{
+  steps = 0;
+  statistics = EMStatistics();
+}
+
+template<typename CovarianceConstraintPolicy>
+double OnlineEMFit<CovarianceConstraintPolicy>::Step(
+    const arma::mat& batch,
+    std::vector<distribution::GaussianDistribution>& dists,
+    arma::vec& weights)
+{
+  // The statistics of the batch must have the same centers as the running
+  // statistics, so that they can be added.
+  EMStatistics batchStatistics;
+  batchStatistics.Reset(statistics.Centers());
+  const double logLikelihood = batchStatistics.Accumulate(batch, NULL,
+      dists, weights);
+
+  // Move the running statistics (which are averages over observations) towards
+  // the average statistics of the batch.
+  const double stepSize = std::pow(steps + stepOffset, -stepDecay);
+  statistics.Scale(1.0 - stepSize);
+  statistics.Add(batchStatistics, stepSize / batch.n_cols);
+  ++steps;
+
+  statistics.Maximize(constraint, dists, weights,
+      arma::accu(statistics.Totals()));
+
+  return logLikelihood;
+}
+
+template<typename CovarianceConstraintPolicy>
+template<typename Archive>
+void OnlineEMFit<CovarianceConstraintPolicy>::Serialize(
+    Archive& ar,
+    const unsigned int /* version */)
+{
+  using data::CreateNVP;
+
+  ar & CreateNVP(batchSize, "batchSize");
+  ar & CreateNVP(maxIterations, "maxIterations");
+  ar & CreateNVP(stepOffset, "stepOffset");
+  ar & CreateNVP(stepDecay, "stepDecay");
+  ar & CreateNVP(constraint, "constraint");
+  ar & CreateNVP(steps, "steps");
+  ar & CreateNVP(statistics, "statistics");
+}
+
+} // namespace gmm
+} // namespace mlpack
+
+#endif
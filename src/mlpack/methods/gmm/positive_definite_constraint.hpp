@@ -62,6 +62,23 @@ class PositiveDefiniteConstraint
     }
   }
 
+  /**
+   * Apply the same constraint to a diagonal covariance matrix, given as the
+   * vector of its diagonal (its eigenvalues): each value is at least 1e-50,
+   * and at least the largest one divided by 1e5.
+   *
+   * @param covariance Diagonal of the covariance matrix.
+   */
+  static void ApplyConstraint(arma::vec& covariance)
+  {
+    if (covariance.n_elem == 0)
+      return;
+
+    const double minEigval = std::max(covariance.max() / 1e5, 1e-50);
+    for (size_t i = 0; i < covariance.n_elem; ++i)
+      covariance[i] = std::max(covariance[i], minEigval);
+  }
+
   //! Serialize the constraint (which stores nothing, so, nothing to do).
   template<typename Archive>
   static void Serialize(Archive& /* ar */, const unsigned int /* version */) { }
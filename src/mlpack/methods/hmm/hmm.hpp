@@ -15,7 +15,11 @@
 #define MLPACK_METHODS_HMM_HMM_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <mlpack/core/util/sfinae_utility.hpp>
 #include <mlpack/core/dists/discrete_distribution.hpp>
+#include "hmm_transition.hpp"
+
+#include <exception>
 
 namespace mlpack {
 namespace hmm /** Hidden Markov Models. */ {
@@ -79,9 +83,21 @@ namespace hmm /** Hidden Markov Models. */ {
  * (with Predict()), generate a sequence (with Generate()), or estimate the
  * probabilities of each state for a sequence of observations (with Train()).
  *
+ * The transition matrix is dense (arma::mat) by default.  For HMMs with many
+ * states and few allowed transitions between them (for instance, banded or
+ * left-to-right topologies), it can be sparse (arma::sp_mat) instead; then
+ * every algorithm only visits the allowed transitions, and training never
+ * allows a transition that isn't stored in the matrix.  Note that the
+ * constructor that takes only the number of states creates a sparse matrix
+ * with every transition allowed, so sparse HMMs should usually be created from
+ * a given transition matrix, or trained with labeled data.
+ *
  * @tparam Distribution Type of emission distribution for this HMM.
+ * @tparam TransitionType Type of the transition matrix (arma::mat or
+ *     arma::sp_mat).
  */
-template<typename Distribution = distribution::DiscreteDistribution>
+template<typename Distribution = distribution::DiscreteDistribution,
+         typename TransitionType = arma::mat>
 class HMM
 {
  public:
@@ -134,7 +150,7 @@ class HMM
    *      (Baum-Welch).
    */
   HMM(const arma::vec& initial,
-      const arma::mat& transition,
+      const TransitionType& transition,
       const std::vector<Distribution>& emission,
       const double tolerance = 1e-5);
 
@@ -153,6 +169,13 @@ class HMM
    * with labeled data first, and then continue to train the model using this
    * overload of Train() with unlabeled data.
    *
+   * The expectation step runs over the sequences in parallel when OpenMP is
+   * available, each thread accumulating its own estimates of the initial and
+   * transition probabilities, which are added together in a fixed order.
+   * The emission probabilities of each time step are scaled by the largest
+   * one before the forward-backward recursions, so long observations whose
+   * probabilities underflow don't break training.
+   *
    * The tolerance of the Baum-Welch algorithm can be set either in the
    * constructor or with the Tolerance() method.  When the change in
    * log-likelihood of the model between iterations is less than the tolerance,
@@ -251,13 +274,46 @@ class HMM
    * sequence, using the Viterbi algorithm, returning the log-likelihood of the
    * most likely state sequence.
    *
+   * Optionally, a beam can be given: at each time step, only the states whose
+   * log-likelihood is within the beam of the best one are kept (beam search).
+   * With a sparse transition matrix, the cost of each time step is then
+   * proportional to the number of transitions out of the kept states, instead
+   * of to the square of the number of states, and the emission probabilities
+   * are only computed for the states that can be reached.  The result is exact
+   * with an infinite beam (the default), and may not be the most probable
+   * sequence otherwise.  With an infinite beam, the emission probabilities of
+   * all the states are computed at once (see EmissionLogProbability()).  A
+   * std::invalid_argument is thrown if the beam is negative.
+   *
    * @param dataSeq Sequence of observations.
    * @param stateSeq Vector in which the most probable state sequence will be
    *    stored.
+   * @param beam Log-likelihood beam for pruning states at each time step.
    * @return Log-likelihood of most probable state sequence.
    */
   double Predict(const arma::mat& dataSeq,
-                 arma::Row<size_t>& stateSeq) const;
+                 arma::Row<size_t>& stateSeq,
+                 const double beam =
+                     std::numeric_limits<double>::infinity()) const;
+
+  /**
+   * Compute the most probable hidden state sequence for each of the given data
+   * sequences, using the Viterbi algorithm.  The sequences are processed in
+   * parallel when OpenMP is available.
+   *
+   * @param dataSeq Vector of observation sequences.
+   * @param stateSeq Vector in which the most probable state sequence of each
+   *    observation sequence will be stored.
+   * @param logLikelihoods Vector in which the log-likelihood of each most
+   *    probable state sequence will be stored.
+   * @param beam Log-likelihood beam for pruning states at each time step (see
+   *    the other overload of Predict()).
+   */
+  void Predict(const std::vector<arma::mat>& dataSeq,
+               std::vector<arma::Row<size_t>>& stateSeq,
+               arma::vec& logLikelihoods,
+               const double beam =
+                   std::numeric_limits<double>::infinity()) const;
 
   /**
    * Compute the log-likelihood of the given data sequence.
@@ -267,6 +323,78 @@ class HMM
    */
   double LogLikelihood(const arma::mat& dataSeq) const;
 
+  /**
+   * Compute the log probability of each observation in the given data sequence
+   * under the emission distribution of each state.  The returned matrix has
+   * rows equal to the number of hidden states and columns equal to the number
+   * of observations.  The batch LogProbability() function of the distribution
+   * is used when it has one (GMM and GaussianDistribution do), and the states
+   * are processed in parallel when OpenMP is available.
+   *
+   * The emission probabilities are usually the most expensive part of the
+   * computations on a sequence, so when several of them are needed (for
+   * instance the state probabilities and the most probable state sequence),
+   * the matrix can be computed once and given to EstimateFromEmission(),
+   * PredictFromEmission() and LogLikelihoodFromEmission().
+   *
+   * @param dataSeq Data sequence to compute probabilities for.
+   * @param logProb Matrix in which the log probabilities will be saved.
+   */
+  void EmissionLogProbability(const arma::mat& dataSeq,
+                              arma::mat& logProb) const;
+
+  /**
+   * Estimate the probabilities of each hidden state at each time step, like
+   * Estimate(), given the log emission probabilities of the sequence computed
+   * by EmissionLogProbability().
+   *
+   * @param logProb Log emission probabilities of each state for each
+   *    observation.
+   * @param stateProb Matrix in which the probabilities of each state at each
+   *    time interval will be stored.
+   * @param forwardProb Matrix in which the forward probabilities of each state
+   *    at each time interval will be stored.
+   * @param backwardProb Matrix in which the backward probabilities of each
+   *    state at each time interval will be stored.
+   * @param scales Vector in which the scaling factors at each time interval
+   *    will be stored.
+   * @return Log-likelihood of the sequence.
+   */
+  double EstimateFromEmission(const arma::mat& logProb,
+                              arma::mat& stateProb,
+                              arma::mat& forwardProb,
+                              arma::mat& backwardProb,
+                              arma::vec& scales) const;
+
+  /**
+   * Compute the most probable hidden state sequence, like Predict(), given the
+   * log emission probabilities of the sequence computed by
+   * EmissionLogProbability().  A std::invalid_argument is thrown if the beam
+   * is negative or if the matrix doesn't have a row for each state.
+   *
+   * @param logProb Log emission probabilities of each state for each
+   *    observation.
+   * @param stateSeq Vector in which the most probable state sequence will be
+   *    stored.
+   * @param beam Log-likelihood beam for pruning states at each time step.
+   * @return Log-likelihood of most probable state sequence.
+   */
+  double PredictFromEmission(const arma::mat& logProb,
+                             arma::Row<size_t>& stateSeq,
+                             const double beam =
+                                 std::numeric_limits<double>::infinity())
+      const;
+
+  /**
+   * Compute the log-likelihood of a data sequence, like LogLikelihood(), given
+   * its log emission probabilities computed by EmissionLogProbability().
+   *
+   * @param logProb Log emission probabilities of each state for each
+   *    observation.
+   * @return Log-likelihood of the sequence.
+   */
+  double LogLikelihoodFromEmission(const arma::mat& logProb) const;
+
   /**
    * HMM filtering. Computes the k-step-ahead expected emission at each time
    * conditioned only on prior observations. That is
@@ -303,9 +431,9 @@ class HMM
   arma::vec& Initial() { return initial; }
 
   //! Return the transition matrix.
-  const arma::mat& Transition() const { return transition; }
+  const TransitionType& Transition() const { return transition; }
   //! Return a modifiable transition matrix reference.
-  arma::mat& Transition() { return transition; }
+  TransitionType& Transition() { return transition; }
 
   //! Return the emission distributions.
   const std::vector<Distribution>& Emission() const { return emission; }
@@ -359,13 +487,76 @@ class HMM
                 const arma::vec& scales,
                 arma::mat& backwardProb) const;
 
+  /**
+   * Compute the emission probabilities of each observation in the given data
+   * sequence, with the probabilities at each time step divided by the largest
+   * of them, so that they don't underflow.  The log-likelihood of the sequence
+   * is the sum of the logs of the scales of the forward algorithm run on these
+   * probabilities, plus the returned value.
+   *
+   * @param dataSeq Data sequence to compute probabilities for.
+   * @param emissionProb Matrix in which the scaled probabilities will be saved.
+   * @return Sum of the logs of the factors removed from each time step.
+   */
+  double ScaledEmissionProbability(const arma::mat& dataSeq,
+                                   arma::mat& emissionProb) const;
+
+  /**
+   * Turn the given log emission probabilities into scaled emission
+   * probabilities, in place, like ScaledEmissionProbability().
+   *
+   * @param emissionProb Log emission probabilities, replaced by the scaled
+   *     probabilities.
+   * @return Sum of the logs of the factors removed from each time step.
+   */
+  static double ScaleEmission(arma::mat& emissionProb);
+
+  /**
+   * The Forward algorithm, given the emission probabilities of each state for
+   * each observation (which may be scaled at each time step; see
+   * ScaledEmissionProbability()).
+   *
+   * @param emissionProb Emission probabilities of each state for each
+   *     observation.
+   * @param scales Vector in which scaling factors will be saved.
+   * @param forwardProb Matrix in which forward probabilities will be saved.
+   */
+  void ForwardFromEmission(const arma::mat& emissionProb,
+                           arma::vec& scales,
+                           arma::mat& forwardProb) const;
+
+  /**
+   * The Backward algorithm, given the emission probabilities of each state for
+   * each observation and the scaling factors found by ForwardFromEmission() on
+   * the same emission probabilities.
+   *
+   * @param emissionProb Emission probabilities of each state for each
+   *     observation.
+   * @param scales Vector of scaling factors.
+   * @param backwardProb Matrix in which backward probabilities will be saved.
+   */
+  void BackwardFromEmission(const arma::mat& emissionProb,
+                            const arma::vec& scales,
+                            arma::mat& backwardProb) const;
+
   //! Set of emission probability distributions; one for each state.
   std::vector<Distribution> emission;
 
   //! Transition probability matrix.
-  arma::mat transition;
+  TransitionType transition;
 
  private:
+  /**
+   * The Viterbi algorithm with a beam, on a sequence of the given length; the
+   * log emission probability of state j at time t is given by
+   * logEmission(j, t), which is only called for the states that are reached.
+   */
+  template<typename EmissionFunction>
+  double Viterbi(const size_t length,
+                 const EmissionFunction& logEmission,
+                 arma::Row<size_t>& stateSeq,
+                 const double beam) const;
+
   //! Initial state probability vector.
   arma::vec initial;
 
@@ -20,14 +20,76 @@
 namespace mlpack {
 namespace hmm {
 
+/**
+ * This gives us a HasLogProbability object that we can use to tell whether or
+ * not an emission distribution has a LogProbability() function.
+ */
+HAS_MEM_FUNC(LogProbability, HasLogProbabilityCheck);
+
+//! Return the log probability of the observation, using the LogProbability()
+//! function of the distribution.
+template<typename Distribution>
+double EmissionLogProbabilityOf(
+    const Distribution& distribution,
+    const arma::vec& observation,
+    const typename std::enable_if_t<HasLogProbabilityCheck<Distribution,
+        double(Distribution::*)(const arma::vec&) const>::value>* = 0)
+{
+  return distribution.LogProbability(observation);
+}
+
+//! Return the log probability of the observation, for distributions without a
+//! LogProbability() function.
+template<typename Distribution>
+double EmissionLogProbabilityOf(
+    const Distribution& distribution,
+    const arma::vec& observation,
+    const typename std::enable_if_t<!HasLogProbabilityCheck<Distribution,
+        double(Distribution::*)(const arma::vec&) const>::value>* = 0)
+{
+  return std::log(distribution.Probability(observation));
+}
+
+//! Compute the log probabilities of all the observations of the sequence at
+//! once, using the batch LogProbability() function of the distribution.
+template<typename Distribution>
+void EmissionLogProbabilitiesOf(
+    const Distribution& distribution,
+    const arma::mat& dataSeq,
+    arma::vec& logProbabilities,
+    const typename std::enable_if_t<HasLogProbabilityCheck<Distribution,
+        void(Distribution::*)(const arma::mat&, arma::vec&) const>::value>* = 0)
+{
+  distribution.LogProbability(dataSeq, logProbabilities);
+}
+
+//! Compute the log probabilities of all the observations of the sequence, one
+//! observation at a time, for distributions without a batch LogProbability()
+//! function.
+template<typename Distribution>
+void EmissionLogProbabilitiesOf(
+    const Distribution& distribution,
+    const arma::mat& dataSeq,
+    arma::vec& logProbabilities,
+    const typename std::enable_if_t<!HasLogProbabilityCheck<Distribution,
+        void(Distribution::*)(const arma::mat&, arma::vec&) const>::value>* = 0)
+{
+  logProbabilities.set_size(dataSeq.n_cols);
+  for (size_t t = 0; t < dataSeq.n_cols; t++)
+  {
+    const arma::vec observation = dataSeq.unsafe_col(t);
+    logProbabilities[t] = EmissionLogProbabilityOf(distribution, observation);
+  }
+}
+
 /**
  * Create the Hidden Markov Model with the given number of hidden states and the
  * given number of emission states.
  */
-template<typename Distribution>
-HMM<Distribution>::HMM(const size_t states,
-                       const Distribution emissions,
-                       const double tolerance) :
+template<typename Distribution, typename TransitionType>
+HMM<Distribution, TransitionType>::HMM(const size_t states,
+                                       const Distribution emissions,
+                                       const double tolerance) :
     emission(states, /* default distribution */ emissions),
     transition(arma::randu<arma::mat>(states, states)),
     initial(arma::randu<arma::vec>(states) / (double) states),
@@ -36,19 +98,19 @@ HMM<Distribution>::HMM(const size_t states,
 {
   // Normalize the transition probabilities and initial state probabilities.
   initial /= arma::accu(initial);
-  for (size_t i = 0; i < transition.n_cols; ++i)
-    transition.col(i) /= arma::accu(transition.col(i));
+  NormalizeTransition(transition, true);
 }
 
 /**
  * Create the Hidden Markov Model with the given transition matrix and the given
  * emission probability matrix.
  */
-template<typename Distribution>
-HMM<Distribution>::HMM(const arma::vec& initial,
-                       const arma::mat& transition,
-                       const std::vector<Distribution>& emission,
-                       const double tolerance) :
+template<typename Distribution, typename TransitionType>
+HMM<Distribution, TransitionType>::HMM(
+    const arma::vec& initial,
+    const TransitionType& transition,
+    const std::vector<Distribution>& emission,
+    const double tolerance) :
     emission(emission),
     transition(transition),
     initial(initial),
@@ -81,8 +143,9 @@ HMM<Distribution>::HMM(const arma::vec& initial,
  *
  * @param dataSeq Set of data sequences to train on.
  */
-template<typename Distribution>
-void HMM<Distribution>::Train(const std::vector<arma::mat>& dataSeq)
+template<typename Distribution, typename TransitionType>
+void HMM<Distribution, TransitionType>::Train(
+    const std::vector<arma::mat>& dataSeq)
 {
   // We should allow a guess at the transition and emission matrices.
   double loglik = 0;
@@ -103,72 +166,144 @@ void HMM<Distribution>::Train(const std::vector<arma::mat>& dataSeq)
           << dimensionality << " dimensions)." << std::endl;
   }
 
-  // These are used later for training of each distribution.  We initialize it
-  // all now so we don't have to do any allocation later on.
+  // These are used later for training of each distribution.  The list of
+  // emission observations doesn't change between iterations, so we assemble
+  // it now, together with the offset of each sequence in it.
   std::vector<arma::vec> emissionProb(transition.n_cols,
       arma::vec(totalLength));
   arma::mat emissionList(dimensionality, totalLength);
+  std::vector<size_t> offsets(dataSeq.size());
+  size_t sumTime = 0;
+  for (size_t seq = 0; seq < dataSeq.size(); seq++)
+  {
+    offsets[seq] = sumTime;
+    if (dataSeq[seq].n_cols > 0)
+    {
+      emissionList.cols(sumTime, sumTime + dataSeq[seq].n_cols - 1) =
+          dataSeq[seq];
+    }
+    sumTime += dataSeq[seq].n_cols;
+  }
+
+#ifdef HAS_OPENMP
+  const size_t numThreads = omp_get_max_threads();
+#else
+  const size_t numThreads = 1;
+#endif
 
   // This should be the Baum-Welch algorithm (EM for HMM estimation). This
   // follows the procedure outlined in Elliot, Aggoun, and Moore's book "Hidden
   // Markov Models: Estimation and Control", pp. 36-40.
   for (size_t iter = 0; iter < iterations; iter++)
   {
-    // Clear new transition matrix and emission probabilities.
-    arma::vec newInitial(transition.n_rows);
-    newInitial.zeros();
-    arma::mat newTransition(transition.n_rows, transition.n_cols);
-    newTransition.zeros();
-
-    // Reset log likelihood.
-    loglik = 0;
-
-    // Sum over time.
-    size_t sumTime = 0;
-
-    // Loop over each sequence.
-    for (size_t seq = 0; seq < dataSeq.size(); seq++)
+    // Each thread accumulates its own estimates of the new initial
+    // probabilities, the new transition matrix (one count for each stored
+    // entry of the transition matrix), and the log-likelihood.
+    std::vector<arma::vec> threadInitial(numThreads,
+        arma::vec(transition.n_rows, arma::fill::zeros));
+    std::vector<arma::vec> threadTransition(numThreads,
+        arma::vec(TransitionEntries(transition), arma::fill::zeros));
+    std::vector<double> threadLoglik(numThreads, 0.0);
+
+    // An exception can't leave the parallel region, so the first one is kept
+    // and thrown afterwards.
+    std::exception_ptr exception;
+
+    #pragma omp parallel num_threads(numThreads)
     {
+#ifdef HAS_OPENMP
+      const size_t thread = omp_get_thread_num();
+#else
+      const size_t thread = 0;
+#endif
+      arma::mat seqEmissionProb;
       arma::mat stateProb;
       arma::mat forward;
       arma::mat backward;
       arma::vec scales;
 
-      // Add the log-likelihood of this sequence.  This is the E-step.
-      loglik += Estimate(dataSeq[seq], stateProb, forward, backward, scales);
-
-      // Add to estimate of initial probability for state j.
-      for (size_t j = 0; j < transition.n_cols; ++j)
-        newInitial[j] += stateProb(j, 0);
-
-      // Now re-estimate the parameters.  This is the M-step.
-      //   pi_i = sum_d ((1 / P(seq[d])) sum_t (f(i, 0) b(i, 0))
-      //   T_ij = sum_d ((1 / P(seq[d])) sum_t (f(i, t) T_ij E_i(seq[d][t]) b(i,
-      //           t + 1)))
-      //   E_ij = sum_d ((1 / P(seq[d])) sum_{t | seq[d][t] = j} f(i, t) b(i, t)
-      // We store the new estimates in a different matrix.
-      for (size_t t = 0; t < dataSeq[seq].n_cols; ++t)
+      // A fixed split of the sequences between the threads keeps the results
+      // reproducible.
+#ifdef _WIN32
+      // Tiny workaround: Visual Studio only implements OpenMP 2.0, which
+      // doesn't support unsigned loop variables. If we're building for Visual
+      // Studio, use the intmax_t type instead.
+      #pragma omp for schedule(static)
+      for (intmax_t seq = 0; seq < (intmax_t) dataSeq.size(); seq++)
+#else
+      #pragma omp for schedule(static)
+      for (size_t seq = 0; seq < dataSeq.size(); seq++)
+#endif
       {
-        for (size_t j = 0; j < transition.n_cols; ++j)
+        const size_t length = dataSeq[seq].n_cols;
+        if (length == 0)
+          continue;
+
+        try
+        {
+          // Add the log-likelihood of this sequence.  This is the E-step.
+          const double logShift = ScaledEmissionProbability(dataSeq[seq],
+              seqEmissionProb);
+          ForwardFromEmission(seqEmissionProb, scales, forward);
+          BackwardFromEmission(seqEmissionProb, scales, backward);
+          stateProb = forward % backward;
+          threadLoglik[thread] += arma::accu(arma::log(scales)) + logShift;
+        }
+        catch (...)
         {
-          if (t < dataSeq[seq].n_cols - 1)
+          #pragma omp critical(HMMTrainException)
           {
-            // Estimate of T_ij (probability of transition from state j to state
-            // i).  We postpone multiplication of the old T_ij until later.
-            for (size_t i = 0; i < transition.n_rows; i++)
-              newTransition(i, j) += forward(j, t) * backward(i, t + 1) *
-                  emission[i].Probability(dataSeq[seq].unsafe_col(t + 1)) /
-                  scales[t + 1];
+            if (!exception)
+              exception = std::current_exception();
           }
+          continue;
+        }
+
+        // Add to estimate of initial probability for state j.
+        threadInitial[thread] += stateProb.col(0);
+
+        // Now re-estimate the parameters.  This is the M-step.
+        //   pi_i = sum_d ((1 / P(seq[d])) sum_t (f(i, 0) b(i, 0))
+        //   T_ij = sum_d ((1 / P(seq[d])) sum_t (f(i, t) T_ij E_i(seq[d][t])
+        //           b(i, t + 1)))
+        //   E_ij = sum_d ((1 / P(seq[d])) sum_{t | seq[d][t] = j} f(i, t)
+        //           b(i, t)
+        // The estimate of T_ij (probability of transition from state j to
+        // state i) for all time steps at once is a matrix product, of which
+        // only the entries stored in the transition matrix are needed.  We
+        // postpone multiplication of the old T_ij until later.
+        if (length > 1)
+        {
+          arma::mat next = backward.tail_cols(length - 1) %
+              seqEmissionProb.tail_cols(length - 1);
+          next.each_row() /= scales.tail(length - 1).t();
+          AddTransitionCounts(transition, next,
+              forward.head_cols(length - 1), threadTransition[thread]);
+        }
 
-          // Add to list of emission observations, for Distribution::Train().
-          emissionList.col(sumTime) = dataSeq[seq].col(t);
-          emissionProb[j][sumTime] = stateProb(j, t);
+        // Store the state probabilities, for Distribution::Train().
+        for (size_t j = 0; j < transition.n_cols; ++j)
+        {
+          emissionProb[j].subvec(offsets[seq], offsets[seq] + length - 1) =
+              stateProb.row(j).t();
         }
-        sumTime++;
       }
     }
 
+    if (exception)
+      std::rethrow_exception(exception);
+
+    // Add together the estimates of each thread, in a fixed order.
+    arma::vec newInitial = std::move(threadInitial[0]);
+    arma::vec newTransition = std::move(threadTransition[0]);
+    loglik = threadLoglik[0];
+    for (size_t t = 1; t < numThreads; ++t)
+    {
+      newInitial += threadInitial[t];
+      newTransition += threadTransition[t];
+      loglik += threadLoglik[t];
+    }
+
     // Normalize the new initial probabilities.
     if (dataSeq.size() > 1)
       initial = newInitial / dataSeq.size();
@@ -179,17 +314,10 @@ void HMM<Distribution>::Train(const std::vector<arma::mat>& dataSeq)
     // multiplication) because every element of the new transition matrix must
     // still be multiplied by the old elements (this is the multiplication we
     // earlier postponed).
-    transition %= newTransition;
+    MultiplyTransitionCounts(newTransition, transition);
 
     // Now we normalize the transition matrix.
-    for (size_t i = 0; i < transition.n_cols; i++)
-    {
-      const double sum = accu(transition.col(i));
-      if (sum > 0.0)
-        transition.col(i) /= sum;
-      else
-        transition.col(i).fill(1.0 / (double) transition.n_rows);
-    }
+    NormalizeTransition(transition, true);
 
     // Now estimate emission probabilities.
     for (size_t state = 0; state < transition.n_cols; state++)
@@ -212,9 +340,10 @@ void HMM<Distribution>::Train(const std::vector<arma::mat>& dataSeq)
  * Train the model using the given labeled observations; the transition and
  * emission matrices are directly estimated.
  */
-template<typename Distribution>
-void HMM<Distribution>::Train(const std::vector<arma::mat>& dataSeq,
-                              const std::vector<arma::Row<size_t> >& stateSeq)
+template<typename Distribution, typename TransitionType>
+void HMM<Distribution, TransitionType>::Train(
+    const std::vector<arma::mat>& dataSeq,
+    const std::vector<arma::Row<size_t> >& stateSeq)
 {
   // Simple error checking.
   if (dataSeq.size() != stateSeq.size())
@@ -224,14 +353,16 @@ void HMM<Distribution>::Train(const std::vector<arma::mat>& dataSeq,
         << ")." << std::endl;
   }
 
+  const size_t states = transition.n_cols;
   initial.zeros();
-  transition.zeros();
 
   // Estimate the transition and emission matrices directly from the
   // observations.  The emission list holds the time indices for observations
-  // from each state.
+  // from each state, and the transition list holds each observed transition,
+  // as (next state, previous state).
   std::vector<std::vector<std::pair<size_t, size_t> > >
-      emissionList(transition.n_cols);
+      emissionList(states);
+  std::vector<std::pair<size_t, size_t> > transitionList;
   for (size_t seq = 0; seq < dataSeq.size(); seq++)
   {
     // Simple error checking.
@@ -255,7 +386,8 @@ void HMM<Distribution>::Train(const std::vector<arma::mat>& dataSeq,
     initial[stateSeq[seq][0]]++;
     for (size_t t = 0; t < dataSeq[seq].n_cols - 1; t++)
     {
-      transition(stateSeq[seq][t + 1], stateSeq[seq][t])++;
+      transitionList.push_back(std::make_pair(stateSeq[seq][t + 1],
+          stateSeq[seq][t]));
       emissionList[stateSeq[seq][t]].push_back(std::make_pair(seq, t));
     }
 
@@ -267,19 +399,16 @@ void HMM<Distribution>::Train(const std::vector<arma::mat>& dataSeq,
   // Normalize initial weights.
   initial /= accu(initial);
 
-  // Normalize transition matrix.
-  for (size_t col = 0; col < transition.n_cols; col++)
-  {
-    // If the transition probability sum is greater than 0 in this column, the
-    // emission probability sum will also be greater than 0.  We want to avoid
-    // division by 0.
-    double sum = accu(transition.col(col));
-    if (sum > 0)
-      transition.col(col) /= sum;
-  }
+  // Count the transitions, and normalize the transition matrix.  If the
+  // transition probability sum is greater than 0 in a column, the emission
+  // probability sum will also be greater than 0; columns that sum to 0 are
+  // left as they are, to avoid division by 0.
+  std::sort(transitionList.begin(), transitionList.end());
+  SetTransitionCounts(states, transitionList, transition);
+  NormalizeTransition(transition, false);
 
   // Estimate emission matrix.
-  for (size_t state = 0; state < transition.n_cols; state++)
+  for (size_t state = 0; state < states; state++)
   {
     // Generate full sequence of observations for this state from the list of
     // emissions that are from this state.
@@ -307,16 +436,37 @@ void HMM<Distribution>::Train(const std::vector<arma::mat>& dataSeq,
  * Estimate the probabilities of each hidden state at each time step for each
  * given data observation.
  */
-template<typename Distribution>
-double HMM<Distribution>::Estimate(const arma::mat& dataSeq,
-                                   arma::mat& stateProb,
-                                   arma::mat& forwardProb,
-                                   arma::mat& backwardProb,
-                                   arma::vec& scales) const
+template<typename Distribution, typename TransitionType>
+double HMM<Distribution, TransitionType>::Estimate(
+    const arma::mat& dataSeq,
+    arma::mat& stateProb,
+    arma::mat& forwardProb,
+    arma::mat& backwardProb,
+    arma::vec& scales) const
 {
-  // First run the forward-backward algorithm.
-  Forward(dataSeq, scales, forwardProb);
-  Backward(dataSeq, scales, backwardProb);
+  // The emission probabilities are computed only once.
+  arma::mat logProb;
+  EmissionLogProbability(dataSeq, logProb);
+  return EstimateFromEmission(logProb, stateProb, forwardProb, backwardProb,
+      scales);
+}
+
+/**
+ * Estimate the probabilities of each hidden state at each time step, given the
+ * log emission probabilities of the sequence.
+ */
+template<typename Distribution, typename TransitionType>
+double HMM<Distribution, TransitionType>::EstimateFromEmission(
+    const arma::mat& logProb,
+    arma::mat& stateProb,
+    arma::mat& forwardProb,
+    arma::mat& backwardProb,
+    arma::vec& scales) const
+{
+  // Run the forward-backward algorithm.
+  const arma::mat emissionProb = arma::exp(logProb);
+  ForwardFromEmission(emissionProb, scales, forwardProb);
+  BackwardFromEmission(emissionProb, scales, backwardProb);
 
   // Now assemble the state probability matrix based on the forward and backward
   // probabilities.
@@ -330,9 +480,10 @@ double HMM<Distribution>::Estimate(const arma::mat& dataSeq,
  * Estimate the probabilities of each hidden state at each time step for each
  * given data observation.
  */
-template<typename Distribution>
-double HMM<Distribution>::Estimate(const arma::mat& dataSeq,
-                                   arma::mat& stateProb) const
+template<typename Distribution, typename TransitionType>
+double HMM<Distribution, TransitionType>::Estimate(
+    const arma::mat& dataSeq,
+    arma::mat& stateProb) const
 {
   // We don't need to save these.
   arma::mat forwardProb, backwardProb;
@@ -346,11 +497,12 @@ double HMM<Distribution>::Estimate(const arma::mat& dataSeq,
  * stored in the dataSequence parameter, and the state sequence is stored in
  * the stateSequence parameter.
  */
-template<typename Distribution>
-void HMM<Distribution>::Generate(const size_t length,
-                                 arma::mat& dataSequence,
-                                 arma::Row<size_t>& stateSequence,
-                                 const size_t startState) const
+template<typename Distribution, typename TransitionType>
+void HMM<Distribution, TransitionType>::Generate(
+    const size_t length,
+    arma::mat& dataSequence,
+    arma::Row<size_t>& stateSequence,
+    const size_t startState) const
 {
   // Set vectors to the right size.
   stateSequence.set_size(length);
@@ -371,19 +523,8 @@ void HMM<Distribution>::Generate(const size_t length,
   {
     // First choose the hidden state.
     randValue = math::Random();
-
-    // Now find where our random value sits in the probability distribution of
-    // state changes.
-    double probSum = 0;
-    for (size_t st = 0; st < transition.n_rows; st++)
-    {
-      probSum += transition(st, stateSequence[t - 1]);
-      if (randValue <= probSum)
-      {
-        stateSequence[t] = st;
-        break;
-      }
-    }
+    stateSequence[t] = SampleTransition(transition, stateSequence[t - 1],
+        randValue);
 
     // Now choose the emission.
     dataSequence.col(t) = emission[stateSequence[t]].Random();
@@ -392,93 +533,297 @@ void HMM<Distribution>::Generate(const size_t length,
 
 /**
  * Compute the most probable hidden state sequence for the given observation
- * using the Viterbi algorithm. Returns the log-likelihood of the most likely
+ * using the Viterbi algorithm, keeping only the states within the beam of the
+ * best one at each time step. Returns the log-likelihood of the most likely
  * sequence.
  */
-template<typename Distribution>
-double HMM<Distribution>::Predict(const arma::mat& dataSeq,
-                                  arma::Row<size_t>& stateSeq) const
+template<typename Distribution, typename TransitionType>
+double HMM<Distribution, TransitionType>::Predict(
+    const arma::mat& dataSeq,
+    arma::Row<size_t>& stateSeq,
+    const double beam) const
 {
-  // This is an implementation of the Viterbi algorithm for finding the most
-  // probable sequence of states to produce the observed data sequence.  We
-  // don't use log-likelihoods to save that little bit of time, but we'll
-  // calculate the log-likelihood at the end of it all.
-  stateSeq.set_size(dataSeq.n_cols);
-  arma::mat logStateProb(transition.n_rows, dataSeq.n_cols);
-  arma::mat stateSeqBack(transition.n_rows, dataSeq.n_cols);
-
-  // Store the logs of the transposed transition matrix.  This is because we
-  // will be using the rows of the transition matrix.
-  arma::mat logTrans(log(trans(transition)));
-
-  // The calculation of the first state is slightly different; the probability
-  // of the first state being state j is the maximum probability that the state
-  // came to be j from another state.
-  logStateProb.col(0).zeros();
-  for (size_t state = 0; state < transition.n_rows; state++)
+  if (!(beam >= 0.0))
+  {
+    std::ostringstream oss;
+    oss << "HMM::Predict(): beam (" << beam << ") must not be negative";
+    throw std::invalid_argument(oss.str());
+  }
+
+  // Without a beam, every reachable state is visited anyway, so the emission
+  // probabilities of all the states are computed at once.
+  if (beam == std::numeric_limits<double>::infinity())
+  {
+    arma::mat logProb;
+    EmissionLogProbability(dataSeq, logProb);
+    return Viterbi(dataSeq.n_cols, [&logProb](const size_t j, const size_t t)
+        { return logProb(j, t); }, stateSeq, beam);
+  }
+
+  return Viterbi(dataSeq.n_cols, [this, &dataSeq](const size_t j,
+      const size_t t)
+  {
+    const arma::vec observation = dataSeq.unsafe_col(t);
+    return EmissionLogProbabilityOf(emission[j], observation);
+  }, stateSeq, beam);
+}
+
+/**
+ * Compute the most probable hidden state sequence, given the log emission
+ * probabilities of the sequence.
+ */
+template<typename Distribution, typename TransitionType>
+double HMM<Distribution, TransitionType>::PredictFromEmission(
+    const arma::mat& logProb,
+    arma::Row<size_t>& stateSeq,
+    const double beam) const
+{
+  if (!(beam >= 0.0))
   {
-    logStateProb(state, 0) = log(initial[state] *
-        emission[state].Probability(dataSeq.unsafe_col(0)));
-    stateSeqBack(state, 0) = state;
+    std::ostringstream oss;
+    oss << "HMM::PredictFromEmission(): beam (" << beam << ") must not be "
+        << "negative";
+    throw std::invalid_argument(oss.str());
   }
 
-  // Store the best first state.
-  arma::uword index;
-  for (size_t t = 1; t < dataSeq.n_cols; t++)
+  if (logProb.n_rows != transition.n_rows)
   {
-    // Assemble the state probability for this element.
-    // Given that we are in state j, we use state with the highest probability
-    // of being the previous state.
-    for (size_t j = 0; j < transition.n_rows; j++)
+    std::ostringstream oss;
+    oss << "HMM::PredictFromEmission(): the emission probabilities have "
+        << logProb.n_rows << " rows, but the model has " << transition.n_rows
+        << " states";
+    throw std::invalid_argument(oss.str());
+  }
+
+  return Viterbi(logProb.n_cols, [&logProb](const size_t j, const size_t t)
+      { return logProb(j, t); }, stateSeq, beam);
+}
+
+template<typename Distribution, typename TransitionType>
+template<typename EmissionFunction>
+double HMM<Distribution, TransitionType>::Viterbi(
+    const size_t length,
+    const EmissionFunction& logEmission,
+    arma::Row<size_t>& stateSeq,
+    const double beam) const
+{
+  // This is an implementation of the Viterbi algorithm for finding the most
+  // probable sequence of states to produce the observed data sequence.  We
+  // work with log-likelihoods, so that long sequences don't underflow.
+  const size_t states = transition.n_rows;
+  stateSeq.set_size(length);
+  if (length == 0)
+    return 0.0;
+
+  // Instead of maximizing over every previous state for every state, each
+  // active state at time t - 1 pushes its score to its successors at time t,
+  // so only the allowed transitions out of the active states are visited.
+  std::vector<size_t> successorStarts, successors;
+  std::vector<double> logTrans;
+  TransitionSuccessors(transition, successorStarts, successors, logTrans);
+  const arma::vec logInitial = arma::log(initial);
+
+  // The active states at each time step, in increasing order, and for each of
+  // them, the position of its best previous state in the active states of the
+  // previous time step.
+  std::vector<std::vector<size_t> > active(length);
+  std::vector<std::vector<size_t> > back(length);
+  std::vector<double> activeScores, nextScores;
+
+  // The best score of each state reached at the current time step; reached
+  // states are marked, and listed so they can be visited (and unmarked) in
+  // time proportional to their number.
+  std::vector<double> best(states);
+  std::vector<size_t> bestBack(states, 0);
+  std::vector<char> reached(states, 0);
+  std::vector<size_t> reachedList;
+
+  for (size_t t = 0; t < length; t++)
+  {
+    reachedList.clear();
+    if (t == 0)
+    {
+      // The calculation of the first state is slightly different; every state
+      // is reached, with its initial probability.
+      for (size_t j = 0; j < states; j++)
+      {
+        reachedList.push_back(j);
+        best[j] = logInitial[j];
+      }
+    }
+    else
+    {
+      // Visiting the previous states in increasing order, and only replacing
+      // strictly better scores, breaks ties towards the lowest previous state.
+      for (size_t p = 0; p < active[t - 1].size(); p++)
+      {
+        const size_t i = active[t - 1][p];
+        for (size_t k = successorStarts[i]; k < successorStarts[i + 1]; k++)
+        {
+          const size_t j = successors[k];
+          const double score = activeScores[p] + logTrans[k];
+          if (!reached[j])
+          {
+            reached[j] = 1;
+            reachedList.push_back(j);
+            best[j] = score;
+            bestBack[j] = p;
+          }
+          else if (score > best[j])
+          {
+            best[j] = score;
+            bestBack[j] = p;
+          }
+        }
+      }
+
+      std::sort(reachedList.begin(), reachedList.end());
+    }
+
+    // Add the log-likelihood of the observation, only for the reached states.
+    double maxScore = -std::numeric_limits<double>::infinity();
+    for (size_t r = 0; r < reachedList.size(); r++)
+    {
+      const size_t j = reachedList[r];
+      reached[j] = 0;
+      best[j] += logEmission(j, t);
+      maxScore = std::max(maxScore, best[j]);
+    }
+
+    // Keep the states within the beam of the best one.  States with zero
+    // probability can't be on the most probable path, unless every state has
+    // zero probability.
+    nextScores.clear();
+    for (size_t r = 0; r < reachedList.size(); r++)
     {
-      arma::vec prob = logStateProb.col(t - 1) + logTrans.col(j);
-      logStateProb(j, t) = prob.max(index) +
-          log(emission[j].Probability(dataSeq.unsafe_col(t)));
-        stateSeqBack(j, t) = index;
+      const size_t j = reachedList[r];
+      if (maxScore == -std::numeric_limits<double>::infinity() ||
+          (best[j] != -std::numeric_limits<double>::infinity() &&
+           best[j] >= maxScore - beam))
+      {
+        active[t].push_back(j);
+        back[t].push_back(bestBack[j]);
+        nextScores.push_back(best[j]);
+      }
     }
+
+    activeScores.swap(nextScores);
   }
 
   // Backtrack to find the most probable state sequence.
-  logStateProb.unsafe_col(dataSeq.n_cols - 1).max(index);
-  stateSeq[dataSeq.n_cols - 1] = index;
-  for (size_t t = 2; t <= dataSeq.n_cols; t++)
-    stateSeq[dataSeq.n_cols - t] =
-        stateSeqBack(stateSeq[dataSeq.n_cols - t + 1], dataSeq.n_cols - t + 1);
+  size_t position = 0;
+  for (size_t p = 1; p < activeScores.size(); p++)
+    if (activeScores[p] > activeScores[position])
+      position = p;
+
+  const double logLikelihood = activeScores[position];
+  for (size_t t = length - 1; t > 0; t--)
+  {
+    stateSeq[t] = active[t][position];
+    position = back[t][position];
+  }
+  stateSeq[0] = active[0][position];
+
+  return logLikelihood;
+}
+
+/**
+ * Compute the most probable hidden state sequence of each of the given
+ * observation sequences using the Viterbi algorithm.
+ */
+template<typename Distribution, typename TransitionType>
+void HMM<Distribution, TransitionType>::Predict(
+    const std::vector<arma::mat>& dataSeq,
+    std::vector<arma::Row<size_t>>& stateSeq,
+    arma::vec& logLikelihoods,
+    const double beam) const
+{
+  stateSeq.resize(dataSeq.size());
+  logLikelihoods.set_size(dataSeq.size());
+
+  // An exception can't leave the parallel region, so the first one is kept
+  // and thrown afterwards.
+  std::exception_ptr exception;
+
+  // The sequences are independent, so they can be scheduled dynamically.
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables. If we're building for Visual Studio, use
+  // the intmax_t type instead.
+  #pragma omp parallel for schedule(dynamic)
+  for (intmax_t seq = 0; seq < (intmax_t) dataSeq.size(); seq++)
+#else
+  #pragma omp parallel for schedule(dynamic)
+  for (size_t seq = 0; seq < dataSeq.size(); seq++)
+#endif
+  {
+    try
+    {
+      logLikelihoods[seq] = Predict(dataSeq[seq], stateSeq[seq], beam);
+    }
+    catch (...)
+    {
+      #pragma omp critical(HMMPredictException)
+      {
+        if (!exception)
+          exception = std::current_exception();
+      }
+    }
+  }
 
-  return logStateProb(stateSeq(dataSeq.n_cols - 1), dataSeq.n_cols - 1);
+  if (exception)
+    std::rethrow_exception(exception);
 }
 
 /**
  * Compute the log-likelihood of the given data sequence.
  */
-template<typename Distribution>
-double HMM<Distribution>::LogLikelihood(const arma::mat& dataSeq) const
+template<typename Distribution, typename TransitionType>
+double HMM<Distribution, TransitionType>::LogLikelihood(
+    const arma::mat& dataSeq) const
 {
+  arma::mat emissionProb;
+  EmissionLogProbability(dataSeq, emissionProb);
+  return LogLikelihoodFromEmission(emissionProb);
+}
+
+/**
+ * Compute the log-likelihood of a data sequence, given its log emission
+ * probabilities.
+ */
+template<typename Distribution, typename TransitionType>
+double HMM<Distribution, TransitionType>::LogLikelihoodFromEmission(
+    const arma::mat& logProb) const
+{
+  arma::mat emissionProb(logProb);
   arma::mat forward;
   arma::vec scales;
 
-  Forward(dataSeq, scales, forward);
+  const double logShift = ScaleEmission(emissionProb);
+  ForwardFromEmission(emissionProb, scales, forward);
 
-  // The log-likelihood is the log of the scales for each time step.
-  return accu(log(scales));
+  // The log-likelihood is the log of the scales for each time step, plus the
+  // log of the factors the emission probabilities were scaled by.
+  return accu(log(scales)) + logShift;
 }
 
 /**
  * HMM filtering.
  */
-template<typename Distribution>
-void HMM<Distribution>::Filter(const arma::mat& dataSeq,
-                               arma::mat& filterSeq,
-                               size_t ahead) const
+template<typename Distribution, typename TransitionType>
+void HMM<Distribution, TransitionType>::Filter(const arma::mat& dataSeq,
+                                               arma::mat& filterSeq,
+                                               size_t ahead) const
 {
   // First run the forward algorithm.
   arma::mat forwardProb;
   arma::vec scales;
   Forward(dataSeq, scales, forwardProb);
 
-  // Propagate state ahead.
-  if (ahead != 0)
-    forwardProb = pow(transition, ahead) * forwardProb;
+  // Propagate state ahead, one step at a time, so that a sparse transition
+  // matrix stays sparse.
+  for (size_t i = 0; i < ahead; i++)
+    forwardProb = transition * forwardProb;
 
   // Compute expected emissions.
   // Will not work for distributions without a Mean() function.
@@ -490,9 +835,9 @@ void HMM<Distribution>::Filter(const arma::mat& dataSeq,
 /**
  * HMM smoothing.
  */
-template<typename Distribution>
-void HMM<Distribution>::Smooth(const arma::mat& dataSeq,
-                               arma::mat& smoothSeq) const
+template<typename Distribution, typename TransitionType>
+void HMM<Distribution, TransitionType>::Smooth(const arma::mat& dataSeq,
+                                               arma::mat& smoothSeq) const
 {
   // First run the forward algorithm.
   arma::mat stateProb;
@@ -508,24 +853,122 @@ void HMM<Distribution>::Smooth(const arma::mat& dataSeq,
 /**
  * The Forward procedure (part of the Forward-Backward algorithm).
  */
-template<typename Distribution>
-void HMM<Distribution>::Forward(const arma::mat& dataSeq,
-                                arma::vec& scales,
-                                arma::mat& forwardProb) const
+template<typename Distribution, typename TransitionType>
+void HMM<Distribution, TransitionType>::Forward(const arma::mat& dataSeq,
+                                                arma::vec& scales,
+                                                arma::mat& forwardProb) const
+{
+  arma::mat logProb;
+  EmissionLogProbability(dataSeq, logProb);
+  ForwardFromEmission(arma::exp(logProb), scales, forwardProb);
+}
+
+template<typename Distribution, typename TransitionType>
+void HMM<Distribution, TransitionType>::Backward(
+    const arma::mat& dataSeq,
+    const arma::vec& scales,
+    arma::mat& backwardProb) const
+{
+  arma::mat logProb;
+  EmissionLogProbability(dataSeq, logProb);
+  BackwardFromEmission(arma::exp(logProb), scales, backwardProb);
+}
+
+template<typename Distribution, typename TransitionType>
+void HMM<Distribution, TransitionType>::EmissionLogProbability(
+    const arma::mat& dataSeq,
+    arma::mat& logProb) const
+{
+  // Each state fills a column of the transposed matrix, so that the threads
+  // write to separate memory.
+  arma::mat logProbTrans(dataSeq.n_cols, transition.n_rows);
+
+  // An exception can't leave the parallel region, so the first one is kept
+  // and thrown afterwards.
+  std::exception_ptr exception;
+
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables. If we're building for Visual Studio, use
+  // the intmax_t type instead.
+  #pragma omp parallel for schedule(dynamic)
+  for (intmax_t state = 0; state < (intmax_t) transition.n_rows; state++)
+#else
+  #pragma omp parallel for schedule(dynamic)
+  for (size_t state = 0; state < transition.n_rows; state++)
+#endif
+  {
+    try
+    {
+      arma::vec stateLogProb;
+      EmissionLogProbabilitiesOf(emission[state], dataSeq, stateLogProb);
+      logProbTrans.col(state) = stateLogProb;
+    }
+    catch (...)
+    {
+      #pragma omp critical(HMMEmissionException)
+      {
+        if (!exception)
+          exception = std::current_exception();
+      }
+    }
+  }
+
+  if (exception)
+    std::rethrow_exception(exception);
+
+  logProb = logProbTrans.t();
+}
+
+template<typename Distribution, typename TransitionType>
+double HMM<Distribution, TransitionType>::ScaledEmissionProbability(
+    const arma::mat& dataSeq,
+    arma::mat& emissionProb) const
+{
+  EmissionLogProbability(dataSeq, emissionProb);
+  return ScaleEmission(emissionProb);
+}
+
+template<typename Distribution, typename TransitionType>
+double HMM<Distribution, TransitionType>::ScaleEmission(
+    arma::mat& emissionProb)
+{
+  double logShift = 0.0;
+  for (size_t t = 0; t < emissionProb.n_cols; t++)
+  {
+    // If no state can emit this observation, the probabilities are all 0
+    // anyway.
+    const double maxLog = emissionProb.col(t).max();
+    if (maxLog == -std::numeric_limits<double>::infinity())
+    {
+      emissionProb.col(t).zeros();
+      continue;
+    }
+
+    emissionProb.col(t) = arma::exp(emissionProb.col(t) - maxLog);
+    logShift += maxLog;
+  }
+
+  return logShift;
+}
+
+template<typename Distribution, typename TransitionType>
+void HMM<Distribution, TransitionType>::ForwardFromEmission(
+    const arma::mat& emissionProb,
+    arma::vec& scales,
+    arma::mat& forwardProb) const
 {
   // Our goal is to calculate the forward probabilities:
   //  P(X_k | o_{1:k}) for all possible states X_k, for each time point k.
-  forwardProb.zeros(transition.n_rows, dataSeq.n_cols);
-  scales.zeros(dataSeq.n_cols);
+  forwardProb.zeros(transition.n_rows, emissionProb.n_cols);
+  scales.zeros(emissionProb.n_cols);
 
   // The first entry in the forward algorithm uses the initial state
   // probabilities.  Note that MATLAB assumes that the starting state (at
   // t = -1) is state 0; this is not our assumption here.  To force that
   // behavior, you could append a single starting state to every single data
   // sequence and that should produce results in line with MATLAB.
-  for (size_t state = 0; state < transition.n_rows; state++)
-    forwardProb(state, 0) = initial(state) *
-        emission[state].Probability(dataSeq.unsafe_col(0));
+  forwardProb.col(0) = initial % emissionProb.col(0);
 
   // Then normalize the column.
   scales[0] = accu(forwardProb.col(0));
@@ -533,17 +976,13 @@ void HMM<Distribution>::Forward(const arma::mat& dataSeq,
     forwardProb.col(0) /= scales[0];
 
   // Now compute the probabilities for each successive observation.
-  for (size_t t = 1; t < dataSeq.n_cols; t++)
+  for (size_t t = 1; t < emissionProb.n_cols; t++)
   {
-    for (size_t j = 0; j < transition.n_rows; j++)
-    {
-      // The forward probability of state j at time t is the sum over all states
-      // of the probability of the previous state transitioning to the current
-      // state and emitting the given observation.
-      forwardProb(j, t) = accu(forwardProb.col(t - 1) %
-          trans(transition.row(j))) *
-          emission[j].Probability(dataSeq.unsafe_col(t));
-    }
+    // The forward probability of state j at time t is the sum over all states
+    // of the probability of the previous state transitioning to the current
+    // state and emitting the given observation.
+    forwardProb.col(t) = (transition * forwardProb.col(t - 1)) %
+        emissionProb.col(t);
 
     // Normalize probability.
     scales[t] = accu(forwardProb.col(t));
@@ -552,42 +991,41 @@ void HMM<Distribution>::Forward(const arma::mat& dataSeq,
   }
 }
 
-template<typename Distribution>
-void HMM<Distribution>::Backward(const arma::mat& dataSeq,
-                                 const arma::vec& scales,
-                                 arma::mat& backwardProb) const
+template<typename Distribution, typename TransitionType>
+void HMM<Distribution, TransitionType>::BackwardFromEmission(
+    const arma::mat& emissionProb,
+    const arma::vec& scales,
+    arma::mat& backwardProb) const
 {
   // Our goal is to calculate the backward probabilities:
   //  P(X_k | o_{k + 1:T}) for all possible states X_k, for each time point k.
-  backwardProb.zeros(transition.n_rows, dataSeq.n_cols);
+  backwardProb.zeros(transition.n_rows, emissionProb.n_cols);
 
   // The last element probability is 1.
-  backwardProb.col(dataSeq.n_cols - 1).fill(1);
+  backwardProb.col(emissionProb.n_cols - 1).fill(1);
 
   // Now step backwards through all other observations.
-  for (size_t t = dataSeq.n_cols - 2; t + 1 > 0; t--)
+  for (size_t t = emissionProb.n_cols - 1; t > 0; t--)
   {
-    for (size_t j = 0; j < transition.n_rows; j++)
-    {
-      // The backward probability of state j at time t is the sum over all state
-      // of the probability of the next state having been a transition from the
-      // current state multiplied by the probability of each of those states
-      // emitting the given observation.
-      for (size_t state = 0; state < transition.n_rows; state++)
-        backwardProb(j, t) += transition(state, j) * backwardProb(state, t + 1)
-            * emission[state].Probability(dataSeq.unsafe_col(t + 1));
-
-      // Normalize by the weights from the forward algorithm.
-      if (scales[t + 1] > 0.0)
-        backwardProb(j, t) /= scales[t + 1];
-    }
+    // The backward probability of state j at time t - 1 is the sum over all
+    // states of the probability of the next state having been a transition
+    // from the current state multiplied by the probability of each of those
+    // states emitting the given observation.
+    backwardProb.col(t - 1) = transition.t() * (backwardProb.col(t) %
+        emissionProb.col(t));
+
+    // Normalize by the weights from the forward algorithm.
+    if (scales[t] > 0.0)
+      backwardProb.col(t - 1) /= scales[t];
   }
 }
 
 //! Serialize the HMM.
-template<typename Distribution>
+template<typename Distribution, typename TransitionType>
 template<typename Archive>
-void HMM<Distribution>::Serialize(Archive& ar, const unsigned int /* version */)
+void HMM<Distribution, TransitionType>::Serialize(
+    Archive& ar,
+    const unsigned int /* version */)
 {
   ar & data::CreateNVP(dimensionality, "dimensionality");
   ar & data::CreateNVP(tolerance, "tolerance");
@@ -17,9 +17,15 @@ enum HMMType : char
 {
   DiscreteHMM = 0,
   GaussianHMM,
-  GaussianMixtureModelHMM
+  GaussianMixtureModelHMM,
+  SparseDiscreteHMM,
+  SparseGaussianHMM,
+  SparseGaussianMixtureModelHMM
 };
 
+//! The type of a sparse transition matrix.
+typedef arma::sp_mat SparseTransition;
+
 /**
  * A serializable HMM model that also stores the type.
  */
@@ -34,6 +40,51 @@ class HMMModel
   HMM<distribution::GaussianDistribution>* gaussianHMM;
   //! Not used if type is not GaussianMixtureModelHMM.
   HMM<gmm::GMM>* gmmHMM;
+  //! Not used if type is not SparseDiscreteHMM.
+  HMM<distribution::DiscreteDistribution, SparseTransition>* sparseDiscreteHMM;
+  //! Not used if type is not SparseGaussianHMM.
+  HMM<distribution::GaussianDistribution, SparseTransition>* sparseGaussianHMM;
+  //! Not used if type is not SparseGaussianMixtureModelHMM.
+  HMM<gmm::GMM, SparseTransition>* sparseGMMHMM;
+
+  //! Delete the HMM and set all the pointers to NULL.
+  void Clear()
+  {
+    delete discreteHMM;
+    delete gaussianHMM;
+    delete gmmHMM;
+    delete sparseDiscreteHMM;
+    delete sparseGaussianHMM;
+    delete sparseGMMHMM;
+
+    discreteHMM = NULL;
+    gaussianHMM = NULL;
+    gmmHMM = NULL;
+    sparseDiscreteHMM = NULL;
+    sparseGaussianHMM = NULL;
+    sparseGMMHMM = NULL;
+  }
+
+  //! Copy the HMM of the given model, of the type of this model.
+  void CopyHMM(const HMMModel& other)
+  {
+    if (type == HMMType::DiscreteHMM)
+      discreteHMM =
+          new HMM<distribution::DiscreteDistribution>(*other.discreteHMM);
+    else if (type == HMMType::GaussianHMM)
+      gaussianHMM =
+          new HMM<distribution::GaussianDistribution>(*other.gaussianHMM);
+    else if (type == HMMType::GaussianMixtureModelHMM)
+      gmmHMM = new HMM<gmm::GMM>(*other.gmmHMM);
+    else if (type == HMMType::SparseDiscreteHMM)
+      sparseDiscreteHMM = new HMM<distribution::DiscreteDistribution,
+          SparseTransition>(*other.sparseDiscreteHMM);
+    else if (type == HMMType::SparseGaussianHMM)
+      sparseGaussianHMM = new HMM<distribution::GaussianDistribution,
+          SparseTransition>(*other.sparseGaussianHMM);
+    else if (type == HMMType::SparseGaussianMixtureModelHMM)
+      sparseGMMHMM = new HMM<gmm::GMM, SparseTransition>(*other.sparseGMMHMM);
+  }
 
  public:
   //! Construct an uninitialized model.
@@ -41,7 +92,10 @@ class HMMModel
       type(HMMType::DiscreteHMM),
       discreteHMM(new HMM<distribution::DiscreteDistribution>()),
       gaussianHMM(NULL),
-      gmmHMM(NULL)
+      gmmHMM(NULL),
+      sparseDiscreteHMM(NULL),
+      sparseGaussianHMM(NULL),
+      sparseGMMHMM(NULL)
   {
     // Nothing to do.
   }
@@ -51,7 +105,10 @@ class HMMModel
       type(type),
       discreteHMM(NULL),
       gaussianHMM(NULL),
-      gmmHMM(NULL)
+      gmmHMM(NULL),
+      sparseDiscreteHMM(NULL),
+      sparseGaussianHMM(NULL),
+      sparseGMMHMM(NULL)
   {
     if (type == HMMType::DiscreteHMM)
       discreteHMM = new HMM<distribution::DiscreteDistribution>();
@@ -59,6 +116,14 @@ class HMMModel
       gaussianHMM = new HMM<distribution::GaussianDistribution>();
     else if (type == HMMType::GaussianMixtureModelHMM)
       gmmHMM = new HMM<gmm::GMM>();
+    else if (type == HMMType::SparseDiscreteHMM)
+      sparseDiscreteHMM =
+          new HMM<distribution::DiscreteDistribution, SparseTransition>();
+    else if (type == HMMType::SparseGaussianHMM)
+      sparseGaussianHMM =
+          new HMM<distribution::GaussianDistribution, SparseTransition>();
+    else if (type == HMMType::SparseGaussianMixtureModelHMM)
+      sparseGMMHMM = new HMM<gmm::GMM, SparseTransition>();
   }
 
   //! Copy another model.
@@ -66,16 +131,12 @@ class HMMModel
       type(other.type),
       discreteHMM(NULL),
       gaussianHMM(NULL),
-      gmmHMM(NULL)
+      gmmHMM(NULL),
+      sparseDiscreteHMM(NULL),
+      sparseGaussianHMM(NULL),
+      sparseGMMHMM(NULL)
   {
-    if (type == HMMType::DiscreteHMM)
-      discreteHMM =
-          new HMM<distribution::DiscreteDistribution>(*other.discreteHMM);
-    else if (type == HMMType::GaussianHMM)
-      gaussianHMM =
-          new HMM<distribution::GaussianDistribution>(*other.gaussianHMM);
-    else if (type == HMMType::GaussianMixtureModelHMM)
-      gmmHMM = new HMM<gmm::GMM>(*other.gmmHMM);
+    CopyHMM(other);
   }
 
   //! Take ownership of another model.
@@ -83,34 +144,29 @@ class HMMModel
       type(other.type),
       discreteHMM(other.discreteHMM),
       gaussianHMM(other.gaussianHMM),
-      gmmHMM(other.gmmHMM)
+      gmmHMM(other.gmmHMM),
+      sparseDiscreteHMM(other.sparseDiscreteHMM),
+      sparseGaussianHMM(other.sparseGaussianHMM),
+      sparseGMMHMM(other.sparseGMMHMM)
   {
     other.type = HMMType::DiscreteHMM;
     other.discreteHMM = new HMM<distribution::DiscreteDistribution>();
     other.gaussianHMM = NULL;
     other.gmmHMM = NULL;
+    other.sparseDiscreteHMM = NULL;
+    other.sparseGaussianHMM = NULL;
+    other.sparseGMMHMM = NULL;
   }
 
   //! Copy assignment operator.
   HMMModel& operator=(const HMMModel& other)
   {
-    delete discreteHMM;
-    delete gaussianHMM;
-    delete gmmHMM;
-
-    discreteHMM = NULL;
-    gaussianHMM = NULL;
-    gmmHMM = NULL;
+    if (this == &other)
+      return *this;
 
+    Clear();
     type = other.type;
-    if (type == HMMType::DiscreteHMM)
-      discreteHMM =
-          new HMM<distribution::DiscreteDistribution>(*other.discreteHMM);
-    else if (type == HMMType::GaussianHMM)
-      gaussianHMM =
-          new HMM<distribution::GaussianDistribution>(*other.gaussianHMM);
-    else if (type == HMMType::GaussianMixtureModelHMM)
-      gmmHMM = new HMM<gmm::GMM>(*other.gmmHMM);
+    CopyHMM(other);
 
     return *this;
   }
@@ -118,9 +174,7 @@ class HMMModel
   //! Clean memory.
   ~HMMModel()
   {
-    delete discreteHMM;
-    delete gaussianHMM;
-    delete gmmHMM;
+    Clear();
   }
 
   /**
@@ -137,8 +191,17 @@ class HMMModel
       ActionType::Apply(*gaussianHMM, x);
     else if (type == HMMType::GaussianMixtureModelHMM)
       ActionType::Apply(*gmmHMM, x);
+    else if (type == HMMType::SparseDiscreteHMM)
+      ActionType::Apply(*sparseDiscreteHMM, x);
+    else if (type == HMMType::SparseGaussianHMM)
+      ActionType::Apply(*sparseGaussianHMM, x);
+    else if (type == HMMType::SparseGaussianMixtureModelHMM)
+      ActionType::Apply(*sparseGMMHMM, x);
   }
 
+  //! Get the type of the HMM.
+  HMMType Type() const { return type; }
+
   //! Serialize the model.
   template<typename Archive>
   void Serialize(Archive& ar, const unsigned int /* version */)
@@ -147,15 +210,7 @@ class HMMModel
 
     // If necessary, clean memory.
     if (Archive::is_loading::value)
-    {
-      delete discreteHMM;
-      delete gaussianHMM;
-      delete gmmHMM;
-
-      discreteHMM = NULL;
-      gaussianHMM = NULL;
-      gmmHMM = NULL;
-    }
+      Clear();
 
     if (type == HMMType::DiscreteHMM)
       ar & data::CreateNVP(discreteHMM, "discreteHMM");
@@ -163,6 +218,12 @@ class HMMModel
       ar & data::CreateNVP(gaussianHMM, "gaussianHMM");
     else if (type == HMMType::GaussianMixtureModelHMM)
       ar & data::CreateNVP(gmmHMM, "gmmHMM");
+    else if (type == HMMType::SparseDiscreteHMM)
+      ar & data::CreateNVP(sparseDiscreteHMM, "sparseDiscreteHMM");
+    else if (type == HMMType::SparseGaussianHMM)
+      ar & data::CreateNVP(sparseGaussianHMM, "sparseGaussianHMM");
+    else if (type == HMMType::SparseGaussianMixtureModelHMM)
+      ar & data::CreateNVP(sparseGMMHMM, "sparseGMMHMM");
   }
 };
 
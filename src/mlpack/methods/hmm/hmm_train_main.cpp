@@ -45,7 +45,14 @@ PROGRAM_INFO("Hidden Markov Model (HMM) Training", "This program allows a "
     "\n\n"
     "Optionally, a pre-created HMM model can be used as a guess for the "
     "transition matrix and emission probabilities; this is specifiable with "
-    "--model_file.");
+    "--model_file."
+    "\n\n"
+    "If --sparse is specified, the HMM stores its transition matrix as a "
+    "sparse matrix, which is much faster for HMMs with many states and few "
+    "allowed transitions between them.  With labels, only the transitions "
+    "seen in the labels are allowed.  Without labels, training a sparse HMM "
+    "from scratch allows every transition, so a pre-created sparse HMM model "
+    "with the allowed transitions should be given with --model_file instead.");
 
 PARAM_STRING_IN_REQ("input_file", "File containing input observations.", "i");
 PARAM_STRING_IN_REQ("type", "Type of HMM: discrete | gaussian | gmm.", "t");
@@ -65,6 +72,8 @@ PARAM_MODEL_OUT(HMMModel, "output_model", "Output for trained HMM.", "M");
 PARAM_INT_IN("seed", "Random seed.  If 0, 'std::time(NULL)' is used.", "s", 0);
 PARAM_DOUBLE_IN("tolerance", "Tolerance of the Baum-Welch algorithm.", "T",
     1e-5);
+PARAM_FLAG("sparse", "If true, the transition matrix of the HMM is stored as "
+    "a sparse matrix (ignored if input_model is specified).", "S");
 
 // Because we don't know what the type of our HMM is, we need to write a
 // function that can take arbitrary HMM types.
@@ -84,8 +93,44 @@ struct Init
     RandomInitialize(hmm.Emission());
   }
 
+  //! Helper function to create an HMM with a dense transition matrix.
+  template<typename Distribution>
+  static void Build(HMM<Distribution>& hmm,
+                    const size_t states,
+                    const Distribution& emission,
+                    const double tolerance)
+  {
+    hmm = HMM<Distribution>(states, emission, tolerance);
+  }
+
+  //! Helper function to create an HMM with a sparse transition matrix.
+  template<typename Distribution>
+  static void Build(HMM<Distribution, SparseTransition>& hmm,
+                    const size_t states,
+                    const Distribution& emission,
+                    const double tolerance)
+  {
+    if (CLI::HasParam("labels_file"))
+    {
+      // The transition matrix is estimated from the labels, so it doesn't have
+      // to be filled first.
+      hmm = HMM<Distribution, SparseTransition>(
+          arma::vec(states).fill(1.0 / (double) states),
+          SparseTransition(states, states),
+          std::vector<Distribution>(states, emission), tolerance);
+    }
+    else
+    {
+      Log::Warn << "Unlabeled training of a sparse HMM from scratch allows "
+          << "every transition; consider specifying an initial model with the "
+          << "allowed transitions (--input_model_file)." << endl;
+      hmm = HMM<Distribution, SparseTransition>(states, emission, tolerance);
+    }
+  }
+
   //! Helper function to create discrete HMM.
-  static void Create(HMM<DiscreteDistribution>& hmm,
+  template<typename TransitionType>
+  static void Create(HMM<DiscreteDistribution, TransitionType>& hmm,
                      vector<mat>& trainSeq,
                      size_t states,
                      double tolerance)
@@ -102,12 +147,12 @@ struct Init
       maxEmissions = arma::max(maxEmissions, maxSeqs);
     }
 
-    hmm = HMM<DiscreteDistribution>(size_t(states),
-        DiscreteDistribution(maxEmissions), tolerance);
+    Build(hmm, size_t(states), DiscreteDistribution(maxEmissions), tolerance);
   }
 
   //! Helper function to create Gaussian HMM.
-  static void Create(HMM<GaussianDistribution>& hmm,
+  template<typename TransitionType>
+  static void Create(HMM<GaussianDistribution, TransitionType>& hmm,
                      vector<mat>& trainSeq,
                      size_t states,
                      double tolerance)
@@ -123,12 +168,13 @@ struct Init
             << dimensionality << ")!" << endl;
 
     // Get the model and initialize it.
-    hmm = HMM<GaussianDistribution>(size_t(states),
-        GaussianDistribution(dimensionality), tolerance);
+    Build(hmm, size_t(states), GaussianDistribution(dimensionality),
+        tolerance);
   }
 
   //! Helper function to create GMM HMM.
-  static void Create(HMM<GMM>& hmm,
+  template<typename TransitionType>
+  static void Create(HMM<GMM, TransitionType>& hmm,
                      vector<mat>& trainSeq,
                      size_t states,
                      double tolerance)
@@ -146,7 +192,7 @@ struct Init
           << "be greater than or equal to 1." << endl;
 
     // Create HMM object.
-    hmm = HMM<GMM>(size_t(states), GMM(size_t(gaussians), dimensionality),
+    Build(hmm, size_t(states), GMM(size_t(gaussians), dimensionality),
         tolerance);
 
     // Issue a warning if the user didn't give labels.
@@ -363,6 +409,10 @@ int main(int argc, char** argv)
   if (CLI::HasParam("input_model") && CLI::HasParam("type"))
     Log::Warn << "--type ignored because --input_model_file specified." << endl;
 
+  if (CLI::HasParam("input_model") && CLI::HasParam("sparse"))
+    Log::Warn << "--sparse ignored because --input_model_file specified."
+        << endl;
+
   if (!CLI::HasParam("input_model") &&
       (type != "discrete") && (type != "gaussian") && (type != "gmm"))
     Log::Fatal << "Unknown type '" << type << "'; must be 'discrete', "
@@ -414,13 +464,15 @@ int main(int argc, char** argv)
   }
 
   // Get the type.
+  const bool sparse = CLI::HasParam("sparse");
   HMMType typeId;
   if (type == "discrete")
-    typeId = HMMType::DiscreteHMM;
+    typeId = sparse ? HMMType::SparseDiscreteHMM : HMMType::DiscreteHMM;
   else if (type == "gaussian")
-    typeId = HMMType::GaussianHMM;
+    typeId = sparse ? HMMType::SparseGaussianHMM : HMMType::GaussianHMM;
   else if (type == "gmm")
-    typeId = HMMType::GaussianMixtureModelHMM;
+    typeId = sparse ? HMMType::SparseGaussianMixtureModelHMM :
+        HMMType::GaussianMixtureModelHMM;
 
   // If we have a model file, we can autodetect the type.
   HMMModel hmm(typeId);
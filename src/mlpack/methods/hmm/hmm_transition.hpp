@@ -0,0 +1,302 @@
+/**
+ * @file hmm_transition.hpp
+ *
+ * Operations on the transition matrix of an HMM that depend on whether the
+ * matrix is dense (arma::mat) or sparse (arma::sp_mat).  With a sparse
+ * transition matrix, only the stored entries are ever visited, so the cost of
+ * each step of the forward-backward algorithm, of Baum-Welch, and of Viterbi
+ * is proportional to the number of allowed transitions instead of to the
+ * square of the number of states.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_HMM_HMM_TRANSITION_HPP
+#define MLPACK_METHODS_HMM_HMM_TRANSITION_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace hmm {
+
+/**
+ * Normalize each column of the dense transition matrix to sum to 1.  Columns
+ * that sum to 0 are filled with equal probabilities if fillEmpty is true, and
+ * are left as they are otherwise.
+ *
+ * @param transition Transition matrix to normalize.
+ * @param fillEmpty Whether to fill the columns that sum to 0.
+ */
+inline void NormalizeTransition(arma::mat& transition, const bool fillEmpty)
+{
+  for (size_t i = 0; i < transition.n_cols; i++)
+  {
+    const double sum = arma::accu(transition.col(i));
+    if (sum > 0.0)
+      transition.col(i) /= sum;
+    else if (fillEmpty)
+      transition.col(i).fill(1.0 / (double) transition.n_rows);
+  }
+}
+
+/**
+ * Normalize each column of the sparse transition matrix to sum to 1.  Columns
+ * that sum to 0 are always left empty, because filling them would make the
+ * matrix dense.
+ *
+ * @param transition Transition matrix to normalize.
+ */
+inline void NormalizeTransition(arma::sp_mat& transition,
+                                const bool /* fillEmpty */)
+{
+  const arma::rowvec sums(arma::sum(transition, 0));
+  for (arma::sp_mat::iterator it = transition.begin(); it != transition.end();
+       ++it)
+  {
+    (*it) /= sums[it.col()];
+  }
+}
+
+/**
+ * Count, for each stored entry of the transition matrix in column-major order,
+ * sum_t next(i, t) * previous(j, t), where (i, j) is the position of the entry.
+ * Baum-Welch uses these counts to re-estimate the transition matrix.  For a
+ * dense matrix, every entry is stored.
+ *
+ * @param transition Transition matrix.
+ * @param next Matrix whose rows correspond to the rows of the transition
+ *     matrix.
+ * @param previous Matrix whose rows correspond to the columns of the
+ *     transition matrix.
+ * @param counts Counts of each entry to add to.
+ */
+inline void AddTransitionCounts(const arma::mat& transition,
+                                const arma::mat& next,
+                                const arma::mat& previous,
+                                arma::vec& counts)
+{
+  // Alias the counts as a matrix, so that the product is added in place.
+  arma::mat countsMatrix(counts.memptr(), transition.n_rows,
+      transition.n_cols, false, true);
+  countsMatrix += next * previous.t();
+}
+
+//! Count the stored entries of the sparse transition matrix; see the dense
+//! overload.
+inline void AddTransitionCounts(const arma::sp_mat& transition,
+                                const arma::mat& next,
+                                const arma::mat& previous,
+                                arma::vec& counts)
+{
+  size_t index = 0;
+  for (arma::sp_mat::const_iterator it = transition.begin();
+       it != transition.end(); ++it, ++index)
+  {
+    counts[index] += arma::dot(next.row(it.row()), previous.row(it.col()));
+  }
+}
+
+//! Get the number of stored entries of the dense transition matrix (all of
+//! them).
+inline size_t TransitionEntries(const arma::mat& transition)
+{
+  return transition.n_elem;
+}
+
+//! Get the number of stored entries of the sparse transition matrix.
+inline size_t TransitionEntries(const arma::sp_mat& transition)
+{
+  return transition.n_nonzero;
+}
+
+/**
+ * Multiply each stored entry of the dense transition matrix by its count (in
+ * column-major order).
+ *
+ * @param counts Counts of each entry.
+ * @param transition Transition matrix to multiply.
+ */
+inline void MultiplyTransitionCounts(const arma::vec& counts,
+                                     arma::mat& transition)
+{
+  transition %= arma::reshape(counts, transition.n_rows, transition.n_cols);
+}
+
+//! Multiply each stored entry of the sparse transition matrix by its count.
+//! The entries whose count is 0 are removed.
+inline void MultiplyTransitionCounts(const arma::vec& counts,
+                                     arma::sp_mat& transition)
+{
+  arma::umat locations(2, transition.n_nonzero);
+  arma::vec values(transition.n_nonzero);
+  size_t index = 0;
+  for (arma::sp_mat::const_iterator it = transition.begin();
+       it != transition.end(); ++it, ++index)
+  {
+    locations(0, index) = it.row();
+    locations(1, index) = it.col();
+    values[index] = (*it) * counts[index];
+  }
+
+  transition = arma::sp_mat(locations, values, transition.n_rows,
+      transition.n_cols, false, true);
+}
+
+/**
+ * Set the dense transition matrix to the given counts of transitions, given
+ * as sorted pairs of (next state, previous state), with repeats.
+ *
+ * @param states Number of states.
+ * @param pairs Sorted transitions.
+ * @param transition Transition matrix to set.
+ */
+inline void SetTransitionCounts(
+    const size_t states,
+    const std::vector<std::pair<size_t, size_t>>& pairs,
+    arma::mat& transition)
+{
+  transition.zeros(states, states);
+  for (size_t i = 0; i < pairs.size(); ++i)
+    transition(pairs[i].first, pairs[i].second)++;
+}
+
+//! Set the sparse transition matrix to the given counts of transitions; see
+//! the dense overload.
+inline void SetTransitionCounts(
+    const size_t states,
+    const std::vector<std::pair<size_t, size_t>>& pairs,
+    arma::sp_mat& transition)
+{
+  // Each run of equal pairs is one entry.
+  std::vector<arma::uword> rows, cols;
+  std::vector<double> counts;
+  for (size_t i = 0; i < pairs.size(); ++i)
+  {
+    if (i > 0 && pairs[i] == pairs[i - 1])
+    {
+      counts.back()++;
+      continue;
+    }
+
+    rows.push_back(pairs[i].first);
+    cols.push_back(pairs[i].second);
+    counts.push_back(1.0);
+  }
+
+  arma::umat locations(2, rows.size());
+  for (size_t i = 0; i < rows.size(); ++i)
+  {
+    locations(0, i) = rows[i];
+    locations(1, i) = cols[i];
+  }
+
+  transition = arma::sp_mat(locations, arma::vec(counts), states, states);
+}
+
+/**
+ * Get the successors of each state in the dense transition matrix, with the
+ * logs of their transition probabilities, in compressed sparse column form:
+ * the successors of state j are rows[colStarts[j]] to
+ * rows[colStarts[j + 1] - 1].  Transitions with probability 0 are skipped.
+ *
+ * @param transition Transition matrix.
+ * @param colStarts Start of the successors of each state.
+ * @param rows Successors.
+ * @param logProbs Log probability of each transition.
+ */
+inline void TransitionSuccessors(const arma::mat& transition,
+                                 std::vector<size_t>& colStarts,
+                                 std::vector<size_t>& rows,
+                                 std::vector<double>& logProbs)
+{
+  colStarts.assign(1, 0);
+  rows.clear();
+  logProbs.clear();
+  for (size_t j = 0; j < transition.n_cols; ++j)
+  {
+    for (size_t i = 0; i < transition.n_rows; ++i)
+    {
+      if (transition(i, j) > 0.0)
+      {
+        rows.push_back(i);
+        logProbs.push_back(std::log(transition(i, j)));
+      }
+    }
+    colStarts.push_back(rows.size());
+  }
+}
+
+//! Get the successors of each state in the sparse transition matrix; see the
+//! dense overload.
+inline void TransitionSuccessors(const arma::sp_mat& transition,
+                                 std::vector<size_t>& colStarts,
+                                 std::vector<size_t>& rows,
+                                 std::vector<double>& logProbs)
+{
+  colStarts.assign(transition.n_cols + 1, 0);
+  rows.clear();
+  logProbs.clear();
+  for (arma::sp_mat::const_iterator it = transition.begin();
+       it != transition.end(); ++it)
+  {
+    ++colStarts[it.col() + 1];
+    rows.push_back(it.row());
+    logProbs.push_back(std::log(*it));
+  }
+
+  // Each column starts where the previous one ends.
+  for (size_t j = 0; j < transition.n_cols; ++j)
+    colStarts[j + 1] += colStarts[j];
+}
+
+/**
+ * Sample the state after the given state from the dense transition matrix.
+ *
+ * @param transition Transition matrix.
+ * @param state Current state.
+ * @param randValue Uniform random value in [0, 1).
+ * @return The next state.
+ */
+inline size_t SampleTransition(const arma::mat& transition,
+                               const size_t state,
+                               const double randValue)
+{
+  // Find where our random value sits in the probability distribution of state
+  // changes.
+  double probSum = 0;
+  for (size_t st = 0; st < transition.n_rows; st++)
+  {
+    probSum += transition(st, state);
+    if (randValue <= probSum)
+      return st;
+  }
+
+  return transition.n_rows - 1;
+}
+
+//! Sample the state after the given state from the sparse transition matrix;
+//! see the dense overload.
+inline size_t SampleTransition(const arma::sp_mat& transition,
+                               const size_t state,
+                               const double randValue)
+{
+  double probSum = 0;
+  size_t last = transition.n_rows - 1;
+  for (arma::sp_mat::const_iterator it = transition.begin_col(state);
+       it != transition.end_col(state); ++it)
+  {
+    probSum += (*it);
+    last = it.row();
+    if (randValue <= probSum)
+      return last;
+  }
+
+  return last;
+}
+
+} // namespace hmm
+} // namespace mlpack
+
+#endif
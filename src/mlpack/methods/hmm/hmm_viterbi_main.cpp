@@ -30,11 +30,76 @@ PROGRAM_INFO("Hidden Markov Model (HMM) Viterbi State Prediction", "This "
     "utility takes an already-trained HMM (--model_file) and evaluates the "
     "most probably hidden state sequence of a given sequence of observations "
     "(--input_file), using the Viterbi algorithm.  The computed state sequence "
-    "is saved to the specified output file (--output_file).");
+    "is saved to the specified output file (--output_file)."
+    "\n\n"
+    "Many sequences can be processed at once with --batch (-b): then "
+    "--input_file contains a list of files of observation sequences, one per "
+    "line (as for mlpack_hmm_train), and the state sequence of each is saved "
+    "to the corresponding line of the list of files given with --output_list "
+    "(-O).  The sequences are processed in parallel when OpenMP is "
+    "available."
+    "\n\n"
+    "For HMMs with many states, --beam (-B) prunes the states whose "
+    "log-likelihood is more than the given beam below the best one at each "
+    "time step (beam search).  This is much faster, especially for HMMs "
+    "trained with --sparse, but the result may not be the most probable "
+    "sequence.  A beam of 0 (the default) gives the exact result.");
 
 PARAM_MATRIX_IN_REQ("input", "Matrix containing observations,", "i");
 PARAM_MODEL_IN_REQ(HMMModel, "input_model", "Trained HMM to use.", "m");
 PARAM_UMATRIX_OUT("output", "File to save predicted state sequence to.", "o");
+PARAM_FLAG("batch", "If true, --input_file is expected to contain a list of "
+    "files to use as input observation sequences.", "b");
+PARAM_STRING_IN("output_list", "If --batch is given, file containing a list of "
+    "files to save the predicted state sequences to, one for each input "
+    "sequence.", "O", "");
+PARAM_DOUBLE_IN("beam", "Log-likelihood beam for pruning states during the "
+    "search, or 0 for an exact search.", "B", 0.0);
+
+// Get the beam to use; an infinite beam gives the exact sequence.
+double Beam()
+{
+  const double beam = CLI::GetParam<double>("beam");
+  return (beam == 0.0) ? std::numeric_limits<double>::infinity() : beam;
+}
+
+// Read a list of file names, one per line.
+void ReadFileList(const string& listFile, vector<string>& files)
+{
+  fstream f(listFile.c_str(), ios_base::in);
+  if (!f.is_open())
+    Log::Fatal << "Could not open '" << listFile << "' for reading." << endl;
+
+  char lineBuf[1024]; // Max 1024 characters... hopefully long enough.
+  f.getline(lineBuf, 1024, '\n');
+  while (!f.eof())
+  {
+    files.push_back(lineBuf);
+    f.getline(lineBuf, 1024, '\n');
+  }
+
+  f.close();
+}
+
+// Transpose the data sequence if that could make it the right dimensionality,
+// and verify its dimensionality.
+template<typename HMMType>
+void CheckSequence(const HMMType& hmm, mat& dataSeq)
+{
+  // See if transposing the data could make it the right dimensionality.
+  if ((dataSeq.n_cols == 1) && (hmm.Emission()[0].Dimensionality() == 1))
+  {
+    Log::Info << "Data sequence appears to be transposed; correcting."
+        << endl;
+    dataSeq = dataSeq.t();
+  }
+
+  // Verify correct dimensionality.
+  if (dataSeq.n_rows != hmm.Emission()[0].Dimensionality())
+    Log::Fatal << "Observation dimensionality (" << dataSeq.n_rows << ") "
+        << "does not match HMM Gaussian dimensionality ("
+        << hmm.Emission()[0].Dimensionality() << ")!" << endl;
+}
 
 // Because we don't know what the type of our HMM is, we need to write a
 // function that can take arbitrary HMM types.
@@ -43,30 +108,57 @@ struct Viterbi
   template<typename HMMType>
   static void Apply(HMMType& hmm, void* /* extraInfo */)
   {
-    // Load observations.
-    mat dataSeq = std::move(CLI::GetParam<arma::mat>("input"));
-
-    // See if transposing the data could make it the right dimensionality.
-    if ((dataSeq.n_cols == 1) && (hmm.Emission()[0].Dimensionality() == 1))
+    if (CLI::HasParam("batch"))
     {
-      Log::Info << "Data sequence appears to be transposed; correcting."
-          << endl;
-      dataSeq = dataSeq.t();
+      ApplyBatch(hmm);
+      return;
     }
 
-    // Verify correct dimensionality.
-    if (dataSeq.n_rows != hmm.Emission()[0].Dimensionality())
-      Log::Fatal << "Observation dimensionality (" << dataSeq.n_rows << ") "
-          << "does not match HMM Gaussian dimensionality ("
-          << hmm.Emission()[0].Dimensionality() << ")!" << endl;
+    // Load observations.
+    mat dataSeq = std::move(CLI::GetParam<arma::mat>("input"));
+    CheckSequence(hmm, dataSeq);
 
     arma::Row<size_t> sequence;
-    hmm.Predict(dataSeq, sequence);
+    hmm.Predict(dataSeq, sequence, Beam());
 
     // Save output.
     if (CLI::HasParam("output"))
       CLI::GetParam<arma::Mat<size_t>>("output") = std::move(sequence);
   }
+
+  template<typename HMMType>
+  static void ApplyBatch(HMMType& hmm)
+  {
+    // The input file contains a list of files to read.
+    vector<string> inputFiles;
+    ReadFileList(CLI::GetUnmappedParam<arma::mat>("input"), inputFiles);
+
+    vector<string> outputFiles;
+    if (CLI::HasParam("output_list"))
+    {
+      ReadFileList(CLI::GetParam<string>("output_list"), outputFiles);
+      if (outputFiles.size() != inputFiles.size())
+        Log::Fatal << "Number of output files (" << outputFiles.size()
+            << ") in --output_list does not match the number of input "
+            << "sequences (" << inputFiles.size() << ")!" << endl;
+    }
+
+    vector<mat> dataSeq(inputFiles.size());
+    for (size_t i = 0; i < inputFiles.size(); ++i)
+    {
+      Log::Info << "Adding sequence from '" << inputFiles[i] << "'." << endl;
+      data::Load(inputFiles[i], dataSeq[i], true); // Fatal on failure.
+      CheckSequence(hmm, dataSeq[i]);
+    }
+
+    vector<arma::Row<size_t>> sequences;
+    arma::vec logLikelihoods;
+    hmm.Predict(dataSeq, sequences, logLikelihoods, Beam());
+
+    // Save output.
+    for (size_t i = 0; i < outputFiles.size(); ++i)
+      data::Save(outputFiles[i], sequences[i], true);
+  }
 };
 
 int main(int argc, char** argv)
@@ -74,9 +166,28 @@ int main(int argc, char** argv)
   // Parse command line options.
   CLI::ParseCommandLine(argc, argv);
 
-  if (!CLI::HasParam("output"))
-    Log::Warn << "--output_file (-o) is not specified; no results will be "
-        << "saved!" << endl;
+  if (CLI::GetParam<double>("beam") < 0.0)
+    Log::Fatal << "Invalid beam (" << CLI::GetParam<double>("beam") << "); "
+        << "must be greater than or equal to 0." << endl;
+
+  if (CLI::HasParam("batch"))
+  {
+    if (CLI::HasParam("output"))
+      Log::Fatal << "--output_file (-o) can't be used with --batch; use "
+          << "--output_list (-O) instead." << endl;
+    if (!CLI::HasParam("output_list"))
+      Log::Warn << "--output_list (-O) is not specified; no results will be "
+          << "saved!" << endl;
+  }
+  else
+  {
+    if (CLI::HasParam("output_list"))
+      Log::Warn << "--output_list (-O) ignored because --batch is not "
+          << "specified." << endl;
+    if (!CLI::HasParam("output"))
+      Log::Warn << "--output_file (-o) is not specified; no results will be "
+          << "saved!" << endl;
+  }
 
   CLI::GetParam<HMMModel>("input_model").PerformAction<Viterbi>((void*) NULL);
 }
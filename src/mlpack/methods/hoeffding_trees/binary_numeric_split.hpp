@@ -73,6 +73,15 @@ class BinaryNumericSplit
    */
   void Train(ObservationType value, const size_t label);
 
+  /**
+   * Add the points the given split has seen, which must have the same number
+   * of classes, to this split.  Afterwards, this split is the same as if it had
+   * also been trained on those points, after the points it has already seen.
+   *
+   * @param other Split to take the points of.
+   */
+  void Merge(const BinaryNumericSplit& other);
+
   /**
    * Given the points seen so far, evaluate the fitness function, returning the
    * best possible gain of a binary split.  Note that this takes O(n) time,
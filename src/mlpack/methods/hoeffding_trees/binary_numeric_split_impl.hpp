@@ -54,6 +54,19 @@ void BinaryNumericSplit<FitnessFunction, ObservationType>::Train(
   isAccurate = false;
 }
 
+template<typename FitnessFunction, typename ObservationType>
+void BinaryNumericSplit<FitnessFunction, ObservationType>::Merge(
+    const BinaryNumericSplit& other)
+{
+  // Inserting at the end keeps equal values in the order they were seen.
+  for (typename std::multimap<ObservationType, size_t>::const_iterator it =
+      other.sortedElements.begin(); it != other.sortedElements.end(); ++it)
+    sortedElements.insert(sortedElements.end(), *it);
+  classCounts += other.classCounts;
+
+  isAccurate = false;
+}
+
 template<typename FitnessFunction, typename ObservationType>
 void BinaryNumericSplit<FitnessFunction, ObservationType>::
     EvaluateFitnessFunction(double& bestFitness,
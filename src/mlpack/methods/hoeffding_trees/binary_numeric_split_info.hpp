@@ -32,6 +32,21 @@ class BinaryNumericSplitInfo
     return (value < splitPoint) ? 0 : 1;
   }
 
+  /**
+   * Get the split as a list of split points, for FlatTree: a point goes to the
+   * child whose index is the number of split points less than its value.  The
+   * split point is the largest value below splitPoint, so that values equal to
+   * splitPoint still go right.
+   */
+  template<typename eT>
+  bool SplitPoints(arma::Col<eT>& splitPoints) const
+  {
+    splitPoints.set_size(1);
+    splitPoints[0] = std::nextafter((eT) splitPoint,
+        -std::numeric_limits<eT>::infinity());
+    return true;
+  }
+
   //! Serialize the split (save/load the split points).
   template<typename Archive>
   void Serialize(Archive& ar, const unsigned int /* version */)
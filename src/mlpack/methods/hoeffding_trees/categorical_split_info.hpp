@@ -30,6 +30,13 @@ class CategoricalSplitInfo
     return size_t(value);
   }
 
+  /**
+   * Get the split as a list of split points, for FlatTree.  There are none,
+   * since the child of a point is its category, so false is returned.
+   */
+  template<typename eT>
+  static bool SplitPoints(arma::Col<eT>& /* splitPoints */) { return false; }
+
   //! Serialize the object.  (Nothing needs to be saved.)
   template<typename Archive>
   void Serialize(Archive& /* ar */, const unsigned int /* version */) { }
@@ -76,6 +76,15 @@ class HoeffdingCategoricalSplit
   template<typename eT>
   void Train(eT value, const size_t label);
 
+  /**
+   * Add the statistics of the given split, which must have the same number of
+   * categories and classes, to this one.  Afterwards, this split is the same as
+   * if it had also been trained on the points the other split was trained on.
+   *
+   * @param other Split to take the statistics of.
+   */
+  void Merge(const HoeffdingCategoricalSplit& other);
+
   /**
    * Given the points seen so far, evaluate the fitness function, returning the
    * gain for the best possible split and the second best possible split.  In
@@ -87,6 +87,19 @@ class HoeffdingNumericSplit
    */
   void Train(ObservationType value, const size_t label);
 
+  /**
+   * Add the statistics of the given split, which must have been created with
+   * the same parameters, to this one, as if this split had also been trained on
+   * the points the other split was trained on.  This is exact if the other
+   * split has not binned its points yet (they are replayed), if this split has
+   * not binned its points yet (it takes the bins of the other split), or if
+   * both splits have the same bins.  Otherwise, the counts of each bin of the
+   * other split are added to the bin of this split that holds its center.
+   *
+   * @param other Split to take the statistics of.
+   */
+  void Merge(const HoeffdingNumericSplit& other);
+
   /**
    * Evaluate the fitness function given what has been calculated so far.  In
    * this case, if binning has not yet been performed, 0 will be returned (i.e.,
@@ -103,6 +103,63 @@ void HoeffdingNumericSplit<FitnessFunction, ObservationType>::Train(
   sufficientStatistics(label, bin)++;
 }
 
+template<typename FitnessFunction, typename ObservationType>
+void HoeffdingNumericSplit<FitnessFunction, ObservationType>::Merge(
+    const HoeffdingNumericSplit& other)
+{
+  // If the other split hasn't binned yet, its points are all we need.
+  if (other.samplesSeen < other.observationsBeforeBinning)
+  {
+    for (size_t i = 0; i < other.samplesSeen; ++i)
+      Train(other.observations[i], other.labels[i]);
+    return;
+  }
+
+  // If this split hasn't binned yet, use the bins of the other split.
+  if (samplesSeen < observationsBeforeBinning)
+  {
+    const arma::Col<ObservationType> oldObservations(observations);
+    const arma::Col<size_t> oldLabels(labels);
+    const size_t oldSamplesSeen = samplesSeen;
+
+    *this = other;
+    for (size_t i = 0; i < oldSamplesSeen; ++i)
+      Train(oldObservations[i], oldLabels[i]);
+    return;
+  }
+
+  bool sameBins = true;
+  for (size_t i = 0; i < splitPoints.n_elem; ++i)
+    sameBins &= (splitPoints[i] == other.splitPoints[i]);
+
+  if (sameBins)
+  {
+    sufficientStatistics += other.sufficientStatistics;
+    return;
+  }
+
+  // The bins differ, so add each bin of the other split to the bin of this
+  // split that holds its center.  With fewer than three bins, the width of
+  // the bins isn't known, so the bins are matched by position instead.
+  for (size_t i = 0; i < bins; ++i)
+  {
+    size_t bin = i;
+    if (bins > 2)
+    {
+      const double width = double(other.splitPoints[1]) -
+          double(other.splitPoints[0]);
+      const double center = double(other.splitPoints[0]) +
+          (double(i) - 0.5) * width;
+
+      bin = 0;
+      while (bin < bins - 1 && center > double(splitPoints[bin]))
+        ++bin;
+    }
+
+    sufficientStatistics.col(bin) += other.sufficientStatistics.col(i);
+  }
+}
+
 template<typename FitnessFunction, typename ObservationType>
 void HoeffdingNumericSplit<FitnessFunction, ObservationType>::
     EvaluateFitnessFunction(double& bestFitness,
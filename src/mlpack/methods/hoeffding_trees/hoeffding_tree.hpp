@@ -15,6 +15,7 @@
 
 #include <mlpack/prereqs.hpp>
 #include <mlpack/core/data/dataset_mapper.hpp>
+#include <mlpack/core/data/chunked_reader.hpp>
 #include "gini_impurity.hpp"
 #include "hoeffding_numeric_split.hpp"
 #include "hoeffding_categorical_split.hpp"
@@ -150,7 +151,10 @@ class HoeffdingTree
 
   /**
    * Train on a set of points, either in streaming mode or in batch mode, with
-   * the given labels.
+   * the given labels.  In batch mode, a node that has not seen any points yet
+   * and gets many points splits them into shards, trains a copy of its split
+   * statistics on each shard in parallel, and merges the copies before it
+   * checks for a split.  The shards don't depend on the number of threads.
    *
    * @param data Data points to train on.
    * @param label Labels of data points.
@@ -170,6 +174,15 @@ class HoeffdingTree
   template<typename VecType>
   void Train(const VecType& point, const size_t label);
 
+  /**
+   * Train in streaming mode on one pass over the blocks of the given reader.
+   * The last row of each block holds the labels of its points, so the reader's
+   * dimensionality must be one more than the tree's.
+   *
+   * @param reader Reader to take the points and labels from.
+   */
+  void Train(data::ChunkedReader& reader);
+
   /**
    * Check if a split would satisfy the conditions of the Hoeffding bound with
    * the node's specified success probability.  If so, the number of children
@@ -190,6 +203,9 @@ class HoeffdingTree
   //! Modify the probability of the majority class.
   double& MajorityProbability() { return majorityProbability; }
 
+  //! Get the number of classes the tree predicts.
+  size_t NumClasses() const { return numClasses; }
+
   //! Get the number of children.
   size_t NumChildren() const { return children.size(); }
 
@@ -218,6 +234,32 @@ class HoeffdingTree
   //! Modify the number of samples before a split check is performed.
   void CheckInterval(const size_t checkInterval);
 
+  //! Get the maximum number of active leaves of the tree (0 means no limit).
+  size_t MaxActiveLeaves() const { return maxActiveLeaves; }
+  /**
+   * Modify the maximum number of active leaves of the tree; this should only be
+   * called on the root of the tree.  Only active leaves keep the statistics
+   * needed to split, so this bounds the memory the tree uses, as in the memory
+   * management of VFDT.  Every checkInterval samples (and at the end of batch
+   * training), the leaves with the highest promise are kept active, and the
+   * others are deactivated: their statistics are freed, and only their
+   * majority class is kept.  The promise of a leaf is the number of samples it
+   * has seen times the probability of error of its majority class, since that
+   * bounds the gain of a split of the leaf.  Inactive leaves still track their
+   * number of samples and majority probability, so that they can become active
+   * again (with new, empty statistics) when they become promising enough.  If
+   * maxActiveLeaves is 0, all the leaves are active.
+   *
+   * The limit is not serialized, and inactive leaves are saved as leaves that
+   * have not seen any samples, so they are active when the tree is loaded.
+   *
+   * @param maxActiveLeaves Maximum number of active leaves (0 for no limit).
+   */
+  void MaxActiveLeaves(const size_t maxActiveLeaves);
+
+  //! Get whether or not the node is active (only leaves can be inactive).
+  bool Active() const { return active; }
+
   /**
    * Given a point and that this node is not a leaf, calculate the index of the
    * child node this point would go towards.  This method is primarily used by
@@ -228,6 +270,18 @@ class HoeffdingTree
   template<typename VecType>
   size_t CalculateDirection(const VecType& point) const;
 
+  /**
+   * Given that this node is not a leaf, get its split as a list of split
+   * points: a point goes to the child whose index is the number of split points
+   * less than its value in the split dimension.  This is used by FlatTree.
+   *
+   * @param splitPoints This will be filled with the split points.
+   * @return false if the split is categorical and the child of a point is its
+   *     category instead, in which case splitPoints is not used.
+   */
+  template<typename eT>
+  bool SplitPoints(arma::Col<eT>& splitPoints) const;
+
   /**
    * Classify the given point, using this node and the entire (sub)tree beneath
    * it.  The predicted label is returned.
@@ -317,6 +371,17 @@ class HoeffdingTree
   bool ownsInfo;
   //! The required probability of success for a split to be performed.
   double successProbability;
+  //! Whether or not the node keeps the statistics needed to split.
+  bool active;
+  //! The number of samples seen by this node that are not in its statistics,
+  //! because it was inactive.
+  size_t inactiveSamples;
+  //! The maximum number of active leaves (0 means no limit; only used by the
+  //! root).
+  size_t maxActiveLeaves;
+  //! The number of samples seen since the last memory check (only used by the
+  //! root).
+  size_t memoryCheckSamples;
 
   // And we need to keep some information for after we have split.
 
@@ -331,6 +396,52 @@ class HoeffdingTree
   typename CategoricalSplitType<FitnessFunction>::SplitInfo categoricalSplit;
   //! If the split is numeric, this holds the splitting information.
   typename NumericSplitType<FitnessFunction>::SplitInfo numericSplit;
+
+  //! In batch mode, nodes with at least twice this many points train on
+  //! shards of at least this many points in parallel.
+  static const size_t BatchShardSize = 16384;
+  //! The maximum number of shards of a node in batch mode.
+  static const size_t MaxBatchShards = 64;
+
+  /**
+   * Train the given split statistics on the given point, with the given
+   * label.
+   */
+  template<typename VecType>
+  void TrainSplits(
+      const VecType& point,
+      const size_t label,
+      std::vector<NumericSplitType<FitnessFunction>>& numericSplits,
+      std::vector<CategoricalSplitType<FitnessFunction>>& categoricalSplits)
+      const;
+
+  /**
+   * Train the split statistics of this node on the given points in parallel,
+   * in shards that are merged in order, and then check for a split.  The node
+   * must not have seen any points yet.
+   */
+  template<typename MatType>
+  void TrainShards(const MatType& data, const arma::Row<size_t>& labels);
+
+  /**
+   * Keep the maxActiveLeaves leaves of the tree with the highest promise
+   * active, and deactivate the others.
+   */
+  void ManageMemory();
+
+  //! Get the promise of this leaf: the expected number of samples it gets
+  //! wrong.
+  double Promise() const
+  {
+    return double(numSamples + inactiveSamples) * (1.0 - majorityProbability);
+  }
+
+  //! Free the statistics of this leaf, keeping only its majority class.
+  void Deactivate();
+
+  //! Create new, empty statistics for this leaf.
+  void Reactivate();
+
   //! If the split has occurred, these are the children.
   std::vector<HoeffdingTree*> children;
 };
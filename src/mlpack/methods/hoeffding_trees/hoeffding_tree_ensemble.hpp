@@ -0,0 +1,222 @@
+/**
+ * @file hoeffding_tree_ensemble.hpp
+ *
+ * An online bagging ensemble of Hoeffding trees, whose trees are trained in
+ * parallel.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_HOEFFDING_TREES_HOEFFDING_TREE_ENSEMBLE_HPP
+#define MLPACK_METHODS_HOEFFDING_TREES_HOEFFDING_TREE_ENSEMBLE_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/math/random.hpp>
+#include "hoeffding_tree.hpp"
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * The HoeffdingTreeEnsemble class is an ensemble of Hoeffding trees trained
+ * with online bagging, as described in the following paper:
+ *
+ * @code
+ * @inproceedings{oza2001online,
+ *     title={{Online Bagging and Boosting}},
+ *     author={Oza, N.C. and Russell, S.},
+ *     year={2001},
+ *     booktitle={Proceedings of the Eighth International Workshop on
+ *         Artificial Intelligence and Statistics (AISTATS '01)},
+ *     pages={105--112}
+ * }
+ * @endcode
+ *
+ * Each tree is trained on each sample k times, where k is drawn from a Poisson
+ * distribution with mean 1; this mimics the bootstrap samples of bagging
+ * without having to see the whole stream.  Batches of samples are shared by
+ * all of the trees, which are independent, so each tree is trained on the
+ * batch by its own thread, without any locking.  The k of each tree and sample
+ * is drawn from the random stream of the tree (see math::RandomStream), at the
+ * position of the sample in the stream, so the trees don't depend on the
+ * number of threads or on how the stream is split into batches.
+ *
+ * The prediction of the ensemble is the majority vote of the trees (ties go to
+ * the lowest class), and its probability is the fraction of the trees that
+ * voted for it.
+ *
+ * @tparam TreeType Type of Hoeffding tree to use.
+ */
+template<typename TreeType>
+class HoeffdingTreeEnsemble
+{
+ public:
+  /**
+   * Create the ensemble with the given number of copies of the given tree,
+   * which is normally an untrained tree with the wanted parameters.
+   *
+   * @param tree Tree to copy.
+   * @param numTrees Number of trees in the ensemble.
+   * @param seed Seed of the random streams of the trees.
+   */
+  HoeffdingTreeEnsemble(const TreeType& tree,
+                        const size_t numTrees,
+                        const uint64_t seed = math::randStreamSeed);
+
+  /**
+   * Create an empty ensemble; this is meant to be used before Serialize().
+   */
+  HoeffdingTreeEnsemble();
+
+  /**
+   * Copy the given ensemble.
+   *
+   * @param other Ensemble to copy.
+   */
+  HoeffdingTreeEnsemble(const HoeffdingTreeEnsemble& other);
+
+  /**
+   * Move the given ensemble.
+   *
+   * @param other Ensemble to move.
+   */
+  HoeffdingTreeEnsemble(HoeffdingTreeEnsemble&& other);
+
+  /**
+   * Copy the given ensemble.
+   *
+   * @param other Ensemble to copy.
+   */
+  HoeffdingTreeEnsemble& operator=(const HoeffdingTreeEnsemble& other);
+
+  /**
+   * Move the given ensemble.
+   *
+   * @param other Ensemble to move.
+   */
+  HoeffdingTreeEnsemble& operator=(HoeffdingTreeEnsemble&& other);
+
+  /**
+   * Clean up the trees.
+   */
+  ~HoeffdingTreeEnsemble();
+
+  /**
+   * Train the trees on the given batch of samples, in parallel.  Each tree
+   * sees the samples in order, each with its own Poisson weight.
+   *
+   * @param data Batch of samples.
+   * @param labels Labels of the samples.
+   */
+  template<typename MatType>
+  void Train(const MatType& data, const arma::Row<size_t>& labels);
+
+  /**
+   * Train the trees on the given sample.
+   *
+   * @param point Sample to train on.
+   * @param label Label of the sample.
+   */
+  template<typename VecType>
+  void Train(const VecType& point, const size_t label);
+
+  /**
+   * Classify the given point by the vote of the trees.
+   *
+   * @param point Point to classify.
+   * @param prediction Predicted label of the point.
+   * @param probability Fraction of the trees that predict the label.
+   */
+  template<typename VecType>
+  void Classify(const VecType& point, size_t& prediction, double& probability)
+      const;
+
+  /**
+   * Classify the given points by the vote of the trees.  The points are
+   * classified in parallel.
+   *
+   * @param data Points to classify.
+   * @param predictions Predicted labels of the points.
+   */
+  template<typename MatType>
+  void Classify(const MatType& data, arma::Row<size_t>& predictions) const;
+
+  /**
+   * Classify the given points by the vote of the trees, also returning the
+   * fraction of the trees that predict each label.  The points are classified
+   * in parallel.
+   *
+   * @param data Points to classify.
+   * @param predictions Predicted labels of the points.
+   * @param probabilities Fraction of the trees that predict each label.
+   */
+  template<typename MatType>
+  void Classify(const MatType& data,
+                arma::Row<size_t>& predictions,
+                arma::rowvec& probabilities) const;
+
+  /**
+   * Set the maximum number of active leaves of each tree (0 means no limit);
+   * see HoeffdingTree::MaxActiveLeaves().
+   *
+   * @param maxActiveLeaves Maximum number of active leaves of each tree.
+   */
+  void MaxActiveLeaves(const size_t maxActiveLeaves);
+
+  //! Get the number of trees.
+  size_t NumTrees() const { return trees.size(); }
+
+  //! Get a tree.
+  const TreeType& Tree(const size_t i) const { return *trees[i]; }
+  //! Modify a tree.
+  TreeType& Tree(const size_t i) { return *trees[i]; }
+
+  //! Get the seed of the random streams of the trees.
+  uint64_t Seed() const { return seed; }
+
+  //! Get the number of samples trained on.
+  size_t SamplesSeen() const { return samplesSeen; }
+
+  /**
+   * Serialize the ensemble.
+   */
+  template<typename Archive>
+  void Serialize(Archive& ar, const unsigned int /* version */);
+
+ private:
+  /**
+   * Get the number of times a tree is trained on a sample, from the given
+   * uniform number in (0, 1); this inverts the cumulative distribution of the
+   * Poisson distribution with mean 1.
+   *
+   * @param u Uniform random number.
+   */
+  static size_t PoissonWeight(const double u);
+
+  /**
+   * Get the number of times the given tree is trained on the sample with the
+   * given position in the stream.
+   *
+   * @param tree Index of the tree.
+   * @param sample Position of the sample in the stream.
+   */
+  size_t Weight(const size_t tree, const size_t sample) const;
+
+  //! The trees; they are held by pointer since they can't be assigned.
+  std::vector<TreeType*> trees;
+  //! The seed of the random streams of the trees.
+  uint64_t seed;
+  //! The number of samples trained on, which is the position of the next
+  //! sample in the stream.
+  size_t samplesSeen;
+};
+
+} // namespace tree
+} // namespace mlpack
+
+// Include implementation.
+#include "hoeffding_tree_ensemble_impl.hpp"
+
+#endif
@@ -0,0 +1,282 @@
+/**
+ * @file hoeffding_tree_ensemble_impl.hpp
+ *
+ * Implementation of the HoeffdingTreeEnsemble class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_HOEFFDING_TREES_HOEFFDING_TREE_ENSEMBLE_IMPL_HPP
+#define MLPACK_METHODS_HOEFFDING_TREES_HOEFFDING_TREE_ENSEMBLE_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "hoeffding_tree_ensemble.hpp"
+
+#include <sstream>
+
+namespace mlpack {
+namespace tree {
+
+template<typename TreeType>
+HoeffdingTreeEnsemble<TreeType>::HoeffdingTreeEnsemble(
+    const TreeType& tree,
+    const size_t numTrees,
+    const uint64_t seed) :
+    trees(numTrees),
+    seed(seed),
+    samplesSeen(0)
+{
+  for (size_t i = 0; i < numTrees; ++i)
+    trees[i] = new TreeType(tree);
+}
+
+template<typename TreeType>
+HoeffdingTreeEnsemble<TreeType>::HoeffdingTreeEnsemble() :
+    seed(0),
+    samplesSeen(0)
+{
+  // Nothing to do.
+}
+
+template<typename TreeType>
+HoeffdingTreeEnsemble<TreeType>::HoeffdingTreeEnsemble(
+    const HoeffdingTreeEnsemble& other) :
+    trees(other.trees.size()),
+    seed(other.seed),
+    samplesSeen(other.samplesSeen)
+{
+  for (size_t i = 0; i < trees.size(); ++i)
+    trees[i] = new TreeType(*other.trees[i]);
+}
+
+template<typename TreeType>
+HoeffdingTreeEnsemble<TreeType>::HoeffdingTreeEnsemble(
+    HoeffdingTreeEnsemble&& other) :
+    trees(std::move(other.trees)),
+    seed(other.seed),
+    samplesSeen(other.samplesSeen)
+{
+  other.trees.clear();
+  other.samplesSeen = 0;
+}
+
+template<typename TreeType>
+HoeffdingTreeEnsemble<TreeType>& HoeffdingTreeEnsemble<TreeType>::operator=(
+    const HoeffdingTreeEnsemble& other)
+{
+  if (this != &other)
+  {
+    for (size_t i = 0; i < trees.size(); ++i)
+      delete trees[i];
+
+    trees.resize(other.trees.size());
+    for (size_t i = 0; i < trees.size(); ++i)
+      trees[i] = new TreeType(*other.trees[i]);
+    seed = other.seed;
+    samplesSeen = other.samplesSeen;
+  }
+
+  return *this;
+}
+
+template<typename TreeType>
+HoeffdingTreeEnsemble<TreeType>& HoeffdingTreeEnsemble<TreeType>::operator=(
+    HoeffdingTreeEnsemble&& other)
+{
+  if (this != &other)
+  {
+    for (size_t i = 0; i < trees.size(); ++i)
+      delete trees[i];
+
+    trees = std::move(other.trees);
+    seed = other.seed;
+    samplesSeen = other.samplesSeen;
+
+    other.trees.clear();
+    other.samplesSeen = 0;
+  }
+
+  return *this;
+}
+
+template<typename TreeType>
+HoeffdingTreeEnsemble<TreeType>::~HoeffdingTreeEnsemble()
+{
+  for (size_t i = 0; i < trees.size(); ++i)
+    delete trees[i];
+}
+
+template<typename TreeType>
+template<typename MatType>
+void HoeffdingTreeEnsemble<TreeType>::Train(const MatType& data,
+                                            const arma::Row<size_t>& labels)
+{
+  // The batch is only read, so the trees can be trained at the same time; each
+  // tree is trained by one thread, so the trees need no locking.  The trees can
+  // take very different times (they split at different times), so they are
+  // handed out dynamically.
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables. If we're building for Visual Studio, use
+  // the intmax_t type instead.
+  #pragma omp parallel for schedule(dynamic)
+  for (intmax_t t = 0; t < (intmax_t) trees.size(); ++t)
+#else
+  #pragma omp parallel for schedule(dynamic)
+  for (size_t t = 0; t < trees.size(); ++t)
+#endif
+  {
+    for (size_t i = 0; i < data.n_cols; ++i)
+    {
+      const size_t weight = Weight(t, samplesSeen + i);
+      for (size_t k = 0; k < weight; ++k)
+        trees[t]->Train(data.col(i), labels[i]);
+    }
+  }
+
+  samplesSeen += data.n_cols;
+}
+
+template<typename TreeType>
+template<typename VecType>
+void HoeffdingTreeEnsemble<TreeType>::Train(const VecType& point,
+                                            const size_t label)
+{
+  // A single sample is too little work to train the trees in parallel.
+  for (size_t t = 0; t < trees.size(); ++t)
+  {
+    const size_t weight = Weight(t, samplesSeen);
+    for (size_t k = 0; k < weight; ++k)
+      trees[t]->Train(point, label);
+  }
+
+  ++samplesSeen;
+}
+
+template<typename TreeType>
+template<typename VecType>
+void HoeffdingTreeEnsemble<TreeType>::Classify(const VecType& point,
+                                               size_t& prediction,
+                                               double& probability) const
+{
+  arma::Col<size_t> votes(trees[0]->NumClasses(), arma::fill::zeros);
+  for (size_t t = 0; t < trees.size(); ++t)
+    ++votes[trees[t]->Classify(point)];
+
+  // max() gives the first of the tied classes.
+  arma::uword maxIndex = 0;
+  votes.max(maxIndex);
+  prediction = (size_t) maxIndex;
+  probability = double(votes[prediction]) / double(trees.size());
+}
+
+template<typename TreeType>
+template<typename MatType>
+void HoeffdingTreeEnsemble<TreeType>::Classify(
+    const MatType& data,
+    arma::Row<size_t>& predictions) const
+{
+  arma::rowvec probabilities;
+  Classify(data, predictions, probabilities);
+}
+
+template<typename TreeType>
+template<typename MatType>
+void HoeffdingTreeEnsemble<TreeType>::Classify(
+    const MatType& data,
+    arma::Row<size_t>& predictions,
+    arma::rowvec& probabilities) const
+{
+  predictions.set_size(data.n_cols);
+  probabilities.set_size(data.n_cols);
+
+  // Each point is classified by all of the trees at once, so the votes of a
+  // point are counted by a single thread.
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables. If we're building for Visual Studio, use
+  // the intmax_t type instead.
+  #pragma omp parallel for
+  for (intmax_t i = 0; i < (intmax_t) data.n_cols; ++i)
+#else
+  #pragma omp parallel for
+  for (size_t i = 0; i < data.n_cols; ++i)
+#endif
+  {
+    Classify(data.col(i), predictions[i], probabilities[i]);
+  }
+}
+
+template<typename TreeType>
+void HoeffdingTreeEnsemble<TreeType>::MaxActiveLeaves(
+    const size_t maxActiveLeaves)
+{
+  for (size_t t = 0; t < trees.size(); ++t)
+    trees[t]->MaxActiveLeaves(maxActiveLeaves);
+}
+
+template<typename TreeType>
+template<typename Archive>
+void HoeffdingTreeEnsemble<TreeType>::Serialize(
+    Archive& ar,
+    const unsigned int /* version */)
+{
+  size_t numTrees = trees.size();
+  ar & data::CreateNVP(numTrees, "numTrees");
+  ar & data::CreateNVP(seed, "seed");
+  ar & data::CreateNVP(samplesSeen, "samplesSeen");
+
+  // Create fake trees to load into if needed.
+  if (Archive::is_loading::value)
+  {
+    for (size_t i = 0; i < trees.size(); ++i)
+      delete trees[i];
+
+    data::DatasetInfo info;
+    trees.resize(numTrees);
+    for (size_t i = 0; i < numTrees; ++i)
+      trees[i] = new TreeType(info, 1, 1);
+  }
+
+  for (size_t i = 0; i < numTrees; ++i)
+  {
+    std::ostringstream name;
+    name << "tree" << i;
+    ar & data::CreateNVP(*trees[i], name.str());
+  }
+}
+
+template<typename TreeType>
+size_t HoeffdingTreeEnsemble<TreeType>::PoissonWeight(const double u)
+{
+  // P(k) = e^{-1} / k!.  Past 20, the remaining probability is below the
+  // resolution of u.
+  double p = std::exp(-1.0);
+  double cdf = p;
+  size_t k = 0;
+  while (u > cdf && k < 20)
+  {
+    ++k;
+    p /= k;
+    cdf += p;
+  }
+
+  return k;
+}
+
+template<typename TreeType>
+size_t HoeffdingTreeEnsemble<TreeType>::Weight(const size_t tree,
+                                               const size_t sample) const
+{
+  // The weight of each sample takes one block of the stream of the tree.
+  math::RandomStream stream(seed, tree);
+  stream.Counter() = sample;
+  return PoissonWeight(stream.Random());
+}
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
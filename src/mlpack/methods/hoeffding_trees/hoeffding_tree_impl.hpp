@@ -49,7 +49,13 @@ HoeffdingTree<
     datasetInfo(&datasetInfo),
     ownsInfo(false),
     successProbability(successProbability),
+    active(true),
+    inactiveSamples(0),
+    maxActiveLeaves(0),
+    memoryCheckSamples(0),
     splitDimension(size_t(-1)),
+    majorityClass(0),
+    majorityProbability(0.0),
     categoricalSplit(0),
     numericSplit()
 {
@@ -105,7 +111,13 @@ HoeffdingTree<
     datasetInfo(&datasetInfo),
     ownsInfo(false),
     successProbability(successProbability),
+    active(true),
+    inactiveSamples(0),
+    maxActiveLeaves(0),
+    memoryCheckSamples(0),
     splitDimension(size_t(-1)),
+    majorityClass(0),
+    majorityProbability(0.0),
     categoricalSplit(0),
     numericSplit()
 {
@@ -167,6 +179,10 @@ HoeffdingTree<FitnessFunction, NumericSplitType, CategoricalSplitType>::
     datasetInfo(new data::DatasetInfo(*other.datasetInfo)),
     ownsInfo(true),
     successProbability(other.successProbability),
+    active(other.active),
+    inactiveSamples(other.inactiveSamples),
+    maxActiveLeaves(other.maxActiveLeaves),
+    memoryCheckSamples(other.memoryCheckSamples),
     splitDimension(other.splitDimension),
     majorityClass(other.majorityClass),
     majorityProbability(other.majorityProbability),
@@ -212,8 +228,16 @@ void HoeffdingTree<
     // Don't split if there are fewer than five points.
     size_t oldMaxSamples = maxSamples;
     maxSamples = std::max(size_t(data.n_cols - 1), size_t(5));
-    for (size_t i = 0; i < data.n_cols; ++i)
-      Train(data.col(i), labels[i]);
+    if (active && numSamples == 0 && splitDimension == size_t(-1) &&
+        data.n_cols >= 2 * BatchShardSize)
+    {
+      TrainShards(data, labels);
+    }
+    else
+    {
+      for (size_t i = 0; i < data.n_cols; ++i)
+        Train(data.col(i), labels[i]);
+    }
     maxSamples = oldMaxSamples;
 
     // Now, if we did split, find out which points go to which child, and
@@ -261,6 +285,10 @@ void HoeffdingTree<
         children[i]->Train(childData, childLabels, true);
       }
     }
+
+    // Enforce the memory budget now that the whole subtree is trained.
+    if (maxActiveLeaves > 0)
+      ManageMemory();
   }
   else
   {
@@ -281,18 +309,19 @@ void HoeffdingTree<
     CategoricalSplitType
 >::Train(const VecType& point, const size_t label)
 {
-  if (splitDimension == size_t(-1))
+  if (splitDimension == size_t(-1) && !active)
+  {
+    // An inactive leaf has no statistics; it only tracks how often its
+    // majority class is right, so that its promise can be computed.
+    const double total = (double) inactiveSamples;
+    majorityProbability = (majorityProbability * total +
+        ((label == majorityClass) ? 1.0 : 0.0)) / (total + 1.0);
+    ++inactiveSamples;
+  }
+  else if (splitDimension == size_t(-1))
   {
     ++numSamples;
-    size_t numericIndex = 0;
-    size_t categoricalIndex = 0;
-    for (size_t i = 0; i < point.n_rows; ++i)
-    {
-      if (datasetInfo->Type(i) == data::Datatype::categorical)
-        categoricalSplits[categoricalIndex++].Train(point[i], label);
-      else if (datasetInfo->Type(i) == data::Datatype::numeric)
-        numericSplits[numericIndex++].Train(point[i], label);
-    }
+    TrainSplits(point, label, numericSplits, categoricalSplits);
 
     // Grab majority class from splits.
     if (categoricalSplits.size() > 0)
@@ -325,6 +354,148 @@ void HoeffdingTree<
     size_t direction = CalculateDirection(point);
     children[direction]->Train(point, label);
   }
+
+  // If there is a memory budget (only set on the root), enforce it every
+  // checkInterval samples.
+  if (maxActiveLeaves > 0 && ++memoryCheckSamples >= checkInterval)
+  {
+    memoryCheckSamples = 0;
+    ManageMemory();
+  }
+}
+
+//! Train on the blocks of a reader.
+template<typename FitnessFunction,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType>
+void HoeffdingTree<
+    FitnessFunction,
+    NumericSplitType,
+    CategoricalSplitType
+>::Train(data::ChunkedReader& reader)
+{
+  const size_t dimensionality = datasetInfo->Dimensionality();
+  if (reader.Dimensionality() != dimensionality + 1)
+  {
+    std::ostringstream oss;
+    oss << "HoeffdingTree::Train(): the blocks of '" << reader.Filename()
+        << "' have " << reader.Dimensionality() << " rows, but the tree needs "
+        << dimensionality << " dimensions and a row of labels";
+    throw std::invalid_argument(oss.str());
+  }
+
+  arma::mat block;
+  while (reader.Next(block))
+  {
+    for (size_t i = 0; i < block.n_cols; ++i)
+    {
+      // Use the memory of the block instead of copying each point.
+      const arma::vec point(block.colptr(i), dimensionality, false, true);
+      Train(point, (size_t) block(dimensionality, i));
+    }
+  }
+}
+
+//! Train the given split statistics on one point.
+template<typename FitnessFunction,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType>
+template<typename VecType>
+void HoeffdingTree<
+    FitnessFunction,
+    NumericSplitType,
+    CategoricalSplitType
+>::TrainSplits(
+    const VecType& point,
+    const size_t label,
+    std::vector<NumericSplitType<FitnessFunction>>& numericSplits,
+    std::vector<CategoricalSplitType<FitnessFunction>>& categoricalSplits)
+    const
+{
+  size_t numericIndex = 0;
+  size_t categoricalIndex = 0;
+  for (size_t i = 0; i < point.n_rows; ++i)
+  {
+    if (datasetInfo->Type(i) == data::Datatype::categorical)
+      categoricalSplits[categoricalIndex++].Train(point[i], label);
+    else if (datasetInfo->Type(i) == data::Datatype::numeric)
+      numericSplits[numericIndex++].Train(point[i], label);
+  }
+}
+
+//! Train on a set of points in parallel shards.
+template<typename FitnessFunction,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType>
+template<typename MatType>
+void HoeffdingTree<
+    FitnessFunction,
+    NumericSplitType,
+    CategoricalSplitType
+>::TrainShards(const MatType& data, const arma::Row<size_t>& labels)
+{
+  // The shards only depend on the number of points, so the merged statistics
+  // don't depend on the number of threads.  Since this node hasn't seen any
+  // points, copies of its split statistics are empty.
+  const size_t numShards = std::min(size_t(data.n_cols / BatchShardSize),
+      size_t(MaxBatchShards));
+  std::vector<std::vector<NumericSplitType<FitnessFunction>>>
+      shardNumericSplits(numShards, numericSplits);
+  std::vector<std::vector<CategoricalSplitType<FitnessFunction>>>
+      shardCategoricalSplits(numShards, categoricalSplits);
+
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables. If we're building for Visual Studio, use
+  // the intmax_t type instead.
+  #pragma omp parallel for
+  for (intmax_t s = 0; s < (intmax_t) numShards; ++s)
+#else
+  #pragma omp parallel for
+  for (size_t s = 0; s < numShards; ++s)
+#endif
+  {
+    const size_t begin = (s * data.n_cols) / numShards;
+    const size_t end = ((s + 1) * data.n_cols) / numShards;
+    for (size_t i = begin; i < end; ++i)
+    {
+      TrainSplits(data.col(i), labels[i], shardNumericSplits[s],
+          shardCategoricalSplits[s]);
+    }
+  }
+
+  // Merge the shards in order; the first one is merged into empty statistics.
+  for (size_t s = 0; s < numShards; ++s)
+  {
+    for (size_t i = 0; i < numericSplits.size(); ++i)
+      numericSplits[i].Merge(shardNumericSplits[s][i]);
+    for (size_t i = 0; i < categoricalSplits.size(); ++i)
+      categoricalSplits[i].Merge(shardCategoricalSplits[s][i]);
+  }
+  numSamples = data.n_cols;
+
+  // Grab majority class from splits.
+  if (categoricalSplits.size() > 0)
+  {
+    majorityClass = categoricalSplits[0].MajorityClass();
+    majorityProbability = categoricalSplits[0].MajorityProbability();
+  }
+  else
+  {
+    majorityClass = numericSplits[0].MajorityClass();
+    majorityProbability = numericSplits[0].MajorityProbability();
+  }
+
+  // Check for a split, as the last point in serial batch training would.
+  if (numSamples % checkInterval == 0)
+  {
+    const size_t numChildren = SplitCheck();
+    if (numChildren > 0)
+    {
+      children.clear();
+      CreateChildren();
+    }
+  }
 }
 
 template<typename FitnessFunction,
@@ -336,8 +507,8 @@ size_t HoeffdingTree<
     CategoricalSplitType
 >::SplitCheck()
 {
-  // Do nothing if we've already split.
-  if (splitDimension != size_t(-1))
+  // Do nothing if we've already split, or if we have no statistics.
+  if (splitDimension != size_t(-1) || !active)
     return 0;
 
   // If not enough points have been seen, we cannot split.
@@ -480,6 +651,134 @@ void HoeffdingTree<
     children[i]->CheckInterval(checkInterval);
 }
 
+template<
+    typename FitnessFunction,
+    template<typename> class NumericSplitType,
+    template<typename> class CategoricalSplitType
+>
+void HoeffdingTree<
+    FitnessFunction,
+    NumericSplitType,
+    CategoricalSplitType
+>::MaxActiveLeaves(const size_t maxActiveLeaves)
+{
+  this->maxActiveLeaves = maxActiveLeaves;
+  memoryCheckSamples = 0;
+  ManageMemory();
+}
+
+template<
+    typename FitnessFunction,
+    template<typename> class NumericSplitType,
+    template<typename> class CategoricalSplitType
+>
+void HoeffdingTree<
+    FitnessFunction,
+    NumericSplitType,
+    CategoricalSplitType
+>::ManageMemory()
+{
+  // Collect the leaves of the tree.
+  std::vector<HoeffdingTree*> leaves;
+  std::vector<HoeffdingTree*> stack(1, this);
+  while (!stack.empty())
+  {
+    HoeffdingTree* node = stack.back();
+    stack.pop_back();
+    if (node->splitDimension == size_t(-1))
+      leaves.push_back(node);
+    for (size_t i = 0; i < node->children.size(); ++i)
+      stack.push_back(node->children[i]);
+  }
+
+  // If there are too many leaves, sort them so the most promising come first.
+  // The sort is stable, so ties keep the same order every time.
+  size_t numActive = leaves.size();
+  if (maxActiveLeaves > 0 && maxActiveLeaves < leaves.size())
+  {
+    numActive = maxActiveLeaves;
+    std::stable_sort(leaves.begin(), leaves.end(),
+        [](const HoeffdingTree* a, const HoeffdingTree* b)
+        {
+          return a->Promise() > b->Promise();
+        });
+  }
+
+  for (size_t i = 0; i < leaves.size(); ++i)
+  {
+    if (i < numActive && !leaves[i]->active)
+      leaves[i]->Reactivate();
+    else if (i >= numActive && leaves[i]->active)
+      leaves[i]->Deactivate();
+  }
+}
+
+template<
+    typename FitnessFunction,
+    template<typename> class NumericSplitType,
+    template<typename> class CategoricalSplitType
+>
+void HoeffdingTree<
+    FitnessFunction,
+    NumericSplitType,
+    CategoricalSplitType
+>::Deactivate()
+{
+  inactiveSamples += numSamples;
+  numSamples = 0;
+
+  // Keep one empty split of each type, so that the statistics can be rebuilt
+  // with the same parameters.  Swapping with a new vector frees the memory.
+  if (numericSplits.size() > 0)
+  {
+    std::vector<NumericSplitType<FitnessFunction>>(1,
+        NumericSplitType<FitnessFunction>(numClasses, numericSplits[0])).swap(
+        numericSplits);
+  }
+  if (categoricalSplits.size() > 0)
+  {
+    std::vector<CategoricalSplitType<FitnessFunction>>(1,
+        CategoricalSplitType<FitnessFunction>(0, numClasses,
+        categoricalSplits[0])).swap(categoricalSplits);
+  }
+
+  active = false;
+}
+
+template<
+    typename FitnessFunction,
+    template<typename> class NumericSplitType,
+    template<typename> class CategoricalSplitType
+>
+void HoeffdingTree<
+    FitnessFunction,
+    NumericSplitType,
+    CategoricalSplitType
+>::Reactivate()
+{
+  // There is a kept split of a type if and only if the dataset has dimensions
+  // of that type.
+  std::vector<NumericSplitType<FitnessFunction>> newNumericSplits;
+  std::vector<CategoricalSplitType<FitnessFunction>> newCategoricalSplits;
+  for (size_t i = 0; i < datasetInfo->Dimensionality(); ++i)
+  {
+    if (datasetInfo->Type(i) == data::Datatype::categorical)
+    {
+      newCategoricalSplits.push_back(CategoricalSplitType<FitnessFunction>(
+          datasetInfo->NumMappings(i), numClasses, categoricalSplits[0]));
+    }
+    else
+    {
+      newNumericSplits.push_back(NumericSplitType<FitnessFunction>(numClasses,
+          numericSplits[0]));
+    }
+  }
+
+  numericSplits.swap(newNumericSplits);
+  categoricalSplits.swap(newCategoricalSplits);
+  active = true;
+}
+
 template<
     typename FitnessFunction,
     template<typename> class NumericSplitType,
@@ -501,6 +800,24 @@ size_t HoeffdingTree<
     return 0; // Not sure what to do here...
 }
 
+template<
+    typename FitnessFunction,
+    template<typename> class NumericSplitType,
+    template<typename> class CategoricalSplitType
+>
+template<typename eT>
+bool HoeffdingTree<
+    FitnessFunction,
+    NumericSplitType,
+    CategoricalSplitType
+>::SplitPoints(arma::Col<eT>& splitPoints) const
+{
+  if (datasetInfo->Type(splitDimension) == data::Datatype::numeric)
+    return numericSplit.SplitPoints(splitPoints);
+  else
+    return categoricalSplit.SplitPoints(splitPoints);
+}
+
 template<
     typename FitnessFunction,
     template<typename> class NumericSplitType,
@@ -698,6 +1015,12 @@ void HoeffdingTree<
     for (size_t i = 0; i < children.size(); ++i)
       delete children[i];
     children.clear();
+
+    // Inactive leaves are saved as leaves that haven't seen any samples, so
+    // every loaded node is active.
+    active = true;
+    inactiveSamples = 0;
+    memoryCheckSamples = 0;
   }
 
   ar & CreateNVP(majorityClass, "majorityClass");
@@ -11,10 +11,12 @@
  */
 #include <mlpack/prereqs.hpp>
 #include <mlpack/core/util/cli.hpp>
+#include <mlpack/core/math/random.hpp>
 #include <mlpack/methods/hoeffding_trees/hoeffding_tree.hpp>
 #include <mlpack/methods/hoeffding_trees/binary_numeric_split.hpp>
 #include <mlpack/methods/hoeffding_trees/information_gain.hpp>
 #include <mlpack/methods/hoeffding_trees/hoeffding_tree_model.hpp>
+#include <ctime>
 #include <queue>
 
 using namespace std;
@@ -46,7 +48,23 @@ PROGRAM_INFO("Hoeffding trees",
     " with the --test_labels_file (-L) option.  Predictions for each test point"
     " will be stored in the file specified by --predictions_file (-p) and "
     "probabilities for each predictions will be stored in the file specified by"
-    " the --probabilities_file (-P) option.");
+    " the --probabilities_file (-P) option."
+    "\n\n"
+    "The memory used by the tree may be bounded with the --max_active_leaves "
+    "(-a) option: only that many leaves (the most promising ones) keep the "
+    "statistics needed to split, and the other leaves only keep their majority "
+    "class until they become promising enough.  The limit is not saved with the"
+    " model, so it must be given each time the model is trained."
+    "\n\n"
+    "An ensemble of Hoeffding trees may be trained instead of a single tree "
+    "with the --num_trees (-e) option.  The trees are trained with online "
+    "bagging: each tree is trained on each sample a random number of times "
+    "(drawn from a Poisson distribution with mean 1), and the trees are "
+    "trained in parallel.  The ensemble predicts the class that the most trees"
+    " vote for, with the fraction of the trees that vote for it as its "
+    "probability.  Ensembles are always trained in streaming mode, and the "
+    "random numbers depend on the --seed (-S) option, but not on the number of"
+    " threads.");
 
 PARAM_MATRIX_AND_INFO_IN("training", "Training dataset (may be categorical).",
     "t");
@@ -85,6 +103,11 @@ PARAM_INT_IN("bins", "If the 'domingos' split strategy is used, this specifies "
 PARAM_INT_IN("observations_before_binning", "If the 'domingos' split strategy "
     "is used, this specifies the number of samples observed before binning is "
     "performed.", "o", 100);
+PARAM_INT_IN("max_active_leaves", "Maximum number of leaves that keep the "
+    "statistics needed to split (0 means no limit).", "a", 0);
+PARAM_INT_IN("num_trees", "Number of trees of the online bagging ensemble to "
+    "train (1 trains a single tree).", "e", 1);
+PARAM_INT_IN("seed", "Random seed.  If 0, 'std::time(NULL)' is used.", "S", 0);
 
 // Convenience typedef.
 typedef tuple<DatasetInfo, arma::mat> TupleType;
@@ -93,6 +116,11 @@ int main(int argc, char** argv)
 {
   CLI::ParseCommandLine(argc, argv);
 
+  if (CLI::GetParam<int>("seed") != 0)
+    math::RandomSeed((size_t) CLI::GetParam<int>("seed"));
+  else
+    math::RandomSeed((size_t) std::time(NULL));
+
   // Check input parameters for validity.
   const string numericSplitStrategy =
       CLI::GetParam<string>("numeric_split_strategy");
@@ -124,6 +152,24 @@ int main(int argc, char** argv)
         << "--test_labels_file (-L) are specified, so no output will be given!"
         << endl;
 
+  if (CLI::GetParam<int>("max_active_leaves") < 0)
+    Log::Fatal << "Invalid value for --max_active_leaves ("
+        << CLI::GetParam<int>("max_active_leaves") << "); must be 0 or greater."
+        << endl;
+
+  if (CLI::GetParam<int>("num_trees") < 1)
+    Log::Fatal << "Invalid value for --num_trees ("
+        << CLI::GetParam<int>("num_trees") << "); must be 1 or greater."
+        << endl;
+
+  if (CLI::HasParam("input_model") && CLI::HasParam("num_trees"))
+    Log::Warn << "--num_trees (-e) ignored because --input_model_file (-m) "
+        << "was specified." << endl;
+
+  if (CLI::GetParam<int>("num_trees") > 1 && CLI::HasParam("batch_mode"))
+    Log::Warn << "--batch_mode (-b) ignored because --num_trees (-e) is greater"
+        << " than 1." << endl;
+
   if ((numericSplitStrategy != "domingos") &&
       (numericSplitStrategy != "binary"))
   {
@@ -165,6 +211,9 @@ int main(int argc, char** argv)
     const size_t bins = (size_t) CLI::GetParam<int>("bins");
     const size_t observationsBeforeBinning = (size_t)
         CLI::GetParam<int>("observations_before_binning");
+    const size_t maxActiveLeaves = (size_t)
+        CLI::GetParam<int>("max_active_leaves");
+    const size_t numTrees = (size_t) CLI::GetParam<int>("num_trees");
     size_t passes = (size_t) CLI::GetParam<int>("passes");
     if (passes > 1)
       batchTraining = false; // We already warned about this earlier.
@@ -190,9 +239,15 @@ int main(int argc, char** argv)
       // Build the model.
       model.BuildModel(trainingSet, datasetInfo, labels,
           arma::max(labels) + 1, batchTraining, confidence, maxSamples,
-          100, minSamples, bins, observationsBeforeBinning);
+          100, minSamples, bins, observationsBeforeBinning, maxActiveLeaves,
+          numTrees);
       --passes; // This model-building takes one pass.
     }
+    else
+    {
+      // The memory budget isn't saved with the model.
+      model.MaxActiveLeaves(maxActiveLeaves);
+    }
 
     // Now pass over the trees as many times as we need to.
     if (batchTraining)
@@ -229,7 +284,11 @@ int main(int argc, char** argv)
   }
 
   // Get the number of nodes in the tree.
-  Log::Info << model.NumNodes() << " nodes in the tree." << endl;
+  if (model.NumTrees() > 1)
+    Log::Info << model.NumNodes() << " nodes in the " << model.NumTrees()
+        << " trees of the ensemble." << endl;
+  else
+    Log::Info << model.NumNodes() << " nodes in the tree." << endl;
 
   // The tree is trained or loaded.  Now do any testing if we need.
   if (CLI::HasParam("test"))
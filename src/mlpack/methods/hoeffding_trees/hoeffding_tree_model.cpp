@@ -17,7 +17,11 @@ HoeffdingTreeModel::HoeffdingTreeModel(const TreeType& type) :
     giniHoeffdingTree(NULL),
     giniBinaryTree(NULL),
     infoHoeffdingTree(NULL),
-    infoBinaryTree(NULL)
+    infoBinaryTree(NULL),
+    giniHoeffdingEnsemble(NULL),
+    giniBinaryEnsemble(NULL),
+    infoHoeffdingEnsemble(NULL),
+    infoBinaryEnsemble(NULL)
 {
   // Nothing to do.
 }
@@ -32,7 +36,15 @@ HoeffdingTreeModel::HoeffdingTreeModel(const HoeffdingTreeModel& other) :
     infoHoeffdingTree(other.infoHoeffdingTree ? new InfoHoeffdingTreeType(
         *other.infoHoeffdingTree) : NULL),
     infoBinaryTree(other.infoBinaryTree ? new InfoBinaryTreeType(
-        *other.infoBinaryTree) : NULL)
+        *other.infoBinaryTree) : NULL),
+    giniHoeffdingEnsemble(other.giniHoeffdingEnsemble ?
+        new GiniHoeffdingEnsembleType(*other.giniHoeffdingEnsemble) : NULL),
+    giniBinaryEnsemble(other.giniBinaryEnsemble ?
+        new GiniBinaryEnsembleType(*other.giniBinaryEnsemble) : NULL),
+    infoHoeffdingEnsemble(other.infoHoeffdingEnsemble ?
+        new InfoHoeffdingEnsembleType(*other.infoHoeffdingEnsemble) : NULL),
+    infoBinaryEnsemble(other.infoBinaryEnsemble ?
+        new InfoBinaryEnsembleType(*other.infoBinaryEnsemble) : NULL)
 {
   // Nothing else to do.
 }
@@ -43,7 +55,11 @@ HoeffdingTreeModel::HoeffdingTreeModel(HoeffdingTreeModel&& other) :
     giniHoeffdingTree(other.giniHoeffdingTree),
     giniBinaryTree(other.giniBinaryTree),
     infoHoeffdingTree(other.infoHoeffdingTree),
-    infoBinaryTree(other.infoBinaryTree)
+    infoBinaryTree(other.infoBinaryTree),
+    giniHoeffdingEnsemble(other.giniHoeffdingEnsemble),
+    giniBinaryEnsemble(other.giniBinaryEnsemble),
+    infoHoeffdingEnsemble(other.infoHoeffdingEnsemble),
+    infoBinaryEnsemble(other.infoBinaryEnsemble)
 {
   // Reset other model.
   other.type = GINI_HOEFFDING;
@@ -51,6 +67,10 @@ HoeffdingTreeModel::HoeffdingTreeModel(HoeffdingTreeModel&& other) :
   other.giniBinaryTree = NULL;
   other.infoHoeffdingTree = NULL;
   other.infoBinaryTree = NULL;
+  other.giniHoeffdingEnsemble = NULL;
+  other.giniBinaryEnsemble = NULL;
+  other.infoHoeffdingEnsemble = NULL;
+  other.infoBinaryEnsemble = NULL;
 }
 
 // Copy operator.
@@ -58,15 +78,7 @@ HoeffdingTreeModel& HoeffdingTreeModel::operator=(
     const HoeffdingTreeModel& other)
 {
   // Clear this model.
-  delete giniHoeffdingTree;
-  delete giniBinaryTree;
-  delete infoHoeffdingTree;
-  delete infoBinaryTree;
-
-  giniHoeffdingTree = NULL;
-  giniBinaryTree = NULL;
-  infoHoeffdingTree = NULL;
-  infoBinaryTree = NULL;
+  Clear();
 
   // Create the right tree.
   type = other.type;
@@ -78,6 +90,16 @@ HoeffdingTreeModel& HoeffdingTreeModel::operator=(
     infoHoeffdingTree = new InfoHoeffdingTreeType(*other.infoHoeffdingTree);
   else if (other.infoBinaryTree && (type == INFO_BINARY))
     infoBinaryTree = new InfoBinaryTreeType(*other.infoBinaryTree);
+  else if (other.giniHoeffdingEnsemble && (type == GINI_HOEFFDING))
+    giniHoeffdingEnsemble = new GiniHoeffdingEnsembleType(
+        *other.giniHoeffdingEnsemble);
+  else if (other.giniBinaryEnsemble && (type == GINI_BINARY))
+    giniBinaryEnsemble = new GiniBinaryEnsembleType(*other.giniBinaryEnsemble);
+  else if (other.infoHoeffdingEnsemble && (type == INFO_HOEFFDING))
+    infoHoeffdingEnsemble = new InfoHoeffdingEnsembleType(
+        *other.infoHoeffdingEnsemble);
+  else if (other.infoBinaryEnsemble && (type == INFO_BINARY))
+    infoBinaryEnsemble = new InfoBinaryEnsembleType(*other.infoBinaryEnsemble);
 
   return *this;
 }
@@ -86,16 +108,17 @@ HoeffdingTreeModel& HoeffdingTreeModel::operator=(
 HoeffdingTreeModel& HoeffdingTreeModel::operator=(HoeffdingTreeModel&& other)
 {
   // Clear this model.
-  delete giniHoeffdingTree;
-  delete giniBinaryTree;
-  delete infoHoeffdingTree;
-  delete infoBinaryTree;
+  Clear();
 
   type = other.type;
   giniHoeffdingTree = other.giniHoeffdingTree;
   giniBinaryTree = other.giniBinaryTree;
   infoHoeffdingTree = other.infoHoeffdingTree;
   infoBinaryTree = other.infoBinaryTree;
+  giniHoeffdingEnsemble = other.giniHoeffdingEnsemble;
+  giniBinaryEnsemble = other.giniBinaryEnsemble;
+  infoHoeffdingEnsemble = other.infoHoeffdingEnsemble;
+  infoBinaryEnsemble = other.infoBinaryEnsemble;
 
   // Clear the other model.
   other.type = GINI_HOEFFDING;
@@ -103,17 +126,40 @@ HoeffdingTreeModel& HoeffdingTreeModel::operator=(HoeffdingTreeModel&& other)
   other.giniBinaryTree = NULL;
   other.infoHoeffdingTree = NULL;
   other.infoBinaryTree = NULL;
+  other.giniHoeffdingEnsemble = NULL;
+  other.giniBinaryEnsemble = NULL;
+  other.infoHoeffdingEnsemble = NULL;
+  other.infoBinaryEnsemble = NULL;
 
   return *this;
 }
 
 // Destructor.
 HoeffdingTreeModel::~HoeffdingTreeModel()
+{
+  Clear();
+}
+
+// Delete the tree or ensemble.
+void HoeffdingTreeModel::Clear()
 {
   delete giniHoeffdingTree;
   delete giniBinaryTree;
   delete infoHoeffdingTree;
   delete infoBinaryTree;
+  delete giniHoeffdingEnsemble;
+  delete giniBinaryEnsemble;
+  delete infoHoeffdingEnsemble;
+  delete infoBinaryEnsemble;
+
+  giniHoeffdingTree = NULL;
+  giniBinaryTree = NULL;
+  infoHoeffdingTree = NULL;
+  infoBinaryTree = NULL;
+  giniHoeffdingEnsemble = NULL;
+  giniBinaryEnsemble = NULL;
+  infoHoeffdingEnsemble = NULL;
+  infoBinaryEnsemble = NULL;
 }
 
 // Create the model.
@@ -128,8 +174,22 @@ void HoeffdingTreeModel::BuildModel(
     const size_t checkInterval,
     const size_t minSamples,
     const size_t bins,
-    const size_t observationsBeforeBinning)
+    const size_t observationsBeforeBinning,
+    const size_t maxActiveLeaves,
+    const size_t numTrees)
 {
+  // If there is a memory budget, it has to be set before training, and the
+  // trees of an ensemble are copies of an untrained tree, so in both cases
+  // build the tree on no points first.
+  const arma::mat emptySet(dataset.n_rows, 0);
+  const arma::Row<size_t> emptyLabels;
+  const bool deferred = (maxActiveLeaves > 0) || (numTrees > 1);
+  const arma::mat& initialSet = deferred ? emptySet : dataset;
+  const arma::Row<size_t>& initialLabels = deferred ? emptyLabels : labels;
+  const bool initialBatch = batchTraining && !deferred;
+
+  Clear();
+
   // Depending on the type, create the tree.
   switch (type)
   {
@@ -139,17 +199,17 @@ void HoeffdingTreeModel::BuildModel(
         HoeffdingDoubleNumericSplit<GiniImpurity> ns(0, bins,
             observationsBeforeBinning);
 
-        giniHoeffdingTree = new GiniHoeffdingTreeType(dataset, datasetInfo,
-            labels, numClasses, batchTraining, successProbability, maxSamples,
-            checkInterval, minSamples,
+        giniHoeffdingTree = new GiniHoeffdingTreeType(initialSet,
+            datasetInfo, initialLabels, numClasses, initialBatch,
+            successProbability, maxSamples, checkInterval, minSamples,
             HoeffdingCategoricalSplit<GiniImpurity>(0, 0), ns);
       }
       break;
 
     case GINI_BINARY:
-      giniBinaryTree = new GiniBinaryTreeType(dataset, datasetInfo, labels,
-          numClasses, batchTraining, successProbability, maxSamples,
-          checkInterval, minSamples);
+      giniBinaryTree = new GiniBinaryTreeType(initialSet, datasetInfo,
+          initialLabels, numClasses, initialBatch, successProbability,
+          maxSamples, checkInterval, minSamples);
       break;
 
     case INFO_HOEFFDING:
@@ -158,19 +218,61 @@ void HoeffdingTreeModel::BuildModel(
         HoeffdingDoubleNumericSplit<InformationGain> ns(0, bins,
             observationsBeforeBinning);
 
-        infoHoeffdingTree = new InfoHoeffdingTreeType(dataset, datasetInfo,
-            labels, numClasses, batchTraining, successProbability, maxSamples,
-            checkInterval, minSamples,
+        infoHoeffdingTree = new InfoHoeffdingTreeType(initialSet,
+            datasetInfo, initialLabels, numClasses, initialBatch,
+            successProbability, maxSamples, checkInterval, minSamples,
             HoeffdingCategoricalSplit<InformationGain>(0, 0), ns);
       }
       break;
 
     case INFO_BINARY:
-      infoBinaryTree = new InfoBinaryTreeType(dataset, datasetInfo, labels,
-          numClasses, batchTraining, successProbability, maxSamples,
-          checkInterval, minSamples);
+      infoBinaryTree = new InfoBinaryTreeType(initialSet, datasetInfo,
+          initialLabels, numClasses, initialBatch, successProbability,
+          maxSamples, checkInterval, minSamples);
       break;
   }
+
+  if (numTrees > 1)
+  {
+    switch (type)
+    {
+      case GINI_HOEFFDING:
+        giniHoeffdingEnsemble = new GiniHoeffdingEnsembleType(
+            *giniHoeffdingTree, numTrees);
+        break;
+
+      case GINI_BINARY:
+        giniBinaryEnsemble = new GiniBinaryEnsembleType(*giniBinaryTree,
+            numTrees);
+        break;
+
+      case INFO_HOEFFDING:
+        infoHoeffdingEnsemble = new InfoHoeffdingEnsembleType(
+            *infoHoeffdingTree, numTrees);
+        break;
+
+      case INFO_BINARY:
+        infoBinaryEnsemble = new InfoBinaryEnsembleType(*infoBinaryTree,
+            numTrees);
+        break;
+    }
+
+    delete giniHoeffdingTree;
+    delete giniBinaryTree;
+    delete infoHoeffdingTree;
+    delete infoBinaryTree;
+
+    giniHoeffdingTree = NULL;
+    giniBinaryTree = NULL;
+    infoHoeffdingTree = NULL;
+    infoBinaryTree = NULL;
+  }
+
+  if (deferred)
+  {
+    MaxActiveLeaves(maxActiveLeaves);
+    Train(dataset, labels, batchTraining);
+  }
 }
 
 // Train the model on one pass of the dataset.
@@ -178,23 +280,71 @@ void HoeffdingTreeModel::Train(const arma::mat& dataset,
                                const arma::Row<size_t>& labels,
                                const bool batchTraining)
 {
-  // Depending on the type, pass through once.
+  // Depending on the type, pass through once.  Ensembles are always trained
+  // in streaming mode.
   switch (type)
   {
     case GINI_HOEFFDING:
-      giniHoeffdingTree->Train(dataset, labels, batchTraining);
+      if (giniHoeffdingEnsemble)
+        giniHoeffdingEnsemble->Train(dataset, labels);
+      else
+        giniHoeffdingTree->Train(dataset, labels, batchTraining);
       break;
 
     case GINI_BINARY:
-      giniBinaryTree->Train(dataset, labels, batchTraining);
+      if (giniBinaryEnsemble)
+        giniBinaryEnsemble->Train(dataset, labels);
+      else
+        giniBinaryTree->Train(dataset, labels, batchTraining);
       break;
 
     case INFO_HOEFFDING:
-      infoHoeffdingTree->Train(dataset, labels, batchTraining);
+      if (infoHoeffdingEnsemble)
+        infoHoeffdingEnsemble->Train(dataset, labels);
+      else
+        infoHoeffdingTree->Train(dataset, labels, batchTraining);
       break;
 
     case INFO_BINARY:
-      infoBinaryTree->Train(dataset, labels, batchTraining);
+      if (infoBinaryEnsemble)
+        infoBinaryEnsemble->Train(dataset, labels);
+      else
+        infoBinaryTree->Train(dataset, labels, batchTraining);
+      break;
+  }
+}
+
+// Set the memory budget of the tree.
+void HoeffdingTreeModel::MaxActiveLeaves(const size_t maxActiveLeaves)
+{
+  switch (type)
+  {
+    case GINI_HOEFFDING:
+      if (giniHoeffdingEnsemble)
+        giniHoeffdingEnsemble->MaxActiveLeaves(maxActiveLeaves);
+      else
+        giniHoeffdingTree->MaxActiveLeaves(maxActiveLeaves);
+      break;
+
+    case GINI_BINARY:
+      if (giniBinaryEnsemble)
+        giniBinaryEnsemble->MaxActiveLeaves(maxActiveLeaves);
+      else
+        giniBinaryTree->MaxActiveLeaves(maxActiveLeaves);
+      break;
+
+    case INFO_HOEFFDING:
+      if (infoHoeffdingEnsemble)
+        infoHoeffdingEnsemble->MaxActiveLeaves(maxActiveLeaves);
+      else
+        infoHoeffdingTree->MaxActiveLeaves(maxActiveLeaves);
+      break;
+
+    case INFO_BINARY:
+      if (infoBinaryEnsemble)
+        infoBinaryEnsemble->MaxActiveLeaves(maxActiveLeaves);
+      else
+        infoBinaryTree->MaxActiveLeaves(maxActiveLeaves);
       break;
   }
 }
@@ -207,19 +357,31 @@ void HoeffdingTreeModel::Classify(const arma::mat& dataset,
   switch (type)
   {
     case GINI_HOEFFDING:
-      giniHoeffdingTree->Classify(dataset, predictions);
+      if (giniHoeffdingEnsemble)
+        giniHoeffdingEnsemble->Classify(dataset, predictions);
+      else
+        giniHoeffdingTree->Classify(dataset, predictions);
       break;
 
     case GINI_BINARY:
-      giniBinaryTree->Classify(dataset, predictions);
+      if (giniBinaryEnsemble)
+        giniBinaryEnsemble->Classify(dataset, predictions);
+      else
+        giniBinaryTree->Classify(dataset, predictions);
       break;
 
     case INFO_HOEFFDING:
-      infoHoeffdingTree->Classify(dataset, predictions);
+      if (infoHoeffdingEnsemble)
+        infoHoeffdingEnsemble->Classify(dataset, predictions);
+      else
+        infoHoeffdingTree->Classify(dataset, predictions);
       break;
 
     case INFO_BINARY:
-      infoBinaryTree->Classify(dataset, predictions);
+      if (infoBinaryEnsemble)
+        infoBinaryEnsemble->Classify(dataset, predictions);
+      else
+        infoBinaryTree->Classify(dataset, predictions);
       break;
   }
 }
@@ -233,33 +395,45 @@ void HoeffdingTreeModel::Classify(const arma::mat& dataset,
   switch (type)
   {
     case GINI_HOEFFDING:
-      giniHoeffdingTree->Classify(dataset, predictions, probabilities);
+      if (giniHoeffdingEnsemble)
+        giniHoeffdingEnsemble->Classify(dataset, predictions, probabilities);
+      else
+        giniHoeffdingTree->Classify(dataset, predictions, probabilities);
       break;
 
     case GINI_BINARY:
-      giniBinaryTree->Classify(dataset, predictions, probabilities);
+      if (giniBinaryEnsemble)
+        giniBinaryEnsemble->Classify(dataset, predictions, probabilities);
+      else
+        giniBinaryTree->Classify(dataset, predictions, probabilities);
       break;
 
     case INFO_HOEFFDING:
-      infoHoeffdingTree->Classify(dataset, predictions, probabilities);
+      if (infoHoeffdingEnsemble)
+        infoHoeffdingEnsemble->Classify(dataset, predictions, probabilities);
+      else
+        infoHoeffdingTree->Classify(dataset, predictions, probabilities);
       break;
 
     case INFO_BINARY:
-      infoBinaryTree->Classify(dataset, predictions, probabilities);
+      if (infoBinaryEnsemble)
+        infoBinaryEnsemble->Classify(dataset, predictions, probabilities);
+      else
+        infoBinaryTree->Classify(dataset, predictions, probabilities);
       break;
   }
 }
 
 // Utility function for counting the number of nodes.
 template<typename TreeType>
-size_t CountNodes(TreeType& tree)
+size_t CountNodes(const TreeType& tree)
 {
-  std::queue<TreeType*> queue;
+  std::queue<const TreeType*> queue;
   size_t nodes = 0;
   queue.push(&tree);
   while (!queue.empty())
   {
-    TreeType* node = queue.front();
+    const TreeType* node = queue.front();
     queue.pop();
     ++nodes;
 
@@ -270,9 +444,30 @@ size_t CountNodes(TreeType& tree)
   return nodes;
 }
 
+// Utility function for counting the number of nodes of all of the trees of an
+// ensemble.
+template<typename EnsembleType>
+size_t CountEnsembleNodes(const EnsembleType& ensemble)
+{
+  size_t nodes = 0;
+  for (size_t i = 0; i < ensemble.NumTrees(); ++i)
+    nodes += CountNodes(ensemble.Tree(i));
+
+  return nodes;
+}
+
 // Get the number of nodes in the tree.
 size_t HoeffdingTreeModel::NumNodes() const
 {
+  if (giniHoeffdingEnsemble)
+    return CountEnsembleNodes(*giniHoeffdingEnsemble);
+  else if (giniBinaryEnsemble)
+    return CountEnsembleNodes(*giniBinaryEnsemble);
+  else if (infoHoeffdingEnsemble)
+    return CountEnsembleNodes(*infoHoeffdingEnsemble);
+  else if (infoBinaryEnsemble)
+    return CountEnsembleNodes(*infoBinaryEnsemble);
+
   // Call CountNodes() with the right type of tree.
   switch (type)
   {
@@ -288,3 +483,18 @@ size_t HoeffdingTreeModel::NumNodes() const
 
   return 0; // This should never happen!
 }
+
+// Get the number of trees.
+size_t HoeffdingTreeModel::NumTrees() const
+{
+  if (giniHoeffdingEnsemble)
+    return giniHoeffdingEnsemble->NumTrees();
+  else if (giniBinaryEnsemble)
+    return giniBinaryEnsemble->NumTrees();
+  else if (infoHoeffdingEnsemble)
+    return infoHoeffdingEnsemble->NumTrees();
+  else if (infoBinaryEnsemble)
+    return infoBinaryEnsemble->NumTrees();
+
+  return 1;
+}
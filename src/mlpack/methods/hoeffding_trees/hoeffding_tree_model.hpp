@@ -8,6 +8,7 @@
 #define MLPACK_METHODS_HOEFFDING_TREE_HOEFFDING_TREE_MODEL_HPP
 
 #include "hoeffding_tree.hpp"
+#include "hoeffding_tree_ensemble.hpp"
 #include "binary_numeric_split.hpp"
 #include "information_gain.hpp"
 
@@ -16,7 +17,8 @@ namespace tree {
 
 /**
  * This class is a serializable Hoeffding tree model that can hold four
- * different types of Hoeffding trees.  It is meant to be used by the
+ * different types of Hoeffding trees, or an online bagging ensemble (see
+ * HoeffdingTreeEnsemble) of one of these types.  It is meant to be used by the
  * command-line program for Hoeffding trees.
  */
 class HoeffdingTreeModel
@@ -44,6 +46,17 @@ class HoeffdingTreeModel
   typedef HoeffdingTree<InformationGain, BinaryDoubleNumericSplit,
       HoeffdingCategoricalSplit> InfoBinaryTreeType;
 
+  //! Convenience typedef for an ensemble of GINI_HOEFFDING trees.
+  typedef HoeffdingTreeEnsemble<GiniHoeffdingTreeType>
+      GiniHoeffdingEnsembleType;
+  //! Convenience typedef for an ensemble of GINI_BINARY trees.
+  typedef HoeffdingTreeEnsemble<GiniBinaryTreeType> GiniBinaryEnsembleType;
+  //! Convenience typedef for an ensemble of INFO_HOEFFDING trees.
+  typedef HoeffdingTreeEnsemble<InfoHoeffdingTreeType>
+      InfoHoeffdingEnsembleType;
+  //! Convenience typedef for an ensemble of INFO_BINARY trees.
+  typedef HoeffdingTreeEnsemble<InfoBinaryTreeType> InfoBinaryEnsembleType;
+
   /**
    * Construct the Hoeffding tree model, but don't initialize any tree.
    *
@@ -105,6 +118,11 @@ class HoeffdingTreeModel
    * @param bins Number of bins, for Hoeffding numeric split.
    * @param observationsBeforeBinning Number of observations before binning, for
    *      Hoeffding numeric split.
+   * @param maxActiveLeaves Maximum number of active leaves of the tree (0 means
+   *      no limit); see HoeffdingTree::MaxActiveLeaves().
+   * @param numTrees Number of trees; if more than one, an online bagging
+   *      ensemble of trees is trained (ignoring batchTraining), with the
+   *      seed of math::RandomSeed().
    */
   void BuildModel(const arma::mat& dataset,
                   const data::DatasetInfo& datasetInfo,
@@ -116,11 +134,14 @@ class HoeffdingTreeModel
                   const size_t checkInterval,
                   const size_t minSamples,
                   const size_t bins,
-                  const size_t observationsBeforeBinning);
+                  const size_t observationsBeforeBinning,
+                  const size_t maxActiveLeaves = 0,
+                  const size_t numTrees = 1);
 
   /**
    * Train in streaming mode on the given dataset.  This takes one pass.  Be
-   * sure that BuildModel() has been called first!
+   * sure that BuildModel() has been called first!  The trees of an ensemble
+   * are trained in parallel, always in streaming mode.
    *
    * @param dataset Dataset to train on.
    * @param labels Labels for training set.
@@ -153,35 +174,76 @@ class HoeffdingTreeModel
                 arma::rowvec& probabilities) const;
 
   /**
-   * Get the number of nodes in the tree.
+   * Set the maximum number of active leaves of the tree (or of each tree of the
+   * ensemble; 0 means no limit); see HoeffdingTree::MaxActiveLeaves().  Be sure
+   * that BuildModel() has been called first!
+   *
+   * @param maxActiveLeaves Maximum number of active leaves.
+   */
+  void MaxActiveLeaves(const size_t maxActiveLeaves);
+
+  /**
+   * Get the number of nodes in the tree (or in all of the trees of the
+   * ensemble).
    */
   size_t NumNodes() const;
 
+  /**
+   * Get the number of trees (1 if the model is a single tree).
+   */
+  size_t NumTrees() const;
+
   /**
    * Serialize the model.
    */
   template<typename Archive>
-  void Serialize(Archive& ar, const unsigned int /* version */)
+  void Serialize(Archive& ar, const unsigned int version)
   {
     ar & data::CreateNVP(type, "type");
 
+    // Models saved before ensembles were supported hold a single tree.
+    bool ensemble = (giniHoeffdingEnsemble || giniBinaryEnsemble ||
+        infoHoeffdingEnsemble || infoBinaryEnsemble);
+    if (version > 0)
+      ar & data::CreateNVP(ensemble, "ensemble");
+    else
+      ensemble = false;
+
     // Clear memory if needed.
     if (Archive::is_loading::value)
-    {
-      delete giniHoeffdingTree;
-      delete giniBinaryTree;
-      delete infoHoeffdingTree;
-      delete infoBinaryTree;
-
-      giniHoeffdingTree = NULL;
-      giniBinaryTree = NULL;
-      infoHoeffdingTree = NULL;
-      infoBinaryTree = NULL;
-    }
+      Clear();
 
     // Fake dataset info may be needed to create fake trees.
     data::DatasetInfo info;
-    if (type == GINI_HOEFFDING)
+    if (ensemble)
+    {
+      // Create empty ensembles to load into if needed.
+      if (type == GINI_HOEFFDING)
+      {
+        if (Archive::is_loading::value)
+          giniHoeffdingEnsemble = new GiniHoeffdingEnsembleType();
+        ar & data::CreateNVP(*giniHoeffdingEnsemble, "giniHoeffdingEnsemble");
+      }
+      else if (type == GINI_BINARY)
+      {
+        if (Archive::is_loading::value)
+          giniBinaryEnsemble = new GiniBinaryEnsembleType();
+        ar & data::CreateNVP(*giniBinaryEnsemble, "giniBinaryEnsemble");
+      }
+      else if (type == INFO_HOEFFDING)
+      {
+        if (Archive::is_loading::value)
+          infoHoeffdingEnsemble = new InfoHoeffdingEnsembleType();
+        ar & data::CreateNVP(*infoHoeffdingEnsemble, "infoHoeffdingEnsemble");
+      }
+      else if (type == INFO_BINARY)
+      {
+        if (Archive::is_loading::value)
+          infoBinaryEnsemble = new InfoBinaryEnsembleType();
+        ar & data::CreateNVP(*infoBinaryEnsemble, "infoBinaryEnsemble");
+      }
+    }
+    else if (type == GINI_HOEFFDING)
     {
       // Create fake tree to load into if needed.
       if (Archive::is_loading::value)
@@ -212,6 +274,9 @@ class HoeffdingTreeModel
   }
 
  private:
+  //! Delete the tree or ensemble that is held.
+  void Clear();
+
   //! The type of tree we are using.
   TreeType type;
 
@@ -230,9 +295,22 @@ class HoeffdingTreeModel
   //! This is used if we are using the information gain and the binary numeric
   //! split.
   InfoBinaryTreeType* infoBinaryTree;
+
+  //! This is used for an ensemble of GINI_HOEFFDING trees.
+  GiniHoeffdingEnsembleType* giniHoeffdingEnsemble;
+  //! This is used for an ensemble of GINI_BINARY trees.
+  GiniBinaryEnsembleType* giniBinaryEnsemble;
+  //! This is used for an ensemble of INFO_HOEFFDING trees.
+  InfoHoeffdingEnsembleType* infoHoeffdingEnsemble;
+  //! This is used for an ensemble of INFO_BINARY trees.
+  InfoBinaryEnsembleType* infoBinaryEnsemble;
 };
 
 } // namespace tree
 } // namespace mlpack
 
+//! Set the serialization version of the HoeffdingTreeModel class (version 1
+//! can hold an ensemble).
+BOOST_CLASS_VERSION(mlpack::tree::HoeffdingTreeModel, 1);
+
 #endif
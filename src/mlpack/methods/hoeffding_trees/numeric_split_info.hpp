@@ -36,6 +36,17 @@ class NumericSplitInfo
     return bin;
   }
 
+  /**
+   * Get the split as a list of split points, for FlatTree: a point goes to the
+   * child whose index is the number of split points less than its value.
+   */
+  template<typename eT>
+  bool SplitPoints(arma::Col<eT>& splitPoints) const
+  {
+    splitPoints = arma::conv_to<arma::Col<eT>>::from(this->splitPoints);
+    return true;
+  }
+
   //! Serialize the split (save/load the split points).
   template<typename Archive>
   void Serialize(Archive& ar, const unsigned int /* version */)
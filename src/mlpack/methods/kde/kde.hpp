@@ -0,0 +1,213 @@
+/**
+ * @file kde.hpp
+ *
+ * Defines the KDE class, which performs kernel density estimation with
+ * dual-tree (or single-tree) algorithms and bounded errors.
+ *
+ * The details of the dual-tree algorithm can be found in the following paper:
+ *
+ * @inproceedings{gray2003nonparametric,
+ *  title={Nonparametric density estimation: Toward computational
+ *      tractability},
+ *  author={Gray, A.G. and Moore, A.W.},
+ *  booktitle={Proceedings of the 2003 SIAM International Conference on Data
+ *      Mining},
+ *  pages={203--211},
+ *  year={2003}
+ * }
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_KDE_KDE_HPP
+#define MLPACK_METHODS_KDE_KDE_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/util/sfinae_utility.hpp>
+#include <mlpack/core/kernels/gaussian_kernel.hpp>
+#include <mlpack/methods/range_search/range_search.hpp>
+
+namespace mlpack {
+namespace kde /** Kernel density estimation. */ {
+
+/**
+ * The KDE class estimates the density of the reference set at each query point
+ * as the mean of the kernel of the distances to the reference points, divided
+ * by the normalization constant of the kernel:
+ *
+ * \f[
+ * f(q) = \frac{1}{N Z} \sum_{r} K(d(q, r))
+ * \f]
+ *
+ * The kernel must have a 'double Evaluate(const double distance)' function
+ * that doesn't increase with the distance (like the Gaussian, Epanechnikov,
+ * spherical or triangular kernels).  If it has a 'double Normalizer(const
+ * size_t dimension)' function, Z is the result; otherwise Z is 1 and the
+ * estimations are only proportional to the density.
+ *
+ * The sums are computed by RangeSearch::KernelSum() with a range holding every
+ * distance, so the same tree traversals are used: a pair of nodes (or a query
+ * point and a node) is accounted for at once when the kernel varies little
+ * enough between the bounds of the distances, and the query points are
+ * processed in parallel when OpenMP is available.  The error of an estimation
+ * f is at most relativeError * f + absoluteError, so a relative error of 0 and
+ * an absolute error of 0 give exact estimations.
+ *
+ * @code
+ * KDE<GaussianKernel> kde(0.05, 0.0, GaussianKernel(0.5));
+ * kde.Train(referenceSet);
+ *
+ * arma::vec estimations;
+ * kde.Evaluate(querySet, estimations);
+ * @endcode
+ *
+ * @tparam KernelType The kernel to use.
+ * @tparam MetricType The metric to use for computation.
+ * @tparam MatType The type of data matrix.
+ * @tparam TreeType The tree type to use; must adhere to the TreeType API.
+ */
+template<typename KernelType = kernel::GaussianKernel,
+         typename MetricType = metric::EuclideanDistance,
+         typename MatType = arma::mat,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType = tree::KDTree>
+class KDE
+{
+ public:
+  //! Convenience typedef for the range search used to compute the sums.
+  typedef range::RangeSearch<MetricType, MatType, TreeType> SearchType;
+
+  /**
+   * Create the KDE object without a reference set.  Train() must be called
+   * before evaluating.
+   *
+   * @param relativeError Largest relative error of each estimation (between 0
+   *     and 1).
+   * @param absoluteError Largest absolute error of each estimation (0 or
+   *     greater).
+   * @param kernel Instantiated kernel.
+   * @param naive If true, the sums are computed without trees.
+   * @param singleMode If true, single-tree traversals are used (as opposed to
+   *     dual-tree traversals).
+   * @param metric An optional instance of the MetricType class.
+   */
+  KDE(const double relativeError = 0.05,
+      const double absoluteError = 0.0,
+      const KernelType& kernel = KernelType(),
+      const bool naive = false,
+      const bool singleMode = false,
+      const MetricType metric = MetricType());
+
+  /**
+   * Create the KDE object and build the tree on the given reference set.  The
+   * reference set is taken with std::move() if possible.
+   *
+   * @param referenceSet Set of reference points.
+   * @param relativeError Largest relative error of each estimation (between 0
+   *     and 1).
+   * @param absoluteError Largest absolute error of each estimation (0 or
+   *     greater).
+   * @param kernel Instantiated kernel.
+   * @param naive If true, the sums are computed without trees.
+   * @param singleMode If true, single-tree traversals are used (as opposed to
+   *     dual-tree traversals).
+   * @param metric An optional instance of the MetricType class.
+   */
+  KDE(MatType referenceSet,
+      const double relativeError = 0.05,
+      const double absoluteError = 0.0,
+      const KernelType& kernel = KernelType(),
+      const bool naive = false,
+      const bool singleMode = false,
+      const MetricType metric = MetricType());
+
+  /**
+   * Build the tree on the given reference set, replacing the current one.  The
+   * reference set is taken with std::move() if possible.
+   *
+   * @param referenceSet Set of reference points.
+   */
+  void Train(MatType referenceSet);
+
+  /**
+   * Estimate the density of the reference set at each point of the query set.
+   *
+   * @param querySet Set of query points.
+   * @param estimations Will hold the estimation for each query point.
+   */
+  void Evaluate(const MatType& querySet, arma::vec& estimations);
+
+  /**
+   * Estimate the density of the reference set at each of its points (each
+   * point counts in its own estimation).
+   *
+   * @param estimations Will hold the estimation for each reference point.
+   */
+  void Evaluate(arma::vec& estimations);
+
+  //! Get the largest relative error of each estimation.
+  double RelativeError() const { return relativeError; }
+  //! Set the largest relative error of each estimation (between 0 and 1).
+  void RelativeError(const double relativeError);
+
+  //! Get the largest absolute error of each estimation.
+  double AbsoluteError() const { return absoluteError; }
+  //! Set the largest absolute error of each estimation (0 or greater).
+  void AbsoluteError(const double absoluteError);
+
+  //! Get the kernel.
+  const KernelType& Kernel() const { return kernel; }
+  //! Modify the kernel.
+  KernelType& Kernel() { return kernel; }
+
+  //! Get whether the sums are computed without trees.
+  bool Naive() const { return search.Naive(); }
+  //! Modify whether the sums are computed without trees.
+  bool& Naive() { return search.Naive(); }
+
+  //! Get whether single-tree traversals are used.
+  bool SingleMode() const { return search.SingleMode(); }
+  //! Modify whether single-tree traversals are used.
+  bool& SingleMode() { return search.SingleMode(); }
+
+  //! Get the number of threads used for the dual-tree traversals (0 means the
+  //! OpenMP default).
+  size_t NumThreads() const { return search.NumThreads(); }
+  //! Modify the number of threads used for the dual-tree traversals (0 means
+  //! the OpenMP default).
+  size_t& NumThreads() { return search.NumThreads(); }
+
+  //! Get the reference set.
+  const MatType& ReferenceSet() const { return search.ReferenceSet(); }
+
+  //! Get the range search that computes the sums.
+  const SearchType& Search() const { return search; }
+
+  //! Serialize the model.
+  template<typename Archive>
+  void Serialize(Archive& ar, const unsigned int /* version */);
+
+ private:
+  //! Get the normalization constant of the kernel (1 if it has none).
+  double Normalizer();
+
+  //! The kernel.
+  KernelType kernel;
+  //! The largest relative error of each estimation.
+  double relativeError;
+  //! The largest absolute error of each estimation.
+  double absoluteError;
+  //! The range search that holds the tree and computes the sums.
+  SearchType search;
+};
+
+} // namespace kde
+} // namespace mlpack
+
+// Include implementation.
+#include "kde_impl.hpp"
+
+#endif
@@ -0,0 +1,243 @@
+/**
+ * @file kde_impl.hpp
+ *
+ * Implementation of the KDE class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_KDE_KDE_IMPL_HPP
+#define MLPACK_METHODS_KDE_KDE_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "kde.hpp"
+
+namespace mlpack {
+namespace kde {
+
+/**
+ * This gives us a HasNormalizerCheck object that we can use to tell whether or
+ * not a kernel has a Normalizer() function.
+ */
+HAS_MEM_FUNC(Normalizer, HasNormalizerCheck);
+
+//! Get the normalization constant of a kernel with a Normalizer() function.
+template<typename KernelType>
+double KernelNormalizer(
+    KernelType& kernel,
+    const size_t dimension,
+    const typename std::enable_if_t<HasNormalizerCheck<KernelType,
+        double(KernelType::*)(size_t)>::value>* = 0)
+{
+  return kernel.Normalizer(dimension);
+}
+
+//! Get the normalization constant of a kernel with a const Normalizer()
+//! function.
+template<typename KernelType>
+double KernelNormalizer(
+    KernelType& kernel,
+    const size_t dimension,
+    const typename std::enable_if_t<HasNormalizerCheck<KernelType,
+        double(KernelType::*)(size_t) const>::value>* = 0)
+{
+  return kernel.Normalizer(dimension);
+}
+
+//! Kernels without a Normalizer() function aren't normalized.
+template<typename KernelType>
+double KernelNormalizer(
+    KernelType& /* kernel */,
+    const size_t /* dimension */,
+    const typename std::enable_if_t<!HasNormalizerCheck<KernelType,
+        double(KernelType::*)(size_t)>::value && !HasNormalizerCheck<KernelType,
+        double(KernelType::*)(size_t) const>::value>* = 0)
+{
+  return 1.0;
+}
+
+template<typename KernelType,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+KDE<KernelType, MetricType, MatType, TreeType>::KDE(
+    const double relativeError,
+    const double absoluteError,
+    const KernelType& kernel,
+    const bool naive,
+    const bool singleMode,
+    const MetricType metric) :
+    kernel(kernel),
+    search(naive, singleMode, metric)
+{
+  RelativeError(relativeError);
+  AbsoluteError(absoluteError);
+}
+
+template<typename KernelType,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+KDE<KernelType, MetricType, MatType, TreeType>::KDE(
+    MatType referenceSet,
+    const double relativeError,
+    const double absoluteError,
+    const KernelType& kernel,
+    const bool naive,
+    const bool singleMode,
+    const MetricType metric) :
+    kernel(kernel),
+    search(std::move(referenceSet), naive, singleMode, metric)
+{
+  RelativeError(relativeError);
+  AbsoluteError(absoluteError);
+}
+
+template<typename KernelType,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void KDE<KernelType, MetricType, MatType, TreeType>::Train(
+    MatType referenceSet)
+{
+  search.Train(std::move(referenceSet));
+}
+
+template<typename KernelType,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void KDE<KernelType, MetricType, MatType, TreeType>::Evaluate(
+    const MatType& querySet,
+    arma::vec& estimations)
+{
+  if (querySet.n_rows != ReferenceSet().n_rows && ReferenceSet().n_cols > 0)
+  {
+    std::ostringstream oss;
+    oss << "KDE::Evaluate(): dimensionality of query set ("
+        << querySet.n_rows << ") is not equal to the dimensionality of the "
+        << "reference set (" << ReferenceSet().n_rows << ")";
+    throw std::invalid_argument(oss.str());
+  }
+
+  const size_t numPoints = ReferenceSet().n_cols;
+  if (numPoints == 0)
+  {
+    estimations.zeros(querySet.n_cols);
+    return;
+  }
+
+  // The absolute error of each estimation is the mean of the absolute errors of
+  // the kernel values, divided by the normalization constant.
+  const double normalizer = Normalizer();
+  search.KernelSum(querySet, math::Range(0.0, DBL_MAX), kernel, estimations,
+      relativeError, absoluteError * normalizer);
+  estimations /= (numPoints * normalizer);
+}
+
+template<typename KernelType,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void KDE<KernelType, MetricType, MatType, TreeType>::Evaluate(
+    arma::vec& estimations)
+{
+  const size_t numPoints = ReferenceSet().n_cols;
+  if (numPoints == 0)
+  {
+    estimations.clear();
+    return;
+  }
+
+  // The monochromatic sums leave each point out, so add it back.
+  const double normalizer = Normalizer();
+  search.KernelSum(math::Range(0.0, DBL_MAX), kernel, estimations,
+      relativeError, absoluteError * normalizer);
+  estimations += kernel.Evaluate(0.0);
+  estimations /= (numPoints * normalizer);
+}
+
+template<typename KernelType,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void KDE<KernelType, MetricType, MatType, TreeType>::RelativeError(
+    const double relativeError)
+{
+  if (relativeError < 0.0 || relativeError > 1.0)
+  {
+    std::ostringstream oss;
+    oss << "KDE::RelativeError(): relative error must be between 0 and 1 "
+        << "(given " << relativeError << ")";
+    throw std::invalid_argument(oss.str());
+  }
+
+  this->relativeError = relativeError;
+}
+
+template<typename KernelType,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void KDE<KernelType, MetricType, MatType, TreeType>::AbsoluteError(
+    const double absoluteError)
+{
+  if (absoluteError < 0.0)
+  {
+    std::ostringstream oss;
+    oss << "KDE::AbsoluteError(): absolute error must be 0 or greater (given "
+        << absoluteError << ")";
+    throw std::invalid_argument(oss.str());
+  }
+
+  this->absoluteError = absoluteError;
+}
+
+template<typename KernelType,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+template<typename Archive>
+void KDE<KernelType, MetricType, MatType, TreeType>::Serialize(
+    Archive& ar,
+    const unsigned int /* version */)
+{
+  ar & data::CreateNVP(kernel, "kernel");
+  ar & data::CreateNVP(relativeError, "relativeError");
+  ar & data::CreateNVP(absoluteError, "absoluteError");
+  ar & data::CreateNVP(search, "search");
+}
+
+template<typename KernelType,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+double KDE<KernelType, MetricType, MatType, TreeType>::Normalizer()
+{
+  return KernelNormalizer(kernel, ReferenceSet().n_rows);
+}
+
+} // namespace kde
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,213 @@
+/**
+ * @file kde_main.cpp
+ *
+ * Executable for kernel density estimation with dual-tree algorithms.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/util/cli.hpp>
+
+#include "kde.hpp"
+#include "kde_model.hpp"
+
+using namespace std;
+using namespace mlpack;
+using namespace mlpack::kde;
+
+// Information about the program itself.
+PROGRAM_INFO("Kernel Density Estimation",
+    "This program estimates the density of a reference set at each point of a "
+    "query set with a kernel: the estimation at a point is the mean of the "
+    "kernel of the distances to the reference points, divided by the "
+    "normalization constant of the kernel.  The sums are computed with "
+    "dual-tree (or single-tree) algorithms, which account for a pair of tree "
+    "nodes at once when the kernel varies little enough between them.  The "
+    "error of an estimation f is at most (--rel_error * f + --abs_error), so "
+    "setting both to 0 gives exact estimations."
+    "\n\n"
+    "The kernel is given with --kernel ('gaussian' or 'epanechnikov') and its "
+    "bandwidth with --bandwidth; the tree with --tree_type ('kd', 'ball', "
+    "'cover' or 'oct').  If no query set is given, the density is estimated at "
+    "each reference point."
+    "\n\n"
+    "For example, the following will estimate the density of 'ref.csv' at each "
+    "point of 'queries.csv' with a Gaussian kernel of bandwidth 0.5 and a "
+    "relative error of 5%, and save the estimations to 'estimations.csv':"
+    "\n\n"
+    "$ kde --reference_file=ref.csv --query_file=queries.csv --bandwidth=0.5\n"
+    "  --rel_error=0.05 --predictions_file=estimations.csv");
+
+// Input and output data.
+PARAM_MATRIX_IN("reference", "Matrix containing the reference dataset.", "r");
+PARAM_MATRIX_IN("query", "Matrix containing the points at which to estimate "
+    "the density (optional).", "q");
+PARAM_COL_OUT("predictions", "If specified, the density estimations will be "
+    "saved to the given file.", "p");
+
+// The option exists to load or save models.
+PARAM_MODEL_IN(KDEModel, "input_model", "File containing a pre-trained KDE "
+    "model.", "m");
+PARAM_MODEL_OUT(KDEModel, "output_model", "If specified, the KDE model will be "
+    "saved to the given file.", "M");
+
+// Model parameters.
+PARAM_STRING_IN("kernel", "Kernel to use: 'gaussian' or 'epanechnikov'.", "k",
+    "gaussian");
+PARAM_DOUBLE_IN("bandwidth", "Bandwidth of the kernel.", "b", 1.0);
+PARAM_STRING_IN("tree_type", "Type of tree to use: 'kd', 'ball', 'cover', "
+    "'oct'.", "t", "kd");
+PARAM_DOUBLE_IN("rel_error", "Largest relative error of each estimation "
+    "(between 0 and 1).", "e", 0.05);
+PARAM_DOUBLE_IN("abs_error", "Largest absolute error of each estimation.", "E",
+    0.0);
+
+// Search settings.
+PARAM_FLAG("naive", "If true, the sums are computed without trees.", "N");
+PARAM_FLAG("single_mode", "If true, single-tree traversals are used (as "
+    "opposed to dual-tree traversals).", "S");
+PARAM_INT_IN("threads", "Number of threads to use for dual-tree traversals (if "
+    "0, the OpenMP default is used).", "T", 0);
+
+int main(int argc, char *argv[])
+{
+  // Give CLI the command line parameters the user passed in.
+  CLI::ParseCommandLine(argc, argv);
+
+  // A user cannot specify both reference data and a model.
+  if (CLI::HasParam("reference") && CLI::HasParam("input_model"))
+    Log::Fatal << "Only one of --reference_file (-r) or --input_model_file (-m)"
+        << " may be specified!" << endl;
+
+  // A user must specify one of them...
+  if (!CLI::HasParam("reference") && !CLI::HasParam("input_model"))
+    Log::Fatal << "No model specified (--input_model_file) and no reference "
+        << "data specified (--reference_file)!  One must be provided." << endl;
+
+  if (CLI::HasParam("input_model"))
+  {
+    // Notify the user of parameters that will be ignored.
+    if (CLI::HasParam("kernel"))
+      Log::Warn << "--kernel (-k) will be ignored because --input_model_file "
+          << "is specified." << endl;
+    if (CLI::HasParam("bandwidth"))
+      Log::Warn << "--bandwidth (-b) will be ignored because --input_model_file"
+          << " is specified." << endl;
+    if (CLI::HasParam("tree_type"))
+      Log::Warn << "--tree_type (-t) will be ignored because --input_model_file"
+          << " is specified." << endl;
+    if (CLI::HasParam("naive"))
+      Log::Warn << "--naive (-N) will be ignored because --input_model_file is "
+          << "specified." << endl;
+  }
+
+  if (!CLI::HasParam("predictions") && !CLI::HasParam("output_model"))
+    Log::Warn << "Neither --predictions_file nor --output_model_file are "
+        << "specified, so no results from this program will be saved!" << endl;
+
+  const double relError = CLI::GetParam<double>("rel_error");
+  if (relError < 0.0 || relError > 1.0)
+    Log::Fatal << "Invalid relative error: " << relError << ".  Must be "
+        << "between 0 and 1." << endl;
+
+  const double absError = CLI::GetParam<double>("abs_error");
+  if (absError < 0.0)
+    Log::Fatal << "Invalid absolute error: " << absError << ".  Must be 0 or "
+        << "greater." << endl;
+
+  const int threads = CLI::GetParam<int>("threads");
+  if (threads < 0)
+    Log::Fatal << "Invalid number of threads: " << threads << ".  Must be 0 or "
+        << "greater." << endl;
+
+  // Naive mode overrides single mode.
+  const bool naive = CLI::HasParam("naive");
+  const bool singleMode = CLI::HasParam("single_mode");
+  if (singleMode && naive)
+    Log::Warn << "--single_mode ignored because --naive is present." << endl;
+
+  // We either have to load the reference data, or we have to load the model.
+  KDEModel kde;
+  if (CLI::HasParam("reference"))
+  {
+    const string kernelType = CLI::GetParam<string>("kernel");
+    if (kernelType == "gaussian")
+      kde.KernelType() = KDEModel::GAUSSIAN_KERNEL;
+    else if (kernelType == "epanechnikov")
+      kde.KernelType() = KDEModel::EPANECHNIKOV_KERNEL;
+    else
+      Log::Fatal << "Unknown kernel '" << kernelType << "'; valid choices are "
+          << "'gaussian' and 'epanechnikov'." << endl;
+
+    const string treeType = CLI::GetParam<string>("tree_type");
+    if (treeType == "kd")
+      kde.TreeType() = KDEModel::KD_TREE;
+    else if (treeType == "ball")
+      kde.TreeType() = KDEModel::BALL_TREE;
+    else if (treeType == "cover")
+      kde.TreeType() = KDEModel::COVER_TREE;
+    else if (treeType == "oct")
+      kde.TreeType() = KDEModel::OCTREE;
+    else
+      Log::Fatal << "Unknown tree type '" << treeType << "'; valid choices are "
+          << "'kd', 'ball', 'cover', and 'oct'." << endl;
+
+    const double bandwidth = CLI::GetParam<double>("bandwidth");
+    if (bandwidth <= 0.0)
+      Log::Fatal << "Invalid bandwidth: " << bandwidth << ".  Must be greater "
+          << "than 0." << endl;
+    kde.Bandwidth() = bandwidth;
+
+    arma::mat referenceSet = std::move(CLI::GetParam<arma::mat>("reference"));
+
+    Log::Info << "Loaded reference data from '"
+        << CLI::GetUnmappedParam<arma::mat>("reference") << "' ("
+        << referenceSet.n_rows << "x" << referenceSet.n_cols << ")." << endl;
+
+    kde.BuildModel(std::move(referenceSet), naive, singleMode);
+  }
+  else
+  {
+    // Load the model from file.
+    kde = std::move(CLI::GetParam<KDEModel>("input_model"));
+
+    Log::Info << "Loaded KDE model from '"
+        << CLI::GetUnmappedParam<KDEModel>("input_model") << "' (trained on "
+        << kde.Dataset().n_rows << "x" << kde.Dataset().n_cols << " dataset)."
+        << endl;
+  }
+
+  kde.Errors(relError, absError);
+  kde.SearchMode(singleMode, size_t(threads));
+
+  // Estimate the density, if desired.
+  if (CLI::HasParam("predictions"))
+  {
+    arma::vec estimations;
+    if (CLI::HasParam("query"))
+    {
+      arma::mat querySet = std::move(CLI::GetParam<arma::mat>("query"));
+      Log::Info << "Loaded query data from '"
+          << CLI::GetUnmappedParam<arma::mat>("query") << "' ("
+          << querySet.n_rows << "x" << querySet.n_cols << ")." << endl;
+
+      kde.Evaluate(querySet, estimations);
+    }
+    else
+    {
+      kde.Evaluate(estimations);
+    }
+
+    Log::Info << "Estimation complete." << endl;
+    CLI::GetParam<arma::vec>("predictions") = std::move(estimations);
+  }
+
+  // Save the output model, if desired.
+  if (CLI::HasParam("output_model"))
+    CLI::GetParam<KDEModel>("output_model") = std::move(kde);
+
+  CLI::Destroy();
+}
@@ -0,0 +1,166 @@
+/**
+ * @file kde_model.cpp
+ *
+ * Implementation of the KDEModel class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "kde_model.hpp"
+
+using namespace std;
+using namespace mlpack;
+using namespace mlpack::kde;
+
+/**
+ * Initialize the KDEModel with the given parameters.
+ */
+KDEModel::KDEModel(const KernelTypes kernelType,
+                   const TreeTypes treeType,
+                   const double bandwidth,
+                   const double relativeError,
+                   const double absoluteError) :
+    kernelType(kernelType),
+    treeType(treeType),
+    bandwidth(bandwidth),
+    relativeError(relativeError),
+    absoluteError(absoluteError)
+{
+  // Nothing to do.
+}
+
+// Copy constructor.
+KDEModel::KDEModel(const KDEModel& other) :
+    kernelType(other.kernelType),
+    treeType(other.treeType),
+    bandwidth(other.bandwidth),
+    relativeError(other.relativeError),
+    absoluteError(other.absoluteError),
+    kdeModel(boost::apply_visitor(CopyVisitor<KDEVariant>(), other.kdeModel))
+{
+  // Nothing to do.
+}
+
+// Move constructor.
+KDEModel::KDEModel(KDEModel&& other) :
+    kernelType(other.kernelType),
+    treeType(other.treeType),
+    bandwidth(other.bandwidth),
+    relativeError(other.relativeError),
+    absoluteError(other.absoluteError),
+    kdeModel(other.kdeModel)
+{
+  // Reset other model.
+  other.kdeModel = decltype(other.kdeModel)();
+}
+
+// Copy operator.
+KDEModel& KDEModel::operator=(const KDEModel& other)
+{
+  if (this == &other)
+    return *this;
+
+  boost::apply_visitor(DeleteVisitor(), kdeModel);
+
+  kernelType = other.kernelType;
+  treeType = other.treeType;
+  bandwidth = other.bandwidth;
+  relativeError = other.relativeError;
+  absoluteError = other.absoluteError;
+  kdeModel = boost::apply_visitor(CopyVisitor<KDEVariant>(), other.kdeModel);
+
+  return *this;
+}
+
+// Move operator.
+KDEModel& KDEModel::operator=(KDEModel&& other)
+{
+  if (this == &other)
+    return *this;
+
+  boost::apply_visitor(DeleteVisitor(), kdeModel);
+
+  kernelType = other.kernelType;
+  treeType = other.treeType;
+  bandwidth = other.bandwidth;
+  relativeError = other.relativeError;
+  absoluteError = other.absoluteError;
+  kdeModel = other.kdeModel;
+
+  // Reset other model.
+  other.kdeModel = decltype(other.kdeModel)();
+
+  return *this;
+}
+
+// Clean memory, if necessary.
+KDEModel::~KDEModel()
+{
+  boost::apply_visitor(DeleteVisitor(), kdeModel);
+}
+
+void KDEModel::Errors(const double relativeError, const double absoluteError)
+{
+  // Let the KDE object check the errors before they are stored.
+  boost::apply_visitor(ErrorVisitor(relativeError, absoluteError), kdeModel);
+
+  this->relativeError = relativeError;
+  this->absoluteError = absoluteError;
+}
+
+const arma::mat& KDEModel::Dataset() const
+{
+  return boost::apply_visitor(ReferenceSetVisitor(), kdeModel);
+}
+
+void KDEModel::BuildModel(arma::mat&& referenceSet,
+                          const bool naive,
+                          const bool singleMode)
+{
+  // Clean memory, if necessary.
+  boost::apply_visitor(DeleteVisitor(), kdeModel);
+
+  if (kernelType == GAUSSIAN_KERNEL)
+    Create<kernel::GaussianKernel>(naive, singleMode);
+  else
+    Create<kernel::EpanechnikovKernel>(naive, singleMode);
+
+  if (!naive)
+  {
+    Timer::Start("tree_building");
+    Log::Info << "Building reference tree..." << endl;
+  }
+
+  TrainVisitor tn(std::move(referenceSet));
+  boost::apply_visitor(tn, kdeModel);
+
+  if (!naive)
+  {
+    Timer::Stop("tree_building");
+    Log::Info << "Tree built." << endl;
+  }
+}
+
+void KDEModel::SearchMode(const bool singleMode, const size_t numThreads)
+{
+  boost::apply_visitor(SearchModeVisitor(singleMode, numThreads), kdeModel);
+}
+
+void KDEModel::Evaluate(const arma::mat& querySet, arma::vec& estimations)
+{
+  Log::Info << "Estimating the density at " << querySet.n_cols << " query "
+      << "points..." << endl;
+
+  EvaluateVisitor ev(querySet, estimations);
+  boost::apply_visitor(ev, kdeModel);
+}
+
+void KDEModel::Evaluate(arma::vec& estimations)
+{
+  Log::Info << "Estimating the density at the reference points..." << endl;
+
+  MonoEvaluateVisitor ev(estimations);
+  boost::apply_visitor(ev, kdeModel);
+}
@@ -0,0 +1,358 @@
+/**
+ * @file kde_model.hpp
+ *
+ * This is a model for kernel density estimation.  It is useful in that it
+ * provides an easy way to serialize a model, and abstracts away the different
+ * kernels and types of trees.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_KDE_KDE_MODEL_HPP
+#define MLPACK_METHODS_KDE_KDE_MODEL_HPP
+
+#include <mlpack/core/kernels/gaussian_kernel.hpp>
+#include <mlpack/core/kernels/epanechnikov_kernel.hpp>
+#include <mlpack/core/tree/binary_space_tree.hpp>
+#include <mlpack/core/tree/cover_tree.hpp>
+#include <mlpack/core/tree/octree.hpp>
+#include <boost/variant.hpp>
+#include "kde.hpp"
+
+namespace mlpack {
+namespace kde {
+
+/**
+ * Alias template for the KDE types held by the model.
+ */
+template<typename KernelType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+using KDEType = KDE<KernelType, metric::EuclideanDistance, arma::mat,
+    TreeType>;
+
+/**
+ * TrainVisitor builds the tree of the given KDEType on the reference set.
+ */
+class TrainVisitor : public boost::static_visitor<void>
+{
+ private:
+  //! The reference set.
+  arma::mat&& referenceSet;
+
+ public:
+  //! Build the tree of the given KDE object.
+  template<typename KDEType>
+  void operator()(KDEType* kde) const;
+
+  //! Construct the TrainVisitor, which takes ownership of the reference set.
+  TrainVisitor(arma::mat&& referenceSet) :
+      referenceSet(std::move(referenceSet))
+  { }
+};
+
+/**
+ * EvaluateVisitor estimates the density at the points of the query set with
+ * the given KDEType.
+ */
+class EvaluateVisitor : public boost::static_visitor<void>
+{
+ private:
+  //! The query set.
+  const arma::mat& querySet;
+  //! The output estimations.
+  arma::vec& estimations;
+
+ public:
+  //! Estimate the density with the given KDE object.
+  template<typename KDEType>
+  void operator()(KDEType* kde) const;
+
+  //! Construct the EvaluateVisitor with the given parameters.
+  EvaluateVisitor(const arma::mat& querySet, arma::vec& estimations) :
+      querySet(querySet),
+      estimations(estimations)
+  { }
+};
+
+/**
+ * MonoEvaluateVisitor estimates the density at the points of the reference set
+ * with the given KDEType.
+ */
+class MonoEvaluateVisitor : public boost::static_visitor<void>
+{
+ private:
+  //! The output estimations.
+  arma::vec& estimations;
+
+ public:
+  //! Estimate the density with the given KDE object.
+  template<typename KDEType>
+  void operator()(KDEType* kde) const;
+
+  //! Construct the MonoEvaluateVisitor with the given output.
+  MonoEvaluateVisitor(arma::vec& estimations) : estimations(estimations) { }
+};
+
+/**
+ * ErrorVisitor sets the relative and absolute errors of the given KDEType.
+ */
+class ErrorVisitor : public boost::static_visitor<void>
+{
+ private:
+  //! The largest relative error.
+  const double relativeError;
+  //! The largest absolute error.
+  const double absoluteError;
+
+ public:
+  //! Set the errors of the given KDE object.
+  template<typename KDEType>
+  void operator()(KDEType* kde) const;
+
+  //! Construct the ErrorVisitor with the given errors.
+  ErrorVisitor(const double relativeError, const double absoluteError) :
+      relativeError(relativeError),
+      absoluteError(absoluteError)
+  { }
+};
+
+/**
+ * SearchModeVisitor sets whether the given KDEType uses single-tree traversals,
+ * and the number of threads.
+ */
+class SearchModeVisitor : public boost::static_visitor<void>
+{
+ private:
+  //! Whether single-tree traversals are used.
+  const bool singleMode;
+  //! The number of threads.
+  const size_t numThreads;
+
+ public:
+  //! Set the search mode of the given KDE object.
+  template<typename KDEType>
+  void operator()(KDEType* kde) const;
+
+  //! Construct the SearchModeVisitor with the given parameters.
+  SearchModeVisitor(const bool singleMode, const size_t numThreads) :
+      singleMode(singleMode),
+      numThreads(numThreads)
+  { }
+};
+
+/**
+ * ReferenceSetVisitor exposes the reference set of the given KDEType.
+ */
+class ReferenceSetVisitor : public boost::static_visitor<const arma::mat&>
+{
+ public:
+  //! Return the reference set of the given KDE object.
+  template<typename KDEType>
+  const arma::mat& operator()(KDEType* kde) const;
+};
+
+/**
+ * CopyVisitor returns a copy of the given KDEType.
+ */
+template<typename VariantType>
+class CopyVisitor : public boost::static_visitor<VariantType>
+{
+ public:
+  //! Return a copy of the given KDE object.
+  template<typename KDEType>
+  VariantType operator()(KDEType* kde) const;
+};
+
+/**
+ * DeleteVisitor deletes the given KDEType instance.
+ */
+class DeleteVisitor : public boost::static_visitor<void>
+{
+ public:
+  //! Delete the KDE object.
+  template<typename KDEType>
+  void operator()(KDEType* kde) const;
+};
+
+/**
+ * SerializeVisitor serializes the given KDEType instance.
+ */
+template<typename Archive>
+class SerializeVisitor : public boost::static_visitor<void>
+{
+ private:
+  Archive& ar;
+  const std::string& name;
+
+ public:
+  //! Serialize the given KDE object.
+  template<typename KDEType>
+  void operator()(KDEType* kde) const;
+
+  //! Construct the SerializeVisitor with the given archive and name.
+  SerializeVisitor(Archive& ar, const std::string& name) : ar(ar), name(name)
+  { }
+};
+
+/**
+ * The KDEModel holds a KDE object with one of a few kernels and tree types,
+ * all with the Euclidean distance, and can be serialized.  The kernel and tree
+ * type are chosen with the KernelType() and TreeType() members before
+ * BuildModel() is called.
+ */
+class KDEModel
+{
+ public:
+  //! The kernels that can be used.
+  enum KernelTypes
+  {
+    GAUSSIAN_KERNEL,
+    EPANECHNIKOV_KERNEL
+  };
+
+  //! The tree types that can be used.
+  enum TreeTypes
+  {
+    KD_TREE,
+    BALL_TREE,
+    COVER_TREE,
+    OCTREE
+  };
+
+ private:
+  //! The kernel.
+  KernelTypes kernelType;
+  //! The tree type.
+  TreeTypes treeType;
+  //! The bandwidth of the kernel.
+  double bandwidth;
+  //! The largest relative error of each estimation.
+  double relativeError;
+  //! The largest absolute error of each estimation.
+  double absoluteError;
+
+  //! The KDE object (only one is non-NULL).
+  typedef boost::variant<KDEType<kernel::GaussianKernel, tree::KDTree>*,
+                         KDEType<kernel::GaussianKernel, tree::BallTree>*,
+                         KDEType<kernel::GaussianKernel,
+                             tree::StandardCoverTree>*,
+                         KDEType<kernel::GaussianKernel, tree::Octree>*,
+                         KDEType<kernel::EpanechnikovKernel, tree::KDTree>*,
+                         KDEType<kernel::EpanechnikovKernel, tree::BallTree>*,
+                         KDEType<kernel::EpanechnikovKernel,
+                             tree::StandardCoverTree>*,
+                         KDEType<kernel::EpanechnikovKernel, tree::Octree>*>
+      KDEVariant;
+  KDEVariant kdeModel;
+
+ public:
+  /**
+   * Initialize the KDEModel with the given parameters.
+   *
+   * @param kernelType Kernel to use.
+   * @param treeType Type of tree to use.
+   * @param bandwidth Bandwidth of the kernel.
+   * @param relativeError Largest relative error of each estimation.
+   * @param absoluteError Largest absolute error of each estimation.
+   */
+  KDEModel(const KernelTypes kernelType = KernelTypes::GAUSSIAN_KERNEL,
+           const TreeTypes treeType = TreeTypes::KD_TREE,
+           const double bandwidth = 1.0,
+           const double relativeError = 0.05,
+           const double absoluteError = 0.0);
+
+  //! Copy the given KDEModel.
+  KDEModel(const KDEModel& other);
+
+  //! Take ownership of the given KDEModel.
+  KDEModel(KDEModel&& other);
+
+  //! Copy the given KDEModel.
+  KDEModel& operator=(const KDEModel& other);
+
+  //! Take ownership of the given KDEModel.
+  KDEModel& operator=(KDEModel&& other);
+
+  //! Clean memory, if necessary.
+  ~KDEModel();
+
+  //! Serialize the KDE model.
+  template<typename Archive>
+  void Serialize(Archive& ar, const unsigned int /* version */);
+
+  //! Get the kernel.
+  KernelTypes KernelType() const { return kernelType; }
+  //! Modify the kernel (don't do this after the model has been built).
+  KernelTypes& KernelType() { return kernelType; }
+
+  //! Get the type of tree.
+  TreeTypes TreeType() const { return treeType; }
+  //! Modify the type of tree (don't do this after the model has been built).
+  TreeTypes& TreeType() { return treeType; }
+
+  //! Get the bandwidth of the kernel.
+  double Bandwidth() const { return bandwidth; }
+  //! Modify the bandwidth (don't do this after the model has been built).
+  double& Bandwidth() { return bandwidth; }
+
+  //! Get the largest relative error of each estimation.
+  double RelativeError() const { return relativeError; }
+  //! Get the largest absolute error of each estimation.
+  double AbsoluteError() const { return absoluteError; }
+  //! Set the largest relative and absolute errors of each estimation.
+  void Errors(const double relativeError, const double absoluteError);
+
+  //! Expose the dataset.
+  const arma::mat& Dataset() const;
+
+  /**
+   * Build the tree on the given reference set.  This takes possession of the
+   * reference set to avoid a copy.
+   *
+   * @param referenceSet Set of reference points.
+   * @param naive Whether the sums should be computed without trees.
+   * @param singleMode Whether single-tree traversals should be used.
+   */
+  void BuildModel(arma::mat&& referenceSet,
+                  const bool naive = false,
+                  const bool singleMode = false);
+
+  /**
+   * Set whether single-tree traversals are used, and the number of threads for
+   * the dual-tree traversals (0 means the OpenMP default).  Whether the sums
+   * are computed without trees is fixed when the model is built.
+   */
+  void SearchMode(const bool singleMode, const size_t numThreads = 0);
+
+  /**
+   * Estimate the density of the reference set at each point of the query set.
+   *
+   * @param querySet Set of query points.
+   * @param estimations Will hold the estimation for each query point.
+   */
+  void Evaluate(const arma::mat& querySet, arma::vec& estimations);
+
+  /**
+   * Estimate the density of the reference set at each of its points.
+   *
+   * @param estimations Will hold the estimation for each reference point.
+   */
+  void Evaluate(arma::vec& estimations);
+
+ private:
+  //! Create a KDE object with the given kernel and tree type.
+  template<typename Kernel>
+  void Create(const bool naive, const bool singleMode);
+};
+
+} // namespace kde
+} // namespace mlpack
+
+// Include implementation (of Serialize() and inline functions).
+#include "kde_model_impl.hpp"
+
+#endif
@@ -0,0 +1,162 @@
+/**
+ * @file kde_model_impl.hpp
+ *
+ * Implementation of Serialize() and templated functions for KDEModel.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_KDE_KDE_MODEL_IMPL_HPP
+#define MLPACK_METHODS_KDE_KDE_MODEL_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "kde_model.hpp"
+
+namespace mlpack {
+namespace kde {
+
+//! Build the tree of the given KDEType instance.
+template<typename KDEType>
+void TrainVisitor::operator()(KDEType* kde) const
+{
+  if (kde)
+    return kde->Train(std::move(referenceSet));
+  throw std::runtime_error("no KDE model initialized");
+}
+
+//! Estimate the density at the query points with the given KDEType instance.
+template<typename KDEType>
+void EvaluateVisitor::operator()(KDEType* kde) const
+{
+  if (kde)
+    return kde->Evaluate(querySet, estimations);
+  throw std::runtime_error("no KDE model initialized");
+}
+
+//! Estimate the density at the reference points with the given KDEType
+//! instance.
+template<typename KDEType>
+void MonoEvaluateVisitor::operator()(KDEType* kde) const
+{
+  if (kde)
+    return kde->Evaluate(estimations);
+  throw std::runtime_error("no KDE model initialized");
+}
+
+//! Set the errors of the given KDEType instance.
+template<typename KDEType>
+void ErrorVisitor::operator()(KDEType* kde) const
+{
+  if (kde)
+  {
+    kde->RelativeError(relativeError);
+    kde->AbsoluteError(absoluteError);
+  }
+}
+
+//! Set the search mode of the given KDEType instance.
+template<typename KDEType>
+void SearchModeVisitor::operator()(KDEType* kde) const
+{
+  if (!kde)
+    throw std::runtime_error("no KDE model initialized");
+
+  kde->SingleMode() = !kde->Naive() && singleMode;
+  kde->NumThreads() = numThreads;
+}
+
+//! Return the reference set of the given KDEType instance.
+template<typename KDEType>
+const arma::mat& ReferenceSetVisitor::operator()(KDEType* kde) const
+{
+  if (kde)
+    return kde->ReferenceSet();
+  throw std::runtime_error("no KDE model initialized");
+}
+
+//! Return a copy of the given KDEType instance.
+template<typename VariantType>
+template<typename KDEType>
+VariantType CopyVisitor<VariantType>::operator()(KDEType* kde) const
+{
+  return kde ? new KDEType(*kde) : (KDEType*) NULL;
+}
+
+//! Delete the given KDEType instance.
+template<typename KDEType>
+void DeleteVisitor::operator()(KDEType* kde) const
+{
+  if (kde)
+    delete kde;
+}
+
+//! Serialize the given KDEType instance.
+template<typename Archive>
+template<typename KDEType>
+void SerializeVisitor<Archive>::operator()(KDEType* kde) const
+{
+  if (!kde)
+    throw std::runtime_error("no KDE model initialized");
+  ar & data::CreateNVP(*kde, name);
+}
+
+// Serialize the model.
+template<typename Archive>
+void KDEModel::Serialize(Archive& ar, const unsigned int /* version */)
+{
+  using data::CreateNVP;
+
+  ar & CreateNVP(kernelType, "kernelType");
+  ar & CreateNVP(treeType, "treeType");
+  ar & CreateNVP(bandwidth, "bandwidth");
+  ar & CreateNVP(relativeError, "relativeError");
+  ar & CreateNVP(absoluteError, "absoluteError");
+
+  // When loading, create an empty model of the right type to load into.
+  if (Archive::is_loading::value)
+  {
+    boost::apply_visitor(DeleteVisitor(), kdeModel);
+    if (kernelType == GAUSSIAN_KERNEL)
+      Create<kernel::GaussianKernel>(false, false);
+    else
+      Create<kernel::EpanechnikovKernel>(false, false);
+  }
+
+  // We'll only need to serialize one of the model objects, based on the type.
+  const std::string name = "kde_model";
+  SerializeVisitor<Archive> s(ar, name);
+  boost::apply_visitor(s, kdeModel);
+}
+
+//! Create a KDE object with the given kernel and the tree type of the model.
+template<typename Kernel>
+void KDEModel::Create(const bool naive, const bool singleMode)
+{
+  const Kernel kernel(bandwidth);
+  switch (treeType)
+  {
+    case KD_TREE:
+      kdeModel = new KDEType<Kernel, tree::KDTree>(relativeError,
+          absoluteError, kernel, naive, singleMode);
+      break;
+    case BALL_TREE:
+      kdeModel = new KDEType<Kernel, tree::BallTree>(relativeError,
+          absoluteError, kernel, naive, singleMode);
+      break;
+    case COVER_TREE:
+      kdeModel = new KDEType<Kernel, tree::StandardCoverTree>(
+          relativeError, absoluteError, kernel, naive, singleMode);
+      break;
+    case OCTREE:
+      kdeModel = new KDEType<Kernel, tree::Octree>(relativeError,
+          absoluteError, kernel, naive, singleMode);
+      break;
+  }
+}
+
+} // namespace kde
+} // namespace mlpack
+
+#endif
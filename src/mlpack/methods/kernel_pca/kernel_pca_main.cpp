@@ -27,8 +27,10 @@
 #include <mlpack/methods/nystroem_method/ordered_selection.hpp>
 #include <mlpack/methods/nystroem_method/random_selection.hpp>
 #include <mlpack/methods/nystroem_method/kmeans_selection.hpp>
+#include <mlpack/methods/nystroem_method/kmeans_plus_plus_selection.hpp>
 #include <mlpack/methods/nystroem_method/nystroem_method.hpp>
 #include <mlpack/methods/kernel_pca/kernel_rules/nystroem_method.hpp>
+#include <mlpack/methods/kernel_pca/kernel_rules/randomized_method.hpp>
 
 #include "kernel_pca.hpp"
 
@@ -87,7 +89,15 @@ PROGRAM_INFO("Kernel Principal Components Analysis",
     " a subset of the data as basis to reconstruct the kernel matrix; to "
     "specify the sampling scheme, the --sampling parameter is used, the "
     "sampling scheme for the nystr\u00F6m method can be chosen from the "
-    "following list: kmeans, random, ordered.");
+    "following list: kmeans, kmeans++, random, ordered.  The 'kmeans++' "
+    "scheme selects points spread over the dataset like 'kmeans', but without "
+    "running the k-means clustering."
+    "\n\n"
+    "Alternately, with --randomized (-R), the kernel matrix is never stored: "
+    "the eigenvectors with the largest eigenvalues are found with randomized "
+    "subspace iterations, which compute the kernel matrix one tile at a time.  "
+    "The memory used is then linear in the number of points, so this scales to "
+    "datasets whose kernel matrix does not fit in memory.");
 
 PARAM_MATRIX_IN_REQ("input", "Input dataset to perform KPCA on.", "i");
 PARAM_MATRIX_OUT("output", "Matrix to save modified dataset to.", "o");
@@ -104,7 +114,11 @@ PARAM_FLAG("center", "If set, the transformed data will be centered about the "
 PARAM_FLAG("nystroem_method", "If set, the nystroem method will be used.", "n");
 
 PARAM_STRING_IN("sampling", "Sampling scheme to use for the nystroem method: "
-    "'kmeans', 'random', 'ordered'", "s", "kmeans");
+    "'kmeans', 'kmeans++', 'random', 'ordered'", "s", "kmeans");
+
+PARAM_FLAG("randomized", "If set, only the leading eigenvectors are found, "
+    "with randomized subspace iterations, without storing the kernel matrix.",
+    "R");
 
 PARAM_DOUBLE_IN("kernel_scale", "Scale, for 'hyptan' kernel.", "S", 1.0);
 PARAM_DOUBLE_IN("offset", "Offset, for 'hyptan' and 'polynomial' kernels.", "O",
@@ -132,6 +146,12 @@ void RunKPCA(arma::mat& dataset,
           KMeansSelection<> > >kpca;
       kpca.Apply(dataset, newDim);
     }
+    else if (sampling == "kmeans++")
+    {
+      KernelPCA<KernelType, NystroemKernelRule<KernelType,
+          KMeansPlusPlusSelection> > kpca;
+      kpca.Apply(dataset, newDim);
+    }
     else if (sampling == "random")
     {
       KernelPCA<KernelType, NystroemKernelRule<KernelType,
@@ -148,9 +168,15 @@ void RunKPCA(arma::mat& dataset,
     {
       // Invalid sampling scheme.
       Log::Fatal << "Invalid sampling scheme ('" << sampling << "'); valid "
-        << "choices are 'kmeans', 'random' and 'ordered'" << endl;
+        << "choices are 'kmeans', 'kmeans++', 'random' and 'ordered'" << endl;
     }
   }
+  else if (CLI::HasParam("randomized"))
+  {
+    KernelPCA<KernelType, RandomizedKernelRule<KernelType> > kpca(kernel,
+        centerTransformedData);
+    kpca.Apply(dataset, newDim);
+  }
   else
   {
     KernelPCA<KernelType> kpca(kernel, centerTransformedData);
@@ -191,6 +217,10 @@ int main(int argc, char** argv)
   const bool nystroem = CLI::HasParam("nystroem_method");
   const string sampling = CLI::GetParam<string>("sampling");
 
+  if (nystroem && CLI::HasParam("randomized"))
+    Log::Warn << "--randomized (-R) ignored because --nystroem_method (-n) is "
+        << "specified." << endl;
+
   if (kernelType == "linear")
   {
     LinearKernel kernel;
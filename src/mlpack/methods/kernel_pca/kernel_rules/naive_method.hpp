@@ -14,6 +14,7 @@
 #define MLPACK_METHODS_KERNEL_PCA_NAIVE_METHOD_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <mlpack/core/kernels/kernel_matrix.hpp>
 
 namespace mlpack {
 namespace kpca {
@@ -44,33 +45,68 @@ class NaiveKernelRule
   // Resize the kernel matrix to the right size.
   kernelMatrix.set_size(data.n_cols, data.n_cols);
 
-  // Note that we only need to calculate the upper triangular part of the
-  // kernel matrix, since it is symmetric. This helps minimize the number of
-  // kernel evaluations.
-  for (size_t i = 0; i < data.n_cols; ++i)
+  // The kernel matrix is computed one tile at a time, in parallel, with a
+  // single matrix product per tile for kernels that allow it.  Note that we
+  // only need to calculate the tiles on and above the diagonal, since the
+  // matrix is symmetric; the tiles below are copied by transposition.
+  const size_t tileSize = 512;
+  const size_t numTiles = (data.n_cols + tileSize - 1) / tileSize;
+
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables. If we're building for Visual Studio, use
+  // the intmax_t type instead.
+  #pragma omp parallel for schedule(dynamic)
+  for (intmax_t i = 0; i < (intmax_t) numTiles; ++i)
+#else
+  #pragma omp parallel for schedule(dynamic)
+  for (size_t i = 0; i < numTiles; ++i)
+#endif
   {
-    for (size_t j = i; j < data.n_cols; ++j)
+    const size_t rowBegin = i * tileSize;
+    const size_t rowEnd = std::min(rowBegin + tileSize, (size_t) data.n_cols);
+    const arma::mat rowPoints(const_cast<double*>(data.colptr(rowBegin)),
+        data.n_rows, rowEnd - rowBegin, false, true);
+
+    arma::mat tile;
+    for (size_t j = i; j < numTiles; ++j)
     {
-      // Evaluate the kernel on these two points.
-      kernelMatrix(i, j) = kernel.Evaluate(data.unsafe_col(i),
-                                           data.unsafe_col(j));
+      const size_t colBegin = j * tileSize;
+      const size_t colEnd = std::min(colBegin + tileSize,
+          (size_t) data.n_cols);
+      const arma::mat colPoints(const_cast<double*>(data.colptr(colBegin)),
+          data.n_rows, colEnd - colBegin, false, true);
+
+      kernel::KernelMatrix(kernel, rowPoints, colPoints, tile);
+      kernelMatrix.submat(rowBegin, colBegin, rowEnd - 1, colEnd - 1) = tile;
+      if (j != (size_t) i)
+        kernelMatrix.submat(colBegin, rowBegin, colEnd - 1, rowEnd - 1) =
+            tile.t();
     }
   }
 
-  // Copy to the lower triangular part of the matrix.
-  for (size_t i = 1; i < data.n_cols; ++i)
-    for (size_t j = 0; j < i; ++j)
-      kernelMatrix(i, j) = kernelMatrix(j, i);
-
   // For PCA the data has to be centered, even if the data is centered. But it
   // is not guaranteed that the data, when mapped to the kernel space, is also
   // centered. Since we actually never work in the feature space we cannot
   // center the data. So, we perform a "psuedo-centering" using the kernel
-  // matrix.
-  arma::rowvec rowMean = arma::sum(kernelMatrix, 0) / kernelMatrix.n_cols;
-  kernelMatrix.each_col() -= arma::sum(kernelMatrix, 1) / kernelMatrix.n_cols;
-  kernelMatrix.each_row() -= rowMean;
-  kernelMatrix += arma::sum(rowMean) / kernelMatrix.n_cols;
+  // matrix: K(i, j) - mean(i) - mean(j) + mean, in a single pass over the
+  // matrix (the row and column means are the same, since it is symmetric).
+  const arma::vec means = arma::sum(kernelMatrix, 1) / kernelMatrix.n_cols;
+  const double mean = arma::mean(means);
+
+#ifdef _WIN32
+  #pragma omp parallel for schedule(static)
+  for (intmax_t j = 0; j < (intmax_t) kernelMatrix.n_cols; ++j)
+#else
+  #pragma omp parallel for schedule(static)
+  for (size_t j = 0; j < kernelMatrix.n_cols; ++j)
+#endif
+  {
+    double* column = kernelMatrix.colptr(j);
+    const double offset = mean - means[j];
+    for (size_t i = 0; i < kernelMatrix.n_rows; ++i)
+      column[i] += offset - means[i];
+  }
 
   // Eigendecompose the centered kernel matrix.
   arma::eig_sym(eigval, eigvec, kernelMatrix);
@@ -0,0 +1,185 @@
+/**
+ * @file randomized_method.hpp
+ *
+ * Find the leading eigenvectors of the kernel matrix with randomized subspace
+ * iterations, without storing the kernel matrix.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_KERNEL_PCA_RANDOMIZED_METHOD_HPP
+#define MLPACK_METHODS_KERNEL_PCA_RANDOMIZED_METHOD_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/kernels/kernel_matrix.hpp>
+
+namespace mlpack {
+namespace kpca {
+
+/**
+ * The RandomizedKernelRule finds the 'rank' leading eigenvalues and
+ * eigenvectors of the centered kernel matrix with randomized subspace
+ * iterations (Halko, Martinsson and Tropp, 2011).  The kernel matrix is never
+ * stored: each product of the centered kernel matrix with a block of vectors
+ * is computed one tile of the kernel matrix at a time, with the rows of the
+ * result split between threads, and the centering is applied to the product
+ * instead of to the matrix.  So the memory used is linear in the number of
+ * points, at the cost of evaluating the kernel matrix once per product.
+ *
+ * The leading eigenvalues are the ones of largest magnitude; for kernels that
+ * are not positive semidefinite (such as the hyperbolic tangent kernel), large
+ * negative eigenvalues may be found instead of small positive ones.
+ *
+ * @tparam KernelType Kernel to be used for computation.
+ * @tparam PowerIterations Number of subspace iterations.
+ * @tparam Oversampling Number of vectors used in addition to 'rank'.
+ */
+template<typename KernelType,
+         size_t PowerIterations = 3,
+         size_t Oversampling = 10>
+class RandomizedKernelRule
+{
+ public:
+  /**
+   * Find the leading eigenvectors of the centered kernel matrix.
+   *
+   * @param data Input data points.
+   * @param transformedData Matrix to output results into.
+   * @param eigval KPCA eigenvalues will be written to this vector.
+   * @param eigvec KPCA eigenvectors will be written to this matrix.
+   * @param rank Number of eigenvectors to find.
+   * @param kernel Kernel to be used for computation.
+   */
+  static void ApplyKernelMatrix(const arma::mat& data,
+                                arma::mat& transformedData,
+                                arma::vec& eigval,
+                                arma::mat& eigvec,
+                                const size_t rank,
+                                KernelType kernel = KernelType())
+  {
+    const size_t n = data.n_cols;
+    const size_t k = std::min(std::max(rank, (size_t) 1), n);
+    const size_t l = std::min(k + Oversampling, n);
+
+    // The means of the rows of the kernel matrix, for the centering.
+    arma::vec means;
+    Multiply(data, kernel, arma::ones<arma::mat>(n, 1), means);
+    means /= n;
+    const double mean = arma::mean(means);
+
+    // Find a basis of the range of the centered kernel matrix.
+    arma::mat Q = arma::randn<arma::mat>(n, l);
+    arma::mat Y, R;
+    CenteredMultiply(data, kernel, means, mean, Q, Y);
+    for (size_t i = 0; i < PowerIterations; ++i)
+    {
+      arma::qr_econ(Q, R, Y);
+      CenteredMultiply(data, kernel, means, mean, Q, Y);
+    }
+    arma::qr_econ(Q, R, Y);
+
+    // Rayleigh-Ritz: eigendecompose the projection of the centered kernel
+    // matrix onto the basis.
+    CenteredMultiply(data, kernel, means, mean, Q, Y);
+    arma::mat projection = Q.t() * Y;
+    projection = 0.5 * (projection + projection.t());
+
+    arma::vec values;
+    arma::mat vectors;
+    arma::eig_sym(values, vectors, projection);
+
+    // The eigenvalues are ordered backwards (we need largest to smallest).
+    values = arma::flipud(values);
+    vectors = arma::fliplr(vectors);
+    eigval = values.subvec(0, k - 1);
+    vectors = vectors.cols(0, k - 1);
+
+    // Since Y is the product of the centered kernel matrix with Q, the
+    // projection of the points onto the eigenvectors needs no other product
+    // with the kernel matrix.
+    transformedData = arma::trans(Y * vectors);
+    transformedData.each_col() /= arma::sqrt(eigval);
+    eigvec = Q * vectors;
+  }
+
+  /**
+   * Compute the product of the kernel matrix of the given points with the
+   * given vectors, one tile of the kernel matrix at a time.  Each thread
+   * computes the rows of the result of its own tiles of rows.
+   *
+   * @param data Input data points.
+   * @param kernel Kernel to be used for computation.
+   * @param vectors Vectors to multiply (one row per point).
+   * @param output Matrix to store the product into.
+   */
+  static void Multiply(const arma::mat& data,
+                       KernelType& kernel,
+                       const arma::mat& vectors,
+                       arma::mat& output)
+  {
+    const size_t tileSize = 512;
+    const size_t numTiles = (data.n_cols + tileSize - 1) / tileSize;
+    output.zeros(data.n_cols, vectors.n_cols);
+
+#ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables. If we're building for Visual Studio, use
+    // the intmax_t type instead.
+    #pragma omp parallel for schedule(dynamic)
+    for (intmax_t i = 0; i < (intmax_t) numTiles; ++i)
+#else
+    #pragma omp parallel for schedule(dynamic)
+    for (size_t i = 0; i < numTiles; ++i)
+#endif
+    {
+      const size_t rowBegin = i * tileSize;
+      const size_t rowEnd = std::min(rowBegin + tileSize,
+          (size_t) data.n_cols);
+      const arma::mat rowPoints(const_cast<double*>(data.colptr(rowBegin)),
+          data.n_rows, rowEnd - rowBegin, false, true);
+
+      arma::mat tile;
+      arma::mat rows(rowEnd - rowBegin, vectors.n_cols, arma::fill::zeros);
+      for (size_t j = 0; j < numTiles; ++j)
+      {
+        const size_t colBegin = j * tileSize;
+        const size_t colEnd = std::min(colBegin + tileSize,
+            (size_t) data.n_cols);
+        const arma::mat colPoints(const_cast<double*>(data.colptr(colBegin)),
+            data.n_rows, colEnd - colBegin, false, true);
+
+        kernel::KernelMatrix(kernel, rowPoints, colPoints, tile);
+        rows += tile * vectors.rows(colBegin, colEnd - 1);
+      }
+
+      output.rows(rowBegin, rowEnd - 1) = rows;
+    }
+  }
+
+ private:
+  /**
+   * Compute the product of the centered kernel matrix with the given vectors,
+   * K V - 1 (m^T V) - m (1^T V) + mean 1 (1^T V), where m holds the means of
+   * the rows of the kernel matrix.
+   */
+  static void CenteredMultiply(const arma::mat& data,
+                               KernelType& kernel,
+                               const arma::vec& means,
+                               const double mean,
+                               const arma::mat& vectors,
+                               arma::mat& output)
+  {
+    Multiply(data, kernel, vectors, output);
+
+    const arma::rowvec sums = arma::sum(vectors, 0);
+    output.each_row() -= means.t() * vectors - mean * sums;
+    output -= means * sums;
+  }
+};
+
+} // namespace kpca
+} // namespace mlpack
+
+#endif
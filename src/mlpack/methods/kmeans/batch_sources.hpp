@@ -0,0 +1,281 @@
+/**
+ * @file batch_sources.hpp
+ *
+ * Sources of batches of points for MiniBatchKMeans: one that samples batches
+ * from a matrix held in memory, and ones that read batches from a stream or
+ * from the blocks of a data::ChunkedReader, so that the dataset never has to be
+ * held in memory.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_KMEANS_BATCH_SOURCES_HPP
+#define MLPACK_METHODS_KMEANS_BATCH_SOURCES_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/math/random.hpp>
+#include <mlpack/core/data/chunked_reader.hpp>
+
+namespace mlpack {
+namespace kmeans {
+
+/**
+ * A batch source that samples every batch uniformly at random (with
+ * replacement) from the columns of a matrix held in memory.  It never runs
+ * out of points.
+ *
+ * @tparam MatType Matrix type (arma::mat or arma::sp_mat).
+ */
+template<typename MatType = arma::mat>
+class MatrixBatchSource
+{
+ public:
+  /**
+   * Create the source to sample from the given matrix, which must not be
+   * destroyed while the source is in use.
+   *
+   * @param data Matrix to sample points from.
+   */
+  MatrixBatchSource(const MatType& data) : data(data) { }
+
+  /**
+   * Sample the given number of points into the batch.
+   *
+   * @param batchSize Number of points to sample.
+   * @param batch Matrix to store the points in.
+   * @return The number of points in the batch (batchSize, or 0 if the matrix is
+   *     empty).
+   */
+  size_t NextBatch(const size_t batchSize, arma::mat& batch)
+  {
+    if (data.n_cols == 0)
+    {
+      batch.reset();
+      return 0;
+    }
+
+    batch.set_size(data.n_rows, batchSize);
+    for (size_t i = 0; i < batchSize; ++i)
+      batch.col(i) = arma::vec(data.col(math::RandInt(0, data.n_cols)));
+
+    return batchSize;
+  }
+
+  //! Get the dimensionality of the points.
+  size_t Dimensionality() const { return data.n_rows; }
+
+ private:
+  //! The matrix to sample from.
+  const MatType& data;
+};
+
+/**
+ * A batch source that reads points from a stream of text, one point per line,
+ * with the values of each point separated by commas, spaces or tabs (like the
+ * CSV files that data::Load() reads).  Empty lines are skipped.  When the end
+ * of the stream is reached, the source can either start again at the
+ * beginning (so that the data is read several times, which requires a stream
+ * that can seek), or report that it has run out of points.
+ *
+ * Only one batch of points is held in memory at a time.
+ */
+class StreamBatchSource
+{
+ public:
+  /**
+   * Create the source to read the given stream, which must not be destroyed
+   * while the source is in use.
+   *
+   * @param stream Stream to read points from.
+   * @param rewind If true, start again at the beginning of the stream when its
+   *     end is reached.
+   */
+  StreamBatchSource(std::istream& stream, const bool rewind = true) :
+      stream(stream),
+      rewind(rewind),
+      dimensionality(0)
+  { }
+
+  /**
+   * Read up to the given number of points into the batch.  Fewer points are
+   * read only if the end of the stream is reached and it is not rewound.  A
+   * std::runtime_error is thrown if a line can't be parsed or has a different
+   * dimensionality than the first line.
+   *
+   * @param batchSize Maximum number of points to read.
+   * @param batch Matrix to store the points in.
+   * @return The number of points read.
+   */
+  size_t NextBatch(const size_t batchSize, arma::mat& batch)
+  {
+    std::vector<double> values;
+    size_t points = 0;
+    bool rewound = false;
+    std::string line;
+    while (points < batchSize)
+    {
+      if (!std::getline(stream, line))
+      {
+        // Only rewind once per batch, so that a stream without any points
+        // doesn't loop forever.
+        if (!rewind || rewound)
+          break;
+
+        stream.clear();
+        stream.seekg(0);
+        rewound = true;
+        continue;
+      }
+
+      const size_t oldSize = values.size();
+      ParseLine(line, values);
+      const size_t lineDimensionality = values.size() - oldSize;
+      if (lineDimensionality == 0)
+        continue;
+
+      if (dimensionality == 0)
+        dimensionality = lineDimensionality;
+      else if (lineDimensionality != dimensionality)
+      {
+        std::ostringstream oss;
+        oss << "StreamBatchSource::NextBatch(): line has " << lineDimensionality
+            << " values, but earlier lines have " << dimensionality;
+        throw std::runtime_error(oss.str());
+      }
+
+      ++points;
+      rewound = false;
+    }
+
+    batch.set_size(dimensionality, points);
+    std::copy(values.begin(), values.end(), batch.memptr());
+    return points;
+  }
+
+  //! Get the dimensionality of the points (0 if none have been read yet).
+  size_t Dimensionality() const { return dimensionality; }
+
+ private:
+  //! The stream to read from.
+  std::istream& stream;
+  //! Whether to start again at the beginning of the stream at its end.
+  bool rewind;
+  //! The dimensionality of the points.
+  size_t dimensionality;
+
+  //! Append the values of the given line to the given vector.
+  static void ParseLine(const std::string& line, std::vector<double>& values)
+  {
+    const char* position = line.c_str();
+    while (*position != '\0')
+    {
+      if (*position == ',' || std::isspace((unsigned char) *position))
+      {
+        ++position;
+        continue;
+      }
+
+      char* end;
+      const double value = std::strtod(position, &end);
+      if (end == position)
+        throw std::runtime_error("StreamBatchSource::NextBatch(): could not "
+            "parse line '" + line + "'");
+
+      values.push_back(value);
+      position = end;
+    }
+  }
+};
+
+/**
+ * A batch source that cuts batches from the blocks of a data::ChunkedReader,
+ * so that CSV, binary and HDF5 files can be streamed (with the blocks in a
+ * random order if the reader shuffles them).  A batch may span several blocks.
+ * When a pass of the reader is over, the source can either start a new pass,
+ * or report that it has run out of points.
+ *
+ * Only the current block (and the block the reader is fetching) is held in
+ * memory.
+ */
+class ChunkedBatchSource
+{
+ public:
+  /**
+   * Create the source to read the blocks of the given reader, which must not
+   * be destroyed while the source is in use.
+   *
+   * @param reader Reader to take blocks from.
+   * @param rewind If true, start a new pass of the reader when a pass is over.
+   */
+  ChunkedBatchSource(data::ChunkedReader& reader, const bool rewind = true) :
+      reader(reader),
+      rewind(rewind),
+      offset(0)
+  { }
+
+  /**
+   * Copy up to the given number of points into the batch.  Fewer points are
+   * copied only if a pass of the reader is over and it is not rewound.
+   *
+   * @param batchSize Maximum number of points to copy.
+   * @param batch Matrix to store the points in.
+   * @return The number of points copied.
+   */
+  size_t NextBatch(const size_t batchSize, arma::mat& batch)
+  {
+    batch.set_size(reader.Dimensionality(), batchSize);
+    size_t points = 0;
+    bool rewound = false;
+    while (points < batchSize)
+    {
+      if (offset == block.n_cols)
+      {
+        if (!reader.Next(block))
+        {
+          // Only start one new pass per batch, so that a reader without any
+          // points doesn't loop forever.
+          if (!rewind || rewound)
+            break;
+
+          rewound = true;
+          continue;
+        }
+
+        offset = 0;
+      }
+
+      const size_t count = std::min(batchSize - points,
+          (size_t) block.n_cols - offset);
+      batch.cols(points, points + count - 1) =
+          block.cols(offset, offset + count - 1);
+      points += count;
+      offset += count;
+      rewound = false;
+    }
+
+    if (points < batchSize)
+      batch.resize(reader.Dimensionality(), points);
+
+    return points;
+  }
+
+  //! Get the dimensionality of the points.
+  size_t Dimensionality() const { return reader.Dimensionality(); }
+
+ private:
+  //! The reader to take blocks from.
+  data::ChunkedReader& reader;
+  //! Whether to start a new pass of the reader when a pass is over.
+  bool rewind;
+  //! The current block.
+  arma::mat block;
+  //! The index of the next point of the current block.
+  size_t offset;
+};
+
+} // namespace kmeans
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,104 @@
+/**
+ * @file blocked_kmeans.hpp
+ *
+ * An implementation of a step of the Lloyd algorithm for k-means clustering
+ * that computes the distances between blocks of points and blocks of centroids
+ * with matrix multiplications.  This is much faster than the naive step for
+ * high-dimensional data.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_KMEANS_BLOCKED_KMEANS_HPP
+#define MLPACK_METHODS_KMEANS_BLOCKED_KMEANS_HPP
+
+#include <mlpack/core/metrics/lmetric.hpp>
+
+namespace mlpack {
+namespace kmeans {
+
+/**
+ * This is an implementation of a single iteration of Lloyd's algorithm for
+ * k-means, which finds the closest centroid to every point like NaiveKMeans
+ * does, but computes the squared distances of a block of points to a block of
+ * centroids at once with
+ *
+ *   || x - c ||^2 = || x ||^2 - 2 x^T c + || c ||^2,
+ *
+ * so that most of the work is one matrix multiplication (a BLAS DGEMM call)
+ * per pair of blocks.  The squared norms of the points are computed once and
+ * cached for all iterations; the squared norms of the centroids are computed
+ * once per iteration.  Blocks of points are handled in parallel when OpenMP is
+ * available.
+ *
+ * Because the distances are computed with a different formula, a point whose
+ * two closest centroids are at almost exactly the same distance may be
+ * assigned to a different one than NaiveKMeans would assign it to.
+ *
+ * This can only be used with the EuclideanDistance or SquaredEuclideanDistance
+ * metrics.  If your intention is to run the full k-means algorithm, you are
+ * looking for the mlpack::kmeans::KMeans class instead of this one.
+ *
+ * @param MetricType Type of metric used with this implementation.
+ * @param MatType Matrix type (arma::mat or arma::sp_mat).
+ */
+template<typename MetricType, typename MatType>
+class BlockedKMeans
+{
+  static_assert(std::is_same<MetricType, metric::EuclideanDistance>::value ||
+      std::is_same<MetricType, metric::SquaredEuclideanDistance>::value,
+      "BlockedKMeans can only be used with EuclideanDistance or "
+      "SquaredEuclideanDistance.");
+
+ public:
+  /**
+   * Construct the BlockedKMeans object with the given dataset and metric.
+   *
+   * @param dataset Dataset.
+   * @param metric Instantiated metric.
+   */
+  BlockedKMeans(const MatType& dataset, MetricType& metric);
+
+  /**
+   * Run a single iteration of the Lloyd algorithm, updating the given centroids
+   * into the newCentroids matrix.  If any cluster is empty (that is, if any
+   * cluster has no points assigned to it), then the centroid associated with
+   * that cluster may be filled with invalid data (it will be corrected later).
+   *
+   * @param centroids Current cluster centroids.
+   * @param newCentroids New cluster centroids.
+   * @param counts Number of points in each cluster at the end of the iteration.
+   */
+  double Iterate(const arma::mat& centroids,
+                 arma::mat& newCentroids,
+                 arma::Col<size_t>& counts);
+
+  size_t DistanceCalculations() const { return distanceCalculations; }
+
+  //! Number of points in each block.
+  static const size_t PointBlockSize = 256;
+  //! Number of centroids in each block.
+  static const size_t CentroidBlockSize = 1024;
+
+ private:
+  //! The dataset.
+  const MatType& dataset;
+  //! The instantiated metric.
+  MetricType& metric;
+
+  //! The squared norm of each point.
+  arma::vec pointNorms;
+
+  //! Number of distance calculations.
+  size_t distanceCalculations;
+};
+
+} // namespace kmeans
+} // namespace mlpack
+
+// Include implementation.
+#include "blocked_kmeans_impl.hpp"
+
+#endif
@@ -0,0 +1,166 @@
+/**
+ * @file blocked_kmeans_impl.hpp
+ *
+ * An implementation of a step of the Lloyd algorithm for k-means clustering
+ * that computes the distances between blocks of points and blocks of centroids
+ * with matrix multiplications.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_KMEANS_BLOCKED_KMEANS_IMPL_HPP
+#define MLPACK_METHODS_KMEANS_BLOCKED_KMEANS_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "blocked_kmeans.hpp"
+
+namespace mlpack {
+namespace kmeans {
+
+template<typename MetricType, typename MatType>
+BlockedKMeans<MetricType, MatType>::BlockedKMeans(const MatType& dataset,
+                                                  MetricType& metric) :
+    dataset(dataset),
+    metric(metric),
+    distanceCalculations(0)
+{ /* Nothing to do. */ }
+
+// Run a single iteration.
+template<typename MetricType, typename MatType>
+double BlockedKMeans<MetricType, MatType>::Iterate(const arma::mat& centroids,
+                                                   arma::mat& newCentroids,
+                                                   arma::Col<size_t>& counts)
+{
+  newCentroids.zeros(centroids.n_rows, centroids.n_cols);
+  counts.zeros(centroids.n_cols);
+
+  // The dataset doesn't change between iterations, so the squared norms of the
+  // points only have to be computed once.
+  if (pointNorms.n_elem != dataset.n_cols)
+  {
+    pointNorms.set_size(dataset.n_cols);
+    for (size_t i = 0; i < dataset.n_cols; ++i)
+      pointNorms[i] = arma::accu(arma::square(dataset.col(i)));
+  }
+
+  const arma::rowvec centroidNorms = arma::sum(arma::square(centroids), 0);
+
+#ifdef HAS_OPENMP
+  const size_t numThreads = omp_get_max_threads();
+#else
+  const size_t numThreads = 1;
+#endif
+
+  // The first thread accumulates its points into newCentroids and counts, and
+  // every other thread into its own sums and counts, which are added together
+  // afterwards.
+  std::vector<arma::mat> threadCentroids(numThreads - 1,
+      arma::mat(centroids.n_rows, centroids.n_cols, arma::fill::zeros));
+  std::vector<arma::Col<size_t>> threadCounts(numThreads - 1,
+      arma::Col<size_t>(centroids.n_cols, arma::fill::zeros));
+
+  const size_t numBlocks = (dataset.n_cols + PointBlockSize - 1) /
+      PointBlockSize;
+
+  #pragma omp parallel num_threads(numThreads)
+  {
+#ifdef HAS_OPENMP
+    const size_t thread = omp_get_thread_num();
+#else
+    const size_t thread = 0;
+#endif
+    arma::mat& localCentroids = (thread == 0) ? newCentroids :
+        threadCentroids[thread - 1];
+    arma::Col<size_t>& localCounts = (thread == 0) ? counts :
+        threadCounts[thread - 1];
+
+    arma::vec minDistances(PointBlockSize);
+    arma::Col<size_t> closestClusters(PointBlockSize);
+
+#ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables. If we're building for Visual Studio,
+    // use the intmax_t type instead.
+    #pragma omp for schedule(dynamic)
+    for (intmax_t b = 0; b < (intmax_t) numBlocks; ++b)
+#else
+    #pragma omp for schedule(dynamic)
+    for (size_t b = 0; b < numBlocks; ++b)
+#endif
+    {
+      const size_t begin = b * PointBlockSize;
+      const size_t end = std::min(begin + PointBlockSize,
+          (size_t) dataset.n_cols);
+      const size_t blockSize = end - begin;
+
+      minDistances.fill(DBL_MAX);
+
+      for (size_t cBegin = 0; cBegin < centroids.n_cols;
+           cBegin += CentroidBlockSize)
+      {
+        const size_t cEnd = std::min(cBegin + CentroidBlockSize,
+            (size_t) centroids.n_cols);
+
+        // The inner products of every point of the block with every centroid
+        // of the block.
+        const arma::mat products = arma::trans(dataset.cols(begin, end - 1)) *
+            centroids.cols(cBegin, cEnd - 1);
+
+        for (size_t j = 0; j < cEnd - cBegin; ++j)
+        {
+          for (size_t i = 0; i < blockSize; ++i)
+          {
+            const double distance = pointNorms[begin + i] -
+                2 * products(i, j) + centroidNorms[cBegin + j];
+            if (distance < minDistances[i])
+            {
+              minDistances[i] = distance;
+              closestClusters[i] = cBegin + j;
+            }
+          }
+        }
+      }
+
+      // Update the centroid of each point of the block.
+      for (size_t i = 0; i < blockSize; ++i)
+      {
+        localCentroids.col(closestClusters[i]) +=
+            arma::vec(dataset.col(begin + i));
+        localCounts(closestClusters[i])++;
+      }
+    }
+  }
+
+  // Add the sums and counts of the other threads, in a fixed order so that the
+  // result doesn't depend on the scheduling.
+  for (size_t t = 0; t < threadCentroids.size(); ++t)
+  {
+    newCentroids += threadCentroids[t];
+    counts += threadCounts[t];
+  }
+
+  // Now normalize the centroid.
+  for (size_t i = 0; i < centroids.n_cols; ++i)
+    if (counts(i) != 0)
+      newCentroids.col(i) /= counts(i);
+
+  distanceCalculations += centroids.n_cols * dataset.n_cols;
+
+  // Calculate cluster distortion for this iteration.
+  double cNorm = 0.0;
+  for (size_t i = 0; i < centroids.n_cols; ++i)
+  {
+    cNorm += std::pow(metric.Evaluate(centroids.col(i), newCentroids.col(i)),
+        2.0);
+  }
+  distanceCalculations += centroids.n_cols;
+
+  return std::sqrt(cNorm);
+}
+
+} // namespace kmeans
+} // namespace mlpack
+
+#endif
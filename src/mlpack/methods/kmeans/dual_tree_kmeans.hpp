@@ -18,6 +18,8 @@
 #include <mlpack/core/tree/binary_space_tree.hpp>
 #include <mlpack/methods/neighbor_search/neighbor_search.hpp>
 #include <mlpack/core/tree/cover_tree.hpp>
+#include <mlpack/core/tree/independent_subtrees.hpp>
+#include <mlpack/core/tree/traversal_statistics.hpp>
 
 #include "dual_tree_kmeans_statistic.hpp"
 
@@ -30,6 +32,16 @@ namespace kmeans {
  * dataset.  The conditions under which this will perform best are probably
  * limited to the case where k is close to the number of points in the dataset,
  * and the number of iterations of the k-means algorithm will be few.
+ *
+ * When OpenMP is available, the tree on the points is split into subtrees with
+ * disjoint sets of points, and the bound updates before each iteration, the
+ * hiding of pruned nodes, and the dual-tree traversal are all done in parallel
+ * over these subtrees.
+ *
+ * The tree built on the centroids is reused from one iteration to the next
+ * when the tree type supports refitting its bounds (like the kd-tree) and no
+ * centroid has moved further than RebuildThreshold() times the radius of the
+ * tree since it was built; otherwise, it is rebuilt.
  */
 template<
     typename MetricType,
@@ -50,6 +62,10 @@ class DualTreeKMeans
   using NNSTreeType =
       TreeType<TreeMetricType, DualTreeKMeansStatistic, TreeMatType>;
 
+  //! Convenience typedef for the search on the centroid tree.
+  typedef neighbor::NeighborSearch<neighbor::NearestNeighborSort, MetricType,
+      MatType, NNSTreeType> NNSType;
+
   /**
    * Construct the DualTreeKMeans object, which will construct a tree on the
    * points.
@@ -78,6 +94,21 @@ class DualTreeKMeans
   //! Modify the number of distance calculations.
   size_t& DistanceCalculations() { return distanceCalculations; }
 
+  //! Get the largest centroid movement (relative to the radius of the centroid
+  //! tree) for which the centroid tree is refit instead of rebuilt.
+  double RebuildThreshold() const { return rebuildThreshold; }
+  //! Modify the largest centroid movement (relative to the radius of the
+  //! centroid tree) for which the centroid tree is refit instead of rebuilt.
+  //! A negative threshold rebuilds the tree in every iteration.
+  double& RebuildThreshold() { return rebuildThreshold; }
+
+  //! Return the number of times the centroid tree has been built.
+  size_t CentroidTreeBuilds() const { return centroidTreeBuilds; }
+
+  //! Get the statistics of all iterations so far, including the searches for
+  //! the nearest centroid of each centroid and the centroid tree building.
+  const tree::TraversalStatistics& Statistics() const { return statistics; }
+
  private:
   //! The original dataset reference.
   const MatType& datasetOrig; // Maybe not necessary.
@@ -90,19 +121,40 @@ class DualTreeKMeans
 
   //! Track distance calculations.
   size_t distanceCalculations;
+  //! The statistics of all iterations.
+  tree::TraversalStatistics statistics;
   //! Track iteration number.
   size_t iteration;
 
+  //! The search object holding the tree built on the centroids.
+  NNSType* nns;
+  //! The centroids the centroid tree was last built on.
+  arma::mat treeCentroids;
+  //! The mapping of the centroids in the centroid tree.
+  std::vector<size_t> oldFromNewCentroids;
+  //! The largest relative movement for which the centroid tree is refit.
+  double rebuildThreshold;
+  //! The number of times the centroid tree has been built.
+  size_t centroidTreeBuilds;
+
+  //! Subtrees of the tree on the points with disjoint sets of points, which
+  //! are updated in parallel (empty if that is not done).
+  std::vector<Tree*> subtrees;
+  //! The nodes above the subtrees, each after its parent.
+  std::vector<Tree*> ancestors;
+
   //! Upper bounds on nearest centroid.
   arma::vec upperBounds;
   //! Lower bounds on second closest cluster distance for each point.
   arma::vec lowerBounds;
-  //! Indicator of whether or not the point is pruned.
-  std::vector<bool> prunedPoints;
+  //! Indicator of whether or not the point is pruned.  This is not a
+  //! std::vector<bool>, so that threads can set the entries of different
+  //! points at the same time.
+  std::vector<char> prunedPoints;
 
   arma::Row<size_t> assignments;
 
-  std::vector<bool> visited; // Was the point visited this iteration?
+  std::vector<char> visited; // Was the point visited this iteration?
 
   arma::mat lastIterationCentroids; // For sanity checks.
 
@@ -110,6 +162,10 @@ class DualTreeKMeans
 
   arma::mat interclusterDistances; // Static storage for intercluster distances.
 
+  //! Build the tree on the given centroids, or refit the last one if the
+  //! centroids have not moved too far.
+  void UpdateCentroidTree(const arma::mat& centroids);
+
   //! Update the bounds in the tree before the next iteration.
   //! centroids is the current (not yet searched) centroids.
   void UpdateTree(Tree& node,
@@ -119,6 +175,30 @@ class DualTreeKMeans
                   const double parentLowerBound = DBL_MAX,
                   const double adjustedParentLowerBound = 0.0);
 
+  //! Update the bounds in the whole tree before the next iteration, with the
+  //! subtrees updated in parallel.
+  void ParallelUpdateTree(const arma::mat& centroids);
+
+  //! Update the bounds of the given node before its children are updated, and
+  //! store the bounds for its children.  Returns whether the node was pruned
+  //! in the last iteration.
+  bool UpdateNodeBounds(Tree& node,
+                        const arma::mat& centroids,
+                        const double parentUpperBound,
+                        const double adjustedParentUpperBound,
+                        const double parentLowerBound,
+                        const double adjustedParentLowerBound,
+                        double& unadjustedUpperBound,
+                        double& adjustedUpperBound,
+                        double& unadjustedLowerBound,
+                        double& adjustedLowerBound);
+
+  //! Update the points of the given node and whether it is pruned, after its
+  //! children are updated.
+  void UpdateNodePoints(Tree& node,
+                        const arma::mat& centroids,
+                        const bool prunedLastIteration);
+
   //! Extract the centroids of the clusters.
   void ExtractCentroids(Tree& node,
                         arma::mat& newCentroids,
@@ -126,6 +206,8 @@ class DualTreeKMeans
                         const arma::mat& centroids);
 
   void CoalesceTree(Tree& node, const size_t child = 0);
+  //! Coalesce the whole tree, with the subtrees coalesced in parallel.
+  void ParallelCoalesceTree();
   void DecoalesceTree(Tree& node);
 };
 
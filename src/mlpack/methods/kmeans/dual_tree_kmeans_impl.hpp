@@ -20,6 +20,8 @@
 
 #include "dual_tree_kmeans_rules.hpp"
 
+#include <unordered_map>
+
 namespace mlpack {
 namespace kmeans {
 
@@ -61,6 +63,9 @@ DualTreeKMeans<MetricType, MatType, TreeType>::DualTreeKMeans(
     metric(metric),
     distanceCalculations(0),
     iteration(0),
+    nns(NULL),
+    rebuildThreshold(0.1),
+    centroidTreeBuilds(0),
     upperBounds(dataset.n_cols),
     lowerBounds(dataset.n_cols),
     prunedPoints(dataset.n_cols, false), // Fill with false.
@@ -86,6 +91,91 @@ DualTreeKMeans<MetricType, MatType, TreeType>::~DualTreeKMeans()
 {
   if (tree)
     delete tree;
+  if (nns)
+    delete nns;
+}
+
+HAS_MEM_FUNC(RefitBounds, HasRefitBoundsCheck);
+
+//! Refit a tree that can refit its bounds to the given centroids.
+template<typename TreeType>
+bool RefitCentroidTree(
+    TreeType& tree,
+    const arma::mat& centroids,
+    const std::vector<size_t>& oldFromNew,
+    const typename std::enable_if<HasRefitBoundsCheck<TreeType,
+        void(TreeType::*)()>::value>::type* = 0)
+{
+  // Move the points of the tree in place; the tree may have rearranged them.
+  for (size_t i = 0; i < centroids.n_cols; ++i)
+  {
+    const size_t index = tree::TreeTraits<TreeType>::RearrangesDataset ?
+        oldFromNew[i] : i;
+    tree.Dataset().col(i) = centroids.col(index);
+  }
+
+  tree.RefitBounds();
+  return true;
+}
+
+//! A tree that can't refit its bounds has to be rebuilt.
+template<typename TreeType>
+bool RefitCentroidTree(
+    TreeType& /* tree */,
+    const arma::mat& /* centroids */,
+    const std::vector<size_t>& /* oldFromNew */,
+    const typename std::enable_if<!HasRefitBoundsCheck<TreeType,
+        void(TreeType::*)()>::value>::type* = 0)
+{
+  return false;
+}
+
+template<typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void DualTreeKMeans<MetricType, MatType, TreeType>::UpdateCentroidTree(
+    const arma::mat& centroids)
+{
+  bool rebuild = (nns == NULL) || (treeCentroids.n_cols != centroids.n_cols);
+  if (!rebuild)
+  {
+    // Find how far the centroids have moved since the tree was built.
+    double maxMovement = 0.0;
+    for (size_t c = 0; c < centroids.n_cols; ++c)
+    {
+      maxMovement = std::max(maxMovement,
+          metric.Evaluate(treeCentroids.col(c), centroids.col(c)));
+    }
+    distanceCalculations += centroids.n_cols;
+
+    rebuild = (maxMovement > rebuildThreshold *
+        nns->ReferenceTree().FurthestDescendantDistance()) ||
+        !RefitCentroidTree(nns->ReferenceTree(), centroids,
+        oldFromNewCentroids);
+  }
+
+  if (!rebuild)
+    return;
+
+  // Build a tree on the centroids.  This will make a copy if necessary, which
+  // is unfortunate, but I don't see a reasonable way around it.
+  delete nns;
+  oldFromNewCentroids.clear();
+  Tree* centroidTree;
+  {
+    tree::TraversalStatistics::PhaseTimer timer(statistics.TreeBuildingTime());
+    centroidTree = BuildTree<Tree>(centroids, oldFromNewCentroids);
+  }
+
+  // We have to make our own TreeType for the search, which is a little bit
+  // abuse, but we know for sure the TreeStatType we have will work.
+  nns = new NNSType(std::move(*centroidTree));
+  delete centroidTree;
+
+  treeCentroids = centroids;
+  ++centroidTreeBuilds;
 }
 
 // Run a single iteration.
@@ -99,17 +189,26 @@ double DualTreeKMeans<MetricType, MatType, TreeType>::Iterate(
     arma::mat& newCentroids,
     arma::Col<size_t>& counts)
 {
-  // Build a tree on the centroids.  This will make a copy if necessary, which
-  // is unfortunate, but I don't see a reasonable way around it.
-  std::vector<size_t> oldFromNewCentroids;
-  Tree* centroidTree = BuildTree<Tree>(centroids, oldFromNewCentroids);
+  // Build (or refit) the tree on the centroids.
+  UpdateCentroidTree(centroids);
+
+#ifdef HAS_OPENMP
+  const size_t numThreads = omp_get_max_threads();
+#else
+  const size_t numThreads = 1;
+#endif
 
-  // Find the nearest neighbors of each of the clusters.  We have to make our
-  // own TreeType, which is a little bit abuse, but we know for sure the
-  // TreeStatType we have will work.
-  neighbor::NeighborSearch<neighbor::NearestNeighborSort, MetricType, MatType,
-      NNSTreeType> nns(std::move(*centroidTree));
+  // The subtrees of the uncoalesced tree are found once, since its structure
+  // never changes.
+  if (numThreads > 1 && subtrees.empty())
+  {
+    tree::IndependentSubtrees(*tree, 8 * numThreads, subtrees, ancestors);
+    if (ancestors.empty())
+      subtrees.clear(); // The tree can't be split.
+  }
+  const bool parallel = (numThreads > 1) && !subtrees.empty();
 
+  // Find the nearest neighbors of each of the clusters.
   // Reset information in the tree, if we need to.
   if (iteration > 0)
   {
@@ -121,8 +220,12 @@ double DualTreeKMeans<MetricType, MatType, TreeType>::Iterate(
         new arma::mat(1, centroids.n_elem) : &interclusterDistances;
 
     arma::Mat<size_t> closestClusters; // We don't actually care about these.
-    nns.Search(1, closestClusters, *interclusterDistancesTemp);
-    distanceCalculations += nns.BaseCases() + nns.Scores();
+    const size_t lastBaseCases = nns->BaseCases();
+    const size_t lastScores = nns->Scores();
+    nns->Search(1, closestClusters, *interclusterDistancesTemp);
+    distanceCalculations += (nns->BaseCases() - lastBaseCases) +
+        (nns->Scores() - lastScores);
+    statistics += nns->Statistics();
 
     // We need to do the unmapping ourselves, if the tree does mapping.
     if (tree::TreeTraits<Tree>::RearrangesDataset)
@@ -136,7 +239,10 @@ double DualTreeKMeans<MetricType, MatType, TreeType>::Iterate(
 
     Timer::Stop("knn");
 
-    UpdateTree(*tree, centroids);
+    if (parallel)
+      ParallelUpdateTree(centroids);
+    else
+      UpdateTree(*tree, centroids);
 
     for (size_t i = 0; i < dataset.n_cols; ++i)
       visited[i] = false;
@@ -151,21 +257,88 @@ double DualTreeKMeans<MetricType, MatType, TreeType>::Iterate(
   // We won't use the KNN class here because we have our own set of rules.
   lastIterationCentroids = centroids;
   typedef DualTreeKMeansRules<MetricType, Tree> RuleType;
-  RuleType rules(nns.ReferenceTree().Dataset(), dataset, assignments,
-      upperBounds, lowerBounds, metric, prunedPoints, oldFromNewCentroids,
-      visited);
-
-  typename Tree::template BreadthFirstDualTreeTraverser<RuleType>
-      traverser(rules);
 
   Timer::Start("tree_mod");
-  CoalesceTree(*tree);
+  if (parallel)
+    ParallelCoalesceTree();
+  else
+    CoalesceTree(*tree);
   Timer::Stop("tree_mod");
 
   // Set the number of pruned centroids in the root to 0.
   tree->Stat().Pruned() = 0;
-  traverser.Traverse(*tree, nns.ReferenceTree());
-  distanceCalculations += rules.BaseCases() + rules.Scores();
+
+  if (parallel)
+  {
+    // Traverse the subtrees of the coalesced tree in parallel.  These are
+    // different from the subtrees above, since pruned nodes are now hidden.
+    std::vector<Tree*> traversalSubtrees;
+    tree::IndependentSubtrees(*tree, 8 * numThreads, traversalSubtrees);
+
+    // The traversal starts at each subtree as if it was the root, because the
+    // nodes above the subtrees aren't visited.
+    for (size_t i = 0; i < traversalSubtrees.size(); ++i)
+    {
+      Tree& node = *traversalSubtrees[i];
+      if (!node.Stat().StaticPruned() && node.Stat().Pruned() == size_t(-1))
+        node.Stat().Pruned() = 0;
+    }
+
+    tree::TraversalStatistics::PhaseTimer timer(statistics.TraversalTime());
+    size_t baseCases = 0;
+    size_t scores = 0;
+    size_t prunes = 0;
+    #pragma omp parallel reduction(+:baseCases, scores, prunes)
+    {
+      // Each thread needs its own copy of the metric and its own rules.  They
+      // only change the nodes and points of the subtree they traverse.
+      MetricType threadMetric(metric);
+      RuleType rules(nns->ReferenceTree().Dataset(), dataset, assignments,
+          upperBounds, lowerBounds, threadMetric, prunedPoints,
+          oldFromNewCentroids, visited);
+
+#ifdef _WIN32
+      // Tiny workaround: Visual Studio only implements OpenMP 2.0, which
+      // doesn't support unsigned loop variables. If we're building for Visual
+      // Studio, use the intmax_t type instead.
+      #pragma omp for schedule(dynamic)
+      for (intmax_t i = 0; i < (intmax_t) traversalSubtrees.size(); ++i)
+#else
+      #pragma omp for schedule(dynamic)
+      for (size_t i = 0; i < traversalSubtrees.size(); ++i)
+#endif
+      {
+        typename Tree::template BreadthFirstDualTreeTraverser<RuleType>
+            traverser(rules);
+        traverser.Traverse(*traversalSubtrees[i], nns->ReferenceTree());
+        prunes += traverser.NumPrunes();
+      }
+
+      baseCases += rules.BaseCases();
+      scores += rules.Scores();
+    }
+
+    distanceCalculations += baseCases + scores;
+    statistics.BaseCases() += baseCases;
+    statistics.Scores() += scores;
+    statistics.Prunes() += prunes;
+  }
+  else
+  {
+    RuleType rules(nns->ReferenceTree().Dataset(), dataset, assignments,
+        upperBounds, lowerBounds, metric, prunedPoints, oldFromNewCentroids,
+        visited);
+
+    typename Tree::template BreadthFirstDualTreeTraverser<RuleType>
+        traverser(rules);
+    {
+      tree::TraversalStatistics::PhaseTimer timer(statistics.TraversalTime());
+      traverser.Traverse(*tree, nns->ReferenceTree());
+    }
+    distanceCalculations += rules.BaseCases() + rules.Scores();
+    statistics.AddRules(rules);
+    statistics.AddTraverser(traverser);
+  }
 
   Timer::Start("tree_mod");
   DecoalesceTree(*tree);
@@ -199,8 +372,6 @@ double DualTreeKMeans<MetricType, MatType, TreeType>::Iterate(
   }
   distanceCalculations += centroids.n_cols;
 
-  delete centroidTree;
-
   ++iteration;
 
   return std::sqrt(residual);
@@ -218,6 +389,97 @@ void DualTreeKMeans<MetricType, MatType, TreeType>::UpdateTree(
     const double adjustedParentUpperBound,
     const double parentLowerBound,
     const double adjustedParentLowerBound)
+{
+  double unadjustedUpperBound, adjustedUpperBound, unadjustedLowerBound,
+      adjustedLowerBound;
+  const bool prunedLastIteration = UpdateNodeBounds(node, centroids,
+      parentUpperBound, adjustedParentUpperBound, parentLowerBound,
+      adjustedParentLowerBound, unadjustedUpperBound, adjustedUpperBound,
+      unadjustedLowerBound, adjustedLowerBound);
+
+  for (size_t i = 0; i < node.NumChildren(); ++i)
+  {
+    UpdateTree(node.Child(i), centroids, unadjustedUpperBound,
+        adjustedUpperBound, unadjustedLowerBound, adjustedLowerBound);
+  }
+
+  UpdateNodePoints(node, centroids, prunedLastIteration);
+}
+
+template<typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void DualTreeKMeans<MetricType, MatType, TreeType>::ParallelUpdateTree(
+    const arma::mat& centroids)
+{
+  // The bounds that each ancestor passes to its children.
+  std::unordered_map<const Tree*, size_t> ancestorIndices;
+  arma::mat childBounds(4, ancestors.size());
+  std::vector<char> prunedLastIteration(ancestors.size());
+
+  // Update the ancestors from the top down; the root gets the default bounds.
+  for (size_t i = 0; i < ancestors.size(); ++i)
+  {
+    Tree& node = *ancestors[i];
+    ancestorIndices[&node] = i;
+
+    double parentBounds[4] = { 0.0, DBL_MAX, DBL_MAX, 0.0 };
+    if (node.Parent() != NULL)
+    {
+      const size_t parent = ancestorIndices.at(node.Parent());
+      for (size_t j = 0; j < 4; ++j)
+        parentBounds[j] = childBounds(j, parent);
+    }
+
+    prunedLastIteration[i] = UpdateNodeBounds(node, centroids,
+        parentBounds[0], parentBounds[1], parentBounds[2], parentBounds[3],
+        childBounds(0, i), childBounds(1, i), childBounds(2, i),
+        childBounds(3, i));
+  }
+
+  // Now each subtree can be updated independently: it only touches its own
+  // nodes and points, and reads the bounds of its parent, which is an
+  // ancestor.
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables. If we're building for Visual Studio, use
+  // the intmax_t type instead.
+  #pragma omp parallel for schedule(dynamic)
+  for (intmax_t i = 0; i < (intmax_t) subtrees.size(); ++i)
+#else
+  #pragma omp parallel for schedule(dynamic)
+  for (size_t i = 0; i < subtrees.size(); ++i)
+#endif
+  {
+    const size_t parent = ancestorIndices.at(subtrees[i]->Parent());
+    UpdateTree(*subtrees[i], centroids, childBounds(0, parent),
+        childBounds(1, parent), childBounds(2, parent), childBounds(3, parent));
+  }
+
+  // Finally, update the ancestors from the bottom up, since that depends on
+  // whether their children are pruned.
+  for (size_t i = ancestors.size(); i > 0; --i)
+    UpdateNodePoints(*ancestors[i - 1], centroids, prunedLastIteration[i - 1]);
+}
+
+template<typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+bool DualTreeKMeans<MetricType, MatType, TreeType>::UpdateNodeBounds(
+    Tree& node,
+    const arma::mat& centroids,
+    const double parentUpperBound,
+    const double adjustedParentUpperBound,
+    const double parentLowerBound,
+    const double adjustedParentLowerBound,
+    double& unadjustedUpperBound,
+    double& adjustedUpperBound,
+    double& unadjustedLowerBound,
+    double& adjustedLowerBound)
 {
   const bool prunedLastIteration = node.Stat().StaticPruned();
   node.Stat().StaticPruned() = false;
@@ -236,10 +498,10 @@ void DualTreeKMeans<MetricType, MatType, TreeType>::UpdateTree(
     node.Stat().Pruned() = node.Parent()->Stat().Pruned();
     node.Stat().Owner() = node.Parent()->Stat().Owner();
   }
-  const double unadjustedUpperBound = node.Stat().UpperBound();
-  double adjustedUpperBound = adjustedParentUpperBound;
-  const double unadjustedLowerBound = node.Stat().LowerBound();
-  double adjustedLowerBound = adjustedParentLowerBound;
+  unadjustedUpperBound = node.Stat().UpperBound();
+  adjustedUpperBound = adjustedParentUpperBound;
+  unadjustedLowerBound = node.Stat().LowerBound();
+  adjustedLowerBound = adjustedParentLowerBound;
 
   // Exhaustive lower bound check. Sigh.
 /*
@@ -328,6 +590,7 @@ visited[node.Descendant(i)] << ".\n";
                    node.MaxDistance(centroids.col(node.Stat().Owner())));
       adjustedUpperBound = node.Stat().UpperBound();
 
+      #pragma omp atomic
       ++distanceCalculations;
       if (node.Stat().UpperBound() < node.Stat().LowerBound())
         node.Stat().StaticPruned() = true;
@@ -338,13 +601,24 @@ visited[node.Descendant(i)] << ".\n";
     node.Stat().LowerBound() -= clusterDistances[centroids.n_cols];
   }
 
-  // Recurse into children, and if all the children (and all the points) are
-  // pruned, then we can mark this as statically pruned.
+  return prunedLastIteration;
+}
+
+template<typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void DualTreeKMeans<MetricType, MatType, TreeType>::UpdateNodePoints(
+    Tree& node,
+    const arma::mat& centroids,
+    const bool prunedLastIteration)
+{
+  // If all the children (and all the points) are pruned, then we can mark this
+  // as statically pruned.
   bool allChildrenPruned = true;
   for (size_t i = 0; i < node.NumChildren(); ++i)
   {
-    UpdateTree(node.Child(i), centroids, unadjustedUpperBound,
-        adjustedUpperBound, unadjustedLowerBound, adjustedLowerBound);
     if (!node.Child(i).Stat().StaticPruned())
       allChildrenPruned = false;
   }
@@ -400,6 +674,7 @@ visited[node.Descendant(i)] << ".\n";
         // Attempt to tighten the bound.
         upperBounds[index] = metric.Evaluate(dataset.col(index),
                                              centroids.col(owner));
+        #pragma omp atomic
         ++distanceCalculations;
         if (upperBounds[index] < pruningLowerBound)
         {
@@ -613,6 +888,78 @@ void DualTreeKMeans<MetricType, MatType, TreeType>::CoalesceTree(
   }
 }
 
+template<typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void DualTreeKMeans<MetricType, MatType, TreeType>::ParallelCoalesceTree()
+{
+  // Find the index of each node among the children of its parent before
+  // anything is changed.
+  auto childIndex = [](const Tree& node)
+  {
+    size_t i = 0;
+    while (&node.Parent()->Child(i) != &node)
+      ++i;
+    return i;
+  };
+
+  std::vector<size_t> subtreeIndices(subtrees.size());
+  for (size_t i = 0; i < subtrees.size(); ++i)
+    subtreeIndices[i] = childIndex(*subtrees[i]);
+
+  std::vector<size_t> ancestorIndices(ancestors.size(), 0);
+  for (size_t i = 0; i < ancestors.size(); ++i)
+    if (ancestors[i]->Parent() != NULL)
+      ancestorIndices[i] = childIndex(*ancestors[i]);
+
+  // First coalesce each subtree.  This only changes the nodes of the subtree,
+  // and the pointer to the subtree in its parent; the subtrees of one parent
+  // change different pointers.  Pruned subtrees are coalesced too, which is
+  // unnecessary but harmless, since their parents hide them afterwards.
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables. If we're building for Visual Studio, use
+  // the intmax_t type instead.
+  #pragma omp parallel for schedule(dynamic)
+  for (intmax_t i = 0; i < (intmax_t) subtrees.size(); ++i)
+#else
+  #pragma omp parallel for schedule(dynamic)
+  for (size_t i = 0; i < subtrees.size(); ++i)
+#endif
+  {
+    CoalesceTree(*subtrees[i], subtreeIndices[i]);
+  }
+
+  // Now coalesce the ancestors from the bottom up, like CoalesceTree() does
+  // after it has coalesced the children.  Whether a child is pruned is taken
+  // from the true child, since the child may have been replaced by its only
+  // remaining child already.
+  for (size_t a = ancestors.size(); a > 0; --a)
+  {
+    Tree& node = *ancestors[a - 1];
+
+    // We can't coalesce the root.
+    if (node.Parent() == NULL)
+      continue;
+
+    const size_t child = ancestorIndices[a - 1];
+    for (size_t i = node.NumChildren() - 1; i > 0; --i)
+      if (((Tree*) node.Stat().TrueChild(i))->Stat().StaticPruned())
+        HideChild(node, i);
+
+    if (((Tree*) node.Stat().TrueChild(0))->Stat().StaticPruned())
+      HideChild(node, 0);
+
+    if (node.NumChildren() == 1)
+    {
+      node.Child(0).Parent() = node.Parent();
+      node.Parent()->ChildPtr(child) = node.ChildPtr(0);
+    }
+  }
+}
+
 template<typename MetricType,
          typename MatType,
          template<typename TreeMetricType,
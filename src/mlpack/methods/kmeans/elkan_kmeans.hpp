@@ -38,6 +38,12 @@ class ElkanKMeans
 
   size_t DistanceCalculations() const { return distanceCalculations; }
 
+  //! Get the cluster of each point, as of the last iteration.
+  const arma::Col<size_t>& Assignments() const { return assignments; }
+  //! Get the sum of the squared norms of the points of each cluster, as of the
+  //! last iteration.
+  const arma::vec& SquaredNormSums() const { return squaredNormSums; }
+
  private:
   //! The dataset.
   const MatType& dataset;
@@ -57,6 +63,11 @@ class ElkanKMeans
   //! Lower bounds on the distance between each point and each cluster.
   arma::mat lowerBounds;
 
+  //! Squared norm of each point.
+  arma::vec squaredNorms;
+  //! Sum of the squared norms of the points of each cluster.
+  arma::vec squaredNormSums;
+
   //! Track distance calculations.
   size_t distanceCalculations;
 };
@@ -37,6 +37,13 @@ double ElkanKMeans<MetricType, MatType>::Iterate(const arma::mat& centroids,
   // Clear new centroids.
   newCentroids.zeros(centroids.n_rows, centroids.n_cols);
   counts.zeros(centroids.n_cols);
+  squaredNormSums.zeros(centroids.n_cols);
+
+  // The squared norms of the points are computed once.  Their sums over each
+  // cluster give the variances of the clusters, if the empty cluster policy
+  // needs them.
+  if (squaredNorms.n_elem != dataset.n_cols)
+    squaredNorms = arma::vec(arma::sum(arma::square(dataset)).t());
 
   // At the beginning of the iteration, we must compute the distances between
   // all centers.  This is O(k^2).
@@ -46,10 +53,10 @@ double ElkanKMeans<MetricType, MatType>::Iterate(const arma::mat& centroids,
   // being the closest cluster centroid.
   clusterDistances.diag().fill(DBL_MAX);
 
-  // Initially set r(x) to true.
-  std::vector<bool> mustRecalculate(dataset.n_cols, true);
-
-  // If this is the first iteration, we must reset all the bounds.
+  // If this is the first iteration, we must reset all the bounds.  The lower
+  // bounds of each point are held in one column, so the bounds of different
+  // points never share a cache line except at the edges of the blocks of points
+  // handled by each thread.
   if (lowerBounds.n_rows != centroids.n_cols)
   {
     lowerBounds.set_size(centroids.n_cols, dataset.n_cols);
@@ -61,15 +68,44 @@ double ElkanKMeans<MetricType, MatType>::Iterate(const arma::mat& centroids,
     assignments.fill(0);
   }
 
+#ifdef HAS_OPENMP
+  const size_t numThreads = omp_get_max_threads();
+#else
+  const size_t numThreads = 1;
+#endif
+
+  // The first thread accumulates its points into newCentroids and counts, and
+  // every other thread into its own sums and counts, which are added together
+  // afterwards.
+  std::vector<arma::mat> threadCentroids(numThreads - 1,
+      arma::mat(centroids.n_rows, centroids.n_cols, arma::fill::zeros));
+  std::vector<arma::Col<size_t>> threadCounts(numThreads - 1,
+      arma::Col<size_t>(centroids.n_cols, arma::fill::zeros));
+  std::vector<arma::vec> threadSquaredNormSums(numThreads - 1,
+      arma::vec(centroids.n_cols, arma::fill::zeros));
+
+  size_t calculations = 0;
+
   // Step 1: for all centers, compute between-cluster distances.  For all
   // centers, compute s(c) = 1/2 min d(c, c').
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables. If we're building for Visual Studio, use
+  // the intmax_t type instead.
+  #pragma omp parallel for schedule(dynamic) num_threads(numThreads) \
+      reduction(+:calculations)
+  for (intmax_t i = 0; i < (intmax_t) centroids.n_cols; ++i)
+#else
+  #pragma omp parallel for schedule(dynamic) num_threads(numThreads) \
+      reduction(+:calculations)
   for (size_t i = 0; i < centroids.n_cols; ++i)
+#endif
   {
     for (size_t j = i + 1; j < centroids.n_cols; ++j)
     {
       const double distance = metric.Evaluate(centroids.col(i),
                                               centroids.col(j));
-      distanceCalculations++;
+      calculations++;
       clusterDistances(i, j) = distance;
       clusterDistances(j, i) = distance;
     }
@@ -79,23 +115,46 @@ double ElkanKMeans<MetricType, MatType>::Iterate(const arma::mat& centroids,
   // that this is equivalent to s(c) for each cluster c.
   minClusterDistances = 0.5 * arma::min(clusterDistances).t();
 
-  // Now loop over all points, and see which ones need to be updated.
-  for (size_t i = 0; i < dataset.n_cols; ++i)
+  // Now loop over all points, and see which ones need to be updated.  Each
+  // thread handles one contiguous block of points.
+  #pragma omp parallel num_threads(numThreads) reduction(+:calculations)
   {
-    // Step 2: identify all points such that u(x) <= s(c(x)).
-    if (upperBounds(i) <= minClusterDistances(assignments[i]))
-    {
-      // No change needed.  This point must still belong to that cluster.
-      counts(assignments[i])++;
-      newCentroids.col(assignments[i]) += arma::vec(dataset.col(i));
-      continue;
-    }
-    else
+#ifdef HAS_OPENMP
+    const size_t thread = omp_get_thread_num();
+#else
+    const size_t thread = 0;
+#endif
+    arma::mat& localCentroids = (thread == 0) ? newCentroids :
+        threadCentroids[thread - 1];
+    arma::Col<size_t>& localCounts = (thread == 0) ? counts :
+        threadCounts[thread - 1];
+    arma::vec& localSquaredNormSums = (thread == 0) ? squaredNormSums :
+        threadSquaredNormSums[thread - 1];
+
+#ifdef _WIN32
+    #pragma omp for schedule(static)
+    for (intmax_t i = 0; i < (intmax_t) dataset.n_cols; ++i)
+#else
+    #pragma omp for schedule(static)
+    for (size_t i = 0; i < dataset.n_cols; ++i)
+#endif
     {
+      // Step 2: identify all points such that u(x) <= s(c(x)).
+      if (upperBounds(i) <= minClusterDistances(assignments[i]))
+      {
+        // No change needed.  This point must still belong to that cluster.
+        localCounts(assignments[i])++;
+        localCentroids.col(assignments[i]) += arma::vec(dataset.col(i));
+        localSquaredNormSums[assignments[i]] += squaredNorms[i];
+        continue;
+      }
+
+      // Initially set r(x) to true.
+      bool mustRecalculate = true;
       for (size_t c = 0; c < centroids.n_cols; ++c)
       {
-        // Step 3: for all remaining points x and centers c such that c != c(x),
-        // u(x) > l(x, c) and u(x) > 0.5 d(c(x), c)...
+        // Step 3: for all remaining points x and centers c such that
+        // c != c(x), u(x) > l(x, c) and u(x) > 0.5 d(c(x), c)...
         if (assignments[i] == c)
           continue; // Pruned because this cluster is already the assignment.
 
@@ -108,13 +167,13 @@ double ElkanKMeans<MetricType, MatType>::Iterate(const arma::mat& centroids,
         // Step 3a: if r(x) then compute d(x, c(x)) and assign r(x) = false.
         // Otherwise, d(x, c(x)) = u(x).
         double dist;
-        if (mustRecalculate[i])
+        if (mustRecalculate)
         {
-          mustRecalculate[i] = false;
+          mustRecalculate = false;
           dist = metric.Evaluate(dataset.col(i), centroids.col(assignments[i]));
           lowerBounds(assignments[i], i) = dist;
           upperBounds(i) = dist;
-          distanceCalculations++;
+          calculations++;
 
           // Check if we can prune again.
           if (upperBounds(i) <= lowerBounds(c, i))
@@ -136,7 +195,7 @@ double ElkanKMeans<MetricType, MatType>::Iterate(const arma::mat& centroids,
           const double pointDist = metric.Evaluate(dataset.col(i),
                                                    centroids.col(c));
           lowerBounds(c, i) = pointDist;
-          distanceCalculations++;
+          calculations++;
           if (pointDist < dist)
           {
             upperBounds(i) = pointDist;
@@ -144,13 +203,23 @@ double ElkanKMeans<MetricType, MatType>::Iterate(const arma::mat& centroids,
           }
         }
       }
+
+      // At this point, we know the new cluster assignment.
+      // Step 4: for each center c, let m(c) be the mean of the points assigned
+      // to c.
+      localCentroids.col(assignments[i]) += arma::vec(dataset.col(i));
+      localCounts[assignments[i]]++;
+      localSquaredNormSums[assignments[i]] += squaredNorms[i];
     }
+  }
 
-    // At this point, we know the new cluster assignment.
-    // Step 4: for each center c, let m(c) be the mean of the points assigned to
-    // c.
-    newCentroids.col(assignments[i]) += arma::vec(dataset.col(i));
-    counts[assignments[i]]++;
+  // Add the sums and counts of the other threads, in a fixed order so that the
+  // result doesn't depend on the scheduling.
+  for (size_t t = 0; t < threadCentroids.size(); ++t)
+  {
+    newCentroids += threadCentroids[t];
+    counts += threadCounts[t];
+    squaredNormSums += threadSquaredNormSums[t];
   }
 
   // Now, normalize and calculate the distance each cluster has moved.
@@ -163,10 +232,18 @@ double ElkanKMeans<MetricType, MatType>::Iterate(const arma::mat& centroids,
 
     moveDistances(c) = metric.Evaluate(newCentroids.col(c), centroids.col(c));
     cNorm += std::pow(moveDistances(c), 2.0);
-    distanceCalculations++;
+    calculations++;
   }
 
+  distanceCalculations += calculations;
+
+#ifdef _WIN32
+  #pragma omp parallel for schedule(static) num_threads(numThreads)
+  for (intmax_t i = 0; i < (intmax_t) dataset.n_cols; ++i)
+#else
+  #pragma omp parallel for schedule(static) num_threads(numThreads)
   for (size_t i = 0; i < dataset.n_cols; ++i)
+#endif
   {
     // Step 5: for each point x and center c, assign
     //   l(x, c) = max { l(x, c) - d(c, m(c)), 0 }.
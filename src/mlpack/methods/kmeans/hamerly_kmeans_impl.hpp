@@ -34,8 +34,12 @@ double HamerlyKMeans<MetricType, MatType>::Iterate(const arma::mat& centroids,
                                                    arma::Col<size_t>& counts)
 {
   size_t hamerlyPruned = 0;
+  size_t calculations = 0;
 
-  // If this is the first iteration, we need to set all the bounds.
+  // If this is the first iteration, we need to set all the bounds.  The bounds
+  // and assignments are held in contiguous vectors, and each thread updates one
+  // contiguous block of points, so threads only share cache lines at the edges
+  // of their blocks.
   if (minClusterDistances.n_elem != centroids.n_cols)
   {
     upperBounds.set_size(dataset.n_cols);
@@ -48,6 +52,29 @@ double HamerlyKMeans<MetricType, MatType>::Iterate(const arma::mat& centroids,
   // Reset new centroids.
   newCentroids.zeros(centroids.n_rows, centroids.n_cols);
   counts.zeros(centroids.n_cols);
+  squaredNormSums.zeros(centroids.n_cols);
+
+  // The squared norms of the points are computed once.  Their sums over each
+  // cluster give the variances of the clusters, if the empty cluster policy
+  // needs them.
+  if (squaredNorms.n_elem != dataset.n_cols)
+    squaredNorms = arma::vec(arma::sum(arma::square(dataset)).t());
+
+#ifdef HAS_OPENMP
+  const size_t numThreads = omp_get_max_threads();
+#else
+  const size_t numThreads = 1;
+#endif
+
+  // The first thread accumulates its points into newCentroids and counts, and
+  // every other thread into its own sums and counts, which are added together
+  // afterwards.
+  std::vector<arma::mat> threadCentroids(numThreads - 1,
+      arma::mat(centroids.n_rows, centroids.n_cols, arma::fill::zeros));
+  std::vector<arma::Col<size_t>> threadCounts(numThreads - 1,
+      arma::Col<size_t>(centroids.n_cols, arma::fill::zeros));
+  std::vector<arma::vec> threadSquaredNormSums(numThreads - 1,
+      arma::vec(centroids.n_cols, arma::fill::zeros));
 
   // Calculate minimum intra-cluster distance for each cluster.
   minClusterDistances.fill(DBL_MAX);
@@ -57,7 +84,7 @@ double HamerlyKMeans<MetricType, MatType>::Iterate(const arma::mat& centroids,
     {
       const double dist = metric.Evaluate(centroids.col(i), centroids.col(j)) /
           2.0;
-      ++distanceCalculations;
+      ++calculations;
 
       // Update bounds, if this intra-cluster distance is smaller.
       if (dist < minClusterDistances(i))
@@ -67,63 +94,101 @@ double HamerlyKMeans<MetricType, MatType>::Iterate(const arma::mat& centroids,
     }
   }
 
-  for (size_t i = 0; i < dataset.n_cols; ++i)
+  #pragma omp parallel num_threads(numThreads) \
+      reduction(+:hamerlyPruned, calculations)
   {
-    const double m = std::max(minClusterDistances(assignments[i]),
-                              lowerBounds(i));
-
-    // First bound test.
-    if (upperBounds(i) <= m)
-    {
-      ++hamerlyPruned;
-      newCentroids.col(assignments[i]) += dataset.col(i);
-      ++counts(assignments[i]);
-      continue;
-    }
-
-    // Tighten upper bound.
-    upperBounds(i) = metric.Evaluate(dataset.col(i),
-                                     centroids.col(assignments[i]));
-    ++distanceCalculations;
-
-    // Second bound test.
-    if (upperBounds(i) <= m)
+#ifdef HAS_OPENMP
+    const size_t thread = omp_get_thread_num();
+#else
+    const size_t thread = 0;
+#endif
+    arma::mat& localCentroids = (thread == 0) ? newCentroids :
+        threadCentroids[thread - 1];
+    arma::Col<size_t>& localCounts = (thread == 0) ? counts :
+        threadCounts[thread - 1];
+    arma::vec& localSquaredNormSums = (thread == 0) ? squaredNormSums :
+        threadSquaredNormSums[thread - 1];
+
+#ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables. If we're building for Visual Studio,
+    // use the intmax_t type instead.
+    #pragma omp for schedule(static)
+    for (intmax_t i = 0; i < (intmax_t) dataset.n_cols; ++i)
+#else
+    #pragma omp for schedule(static)
+    for (size_t i = 0; i < dataset.n_cols; ++i)
+#endif
     {
-      newCentroids.col(assignments[i]) += dataset.col(i);
-      ++counts(assignments[i]);
-      continue;
-    }
+      const double m = std::max(minClusterDistances(assignments[i]),
+                                lowerBounds(i));
 
-    // The bounds failed.  So test against all other clusters.
-    // This is Hamerly's Point-All-Ctrs() function from the paper.
-    // We have to reset the lower bound first.
-    lowerBounds(i) = DBL_MAX;
-    for (size_t c = 0; c < centroids.n_cols; ++c)
-    {
-      if (c == assignments[i])
+      // First bound test.
+      if (upperBounds(i) <= m)
+      {
+        ++hamerlyPruned;
+        localCentroids.col(assignments[i]) += dataset.col(i);
+        ++localCounts(assignments[i]);
+        localSquaredNormSums[assignments[i]] += squaredNorms[i];
         continue;
+      }
 
-      const double dist = metric.Evaluate(dataset.col(i), centroids.col(c));
+      // Tighten upper bound.
+      upperBounds(i) = metric.Evaluate(dataset.col(i),
+                                       centroids.col(assignments[i]));
+      ++calculations;
 
-      // Is this a better cluster?  At this point, upperBounds[i] = d(i, c(i)).
-      if (dist < upperBounds(i))
+      // Second bound test.
+      if (upperBounds(i) <= m)
       {
-        // lowerBounds holds the second closest cluster.
-        lowerBounds(i) = upperBounds(i);
-        upperBounds(i) = dist;
-        assignments[i] = c;
+        localCentroids.col(assignments[i]) += dataset.col(i);
+        ++localCounts(assignments[i]);
+        localSquaredNormSums[assignments[i]] += squaredNorms[i];
+        continue;
       }
-      else if (dist < lowerBounds(i))
+
+      // The bounds failed.  So test against all other clusters.
+      // This is Hamerly's Point-All-Ctrs() function from the paper.
+      // We have to reset the lower bound first.
+      lowerBounds(i) = DBL_MAX;
+      for (size_t c = 0; c < centroids.n_cols; ++c)
       {
-        // This is a closer second-closest cluster.
-        lowerBounds(i) = dist;
+        if (c == assignments[i])
+          continue;
+
+        const double dist = metric.Evaluate(dataset.col(i), centroids.col(c));
+
+        // Is this a better cluster?  At this point, upperBounds[i] =
+        // d(i, c(i)).
+        if (dist < upperBounds(i))
+        {
+          // lowerBounds holds the second closest cluster.
+          lowerBounds(i) = upperBounds(i);
+          upperBounds(i) = dist;
+          assignments[i] = c;
+        }
+        else if (dist < lowerBounds(i))
+        {
+          // This is a closer second-closest cluster.
+          lowerBounds(i) = dist;
+        }
       }
+      calculations += centroids.n_cols - 1;
+
+      // Update new centroids.
+      localCentroids.col(assignments[i]) += dataset.col(i);
+      ++localCounts(assignments[i]);
+      localSquaredNormSums[assignments[i]] += squaredNorms[i];
     }
-    distanceCalculations += centroids.n_cols - 1;
+  }
 
-    // Update new centroids.
-    newCentroids.col(assignments[i]) += dataset.col(i);
-    ++counts(assignments[i]);
+  // Add the sums and counts of the other threads, in a fixed order so that the
+  // result doesn't depend on the scheduling.
+  for (size_t t = 0; t < threadCentroids.size(); ++t)
+  {
+    newCentroids += threadCentroids[t];
+    counts += threadCounts[t];
+    squaredNormSums += threadSquaredNormSums[t];
   }
 
   // Normalize centroids and calculate cluster movement (contains parts of
@@ -143,7 +208,7 @@ double HamerlyKMeans<MetricType, MatType>::Iterate(const arma::mat& centroids,
                                             newCentroids.col(c));
     centroidMovements(c) = movement;
     centroidMovement += std::pow(movement, 2.0);
-    ++distanceCalculations;
+    ++calculations;
 
     if (movement > furthestMovement)
     {
@@ -157,8 +222,16 @@ double HamerlyKMeans<MetricType, MatType>::Iterate(const arma::mat& centroids,
     }
   }
 
+  distanceCalculations += calculations;
+
   // Now update bounds (lines 3-8 of Update-Bounds()).
+#ifdef _WIN32
+  #pragma omp parallel for schedule(static) num_threads(numThreads)
+  for (intmax_t i = 0; i < (intmax_t) dataset.n_cols; ++i)
+#else
+  #pragma omp parallel for schedule(static) num_threads(numThreads)
   for (size_t i = 0; i < dataset.n_cols; ++i)
+#endif
   {
     upperBounds(i) += centroidMovements(assignments[i]);
     if (assignments[i] == furthestMovingCluster)
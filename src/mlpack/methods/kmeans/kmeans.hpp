@@ -155,6 +155,31 @@ class KMeans
                const bool initialAssignmentGuess = false,
                const bool initialCentroidGuess = false);
 
+  /**
+   * Perform k-means clustering on the data the given number of times, from
+   * different initial partitions, and keep the clustering with the lowest
+   * objective (the sum of squared distances between the points and their
+   * centroids).  The restarts are run in parallel when OpenMP is available.
+   * They share the dataset, and each has its own copy of the policies and its
+   * own random stream (see math::TaskRandomStream()), so the result depends on
+   * the random seed but not on the number of threads.
+   *
+   * @tparam MatType Type of matrix (arma::mat or arma::sp_mat).
+   * @param data Dataset to cluster.
+   * @param clusters Number of clusters to compute.
+   * @param restarts Number of times to run k-means.
+   * @param assignments Vector to store the cluster assignments of the best
+   *      clustering in.
+   * @param centroids Matrix in which the centroids of the best clustering are
+   *      stored.
+   * @return The objective of the best clustering.
+   */
+  double Cluster(const MatType& data,
+                 const size_t clusters,
+                 const size_t restarts,
+                 arma::Row<size_t>& assignments,
+                 arma::mat& centroids);
+
   //! Get the maximum number of iterations.
   size_t MaxIterations() const { return maxIterations; }
   //! Set the maximum number of iterations.
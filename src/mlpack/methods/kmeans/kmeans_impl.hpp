@@ -12,6 +12,7 @@
  */
 #include "kmeans.hpp"
 
+#include <mlpack/core/math/random.hpp>
 #include <mlpack/core/metrics/lmetric.hpp>
 #include <mlpack/core/util/sfinae_utility.hpp>
 
@@ -78,6 +79,51 @@ bool GetInitialAssignmentsOrCentroids(
   return false;
 }
 
+HAS_MEM_FUNC(SquaredNormSums, HasSquaredNormSumsCheck);
+HAS_MEM_FUNC(ClusterStatistics, TakesClusterStatisticsCheck);
+
+/**
+ * 'value' is true if the LloydStepType keeps the assignments of the points and
+ * the sums of the squared norms of the points of each cluster, and the
+ * EmptyClusterPolicy can use them.
+ */
+template<typename LloydStepType, typename EmptyClusterPolicy>
+struct SharesClusterStatistics
+{
+  static const bool value =
+    HasSquaredNormSumsCheck<LloydStepType,
+        const arma::vec&(LloydStepType::*)() const>::value &&
+    TakesClusterStatisticsCheck<EmptyClusterPolicy,
+        void(EmptyClusterPolicy::*)(const arma::Col<size_t>&,
+                                    const arma::vec&,
+                                    const size_t)>::value;
+};
+
+//! Give the cluster statistics of the Lloyd step to the empty cluster policy,
+//! if they can be shared.
+template<typename LloydStepType, typename EmptyClusterPolicy>
+void GiveClusterStatistics(
+    const LloydStepType& lloydStep,
+    EmptyClusterPolicy& emptyClusterAction,
+    const size_t iteration,
+    const typename std::enable_if_t<
+        SharesClusterStatistics<LloydStepType, EmptyClusterPolicy>::value>* = 0)
+{
+  emptyClusterAction.ClusterStatistics(lloydStep.Assignments(),
+      lloydStep.SquaredNormSums(), iteration);
+}
+
+//! Nothing to do if the cluster statistics can't be shared.
+template<typename LloydStepType, typename EmptyClusterPolicy>
+void GiveClusterStatistics(
+    const LloydStepType& /* lloydStep */,
+    EmptyClusterPolicy& /* emptyClusterAction */,
+    const size_t /* iteration */,
+    const typename std::enable_if_t<
+        !SharesClusterStatistics<LloydStepType, EmptyClusterPolicy>::value>* =
+        0)
+{ }
+
 /**
  * Construct the K-Means object.
  */
@@ -221,7 +267,10 @@ Cluster(const MatType& data,
       cNorm = lloydStep.Iterate(centroidsOther, centroids, counts);
 
     // If we are not allowing empty clusters, then check that all of our
-    // clusters have points.
+    // clusters have points.  The empty cluster policy may use what the Lloyd
+    // step knows about the clusters, instead of scanning the dataset again.
+    if (clusters > 0 && counts.min() == 0)
+      GiveClusterStatistics(lloydStep, emptyClusterAction, iteration);
     for (size_t i = 0; i < clusters; i++)
     {
       if (counts[i] == 0)
@@ -335,6 +384,78 @@ Cluster(const MatType& data,
   }
 }
 
+/**
+ * Perform k-means clustering on the data several times, and keep the best
+ * clustering.
+ */
+template<typename MetricType,
+         typename InitialPartitionPolicy,
+         typename EmptyClusterPolicy,
+         template<class, class> class LloydStepType,
+         typename MatType>
+double KMeans<
+    MetricType,
+    InitialPartitionPolicy,
+    EmptyClusterPolicy,
+    LloydStepType,
+    MatType>::
+Cluster(const MatType& data,
+        const size_t clusters,
+        const size_t restarts,
+        arma::Row<size_t>& assignments,
+        arma::mat& centroids)
+{
+  if (restarts == 0)
+    Log::Fatal << "KMeans::Cluster(): the number of restarts must be greater "
+        << "than 0!" << std::endl;
+
+  std::vector<arma::Row<size_t>> restartAssignments(restarts);
+  std::vector<arma::mat> restartCentroids(restarts);
+  arma::vec objectives(restarts);
+
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables. If we're building for Visual Studio, use
+  // the intmax_t type instead.
+  #pragma omp parallel for schedule(dynamic)
+  for (intmax_t r = 0; r < (intmax_t) restarts; ++r)
+#else
+  #pragma omp parallel for schedule(dynamic)
+  for (size_t r = 0; r < restarts; ++r)
+#endif
+  {
+    // Each restart draws its initial partition from its own random stream,
+    // and has its own copy of the policies, which may keep state.
+    math::TaskRandomStreamScope scope(r);
+    KMeans restart(*this);
+    restart.Cluster(data, clusters, restartAssignments[r],
+        restartCentroids[r]);
+
+    double objective = 0.0;
+    for (size_t i = 0; i < data.n_cols; ++i)
+    {
+      objective += std::pow(restart.Metric().Evaluate(data.col(i),
+          restartCentroids[r].col(restartAssignments[r][i])), 2.0);
+    }
+    objectives[r] = objective;
+  }
+
+  // Ties go to the first restart, so the choice doesn't depend on the
+  // scheduling either.
+  size_t best = 0;
+  for (size_t r = 0; r < restarts; ++r)
+  {
+    Log::Info << "KMeans::Cluster(): objective of restart " << r << " is "
+        << objectives[r] << "." << std::endl;
+    if (objectives[r] < objectives[best])
+      best = r;
+  }
+
+  assignments = std::move(restartAssignments[best]);
+  centroids = std::move(restartCentroids[best]);
+  return objectives[best];
+}
+
 template<typename MetricType,
          typename InitialPartitionPolicy,
          typename EmptyClusterPolicy,
@@ -16,8 +16,13 @@
 #include "allow_empty_clusters.hpp"
 #include "kill_empty_clusters.hpp"
 #include "refined_start.hpp"
+#include "kmeans_plus_plus_initialization.hpp"
+#include "kmeans_parallel_initialization.hpp"
 #include "elkan_kmeans.hpp"
 #include "hamerly_kmeans.hpp"
+#include "yinyang_kmeans.hpp"
+#include "blocked_kmeans.hpp"
+#include "mini_batch_kmeans.hpp"
 #include "pelleg_moore_kmeans.hpp"
 #include "dual_tree_kmeans.hpp"
 
@@ -41,13 +46,39 @@ PROGRAM_INFO("K-Means Clustering", "This program performs K-Means clustering "
     "to be used in each sample, the --percentage parameter is used (it should "
     "be a value between 0.0 and 1.0)."
     "\n\n"
+    "The k-means++ seeding (\"k-means++: The advantages of careful seeding\", "
+    "2007) can be used with the --kmeans_plus_plus (-K) option, and its "
+    "scalable variant k-means|| (\"Scalable k-means++\", 2012) with the "
+    "--kmeans_parallel (-L) option.  k-means|| needs far fewer passes over the "
+    "dataset; the number of oversampling rounds is given with --rounds, and "
+    "the number of candidates taken in each round (as a multiple of the number "
+    "of clusters) with --oversampling.  Both often reduce the number of Lloyd "
+    "iterations considerably."
+    "\n\n"
     "There are several options available for the algorithm used for each Lloyd "
     "iteration, specified with the --algorithm (-a) option.  The standard O(kN)"
     " approach can be used ('naive').  Other options include the Pelleg-Moore "
     "tree-based algorithm ('pelleg-moore'), Elkan's triangle-inequality based "
     "algorithm ('elkan'), Hamerly's modification to Elkan's algorithm "
-    "('hamerly'), the dual-tree k-means algorithm ('dualtree'), and the "
-    "dual-tree k-means algorithm using the cover tree ('dualtree-covertree')."
+    "('hamerly'), the Yinyang algorithm, which keeps bounds for groups of "
+    "centroids ('yinyang'), the dual-tree k-means algorithm ('dualtree'), the "
+    "dual-tree k-means algorithm using the cover tree ('dualtree-covertree'), "
+    "and the naive approach with distances computed as blocked matrix "
+    "multiplications ('blocked'), which is fastest for high-dimensional data."
+    "\n\n"
+    "With --restarts, k-means is run the given number of times from different "
+    "initial partitions (in parallel when mlpack is built with OpenMP), and "
+    "the clustering with the lowest sum of squared distances between the "
+    "points and their centroids is kept.  The result only depends on --seed, "
+    "not on the number of threads."
+    "\n\n"
+    "Mini-batch k-means (Sculley, \"Web-scale k-means clustering\", 2010) can "
+    "be used with '--algorithm mini-batch'.  Instead of full Lloyd iterations, "
+    "each iteration moves the centroids towards a random batch of points, "
+    "whose size is given with the --batch_size (-b) option, and "
+    "--max_iterations gives the number of batches.  This is much faster for "
+    "very large datasets, but the clustering is only approximate.  The empty "
+    "cluster options are ignored for mini-batch k-means."
     "\n\n"
     "The behavior for when an empty cluster is encountered can be modified with"
     " the --allow_empty_clusters (-e) option.  When this option is specified "
@@ -86,6 +117,9 @@ PARAM_FLAG("labels_only", "Only output labels into output file.", "l");
 PARAM_INT_IN("max_iterations", "Maximum number of iterations before k-means "
     "terminates.", "m", 1000);
 PARAM_INT_IN("seed", "Random seed.  If 0, 'std::time(NULL)' is used.", "s", 0);
+PARAM_INT_IN("restarts", "Number of times to run k-means from different "
+    "initial partitions; the clustering with the lowest sum of squared "
+    "distances is kept.", "", 1);
 PARAM_MATRIX_IN("initial_centroids", "Start with the specified initial "
     "centroids.", "I");
 
@@ -97,9 +131,22 @@ PARAM_INT_IN("samplings", "Number of samplings to perform for refined start "
 PARAM_DOUBLE_IN("percentage", "Percentage of dataset to use for each refined "
     "start sampling (use when --refined_start is specified).", "p", 0.02);
 
+// Parameters for k-means++ and k-means|| initialization.
+PARAM_FLAG("kmeans_plus_plus", "Use the k-means++ seeding to choose initial "
+    "points.", "K");
+PARAM_FLAG("kmeans_parallel", "Use the k-means|| seeding to choose initial "
+    "points.", "L");
+PARAM_DOUBLE_IN("oversampling", "Expected number of candidates in each "
+    "k-means|| round, as a multiple of the number of clusters (use when "
+    "--kmeans_parallel is specified).", "O", 2.0);
+PARAM_INT_IN("rounds", "Number of k-means|| oversampling rounds (use when "
+    "--kmeans_parallel is specified).", "R", 5);
+
 PARAM_STRING_IN("algorithm", "Algorithm to use for the Lloyd iteration "
-    "('naive', 'pelleg-moore', 'elkan', 'hamerly', 'dualtree', or "
-    "'dualtree-covertree').", "a", "naive");
+    "('naive', 'pelleg-moore', 'elkan', 'hamerly', 'yinyang', 'dualtree', "
+    "'dualtree-covertree', 'blocked', or 'mini-batch').", "a", "naive");
+PARAM_INT_IN("batch_size", "Number of points in each batch (use when "
+    "--algorithm mini-batch is specified).", "b", 1000);
 
 // Given the type of initial partition policy, figure out the empty cluster
 // policy and run k-means.
@@ -117,6 +164,23 @@ template<typename InitialPartitionPolicy,
          template<class, class> class LloydStepType>
 void RunKMeans(const InitialPartitionPolicy& ipp);
 
+// Given the initial partition policy, sanitize/load input and run mini-batch
+// k-means.
+template<typename InitialPartitionPolicy>
+void RunMiniBatchKMeans(const InitialPartitionPolicy& ipp);
+
+// Sanitize the options and load the dataset and the initial centroids (if
+// given).  Returns whether initial centroids were given.
+bool LoadInput(size_t& clusters,
+               size_t& maxIterations,
+               arma::mat& dataset,
+               arma::mat& centroids);
+
+// Save the assignments (if requested) and the centroids (if requested).
+void SaveResults(arma::mat& dataset,
+                 arma::Row<size_t>& assignments,
+                 arma::mat& centroids);
+
 int main(int argc, char** argv)
 {
   CLI::ParseCommandLine(argc, argv);
@@ -130,6 +194,13 @@ int main(int argc, char** argv)
   // Now, start building the KMeans type that we'll be using.  Start with the
   // initial partition policy.  The call to FindEmptyClusterPolicy<> results in
   // a call to RunKMeans<> and the algorithm is completed.
+  if (CLI::HasParam("refined_start") + CLI::HasParam("kmeans_plus_plus") +
+      CLI::HasParam("kmeans_parallel") > 1)
+  {
+    Log::Fatal << "Only one of --refined_start (-r), --kmeans_plus_plus (-K), "
+        << "and --kmeans_parallel (-L) may be specified!" << endl;
+  }
+
   if (CLI::HasParam("refined_start"))
   {
     const int samplings = CLI::GetParam<int>("samplings");
@@ -144,6 +215,26 @@ int main(int argc, char** argv)
 
     FindEmptyClusterPolicy<RefinedStart>(RefinedStart(samplings, percentage));
   }
+  else if (CLI::HasParam("kmeans_plus_plus"))
+  {
+    FindEmptyClusterPolicy<KMeansPlusPlusInitialization>(
+        KMeansPlusPlusInitialization());
+  }
+  else if (CLI::HasParam("kmeans_parallel"))
+  {
+    const double oversampling = CLI::GetParam<double>("oversampling");
+    const int rounds = CLI::GetParam<int>("rounds");
+
+    if (oversampling <= 0.0)
+      Log::Fatal << "Oversampling factor (" << oversampling << ") must be "
+          << "greater than 0.0!" << endl;
+    if (rounds < 0)
+      Log::Fatal << "Number of rounds (" << rounds << ") must be greater than "
+          << "or equal to 0!" << endl;
+
+    FindEmptyClusterPolicy<KMeansParallelInitialization>(
+        KMeansParallelInitialization(oversampling, (size_t) rounds));
+  }
   else
   {
     FindEmptyClusterPolicy<SampleInitialization>(SampleInitialization());
@@ -155,6 +246,19 @@ int main(int argc, char** argv)
 template<typename InitialPartitionPolicy>
 void FindEmptyClusterPolicy(const InitialPartitionPolicy& ipp)
 {
+  // Mini-batch k-means has no Lloyd iterations, so it has no empty cluster
+  // policy either.
+  if (CLI::GetParam<string>("algorithm") == "mini-batch")
+  {
+    if (CLI::HasParam("allow_empty_clusters") ||
+        CLI::HasParam("kill_empty_clusters"))
+      Log::Warn << "--allow_empty_clusters (-e) and --kill_empty_clusters (-E) "
+          << "are ignored for mini-batch k-means." << endl;
+
+    RunMiniBatchKMeans<InitialPartitionPolicy>(ipp);
+    return;
+  }
+
   if (CLI::HasParam("allow_empty_clusters") &&
       CLI::HasParam("kill_empty_clusters"))
     Log::Fatal << "Only one of --allow_empty_clusters (-e) or "
@@ -177,6 +281,8 @@ void FindLloydStepType(const InitialPartitionPolicy& ipp)
     RunKMeans<InitialPartitionPolicy, EmptyClusterPolicy, ElkanKMeans>(ipp);
   else if (algorithm == "hamerly")
     RunKMeans<InitialPartitionPolicy, EmptyClusterPolicy, HamerlyKMeans>(ipp);
+  else if (algorithm == "yinyang")
+    RunKMeans<InitialPartitionPolicy, EmptyClusterPolicy, YinyangKMeans>(ipp);
   else if (algorithm == "pelleg-moore")
     RunKMeans<InitialPartitionPolicy, EmptyClusterPolicy,
         PellegMooreKMeans>(ipp);
@@ -188,10 +294,13 @@ void FindLloydStepType(const InitialPartitionPolicy& ipp)
         CoverTreeDualTreeKMeans>(ipp);
   else if (algorithm == "naive")
     RunKMeans<InitialPartitionPolicy, EmptyClusterPolicy, NaiveKMeans>(ipp);
+  else if (algorithm == "blocked")
+    RunKMeans<InitialPartitionPolicy, EmptyClusterPolicy, BlockedKMeans>(ipp);
   else
     Log::Fatal << "Unknown algorithm: '" << algorithm << "'.  Supported options"
-        << " are 'naive', 'pelleg-moore', 'elkan', 'hamerly', 'dualtree', and "
-        << "'dualtree-covertree'." << endl;
+        << " are 'naive', 'pelleg-moore', 'elkan', 'hamerly', 'yinyang', "
+        << "'dualtree', 'dualtree-covertree', 'blocked', and 'mini-batch'."
+        << endl;
 }
 
 // Given the template parameters, sanitize/load input and run k-means.
@@ -199,30 +308,129 @@ template<typename InitialPartitionPolicy,
          typename EmptyClusterPolicy,
          template<class, class> class LloydStepType>
 void RunKMeans(const InitialPartitionPolicy& ipp)
+{
+  size_t clusters, maxIterations;
+  arma::mat dataset, centroids;
+  const bool initialCentroidGuess = LoadInput(clusters, maxIterations, dataset,
+      centroids);
+
+  Timer::Start("clustering");
+  KMeans<metric::EuclideanDistance,
+         InitialPartitionPolicy,
+         EmptyClusterPolicy,
+         LloydStepType> kmeans(maxIterations, metric::EuclideanDistance(), ipp);
+
+  arma::Row<size_t> assignments;
+  const size_t restarts = (size_t) CLI::GetParam<int>("restarts");
+  if (restarts > 1 && !initialCentroidGuess)
+  {
+    // Run the restarts, and keep the best clustering.
+    const double objective = kmeans.Cluster(dataset, clusters, restarts,
+        assignments, centroids);
+    Log::Info << "Sum of squared distances of the best restart: " << objective
+        << "." << endl;
+  }
+  else if (CLI::HasParam("output") || CLI::HasParam("in_place"))
+  {
+    // We need to get the assignments.
+    kmeans.Cluster(dataset, clusters, assignments, centroids,
+        false, initialCentroidGuess);
+  }
+  else
+  {
+    // Just save the centroids.
+    kmeans.Cluster(dataset, clusters, centroids, initialCentroidGuess);
+  }
+  Timer::Stop("clustering");
+
+  SaveResults(dataset, assignments, centroids);
+}
+
+// Given the initial partition policy, sanitize/load input and run mini-batch
+// k-means.
+template<typename InitialPartitionPolicy>
+void RunMiniBatchKMeans(const InitialPartitionPolicy& ipp)
+{
+  const int batchSize = CLI::GetParam<int>("batch_size");
+  if (batchSize <= 0)
+  {
+    Log::Fatal << "Invalid batch size (" << batchSize << ")! Must be greater "
+        << "than 0." << endl;
+  }
+
+  size_t clusters, maxIterations;
+  arma::mat dataset, centroids;
+  const bool initialCentroidGuess = LoadInput(clusters, maxIterations, dataset,
+      centroids);
+
+  Timer::Start("clustering");
+  MiniBatchKMeans<metric::EuclideanDistance, InitialPartitionPolicy> kmeans(
+      (size_t) batchSize, maxIterations, 0.0, metric::EuclideanDistance(), ipp);
+
+  arma::Row<size_t> assignments;
+  if (CLI::HasParam("output") || CLI::HasParam("in_place"))
+  {
+    kmeans.Cluster(dataset, clusters, assignments, centroids,
+        initialCentroidGuess);
+  }
+  else
+  {
+    MatrixBatchSource<> source(dataset);
+    kmeans.Cluster(source, clusters, centroids, initialCentroidGuess);
+  }
+  Timer::Stop("clustering");
+
+  SaveResults(dataset, assignments, centroids);
+}
+
+// Sanitize the options and load the dataset and the initial centroids (if
+// given).  Returns whether initial centroids were given.
+bool LoadInput(size_t& clusters,
+               size_t& maxIterations,
+               arma::mat& dataset,
+               arma::mat& centroids)
 {
   // Now, do validation of input options.
-  int clusters = CLI::GetParam<int>("clusters");
-  if (clusters < 0)
+  const int clustersParam = CLI::GetParam<int>("clusters");
+  if (clustersParam < 0)
   {
-    Log::Fatal << "Invalid number of clusters requested (" << clusters << ")! "
-        << "Must be greater than or equal to 0." << endl;
+    Log::Fatal << "Invalid number of clusters requested (" << clustersParam
+        << ")! Must be greater than or equal to 0." << endl;
   }
-  else if (clusters == 0 && CLI::HasParam("initial_centroids"))
+  else if (clustersParam == 0 && CLI::HasParam("initial_centroids"))
   {
     Log::Info << "Detecting number of clusters automatically from input "
         << "centroids." << endl;
   }
-  else if (clusters == 0)
+  else if (clustersParam == 0)
   {
     Log::Fatal << "Number of clusters requested is 0, and no initial centroids "
         << "provided!" << endl;
   }
+  clusters = (size_t) clustersParam;
 
-  const int maxIterations = CLI::GetParam<int>("max_iterations");
-  if (maxIterations < 0)
+  const int maxIterationsParam = CLI::GetParam<int>("max_iterations");
+  if (maxIterationsParam < 0)
   {
-    Log::Fatal << "Invalid value for maximum iterations (" << maxIterations <<
-        ")! Must be greater than or equal to 0." << endl;
+    Log::Fatal << "Invalid value for maximum iterations (" << maxIterationsParam
+        << ")! Must be greater than or equal to 0." << endl;
+  }
+  maxIterations = (size_t) maxIterationsParam;
+
+  const int restarts = CLI::GetParam<int>("restarts");
+  if (restarts <= 0)
+  {
+    Log::Fatal << "Invalid number of restarts (" << restarts << ")! Must be "
+        << "greater than 0." << endl;
+  }
+  else if (restarts > 1 && CLI::HasParam("initial_centroids"))
+  {
+    Log::Warn << "--restarts is ignored when --initial_centroids is given."
+        << endl;
+  }
+  else if (restarts > 1 && CLI::GetParam<string>("algorithm") == "mini-batch")
+  {
+    Log::Warn << "--restarts is ignored for mini-batch k-means." << endl;
   }
 
   // Make sure we have an output file if we're not doing the work in-place.
@@ -234,8 +442,7 @@ void RunKMeans(const InitialPartitionPolicy& ipp)
   }
 
   // Load our dataset.
-  arma::mat dataset = CLI::GetParam<arma::mat>("input");
-  arma::mat centroids;
+  dataset = CLI::GetParam<arma::mat>("input");
 
   const bool initialCentroidGuess = CLI::HasParam("initial_centroids");
   // Load initial centroids if the user asked for it.
@@ -245,27 +452,24 @@ void RunKMeans(const InitialPartitionPolicy& ipp)
     if (clusters == 0)
       clusters = centroids.n_cols;
 
-    if (CLI::HasParam("refined_start"))
+    if (CLI::HasParam("refined_start") || CLI::HasParam("kmeans_plus_plus") ||
+        CLI::HasParam("kmeans_parallel"))
       Log::Warn << "Initial centroids are specified, but will be ignored "
-          << "because --refined_start is also specified!" << endl;
+          << "because an initialization strategy is also specified!" << endl;
     else
       Log::Info << "Using initial centroid guesses." << endl;
   }
 
-  Timer::Start("clustering");
-  KMeans<metric::EuclideanDistance,
-         InitialPartitionPolicy,
-         EmptyClusterPolicy,
-         LloydStepType> kmeans(maxIterations, metric::EuclideanDistance(), ipp);
+  return initialCentroidGuess;
+}
 
+// Save the assignments (if requested) and the centroids (if requested).
+void SaveResults(arma::mat& dataset,
+                 arma::Row<size_t>& assignments,
+                 arma::mat& centroids)
+{
   if (CLI::HasParam("output") || CLI::HasParam("in_place"))
   {
-    // We need to get the assignments.
-    arma::Row<size_t> assignments;
-    kmeans.Cluster(dataset, clusters, assignments, centroids,
-        false, initialCentroidGuess);
-    Timer::Stop("clustering");
-
     // Now figure out what to do with our results.
     if (CLI::HasParam("in_place"))
     {
@@ -315,12 +519,6 @@ void RunKMeans(const InitialPartitionPolicy& ipp)
       }
     }
   }
-  else
-  {
-    // Just save the centroids.
-    kmeans.Cluster(dataset, clusters, centroids, initialCentroidGuess);
-    Timer::Stop("clustering");
-  }
 
   // Should we write the centroids to a file?
   if (CLI::HasParam("centroid"))
@@ -0,0 +1,128 @@
+/**
+ * @file kmeans_parallel_initialization.hpp
+ *
+ * An implementation of the k-means|| initialization of Bahmani et al., a
+ * scalable variant of k-means++ that needs only a few passes over the dataset.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_KMEANS_KMEANS_PARALLEL_INITIALIZATION_HPP
+#define MLPACK_METHODS_KMEANS_KMEANS_PARALLEL_INITIALIZATION_HPP
+
+#include <mlpack/prereqs.hpp>
+#include "kmeans_plus_plus_initialization.hpp"
+
+namespace mlpack {
+namespace kmeans {
+
+/**
+ * The k-means|| initialization chooses a first candidate centroid uniformly at
+ * random, and then runs a small number of oversampling rounds.  In each round,
+ * every point is taken as a candidate independently with probability
+ *
+ *   min(1, l * d(x)^2 / phi),
+ *
+ * where d(x) is the distance of the point to its closest candidate, phi is the
+ * sum of d(x)^2 over the dataset, and l is the oversampling factor (here given
+ * as a multiple of the number of clusters).  Each candidate is then weighted
+ * by the number of points closest to it, and the weighted candidates are
+ * clustered into the final centroids with the k-means++ seeding.  Since each
+ * round takes about l candidates at once, only a few passes over the dataset
+ * are needed instead of the k passes of k-means++.  The passes over the dataset
+ * are done in parallel when OpenMP is available.  This is an implementation of
+ * the following paper:
+ *
+ * @article{bahmani2012scalable,
+ *   title={Scalable k-means++},
+ *   author={Bahmani, Bahman and Moseley, Benjamin and Vattani, Andrea and
+ *       Kumar, Ravi and Vassilvitskii, Sergei},
+ *   journal={Proceedings of the VLDB Endowment},
+ *   volume={5},
+ *   number={7},
+ *   pages={622--633},
+ *   year={2012}
+ * }
+ */
+class KMeansParallelInitialization
+{
+ public:
+  /**
+   * Create the KMeansParallelInitialization object, optionally specifying the
+   * oversampling factor and the number of oversampling rounds.  The paper
+   * finds that an oversampling factor between 0.5 and 2 and 5 rounds work
+   * well.
+   *
+   * @param oversampling Expected number of candidates taken in each round, as
+   *     a multiple of the number of clusters.
+   * @param rounds Number of oversampling rounds.
+   */
+  KMeansParallelInitialization(const double oversampling = 2.0,
+                               const size_t rounds = 5) :
+      oversampling(oversampling), rounds(rounds) { }
+
+  /**
+   * Initialize the centroids matrix with the k-means|| seeding.
+   *
+   * @tparam MatType Type of data (arma::mat or arma::sp_mat).
+   * @param data Dataset.
+   * @param clusters Number of clusters.
+   * @param centroids Matrix to put initial centroids into.
+   */
+  template<typename MatType>
+  void Cluster(const MatType& data,
+               const size_t clusters,
+               arma::mat& centroids);
+
+  //! Get the oversampling factor.
+  double Oversampling() const { return oversampling; }
+  //! Modify the oversampling factor.
+  double& Oversampling() { return oversampling; }
+
+  //! Get the number of oversampling rounds.
+  size_t Rounds() const { return rounds; }
+  //! Modify the number of oversampling rounds.
+  size_t& Rounds() { return rounds; }
+
+  //! Serialize the object.
+  template<typename Archive>
+  void Serialize(Archive& ar, const unsigned int /* version */)
+  {
+    ar & data::CreateNVP(oversampling, "oversampling");
+    ar & data::CreateNVP(rounds, "rounds");
+  }
+
+ private:
+  //! The expected number of candidates in each round, over the clusters.
+  double oversampling;
+  //! The number of oversampling rounds.
+  size_t rounds;
+
+  /**
+   * Update the squared distance of each point to its closest candidate, and
+   * the closest candidate, with the candidates starting at the given index.
+   *
+   * @param data Dataset.
+   * @param candidates Indices of the candidates in the dataset.
+   * @param firstCandidate Index of the first new candidate.
+   * @param minDistances Squared distance to the closest candidate.
+   * @param closestCandidates Index of the closest candidate.
+   * @return The sum of the squared distances.
+   */
+  template<typename MatType>
+  static double UpdateDistances(const MatType& data,
+                                const std::vector<size_t>& candidates,
+                                const size_t firstCandidate,
+                                arma::vec& minDistances,
+                                arma::Col<size_t>& closestCandidates);
+};
+
+} // namespace kmeans
+} // namespace mlpack
+
+// Include implementation.
+#include "kmeans_parallel_initialization_impl.hpp"
+
+#endif
@@ -0,0 +1,132 @@
+/**
+ * @file kmeans_parallel_initialization_impl.hpp
+ *
+ * Implementation of the k-means|| initialization.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_KMEANS_KMEANS_PARALLEL_INITIALIZATION_IMPL_HPP
+#define MLPACK_METHODS_KMEANS_KMEANS_PARALLEL_INITIALIZATION_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "kmeans_parallel_initialization.hpp"
+
+namespace mlpack {
+namespace kmeans {
+
+template<typename MatType>
+void KMeansParallelInitialization::Cluster(const MatType& data,
+                                           const size_t clusters,
+                                           arma::mat& centroids)
+{
+  if (data.n_cols == 0 || clusters == 0)
+  {
+    centroids.set_size(data.n_rows, clusters);
+    return;
+  }
+
+  // Start with one candidate chosen uniformly at random.
+  std::vector<size_t> candidates;
+  candidates.push_back(math::RandInt(data.n_cols));
+
+  arma::vec minDistances(data.n_cols);
+  minDistances.fill(DBL_MAX);
+  arma::Col<size_t> closestCandidates(data.n_cols);
+  double cost = UpdateDistances(data, candidates, 0, minDistances,
+      closestCandidates);
+
+  const double l = oversampling * clusters;
+  for (size_t r = 0; r < rounds && cost > 0.0; ++r)
+  {
+    // Take each point independently with probability proportional to its
+    // squared distance.  The random numbers are drawn in order, so the result
+    // only depends on the random seed, and not on the number of threads.
+    const size_t firstCandidate = candidates.size();
+    for (size_t i = 0; i < data.n_cols; ++i)
+    {
+      if (math::Random() < l * minDistances[i] / cost)
+        candidates.push_back(i);
+    }
+
+    if (candidates.size() == firstCandidate)
+      continue;
+
+    cost = UpdateDistances(data, candidates, firstCandidate, minDistances,
+        closestCandidates);
+
+    Log::Info << "KMeansParallelInitialization::Cluster(): round " << r
+        << ", " << candidates.size() << " candidates, cost " << cost << "."
+        << std::endl;
+  }
+
+  // Weight each candidate by the number of points closest to it.
+  arma::mat candidateSet(data.n_rows, candidates.size());
+  for (size_t j = 0; j < candidates.size(); ++j)
+    candidateSet.col(j) = arma::vec(data.col(candidates[j]));
+
+  arma::vec weights(candidates.size(), arma::fill::zeros);
+  for (size_t i = 0; i < data.n_cols; ++i)
+    weights[closestCandidates[i]] += 1.0;
+
+  if (candidates.size() <= clusters)
+  {
+    // There are not enough candidates, so fill the other centroids with random
+    // points.
+    centroids.set_size(data.n_rows, clusters);
+    centroids.cols(0, candidates.size() - 1) = candidateSet;
+    for (size_t c = candidates.size(); c < clusters; ++c)
+      centroids.col(c) = arma::vec(data.col(math::RandInt(data.n_cols)));
+  }
+  else
+  {
+    // Recluster the weighted candidates into the final centroids.
+    KMeansPlusPlusInitialization::WeightedCluster(candidateSet, weights,
+        clusters, centroids);
+  }
+}
+
+template<typename MatType>
+double KMeansParallelInitialization::UpdateDistances(
+    const MatType& data,
+    const std::vector<size_t>& candidates,
+    const size_t firstCandidate,
+    arma::vec& minDistances,
+    arma::Col<size_t>& closestCandidates)
+{
+  double cost = 0.0;
+
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables. If we're building for Visual Studio, use
+  // the intmax_t type instead.
+  #pragma omp parallel for schedule(static) reduction(+:cost)
+  for (intmax_t i = 0; i < (intmax_t) data.n_cols; ++i)
+#else
+  #pragma omp parallel for schedule(static) reduction(+:cost)
+  for (size_t i = 0; i < data.n_cols; ++i)
+#endif
+  {
+    for (size_t j = firstCandidate; j < candidates.size(); ++j)
+    {
+      const double distance = metric::SquaredEuclideanDistance::Evaluate(
+          data.col(i), data.col(candidates[j]));
+      if (distance < minDistances[i])
+      {
+        minDistances[i] = distance;
+        closestCandidates[i] = j;
+      }
+    }
+
+    cost += minDistances[i];
+  }
+
+  return cost;
+}
+
+} // namespace kmeans
+} // namespace mlpack
+
+#endif
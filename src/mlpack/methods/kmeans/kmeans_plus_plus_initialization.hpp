@@ -0,0 +1,96 @@
+/**
+ * @file kmeans_plus_plus_initialization.hpp
+ *
+ * An implementation of the k-means++ initialization of Arthur and
+ * Vassilvitskii, which chooses initial centroids that are spread out over the
+ * dataset.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_KMEANS_KMEANS_PLUS_PLUS_INITIALIZATION_HPP
+#define MLPACK_METHODS_KMEANS_KMEANS_PLUS_PLUS_INITIALIZATION_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/metrics/lmetric.hpp>
+
+namespace mlpack {
+namespace kmeans {
+
+/**
+ * The k-means++ initialization chooses the first centroid uniformly at random
+ * from the dataset, and then each following centroid from the dataset with
+ * probability proportional to the squared distance of each point to its closest
+ * centroid chosen so far.  The expected cost of the initial centroids is then
+ * within a factor of O(log k) of the best clustering.  It is an implementation
+ * of the following paper:
+ *
+ * @inproceedings{arthur2007kmeans,
+ *   title={k-means++: The advantages of careful seeding},
+ *   author={Arthur, David and Vassilvitskii, Sergei},
+ *   booktitle={Proceedings of the Eighteenth Annual ACM-SIAM Symposium on
+ *       Discrete Algorithms (SODA 2007)},
+ *   pages={1027--1035},
+ *   year={2007}
+ * }
+ *
+ * Each of the k rounds needs a pass over the dataset to update the distances
+ * to the closest centroid; that pass is done in parallel when OpenMP is
+ * available.  For very large datasets and many clusters, the
+ * KMeansParallelInitialization policy needs far fewer passes.
+ */
+class KMeansPlusPlusInitialization
+{
+ public:
+  //! Empty constructor, required by the InitialPartitionPolicy type definition.
+  KMeansPlusPlusInitialization() { }
+
+  /**
+   * Initialize the centroids matrix with the k-means++ seeding.
+   *
+   * @tparam MatType Type of data (arma::mat or arma::sp_mat).
+   * @param data Dataset.
+   * @param clusters Number of clusters.
+   * @param centroids Matrix to put initial centroids into.
+   */
+  template<typename MatType>
+  inline static void Cluster(const MatType& data,
+                             const size_t clusters,
+                             arma::mat& centroids)
+  {
+    WeightedCluster(data, arma::ones<arma::vec>(data.n_cols), clusters,
+        centroids);
+  }
+
+  /**
+   * Initialize the centroids matrix with the k-means++ seeding on a weighted
+   * dataset: the probability of choosing each point is also proportional to its
+   * weight, as if the point was in the dataset that many times.  This is used
+   * by KMeansParallelInitialization to recluster its weighted candidates.
+   *
+   * @tparam MatType Type of data (arma::mat or arma::sp_mat).
+   * @param data Dataset.
+   * @param weights Non-negative weight of each point.
+   * @param clusters Number of clusters.
+   * @param centroids Matrix to put initial centroids into.
+   */
+  template<typename MatType>
+  static void WeightedCluster(const MatType& data,
+                              const arma::vec& weights,
+                              const size_t clusters,
+                              arma::mat& centroids);
+
+  //! Serialize the object (nothing to do).
+  template<typename Archive>
+  void Serialize(Archive& /* ar */, const unsigned int /* version */) { }
+};
+
+} // namespace kmeans
+} // namespace mlpack
+
+// Include implementation.
+#include "kmeans_plus_plus_initialization_impl.hpp"
+
+#endif
@@ -0,0 +1,95 @@
+/**
+ * @file kmeans_plus_plus_initialization_impl.hpp
+ *
+ * Implementation of the k-means++ initialization.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_KMEANS_KMEANS_PLUS_PLUS_INITIALIZATION_IMPL_HPP
+#define MLPACK_METHODS_KMEANS_KMEANS_PLUS_PLUS_INITIALIZATION_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "kmeans_plus_plus_initialization.hpp"
+
+namespace mlpack {
+namespace kmeans {
+
+template<typename MatType>
+void KMeansPlusPlusInitialization::WeightedCluster(const MatType& data,
+                                                   const arma::vec& weights,
+                                                   const size_t clusters,
+                                                   arma::mat& centroids)
+{
+  centroids.set_size(data.n_rows, clusters);
+  if (data.n_cols == 0 || clusters == 0)
+    return;
+
+  // The squared distance of each point to its closest centroid.
+  arma::vec minDistances(data.n_cols);
+  minDistances.fill(DBL_MAX);
+
+  // The first centroid is chosen proportionally to the weights only.
+  arma::vec probabilities = weights;
+  double total = arma::accu(weights);
+
+  for (size_t c = 0; c < clusters; ++c)
+  {
+    // Sample a point proportionally to the probabilities.  If every point has
+    // probability zero (that is, there are fewer distinct points than
+    // clusters), sample uniformly.
+    size_t index = 0;
+    if (total > 0.0)
+    {
+      const double target = math::Random() * total;
+      double sum = 0.0;
+      index = data.n_cols - 1;
+      for (size_t i = 0; i < data.n_cols; ++i)
+      {
+        sum += probabilities[i];
+        if (sum > target)
+        {
+          index = i;
+          break;
+        }
+      }
+    }
+    else
+    {
+      index = math::RandInt(data.n_cols);
+    }
+
+    centroids.col(c) = arma::vec(data.col(index));
+    if (c == clusters - 1)
+      break;
+
+    // Update the distances to the closest centroid with the new centroid.
+    total = 0.0;
+#ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables. If we're building for Visual Studio, use
+    // the intmax_t type instead.
+    #pragma omp parallel for schedule(static) reduction(+:total)
+    for (intmax_t i = 0; i < (intmax_t) data.n_cols; ++i)
+#else
+    #pragma omp parallel for schedule(static) reduction(+:total)
+    for (size_t i = 0; i < data.n_cols; ++i)
+#endif
+    {
+      const double distance = metric::SquaredEuclideanDistance::Evaluate(
+          data.col(i), centroids.col(c));
+      if (distance < minDistances[i])
+        minDistances[i] = distance;
+
+      probabilities[i] = weights[i] * minDistances[i];
+      total += probabilities[i];
+    }
+  }
+}
+
+} // namespace kmeans
+} // namespace mlpack
+
+#endif
@@ -15,6 +15,7 @@
 #define MLPACK_METHODS_KMEANS_MAX_VARIANCE_NEW_CLUSTER_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <mlpack/core/metrics/lmetric.hpp>
 
 namespace mlpack {
 namespace kmeans {
@@ -22,12 +23,22 @@ namespace kmeans {
 /**
  * When an empty cluster is detected, this class takes the point furthest from
  * the centroid of the cluster with maximum variance as a new cluster.
+ *
+ * The variances and the assignments of the points are computed once per
+ * iteration.  If the Lloyd step gives its assignments and the sums of the
+ * squared norms of the points of each cluster (through ClusterStatistics()),
+ * the variances are found in O(k) time for the Euclidean distance; otherwise,
+ * the points are assigned to the centroids again, in O(kN) time.  The furthest
+ * point is searched for in parallel when OpenMP is available.
  */
 class MaxVarianceNewCluster
 {
  public:
   //! Default constructor required by EmptyClusterPolicy.
-  MaxVarianceNewCluster() : iteration(size_t(-1)) { }
+  MaxVarianceNewCluster() :
+      iteration(size_t(-1)),
+      statisticsIteration(size_t(-1))
+  { }
 
   /**
    * Take the point furthest from the centroid of the cluster with maximum
@@ -54,6 +65,21 @@ class MaxVarianceNewCluster
                       MetricType& metric,
                       const size_t iteration);
 
+  /**
+   * Give the assignments of the points and the sums of the squared norms of the
+   * points of each cluster, as computed by the Lloyd step in the given
+   * iteration, so that the variances don't have to be recomputed from the
+   * dataset if a cluster is empty in this iteration.
+   *
+   * @param assignments Cluster of each point.
+   * @param squaredNormSums Sum of the squared norms of the points of each
+   *      cluster.
+   * @param iteration Index of the iteration.
+   */
+  void ClusterStatistics(const arma::Col<size_t>& assignments,
+                         const arma::vec& squaredNormSums,
+                         const size_t iteration);
+
   //! Serialize the object.
   template<typename Archive>
   void Serialize(Archive& ar, const unsigned int version);
@@ -65,6 +91,11 @@ class MaxVarianceNewCluster
   arma::vec variances;
   //! Cached assignments for each point.
   arma::Row<size_t> assignments;
+  //! Index of iteration for which the statistics of the Lloyd step were given.
+  size_t statisticsIteration;
+  //! Sums of the squared norms of the points of each cluster, given by the
+  //! Lloyd step.
+  arma::vec squaredNormSums;
 
   //! Called when we are on a new iteration.
   template<typename MetricType, typename MatType>
@@ -30,9 +30,34 @@ size_t MaxVarianceNewCluster::EmptyCluster(const MatType& data,
                                            MetricType& metric,
                                            const size_t iteration)
 {
-  // If necessary, calculate the variances and assignments.
+  // If necessary, calculate the variances and assignments.  With the
+  // Euclidean distance, the statistics given by the Lloyd step for this
+  // iteration give the variance of each cluster around its new centroid
+  // directly, as the mean squared norm minus the squared norm of the mean.
   if (iteration != this->iteration || assignments.n_elem != data.n_cols)
-    Precalculate(data, oldCentroids, clusterCounts, metric);
+  {
+    if (statisticsIteration == iteration &&
+        assignments.n_elem == data.n_cols &&
+        std::is_same<MetricType, metric::EuclideanDistance>::value)
+    {
+      variances.zeros(newCentroids.n_cols);
+      for (size_t c = 0; c < newCentroids.n_cols; ++c)
+      {
+        if (clusterCounts[c] > 1)
+        {
+          variances[c] = std::max(0.0, squaredNormSums[c] / clusterCounts[c] -
+              arma::dot(newCentroids.col(c), newCentroids.col(c)));
+        }
+      }
+    }
+    else
+    {
+      Precalculate(data, oldCentroids, clusterCounts, metric);
+    }
+
+    // The statistics no longer hold once points are moved.
+    statisticsIteration = size_t(-1);
+  }
   this->iteration = iteration;
 
   // Now find the cluster with maximum variance.
@@ -44,20 +69,47 @@ size_t MaxVarianceNewCluster::EmptyCluster(const MatType& data,
   if (variances[maxVarCluster] == 0.0)
     return 0;
 
-  // Now, inside this cluster, find the point which is furthest away.
+  // Now, inside this cluster, find the point which is furthest away.  Each
+  // thread finds the furthest point of its block; ties go to the first point,
+  // as in a serial scan.
   size_t furthestPoint = data.n_cols;
   double maxDistance = -DBL_MAX;
-  for (size_t i = 0; i < data.n_cols; ++i)
+  #pragma omp parallel
   {
-    if (assignments[i] == maxVarCluster)
+    size_t threadFurthestPoint = data.n_cols;
+    double threadMaxDistance = -DBL_MAX;
+
+#ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables. If we're building for Visual Studio,
+    // use the intmax_t type instead.
+    #pragma omp for schedule(static)
+    for (intmax_t i = 0; i < (intmax_t) data.n_cols; ++i)
+#else
+    #pragma omp for schedule(static)
+    for (size_t i = 0; i < data.n_cols; ++i)
+#endif
     {
-      const double distance = std::pow(metric.Evaluate(data.col(i),
-          newCentroids.col(maxVarCluster)), 2.0);
+      if (assignments[i] == maxVarCluster)
+      {
+        const double distance = std::pow(metric.Evaluate(data.col(i),
+            newCentroids.col(maxVarCluster)), 2.0);
+
+        if (distance > threadMaxDistance)
+        {
+          threadMaxDistance = distance;
+          threadFurthestPoint = i;
+        }
+      }
+    }
 
-      if (distance > maxDistance)
+    #pragma omp critical
+    {
+      if (threadMaxDistance > maxDistance || (threadMaxDistance ==
+          maxDistance && threadFurthestPoint < furthestPoint))
       {
-        maxDistance = distance;
-        furthestPoint = i;
+        maxDistance = threadMaxDistance;
+        furthestPoint = threadFurthestPoint;
       }
     }
   }
@@ -98,6 +150,16 @@ size_t MaxVarianceNewCluster::EmptyCluster(const MatType& data,
   return 1; // We only changed one point.
 }
 
+inline void MaxVarianceNewCluster::ClusterStatistics(
+    const arma::Col<size_t>& assignments,
+    const arma::vec& squaredNormSums,
+    const size_t iteration)
+{
+  this->assignments = assignments.t();
+  this->squaredNormSums = squaredNormSums;
+  statisticsIteration = iteration;
+}
+
 //! Serialize the object.
 template<typename Archive>
 void MaxVarianceNewCluster::Serialize(Archive& /* ar */,
@@ -126,8 +188,19 @@ void MaxVarianceNewCluster::Precalculate(const MatType& data,
   assignments.set_size(data.n_cols);
 
   // Add the variance of each point's distance away from the cluster.  I think
-  // this is the sensible thing to do.
+  // this is the sensible thing to do.  The points are assigned in parallel,
+  // and the squared distances added up afterwards in a fixed order.
+  arma::vec distances(data.n_cols);
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables. If we're building for Visual Studio, use
+  // the intmax_t type instead.
+  #pragma omp parallel for schedule(static)
+  for (intmax_t i = 0; i < (intmax_t) data.n_cols; ++i)
+#else
+  #pragma omp parallel for schedule(static)
   for (size_t i = 0; i < data.n_cols; ++i)
+#endif
   {
     // Find the closest centroid to this point.
     double minDistance = std::numeric_limits<double>::infinity();
@@ -145,10 +218,12 @@ void MaxVarianceNewCluster::Precalculate(const MatType& data,
     }
 
     assignments[i] = closestCluster;
-    variances[closestCluster] += std::pow(metric.Evaluate(data.col(i),
-        oldCentroids.col(closestCluster)), 2.0);
+    distances[i] = std::pow(minDistance, 2.0);
   }
 
+  for (size_t i = 0; i < data.n_cols; ++i)
+    variances[assignments[i]] += distances[i];
+
   // Divide by the number of points in the cluster to produce the variance,
   // unless the cluster is empty or contains only one point, in which case we
   // set the variance to 0.
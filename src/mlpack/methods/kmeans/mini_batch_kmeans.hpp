@@ -0,0 +1,177 @@
+/**
+ * @file mini_batch_kmeans.hpp
+ *
+ * An implementation of mini-batch k-means (Sculley, "Web-scale k-means
+ * clustering", 2010), which updates the centroids with small random batches of
+ * points instead of full passes over the dataset.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_KMEANS_MINI_BATCH_KMEANS_HPP
+#define MLPACK_METHODS_KMEANS_MINI_BATCH_KMEANS_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/metrics/lmetric.hpp>
+#include "sample_initialization.hpp"
+#include "batch_sources.hpp"
+
+namespace mlpack {
+namespace kmeans {
+
+/**
+ * This class implements mini-batch k-means.  Each iteration takes a batch of
+ * points, finds the closest centroid to each point of the batch, and then moves
+ * each centroid towards each of the points of the batch assigned to it with a
+ * per-centroid learning rate of 1 / v, where v is the number of points that
+ * have been assigned to that centroid so far.  Each iteration costs time
+ * proportional to the batch size instead of the size of the dataset, so this
+ * is suited to very large datasets, at the cost of a clustering that is only
+ * approximately as good as the one found by KMeans.
+ *
+ * The points are read from a batch source, which must provide the method
+ *
+ * @code
+ * size_t NextBatch(const size_t batchSize, arma::mat& batch);
+ * @endcode
+ *
+ * that stores at most batchSize points in the batch and returns the number of
+ * points stored there; clustering stops early once it returns 0.  The
+ * MatrixBatchSource class samples batches from a matrix in memory, while
+ * StreamBatchSource reads batches from a stream and ChunkedBatchSource takes
+ * them from the blocks of a data::ChunkedReader, so the dataset never has to be
+ * held in memory.  The initial centroids are chosen from the first batch with
+ * the InitialPartitionPolicy, unless they are given.
+ *
+ * @code
+ * std::ifstream stream("points.csv");
+ * StreamBatchSource source(stream);
+ *
+ * MiniBatchKMeans<> kmeans(1000, 500);
+ * arma::mat centroids;
+ * kmeans.Cluster(source, 100, centroids);
+ * @endcode
+ *
+ * @tparam MetricType The distance metric used to assign points to centroids.
+ * @tparam InitialPartitionPolicy Initial centroid policy; it must give initial
+ *     centroids (like SampleInitialization and RefinedStart), not assignments.
+ */
+template<typename MetricType = metric::EuclideanDistance,
+         typename InitialPartitionPolicy = SampleInitialization>
+class MiniBatchKMeans
+{
+ public:
+  /**
+   * Create the MiniBatchKMeans object.  A std::invalid_argument is thrown if
+   * the batch size is 0 or the tolerance is negative.
+   *
+   * @param batchSize Number of points in each batch.
+   * @param maxIterations Number of batches to process.
+   * @param tolerance If greater than 0, stop early once no centroid moves more
+   *     than this far in one iteration.
+   * @param metric Instantiated metric.
+   * @param partitioner Initial centroid policy.
+   */
+  MiniBatchKMeans(const size_t batchSize = 1000,
+                  const size_t maxIterations = 100,
+                  const double tolerance = 0.0,
+                  const MetricType metric = MetricType(),
+                  const InitialPartitionPolicy partitioner =
+                      InitialPartitionPolicy());
+
+  /**
+   * Cluster the points given by the batch source.  If initialGuess is true,
+   * the given centroids are used as the initial centroids; otherwise, the
+   * initial centroids are chosen from the first batch.  A std::invalid_argument
+   * is thrown if there are no points, if the first batch has fewer points than
+   * clusters, or if the initial centroids don't fit the points.
+   *
+   * @param source Source of batches of points.
+   * @param clusters Number of clusters to find.
+   * @param centroids Matrix to store the centroids in (and to read the initial
+   *     centroids from, if initialGuess is true).
+   * @param initialGuess Whether the given centroids are the initial centroids.
+   */
+  template<typename BatchSourceType>
+  void Cluster(BatchSourceType& source,
+               const size_t clusters,
+               arma::mat& centroids,
+               const bool initialGuess = false);
+
+  /**
+   * Cluster the given dataset, sampling batches from it, and then assign every
+   * point to its closest centroid.
+   *
+   * @param data Dataset to cluster.
+   * @param clusters Number of clusters to find.
+   * @param assignments Vector to store the cluster of each point in.
+   * @param centroids Matrix to store the centroids in (and to read the initial
+   *     centroids from, if initialGuess is true).
+   * @param initialGuess Whether the given centroids are the initial centroids.
+   */
+  template<typename MatType>
+  void Cluster(const MatType& data,
+               const size_t clusters,
+               arma::Row<size_t>& assignments,
+               arma::mat& centroids,
+               const bool initialGuess = false);
+
+  //! Get the batch size.
+  size_t BatchSize() const { return batchSize; }
+  //! Modify the batch size.
+  size_t& BatchSize() { return batchSize; }
+
+  //! Get the number of iterations.
+  size_t MaxIterations() const { return maxIterations; }
+  //! Modify the number of iterations.
+  size_t& MaxIterations() { return maxIterations; }
+
+  //! Get the tolerance.
+  double Tolerance() const { return tolerance; }
+  //! Modify the tolerance.
+  double& Tolerance() { return tolerance; }
+
+  //! Get the distance metric.
+  const MetricType& Metric() const { return metric; }
+  //! Modify the distance metric.
+  MetricType& Metric() { return metric; }
+
+  //! Get the initial centroid policy.
+  const InitialPartitionPolicy& Partitioner() const { return partitioner; }
+  //! Modify the initial centroid policy.
+  InitialPartitionPolicy& Partitioner() { return partitioner; }
+
+ private:
+  //! Number of points in each batch.
+  size_t batchSize;
+  //! Number of batches to process.
+  size_t maxIterations;
+  //! Stop once no centroid moves more than this in an iteration (if > 0).
+  double tolerance;
+  //! Instantiated distance metric.
+  MetricType metric;
+  //! Initial centroid policy.
+  InitialPartitionPolicy partitioner;
+
+  /**
+   * Find the closest centroid to each point of the given matrix.
+   *
+   * @param points Points to assign.
+   * @param centroids Centroids.
+   * @param assignments Vector to store the closest centroid of each point in.
+   */
+  template<typename MatType, typename VecType>
+  void Assign(const MatType& points,
+              const arma::mat& centroids,
+              VecType& assignments);
+};
+
+} // namespace kmeans
+} // namespace mlpack
+
+// Include implementation.
+#include "mini_batch_kmeans_impl.hpp"
+
+#endif
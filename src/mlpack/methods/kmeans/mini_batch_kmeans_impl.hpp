@@ -0,0 +1,189 @@
+/**
+ * @file mini_batch_kmeans_impl.hpp
+ *
+ * Implementation of mini-batch k-means.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_KMEANS_MINI_BATCH_KMEANS_IMPL_HPP
+#define MLPACK_METHODS_KMEANS_MINI_BATCH_KMEANS_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "mini_batch_kmeans.hpp"
+
+namespace mlpack {
+namespace kmeans {
+
+template<typename MetricType, typename InitialPartitionPolicy>
+MiniBatchKMeans<MetricType, InitialPartitionPolicy>::MiniBatchKMeans(
+    const size_t batchSize,
+    const size_t maxIterations,
+    const double tolerance,
+    const MetricType metric,
+    const InitialPartitionPolicy partitioner) :
+    batchSize(batchSize),
+    maxIterations(maxIterations),
+    tolerance(tolerance),
+    metric(metric),
+    partitioner(partitioner)
+{
+  if (batchSize == 0)
+    throw std::invalid_argument("MiniBatchKMeans: batch size must be greater "
+        "than 0");
+  if (tolerance < 0.0)
+    throw std::invalid_argument("MiniBatchKMeans: tolerance must not be "
+        "negative");
+}
+
+template<typename MetricType, typename InitialPartitionPolicy>
+template<typename BatchSourceType>
+void MiniBatchKMeans<MetricType, InitialPartitionPolicy>::Cluster(
+    BatchSourceType& source,
+    const size_t clusters,
+    arma::mat& centroids,
+    const bool initialGuess)
+{
+  if (clusters == 0)
+    throw std::invalid_argument("MiniBatchKMeans::Cluster(): number of "
+        "clusters must be greater than 0");
+
+  arma::mat batch;
+  size_t points = source.NextBatch(batchSize, batch);
+  if (points == 0)
+    throw std::invalid_argument("MiniBatchKMeans::Cluster(): no points to "
+        "cluster");
+
+  if (initialGuess)
+  {
+    if (centroids.n_cols != clusters || centroids.n_rows != batch.n_rows)
+    {
+      std::ostringstream oss;
+      oss << "MiniBatchKMeans::Cluster(): initial centroids have size "
+          << centroids.n_rows << "x" << centroids.n_cols << ", but expected "
+          << batch.n_rows << "x" << clusters;
+      throw std::invalid_argument(oss.str());
+    }
+  }
+  else
+  {
+    if (points < clusters)
+    {
+      std::ostringstream oss;
+      oss << "MiniBatchKMeans::Cluster(): first batch has only " << points
+          << " points, but " << clusters << " clusters were requested";
+      throw std::invalid_argument(oss.str());
+    }
+
+    partitioner.Cluster(batch, clusters, centroids);
+  }
+
+  // The number of points assigned to each centroid so far; the learning rate of
+  // each centroid is the inverse of its count.
+  arma::Col<size_t> counts(clusters, arma::fill::zeros);
+  arma::Col<size_t> assignments;
+  arma::mat oldCentroids;
+
+  size_t iteration = 0;
+  while (iteration < maxIterations && points > 0)
+  {
+    oldCentroids = centroids;
+
+    // The closest centroids are found before any centroid is moved, as in
+    // Sculley's algorithm.
+    Assign(batch, centroids, assignments);
+
+    for (size_t i = 0; i < points; ++i)
+    {
+      const size_t cluster = assignments[i];
+      counts[cluster]++;
+      const double eta = 1.0 / counts[cluster];
+      centroids.col(cluster) = (1.0 - eta) * centroids.col(cluster) +
+          eta * batch.col(i);
+    }
+
+    ++iteration;
+
+    // The largest distance any centroid moved.
+    double movement = 0.0;
+    for (size_t c = 0; c < clusters; ++c)
+      movement = std::max(movement, metric.Evaluate(oldCentroids.col(c),
+          centroids.col(c)));
+
+    Log::Info << "MiniBatchKMeans::Cluster(): iteration " << iteration
+        << ", largest centroid movement " << movement << "." << std::endl;
+
+    if (tolerance > 0.0 && movement < tolerance)
+    {
+      Log::Info << "MiniBatchKMeans::Cluster(): converged after " << iteration
+          << " iterations." << std::endl;
+      break;
+    }
+
+    if (iteration < maxIterations)
+      points = source.NextBatch(batchSize, batch);
+  }
+
+  if (points == 0)
+    Log::Info << "MiniBatchKMeans::Cluster(): ran out of points after "
+        << iteration << " iterations." << std::endl;
+}
+
+template<typename MetricType, typename InitialPartitionPolicy>
+template<typename MatType>
+void MiniBatchKMeans<MetricType, InitialPartitionPolicy>::Cluster(
+    const MatType& data,
+    const size_t clusters,
+    arma::Row<size_t>& assignments,
+    arma::mat& centroids,
+    const bool initialGuess)
+{
+  MatrixBatchSource<MatType> source(data);
+  Cluster(source, clusters, centroids, initialGuess);
+
+  Assign(data, centroids, assignments);
+}
+
+template<typename MetricType, typename InitialPartitionPolicy>
+template<typename MatType, typename VecType>
+void MiniBatchKMeans<MetricType, InitialPartitionPolicy>::Assign(
+    const MatType& points,
+    const arma::mat& centroids,
+    VecType& assignments)
+{
+  assignments.set_size(points.n_cols);
+
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables. If we're building for Visual Studio, use
+  // the intmax_t type instead.
+  #pragma omp parallel for schedule(static)
+  for (intmax_t i = 0; i < (intmax_t) points.n_cols; ++i)
+#else
+  #pragma omp parallel for schedule(static)
+  for (size_t i = 0; i < points.n_cols; ++i)
+#endif
+  {
+    double minDistance = DBL_MAX;
+    size_t closestCluster = 0;
+    for (size_t c = 0; c < centroids.n_cols; ++c)
+    {
+      const double distance = metric.Evaluate(points.col(i),
+          centroids.col(c));
+      if (distance < minDistance)
+      {
+        minDistance = distance;
+        closestCluster = c;
+      }
+    }
+
+    assignments[i] = closestCluster;
+  }
+}
+
+} // namespace kmeans
+} // namespace mlpack
+
+#endif
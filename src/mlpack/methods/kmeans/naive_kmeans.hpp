@@ -54,12 +54,26 @@ class NaiveKMeans
 
   size_t DistanceCalculations() const { return distanceCalculations; }
 
+  //! Get the cluster of each point, as of the last iteration.
+  const arma::Col<size_t>& Assignments() const { return assignments; }
+  //! Get the sum of the squared norms of the points of each cluster, as of the
+  //! last iteration.
+  const arma::vec& SquaredNormSums() const { return squaredNormSums; }
+
  private:
   //! The dataset.
   const MatType& dataset;
   //! The instantiated metric.
   MetricType& metric;
 
+  //! Assignments for each point.
+  arma::Col<size_t> assignments;
+
+  //! Squared norm of each point.
+  arma::vec squaredNorms;
+  //! Sum of the squared norms of the points of each cluster.
+  arma::vec squaredNormSums;
+
   //! Number of distance calculations.
   size_t distanceCalculations;
 };
@@ -36,30 +36,91 @@ double NaiveKMeans<MetricType, MatType>::Iterate(const arma::mat& centroids,
 {
   newCentroids.zeros(centroids.n_rows, centroids.n_cols);
   counts.zeros(centroids.n_cols);
+  squaredNormSums.zeros(centroids.n_cols);
+  assignments.set_size(dataset.n_cols);
 
-  // Find the closest centroid to each point and update the new centroids.
-  for (size_t i = 0; i < dataset.n_cols; i++)
+  // The squared norms of the points are computed once.  Their sums over each
+  // cluster give the variances of the clusters, if the empty cluster policy
+  // needs them.
+  if (squaredNorms.n_elem != dataset.n_cols)
+    squaredNorms = arma::vec(arma::sum(arma::square(dataset)).t());
+
+#ifdef HAS_OPENMP
+  const size_t numThreads = omp_get_max_threads();
+#else
+  const size_t numThreads = 1;
+#endif
+
+  // The first thread accumulates its points into newCentroids and counts, and
+  // every other thread into its own sums and counts, which are added together
+  // afterwards.
+  std::vector<arma::mat> threadCentroids(numThreads - 1,
+      arma::mat(centroids.n_rows, centroids.n_cols, arma::fill::zeros));
+  std::vector<arma::Col<size_t>> threadCounts(numThreads - 1,
+      arma::Col<size_t>(centroids.n_cols, arma::fill::zeros));
+  std::vector<arma::vec> threadSquaredNormSums(numThreads - 1,
+      arma::vec(centroids.n_cols, arma::fill::zeros));
+
+  #pragma omp parallel num_threads(numThreads)
   {
-    // Find the closest centroid to this point.
-    double minDistance = std::numeric_limits<double>::infinity();
-    size_t closestCluster = centroids.n_cols; // Invalid value.
+#ifdef HAS_OPENMP
+    const size_t thread = omp_get_thread_num();
+#else
+    const size_t thread = 0;
+#endif
+    arma::mat& localCentroids = (thread == 0) ? newCentroids :
+        threadCentroids[thread - 1];
+    arma::Col<size_t>& localCounts = (thread == 0) ? counts :
+        threadCounts[thread - 1];
+    arma::vec& localSquaredNormSums = (thread == 0) ? squaredNormSums :
+        threadSquaredNormSums[thread - 1];
 
-    for (size_t j = 0; j < centroids.n_cols; j++)
+    // Find the closest centroid to each point and update the new centroids.
+#ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables. If we're building for Visual Studio,
+    // use the intmax_t type instead.
+    #pragma omp for schedule(static)
+    for (intmax_t i = 0; i < (intmax_t) dataset.n_cols; i++)
+#else
+    #pragma omp for schedule(static)
+    for (size_t i = 0; i < dataset.n_cols; i++)
+#endif
     {
-      const double distance = metric.Evaluate(dataset.col(i), centroids.col(j));
+      // Find the closest centroid to this point.
+      double minDistance = std::numeric_limits<double>::infinity();
+      size_t closestCluster = centroids.n_cols; // Invalid value.
 
-      if (distance < minDistance)
+      for (size_t j = 0; j < centroids.n_cols; j++)
       {
-        minDistance = distance;
-        closestCluster = j;
+        const double distance = metric.Evaluate(dataset.col(i),
+            centroids.col(j));
+
+        if (distance < minDistance)
+        {
+          minDistance = distance;
+          closestCluster = j;
+        }
       }
-    }
 
-    Log::Assert(closestCluster != centroids.n_cols);
+      Log::Assert(closestCluster != centroids.n_cols);
+
+      // We now have the minimum distance centroid index.  Update that
+      // centroid.
+      localCentroids.col(closestCluster) += arma::vec(dataset.col(i));
+      localCounts(closestCluster)++;
+      localSquaredNormSums[closestCluster] += squaredNorms[i];
+      assignments[i] = closestCluster;
+    }
+  }
 
-    // We now have the minimum distance centroid index.  Update that centroid.
-    newCentroids.col(closestCluster) += arma::vec(dataset.col(i));
-    counts(closestCluster)++;
+  // Add the sums and counts of the other threads, in a fixed order so that the
+  // result doesn't depend on the scheduling.
+  for (size_t t = 0; t < threadCentroids.size(); ++t)
+  {
+    newCentroids += threadCentroids[t];
+    counts += threadCounts[t];
+    squaredNormSums += threadSquaredNormSums[t];
   }
 
   // Now normalize the centroid.
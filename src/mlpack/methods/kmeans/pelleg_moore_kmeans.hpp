@@ -14,6 +14,7 @@
 #define MLPACK_METHODS_KMEANS_PELLEG_MOORE_KMEANS_HPP
 
 #include <mlpack/core/tree/binary_space_tree.hpp>
+#include <mlpack/core/tree/independent_subtrees.hpp>
 #include "pelleg_moore_kmeans_statistic.hpp"
 
 namespace mlpack {
@@ -37,6 +38,9 @@ namespace kmeans {
  * organization={ACM}
  * }
  * @endcode
+ *
+ * When OpenMP is available, the kd-tree is split into subtrees with disjoint
+ * sets of points, which are traversed in parallel.
  */
 template<typename MetricType, typename MatType>
 class PellegMooreKMeans
@@ -85,6 +89,12 @@ class PellegMooreKMeans
 
   //! Track distance calculations.
   size_t distanceCalculations;
+
+  //! Subtrees of the tree with disjoint sets of points, which are traversed in
+  //! parallel (empty if that is not done).
+  std::vector<TreeType*> subtrees;
+  //! The nodes above the subtrees, each after its parent.
+  std::vector<TreeType*> ancestors;
 };
 
 } // namespace kmeans
@@ -16,6 +16,8 @@
 #include "pelleg_moore_kmeans.hpp"
 #include "pelleg_moore_kmeans_rules.hpp"
 
+#include <unordered_set>
+
 namespace mlpack {
 namespace kmeans {
 
@@ -53,14 +55,105 @@ double PellegMooreKMeans<MetricType, MatType>::Iterate(
   typedef PellegMooreKMeansRules<MetricType, TreeType> RulesType;
   RulesType rules(dataset, centroids, newCentroids, counts, metric);
 
-  // Use single-tree traverser.
-  typename TreeType::template SingleTreeTraverser<RulesType> traverser(rules);
+#ifdef HAS_OPENMP
+  const size_t numThreads = omp_get_max_threads();
+#else
+  const size_t numThreads = 1;
+#endif
+
+  // The tree never changes, so it only has to be split once.
+  if (numThreads > 1 && subtrees.empty())
+  {
+    tree::IndependentSubtrees(*tree, 8 * numThreads, subtrees, ancestors);
+    if (ancestors.empty())
+      subtrees.clear(); // The tree can't be split.
+  }
+
+  if (subtrees.empty() || numThreads == 1)
+  {
+    // Use single-tree traverser.
+    typename TreeType::template SingleTreeTraverser<RulesType>
+        traverser(rules);
 
-  // Now, do a traversal with a fake query index (since the query index is
-  // irrelevant; we are checking each node with all clusters.
-  traverser.Traverse(0, *tree);
+    // Now, do a traversal with a fake query index (since the query index is
+    // irrelevant; we are checking each node with all clusters.
+    traverser.Traverse(0, *tree);
+
+    distanceCalculations += rules.DistanceCalculations();
+  }
+  else
+  {
+    // Score the nodes above the subtrees first, from the top down, just like
+    // the traversal would (the root is never scored).  A node that is
+    // dominated by a single cluster has been counted, so nothing below it is
+    // traversed.
+    std::unordered_set<const TreeType*> prunedNodes;
+    for (size_t i = 0; i < ancestors.size(); ++i)
+    {
+      const TreeType* parent = ancestors[i]->Parent();
+      if (parent == NULL)
+        continue;
+
+      if (prunedNodes.count(parent) ||
+          rules.Score(0, *ancestors[i]) == DBL_MAX)
+        prunedNodes.insert(ancestors[i]);
+    }
 
-  distanceCalculations += rules.DistanceCalculations();
+    // The first thread accumulates into newCentroids and counts, and every
+    // other thread into its own sums and counts, which are added together
+    // afterwards.
+    std::vector<arma::mat> threadCentroids(numThreads - 1,
+        arma::mat(centroids.n_rows, centroids.n_cols, arma::fill::zeros));
+    std::vector<arma::Col<size_t>> threadCounts(numThreads - 1,
+        arma::Col<size_t>(centroids.n_cols, arma::fill::zeros));
+
+    size_t threadDistanceCalculations = 0;
+    #pragma omp parallel num_threads(numThreads) \
+        reduction(+:threadDistanceCalculations)
+    {
+#ifdef HAS_OPENMP
+      const size_t thread = omp_get_thread_num();
+#else
+      const size_t thread = 0;
+#endif
+      MetricType threadMetric(metric);
+      RulesType threadRules(dataset, centroids,
+          (thread == 0) ? newCentroids : threadCentroids[thread - 1],
+          (thread == 0) ? counts : threadCounts[thread - 1], threadMetric);
+      typename TreeType::template SingleTreeTraverser<RulesType>
+          traverser(threadRules);
+
+#ifdef _WIN32
+      // Tiny workaround: Visual Studio only implements OpenMP 2.0, which
+      // doesn't support unsigned loop variables. If we're building for Visual
+      // Studio, use the intmax_t type instead.
+      #pragma omp for schedule(dynamic)
+      for (intmax_t i = 0; i < (intmax_t) subtrees.size(); ++i)
+#else
+      #pragma omp for schedule(dynamic)
+      for (size_t i = 0; i < subtrees.size(); ++i)
+#endif
+      {
+        // The subtree is scored first, like its parent would have done.
+        if (!prunedNodes.count(subtrees[i]->Parent()) &&
+            threadRules.Score(0, *subtrees[i]) != DBL_MAX)
+          traverser.Traverse(0, *subtrees[i]);
+      }
+
+      threadDistanceCalculations += threadRules.DistanceCalculations();
+    }
+
+    // Add the sums and counts of the other threads, in a fixed order so that
+    // the result doesn't depend on the scheduling.
+    for (size_t t = 0; t < threadCentroids.size(); ++t)
+    {
+      newCentroids += threadCentroids[t];
+      counts += threadCounts[t];
+    }
+
+    distanceCalculations += rules.DistanceCalculations() +
+        threadDistanceCalculations;
+  }
 
   // Now, calculate how far the clusters moved, after normalizing them.
   double residual = 0.0;
@@ -14,6 +14,7 @@
 #define MLPACK_METHODS_KMEANS_RANDOM_PARTITION_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <mlpack/core/math/random.hpp>
 
 namespace mlpack {
 namespace kmeans {
@@ -45,9 +46,13 @@ class RandomPartition
                              const size_t clusters,
                              arma::Row<size_t>& assignments)
   {
-    // Implementation is so simple we'll put it here in the header file.
-    assignments = arma::shuffle(arma::linspace<arma::Row<size_t>>(0,
-        (clusters - 1), data.n_cols));
+    // Implementation is so simple we'll put it here in the header file.  The
+    // shuffle uses the random stream of the calling thread, so that parallel
+    // k-means restarts don't share a generator.
+    assignments = arma::linspace<arma::Row<size_t>>(0, (clusters - 1),
+        data.n_cols);
+    for (size_t i = assignments.n_elem; i > 1; --i)
+      std::swap(assignments[i - 1], assignments[math::RandInt(i)]);
   }
 
   //! Serialize the partitioner (nothing to do).
@@ -0,0 +1,131 @@
+/**
+ * @file sparse_kmeans.hpp
+ *
+ * An implementation of a step of the Lloyd algorithm for k-means clustering
+ * on sparse data, which only touches the nonzero elements of the points.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_KMEANS_SPARSE_KMEANS_HPP
+#define MLPACK_METHODS_KMEANS_SPARSE_KMEANS_HPP
+
+#include <mlpack/core/metrics/lmetric.hpp>
+
+namespace mlpack {
+namespace kmeans {
+
+/**
+ * This is an implementation of a single iteration of Lloyd's algorithm for
+ * k-means on sparse data (arma::sp_mat).  Like BlockedKMeans, it computes the
+ * squared distances with
+ *
+ *   || x - c ||^2 = || x ||^2 - 2 x^T c + || c ||^2,
+ *
+ * where the squared norms of the points are computed once and cached, and the
+ * squared norms of the centroids are computed once per iteration.  The inner
+ * products x^T c with all the centroids are accumulated over the nonzero
+ * elements of x only, from a transposed copy of the centroids (so that the
+ * entries of all the centroids for one dimension are contiguous), so an
+ * iteration costs O(nnz * k) instead of O(n * d * k).  Blocks of points are
+ * handled in parallel when OpenMP is available.
+ *
+ * The new centroids are accumulated without ever densifying a point: the
+ * transposed dataset (one column per dimension) is built once, and the
+ * dimensions are then split among the threads, each adding the nonzero
+ * elements of its dimensions to the sums of the clusters of their points.  No
+ * thread needs its own copy of the centroids, which matters when the data has
+ * millions of dimensions.  The price is a second copy of the nonzero elements
+ * of the dataset.
+ *
+ * Because the distances are computed with a different formula, a point whose
+ * two closest centroids are at almost exactly the same distance may be
+ * assigned to a different one than NaiveKMeans would assign it to.
+ *
+ * This can only be used with the EuclideanDistance or SquaredEuclideanDistance
+ * metrics, and with arma::sp_mat data.  If your intention is to run the full
+ * k-means algorithm, you are looking for the mlpack::kmeans::KMeans class
+ * instead of this one.
+ *
+ * @code
+ * KMeans<metric::EuclideanDistance, SampleInitialization,
+ *     MaxVarianceNewCluster, SparseKMeans, arma::sp_mat> k;
+ * k.Cluster(documents, 100, assignments);
+ * @endcode
+ *
+ * @param MetricType Type of metric used with this implementation.
+ * @param MatType Matrix type (arma::sp_mat).
+ */
+template<typename MetricType, typename MatType>
+class SparseKMeans
+{
+  static_assert(std::is_same<MetricType, metric::EuclideanDistance>::value ||
+      std::is_same<MetricType, metric::SquaredEuclideanDistance>::value,
+      "SparseKMeans can only be used with EuclideanDistance or "
+      "SquaredEuclideanDistance.");
+  static_assert(std::is_same<MatType, arma::sp_mat>::value,
+      "SparseKMeans can only be used with arma::sp_mat.");
+
+ public:
+  /**
+   * Construct the SparseKMeans object with the given dataset and metric.
+   *
+   * @param dataset Dataset.
+   * @param metric Instantiated metric.
+   */
+  SparseKMeans(const MatType& dataset, MetricType& metric);
+
+  /**
+   * Run a single iteration of the Lloyd algorithm, updating the given centroids
+   * into the newCentroids matrix.  If any cluster is empty (that is, if any
+   * cluster has no points assigned to it), then the centroid associated with
+   * that cluster may be filled with invalid data (it will be corrected later).
+   *
+   * @param centroids Current cluster centroids.
+   * @param newCentroids New cluster centroids.
+   * @param counts Number of points in each cluster at the end of the iteration.
+   */
+  double Iterate(const arma::mat& centroids,
+                 arma::mat& newCentroids,
+                 arma::Col<size_t>& counts);
+
+  size_t DistanceCalculations() const { return distanceCalculations; }
+
+  //! Get the cluster of each point, as of the last iteration.
+  const arma::Col<size_t>& Assignments() const { return assignments; }
+  //! Get the sum of the squared norms of the points of each cluster, as of the
+  //! last iteration.
+  const arma::vec& SquaredNormSums() const { return squaredNormSums; }
+
+  //! Number of points in each block.
+  static const size_t PointBlockSize = 256;
+
+ private:
+  //! The dataset.
+  const MatType& dataset;
+  //! The instantiated metric.
+  MetricType& metric;
+
+  //! The transposed dataset (one column per dimension).
+  MatType datasetTrans;
+  //! The squared norm of each point.
+  arma::vec pointNorms;
+
+  //! Assignments for each point.
+  arma::Col<size_t> assignments;
+  //! Sum of the squared norms of the points of each cluster.
+  arma::vec squaredNormSums;
+
+  //! Number of distance calculations.
+  size_t distanceCalculations;
+};
+
+} // namespace kmeans
+} // namespace mlpack
+
+// Include implementation.
+#include "sparse_kmeans_impl.hpp"
+
+#endif
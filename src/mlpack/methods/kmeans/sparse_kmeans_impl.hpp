@@ -0,0 +1,186 @@
+/**
+ * @file sparse_kmeans_impl.hpp
+ *
+ * An implementation of a step of the Lloyd algorithm for k-means clustering
+ * on sparse data, which only touches the nonzero elements of the points.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_KMEANS_SPARSE_KMEANS_IMPL_HPP
+#define MLPACK_METHODS_KMEANS_SPARSE_KMEANS_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "sparse_kmeans.hpp"
+
+namespace mlpack {
+namespace kmeans {
+
+template<typename MetricType, typename MatType>
+SparseKMeans<MetricType, MatType>::SparseKMeans(const MatType& dataset,
+                                                MetricType& metric) :
+    dataset(dataset),
+    metric(metric),
+    distanceCalculations(0)
+{ /* Nothing to do. */ }
+
+// Run a single iteration.
+template<typename MetricType, typename MatType>
+double SparseKMeans<MetricType, MatType>::Iterate(const arma::mat& centroids,
+                                                  arma::mat& newCentroids,
+                                                  arma::Col<size_t>& counts)
+{
+  newCentroids.zeros(centroids.n_rows, centroids.n_cols);
+  counts.zeros(centroids.n_cols);
+  squaredNormSums.zeros(centroids.n_cols);
+  assignments.set_size(dataset.n_cols);
+
+  // The dataset doesn't change between iterations, so its transpose and the
+  // squared norms of the points only have to be computed once.
+  if (pointNorms.n_elem != dataset.n_cols)
+  {
+    datasetTrans = dataset.t();
+    pointNorms.zeros(dataset.n_cols);
+    for (size_t i = 0; i < dataset.n_cols; ++i)
+      for (size_t j = dataset.col_ptrs[i]; j < dataset.col_ptrs[i + 1]; ++j)
+        pointNorms[i] += dataset.values[j] * dataset.values[j];
+  }
+
+  // Each column holds the entries of all the centroids for one dimension.
+  const arma::mat centroidsTrans = centroids.t();
+  const arma::rowvec centroidNorms = arma::sum(arma::square(centroids), 0);
+  const size_t k = centroids.n_cols;
+
+#ifdef HAS_OPENMP
+  const size_t numThreads = omp_get_max_threads();
+#else
+  const size_t numThreads = 1;
+#endif
+
+  // The first thread counts its points into counts, and every other thread
+  // into its own counts, which are added together afterwards.
+  std::vector<arma::Col<size_t>> threadCounts(numThreads - 1,
+      arma::Col<size_t>(k, arma::fill::zeros));
+  std::vector<arma::vec> threadSquaredNormSums(numThreads - 1,
+      arma::vec(k, arma::fill::zeros));
+
+  const size_t numBlocks = (dataset.n_cols + PointBlockSize - 1) /
+      PointBlockSize;
+
+  #pragma omp parallel num_threads(numThreads)
+  {
+#ifdef HAS_OPENMP
+    const size_t thread = omp_get_thread_num();
+#else
+    const size_t thread = 0;
+#endif
+    arma::Col<size_t>& localCounts = (thread == 0) ? counts :
+        threadCounts[thread - 1];
+    arma::vec& localSquaredNormSums = (thread == 0) ? squaredNormSums :
+        threadSquaredNormSums[thread - 1];
+
+    arma::vec products(k);
+
+#ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables. If we're building for Visual Studio,
+    // use the intmax_t type instead.
+    #pragma omp for schedule(dynamic)
+    for (intmax_t b = 0; b < (intmax_t) numBlocks; ++b)
+#else
+    #pragma omp for schedule(dynamic)
+    for (size_t b = 0; b < numBlocks; ++b)
+#endif
+    {
+      const size_t begin = b * PointBlockSize;
+      const size_t end = std::min(begin + PointBlockSize,
+          (size_t) dataset.n_cols);
+
+      for (size_t i = begin; i < end; ++i)
+      {
+        // The inner products of the point with every centroid, from its
+        // nonzero elements only.
+        products.zeros();
+        for (size_t j = dataset.col_ptrs[i]; j < dataset.col_ptrs[i + 1]; ++j)
+        {
+          const double value = dataset.values[j];
+          const double* centroidValues =
+              centroidsTrans.colptr(dataset.row_indices[j]);
+          for (size_t c = 0; c < k; ++c)
+            products[c] += value * centroidValues[c];
+        }
+
+        double minDistance = DBL_MAX;
+        size_t closestCluster = 0;
+        for (size_t c = 0; c < k; ++c)
+        {
+          const double distance = pointNorms[i] - 2 * products[c] +
+              centroidNorms[c];
+          if (distance < minDistance)
+          {
+            minDistance = distance;
+            closestCluster = c;
+          }
+        }
+
+        assignments[i] = closestCluster;
+        localCounts(closestCluster)++;
+        localSquaredNormSums[closestCluster] += pointNorms[i];
+      }
+    }
+  }
+
+  // Add the counts of the other threads, in a fixed order so that the result
+  // doesn't depend on the scheduling.
+  for (size_t t = 0; t < threadCounts.size(); ++t)
+  {
+    counts += threadCounts[t];
+    squaredNormSums += threadSquaredNormSums[t];
+  }
+
+  // Sum the points of each cluster, one dimension (one row of newCentroids)
+  // per loop iteration, so that each thread writes to its own rows.
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables. If we're building for Visual Studio, use
+  // the intmax_t type instead.
+  #pragma omp parallel for schedule(dynamic, 64) num_threads(numThreads)
+  for (intmax_t d = 0; d < (intmax_t) datasetTrans.n_cols; ++d)
+#else
+  #pragma omp parallel for schedule(dynamic, 64) num_threads(numThreads)
+  for (size_t d = 0; d < datasetTrans.n_cols; ++d)
+#endif
+  {
+    for (size_t j = datasetTrans.col_ptrs[d]; j < datasetTrans.col_ptrs[d + 1];
+         ++j)
+    {
+      newCentroids(d, assignments[datasetTrans.row_indices[j]]) +=
+          datasetTrans.values[j];
+    }
+  }
+
+  // Now normalize the centroid.
+  for (size_t i = 0; i < k; ++i)
+    if (counts(i) != 0)
+      newCentroids.col(i) /= counts(i);
+
+  distanceCalculations += k * dataset.n_cols;
+
+  // Calculate cluster distortion for this iteration.
+  double cNorm = 0.0;
+  for (size_t i = 0; i < k; ++i)
+  {
+    cNorm += std::pow(metric.Evaluate(centroids.col(i), newCentroids.col(i)),
+        2.0);
+  }
+  distanceCalculations += k;
+
+  return std::sqrt(cNorm);
+}
+
+} // namespace kmeans
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,120 @@
+/**
+ * @file yinyang_kmeans.hpp
+ *
+ * An implementation of the Yinyang algorithm for k-means clustering, which
+ * keeps a lower bound for each group of centroids instead of one for each
+ * centroid.
+ *
+ * The details of this method can be found in the following paper:
+ *
+ * @inproceedings{ding2015yinyang,
+ *  title={Yinyang k-means: a drop-in replacement of the classic k-means with
+ *      consistent speedup},
+ *  author={Ding, Y. and Zhao, Y. and Shen, X. and Musuvathi, M. and
+ *      Mytkowicz, T.},
+ *  booktitle={Proceedings of the 32nd International Conference on Machine
+ *      Learning},
+ *  pages={579--587},
+ *  year={2015}
+ * }
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_KMEANS_YINYANG_KMEANS_HPP
+#define MLPACK_METHODS_KMEANS_YINYANG_KMEANS_HPP
+
+namespace mlpack {
+namespace kmeans {
+
+/**
+ * The YinyangKMeans Lloyd step groups the centroids into about k / 10 groups
+ * (by clustering the initial centroids), and keeps, for each point, an upper
+ * bound on the distance to its centroid and a lower bound on the distance to
+ * the other centroids of each group.  Elkan's algorithm keeps k lower bounds
+ * per point and Hamerly's only one; this is in between, with k / 10 of them.
+ *
+ * When the centroids move, the lower bound of a group decreases by the largest
+ * movement in the group.  A point keeps its centroid if its upper bound is
+ * below all lower bounds (the global filter); otherwise, only the groups whose
+ * lower bound is below the distance to the best centroid found so far are
+ * visited (the group filter), and in those, the centroids whose own movement
+ * still leaves them too far away are skipped (the local filter).  The results
+ * are the same as with the naive Lloyd step.  The points are processed in
+ * parallel when OpenMP is available.
+ */
+template<typename MetricType, typename MatType>
+class YinyangKMeans
+{
+ public:
+  /**
+   * Construct the YinyangKMeans object, which must store several sets of
+   * bounds.
+   */
+  YinyangKMeans(const MatType& dataset, MetricType& metric);
+
+  /**
+   * Run a single iteration of the Yinyang algorithm, updating the given
+   * centroids into the newCentroids matrix.
+   *
+   * @param centroids Current cluster centroids.
+   * @param newCentroids New cluster centroids.
+   * @param counts Current counts, to be overwritten with new counts.
+   */
+  double Iterate(const arma::mat& centroids,
+                 arma::mat& newCentroids,
+                 arma::Col<size_t>& counts);
+
+  size_t DistanceCalculations() const { return distanceCalculations; }
+
+  //! Get the cluster of each point, as of the last iteration.
+  const arma::Col<size_t>& Assignments() const { return assignments; }
+  //! Get the sum of the squared norms of the points of each cluster, as of the
+  //! last iteration.
+  const arma::vec& SquaredNormSums() const { return squaredNormSums; }
+
+  //! Get the number of groups of centroids (0 before the first iteration).
+  size_t Groups() const { return groups.size(); }
+
+ private:
+  //! Split the given centroids into groups, with a few iterations of k-means
+  //! on the centroids.
+  void GroupCentroids(const arma::mat& centroids);
+
+  //! The dataset.
+  const MatType& dataset;
+  //! The instantiated metric.
+  MetricType& metric;
+
+  //! The centroids of each group.
+  std::vector<std::vector<size_t>> groups;
+  //! The group of each centroid.
+  arma::Col<size_t> groupOf;
+  //! The centroids the bounds refer to.
+  arma::mat oldCentroids;
+
+  //! Upper bounds for each point.
+  arma::vec upperBounds;
+  //! Lower bounds for each group (rows) and each point (columns).
+  arma::mat lowerBounds;
+  //! Assignments for each point.
+  arma::Col<size_t> assignments;
+
+  //! Squared norm of each point.
+  arma::vec squaredNorms;
+  //! Sum of the squared norms of the points of each cluster.
+  arma::vec squaredNormSums;
+
+  //! Track distance calculations.
+  size_t distanceCalculations;
+};
+
+} // namespace kmeans
+} // namespace mlpack
+
+// Include implementation.
+#include "yinyang_kmeans_impl.hpp"
+
+#endif
@@ -0,0 +1,344 @@
+/**
+ * @file yinyang_kmeans_impl.hpp
+ *
+ * An implementation of the Yinyang algorithm for k-means clustering.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_KMEANS_YINYANG_KMEANS_IMPL_HPP
+#define MLPACK_METHODS_KMEANS_YINYANG_KMEANS_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "yinyang_kmeans.hpp"
+
+namespace mlpack {
+namespace kmeans {
+
+template<typename MetricType, typename MatType>
+YinyangKMeans<MetricType, MatType>::YinyangKMeans(const MatType& dataset,
+                                                  MetricType& metric) :
+    dataset(dataset),
+    metric(metric),
+    distanceCalculations(0)
+{
+  // Nothing to do.
+}
+
+template<typename MetricType, typename MatType>
+double YinyangKMeans<MetricType, MatType>::Iterate(const arma::mat& centroids,
+                                                   arma::mat& newCentroids,
+                                                   arma::Col<size_t>& counts)
+{
+  size_t globalPruned = 0;
+  size_t groupPruned = 0;
+  size_t calculations = 0;
+
+  // If this is the first iteration, the centroids are grouped and all the
+  // distances are computed.  Otherwise, the bounds refer to the centroids of
+  // the last iteration, so they are moved by the movement of the centroids
+  // since then (which also accounts for changes made by the empty cluster
+  // policy).
+  const bool firstIteration = (oldCentroids.n_cols != centroids.n_cols);
+  arma::vec movements(centroids.n_cols, arma::fill::zeros);
+  if (firstIteration)
+  {
+    GroupCentroids(centroids);
+    upperBounds.set_size(dataset.n_cols);
+    lowerBounds.set_size(groups.size(), dataset.n_cols);
+    assignments.zeros(dataset.n_cols);
+  }
+  else
+  {
+    for (size_t c = 0; c < centroids.n_cols; ++c)
+    {
+      movements(c) = metric.Evaluate(oldCentroids.col(c), centroids.col(c));
+      ++calculations;
+    }
+  }
+
+  // The lower bound of a group decreases by the largest movement in it.
+  arma::vec groupDrifts(groups.size(), arma::fill::zeros);
+  for (size_t c = 0; c < centroids.n_cols; ++c)
+    groupDrifts(groupOf[c]) = std::max(groupDrifts(groupOf[c]), movements(c));
+
+  // Reset new centroids.
+  newCentroids.zeros(centroids.n_rows, centroids.n_cols);
+  counts.zeros(centroids.n_cols);
+  squaredNormSums.zeros(centroids.n_cols);
+
+  // The squared norms of the points are computed once.  Their sums over each
+  // cluster give the variances of the clusters, if the empty cluster policy
+  // needs them.
+  if (squaredNorms.n_elem != dataset.n_cols)
+    squaredNorms = arma::vec(arma::sum(arma::square(dataset)).t());
+
+#ifdef HAS_OPENMP
+  const size_t numThreads = omp_get_max_threads();
+#else
+  const size_t numThreads = 1;
+#endif
+
+  // The first thread accumulates its points into newCentroids and counts, and
+  // every other thread into its own sums and counts, which are added together
+  // afterwards.
+  std::vector<arma::mat> threadCentroids(numThreads - 1,
+      arma::mat(centroids.n_rows, centroids.n_cols, arma::fill::zeros));
+  std::vector<arma::Col<size_t>> threadCounts(numThreads - 1,
+      arma::Col<size_t>(centroids.n_cols, arma::fill::zeros));
+  std::vector<arma::vec> threadSquaredNormSums(numThreads - 1,
+      arma::vec(centroids.n_cols, arma::fill::zeros));
+
+  #pragma omp parallel num_threads(numThreads) \
+      reduction(+:globalPruned, groupPruned, calculations)
+  {
+#ifdef HAS_OPENMP
+    const size_t thread = omp_get_thread_num();
+#else
+    const size_t thread = 0;
+#endif
+    arma::mat& localCentroids = (thread == 0) ? newCentroids :
+        threadCentroids[thread - 1];
+    arma::Col<size_t>& localCounts = (thread == 0) ? counts :
+        threadCounts[thread - 1];
+    arma::vec& localSquaredNormSums = (thread == 0) ? squaredNormSums :
+        threadSquaredNormSums[thread - 1];
+
+    // The centroids that were the best so far for a point, but were replaced,
+    // with their groups and distances.
+    std::vector<std::pair<size_t, double>> replaced;
+
+#ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables. If we're building for Visual Studio,
+    // use the intmax_t type instead.
+    #pragma omp for schedule(static)
+    for (intmax_t i = 0; i < (intmax_t) dataset.n_cols; ++i)
+#else
+    #pragma omp for schedule(static)
+    for (size_t i = 0; i < dataset.n_cols; ++i)
+#endif
+    {
+      if (firstIteration)
+      {
+        // Compute the distances to all the centroids.
+        size_t best = 0;
+        double bestDistance = DBL_MAX;
+        lowerBounds.col(i).fill(DBL_MAX);
+        for (size_t c = 0; c < centroids.n_cols; ++c)
+        {
+          const double dist = metric.Evaluate(dataset.col(i),
+              centroids.col(c));
+          if (dist < bestDistance)
+          {
+            // The previous best centroid now bounds the distances to its
+            // group.
+            if (c > 0)
+            {
+              lowerBounds(groupOf[best], i) = std::min(
+                  lowerBounds(groupOf[best], i), bestDistance);
+            }
+            best = c;
+            bestDistance = dist;
+          }
+          else
+          {
+            lowerBounds(groupOf[c], i) = std::min(lowerBounds(groupOf[c], i),
+                dist);
+          }
+        }
+        calculations += centroids.n_cols;
+
+        assignments[i] = best;
+        upperBounds(i) = bestDistance;
+        localCentroids.col(best) += dataset.col(i);
+        ++localCounts(best);
+        localSquaredNormSums[best] += squaredNorms[i];
+        continue;
+      }
+
+      // Update the bounds with the movements of the centroids.
+      const size_t assignment = assignments[i];
+      upperBounds(i) += movements(assignment);
+      double globalLowerBound = DBL_MAX;
+      for (size_t g = 0; g < groups.size(); ++g)
+      {
+        lowerBounds(g, i) -= groupDrifts(g);
+        globalLowerBound = std::min(globalLowerBound, lowerBounds(g, i));
+      }
+
+      // Global filter.
+      if (upperBounds(i) > globalLowerBound)
+      {
+        // Tighten the upper bound, and try again.
+        upperBounds(i) = metric.Evaluate(dataset.col(i),
+            centroids.col(assignment));
+        ++calculations;
+      }
+
+      if (upperBounds(i) <= globalLowerBound)
+      {
+        ++globalPruned;
+        localCentroids.col(assignment) += dataset.col(i);
+        ++localCounts(assignment);
+        localSquaredNormSums[assignment] += squaredNorms[i];
+        continue;
+      }
+
+      size_t best = assignment;
+      double bestDistance = upperBounds(i);
+      replaced.clear();
+      for (size_t g = 0; g < groups.size(); ++g)
+      {
+        // Group filter.
+        if (lowerBounds(g, i) >= bestDistance)
+        {
+          ++groupPruned;
+          continue;
+        }
+
+        // Before the drift, the lower bound held for each centroid of the
+        // group (other than the assigned one) at its last position.
+        const double oldLowerBound = lowerBounds(g, i) + groupDrifts(g);
+        double newLowerBound = DBL_MAX;
+        for (size_t j = 0; j < groups[g].size(); ++j)
+        {
+          const size_t c = groups[g][j];
+          if (c == assignment)
+            continue;
+
+          // Local filter.
+          const double bound = oldLowerBound - movements(c);
+          if (bound >= bestDistance)
+          {
+            newLowerBound = std::min(newLowerBound, bound);
+            continue;
+          }
+
+          const double dist = metric.Evaluate(dataset.col(i),
+              centroids.col(c));
+          ++calculations;
+          if (dist < bestDistance)
+          {
+            replaced.push_back(std::make_pair(groupOf[best], bestDistance));
+            best = c;
+            bestDistance = dist;
+          }
+          else
+          {
+            newLowerBound = std::min(newLowerBound, dist);
+          }
+        }
+
+        lowerBounds(g, i) = newLowerBound;
+      }
+
+      // The replaced centroids (including the previous assignment) now bound
+      // the distances to their groups.
+      for (size_t j = 0; j < replaced.size(); ++j)
+      {
+        lowerBounds(replaced[j].first, i) = std::min(
+            lowerBounds(replaced[j].first, i), replaced[j].second);
+      }
+
+      assignments[i] = best;
+      upperBounds(i) = bestDistance;
+      localCentroids.col(best) += dataset.col(i);
+      ++localCounts(best);
+      localSquaredNormSums[best] += squaredNorms[i];
+    }
+  }
+
+  // Add the sums and counts of the other threads, in a fixed order so that the
+  // result doesn't depend on the scheduling.
+  for (size_t t = 0; t < threadCentroids.size(); ++t)
+  {
+    newCentroids += threadCentroids[t];
+    counts += threadCounts[t];
+    squaredNormSums += threadSquaredNormSums[t];
+  }
+
+  // Normalize centroids and calculate cluster movement.
+  double centroidMovement = 0.0;
+  for (size_t c = 0; c < centroids.n_cols; ++c)
+  {
+    if (counts(c) > 0)
+      newCentroids.col(c) /= counts(c);
+
+    centroidMovement += std::pow(metric.Evaluate(centroids.col(c),
+        newCentroids.col(c)), 2.0);
+    ++calculations;
+  }
+
+  // The bounds now refer to these centroids.
+  oldCentroids = centroids;
+  distanceCalculations += calculations;
+
+  Log::Info << "Yinyang prunes: " << globalPruned << " points, "
+      << groupPruned << " groups.\n";
+
+  return std::sqrt(centroidMovement);
+}
+
+template<typename MetricType, typename MatType>
+void YinyangKMeans<MetricType, MatType>::GroupCentroids(
+    const arma::mat& centroids)
+{
+  const size_t numGroups = std::max((size_t) 1, centroids.n_cols / 10);
+
+  // Start from evenly spaced centroids, and run a few iterations of k-means.
+  arma::mat groupCenters(centroids.n_rows, numGroups);
+  for (size_t g = 0; g < numGroups; ++g)
+    groupCenters.col(g) = centroids.col(g * centroids.n_cols / numGroups);
+
+  groupOf.zeros(centroids.n_cols);
+  for (size_t iteration = 0; iteration < 5; ++iteration)
+  {
+    arma::mat sums(centroids.n_rows, numGroups, arma::fill::zeros);
+    arma::Col<size_t> sizes(numGroups, arma::fill::zeros);
+    for (size_t c = 0; c < centroids.n_cols; ++c)
+    {
+      double bestDistance = DBL_MAX;
+      for (size_t g = 0; g < numGroups; ++g)
+      {
+        const double dist = metric.Evaluate(centroids.col(c),
+            groupCenters.col(g));
+        if (dist < bestDistance)
+        {
+          bestDistance = dist;
+          groupOf[c] = g;
+        }
+      }
+      distanceCalculations += numGroups;
+
+      sums.col(groupOf[c]) += centroids.col(c);
+      ++sizes[groupOf[c]];
+    }
+
+    for (size_t g = 0; g < numGroups; ++g)
+      if (sizes[g] > 0)
+        groupCenters.col(g) = sums.col(g) / sizes[g];
+  }
+
+  // Keep only the groups that aren't empty.
+  std::vector<size_t> newGroup(numGroups, size_t(-1));
+  groups.clear();
+  for (size_t c = 0; c < centroids.n_cols; ++c)
+  {
+    if (newGroup[groupOf[c]] == size_t(-1))
+    {
+      newGroup[groupOf[c]] = groups.size();
+      groups.push_back(std::vector<size_t>());
+    }
+
+    groupOf[c] = newGroup[groupOf[c]];
+    groups[groupOf[c]].push_back(c);
+  }
+}
+
+} // namespace kmeans
+} // namespace mlpack
+
+#endif
@@ -107,6 +107,38 @@ LARS::LARS(const arma::mat& data,
   Train(data, responses, transposeData);
 }
 
+LARS::LARS(const LARS& other)
+{
+  *this = other;
+}
+
+LARS& LARS::operator=(const LARS& other)
+{
+  if (this == &other)
+    return *this;
+
+  // The pointer to the Gram matrix must not refer to the other model's
+  // internal storage.
+  matGramInternal = other.matGramInternal;
+  matGram = (other.matGram == &other.matGramInternal) ? &matGramInternal :
+      other.matGram;
+  matUtriCholFactor = other.matUtriCholFactor;
+  useCholesky = other.useCholesky;
+  lasso = other.lasso;
+  lambda1 = other.lambda1;
+  elasticNet = other.elasticNet;
+  lambda2 = other.lambda2;
+  tolerance = other.tolerance;
+  betaPath = other.betaPath;
+  lambdaPath = other.lambdaPath;
+  activeSet = other.activeSet;
+  isActive = other.isActive;
+  ignoreSet = other.ignoreSet;
+  isIgnored = other.isIgnored;
+
+  return *this;
+}
+
 void LARS::Train(const arma::mat& matX,
                  const arma::vec& y,
                  arma::vec& beta,
@@ -130,7 +162,15 @@ void LARS::Train(const arma::mat& matX,
                  arma::vec& beta,
                  const bool transposeData)
 {
-  Timer::Start("lars_regression");
+  // The timers can't be used by several threads at once, so LARS isn't timed
+  // when it is run in parallel (for instance by SparseCoding::Encode()).
+#ifdef HAS_OPENMP
+  const bool timed = !omp_in_parallel();
+#else
+  const bool timed = true;
+#endif
+  if (timed)
+    Timer::Start("lars_regression");
 
   // Clear any previous solution information.
   betaPath.clear();
@@ -185,7 +225,8 @@ void LARS::Train(const arma::mat& matX,
   if (maxCorr < lambda1)
   {
     lambdaPath[0] = lambda1;
-    Timer::Stop("lars_regression");
+    if (timed)
+      Timer::Stop("lars_regression");
     return;
   }
 
@@ -417,7 +458,8 @@ void LARS::Train(const arma::mat& matX,
   // Unfortunate copy...
   beta = betaPath.back();
 
-  Timer::Stop("lars_regression");
+  if (timed)
+    Timer::Stop("lars_regression");
 }
 
 void LARS::Train(const arma::mat& data,
@@ -218,6 +218,22 @@ class LARS
        const double lambda2 = 0.0,
        const double tolerance = 1e-16);
 
+  /**
+   * Copy the given LARS model.  If it computed its own Gram matrix, the copy
+   * refers to its own copy of that matrix; a precalculated Gram matrix is
+   * shared.
+   *
+   * @param other LARS model to copy.
+   */
+  LARS(const LARS& other);
+
+  /**
+   * Copy the given LARS model, like the copy constructor.
+   *
+   * @param other LARS model to copy.
+   */
+  LARS& operator=(const LARS& other);
+
   /**
    * Run LARS.  The input matrix (like all mlpack matrices) should be
    * column-major -- each column is an observation and each row is a dimension.
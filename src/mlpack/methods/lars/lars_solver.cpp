@@ -0,0 +1,352 @@
+/**
+ * @file lars_solver.cpp
+ *
+ * Implementation of the LARSSolver class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "lars_solver.hpp"
+#include <mlpack/core/util/log.hpp>
+
+using namespace mlpack;
+using namespace mlpack::regression;
+
+LARSSolver::LARSSolver(const arma::mat& gramMatrix,
+                       const double lambda1,
+                       const double lambda2,
+                       const double tolerance) :
+    gram(&gramMatrix),
+    lambda1(lambda1),
+    lambda2(lambda2),
+    tolerance(tolerance),
+    lasso((lambda1 != 0)),
+    elasticNet((lambda1 != 0) && (lambda2 != 0))
+{
+  const size_t dims = gramMatrix.n_rows;
+
+  cholFactor.set_size(dims, dims);
+  activeGram.set_size(dims, dims);
+
+  activeSet.reserve(dims);
+  isActive.resize(dims, false);
+  ignoreSet.reserve(dims);
+  isIgnored.resize(dims, false);
+
+  corr.set_size(dims);
+  signs.set_size(dims);
+  direction.set_size(dims);
+  gramDirection.set_size(dims);
+  activeBeta.set_size(dims);
+  previousBeta.set_size(dims);
+}
+
+void LARSSolver::Solve(const arma::mat& data,
+                       const arma::mat& responses,
+                       arma::mat& betas)
+{
+  // Compute the correlations of all the responses at once.
+  const arma::mat correlations = trans(data) * responses;
+
+  betas.set_size(gram->n_rows, responses.n_cols);
+  for (size_t i = 0; i < responses.n_cols; ++i)
+  {
+    // Alias the solution, so that Run() places it directly into betas.
+    arma::vec beta = betas.unsafe_col(i);
+    Run(correlations.unsafe_col(i), NULL, beta);
+  }
+}
+
+void LARSSolver::Solve(const arma::vec& correlations, arma::vec& beta)
+{
+  Run(correlations, NULL, beta);
+}
+
+void LARSSolver::Solve(const arma::vec& correlations,
+                       const arma::vec& scales,
+                       arma::vec& beta)
+{
+  Run(correlations, &scales, beta);
+}
+
+void LARSSolver::Run(const arma::vec& vecXTy,
+                     const arma::vec* scales,
+                     arma::vec& beta)
+{
+  const size_t dims = gram->n_rows;
+
+  // Clear any previous solution information.
+  for (size_t i = 0; i < activeSet.size(); ++i)
+    isActive[activeSet[i]] = false;
+  for (size_t i = 0; i < ignoreSet.size(); ++i)
+    isIgnored[ignoreSet[i]] = false;
+  activeSet.clear();
+  ignoreSet.clear();
+
+  beta.zeros(dims);
+  bool lassocond = false;
+
+  // Compute the initial maximum correlation among all dimensions.
+  corr = vecXTy;
+  double maxCorr = 0;
+  size_t changeInd = 0;
+  for (size_t i = 0; i < dims; ++i)
+  {
+    if (fabs(corr[i]) > maxCorr)
+    {
+      maxCorr = fabs(corr[i]);
+      changeInd = i;
+    }
+  }
+
+  // The value of lambda1 for the solution before the last step.
+  double previousLambda = maxCorr;
+
+  // If the maximum correlation is too small, there is no reason to continue.
+  if (maxCorr < lambda1)
+    return;
+
+  // Main loop.
+  while (((activeSet.size() + ignoreSet.size()) < dims) &&
+         (maxCorr > tolerance))
+  {
+    // Compute the maximum correlation among inactive dimensions.
+    maxCorr = 0;
+    for (size_t i = 0; i < dims; ++i)
+    {
+      if ((!isActive[i]) && (!isIgnored[i]) && (fabs(corr[i]) > maxCorr))
+      {
+        maxCorr = fabs(corr[i]);
+        changeInd = i;
+      }
+    }
+
+    // Add variable to active set.
+    if (!lassocond)
+      Activate(changeInd, scales);
+
+    const size_t n = activeSet.size();
+    if (n == 0)
+    {
+      // The last active dimension was removed; add the next one.
+      lassocond = false;
+      continue;
+    }
+
+    // Check for singularity.
+    if (!(std::abs(cholFactor(n - 1, n - 1)) > tolerance))
+    {
+      // Singularity, so remove variable from active set, add to ignores set,
+      // and look for new variable to add.
+      Log::Warn << "Encountered singularity when adding variable "
+          << changeInd << " to active set; permanently removing."
+          << std::endl;
+      CholeskyDelete(n - 1);
+      Deactivate(n - 1);
+      Ignore(changeInd);
+      continue;
+    }
+
+    // Compute signs of correlations.
+    for (size_t i = 0; i < n; ++i)
+      signs[i] = corr[activeSet[i]] / fabs(corr[activeSet[i]]);
+
+    // Compute the "equiangular" direction in parameter space, inv(R^T R) s,
+    // by forward and back substitution with the Cholesky factor R.
+    for (size_t i = 0; i < n; ++i)
+    {
+      double sum = signs[i];
+      for (size_t j = 0; j < i; ++j)
+        sum -= cholFactor(j, i) * direction[j];
+      direction[i] = sum / cholFactor(i, i);
+    }
+    for (size_t i = n; i-- > 0; )
+    {
+      double sum = direction[i];
+      for (size_t j = i + 1; j < n; ++j)
+        sum -= cholFactor(i, j) * direction[j];
+      direction[i] = sum / cholFactor(i, i);
+    }
+
+    double normalization = 0.0;
+    for (size_t i = 0; i < n; ++i)
+      normalization += signs[i] * direction[i];
+    normalization = 1.0 / sqrt(normalization);
+    direction.head(n) *= normalization;
+
+    // The correlations of the "equiangular" direction in output space with
+    // each dimension.
+    gramDirection = activeGram.head_cols(n) * direction.head(n);
+
+    double gamma = maxCorr / normalization;
+
+    // If not all variables are active.
+    if ((activeSet.size() + ignoreSet.size()) < dims)
+    {
+      // Compute correlations with direction.
+      for (size_t ind = 0; ind < dims; ++ind)
+      {
+        if (isActive[ind] || isIgnored[ind])
+          continue;
+
+        const double dirCorr = gramDirection[ind];
+        const double val1 = (maxCorr - corr[ind]) / (normalization - dirCorr);
+        const double val2 = (maxCorr + corr[ind]) / (normalization + dirCorr);
+        if ((val1 > 0) && (val1 < gamma))
+          gamma = val1;
+        if ((val2 > 0) && (val2 < gamma))
+          gamma = val2;
+      }
+    }
+
+    // Bound gamma according to LASSO.
+    if (lasso)
+    {
+      lassocond = false;
+      double lassoboundOnGamma = DBL_MAX;
+      size_t activeIndToKickOut = -1;
+
+      for (size_t i = 0; i < n; ++i)
+      {
+        const double val = -beta[activeSet[i]] / direction[i];
+        if ((val > 0) && (val < lassoboundOnGamma))
+        {
+          lassoboundOnGamma = val;
+          activeIndToKickOut = i;
+        }
+      }
+
+      if (lassoboundOnGamma < gamma)
+      {
+        gamma = lassoboundOnGamma;
+        lassocond = true;
+        changeInd = activeIndToKickOut;
+      }
+    }
+
+    // Update the estimator.
+    previousBeta = beta;
+    for (size_t i = 0; i < n; ++i)
+      beta[activeSet[i]] += gamma * direction[i];
+
+    if (lassocond)
+    {
+      // Make sure the kicked out dimension is actually zero, and remove it
+      // (it is in position changeInd in activeSet).
+      beta[activeSet[changeInd]] = 0;
+      CholeskyDelete(changeInd);
+      Deactivate(changeInd);
+    }
+
+    // Compute the correlations of the residual, X^T y - X^T X beta; beta is
+    // zero outside of the active set.
+    const size_t activeCount = activeSet.size();
+    for (size_t i = 0; i < activeCount; ++i)
+      activeBeta[i] = beta[activeSet[i]];
+    corr = vecXTy;
+    if (activeCount > 0)
+      corr -= activeGram.head_cols(activeCount) * activeBeta.head(activeCount);
+    if (elasticNet)
+      corr -= lambda2 * beta;
+
+    double curLambda = 0;
+    for (size_t i = 0; i < activeCount; ++i)
+      curLambda += fabs(corr[activeSet[i]]);
+
+    curLambda /= ((double) activeCount);
+
+    // Time to stop for LASSO?
+    if (lasso && (curLambda <= lambda1))
+    {
+      // Interpolate beta between the last two solutions.
+      const double interp = (previousLambda - lambda1) /
+          (previousLambda - curLambda);
+      beta = (1 - interp) * previousBeta + interp * beta;
+      break;
+    }
+
+    previousLambda = curLambda;
+  }
+}
+
+void LARSSolver::Activate(const size_t varInd, const arma::vec* scales)
+{
+  const size_t n = activeSet.size();
+
+  // Copy the column of the (scaled) Gram matrix of the new dimension.
+  if (scales)
+    activeGram.col(n) = (*scales)[varInd] * (gram->col(varInd) % (*scales));
+  else
+    activeGram.col(n) = gram->col(varInd);
+
+  // Add the new column of the Cholesky factor, R^{-T} g, by forward
+  // substitution, where g holds the Gram entries of the active dimensions.
+  double sqNorm = activeGram(varInd, n);
+  if (elasticNet)
+    sqNorm += lambda2;
+
+  for (size_t i = 0; i < n; ++i)
+  {
+    double sum = activeGram(activeSet[i], n);
+    for (size_t j = 0; j < i; ++j)
+      sum -= cholFactor(j, i) * cholFactor(j, n);
+    cholFactor(i, n) = sum / cholFactor(i, i);
+    sqNorm -= cholFactor(i, n) * cholFactor(i, n);
+  }
+  cholFactor(n, n) = sqrt(sqNorm);
+
+  isActive[varInd] = true;
+  activeSet.push_back(varInd);
+}
+
+void LARSSolver::Deactivate(const size_t activeVarInd)
+{
+  // Keep the columns of the Gram matrix in the order of the active set.
+  for (size_t i = activeVarInd + 1; i < activeSet.size(); ++i)
+    activeGram.col(i - 1) = activeGram.col(i);
+
+  isActive[activeSet[activeVarInd]] = false;
+  activeSet.erase(activeSet.begin() + activeVarInd);
+}
+
+void LARSSolver::Ignore(const size_t varInd)
+{
+  isIgnored[varInd] = true;
+  ignoreSet.push_back(varInd);
+}
+
+void LARSSolver::CholeskyDelete(const size_t colToKill)
+{
+  const size_t n = activeSet.size();
+
+  // Remove the column; the factor is then upper triangular except for one
+  // subdiagonal entry in each of the following columns.
+  for (size_t k = colToKill; k + 1 < n; ++k)
+    for (size_t i = 0; i <= k + 1; ++i)
+      cholFactor(i, k) = cholFactor(i, k + 1);
+
+  // Zero the subdiagonal entries with Givens rotations of consecutive rows.
+  for (size_t k = colToKill; k + 1 < n; ++k)
+  {
+    const double a = cholFactor(k, k);
+    const double b = cholFactor(k + 1, k);
+    if (b == 0)
+      continue;
+
+    const double r = std::sqrt(a * a + b * b);
+    const double c = a / r;
+    const double s = b / r;
+
+    cholFactor(k, k) = r;
+    cholFactor(k + 1, k) = 0;
+    for (size_t j = k + 1; j + 1 < n; ++j)
+    {
+      const double x = cholFactor(k, j);
+      const double y = cholFactor(k + 1, j);
+      cholFactor(k, j) = c * x + s * y;
+      cholFactor(k + 1, j) = -s * x + c * y;
+    }
+  }
+}
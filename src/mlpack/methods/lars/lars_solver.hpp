@@ -0,0 +1,178 @@
+/**
+ * @file lars_solver.hpp
+ *
+ * Definition of the LARSSolver class, which solves many LASSO or Elastic Net
+ * problems that share one Gram matrix, reusing its workspaces.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_LARS_LARS_SOLVER_HPP
+#define MLPACK_METHODS_LARS_LARS_SOLVER_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace regression {
+
+/**
+ * The LARSSolver runs the same LARS iterations as the LARS class with
+ * Cholesky decomposition (see LARS for the problems that are solved), for
+ * many response vectors and a single Gram matrix X^T X, which is the case of
+ * the coding steps of SparseCoding and LocalCoordinateCoding.
+ *
+ * Unlike the LARS class, the solver only works with the Gram matrix and the
+ * correlations X^T y: the correlations of a whole batch of responses are
+ * computed with a single matrix product, and X is never needed inside the
+ * iterations.  The Cholesky factor of the active Gram matrix, the columns of
+ * the Gram matrix of the active dimensions, and every other vector used by the
+ * iterations are allocated once, when the solver is created, and the Cholesky
+ * factor is updated in place (by substitution when a dimension is added, and
+ * with Givens rotations when one is removed).  No solution path is stored.
+ *
+ * A solver may not be used by several threads at once; to solve in parallel,
+ * use one solver per thread (they may all share the same Gram matrix).
+ */
+class LARSSolver
+{
+ public:
+  /**
+   * Create the solver for the given Gram matrix, which must be valid until the
+   * solver is destroyed.  The Gram matrix should not include the l2-norm
+   * penalty; it is added to the Cholesky factor when needed.
+   *
+   * @param gramMatrix Gram matrix X^T X.
+   * @param lambda1 Regularization parameter for l1-norm penalty.
+   * @param lambda2 Regularization parameter for l2-norm penalty.
+   * @param tolerance Run until the maximum correlation of elements in (X^T y)
+   *     is less than this.
+   */
+  LARSSolver(const arma::mat& gramMatrix,
+             const double lambda1 = 0.0,
+             const double lambda2 = 0.0,
+             const double tolerance = 1e-16);
+
+  /**
+   * Solve the problem for each column of the given responses.  The data
+   * matrix is row-major (each column is a dimension, as with LARS::Train()
+   * and transposeData = false), and the Gram matrix of the solver must be
+   * data^T * data.
+   *
+   * @param data Row-major input data.
+   * @param responses Matrix of targets; each column is a vector of targets.
+   * @param betas Matrix to store the solutions in (one column per column of
+   *     responses).  It may be an alias of existing memory of the right size.
+   */
+  void Solve(const arma::mat& data,
+             const arma::mat& responses,
+             arma::mat& betas);
+
+  /**
+   * Solve the problem for the given correlations X^T y.
+   *
+   * @param correlations Correlations of the dimensions with the targets.
+   * @param beta Vector to store the solution in.
+   */
+  void Solve(const arma::vec& correlations, arma::vec& beta);
+
+  /**
+   * Solve the problem for the data X diag(scales), whose Gram matrix is
+   * diag(scales) X^T X diag(scales), without computing the scaled Gram matrix.
+   * The correlations must be the ones of the scaled data, diag(scales) X^T y.
+   *
+   * @param correlations Correlations of the scaled dimensions with the targets.
+   * @param scales Scale of each dimension.
+   * @param beta Vector to store the solution (for the scaled data) in.
+   */
+  void Solve(const arma::vec& correlations,
+             const arma::vec& scales,
+             arma::vec& beta);
+
+  //! Get the Gram matrix.
+  const arma::mat& GramMatrix() const { return *gram; }
+
+  //! Get the regularization parameter for the l1-norm penalty.
+  double Lambda1() const { return lambda1; }
+  //! Get the regularization parameter for the l2-norm penalty.
+  double Lambda2() const { return lambda2; }
+  //! Get the tolerance for the main loop.
+  double Tolerance() const { return tolerance; }
+
+  //! Get the active set of the last solution.
+  const std::vector<size_t>& ActiveSet() const { return activeSet; }
+
+ private:
+  //! The Gram matrix.
+  const arma::mat* gram;
+
+  //! Regularization parameter for l1 penalty.
+  double lambda1;
+  //! Regularization parameter for l2 penalty.
+  double lambda2;
+  //! Tolerance for main loop.
+  double tolerance;
+
+  //! True if this is the LASSO problem.
+  bool lasso;
+  //! True if this is the elastic net problem.
+  bool elasticNet;
+
+  //! Upper triangular Cholesky factor; only the leading activeSet.size()
+  //! columns are in use.
+  arma::mat cholFactor;
+  //! Columns of the (scaled) Gram matrix of the active dimensions, in the
+  //! order of the active set.
+  arma::mat activeGram;
+
+  //! Active set of dimensions.
+  std::vector<size_t> activeSet;
+  //! Active set membership indicator (for each dimension).
+  std::vector<bool> isActive;
+  //! Set of ignored variables (for dimensions in span{active set dimensions}).
+  std::vector<size_t> ignoreSet;
+  //! Membership indicator for set of ignored variables.
+  std::vector<bool> isIgnored;
+
+  //! Current correlations of the residual with each dimension.
+  arma::vec corr;
+  //! Signs of the correlations of the active dimensions.
+  arma::vec signs;
+  //! Direction of the active coefficients.
+  arma::vec direction;
+  //! Correlations of the direction (in output space) with each dimension.
+  arma::vec gramDirection;
+  //! The active coefficients.
+  arma::vec activeBeta;
+  //! The solution before the last step, to interpolate the last step.
+  arma::vec previousBeta;
+
+  /**
+   * Run LARS for the given correlations, with the Gram matrix scaled by the
+   * given scales (if not NULL).
+   */
+  void Run(const arma::vec& vecXTy,
+           const arma::vec* scales,
+           arma::vec& beta);
+
+  /**
+   * Add the given dimension to the active set: copy its column of the Gram
+   * matrix and add it to the Cholesky factor.
+   */
+  void Activate(const size_t varInd, const arma::vec* scales);
+
+  //! Remove the activeVarInd'th element from the active set.
+  void Deactivate(const size_t activeVarInd);
+
+  //! Add the given dimension to the ignores set (never removed).
+  void Ignore(const size_t varInd);
+
+  //! Remove the given column of the Cholesky factor, in place.
+  void CholeskyDelete(const size_t colToKill);
+};
+
+} // namespace regression
+} // namespace mlpack
+
+#endif
@@ -42,6 +42,14 @@ LinearRegression::LinearRegression(const arma::mat& predictors,
   Train(predictors, responses, weights, intercept);
 }
 
+LinearRegression::LinearRegression(const NormalEquations& equations,
+                                   const double lambda) :
+    lambda(lambda),
+    intercept(equations.Intercept())
+{
+  Train(equations);
+}
+
 LinearRegression::LinearRegression(const LinearRegression& linearRegression) :
     parameters(linearRegression.parameters),
     lambda(linearRegression.lambda)
@@ -127,6 +135,12 @@ void LinearRegression::Train(const arma::mat& predictors,
   }
 }
 
+void LinearRegression::Train(const NormalEquations& equations)
+{
+  intercept = equations.Intercept();
+  equations.Solve(lambda, parameters);
+}
+
 void LinearRegression::Predict(const arma::mat& points, arma::vec& predictions)
     const
 {
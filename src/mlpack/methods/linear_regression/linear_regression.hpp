@@ -14,6 +14,7 @@
 #define MLPACK_METHODS_LINEAR_REGRESSION_LINEAR_REGRESSION_HPP
 
 #include <mlpack/prereqs.hpp>
+#include "normal_equations.hpp"
 
 namespace mlpack {
 namespace regression /** Regression methods. */ {
@@ -69,6 +70,16 @@ class LinearRegression
                    const double lambda = 0,
                    const bool intercept = true);
 
+  /**
+   * Creates the model from the accumulated normal equations of the training
+   * points; see NormalEquations.  Whether or not an intercept term is used is
+   * taken from the normal equations.
+   *
+   * @param equations Normal equations of the training points.
+   * @param lambda Regularization constant for ridge regression.
+   */
+  LinearRegression(const NormalEquations& equations, const double lambda = 0);
+
   /**
    * Copy constructor.
    *
@@ -132,6 +143,18 @@ class LinearRegression
              const arma::rowvec& weights,
              const bool intercept = true);
 
+  /**
+   * Train the LinearRegression model from the accumulated normal equations of
+   * the training points, with the current value of lambda.  This is how models
+   * are trained on datasets that don't fit in memory: the points are given to
+   * NormalEquations::Update() one block at a time.  Solving the normal
+   * equations is less accurate than the QR decomposition used by the other
+   * overloads of Train() when the points are badly conditioned.
+   *
+   * @param equations Normal equations of the training points.
+   */
+  void Train(const NormalEquations& equations);
+
   /**
    * Calculate y_i for each data point in points.
    *
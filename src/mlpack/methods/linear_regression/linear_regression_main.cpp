@@ -11,6 +11,7 @@
  */
 #include <mlpack/prereqs.hpp>
 #include <mlpack/core/util/cli.hpp>
+#include <mlpack/core/data/chunked_reader.hpp>
 #include "linear_regression.hpp"
 
 using namespace mlpack;
@@ -35,7 +36,13 @@ PROGRAM_INFO("Simple Linear Regression and Prediction",
     "and these predicted responses, y', are saved to a file "
     "(--output_predictions).  This type of regression is related to "
     "least-angle regression, which mlpack implements with the 'lars' "
-    "executable.");
+    "executable."
+    "\n\n"
+    "With --block_size (-b), the training set is never loaded: it is read one "
+    "block of points at a time, and the model is found by solving the normal "
+    "equations, (X'X + lambda I) b = X'y, whose terms are accumulated in one "
+    "pass over the blocks (using every core if OpenMP is available).  This is "
+    "less accurate than the default method when X'X is badly conditioned.");
 
 PARAM_MATRIX_IN("training", "Matrix containing training set X (regressors).",
     "t");
@@ -57,6 +64,65 @@ PARAM_COL_OUT("output_predictions", "If --test_file is specified, this "
 PARAM_DOUBLE_IN("lambda", "Tikhonov regularization for ridge regression.  If 0,"
     " the method reduces to linear regression.", "l", 0.0);
 
+PARAM_INT_IN("block_size", "If specified, read the training set in blocks of "
+    "this many points, without loading it, and solve the normal equations.",
+    "b", 0);
+
+//! Train the model on the training file one block at a time, without loading
+//! it.
+void TrainStreaming(const size_t blockSize, LinearRegression& lr)
+{
+  data::ChunkedReader reader(CLI::GetUnmappedParam<mat>("training"),
+      blockSize);
+
+  // Are the responses in a separate file?  If so, they are loaded entirely,
+  // since they are only one number per point.
+  const bool separateResponses = CLI::HasParam("training_responses");
+  rowvec responses;
+  if (separateResponses)
+  {
+    Timer::Start("load_responses");
+    responses = CLI::GetParam<rowvec>("training_responses");
+    Timer::Stop("load_responses");
+
+    if (responses.n_cols != reader.NumPoints())
+      Log::Fatal << "The responses must have the same number of rows as the "
+          "training file." << endl;
+  }
+  else if (reader.Dimensionality() < 2)
+  {
+    Log::Fatal << "The training file must have at least two columns when "
+        << "--training_responses is not specified." << endl;
+  }
+
+  Timer::Start("regression");
+  NormalEquations equations;
+  mat block;
+  size_t offset = 0;
+  while (reader.Next(block))
+  {
+    if (separateResponses)
+    {
+      equations.Update(block, responses.subvec(offset,
+          offset + block.n_cols - 1));
+    }
+    else
+    {
+      // The responses are the last row of the block.
+      equations.Update(block.head_rows(block.n_rows - 1),
+          block.row(block.n_rows - 1));
+    }
+
+    offset += block.n_cols;
+  }
+
+  if (equations.Count() == 0)
+    Log::Fatal << "The training set has no points." << endl;
+
+  lr.Train(equations);
+  Timer::Stop("regression");
+}
+
 int main(int argc, char* argv[])
 {
   // Handle parameters.
@@ -122,8 +188,29 @@ int main(int argc, char* argv[])
         << " specified; no output will be saved!" << endl;
   }
 
+  if (CLI::HasParam("block_size") && CLI::GetParam<int>("block_size") <= 0)
+  {
+    Log::Fatal << "Invalid block size (" << CLI::GetParam<int>("block_size")
+        << "); must be greater than 0." << endl;
+  }
+
+  if (!computeModel && CLI::HasParam("block_size"))
+  {
+    Log::Warn << "--block_size ignored because no model is being trained."
+        << endl;
+  }
+
+  // The training file is read in blocks, so it is never loaded.
+  if (computeModel && CLI::HasParam("block_size"))
+  {
+    TrainStreaming((size_t) CLI::GetParam<int>("block_size"), lr);
+
+    // Save the parameters.
+    if (CLI::HasParam("output_model"))
+      CLI::GetParam<LinearRegression>("output_model") = std::move(lr);
+  }
   // An input file was given and we need to generate the model.
-  if (computeModel)
+  else if (computeModel)
   {
     Timer::Start("load_regressors");
     regressors = std::move(CLI::GetParam<mat>("training"));
@@ -149,7 +236,7 @@ int main(int argc, char* argv[])
     }
 
     Timer::Start("regression");
-    lr = LinearRegression(regressors, responses);
+    lr = LinearRegression(regressors, responses, lambda);
     Timer::Stop("regression");
 
     // Save the parameters.
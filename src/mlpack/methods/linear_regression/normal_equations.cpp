@@ -0,0 +1,260 @@
+/**
+ * @file normal_equations.cpp
+ *
+ * Implementation of NormalEquations.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "normal_equations.hpp"
+#include <mlpack/core/util/log.hpp>
+
+namespace mlpack {
+namespace regression {
+
+NormalEquations::NormalEquations(const bool intercept) :
+    intercept(intercept),
+    count(0),
+    totalWeight(0.0),
+    responseMean(0.0)
+{
+  // Nothing to do.
+}
+
+void NormalEquations::Update(const arma::mat& predictors,
+                             const arma::rowvec& responses)
+{
+  Update(predictors, responses, arma::rowvec());
+}
+
+void NormalEquations::Update(const arma::mat& predictors,
+                             const arma::rowvec& responses,
+                             const arma::rowvec& weights)
+{
+  CheckDimensions(predictors, responses, weights);
+
+  const size_t n = predictors.n_cols;
+  if (n == 0)
+    return;
+
+  // Each thread accumulates its chunks of points into its own object, and the
+  // objects are merged in order at the end.
+  const size_t chunkSize = 4096;
+  const size_t numChunks = (n + chunkSize - 1) / chunkSize;
+
+#ifdef HAS_OPENMP
+  const size_t numThreads = std::min((size_t) omp_get_max_threads(),
+      numChunks);
+#else
+  const size_t numThreads = 1;
+#endif
+
+  std::vector<NormalEquations> partial(numThreads, NormalEquations(intercept));
+
+  #pragma omp parallel num_threads(numThreads)
+  {
+#ifdef HAS_OPENMP
+    const size_t thread = omp_get_thread_num();
+#else
+    const size_t thread = 0;
+#endif
+
+#ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables. If we're building for Visual Studio,
+    // use the intmax_t type instead.
+    #pragma omp for schedule(static)
+    for (intmax_t c = 0; c < (intmax_t) numChunks; ++c)
+#else
+    #pragma omp for schedule(static)
+    for (size_t c = 0; c < numChunks; ++c)
+#endif
+    {
+      const size_t begin = c * chunkSize;
+      const size_t chunk = std::min(chunkSize, n - begin);
+
+      // Alias the chunk of points, responses and weights.
+      const arma::mat chunkPredictors(
+          const_cast<double*>(predictors.colptr(begin)), predictors.n_rows,
+          chunk, false, true);
+      const arma::rowvec chunkResponses(
+          const_cast<double*>(responses.memptr() + begin), chunk, false, true);
+      const arma::rowvec chunkWeights = (weights.n_elem == 0) ?
+          arma::rowvec() : arma::rowvec(
+          const_cast<double*>(weights.memptr() + begin), chunk, false, true);
+
+      partial[thread].Accumulate(chunkPredictors, chunkResponses,
+          chunkWeights);
+    }
+  }
+
+  for (size_t t = 0; t < numThreads; ++t)
+    Merge(partial[t]);
+}
+
+void NormalEquations::Merge(const NormalEquations& other)
+{
+  if (other.intercept != intercept)
+  {
+    throw std::invalid_argument("NormalEquations::Merge(): can't merge "
+        "statistics with and without an intercept term");
+  }
+
+  if (other.totalWeight == 0.0)
+  {
+    count += other.count;
+    return;
+  }
+
+  if (totalWeight == 0.0)
+  {
+    count += other.count;
+    totalWeight = other.totalWeight;
+    mean = other.mean;
+    responseMean = other.responseMean;
+    scatter = other.scatter;
+    responseScatter = other.responseScatter;
+    return;
+  }
+
+  if (other.mean.n_elem != mean.n_elem)
+  {
+    std::ostringstream oss;
+    oss << "NormalEquations::Merge(): dimensionality of the points ("
+        << other.mean.n_elem << ") doesn't match the dimensionality of the "
+        << "statistics (" << mean.n_elem << ")";
+    throw std::invalid_argument(oss.str());
+  }
+
+  const double total = totalWeight + other.totalWeight;
+  const double weight = totalWeight * other.totalWeight / total;
+  const arma::vec delta = other.mean - mean;
+  const double responseDelta = other.responseMean - responseMean;
+
+  scatter += other.scatter + weight * delta * delta.t();
+  responseScatter += other.responseScatter + (weight * responseDelta) * delta;
+  mean += (other.totalWeight / total) * delta;
+  responseMean += (other.totalWeight / total) * responseDelta;
+
+  totalWeight = total;
+  count += other.count;
+}
+
+void NormalEquations::Solve(const double lambda, arma::vec& parameters) const
+{
+  if (totalWeight == 0.0)
+  {
+    throw std::invalid_argument("NormalEquations::Solve(): there are no points "
+        "with a positive weight");
+  }
+
+  // With an intercept, the other parameters only depend on the centered
+  // points; otherwise, X^T W X and X^T W y are found from the centered
+  // statistics and the means.
+  arma::mat a = scatter;
+  arma::vec b = responseScatter;
+  if (!intercept)
+  {
+    a += totalWeight * mean * mean.t();
+    b += (totalWeight * responseMean) * mean;
+  }
+
+  if (lambda != 0.0)
+    a.diag() += lambda;
+
+  arma::vec beta;
+  if (!arma::solve(beta, a, b))
+  {
+    Log::Warn << "NormalEquations::Solve(): the system is singular; using the "
+        << "pseudoinverse.  Consider setting lambda > 0." << std::endl;
+    beta = arma::pinv(a) * b;
+  }
+
+  if (intercept)
+  {
+    parameters.set_size(beta.n_elem + 1);
+    parameters[0] = responseMean - arma::dot(mean, beta);
+    parameters.tail(beta.n_elem) = beta;
+  }
+  else
+  {
+    parameters = beta;
+  }
+}
+
+void NormalEquations::Accumulate(const arma::mat& predictors,
+                                 const arma::rowvec& responses,
+                                 const arma::rowvec& weights)
+{
+  NormalEquations block(intercept);
+  block.count = predictors.n_cols;
+
+  if (weights.n_elem == 0)
+  {
+    block.totalWeight = predictors.n_cols;
+    block.mean = arma::mean(predictors, 1);
+    block.responseMean = arma::mean(responses);
+
+    const arma::mat centered = predictors.each_col() - block.mean;
+    const arma::rowvec centeredResponses = responses - block.responseMean;
+    block.scatter = centered * centered.t();
+    block.responseScatter = centered * centeredResponses.t();
+  }
+  else
+  {
+    block.totalWeight = arma::accu(weights);
+    if (block.totalWeight > 0.0)
+    {
+      block.mean = predictors * weights.t() / block.totalWeight;
+      block.responseMean = arma::dot(responses, weights) / block.totalWeight;
+
+      const arma::mat centered = predictors.each_col() - block.mean;
+      const arma::rowvec centeredResponses = responses - block.responseMean;
+      const arma::mat weighted = centered.each_row() % weights;
+      block.scatter = weighted * centered.t();
+      block.responseScatter = weighted * centeredResponses.t();
+    }
+    else
+    {
+      block.totalWeight = 0.0;
+    }
+  }
+
+  Merge(block);
+}
+
+void NormalEquations::CheckDimensions(const arma::mat& predictors,
+                                      const arma::rowvec& responses,
+                                      const arma::rowvec& weights) const
+{
+  std::ostringstream oss;
+  if (mean.n_elem > 0 && predictors.n_rows != mean.n_elem)
+  {
+    oss << "NormalEquations::Update(): dimensionality of the points ("
+        << predictors.n_rows << ") doesn't match the dimensionality of the "
+        << "statistics (" << mean.n_elem << ")";
+  }
+  else if (responses.n_elem != predictors.n_cols)
+  {
+    oss << "NormalEquations::Update(): number of responses ("
+        << responses.n_elem << ") doesn't match the number of points ("
+        << predictors.n_cols << ")";
+  }
+  else if (weights.n_elem != 0 && weights.n_elem != predictors.n_cols)
+  {
+    oss << "NormalEquations::Update(): number of weights (" << weights.n_elem
+        << ") doesn't match the number of points (" << predictors.n_cols
+        << ")";
+  }
+  else
+  {
+    return;
+  }
+
+  throw std::invalid_argument(oss.str());
+}
+
+} // namespace regression
+} // namespace mlpack
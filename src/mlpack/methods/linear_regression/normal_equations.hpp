@@ -0,0 +1,173 @@
+/**
+ * @file normal_equations.hpp
+ *
+ * Mergeable statistics of the normal equations of (weighted, ridge) linear
+ * regression, accumulated one block of points at a time.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_LINEAR_REGRESSION_NORMAL_EQUATIONS_HPP
+#define MLPACK_METHODS_LINEAR_REGRESSION_NORMAL_EQUATIONS_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace regression {
+
+/**
+ * NormalEquations accumulates what is needed to solve the normal equations of
+ * linear regression, (X^T W X + lambda I) b = X^T W y, in one pass over the
+ * points, which are given one block at a time, so that the dataset never has
+ * to be in memory and is never copied.  For points of dimensionality d, the
+ * state takes O(d^2) memory: the total weight of the points, their weighted
+ * means and the weighted mean of the responses, and the centered scatter
+ * matrices of the points with themselves and with the responses.  The
+ * intercept is handled through the means, so no row of ones is ever added to
+ * the points, and accumulating centered scatter matrices avoids the loss of
+ * precision of X^T X when the points are far from the origin.
+ *
+ * Each block is split between threads, by columns, when OpenMP is available.
+ * Two states are merged with the pairwise update of Chan et al. for the means
+ * and scatter matrices, so the states of separate parts of a dataset can be
+ * accumulated independently (even on different machines) and then merged.
+ *
+ * Solving the normal equations squares the condition number of the problem;
+ * for badly conditioned problems that fit in memory, LinearRegression::Train()
+ * (which uses a QR decomposition) is more accurate.
+ *
+ * @code
+ * data::ChunkedReader reader("large.csv", 100000);
+ * NormalEquations equations;
+ * arma::mat block;
+ * while (reader.Next(block))
+ * {
+ *   // The responses are the last row of each block.
+ *   equations.Update(block.head_rows(block.n_rows - 1),
+ *       block.row(block.n_rows - 1));
+ * }
+ *
+ * LinearRegression lr(equations, 0.1);
+ * @endcode
+ */
+class NormalEquations
+{
+ public:
+  /**
+   * Create the object with no points.
+   *
+   * @param intercept Whether or not the model has an intercept term.
+   */
+  NormalEquations(const bool intercept = true);
+
+  /**
+   * Add the given points (one per column) and their responses.  A
+   * std::invalid_argument is thrown if the dimensionality of the points isn't
+   * the dimensionality of the points already added, or if there isn't one
+   * response per point.
+   *
+   * @param predictors Points to add.
+   * @param responses Responses of the points.
+   */
+  void Update(const arma::mat& predictors, const arma::rowvec& responses);
+
+  /**
+   * Add the given weighted points (one per column) and their responses.  A
+   * std::invalid_argument is thrown if the dimensionality of the points isn't
+   * the dimensionality of the points already added, or if there isn't one
+   * response and one weight per point.
+   *
+   * @param predictors Points to add.
+   * @param responses Responses of the points.
+   * @param weights Nonnegative weights of the points.
+   */
+  void Update(const arma::mat& predictors,
+              const arma::rowvec& responses,
+              const arma::rowvec& weights);
+
+  /**
+   * Merge the statistics of other points into this object.  A
+   * std::invalid_argument is thrown if the dimensionality of their points
+   * isn't the dimensionality of the points already added, or if only one of
+   * the objects has an intercept term.
+   *
+   * @param other Statistics of the other points.
+   */
+  void Merge(const NormalEquations& other);
+
+  /**
+   * Solve the normal equations with the given ridge regularization; the
+   * intercept, if any, isn't penalized.  The parameters are laid out as in
+   * LinearRegression: if there is an intercept, it is the first parameter.
+   *
+   * @param lambda Regularization constant for ridge regression.
+   * @param parameters Vector to store the parameters into.
+   */
+  void Solve(const double lambda, arma::vec& parameters) const;
+
+  //! Get whether or not the model has an intercept term.
+  bool Intercept() const { return intercept; }
+  //! Get the number of points.
+  size_t Count() const { return count; }
+  //! Get the total weight of the points.
+  double TotalWeight() const { return totalWeight; }
+  //! Get the dimensionality of the points (0 if there are no points).
+  size_t Dimensionality() const { return mean.n_elem; }
+  //! Get the weighted mean of the points.
+  const arma::vec& Mean() const { return mean; }
+  //! Get the weighted mean of the responses.
+  double ResponseMean() const { return responseMean; }
+  //! Get the weighted scatter matrix of the centered points.
+  const arma::mat& Scatter() const { return scatter; }
+  //! Get the weighted cross scatter of the centered points and responses.
+  const arma::vec& ResponseScatter() const { return responseScatter; }
+
+  //! Serialize the statistics.
+  template<typename Archive>
+  void Serialize(Archive& ar, const unsigned int /* version */)
+  {
+    ar & data::CreateNVP(intercept, "intercept");
+    ar & data::CreateNVP(count, "count");
+    ar & data::CreateNVP(totalWeight, "totalWeight");
+    ar & data::CreateNVP(mean, "mean");
+    ar & data::CreateNVP(responseMean, "responseMean");
+    ar & data::CreateNVP(scatter, "scatter");
+    ar & data::CreateNVP(responseScatter, "responseScatter");
+  }
+
+ private:
+  //! Whether or not the model has an intercept term.
+  bool intercept;
+  //! The number of points.
+  size_t count;
+  //! The total weight of the points.
+  double totalWeight;
+  //! The weighted mean of the points.
+  arma::vec mean;
+  //! The weighted mean of the responses.
+  double responseMean;
+  //! The weighted scatter matrix of the centered points.
+  arma::mat scatter;
+  //! The weighted cross scatter of the centered points and responses.
+  arma::vec responseScatter;
+
+  /**
+   * Add the given points to the statistics, in the calling thread; weights may
+   * be empty (all the weights are 1).
+   */
+  void Accumulate(const arma::mat& predictors,
+                  const arma::rowvec& responses,
+                  const arma::rowvec& weights);
+
+  //! Check that the given points can be added.
+  void CheckDimensions(const arma::mat& predictors,
+                       const arma::rowvec& responses,
+                       const arma::rowvec& weights) const;
+};
+
+} // namespace regression
+} // namespace mlpack
+
+#endif
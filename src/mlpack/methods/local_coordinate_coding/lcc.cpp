@@ -11,6 +11,7 @@
  */
 #include "lcc.hpp"
 #include <mlpack/core/math/lin_alg.hpp>
+#include <mlpack/methods/neighbor_search/neighbor_search.hpp>
 
 namespace mlpack {
 namespace lcc {
@@ -28,38 +29,112 @@ LocalCoordinateCoding::LocalCoordinateCoding(
   // Nothing to do.
 }
 
-void LocalCoordinateCoding::Encode(const arma::mat& data, arma::mat& codes)
+void LocalCoordinateCoding::Encode(const arma::mat& data,
+                                   arma::mat& codes,
+                                   const size_t neighbors)
 {
-  arma::mat invSqDists = 1.0 / (repmat(trans(sum(square(dictionary))), 1,
-      data.n_cols) + repmat(sum(square(data)), atoms, 1) - 2 * trans(dictionary)
-      * data);
+  // The dictionary of each point is the dictionary with atoms scaled by invW,
+  // the inverse squared distances of the point to the atoms, so the LARS
+  // solvers only need the Gram matrix of the dictionary, scaled for each point.
+  const arma::mat dictGram = trans(dictionary) * dictionary;
 
-  arma::mat dictGram = trans(dictionary) * dictionary;
-  arma::mat dictGramTD(dictGram.n_rows, dictGram.n_cols);
+  codes.zeros(atoms, data.n_cols);
+  Log::Debug << "Encoding " << data.n_cols << " points." << std::endl;
 
-  codes.set_size(atoms, data.n_cols);
-  for (size_t i = 0; i < data.n_cols; i++)
+  if (neighbors == 0 || neighbors >= atoms)
   {
-    // Report progress.
-    if ((i % 100) == 0)
-    {
-      Log::Debug << "Optimization at point " << i << "." << std::endl;
-    }
-
-    arma::vec invW = invSqDists.unsafe_col(i);
-    arma::mat dictPrime = dictionary * diagmat(invW);
+    const arma::rowvec atomNorms = sum(square(dictionary));
 
-    arma::mat dictGramTD = diagmat(invW) * dictGram * diagmat(invW);
+    // The points are encoded in parallel, by blocks of points; the distances
+    // of a block of points to the atoms are computed with a single matrix
+    // product.  Each thread keeps its own LARS solver, so that its workspaces
+    // are reused from one point to the next.
+    const size_t blockSize = 256;
+    const size_t numBlocks = (data.n_cols + blockSize - 1) / blockSize;
 
-    bool useCholesky = false;
-    regression::LARS lars(useCholesky, dictGramTD, 0.5 * lambda);
-
-    // Run LARS for this point, by making an alias of the point and passing
-    // that.
-    arma::vec beta = codes.unsafe_col(i);
-    arma::rowvec responses = data.unsafe_col(i).t();
-    lars.Train(dictPrime, responses, beta, false);
-    beta %= invW; // Remember, beta is an alias of codes.col(i).
+    #pragma omp parallel
+    {
+      regression::LARSSolver solver(dictGram, 0.5 * lambda);
+      arma::mat correlations, invSqDists;
+      arma::vec scaledCorrelations;
+
+#ifdef _WIN32
+      // Tiny workaround: Visual Studio only implements OpenMP 2.0, which
+      // doesn't support unsigned loop variables. If we're building for Visual
+      // Studio, use the intmax_t type instead.
+      #pragma omp for schedule(dynamic)
+      for (intmax_t b = 0; b < (intmax_t) numBlocks; ++b)
+#else
+      #pragma omp for schedule(dynamic)
+      for (size_t b = 0; b < numBlocks; ++b)
+#endif
+      {
+        const size_t begin = b * blockSize;
+        const size_t count = std::min(blockSize, (size_t) data.n_cols - begin);
+        const arma::mat points(const_cast<double*>(data.colptr(begin)),
+            data.n_rows, count, false, true);
+
+        correlations = trans(dictionary) * points;
+        invSqDists = -2 * correlations;
+        invSqDists.each_col() += trans(atomNorms);
+        invSqDists.each_row() += sum(square(points));
+        invSqDists = 1.0 / invSqDists;
+
+        for (size_t i = 0; i < count; ++i)
+        {
+          arma::vec invW = invSqDists.unsafe_col(i);
+          scaledCorrelations = correlations.unsafe_col(i) % invW;
+
+          // Run LARS for this point, by making an alias of the code and
+          // passing that.
+          arma::vec beta = codes.unsafe_col(begin + i);
+          solver.Solve(scaledCorrelations, invW, beta);
+          beta %= invW; // Remember, beta is an alias of codes.col(i).
+        }
+      }
+    }
+  }
+  else
+  {
+    // Only the nearest atoms of each point are used, so each point has a much
+    // smaller LARS problem.  The nearest atoms are found with a tree.
+    arma::Mat<size_t> neighborIndices;
+    arma::mat distances;
+    neighbor::KNN knn(dictionary);
+    knn.Search(data, neighbors, neighborIndices, distances);
+
+    #pragma omp parallel
+    {
+      // The Gram matrix of the nearest atoms of the current point; the solver
+      // refers to it, so it is overwritten for each point.
+      arma::mat localGram(neighbors, neighbors);
+      regression::LARSSolver solver(localGram, 0.5 * lambda);
+      arma::vec invW(neighbors), scaledCorrelations(neighbors), beta;
+
+#ifdef _WIN32
+      #pragma omp for schedule(dynamic, 64)
+      for (intmax_t i = 0; i < (intmax_t) data.n_cols; ++i)
+#else
+      #pragma omp for schedule(dynamic, 64)
+      for (size_t i = 0; i < data.n_cols; ++i)
+#endif
+      {
+        const size_t* indices = neighborIndices.colptr(i);
+        for (size_t a = 0; a < neighbors; ++a)
+        {
+          for (size_t b = 0; b < neighbors; ++b)
+            localGram(a, b) = dictGram(indices[a], indices[b]);
+
+          invW[a] = 1.0 / (distances(a, i) * distances(a, i));
+          scaledCorrelations[a] = invW[a] *
+              dot(dictionary.col(indices[a]), data.col(i));
+        }
+
+        solver.Solve(scaledCorrelations, invW, beta);
+        for (size_t a = 0; a < neighbors; ++a)
+          codes(indices[a], i) = beta[a] * invW[a];
+      }
+    }
   }
 }
 
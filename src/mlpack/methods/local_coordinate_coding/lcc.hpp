@@ -15,6 +15,7 @@
 
 #include <mlpack/prereqs.hpp>
 #include <mlpack/methods/lars/lars.hpp>
+#include <mlpack/methods/lars/lars_solver.hpp>
 
 // Include three simple dictionary initializers from sparse coding.
 #include "../sparse_coding/nothing_initializer.hpp"
@@ -145,12 +146,20 @@ class LocalCoordinateCoding
                  DictionaryInitializer());
 
   /**
-   * Code each point via distance-weighted LARS.
+   * Code each point via distance-weighted LARS.  The points are coded in
+   * parallel when OpenMP is available.  If neighbors is not 0, only the given
+   * number of nearest atoms of each point (found with a tree) may have nonzero
+   * coefficients in its code; this approximation makes each LARS problem much
+   * smaller when there are many atoms.
    *
    * @param data Matrix containing points to encode.
    * @param codes Output matrix to store codes in.
+   * @param neighbors Number of nearest atoms used to code each point (0 uses
+   *     all the atoms).
    */
-  void Encode(const arma::mat& data, arma::mat& codes);
+  void Encode(const arma::mat& data,
+              arma::mat& codes,
+              const size_t neighbors = 0);
 
   /**
    * Learn dictionary by solving linear system.
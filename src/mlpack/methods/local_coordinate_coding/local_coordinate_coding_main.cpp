@@ -50,7 +50,11 @@ PROGRAM_INFO("Local Coordinate Coding",
     "\n\n"
     "The maximum number of iterations may be specified with the -n option. "
     "Optionally, the input data matrix X can be normalized before coding with "
-    "the -N option.");
+    "the -N option."
+    "\n\n"
+    "Test points given with -T are coded in parallel.  With many atoms, the "
+    "--neighbors (-K) option codes each test point with only its nearest "
+    "atoms, which is much faster.");
 
 // Training parameters.
 PARAM_MATRIX_IN("training", "Matrix of training data (X).", "t");
@@ -71,6 +75,8 @@ PARAM_MODEL_OUT(LocalCoordinateCoding, "output_model", "Output for trained LCC "
 
 // Test on another dataset.
 PARAM_MATRIX_IN("test", "Test points to encode.", "T");
+PARAM_INT_IN("neighbors", "If nonzero, code each test point with only this "
+    "many nearest atoms.", "K", 0);
 PARAM_MATRIX_OUT("dictionary", "Output dictionary matrix.", "d");
 PARAM_MATRIX_OUT("codes", "Output codes matrix.", "c");
 
@@ -209,8 +215,12 @@ int main(int argc, char* argv[])
         matY.col(i) /= norm(matY.col(i), 2);
     }
 
+    if (CLI::GetParam<int>("neighbors") < 0)
+      Log::Fatal << "Number of neighbors (--neighbors) must be nonnegative!"
+          << endl;
+
     mat codes;
-    lcc.Encode(matY, codes);
+    lcc.Encode(matY, codes, (size_t) CLI::GetParam<int>("neighbors"));
 
     if (CLI::HasParam("codes"))
       CLI::GetParam<mat>("codes") = std::move(codes);
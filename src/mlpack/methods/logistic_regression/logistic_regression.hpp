@@ -252,6 +252,17 @@ class LogisticRegression
   arma::vec parameters;
   //! L2-regularization penalty parameter.
   double lambda;
+
+  /**
+   * Compute the probability that each of the given points has label 1.  The
+   * points are split into blocks, which are scored in parallel when OpenMP is
+   * available.
+   *
+   * @param dataset Set of points to score.
+   * @param probabilities Probability of label 1 for each point (output).
+   */
+  void ComputeProbabilities(const MatType& dataset,
+                            arma::rowvec& probabilities) const;
 };
 
 } // namespace regression
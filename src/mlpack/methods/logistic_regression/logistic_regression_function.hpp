@@ -37,6 +37,57 @@ class LogisticRegressionFunction
                              const arma::vec& initialPoint,
                              const double lambda = 0);
 
+  /**
+   * Evaluate the gradient of the logistic regression log-likelihood function
+   * with respect to only one point in the dataset, as a sparse vector that is
+   * nonzero only for the intercept and the nonzero features of the point; it
+   * takes O(nnz) time, which is useful on sparse data for optimizers such as
+   * HogwildSGD.  The regularization term is only applied to the parameters of
+   * the nonzero features, so this is not the same as the dense separable
+   * gradient unless lambda is 0.
+   *
+   * @param parameters Vector of logistic regression parameters.
+   * @param i Index of points to use for objective function gradient evaluation.
+   * @param gradient Sparse vector to output gradient into.
+   */
+  void Gradient(const arma::mat& parameters,
+                const size_t i,
+                arma::sp_mat& gradient) const;
+
+  /**
+   * Return the scalar of the gradient of the log-likelihood of the given
+   * point: the gradient of its data term is this scalar times the point with
+   * a leading 1 for the intercept.  This lets SAGA store its table of
+   * gradients as one scalar per point.
+   *
+   * @param parameters Vector of logistic regression parameters.
+   * @param i Index of the point.
+   */
+  double LinearGradient(const arma::mat& parameters, const size_t i) const;
+
+  /**
+   * Add the given multiple of the point (with a leading 1 for the intercept)
+   * to the gradient; see LinearGradient().
+   *
+   * @param i Index of the point.
+   * @param scale Multiple of the point to add.
+   * @param gradient Vector to add the point to.
+   */
+  void AddLinearGradient(const size_t i,
+                         const double scale,
+                         arma::mat& gradient) const;
+
+  /**
+   * Evaluate the gradient of the share of the regularization term of one
+   * point, so that the separable gradient of point i is this plus
+   * LinearGradient(parameters, i) times the point.
+   *
+   * @param parameters Vector of logistic regression parameters.
+   * @param gradient Vector to output gradient into.
+   */
+  void RegularizationGradient(const arma::mat& parameters,
+                              arma::mat& gradient) const;
+
   //! Return the initial point for the optimization.
   const arma::mat& InitialPoint() const { return initialPoint; }
   //! Modify the initial point for the optimization.
@@ -81,6 +132,20 @@ class LogisticRegressionFunction
    */
   double Evaluate(const arma::mat& parameters, const size_t i) const;
 
+  /**
+   * Evaluate the logistic regression log-likelihood function with the given
+   * parameters, using only the points [begin, begin + batchSize).  This is the
+   * sum of the separable objectives of those points, computed with one matrix
+   * product, and is used by the SGD-family optimizers when present.
+   *
+   * @param parameters Vector of logistic regression parameters.
+   * @param begin Index of the first point of the batch.
+   * @param batchSize Number of points of the batch.
+   */
+  double Evaluate(const arma::mat& parameters,
+                  const size_t begin,
+                  const size_t batchSize) const;
+
   /**
    * Evaluate the gradient of the logistic regression log-likelihood function
    * with the given parameters.
@@ -104,6 +169,38 @@ class LogisticRegressionFunction
                 const size_t i,
                 arma::mat& gradient) const;
 
+  /**
+   * Evaluate the gradient of the logistic regression log-likelihood function
+   * with the given parameters, with respect to the points
+   * [begin, begin + batchSize).  This is the sum of the separable gradients of
+   * those points, computed with matrix products.
+   *
+   * @param parameters Vector of logistic regression parameters.
+   * @param begin Index of the first point of the batch.
+   * @param gradient Vector to output gradient into.
+   * @param batchSize Number of points of the batch.
+   */
+  void Gradient(const arma::mat& parameters,
+                const size_t begin,
+                arma::mat& gradient,
+                const size_t batchSize) const;
+
+  /**
+   * Evaluate the objective and the gradient of the logistic regression
+   * log-likelihood function on the points [begin, begin + batchSize) at once;
+   * the sigmoids of the points are computed only once for both.  The gradient
+   * is stored in the given matrix and the objective is returned.
+   *
+   * @param parameters Vector of logistic regression parameters.
+   * @param begin Index of the first point of the batch.
+   * @param gradient Vector to output gradient into.
+   * @param batchSize Number of points of the batch.
+   */
+  double EvaluateWithGradient(const arma::mat& parameters,
+                              const size_t begin,
+                              arma::mat& gradient,
+                              const size_t batchSize) const;
+
   //! Return the initial point for the optimization.
   const arma::mat& GetInitialPoint() const { return initialPoint; }
 
@@ -119,6 +216,13 @@ class LogisticRegressionFunction
   const arma::Row<size_t>& responses;
   //! The regularization parameter for L2-regularization.
   double lambda;
+
+  /**
+   * Compute the negative log-likelihood of a point, given the exponent of its
+   * sigmoid (w^T x + b) and its response, without overflow or loss of
+   * precision for large exponents.
+   */
+  static double LogLoss(const double exponent, const size_t response);
 };
 
 } // namespace regression
@@ -75,11 +75,11 @@ double LogisticRegressionFunction<MatType>::Evaluate(
       arma::dot(parameters.col(0).subvec(1, parameters.n_elem - 1),
                 parameters.col(0).subvec(1, parameters.n_elem - 1));
 
-  // Calculate vectors of sigmoids.  The intercept term is parameters(0, 0) and
-  // does not need to be multiplied by any of the predictors.
-  const arma::vec exponents = parameters(0, 0) + predictors.t() *
-      parameters.col(0).subvec(1, parameters.n_elem - 1);
-  const arma::vec sigmoid = 1.0 / (1.0 + arma::exp(-exponents));
+  // Calculate the exponents of the sigmoids.  The intercept term is
+  // parameters(0, 0) and does not need to be multiplied by any of the
+  // predictors.
+  const arma::rowvec exponents = parameters(0, 0) +
+      parameters.col(0).subvec(1, parameters.n_elem - 1).t() * predictors;
 
   // Assemble full objective function.  Often the objective function and the
   // regularization as given are divided by the number of features, but this
@@ -87,15 +87,9 @@ double LogisticRegressionFunction<MatType>::Evaluate(
   // terms for computational efficiency.
   double result = 0.0;
   for (size_t i = 0; i < responses.n_elem; ++i)
-  {
-    if (responses[i] == 1)
-      result += log(sigmoid[i]);
-    else
-      result += log(1.0 - sigmoid[i]);
-  }
+    result += LogLoss(exponents[i], responses[i]);
 
-  // Invert the result, because it's a minimization.
-  return -result + regularization;
+  return result + regularization;
 }
 
 /**
@@ -114,15 +108,39 @@ double LogisticRegressionFunction<MatType>::Evaluate(
       arma::dot(parameters.col(0).subvec(1, parameters.n_elem - 1),
                 parameters.col(0).subvec(1, parameters.n_elem - 1));
 
-  // Calculate sigmoid.
   const double exponent = parameters(0, 0) + arma::dot(predictors.col(i),
       parameters.col(0).subvec(1, parameters.n_elem - 1));
-  const double sigmoid = 1.0 / (1.0 + std::exp(-exponent));
 
-  if (responses[i] == 1)
-    return -log(sigmoid) + regularization;
-  else
-    return -log(1.0 - sigmoid) + regularization;
+  return LogLoss(exponent, responses[i]) + regularization;
+}
+
+/**
+ * Evaluate the logistic regression objective function on a batch of points.
+ * This is the sum of the separable objectives of the points.
+ */
+template<typename MatType>
+double LogisticRegressionFunction<MatType>::Evaluate(
+    const arma::mat& parameters,
+    const size_t begin,
+    const size_t batchSize) const
+{
+  // Each point has its share of the regularization term.
+  const double regularization = lambda *
+      (batchSize / (2.0 * predictors.n_cols)) *
+      arma::dot(parameters.col(0).subvec(1, parameters.n_elem - 1),
+                parameters.col(0).subvec(1, parameters.n_elem - 1));
+
+  // One matrix-vector product gives the exponents of the whole batch.
+  const size_t end = begin + batchSize - 1;
+  const arma::rowvec exponents = parameters(0, 0) +
+      parameters.col(0).subvec(1, parameters.n_elem - 1).t() *
+      predictors.cols(begin, end);
+
+  double result = 0.0;
+  for (size_t i = 0; i < batchSize; ++i)
+    result += LogLoss(exponents[i], responses[begin + i]);
+
+  return result + regularization;
 }
 
 //! Evaluate the gradient of the logistic regression objective function.
@@ -170,6 +188,158 @@ void LogisticRegressionFunction<MatType>::Gradient(
       * (responses[i] - sigmoid) + regularization;
 }
 
+/**
+ * Evaluate the gradient of the logistic regression objective function with
+ * respect to a batch of points.  This is the sum of the separable gradients of
+ * the points.
+ */
+template<typename MatType>
+void LogisticRegressionFunction<MatType>::Gradient(
+    const arma::mat& parameters,
+    const size_t begin,
+    arma::mat& gradient,
+    const size_t batchSize) const
+{
+  // Each point has its share of the regularization term.
+  arma::mat regularization;
+  regularization = lambda * parameters.col(0).subvec(1, parameters.n_elem - 1)
+      * batchSize / predictors.n_cols;
+
+  const size_t end = begin + batchSize - 1;
+  const arma::rowvec errors = arma::conv_to<arma::rowvec>::from(
+      responses.subvec(begin, end)) - (1 / (1 + arma::exp(-parameters(0, 0)
+      - parameters.col(0).subvec(1, parameters.n_elem - 1).t() *
+      predictors.cols(begin, end))));
+
+  gradient.set_size(parameters.n_elem);
+  gradient[0] = -arma::accu(errors);
+  gradient.col(0).subvec(1, parameters.n_elem - 1) =
+      -predictors.cols(begin, end) * errors.t() + regularization;
+}
+
+/**
+ * Evaluate the logistic regression objective function and its gradient on a
+ * batch of points, with one computation of the sigmoids.
+ */
+template<typename MatType>
+double LogisticRegressionFunction<MatType>::EvaluateWithGradient(
+    const arma::mat& parameters,
+    const size_t begin,
+    arma::mat& gradient,
+    const size_t batchSize) const
+{
+  // Each point has its share of the regularization term.
+  const double share = lambda * batchSize / predictors.n_cols;
+  const double regularization = 0.5 * share *
+      arma::dot(parameters.col(0).subvec(1, parameters.n_elem - 1),
+                parameters.col(0).subvec(1, parameters.n_elem - 1));
+
+  const size_t end = begin + batchSize - 1;
+  const arma::rowvec exponents = parameters(0, 0) +
+      parameters.col(0).subvec(1, parameters.n_elem - 1).t() *
+      predictors.cols(begin, end);
+  const arma::rowvec sigmoids = 1.0 / (1.0 + arma::exp(-exponents));
+
+  double result = 0.0;
+  for (size_t i = 0; i < batchSize; ++i)
+    result += LogLoss(exponents[i], responses[begin + i]);
+
+  const arma::rowvec errors = arma::conv_to<arma::rowvec>::from(
+      responses.subvec(begin, end)) - sigmoids;
+
+  gradient.set_size(parameters.n_elem);
+  gradient[0] = -arma::accu(errors);
+  gradient.col(0).subvec(1, parameters.n_elem - 1) =
+      -predictors.cols(begin, end) * errors.t() +
+      share * parameters.col(0).subvec(1, parameters.n_elem - 1);
+
+  return result + regularization;
+}
+
+/**
+ * Evaluate the gradient of the logistic regression objective function with
+ * respect to one point, touching only the nonzero features of the point.
+ */
+template<typename MatType>
+void LogisticRegressionFunction<MatType>::Gradient(
+    const arma::mat& parameters,
+    const size_t i,
+    arma::sp_mat& gradient) const
+{
+  const arma::sp_mat point(predictors.col(i));
+
+  double dot = parameters(0, 0);
+  for (arma::sp_mat::const_iterator it = point.begin(); it != point.end();
+      ++it)
+    dot += (*it) * parameters(it.row() + 1, 0);
+
+  const double error = responses[i] - 1.0 / (1.0 + std::exp(-dot));
+
+  arma::umat locations(2, point.n_nonzero + 1, arma::fill::zeros);
+  arma::vec values(point.n_nonzero + 1);
+  values[0] = -error;
+
+  size_t j = 1;
+  for (arma::sp_mat::const_iterator it = point.begin(); it != point.end();
+      ++it, ++j)
+  {
+    locations(0, j) = it.row() + 1;
+    values[j] = -(*it) * error + lambda * parameters(it.row() + 1, 0) /
+        predictors.n_cols;
+  }
+
+  gradient = arma::sp_mat(locations, values, parameters.n_elem, 1);
+}
+
+/**
+ * The negative log-likelihood of a point is log(1 + exp(-z)) if its response
+ * is 1 and log(1 + exp(z)) otherwise, where z is the exponent of the sigmoid.
+ * Computing it from the sigmoid gives log(0) = -inf once the sigmoid rounds to
+ * 0 or 1, so with x = -z or x = z it is computed as
+ * max(x, 0) + log(1 + exp(-|x|)), whose exponential can't overflow.
+ */
+template<typename MatType>
+inline double LogisticRegressionFunction<MatType>::LogLoss(
+    const double exponent,
+    const size_t response)
+{
+  const double x = (response == 1) ? -exponent : exponent;
+  return std::max(x, 0.0) + std::log1p(std::exp(-std::abs(x)));
+}
+
+template<typename MatType>
+double LogisticRegressionFunction<MatType>::LinearGradient(
+    const arma::mat& parameters,
+    const size_t i) const
+{
+  const double sigmoid = 1.0 / (1.0 + std::exp(-parameters(0, 0)
+      - arma::dot(predictors.col(i), parameters.col(0).subvec(1,
+      parameters.n_elem - 1))));
+
+  return -(responses[i] - sigmoid);
+}
+
+template<typename MatType>
+void LogisticRegressionFunction<MatType>::AddLinearGradient(
+    const size_t i,
+    const double scale,
+    arma::mat& gradient) const
+{
+  gradient[0] += scale;
+  gradient.col(0).subvec(1, gradient.n_elem - 1) += scale * predictors.col(i);
+}
+
+template<typename MatType>
+void LogisticRegressionFunction<MatType>::RegularizationGradient(
+    const arma::mat& parameters,
+    arma::mat& gradient) const
+{
+  gradient.set_size(parameters.n_elem, 1);
+  gradient[0] = 0;
+  gradient.col(0).subvec(1, parameters.n_elem - 1) = lambda *
+      parameters.col(0).subvec(1, parameters.n_elem - 1) / predictors.n_cols;
+}
+
 } // namespace regression
 } // namespace mlpack
 
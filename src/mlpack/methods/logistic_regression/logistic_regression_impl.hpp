@@ -127,11 +127,12 @@ void LogisticRegression<MatType>::Classify(const MatType& dataset,
                                            arma::Row<size_t>& labels,
                                            const double decisionBoundary) const
 {
-  // Calculate sigmoid function for each point.  The (1.0 - decisionBoundary)
-  // term correctly sets an offset so that floor() returns 0 or 1 correctly.
-  labels = arma::conv_to<arma::Row<size_t>>::from((1.0 /
-      (1.0 + arma::exp(-parameters(0) - dataset.t() *
-      parameters.subvec(1, parameters.n_elem - 1)))) +
+  arma::rowvec probabilities;
+  ComputeProbabilities(dataset, probabilities);
+
+  // The (1.0 - decisionBoundary) term correctly sets an offset so that floor()
+  // returns 0 or 1 correctly.
+  labels = arma::conv_to<arma::Row<size_t>>::from(probabilities +
       (1.0 - decisionBoundary));
 }
 
@@ -139,12 +140,13 @@ template<typename MatType>
 void LogisticRegression<MatType>::Classify(const MatType& dataset,
                                            arma::mat& probabilities) const
 {
+  arma::rowvec positive;
+  ComputeProbabilities(dataset, positive);
+
   // Set correct size of output matrix.
   probabilities.set_size(2, dataset.n_cols);
-
-  probabilities.row(1) = 1.0 / (1.0 + arma::exp(-parameters(0) - dataset.t() *
-      parameters.subvec(1, parameters.n_elem - 1))).t();
-  probabilities.row(0) = 1.0 - probabilities.row(1);
+  probabilities.row(1) = positive;
+  probabilities.row(0) = 1.0 - positive;
 }
 
 template<typename MatType>
@@ -153,7 +155,7 @@ double LogisticRegression<MatType>::ComputeError(
     const arma::Row<size_t>& responses) const
 {
   // Construct a new error function.
-  LogisticRegressionFunction<> newErrorFunction(predictors, responses,
+  LogisticRegressionFunction<MatType> newErrorFunction(predictors, responses,
       lambda);
 
   return newErrorFunction.Evaluate(parameters);
@@ -170,16 +172,44 @@ double LogisticRegression<MatType>::ComputeAccuracy(
   Classify(predictors, tempResponses, decisionBoundary);
 
   // Count the number of responses that were correct.
-  size_t count = 0;
-  for (size_t i = 0; i < responses.n_elem; i++)
-  {
-    if (responses(i) == tempResponses(i))
-      count++;
-  }
+  const size_t count = arma::accu(responses == tempResponses);
 
   return (double) (count * 100) / responses.n_elem;
 }
 
+template<typename MatType>
+void LogisticRegression<MatType>::ComputeProbabilities(
+    const MatType& dataset,
+    arma::rowvec& probabilities) const
+{
+  probabilities.set_size(dataset.n_cols);
+
+  // Each block of points is scored with one matrix-vector product, and the
+  // blocks are split between the threads.
+  const size_t blockSize = 4096;
+  const size_t numBlocks = (dataset.n_cols + blockSize - 1) / blockSize;
+  const arma::vec weights(const_cast<double*>(parameters.memptr() + 1),
+      parameters.n_elem - 1, false, true);
+
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables. If we're building for Visual Studio, use
+  // the intmax_t type instead.
+  #pragma omp parallel for schedule(static)
+  for (intmax_t b = 0; b < (intmax_t) numBlocks; ++b)
+#else
+  #pragma omp parallel for schedule(static)
+  for (size_t b = 0; b < numBlocks; ++b)
+#endif
+  {
+    const size_t begin = b * blockSize;
+    const size_t end = std::min(begin + blockSize, (size_t) dataset.n_cols) - 1;
+
+    probabilities.subvec(begin, end) = 1.0 / (1.0 + arma::exp(-parameters(0) -
+        weights.t() * dataset.cols(begin, end)));
+  }
+}
+
 template<typename MatType>
 template<typename Archive>
 void LogisticRegression<MatType>::Serialize(
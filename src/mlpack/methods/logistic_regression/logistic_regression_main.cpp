@@ -15,6 +15,9 @@
 
 #include <mlpack/core/optimizers/sgd/sgd.hpp>
 #include <mlpack/core/optimizers/minibatch_sgd/minibatch_sgd.hpp>
+#ifdef HAS_MPI
+  #include <mlpack/core/optimizers/distributed/distributed_function.hpp>
+#endif
 
 using namespace std;
 using namespace mlpack;
@@ -72,13 +75,35 @@ PROGRAM_INFO("L2-regularized Logistic Regression and Prediction",
     "\n\n"
     "This implementation of logistic regression does not support the general "
     "multi-class case but instead only the two-class case.  Any responses must "
-    "be either 0 or 1.");
+    "be either 0 or 1."
+    "\n\n"
+    "If mlpack is built with MPI (USE_MPI), the training set can be split "
+    "across the ranks with the --training_chunks (-c) option, which gives one "
+    "file per rank (with the labels as the last dimension); rank i loads only "
+    "the i'th file.  The model is then trained with 'lbfgs' or "
+    "'minibatch-sgd' on all the chunks at once, each rank computing the "
+    "objective and gradient of its own chunk.  Only rank 0 logs, predicts and "
+    "saves output."
+    "\n\n"
+    "With --sparse (-S), the training and test sets are loaded as sparse "
+    "matrices, and training and prediction take time linear in their number "
+    "of nonzero values.  Sparse matrices can be given as sparse ARFF files "
+    "(.arff), as coordinate lists with a 'point feature value' line per "
+    "nonzero value (.txt, .tsv or .coo), or as Armadillo binary sparse "
+    "matrices (.bin).  Models trained on sparse data can be used with dense "
+    "data, and the other way around.");
 
 // Training parameters.
 PARAM_MATRIX_IN("training", "A matrix containing the training set (the matrix "
     "of predictors, X).", "t");
 PARAM_UROW_IN("labels", "A matrix containing labels (0 or 1) for the points "
     "in the training set (y).", "l");
+PARAM_FLAG("sparse", "Load the training and test sets as sparse matrices.",
+    "S");
+#ifdef HAS_MPI
+PARAM_VECTOR_IN(string, "training_chunks", "Files holding the chunk of the "
+    "training set (with the labels as last dimension) of each MPI rank.", "c");
+#endif
 
 // Optimizer parameters.
 PARAM_DOUBLE_IN("lambda", "L2-regularization parameter for training.", "L",
@@ -110,11 +135,29 @@ PARAM_DOUBLE_IN("decision_boundary", "Decision boundary for prediction; if the "
     "logistic function for a point is less than the boundary, the class is "
     "taken to be 0; otherwise, the class is 1.", "d", 0.5);
 
-int main(int argc, char** argv)
+//! Load the matrix of the given parameter.
+void LoadMatrix(const string& name, arma::mat& matrix)
 {
-  CLI::ParseCommandLine(argc, argv);
+  matrix = std::move(CLI::GetParam<arma::mat>(name));
+}
 
-  // Collect command-line options.
+//! Load the matrix of the given parameter as a sparse matrix, from its file.
+void LoadMatrix(const string& name, arma::sp_mat& matrix)
+{
+  data::Load(CLI::GetUnmappedParam<arma::mat>(name), matrix, true);
+}
+
+/**
+ * Train the model (if a training set is given) and classify the test set (if
+ * any), with dense or sparse data.  The model is kept as a
+ * LogisticRegression<>, so that models trained on sparse data can be used with
+ * dense data and the other way around.
+ */
+template<typename MatType>
+void TrainAndClassify(LogisticRegression<>& model,
+                      const bool isRoot,
+                      const bool distributed)
+{
   const double lambda = CLI::GetParam<double>("lambda");
   const string optimizerType = CLI::GetParam<string>("optimizer");
   const double tolerance = CLI::GetParam<double>("tolerance");
@@ -123,80 +166,34 @@ int main(int argc, char** argv)
   const size_t maxIterations = (size_t) CLI::GetParam<int>("max_iterations");
   const double decisionBoundary = CLI::GetParam<double>("decision_boundary");
 
-  // One of inputFile and modelFile must be specified.
-  if (!CLI::HasParam("training") && !CLI::HasParam("input_model"))
-    Log::Fatal << "One of --input_model_file or --training_file must be "
-        << "specified." << endl;
-
-  // If no output file is given, the user should know that the model will not be
-  // saved, but only if a model is being trained.
-  if (!CLI::HasParam("output_model") && CLI::HasParam("training"))
-    Log::Warn << "--output_model_file not given; trained model will not be "
-        << "saved." << endl;
-
-  if (CLI::HasParam("test") && !CLI::HasParam("output") &&
-      !CLI::HasParam("output_probabilities"))
-    Log::Warn << "--test_file specified, but neither --output_file nor "
-        << "--output_probabilities_file are specified; no test "
-        << "output will be saved!" << endl;
-
-  if (CLI::HasParam("output") && !CLI::HasParam("test"))
-    Log::Warn << "--output_file ignored because --test_file is not specified."
-        << endl;
-
-  if (CLI::HasParam("output_probabilities") && !CLI::HasParam("test"))
-    Log::Warn << "--output_probabilities_file ignored because --test_file is "
-        << "not specified." << endl;
-
-  // Tolerance needs to be positive.
-  if (tolerance < 0.0)
-    Log::Fatal << "Tolerance must be positive (received " << tolerance << ")."
-        << endl;
-
-  // Optimizer has to be L-BFGS or SGD.
-  if (optimizerType != "lbfgs" && optimizerType != "sgd" &&
-      optimizerType != "minibatch-sgd")
-    Log::Fatal << "--optimizer must be 'lbfgs', 'sgd', or 'minibatch-sgd'."
-        << endl;
-
-  // Lambda must be positive.
-  if (lambda < 0.0)
-    Log::Fatal << "L2-regularization parameter (--lambda) must be positive ("
-        << "received " << lambda << ")." << endl;
-
-  // Decision boundary must be between 0 and 1.
-  if (decisionBoundary < 0.0 || decisionBoundary > 1.0)
-    Log::Fatal << "Decision boundary (--decision_boundary) must be between 0.0 "
-        << "and 1.0 (received " << decisionBoundary << ")." << endl;
-
-  if ((stepSize < 0.0) &&
-      (optimizerType == "sgd" || optimizerType == "minibatch-sgd"))
-    Log::Fatal << "Step size (--step_size) must be positive (received "
-        << stepSize << ")." << endl;
-
-  if (CLI::HasParam("step_size") && optimizerType == "lbfgs")
-    Log::Warn << "Step size (--step_size) ignored because 'sgd' optimizer is "
-        << "not being used." << endl;
-
-  if (CLI::HasParam("batch_size") && optimizerType != "minibatch-sgd")
-    Log::Warn << "Batch size (--batch_size) ignored because 'minibatch-sgd' "
-        << "optimizer is not being used." << endl;
+#ifdef HAS_MPI
+  int rank, numRanks;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &numRanks);
+#endif
 
   // These are the matrices we might use.
-  arma::mat regressors;
+  MatType regressors;
   arma::Row<size_t> responses;
-  arma::mat testSet;
+  MatType testSet;
   arma::Row<size_t> predictions;
 
   // Load data matrix.
   if (CLI::HasParam("training"))
-    regressors = std::move(CLI::GetParam<arma::mat>("training"));
+    LoadMatrix("training", regressors);
+#ifdef HAS_MPI
+  if (distributed)
+  {
+    // Each rank loads its own chunk; the labels are the last dimension.
+    const string chunkFile =
+        CLI::GetParam<vector<string>>("training_chunks")[rank];
+    if (!data::Load(chunkFile, regressors))
+      Log::Fatal << "Rank " << rank << " could not load training chunk '"
+          << chunkFile << "'!" << endl;
+  }
+#endif
 
-  // Load the model, if necessary.
-  LogisticRegression<> model(0, 0); // Empty model.
-  if (CLI::HasParam("input_model"))
-    model = std::move(CLI::GetParam<LogisticRegression<>>("input_model"));
-  else
+  if (!CLI::HasParam("input_model"))
   {
     // Set the size of the parameters vector, if necessary.
     if (!CLI::HasParam("labels"))
@@ -213,47 +210,98 @@ int main(int argc, char** argv)
       Log::Fatal << "The labels (--labels_file) must have the same number of "
           << "points as the training dataset (--training_file)." << endl;
   }
-  else if (CLI::HasParam("training"))
+  else if (CLI::HasParam("training") || distributed)
   {
     // The initial predictors for y, Nx1.
     responses = arma::conv_to<arma::Row<size_t>>::from(
-        regressors.row(regressors.n_rows - 1));
+        arma::mat(regressors.row(regressors.n_rows - 1)));
     regressors.shed_row(regressors.n_rows - 1);
   }
 
   // Verify the labels.
-  if (CLI::HasParam("training") && max(responses) > 1)
+  if ((CLI::HasParam("training") || distributed) && max(responses) > 1)
     Log::Fatal << "The labels must be either 0 or 1, not " << max(responses)
         << "!" << endl;
 
   // Now, do the training.
+#ifdef HAS_MPI
+  if (distributed)
+  {
+    // The regularization is split between the ranks, since the objectives of
+    // the chunks are summed.
+    LogisticRegressionFunction<MatType> lrf(regressors, responses,
+        model.Parameters(), lambda / numRanks);
+    DistributedFunction<LogisticRegressionFunction<MatType>> df(lrf);
+    arma::mat parameters(df.GetInitialPoint());
+    double objective;
+    if (optimizerType == "lbfgs")
+    {
+      L_BFGS<DistributedFunction<LogisticRegressionFunction<MatType>>>
+          lbfgsOpt(df);
+      lbfgsOpt.MaxIterations() = maxIterations;
+      lbfgsOpt.MinGradientNorm() = tolerance;
+      Log::Info << "Training model with L-BFGS optimizer on " << numRanks
+          << " ranks." << endl;
+
+      objective = lbfgsOpt.Optimize(parameters);
+    }
+    else
+    {
+      MiniBatchSGD<DistributedFunction<LogisticRegressionFunction<MatType>>>
+          mbsgdOpt(df);
+      mbsgdOpt.BatchSize() = batchSize;
+      mbsgdOpt.Tolerance() = tolerance;
+      mbsgdOpt.StepSize() = stepSize;
+      mbsgdOpt.MaxIterations() = maxIterations;
+      // The batches must be visited in the same order on every rank.
+      mbsgdOpt.Shuffle() = false;
+      Log::Info << "Training model with mini-batch SGD optimizer (batch size "
+          << batchSize << ") on " << numRanks << " ranks." << endl;
+
+      objective = mbsgdOpt.Optimize(parameters);
+    }
+
+    Log::Info << "Final objective of trained model is " << objective << "."
+        << endl;
+    model.Parameters() = parameters;
+  }
+  else
+#endif
   if (CLI::HasParam("training"))
   {
-    LogisticRegressionFunction<> lrf(regressors, responses, model.Parameters());
+    LogisticRegressionFunction<MatType> lrf(regressors, responses,
+        model.Parameters(), lambda);
+    arma::mat parameters(lrf.GetInitialPoint());
+    double objective;
+    Timer::Start("logistic_regression_optimization");
     if (optimizerType == "sgd")
     {
-      SGD<LogisticRegressionFunction<>> sgdOpt(lrf);
+      // With sparse data, the gradient of each point is sparse, so each step
+      // only updates the parameters of the nonzero features of its point.
+      typedef typename std::conditional<
+          arma::is_arma_sparse_type<MatType>::value, arma::sp_mat,
+          arma::mat>::type GradType;
+      SGD<LogisticRegressionFunction<MatType>, VanillaUpdate, GradType>
+          sgdOpt(lrf);
       sgdOpt.MaxIterations() = maxIterations;
       sgdOpt.Tolerance() = tolerance;
       sgdOpt.StepSize() = stepSize;
       Log::Info << "Training model with SGD optimizer." << endl;
 
-      // This will train the model.
-      model.Train(sgdOpt);
+      objective = sgdOpt.Optimize(parameters);
     }
     else if (optimizerType == "lbfgs")
     {
-      L_BFGS<LogisticRegressionFunction<>> lbfgsOpt(lrf);
+      L_BFGS<LogisticRegressionFunction<MatType>> lbfgsOpt(lrf);
       lbfgsOpt.MaxIterations() = maxIterations;
       lbfgsOpt.MinGradientNorm() = tolerance;
       Log::Info << "Training model with L-BFGS optimizer." << endl;
 
-      // This will train the model.
-      model.Train(lbfgsOpt);
+      objective = lbfgsOpt.Optimize(parameters);
     }
-    else if (optimizerType == "minibatch-sgd")
+    else
     {
-      MiniBatchSGD<LogisticRegressionFunction<>> mbsgdOpt(lrf);
+      MiniBatchSGD<LogisticRegressionFunction<MatType>> mbsgdOpt(lrf);
       mbsgdOpt.BatchSize() = batchSize;
       mbsgdOpt.Tolerance() = tolerance;
       mbsgdOpt.StepSize() = stepSize;
@@ -261,13 +309,22 @@ int main(int argc, char** argv)
       Log::Info << "Training model with mini-batch SGD optimizer (batch size "
           << batchSize << ")." << endl;
 
-      model.Train(mbsgdOpt);
+      objective = mbsgdOpt.Optimize(parameters);
     }
+    Timer::Stop("logistic_regression_optimization");
+
+    Log::Info << "Final objective of trained model is " << objective << "."
+        << endl;
+    model.Parameters() = parameters;
   }
 
-  if (CLI::HasParam("test"))
+  if (isRoot && CLI::HasParam("test"))
   {
-    testSet = std::move(CLI::GetParam<arma::mat>("test"));
+    LoadMatrix("test", testSet);
+
+    // A model of the type of the test set, with the trained parameters.
+    LogisticRegression<MatType> testModel(0, lambda);
+    testModel.Parameters() = model.Parameters();
 
     // We must perform predictions on the test set.  Training (and the
     // optimizer) are irrelevant here; we'll pass in the model we have.
@@ -275,7 +332,7 @@ int main(int argc, char** argv)
     {
       Log::Info << "Predicting classes of points in '"
           << CLI::GetUnmappedParam<arma::mat>("test") << "'." << endl;
-      model.Classify(testSet, predictions, decisionBoundary);
+      testModel.Classify(testSet, predictions, decisionBoundary);
 
       CLI::GetParam<arma::Row<size_t>>("output") = std::move(predictions);
     }
@@ -285,12 +342,125 @@ int main(int argc, char** argv)
       Log::Info << "Calculating class probabilities of points in '"
           << CLI::GetUnmappedParam<arma::mat>("test") << "'." << endl;
       arma::mat probabilities;
-      model.Classify(testSet, probabilities);
+      testModel.Classify(testSet, probabilities);
 
       CLI::GetParam<arma::mat>("output_probabilities") =
           std::move(probabilities);
     }
   }
+}
+
+int main(int argc, char** argv)
+{
+  // Only rank 0 saves output when running under MPI.
+  bool isRoot = true;
+  bool distributed = false;
+#ifdef HAS_MPI
+  MPI_Init(&argc, &argv);
+  int rank, numRanks;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &numRanks);
+  isRoot = (rank == 0);
+#endif
+
+  CLI::ParseCommandLine(argc, argv);
+
+  // Collect command-line options.
+  const double lambda = CLI::GetParam<double>("lambda");
+  const string optimizerType = CLI::GetParam<string>("optimizer");
+  const double tolerance = CLI::GetParam<double>("tolerance");
+  const double stepSize = CLI::GetParam<double>("step_size");
+  const double decisionBoundary = CLI::GetParam<double>("decision_boundary");
+
+#ifdef HAS_MPI
+  distributed = CLI::HasParam("training_chunks");
+  if (distributed)
+  {
+    if (CLI::HasParam("training") || CLI::HasParam("labels"))
+      Log::Fatal << "--training_file (-t) and --labels_file (-l) may not be "
+          << "specified with --training_chunks (-c)!" << endl;
+    if (CLI::GetParam<vector<string>>("training_chunks").size() !=
+        size_t(numRanks))
+      Log::Fatal << "--training_chunks (-c) requires one chunk per MPI rank, "
+          << "but " << numRanks << " ranks and "
+          << CLI::GetParam<vector<string>>("training_chunks").size()
+          << " chunks were given." << endl;
+    if (optimizerType == "sgd")
+      Log::Fatal << "--training_chunks (-c) requires the 'lbfgs' or "
+          << "'minibatch-sgd' optimizer." << endl;
+  }
+#endif
+
+  // One of inputFile and modelFile must be specified.
+  if (!CLI::HasParam("training") && !CLI::HasParam("input_model") &&
+      !distributed)
+    Log::Fatal << "One of --input_model_file or --training_file must be "
+        << "specified." << endl;
+
+  // If no output file is given, the user should know that the model will not be
+  // saved, but only if a model is being trained.
+  if (!CLI::HasParam("output_model") &&
+      (CLI::HasParam("training") || distributed))
+    Log::Warn << "--output_model_file not given; trained model will not be "
+        << "saved." << endl;
+
+  if (CLI::HasParam("test") && !CLI::HasParam("output") &&
+      !CLI::HasParam("output_probabilities"))
+    Log::Warn << "--test_file specified, but neither --output_file nor "
+        << "--output_probabilities_file are specified; no test "
+        << "output will be saved!" << endl;
+
+  if (CLI::HasParam("output") && !CLI::HasParam("test"))
+    Log::Warn << "--output_file ignored because --test_file is not specified."
+        << endl;
+
+  if (CLI::HasParam("output_probabilities") && !CLI::HasParam("test"))
+    Log::Warn << "--output_probabilities_file ignored because --test_file is "
+        << "not specified." << endl;
+
+  // Tolerance needs to be positive.
+  if (tolerance < 0.0)
+    Log::Fatal << "Tolerance must be positive (received " << tolerance << ")."
+        << endl;
+
+  // Optimizer has to be L-BFGS or SGD.
+  if (optimizerType != "lbfgs" && optimizerType != "sgd" &&
+      optimizerType != "minibatch-sgd")
+    Log::Fatal << "--optimizer must be 'lbfgs', 'sgd', or 'minibatch-sgd'."
+        << endl;
+
+  // Lambda must be positive.
+  if (lambda < 0.0)
+    Log::Fatal << "L2-regularization parameter (--lambda) must be positive ("
+        << "received " << lambda << ")." << endl;
+
+  // Decision boundary must be between 0 and 1.
+  if (decisionBoundary < 0.0 || decisionBoundary > 1.0)
+    Log::Fatal << "Decision boundary (--decision_boundary) must be between 0.0 "
+        << "and 1.0 (received " << decisionBoundary << ")." << endl;
+
+  if ((stepSize < 0.0) &&
+      (optimizerType == "sgd" || optimizerType == "minibatch-sgd"))
+    Log::Fatal << "Step size (--step_size) must be positive (received "
+        << stepSize << ")." << endl;
+
+  if (CLI::HasParam("step_size") && optimizerType == "lbfgs")
+    Log::Warn << "Step size (--step_size) ignored because 'sgd' optimizer is "
+        << "not being used." << endl;
+
+  if (CLI::HasParam("batch_size") && optimizerType != "minibatch-sgd")
+    Log::Warn << "Batch size (--batch_size) ignored because 'minibatch-sgd' "
+        << "optimizer is not being used." << endl;
+
+  // Load the model, if necessary.
+  LogisticRegression<> model(0, 0); // Empty model.
+  if (CLI::HasParam("input_model"))
+    model = std::move(CLI::GetParam<LogisticRegression<>>("input_model"));
+
+  if (CLI::HasParam("sparse"))
+    TrainAndClassify<arma::sp_mat>(model, isRoot, distributed);
+  else
+    TrainAndClassify<arma::mat>(model, isRoot, distributed);
 
   if (CLI::HasParam("output_model"))
   {
@@ -300,5 +470,12 @@ int main(int argc, char** argv)
     CLI::GetParam<LogisticRegression<>>("output_model") = std::move(model);
   }
 
-  CLI::Destroy();
+  // Output files are written by CLI::Destroy(), so other ranks must not call
+  // it.
+  if (isRoot)
+    CLI::Destroy();
+
+#ifdef HAS_MPI
+  MPI_Finalize();
+#endif
 }
@@ -189,6 +189,38 @@ class LSHSearch
              const size_t bucketSize = 500,
              const arma::cube& projection = arma::cube());
 
+  /**
+   * Add the given points to the model, hashing them with the existing
+   * projections and appending them to their buckets (as long as the buckets
+   * aren't full), so the other points aren't hashed again.  The new points
+   * are given the indices following the points already in the model.  The
+   * model then holds its own copy of the reference set, and each call copies
+   * the reference set and the buckets once, so points should be inserted in
+   * batches.  A std::invalid_argument is thrown if the model isn't trained or
+   * if the dimensionality of the points isn't the one of the reference set.
+   *
+   * @param points Points to add (one per column).
+   */
+  void Insert(const arma::mat& points);
+
+  /**
+   * Remove the given points from the model, so that they are never returned
+   * as neighbors.  The points keep their indices (the reference set isn't
+   * modified); they are marked as removed, and they are dropped from the
+   * buckets by Compact(), which is called when the removed points may take
+   * more than a quarter of the buckets.  A std::invalid_argument is thrown if
+   * an index is out of range.
+   *
+   * @param indices Indices of the points to remove.
+   */
+  void Remove(const arma::Col<size_t>& indices);
+
+  /**
+   * Drop the removed points from the buckets, in one pass over the buckets.
+   * This is called by Remove() when needed.
+   */
+  void Compact();
+
   /**
    * Compute the nearest neighbors of the points in the given query set and
    * store the output in the given matrices.  The matrices will be set to the
@@ -281,9 +313,14 @@ class LSHSearch
   //! Get the bucket size of the second hash.
   size_t BucketSize() const { return bucketSize; }
 
-  //! Get the second hash table.
-  const std::vector<arma::Col<size_t>>& SecondHashTable() const
-      { return secondHashTable; }
+  //! Get the offsets of the buckets of the second hash table in
+  //! BucketContents(): bucket r holds the points BucketContents()[o] for o in
+  //! [BucketOffsets()[r], BucketOffsets()[r + 1]).
+  const arma::Col<size_t>& BucketOffsets() const { return bucketOffsets; }
+
+  //! Get the points of the buckets of the second hash table, one bucket after
+  //! the other.
+  const arma::Col<size_t>& BucketContents() const { return bucketContents; }
 
   //! Get the projection tables.
   const arma::cube& Projections() { return projections; }
@@ -297,11 +334,28 @@ class LSHSearch
   }
 
  private:
+  /**
+   * Hash the given points into the buckets of the second hash table, for
+   * every table, by blocks of points in parallel.  The bucket of point j in
+   * table i is stored in secondHashVectors(i, j).
+   *
+   * @param points Points to hash.
+   * @param secondHashVectors Matrix to store the buckets into.
+   */
+  void HashPoints(const arma::mat& points,
+                  arma::Mat<size_t>& secondHashVectors) const;
+
   /**
    * This function takes a query and hashes it into each of the hash tables to
    * get keys for the query and then the key is hashed to a bucket of the second
    * hash table and all the points (if any) in those buckets are collected as
-   * the potential neighbor candidates.
+   * the potential neighbor candidates.  Each candidate is kept once, and they
+   * are sorted by index.
+   *
+   * Duplicates are found by marking the candidates in the given bitmap, which
+   * has one (false) entry per reference point; only the marked entries are
+   * reset afterwards, so this takes time linear in the number of points in the
+   * buckets, and the bitmap can be reused for the next query.
    *
    * @param queryPoint The query point currently being processed.
    * @param referenceIndices The list of neighbor candidates obtained from
@@ -311,12 +365,14 @@ class LSHSearch
    *    0, all tables are searched.
    * @param T The number of additional probing bins for multiprobe LSH. If 0,
    *    single-probe is used.
+   * @param visited Bitmap of the reference points, all false.
    */
   template<typename VecType>
   void ReturnIndicesFromTable(const VecType& queryPoint,
                               arma::uvec& referenceIndices,
                               size_t numTablesToSearch,
-                              const size_t T) const;
+                              const size_t T,
+                              std::vector<bool>& visited) const;
 
   /**
    * This is a helper function that computes the distance of the query to the
@@ -358,6 +414,31 @@ class LSHSearch
                 arma::Mat<size_t>& neighbors,
                 arma::mat& distances) const;
 
+  /**
+   * Compute the distances of the query to the neighbor candidates, gathering
+   * blocks of candidates into a matrix so that the distances of a block are
+   * computed at once, and store the best 'k' candidates, best first, into
+   * column queryIndex of neighbors and distances.  The candidate with index
+   * skip, if any, is ignored.
+   *
+   * @param query The query point.
+   * @param referenceIndices The vector of indices of candidate neighbors for
+   *    the query.
+   * @param skip Index of the reference point to ignore (or the number of
+   *    reference points, to ignore none).
+   * @param k Number of neighbors to search for.
+   * @param queryIndex The index of the query in question.
+   * @param neighbors Matrix holding output neighbors.
+   * @param distances Matrix holding output distances.
+   */
+  void RankCandidates(const arma::vec& query,
+                      const arma::uvec& referenceIndices,
+                      const size_t skip,
+                      const size_t k,
+                      const size_t queryIndex,
+                      arma::Mat<size_t>& neighbors,
+                      arma::mat& distances) const;
+
   /**
    * This function implements the core idea behind Multiprobe LSH. It is called
    * by ReturnIndicesFromTables when T > 0. Given a query's code and its
@@ -443,35 +524,43 @@ class LSHSearch
   //! The bucket size of the second hash.
   size_t bucketSize;
 
-  //! The final hash table; should be (< secondHashSize) vectors each with
-  //! (<= bucketSize) elements.
-  std::vector<arma::Col<size_t>> secondHashTable;
+  //! The final hash table, with the points of each of its (< secondHashSize)
+  //! buckets stored one bucket after the other; each bucket holds
+  //! (<= bucketSize) points.
+  arma::Col<size_t> bucketContents;
 
-  //! The number of elements present in each hash bucket; should be
-  //! secondHashSize.
-  arma::Col<size_t> bucketContentSize;
+  //! The offset of each bucket in bucketContents, followed by the total number
+  //! of points; bucket r holds bucketContents[o] for o in
+  //! [bucketOffsets[r], bucketOffsets[r + 1]).
+  arma::Col<size_t> bucketOffsets;
 
-  //! For a particular hash value, points to the row in secondHashTable
-  //! corresponding to this value. Length secondHashSize.
+  //! For a particular hash value, points to the bucket (row) of the second
+  //! hash table corresponding to this value. Length secondHashSize.
   arma::Col<size_t> bucketRowInHashTable;
 
+  //! Whether each reference point was removed.  Removed points are never
+  //! candidates, and are dropped from the buckets by Compact().
+  std::vector<bool> removed;
+
+  //! The number of removed points that may still be in the buckets.
+  size_t numPendingRemovals;
+
   //! The number of distance evaluations.
   size_t distanceEvaluations;
 
   //! Candidate represents a possible candidate neighbor (distance, index).
   typedef std::pair<double, size_t> Candidate;
 
-  //! Compare two candidates based on the distance.
+  //! Compare two candidates based on the distance (and then on the index, so
+  //! that ties are broken the same way every time); better candidates come
+  //! first.
   struct CandidateCmp {
     bool operator()(const Candidate& c1, const Candidate& c2)
     {
-      return !SortPolicy::IsBetter(c2.first, c1.first);
+      return SortPolicy::IsBetter(c1.first, c2.first) ||
+          ((c1.first == c2.first) && (c1.second < c2.second));
     };
   };
-
-  //! Use a priority queue to represent the list of candidate neighbors.
-  typedef std::priority_queue<Candidate, std::vector<Candidate>, CandidateCmp>
-      CandidateList;
 }; // class LSHSearch
 
 } // namespace neighbor
@@ -479,7 +568,7 @@ class LSHSearch
 
 //! Set the serialization version of the LSHSearch class.
 BOOST_TEMPLATE_CLASS_VERSION(template<typename SortPolicy>,
-    mlpack::neighbor::LSHSearch<SortPolicy>, 1);
+    mlpack::neighbor::LSHSearch<SortPolicy>, 3);
 
 // Include implementation.
 #include "lsh_search_impl.hpp"
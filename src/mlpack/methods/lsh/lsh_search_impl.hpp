@@ -34,6 +34,7 @@ LSHSearch(const arma::mat& referenceSet,
   hashWidth(hashWidthIn),
   secondHashSize(secondHashSize),
   bucketSize(bucketSize),
+  numPendingRemovals(0),
   distanceEvaluations(0)
 {
   // Pass work to training function.
@@ -56,6 +57,7 @@ LSHSearch(const arma::mat& referenceSet,
   hashWidth(hashWidthIn),
   secondHashSize(secondHashSize),
   bucketSize(bucketSize),
+  numPendingRemovals(0),
   distanceEvaluations(0)
 {
   // Pass work to training function
@@ -73,6 +75,7 @@ LSHSearch<SortPolicy>::LSHSearch() :
     hashWidth(0),
     secondHashSize(99901),
     bucketSize(500),
+    numPendingRemovals(0),
     distanceEvaluations(0)
 {
 }
@@ -90,9 +93,11 @@ LSHSearch<SortPolicy>::LSHSearch(const LSHSearch& other) :
     secondHashSize(other.secondHashSize),
     secondHashWeights(other.secondHashWeights),
     bucketSize(other.bucketSize),
-    secondHashTable(other.secondHashTable),
-    bucketContentSize(other.bucketContentSize),
+    bucketContents(other.bucketContents),
+    bucketOffsets(other.bucketOffsets),
     bucketRowInHashTable(other.bucketRowInHashTable),
+    removed(other.removed),
+    numPendingRemovals(other.numPendingRemovals),
     distanceEvaluations(other.distanceEvaluations)
 {
   // Nothing to do.
@@ -111,9 +116,11 @@ LSHSearch<SortPolicy>::LSHSearch(LSHSearch&& other) :
     secondHashSize(other.secondHashSize),
     secondHashWeights(std::move(other.secondHashWeights)),
     bucketSize(other.bucketSize),
-    secondHashTable(std::move(other.secondHashTable)),
-    bucketContentSize(std::move(other.bucketContentSize)),
+    bucketContents(std::move(other.bucketContents)),
+    bucketOffsets(std::move(other.bucketOffsets)),
     bucketRowInHashTable(std::move(other.bucketRowInHashTable)),
+    removed(std::move(other.removed)),
+    numPendingRemovals(other.numPendingRemovals),
     distanceEvaluations(other.distanceEvaluations)
 {
   // Reset other model to defaults.
@@ -124,6 +131,7 @@ LSHSearch<SortPolicy>::LSHSearch(LSHSearch&& other) :
   other.hashWidth = 0;
   other.secondHashSize = 99901;
   other.bucketSize = 500;
+  other.numPendingRemovals = 0;
   other.distanceEvaluations = 0;
 }
 
@@ -144,9 +152,11 @@ LSHSearch<SortPolicy>& LSHSearch<SortPolicy>::operator=(const LSHSearch& other)
   secondHashSize = other.secondHashSize;
   secondHashWeights = other.secondHashWeights;
   bucketSize = other.bucketSize;
-  secondHashTable = other.secondHashTable;
-  bucketContentSize = other.bucketContentSize;
+  bucketContents = other.bucketContents;
+  bucketOffsets = other.bucketOffsets;
   bucketRowInHashTable = other.bucketRowInHashTable;
+  removed = other.removed;
+  numPendingRemovals = other.numPendingRemovals;
   distanceEvaluations = other.distanceEvaluations;
 
   return *this;
@@ -169,9 +179,11 @@ LSHSearch<SortPolicy>& LSHSearch<SortPolicy>::operator=(LSHSearch&& other)
   secondHashSize = other.secondHashSize;
   secondHashWeights = std::move(other.secondHashWeights);
   bucketSize = other.bucketSize;
-  secondHashTable = std::move(other.secondHashTable);
-  bucketContentSize = std::move(other.bucketContentSize);
+  bucketContents = std::move(other.bucketContents);
+  bucketOffsets = std::move(other.bucketOffsets);
   bucketRowInHashTable = std::move(other.bucketRowInHashTable);
+  removed = std::move(other.removed);
+  numPendingRemovals = other.numPendingRemovals;
   distanceEvaluations = other.distanceEvaluations;
 
   // Reset other model to defaults.
@@ -182,6 +194,7 @@ LSHSearch<SortPolicy>& LSHSearch<SortPolicy>::operator=(LSHSearch&& other)
   other.hashWidth = 0;
   other.secondHashSize = 99901;
   other.bucketSize = 500;
+  other.numPendingRemovals = 0;
   other.distanceEvaluations = 0;
 
   return *this;
@@ -281,148 +294,313 @@ void LSHSearch<SortPolicy>::Train(const arma::mat& referenceSet,
         "tables provided must be equal to numProj");
   }
 
+  if (projections.n_cols != numProj)
+  {
+    std::ostringstream oss;
+    oss << "LSHSearch::Train(): number of projections in each table ("
+        << projections.n_cols << ") must be equal to numProj (" << numProj
+        << ")";
+    throw std::invalid_argument(oss.str());
+  }
+
   // We will store the second hash vectors in this matrix; the second hash
-  // vector for table i will be held in row i.  We have to use int and not
-  // size_t, otherwise negative numbers are cast to 0.
-  arma::Mat<size_t> secondHashVectors(numTables, referenceSet.n_cols);
+  // vector for table i will be held in row i.
+  arma::Mat<size_t> secondHashVectors;
+  HashPoints(referenceSet, secondHashVectors);
 
-  for (size_t i = 0; i < numTables; i++)
+  // Now, using the hash vectors for each table, count the number of points in
+  // each bucket of the second hash table.  The nonempty buckets are numbered
+  // in the order in which they are first seen.
+  arma::Row<size_t> secondHashBinCounts(secondHashSize, arma::fill::zeros);
+  size_t numRowsInTable = 0;
+  for (size_t i = 0; i < numTables; ++i)
   {
-    // Step IV: create the 'numProj'-dimensional key for each point in each
-    // table.
-
-    // The following code performs the task of hashing each point to a
-    // 'numProj'-dimensional integer key.  Hence you get a ('numProj' x
-    // 'referenceSet.n_cols') key matrix.
-    //
-    // For a single table, let the 'numProj' projections be denoted by 'proj_i'
-    // and the corresponding offset be 'offset_i'.  Then the key of a single
-    // point is obtained as:
-    // key = { floor((<proj_i, point> + offset_i) / 'hashWidth') forall i }
-    arma::mat offsetMat = arma::repmat(offsets.unsafe_col(i), 1,
-                                       referenceSet.n_cols);
-    arma::mat hashMat = projections.slice(i).t() * (referenceSet);
-    hashMat += offsetMat;
-    hashMat /= hashWidth;
-
-    // Step V: Putting the points in the 'secondHashTable' by hashing the key.
-    // Now we hash every key, point ID to its corresponding bucket.  We must
-    // also normalize the hashes to the range [0, secondHashSize).
-    arma::rowvec unmodVector = secondHashWeights.t() * arma::floor(hashMat);
-    for (size_t j = 0; j < unmodVector.n_elem; ++j)
+    for (size_t j = 0; j < secondHashVectors.n_cols; ++j)
     {
-      double shs = (double) secondHashSize; // Convenience cast.
-      if (unmodVector[j] >= 0.0)
-      {
-        const size_t key = size_t(fmod(unmodVector[j], shs));
-        secondHashVectors(i, j) = key;
-      }
-      else
-      {
-        const double mod = fmod(-unmodVector[j], shs);
-        const size_t key = (mod < 1.0) ? 0 : secondHashSize - size_t(mod);
-        secondHashVectors(i, j) = key;
-      }
+      const size_t hashInd = secondHashVectors(i, j);
+      if (secondHashBinCounts[hashInd]++ == 0)
+        bucketRowInHashTable[hashInd] = numRowsInTable++;
     }
   }
 
-  // Now, using the hash vectors for each table, count the number of rows we
-  // have in the second hash table.
-  arma::Row<size_t> secondHashBinCounts(secondHashSize, arma::fill::zeros);
-  for (size_t i = 0; i < secondHashVectors.n_elem; ++i)
-    secondHashBinCounts[secondHashVectors[i]]++;
-
   // Enforce the maximum bucket size.
   const size_t effectiveBucketSize = (bucketSize == 0) ? SIZE_MAX : bucketSize;
   secondHashBinCounts.transform([effectiveBucketSize](size_t val)
       { return std::min(val, effectiveBucketSize); });
 
-  const size_t numRowsInTable = arma::accu(secondHashBinCounts > 0);
-  bucketContentSize.zeros(numRowsInTable);
-  secondHashTable.resize(numRowsInTable);
-
-  // Next we must assign each point in each table to the right second hash
-  // table.
-  size_t currentRow = 0;
+  // The buckets are stored one after the other in bucketContents, so find
+  // where each of them starts.
+  bucketOffsets.zeros(numRowsInTable + 1);
+  for (size_t i = 0; i < secondHashSize; ++i)
+    if (secondHashBinCounts[i] > 0)
+      bucketOffsets[bucketRowInHashTable[i] + 1] = secondHashBinCounts[i];
+  for (size_t i = 0; i < numRowsInTable; ++i)
+    bucketOffsets[i + 1] += bucketOffsets[i];
+
+  // Next we must assign each point in each table to its bucket, until the
+  // bucket is full.
+  bucketContents.set_size(bucketOffsets[numRowsInTable]);
+  arma::Col<size_t> bucketEnds = bucketOffsets.head(numRowsInTable);
   for (size_t i = 0; i < numTables; ++i)
   {
-    // Insert the point in the corresponding row to its bucket in the
-    // 'secondHashTable'.
     for (size_t j = 0; j < secondHashVectors.n_cols; j++)
     {
-      // This is the bucket number.
-      size_t hashInd = (size_t) secondHashVectors(i, j);
-      // The point ID is 'j'.
-
-      // If this is currently an empty bucket, start a new row keep track of
-      // which row corresponds to the bucket.
-      const size_t maxSize = secondHashBinCounts[hashInd];
-      if (bucketRowInHashTable[hashInd] == secondHashSize)
-      {
-        bucketRowInHashTable[hashInd] = currentRow;
-        secondHashTable[currentRow].set_size(maxSize);
-        currentRow++;
-      }
+      // This is the bucket; the point ID is 'j'.
+      const size_t row = bucketRowInHashTable[secondHashVectors(i, j)];
 
-      // If this vector in the hash table is not full, add the point.
-      const size_t index = bucketRowInHashTable[hashInd];
-      if (bucketContentSize[index] < maxSize)
-        secondHashTable[index](bucketContentSize[index]++) = j;
+      // If the bucket is not full, add the point.
+      if (bucketEnds[row] < bucketOffsets[row + 1])
+        bucketContents[bucketEnds[row]++] = j;
     } // Loop over all points in the reference set.
   } // Loop over tables.
 
+  // No point is removed.
+  removed.assign(referenceSet.n_cols, false);
+  numPendingRemovals = 0;
+
   Log::Info << "Final hash table size: " << numRowsInTable << " rows, with a "
             << "maximum length of " << arma::max(secondHashBinCounts) << ", "
             << "totaling " << arma::accu(secondHashBinCounts) << " elements."
             << std::endl;
 }
 
-// Base case where the query set is the reference set.  (So, we can't return
-// ourselves as the nearest neighbor.)
+// Add points to the model.
 template<typename SortPolicy>
-inline force_inline
-void LSHSearch<SortPolicy>::BaseCase(const size_t queryIndex,
-                                     const arma::uvec& referenceIndices,
-                                     const size_t k,
-                                     arma::Mat<size_t>& neighbors,
-                                     arma::mat& distances) const
+void LSHSearch<SortPolicy>::Insert(const arma::mat& points)
 {
-  // Let's build the list of candidate neighbors for the given query point.
-  // It will be initialized with k candidates:
-  // (WorstDistance, referenceSet->n_cols)
-  const Candidate def = std::make_pair(SortPolicy::WorstDistance(),
-      referenceSet->n_cols);
-  std::vector<Candidate> vect(k, def);
-  CandidateList pqueue(CandidateCmp(), std::move(vect));
-
-  for (size_t j = 0; j < referenceIndices.n_elem; ++j)
+  if (bucketOffsets.n_elem == 0)
   {
-    const size_t referenceIndex = referenceIndices[j];
-    // If the points are the same, skip this point.
-    if (queryIndex == referenceIndex)
-      continue;
+    throw std::invalid_argument("LSHSearch::Insert(): the model must be "
+        "trained before points are inserted");
+  }
+
+  if (points.n_rows != referenceSet->n_rows)
+  {
+    std::ostringstream oss;
+    oss << "LSHSearch::Insert(): dimensionality of the points ("
+        << points.n_rows << ") is not equal to the dimensionality the model "
+        << "was trained on (" << referenceSet->n_rows << ")!";
+    throw std::invalid_argument(oss.str());
+  }
+
+  // Hash the new points with the existing projections.
+  arma::Mat<size_t> secondHashVectors;
+  HashPoints(points, secondHashVectors);
+
+  // The model now holds its own copy of the reference set, with the new
+  // points at the end.
+  const size_t firstIndex = referenceSet->n_cols;
+  arma::mat* newReferenceSet = new arma::mat(arma::join_rows(*referenceSet,
+      points));
+  if (ownsSet)
+    delete referenceSet;
+  referenceSet = newReferenceSet;
+  ownsSet = true;
+  removed.resize(referenceSet->n_cols, false);
 
-    const double distance = metric::EuclideanDistance::Evaluate(
-        referenceSet->unsafe_col(queryIndex),
-        referenceSet->unsafe_col(referenceIndex));
+  // Number the buckets that are seen for the first time after the existing
+  // ones, and count the points each bucket will hold, up to the maximum
+  // bucket size.
+  const size_t effectiveBucketSize = (bucketSize == 0) ? SIZE_MAX : bucketSize;
+  const size_t oldNumRows = bucketOffsets.n_elem - 1;
+  std::vector<size_t> bucketCounts(oldNumRows);
+  for (size_t i = 0; i < oldNumRows; ++i)
+    bucketCounts[i] = bucketOffsets[i + 1] - bucketOffsets[i];
 
-    Candidate c = std::make_pair(distance, referenceIndex);
-    // If this distance is better than the worst candidate, let's insert it.
-    if (CandidateCmp()(c, pqueue.top()))
+  for (size_t i = 0; i < numTables; ++i)
+  {
+    for (size_t j = 0; j < secondHashVectors.n_cols; ++j)
     {
-      pqueue.pop();
-      pqueue.push(c);
+      const size_t hashInd = secondHashVectors(i, j);
+      if (bucketRowInHashTable[hashInd] == secondHashSize)
+      {
+        bucketRowInHashTable[hashInd] = bucketCounts.size();
+        bucketCounts.push_back(0);
+      }
+
+      const size_t row = bucketRowInHashTable[hashInd];
+      if (bucketCounts[row] < effectiveBucketSize)
+        ++bucketCounts[row];
     }
   }
 
-  for (size_t j = 1; j <= k; j++)
+  // Lay out the buckets again, copying the existing points of each bucket,
+  // and then add the new points in the same order.
+  const size_t numRows = bucketCounts.size();
+  arma::Col<size_t> newOffsets(numRows + 1);
+  newOffsets[0] = 0;
+  for (size_t i = 0; i < numRows; ++i)
+    newOffsets[i + 1] = newOffsets[i] + bucketCounts[i];
+
+  arma::Col<size_t> newContents(newOffsets[numRows]);
+  arma::Col<size_t> bucketEnds = newOffsets.head(numRows);
+  for (size_t i = 0; i < oldNumRows; ++i)
   {
-    neighbors(k - j, queryIndex) = pqueue.top().second;
-    distances(k - j, queryIndex) = pqueue.top().first;
-    pqueue.pop();
+    for (size_t j = bucketOffsets[i]; j < bucketOffsets[i + 1]; ++j)
+      newContents[bucketEnds[i]++] = bucketContents[j];
+  }
+
+  for (size_t i = 0; i < numTables; ++i)
+  {
+    for (size_t j = 0; j < secondHashVectors.n_cols; ++j)
+    {
+      const size_t row = bucketRowInHashTable[secondHashVectors(i, j)];
+      if (bucketEnds[row] < newOffsets[row + 1])
+        newContents[bucketEnds[row]++] = firstIndex + j;
+    }
+  }
+
+  bucketOffsets = std::move(newOffsets);
+  bucketContents = std::move(newContents);
+}
+
+// Remove points from the model.
+template<typename SortPolicy>
+void LSHSearch<SortPolicy>::Remove(const arma::Col<size_t>& indices)
+{
+  for (size_t i = 0; i < indices.n_elem; ++i)
+  {
+    if (indices[i] >= referenceSet->n_cols)
+    {
+      std::ostringstream oss;
+      oss << "LSHSearch::Remove(): index " << indices[i] << " is out of range "
+          << "(the reference set has " << referenceSet->n_cols << " points)";
+      throw std::invalid_argument(oss.str());
+    }
+  }
+
+  for (size_t i = 0; i < indices.n_elem; ++i)
+  {
+    if (!removed[indices[i]])
+    {
+      removed[indices[i]] = true;
+      ++numPendingRemovals;
+    }
+  }
+
+  // Each point is in at most one bucket per table; compact the buckets when
+  // removed points may take more than a quarter of them.
+  if (4 * numPendingRemovals * numTables > bucketContents.n_elem)
+    Compact();
+}
+
+// Drop the removed points from the buckets.
+template<typename SortPolicy>
+void LSHSearch<SortPolicy>::Compact()
+{
+  if (bucketOffsets.n_elem == 0)
+    return;
+
+  // The buckets only shrink, so they can be moved down in place.
+  const size_t numRows = bucketOffsets.n_elem - 1;
+  size_t begin = 0;
+  size_t numPoints = 0;
+  for (size_t i = 0; i < numRows; ++i)
+  {
+    const size_t end = bucketOffsets[i + 1];
+    for (size_t j = begin; j < end; ++j)
+      if (!removed[bucketContents[j]])
+        bucketContents[numPoints++] = bucketContents[j];
+
+    bucketOffsets[i + 1] = numPoints;
+    begin = end;
+  }
+
+  bucketContents.resize(numPoints);
+  numPendingRemovals = 0;
+}
+
+// Hash the given points into the second hash table, for every table.
+template<typename SortPolicy>
+void LSHSearch<SortPolicy>::HashPoints(
+    const arma::mat& points,
+    arma::Mat<size_t>& secondHashVectors) const
+{
+  secondHashVectors.set_size(numTables, points.n_cols);
+
+  // The slices of the projection cube are contiguous, so the projections of
+  // all the tables are the columns of one matrix, and a block of points is
+  // projected for every table with one matrix product.  The blocks are hashed
+  // in parallel, and each block of projections holds about 2^20 values.
+  const arma::mat allProjections(const_cast<double*>(projections.memptr()),
+      projections.n_rows, numProj * numTables, false, true);
+  const arma::vec allOffsets(const_cast<double*>(offsets.memptr()),
+      numProj * numTables, false, true);
+  const size_t blockSize = std::max((size_t) 1, std::min((size_t) 4096,
+      ((size_t) 1 << 20) / std::max((size_t) 1, numProj * numTables)));
+  const size_t numBlocks = (points.n_cols + blockSize - 1) / blockSize;
+
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables. If we're building for Visual Studio, use
+  // the intmax_t type instead.
+  #pragma omp parallel for schedule(static)
+  for (intmax_t b = 0; b < (intmax_t) numBlocks; ++b)
+#else
+  #pragma omp parallel for schedule(static)
+  for (size_t b = 0; b < numBlocks; ++b)
+#endif
+  {
+    const size_t begin = b * blockSize;
+    const size_t end = std::min(begin + blockSize, points.n_cols) - 1;
+
+    // Step IV: create the 'numProj'-dimensional key for each point in each
+    // table.
+
+    // The following code performs the task of hashing each point to a
+    // 'numProj'-dimensional integer key.  Hence you get a ('numProj' x
+    // 'points.n_cols') key matrix for each table, and the key matrices of the
+    // tables are stacked.
+    //
+    // For a single table, let the 'numProj' projections be denoted by 'proj_i'
+    // and the corresponding offset be 'offset_i'.  Then the key of a single
+    // point is obtained as:
+    // key = { floor((<proj_i, point> + offset_i) / 'hashWidth') forall i }
+    arma::mat hashMat = allProjections.t() * points.cols(begin, end);
+    hashMat.each_col() += allOffsets;
+    hashMat = arma::floor(hashMat / hashWidth);
+
+    for (size_t i = 0; i < numTables; i++)
+    {
+      // Step V: Putting the points in the second hash table by hashing the
+      // key.  Now we hash every key, point ID to its corresponding bucket.  We
+      // must also normalize the hashes to the range [0, secondHashSize).
+      arma::rowvec unmodVector = secondHashWeights.t() *
+          hashMat.rows(i * numProj, (i + 1) * numProj - 1);
+      for (size_t j = 0; j < unmodVector.n_elem; ++j)
+      {
+        double shs = (double) secondHashSize; // Convenience cast.
+        if (unmodVector[j] >= 0.0)
+        {
+          const size_t key = size_t(fmod(unmodVector[j], shs));
+          secondHashVectors(i, begin + j) = key;
+        }
+        else
+        {
+          const double mod = fmod(-unmodVector[j], shs);
+          const size_t key = (mod < 1.0) ? 0 : secondHashSize - size_t(mod);
+          secondHashVectors(i, begin + j) = key;
+        }
+      }
+    }
   }
 }
 
+// Base case where the query set is the reference set.  (So, we can't return
+// ourselves as the nearest neighbor.)
+template<typename SortPolicy>
+inline force_inline
+void LSHSearch<SortPolicy>::BaseCase(const size_t queryIndex,
+                                     const arma::uvec& referenceIndices,
+                                     const size_t k,
+                                     arma::Mat<size_t>& neighbors,
+                                     arma::mat& distances) const
+{
+  // If the points are the same, skip this point.
+  RankCandidates(referenceSet->unsafe_col(queryIndex), referenceIndices,
+      queryIndex, k, queryIndex, neighbors, distances);
+}
+
 // Base case for bichromatic search.
 template<typename SortPolicy>
 inline force_inline
@@ -433,35 +611,60 @@ void LSHSearch<SortPolicy>::BaseCase(const size_t queryIndex,
                                      arma::Mat<size_t>& neighbors,
                                      arma::mat& distances) const
 {
-  // Let's build the list of candidate neighbors for the given query point.
-  // It will be initialized with k candidates:
-  // (WorstDistance, referenceSet->n_cols)
-  const Candidate def = std::make_pair(SortPolicy::WorstDistance(),
-      referenceSet->n_cols);
-  std::vector<Candidate> vect(k, def);
-  CandidateList pqueue(CandidateCmp(), std::move(vect));
-
-  for (size_t j = 0; j < referenceIndices.n_elem; ++j)
+  RankCandidates(querySet.unsafe_col(queryIndex), referenceIndices,
+      referenceSet->n_cols, k, queryIndex, neighbors, distances);
+}
+
+template<typename SortPolicy>
+void LSHSearch<SortPolicy>::RankCandidates(const arma::vec& query,
+                                           const arma::uvec& referenceIndices,
+                                           const size_t skip,
+                                           const size_t k,
+                                           const size_t queryIndex,
+                                           arma::Mat<size_t>& neighbors,
+                                           arma::mat& distances) const
+{
+  std::vector<Candidate> candidates;
+  candidates.reserve(referenceIndices.n_elem);
+
+  // Gather the candidates into a matrix, one block at a time, and compute the
+  // distances of the block at once.
+  const size_t blockSize = 1024;
+  arma::mat block;
+  arma::rowvec blockDistances;
+  for (size_t begin = 0; begin < referenceIndices.n_elem; begin += blockSize)
   {
-    const size_t referenceIndex = referenceIndices[j];
-    const double distance = metric::EuclideanDistance::Evaluate(
-        querySet.unsafe_col(queryIndex),
-        referenceSet->unsafe_col(referenceIndex));
-
-    Candidate c = std::make_pair(distance, referenceIndex);
-    // If this distance is better than the worst candidate, let's insert it.
-    if (CandidateCmp()(c, pqueue.top()))
+    const size_t end = std::min(begin + blockSize, referenceIndices.n_elem);
+    block = referenceSet->cols(referenceIndices.subvec(begin, end - 1));
+    block.each_col() -= query;
+    blockDistances = arma::sqrt(arma::sum(arma::square(block), 0));
+
+    for (size_t j = begin; j < end; ++j)
     {
-      pqueue.pop();
-      pqueue.push(c);
+      if (referenceIndices[j] != skip)
+      {
+        candidates.push_back(std::make_pair(blockDistances[j - begin],
+            referenceIndices[j]));
+      }
     }
   }
 
-  for (size_t j = 1; j <= k; j++)
+  // Keep the best k candidates, best first.  If there are fewer than k
+  // candidates, the remaining neighbors are (WorstDistance,
+  // referenceSet->n_cols).
+  const size_t found = std::min(k, (size_t) candidates.size());
+  std::partial_sort(candidates.begin(), candidates.begin() + found,
+      candidates.end(), CandidateCmp());
+
+  for (size_t j = 0; j < found; ++j)
+  {
+    neighbors(j, queryIndex) = candidates[j].second;
+    distances(j, queryIndex) = candidates[j].first;
+  }
+  for (size_t j = found; j < k; ++j)
   {
-    neighbors(k - j, queryIndex) = pqueue.top().second;
-    distances(k - j, queryIndex) = pqueue.top().first;
-    pqueue.pop();
+    neighbors(j, queryIndex) = referenceSet->n_cols;
+    distances(j, queryIndex) = SortPolicy::WorstDistance();
   }
 }
 
@@ -732,7 +935,8 @@ void LSHSearch<SortPolicy>::ReturnIndicesFromTable(
     const VecType& queryPoint,
     arma::uvec& referenceIndices,
     size_t numTablesToSearch,
-    const size_t T) const
+    const size_t T,
+    std::vector<bool>& visited) const
 {
   // Decide on the number of tables to look into.
   if (numTablesToSearch == 0) // If no user input is given, search all.
@@ -748,11 +952,15 @@ void LSHSearch<SortPolicy>::ReturnIndicesFromTable(
   // keys for the query where each key is a 'numProj' dimensional integer
   // vector.
 
-  // Compute the projection of the query in each table.
+  // Compute the projection of the query in each table with one product, since
+  // the projections of the tables are the columns of one matrix.
   arma::mat allProjInTables(numProj, numTablesToSearch);
   arma::mat queryCodesNotFloored(numProj, numTablesToSearch);
-  for (size_t i = 0; i < numTablesToSearch; i++)
-    queryCodesNotFloored.unsafe_col(i) = projections.slice(i).t() * queryPoint;
+  const arma::mat allProjections(const_cast<double*>(projections.memptr()),
+      projections.n_rows, numProj * numTablesToSearch, false, true);
+  arma::vec allQueryCodes(queryCodesNotFloored.memptr(),
+      queryCodesNotFloored.n_elem, false, true);
+  allQueryCodes = allProjections.t() * queryPoint;
 
   queryCodesNotFloored += offsets.cols(0, numTablesToSearch - 1);
   allProjInTables = arma::floor(queryCodesNotFloored / hashWidth);
@@ -800,82 +1008,47 @@ void LSHSearch<SortPolicy>::ReturnIndicesFromTable(
     {
       const size_t hashInd = hashMat(p, i); // find query's bucket
       const size_t tableRow = bucketRowInHashTable[hashInd];
-      if (tableRow < secondHashSize)
-        maxNumPoints += bucketContentSize[tableRow]; // count bucket contents
+      if (tableRow < secondHashSize) // count bucket contents
+        maxNumPoints += bucketOffsets[tableRow + 1] - bucketOffsets[tableRow];
     }
   }
 
-  // There are two ways to proceed here:
-  // Either allocate a maxNumPoints-size vector, place all candidates, and run
-  // unique on the vector to discard duplicates.
-  // Or allocate a referenceSet->n_cols size vector (i.e. number of reference
-  // points) of zeros, and mark found indices as 1.
-  // Option 1 runs faster for small maxNumPoints but worse for larger values, so
-  // we choose based on a heuristic.
-  const float cutoff = 0.1;
-  const float selectivity = static_cast<float>(maxNumPoints) /
-      static_cast<float>(referenceSet->n_cols);
-
-  if (selectivity > cutoff)
+  // Collect the points of the buckets, keeping the first copy of each; the
+  // points that were seen are marked in 'visited', and only those marks are
+  // reset at the end, so this takes O(maxNumPoints) time.
+  referenceIndices.set_size(maxNumPoints);
+  size_t numCandidates = 0;
+  for (size_t i = 0; i < numTablesToSearch; ++i) // For all tables
   {
-    // Heuristic: larger maxNumPoints means we should use find() because it
-    // should be faster.
-    // Reference points hashed in the same bucket as the query are set to >0.
-    arma::Col<size_t> refPointsConsidered;
-    refPointsConsidered.zeros(referenceSet->n_cols);
-
-    for (size_t i = 0; i < numTablesToSearch; ++i) // for all tables
+    for (size_t p = 0; p < T + 1; ++p) // For entire probing sequence.
     {
-      for (size_t p = 0; p < T + 1; ++p) // For entire probing sequence.
-      {
-        // get the sequence code
-        size_t hashInd = hashMat(p, i);
-        size_t tableRow = bucketRowInHashTable[hashInd];
+      const size_t hashInd = hashMat(p, i); // Find the query's bucket.
+      const size_t tableRow = bucketRowInHashTable[hashInd];
 
-        if (tableRow < secondHashSize && bucketContentSize[tableRow] > 0)
+      if (tableRow < secondHashSize)
+      {
+        // Store all the points of the bucket in the candidates set.
+        for (size_t j = bucketOffsets[tableRow];
+             j < bucketOffsets[tableRow + 1]; ++j)
         {
-          // Pick the indices in the bucket corresponding to hashInd.
-          for (size_t j = 0; j < bucketContentSize[tableRow]; ++j)
-            refPointsConsidered[ secondHashTable[tableRow](j) ]++;
+          const size_t index = bucketContents[j];
+          if (!visited[index] && !removed[index])
+          {
+            visited[index] = true;
+            referenceIndices[numCandidates++] = index;
+          }
         }
       }
     }
-
-    // Only keep reference points found in at least one bucket.
-    referenceIndices = arma::find(refPointsConsidered > 0);
-    return;
   }
-  else
-  {
-    // Heuristic: smaller maxNumPoints means we should use unique() because it
-    // should be faster.
-    // Allocate space for the query's potential neighbors.
-    arma::uvec refPointsConsideredSmall;
-    refPointsConsideredSmall.zeros(maxNumPoints);
 
-    // Retrieve candidates.
-    size_t start = 0;
-
-    for (size_t i = 0; i < numTablesToSearch; ++i) // For all tables
-    {
-      for (size_t p = 0; p < T + 1; ++p)
-      {
-        const size_t hashInd =  hashMat(p, i); // Find the query's bucket.
-        const size_t tableRow = bucketRowInHashTable[hashInd];
-
-        if (tableRow < secondHashSize)
-        {
-          // Store all secondHashTable points in the candidates set.
-          for (size_t j = 0; j < bucketContentSize[tableRow]; ++j)
-            refPointsConsideredSmall(start++) = secondHashTable[tableRow](j);
-       }
-      }
-    }
+  referenceIndices.resize(numCandidates);
+  for (size_t j = 0; j < numCandidates; ++j)
+    visited[referenceIndices[j]] = false;
 
-    // Keep only one copy of each candidate.
-    referenceIndices = arma::unique(refPointsConsideredSmall);
-    return;
-  }
+  // Sort the candidates, so that the reference set is read in order when
+  // their distances are computed.
+  referenceIndices = arma::sort(referenceIndices);
 }
 
 // Search for nearest neighbors in a given query set.
@@ -934,40 +1107,37 @@ void LSHSearch<SortPolicy>::Search(const arma::mat& querySet,
 
   Timer::Start("computing_neighbors");
 
-  // Parallelization to process more than one query at a time.
+  // Parallelization to process more than one query at a time.  Each thread
+  // has its own bitmap of the reference points, to find duplicate candidates.
+  #pragma omp parallel shared(resultingNeighbors, distances)
+  {
+    std::vector<bool> visited(referenceSet->n_cols, false);
+    arma::uvec refIndices;
+
 #ifdef _WIN32
-  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
-  // support unsigned loop variables. If we're building for Visual Studio, use
-  // the intmax_t type instead.
-  #pragma omp parallel for \
-      shared(resultingNeighbors, distances) \
-      schedule(dynamic)\
-      reduction(+:avgIndicesReturned)
-  for (intmax_t i = 0; i < (intmax_t) querySet.n_cols; ++i)
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables. If we're building for Visual Studio,
+    // use the intmax_t type instead.
+    #pragma omp for schedule(dynamic) reduction(+:avgIndicesReturned)
+    for (intmax_t i = 0; i < (intmax_t) querySet.n_cols; ++i)
 #else
-  #pragma omp parallel for \
-      shared(resultingNeighbors, distances) \
-      schedule(dynamic)\
-      reduction(+:avgIndicesReturned)
-  for (size_t i = 0; i < querySet.n_cols; ++i)
+    #pragma omp for schedule(dynamic) reduction(+:avgIndicesReturned)
+    for (size_t i = 0; i < querySet.n_cols; ++i)
 #endif
-  {
-    // Go through every query point.
-    // Hash every query into every hash table and eventually into the
-    // 'secondHashTable' to obtain the neighbor candidates.
-    arma::uvec refIndices;
-    ReturnIndicesFromTable(querySet.col(i), refIndices, numTablesToSearch,
-        Teffective);
-
-    // An informative book-keeping for the number of neighbor candidates
-    // returned on average.
-    // Make atomic to avoid race conditions when multiple threads are running
-    // #pragma omp atomic
-    avgIndicesReturned = avgIndicesReturned + refIndices.n_elem;
-
-    // Sequentially go through all the candidates and save the best 'k'
-    // candidates.
-    BaseCase(i, refIndices, k, querySet, resultingNeighbors, distances);
+    {
+      // Go through every query point.
+      // Hash every query into every hash table and eventually into the
+      // second hash table to obtain the neighbor candidates.
+      ReturnIndicesFromTable(querySet.col(i), refIndices, numTablesToSearch,
+          Teffective, visited);
+
+      // An informative book-keeping for the number of neighbor candidates
+      // returned on average.
+      avgIndicesReturned += refIndices.n_elem;
+
+      // Go through all the candidates and save the best 'k' candidates.
+      BaseCase(i, refIndices, k, querySet, resultingNeighbors, distances);
+    }
   }
 
   Timer::Stop("computing_neighbors");
@@ -1011,40 +1181,37 @@ Search(const size_t k,
 
   Timer::Start("computing_neighbors");
 
-  // Parallelization to process more than one query at a time.
+  // Parallelization to process more than one query at a time.  Each thread
+  // has its own bitmap of the reference points, to find duplicate candidates.
+  #pragma omp parallel shared(resultingNeighbors, distances)
+  {
+    std::vector<bool> visited(referenceSet->n_cols, false);
+    arma::uvec refIndices;
+
 #ifdef _WIN32
-  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
-  // support unsigned loop variables. If we're building for Visual Studio, use
-  // the intmax_t type instead.
-  #pragma omp parallel for \
-      shared(resultingNeighbors, distances) \
-      schedule(dynamic)\
-      reduction(+:avgIndicesReturned)
-  for (intmax_t i = 0; i < (intmax_t) referenceSet->n_cols; ++i)
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables. If we're building for Visual Studio,
+    // use the intmax_t type instead.
+    #pragma omp for schedule(dynamic) reduction(+:avgIndicesReturned)
+    for (intmax_t i = 0; i < (intmax_t) referenceSet->n_cols; ++i)
 #else
-  #pragma omp parallel for \
-      shared(resultingNeighbors, distances) \
-      schedule(dynamic)\
-      reduction(+:avgIndicesReturned)
-  for (size_t i = 0; i < referenceSet->n_cols; ++i)
+    #pragma omp for schedule(dynamic) reduction(+:avgIndicesReturned)
+    for (size_t i = 0; i < referenceSet->n_cols; ++i)
 #endif
-  {
-    // Go through every query point.
-    // Hash every query into every hash table and eventually into the
-    // 'secondHashTable' to obtain the neighbor candidates.
-    arma::uvec refIndices;
-    ReturnIndicesFromTable(referenceSet->col(i), refIndices, numTablesToSearch,
-        Teffective);
-
-    // An informative book-keeping for the number of neighbor candidates
-    // returned on average.
-    // Make atomic to avoid race conditions when multiple threads are running.
-    // #pragma omp atomic
-    avgIndicesReturned += refIndices.n_elem;
-
-    // Sequentially go through all the candidates and save the best 'k'
-    // candidates.
-    BaseCase(i, refIndices, k, resultingNeighbors, distances);
+    {
+      // Go through every query point.
+      // Hash every query into every hash table and eventually into the
+      // second hash table to obtain the neighbor candidates.
+      ReturnIndicesFromTable(referenceSet->col(i), refIndices,
+          numTablesToSearch, Teffective, visited);
+
+      // An informative book-keeping for the number of neighbor candidates
+      // returned on average.
+      avgIndicesReturned += refIndices.n_elem;
+
+      // Go through all the candidates and save the best 'k' candidates.
+      BaseCase(i, refIndices, k, resultingNeighbors, distances);
+    }
   }
 
   Timer::Stop("computing_neighbors");
@@ -1126,81 +1293,128 @@ void LSHSearch<SortPolicy>::Serialize(Archive& ar,
   ar & CreateNVP(secondHashSize, "secondHashSize");
   ar & CreateNVP(secondHashWeights, "secondHashWeights");
   ar & CreateNVP(bucketSize, "bucketSize");
-  // needs specific handling for new version
 
-  // Backward compatibility: in older versions of LSHSearch, the secondHashTable
-  // was stored as an arma::Mat<size_t>.  So we need to properly load that, then
-  // prune it down to size.
-  if (version == 0)
+  // Versions 0 and 1 stored the second hash table as one vector per bucket,
+  // which we load and then lay out one bucket after the other.
+  if (version < 2)
   {
-    arma::Mat<size_t> tmpSecondHashTable;
-    ar & CreateNVP(tmpSecondHashTable, "secondHashTable");
+    std::vector<arma::Col<size_t>> secondHashTable;
+    arma::Col<size_t> bucketContentSize;
 
-    // The old secondHashTable was stored in row-major format, so we transpose
-    // it.
-    tmpSecondHashTable = tmpSecondHashTable.t();
-
-    secondHashTable.resize(tmpSecondHashTable.n_cols);
-    for (size_t i = 0; i < tmpSecondHashTable.n_cols; ++i)
+    // Backward compatibility: in older versions of LSHSearch, the
+    // secondHashTable was stored as an arma::Mat<size_t>.  So we need to
+    // properly load that, then prune it down to size.
+    if (version == 0)
     {
-      // Find length of each column.  We know we are at the end of the list when
-      // the value referenceSet->n_cols is seen.
+      arma::Mat<size_t> tmpSecondHashTable;
+      ar & CreateNVP(tmpSecondHashTable, "secondHashTable");
 
-      size_t len = 0;
-      for (; len < tmpSecondHashTable.n_rows; ++len)
-        if (tmpSecondHashTable(len, i) == referenceSet->n_cols)
-          break;
+      // The old secondHashTable was stored in row-major format, so we
+      // transpose it.
+      tmpSecondHashTable = tmpSecondHashTable.t();
 
-      // Set the size of the new column correctly.
-      secondHashTable[i].set_size(len);
-      for (size_t j = 0; j < len; ++j)
-        secondHashTable[i](j) = tmpSecondHashTable(j, i);
+      secondHashTable.resize(tmpSecondHashTable.n_cols);
+      for (size_t i = 0; i < tmpSecondHashTable.n_cols; ++i)
+      {
+        // Find length of each column.  We know we are at the end of the list
+        // when the value referenceSet->n_cols is seen.
+
+        size_t len = 0;
+        for (; len < tmpSecondHashTable.n_rows; ++len)
+          if (tmpSecondHashTable(len, i) == referenceSet->n_cols)
+            break;
+
+        // Set the size of the new column correctly.
+        secondHashTable[i].set_size(len);
+        for (size_t j = 0; j < len; ++j)
+          secondHashTable[i](j) = tmpSecondHashTable(j, i);
+      }
     }
-  }
-  else
-  {
-    size_t tables;
-    if (Archive::is_saving::value)
-      tables = secondHashTable.size();
-    ar & CreateNVP(tables, "numSecondHashTables");
-
-    // Set size of second hash table if needed.
-    if (Archive::is_loading::value)
+    else
     {
-      secondHashTable.clear();
+      size_t tables;
+      ar & CreateNVP(tables, "numSecondHashTables");
       secondHashTable.resize(tables);
+
+      for (size_t i = 0; i < secondHashTable.size(); ++i)
+      {
+        std::ostringstream oss;
+        oss << "secondHashTable" << i;
+        ar & CreateNVP(secondHashTable[i], oss.str());
+      }
+    }
+
+    // Backward compatibility: old versions of LSHSearch held bucketContentSize
+    // for all possible buckets (of size secondHashSize), but later versions
+    // hold a compressed representation.
+    if (version == 0)
+    {
+      // The vector was stored in the old uncompressed form.  So we need to
+      // shrink it.  But we can't do that until we have bucketRowInHashTable,
+      // so we also have to load that.
+      arma::Col<size_t> tmpBucketContentSize;
+      ar & CreateNVP(tmpBucketContentSize, "bucketContentSize");
+      ar & CreateNVP(bucketRowInHashTable, "bucketRowInHashTable");
+
+      // Compress into a smaller vector by just dropping all of the zeros.
+      bucketContentSize.zeros(secondHashTable.size());
+      for (size_t i = 0; i < tmpBucketContentSize.n_elem; ++i)
+        if (tmpBucketContentSize[i] > 0)
+          bucketContentSize[bucketRowInHashTable[i]] = tmpBucketContentSize[i];
+    }
+    else
+    {
+      ar & CreateNVP(bucketContentSize, "bucketContentSize");
+      ar & CreateNVP(bucketRowInHashTable, "bucketRowInHashTable");
     }
 
+    // Now store the buckets one after the other.
+    bucketOffsets.zeros(secondHashTable.size() + 1);
+    for (size_t i = 0; i < secondHashTable.size(); ++i)
+      bucketOffsets[i + 1] = bucketOffsets[i] + bucketContentSize[i];
+
+    bucketContents.set_size(bucketOffsets[secondHashTable.size()]);
     for (size_t i = 0; i < secondHashTable.size(); ++i)
     {
-      std::ostringstream oss;
-      oss << "secondHashTable" << i;
-      ar & CreateNVP(secondHashTable[i], oss.str());
+      for (size_t j = 0; j < bucketContentSize[i]; ++j)
+        bucketContents[bucketOffsets[i] + j] = secondHashTable[i][j];
     }
   }
-
-  // Backward compatibility: old versions of LSHSearch held bucketContentSize
-  // for all possible buckets (of size secondHashSize), but now we hold a
-  // compressed representation.
-  if (version == 0)
+  else
   {
-    // The vector was stored in the old uncompressed form.  So we need to shrink
-    // it.  But we can't do that until we have bucketRowInHashTable, so we also
-    // have to load that.
-    arma::Col<size_t> tmpBucketContentSize;
-    ar & CreateNVP(tmpBucketContentSize, "bucketContentSize");
+    ar & CreateNVP(bucketOffsets, "bucketOffsets");
+    ar & CreateNVP(bucketContents, "bucketContents");
     ar & CreateNVP(bucketRowInHashTable, "bucketRowInHashTable");
+  }
 
-    // Compress into a smaller vector by just dropping all of the zeros.
-    bucketContentSize.set_size(secondHashTable.size());
-    for (size_t i = 0; i < tmpBucketContentSize.n_elem; ++i)
-      if (tmpBucketContentSize[i] > 0)
-        bucketContentSize[bucketRowInHashTable[i]] = tmpBucketContentSize[i];
+  // Versions before 3 had no removed points; the removed points are stored as
+  // a list of indices.
+  if (version < 3)
+  {
+    removed.assign(referenceSet->n_cols, false);
+    numPendingRemovals = 0;
   }
   else
   {
-    ar & CreateNVP(bucketContentSize, "bucketContentSize");
-    ar & CreateNVP(bucketRowInHashTable, "bucketRowInHashTable");
+    arma::Col<size_t> removedIndices;
+    if (Archive::is_saving::value)
+    {
+      std::vector<size_t> indices;
+      for (size_t i = 0; i < removed.size(); ++i)
+        if (removed[i])
+          indices.push_back(i);
+      removedIndices = arma::conv_to<arma::Col<size_t>>::from(indices);
+    }
+
+    ar & CreateNVP(removedIndices, "removedIndices");
+    ar & CreateNVP(numPendingRemovals, "numPendingRemovals");
+
+    if (Archive::is_loading::value)
+    {
+      removed.assign(referenceSet->n_cols, false);
+      for (size_t i = 0; i < removedIndices.n_elem; ++i)
+        removed[removedIndices[i]] = true;
+    }
   }
 
   ar & CreateNVP(distanceEvaluations, "distanceEvaluations");
@@ -0,0 +1,227 @@
+/**
+ * @file simhash_search.hpp
+ *
+ * Defines the SimHashSearch class, which hashes points with sign random
+ * projections (SimHash) into bit-packed codes and searches them in Hamming
+ * space, with multi-index hashing for exact Hamming-radius search.
+ *
+ * The details of the hash family can be found in the following paper:
+ *
+ * @inproceedings{charikar2002similarity,
+ *  title={Similarity estimation techniques from rounding algorithms},
+ *  author={Charikar, M.S.},
+ *  booktitle={Proceedings of the 34th Annual ACM Symposium on Theory of
+ *      Computing},
+ *  pages={380--388},
+ *  year={2002}
+ * }
+ *
+ * and the details of multi-index hashing in the following paper:
+ *
+ * @inproceedings{norouzi2012fast,
+ *  title={Fast search in Hamming space with multi-index hashing},
+ *  author={Norouzi, M. and Punjani, A. and Fleet, D.J.},
+ *  booktitle={Proceedings of the IEEE Conference on Computer Vision and
+ *      Pattern Recognition},
+ *  pages={3108--3115},
+ *  year={2012}
+ * }
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_LSH_SIMHASH_SEARCH_HPP
+#define MLPACK_METHODS_LSH_SIMHASH_SEARCH_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include <unordered_map>
+
+namespace mlpack {
+namespace neighbor {
+
+/**
+ * The SimHashSearch class hashes each point to a code of the given number of
+ * bits, where bit b is the sign of the projection of the point on a random
+ * Gaussian direction.  Two points at an angle theta differ in each bit with
+ * probability theta / pi, so the Hamming distance between codes estimates the
+ * angle (and the cosine similarity) between the points.
+ *
+ * The codes are packed into 64-bit words, so a point takes bits / 8 bytes, and
+ * Hamming distances are computed with one XOR and one population count per
+ * word; when the compiler targets a CPU with a popcount instruction (for
+ * instance with -mpopcnt or -march=native), it is used.  Search() finds the
+ * nearest codes by scanning all of them.  RangeSearch() finds all codes within
+ * a Hamming radius exactly, with multi-index hashing: the codes are split into
+ * the given number of substrings, each indexed in a hash table, and since a
+ * code within radius r of the query has at least one substring within radius
+ * r / substrings of the query's, only the buckets of those substrings are
+ * visited.  Query points are searched in parallel when OpenMP is available.
+ *
+ * @code
+ * SimHashSearch<> simhash(embeddings, 128, 4);
+ *
+ * arma::Mat<size_t> neighbors;
+ * arma::mat distances;
+ * simhash.Search(queries, 10, neighbors, distances);
+ *
+ * std::vector<std::vector<size_t>> close;
+ * std::vector<std::vector<double>> closeDistances;
+ * simhash.RangeSearch(queries, 8, close, closeDistances);
+ * @endcode
+ *
+ * @tparam MatType The type of data matrix.
+ */
+template<typename MatType = arma::mat>
+class SimHashSearch
+{
+ public:
+  /**
+   * Create the SimHashSearch object without projections.  Train() must be
+   * called before searching.
+   *
+   * @param bits Number of bits of each code.
+   * @param substrings Number of substrings (and hash tables) of multi-index
+   *     hashing; each substring may have at most 64 bits.
+   */
+  SimHashSearch(const size_t bits = 64, const size_t substrings = 4);
+
+  /**
+   * Create the SimHashSearch object and hash the given reference set.
+   *
+   * @param referenceSet Set of reference points.
+   * @param bits Number of bits of each code.
+   * @param substrings Number of substrings (and hash tables) of multi-index
+   *     hashing; each substring may have at most 64 bits.
+   */
+  SimHashSearch(const MatType& referenceSet,
+                const size_t bits = 64,
+                const size_t substrings = 4);
+
+  /**
+   * Draw new random projections, and hash the given reference set, replacing
+   * the current codes.
+   *
+   * @param referenceSet Set of reference points.
+   */
+  void Train(const MatType& referenceSet);
+
+  /**
+   * Find the k reference points with the closest codes to the code of each
+   * query point, with the Hamming distances between the codes.
+   *
+   * @param querySet Set of query points.
+   * @param k Number of neighbors to search for.
+   * @param neighbors Matrix storing lists of neighbors for each query point.
+   * @param distances Matrix storing the Hamming distances of the neighbors for
+   *     each query point.
+   */
+  void Search(const MatType& querySet,
+              const size_t k,
+              arma::Mat<size_t>& neighbors,
+              arma::mat& distances) const;
+
+  /**
+   * Find all reference points whose code is within the given Hamming distance
+   * of the code of each query point, closest first.
+   *
+   * @param querySet Set of query points.
+   * @param radius Largest Hamming distance.
+   * @param neighbors Object storing the list of neighbors of each query point.
+   * @param distances Object storing the Hamming distances of the neighbors of
+   *     each query point.
+   */
+  void RangeSearch(const MatType& querySet,
+                   const size_t radius,
+                   std::vector<std::vector<size_t>>& neighbors,
+                   std::vector<std::vector<double>>& distances) const;
+
+  /**
+   * Compute the code of the given point, which must have the dimensionality of
+   * the reference points.
+   *
+   * @param point Point to hash.
+   * @param code Words of the code (Words() of them).
+   */
+  template<typename VecType>
+  void Hash(const VecType& point, uint64_t* code) const;
+
+  //! Compute the Hamming distance between two codes of the given length.
+  static size_t HammingDistance(const uint64_t* a,
+                                const uint64_t* b,
+                                const size_t words);
+
+  //! Get the number of bits of each code.
+  size_t Bits() const { return bits; }
+  //! Get the number of 64-bit words of each code.
+  size_t Words() const { return (bits + 63) / 64; }
+  //! Get the number of substrings of multi-index hashing.
+  size_t Substrings() const { return substrings; }
+  //! Get the number of reference points.
+  size_t Size() const { return size; }
+
+  //! Get the random projections (one per row).
+  const arma::mat& Projections() const { return projections; }
+  //! Get the code of the given reference point.
+  const uint64_t* Code(const size_t point) const
+  { return codes.data() + point * Words(); }
+
+  //! Serialize the index.
+  template<typename Archive>
+  void Serialize(Archive& ar, const unsigned int /* version */);
+
+ private:
+  //! A point and its Hamming distance to the query point.
+  typedef std::pair<size_t, size_t> Candidate;
+  //! The hash table of a substring: the points for each value.
+  typedef std::unordered_map<uint64_t, std::vector<size_t>> Table;
+
+  //! Throw if the query points don't have the dimensionality of the
+  //! reference points; function is the name of the calling function.
+  void CheckDimensionality(const MatType& querySet,
+                           const char* function) const;
+
+  //! Get the first bit of the given substring.
+  size_t SubstringBegin(const size_t substring) const;
+
+  //! Extract the given substring of a code.
+  uint64_t Substring(const uint64_t* code, const size_t substring) const;
+
+  //! Fill the hash tables of the substrings with the codes.
+  void BuildTables();
+
+  /**
+   * Add the points of the buckets of the given table whose values differ from
+   * the given value in at most the given number of bits, starting at the given
+   * bit.
+   */
+  void Probe(const Table& table,
+             const uint64_t value,
+             const size_t length,
+             const size_t firstBit,
+             const size_t flips,
+             std::vector<size_t>& candidates) const;
+
+  //! Number of bits of each code.
+  size_t bits;
+  //! Number of substrings of multi-index hashing.
+  size_t substrings;
+  //! Number of reference points.
+  size_t size;
+  //! The random projections (one per row).
+  arma::mat projections;
+  //! The codes of the reference points, Words() words per point.
+  std::vector<uint64_t> codes;
+  //! The hash table of each substring.
+  std::vector<Table> tables;
+};
+
+} // namespace neighbor
+} // namespace mlpack
+
+// Include implementation.
+#include "simhash_search_impl.hpp"
+
+#endif
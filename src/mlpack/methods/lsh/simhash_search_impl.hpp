@@ -0,0 +1,364 @@
+/**
+ * @file simhash_search_impl.hpp
+ *
+ * Implementation of the SimHashSearch class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_LSH_SIMHASH_SEARCH_IMPL_HPP
+#define MLPACK_METHODS_LSH_SIMHASH_SEARCH_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "simhash_search.hpp"
+
+#ifdef _MSC_VER
+  #include <intrin.h>
+#endif
+
+namespace mlpack {
+namespace neighbor {
+
+template<typename MatType>
+SimHashSearch<MatType>::SimHashSearch(const size_t bits,
+                                      const size_t substrings) :
+    bits(bits),
+    substrings(substrings),
+    size(0)
+{
+  if (bits == 0)
+  {
+    throw std::invalid_argument("SimHashSearch::SimHashSearch(): the number "
+        "of bits must be positive");
+  }
+
+  if (substrings == 0 || substrings > bits || (bits + substrings - 1) /
+      substrings > 64)
+  {
+    std::ostringstream error;
+    error << "SimHashSearch::SimHashSearch(): the number of substrings ("
+        << substrings << ") must be between 1 and the number of bits (" << bits
+        << "), with at most 64 bits per substring";
+    throw std::invalid_argument(error.str());
+  }
+}
+
+template<typename MatType>
+SimHashSearch<MatType>::SimHashSearch(const MatType& referenceSet,
+                                      const size_t bits,
+                                      const size_t substrings) :
+    SimHashSearch(bits, substrings)
+{
+  Train(referenceSet);
+}
+
+template<typename MatType>
+void SimHashSearch<MatType>::Train(const MatType& referenceSet)
+{
+  Timer::Start("hash_building");
+
+  projections.randn(bits, referenceSet.n_rows);
+  size = referenceSet.n_cols;
+  codes.assign(size * Words(), 0);
+
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables. If we're building for Visual Studio, use
+  // the intmax_t type instead.
+  #pragma omp parallel for schedule(static)
+  for (intmax_t i = 0; i < (intmax_t) size; ++i)
+#else
+  #pragma omp parallel for schedule(static)
+  for (size_t i = 0; i < size; ++i)
+#endif
+  {
+    Hash(referenceSet.col(i), codes.data() + i * Words());
+  }
+
+  BuildTables();
+
+  Timer::Stop("hash_building");
+}
+
+template<typename MatType>
+template<typename VecType>
+void SimHashSearch<MatType>::Hash(const VecType& point, uint64_t* code) const
+{
+  const arma::vec projected = projections *
+      arma::conv_to<arma::vec>::from(point);
+  for (size_t w = 0; w < Words(); ++w)
+    code[w] = 0;
+  for (size_t b = 0; b < bits; ++b)
+  {
+    if (projected[b] >= 0.0)
+      code[b / 64] |= (uint64_t(1) << (b % 64));
+  }
+}
+
+template<typename MatType>
+size_t SimHashSearch<MatType>::HammingDistance(const uint64_t* a,
+                                               const uint64_t* b,
+                                               const size_t words)
+{
+  size_t distance = 0;
+  for (size_t w = 0; w < words; ++w)
+  {
+    const uint64_t difference = a[w] ^ b[w];
+#if defined(__GNUC__)
+    distance += __builtin_popcountll(difference);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    distance += __popcnt64(difference);
+#else
+    // Count the bits of each byte in parallel, then sum the bytes.
+    uint64_t x = difference - ((difference >> 1) & 0x5555555555555555ULL);
+    x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    distance += (x * 0x0101010101010101ULL) >> 56;
+#endif
+  }
+
+  return distance;
+}
+
+template<typename MatType>
+void SimHashSearch<MatType>::Search(const MatType& querySet,
+                                    const size_t k,
+                                    arma::Mat<size_t>& neighbors,
+                                    arma::mat& distances) const
+{
+  if (k > size)
+  {
+    std::stringstream ss;
+    ss << "requested value of k (" << k << ") is greater than the number of "
+        << "points in the reference set (" << size << ")";
+    throw std::invalid_argument(ss.str());
+  }
+
+  CheckDimensionality(querySet, "Search");
+
+  Timer::Start("computing_neighbors");
+
+  neighbors.set_size(k, querySet.n_cols);
+  distances.set_size(k, querySet.n_cols);
+
+  #pragma omp parallel
+  {
+    std::vector<uint64_t> queryCode(Words());
+    std::vector<Candidate> found;
+
+#ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables. If we're building for Visual Studio,
+    // use the intmax_t type instead.
+    #pragma omp for schedule(dynamic, 16)
+    for (intmax_t i = 0; i < (intmax_t) querySet.n_cols; ++i)
+#else
+    #pragma omp for schedule(dynamic, 16)
+    for (size_t i = 0; i < querySet.n_cols; ++i)
+#endif
+    {
+      Hash(querySet.col(i), queryCode.data());
+
+      // Scan all the codes, and keep the closest in a max-heap.
+      found.clear();
+      const uint64_t* code = codes.data();
+      for (size_t j = 0; j < size && k > 0; ++j, code += Words())
+      {
+        const size_t distance = HammingDistance(queryCode.data(), code,
+            Words());
+        if (found.size() < k)
+        {
+          found.push_back(Candidate(distance, j));
+          std::push_heap(found.begin(), found.end());
+        }
+        else if (distance < found.front().first)
+        {
+          std::pop_heap(found.begin(), found.end());
+          found.back() = Candidate(distance, j);
+          std::push_heap(found.begin(), found.end());
+        }
+      }
+      std::sort_heap(found.begin(), found.end());
+
+      for (size_t j = 0; j < k; ++j)
+      {
+        neighbors(j, i) = found[j].second;
+        distances(j, i) = (double) found[j].first;
+      }
+    }
+  }
+
+  Timer::Stop("computing_neighbors");
+}
+
+template<typename MatType>
+void SimHashSearch<MatType>::RangeSearch(
+    const MatType& querySet,
+    const size_t radius,
+    std::vector<std::vector<size_t>>& neighbors,
+    std::vector<std::vector<double>>& distances) const
+{
+  CheckDimensionality(querySet, "RangeSearch");
+
+  Timer::Start("computing_neighbors");
+
+  neighbors.clear();
+  neighbors.resize(querySet.n_cols);
+  distances.clear();
+  distances.resize(querySet.n_cols);
+
+  // By the pigeonhole principle, a code within the radius has a substring
+  // within this radius of the query's.
+  const size_t flips = radius / substrings;
+
+  #pragma omp parallel
+  {
+    std::vector<uint64_t> queryCode(Words());
+    std::vector<size_t> candidates;
+    std::vector<Candidate> found;
+
+#ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables. If we're building for Visual Studio,
+    // use the intmax_t type instead.
+    #pragma omp for schedule(dynamic, 16)
+    for (intmax_t i = 0; i < (intmax_t) querySet.n_cols; ++i)
+#else
+    #pragma omp for schedule(dynamic, 16)
+    for (size_t i = 0; i < querySet.n_cols; ++i)
+#endif
+    {
+      Hash(querySet.col(i), queryCode.data());
+
+      candidates.clear();
+      for (size_t s = 0; s < substrings; ++s)
+      {
+        const size_t length = SubstringBegin(s + 1) - SubstringBegin(s);
+        Probe(tables[s], Substring(queryCode.data(), s), length, 0,
+            std::min(flips, length), candidates);
+      }
+      std::sort(candidates.begin(), candidates.end());
+      candidates.erase(std::unique(candidates.begin(), candidates.end()),
+          candidates.end());
+
+      // Check the full codes of the candidates.
+      found.clear();
+      for (size_t j = 0; j < candidates.size(); ++j)
+      {
+        const size_t distance = HammingDistance(queryCode.data(),
+            Code(candidates[j]), Words());
+        if (distance <= radius)
+          found.push_back(Candidate(distance, candidates[j]));
+      }
+      std::sort(found.begin(), found.end());
+
+      neighbors[i].resize(found.size());
+      distances[i].resize(found.size());
+      for (size_t j = 0; j < found.size(); ++j)
+      {
+        neighbors[i][j] = found[j].second;
+        distances[i][j] = (double) found[j].first;
+      }
+    }
+  }
+
+  Timer::Stop("computing_neighbors");
+}
+
+template<typename MatType>
+void SimHashSearch<MatType>::CheckDimensionality(const MatType& querySet,
+                                                 const char* function) const
+{
+  // This is checked before the parallel loops, which can't throw.
+  if (querySet.n_rows != projections.n_cols)
+  {
+    std::ostringstream error;
+    error << "SimHashSearch::" << function << "(): the dimensionality of the "
+        << "query points (" << querySet.n_rows << ") doesn't match the "
+        << "dimensionality of the reference points (" << projections.n_cols
+        << ")";
+    throw std::invalid_argument(error.str());
+  }
+}
+
+template<typename MatType>
+size_t SimHashSearch<MatType>::SubstringBegin(const size_t substring) const
+{
+  // The first (bits % substrings) substrings have one more bit.
+  return substring * (bits / substrings) +
+      std::min(substring, bits % substrings);
+}
+
+template<typename MatType>
+uint64_t SimHashSearch<MatType>::Substring(const uint64_t* code,
+                                           const size_t substring) const
+{
+  const size_t begin = SubstringBegin(substring);
+  const size_t length = SubstringBegin(substring + 1) - begin;
+
+  // The substring may span two words.
+  const size_t word = begin / 64;
+  const size_t offset = begin % 64;
+  uint64_t value = code[word] >> offset;
+  if (offset + length > 64)
+    value |= code[word + 1] << (64 - offset);
+
+  return (length == 64) ? value : (value & ((uint64_t(1) << length) - 1));
+}
+
+template<typename MatType>
+void SimHashSearch<MatType>::BuildTables()
+{
+  tables.clear();
+  tables.resize(substrings);
+  for (size_t s = 0; s < substrings; ++s)
+    for (size_t i = 0; i < size; ++i)
+      tables[s][Substring(Code(i), s)].push_back(i);
+}
+
+template<typename MatType>
+void SimHashSearch<MatType>::Probe(const Table& table,
+                                   const uint64_t value,
+                                   const size_t length,
+                                   const size_t firstBit,
+                                   const size_t flips,
+                                   std::vector<size_t>& candidates) const
+{
+  typename Table::const_iterator it = table.find(value);
+  if (it != table.end())
+    candidates.insert(candidates.end(), it->second.begin(), it->second.end());
+
+  // Each set of flipped bits is enumerated once, in increasing order.
+  if (flips == 0)
+    return;
+  for (size_t b = firstBit; b < length; ++b)
+  {
+    Probe(table, value ^ (uint64_t(1) << b), length, b + 1, flips - 1,
+        candidates);
+  }
+}
+
+template<typename MatType>
+template<typename Archive>
+void SimHashSearch<MatType>::Serialize(Archive& ar,
+                                       const unsigned int /* version */)
+{
+  using data::CreateNVP;
+
+  ar & CreateNVP(bits, "bits");
+  ar & CreateNVP(substrings, "substrings");
+  ar & CreateNVP(size, "size");
+  ar & CreateNVP(projections, "projections");
+  ar & CreateNVP(codes, "codes");
+
+  // The hash tables are rebuilt from the codes.
+  if (Archive::is_loading::value)
+    BuildTables();
+}
+
+} // namespace neighbor
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,187 @@
+/**
+ * @file soft_impute.cpp
+ *
+ * Implementation of the SoftImpute class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "soft_impute.hpp"
+
+namespace mlpack {
+namespace matrix_completion {
+
+SoftImpute::SoftImpute(const size_t m,
+                       const size_t n,
+                       const arma::umat& indices,
+                       const arma::vec& values,
+                       const double lambda,
+                       const size_t maxRank,
+                       const size_t maxIterations,
+                       const double tolerance) :
+    m(m),
+    n(n),
+    lambda(lambda),
+    maxRank(maxRank),
+    maxIterations(maxIterations),
+    tolerance(tolerance),
+    iterations(0)
+{
+  if (indices.n_rows != 2)
+  {
+    Log::Fatal << "SoftImpute::SoftImpute(): matrix of constraint indices does "
+        << "not have 2 rows!" << std::endl;
+  }
+
+  if (indices.n_cols != values.n_elem)
+  {
+    Log::Fatal << "SoftImpute::SoftImpute(): the number of constraint indices "
+        << "(columns of constraint indices matrix) does not match the number "
+        << "of constraint values (length of constraint value vector)!"
+        << std::endl;
+  }
+
+  for (size_t i = 0; i < values.n_elem; i++)
+  {
+    if (indices(0, i) >= m || indices(1, i) >= n)
+      Log::Fatal << "SoftImpute::SoftImpute(): indices (" << indices(0, i)
+          << ", " << indices(1, i) << ") are out of bounds for matrix of size "
+          << m << " x " << n << "!" << std::endl;
+  }
+
+  // Sort the known entries by column and then by row, so that the residuals
+  // are the values of a sparse matrix with a fixed structure.
+  std::vector<size_t> order(values.n_elem);
+  for (size_t i = 0; i < order.size(); ++i)
+    order[i] = i;
+  std::sort(order.begin(), order.end(), [&indices](const size_t a,
+      const size_t b)
+  {
+    return (indices(1, a) < indices(1, b)) ||
+        (indices(1, a) == indices(1, b) && indices(0, a) < indices(0, b));
+  });
+
+  this->values.set_size(values.n_elem);
+  rows.set_size(values.n_elem);
+  cols.set_size(values.n_elem);
+  colPointers.zeros(n + 1);
+  for (size_t i = 0; i < order.size(); ++i)
+  {
+    if (i > 0 && indices(0, order[i]) == rows[i - 1] &&
+        indices(1, order[i]) == cols[i - 1])
+    {
+      Log::Fatal << "SoftImpute::SoftImpute(): entry (" << rows[i - 1] << ", "
+          << cols[i - 1] << ") is given more than once!" << std::endl;
+    }
+
+    this->values[i] = values[order[i]];
+    rows[i] = indices(0, order[i]);
+    cols[i] = indices(1, order[i]);
+    ++colPointers[cols[i] + 1];
+  }
+
+  for (size_t j = 0; j < n; ++j)
+    colPointers[j + 1] += colPointers[j];
+}
+
+void SoftImpute::Recover(arma::mat& u, arma::vec& s, arma::mat& v)
+{
+  // Start from the zero matrix.
+  u.set_size(m, 0);
+  s.set_size(0);
+  v.set_size(n, 0);
+
+  // A few oversampled columns make the leading singular values accurate.
+  svd::RandomizedSVD rsvd(maxRank + 10, 2);
+
+  arma::vec residuals;
+  arma::mat newU, newV, product;
+  arma::vec newS;
+  for (iterations = 0; maxIterations == 0 || iterations < maxIterations;)
+  {
+    ++iterations;
+
+    // The filled matrix is the residuals on the known entries plus the
+    // current solution.
+    ComputeResiduals(u, s, v, residuals);
+    const arma::sp_mat sparse(rows, colPointers, residuals, m, n);
+    const SparsePlusLowRank filled(sparse, u, s, v);
+
+    rsvd.ApplyOperator(filled, newU, newS, newV, maxRank);
+
+    // Soft-threshold the singular values, and keep the positive ones.
+    size_t rank = 0;
+    while (rank < std::min(maxRank, (size_t) newS.n_elem) &&
+        newS[rank] > lambda)
+      ++rank;
+
+    newS = newS.head(rank) - lambda;
+    newU = newU.head_cols(rank);
+    newV = newV.head_cols(rank);
+
+    // The change of the solution, from its factors:
+    // ||Z1 - Z0||^2 = ||Z1||^2 + ||Z0||^2 - 2 tr(S1 U1^T U0 S0 V0^T V1).
+    const double oldNorm = arma::dot(s, s);
+    const double newNorm = arma::dot(newS, newS);
+    product = (newU.t() * u) * arma::diagmat(s) * (v.t() * newV);
+    const double change = std::max(oldNorm + newNorm - 2.0 *
+        arma::dot(product.diag(), newS), 0.0);
+
+    u.swap(newU);
+    s.swap(newS);
+    v.swap(newV);
+
+    Log::Info << "SoftImpute::Recover(): iteration " << iterations << ", rank "
+        << rank << ", relative change " << change / std::max(oldNorm, 1e-300)
+        << "." << std::endl;
+
+    if (change <= tolerance * oldNorm)
+      break;
+  }
+}
+
+void SoftImpute::Recover(arma::mat& recovered)
+{
+  arma::mat u, v;
+  arma::vec s;
+  Recover(u, s, v);
+  recovered = u * arma::diagmat(s) * v.t();
+}
+
+void SoftImpute::ComputeResiduals(const arma::mat& u,
+                                  const arma::vec& s,
+                                  const arma::mat& v,
+                                  arma::vec& residuals) const
+{
+  residuals.set_size(values.n_elem);
+
+  // The rows of u (scaled by s) and of v are needed, so they are made
+  // contiguous.
+  const arma::mat us = (u * arma::diagmat(s)).t();
+  const arma::mat vt = v.t();
+
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables. If we're building for Visual Studio, use
+  // the intmax_t type instead.
+  #pragma omp parallel for schedule(static)
+  for (intmax_t i = 0; i < (intmax_t) values.n_elem; ++i)
+#else
+  #pragma omp parallel for schedule(static)
+  for (size_t i = 0; i < values.n_elem; ++i)
+#endif
+  {
+    const double* left = us.colptr(rows[i]);
+    const double* right = vt.colptr(cols[i]);
+    double prediction = 0.0;
+    for (size_t k = 0; k < s.n_elem; ++k)
+      prediction += left[k] * right[k];
+
+    residuals[i] = values[i] - prediction;
+  }
+}
+
+} // namespace matrix_completion
+} // namespace mlpack
@@ -0,0 +1,228 @@
+/**
+ * @file soft_impute.hpp
+ *
+ * The Soft-Impute solver for matrix completion, which iterates soft-thresholded
+ * SVDs of a sparse plus low-rank matrix.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_MATRIX_COMPLETION_SOFT_IMPUTE_HPP
+#define MLPACK_METHODS_MATRIX_COMPLETION_SOFT_IMPUTE_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/methods/randomized_svd/randomized_svd.hpp>
+
+namespace mlpack {
+namespace matrix_completion {
+
+/**
+ * A sparse matrix plus a low-rank matrix U diag(s) V^T, given to
+ * svd::RandomizedSVD::ApplyOperator() through its products with dense
+ * matrices, which cost O(nnz l + (m + n) r l) for l columns instead of
+ * O(m n l).
+ */
+class SparsePlusLowRank
+{
+ public:
+  /**
+   * Create the operator.  The matrices are not copied, so they must outlive
+   * it.
+   *
+   * @param sparse Sparse part.
+   * @param u Left factor of the low-rank part.
+   * @param s Singular values of the low-rank part.
+   * @param v Right factor of the low-rank part.
+   */
+  SparsePlusLowRank(const arma::sp_mat& sparse,
+                    const arma::mat& u,
+                    const arma::vec& s,
+                    const arma::mat& v) :
+      sparse(sparse), u(u), s(s), v(v)
+  { }
+
+  //! Get the number of rows.
+  size_t Rows() const { return sparse.n_rows; }
+  //! Get the number of columns.
+  size_t Cols() const { return sparse.n_cols; }
+
+  //! Set output to the product of the matrix with x.
+  void Apply(const arma::mat& x, arma::mat& output) const
+  {
+    output = sparse * x;
+    if (s.n_elem > 0)
+      output += u * arma::diagmat(s) * (v.t() * x);
+  }
+
+  //! Set output to the product of the transposed matrix with x.
+  void ApplyTransposed(const arma::mat& x, arma::mat& output) const
+  {
+    output = sparse.t() * x;
+    if (s.n_elem > 0)
+      output += v * arma::diagmat(s) * (u.t() * x);
+  }
+
+ private:
+  //! The sparse part.
+  const arma::sp_mat& sparse;
+  //! The left factor of the low-rank part.
+  const arma::mat& u;
+  //! The singular values of the low-rank part.
+  const arma::vec& s;
+  //! The right factor of the low-rank part.
+  const arma::mat& v;
+};
+
+/**
+ * This class solves matrix completion problems with the Soft-Impute algorithm,
+ * which minimizes
+ *
+ *   1/2 sum_{(i, j) known} (X_ij - M_ij)^2 + lambda ||X||_*
+ *
+ * by replacing the unknown entries with those of the current solution Z and
+ * soft-thresholding the singular values of the filled matrix, until Z stops
+ * changing.  The filled matrix is the sparse matrix of the residuals on the
+ * known entries plus the low-rank Z, so its SVD is computed with
+ * svd::RandomizedSVD through products with that structure, and no m x n matrix
+ * is ever formed.  The residuals are computed in parallel when OpenMP is
+ * available.  Unlike MatrixCompletion, which solves an SDP with one constraint
+ * per known entry, this scales to millions of known entries.
+ *
+ * For more information, see the following paper:
+ *
+ * @code
+ * @article{mazumder2010spectral,
+ *   title={Spectral regularization algorithms for learning large incomplete
+ *       matrices},
+ *   author={Mazumder, R. and Hastie, T. and Tibshirani, R.},
+ *   journal={Journal of Machine Learning Research},
+ *   volume={11},
+ *   pages={2287--2322},
+ *   year={2010}
+ * }
+ * @endcode
+ *
+ * An example of how to use this class is shown below:
+ *
+ * @code
+ * size_t m, n;         // size of unknown matrix
+ * arma::umat indices;  // contains the known indices [2 x n_entries]
+ * arma::vec values;    // contains the known values [n_entries]
+ *
+ * SoftImpute si(m, n, indices, values, 0.5, 20);
+ * arma::mat u, v;
+ * arma::vec s;
+ * si.Recover(u, s, v); // The completed matrix is u * diagmat(s) * v.t().
+ * @endcode
+ *
+ * @see MatrixCompletion
+ */
+class SoftImpute
+{
+ public:
+  /**
+   * Construct a matrix completion problem.
+   *
+   * @param m Number of rows of original matrix.
+   * @param n Number of columns of original matrix.
+   * @param indices Matrix containing the indices of the known entries (must be
+   *    [2 x p]).
+   * @param values Vector containing the values of the known entries (must be
+   *    length p).
+   * @param lambda Regularization parameter (the singular value threshold).
+   * @param maxRank Maximum rank of the solution.
+   * @param maxIterations Maximum number of iterations (0 for no limit).
+   * @param tolerance Relative change of the solution for convergence.
+   */
+  SoftImpute(const size_t m,
+             const size_t n,
+             const arma::umat& indices,
+             const arma::vec& values,
+             const double lambda,
+             const size_t maxRank,
+             const size_t maxIterations = 100,
+             const double tolerance = 1e-5);
+
+  /**
+   * Solve the problem, and return the factors of the completed matrix, which
+   * is u * diagmat(s) * v.t().
+   *
+   * @param u Will contain the left singular vectors of the solution.
+   * @param s Will contain the singular values of the solution.
+   * @param v Will contain the right singular vectors of the solution.
+   */
+  void Recover(arma::mat& u, arma::vec& s, arma::mat& v);
+
+  /**
+   * Solve the problem, and return the completed matrix.
+   *
+   * @param recovered Will contain the completed matrix.
+   */
+  void Recover(arma::mat& recovered);
+
+  //! Get the regularization parameter.
+  double Lambda() const { return lambda; }
+  //! Modify the regularization parameter.
+  double& Lambda() { return lambda; }
+
+  //! Get the maximum rank of the solution.
+  size_t MaxRank() const { return maxRank; }
+  //! Modify the maximum rank of the solution.
+  size_t& MaxRank() { return maxRank; }
+
+  //! Get the maximum number of iterations.
+  size_t MaxIterations() const { return maxIterations; }
+  //! Modify the maximum number of iterations.
+  size_t& MaxIterations() { return maxIterations; }
+
+  //! Get the tolerance for convergence.
+  double Tolerance() const { return tolerance; }
+  //! Modify the tolerance for convergence.
+  double& Tolerance() { return tolerance; }
+
+  //! Get the number of iterations of the last call to Recover().
+  size_t Iterations() const { return iterations; }
+
+ private:
+  /**
+   * Compute the residuals of the solution u * diagmat(s) * v.t() on the known
+   * entries, in the order of values.
+   */
+  void ComputeResiduals(const arma::mat& u,
+                        const arma::vec& s,
+                        const arma::mat& v,
+                        arma::vec& residuals) const;
+
+  //! Number of rows in original matrix.
+  size_t m;
+  //! Number of columns in original matrix.
+  size_t n;
+  //! The regularization parameter.
+  double lambda;
+  //! The maximum rank of the solution.
+  size_t maxRank;
+  //! The maximum number of iterations.
+  size_t maxIterations;
+  //! The tolerance for convergence.
+  double tolerance;
+  //! The number of iterations of the last call to Recover().
+  size_t iterations;
+
+  //! The known values, sorted by column and then by row (the order of the
+  //! nonzero elements of a sparse matrix).
+  arma::vec values;
+  //! The row of each known entry, in the same order.
+  arma::uvec rows;
+  //! The column of each known entry, in the same order.
+  arma::uvec cols;
+  //! The index of the first known entry of each column, and the number of
+  //! known entries.
+  arma::uvec colPointers;
+};
+
+} // namespace matrix_completion
+} // namespace mlpack
+
+#endif
@@ -25,7 +25,8 @@ namespace meanshift /** Mean shift clustering. */ {
 /**
  * This class implements mean shift clustering.  For each point in dataset,
  * apply mean shift algorithm until maximum iterations or convergence.  Then
- * remove duplicate centroids.
+ * remove duplicate centroids.  When OpenMP is available, the points (or seeds)
+ * are shifted in parallel.
  *
  * A simple example of how to run mean shift clustering is shown below.
  *
@@ -109,6 +110,9 @@ class MeanShift
    * side length binSize, and any bins that contain fewer than minFreq points
    * will be removed as possible seeds.  Usually, 1 is a sufficient parameter
    * for minFreq, and the bin size can be set equal to the estimated radius.
+   * The bins are kept in a hash table that holds a few words per non-empty bin
+   * (independent of the dimensionality), and the seeds are in the order of the
+   * first point of their bin.
    *
    * @param data The reference data set.
    * @param binSize Width of hypercube bins.
@@ -120,6 +124,12 @@ class MeanShift
                 const int minFreq,
                 MatType& seeds);
 
+  //! Return whether the two given points of the dataset are in the same bin.
+  static bool SameBin(const MatType& data,
+                      const size_t first,
+                      const size_t second,
+                      const double binSize);
+
   /**
    * Use kernel to calculate new centroid given dataset and valid neighbors.
    *
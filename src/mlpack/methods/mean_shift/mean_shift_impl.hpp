@@ -18,7 +18,8 @@
 #include <mlpack/methods/neighbor_search/neighbor_search.hpp>
 #include <mlpack/methods/range_search/range_search.hpp>
 
-#include "map"
+#include <unordered_map>
+#include <boost/functional/hash.hpp>
 
 // In case it hasn't been included yet.
 #include "mean_shift.hpp"
@@ -71,23 +72,6 @@ EstimateRadius(const MatType& data, double ratio)
   return sum(maxDistances) / (double) data.n_cols;
 }
 
-// Class to compare two vectors.
-template <typename VecType>
-class less
-{
- public:
-  bool operator()(const VecType& first, const VecType& second) const
-  {
-    for (size_t i = 0; i < first.n_rows; ++i)
-    {
-      if (first[i] == second[i])
-        continue;
-      return first(i) < second(i);
-    }
-    return false;
-  }
-};
-
 // Generate seeds from given data set.
 template<bool UseKernel, typename KernelType, typename MatType>
 void MeanShift<UseKernel, KernelType, MatType>::GenSeeds(
@@ -96,32 +80,53 @@ void MeanShift<UseKernel, KernelType, MatType>::GenSeeds(
     const int minFreq,
     MatType& seeds)
 {
-  typedef arma::colvec VecType;
-  std::map<VecType, int, less<VecType> > allSeeds;
+  // The bins are found through a hash table of their coordinates.  Only the
+  // first point of each bin and the number of points in it are stored, and
+  // bins whose coordinates have the same hash are chained; so the table takes
+  // a few words per bin, whatever the dimensionality.
+  std::unordered_map<size_t, size_t> firstBins;
+  std::vector<size_t> binPoints, binCounts, nextBins;
   for (size_t i = 0; i < data.n_cols; ++i)
   {
-    VecType binnedPoint = arma::floor(data.unsafe_col(i) / binSize);
-    if (allSeeds.find(binnedPoint) == allSeeds.end())
-      allSeeds[binnedPoint] = 1;
-    else
-      allSeeds[binnedPoint]++;
+    size_t hash = 0;
+    // Adding 0 turns -0 into 0, so that they hash the same.
+    for (size_t d = 0; d < data.n_rows; ++d)
+      boost::hash_combine(hash, std::floor(data(d, i) / binSize) + 0.0);
+
+    std::unordered_map<size_t, size_t>::iterator it = firstBins.find(hash);
+    size_t bin = (it == firstBins.end()) ? SIZE_MAX : it->second;
+    while (bin != SIZE_MAX && !SameBin(data, binPoints[bin], i, binSize))
+      bin = nextBins[bin];
+
+    if (bin != SIZE_MAX)
+    {
+      ++binCounts[bin];
+      continue;
+    }
+
+    // This is a new bin; put it at the head of the chain of its hash.
+    nextBins.push_back((it == firstBins.end()) ? SIZE_MAX : it->second);
+    firstBins[hash] = binPoints.size();
+    binPoints.push_back(i);
+    binCounts.push_back(1);
   }
 
   // Remove seeds with too few points.  First we count the number of seeds we
-  // end up with, then we add them.
-  std::map<VecType, int, less<VecType> >::iterator it;
+  // end up with, then we add them, in the order of the first point of their
+  // bins.
   size_t count = 0;
-  for (it = allSeeds.begin(); it != allSeeds.end(); ++it)
-    if (it->second >= minFreq)
+  for (size_t b = 0; b < binCounts.size(); ++b)
+    if (binCounts[b] >= (size_t) minFreq)
       ++count;
 
   seeds.set_size(data.n_rows, count);
   count = 0;
-  for (it = allSeeds.begin(); it != allSeeds.end(); ++it)
+  for (size_t b = 0; b < binCounts.size(); ++b)
   {
-    if (it->second >= minFreq)
+    if (binCounts[b] >= (size_t) minFreq)
     {
-      seeds.col(count) = it->first;
+      for (size_t d = 0; d < data.n_rows; ++d)
+        seeds(d, count) = std::floor(data(d, binPoints[b]) / binSize);
       ++count;
     }
   }
@@ -129,6 +134,24 @@ void MeanShift<UseKernel, KernelType, MatType>::GenSeeds(
   seeds *= binSize;
 }
 
+// Check whether two points are in the same bin.
+template<bool UseKernel, typename KernelType, typename MatType>
+bool MeanShift<UseKernel, KernelType, MatType>::SameBin(
+    const MatType& data,
+    const size_t first,
+    const size_t second,
+    const double binSize)
+{
+  for (size_t d = 0; d < data.n_rows; ++d)
+  {
+    if (std::floor(data(d, first) / binSize) !=
+        std::floor(data(d, second) / binSize))
+      return false;
+  }
+
+  return true;
+}
+
 // Calculate new centroid with given kernel.
 template<bool UseKernel, typename KernelType, typename MatType>
 template<bool ApplyKernel>
@@ -203,61 +226,95 @@ inline void MeanShift<UseKernel, KernelType, MatType>::Cluster(
 
   // Holds all centroids before removing duplicate ones.
   arma::mat allCentroids(pSeeds->n_rows, pSeeds->n_cols);
+  // Whether the mean shift of each seed has converged.
+  std::vector<char> converged(pSeeds->n_cols, 0);
 
   assignments.set_size(data.n_cols);
 
-  range::RangeSearch<> rangeSearcher(data);
+  // The tree is built only once, and each thread searches it with its own
+  // single-tree RangeSearch object and its own buffers.  The points of the
+  // tree may be rearranged, so the centroids are computed from its dataset.
+  typedef range::RangeSearch<> RangeSearchType;
+  typename RangeSearchType::Tree referenceTree(data);
+  const arma::mat& treeData = referenceTree.Dataset();
   math::Range validRadius(0, radius);
-  std::vector<std::vector<size_t> > neighbors;
-  std::vector<std::vector<double> > distances;
 
-  // For each seed, perform mean shift algorithm.
-  for (size_t i = 0; i < pSeeds->n_cols; ++i)
+  // Each seed is shifted independently of the others.
+  #pragma omp parallel
   {
-    // Initial centroid is the seed itself.
-    allCentroids.col(i) = pSeeds->unsafe_col(i);
-    for (size_t completedIterations = 0; completedIterations < maxIterations;
-         completedIterations++)
+    RangeSearchType rangeSearcher(&referenceTree, true);
+    rangeSearcher.NumThreads() = 1;
+    std::vector<std::vector<size_t> > neighbors(1);
+    std::vector<std::vector<double> > distances(1);
+    range::RangeSearchVectorCallback callback(neighbors, distances);
+
+#ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables. If we're building for Visual Studio,
+    // use the intmax_t type instead.
+    #pragma omp for schedule(dynamic)
+    for (intmax_t i = 0; i < (intmax_t) pSeeds->n_cols; ++i)
+#else
+    #pragma omp for schedule(dynamic)
+    for (size_t i = 0; i < pSeeds->n_cols; ++i)
+#endif
     {
-      // Store new centroid in this.
-      arma::colvec newCentroid = arma::zeros<arma::colvec>(pSeeds->n_rows);
-
-      rangeSearcher.Search(allCentroids.unsafe_col(i), validRadius,
-          neighbors, distances);
-      if (neighbors[0].size() <= 1)
-        break;
-
-      // Calculate new centroid.
-      if (!CalculateCentroid(data, neighbors[0], distances[0], newCentroid))
-        newCentroid = allCentroids.unsafe_col(i);
-
-      // If the mean shift vector is small enough, it has converged.
-      if (metric::EuclideanDistance::Evaluate(newCentroid,
-          allCentroids.unsafe_col(i)) < 1e-3 * radius)
+      // Initial centroid is the seed itself.
+      allCentroids.col(i) = pSeeds->unsafe_col(i);
+      for (size_t completedIterations = 0;
+           completedIterations < maxIterations; completedIterations++)
       {
-        // Determine if the new centroid is duplicate with old ones.
-        bool isDuplicated = false;
-        for (size_t k = 0; k < centroids.n_cols; ++k)
+        // Store new centroid in this.
+        arma::colvec newCentroid = arma::zeros<arma::colvec>(pSeeds->n_rows);
+
+        neighbors[0].clear();
+        distances[0].clear();
+        rangeSearcher.Search(allCentroids.unsafe_col(i), validRadius,
+            callback);
+        if (neighbors[0].size() <= 1)
+          break;
+
+        // Calculate new centroid.
+        if (!CalculateCentroid(treeData, neighbors[0], distances[0],
+            newCentroid))
+          newCentroid = allCentroids.unsafe_col(i);
+
+        // If the mean shift vector is small enough, it has converged.
+        if (metric::EuclideanDistance::Evaluate(newCentroid,
+            allCentroids.unsafe_col(i)) < 1e-3 * radius)
         {
-          const double distance = metric::EuclideanDistance::Evaluate(
-              allCentroids.unsafe_col(i), centroids.unsafe_col(k));
-          if (distance < radius)
-          {
-            isDuplicated = true;
-            break;
-          }
+          converged[i] = 1;
+          break;
         }
 
-        if (!isDuplicated)
-          centroids.insert_cols(centroids.n_cols, allCentroids.unsafe_col(i));
+        // Update the centroid.
+        allCentroids.col(i) = newCentroid;
+      }
+    }
+  }
+
+  // Remove the duplicate centroids, in the order of the seeds, so that the
+  // result doesn't depend on the scheduling.
+  for (size_t i = 0; i < pSeeds->n_cols; ++i)
+  {
+    if (!converged[i])
+      continue;
 
-        // Get out of the loop.
+    // Determine if the new centroid is duplicate with old ones.
+    bool isDuplicated = false;
+    for (size_t k = 0; k < centroids.n_cols; ++k)
+    {
+      const double distance = metric::EuclideanDistance::Evaluate(
+          allCentroids.unsafe_col(i), centroids.unsafe_col(k));
+      if (distance < radius)
+      {
+        isDuplicated = true;
         break;
       }
-
-      // Update the centroid.
-      allCentroids.col(i) = newCentroid;
     }
+
+    if (!isDuplicated)
+      centroids.insert_cols(centroids.n_cols, allCentroids.unsafe_col(i));
   }
 
   // Assign centroids to each point.
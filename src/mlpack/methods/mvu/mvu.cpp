@@ -30,29 +30,42 @@ void MVU::Unfold(const size_t newDim,
                  const size_t numNeighbors,
                  arma::mat& outputData)
 {
+  SDP<arma::sp_mat> sdp;
+  BuildSDP(numNeighbors, sdp);
+
   // First we have to choose the output point.  We'll take a linear projection
   // of the data for now (this is probably not a good final solution).
 //  outputData = trans(data.rows(0, newDim - 1));
   // Following Nick's idea.
   outputData.randu(data.n_cols, newDim);
 
-  // The number of constraints is the number of nearest neighbors plus one.
-  LRSDP<arma::sp_mat> mvuSolver(numNeighbors * data.n_cols + 1, outputData);
+  LRSDP<SDP<arma::sp_mat>> mvuSolver(sdp, outputData);
+
+  // Now on with the solving.
+  double objective = mvuSolver.Optimize(outputData);
+
+  Log::Info << "Final objective is " << objective << "." << std::endl;
+
+  // Revert to original data format.
+  outputData = trans(outputData);
+}
+
+void MVU::BuildSDP(const size_t numNeighbors, SDP<arma::sp_mat>& sdp) const
+{
+  const size_t n = data.n_cols;
+
+  // There is one sparse constraint for each neighbor of each point, and the
+  // dense centering constraint.
+  sdp = SDP<arma::sp_mat>(n, numNeighbors * n, 1);
 
   // Set up the objective.  Because we are maximizing the trace of (R R^T),
   // we'll instead state it as min(-I_n * (R R^T)), meaning C() is -I_n.
-  mvuSolver.C().eye(data.n_cols, data.n_cols);
-  mvuSolver.C() *= -1;
-
-  // Now set up each of the constraints.
-  // The first constraint is trace(ones * R * R^T) = 0.
-  mvuSolver.B()[0] = 0;
-  mvuSolver.A()[0].ones(data.n_cols, data.n_cols);
+  sdp.C().eye(n, n);
+  sdp.C() *= -1;
 
-  // All of our other constraints will be sparse except the first.  So set that
-  // vector of modes accordingly.
-  mvuSolver.AModes().ones();
-  mvuSolver.AModes()[0] = 0;
+  // The dense constraint is trace(ones * R * R^T) = 0.
+  sdp.DenseA()[0].ones(n, n);
+  sdp.DenseB()[0] = 0;
 
   // Now all of the other constraints.  We first have to run KNN to get the
   // list of nearest neighbors.
@@ -63,49 +76,31 @@ void MVU::Unfold(const size_t newDim,
   knn.Search(numNeighbors, neighbors, distances);
 
   // Add each of the other constraints.  They are sparse constraints:
-  //   Tr(A_ij K) = d_ij;
+  //   Tr(A_ij K) = d_ij^2;
   //   A_ij = zeros except for 1 at (i, i), (j, j); -1 at (i, j), (j, i).
+  arma::umat locations(2, 4);
+  arma::vec values("1 -1 -1 1");
   for (size_t i = 0; i < neighbors.n_cols; ++i)
   {
     for (size_t j = 0; j < numNeighbors; ++j)
     {
       // This is the index of the constraint.
-      const size_t index = (i * numNeighbors) + j + 1;
-
-      arma::mat& aRef = mvuSolver.A()[index];
-
-      aRef.set_size(3, 4);
-
-      // A_ij(i, i) = 1.
-      aRef(0, 0) = i;
-      aRef(1, 0) = i;
-      aRef(2, 0) = 1;
-
-      // A_ij(i, j) = -1.
-      aRef(0, 1) = i;
-      aRef(1, 1) = neighbors(j, i);
-      aRef(2, 1) = -1;
-
-      // A_ij(j, i) = -1.
-      aRef(0, 2) = neighbors(j, i);
-      aRef(1, 2) = i;
-      aRef(2, 2) = -1;
-
-      // A_ij(j, j) = 1.
-      aRef(0, 3) = neighbors(j, i);
-      aRef(1, 3) = neighbors(j, i);
-      aRef(2, 3) = 1;
-
-      // The constraint b_ij is the distance between these two points.
-      mvuSolver.B()[index] = distances(j, i);
+      const size_t index = (i * numNeighbors) + j;
+      const size_t neighbor = neighbors(j, i);
+
+      locations(0, 0) = i;
+      locations(1, 0) = i;
+      locations(0, 1) = i;
+      locations(1, 1) = neighbor;
+      locations(0, 2) = neighbor;
+      locations(1, 2) = i;
+      locations(0, 3) = neighbor;
+      locations(1, 3) = neighbor;
+      sdp.SparseA()[index] = arma::sp_mat(locations, values, n, n);
+
+      // The constraint b_ij is the squared distance between these two points,
+      // since Tr(A_ij K) = K_ii + K_jj - 2 K_ij.
+      sdp.SparseB()[index] = distances(j, i) * distances(j, i);
     }
   }
-
-  // Now on with the solving.
-  double objective = mvuSolver.Optimize(outputData);
-
-  Log::Info << "Final objective is " << objective << "." << std::endl;
-
-  // Revert to original data format.
-  outputData = trans(outputData);
 }
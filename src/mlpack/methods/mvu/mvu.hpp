@@ -18,6 +18,7 @@
 #define MLPACK_METHODS_MVU_MVU_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <mlpack/core/optimizers/sdp/sdp.hpp>
 
 namespace mlpack {
 namespace mvu {
@@ -28,6 +29,12 @@ namespace mvu {
  *
  * - dataset
  * - new dimensionality
+ *
+ * The SDP solved by MVU has one constraint for each pair of neighbors, and
+ * each of these only touches four entries of the kernel matrix, so they are
+ * stored as sparse constraints; the low-rank solver then evaluates them in
+ * O(rank) time each, without forming the kernel matrix.  Only the centering
+ * constraint is dense.
  */
 class MVU
 {
@@ -38,6 +45,17 @@ class MVU
               const size_t numNeighbors,
               arma::mat& outputCoordinates);
 
+  /**
+   * Build the SDP that MVU solves: maximize the trace of the kernel matrix K,
+   * subject to K being centered and to the squared distance between each
+   * point and each of its nearest neighbors being kept.
+   *
+   * @param numNeighbors Number of nearest neighbors of each point.
+   * @param sdp SDP to store the problem in.
+   */
+  void BuildSDP(const size_t numNeighbors,
+                optimization::SDP<arma::sp_mat>& sdp) const;
+
  private:
   const arma::mat& data;
 };
@@ -0,0 +1,280 @@
+/**
+ * @file mvu_benchmark_main.cpp
+ *
+ * A benchmark of the low-rank SDP solver on the semidefinite program of MVU:
+ * the evaluation of the constraints, of the augmented Lagrangian and of its
+ * gradient is timed, and compared against the evaluation through the explicit
+ * kernel matrix R R^T.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/util/cli.hpp>
+#include <mlpack/core/optimizers/sdp/lrsdp.hpp>
+
+#include <chrono>
+#include <fstream>
+#include <string>
+
+#include "mvu.hpp"
+
+using namespace std;
+using namespace mlpack;
+using namespace mlpack::mvu;
+using namespace mlpack::optimization;
+
+PROGRAM_INFO("MVU Benchmark",
+    "This program times the low-rank SDP solver on the semidefinite program "
+    "solved by Maximum Variance Unfolding, which has one sparse constraint for "
+    "each of the --k (-k) nearest neighbors of each point.  For a random "
+    "solution of rank --new_dim (-D), the following are timed:"
+    "\n\n"
+    " - the evaluation of all the constraints (constraints),\n"
+    " - the evaluation of the augmented Lagrangian (objective),\n"
+    " - the evaluation of its gradient (gradient)."
+    "\n\n"
+    "If --reference (-R) is given, the same quantities are also computed "
+    "through the explicit kernel matrix R R^T, which is what the solver did "
+    "before the constraints were evaluated from their nonzeros, and the "
+    "largest relative difference between the two is reported.  If --solve "
+    "(-S) is given, the whole SDP is solved and the time of the solve is "
+    "reported too."
+    "\n\n"
+    "Each evaluation is repeated --trials (-T) times and the fastest time (in "
+    "seconds) is reported.  If no input dataset is given, a uniformly random "
+    "one with --points (-p) points in --dimensions (-d) dimensions is "
+    "generated.  The results are printed and can be saved as CSV with "
+    "--output_file (-o).");
+
+PARAM_MATRIX_IN("input", "Input dataset.", "i");
+PARAM_INT_IN("points", "Number of points of the random dataset, if no input "
+    "dataset is given.", "p", 1000);
+PARAM_INT_IN("dimensions", "Dimensionality of the random dataset, if no input "
+    "dataset is given.", "d", 3);
+
+PARAM_INT_IN("k", "Number of nearest neighbors of each point.", "k", 5);
+PARAM_INT_IN("new_dim", "Rank of the solution.", "D", 2);
+PARAM_INT_IN("trials", "Number of times each evaluation is repeated.", "T",
+    3);
+PARAM_FLAG("reference", "Also time the evaluation through R R^T.", "R");
+PARAM_FLAG("solve", "Also time the solve of the SDP.", "S");
+
+PARAM_STRING_IN("output_file", "File to save the results to (CSV).", "o", "");
+PARAM_INT_IN("seed", "Random seed (if 0, std::time(NULL) is used).", "s", 0);
+
+// Return the number of seconds since the given time.
+static double SecondsSince(const chrono::steady_clock::time_point& start)
+{
+  return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+// Return the fastest time of the given number of runs of the given function.
+template<typename FunctionType>
+static double Time(const int trials, FunctionType f)
+{
+  double best = DBL_MAX;
+  for (int trial = 0; trial < trials; ++trial)
+  {
+    const chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    f();
+    best = std::min(best, SecondsSince(start));
+  }
+  return best;
+}
+
+// Compute the constraints of the SDP through the kernel matrix.
+static void ReferenceConstraints(const SDP<arma::sp_mat>& sdp,
+                                 const arma::mat& kernel,
+                                 arma::vec& constraints)
+{
+  const size_t numSparse = sdp.NumSparseConstraints();
+  constraints.set_size(sdp.NumConstraints());
+  for (size_t i = 0; i < numSparse; ++i)
+    constraints[i] = arma::accu(sdp.SparseA()[i] % kernel) - sdp.SparseB()[i];
+  for (size_t i = 0; i < sdp.NumDenseConstraints(); ++i)
+    constraints[numSparse + i] = arma::accu(sdp.DenseA()[i] % kernel) -
+        sdp.DenseB()[i];
+}
+
+// Compute the augmented Lagrangian through the kernel matrix.
+static double ReferenceObjective(const SDP<arma::sp_mat>& sdp,
+                                 const arma::mat& coordinates,
+                                 const arma::vec& lambda,
+                                 const double sigma)
+{
+  const arma::mat kernel = coordinates * trans(coordinates);
+  arma::vec constraints;
+  ReferenceConstraints(sdp, kernel, constraints);
+
+  return arma::accu(sdp.C() % kernel) - arma::dot(lambda, constraints) +
+      (sigma / 2.) * arma::dot(constraints, constraints);
+}
+
+// Compute the gradient of the augmented Lagrangian through the kernel matrix.
+static void ReferenceGradient(const SDP<arma::sp_mat>& sdp,
+                              const arma::mat& coordinates,
+                              const arma::vec& lambda,
+                              const double sigma,
+                              arma::mat& gradient)
+{
+  const arma::mat kernel = coordinates * trans(coordinates);
+  arma::vec constraints;
+  ReferenceConstraints(sdp, kernel, constraints);
+
+  const size_t numSparse = sdp.NumSparseConstraints();
+  arma::mat s(sdp.C());
+  for (size_t i = 0; i < numSparse; ++i)
+    s -= (lambda[i] - sigma * constraints[i]) * sdp.SparseA()[i];
+  for (size_t i = 0; i < sdp.NumDenseConstraints(); ++i)
+    s -= (lambda[numSparse + i] - sigma * constraints[numSparse + i]) *
+        sdp.DenseA()[i];
+
+  gradient = 2 * s * coordinates;
+}
+
+// Return the largest relative difference between two results.
+static double Difference(const arma::mat& a, const arma::mat& b)
+{
+  return arma::abs(a - b).max() / std::max(arma::abs(b).max(), 1e-300);
+}
+
+int main(int argc, char** argv)
+{
+  CLI::ParseCommandLine(argc, argv);
+
+  if (CLI::GetParam<int>("seed") != 0)
+    math::RandomSeed((size_t) CLI::GetParam<int>("seed"));
+  else
+    math::RandomSeed((size_t) std::time(NULL));
+
+  const int trials = CLI::GetParam<int>("trials");
+  if (trials < 1)
+    Log::Fatal << "Invalid number of trials: " << trials << ".  Must be "
+        << "greater than 0." << endl;
+
+  // Load or generate the data.
+  arma::mat data;
+  if (CLI::HasParam("input"))
+  {
+    data = std::move(CLI::GetParam<arma::mat>("input"));
+  }
+  else
+  {
+    const int points = CLI::GetParam<int>("points");
+    const int dimensions = CLI::GetParam<int>("dimensions");
+    if (points < 2 || dimensions < 1)
+      Log::Fatal << "Invalid random dataset size: " << dimensions << " x "
+          << points << ".  --points must be greater than 1 and --dimensions "
+          << "must be greater than 0." << endl;
+    data.randu(dimensions, points);
+  }
+
+  const int k = CLI::GetParam<int>("k");
+  if (k < 1 || size_t(k) >= data.n_cols)
+    Log::Fatal << "Invalid k: " << k << ".  Must be between 1 and the number "
+        << "of points minus 1 (" << data.n_cols - 1 << ")." << endl;
+
+  const int newDim = CLI::GetParam<int>("new_dim");
+  if (newDim < 1)
+    Log::Fatal << "Invalid new dimensionality: " << newDim << ".  Must be "
+        << "greater than 0." << endl;
+
+  const bool reference = CLI::HasParam("reference");
+
+  MVU mvu(data);
+  SDP<arma::sp_mat> sdp;
+  mvu.BuildSDP(size_t(k), sdp);
+
+  // Evaluate at a random point, with random multipliers.
+  const arma::mat coordinates(data.n_cols, newDim, arma::fill::randu);
+  LRSDPFunction<SDP<arma::sp_mat>> lrsdp(sdp, coordinates);
+  AugLagrangianFunction<LRSDPFunction<SDP<arma::sp_mat>>> function(lrsdp,
+      arma::randu<arma::vec>(sdp.NumConstraints()), 10);
+
+  Log::Info << "Benchmarking " << sdp.NumSparseConstraints() << " sparse and "
+      << sdp.NumDenseConstraints() << " dense constraints on " << data.n_cols
+      << " points." << endl;
+
+  vector<string> names = { "constraints", "objective", "gradient" };
+  arma::mat results(names.size(), 3);
+  results.fill(arma::datum::nan);
+
+  arma::vec constraints, referenceConstraints;
+  results(0, 0) = Time(trials, [&]()
+      { lrsdp.EvaluateConstraints(coordinates, constraints); });
+
+  double objective = 0, referenceObjective = 0;
+  results(1, 0) = Time(trials, [&]()
+      { objective = function.Evaluate(coordinates); });
+
+  arma::mat gradient, referenceGradient;
+  results(2, 0) = Time(trials, [&]()
+      { function.Gradient(coordinates, gradient); });
+
+  if (reference)
+  {
+    results(0, 1) = Time(trials, [&]()
+    {
+      ReferenceConstraints(sdp, coordinates * trans(coordinates),
+          referenceConstraints);
+    });
+    results(0, 2) = Difference(constraints, referenceConstraints);
+
+    results(1, 1) = Time(trials, [&]()
+    {
+      referenceObjective = ReferenceObjective(sdp, coordinates,
+          function.Lambda(), function.Sigma());
+    });
+    results(1, 2) = std::abs(objective - referenceObjective) /
+        std::max(std::abs(referenceObjective), 1e-300);
+
+    results(2, 1) = Time(trials, [&]()
+    {
+      ReferenceGradient(sdp, coordinates, function.Lambda(), function.Sigma(),
+          referenceGradient);
+    });
+    results(2, 2) = Difference(gradient, referenceGradient);
+  }
+
+  if (CLI::HasParam("solve"))
+  {
+    arma::mat output(coordinates);
+    LRSDP<SDP<arma::sp_mat>> mvuSolver(sdp, output);
+    const chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    const double finalObjective = mvuSolver.Optimize(output);
+    names.push_back("solve");
+    results.resize(names.size(), 3);
+    results.row(names.size() - 1).fill(arma::datum::nan);
+    results(names.size() - 1, 0) = SecondsSince(start);
+
+    Log::Info << "Final objective is " << finalObjective << "." << endl;
+  }
+
+  // Print the results.
+  ostringstream table;
+  table.precision(10);
+  table << "measurement,time,reference_time,difference" << endl;
+  for (size_t m = 0; m < names.size(); ++m)
+  {
+    table << names[m];
+    for (size_t c = 0; c < results.n_cols; ++c)
+      table << "," << results(m, c);
+    table << endl;
+  }
+  cout << table.str();
+
+  const string outputFile = CLI::GetParam<string>("output_file");
+  if (outputFile != "")
+  {
+    ofstream output(outputFile.c_str());
+    if (!output.is_open())
+      Log::Fatal << "Could not open output file '" << outputFile << "'!"
+          << endl;
+    output << table.str();
+  }
+
+  CLI::Destroy();
+}
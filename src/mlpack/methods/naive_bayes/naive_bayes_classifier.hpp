@@ -16,6 +16,7 @@
 #define MLPACK_METHODS_NAIVE_BAYES_NAIVE_BAYES_CLASSIFIER_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <mlpack/core/data/chunked_reader.hpp>
 
 namespace mlpack {
 namespace naive_bayes /** The Naive Bayes Classifier. */ {
@@ -91,6 +92,11 @@ class NaiveBayesClassifier
    * classes, either re-initialize or call Means(), Variances(), and
    * Probabilities() individually to set them to the right size.
    *
+   * With the incremental algorithm, a large dataset can be given in chunks:
+   * training on each chunk in turn gives the same model as training on the
+   * whole dataset at once.  The statistics of blocks of points are computed in
+   * parallel with OpenMP and then merged into the model.
+   *
    * @param data The dataset to train on.
    * @param incremental Whether or not to use the incremental algorithm for
    *      training.
@@ -110,6 +116,19 @@ class NaiveBayesClassifier
   template<typename VecType>
   void Train(const VecType& point, const size_t label);
 
+  /**
+   * Train the Naive Bayes classifier on one pass over the blocks of the given
+   * reader, one block at a time.  The last row of each block holds the labels
+   * of its points, so the reader's dimensionality must be one more than the
+   * model's.  Each block is merged into the model as with the incremental
+   * algorithm, so this gives the same model as training on the whole dataset
+   * at once.
+   *
+   * @param reader Reader to take the points and labels from.
+   * @param incremental Whether to use the current model as a starting point.
+   */
+  void Train(data::ChunkedReader& reader, const bool incremental = true);
+
   /**
    * Classify the given point, using the training GaussianNB model. The predicted label is
    * returned.
@@ -136,7 +155,9 @@ class NaiveBayesClassifier
 
   /**
    * Classify the given points using the training GaussianNB model.
-   * The predicted labels for each point are stored in the given vector.
+   * The predicted labels for each point are stored in the given vector.  The
+   * log likelihoods of all classes are computed for blocks of points at a
+   * time, and the blocks are split between threads with OpenMP.
    *
    * @code
    * arma::mat test_data; // each column is a test point
@@ -222,6 +243,16 @@ class NaiveBayesClassifier
    */
   void LogLikelihood(const MatType& data,
                      arma::mat& logLikelihoods) const;
+
+  /**
+   * Compute the terms of the log likelihood of each class that do not depend
+   * on the point.
+   *
+   * @param invVar Matrix to store the inverse of the variances in.
+   * @param logNorm Vector to store the log of the prior probability of each
+   *     class plus the log of the normalizing constant of its Gaussian in.
+   */
+  void LogLikelihoodTerms(arma::mat& invVar, arma::vec& logNorm) const;
 };
 
 } // namespace naive_bayes
@@ -69,67 +69,106 @@ void NaiveBayesClassifier<MatType>::Train(const MatType& data,
                                           const arma::Row<size_t>& labels,
                                           const bool incremental)
 {
-  // Calculate the class probabilities as well as the sample mean and variance
-  // for each of the features with respect to each of the labels.
+  const size_t classes = probabilities.n_elem;
+
+  // The model is kept as the number of points, the mean, and the sum of the
+  // squared deviations from the mean (M2) of each class, which can be merged
+  // with those of more points (Chan et al., 1979).
+  arma::vec counts(classes, arma::fill::zeros);
+  MatType m2(means.n_rows, classes, arma::fill::zeros);
   if (incremental)
   {
-    // Use incremental algorithm.
-    // Fist, de-normalize probabilities.
-    probabilities *= trainingPoints;
-
-    for (size_t j = 0; j < data.n_cols; ++j)
-    {
-      const size_t label = labels[j];
-      ++probabilities[label];
-
-      arma::vec delta = data.col(j) - means.col(label);
-      means.col(label) += delta / probabilities[label];
-      variances.col(label) += delta % (data.col(j) - means.col(label));
-    }
-
-    for (size_t i = 0; i < probabilities.n_elem; ++i)
-    {
-      if (probabilities[i] > 2)
-        variances.col(i) /= (probabilities[i] - 1);
-    }
+    // Use the current model as a starting point.
+    counts = arma::round(probabilities * trainingPoints);
+    for (size_t i = 0; i < classes; ++i)
+      if (counts[i] > 1)
+        m2.col(i) = variances.col(i) * (counts[i] - 1);
   }
   else
   {
-    // Set all parameters to zero
-    probabilities.zeros();
+    // Ignore the current model.
     means.zeros();
-    variances.zeros();
+    trainingPoints = 0;
+  }
 
-    // Don't use incremental algorithm.  This is a two-pass algorithm.  It is
-    // possible to calculate the means and variances using a faster one-pass
-    // algorithm but there are some precision and stability issues.  If this is
-    // too slow, it's an option to use the faster algorithm by default and then
-    // have this (and the incremental algorithm) be other options.
+  // The points are split into at most 64 blocks (of at least 1024 points),
+  // whose statistics are computed in parallel.  Each block is handled with a
+  // two-pass algorithm, to avoid the precision issues of the one-pass
+  // algorithm.  The blocks are then merged into the model in order, so the
+  // model does not depend on the number of threads.
+  const size_t blockSize = std::max((size_t) 1024,
+      (size_t) (data.n_cols + 63) / 64);
+  const size_t numBlocks = (data.n_cols + blockSize - 1) / blockSize;
+  std::vector<arma::vec> blockCounts(numBlocks);
+  std::vector<MatType> blockMeans(numBlocks);
+  std::vector<MatType> blockM2(numBlocks);
+
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables. If we're building for Visual Studio, use
+  // the intmax_t type instead.
+#ifdef _WIN32
+  #pragma omp parallel for default(shared)
+  for (intmax_t block = 0; block < (intmax_t) numBlocks; ++block)
+#else
+  #pragma omp parallel for default(shared)
+  for (size_t block = 0; block < numBlocks; ++block)
+#endif
+  {
+    const size_t begin = block * blockSize;
+    const size_t end = std::min(begin + blockSize, (size_t) data.n_cols);
+
+    arma::vec& blockCount = blockCounts[block];
+    MatType& blockMean = blockMeans[block];
+    MatType& blockSquares = blockM2[block];
+    blockCount.zeros(classes);
+    blockMean.zeros(means.n_rows, classes);
+    blockSquares.zeros(means.n_rows, classes);
 
     // Calculate the means.
-    for (size_t j = 0; j < data.n_cols; ++j)
+    for (size_t j = begin; j < end; ++j)
     {
       const size_t label = labels[j];
-      ++probabilities[label];
-      means.col(label) += data.col(j);
+      ++blockCount[label];
+      blockMean.col(label) += data.col(j);
     }
 
-    // Normalize means.
-    for (size_t i = 0; i < probabilities.n_elem; ++i)
-      if (probabilities[i] != 0.0)
-        means.col(i) /= probabilities[i];
+    for (size_t i = 0; i < classes; ++i)
+      if (blockCount[i] != 0.0)
+        blockMean.col(i) /= blockCount[i];
 
-    // Calculate variances.
-    for (size_t j = 0; j < data.n_cols; ++j)
+    // Calculate the sums of squared deviations.
+    for (size_t j = begin; j < end; ++j)
     {
       const size_t label = labels[j];
-      variances.col(label) += square(data.col(j) - means.col(label));
+      blockSquares.col(label) += square(data.col(j) - blockMean.col(label));
+    }
+  }
+
+  // Merge the blocks into the model.
+  for (size_t block = 0; block < numBlocks; ++block)
+  {
+    for (size_t i = 0; i < classes; ++i)
+    {
+      const double blockCount = blockCounts[block][i];
+      if (blockCount == 0.0)
+        continue;
+
+      const double count = counts[i] + blockCount;
+      const arma::vec delta = blockMeans[block].col(i) - means.col(i);
+      means.col(i) += delta * (blockCount / count);
+      m2.col(i) += blockM2[block].col(i) + square(delta) *
+          (counts[i] * blockCount / count);
+      counts[i] = count;
     }
+  }
 
-    // Normalize variances.
-    for (size_t i = 0; i < probabilities.n_elem; ++i)
-      if (probabilities[i] > 1)
-        variances.col(i) /= (probabilities[i] - 1);
+  // Normalize the variances.
+  for (size_t i = 0; i < classes; ++i)
+  {
+    if (counts[i] > 1)
+      variances.col(i) = m2.col(i) / (counts[i] - 1);
+    else
+      variances.col(i).zeros();
   }
 
   // Ensure that the variances are invertible.
@@ -137,8 +176,11 @@ void NaiveBayesClassifier<MatType>::Train(const MatType& data,
     if (variances[i] == 0.0)
       variances[i] = 1e-50;
 
-  probabilities /= data.n_cols;
   trainingPoints += data.n_cols;
+  if (trainingPoints > 0)
+    probabilities = counts / trainingPoints;
+  else
+    probabilities.zeros();
 }
 
 template<typename MatType>
@@ -162,6 +204,47 @@ void NaiveBayesClassifier<MatType>::Train(const VecType& point,
   probabilities /= trainingPoints;
 }
 
+template<typename MatType>
+void NaiveBayesClassifier<MatType>::Train(data::ChunkedReader& reader,
+                                          const bool incremental)
+{
+  const size_t dimensionality = means.n_rows;
+  if (reader.Dimensionality() != dimensionality + 1)
+  {
+    std::ostringstream oss;
+    oss << "NaiveBayesClassifier::Train(): the blocks of '"
+        << reader.Filename() << "' have " << reader.Dimensionality()
+        << " rows, but the model needs " << dimensionality << " dimensions "
+        << "and a row of labels";
+    throw std::invalid_argument(oss.str());
+  }
+
+  arma::mat block;
+  bool first = true;
+  while (reader.Next(block))
+  {
+    const arma::Row<size_t> labels =
+        arma::conv_to<arma::Row<size_t>>::from(block.row(dimensionality));
+    Train(MatType(block.rows(0, dimensionality - 1)), labels,
+        incremental || !first);
+    first = false;
+  }
+}
+
+template<typename MatType>
+void NaiveBayesClassifier<MatType>::LogLikelihoodTerms(
+    arma::mat& invVar,
+    arma::vec& logNorm) const
+{
+  invVar = 1.0 / variances;
+
+  // This is an adaptation of gmm::phi() for the case where the covariance is a
+  // diagonal matrix.  The log of its determinant is the sum of the logs of the
+  // variances, which does not underflow like the determinant itself.
+  logNorm = arma::log(probabilities) + means.n_rows / -2.0 * log(2 * M_PI) -
+      0.5 * arma::sum(arma::log(variances), 0).t();
+}
+
 template<typename MatType>
 template<typename VecType>
 void NaiveBayesClassifier<MatType>::LogLikelihood(
@@ -172,26 +255,14 @@ void NaiveBayesClassifier<MatType>::LogLikelihood(
   // training data.
   Log::Assert(point.n_rows == means.n_rows);
 
-  logLikelihoods = arma::log(probabilities);
-  arma::mat invVar = 1.0 / variances;
-
-  // Calculate the joint log likelihood of point for each of the
-  // means.n_cols.
+  arma::mat invVar;
+  LogLikelihoodTerms(invVar, logLikelihoods);
 
-  // Loop over every class.
-  for (size_t i = 0; i < means.n_cols; i++)
-  {
-    // This is an adaptation of gmm::phi() for the case where the covariance is
-    // a diagonal matrix.
-    arma::vec diffs = point - means.col(i);
-    arma::vec rhs = -0.5 * arma::diagmat(invVar.col(i)) * diffs;
-    double exponent = arma::accu(diffs % rhs); // log(exp(value)) == value
-
-    // Calculate point log likelihood as sum of logs to decrease floating point
-    // errors.
-    logLikelihoods(i) += (point.n_rows / -2.0 * log(2 * M_PI) - 0.5 *
-        log(arma::det(arma::diagmat(variances.col(i)))) + exponent);
-  }
+  // Calculate the joint log likelihood of point for each of the classes at
+  // once, as a sum of logs to decrease floating point errors.
+  arma::mat diffs = means;
+  diffs.each_col() -= point;
+  logLikelihoods -= 0.5 * arma::sum(arma::square(diffs) % invVar, 0).t();
 }
 
 template<typename MatType>
@@ -199,11 +270,40 @@ void NaiveBayesClassifier<MatType>::LogLikelihood(
     const MatType& data,
     arma::mat& logLikelihoods) const
 {
+  Log::Assert(data.n_rows == means.n_rows);
+
+  arma::mat invVar;
+  arma::vec logNorm;
+  LogLikelihoodTerms(invVar, logNorm);
+
   logLikelihoods.set_size(means.n_cols, data.n_cols);
-  for (size_t i = 0; i < data.n_cols; ++i)
+
+  // The points are processed in blocks small enough to stay in cache while the
+  // log likelihoods of every class are computed, and the blocks are split
+  // between threads.
+  const size_t blockSize = std::max((size_t) 1,
+      (size_t) 32768 / std::max((size_t) data.n_rows, (size_t) 1));
+  const size_t numBlocks = (data.n_cols + blockSize - 1) / blockSize;
+
+#ifdef _WIN32
+  #pragma omp parallel for default(shared)
+  for (intmax_t block = 0; block < (intmax_t) numBlocks; ++block)
+#else
+  #pragma omp parallel for default(shared)
+  for (size_t block = 0; block < numBlocks; ++block)
+#endif
   {
-    arma::vec v = logLikelihoods.unsafe_col(i);
-    LogLikelihood(data.col(i), v);
+    const size_t begin = block * blockSize;
+    const size_t end = std::min(begin + blockSize, (size_t) data.n_cols);
+
+    arma::mat diffs;
+    for (size_t i = 0; i < means.n_cols; ++i)
+    {
+      diffs = data.cols(begin, end - 1);
+      diffs.each_col() -= means.col(i);
+      logLikelihoods.submat(i, begin, i, end - 1) = logNorm[i] - 0.5 *
+          (invVar.col(i).t() * arma::square(diffs));
+    }
   }
 }
 
@@ -14,8 +14,11 @@
  */
 #include <mlpack/prereqs.hpp>
 #include <mlpack/core/util/cli.hpp>
+#include <mlpack/core/util/model_server.hpp>
 #include <mlpack/core/data/normalize_labels.hpp>
 
+#include <sstream>
+
 #include "naive_bayes_classifier.hpp"
 
 using namespace mlpack;
@@ -41,7 +44,13 @@ PROGRAM_INFO("Parametric Naive Bayes Classifier",
     "specified with the --test_file (-T) option, and the classifications will "
     "be saved to the file specified with the --output_file (-o) option.  If "
     "saving a trained model is desired, the --output_model_file (-M) option "
-    "should be given.");
+    "should be given."
+    "\n\n"
+    "With --serve, the model is trained or loaded once, and then test sets "
+    "read from the standard input are classified on the standard output, with"
+    " the binary protocol of mlpack::util::ModelServer, until the input ends."
+    "  Each response holds the predicted labels and their probabilities.  Log "
+    "output goes to the standard error while serving.");
 
 // A struct for saving the model with mappings.
 struct NBCModel
@@ -79,6 +88,8 @@ PARAM_UROW_OUT("output", "The matrix in which the predicted labels for the"
     " test set will be written.", "o");
 PARAM_MATRIX_OUT("output_probs", "The matrix in which the predicted probability"
     " of labels for the test set will be written.", "p");
+PARAM_FLAG("serve", "If set, classify test sets read from the standard input,"
+    " until the input ends.", "");
 
 int main(int argc, char* argv[])
 {
@@ -100,8 +111,11 @@ int main(int argc, char* argv[])
     Log::Warn << "--incremental_variance (-I) ignored because --training_file "
         << "(-t) is not specified." << endl;
 
+  if (CLI::HasParam("serve") && CLI::HasParam("test"))
+    Log::Fatal << "--test_file (-T) may not be specified with --serve!" << endl;
+
   if (!CLI::HasParam("output") && !CLI::HasParam("output_model") &&
-      !CLI::HasParam("output_probs"))
+      !CLI::HasParam("output_probs") && !CLI::HasParam("serve"))
     Log::Warn << "Neither --output_file (-o), nor --output_model_file (-M), nor"
         << " --output_proba_file (-p) specified; no output will be saved!"
         << endl;
@@ -158,6 +172,38 @@ int main(int argc, char* argv[])
     model = std::move(CLI::GetParam<NBCModel>("input_model"));
   }
 
+  // Classify test sets from the standard input, if desired.
+  if (CLI::HasParam("serve"))
+  {
+    // The predictions are kept between requests to reuse their memory.
+    Row<size_t> predictions, rawResults;
+    try
+    {
+      const size_t requests = util::ModelServer::ServeStandardStreams(
+          [&](mat& request, vector<mat>& response)
+          {
+            if (request.n_rows != model.nbc.Means().n_rows)
+            {
+              ostringstream error;
+              error << "test data dimensionality (" << request.n_rows << ") "
+                  << "must be the same as training data ("
+                  << model.nbc.Means().n_rows << ")";
+              throw invalid_argument(error.str());
+            }
+
+            response.resize(2);
+            model.nbc.Classify(request, predictions, response[1]);
+            data::RevertLabels(predictions, model.mappings, rawResults);
+            response[0] = conv_to<mat>::from(rawResults);
+          });
+      Log::Info << "Classified " << requests << " test sets." << endl;
+    }
+    catch (std::exception& e)
+    {
+      Log::Fatal << e.what() << endl;
+    }
+  }
+
   // Do we need to do testing?
   if (CLI::HasParam("test"))
   {
@@ -82,6 +82,12 @@ class NCA
   //! Get the labels reference.
   const arma::Row<size_t>& Labels() const { return labels; }
 
+  //! Get the function to optimize.
+  const SoftmaxErrorFunction<MetricType>& Function() const
+  { return errorFunction; }
+  //! Modify the function to optimize.
+  SoftmaxErrorFunction<MetricType>& Function() { return errorFunction; }
+
   //! Get the optimizer.
   const OptimizerType<SoftmaxErrorFunction<MetricType> >& Optimizer() const
   { return optimizer; }
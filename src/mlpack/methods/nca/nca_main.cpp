@@ -76,6 +76,12 @@ PROGRAM_INFO("Neighborhood Components Analysis (NCA)",
     "documentation (in lbfgs.hpp) or the vast set of published literature on "
     "L-BFGS."
     "\n\n"
+    "With the L-BFGS optimizer, each step takes time quadratic in the number "
+    "of points (split between all cores if OpenMP is available).  For large "
+    "datasets, --neighbors (-k) approximates the objective by only considering "
+    "the k nearest neighbors of each point in the learned space, so that each "
+    "step takes roughly O(n k) time plus a nearest neighbor search."
+    "\n\n"
     "By default, the SGD optimizer is used.");
 
 PARAM_MATRIX_IN_REQ("input", "Input dataset to run NCA on.", "i");
@@ -110,6 +116,9 @@ PARAM_DOUBLE_IN("min_step", "Minimum step of line search for L-BFGS.", "m",
 PARAM_DOUBLE_IN("max_step", "Maximum step of line search for L-BFGS.", "M",
     1e20);
 
+PARAM_INT_IN("neighbors", "If nonzero, approximate the objective for L-BFGS "
+    "with this many nearest neighbors of each point.", "k", 0);
+
 PARAM_INT_IN("seed", "Random seed.  If 0, 'std::time(NULL)' is used.", "s", 0);
 
 using namespace mlpack;
@@ -170,6 +179,10 @@ int main(int argc, char* argv[])
     if (optimizerType == "sgd" && CLI::HasParam("batch_size"))
       Log::Warn << "Parameter --batch_size ignored (not using 'minibatch-sgd' "
           << "optimizer." << endl;
+
+    if (CLI::HasParam("neighbors"))
+      Log::Warn << "Parameter --neighbors ignored (not using 'lbfgs' "
+          << "optimizer)." << endl;
   }
   else if (optimizerType == "lbfgs")
   {
@@ -186,6 +199,12 @@ int main(int argc, char* argv[])
           << "optimizer)." << endl;
   }
 
+  if (CLI::GetParam<int>("neighbors") < 0)
+  {
+    Log::Fatal << "Invalid number of neighbors (" << CLI::GetParam<int>(
+        "neighbors") << "); must be 0 or greater." << endl;
+  }
+
   const double stepSize = CLI::GetParam<double>("step_size");
   const size_t maxIterations = (size_t) CLI::GetParam<int>("max_iterations");
   const double tolerance = CLI::GetParam<double>("tolerance");
@@ -198,6 +217,7 @@ int main(int argc, char* argv[])
   const double minStep = CLI::GetParam<double>("min_step");
   const double maxStep = CLI::GetParam<double>("max_step");
   const size_t batchSize = (size_t) CLI::GetParam<int>("batch_size");
+  const size_t neighbors = (size_t) CLI::GetParam<int>("neighbors");
 
   // Load data.
   arma::mat data = std::move(CLI::GetParam<arma::mat>("input"));
@@ -264,6 +284,7 @@ int main(int argc, char* argv[])
     nca.Optimizer().MaxLineSearchTrials() = maxLineSearchTrials;
     nca.Optimizer().MinStep() = minStep;
     nca.Optimizer().MaxStep() = maxStep;
+    nca.Function().Neighbors() = neighbors;
 
     nca.LearnDistance(distance);
   }
@@ -14,6 +14,7 @@
 #define MLPACK_METHODS_NCA_NCA_SOFTMAX_ERROR_FUNCTION_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <mlpack/methods/neighbor_search/neighbor_search.hpp>
 
 namespace mlpack {
 namespace nca {
@@ -37,6 +38,15 @@ namespace nca {
  * optimizers use, overloads of Evaluate() and Gradient() are given which only
  * operate on one point in the dataset.  This is useful for optimizers like
  * stochastic gradient descent (see mlpack::optimization::SGD).
+ *
+ * The non-separable Evaluate() and Gradient() take O(n^2) time, which is split
+ * between threads when OpenMP is available.  For large datasets, they can
+ * instead be approximated by truncating the softmax of each point to its k
+ * nearest neighbors in the stretched space (set with Neighbors()), which are
+ * found with KNN; then they take roughly O(n k) time, plus the time of the
+ * search.  The neighbors are found with the Euclidean distance, so the
+ * truncation keeps the largest terms of the softmax when the metric is an
+ * increasing function of the Euclidean distance, as the default one is.
  */
 template<typename MetricType = metric::SquaredEuclideanDistance>
 class SoftmaxErrorFunction
@@ -113,6 +123,11 @@ class SoftmaxErrorFunction
    */
   size_t NumFunctions() const { return dataset.n_cols; }
 
+  //! Get the number of neighbors of the approximation (0 means exact).
+  size_t Neighbors() const { return neighbors; }
+  //! Modify the number of neighbors of the approximation (0 means exact).
+  size_t& Neighbors() { return neighbors; }
+
  private:
   //! The dataset.
   const arma::mat& dataset;
@@ -121,6 +136,8 @@ class SoftmaxErrorFunction
 
   //! The instantiated metric.
   MetricType metric;
+  //! The number of neighbors of the approximation, or 0 for exact evaluation.
+  size_t neighbors;
 
   //! Last coordinates.  Used for the non-separable Evaluate() and Gradient().
   arma::mat lastCoordinates;
@@ -132,19 +149,28 @@ class SoftmaxErrorFunction
   //! Evaluate() and Gradient().
   arma::vec denominators;
 
+  //! The nearest neighbors of each point in the stretched dataset, for the
+  //! approximate non-separable Evaluate() and Gradient(); empty when exact.
+  arma::Mat<size_t> neighborIndices;
   //! False if nothing has ever been precalculated (only at construction time).
   bool precalculated;
 
+  //! Whether the non-separable Evaluate() and Gradient() are approximated.
+  bool Approximate() const
+  {
+    return (neighbors > 0) && (neighbors + 1 < dataset.n_cols);
+  }
+
   /**
    * Precalculate the denominators and numerators that will make up the p_ij,
    * but only if the coordinates matrix is different than the last coordinates
    * the Precalculate() method was run with.  This method is only called by the
    * non-separable Evaluate() and Gradient().
    *
-   * This will update last_coordinates_ and stretched_dataset_, and also
-   * calculate the p_i and denominators_ which are used in the calculation of
-   * p_i or p_ij.  The calculation will be O((n * (n + 1)) / 2), which is not
-   * great.
+   * This will update lastCoordinates and stretchedDataset, and also
+   * calculate the p_i and denominators which are used in the calculation of
+   * p_i or p_ij.  The calculation is O(n^2), split between threads, or
+   * O(n k) after the nearest neighbor search if the function is approximated.
    *
    * @param coordinates Coordinates matrix to use for precalculation.
    */
@@ -27,6 +27,7 @@ SoftmaxErrorFunction<MetricType>::SoftmaxErrorFunction(
     dataset(dataset),
     labels(labels),
     metric(metric),
+    neighbors(0),
     precalculated(false)
 { /* nothing to do */ }
 
@@ -94,38 +95,146 @@ void SoftmaxErrorFunction<MetricType>::Gradient(const arma::mat& coordinates,
   // Now, we handle the summation over i:
   //   sum_i (p_i sum_k (p_ik x_ik x_ik^T) -
   //       sum_{j in class of i} (p_ij x_ij x_ij^T)
-  // We can algebraically manipulate the whole thing to produce a more
-  // memory-friendly way to calculate this.  Looping over each i and k (again
-  // O((n * (n + 1)) / 2) as with the last step, we can add the following to the
-  // sum:
+  // which is sum_i sum_k (w_ik x_ik x_ik^T), where
   //
-  //   if class of i is the same as the class of k, add
-  //     (((p_i - (1 / p_i)) p_ik) + ((p_k - (1 / p_k)) p_ki)) x_ik x_ik^T
-  //   otherwise, add
-  //     (p_i p_ik + p_k p_ki) x_ik x_ik^T
+  //   w_ik = (p_i - 1) p_ik if the class of i is the same as the class of k,
+  //   w_ik = p_i p_ik otherwise.
+  //
+  // With W the matrix of the w_ik and X the dataset, this is
+  //   X diag(W 1) X^T + X diag(W^T 1) X^T - X W X^T - (X W X^T)^T,
+  // so instead of an outer product for each pair of points, it takes matrix
+  // products with W, which are done one block of rows of W at a time (or at
+  // once, if W is sparse because the function is approximated).  x_ik is
+  // x_i - x_k; we are not using stretched points here.  Only differences of
+  // points appear, so the points are centered first, which keeps the terms of
+  // the sum small.
+  const size_t n = dataset.n_cols;
+  const arma::mat centered = dataset.each_col() - arma::mean(dataset, 1);
   arma::mat sum;
-  sum.zeros(stretchedDataset.n_rows, stretchedDataset.n_rows);
-  for (size_t i = 0; i < stretchedDataset.n_cols; i++)
+  arma::rowvec columnSums;
+
+  if (Approximate())
   {
-    for (size_t k = (i + 1); k < stretchedDataset.n_cols; k++)
+    // Row i of W only has the nearest neighbors of point i.
+    arma::umat locations(2, neighbors * n);
+    arma::vec values(neighbors * n);
+
+#ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables. If we're building for Visual Studio,
+    // use the intmax_t type instead.
+    #pragma omp parallel for schedule(static)
+    for (intmax_t i = 0; i < (intmax_t) n; ++i)
+#else
+    #pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < n; ++i)
+#endif
     {
-      // Calculate p_ik and p_ki first.
-      double eval = exp(-metric.Evaluate(stretchedDataset.unsafe_col(i),
-                                         stretchedDataset.unsafe_col(k)));
-      double p_ik = 0, p_ki = 0;
-      p_ik = eval / denominators(i);
-      p_ki = eval / denominators(k);
-
-      // Subtract x_i from x_k.  We are not using stretched points here.
-      arma::vec x_ik = dataset.col(i) - dataset.col(k);
-      arma::mat secondTerm = (x_ik * trans(x_ik));
-
-      if (labels[i] == labels[k])
-        sum += ((p[i] - 1) * p_ik + (p[k] - 1) * p_ki) * secondTerm;
-      else
-        sum += (p[i] * p_ik + p[k] * p_ki) * secondTerm;
+      for (size_t j = 0; j < neighbors; ++j)
+      {
+        const size_t k = neighborIndices(j, i);
+        const double p_ik = std::exp(-metric.Evaluate(
+            stretchedDataset.unsafe_col(i), stretchedDataset.unsafe_col(k))) /
+            denominators[i];
+
+        locations(0, i * neighbors + j) = i;
+        locations(1, i * neighbors + j) = k;
+        values[i * neighbors + j] = (labels[i] == labels[k]) ?
+            (p[i] - 1) * p_ik : p[i] * p_ik;
+      }
     }
+
+    const arma::sp_mat weights(locations, values, n, n);
+    const arma::rowvec rowSums(arma::vec(arma::sum(weights, 1)).t());
+    columnSums = arma::rowvec(arma::sum(weights, 0));
+
+    const arma::mat product = centered * (weights * centered.t());
+    sum = (centered.each_row() % rowSums) * centered.t() - product -
+        product.t();
   }
+  else
+  {
+    // Each block of rows of W holds about 2^20 values (8MB).
+    const size_t blockSize = std::max((size_t) 1, std::min((size_t) 256,
+        ((size_t) 1 << 20) / std::max(n, (size_t) 1)));
+    const size_t numBlocks = (n + blockSize - 1) / blockSize;
+
+#ifdef HAS_OPENMP
+    const size_t numThreads = std::max((size_t) 1, std::min(
+        (size_t) omp_get_max_threads(), numBlocks));
+#else
+    const size_t numThreads = 1;
+#endif
+
+    // Each thread sums its own blocks; the sums are added in order at the end.
+    std::vector<arma::mat> sums(numThreads,
+        arma::mat(dataset.n_rows, dataset.n_rows, arma::fill::zeros));
+    std::vector<arma::rowvec> sumsOfColumns(numThreads,
+        arma::rowvec(n, arma::fill::zeros));
+
+    #pragma omp parallel num_threads(numThreads)
+    {
+#ifdef HAS_OPENMP
+      const size_t thread = omp_get_thread_num();
+#else
+      const size_t thread = 0;
+#endif
+
+      arma::mat weights;
+
+#ifdef _WIN32
+      // Tiny workaround: Visual Studio only implements OpenMP 2.0, which
+      // doesn't support unsigned loop variables. If we're building for Visual
+      // Studio, use the intmax_t type instead.
+      #pragma omp for schedule(static)
+      for (intmax_t b = 0; b < (intmax_t) numBlocks; ++b)
+#else
+      #pragma omp for schedule(static)
+      for (size_t b = 0; b < numBlocks; ++b)
+#endif
+      {
+        const size_t first = b * blockSize;
+        const size_t last = std::min(first + blockSize, n) - 1;
+
+        weights.set_size(last - first + 1, n);
+        for (size_t k = 0; k < n; ++k)
+        {
+          for (size_t i = first; i <= last; ++i)
+          {
+            if (i == k)
+            {
+              weights(i - first, k) = 0.0;
+              continue;
+            }
+
+            const double p_ik = std::exp(-metric.Evaluate(
+                stretchedDataset.unsafe_col(i),
+                stretchedDataset.unsafe_col(k))) / denominators[i];
+            weights(i - first, k) = (labels[i] == labels[k]) ?
+                (p[i] - 1) * p_ik : p[i] * p_ik;
+          }
+        }
+
+        const arma::mat points = centered.cols(first, last);
+        const arma::rowvec rowSums = arma::sum(weights, 1).t();
+        const arma::mat product = points * (weights * centered.t());
+
+        sums[thread] += (points.each_row() % rowSums) * points.t() - product -
+            product.t();
+        sumsOfColumns[thread] += arma::sum(weights, 0);
+      }
+    }
+
+    sum = std::move(sums[0]);
+    columnSums = std::move(sumsOfColumns[0]);
+    for (size_t t = 1; t < numThreads; ++t)
+    {
+      sum += sums[t];
+      columnSums += sumsOfColumns[t];
+    }
+  }
+
+  sum += (centered.each_row() % columnSums) * centered.t();
 
   // Assemble the final gradient.
   gradient = -2 * coordinates * sum;
@@ -214,46 +323,75 @@ void SoftmaxErrorFunction<MetricType>::Precalculate(
   // Ensure it is the right size.
   lastCoordinates.set_size(coordinates.n_rows, coordinates.n_cols);
 
-  // Make sure the calculation is necessary.
+  // Make sure the calculation is necessary.  It also is if the approximation
+  // has changed.
+  const size_t k = Approximate() ? neighbors : 0;
   if ((accu(coordinates == lastCoordinates) == coordinates.n_elem) &&
-      precalculated)
+      (neighborIndices.n_rows == k) && precalculated)
     return; // No need to calculate; we already have this stuff saved.
 
   // Coordinates are different; save the new ones, and stretch the dataset.
   lastCoordinates = coordinates;
   stretchedDataset = coordinates * dataset;
 
+  // If the softmax is truncated, find the nearest neighbors of each point in
+  // the stretched space.
+  if (k > 0)
+  {
+    arma::mat distances;
+    neighbor::KNN knn(stretchedDataset);
+    knn.Search(k, neighborIndices, distances);
+  }
+  else
+  {
+    neighborIndices.reset();
+  }
+
   // For each point i, we must evaluate the softmax function:
   //   p_ij = exp( -K(x_i, x_j) ) / ( sum_{k != i} ( exp( -K(x_i, x_k) )))
   //   p_i = sum_{j in class of i} p_ij
   // We will do this by keeping track of the denominators for each i as well as
-  // the numerators (the sum for all j in class of i).  This will be on the
-  // order of O((n * (n + 1)) / 2), which really isn't all that great.
-  p.zeros(stretchedDataset.n_cols);
-  denominators.zeros(stretchedDataset.n_cols);
-  for (size_t i = 0; i < stretchedDataset.n_cols; i++)
+  // the numerators (the sum for all j in class of i).  Each point is handled
+  // by one thread, which scans the whole dataset (or only the neighbors of the
+  // point, if the function is approximated).
+  const size_t n = stretchedDataset.n_cols;
+  p.set_size(n);
+  denominators.set_size(n);
+
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables. If we're building for Visual Studio,
+  // use the intmax_t type instead.
+  #pragma omp parallel for schedule(static)
+  for (intmax_t i = 0; i < (intmax_t) n; ++i)
+#else
+  #pragma omp parallel for schedule(static)
+  for (size_t i = 0; i < n; ++i)
+#endif
   {
-    for (size_t j = (i + 1); j < stretchedDataset.n_cols; j++)
+    double numerator = 0.0;
+    double denominator = 0.0;
+    const size_t count = (k > 0) ? k : n;
+    for (size_t c = 0; c < count; ++c)
     {
-      // Evaluate exp(-d(x_i, x_j)).
-      double eval = exp(-metric.Evaluate(stretchedDataset.unsafe_col(i),
-                                         stretchedDataset.unsafe_col(j)));
+      const size_t j = (k > 0) ? neighborIndices(c, i) : c;
+      if (j == (size_t) i)
+        continue;
 
-      // Add this to the denominators of both p_i and p_j: K(i, j) = K(j, i).
-      denominators[i] += eval;
-      denominators[j] += eval;
+      // Evaluate exp(-d(x_i, x_j)).
+      const double eval = std::exp(-metric.Evaluate(
+          stretchedDataset.unsafe_col(i), stretchedDataset.unsafe_col(j)));
 
-      // If i and j are the same class, add to numerator of both.
+      // Add this to the denominator, and to the numerator if i and j are the
+      // same class.
+      denominator += eval;
       if (labels[i] == labels[j])
-      {
-        p[i] += eval;
-        p[j] += eval;
-      }
+        numerator += eval;
     }
-  }
 
-  // Divide p_i by their denominators.
-  p /= denominators;
+    denominators[i] = denominator;
+    p[i] = numerator / denominator;
+  }
 
   // Clean up any bad values.
   for (size_t i = 0; i < stretchedDataset.n_cols; i++)
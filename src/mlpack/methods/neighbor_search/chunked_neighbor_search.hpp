@@ -0,0 +1,159 @@
+/**
+ * @file chunked_neighbor_search.hpp
+ *
+ * Defines the ChunkedNeighborSearch class, which performs neighbor search on a
+ * reference set that is held on disk as a set of smaller chunks, so that the
+ * whole reference set never has to be held in memory.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_NEIGHBOR_SEARCH_CHUNKED_NEIGHBOR_SEARCH_HPP
+#define MLPACK_METHODS_NEIGHBOR_SEARCH_CHUNKED_NEIGHBOR_SEARCH_HPP
+
+#include <mlpack/prereqs.hpp>
+#include "neighbor_search.hpp"
+
+namespace mlpack {
+namespace neighbor {
+
+/**
+ * The ChunkedNeighborSearch class performs neighbor search when the reference
+ * set is too large to fit in memory.  The reference set is given as a list of
+ * files, each holding a part (a chunk) of the reference points, and the points
+ * are numbered in the order of the files, so the first point of the second
+ * chunk has the index that follows the last point of the first chunk.
+ *
+ * During a search, the chunks are loaded one at a time; a tree is built on
+ * each chunk, the query set is searched on that tree with NeighborSearch, and
+ * the results are merged with the results of the previous chunks.  While one
+ * chunk is searched, the next one is loaded in the background, so at most two
+ * chunks are held in memory at any time and loading is overlapped with
+ * computation.
+ *
+ * @code
+ * std::vector<std::string> chunks = { "ref_0.bin", "ref_1.bin", "ref_2.bin" };
+ * ChunkedNeighborSearch<> knn(chunks);
+ *
+ * arma::Mat<size_t> neighbors;
+ * arma::mat distances;
+ * knn.Search(querySet, 5, neighbors, distances);
+ * @endcode
+ *
+ * @tparam SortPolicy The sort policy for distances; see NearestNeighborSort.
+ * @tparam MetricType The metric to use for computation.
+ * @tparam MatType The type of data matrix.
+ * @tparam TreeType The tree type to build on each chunk.
+ */
+template<typename SortPolicy = NearestNeighborSort,
+         typename MetricType = mlpack::metric::EuclideanDistance,
+         typename MatType = arma::mat,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType = tree::KDTree>
+class ChunkedNeighborSearch
+{
+ public:
+  //! The type of NeighborSearch used to search each chunk.
+  typedef NeighborSearch<SortPolicy, MetricType, MatType, TreeType>
+      ChunkSearchType;
+
+  /**
+   * Initialize the ChunkedNeighborSearch object with the given list of chunk
+   * files.  The files are not loaded until Search() is called.  Each file must
+   * be loadable with data::Load(), and all chunks must have the same
+   * dimensionality.
+   *
+   * @param chunkFiles Files holding the chunks of the reference set, in order.
+   * @param mode Search mode to use on each chunk (naive, single-tree,
+   *      dual-tree or greedy).
+   * @param epsilon Relative approximate error (non-negative).
+   * @param metric An optional instance of the MetricType class.
+   */
+  ChunkedNeighborSearch(const std::vector<std::string>& chunkFiles,
+                        const NeighborSearchMode mode = DUAL_TREE_MODE,
+                        const double epsilon = 0,
+                        const MetricType metric = MetricType());
+
+  /**
+   * For each point in the query set, compute the nearest neighbors among the
+   * points of all chunks, and store the output in the given matrices.  The
+   * matrices will be set to the size of n columns by k rows, where n is the
+   * number of points in the query set.  Neighbor indices refer to the
+   * concatenation of the chunks.  A std::runtime_error is thrown if a chunk
+   * can't be loaded, and std::invalid_argument is thrown if a chunk has the
+   * wrong dimensionality or there are fewer than k reference points in total.
+   *
+   * @param querySet Set of query points.
+   * @param k Number of neighbors to search for.
+   * @param neighbors Matrix storing lists of neighbors for each query point.
+   * @param distances Matrix storing distances of neighbors for each query
+   *     point.
+   */
+  void Search(const MatType& querySet,
+              const size_t k,
+              arma::Mat<size_t>& neighbors,
+              arma::mat& distances);
+
+  /**
+   * Merge the results of a search on a chunk into the running results.  Each
+   * column of the running results and of the chunk results is sorted from
+   * best to worst; after the merge, each column of the running results holds
+   * the best neighbors of both, still sorted.  The neighbors of the chunk are
+   * shifted by the given offset, which is the index of the first point of the
+   * chunk.
+   *
+   * @param neighbors Running neighbor results (k x n).
+   * @param distances Running distance results (k x n).
+   * @param chunkNeighbors Neighbors found in the chunk (at most k x n).
+   * @param chunkDistances Distances found in the chunk (at most k x n).
+   * @param offset Index of the first point of the chunk.
+   */
+  static void MergeResults(arma::Mat<size_t>& neighbors,
+                           arma::mat& distances,
+                           const arma::Mat<size_t>& chunkNeighbors,
+                           const arma::mat& chunkDistances,
+                           const size_t offset);
+
+  //! Get the list of chunk files.
+  const std::vector<std::string>& ChunkFiles() const { return chunkFiles; }
+  //! Modify the list of chunk files.
+  std::vector<std::string>& ChunkFiles() { return chunkFiles; }
+
+  //! Get the search mode.
+  NeighborSearchMode SearchMode() const { return searchMode; }
+  //! Modify the search mode.
+  NeighborSearchMode& SearchMode() { return searchMode; }
+
+  //! Get the approximation parameter epsilon.
+  double Epsilon() const { return epsilon; }
+  //! Modify the approximation parameter epsilon.
+  double& Epsilon() { return epsilon; }
+
+ private:
+  //! Files holding the chunks of the reference set.
+  std::vector<std::string> chunkFiles;
+  //! Search mode used on each chunk.
+  NeighborSearchMode searchMode;
+  //! Relative approximate error.
+  double epsilon;
+  //! Instantiated metric.
+  MetricType metric;
+
+  //! Load the given chunk, throwing a std::runtime_error on failure.
+  static MatType LoadChunk(const std::string& filename);
+};
+
+//! Chunked k-nearest-neighbor search with Euclidean distances.
+typedef ChunkedNeighborSearch<NearestNeighborSort, metric::EuclideanDistance>
+    ChunkedKNN;
+
+} // namespace neighbor
+} // namespace mlpack
+
+// Include implementation.
+#include "chunked_neighbor_search_impl.hpp"
+
+#endif
@@ -0,0 +1,178 @@
+/**
+ * @file chunked_neighbor_search_impl.hpp
+ *
+ * Implementation of the ChunkedNeighborSearch class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_NEIGHBOR_SEARCH_CHUNKED_NEIGHBOR_SEARCH_IMPL_HPP
+#define MLPACK_METHODS_NEIGHBOR_SEARCH_CHUNKED_NEIGHBOR_SEARCH_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "chunked_neighbor_search.hpp"
+
+#include <future>
+
+namespace mlpack {
+namespace neighbor {
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+ChunkedNeighborSearch<SortPolicy, MetricType, MatType, TreeType>::
+ChunkedNeighborSearch(const std::vector<std::string>& chunkFiles,
+                      const NeighborSearchMode mode,
+                      const double epsilon,
+                      const MetricType metric) :
+    chunkFiles(chunkFiles),
+    searchMode(mode),
+    epsilon(epsilon),
+    metric(metric)
+{
+  if (epsilon < 0)
+    throw std::invalid_argument("epsilon must be non-negative");
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void ChunkedNeighborSearch<SortPolicy, MetricType, MatType, TreeType>::Search(
+    const MatType& querySet,
+    const size_t k,
+    arma::Mat<size_t>& neighbors,
+    arma::mat& distances)
+{
+  if (chunkFiles.empty())
+    throw std::invalid_argument("ChunkedNeighborSearch::Search(): no "
+        "reference chunks given");
+
+  // Initialize the results; every candidate is worse than any real neighbor.
+  neighbors.set_size(k, querySet.n_cols);
+  neighbors.fill(size_t() - 1);
+  distances.set_size(k, querySet.n_cols);
+  distances.fill(SortPolicy::WorstDistance());
+
+  // Start loading the first chunk.  Each subsequent chunk is loaded in the
+  // background while the previous one is searched.
+  std::future<MatType> nextChunk = std::async(std::launch::async, &LoadChunk,
+      chunkFiles[0]);
+
+  size_t offset = 0;
+  for (size_t i = 0; i < chunkFiles.size(); ++i)
+  {
+    MatType chunk = nextChunk.get();
+    if (i + 1 < chunkFiles.size())
+      nextChunk = std::async(std::launch::async, &LoadChunk,
+          chunkFiles[i + 1]);
+
+    if (chunk.n_rows != querySet.n_rows)
+    {
+      std::ostringstream oss;
+      oss << "ChunkedNeighborSearch::Search(): chunk '" << chunkFiles[i]
+          << "' has dimensionality " << chunk.n_rows << ", but the query set "
+          << "has dimensionality " << querySet.n_rows;
+      throw std::invalid_argument(oss.str());
+    }
+
+    const size_t chunkSize = chunk.n_cols;
+    if (chunkSize == 0)
+      continue;
+
+    Log::Info << "Searching reference chunk " << i << " ('" << chunkFiles[i]
+        << "', " << chunkSize << " points)." << std::endl;
+
+    ChunkSearchType chunkSearch(std::move(chunk), searchMode, epsilon, metric);
+
+    arma::Mat<size_t> chunkNeighbors;
+    arma::mat chunkDistances;
+    chunkSearch.Search(querySet, std::min(k, chunkSize), chunkNeighbors,
+        chunkDistances);
+
+    MergeResults(neighbors, distances, chunkNeighbors, chunkDistances, offset);
+    offset += chunkSize;
+  }
+
+  if (k > offset)
+  {
+    std::ostringstream oss;
+    oss << "ChunkedNeighborSearch::Search(): requested " << k << " neighbors, "
+        << "but the reference chunks only hold " << offset << " points";
+    throw std::invalid_argument(oss.str());
+  }
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void ChunkedNeighborSearch<SortPolicy, MetricType, MatType, TreeType>::
+MergeResults(arma::Mat<size_t>& neighbors,
+             arma::mat& distances,
+             const arma::Mat<size_t>& chunkNeighbors,
+             const arma::mat& chunkDistances,
+             const size_t offset)
+{
+  const size_t k = neighbors.n_rows;
+  const size_t chunkK = chunkNeighbors.n_rows;
+
+  arma::Col<size_t> mergedNeighbors(k);
+  arma::vec mergedDistances(k);
+  for (size_t q = 0; q < neighbors.n_cols; ++q)
+  {
+    // Standard merge of two sorted lists.  The running results win ties, so
+    // that points from earlier chunks (with lower indices) come first.
+    size_t a = 0, b = 0;
+    for (size_t i = 0; i < k; ++i)
+    {
+      if (b < chunkK && SortPolicy::IsBetter(chunkDistances(b, q),
+          distances(a, q)) && chunkDistances(b, q) != distances(a, q))
+      {
+        mergedNeighbors[i] = chunkNeighbors(b, q) + offset;
+        mergedDistances[i] = chunkDistances(b, q);
+        ++b;
+      }
+      else
+      {
+        mergedNeighbors[i] = neighbors(a, q);
+        mergedDistances[i] = distances(a, q);
+        ++a;
+      }
+    }
+
+    neighbors.col(q) = mergedNeighbors;
+    distances.col(q) = mergedDistances;
+  }
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+MatType ChunkedNeighborSearch<SortPolicy, MetricType, MatType, TreeType>::
+LoadChunk(const std::string& filename)
+{
+  MatType chunk;
+  if (!data::Load(filename, chunk))
+    throw std::runtime_error("ChunkedNeighborSearch: could not load reference "
+        "chunk '" + filename + "'");
+
+  return chunk;
+}
+
+} // namespace neighbor
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,162 @@
+/**
+ * @file distributed_neighbor_search.hpp
+ *
+ * Defines the DistributedNeighborSearch class, which performs neighbor search
+ * on a reference set that is sharded across the ranks of an MPI communicator.
+ * This file is only usable when mlpack is configured with USE_MPI.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_NEIGHBOR_SEARCH_DISTRIBUTED_NEIGHBOR_SEARCH_HPP
+#define MLPACK_METHODS_NEIGHBOR_SEARCH_DISTRIBUTED_NEIGHBOR_SEARCH_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mpi.h>
+#include "sharded_neighbor_search.hpp"
+
+namespace mlpack {
+namespace neighbor {
+
+/**
+ * The DistributedNeighborSearch class performs neighbor search on a reference
+ * set that is sharded across the ranks of an MPI communicator.  Each rank
+ * holds one shard and builds a tree on it; the shards are numbered in rank
+ * order, so the first point of rank 1 has the index that follows the last
+ * point of rank 0.
+ *
+ * On construction, the bounding box and size of every shard are shared with
+ * all ranks.  Search() is collective: the query set, given on rank 0, is
+ * broadcast to every rank, and each rank uses the bounding boxes to decide
+ * which query points may have one of their k best neighbors in its shard (see
+ * ShardedNeighborSearch::RouteQueries()).  Each rank searches only those query
+ * points on its shard, and the results are gathered on rank 0 and merged.
+ *
+ * @code
+ * // On every rank:
+ * arma::mat localShard;
+ * data::Load("shard_" + std::to_string(rank) + ".csv", localShard, true);
+ * DistributedNeighborSearch<> knn(std::move(localShard));
+ *
+ * arma::Mat<size_t> neighbors;
+ * arma::mat distances;
+ * knn.Search(querySet, 5, neighbors, distances); // Results only on rank 0.
+ * @endcode
+ *
+ * @tparam SortPolicy The sort policy for distances; see NearestNeighborSort.
+ * @tparam MetricType The metric to use for computation; this must be an
+ *     LMetric, so that the shards can be bounded with an HRectBound.
+ * @tparam MatType The type of data matrix (arma::mat or arma::fmat).
+ * @tparam TreeType The tree type to build on the local shard.
+ */
+template<typename SortPolicy = NearestNeighborSort,
+         typename MetricType = mlpack::metric::EuclideanDistance,
+         typename MatType = arma::mat,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType = tree::KDTree>
+class DistributedNeighborSearch
+{
+ public:
+  //! The type of NeighborSearch used to search the local shard.
+  typedef NeighborSearch<SortPolicy, MetricType, MatType, TreeType>
+      ShardSearchType;
+  //! The type of element held in MatType.
+  typedef typename MatType::elem_type ElemType;
+  //! The type of bound used to route queries to ranks.
+  typedef bound::HRectBound<MetricType, ElemType> BoundType;
+
+  /**
+   * Initialize the DistributedNeighborSearch object with the shard of this
+   * rank, and share the bounding box and size of each shard between all
+   * ranks.  This is collective over the communicator.  A std::invalid_argument
+   * is thrown on every rank if the shards don't all have the same
+   * dimensionality.
+   *
+   * @param localReferenceSet The shard held by this rank (taken with
+   *      std::move()).
+   * @param comm The MPI communicator holding the shards.
+   * @param mode Search mode to use on the local shard (naive, single-tree,
+   *      dual-tree or greedy).
+   * @param epsilon Relative approximate error (non-negative).
+   * @param metric An optional instance of the MetricType class.
+   */
+  DistributedNeighborSearch(MatType&& localReferenceSet,
+                            MPI_Comm comm = MPI_COMM_WORLD,
+                            const NeighborSearchMode mode = DUAL_TREE_MODE,
+                            const double epsilon = 0,
+                            const MetricType metric = MetricType());
+
+  /**
+   * For each point in the query set, compute the nearest neighbors among the
+   * points of all ranks.  This is collective over the communicator; the query
+   * set is only read on rank 0, and the results are only stored on rank 0 (on
+   * other ranks, the output matrices are emptied).  Neighbor indices refer to
+   * the concatenation of the shards in rank order.  A std::invalid_argument is
+   * thrown on every rank if the query set has the wrong dimensionality or
+   * there are fewer than k reference points in total.
+   *
+   * @param querySet Set of query points (only used on rank 0).
+   * @param k Number of neighbors to search for.
+   * @param neighbors Matrix storing lists of neighbors for each query point.
+   * @param distances Matrix storing distances of neighbors for each query
+   *     point.
+   */
+  void Search(const MatType& querySet,
+              const size_t k,
+              arma::Mat<size_t>& neighbors,
+              arma::mat& distances);
+
+  //! Get the rank of this process in the communicator.
+  int Rank() const { return rank; }
+  //! Get the number of ranks in the communicator.
+  int NumRanks() const { return numRanks; }
+
+  //! Get the NeighborSearch object of the local shard.
+  const ShardSearchType& LocalSearch() const { return localSearch; }
+  //! Get the bounding box of the shard of the given rank.
+  const BoundType& ShardBound(const size_t i) const { return bounds[i]; }
+  //! Get the index of the first point of the shard of the given rank.
+  size_t ShardOffset(const size_t i) const { return offsets[i]; }
+
+  //! Get the number of reference points over all ranks.
+  size_t NumPoints() const { return numPoints; }
+
+ private:
+  //! The communicator holding the shards.
+  MPI_Comm comm;
+  //! The rank of this process.
+  int rank;
+  //! The number of ranks.
+  int numRanks;
+
+  //! The NeighborSearch object of the local shard.
+  ShardSearchType localSearch;
+  //! The bounding box of the shard of each rank.
+  std::vector<BoundType> bounds;
+  //! The number of points in the shard of each rank.
+  std::vector<size_t> sizes;
+  //! The index of the first point of the shard of each rank.
+  std::vector<size_t> offsets;
+  //! The number of reference points over all ranks.
+  size_t numPoints;
+  //! The dimensionality of the reference points.
+  size_t dimensionality;
+
+  //! Get the MPI datatype matching ElemType.
+  static MPI_Datatype ElemMPIType();
+};
+
+//! Distributed k-nearest-neighbor search with Euclidean distances.
+typedef DistributedNeighborSearch<NearestNeighborSort,
+    metric::EuclideanDistance> DistributedKNN;
+
+} // namespace neighbor
+} // namespace mlpack
+
+// Include implementation.
+#include "distributed_neighbor_search_impl.hpp"
+
+#endif
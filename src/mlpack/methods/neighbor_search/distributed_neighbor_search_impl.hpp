@@ -0,0 +1,241 @@
+/**
+ * @file distributed_neighbor_search_impl.hpp
+ *
+ * Implementation of the DistributedNeighborSearch class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_NEIGHBOR_SEARCH_DISTRIBUTED_NEIGHBOR_SEARCH_IMPL_HPP
+#define MLPACK_METHODS_NEIGHBOR_SEARCH_DISTRIBUTED_NEIGHBOR_SEARCH_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "distributed_neighbor_search.hpp"
+
+namespace mlpack {
+namespace neighbor {
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+DistributedNeighborSearch<SortPolicy, MetricType, MatType, TreeType>::
+DistributedNeighborSearch(MatType&& localReferenceSet,
+                          MPI_Comm comm,
+                          const NeighborSearchMode mode,
+                          const double epsilon,
+                          const MetricType metric) :
+    comm(comm),
+    localSearch(mode, epsilon, metric),
+    numPoints(0),
+    dimensionality(localReferenceSet.n_rows)
+{
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &numRanks);
+
+  // Every shard must have the same dimensionality.
+  unsigned long long localInfo[2] = { localReferenceSet.n_rows,
+                                      localReferenceSet.n_cols };
+  std::vector<unsigned long long> info(2 * numRanks);
+  MPI_Allgather(localInfo, 2, MPI_UNSIGNED_LONG_LONG, info.data(), 2,
+      MPI_UNSIGNED_LONG_LONG, comm);
+
+  for (int r = 0; r < numRanks; ++r)
+  {
+    if (info[2 * r] != dimensionality)
+    {
+      std::ostringstream oss;
+      oss << "DistributedNeighborSearch: the shard of rank " << r << " has "
+          << "dimensionality " << info[2 * r] << ", but the shard of rank "
+          << rank << " has dimensionality " << dimensionality;
+      throw std::invalid_argument(oss.str());
+    }
+
+    sizes.push_back(info[2 * r + 1]);
+    offsets.push_back(numPoints);
+    numPoints += info[2 * r + 1];
+  }
+
+  // Share the bounding boxes, as the lower and upper end of each dimension.
+  BoundType localBound(dimensionality);
+  localBound |= localReferenceSet;
+  std::vector<double> localRanges(2 * dimensionality);
+  for (size_t d = 0; d < dimensionality; ++d)
+  {
+    localRanges[2 * d] = localBound[d].Lo();
+    localRanges[2 * d + 1] = localBound[d].Hi();
+  }
+
+  std::vector<double> ranges(2 * dimensionality * numRanks);
+  const int rangeCount = int(2 * dimensionality);
+  MPI_Allgather(localRanges.data(), rangeCount, MPI_DOUBLE, ranges.data(),
+      rangeCount, MPI_DOUBLE, comm);
+
+  for (int r = 0; r < numRanks; ++r)
+  {
+    BoundType bound(dimensionality);
+    for (size_t d = 0; d < dimensionality; ++d)
+    {
+      const size_t i = 2 * (r * dimensionality + d);
+      bound[d] = math::RangeType<ElemType>(ranges[i], ranges[i + 1]);
+    }
+    bounds.push_back(std::move(bound));
+  }
+
+  // No tree can be built on an empty shard, but it is never searched anyway.
+  if (localReferenceSet.n_cols > 0)
+    localSearch.Train(std::move(localReferenceSet));
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void DistributedNeighborSearch<SortPolicy, MetricType, MatType, TreeType>::
+Search(const MatType& querySet,
+       const size_t k,
+       arma::Mat<size_t>& neighbors,
+       arma::mat& distances)
+{
+  // Tell every rank the size of the query set.
+  unsigned long long querySize[2] = { querySet.n_rows, querySet.n_cols };
+  MPI_Bcast(querySize, 2, MPI_UNSIGNED_LONG_LONG, 0, comm);
+
+  if (querySize[0] != dimensionality)
+  {
+    std::ostringstream oss;
+    oss << "DistributedNeighborSearch::Search(): query set has dimensionality "
+        << querySize[0] << ", but the reference shards have dimensionality "
+        << dimensionality;
+    throw std::invalid_argument(oss.str());
+  }
+
+  if (k > numPoints)
+  {
+    std::ostringstream oss;
+    oss << "DistributedNeighborSearch::Search(): requested " << k
+        << " neighbors, but the reference shards only hold " << numPoints
+        << " points";
+    throw std::invalid_argument(oss.str());
+  }
+
+  // Broadcast the query set.  Rank 0 only reads from its buffer.
+  MatType localQuerySet;
+  const MatType* queries = &querySet;
+  if (rank != 0)
+  {
+    localQuerySet.set_size(querySize[0], querySize[1]);
+    queries = &localQuerySet;
+  }
+  MPI_Bcast(const_cast<ElemType*>(queries->memptr()), int(queries->n_elem),
+      ElemMPIType(), 0, comm);
+
+  // Every rank computes the same routes, so each rank knows how many results
+  // every other rank will send.
+  std::vector<std::vector<size_t>> routes;
+  ShardedNeighborSearch<SortPolicy, MetricType, MatType, TreeType>::
+      RouteQueries(*queries, k, bounds, sizes, routes);
+
+  std::vector<unsigned long long> localNeighbors;
+  std::vector<double> localDistances;
+  if (!routes[rank].empty())
+  {
+    Log::Info << "Rank " << rank << ": searching " << routes[rank].size()
+        << " query points on the local shard (" << sizes[rank] << " points)."
+        << std::endl;
+
+    const arma::uvec indices = arma::conv_to<arma::uvec>::from(routes[rank]);
+    const MatType routedQuerySet = queries->cols(indices);
+
+    arma::Mat<size_t> shardNeighbors;
+    arma::mat shardDistances;
+    localSearch.Search(routedQuerySet, std::min(k, sizes[rank]),
+        shardNeighbors, shardDistances);
+
+    localNeighbors.assign(shardNeighbors.begin(), shardNeighbors.end());
+    localDistances.assign(shardDistances.begin(), shardDistances.end());
+  }
+
+  // Gather everything on rank 0.
+  std::vector<int> counts(numRanks), displacements(numRanks);
+  int total = 0;
+  for (int r = 0; r < numRanks; ++r)
+  {
+    counts[r] = int(routes[r].size() * std::min(k, sizes[r]));
+    displacements[r] = total;
+    total += counts[r];
+  }
+
+  std::vector<unsigned long long> allNeighbors(rank == 0 ? total : 0);
+  std::vector<double> allDistances(rank == 0 ? total : 0);
+  MPI_Gatherv(localNeighbors.data(), counts[rank], MPI_UNSIGNED_LONG_LONG,
+      allNeighbors.data(), counts.data(), displacements.data(),
+      MPI_UNSIGNED_LONG_LONG, 0, comm);
+  MPI_Gatherv(localDistances.data(), counts[rank], MPI_DOUBLE,
+      allDistances.data(), counts.data(), displacements.data(), MPI_DOUBLE, 0,
+      comm);
+
+  if (rank != 0)
+  {
+    neighbors.reset();
+    distances.reset();
+    return;
+  }
+
+  // Initialize the results; every candidate is worse than any real neighbor.
+  neighbors.set_size(k, querySet.n_cols);
+  neighbors.fill(size_t() - 1);
+  distances.set_size(k, querySet.n_cols);
+  distances.fill(SortPolicy::WorstDistance());
+
+  // Merge in rank order, so that ties go to the lowest index.
+  for (int r = 0; r < numRanks; ++r)
+  {
+    if (routes[r].empty())
+      continue;
+
+    const size_t shardK = std::min(k, sizes[r]);
+    arma::Mat<size_t> shardNeighbors(shardK, routes[r].size());
+    std::copy(allNeighbors.begin() + displacements[r],
+        allNeighbors.begin() + displacements[r] + counts[r],
+        shardNeighbors.begin());
+    const arma::mat shardDistances(allDistances.data() + displacements[r],
+        shardK, routes[r].size());
+
+    const arma::uvec indices = arma::conv_to<arma::uvec>::from(routes[r]);
+    arma::Mat<size_t> routedNeighbors = neighbors.cols(indices);
+    arma::mat routedDistances = distances.cols(indices);
+    ChunkedNeighborSearch<SortPolicy, MetricType, MatType, TreeType>::
+        MergeResults(routedNeighbors, routedDistances, shardNeighbors,
+        shardDistances, offsets[r]);
+    neighbors.cols(indices) = routedNeighbors;
+    distances.cols(indices) = routedDistances;
+  }
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+MPI_Datatype DistributedNeighborSearch<SortPolicy, MetricType, MatType,
+    TreeType>::ElemMPIType()
+{
+  static_assert(std::is_same<ElemType, double>::value ||
+      std::is_same<ElemType, float>::value, "DistributedNeighborSearch only "
+      "supports arma::mat and arma::fmat data");
+
+  return std::is_same<ElemType, float>::value ? MPI_FLOAT : MPI_DOUBLE;
+}
+
+} // namespace neighbor
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,293 @@
+/**
+ * @file hnsw_search.hpp
+ *
+ * Defines the HNSWSearch class, which performs approximate nearest neighbor
+ * search with a hierarchical navigable small world graph built on the
+ * reference set.
+ *
+ * The details of this method can be found in the following paper:
+ *
+ * @article{malkov2020efficient,
+ *  title={Efficient and robust approximate nearest neighbor search using
+ *      Hierarchical Navigable Small World graphs},
+ *  author={Malkov, Yu. A. and Yashunin, D. A.},
+ *  journal={IEEE Transactions on Pattern Analysis and Machine Intelligence},
+ *  volume={42},
+ *  number={4},
+ *  pages={824--836},
+ *  year={2020}
+ * }
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_NEIGHBOR_SEARCH_HNSW_SEARCH_HPP
+#define MLPACK_METHODS_NEIGHBOR_SEARCH_HNSW_SEARCH_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/metrics/lmetric.hpp>
+
+#include <mutex>
+
+namespace mlpack {
+namespace neighbor {
+
+/**
+ * The HNSWSearch class builds a hierarchical navigable small world (HNSW) graph
+ * on the reference set and uses it to find approximate nearest neighbors.
+ * Each point is given a random level, drawn from an exponential distribution,
+ * and is linked to close points in each layer of the graph up to its level.
+ * A search starts at the single point of the top layer, walks greedily towards
+ * the query in each layer, and explores the bottom layer with a list of the ef
+ * best points found so far.  This is usually the fastest method for a given
+ * recall in high dimension, where trees can't prune.
+ *
+ * The parameters are those of the paper:
+ *
+ *  - M: the number of links of each point in each layer (2 * M in the bottom
+ *    layer); more links give a better recall, but a larger and slower graph;
+ *  - efConstruction: the number of candidate neighbors considered when a point
+ *    is inserted; a larger value gives a better graph but a slower build;
+ *  - ef: the number of candidates kept by a search (at least k); this trades
+ *    speed for recall and can be changed at any time.
+ *
+ * The points are inserted in parallel when OpenMP is available (each thread
+ * locks the points whose links it reads or modifies), and the query points
+ * are searched in parallel.  Because of this and the random levels, the graph,
+ * and so the results, may differ between runs.
+ *
+ * @code
+ * HNSWSearch<> hnsw(referenceSet, 16, 200);
+ * hnsw.Ef() = 100;
+ *
+ * arma::Mat<size_t> neighbors;
+ * arma::mat distances;
+ * hnsw.Search(querySet, 10, neighbors, distances);
+ * @endcode
+ *
+ * @tparam MetricType The metric to use for computation (an LMetric or an
+ *     IPMetric, for instance).
+ * @tparam MatType The type of data matrix.
+ */
+template<typename MetricType = metric::EuclideanDistance,
+         typename MatType = arma::mat>
+class HNSWSearch
+{
+ public:
+  /**
+   * Create the HNSWSearch object without a reference set.  Train() must be
+   * called before searching.
+   *
+   * @param m Number of links of each point in each layer (at least 2).
+   * @param efConstruction Number of candidates considered when inserting a
+   *     point.
+   * @param ef Number of candidates kept by a search.
+   * @param metric An optional instance of the MetricType class.
+   */
+  HNSWSearch(const size_t m = 16,
+             const size_t efConstruction = 200,
+             const size_t ef = 50,
+             const MetricType metric = MetricType());
+
+  /**
+   * Create the HNSWSearch object and build the graph on the given reference
+   * set.  The reference set is taken with std::move() if possible.
+   *
+   * @param referenceSet Set of reference points.
+   * @param m Number of links of each point in each layer (at least 2).
+   * @param efConstruction Number of candidates considered when inserting a
+   *     point.
+   * @param ef Number of candidates kept by a search.
+   * @param metric An optional instance of the MetricType class.
+   */
+  HNSWSearch(MatType referenceSet,
+             const size_t m = 16,
+             const size_t efConstruction = 200,
+             const size_t ef = 50,
+             const MetricType metric = MetricType());
+
+  /**
+   * Build the graph on the given reference set, replacing the current one.
+   * The reference set is taken with std::move() if possible.
+   *
+   * @param referenceSet Set of reference points.
+   */
+  void Train(MatType referenceSet);
+
+  /**
+   * Find the approximate k nearest neighbors of each point of the query set.
+   * Each column of neighbors and distances holds the neighbors of a query
+   * point, best first.  If fewer than k points are found (which can only
+   * happen when the graph is not connected), the missing neighbors have the
+   * index SIZE_MAX and the distance DBL_MAX.
+   *
+   * @param querySet Set of query points.
+   * @param k Number of neighbors to search for.
+   * @param neighbors Matrix storing lists of neighbors for each query point.
+   * @param distances Matrix storing distances of neighbors for each query
+   *     point.
+   */
+  void Search(const MatType& querySet,
+              const size_t k,
+              arma::Mat<size_t>& neighbors,
+              arma::mat& distances) const;
+
+  /**
+   * Find the approximate k nearest neighbors of each point of the reference
+   * set, not counting the point itself.
+   *
+   * @param k Number of neighbors to search for.
+   * @param neighbors Matrix storing lists of neighbors for each point.
+   * @param distances Matrix storing distances of neighbors for each point.
+   */
+  void Search(const size_t k,
+              arma::Mat<size_t>& neighbors,
+              arma::mat& distances) const;
+
+  //! Get the number of links of each point in each layer.
+  size_t M() const { return m; }
+  //! Get the number of candidates considered when inserting a point.
+  size_t EfConstruction() const { return efConstruction; }
+  //! Get the number of candidates kept by a search.
+  size_t Ef() const { return ef; }
+  //! Modify the number of candidates kept by a search.
+  size_t& Ef() { return ef; }
+
+  //! Get the top layer of the graph.
+  size_t MaxLevel() const { return maxLevel; }
+  //! Get the top layer of the given point.
+  size_t Level(const size_t point) const { return graph[point].size() - 1; }
+  //! Get the links of the given point in the given layer.
+  const std::vector<size_t>& Links(const size_t point,
+                                   const size_t level) const
+  { return graph[point][level]; }
+
+  //! Get the reference set.
+  const MatType& ReferenceSet() const { return referenceSet; }
+
+  //! Get the instantiated metric.
+  const MetricType& Metric() const { return metric; }
+  //! Modify the instantiated metric.
+  MetricType& Metric() { return metric; }
+
+  //! Serialize the index.
+  template<typename Archive>
+  void Serialize(Archive& ar, const unsigned int /* version */);
+
+ private:
+  //! A point and its distance to the point being searched for.
+  typedef std::pair<double, size_t> Candidate;
+
+  /**
+   * VisitedList marks the points visited by a search.  Each search increases
+   * the tag, so the marks don't need to be cleared.
+   */
+  class VisitedList
+  {
+   public:
+    //! Create the list for the given number of points.
+    VisitedList(const size_t numPoints) : marks(numPoints, 0), tag(0) { }
+
+    //! Forget all marks.
+    void Reset() { ++tag; }
+
+    //! Mark the given point and return whether or not it was already marked.
+    bool Visit(const size_t point)
+    {
+      if (marks[point] == tag)
+        return true;
+      marks[point] = tag;
+      return false;
+    }
+
+   private:
+    //! The tag of each point when it was last visited.
+    std::vector<size_t> marks;
+    //! The tag of the current search.
+    size_t tag;
+  };
+
+  /**
+   * Get the links of the given point in the given layer.  While the graph is
+   * built (locks is not NULL), the links are copied into the given buffer with
+   * the point locked.
+   */
+  const std::vector<size_t>& Links(const size_t point,
+                                   const size_t level,
+                                   std::vector<size_t>& buffer,
+                                   std::vector<std::mutex>* locks) const;
+
+  /**
+   * Walk greedily in the given layer from the given point (whose distance is
+   * given) to the point closest to the query point, and update both.
+   */
+  template<typename VecType>
+  void GreedySearch(const VecType& query,
+                    const size_t level,
+                    size_t& current,
+                    double& currentDistance,
+                    std::vector<std::mutex>* locks) const;
+
+  /**
+   * Search the given layer from the given entry points, and return the ef best
+   * points found, best first.
+   */
+  template<typename VecType>
+  std::vector<Candidate> SearchLayer(const VecType& query,
+                                     const std::vector<Candidate>& entries,
+                                     const size_t ef,
+                                     const size_t level,
+                                     VisitedList& visited,
+                                     std::vector<std::mutex>* locks) const;
+
+  /**
+   * Keep at most maxLinks of the given candidates (sorted best first) with the
+   * heuristic of the paper: a candidate is kept if it is closer to the point
+   * than to every candidate already kept, so that links go in different
+   * directions.
+   */
+  void SelectLinks(std::vector<Candidate>& candidates,
+                   const size_t maxLinks) const;
+
+  //! Insert the given point into the graph.
+  void Insert(const size_t point,
+              VisitedList& visited,
+              std::vector<std::mutex>& locks,
+              std::mutex& entryLock);
+
+  //! Find the neighbors of the given query point.
+  template<typename VecType>
+  void SearchPoint(const VecType& query,
+                   const size_t k,
+                   const size_t skipped,
+                   VisitedList& visited,
+                   size_t* neighbors,
+                   double* distances) const;
+
+  //! Number of links of each point in each layer.
+  size_t m;
+  //! Number of candidates considered when inserting a point.
+  size_t efConstruction;
+  //! Number of candidates kept by a search.
+  size_t ef;
+  //! Instantiation of the metric.
+  MetricType metric;
+  //! The reference set.
+  MatType referenceSet;
+  //! The links of each point, for each layer up to its level.
+  std::vector<std::vector<std::vector<size_t>>> graph;
+  //! The point the searches start from, which is in the top layer.
+  size_t entryPoint;
+  //! The top layer.
+  size_t maxLevel;
+};
+
+} // namespace neighbor
+} // namespace mlpack
+
+// Include implementation.
+#include "hnsw_search_impl.hpp"
+
+#endif
@@ -0,0 +1,466 @@
+/**
+ * @file hnsw_search_impl.hpp
+ *
+ * Implementation of the HNSWSearch class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_NEIGHBOR_SEARCH_HNSW_SEARCH_IMPL_HPP
+#define MLPACK_METHODS_NEIGHBOR_SEARCH_HNSW_SEARCH_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "hnsw_search.hpp"
+
+#include <queue>
+
+namespace mlpack {
+namespace neighbor {
+
+template<typename MetricType, typename MatType>
+HNSWSearch<MetricType, MatType>::HNSWSearch(const size_t m,
+                                            const size_t efConstruction,
+                                            const size_t ef,
+                                            const MetricType metric) :
+    m(m),
+    efConstruction(efConstruction),
+    ef(ef),
+    metric(metric),
+    entryPoint(0),
+    maxLevel(0)
+{
+  if (m < 2)
+  {
+    std::ostringstream error;
+    error << "HNSWSearch::HNSWSearch(): the number of links (" << m << ") must "
+        << "be at least 2";
+    throw std::invalid_argument(error.str());
+  }
+}
+
+template<typename MetricType, typename MatType>
+HNSWSearch<MetricType, MatType>::HNSWSearch(MatType referenceSet,
+                                            const size_t m,
+                                            const size_t efConstruction,
+                                            const size_t ef,
+                                            const MetricType metric) :
+    HNSWSearch(m, efConstruction, ef, metric)
+{
+  Train(std::move(referenceSet));
+}
+
+template<typename MetricType, typename MatType>
+void HNSWSearch<MetricType, MatType>::Train(MatType referenceSetIn)
+{
+  Timer::Start("tree_building");
+
+  referenceSet = std::move(referenceSetIn);
+  graph.clear();
+  graph.resize(referenceSet.n_cols);
+  entryPoint = 0;
+  maxLevel = 0;
+  if (referenceSet.n_cols == 0)
+  {
+    Timer::Stop("tree_building");
+    return;
+  }
+
+  // Draw the levels first, so that they only depend on the random seed.  The
+  // probability of a level decreases by a factor of m for each layer.
+  const double levelMultiplier = 1.0 / std::log((double) m);
+  for (size_t i = 0; i < referenceSet.n_cols; ++i)
+  {
+    const size_t level = (size_t) std::floor(-std::log(1.0 - math::Random()) *
+        levelMultiplier);
+    graph[i].resize(level + 1);
+  }
+
+  // The first point starts the graph.
+  maxLevel = graph[0].size() - 1;
+
+  std::vector<std::mutex> locks(referenceSet.n_cols);
+  std::mutex entryLock;
+
+  #pragma omp parallel
+  {
+    VisitedList visited(referenceSet.n_cols);
+
+#ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables. If we're building for Visual Studio,
+    // use the intmax_t type instead.
+    #pragma omp for schedule(dynamic, 16)
+    for (intmax_t i = 1; i < (intmax_t) referenceSet.n_cols; ++i)
+#else
+    #pragma omp for schedule(dynamic, 16)
+    for (size_t i = 1; i < referenceSet.n_cols; ++i)
+#endif
+    {
+      Insert(i, visited, locks, entryLock);
+    }
+  }
+
+  Timer::Stop("tree_building");
+}
+
+template<typename MetricType, typename MatType>
+void HNSWSearch<MetricType, MatType>::Search(const MatType& querySet,
+                                             const size_t k,
+                                             arma::Mat<size_t>& neighbors,
+                                             arma::mat& distances) const
+{
+  if (k > referenceSet.n_cols)
+  {
+    std::stringstream ss;
+    ss << "requested value of k (" << k << ") is greater than the number of "
+        << "points in the reference set (" << referenceSet.n_cols << ")";
+    throw std::invalid_argument(ss.str());
+  }
+
+  Timer::Start("computing_neighbors");
+
+  neighbors.set_size(k, querySet.n_cols);
+  distances.set_size(k, querySet.n_cols);
+
+  #pragma omp parallel
+  {
+    VisitedList visited(referenceSet.n_cols);
+
+#ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables. If we're building for Visual Studio,
+    // use the intmax_t type instead.
+    #pragma omp for schedule(dynamic, 16)
+    for (intmax_t i = 0; i < (intmax_t) querySet.n_cols; ++i)
+#else
+    #pragma omp for schedule(dynamic, 16)
+    for (size_t i = 0; i < querySet.n_cols; ++i)
+#endif
+    {
+      SearchPoint(querySet.col(i), k, size_t() - 1, visited,
+          neighbors.colptr(i), distances.colptr(i));
+    }
+  }
+
+  Timer::Stop("computing_neighbors");
+}
+
+template<typename MetricType, typename MatType>
+void HNSWSearch<MetricType, MatType>::Search(const size_t k,
+                                             arma::Mat<size_t>& neighbors,
+                                             arma::mat& distances) const
+{
+  if (k >= referenceSet.n_cols && k > 0)
+  {
+    std::stringstream ss;
+    ss << "requested value of k (" << k << ") is greater than or equal to the "
+        << "number of points in the reference set (" << referenceSet.n_cols
+        << ")";
+    throw std::invalid_argument(ss.str());
+  }
+
+  Timer::Start("computing_neighbors");
+
+  neighbors.set_size(k, referenceSet.n_cols);
+  distances.set_size(k, referenceSet.n_cols);
+
+  #pragma omp parallel
+  {
+    VisitedList visited(referenceSet.n_cols);
+
+#ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables. If we're building for Visual Studio,
+    // use the intmax_t type instead.
+    #pragma omp for schedule(dynamic, 16)
+    for (intmax_t i = 0; i < (intmax_t) referenceSet.n_cols; ++i)
+#else
+    #pragma omp for schedule(dynamic, 16)
+    for (size_t i = 0; i < referenceSet.n_cols; ++i)
+#endif
+    {
+      SearchPoint(referenceSet.col(i), k, i, visited, neighbors.colptr(i),
+          distances.colptr(i));
+    }
+  }
+
+  Timer::Stop("computing_neighbors");
+}
+
+template<typename MetricType, typename MatType>
+const std::vector<size_t>& HNSWSearch<MetricType, MatType>::Links(
+    const size_t point,
+    const size_t level,
+    std::vector<size_t>& buffer,
+    std::vector<std::mutex>* locks) const
+{
+  if (!locks)
+    return graph[point][level];
+
+  std::lock_guard<std::mutex> lock((*locks)[point]);
+  buffer = graph[point][level];
+  return buffer;
+}
+
+template<typename MetricType, typename MatType>
+template<typename VecType>
+void HNSWSearch<MetricType, MatType>::GreedySearch(
+    const VecType& query,
+    const size_t level,
+    size_t& current,
+    double& currentDistance,
+    std::vector<std::mutex>* locks) const
+{
+  std::vector<size_t> buffer;
+  bool changed = true;
+  while (changed)
+  {
+    changed = false;
+    const std::vector<size_t>& links = Links(current, level, buffer, locks);
+    for (size_t i = 0; i < links.size(); ++i)
+    {
+      const double distance = metric.Evaluate(query,
+          referenceSet.col(links[i]));
+      if (distance < currentDistance)
+      {
+        currentDistance = distance;
+        current = links[i];
+        changed = true;
+      }
+    }
+  }
+}
+
+template<typename MetricType, typename MatType>
+template<typename VecType>
+std::vector<typename HNSWSearch<MetricType, MatType>::Candidate>
+HNSWSearch<MetricType, MatType>::SearchLayer(
+    const VecType& query,
+    const std::vector<Candidate>& entries,
+    const size_t ef,
+    const size_t level,
+    VisitedList& visited,
+    std::vector<std::mutex>* locks) const
+{
+  // The candidates to expand, closest first, and the best points found, worst
+  // first.
+  std::priority_queue<Candidate, std::vector<Candidate>,
+      std::greater<Candidate>> candidates;
+  std::priority_queue<Candidate> results;
+
+  visited.Reset();
+  for (size_t i = 0; i < entries.size(); ++i)
+  {
+    visited.Visit(entries[i].second);
+    candidates.push(entries[i]);
+    results.push(entries[i]);
+    if (results.size() > ef)
+      results.pop();
+  }
+
+  std::vector<size_t> buffer;
+  while (!candidates.empty())
+  {
+    const Candidate candidate = candidates.top();
+    if (results.size() >= ef && candidate.first > results.top().first)
+      break;
+    candidates.pop();
+
+    const std::vector<size_t>& links = Links(candidate.second, level, buffer,
+        locks);
+    for (size_t i = 0; i < links.size(); ++i)
+    {
+      if (visited.Visit(links[i]))
+        continue;
+
+      const double distance = metric.Evaluate(query,
+          referenceSet.col(links[i]));
+      if (results.size() < ef || distance < results.top().first)
+      {
+        candidates.push(Candidate(distance, links[i]));
+        results.push(Candidate(distance, links[i]));
+        if (results.size() > ef)
+          results.pop();
+      }
+    }
+  }
+
+  std::vector<Candidate> found(results.size());
+  for (size_t i = found.size(); i > 0; --i)
+  {
+    found[i - 1] = results.top();
+    results.pop();
+  }
+
+  return found;
+}
+
+template<typename MetricType, typename MatType>
+void HNSWSearch<MetricType, MatType>::SelectLinks(
+    std::vector<Candidate>& candidates,
+    const size_t maxLinks) const
+{
+  if (candidates.size() <= maxLinks)
+    return;
+
+  std::vector<Candidate> selected;
+  selected.reserve(maxLinks);
+  for (size_t i = 0; i < candidates.size() && selected.size() < maxLinks; ++i)
+  {
+    bool keep = true;
+    for (size_t j = 0; j < selected.size(); ++j)
+    {
+      if (metric.Evaluate(referenceSet.col(candidates[i].second),
+          referenceSet.col(selected[j].second)) < candidates[i].first)
+      {
+        keep = false;
+        break;
+      }
+    }
+
+    if (keep)
+      selected.push_back(candidates[i]);
+  }
+
+  candidates.swap(selected);
+}
+
+template<typename MetricType, typename MatType>
+void HNSWSearch<MetricType, MatType>::Insert(const size_t point,
+                                             VisitedList& visited,
+                                             std::vector<std::mutex>& locks,
+                                             std::mutex& entryLock)
+{
+  const size_t level = graph[point].size() - 1;
+
+  // A point that becomes the new entry point holds the lock until it is
+  // linked, so that no other point starts from it before.
+  std::unique_lock<std::mutex> entryGuard(entryLock);
+  const size_t topLevel = maxLevel;
+  size_t current = entryPoint;
+  if (level <= topLevel)
+    entryGuard.unlock();
+
+  double currentDistance = metric.Evaluate(referenceSet.col(point),
+      referenceSet.col(current));
+  for (size_t l = topLevel; l > level; --l)
+  {
+    GreedySearch(referenceSet.col(point), l, current, currentDistance,
+        &locks);
+  }
+
+  std::vector<Candidate> entries(1, Candidate(currentDistance, current));
+  for (size_t l = std::min(level, topLevel) + 1; l > 0; --l)
+  {
+    const size_t layer = l - 1;
+    std::vector<Candidate> found = SearchLayer(referenceSet.col(point),
+        entries, efConstruction, layer, visited, &locks);
+    entries = found;
+
+    SelectLinks(found, m);
+    {
+      std::lock_guard<std::mutex> lock(locks[point]);
+      graph[point][layer].resize(found.size());
+      for (size_t i = 0; i < found.size(); ++i)
+        graph[point][layer][i] = found[i].second;
+    }
+
+    // Link each neighbor back to the point, and select its links again if it
+    // has too many.
+    const size_t maxLinks = (layer == 0) ? 2 * m : m;
+    for (size_t i = 0; i < found.size(); ++i)
+    {
+      const size_t neighbor = found[i].second;
+      std::lock_guard<std::mutex> lock(locks[neighbor]);
+      std::vector<size_t>& links = graph[neighbor][layer];
+      links.push_back(point);
+      if (links.size() <= maxLinks)
+        continue;
+
+      std::vector<Candidate> candidates(links.size());
+      for (size_t j = 0; j < links.size(); ++j)
+      {
+        candidates[j] = Candidate(metric.Evaluate(referenceSet.col(neighbor),
+            referenceSet.col(links[j])), links[j]);
+      }
+      std::sort(candidates.begin(), candidates.end());
+      SelectLinks(candidates, maxLinks);
+
+      links.resize(candidates.size());
+      for (size_t j = 0; j < candidates.size(); ++j)
+        links[j] = candidates[j].second;
+    }
+  }
+
+  if (level > topLevel)
+  {
+    entryPoint = point;
+    maxLevel = level;
+  }
+}
+
+template<typename MetricType, typename MatType>
+template<typename VecType>
+void HNSWSearch<MetricType, MatType>::SearchPoint(const VecType& query,
+                                                  const size_t k,
+                                                  const size_t skipped,
+                                                  VisitedList& visited,
+                                                  size_t* neighbors,
+                                                  double* distances) const
+{
+  if (k == 0)
+    return;
+
+  size_t current = entryPoint;
+  double currentDistance = metric.Evaluate(query, referenceSet.col(current));
+  for (size_t l = maxLevel; l > 0; --l)
+    GreedySearch(query, l, current, currentDistance, NULL);
+
+  // One more candidate is needed if the query point is a reference point.
+  const size_t wanted = (skipped == size_t() - 1) ? k : k + 1;
+  std::vector<Candidate> entries(1, Candidate(currentDistance, current));
+  const std::vector<Candidate> found = SearchLayer(query, entries,
+      std::max(ef, wanted), 0, visited, NULL);
+
+  size_t count = 0;
+  for (size_t i = 0; i < found.size() && count < k; ++i)
+  {
+    if (found[i].second == skipped)
+      continue;
+
+    neighbors[count] = found[i].second;
+    distances[count] = found[i].first;
+    ++count;
+  }
+
+  for (; count < k; ++count)
+  {
+    neighbors[count] = size_t() - 1;
+    distances[count] = DBL_MAX;
+  }
+}
+
+template<typename MetricType, typename MatType>
+template<typename Archive>
+void HNSWSearch<MetricType, MatType>::Serialize(
+    Archive& ar,
+    const unsigned int /* version */)
+{
+  using data::CreateNVP;
+
+  ar & CreateNVP(m, "m");
+  ar & CreateNVP(efConstruction, "efConstruction");
+  ar & CreateNVP(ef, "ef");
+  ar & CreateNVP(metric, "metric");
+  ar & CreateNVP(referenceSet, "referenceSet");
+  ar & CreateNVP(graph, "graph");
+  ar & CreateNVP(entryPoint, "entryPoint");
+  ar & CreateNVP(maxLevel, "maxLevel");
+}
+
+} // namespace neighbor
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,254 @@
+/**
+ * @file inverted_index_search.cpp
+ *
+ * Implementation of the InvertedIndexSearch class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "inverted_index_search.hpp"
+
+namespace mlpack {
+namespace neighbor {
+
+InvertedIndexSearch::InvertedIndexSearch(const bool cosine) :
+    cosine(cosine)
+{
+  // Nothing to do.
+}
+
+InvertedIndexSearch::InvertedIndexSearch(const arma::sp_mat& referenceSet,
+                                         const bool cosine) :
+    cosine(cosine)
+{
+  Train(referenceSet);
+}
+
+void InvertedIndexSearch::Train(const arma::sp_mat& referenceSet)
+{
+  Timer::Start("tree_building");
+
+  // Build the transposed reference set, so that each column is the posting
+  // list of a feature, with the points in increasing order.
+  arma::umat locations(2, referenceSet.n_nonzero);
+  arma::vec values(referenceSet.n_nonzero);
+  for (size_t i = 0; i < referenceSet.n_cols; ++i)
+  {
+    const size_t begin = referenceSet.col_ptrs[i];
+    const size_t end = referenceSet.col_ptrs[i + 1];
+
+    double norm = 1.0;
+    if (cosine)
+    {
+      norm = 0.0;
+      for (size_t j = begin; j < end; ++j)
+        norm += referenceSet.values[j] * referenceSet.values[j];
+      norm = std::sqrt(norm);
+    }
+
+    for (size_t j = begin; j < end; ++j)
+    {
+      locations(0, j) = i;
+      locations(1, j) = referenceSet.row_indices[j];
+      values[j] = referenceSet.values[j] / norm;
+    }
+  }
+
+  index = arma::sp_mat(locations, values, referenceSet.n_cols,
+      referenceSet.n_rows);
+
+  maxValues.zeros(index.n_cols);
+  minValues.zeros(index.n_cols);
+  for (size_t f = 0; f < index.n_cols; ++f)
+  {
+    for (size_t j = index.col_ptrs[f]; j < index.col_ptrs[f + 1]; ++j)
+    {
+      maxValues[f] = std::max(maxValues[f], index.values[j]);
+      minValues[f] = std::min(minValues[f], index.values[j]);
+    }
+  }
+
+  Timer::Stop("tree_building");
+}
+
+void InvertedIndexSearch::Search(const arma::sp_mat& querySet,
+                                 const size_t k,
+                                 arma::Mat<size_t>& neighbors,
+                                 arma::mat& similarities) const
+{
+  if (k > Size())
+  {
+    std::stringstream ss;
+    ss << "requested value of k (" << k << ") is greater than the number of "
+        << "points in the reference set (" << Size() << ")";
+    throw std::invalid_argument(ss.str());
+  }
+
+  if (querySet.n_rows != Dimensionality())
+  {
+    std::ostringstream error;
+    error << "InvertedIndexSearch::Search(): the dimensionality of the query "
+        << "points (" << querySet.n_rows << ") doesn't match the "
+        << "dimensionality of the reference points (" << Dimensionality()
+        << ")";
+    throw std::invalid_argument(error.str());
+  }
+
+  Timer::Start("computing_neighbors");
+
+  neighbors.set_size(k, querySet.n_cols);
+  similarities.set_size(k, querySet.n_cols);
+
+  #pragma omp parallel
+  {
+    std::vector<Cursor> cursors;
+    std::vector<Candidate> found;
+
+#ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables. If we're building for Visual Studio,
+    // use the intmax_t type instead.
+    #pragma omp for schedule(dynamic, 16)
+    for (intmax_t i = 0; i < (intmax_t) querySet.n_cols; ++i)
+#else
+    #pragma omp for schedule(dynamic, 16)
+    for (size_t i = 0; i < querySet.n_cols; ++i)
+#endif
+    {
+      SearchPoint(querySet, i, k, cursors, found);
+
+      size_t count = 0;
+      for (; count < found.size(); ++count)
+      {
+        neighbors(count, i) = found[count].second;
+        similarities(count, i) = found[count].first;
+      }
+
+      for (; count < k; ++count)
+      {
+        neighbors(count, i) = size_t() - 1;
+        similarities(count, i) = -DBL_MAX;
+      }
+    }
+  }
+
+  Timer::Stop("computing_neighbors");
+}
+
+void InvertedIndexSearch::SearchPoint(const arma::sp_mat& querySet,
+                                      const size_t query,
+                                      const size_t k,
+                                      std::vector<Cursor>& cursors,
+                                      std::vector<Candidate>& found) const
+{
+  found.clear();
+  cursors.clear();
+  if (k == 0)
+    return;
+
+  const size_t begin = querySet.col_ptrs[query];
+  const size_t end = querySet.col_ptrs[query + 1];
+
+  double norm = 1.0;
+  if (cosine)
+  {
+    norm = 0.0;
+    for (size_t j = begin; j < end; ++j)
+      norm += querySet.values[j] * querySet.values[j];
+    norm = std::sqrt(norm);
+  }
+
+  // Open the posting list of each nonzero feature of the query point.  A
+  // feature contributes at most weight * maxValue (or weight * minValue, for a
+  // negative weight) to a similarity, and nothing to the points without it.
+  for (size_t j = begin; j < end; ++j)
+  {
+    const size_t feature = querySet.row_indices[j];
+    const size_t listBegin = index.col_ptrs[feature];
+    const size_t listEnd = index.col_ptrs[feature + 1];
+    if (listBegin == listEnd)
+      continue;
+
+    Cursor cursor;
+    cursor.point = index.row_indices + listBegin;
+    cursor.end = index.row_indices + listEnd;
+    cursor.value = index.values + listBegin;
+    cursor.weight = querySet.values[j] / norm;
+    cursor.bound = std::max(0.0, std::max(cursor.weight * maxValues[feature],
+        cursor.weight * minValues[feature]));
+    cursors.push_back(cursor);
+  }
+
+  // The k best candidates are kept in a min-heap.
+  std::greater<Candidate> compare;
+  while (!cursors.empty())
+  {
+    std::sort(cursors.begin(), cursors.end(),
+        [](const Cursor& a, const Cursor& b) { return *a.point < *b.point; });
+
+    // Find the pivot: the first point whose bound exceeds the k-th best
+    // similarity.  Points before it can't be among the k best.
+    const double threshold = (found.size() < k) ? -DBL_MAX :
+        found.front().first;
+    double bound = 0.0;
+    size_t pivot = 0;
+    for (; pivot < cursors.size(); ++pivot)
+    {
+      bound += cursors[pivot].bound;
+      if (bound > threshold)
+        break;
+    }
+
+    if (pivot == cursors.size())
+      break;
+
+    const arma::uword pivotPoint = *cursors[pivot].point;
+    if (*cursors[0].point == pivotPoint)
+    {
+      // All the lists that hold the pivot point are at the front, so it can be
+      // scored.
+      double similarity = 0.0;
+      for (size_t c = 0; c < cursors.size() && *cursors[c].point == pivotPoint;
+           ++c)
+      {
+        similarity += cursors[c].weight * (*cursors[c].value);
+        ++cursors[c].point;
+        ++cursors[c].value;
+      }
+
+      if (found.size() < k)
+      {
+        found.push_back(Candidate(similarity, pivotPoint));
+        std::push_heap(found.begin(), found.end(), compare);
+      }
+      else if (similarity > threshold)
+      {
+        std::pop_heap(found.begin(), found.end(), compare);
+        found.back() = Candidate(similarity, pivotPoint);
+        std::push_heap(found.begin(), found.end(), compare);
+      }
+    }
+    else
+    {
+      // Skip the points before the pivot in the preceding lists.
+      for (size_t c = 0; c < pivot; ++c)
+      {
+        const arma::uword* next = std::lower_bound(cursors[c].point,
+            cursors[c].end, pivotPoint);
+        cursors[c].value += (next - cursors[c].point);
+        cursors[c].point = next;
+      }
+    }
+
+    // Close the lists that were fully traversed.
+    cursors.erase(std::remove_if(cursors.begin(), cursors.end(),
+        [](const Cursor& c) { return c.point == c.end; }), cursors.end());
+  }
+
+  std::sort_heap(found.begin(), found.end(), compare);
+}
+
+} // namespace neighbor
+} // namespace mlpack
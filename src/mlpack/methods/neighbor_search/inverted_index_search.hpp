@@ -0,0 +1,166 @@
+/**
+ * @file inverted_index_search.hpp
+ *
+ * Defines the InvertedIndexSearch class, which finds the points of a sparse
+ * reference set with the largest inner product or cosine similarity to each
+ * sparse query point with an inverted index and WAND pruning.
+ *
+ * The details of the pruning can be found in the following paper:
+ *
+ * @inproceedings{broder2003efficient,
+ *  title={Efficient query evaluation using a two-level retrieval process},
+ *  author={Broder, A.Z. and Carmel, D. and Herscovici, M. and Soffer, A. and
+ *      Zien, J.},
+ *  booktitle={Proceedings of the Twelfth International Conference on
+ *      Information and Knowledge Management},
+ *  pages={426--434},
+ *  year={2003}
+ * }
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_NEIGHBOR_SEARCH_INVERTED_INDEX_SEARCH_HPP
+#define MLPACK_METHODS_NEIGHBOR_SEARCH_INVERTED_INDEX_SEARCH_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace neighbor {
+
+/**
+ * The InvertedIndexSearch class finds the k points of a sparse reference set
+ * with the largest inner product (or cosine similarity) to each point of a
+ * sparse query set, such as TF-IDF vectors with millions of dimensions, where
+ * trees can't prune and NeighborSearch on arma::sp_mat is no faster than brute
+ * force.
+ *
+ * The index holds one posting list per feature: the points where the feature
+ * is nonzero, in increasing order, with their values (divided by the norm of
+ * the point for the cosine similarity).  A query only visits the posting lists
+ * of its own nonzero features, and the lists are traversed with WAND: each
+ * list has an upper bound on its contribution to the similarity, and points
+ * whose bounds sum to no more than the k-th best similarity found so far are
+ * skipped by a binary search in the lists, without being scored.  The results
+ * are exact.
+ *
+ * Only the points that share a nonzero feature with a query point are
+ * candidates; if there are fewer than k of them, the missing neighbors have
+ * the index SIZE_MAX and the similarity -DBL_MAX.  Query points are searched
+ * in parallel when OpenMP is available.
+ *
+ * @code
+ * arma::sp_mat documents; // One TF-IDF vector per column.
+ * InvertedIndexSearch index(documents, true);
+ *
+ * arma::Mat<size_t> neighbors;
+ * arma::mat similarities;
+ * index.Search(queries, 10, neighbors, similarities);
+ * @endcode
+ */
+class InvertedIndexSearch
+{
+ public:
+  /**
+   * Create the InvertedIndexSearch object with an empty index.
+   *
+   * @param cosine If true, the cosine similarity is used instead of the inner
+   *     product.
+   */
+  InvertedIndexSearch(const bool cosine = false);
+
+  /**
+   * Create the InvertedIndexSearch object and index the given reference set.
+   *
+   * @param referenceSet Set of reference points (one per column).
+   * @param cosine If true, the cosine similarity is used instead of the inner
+   *     product.
+   */
+  InvertedIndexSearch(const arma::sp_mat& referenceSet,
+                      const bool cosine = false);
+
+  /**
+   * Index the given reference set, replacing the current index.
+   *
+   * @param referenceSet Set of reference points (one per column).
+   */
+  void Train(const arma::sp_mat& referenceSet);
+
+  /**
+   * Find the k reference points with the largest similarity to each point of
+   * the query set, most similar first.
+   *
+   * @param querySet Set of query points (one per column).
+   * @param k Number of neighbors to search for.
+   * @param neighbors Matrix storing lists of neighbors for each query point.
+   * @param similarities Matrix storing the similarities of the neighbors for
+   *     each query point.
+   */
+  void Search(const arma::sp_mat& querySet,
+              const size_t k,
+              arma::Mat<size_t>& neighbors,
+              arma::mat& similarities) const;
+
+  //! Get whether the cosine similarity is used.
+  bool Cosine() const { return cosine; }
+
+  //! Get the number of indexed points.
+  size_t Size() const { return index.n_rows; }
+  //! Get the dimensionality of the indexed points.
+  size_t Dimensionality() const { return index.n_cols; }
+
+  //! Get the index: column j holds the posting list of feature j.
+  const arma::sp_mat& Index() const { return index; }
+
+  //! Serialize the index.
+  template<typename Archive>
+  void Serialize(Archive& ar, const unsigned int /* version */);
+
+ private:
+  //! The position of a query in the posting list of one of its features.
+  struct Cursor
+  {
+    //! The current point of the list.
+    const arma::uword* point;
+    //! The end of the list.
+    const arma::uword* end;
+    //! The value of the feature for the current point.
+    const double* value;
+    //! The value of the feature for the query point.
+    double weight;
+    //! Upper bound on the contribution of the feature to a similarity.
+    double bound;
+  };
+
+  //! A point and its similarity to the query point.
+  typedef std::pair<double, size_t> Candidate;
+
+  /**
+   * Find the k reference points most similar to the given query point, most
+   * similar first.
+   */
+  void SearchPoint(const arma::sp_mat& querySet,
+                   const size_t query,
+                   const size_t k,
+                   std::vector<Cursor>& cursors,
+                   std::vector<Candidate>& found) const;
+
+  //! Whether the cosine similarity is used.
+  bool cosine;
+  //! The transposed (and normalized) reference set.
+  arma::sp_mat index;
+  //! The largest value of each feature.
+  arma::vec maxValues;
+  //! The smallest value of each feature.
+  arma::vec minValues;
+};
+
+} // namespace neighbor
+} // namespace mlpack
+
+// Include implementation of templated functions.
+#include "inverted_index_search_impl.hpp"
+
+#endif
@@ -0,0 +1,35 @@
+/**
+ * @file inverted_index_search_impl.hpp
+ *
+ * Implementation of the templated functions of the InvertedIndexSearch class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_NEIGHBOR_SEARCH_INVERTED_INDEX_SEARCH_IMPL_HPP
+#define MLPACK_METHODS_NEIGHBOR_SEARCH_INVERTED_INDEX_SEARCH_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "inverted_index_search.hpp"
+
+namespace mlpack {
+namespace neighbor {
+
+template<typename Archive>
+void InvertedIndexSearch::Serialize(Archive& ar,
+                                    const unsigned int /* version */)
+{
+  using data::CreateNVP;
+
+  ar & CreateNVP(cosine, "cosine");
+  ar & CreateNVP(index, "index");
+  ar & CreateNVP(maxValues, "maxValues");
+  ar & CreateNVP(minValues, "minValues");
+}
+
+} // namespace neighbor
+} // namespace mlpack
+
+#endif
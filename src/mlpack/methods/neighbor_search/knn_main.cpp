@@ -12,16 +12,26 @@
  */
 #include <mlpack/prereqs.hpp>
 #include <mlpack/core/util/cli.hpp>
+#include <mlpack/core/util/model_server.hpp>
 #include <mlpack/core/metrics/lmetric.hpp>
 #include <mlpack/core/tree/cover_tree.hpp>
 
 #include <string>
 #include <fstream>
 #include <iostream>
+#include <sstream>
 
 #include "neighbor_search.hpp"
 #include "unmap.hpp"
 #include "ns_model.hpp"
+#include "chunked_neighbor_search.hpp"
+#include "spill_tree_tuner.hpp"
+#include "hnsw_search.hpp"
+#include "nn_descent.hpp"
+
+#ifdef HAS_MPI
+  #include "distributed_neighbor_search.hpp"
+#endif
 
 using namespace std;
 using namespace mlpack;
@@ -51,10 +61,60 @@ PROGRAM_INFO("k-Nearest-Neighbors",
     "neighbors output file corresponds to the index of the point in the "
     "reference set which is the i'th nearest neighbor from the point in the "
     "query set with index j.  Row i and column j in the distances output file "
-    "corresponds to the distance between those two points.");
+    "corresponds to the distance between those two points."
+    "\n\n"
+    "If the reference set is too large to fit in memory, it can be split into "
+    "several files given with --reference_chunks (-C) instead of "
+    "--reference_file.  A kd-tree is then built on each chunk in turn, while "
+    "the next chunk is loaded in the background, and the results are merged.  "
+    "Neighbor indices refer to the concatenation of the chunks, in the order "
+    "given.  A query set must be given in this case, and no model can be "
+    "saved."
+    "\n\n"
+    "With spill trees, --target_recall (-g) may be given instead of --tau "
+    "(-u) and --leaf_size (-l).  They are then chosen automatically: spill "
+    "trees with several overlaps and leaf sizes are built, a random sample of "
+    "at most --tune_sample_size (-z) query points is searched with each, and "
+    "the fastest setting whose recall on the sample reaches the target is "
+    "used.  Since the tuning measures single-tree search, single-tree search "
+    "is used unless --algorithm (-a) is given."
+    "\n\n"
+    "With --algorithm greedy, only the best child of each tree node is "
+    "visited.  Recall can be traded for time with --beam_width, the number of "
+    "nodes kept at each level, and --backtrack_budget, the number of base "
+    "cases each query point may spend on the nodes left out of the beam."
+    "\n\n"
+    "With --tree_type hnsw, no tree is built: a hierarchical navigable small "
+    "world graph is built on the reference set instead, with --hnsw_m links "
+    "per point and --hnsw_ef_construction candidates per insertion, and the "
+    "search is approximate, keeping --hnsw_ef candidates (more candidates give "
+    "a better recall but a slower search).  --algorithm (-a) and --epsilon "
+    "(-e) are then ignored, and the graph can't be saved as a kNN model."
+    "\n\n"
+    "With --tree_type nn-descent, the approximate --k nearest neighbors of "
+    "each reference point are found by NN-Descent: the neighbor lists are "
+    "seeded with the leaves of --nn_descent_trees random projection trees "
+    "(with --leaf_size points per leaf), and then refined with the neighbors "
+    "of the neighbors for at most --nn_descent_iterations iterations.  No "
+    "query set may be given, and no model can be saved."
+    "\n\n"
+    "With --serve, the model is built or loaded once, and then searches for the"
+    " --k nearest neighbors of query sets read from the standard input are "
+    "answered on the standard output, with the binary protocol of "
+    "mlpack::util::ModelServer, until the input ends.  Each response holds the"
+    " neighbors and the distances.  Log output goes to the standard error "
+    "while serving.");
 
 // Define our input parameters that this program will take.
 PARAM_MATRIX_IN("reference", "Matrix containing the reference dataset.", "r");
+PARAM_VECTOR_IN(string, "reference_chunks", "Files holding consecutive chunks "
+    "of a reference set too large to fit in memory (used instead of "
+    "--reference_file).", "C");
+#ifdef HAS_MPI
+PARAM_FLAG("distributed", "When run under MPI, rank i loads and searches only "
+    "the i'th file of --reference_chunks (one chunk per rank); the query set "
+    "is read on rank 0 and the results are merged and saved on rank 0.", "P");
+#endif
 PARAM_MATRIX_OUT("distances", "Matrix to output distances into.", "d");
 PARAM_UMATRIX_OUT("neighbors", "Matrix to output neighbors into.", "n");
 PARAM_MATRIX_IN("true_distances", "Matrix of true distances to compute "
@@ -71,13 +131,16 @@ PARAM_MODEL_OUT(KNNModel, "output_model", "If specified, the kNN model will be "
 // The user may specify a query file of query points and a number of nearest
 // neighbors to search for.
 PARAM_MATRIX_IN("query", "Matrix containing query points (optional).", "q");
+PARAM_FLAG("serve", "If set, answer searches for query sets read from the "
+    "standard input, until the input ends.", "");
 PARAM_INT_IN("k", "Number of nearest neighbors to find.", "k", 0);
 
 // The user may specify the type of tree to use, and a few parameters for tree
 // building.
 PARAM_STRING_IN("tree_type", "Type of tree to use: 'kd', 'vp', 'rp', 'max-rp', "
     "'ub', 'cover', 'r', 'r-star', 'x', 'ball', 'hilbert-r', 'r-plus', "
-    "'r-plus-plus', 'spill', 'oct'.", "t", "kd");
+    "'r-plus-plus', 'spill', 'oct', 'hnsw' (a graph, not a tree), "
+    "'nn-descent' (for the reference set only).", "t", "kd");
 PARAM_INT_IN("leaf_size", "Leaf size for tree building (used for kd-trees, vp "
     "trees, random projection trees, UB trees, R trees, R* trees, X trees, "
     "Hilbert R trees, R+ trees, R++ trees, spill trees, and octrees).", "l",
@@ -86,6 +149,22 @@ PARAM_DOUBLE_IN("tau", "Overlapping size (only valid for spill trees).", "u",
     0);
 PARAM_DOUBLE_IN("rho", "Balance threshold (only valid for spill trees).", "b",
     0.7);
+PARAM_DOUBLE_IN("target_recall", "If specified, tau and the leaf size of the "
+    "spill tree are tuned to reach this recall (only valid for spill trees).",
+    "g", 0);
+PARAM_INT_IN("hnsw_m", "Number of links of each point in each layer of the "
+    "HNSW graph (only valid with --tree_type hnsw).", "", 16);
+PARAM_INT_IN("hnsw_ef_construction", "Number of candidates considered when "
+    "inserting a point in the HNSW graph (only valid with --tree_type hnsw).",
+    "", 200);
+PARAM_INT_IN("hnsw_ef", "Number of candidates kept by a search in the HNSW "
+    "graph (only valid with --tree_type hnsw).", "", 50);
+PARAM_INT_IN("nn_descent_trees", "Number of random projection trees used to "
+    "seed NN-Descent (only valid with --tree_type nn-descent).", "", 4);
+PARAM_INT_IN("nn_descent_iterations", "Maximum number of iterations of "
+    "NN-Descent (only valid with --tree_type nn-descent).", "", 10);
+PARAM_INT_IN("tune_sample_size", "Maximum number of query points used to tune "
+    "the spill tree when --target_recall is specified.", "z", 1000);
 
 PARAM_FLAG("random_basis", "Before tree-building, project the data onto a "
     "random orthogonal basis.", "R");
@@ -102,9 +181,25 @@ PARAM_FLAG("single_mode", "(Deprecated) If true, single-tree search is used "
     "'--algorithm single_tree' instead.", "S");
 PARAM_DOUBLE_IN("epsilon", "If specified, will do approximate nearest neighbor "
     "search with given relative error.", "e", 0);
+PARAM_INT_IN("beam_width", "Number of nodes kept at each level of the tree by "
+    "greedy search (only valid with --algorithm greedy).", "", 1);
+PARAM_INT_IN("backtrack_budget", "Number of base cases greedy search may spend "
+    "on the nodes left out of the beam, for each query point (only valid "
+    "with --algorithm greedy).", "", 0);
 
 int main(int argc, char *argv[])
 {
+  // Only rank 0 saves output when running under MPI.
+  bool isRoot = true;
+  bool distributed = false;
+#ifdef HAS_MPI
+  MPI_Init(&argc, &argv);
+  int rank, numRanks;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &numRanks);
+  isRoot = (rank == 0);
+#endif
+
   // Give CLI the command line parameters the user passed in.
   CLI::ParseCommandLine(argc, argv);
 
@@ -119,10 +214,64 @@ int main(int argc, char *argv[])
         << " may be specified!" << endl;
 
   // A user must specify one of them...
-  if (!CLI::HasParam("reference") && !CLI::HasParam("input_model"))
+  if (!CLI::HasParam("reference") && !CLI::HasParam("input_model") &&
+      !CLI::HasParam("reference_chunks"))
     Log::Fatal << "No model specified (--input_model_file) and no reference "
         << "data specified (--reference_file)!  One must be provided." << endl;
 
+  if (CLI::HasParam("reference_chunks"))
+  {
+    if (CLI::HasParam("reference") || CLI::HasParam("input_model"))
+      Log::Fatal << "--reference_chunks (-C) may not be specified with "
+          << "--reference_file (-r) or --input_model_file (-m)!" << endl;
+    if (CLI::HasParam("output_model"))
+      Log::Fatal << "--output_model_file (-M) may not be specified with "
+          << "--reference_chunks (-C), because no single model is built!"
+          << endl;
+    if (!CLI::HasParam("query") || !CLI::HasParam("k"))
+      Log::Fatal << "--query_file (-q) and --k (-k) must be specified with "
+          << "--reference_chunks (-C)!" << endl;
+    if (CLI::HasParam("tree_type") &&
+        CLI::GetParam<string>("tree_type") != "kd")
+      Log::Fatal << "Only kd-trees can be used with --reference_chunks (-C)!"
+          << endl;
+    if (CLI::HasParam("random_basis"))
+      Log::Warn << "--random_basis (-R) will be ignored because "
+          << "--reference_chunks is specified." << endl;
+    if (CLI::HasParam("leaf_size"))
+      Log::Warn << "--leaf_size (-l) will be ignored because "
+          << "--reference_chunks is specified." << endl;
+  }
+
+#ifdef HAS_MPI
+  distributed = CLI::HasParam("distributed");
+  if (distributed)
+  {
+    if (!CLI::HasParam("reference_chunks"))
+      Log::Fatal << "--reference_chunks (-C) must be specified with "
+          << "--distributed (-P)!" << endl;
+    if (CLI::GetParam<vector<string>>("reference_chunks").size() !=
+        size_t(numRanks))
+      Log::Fatal << "--distributed (-P) requires one reference chunk per MPI "
+          << "rank, but " << numRanks << " ranks and "
+          << CLI::GetParam<vector<string>>("reference_chunks").size()
+          << " chunks are given!" << endl;
+  }
+#endif
+
+  if (CLI::HasParam("serve"))
+  {
+    if (!CLI::HasParam("k"))
+      Log::Fatal << "--k (-k) must be specified with --serve!" << endl;
+    if (CLI::HasParam("query") || CLI::HasParam("reference_chunks"))
+      Log::Fatal << "--query_file (-q) and --reference_chunks (-C) may not be "
+          << "specified with --serve!" << endl;
+    if (CLI::HasParam("neighbors") || CLI::HasParam("distances") ||
+        CLI::HasParam("true_neighbors") || CLI::HasParam("true_distances"))
+      Log::Warn << "Output and evaluation files are ignored with --serve, "
+          << "since the results are written to the standard output." << endl;
+  }
+
   if (CLI::HasParam("input_model"))
   {
     // Notify the user of parameters that will be ignored.
@@ -138,6 +287,9 @@ int main(int argc, char *argv[])
     if (CLI::HasParam("rho"))
       Log::Warn << "--rho (-b) will be ignored because --input_model_file is "
           "specified." << endl;
+    if (CLI::HasParam("target_recall"))
+      Log::Warn << "--target_recall (-g) will be ignored because "
+          << "--input_model_file is specified." << endl;
     // Notify the user of parameters that will be only be considered for query
     // tree.
     if (CLI::HasParam("leaf_size"))
@@ -151,7 +303,7 @@ int main(int argc, char *argv[])
         << "results from this program will be saved!" << endl;
 
   // If the user specifies k but no output files, they should be warned.
-  if (CLI::HasParam("k") &&
+  if (CLI::HasParam("k") && !CLI::HasParam("serve") &&
       !(CLI::HasParam("neighbors") || CLI::HasParam("distances")))
     Log::Warn << "Neither --neighbors_file nor --distances_file is specified, "
         << "so the nearest neighbor search results will not be saved!" << endl;
@@ -193,14 +345,108 @@ int main(int argc, char *argv[])
   if (CLI::HasParam("rho") && "spill" != CLI::GetParam<string>("tree_type"))
     Log::Fatal << "Rho parameter is only valid for spill trees." << endl;
 
+  // Sanity check on the tuning options.
+  const bool autoTune = CLI::HasParam("target_recall") &&
+      CLI::HasParam("reference");
+  if (CLI::HasParam("target_recall"))
+  {
+    const double targetRecall = CLI::GetParam<double>("target_recall");
+    if (targetRecall <= 0 || targetRecall > 1)
+      Log::Fatal << "Invalid target recall: " << targetRecall << ".  Must be "
+          << "in the range (0, 1]." << endl;
+    if ("spill" != CLI::GetParam<string>("tree_type"))
+      Log::Fatal << "Target recall is only valid for spill trees." << endl;
+    if (!CLI::HasParam("k"))
+      Log::Fatal << "--k (-k) must be specified with --target_recall (-g)!"
+          << endl;
+    if (CLI::HasParam("tau"))
+      Log::Warn << "--tau (-u) will be ignored because --target_recall (-g) "
+          << "is specified." << endl;
+    if (CLI::HasParam("leaf_size"))
+      Log::Warn << "--leaf_size (-l) will be ignored because --target_recall "
+          << "(-g) is specified." << endl;
+  }
+  if (CLI::GetParam<int>("tune_sample_size") < 1)
+    Log::Fatal << "Invalid tuning sample size: "
+        << CLI::GetParam<int>("tune_sample_size") << ".  Must be greater than "
+        << "0." << endl;
+
   // Sanity check on epsilon.
   const double epsilon = CLI::GetParam<double>("epsilon");
   if (epsilon < 0)
     Log::Fatal << "Invalid epsilon: " << epsilon << ".  Must be non-negative. "
         << endl;
 
+  // Sanity checks on the greedy search options.
+  const int beamWidth = CLI::GetParam<int>("beam_width");
+  const int backtrackBudget = CLI::GetParam<int>("backtrack_budget");
+  if (beamWidth < 1)
+    Log::Fatal << "Invalid beam width: " << beamWidth << ".  Must be greater "
+        << "than 0." << endl;
+  if (backtrackBudget < 0)
+    Log::Fatal << "Invalid backtracking budget: " << backtrackBudget << ".  "
+        << "Must be 0 or greater." << endl;
+  if ((CLI::HasParam("beam_width") || CLI::HasParam("backtrack_budget")) &&
+      CLI::GetParam<string>("algorithm") != "greedy")
+    Log::Warn << "--beam_width and --backtrack_budget are ignored without "
+        << "--algorithm greedy." << endl;
+
+  // Sanity checks on the HNSW options.
+  const bool useHNSW = CLI::HasParam("reference") &&
+      CLI::GetParam<string>("tree_type") == "hnsw";
+  if (CLI::GetParam<string>("tree_type") != "hnsw" &&
+      (CLI::HasParam("hnsw_m") || CLI::HasParam("hnsw_ef_construction") ||
+       CLI::HasParam("hnsw_ef")))
+    Log::Fatal << "--hnsw_m, --hnsw_ef_construction and --hnsw_ef are only "
+        << "valid with --tree_type hnsw." << endl;
+  if (useHNSW)
+  {
+    if (CLI::HasParam("output_model"))
+      Log::Fatal << "--output_model_file (-M) may not be specified with "
+          << "--tree_type hnsw!" << endl;
+    if (CLI::GetParam<int>("hnsw_m") < 2)
+      Log::Fatal << "Invalid --hnsw_m: " << CLI::GetParam<int>("hnsw_m")
+          << ".  Must be at least 2." << endl;
+    if (CLI::GetParam<int>("hnsw_ef_construction") < 1 ||
+        CLI::GetParam<int>("hnsw_ef") < 1)
+      Log::Fatal << "--hnsw_ef_construction and --hnsw_ef must be greater "
+          << "than 0." << endl;
+    if (CLI::HasParam("algorithm") || CLI::HasParam("epsilon") ||
+        CLI::HasParam("leaf_size") || CLI::HasParam("random_basis"))
+      Log::Warn << "--algorithm (-a), --epsilon (-e), --leaf_size (-l) and "
+          << "--random_basis (-R) are ignored with --tree_type hnsw." << endl;
+  }
+
+  // Sanity checks on the NN-Descent options.
+  const bool useNNDescent = CLI::HasParam("reference") &&
+      CLI::GetParam<string>("tree_type") == "nn-descent";
+  if (CLI::GetParam<string>("tree_type") != "nn-descent" &&
+      (CLI::HasParam("nn_descent_trees") ||
+       CLI::HasParam("nn_descent_iterations")))
+    Log::Fatal << "--nn_descent_trees and --nn_descent_iterations are only "
+        << "valid with --tree_type nn-descent." << endl;
+  if (useNNDescent)
+  {
+    if (CLI::HasParam("output_model") || CLI::HasParam("query") ||
+        CLI::HasParam("serve"))
+      Log::Fatal << "--output_model_file (-M), --query_file (-q) and --serve "
+          << "may not be specified with --tree_type nn-descent!" << endl;
+    if (CLI::GetParam<int>("nn_descent_trees") < 0 ||
+        CLI::GetParam<int>("nn_descent_iterations") < 0)
+      Log::Fatal << "--nn_descent_trees and --nn_descent_iterations must be 0 "
+          << "or greater." << endl;
+    if (CLI::HasParam("algorithm") || CLI::HasParam("epsilon") ||
+        CLI::HasParam("random_basis"))
+      Log::Warn << "--algorithm (-a), --epsilon (-e) and --random_basis (-R) "
+          << "are ignored with --tree_type nn-descent." << endl;
+  }
+
   // We either have to load the reference data, or we have to load the model.
+  // With --tree_type hnsw, the graph is used instead of the model, and with
+  // --tree_type nn-descent, only the reference set is kept.
   KNNModel knn;
+  std::unique_ptr<HNSWSearch<>> hnsw;
+  arma::mat nnDescentSet;
 
   const string algorithm = CLI::GetParam<string>("algorithm");
   NeighborSearchMode searchMode = DUAL_TREE_MODE;
@@ -245,7 +491,30 @@ int main(int argc, char *argv[])
       Log::Warn << "--single_mode ignored because --naive is present." << endl;
   }
 
-  if (CLI::HasParam("reference"))
+  if (useHNSW)
+  {
+    arma::mat referenceSet = std::move(CLI::GetParam<arma::mat>("reference"));
+
+    Log::Info << "Loaded reference data from '"
+        << CLI::GetUnmappedParam<arma::mat>("reference") << "' ("
+        << referenceSet.n_rows << " x " << referenceSet.n_cols << ")."
+        << endl;
+
+    hnsw.reset(new HNSWSearch<>(std::move(referenceSet),
+        (size_t) CLI::GetParam<int>("hnsw_m"),
+        (size_t) CLI::GetParam<int>("hnsw_ef_construction"),
+        (size_t) CLI::GetParam<int>("hnsw_ef")));
+  }
+  else if (useNNDescent)
+  {
+    nnDescentSet = std::move(CLI::GetParam<arma::mat>("reference"));
+
+    Log::Info << "Loaded reference data from '"
+        << CLI::GetUnmappedParam<arma::mat>("reference") << "' ("
+        << nnDescentSet.n_rows << " x " << nnDescentSet.n_cols << ")."
+        << endl;
+  }
+  else if (CLI::HasParam("reference"))
   {
     // Get all the parameters.
     const string treeType = CLI::GetParam<string>("tree_type");
@@ -288,12 +557,6 @@ int main(int argc, char *argv[])
           << "'ball', 'hilbert-r', 'r-plus', 'r-plus-plus', 'spill', and "
           << "'oct'." << endl;
 
-    knn.TreeType() = tree;
-    knn.RandomBasis() = randomBasis;
-    knn.LeafSize() = size_t(lsInt);
-    knn.Tau() = tau;
-    knn.Rho() = rho;
-
     arma::mat referenceSet = std::move(CLI::GetParam<arma::mat>("reference"));
 
     Log::Info << "Loaded reference data from '"
@@ -301,9 +564,43 @@ int main(int argc, char *argv[])
         << referenceSet.n_rows << " x " << referenceSet.n_cols << ")."
         << endl;
 
-    knn.BuildModel(std::move(referenceSet), size_t(lsInt), searchMode, epsilon);
+    size_t leafSize = size_t(lsInt);
+    double spillTau = tau;
+    if (autoTune)
+    {
+      SpillTreeTuner tuner(CLI::GetParam<double>("target_recall"),
+          (size_t) CLI::GetParam<int>("tune_sample_size"), rho);
+      try
+      {
+        tuner.Tune(referenceSet, CLI::HasParam("query") ?
+            CLI::GetParam<arma::mat>("query") : referenceSet,
+            (size_t) CLI::GetParam<int>("k"));
+      }
+      catch (std::exception& e)
+      {
+        Log::Fatal << e.what() << endl;
+      }
+
+      Log::Info << "Chose tau " << tuner.Tau() << " and leaf size "
+          << tuner.LeafSize() << " (recall " << tuner.Recall() << " on the "
+          << "tuning sample)." << endl;
+      leafSize = tuner.LeafSize();
+      spillTau = tuner.Tau();
+      if (!CLI::HasParam("algorithm"))
+        searchMode = SINGLE_TREE_MODE;
+    }
+
+    knn.TreeType() = tree;
+    knn.RandomBasis() = randomBasis;
+    knn.LeafSize() = leafSize;
+    knn.Tau() = spillTau;
+    knn.Rho() = rho;
+
+    knn.BuildModel(std::move(referenceSet), leafSize, searchMode, epsilon);
+    knn.BeamWidth() = size_t(beamWidth);
+    knn.BacktrackBudget() = size_t(backtrackBudget);
   }
-  else
+  else if (CLI::HasParam("input_model"))
   {
     // Load the model from file.
     knn = std::move(CLI::GetParam<KNNModel>("input_model"));
@@ -311,6 +608,8 @@ int main(int argc, char *argv[])
     // Adjust search mode.
     knn.SearchMode() = searchMode;
     knn.Epsilon() = epsilon;
+    knn.BeamWidth() = size_t(beamWidth);
+    knn.BacktrackBudget() = size_t(backtrackBudget);
 
     // If leaf_size wasn't provided, let's consider the current value in the
     // loaded model.  Else, update it (only considered when building the query
@@ -324,13 +623,57 @@ int main(int argc, char *argv[])
         << endl;
   }
 
+  // Answer searches from the standard input, if desired.
+  if (CLI::HasParam("serve"))
+  {
+    const size_t k = (size_t) CLI::GetParam<int>("k");
+    const arma::mat& referenceSet = hnsw ? hnsw->ReferenceSet() :
+        knn.Dataset();
+    if (k > referenceSet.n_cols)
+    {
+      Log::Fatal << "Invalid k: " << k << "; must be greater than 0 and "
+          << "less than or equal to the number of reference points ("
+          << referenceSet.n_cols << ")." << endl;
+    }
+
+    // The neighbors are kept between requests to reuse their memory.
+    arma::Mat<size_t> neighbors;
+    try
+    {
+      const size_t requests = util::ModelServer::ServeStandardStreams(
+          [&](arma::mat& request, vector<arma::mat>& response)
+          {
+            if (request.n_rows != referenceSet.n_rows)
+            {
+              ostringstream error;
+              error << "query dimensionality (" << request.n_rows << ") must "
+                  << "be the same as the reference dimensionality ("
+                  << referenceSet.n_rows << ")";
+              throw invalid_argument(error.str());
+            }
+
+            response.resize(2);
+            if (hnsw)
+              hnsw->Search(request, k, neighbors, response[1]);
+            else
+              knn.Search(std::move(request), k, neighbors, response[1]);
+            response[0] = arma::conv_to<arma::mat>::from(neighbors);
+          });
+      Log::Info << "Answered " << requests << " requests." << endl;
+    }
+    catch (std::exception& e)
+    {
+      Log::Fatal << e.what() << endl;
+    }
+  }
   // Perform search, if desired.
-  if (CLI::HasParam("k"))
+  else if (CLI::HasParam("k"))
   {
     const size_t k = (size_t) CLI::GetParam<int>("k");
 
+    // In distributed mode, only rank 0 needs the query set.
     arma::mat queryData;
-    if (CLI::HasParam("query"))
+    if (CLI::HasParam("query") && (!distributed || isRoot))
     {
       queryData = std::move(CLI::GetParam<arma::mat>("query"));
       Log::Info << "Loaded query data from '"
@@ -338,24 +681,96 @@ int main(int argc, char *argv[])
           << queryData.n_rows << "x" << queryData.n_cols << ")." << endl;
     }
 
-    // Sanity check on k value: must be greater than 0, must be less than the
-    // number of reference points.  Since it is unsigned, we only test the upper
-    // bound.
-    if (k > knn.Dataset().n_cols)
-    {
-      Log::Fatal << "Invalid k: " << k << "; must be greater than 0 and less ";
-      Log::Fatal << "than or equal to the number of reference points (";
-      Log::Fatal << knn.Dataset().n_cols << ")." << endl;
-    }
-
     // Now run the search.
     arma::Mat<size_t> neighbors;
     arma::mat distances;
 
-    if (CLI::HasParam("query"))
-      knn.Search(std::move(queryData), k, neighbors, distances);
+#ifdef HAS_MPI
+    if (distributed)
+    {
+      // Each rank loads its own chunk.
+      const string chunkFile =
+          CLI::GetParam<vector<string>>("reference_chunks")[rank];
+      arma::mat localReferenceSet;
+      if (!data::Load(chunkFile, localReferenceSet))
+        Log::Fatal << "Rank " << rank << " could not load reference chunk '"
+            << chunkFile << "'!" << endl;
+
+      try
+      {
+        DistributedKNN distributedKNN(std::move(localReferenceSet),
+            MPI_COMM_WORLD, searchMode, epsilon);
+        distributedKNN.Search(queryData, k, neighbors, distances);
+      }
+      catch (std::exception& e)
+      {
+        Log::Fatal << e.what() << endl;
+      }
+    }
     else
-      knn.Search(k, neighbors, distances);
+#endif
+    if (CLI::HasParam("reference_chunks"))
+    {
+      // The number of reference points is only known once every chunk has
+      // been loaded, so Search() checks k.
+      ChunkedKNN chunkedKNN(CLI::GetParam<vector<string>>("reference_chunks"),
+          searchMode, epsilon);
+      try
+      {
+        chunkedKNN.Search(queryData, k, neighbors, distances);
+      }
+      catch (std::exception& e)
+      {
+        Log::Fatal << e.what() << endl;
+      }
+    }
+    else if (useNNDescent)
+    {
+      // Search() checks k.
+      try
+      {
+        NNDescent<> nnDescent(
+            (size_t) CLI::GetParam<int>("nn_descent_trees"), size_t(lsInt),
+            (size_t) CLI::GetParam<int>("nn_descent_iterations"));
+        nnDescent.Search(nnDescentSet, k, neighbors, distances);
+      }
+      catch (std::exception& e)
+      {
+        Log::Fatal << e.what() << endl;
+      }
+    }
+    else if (hnsw)
+    {
+      // Search() checks k.
+      try
+      {
+        if (CLI::HasParam("query"))
+          hnsw->Search(queryData, k, neighbors, distances);
+        else
+          hnsw->Search(k, neighbors, distances);
+      }
+      catch (std::exception& e)
+      {
+        Log::Fatal << e.what() << endl;
+      }
+    }
+    else
+    {
+      // Sanity check on k value: must be greater than 0, must be less than the
+      // number of reference points.  Since it is unsigned, we only test the
+      // upper bound.
+      if (k > knn.Dataset().n_cols)
+      {
+        Log::Fatal << "Invalid k: " << k << "; must be greater than 0 and "
+            << "less than or equal to the number of reference points ("
+            << knn.Dataset().n_cols << ")." << endl;
+      }
+
+      if (CLI::HasParam("query"))
+        knn.Search(std::move(queryData), k, neighbors, distances);
+      else
+        knn.Search(k, neighbors, distances);
+    }
     Log::Info << "Search complete." << endl;
 
     // Save output, if desired.
@@ -365,9 +780,10 @@ int main(int argc, char *argv[])
       CLI::GetParam<arma::mat>("distances") = std::move(distances);
 
     // Calculate the effective error, if desired.
-    if (CLI::HasParam("true_distances"))
+    if (isRoot && CLI::HasParam("true_distances"))
     {
-      if (knn.TreeType() != KNNModel::SPILL_TREE && knn.Epsilon() == 0)
+      if (!hnsw && !useNNDescent &&
+          knn.TreeType() != KNNModel::SPILL_TREE && epsilon == 0)
         Log::Warn << "--true_distances_file (-D) specified, but the search is "
             << "exact, so there is no need to calculate the error!" << endl;
 
@@ -384,9 +800,10 @@ int main(int argc, char *argv[])
     }
 
     // Calculate the recall, if desired.
-    if (CLI::HasParam("true_neighbors"))
+    if (isRoot && CLI::HasParam("true_neighbors"))
     {
-      if (knn.TreeType() != KNNModel::SPILL_TREE && knn.Epsilon() == 0)
+      if (!hnsw && !useNNDescent &&
+          knn.TreeType() != KNNModel::SPILL_TREE && epsilon == 0)
         Log::Warn << "--true_neighbors_file (-T) specified, but the search is "
             << "exact, so there is no need to calculate the recall!" << endl;
 
@@ -405,5 +822,12 @@ int main(int argc, char *argv[])
   if (CLI::HasParam("output_model"))
     CLI::GetParam<KNNModel>("output_model") = std::move(knn);
 
-  CLI::Destroy();
+  // Output files are written by CLI::Destroy(), so other ranks must not call
+  // it.
+  if (isRoot)
+    CLI::Destroy();
+
+#ifdef HAS_MPI
+  MPI_Finalize();
+#endif
 }
@@ -20,6 +20,9 @@
 #include <mlpack/core/tree/binary_space_tree.hpp>
 #include <mlpack/core/tree/rectangle_tree.hpp>
 #include <mlpack/core/tree/binary_space_tree/binary_space_tree.hpp>
+#include <mlpack/core/tree/independent_subtrees.hpp>
+#include <mlpack/core/tree/traversal_statistics.hpp>
+#include <mlpack/core/tree/greedy_single_tree_traverser.hpp>
 
 #include "neighbor_search_stat.hpp"
 #include "sort_policies/nearest_neighbor_sort.hpp"
@@ -57,6 +60,12 @@ enum NeighborSearchMode
  * can be found in the NearestNeighborSort class and the kernel::ExampleKernel
  * class.
  *
+ * The reference tree can be updated between searches through ReferenceTree()
+ * (for instance with BinarySpaceTree::InsertPoint() and DeletePoint(), giving
+ * them OldFromNewReferences() if it isn't empty), without training again.  An
+ * updated BinarySpaceTree may leave free columns in the reference set, which
+ * hold no points; the searches only use the points of the tree.
+ *
  * @tparam SortPolicy The sort policy for distances; see NearestNeighborSort.
  * @tparam MetricType The metric to use for computation.
  * @tparam MatType The type of data matrix.
@@ -334,6 +343,10 @@ class NeighborSearch
    * where n is the number of points in the query dataset and k is the number of
    * neighbors being searched for.
    *
+   * If the reference tree has free columns (see the class documentation), n is
+   * the number of points of the tree, and column i of the results holds the
+   * neighbors of the point ReferenceTree().Descendant(i).
+   *
    * @param k Number of neighbors to search for.
    * @param neighbors Matrix storing lists of neighbors for each query point.
    * @param distances Matrix storing distances of neighbors for each query
@@ -382,6 +395,10 @@ class NeighborSearch
   //! Return the number of node combination scores during the last search.
   size_t Scores() const { return scores; }
 
+  //! Return the statistics of the traversal (base cases, scores, prunes and
+  //! times) of the last search.
+  const tree::TraversalStatistics& Statistics() const { return statistics; }
+
   //! Access the search mode.
   NeighborSearchMode SearchMode() const { return searchMode; }
   //! Modify the search mode.
@@ -392,6 +409,19 @@ class NeighborSearch
   //! Modify the relative error to be considered in approximate search.
   double& Epsilon() { return epsilon; }
 
+  //! Access the number of nodes kept at each level by greedy search.
+  size_t BeamWidth() const { return beamWidth; }
+  //! Modify the number of nodes kept at each level by greedy search (at least
+  //! 1).
+  size_t& BeamWidth() { return beamWidth; }
+
+  //! Access the number of base cases greedy search may spend on backtracking
+  //! for each query point.
+  size_t BacktrackBudget() const { return backtrackBudget; }
+  //! Modify the number of base cases greedy search may spend on backtracking
+  //! for each query point.
+  size_t& BacktrackBudget() { return backtrackBudget; }
+
   //! Access the reference dataset.
   const MatType& ReferenceSet() const { return *referenceSet; }
 
@@ -400,6 +430,14 @@ class NeighborSearch
   //! Modify the reference tree.
   Tree& ReferenceTree() { return *referenceTree; }
 
+  //! Access the mapping from the indices of the reference tree's dataset to
+  //! the indices of the original reference set (empty if there is no mapping).
+  const std::vector<size_t>& OldFromNewReferences() const
+  { return oldFromNewReferences; }
+  //! Modify the mapping from the indices of the reference tree's dataset to
+  //! the indices of the original reference set.
+  std::vector<size_t>& OldFromNewReferences() { return oldFromNewReferences; }
+
   //! Serialize the NeighborSearch model.
   template<typename Archive>
   void Serialize(Archive& ar, const unsigned int /* version */);
@@ -421,6 +459,10 @@ class NeighborSearch
   NeighborSearchMode searchMode;
   //! Indicates the relative error to be considered in approximate search.
   double epsilon;
+  //! The number of nodes kept at each level by greedy search.
+  size_t beamWidth;
+  //! The number of base cases greedy search may spend on backtracking.
+  size_t backtrackBudget;
 
   //! Instantiation of metric.
   MetricType metric;
@@ -429,11 +471,157 @@ class NeighborSearch
   size_t baseCases;
   //! The total number of scores (applicable for non-naive search).
   size_t scores;
+  //! The statistics of the last search.
+  tree::TraversalStatistics statistics;
 
   //! If this is true, the reference tree bounds need to be reset on a call to
   //! Search() without a query set.
   bool treeNeedsReset;
 
+  //! Candidate lists for each query point.  These are held between searches so
+  //! that their memory can be reused.
+  std::vector<typename NeighborSearchRules<SortPolicy, MetricType,
+      Tree>::CandidateList> candidateLists;
+
+  /**
+   * Perform a single-tree traversal of the reference tree for each of the
+   * given number of query points.  If OpenMP is available and parallelSafe is
+   * true, the query points are split between threads, and each thread holds
+   * its own rules object and traverser.  The number of scores and base cases
+   * performed by all threads is added to the given rules object.
+   *
+   * @param numQueries Number of query points.
+   * @param rules Rules object holding the candidate lists for all query points.
+   * @param parallelSafe Whether or not the traversal may be run in parallel.
+   * @param queryIndices If given, the indices of the query points in the query
+   *     set (otherwise the query points are the first numQueries points).
+   */
+  template<typename TraversalType, typename RuleType>
+  void SingleTreeTraverse(const size_t numQueries,
+                          RuleType& rules,
+                          const bool parallelSafe,
+                          const std::vector<size_t>* queryIndices = NULL);
+
+  /**
+   * Return the number of reference points.  This is the number of points of
+   * the reference tree, which may be less than the number of columns of the
+   * reference set once the tree has been updated.
+   */
+  size_t NumReferencePoints() const
+  {
+    return referenceTree ? referenceTree->NumDescendants() :
+        referenceSet->n_cols;
+  }
+
+  /**
+   * Get the indices of the reference points in the reference set, in the order
+   * of the reference tree; the columns left out are free columns of an updated
+   * tree.
+   *
+   * @param referencePoints Vector to store the indices in.
+   */
+  void ReferencePoints(std::vector<size_t>& referencePoints) const;
+
+  //! Give the beam width and the backtracking budget to a greedy traverser.
+  template<typename RuleType>
+  void ConfigureTraverser(
+      tree::GreedySingleTreeTraverser<Tree, RuleType>& traverser) const
+  {
+    traverser.BeamWidth() = beamWidth;
+    traverser.BacktrackBudget() = backtrackBudget;
+  }
+
+  //! Other traversers have nothing to configure.
+  template<typename TraversalType>
+  void ConfigureTraverser(TraversalType& /* traverser */) const { }
+
+  /**
+   * Return whether or not greedy single-tree traversals can be run in
+   * parallel.  Following only the best child never modifies the reference
+   * tree, but a beam or backtracking calls Score(), which does for some trees.
+   */
+  bool GreedyParallelSafe() const
+  {
+    return (beamWidth <= 1 && backtrackBudget == 0) ||
+        SingleTreeParallelSafe();
+  }
+
+  /**
+   * Return whether or not single-tree traversals can be run in parallel.  For
+   * trees where the first point of a node is the centroid and the tree has
+   * self-children (like the cover tree), NeighborSearchRules::Score() caches
+   * base cases in the statistics of reference nodes, so the reference tree is
+   * modified during the traversal and it is not safe to run in parallel.
+   */
+  static constexpr bool SingleTreeParallelSafe()
+  {
+    return !(tree::TreeTraits<Tree>::FirstPointIsCentroid &&
+             tree::TreeTraits<Tree>::HasSelfChildren);
+  }
+
+  /**
+   * Perform a dual-tree traversal of the given query tree and the reference
+   * tree with the given rules.  If OpenMP is available and more than one
+   * thread may be used, the query tree is split into subtrees with disjoint
+   * sets of points, and each of those is traversed against the reference tree
+   * in parallel.  The number of scores and base cases performed by all threads
+   * is added to the given rules object.
+   *
+   * @param queryTree Tree built on query points.
+   * @param rules Rules object holding the candidate lists for all query points.
+   */
+  template<typename RuleType>
+  void DualTreeTraverse(Tree& queryTree, RuleType& rules);
+
+  /**
+   * Return whether or not naive search uses BlockedNaiveSearch(), which is the
+   * case for dense matrices with the (squared) Euclidean distance.
+   */
+  static constexpr bool BlockedNaiveSearchAvailable()
+  {
+    return std::is_same<MatType, arma::mat>::value &&
+        (std::is_same<MetricType, metric::LMetric<2, true>>::value ||
+         std::is_same<MetricType, metric::LMetric<2, false>>::value);
+  }
+
+  /**
+   * Find the k neighbors of each query point by brute force, without the
+   * rules.  The squared distances between a block of QueryBlockSize query
+   * points and a block of ReferenceBlockSize reference points are computed with
+   * one matrix product and the cached squared norms of the points, and the
+   * candidates of each query point are kept in a sorted array that is only
+   * updated by the (few) distances better than its worst candidate.  The blocks
+   * of query points are handled in parallel.  The distances to the k neighbors
+   * found are computed again with the metric at the end, so they are exact.
+   *
+   * @param querySet Set of query points.
+   * @param k Number of neighbors to search for.
+   * @param neighbors Matrix storing lists of neighbors for each query point.
+   * @param distances Matrix storing distances of neighbors for each query
+   *     point.
+   * @param sameSet If true, the query set is the reference set, and each point
+   *     is not returned as its own neighbor.
+   */
+  void BlockedNaiveSearch(const MatType& querySet,
+                          const size_t k,
+                          arma::Mat<size_t>& neighbors,
+                          arma::mat& distances,
+                          const bool sameSet,
+                          std::true_type /* available */);
+
+  //! BlockedNaiveSearch() is not available for this metric or matrix type.
+  void BlockedNaiveSearch(const MatType& /* querySet */,
+                          const size_t /* k */,
+                          arma::Mat<size_t>& /* neighbors */,
+                          arma::mat& /* distances */,
+                          const bool /* sameSet */,
+                          std::false_type /* available */) { }
+
+  //! The number of query points handled together by BlockedNaiveSearch().
+  static const size_t QueryBlockSize = 256;
+  //! The number of reference points handled together by BlockedNaiveSearch().
+  static const size_t ReferenceBlockSize = 512;
+
   //! The NSModel class should have access to internal members.
   template<typename SortPol>
   friend class TrainVisitor;
@@ -14,6 +14,7 @@
 #define MLPACK_METHODS_NEIGHBOR_SEARCH_NEIGHBOR_SEARCH_IMPL_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <mlpack/core/util/numa.hpp>
 #include <mlpack/core/tree/greedy_single_tree_traverser.hpp>
 #include "neighbor_search_rules.hpp"
 #include <mlpack/core/tree/spill_tree/is_spill_tree.hpp>
@@ -30,6 +31,7 @@ TreeType* BuildTree(
         tree::TreeTraits<TreeType>::RearrangesDataset, TreeType
     >* = 0)
 {
+  MLPACK_PROFILE_SCOPE("tree_building");
   return new TreeType(std::forward<MatType>(dataset), oldFromNew);
 }
 
@@ -42,6 +44,7 @@ TreeType* BuildTree(
         !tree::TreeTraits<TreeType>::RearrangesDataset, TreeType
     >* = 0)
 {
+  MLPACK_PROFILE_SCOPE("tree_building");
   return new TreeType(std::forward<MatType>(dataset));
 }
 
@@ -67,6 +70,8 @@ SingleTreeTraversalType>::NeighborSearch(const MatType& referenceSetIn,
     setOwner(false),
     searchMode(mode),
     epsilon(epsilon),
+    beamWidth(1),
+    backtrackBudget(0),
     metric(metric),
     baseCases(0),
     scores(0),
@@ -98,6 +103,8 @@ SingleTreeTraversalType>::NeighborSearch(MatType&& referenceSetIn,
     setOwner(mode == NAIVE_MODE),
     searchMode(mode),
     epsilon(epsilon),
+    beamWidth(1),
+    backtrackBudget(0),
     metric(metric),
     baseCases(0),
     scores(0),
@@ -127,6 +134,8 @@ SingleTreeTraversalType>::NeighborSearch(const Tree& referenceTree,
     setOwner(false),
     searchMode(mode),
     epsilon(epsilon),
+    beamWidth(1),
+    backtrackBudget(0),
     metric(metric),
     baseCases(0),
     scores(0),
@@ -156,6 +165,8 @@ SingleTreeTraversalType>::NeighborSearch(Tree&& referenceTree,
     setOwner(false),
     searchMode(mode),
     epsilon(epsilon),
+    beamWidth(1),
+    backtrackBudget(0),
     metric(metric),
     baseCases(0),
     scores(0),
@@ -184,6 +195,8 @@ SingleTreeTraversalType>::NeighborSearch(const NeighborSearchMode mode,
     setOwner(true),
     searchMode(mode),
     epsilon(epsilon),
+    beamWidth(1),
+    backtrackBudget(0),
     metric(metric),
     baseCases(0),
     scores(0),
@@ -219,6 +232,8 @@ SingleTreeTraversalType>::NeighborSearch(const NeighborSearch& other) :
     setOwner(!other.referenceTree),
     searchMode(other.searchMode),
     epsilon(other.epsilon),
+    beamWidth(other.beamWidth),
+    backtrackBudget(other.backtrackBudget),
     metric(other.metric),
     baseCases(other.baseCases),
     scores(other.scores),
@@ -245,6 +260,8 @@ SingleTreeTraversalType>::NeighborSearch(NeighborSearch&& other) :
     setOwner(other.setOwner),
     searchMode(other.searchMode),
     epsilon(other.epsilon),
+    beamWidth(other.beamWidth),
+    backtrackBudget(other.backtrackBudget),
     metric(std::move(other.metric)),
     baseCases(other.baseCases),
     scores(other.scores),
@@ -258,6 +275,8 @@ SingleTreeTraversalType>::NeighborSearch(NeighborSearch&& other) :
   other.setOwner = true;
   other.searchMode = DUAL_TREE_MODE,
   other.epsilon = 0.0;
+  other.beamWidth = 1;
+  other.backtrackBudget = 0;
   other.baseCases = 0;
   other.scores = 0;
   other.treeNeedsReset = false;
@@ -299,6 +318,8 @@ NeighborSearch<SortPolicy,
   setOwner = (other.referenceTree == NULL);
   searchMode = other.searchMode;
   epsilon = other.epsilon;
+  beamWidth = other.beamWidth;
+  backtrackBudget = other.backtrackBudget;
   metric = other.metric;
   baseCases = other.baseCases;
   scores = other.scores;
@@ -340,6 +361,8 @@ NeighborSearch<SortPolicy,
   setOwner = other.setOwner;
   searchMode = other.searchMode;
   epsilon = other.epsilon;
+  beamWidth = other.beamWidth;
+  backtrackBudget = other.backtrackBudget;
   metric = other.metric;
   baseCases = other.baseCases;
   scores = other.scores;
@@ -353,6 +376,8 @@ NeighborSearch<SortPolicy,
   other.setOwner = true;
   other.searchMode = DUAL_TREE_MODE,
   other.epsilon = 0.0;
+  other.beamWidth = 1;
+  other.backtrackBudget = 0;
   other.baseCases = 0;
   other.scores = 0;
   other.treeNeedsReset = false;
@@ -403,6 +428,7 @@ DualTreeTraversalType, SingleTreeTraversalType>::Train(
   }
   else
   {
+    referenceTree = NULL;
     treeOwner = false;
   }
 
@@ -444,6 +470,7 @@ DualTreeTraversalType, SingleTreeTraversalType>::Train(MatType&& referenceSetIn)
   }
   else
   {
+    referenceTree = NULL;
     treeOwner = false;
   }
 
@@ -543,11 +570,12 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
     arma::Mat<size_t>& neighbors,
     arma::mat& distances)
 {
-  if (k > referenceSet->n_cols)
+  const size_t numReferences = NumReferencePoints();
+  if (k > numReferences)
   {
     std::stringstream ss;
     ss << "requested value of k (" << k << ") is greater than the number of "
-        << "points in the reference set (" << referenceSet->n_cols << ")";
+        << "points in the reference set (" << numReferences << ")";
     throw std::invalid_argument(ss.str());
   }
 
@@ -555,6 +583,7 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
 
   baseCases = 0;
   scores = 0;
+  statistics.Reset();
 
   // This will hold mappings for query points, if necessary.
   std::vector<size_t> oldFromNewQueries;
@@ -588,15 +617,37 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
   {
     case NAIVE_MODE:
     {
+      tree::TraversalStatistics::PhaseTimer timer(statistics.TraversalTime());
+      baseCases += querySet.n_cols * numReferences;
+
+      // The free columns of an updated reference tree hold no points.
+      const bool freeColumns = (numReferences != referenceSet->n_cols);
+      if (BlockedNaiveSearchAvailable() && !freeColumns)
+      {
+        BlockedNaiveSearch(querySet, k, *neighborPtr, *distancePtr, false,
+            std::integral_constant<bool, BlockedNaiveSearchAvailable()>());
+        break;
+      }
+
       // Create the helper object for the tree traversal.
-      RuleType rules(*referenceSet, querySet, k, metric, epsilon);
+      RuleType rules(*referenceSet, querySet, k, metric, candidateLists,
+          epsilon);
 
       // The naive brute-force traversal.
-      for (size_t i = 0; i < querySet.n_cols; ++i)
-        for (size_t j = 0; j < referenceSet->n_cols; ++j)
-          rules.BaseCase(i, j);
-
-      baseCases += querySet.n_cols * referenceSet->n_cols;
+      if (freeColumns)
+      {
+        std::vector<size_t> referencePoints;
+        ReferencePoints(referencePoints);
+        for (size_t i = 0; i < querySet.n_cols; ++i)
+          for (size_t j = 0; j < numReferences; ++j)
+            rules.BaseCase(i, referencePoints[j]);
+      }
+      else
+      {
+        for (size_t i = 0; i < querySet.n_cols; ++i)
+          for (size_t j = 0; j < referenceSet->n_cols; ++j)
+            rules.BaseCase(i, j);
+      }
 
       rules.GetResults(*neighborPtr, *distancePtr);
       break;
@@ -604,14 +655,12 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
     case SINGLE_TREE_MODE:
     {
       // Create the helper object for the tree traversal.
-      RuleType rules(*referenceSet, querySet, k, metric, epsilon);
+      RuleType rules(*referenceSet, querySet, k, metric, candidateLists,
+          epsilon);
 
-      // Create the traverser.
-      SingleTreeTraversalType<RuleType> traverser(rules);
-
-      // Now have it traverse for each point.
-      for (size_t i = 0; i < querySet.n_cols; ++i)
-        traverser.Traverse(i, *referenceTree);
+      // Traverse for each point.
+      SingleTreeTraverse<SingleTreeTraversalType<RuleType>>(querySet.n_cols,
+          rules, SingleTreeParallelSafe());
 
       scores += rules.Scores();
       baseCases += rules.BaseCases();
@@ -629,17 +678,20 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
       // Build the query tree.
       Timer::Stop("computing_neighbors");
       Timer::Start("tree_building");
-      Tree* queryTree = BuildTree<Tree>(querySet, oldFromNewQueries);
+      Tree* queryTree;
+      {
+        tree::TraversalStatistics::PhaseTimer timer(
+            statistics.TreeBuildingTime());
+        queryTree = BuildTree<Tree>(querySet, oldFromNewQueries);
+      }
       Timer::Stop("tree_building");
       Timer::Start("computing_neighbors");
 
       // Create the helper object for the tree traversal.
-      RuleType rules(*referenceSet, queryTree->Dataset(), k, metric, epsilon);
+      RuleType rules(*referenceSet, queryTree->Dataset(), k, metric,
+          candidateLists, epsilon);
 
-      // Create the traverser.
-      DualTreeTraversalType<RuleType> traverser(rules);
-
-      traverser.Traverse(*queryTree, *referenceTree);
+      DualTreeTraverse(*queryTree, rules);
 
       scores += rules.Scores();
       baseCases += rules.BaseCases();
@@ -657,14 +709,11 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
     case GREEDY_SINGLE_TREE_MODE:
     {
       // Create the helper object for the tree traversal.
-      RuleType rules(*referenceSet, querySet, k, metric);
-
-      // Create the traverser.
-      tree::GreedySingleTreeTraverser<Tree, RuleType> traverser(rules);
+      RuleType rules(*referenceSet, querySet, k, metric, candidateLists);
 
-      // Now have it traverse for each point.
-      for (size_t i = 0; i < querySet.n_cols; ++i)
-        traverser.Traverse(i, *referenceTree);
+      // Traverse for each point.
+      SingleTreeTraverse<tree::GreedySingleTreeTraverser<Tree, RuleType>>(
+          querySet.n_cols, rules, GreedyParallelSafe());
 
       scores += rules.Scores();
       baseCases += rules.BaseCases();
@@ -679,6 +728,8 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
     }
   }
 
+  statistics.BaseCases() = baseCases;
+  statistics.Scores() = scores;
   Timer::Stop("computing_neighbors");
 
   // Map points back to original indices, if necessary.
@@ -757,11 +808,12 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
     arma::mat& distances,
     bool sameSet)
 {
-  if (k > referenceSet->n_cols)
+  const size_t numReferences = NumReferencePoints();
+  if (k > numReferences)
   {
     std::stringstream ss;
     ss << "requested value of k (" << k << ") is greater than the number of "
-        << "points in the reference set (" << referenceSet->n_cols << ")";
+        << "points in the reference set (" << numReferences << ")";
     throw std::invalid_argument(ss.str());
   }
 
@@ -774,6 +826,7 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
 
   baseCases = 0;
   scores = 0;
+  statistics.Reset();
 
   // Get a reference to the query set.
   const MatType& querySet = queryTree.Dataset();
@@ -790,11 +843,10 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
 
   // Create the helper object for the traversal.
   typedef NeighborSearchRules<SortPolicy, MetricType, Tree> RuleType;
-  RuleType rules(*referenceSet, querySet, k, metric, epsilon, sameSet);
+  RuleType rules(*referenceSet, querySet, k, metric, candidateLists, epsilon,
+      sameSet);
 
-  // Create the traverser.
-  DualTreeTraversalType<RuleType> traverser(rules);
-  traverser.Traverse(queryTree, *referenceTree);
+  DualTreeTraverse(queryTree, rules);
 
   scores += rules.Scores();
   baseCases += rules.BaseCases();
@@ -807,6 +859,8 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
   Log::Info << rules.Scores() << " node combinations were scored.\n";
   Log::Info << rules.BaseCases() << " base cases were calculated.\n";
 
+  statistics.BaseCases() = baseCases;
+  statistics.Scores() = scores;
   Timer::Stop("computing_neighbors");
 
   // Do we need to map indices?
@@ -840,11 +894,12 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
     arma::Mat<size_t>& neighbors,
     arma::mat& distances)
 {
-  if (k > referenceSet->n_cols)
+  const size_t numReferences = NumReferencePoints();
+  if (k > numReferences)
   {
     std::stringstream ss;
     ss << "requested value of k (" << k << ") is greater than the number of "
-        << "points in the reference set (" << referenceSet->n_cols << ")";
+        << "points in the reference set (" << numReferences << ")";
     throw std::invalid_argument(ss.str());
   }
 
@@ -852,12 +907,22 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
 
   baseCases = 0;
   scores = 0;
+  statistics.Reset();
+
+  // If the reference tree has been updated, the reference set may have free
+  // columns, which hold no points; then only the points of the tree are
+  // queried, and their results are gathered in the order of the tree.
+  const bool freeColumns = (numReferences != referenceSet->n_cols);
+  std::vector<size_t> referencePoints;
+  if (freeColumns)
+    ReferencePoints(referencePoints);
 
   arma::Mat<size_t>* neighborPtr = &neighbors;
   arma::mat* distancePtr = &distances;
 
-  if (!oldFromNewReferences.empty() &&
-      tree::TreeTraits<Tree>::RearrangesDataset)
+  const bool mapReferences = !oldFromNewReferences.empty() &&
+      tree::TreeTraits<Tree>::RearrangesDataset;
+  if (mapReferences || freeColumns)
   {
     // We will always need to rearrange in this case.
     distancePtr = new arma::mat;
@@ -870,29 +935,44 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
 
   // Create the helper object for the traversal.
   typedef NeighborSearchRules<SortPolicy, MetricType, Tree> RuleType;
-  RuleType rules(*referenceSet, *referenceSet, k, metric, epsilon,
-      true /* don't return the same point as nearest neighbor */);
+  RuleType rules(*referenceSet, *referenceSet, k, metric, candidateLists,
+      epsilon, true /* don't return the same point as nearest neighbor */);
 
   switch (searchMode)
   {
     case NAIVE_MODE:
     {
-      // The naive brute-force solution.
-      for (size_t i = 0; i < referenceSet->n_cols; ++i)
-        for (size_t j = 0; j < referenceSet->n_cols; ++j)
-          rules.BaseCase(i, j);
+      tree::TraversalStatistics::PhaseTimer timer(statistics.TraversalTime());
+      baseCases += numReferences * numReferences;
 
-      baseCases += referenceSet->n_cols * referenceSet->n_cols;
+      if (BlockedNaiveSearchAvailable() && !freeColumns)
+      {
+        BlockedNaiveSearch(*referenceSet, k, *neighborPtr, *distancePtr, true,
+            std::integral_constant<bool, BlockedNaiveSearchAvailable()>());
+        break;
+      }
+
+      // The naive brute-force solution.
+      if (freeColumns)
+      {
+        for (size_t i = 0; i < numReferences; ++i)
+          for (size_t j = 0; j < numReferences; ++j)
+            rules.BaseCase(referencePoints[i], referencePoints[j]);
+      }
+      else
+      {
+        for (size_t i = 0; i < referenceSet->n_cols; ++i)
+          for (size_t j = 0; j < referenceSet->n_cols; ++j)
+            rules.BaseCase(i, j);
+      }
       break;
     }
     case SINGLE_TREE_MODE:
     {
-      // Create the traverser.
-      SingleTreeTraversalType<RuleType> traverser(rules);
-
-      // Now have it traverse for each point.
-      for (size_t i = 0; i < referenceSet->n_cols; ++i)
-        traverser.Traverse(i, *referenceTree);
+      // Traverse for each point.
+      SingleTreeTraverse<SingleTreeTraversalType<RuleType>>(numReferences,
+          rules, SingleTreeParallelSafe(),
+          freeColumns ? &referencePoints : NULL);
 
       scores += rules.Scores();
       baseCases += rules.BaseCases();
@@ -925,19 +1005,16 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
         }
       }
 
-      // Create the traverser.
-      DualTreeTraversalType<RuleType> traverser(rules);
-
       if (tree::IsSpillTree<Tree>::value)
       {
         // For Dual Tree Search on SpillTree, the queryTree must be built with
         // non overlapping (tau = 0).
         Tree queryTree(*referenceSet);
-        traverser.Traverse(queryTree, *referenceTree);
+        DualTreeTraverse(queryTree, rules);
       }
       else
       {
-        traverser.Traverse(*referenceTree, *referenceTree);
+        DualTreeTraverse(*referenceTree, rules);
         // Next time we perform this search, we'll need to reset the tree.
         treeNeedsReset = true;
       }
@@ -956,12 +1033,10 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
     }
     case GREEDY_SINGLE_TREE_MODE:
     {
-      // Create the traverser.
-      tree::GreedySingleTreeTraverser<Tree, RuleType> traverser(rules);
-
-      // Now have it traverse for each point.
-      for (size_t i = 0; i < referenceSet->n_cols; ++i)
-        traverser.Traverse(i, *referenceTree);
+      // Traverse for each point.
+      SingleTreeTraverse<tree::GreedySingleTreeTraverser<Tree, RuleType>>(
+          numReferences, rules, GreedyParallelSafe(),
+          freeColumns ? &referencePoints : NULL);
 
       scores += rules.Scores();
       baseCases += rules.BaseCases();
@@ -974,13 +1049,39 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
     }
   }
 
-  rules.GetResults(*neighborPtr, *distancePtr);
+  // BlockedNaiveSearch() gives the results directly.
+  if (searchMode != NAIVE_MODE || !BlockedNaiveSearchAvailable() ||
+      freeColumns)
+    rules.GetResults(*neighborPtr, *distancePtr);
 
+  statistics.BaseCases() = baseCases;
+  statistics.Scores() = scores;
   Timer::Stop("computing_neighbors");
 
-  // Do we need to map the reference indices?
-  if (!oldFromNewReferences.empty() &&
-      tree::TreeTraits<Tree>::RearrangesDataset)
+  if (freeColumns)
+  {
+    // Gather the results of the points of the tree, mapping the indices of the
+    // neighbors if necessary.
+    neighbors.set_size(k, numReferences);
+    distances.set_size(k, numReferences);
+
+    for (size_t i = 0; i < numReferences; ++i)
+    {
+      const size_t column = referencePoints[i];
+      distances.col(i) = distancePtr->col(column);
+      for (size_t j = 0; j < distances.n_rows; ++j)
+      {
+        const size_t neighbor = (*neighborPtr)(j, column);
+        neighbors(j, i) = mapReferences ? oldFromNewReferences[neighbor] :
+            neighbor;
+      }
+    }
+
+    // Finished with temporary matrices.
+    delete neighborPtr;
+    delete distancePtr;
+  }
+  else if (mapReferences)
   {
     neighbors.set_size(k, referenceSet->n_cols);
     distances.set_size(k, referenceSet->n_cols);
@@ -1002,6 +1103,310 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
   }
 }
 
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+template<typename TraversalType, typename RuleType>
+void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
+DualTreeTraversalType, SingleTreeTraversalType>::SingleTreeTraverse(
+    const size_t numQueries,
+    RuleType& rules,
+    const bool parallelSafe,
+    const std::vector<size_t>* queryIndices)
+{
+  tree::TraversalStatistics::PhaseTimer timer(statistics.TraversalTime());
+
+#ifdef HAS_OPENMP
+  if (parallelSafe && omp_get_max_threads() > 1 && numQueries > 1)
+  {
+    size_t totalScores = 0;
+    size_t totalBaseCases = 0;
+    size_t totalPrunes = 0;
+
+    // The query points are handed out dynamically, or in contiguous ranges
+    // when NUMA placement is enabled (see NUMA).
+    NUMA::LoopSchedule schedule(16);
+
+    #pragma omp parallel reduction(+:totalScores, totalBaseCases, totalPrunes)
+    {
+      // Each thread holds one rules object and one traverser for all of the
+      // query points it handles.  The candidate lists are shared, but each
+      // query point is only handled by one thread.
+      MLPACK_PROFILE_SCOPE("computing_neighbors");
+      NUMA::PinThread();
+      RuleType threadRules(rules, typename RuleType::ShareCandidates());
+      TraversalType traverser(threadRules);
+      ConfigureTraverser(traverser);
+
+#ifdef _WIN32
+      // Tiny workaround: Visual Studio only implements OpenMP 2.0, which
+      // doesn't support unsigned loop variables. If we're building for Visual
+      // Studio, use the intmax_t type instead.
+      #pragma omp for schedule(runtime)
+      for (intmax_t i = 0; i < (intmax_t) numQueries; ++i)
+#else
+      #pragma omp for schedule(runtime)
+      for (size_t i = 0; i < numQueries; ++i)
+#endif
+      {
+        traverser.Traverse(queryIndices ? (*queryIndices)[i] : i,
+            *referenceTree);
+      }
+
+      totalScores += threadRules.Scores();
+      totalBaseCases += threadRules.BaseCases();
+      totalPrunes += traverser.NumPrunes();
+    }
+
+    rules.Scores() += totalScores;
+    rules.BaseCases() += totalBaseCases;
+    statistics.Prunes() += totalPrunes;
+    return;
+  }
+#else
+  (void) parallelSafe;
+#endif
+
+  MLPACK_PROFILE_SCOPE("computing_neighbors");
+  TraversalType traverser(rules);
+  ConfigureTraverser(traverser);
+  for (size_t i = 0; i < numQueries; ++i)
+    traverser.Traverse(queryIndices ? (*queryIndices)[i] : i, *referenceTree);
+  statistics.AddTraverser(traverser);
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
+DualTreeTraversalType, SingleTreeTraversalType>::ReferencePoints(
+    std::vector<size_t>& referencePoints) const
+{
+  referencePoints.resize(NumReferencePoints());
+  for (size_t i = 0; i < referencePoints.size(); ++i)
+    referencePoints[i] = referenceTree ? referenceTree->Descendant(i) : i;
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
+DualTreeTraversalType, SingleTreeTraversalType>::BlockedNaiveSearch(
+    const MatType& querySet,
+    const size_t k,
+    arma::Mat<size_t>& neighbors,
+    arma::mat& distances,
+    const bool sameSet,
+    std::true_type /* available */)
+{
+  MLPACK_PROFILE_SCOPE("computing_neighbors");
+  if (k == 0)
+    return;
+
+  const arma::mat& references = *referenceSet;
+  const arma::rowvec referenceNorms = arma::sum(arma::square(references), 0);
+  const arma::rowvec queryNorms = sameSet ? referenceNorms :
+      arma::rowvec(arma::sum(arma::square(querySet), 0));
+
+  const size_t numBlocks = (querySet.n_cols + QueryBlockSize - 1) /
+      QueryBlockSize;
+
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables. If we're building for Visual Studio, use
+  // the intmax_t type instead.
+  #pragma omp parallel for schedule(dynamic)
+  for (intmax_t b = 0; b < (intmax_t) numBlocks; ++b)
+#else
+  #pragma omp parallel for schedule(dynamic)
+  for (size_t b = 0; b < numBlocks; ++b)
+#endif
+  {
+    const size_t begin = b * QueryBlockSize;
+    const size_t end = std::min(begin + QueryBlockSize,
+        (size_t) querySet.n_cols);
+    const arma::mat queries(const_cast<double*>(querySet.colptr(begin)),
+        querySet.n_rows, end - begin, false, true);
+
+    // The candidates of each query point, best first; the distances are the
+    // squared distances computed from the norms.
+    arma::mat candidateDistances(k, queries.n_cols);
+    candidateDistances.fill(SortPolicy::WorstDistance());
+    arma::Mat<size_t> candidates(k, queries.n_cols);
+    candidates.fill(size_t() - 1);
+
+    arma::mat block;
+    for (size_t refBegin = 0; refBegin < references.n_cols;
+        refBegin += ReferenceBlockSize)
+    {
+      const size_t refEnd = std::min(refBegin + ReferenceBlockSize,
+          (size_t) references.n_cols);
+      const arma::mat referenceBlock(const_cast<double*>(
+          references.colptr(refBegin)), references.n_rows, refEnd - refBegin,
+          false, true);
+
+      // Each column holds the squared distances of one query point to the
+      // reference points of the block.
+      block = -2.0 * referenceBlock.t() * queries;
+      block.each_col() += referenceNorms.subvec(refBegin, refEnd - 1).t();
+      block.each_row() += queryNorms.subvec(begin, end - 1);
+
+      for (size_t q = 0; q < queries.n_cols; ++q)
+      {
+        const double* blockDistances = block.colptr(q);
+        double* bestDistances = candidateDistances.colptr(q);
+        size_t* bestIndices = candidates.colptr(q);
+        for (size_t r = 0; r < block.n_rows; ++r)
+        {
+          // Rounding may make the distance of close points slightly negative.
+          const double distance = std::max(blockDistances[r], 0.0);
+          if (!SortPolicy::IsBetter(distance, bestDistances[k - 1]) ||
+              (sameSet && refBegin + r == begin + q))
+            continue;
+
+          // Insert the candidate after the candidates that are as good.
+          size_t pos = k - 1;
+          while (pos > 0 && distance != bestDistances[pos - 1] &&
+              SortPolicy::IsBetter(distance, bestDistances[pos - 1]))
+          {
+            bestDistances[pos] = bestDistances[pos - 1];
+            bestIndices[pos] = bestIndices[pos - 1];
+            --pos;
+          }
+          bestDistances[pos] = distance;
+          bestIndices[pos] = refBegin + r;
+        }
+      }
+    }
+
+    // Compute the distances to the neighbors with the metric, and sort them
+    // again, since the squared distances computed from the norms may have a
+    // small error.
+    std::vector<std::pair<double, size_t>> sorted(k);
+    for (size_t q = 0; q < queries.n_cols; ++q)
+    {
+      for (size_t i = 0; i < k; ++i)
+      {
+        const size_t index = candidates(i, q);
+        sorted[i].second = index;
+        sorted[i].first = (index == size_t() - 1) ?
+            SortPolicy::WorstDistance() :
+            metric.Evaluate(queries.col(q), references.col(index));
+      }
+
+      std::stable_sort(sorted.begin(), sorted.end(),
+          [](const std::pair<double, size_t>& a,
+             const std::pair<double, size_t>& b)
+          {
+            return a.first != b.first && SortPolicy::IsBetter(a.first, b.first);
+          });
+
+      for (size_t i = 0; i < k; ++i)
+      {
+        distances(i, begin + q) = sorted[i].first;
+        neighbors(i, begin + q) = sorted[i].second;
+      }
+    }
+  }
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+template<typename RuleType>
+void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
+DualTreeTraversalType, SingleTreeTraversalType>::DualTreeTraverse(
+    Tree& queryTree,
+    RuleType& rules)
+{
+  tree::TraversalStatistics::PhaseTimer timer(statistics.TraversalTime());
+
+#ifdef HAS_OPENMP
+  const size_t numThreads = omp_get_max_threads();
+#else
+  const size_t numThreads = 1;
+#endif
+
+  // Split the query tree into subtrees with disjoint sets of points.  Ask for
+  // more subtrees than threads, so that the dynamic schedule can balance the
+  // work.  If this isn't possible, we just get the root back.
+  std::vector<Tree*> subtrees;
+  if (numThreads > 1)
+    tree::IndependentSubtrees(queryTree, 8 * numThreads, subtrees);
+
+  if (subtrees.size() <= 1)
+  {
+    MLPACK_PROFILE_SCOPE("computing_neighbors");
+    DualTreeTraversalType<RuleType> traverser(rules);
+    traverser.Traverse(queryTree, *referenceTree);
+    statistics.AddTraverser(traverser);
+    return;
+  }
+
+  size_t totalScores = 0;
+  size_t totalBaseCases = 0;
+  size_t totalPrunes = 0;
+
+  // With NUMA placement, each thread takes a contiguous range of the subtrees
+  // in dataset order, so that it mostly reads query points on its own node.
+  if (NUMA::Enabled())
+    tree::SortByDatasetOrder(subtrees);
+  NUMA::LoopSchedule schedule;
+
+  #pragma omp parallel reduction(+:totalScores, totalBaseCases, totalPrunes)
+  {
+    // Each thread gets its own traversal state, but all threads share the
+    // candidate lists.  No candidate list is touched by more than one thread,
+    // because the subtrees hold disjoint sets of query points.
+    MLPACK_PROFILE_SCOPE("computing_neighbors");
+    NUMA::PinThread();
+    RuleType threadRules(rules, typename RuleType::ShareCandidates());
+
+#ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables. If we're building for Visual Studio,
+    // use the intmax_t type instead.
+    #pragma omp for schedule(runtime)
+    for (intmax_t i = 0; i < (intmax_t) subtrees.size(); ++i)
+#else
+    #pragma omp for schedule(runtime)
+    for (size_t i = 0; i < subtrees.size(); ++i)
+#endif
+    {
+      DualTreeTraversalType<RuleType> traverser(threadRules);
+      traverser.Traverse(*subtrees[i], *referenceTree);
+      totalPrunes += traverser.NumPrunes();
+    }
+
+    totalScores += threadRules.Scores();
+    totalBaseCases += threadRules.BaseCases();
+  }
+
+  rules.Scores() += totalScores;
+  rules.BaseCases() += totalBaseCases;
+  statistics.Prunes() += totalPrunes;
+}
+
 //! Calculate the average relative error.
 template<typename SortPolicy,
          typename MetricType,
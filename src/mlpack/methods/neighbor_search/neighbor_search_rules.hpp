@@ -35,6 +35,21 @@ template<typename SortPolicy, typename MetricType, typename TreeType>
 class NeighborSearchRules
 {
  public:
+  //! Candidate represents a possible candidate neighbor (distance, index).
+  typedef std::pair<double, size_t> Candidate;
+
+  //! Compare two candidates based on the distance.
+  struct CandidateCmp {
+    bool operator()(const Candidate& c1, const Candidate& c2)
+    {
+      return !SortPolicy::IsBetter(c2.first, c1.first);
+    };
+  };
+
+  //! Use a priority queue to represent the list of candidate neighbors.
+  typedef std::priority_queue<Candidate, std::vector<Candidate>, CandidateCmp>
+      CandidateList;
+
   /**
    * Construct the NeighborSearchRules object.  This is usually done from within
    * the NeighborSearch class at search time.
@@ -54,6 +69,59 @@ class NeighborSearchRules
                       const double epsilon = 0,
                       const bool sameSet = false);
 
+  /**
+   * Construct the NeighborSearchRules object, storing the candidate lists in the
+   * given vector instead of internally.  The vector is resized to hold one
+   * candidate list per query point; any memory it already holds is reused, so
+   * passing the same vector to successive searches avoids reallocating the
+   * candidate lists for every search.
+   *
+   * @param referenceSet Set of reference data.
+   * @param querySet Set of query data.
+   * @param k Number of neighbors to search for.
+   * @param metric Instantiated metric.
+   * @param storage Vector to store candidate lists in.
+   * @param epsilon Relative approximate error.
+   * @param sameSet If true, the query and reference set are taken to be the
+   *      same, and a query point will not return itself in the results.
+   */
+  NeighborSearchRules(const typename TreeType::Mat& referenceSet,
+                      const typename TreeType::Mat& querySet,
+                      const size_t k,
+                      MetricType& metric,
+                      std::vector<CandidateList>& storage,
+                      const double epsilon = 0,
+                      const bool sameSet = false);
+
+  //! Tag that selects the constructor that shares the candidate lists of
+  //! another rules object.
+  struct ShareCandidates { };
+
+  /**
+   * Construct a NeighborSearchRules object that shares the candidate lists of
+   * the given NeighborSearchRules object, but holds its own base case cache,
+   * traversal information, and counters.  This is used for parallel
+   * traversals, where each thread holds its own rules object and is
+   * responsible for a disjoint set of query points; since no query point is
+   * touched by more than one thread, the candidate lists need no locking.
+   *
+   * The given rules object must outlive the constructed object.
+   *
+   * @code
+   * RuleType threadRules(rules, RuleType::ShareCandidates());
+   * @endcode
+   *
+   * @param other Rules object whose candidate lists will be shared.
+   */
+  NeighborSearchRules(NeighborSearchRules& other, const ShareCandidates&);
+
+  //! Rules objects can't be copied, since a copy would share (or lose) the
+  //! candidate lists; use the ShareCandidates constructor to share them.
+  NeighborSearchRules(const NeighborSearchRules& other) = delete;
+
+  //! Rules objects can't be assigned.
+  NeighborSearchRules& operator=(const NeighborSearchRules& other) = delete;
+
   /**
    * Store the list of candidates for each query point in the given matrices.
    *
@@ -164,23 +232,12 @@ class NeighborSearchRules
   //! The query set.
   const typename TreeType::Mat& querySet;
 
-  //! Candidate represents a possible candidate neighbor (distance, index).
-  typedef std::pair<double, size_t> Candidate;
-
-  //! Compare two candidates based on the distance.
-  struct CandidateCmp {
-    bool operator()(const Candidate& c1, const Candidate& c2)
-    {
-      return !SortPolicy::IsBetter(c2.first, c1.first);
-    };
-  };
-
-  //! Use a priority queue to represent the list of candidate neighbors.
-  typedef std::priority_queue<Candidate, std::vector<Candidate>, CandidateCmp>
-      CandidateList;
+  //! Storage for the set of candidate neighbors for each point, if the
+  //! candidate lists are not held elsewhere.
+  std::vector<CandidateList> candidateStorage;
 
   //! Set of candidate neighbors for each point.
-  std::vector<CandidateList> candidates;
+  std::vector<CandidateList>& candidates;
 
   //! Number of neighbors to search for.
   const size_t k;
@@ -215,6 +272,11 @@ class NeighborSearchRules
    */
   double CalculateBound(TreeType& queryNode) const;
 
+  /**
+   * Fill the candidate lists with k default candidates for each query point.
+   */
+  void InitializeCandidates();
+
   /**
    * Helper function to insert a point into the list of candidate points.
    *
@@ -0,0 +1,208 @@
+/**
+ * @file nn_descent.hpp
+ *
+ * Defines the NNDescent class, which builds an approximate k-nearest-neighbor
+ * graph of a dataset by NN-Descent, seeded with the leaves of random
+ * projection trees.
+ *
+ * The details of this method can be found in the following paper:
+ *
+ * @inproceedings{dong2011efficient,
+ *  title={Efficient k-nearest neighbor graph construction for generic
+ *      similarity measures},
+ *  author={Dong, W. and Moses, C. and Li, K.},
+ *  booktitle={Proceedings of the 20th International Conference on World Wide
+ *      Web},
+ *  pages={577--586},
+ *  year={2011}
+ * }
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_NEIGHBOR_SEARCH_NN_DESCENT_HPP
+#define MLPACK_METHODS_NEIGHBOR_SEARCH_NN_DESCENT_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/metrics/lmetric.hpp>
+#include <mlpack/core/tree/binary_space_tree.hpp>
+
+#include <mutex>
+
+namespace mlpack {
+namespace neighbor {
+
+/**
+ * The NNDescent class finds approximate k nearest neighbors of each point of a
+ * dataset (the all-kNN problem, or the kNN graph), without a query set.  It is
+ * much faster than exact search in high dimension, where trees can't prune.
+ *
+ * The neighbor lists are first seeded with the points that share a leaf of
+ * each of a few random projection trees (RPTree), and lists still not full are
+ * completed with random points.  Then, in each iteration, the neighbors of the
+ * neighbors of each point (and the points that have it as a neighbor) are
+ * compared with each other, and the lists are updated with the closer points
+ * found.  Only pairs with at least one neighbor new since the last iteration
+ * are compared, and at most sampleRate * k new neighbors of each point are
+ * used in an iteration.  The iterations stop when fewer than delta * k * N
+ * neighbors were replaced, or after maxIterations iterations.
+ *
+ * The leaves and the points are processed in parallel when OpenMP is
+ * available.  The neighbor lists are protected by a fixed number of locks, the
+ * list of point i being protected by lock (i % locks), so a thread only waits
+ * when another thread updates a list that shares its lock.  Because of this
+ * and of the random trees, the results may differ between runs.
+ *
+ * @code
+ * NNDescent<> nnd;
+ * arma::Mat<size_t> neighbors;
+ * arma::mat distances;
+ * nnd.Search(dataset, 10, neighbors, distances);
+ * @endcode
+ *
+ * @tparam MetricType The metric to use for computation.
+ * @tparam MatType The type of data matrix.
+ */
+template<typename MetricType = metric::EuclideanDistance,
+         typename MatType = arma::mat>
+class NNDescent
+{
+ public:
+  /**
+   * Create the NNDescent object with the given parameters.
+   *
+   * @param trees Number of random projection trees used to seed the neighbor
+   *     lists (0 seeds them with random points only).
+   * @param leafSize Maximum number of points in a leaf of the trees.
+   * @param maxIterations Maximum number of iterations.
+   * @param delta The iterations stop when fewer than delta * k * N neighbors
+   *     were replaced in an iteration.
+   * @param sampleRate Fraction of the new neighbors of each point used in an
+   *     iteration (between 0 and 1).
+   * @param metric An optional instance of the MetricType class.
+   */
+  NNDescent(const size_t trees = 4,
+            const size_t leafSize = 20,
+            const size_t maxIterations = 10,
+            const double delta = 0.001,
+            const double sampleRate = 1.0,
+            const MetricType metric = MetricType());
+
+  /**
+   * Find the approximate k nearest neighbors of each point of the dataset, not
+   * counting the point itself.  Each column of neighbors and distances holds
+   * the neighbors of a point, closest first, as with the monochromatic
+   * NeighborSearch::Search().
+   *
+   * @param dataset Set of points.
+   * @param k Number of neighbors to search for (less than the number of
+   *     points).
+   * @param neighbors Matrix storing lists of neighbors for each point.
+   * @param distances Matrix storing distances of neighbors for each point.
+   */
+  void Search(const MatType& dataset,
+              const size_t k,
+              arma::Mat<size_t>& neighbors,
+              arma::mat& distances);
+
+  //! Get the number of random projection trees.
+  size_t Trees() const { return trees; }
+  //! Modify the number of random projection trees.
+  size_t& Trees() { return trees; }
+
+  //! Get the maximum number of points in a leaf of the trees.
+  size_t LeafSize() const { return leafSize; }
+  //! Modify the maximum number of points in a leaf of the trees.
+  size_t& LeafSize() { return leafSize; }
+
+  //! Get the maximum number of iterations.
+  size_t MaxIterations() const { return maxIterations; }
+  //! Modify the maximum number of iterations.
+  size_t& MaxIterations() { return maxIterations; }
+
+  //! Get the fraction of replaced neighbors under which the iterations stop.
+  double Delta() const { return delta; }
+  //! Modify the fraction of replaced neighbors under which the iterations
+  //! stop.
+  double& Delta() { return delta; }
+
+  //! Get the fraction of the new neighbors used in an iteration.
+  double SampleRate() const { return sampleRate; }
+  //! Modify the fraction of the new neighbors used in an iteration.
+  double& SampleRate() { return sampleRate; }
+
+  //! Get the number of iterations of the last search.
+  size_t Iterations() const { return iterations; }
+
+  //! Get the instantiated metric.
+  const MetricType& Metric() const { return metric; }
+  //! Modify the instantiated metric.
+  MetricType& Metric() { return metric; }
+
+ private:
+  //! Convenience typedef for the trees used to seed the lists.
+  typedef tree::RPTree<MetricType, tree::EmptyStatistic, MatType> Tree;
+
+  /**
+   * Insert the given candidate into the neighbor list of the given point, if
+   * it is closer than the furthest neighbor and not already in the list, and
+   * return whether it was inserted.  The list is locked with the given locks.
+   */
+  bool Insert(const size_t point,
+              const size_t candidate,
+              const double distance,
+              std::vector<std::mutex>& locks);
+
+  //! Add the leaves of the given tree to the given list.
+  static void Leaves(Tree& node, std::vector<Tree*>& leaves);
+
+  //! Seed the neighbor lists with the points of the leaves of a random
+  //! projection tree.
+  void SeedFromTree(const MatType& dataset, std::vector<std::mutex>& locks);
+
+  //! Complete the neighbor lists that are not full with random points.
+  void SeedRandomly(const MatType& dataset, std::vector<std::mutex>& locks);
+
+  /**
+   * Split the neighbors (and reverse neighbors) of each point into new and old
+   * candidates, keeping at most the given number of new ones, which are then
+   * marked as old.
+   */
+  void Candidates(const size_t sampleSize,
+                  std::vector<std::vector<size_t>>& newCandidates,
+                  std::vector<std::vector<size_t>>& oldCandidates);
+
+  //! Number of random projection trees.
+  size_t trees;
+  //! Maximum number of points in a leaf of the trees.
+  size_t leafSize;
+  //! Maximum number of iterations.
+  size_t maxIterations;
+  //! Fraction of replaced neighbors under which the iterations stop.
+  double delta;
+  //! Fraction of the new neighbors used in an iteration.
+  double sampleRate;
+  //! Instantiation of the metric.
+  MetricType metric;
+  //! Number of iterations of the last search.
+  size_t iterations;
+
+  //! The number of neighbors of the current search.
+  size_t k;
+  //! The neighbors of each point (one column per point), closest first.
+  arma::Mat<size_t> graph;
+  //! The distances to the neighbors of each point.
+  arma::mat graphDistances;
+  //! Whether each neighbor is new since it was last used as a candidate.
+  std::vector<char> isNew;
+};
+
+} // namespace neighbor
+} // namespace mlpack
+
+// Include implementation.
+#include "nn_descent_impl.hpp"
+
+#endif
@@ -0,0 +1,293 @@
+/**
+ * @file nn_descent_impl.hpp
+ *
+ * Implementation of the NNDescent class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_NEIGHBOR_SEARCH_NN_DESCENT_IMPL_HPP
+#define MLPACK_METHODS_NEIGHBOR_SEARCH_NN_DESCENT_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "nn_descent.hpp"
+
+namespace mlpack {
+namespace neighbor {
+
+template<typename MetricType, typename MatType>
+NNDescent<MetricType, MatType>::NNDescent(const size_t trees,
+                                          const size_t leafSize,
+                                          const size_t maxIterations,
+                                          const double delta,
+                                          const double sampleRate,
+                                          const MetricType metric) :
+    trees(trees),
+    leafSize(leafSize),
+    maxIterations(maxIterations),
+    delta(delta),
+    sampleRate(sampleRate),
+    metric(metric),
+    iterations(0),
+    k(0)
+{
+  if (sampleRate <= 0.0 || sampleRate > 1.0)
+  {
+    std::ostringstream error;
+    error << "NNDescent::NNDescent(): the sample rate (" << sampleRate << ") "
+        << "must be greater than 0 and at most 1";
+    throw std::invalid_argument(error.str());
+  }
+}
+
+template<typename MetricType, typename MatType>
+void NNDescent<MetricType, MatType>::Search(const MatType& dataset,
+                                            const size_t k,
+                                            arma::Mat<size_t>& neighbors,
+                                            arma::mat& distances)
+{
+  if (k == 0 || k >= dataset.n_cols)
+  {
+    std::ostringstream error;
+    error << "NNDescent::Search(): requested value of k (" << k << ") must be "
+        << "greater than 0 and less than the number of points ("
+        << dataset.n_cols << ")";
+    throw std::invalid_argument(error.str());
+  }
+
+  Timer::Start("computing_neighbors");
+
+  const size_t numPoints = dataset.n_cols;
+  this->k = k;
+  graph.set_size(k, numPoints);
+  graph.fill(SIZE_MAX);
+  graphDistances.set_size(k, numPoints);
+  graphDistances.fill(DBL_MAX);
+  isNew.assign(k * numPoints, 1);
+
+  // Lock striping: the list of point i is protected by lock (i % locks).
+  std::vector<std::mutex> locks(std::min(numPoints, (size_t) 1024));
+
+  for (size_t t = 0; t < trees; ++t)
+    SeedFromTree(dataset, locks);
+  SeedRandomly(dataset, locks);
+
+  const size_t sampleSize = std::max((size_t) 1,
+      (size_t) std::ceil(sampleRate * k));
+  std::vector<std::vector<size_t>> newCandidates, oldCandidates;
+  for (iterations = 0; iterations < maxIterations; )
+  {
+    ++iterations;
+    Candidates(sampleSize, newCandidates, oldCandidates);
+
+    // Compare the candidates of each point with each other: each pair holds
+    // at least one new candidate.
+    size_t updates = 0;
+#ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables. If we're building for Visual Studio,
+    // use the intmax_t type instead.
+    #pragma omp parallel for schedule(dynamic, 16) reduction(+:updates)
+    for (intmax_t i = 0; i < (intmax_t) numPoints; ++i)
+#else
+    #pragma omp parallel for schedule(dynamic, 16) reduction(+:updates)
+    for (size_t i = 0; i < numPoints; ++i)
+#endif
+    {
+      const std::vector<size_t>& fresh = newCandidates[i];
+      const std::vector<size_t>& old = oldCandidates[i];
+      for (size_t a = 0; a < fresh.size(); ++a)
+      {
+        const size_t u = fresh[a];
+        for (size_t b = a + 1; b < fresh.size() + old.size(); ++b)
+        {
+          const size_t v = (b < fresh.size()) ? fresh[b] :
+              old[b - fresh.size()];
+          if (u == v)
+            continue;
+
+          const double distance = metric.Evaluate(dataset.col(u),
+              dataset.col(v));
+          updates += Insert(u, v, distance, locks);
+          updates += Insert(v, u, distance, locks);
+        }
+      }
+    }
+
+    Log::Info << "NN-Descent iteration " << iterations << ": " << updates
+        << " neighbors replaced." << std::endl;
+    if (updates < delta * k * numPoints)
+      break;
+  }
+
+  neighbors = std::move(graph);
+  distances = std::move(graphDistances);
+  isNew.clear();
+
+  Timer::Stop("computing_neighbors");
+}
+
+template<typename MetricType, typename MatType>
+bool NNDescent<MetricType, MatType>::Insert(const size_t point,
+                                            const size_t candidate,
+                                            const double distance,
+                                            std::vector<std::mutex>& locks)
+{
+  std::lock_guard<std::mutex> lock(locks[point % locks.size()]);
+
+  size_t* ids = graph.colptr(point);
+  double* dists = graphDistances.colptr(point);
+  char* fresh = isNew.data() + point * k;
+  if (distance >= dists[k - 1])
+    return false;
+  for (size_t j = 0; j < k; ++j)
+    if (ids[j] == candidate)
+      return false;
+
+  // Shift the furthest neighbors to keep the list sorted.
+  size_t position = k - 1;
+  while (position > 0 && dists[position - 1] > distance)
+  {
+    ids[position] = ids[position - 1];
+    dists[position] = dists[position - 1];
+    fresh[position] = fresh[position - 1];
+    --position;
+  }
+
+  ids[position] = candidate;
+  dists[position] = distance;
+  fresh[position] = 1;
+  return true;
+}
+
+template<typename MetricType, typename MatType>
+void NNDescent<MetricType, MatType>::Leaves(Tree& node,
+                                            std::vector<Tree*>& leaves)
+{
+  if (node.IsLeaf())
+  {
+    leaves.push_back(&node);
+    return;
+  }
+
+  for (size_t i = 0; i < node.NumChildren(); ++i)
+    Leaves(node.Child(i), leaves);
+}
+
+template<typename MetricType, typename MatType>
+void NNDescent<MetricType, MatType>::SeedFromTree(
+    const MatType& dataset,
+    std::vector<std::mutex>& locks)
+{
+  // The tree rearranges its copy of the dataset.
+  std::vector<size_t> oldFromNew;
+  Tree tree(dataset, oldFromNew, std::max(leafSize, (size_t) 2));
+  const MatType& points = tree.Dataset();
+
+  std::vector<Tree*> leaves;
+  Leaves(tree, leaves);
+
+  // Every pair of points of a leaf is a candidate.
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables. If we're building for Visual Studio, use
+  // the intmax_t type instead.
+  #pragma omp parallel for schedule(dynamic)
+  for (intmax_t l = 0; l < (intmax_t) leaves.size(); ++l)
+#else
+  #pragma omp parallel for schedule(dynamic)
+  for (size_t l = 0; l < leaves.size(); ++l)
+#endif
+  {
+    const size_t begin = leaves[l]->Begin();
+    const size_t end = begin + leaves[l]->Count();
+    for (size_t a = begin; a < end; ++a)
+    {
+      for (size_t b = a + 1; b < end; ++b)
+      {
+        const double distance = metric.Evaluate(points.col(a), points.col(b));
+        Insert(oldFromNew[a], oldFromNew[b], distance, locks);
+        Insert(oldFromNew[b], oldFromNew[a], distance, locks);
+      }
+    }
+  }
+}
+
+template<typename MetricType, typename MatType>
+void NNDescent<MetricType, MatType>::SeedRandomly(
+    const MatType& dataset,
+    std::vector<std::mutex>& locks)
+{
+  // The random number generator isn't thread-safe, so this is serial.  Since
+  // k is less than the number of points, every list can be filled.
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+  {
+    while (graph(k - 1, i) == SIZE_MAX)
+    {
+      const size_t j = (size_t) math::RandInt(dataset.n_cols);
+      if (j != i)
+        Insert(i, j, metric.Evaluate(dataset.col(i), dataset.col(j)), locks);
+    }
+  }
+}
+
+template<typename MetricType, typename MatType>
+void NNDescent<MetricType, MatType>::Candidates(
+    const size_t sampleSize,
+    std::vector<std::vector<size_t>>& newCandidates,
+    std::vector<std::vector<size_t>>& oldCandidates)
+{
+  const size_t numPoints = graph.n_cols;
+  newCandidates.assign(numPoints, std::vector<size_t>());
+  oldCandidates.assign(numPoints, std::vector<size_t>());
+
+  std::vector<size_t> fresh;
+  for (size_t i = 0; i < numPoints; ++i)
+  {
+    fresh.clear();
+    for (size_t j = 0; j < k; ++j)
+    {
+      if (isNew[i * k + j])
+      {
+        fresh.push_back(j);
+      }
+      else
+      {
+        oldCandidates[i].push_back(graph(j, i));
+        oldCandidates[graph(j, i)].push_back(i);
+      }
+    }
+
+    // Use a random sample of the new neighbors, and mark them as old.
+    for (size_t s = 0; s < std::min(sampleSize, fresh.size()); ++s)
+    {
+      std::swap(fresh[s], fresh[math::RandInt(s, fresh.size())]);
+      const size_t neighbor = graph(fresh[s], i);
+      newCandidates[i].push_back(neighbor);
+      newCandidates[neighbor].push_back(i);
+      isNew[i * k + fresh[s]] = 0;
+    }
+  }
+
+  // Points that are the neighbors of many points get many reverse candidates;
+  // keep a random sample of them.
+  for (size_t i = 0; i < numPoints; ++i)
+  {
+    for (std::vector<size_t>* list : { &newCandidates[i], &oldCandidates[i] })
+    {
+      if (list->size() <= 2 * sampleSize)
+        continue;
+
+      for (size_t s = 0; s < 2 * sampleSize; ++s)
+        std::swap((*list)[s], (*list)[math::RandInt(s, list->size())]);
+      list->resize(2 * sampleSize);
+    }
+  }
+}
+
+} // namespace neighbor
+} // namespace mlpack
+
+#endif
@@ -20,7 +20,13 @@
 #include <mlpack/core/tree/rectangle_tree.hpp>
 #include <mlpack/core/tree/spill_tree.hpp>
 #include <mlpack/core/tree/octree.hpp>
+#include <mlpack/core/data/mapped_file.hpp>
 #include <boost/variant.hpp>
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
+#include <fstream>
+#include <sstream>
+#include <memory>
 #include "neighbor_search.hpp"
 
 namespace mlpack {
@@ -230,6 +236,29 @@ class EpsilonVisitor : public boost::static_visitor<double&>
   double& operator()(NSType *ns) const;
 };
 
+/**
+ * BeamWidthVisitor exposes the BeamWidth method of the given NSType.
+ */
+class BeamWidthVisitor : public boost::static_visitor<size_t&>
+{
+ public:
+  //! Return the number of nodes kept at each level by greedy search.
+  template<typename NSType>
+  size_t& operator()(NSType* ns) const;
+};
+
+/**
+ * BacktrackBudgetVisitor exposes the BacktrackBudget method of the given
+ * NSType.
+ */
+class BacktrackBudgetVisitor : public boost::static_visitor<size_t&>
+{
+ public:
+  //! Return the number of base cases greedy search may spend on backtracking.
+  template<typename NSType>
+  size_t& operator()(NSType* ns) const;
+};
+
 /**
  * ReferenceSetVisitor exposes the referenceSet of the given NSType.
  */
@@ -241,6 +270,60 @@ class ReferenceSetVisitor : public boost::static_visitor<const arma::mat&>
   const arma::mat& operator()(NSType *ns) const;
 };
 
+/**
+ * BaseCasesVisitor exposes the number of base cases of the last search of the
+ * given NSType.
+ */
+class BaseCasesVisitor : public boost::static_visitor<size_t>
+{
+ public:
+  //! Return the number of base cases.
+  template<typename NSType>
+  size_t operator()(NSType* ns) const;
+};
+
+/**
+ * ScoresVisitor exposes the number of node scores of the last search of the
+ * given NSType.
+ */
+class ScoresVisitor : public boost::static_visitor<size_t>
+{
+ public:
+  //! Return the number of node scores.
+  template<typename NSType>
+  size_t operator()(NSType* ns) const;
+};
+
+/**
+ * TreeSizeVisitor counts the nodes of the reference tree of the given NSType,
+ * and the bytes taken by the node objects (not counting the memory that the
+ * nodes allocate themselves, like the point lists of rectangle trees).  Both
+ * are 0 in naive mode.
+ */
+class TreeSizeVisitor : public boost::static_visitor<void>
+{
+ private:
+  //! Number of nodes.
+  size_t& numNodes;
+  //! Number of bytes taken by the nodes.
+  size_t& numBytes;
+
+  //! Count the nodes of the subtree rooted at the given node.
+  template<typename TreeType>
+  static size_t CountNodes(const TreeType& node);
+
+ public:
+  //! Construct the TreeSizeVisitor to store the results in the given values.
+  TreeSizeVisitor(size_t& numNodes, size_t& numBytes) :
+      numNodes(numNodes),
+      numBytes(numBytes)
+  { }
+
+  //! Count the nodes of the reference tree.
+  template<typename NSType>
+  void operator()(NSType* ns) const;
+};
+
 /**
  * DeleteVisitor deletes the given NSType instance.
  */
@@ -262,6 +345,44 @@ class DeleteVisitor : public boost::static_visitor<void>
  *
  * @tparam SortPolicy The sort policy for distances; see NearestNeighborSort.
  */
+/**
+ * FlatSaveVisitor writes the reference tree of a NeighborSearch object to a
+ * stream as a flat image (see BinarySpaceTree::SaveFlat()), and the search
+ * parameters to an archive.  A std::invalid_argument is thrown if the tree type
+ * does not support flat images or naive search is used.
+ */
+class FlatSaveVisitor : public boost::static_visitor<void>
+{
+ private:
+  //! The stream to write the tree to.
+  std::ostream& stream;
+  //! The archive to write the search parameters to.
+  boost::archive::binary_oarchive& ar;
+
+  //! Write the search parameters and the tree.
+  template<typename NSType>
+  void SaveFlat(NSType* ns,
+                const typename std::enable_if<tree::HasFlatImage<
+                    typename NSType::Tree>::value>::type* = 0) const;
+
+  //! Throw an exception, because the tree can't be written as a flat image.
+  template<typename NSType>
+  void SaveFlat(NSType* ns,
+                const typename std::enable_if<!tree::HasFlatImage<
+                    typename NSType::Tree>::value>::type* = 0) const;
+
+ public:
+  //! Write the given NSType instance.
+  template<typename NSType>
+  void operator()(NSType* ns) const;
+
+  //! Construct the FlatSaveVisitor with the given stream and archive.
+  FlatSaveVisitor(std::ostream& stream, boost::archive::binary_oarchive& ar) :
+      stream(stream),
+      ar(ar)
+  {};
+};
+
 template<typename SortPolicy>
 class NSModel
 {
@@ -324,6 +445,19 @@ class NSModel
                  NSType<SortPolicy, tree::UBTree>*,
                  NSType<SortPolicy, tree::Octree>*> nSearch;
 
+  //! The file holding the reference tree and dataset, if the model was loaded
+  //! with LoadFlat().
+  std::shared_ptr<data::MappedFile> mappedFile;
+
+  /**
+   * Create a NeighborSearch object with the given type from the flat image of a
+   * tree and the search parameters stored in the given archive.
+   */
+  template<typename NSType>
+  static NSType* LoadFlatSearch(char* image,
+                                const size_t size,
+                                boost::archive::binary_iarchive& ar);
+
  public:
   /**
    * Initialize the NSModel with the given type and whether or not a random
@@ -370,6 +504,29 @@ class NSModel
   template<typename Archive>
   void Serialize(Archive& ar, const unsigned int /* version */);
 
+  /**
+   * Save the model to the given file in a flat, pointer-free layout that can be
+   * loaded with LoadFlat().  The file holds the points of the reference set in
+   * column-major order, the tree nodes as a table, and the other parameters of
+   * the model.  Only tree types built on BinarySpaceTree (kd-trees, ball trees,
+   * VP trees, RP trees, max-RP trees and UB trees) are supported; for other
+   * tree types, or in naive mode, a std::invalid_argument is thrown.
+   *
+   * @param filename File to save the model to.
+   */
+  void SaveFlat(const std::string& filename);
+
+  /**
+   * Load the model from a file written by SaveFlat().  The file is mapped into
+   * memory and the reference set is not copied, so loading takes time
+   * proportional to the number of tree nodes only, the points are read from
+   * disk as they are needed, and processes that load the same file share the
+   * memory holding it.  The file must not be modified while it is loaded.
+   *
+   * @param filename File to load the model from.
+   */
+  void LoadFlat(const std::string& filename);
+
   //! Expose the dataset.
   const arma::mat& Dataset() const;
 
@@ -381,6 +538,14 @@ class NSModel
   double Epsilon() const;
   double& Epsilon();
 
+  //! Expose the beam width of greedy search.
+  size_t BeamWidth() const;
+  size_t& BeamWidth();
+
+  //! Expose the backtracking budget of greedy search.
+  size_t BacktrackBudget() const;
+  size_t& BacktrackBudget();
+
   //! Expose leafSize.
   size_t LeafSize() const { return leafSize; }
   size_t& LeafSize() { return leafSize; }
@@ -418,6 +583,21 @@ class NSModel
               arma::Mat<size_t>& neighbors,
               arma::mat& distances);
 
+  //! Return the number of base cases of the last search.
+  size_t BaseCases() const;
+
+  //! Return the number of node scores of the last search.
+  size_t Scores() const;
+
+  /**
+   * Count the nodes of the reference tree and the bytes taken by the node
+   * objects (see TreeSizeVisitor).  Both are 0 in naive mode.
+   *
+   * @param numNodes Will be set to the number of nodes.
+   * @param numBytes Will be set to the number of bytes taken by the nodes.
+   */
+  void TreeSize(size_t& numNodes, size_t& numBytes) const;
+
   //! Return a string representation of the current tree type.
   std::string TreeName() const;
 };
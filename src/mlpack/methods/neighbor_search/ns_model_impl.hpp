@@ -243,6 +243,24 @@ double& EpsilonVisitor::operator()(NSType* ns) const
   throw std::runtime_error("no neighbor search model initialized");
 }
 
+//! Expose the BeamWidth method of the given NSType.
+template<typename NSType>
+size_t& BeamWidthVisitor::operator()(NSType* ns) const
+{
+  if (ns)
+    return ns->BeamWidth();
+  throw std::runtime_error("no neighbor search model initialized");
+}
+
+//! Expose the BacktrackBudget method of the given NSType.
+template<typename NSType>
+size_t& BacktrackBudgetVisitor::operator()(NSType* ns) const
+{
+  if (ns)
+    return ns->BacktrackBudget();
+  throw std::runtime_error("no neighbor search model initialized");
+}
+
 //! Expose the referenceSet of the given NSType.
 template<typename NSType>
 const arma::mat& ReferenceSetVisitor::operator()(NSType* ns) const
@@ -252,6 +270,50 @@ const arma::mat& ReferenceSetVisitor::operator()(NSType* ns) const
   throw std::runtime_error("no neighbor search model initialized");
 }
 
+//! Expose the number of base cases of the given NSType.
+template<typename NSType>
+size_t BaseCasesVisitor::operator()(NSType* ns) const
+{
+  if (ns)
+    return ns->BaseCases();
+  throw std::runtime_error("no neighbor search model initialized");
+}
+
+//! Expose the number of node scores of the given NSType.
+template<typename NSType>
+size_t ScoresVisitor::operator()(NSType* ns) const
+{
+  if (ns)
+    return ns->Scores();
+  throw std::runtime_error("no neighbor search model initialized");
+}
+
+//! Count the nodes of the reference tree of the given NSType.
+template<typename NSType>
+void TreeSizeVisitor::operator()(NSType* ns) const
+{
+  if (!ns)
+    throw std::runtime_error("no neighbor search model initialized");
+
+  numNodes = 0;
+  numBytes = 0;
+  if (ns->SearchMode() != NAIVE_MODE)
+  {
+    numNodes = CountNodes(ns->ReferenceTree());
+    numBytes = numNodes * sizeof(typename NSType::Tree);
+  }
+}
+
+//! Count the nodes of the subtree rooted at the given node.
+template<typename TreeType>
+size_t TreeSizeVisitor::CountNodes(const TreeType& node)
+{
+  size_t count = 1;
+  for (size_t i = 0; i < node.NumChildren(); ++i)
+    count += CountNodes(node.Child(i));
+  return count;
+}
+
 //! Clean memory, if necessary.
 template<typename NSType>
 void DeleteVisitor::operator()(NSType* ns) const
@@ -260,6 +322,46 @@ void DeleteVisitor::operator()(NSType* ns) const
     delete ns;
 }
 
+//! Write the given NSType instance as a flat image.
+template<typename NSType>
+void FlatSaveVisitor::operator()(NSType* ns) const
+{
+  if (ns)
+    return SaveFlat(ns);
+  throw std::runtime_error("no neighbor search model initialized");
+}
+
+//! Write the search parameters and the tree.
+template<typename NSType>
+void FlatSaveVisitor::SaveFlat(
+    NSType* ns,
+    const typename std::enable_if<tree::HasFlatImage<
+        typename NSType::Tree>::value>::type*) const
+{
+  if (ns->SearchMode() == NAIVE_MODE)
+    throw std::invalid_argument("cannot save a model that uses naive search "
+        "as a flat image");
+
+  NeighborSearchMode searchMode = ns->SearchMode();
+  double epsilon = ns->Epsilon();
+  ar << data::CreateNVP(searchMode, "searchMode");
+  ar << data::CreateNVP(epsilon, "epsilon");
+  ar << data::CreateNVP(ns->OldFromNewReferences(), "oldFromNewReferences");
+
+  ns->ReferenceTree().SaveFlat(stream);
+}
+
+//! Throw an exception, because the tree can't be written as a flat image.
+template<typename NSType>
+void FlatSaveVisitor::SaveFlat(
+    NSType* /* ns */,
+    const typename std::enable_if<!tree::HasFlatImage<
+        typename NSType::Tree>::value>::type*) const
+{
+  throw std::invalid_argument("the tree type of the model cannot be saved as "
+      "a flat image");
+}
+
 /**
  * Initialize the NSModel with the given type and whether or not a random
  * basis should be used.
@@ -283,7 +385,8 @@ NSModel<SortPolicy>::NSModel(const NSModel& other) :
     rho(other.rho),
     randomBasis(other.randomBasis),
     q(other.q),
-    nSearch(other.nSearch)
+    nSearch(other.nSearch),
+    mappedFile(other.mappedFile)
 {
   // Nothing to do.
 }
@@ -296,7 +399,8 @@ NSModel<SortPolicy>::NSModel(NSModel&& other) :
     rho(other.rho),
     randomBasis(other.randomBasis),
     q(std::move(other.q)),
-    nSearch(other.nSearch)
+    nSearch(other.nSearch),
+    mappedFile(std::move(other.mappedFile))
 {
   // Reset parameters of the other model.
   other.treeType = TreeTypes::KD_TREE;
@@ -319,6 +423,7 @@ NSModel<SortPolicy>& NSModel<SortPolicy>::operator=(const NSModel& other)
   randomBasis = other.randomBasis;
   q = other.q;
   nSearch = other.nSearch;
+  mappedFile = other.mappedFile;
 
   return *this;
 }
@@ -336,6 +441,7 @@ NSModel<SortPolicy>& NSModel<SortPolicy>::operator=(NSModel&& other)
   q = std::move(other.q);
   // Copy the pointer and type.
   nSearch = other.nSearch;
+  mappedFile = std::move(other.mappedFile);
 
   // Reset parameters of the other model.
   other.treeType = TreeTypes::KD_TREE;
@@ -399,12 +505,167 @@ void NSModel<SortPolicy>::Serialize(Archive& ar, const unsigned int version)
 
   // This should never happen, but just in case, be clean with memory.
   if (Archive::is_loading::value)
+  {
     boost::apply_visitor(DeleteVisitor(), nSearch);
+    mappedFile.reset();
+  }
 
   const std::string& name = NSModelName<SortPolicy>::Name();
   ar & data::CreateNVP(nSearch, name);
 }
 
+//! Save the model as a flat image.
+template<typename SortPolicy>
+void NSModel<SortPolicy>::SaveFlat(const std::string& filename)
+{
+  std::ofstream stream(filename.c_str(), std::ios::binary);
+  if (!stream.is_open())
+  {
+    std::ostringstream oss;
+    oss << "NSModel::SaveFlat(): cannot open file '" << filename << "' for "
+        << "writing";
+    throw std::runtime_error(oss.str());
+  }
+
+  tree::FlatModelHeader header;
+  std::memset(&header, 0, sizeof(tree::FlatModelHeader));
+  std::strncpy(header.magic, "mlpknsm", sizeof(header.magic));
+  header.version = 1;
+  header.treeOffset = tree::FlatImageAlign(sizeof(tree::FlatModelHeader));
+
+  // The header is written again once the offsets are known.
+  const char padding[tree::FlatImageAlignment] = { 0 };
+  stream.write(reinterpret_cast<const char*>(&header),
+      sizeof(tree::FlatModelHeader));
+  stream.write(padding, header.treeOffset - sizeof(tree::FlatModelHeader));
+
+  std::ostringstream params(std::ios::binary);
+  {
+    boost::archive::binary_oarchive ar(params);
+    ar << data::CreateNVP(treeType, "treeType");
+    ar << data::CreateNVP(leafSize, "leafSize");
+    ar << data::CreateNVP(tau, "tau");
+    ar << data::CreateNVP(rho, "rho");
+    ar << data::CreateNVP(randomBasis, "randomBasis");
+    ar << data::CreateNVP(q, "q");
+
+    FlatSaveVisitor visitor(stream, ar);
+    boost::apply_visitor(visitor, nSearch);
+  }
+  const std::string paramsString = params.str();
+
+  const size_t treeEnd = (size_t) stream.tellp();
+  header.paramsOffset = tree::FlatImageAlign(treeEnd);
+  header.paramsSize = paramsString.size();
+  stream.write(padding, header.paramsOffset - treeEnd);
+  stream.write(paramsString.data(), paramsString.size());
+
+  stream.seekp(0);
+  stream.write(reinterpret_cast<const char*>(&header),
+      sizeof(tree::FlatModelHeader));
+
+  if (!stream.good())
+  {
+    std::ostringstream oss;
+    oss << "NSModel::SaveFlat(): error writing to file '" << filename << "'";
+    throw std::runtime_error(oss.str());
+  }
+}
+
+//! Create a NeighborSearch object from a flat image.
+template<typename SortPolicy>
+template<typename NSType>
+NSType* NSModel<SortPolicy>::LoadFlatSearch(char* image,
+                                            const size_t size,
+                                            boost::archive::binary_iarchive& ar)
+{
+  NeighborSearchMode searchMode;
+  double epsilon;
+  std::vector<size_t> oldFromNewReferences;
+  ar >> data::CreateNVP(searchMode, "searchMode");
+  ar >> data::CreateNVP(epsilon, "epsilon");
+  ar >> data::CreateNVP(oldFromNewReferences, "oldFromNewReferences");
+
+  typename NSType::Tree tree(image, size);
+  NSType* ns = new NSType(std::move(tree), searchMode, epsilon);
+  ns->OldFromNewReferences() = std::move(oldFromNewReferences);
+  return ns;
+}
+
+//! Load the model from a flat image.
+template<typename SortPolicy>
+void NSModel<SortPolicy>::LoadFlat(const std::string& filename)
+{
+  std::shared_ptr<data::MappedFile> file =
+      std::make_shared<data::MappedFile>(filename);
+
+  tree::FlatModelHeader header;
+  if (file->Size() >= sizeof(tree::FlatModelHeader))
+    std::memcpy(&header, file->Memory(), sizeof(tree::FlatModelHeader));
+  if (file->Size() < sizeof(tree::FlatModelHeader) ||
+      std::strncmp(header.magic, "mlpknsm", sizeof(header.magic)) != 0 ||
+      header.version != 1 ||
+      header.treeOffset > header.paramsOffset ||
+      header.paramsOffset + header.paramsSize > file->Size())
+  {
+    std::ostringstream oss;
+    oss << "NSModel::LoadFlat(): file '" << filename << "' was not written "
+        << "by NSModel::SaveFlat()";
+    throw std::runtime_error(oss.str());
+  }
+
+  tree::MemoryStreamBuf buffer(file->Memory() + header.paramsOffset,
+      header.paramsSize);
+  boost::archive::binary_iarchive ar(buffer);
+
+  TreeTypes newTreeType;
+  ar >> data::CreateNVP(newTreeType, "treeType");
+  ar >> data::CreateNVP(leafSize, "leafSize");
+  ar >> data::CreateNVP(tau, "tau");
+  ar >> data::CreateNVP(rho, "rho");
+  ar >> data::CreateNVP(randomBasis, "randomBasis");
+  ar >> data::CreateNVP(q, "q");
+
+  char* image = file->Memory() + header.treeOffset;
+  const size_t imageSize = header.paramsOffset - header.treeOffset;
+  decltype(nSearch) newSearch;
+  switch (newTreeType)
+  {
+    case KD_TREE:
+      newSearch = LoadFlatSearch<NSType<SortPolicy, tree::KDTree>>(image,
+          imageSize, ar);
+      break;
+    case BALL_TREE:
+      newSearch = LoadFlatSearch<NSType<SortPolicy, tree::BallTree>>(image,
+          imageSize, ar);
+      break;
+    case VP_TREE:
+      newSearch = LoadFlatSearch<NSType<SortPolicy, tree::VPTree>>(image,
+          imageSize, ar);
+      break;
+    case RP_TREE:
+      newSearch = LoadFlatSearch<NSType<SortPolicy, tree::RPTree>>(image,
+          imageSize, ar);
+      break;
+    case MAX_RP_TREE:
+      newSearch = LoadFlatSearch<NSType<SortPolicy, tree::MaxRPTree>>(image,
+          imageSize, ar);
+      break;
+    case UB_TREE:
+      newSearch = LoadFlatSearch<NSType<SortPolicy, tree::UBTree>>(image,
+          imageSize, ar);
+      break;
+    default:
+      throw std::invalid_argument("NSModel::LoadFlat(): the tree type of the "
+          "model cannot be loaded from a flat image");
+  }
+
+  boost::apply_visitor(DeleteVisitor(), nSearch);
+  treeType = newTreeType;
+  nSearch = newSearch;
+  mappedFile = file;
+}
+
 //! Expose the dataset.
 template<typename SortPolicy>
 const arma::mat& NSModel<SortPolicy>::Dataset() const
@@ -438,6 +699,30 @@ double& NSModel<SortPolicy>::Epsilon()
   return boost::apply_visitor(EpsilonVisitor(), nSearch);
 }
 
+template<typename SortPolicy>
+size_t NSModel<SortPolicy>::BeamWidth() const
+{
+  return boost::apply_visitor(BeamWidthVisitor(), nSearch);
+}
+
+template<typename SortPolicy>
+size_t& NSModel<SortPolicy>::BeamWidth()
+{
+  return boost::apply_visitor(BeamWidthVisitor(), nSearch);
+}
+
+template<typename SortPolicy>
+size_t NSModel<SortPolicy>::BacktrackBudget() const
+{
+  return boost::apply_visitor(BacktrackBudgetVisitor(), nSearch);
+}
+
+template<typename SortPolicy>
+size_t& NSModel<SortPolicy>::BacktrackBudget()
+{
+  return boost::apply_visitor(BacktrackBudgetVisitor(), nSearch);
+}
+
 //! Build the reference tree.
 template<typename SortPolicy>
 void NSModel<SortPolicy>::BuildModel(arma::mat&& referenceSet,
@@ -480,6 +765,7 @@ void NSModel<SortPolicy>::BuildModel(arma::mat&& referenceSet,
 
   // Clean memory, if necessary.
   boost::apply_visitor(DeleteVisitor(), nSearch);
+  mappedFile.reset();
 
   // Do we need to modify the reference set?
   if (randomBasis)
@@ -620,6 +906,28 @@ void NSModel<SortPolicy>::Search(const size_t k,
   boost::apply_visitor(search, nSearch);
 }
 
+//! Return the number of base cases of the last search.
+template<typename SortPolicy>
+size_t NSModel<SortPolicy>::BaseCases() const
+{
+  return boost::apply_visitor(BaseCasesVisitor(), nSearch);
+}
+
+//! Return the number of node scores of the last search.
+template<typename SortPolicy>
+size_t NSModel<SortPolicy>::Scores() const
+{
+  return boost::apply_visitor(ScoresVisitor(), nSearch);
+}
+
+//! Count the nodes of the reference tree.
+template<typename SortPolicy>
+void NSModel<SortPolicy>::TreeSize(size_t& numNodes, size_t& numBytes) const
+{
+  TreeSizeVisitor visitor(numNodes, numBytes);
+  boost::apply_visitor(visitor, nSearch);
+}
+
 //! Get the name of the tree type.
 template<typename SortPolicy>
 std::string NSModel<SortPolicy>::TreeName() const
@@ -0,0 +1,264 @@
+/**
+ * @file pq_search.hpp
+ *
+ * Defines the PQSearch class, which performs approximate nearest neighbor
+ * search with the Euclidean distance on points compressed by product
+ * quantization, optionally with an inverted file (IVF-PQ).
+ *
+ * The details of this method can be found in the following paper:
+ *
+ * @article{jegou2011product,
+ *  title={Product quantization for nearest neighbor search},
+ *  author={J{\'e}gou, H. and Douze, M. and Schmid, C.},
+ *  journal={IEEE Transactions on Pattern Analysis and Machine Intelligence},
+ *  volume={33},
+ *  number={1},
+ *  pages={117--128},
+ *  year={2011}
+ * }
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_NEIGHBOR_SEARCH_PQ_SEARCH_HPP
+#define MLPACK_METHODS_NEIGHBOR_SEARCH_PQ_SEARCH_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/metrics/lmetric.hpp>
+#include <mlpack/methods/kmeans/kmeans.hpp>
+
+namespace mlpack {
+namespace neighbor {
+
+/**
+ * The PQSearch class stores the reference set compressed by product
+ * quantization and finds approximate nearest neighbors with the Euclidean
+ * distance.  The dimensions are split into a number of subspaces, k-means
+ * learns a codebook of at most 256 centroids in each subspace, and each point
+ * is stored as the index of the closest centroid in each subspace: one byte
+ * per subspace, plus the index of the point.  For instance, 128-dimensional
+ * points with 16 subspaces take 24 bytes instead of 1024.
+ *
+ * With more than one list, the points are first assigned to the closest of a
+ * set of coarse centroids (also learned by k-means), and the residuals to that
+ * centroid are quantized; a search only scans the points of the lists of the
+ * given number of closest coarse centroids (the probes).
+ *
+ * Distances are computed asymmetrically: the query point is not quantized.
+ * For each scanned list, a table of the squared distances between each
+ * subvector of the query (residual) and each centroid of the codebooks is
+ * computed once, and the distance to a point is then the sum of one table
+ * entry per subspace.  Optionally, the best candidates can be re-ranked with
+ * the exact distance to the original points, which can stay on disk and be
+ * mapped into memory with data::MappedMatrix, since only a few columns are
+ * read for each query.
+ *
+ * The codebooks can be trained on a sample with Train(), and the points added
+ * in batches with Add(), so that the full reference set never has to be held
+ * in memory.  Query points are searched in parallel when OpenMP is available.
+ *
+ * @code
+ * data::MappedMatrix<> points("points.mlm");
+ * PQSearch<> pq(16, 256, 1024);
+ * pq.Train(sample);
+ * pq.Add(points.Matrix());
+ * pq.Probes() = 16;
+ *
+ * arma::Mat<size_t> neighbors;
+ * arma::mat distances;
+ * // Re-rank the 100 best candidates with the original points.
+ * pq.Search(querySet, points.Matrix(), 10, 100, neighbors, distances);
+ * @endcode
+ *
+ * @tparam MatType The type of data matrix.
+ */
+template<typename MatType = arma::mat>
+class PQSearch
+{
+ public:
+  /**
+   * Create the PQSearch object without codebooks.  Train() must be called
+   * before points are added.
+   *
+   * @param subspaces Number of subspaces (bytes per point).
+   * @param centroids Number of centroids of the codebook of each subspace
+   *     (between 1 and 256).
+   * @param lists Number of coarse centroids (inverted lists); 1 gives plain
+   *     product quantization.
+   * @param probes Number of lists scanned by a search.
+   * @param maxIterations Maximum number of iterations of k-means.
+   */
+  PQSearch(const size_t subspaces = 8,
+           const size_t centroids = 256,
+           const size_t lists = 1,
+           const size_t probes = 1,
+           const size_t maxIterations = 25);
+
+  /**
+   * Create the PQSearch object, train the codebooks on the given reference
+   * set, and add all of its points.
+   *
+   * @param referenceSet Set of reference points.
+   * @param subspaces Number of subspaces (bytes per point).
+   * @param centroids Number of centroids of the codebook of each subspace
+   *     (between 1 and 256).
+   * @param lists Number of coarse centroids (inverted lists); 1 gives plain
+   *     product quantization.
+   * @param probes Number of lists scanned by a search.
+   * @param maxIterations Maximum number of iterations of k-means.
+   */
+  PQSearch(const MatType& referenceSet,
+           const size_t subspaces = 8,
+           const size_t centroids = 256,
+           const size_t lists = 1,
+           const size_t probes = 1,
+           const size_t maxIterations = 25);
+
+  /**
+   * Learn the coarse centroids and the codebooks on the given points, which
+   * may be a sample of the reference set.  All points previously added are
+   * removed.
+   *
+   * @param trainingSet Set of points to learn the codebooks on.
+   */
+  void Train(const MatType& trainingSet);
+
+  /**
+   * Compress the given points and add them to the index.  Their indices are
+   * Size(), Size() + 1, and so on.
+   *
+   * @param points Set of points to add.
+   */
+  void Add(const MatType& points);
+
+  /**
+   * Find the approximate k nearest neighbors of each point of the query set,
+   * with the distances to the compressed points.  If fewer than k points are
+   * in the probed lists, the missing neighbors have the index SIZE_MAX and the
+   * distance DBL_MAX.
+   *
+   * @param querySet Set of query points.
+   * @param k Number of neighbors to search for.
+   * @param neighbors Matrix storing lists of neighbors for each query point.
+   * @param distances Matrix storing distances of neighbors for each query
+   *     point.
+   */
+  void Search(const MatType& querySet,
+              const size_t k,
+              arma::Mat<size_t>& neighbors,
+              arma::mat& distances) const;
+
+  /**
+   * Find the approximate k nearest neighbors of each point of the query set,
+   * re-ranking the best candidates with the exact distance to the original
+   * points.  The returned distances are exact.
+   *
+   * @param querySet Set of query points.
+   * @param referenceSet The original points, in the order they were added.
+   * @param k Number of neighbors to search for.
+   * @param candidates Number of candidates to re-rank (at least k).
+   * @param neighbors Matrix storing lists of neighbors for each query point.
+   * @param distances Matrix storing distances of neighbors for each query
+   *     point.
+   */
+  void Search(const MatType& querySet,
+              const MatType& referenceSet,
+              const size_t k,
+              const size_t candidates,
+              arma::Mat<size_t>& neighbors,
+              arma::mat& distances) const;
+
+  //! Get the number of subspaces.
+  size_t Subspaces() const { return subspaces; }
+  //! Get the number of centroids of each codebook.
+  size_t Centroids() const { return centroids; }
+  //! Get the number of lists.
+  size_t Lists() const { return lists; }
+  //! Get the number of lists scanned by a search.
+  size_t Probes() const { return probes; }
+  //! Modify the number of lists scanned by a search.
+  size_t& Probes() { return probes; }
+
+  //! Get the number of points in the index.
+  size_t Size() const { return size; }
+  //! Get the dimensionality of the points.
+  size_t Dimensionality() const { return coarseCentroids.n_rows; }
+
+  //! Get the coarse centroids (one per column).
+  const arma::mat& CoarseCentroids() const { return coarseCentroids; }
+  //! Get the codebook of the given subspace (one centroid per column).
+  const arma::mat& Codebook(const size_t subspace) const
+  { return codebooks[subspace]; }
+
+  //! Get the indices of the points of the given list.
+  const std::vector<size_t>& ListIndices(const size_t list) const
+  { return indices[list]; }
+  //! Get the codes of the points of the given list (Subspaces() per point).
+  const std::vector<unsigned char>& ListCodes(const size_t list) const
+  { return codes[list]; }
+
+  //! Serialize the index.
+  template<typename Archive>
+  void Serialize(Archive& ar, const unsigned int /* version */);
+
+ private:
+  //! A point and its (squared) distance to the query point.
+  typedef std::pair<double, size_t> Candidate;
+
+  //! Get the first dimension of the given subspace.
+  size_t SubspaceBegin(const size_t subspace) const;
+
+  //! Find the index of the closest column of the centroids to the point.
+  template<typename VecType>
+  static size_t Closest(const VecType& point, const arma::mat& centers);
+
+  /**
+   * Search all query points; if referenceSet is not NULL, the given number of
+   * candidates are re-ranked with the original points.
+   */
+  void SearchQueries(const MatType& querySet,
+                     const MatType* referenceSet,
+                     const size_t k,
+                     const size_t candidates,
+                     arma::Mat<size_t>& neighbors,
+                     arma::mat& distances) const;
+
+  /**
+   * Find the given number of best candidates for the given query point, with
+   * the squared distances to the compressed points, best first.
+   */
+  void SearchPoint(const arma::vec& query,
+                   const size_t wanted,
+                   std::vector<Candidate>& found) const;
+
+  //! Number of subspaces.
+  size_t subspaces;
+  //! Number of centroids of each codebook.
+  size_t centroids;
+  //! Number of lists.
+  size_t lists;
+  //! Number of lists scanned by a search.
+  size_t probes;
+  //! Maximum number of iterations of k-means.
+  size_t maxIterations;
+  //! The coarse centroids.
+  arma::mat coarseCentroids;
+  //! The codebook of each subspace.
+  std::vector<arma::mat> codebooks;
+  //! The indices of the points of each list.
+  std::vector<std::vector<size_t>> indices;
+  //! The codes of the points of each list, one byte per subspace.
+  std::vector<std::vector<unsigned char>> codes;
+  //! The number of points in the index.
+  size_t size;
+};
+
+} // namespace neighbor
+} // namespace mlpack
+
+// Include implementation.
+#include "pq_search_impl.hpp"
+
+#endif
@@ -0,0 +1,410 @@
+/**
+ * @file pq_search_impl.hpp
+ *
+ * Implementation of the PQSearch class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_NEIGHBOR_SEARCH_PQ_SEARCH_IMPL_HPP
+#define MLPACK_METHODS_NEIGHBOR_SEARCH_PQ_SEARCH_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "pq_search.hpp"
+
+namespace mlpack {
+namespace neighbor {
+
+template<typename MatType>
+PQSearch<MatType>::PQSearch(const size_t subspaces,
+                            const size_t centroids,
+                            const size_t lists,
+                            const size_t probes,
+                            const size_t maxIterations) :
+    subspaces(subspaces),
+    centroids(centroids),
+    lists(lists),
+    probes(probes),
+    maxIterations(maxIterations),
+    size(0)
+{
+  if (subspaces == 0)
+  {
+    throw std::invalid_argument("PQSearch::PQSearch(): the number of subspaces "
+        "must be positive");
+  }
+
+  if (centroids == 0 || centroids > 256)
+  {
+    std::ostringstream error;
+    error << "PQSearch::PQSearch(): the number of centroids (" << centroids
+        << ") must be between 1 and 256";
+    throw std::invalid_argument(error.str());
+  }
+
+  if (lists == 0)
+  {
+    throw std::invalid_argument("PQSearch::PQSearch(): the number of lists "
+        "must be positive");
+  }
+}
+
+template<typename MatType>
+PQSearch<MatType>::PQSearch(const MatType& referenceSet,
+                            const size_t subspaces,
+                            const size_t centroids,
+                            const size_t lists,
+                            const size_t probes,
+                            const size_t maxIterations) :
+    PQSearch(subspaces, centroids, lists, probes, maxIterations)
+{
+  Train(referenceSet);
+  Add(referenceSet);
+}
+
+template<typename MatType>
+void PQSearch<MatType>::Train(const MatType& trainingSet)
+{
+  if (subspaces > trainingSet.n_rows)
+  {
+    std::ostringstream error;
+    error << "PQSearch::Train(): the number of subspaces (" << subspaces
+        << ") is greater than the dimensionality of the points ("
+        << trainingSet.n_rows << ")";
+    throw std::invalid_argument(error.str());
+  }
+
+  if (trainingSet.n_cols < std::max(centroids, lists))
+  {
+    std::ostringstream error;
+    error << "PQSearch::Train(): the number of training points ("
+        << trainingSet.n_cols << ") must be at least the number of centroids ("
+        << centroids << ") and of lists (" << lists << ")";
+    throw std::invalid_argument(error.str());
+  }
+
+  Timer::Start("tree_building");
+
+  // The residuals of the points to their coarse centroid are quantized.
+  arma::mat residuals = arma::conv_to<arma::mat>::from(trainingSet);
+  kmeans::KMeans<> kmeans(maxIterations);
+  if (lists == 1)
+  {
+    coarseCentroids = arma::mean(residuals, 1);
+    residuals.each_col() -= coarseCentroids.col(0);
+  }
+  else
+  {
+    arma::Row<size_t> assignments;
+    kmeans.Cluster(residuals, lists, assignments, coarseCentroids);
+    for (size_t i = 0; i < residuals.n_cols; ++i)
+      residuals.col(i) -= coarseCentroids.col(assignments[i]);
+  }
+
+  codebooks.resize(subspaces);
+  for (size_t j = 0; j < subspaces; ++j)
+  {
+    const arma::mat subvectors = residuals.rows(SubspaceBegin(j),
+        SubspaceBegin(j + 1) - 1);
+    kmeans.Cluster(subvectors, centroids, codebooks[j]);
+  }
+
+  indices.clear();
+  indices.resize(lists);
+  codes.clear();
+  codes.resize(lists);
+  size = 0;
+
+  Timer::Stop("tree_building");
+}
+
+template<typename MatType>
+void PQSearch<MatType>::Add(const MatType& points)
+{
+  if (codebooks.empty() || points.n_rows != Dimensionality())
+  {
+    std::ostringstream error;
+    error << "PQSearch::Add(): the dimensionality of the points ("
+        << points.n_rows << ") doesn't match the dimensionality of the "
+        << "codebooks (" << Dimensionality() << "); was Train() called?";
+    throw std::invalid_argument(error.str());
+  }
+
+  Timer::Start("tree_building");
+
+  // The points are encoded in parallel, then appended to their lists in order.
+  std::vector<size_t> assignments(points.n_cols);
+  std::vector<unsigned char> pointCodes(points.n_cols * subspaces);
+
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables. If we're building for Visual Studio, use
+  // the intmax_t type instead.
+  #pragma omp parallel for schedule(static)
+  for (intmax_t i = 0; i < (intmax_t) points.n_cols; ++i)
+#else
+  #pragma omp parallel for schedule(static)
+  for (size_t i = 0; i < points.n_cols; ++i)
+#endif
+  {
+    arma::vec residual = arma::conv_to<arma::vec>::from(points.col(i));
+    assignments[i] = Closest(residual, coarseCentroids);
+    residual -= coarseCentroids.col(assignments[i]);
+
+    for (size_t j = 0; j < subspaces; ++j)
+    {
+      pointCodes[i * subspaces + j] = (unsigned char) Closest(
+          residual.subvec(SubspaceBegin(j), SubspaceBegin(j + 1) - 1),
+          codebooks[j]);
+    }
+  }
+
+  for (size_t i = 0; i < points.n_cols; ++i)
+  {
+    indices[assignments[i]].push_back(size + i);
+    codes[assignments[i]].insert(codes[assignments[i]].end(),
+        pointCodes.begin() + i * subspaces,
+        pointCodes.begin() + (i + 1) * subspaces);
+  }
+  size += points.n_cols;
+
+  Timer::Stop("tree_building");
+}
+
+template<typename MatType>
+void PQSearch<MatType>::Search(const MatType& querySet,
+                               const size_t k,
+                               arma::Mat<size_t>& neighbors,
+                               arma::mat& distances) const
+{
+  SearchQueries(querySet, NULL, k, k, neighbors, distances);
+}
+
+template<typename MatType>
+void PQSearch<MatType>::Search(const MatType& querySet,
+                               const MatType& referenceSet,
+                               const size_t k,
+                               const size_t candidates,
+                               arma::Mat<size_t>& neighbors,
+                               arma::mat& distances) const
+{
+  if (referenceSet.n_cols != size || referenceSet.n_rows != Dimensionality())
+  {
+    std::ostringstream error;
+    error << "PQSearch::Search(): the reference set (" << referenceSet.n_rows
+        << " x " << referenceSet.n_cols << ") doesn't match the indexed points "
+        << "(" << Dimensionality() << " x " << size << ")";
+    throw std::invalid_argument(error.str());
+  }
+
+  SearchQueries(querySet, &referenceSet, k, std::max(k, candidates),
+      neighbors, distances);
+}
+
+template<typename MatType>
+size_t PQSearch<MatType>::SubspaceBegin(const size_t subspace) const
+{
+  // The first (dimensionality % subspaces) subspaces have one more dimension.
+  const size_t dimensionality = coarseCentroids.n_rows;
+  return subspace * (dimensionality / subspaces) +
+      std::min(subspace, dimensionality % subspaces);
+}
+
+template<typename MatType>
+template<typename VecType>
+size_t PQSearch<MatType>::Closest(const VecType& point,
+                                  const arma::mat& centers)
+{
+  size_t closest = 0;
+  double closestDistance = DBL_MAX;
+  for (size_t c = 0; c < centers.n_cols; ++c)
+  {
+    const double distance = metric::SquaredEuclideanDistance::Evaluate(point,
+        centers.col(c));
+    if (distance < closestDistance)
+    {
+      closestDistance = distance;
+      closest = c;
+    }
+  }
+
+  return closest;
+}
+
+template<typename MatType>
+void PQSearch<MatType>::SearchQueries(const MatType& querySet,
+                                      const MatType* referenceSet,
+                                      const size_t k,
+                                      const size_t candidates,
+                                      arma::Mat<size_t>& neighbors,
+                                      arma::mat& distances) const
+{
+  if (k > size)
+  {
+    std::stringstream ss;
+    ss << "requested value of k (" << k << ") is greater than the number of "
+        << "points in the reference set (" << size << ")";
+    throw std::invalid_argument(ss.str());
+  }
+
+  if (querySet.n_rows != Dimensionality())
+  {
+    std::ostringstream error;
+    error << "PQSearch::Search(): the dimensionality of the query points ("
+        << querySet.n_rows << ") doesn't match the dimensionality of the "
+        << "reference points (" << Dimensionality() << ")";
+    throw std::invalid_argument(error.str());
+  }
+
+  Timer::Start("computing_neighbors");
+
+  neighbors.set_size(k, querySet.n_cols);
+  distances.set_size(k, querySet.n_cols);
+
+  #pragma omp parallel
+  {
+    std::vector<Candidate> found;
+
+#ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables. If we're building for Visual Studio,
+    // use the intmax_t type instead.
+    #pragma omp for schedule(dynamic, 16)
+    for (intmax_t i = 0; i < (intmax_t) querySet.n_cols; ++i)
+#else
+    #pragma omp for schedule(dynamic, 16)
+    for (size_t i = 0; i < querySet.n_cols; ++i)
+#endif
+    {
+      const arma::vec query = arma::conv_to<arma::vec>::from(querySet.col(i));
+      SearchPoint(query, candidates, found);
+
+      if (referenceSet)
+      {
+        // Re-rank the candidates with the original points, which are read
+        // one column at a time.
+        for (size_t j = 0; j < found.size(); ++j)
+        {
+          const typename MatType::elem_type* point =
+              referenceSet->colptr(found[j].second);
+          double distance = 0.0;
+          for (size_t d = 0; d < query.n_elem; ++d)
+          {
+            const double difference = query[d] - (double) point[d];
+            distance += difference * difference;
+          }
+          found[j].first = distance;
+        }
+        std::sort(found.begin(), found.end());
+      }
+
+      size_t count = 0;
+      for (; count < k && count < found.size(); ++count)
+      {
+        neighbors(count, i) = found[count].second;
+        distances(count, i) = std::sqrt(std::max(found[count].first, 0.0));
+      }
+
+      for (; count < k; ++count)
+      {
+        neighbors(count, i) = size_t() - 1;
+        distances(count, i) = DBL_MAX;
+      }
+    }
+  }
+
+  Timer::Stop("computing_neighbors");
+}
+
+template<typename MatType>
+void PQSearch<MatType>::SearchPoint(const arma::vec& query,
+                                    const size_t wanted,
+                                    std::vector<Candidate>& found) const
+{
+  found.clear();
+  if (wanted == 0)
+    return;
+
+  // Find the lists to scan.
+  std::vector<Candidate> closestLists(lists);
+  for (size_t l = 0; l < lists; ++l)
+  {
+    closestLists[l] = Candidate(metric::SquaredEuclideanDistance::Evaluate(
+        query, coarseCentroids.col(l)), l);
+  }
+  const size_t scanned = std::min(probes, lists);
+  std::partial_sort(closestLists.begin(), closestLists.begin() + scanned,
+      closestLists.end());
+
+  // The table holds the squared distances between the subvectors of the
+  // residual and the centroids, one subspace per column, so the distance to a
+  // point is the sum of one entry of each column.
+  arma::mat table(centroids, subspaces);
+  arma::vec residual;
+  for (size_t p = 0; p < scanned; ++p)
+  {
+    const size_t l = closestLists[p].second;
+    if (indices[l].empty())
+      continue;
+
+    residual = query - coarseCentroids.col(l);
+    for (size_t j = 0; j < subspaces; ++j)
+    {
+      const arma::vec subvector = residual.subvec(SubspaceBegin(j),
+          SubspaceBegin(j + 1) - 1);
+      table.col(j) = arma::sum(arma::square(
+          codebooks[j].each_col() - subvector), 0).t();
+    }
+
+    // Scan the codes, and keep the best candidates in a max-heap.
+    const double* tableMemory = table.memptr();
+    const unsigned char* code = codes[l].data();
+    const std::vector<size_t>& listIndices = indices[l];
+    for (size_t i = 0; i < listIndices.size(); ++i, code += subspaces)
+    {
+      double distance = 0.0;
+      for (size_t j = 0; j < subspaces; ++j)
+        distance += tableMemory[j * centroids + code[j]];
+
+      if (found.size() < wanted)
+      {
+        found.push_back(Candidate(distance, listIndices[i]));
+        std::push_heap(found.begin(), found.end());
+      }
+      else if (distance < found.front().first)
+      {
+        std::pop_heap(found.begin(), found.end());
+        found.back() = Candidate(distance, listIndices[i]);
+        std::push_heap(found.begin(), found.end());
+      }
+    }
+  }
+
+  std::sort_heap(found.begin(), found.end());
+}
+
+template<typename MatType>
+template<typename Archive>
+void PQSearch<MatType>::Serialize(Archive& ar,
+                                  const unsigned int /* version */)
+{
+  using data::CreateNVP;
+
+  ar & CreateNVP(subspaces, "subspaces");
+  ar & CreateNVP(centroids, "centroids");
+  ar & CreateNVP(lists, "lists");
+  ar & CreateNVP(probes, "probes");
+  ar & CreateNVP(maxIterations, "maxIterations");
+  ar & CreateNVP(coarseCentroids, "coarseCentroids");
+  ar & CreateNVP(codebooks, "codebooks");
+  ar & CreateNVP(indices, "indices");
+  ar & CreateNVP(codes, "codes");
+  ar & CreateNVP(size, "size");
+}
+
+} // namespace neighbor
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,168 @@
+/**
+ * @file sharded_neighbor_search.hpp
+ *
+ * Defines the ShardedNeighborSearch class, which performs neighbor search on a
+ * reference set that is split into several shards, each with its own tree.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_NEIGHBOR_SEARCH_SHARDED_NEIGHBOR_SEARCH_HPP
+#define MLPACK_METHODS_NEIGHBOR_SEARCH_SHARDED_NEIGHBOR_SEARCH_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/tree/hrectbound.hpp>
+#include "neighbor_search.hpp"
+#include "chunked_neighbor_search.hpp"
+
+namespace mlpack {
+namespace neighbor {
+
+/**
+ * The ShardedNeighborSearch class performs neighbor search on a reference set
+ * that is split into several shards.  A separate NeighborSearch object (and
+ * thus a separate tree) is built on each shard, and the points are numbered in
+ * the order of the shards, so the first point of the second shard has the index
+ * that follows the last point of the first shard.
+ *
+ * The bounding box of each shard is kept, and each query point is only sent to
+ * the shards that may hold one of its k best neighbors: using only the bounding
+ * boxes, an upper bound on the distance to the k'th best neighbor is found, and
+ * every shard whose bounding box is further away than that bound is pruned.
+ * The results of each shard are then merged into the final results.
+ *
+ * The routing is exposed through RouteQueries() so that it can be reused when
+ * the shards are held by different processes; see DistributedNeighborSearch.
+ *
+ * @code
+ * std::vector<arma::mat> shards = { shard0, shard1, shard2 };
+ * ShardedNeighborSearch<> knn(std::move(shards));
+ *
+ * arma::Mat<size_t> neighbors;
+ * arma::mat distances;
+ * knn.Search(querySet, 5, neighbors, distances);
+ * @endcode
+ *
+ * @tparam SortPolicy The sort policy for distances; see NearestNeighborSort.
+ * @tparam MetricType The metric to use for computation; this must be an
+ *     LMetric, so that the shards can be bounded with an HRectBound.
+ * @tparam MatType The type of data matrix.
+ * @tparam TreeType The tree type to build on each shard.
+ */
+template<typename SortPolicy = NearestNeighborSort,
+         typename MetricType = mlpack::metric::EuclideanDistance,
+         typename MatType = arma::mat,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType = tree::KDTree>
+class ShardedNeighborSearch
+{
+ public:
+  //! The type of NeighborSearch used to search each shard.
+  typedef NeighborSearch<SortPolicy, MetricType, MatType, TreeType>
+      ShardSearchType;
+  //! The type of element held in MatType.
+  typedef typename MatType::elem_type ElemType;
+  //! The type of bound used to route queries to shards.
+  typedef bound::HRectBound<MetricType, ElemType> BoundType;
+
+  /**
+   * Initialize the ShardedNeighborSearch object, building a tree on each of
+   * the given shards.  The shards are taken with std::move(), and they must
+   * all have the same dimensionality.  Empty shards are allowed and are
+   * simply never searched.
+   *
+   * @param shards Shards of the reference set, in order.
+   * @param mode Search mode to use on each shard (naive, single-tree,
+   *      dual-tree or greedy).
+   * @param epsilon Relative approximate error (non-negative).
+   * @param metric An optional instance of the MetricType class.
+   */
+  ShardedNeighborSearch(std::vector<MatType>&& shards,
+                        const NeighborSearchMode mode = DUAL_TREE_MODE,
+                        const double epsilon = 0,
+                        const MetricType metric = MetricType());
+
+  /**
+   * For each point in the query set, compute the nearest neighbors among the
+   * points of all shards, and store the output in the given matrices.  The
+   * matrices will be set to the size of n columns by k rows, where n is the
+   * number of points in the query set.  Neighbor indices refer to the
+   * concatenation of the shards.  A std::invalid_argument is thrown if the
+   * query set has the wrong dimensionality or there are fewer than k reference
+   * points in total.
+   *
+   * @param querySet Set of query points.
+   * @param k Number of neighbors to search for.
+   * @param neighbors Matrix storing lists of neighbors for each query point.
+   * @param distances Matrix storing distances of neighbors for each query
+   *     point.
+   */
+  void Search(const MatType& querySet,
+              const size_t k,
+              arma::Mat<size_t>& neighbors,
+              arma::mat& distances);
+
+  /**
+   * Decide which shards must be searched for each query point.  For each query
+   * point, the shards are sorted by the worst possible distance from the point
+   * to their bounding box, and the worst distance of the first shards that
+   * together hold k points is a bound on the distance to the k'th best
+   * neighbor.  Each shard whose best possible distance is not better than that
+   * bound can't hold any of the k best neighbors and is pruned.
+   *
+   * When this returns, routes[s] holds the indices of the query points that
+   * must be searched on shard s, in increasing order.
+   *
+   * @param querySet Set of query points.
+   * @param k Number of neighbors to search for.
+   * @param bounds Bounding box of each shard.
+   * @param sizes Number of points in each shard.
+   * @param routes Vector to store the query indices of each shard in.
+   */
+  static void RouteQueries(const MatType& querySet,
+                           const size_t k,
+                           const std::vector<BoundType>& bounds,
+                           const std::vector<size_t>& sizes,
+                           std::vector<std::vector<size_t>>& routes);
+
+  //! Get the number of shards.
+  size_t NumShards() const { return searchers.size(); }
+  //! Get the NeighborSearch object of the given shard.
+  const ShardSearchType& Shard(const size_t i) const { return searchers[i]; }
+  //! Get the bounding box of the given shard.
+  const BoundType& ShardBound(const size_t i) const { return bounds[i]; }
+  //! Get the index of the first point of the given shard.
+  size_t ShardOffset(const size_t i) const { return offsets[i]; }
+
+  //! Get the number of reference points over all shards.
+  size_t NumPoints() const { return numPoints; }
+
+ private:
+  //! The NeighborSearch object of each shard.
+  std::vector<ShardSearchType> searchers;
+  //! The bounding box of each shard.
+  std::vector<BoundType> bounds;
+  //! The number of points in each shard.
+  std::vector<size_t> sizes;
+  //! The index of the first point of each shard.
+  std::vector<size_t> offsets;
+  //! The number of reference points over all shards.
+  size_t numPoints;
+  //! The dimensionality of the reference points.
+  size_t dimensionality;
+};
+
+//! Sharded k-nearest-neighbor search with Euclidean distances.
+typedef ShardedNeighborSearch<NearestNeighborSort, metric::EuclideanDistance>
+    ShardedKNN;
+
+} // namespace neighbor
+} // namespace mlpack
+
+// Include implementation.
+#include "sharded_neighbor_search_impl.hpp"
+
+#endif
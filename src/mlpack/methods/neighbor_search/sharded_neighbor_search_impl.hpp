@@ -0,0 +1,198 @@
+/**
+ * @file sharded_neighbor_search_impl.hpp
+ *
+ * Implementation of the ShardedNeighborSearch class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_NEIGHBOR_SEARCH_SHARDED_NEIGHBOR_SEARCH_IMPL_HPP
+#define MLPACK_METHODS_NEIGHBOR_SEARCH_SHARDED_NEIGHBOR_SEARCH_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "sharded_neighbor_search.hpp"
+
+namespace mlpack {
+namespace neighbor {
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+ShardedNeighborSearch<SortPolicy, MetricType, MatType, TreeType>::
+ShardedNeighborSearch(std::vector<MatType>&& shards,
+                      const NeighborSearchMode mode,
+                      const double epsilon,
+                      const MetricType metric) :
+    numPoints(0),
+    dimensionality(shards.empty() ? 0 : shards[0].n_rows)
+{
+  if (epsilon < 0)
+    throw std::invalid_argument("epsilon must be non-negative");
+
+  searchers.reserve(shards.size());
+  for (size_t i = 0; i < shards.size(); ++i)
+  {
+    if (shards[i].n_rows != dimensionality)
+    {
+      std::ostringstream oss;
+      oss << "ShardedNeighborSearch: shard " << i << " has dimensionality "
+          << shards[i].n_rows << ", but shard 0 has dimensionality "
+          << dimensionality;
+      throw std::invalid_argument(oss.str());
+    }
+
+    BoundType bound(dimensionality);
+    bound |= shards[i];
+    bounds.push_back(std::move(bound));
+
+    sizes.push_back(shards[i].n_cols);
+    offsets.push_back(numPoints);
+    numPoints += shards[i].n_cols;
+
+    // No tree can be built on an empty shard, but it is never searched anyway.
+    if (shards[i].n_cols == 0)
+      searchers.emplace_back(mode, epsilon, metric);
+    else
+      searchers.emplace_back(std::move(shards[i]), mode, epsilon, metric);
+  }
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void ShardedNeighborSearch<SortPolicy, MetricType, MatType, TreeType>::Search(
+    const MatType& querySet,
+    const size_t k,
+    arma::Mat<size_t>& neighbors,
+    arma::mat& distances)
+{
+  if (querySet.n_rows != dimensionality)
+  {
+    std::ostringstream oss;
+    oss << "ShardedNeighborSearch::Search(): query set has dimensionality "
+        << querySet.n_rows << ", but the reference shards have dimensionality "
+        << dimensionality;
+    throw std::invalid_argument(oss.str());
+  }
+
+  if (k > numPoints)
+  {
+    std::ostringstream oss;
+    oss << "ShardedNeighborSearch::Search(): requested " << k << " neighbors, "
+        << "but the reference shards only hold " << numPoints << " points";
+    throw std::invalid_argument(oss.str());
+  }
+
+  // Initialize the results; every candidate is worse than any real neighbor.
+  neighbors.set_size(k, querySet.n_cols);
+  neighbors.fill(size_t() - 1);
+  distances.set_size(k, querySet.n_cols);
+  distances.fill(SortPolicy::WorstDistance());
+
+  std::vector<std::vector<size_t>> routes;
+  RouteQueries(querySet, k, bounds, sizes, routes);
+
+  for (size_t s = 0; s < searchers.size(); ++s)
+  {
+    if (routes[s].empty())
+      continue;
+
+    Log::Info << "Searching " << routes[s].size() << " query points on shard "
+        << s << " (" << sizes[s] << " points)." << std::endl;
+
+    const arma::uvec indices = arma::conv_to<arma::uvec>::from(routes[s]);
+    const MatType shardQuerySet = querySet.cols(indices);
+
+    arma::Mat<size_t> shardNeighbors;
+    arma::mat shardDistances;
+    searchers[s].Search(shardQuerySet, std::min(k, sizes[s]), shardNeighbors,
+        shardDistances);
+
+    // Merge into the running results of the routed query points only.
+    arma::Mat<size_t> routedNeighbors = neighbors.cols(indices);
+    arma::mat routedDistances = distances.cols(indices);
+    ChunkedNeighborSearch<SortPolicy, MetricType, MatType, TreeType>::
+        MergeResults(routedNeighbors, routedDistances, shardNeighbors,
+        shardDistances, offsets[s]);
+    neighbors.cols(indices) = routedNeighbors;
+    distances.cols(indices) = routedDistances;
+  }
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void ShardedNeighborSearch<SortPolicy, MetricType, MatType, TreeType>::
+RouteQueries(const MatType& querySet,
+             const size_t k,
+             const std::vector<BoundType>& bounds,
+             const std::vector<size_t>& sizes,
+             std::vector<std::vector<size_t>>& routes)
+{
+  routes.clear();
+  routes.resize(bounds.size());
+
+  // (worst distance, shard) pairs for the current query point.
+  std::vector<std::pair<double, size_t>> worst;
+  std::vector<double> best(bounds.size());
+  for (size_t q = 0; q < querySet.n_cols; ++q)
+  {
+    worst.clear();
+    for (size_t s = 0; s < bounds.size(); ++s)
+    {
+      if (sizes[s] == 0)
+        continue;
+
+      // Which end of the range is the best depends on the sort policy.
+      const math::RangeType<ElemType> range =
+          bounds[s].RangeDistance(querySet.col(q));
+      const bool loIsBest = SortPolicy::IsBetter(range.Lo(), range.Hi());
+      best[s] = loIsBest ? range.Lo() : range.Hi();
+      worst.push_back(std::make_pair(loIsBest ? range.Hi() : range.Lo(), s));
+    }
+
+    std::sort(worst.begin(), worst.end(),
+        [](const std::pair<double, size_t>& a,
+           const std::pair<double, size_t>& b)
+        {
+          return SortPolicy::IsBetter(a.first, b.first) && a.first != b.first;
+        });
+
+    // The k best neighbors are no worse than the worst distance to the first
+    // shards that together hold k points.
+    double kthBound = SortPolicy::WorstDistance();
+    size_t count = 0;
+    for (size_t i = 0; i < worst.size(); ++i)
+    {
+      count += sizes[worst[i].second];
+      if (count >= k)
+      {
+        kthBound = worst[i].first;
+        break;
+      }
+    }
+
+    for (size_t i = 0; i < worst.size(); ++i)
+    {
+      const size_t s = worst[i].second;
+      if (SortPolicy::IsBetter(best[s], kthBound))
+        routes[s].push_back(q);
+    }
+  }
+}
+
+} // namespace neighbor
+} // namespace mlpack
+
+#endif
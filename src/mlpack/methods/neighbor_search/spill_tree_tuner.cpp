@@ -0,0 +1,151 @@
+/**
+ * @file spill_tree_tuner.cpp
+ *
+ * Implementation of the SpillTreeTuner class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "spill_tree_tuner.hpp"
+
+#include <chrono>
+
+namespace mlpack {
+namespace neighbor {
+
+SpillTreeTuner::SpillTreeTuner(const double targetRecall,
+                               const size_t sampleSize,
+                               const double rho) :
+    targetRecall(targetRecall),
+    sampleSize(sampleSize),
+    rho(rho),
+    tau(0),
+    leafSize(20),
+    recall(0),
+    searchTime(0)
+{
+  if (targetRecall <= 0 || targetRecall > 1)
+    throw std::invalid_argument("SpillTreeTuner: target recall must be in the "
+        "range (0, 1]");
+  if (sampleSize == 0)
+    throw std::invalid_argument("SpillTreeTuner: sample size must be greater "
+        "than 0");
+  if (rho < 0 || rho > 1)
+    throw std::invalid_argument("SpillTreeTuner: rho must be in the range "
+        "[0, 1]");
+}
+
+void SpillTreeTuner::Tune(const arma::mat& referenceSet,
+                          const arma::mat& querySet,
+                          const size_t k)
+{
+  if (k == 0 || k > referenceSet.n_cols)
+  {
+    std::ostringstream oss;
+    oss << "SpillTreeTuner::Tune(): invalid k " << k << "; must be greater "
+        << "than 0 and less than or equal to the number of reference points ("
+        << referenceSet.n_cols << ")";
+    throw std::invalid_argument(oss.str());
+  }
+  if (querySet.n_cols == 0)
+    throw std::invalid_argument("SpillTreeTuner::Tune(): query set is empty");
+  if (querySet.n_rows != referenceSet.n_rows)
+    throw std::invalid_argument("SpillTreeTuner::Tune(): query set and "
+        "reference set must have the same dimensionality");
+
+  // Take a random sample of the query points.
+  arma::mat sample;
+  if (querySet.n_cols <= sampleSize)
+  {
+    sample = querySet;
+  }
+  else
+  {
+    const arma::uvec order = arma::shuffle(arma::linspace<arma::uvec>(0,
+        querySet.n_cols - 1, querySet.n_cols));
+    sample = querySet.cols(order.head(sampleSize));
+  }
+
+  // Find the true neighbors of the sample.
+  arma::Mat<size_t> trueNeighbors;
+  arma::mat trueDistances;
+  KNN exact(referenceSet);
+  exact.Search(sample, k, trueNeighbors, trueDistances);
+
+  std::vector<double> candidateTaus = taus;
+  if (candidateTaus.empty())
+  {
+    const arma::rowvec kthDistances = trueDistances.row(k - 1);
+    const double scale = arma::median(kthDistances);
+    const double factors[] = { 0.0, 0.25, 0.5, 1.0, 2.0, 4.0 };
+    for (size_t i = 0; i < 6; ++i)
+      candidateTaus.push_back(factors[i] * scale);
+  }
+  std::sort(candidateTaus.begin(), candidateTaus.end());
+  if (candidateTaus[0] < 0)
+    throw std::invalid_argument("SpillTreeTuner::Tune(): candidate taus must "
+        "be non-negative");
+
+  std::vector<size_t> candidateLeafSizes = leafSizes;
+  if (candidateLeafSizes.empty())
+    candidateLeafSizes = { 10, 20, 40, 80 };
+  for (size_t i = 0; i < candidateLeafSizes.size(); ++i)
+    if (candidateLeafSizes[i] == 0)
+      throw std::invalid_argument("SpillTreeTuner::Tune(): candidate leaf "
+          "sizes must be greater than 0");
+
+  bool reached = false;
+  recall = -1.0;
+  for (size_t l = 0; l < candidateLeafSizes.size(); ++l)
+  {
+    for (size_t t = 0; t < candidateTaus.size(); ++t)
+    {
+      SpillKNN::Tree tree(referenceSet, candidateTaus[t],
+          candidateLeafSizes[l], rho);
+      SpillKNN search(std::move(tree), SINGLE_TREE_MODE);
+
+      arma::Mat<size_t> neighbors;
+      arma::mat distances;
+      const std::chrono::steady_clock::time_point start =
+          std::chrono::steady_clock::now();
+      search.Search(sample, k, neighbors, distances);
+      const double time = std::chrono::duration<double>(
+          std::chrono::steady_clock::now() - start).count();
+
+      const double candidateRecall = SpillKNN::Recall(neighbors,
+          trueNeighbors);
+
+      Log::Info << "Spill tree with tau " << candidateTaus[t] << " and leaf "
+          << "size " << candidateLeafSizes[l] << ": recall " << candidateRecall
+          << ", search time " << time << "s." << std::endl;
+
+      const bool candidateReached = (candidateRecall >= targetRecall);
+      const bool better = candidateReached ? (!reached || time < searchTime) :
+          (!reached && (candidateRecall > recall ||
+          (candidateRecall == recall && time < searchTime)));
+      if (better)
+      {
+        reached = candidateReached;
+        tau = candidateTaus[t];
+        leafSize = candidateLeafSizes[l];
+        recall = candidateRecall;
+        searchTime = time;
+      }
+
+      // A larger tau can only make the search slower.
+      if (candidateReached)
+        break;
+    }
+  }
+
+  if (!reached)
+    Log::Warn << "SpillTreeTuner::Tune(): no candidate reached the target "
+        << "recall " << targetRecall << "; using tau " << tau << " and leaf "
+        << "size " << leafSize << ", with recall " << recall << "."
+        << std::endl;
+}
+
+} // namespace neighbor
+} // namespace mlpack
@@ -0,0 +1,145 @@
+/**
+ * @file spill_tree_tuner.hpp
+ *
+ * Defines the SpillTreeTuner class, which chooses the overlap (tau) and the
+ * leaf size of a spill tree so that defeatist search reaches a target recall
+ * as fast as possible.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_NEIGHBOR_SEARCH_SPILL_TREE_TUNER_HPP
+#define MLPACK_METHODS_NEIGHBOR_SEARCH_SPILL_TREE_TUNER_HPP
+
+#include <mlpack/prereqs.hpp>
+#include "neighbor_search.hpp"
+
+namespace mlpack {
+namespace neighbor {
+
+/**
+ * The SpillTreeTuner class chooses the overlap size (tau) and the leaf size of
+ * a spill tree for approximate k-nearest-neighbor search with SpillKNN.  A
+ * larger overlap gives a higher recall but a slower search, so the
+ * parameters must usually be tuned by hand; this class does the tuning
+ * automatically, using a random sample of the query points.
+ *
+ * The true neighbors of the sample are found once with exact search.  Then,
+ * for each candidate pair of tau and leaf size, a spill tree is built, the
+ * sample is searched with single-tree defeatist search (which handles the
+ * query points in parallel when OpenMP is available), and the recall and the
+ * search time are measured.  The fastest pair whose recall reaches the target
+ * is chosen.  If no pair reaches the target, the pair with the highest recall
+ * is chosen and a warning is issued.  For each leaf size, the candidate taus
+ * are tried in increasing order, and no larger tau is tried once one reaches
+ * the target, since it could only be slower.
+ *
+ * If no candidate taus are given, they are set to multiples (0, 0.25, 0.5, 1,
+ * 2 and 4) of the median distance from a sample point to its k'th nearest
+ * neighbor.  If no candidate leaf sizes are given, 10, 20, 40 and 80 are used.
+ *
+ * @code
+ * SpillTreeTuner tuner(0.95);
+ * tuner.Tune(referenceSet, querySet, 5);
+ *
+ * SpillKNN::Tree tree(referenceSet, tuner.Tau(), tuner.LeafSize());
+ * SpillKNN knn(std::move(tree), SINGLE_TREE_MODE);
+ * knn.Search(querySet, 5, neighbors, distances);
+ * @endcode
+ */
+class SpillTreeTuner
+{
+ public:
+  /**
+   * Create the tuner.  A std::invalid_argument is thrown if the target recall
+   * is not in (0, 1], if the sample size is 0, or if rho is not in [0, 1].
+   *
+   * @param targetRecall Recall that the chosen parameters should reach.
+   * @param sampleSize Maximum number of query points to tune on.
+   * @param rho Balance threshold of the spill trees that are built.
+   */
+  SpillTreeTuner(const double targetRecall = 0.95,
+                 const size_t sampleSize = 1000,
+                 const double rho = 0.7);
+
+  /**
+   * Choose tau and the leaf size for searching the k nearest neighbors of
+   * points like those in the query set among the points of the reference set.
+   * The chosen parameters can then be obtained with Tau() and LeafSize().  A
+   * std::invalid_argument is thrown if k is 0 or larger than the number of
+   * reference points, if the query set is empty, if the dimensionalities of
+   * the sets differ, or if a candidate tau is negative or a candidate leaf
+   * size is 0.
+   *
+   * @param referenceSet Set of reference points.
+   * @param querySet Set of query points to sample from (this may be the
+   *     reference set).
+   * @param k Number of neighbors to search for.
+   */
+  void Tune(const arma::mat& referenceSet,
+            const arma::mat& querySet,
+            const size_t k);
+
+  //! Get the target recall.
+  double TargetRecall() const { return targetRecall; }
+  //! Modify the target recall.
+  double& TargetRecall() { return targetRecall; }
+
+  //! Get the maximum number of sampled query points.
+  size_t SampleSize() const { return sampleSize; }
+  //! Modify the maximum number of sampled query points.
+  size_t& SampleSize() { return sampleSize; }
+
+  //! Get the balance threshold.
+  double Rho() const { return rho; }
+  //! Modify the balance threshold.
+  double& Rho() { return rho; }
+
+  //! Get the candidate taus (if empty, they are chosen by Tune()).
+  const std::vector<double>& Taus() const { return taus; }
+  //! Modify the candidate taus (if empty, they are chosen by Tune()).
+  std::vector<double>& Taus() { return taus; }
+
+  //! Get the candidate leaf sizes (if empty, the defaults are used).
+  const std::vector<size_t>& LeafSizes() const { return leafSizes; }
+  //! Modify the candidate leaf sizes (if empty, the defaults are used).
+  std::vector<size_t>& LeafSizes() { return leafSizes; }
+
+  //! Get the tau chosen by the last call to Tune().
+  double Tau() const { return tau; }
+  //! Get the leaf size chosen by the last call to Tune().
+  size_t LeafSize() const { return leafSize; }
+  //! Get the recall on the sample with the chosen parameters.
+  double Recall() const { return recall; }
+  //! Get the time (in seconds) taken to search the sample with the chosen
+  //! parameters.
+  double SearchTime() const { return searchTime; }
+
+ private:
+  //! The recall that the chosen parameters should reach.
+  double targetRecall;
+  //! The maximum number of sampled query points.
+  size_t sampleSize;
+  //! The balance threshold of the spill trees.
+  double rho;
+  //! The candidate taus.
+  std::vector<double> taus;
+  //! The candidate leaf sizes.
+  std::vector<size_t> leafSizes;
+
+  //! The chosen tau.
+  double tau;
+  //! The chosen leaf size.
+  size_t leafSize;
+  //! The recall with the chosen parameters.
+  double recall;
+  //! The search time with the chosen parameters.
+  double searchTime;
+};
+
+} // namespace neighbor
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,131 @@
+/**
+ * @file transformed_neighbor_search.hpp
+ *
+ * Defines the TransformedNeighborSearch class, which performs neighbor search
+ * with a metric that is the Euclidean distance after a transformation of the
+ * points (such as the Mahalanobis distance), on transformed data.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_NEIGHBOR_SEARCH_TRANSFORMED_NEIGHBOR_SEARCH_HPP
+#define MLPACK_METHODS_NEIGHBOR_SEARCH_TRANSFORMED_NEIGHBOR_SEARCH_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/metrics/euclidean_transform.hpp>
+#include "neighbor_search.hpp"
+
+namespace mlpack {
+namespace neighbor {
+
+/**
+ * The TransformedNeighborSearch class performs neighbor search with a metric
+ * that has a metric::EuclideanTransform, such as the Mahalanobis distance
+ * (for instance with the matrix learned by NCA) or the metric induced by the
+ * cosine distance.  The reference set is transformed once when the object is
+ * built, and each query set when it is searched; the search itself is then a
+ * NeighborSearch with the Euclidean distance, which costs O(d) per distance
+ * evaluation instead of O(d^2) for the Mahalanobis distance, and can use the
+ * trees that need an LMetric (such as the default kd-tree).  The neighbors and
+ * distances are the same as with the original metric.
+ *
+ * @code
+ * metric::MahalanobisDistance<> mahalanobis(q);
+ * TransformedNeighborSearch<> knn(referenceSet, mahalanobis);
+ *
+ * arma::Mat<size_t> neighbors;
+ * arma::mat distances;
+ * knn.Search(querySet, 5, neighbors, distances);
+ * @endcode
+ *
+ * @tparam SortPolicy The sort policy for distances; see NearestNeighborSort.
+ * @tparam OriginalMetricType The metric to search with.
+ * @tparam TreeType The tree type to use on the transformed points.
+ */
+template<typename SortPolicy = NearestNeighborSort,
+         typename OriginalMetricType = metric::MahalanobisDistance<>,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType = tree::KDTree>
+class TransformedNeighborSearch
+{
+ public:
+  //! The transformation of the points.
+  typedef metric::EuclideanTransform<OriginalMetricType> TransformType;
+
+  static_assert(TransformType::IsTransformable, "TransformedNeighborSearch "
+      "needs a metric with a metric::EuclideanTransform.");
+
+  //! The type of NeighborSearch used on the transformed points.
+  typedef NeighborSearch<SortPolicy, typename TransformType::MetricType,
+      arma::mat, TreeType> SearchType;
+
+  /**
+   * Transform the given reference set and build the search on it.
+   *
+   * @param referenceSet Set of reference points.
+   * @param metric Metric to search with.
+   * @param mode Neighbor search mode.
+   * @param epsilon Relative approximate error (non-negative).
+   */
+  TransformedNeighborSearch(arma::mat referenceSet,
+                            const OriginalMetricType& metric,
+                            const NeighborSearchMode mode = DUAL_TREE_MODE,
+                            const double epsilon = 0);
+
+  /**
+   * For each point in the query set, compute the nearest neighbors with the
+   * original metric, and store the output in the given matrices, as
+   * NeighborSearch::Search() does.  The query set is transformed first.
+   *
+   * @param querySet Set of query points.
+   * @param k Number of neighbors to search for.
+   * @param neighbors Matrix storing lists of neighbors for each query point.
+   * @param distances Matrix storing distances of neighbors for each query
+   *     point.
+   */
+  void Search(const arma::mat& querySet,
+              const size_t k,
+              arma::Mat<size_t>& neighbors,
+              arma::mat& distances);
+
+  /**
+   * Search for the nearest neighbors of every point in the reference set, as
+   * NeighborSearch::Search() does.
+   *
+   * @param k Number of neighbors to search for.
+   * @param neighbors Matrix storing lists of neighbors for each query point.
+   * @param distances Matrix storing distances of neighbors for each query
+   *     point.
+   */
+  void Search(const size_t k,
+              arma::Mat<size_t>& neighbors,
+              arma::mat& distances);
+
+  //! Get the transformation of the points.
+  const TransformType& Transform() const { return transform; }
+
+  //! Get the search on the transformed points.
+  const SearchType& Searcher() const { return search; }
+  //! Modify the search on the transformed points.
+  SearchType& Searcher() { return search; }
+
+ private:
+  //! The transformation of the points.
+  TransformType transform;
+  //! The search on the transformed points.
+  SearchType search;
+
+  //! Transform the given points and return them.
+  arma::mat Transformed(arma::mat points) const;
+};
+
+} // namespace neighbor
+} // namespace mlpack
+
+// Include implementation.
+#include "transformed_neighbor_search_impl.hpp"
+
+#endif
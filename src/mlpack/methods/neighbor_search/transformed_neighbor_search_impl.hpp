@@ -0,0 +1,78 @@
+/**
+ * @file transformed_neighbor_search_impl.hpp
+ *
+ * Implementation of the TransformedNeighborSearch class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_NEIGHBOR_SEARCH_TRANSFORMED_NEIGHBOR_SEARCH_IMPL_HPP
+#define MLPACK_METHODS_NEIGHBOR_SEARCH_TRANSFORMED_NEIGHBOR_SEARCH_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "transformed_neighbor_search.hpp"
+
+namespace mlpack {
+namespace neighbor {
+
+template<typename SortPolicy,
+         typename OriginalMetricType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+TransformedNeighborSearch<SortPolicy, OriginalMetricType, TreeType>::
+TransformedNeighborSearch(arma::mat referenceSet,
+                          const OriginalMetricType& metric,
+                          const NeighborSearchMode mode,
+                          const double epsilon) :
+    transform(metric),
+    search(Transformed(std::move(referenceSet)), mode, epsilon)
+{
+  // Nothing to do.
+}
+
+template<typename SortPolicy,
+         typename OriginalMetricType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void TransformedNeighborSearch<SortPolicy, OriginalMetricType, TreeType>::
+Search(const arma::mat& querySet,
+       const size_t k,
+       arma::Mat<size_t>& neighbors,
+       arma::mat& distances)
+{
+  search.Search(Transformed(querySet), k, neighbors, distances);
+}
+
+template<typename SortPolicy,
+         typename OriginalMetricType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void TransformedNeighborSearch<SortPolicy, OriginalMetricType, TreeType>::
+Search(const size_t k,
+       arma::Mat<size_t>& neighbors,
+       arma::mat& distances)
+{
+  search.Search(k, neighbors, distances);
+}
+
+template<typename SortPolicy,
+         typename OriginalMetricType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+arma::mat TransformedNeighborSearch<SortPolicy, OriginalMetricType, TreeType>::
+Transformed(arma::mat points) const
+{
+  transform.Apply(points);
+  return points;
+}
+
+} // namespace neighbor
+} // namespace mlpack
+
+#endif
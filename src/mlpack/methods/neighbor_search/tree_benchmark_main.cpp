@@ -0,0 +1,352 @@
+/**
+ * @file tree_benchmark_main.cpp
+ *
+ * A benchmark that compares the tree types available for k-nearest-neighbor
+ * search: for each tree type, the build time, the size of the tree, the query
+ * latency and the number of base cases and node scores are measured.  The
+ * results can be saved and compared against the results of an earlier run to
+ * catch performance regressions.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/util/cli.hpp>
+
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <string>
+
+#include "ns_model.hpp"
+
+using namespace std;
+using namespace mlpack;
+using namespace mlpack::neighbor;
+
+// Convenience typedef.
+typedef NSModel<NearestNeighborSort> KNNModel;
+
+PROGRAM_INFO("Tree Benchmark",
+    "This program compares the tree types that can be used for "
+    "k-nearest-neighbor search.  For each tree type, a tree is built on the "
+    "reference set and the k nearest neighbors of each query point are "
+    "searched; the following are then reported:"
+    "\n\n"
+    " - the time taken to build the tree (build_time, in seconds),\n"
+    " - the number of nodes of the tree (nodes),\n"
+    " - the bytes taken by the node objects (memory; memory allocated by the "
+    "nodes themselves, like the point lists of rectangle trees, is not "
+    "counted),\n"
+    " - the search time per query point (query_time, in seconds),\n"
+    " - the number of base cases per query point (base_cases),\n"
+    " - the number of node scores per query point (scores)."
+    "\n\n"
+    "Builds and searches are repeated --trials (-T) times and the fastest time "
+    "is reported.  If no reference set is given, a uniformly random one with "
+    "--points (-p) points in --dimensions (-d) dimensions is generated; if no "
+    "query set is given, the reference set is used.  The tree types to "
+    "benchmark are given with --tree_types (-t); by default, all of 'kd', "
+    "'vp', 'rp', 'max-rp', 'ub', 'cover', 'r', 'r-star', 'x', 'ball', "
+    "'hilbert-r', 'r-plus', 'r-plus-plus', 'spill' and 'oct' are used."
+    "\n\n"
+    "The results are printed and can be saved as CSV with --output_file (-o).  "
+    "If the results of an earlier run are given with --baseline_file (-B), "
+    "every measurement that is more than --tolerance (-x) worse than in the "
+    "baseline is reported as a regression, and the program fails if there "
+    "are any regressions.  For example, the following saves a baseline and "
+    "then checks a later build against it:"
+    "\n\n"
+    "$ mlpack_tree_benchmark --reference_file=data.csv --output_file=base.csv\n"
+    "$ mlpack_tree_benchmark --reference_file=data.csv --baseline_file=base.csv"
+    " --tolerance=0.2");
+
+PARAM_MATRIX_IN("reference", "Matrix containing the reference dataset.", "r");
+PARAM_MATRIX_IN("query", "Matrix containing query points (optional).", "q");
+PARAM_INT_IN("points", "Number of points of the random reference set, if no "
+    "reference set is given.", "p", 10000);
+PARAM_INT_IN("dimensions", "Dimensionality of the random reference set, if no "
+    "reference set is given.", "d", 3);
+
+PARAM_VECTOR_IN(string, "tree_types", "Tree types to benchmark (by default, "
+    "all of them).", "t");
+PARAM_INT_IN("k", "Number of nearest neighbors to find.", "k", 5);
+PARAM_INT_IN("leaf_size", "Leaf size for tree building (used for all tree "
+    "types except cover trees).", "l", 20);
+PARAM_STRING_IN("algorithm", "Type of neighbor search: 'single_tree', "
+    "'dual_tree', 'greedy'.", "a", "dual_tree");
+PARAM_INT_IN("trials", "Number of times each build and search is repeated.",
+    "T", 3);
+
+PARAM_STRING_IN("output_file", "File to save the results to (CSV).", "o", "");
+PARAM_STRING_IN("baseline_file", "File holding the results of an earlier run, "
+    "to check for regressions.", "B", "");
+PARAM_DOUBLE_IN("tolerance", "Relative increase of a measurement over the "
+    "baseline that is reported as a regression.", "x", 0.2);
+PARAM_INT_IN("seed", "Random seed (if 0, std::time(NULL) is used).", "s", 0);
+
+// The names of the measurements, in the order they are saved in.
+static const char* metricNames[] = { "build_time", "nodes", "memory",
+    "query_time", "base_cases", "scores" };
+static const size_t numMetrics = 6;
+
+// Map the name of a tree type to its KNNModel::TreeTypes value.
+static bool GetTreeType(const string& name, KNNModel::TreeTypes& type)
+{
+  static const map<string, KNNModel::TreeTypes> types = {
+      { "kd", KNNModel::KD_TREE }, { "vp", KNNModel::VP_TREE },
+      { "rp", KNNModel::RP_TREE }, { "max-rp", KNNModel::MAX_RP_TREE },
+      { "ub", KNNModel::UB_TREE }, { "cover", KNNModel::COVER_TREE },
+      { "r", KNNModel::R_TREE }, { "r-star", KNNModel::R_STAR_TREE },
+      { "x", KNNModel::X_TREE }, { "ball", KNNModel::BALL_TREE },
+      { "hilbert-r", KNNModel::HILBERT_R_TREE },
+      { "r-plus", KNNModel::R_PLUS_TREE },
+      { "r-plus-plus", KNNModel::R_PLUS_PLUS_TREE },
+      { "spill", KNNModel::SPILL_TREE }, { "oct", KNNModel::OCTREE } };
+
+  map<string, KNNModel::TreeTypes>::const_iterator it = types.find(name);
+  if (it == types.end())
+    return false;
+
+  type = it->second;
+  return true;
+}
+
+// Return the number of seconds since the given time.
+static double SecondsSince(const chrono::steady_clock::time_point& start)
+{
+  return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv)
+{
+  CLI::ParseCommandLine(argc, argv);
+
+  if (CLI::GetParam<int>("seed") != 0)
+    math::RandomSeed((size_t) CLI::GetParam<int>("seed"));
+  else
+    math::RandomSeed((size_t) std::time(NULL));
+
+  // Sanity checks on the parameters.
+  const int k = CLI::GetParam<int>("k");
+  if (k < 1)
+    Log::Fatal << "Invalid k: " << k << ".  Must be greater than 0." << endl;
+
+  const int leafSize = CLI::GetParam<int>("leaf_size");
+  if (leafSize < 1)
+    Log::Fatal << "Invalid leaf size: " << leafSize << ".  Must be greater "
+        << "than 0." << endl;
+
+  const int trials = CLI::GetParam<int>("trials");
+  if (trials < 1)
+    Log::Fatal << "Invalid number of trials: " << trials << ".  Must be "
+        << "greater than 0." << endl;
+
+  const double tolerance = CLI::GetParam<double>("tolerance");
+  if (tolerance < 0)
+    Log::Fatal << "Invalid tolerance: " << tolerance << ".  Must be "
+        << "non-negative." << endl;
+
+  const string algorithm = CLI::GetParam<string>("algorithm");
+  NeighborSearchMode searchMode = DUAL_TREE_MODE;
+  if (algorithm == "single_tree")
+    searchMode = SINGLE_TREE_MODE;
+  else if (algorithm == "dual_tree")
+    searchMode = DUAL_TREE_MODE;
+  else if (algorithm == "greedy")
+    searchMode = GREEDY_SINGLE_TREE_MODE;
+  else
+    Log::Fatal << "Unknown neighbor search algorithm '" << algorithm << "'; "
+        << "valid choices are 'single_tree', 'dual_tree' and 'greedy'." << endl;
+
+  vector<string> treeNames = CLI::GetParam<vector<string>>("tree_types");
+  if (treeNames.empty())
+    treeNames = { "kd", "vp", "rp", "max-rp", "ub", "cover", "r", "r-star",
+        "x", "ball", "hilbert-r", "r-plus", "r-plus-plus", "spill", "oct" };
+
+  vector<KNNModel::TreeTypes> treeTypes(treeNames.size());
+  for (size_t i = 0; i < treeNames.size(); ++i)
+    if (!GetTreeType(treeNames[i], treeTypes[i]))
+      Log::Fatal << "Unknown tree type '" << treeNames[i] << "'; valid choices "
+          << "are 'kd', 'vp', 'rp', 'max-rp', 'ub', 'cover', 'r', 'r-star', "
+          << "'x', 'ball', 'hilbert-r', 'r-plus', 'r-plus-plus', 'spill', and "
+          << "'oct'." << endl;
+
+  // Load or generate the data.
+  arma::mat referenceSet;
+  if (CLI::HasParam("reference"))
+  {
+    referenceSet = std::move(CLI::GetParam<arma::mat>("reference"));
+  }
+  else
+  {
+    const int points = CLI::GetParam<int>("points");
+    const int dimensions = CLI::GetParam<int>("dimensions");
+    if (points < 1 || dimensions < 1)
+      Log::Fatal << "Invalid random reference set size: " << dimensions << " x "
+          << points << ".  --points and --dimensions must be greater than 0."
+          << endl;
+    referenceSet.randu(dimensions, points);
+  }
+
+  const bool monochromatic = !CLI::HasParam("query");
+  arma::mat querySet;
+  if (!monochromatic)
+    querySet = std::move(CLI::GetParam<arma::mat>("query"));
+  const size_t numQueries = monochromatic ? referenceSet.n_cols :
+      querySet.n_cols;
+
+  if (size_t(k) > referenceSet.n_cols)
+    Log::Fatal << "Invalid k: " << k << "; must be less than or equal to the "
+        << "number of reference points (" << referenceSet.n_cols << ")."
+        << endl;
+  if (!monochromatic && querySet.n_rows != referenceSet.n_rows)
+    Log::Fatal << "Query set has dimensionality " << querySet.n_rows << ", but "
+        << "the reference set has dimensionality " << referenceSet.n_rows
+        << "." << endl;
+
+  // Run the benchmarks.  Each row of the results holds the measurements of one
+  // tree type.
+  arma::mat results(treeTypes.size(), numMetrics);
+  for (size_t t = 0; t < treeTypes.size(); ++t)
+  {
+    Log::Info << "Benchmarking tree type '" << treeNames[t] << "'." << endl;
+
+    KNNModel knn(treeTypes[t]);
+    knn.LeafSize() = size_t(leafSize);
+
+    double buildTime = DBL_MAX;
+    double searchTime = DBL_MAX;
+    for (int trial = 0; trial < trials; ++trial)
+    {
+      arma::mat referenceCopy(referenceSet);
+      const chrono::steady_clock::time_point buildStart =
+          chrono::steady_clock::now();
+      knn.BuildModel(std::move(referenceCopy), size_t(leafSize), searchMode);
+      buildTime = std::min(buildTime, SecondsSince(buildStart));
+
+      arma::Mat<size_t> neighbors;
+      arma::mat distances;
+      if (monochromatic)
+      {
+        const chrono::steady_clock::time_point searchStart =
+            chrono::steady_clock::now();
+        knn.Search(size_t(k), neighbors, distances);
+        searchTime = std::min(searchTime, SecondsSince(searchStart));
+      }
+      else
+      {
+        arma::mat queryCopy(querySet);
+        const chrono::steady_clock::time_point searchStart =
+            chrono::steady_clock::now();
+        knn.Search(std::move(queryCopy), size_t(k), neighbors, distances);
+        searchTime = std::min(searchTime, SecondsSince(searchStart));
+      }
+    }
+
+    size_t numNodes, numBytes;
+    knn.TreeSize(numNodes, numBytes);
+
+    results(t, 0) = buildTime;
+    results(t, 1) = numNodes;
+    results(t, 2) = numBytes;
+    results(t, 3) = searchTime / numQueries;
+    results(t, 4) = double(knn.BaseCases()) / numQueries;
+    results(t, 5) = double(knn.Scores()) / numQueries;
+  }
+
+  // Print the results.
+  ostringstream table;
+  table.precision(10);
+  table << "tree";
+  for (size_t m = 0; m < numMetrics; ++m)
+    table << "," << metricNames[m];
+  table << endl;
+  for (size_t t = 0; t < treeTypes.size(); ++t)
+  {
+    table << treeNames[t];
+    for (size_t m = 0; m < numMetrics; ++m)
+      table << "," << results(t, m);
+    table << endl;
+  }
+  cout << table.str();
+
+  const string outputFile = CLI::GetParam<string>("output_file");
+  if (outputFile != "")
+  {
+    ofstream output(outputFile.c_str());
+    if (!output.is_open())
+      Log::Fatal << "Could not open output file '" << outputFile << "'!"
+          << endl;
+    output << table.str();
+  }
+
+  // Compare against the baseline, if one was given.
+  const string baselineFile = CLI::GetParam<string>("baseline_file");
+  if (baselineFile != "")
+  {
+    ifstream baseline(baselineFile.c_str());
+    if (!baseline.is_open())
+      Log::Fatal << "Could not open baseline file '" << baselineFile << "'!"
+          << endl;
+
+    // Skip the header, and read the measurements of each tree type.
+    string line;
+    getline(baseline, line);
+    map<string, vector<double>> baselineResults;
+    while (getline(baseline, line))
+    {
+      if (line.empty())
+        continue;
+
+      istringstream fields(line);
+      string name, field;
+      getline(fields, name, ',');
+      vector<double> values;
+      while (getline(fields, field, ','))
+        values.push_back(atof(field.c_str()));
+
+      if (values.size() != numMetrics)
+        Log::Fatal << "Baseline file '" << baselineFile << "' has "
+            << values.size() << " measurements for tree type '" << name
+            << "'; expected " << numMetrics << "." << endl;
+      baselineResults[name] = values;
+    }
+
+    size_t regressions = 0;
+    for (size_t t = 0; t < treeTypes.size(); ++t)
+    {
+      map<string, vector<double>>::const_iterator it =
+          baselineResults.find(treeNames[t]);
+      if (it == baselineResults.end())
+      {
+        Log::Warn << "Tree type '" << treeNames[t] << "' is not in the "
+            << "baseline." << endl;
+        continue;
+      }
+
+      for (size_t m = 0; m < numMetrics; ++m)
+      {
+        const double old = it->second[m];
+        if (results(t, m) > old * (1 + tolerance))
+        {
+          Log::Warn << "Regression for tree type '" << treeNames[t] << "': "
+              << metricNames[m] << " is " << results(t, m) << ", baseline is "
+              << old << "." << endl;
+          ++regressions;
+        }
+      }
+    }
+
+    if (regressions > 0)
+      Log::Fatal << regressions << " regressions found against baseline '"
+          << baselineFile << "'." << endl;
+
+    Log::Info << "No regressions found against baseline '" << baselineFile
+        << "'." << endl;
+  }
+
+  CLI::Destroy();
+}
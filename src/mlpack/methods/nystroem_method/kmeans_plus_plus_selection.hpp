@@ -0,0 +1,110 @@
+/**
+ * @file kmeans_plus_plus_selection.hpp
+ *
+ * Select points with the k-means++ seeding for use in the Nystroem method of
+ * kernel matrix approximation.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_NYSTROEM_METHOD_KMEANS_PLUS_PLUS_SELECTION_HPP
+#define MLPACK_METHODS_NYSTROEM_METHOD_KMEANS_PLUS_PLUS_SELECTION_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/metrics/lmetric.hpp>
+
+namespace mlpack {
+namespace kernel {
+
+/**
+ * Select points of the dataset with the k-means++ seeding: the first point is
+ * chosen uniformly at random, and each following point with probability
+ * proportional to its squared distance to the closest point chosen so far.
+ * The selected points are spread over the dataset like the centroids of the
+ * KMeansSelection policy, but only one pass over the dataset is needed per
+ * point (done in parallel when OpenMP is available), instead of running the
+ * k-means clustering, and the selected points are points of the dataset.
+ */
+class KMeansPlusPlusSelection
+{
+ public:
+  /**
+   * Select the specified number of points in the dataset with the k-means++
+   * seeding.
+   *
+   * @param data Dataset to sample from.
+   * @param m Number of points to select.
+   * @return Indices of selected points from the dataset.
+   */
+  const static arma::Col<size_t> Select(const arma::mat& data, const size_t m)
+  {
+    arma::Col<size_t> selectedPoints(m);
+    if (data.n_cols == 0 || m == 0)
+      return selectedPoints;
+
+    // The squared distance of each point to its closest selected point.
+    arma::vec minDistances(data.n_cols);
+    minDistances.fill(DBL_MAX);
+    double total = 0.0;
+
+    for (size_t i = 0; i < m; ++i)
+    {
+      // Sample a point proportionally to the squared distances.  If every
+      // distance is zero (the first point, or fewer distinct points than m),
+      // sample uniformly.
+      size_t index = data.n_cols - 1;
+      if (i > 0 && total > 0.0)
+      {
+        const double target = math::Random() * total;
+        double sum = 0.0;
+        for (size_t j = 0; j < data.n_cols; ++j)
+        {
+          sum += minDistances[j];
+          if (sum > target)
+          {
+            index = j;
+            break;
+          }
+        }
+      }
+      else
+      {
+        index = math::RandInt(data.n_cols);
+      }
+
+      selectedPoints[i] = index;
+      if (i == m - 1)
+        break;
+
+      // Update the distances to the closest selected point.
+      total = 0.0;
+#ifdef _WIN32
+      // Tiny workaround: Visual Studio only implements OpenMP 2.0, which
+      // doesn't support unsigned loop variables. If we're building for Visual
+      // Studio, use the intmax_t type instead.
+      #pragma omp parallel for schedule(static) reduction(+:total)
+      for (intmax_t j = 0; j < (intmax_t) data.n_cols; ++j)
+#else
+      #pragma omp parallel for schedule(static) reduction(+:total)
+      for (size_t j = 0; j < data.n_cols; ++j)
+#endif
+      {
+        const double distance = metric::SquaredEuclideanDistance::Evaluate(
+            data.col(j), data.col(index));
+        if (distance < minDistances[j])
+          minDistances[j] = distance;
+
+        total += minDistances[j];
+      }
+    }
+
+    return selectedPoints;
+  }
+};
+
+} // namespace kernel
+} // namespace mlpack
+
+#endif
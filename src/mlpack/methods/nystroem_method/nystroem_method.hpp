@@ -69,6 +69,21 @@ class NystroemMethod
                        arma::mat& semiKernel);
 
  private:
+  /**
+   * Construct the mini-kernel and semi-kernel matrices of the given selected
+   * points.  The kernel is evaluated between blocks of points at once (with a
+   * single matrix product for inner product and squared distance kernels; see
+   * KernelMatrix()), and the blocks of the semi-kernel matrix are computed in
+   * parallel.
+   *
+   * @param selectedData Selected points.
+   * @param miniKernel to store the constructed mini-kernel matrix in.
+   * @param semiKernel to store the constructed semi-kernel matrix in.
+   */
+  void EvaluateKernelMatrix(const arma::mat& selectedData,
+                            arma::mat& miniKernel,
+                            arma::mat& semiKernel);
+
   //! The reference dataset.
   const arma::mat& data;
   //! The locally stored kernel, if it is necessary.
@@ -16,6 +16,8 @@
 // In case it hasn't been included yet.
 #include "nystroem_method.hpp"
 
+#include <mlpack/core/kernels/kernel_matrix.hpp>
+
 namespace mlpack {
 namespace kernel {
 
@@ -35,18 +37,8 @@ void NystroemMethod<KernelType, PointSelectionPolicy>::GetKernelMatrix(
     arma::mat& miniKernel,
     arma::mat& semiKernel)
 {
-  // Assemble mini-kernel matrix.
-  for (size_t i = 0; i < rank; ++i)
-    for (size_t j = 0; j < rank; ++j)
-      miniKernel(i, j) = kernel.Evaluate(selectedData->col(i),
-                                         selectedData->col(j));
+  EvaluateKernelMatrix(*selectedData, miniKernel, semiKernel);
 
-  // Construct semi-kernel matrix with interactions between selected data and
-  // all points.
-  for (size_t i = 0; i < data.n_cols; ++i)
-    for (size_t j = 0; j < rank; ++j)
-      semiKernel(i, j) = kernel.Evaluate(data.col(i),
-                                         selectedData->col(j));
   // Clean the memory.
   delete selectedData;
 }
@@ -56,19 +48,51 @@ void NystroemMethod<KernelType, PointSelectionPolicy>::GetKernelMatrix(
     const arma::Col<size_t>& selectedPoints,
     arma::mat& miniKernel,
     arma::mat& semiKernel)
+{
+  // Gather the selected points, so that the kernel can be evaluated on blocks
+  // of points.
+  arma::mat selectedData(data.n_rows, selectedPoints.n_elem);
+  for (size_t i = 0; i < selectedPoints.n_elem; ++i)
+    selectedData.col(i) = data.col(selectedPoints[i]);
+
+  EvaluateKernelMatrix(selectedData, miniKernel, semiKernel);
+}
+
+template<typename KernelType, typename PointSelectionPolicy>
+void NystroemMethod<KernelType, PointSelectionPolicy>::EvaluateKernelMatrix(
+    const arma::mat& selectedData,
+    arma::mat& miniKernel,
+    arma::mat& semiKernel)
 {
   // Assemble mini-kernel matrix.
-  for (size_t i = 0; i < rank; ++i)
-    for (size_t j = 0; j < rank; ++j)
-      miniKernel(i, j) = kernel.Evaluate(data.col(selectedPoints(i)),
-                                         data.col(selectedPoints(j)));
-
-  // Construct semi-kernel matrix with interactions between selected points and
-  // all points.
-  for (size_t i = 0; i < data.n_cols; ++i)
-    for (size_t j = 0; j < rank; ++j)
-      semiKernel(i, j) = kernel.Evaluate(data.col(i),
-                                         data.col(selectedPoints(j)));
+  KernelMatrix(kernel, selectedData, selectedData, miniKernel);
+
+  // Construct semi-kernel matrix with interactions between selected data and
+  // all points, one block of points per thread at a time.
+  const size_t blockSize = 1024;
+  const size_t numBlocks = (data.n_cols + blockSize - 1) / blockSize;
+  semiKernel.set_size(data.n_cols, selectedData.n_cols);
+
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables. If we're building for Visual Studio, use
+  // the intmax_t type instead.
+  #pragma omp parallel for schedule(dynamic)
+  for (intmax_t b = 0; b < (intmax_t) numBlocks; ++b)
+#else
+  #pragma omp parallel for schedule(dynamic)
+  for (size_t b = 0; b < numBlocks; ++b)
+#endif
+  {
+    const size_t begin = b * blockSize;
+    const size_t end = std::min(begin + blockSize, (size_t) data.n_cols);
+    const arma::mat points(const_cast<double*>(data.colptr(begin)),
+        data.n_rows, end - begin, false, true);
+
+    arma::mat block;
+    KernelMatrix(kernel, points, selectedData, block);
+    semiKernel.rows(begin, end - 1) = block;
+  }
 }
 
 template<typename KernelType, typename PointSelectionPolicy>
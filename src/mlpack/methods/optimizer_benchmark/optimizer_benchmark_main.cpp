@@ -0,0 +1,804 @@
+/**
+ * @file optimizer_benchmark_main.cpp
+ *
+ * A benchmark that runs the optimizers of mlpack on the test functions of the
+ * optimizers (and on the logistic and softmax regression objectives) and
+ * reports, for each pair, the time taken, the final objective, the number of
+ * evaluations of the objective and its gradient, and the number of heap
+ * allocations per iteration.  The results can be saved and compared against
+ * the results of an earlier run to catch performance regressions.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/util/cli.hpp>
+
+#include <mlpack/core/optimizers/lbfgs/lbfgs.hpp>
+#include <mlpack/core/optimizers/lbfgs/test_functions.hpp>
+#include <mlpack/core/optimizers/gradient_descent/gradient_descent.hpp>
+#include <mlpack/core/optimizers/sgd/sgd.hpp>
+#include <mlpack/core/optimizers/sgd/test_function.hpp>
+#include <mlpack/core/optimizers/minibatch_sgd/minibatch_sgd.hpp>
+#include <mlpack/core/optimizers/adam/adam.hpp>
+#include <mlpack/core/optimizers/rmsprop/rmsprop.hpp>
+#include <mlpack/core/optimizers/ada_grad/ada_grad.hpp>
+#include <mlpack/core/optimizers/ada_delta/ada_delta.hpp>
+#include <mlpack/core/optimizers/smorms3/smorms3.hpp>
+#include <mlpack/core/optimizers/sgdr/sgdr.hpp>
+#include <mlpack/core/optimizers/svrg/svrg.hpp>
+#include <mlpack/core/optimizers/saga/saga.hpp>
+#include <mlpack/core/optimizers/aug_lagrangian/aug_lagrangian.hpp>
+#include <mlpack/core/optimizers/aug_lagrangian/aug_lagrangian_test_functions.hpp>
+#include <mlpack/methods/logistic_regression/logistic_regression_function.hpp>
+#include <mlpack/methods/softmax_regression/softmax_regression_function.hpp>
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+
+using namespace std;
+using namespace mlpack;
+using namespace mlpack::optimization;
+using namespace mlpack::optimization::test;
+using namespace mlpack::regression;
+
+PROGRAM_INFO("Optimizer Benchmark",
+    "This program runs the optimizers of mlpack on the functions they are "
+    "tested on, and on the logistic and softmax regression objectives of a "
+    "random dataset.  Each optimizer is run on every function it can "
+    "optimize, starting from the initial point of the function and with its "
+    "default parameters, and the following are reported:"
+    "\n\n"
+    " - the time taken by the optimization (time, in seconds),\n"
+    " - the final objective (objective),\n"
+    " - the difference to the best known objective of the function (gap; for "
+    "the regression objectives, the best objective found by any optimizer),\n"
+    " - whether the gap is within --target (-g) times the best objective (or "
+    "--target, if the best objective is smaller than 1) (reached),\n"
+    " - the number of evaluations of the objective, counted in passes over "
+    "the whole function (evaluations),\n"
+    " - the number of evaluations of the gradient, counted the same way "
+    "(gradients),\n"
+    " - the number of heap allocations per call to a gradient "
+    "(allocations_per_iteration)."
+    "\n\n"
+    "The stochastic optimizers are limited to --max_passes (-P) passes over "
+    "the data.  Each optimization is repeated --trials (-T) times and the "
+    "fastest time is reported.  The optimizers and functions to run are "
+    "selected with --optimizers (-O) and --functions (-F); by default, all of "
+    "them are run.  The optimizers are 'lbfgs', 'gd', 'gd-line-search', "
+    "'sgd', 'momentum-sgd', 'minibatch-sgd', 'adam', 'adamax', 'rmsprop', "
+    "'adagrad', 'adadelta', 'smorms3', 'sgdr', 'svrg', 'saga' and "
+    "'aug-lagrangian'; the functions are 'rosenbrock', 'wood', "
+    "'rosenbrock-wood', 'generalized-rosenbrock', 'sgd-test', "
+    "'aug-lagrangian-test', 'gockenbach', 'logistic' and 'softmax'."
+    "\n\n"
+    "The results are printed and can be saved as CSV with --output_file (-o).  "
+    "If the results of an earlier run are given with --baseline_file (-B), "
+    "every time, evaluation count and allocation count that is more than "
+    "--tolerance (-x) worse than in the baseline is reported as a regression, "
+    "and the program fails if there are any regressions.");
+
+PARAM_VECTOR_IN(string, "optimizers", "Optimizers to benchmark (by default, "
+    "all of them).", "O");
+PARAM_VECTOR_IN(string, "functions", "Functions to benchmark on (by default, "
+    "all of them).", "F");
+PARAM_INT_IN("max_passes", "Maximum number of passes over the data of the "
+    "stochastic optimizers.", "P", 100);
+PARAM_DOUBLE_IN("target", "Relative gap to the best objective that counts as "
+    "reaching it.", "g", 1e-3);
+PARAM_INT_IN("points", "Number of points of the random dataset of the "
+    "regression objectives.", "p", 1000);
+PARAM_INT_IN("dimensions", "Dimensionality of the random dataset of the "
+    "regression objectives.", "d", 10);
+PARAM_INT_IN("trials", "Number of times each optimization is repeated.", "T",
+    1);
+
+PARAM_STRING_IN("output_file", "File to save the results to (CSV).", "o", "");
+PARAM_STRING_IN("baseline_file", "File holding the results of an earlier run, "
+    "to check for regressions.", "B", "");
+PARAM_DOUBLE_IN("tolerance", "Relative increase of a measurement over the "
+    "baseline that is reported as a regression.", "x", 0.2);
+PARAM_INT_IN("seed", "Random seed (if 0, std::time(NULL) is used).", "s", 0);
+
+// The number of heap allocations since the start of the program.
+static std::atomic<size_t> allocations(0);
+
+// Count the heap allocations.  With glibc, the allocation functions of the C
+// library are replaced, so that the allocations of Armadillo (which don't go
+// through operator new) are counted too; otherwise only operator new is.
+#ifdef __GLIBC__
+extern "C" {
+
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t n, size_t size);
+void* __libc_realloc(void* pointer, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+
+void* malloc(size_t size) __THROW
+{
+  ++allocations;
+  return __libc_malloc(size);
+}
+
+void* calloc(size_t n, size_t size) __THROW
+{
+  ++allocations;
+  return __libc_calloc(n, size);
+}
+
+void* realloc(void* pointer, size_t size) __THROW
+{
+  ++allocations;
+  return __libc_realloc(pointer, size);
+}
+
+int posix_memalign(void** pointer, size_t alignment, size_t size) __THROW
+{
+  ++allocations;
+  *pointer = __libc_memalign(alignment, size);
+  return (*pointer == NULL) ? ENOMEM : 0;
+}
+
+void* aligned_alloc(size_t alignment, size_t size) __THROW
+{
+  ++allocations;
+  return __libc_memalign(alignment, size);
+}
+
+} // extern "C"
+#else
+void* operator new(size_t size)
+{
+  ++allocations;
+  void* pointer = std::malloc(size == 0 ? 1 : size);
+  if (pointer == NULL)
+    throw std::bad_alloc();
+  return pointer;
+}
+
+void* operator new[](size_t size)
+{
+  return operator new(size);
+}
+
+void operator delete(void* pointer) noexcept
+{
+  std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept
+{
+  std::free(pointer);
+}
+#endif
+
+/**
+ * CountingFunction wraps a function and counts the points its objective and
+ * gradient are evaluated on.  Each form of Evaluate() and Gradient() is only
+ * instantiated if an optimizer calls it, and the batch forms are only visible
+ * (to the traits of batch_function.hpp) if the wrapped function has them, so
+ * the optimizers take the same code paths as with the wrapped function.
+ */
+template<typename FunctionType>
+class CountingFunction
+{
+ public:
+  /**
+   * Wrap the given function, which is separable over the given number of
+   * points (1 if it isn't separable).
+   */
+  CountingFunction(FunctionType& function, const size_t points) :
+      function(function), points(points), evaluations(0), gradients(0),
+      gradientCalls(0)
+  { }
+
+  template<typename F = FunctionType>
+  size_t NumFunctions() const { return function.NumFunctions(); }
+
+  const arma::mat& GetInitialPoint() const { return initialPoint; }
+
+  template<typename F = FunctionType>
+  double Evaluate(const arma::mat& coordinates) const
+  {
+    evaluations += points;
+    return function.Evaluate(coordinates);
+  }
+
+  template<typename F = FunctionType>
+  double Evaluate(const arma::mat& coordinates, const size_t i) const
+  {
+    ++evaluations;
+    return function.Evaluate(coordinates, i);
+  }
+
+  template<typename F = FunctionType, typename = std::enable_if_t<
+      HasConstBatchEvaluate<F>::value>>
+  double Evaluate(const arma::mat& coordinates,
+                  const size_t begin,
+                  const size_t batchSize) const
+  {
+    evaluations += batchSize;
+    return function.Evaluate(coordinates, begin, batchSize);
+  }
+
+  template<typename F = FunctionType>
+  void Gradient(const arma::mat& coordinates, arma::mat& gradient) const
+  {
+    gradients += points;
+    ++gradientCalls;
+    function.Gradient(coordinates, gradient);
+  }
+
+  template<typename F = FunctionType>
+  void Gradient(const arma::mat& coordinates,
+                const size_t i,
+                arma::mat& gradient) const
+  {
+    ++gradients;
+    ++gradientCalls;
+    function.Gradient(coordinates, i, gradient);
+  }
+
+  template<typename F = FunctionType, typename = std::enable_if_t<
+      HasConstBatchGradient<F>::value>>
+  void Gradient(const arma::mat& coordinates,
+                const size_t begin,
+                arma::mat& gradient,
+                const size_t batchSize) const
+  {
+    gradients += batchSize;
+    ++gradientCalls;
+    function.Gradient(coordinates, begin, gradient, batchSize);
+  }
+
+  template<typename F = FunctionType, typename = std::enable_if_t<
+      HasBatchEvaluateWithGradient<F>::value>>
+  double EvaluateWithGradient(const arma::mat& coordinates,
+                              const size_t begin,
+                              arma::mat& gradient,
+                              const size_t batchSize) const
+  {
+    evaluations += batchSize;
+    gradients += batchSize;
+    ++gradientCalls;
+    return function.EvaluateWithGradient(coordinates, begin, gradient,
+        batchSize);
+  }
+
+  template<typename F = FunctionType>
+  size_t NumConstraints() const { return function.NumConstraints(); }
+
+  template<typename F = FunctionType>
+  double EvaluateConstraint(const size_t index,
+                            const arma::mat& coordinates) const
+  {
+    return function.EvaluateConstraint(index, coordinates);
+  }
+
+  template<typename F = FunctionType>
+  void GradientConstraint(const size_t index,
+                          const arma::mat& coordinates,
+                          arma::mat& gradient) const
+  {
+    function.GradientConstraint(index, coordinates, gradient);
+  }
+
+  //! Get the number of evaluations of the objective, in passes.
+  double Evaluations() const { return double(evaluations) / points; }
+  //! Get the number of evaluations of the gradient, in passes.
+  double Gradients() const { return double(gradients) / points; }
+  //! Get the number of calls to a gradient.
+  size_t GradientCalls() const { return gradientCalls; }
+
+  //! Set the initial point.
+  void SetInitialPoint(const arma::mat& point) { initialPoint = point; }
+
+ private:
+  FunctionType& function;
+  size_t points;
+  arma::mat initialPoint;
+  mutable std::atomic<size_t> evaluations;
+  mutable std::atomic<size_t> gradients;
+  mutable std::atomic<size_t> gradientCalls;
+};
+
+// The names of the measurements, in the order they are saved in.
+static const char* metricNames[] = { "time", "objective", "gap", "reached",
+    "evaluations", "gradients", "allocations_per_iteration" };
+static const size_t numMetrics = 7;
+
+// The measurements that are checked for regressions (lower is better).
+static const size_t checkedMetrics[] = { 0, 4, 5, 6 };
+
+// The results of one optimizer on one function.
+struct Run
+{
+  string optimizer;
+  string function;
+  double best;
+  arma::vec results;
+};
+
+// Return the number of seconds since the given time.
+static double SecondsSince(const chrono::steady_clock::time_point& start)
+{
+  return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+// Holds the options of the benchmark and collects the results.
+class Benchmark
+{
+ public:
+  Benchmark(const vector<string>& optimizers,
+            const size_t maxPasses,
+            const int trials) :
+      optimizers(optimizers), maxPasses(maxPasses), trials(trials)
+  { }
+
+  //! Get the maximum number of passes of the stochastic optimizers.
+  size_t MaxPasses() const { return maxPasses; }
+
+  /**
+   * Run the given optimizer on the given function, if the optimizer is
+   * selected.  The optimizer is given the counted function and the iterate,
+   * and returns the final objective.
+   *
+   * @param optimizer Name of the optimizer.
+   * @param name Name of the function.
+   * @param function Function to optimize.
+   * @param points Number of points the function is separable over.
+   * @param best Best known objective (DBL_MAX if unknown).
+   * @param optimize Run of the optimizer.
+   */
+  template<typename FunctionType, typename OptimizeType>
+  void Add(const string& optimizer,
+           const string& name,
+           FunctionType& function,
+           const size_t points,
+           const double best,
+           OptimizeType optimize)
+  {
+    if (!optimizers.empty() && std::find(optimizers.begin(), optimizers.end(),
+        optimizer) == optimizers.end())
+      return;
+
+    Log::Info << "Running '" << optimizer << "' on '" << name << "'." << endl;
+
+    Run run;
+    run.optimizer = optimizer;
+    run.function = name;
+    run.best = best;
+    run.results.set_size(numMetrics);
+    run.results[0] = DBL_MAX;
+    for (int trial = 0; trial < trials; ++trial)
+    {
+      CountingFunction<FunctionType> counted(function, points);
+      counted.SetInitialPoint(function.GetInitialPoint());
+      arma::mat iterate(function.GetInitialPoint());
+
+      const size_t startAllocations = allocations;
+      const chrono::steady_clock::time_point start =
+          chrono::steady_clock::now();
+      const double objective = optimize(counted, iterate);
+      run.results[0] = std::min(run.results[0], SecondsSince(start));
+      const size_t runAllocations = allocations - startAllocations;
+
+      run.results[1] = objective;
+      run.results[4] = counted.Evaluations();
+      run.results[5] = counted.Gradients();
+      run.results[6] = double(runAllocations) /
+          std::max(counted.GradientCalls(), (size_t) 1);
+    }
+
+    runs.push_back(run);
+  }
+
+  //! Get the results.
+  vector<Run>& Runs() { return runs; }
+
+ private:
+  vector<string> optimizers;
+  size_t maxPasses;
+  int trials;
+  vector<Run> runs;
+};
+
+// Run the optimizers that only need the full objective and gradient.
+template<typename FunctionType>
+static void FullOptimizers(Benchmark& b,
+                           const string& name,
+                           FunctionType& function,
+                           const size_t points,
+                           const double best)
+{
+  typedef CountingFunction<FunctionType> CountedType;
+
+  b.Add("lbfgs", name, function, points, best,
+      [](CountedType& f, arma::mat& iterate)
+  {
+    L_BFGS<CountedType> optimizer(f);
+    return optimizer.Optimize(iterate);
+  });
+
+  b.Add("gd", name, function, points, best,
+      [](CountedType& f, arma::mat& iterate)
+  {
+    GradientDescent<CountedType> optimizer(f);
+    return optimizer.Optimize(iterate);
+  });
+
+  b.Add("gd-line-search", name, function, points, best,
+      [](CountedType& f, arma::mat& iterate)
+  {
+    GradientDescent<CountedType> optimizer(f, 1.0, 100000, 1e-5, true);
+    return optimizer.Optimize(iterate);
+  });
+}
+
+// Run the optimizers that need a separable objective and gradient.
+template<typename FunctionType>
+static void SeparableOptimizers(Benchmark& b,
+                                const string& name,
+                                FunctionType& function,
+                                const double best)
+{
+  typedef CountingFunction<FunctionType> CountedType;
+
+  const size_t n = function.NumFunctions();
+  const size_t steps = b.MaxPasses() * n;
+  const size_t batchSize = std::min((size_t) 32, n);
+  const size_t batches = b.MaxPasses() * ((n + batchSize - 1) / batchSize);
+  const size_t passes = b.MaxPasses();
+
+  b.Add("sgd", name, function, n, best,
+      [steps](CountedType& f, arma::mat& iterate)
+  {
+    StandardSGD<CountedType> optimizer(f, 0.01, steps);
+    return optimizer.Optimize(iterate);
+  });
+
+  b.Add("momentum-sgd", name, function, n, best,
+      [steps](CountedType& f, arma::mat& iterate)
+  {
+    MomentumSGD<CountedType> optimizer(f, 0.01, steps);
+    return optimizer.Optimize(iterate);
+  });
+
+  b.Add("minibatch-sgd", name, function, n, best,
+      [batchSize, batches](CountedType& f, arma::mat& iterate)
+  {
+    MiniBatchSGD<CountedType> optimizer(f, batchSize, 0.01, batches);
+    return optimizer.Optimize(iterate);
+  });
+
+  b.Add("adam", name, function, n, best,
+      [steps](CountedType& f, arma::mat& iterate)
+  {
+    Adam<CountedType> optimizer(f, 0.001, 0.9, 0.999, 1e-8, steps);
+    return optimizer.Optimize(iterate);
+  });
+
+  b.Add("adamax", name, function, n, best,
+      [steps](CountedType& f, arma::mat& iterate)
+  {
+    AdaMax<CountedType> optimizer(f, 0.001, 0.9, 0.999, 1e-8, steps);
+    return optimizer.Optimize(iterate);
+  });
+
+  b.Add("rmsprop", name, function, n, best,
+      [steps](CountedType& f, arma::mat& iterate)
+  {
+    RMSProp<CountedType> optimizer(f, 0.01, 0.99, 1e-8, steps);
+    return optimizer.Optimize(iterate);
+  });
+
+  b.Add("adagrad", name, function, n, best,
+      [steps](CountedType& f, arma::mat& iterate)
+  {
+    AdaGrad<CountedType> optimizer(f, 0.01, 1e-8, steps);
+    return optimizer.Optimize(iterate);
+  });
+
+  b.Add("adadelta", name, function, n, best,
+      [steps](CountedType& f, arma::mat& iterate)
+  {
+    AdaDelta<CountedType> optimizer(f, 1.0, 0.95, 1e-6, steps);
+    return optimizer.Optimize(iterate);
+  });
+
+  b.Add("smorms3", name, function, n, best,
+      [steps](CountedType& f, arma::mat& iterate)
+  {
+    SMORMS3<CountedType> optimizer(f, 0.001, 1e-16, steps);
+    return optimizer.Optimize(iterate);
+  });
+
+  b.Add("sgdr", name, function, n, best,
+      [batchSize, batches](CountedType& f, arma::mat& iterate)
+  {
+    SGDR<CountedType> optimizer(f, 50, 2.0, batchSize, 0.01, batches);
+    return optimizer.Optimize(iterate);
+  });
+
+  b.Add("svrg", name, function, n, best,
+      [passes](CountedType& f, arma::mat& iterate)
+  {
+    SVRG<CountedType> optimizer(f, 0.01, passes);
+    return optimizer.Optimize(iterate);
+  });
+
+  b.Add("saga", name, function, n, best,
+      [passes](CountedType& f, arma::mat& iterate)
+  {
+    SAGA<CountedType> optimizer(f, 0.01, passes);
+    return optimizer.Optimize(iterate);
+  });
+}
+
+// Run the optimizers of constrained functions.
+template<typename FunctionType>
+static void ConstrainedOptimizers(Benchmark& b,
+                                  const string& name,
+                                  FunctionType& function,
+                                  const double best)
+{
+  typedef CountingFunction<FunctionType> CountedType;
+
+  b.Add("aug-lagrangian", name, function, 1, best,
+      [&function](CountedType& f, arma::mat& iterate)
+  {
+    AugLagrangian<CountedType> optimizer(f);
+    optimizer.Optimize(iterate);
+    return function.Evaluate(iterate);
+  });
+}
+
+// Whether the function with the given name is selected.
+static bool Selected(const vector<string>& functions, const string& name)
+{
+  return functions.empty() || std::find(functions.begin(), functions.end(),
+      name) != functions.end();
+}
+
+int main(int argc, char** argv)
+{
+  CLI::ParseCommandLine(argc, argv);
+
+  if (CLI::GetParam<int>("seed") != 0)
+    math::RandomSeed((size_t) CLI::GetParam<int>("seed"));
+  else
+    math::RandomSeed((size_t) std::time(NULL));
+
+  // Sanity checks on the parameters.
+  const int maxPasses = CLI::GetParam<int>("max_passes");
+  if (maxPasses < 1)
+    Log::Fatal << "Invalid maximum number of passes: " << maxPasses << ".  "
+        << "Must be greater than 0." << endl;
+
+  const int trials = CLI::GetParam<int>("trials");
+  if (trials < 1)
+    Log::Fatal << "Invalid number of trials: " << trials << ".  Must be "
+        << "greater than 0." << endl;
+
+  const double target = CLI::GetParam<double>("target");
+  if (target < 0)
+    Log::Fatal << "Invalid target: " << target << ".  Must be non-negative."
+        << endl;
+
+  const double tolerance = CLI::GetParam<double>("tolerance");
+  if (tolerance < 0)
+    Log::Fatal << "Invalid tolerance: " << tolerance << ".  Must be "
+        << "non-negative." << endl;
+
+  const int points = CLI::GetParam<int>("points");
+  const int dimensions = CLI::GetParam<int>("dimensions");
+  if (points < 1 || dimensions < 1)
+    Log::Fatal << "Invalid random dataset size: " << dimensions << " x "
+        << points << ".  --points and --dimensions must be greater than 0."
+        << endl;
+
+  const vector<string> functions = CLI::GetParam<vector<string>>("functions");
+  Benchmark b(CLI::GetParam<vector<string>>("optimizers"), size_t(maxPasses),
+      trials);
+
+  // The test functions of the optimizers, with their minima.
+  RosenbrockFunction rosenbrock;
+  if (Selected(functions, "rosenbrock"))
+    FullOptimizers(b, "rosenbrock", rosenbrock, 1, 0.0);
+
+  WoodFunction wood;
+  if (Selected(functions, "wood"))
+    FullOptimizers(b, "wood", wood, 1, 0.0);
+
+  RosenbrockWoodFunction rosenbrockWood;
+  if (Selected(functions, "rosenbrock-wood"))
+    FullOptimizers(b, "rosenbrock-wood", rosenbrockWood, 1, 0.0);
+
+  GeneralizedRosenbrockFunction generalizedRosenbrock(10);
+  if (Selected(functions, "generalized-rosenbrock"))
+  {
+    FullOptimizers(b, "generalized-rosenbrock", generalizedRosenbrock,
+        generalizedRosenbrock.NumFunctions(), 0.0);
+    SeparableOptimizers(b, "generalized-rosenbrock", generalizedRosenbrock,
+        0.0);
+  }
+
+  SGDTestFunction sgdTest;
+  if (Selected(functions, "sgd-test"))
+    SeparableOptimizers(b, "sgd-test", sgdTest, -1.0);
+
+  AugLagrangianTestFunction augLagrangianTest;
+  if (Selected(functions, "aug-lagrangian-test"))
+    ConstrainedOptimizers(b, "aug-lagrangian-test", augLagrangianTest, 70.0);
+
+  GockenbachFunction gockenbach;
+  if (Selected(functions, "gockenbach"))
+    ConstrainedOptimizers(b, "gockenbach", gockenbach, 29.633926);
+
+  // The regression objectives, on two Gaussian classes (three for softmax),
+  // whose best objective isn't known.
+  arma::mat data(dimensions, points);
+  arma::Row<size_t> labels(points);
+  for (int i = 0; i < points; ++i)
+  {
+    labels[i] = i % 3;
+    data.col(i) = arma::randn<arma::vec>(dimensions) + 2.0 * labels[i];
+  }
+  const arma::Row<size_t> binaryLabels =
+      arma::conv_to<arma::Row<size_t>>::from(labels > 0);
+
+  LogisticRegressionFunction<> logistic(data, binaryLabels, 0.01);
+  if (Selected(functions, "logistic"))
+  {
+    FullOptimizers(b, "logistic", logistic, size_t(points), DBL_MAX);
+    SeparableOptimizers(b, "logistic", logistic, DBL_MAX);
+  }
+
+  SoftmaxRegressionFunction<> softmax(data, labels, 3, 0.01);
+  if (Selected(functions, "softmax"))
+  {
+    FullOptimizers(b, "softmax", softmax, size_t(points), DBL_MAX);
+    SeparableOptimizers(b, "softmax", softmax, DBL_MAX);
+  }
+
+  vector<Run>& runs = b.Runs();
+  if (runs.empty())
+    Log::Fatal << "No optimizer was run; check --optimizers and --functions."
+        << endl;
+
+  // The best objective of the functions without a known minimum is the best
+  // objective found by any optimizer.
+  map<string, double> bestObjectives;
+  for (size_t r = 0; r < runs.size(); ++r)
+  {
+    if (runs[r].best != DBL_MAX || !std::isfinite(runs[r].results[1]))
+      continue;
+    map<string, double>::iterator it = bestObjectives.find(runs[r].function);
+    if (it == bestObjectives.end() || runs[r].results[1] < it->second)
+      bestObjectives[runs[r].function] = runs[r].results[1];
+  }
+  for (size_t r = 0; r < runs.size(); ++r)
+  {
+    if (runs[r].best == DBL_MAX && bestObjectives.count(runs[r].function))
+      runs[r].best = bestObjectives[runs[r].function];
+
+    const double gap = runs[r].results[1] - runs[r].best;
+    runs[r].results[2] = gap;
+    runs[r].results[3] = (std::isfinite(gap) &&
+        gap <= target * std::max(std::abs(runs[r].best), 1.0)) ? 1 : 0;
+  }
+
+  // Print the results.
+  ostringstream table;
+  table.precision(10);
+  table << "optimizer,function";
+  for (size_t m = 0; m < numMetrics; ++m)
+    table << "," << metricNames[m];
+  table << endl;
+  for (size_t r = 0; r < runs.size(); ++r)
+  {
+    table << runs[r].optimizer << "," << runs[r].function;
+    for (size_t m = 0; m < numMetrics; ++m)
+      table << "," << runs[r].results[m];
+    table << endl;
+  }
+  cout << table.str();
+
+  const string outputFile = CLI::GetParam<string>("output_file");
+  if (outputFile != "")
+  {
+    ofstream output(outputFile.c_str());
+    if (!output.is_open())
+      Log::Fatal << "Could not open output file '" << outputFile << "'!"
+          << endl;
+    output << table.str();
+  }
+
+  // Compare against the baseline, if one was given.
+  const string baselineFile = CLI::GetParam<string>("baseline_file");
+  if (baselineFile != "")
+  {
+    ifstream baseline(baselineFile.c_str());
+    if (!baseline.is_open())
+      Log::Fatal << "Could not open baseline file '" << baselineFile << "'!"
+          << endl;
+
+    // Skip the header, and read the measurements of each run.
+    string line;
+    getline(baseline, line);
+    map<string, vector<double>> baselineResults;
+    while (getline(baseline, line))
+    {
+      if (line.empty())
+        continue;
+
+      istringstream fields(line);
+      string optimizer, function, field;
+      getline(fields, optimizer, ',');
+      getline(fields, function, ',');
+      vector<double> values;
+      while (getline(fields, field, ','))
+        values.push_back(atof(field.c_str()));
+
+      if (values.size() != numMetrics)
+        Log::Fatal << "Baseline file '" << baselineFile << "' has "
+            << values.size() << " measurements for '" << optimizer << "' on '"
+            << function << "'; expected " << numMetrics << "." << endl;
+      baselineResults[optimizer + "," + function] = values;
+    }
+
+    size_t regressions = 0;
+    for (size_t r = 0; r < runs.size(); ++r)
+    {
+      const string key = runs[r].optimizer + "," + runs[r].function;
+      map<string, vector<double>>::const_iterator it =
+          baselineResults.find(key);
+      if (it == baselineResults.end())
+      {
+        Log::Warn << "'" << runs[r].optimizer << "' on '" << runs[r].function
+            << "' is not in the baseline." << endl;
+        continue;
+      }
+
+      // An optimizer that doesn't reach the best objective anymore has
+      // regressed too.
+      if (it->second[3] == 1 && runs[r].results[3] == 0)
+      {
+        Log::Warn << "Regression for '" << runs[r].optimizer << "' on '"
+            << runs[r].function << "': the best objective isn't reached "
+            << "anymore." << endl;
+        ++regressions;
+      }
+
+      for (size_t c = 0; c < 4; ++c)
+      {
+        const size_t m = checkedMetrics[c];
+        const double old = it->second[m];
+        if (runs[r].results[m] > old * (1 + tolerance))
+        {
+          Log::Warn << "Regression for '" << runs[r].optimizer << "' on '"
+              << runs[r].function << "': " << metricNames[m] << " is "
+              << runs[r].results[m] << ", baseline is " << old << "." << endl;
+          ++regressions;
+        }
+      }
+    }
+
+    if (regressions > 0)
+      Log::Fatal << regressions << " regressions found against baseline '"
+          << baselineFile << "'." << endl;
+
+    Log::Info << "No regressions found against baseline '" << baselineFile
+        << "'." << endl;
+  }
+
+  CLI::Destroy();
+}
@@ -0,0 +1,102 @@
+/**
+ * @file incremental_svd_method.hpp
+ *
+ * Implementation of the incremental SVD method for use in the Principal
+ * Components Analysis method.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+
+#ifndef MLPACK_METHODS_PCA_DECOMPOSITION_POLICIES_INCREMENTAL_SVD_METHOD_HPP
+#define MLPACK_METHODS_PCA_DECOMPOSITION_POLICIES_INCREMENTAL_SVD_METHOD_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/methods/pca/incremental_pca.hpp>
+
+namespace mlpack {
+namespace pca {
+
+/**
+ * Implementation of the incremental SVD policy: the centered data is given to
+ * IncrementalPCA one block of points at a time.  This is the decomposition
+ * that can be used on data that doesn't fit in memory (see IncrementalPCA);
+ * on data that is in memory, it gives the results of an exact PCA if the rank
+ * is 0.
+ */
+class IncrementalSVDPolicy
+{
+ public:
+  /**
+   * Use the incremental SVD method to perform the principal components
+   * analysis (PCA).
+   *
+   * @param blockSize Number of points in each block.
+   * @param rank Number of principal components kept between blocks (0 keeps
+   *        as many as the dimensionality, so that the PCA is exact).
+   */
+  IncrementalSVDPolicy(const size_t blockSize = 10000,
+                       const size_t rank = 0) :
+      blockSize(blockSize),
+      rank(rank)
+  {
+    /* Nothing to do here */
+  }
+
+  /**
+   * Apply Principal Component Analysis to the provided data set using the
+   * incremental SVD.
+   *
+   * @param data Data matrix.
+   * @param centeredData Centered data matrix.
+   * @param transformedData Matrix to put results of PCA into.
+   * @param eigVal Vector to put eigenvalues into.
+   * @param eigvec Matrix to put eigenvectors (loadings) into.
+   * @param rank Rank of the decomposition (unused; see the constructor).
+   */
+  void Apply(const arma::mat& /* data */,
+             const arma::mat& centeredData,
+             arma::mat& transformedData,
+             arma::vec& eigVal,
+             arma::mat& eigvec,
+             const size_t /* rank */)
+  {
+    IncrementalPCA pca(rank);
+    for (size_t begin = 0; begin < centeredData.n_cols; begin += blockSize)
+    {
+      const size_t end = std::min(begin + blockSize,
+          (size_t) centeredData.n_cols) - 1;
+      pca.Update(centeredData.cols(begin, end));
+    }
+
+    eigvec = pca.Components();
+    eigVal = pca.Eigenvalues();
+
+    // Project the samples to the principals.
+    transformedData = arma::trans(eigvec) * centeredData;
+  }
+
+  //! Get the number of points in each block.
+  size_t BlockSize() const { return blockSize; }
+  //! Modify the number of points in each block.
+  size_t& BlockSize() { return blockSize; }
+
+  //! Get the number of principal components kept between blocks.
+  size_t Rank() const { return rank; }
+  //! Modify the number of principal components kept between blocks.
+  size_t& Rank() { return rank; }
+
+ private:
+  //! Locally stored number of points in each block.
+  size_t blockSize;
+
+  //! Locally stored number of principal components kept between blocks.
+  size_t rank;
+};
+
+} // namespace pca
+} // namespace mlpack
+
+#endif
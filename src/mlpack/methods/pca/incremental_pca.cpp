@@ -0,0 +1,151 @@
+/**
+ * @file incremental_pca.cpp
+ *
+ * Implementation of IncrementalPCA.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "incremental_pca.hpp"
+
+namespace mlpack {
+namespace pca {
+
+IncrementalPCA::IncrementalPCA(const size_t rank) :
+    rank(rank),
+    count(0),
+    scatter(0.0)
+{
+  // Nothing to do.
+}
+
+void IncrementalPCA::Update(const arma::mat& block)
+{
+  if (block.n_cols == 0)
+    return;
+
+  // Decompose the block on its own, and merge it.
+  IncrementalPCA blockPCA(rank);
+  blockPCA.count = block.n_cols;
+  blockPCA.mean = arma::mean(block, 1);
+  const arma::mat centered = block.each_col() - blockPCA.mean;
+  blockPCA.scatter = arma::accu(arma::square(centered));
+  blockPCA.Decompose(centered);
+
+  Merge(blockPCA);
+}
+
+void IncrementalPCA::Merge(const IncrementalPCA& other)
+{
+  if (other.count == 0)
+    return;
+
+  if (count == 0)
+  {
+    count = other.count;
+    mean = other.mean;
+    components = other.components;
+    singularValues = other.singularValues;
+    scatter = other.scatter;
+    Decompose(components.each_row() % singularValues.t());
+    return;
+  }
+
+  if (other.mean.n_elem != mean.n_elem)
+  {
+    std::ostringstream oss;
+    oss << "IncrementalPCA::Merge(): dimensionality of the points ("
+        << other.mean.n_elem << ") doesn't match the dimensionality of the "
+        << "decomposition (" << mean.n_elem << ")";
+    throw std::invalid_argument(oss.str());
+  }
+
+  const double total = (double) count + (double) other.count;
+  const double weight = (double) count * (double) other.count / total;
+  const arma::vec delta = other.mean - mean;
+
+  // The singular values and vectors of the union are those of
+  // [U_A S_A, U_B S_B, sqrt(weight) delta].
+  const size_t a = singularValues.n_elem;
+  const size_t b = other.singularValues.n_elem;
+  arma::mat x(mean.n_elem, a + b + 1);
+  if (a > 0)
+    x.head_cols(a) = components.each_row() % singularValues.t();
+  if (b > 0)
+    x.cols(a, a + b - 1) = other.components.each_row() %
+        other.singularValues.t();
+  x.col(a + b) = std::sqrt(weight) * delta;
+
+  mean += (other.count / total) * delta;
+  scatter += other.scatter + weight * arma::dot(delta, delta);
+  count += other.count;
+
+  Decompose(x);
+}
+
+void IncrementalPCA::Transform(const arma::mat& data,
+                               arma::mat& transformed) const
+{
+  if (data.n_rows != mean.n_elem)
+  {
+    std::ostringstream oss;
+    oss << "IncrementalPCA::Transform(): dimensionality of the points ("
+        << data.n_rows << ") doesn't match the dimensionality of the "
+        << "decomposition (" << mean.n_elem << ")";
+    throw std::invalid_argument(oss.str());
+  }
+
+  transformed = components.t() * (data.each_col() - mean);
+}
+
+arma::vec IncrementalPCA::Eigenvalues() const
+{
+  if (count < 2)
+    return arma::zeros<arma::vec>(singularValues.n_elem);
+
+  // The covariance of the points is the scatter matrix divided by n - 1.
+  return arma::square(singularValues) / (count - 1);
+}
+
+double IncrementalPCA::TotalVariance() const
+{
+  return (count < 2) ? 0.0 : scatter / (count - 1);
+}
+
+void IncrementalPCA::Decompose(const arma::mat& x)
+{
+  const size_t maxRank = (rank == 0) ? x.n_rows : rank;
+
+  arma::mat u;
+  arma::vec s;
+  if (x.n_rows < x.n_cols)
+  {
+    // It is cheaper to decompose the (small) scatter matrix X X^T, whose
+    // eigenvalues are the squared singular values of X.
+    arma::vec eigval;
+    arma::mat eigvec;
+    if (!arma::eig_sym(eigval, eigvec, x * x.t()))
+      throw std::runtime_error("IncrementalPCA: eigendecomposition failed");
+
+    // eig_sym() sorts the eigenvalues in ascending order, and rounding may
+    // make the smallest ones negative.
+    eigval.elem(arma::find(eigval < 0.0)).zeros();
+    u = arma::fliplr(eigvec);
+    s = arma::sqrt(arma::flipud(eigval));
+  }
+  else
+  {
+    arma::mat v;
+    if (!arma::svd_econ(u, s, v, x, "left"))
+      throw std::runtime_error("IncrementalPCA: SVD failed");
+  }
+
+  const size_t keep = std::min(maxRank, (size_t) s.n_elem);
+  components = u.head_cols(keep);
+  singularValues = s.head(keep);
+}
+
+} // namespace pca
+} // namespace mlpack
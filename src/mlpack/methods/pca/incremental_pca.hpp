@@ -0,0 +1,149 @@
+/**
+ * @file incremental_pca.hpp
+ *
+ * Principal components analysis of a dataset given one block of points at a
+ * time, with mergeable means and truncated singular value decompositions.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_PCA_INCREMENTAL_PCA_HPP
+#define MLPACK_METHODS_PCA_INCREMENTAL_PCA_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace pca {
+
+/**
+ * IncrementalPCA finds the principal components of a dataset in one pass over
+ * its points, which are given one block at a time, so that the dataset never
+ * has to be in memory.  The state is the number of points, their mean, and
+ * the leading singular values and left singular vectors of the centered points
+ * (at most the given rank of them), so it takes O(d * rank) memory for points
+ * of dimensionality d.
+ *
+ * Two states are merged as in the incremental SVD with a mean update of Ross
+ * et al. ("Incremental learning for robust visual tracking", IJCV 2008): if A
+ * and B are the centered points of the two states, of means a and b, the
+ * centered points of their union have the scatter matrix
+ *
+ * \f[
+ * A A^T + B B^T + \frac{n_A n_B}{n_A + n_B} (b - a) (b - a)^T,
+ * \f]
+ *
+ * which is X X^T for X = [U_A S_A, U_B S_B, \sqrt{n_A n_B / (n_A + n_B)}
+ * (b - a)]; the thin SVD of X (of at most 2 rank + 1 columns) gives the
+ * singular values and vectors of the union, which are truncated to the rank
+ * again.  A block of points is added by decomposing it and merging it.  If the
+ * rank is at least the dimensionality, nothing is truncated and the result is
+ * that of an exact PCA; otherwise, the variance outside of the kept subspace is
+ * lost at each merge, as with any truncated incremental SVD.  The total
+ * variance of the data is kept exactly, so the fraction of the variance
+ * explained by the kept components is known.
+ *
+ * @code
+ * data::ChunkedReader reader("large.csv", 100000);
+ * IncrementalPCA pca(10);
+ * arma::mat block;
+ * while (reader.Next(block))
+ *   pca.Update(block);
+ *
+ * // Project a block of points onto the 10 principal components.
+ * arma::mat transformed;
+ * pca.Transform(block, transformed);
+ * @endcode
+ */
+class IncrementalPCA
+{
+ public:
+  /**
+   * Create the object with no points.
+   *
+   * @param rank Maximum number of principal components to keep (0 keeps as
+   *     many as the dimensionality).
+   */
+  IncrementalPCA(const size_t rank = 0);
+
+  /**
+   * Add the given points (one per column) to the decomposition.  A
+   * std::invalid_argument is thrown if their dimensionality isn't the
+   * dimensionality of the points already added.
+   *
+   * @param block Points to add.
+   */
+  void Update(const arma::mat& block);
+
+  /**
+   * Merge the decomposition of other points into this one.  A
+   * std::invalid_argument is thrown if their dimensionality isn't the
+   * dimensionality of the points already added.
+   *
+   * @param other Decomposition of the other points.
+   */
+  void Merge(const IncrementalPCA& other);
+
+  /**
+   * Project the given points (one per column) onto the principal components.
+   *
+   * @param data Points to project.
+   * @param transformed Matrix to store the projected points into.
+   */
+  void Transform(const arma::mat& data, arma::mat& transformed) const;
+
+  //! Get the maximum number of principal components that are kept.
+  size_t Rank() const { return rank; }
+  //! Get the number of points.
+  size_t Count() const { return count; }
+  //! Get the mean of the points.
+  const arma::vec& Mean() const { return mean; }
+  //! Get the principal components (one per column), by decreasing variance.
+  const arma::mat& Components() const { return components; }
+  //! Get the singular values of the centered points.
+  const arma::vec& SingularValues() const { return singularValues; }
+
+  //! Get the variances of the points along the principal components (the
+  //! eigenvalues of their covariance matrix).
+  arma::vec Eigenvalues() const;
+
+  //! Get the total variance of the points (the trace of their covariance
+  //! matrix), which is exact even if components are truncated.
+  double TotalVariance() const;
+
+  //! Serialize the decomposition.
+  template<typename Archive>
+  void Serialize(Archive& ar, const unsigned int /* version */)
+  {
+    ar & data::CreateNVP(rank, "rank");
+    ar & data::CreateNVP(count, "count");
+    ar & data::CreateNVP(mean, "mean");
+    ar & data::CreateNVP(components, "components");
+    ar & data::CreateNVP(singularValues, "singularValues");
+    ar & data::CreateNVP(scatter, "scatter");
+  }
+
+ private:
+  //! Set the components and singular values to the truncated thin SVD of the
+  //! given matrix.
+  void Decompose(const arma::mat& x);
+
+  //! The maximum number of principal components to keep.
+  size_t rank;
+  //! The number of points.
+  size_t count;
+  //! The mean of the points.
+  arma::vec mean;
+  //! The left singular vectors of the centered points.
+  arma::mat components;
+  //! The singular values of the centered points.
+  arma::vec singularValues;
+  //! The sum of the squared norms of the centered points.
+  double scatter;
+};
+
+} // namespace pca
+} // namespace mlpack
+
+#endif
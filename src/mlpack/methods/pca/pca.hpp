@@ -129,7 +129,7 @@ class PCAType
         if (stdDev[i] == 0)
           stdDev[i] = 1e-50;
 
-      centeredData /= arma::repmat(stdDev, 1, centeredData.n_cols);
+      centeredData.each_col() /= stdDev;
     }
   }
 
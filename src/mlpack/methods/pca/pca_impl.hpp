@@ -48,14 +48,14 @@ void PCAType<DecompositionPolicy>::Apply(const arma::mat& data,
 {
   Timer::Start("pca");
 
-  // Center the data into a temporary matrix.
-  arma::mat centeredData;
-  math::Center(data, centeredData);
+  // Center the data into the output matrix, which may be the data itself, so
+  // that no temporary copy of the data is made.
+  math::Center(data, transformedData);
 
   // Scale the data if the user ask for.
-  ScaleData(centeredData);
+  ScaleData(transformedData);
 
-  decomposition.Apply(data, centeredData, transformedData, eigVal, eigvec,
+  decomposition.Apply(data, transformedData, transformedData, eigVal, eigvec,
       data.n_rows);
 
   Timer::Stop("pca");
@@ -106,14 +106,13 @@ double PCAType<DecompositionPolicy>::Apply(arma::mat& data,
 
   Timer::Start("pca");
 
-  // Center the data into a temporary matrix.
-  arma::mat centeredData;
-  math::Center(data, centeredData);
+  // Center the data in place; it is overwritten by the result anyway.
+  math::CenterInPlace(data);
 
   // Scale the data if the user ask for.
-  ScaleData(centeredData);
+  ScaleData(data);
 
-  decomposition.Apply(data, centeredData, data, eigVal, eigvec, newDimension);
+  decomposition.Apply(data, data, data, eigVal, eigvec, newDimension);
 
   if (newDimension < eigvec.n_rows)
     // Drop unnecessary rows.
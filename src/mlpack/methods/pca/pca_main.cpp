@@ -12,12 +12,18 @@
  */
 #include <mlpack/prereqs.hpp>
 #include <mlpack/core/util/cli.hpp>
+#include <mlpack/core/data/chunked_reader.hpp>
+#include <mlpack/core/data/extension.hpp>
 
 #include "pca.hpp"
 #include <mlpack/methods/pca/decomposition_policies/exact_svd_method.hpp>
 #include <mlpack/methods/pca/decomposition_policies/quic_svd_method.hpp>
 #include <mlpack/methods/pca/decomposition_policies/randomized_svd_method.hpp>
 #include <mlpack/methods/pca/decomposition_policies/randomized_block_krylov_method.hpp>
+#include <mlpack/methods/pca/decomposition_policies/incremental_svd_method.hpp>
+
+#include <fstream>
+#include <limits>
 
 using namespace mlpack;
 using namespace mlpack::pca;
@@ -26,10 +32,18 @@ using namespace std;
 // Document program.
 PROGRAM_INFO("Principal Components Analysis", "This program performs principal "
     "components analysis on the given dataset using the exact, randomized, "
-    "randomized block krylov or QUIC SVD method. It will transform the data "
-    "onto its principal components, optionally performing dimensionality "
-    "reduction by ignoring the principal components with the smallest "
-    "eigenvalues.");
+    "randomized block krylov, QUIC or incremental SVD method. It will transform "
+    "the data onto its principal components, optionally performing "
+    "dimensionality reduction by ignoring the principal components with the "
+    "smallest eigenvalues."
+    "\n\n"
+    "With --block_size (-b), the dataset is never loaded: it is read one block "
+    "of points at a time, and the principal components are found in one pass "
+    "with the incremental SVD method, keeping only as many components as the "
+    "new dimensionality; a second pass writes the transformed points to the "
+    "output file, which must then be a text file (.csv, .txt or .tsv).  The "
+    "memory used depends on the block size and the dimensionality, but not on "
+    "the number of points.");
 
 // Parameters for program.
 PARAM_MATRIX_IN_REQ("input", "Input dataset to perform PCA on.", "i");
@@ -44,7 +58,11 @@ PARAM_FLAG("scale", "If set, the data will be scaled before running PCA, such "
 
 PARAM_STRING_IN("decomposition_method", "Method used for the principal "
     "components analysis: 'exact', 'randomized', 'randomized-block-krylov', "
-    "'quic'.", "c", "exact");
+    "'quic', 'incremental'.", "c", "exact");
+
+PARAM_INT_IN("block_size", "If specified, read the input in blocks of this "
+    "many points, without loading it, and use the incremental method.", "b",
+    0);
 
 
 //! Run RunPCA on the specified dataset with the given decomposition method.
@@ -76,19 +94,130 @@ void RunPCA(arma::mat& dataset,
       dataset.n_rows << " dimensions)." << endl;
 }
 
+//! Run PCA on the input file one block at a time, without loading it.
+void RunStreamingPCA(const size_t blockSize, const double varToRetain)
+{
+  data::ChunkedReader reader(CLI::GetUnmappedParam<arma::mat>("input"),
+      blockSize);
+
+  size_t newDimension = reader.Dimensionality();
+  if (CLI::GetParam<int>("new_dimensionality") != 0)
+  {
+    newDimension = (size_t) CLI::GetParam<int>("new_dimensionality");
+    if (newDimension > reader.Dimensionality())
+    {
+      Log::Fatal << "New dimensionality (" << newDimension
+          << ") cannot be greater than existing dimensionality ("
+          << reader.Dimensionality() << ")!" << endl;
+    }
+  }
+
+  if (varToRetain < 0 || varToRetain > 1)
+    Log::Fatal << "--var_to_retain (" << varToRetain << ") should be between "
+        << "0 and 1." << endl;
+
+  // Find the principal components in one pass.
+  Log::Info << "Performing incremental PCA on dataset..." << endl;
+  Timer::Start("pca");
+  IncrementalPCA pca(newDimension);
+  arma::mat block;
+  while (reader.Next(block))
+    pca.Update(block);
+  Timer::Stop("pca");
+
+  if (pca.Count() == 0)
+    Log::Fatal << "The dataset has no points." << endl;
+
+  // Only the kept components are known, but the total variance is exact.
+  const arma::vec eigVal = pca.Eigenvalues();
+  const double totalVariance = pca.TotalVariance();
+  size_t dimensions = eigVal.n_elem;
+  if (varToRetain != 0)
+  {
+    if (CLI::GetParam<int>("new_dimensionality") != 0)
+      Log::Warn << "Only the first " << newDimension << " components are "
+          << "considered for --var_to_retain (-r), because -d was specified."
+          << endl;
+
+    double varSum = 0.0;
+    dimensions = 0;
+    while (dimensions < eigVal.n_elem && varSum < varToRetain * totalVariance)
+      varSum += eigVal[dimensions++];
+  }
+
+  const double varRetained = (totalVariance == 0.0) ? 1.0 :
+      arma::accu(eigVal.head(dimensions)) / totalVariance;
+  Log::Info << (varRetained * 100) << "% of variance retained (" << dimensions
+      << " dimensions)." << endl;
+
+  if (!CLI::HasParam("output"))
+    return;
+
+  // Write the transformed points one block at a time; the matrix of the
+  // output parameter is left empty, so it isn't saved again.
+  const string filename = CLI::GetUnmappedParam<arma::mat>("output");
+  const string extension = data::Extension(filename);
+  if (extension != "csv" && extension != "txt" && extension != "tsv")
+    Log::Fatal << "With --block_size, the output file must be a text file "
+        << "(.csv, .txt or .tsv)." << endl;
+  const char separator = (extension == "csv") ? ',' : ' ';
+
+  ofstream output(filename.c_str());
+  if (!output.is_open())
+    Log::Fatal << "Cannot open '" << filename << "' for writing." << endl;
+  output.precision(numeric_limits<double>::digits10);
+
+  Timer::Start("pca_transform");
+  arma::mat transformed;
+  while (reader.Next(block))
+  {
+    pca.Transform(block, transformed);
+    for (size_t i = 0; i < transformed.n_cols; ++i)
+    {
+      for (size_t d = 0; d < dimensions; ++d)
+        output << (d == 0 ? "" : string(1, separator)) << transformed(d, i);
+      output << '\n';
+    }
+  }
+  Timer::Stop("pca_transform");
+
+  if (!output.good())
+    Log::Fatal << "Error writing to '" << filename << "'." << endl;
+}
+
 int main(int argc, char** argv)
 {
   // Parse commandline.
   CLI::ParseCommandLine(argc, argv);
 
-  // Load input dataset.
-  arma::mat& dataset = CLI::GetParam<arma::mat>("input");
-
   // Issue a warning if the user did not specify an output file.
   if (!CLI::HasParam("output"))
     Log::Warn << "--output_file is not specified; no output will be "
         << "saved." << endl;
 
+  if (CLI::HasParam("block_size"))
+  {
+    if (CLI::GetParam<int>("block_size") <= 0)
+    {
+      Log::Fatal << "Invalid block size (" << CLI::GetParam<int>("block_size")
+          << "); must be greater than 0." << endl;
+    }
+
+    if (CLI::HasParam("scale"))
+      Log::Fatal << "--scale can't be used with --block_size." << endl;
+
+    if (CLI::HasParam("decomposition_method"))
+      Log::Warn << "--decomposition_method ignored, because --block_size is "
+          << "specified." << endl;
+
+    RunStreamingPCA((size_t) CLI::GetParam<int>("block_size"),
+        CLI::GetParam<double>("var_to_retain"));
+    return 0;
+  }
+
+  // Load input dataset.
+  arma::mat& dataset = CLI::GetParam<arma::mat>("input");
+
   // Find out what dimension we want.
   size_t newDimension = dataset.n_rows; // No reduction, by default.
   if (CLI::GetParam<int>("new_dimensionality") != 0)
@@ -127,12 +256,16 @@ int main(int argc, char** argv)
   {
     RunPCA<QUICSVDPolicy>(dataset, newDimension, scale, varToRetain);
   }
+  else if (decompositionMethod == "incremental")
+  {
+    RunPCA<IncrementalSVDPolicy>(dataset, newDimension, scale, varToRetain);
+  }
   else
   {
     // Invalid decomposition method.
     Log::Fatal << "Invalid decomposition method ('" << decompositionMethod
         << "'); valid choices are 'exact', 'randomized', "
-        << "'randomized-block-krylov', 'quic'." << endl;
+        << "'randomized-block-krylov', 'quic', 'incremental'." << endl;
   }
 
   // Now save the results.
@@ -102,9 +102,35 @@ class Perceptron
              const arma::Row<size_t>& labels,
              const arma::rowvec& instanceWeights = arma::rowvec());
 
+  /**
+   * Train the perceptron by iterative parameter mixing: the dataset is split
+   * into the given number of contiguous shards, and in each iteration the
+   * perceptron is trained on each shard for one pass, in parallel, starting
+   * from the current weights, and then the weights are set to the average of
+   * the weights found on the shards.  Training stops when no shard has
+   * misclassified a point during an iteration, or after MaxIterations()
+   * iterations.
+   *
+   * Like Train(), this does not reset the model weights.  With a single
+   * shard, this is the same as Train().
+   *
+   * @param data Dataset on which training should be performed.
+   * @param labels Labels of the dataset.  Make sure that these labels don't
+   *      contain any values greater than NumClasses()!
+   * @param numShards Number of shards (0 means one per thread).
+   * @param instanceWeights Cost matrix. Stores the cost of mispredicting
+   *      instances.  This is useful for boosting.
+   */
+  void ParallelTrain(const MatType& data,
+                     const arma::Row<size_t>& labels,
+                     const size_t numShards = 0,
+                     const arma::rowvec& instanceWeights = arma::rowvec());
+
   /**
    * Classification function. After training, use the weights matrix to
-   * classify test, and put the predicted classes in predictedLabels.
+   * classify test, and put the predicted classes in predictedLabels.  The
+   * points are classified in blocks, each with one matrix product, which are
+   * split between threads when OpenMP is available.
    *
    * @param test Testing data or data to classify.
    * @param predictedLabels Vector to store the predicted classes after
@@ -150,6 +176,21 @@ class Perceptron
 
   //! The biases for each class.
   arma::vec biases;
+
+  /**
+   * Make one pass of the perceptron learning rule over the points
+   * [begin, end) of the dataset, updating the given weights and biases at each
+   * misclassified point.
+   *
+   * @return Number of misclassified points.
+   */
+  static size_t TrainPass(const MatType& data,
+                          const arma::Row<size_t>& labels,
+                          const arma::rowvec& instanceWeights,
+                          const size_t begin,
+                          const size_t end,
+                          arma::mat& weights,
+                          arma::vec& biases);
 };
 
 } // namespace perceptron
@@ -112,15 +112,35 @@ void Perceptron<LearnPolicy, WeightInitializationPolicy, MatType>::Classify(
     const MatType& test,
     arma::Row<size_t>& predictedLabels)
 {
-  arma::vec tempLabelMat;
-  arma::uword maxIndex = 0;
+  predictedLabels.set_size(test.n_cols);
 
-  // Could probably be faster if done in batch.
-  for (size_t i = 0; i < test.n_cols; i++)
+  // The scores of each block of points are found with one matrix product.
+  const size_t blockSize = 4096;
+  const size_t numBlocks = (test.n_cols + blockSize - 1) / blockSize;
+
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables. If we're building for Visual Studio, use
+  // the intmax_t type instead.
+  #pragma omp parallel for schedule(static)
+  for (intmax_t b = 0; b < (intmax_t) numBlocks; ++b)
+#else
+  #pragma omp parallel for schedule(static)
+  for (size_t b = 0; b < numBlocks; ++b)
+#endif
   {
-    tempLabelMat = weights.t() * test.col(i) + biases;
-    tempLabelMat.max(maxIndex);
-    predictedLabels(0, i) = maxIndex;
+    const size_t begin = b * blockSize;
+    const size_t end = std::min(begin + blockSize, (size_t) test.n_cols) - 1;
+
+    arma::mat scores = weights.t() * test.cols(begin, end);
+    scores.each_col() += biases;
+
+    arma::uword maxIndex = 0;
+    for (size_t i = 0; i < scores.n_cols; ++i)
+    {
+      scores.col(i).max(maxIndex);
+      predictedLabels[begin + i] = maxIndex;
+    }
   }
 }
 
@@ -143,9 +163,99 @@ void Perceptron<LearnPolicy, WeightInitializationPolicy, MatType>::Train(
     const arma::Row<size_t>& labels,
     const arma::rowvec& instanceWeights)
 {
-  size_t j, i = 0;
-  bool converged = false;
-  size_t tempLabel;
+  // Each iteration is one pass over the dataset; training has converged when
+  // a pass classifies every point correctly.
+  for (size_t i = 0; i < maxIterations; ++i)
+  {
+    if (TrainPass(data, labels, instanceWeights, 0, data.n_cols, weights,
+        biases) == 0)
+      break;
+  }
+}
+
+/**
+ * Training by iterative parameter mixing (McDonald, Hall and Mann, 2010): each
+ * shard makes one pass from the mixed weights of the last iteration, and the
+ * weights of the shards are averaged.
+ */
+template<
+    typename LearnPolicy,
+    typename WeightInitializationPolicy,
+    typename MatType
+>
+void Perceptron<LearnPolicy, WeightInitializationPolicy, MatType>::
+ParallelTrain(const MatType& data,
+              const arma::Row<size_t>& labels,
+              const size_t numShards,
+              const arma::rowvec& instanceWeights)
+{
+#ifdef HAS_OPENMP
+  size_t shards = (numShards == 0) ? (size_t) omp_get_max_threads() :
+      numShards;
+#else
+  size_t shards = (numShards == 0) ? 1 : numShards;
+#endif
+  shards = std::max((size_t) 1, std::min(shards, (size_t) data.n_cols));
+
+  std::vector<arma::mat> shardWeights(shards);
+  std::vector<arma::vec> shardBiases(shards);
+  std::vector<size_t> mistakes(shards);
+
+  for (size_t i = 0; i < maxIterations; ++i)
+  {
+#ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables. If we're building for Visual Studio,
+    // use the intmax_t type instead.
+    #pragma omp parallel for schedule(static)
+    for (intmax_t s = 0; s < (intmax_t) shards; ++s)
+#else
+    #pragma omp parallel for schedule(static)
+    for (size_t s = 0; s < shards; ++s)
+#endif
+    {
+      shardWeights[s] = weights;
+      shardBiases[s] = biases;
+      mistakes[s] = TrainPass(data, labels, instanceWeights,
+          s * data.n_cols / shards, (s + 1) * data.n_cols / shards,
+          shardWeights[s], shardBiases[s]);
+    }
+
+    // If no shard has made a mistake, no weights have changed.
+    size_t totalMistakes = 0;
+    for (size_t s = 0; s < shards; ++s)
+      totalMistakes += mistakes[s];
+    if (totalMistakes == 0)
+      break;
+
+    // Mix the weights of the shards, in order.
+    weights = shardWeights[0];
+    biases = shardBiases[0];
+    for (size_t s = 1; s < shards; ++s)
+    {
+      weights += shardWeights[s];
+      biases += shardBiases[s];
+    }
+    weights /= shards;
+    biases /= shards;
+  }
+}
+
+template<
+    typename LearnPolicy,
+    typename WeightInitializationPolicy,
+    typename MatType
+>
+size_t Perceptron<LearnPolicy, WeightInitializationPolicy, MatType>::TrainPass(
+    const MatType& data,
+    const arma::Row<size_t>& labels,
+    const arma::rowvec& instanceWeights,
+    const size_t begin,
+    const size_t end,
+    arma::mat& weights,
+    arma::vec& biases)
+{
+  size_t mistakes = 0;
   arma::uword maxIndexRow, maxIndexCol;
   arma::mat tempLabelMat;
 
@@ -153,41 +263,33 @@ void Perceptron<LearnPolicy, WeightInitializationPolicy, MatType>::Train(
 
   const bool hasWeights = (instanceWeights.n_elem > 0);
 
-  while ((i < maxIterations) && (!converged))
+  for (size_t j = begin; j < end; j++)
   {
-    // This outer loop is for each iteration, and we use the 'converged'
-    // variable for noting whether or not convergence has been reached.
-    i++;
-    converged = true;
+    // Multiply for each variable and check whether the current weight vector
+    // correctly classifies this.
+    tempLabelMat = weights.t() * data.col(j) + biases;
+
+    tempLabelMat.max(maxIndexRow, maxIndexCol);
 
-    // Now this inner loop is for going through the dataset in each iteration.
-    for (j = 0; j < data.n_cols; j++)
+    // Check whether prediction is correct.
+    if (maxIndexRow != labels(0, j))
     {
-      // Multiply for each variable and check whether the current weight vector
-      // correctly classifies this.
-      tempLabelMat = weights.t() * data.col(j) + biases;
-
-      tempLabelMat.max(maxIndexRow, maxIndexCol);
-
-      // Check whether prediction is correct.
-      if (maxIndexRow != labels(0, j))
-      {
-        // Due to incorrect prediction, convergence set to false.
-        converged = false;
-        tempLabel = labels(0, j);
-
-        // Send maxIndexRow for knowing which weight to update, send j to know
-        // the value of the vector to update it with.  Send tempLabel to know
-        // the correct class.
-        if (hasWeights)
-          LP.UpdateWeights(data.col(j), weights, biases, maxIndexRow, tempLabel,
-              instanceWeights(j));
-        else
-          LP.UpdateWeights(data.col(j), weights, biases, maxIndexRow,
-              tempLabel);
-      }
+      ++mistakes;
+      const size_t tempLabel = labels(0, j);
+
+      // Send maxIndexRow for knowing which weight to update, send j to know
+      // the value of the vector to update it with.  Send tempLabel to know the
+      // correct class.
+      if (hasWeights)
+        LP.UpdateWeights(data.col(j), weights, biases, maxIndexRow, tempLabel,
+            instanceWeights(j));
+      else
+        LP.UpdateWeights(data.col(j), weights, biases, maxIndexRow,
+            tempLabel);
     }
   }
+
+  return mistakes;
 }
 
 //! Serialize the perceptron.
@@ -63,7 +63,12 @@ PROGRAM_INFO("Perceptron",
     "data must match.  So you cannot pass a perceptron model trained on 2 "
     "classes and then re-train with a 4-class dataset.  Similarly, attempting "
     "classification on a 3-dimensional dataset with a perceptron that has been "
-    "trained on 8 dimensions will cause an error.");
+    "trained on 8 dimensions will cause an error."
+    "\n\n"
+    "With --shards (-S), the training set is split into that many shards, and "
+    "in each iteration a copy of the perceptron is trained on each shard in "
+    "parallel, after which the weights of the copies are averaged (iterative "
+    "parameter mixing).");
 
 // When we save a model, we must also save the class mappings.  So we use this
 // auxiliary structure to store both the perceptron and the mapping, and we'll
@@ -95,6 +100,8 @@ PARAM_UROW_IN("labels", "A matrix containing labels for the training set.",
     "l");
 PARAM_INT_IN("max_iterations", "The maximum number of iterations the "
     "perceptron is to be run", "n", 1000);
+PARAM_INT_IN("shards", "If nonzero, train on this many shards of the training "
+    "set in parallel, averaging their weights after each iteration.", "S", 0);
 
 // Model loading/saving.
 PARAM_MODEL_IN(PerceptronModel, "input_model", "Input perceptron model.", "m");
@@ -113,6 +120,11 @@ int main(int argc, char** argv)
   // First, get all parameters and validate them.
   const size_t maxIterations = (size_t) CLI::GetParam<int>("max_iterations");
 
+  if (CLI::GetParam<int>("shards") < 0)
+    Log::Fatal << "Invalid number of shards (" << CLI::GetParam<int>("shards")
+        << "); must be 0 or greater." << endl;
+  const size_t shards = (size_t) CLI::GetParam<int>("shards");
+
   // We must either load a model or train a model.
   if (!CLI::HasParam("input_model") && !CLI::HasParam("training"))
     Log::Fatal << "Either an input model must be specified with "
@@ -187,8 +199,17 @@ int main(int argc, char** argv)
     {
       // Create and train the classifier.
       Timer::Start("training");
-      p.P() = Perceptron<>(trainingData, labels, max(labels) + 1,
-          maxIterations);
+      if (shards > 0)
+      {
+        p.P() = Perceptron<>(max(labels) + 1, trainingData.n_rows,
+            maxIterations);
+        p.P().ParallelTrain(trainingData, labels, shards);
+      }
+      else
+      {
+        p.P() = Perceptron<>(trainingData, labels, max(labels) + 1,
+            maxIterations);
+      }
       Timer::Stop("training");
     }
     else
@@ -216,7 +237,10 @@ int main(int argc, char** argv)
       // Now train.
       Timer::Start("training");
       p.P().MaxIterations() = maxIterations;
-      p.P().Train(trainingData, labels.t());
+      if (shards > 0)
+        p.P().ParallelTrain(trainingData, labels, shards);
+      else
+        p.P().Train(trainingData, labels.t());
       Timer::Stop("training");
     }
   }
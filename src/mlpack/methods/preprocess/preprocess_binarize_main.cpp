@@ -67,22 +67,21 @@ int main(int argc, char** argv)
     Log::Warn << "You did not specify --output_file, so no result will be "
         << "saved." << endl;
 
-  // Load the data.
+  // Load the data.  The input is binarized in place, so no copy is made.
   arma::mat input = std::move(CLI::GetParam<arma::mat>("input"));
-  arma::mat output;
 
   Timer::Start("binarize");
   if (CLI::HasParam("dimension"))
   {
-    data::Binarize<double>(input, output, threshold, dimension);
+    data::Binarize<double>(input, threshold, dimension);
   }
   else
   {
     // binarize the whole data
-    data::Binarize<double>(input, output, threshold);
+    data::Binarize<double>(input, threshold);
   }
   Timer::Stop("binarize");
 
   if (CLI::HasParam("output"))
-    CLI::GetParam<arma::mat>("output") = std::move(output);
+    CLI::GetParam<arma::mat>("output") = std::move(input);
 }
@@ -11,11 +11,14 @@
  */
 #include <mlpack/prereqs.hpp>
 #include <mlpack/core/util/cli.hpp>
+#include <mlpack/core/data/chunked_reader.hpp>
+#include <mlpack/core/math/streaming_statistics.hpp>
 #include <boost/format.hpp>
 #include <boost/lexical_cast.hpp>
 
 using namespace mlpack;
 using namespace mlpack::data;
+using namespace mlpack::math;
 using namespace std;
 using namespace boost;
 
@@ -41,7 +44,16 @@ PROGRAM_INFO("Descriptive Statistics", "This utility takes a dataset and "
     "If we want to customize the width to 10 and precision to 5 and consider "
     "the dataset as a population, we could run"
     "\n\n"
-    "$ mlpack_preprocess_describe -i dataset.csv -w 10 -p 5 -P -v");
+    "$ mlpack_preprocess_describe -i dataset.csv -w 10 -p 5 -P -v"
+    "\n\n"
+    "The statistics are computed in a single pass over the data.  If "
+    "--block_size (-b) is given, the dataset is not loaded; instead it is read "
+    "in blocks of that many points, so that a dataset larger than memory can "
+    "be described with one sequential read.  In that case the median and the "
+    "number of distinct values of each dimension are approximations, and "
+    "--row_major can't be used."
+    "\n\n"
+    "$ mlpack_preprocess_describe -i dataset.csv -b 100000 -v");
 
 // Define parameters for data.
 PARAM_MATRIX_IN_REQ("input", "Matrix containing data,", "i");
@@ -55,85 +67,9 @@ PARAM_FLAG("population", "If specified, the program will calculate statistics "
 PARAM_FLAG("row_major", "If specified, the program will calculate statistics "
     "across rows, not across columns.  (Remember that in mlpack, a column "
     "represents a point, so this option is generally not necessary.)", "r");
-
-/**
-* Calculates the sum of deviations to the Nth Power.
-*
-* @param input Vector that captures a dimension of a dataset.
-* @param rowMean Mean of the given vector.
-* @param n Degree of power.
-* @return sum of nth power deviations.
-*/
-double SumNthPowerDeviations(const arma::rowvec& input,
-                             const double& fMean,
-                             size_t n)
-{
-  return arma::sum(arma::pow(input - fMean, static_cast<double>(n)));
-}
-
-/**
- * Calculates Skewness of the given vector.
- *
- * @param input Vector that captures a dimension of a dataset
- * @param rowStd Standard Deviation of the given vector.
- * @param rowMean Mean of the given vector.
- * @return Skewness of the given vector.
- */
-double Skewness(const arma::rowvec& input,
-                const double& fStd,
-                const double& fMean,
-                const bool population)
-{
-  double skewness = 0;
-  const double S3 = pow(fStd, 3);
-  const double M3 = SumNthPowerDeviations(input, fMean, 3);
-  const double n = input.n_elem;
-  if (population)
-  {
-    // Calculate population skewness
-    skewness = M3 / (n * S3);
-  }
-  else
-  {
-    // Calculate sample skewness.
-    skewness = n * M3 / ((n - 1) * (n - 2) * S3);
-  }
-  return skewness;
-}
-
-/**
- * Calculates excess kurtosis of the given vector.
- *
- * @param input Vector that captures a dimension of a dataset
- * @param rowStd Standard Deviation of the given vector.
- * @param rowMean Mean of the given vector.
- * @return Kurtosis of the given vector.
- */
-double Kurtosis(const arma::rowvec& input,
-                const double& fStd,
-                const double& fMean,
-                const bool population)
-{
-  double kurtosis = 0;
-  const double M4 = SumNthPowerDeviations(input, fMean, 4);
-  const double n = input.n_elem;
-  if (population)
-  {
-    // Calculate population excess kurtosis.
-    const double M2 = SumNthPowerDeviations(input, fMean, 2);
-    kurtosis = n * (M4 / pow(M2, 2)) - 3;
-  }
-  else
-  {
-    // Calculate sample excess kurtosis.
-    const double S4 = pow(fStd, 4);
-    const double norm3 = (3 * (n - 1) * (n - 1)) / ((n - 2) * (n - 3));
-    const double normC = (n * (n + 1)) / ((n - 1) * (n - 2) * (n - 3));
-    const double normM = M4 / S4;
-    kurtosis = normC * normM - norm3;
-  }
-  return kurtosis;
-}
+PARAM_INT_IN("block_size", "If specified, read the dataset in blocks of this "
+    "many points instead of loading it (the median and the number of distinct "
+    "values are then approximate).", "b", 0);
 
 /**
  * Calculates standard error of standard deviation.
@@ -156,9 +92,113 @@ int main(int argc, char** argv)
   const size_t width = static_cast<size_t>(CLI::GetParam<int>("width"));
   const bool population = CLI::HasParam("population");
   const bool rowMajor = CLI::HasParam("row_major");
+  const bool oneDimension = CLI::HasParam("dimension");
+
+  if (CLI::HasParam("block_size") && CLI::GetParam<int>("block_size") <= 0)
+  {
+    Log::Fatal << "Invalid block size (" << CLI::GetParam<int>("block_size")
+        << "); must be greater than 0." << endl;
+  }
+
+  if (CLI::HasParam("block_size") && rowMajor)
+    Log::Fatal << "--row_major can't be used with --block_size." << endl;
 
-  // Load the data.
-  arma::mat& data = CLI::GetParam<arma::mat>("input");
+  // Each row of the matrix that is described is a dimension; the moments,
+  // minima and maxima of all of them are found in a single pass over the
+  // points.
+  MomentAccumulator moments;
+  arma::vec medians;
+  arma::vec distinct;
+
+  Timer::Start("statistics");
+  if (CLI::HasParam("block_size"))
+  {
+    // Read the dataset one block at a time, so that it is never in memory.
+    // The median and the number of distinct values of each dimension come
+    // from sketches, which are updated in parallel over the dimensions.
+    const size_t blockSize = (size_t) CLI::GetParam<int>("block_size");
+    ChunkedReader reader(CLI::GetUnmappedParam<arma::mat>("input"),
+        blockSize);
+    if (oneDimension && dimension >= reader.Dimensionality())
+    {
+      Log::Fatal << "Invalid dimension " << dimension << "; the data has "
+          << reader.Dimensionality() << " dimensions." << endl;
+    }
+
+    const size_t dimensions = oneDimension ? 1 : reader.Dimensionality();
+    std::vector<QuantileSketch> quantiles(dimensions, QuantileSketch(2048));
+    std::vector<CardinalitySketch> cardinalities(dimensions);
+
+    arma::mat block;
+    while (reader.Next(block))
+    {
+      if (oneDimension)
+        block = block.row(dimension);
+
+      moments.Update(block);
+
+#ifdef _WIN32
+      // Tiny workaround: Visual Studio only implements OpenMP 2.0, which
+      // doesn't support unsigned loop variables. If we're building for Visual
+      // Studio, use the intmax_t type instead.
+      #pragma omp parallel for schedule(dynamic)
+      for (intmax_t d = 0; d < (intmax_t) dimensions; ++d)
+#else
+      #pragma omp parallel for schedule(dynamic)
+      for (size_t d = 0; d < dimensions; ++d)
+#endif
+      {
+        for (size_t i = 0; i < block.n_cols; ++i)
+        {
+          quantiles[d].Insert(block(d, i));
+          cardinalities[d].Insert(block(d, i));
+        }
+      }
+    }
+
+    if (moments.Count() == 0)
+      Log::Fatal << "The dataset has no points." << endl;
+
+    medians.set_size(dimensions);
+    distinct.set_size(dimensions);
+    for (size_t d = 0; d < dimensions; ++d)
+    {
+      medians[d] = quantiles[d].Quantile(0.5);
+      distinct[d] = std::round(cardinalities[d].Estimate());
+    }
+  }
+  else
+  {
+    // Load the data.
+    const arma::mat& data = CLI::GetParam<arma::mat>("input");
+    const size_t dimensions = rowMajor ? data.n_cols : data.n_rows;
+    if (oneDimension && dimension >= dimensions)
+    {
+      Log::Fatal << "Invalid dimension " << dimension << "; the data has "
+          << dimensions << " dimensions." << endl;
+    }
+
+    // Only copy the data if the dimensions to describe aren't its rows.
+    arma::mat selected;
+    if (rowMajor && oneDimension)
+      selected = arma::trans(data.col(dimension));
+    else if (rowMajor)
+      selected = arma::trans(data);
+    else if (oneDimension)
+      selected = data.row(dimension);
+    const arma::mat& points = (rowMajor || oneDimension) ? selected : data;
+
+    moments.Update(points);
+    medians = arma::median(points, 1);
+    distinct.set_size(points.n_rows);
+    for (size_t d = 0; d < points.n_rows; ++d)
+      distinct[d] = arma::unique(points.row(d)).eval().n_elem;
+  }
+
+  const arma::vec variances = moments.Variance(population);
+  const arma::vec stddevs = moments.Stddev(population);
+  const arma::vec skewness = moments.Skewness(population);
+  const arma::vec kurtosis = moments.Kurtosis(population);
 
   // Generate boost format recipe.
   const string widthPrecision("%-" + to_string(width) + "." +
@@ -167,64 +207,40 @@ int main(int argc, char** argv)
   string stringFormat = "";
   string numberFormat = "";
 
-  // We are going to print 11 different categories.
-  for (size_t i = 0; i < 11; ++i)
+  // We are going to print 12 different categories.
+  for (size_t i = 0; i < 12; ++i)
   {
     stringFormat += widthOnly + "s";
     numberFormat += widthPrecision + "f";
   }
 
-  Timer::Start("statistics");
   // Print the headers.
   Log::Info << boost::format(stringFormat)
       % "dim" % "var" % "mean" % "std" % "median" % "min" % "max"
-      % "range" % "skew" % "kurt" % "SE" << endl;
+      % "range" % "skew" % "kurt" % "SE" % "distinct" << endl;
 
-  // Lambda function to print out the results.
-  auto PrintStatResults = [&](size_t dim, bool rowMajor)
+  // If the user specified dimension, describe statistics of the given
+  // dimension. If a dimension is not specified, describe all dimensions.
+  for (size_t i = 0; i < moments.Dimensionality(); ++i)
   {
-    arma::rowvec feature;
-    if (rowMajor)
-      feature = arma::conv_to<arma::rowvec>::from(data.col(dim));
-    else
-      feature = data.row(dim);
-
-    // f at the front of the variable names means "feature".
-    const double fMax = arma::max(feature);
-    const double fMin = arma::min(feature);
-    const double fMean = arma::mean(feature);
-    const double fStd = arma::stddev(feature, population);
+    const double fMin = moments.Min()[i];
+    const double fMax = moments.Max()[i];
 
     // Print statistics of the given dimension.
     Log::Info << boost::format(numberFormat)
-        % dim
-        % arma::var(feature, population)
-        % fMean
-        % fStd
-        % arma::median(feature)
+        % (oneDimension ? dimension : i)
+        % variances[i]
+        % moments.Mean()[i]
+        % stddevs[i]
+        % medians[i]
         % fMin
         % fMax
         % (fMax - fMin) // range
-        % Skewness(feature, fStd, fMean, population)
-        % Kurtosis(feature, fStd, fMean, population)
-        % StandardError(feature.n_elem, fStd)
+        % skewness[i]
+        % kurtosis[i]
+        % StandardError(moments.Count(), stddevs[i])
+        % distinct[i]
         << endl;
-  };
-
-  // If the user specified dimension, describe statistics of the given
-  // dimension. If a dimension is not specified, describe all dimensions.
-  if (CLI::HasParam("dimension"))
-  {
-    PrintStatResults(dimension, rowMajor);
-  }
-  else
-  {
-    const size_t dimensions = rowMajor ? data.n_cols : data.n_rows;
-    for (size_t i = 0; i < dimensions; ++i)
-    {
-      PrintStatResults(i, rowMajor);
-    }
   }
   Timer::Stop("statistics");
 }
-
@@ -138,55 +138,53 @@ int main(int argc, char** argv)
   }
   else
   {
-    // Initialize imputer class
-    Imputer<double, MapperType, MeanImputation<double>> imputer(info);
+    // When --dimension is specified, the program will apply the changes to
+    // only the given dimension; otherwise, it will apply them to all the
+    // dimensions with missing values.  All the dimensions are imputed in one
+    // pass over the data.
+    std::vector<size_t> dimensions;
+    if (CLI::HasParam("dimension"))
+    {
+      Log::Info << "Performing '" << strategy << "' imputation strategy "
+          << "to replace '" << missingValue << "' on dimension " << dimension
+          << "." << endl;
+      dimensions.push_back(dimension);
+    }
+    else
+    {
+      Log::Info << "Performing '" << strategy << "' imputation strategy "
+          << "to replace '" << missingValue << "' on all dimensions." << endl;
+      dimensions = dirtyDimensions;
+    }
+
+    Timer::Start("imputation");
     if (strategy == "mean")
     {
       Imputer<double, MapperType, MeanImputation<double>> imputer(info);
+      imputer.Impute(input, missingValue, dimensions);
     }
     else if (strategy == "median")
     {
       Imputer<double, MapperType, MedianImputation<double>> imputer(info);
+      imputer.Impute(input, missingValue, dimensions);
     }
     else if (strategy == "listwise_deletion")
     {
       Imputer<double, MapperType, ListwiseDeletion<double>> imputer(info);
+      imputer.Impute(input, missingValue, dimensions);
     }
     else if (strategy == "custom")
     {
       CustomImputation<double> strat(customValue);
       Imputer<double, MapperType, CustomImputation<double>> imputer(
           info, strat);
+      imputer.Impute(input, missingValue, dimensions);
     }
     else
     {
       Log::Fatal << "'" <<  strategy << "' imputation strategy does not exist"
           << endl;
     }
-
-    Timer::Start("imputation");
-    if (CLI::HasParam("dimension"))
-    {
-      // when --dimension is specified,
-      // the program will apply the changes to only the given dimension.
-      Log::Info << "Performing '" << strategy << "' imputation strategy "
-          << "to replace '" << missingValue << "' on dimension " << dimension
-          << "." << endl;
-
-      imputer.Impute(input, missingValue, dimension);
-    }
-    else
-    {
-      // when --dimension is not specified,
-      // the program will apply the changes to all dimensions.
-      Log::Info << "Performing '" << strategy << "' imputation strategy "
-          << "to replace '" << missingValue << "' on all dimensions." << endl;
-
-      for (size_t i : dirtyDimensions)
-      {
-        imputer.Impute(input, missingValue, i);
-      }
-    }
     Timer::Stop("imputation");
 
     if (!outputFile.empty())
@@ -66,13 +66,16 @@ class QUIC_SVD
    * @param sigma Diagonal matrix of singular values.
    * @param epsilon Error tolerance fraction for calculated subspace.
    * @param delta Cumulative probability for Monte Carlo error lower bound.
+   * @param splitBatch Maximum number of cosine tree nodes split in parallel at
+   *     each step of the tree construction.
    */
   QUIC_SVD(const arma::mat& dataset,
            arma::mat& u,
            arma::mat& v,
            arma::mat& sigma,
            const double epsilon = 0.03,
-           const double delta = 0.1);
+           const double delta = 0.1,
+           const size_t splitBatch = 1);
 
   /**
    * This function uses the vector subspace created using a cosine tree to
@@ -47,6 +47,11 @@ double Radical::Vasicek(vec& z) const
 {
   z = sort(z);
 
+  return SpacingSum(z);
+}
+
+double Radical::SpacingSum(const vec& z) const
+{
   // Apparently slower.
   /*
   vec logs = log(z.subvec(m, z.n_elem - 1) - z.subvec(0, z.n_elem - 1 - m));
@@ -65,31 +70,104 @@ double Radical::Vasicek(vec& z) const
   return sum;
 }
 
+double Radical::RotatedVasicek(const vec& x,
+                               const vec& y,
+                               const double a,
+                               const double b,
+                               uvec& order,
+                               vec& z) const
+{
+  const size_t n = x.n_elem;
+  z.set_size(n);
+
+  // A small rotation only swaps a few pairs of points, so the order of the
+  // last angle is nearly sorted, and insertion sort takes O(n) time plus the
+  // number of swaps.  If there are too many swaps, sort from scratch.
+  bool sorted = false;
+  if (order.n_elem == n)
+  {
+    for (size_t k = 0; k < n; ++k)
+      z[k] = a * x[order[k]] + b * y[order[k]];
+
+    const size_t maxMoves = 16 * n;
+    size_t moves = 0;
+    sorted = true;
+    for (size_t k = 1; k < n; ++k)
+    {
+      const double value = z[k];
+      const uword index = order[k];
+      size_t j = k;
+      while ((j > 0) && (z[j - 1] > value))
+      {
+        z[j] = z[j - 1];
+        order[j] = order[j - 1];
+        --j;
+      }
+      z[j] = value;
+      order[j] = index;
+
+      moves += k - j;
+      if (moves > maxMoves)
+      {
+        sorted = false;
+        break;
+      }
+    }
+  }
+
+  if (!sorted)
+  {
+    z = a * x + b * y;
+    order = sort_index(z);
+    z = z.elem(order);
+  }
+
+  return SpacingSum(z);
+}
 
 double Radical::DoRadical2D(const mat& matX)
 {
   CopyAndPerturb(perturbed, matX);
 
-  mat::fixed<2, 2> matJacobi;
+  const vec x(perturbed.colptr(0), perturbed.n_rows, false, true);
+  const vec y(perturbed.colptr(1), perturbed.n_rows, false, true);
 
   vec values(angles);
 
-  for (size_t i = 0; i < angles; i++)
-  {
-    const double theta = (i / (double) angles) * M_PI / 2.0;
-    const double cosTheta = cos(theta);
-    const double sinTheta = sin(theta);
-
-    matJacobi(0, 0) = cosTheta;
-    matJacobi(1, 0) = -sinTheta;
-    matJacobi(0, 1) = sinTheta;
-    matJacobi(1, 1) = cosTheta;
-
-    candidate = perturbed * matJacobi;
-    vec candidateY1 = candidate.unsafe_col(0);
-    vec candidateY2 = candidate.unsafe_col(1);
+  // Each thread searches a contiguous range of angles, so that the sorted
+  // projections of each angle are nearly sorted for the next one.
+#ifdef HAS_OPENMP
+  const size_t numThreads = std::max((size_t) 1,
+      std::min((size_t) omp_get_max_threads(), angles));
+#else
+  const size_t numThreads = 1;
+#endif
 
-    values(i) = Vasicek(candidateY1) + Vasicek(candidateY2);
+  #pragma omp parallel num_threads(numThreads)
+  {
+#ifdef HAS_OPENMP
+    const size_t thread = omp_get_thread_num();
+#else
+    const size_t thread = 0;
+#endif
+
+    // The sorted orders of the projections on the two rotated axes.
+    uvec order1, order2;
+    vec z;
+
+    const size_t first = thread * angles / numThreads;
+    const size_t last = (thread + 1) * angles / numThreads;
+    for (size_t i = first; i < last; i++)
+    {
+      const double theta = (i / (double) angles) * M_PI / 2.0;
+      const double cosTheta = cos(theta);
+      const double sinTheta = sin(theta);
+
+      // The columns of the data rotated by the Jacobi matrix
+      // [cos(theta), sin(theta); -sin(theta), cos(theta)].
+      values(i) = RotatedVasicek(x, y, cosTheta, -sinTheta, order1, z) +
+          RotatedVasicek(x, y, sinTheta, cosTheta, order2, z);
+    }
   }
 
   uword indOpt = 0;
@@ -88,7 +88,11 @@ class Radical
    */
   void CopyAndPerturb(arma::mat& xNew, const arma::mat& x) const;
 
-  //! Two-dimensional version of RADICAL.
+  /**
+   * Two-dimensional version of RADICAL.  The angles are split between threads
+   * when OpenMP is available, and each thread updates the sorted projections
+   * of the data from one angle to the next instead of sorting them again.
+   */
   double DoRadical2D(const arma::mat& matX);
 
   //! Get the standard deviation of the additive Gaussian noise.
@@ -131,8 +135,22 @@ class Radical
 
   //! Internal matrix, held as member variable to prevent memory reallocations.
   arma::mat perturbed;
-  //! Internal matrix, held as member variable to prevent memory reallocations.
-  arma::mat candidate;
+
+  //! Sum of the logarithms of the m-spacings of the sorted sample z.
+  double SpacingSum(const arma::vec& z) const;
+
+  /**
+   * Vasicek's estimator of the entropy of the projection a x + b y, where
+   * order holds the order in which the projection of the previous angle
+   * was sorted (or is empty).  The order is updated, and z holds the sorted
+   * projection.
+   */
+  double RotatedVasicek(const arma::vec& x,
+                        const arma::vec& y,
+                        const double a,
+                        const double b,
+                        arma::uvec& order,
+                        arma::vec& z) const;
 };
 
 void WhitenFeatureMajorMatrix(const arma::mat& matX,
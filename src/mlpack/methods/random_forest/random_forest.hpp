@@ -0,0 +1,238 @@
+/**
+ * @file random_forest.hpp
+ *
+ * Definition of the RandomForest class, an ensemble of decision trees trained
+ * on bootstrap samples of the dataset.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_RANDOM_FOREST_RANDOM_FOREST_HPP
+#define MLPACK_METHODS_RANDOM_FOREST_RANDOM_FOREST_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/util/sfinae_utility.hpp>
+#include <mlpack/methods/decision_tree/decision_tree.hpp>
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * A random forest: an ensemble of decision trees, each trained on a bootstrap
+ * sample of the dataset, where each node of each tree searches only a random
+ * subset of the dimensions for a split (with the default
+ * MultipleRandomDimensionSelect).  The forest predicts the class with the
+ * highest average class probability over the trees.
+ *
+ * The bootstrap sample of a tree is given to it through weights: each point
+ * drawn is used once, with a weight equal to the number of times it was drawn,
+ * and the points that were not drawn are left out.  The trees are trained in
+ * parallel with OpenMP, one tree per thread.  Each tree has its own random
+ * number generator, seeded from math::randGen before training, so the forest
+ * only depends on the random seed and not on the number of threads.  If the
+ * dimension selection policy has a Generator(std::mt19937&) method (like
+ * MultipleRandomDimensionSelect), the tree's generator is given to it.
+ *
+ * @tparam FitnessFunction Fitness function to use for the trees.
+ * @tparam DimensionSelectionType Policy to choose the dimensions to search at
+ *     each node.
+ * @tparam NumericSplitType Split policy for numeric dimensions.
+ * @tparam CategoricalSplitType Split policy for categorical dimensions.
+ * @tparam ElemType Type of the elements of the dataset.
+ */
+template<typename FitnessFunction = GiniGain,
+         typename DimensionSelectionType = MultipleRandomDimensionSelect,
+         template<typename> class NumericSplitType = BestBinaryNumericSplit,
+         template<typename> class CategoricalSplitType = AllCategoricalSplit,
+         typename ElemType = double>
+class RandomForest
+{
+ public:
+  //! The type of the trees in the forest.
+  typedef DecisionTree<FitnessFunction, NumericSplitType, CategoricalSplitType,
+      DimensionSelectionType, ElemType> DecisionTreeType;
+
+  /**
+   * Construct the random forest without training it.  Call Train() before
+   * using it to classify points.
+   */
+  RandomForest() { }
+
+  /**
+   * Construct and train the random forest on the given numeric data.
+   *
+   * @param data Dataset to train on.
+   * @param labels Labels for each training point.
+   * @param numClasses Number of classes in the dataset.
+   * @param numTrees Number of trees in the forest.
+   * @param minimumLeafSize Minimum number of points in each leaf node.
+   * @param dimensionSelector Instantiated dimension selection policy, which is
+   *     copied for each tree.
+   */
+  template<typename MatType>
+  RandomForest(const MatType& data,
+               const arma::Row<size_t>& labels,
+               const size_t numClasses,
+               const size_t numTrees = 20,
+               const size_t minimumLeafSize = 1,
+               const DimensionSelectionType& dimensionSelector =
+                   DimensionSelectionType());
+
+  /**
+   * Construct and train the random forest on the given data, where the data
+   * can be both numeric and categorical.
+   *
+   * @param data Dataset to train on.
+   * @param datasetInfo Type information for each dimension of the dataset.
+   * @param labels Labels for each training point.
+   * @param numClasses Number of classes in the dataset.
+   * @param numTrees Number of trees in the forest.
+   * @param minimumLeafSize Minimum number of points in each leaf node.
+   * @param dimensionSelector Instantiated dimension selection policy, which is
+   *     copied for each tree.
+   */
+  template<typename MatType>
+  RandomForest(const MatType& data,
+               const data::DatasetInfo& datasetInfo,
+               const arma::Row<size_t>& labels,
+               const size_t numClasses,
+               const size_t numTrees = 20,
+               const size_t minimumLeafSize = 1,
+               const DimensionSelectionType& dimensionSelector =
+                   DimensionSelectionType());
+
+  /**
+   * Train the random forest on the given numeric data.  This will overwrite
+   * the existing model.
+   *
+   * @param data Dataset to train on.
+   * @param labels Labels for each training point.
+   * @param numClasses Number of classes in the dataset.
+   * @param numTrees Number of trees in the forest.
+   * @param minimumLeafSize Minimum number of points in each leaf node.
+   * @param dimensionSelector Instantiated dimension selection policy, which is
+   *     copied for each tree.
+   */
+  template<typename MatType>
+  void Train(const MatType& data,
+             const arma::Row<size_t>& labels,
+             const size_t numClasses,
+             const size_t numTrees = 20,
+             const size_t minimumLeafSize = 1,
+             const DimensionSelectionType& dimensionSelector =
+                 DimensionSelectionType());
+
+  /**
+   * Train the random forest on the given data, where the data can be both
+   * numeric and categorical.  This will overwrite the existing model.
+   *
+   * @param data Dataset to train on.
+   * @param datasetInfo Type information for each dimension of the dataset.
+   * @param labels Labels for each training point.
+   * @param numClasses Number of classes in the dataset.
+   * @param numTrees Number of trees in the forest.
+   * @param minimumLeafSize Minimum number of points in each leaf node.
+   * @param dimensionSelector Instantiated dimension selection policy, which is
+   *     copied for each tree.
+   */
+  template<typename MatType>
+  void Train(const MatType& data,
+             const data::DatasetInfo& datasetInfo,
+             const arma::Row<size_t>& labels,
+             const size_t numClasses,
+             const size_t numTrees = 20,
+             const size_t minimumLeafSize = 1,
+             const DimensionSelectionType& dimensionSelector =
+                 DimensionSelectionType());
+
+  /**
+   * Predict the class of the given point.
+   *
+   * @param point Point to classify.
+   */
+  template<typename VecType>
+  size_t Classify(const VecType& point) const;
+
+  /**
+   * Predict the class of the given point, and the average class probabilities
+   * over the trees.
+   *
+   * @param point Point to classify.
+   * @param prediction This will be set to the predicted class of the point.
+   * @param probabilities This will be filled with the class probabilities for
+   *      the point.
+   */
+  template<typename VecType>
+  void Classify(const VecType& point,
+                size_t& prediction,
+                arma::vec& probabilities) const;
+
+  /**
+   * Predict the classes of each point in the given dataset.  The points are
+   * split into blocks, one per thread, and each block is classified tree by
+   * tree, so that each tree stays in cache while it is used.
+   *
+   * @param data Dataset to classify.
+   * @param predictions This will be filled with the predicted class of each
+   *      point.
+   */
+  template<typename MatType>
+  void Classify(const MatType& data, arma::Row<size_t>& predictions) const;
+
+  /**
+   * Predict the classes of each point in the given dataset, and the average
+   * class probabilities over the trees; see the overload without
+   * probabilities.
+   *
+   * @param data Dataset to classify.
+   * @param predictions This will be filled with the predicted class of each
+   *      point.
+   * @param probabilities This will be filled with the class probabilities of
+   *      each point, one column per point.
+   */
+  template<typename MatType>
+  void Classify(const MatType& data,
+                arma::Row<size_t>& predictions,
+                arma::mat& probabilities) const;
+
+  //! Get the number of trees in the forest.
+  size_t NumTrees() const { return trees.size(); }
+
+  //! Get the tree of the given index.
+  const DecisionTreeType& Tree(const size_t i) const { return trees[i]; }
+  //! Modify the tree of the given index (be careful!).
+  DecisionTreeType& Tree(const size_t i) { return trees[i]; }
+
+  /**
+   * Serialize the random forest.
+   */
+  template<typename Archive>
+  void Serialize(Archive& ar, const unsigned int /* version */);
+
+ private:
+  /**
+   * Train the trees of the forest.  If UseDatasetInfo is false, datasetInfo is
+   * ignored and all dimensions are numeric.
+   */
+  template<bool UseDatasetInfo, typename MatType>
+  void Train(const MatType& data,
+             const data::DatasetInfo& datasetInfo,
+             const arma::Row<size_t>& labels,
+             const size_t numClasses,
+             const size_t numTrees,
+             const size_t minimumLeafSize,
+             const DimensionSelectionType& dimensionSelector);
+
+  //! The trees in the forest.
+  std::vector<DecisionTreeType> trees;
+};
+
+} // namespace tree
+} // namespace mlpack
+
+// Include implementation.
+#include "random_forest_impl.hpp"
+
+#endif
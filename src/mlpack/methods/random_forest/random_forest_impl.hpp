@@ -0,0 +1,383 @@
+/**
+ * @file random_forest_impl.hpp
+ *
+ * Implementation of the RandomForest class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_RANDOM_FOREST_RANDOM_FOREST_IMPL_HPP
+#define MLPACK_METHODS_RANDOM_FOREST_RANDOM_FOREST_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "random_forest.hpp"
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * This gives us a HasGeneratorCheck object that we can use to tell whether or
+ * not a dimension selection policy has a Generator() function.
+ */
+HAS_MEM_FUNC(Generator, HasGeneratorCheck);
+
+//! Give the random number generator to the dimension selection policy.
+template<typename DimensionSelectionType>
+void SetDimensionSelectionGenerator(
+    DimensionSelectionType& dimensionSelector,
+    std::mt19937& generator,
+    const typename std::enable_if_t<HasGeneratorCheck<DimensionSelectionType,
+        void(DimensionSelectionType::*)(std::mt19937&)>::value>* = 0)
+{
+  dimensionSelector.Generator(generator);
+}
+
+//! Dimension selection policies without a Generator() function don't need a
+//! random number generator.
+template<typename DimensionSelectionType>
+void SetDimensionSelectionGenerator(
+    DimensionSelectionType& /* dimensionSelector */,
+    std::mt19937& /* generator */,
+    const typename std::enable_if_t<!HasGeneratorCheck<DimensionSelectionType,
+        void(DimensionSelectionType::*)(std::mt19937&)>::value>* = 0)
+{ }
+
+template<typename FitnessFunction,
+         typename DimensionSelectionType,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType,
+         typename ElemType>
+template<typename MatType>
+RandomForest<FitnessFunction, DimensionSelectionType, NumericSplitType,
+             CategoricalSplitType, ElemType>::RandomForest(
+    const MatType& data,
+    const arma::Row<size_t>& labels,
+    const size_t numClasses,
+    const size_t numTrees,
+    const size_t minimumLeafSize,
+    const DimensionSelectionType& dimensionSelector)
+{
+  Train(data, labels, numClasses, numTrees, minimumLeafSize,
+      dimensionSelector);
+}
+
+template<typename FitnessFunction,
+         typename DimensionSelectionType,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType,
+         typename ElemType>
+template<typename MatType>
+RandomForest<FitnessFunction, DimensionSelectionType, NumericSplitType,
+             CategoricalSplitType, ElemType>::RandomForest(
+    const MatType& data,
+    const data::DatasetInfo& datasetInfo,
+    const arma::Row<size_t>& labels,
+    const size_t numClasses,
+    const size_t numTrees,
+    const size_t minimumLeafSize,
+    const DimensionSelectionType& dimensionSelector)
+{
+  Train(data, datasetInfo, labels, numClasses, numTrees, minimumLeafSize,
+      dimensionSelector);
+}
+
+template<typename FitnessFunction,
+         typename DimensionSelectionType,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType,
+         typename ElemType>
+template<typename MatType>
+void RandomForest<FitnessFunction, DimensionSelectionType, NumericSplitType,
+                  CategoricalSplitType, ElemType>::Train(
+    const MatType& data,
+    const arma::Row<size_t>& labels,
+    const size_t numClasses,
+    const size_t numTrees,
+    const size_t minimumLeafSize,
+    const DimensionSelectionType& dimensionSelector)
+{
+  // The dataset info is ignored.
+  Train<false>(data, data::DatasetInfo(data.n_rows), labels, numClasses,
+      numTrees, minimumLeafSize, dimensionSelector);
+}
+
+template<typename FitnessFunction,
+         typename DimensionSelectionType,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType,
+         typename ElemType>
+template<typename MatType>
+void RandomForest<FitnessFunction, DimensionSelectionType, NumericSplitType,
+                  CategoricalSplitType, ElemType>::Train(
+    const MatType& data,
+    const data::DatasetInfo& datasetInfo,
+    const arma::Row<size_t>& labels,
+    const size_t numClasses,
+    const size_t numTrees,
+    const size_t minimumLeafSize,
+    const DimensionSelectionType& dimensionSelector)
+{
+  Train<true>(data, datasetInfo, labels, numClasses, numTrees,
+      minimumLeafSize, dimensionSelector);
+}
+
+template<typename FitnessFunction,
+         typename DimensionSelectionType,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType,
+         typename ElemType>
+template<bool UseDatasetInfo, typename MatType>
+void RandomForest<FitnessFunction, DimensionSelectionType, NumericSplitType,
+                  CategoricalSplitType, ElemType>::Train(
+    const MatType& data,
+    const data::DatasetInfo& datasetInfo,
+    const arma::Row<size_t>& labels,
+    const size_t numClasses,
+    const size_t numTrees,
+    const size_t minimumLeafSize,
+    const DimensionSelectionType& dimensionSelector)
+{
+  // Sanity checks on the data, which the trees would otherwise make on each
+  // thread.
+  if (data.n_cols != labels.n_elem)
+  {
+    std::ostringstream oss;
+    oss << "RandomForest::Train(): number of points (" << data.n_cols << ") "
+        << "does not match number of labels (" << labels.n_elem << ")!"
+        << std::endl;
+    throw std::invalid_argument(oss.str());
+  }
+
+  if (numTrees == 0)
+  {
+    throw std::invalid_argument("RandomForest::Train(): the number of trees "
+        "must be positive!");
+  }
+
+  trees.clear();
+  trees.resize(numTrees);
+
+  // Seed the generator of each tree in order, so that the forest does not
+  // depend on which thread trains which tree.
+  std::vector<std::mt19937::result_type> seeds(numTrees);
+  for (size_t i = 0; i < numTrees; ++i)
+    seeds[i] = math::randGen();
+
+  // Each tree is trained on one thread.
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables. If we're building for Visual Studio, use
+  // the intmax_t type instead.
+  #pragma omp parallel for schedule(dynamic)
+  for (intmax_t i = 0; i < (intmax_t) numTrees; ++i)
+#else
+  #pragma omp parallel for schedule(dynamic)
+  for (size_t i = 0; i < numTrees; ++i)
+#endif
+  {
+    std::mt19937 generator(seeds[i]);
+
+    // Draw the bootstrap sample.  Each point that is drawn is used once, with
+    // the number of times that it was drawn as its weight.
+    arma::rowvec counts(data.n_cols, arma::fill::zeros);
+    std::uniform_real_distribution<> uniformDist;
+    for (size_t j = 0; j < data.n_cols; ++j)
+    {
+      counts[(size_t) std::floor((double) data.n_cols *
+          uniformDist(generator))]++;
+    }
+
+    const arma::uvec inBag = arma::find(counts > 0);
+    MatType bagData = data.cols(inBag);
+    arma::Row<size_t> bagLabels = labels.cols(inBag);
+    arma::rowvec bagWeights = counts.cols(inBag);
+
+    DimensionSelectionType treeDimensionSelector(dimensionSelector);
+    SetDimensionSelectionGenerator(treeDimensionSelector, generator);
+
+    if (UseDatasetInfo)
+    {
+      trees[i].Train(std::move(bagData), datasetInfo, std::move(bagLabels),
+          numClasses, std::move(bagWeights), minimumLeafSize,
+          treeDimensionSelector);
+    }
+    else
+    {
+      trees[i].Train(std::move(bagData), std::move(bagLabels), numClasses,
+          std::move(bagWeights), minimumLeafSize, treeDimensionSelector);
+    }
+  }
+}
+
+template<typename FitnessFunction,
+         typename DimensionSelectionType,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType,
+         typename ElemType>
+template<typename VecType>
+size_t RandomForest<FitnessFunction, DimensionSelectionType, NumericSplitType,
+                    CategoricalSplitType, ElemType>::Classify(
+    const VecType& point) const
+{
+  size_t prediction;
+  arma::vec probabilities;
+  Classify(point, prediction, probabilities);
+  return prediction;
+}
+
+template<typename FitnessFunction,
+         typename DimensionSelectionType,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType,
+         typename ElemType>
+template<typename VecType>
+void RandomForest<FitnessFunction, DimensionSelectionType, NumericSplitType,
+                  CategoricalSplitType, ElemType>::Classify(
+    const VecType& point,
+    size_t& prediction,
+    arma::vec& probabilities) const
+{
+  if (trees.size() == 0)
+  {
+    throw std::invalid_argument("RandomForest::Classify(): no random forest "
+        "trained!");
+  }
+
+  size_t treePrediction;
+  arma::vec treeProbabilities;
+  for (size_t i = 0; i < trees.size(); ++i)
+  {
+    trees[i].Classify(point, treePrediction, treeProbabilities);
+    if (i == 0)
+      probabilities = treeProbabilities;
+    else
+      probabilities += treeProbabilities;
+  }
+
+  probabilities /= trees.size();
+  arma::uword maxIndex;
+  probabilities.max(maxIndex);
+  prediction = (size_t) maxIndex;
+}
+
+template<typename FitnessFunction,
+         typename DimensionSelectionType,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType,
+         typename ElemType>
+template<typename MatType>
+void RandomForest<FitnessFunction, DimensionSelectionType, NumericSplitType,
+                  CategoricalSplitType, ElemType>::Classify(
+    const MatType& data,
+    arma::Row<size_t>& predictions) const
+{
+  arma::mat probabilities;
+  Classify(data, predictions, probabilities);
+}
+
+template<typename FitnessFunction,
+         typename DimensionSelectionType,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType,
+         typename ElemType>
+template<typename MatType>
+void RandomForest<FitnessFunction, DimensionSelectionType, NumericSplitType,
+                  CategoricalSplitType, ElemType>::Classify(
+    const MatType& data,
+    arma::Row<size_t>& predictions,
+    arma::mat& probabilities) const
+{
+  if (trees.size() == 0)
+  {
+    throw std::invalid_argument("RandomForest::Classify(): no random forest "
+        "trained!");
+  }
+
+  predictions.set_size(data.n_cols);
+  if (data.n_cols == 0)
+  {
+    probabilities.set_size(0, 0);
+    return;
+  }
+
+  // Find the number of classes from the first point.
+  size_t prediction;
+  arma::vec classProbabilities;
+  trees[0].Classify(data.col(0), prediction, classProbabilities);
+  probabilities.zeros(classProbabilities.n_elem, data.n_cols);
+
+#ifdef HAS_OPENMP
+  const size_t numThreads = std::min((size_t) omp_get_max_threads(),
+      (size_t) data.n_cols);
+#else
+  const size_t numThreads = 1;
+#endif
+
+  // Give each thread one contiguous block of points, and add up the class
+  // probabilities of the block tree by tree.
+  #pragma omp parallel num_threads(numThreads)
+  {
+#ifdef HAS_OPENMP
+    const size_t thread = omp_get_thread_num();
+#else
+    const size_t thread = 0;
+#endif
+    const size_t begin = (thread * data.n_cols) / numThreads;
+    const size_t end = ((thread + 1) * data.n_cols) / numThreads;
+
+    size_t treePrediction;
+    arma::vec treeProbabilities;
+    for (size_t i = 0; i < trees.size(); ++i)
+    {
+      for (size_t j = begin; j < end; ++j)
+      {
+        trees[i].Classify(data.col(j), treePrediction, treeProbabilities);
+        probabilities.col(j) += treeProbabilities;
+      }
+    }
+
+    for (size_t j = begin; j < end; ++j)
+    {
+      probabilities.col(j) /= trees.size();
+      arma::uword maxIndex;
+      probabilities.col(j).max(maxIndex);
+      predictions[j] = (size_t) maxIndex;
+    }
+  }
+}
+
+template<typename FitnessFunction,
+         typename DimensionSelectionType,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType,
+         typename ElemType>
+template<typename Archive>
+void RandomForest<FitnessFunction, DimensionSelectionType, NumericSplitType,
+                  CategoricalSplitType, ElemType>::Serialize(
+    Archive& ar,
+    const unsigned int /* version */)
+{
+  using data::CreateNVP;
+
+  size_t numTrees = trees.size();
+  ar & CreateNVP(numTrees, "numTrees");
+  if (Archive::is_loading::value)
+  {
+    trees.clear();
+    trees.resize(numTrees);
+  }
+
+  for (size_t i = 0; i < numTrees; ++i)
+  {
+    std::ostringstream name;
+    name << "tree" << i;
+    ar & CreateNVP(trees[i], name.str());
+  }
+}
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
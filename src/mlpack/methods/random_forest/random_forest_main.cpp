@@ -0,0 +1,239 @@
+/**
+ * @file random_forest_main.cpp
+ *
+ * A command-line program to train and evaluate a random forest.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include <mlpack/core.hpp>
+#include "random_forest.hpp"
+
+using namespace std;
+using namespace mlpack;
+using namespace mlpack::tree;
+
+PROGRAM_INFO("Random forest",
+    "Train and evaluate using a random forest.  Given a dataset containing "
+    "numeric features and associated labels for each point in the dataset, this"
+    " program can train a random forest on that data.  Each tree of the forest "
+    "is trained on a bootstrap sample of the dataset, and each node of each "
+    "tree only searches a random subset of the dimensions for the best split.  "
+    "The trees are trained in parallel, and the forest predicts the class with "
+    "the highest class probability averaged over the trees."
+    "\n\n"
+    "The training file and associated labels are specified with the "
+    "--training_file and --labels_file options, respectively.  The labels "
+    "should be in the range [0, num_classes - 1].  The number of trees is "
+    "given with --num_trees (-N), the minimum number of points in each leaf "
+    "with --minimum_leaf_size (-n), and the number of dimensions searched at "
+    "each node with --subspace_dim (-d); if --subspace_dim is 0, the square "
+    "root of the number of dimensions is used.  If --print_training_accuracy "
+    "(-a) is specified, the accuracy on the training set will be printed."
+    "\n\n"
+    "When a model is trained, it may be saved to file with the "
+    "--output_model_file (-M) option.  A model may be loaded from file for "
+    "predictions with the --input_model_file (-m) option.  The "
+    "--input_model_file option may not be specified when the --training_file "
+    "option is specified."
+    "\n\n"
+    "A file containing test data may be specified with the --test_file (-T) "
+    "option, and if performance numbers are desired for that test set, labels "
+    "may be specified with the --test_labels_file (-L) option.  Predictions "
+    "for each test point may be stored into the file specified by the "
+    "--predictions_file (-p) option.  Class probabilities for each prediction "
+    "will be stored in the file specified by the --probabilities_file (-P) "
+    "option.");
+
+// Datasets.
+PARAM_MATRIX_IN("training", "Matrix of training points.", "t");
+PARAM_UROW_IN("labels", "Training labels.", "l");
+PARAM_MATRIX_IN("test", "Matrix of test points.", "T");
+PARAM_UROW_IN("test_labels", "Test point labels, if accuracy calculation "
+    "is desired.", "L");
+
+// Training parameters.
+PARAM_INT_IN("num_trees", "Number of trees in the random forest.", "N", 10);
+PARAM_INT_IN("minimum_leaf_size", "Minimum number of points in a leaf.", "n",
+    1);
+PARAM_INT_IN("subspace_dim", "Number of dimensions to search at each node (0 "
+    "means the square root of the number of dimensions).", "d", 0);
+PARAM_INT_IN("seed", "Random seed.  If 0, 'std::time(NULL)' is used.", "s", 0);
+PARAM_FLAG("print_training_accuracy", "Print the training accuracy.", "a");
+
+// Output parameters.
+PARAM_MATRIX_OUT("probabilities", "Class probabilities for each test point.",
+    "P");
+PARAM_UROW_OUT("predictions", "Class predictions for each test point.", "p");
+
+/**
+ * This is the class that we will serialize.  It is a pretty simple wrapper
+ * around RandomForest<>.  In order to support categoricals, it will need to
+ * also hold and serialize a DatasetInfo.
+ */
+class RandomForestModel
+{
+ public:
+  // The forest itself, left public for direct access by this program.
+  RandomForest<> rf;
+
+  // Create the model.
+  RandomForestModel() { /* Nothing to do. */ }
+
+  // Serialize the model.
+  template<typename Archive>
+  void Serialize(Archive& ar, const unsigned int /* version */)
+  {
+    ar & data::CreateNVP(rf, "rf");
+  }
+};
+
+// Models.
+PARAM_MODEL_IN(RandomForestModel, "input_model", "Pre-trained random forest, "
+    "to be used with test points.", "m");
+PARAM_MODEL_OUT(RandomForestModel, "output_model", "Model to save trained "
+    "random forest to.", "M");
+
+int main(int argc, char** argv)
+{
+  CLI::ParseCommandLine(argc, argv);
+
+  // Initialize random seed.
+  if (CLI::GetParam<int>("seed") != 0)
+    math::RandomSeed((size_t) CLI::GetParam<int>("seed"));
+  else
+    math::RandomSeed((size_t) std::time(NULL));
+
+  // Check parameters.
+  if (CLI::HasParam("training") && CLI::HasParam("input_model"))
+    Log::Fatal << "Cannot specify both --training_file and --input_model_file!"
+        << endl;
+
+  if (!CLI::HasParam("training") && !CLI::HasParam("input_model"))
+    Log::Fatal << "One of --training_file or --input_model_file must be "
+        << "specified!" << endl;
+
+  if (CLI::HasParam("training") && !CLI::HasParam("labels"))
+    Log::Fatal << "--labels_file must be specified with --training_file!"
+        << endl;
+
+  if (CLI::GetParam<int>("num_trees") <= 0)
+    Log::Fatal << "--num_trees must be positive!" << endl;
+
+  if (CLI::GetParam<int>("minimum_leaf_size") <= 0)
+    Log::Fatal << "--minimum_leaf_size must be positive!" << endl;
+
+  if (CLI::GetParam<int>("subspace_dim") < 0)
+    Log::Fatal << "--subspace_dim must be non-negative!" << endl;
+
+  if (CLI::HasParam("test_labels") && !CLI::HasParam("test"))
+    Log::Warn << "--test_labels_file ignored because --test_file is not passed."
+        << endl;
+
+  if (!CLI::HasParam("output_model") && !CLI::HasParam("probabilities") &&
+      !CLI::HasParam("predictions") && !CLI::HasParam("test_labels"))
+    Log::Warn << "None of --output_model_file, --probabilities_file, or "
+        << "--predictions_file are given, and accuracy is not being calculated;"
+        << " no output will be saved!" << endl;
+
+  if (CLI::HasParam("print_training_accuracy") && !CLI::HasParam("training"))
+    Log::Warn << "--print_training_accuracy ignored because --training_file is"
+        << " not specified." << endl;
+
+  if (!CLI::HasParam("test"))
+  {
+    if (CLI::HasParam("probabilities"))
+      Log::Warn << "--probabilities_file ignored because --test_file is not "
+          << "specified." << endl;
+    if (CLI::HasParam("predictions"))
+      Log::Warn << "--predictions_file ignored because --test_file is not "
+          << "specified." << endl;
+  }
+
+  // Load the model or build the forest.
+  RandomForestModel model;
+
+  if (CLI::HasParam("training"))
+  {
+    arma::mat dataset = std::move(CLI::GetParam<arma::mat>("training"));
+    arma::Row<size_t> labels =
+        std::move(CLI::GetParam<arma::Row<size_t>>("labels"));
+
+    if (labels.n_elem != dataset.n_cols)
+      Log::Fatal << "Number of labels (" << labels.n_elem << ") does not match "
+          << "the number of training points (" << dataset.n_cols << ")!"
+          << endl;
+
+    // Calculate number of classes.
+    const size_t numClasses = arma::max(labels) + 1;
+
+    const size_t numTrees = (size_t) CLI::GetParam<int>("num_trees");
+    const size_t minLeafSize = (size_t) CLI::GetParam<int>("minimum_leaf_size");
+    MultipleRandomDimensionSelect dimensionSelector(
+        (size_t) CLI::GetParam<int>("subspace_dim"));
+
+    Timer::Start("rf_training");
+    model.rf.Train(dataset, labels, numClasses, numTrees, minLeafSize,
+        dimensionSelector);
+    Timer::Stop("rf_training");
+
+    // Do we need to print training accuracy?
+    if (CLI::HasParam("print_training_accuracy"))
+    {
+      arma::Row<size_t> predictions;
+      model.rf.Classify(dataset, predictions);
+
+      const size_t correct = arma::accu(predictions == labels);
+
+      // Print number of correct points.
+      Log::Info << double(correct) / double(dataset.n_cols) * 100 << "%% "
+          << "correct on training set (" << correct << " / " << dataset.n_cols
+          << ")." << endl;
+    }
+  }
+  else
+  {
+    model = std::move(CLI::GetParam<RandomForestModel>("input_model"));
+  }
+
+  // Do we need to get predictions?
+  if (CLI::HasParam("test"))
+  {
+    arma::mat testPoints = std::move(CLI::GetParam<arma::mat>("test"));
+
+    arma::Row<size_t> predictions;
+    arma::mat probabilities;
+
+    Timer::Start("rf_prediction");
+    model.rf.Classify(testPoints, predictions, probabilities);
+    Timer::Stop("rf_prediction");
+
+    // Do we need to calculate accuracy?
+    if (CLI::HasParam("test_labels"))
+    {
+      arma::Row<size_t> testLabels =
+          std::move(CLI::GetParam<arma::Row<size_t>>("test_labels"));
+
+      const size_t correct = arma::accu(predictions == testLabels);
+
+      // Print number of correct points.
+      Log::Info << double(correct) / double(testPoints.n_cols) * 100 << "%% "
+          << "correct on test set (" << correct << " / " << testPoints.n_cols
+          << ")." << endl;
+    }
+
+    // Do we need to save outputs?
+    if (CLI::HasParam("predictions"))
+      CLI::GetParam<arma::Row<size_t>>("predictions") = std::move(predictions);
+    if (CLI::HasParam("probabilities"))
+      CLI::GetParam<arma::mat>("probabilities") = std::move(probabilities);
+  }
+
+  // Do we need to save the model?
+  if (CLI::HasParam("output_model"))
+    CLI::GetParam<RandomForestModel>("output_model") = std::move(model);
+
+  CLI::Destroy();
+}
@@ -0,0 +1,180 @@
+/**
+ * @file random_sketch.cpp
+ *
+ * Implementation of the RandomSketch class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "random_sketch.hpp"
+
+#include <mlpack/core/math/random.hpp>
+
+namespace mlpack {
+namespace svd {
+
+RandomSketch::RandomSketch(const SketchType type, const size_t blockSize) :
+    type(type),
+    blockSize(blockSize),
+    rows(0),
+    cols(0)
+{
+  // Nothing to do.
+}
+
+void RandomSketch::Reset(const size_t rows, const size_t cols)
+{
+  this->rows = rows;
+  this->cols = cols;
+
+  const uint64_t seed = ((uint64_t) math::randGen() << 32) |
+      (uint64_t) math::randGen();
+
+  if (type == GAUSSIAN)
+  {
+    buckets.reset();
+    signs.reset();
+
+    gaussian.set_size(rows, cols);
+    Randn(gaussian, seed, blockSize);
+  }
+  else
+  {
+    gaussian.reset();
+
+    // Drawing one column and one sign per row is cheap next to applying the
+    // sketch, so it is done with a single stream.
+    math::RandomStream stream(seed, 0);
+    buckets.set_size(rows);
+    signs.set_size(rows);
+    for (size_t i = 0; i < rows; ++i)
+    {
+      buckets[i] = std::min((size_t) (stream.Random() * cols), cols - 1);
+      signs[i] = (stream.Random() < 0.5) ? -1.0 : 1.0;
+    }
+  }
+}
+
+void RandomSketch::Apply(const arma::mat& data, arma::mat& output) const
+{
+  if (data.n_cols != rows)
+  {
+    Log::Fatal << "RandomSketch::Apply(): the matrix has " << data.n_cols
+        << " columns, but the sketch has " << rows << " rows!" << std::endl;
+  }
+
+  if (type == GAUSSIAN)
+  {
+    output = data * gaussian;
+    return;
+  }
+
+  output.zeros(data.n_rows, cols);
+
+  // Each thread adds up the columns of data for its own block of rows, so the
+  // threads never write to the same entries.
+#ifdef HAS_OPENMP
+  const size_t threads = omp_get_max_threads();
+#else
+  const size_t threads = 1;
+#endif
+  const size_t rowBlock = std::max((size_t) 64,
+      (data.n_rows + threads - 1) / threads);
+  const size_t numBlocks = (data.n_rows + rowBlock - 1) / rowBlock;
+
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables. If we're building for Visual Studio, use
+  // the intmax_t type instead.
+  #pragma omp parallel for schedule(static)
+  for (intmax_t b = 0; b < (intmax_t) numBlocks; ++b)
+#else
+  #pragma omp parallel for schedule(static)
+  for (size_t b = 0; b < numBlocks; ++b)
+#endif
+  {
+    const size_t begin = b * rowBlock;
+    const size_t end = std::min(begin + rowBlock, (size_t) data.n_rows);
+    for (size_t i = 0; i < data.n_cols; ++i)
+    {
+      const double* in = data.colptr(i);
+      double* out = output.colptr(buckets[i]);
+      const double sign = signs[i];
+      for (size_t r = begin; r < end; ++r)
+        out[r] += sign * in[r];
+    }
+  }
+}
+
+void RandomSketch::ApplyTransposed(const arma::mat& data,
+                                   arma::mat& output) const
+{
+  if (data.n_rows != rows)
+  {
+    Log::Fatal << "RandomSketch::ApplyTransposed(): the matrix has "
+        << data.n_rows << " rows, but the sketch has " << rows << " rows!"
+        << std::endl;
+  }
+
+  if (type == GAUSSIAN)
+  {
+    output = data.t() * gaussian;
+    return;
+  }
+
+  output.zeros(data.n_cols, cols);
+
+  // Row j of the result only depends on column j of data.
+#ifdef _WIN32
+  #pragma omp parallel for schedule(static)
+  for (intmax_t j = 0; j < (intmax_t) data.n_cols; ++j)
+#else
+  #pragma omp parallel for schedule(static)
+  for (size_t j = 0; j < data.n_cols; ++j)
+#endif
+  {
+    const double* in = data.colptr(j);
+    for (size_t i = 0; i < data.n_rows; ++i)
+      output(j, buckets[i]) += signs[i] * in[i];
+  }
+}
+
+void RandomSketch::ColumnSums(arma::rowvec& sums) const
+{
+  if (type == GAUSSIAN)
+  {
+    sums = arma::sum(gaussian, 0);
+    return;
+  }
+
+  sums.zeros(cols);
+  for (size_t i = 0; i < rows; ++i)
+    sums[buckets[i]] += signs[i];
+}
+
+void RandomSketch::Randn(arma::mat& matrix,
+                         const uint64_t seed,
+                         const size_t blockSize)
+{
+  const size_t numBlocks = (matrix.n_elem + blockSize - 1) / blockSize;
+  double* memory = matrix.memptr();
+
+#ifdef _WIN32
+  #pragma omp parallel for schedule(static)
+  for (intmax_t b = 0; b < (intmax_t) numBlocks; ++b)
+#else
+  #pragma omp parallel for schedule(static)
+  for (size_t b = 0; b < numBlocks; ++b)
+#endif
+  {
+    const size_t begin = b * blockSize;
+    const size_t count = std::min(blockSize, (size_t) matrix.n_elem - begin);
+    math::RandomStream stream(seed, b);
+    stream.FillNormal(memory + begin, count);
+  }
+}
+
+} // namespace svd
+} // namespace mlpack
@@ -0,0 +1,151 @@
+/**
+ * @file random_sketch.hpp
+ *
+ * Random test matrices for the randomized SVD methods, drawn in parallel and
+ * applied without forming a dense matrix when they are sparse.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_RANDOMIZED_SVD_RANDOM_SKETCH_HPP
+#define MLPACK_METHODS_RANDOMIZED_SVD_RANDOM_SKETCH_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace svd {
+
+/**
+ * A RandomSketch is the random test matrix Omega used by the randomized SVD
+ * methods to find the range of a matrix (data * Omega).  It can be
+ *
+ *  - a Gaussian matrix, whose entries are drawn in parallel, one block of
+ *    entries per random stream, so that the matrix only depends on the random
+ *    seed and not on the number of threads;
+ *
+ *  - a CountSketch matrix, with a single nonzero entry (+1 or -1) in each row,
+ *    in a random column.  Only the column and the sign of each row are stored,
+ *    and data * Omega is computed by adding up the (signed) columns of data,
+ *    in parallel, without any dense test matrix.
+ *
+ * For more information on the CountSketch matrix, see the following.
+ *
+ * @code
+ * @inproceedings{Clarkson2013,
+ *   author    = {Clarkson, Kenneth L. and Woodruff, David P.},
+ *   title     = {Low Rank Approximation and Regression in Input Sparsity
+ *                Time},
+ *   booktitle = {Proceedings of the 45th Annual ACM Symposium on Theory of
+ *                Computing},
+ *   pages     = {81--90},
+ *   year      = {2013}
+ * }
+ * @endcode
+ */
+class RandomSketch
+{
+ public:
+  //! The kind of test matrix.
+  enum SketchType
+  {
+    GAUSSIAN,
+    COUNT_SKETCH
+  };
+
+  /**
+   * Create the sketch.  No test matrix is drawn until Reset() is called.
+   *
+   * @param type The kind of test matrix.
+   * @param blockSize Number of entries of a Gaussian test matrix drawn from
+   *        each random stream.
+   */
+  RandomSketch(const SketchType type = GAUSSIAN,
+               const size_t blockSize = 65536);
+
+  /**
+   * Draw a new test matrix of the given size.  The seed of the test matrix is
+   * drawn from the mlpack random number generator, so it is reproducible with
+   * math::RandomSeed().
+   *
+   * @param rows Number of rows of the test matrix.
+   * @param cols Number of columns of the test matrix.
+   */
+  void Reset(const size_t rows, const size_t cols);
+
+  /**
+   * Compute data * Omega.  data must have as many columns as the test matrix
+   * has rows.
+   *
+   * @param data Matrix to sketch.
+   * @param output Matrix to store the result into.
+   */
+  void Apply(const arma::mat& data, arma::mat& output) const;
+
+  /**
+   * Compute data^T * Omega.  data must have as many rows as the test matrix
+   * has rows.
+   *
+   * @param data Matrix to sketch.
+   * @param output Matrix to store the result into.
+   */
+  void ApplyTransposed(const arma::mat& data, arma::mat& output) const;
+
+  /**
+   * Compute the sum of each column of the test matrix (1^T * Omega).
+   *
+   * @param sums Vector to store the sums into.
+   */
+  void ColumnSums(arma::rowvec& sums) const;
+
+  /**
+   * Fill the given matrix with numbers of the standard normal distribution.
+   * The entries are drawn in parallel, with the i-th block of blockSize
+   * entries drawn from the i-th random stream of the given seed.
+   *
+   * @param matrix Matrix to fill.
+   * @param seed Seed of the random streams.
+   * @param blockSize Number of entries drawn from each random stream.
+   */
+  static void Randn(arma::mat& matrix,
+                    const uint64_t seed,
+                    const size_t blockSize = 65536);
+
+  //! Get the kind of test matrix.
+  SketchType Type() const { return type; }
+  //! Modify the kind of test matrix.  Reset() must be called afterwards.
+  SketchType& Type() { return type; }
+
+  //! Get the number of rows of the test matrix.
+  size_t Rows() const { return rows; }
+  //! Get the number of columns of the test matrix.
+  size_t Cols() const { return cols; }
+
+ private:
+  //! The kind of test matrix.
+  SketchType type;
+
+  //! Number of entries of a Gaussian test matrix drawn from each stream.
+  size_t blockSize;
+
+  //! Number of rows of the test matrix.
+  size_t rows;
+
+  //! Number of columns of the test matrix.
+  size_t cols;
+
+  //! The Gaussian test matrix (empty for a CountSketch test matrix).
+  arma::mat gaussian;
+
+  //! The column of the nonzero entry of each row of a CountSketch matrix.
+  arma::Col<size_t> buckets;
+
+  //! The sign of the nonzero entry of each row of a CountSketch matrix.
+  arma::vec signs;
+};
+
+} // namespace svd
+} // namespace mlpack
+
+#endif
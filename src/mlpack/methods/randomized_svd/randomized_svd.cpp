@@ -22,10 +22,12 @@ RandomizedSVD::RandomizedSVD(const arma::mat& data,
                              const size_t iteratedPower,
                              const size_t maxIterations,
                              const size_t rank,
-                             const double eps) :
+                             const double eps,
+                             const RandomSketch::SketchType sketchType) :
     iteratedPower(iteratedPower),
     maxIterations(maxIterations),
-    eps(eps)
+    eps(eps),
+    sketchType(sketchType)
 {
   if (rank == 0)
   {
@@ -39,10 +41,12 @@ RandomizedSVD::RandomizedSVD(const arma::mat& data,
 
 RandomizedSVD::RandomizedSVD(const size_t iteratedPower,
                              const size_t maxIterations,
-                             const double eps) :
+                             const double eps,
+                             const RandomSketch::SketchType sketchType) :
     iteratedPower(iteratedPower),
     maxIterations(maxIterations),
-    eps(eps)
+    eps(eps),
+    sketchType(sketchType)
 {
   /* Nothing to do here */
 }
@@ -56,33 +60,43 @@ void RandomizedSVD::Apply(const arma::mat& data,
   if (iteratedPower == 0)
     iteratedPower = rank + 2;
 
-  // Center the data into a temporary matrix.
+  // The data is never centered in memory: the mean of each row is subtracted
+  // from the products with the data instead.
   arma::vec rowMean = arma::sum(data, 1) / data.n_cols + eps;
 
-  arma::mat R, Q, Qdata;
+  // The workspaces of the power iterations.  Q has one row per point (or per
+  // dimension, if there are fewer points than dimensions) and P has one row
+  // per dimension (or per point); products are written into them directly,
+  // so they are allocated only once.
+  arma::mat Q, P, factor;
+  arma::rowvec sums;
+  RandomSketch sketch(sketchType);
 
   // Apply the centered data matrix to a random matrix, obtaining Q.
   if (data.n_cols >= data.n_rows)
   {
-    R = arma::randn<arma::mat>(data.n_rows, iteratedPower);
-    Q = (data.t() * R) - arma::repmat(arma::trans(R.t() * rowMean),
-        data.n_cols, 1);
+    sketch.Reset(data.n_rows, iteratedPower);
+    sketch.ApplyTransposed(data, Q);
+    sketch.ApplyTransposed(rowMean, P);
+    Q.each_row() -= P;
   }
   else
   {
-    R = arma::randn<arma::mat>(data.n_cols, iteratedPower);
-    Q = (data * R) - (rowMean * (arma::ones(1, data.n_cols) * R));
+    sketch.Reset(data.n_cols, iteratedPower);
+    sketch.Apply(data, Q);
+    sketch.ColumnSums(sums);
+    Q -= rowMean * sums;
   }
 
   // Form a matrix Q whose columns constitute a
   // well-conditioned basis for the columns of the earlier Q.
   if (maxIterations == 0)
   {
-    arma::qr_econ(Q, v, Q);
+    arma::qr_econ(Q, factor, Q);
   }
   else
   {
-    arma::lu(Q, v, Q);
+    arma::lu(Q, factor, Q);
   }
 
   // Perform normalized power iterations.
@@ -90,15 +104,19 @@ void RandomizedSVD::Apply(const arma::mat& data,
   {
     if (data.n_cols >= data.n_rows)
     {
-      Q = (data * Q) - rowMean * (arma::ones(1, data.n_cols) * Q);
-      arma::lu(Q, v, Q);
-      Q = (data.t() * Q) - arma::repmat(rowMean.t() * Q, data.n_cols, 1);
+      P = data * Q;
+      P -= rowMean * arma::sum(Q, 0);
+      arma::lu(P, factor, P);
+      Q = data.t() * P;
+      Q.each_row() -= rowMean.t() * P;
     }
     else
     {
-      Q = (data.t() * Q) - arma::repmat(rowMean.t() * Q, data.n_cols, 1);
-      arma::lu(Q, v, Q);
-      Q = (data * Q) - (rowMean * (arma::ones(1, data.n_cols) * Q));
+      P = data.t() * Q;
+      P.each_row() -= rowMean.t() * Q;
+      arma::lu(P, factor, P);
+      Q = data * P;
+      Q -= rowMean * arma::sum(P, 0);
     }
 
     // Computing the LU decomposition is more efficient than computing the QR
@@ -107,27 +125,29 @@ void RandomizedSVD::Apply(const arma::mat& data,
     // orthonormal.
     if (i < (maxIterations - 1))
     {
-      arma::lu(Q, v, Q);
+      arma::lu(Q, factor, Q);
     }
     else
     {
-      arma::qr_econ(Q, v, Q);
+      arma::qr_econ(Q, factor, Q);
     }
   }
 
   // Do economical singular value decomposition and compute only the
   // approximations of the left singular vectors by using the centered data
-  // applied to Q.
+  // applied to Q.  P is reused for the projection of the data.
   if (data.n_cols >= data.n_rows)
   {
-    Qdata = (data * Q) - rowMean * (arma::ones(1, data.n_cols) * Q);
-    arma::svd_econ(u, s, v, Qdata);
+    P = data * Q;
+    P -= rowMean * arma::sum(Q, 0);
+    arma::svd_econ(u, s, v, P);
     v = Q * v;
   }
   else
   {
-    Qdata = (Q.t() * data) - arma::repmat(Q.t() * rowMean, 1,  data.n_cols);
-    arma::svd_econ(u, s, v, Qdata);
+    P = Q.t() * data;
+    P.each_col() -= Q.t() * rowMean;
+    arma::svd_econ(u, s, v, P);
     u = Q * u;
   }
 }
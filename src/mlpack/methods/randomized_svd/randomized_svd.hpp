@@ -15,6 +15,8 @@
 
 #include <mlpack/prereqs.hpp>
 
+#include "random_sketch.hpp"
+
 namespace mlpack {
 namespace svd {
 
@@ -47,6 +49,11 @@ namespace svd {
  * }
  * @endcode
  *
+ * The random test matrix is a RandomSketch: either a Gaussian matrix drawn in
+ * parallel, or a sparse CountSketch matrix that is never formed.  The power
+ * iterations reuse the same workspaces, and the data is never centered in
+ * memory.
+ *
  * An example of how to use the interface is shown below:
  *
  * @code
@@ -80,6 +87,7 @@ class RandomizedSVD
    * @param rank Rank of the approximation (Default: number of rows.)
    * @param eps The eps coefficient to avoid division by zero (numerical
    *        stability).
+   * @param sketchType The kind of random test matrix.
    */
   RandomizedSVD(const arma::mat& data,
                 arma::mat& u,
@@ -88,7 +96,9 @@ class RandomizedSVD
                 const size_t iteratedPower = 0,
                 const size_t maxIterations = 2,
                 const size_t rank = 0,
-                const double eps = 1e-7);
+                const double eps = 1e-7,
+                const RandomSketch::SketchType sketchType =
+                    RandomSketch::GAUSSIAN);
 
   /**
    * Create object for the randomized SVD method.
@@ -99,10 +109,13 @@ class RandomizedSVD
    *        (Default: 2).
    * @param eps The eps coefficient to avoid division by zero (numerical
    *        stability).
+   * @param sketchType The kind of random test matrix.
    */
   RandomizedSVD(const size_t iteratedPower = 0,
                 const size_t maxIterations = 2,
-                const double eps = 1e-7);
+                const double eps = 1e-7,
+                const RandomSketch::SketchType sketchType =
+                    RandomSketch::GAUSSIAN);
 
   /**
    * Apply Principal Component Analysis to the provided data set using the
@@ -120,6 +133,34 @@ class RandomizedSVD
              arma::mat& v,
              const size_t rank);
 
+  /**
+   * Compute the randomized SVD of a matrix that is only known through its
+   * products with dense matrices, such as a sparse plus low-rank matrix.  The
+   * matrix is not centered, and the random test matrix is Gaussian.  The
+   * operator must provide
+   *
+   * @code
+   * size_t Rows() const;
+   * size_t Cols() const;
+   * // Set output to A * x.
+   * void Apply(const arma::mat& x, arma::mat& output) const;
+   * // Set output to A^T * x.
+   * void ApplyTransposed(const arma::mat& x, arma::mat& output) const;
+   * @endcode
+   *
+   * @param op Operator to decompose.
+   * @param u First unitary matrix.
+   * @param s Vector of singular values.
+   * @param v Second unitary matrix.
+   * @param rank Rank of the approximation.
+   */
+  template<typename OperatorType>
+  void ApplyOperator(const OperatorType& op,
+                     arma::mat& u,
+                     arma::vec& s,
+                     arma::mat& v,
+                     const size_t rank) const;
+
   //! Get the size of the normalized power iterations.
   size_t IteratedPower() const { return iteratedPower; }
   //! Modify the size of the normalized power iterations.
@@ -135,6 +176,11 @@ class RandomizedSVD
   //! Modify the value used for decomposition stability.
   double& Epsilon() { return eps; }
 
+  //! Get the kind of random test matrix.
+  RandomSketch::SketchType SketchType() const { return sketchType; }
+  //! Modify the kind of random test matrix.
+  RandomSketch::SketchType& SketchType() { return sketchType; }
+
  private:
   //! Locally stored size of the normalized power iterations.
   size_t iteratedPower;
@@ -144,9 +190,15 @@ class RandomizedSVD
 
   //! The value used for numerical stability.
   double eps;
+
+  //! The kind of random test matrix.
+  RandomSketch::SketchType sketchType;
 };
 
 } // namespace svd
 } // namespace mlpack
 
+// Include implementation of templated functions.
+#include "randomized_svd_impl.hpp"
+
 #endif
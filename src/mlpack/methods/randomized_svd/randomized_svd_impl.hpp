@@ -0,0 +1,65 @@
+/**
+ * @file randomized_svd_impl.hpp
+ *
+ * Implementation of the templated functions of the RandomizedSVD class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_RANDOMIZED_SVD_RANDOMIZED_SVD_IMPL_HPP
+#define MLPACK_METHODS_RANDOMIZED_SVD_RANDOMIZED_SVD_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "randomized_svd.hpp"
+
+namespace mlpack {
+namespace svd {
+
+template<typename OperatorType>
+void RandomizedSVD::ApplyOperator(const OperatorType& op,
+                                  arma::mat& u,
+                                  arma::vec& s,
+                                  arma::mat& v,
+                                  const size_t rank) const
+{
+  const size_t l = std::min((iteratedPower == 0) ? rank + 2 : iteratedPower,
+      std::min(op.Rows(), op.Cols()));
+
+  // Apply the operator to a random matrix, obtaining Q.
+  arma::mat Q, P, factor;
+  op.Apply(arma::randn<arma::mat>(op.Cols(), l), Q);
+
+  // Form a matrix Q whose columns constitute a well-conditioned basis for the
+  // columns of the earlier Q.
+  if (maxIterations == 0)
+    arma::qr_econ(Q, factor, Q);
+  else
+    arma::lu(Q, factor, Q);
+
+  // Perform normalized power iterations; only the last one orthonormalizes Q
+  // with a QR decomposition.
+  for (size_t i = 0; i < maxIterations; ++i)
+  {
+    op.ApplyTransposed(Q, P);
+    arma::lu(P, factor, P);
+    op.Apply(P, Q);
+
+    if (i < (maxIterations - 1))
+      arma::lu(Q, factor, Q);
+    else
+      arma::qr_econ(Q, factor, Q);
+  }
+
+  // A ~= Q Q^T A, and the SVD of (Q^T A)^T = A^T Q = V S W^T gives
+  // A ~= (Q W) S V^T.
+  op.ApplyTransposed(Q, P);
+  arma::svd_econ(v, s, factor, P);
+  u = Q * factor;
+}
+
+} // namespace svd
+} // namespace mlpack
+
+#endif
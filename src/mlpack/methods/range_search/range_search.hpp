@@ -16,7 +16,10 @@
 #include <mlpack/prereqs.hpp>
 #include <mlpack/core/metrics/lmetric.hpp>
 #include <mlpack/core/tree/binary_space_tree.hpp>
+#include <mlpack/core/tree/independent_subtrees.hpp>
+#include <mlpack/core/tree/traversal_statistics.hpp>
 #include "range_search_stat.hpp"
+#include "range_search_callbacks.hpp"
 
 namespace mlpack {
 namespace range /** Range-search routines. */ {
@@ -30,6 +33,11 @@ class TrainVisitor;
  * algorithm; for more details on the actual algorithm, see the RangeSearchRules
  * class.
  *
+ * If OpenMP is available, searches are run in parallel: dual-tree searches
+ * split the query tree into independent subtrees, and naive and single-tree
+ * searches split the query points into blocks.  The number of threads can be
+ * set with NumThreads().
+ *
  * @tparam MetricType Metric to use for range search calculations.
  * @tparam MatType Type of data to use.
  * @tparam TreeType Type of tree to use; must satisfy the TreeType policy API.
@@ -192,6 +200,18 @@ class RangeSearch
    */
   void Train(Tree* referenceTree);
 
+  /**
+   * Set the reference tree to a new reference tree, taking ownership of the
+   * tree.  If the tree rearranges its dataset, the given mapping is used to map
+   * the results back to the original indices of the points.
+   *
+   * @param referenceTree New reference tree.
+   * @param oldFromNewReferences Mapping from the indices of the tree's dataset
+   *     to the original indices, as filled during construction of the tree.
+   */
+  void Train(Tree&& referenceTree,
+             std::vector<size_t>&& oldFromNewReferences);
+
   /**
    * Search for all reference points in the given range for each point in the
    * query set, returning the results in the neighbors and distances objects.
@@ -299,6 +319,172 @@ class RangeSearch
               std::vector<std::vector<size_t>>& neighbors,
               std::vector<std::vector<double>>& distances);
 
+  /**
+   * Search for all reference points in the given range for each point in the
+   * query set, passing each result to the given callback as soon as it is
+   * found, instead of storing the results.  The callback is called as
+   *
+   * @code
+   * callback(queryIndex, referenceIndex, distance);
+   * @endcode
+   *
+   * for each reference point whose distance to a query point falls into the
+   * range.  The indices are those of the original query and reference sets.
+   * Results are not passed in any particular order, and each pair of points is
+   * passed only once.  In a parallel search, each thread passes its results on
+   * in batches, and the callback is never called by two threads at once,
+   * unless RangeSearchCallbackTraits says that the callback may be; then each
+   * thread calls it directly.  For instance, to count the neighbors of each
+   * point:
+   *
+   * @code
+   * arma::Col<size_t> counts(querySet.n_cols, arma::fill::zeros);
+   * auto count = [&counts](const size_t q, const size_t, const double)
+   *     { ++counts[q]; };
+   * rs.Search(querySet, math::Range(0.0, 1.0), count);
+   * @endcode
+   *
+   * @param querySet Set of query points to search with.
+   * @param range Range of distances in which to search.
+   * @param callback Callback to pass each result to.
+   */
+  template<typename CallbackType>
+  void Search(const MatType& querySet,
+              const math::Range& range,
+              CallbackType& callback);
+
+  /**
+   * Given a pre-built query tree, search for all reference points in the given
+   * range for each point in the query set, passing each result to the given
+   * callback (see the overload that takes a query set).  Query indices are
+   * indices into the query tree's dataset.  If either naive or singleMode are
+   * set to true, this will throw an invalid_argument exception.
+   *
+   * @param queryTree Tree built on query points.
+   * @param range Range of distances in which to search.
+   * @param callback Callback to pass each result to.
+   */
+  template<typename CallbackType>
+  void Search(Tree* queryTree,
+              const math::Range& range,
+              CallbackType& callback);
+
+  /**
+   * Search for all points in the given range for each point in the reference
+   * set, passing each result to the given callback (see the overload that
+   * takes a query set).  A point is not returned as its own neighbor.
+   *
+   * @param range Range of distances in which to search.
+   * @param callback Callback to pass each result to.
+   */
+  template<typename CallbackType>
+  void Search(const math::Range& range, CallbackType& callback);
+
+  /**
+   * Search for all reference points in the given range for each point in the
+   * query set, and return the results in compressed sparse row (CSR) form:
+   * the neighbors of query point i are neighbors[offsets[i]] through
+   * neighbors[offsets[i + 1] - 1], and distances holds their distances at the
+   * same positions.  This holds the same results as the overload that returns
+   * a vector for each query point, in the same order, but in three flat
+   * vectors.
+   *
+   * @param querySet Set of query points to search with.
+   * @param range Range of distances in which to search.
+   * @param offsets Will hold querySet.n_cols + 1 offsets into neighbors and
+   *      distances.
+   * @param neighbors Will hold the neighbors of all query points.
+   * @param distances Will hold the distances of all query points.
+   */
+  void Search(const MatType& querySet,
+              const math::Range& range,
+              std::vector<size_t>& offsets,
+              std::vector<size_t>& neighbors,
+              std::vector<double>& distances);
+
+  /**
+   * Search for all points in the given range for each point in the reference
+   * set, and return the results in compressed sparse row (CSR) form (see the
+   * overload that takes a query set).
+   *
+   * @param range Range of distances in which to search.
+   * @param offsets Will hold one more offset than there are reference points.
+   * @param neighbors Will hold the neighbors of all points.
+   * @param distances Will hold the distances of all points.
+   */
+  void Search(const math::Range& range,
+              std::vector<size_t>& offsets,
+              std::vector<size_t>& neighbors,
+              std::vector<double>& distances);
+
+  /**
+   * Count the reference points in the given range of each point in the query
+   * set, without storing them.  When the bounds of a node show that all of its
+   * points are in the range, its number of points is added at once, so dense
+   * ranges cost far less than a search.
+   *
+   * @param querySet Set of query points to search with.
+   * @param range Range of distances in which to search.
+   * @param counts Will hold the number of points in the range of each query
+   *      point.
+   */
+  void Count(const MatType& querySet,
+             const math::Range& range,
+             arma::Col<size_t>& counts);
+
+  /**
+   * Count the other reference points in the given range of each point in the
+   * reference set (see the overload that takes a query set).
+   *
+   * @param range Range of distances in which to search.
+   * @param counts Will hold the number of points in the range of each point.
+   */
+  void Count(const math::Range& range, arma::Col<size_t>& counts);
+
+  /**
+   * Sum a kernel of the distances of the reference points in the given range
+   * of each point in the query set, without storing them (see
+   * RangeSearchKernelSumCallback).  The kernel must have a 'double
+   * Evaluate(const double distance)' function that doesn't increase with the
+   * distance.  When the bounds of a node show that all of its points are in
+   * the range and that the kernel varies little enough over them, the node is
+   * added at once.
+   *
+   * @param querySet Set of query points to search with.
+   * @param range Range of distances in which to search.
+   * @param kernel Instantiated kernel.
+   * @param sums Will hold the kernel sum of each query point.
+   * @param relativeError Largest relative error of each kernel value (0 gives
+   *      exact sums).
+   * @param absoluteError Largest absolute error of each kernel value.
+   */
+  template<typename KernelType>
+  void KernelSum(const MatType& querySet,
+                 const math::Range& range,
+                 const KernelType& kernel,
+                 arma::vec& sums,
+                 const double relativeError = 0.0,
+                 const double absoluteError = 0.0);
+
+  /**
+   * Sum a kernel of the distances of the other reference points in the given
+   * range of each point in the reference set (see the overload that takes a
+   * query set).
+   *
+   * @param range Range of distances in which to search.
+   * @param kernel Instantiated kernel.
+   * @param sums Will hold the kernel sum of each point.
+   * @param relativeError Largest relative error of each kernel value (0 gives
+   *      exact sums).
+   * @param absoluteError Largest absolute error of each kernel value.
+   */
+  template<typename KernelType>
+  void KernelSum(const math::Range& range,
+                 const KernelType& kernel,
+                 arma::vec& sums,
+                 const double relativeError = 0.0,
+                 const double absoluteError = 0.0);
+
   //! Get whether single-tree search is being used.
   bool SingleMode() const { return singleMode; }
   //! Modify whether single-tree search is being used.
@@ -309,10 +495,23 @@ class RangeSearch
   //! Modify whether naive search is being used.
   bool& Naive() { return naive; }
 
+  //! Get the number of threads used for search (0 means the OpenMP default).
+  size_t NumThreads() const { return numThreads; }
+  //! Modify the number of threads used for search (0 means the OpenMP
+  //! default, and 1 disables parallel search).
+  size_t& NumThreads() { return numThreads; }
+
+  //! The number of query points in each block of a parallel naive or
+  //! single-tree search.
+  static const size_t QueryBlockSize = 256;
+
   //! Get the number of base cases during the last search.
   size_t BaseCases() const { return baseCases; }
   //! Get the number of scores during the last search.
   size_t Scores() const { return scores; }
+  //! Get the statistics of the traversal (base cases, scores, prunes and
+  //! times) of the last search.
+  const tree::TraversalStatistics& Statistics() const { return statistics; }
 
   //! Serialize the model.
   template<typename Archive>
@@ -324,6 +523,11 @@ class RangeSearch
   //! Return the reference tree (or NULL if in naive mode).
   Tree* ReferenceTree() { return referenceTree; }
 
+  //! Access the mapping from the indices of the reference tree's dataset to
+  //! the indices of the original reference set (empty if there is no mapping).
+  const std::vector<size_t>& OldFromNewReferences() const
+  { return oldFromNewReferences; }
+
  private:
   //! Mappings to old reference indices (used when this object builds trees).
   std::vector<size_t> oldFromNewReferences;
@@ -342,6 +546,8 @@ class RangeSearch
   bool naive;
   //! If true, single-tree computation is used.
   bool singleMode;
+  //! The number of threads to use for search (0 means the OpenMP default).
+  size_t numThreads;
 
   //! Instantiated distance metric.
   MetricType metric;
@@ -350,6 +556,82 @@ class RangeSearch
   size_t baseCases;
   //! The total number of scores during the last search.
   size_t scores;
+  //! The statistics of the last search.
+  tree::TraversalStatistics statistics;
+
+  /**
+   * Perform a dual-tree traversal of the given query tree and the reference
+   * tree, passing each result to the given callback.  If OpenMP is available
+   * and more than one thread may be used, the query tree is split into
+   * subtrees with disjoint sets of points, and each of those is traversed
+   * against the reference tree in parallel.  Each thread stores the results of
+   * a subtree in its own buffer, and passes them to the callback once the
+   * subtree is done, so the callback is never called by two threads at once
+   * (unless RangeSearchCallbackTraits says it may be, in which case the
+   * results are passed on directly).  The number of base cases and scores of
+   * all threads is added to baseCases and scores.
+   *
+   * @param queryTree Tree built on query points.
+   * @param range Range of distances in which to search.
+   * @param queryMapping Mapping of query indices to original indices, or NULL.
+   * @param referenceMapping Mapping of reference indices to original indices,
+   *      or NULL.
+   * @param sameSet Whether the query set is the reference set.
+   * @param callback Callback to pass each result to.
+   */
+  template<typename CallbackType>
+  void DualTreeTraverse(Tree& queryTree,
+                        const math::Range& range,
+                        const std::vector<size_t>* queryMapping,
+                        const std::vector<size_t>* referenceMapping,
+                        const bool sameSet,
+                        CallbackType& callback);
+
+  /**
+   * Perform a naive or single-tree search (depending on the naive member) for
+   * each point of the given query set, passing each result to the given
+   * callback.  If OpenMP is available and more than one thread may be used,
+   * blocks of QueryBlockSize query points are searched in parallel, and the
+   * results are passed to the callback like in DualTreeTraverse().  The
+   * number of base cases and scores is added to baseCases and scores.
+   *
+   * @param querySet Set of query points to search with.
+   * @param range Range of distances in which to search.
+   * @param queryMapping Mapping of query indices to original indices, or NULL.
+   * @param referenceMapping Mapping of reference indices to original indices,
+   *      or NULL.
+   * @param sameSet Whether the query set is the reference set.
+   * @param callback Callback to pass each result to.
+   */
+  template<typename CallbackType>
+  void BlockSearch(const MatType& querySet,
+                   const math::Range& range,
+                   const std::vector<size_t>* queryMapping,
+                   const std::vector<size_t>* referenceMapping,
+                   const bool sameSet,
+                   CallbackType& callback);
+
+  /**
+   * Search for all points in the given range for each point in the reference
+   * set, passing each result to the given callback.  If sameSet is false, each
+   * point is also returned as its own neighbor, which lets callbacks take
+   * whole nodes (see RangeSearchCallbackTraits).
+   *
+   * @param range Range of distances in which to search.
+   * @param sameSet Whether a point should not be returned as its own
+   *      neighbor.
+   * @param callback Callback to pass each result to.
+   */
+  template<typename CallbackType>
+  void MonochromaticSearch(const math::Range& range,
+                           const bool sameSet,
+                           CallbackType& callback);
+
+  //! Search for the query points with indices in [begin, end) with the given
+  //! rules, naively or with a single-tree traversal, and return the number of
+  //! pruned nodes.
+  template<typename RuleType>
+  size_t SearchQueries(RuleType& rules, const size_t begin, const size_t end);
 
   //! For access to mappings when building models.
   friend class TrainVisitor;
@@ -0,0 +1,430 @@
+/**
+ * @file range_search_callbacks.hpp
+ *
+ * Callbacks that receive the results of a range search.  RangeSearchRules
+ * hands each result (a query index, a reference index and their distance) to a
+ * callback as soon as it is found, so results can be processed or stored in a
+ * compact form instead of in one vector per query point.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_RANGE_SEARCH_RANGE_SEARCH_CALLBACKS_HPP
+#define MLPACK_METHODS_RANGE_SEARCH_RANGE_SEARCH_CALLBACKS_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/math/range.hpp>
+
+namespace mlpack {
+namespace range {
+
+/**
+ * Traits of a range search callback.  By default, a callback is assumed to be
+ * unsafe to call from several threads at once, so parallel searches buffer
+ * their results and pass them to the callback one thread at a time.  A
+ * callback that may be called concurrently (for instance, one that only
+ * updates atomic values) can specialize this class with IsThreadSafe set to
+ * true; parallel searches then call it directly from each thread, without
+ * buffering any results.  The threads of a parallel search always work on
+ * different query points, so a callback that only updates values of the query
+ * point it is given is thread-safe.
+ *
+ * A callback that doesn't need each neighbor (for instance, one that counts
+ * them) can set TakesNodes to true and implement
+ *
+ * @code
+ * bool AddNode(const size_t queryIndex,
+ *              const size_t numPoints,
+ *              const math::Range& distances);
+ * @endcode
+ *
+ * When all the points of a reference node are in the range, the search then
+ * calls AddNode() with the number of those points and bounds on their
+ * distances to the query point, instead of computing each distance.  If
+ * AddNode() returns false, nothing is added and the search recurses into the
+ * node, so that its children or its points are passed instead; whether it
+ * returns false may only depend on the distances.  Nodes are only passed to
+ * callbacks that are called directly (see IsThreadSafe).
+ *
+ * @tparam CallbackType Type of the callback.
+ */
+template<typename CallbackType>
+struct RangeSearchCallbackTraits
+{
+  //! Whether the callback may be called by several threads at once.
+  static const bool IsThreadSafe = false;
+  //! Whether the callback can take all the points of a node with AddNode().
+  static const bool TakesNodes = false;
+};
+
+/**
+ * The default callback, which appends each result to the vectors of neighbors
+ * and distances of its query point, as RangeSearch::Search() returns them.
+ * The vectors must already hold one entry for each query point.
+ */
+class RangeSearchVectorCallback
+{
+ public:
+  /**
+   * Create the callback to store results in the given vectors.
+   *
+   * @param neighbors Vector of neighbor indices for each query point.
+   * @param distances Vector of neighbor distances for each query point.
+   */
+  RangeSearchVectorCallback(std::vector<std::vector<size_t>>& neighbors,
+                            std::vector<std::vector<double>>& distances) :
+      neighbors(neighbors),
+      distances(distances)
+  { }
+
+  //! Store the given result.
+  void operator()(const size_t queryIndex,
+                  const size_t referenceIndex,
+                  const double distance)
+  {
+    neighbors[queryIndex].push_back(referenceIndex);
+    distances[queryIndex].push_back(distance);
+  }
+
+ private:
+  //! The neighbor indices for each query point.
+  std::vector<std::vector<size_t>>& neighbors;
+  //! The neighbor distances for each query point.
+  std::vector<std::vector<double>>& distances;
+};
+
+/**
+ * A callback that counts the results of each query point, without computing
+ * the distances of the points of reference nodes that are entirely in the
+ * range.  The counts must already hold one (zero) entry for each query point.
+ */
+class RangeSearchCountCallback
+{
+ public:
+  /**
+   * Create the callback to count the results in the given vector.
+   *
+   * @param counts Number of results for each query point.
+   */
+  RangeSearchCountCallback(arma::Col<size_t>& counts) : counts(counts) { }
+
+  //! Count the given result.
+  void operator()(const size_t queryIndex,
+                  const size_t /* referenceIndex */,
+                  const double /* distance */)
+  {
+    ++counts[queryIndex];
+  }
+
+  //! Count all the points of a node.
+  bool AddNode(const size_t queryIndex,
+               const size_t numPoints,
+               const math::Range& /* distances */)
+  {
+    counts[queryIndex] += numPoints;
+    return true;
+  }
+
+ private:
+  //! The number of results of each query point.
+  arma::Col<size_t>& counts;
+};
+
+//! Each thread counts the results of its own query points.
+template<>
+struct RangeSearchCallbackTraits<RangeSearchCountCallback>
+{
+  static const bool IsThreadSafe = true;
+  static const bool TakesNodes = true;
+};
+
+/**
+ * A callback that sums a kernel of the distance of each result, for each query
+ * point.  The kernel must have a 'double Evaluate(const double distance)'
+ * function that doesn't increase with the distance, like the Gaussian,
+ * Epanechnikov, triangular and spherical kernels.  The sums must already hold
+ * one (zero) entry for each query point.
+ *
+ * When all the points of a reference node are in the range and the kernel
+ * varies by at most twice the allowed error over their distances, the node
+ * adds its number of points times the middle of the kernel bounds, so each
+ * term of the sum is within relativeError * K + absoluteError of its true
+ * value K.  With errors of 0, this only happens where the kernel is flat, and
+ * the sums are exact.
+ *
+ * @tparam KernelType Type of the kernel.
+ */
+template<typename KernelType>
+class RangeSearchKernelSumCallback
+{
+ public:
+  /**
+   * Create the callback to sum the kernel values in the given vector.
+   *
+   * @param sums Sum of the kernel values for each query point.
+   * @param kernel Instantiated kernel.
+   * @param relativeError Largest relative error of each kernel value.
+   * @param absoluteError Largest absolute error of each kernel value.
+   */
+  RangeSearchKernelSumCallback(arma::vec& sums,
+                               const KernelType& kernel,
+                               const double relativeError = 0.0,
+                               const double absoluteError = 0.0) :
+      sums(sums),
+      kernel(kernel),
+      relativeError(relativeError),
+      absoluteError(absoluteError)
+  { }
+
+  //! Add the kernel value of the given result.
+  void operator()(const size_t queryIndex,
+                  const size_t /* referenceIndex */,
+                  const double distance)
+  {
+    sums[queryIndex] += kernel.Evaluate(distance);
+  }
+
+  //! Add the kernel values of all the points of a node, if their bounds are
+  //! tight enough.
+  bool AddNode(const size_t queryIndex,
+               const size_t numPoints,
+               const math::Range& distances)
+  {
+    const double maxKernel = kernel.Evaluate(std::max(distances.Lo(), 0.0));
+    const double minKernel = kernel.Evaluate(distances.Hi());
+    if (maxKernel - minKernel > 2.0 * (relativeError * minKernel +
+        absoluteError))
+      return false;
+
+    sums[queryIndex] += numPoints * (maxKernel + minKernel) / 2.0;
+    return true;
+  }
+
+ private:
+  //! The sum of the kernel values of each query point.
+  arma::vec& sums;
+  //! The instantiated kernel.
+  KernelType kernel;
+  //! The largest relative error of each kernel value.
+  double relativeError;
+  //! The largest absolute error of each kernel value.
+  double absoluteError;
+};
+
+//! Each thread sums the kernel values of its own query points.
+template<typename KernelType>
+struct RangeSearchCallbackTraits<RangeSearchKernelSumCallback<KernelType>>
+{
+  static const bool IsThreadSafe = true;
+  static const bool TakesNodes = true;
+};
+
+/**
+ * A callback that stores the results in flat buffers and then turns them into
+ * compressed sparse row (CSR) form: the neighbors of query point i are
+ * neighbors[offsets[i]] to neighbors[offsets[i + 1] - 1], and their distances
+ * are stored at the same positions of distances.  The neighbors of each query
+ * point are in the order they were found, which is the order
+ * RangeSearch::Search() would return them in.
+ *
+ * The results are held in three flat buffers, however many query points
+ * there are, instead of in two vectors per query point.  If the results arrive
+ * grouped by query point (as they do in naive and single-tree search), the
+ * buffers are used as they are; otherwise, they are reordered with a counting
+ * sort.
+ */
+class RangeSearchCSRCallback
+{
+ public:
+  //! Create the callback with empty buffers.
+  RangeSearchCSRCallback() : ordered(true) { }
+
+  //! Store the given result.
+  void operator()(const size_t queryIndex,
+                  const size_t referenceIndex,
+                  const double distance)
+  {
+    if (!queries.empty() && queryIndex < queries.back())
+      ordered = false;
+
+    queries.push_back(queryIndex);
+    references.push_back(referenceIndex);
+    resultDistances.push_back(distance);
+  }
+
+  /**
+   * Move the stored results into CSR form.  The internal buffers are emptied,
+   * so the callback can be used for another search afterwards.
+   *
+   * @param numQueries Number of query points of the search.
+   * @param offsets Will be set to numQueries + 1 offsets into neighbors and
+   *     distances.
+   * @param neighbors Will hold the neighbors of all query points.
+   * @param distances Will hold the distances of all query points.
+   */
+  void Finalize(const size_t numQueries,
+                std::vector<size_t>& offsets,
+                std::vector<size_t>& neighbors,
+                std::vector<double>& distances)
+  {
+    // Count the results of each query point.
+    offsets.assign(numQueries + 1, 0);
+    for (size_t i = 0; i < queries.size(); ++i)
+      ++offsets[queries[i] + 1];
+    for (size_t i = 0; i < numQueries; ++i)
+      offsets[i + 1] += offsets[i];
+
+    if (ordered)
+    {
+      neighbors.swap(references);
+      distances.swap(resultDistances);
+    }
+    else
+    {
+      neighbors.resize(queries.size());
+      distances.resize(queries.size());
+
+      std::vector<size_t> next(offsets.begin(), offsets.end() - 1);
+      for (size_t i = 0; i < queries.size(); ++i)
+      {
+        const size_t position = next[queries[i]]++;
+        neighbors[position] = references[i];
+        distances[position] = resultDistances[i];
+      }
+    }
+
+    // Release the buffers.
+    std::vector<size_t>().swap(queries);
+    std::vector<size_t>().swap(references);
+    std::vector<double>().swap(resultDistances);
+    ordered = true;
+  }
+
+ private:
+  //! The query index of each result.
+  std::vector<size_t> queries;
+  //! The reference index of each result.
+  std::vector<size_t> references;
+  //! The distance of each result.
+  std::vector<double> resultDistances;
+  //! Whether the results have arrived grouped by query point so far.
+  bool ordered;
+};
+
+/**
+ * A callback that stores the results in a flat buffer until they are passed on
+ * to another callback with Flush().  This is used by parallel searches, where
+ * each thread buffers its own results.
+ */
+class RangeSearchBufferCallback
+{
+ public:
+  //! Store the given result.
+  void operator()(const size_t queryIndex,
+                  const size_t referenceIndex,
+                  const double distance)
+  {
+    queries.push_back(queryIndex);
+    references.push_back(referenceIndex);
+    resultDistances.push_back(distance);
+  }
+
+  /**
+   * Pass all stored results to the given callback, in the order they were
+   * found, and empty the buffer.  The memory of the buffer is kept to be
+   * reused.
+   *
+   * @param callback Callback to pass the results to.
+   */
+  template<typename CallbackType>
+  void Flush(CallbackType& callback)
+  {
+    for (size_t i = 0; i < queries.size(); ++i)
+      callback(queries[i], references[i], resultDistances[i]);
+
+    queries.clear();
+    references.clear();
+    resultDistances.clear();
+  }
+
+ private:
+  //! The query index of each result.
+  std::vector<size_t> queries;
+  //! The reference index of each result.
+  std::vector<size_t> references;
+  //! The distance of each result.
+  std::vector<double> resultDistances;
+};
+
+/**
+ * A callback that maps the indices of each result from the indices of
+ * rearranged datasets back to the original indices before passing it to
+ * another callback.  This is used by RangeSearch when it has built trees that
+ * rearrange the points.
+ *
+ * @tparam CallbackType Type of the callback to pass the mapped results to.
+ */
+template<typename CallbackType>
+class MappedRangeSearchCallback
+{
+ public:
+  /**
+   * Create the callback.  A mapping may be NULL, in which case those indices
+   * are passed on unchanged.
+   *
+   * @param callback Callback to pass the mapped results to.
+   * @param oldFromNewQueries Mapping of query indices, or NULL.
+   * @param oldFromNewReferences Mapping of reference indices, or NULL.
+   */
+  MappedRangeSearchCallback(CallbackType& callback,
+                            const std::vector<size_t>* oldFromNewQueries,
+                            const std::vector<size_t>* oldFromNewReferences) :
+      callback(callback),
+      oldFromNewQueries(oldFromNewQueries),
+      oldFromNewReferences(oldFromNewReferences)
+  { }
+
+  //! Map the given result and pass it on.
+  void operator()(const size_t queryIndex,
+                  const size_t referenceIndex,
+                  const double distance)
+  {
+    callback(oldFromNewQueries ? (*oldFromNewQueries)[queryIndex] : queryIndex,
+        oldFromNewReferences ? (*oldFromNewReferences)[referenceIndex] :
+        referenceIndex, distance);
+  }
+
+  //! Map the query index of the given node and pass it on.
+  bool AddNode(const size_t queryIndex,
+               const size_t numPoints,
+               const math::Range& distances)
+  {
+    return callback.AddNode(oldFromNewQueries ?
+        (*oldFromNewQueries)[queryIndex] : queryIndex, numPoints, distances);
+  }
+
+ private:
+  //! The callback to pass the results to.
+  CallbackType& callback;
+  //! The mapping of query indices (or NULL).
+  const std::vector<size_t>* oldFromNewQueries;
+  //! The mapping of reference indices (or NULL).
+  const std::vector<size_t>* oldFromNewReferences;
+};
+
+//! A mapped callback has the traits of the callback it passes results to.
+template<typename CallbackType>
+struct RangeSearchCallbackTraits<MappedRangeSearchCallback<CallbackType>>
+{
+  static const bool IsThreadSafe =
+      RangeSearchCallbackTraits<CallbackType>::IsThreadSafe;
+  static const bool TakesNodes =
+      RangeSearchCallbackTraits<CallbackType>::TakesNodes;
+};
+
+} // namespace range
+} // namespace mlpack
+
+#endif
@@ -18,6 +18,8 @@
 // The rules for traversal.
 #include "range_search_rules.hpp"
 
+#include <mlpack/core/util/numa.hpp>
+
 namespace mlpack {
 namespace range {
 
@@ -59,6 +61,7 @@ RangeSearch<MetricType, MatType, TreeType>::RangeSearch(
     setOwner(false),
     naive(naive),
     singleMode(!naive && singleMode), // Naive overrides single mode.
+    numThreads(0),
     metric(metric),
     baseCases(0),
     scores(0)
@@ -85,6 +88,7 @@ RangeSearch<MetricType, MatType, TreeType>::RangeSearch(
     setOwner(naive),
     naive(naive),
     singleMode(!naive && singleMode),
+    numThreads(0),
     metric(metric),
     baseCases(0),
     scores(0)
@@ -107,6 +111,7 @@ RangeSearch<MetricType, MatType, TreeType>::RangeSearch(
     setOwner(false),
     naive(false),
     singleMode(singleMode),
+    numThreads(0),
     metric(metric),
     baseCases(0),
     scores(0)
@@ -129,6 +134,7 @@ RangeSearch<MetricType, MatType, TreeType>::RangeSearch(
     setOwner(true),
     naive(naive),
     singleMode(singleMode),
+    numThreads(0),
     metric(metric),
     baseCases(0),
     scores(0)
@@ -157,6 +163,7 @@ RangeSearch<MetricType, MatType, TreeType>::RangeSearch(
     setOwner(!other.referenceTree),
     naive(other.naive),
     singleMode(other.singleMode),
+    numThreads(other.numThreads),
     metric(other.metric),
     baseCases(other.baseCases),
     scores(other.scores)
@@ -177,6 +184,7 @@ RangeSearch<MetricType, MatType, TreeType>::RangeSearch(RangeSearch&& other) :
     setOwner(other.setOwner),
     naive(other.naive),
     singleMode(other.singleMode),
+    numThreads(other.numThreads),
     metric(std::move(other.metric)),
     baseCases(other.baseCases),
     scores(other.scores)
@@ -217,6 +225,7 @@ RangeSearch<MetricType, MatType, TreeType>::operator=(const RangeSearch& other)
   setOwner = !other.referenceTree;
   naive = other.naive;
   singleMode = other.singleMode;
+  numThreads = other.numThreads;
   metric = other.metric;
   baseCases = other.baseCases;
   scores = other.scores;
@@ -246,6 +255,7 @@ RangeSearch<MetricType, MatType, TreeType>::operator=(RangeSearch&& other)
   setOwner = other.setOwner;
   naive = other.naive;
   singleMode = other.singleMode;
+  numThreads = other.numThreads;
   metric = std::move(other.metric);
   baseCases = other.baseCases;
   scores = other.scores;
@@ -376,6 +386,31 @@ void RangeSearch<MetricType, MatType, TreeType>::Train(
   setOwner = false;
 }
 
+template<typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void RangeSearch<MetricType, MatType, TreeType>::Train(
+    Tree&& referenceTree,
+    std::vector<size_t>&& oldFromNewReferences)
+{
+  if (naive)
+    throw std::invalid_argument("cannot train on given reference tree when "
+        "naive search (without trees) is desired");
+
+  if (treeOwner && this->referenceTree)
+    delete this->referenceTree;
+  if (setOwner && referenceSet)
+    delete this->referenceSet;
+
+  this->oldFromNewReferences = std::move(oldFromNewReferences);
+  this->referenceTree = new Tree(std::move(referenceTree));
+  this->referenceSet = &this->referenceTree->Dataset();
+  treeOwner = true;
+  setOwner = false;
+}
+
 template<typename MetricType,
          typename MatType,
          template<typename TreeMetricType,
@@ -386,6 +421,28 @@ void RangeSearch<MetricType, MatType, TreeType>::Search(
     const math::Range& range,
     std::vector<std::vector<size_t>>& neighbors,
     std::vector<std::vector<double>>& distances)
+{
+  // Each result is stored as soon as it is found, at its original query index,
+  // so no temporary copy of the results is needed to map them back.
+  neighbors.clear();
+  neighbors.resize(querySet.n_cols);
+  distances.clear();
+  distances.resize(querySet.n_cols);
+
+  RangeSearchVectorCallback callback(neighbors, distances);
+  Search(querySet, range, callback);
+}
+
+template<typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+template<typename CallbackType>
+void RangeSearch<MetricType, MatType, TreeType>::Search(
+    const MatType& querySet,
+    const math::Range& range,
+    CallbackType& callback)
 {
   if (querySet.n_rows != referenceSet->n_rows)
   {
@@ -405,159 +462,50 @@ void RangeSearch<MetricType, MatType, TreeType>::Search(
   // This will hold mappings for query points, if necessary.
   std::vector<size_t> oldFromNewQueries;
 
-  // If we have built the trees ourselves, then we will have to map all the
-  // indices back to their original indices when this computation is finished.
-  // To avoid extra copies, we will store the unmapped neighbors and distances
-  // in a separate object.
-  std::vector<std::vector<size_t>>* neighborPtr = &neighbors;
-  std::vector<std::vector<double>>* distancePtr = &distances;
-
-  // Mapping is only necessary if the tree rearranges points.
-  if (tree::TreeTraits<Tree>::RearrangesDataset)
-  {
-    // Query indices only need to be mapped if we are building the query tree
-    // ourselves.
-    if (!singleMode && !naive)
-    {
-      distancePtr = new std::vector<std::vector<double>>;
-      neighborPtr = new std::vector<std::vector<size_t>>;
-    }
-
-    // Reference indices only need to be mapped if we built the reference tree
-    // ourselves.
-    else if (treeOwner)
-      neighborPtr = new std::vector<std::vector<size_t>>;
-  }
-
-  // Resize each vector.
-  neighborPtr->clear(); // Just in case there was anything in it.
-  neighborPtr->resize(querySet.n_cols);
-  distancePtr->clear();
-  distancePtr->resize(querySet.n_cols);
-
-  // Create the helper object for the traversal.
-  typedef RangeSearchRules<MetricType, Tree> RuleType;
+  // If we have built the reference tree ourselves and it rearranges the
+  // points, reference indices must be mapped back to their original indices.
+  const std::vector<size_t>* referenceMapping =
+      (tree::TreeTraits<Tree>::RearrangesDataset && treeOwner) ?
+      &oldFromNewReferences : NULL;
 
   // Reset counts.
   baseCases = 0;
   scores = 0;
+  statistics.Reset();
 
-  if (naive)
-  {
-    RuleType rules(*referenceSet, querySet, range, *neighborPtr, *distancePtr,
-        metric);
-
-    // The naive brute-force solution.
-    for (size_t i = 0; i < querySet.n_cols; ++i)
-      for (size_t j = 0; j < referenceSet->n_cols; ++j)
-        rules.BaseCase(i, j);
-
-    baseCases += (querySet.n_cols * referenceSet->n_cols);
-  }
-  else if (singleMode)
+  if (naive || singleMode)
   {
-    // Create the traverser.
-    RuleType rules(*referenceSet, querySet, range, *neighborPtr, *distancePtr,
-        metric);
-    typename Tree::template SingleTreeTraverser<RuleType> traverser(rules);
-
-    // Now have it traverse for each point.
-    for (size_t i = 0; i < querySet.n_cols; ++i)
-      traverser.Traverse(i, *referenceTree);
-
-    baseCases += rules.BaseCases();
-    scores += rules.Scores();
+    // Naive brute-force search, or single-tree search for each point.
+    BlockSearch(querySet, range, NULL, referenceMapping, false, callback);
   }
   else // Dual-tree recursion.
   {
     // Build the query tree.
     Timer::Stop("range_search/computing_neighbors");
     Timer::Start("range_search/tree_building");
-    Tree* queryTree = BuildTree<Tree>(querySet, oldFromNewQueries);
+    Tree* queryTree;
+    {
+      tree::TraversalStatistics::PhaseTimer timer(
+          statistics.TreeBuildingTime());
+      queryTree = BuildTree<Tree>(querySet, oldFromNewQueries);
+    }
     Timer::Stop("range_search/tree_building");
     Timer::Start("range_search/computing_neighbors");
 
-    // Create the traverser.
-    RuleType rules(*referenceSet, queryTree->Dataset(), range, *neighborPtr,
-        *distancePtr, metric);
-    typename Tree::template DualTreeTraverser<RuleType> traverser(rules);
+    // Query indices only need to be mapped if the tree rearranged them.
+    const std::vector<size_t>* queryMapping =
+        tree::TreeTraits<Tree>::RearrangesDataset ? &oldFromNewQueries : NULL;
 
-    traverser.Traverse(*queryTree, *referenceTree);
-
-    baseCases += rules.BaseCases();
-    scores += rules.Scores();
+    DualTreeTraverse(*queryTree, range, queryMapping, referenceMapping, false,
+        callback);
 
     // Clean up tree memory.
     delete queryTree;
   }
 
+  statistics.BaseCases() = baseCases;
+  statistics.Scores() = scores;
   Timer::Stop("range_search/computing_neighbors");
-
-  // Map points back to original indices, if necessary.
-  if (tree::TreeTraits<Tree>::RearrangesDataset)
-  {
-    if (!singleMode && !naive && treeOwner)
-    {
-      // We must map both query and reference indices.
-      neighbors.clear();
-      neighbors.resize(querySet.n_cols);
-      distances.clear();
-      distances.resize(querySet.n_cols);
-
-      for (size_t i = 0; i < distances.size(); i++)
-      {
-        // Map distances (copy a column).
-        const size_t queryMapping = oldFromNewQueries[i];
-        distances[queryMapping] = (*distancePtr)[i];
-
-        // Copy each neighbor individually, because we need to map it.
-        neighbors[queryMapping].resize(distances[queryMapping].size());
-        for (size_t j = 0; j < distances[queryMapping].size(); j++)
-          neighbors[queryMapping][j] =
-              oldFromNewReferences[(*neighborPtr)[i][j]];
-      }
-
-      // Finished with temporary objects.
-      delete neighborPtr;
-      delete distancePtr;
-    }
-    else if (!singleMode && !naive)
-    {
-      // We must map query indices only.
-      neighbors.clear();
-      neighbors.resize(querySet.n_cols);
-      distances.clear();
-      distances.resize(querySet.n_cols);
-
-      for (size_t i = 0; i < distances.size(); ++i)
-      {
-        // Map distances and neighbors (copy a column).
-        const size_t queryMapping = oldFromNewQueries[i];
-        distances[queryMapping] = (*distancePtr)[i];
-        neighbors[queryMapping] = (*neighborPtr)[i];
-      }
-
-      // Finished with temporary objects.
-      delete neighborPtr;
-      delete distancePtr;
-    }
-    else if (treeOwner)
-    {
-      // We must map reference indices only.
-      neighbors.clear();
-      neighbors.resize(querySet.n_cols);
-
-      for (size_t i = 0; i < neighbors.size(); i++)
-      {
-        neighbors[i].resize((*neighborPtr)[i].size());
-        for (size_t j = 0; j < neighbors[i].size(); j++)
-          neighbors[i][j] = oldFromNewReferences[(*neighborPtr)[i][j]];
-      }
-
-      // Finished with temporary object.
-      delete neighborPtr;
-    }
-  }
 }
 
 template<typename MetricType,
@@ -571,64 +519,141 @@ void RangeSearch<MetricType, MatType, TreeType>::Search(
     std::vector<std::vector<size_t>>& neighbors,
     std::vector<std::vector<double>>& distances)
 {
-  // If there are no points, there is no search to be done.
-  if (referenceSet->n_cols == 0)
-    return;
+  // Make sure we are in dual-tree mode.
+  if (singleMode || naive)
+    throw std::invalid_argument("cannot call RangeSearch::Search() with a "
+        "query tree when naive or singleMode are set to true");
 
-  Timer::Start("range_search/computing_neighbors");
+  neighbors.clear();
+  neighbors.resize(queryTree->Dataset().n_cols);
+  distances.clear();
+  distances.resize(queryTree->Dataset().n_cols);
 
-  // Get a reference to the query set.
-  const MatType& querySet = queryTree->Dataset();
+  RangeSearchVectorCallback callback(neighbors, distances);
+  Search(queryTree, range, callback);
+}
 
+template<typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+template<typename CallbackType>
+void RangeSearch<MetricType, MatType, TreeType>::Search(
+    Tree* queryTree,
+    const math::Range& range,
+    CallbackType& callback)
+{
   // Make sure we are in dual-tree mode.
   if (singleMode || naive)
     throw std::invalid_argument("cannot call RangeSearch::Search() with a "
         "query tree when naive or singleMode are set to true");
 
-  // We won't need to map query indices, but will we need to map distances?
-  std::vector<std::vector<size_t>>* neighborPtr = &neighbors;
+  // If there are no points, there is no search to be done.
+  if (referenceSet->n_cols == 0)
+    return;
 
-  if (treeOwner && tree::TreeTraits<Tree>::RearrangesDataset)
-    neighborPtr = new std::vector<std::vector<size_t>>;
+  Timer::Start("range_search/computing_neighbors");
 
-  // Resize each vector.
-  neighborPtr->clear(); // Just in case there was anything in it.
-  neighborPtr->resize(querySet.n_cols);
-  distances.clear();
-  distances.resize(querySet.n_cols);
+  // We won't need to map query indices, but we may need to map reference
+  // indices.
+  const std::vector<size_t>* referenceMapping =
+      (tree::TreeTraits<Tree>::RearrangesDataset && treeOwner) ?
+      &oldFromNewReferences : NULL;
 
-  // Create the helper object for the traversal.
-  typedef RangeSearchRules<MetricType, Tree> RuleType;
-  RuleType rules(*referenceSet, queryTree->Dataset(), range, *neighborPtr,
-      distances, metric);
+  baseCases = 0;
+  scores = 0;
+  statistics.Reset();
+  DualTreeTraverse(*queryTree, range, NULL, referenceMapping, false, callback);
 
-  // Create the traverser.
-  typename Tree::template DualTreeTraverser<RuleType> traverser(rules);
+  statistics.BaseCases() = baseCases;
+  statistics.Scores() = scores;
+  Timer::Stop("range_search/computing_neighbors");
+}
 
-  traverser.Traverse(*queryTree, *referenceTree);
+template<typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void RangeSearch<MetricType, MatType, TreeType>::Search(
+    const math::Range& range,
+    std::vector<std::vector<size_t>>& neighbors,
+    std::vector<std::vector<double>>& distances)
+{
+  neighbors.clear();
+  neighbors.resize(referenceSet->n_cols);
+  distances.clear();
+  distances.resize(referenceSet->n_cols);
 
-  Timer::Stop("range_search/computing_neighbors");
+  RangeSearchVectorCallback callback(neighbors, distances);
+  Search(range, callback);
+}
 
-  baseCases = rules.BaseCases();
-  scores = rules.Scores();
+template<typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+template<typename CallbackType>
+void RangeSearch<MetricType, MatType, TreeType>::Search(
+    const math::Range& range,
+    CallbackType& callback)
+{
+  MonochromaticSearch(range, true, callback);
+}
 
-  // Do we need to map indices?
-  if (treeOwner && tree::TreeTraits<Tree>::RearrangesDataset)
-  {
-    // We must map reference indices only.
-    neighbors.clear();
-    neighbors.resize(querySet.n_cols);
+template<typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void RangeSearch<MetricType, MatType, TreeType>::Count(
+    const MatType& querySet,
+    const math::Range& range,
+    arma::Col<size_t>& counts)
+{
+  counts.zeros(querySet.n_cols);
+  RangeSearchCountCallback callback(counts);
+  Search(querySet, range, callback);
+}
 
-    for (size_t i = 0; i < neighbors.size(); i++)
-    {
-      neighbors[i].resize((*neighborPtr)[i].size());
-      for (size_t j = 0; j < neighbors[i].size(); j++)
-        neighbors[i][j] = oldFromNewReferences[(*neighborPtr)[i][j]];
-    }
+template<typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void RangeSearch<MetricType, MatType, TreeType>::Count(
+    const math::Range& range,
+    arma::Col<size_t>& counts)
+{
+  // Each point is counted in its own range (so that whole nodes can be
+  // counted), and then removed.
+  counts.zeros(referenceSet->n_cols);
+  RangeSearchCountCallback callback(counts);
+  MonochromaticSearch(range, false, callback);
+  if (range.Contains(0.0))
+    counts -= 1;
+}
 
-    // Finished with temporary object.
-    delete neighborPtr;
-  }
+template<typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+template<typename KernelType>
+void RangeSearch<MetricType, MatType, TreeType>::KernelSum(
+    const MatType& querySet,
+    const math::Range& range,
+    const KernelType& kernel,
+    arma::vec& sums,
+    const double relativeError,
+    const double absoluteError)
+{
+  sums.zeros(querySet.n_cols);
+  RangeSearchKernelSumCallback<KernelType> callback(sums, kernel,
+      relativeError, absoluteError);
+  Search(querySet, range, callback);
 }
 
 template<typename MetricType,
@@ -636,10 +661,35 @@ template<typename MetricType,
          template<typename TreeMetricType,
                   typename TreeStatType,
                   typename TreeMatType> class TreeType>
-void RangeSearch<MetricType, MatType, TreeType>::Search(
+template<typename KernelType>
+void RangeSearch<MetricType, MatType, TreeType>::KernelSum(
     const math::Range& range,
-    std::vector<std::vector<size_t>>& neighbors,
-    std::vector<std::vector<double>>& distances)
+    const KernelType& kernel,
+    arma::vec& sums,
+    const double relativeError,
+    const double absoluteError)
+{
+  // Each point is added to its own sum (so that whole nodes can be added), and
+  // then removed.  The error of a node that holds the point is at most twice
+  // the error of the other points of the node, so the error bound is halved.
+  sums.zeros(referenceSet->n_cols);
+  RangeSearchKernelSumCallback<KernelType> callback(sums, kernel,
+      relativeError / 2.0, absoluteError / 2.0);
+  MonochromaticSearch(range, false, callback);
+  if (range.Contains(0.0))
+    sums -= kernel.Evaluate(0.0);
+}
+
+template<typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+template<typename CallbackType>
+void RangeSearch<MetricType, MatType, TreeType>::MonochromaticSearch(
+    const math::Range& range,
+    const bool sameSet,
+    CallbackType& callback)
 {
   // If there are no points, there is no search to be done.
   if (referenceSet->n_cols == 0)
@@ -647,89 +697,319 @@ void RangeSearch<MetricType, MatType, TreeType>::Search(
 
   Timer::Start("range_search/computing_neighbors");
 
-  // Here, we will use the query set as the reference set.
-  std::vector<std::vector<size_t>>* neighborPtr = &neighbors;
-  std::vector<std::vector<double>>* distancePtr = &distances;
+  // Here, we will use the query set as the reference set, so both query and
+  // reference indices must be mapped if we built the tree and it rearranged
+  // the points.
+  const std::vector<size_t>* mapping =
+      (tree::TreeTraits<Tree>::RearrangesDataset && treeOwner) ?
+      &oldFromNewReferences : NULL;
+
+  baseCases = 0;
+  scores = 0;
+  statistics.Reset();
 
-  if (tree::TreeTraits<Tree>::RearrangesDataset && treeOwner)
+  if (naive || singleMode)
   {
-    // We will always need to rearrange in this case.
-    distancePtr = new std::vector<std::vector<double>>;
-    neighborPtr = new std::vector<std::vector<size_t>>;
+    // Naive brute-force search, or single-tree search for each point; unless
+    // sameSet is false, the query is not returned in its own results.
+    BlockSearch(*referenceSet, range, mapping, mapping, sameSet, callback);
+  }
+  else // Dual-tree recursion.
+  {
+    DualTreeTraverse(*referenceTree, range, mapping, mapping, sameSet,
+        callback);
   }
 
-  // Resize each vector.
-  neighborPtr->clear(); // Just in case there was anything in it.
-  neighborPtr->resize(referenceSet->n_cols);
-  distancePtr->clear();
-  distancePtr->resize(referenceSet->n_cols);
+  statistics.BaseCases() = baseCases;
+  statistics.Scores() = scores;
+  Timer::Stop("range_search/computing_neighbors");
+}
 
-  // Create the helper object for the traversal.
-  typedef RangeSearchRules<MetricType, Tree> RuleType;
-  RuleType rules(*referenceSet, *referenceSet, range, *neighborPtr,
-      *distancePtr, metric, true /* don't return the query in the results */);
+template<typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void RangeSearch<MetricType, MatType, TreeType>::Search(
+    const MatType& querySet,
+    const math::Range& range,
+    std::vector<size_t>& offsets,
+    std::vector<size_t>& neighbors,
+    std::vector<double>& distances)
+{
+  RangeSearchCSRCallback callback;
+  Search(querySet, range, callback);
+  callback.Finalize(querySet.n_cols, offsets, neighbors, distances);
+}
 
-  if (naive)
-  {
-    // The naive brute-force solution.
-    for (size_t i = 0; i < referenceSet->n_cols; ++i)
-      for (size_t j = 0; j < referenceSet->n_cols; ++j)
-        rules.BaseCase(i, j);
+template<typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void RangeSearch<MetricType, MatType, TreeType>::Search(
+    const math::Range& range,
+    std::vector<size_t>& offsets,
+    std::vector<size_t>& neighbors,
+    std::vector<double>& distances)
+{
+  RangeSearchCSRCallback callback;
+  Search(range, callback);
+  callback.Finalize(referenceSet->n_cols, offsets, neighbors, distances);
+}
 
-    baseCases = (referenceSet->n_cols * referenceSet->n_cols);
-    scores = 0;
-  }
-  else if (singleMode)
+template<typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+template<typename CallbackType>
+void RangeSearch<MetricType, MatType, TreeType>::DualTreeTraverse(
+    Tree& queryTree,
+    const math::Range& range,
+    const std::vector<size_t>* queryMapping,
+    const std::vector<size_t>* referenceMapping,
+    const bool sameSet,
+    CallbackType& callback)
+{
+  tree::TraversalStatistics::PhaseTimer timer(statistics.TraversalTime());
+
+#ifdef HAS_OPENMP
+  const size_t threads = (numThreads == 0) ? omp_get_max_threads() :
+      numThreads;
+#else
+  const size_t threads = 1;
+#endif
+
+  // Split the query tree into subtrees with disjoint sets of points.  Ask for
+  // more subtrees than threads, so that the dynamic schedule can balance the
+  // work.  If this isn't possible, we just get the root back.
+  std::vector<Tree*> subtrees;
+  if (threads > 1)
+    tree::IndependentSubtrees(queryTree, 8 * threads, subtrees);
+
+  if (subtrees.size() <= 1)
   {
-    // Create the traverser.
-    typename Tree::template SingleTreeTraverser<RuleType> traverser(rules);
+    typedef MappedRangeSearchCallback<CallbackType> MappedCallbackType;
+    typedef RangeSearchRules<MetricType, Tree, MappedCallbackType> RuleType;
+    RuleType rules(*referenceSet, queryTree.Dataset(), range,
+        MappedCallbackType(callback, queryMapping, referenceMapping), metric,
+        sameSet);
 
-    // Now have it traverse for each point.
-    for (size_t i = 0; i < referenceSet->n_cols; ++i)
-      traverser.Traverse(i, *referenceTree);
+    typename Tree::template DualTreeTraverser<RuleType> traverser(rules);
+    traverser.Traverse(queryTree, *referenceTree);
 
-    baseCases = rules.BaseCases();
-    scores = rules.Scores();
+    baseCases += rules.BaseCases();
+    scores += rules.Scores();
+    statistics.AddTraverser(traverser);
+    return;
   }
-  else // Dual-tree recursion.
+
+  typedef MappedRangeSearchCallback<CallbackType> MappedCallbackType;
+  typedef RangeSearchRules<MetricType, Tree, MappedCallbackType>
+      DirectRuleType;
+  typedef MappedRangeSearchCallback<RangeSearchBufferCallback>
+      MappedBufferType;
+  typedef RangeSearchRules<MetricType, Tree, MappedBufferType> RuleType;
+
+  size_t totalBaseCases = 0;
+  size_t totalScores = 0;
+  size_t totalPrunes = 0;
+
+  // With NUMA placement, each thread takes a contiguous range of the subtrees
+  // in dataset order, so that it mostly reads query points on its own node.
+  if (NUMA::Enabled())
+    tree::SortByDatasetOrder(subtrees);
+  NUMA::LoopSchedule schedule;
+
+  #pragma omp parallel num_threads(threads) \
+      reduction(+:totalBaseCases, totalScores, totalPrunes)
   {
-    // Create the traverser.
-    typename Tree::template DualTreeTraverser<RuleType> traverser(rules);
+    // Each thread holds its own results until a subtree is done, unless the
+    // callback may be called by several threads at once; the metric is copied
+    // too, since it may hold state.
+    NUMA::PinThread();
+    RangeSearchBufferCallback buffer;
+    MetricType threadMetric(metric);
+
+#ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables. If we're building for Visual Studio,
+    // use the intmax_t type instead.
+    #pragma omp for schedule(runtime)
+    for (intmax_t i = 0; i < (intmax_t) subtrees.size(); ++i)
+#else
+    #pragma omp for schedule(runtime)
+    for (size_t i = 0; i < subtrees.size(); ++i)
+#endif
+    {
+      if (RangeSearchCallbackTraits<CallbackType>::IsThreadSafe)
+      {
+        DirectRuleType rules(*referenceSet, queryTree.Dataset(), range,
+            MappedCallbackType(callback, queryMapping, referenceMapping),
+            threadMetric, sameSet);
 
-    traverser.Traverse(*referenceTree, *referenceTree);
+        typename Tree::template DualTreeTraverser<DirectRuleType>
+            traverser(rules);
+        traverser.Traverse(*subtrees[i], *referenceTree);
 
-    baseCases = rules.BaseCases();
-    scores = rules.Scores();
+        totalBaseCases += rules.BaseCases();
+        totalScores += rules.Scores();
+        totalPrunes += traverser.NumPrunes();
+      }
+      else
+      {
+        RuleType rules(*referenceSet, queryTree.Dataset(), range,
+            MappedBufferType(buffer, queryMapping, referenceMapping),
+            threadMetric, sameSet);
+
+        typename Tree::template DualTreeTraverser<RuleType> traverser(rules);
+        traverser.Traverse(*subtrees[i], *referenceTree);
+
+        totalBaseCases += rules.BaseCases();
+        totalScores += rules.Scores();
+        totalPrunes += traverser.NumPrunes();
+
+        // Only one thread at a time may pass results to the callback.
+        #pragma omp critical(RangeSearchFlushResults)
+        buffer.Flush(callback);
+      }
+    }
   }
 
-  Timer::Stop("range_search/computing_neighbors");
+  baseCases += totalBaseCases;
+  scores += totalScores;
+  statistics.Prunes() += totalPrunes;
+}
 
-  // Do we need to map the reference indices?
-  if (treeOwner && tree::TreeTraits<Tree>::RearrangesDataset)
+template<typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+template<typename CallbackType>
+void RangeSearch<MetricType, MatType, TreeType>::BlockSearch(
+    const MatType& querySet,
+    const math::Range& range,
+    const std::vector<size_t>* queryMapping,
+    const std::vector<size_t>* referenceMapping,
+    const bool sameSet,
+    CallbackType& callback)
+{
+  tree::TraversalStatistics::PhaseTimer timer(statistics.TraversalTime());
+
+#ifdef HAS_OPENMP
+  const size_t threads = (numThreads == 0) ? omp_get_max_threads() :
+      numThreads;
+#else
+  const size_t threads = 1;
+#endif
+
+  typedef MappedRangeSearchCallback<CallbackType> MappedCallbackType;
+  typedef RangeSearchRules<MetricType, Tree, MappedCallbackType>
+      DirectRuleType;
+
+  const size_t numBlocks = (querySet.n_cols + QueryBlockSize - 1) /
+      QueryBlockSize;
+  if (threads <= 1 || numBlocks <= 1)
   {
-    neighbors.clear();
-    neighbors.resize(referenceSet->n_cols);
-    distances.clear();
-    distances.resize(referenceSet->n_cols);
+    DirectRuleType rules(*referenceSet, querySet, range,
+        MappedCallbackType(callback, queryMapping, referenceMapping), metric,
+        sameSet);
+    statistics.Prunes() += SearchQueries(rules, 0, querySet.n_cols);
+
+    baseCases += rules.BaseCases();
+    scores += rules.Scores();
+    return;
+  }
 
-    for (size_t i = 0; i < distances.size(); i++)
+  typedef MappedRangeSearchCallback<RangeSearchBufferCallback>
+      MappedBufferType;
+  typedef RangeSearchRules<MetricType, Tree, MappedBufferType> RuleType;
+
+  size_t totalBaseCases = 0;
+  size_t totalScores = 0;
+  size_t totalPrunes = 0;
+
+  #pragma omp parallel num_threads(threads) \
+      reduction(+:totalBaseCases, totalScores, totalPrunes)
+  {
+    // Each thread holds the results of a block in its own buffer, unless the
+    // callback may be called by several threads at once.
+    RangeSearchBufferCallback buffer;
+    MetricType threadMetric(metric);
+    DirectRuleType directRules(*referenceSet, querySet, range,
+        MappedCallbackType(callback, queryMapping, referenceMapping),
+        threadMetric, sameSet);
+    RuleType rules(*referenceSet, querySet, range,
+        MappedBufferType(buffer, queryMapping, referenceMapping), threadMetric,
+        sameSet);
+
+#ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables. If we're building for Visual Studio,
+    // use the intmax_t type instead.
+    #pragma omp for schedule(dynamic)
+    for (intmax_t b = 0; b < (intmax_t) numBlocks; ++b)
+#else
+    #pragma omp for schedule(dynamic)
+    for (size_t b = 0; b < numBlocks; ++b)
+#endif
     {
-      // Map distances (copy a column).
-      const size_t refMapping = oldFromNewReferences[i];
-      distances[refMapping] = (*distancePtr)[i];
+      const size_t begin = b * QueryBlockSize;
+      const size_t end = std::min(begin + QueryBlockSize,
+          (size_t) querySet.n_cols);
 
-      // Copy each neighbor individually, because we need to map it.
-      neighbors[refMapping].resize(distances[refMapping].size());
-      for (size_t j = 0; j < distances[refMapping].size(); j++)
+      if (RangeSearchCallbackTraits<CallbackType>::IsThreadSafe)
       {
-        neighbors[refMapping][j] = oldFromNewReferences[(*neighborPtr)[i][j]];
+        totalPrunes += SearchQueries(directRules, begin, end);
+      }
+      else
+      {
+        totalPrunes += SearchQueries(rules, begin, end);
+
+        // Only one thread at a time may pass results to the callback.
+        #pragma omp critical(RangeSearchFlushResults)
+        buffer.Flush(callback);
       }
     }
 
-    // Finished with temporary objects.
-    delete neighborPtr;
-    delete distancePtr;
+    totalBaseCases += directRules.BaseCases() + rules.BaseCases();
+    totalScores += directRules.Scores() + rules.Scores();
+  }
+
+  baseCases += totalBaseCases;
+  scores += totalScores;
+  statistics.Prunes() += totalPrunes;
+}
+
+template<typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+template<typename RuleType>
+size_t RangeSearch<MetricType, MatType, TreeType>::SearchQueries(
+    RuleType& rules,
+    const size_t begin,
+    const size_t end)
+{
+  if (naive)
+  {
+    // The naive brute-force solution.
+    for (size_t i = begin; i < end; ++i)
+      for (size_t j = 0; j < referenceSet->n_cols; ++j)
+        rules.BaseCase(i, j);
+
+    return 0;
   }
+
+  // Traverse the reference tree for each point.
+  typename Tree::template SingleTreeTraverser<RuleType> traverser(rules);
+  for (size_t i = begin; i < end; ++i)
+    traverser.Traverse(i, *referenceTree);
+
+  return traverser.NumPrunes();
 }
 
 template<typename MetricType,
@@ -88,6 +88,8 @@ PARAM_INT_IN("seed", "Random seed (if 0, std::time(NULL) is used).", "s", 0);
 PARAM_FLAG("naive", "If true, O(n^2) naive mode is used for computation.", "N");
 PARAM_FLAG("single_mode", "If true, single-tree search is used (as opposed to "
     "dual-tree search).", "S");
+PARAM_INT_IN("threads", "Number of threads to use for dual-tree search (if 0, "
+    "the OpenMP default is used).", "T", 0);
 
 int main(int argc, char *argv[])
 {
@@ -152,6 +154,11 @@ int main(int argc, char *argv[])
     Log::Fatal << "Invalid leaf size: " << lsInt << ".  Must be greater than 0."
         << endl;
 
+  const int threads = CLI::GetParam<int>("threads");
+  if (threads < 0)
+    Log::Fatal << "Invalid number of threads: " << threads << ".  Must be 0 or "
+        << "greater." << endl;
+
   // We either have to load the reference data, or we have to load the model.
   RSModel rs;
   const bool naive = CLI::HasParam("naive");
@@ -225,6 +232,8 @@ int main(int argc, char *argv[])
     rs.LeafSize() = size_t(lsInt);
   }
 
+  rs.NumThreads() = size_t(threads);
+
   // Perform search, if desired.
   if (CLI::HasParam("min") || CLI::HasParam("max"))
   {
@@ -13,21 +13,32 @@
 #define MLPACK_METHODS_RANGE_SEARCH_RANGE_SEARCH_RULES_HPP
 
 #include <mlpack/core/tree/traversal_info.hpp>
+#include "range_search_callbacks.hpp"
 
 namespace mlpack {
 namespace range {
 
 /**
  * The RangeSearchRules class is a template helper class used by RangeSearch
- * class when performing range searches.
+ * class when performing range searches.  Each result is passed to a callback
+ * as soon as it is found; by default, the results are stored in a vector of
+ * neighbors and a vector of distances for each query point.
  *
  * @tparam MetricType The metric to use for computation.
  * @tparam TreeType The tree type to use; must adhere to the TreeType API.
+ * @tparam CallbackType The callback that receives the results; it is called as
+ *     callback(queryIndex, referenceIndex, distance).  See
+ *     range_search_callbacks.hpp.
  */
-template<typename MetricType, typename TreeType>
+template<typename MetricType,
+         typename TreeType,
+         typename CallbackType = RangeSearchVectorCallback>
 class RangeSearchRules
 {
  public:
+  //! The type of data matrix.
+  typedef typename TreeType::Mat MatType;
+
   /**
    * Construct the RangeSearchRules object.  This is usually done from within
    * the RangeSearch class at search time.
@@ -41,14 +52,33 @@ class RangeSearchRules
    * @param sameSet If true, the query and reference set are taken to be the
    *      same, and a query point will not return itself in the results.
    */
-  RangeSearchRules(const arma::mat& referenceSet,
-                   const arma::mat& querySet,
+  RangeSearchRules(const MatType& referenceSet,
+                   const MatType& querySet,
                    const math::Range& range,
                    std::vector<std::vector<size_t> >& neighbors,
                    std::vector<std::vector<double> >& distances,
                    MetricType& metric,
                    const bool sameSet = false);
 
+  /**
+   * Construct the RangeSearchRules object with a callback that receives the
+   * results.
+   *
+   * @param referenceSet Set of reference data.
+   * @param querySet Set of query data.
+   * @param range Range to search for.
+   * @param callback Callback to pass each result to.
+   * @param metric Instantiated metric.
+   * @param sameSet If true, the query and reference set are taken to be the
+   *      same, and a query point will not return itself in the results.
+   */
+  RangeSearchRules(const MatType& referenceSet,
+                   const MatType& querySet,
+                   const math::Range& range,
+                   CallbackType callback,
+                   MetricType& metric,
+                   const bool sameSet = false);
+
   /**
    * Compute the base case between the given query point and reference point.
    *
@@ -119,19 +149,16 @@ class RangeSearchRules
 
  private:
   //! The reference set.
-  const arma::mat& referenceSet;
+  const MatType& referenceSet;
 
   //! The query set.
-  const arma::mat& querySet;
+  const MatType& querySet;
 
   //! The range of distances for which we are searching.
   const math::Range& range;
 
-  //! The vector the resultant neighbor indices should be stored in.
-  std::vector<std::vector<size_t> >& neighbors;
-
-  //! The vector the resultant neighbor distances should be stored in.
-  std::vector<std::vector<double> >& distances;
+  //! The callback that receives the results.
+  CallbackType callback;
 
   //! The instantiated metric.
   MetricType& metric;
@@ -143,12 +170,31 @@ class RangeSearchRules
   size_t lastQueryIndex;
   //! The last reference index.
   size_t lastReferenceIndex;
-
-  //! Add all the points in the given node to the results for the given query
-  //! point.  If the base case has already been calculated, we make sure to not
-  //! add that to the results twice.
-  void AddResult(const size_t queryIndex,
-                 TreeType& referenceNode);
+  //! The distance between the last query and reference points.
+  double lastBaseCase;
+
+  //! Add all the points in the given node, whose distances to the query point
+  //! are within the given bounds, to the results for the given query point.
+  //! If the base case has already been calculated, we make sure to not add
+  //! that to the results twice.  Return false if the callback declined to take
+  //! the node at once, in which case nothing was added.
+  bool AddResult(const size_t queryIndex,
+                 TreeType& referenceNode,
+                 const math::Range& distances);
+
+  //! Pass the given number of points of a node to the callback at once, if it
+  //! takes nodes (see RangeSearchCallbackTraits), and return whether it did.
+  bool AddNode(const size_t queryIndex,
+               const size_t numPoints,
+               const math::Range& distances,
+               const std::true_type /* takesNodes */);
+
+  //! The callback doesn't take nodes.
+  bool AddNode(const size_t /* queryIndex */,
+               const size_t /* numPoints */,
+               const math::Range& /* distances */,
+               const std::false_type /* takesNodes */)
+  { return false; }
 
   TraversalInfoType traversalInfo;
 
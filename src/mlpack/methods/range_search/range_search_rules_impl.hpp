@@ -18,10 +18,10 @@
 namespace mlpack {
 namespace range {
 
-template<typename MetricType, typename TreeType>
-RangeSearchRules<MetricType, TreeType>::RangeSearchRules(
-    const arma::mat& referenceSet,
-    const arma::mat& querySet,
+template<typename MetricType, typename TreeType, typename CallbackType>
+RangeSearchRules<MetricType, TreeType, CallbackType>::RangeSearchRules(
+    const MatType& referenceSet,
+    const MatType& querySet,
     const math::Range& range,
     std::vector<std::vector<size_t> >& neighbors,
     std::vector<std::vector<double> >& distances,
@@ -30,12 +30,35 @@ RangeSearchRules<MetricType, TreeType>::RangeSearchRules(
     referenceSet(referenceSet),
     querySet(querySet),
     range(range),
-    neighbors(neighbors),
-    distances(distances),
+    callback(neighbors, distances),
     metric(metric),
     sameSet(sameSet),
     lastQueryIndex(querySet.n_cols),
     lastReferenceIndex(referenceSet.n_cols),
+    lastBaseCase(0.0),
+    baseCases(0),
+    scores(0)
+{
+  // Nothing to do.
+}
+
+template<typename MetricType, typename TreeType, typename CallbackType>
+RangeSearchRules<MetricType, TreeType, CallbackType>::RangeSearchRules(
+    const MatType& referenceSet,
+    const MatType& querySet,
+    const math::Range& range,
+    CallbackType callback,
+    MetricType& metric,
+    const bool sameSet) :
+    referenceSet(referenceSet),
+    querySet(querySet),
+    range(range),
+    callback(callback),
+    metric(metric),
+    sameSet(sameSet),
+    lastQueryIndex(querySet.n_cols),
+    lastReferenceIndex(referenceSet.n_cols),
+    lastBaseCase(0.0),
     baseCases(0),
     scores(0)
 {
@@ -44,9 +67,9 @@ RangeSearchRules<MetricType, TreeType>::RangeSearchRules(
 
 //! The base case.  Evaluate the distance between the two points and add to the
 //! results if necessary.
-template<typename MetricType, typename TreeType>
+template<typename MetricType, typename TreeType, typename CallbackType>
 inline force_inline
-double RangeSearchRules<MetricType, TreeType>::BaseCase(
+double RangeSearchRules<MetricType, TreeType, CallbackType>::BaseCase(
     const size_t queryIndex,
     const size_t referenceIndex)
 {
@@ -65,20 +88,19 @@ double RangeSearchRules<MetricType, TreeType>::BaseCase(
   // Update last indices, so we don't accidentally perform a base case twice.
   lastQueryIndex = queryIndex;
   lastReferenceIndex = referenceIndex;
+  lastBaseCase = distance;
 
   if (range.Contains(distance))
-  {
-    neighbors[queryIndex].push_back(referenceIndex);
-    distances[queryIndex].push_back(distance);
-  }
+    callback(queryIndex, referenceIndex, distance);
 
   return distance;
 }
 
 //! Single-tree scoring function.
-template<typename MetricType, typename TreeType>
-double RangeSearchRules<MetricType, TreeType>::Score(const size_t queryIndex,
-                                                     TreeType& referenceNode)
+template<typename MetricType, typename TreeType, typename CallbackType>
+double RangeSearchRules<MetricType, TreeType, CallbackType>::Score(
+    const size_t queryIndex,
+    TreeType& referenceNode)
 {
   // We must get the minimum and maximum distances and store them in this
   // object.
@@ -94,10 +116,24 @@ double RangeSearchRules<MetricType, TreeType>::Score(const size_t queryIndex,
         (referenceNode.Point(0) == referenceNode.Parent()->Point(0)))
     {
       // If the tree has self-children and this is a self-child, the base case
-      // was already calculated.
-      baseCase = referenceNode.Parent()->Stat().LastDistance();
-      lastQueryIndex = queryIndex;
-      lastReferenceIndex = referenceNode.Point(0);
+      // was already calculated and its result already added.  It is kept in
+      // this object rather than in the tree, because other threads may search
+      // the same tree at the same time; if other base cases were calculated
+      // since then, the distance is calculated again.
+      if ((lastQueryIndex == queryIndex) &&
+          (lastReferenceIndex == referenceNode.Point(0)))
+      {
+        baseCase = lastBaseCase;
+      }
+      else
+      {
+        baseCase = metric.Evaluate(querySet.unsafe_col(queryIndex),
+            referenceSet.unsafe_col(referenceNode.Point(0)));
+        ++baseCases;
+        lastQueryIndex = queryIndex;
+        lastReferenceIndex = referenceNode.Point(0);
+        lastBaseCase = baseCase;
+      }
     }
     else
     {
@@ -108,9 +144,6 @@ double RangeSearchRules<MetricType, TreeType>::Score(const size_t queryIndex,
     // This may be possibly loose for non-ball bound trees.
     distances.Lo() = baseCase - referenceNode.FurthestDescendantDistance();
     distances.Hi() = baseCase + referenceNode.FurthestDescendantDistance();
-
-    // Update last distance calculation.
-    referenceNode.Stat().LastDistance() = baseCase;
   }
   else
   {
@@ -123,12 +156,11 @@ double RangeSearchRules<MetricType, TreeType>::Score(const size_t queryIndex,
     return DBL_MAX;
 
   // In this case, all of the points in the reference node will be part of the
-  // results.
-  if ((distances.Lo() >= range.Lo()) && (distances.Hi() <= range.Hi()))
-  {
-    AddResult(queryIndex, referenceNode);
+  // results.  If the callback declines to take the node at once, we recurse
+  // into it instead.
+  if ((distances.Lo() >= range.Lo()) && (distances.Hi() <= range.Hi()) &&
+      AddResult(queryIndex, referenceNode, distances))
     return DBL_MAX; // We don't need to go any deeper.
-  }
 
   // Otherwise the score doesn't matter.  Recursion order is irrelevant in
   // range search.
@@ -136,8 +168,8 @@ double RangeSearchRules<MetricType, TreeType>::Score(const size_t queryIndex,
 }
 
 //! Single-tree rescoring function.
-template<typename MetricType, typename TreeType>
-double RangeSearchRules<MetricType, TreeType>::Rescore(
+template<typename MetricType, typename TreeType, typename CallbackType>
+double RangeSearchRules<MetricType, TreeType, CallbackType>::Rescore(
     const size_t /* queryIndex */,
     TreeType& /* referenceNode */,
     const double oldScore) const
@@ -147,9 +179,10 @@ double RangeSearchRules<MetricType, TreeType>::Rescore(
 }
 
 //! Dual-tree scoring function.
-template<typename MetricType, typename TreeType>
-double RangeSearchRules<MetricType, TreeType>::Score(TreeType& queryNode,
-                                                     TreeType& referenceNode)
+template<typename MetricType, typename TreeType, typename CallbackType>
+double RangeSearchRules<MetricType, TreeType, CallbackType>::Score(
+    TreeType& queryNode,
+    TreeType& referenceNode)
 {
   math::Range distances;
   if (tree::TreeTraits<TreeType>::FirstPointIsCentroid)
@@ -193,11 +226,14 @@ double RangeSearchRules<MetricType, TreeType>::Score(TreeType& queryNode,
     return DBL_MAX;
 
   // In this case, all of the points in the reference node will be part of all
-  // the results for each point in the query node.
-  if ((distances.Lo() >= range.Lo()) && (distances.Hi() <= range.Hi()))
+  // the results for each point in the query node.  The callback takes or
+  // declines the node for all query points alike, since its decision only
+  // depends on the distances; if it declines, we recurse instead.
+  if ((distances.Lo() >= range.Lo()) && (distances.Hi() <= range.Hi()) &&
+      AddResult(queryNode.Descendant(0), referenceNode, distances))
   {
-    for (size_t i = 0; i < queryNode.NumDescendants(); ++i)
-      AddResult(queryNode.Descendant(i), referenceNode);
+    for (size_t i = 1; i < queryNode.NumDescendants(); ++i)
+      AddResult(queryNode.Descendant(i), referenceNode, distances);
     return DBL_MAX; // We don't need to go any deeper.
   }
 
@@ -209,8 +245,8 @@ double RangeSearchRules<MetricType, TreeType>::Score(TreeType& queryNode,
 }
 
 //! Dual-tree rescoring function.
-template<typename MetricType, typename TreeType>
-double RangeSearchRules<MetricType, TreeType>::Rescore(
+template<typename MetricType, typename TreeType, typename CallbackType>
+double RangeSearchRules<MetricType, TreeType, CallbackType>::Rescore(
     TreeType& /* queryNode */,
     TreeType& /* referenceNode */,
     const double oldScore) const
@@ -221,9 +257,11 @@ double RangeSearchRules<MetricType, TreeType>::Rescore(
 
 //! Add all the points in the given node to the results for the given query
 //! point.
-template<typename MetricType, typename TreeType>
-void RangeSearchRules<MetricType, TreeType>::AddResult(const size_t queryIndex,
-                                                       TreeType& referenceNode)
+template<typename MetricType, typename TreeType, typename CallbackType>
+bool RangeSearchRules<MetricType, TreeType, CallbackType>::AddResult(
+    const size_t queryIndex,
+    TreeType& referenceNode,
+    const math::Range& distances)
 {
   // Some types of trees calculate the base case evaluation before Score() is
   // called, so if the base case has already been calculated, then we must avoid
@@ -236,27 +274,39 @@ void RangeSearchRules<MetricType, TreeType>::AddResult(const size_t queryIndex,
     baseCaseMod = 1;
   }
 
-  // Resize distances and neighbors vectors appropriately.  We have to use
-  // reserve() and not resize(), because we don't know if we will encounter the
-  // case where the datasets and points are the same (and we skip in that case).
-  const size_t oldSize = neighbors[queryIndex].size();
-  neighbors[queryIndex].reserve(oldSize + referenceNode.NumDescendants() -
-      baseCaseMod);
-  distances[queryIndex].reserve(oldSize + referenceNode.NumDescendants() -
-      baseCaseMod);
+  // A callback that takes nodes gets all the points at once, without their
+  // distances, or declines them.  This can't exclude the query point from its
+  // own results, so it is only done when the query set isn't the reference
+  // set.
+  if (!sameSet && RangeSearchCallbackTraits<CallbackType>::TakesNodes)
+  {
+    return AddNode(queryIndex, referenceNode.NumDescendants() - baseCaseMod,
+        distances, std::integral_constant<bool,
+        RangeSearchCallbackTraits<CallbackType>::TakesNodes>());
+  }
 
   for (size_t i = baseCaseMod; i < referenceNode.NumDescendants(); ++i)
   {
-    if ((&referenceSet == &querySet) &&
-        (queryIndex == referenceNode.Descendant(i)))
+    if (sameSet && (queryIndex == referenceNode.Descendant(i)))
       continue;
 
     const double distance = metric.Evaluate(querySet.unsafe_col(queryIndex),
         referenceNode.Dataset().unsafe_col(referenceNode.Descendant(i)));
 
-    neighbors[queryIndex].push_back(referenceNode.Descendant(i));
-    distances[queryIndex].push_back(distance);
+    callback(queryIndex, referenceNode.Descendant(i), distance);
   }
+
+  return true;
+}
+
+template<typename MetricType, typename TreeType, typename CallbackType>
+bool RangeSearchRules<MetricType, TreeType, CallbackType>::AddNode(
+    const size_t queryIndex,
+    const size_t numPoints,
+    const math::Range& distances,
+    const std::true_type /* takesNodes */)
+{
+  return callback.AddNode(queryIndex, numPoints, distances);
 }
 
 } // namespace range
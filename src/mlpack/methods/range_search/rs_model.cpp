@@ -11,6 +11,8 @@
  */
 #include "rs_model.hpp"
 #include <mlpack/core/math/random_basis.hpp>
+#include <fstream>
+#include <sstream>
 
 using namespace std;
 using namespace mlpack;
@@ -33,7 +35,8 @@ RSModel::RSModel(const RSModel& other) :
     treeType(other.treeType),
     leafSize(other.leafSize),
     randomBasis(other.randomBasis),
-    rSearch(other.rSearch)
+    rSearch(other.rSearch),
+    mappedFile(other.mappedFile)
 {
   // Nothing to do.
 }
@@ -43,7 +46,8 @@ RSModel::RSModel(RSModel&& other) :
     treeType(other.treeType),
     leafSize(other.leafSize),
     randomBasis(other.randomBasis),
-    rSearch(other.rSearch)
+    rSearch(other.rSearch),
+    mappedFile(std::move(other.mappedFile))
 {
   // Reset other model.
   other.treeType = TreeTypes::KD_TREE;
@@ -61,6 +65,7 @@ RSModel& RSModel::operator=(const RSModel& other)
   leafSize = other.leafSize;
   randomBasis = other.randomBasis;
   rSearch = other.rSearch;
+  mappedFile = other.mappedFile;
 
   return *this;
 }
@@ -74,6 +79,7 @@ RSModel& RSModel::operator=(RSModel&& other)
   leafSize = other.leafSize;
   randomBasis = other.randomBasis;
   rSearch = other.rSearch;
+  mappedFile = std::move(other.mappedFile);
 
   // Reset other model.
   other.treeType = TreeTypes::KD_TREE;
@@ -106,6 +112,7 @@ void RSModel::BuildModel(arma::mat&& referenceSet,
 
   // Clean memory, if necessary.
   boost::apply_visitor(DeleteVisitor(), rSearch);
+  mappedFile.reset();
 
   // Do we need to modify the reference set?
   if (randomBasis)
@@ -186,6 +193,132 @@ void RSModel::BuildModel(arma::mat&& referenceSet,
   }
 }
 
+// Save the model as a flat image.
+void RSModel::SaveFlat(const std::string& filename)
+{
+  ofstream stream(filename.c_str(), ios::binary);
+  if (!stream.is_open())
+  {
+    ostringstream oss;
+    oss << "RSModel::SaveFlat(): cannot open file '" << filename << "' for "
+        << "writing";
+    throw runtime_error(oss.str());
+  }
+
+  tree::FlatModelHeader header;
+  memset(&header, 0, sizeof(tree::FlatModelHeader));
+  strncpy(header.magic, "mlpkrsm", sizeof(header.magic));
+  header.version = 1;
+  header.treeOffset = tree::FlatImageAlign(sizeof(tree::FlatModelHeader));
+
+  // The header is written again once the offsets are known.
+  const char padding[tree::FlatImageAlignment] = { 0 };
+  stream.write(reinterpret_cast<const char*>(&header),
+      sizeof(tree::FlatModelHeader));
+  stream.write(padding, header.treeOffset - sizeof(tree::FlatModelHeader));
+
+  ostringstream params(ios::binary);
+  {
+    boost::archive::binary_oarchive ar(params);
+    ar << data::CreateNVP(treeType, "treeType");
+    ar << data::CreateNVP(leafSize, "leafSize");
+    ar << data::CreateNVP(randomBasis, "randomBasis");
+    ar << data::CreateNVP(q, "q");
+
+    FlatSaveVisitor visitor(stream, ar);
+    boost::apply_visitor(visitor, rSearch);
+  }
+  const string paramsString = params.str();
+
+  const size_t treeEnd = (size_t) stream.tellp();
+  header.paramsOffset = tree::FlatImageAlign(treeEnd);
+  header.paramsSize = paramsString.size();
+  stream.write(padding, header.paramsOffset - treeEnd);
+  stream.write(paramsString.data(), paramsString.size());
+
+  stream.seekp(0);
+  stream.write(reinterpret_cast<const char*>(&header),
+      sizeof(tree::FlatModelHeader));
+
+  if (!stream.good())
+  {
+    ostringstream oss;
+    oss << "RSModel::SaveFlat(): error writing to file '" << filename << "'";
+    throw runtime_error(oss.str());
+  }
+}
+
+// Load the model from a flat image.
+void RSModel::LoadFlat(const std::string& filename)
+{
+  shared_ptr<data::MappedFile> file = make_shared<data::MappedFile>(filename);
+
+  tree::FlatModelHeader header;
+  if (file->Size() >= sizeof(tree::FlatModelHeader))
+    memcpy(&header, file->Memory(), sizeof(tree::FlatModelHeader));
+  if (file->Size() < sizeof(tree::FlatModelHeader) ||
+      strncmp(header.magic, "mlpkrsm", sizeof(header.magic)) != 0 ||
+      header.version != 1 ||
+      header.treeOffset > header.paramsOffset ||
+      header.paramsOffset + header.paramsSize > file->Size())
+  {
+    ostringstream oss;
+    oss << "RSModel::LoadFlat(): file '" << filename << "' was not written "
+        << "by RSModel::SaveFlat()";
+    throw runtime_error(oss.str());
+  }
+
+  tree::MemoryStreamBuf buffer(file->Memory() + header.paramsOffset,
+      header.paramsSize);
+  boost::archive::binary_iarchive ar(buffer);
+
+  TreeTypes newTreeType;
+  ar >> data::CreateNVP(newTreeType, "treeType");
+  ar >> data::CreateNVP(leafSize, "leafSize");
+  ar >> data::CreateNVP(randomBasis, "randomBasis");
+  ar >> data::CreateNVP(q, "q");
+
+  char* image = file->Memory() + header.treeOffset;
+  const size_t imageSize = header.paramsOffset - header.treeOffset;
+  decltype(rSearch) newSearch;
+  switch (newTreeType)
+  {
+    case KD_TREE:
+      newSearch = LoadFlatSearch<RSType<tree::KDTree>>(image, imageSize, ar);
+      break;
+
+    case BALL_TREE:
+      newSearch = LoadFlatSearch<RSType<tree::BallTree>>(image, imageSize, ar);
+      break;
+
+    case VP_TREE:
+      newSearch = LoadFlatSearch<RSType<tree::VPTree>>(image, imageSize, ar);
+      break;
+
+    case RP_TREE:
+      newSearch = LoadFlatSearch<RSType<tree::RPTree>>(image, imageSize, ar);
+      break;
+
+    case MAX_RP_TREE:
+      newSearch = LoadFlatSearch<RSType<tree::MaxRPTree>>(image, imageSize,
+          ar);
+      break;
+
+    case UB_TREE:
+      newSearch = LoadFlatSearch<RSType<tree::UBTree>>(image, imageSize, ar);
+      break;
+
+    default:
+      throw invalid_argument("RSModel::LoadFlat(): the tree type of the model "
+          "cannot be loaded from a flat image");
+  }
+
+  boost::apply_visitor(DeleteVisitor(), rSearch);
+  treeType = newTreeType;
+  rSearch = newSearch;
+  mappedFile = file;
+}
+
 // Perform range search.
 void RSModel::Search(arma::mat&& querySet,
                      const math::Range& range,
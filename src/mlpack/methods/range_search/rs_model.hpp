@@ -19,7 +19,11 @@
 #include <mlpack/core/tree/cover_tree.hpp>
 #include <mlpack/core/tree/rectangle_tree.hpp>
 #include <mlpack/core/tree/octree.hpp>
+#include <mlpack/core/data/mapped_file.hpp>
 #include <boost/variant.hpp>
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
+#include <memory>
 #include "range_search.hpp"
 
 namespace mlpack {
@@ -208,6 +212,41 @@ class SerializeVisitor : public boost::static_visitor<void>
   SerializeVisitor(Archive& ar, const std::string& name);
 };
 
+/**
+ * FlatSaveVisitor writes the reference tree of a RangeSearch object to a stream
+ * as a flat image (see BinarySpaceTree::SaveFlat()), and the search parameters
+ * to an archive.  A std::invalid_argument is thrown if the tree type does not
+ * support flat images or naive search is used.
+ */
+class FlatSaveVisitor : public boost::static_visitor<void>
+{
+ private:
+  //! The stream to write the tree to.
+  std::ostream& stream;
+  //! The archive to write the search parameters to.
+  boost::archive::binary_oarchive& ar;
+
+  //! Write the search parameters and the tree.
+  template<typename RSType>
+  void SaveFlat(RSType* rs,
+                const typename std::enable_if<tree::HasFlatImage<
+                    typename RSType::Tree>::value>::type* = 0) const;
+
+  //! Throw an exception, because the tree can't be written as a flat image.
+  template<typename RSType>
+  void SaveFlat(RSType* rs,
+                const typename std::enable_if<!tree::HasFlatImage<
+                    typename RSType::Tree>::value>::type* = 0) const;
+
+ public:
+  //! Write the given RSType instance.
+  template<typename RSType>
+  void operator()(RSType* rs) const;
+
+  //! Construct the FlatSaveVisitor with the given stream and archive.
+  FlatSaveVisitor(std::ostream& stream, boost::archive::binary_oarchive& ar);
+};
+
 /**
  * SingleModeVisitor exposes the SingleMode() method of the given RSType.
  */
@@ -235,6 +274,19 @@ class NaiveVisitor : public boost::static_visitor<bool&>
   bool& operator()(RSType* rs) const;
 };
 
+/**
+ * NumThreadsVisitor exposes the NumThreads() method of the given RSType.
+ */
+class NumThreadsVisitor : public boost::static_visitor<size_t&>
+{
+ public:
+  /**
+   * Get a reference to the number of threads of the given RangeSearch object.
+   */
+  template<typename RSType>
+  size_t& operator()(RSType* rs) const;
+};
+
 class RSModel
 {
  public:
@@ -285,6 +337,19 @@ class RSModel
                  RSType<tree::UBTree>*,
                  RSType<tree::Octree>*> rSearch;
 
+  //! The file holding the reference tree and dataset, if the model was loaded
+  //! with LoadFlat().
+  std::shared_ptr<data::MappedFile> mappedFile;
+
+  /**
+   * Create a RangeSearch object with the given type from the flat image of a
+   * tree and the search parameters stored in the given archive.
+   */
+  template<typename RSType>
+  static RSType* LoadFlatSearch(char* image,
+                                const size_t size,
+                                boost::archive::binary_iarchive& ar);
+
  public:
   /**
    * Initialize the RSModel with the given type and whether or not a random
@@ -333,6 +398,29 @@ class RSModel
   template<typename Archive>
   void Serialize(Archive& ar, const unsigned int /* version */);
 
+  /**
+   * Save the model to the given file in a flat, pointer-free layout that can be
+   * loaded with LoadFlat().  The file holds the points of the reference set in
+   * column-major order, the tree nodes as a table, and the other parameters of
+   * the model.  Only tree types built on BinarySpaceTree (kd-trees, ball trees,
+   * VP trees, RP trees, max-RP trees and UB trees) are supported; for other
+   * tree types, or in naive mode, a std::invalid_argument is thrown.
+   *
+   * @param filename File to save the model to.
+   */
+  void SaveFlat(const std::string& filename);
+
+  /**
+   * Load the model from a file written by SaveFlat().  The file is mapped into
+   * memory and the reference set is not copied, so loading takes time
+   * proportional to the number of tree nodes only, the points are read from
+   * disk as they are needed, and processes that load the same file share the
+   * memory holding it.  The file must not be modified while it is loaded.
+   *
+   * @param filename File to load the model from.
+   */
+  void LoadFlat(const std::string& filename);
+
   //! Expose the dataset.
   const arma::mat& Dataset() const;
 
@@ -346,6 +434,13 @@ class RSModel
   //! Modify whether the model is in naive search mode.
   bool& Naive();
 
+  //! Get the number of threads used for dual-tree search (0 means the OpenMP
+  //! default).
+  size_t NumThreads() const;
+  //! Modify the number of threads used for dual-tree search (0 means the
+  //! OpenMP default).
+  size_t& NumThreads();
+
   //! Get the leaf size (applicable to everything but the cover tree).
   size_t LeafSize() const { return leafSize; }
   //! Modify the leaf size (applicable to everything but the cover tree).
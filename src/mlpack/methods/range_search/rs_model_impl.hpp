@@ -220,6 +220,78 @@ bool& NaiveVisitor::operator()(RSType* rs) const
   throw std::runtime_error("no range search model initialized");
 }
 
+//! Exposes NumThreads() function of given RSType
+template<typename RSType>
+size_t& NumThreadsVisitor::operator()(RSType* rs) const
+{
+  if (rs)
+    return rs->NumThreads();
+  throw std::runtime_error("no range search model initialized");
+}
+
+//! Construct the FlatSaveVisitor with the given stream and archive.
+inline FlatSaveVisitor::FlatSaveVisitor(std::ostream& stream,
+                                        boost::archive::binary_oarchive& ar) :
+    stream(stream),
+    ar(ar)
+{}
+
+//! Write the given RSType instance as a flat image.
+template<typename RSType>
+void FlatSaveVisitor::operator()(RSType* rs) const
+{
+  if (rs)
+    return SaveFlat(rs);
+  throw std::runtime_error("no range search model initialized");
+}
+
+//! Write the search parameters and the tree.
+template<typename RSType>
+void FlatSaveVisitor::SaveFlat(
+    RSType* rs,
+    const typename std::enable_if<tree::HasFlatImage<
+        typename RSType::Tree>::value>::type*) const
+{
+  if (rs->Naive())
+    throw std::invalid_argument("cannot save a model that uses naive search "
+        "as a flat image");
+
+  bool singleMode = rs->SingleMode();
+  std::vector<size_t> oldFromNewReferences = rs->OldFromNewReferences();
+  ar << data::CreateNVP(singleMode, "singleMode");
+  ar << data::CreateNVP(oldFromNewReferences, "oldFromNewReferences");
+
+  rs->ReferenceTree()->SaveFlat(stream);
+}
+
+//! Throw an exception, because the tree can't be written as a flat image.
+template<typename RSType>
+void FlatSaveVisitor::SaveFlat(
+    RSType* /* rs */,
+    const typename std::enable_if<!tree::HasFlatImage<
+        typename RSType::Tree>::value>::type*) const
+{
+  throw std::invalid_argument("the tree type of the model cannot be saved as "
+      "a flat image");
+}
+
+//! Create a RangeSearch object from a flat image.
+template<typename RSType>
+RSType* RSModel::LoadFlatSearch(char* image,
+                                const size_t size,
+                                boost::archive::binary_iarchive& ar)
+{
+  bool singleMode;
+  std::vector<size_t> oldFromNewReferences;
+  ar >> data::CreateNVP(singleMode, "singleMode");
+  ar >> data::CreateNVP(oldFromNewReferences, "oldFromNewReferences");
+
+  typename RSType::Tree tree(image, size);
+  RSType* rs = new RSType(false, singleMode);
+  rs->Train(std::move(tree), std::move(oldFromNewReferences));
+  return rs;
+}
+
 // Serialize the model.
 template<typename Archive>
 void RSModel::Serialize(Archive& ar, const unsigned int /* version */)
@@ -232,7 +304,10 @@ void RSModel::Serialize(Archive& ar, const unsigned int /* version */)
 
   // This should never happen, but just in case...
   if (Archive::is_loading::value)
+  {
     boost::apply_visitor(DeleteVisitor(), rSearch);
+    mappedFile.reset();
+  }
 
   // We'll only need to serialize one of the model objects, based on the type.
   const std::string& name = RSModelName::Name();
@@ -265,6 +340,16 @@ inline bool& RSModel::Naive()
   return boost::apply_visitor(NaiveVisitor(), rSearch);
 }
 
+inline size_t RSModel::NumThreads() const
+{
+  return boost::apply_visitor(NumThreadsVisitor(), rSearch);
+}
+
+inline size_t& RSModel::NumThreads()
+{
+  return boost::apply_visitor(NumThreadsVisitor(), rSearch);
+}
+
 } // namespace range
 } // namespace mlpack
 
@@ -0,0 +1,130 @@
+/**
+ * @file transformed_range_search.hpp
+ *
+ * Defines the TransformedRangeSearch class, which performs range search with a
+ * metric that is the Euclidean distance after a transformation of the points
+ * (such as the Mahalanobis distance), on transformed data.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_RANGE_SEARCH_TRANSFORMED_RANGE_SEARCH_HPP
+#define MLPACK_METHODS_RANGE_SEARCH_TRANSFORMED_RANGE_SEARCH_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/metrics/euclidean_transform.hpp>
+#include "range_search.hpp"
+
+namespace mlpack {
+namespace range {
+
+/**
+ * The TransformedRangeSearch class performs range search with a metric that
+ * has a metric::EuclideanTransform, such as the Mahalanobis distance or the
+ * metric induced by the cosine distance.  The reference set is transformed
+ * once when the object is built, and each query set when it is searched; the
+ * search itself is then a RangeSearch with the Euclidean distance, which
+ * costs O(d) per distance evaluation and can use the trees that need an
+ * LMetric.  The results are the same as with the original metric.
+ *
+ * @tparam OriginalMetricType The metric to search with.
+ * @tparam TreeType The tree type to use on the transformed points.
+ */
+template<typename OriginalMetricType = metric::MahalanobisDistance<>,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType = tree::KDTree>
+class TransformedRangeSearch
+{
+ public:
+  //! The transformation of the points.
+  typedef metric::EuclideanTransform<OriginalMetricType> TransformType;
+
+  static_assert(TransformType::IsTransformable, "TransformedRangeSearch "
+      "needs a metric with a metric::EuclideanTransform.");
+
+  //! The type of RangeSearch used on the transformed points.
+  typedef RangeSearch<typename TransformType::MetricType, arma::mat, TreeType>
+      SearchType;
+
+  /**
+   * Transform the given reference set and build the search on it.
+   *
+   * @param referenceSet Set of reference points.
+   * @param metric Metric to search with.
+   * @param naive If true, brute force naive search will be used.
+   * @param singleMode If true, single-tree search will be used.
+   */
+  TransformedRangeSearch(arma::mat referenceSet,
+                         const OriginalMetricType& metric,
+                         const bool naive = false,
+                         const bool singleMode = false) :
+      transform(metric),
+      search(Transformed(std::move(referenceSet)), naive, singleMode)
+  { }
+
+  /**
+   * Search for all reference points in the given range for each point in the
+   * query set, as RangeSearch::Search() does.  The query set is transformed
+   * first.
+   *
+   * @param querySet Set of query points to search with.
+   * @param range Range of distances in which to search.
+   * @param neighbors Object which will hold the list of neighbors for each
+   *      point which fell into the given range, for each query point.
+   * @param distances Object which will hold the list of distances for each
+   *      point which fell into the given range, for each query point.
+   */
+  void Search(const arma::mat& querySet,
+              const math::Range& range,
+              std::vector<std::vector<size_t>>& neighbors,
+              std::vector<std::vector<double>>& distances)
+  {
+    search.Search(Transformed(querySet), range, neighbors, distances);
+  }
+
+  /**
+   * Search for all the points of the reference set in the given range of each
+   * other, as RangeSearch::Search() does.
+   *
+   * @param range Range of distances in which to search.
+   * @param neighbors Object which will hold the list of neighbors for each
+   *      point which fell into the given range, for each query point.
+   * @param distances Object which will hold the list of distances for each
+   *      point which fell into the given range, for each query point.
+   */
+  void Search(const math::Range& range,
+              std::vector<std::vector<size_t>>& neighbors,
+              std::vector<std::vector<double>>& distances)
+  {
+    search.Search(range, neighbors, distances);
+  }
+
+  //! Get the transformation of the points.
+  const TransformType& Transform() const { return transform; }
+
+  //! Get the search on the transformed points.
+  const SearchType& Searcher() const { return search; }
+  //! Modify the search on the transformed points.
+  SearchType& Searcher() { return search; }
+
+ private:
+  //! The transformation of the points.
+  TransformType transform;
+  //! The search on the transformed points.
+  SearchType search;
+
+  //! Transform the given points and return them.
+  arma::mat Transformed(arma::mat points) const
+  {
+    transform.Apply(points);
+    return points;
+  }
+};
+
+} // namespace range
+} // namespace mlpack
+
+#endif
@@ -93,6 +93,9 @@ PARAM_FLAG("first_leaf_exact", "The flag to trigger sampling only after "
            "exactly exploring the first leaf.", "X");
 PARAM_INT_IN("single_sample_limit", "The limit on the maximum number of "
     "samples (and hence the largest node you can approximate).", "z", 20);
+PARAM_INT_IN("threads", "Number of threads to use for single-tree search (if "
+    "0, the OpenMP default is used).  Results are reproducible for a given "
+    "--seed and number of threads.", "j", 0);
 
 int main(int argc, char *argv[])
 {
@@ -230,6 +233,12 @@ int main(int argc, char *argv[])
   rann.SampleAtLeaves() = CLI::HasParam("sample_at_leaves");
   rann.FirstLeafExact() = CLI::HasParam("sample_at_leaves");
 
+  const int threads = CLI::GetParam<int>("threads");
+  if (threads < 0)
+    Log::Fatal << "Invalid number of threads: " << threads << ".  Must be 0 or "
+        << "greater." << endl;
+  rann.NumThreads() = size_t(threads);
+
   // Perform search, if desired.
   if (CLI::HasParam("k"))
   {
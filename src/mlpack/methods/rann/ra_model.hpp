@@ -175,6 +175,13 @@ class RAModel
   //! Modify the limit on the size of a node that can be approximation.
   size_t& SingleSampleLimit();
 
+  //! Get the number of threads used for single-tree search (0 means the
+  //! OpenMP default).
+  size_t NumThreads() const;
+  //! Modify the number of threads used for single-tree search (0 means the
+  //! OpenMP default).
+  size_t& NumThreads();
+
   //! Get the leaf size (only relevant when the kd-tree is used).
   size_t LeafSize() const;
   //! Modify the leaf size (only relevant when the kd-tree is used).
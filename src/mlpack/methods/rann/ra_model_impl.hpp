@@ -706,6 +706,62 @@ size_t& RAModel<SortPolicy>::SingleSampleLimit()
       "initialized");
 }
 
+template<typename SortPolicy>
+size_t RAModel<SortPolicy>::NumThreads() const
+{
+  if (kdTreeRA)
+    return kdTreeRA->NumThreads();
+  else if (coverTreeRA)
+    return coverTreeRA->NumThreads();
+  else if (rTreeRA)
+    return rTreeRA->NumThreads();
+  else if (rStarTreeRA)
+    return rStarTreeRA->NumThreads();
+  else if (xTreeRA)
+    return xTreeRA->NumThreads();
+  else if (hilbertRTreeRA)
+    return hilbertRTreeRA->NumThreads();
+  else if (rPlusTreeRA)
+    return rPlusTreeRA->NumThreads();
+  else if (rPlusPlusTreeRA)
+    return rPlusPlusTreeRA->NumThreads();
+  else if (ubTreeRA)
+    return ubTreeRA->NumThreads();
+  else if (octreeRA)
+    return octreeRA->NumThreads();
+
+  throw std::runtime_error("no rank-approximate nearest neighbor search model "
+      "initialized");
+}
+
+template<typename SortPolicy>
+size_t& RAModel<SortPolicy>::NumThreads()
+{
+  if (kdTreeRA)
+    return kdTreeRA->NumThreads();
+  else if (coverTreeRA)
+    return coverTreeRA->NumThreads();
+  else if (rTreeRA)
+    return rTreeRA->NumThreads();
+  else if (rStarTreeRA)
+    return rStarTreeRA->NumThreads();
+  else if (xTreeRA)
+    return xTreeRA->NumThreads();
+  else if (hilbertRTreeRA)
+    return hilbertRTreeRA->NumThreads();
+  else if (rPlusTreeRA)
+    return rPlusTreeRA->NumThreads();
+  else if (rPlusPlusTreeRA)
+    return rPlusPlusTreeRA->NumThreads();
+  else if (ubTreeRA)
+    return ubTreeRA->NumThreads();
+  else if (octreeRA)
+    return octreeRA->NumThreads();
+
+  throw std::runtime_error("no rank-approximate nearest neighbor search model "
+      "initialized");
+}
+
 template<typename SortPolicy>
 size_t RAModel<SortPolicy>::LeafSize() const
 {
@@ -26,6 +26,7 @@
 #include <mlpack/prereqs.hpp>
 
 #include <mlpack/core/tree/binary_space_tree.hpp>
+#include <mlpack/core/tree/traversal_statistics.hpp>
 
 #include <mlpack/core/metrics/lmetric.hpp>
 #include <mlpack/methods/neighbor_search/sort_policies/nearest_neighbor_sort.hpp>
@@ -414,6 +415,18 @@ class RASearch
   //! Modify the limit on the size of a node that can be approximation.
   size_t& SingleSampleLimit() { return singleSampleLimit; }
 
+  //! Get the number of threads used for single-tree search (0 means the
+  //! OpenMP default).
+  size_t NumThreads() const { return numThreads; }
+  //! Modify the number of threads used for single-tree search (0 means the
+  //! OpenMP default, and 1 disables parallel search).  Results are
+  //! reproducible for a given random seed and number of threads.
+  size_t& NumThreads() { return numThreads; }
+
+  //! Get the statistics of the last search.  The number of base cases is the
+  //! number of distance computations.
+  const tree::TraversalStatistics& Statistics() const { return statistics; }
+
   //! Serialize the object.
   template<typename Archive>
   void Serialize(Archive& ar, const unsigned int /* version */);
@@ -451,6 +464,34 @@ class RASearch
   //! Instantiation of kernel.
   MetricType metric;
 
+  //! The number of threads to use for single-tree search (0 means the OpenMP
+  //! default).
+  size_t numThreads;
+
+  //! The statistics of the last search.
+  tree::TraversalStatistics statistics;
+
+  /**
+   * Perform single-tree search for the given query set in parallel.  The query
+   * set is split into the given number of contiguous blocks, and each block is
+   * searched with its own rules object and its own random number generator,
+   * which is seeded from math::randGen.  So, for a given seed of math::randGen
+   * and a given number of blocks, the results are always the same, no matter
+   * which thread searches which block.
+   *
+   * @param querySet Set of query points.
+   * @param k Number of neighbors to search for.
+   * @param numBlocks Number of blocks to split the query set into (at most the
+   *      number of query points).
+   * @param neighbors Matrix to store the neighbors in (k x n, already sized).
+   * @param distances Matrix to store the distances in (k x n, already sized).
+   */
+  void ParallelSingleTreeSearch(const MatType& querySet,
+                                const size_t k,
+                                const size_t numBlocks,
+                                arma::Mat<size_t>& neighbors,
+                                arma::mat& distances);
+
   //! RAModel can modify internal members as necessary.
   friend class RAModel<SortPolicy>;
 }; // class RASearch
@@ -75,7 +75,8 @@ RASearch(const MatType& referenceSetIn,
     sampleAtLeaves(sampleAtLeaves),
     firstLeafExact(firstLeafExact),
     singleSampleLimit(singleSampleLimit),
-    metric(metric)
+    metric(metric),
+    numThreads(0)
 {
   // Nothing to do.
 }
@@ -110,7 +111,8 @@ RASearch(MatType&& referenceSetIn,
     sampleAtLeaves(sampleAtLeaves),
     firstLeafExact(firstLeafExact),
     singleSampleLimit(singleSampleLimit),
-    metric(metric)
+    metric(metric),
+    numThreads(0)
 {
   // Nothing to do.
 }
@@ -142,7 +144,8 @@ RASearch(Tree* referenceTree,
     sampleAtLeaves(sampleAtLeaves),
     firstLeafExact(firstLeafExact),
     singleSampleLimit(singleSampleLimit),
-    metric(metric)
+    metric(metric),
+    numThreads(0)
 // Nothing else to initialize.
 {  }
 
@@ -173,7 +176,8 @@ RASearch(const bool naive,
     sampleAtLeaves(sampleAtLeaves),
     firstLeafExact(firstLeafExact),
     singleSampleLimit(singleSampleLimit),
-    metric(metric)
+    metric(metric),
+    numThreads(0)
 {
   // Build the tree on the empty dataset, if necessary.
   if (!naive)
@@ -305,6 +309,7 @@ Search(const MatType& querySet,
   }
 
   Timer::Start("computing_neighbors");
+  statistics.Reset();
 
   // This will hold mappings for query points, if necessary.
   std::vector<size_t> oldFromNewQueries;
@@ -351,37 +356,65 @@ Search(const MatType& querySet,
 
     // Run the base case on each combination of query point and sampled
     // reference point.
-    for (size_t i = 0; i < querySet.n_cols; ++i)
-      for (size_t j = 0; j < distinctSamples.n_elem; ++j)
-        rules.BaseCase(i, (size_t) distinctSamples[j]);
+    {
+      tree::TraversalStatistics::PhaseTimer timer(statistics.TraversalTime());
+      for (size_t i = 0; i < querySet.n_cols; ++i)
+        for (size_t j = 0; j < distinctSamples.n_elem; ++j)
+          rules.BaseCase(i, (size_t) distinctSamples[j]);
+    }
+    statistics.BaseCases() += rules.NumDistComputations();
 
     rules.GetResults(*neighborPtr, *distancePtr);
   }
   else if (singleMode)
   {
-    RuleType rules(*referenceSet, querySet, k, metric, tau, alpha, naive,
-        sampleAtLeaves, firstLeafExact, singleSampleLimit, false);
+#ifdef HAS_OPENMP
+    const size_t threads = (numThreads == 0) ? omp_get_max_threads() :
+        numThreads;
+#else
+    const size_t threads = 1;
+#endif
 
-    // If the reference root node is a leaf, then the sampling has already been
-    // done in the RASearchRules constructor.  This happens when naive = true.
-    if (!referenceTree->IsLeaf())
+    // If more than one thread may be used, split the query points between
+    // threads; otherwise, search for all query points with one rules object.
+    if (threads > 1 && querySet.n_cols > 1 && !referenceTree->IsLeaf())
+    {
+      ParallelSingleTreeSearch(querySet, k, std::min(threads,
+          (size_t) querySet.n_cols), *neighborPtr, *distancePtr);
+    }
+    else
     {
-      Log::Info << "Performing single-tree traversal..." << std::endl;
+      RuleType rules(*referenceSet, querySet, k, metric, tau, alpha, naive,
+          sampleAtLeaves, firstLeafExact, singleSampleLimit, false);
 
-      // Create the traverser.
-      typename Tree::template SingleTreeTraverser<RuleType> traverser(rules);
+      // If the reference root node is a leaf, then the sampling has already
+      // been done in the RASearchRules constructor.  This happens when naive =
+      // true.
+      if (!referenceTree->IsLeaf())
+      {
+        Log::Info << "Performing single-tree traversal..." << std::endl;
 
-      // Now have it traverse for each point.
-      for (size_t i = 0; i < querySet.n_cols; ++i)
-        traverser.Traverse(i, *referenceTree);
+        // Create the traverser.
+        typename Tree::template SingleTreeTraverser<RuleType> traverser(rules);
 
-      Log::Info << "Single-tree traversal complete." << std::endl;
-      Log::Info << "Average number of distance calculations per query point: "
-          << (rules.NumDistComputations() / querySet.n_cols) << "."
-          << std::endl;
-    }
+        // Now have it traverse for each point.
+        {
+          tree::TraversalStatistics::PhaseTimer timer(
+              statistics.TraversalTime());
+          for (size_t i = 0; i < querySet.n_cols; ++i)
+            traverser.Traverse(i, *referenceTree);
+        }
+        statistics.AddTraverser(traverser);
 
-    rules.GetResults(*neighborPtr, *distancePtr);
+        Log::Info << "Single-tree traversal complete." << std::endl;
+        Log::Info << "Average number of distance calculations per query point: "
+            << (rules.NumDistComputations() / querySet.n_cols) << "."
+            << std::endl;
+      }
+
+      statistics.BaseCases() += rules.NumDistComputations();
+      rules.GetResults(*neighborPtr, *distancePtr);
+    }
   }
   else // Dual-tree recursion.
   {
@@ -390,8 +423,13 @@ Search(const MatType& querySet,
     // Build the query tree.
     Timer::Stop("computing_neighbors");
     Timer::Start("tree_building");
-    Tree* queryTree = aux::BuildTree<Tree>(const_cast<MatType&>(querySet),
-        oldFromNewQueries);
+    Tree* queryTree;
+    {
+      tree::TraversalStatistics::PhaseTimer timer(
+          statistics.TreeBuildingTime());
+      queryTree = aux::BuildTree<Tree>(const_cast<MatType&>(querySet),
+          oldFromNewQueries);
+    }
     Timer::Stop("tree_building");
     Timer::Start("computing_neighbors");
 
@@ -402,7 +440,12 @@ Search(const MatType& querySet,
     Log::Info << "Query statistic pre-search: "
         << queryTree->Stat().NumSamplesMade() << std::endl;
 
-    traverser.Traverse(*queryTree, *referenceTree);
+    {
+      tree::TraversalStatistics::PhaseTimer timer(statistics.TraversalTime());
+      traverser.Traverse(*queryTree, *referenceTree);
+    }
+    statistics.BaseCases() += rules.NumDistComputations();
+    statistics.AddTraverser(traverser);
 
     Log::Info << "Dual-tree traversal complete." << std::endl;
     Log::Info << "Average number of distance calculations per query point: "
@@ -488,6 +531,7 @@ void RASearch<SortPolicy, MetricType, MatType, TreeType>::Search(
     arma::mat& distances)
 {
   Timer::Start("computing_neighbors");
+  statistics.Reset();
 
   // Get a reference to the query set.
   const MatType& querySet = queryTree->Dataset();
@@ -513,7 +557,12 @@ void RASearch<SortPolicy, MetricType, MatType, TreeType>::Search(
 
   // Create the traverser.
   typename Tree::template DualTreeTraverser<RuleType> traverser(rules);
-  traverser.Traverse(*queryTree, *referenceTree);
+  {
+    tree::TraversalStatistics::PhaseTimer timer(statistics.TraversalTime());
+    traverser.Traverse(*queryTree, *referenceTree);
+  }
+  statistics.BaseCases() += rules.NumDistComputations();
+  statistics.AddTraverser(traverser);
 
   rules.GetResults(*neighborPtr, distances);
 
@@ -547,6 +596,7 @@ void RASearch<SortPolicy, MetricType, MatType, TreeType>::Search(
     arma::mat& distances)
 {
   Timer::Start("computing_neighbors");
+  statistics.Reset();
 
   arma::Mat<size_t>* neighborPtr = &neighbors;
   arma::mat* distancePtr = &distances;
@@ -578,6 +628,7 @@ void RASearch<SortPolicy, MetricType, MatType, TreeType>::Search(
         distinctSamples);
 
     // The naive brute-force solution.
+    tree::TraversalStatistics::PhaseTimer timer(statistics.TraversalTime());
     for (size_t i = 0; i < referenceSet->n_cols; ++i)
       for (size_t j = 0; j < referenceSet->n_cols; ++j)
         rules.BaseCase(i, j);
@@ -588,17 +639,26 @@ void RASearch<SortPolicy, MetricType, MatType, TreeType>::Search(
     typename Tree::template SingleTreeTraverser<RuleType> traverser(rules);
 
     // Now have it traverse for each point.
-    for (size_t i = 0; i < referenceSet->n_cols; ++i)
-      traverser.Traverse(i, *referenceTree);
+    {
+      tree::TraversalStatistics::PhaseTimer timer(statistics.TraversalTime());
+      for (size_t i = 0; i < referenceSet->n_cols; ++i)
+        traverser.Traverse(i, *referenceTree);
+    }
+    statistics.AddTraverser(traverser);
   }
   else
   {
     // Create the traverser.
     typename Tree::template DualTreeTraverser<RuleType> traverser(rules);
 
-    traverser.Traverse(*referenceTree, *referenceTree);
+    {
+      tree::TraversalStatistics::PhaseTimer timer(statistics.TraversalTime());
+      traverser.Traverse(*referenceTree, *referenceTree);
+    }
+    statistics.AddTraverser(traverser);
   }
 
+  statistics.BaseCases() += rules.NumDistComputations();
   rules.GetResults(*neighborPtr, *distancePtr);
 
   Timer::Stop("computing_neighbors");
@@ -626,6 +686,98 @@ void RASearch<SortPolicy, MetricType, MatType, TreeType>::Search(
   }
 }
 
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void RASearch<SortPolicy, MetricType, MatType, TreeType>::
+ParallelSingleTreeSearch(const MatType& querySet,
+                         const size_t k,
+                         const size_t numBlocks,
+                         arma::Mat<size_t>& neighbors,
+                         arma::mat& distances)
+{
+  typedef RASearchRules<SortPolicy, MetricType, Tree> RuleType;
+  typedef typename MatType::elem_type ElemType;
+
+  tree::TraversalStatistics::PhaseTimer timer(statistics.TraversalTime());
+
+  Log::Info << "Performing single-tree traversal with " << numBlocks
+      << " blocks of query points..." << std::endl;
+
+  // Each block gets its own generator, seeded from the global generator, so
+  // that the samples drawn for a block only depend on the global seed.
+  std::vector<std::mt19937> generators;
+  generators.reserve(numBlocks);
+  for (size_t b = 0; b < numBlocks; ++b)
+    generators.push_back(std::mt19937(math::randGen()));
+
+  // Each block also gets its own copy of the metric, since the rules may
+  // modify it.
+  std::vector<MetricType> metrics(numBlocks, metric);
+
+  // Each block is an alias of a contiguous range of query points.  The rules
+  // are built here, and not by the threads, because their constructor uses
+  // timers.
+  std::vector<size_t> blockStarts(numBlocks + 1);
+  std::vector<MatType> blocks;
+  std::vector<RuleType> rules;
+  blocks.reserve(numBlocks);
+  rules.reserve(numBlocks);
+  for (size_t b = 0; b <= numBlocks; ++b)
+    blockStarts[b] = (b * querySet.n_cols) / numBlocks;
+
+  for (size_t b = 0; b < numBlocks; ++b)
+  {
+    blocks.emplace_back(const_cast<ElemType*>(
+        querySet.colptr(blockStarts[b])), querySet.n_rows,
+        blockStarts[b + 1] - blockStarts[b], false, true);
+    rules.emplace_back(*referenceSet, blocks[b], k, metrics[b], tau, alpha,
+        false, sampleAtLeaves, firstLeafExact, singleSampleLimit, false,
+        generators[b]);
+  }
+
+  size_t numPrunes = 0;
+
+#ifdef _WIN32
+  // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+  // support unsigned loop variables. If we're building for Visual Studio, use
+  // the intmax_t type instead.
+  #pragma omp parallel for schedule(dynamic) num_threads(numBlocks) \
+      reduction(+:numPrunes)
+  for (intmax_t b = 0; b < (intmax_t) numBlocks; ++b)
+#else
+  #pragma omp parallel for schedule(dynamic) num_threads(numBlocks) \
+      reduction(+:numPrunes)
+  for (size_t b = 0; b < numBlocks; ++b)
+#endif
+  {
+    typename Tree::template SingleTreeTraverser<RuleType> traverser(rules[b]);
+    for (size_t i = 0; i < blocks[b].n_cols; ++i)
+      traverser.Traverse(i, *referenceTree);
+    numPrunes += traverser.NumPrunes();
+
+    // The blocks hold disjoint columns of the results.
+    arma::Mat<size_t> blockNeighbors;
+    arma::mat blockDistances;
+    rules[b].GetResults(blockNeighbors, blockDistances);
+    neighbors.cols(blockStarts[b], blockStarts[b + 1] - 1) = blockNeighbors;
+    distances.cols(blockStarts[b], blockStarts[b + 1] - 1) = blockDistances;
+  }
+
+  size_t numDistComputations = 0;
+  for (size_t b = 0; b < numBlocks; ++b)
+    numDistComputations += rules[b].NumDistComputations();
+  statistics.BaseCases() += numDistComputations;
+  statistics.Prunes() += numPrunes;
+
+  Log::Info << "Single-tree traversal complete." << std::endl;
+  Log::Info << "Average number of distance calculations per query point: "
+      << (numDistComputations / querySet.n_cols) << "." << std::endl;
+}
+
 template<typename SortPolicy,
          typename MetricType,
          typename MatType,
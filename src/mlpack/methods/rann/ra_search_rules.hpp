@@ -53,6 +53,8 @@ class RASearchRules
    *     approximated by sampling.
    * @param sameSet If true, the query and reference set are taken to be the
    *      same, and a query point will not return itself in the results.
+   * @param generator Random number generator to draw samples with.  Searches
+   *      running in parallel must each use their own generator.
    */
   RASearchRules(const arma::mat& referenceSet,
                 const arma::mat& querySet,
@@ -64,7 +66,8 @@ class RASearchRules
                 const bool sampleAtLeaves = false,
                 const bool firstLeafExact = false,
                 const size_t singleSampleLimit = 20,
-                const bool sameSet = false);
+                const bool sameSet = false,
+                std::mt19937& generator = math::randGen);
 
   /**
    * Store the list of candidates for each query point in the given matrices.
@@ -296,6 +299,9 @@ class RASearchRules
   //! If the query and reference set are identical, this is true.
   bool sameSet;
 
+  //! The random number generator used to draw samples.
+  std::mt19937& generator;
+
   TraversalInfoType traversalInfo;
 
   /**
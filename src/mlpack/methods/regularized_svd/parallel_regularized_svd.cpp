@@ -0,0 +1,139 @@
+/**
+ * @file parallel_regularized_svd.cpp
+ *
+ * Implementation of the ParallelRegularizedSVD class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "parallel_regularized_svd.hpp"
+
+#include <mlpack/core/optimizers/hogwild_sgd/hogwild_sgd.hpp>
+
+namespace mlpack {
+namespace svd {
+
+ParallelRegularizedSVD::ParallelRegularizedSVD(const size_t iterations,
+                                               const double alpha,
+                                               const double lambda,
+                                               const bool stratified) :
+    iterations(iterations),
+    alpha(alpha),
+    lambda(lambda),
+    stratified(stratified)
+{
+  // Nothing to do.
+}
+
+void ParallelRegularizedSVD::Apply(const arma::mat& data,
+                                   const size_t rank,
+                                   arma::mat& u,
+                                   arma::mat& v)
+{
+  // The function gives the initial point, and the sparse gradients of the
+  // ratings for HogwildSGD.
+  RegularizedSVDFunction rSVDFunc(data, rank, lambda);
+  arma::mat parameters = rSVDFunc.GetInitialPoint();
+
+  const size_t numUsers = rSVDFunc.NumUsers();
+  const size_t numItems = rSVDFunc.NumItems();
+
+  if (stratified)
+  {
+    StratifiedOptimize(data, numUsers, parameters);
+  }
+  else
+  {
+    // The gradient of the function is twice the step of RegularizedSVD, so
+    // half the learning rate gives the same steps.  All the passes are run.
+    optimization::HogwildSGD<RegularizedSVDFunction> optimizer(rSVDFunc, 32,
+        alpha / 2, iterations, 0.0);
+    optimizer.Optimize(parameters);
+  }
+
+  // Extract user and item matrices from the optimized parameters.
+  u = parameters.submat(0, numUsers, rank - 1, numUsers + numItems - 1).t();
+  v = parameters.submat(0, 0, rank - 1, numUsers - 1);
+}
+
+void ParallelRegularizedSVD::StratifiedOptimize(const arma::mat& data,
+                                                const size_t numUsers,
+                                                arma::mat& parameters) const
+{
+#ifdef HAS_OPENMP
+  const size_t numBlocks = omp_get_max_threads();
+#else
+  const size_t numBlocks = 1;
+#endif
+  const size_t numItems = parameters.n_cols - numUsers;
+
+  // Assign the users and the items to the blocks at random, so that the
+  // blocks of the grid hold similar numbers of ratings.
+  const arma::uvec userOrder = arma::shuffle(arma::linspace<arma::uvec>(0,
+      numUsers - 1, numUsers));
+  const arma::uvec itemOrder = arma::shuffle(arma::linspace<arma::uvec>(0,
+      numItems - 1, numItems));
+
+  // Block (i, j) of the grid is stored at i * numBlocks + j.
+  std::vector<std::vector<size_t>> blockRatings(numBlocks * numBlocks);
+  for (size_t i = 0; i < data.n_cols; ++i)
+  {
+    const size_t userBlock = userOrder[(size_t) data(0, i)] * numBlocks /
+        numUsers;
+    const size_t itemBlock = itemOrder[(size_t) data(1, i)] * numBlocks /
+        numItems;
+    blockRatings[userBlock * numBlocks + itemBlock].push_back(i);
+  }
+
+  std::vector<arma::uvec> blocks(numBlocks * numBlocks);
+  for (size_t b = 0; b < blocks.size(); ++b)
+    blocks[b] = arma::conv_to<arma::uvec>::from(blockRatings[b]);
+
+  for (size_t iteration = 0; iteration < iterations; ++iteration)
+  {
+    // The ratings of each block are visited in a new order on each pass.
+    for (size_t b = 0; b < blocks.size(); ++b)
+      blocks[b] = arma::shuffle(blocks[b]);
+
+    for (size_t offset = 0; offset < numBlocks; ++offset)
+    {
+      // The blocks of this sub-pass share no user and no item.
+#ifdef _WIN32
+      // Tiny workaround: Visual Studio only implements OpenMP 2.0, which
+      // doesn't support unsigned loop variables. If we're building for Visual
+      // Studio, use the intmax_t type instead.
+      #pragma omp parallel for schedule(static, 1)
+      for (intmax_t t = 0; t < (intmax_t) numBlocks; ++t)
+#else
+      #pragma omp parallel for schedule(static, 1)
+      for (size_t t = 0; t < numBlocks; ++t)
+#endif
+      {
+        const arma::uvec& block = blocks[t * numBlocks +
+            (t + offset) % numBlocks];
+        arma::vec userVec(parameters.n_rows);
+        for (size_t k = 0; k < block.n_elem; ++k)
+        {
+          const size_t i = block[k];
+          const size_t user = data(0, i);
+          const size_t item = data(1, i) + numUsers;
+
+          // Take the step of RegularizedSVD, with both gradients taken at
+          // the current point.
+          const double ratingError = data(2, i) - arma::dot(
+              parameters.col(user), parameters.col(item));
+          userVec = parameters.col(user);
+          parameters.col(user) -= alpha * (lambda * userVec -
+              ratingError * parameters.col(item));
+          parameters.col(item) -= alpha * (lambda * parameters.col(item) -
+              ratingError * userVec);
+        }
+      }
+    }
+  }
+}
+
+} // namespace svd
+} // namespace mlpack
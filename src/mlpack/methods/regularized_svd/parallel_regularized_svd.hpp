@@ -0,0 +1,156 @@
+/**
+ * @file parallel_regularized_svd.hpp
+ *
+ * A parallel implementation of Regularized SVD, with either lock-free or
+ * block-stratified stochastic gradient descent.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_REGULARIZED_SVD_PARALLEL_REGULARIZED_SVD_HPP
+#define MLPACK_METHODS_REGULARIZED_SVD_PARALLEL_REGULARIZED_SVD_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/methods/cf/cf.hpp>
+
+#include "regularized_svd_function.hpp"
+
+namespace mlpack {
+namespace svd {
+
+/**
+ * This class finds the same factorization as RegularizedSVD, with the same
+ * learning rate and regularization parameter, but takes the SGD steps of the
+ * ratings on several threads at once.  Two schemes are available.
+ *
+ * With stratification (the default), this is the distributed SGD (DSGD) of
+ * the following paper:
+ *
+ * @code
+ * @inproceedings{gemulla2011large,
+ *   title={Large-scale matrix factorization with distributed stochastic
+ *       gradient descent},
+ *   author={Gemulla, R. and Nijkamp, E. and Haas, P.J. and Sismanis, Y.},
+ *   booktitle={Proceedings of the 17th ACM SIGKDD International Conference on
+ *       Knowledge Discovery and Data Mining},
+ *   pages={69--77},
+ *   year={2011}
+ * }
+ * @endcode
+ *
+ * The users and the items are split (at random) into as many blocks as there
+ * are threads, which splits the rating matrix into a grid of blocks.  Each pass
+ * over the ratings is made of one sub-pass per block of items; in a sub-pass,
+ * every thread takes the steps of the ratings of its own block of users and a
+ * different block of items.  The threads then never update the same user or
+ * item, so no step is lost, and the result does not depend on the scheduling
+ * of the threads.
+ *
+ * Without stratification, every pass is handed to HogwildSGD, whose threads
+ * take the steps of disjoint parts of the shuffled ratings without any
+ * locking (see the HogwildSGD documentation).  This has no barrier between
+ * sub-passes, but concurrent steps of the same user or item may overwrite each
+ * other.
+ *
+ * @code
+ * arma::mat data; // Rating data in the form of coordinate list.
+ *
+ * // Make a ParallelRegularizedSVD object for 10 passes over the data.
+ * ParallelRegularizedSVD rSVD(10, 0.01, 0.02);
+ *
+ * arma::mat u, v; // Item and user matrices.
+ * rSVD.Apply(data, 20, u, v);
+ * @endcode
+ */
+class ParallelRegularizedSVD
+{
+ public:
+  /**
+   * Create the factorizer with the given parameters.
+   *
+   * @param iterations Number of passes over the ratings.
+   * @param alpha Learning rate of the SGD steps.
+   * @param lambda Regularization parameter for the optimization.
+   * @param stratified If true, use DSGD; otherwise, use Hogwild!.
+   */
+  ParallelRegularizedSVD(const size_t iterations = 10,
+                         const double alpha = 0.01,
+                         const double lambda = 0.02,
+                         const bool stratified = true);
+
+  /**
+   * Obtains the user and item matrices using the provided data and rank.
+   *
+   * @param data Rating data matrix.
+   * @param rank Rank parameter to be used for optimization.
+   * @param u Item matrix obtained on decomposition.
+   * @param v User matrix obtained on decomposition.
+   */
+  void Apply(const arma::mat& data,
+             const size_t rank,
+             arma::mat& u,
+             arma::mat& v);
+
+  //! Get the number of passes over the ratings.
+  size_t Iterations() const { return iterations; }
+  //! Modify the number of passes over the ratings.
+  size_t& Iterations() { return iterations; }
+
+  //! Get the learning rate.
+  double Alpha() const { return alpha; }
+  //! Modify the learning rate.
+  double& Alpha() { return alpha; }
+
+  //! Get the regularization parameter.
+  double Lambda() const { return lambda; }
+  //! Modify the regularization parameter.
+  double& Lambda() { return lambda; }
+
+  //! Get whether the steps are stratified (DSGD) or lock-free (Hogwild!).
+  bool Stratified() const { return stratified; }
+  //! Modify whether the steps are stratified (DSGD) or lock-free (Hogwild!).
+  bool& Stratified() { return stratified; }
+
+ private:
+  /**
+   * Run DSGD on the given parameters, which hold the users and then the items.
+   *
+   * @param data Rating data matrix.
+   * @param numUsers Number of users in the data.
+   * @param parameters Parameters to optimize.
+   */
+  void StratifiedOptimize(const arma::mat& data,
+                          const size_t numUsers,
+                          arma::mat& parameters) const;
+
+  //! Number of passes over the ratings.
+  size_t iterations;
+  //! Learning rate of the SGD steps.
+  double alpha;
+  //! Regularization parameter for the optimization.
+  double lambda;
+  //! Whether to use DSGD instead of Hogwild!.
+  bool stratified;
+};
+
+} // namespace svd
+} // namespace mlpack
+
+namespace mlpack {
+namespace cf {
+
+//! Factorizer traits of parallel Regularized SVD.
+template<>
+class FactorizerTraits<mlpack::svd::ParallelRegularizedSVD>
+{
+ public:
+  //! Data provided to ParallelRegularizedSVD need not be cleaned.
+  static const bool UsesCoordinateList = true;
+};
+
+} // namespace cf
+} // namespace mlpack
+
+#endif
@@ -122,6 +122,39 @@ void RegularizedSVDFunction::Gradient(const arma::mat& parameters,
   }
 }
 
+void RegularizedSVDFunction::Gradient(const arma::mat& parameters,
+                                      const size_t i,
+                                      arma::sp_mat& gradient) const
+{
+  // Indices for accessing the the correct parameter columns.
+  const size_t user = data(0, i);
+  const size_t item = data(1, i) + numUsers;
+
+  // Prediction error for the example.
+  const double rating = data(2, i);
+  double ratingError = rating - arma::dot(parameters.col(user),
+                                          parameters.col(item));
+
+  // The gradient is the same as the contribution of the example to the full
+  // gradient, but only the two columns of the example are stored.
+  arma::umat locations(2, 2 * rank);
+  arma::vec values(2 * rank);
+  for (size_t r = 0; r < rank; ++r)
+  {
+    locations(0, r) = r;
+    locations(1, r) = user;
+    values[r] = 2 * (lambda * parameters(r, user) -
+                     ratingError * parameters(r, item));
+
+    locations(0, rank + r) = r;
+    locations(1, rank + r) = item;
+    values[rank + r] = 2 * (lambda * parameters(r, item) -
+                            ratingError * parameters(r, user));
+  }
+
+  gradient = arma::sp_mat(locations, values, rank, numUsers + numItems);
+}
+
 } // namespace svd
 } // namespace mlpack
 
@@ -0,0 +1,209 @@
+/**
+ * @file async_learning.hpp
+ *
+ * Definition of AsyncLearning, which collects experience with many actor
+ * threads while one learner trains a Q-network on it.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_RL_ASYNC_LEARNING_HPP
+#define MLPACK_METHODS_RL_ASYNC_LEARNING_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+#include "replay/random_replay.hpp"
+#include "replay/transition_queue.hpp"
+
+namespace mlpack {
+namespace rl {
+
+/**
+ * AsyncLearning trains a Q-network (a network with one output, the value, for
+ * each action) with one-step Q-learning on the experience of many actors, in
+ * the style of Ape-X.  Each actor is a thread with its own copy of the
+ * environment and of the network, which acts epsilon-greedily and pushes each
+ * transition into a lock-free TransitionQueue.  The learner, in the calling
+ * thread, moves the transitions from the queue into a replay memory, and
+ * trains the network on batches sampled from it with the targets
+ *
+ *   r + discount * max_a Q_target(s', a)
+ *
+ * (or r if s' is terminal).  Every publishInterval learner steps, the
+ * learner publishes its parameters: the actors copy them into their networks
+ * before their next step, and the target network takes them too.
+ *
+ * As in Ape-X, actor i of N explores with probability
+ * epsilon^(1 + 7 i / (N - 1)), so some actors explore a lot and others act
+ * almost greedily.
+ *
+ * @code
+ * FFN<MeanSquaredError<>, GaussianInitialization> network(
+ *     MeanSquaredError<>(), GaussianInitialization(0, 0.001));
+ * network.Add<Linear<>>(4, 64);
+ * network.Add<ReLULayer<>>();
+ * network.Add<Linear<>>(64, 2);
+ * network.ResetParameters();
+ *
+ * // The optimizer makes one pass over each sampled batch of 32 transitions.
+ * RMSProp<decltype(network)> optimizer(network, 0.001, 0.99, 1e-8, 32);
+ * RandomReplay<CartPole> replay(32, 100000);
+ *
+ * AsyncLearning<CartPole, decltype(network), decltype(optimizer)> learning(
+ *     network, optimizer, replay, 8);
+ * learning.Train(10000);
+ * @endcode
+ *
+ * @tparam EnvironmentType The task; it must be copyable, since each actor has
+ *     its own copy.
+ * @tparam NetworkType The Q-network (such as FFN); it must be copyable, and
+ *     its parameters must not be reallocated when they are assigned.
+ * @tparam OptimizerType The optimizer used for each learner step, which must
+ *     be constructed on the network.
+ * @tparam ReplayType The replay memory of the learner, with the interface of
+ *     RandomReplay.
+ */
+template<
+  typename EnvironmentType,
+  typename NetworkType,
+  typename OptimizerType,
+  typename ReplayType = RandomReplay<EnvironmentType>
+>
+class AsyncLearning
+{
+ public:
+  using ActionType = typename EnvironmentType::Action;
+  using StateType = typename EnvironmentType::State;
+
+  /**
+   * Prepare to train the given network; nothing is run until Train() is
+   * called.  The network, optimizer and replay memory are used by reference
+   * and must outlive this object.
+   *
+   * @param network The Q-network to train.
+   * @param optimizer The optimizer of the network.
+   * @param replay The replay memory of the learner.
+   * @param numActors The number of actor threads.
+   * @param discount The discount of future rewards.
+   * @param publishInterval The number of learner steps between publications
+   *     of the parameters.
+   * @param minReplaySize The number of transitions in the replay memory
+   *     before the learner starts training.
+   * @param epsilon The largest probability to explore of the actors.
+   * @param queueSize The capacity of the queue of transitions.
+   * @param environment The task; each actor gets a copy.
+   */
+  AsyncLearning(NetworkType& network,
+                OptimizerType& optimizer,
+                ReplayType& replay,
+                const size_t numActors = 4,
+                const double discount = 0.99,
+                const size_t publishInterval = 100,
+                const size_t minReplaySize = 100,
+                const double epsilon = 0.4,
+                const size_t queueSize = 4096,
+                const EnvironmentType& environment = EnvironmentType());
+
+  /**
+   * Start the actors, run the given number of learner steps, then stop the
+   * actors and wait for them.  This may be called again to train further; the
+   * actors then start new episodes.  If an actor throws an exception, the
+   * actors are stopped and the exception is rethrown.
+   *
+   * @param steps The number of batches to train the network on.
+   */
+  void Train(const size_t steps);
+
+  //! Get the number of actor threads.
+  size_t NumActors() const { return numActors; }
+  //! Modify the number of actor threads.
+  size_t& NumActors() { return numActors; }
+
+  //! Get the number of environment steps taken by all the actors.
+  size_t ActorSteps() const { return actorSteps; }
+  //! Get the number of episodes completed by all the actors.
+  size_t Episodes() const { return episodes; }
+  //! Get the number of times the parameters have been published.
+  size_t Publications() const { return version; }
+  //! Get the number of learner steps taken.
+  size_t LearnerSteps() const { return learnerSteps; }
+
+ private:
+  //! Run actor number index with the given seed until the actors are stopped.
+  void Actor(const size_t index, const size_t seed);
+
+  //! Train the network on one batch sampled from the replay memory.
+  void LearnerStep();
+
+  //! Give the parameters of the network to the actors and the target network.
+  void Publish();
+
+  //! Locally-stored Q-network.
+  NetworkType& network;
+  //! Locally-stored optimizer of the network.
+  OptimizerType& optimizer;
+  //! Locally-stored replay memory of the learner.
+  ReplayType& replay;
+
+  //! Locally-stored number of actor threads.
+  size_t numActors;
+  //! Locally-stored discount of future rewards.
+  double discount;
+  //! Locally-stored number of learner steps between publications.
+  size_t publishInterval;
+  //! Locally-stored number of transitions needed before training.
+  size_t minReplaySize;
+  //! Locally-stored largest probability to explore.
+  double epsilon;
+  //! Locally-stored task.
+  EnvironmentType environment;
+
+  //! The queue of transitions from the actors to the learner.
+  TransitionQueue<EnvironmentType> queue;
+
+  //! The network that the targets are computed with.
+  NetworkType targetNetwork;
+  //! The networks of the actors.
+  std::vector<NetworkType> actorNetworks;
+
+  //! The last published parameters.
+  arma::mat published;
+  //! The number of publications; actors compare it with the version of their
+  //! parameters.
+  std::atomic<size_t> version;
+  //! The lock of the published parameters.
+  std::mutex publishMutex;
+
+  //! Whether the actors should stop.
+  std::atomic<bool> stop;
+  //! The number of environment steps of all the actors.
+  std::atomic<size_t> actorSteps;
+  //! The number of completed episodes of all the actors.
+  std::atomic<size_t> episodes;
+  //! The number of learner steps taken.
+  size_t learnerSteps;
+
+  //! The first exception thrown by an actor.
+  std::exception_ptr error;
+  //! The lock of the exception.
+  std::mutex errorMutex;
+
+  //! Locally-stored sampled batch and its targets, reused at each step.
+  arma::mat sampledStates, sampledNextStates, targets, nextValues;
+  arma::icolvec sampledActions, sampledTerminal;
+  arma::colvec sampledRewards;
+};
+
+} // namespace rl
+} // namespace mlpack
+
+// Include implementation.
+#include "async_learning_impl.hpp"
+
+#endif
@@ -0,0 +1,265 @@
+/**
+ * @file async_learning_impl.hpp
+ *
+ * Implementation of AsyncLearning.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_RL_ASYNC_LEARNING_IMPL_HPP
+#define MLPACK_METHODS_RL_ASYNC_LEARNING_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "async_learning.hpp"
+
+#include <mlpack/core/math/random.hpp>
+
+namespace mlpack {
+namespace rl {
+
+template<typename EnvironmentType,
+         typename NetworkType,
+         typename OptimizerType,
+         typename ReplayType>
+AsyncLearning<EnvironmentType, NetworkType, OptimizerType, ReplayType>::
+AsyncLearning(NetworkType& network,
+              OptimizerType& optimizer,
+              ReplayType& replay,
+              const size_t numActors,
+              const double discount,
+              const size_t publishInterval,
+              const size_t minReplaySize,
+              const double epsilon,
+              const size_t queueSize,
+              const EnvironmentType& environment) :
+    network(network),
+    optimizer(optimizer),
+    replay(replay),
+    numActors(numActors),
+    discount(discount),
+    publishInterval(publishInterval),
+    minReplaySize(std::max(minReplaySize, (size_t) 1)),
+    epsilon(epsilon),
+    environment(environment),
+    queue(queueSize),
+    version(0),
+    stop(false),
+    actorSteps(0),
+    episodes(0),
+    learnerSteps(0)
+{
+  if (numActors == 0)
+    throw std::invalid_argument("AsyncLearning::AsyncLearning(): numActors "
+        "must be greater than 0!");
+  if (publishInterval == 0)
+    throw std::invalid_argument("AsyncLearning::AsyncLearning(): "
+        "publishInterval must be greater than 0!");
+}
+
+template<typename EnvironmentType,
+         typename NetworkType,
+         typename OptimizerType,
+         typename ReplayType>
+void AsyncLearning<EnvironmentType, NetworkType, OptimizerType, ReplayType>::
+Train(const size_t steps)
+{
+  if (network.Parameters().is_empty())
+    network.ResetParameters();
+
+  // The copies of the network are made before any thread starts.  The layers
+  // of a copy are pointed at its own parameters, so that assigning the
+  // published parameters to them updates the layers.
+  targetNetwork = network;
+  targetNetwork.ResetParameters();
+  targetNetwork.Parameters() = network.Parameters();
+
+  actorNetworks.clear();
+  actorNetworks.reserve(numActors);
+  for (size_t i = 0; i < numActors; ++i)
+    actorNetworks.push_back(network);
+  for (size_t i = 0; i < numActors; ++i)
+  {
+    actorNetworks[i].ResetParameters();
+    actorNetworks[i].Parameters() = network.Parameters();
+  }
+
+  published = network.Parameters();
+  stop = false;
+  error = std::exception_ptr();
+
+  // Each actor draws from its own random stream.
+  const size_t seed = (size_t) math::RandInt(std::numeric_limits<int>::max());
+  std::vector<std::thread> actors;
+  for (size_t i = 0; i < numActors; ++i)
+    actors.push_back(std::thread(&AsyncLearning::Actor, this, i, seed));
+
+  std::exception_ptr learnerError;
+  try
+  {
+    StateType state, nextState;
+    ActionType action;
+    double reward;
+    bool isEnd;
+
+    size_t step = 0;
+    while (step < steps)
+    {
+      {
+        std::lock_guard<std::mutex> lock(errorMutex);
+        if (error)
+          break;
+      }
+
+      // Move the new transitions into the replay memory.
+      while (queue.Pop(state, action, reward, nextState, isEnd))
+        replay.Store(state, action, reward, nextState, isEnd);
+
+      if (replay.Size() < minReplaySize)
+      {
+        std::this_thread::yield();
+        continue;
+      }
+
+      LearnerStep();
+      ++step;
+      ++learnerSteps;
+      if (learnerSteps % publishInterval == 0)
+        Publish();
+    }
+  }
+  catch (...)
+  {
+    learnerError = std::current_exception();
+  }
+
+  stop = true;
+  for (size_t i = 0; i < actors.size(); ++i)
+    actors[i].join();
+
+  if (learnerError)
+    std::rethrow_exception(learnerError);
+  if (error)
+    std::rethrow_exception(error);
+}
+
+template<typename EnvironmentType,
+         typename NetworkType,
+         typename OptimizerType,
+         typename ReplayType>
+void AsyncLearning<EnvironmentType, NetworkType, OptimizerType, ReplayType>::
+Actor(const size_t index, const size_t seed)
+{
+  try
+  {
+    math::RandomStream stream(seed, index);
+    NetworkType& actorNetwork = actorNetworks[index];
+    EnvironmentType actorEnvironment(environment);
+
+    const double actorEpsilon = (numActors == 1) ? epsilon :
+        std::pow(epsilon, 1.0 + 7.0 * index / (numActors - 1));
+
+    size_t actorVersion = 0;
+    StateType state = actorEnvironment.InitialSample();
+    StateType nextState;
+    arma::mat actionValues;
+    while (!stop)
+    {
+      // Take the last published parameters, if they are new.
+      if (version != actorVersion)
+      {
+        std::lock_guard<std::mutex> lock(publishMutex);
+        actorNetwork.Parameters() = published;
+        actorVersion = version;
+      }
+
+      ActionType action;
+      if (stream.Random() < actorEpsilon)
+      {
+        action = static_cast<ActionType>(std::min((size_t) (stream.Random() *
+            ActionType::size), (size_t) ActionType::size - 1));
+      }
+      else
+      {
+        actorNetwork.Predict(state.Encode(), actionValues);
+        arma::uword best;
+        actionValues.max(best);
+        action = static_cast<ActionType>(best);
+      }
+
+      const double reward = actorEnvironment.Sample(state, action, nextState);
+      const bool isEnd = actorEnvironment.IsTerminal(nextState);
+
+      // Wait for the learner to make room in the queue.
+      while (!queue.Push(state, action, reward, nextState, isEnd))
+      {
+        if (stop)
+          return;
+        std::this_thread::yield();
+      }
+
+      ++actorSteps;
+      if (isEnd)
+      {
+        ++episodes;
+        state = actorEnvironment.InitialSample();
+      }
+      else
+      {
+        state = nextState;
+      }
+    }
+  }
+  catch (...)
+  {
+    std::lock_guard<std::mutex> lock(errorMutex);
+    if (!error)
+      error = std::current_exception();
+  }
+}
+
+template<typename EnvironmentType,
+         typename NetworkType,
+         typename OptimizerType,
+         typename ReplayType>
+void AsyncLearning<EnvironmentType, NetworkType, OptimizerType, ReplayType>::
+LearnerStep()
+{
+  replay.Sample(sampledStates, sampledActions, sampledRewards,
+      sampledNextStates, sampledTerminal);
+
+  // The targets are the current values, except for the value of the action
+  // taken, which is the one-step Q-learning target.
+  targetNetwork.Predict(sampledNextStates, nextValues);
+  network.Predict(sampledStates, targets);
+  for (size_t i = 0; i < sampledActions.n_elem; ++i)
+  {
+    double target = sampledRewards[i];
+    if (!sampledTerminal[i])
+      target += discount * nextValues.col(i).max();
+
+    targets(sampledActions[i], i) = target;
+  }
+
+  network.Train(sampledStates, targets, optimizer);
+}
+
+template<typename EnvironmentType,
+         typename NetworkType,
+         typename OptimizerType,
+         typename ReplayType>
+void AsyncLearning<EnvironmentType, NetworkType, OptimizerType, ReplayType>::
+Publish()
+{
+  targetNetwork.Parameters() = network.Parameters();
+
+  std::lock_guard<std::mutex> lock(publishMutex);
+  published = network.Parameters();
+  ++version;
+}
+
+} // namespace rl
+} // namespace mlpack
+
+#endif
@@ -171,6 +171,47 @@ class CartPole
     return Sample(state, action, nextState);
   }
 
+  /**
+   * Dynamics of Cart Pole for a batch of states at once.  Each column of the
+   * states is an encoded state, and the same arithmetic as the single-state
+   * Sample() is applied to whole rows.  nextStates may be the same matrix as
+   * states.
+   *
+   * @param states The current encoded states, one per column.
+   * @param actions The current action of each state.
+   * @param nextStates The next encoded states.
+   * @param rewards The reward of each state; it's always 1.0.
+   */
+  void Sample(const arma::mat& states,
+              const std::vector<Action>& actions,
+              arma::mat& nextStates,
+              arma::colvec& rewards) const
+  {
+    arma::rowvec force(states.n_cols);
+    for (size_t i = 0; i < states.n_cols; ++i)
+      force[i] = actions[i] ? forceMag : -forceMag;
+
+    // Calculate acceleration.
+    const arma::rowvec cosTheta = arma::cos(states.row(2));
+    const arma::rowvec sinTheta = arma::sin(states.row(2));
+    const arma::rowvec temp = (force + poleMassLength * states.row(3) %
+        states.row(3) % sinTheta) / totalMass;
+    const arma::rowvec thetaAcc = (gravity * sinTheta - cosTheta % temp) /
+        (length * (4.0 / 3.0 - massPole * cosTheta % cosTheta / totalMass));
+    const arma::rowvec xAcc = temp - poleMassLength * thetaAcc % cosTheta /
+        totalMass;
+
+    // Update states; each row only depends on rows that haven't been updated
+    // yet, so the states may be updated in place.
+    nextStates.set_size(State::dimension, states.n_cols);
+    nextStates.row(0) = states.row(0) + tau * states.row(1);
+    nextStates.row(1) = states.row(1) + tau * xAcc;
+    nextStates.row(2) = states.row(2) + tau * states.row(3);
+    nextStates.row(3) = states.row(3) + tau * thetaAcc;
+
+    rewards.ones(states.n_cols);
+  }
+
   /**
    * Initial state representation is randomly generated within [-0.05, 0.05].
    *
@@ -193,6 +234,24 @@ class CartPole
         std::abs(state.Angle()) > thetaThresholdRadians;
   }
 
+  /**
+   * Whether each of the given encoded states is a terminal state.
+   *
+   * @param states The encoded states, one per column.
+   * @return 1 for each terminal state, otherwise 0.
+   */
+  arma::icolvec IsTerminal(const arma::mat& states) const
+  {
+    arma::icolvec terminal(states.n_cols);
+    for (size_t i = 0; i < states.n_cols; ++i)
+    {
+      terminal[i] = std::abs(states(0, i)) > xThreshold ||
+          std::abs(states(2, i)) > thetaThresholdRadians;
+    }
+
+    return terminal;
+  }
+
  private:
   //! Locally-stored gravity.
   double gravity;
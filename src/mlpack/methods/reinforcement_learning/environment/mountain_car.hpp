@@ -150,6 +150,47 @@ class MountainCar
     return Sample(state, action, nextState);
   }
 
+  /**
+   * Dynamics of Mountain Car for a batch of states at once.  Each column of the
+   * states is an encoded state, and the same arithmetic as the single-state
+   * Sample() is applied to whole rows.  nextStates may be the same matrix as
+   * states.
+   *
+   * @param states The current encoded states, one per column.
+   * @param actions The current action of each state.
+   * @param nextStates The next encoded states.
+   * @param rewards The reward of each state; it's always -1.0.
+   */
+  void Sample(const arma::mat& states,
+              const std::vector<Action>& actions,
+              arma::mat& nextStates,
+              arma::colvec& rewards) const
+  {
+    arma::rowvec direction(states.n_cols);
+    for (size_t i = 0; i < states.n_cols; ++i)
+      direction[i] = (int) actions[i] - 1;
+
+    // Calculate acceleration.
+    const arma::rowvec velocity = arma::clamp(states.row(0) + 0.001 *
+        direction - 0.0025 * arma::cos(3 * states.row(1)), velocityMin,
+        velocityMax);
+
+    // Update states.
+    nextStates.set_size(State::dimension, states.n_cols);
+    nextStates.row(1) = arma::clamp(states.row(1) + velocity, positionMin,
+        positionMax);
+    nextStates.row(0) = velocity;
+
+    for (size_t i = 0; i < states.n_cols; ++i)
+    {
+      if (std::abs(nextStates(1, i) - positionMin) <= 1e-5)
+        nextStates(0, i) = 0.0;
+    }
+
+    rewards.set_size(states.n_cols);
+    rewards.fill(-1.0);
+  }
+
   /**
    * Initial position is randomly generated within [-0.6, -0.4].
    * Initial velocity is 0.
@@ -175,6 +216,21 @@ class MountainCar
     return std::abs(state.Position() - positionMax) <= 1e-5;
   }
 
+  /**
+   * Whether each of the given encoded states is a terminal state.
+   *
+   * @param states The encoded states, one per column.
+   * @return 1 for each terminal state, otherwise 0.
+   */
+  arma::icolvec IsTerminal(const arma::mat& states) const
+  {
+    arma::icolvec terminal(states.n_cols);
+    for (size_t i = 0; i < states.n_cols; ++i)
+      terminal[i] = std::abs(states(1, i) - positionMax) <= 1e-5;
+
+    return terminal;
+  }
+
  private:
   //! Locally-stored minimum legal position.
   double positionMin;
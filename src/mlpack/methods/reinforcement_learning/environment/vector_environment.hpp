@@ -0,0 +1,135 @@
+/**
+ * @file vector_environment.hpp
+ *
+ * A batch of independent copies of an environment, whose states are held in
+ * one matrix and stepped together.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_RL_ENVIRONMENT_VECTOR_ENVIRONMENT_HPP
+#define MLPACK_METHODS_RL_ENVIRONMENT_VECTOR_ENVIRONMENT_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace rl {
+
+/**
+ * A vectorized environment runs a number of independent episodes (lanes) of
+ * the same task at once.  The encoded states of all the lanes are held in the
+ * columns of one matrix, so they can be given directly to a network as a
+ * batch, and they are all stepped with one call to the batched Sample() of the
+ * environment.  When the episode of a lane ends, that lane alone is started
+ * again from a new initial state.
+ *
+ * @code
+ * VectorEnvironment<CartPole> env(64);
+ * std::vector<CartPole::Action> actions(env.NumEnvironments());
+ * arma::mat actionValues, nextStates;
+ * arma::colvec rewards;
+ * arma::icolvec terminal;
+ * for (size_t step = 0; step < 1000; ++step)
+ * {
+ *   network.Predict(env.States(), actionValues);
+ *   for (size_t i = 0; i < actions.size(); ++i)
+ *     actions[i] = policy.Sample(actionValues.col(i));
+ *
+ *   env.Step(actions, nextStates, rewards, terminal);
+ * }
+ * @endcode
+ *
+ * @tparam EnvironmentType The task; it must provide the batched Sample() and
+ *     IsTerminal() of CartPole and MountainCar.
+ */
+template<typename EnvironmentType>
+class VectorEnvironment
+{
+ public:
+  using ActionType = typename EnvironmentType::Action;
+  using StateType = typename EnvironmentType::State;
+
+  /**
+   * Create the given number of lanes, each in a new initial state.
+   *
+   * @param numEnvironments Number of lanes.
+   * @param environment The task to run in every lane.
+   */
+  VectorEnvironment(const size_t numEnvironments,
+                    const EnvironmentType& environment = EnvironmentType()) :
+      environment(environment),
+      states(StateType::dimension, numEnvironments)
+  {
+    Reset();
+  }
+
+  /**
+   * Start a new episode in every lane.
+   */
+  void Reset()
+  {
+    for (size_t i = 0; i < states.n_cols; ++i)
+      states.col(i) = environment.InitialSample().Encode();
+  }
+
+  /**
+   * Take one action in every lane.  The lanes whose next state is terminal
+   * are then started again, so States() holds the states to act from at the
+   * next step, while nextStates holds the states the actions led to (as they
+   * should be stored in a replay buffer).
+   *
+   * @param actions The action of each lane.
+   * @param nextStates The encoded states the actions led to, one per column.
+   * @param rewards The reward of each lane.
+   * @param terminal 1 for each lane whose episode ended, otherwise 0.
+   */
+  void Step(const std::vector<ActionType>& actions,
+            arma::mat& nextStates,
+            arma::colvec& rewards,
+            arma::icolvec& terminal)
+  {
+    if (actions.size() != states.n_cols)
+    {
+      std::ostringstream oss;
+      oss << "VectorEnvironment::Step(): number of actions (" << actions.size()
+          << ") doesn't match the number of environments (" << states.n_cols
+          << ")";
+      throw std::invalid_argument(oss.str());
+    }
+
+    environment.Sample(states, actions, nextStates, rewards);
+    terminal = environment.IsTerminal(nextStates);
+
+    states = nextStates;
+    for (size_t i = 0; i < states.n_cols; ++i)
+    {
+      if (terminal[i])
+        states.col(i) = environment.InitialSample().Encode();
+    }
+  }
+
+  //! Get the number of lanes.
+  size_t NumEnvironments() const { return states.n_cols; }
+
+  //! Get the encoded state of each lane, one per column.
+  const arma::mat& States() const { return states; }
+  //! Modify the encoded state of each lane.
+  arma::mat& States() { return states; }
+
+  //! Get the task.
+  const EnvironmentType& Environment() const { return environment; }
+
+ private:
+  //! Locally-stored task.
+  EnvironmentType environment;
+
+  //! Locally-stored encoded state of each lane.
+  arma::mat states;
+};
+
+} // namespace rl
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,242 @@
+/**
+ * @file concurrent_replay.hpp
+ *
+ * This file is an implementation of random experience replay that many
+ * threads can store experiences into and sample from at once.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_RL_REPLAY_CONCURRENT_REPLAY_HPP
+#define MLPACK_METHODS_RL_REPLAY_CONCURRENT_REPLAY_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/math/random.hpp>
+#include <atomic>
+#include <thread>
+
+namespace mlpack {
+namespace rl {
+
+/**
+ * Implementation of random experience replay for many threads.
+ *
+ * Like RandomReplay, the experiences are kept in a First-In-First-Out ring
+ * buffer and sampled uniformly, but any number of threads may call Store() and
+ * Sample() at once, without locks.  Store() claims the next position with an
+ * atomic increment of the write cursor, and each slot has a sequence number
+ * used as a seqlock: it is odd while the slot is written and even otherwise,
+ * and it grows with each write.  A writer first waits for the writer of the
+ * same slot one lap before (which only happens when the buffer is much
+ * smaller than the number of producers), then makes the sequence number odd,
+ * writes the experience and makes it even again.  Sample() copies a slot and
+ * keeps the copy only if the sequence number of the slot was the same even
+ * number before and after the copy; otherwise it draws another slot.  The
+ * slots are drawn from the random stream given to Sample(), so each sampling
+ * thread should give its own stream (such as RandomStream(seed, index)).
+ *
+ * @tparam EnvironmentType Desired task.
+ */
+template <typename EnvironmentType>
+class ConcurrentReplay
+{
+ public:
+  using ActionType = typename EnvironmentType::Action;
+  using StateType = typename EnvironmentType::State;
+
+  /**
+   * Construct an instance of concurrent experience replay class.
+   *
+   * @param batchSize Number of examples returned at each sample.
+   * @param capacity Total memory size in terms of number of examples.
+   * @param dimension The dimension of an encoded state.
+   */
+  ConcurrentReplay(const size_t batchSize,
+                   const size_t capacity,
+                   const size_t dimension = StateType::dimension) :
+      batchSize(batchSize),
+      capacity(capacity),
+      cursor(0),
+      sequences(capacity),
+      states(dimension, capacity),
+      actions(capacity),
+      rewards(capacity),
+      nextStates(dimension, capacity),
+      isTerminal(capacity)
+  {
+    for (size_t i = 0; i < capacity; ++i)
+      sequences[i].store(0, std::memory_order_relaxed);
+  }
+
+  /**
+   * Store the given experience; this may be called from any thread.
+   *
+   * @param state Given state.
+   * @param action Given action.
+   * @param reward Given reward.
+   * @param nextState Given next state.
+   * @param isEnd Whether next state is terminal state.
+   */
+  void Store(const StateType& state,
+             ActionType action,
+             double reward,
+             const StateType& nextState,
+             bool isEnd)
+  {
+    const size_t position = cursor.fetch_add(1, std::memory_order_relaxed);
+    const size_t slot = position % capacity;
+    const size_t lap = position / capacity;
+
+    // Wait for the write of the previous lap to this slot to finish.
+    std::atomic<size_t>& sequence = sequences[slot];
+    while (sequence.load(std::memory_order_acquire) != 2 * lap)
+      std::this_thread::yield();
+
+    sequence.store(2 * lap + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    states.col(slot) = state.Encode();
+    actions[slot] = action;
+    rewards[slot] = reward;
+    nextStates.col(slot) = nextState.Encode();
+    isTerminal[slot] = isEnd;
+
+    sequence.store(2 * lap + 2, std::memory_order_release);
+  }
+
+  /**
+   * Sample some experiences; this may be called from any thread, even while
+   * other threads store experiences.  Each sampled experience is one that was
+   * completely stored.
+   *
+   * The experiences are copied into the given objects, which are only resized
+   * when they don't have the right size, so nothing is allocated when the same
+   * objects are given at each call.
+   *
+   * The slots are drawn from the given random stream, which must not be used
+   * by another thread at the same time.
+   *
+   * @param sampledStates Sampled encoded states.
+   * @param sampledActions Sampled actions.
+   * @param sampledRewards Sampled rewards.
+   * @param sampledNextStates Sampled encoded next states.
+   * @param isTerminal Indicate whether corresponding next state is terminal
+   *     state.
+   * @param stream Random stream to draw the slots from.
+   */
+  void Sample(arma::mat& sampledStates,
+              arma::icolvec& sampledActions,
+              arma::colvec& sampledRewards,
+              arma::mat& sampledNextStates,
+              arma::icolvec& isTerminal,
+              math::RandomStream& stream)
+  {
+    sampledStates.set_size(states.n_rows, batchSize);
+    sampledActions.set_size(batchSize);
+    sampledRewards.set_size(batchSize);
+    sampledNextStates.set_size(nextStates.n_rows, batchSize);
+    isTerminal.set_size(batchSize);
+
+    for (size_t i = 0; i < batchSize; ++i)
+    {
+      while (true)
+      {
+        const size_t upperBound = Size();
+        if (upperBound == 0)
+        {
+          std::this_thread::yield();
+          continue;
+        }
+
+        const size_t slot = std::min((size_t) (stream.Random() * upperBound),
+            upperBound - 1);
+        const size_t before =
+            sequences[slot].load(std::memory_order_acquire);
+        if (before == 0 || before % 2 == 1)
+          continue;
+
+        sampledStates.col(i) = states.col(slot);
+        sampledActions[i] = actions[slot];
+        sampledRewards[i] = rewards[slot];
+        sampledNextStates.col(i) = nextStates.col(slot);
+        isTerminal[i] = this->isTerminal[slot];
+
+        // The copy is consistent if no writer touched the slot meanwhile.
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequences[slot].load(std::memory_order_relaxed) == before)
+          break;
+      }
+    }
+  }
+
+  /**
+   * Sample some experiences, drawing the slots from the random stream of the
+   * calling thread (see math::ThreadRandomStream()); this has the interface of
+   * RandomReplay::Sample().  The numbers drawn by threads not created by
+   * OpenMP aren't reproducible, so these threads should give a stream of
+   * their own instead.
+   *
+   * @param sampledStates Sampled encoded states.
+   * @param sampledActions Sampled actions.
+   * @param sampledRewards Sampled rewards.
+   * @param sampledNextStates Sampled encoded next states.
+   * @param isTerminal Indicate whether corresponding next state is terminal
+   *     state.
+   */
+  void Sample(arma::mat& sampledStates,
+              arma::icolvec& sampledActions,
+              arma::colvec& sampledRewards,
+              arma::mat& sampledNextStates,
+              arma::icolvec& isTerminal)
+  {
+    Sample(sampledStates, sampledActions, sampledRewards, sampledNextStates,
+        isTerminal, math::ThreadRandomStream());
+  }
+
+  /**
+   * Get the number of transitions in the memory, including those that are
+   * still being stored.
+   *
+   * @return Actual used memory size
+   */
+  size_t Size() const
+  {
+    return std::min(cursor.load(std::memory_order_relaxed), capacity);
+  }
+
+ private:
+  //! Locally-stored number of examples of each sample.
+  size_t batchSize;
+
+  //! Locally-stored total memory limit.
+  size_t capacity;
+
+  //! The number of positions claimed by Store() so far.
+  std::atomic<size_t> cursor;
+
+  //! The seqlock sequence number of each slot.
+  std::vector<std::atomic<size_t>> sequences;
+
+  //! Locally-stored encoded previous states.
+  arma::mat states;
+
+  //! Locally-stored previous actions.
+  std::vector<ActionType> actions;
+
+  //! Locally-stored previous rewards.
+  arma::colvec rewards;
+
+  //! Locally-stored encoded previous next states.
+  arma::mat nextStates;
+
+  //! Locally-stored termination information of previous experience (not
+  //! std::vector<bool>, whose neighbouring elements share bytes).
+  std::vector<char> isTerminal;
+};
+
+} // namespace rl
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,261 @@
+/**
+ * @file prioritized_replay.hpp
+ *
+ * This file is an implementation of prioritized experience replay.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_RL_REPLAY_PRIORITIZED_REPLAY_HPP
+#define MLPACK_METHODS_RL_REPLAY_PRIORITIZED_REPLAY_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/math/random.hpp>
+#include "sum_tree.hpp"
+
+namespace mlpack {
+namespace rl {
+
+/**
+ * Implementation of prioritized experience replay.
+ *
+ * Like RandomReplay, the experiences are kept in a First-In-First-Out buffer,
+ * but each experience is sampled with probability proportional to its
+ * priority, p_i^alpha, where the priority is usually the absolute TD error of
+ * the experience when it was last used for training.  New experiences get the
+ * largest priority seen so far, so that each is sampled at least once.  The
+ * priorities are held in a SumTree, so that sampling and updating a priority
+ * take O(log N) time.  Since the experiences aren't sampled uniformly, each
+ * sampled experience also gets an importance-sampling weight,
+ * (N P(i))^-beta, divided by the largest weight of the sample, to scale its
+ * update.
+ *
+ * For more information, see the following.
+ *
+ * @code
+ * @inproceedings{schaul2016prioritized,
+ *  title     = {Prioritized Experience Replay},
+ *  author    = {Schaul, Tom and Quan, John and Antonoglou, Ioannis and
+ *               Silver, David},
+ *  booktitle = {International Conference on Learning Representations},
+ *  year      = {2016}
+ * }
+ * @endcode
+ *
+ * @tparam EnvironmentType Desired task.
+ */
+template <typename EnvironmentType>
+class PrioritizedReplay
+{
+ public:
+  using ActionType = typename EnvironmentType::Action;
+  using StateType = typename EnvironmentType::State;
+
+  /**
+   * Construct an instance of prioritized experience replay class.
+   *
+   * @param batchSize Number of examples returned at each sample.
+   * @param capacity Total memory size in terms of number of examples.
+   * @param alpha How much prioritization is used (0 is uniform sampling).
+   * @param beta How much the importance-sampling weights correct for the
+   *     prioritization (1 is full correction).
+   * @param dimension The dimension of an encoded state.
+   */
+  PrioritizedReplay(const size_t batchSize,
+                    const size_t capacity,
+                    const double alpha = 0.6,
+                    const double beta = 0.4,
+                    const size_t dimension = StateType::dimension) :
+      batchSize(batchSize),
+      capacity(capacity),
+      alpha(alpha),
+      beta(beta),
+      epsilon(1e-6),
+      maxPriority(1.0),
+      position(0),
+      states(dimension, capacity),
+      actions(capacity),
+      rewards(capacity),
+      nextStates(dimension, capacity),
+      isTerminal(capacity),
+      full(false),
+      priorities(capacity)
+  { /* Nothing to do here. */ }
+
+  /**
+   * Store the given experience, with the largest priority seen so far.
+   *
+   * @param state Given state.
+   * @param action Given action.
+   * @param reward Given reward.
+   * @param nextState Given next state.
+   * @param isEnd Whether next state is terminal state.
+   */
+  void Store(const StateType& state,
+             ActionType action,
+             double reward,
+             const StateType& nextState,
+             bool isEnd)
+  {
+    states.col(position) = state.Encode();
+    actions(position) = action;
+    rewards(position) = reward;
+    nextStates.col(position) = nextState.Encode();
+    isTerminal(position) = isEnd;
+    priorities.Set(position, std::pow(maxPriority, alpha));
+    position++;
+    if (position == capacity)
+    {
+      full = true;
+      position = 0;
+    }
+  }
+
+  /**
+   * Sample some experiences in proportion to their priorities.  The range of
+   * priorities is split into batchSize equal segments and one experience is
+   * drawn from each, so that the sample spreads over the whole range.
+   *
+   * The experiences are copied into the given objects, which are only resized
+   * when they don't have the right size, so nothing is allocated when the same
+   * objects are given at each call.
+   *
+   * @param sampledStates Sampled encoded states.
+   * @param sampledActions Sampled actions.
+   * @param sampledRewards Sampled rewards.
+   * @param sampledNextStates Sampled encoded next states.
+   * @param isTerminal Indicate whether corresponding next state is terminal
+   *     state.
+   * @param sampledIndices Indices of the sampled experiences, to be given to
+   *     UpdatePriorities().
+   * @param weights Importance-sampling weight of each sampled experience.
+   */
+  void Sample(arma::mat& sampledStates,
+              arma::icolvec& sampledActions,
+              arma::colvec& sampledRewards,
+              arma::mat& sampledNextStates,
+              arma::icolvec& isTerminal,
+              arma::Col<size_t>& sampledIndices,
+              arma::colvec& weights)
+  {
+    const size_t upperBound = full ? capacity : position;
+    const double total = priorities.Sum();
+    const double segment = total / batchSize;
+
+    sampledStates.set_size(states.n_rows, batchSize);
+    sampledActions.set_size(batchSize);
+    sampledRewards.set_size(batchSize);
+    sampledNextStates.set_size(nextStates.n_rows, batchSize);
+    isTerminal.set_size(batchSize);
+    sampledIndices.set_size(batchSize);
+    weights.set_size(batchSize);
+
+    double maxWeight = 0.0;
+    for (size_t i = 0; i < batchSize; ++i)
+    {
+      const size_t index = priorities.Find(math::Random(i * segment,
+          (i + 1) * segment));
+      sampledIndices[i] = index;
+      sampledStates.col(i) = states.col(index);
+      sampledActions[i] = actions[index];
+      sampledRewards[i] = rewards[index];
+      sampledNextStates.col(i) = nextStates.col(index);
+      isTerminal[i] = this->isTerminal[index];
+
+      // (N P(i))^-beta, with P(i) = p_i / total.
+      weights[i] = std::pow(upperBound * priorities.Get(index) / total, -beta);
+      maxWeight = std::max(maxWeight, weights[i]);
+    }
+
+    weights /= maxWeight;
+  }
+
+  /**
+   * Set the priorities of the given experiences from their new absolute TD
+   * errors, usually those of the last sample.
+   *
+   * @param indices Indices of the experiences, as given by Sample().
+   * @param tdErrors TD error of each experience.
+   */
+  void UpdatePriorities(const arma::Col<size_t>& indices,
+                        const arma::colvec& tdErrors)
+  {
+    for (size_t i = 0; i < indices.n_elem; ++i)
+    {
+      // A small constant keeps every experience possible to sample.
+      const double priority = std::abs(tdErrors[i]) + epsilon;
+      maxPriority = std::max(maxPriority, priority);
+      priorities.Set(indices[i], std::pow(priority, alpha));
+    }
+  }
+
+  /**
+   * Get the number of transitions in the memory.
+   *
+   * @return Actual used memory size
+   */
+  const size_t& Size()
+  {
+    return full ? capacity : position;
+  }
+
+  //! Get how much prioritization is used.
+  double Alpha() const { return alpha; }
+
+  //! Get how much the importance-sampling weights correct for the
+  //! prioritization.
+  double Beta() const { return beta; }
+  //! Modify how much the importance-sampling weights correct for the
+  //! prioritization; it is usually annealed to 1 during training.
+  double& Beta() { return beta; }
+
+ private:
+  //! Locally-stored number of examples of each sample.
+  size_t batchSize;
+
+  //! Locally-stored total memory limit.
+  size_t capacity;
+
+  //! Locally-stored exponent of the priorities.
+  double alpha;
+
+  //! Locally-stored exponent of the importance-sampling weights.
+  double beta;
+
+  //! Locally-stored constant added to each absolute TD error.
+  double epsilon;
+
+  //! Locally-stored largest priority seen so far.
+  double maxPriority;
+
+  //! Indicate the position to store new transition.
+  size_t position;
+
+  //! Locally-stored encoded previous states.
+  arma::mat states;
+
+  //! Locally-stored previous actions.
+  arma::icolvec actions;
+
+  //! Locally-stored previous rewards.
+  arma::colvec rewards;
+
+  //! Locally-stored encoded previous next states.
+  arma::mat nextStates;
+
+  //! Locally-stored termination information of previous experience.
+  arma::icolvec isTerminal;
+
+  //! Locally-stored indicator that whether the memory is full or not
+  bool full;
+
+  //! Locally-stored priorities (to the power alpha) of the experiences.
+  SumTree priorities;
+};
+
+} // namespace rl
+} // namespace mlpack
+
+#endif
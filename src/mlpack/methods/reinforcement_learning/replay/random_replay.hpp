@@ -13,6 +13,7 @@
 #define MLPACK_METHODS_RL_REPLAY_RANDOM_REPLAY_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <mlpack/core/math/random.hpp>
 
 namespace mlpack {
 namespace rl {
@@ -103,6 +104,10 @@ class RandomReplay
    * @param sampledRewards Sampled rewards.
    * @param sampledNextStates Sampled encoded next states.
    * @param isTerminal Indicate whether corresponding next state is terminal state.
+   *
+   * The experiences are copied into the given objects, which are only resized
+   * when they don't have the right size, so nothing is allocated when the same
+   * objects are given at each call.
    */
   void Sample(arma::mat& sampledStates,
               arma::icolvec& sampledActions,
@@ -110,15 +115,23 @@ class RandomReplay
               arma::mat& sampledNextStates,
               arma::icolvec& isTerminal)
   {
-    size_t upperBound = full ? capacity : position;
-    arma::uvec sampledIndices = arma::randi<arma::uvec>(
-        batchSize, arma::distr_param(0, upperBound - 1));
-
-    sampledStates = states.cols(sampledIndices);
-    sampledActions = actions.elem(sampledIndices);
-    sampledRewards = rewards.elem(sampledIndices);
-    sampledNextStates = nextStates.cols(sampledIndices);
-    isTerminal = this->isTerminal.elem(sampledIndices);
+    const size_t upperBound = full ? capacity : position;
+
+    sampledStates.set_size(states.n_rows, batchSize);
+    sampledActions.set_size(batchSize);
+    sampledRewards.set_size(batchSize);
+    sampledNextStates.set_size(nextStates.n_rows, batchSize);
+    isTerminal.set_size(batchSize);
+
+    for (size_t i = 0; i < batchSize; ++i)
+    {
+      const size_t index = math::RandInt(upperBound);
+      sampledStates.col(i) = states.col(index);
+      sampledActions[i] = actions[index];
+      sampledRewards[i] = rewards[index];
+      sampledNextStates.col(i) = nextStates.col(index);
+      isTerminal[i] = this->isTerminal[index];
+    }
   }
 
   /**
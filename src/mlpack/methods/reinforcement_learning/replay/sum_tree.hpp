@@ -0,0 +1,113 @@
+/**
+ * @file sum_tree.hpp
+ *
+ * An array-backed binary tree of sums, for sampling indices in proportion to
+ * their values.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_RL_REPLAY_SUM_TREE_HPP
+#define MLPACK_METHODS_RL_REPLAY_SUM_TREE_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace rl {
+
+/**
+ * A sum tree holds a nonnegative value for each of a fixed number of indices,
+ * and keeps the sum of the values of every subtree, so that a value can be
+ * changed, and an index can be found from a prefix sum of the values, in
+ * O(log n) time.  The tree is stored in one array: node i has children 2i and
+ * 2i + 1, the root is node 1, and the leaves are the last half of the array.
+ */
+class SumTree
+{
+ public:
+  /**
+   * Create a tree for the given number of indices, whose values are all 0.
+   *
+   * @param size Number of indices.
+   */
+  SumTree(const size_t size = 0) : size(size), leaves(1)
+  {
+    while (leaves < size)
+      leaves *= 2;
+
+    tree.zeros(2 * leaves);
+  }
+
+  /**
+   * Set the value of the given index, and update the sums of the subtrees that
+   * hold it.
+   *
+   * @param index Index to set the value of.
+   * @param value Nonnegative value.
+   */
+  void Set(const size_t index, const double value)
+  {
+    // The sums are recomputed rather than adjusted by the difference, so
+    // rounding errors don't accumulate over many updates.
+    size_t node = index + leaves;
+    tree[node] = value;
+    while (node > 1)
+    {
+      node /= 2;
+      tree[node] = tree[2 * node] + tree[2 * node + 1];
+    }
+  }
+
+  //! Get the value of the given index.
+  double Get(const size_t index) const { return tree[index + leaves]; }
+
+  //! Get the sum of all the values.
+  double Sum() const { return tree[1]; }
+
+  //! Get the number of indices.
+  size_t Size() const { return size; }
+
+  /**
+   * Find the first index whose prefix sum (the sum of its value and the values
+   * of all the indices before it) exceeds the given value.  If the value is at
+   * least Sum() (which can happen through rounding), the last index with a
+   * nonzero value is returned.
+   *
+   * @param value Value in [0, Sum()).
+   * @return Index whose value interval holds the given value.
+   */
+  size_t Find(double value) const
+  {
+    size_t node = 1;
+    while (node < leaves)
+    {
+      const size_t left = 2 * node;
+      if (value < tree[left] || tree[left + 1] == 0.0)
+      {
+        node = left;
+      }
+      else
+      {
+        value -= tree[left];
+        node = left + 1;
+      }
+    }
+
+    return node - leaves;
+  }
+
+ private:
+  //! The number of indices.
+  size_t size;
+  //! The number of leaves: the smallest power of two that is at least size.
+  size_t leaves;
+  //! The sums of the subtrees of each node; the values are the leaves.
+  arma::vec tree;
+};
+
+} // namespace rl
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,193 @@
+/**
+ * @file transition_queue.hpp
+ *
+ * A bounded, lock-free queue of transitions, filled by many threads and
+ * emptied by one.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_RL_REPLAY_TRANSITION_QUEUE_HPP
+#define MLPACK_METHODS_RL_REPLAY_TRANSITION_QUEUE_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <atomic>
+
+namespace mlpack {
+namespace rl {
+
+/**
+ * A TransitionQueue passes transitions (state, action, reward, next state and
+ * whether the next state is terminal) from any number of producer threads to
+ * one consumer thread, without locks.  It is a ring of slots, each with a
+ * sequence number that tells whether the slot is free for the producer of a
+ * given position or holds the transition of a given position for the
+ * consumer: producers claim positions with a compare-and-swap of the tail,
+ * and the consumer, alone, reads the head.  The transitions are stored in
+ * preallocated matrices, so pushing and popping don't allocate.
+ *
+ * @tparam EnvironmentType The task whose transitions are queued.
+ */
+template<typename EnvironmentType>
+class TransitionQueue
+{
+ public:
+  using ActionType = typename EnvironmentType::Action;
+  using StateType = typename EnvironmentType::State;
+
+  /**
+   * Create an empty queue.
+   *
+   * @param capacity Maximum number of transitions held at once; it is rounded
+   *     up to a power of two.
+   * @param dimension The dimension of an encoded state.
+   */
+  TransitionQueue(const size_t capacity,
+                  const size_t dimension = StateType::dimension) :
+      mask(RoundCapacity(capacity) - 1),
+      sequences(mask + 1),
+      states(dimension, mask + 1),
+      actions(mask + 1),
+      rewards(mask + 1),
+      nextStates(dimension, mask + 1),
+      isTerminal(mask + 1),
+      tail(0),
+      head(0)
+  {
+    for (size_t i = 0; i <= mask; ++i)
+      sequences[i].store(i, std::memory_order_relaxed);
+  }
+
+  /**
+   * Add a transition to the queue; this may be called from any thread.
+   *
+   * @param state Given state.
+   * @param action Given action.
+   * @param reward Given reward.
+   * @param nextState Given next state.
+   * @param isEnd Whether next state is terminal state.
+   * @return false if the queue was full (the transition wasn't added).
+   */
+  bool Push(const StateType& state,
+            const ActionType action,
+            const double reward,
+            const StateType& nextState,
+            const bool isEnd)
+  {
+    size_t position = tail.load(std::memory_order_relaxed);
+    while (true)
+    {
+      const size_t sequence =
+          sequences[position & mask].load(std::memory_order_acquire);
+      if (sequence == position)
+      {
+        // The slot is free; claim it, unless another producer did first (then
+        // position holds the new tail).
+        if (tail.compare_exchange_weak(position, position + 1,
+            std::memory_order_relaxed))
+          break;
+      }
+      else if (sequence < position)
+      {
+        // The slot still holds the transition of the previous lap.
+        return false;
+      }
+      else
+      {
+        position = tail.load(std::memory_order_relaxed);
+      }
+    }
+
+    const size_t slot = position & mask;
+    states.col(slot) = state.Encode();
+    actions[slot] = action;
+    rewards[slot] = reward;
+    nextStates.col(slot) = nextState.Encode();
+    isTerminal[slot] = isEnd;
+
+    // Hand the slot to the consumer.
+    sequences[slot].store(position + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * Take the oldest transition from the queue; this must only be called from
+   * one thread at a time.
+   *
+   * @param state The state of the transition.
+   * @param action The action of the transition.
+   * @param reward The reward of the transition.
+   * @param nextState The next state of the transition.
+   * @param isEnd Whether the next state is a terminal state.
+   * @return false if the queue was empty.
+   */
+  bool Pop(StateType& state,
+           ActionType& action,
+           double& reward,
+           StateType& nextState,
+           bool& isEnd)
+  {
+    const size_t slot = head & mask;
+    if (sequences[slot].load(std::memory_order_acquire) != head + 1)
+      return false;
+
+    state.Data() = states.col(slot);
+    action = actions[slot];
+    reward = rewards[slot];
+    nextState.Data() = nextStates.col(slot);
+    isEnd = isTerminal[slot];
+
+    // Free the slot for the producer of the next lap.
+    sequences[slot].store(head + mask + 1, std::memory_order_release);
+    ++head;
+    return true;
+  }
+
+  //! Get the maximum number of transitions held at once.
+  size_t Capacity() const { return mask + 1; }
+
+ private:
+  //! Round the capacity up to a power of two.
+  static size_t RoundCapacity(const size_t capacity)
+  {
+    size_t rounded = 1;
+    while (rounded < capacity)
+      rounded *= 2;
+    return rounded;
+  }
+
+  //! The capacity minus one, to find the slot of a position.
+  size_t mask;
+
+  //! The sequence number of each slot.
+  std::vector<std::atomic<size_t>> sequences;
+
+  //! Locally-stored encoded states.
+  arma::mat states;
+
+  //! Locally-stored actions.
+  std::vector<ActionType> actions;
+
+  //! Locally-stored rewards.
+  arma::colvec rewards;
+
+  //! Locally-stored encoded next states.
+  arma::mat nextStates;
+
+  //! Locally-stored termination information (not std::vector<bool>, whose
+  //! neighbouring elements share bytes, which producers can't write at once).
+  std::vector<char> isTerminal;
+
+  //! The next position to be claimed by a producer.
+  std::atomic<size_t> tail;
+
+  //! The next position to be read by the consumer.
+  size_t head;
+};
+
+} // namespace rl
+} // namespace mlpack
+
+#endif
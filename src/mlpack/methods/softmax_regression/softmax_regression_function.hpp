@@ -18,6 +18,21 @@
 namespace mlpack {
 namespace regression {
 
+/**
+ * The objective function of softmax regression.  The data may be dense or
+ * sparse: with arma::sp_mat as MatType, the products with the data take time
+ * linear in its number of nonzero values, and the gradient of a single point
+ * can be computed as a sparse matrix (for optimizers such as HogwildSGD, or
+ * SGD with a sparse gradient type).
+ *
+ * The objective and its gradient are computed one block of points at a time
+ * (in parallel when OpenMP is available), so only the class probabilities of
+ * one block per thread are held at once, and the labels are used directly
+ * instead of a ground truth matrix.
+ *
+ * @tparam MatType Type of data matrix.
+ */
+template<typename MatType = arma::mat>
 class SoftmaxRegressionFunction
 {
  public:
@@ -32,7 +47,7 @@ class SoftmaxRegressionFunction
    * @param lambda L2-regularization constant.
    * @param fitIntercept Intercept term flag.
    */
-  SoftmaxRegressionFunction(const arma::mat& data,
+  SoftmaxRegressionFunction(const MatType& data,
                             const arma::Row<size_t>& labels,
                             const size_t numClasses,
                             const double lambda = 0.0001,
@@ -89,6 +104,20 @@ class SoftmaxRegressionFunction
   void GetProbabilitiesMatrix(const arma::mat& parameters,
                               arma::mat& probabilities) const;
 
+  /**
+   * Evaluate the probabilities matrix of the points [begin, begin + batchSize)
+   * with the passed parameters.
+   *
+   * @param parameters Current values of the model parameters.
+   * @param probabilities Pointer to arma::mat which stores the probabilities.
+   * @param begin Index of the first point of the batch.
+   * @param batchSize Number of points of the batch.
+   */
+  void GetProbabilitiesMatrix(const arma::mat& parameters,
+                              arma::mat& probabilities,
+                              const size_t begin,
+                              const size_t batchSize) const;
+
   /**
    * Evaluates the objective function of the softmax regression model using the
    * given parameters. The cost function has terms for the log likelihood error
@@ -100,6 +129,32 @@ class SoftmaxRegressionFunction
    */
   double Evaluate(const arma::mat& parameters) const;
 
+  /**
+   * Evaluates the objective function of the softmax regression model on the
+   * points [begin, begin + batchSize), with their share of the regularization
+   * cost, so that the objectives of all the batches sum to Evaluate().  This is
+   * used by the SGD-family optimizers.
+   *
+   * @param parameters Current values of the model parameters.
+   * @param begin Index of the first point of the batch.
+   * @param batchSize Number of points of the batch.
+   */
+  double Evaluate(const arma::mat& parameters,
+                  const size_t begin,
+                  const size_t batchSize) const;
+
+  /**
+   * Evaluates the objective function of the softmax regression model on the
+   * given point, with its share of the regularization cost.
+   *
+   * @param parameters Current values of the model parameters.
+   * @param i Index of the point.
+   */
+  double Evaluate(const arma::mat& parameters, const size_t i) const
+  {
+    return Evaluate(parameters, i, 1);
+  }
+
   /**
    * Evaluates the gradient values of the objective function given the current
    * set of parameters. The function calculates the probabilities for each class
@@ -111,6 +166,70 @@ class SoftmaxRegressionFunction
    */
   void Gradient(const arma::mat& parameters, arma::mat& gradient) const;
 
+  /**
+   * Evaluates the gradient of the objective function of the points
+   * [begin, begin + batchSize), with their share of the regularization.
+   *
+   * @param parameters Current values of the model parameters.
+   * @param begin Index of the first point of the batch.
+   * @param gradient Matrix where gradient values will be stored.
+   * @param batchSize Number of points of the batch.
+   */
+  void Gradient(const arma::mat& parameters,
+                const size_t begin,
+                arma::mat& gradient,
+                const size_t batchSize) const;
+
+  /**
+   * Evaluates the objective function and its gradient on the points
+   * [begin, begin + batchSize), with their share of the regularization, and
+   * computes the class probabilities of the points only once.
+   *
+   * @param parameters Current values of the model parameters.
+   * @param begin Index of the first point of the batch.
+   * @param gradient Matrix where gradient values will be stored.
+   * @param batchSize Number of points of the batch.
+   * @return Objective function of the batch.
+   */
+  double EvaluateWithGradient(const arma::mat& parameters,
+                              const size_t begin,
+                              arma::mat& gradient,
+                              const size_t batchSize) const;
+
+  /**
+   * Evaluates the gradient of the objective function of the given point, with
+   * its share of the regularization.
+   *
+   * @param parameters Current values of the model parameters.
+   * @param i Index of the point.
+   * @param gradient Matrix where gradient values will be stored.
+   */
+  void Gradient(const arma::mat& parameters,
+                const size_t i,
+                arma::mat& gradient) const
+  {
+    Gradient(parameters, i, gradient, 1);
+  }
+
+  /**
+   * Evaluates the gradient of the objective function of the given point as a
+   * sparse matrix, which is nonzero only in the columns of the intercept and
+   * of the nonzero features of the point; it takes O(numClasses * nnz) time.
+   * The regularization is only applied to the parameters of those columns, so
+   * this is not the same as the dense gradient of the point unless lambda is
+   * 0.
+   *
+   * @param parameters Current values of the model parameters.
+   * @param i Index of the point.
+   * @param gradient Sparse matrix where gradient values will be stored.
+   */
+  void Gradient(const arma::mat& parameters,
+                const size_t i,
+                arma::sp_mat& gradient) const;
+
+  //! Return the number of separable functions (the number of points).
+  size_t NumFunctions() const { return data.n_cols; }
+
   //! Return the initial point for the optimization.
   const arma::mat& GetInitialPoint() const { return initialPoint; }
 
@@ -134,9 +253,9 @@ class SoftmaxRegressionFunction
 
  private:
   //! Training data matrix.
-  const arma::mat& data;
-  //! Label matrix for the provided data.
-  arma::sp_mat groundTruth;
+  const MatType& data;
+  //! Labels of the training data.
+  arma::Row<size_t> labels;
   //! Initial parameter point.
   arma::mat initialPoint;
   //! Number of classes.
@@ -145,9 +264,23 @@ class SoftmaxRegressionFunction
   double lambda;
   //! Intercept term flag.
   bool fitIntercept;
+
+  /**
+   * Compute the negative log likelihood of the points
+   * [begin, begin + batchSize), without regularization, by blocks of points.
+   * If gradient isn't NULL, the gradient of the negative log likelihood is
+   * stored into it.
+   */
+  double EvaluateBlocks(const arma::mat& parameters,
+                        const size_t begin,
+                        const size_t batchSize,
+                        arma::mat* gradient) const;
 };
 
 } // namespace regression
 } // namespace mlpack
 
+// Include implementation.
+#include "softmax_regression_function_impl.hpp"
+
 #endif
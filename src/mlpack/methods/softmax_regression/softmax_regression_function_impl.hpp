@@ -0,0 +1,455 @@
+/**
+ * @file softmax_regression_function_impl.hpp
+ * @author Siddharth Agrawal
+ *
+ * Implementation of function to be optimized for softmax regression.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_SOFTMAX_REGRESSION_SOFTMAX_REGRESSION_FUNCTION_IMPL_HPP
+#define MLPACK_METHODS_SOFTMAX_REGRESSION_SOFTMAX_REGRESSION_FUNCTION_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "softmax_regression_function.hpp"
+
+namespace mlpack {
+namespace regression {
+
+template<typename MatType>
+SoftmaxRegressionFunction<MatType>::SoftmaxRegressionFunction(
+    const MatType& data,
+    const arma::Row<size_t>& labels,
+    const size_t numClasses,
+    const double lambda,
+    const bool fitIntercept) :
+    data(data),
+    labels(labels),
+    numClasses(numClasses),
+    lambda(lambda),
+    fitIntercept(fitIntercept)
+{
+  if (labels.n_elem != data.n_cols)
+  {
+    std::ostringstream oss;
+    oss << "SoftmaxRegressionFunction::SoftmaxRegressionFunction(): number of "
+        << "labels (" << labels.n_elem << ") doesn't match the number of "
+        << "points (" << data.n_cols << ")";
+    throw std::invalid_argument(oss.str());
+  }
+
+  if (labels.n_elem > 0 && labels.max() >= numClasses)
+  {
+    std::ostringstream oss;
+    oss << "SoftmaxRegressionFunction::SoftmaxRegressionFunction(): label "
+        << labels.max() << " is out of range for " << numClasses
+        << " classes";
+    throw std::invalid_argument(oss.str());
+  }
+
+  // Initialize the parameters to suitable values.
+  initialPoint = InitializeWeights();
+}
+
+/**
+ * Initializes parameter weights to random values taken from a scaled standard
+ * normal distribution. The weights cannot be initialized to zero, as that will
+ * lead to each class output being the same.
+ */
+template<typename MatType>
+const arma::mat SoftmaxRegressionFunction<MatType>::InitializeWeights()
+{
+  return InitializeWeights(data.n_rows, numClasses, fitIntercept);
+}
+
+template<typename MatType>
+const arma::mat SoftmaxRegressionFunction<MatType>::InitializeWeights(
+    const size_t featureSize,
+    const size_t numClasses,
+    const bool fitIntercept)
+{
+    arma::mat parameters;
+    InitializeWeights(parameters, featureSize, numClasses, fitIntercept);
+    return parameters;
+}
+
+template<typename MatType>
+void SoftmaxRegressionFunction<MatType>::InitializeWeights(
+    arma::mat &weights,
+    const size_t featureSize,
+    const size_t numClasses,
+    const bool fitIntercept)
+{
+  // Initialize values to 0.005 * r. 'r' is a matrix of random values taken from
+  // a Gaussian distribution with mean zero and variance one.
+  // If the fitIntercept flag is true, parameters.col(0) is the intercept.
+  if (fitIntercept)
+    weights.randn(numClasses, featureSize + 1);
+  else
+    weights.randn(numClasses, featureSize);
+  weights *= 0.005;
+}
+
+/**
+ * This is equivalent to applying the indicator function to the training
+ * labels. The output is in the form of a matrix, which leads to simpler
+ * calculations in the Evaluate() and Gradient() methods.
+ */
+template<typename MatType>
+void SoftmaxRegressionFunction<MatType>::GetGroundTruthMatrix(
+    const arma::Row<size_t>& labels, arma::sp_mat& groundTruth)
+{
+  // Calculate the ground truth matrix according to the labels passed. The
+  // ground truth matrix is a matrix of dimensions 'numClasses * numExamples',
+  // where each column contains a single entry of '1', marking the label
+  // corresponding to that example.
+
+  // Row pointers and column pointers corresponding to the entries.
+  arma::uvec rowPointers(labels.n_elem);
+  arma::uvec colPointers(labels.n_elem + 1);
+
+  // Row pointers are the labels of the examples, and column pointers are the
+  // number of cumulative entries made uptil that column.
+  for (size_t i = 0; i < labels.n_elem; i++)
+  {
+    rowPointers(i) = labels(i);
+    colPointers(i+1) = i + 1;
+  }
+
+  // All entries are '1'.
+  arma::vec values;
+  values.ones(labels.n_elem);
+
+  // Calculate the matrix.
+  groundTruth = arma::sp_mat(rowPointers, colPointers, values, numClasses,
+                             labels.n_elem);
+}
+
+/**
+ * Evaluate the probabilities matrix. If fitIntercept flag is true,
+ * it should consider the parameters.cols(0) intercept term.
+ */
+template<typename MatType>
+void SoftmaxRegressionFunction<MatType>::GetProbabilitiesMatrix(
+    const arma::mat& parameters,
+    arma::mat& probabilities) const
+{
+  GetProbabilitiesMatrix(parameters, probabilities, 0, data.n_cols);
+}
+
+template<typename MatType>
+void SoftmaxRegressionFunction<MatType>::GetProbabilitiesMatrix(
+    const arma::mat& parameters,
+    arma::mat& probabilities,
+    const size_t begin,
+    const size_t batchSize) const
+{
+  arma::mat hypothesis;
+
+  if (fitIntercept)
+  {
+    // In order to add the intercept term, we should compute following matrix:
+    //     [1; data] = arma::join_cols(ones(1, data.n_cols), data)
+    //     hypothesis = arma::exp(parameters * [1; data]).
+    //
+    // Since the cost of join maybe high due to the copy of original data,
+    // split the hypothesis computation to two components.
+    hypothesis = arma::exp(arma::repmat(parameters.col(0), 1, batchSize) +
+        parameters.cols(1, parameters.n_cols - 1) *
+        data.cols(begin, begin + batchSize - 1));
+  }
+  else
+  {
+    hypothesis = arma::exp(parameters *
+        data.cols(begin, begin + batchSize - 1));
+  }
+
+  probabilities = hypothesis / arma::repmat(arma::sum(hypothesis, 0),
+                                            numClasses, 1);
+}
+
+/**
+ * Evaluates the objective function given the parameters.
+ */
+template<typename MatType>
+double SoftmaxRegressionFunction<MatType>::Evaluate(
+    const arma::mat& parameters) const
+{
+  // The objective function is the negative log likelihood of the model
+  // calculated over all the training examples. Mathematically it is as follows:
+  // log likelihood = sum(1{y_i = j} * log(probability(j))) / m
+  // The sum is over all 'i's and 'j's, where 'i' points to a training example
+  // and 'j' points to a particular class. 1{x} is an indicator function whose
+  // value is 1 only when 'x' is satisfied, otherwise it is 0.
+  // 'm' is the number of training examples.
+  // The cost also takes into account the regularization to control the
+  // parameter weights.
+
+  // The probabilities of the classes of a training example are given by:
+  // p_j = exp(theta_j' * x_i) / sum(exp(theta_k' * x_i))
+  // The sum is calculated over all the classes.
+  // x_i is the input vector for a particular training example.
+  // theta_j is the parameter vector associated with a particular class.
+  // They are computed one block of examples at a time; see EvaluateBlocks().
+  const double logLikelihood = -EvaluateBlocks(parameters, 0, data.n_cols,
+      NULL) / data.n_cols;
+  const double weightDecay = 0.5 * lambda * arma::accu(parameters % parameters);
+
+  // The cost is the sum of the negative log likelihood and the regularization
+  // terms.
+  return -logLikelihood + weightDecay;
+}
+
+/**
+ * Calculates and stores the gradient values given a set of parameters.
+ */
+template<typename MatType>
+void SoftmaxRegressionFunction<MatType>::Gradient(
+    const arma::mat& parameters,
+    arma::mat& gradient) const
+{
+  // The gradient of the log likelihood is accumulated one block of examples
+  // at a time, so the class probabilities of all the examples are never held
+  // at once; see EvaluateBlocks().
+  EvaluateBlocks(parameters, 0, data.n_cols, &gradient);
+  gradient /= data.n_cols;
+  gradient += lambda * parameters;
+}
+
+/**
+ * Evaluates the objective function of a batch of points, with their share of
+ * the regularization.
+ */
+template<typename MatType>
+double SoftmaxRegressionFunction<MatType>::Evaluate(
+    const arma::mat& parameters,
+    const size_t begin,
+    const size_t batchSize) const
+{
+  const double logLikelihood = -EvaluateBlocks(parameters, begin, batchSize,
+      NULL) / data.n_cols;
+  const double weightDecay = 0.5 * lambda * batchSize / data.n_cols *
+      arma::accu(parameters % parameters);
+
+  return -logLikelihood + weightDecay;
+}
+
+/**
+ * Calculates the gradient of a batch of points, with their share of the
+ * regularization.
+ */
+template<typename MatType>
+void SoftmaxRegressionFunction<MatType>::Gradient(
+    const arma::mat& parameters,
+    const size_t begin,
+    arma::mat& gradient,
+    const size_t batchSize) const
+{
+  EvaluateBlocks(parameters, begin, batchSize, &gradient);
+  gradient /= data.n_cols;
+  gradient += (lambda * batchSize / data.n_cols) * parameters;
+}
+
+/**
+ * Evaluates the objective function and the gradient of a batch of points,
+ * with their share of the regularization, computing the class probabilities
+ * once.
+ */
+template<typename MatType>
+double SoftmaxRegressionFunction<MatType>::EvaluateWithGradient(
+    const arma::mat& parameters,
+    const size_t begin,
+    arma::mat& gradient,
+    const size_t batchSize) const
+{
+  const double logLikelihood = -EvaluateBlocks(parameters, begin, batchSize,
+      &gradient) / data.n_cols;
+  const double share = lambda * batchSize / data.n_cols;
+
+  gradient /= data.n_cols;
+  gradient += share * parameters;
+
+  return -logLikelihood + 0.5 * share * arma::accu(parameters % parameters);
+}
+
+/**
+ * Calculates the gradient of one point as a sparse matrix, touching only the
+ * columns of the nonzero features of the point.
+ */
+template<typename MatType>
+void SoftmaxRegressionFunction<MatType>::Gradient(
+    const arma::mat& parameters,
+    const size_t i,
+    arma::sp_mat& gradient) const
+{
+  const arma::sp_mat point(data.col(i));
+  const size_t offset = fitIntercept ? 1 : 0;
+
+  // Compute the class probabilities of the point from its nonzero features.
+  arma::vec scores = fitIntercept ? arma::vec(parameters.col(0)) :
+      arma::vec(numClasses, arma::fill::zeros);
+  for (arma::sp_mat::const_iterator it = point.begin(); it != point.end();
+      ++it)
+    scores += (*it) * parameters.col(it.row() + offset);
+
+  // Subtract the largest score, so that the exponentials can't overflow.
+  arma::vec inner = arma::exp(scores - scores.max());
+  inner /= arma::accu(inner);
+
+  inner[labels[i]] -= 1.0;
+  inner /= data.n_cols;
+
+  const double decay = lambda / data.n_cols;
+  const size_t numColumns = point.n_nonzero + offset;
+  arma::umat locations(2, numClasses * numColumns);
+  arma::vec values(numClasses * numColumns);
+
+  size_t k = 0;
+  if (fitIntercept)
+  {
+    for (size_t c = 0; c < numClasses; ++c, ++k)
+    {
+      locations(0, k) = c;
+      locations(1, k) = 0;
+      values[k] = inner[c] + decay * parameters(c, 0);
+    }
+  }
+
+  for (arma::sp_mat::const_iterator it = point.begin(); it != point.end();
+      ++it)
+  {
+    const size_t column = it.row() + offset;
+    for (size_t c = 0; c < numClasses; ++c, ++k)
+    {
+      locations(0, k) = c;
+      locations(1, k) = column;
+      values[k] = inner[c] * (*it) + decay * parameters(c, column);
+    }
+  }
+
+  gradient = arma::sp_mat(locations, values, parameters.n_rows,
+      parameters.n_cols);
+}
+
+/**
+ * The scores of a block of points are computed with one matrix product, and
+ * turned into class probabilities in place; the largest score of each point is
+ * subtracted first, so the exponentials can't overflow.  The probabilities
+ * minus the indicators of the labels then give the gradient of the block with
+ * a second product.  Blocks are split between the threads, each of which
+ * accumulates its own objective and gradient; these are summed in order at the
+ * end.
+ */
+template<typename MatType>
+double SoftmaxRegressionFunction<MatType>::EvaluateBlocks(
+    const arma::mat& parameters,
+    const size_t begin,
+    const size_t batchSize,
+    arma::mat* gradient) const
+{
+  // Limit each block of scores to about 2^20 values (8MB).
+  const size_t blockSize = std::max((size_t) 1, std::min((size_t) 4096,
+      ((size_t) 1 << 20) / numClasses));
+  const size_t numBlocks = (batchSize + blockSize - 1) / blockSize;
+  const size_t offset = fitIntercept ? 1 : 0;
+
+  // If this is called from a parallel region (such as the ones of L_BFGS),
+  // the blocks are all handled by the calling thread.
+#ifdef HAS_OPENMP
+  const size_t numThreads = omp_in_parallel() ? 1 :
+      std::max((size_t) 1, std::min((size_t) omp_get_max_threads(),
+      numBlocks));
+#else
+  const size_t numThreads = 1;
+#endif
+
+  std::vector<double> objectives(numThreads, 0.0);
+  std::vector<arma::mat> gradients(gradient ? numThreads : 0,
+      arma::mat(parameters.n_rows, parameters.n_cols, arma::fill::zeros));
+
+  #pragma omp parallel num_threads(numThreads)
+  {
+#ifdef HAS_OPENMP
+    const size_t thread = omp_get_thread_num();
+#else
+    const size_t thread = 0;
+#endif
+
+    arma::mat scores;
+
+#ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables. If we're building for Visual Studio,
+    // use the intmax_t type instead.
+    #pragma omp for schedule(static)
+    for (intmax_t b = 0; b < (intmax_t) numBlocks; ++b)
+#else
+    #pragma omp for schedule(static)
+    for (size_t b = 0; b < numBlocks; ++b)
+#endif
+    {
+      const size_t first = begin + b * blockSize;
+      const size_t last = std::min(first + blockSize, begin + batchSize) - 1;
+
+      scores = parameters.cols(offset, parameters.n_cols - 1) *
+          data.cols(first, last);
+      if (fitIntercept)
+        scores.each_col() += parameters.col(0);
+
+      for (size_t j = 0; j < scores.n_cols; ++j)
+      {
+        double* score = scores.colptr(j);
+        const size_t label = labels[first + j];
+
+        double maxScore = score[0];
+        for (size_t c = 1; c < numClasses; ++c)
+          maxScore = std::max(maxScore, score[c]);
+
+        // -log(p_label) = log(sum(exp(s_c - max))) - (s_label - max).
+        const double labelScore = score[label] - maxScore;
+        double sum = 0.0;
+        for (size_t c = 0; c < numClasses; ++c)
+        {
+          score[c] = std::exp(score[c] - maxScore);
+          sum += score[c];
+        }
+        objectives[thread] += std::log(sum) - labelScore;
+
+        if (gradient)
+        {
+          for (size_t c = 0; c < numClasses; ++c)
+            score[c] /= sum;
+          score[label] -= 1.0;
+        }
+      }
+
+      if (gradient)
+      {
+        arma::mat& g = gradients[thread];
+        g.cols(offset, g.n_cols - 1) += scores * data.cols(first, last).t();
+        if (fitIntercept)
+          g.col(0) += arma::sum(scores, 1);
+      }
+    }
+  }
+
+  double objective = 0.0;
+  for (size_t t = 0; t < numThreads; ++t)
+    objective += objectives[t];
+
+  if (gradient)
+  {
+    *gradient = std::move(gradients[0]);
+    for (size_t t = 1; t < numThreads; ++t)
+      *gradient += gradients[t];
+  }
+
+  return objective;
+}
+
+} // namespace regression
+} // namespace mlpack
+
+#endif
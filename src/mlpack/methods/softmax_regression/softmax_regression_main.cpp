@@ -47,7 +47,15 @@ PROGRAM_INFO("Softmax Regression", "This program performs softmax regression, "
     "will be saved in the file specified with the --predictions_file (-p) "
     "option.  If labels are specified for the test data, with the --test_labels"
     " (-L) option, then the program will print the accuracy of the predictions "
-    "on the given test set and its corresponding labels.");
+    "on the given test set and its corresponding labels."
+    "\n\n"
+    "With --sparse (-S), the training and test sets are loaded as sparse "
+    "matrices, and training and prediction take time linear in their number "
+    "of nonzero values.  Sparse matrices can be given as sparse ARFF files "
+    "(.arff), as coordinate lists with a 'point feature value' line per "
+    "nonzero value (.txt, .tsv or .coo), or as Armadillo binary sparse "
+    "matrices (.bin).  Models trained on sparse data can be used with dense "
+    "data, and the other way around.");
 
 // Required options.
 PARAM_MATRIX_IN("training", "A matrix containing the training set (the matrix "
@@ -78,17 +86,25 @@ PARAM_INT_IN("number_of_classes", "Number of classes for classification; if "
 PARAM_DOUBLE_IN("lambda", "L2-regularization constant", "r", 0.0001);
 
 PARAM_FLAG("no_intercept", "Do not add the intercept term to the model.", "N");
+PARAM_FLAG("sparse", "Load the training and test sets as sparse matrices.",
+    "S");
 
 // Count the number of classes in the given labels (if numClasses == 0).
 size_t CalculateNumberOfClasses(const size_t numClasses,
                                 const arma::Row<size_t>& trainLabels);
 
+// Load the matrix of the given parameter.
+void LoadMatrix(const string& name, arma::mat& matrix);
+
+// Load the matrix of the given parameter as a sparse matrix.
+void LoadMatrix(const string& name, arma::sp_mat& matrix);
+
 // Test the accuracy of the model.
-template<typename Model>
+template<typename Model, typename MatType>
 void TestClassifyAcc(const size_t numClasses, const Model& model);
 
 // Build the softmax model given the parameters.
-template<typename Model>
+template<typename Model, typename MatType>
 unique_ptr<Model> TrainSoftmax(const size_t maxIterations);
 
 int main(int argc, char** argv)
@@ -117,9 +133,17 @@ int main(int argc, char** argv)
         << "no results from this program will be saved." << endl;
 
   using SM = SoftmaxRegression<>;
-  unique_ptr<SM> sm = TrainSoftmax<SM>(maxIterations);
-
-  TestClassifyAcc(sm->NumClasses(), *sm);
+  unique_ptr<SM> sm;
+  if (CLI::HasParam("sparse"))
+  {
+    sm = TrainSoftmax<SM, arma::sp_mat>(maxIterations);
+    TestClassifyAcc<SM, arma::sp_mat>(sm->NumClasses(), *sm);
+  }
+  else
+  {
+    sm = TrainSoftmax<SM, arma::mat>(maxIterations);
+    TestClassifyAcc<SM, arma::mat>(sm->NumClasses(), *sm);
+  }
 
   if (CLI::HasParam("output_model"))
     CLI::GetParam<SM>("output_model") = std::move(*sm);
@@ -142,7 +166,17 @@ size_t CalculateNumberOfClasses(const size_t numClasses,
   }
 }
 
-template<typename Model>
+void LoadMatrix(const string& name, arma::mat& matrix)
+{
+  matrix = std::move(CLI::GetParam<arma::mat>(name));
+}
+
+void LoadMatrix(const string& name, arma::sp_mat& matrix)
+{
+  data::Load(CLI::GetUnmappedParam<arma::mat>(name), matrix, true);
+}
+
+template<typename Model, typename MatType>
 void TestClassifyAcc(size_t numClasses, const Model& model)
 {
   using namespace mlpack;
@@ -167,7 +201,8 @@ void TestClassifyAcc(size_t numClasses, const Model& model)
   }
 
   // Get the test dataset, and get predictions.
-  arma::mat testData = std::move(CLI::GetParam<arma::mat>("test"));
+  MatType testData;
+  LoadMatrix("test", testData);
 
   arma::Row<size_t> predictLabels;
   model.Classify(testData, predictLabels);
@@ -215,12 +250,12 @@ void TestClassifyAcc(size_t numClasses, const Model& model)
   }
 }
 
-template<typename Model>
+template<typename Model, typename MatType>
 unique_ptr<Model> TrainSoftmax(const size_t maxIterations)
 {
   using namespace mlpack;
 
-  using SRF = regression::SoftmaxRegressionFunction;
+  using SRF = regression::SoftmaxRegressionFunction<MatType>;
 
   unique_ptr<Model> sm;
   if (CLI::HasParam("input_model"))
@@ -230,7 +265,8 @@ unique_ptr<Model> TrainSoftmax(const size_t maxIterations)
   }
   else
   {
-    arma::mat trainData = std::move(CLI::GetParam<arma::mat>("training"));
+    MatType trainData;
+    LoadMatrix("training", trainData);
     arma::Row<size_t> trainLabels =
         std::move(CLI::GetParam<arma::Row<size_t>>("labels"));
 
@@ -243,8 +279,8 @@ unique_ptr<Model> TrainSoftmax(const size_t maxIterations)
 
     const bool intercept = CLI::HasParam("no_intercept") ? false : true;
 
-    SRF smFunction(trainData, trainLabels, numClasses, intercept,
-        CLI::GetParam<double>("lambda"));
+    SRF smFunction(trainData, trainLabels, numClasses,
+        CLI::GetParam<double>("lambda"), intercept);
 
     const size_t numBasis = 5;
     optimization::L_BFGS<SRF> optimizer(smFunction, numBasis, maxIterations);
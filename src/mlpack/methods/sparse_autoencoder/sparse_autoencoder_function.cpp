@@ -74,6 +74,13 @@ const arma::mat SparseAutoencoderFunction::InitializeWeights()
 /** Evaluates the objective function given the parameters.
   */
 double SparseAutoencoderFunction::Evaluate(const arma::mat& parameters) const
+{
+  return Evaluate(parameters, 0, data.n_cols);
+}
+
+double SparseAutoencoderFunction::Evaluate(const arma::mat& parameters,
+                                           const size_t begin,
+                                           const size_t batchSize) const
 {
   // The objective function is the average squared reconstruction error of the
   // network. w1 and b1 are the weights and biases associated with the hidden
@@ -82,129 +89,285 @@ double SparseAutoencoderFunction::Evaluate(const arma::mat& parameters) const
   // 'm' is the number of training examples.
   // The cost also takes into account the regularization and KL divergence terms
   // to control the parameter weights and sparsity of the model respectively.
+  //
+  // A batch has the share batchSize / m of the regularization and KL
+  // divergence terms, where the KL divergence uses the average activations of
+  // the hidden layer over the batch.  Both the average activations and the
+  // reconstruction error are found in one pass over the points of the batch.
+  arma::vec rhoCap;
+  const double squaredError = ForwardBlocks(parameters, begin, batchSize,
+      rhoCap, true);
+
+  return 0.5 * squaredError / data.n_cols + ((double) batchSize /
+      data.n_cols) * (WeightDecay(parameters) + KLDivergence(rhoCap));
+}
 
-  // Compute the limits for the parameters w1, w2, b1 and b2.
-  const size_t l1 = hiddenSize;
-  const size_t l2 = visibleSize;
-  const size_t l3 = 2 * hiddenSize;
+/** Calculates and stores the gradient values given a set of parameters.
+  */
+void SparseAutoencoderFunction::Gradient(const arma::mat& parameters,
+                                         arma::mat& gradient) const
+{
+  Gradient(parameters, 0, gradient, data.n_cols);
+}
 
-  // w1, w2, b1 and b2 are not extracted separately, 'parameters' is directly
-  // used in their place to avoid copying data. The following representations
-  // are used:
-  // w1 <- parameters.submat(0, 0, l1-1, l2-1)
-  // w2 <- parameters.submat(l1, 0, l3-1, l2-1).t()
-  // b1 <- parameters.submat(0, l2, l1-1, l2)
-  // b2 <- parameters.submat(l3, 0, l3, l2-1).t()
+void SparseAutoencoderFunction::Gradient(const arma::mat& parameters,
+                                         const size_t begin,
+                                         arma::mat& gradient,
+                                         const size_t batchSize) const
+{
+  EvaluateWithGradient(parameters, begin, gradient, batchSize);
+}
+
+double SparseAutoencoderFunction::EvaluateWithGradient(
+    const arma::mat& parameters,
+    const size_t begin,
+    arma::mat& gradient,
+    const size_t batchSize) const
+{
+  // Performs a feedforward pass of the neural network, and computes the
+  // activations of the output layer as in the Evaluate() method. It uses the
+  // Backpropagation algorithm to calculate the delta values at each layer,
+  // except for the input layer. The delta values are then used with input layer
+  // and hidden layer activations to get the parameter gradients.
+  //
+  // The delta values of the hidden layer depend on the average activations of
+  // the hidden layer through the KL divergence term, so these are found first,
+  // in a pass over the points of the batch, and the gradient is then
+  // accumulated in a second pass.
 
-  arma::mat hiddenLayer, outputLayer;
+  // Compute the limits for the parameters w1 and w2.
+  const size_t l2 = visibleSize;
+  const size_t l3 = 2 * hiddenSize;
 
-  // Compute activations of the hidden and output layers.
-  Sigmoid(parameters.submat(0, 0, l1 - 1, l2 - 1) * data +
-      arma::repmat(parameters.submat(0, l2, l1 - 1, l2), 1, data.n_cols),
-      hiddenLayer);
+  arma::vec rhoCap;
+  ForwardBlocks(parameters, begin, batchSize, rhoCap, false);
 
-  Sigmoid(parameters.submat(l1, 0, l3 - 1, l2 - 1).t() * hiddenLayer +
-      arma::repmat(parameters.submat(l3, 0, l3, l2 - 1).t(), 1, data.n_cols),
-      outputLayer);
+  // The gradient of the KL divergence term with respect to the average
+  // activations; the share batchSize / m of the term cancels the average over
+  // the batch, so that the gradient of every point is divided by m.
+  const arma::vec klDivGrad = beta * (-(rho / rhoCap) + (1 - rho) /
+      (1 - rhoCap));
 
-  arma::mat rhoCap, diff;
+  const double squaredError = BackwardBlocks(parameters, begin, batchSize,
+      klDivGrad, gradient);
 
-  // Average activations of the hidden layer.
-  rhoCap = arma::sum(hiddenLayer, 1) / data.n_cols;
-  // Difference between the reconstructed data and the original data.
-  diff = outputLayer - data;
+  // Add the regularization terms to the sums of the gradients of the points.
+  const double share = (double) batchSize / data.n_cols;
+  gradient /= data.n_cols;
+  gradient.submat(0, 0, l3 - 1, l2 - 1) += (share * lambda) *
+      parameters.submat(0, 0, l3 - 1, l2 - 1);
 
-  double wL2SquaredNorm;
+  return 0.5 * squaredError / data.n_cols + share *
+      (WeightDecay(parameters) + KLDivergence(rhoCap));
+}
 
-  // Calculate squared L2-norms of w1 and w2.
-  wL2SquaredNorm = arma::accu(parameters.submat(0, 0, l3 - 1, l2 - 1) %
-      parameters.submat(0, 0, l3 - 1, l2 - 1));
+double SparseAutoencoderFunction::WeightDecay(const arma::mat& parameters)
+    const
+{
+  // 'weightDecay' is the squared l2-norm of the weights w1 and w2.
+  const size_t l2 = visibleSize;
+  const size_t l3 = 2 * hiddenSize;
 
-  double sumOfSquaresError, weightDecay, klDivergence, cost;
+  return 0.5 * lambda * arma::accu(arma::square(
+      parameters.submat(0, 0, l3 - 1, l2 - 1)));
+}
 
-  // Calculate the reconstruction error, the regularization cost and the KL
-  // divergence cost terms. 'sumOfSquaresError' is the average squared l2-norm
-  // of the reconstructed data difference. 'weightDecay' is the squared l2-norm
-  // of the weights w1 and w2. 'klDivergence' is the cost of the hidden layer
-  // activations not being low. It is given by the following formula:
+double SparseAutoencoderFunction::KLDivergence(const arma::vec& rhoCap) const
+{
+  // 'klDivergence' is the cost of the hidden layer activations not being low.
+  // It is given by the following formula:
   // KL = sum_over_hSize(rho*log(rho/rhoCaq) + (1-rho)*log((1-rho)/(1-rhoCap)))
-  sumOfSquaresError = 0.5 * arma::accu(diff % diff) / data.n_cols;
-  weightDecay = 0.5 * lambda * wL2SquaredNorm;
-  klDivergence = beta * arma::accu(rho * arma::log(rho / rhoCap) + (1 - rho) *
+  return beta * arma::accu(rho * arma::log(rho / rhoCap) + (1 - rho) *
       arma::log((1 - rho) / (1 - rhoCap)));
-
-  // The cost is the sum of the terms calculated above.
-  cost = sumOfSquaresError + weightDecay + klDivergence;
-
-  return cost;
 }
 
-/** Calculates and stores the gradient values given a set of parameters.
-  */
-void SparseAutoencoderFunction::Gradient(const arma::mat& parameters,
-                                         arma::mat& gradient) const
+size_t SparseAutoencoderFunction::BlockSize() const
 {
-  // Performs a feedforward pass of the neural network, and computes the
-  // activations of the output layer as in the Evaluate() method. It uses the
-  // Backpropagation algorithm to calculate the delta values at each layer,
-  // except for the input layer. The delta values are then used with input layer
-  // and hidden layer activations to get the parameter gradients.
+  // Limit each block of activations to about 2^20 values (8MB).
+  return std::max((size_t) 1, std::min((size_t) 4096, ((size_t) 1 << 20) /
+      std::max(visibleSize, hiddenSize)));
+}
 
+double SparseAutoencoderFunction::ForwardBlocks(const arma::mat& parameters,
+                                                const size_t begin,
+                                                const size_t batchSize,
+                                                arma::vec& rhoCap,
+                                                const bool reconstruct) const
+{
   // Compute the limits for the parameters w1, w2, b1 and b2.
   const size_t l1 = hiddenSize;
   const size_t l2 = visibleSize;
   const size_t l3 = 2 * hiddenSize;
 
-  // w1, w2, b1 and b2 are not extracted separately, 'parameters' is directly
-  // used in their place to avoid copying data. The following representations
-  // are used:
-  // w1 <- parameters.submat(0, 0, l1-1, l2-1)
-  // w2 <- parameters.submat(l1, 0, l3-1, l2-1).t()
-  // b1 <- parameters.submat(0, l2, l1-1, l2)
-  // b2 <- parameters.submat(l3, 0, l3, l2-1).t()
+  const size_t blockSize = BlockSize();
+  const size_t numBlocks = (batchSize + blockSize - 1) / blockSize;
+
+  // If this is called from a parallel region (such as the ones of L_BFGS),
+  // the blocks are all handled by the calling thread.
+#ifdef HAS_OPENMP
+  const size_t numThreads = omp_in_parallel() ? 1 :
+      std::max((size_t) 1, std::min((size_t) omp_get_max_threads(),
+      numBlocks));
+#else
+  const size_t numThreads = 1;
+#endif
+
+  std::vector<arma::vec> hiddenSums(numThreads,
+      arma::vec(hiddenSize, arma::fill::zeros));
+  std::vector<double> squaredErrors(numThreads, 0.0);
+
+  #pragma omp parallel num_threads(numThreads)
+  {
+#ifdef HAS_OPENMP
+    const size_t thread = omp_get_thread_num();
+#else
+    const size_t thread = 0;
+#endif
+
+    arma::mat hiddenLayer, outputLayer;
+
+#ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables. If we're building for Visual Studio,
+    // use the intmax_t type instead.
+    #pragma omp for schedule(static)
+    for (intmax_t b = 0; b < (intmax_t) numBlocks; ++b)
+#else
+    #pragma omp for schedule(static)
+    for (size_t b = 0; b < numBlocks; ++b)
+#endif
+    {
+      const size_t first = begin + b * blockSize;
+      const size_t last = std::min(first + blockSize, begin + batchSize) - 1;
+
+      // Compute activations of the hidden and output layers.
+      hiddenLayer = parameters.submat(0, 0, l1 - 1, l2 - 1) *
+          data.cols(first, last);
+      hiddenLayer.each_col() += parameters.submat(0, l2, l1 - 1, l2);
+      Sigmoid(hiddenLayer, hiddenLayer);
+
+      hiddenSums[thread] += arma::sum(hiddenLayer, 1);
+
+      if (reconstruct)
+      {
+        outputLayer = parameters.submat(l1, 0, l3 - 1, l2 - 1).t() *
+            hiddenLayer;
+        outputLayer.each_col() += parameters.submat(l3, 0, l3, l2 - 1).t();
+        Sigmoid(outputLayer, outputLayer);
+
+        squaredErrors[thread] += arma::accu(arma::square(outputLayer -
+            data.cols(first, last)));
+      }
+    }
+  }
 
-  arma::mat hiddenLayer, outputLayer;
-
-  // Compute activations of the hidden and output layers.
-  Sigmoid(parameters.submat(0, 0, l1 - 1, l2 - 1) * data +
-      arma::repmat(parameters.submat(0, l2, l1 - 1, l2), 1, data.n_cols),
-      hiddenLayer);
-
-  Sigmoid(parameters.submat(l1, 0, l3 - 1, l2 - 1).t() * hiddenLayer +
-      arma::repmat(parameters.submat(l3, 0, l3, l2 - 1).t(), 1, data.n_cols),
-      outputLayer);
+  // Average activations of the hidden layer.
+  rhoCap = std::move(hiddenSums[0]);
+  double squaredError = squaredErrors[0];
+  for (size_t t = 1; t < numThreads; ++t)
+  {
+    rhoCap += hiddenSums[t];
+    squaredError += squaredErrors[t];
+  }
+  rhoCap /= batchSize;
+
+  return squaredError;
+}
 
-  arma::mat rhoCap, diff;
+double SparseAutoencoderFunction::BackwardBlocks(const arma::mat& parameters,
+                                                 const size_t begin,
+                                                 const size_t batchSize,
+                                                 const arma::vec& klDivGrad,
+                                                 arma::mat& gradient) const
+{
+  // Compute the limits for the parameters w1, w2, b1 and b2.
+  const size_t l1 = hiddenSize;
+  const size_t l2 = visibleSize;
+  const size_t l3 = 2 * hiddenSize;
 
-  // Average activations of the hidden layer.
-  rhoCap = arma::sum(hiddenLayer, 1) / data.n_cols;
-  // Difference between the reconstructed data and the original data.
-  diff = outputLayer - data;
-
-  arma::mat klDivGrad, delOut, delHid;
-
-  // The delta vector for the output layer is given by diff * f'(z), where z is
-  // the preactivation and f is the activation function. The derivative of the
-  // sigmoid function turns out to be f(z) * (1 - f(z)). For every other layer
-  // in the neural network which comes before the output layer, the delta values
-  // are given del_n = w_n' * del_(n+1) * f'(z_n). Since our cost function also
-  // includes the KL divergence term, we adjust for that in the formula below.
-  klDivGrad = beta * (-(rho / rhoCap) + (1 - rho) / (1 - rhoCap));
-  delOut = diff % outputLayer % (1 - outputLayer);
-  delHid = (parameters.submat(l1, 0, l3 - 1, l2 - 1) * delOut +
-      arma::repmat(klDivGrad, 1, data.n_cols)) % hiddenLayer %
-      (1 - hiddenLayer);
-
-  gradient.zeros(2 * hiddenSize + 1, visibleSize + 1);
-
-  // Compute the gradient values using the activations and the delta values. The
-  // formula also accounts for the regularization terms in the objective.
-  // function.
-  gradient.submat(0, 0, l1 - 1, l2 - 1) = delHid * data.t() / data.n_cols +
-      lambda * parameters.submat(0, 0, l1 - 1, l2 - 1);
-  gradient.submat(l1, 0, l3 - 1, l2 - 1) =
-      (delOut * hiddenLayer.t() / data.n_cols +
-      lambda * parameters.submat(l1, 0, l3 - 1, l2 - 1).t()).t();
-  gradient.submat(0, l2, l1 - 1, l2) = arma::sum(delHid, 1) / data.n_cols;
-  gradient.submat(l3, 0, l3, l2 - 1) = (arma::sum(delOut, 1) / data.n_cols).t();
+  const size_t blockSize = BlockSize();
+  const size_t numBlocks = (batchSize + blockSize - 1) / blockSize;
+
+#ifdef HAS_OPENMP
+  const size_t numThreads = omp_in_parallel() ? 1 :
+      std::max((size_t) 1, std::min((size_t) omp_get_max_threads(),
+      numBlocks));
+#else
+  const size_t numThreads = 1;
+#endif
+
+  std::vector<arma::mat> gradients(numThreads,
+      arma::mat(parameters.n_rows, parameters.n_cols, arma::fill::zeros));
+  std::vector<double> squaredErrors(numThreads, 0.0);
+
+  #pragma omp parallel num_threads(numThreads)
+  {
+#ifdef HAS_OPENMP
+    const size_t thread = omp_get_thread_num();
+#else
+    const size_t thread = 0;
+#endif
+
+    arma::mat hiddenLayer, outputLayer, delOut, delHid;
+
+#ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables. If we're building for Visual Studio,
+    // use the intmax_t type instead.
+    #pragma omp for schedule(static)
+    for (intmax_t b = 0; b < (intmax_t) numBlocks; ++b)
+#else
+    #pragma omp for schedule(static)
+    for (size_t b = 0; b < numBlocks; ++b)
+#endif
+    {
+      const size_t first = begin + b * blockSize;
+      const size_t last = std::min(first + blockSize, begin + batchSize) - 1;
+
+      // Compute activations of the hidden and output layers.
+      hiddenLayer = parameters.submat(0, 0, l1 - 1, l2 - 1) *
+          data.cols(first, last);
+      hiddenLayer.each_col() += parameters.submat(0, l2, l1 - 1, l2);
+      Sigmoid(hiddenLayer, hiddenLayer);
+
+      outputLayer = parameters.submat(l1, 0, l3 - 1, l2 - 1).t() * hiddenLayer;
+      outputLayer.each_col() += parameters.submat(l3, 0, l3, l2 - 1).t();
+      Sigmoid(outputLayer, outputLayer);
+
+      // Difference between the reconstructed data and the original data.
+      delOut = outputLayer - data.cols(first, last);
+      squaredErrors[thread] += arma::accu(arma::square(delOut));
+
+      // The delta vector for the output layer is given by diff * f'(z), where
+      // z is the preactivation and f is the activation function. The
+      // derivative of the sigmoid function turns out to be f(z) * (1 - f(z)).
+      // For every other layer in the neural network which comes before the
+      // output layer, the delta values are given
+      // del_n = w_n' * del_(n+1) * f'(z_n). Since our cost function also
+      // includes the KL divergence term, we adjust for that in the formula
+      // below.
+      delOut %= outputLayer % (1 - outputLayer);
+      delHid = parameters.submat(l1, 0, l3 - 1, l2 - 1) * delOut;
+      delHid.each_col() += klDivGrad;
+      delHid %= hiddenLayer % (1 - hiddenLayer);
+
+      // Accumulate the gradient values using the activations and the delta
+      // values.
+      arma::mat& g = gradients[thread];
+      g.submat(0, 0, l1 - 1, l2 - 1) += delHid * data.cols(first, last).t();
+      g.submat(l1, 0, l3 - 1, l2 - 1) += hiddenLayer * delOut.t();
+      g.submat(0, l2, l1 - 1, l2) += arma::sum(delHid, 1);
+      g.submat(l3, 0, l3, l2 - 1) += arma::sum(delOut, 1).t();
+    }
+  }
+
+  gradient = std::move(gradients[0]);
+  double squaredError = squaredErrors[0];
+  for (size_t t = 1; t < numThreads; ++t)
+  {
+    gradient += gradients[t];
+    squaredError += squaredErrors[t];
+  }
+
+  return squaredError;
 }
@@ -22,6 +22,11 @@ namespace nn {
  * This is a class for the sparse autoencoder objective function. It can be used
  * to create learning models like self-taught learning, stacked autoencoders,
  * conditional random fields (CRFs), and so forth.
+ *
+ * The objective and gradient are computed over blocks of points, in parallel
+ * when OpenMP is available, so that no temporary grows with the number of
+ * points.  The batch functions allow training with the SGD-family
+ * optimizers, such as MiniBatchSGD.
  */
 class SparseAutoencoderFunction
 {
@@ -59,6 +64,21 @@ class SparseAutoencoderFunction
    */
   double Evaluate(const arma::mat& parameters) const;
 
+  /**
+   * Evaluates the objective function on the points [begin, begin + batchSize),
+   * with their share (batchSize / m, for m points) of the regularization and
+   * KL divergence costs, where the KL divergence uses the average activations
+   * of the hidden layer over the batch.  The objectives of the batches sum to
+   * Evaluate() when beta is 0, so this is used by the SGD-family optimizers.
+   *
+   * @param parameters Current values of the model parameters.
+   * @param begin Index of the first point of the batch.
+   * @param batchSize Number of points of the batch.
+   */
+  double Evaluate(const arma::mat& parameters,
+                  const size_t begin,
+                  const size_t batchSize) const;
+
   /**
    * Evaluates the gradient values of the objective function given the current
    * set of parameters. The function performs a feedforward pass and computes
@@ -70,6 +90,37 @@ class SparseAutoencoderFunction
    */
   void Gradient(const arma::mat& parameters, arma::mat& gradient) const;
 
+  /**
+   * Evaluates the gradient of the objective function of the points
+   * [begin, begin + batchSize), as defined by the batch Evaluate().
+   *
+   * @param parameters Current values of the model parameters.
+   * @param begin Index of the first point of the batch.
+   * @param gradient Matrix where gradient values will be stored.
+   * @param batchSize Number of points of the batch.
+   */
+  void Gradient(const arma::mat& parameters,
+                const size_t begin,
+                arma::mat& gradient,
+                const size_t batchSize) const;
+
+  /**
+   * Evaluates the objective function of the points [begin, begin + batchSize)
+   * and its gradient, as defined by the batch Evaluate(), with one forward
+   * pass for the average activations of the hidden layer and one forward and
+   * backward pass for the gradient.
+   *
+   * @param parameters Current values of the model parameters.
+   * @param begin Index of the first point of the batch.
+   * @param gradient Matrix where gradient values will be stored.
+   * @param batchSize Number of points of the batch.
+   * @return Objective function of the batch.
+   */
+  double EvaluateWithGradient(const arma::mat& parameters,
+                              const size_t begin,
+                              arma::mat& gradient,
+                              const size_t batchSize) const;
+
   /**
    * Returns the elementwise sigmoid of the passed matrix, where the sigmoid
    * function of a real number 'x' is [1 / (1 + exp(-x))].
@@ -81,6 +132,9 @@ class SparseAutoencoderFunction
     output = (1.0 / (1 + arma::exp(-x)));
   }
 
+  //! Return the number of separable functions (the number of points).
+  size_t NumFunctions() const { return data.n_cols; }
+
   //! Return the initial point for the optimization.
   const arma::mat& GetInitialPoint() const { return initialPoint; }
 
@@ -159,6 +213,41 @@ class SparseAutoencoderFunction
   double beta;
   //! Sparsity parameter.
   double rho;
+
+  //! Compute the L2-regularization cost of the weights.
+  double WeightDecay(const arma::mat& parameters) const;
+
+  //! Compute the KL divergence cost of the given average activations.
+  double KLDivergence(const arma::vec& rhoCap) const;
+
+  //! Number of points of each block, so that the activations of a block take
+  //! about 2^20 values.
+  size_t BlockSize() const;
+
+  /**
+   * Compute the average activations of the hidden layer over the points
+   * [begin, begin + batchSize), by blocks of points.  If reconstruct is true,
+   * the sum of the squared reconstruction errors of the points is returned;
+   * otherwise, 0 is returned.
+   */
+  double ForwardBlocks(const arma::mat& parameters,
+                       const size_t begin,
+                       const size_t batchSize,
+                       arma::vec& rhoCap,
+                       const bool reconstruct) const;
+
+  /**
+   * Store the sum of the gradients of the reconstruction error and the KL
+   * divergence (without regularization) of the points
+   * [begin, begin + batchSize) into gradient, by blocks of points, given the
+   * gradient of the KL divergence with respect to the average activations.
+   * The sum of the squared reconstruction errors of the points is returned.
+   */
+  double BackwardBlocks(const arma::mat& parameters,
+                        const size_t begin,
+                        const size_t batchSize,
+                        const arma::vec& klDivGrad,
+                        arma::mat& gradient) const;
 };
 
 } // namespace nn
@@ -41,21 +41,41 @@ void SparseCoding::Encode(const arma::mat& data, arma::mat& codes)
   arma::mat matGram = trans(dictionary) * dictionary;
 
   codes.set_size(atoms, data.n_cols);
-  for (size_t i = 0; i < data.n_cols; ++i)
+  Log::Debug << "Encoding " << data.n_cols << " points." << std::endl;
+
+  // The points are independent, so blocks of points are encoded in parallel.
+  // Each thread keeps its own LARS solver, so that its workspaces are reused
+  // from one point to the next, and all of them share the Gram matrix of the
+  // dictionary.  The correlations of a block of points with the atoms are
+  // computed with a single matrix product.
+  const size_t blockSize = 256;
+  const size_t numBlocks = (data.n_cols + blockSize - 1) / blockSize;
+
+  #pragma omp parallel
   {
-    // Report progress.
-    if ((i % 100) == 0)
-      Log::Debug << "Optimization at point " << i << "." << std::endl;
-
-    bool useCholesky = true;
-    regression::LARS lars(useCholesky, matGram, lambda1, lambda2);
-
-    // Create an alias of the code (using the same memory), and then LARS will
-    // place the result directly into that; then we will not need to have an
-    // extra copy.
-    arma::vec code = codes.unsafe_col(i);
-    arma::rowvec responses = data.unsafe_col(i).t();
-    lars.Train(dictionary, responses, code, false);
+    regression::LARSSolver solver(matGram, lambda1, lambda2);
+
+#ifdef _WIN32
+    // Tiny workaround: Visual Studio only implements OpenMP 2.0, which doesn't
+    // support unsigned loop variables. If we're building for Visual Studio, use
+    // the intmax_t type instead.
+    #pragma omp for schedule(dynamic)
+    for (intmax_t b = 0; b < (intmax_t) numBlocks; ++b)
+#else
+    #pragma omp for schedule(dynamic)
+    for (size_t b = 0; b < numBlocks; ++b)
+#endif
+    {
+      const size_t begin = b * blockSize;
+      const size_t count = std::min(blockSize, (size_t) data.n_cols - begin);
+
+      // Create aliases of the points and of their codes (using the same
+      // memory); the solver will place the result directly into the codes.
+      const arma::mat points(const_cast<double*>(data.colptr(begin)),
+          data.n_rows, count, false, true);
+      arma::mat blockCodes(codes.colptr(begin), atoms, count, false, true);
+      solver.Solve(dictionary, points, blockCodes);
+    }
   }
 }
 
@@ -138,15 +158,22 @@ double SparseCoding::OptimizeDictionary(const arma::mat& data,
   arma::mat codesXT;
   arma::mat codesZT;
 
-  if (inactiveAtoms.empty())
+  const arma::mat& activeCodes = inactiveAtoms.empty() ? codes : matActiveZ;
+
+  // The codes are usually sparse (adjacencies holds the nonzero entries), and
+  // then the products are computed with a sparse matrix, which is much faster
+  // than the dense products; data is also never transposed.
+  if (adjacencies.n_elem < 0.1 * codes.n_elem)
   {
-    codesXT = codes * trans(data);
-    codesZT = codes * trans(codes);
+    const arma::sp_mat sparseCodes(activeCodes);
+    const arma::sp_mat sparseCodesT = sparseCodes.t();
+    codesXT = trans(data * sparseCodesT);
+    codesZT = arma::mat(sparseCodes * sparseCodesT);
   }
   else
   {
-    codesXT = matActiveZ * trans(data);
-    codesZT = matActiveZ * trans(matActiveZ);
+    codesXT = activeCodes * trans(data);
+    codesZT = activeCodes * trans(activeCodes);
   }
 
   double normGradient = 0;
@@ -15,6 +15,7 @@
 
 #include <mlpack/prereqs.hpp>
 #include <mlpack/methods/lars/lars.hpp>
+#include <mlpack/methods/lars/lars_solver.hpp>
 
 // Include our three simple dictionary initializers.
 #include "nothing_initializer.hpp"
@@ -108,4 +108,18 @@ using enable_if_t = typename enable_if<B, T>::type;
 // We need to be able to mark functions deprecated.
 #include <mlpack/core/util/deprecated.hpp>
 
+// Use OpenMP if compiled with -DHAS_OPENMP.  Tree construction uses OpenMP
+// tasks and taskloops, which need OpenMP 4.5 (so they are not available with,
+// e.g., Visual Studio).  The distance computations of the bounds use simd
+// loops, which need OpenMP 4.0.
+#ifdef HAS_OPENMP
+  #include <omp.h>
+  #if _OPENMP >= 201307
+    #define MLPACK_HAS_OPENMP_SIMD
+  #endif
+  #if _OPENMP >= 201511
+    #define MLPACK_HAS_OPENMP_TASKS
+  #endif
+#endif
+
 #endif
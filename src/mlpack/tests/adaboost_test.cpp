@@ -882,4 +882,41 @@ BOOST_AUTO_TEST_CASE(DecisionStumpSerializationTest)
   }
 }
 
+/**
+ * Make sure that Classify() gives the labels with the most weighted votes of
+ * the weak learners, on a dataset that spans several blocks of points.
+ */
+BOOST_AUTO_TEST_CASE(ClassifyVotesTest)
+{
+  mat data = randu<mat>(5, 2500);
+  Row<size_t> labels(2500);
+  for (size_t i = 0; i < 2500; ++i)
+    labels[i] = (data(0, i) + data(1, i) > 1.0) ? ((data(2, i) > 0.5) ? 2 : 1)
+        : 0;
+
+  DecisionStump<> ds(data, labels, 3, 10);
+  AdaBoost<DecisionStump<>> ab(data, labels, ds, 30, 1e-10);
+
+  mat testData = randu<mat>(5, 3000);
+  Row<size_t> predictedLabels;
+  ab.Classify(testData, predictedLabels);
+  BOOST_REQUIRE_EQUAL(predictedLabels.n_elem, testData.n_cols);
+
+  mat votes(3, testData.n_cols, arma::fill::zeros);
+  for (size_t i = 0; i < ab.WeakLearners(); ++i)
+  {
+    Row<size_t> weakLabels;
+    ab.WeakLearner(i).Classify(testData, weakLabels);
+    for (size_t j = 0; j < weakLabels.n_elem; ++j)
+      votes(weakLabels[j], j) += ab.Alpha(i);
+  }
+
+  arma::uword maxIndex = 0;
+  for (size_t j = 0; j < votes.n_cols; ++j)
+  {
+    votes.col(j).max(maxIndex);
+    BOOST_REQUIRE_EQUAL(predictedLabels[j], (size_t) maxIndex);
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -12,6 +12,7 @@
 #include <mlpack/methods/neighbor_search/neighbor_search.hpp>
 #include <mlpack/methods/neighbor_search/unmap.hpp>
 #include <mlpack/methods/neighbor_search/ns_model.hpp>
+#include <mlpack/methods/neighbor_search/spill_tree_tuner.hpp>
 #include <mlpack/core/tree/cover_tree.hpp>
 #include <mlpack/core/tree/example_tree.hpp>
 #include <boost/test/unit_test.hpp>
@@ -472,4 +473,81 @@ BOOST_AUTO_TEST_CASE(KNNModelMonochromaticTest)
   }
 }
 
+/**
+ * Make sure that the parameters chosen by SpillTreeTuner reach the target
+ * recall on the sample, and that they give a similar recall on the whole query
+ * set.
+ */
+BOOST_AUTO_TEST_CASE(SpillTreeTunerRecallTest)
+{
+  arma::mat referenceSet(5, 2000, arma::fill::randu);
+  arma::mat querySet(5, 500, arma::fill::randu);
+  const size_t k = 5;
+
+  SpillTreeTuner tuner(0.9, 200);
+  tuner.Tune(referenceSet, querySet, k);
+
+  BOOST_REQUIRE_GE(tuner.Recall(), 0.9);
+  BOOST_REQUIRE_GE(tuner.Tau(), 0.0);
+  BOOST_REQUIRE_GT(tuner.LeafSize(), 0);
+
+  KNN exact(referenceSet);
+  arma::Mat<size_t> trueNeighbors;
+  arma::mat trueDistances;
+  exact.Search(querySet, k, trueNeighbors, trueDistances);
+
+  SpillKNN::Tree tree(referenceSet, tuner.Tau(), tuner.LeafSize());
+  SpillKNN spill(std::move(tree), SINGLE_TREE_MODE);
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  spill.Search(querySet, k, neighbors, distances);
+
+  BOOST_REQUIRE_GE(SpillKNN::Recall(neighbors, trueNeighbors), 0.8);
+}
+
+/**
+ * Make sure that SpillTreeTuner uses the given candidates, and that it stops
+ * at the smallest tau that reaches the target.
+ */
+BOOST_AUTO_TEST_CASE(SpillTreeTunerCandidatesTest)
+{
+  arma::mat dataset(3, 500, arma::fill::randu);
+
+  // A tau larger than the diameter of the dataset makes every node
+  // non-overlapping, so the search is exact.
+  SpillTreeTuner tuner(1.0);
+  tuner.Taus() = { 10.0, 20.0 };
+  tuner.LeafSizes() = { 15 };
+  tuner.Tune(dataset, dataset, 3);
+
+  BOOST_REQUIRE_EQUAL(tuner.Tau(), 10.0);
+  BOOST_REQUIRE_EQUAL(tuner.LeafSize(), 15);
+  BOOST_REQUIRE_CLOSE(tuner.Recall(), 1.0, 1e-5);
+}
+
+/**
+ * Make sure that SpillTreeTuner rejects invalid parameters.
+ */
+BOOST_AUTO_TEST_CASE(SpillTreeTunerInvalidTest)
+{
+  arma::mat dataset(3, 100, arma::fill::randu);
+
+  BOOST_REQUIRE_THROW(SpillTreeTuner(0.0), std::invalid_argument);
+  BOOST_REQUIRE_THROW(SpillTreeTuner(1.5), std::invalid_argument);
+  BOOST_REQUIRE_THROW(SpillTreeTuner(0.9, 0), std::invalid_argument);
+  BOOST_REQUIRE_THROW(SpillTreeTuner(0.9, 100, 2.0), std::invalid_argument);
+
+  SpillTreeTuner tuner;
+  BOOST_REQUIRE_THROW(tuner.Tune(dataset, dataset, 0), std::invalid_argument);
+  BOOST_REQUIRE_THROW(tuner.Tune(dataset, dataset, 101),
+      std::invalid_argument);
+
+  arma::mat wrongDimensions(4, 10, arma::fill::randu);
+  BOOST_REQUIRE_THROW(tuner.Tune(dataset, wrongDimensions, 3),
+      std::invalid_argument);
+
+  tuner.Taus() = { -1.0 };
+  BOOST_REQUIRE_THROW(tuner.Tune(dataset, dataset, 3), std::invalid_argument);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
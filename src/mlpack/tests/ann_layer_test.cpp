@@ -387,6 +387,31 @@ BOOST_AUTO_TEST_CASE(DropoutProbabilityTest)
   }
 }
 
+/**
+ * Make sure the dropout mask is reproducible for a fixed seed.
+ */
+BOOST_AUTO_TEST_CASE(DropoutReproducibleMaskTest)
+{
+  arma::mat input = arma::ones(300, 4);
+
+  Dropout<> module(0.5);
+  module.Deterministic() = false;
+
+  math::RandomSeed(5);
+  arma::mat output;
+  module.Forward(std::move(input), std::move(output));
+
+  arma::mat otherOutput;
+  module.Forward(std::move(input), std::move(otherOutput));
+  BOOST_REQUIRE_GT(arma::accu(output != otherOutput), 0);
+
+  math::RandomSeed(5);
+  module.Forward(std::move(input), std::move(otherOutput));
+  CheckMatrices(output, otherOutput);
+
+  math::RandomSeed(std::time(NULL));
+}
+
 /*
  * Perform dropout with probability 1 - p where p = 0, means no dropout.
  */
@@ -778,6 +803,123 @@ BOOST_AUTO_TEST_CASE(GradientLSTMLayerTest)
   BOOST_REQUIRE_LE(CheckGradient(function), 1e-4);
 }
 
+/**
+ * Test that the LSTM layer gives the same results for a batch of sequences as
+ * for each sequence on its own.
+ */
+BOOST_AUTO_TEST_CASE(BatchLSTMLayerTest)
+{
+  const size_t rho = 3;
+  LSTM<> module(4, 3, rho);
+  module.Parameters().randn();
+  module.Reset();
+
+  arma::cube input(4, 2, rho, arma::fill::randu);
+  arma::cube output(3, 2, rho);
+  for (size_t t = 0; t < rho; t++)
+  {
+    arma::mat step = input.slice(t);
+    arma::mat stepOutput;
+    module.Forward(std::move(step), std::move(stepOutput));
+    output.slice(t) = stepOutput;
+  }
+
+  for (size_t i = 0; i < input.n_cols; i++)
+  {
+    for (size_t t = 0; t < rho; t++)
+    {
+      arma::mat step = input.slice(t).col(i);
+      arma::mat stepOutput;
+      module.Forward(std::move(step), std::move(stepOutput));
+      CheckMatrices(stepOutput, arma::mat(output.slice(t).col(i)));
+    }
+  }
+}
+
+/**
+ * Test that LSTMLayoutVisitor rearranges the parameters of the LSTM layers of
+ * old models (the input weights, the biases, then the recurrent weights) into
+ * the stacked layout, also in nested modules, and leaves the other layers as
+ * they are.
+ */
+BOOST_AUTO_TEST_CASE(LSTMLayoutVisitorTest)
+{
+  Linear<> linear(5, 4);
+  LSTM<> lstm(4, 3, 5);
+  Sequential<> sequential;
+  sequential.Add(&lstm);
+  std::vector<LayerTypes> network = { &linear, &sequential };
+
+  // The Linear layer has 24 parameters.  The LSTM layer has 48 input weights,
+  // 36 recurrent weights and 12 biases.
+  arma::mat stacked(120, 1, arma::fill::randu);
+  arma::mat parameters = stacked;
+  parameters.rows(72, 83) = stacked.rows(108, 119);
+  parameters.rows(84, 119) = stacked.rows(72, 107);
+
+  size_t offset = 0;
+  for (LayerTypes& layer : network)
+  {
+    offset += boost::apply_visitor(LSTMLayoutVisitor(parameters, offset),
+        layer);
+  }
+
+  BOOST_REQUIRE_EQUAL(offset, 120);
+  CheckMatrices(parameters, stacked);
+}
+
+/**
+ * Test that a padded sequence with a given length gives the same objective,
+ * gradient and predictions as the sequence without padding, also with
+ * truncated BPTT over the whole sequence.
+ */
+BOOST_AUTO_TEST_CASE(VariableLengthLSTMLayerTest)
+{
+  arma::mat input = arma::randu(5, 1);
+  arma::mat target = arma::mat("1; 2; 1; 3; 3");
+  arma::mat shortInput = input.rows(0, 2);
+  arma::mat shortTarget = target.rows(0, 2);
+
+  RNN<NegativeLogLikelihood<> > model(input, target, 5);
+  model.Add<IdentityLayer<> >();
+  model.Add<Linear<> >(1, 10);
+  model.Add<LSTM<> >(10, 3, 5);
+  model.Add<LogSoftMax<> >();
+  model.SequenceLengths() = arma::Row<size_t>("3");
+
+  RNN<NegativeLogLikelihood<> > shortModel(shortInput, shortTarget, 3);
+  shortModel.Add<IdentityLayer<> >();
+  shortModel.Add<Linear<> >(1, 10);
+  shortModel.Add<LSTM<> >(10, 3, 3);
+  shortModel.Add<LogSoftMax<> >();
+
+  // Initialize both models, then share the parameters.
+  const double error = model.Evaluate(model.Parameters(), 0);
+  shortModel.Evaluate(shortModel.Parameters(), 0);
+  shortModel.Parameters() = model.Parameters();
+
+  BOOST_REQUIRE_CLOSE(error, shortModel.Evaluate(shortModel.Parameters(), 0),
+      1e-5);
+
+  arma::mat gradient, shortGradient;
+  model.Gradient(model.Parameters(), 0, gradient);
+  shortModel.Gradient(shortModel.Parameters(), 0, shortGradient);
+  CheckMatrices(gradient, shortGradient);
+
+  model.BPTTSteps() = 3;
+  model.Gradient(model.Parameters(), 0, gradient);
+  CheckMatrices(gradient, shortGradient);
+
+  // The predictions of the padding steps are zero.
+  arma::mat predictions, shortPredictions;
+  model.Predict(input, predictions, arma::Row<size_t>("3"));
+  shortModel.Predict(shortInput, shortPredictions);
+
+  BOOST_REQUIRE_EQUAL(predictions.n_rows, 5 * 3);
+  CheckMatrices(arma::mat(predictions.rows(0, 8)), shortPredictions);
+  BOOST_REQUIRE_SMALL(arma::accu(arma::abs(predictions.rows(9, 14))), 1e-10);
+}
+
 /**
  * Simple concat module test.
  */
@@ -903,6 +1045,282 @@ BOOST_AUTO_TEST_CASE(SimpleLookupLayerTest)
   BOOST_REQUIRE_CLOSE(arma::accu(gradient), arma::accu(error), 1e-3);
 }
 
+/**
+ * Make sure that the sparse gradient mode of the lookup module only writes the
+ * columns of the used words, and sums the errors of repeated words.
+ */
+BOOST_AUTO_TEST_CASE(SparseLookupLayerGradientTest)
+{
+  Lookup<> module(10, 5);
+  module.Parameters().randu();
+  module.SparseGradient() = true;
+
+  arma::mat input("4; 2; 4");
+  arma::mat error = arma::randu<arma::mat>(5, 3);
+
+  // The other columns are left as they are.
+  arma::mat gradient = arma::ones<arma::mat>(5, 10);
+  module.Gradient(std::move(input), std::move(error), std::move(gradient));
+
+  BOOST_REQUIRE_EQUAL(module.GradientColumns().n_elem, 2);
+  BOOST_REQUIRE_EQUAL(module.GradientColumns()[0], 1);
+  BOOST_REQUIRE_EQUAL(module.GradientColumns()[1], 3);
+
+  for (size_t i = 0; i < 5; ++i)
+  {
+    BOOST_REQUIRE_CLOSE(gradient(i, 1), error(i, 1), 1e-5);
+    BOOST_REQUIRE_CLOSE(gradient(i, 3), error(i, 0) + error(i, 2), 1e-5);
+  }
+
+  BOOST_REQUIRE_CLOSE(arma::accu(gradient), 40.0 + arma::accu(error), 1e-5);
+}
+
+/**
+ * Convolution layer (using the Im2ColConvolution rule) numerically gradient
+ * test, with both the Winograd and the im2col paths.
+ */
+BOOST_AUTO_TEST_CASE(GradientIm2ColConvolutionLayerTest)
+{
+  typedef Convolution<Im2ColConvolution<ValidConvolution>,
+      Im2ColConvolution<FullConvolution>,
+      Im2ColConvolution<ValidConvolution> > Im2ColConvolutionLayer;
+
+  // Convolution function gradient instantiation.
+  struct GradientFunction
+  {
+    GradientFunction(const size_t k, const size_t d, const size_t pad)
+    {
+      input = arma::randu(2 * 6 * 6, 1);
+      target = arma::mat("1");
+
+      const size_t outputSize = (6 + 2 * pad - k) / d + 1;
+
+      model = new FFN<NegativeLogLikelihood<>, NguyenWidrowInitialization>(
+          input, target);
+      model->Add<Im2ColConvolutionLayer>(2, 3, k, k, d, d, pad, pad, 6, 6);
+      model->Add<Linear<> >(3 * outputSize * outputSize, 2);
+      model->Add<LogSoftMax<> >();
+    }
+
+    ~GradientFunction()
+    {
+      delete model;
+    }
+
+    double Gradient(arma::mat& gradient) const
+    {
+      double error = model->Evaluate(model->Parameters(), 0);
+      model->Gradient(model->Parameters(), 0, gradient);
+      return error;
+    }
+
+    arma::mat& Parameters() { return model->Parameters(); }
+
+    FFN<NegativeLogLikelihood<>, NguyenWidrowInitialization>* model;
+    arma::mat input, target;
+  };
+
+  // A padded 3x3 filter with unit stride (Winograd), and a 2x2 filter with
+  // stride 2 (im2col).
+  GradientFunction winograd(3, 1, 1);
+  BOOST_REQUIRE_LE(CheckGradient(winograd), 1e-4);
+
+  GradientFunction im2col(2, 2, 0);
+  BOOST_REQUIRE_LE(CheckGradient(im2col), 1e-4);
+}
+
+/**
+ * Convolution layer numerical gradient test, with the planned fft forward
+ * rule, whose filter transforms must follow the changes of the weights.
+ */
+BOOST_AUTO_TEST_CASE(GradientPlannedFFTConvolutionLayerTest)
+{
+  typedef Convolution<PlannedFFTConvolution,
+      Im2ColConvolution<FullConvolution>,
+      Im2ColConvolution<ValidConvolution> > PlannedFFTConvolutionLayer;
+
+  // Convolution function gradient instantiation.
+  struct GradientFunction
+  {
+    GradientFunction()
+    {
+      input = arma::randu(2 * 7 * 7, 1);
+      target = arma::mat("1");
+
+      model = new FFN<NegativeLogLikelihood<>, NguyenWidrowInitialization>(
+          input, target);
+      model->Add<PlannedFFTConvolutionLayer>(2, 3, 4, 4, 1, 1, 1, 1, 7, 7);
+      model->Add<Linear<> >(3 * 6 * 6, 2);
+      model->Add<LogSoftMax<> >();
+    }
+
+    ~GradientFunction()
+    {
+      delete model;
+    }
+
+    double Gradient(arma::mat& gradient) const
+    {
+      double error = model->Evaluate(model->Parameters(), 0);
+      model->Gradient(model->Parameters(), 0, gradient);
+      return error;
+    }
+
+    arma::mat& Parameters() { return model->Parameters(); }
+
+    FFN<NegativeLogLikelihood<>, NguyenWidrowInitialization>* model;
+    arma::mat input, target;
+  } function;
+
+  BOOST_REQUIRE_LE(CheckGradient(function), 1e-4);
+}
+
+/**
+ * Jacobian pooling module test, for the unrolled 2x2 and 3x3 windows and for
+ * a general window.
+ */
+BOOST_AUTO_TEST_CASE(JacobianPoolingLayerTest)
+{
+  const size_t kW[] = { 2, 3, 3 };
+  const size_t kH[] = { 2, 3, 2 };
+  const size_t dW[] = { 2, 1, 1 };
+  const size_t dH[] = { 2, 1, 2 };
+
+  for (size_t t = 0; t < 3; t++)
+  {
+    arma::mat input;
+    input.set_size(6 * 5 * 2, 1);
+
+    MaxPooling<> maxPooling(kW[t], kH[t], dW[t], dH[t]);
+    maxPooling.InputWidth() = 6;
+    maxPooling.InputHeight() = 5;
+
+    double error = JacobianTest(maxPooling, input);
+    BOOST_REQUIRE_LE(error, 1e-5);
+
+    MeanPooling<> meanPooling(kW[t], kH[t], dW[t], dH[t]);
+    meanPooling.InputWidth() = 6;
+    meanPooling.InputHeight() = 5;
+
+    error = JacobianTest(meanPooling, input);
+    BOOST_REQUIRE_LE(error, 1e-5);
+  }
+}
+
+/**
+ * Test that the pooling modules give the same results for a batch of points
+ * as for each point on its own.
+ */
+BOOST_AUTO_TEST_CASE(BatchPoolingLayerTest)
+{
+  arma::mat input = arma::randu(6 * 5 * 2, 4);
+  arma::mat error = arma::randu(3 * 2 * 2, 4);
+
+  MaxPooling<> maxPooling(2, 2, 2, 2);
+  maxPooling.InputWidth() = 6;
+  maxPooling.InputHeight() = 5;
+
+  MeanPooling<> meanPooling(2, 2, 2, 2);
+  meanPooling.InputWidth() = 6;
+  meanPooling.InputHeight() = 5;
+
+  arma::mat maxOutput, maxDelta, meanOutput, meanDelta;
+  maxPooling.Forward(std::move(input), std::move(maxOutput));
+  maxPooling.Backward(std::move(input), std::move(error), std::move(maxDelta));
+  meanPooling.Forward(std::move(input), std::move(meanOutput));
+  meanPooling.Backward(std::move(input), std::move(error),
+      std::move(meanDelta));
+
+  BOOST_REQUIRE_EQUAL(maxOutput.n_rows, 3 * 2 * 2);
+  BOOST_REQUIRE_EQUAL(maxOutput.n_cols, 4);
+  BOOST_REQUIRE_EQUAL(maxDelta.n_rows, input.n_rows);
+  BOOST_REQUIRE_EQUAL(maxDelta.n_cols, 4);
+
+  for (size_t i = 0; i < input.n_cols; i++)
+  {
+    arma::mat point = input.col(i);
+    arma::mat pointError = error.col(i);
+    arma::mat output, delta;
+
+    maxPooling.Forward(std::move(point), std::move(output));
+    maxPooling.Backward(std::move(point), std::move(pointError),
+        std::move(delta));
+    CheckMatrices(output, arma::mat(maxOutput.col(i)));
+    CheckMatrices(delta, arma::mat(maxDelta.col(i)));
+
+    meanPooling.Forward(std::move(point), std::move(output));
+    meanPooling.Backward(std::move(point), std::move(pointError),
+        std::move(delta));
+    CheckMatrices(output, arma::mat(meanOutput.col(i)));
+    CheckMatrices(delta, arma::mat(meanDelta.col(i)));
+  }
+}
+
+/**
+ * Make sure that the glimpses of a batch are those of its images, and that the
+ * backward pass of the glimpse layer is the transpose of its forward pass.
+ */
+BOOST_AUTO_TEST_CASE(BatchGlimpseLayerTest)
+{
+  const size_t width = 12;
+  const size_t height = 10;
+  const size_t imageSize = width * height;
+
+  for (size_t scale = 2; scale <= 3; ++scale)
+  {
+    // Every patch of a constant image is constant, while the crops are in the
+    // image.
+    Glimpse<> constantModule(1, 2, 2, scale, width, height);
+    constantModule.Deterministic() = true;
+    arma::mat constantInput = arma::ones(imageSize + 2, 3);
+    constantInput.rows(imageSize, imageSize + 1).zeros();
+    arma::mat constantOutput;
+    constantModule.Forward(std::move(constantInput),
+        std::move(constantOutput));
+    CheckMatrices(constantOutput, arma::ones(2 * 2 * 2, 3));
+
+    // The largest crops stick out of the image.
+    Glimpse<> module(1, 2, 3, scale, width, height);
+    module.Deterministic() = true;
+
+    arma::mat input = arma::randu(imageSize + 2, 5);
+    input.rows(imageSize, imageSize + 1) = 2 * input.rows(imageSize,
+        imageSize + 1) - 1;
+    input(imageSize, 4) = -1;
+    input(imageSize + 1, 4) = 1;
+
+    arma::mat output;
+    module.Forward(std::move(input), std::move(output));
+    BOOST_REQUIRE_EQUAL(output.n_rows, 3 * 2 * 2);
+    BOOST_REQUIRE_EQUAL(output.n_cols, 5);
+
+    for (size_t i = 0; i < input.n_cols; ++i)
+    {
+      arma::mat single = arma::zeros(imageSize, 2);
+      single.col(0) = input.submat(0, i, imageSize - 1, i);
+      single.submat(0, 1, 1, 1) = input.submat(imageSize, i, imageSize + 1, i);
+
+      arma::mat singleOutput;
+      module.Forward(std::move(single), std::move(singleOutput));
+      CheckMatrices(singleOutput, arma::mat(output.col(i)));
+    }
+
+    // The glimpses are linear in the images, and the locations get no error.
+    module.Deterministic() = false;
+    module.Forward(std::move(input), std::move(output));
+
+    arma::mat error = arma::randu(output.n_rows, output.n_cols);
+    arma::mat delta;
+    module.Backward(std::move(input), std::move(error), std::move(delta));
+    BOOST_REQUIRE_EQUAL(delta.n_rows, input.n_rows);
+    BOOST_REQUIRE_EQUAL(delta.n_cols, input.n_cols);
+    BOOST_REQUIRE_SMALL(arma::accu(arma::abs(delta.rows(imageSize,
+        imageSize + 1))), 1e-10);
+    BOOST_REQUIRE_CLOSE(arma::accu(output % error), arma::accu(
+        input.rows(0, imageSize - 1) % delta.rows(0, imageSize - 1)), 1e-8);
+  }
+}
+
 /**
  * Simple LogSoftMax module test.
  */
@@ -0,0 +1,66 @@
+/**
+ * @file async_learning_test.cpp
+ *
+ * Test the asynchronous actor-learner training of Q-networks.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include <mlpack/core.hpp>
+
+#include <mlpack/core/optimizers/rmsprop/rmsprop.hpp>
+#include <mlpack/methods/ann/layer/layer.hpp>
+#include <mlpack/methods/ann/ffn.hpp>
+#include <mlpack/methods/ann/init_rules/gaussian_init.hpp>
+#include <mlpack/methods/reinforcement_learning/environment/cart_pole.hpp>
+#include <mlpack/methods/reinforcement_learning/async_learning.hpp>
+
+#include <boost/test/unit_test.hpp>
+#include "test_tools.hpp"
+
+using namespace mlpack;
+using namespace mlpack::ann;
+using namespace mlpack::optimization;
+using namespace mlpack::rl;
+
+BOOST_AUTO_TEST_SUITE(AsyncLearningTest);
+
+/**
+ * Train a small Q-network on CartPole with a few actors, and make sure that
+ * the actors collect experience, the learner trains the network, and the
+ * parameters are published.
+ */
+BOOST_AUTO_TEST_CASE(CartPoleAsyncLearningTest)
+{
+  FFN<MeanSquaredError<>, GaussianInitialization> network(
+      MeanSquaredError<>(), GaussianInitialization(0, 0.001));
+  network.Add<Linear<>>(4, 32);
+  network.Add<ReLULayer<>>();
+  network.Add<Linear<>>(32, 2);
+  network.ResetParameters();
+  const arma::mat initialParameters = network.Parameters();
+
+  RMSProp<decltype(network)> optimizer(network, 0.001, 0.99, 1e-8, 16);
+  RandomReplay<CartPole> replay(16, 10000);
+
+  AsyncLearning<CartPole, decltype(network), decltype(optimizer)> learning(
+      network, optimizer, replay, 3, 0.99, 25, 64);
+  learning.Train(200);
+
+  BOOST_REQUIRE_EQUAL(learning.LearnerSteps(), 200);
+  BOOST_REQUIRE_EQUAL(learning.Publications(), 8);
+  BOOST_REQUIRE_GE(learning.ActorSteps(), 64);
+  BOOST_REQUIRE_GT(learning.Episodes(), 0);
+  BOOST_REQUIRE_GE(replay.Size(), 64);
+  BOOST_REQUIRE_GT(arma::abs(network.Parameters() - initialParameters).max(),
+      0.0);
+
+  // Training can go on.
+  learning.Train(50);
+  BOOST_REQUIRE_EQUAL(learning.LearnerSteps(), 250);
+  BOOST_REQUIRE_EQUAL(learning.Publications(), 10);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -68,4 +68,24 @@ BOOST_AUTO_TEST_CASE(BinerizeAll)
   BOOST_REQUIRE_CLOSE(output(2, 2), 1.0, 1e-5); // 9
 }
 
+/**
+ * Make sure the in-place overloads give the same results as the others.
+ */
+BOOST_AUTO_TEST_CASE(BinarizeInPlace)
+{
+  mat input = randu<mat>(7, 100);
+  const double threshold = 0.5;
+
+  mat output;
+  mat inPlace(input);
+  Binarize<double>(input, output, threshold);
+  Binarize<double>(inPlace, threshold);
+  CheckMatrices(inPlace, output);
+
+  inPlace = input;
+  Binarize<double>(input, output, threshold, 3);
+  Binarize<double>(inPlace, threshold, 3);
+  CheckMatrices(inPlace, output);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
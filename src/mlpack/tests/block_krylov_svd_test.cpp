@@ -88,6 +88,43 @@ BOOST_AUTO_TEST_CASE(RandomizedBlockKrylovSVDReconstructionError)
   BOOST_REQUIRE_SMALL(error, 1e-5);
 }
 
+/**
+ * The reconstruction and sigular value error of the SVD obtained with a
+ * CountSketch starting block should be small.
+ */
+BOOST_AUTO_TEST_CASE(RandomizedBlockKrylovSVDCountSketchReconstructionError)
+{
+  arma::mat U = arma::randn<arma::mat>(100, 3);
+  arma::mat V = arma::randn<arma::mat>(200, 3);
+
+  arma::mat R;
+  arma::qr_econ(U, R, U);
+  arma::qr_econ(V, R, V);
+
+  arma::mat data = U * arma::diagmat(arma::vec("1 0.1 0.01")) * V.t();
+
+  arma::mat U1, U2, V1, V2;
+  arma::vec s1, s2, s3;
+
+  arma::svd_econ(U1, s1, V1, data);
+
+  svd::RandomizedBlockKrylovSVD rSVD(5, 10, svd::RandomSketch::COUNT_SKETCH);
+  rSVD.Apply(data, U2, s2, V2, 3);
+
+  // Use the same amount of data for the comparison.
+  s3 = s1.subvec(0, s2.n_elem - 1);
+
+  // The sigular value error should be small.
+  double error = arma::norm(s2 - s3, "frob") / arma::norm(s2, "frob");
+  BOOST_REQUIRE_SMALL(error, 1e-5);
+
+  arma::mat reconstruct = U2 * arma::diagmat(s2) * V2.t();
+
+  // The relative reconstruction error should be small.
+  error = arma::norm(data - reconstruct, "frob") / arma::norm(data, "frob");
+  BOOST_REQUIRE_SMALL(error, 1e-5);
+}
+
 /*
  * Check if the method can handle noisy matrices.
  */
@@ -466,6 +466,173 @@ BOOST_AUTO_TEST_CASE(EmptyConstructorTrainTest)
   }
 }
 
+/**
+ * Make sure that each user is recommended the unrated items with the highest
+ * average estimated rating by its neighborhood, best first.
+ */
+BOOST_AUTO_TEST_CASE(RecommendationsAreBestUnratedItemsTest)
+{
+  arma::sp_mat data;
+  data.sprandu(80, 60, 0.3);
+  data.col(7).ones(); // User 7 rated every item.
+
+  CF c(data, amf::NMFALSFactorizer(), 4, 5);
+
+  const size_t numRecs = 6;
+  arma::Mat<size_t> recommendations;
+  c.GetRecommendations(numRecs, recommendations);
+  BOOST_REQUIRE_EQUAL(recommendations.n_rows, numRecs);
+  BOOST_REQUIRE_EQUAL(recommendations.n_cols, 60);
+
+  // Find the neighborhoods with a new search on the stretched H matrix.
+  arma::mat stretchedH = arma::chol(c.W().t() * c.W()) * c.H();
+  neighbor::KNN knn(stretchedH);
+  arma::Mat<size_t> neighborhood;
+  arma::mat distances;
+  knn.Search(stretchedH, 4, neighborhood, distances);
+
+  for (size_t u = 0; u < 60; ++u)
+  {
+    arma::vec averages(80, arma::fill::zeros);
+    for (size_t j = 0; j < neighborhood.n_rows; ++j)
+      averages += c.W() * c.H().col(neighborhood(j, u));
+    averages /= neighborhood.n_rows;
+
+    if (u == 7)
+    {
+      for (size_t p = 0; p < numRecs; ++p)
+        BOOST_REQUIRE_EQUAL(recommendations(p, u), 80);
+      continue;
+    }
+
+    // The recommendations are unrated, in decreasing order, and no unrated
+    // item that wasn't recommended is better than the last one.
+    for (size_t p = 0; p < numRecs; ++p)
+    {
+      BOOST_REQUIRE_EQUAL((double) data(recommendations(p, u), u), 0.0);
+      if (p > 0)
+      {
+        BOOST_REQUIRE_LE(averages[recommendations(p, u)],
+            averages[recommendations(p - 1, u)] + 1e-10);
+      }
+    }
+
+    const double worst = averages[recommendations(numRecs - 1, u)];
+    for (size_t i = 0; i < 80; ++i)
+    {
+      if ((double) data(i, u) == 0.0 &&
+          arma::all(recommendations.col(u) != i))
+        BOOST_REQUIRE_LE(averages[i], worst + 1e-10);
+    }
+  }
+}
+
+/**
+ * Make sure that searching the items with FastMKS gives the same
+ * recommendations as estimating the rating of every item, and that LSH gives
+ * unrated items.
+ */
+BOOST_AUTO_TEST_CASE(ItemSearchTest)
+{
+  arma::sp_mat data;
+  data.sprandu(200, 50, 0.2);
+
+  CF c(data, amf::NMFALSFactorizer(), 5, 4);
+
+  arma::Mat<size_t> exhaustive, fastmks, lsh;
+  c.GetRecommendations(8, exhaustive);
+  c.GetRecommendations(8, fastmks, FASTMKS_ITEM_SEARCH);
+  c.GetRecommendations(8, lsh, LSH_ITEM_SEARCH);
+
+  CheckMatrices(exhaustive, fastmks);
+
+  BOOST_REQUIRE_EQUAL(lsh.n_rows, 8);
+  BOOST_REQUIRE_EQUAL(lsh.n_cols, 50);
+  for (size_t u = 0; u < lsh.n_cols; ++u)
+  {
+    for (size_t p = 0; p < lsh.n_rows; ++p)
+    {
+      BOOST_REQUIRE_LE(lsh(p, u), 200);
+      if (lsh(p, u) < 200)
+        BOOST_REQUIRE_EQUAL((double) data(lsh(p, u), u), 0.0);
+    }
+  }
+
+  // The item index is rebuilt after training again.
+  c.Train(data);
+  c.GetRecommendations(8, exhaustive);
+  c.GetRecommendations(8, fastmks, FASTMKS_ITEM_SEARCH);
+  CheckMatrices(exhaustive, fastmks);
+}
+
+/**
+ * Make sure Update() folds a new user into a model of low-rank ratings, and
+ * replaces the ratings that are given again.
+ */
+BOOST_AUTO_TEST_CASE(UpdateTest)
+{
+  const size_t numItems = 60;
+  const size_t numUsers = 40;
+  const arma::mat items = arma::randu(numItems, 3);
+  const arma::mat users = arma::randu(3, numUsers);
+  const arma::mat ratings = items * users;
+
+  // All the users but the last one rate every item.
+  arma::mat data(3, (numUsers - 1) * numItems);
+  for (size_t u = 0; u < numUsers - 1; ++u)
+  {
+    for (size_t i = 0; i < numItems; ++i)
+    {
+      data(0, u * numItems + i) = u;
+      data(1, u * numItems + i) = i;
+      data(2, u * numItems + i) = ratings(i, u);
+    }
+  }
+
+  CF c(data, amf::NMFALSFactorizer(), 5, 3);
+  BOOST_REQUIRE_EQUAL(c.H().n_cols, numUsers - 1);
+
+  // The last user rates the first two thirds of the items, and the first user
+  // rates the first item again.
+  arma::mat newData(3, 41);
+  for (size_t i = 0; i < 40; ++i)
+  {
+    newData(0, i) = numUsers - 1;
+    newData(1, i) = i;
+    newData(2, i) = ratings(i, numUsers - 1);
+  }
+  newData(0, 40) = 0;
+  newData(1, 40) = 0;
+  newData(2, 40) = ratings(0, 0) + 0.5;
+
+  c.Update(newData);
+
+  BOOST_REQUIRE_EQUAL(c.CleanedData().n_rows, numItems);
+  BOOST_REQUIRE_EQUAL(c.CleanedData().n_cols, numUsers);
+  BOOST_REQUIRE_EQUAL(c.CleanedData().n_nonzero, numUsers * numItems - 20);
+  BOOST_REQUIRE_CLOSE((double) c.CleanedData()(0, 0), ratings(0, 0) + 0.5,
+      1e-5);
+  BOOST_REQUIRE_EQUAL(c.W().n_rows, numItems);
+  BOOST_REQUIRE_EQUAL(c.H().n_cols, numUsers);
+
+  // The ratings of the items the new user hasn't rated are predicted by its
+  // factors.
+  const arma::vec predicted = c.W().tail_rows(20) * c.H().col(numUsers - 1);
+  const arma::vec truth = ratings.col(numUsers - 1).tail(20);
+  BOOST_REQUIRE_SMALL(arma::norm(predicted - truth) / arma::norm(truth), 0.1);
+
+  // Recommendations can be made for the new user.
+  arma::Mat<size_t> recommendations;
+  c.GetRecommendations(5, recommendations,
+      arma::Col<size_t>({ numUsers - 1 }));
+  for (size_t p = 0; p < 5; ++p)
+    BOOST_REQUIRE_GE(recommendations(p, 0), 40);
+
+  // An untrained model can't be updated.
+  CF untrained;
+  BOOST_REQUIRE_THROW(untrained.Update(newData), std::invalid_argument);
+}
+
 /**
  * Ensure we can load and save the CF model.
  */
@@ -541,6 +708,17 @@ BOOST_AUTO_TEST_CASE(SerializationTest)
     BOOST_REQUIRE_CLOSE(c.CleanedData().values[i],
         cText.CleanedData().values[i], 1e-5);
   }
+
+  // The loaded models give the same recommendations, with the user index they
+  // stored.
+  arma::Mat<size_t> recommendations, xmlRecommendations, binaryRecommendations,
+      textRecommendations;
+  c.GetRecommendations(5, recommendations);
+  cXml.GetRecommendations(5, xmlRecommendations);
+  cBinary.GetRecommendations(5, binaryRecommendations);
+  cText.GetRecommendations(5, textRecommendations);
+  CheckMatrices(recommendations, xmlRecommendations, binaryRecommendations,
+      textRecommendations);
 }
 
 
@@ -10,6 +10,7 @@
  * http://www.opensource.org/licenses/BSD-3-Clause for more information.
  */
 #include <mlpack/core.hpp>
+#include <mlpack/core/util/model_server.hpp>
 
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
@@ -41,6 +42,14 @@ void AddRequiredCLIOptions()
   CLI::Add<bool>(false, "verbose", "Display informational messages and the full"
       " list of parameters and timers at the end of execution.", 'v');
   CLI::Add<bool>(false, "version", "Display the version of mlpack.", 'V');
+  CLI::Add<string>("", "profile_file", "If specified, the time spent by each "
+      "thread in each profiled region is saved to this file as a Chrome trace "
+      "(JSON).");
+  CLI::Add<bool>(false, "perf_counters", "If set, hardware performance "
+      "counters are read around each program timer on Linux.");
+  CLI::Add<string>("", "perf_counters_file", "If specified, hardware "
+      "performance counters are read around each program timer on Linux, and "
+      "saved to this file as CSV.");
 }
 
 /**
@@ -1111,4 +1120,73 @@ BOOST_AUTO_TEST_CASE(RawDatasetInfoLoadParameter)
   remove("test.arff");
 }
 
+/**
+ * Make sure the model server answers requests and errors with the documented
+ * protocol.
+ */
+BOOST_AUTO_TEST_CASE(ModelServerTest)
+{
+  arma::mat first = arma::randu<arma::mat>(3, 5);
+  arma::mat second = arma::randu<arma::mat>(2, 4);
+
+  // Two requests, one of which fails, and the end of the session.
+  std::stringstream input;
+  uint64_t header[2] = { first.n_rows, first.n_cols };
+  input.write((const char*) header, sizeof(header));
+  input.write((const char*) first.memptr(), sizeof(double) * first.n_elem);
+  header[0] = second.n_rows;
+  header[1] = second.n_cols;
+  input.write((const char*) header, sizeof(header));
+  input.write((const char*) second.memptr(), sizeof(double) * second.n_elem);
+  header[0] = header[1] = 0;
+  input.write((const char*) header, sizeof(header));
+
+  // The handler doubles three-dimensional points, and sums them.
+  std::stringstream output;
+  util::ModelServer server(input, output);
+  const size_t requests = server.Serve(
+      [](arma::mat& request, std::vector<arma::mat>& response)
+      {
+        if (request.n_rows != 3)
+          throw std::invalid_argument("bad dimensionality");
+
+        response.resize(2);
+        response[0] = 2 * request;
+        response[1] = arma::sum(request, 1);
+      });
+  BOOST_REQUIRE_EQUAL(requests, 2);
+
+  uint64_t value;
+  output.read((char*) &value, sizeof(value));
+  BOOST_REQUIRE_EQUAL(value, 0);
+  output.read((char*) &value, sizeof(value));
+  BOOST_REQUIRE_EQUAL(value, 2);
+
+  arma::mat expected[2] = { 2 * first, arma::sum(first, 1) };
+  for (size_t i = 0; i < 2; ++i)
+  {
+    output.read((char*) header, sizeof(header));
+    arma::mat matrix(header[0], header[1]);
+    output.read((char*) matrix.memptr(), sizeof(double) * matrix.n_elem);
+    CheckMatrices(matrix, expected[i]);
+  }
+
+  output.read((char*) &value, sizeof(value));
+  BOOST_REQUIRE_EQUAL(value, 1);
+  output.read((char*) &value, sizeof(value));
+  std::string message(value, ' ');
+  output.read(&message[0], value);
+  BOOST_REQUIRE_EQUAL(message, "bad dimensionality");
+
+  // A truncated request is an error.
+  std::stringstream truncated;
+  header[0] = 3;
+  header[1] = 5;
+  truncated.write((const char*) header, sizeof(header));
+  truncated.write((const char*) first.memptr(), sizeof(double) * 7);
+  util::ModelServer truncatedServer(truncated, output);
+  BOOST_REQUIRE_THROW(truncatedServer.Serve(
+      [](arma::mat&, std::vector<arma::mat>&) { }), std::runtime_error);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -16,6 +16,8 @@
 #include <mlpack/methods/ann/convolution_rules/naive_convolution.hpp>
 #include <mlpack/methods/ann/convolution_rules/fft_convolution.hpp>
 #include <mlpack/methods/ann/convolution_rules/svd_convolution.hpp>
+#include <mlpack/methods/ann/convolution_rules/im2col_convolution.hpp>
+#include <mlpack/methods/ann/convolution_rules/planned_fft_convolution.hpp>
 
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
@@ -149,6 +151,10 @@ BOOST_AUTO_TEST_CASE(ValidConvolution2DTest)
   // speeded up the computation.
   Convolution2DMethodTest<SVDConvolution<ValidConvolution> >(input, filter,
       output);
+
+  // Perform the convolution by lowering it to a matrix product.
+  Convolution2DMethodTest<Im2ColConvolution<ValidConvolution> >(input, filter,
+      output);
 }
 
 /**
@@ -186,6 +192,10 @@ BOOST_AUTO_TEST_CASE(FullConvolution2DTest)
   // speeded up the computation.
   Convolution2DMethodTest<SVDConvolution<FullConvolution> >(input, filter,
       output);
+
+  // Perform the convolution by lowering it to a matrix product.
+  Convolution2DMethodTest<Im2ColConvolution<FullConvolution> >(input, filter,
+      output);
 }
 
 /**
@@ -231,6 +241,10 @@ BOOST_AUTO_TEST_CASE(ValidConvolution3DTest)
   // speeded up the computation.
   Convolution3DMethodTest<SVDConvolution<ValidConvolution> >(inputCube,
       filterCube, outputCube);
+
+  // Perform the convolution by lowering it to a matrix product.
+  Convolution3DMethodTest<Im2ColConvolution<ValidConvolution> >(inputCube,
+      filterCube, outputCube);
 }
 
 /**
@@ -280,6 +294,10 @@ BOOST_AUTO_TEST_CASE(FullConvolution3DTest)
   // speeded up the computation.
   Convolution3DMethodTest<SVDConvolution<FullConvolution> >(inputCube,
       filterCube, outputCube);
+
+  // Perform the convolution by lowering it to a matrix product.
+  Convolution3DMethodTest<Im2ColConvolution<FullConvolution> >(inputCube,
+      filterCube, outputCube);
 }
 
 /**
@@ -322,6 +340,10 @@ BOOST_AUTO_TEST_CASE(ValidConvolutionBatchTest)
   // speeded up the computation.
   ConvolutionMethodBatchTest<SVDConvolution<ValidConvolution> >(input,
       filterCube, outputCube);
+
+  // Perform the convolution by lowering it to a matrix product.
+  ConvolutionMethodBatchTest<Im2ColConvolution<ValidConvolution> >(input,
+      filterCube, outputCube);
 }
 
 /**
@@ -368,6 +390,101 @@ BOOST_AUTO_TEST_CASE(FullConvolutionBatchTest)
   // speeded up the computation.
   ConvolutionMethodBatchTest<SVDConvolution<FullConvolution> >(input,
       filterCube, outputCube);
+
+  // Perform the convolution by lowering it to a matrix product.
+  ConvolutionMethodBatchTest<Im2ColConvolution<FullConvolution> >(input,
+      filterCube, outputCube);
+}
+
+/**
+ * Test that Im2ColConvolution::MapsConvolution() (through im2col and through
+ * the Winograd transform) matches the sum of the naive convolutions of each
+ * input map.
+ */
+BOOST_AUTO_TEST_CASE(Im2ColMapsConvolutionTest)
+{
+  const size_t inSize = 2;
+  const size_t outSize = 3;
+
+  // The 3x3 filters use the Winograd transform; the 2x2 filters and the
+  // strided 3x3 filters use im2col.
+  const size_t kernels[] = { 3, 2, 3 };
+  const size_t strides[] = { 1, 1, 2 };
+  for (size_t t = 0; t < 3; t++)
+  {
+    const size_t k = kernels[t];
+    const size_t d = strides[t];
+
+    arma::cube input(7, 6, inSize, arma::fill::randu);
+    arma::cube filters(k, k, outSize * inSize, arma::fill::randn);
+
+    arma::cube output;
+    Im2ColConvolution<ValidConvolution>::MapsConvolution(input, filters,
+        output, d, d);
+
+    BOOST_REQUIRE_EQUAL(output.n_rows, (7 - k) / d + 1);
+    BOOST_REQUIRE_EQUAL(output.n_cols, (6 - k) / d + 1);
+    BOOST_REQUIRE_EQUAL(output.n_slices, outSize);
+
+    for (size_t o = 0; o < outSize; o++)
+    {
+      arma::mat expected = arma::zeros(output.n_rows, output.n_cols);
+      for (size_t i = 0; i < inSize; i++)
+      {
+        arma::mat convOutput;
+        NaiveConvolution<ValidConvolution>::Convolution(input.slice(i),
+            filters.slice(o * inSize + i), convOutput);
+
+        // Naive convolution with unit stride; subsample it.
+        for (size_t r = 0; r < output.n_rows; r++)
+          for (size_t c = 0; c < output.n_cols; c++)
+            expected(r, c) += convOutput(r * d, c * d);
+      }
+
+      for (size_t j = 0; j < expected.n_elem; j++)
+        BOOST_REQUIRE_CLOSE(output.slice(o)[j], expected[j], 1e-5);
+    }
+  }
+}
+
+/**
+ * Convolve all the maps through fft with cached filter transforms, and compare
+ * with im2col.
+ */
+BOOST_AUTO_TEST_CASE(PlannedFFTMapsConvolutionTest)
+{
+  const size_t inSize = 3;
+  const size_t outSize = 2;
+
+  // The transform sizes are products of 2, 3 and 5.
+  BOOST_REQUIRE_EQUAL(PlannedFFTConvolution::TransformSize(7), 8);
+  BOOST_REQUIRE_EQUAL(PlannedFFTConvolution::TransformSize(11), 12);
+  BOOST_REQUIRE_EQUAL(PlannedFFTConvolution::TransformSize(31), 32);
+
+  PlannedFFTConvolution rule;
+  arma::cube input(11, 9, inSize, arma::fill::randu);
+  arma::cube filters(4, 3, outSize * inSize, arma::fill::randn);
+
+  const size_t dW[] = { 1, 2, 1 };
+  const size_t dH[] = { 1, 3, 1 };
+  for (size_t t = 0; t < 3; t++)
+  {
+    arma::cube output, expected;
+    rule.MapsConvolution(input, filters, output, dW[t], dH[t]);
+    Im2ColConvolution<ValidConvolution>::MapsConvolution(input, filters,
+        expected, dW[t], dH[t]);
+
+    BOOST_REQUIRE_EQUAL(output.n_rows, expected.n_rows);
+    BOOST_REQUIRE_EQUAL(output.n_cols, expected.n_cols);
+    BOOST_REQUIRE_EQUAL(output.n_slices, expected.n_slices);
+    for (size_t j = 0; j < expected.n_elem; j++)
+      BOOST_REQUIRE_CLOSE(output[j], expected[j], 1e-5);
+
+    // The filter transforms are reused until the filters change.
+    BOOST_REQUIRE_EQUAL(rule.FilterTransforms(), (t == 2) ? 2 : 1);
+    if (t == 1)
+      filters.randn();
+  }
 }
 
 BOOST_AUTO_TEST_SUITE_END();
@@ -222,4 +222,61 @@ BOOST_AUTO_TEST_CASE(CosineTreeModifiedGramSchmidt)
   }
 }
 
+/**
+ * Checks CosineTree::BlockGramSchmidt() by orthonormalizing blocks of random
+ * vectors against a growing basis, and checking that the basis stays
+ * orthonormal and spans the vectors.
+ */
+BOOST_AUTO_TEST_CASE(CosineTreeBlockGramSchmidt)
+{
+  const size_t numRows = 100;
+  const size_t blockSize = 5;
+
+  arma::mat basis(numRows, 0);
+  for (size_t i = 0; i < 6; i++)
+  {
+    arma::mat vectors = arma::randu(numRows, blockSize);
+    arma::mat original = vectors;
+    CosineTree::BlockGramSchmidt(basis, vectors);
+
+    basis.insert_cols(basis.n_cols, vectors);
+
+    // The basis should be orthonormal.
+    arma::mat gram = basis.t() * basis;
+    arma::mat identity = arma::eye(basis.n_cols, basis.n_cols);
+    BOOST_REQUIRE_SMALL(arma::norm(gram - identity, "fro"), 1e-10);
+
+    // The original vectors should be in the span of the basis.
+    arma::mat residual = original - basis * (basis.t() * original);
+    BOOST_REQUIRE_SMALL(arma::norm(residual, "fro"), 1e-10);
+  }
+}
+
+/**
+ * Splitting several nodes at each step should still give an orthonormal basis
+ * that captures the dataset.
+ */
+BOOST_AUTO_TEST_CASE(CosineTreeBatchSplit)
+{
+  arma::mat data = arma::randu(50, 500);
+
+  CosineTree ctree(data, 0.05, 0.1, 4);
+  arma::mat basis;
+  ctree.GetFinalBasis(basis);
+
+  BOOST_REQUIRE_GT(basis.n_cols, 1);
+
+  // The nonzero basis vectors should be orthonormal.
+  arma::uvec nonzero = arma::find(arma::sum(arma::square(basis), 0) > 0.5);
+  arma::mat used = basis.cols(nonzero);
+  arma::mat gram = used.t() * used;
+  BOOST_REQUIRE_SMALL(arma::norm(gram - arma::eye(used.n_cols, used.n_cols),
+      "fro"), 1e-8);
+
+  // The projection onto the basis should keep most of the dataset.
+  const double error = arma::norm(data - used * (used.t() * data), "fro") /
+      arma::norm(data, "fro");
+  BOOST_REQUIRE_LT(error, 0.5);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
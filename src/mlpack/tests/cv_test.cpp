@@ -9,12 +9,14 @@
  * http://www.opensource.org/licenses/BSD-3-Clause for more information.
  */
 
+#include <mlpack/core/cv/k_fold_cv.hpp>
 #include <mlpack/core/cv/metrics/accuracy.hpp>
 #include <mlpack/core/cv/metrics/mse.hpp>
 #include <mlpack/core/optimizers/rmsprop/rmsprop.hpp>
 #include <mlpack/methods/ann/ffn.hpp>
 #include <mlpack/methods/ann/init_rules/zero_init.hpp>
 #include <mlpack/methods/ann/layer/layer.hpp>
+#include <mlpack/methods/lars/lars.hpp>
 #include <mlpack/methods/linear_regression/linear_regression.hpp>
 #include <mlpack/methods/logistic_regression/logistic_regression.hpp>
 
@@ -90,4 +92,100 @@ BOOST_AUTO_TEST_CASE(MSEMatResponsesTest)
   BOOST_REQUIRE_CLOSE(MSE::Evaluate(ffn, data, responses), expectedMSE, 1e-1);
 }
 
+/**
+ * Make a noisy linear regression problem.
+ */
+void LinearProblem(arma::mat& data, arma::rowvec& responses)
+{
+  data.randn(5, 180);
+  const arma::rowvec weights("1 2 3 4 5");
+  responses = weights * data + 0.1 * arma::randn<arma::rowvec>(180);
+}
+
+/*
+ * Test that k-fold cross-validation trains on every fold, and that the
+ * validation error of a good model is the noise.
+ */
+BOOST_AUTO_TEST_CASE(KFoldCVEvaluateTest)
+{
+  arma::mat data;
+  arma::rowvec responses;
+  LinearProblem(data, responses);
+
+  KFoldCV<arma::mat, arma::rowvec> cv(7, data, responses);
+  BOOST_REQUIRE_EQUAL(cv.K(), 7);
+  BOOST_REQUIRE_EQUAL(cv.NumPoints(), 180);
+
+  const double mse = cv.Evaluate<MSE>(LinearRegression(),
+      [](LinearRegression& model, const arma::mat& data,
+         const arma::rowvec& responses) { model.Train(data, responses); });
+
+  BOOST_REQUIRE_EQUAL(cv.Trainings(), 7);
+  BOOST_REQUIRE_LT(mse, 0.02);
+  BOOST_REQUIRE_GT(mse, 0.005);
+}
+
+/*
+ * Test grid search over the lambda path of LARS, with and without warm starts.
+ */
+BOOST_AUTO_TEST_CASE(KFoldCVGridSearchTest)
+{
+  arma::mat data;
+  arma::rowvec responses;
+  LinearProblem(data, responses);
+
+  KFoldCV<arma::mat, arma::rowvec> cv(5, data, responses);
+
+  const std::vector<double> lambdas = { 1e4, 100.0, 1e-4 };
+  auto train = [](LARS& model, const double& lambda, const arma::mat& data,
+      const arma::rowvec& responses)
+  {
+    model = LARS(true, lambda);
+    model.Train(data, responses);
+  };
+
+  arma::vec scores, warmScores;
+  const size_t best = cv.GridSearch<MSE>(LARS(), lambdas, train, scores);
+  const size_t warmBest = cv.GridSearch<MSE>(LARS(), lambdas, train,
+      warmScores, true);
+
+  BOOST_REQUIRE_EQUAL(best, 2);
+  BOOST_REQUIRE_EQUAL(warmBest, 2);
+  BOOST_REQUIRE_GT(scores[0], scores[1]);
+  BOOST_REQUIRE_GT(scores[1], scores[2]);
+  for (size_t c = 0; c < lambdas.size(); ++c)
+    BOOST_REQUIRE_CLOSE(scores[c], warmScores[c], 1e-5);
+  BOOST_REQUIRE_EQUAL(cv.Trainings(), 2 * 3 * 5);
+}
+
+/*
+ * Test that successive halving drops the bad configurations early.
+ */
+BOOST_AUTO_TEST_CASE(KFoldCVSuccessiveHalvingTest)
+{
+  arma::mat data;
+  arma::rowvec responses;
+  LinearProblem(data, responses);
+
+  KFoldCV<arma::mat, arma::rowvec> cv(9, data, responses);
+
+  const std::vector<double> lambdas = { 1e4, 1e3, 100.0, 10.0, 1.0, 0.1, 0.01,
+      1e-3, 1e-4 };
+  arma::vec scores;
+  const size_t best = cv.SuccessiveHalving<MSE>(LARS(), lambdas,
+      [](LARS& model, const double& lambda, const arma::mat& data,
+         const arma::rowvec& responses)
+      {
+        model = LARS(true, lambda);
+        model.Train(data, responses);
+      }, scores, 3);
+
+  // The nine configurations are evaluated on one fold, the best three on two
+  // more, and the best one on the remaining six, instead of 81 trainings for a
+  // full grid search.
+  BOOST_REQUIRE_EQUAL(cv.Trainings(), 9 + 3 * 2 + 6);
+  BOOST_REQUIRE_LT(lambdas[best], 10.0);
+  BOOST_REQUIRE_LT(scores[best], scores[0]);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -11,6 +11,7 @@
  */
 #include <mlpack/core.hpp>
 #include <mlpack/methods/dbscan/dbscan.hpp>
+#include <mlpack/methods/emst/union_find.hpp>
 
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
@@ -271,4 +272,165 @@ BOOST_AUTO_TEST_CASE(GaussiansSingleModeTest)
   }
 }
 
+/**
+ * Check that core points, border points and noise are told apart: a chain of
+ * points that is connected, but where no point has enough neighbors, is noise.
+ */
+BOOST_AUTO_TEST_CASE(CoreAndBorderPointsTest)
+{
+  // Points 0 to 3 are core points, point 4 is a border point of their cluster,
+  // and points 5 to 8 are noise.
+  arma::mat points("0.0 0.05 0.1 0.12 0.26 10.0 10.14 10.28 10.42");
+
+  for (size_t batch = 0; batch < 2; ++batch)
+  {
+    DBSCAN<> d(0.15, 4, batch == 1);
+
+    arma::Row<size_t> assignments;
+    const size_t clusters = d.Cluster(points, assignments);
+
+    BOOST_REQUIRE_EQUAL(clusters, 1);
+    for (size_t i = 0; i < 5; ++i)
+      BOOST_REQUIRE_EQUAL(assignments[i], 0);
+    for (size_t i = 5; i < 9; ++i)
+      BOOST_REQUIRE_EQUAL(assignments[i], SIZE_MAX);
+  }
+}
+
+/**
+ * Make sure that the concurrent union-find structure finds the same components
+ * as the serial one, and that the root of each component is its smallest
+ * element.
+ */
+BOOST_AUTO_TEST_CASE(ConcurrentUnionFindTest)
+{
+  const size_t size = 5000;
+  arma::Mat<size_t> pairs = arma::randi<arma::Mat<size_t>>(2, 3000,
+      arma::distr_param(0, size - 1));
+
+  emst::UnionFind serial(size);
+  for (size_t i = 0; i < pairs.n_cols; ++i)
+    serial.Union(pairs(0, i), pairs(1, i));
+
+  ConcurrentUnionFind concurrent(size);
+  #pragma omp parallel for
+  for (intmax_t i = 0; i < (intmax_t) pairs.n_cols; ++i)
+    concurrent.Union(pairs(0, i), pairs(1, i));
+
+  std::vector<size_t> smallest(size, SIZE_MAX);
+  for (size_t i = 0; i < size; ++i)
+    smallest[serial.Find(i)] = std::min(smallest[serial.Find(i)], i);
+
+  for (size_t i = 0; i < size; ++i)
+    BOOST_REQUIRE_EQUAL(concurrent.Find(i), smallest[serial.Find(i)]);
+}
+
+/**
+ * Make sure that DBSCAN with grid-based range search gives the same clusters as
+ * with tree-based range search, in 2 and 3 dimensions, in batch mode and
+ * otherwise.
+ */
+BOOST_AUTO_TEST_CASE(GridDBSCANTest)
+{
+  for (size_t dims = 2; dims < 4; ++dims)
+  {
+    arma::mat points(dims, 3000, arma::fill::randu);
+    // Add a dense blob, so that some cells are full of core points.
+    points.cols(0, 499) = 0.5 + 0.01 * arma::randu<arma::mat>(dims, 500);
+
+    for (size_t batch = 0; batch < 2; ++batch)
+    {
+      arma::Row<size_t> assignments, gridAssignments;
+
+      DBSCAN<> d(0.04, 5, batch == 1);
+      const size_t clusters = d.Cluster(points, assignments);
+
+      DBSCAN<GridRangeSearch> grid(0.04, 5, batch == 1);
+      const size_t gridClusters = grid.Cluster(points, gridAssignments);
+
+      BOOST_REQUIRE_GT(clusters, 1);
+      BOOST_REQUIRE_EQUAL(clusters, gridClusters);
+      for (size_t i = 0; i < points.n_cols; ++i)
+        BOOST_REQUIRE_EQUAL(assignments[i], gridAssignments[i]);
+    }
+  }
+}
+
+/**
+ * Make sure that GridRangeSearch finds the same neighbors as naive range
+ * search with a generic callback, including for a range that doesn't start at
+ * 0 and for query points outside of the grid.
+ */
+BOOST_AUTO_TEST_CASE(GridRangeSearchTest)
+{
+  arma::mat referenceSet(2, 500, arma::fill::randu);
+  arma::mat querySet = 1.2 * arma::randu<arma::mat>(2, 300) - 0.1;
+
+  GridRangeSearch grid;
+  grid.Train(referenceSet);
+
+  range::RangeSearch<> naive(referenceSet, true);
+
+  const math::Range ranges[] = { math::Range(0.0, 0.1),
+                                 math::Range(0.05, 0.15) };
+  for (size_t r = 0; r < 2; ++r)
+  {
+    std::vector<std::vector<size_t>> neighbors(querySet.n_cols),
+        naiveNeighbors;
+    std::vector<std::vector<double>> distances(querySet.n_cols),
+        naiveDistances;
+    range::RangeSearchVectorCallback callback(neighbors, distances);
+    grid.Search(querySet, ranges[r], callback);
+    naive.Search(querySet, ranges[r], naiveNeighbors, naiveDistances);
+
+    for (size_t i = 0; i < querySet.n_cols; ++i)
+    {
+      std::sort(neighbors[i].begin(), neighbors[i].end());
+      std::sort(naiveNeighbors[i].begin(), naiveNeighbors[i].end());
+
+      BOOST_REQUIRE_EQUAL(neighbors[i].size(), naiveNeighbors[i].size());
+      for (size_t j = 0; j < neighbors[i].size(); ++j)
+        BOOST_REQUIRE_EQUAL(neighbors[i][j], naiveNeighbors[i][j]);
+    }
+  }
+
+  // High-dimensional data isn't supported.
+  arma::mat highDimensional(GridRangeSearch::MaxDimensionality + 1, 10,
+      arma::fill::randu);
+  BOOST_REQUIRE_THROW(grid.Train(highDimensional), std::invalid_argument);
+}
+
+#ifdef HAS_OPENMP
+/**
+ * Make sure that DBSCAN gives the same clusters with one thread and with four
+ * threads, in batch mode and otherwise.
+ */
+BOOST_AUTO_TEST_CASE(ParallelDBSCANTest)
+{
+  arma::mat points(2, 3000, arma::fill::randu);
+  const size_t prevNumThreads = omp_get_max_threads();
+
+  for (size_t batch = 0; batch < 2; ++batch)
+  {
+    arma::Row<size_t> assignments, parallelAssignments;
+
+    omp_set_num_threads(1);
+    DBSCAN<> d(0.02, 5, batch == 1);
+    const size_t clusters = d.Cluster(points, assignments);
+
+    omp_set_num_threads(4);
+    DBSCAN<> parallel(0.02, 5, batch == 1);
+    const size_t parallelClusters = parallel.Cluster(points,
+        parallelAssignments);
+
+    BOOST_REQUIRE_GT(clusters, 1);
+    BOOST_REQUIRE_EQUAL(clusters, parallelClusters);
+    for (size_t i = 0; i < points.n_cols; ++i)
+      BOOST_REQUIRE_EQUAL(assignments[i], parallelAssignments[i]);
+  }
+
+  omp_set_num_threads(prevNumThreads);
+}
+#endif
+
 BOOST_AUTO_TEST_SUITE_END();
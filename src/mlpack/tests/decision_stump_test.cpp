@@ -391,4 +391,49 @@ BOOST_AUTO_TEST_CASE(IntTest)
   BOOST_CHECK_EQUAL(predictedLabels(0, 7), 2);
 }
 
+/**
+ * Make sure that training with a DecisionStumpIndex gives the same stumps as
+ * weighted training, round after round with different weights.
+ */
+BOOST_AUTO_TEST_CASE(DecisionStumpIndexTest)
+{
+  arma::mat data = arma::randu<arma::mat>(4, 500);
+  data.row(2).fill(1.0); // This dimension can't be split on.
+  arma::Row<size_t> labels(500);
+  for (size_t i = 0; i < 500; ++i)
+    labels[i] = (data(1, i) + 0.3 * data(3, i) > 0.7) ? 2 :
+        ((data(0, i) > 0.5) ? 1 : 0);
+
+  DecisionStumpIndex<> index(data, labels, 3, 5);
+  BOOST_REQUIRE_EQUAL(index.Classes(), 3);
+  BOOST_REQUIRE_EQUAL(index.BucketSize(), 5);
+
+  // The same stump is trained several times, so each training must also clear
+  // the bins of the previous one.
+  DecisionStump<> stump, indexStump;
+  for (size_t round = 0; round < 5; ++round)
+  {
+    arma::rowvec weights = arma::randu<arma::rowvec>(500);
+    weights /= arma::accu(weights);
+
+    stump.Train(data, labels, weights, 3, 5);
+    indexStump.Train(index, weights);
+
+    BOOST_REQUIRE_EQUAL(stump.SplitDimension(), indexStump.SplitDimension());
+    BOOST_REQUIRE_EQUAL(stump.Split().n_elem, indexStump.Split().n_elem);
+    BOOST_REQUIRE_EQUAL(stump.BinLabels().n_elem,
+        indexStump.BinLabels().n_elem);
+    for (size_t i = 0; i < stump.Split().n_elem; ++i)
+    {
+      BOOST_REQUIRE_EQUAL(stump.Split()[i], indexStump.Split()[i]);
+      BOOST_REQUIRE_EQUAL(stump.BinLabels()[i], indexStump.BinLabels()[i]);
+    }
+
+    // The stump must match a stump trained from scratch.
+    DecisionStump<> newStump(stump, data, labels, weights);
+    BOOST_REQUIRE_EQUAL(newStump.SplitDimension(), stump.SplitDimension());
+    BOOST_REQUIRE_EQUAL(newStump.Split().n_elem, stump.Split().n_elem);
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -463,6 +463,167 @@ BOOST_AUTO_TEST_CASE(BestBinaryNumericSplitNoGainTest)
   BOOST_REQUIRE_EQUAL(classProbabilities.n_elem, 0);
 }
 
+/**
+ * Check that the HistogramNumericSplit will split on an obviously splittable
+ * dimension.
+ */
+BOOST_AUTO_TEST_CASE(HistogramNumericSplitSimpleSplitTest)
+{
+  arma::vec values("0.0 0.1 0.2 0.3 0.4 0.5 0.6 0.7 0.8 0.9 1.0");
+  arma::Row<size_t> labels("0 0 0 0 0 1 1 1 1 1 1");
+  arma::rowvec weights(labels.n_elem);
+  weights.ones();
+
+  arma::vec classProbabilities;
+  HistogramNumericSplit<GiniGain>::template AuxiliarySplitInfo<double> aux;
+
+  // Call the method to do the splitting.
+  const double bestGain = GiniGain::Evaluate<false>(labels, 2, weights);
+  const double gain = HistogramNumericSplit<GiniGain>::SplitIfBetter<false>(
+      bestGain, values, labels, 2, weights, 3, classProbabilities, aux);
+  const double weightedGain =
+      HistogramNumericSplit<GiniGain>::SplitIfBetter<true>(bestGain, values,
+      labels, 2, weights, 3, classProbabilities, aux);
+
+  // Make sure that a split was made.
+  BOOST_REQUIRE_GT(gain, bestGain);
+
+  // Make sure weight works and make no different with no weighted one
+  BOOST_REQUIRE_EQUAL(gain, weightedGain);
+
+  // The split is perfect, so we should be able to accomplish a gain of 0.
+  BOOST_REQUIRE_SMALL(gain, 1e-5);
+
+  // The class probabilities, for this split, hold the splitting point, which
+  // should be between 4 and 5.
+  BOOST_REQUIRE_EQUAL(classProbabilities.n_elem, 1);
+  BOOST_REQUIRE_GT(classProbabilities[0], 0.4);
+  BOOST_REQUIRE_LT(classProbabilities[0], 0.5);
+}
+
+/**
+ * Check that the HistogramNumericSplit won't split if not enough points are
+ * given.
+ */
+BOOST_AUTO_TEST_CASE(HistogramNumericSplitMinSamplesTest)
+{
+  arma::vec values("0.0 0.1 0.2 0.3 0.4 0.5 0.6 0.7 0.8 0.9 1.0");
+  arma::Row<size_t> labels("0 0 0 0 0 1 1 1 1 1 1");
+  arma::rowvec weights(labels.n_elem, arma::fill::ones);
+
+  arma::vec classProbabilities;
+  HistogramNumericSplit<GiniGain>::template AuxiliarySplitInfo<double> aux;
+
+  // Call the method to do the splitting.
+  const double bestGain = GiniGain::Evaluate<false>(labels, 2, weights);
+  const double gain = HistogramNumericSplit<GiniGain>::SplitIfBetter<false>(
+      bestGain, values, labels, 2, weights, 8, classProbabilities, aux);
+  // This should make no difference because it won't split at all.
+  const double weightedGain =
+      HistogramNumericSplit<GiniGain>::SplitIfBetter<true>(bestGain, values,
+      labels, 2, weights, 8, classProbabilities, aux);
+
+  // Make sure that no split was made.
+  BOOST_REQUIRE_EQUAL(gain, bestGain);
+  BOOST_REQUIRE_EQUAL(gain, weightedGain);
+  BOOST_REQUIRE_EQUAL(classProbabilities.n_elem, 0);
+}
+
+/**
+ * Check that the HistogramNumericSplit doesn't split a dimension that gives no
+ * gain.
+ */
+BOOST_AUTO_TEST_CASE(HistogramNumericSplitNoGainTest)
+{
+  arma::vec values(100);
+  arma::Row<size_t> labels(100);
+  arma::rowvec weights;
+  for (size_t i = 0; i < 100; i += 2)
+  {
+    values[i] = i;
+    labels[i] = 0;
+    values[i + 1] = i;
+    labels[i + 1] = 1;
+  }
+
+  arma::vec classProbabilities;
+  HistogramNumericSplit<GiniGain>::template AuxiliarySplitInfo<double> aux;
+
+  // Call the method to do the splitting.
+  const double bestGain = GiniGain::Evaluate<false>(labels, 2, weights);
+  const double gain = HistogramNumericSplit<GiniGain>::SplitIfBetter<false>(
+      bestGain, values, labels, 2, weights, 10, classProbabilities, aux);
+
+  // Make sure there was no split.
+  BOOST_REQUIRE_EQUAL(gain, bestGain);
+  BOOST_REQUIRE_EQUAL(classProbabilities.n_elem, 0);
+}
+
+/**
+ * Check that the HistogramNumericSplit finds the same split as the
+ * BestBinaryNumericSplit when there are few distinct values, with both fitness
+ * functions and with weights.
+ */
+BOOST_AUTO_TEST_CASE(HistogramNumericSplitExactTest)
+{
+  arma::vec values(1000);
+  arma::Row<size_t> labels(1000);
+  arma::rowvec weights(1000);
+  for (size_t i = 0; i < 1000; ++i)
+  {
+    values[i] = math::RandInt(0, 200) / 10.0;
+    labels[i] = (values[i] + math::Random(-5.0, 5.0) > 10.0) ? 1 : 0;
+    weights[i] = math::Random();
+  }
+
+  arma::vec classProbabilities, histogramClassProbabilities;
+  BestBinaryNumericSplit<GiniGain>::template AuxiliarySplitInfo<double> aux;
+  HistogramNumericSplit<GiniGain>::template AuxiliarySplitInfo<double>
+      histogramAux;
+  BestBinaryNumericSplit<InformationGain>::template
+      AuxiliarySplitInfo<double> infoAux;
+  HistogramNumericSplit<InformationGain>::template
+      AuxiliarySplitInfo<double> infoHistogramAux;
+
+  const double bestGain = GiniGain::Evaluate<false>(labels, 2, weights);
+  const double gain = BestBinaryNumericSplit<GiniGain>::SplitIfBetter<false>(
+      bestGain, values, labels, 2, weights, 10, classProbabilities, aux);
+  const double histogramGain =
+      HistogramNumericSplit<GiniGain>::SplitIfBetter<false>(bestGain, values,
+      labels, 2, weights, 10, histogramClassProbabilities, histogramAux);
+  BOOST_REQUIRE_CLOSE(histogramGain, gain, 1e-5);
+  BOOST_REQUIRE_EQUAL(histogramClassProbabilities.n_elem, 1);
+  BOOST_REQUIRE_CLOSE(histogramClassProbabilities[0], classProbabilities[0],
+      1e-5);
+
+  const double weightedBestGain = GiniGain::Evaluate<true>(labels, 2,
+      weights);
+  const double weightedGain =
+      BestBinaryNumericSplit<GiniGain>::SplitIfBetter<true>(weightedBestGain,
+      values, labels, 2, weights, 10, classProbabilities, aux);
+  const double histogramWeightedGain =
+      HistogramNumericSplit<GiniGain>::SplitIfBetter<true>(weightedBestGain,
+      values, labels, 2, weights, 10, histogramClassProbabilities,
+      histogramAux);
+  BOOST_REQUIRE_CLOSE(histogramWeightedGain, weightedGain, 1e-5);
+  BOOST_REQUIRE_CLOSE(histogramClassProbabilities[0], classProbabilities[0],
+      1e-5);
+
+  const double infoBestGain = InformationGain::Evaluate<false>(labels, 2,
+      weights);
+  const double infoGain =
+      BestBinaryNumericSplit<InformationGain>::SplitIfBetter<false>(
+      infoBestGain, values, labels, 2, weights, 10, classProbabilities,
+      infoAux);
+  const double histogramInfoGain =
+      HistogramNumericSplit<InformationGain>::SplitIfBetter<false>(
+      infoBestGain, values, labels, 2, weights, 10,
+      histogramClassProbabilities, infoHistogramAux);
+  BOOST_REQUIRE_CLOSE(histogramInfoGain, infoGain, 1e-5);
+  BOOST_REQUIRE_CLOSE(histogramClassProbabilities[0], classProbabilities[0],
+      1e-5);
+}
+
 /**
  * Check that the AllCategoricalSplit will split when the split is obviously
  * better.
@@ -1069,4 +1230,259 @@ BOOST_AUTO_TEST_CASE(CategoricalInformationGainWeightedBuildTest)
   BOOST_REQUIRE_GT(correctPct, 0.70);
 }
 
+/**
+ * Test that a decision tree with histogram-based splits generalizes as well as
+ * one that tries every split, on a dataset with many distinct values.
+ */
+BOOST_AUTO_TEST_CASE(HistogramDecisionTreeTest)
+{
+  arma::mat dataset, testDataset;
+  arma::Row<size_t> labels, testLabels;
+  for (size_t i = 0; i < 2; ++i)
+  {
+    arma::mat& d = (i == 0) ? dataset : testDataset;
+    arma::Row<size_t>& l = (i == 0) ? labels : testLabels;
+    d.randu(4, 10000);
+    l.set_size(10000);
+    for (size_t j = 0; j < 10000; ++j)
+      l[j] = (d(0, j) + d(1, j) > 1.0) ? ((d(2, j) > 0.3) ? 1 : 2) : 0;
+  }
+
+  DecisionTree<GiniGain, HistogramNumericSplit> tree(dataset, labels, 3, 10);
+  DecisionTree<> exactTree(dataset, labels, 3, 10);
+
+  arma::Row<size_t> predictions, exactPredictions;
+  tree.Classify(testDataset, predictions);
+  exactTree.Classify(testDataset, exactPredictions);
+
+  BOOST_REQUIRE_EQUAL(predictions.n_elem, testDataset.n_cols);
+
+  const double correct = arma::accu(predictions == testLabels) /
+      (double) testLabels.n_elem;
+  const double exactCorrect = arma::accu(exactPredictions == testLabels) /
+      (double) testLabels.n_elem;
+
+  BOOST_REQUIRE_GT(correct, 0.95);
+  BOOST_REQUIRE_GT(correct, exactCorrect - 0.02);
+}
+
+#ifdef HAS_OPENMP
+/**
+ * Check that two decision trees have the same structure and give the same
+ * class probabilities for every point of the given dataset.
+ */
+template<typename TreeType>
+void CheckSameTree(const TreeType& a, const TreeType& b, const arma::mat& data)
+{
+  arma::Row<size_t> predictions, otherPredictions;
+  arma::mat probabilities, otherProbabilities;
+  a.Classify(data, predictions, probabilities);
+  b.Classify(data, otherPredictions, otherProbabilities);
+
+  BOOST_REQUIRE_EQUAL(arma::accu(predictions != otherPredictions), 0);
+  BOOST_REQUIRE_EQUAL(arma::accu(probabilities != otherProbabilities), 0);
+
+  std::vector<std::pair<const TreeType*, const TreeType*>> stack;
+  stack.push_back(std::make_pair(&a, &b));
+  while (!stack.empty())
+  {
+    const TreeType* node = stack.back().first;
+    const TreeType* otherNode = stack.back().second;
+    stack.pop_back();
+
+    BOOST_REQUIRE_EQUAL(node->NumChildren(), otherNode->NumChildren());
+    for (size_t i = 0; i < node->NumChildren(); ++i)
+      stack.push_back(std::make_pair(&node->Child(i), &otherNode->Child(i)));
+  }
+}
+
+/**
+ * Make sure that a decision tree trained with several threads is the same as
+ * one trained with one thread, on numeric data with and without weights.  The
+ * dataset is big enough that the dimensions of the root and the subtrees near
+ * it are handled as separate tasks.
+ */
+BOOST_AUTO_TEST_CASE(ParallelDecisionTreeTest)
+{
+  arma::mat dataset(8, 20000, arma::fill::randu);
+  arma::Row<size_t> labels(20000);
+  for (size_t i = 0; i < 20000; ++i)
+  {
+    labels[i] = (dataset(1, i) + 0.3 * mlpack::math::Random() > 0.6) ?
+        ((dataset(4, i) > 0.5) ? 2 : 1) : 0;
+  }
+  arma::rowvec weights(20000, arma::fill::randu);
+
+  const size_t prevNumThreads = omp_get_max_threads();
+  omp_set_num_threads(std::max(prevNumThreads, (size_t) 4));
+
+  DecisionTree<> parallelTree(dataset, labels, 3, 5);
+  DecisionTree<> parallelWeightedTree(dataset, labels, 3, weights, 5);
+  DecisionTree<GiniGain, HistogramNumericSplit> parallelHistogramTree(dataset,
+      labels, 3, 5);
+
+  omp_set_num_threads(1);
+
+  DecisionTree<> tree(dataset, labels, 3, 5);
+  DecisionTree<> weightedTree(dataset, labels, 3, weights, 5);
+  DecisionTree<GiniGain, HistogramNumericSplit> histogramTree(dataset, labels,
+      3, 5);
+
+  omp_set_num_threads(prevNumThreads);
+
+  CheckSameTree(tree, parallelTree, dataset);
+  CheckSameTree(weightedTree, parallelWeightedTree, dataset);
+  CheckSameTree(histogramTree, parallelHistogramTree, dataset);
+}
+
+/**
+ * Make sure that a decision tree trained with several threads on categorical
+ * data is the same as one trained with one thread.
+ */
+BOOST_AUTO_TEST_CASE(ParallelCategoricalDecisionTreeTest)
+{
+  arma::mat d;
+  arma::Row<size_t> l;
+  data::DatasetInfo di;
+  MockCategoricalData(d, l, di);
+
+  // Make the dataset bigger than the threshold for parallel training.
+  arma::mat dataset = arma::repmat(d, 1, 2);
+  arma::Row<size_t> labels = arma::repmat(l, 1, 2);
+
+  const size_t prevNumThreads = omp_get_max_threads();
+  omp_set_num_threads(std::max(prevNumThreads, (size_t) 4));
+
+  DecisionTree<> parallelTree(dataset, di, labels, 5, 10);
+
+  omp_set_num_threads(1);
+
+  DecisionTree<> tree(dataset, di, labels, 5, 10);
+
+  omp_set_num_threads(prevNumThreads);
+
+  CheckSameTree(tree, parallelTree, dataset);
+}
+#endif
+
+/**
+ * Make sure that the FlatTree classifies the given points exactly as the tree
+ * it was built from, one at a time and all at once.
+ */
+template<typename TreeType>
+void CheckFlatTree(const TreeType& tree,
+                   const FlatTree<>& flatTree,
+                   const arma::mat& data)
+{
+  arma::Row<size_t> predictions, flatPredictions, flatPredictions2;
+  arma::mat probabilities, flatProbabilities;
+  tree.Classify(data, predictions, probabilities);
+  flatTree.Classify(data, flatPredictions, flatProbabilities);
+  flatTree.Classify(data, flatPredictions2);
+
+  BOOST_REQUIRE_EQUAL(flatPredictions.n_elem, data.n_cols);
+  BOOST_REQUIRE_EQUAL(flatProbabilities.n_rows, probabilities.n_rows);
+  BOOST_REQUIRE_EQUAL(flatProbabilities.n_cols, data.n_cols);
+  for (size_t i = 0; i < data.n_cols; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(predictions[i], flatPredictions[i]);
+    BOOST_REQUIRE_EQUAL(predictions[i], flatPredictions2[i]);
+    BOOST_REQUIRE_EQUAL(predictions[i], flatTree.Classify(data.col(i)));
+
+    size_t prediction;
+    arma::vec pointProbabilities;
+    flatTree.Classify(data.col(i), prediction, pointProbabilities);
+    BOOST_REQUIRE_EQUAL(prediction, predictions[i]);
+    for (size_t j = 0; j < probabilities.n_rows; ++j)
+    {
+      BOOST_REQUIRE_EQUAL(probabilities(j, i), flatProbabilities(j, i));
+      BOOST_REQUIRE_EQUAL(probabilities(j, i), pointProbabilities[j]);
+    }
+  }
+}
+
+/**
+ * Make sure that a FlatTree classifies points exactly as the decision tree it
+ * was built from, on numeric and on categorical data.
+ */
+BOOST_AUTO_TEST_CASE(FlatDecisionTreeTest)
+{
+  arma::mat dataset(5, 3000, arma::fill::randu);
+  arma::Row<size_t> labels(3000);
+  for (size_t i = 0; i < 3000; ++i)
+  {
+    labels[i] = (dataset(1, i) + 0.3 * mlpack::math::Random() > 0.6) ?
+        ((dataset(4, i) > 0.5) ? 2 : 1) : 0;
+  }
+  arma::mat testData(5, 1000, arma::fill::randu);
+
+  DecisionTree<> tree(dataset, labels, 3, 5);
+  DecisionTree<GiniGain, HistogramNumericSplit> histogramTree(dataset, labels,
+      3, 5);
+  FlatTree<> flatTree(tree);
+  FlatTree<> flatHistogramTree(histogramTree);
+
+  BOOST_REQUIRE_GT(flatTree.NumNodes(), 1);
+  BOOST_REQUIRE_GT(flatTree.Depth(), 0);
+  CheckFlatTree(tree, flatTree, dataset);
+  CheckFlatTree(tree, flatTree, testData);
+  CheckFlatTree(histogramTree, flatHistogramTree, testData);
+
+  arma::mat categoricalData;
+  arma::Row<size_t> categoricalLabels;
+  data::DatasetInfo di;
+  MockCategoricalData(categoricalData, categoricalLabels, di);
+  DecisionTree<> categoricalTree(categoricalData, di, categoricalLabels, 5,
+      10);
+  FlatTree<> flatCategoricalTree(categoricalTree);
+
+  BOOST_REQUIRE_GT(flatCategoricalTree.NumNodes(), 1);
+  CheckFlatTree(categoricalTree, flatCategoricalTree, categoricalData);
+}
+
+/**
+ * Make sure that a FlatTree of a tree with no splits predicts the majority
+ * class, and that a default FlatTree predicts class 0.
+ */
+BOOST_AUTO_TEST_CASE(FlatDecisionTreeLeafTest)
+{
+  arma::mat dataset(3, 100, arma::fill::randu);
+  arma::Row<size_t> labels(100);
+  labels.fill(1);
+
+  DecisionTree<> tree(dataset, labels, 2);
+  FlatTree<> flatTree(tree);
+
+  BOOST_REQUIRE_EQUAL(flatTree.NumNodes(), 1);
+  BOOST_REQUIRE_EQUAL(flatTree.Depth(), 0);
+  CheckFlatTree(tree, flatTree, dataset);
+
+  FlatTree<> emptyTree;
+  BOOST_REQUIRE_EQUAL(emptyTree.Classify(dataset.col(0)), 0);
+}
+
+/**
+ * Make sure that a FlatTree can be serialized and deserialized.
+ */
+BOOST_AUTO_TEST_CASE(FlatDecisionTreeSerializationTest)
+{
+  arma::mat dataset(5, 1000, arma::fill::randu);
+  arma::Row<size_t> labels(1000);
+  for (size_t i = 0; i < 1000; ++i)
+    labels[i] = (dataset(3, i) > 0.4) ? ((dataset(0, i) > 0.7) ? 2 : 1) : 0;
+
+  DecisionTree<> tree(dataset, labels, 3, 5);
+  FlatTree<> flatTree(tree);
+  FlatTree<> xmlTree, textTree, binaryTree;
+
+  SerializeObjectAll(flatTree, xmlTree, textTree, binaryTree);
+
+  BOOST_REQUIRE_EQUAL(xmlTree.NumNodes(), flatTree.NumNodes());
+  BOOST_REQUIRE_EQUAL(textTree.NumNodes(), flatTree.NumNodes());
+  BOOST_REQUIRE_EQUAL(binaryTree.NumNodes(), flatTree.NumNodes());
+  CheckFlatTree(tree, xmlTree, dataset);
+  CheckFlatTree(tree, textTree, dataset);
+  CheckFlatTree(tree, binaryTree, dataset);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
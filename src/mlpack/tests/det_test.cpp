@@ -349,6 +349,40 @@ BOOST_AUTO_TEST_CASE(TestComputeValue)
   BOOST_REQUIRE_CLOSE(0.0, testDTree.ComputeValue(q4), 1e-10);
 }
 
+/**
+ * The batch ComputeValue() must give the same values as ComputeValue() on each
+ * point, including points out of the range of the tree.
+ */
+BOOST_AUTO_TEST_CASE(TestBatchComputeValue)
+{
+  arma::mat dataset = arma::randu<arma::mat>(3, 300);
+  arma::Col<size_t> oldFromNew(dataset.n_cols);
+  for (size_t i = 0; i < oldFromNew.n_elem; ++i)
+    oldFromNew[i] = i;
+
+  DTree<arma::mat> tree(dataset);
+  double alpha = tree.Grow(dataset, oldFromNew, false, 10, 5);
+
+  // Some of the queries are out of the range of the tree.
+  arma::mat queries = 1.2 * arma::randu<arma::mat>(3, 200) - 0.1;
+
+  for (size_t pass = 0; pass < 2; ++pass)
+  {
+    arma::vec values;
+    tree.ComputeValue(queries, values);
+
+    BOOST_REQUIRE_EQUAL(values.n_elem, queries.n_cols);
+    for (size_t i = 0; i < queries.n_cols; ++i)
+    {
+      const arma::vec query = queries.col(i);
+      BOOST_REQUIRE_CLOSE(values[i], tree.ComputeValue(query), 1e-10);
+    }
+
+    // Check the pruned tree too.
+    alpha = tree.PruneAndUpdate(alpha, dataset.n_cols, false);
+  }
+}
+
 BOOST_AUTO_TEST_CASE(TestVariableImportance)
 {
   arma::mat testData(3, 5);
@@ -778,4 +812,127 @@ BOOST_AUTO_TEST_CASE(MoveOperatorTest)
   BOOST_REQUIRE_CLOSE(testDTree2.Right()->SplitValue(), 0.5, 1e-5);
 }
 
+/**
+ * Make sure that growing the tree from sorted indices gives the same tree as
+ * the regular Grow() on a simple dataset.
+ */
+BOOST_AUTO_TEST_CASE(TestGrowSortedIndices)
+{
+  arma::mat testData(3, 5);
+
+  testData << 4 << 5 << 7 << 3 << 5 << arma::endr
+           << 5 << 0 << 1 << 7 << 1 << arma::endr
+           << 5 << 6 << 7 << 1 << 8 << arma::endr;
+
+  arma::Col<size_t> oTest(5);
+  oTest << 0 << 1 << 2 << 3 << 4;
+
+  arma::Mat<size_t> sortedIndices;
+  DTree<arma::mat>::SortIndices(testData, sortedIndices);
+
+  DTree<arma::mat> testDTree(testData);
+  testDTree.Grow(testData, sortedIndices, oTest, false, 2, 1);
+
+  BOOST_REQUIRE_EQUAL(oTest[0], 0);
+  BOOST_REQUIRE_EQUAL(oTest[1], 3);
+  BOOST_REQUIRE_EQUAL(oTest[2], 1);
+  BOOST_REQUIRE_EQUAL(oTest[3], 2);
+  BOOST_REQUIRE_EQUAL(oTest[4], 4);
+
+  BOOST_REQUIRE(testDTree.Left()->Left() == NULL);
+  BOOST_REQUIRE(testDTree.Left()->Right() == NULL);
+  BOOST_REQUIRE(testDTree.Right()->Left()->Left() == NULL);
+  BOOST_REQUIRE(testDTree.Right()->Left()->Right() == NULL);
+  BOOST_REQUIRE(testDTree.Right()->Right()->Left() == NULL);
+  BOOST_REQUIRE(testDTree.Right()->Right()->Right() == NULL);
+
+  BOOST_REQUIRE(testDTree.SubtreeLeaves() == 3);
+
+  BOOST_REQUIRE(testDTree.SplitDim() == 2);
+  BOOST_REQUIRE_CLOSE(testDTree.SplitValue(), 5.5, 1e-5);
+  BOOST_REQUIRE(testDTree.Right()->SplitDim() == 1);
+  BOOST_REQUIRE_CLOSE(testDTree.Right()->SplitValue(), 0.5, 1e-5);
+}
+
+// Check that two density estimation trees are the same.
+void CheckSameTrees(const DTree<arma::mat>& a, const DTree<arma::mat>& b)
+{
+  BOOST_REQUIRE_EQUAL(a.Start(), b.Start());
+  BOOST_REQUIRE_EQUAL(a.End(), b.End());
+  BOOST_REQUIRE_EQUAL(a.SubtreeLeaves(), b.SubtreeLeaves());
+  BOOST_REQUIRE_CLOSE(a.LogNegError(), b.LogNegError(), 1e-10);
+  BOOST_REQUIRE_CLOSE(a.Ratio(), b.Ratio(), 1e-10);
+  BOOST_REQUIRE_EQUAL(a.Left() == NULL, b.Left() == NULL);
+  if (a.Left() == NULL)
+    return;
+
+  BOOST_REQUIRE_EQUAL(a.SplitDim(), b.SplitDim());
+  BOOST_REQUIRE_CLOSE(a.SplitValue(), b.SplitValue(), 1e-10);
+  BOOST_REQUIRE_CLOSE(a.SubtreeLeavesLogNegError(),
+      b.SubtreeLeavesLogNegError(), 1e-10);
+  BOOST_REQUIRE_CLOSE(a.AlphaUpper(), b.AlphaUpper(), 1e-10);
+
+  CheckSameTrees(*a.Left(), *b.Left());
+  CheckSameTrees(*a.Right(), *b.Right());
+}
+
+/**
+ * Grow trees on a subset of a random dataset from sorted indices, and make
+ * sure they are the same as the trees grown by the regular Grow() on a copy of
+ * the subset, with the same points in each leaf.
+ */
+BOOST_AUTO_TEST_CASE(TestGrowSortedIndicesSubset)
+{
+  arma::mat dataset = arma::randu<arma::mat>(4, 500);
+  // Add some duplicate values.
+  dataset.row(3) = arma::floor(10 * dataset.row(3));
+
+  arma::Mat<size_t> sortedIndices;
+  DTree<arma::mat>::SortIndices(dataset, sortedIndices);
+
+  // Use all the points but the first 100, like a cross-validation fold.
+  arma::mat train = dataset.cols(100, 499);
+  arma::Col<size_t> oldFromNew(400);
+  arma::Col<size_t> sortedOldFromNew(400);
+  for (size_t i = 0; i < 400; ++i)
+  {
+    oldFromNew[i] = i;
+    sortedOldFromNew[i] = i + 100;
+  }
+
+  DTree<arma::mat> tree(train);
+  const double alpha = tree.Grow(train, oldFromNew, false, 10, 5);
+
+  DTree<arma::mat> sortedTree(tree.MaxVals(), tree.MinVals(), 400);
+  const double sortedAlpha = sortedTree.Grow(dataset, sortedIndices,
+      sortedOldFromNew, false, 10, 5);
+
+  BOOST_REQUIRE_CLOSE(alpha, sortedAlpha, 1e-10);
+  CheckSameTrees(tree, sortedTree);
+
+  // Each leaf must hold the same points.
+  std::stack<const DTree<arma::mat>*> stack;
+  stack.push(&tree);
+  while (!stack.empty())
+  {
+    const DTree<arma::mat>* node = stack.top();
+    stack.pop();
+    if (node->Left() != NULL)
+    {
+      stack.push(node->Left());
+      stack.push(node->Right());
+      continue;
+    }
+
+    arma::Col<size_t> points = oldFromNew.subvec(node->Start(),
+        node->End() - 1) + 100;
+    arma::Col<size_t> sortedPoints = sortedOldFromNew.subvec(node->Start(),
+        node->End() - 1);
+    points = arma::sort(points);
+    sortedPoints = arma::sort(sortedPoints);
+    for (size_t i = 0; i < points.n_elem; ++i)
+      BOOST_REQUIRE_EQUAL(points[i], sortedPoints[i]);
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
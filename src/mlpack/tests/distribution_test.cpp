@@ -6,6 +6,7 @@
  * Tests for the classes:
  *  * mlpack::distribution::DiscreteDistribution
  *  * mlpack::distribution::GaussianDistribution
+ *  * mlpack::distribution::DiagonalGaussianDistribution
  *  * mlpack::distribution::GammaDistribution
  *
  * mlpack is free software; you may redistribute it and/or modify it under the
@@ -14,6 +15,7 @@
  * http://www.opensource.org/licenses/BSD-3-Clause for more information.
  */
 #include <mlpack/core.hpp>
+#include <mlpack/core/dists/regression_distribution.hpp>
 
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
@@ -580,6 +582,69 @@ BOOST_AUTO_TEST_CASE(GaussianDistributionTrainWithTwoDistProbabilitiesTest)
   BOOST_REQUIRE_CLOSE(guDist.Covariance()[0], cov1[0], 5);
 }
 
+/**
+ * Make sure the log probabilities of a DiagonalGaussianDistribution are those
+ * of a GaussianDistribution with the same (diagonal) covariance, for one point
+ * and for several blocks of points.
+ */
+BOOST_AUTO_TEST_CASE(DiagonalGaussianDistributionProbabilityTest)
+{
+  arma::vec mean = "5 -6 3 0.5 2";
+  arma::vec variances = "6 0.7 4 1 2.5";
+
+  DiagonalGaussianDistribution d(mean, variances);
+  GaussianDistribution g(mean, arma::diagmat(variances));
+
+  arma::mat points(5, 2500, arma::fill::randn);
+  points *= 3;
+
+  arma::vec dProbabilities, gProbabilities;
+  d.LogProbability(points, dProbabilities);
+  g.LogProbability(points, gProbabilities);
+
+  BOOST_REQUIRE_EQUAL(dProbabilities.n_elem, points.n_cols);
+  for (size_t i = 0; i < points.n_cols; ++i)
+  {
+    BOOST_REQUIRE_CLOSE(dProbabilities[i], gProbabilities[i], 1e-5);
+    BOOST_REQUIRE_CLOSE(d.LogProbability(points.col(i)),
+        g.LogProbability(points.col(i)), 1e-5);
+  }
+}
+
+/**
+ * Make sure DiagonalGaussianDistribution::Train() recovers the mean and the
+ * variances of the data, with and without probabilities.
+ */
+BOOST_AUTO_TEST_CASE(DiagonalGaussianDistributionTrainTest)
+{
+  arma::vec mean = "1 -2 3";
+  arma::vec variances = "0.5 2 4";
+  DiagonalGaussianDistribution d(mean, variances);
+
+  arma::mat data(3, 20000);
+  for (size_t i = 0; i < data.n_cols; ++i)
+    data.col(i) = d.Random();
+
+  DiagonalGaussianDistribution trained;
+  trained.Train(data);
+  for (size_t i = 0; i < 3; ++i)
+  {
+    BOOST_REQUIRE_SMALL(trained.Mean()[i] - mean[i], 0.1);
+    BOOST_REQUIRE_CLOSE(trained.Covariance()[i], variances[i], 5);
+  }
+
+  // Training with equal probabilities gives the biased estimate of the same
+  // variances.
+  DiagonalGaussianDistribution weighted;
+  weighted.Train(data, arma::vec(data.n_cols).fill(0.5));
+  for (size_t i = 0; i < 3; ++i)
+  {
+    BOOST_REQUIRE_CLOSE(weighted.Mean()[i], trained.Mean()[i], 1e-5);
+    BOOST_REQUIRE_CLOSE(weighted.Covariance()[i], trained.Covariance()[i] *
+        (data.n_cols - 1) / data.n_cols, 1e-5);
+  }
+}
+
 /******************************/
 /** Gamma Distribution Tests **/
 /******************************/
@@ -958,4 +1023,95 @@ BOOST_AUTO_TEST_CASE(GammaDistributionLogProbabilityTest)
   BOOST_REQUIRE_CLOSE(prob3(1), std::log(0.026165), 1e-3);
 }
 
+/**
+ * Make sure the batch LogProbability() of each distribution gives the same
+ * results as the probability of each observation, with enough observations
+ * for the parallel loops to be used.
+ */
+BOOST_AUTO_TEST_CASE(BatchLogProbabilityTest)
+{
+  const size_t n = 3000;
+
+  // Discrete distribution.
+  std::vector<arma::vec> probs;
+  probs.push_back(arma::vec("0.2 0.3 0.5"));
+  probs.push_back(arma::vec("0.6 0.4"));
+  DiscreteDistribution discrete(probs);
+  arma::mat discreteObs(2, n);
+  for (size_t i = 0; i < n; ++i)
+  {
+    discreteObs(0, i) = math::RandInt(3);
+    discreteObs(1, i) = math::RandInt(2);
+  }
+
+  arma::vec logProbs;
+  discrete.LogProbability(discreteObs, logProbs);
+  BOOST_REQUIRE_EQUAL(logProbs.n_elem, n);
+  for (size_t i = 0; i < n; ++i)
+    BOOST_REQUIRE_CLOSE(logProbs[i],
+        discrete.LogProbability(discreteObs.col(i)), 1e-5);
+
+  // An observation out of bounds is an error.
+  discreteObs(1, 5) = 2;
+  BOOST_REQUIRE_THROW(discrete.LogProbability(discreteObs, logProbs),
+      std::invalid_argument);
+
+  // Laplace distribution.
+  LaplaceDistribution laplace(arma::vec("1.0 -2.0 0.5"), 1.5);
+  const arma::mat laplaceObs = arma::randn<arma::mat>(3, n);
+  laplace.LogProbability(laplaceObs, logProbs);
+  BOOST_REQUIRE_EQUAL(logProbs.n_elem, n);
+  for (size_t i = 0; i < n; ++i)
+    BOOST_REQUIRE_CLOSE(logProbs[i],
+        laplace.LogProbability(laplaceObs.col(i)), 1e-5);
+
+  // Gamma distribution.
+  GammaDistribution gamma(arma::vec("2.0 1.0 0.5"), arma::vec("1.5 2.0 0.7"));
+  const arma::mat gammaObs = arma::randu<arma::mat>(3, n) * 5.0 + 0.01;
+  gamma.LogProbability(gammaObs, logProbs);
+  BOOST_REQUIRE_EQUAL(logProbs.n_elem, n);
+  for (size_t i = 0; i < n; ++i)
+  {
+    const double logProb = std::log(gamma.Probability(gammaObs(0, i), 0)) +
+        std::log(gamma.Probability(gammaObs(1, i), 1)) +
+        std::log(gamma.Probability(gammaObs(2, i), 2));
+    BOOST_REQUIRE_CLOSE(logProbs[i], logProb, 1e-5);
+  }
+
+  // Regression distribution; the first row holds the responses.
+  arma::mat regressionObs = arma::randu<arma::mat>(3, n);
+  regressionObs.row(0) = 2.0 * regressionObs.row(1) - regressionObs.row(2) +
+      0.1 * arma::randn<arma::rowvec>(n);
+  RegressionDistribution regression(regressionObs.rows(1, 2),
+      arma::rowvec(regressionObs.row(0)));
+  regression.LogProbability(regressionObs, logProbs);
+  BOOST_REQUIRE_EQUAL(logProbs.n_elem, n);
+  for (size_t i = 0; i < n; ++i)
+    BOOST_REQUIRE_CLOSE(logProbs[i],
+        regression.LogProbability(regressionObs.col(i)), 1e-5);
+}
+
+/**
+ * The Laplace distribution, which now also has Train(), should fit the same
+ * parameters with and without uniform weights.
+ */
+BOOST_AUTO_TEST_CASE(LaplaceDistributionWeightedTrainTest)
+{
+  const arma::mat obs = arma::randn<arma::mat>(4, 500);
+
+  LaplaceDistribution l1, l2;
+  l1.Train(obs);
+  l2.Train(obs, arma::ones<arma::vec>(500));
+
+  for (size_t d = 0; d < 4; ++d)
+    BOOST_REQUIRE_CLOSE(l1.Mean()[d], l2.Mean()[d], 1e-5);
+  BOOST_REQUIRE_CLOSE(l1.Scale(), l2.Scale(), 1e-5);
+
+  // The scale is the mean distance to the mean.
+  double scale = 0.0;
+  for (size_t i = 0; i < obs.n_cols; ++i)
+    scale += arma::norm(obs.col(i) - l1.Mean(), 2);
+  BOOST_REQUIRE_CLOSE(l1.Scale(), scale / obs.n_cols, 1e-5);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
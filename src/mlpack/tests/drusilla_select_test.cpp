@@ -167,4 +167,22 @@ BOOST_AUTO_TEST_CASE(SparseTest)
   BOOST_REQUIRE_EQUAL(distances.n_rows, 3);
 }
 
+// The results must not depend on the number of threads.
+BOOST_AUTO_TEST_CASE(DrusillaSelectThreadsTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(10, 2000);
+
+  DrusillaSelect<> ds(dataset, 10, 20);
+
+  arma::mat distances, singleDistances;
+  arma::Mat<size_t> neighbors, singleNeighbors;
+  ds.Search(dataset, 3, neighbors, distances);
+
+  ds.NumThreads() = 1;
+  ds.Search(dataset, 3, singleNeighbors, singleDistances);
+
+  CheckMatrices(neighbors, singleNeighbors);
+  CheckMatrices(distances, singleDistances);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
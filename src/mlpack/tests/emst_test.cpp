@@ -10,6 +10,7 @@
  */
 #include <mlpack/core.hpp>
 #include <mlpack/methods/emst/dtb.hpp>
+#include <mlpack/methods/emst/single_linkage.hpp>
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
 
@@ -278,4 +279,199 @@ BOOST_AUTO_TEST_CASE(BallTreeTest)
   }
 }
 
+/**
+ * Make sure that the approximate MST is a spanning tree whose edges are each
+ * at most (1 + epsilon) times as long as needed, so its total length is at
+ * most (1 + epsilon) times the length of the exact MST.
+ */
+BOOST_AUTO_TEST_CASE(ApproximateEMSTTest)
+{
+  arma::mat inputData = arma::randu<arma::mat>(3, 1500);
+  const double epsilon = 0.5;
+
+  DualTreeBoruvka<> exact(inputData);
+  DualTreeBoruvka<> approx(inputData);
+  approx.Epsilon() = epsilon;
+
+  arma::mat exactResults, approxResults;
+  exact.ComputeMST(exactResults);
+  approx.ComputeMST(approxResults);
+
+  BOOST_REQUIRE_EQUAL(approxResults.n_cols, inputData.n_cols - 1);
+
+  // The edges must connect all points.
+  UnionFind components(inputData.n_cols);
+  for (size_t i = 0; i < approxResults.n_cols; ++i)
+  {
+    const size_t a = (size_t) approxResults(0, i);
+    const size_t b = (size_t) approxResults(1, i);
+    BOOST_REQUIRE_NE(components.Find(a), components.Find(b));
+    components.Union(a, b);
+
+    BOOST_REQUIRE_CLOSE(approxResults(2, i), arma::norm(inputData.col(a) -
+        inputData.col(b)), 1e-5);
+  }
+
+  const double exactLength = arma::accu(exactResults.row(2));
+  const double approxLength = arma::accu(approxResults.row(2));
+  BOOST_REQUIRE_GE(approxLength, exactLength * (1 - 1e-10));
+  BOOST_REQUIRE_LE(approxLength, exactLength * (1 + epsilon));
+}
+
+/**
+ * A negative epsilon must be rejected.
+ */
+BOOST_AUTO_TEST_CASE(NegativeEpsilonTest)
+{
+  arma::mat inputData = arma::randu<arma::mat>(3, 50);
+  DualTreeBoruvka<> dtb(inputData);
+  dtb.Epsilon() = -0.1;
+
+  arma::mat results;
+  BOOST_REQUIRE_THROW(dtb.ComputeMST(results), std::invalid_argument);
+}
+
+/**
+ * Check the single-linkage dendrogram and cuts on a simple set of points on a
+ * line: 0, 1, 3, 7 and 15, where each point is twice as far from the previous
+ * one as the previous one is from its predecessor.
+ */
+BOOST_AUTO_TEST_CASE(SingleLinkageTest)
+{
+  arma::mat inputData("0 1 3 7 15");
+
+  DualTreeBoruvka<> dtb(inputData);
+  arma::mat mst;
+  dtb.ComputeMST(mst);
+
+  arma::mat dendrogram;
+  SingleLinkageDendrogram(mst, dendrogram);
+
+  BOOST_REQUIRE_EQUAL(dendrogram.n_rows, 4);
+  BOOST_REQUIRE_EQUAL(dendrogram.n_cols, 4);
+
+  // First, points 0 and 1 are merged into cluster 5; then point 2 joins it as
+  // cluster 6, then point 3 (cluster 7), then point 4 (cluster 8).
+  const double expected[4][4] = { { 0, 1, 1, 2 },
+                                  { 2, 5, 2, 3 },
+                                  { 3, 6, 4, 4 },
+                                  { 4, 7, 8, 5 } };
+  for (size_t i = 0; i < 4; ++i)
+    for (size_t j = 0; j < 4; ++j)
+      BOOST_REQUIRE_CLOSE(dendrogram(j, i), expected[i][j], 1e-5);
+
+  // Cut at a distance of 3: {0, 1, 3}, {7}, {15}.
+  arma::Row<size_t> assignments;
+  BOOST_REQUIRE_EQUAL(CutAtDistance(mst, 3.0, assignments), 3);
+  BOOST_REQUIRE_EQUAL(assignments.n_elem, 5);
+  BOOST_REQUIRE_EQUAL(assignments[0], 0);
+  BOOST_REQUIRE_EQUAL(assignments[1], 0);
+  BOOST_REQUIRE_EQUAL(assignments[2], 0);
+  BOOST_REQUIRE_EQUAL(assignments[3], 1);
+  BOOST_REQUIRE_EQUAL(assignments[4], 2);
+
+  // Two clusters: only the longest edge is removed.
+  CutToClusters(mst, 2, assignments);
+  BOOST_REQUIRE_EQUAL(assignments.n_elem, 5);
+  for (size_t i = 0; i < 4; ++i)
+    BOOST_REQUIRE_EQUAL(assignments[i], 0);
+  BOOST_REQUIRE_EQUAL(assignments[4], 1);
+
+  // Five clusters: every point is on its own.
+  CutToClusters(mst, 5, assignments);
+  for (size_t i = 0; i < 5; ++i)
+    BOOST_REQUIRE_EQUAL(assignments[i], i);
+
+  BOOST_REQUIRE_THROW(CutToClusters(mst, 0, assignments),
+      std::invalid_argument);
+  BOOST_REQUIRE_THROW(CutToClusters(mst, 6, assignments),
+      std::invalid_argument);
+}
+
+/**
+ * Cutting the dendrogram of random data into k clusters must give exactly k
+ * clusters, and cutting at the distance of a merge must give the clusters that
+ * exist after that merge.
+ */
+BOOST_AUTO_TEST_CASE(SingleLinkageCutsTest)
+{
+  arma::mat inputData = arma::randu<arma::mat>(2, 300);
+
+  DualTreeBoruvka<> dtb(inputData);
+  arma::mat mst;
+  dtb.ComputeMST(mst);
+
+  arma::mat dendrogram;
+  SingleLinkageDendrogram(mst, dendrogram);
+
+  // The last merge holds all the points.
+  BOOST_REQUIRE_EQUAL((size_t) dendrogram(3, dendrogram.n_cols - 1), 300);
+
+  for (size_t k = 1; k <= 300; k += 37)
+  {
+    arma::Row<size_t> assignments, distanceAssignments;
+    CutToClusters(mst, k, assignments);
+    BOOST_REQUIRE_EQUAL(arma::max(assignments) + 1, k);
+
+    // After (300 - k) merges there are k clusters.
+    if (k < 300)
+    {
+      const double distance = dendrogram(2, 300 - k - 1);
+      BOOST_REQUIRE_EQUAL(CutAtDistance(mst, distance, distanceAssignments),
+          k);
+      for (size_t i = 0; i < assignments.n_elem; ++i)
+        BOOST_REQUIRE_EQUAL(assignments[i], distanceAssignments[i]);
+    }
+  }
+}
+
+#ifdef HAS_OPENMP
+
+/**
+ * Make sure the parallel search of each round gives the same MST as the naive
+ * algorithm.
+ */
+template<template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void ParallelDualTreeVsNaiveTest()
+{
+  arma::mat inputData = arma::randu<arma::mat>(3, 2000);
+
+  DualTreeBoruvka<EuclideanDistance, arma::mat, TreeType> dtb(inputData);
+  dtb.NumThreads() = 4;
+  DualTreeBoruvka<> naive(inputData, true);
+
+  arma::mat dualResults, naiveResults;
+  dtb.ComputeMST(dualResults);
+  naive.ComputeMST(naiveResults);
+
+  BOOST_REQUIRE_EQUAL(dualResults.n_cols, naiveResults.n_cols);
+  BOOST_REQUIRE_EQUAL(dualResults.n_rows, naiveResults.n_rows);
+
+  for (size_t i = 0; i < dualResults.n_cols; i++)
+  {
+    BOOST_REQUIRE_EQUAL(dualResults(0, i), naiveResults(0, i));
+    BOOST_REQUIRE_EQUAL(dualResults(1, i), naiveResults(1, i));
+    BOOST_REQUIRE_CLOSE(dualResults(2, i), naiveResults(2, i), 1e-5);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(ParallelKDTreeTest)
+{
+  ParallelDualTreeVsNaiveTest<KDTree>();
+}
+
+BOOST_AUTO_TEST_CASE(ParallelCoverTreeTest)
+{
+  ParallelDualTreeVsNaiveTest<StandardCoverTree>();
+}
+
+BOOST_AUTO_TEST_CASE(ParallelBallTreeTest)
+{
+  ParallelDualTreeVsNaiveTest<BallTree>();
+}
+
+#endif
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -1082,4 +1082,185 @@ BOOST_AUTO_TEST_CASE(CopyAssignmentTest)
   }
 }
 
+/**
+ * Compute, by brute force, the k points of the reference set with maximum
+ * kernel value to each query point, evaluating the kernel one pair at a time.
+ */
+template<typename KernelType>
+void PairwiseMaxKernels(const arma::mat& referenceSet,
+                        const arma::mat& querySet,
+                        KernelType& kernel,
+                        const size_t k,
+                        arma::Mat<size_t>& indices,
+                        arma::mat& kernels)
+{
+  indices.set_size(k, querySet.n_cols);
+  kernels.set_size(k, querySet.n_cols);
+  arma::vec evals(referenceSet.n_cols);
+  for (size_t q = 0; q < querySet.n_cols; ++q)
+  {
+    for (size_t r = 0; r < referenceSet.n_cols; ++r)
+      evals[r] = kernel.Evaluate(querySet.col(q), referenceSet.col(r));
+
+    arma::uvec order = arma::stable_sort_index(evals, "descend");
+    for (size_t j = 0; j < k; ++j)
+    {
+      indices(j, q) = order[j];
+      kernels(j, q) = evals[order[j]];
+    }
+  }
+}
+
+/**
+ * Make sure that the batched naive search, which is used for kernels that are
+ * a function of the inner product, gives the same results as evaluating the
+ * kernel for each pair of points.  The sets are large enough that there are
+ * several blocks of query and reference points.
+ */
+template<typename KernelType>
+void BatchedNaiveSearchTest(KernelType& kernel)
+{
+  arma::mat referenceSet = arma::randu<arma::mat>(5, 3000);
+  arma::mat querySet = arma::randu<arma::mat>(5, 600);
+
+  FastMKS<KernelType> f(referenceSet, kernel, false, true);
+
+  arma::Mat<size_t> indices, pairwiseIndices;
+  arma::mat kernels, pairwiseKernels;
+  f.Search(querySet, 5, indices, kernels);
+  PairwiseMaxKernels(referenceSet, querySet, kernel, 5, pairwiseIndices,
+      pairwiseKernels);
+
+  BOOST_REQUIRE_EQUAL(indices.n_rows, 5);
+  BOOST_REQUIRE_EQUAL(indices.n_cols, 600);
+  for (size_t i = 0; i < indices.n_elem; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(indices[i], pairwiseIndices[i]);
+    BOOST_REQUIRE_CLOSE(kernels[i], pairwiseKernels[i], 1e-5);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(BatchedNaiveLinearTest)
+{
+  LinearKernel lk;
+  BatchedNaiveSearchTest(lk);
+}
+
+BOOST_AUTO_TEST_CASE(BatchedNaivePolynomialTest)
+{
+  PolynomialKernel pk(3.0, 0.5);
+  BatchedNaiveSearchTest(pk);
+}
+
+BOOST_AUTO_TEST_CASE(BatchedNaiveHyptanTest)
+{
+  HyperbolicTangentKernel htk(0.1, 0.2);
+  BatchedNaiveSearchTest(htk);
+}
+
+/**
+ * Make sure the batched naive search doesn't return a point as its own
+ * candidate when the query set is the reference set.
+ */
+BOOST_AUTO_TEST_CASE(BatchedNaiveMonochromaticTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(5, 2500);
+  PolynomialKernel pk(2.0, 1.0);
+
+  FastMKS<PolynomialKernel> naive(dataset, pk, false, true);
+  FastMKS<PolynomialKernel> single(dataset, pk, true, false);
+
+  arma::Mat<size_t> naiveIndices, singleIndices;
+  arma::mat naiveKernels, singleKernels;
+  naive.Search(3, naiveIndices, naiveKernels);
+  single.Search(3, singleIndices, singleKernels);
+
+  for (size_t i = 0; i < naiveIndices.n_cols; ++i)
+  {
+    for (size_t j = 0; j < naiveIndices.n_rows; ++j)
+    {
+      BOOST_REQUIRE_NE(naiveIndices(j, i), i);
+      BOOST_REQUIRE_EQUAL(naiveIndices(j, i), singleIndices(j, i));
+      BOOST_REQUIRE_CLOSE(naiveKernels(j, i), singleKernels(j, i), 1e-5);
+    }
+  }
+}
+
+#ifdef HAS_OPENMP
+
+/**
+ * Make sure that naive search gives the same results with one thread and with
+ * several threads, both for a kernel that uses the batched search and for one
+ * that doesn't.
+ */
+template<typename KernelType>
+void ParallelNaiveSearchTest(KernelType& kernel)
+{
+  arma::mat referenceSet = arma::randu<arma::mat>(4, 1500);
+  arma::mat querySet = arma::randu<arma::mat>(4, 700);
+
+  FastMKS<KernelType> f(referenceSet, kernel, false, true);
+
+  arma::Mat<size_t> serialIndices, parallelIndices;
+  arma::mat serialKernels, parallelKernels;
+
+  f.NumThreads() = 1;
+  f.Search(querySet, 4, serialIndices, serialKernels);
+  f.NumThreads() = 4;
+  f.Search(querySet, 4, parallelIndices, parallelKernels);
+
+  CheckMatrices(serialIndices, parallelIndices);
+  CheckMatrices(serialKernels, parallelKernels);
+}
+
+BOOST_AUTO_TEST_CASE(ParallelNaiveLinearTest)
+{
+  LinearKernel lk;
+  ParallelNaiveSearchTest(lk);
+}
+
+BOOST_AUTO_TEST_CASE(ParallelNaiveGaussianTest)
+{
+  GaussianKernel gk(0.5);
+  ParallelNaiveSearchTest(gk);
+}
+
+#endif
+
+/**
+ * The self-kernels of the reference points are cached between searches; make
+ * sure they are recomputed when the model is trained on a new reference set.
+ */
+BOOST_AUTO_TEST_CASE(SelfKernelCacheRetrainTest)
+{
+  arma::mat referenceSet = arma::randu<arma::mat>(5, 300);
+  arma::mat newReferenceSet = 10 * arma::randu<arma::mat>(5, 300);
+  arma::mat querySet = arma::randu<arma::mat>(5, 50);
+  PolynomialKernel pk(2.0);
+
+  for (size_t mode = 0; mode < 2; ++mode)
+  {
+    const bool singleMode = (mode == 0);
+    FastMKS<PolynomialKernel> f(referenceSet, pk, singleMode);
+
+    arma::Mat<size_t> indices;
+    arma::mat kernels;
+    f.Search(querySet, 3, indices, kernels);
+
+    f.Train(newReferenceSet, pk);
+    f.Search(querySet, 3, indices, kernels);
+
+    arma::Mat<size_t> pairwiseIndices;
+    arma::mat pairwiseKernels;
+    PairwiseMaxKernels(newReferenceSet, querySet, pk, 3, pairwiseIndices,
+        pairwiseKernels);
+
+    for (size_t i = 0; i < indices.n_elem; ++i)
+    {
+      BOOST_REQUIRE_EQUAL(indices[i], pairwiseIndices[i]);
+      BOOST_REQUIRE_CLOSE(kernels[i], pairwiseKernels[i], 1e-5);
+    }
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
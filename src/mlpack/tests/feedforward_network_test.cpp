@@ -13,11 +13,17 @@
 #include <mlpack/core.hpp>
 
 #include <mlpack/core/optimizers/rmsprop/rmsprop.hpp>
+#include <mlpack/core/optimizers/adam/adam.hpp>
+#include <mlpack/core/optimizers/ada_grad/ada_grad.hpp>
+#include <mlpack/core/optimizers/hogwild_sgd/hogwild_sgd.hpp>
 #include <mlpack/methods/ann/layer/layer.hpp>
 #include <mlpack/methods/ann/ffn.hpp>
+#include <mlpack/methods/ann/quantized_ffn.hpp>
+#include <mlpack/methods/ann/static_ffn.hpp>
 
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
+#include "serialization.hpp"
 
 using namespace mlpack;
 using namespace mlpack::ann;
@@ -426,4 +432,743 @@ BOOST_AUTO_TEST_CASE(FFNMiscTest)
   movedModel = std::move(copiedModel);
 }
 
+/**
+ * Make sure that the objective, the gradient and the predictions of a batch of
+ * points passed through the network as one matrix are the same as those of the
+ * points passed through one at a time.
+ */
+BOOST_AUTO_TEST_CASE(FFNBatchGradientTest)
+{
+  arma::mat data = arma::randu<arma::mat>(5, 40);
+  arma::mat labels = arma::zeros<arma::mat>(1, 40);
+  for (size_t i = 0; i < labels.n_cols; ++i)
+    labels(i) = (data(0, i) + data(1, i) > 1.0) ? 2 : 1;
+
+  FFN<NegativeLogLikelihood<> > model(data, labels);
+  model.Add<Linear<> >(5, 8);
+  model.Add<LeakyReLU<> >();
+  model.Add<Linear<> >(8, 2);
+  model.Add<LogSoftMax<> >();
+  model.ResetParameters();
+
+  // Points [10, 35) form the batch.
+  arma::mat batchGradient;
+  model.Gradient(model.Parameters(), 10, batchGradient, 25);
+  const double batchObjective = model.Evaluate(model.Parameters(), 10, 25);
+
+  arma::mat gradient = arma::zeros<arma::mat>(batchGradient.n_rows,
+      batchGradient.n_cols);
+  double objective = 0;
+  for (size_t i = 10; i < 35; ++i)
+  {
+    arma::mat pointGradient;
+    model.Gradient(model.Parameters(), i, pointGradient);
+    gradient += pointGradient;
+    objective += model.Evaluate(model.Parameters(), i);
+  }
+
+  BOOST_REQUIRE_CLOSE(batchObjective, objective, 1e-5);
+  for (size_t i = 0; i < gradient.n_elem; ++i)
+  {
+    if (std::abs(gradient[i]) < 1e-10)
+      BOOST_REQUIRE_SMALL(batchGradient[i], 1e-10);
+    else
+      BOOST_REQUIRE_CLOSE(batchGradient[i], gradient[i], 1e-5);
+  }
+
+  // The predictions of the whole dataset must match those of each point.
+  arma::mat predictions;
+  model.Predict(data, predictions);
+  for (size_t i = 0; i < data.n_cols; ++i)
+  {
+    arma::mat pointPrediction;
+    model.Predict(data.col(i), pointPrediction);
+    for (size_t j = 0; j < pointPrediction.n_elem; ++j)
+      BOOST_REQUIRE_CLOSE(predictions(j, i), pointPrediction[j], 1e-5);
+  }
+}
+
+/**
+ * Make sure that the predictions made through workspaces match those of the
+ * network, and that workspaces don't interfere with each other.
+ */
+BOOST_AUTO_TEST_CASE(FFNWorkspacePredictTest)
+{
+  arma::mat data = arma::randu<arma::mat>(4, 300);
+
+  FFN<NegativeLogLikelihood<> > model;
+  model.Add<Linear<> >(4, 6);
+  model.Add<SigmoidLayer<> >();
+  model.Add<Dropout<> >(0.3);
+  model.Add<Linear<> >(6, 3);
+  model.Add<LogSoftMax<> >();
+  model.ResetParameters();
+
+  const FFN<NegativeLogLikelihood<> >& constModel = model;
+  FFN<NegativeLogLikelihood<> >::Workspace workspace(constModel);
+  FFN<NegativeLogLikelihood<> >::Workspace otherWorkspace(constModel);
+
+  arma::mat predictions, workspacePredictions, otherPredictions;
+  model.Predict(data, predictions);
+  constModel.Predict(data, workspacePredictions, workspace);
+  constModel.Predict(data.cols(0, 9), otherPredictions, otherWorkspace);
+
+  BOOST_REQUIRE_EQUAL(workspacePredictions.n_rows, predictions.n_rows);
+  BOOST_REQUIRE_EQUAL(workspacePredictions.n_cols, predictions.n_cols);
+  for (size_t i = 0; i < predictions.n_elem; ++i)
+    BOOST_REQUIRE_CLOSE(workspacePredictions[i], predictions[i], 1e-5);
+
+  for (size_t i = 0; i < otherPredictions.n_elem; ++i)
+    BOOST_REQUIRE_CLOSE(otherPredictions[i], predictions[i], 1e-5);
+
+  // A workspace can only be used with its own network.
+  FFN<NegativeLogLikelihood<> > otherModel(model);
+  BOOST_REQUIRE_THROW(otherModel.Predict(data, predictions, workspace),
+      std::invalid_argument);
+}
+
+/**
+ * Make sure that the passes that use the planned layer buffers give the same
+ * results as the first pass, which plans them, also when deterministic and
+ * training passes and batch sizes are interleaved.
+ */
+BOOST_AUTO_TEST_CASE(FFNPlannedBuffersTest)
+{
+  arma::mat data = arma::randu<arma::mat>(3, 50);
+  arma::mat labels = arma::zeros<arma::mat>(1, 50);
+  for (size_t i = 0; i < labels.n_cols; ++i)
+    labels(i) = (data(2, i) > 0.5) ? 2 : 1;
+
+  FFN<NegativeLogLikelihood<> > model(data, labels);
+  model.Add<Linear<> >(3, 7);
+  model.Add<SigmoidLayer<> >();
+  model.Add<Linear<> >(7, 5);
+  model.Add<TanHLayer<> >();
+  model.Add<Linear<> >(5, 2);
+  model.Add<LogSoftMax<> >();
+  model.ResetParameters();
+
+  arma::mat firstGradient, gradient;
+  model.Gradient(model.Parameters(), 0, firstGradient, 20);
+  const double firstObjective = model.Evaluate(model.Parameters(), 0, 20);
+  arma::mat firstPredictions;
+  model.Predict(data, firstPredictions);
+
+  for (size_t trial = 0; trial < 3; ++trial)
+  {
+    model.Gradient(model.Parameters(), 0, gradient, 20);
+    BOOST_REQUIRE_EQUAL(gradient.n_elem, firstGradient.n_elem);
+    for (size_t i = 0; i < gradient.n_elem; ++i)
+      BOOST_REQUIRE_CLOSE(gradient[i] + 1.0, firstGradient[i] + 1.0, 1e-8);
+
+    BOOST_REQUIRE_CLOSE(model.Evaluate(model.Parameters(), 0, 20),
+        firstObjective, 1e-8);
+
+    // A pass with another batch size in between.
+    model.Evaluate(model.Parameters(), 20, 7);
+
+    arma::mat predictions;
+    model.Predict(data, predictions);
+    for (size_t i = 0; i < predictions.n_elem; ++i)
+      BOOST_REQUIRE_CLOSE(predictions[i], firstPredictions[i], 1e-8);
+  }
+}
+
+/**
+ * Make sure that the batch gradient sharded across replicas, and the gradient
+ * computed with a workspace, are the same as the gradient computed by the
+ * network itself.
+ */
+BOOST_AUTO_TEST_CASE(FFNReplicaGradientTest)
+{
+  arma::mat data = arma::randu<arma::mat>(4, 60);
+  arma::mat labels = arma::zeros<arma::mat>(1, 60);
+  for (size_t i = 0; i < labels.n_cols; ++i)
+    labels(i) = (data(1, i) > data(3, i)) ? 2 : 1;
+
+  FFN<NegativeLogLikelihood<> > model(data, labels);
+  model.Add<Linear<> >(4, 6);
+  model.Add<SigmoidLayer<> >();
+  model.Add<Linear<> >(6, 2);
+  model.Add<LogSoftMax<> >();
+  model.ResetParameters();
+
+  arma::mat gradient;
+  model.Gradient(model.Parameters(), 5, gradient, 51);
+
+  // Three replicas don't divide the batch evenly, and the tree reduction has
+  // an unpaired replica in its first round.
+  model.Replicas() = 3;
+  arma::mat replicaGradient;
+  for (size_t trial = 0; trial < 2; ++trial)
+  {
+    model.Gradient(model.Parameters(), 5, replicaGradient, 51);
+    BOOST_REQUIRE_EQUAL(replicaGradient.n_elem, gradient.n_elem);
+    for (size_t i = 0; i < gradient.n_elem; ++i)
+      BOOST_REQUIRE_CLOSE(replicaGradient[i] + 1.0, gradient[i] + 1.0, 1e-8);
+  }
+
+  const FFN<NegativeLogLikelihood<> >& constModel = model;
+  FFN<NegativeLogLikelihood<> >::Workspace workspace(constModel);
+  arma::mat workspaceGradient;
+  constModel.Gradient(model.Parameters(), 5, workspaceGradient, 51, workspace);
+  for (size_t i = 0; i < gradient.n_elem; ++i)
+    BOOST_REQUIRE_CLOSE(workspaceGradient[i] + 1.0, gradient[i] + 1.0, 1e-8);
+}
+
+/**
+ * Train a network with Hogwild! through the Train() API, and make sure that it
+ * learns a simple classification problem.
+ */
+BOOST_AUTO_TEST_CASE(FFNHogwildTrainTest)
+{
+  arma::mat data = arma::randu<arma::mat>(2, 1000);
+  arma::mat labels = arma::zeros<arma::mat>(1, 1000);
+  for (size_t i = 0; i < labels.n_cols; ++i)
+    labels(i) = (data(0, i) > data(1, i)) ? 2 : 1;
+
+  FFN<NegativeLogLikelihood<> > model;
+  model.Add<Linear<> >(2, 8);
+  model.Add<SigmoidLayer<> >();
+  model.Add<Linear<> >(8, 2);
+  model.Add<LogSoftMax<> >();
+
+  HogwildSGD<decltype(model)> opt(model, 10, 0.5, 50, -1.0);
+  model.Train(data, labels, opt);
+
+  arma::mat predictions;
+  model.Predict(data, predictions);
+  size_t errors = 0;
+  for (size_t i = 0; i < predictions.n_cols; ++i)
+  {
+    const size_t prediction = arma::as_scalar(arma::find(
+        arma::max(predictions.col(i)) == predictions.col(i), 1)) + 1;
+    if (prediction != labels(i))
+      ++errors;
+  }
+
+  BOOST_REQUIRE_LE((double) errors / data.n_cols, 0.1);
+}
+
+/**
+ * Make sure that the sparse gradient of a network with an embedding table
+ * matches the dense one, and that the sparse optimizers give the same result as
+ * the dense ones (for SGD and AdaGrad) or leave the unused words untouched (for
+ * the lazy Adam).
+ */
+BOOST_AUTO_TEST_CASE(FFNSparseGradientTest)
+{
+  // One word per point, from the first 20 words of a vocabulary of 50.
+  arma::mat data = arma::ceil(20 * arma::randu<arma::mat>(1, 100));
+  arma::mat labels = arma::zeros<arma::mat>(1, 100);
+  for (size_t i = 0; i < labels.n_cols; ++i)
+    labels(i) = ((size_t) data(i) % 3) + 1;
+
+  FFN<NegativeLogLikelihood<> > dense(data, labels);
+  FFN<NegativeLogLikelihood<> > sparse(data, labels);
+  for (FFN<NegativeLogLikelihood<> >* model : { &dense, &sparse })
+  {
+    model->Add<Lookup<> >(50, 4);
+    model->Add<Linear<> >(4, 3);
+    model->Add<LogSoftMax<> >();
+    model->ResetParameters();
+  }
+  sparse.Parameters() = dense.Parameters();
+  const arma::mat initial = dense.Parameters();
+
+  arma::mat denseGradient;
+  arma::sp_mat sparseGradient;
+  for (size_t i = 0; i < 3; ++i)
+  {
+    dense.Gradient(dense.Parameters(), i, denseGradient);
+    sparse.Gradient(sparse.Parameters(), i, sparseGradient);
+
+    // Only one column of the embedding table has a gradient.
+    BOOST_REQUIRE_LE(sparseGradient.n_nonzero, 4 + 4 * 3 + 3);
+    CheckMatrices(denseGradient, arma::mat(sparseGradient));
+  }
+
+  StandardSGD<decltype(dense)> denseSGD(dense, 0.1, 300, -1, false);
+  SparseSGD<decltype(sparse)> sparseSGD(sparse, 0.1, 300, -1, false);
+  denseSGD.Optimize(dense.Parameters());
+  sparseSGD.Optimize(sparse.Parameters());
+  CheckMatrices(dense.Parameters(), sparse.Parameters());
+
+  AdaGrad<decltype(dense)> denseAdaGrad(dense, 0.1, 1e-8, 300, -1, false);
+  SparseAdaGrad<decltype(sparse)> sparseAdaGrad(sparse, 0.1, 1e-8, 300, -1,
+      false);
+  denseAdaGrad.Optimize(dense.Parameters());
+  sparseAdaGrad.Optimize(sparse.Parameters());
+  CheckMatrices(dense.Parameters(), sparse.Parameters());
+
+  // The embeddings of the unused words (the last 30) are the initial ones.
+  sparse.Parameters() = initial;
+  SparseAdam<decltype(sparse)> sparseAdam(sparse, 0.01, 0.9, 0.999, 1e-8, 300,
+      -1, false);
+  sparseAdam.Optimize(sparse.Parameters());
+  CheckMatrices(sparse.Parameters().rows(80, 199), initial.rows(80, 199));
+  BOOST_REQUIRE_GT(arma::accu(arma::abs(sparse.Parameters().rows(0, 79) -
+      initial.rows(0, 79))), 0.0);
+}
+
+/**
+ * Make sure that the fused deterministic passes (with a fused Linear and
+ * activation, a merged Dropout scale, a left out Dropout, a replaced
+ * DropConnect and a merged LogSoftMax loss) give the same predictions and
+ * objective as the passes through all modules.
+ */
+BOOST_AUTO_TEST_CASE(FFNFusedDeterministicTest)
+{
+  arma::mat data = arma::randu<arma::mat>(5, 40);
+  arma::mat labels = arma::zeros<arma::mat>(1, 40);
+  for (size_t i = 0; i < labels.n_cols; ++i)
+    labels(i) = (data(0, i) > data(1, i)) ? 1 : ((data(2, i) > 0.5) ? 2 : 3);
+
+  FFN<NegativeLogLikelihood<> > model(data, labels);
+  model.Add<Linear<> >(5, 8);
+  model.Add<ReLULayer<> >();
+  model.Add<Dropout<> >(0.2);
+  model.Add<DropConnect<> >(8, 6, 0.3);
+  model.Add<TanHLayer<> >();
+  model.Add<Dropout<> >(0.4, false);
+  model.Add<Linear<> >(6, 3);
+  model.Add<LogSoftMax<> >();
+  model.ResetParameters();
+
+  // The first pass sets the input size of the layers, so it runs through all
+  // modules, and the following ones run the fused plan.
+  arma::mat predictions, fusedPredictions;
+  model.Predict(data, predictions);
+  model.Predict(data, fusedPredictions);
+  CheckMatrices(predictions, fusedPredictions);
+
+  double objective = 0;
+  for (size_t i = 0; i < labels.n_cols; ++i)
+    objective -= predictions(labels(i) - 1, i);
+
+  BOOST_REQUIRE_CLOSE(model.Evaluate(model.Parameters(), 0, 40, true),
+      objective, 1e-5);
+
+  double pointObjective = 0;
+  for (size_t i = 0; i < labels.n_cols; ++i)
+    pointObjective += model.Evaluate(model.Parameters(), i, true);
+  BOOST_REQUIRE_CLOSE(pointObjective, objective, 1e-5);
+
+  // A copy makes its own plan.
+  FFN<NegativeLogLikelihood<> > copy(model);
+  arma::mat copyPredictions;
+  copy.Predict(data, copyPredictions);
+  CheckMatrices(predictions, copyPredictions);
+}
+
+/**
+ * Make sure that a StaticFFN computes the same objective, gradient and
+ * predictions as the FFN with the same layers and parameters.
+ */
+BOOST_AUTO_TEST_CASE(StaticFFNTest)
+{
+  arma::mat data = arma::randu<arma::mat>(5, 30);
+  arma::mat labels = arma::zeros<arma::mat>(1, 30);
+  for (size_t i = 0; i < labels.n_cols; ++i)
+    labels(i) = (data(0, i) > data(4, i)) ? 2 : 1;
+
+  FFN<NegativeLogLikelihood<> > model(data, labels);
+  model.Add<Linear<> >(5, 7);
+  model.Add<ReLULayer<> >();
+  model.Add<Linear<> >(7, 2);
+  model.Add<LogSoftMax<> >();
+  model.ResetParameters();
+
+  typedef StaticFFN<NegativeLogLikelihood<>, RandomInitialization, Linear<>,
+      ReLULayer<>, Linear<>, LogSoftMax<> > StaticModelType;
+  StaticModelType staticModel(Linear<>(5, 7), ReLULayer<>(), Linear<>(7, 2),
+      LogSoftMax<>());
+  staticModel.ResetParameters();
+  BOOST_REQUIRE_EQUAL(staticModel.Parameters().n_elem,
+      model.Parameters().n_elem);
+  staticModel.Parameters() = model.Parameters();
+
+  // Train() with no iterations sets the data and keeps the parameters.
+  RMSProp<StaticModelType> opt(staticModel, 0.01, 0.99, 1e-8, 1, -1);
+  staticModel.Train(data, labels, opt);
+
+  BOOST_REQUIRE_CLOSE(staticModel.Evaluate(staticModel.Parameters(), 3, 20,
+      true), model.Evaluate(model.Parameters(), 3, 20, true), 1e-8);
+
+  arma::mat gradient, staticGradient;
+  model.Gradient(model.Parameters(), 3, gradient, 20);
+  staticModel.Gradient(staticModel.Parameters(), 3, staticGradient, 20);
+  BOOST_REQUIRE_EQUAL(staticGradient.n_elem, gradient.n_elem);
+  for (size_t i = 0; i < gradient.n_elem; ++i)
+    BOOST_REQUIRE_CLOSE(staticGradient[i] + 1.0, gradient[i] + 1.0, 1e-8);
+
+  arma::mat predictions, staticPredictions;
+  model.Predict(data, predictions);
+  staticModel.Predict(data, staticPredictions);
+  BOOST_REQUIRE_EQUAL(staticPredictions.n_cols, predictions.n_cols);
+  for (size_t i = 0; i < predictions.n_elem; ++i)
+    BOOST_REQUIRE_CLOSE(staticPredictions[i], predictions[i], 1e-8);
+
+  // A copy must use its own parameters.
+  StaticModelType copiedModel(staticModel);
+  copiedModel.Parameters().zeros();
+  arma::mat copiedPredictions;
+  staticModel.Predict(data, copiedPredictions);
+  for (size_t i = 0; i < predictions.n_elem; ++i)
+    BOOST_REQUIRE_CLOSE(copiedPredictions[i], predictions[i], 1e-8);
+}
+
+/**
+ * Make sure a single precision StaticFFN gives (up to the precision) the same
+ * objective, gradient and predictions as the double precision network, and
+ * that its master parameters stay double precision.
+ */
+BOOST_AUTO_TEST_CASE(SinglePrecisionStaticFFNTest)
+{
+  arma::mat data = arma::randu<arma::mat>(5, 30);
+  arma::mat labels = arma::zeros<arma::mat>(1, 30);
+  for (size_t i = 0; i < labels.n_cols; ++i)
+    labels(i) = (data(0, i) > data(4, i)) ? 2 : 1;
+
+  typedef StaticFFN<NegativeLogLikelihood<>, RandomInitialization, Linear<>,
+      ReLULayer<>, Linear<>, LogSoftMax<> > ModelType;
+  ModelType model(Linear<>(5, 7), ReLULayer<>(), Linear<>(7, 2),
+      LogSoftMax<>());
+
+  typedef StaticFFN<NegativeLogLikelihood<arma::fmat, arma::fmat>,
+      RandomInitialization, Linear<arma::fmat, arma::fmat>,
+      ReLULayer<arma::fmat, arma::fmat>, Linear<arma::fmat, arma::fmat>,
+      LogSoftMax<arma::fmat, arma::fmat> > FloatModelType;
+  FloatModelType floatModel(Linear<arma::fmat, arma::fmat>(5, 7),
+      ReLULayer<arma::fmat, arma::fmat>(), Linear<arma::fmat, arma::fmat>(7,
+      2), LogSoftMax<arma::fmat, arma::fmat>());
+
+  // Train() with no iterations sets the data.
+  RMSProp<ModelType> opt(model, 0.01, 0.99, 1e-8, 1, -1);
+  model.Train(data, labels, opt);
+  RMSProp<FloatModelType> floatOpt(floatModel, 0.01, 0.99, 1e-8, 1, -1);
+  floatModel.Train(data, labels, floatOpt);
+
+  BOOST_REQUIRE_EQUAL(floatModel.Parameters().n_elem,
+      model.Parameters().n_elem);
+  floatModel.Parameters() = model.Parameters();
+
+  BOOST_REQUIRE_CLOSE(floatModel.Evaluate(floatModel.Parameters(), 3, 20,
+      true), model.Evaluate(model.Parameters(), 3, 20, true), 1e-3);
+
+  arma::mat gradient, floatGradient;
+  model.Gradient(model.Parameters(), 3, gradient, 20);
+  floatModel.Gradient(floatModel.Parameters(), 3, floatGradient, 20);
+  BOOST_REQUIRE_EQUAL(floatGradient.n_elem, gradient.n_elem);
+  for (size_t i = 0; i < gradient.n_elem; ++i)
+    BOOST_REQUIRE_CLOSE(floatGradient[i] + 1.0, gradient[i] + 1.0, 1e-3);
+
+  arma::mat predictions, floatPredictions;
+  model.Predict(data, predictions);
+  floatModel.Predict(data, floatPredictions);
+  BOOST_REQUIRE_EQUAL(floatPredictions.n_cols, predictions.n_cols);
+  for (size_t i = 0; i < predictions.n_elem; ++i)
+    BOOST_REQUIRE_CLOSE(floatPredictions[i], predictions[i], 1e-3);
+
+  // The layers must see changes of the master parameters.
+  floatModel.Parameters() *= 2;
+  model.Parameters() *= 2;
+  BOOST_REQUIRE_CLOSE(floatModel.Evaluate(floatModel.Parameters(), 0, 30,
+      true), model.Evaluate(model.Parameters(), 0, 30, true), 1e-3);
+}
+
+/**
+ * Make sure the predictions of a quantized network are close to those of the
+ * network, and that their classes agree.
+ */
+template<typename QuantizedType>
+void CheckQuantizedPredictions(QuantizedType& quantized,
+                               const arma::mat& data,
+                               const arma::mat& predictions)
+{
+  arma::mat quantizedPredictions;
+  quantized.Predict(data, quantizedPredictions);
+
+  BOOST_REQUIRE_EQUAL(quantizedPredictions.n_rows, predictions.n_rows);
+  BOOST_REQUIRE_EQUAL(quantizedPredictions.n_cols, predictions.n_cols);
+  BOOST_REQUIRE_LT(arma::norm(quantizedPredictions - predictions, "fro") /
+      arma::norm(predictions, "fro"), 0.05);
+
+  size_t agree = 0;
+  for (size_t i = 0; i < predictions.n_cols; ++i)
+  {
+    if (quantizedPredictions.col(i).index_max() ==
+        predictions.col(i).index_max())
+      ++agree;
+  }
+  BOOST_REQUIRE_GE(agree, (size_t) (0.95 * predictions.n_cols));
+}
+
+/**
+ * Quantize a network of fully connected layers (with two consecutive Linear
+ * layers, so the output of the first one is requantized directly), and make
+ * sure it predicts like the network, and survives serialization.
+ */
+BOOST_AUTO_TEST_CASE(QuantizedFFNTest)
+{
+  arma::mat data = arma::randu<arma::mat>(10, 200);
+
+  FFN<NegativeLogLikelihood<> > model;
+  model.Add<Linear<> >(10, 16);
+  model.Add<Linear<> >(16, 12);
+  model.Add<ReLULayer<> >();
+  model.Add<LinearNoBias<> >(12, 3);
+  model.Add<LogSoftMax<> >();
+  model.ResetParameters();
+
+  arma::mat predictions;
+  model.Predict(data, predictions);
+
+  QuantizedFFN<> quantized(model, data);
+  BOOST_REQUIRE_EQUAL(quantized.QuantizedLayers().size(), 3);
+  BOOST_REQUIRE_EQUAL(quantized.Parameters().n_elem, 0);
+
+  // The largest weight of each layer maps to the largest 8-bit value.
+  for (size_t i = 0; i < quantized.QuantizedLayers().size(); ++i)
+  {
+    const arma::Mat<arma::s8>& weights =
+        quantized.QuantizedLayers()[i].Weights();
+    BOOST_REQUIRE_EQUAL(arma::abs(arma::conv_to<arma::imat>::from(
+        weights)).max(), 127);
+  }
+
+  CheckQuantizedPredictions(quantized, data, predictions);
+
+  // A quantized network is loaded into one with the same (untrained) layers.
+  FFN<NegativeLogLikelihood<> > sameLayers;
+  sameLayers.Add<Linear<> >(10, 16);
+  sameLayers.Add<Linear<> >(16, 12);
+  sameLayers.Add<ReLULayer<> >();
+  sameLayers.Add<LinearNoBias<> >(12, 3);
+  sameLayers.Add<LogSoftMax<> >();
+
+  QuantizedFFN<> xmlQuantized(sameLayers), textQuantized(sameLayers),
+      binaryQuantized(sameLayers);
+  SerializeObjectAll(quantized, xmlQuantized, textQuantized, binaryQuantized);
+
+  arma::mat quantizedPredictions;
+  quantized.Predict(data, quantizedPredictions);
+  arma::mat xmlPredictions, textPredictions, binaryPredictions;
+  xmlQuantized.Predict(data, xmlPredictions);
+  textQuantized.Predict(data, textPredictions);
+  binaryQuantized.Predict(data, binaryPredictions);
+  CheckMatrices(quantizedPredictions, xmlPredictions, textPredictions,
+      binaryPredictions);
+}
+
+/**
+ * Quantize a network with a (padded) Convolution layer, and make sure it
+ * predicts like the network.
+ */
+BOOST_AUTO_TEST_CASE(QuantizedConvolutionFFNTest)
+{
+  arma::mat data = arma::randu<arma::mat>(36, 50);
+
+  FFN<NegativeLogLikelihood<> > model;
+  model.Add<Convolution<> >(1, 2, 3, 3, 1, 1, 1, 1, 6, 6);
+  model.Add<ReLULayer<> >();
+  model.Add<Linear<> >(72, 3);
+  model.Add<LogSoftMax<> >();
+  model.ResetParameters();
+
+  arma::mat predictions;
+  model.Predict(data, predictions);
+
+  QuantizedFFN<> quantized(model, data);
+  BOOST_REQUIRE_EQUAL(quantized.QuantizedLayers().size(), 2);
+  BOOST_REQUIRE_EQUAL(quantized.QuantizedLayers()[0].OutputWidth(), 6);
+  BOOST_REQUIRE_EQUAL(quantized.QuantizedLayers()[0].OutputHeight(), 6);
+
+  CheckQuantizedPredictions(quantized, data, predictions);
+}
+
+/**
+ * Train a network on shards read by a DataLoader, and make sure it learns the
+ * data of the shards.
+ */
+BOOST_AUTO_TEST_CASE(FFNDataLoaderTrainTest)
+{
+  // Two classes on either side of a line; the label is the last row of each
+  // shard.
+  arma::mat data = arma::randu<arma::mat>(2, 600);
+  arma::mat labels(1, 600);
+  for (size_t i = 0; i < data.n_cols; ++i)
+    labels(i) = (data(0, i) + data(1, i) > 1.0) ? 2 : 1;
+
+  std::vector<std::string> shards;
+  for (size_t i = 0; i < 3; ++i)
+  {
+    std::ostringstream filename;
+    filename << "ffn_data_loader_shard_" << i << ".bin";
+    shards.push_back(filename.str());
+
+    arma::mat shard = arma::join_cols(data.cols(200 * i, 200 * i + 199),
+        labels.cols(200 * i, 200 * i + 199));
+    data::Save(filename.str(), shard, true);
+  }
+
+  // The transformation centers the predictors.
+  data::DataLoader loader(shards, 100, data::DataLoader::SplitReader(1),
+      [](arma::mat& predictors, arma::mat&) { predictors -= 0.5; });
+
+  FFN<NegativeLogLikelihood<> > model;
+  model.Add<Linear<> >(2, 8);
+  model.Add<SigmoidLayer<> >();
+  model.Add<Linear<> >(8, 2);
+  model.Add<LogSoftMax<> >();
+
+  // One pass over each batch of the loader.
+  RMSProp<decltype(model)> opt(model, 0.01, 0.88, 1e-8, 100, -1);
+  model.Train(loader, opt, 30);
+
+  arma::mat predictions;
+  model.Predict(data - 0.5, predictions);
+  size_t correct = 0;
+  for (size_t i = 0; i < predictions.n_cols; ++i)
+  {
+    const size_t prediction = arma::as_scalar(arma::find(
+        arma::max(predictions.col(i)) == predictions.col(i), 1)) + 1;
+    if (prediction == labels(i))
+      ++correct;
+  }
+  BOOST_REQUIRE_GE(correct, 540);
+
+  for (size_t i = 0; i < 3; ++i)
+    remove(shards[i].c_str());
+}
+
+/**
+ * Make sure the profiler records the passes of each layer while it is
+ * enabled, and writes them out.
+ */
+BOOST_AUTO_TEST_CASE(FFNLayerProfilerTest)
+{
+  arma::mat data = arma::randu<arma::mat>(4, 50);
+  arma::mat labels = arma::ones<arma::mat>(1, 50);
+  labels.elem(arma::find(data.row(0) > 0.5)).fill(2);
+
+  FFN<NegativeLogLikelihood<> > model(data, labels);
+  model.Add<Linear<> >(4, 6);
+  model.Add<ReLULayer<> >();
+  model.Add<Linear<> >(6, 2);
+  model.Add<LogSoftMax<> >();
+  model.ResetParameters();
+
+  // Nothing is recorded until the profiler is enabled.
+  arma::mat gradient;
+  model.Gradient(model.Parameters(), 0, gradient, 10);
+  BOOST_REQUIRE_EQUAL(model.Profiler().Records().size(), 0);
+
+  model.Profiler().Enable(true);
+  for (size_t i = 0; i < 5; ++i)
+    model.Gradient(model.Parameters(), 10 * i, gradient, 10);
+  model.Profiler().Disable();
+  model.Gradient(model.Parameters(), 0, gradient, 10);
+
+  const std::vector<LayerProfiler::LayerRecord>& records =
+      model.Profiler().Records();
+  BOOST_REQUIRE_EQUAL(records.size(), 4);
+  BOOST_REQUIRE_EQUAL(records[0].name, "Linear");
+  BOOST_REQUIRE_EQUAL(records[1].name, "RectifierFunction");
+  BOOST_REQUIRE_EQUAL(records[3].name, "LogSoftMax");
+  for (size_t i = 0; i < records.size(); ++i)
+  {
+    BOOST_REQUIRE_EQUAL(records[i].calls[LayerProfiler::FORWARD], 5);
+    BOOST_REQUIRE_EQUAL(records[i].calls[LayerProfiler::BACKWARD], 5);
+    BOOST_REQUIRE_EQUAL(records[i].calls[LayerProfiler::GRADIENT], 5);
+  }
+
+  // Two operations per weight and per point.
+  BOOST_REQUIRE_CLOSE(records[0].flops[LayerProfiler::FORWARD],
+      5 * 2.0 * (4 * 6 + 6) * 10, 1e-5);
+  BOOST_REQUIRE_CLOSE(records[2].flops[LayerProfiler::GRADIENT],
+      5 * 2.0 * (6 * 2 + 2) * 10, 1e-5);
+  BOOST_REQUIRE_CLOSE(records[1].flops[LayerProfiler::FORWARD], 5 * 6 * 10,
+      1e-5);
+
+  std::ostringstream report;
+  model.Profiler().Report(report);
+  BOOST_REQUIRE_NE(report.str().find("RectifierFunction"), std::string::npos);
+
+  // One trace event per recorded pass.
+  std::ostringstream trace;
+  model.Profiler().ChromeTrace(trace);
+  const std::string traceString = trace.str();
+  size_t events = 0;
+  for (size_t pos = traceString.find("\"ph\": \"X\""); pos !=
+      std::string::npos; pos = traceString.find("\"ph\": \"X\"", pos + 1))
+    ++events;
+  BOOST_REQUIRE_EQUAL(events, 4 * 3 * 5);
+
+  model.Profiler().Reset();
+  BOOST_REQUIRE_EQUAL(model.Profiler().Records().size(), 0);
+}
+
+/**
+ * Make sure that the gradient of a network is the same with and without
+ * checkpoints, including for stochastic layers and nested modules.
+ */
+BOOST_AUTO_TEST_CASE(FFNCheckpointGradientTest)
+{
+  arma::mat data = arma::randu<arma::mat>(5, 40);
+  arma::mat labels = arma::ones<arma::mat>(1, 40);
+  labels.elem(arma::find(data.row(1) > 0.5)).fill(2);
+
+  FFN<NegativeLogLikelihood<> > model(data, labels);
+  model.Add<Linear<> >(5, 8);
+  model.Add<ReLULayer<> >();
+  model.Add<Dropout<> >(0.3);
+  model.Add<Linear<> >(8, 6);
+  Sequential<>* sequential = new Sequential<>();
+  sequential->Add<SigmoidLayer<> >();
+  sequential->Add<Linear<> >(6, 2);
+  model.Add(sequential);
+  model.Add<LogSoftMax<> >();
+  model.ResetParameters();
+
+  for (size_t interval = 1; interval <= 6; ++interval)
+  {
+    arma::mat gradient, checkpointGradient;
+    model.CheckpointInterval() = 0;
+    math::RandomSeed(7);
+    model.Gradient(model.Parameters(), 0, gradient, 20);
+
+    // The dropout masks drawn again for the recomputed segments must be the
+    // same as those of the first pass.
+    model.CheckpointInterval() = interval;
+    math::RandomSeed(7);
+    model.Gradient(model.Parameters(), 0, checkpointGradient, 20);
+
+    CheckMatrices(gradient, checkpointGradient);
+  }
+}
+
+/**
+ * Make sure that the checkpointed passes reject recurrent modules, whose state
+ * would change when their segment is recomputed.
+ */
+BOOST_AUTO_TEST_CASE(FFNCheckpointRecurrentTest)
+{
+  arma::mat data = arma::randu<arma::mat>(5, 10);
+  arma::mat labels = arma::ones<arma::mat>(1, 10);
+
+  FFN<NegativeLogLikelihood<> > model(data, labels);
+  model.Add<Linear<> >(5, 4);
+  Sequential<>* sequential = new Sequential<>();
+  sequential->Add<LSTM<> >(4, 3, 5);
+  model.Add(sequential);
+  model.Add<LogSoftMax<> >();
+  model.ResetParameters();
+
+  arma::mat gradient;
+  model.CheckpointInterval() = 1;
+  BOOST_REQUIRE_THROW(model.Gradient(model.Parameters(), 0, gradient, 10),
+      std::invalid_argument);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
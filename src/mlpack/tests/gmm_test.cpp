@@ -13,17 +13,21 @@
 #include <mlpack/core.hpp>
 
 #include <mlpack/methods/gmm/gmm.hpp>
+#include <mlpack/methods/gmm/diagonal_gmm.hpp>
 
 #include <mlpack/methods/gmm/no_constraint.hpp>
 #include <mlpack/methods/gmm/positive_definite_constraint.hpp>
 #include <mlpack/methods/gmm/diagonal_constraint.hpp>
 #include <mlpack/methods/gmm/eigenvalue_ratio_constraint.hpp>
+#include <mlpack/methods/gmm/online_em_fit.hpp>
 
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
+#include "serialization.hpp"
 
 using namespace mlpack;
 using namespace mlpack::gmm;
+using namespace mlpack::kmeans;
 
 BOOST_AUTO_TEST_SUITE(GMMTest);
 /**
@@ -78,6 +82,43 @@ BOOST_AUTO_TEST_CASE(GMMProbabilityComponentTest)
   BOOST_REQUIRE_CLOSE(gmm.Probability("1.4 0", 1), 0.0067568972024, 1e-5);
 }
 
+/**
+ * Test the batch GMM::Probability() and GMM::LogProbability() against the
+ * probabilities of single observations, with enough observations for several
+ * blocks, and make sure that far away observations don't underflow in log
+ * space.
+ */
+BOOST_AUTO_TEST_CASE(GMMBatchProbabilityTest)
+{
+  GMM gmm(2, 2);
+  gmm.Component(0) = distribution::GaussianDistribution("0 0", "1 0; 0 1");
+  gmm.Component(1) = distribution::GaussianDistribution("3 3", "2 1; 1 2");
+  gmm.Weights() = "0.3 0.7";
+
+  arma::mat observations = 3.0 * arma::randn<arma::mat>(2, 2500);
+  arma::vec probabilities, logProbabilities;
+  gmm.Probability(observations, probabilities);
+  gmm.LogProbability(observations, logProbabilities);
+
+  BOOST_REQUIRE_EQUAL(probabilities.n_elem, observations.n_cols);
+  BOOST_REQUIRE_EQUAL(logProbabilities.n_elem, observations.n_cols);
+  for (size_t i = 0; i < observations.n_cols; ++i)
+  {
+    const double probability = gmm.Probability(observations.unsafe_col(i));
+    BOOST_REQUIRE_CLOSE(probabilities[i], probability, 1e-5);
+    BOOST_REQUIRE_CLOSE(logProbabilities[i], std::log(probability), 1e-5);
+  }
+
+  // The probability of this point underflows, but its log probability
+  // doesn't.  The second component dominates; its log probability is
+  // -log(2 pi) - 0.5 log(3) - (1/3) (x^2 - xy + y^2) with x = y = 997.
+  arma::mat far("1000; 1000");
+  gmm.LogProbability(far, logProbabilities);
+  const double expected = std::log(0.7) - std::log(2 * M_PI) -
+      0.5 * std::log(3.0) - 997.0 * 997.0 / 3.0;
+  BOOST_REQUIRE_CLOSE(logProbabilities[0], expected, 1e-5);
+}
+
 /**
  * Test training a model on only one Gaussian (randomly generated) in two
  * dimensions.  We will vary the dataset size from small to large.  The EM
@@ -761,4 +802,333 @@ BOOST_AUTO_TEST_CASE(UseExistingModelTest)
 }
 
 
+/**
+ * Make sure that EM still assigns observations whose probability under every
+ * component underflows to 0: the responsibilities are computed in log-space, so
+ * each observation goes to its closest component.
+ */
+BOOST_AUTO_TEST_CASE(EMFitUnderflowTest)
+{
+  std::vector<distribution::GaussianDistribution> dists;
+  dists.push_back(distribution::GaussianDistribution("0.0", "0.0001"));
+  dists.push_back(distribution::GaussianDistribution("10.0", "0.0001"));
+  arma::vec weights("0.5 0.5");
+
+  // Both observations are about 40 standard deviations from either component.
+  arma::mat observations("4.0 6.0");
+
+  // Run a single iteration.
+  EMFit<> fitter(2);
+  fitter.Estimate(observations, dists, weights, true);
+
+  BOOST_REQUIRE_CLOSE(dists[0].Mean()[0], 4.0, 1e-5);
+  BOOST_REQUIRE_CLOSE(dists[1].Mean()[0], 6.0, 1e-5);
+  BOOST_REQUIRE_CLOSE(weights[0], 0.5, 1e-5);
+  BOOST_REQUIRE_CLOSE(weights[1], 0.5, 1e-5);
+}
+
+#ifdef HAS_OPENMP
+/**
+ * Make sure that EM gives the same model with one thread and with four
+ * threads, up to the order of the floating-point sums.
+ */
+BOOST_AUTO_TEST_CASE(ParallelEMFitTest)
+{
+  arma::mat data(3, 5000, arma::fill::randn);
+  data.cols(2500, 4999) += 5.0;
+  const size_t prevNumThreads = omp_get_max_threads();
+
+  // Start both models from the same initial model and run a few iterations.
+  GMM gmm(2, 3);
+  gmm.Train(data, 1, false, EMFit<>(2));
+  GMM parallelGmm(gmm);
+
+  omp_set_num_threads(1);
+  gmm.Train(data, 1, true, EMFit<>(10));
+  omp_set_num_threads(4);
+  parallelGmm.Train(data, 1, true, EMFit<>(10));
+
+  for (size_t i = 0; i < gmm.Gaussians(); ++i)
+  {
+    BOOST_REQUIRE_CLOSE(gmm.Weights()[i], parallelGmm.Weights()[i], 1e-5);
+    for (size_t j = 0; j < gmm.Dimensionality(); ++j)
+    {
+      BOOST_REQUIRE_CLOSE(gmm.Component(i).Mean()[j],
+          parallelGmm.Component(i).Mean()[j], 1e-5);
+      for (size_t k = 0; k < gmm.Dimensionality(); ++k)
+      {
+        BOOST_REQUIRE_CLOSE(gmm.Component(i).Covariance()(j, k),
+            parallelGmm.Component(i).Covariance()(j, k), 1e-5);
+      }
+    }
+  }
+
+  omp_set_num_threads(prevNumThreads);
+}
+
+/**
+ * Make sure that several trials give the same model with one thread and with
+ * four threads, since each trial has its own random stream.
+ */
+BOOST_AUTO_TEST_CASE(ParallelGMMTrialsTest)
+{
+  arma::mat data(2, 2000, arma::fill::randn);
+  data.cols(1000, 1999) += 4.0;
+  const size_t prevNumThreads = omp_get_max_threads();
+
+  GMM gmm(2, 2), parallelGmm(2, 2);
+  omp_set_num_threads(1);
+  const double likelihood = gmm.Train(data, 5);
+  omp_set_num_threads(4);
+  const double parallelLikelihood = parallelGmm.Train(data, 5);
+  omp_set_num_threads(prevNumThreads);
+
+  BOOST_REQUIRE_CLOSE(likelihood, parallelLikelihood, 1e-5);
+  for (size_t i = 0; i < gmm.Gaussians(); ++i)
+  {
+    BOOST_REQUIRE_CLOSE(gmm.Weights()[i], parallelGmm.Weights()[i], 1e-5);
+    for (size_t j = 0; j < gmm.Dimensionality(); ++j)
+    {
+      BOOST_REQUIRE_CLOSE(gmm.Component(i).Mean()[j],
+          parallelGmm.Component(i).Mean()[j], 1e-5);
+    }
+  }
+}
+#endif
+
+/**
+ * Make sure that online EM, reading batches from a stream, recovers two
+ * well-separated Gaussians.
+ */
+BOOST_AUTO_TEST_CASE(OnlineEMFitTest)
+{
+  arma::mat data(2, 4000, arma::fill::randn);
+  data.cols(0, 999) *= 0.5;
+  data.cols(1000, 3999) += 10.0;
+
+  // The stream is read in order, so the first batch must be a mixture too.
+  const arma::uvec order = arma::shuffle(arma::linspace<arma::uvec>(0, 3999,
+      4000));
+  data = data.cols(order);
+
+  std::stringstream stream;
+  for (size_t i = 0; i < data.n_cols; ++i)
+    stream << data(0, i) << "," << data(1, i) << std::endl;
+
+  StreamBatchSource source(stream);
+  std::vector<distribution::GaussianDistribution> dists(2);
+  arma::vec weights(2);
+  OnlineEMFit<> em(500, 100);
+  em.Estimate(source, dists, weights);
+
+  BOOST_REQUIRE_EQUAL(em.Steps(), 100);
+  BOOST_REQUIRE_EQUAL(dists[0].Dimensionality(), 2);
+
+  // Find which component is the one near the origin.
+  const size_t first = (arma::norm(dists[0].Mean()) <
+      arma::norm(dists[1].Mean())) ? 0 : 1;
+  const size_t second = 1 - first;
+
+  BOOST_REQUIRE_CLOSE(weights[first], 0.25, 10.0);
+  BOOST_REQUIRE_CLOSE(weights[second], 0.75, 5.0);
+  for (size_t d = 0; d < 2; ++d)
+  {
+    BOOST_REQUIRE_SMALL(dists[first].Mean()[d], 0.15);
+    BOOST_REQUIRE_CLOSE(dists[second].Mean()[d], 10.0, 1.5);
+    BOOST_REQUIRE_CLOSE(dists[first].Covariance()(d, d), 0.25, 25.0);
+    BOOST_REQUIRE_CLOSE(dists[second].Covariance()(d, d), 1.0, 15.0);
+  }
+}
+
+/**
+ * Make sure that a serialized OnlineEMFit continues training like the original
+ * one.
+ */
+BOOST_AUTO_TEST_CASE(OnlineEMFitSerializationTest)
+{
+  arma::mat data(3, 2000, arma::fill::randn);
+  data.cols(1000, 1999) += 6.0;
+
+  MatrixBatchSource<> source(data);
+  std::vector<distribution::GaussianDistribution> dists(2);
+  arma::vec weights(2);
+  OnlineEMFit<> em(200, 10);
+  em.Estimate(source, dists, weights);
+
+  OnlineEMFit<> xmlEm(1, 1), textEm(1, 1), binaryEm(1, 1);
+  SerializeObjectAll(em, xmlEm, textEm, binaryEm);
+
+  BOOST_REQUIRE_EQUAL(xmlEm.BatchSize(), 200);
+  BOOST_REQUIRE_EQUAL(textEm.MaxIterations(), 10);
+  BOOST_REQUIRE_EQUAL(binaryEm.Steps(), em.Steps());
+
+  // Continue training each fitter with the same batches.
+  std::vector<distribution::GaussianDistribution> resultDists[4];
+  arma::vec resultWeights[4];
+  OnlineEMFit<>* fitters[4] = { &em, &xmlEm, &textEm, &binaryEm };
+  for (size_t f = 0; f < 4; ++f)
+  {
+    resultDists[f] = dists;
+    resultWeights[f] = weights;
+    math::RandomSeed(42);
+    fitters[f]->Estimate(source, resultDists[f], resultWeights[f], true);
+  }
+
+  for (size_t f = 1; f < 4; ++f)
+  {
+    BOOST_REQUIRE_EQUAL(fitters[f]->Steps(), em.Steps());
+    for (size_t i = 0; i < 2; ++i)
+    {
+      BOOST_REQUIRE_CLOSE(resultWeights[f][i], resultWeights[0][i], 1e-5);
+      CheckMatrices(resultDists[f][i].Mean(), resultDists[0][i].Mean());
+      CheckMatrices(resultDists[f][i].Covariance(),
+          resultDists[0][i].Covariance());
+    }
+  }
+}
+
+/**
+ * Make sure that resuming online EM from a model alone (without running
+ * statistics) keeps a good model good.
+ */
+BOOST_AUTO_TEST_CASE(OnlineEMFitResumeFromModelTest)
+{
+  arma::mat data(2, 2000, arma::fill::randn);
+  data.cols(1000, 1999) += 8.0;
+
+  GMM gmm(2, 2);
+  gmm.Train(data);
+
+  std::vector<distribution::GaussianDistribution> dists;
+  for (size_t i = 0; i < gmm.Gaussians(); ++i)
+    dists.push_back(gmm.Component(i));
+  arma::vec weights = gmm.Weights();
+
+  MatrixBatchSource<> source(data);
+  OnlineEMFit<> em(500, 20);
+  em.Estimate(source, dists, weights, true);
+
+  for (size_t i = 0; i < gmm.Gaussians(); ++i)
+  {
+    BOOST_REQUIRE_CLOSE(weights[i], gmm.Weights()[i], 10.0);
+    for (size_t d = 0; d < 2; ++d)
+    {
+      BOOST_REQUIRE_SMALL(dists[i].Mean()[d] - gmm.Component(i).Mean()[d],
+          0.2);
+    }
+  }
+
+  // Mismatched dimensionality should be an error.
+  arma::mat wrongData(3, 100, arma::fill::randn);
+  MatrixBatchSource<> wrongSource(wrongData);
+  BOOST_REQUIRE_THROW(em.Estimate(wrongSource, dists, weights, true),
+      std::invalid_argument);
+}
+
+/**
+ * Make sure a DiagonalGMM gives the same probabilities and classifications as a
+ * GMM with the same diagonal covariances.
+ */
+BOOST_AUTO_TEST_CASE(DiagonalGMMProbabilityTest)
+{
+  const size_t gaussians = 6;
+  const size_t dims = 10;
+  GMM gmm(gaussians, dims);
+  DiagonalGMM diagonalGMM(gaussians, dims);
+
+  arma::vec weights(gaussians, arma::fill::randu);
+  weights /= arma::accu(weights);
+  gmm.Weights() = weights;
+  diagonalGMM.Weights() = weights;
+  for (size_t i = 0; i < gaussians; ++i)
+  {
+    const arma::vec mean = 10 * arma::randu<arma::vec>(dims);
+    const arma::vec variances = arma::randu<arma::vec>(dims) + 0.5;
+    gmm.Component(i).Mean() = mean;
+    gmm.Component(i).Covariance(arma::mat(arma::diagmat(variances)));
+    diagonalGMM.Component(i).Mean() = mean;
+    diagonalGMM.Component(i).Covariance(variances);
+  }
+
+  // Enough points for several blocks.
+  arma::mat points = 10 * arma::randu<arma::mat>(dims, 2500);
+
+  arma::vec logProbabilities, diagonalLogProbabilities;
+  gmm.LogProbability(points, logProbabilities);
+  diagonalGMM.LogProbability(points, diagonalLogProbabilities);
+
+  arma::Row<size_t> labels, diagonalLabels;
+  gmm.Classify(points, labels);
+  diagonalGMM.Classify(points, diagonalLabels);
+
+  for (size_t i = 0; i < points.n_cols; ++i)
+  {
+    BOOST_REQUIRE_CLOSE(logProbabilities[i], diagonalLogProbabilities[i],
+        1e-5);
+    BOOST_REQUIRE_EQUAL(labels[i], diagonalLabels[i]);
+  }
+
+  BOOST_REQUIRE_CLOSE(gmm.Probability(points.col(0)),
+      diagonalGMM.Probability(points.col(0)), 1e-5);
+}
+
+/**
+ * Make sure that training a DiagonalGMM from a given model gives the same model
+ * as training a GMM with the DiagonalConstraint from the same model.
+ */
+BOOST_AUTO_TEST_CASE(DiagonalGMMTrainTest)
+{
+  const size_t gaussians = 3;
+  const size_t dims = 4;
+
+  // Generate well-separated Gaussians with diagonal covariances.
+  arma::mat data(dims, 3000);
+  for (size_t i = 0; i < data.n_cols; ++i)
+  {
+    const size_t g = i % gaussians;
+    data.col(i) = 20.0 * g + (1.0 + g) * arma::randn<arma::vec>(dims);
+  }
+
+  GMM gmm(gaussians, dims);
+  DiagonalGMM diagonalGMM(gaussians, dims);
+  for (size_t i = 0; i < gaussians; ++i)
+  {
+    const arma::vec mean = data.col(i) + 0.5;
+    gmm.Component(i).Mean() = mean;
+    diagonalGMM.Component(i).Mean() = mean;
+  }
+
+  EMFit<KMeans<>, DiagonalConstraint> fitter(20, 1e-10);
+  DiagonalEMFit<> diagonalFitter(20, 1e-10);
+  const double likelihood = gmm.Train(data, 1, true, fitter);
+  const double diagonalLikelihood = diagonalGMM.Train(data, 1, true,
+      diagonalFitter);
+
+  BOOST_REQUIRE_CLOSE(likelihood, diagonalLikelihood, 1e-5);
+  for (size_t i = 0; i < gaussians; ++i)
+  {
+    BOOST_REQUIRE_CLOSE(gmm.Weights()[i], diagonalGMM.Weights()[i], 1e-5);
+    for (size_t d = 0; d < dims; ++d)
+    {
+      BOOST_REQUIRE_CLOSE(gmm.Component(i).Mean()[d],
+          diagonalGMM.Component(i).Mean()[d], 1e-5);
+      BOOST_REQUIRE_CLOSE(gmm.Component(i).Covariance()(d, d),
+          diagonalGMM.Component(i).Covariance()[d], 1e-5);
+    }
+  }
+
+  // The trained model should have found the Gaussians.
+  arma::Row<size_t> labels;
+  diagonalGMM.Classify(data, labels);
+  for (size_t i = gaussians; i < data.n_cols; ++i)
+    BOOST_REQUIRE_EQUAL(labels[i], labels[i % gaussians]);
+
+  // Training from scratch should find them too.
+  DiagonalGMM fresh(gaussians, dims);
+  fresh.Train(data, 3);
+  fresh.Classify(data, labels);
+  for (size_t i = gaussians; i < data.n_cols; ++i)
+    BOOST_REQUIRE_EQUAL(labels[i], labels[i % gaussians]);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
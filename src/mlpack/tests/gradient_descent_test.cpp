@@ -54,4 +54,28 @@ BOOST_AUTO_TEST_CASE(RosenbrockTest)
     BOOST_REQUIRE_CLOSE(coordinates[j], (double) 1.0, 1e-3);
 }
 
+/**
+ * With a step size that makes the fixed-step iteration diverge, the Armijo
+ * line search should still find the minimum.
+ */
+BOOST_AUTO_TEST_CASE(LineSearchGDTestFunction)
+{
+  GDTestFunction f;
+  GradientDescent<GDTestFunction> s(f, 3.0, 1000, 1e-9, true);
+
+  arma::vec coordinates = f.GetInitialPoint();
+  double result = s.Optimize(coordinates);
+
+  BOOST_REQUIRE_SMALL(result, 1e-4);
+  BOOST_REQUIRE_SMALL(coordinates[0], 1e-2);
+  BOOST_REQUIRE_SMALL(coordinates[1], 1e-2);
+  BOOST_REQUIRE_SMALL(coordinates[2], 1e-2);
+
+  // Without the line search, the same step size diverges.
+  GradientDescent<GDTestFunction> fixed(f, 3.0, 100, 1e-9);
+  coordinates = f.GetInitialPoint();
+  BOOST_REQUIRE_GT(fixed.Optimize(coordinates), f.Evaluate(
+      f.GetInitialPoint()));
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -10,6 +10,7 @@
  */
 #include <mlpack/core.hpp>
 #include <mlpack/methods/hmm/hmm.hpp>
+#include <mlpack/methods/hmm/hmm_model.hpp>
 #include <mlpack/methods/gmm/gmm.hpp>
 
 #include <boost/test/unit_test.hpp>
@@ -1173,5 +1174,362 @@ BOOST_AUTO_TEST_CASE(DiscreteHMMLoadSaveTest)
           hmm2.Emission()[j].Probabilities()[i], 1e-3);
 }
 
+/**
+ * Make sure that the batch Predict() gives the same state sequences and
+ * log-likelihoods as predicting each sequence on its own.
+ */
+BOOST_AUTO_TEST_CASE(GaussianHMMBatchPredictTest)
+{
+  arma::vec initial("0.6 0.4");
+  arma::mat transition("0.8 0.3; 0.2 0.7");
+  std::vector<GaussianDistribution> emission;
+  emission.push_back(GaussianDistribution("0 0", "1 0; 0 1"));
+  emission.push_back(GaussianDistribution("4 4", "2 0.5; 0.5 1"));
+  HMM<GaussianDistribution> hmm(initial, transition, emission);
+
+  std::vector<arma::mat> dataSeq(50);
+  std::vector<arma::Row<size_t>> generatedStates(50);
+  for (size_t i = 0; i < dataSeq.size(); ++i)
+    hmm.Generate(5 + 3 * i, dataSeq[i], generatedStates[i]);
+
+  std::vector<arma::Row<size_t>> stateSeq;
+  arma::vec logLikelihoods;
+  hmm.Predict(dataSeq, stateSeq, logLikelihoods);
+
+  BOOST_REQUIRE_EQUAL(stateSeq.size(), dataSeq.size());
+  BOOST_REQUIRE_EQUAL(logLikelihoods.n_elem, dataSeq.size());
+  for (size_t i = 0; i < dataSeq.size(); ++i)
+  {
+    arma::Row<size_t> states;
+    const double logLikelihood = hmm.Predict(dataSeq[i], states);
+
+    BOOST_REQUIRE_CLOSE(logLikelihoods[i], logLikelihood, 1e-5);
+    BOOST_REQUIRE_EQUAL(stateSeq[i].n_elem, states.n_elem);
+    for (size_t t = 0; t < states.n_elem; ++t)
+      BOOST_REQUIRE_EQUAL(stateSeq[i][t], states[t]);
+  }
+}
+
+/**
+ * Make sure that the log-likelihood and the most probable state sequence of
+ * observations whose probabilities underflow are still correct.
+ */
+BOOST_AUTO_TEST_CASE(GaussianHMMUnderflowTest)
+{
+  // With a single state, the log-likelihood of the sequence is the sum of the
+  // log probabilities of the observations.
+  arma::vec initial("1");
+  arma::mat transition("1");
+  std::vector<GaussianDistribution> emission;
+  emission.push_back(GaussianDistribution("0", "1"));
+  HMM<GaussianDistribution> hmm(initial, transition, emission);
+
+  arma::mat dataSeq(1, 20);
+  dataSeq.fill(1000.0);
+  const double expected = 20 * (-0.5 * std::log(2 * M_PI) - 0.5 * 1e6);
+  BOOST_REQUIRE_CLOSE(hmm.LogLikelihood(dataSeq), expected, 1e-5);
+
+  arma::Row<size_t> states;
+  BOOST_REQUIRE_CLOSE(hmm.Predict(dataSeq, states), expected, 1e-5);
+
+  // With two states, Baum-Welch must still be able to move the far state
+  // towards the observations.
+  arma::vec initial2("0.5 0.5");
+  arma::mat transition2("0.5 0.5; 0.5 0.5");
+  std::vector<GaussianDistribution> emission2;
+  emission2.push_back(GaussianDistribution("0", "1"));
+  emission2.push_back(GaussianDistribution("100", "1"));
+  HMM<GaussianDistribution> hmm2(initial2, transition2, emission2);
+
+  std::vector<arma::mat> trainSeq(1, dataSeq);
+  trainSeq[0].cols(0, 9) += 0.1 * arma::randn<arma::rowvec>(10);
+  hmm2.Train(trainSeq);
+
+  BOOST_REQUIRE(std::isfinite(hmm2.LogLikelihood(trainSeq[0])));
+  BOOST_REQUIRE_CLOSE(hmm2.Emission()[1].Mean()[0], 1000.0, 1.0);
+}
+
+#ifdef HAS_OPENMP
+/**
+ * Make sure that Baum-Welch gives the same model with one thread and with
+ * several.
+ */
+BOOST_AUTO_TEST_CASE(ParallelBaumWelchTest)
+{
+  arma::vec initial("0.6 0.4");
+  arma::mat transition("0.8 0.3; 0.2 0.7");
+  std::vector<GaussianDistribution> emission;
+  emission.push_back(GaussianDistribution("0 0", "1 0; 0 1"));
+  emission.push_back(GaussianDistribution("4 4", "2 0.5; 0.5 1"));
+  HMM<GaussianDistribution> hmm(initial, transition, emission);
+
+  std::vector<arma::mat> dataSeq(100);
+  std::vector<arma::Row<size_t>> states(100);
+  for (size_t i = 0; i < dataSeq.size(); ++i)
+    hmm.Generate(20, dataSeq[i], states[i]);
+
+  HMM<GaussianDistribution> parallelHmm(hmm);
+  const size_t prevNumThreads = omp_get_max_threads();
+
+  omp_set_num_threads(1);
+  hmm.Train(dataSeq);
+  omp_set_num_threads(4);
+  parallelHmm.Train(dataSeq);
+
+  for (size_t i = 0; i < 2; ++i)
+  {
+    BOOST_REQUIRE_CLOSE(hmm.Initial()[i], parallelHmm.Initial()[i], 1e-5);
+    for (size_t j = 0; j < 2; ++j)
+    {
+      BOOST_REQUIRE_CLOSE(hmm.Transition()(i, j),
+          parallelHmm.Transition()(i, j), 1e-5);
+    }
+
+    CheckMatrices(hmm.Emission()[i].Mean(), parallelHmm.Emission()[i].Mean(),
+        1e-5);
+    CheckMatrices(hmm.Emission()[i].Covariance(),
+        parallelHmm.Emission()[i].Covariance(), 1e-5);
+  }
+
+  omp_set_num_threads(prevNumThreads);
+}
+#endif
+
+/**
+ * Create a left-to-right Gaussian HMM with the given number of states, where
+ * each state either stays or moves to the next state, and the same HMM with a
+ * sparse transition matrix.
+ */
+void CreateBandedHMMs(const size_t states,
+                      HMM<GaussianDistribution>& hmm,
+                      HMM<GaussianDistribution, arma::sp_mat>& sparseHmm)
+{
+  arma::vec initial(states, arma::fill::zeros);
+  initial[0] = 1.0;
+  arma::mat transition(states, states, arma::fill::zeros);
+  std::vector<GaussianDistribution> emission;
+  for (size_t i = 0; i < states; ++i)
+  {
+    transition(i, i) = (i == states - 1) ? 1.0 : 0.7;
+    if (i < states - 1)
+      transition(i + 1, i) = 0.3;
+
+    arma::vec mean(1);
+    mean[0] = 2.0 * i;
+    emission.push_back(GaussianDistribution(mean, arma::eye<arma::mat>(1, 1)));
+  }
+
+  hmm = HMM<GaussianDistribution>(initial, transition, emission);
+  sparseHmm = HMM<GaussianDistribution, arma::sp_mat>(initial,
+      arma::sp_mat(transition), emission);
+}
+
+/**
+ * Make sure that an HMM with a sparse transition matrix gives the same
+ * log-likelihoods, state sequences, and trained model as the same HMM with a
+ * dense transition matrix.
+ */
+BOOST_AUTO_TEST_CASE(SparseTransitionHMMTest)
+{
+  HMM<GaussianDistribution> hmm;
+  HMM<GaussianDistribution, arma::sp_mat> sparseHmm;
+  CreateBandedHMMs(10, hmm, sparseHmm);
+
+  std::vector<arma::mat> dataSeq(20);
+  std::vector<arma::Row<size_t>> stateSeq(20);
+  for (size_t i = 0; i < dataSeq.size(); ++i)
+    sparseHmm.Generate(40, dataSeq[i], stateSeq[i]);
+
+  for (size_t i = 0; i < dataSeq.size(); ++i)
+  {
+    BOOST_REQUIRE_CLOSE(sparseHmm.LogLikelihood(dataSeq[i]),
+        hmm.LogLikelihood(dataSeq[i]), 1e-5);
+
+    arma::Row<size_t> states, sparseStates;
+    const double logLikelihood = hmm.Predict(dataSeq[i], states);
+    BOOST_REQUIRE_CLOSE(sparseHmm.Predict(dataSeq[i], sparseStates),
+        logLikelihood, 1e-5);
+    for (size_t t = 0; t < states.n_elem; ++t)
+      BOOST_REQUIRE_EQUAL(sparseStates[t], states[t]);
+  }
+
+  // Baum-Welch never allows a transition with zero probability, so training
+  // gives the same model.
+  hmm.Train(dataSeq);
+  sparseHmm.Train(dataSeq);
+
+  BOOST_REQUIRE_LE(sparseHmm.Transition().n_nonzero, 19);
+  const arma::mat sparseTransition(sparseHmm.Transition());
+  for (size_t i = 0; i < 10; ++i)
+  {
+    for (size_t j = 0; j < 10; ++j)
+    {
+      if (hmm.Transition()(i, j) < 1e-10)
+        BOOST_REQUIRE_SMALL(sparseTransition(i, j), 1e-10);
+      else
+        BOOST_REQUIRE_CLOSE(sparseTransition(i, j), hmm.Transition()(i, j),
+            1e-4);
+    }
+
+    BOOST_REQUIRE_CLOSE(sparseHmm.Emission()[i].Mean()[0],
+        hmm.Emission()[i].Mean()[0], 1e-4);
+  }
+
+  // Labeled training only stores the transitions seen in the labels.
+  sparseHmm.Train(dataSeq, stateSeq);
+  hmm.Train(dataSeq, stateSeq);
+  BOOST_REQUIRE_LE(sparseHmm.Transition().n_nonzero, 19);
+  CheckMatrices(arma::mat(sparseHmm.Transition()), hmm.Transition());
+}
+
+/**
+ * Make sure that Viterbi with a wide beam gives the exact state sequence, and
+ * that a narrow beam gives a valid sequence that is no more likely.
+ */
+BOOST_AUTO_TEST_CASE(BeamViterbiTest)
+{
+  HMM<GaussianDistribution> hmm;
+  HMM<GaussianDistribution, arma::sp_mat> sparseHmm;
+  CreateBandedHMMs(30, hmm, sparseHmm);
+
+  arma::mat dataSeq;
+  arma::Row<size_t> stateSeq;
+  sparseHmm.Generate(200, dataSeq, stateSeq);
+
+  arma::Row<size_t> states, beamStates, narrowStates;
+  const double logLikelihood = hmm.Predict(dataSeq, states);
+  BOOST_REQUIRE_CLOSE(sparseHmm.Predict(dataSeq, beamStates, 50.0),
+      logLikelihood, 1e-5);
+  for (size_t t = 0; t < states.n_elem; ++t)
+    BOOST_REQUIRE_EQUAL(beamStates[t], states[t]);
+
+  const double narrowLogLikelihood = sparseHmm.Predict(dataSeq, narrowStates,
+      0.0);
+  BOOST_REQUIRE_LE(narrowLogLikelihood, logLikelihood + 1e-8);
+  BOOST_REQUIRE_EQUAL(narrowStates.n_elem, dataSeq.n_cols);
+  BOOST_REQUIRE_EQUAL(narrowStates[0], 0);
+  for (size_t t = 1; t < narrowStates.n_elem; ++t)
+    BOOST_REQUIRE_GT((double) sparseHmm.Transition()(narrowStates[t],
+        narrowStates[t - 1]), 0.0);
+
+  BOOST_REQUIRE_THROW(sparseHmm.Predict(dataSeq, narrowStates, -1.0),
+      std::invalid_argument);
+}
+
+/**
+ * Make sure that the state probabilities, the most probable state sequence and
+ * the log-likelihood of a GMM HMM are the same when computed from the emission
+ * probabilities of the sequence, computed once.
+ */
+BOOST_AUTO_TEST_CASE(GMMHMMEmissionReuseTest)
+{
+  std::vector<GMM> gmms(3, GMM(2, 2));
+  for (size_t i = 0; i < gmms.size(); ++i)
+  {
+    gmms[i].Component(0) = GaussianDistribution(4.0 * i * arma::ones(2),
+        arma::eye<arma::mat>(2, 2));
+    gmms[i].Component(1) = GaussianDistribution(4.0 * i * arma::ones(2) + 1.0,
+        arma::eye<arma::mat>(2, 2));
+  }
+  arma::mat trans("0.8 0.1 0.1; 0.1 0.8 0.1; 0.1 0.1 0.8");
+  HMM<GMM> hmm(arma::vec("0.5 0.3 0.2"), trans, gmms);
+
+  arma::mat dataSeq;
+  arma::Row<size_t> stateSeq;
+  hmm.Generate(300, dataSeq, stateSeq);
+
+  arma::mat logProb;
+  hmm.EmissionLogProbability(dataSeq, logProb);
+  BOOST_REQUIRE_EQUAL(logProb.n_rows, 3);
+  BOOST_REQUIRE_EQUAL(logProb.n_cols, 300);
+  for (size_t j = 0; j < 3; ++j)
+  {
+    BOOST_REQUIRE_CLOSE(logProb(j, 7),
+        std::log(gmms[j].Probability(dataSeq.col(7))), 1e-5);
+  }
+
+  arma::mat stateProb, forward, backward, cachedStateProb;
+  arma::vec scales;
+  const double logLikelihood = hmm.Estimate(dataSeq, stateProb);
+  BOOST_REQUIRE_CLOSE(hmm.EstimateFromEmission(logProb, cachedStateProb,
+      forward, backward, scales), logLikelihood, 1e-5);
+  for (size_t i = 0; i < stateProb.n_elem; ++i)
+  {
+    if (std::abs(stateProb[i]) < 1e-8)
+      BOOST_REQUIRE_SMALL(cachedStateProb[i], 1e-8);
+    else
+      BOOST_REQUIRE_CLOSE(cachedStateProb[i], stateProb[i], 1e-5);
+  }
+
+  BOOST_REQUIRE_CLOSE(hmm.LogLikelihoodFromEmission(logProb),
+      hmm.LogLikelihood(dataSeq), 1e-5);
+
+  arma::Row<size_t> predictions, cachedPredictions;
+  BOOST_REQUIRE_CLOSE(hmm.PredictFromEmission(logProb, cachedPredictions),
+      hmm.Predict(dataSeq, predictions), 1e-5);
+  for (size_t t = 0; t < predictions.n_elem; ++t)
+    BOOST_REQUIRE_EQUAL(cachedPredictions[t], predictions[t]);
+
+  BOOST_REQUIRE_THROW(hmm.PredictFromEmission(logProb.rows(0, 1),
+      cachedPredictions), std::invalid_argument);
+}
+
+/**
+ * Test saving and loading of HMMs with sparse transition matrices, on their
+ * own and in an HMMModel.
+ */
+BOOST_AUTO_TEST_CASE(SparseHMMLoadSaveTest)
+{
+  HMM<GaussianDistribution> hmm;
+  HMM<GaussianDistribution, arma::sp_mat> sparseHmm;
+  CreateBandedHMMs(5, hmm, sparseHmm);
+
+  // Save the HMM.
+  {
+    std::ofstream ofs("test-sparse-hmm-save.xml");
+    boost::archive::xml_oarchive ar(ofs);
+    ar << data::CreateNVP(sparseHmm, "hmm");
+  }
+
+  // Load the HMM.
+  HMM<GaussianDistribution, arma::sp_mat> sparseHmm2;
+  {
+    std::ifstream ifs("test-sparse-hmm-save.xml");
+    boost::archive::xml_iarchive ar(ifs);
+    ar >> data::CreateNVP(sparseHmm2, "hmm");
+  }
+
+  // Remove clutter.
+  remove("test-sparse-hmm-save.xml");
+
+  BOOST_REQUIRE_EQUAL(sparseHmm2.Transition().n_nonzero,
+      sparseHmm.Transition().n_nonzero);
+  CheckMatrices(arma::mat(sparseHmm2.Transition()),
+      arma::mat(sparseHmm.Transition()));
+  CheckMatrices(sparseHmm2.Initial(), sparseHmm.Initial());
+  for (size_t i = 0; i < 5; ++i)
+    CheckMatrices(sparseHmm2.Emission()[i].Mean(),
+        sparseHmm.Emission()[i].Mean());
+
+  // The type of a sparse HMMModel must survive serialization.
+  HMMModel model(HMMType::SparseGaussianHMM);
+  {
+    std::ofstream ofs("test-sparse-hmm-model-save.xml");
+    boost::archive::xml_oarchive ar(ofs);
+    ar << data::CreateNVP(model, "model");
+  }
+
+  HMMModel model2;
+  {
+    std::ifstream ifs("test-sparse-hmm-model-save.xml");
+    boost::archive::xml_iarchive ar(ifs);
+    ar >> data::CreateNVP(model2, "model");
+  }
+
+  remove("test-sparse-hmm-model-save.xml");
+
+  BOOST_REQUIRE_EQUAL((int) model2.Type(), (int) HMMType::SparseGaussianHMM);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
 
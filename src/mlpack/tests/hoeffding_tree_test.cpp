@@ -16,6 +16,8 @@
 #include <mlpack/methods/hoeffding_trees/hoeffding_categorical_split.hpp>
 #include <mlpack/methods/hoeffding_trees/binary_numeric_split.hpp>
 #include <mlpack/methods/hoeffding_trees/hoeffding_tree_model.hpp>
+#include <mlpack/methods/hoeffding_trees/hoeffding_tree_ensemble.hpp>
+#include <mlpack/methods/decision_tree/flat_tree.hpp>
 
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
@@ -1388,4 +1390,561 @@ BOOST_AUTO_TEST_CASE(HoeffdingTreeModelSerializationTest)
   }
 }
 
+
+/**
+ * Make sure that the FlatTree classifies the given points exactly as the
+ * Hoeffding tree it was built from.
+ */
+template<typename TreeType, typename MatType>
+void CheckFlatHoeffdingTree(const TreeType& tree, const MatType& data)
+{
+  FlatTree<> flatTree(tree);
+  BOOST_REQUIRE_GT(flatTree.NumNodes(), 1);
+
+  const arma::mat points = arma::conv_to<arma::mat>::from(data);
+  arma::Row<size_t> predictions, flatPredictions;
+  arma::rowvec probabilities;
+  arma::mat flatProbabilities;
+  tree.Classify(data, predictions, probabilities);
+  flatTree.Classify(points, flatPredictions, flatProbabilities);
+
+  BOOST_REQUIRE_EQUAL(flatProbabilities.n_rows, 1);
+  for (size_t i = 0; i < data.n_cols; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(predictions[i], flatPredictions[i]);
+    BOOST_REQUIRE_EQUAL(predictions[i], flatTree.Classify(points.col(i)));
+    BOOST_REQUIRE_EQUAL(probabilities[i], flatProbabilities(0, i));
+  }
+}
+
+/**
+ * Make sure that FlatTree works with Hoeffding trees with binary and multiple
+ * numeric splits, and with categorical splits.
+ */
+BOOST_AUTO_TEST_CASE(FlatHoeffdingTreeTest)
+{
+  arma::mat dataset(3, 9000);
+  arma::Row<size_t> labels(9000);
+  data::DatasetInfo info(3); // All features are numeric.
+  for (size_t i = 0; i < 9000; i += 3)
+  {
+    dataset(0, i) = mlpack::math::Random();
+    dataset(1, i) = mlpack::math::Random();
+    dataset(2, i) = mlpack::math::Random();
+    labels[i] = 0;
+
+    dataset(0, i + 1) = mlpack::math::Random();
+    dataset(1, i + 1) = mlpack::math::Random() - 1.0;
+    dataset(2, i + 1) = mlpack::math::Random() + 0.5;
+    labels[i + 1] = 2;
+
+    dataset(0, i + 2) = mlpack::math::Random();
+    dataset(1, i + 2) = mlpack::math::Random() + 1.0;
+    dataset(2, i + 2) = mlpack::math::Random() + 0.8;
+    labels[i + 2] = 1;
+  }
+
+  HoeffdingTree<GiniImpurity, HoeffdingDoubleNumericSplit> numericTree(
+      dataset, info, labels, 3, false);
+  HoeffdingTree<GiniImpurity, BinaryDoubleNumericSplit> binaryTree(dataset,
+      info, labels, 3, false);
+  CheckFlatHoeffdingTree(numericTree, dataset);
+  CheckFlatHoeffdingTree(binaryTree, dataset);
+
+  DatasetInfo categoricalInfo(2);
+  for (size_t i = 0; i < 4; ++i)
+  {
+    std::ostringstream category;
+    category << "cat" << i;
+    categoricalInfo.MapString<size_t>(category.str(), 0);
+  }
+  arma::Mat<size_t> categoricalDataset(2, 6000);
+  arma::Row<size_t> categoricalLabels(6000);
+  for (size_t i = 0; i < 6000; ++i)
+  {
+    categoricalDataset(0, i) = mlpack::math::RandInt(4);
+    categoricalDataset(1, i) = mlpack::math::RandInt(10);
+    categoricalLabels[i] = (categoricalDataset(0, i) < 2) ? 0 : 1;
+  }
+
+  HoeffdingTree<GiniImpurity, HoeffdingSizeTNumericSplit,
+      HoeffdingCategoricalSplit> categoricalTree(categoricalDataset,
+      categoricalInfo, categoricalLabels, 2, false);
+  CheckFlatHoeffdingTree(categoricalTree, categoricalDataset);
+}
+
+
+/**
+ * Make sure that merging categorical splits trained on two halves of the data
+ * gives the same split as training on all of the data.
+ */
+BOOST_AUTO_TEST_CASE(HoeffdingCategoricalSplitMergeTest)
+{
+  HoeffdingCategoricalSplit<GiniImpurity> split(5, 3), first(5, 3),
+      second(5, 3);
+  for (size_t i = 0; i < 1000; ++i)
+  {
+    const size_t category = mlpack::math::RandInt(0, 5);
+    const size_t label = (category + mlpack::math::RandInt(0, 2)) % 3;
+    split.Train(category, label);
+    if (i < 400)
+      first.Train(category, label);
+    else
+      second.Train(category, label);
+  }
+  first.Merge(second);
+
+  double bestGain, secondBestGain, mergedBestGain, mergedSecondBestGain;
+  split.EvaluateFitnessFunction(bestGain, secondBestGain);
+  first.EvaluateFitnessFunction(mergedBestGain, mergedSecondBestGain);
+  BOOST_REQUIRE_EQUAL(bestGain, mergedBestGain);
+  BOOST_REQUIRE_EQUAL(secondBestGain, mergedSecondBestGain);
+  BOOST_REQUIRE_EQUAL(split.MajorityClass(), first.MajorityClass());
+  BOOST_REQUIRE_EQUAL(split.MajorityProbability(), first.MajorityProbability());
+}
+
+/**
+ * Make sure that merging binary numeric splits trained on two halves of the
+ * data gives the same split as training on all of the data.
+ */
+BOOST_AUTO_TEST_CASE(BinaryNumericSplitMergeTest)
+{
+  BinaryNumericSplit<GiniImpurity> split(2), first(2), second(2);
+  for (size_t i = 0; i < 1000; ++i)
+  {
+    // Use few distinct values, so that there are many ties.
+    const double value = mlpack::math::RandInt(0, 20);
+    const size_t label = (value + mlpack::math::Random() * 4.0 > 12.0) ? 1 : 0;
+    split.Train(value, label);
+    if (i < 600)
+      first.Train(value, label);
+    else
+      second.Train(value, label);
+  }
+  first.Merge(second);
+
+  double bestGain, secondBestGain, mergedBestGain, mergedSecondBestGain;
+  split.EvaluateFitnessFunction(bestGain, secondBestGain);
+  first.EvaluateFitnessFunction(mergedBestGain, mergedSecondBestGain);
+  BOOST_REQUIRE_EQUAL(bestGain, mergedBestGain);
+  BOOST_REQUIRE_EQUAL(secondBestGain, mergedSecondBestGain);
+  BOOST_REQUIRE_EQUAL(split.MajorityClass(), first.MajorityClass());
+
+  arma::Col<size_t> childMajorities, mergedChildMajorities;
+  BinaryNumericSplitInfo<> splitInfo, mergedSplitInfo;
+  split.Split(childMajorities, splitInfo);
+  first.Split(mergedChildMajorities, mergedSplitInfo);
+  BOOST_REQUIRE_EQUAL(childMajorities[0], mergedChildMajorities[0]);
+  BOOST_REQUIRE_EQUAL(childMajorities[1], mergedChildMajorities[1]);
+  for (size_t i = 0; i < 20; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(splitInfo.CalculateDirection(double(i)),
+        mergedSplitInfo.CalculateDirection(double(i)));
+  }
+}
+
+/**
+ * Make sure that merging numeric splits is exact when one of them has not
+ * binned its points yet, and that it keeps the counts otherwise.
+ */
+BOOST_AUTO_TEST_CASE(HoeffdingNumericSplitMergeTest)
+{
+  arma::vec values(1000, arma::fill::randu);
+  arma::Row<size_t> labels(1000);
+  for (size_t i = 0; i < 1000; ++i)
+    labels[i] = (values[i] > 0.4) ? 1 : 0;
+
+  // The second split has too few points to have binned them, so its points
+  // are replayed.
+  HoeffdingNumericSplit<GiniImpurity> split(2), first(2), second(2);
+  for (size_t i = 0; i < 1000; ++i)
+  {
+    split.Train(values[i], labels[i]);
+    if (i < 950)
+      first.Train(values[i], labels[i]);
+    else
+      second.Train(values[i], labels[i]);
+  }
+  first.Merge(second);
+
+  double bestGain, secondBestGain, mergedBestGain, mergedSecondBestGain;
+  split.EvaluateFitnessFunction(bestGain, secondBestGain);
+  first.EvaluateFitnessFunction(mergedBestGain, mergedSecondBestGain);
+  BOOST_REQUIRE_EQUAL(bestGain, mergedBestGain);
+  BOOST_REQUIRE_EQUAL(split.MajorityProbability(), first.MajorityProbability());
+
+  // An empty split takes the bins of the other split.
+  HoeffdingNumericSplit<GiniImpurity> empty(2);
+  empty.Merge(split);
+  empty.EvaluateFitnessFunction(mergedBestGain, mergedSecondBestGain);
+  BOOST_REQUIRE_EQUAL(bestGain, mergedBestGain);
+
+  // Two binned splits with different bins keep all the counts.
+  HoeffdingNumericSplit<GiniImpurity> low(2), high(2);
+  for (size_t i = 0; i < 1000; ++i)
+  {
+    low.Train(values[i] / 2.0, labels[i]);
+    high.Train(values[i] / 2.0 + 0.25, labels[i]);
+  }
+  low.Merge(high);
+  BOOST_REQUIRE_EQUAL(low.MajorityClass(), split.MajorityClass());
+  BOOST_REQUIRE_CLOSE(low.MajorityProbability(), split.MajorityProbability(),
+      1e-5);
+}
+
+/**
+ * Make sure that batch training of a large Hoeffding tree, which trains on
+ * shards in parallel, gives an accurate tree that doesn't depend on the number
+ * of threads.
+ */
+BOOST_AUTO_TEST_CASE(HoeffdingTreeShardedBatchTest)
+{
+  arma::mat dataset(3, 40000);
+  arma::Row<size_t> labels(40000);
+  data::DatasetInfo info(3); // All features are numeric.
+  for (size_t i = 0; i < 40000; ++i)
+  {
+    dataset(0, i) = mlpack::math::Random();
+    dataset(1, i) = mlpack::math::Random();
+    dataset(2, i) = mlpack::math::Random();
+    labels[i] = (dataset(1, i) > 0.5) ? ((dataset(2, i) > 0.3) ? 2 : 1) : 0;
+  }
+
+  typedef HoeffdingTree<GiniImpurity, BinaryDoubleNumericSplit> TreeType;
+
+#ifdef HAS_OPENMP
+  const size_t prevNumThreads = omp_get_max_threads();
+  omp_set_num_threads(std::max(prevNumThreads, (size_t) 4));
+#endif
+
+  TreeType tree(dataset, info, labels, 3, true);
+  HoeffdingTree<> binnedTree(dataset, info, labels, 3, true);
+
+#ifdef HAS_OPENMP
+  omp_set_num_threads(1);
+#endif
+
+  TreeType otherTree(dataset, info, labels, 3, true);
+  HoeffdingTree<> otherBinnedTree(dataset, info, labels, 3, true);
+
+#ifdef HAS_OPENMP
+  omp_set_num_threads(prevNumThreads);
+#endif
+
+  BOOST_REQUIRE_GT(tree.NumChildren(), 0);
+  BOOST_REQUIRE_GT(binnedTree.NumChildren(), 0);
+
+  arma::Row<size_t> predictions, otherPredictions, binnedPredictions,
+      otherBinnedPredictions;
+  tree.Classify(dataset, predictions);
+  otherTree.Classify(dataset, otherPredictions);
+  binnedTree.Classify(dataset, binnedPredictions);
+  otherBinnedTree.Classify(dataset, otherBinnedPredictions);
+
+  size_t correct = 0, binnedCorrect = 0;
+  for (size_t i = 0; i < 40000; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(predictions[i], otherPredictions[i]);
+    BOOST_REQUIRE_EQUAL(binnedPredictions[i], otherBinnedPredictions[i]);
+    if (predictions[i] == labels[i])
+      ++correct;
+    if (binnedPredictions[i] == labels[i])
+      ++binnedCorrect;
+  }
+
+  BOOST_REQUIRE_GT(correct, 38000);
+  BOOST_REQUIRE_GT(binnedCorrect, 34000);
+}
+
+/**
+ * Make sure that training on the blocks of a ChunkedReader gives the same tree
+ * as training on each point of the dataset in turn.
+ */
+BOOST_AUTO_TEST_CASE(HoeffdingTreeChunkedReaderTest)
+{
+  // The labels are stored as the last dimension.
+  arma::mat dataset(4, 5000);
+  arma::Row<size_t> labels(5000);
+  data::DatasetInfo info(3); // All features are numeric.
+  for (size_t i = 0; i < 5000; ++i)
+  {
+    dataset(0, i) = mlpack::math::Random();
+    dataset(1, i) = mlpack::math::Random();
+    dataset(2, i) = mlpack::math::Random();
+    labels[i] = (dataset(1, i) > 0.5) ? ((dataset(2, i) > 0.3) ? 2 : 1) : 0;
+    dataset(3, i) = labels[i];
+  }
+  data::Save("test.bin", dataset);
+
+  const arma::mat points = dataset.rows(0, 2);
+  HoeffdingTree<> streamTree(info, 3);
+  for (size_t i = 0; i < 5000; ++i)
+    streamTree.Train(points.col(i), labels[i]);
+
+  HoeffdingTree<> readerTree(info, 3);
+  data::ChunkedReader reader("test.bin", 300);
+  readerTree.Train(reader);
+
+  BOOST_REQUIRE_GT(streamTree.NumChildren(), 0);
+  BOOST_REQUIRE_EQUAL(readerTree.NumChildren(), streamTree.NumChildren());
+
+  arma::Row<size_t> streamPredictions, readerPredictions;
+  streamTree.Classify(points, streamPredictions);
+  readerTree.Classify(points, readerPredictions);
+  for (size_t i = 0; i < 5000; ++i)
+    BOOST_REQUIRE_EQUAL(readerPredictions[i], streamPredictions[i]);
+
+  // A reader without a row of labels is rejected.
+  data::Save("test.bin", points);
+  data::ChunkedReader badReader("test.bin", 300);
+  BOOST_REQUIRE_THROW(readerTree.Train(badReader), std::invalid_argument);
+
+  remove("test.bin");
+}
+
+/**
+ * Count the leaves of the given Hoeffding tree, and how many of them are
+ * active.
+ */
+template<typename TreeType>
+void CountActiveLeaves(const TreeType& tree,
+                       size_t& numLeaves,
+                       size_t& numActiveLeaves)
+{
+  numLeaves = 0;
+  numActiveLeaves = 0;
+  std::stack<const TreeType*> stack;
+  stack.push(&tree);
+  while (!stack.empty())
+  {
+    const TreeType* node = stack.top();
+    stack.pop();
+
+    if (node->NumChildren() == 0)
+    {
+      ++numLeaves;
+      if (node->Active())
+        ++numActiveLeaves;
+    }
+    else
+    {
+      BOOST_REQUIRE(node->Active());
+    }
+
+    for (size_t i = 0; i < node->NumChildren(); ++i)
+      stack.push(&node->Child(i));
+  }
+}
+
+/**
+ * Make sure that a streaming Hoeffding tree with a memory budget never keeps
+ * more active leaves than allowed at a memory check, still learns a tree with
+ * many leaves, and can be serialized.
+ */
+BOOST_AUTO_TEST_CASE(HoeffdingTreeMaxActiveLeavesTest)
+{
+  // The class only depends on the first dimension, so the tree needs at least
+  // six leaves.
+  arma::mat dataset(2, 30000);
+  arma::Row<size_t> labels(30000);
+  data::DatasetInfo info(2); // All features are numeric.
+  for (size_t i = 0; i < 30000; ++i)
+  {
+    dataset(0, i) = mlpack::math::Random();
+    dataset(1, i) = mlpack::math::Random();
+    labels[i] = std::min((size_t) (dataset(0, i) * 6.0), (size_t) 5);
+  }
+
+  typedef HoeffdingTree<GiniImpurity, BinaryDoubleNumericSplit> TreeType;
+  TreeType tree(info, 6, 0.95, 0, 100, 100);
+  tree.MaxActiveLeaves(3);
+  BOOST_REQUIRE_EQUAL(tree.MaxActiveLeaves(), 3);
+
+  // Each chunk is a multiple of the check interval, so the memory budget was
+  // just enforced when it ends.
+  size_t numLeaves, numActiveLeaves;
+  for (size_t c = 0; c < 30; ++c)
+  {
+    tree.Train(dataset.cols(1000 * c, 1000 * c + 999),
+        labels.subvec(1000 * c, 1000 * c + 999), false);
+
+    CountActiveLeaves(tree, numLeaves, numActiveLeaves);
+    BOOST_REQUIRE_LE(numActiveLeaves, 3);
+    BOOST_REQUIRE_EQUAL(numActiveLeaves, std::min(numLeaves, (size_t) 3));
+  }
+
+  // The pure leaves are the least promising, so the budget doesn't stop the
+  // tree from learning every class.
+  BOOST_REQUIRE_GE(numLeaves, 6);
+
+  arma::Row<size_t> predictions;
+  tree.Classify(dataset, predictions);
+  size_t correct = 0;
+  for (size_t i = 0; i < 30000; ++i)
+    if (predictions[i] == labels[i])
+      ++correct;
+  BOOST_REQUIRE_GT(correct, 27000);
+
+  // Inactive leaves are loaded as active leaves that haven't seen any samples.
+  std::ostringstream oss;
+  {
+    boost::archive::binary_oarchive boa(oss);
+    boa << data::CreateNVP(tree, "tree");
+  }
+
+  TreeType loadedTree(info, 6);
+  std::istringstream iss(oss.str());
+  {
+    boost::archive::binary_iarchive bia(iss);
+    bia >> data::CreateNVP(loadedTree, "tree");
+  }
+
+  size_t numLoadedLeaves, numLoadedActiveLeaves;
+  CountActiveLeaves(loadedTree, numLoadedLeaves, numLoadedActiveLeaves);
+  BOOST_REQUIRE_EQUAL(numLoadedLeaves, numLeaves);
+  BOOST_REQUIRE_EQUAL(numLoadedActiveLeaves, numLeaves);
+
+  arma::Row<size_t> loadedPredictions;
+  loadedTree.Classify(dataset, loadedPredictions);
+  for (size_t i = 0; i < 30000; ++i)
+    BOOST_REQUIRE_EQUAL(predictions[i], loadedPredictions[i]);
+
+  // Removing the budget reactivates every leaf, and training can go on.
+  tree.MaxActiveLeaves(0);
+  CountActiveLeaves(tree, numLeaves, numActiveLeaves);
+  BOOST_REQUIRE_EQUAL(numActiveLeaves, numLeaves);
+  tree.Train(dataset, labels, false);
+}
+
+/**
+ * Make sure that a HoeffdingTreeModel built with a memory budget enforces it,
+ * in both batch and streaming mode.
+ */
+BOOST_AUTO_TEST_CASE(HoeffdingTreeModelMaxActiveLeavesTest)
+{
+  arma::mat dataset(2, 6000);
+  arma::Row<size_t> labels(6000);
+  data::DatasetInfo info(2); // All features are numeric.
+  for (size_t i = 0; i < 6000; ++i)
+  {
+    dataset(0, i) = mlpack::math::Random();
+    dataset(1, i) = mlpack::math::Random();
+    labels[i] = std::min((size_t) (dataset(0, i) * 4.0), (size_t) 3);
+  }
+
+  for (size_t batch = 0; batch < 2; ++batch)
+  {
+    HoeffdingTreeModel m(HoeffdingTreeModel::GINI_BINARY);
+    m.BuildModel(dataset, info, labels, 4, (batch == 1), 0.95, 0, 100, 100, 10,
+        100, 2);
+
+    arma::Row<size_t> predictions;
+    m.Classify(dataset, predictions);
+    BOOST_REQUIRE_EQUAL(predictions.n_elem, 6000);
+    BOOST_REQUIRE_GT(m.NumNodes(), 1);
+
+    // Training again keeps the budget.
+    m.Train(dataset, labels, false);
+    m.MaxActiveLeaves(0);
+  }
+}
+
+/**
+ * Make sure that an online bagging ensemble of Hoeffding trees classifies an
+ * easy dataset well, doesn't depend on how the stream is split into batches,
+ * and survives serialization.
+ */
+BOOST_AUTO_TEST_CASE(HoeffdingTreeEnsembleTest)
+{
+  arma::mat dataset(2, 6000);
+  arma::Row<size_t> labels(6000);
+  data::DatasetInfo info(2); // All features are numeric.
+  for (size_t i = 0; i < 6000; ++i)
+  {
+    dataset(0, i) = mlpack::math::Random();
+    dataset(1, i) = mlpack::math::Random();
+    labels[i] = std::min((size_t) (dataset(0, i) * 4.0), (size_t) 3);
+  }
+
+  // Train the same ensemble on the whole stream, and on the stream split into
+  // single points and two batches.
+  typedef HoeffdingTreeModel::GiniBinaryTreeType TreeType;
+  const TreeType tree(info, 4);
+  HoeffdingTreeEnsemble<TreeType> ensemble(tree, 5, 42);
+  HoeffdingTreeEnsemble<TreeType> splitEnsemble(tree, 5, 42);
+  ensemble.Train(dataset, labels);
+
+  for (size_t i = 0; i < 1000; ++i)
+    splitEnsemble.Train(dataset.col(i), labels[i]);
+  const arma::mat firstBatch = dataset.cols(1000, 2999);
+  const arma::Row<size_t> firstLabels = labels.subvec(1000, 2999);
+  const arma::mat secondBatch = dataset.cols(3000, 5999);
+  const arma::Row<size_t> secondLabels = labels.subvec(3000, 5999);
+  splitEnsemble.Train(firstBatch, firstLabels);
+  splitEnsemble.Train(secondBatch, secondLabels);
+
+  BOOST_REQUIRE_EQUAL(ensemble.SamplesSeen(), 6000);
+  BOOST_REQUIRE_EQUAL(splitEnsemble.SamplesSeen(), 6000);
+
+  arma::Row<size_t> predictions, splitPredictions;
+  arma::rowvec probabilities, splitProbabilities;
+  ensemble.Classify(dataset, predictions, probabilities);
+  splitEnsemble.Classify(dataset, splitPredictions, splitProbabilities);
+
+  size_t correct = 0;
+  for (size_t i = 0; i < 6000; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(predictions[i], splitPredictions[i]);
+    BOOST_REQUIRE_EQUAL(probabilities[i], splitProbabilities[i]);
+    BOOST_REQUIRE_GE(probabilities[i], 0.2);
+    BOOST_REQUIRE_LE(probabilities[i], 1.0);
+
+    // The vote of a single point gives the same result.
+    size_t prediction;
+    double probability;
+    ensemble.Classify(dataset.col(i), prediction, probability);
+    BOOST_REQUIRE_EQUAL(prediction, predictions[i]);
+    BOOST_REQUIRE_EQUAL(probability, probabilities[i]);
+
+    if (predictions[i] == labels[i])
+      ++correct;
+  }
+  BOOST_REQUIRE_GT(correct, 5100);
+
+  // The model can hold an ensemble of each type of tree.
+  for (size_t i = 0; i < 4; ++i)
+  {
+    HoeffdingTreeModel m((HoeffdingTreeModel::TreeType) i);
+    HoeffdingTreeModel xmlM, textM, binaryM;
+    m.BuildModel(dataset, info, labels, 4, true, 0.95, 5000, 100, 100, 10,
+        100, 0, 3);
+    BOOST_REQUIRE_EQUAL(m.NumTrees(), 3);
+    BOOST_REQUIRE_GT(m.NumNodes(), 3);
+
+    SerializeObjectAll(m, xmlM, textM, binaryM);
+    BOOST_REQUIRE_EQUAL(xmlM.NumTrees(), 3);
+    BOOST_REQUIRE_EQUAL(textM.NumTrees(), 3);
+    BOOST_REQUIRE_EQUAL(binaryM.NumTrees(), 3);
+
+    arma::Row<size_t> modelPredictions, predictionsXml, predictionsText,
+        predictionsBinary;
+    m.Classify(dataset, modelPredictions);
+    xmlM.Classify(dataset, predictionsXml);
+    textM.Classify(dataset, predictionsText);
+    binaryM.Classify(dataset, predictionsBinary);
+
+    for (size_t j = 0; j < 6000; ++j)
+    {
+      BOOST_REQUIRE_EQUAL(modelPredictions[j], predictionsXml[j]);
+      BOOST_REQUIRE_EQUAL(modelPredictions[j], predictionsText[j]);
+      BOOST_REQUIRE_EQUAL(modelPredictions[j], predictionsBinary[j]);
+    }
+
+    // A copy holds the ensemble too.
+    HoeffdingTreeModel copy(m);
+    BOOST_REQUIRE_EQUAL(copy.NumTrees(), 3);
+    BOOST_REQUIRE_EQUAL(copy.NumNodes(), m.NumNodes());
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -266,4 +266,75 @@ BOOST_AUTO_TEST_CASE(ListwiseDeletionTest)
   BOOST_REQUIRE_CLOSE(rowWiseInput(1, 3), 8.0, 1e-5);
 }
 
+/**
+ * Make sure imputing several dimensions at once gives the same result as
+ * imputing them one at a time, for each strategy.
+ */
+template<typename StrategyType>
+void CheckMultipleDimensions(StrategyType strategy)
+{
+  // Put missing values in a few dimensions of a random dataset.
+  arma::mat dataset = arma::randu<arma::mat>(10, 1001);
+  for (size_t i = 0; i < dataset.n_elem; i += 7)
+    if ((i % dataset.n_rows) % 3 == 0)
+      dataset[i] = (i % 2 == 0) ? 0.0 : arma::datum::nan;
+
+  const std::vector<size_t> dimensions = { 0, 3, 6, 9 };
+  const std::vector<double> mappedValues(dimensions.size(), 0.0);
+  for (size_t c = 0; c < 2; ++c)
+  {
+    const bool columnMajor = (c == 0);
+    arma::mat input = columnMajor ? dataset : arma::mat(dataset.t());
+    arma::mat expected(input);
+
+    StrategyType multiple(strategy);
+    multiple.Impute(input, mappedValues, dimensions, columnMajor);
+    for (size_t k = 0; k < dimensions.size(); ++k)
+      strategy.Impute(expected, 0.0, dimensions[k], columnMajor);
+
+    BOOST_REQUIRE_EQUAL(input.n_rows, expected.n_rows);
+    BOOST_REQUIRE_EQUAL(input.n_cols, expected.n_cols);
+    for (size_t i = 0; i < input.n_elem; ++i)
+      BOOST_REQUIRE_CLOSE(input[i], expected[i], 1e-5);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(MultipleDimensionImputationTest)
+{
+  CheckMultipleDimensions(CustomImputation<double>(99));
+  CheckMultipleDimensions(MeanImputation<double>());
+  CheckMultipleDimensions(MedianImputation<double>());
+  CheckMultipleDimensions(ListwiseDeletion<double>());
+}
+
+/**
+ * Make sure the Imputer imputes all the given dimensions.
+ */
+BOOST_AUTO_TEST_CASE(ImputerMultipleDimensionTest)
+{
+  fstream f;
+  f.open("test_file.csv", fstream::out);
+  f << "a, 2, 3"  << endl;
+  f << "5, 6, a"  << endl;
+  f << "8, a, 10" << endl;
+  f.close();
+
+  arma::mat input;
+  MissingPolicy policy({"a"});
+  DatasetMapper<MissingPolicy> info(policy);
+  BOOST_REQUIRE(data::Load("test_file.csv", input, info) == true);
+
+  Imputer<double,
+          DatasetMapper<MissingPolicy>,
+          MeanImputation<double>> imputer(info);
+  imputer.Impute(input, "a", std::vector<size_t>({ 0, 1, 2 }));
+
+  BOOST_REQUIRE_CLOSE(input(0, 0), 6.5, 1e-5);
+  BOOST_REQUIRE_CLOSE(input(1, 2), 4.0, 1e-5);
+  BOOST_REQUIRE_CLOSE(input(2, 1), 6.5, 1e-5);
+  BOOST_REQUIRE_CLOSE(input(2, 2), 10.0, 1e-5);
+
+  remove("test_file.csv");
+}
+
 BOOST_AUTO_TEST_SUITE_END();
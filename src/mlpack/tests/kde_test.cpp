@@ -0,0 +1,209 @@
+/**
+ * @file kde_test.cpp
+ *
+ * Tests for the KDE class and the KDEModel class.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include <mlpack/core.hpp>
+#include <mlpack/core/kernels/epanechnikov_kernel.hpp>
+#include <mlpack/methods/kde/kde.hpp>
+#include <mlpack/methods/kde/kde_model.hpp>
+#include <boost/test/unit_test.hpp>
+#include "test_tools.hpp"
+#include "serialization.hpp"
+
+using namespace mlpack;
+using namespace mlpack::kde;
+using namespace mlpack::kernel;
+using namespace mlpack::metric;
+using namespace mlpack::tree;
+
+BOOST_AUTO_TEST_SUITE(KDETest);
+
+/**
+ * Compute the density estimations by brute force.
+ */
+template<typename KernelType>
+arma::vec ExactEstimations(const arma::mat& referenceSet,
+                           const arma::mat& querySet,
+                           KernelType kernel)
+{
+  arma::vec estimations(querySet.n_cols);
+  for (size_t i = 0; i < querySet.n_cols; ++i)
+  {
+    double sum = 0.0;
+    for (size_t j = 0; j < referenceSet.n_cols; ++j)
+    {
+      sum += kernel.Evaluate(EuclideanDistance::Evaluate(querySet.col(i),
+          referenceSet.col(j)));
+    }
+    estimations[i] = sum / (referenceSet.n_cols *
+        kernel.Normalizer(referenceSet.n_rows));
+  }
+
+  return estimations;
+}
+
+/**
+ * Make sure that exact and approximate estimations are within the error bounds
+ * in every mode, with and without a query set.
+ */
+template<typename KernelType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void KDEBoundsTest(const KernelType& kernel)
+{
+  arma::mat referenceData = arma::randu<arma::mat>(3, 600);
+  arma::mat queryData = arma::randu<arma::mat>(3, 200);
+
+  const arma::vec exact = ExactEstimations(referenceData, queryData, kernel);
+  const arma::vec exactMono = ExactEstimations(referenceData, referenceData,
+      kernel);
+
+  for (size_t mode = 0; mode < 3; ++mode)
+  {
+    KDE<KernelType, EuclideanDistance, arma::mat, TreeType> kde(referenceData,
+        0.0, 0.0, kernel, mode == 0, mode == 1);
+
+    arma::vec estimations, estimationsMono;
+    kde.Evaluate(queryData, estimations);
+    kde.Evaluate(estimationsMono);
+
+    BOOST_REQUIRE_EQUAL(estimations.n_elem, queryData.n_cols);
+    BOOST_REQUIRE_EQUAL(estimationsMono.n_elem, referenceData.n_cols);
+    for (size_t i = 0; i < exact.n_elem; ++i)
+      BOOST_REQUIRE_CLOSE(estimations[i], exact[i], 1e-5);
+    for (size_t i = 0; i < exactMono.n_elem; ++i)
+      BOOST_REQUIRE_CLOSE(estimationsMono[i], exactMono[i], 1e-5);
+
+    // Now with a relative error of 5%.
+    kde.RelativeError(0.05);
+    kde.Evaluate(queryData, estimations);
+    kde.Evaluate(estimationsMono);
+
+    for (size_t i = 0; i < exact.n_elem; ++i)
+      BOOST_REQUIRE_LE(std::abs(estimations[i] - exact[i]),
+          0.05 * exact[i] + 1e-10);
+    for (size_t i = 0; i < exactMono.n_elem; ++i)
+      BOOST_REQUIRE_LE(std::abs(estimationsMono[i] - exactMono[i]),
+          0.05 * exactMono[i] + 1e-10);
+
+    // And with only an absolute error.
+    const double absoluteError = 0.01 * arma::mean(exact);
+    kde.RelativeError(0.0);
+    kde.AbsoluteError(absoluteError);
+    kde.Evaluate(queryData, estimations);
+    kde.Evaluate(estimationsMono);
+
+    for (size_t i = 0; i < exact.n_elem; ++i)
+      BOOST_REQUIRE_LE(std::abs(estimations[i] - exact[i]),
+          absoluteError + 1e-10);
+    for (size_t i = 0; i < exactMono.n_elem; ++i)
+      BOOST_REQUIRE_LE(std::abs(estimationsMono[i] - exactMono[i]),
+          absoluteError + 1e-10);
+  }
+}
+
+/**
+ * Make sure the estimations are within the error bounds with kd-trees.
+ */
+BOOST_AUTO_TEST_CASE(KDEKDTreeTest)
+{
+  KDEBoundsTest<GaussianKernel, KDTree>(GaussianKernel(0.2));
+  KDEBoundsTest<EpanechnikovKernel, KDTree>(EpanechnikovKernel(0.3));
+}
+
+/**
+ * Make sure the estimations are within the error bounds with ball trees.
+ */
+BOOST_AUTO_TEST_CASE(KDEBallTreeTest)
+{
+  KDEBoundsTest<GaussianKernel, BallTree>(GaussianKernel(0.2));
+}
+
+/**
+ * Make sure the estimations are within the error bounds with cover trees,
+ * which compute base cases in Score().
+ */
+BOOST_AUTO_TEST_CASE(KDECoverTreeTest)
+{
+  KDEBoundsTest<GaussianKernel, StandardCoverTree>(GaussianKernel(0.2));
+}
+
+/**
+ * Make sure the estimations are within the error bounds with octrees.
+ */
+BOOST_AUTO_TEST_CASE(KDEOctreeTest)
+{
+  KDEBoundsTest<GaussianKernel, Octree>(GaussianKernel(0.2));
+}
+
+/**
+ * Make sure that invalid errors are rejected.
+ */
+BOOST_AUTO_TEST_CASE(KDEInvalidErrorTest)
+{
+  BOOST_REQUIRE_THROW(KDE<> kde(-0.1), std::invalid_argument);
+  BOOST_REQUIRE_THROW(KDE<> kde(1.5), std::invalid_argument);
+  BOOST_REQUIRE_THROW(KDE<> kde(0.05, -1.0), std::invalid_argument);
+
+  KDE<> kde;
+  BOOST_REQUIRE_THROW(kde.RelativeError(2.0), std::invalid_argument);
+  BOOST_REQUIRE_THROW(kde.AbsoluteError(-0.5), std::invalid_argument);
+
+  // Query points must have the dimensionality of the reference points.
+  kde.Train(arma::randu<arma::mat>(3, 100));
+  arma::vec estimations;
+  BOOST_REQUIRE_THROW(kde.Evaluate(arma::randu<arma::mat>(4, 10), estimations),
+      std::invalid_argument);
+}
+
+/**
+ * Make sure that a serialized KDEModel gives the same estimations, with every
+ * kernel and tree type.
+ */
+BOOST_AUTO_TEST_CASE(KDEModelSerializationTest)
+{
+  arma::mat referenceData = arma::randu<arma::mat>(3, 300);
+  arma::mat queryData = arma::randu<arma::mat>(3, 100);
+
+  for (size_t kernelType = 0; kernelType < 2; ++kernelType)
+  {
+    for (size_t treeType = 0; treeType < 4; ++treeType)
+    {
+      KDEModel model((KDEModel::KernelTypes) kernelType,
+          (KDEModel::TreeTypes) treeType, 0.3, 0.05, 0.0);
+      model.BuildModel(arma::mat(referenceData));
+
+      KDEModel xmlModel, textModel, binaryModel;
+      SerializeObjectAll(model, xmlModel, textModel, binaryModel);
+
+      BOOST_REQUIRE_EQUAL(xmlModel.KernelType(), model.KernelType());
+      BOOST_REQUIRE_EQUAL(xmlModel.TreeType(), model.TreeType());
+      BOOST_REQUIRE_EQUAL(binaryModel.Bandwidth(), 0.3);
+
+      arma::vec estimations, xmlEstimations, textEstimations,
+          binaryEstimations;
+      model.Evaluate(queryData, estimations);
+      xmlModel.Evaluate(queryData, xmlEstimations);
+      textModel.Evaluate(queryData, textEstimations);
+      binaryModel.Evaluate(queryData, binaryEstimations);
+
+      CheckMatrices(estimations, xmlEstimations, textEstimations,
+          binaryEstimations);
+
+      // A copy of the model gives the same estimations too.
+      KDEModel copy(model);
+      arma::vec copyEstimations;
+      copy.Evaluate(queryData, copyEstimations);
+      CheckMatrices(estimations, copyEstimations);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END();
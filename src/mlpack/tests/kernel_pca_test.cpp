@@ -12,6 +12,7 @@
 #include <mlpack/core.hpp>
 #include <mlpack/core/kernels/gaussian_kernel.hpp>
 #include <mlpack/methods/kernel_pca/kernel_rules/nystroem_method.hpp>
+#include <mlpack/methods/kernel_pca/kernel_rules/randomized_method.hpp>
 #include <mlpack/methods/kernel_pca/kernel_pca.hpp>
 
 #include <boost/test/unit_test.hpp>
@@ -150,4 +151,74 @@ BOOST_AUTO_TEST_CASE(CircleTransformationTestNystroem)
   BOOST_REQUIRE_EQUAL(ranges[1].Contains(ranges[2]), false);
 }
 
+/**
+ * The tiled kernel matrix of the naive method should give the eigenvalues of
+ * the centered kernel matrix computed one evaluation at a time.
+ */
+BOOST_AUTO_TEST_CASE(NaiveKernelRuleTiledTest)
+{
+  // More points than fit in one tile.
+  arma::mat dataset = arma::randn<arma::mat>(3, 700);
+  GaussianKernel kernel(1.0);
+
+  arma::mat kernelMatrix(dataset.n_cols, dataset.n_cols);
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+    for (size_t j = 0; j < dataset.n_cols; ++j)
+      kernelMatrix(i, j) = kernel.Evaluate(dataset.col(i), dataset.col(j));
+
+  arma::mat centering = arma::eye(dataset.n_cols, dataset.n_cols) -
+      arma::ones(dataset.n_cols, dataset.n_cols) / dataset.n_cols;
+  arma::vec expected = arma::eig_sym(centering * kernelMatrix * centering);
+  expected = arma::flipud(expected);
+
+  arma::mat transformedData, eigvec;
+  arma::vec eigval;
+  NaiveKernelRule<GaussianKernel>::ApplyKernelMatrix(dataset, transformedData,
+      eigval, eigvec, 0, kernel);
+
+  BOOST_REQUIRE_EQUAL(eigval.n_elem, expected.n_elem);
+  for (size_t i = 0; i < 10; ++i)
+    BOOST_REQUIRE_CLOSE(eigval[i], expected[i], 1e-5);
+}
+
+/**
+ * The randomized method should find the leading eigenvalues of the naive
+ * method, and the same projections of the points (up to their sign).
+ */
+BOOST_AUTO_TEST_CASE(RandomizedKernelRuleTest)
+{
+  // Stretch the data so that the leading eigenvalues are well separated.
+  arma::mat dataset = arma::randn<arma::mat>(3, 1100);
+  dataset.row(0) *= 4.0;
+  dataset.row(1) *= 2.0;
+  GaussianKernel kernel(2.0);
+
+  arma::mat naiveData, naiveEigvec;
+  arma::vec naiveEigval;
+  NaiveKernelRule<GaussianKernel>::ApplyKernelMatrix(dataset, naiveData,
+      naiveEigval, naiveEigvec, 0, kernel);
+
+  arma::mat randomizedData, randomizedEigvec;
+  arma::vec randomizedEigval;
+  RandomizedKernelRule<GaussianKernel, 6>::ApplyKernelMatrix(dataset,
+      randomizedData, randomizedEigval, randomizedEigvec, 3, kernel);
+
+  BOOST_REQUIRE_EQUAL(randomizedEigval.n_elem, 3);
+  BOOST_REQUIRE_EQUAL(randomizedEigvec.n_rows, dataset.n_cols);
+  BOOST_REQUIRE_EQUAL(randomizedEigvec.n_cols, 3);
+  BOOST_REQUIRE_EQUAL(randomizedData.n_rows, 3);
+  BOOST_REQUIRE_EQUAL(randomizedData.n_cols, dataset.n_cols);
+
+  for (size_t i = 0; i < 3; ++i)
+  {
+    BOOST_REQUIRE_CLOSE(randomizedEigval[i], naiveEigval[i], 1.0);
+
+    // The projections should be the same, up to the sign.
+    const double correlation = std::abs(arma::dot(randomizedData.row(i),
+        naiveData.row(i))) / (arma::norm(randomizedData.row(i)) *
+        arma::norm(naiveData.row(i)));
+    BOOST_REQUIRE_GT(correlation, 0.95);
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
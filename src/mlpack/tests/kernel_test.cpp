@@ -18,7 +18,9 @@
 #include <mlpack/core/kernels/linear_kernel.hpp>
 #include <mlpack/core/kernels/polynomial_kernel.hpp>
 #include <mlpack/core/kernels/spherical_kernel.hpp>
+#include <mlpack/core/kernels/triangular_kernel.hpp>
 #include <mlpack/core/kernels/pspectrum_string_kernel.hpp>
+#include <mlpack/core/kernels/kernel_matrix.hpp>
 #include <mlpack/core/metrics/lmetric.hpp>
 #include <mlpack/core/metrics/mahalanobis_distance.hpp>
 
@@ -608,4 +610,144 @@ BOOST_AUTO_TEST_CASE(PSpectrumStringEvaluateTest)
   BOOST_REQUIRE_CLOSE(p.Evaluate(b, a), 11.0, 1e-5);
 }
 
+/**
+ * The spectra of the p-spectrum string kernel should give the same evaluations
+ * as the maps of substring counts, for short substrings (stored exactly) and
+ * long substrings (hashed), and KernelMatrix() should agree with Evaluate().
+ */
+BOOST_AUTO_TEST_CASE(PSpectrumStringKernelMatrixTest)
+{
+  std::vector<std::vector<std::string> > dataset(1);
+  dataset[0].push_back("MKTAYIAKQRQISFVKSHFSRQLEERLGLIEVQAPILSRVGDGTQDNLSGAEK");
+  dataset[0].push_back("MKTAYIAKQRQISFVKSHFSRQ");
+  dataset[0].push_back("GLIEVQAPILSRVGDGTQ mellow jello MKTAYIAKQRQ");
+  dataset[0].push_back("aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa");
+  dataset[0].push_back("AAAAAAAAAAAAAA");
+  dataset[0].push_back("short");
+
+  arma::mat points(2, dataset[0].size(), arma::fill::zeros);
+  for (size_t i = 0; i < points.n_cols; ++i)
+    points(1, i) = i;
+
+  const size_t ps[] = { 3, 10 };
+  for (size_t t = 0; t < 2; ++t)
+  {
+    PSpectrumStringKernel kernel(dataset, ps[t]);
+
+    arma::mat output;
+    KernelMatrix(kernel, points, points, output);
+
+    BOOST_REQUIRE_EQUAL(output.n_rows, points.n_cols);
+    BOOST_REQUIRE_EQUAL(output.n_cols, points.n_cols);
+    for (size_t i = 0; i < points.n_cols; ++i)
+    {
+      for (size_t j = 0; j < points.n_cols; ++j)
+      {
+        // Compute the kernel from the maps of substring counts.
+        const std::map<std::string, int>& iMap = kernel.Counts()[0][i];
+        const std::map<std::string, int>& jMap = kernel.Counts()[0][j];
+        double eval = 0.0;
+        std::map<std::string, int>::const_iterator it;
+        for (it = iMap.begin(); it != iMap.end(); ++it)
+          if (jMap.count(it->first))
+            eval += it->second * jMap.at(it->first);
+
+        BOOST_REQUIRE_EQUAL(output(i, j), eval);
+        BOOST_REQUIRE_EQUAL(kernel.Evaluate(points.col(i), points.col(j)),
+            eval);
+      }
+    }
+  }
+}
+
+/**
+ * Check KernelMatrix() against the kernel evaluated on each pair of points.
+ */
+template<typename KernelType>
+void CheckKernelMatrix(KernelType& kernel)
+{
+  arma::mat a = arma::randn<arma::mat>(5, 30);
+  arma::mat b = arma::randn<arma::mat>(5, 40);
+  b.col(0) = a.col(0); // The distance of some points is zero.
+
+  arma::mat output;
+  KernelMatrix(kernel, a, b, output);
+
+  BOOST_REQUIRE_EQUAL(output.n_rows, 30);
+  BOOST_REQUIRE_EQUAL(output.n_cols, 40);
+  for (size_t i = 0; i < a.n_cols; ++i)
+  {
+    for (size_t j = 0; j < b.n_cols; ++j)
+    {
+      const double eval = kernel.Evaluate(a.col(i), b.col(j));
+      if (std::abs(eval) < 1e-8)
+        BOOST_REQUIRE_SMALL(output(i, j), 1e-7);
+      else
+        BOOST_REQUIRE_CLOSE(output(i, j), eval, 1e-5);
+    }
+  }
+}
+
+/**
+ * KernelMatrix() should give the same evaluations as the kernel for inner
+ * product kernels, squared distance kernels, and other kernels.
+ */
+BOOST_AUTO_TEST_CASE(KernelMatrixTest)
+{
+  GaussianKernel gaussian(1.5);
+  CheckKernelMatrix(gaussian);
+
+  EpanechnikovKernel epanechnikov(4.0);
+  CheckKernelMatrix(epanechnikov);
+
+  PolynomialKernel polynomial(3.0, 1.0);
+  CheckKernelMatrix(polynomial);
+
+  LinearKernel linear;
+  CheckKernelMatrix(linear);
+
+  LaplacianKernel laplacian(2.0);
+  CheckKernelMatrix(laplacian);
+
+  SphericalKernel spherical(3.0);
+  CheckKernelMatrix(spherical);
+
+  TriangularKernel triangular(4.0);
+  CheckKernelMatrix(triangular);
+
+  CosineDistance cosine;
+  CheckKernelMatrix(cosine);
+}
+
+/**
+ * KernelVector() should give the same evaluations as the kernel, including
+ * against a point of norm 0 for the cosine distance.
+ */
+BOOST_AUTO_TEST_CASE(KernelVectorTest)
+{
+  arma::vec point = arma::randn<arma::vec>(5);
+  arma::mat b = arma::randn<arma::mat>(5, 20);
+  b.col(3).zeros();
+
+  GaussianKernel gaussian(1.5);
+  CosineDistance cosine;
+
+  arma::rowvec gaussianOutput, cosineOutput;
+  KernelVector(gaussian, point, b, gaussianOutput);
+  KernelVector(cosine, point, b, cosineOutput);
+
+  BOOST_REQUIRE_EQUAL(gaussianOutput.n_elem, 20);
+  BOOST_REQUIRE_EQUAL(cosineOutput.n_elem, 20);
+  for (size_t j = 0; j < b.n_cols; ++j)
+  {
+    BOOST_REQUIRE_CLOSE(gaussianOutput[j], gaussian.Evaluate(point, b.col(j)),
+        1e-5);
+    const double eval = cosine.Evaluate(point, b.col(j));
+    if (std::abs(eval) < 1e-8)
+      BOOST_REQUIRE_SMALL(cosineOutput[j], 1e-7);
+    else
+      BOOST_REQUIRE_CLOSE(cosineOutput[j], eval, 1e-5);
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -61,4 +61,54 @@ BOOST_AUTO_TEST_CASE(IsNormalizedTest)
       false);
 }
 
+/**
+ * Check the IsInnerProductKernel trait, which marks kernels that are a function
+ * of the inner product only.
+ */
+BOOST_AUTO_TEST_CASE(IsInnerProductKernelTest)
+{
+  BOOST_REQUIRE_EQUAL((bool) KernelTraits<int>::IsInnerProductKernel, false);
+
+  BOOST_REQUIRE_EQUAL((bool) KernelTraits<LinearKernel>::IsInnerProductKernel,
+      true);
+  BOOST_REQUIRE_EQUAL(
+      (bool) KernelTraits<PolynomialKernel>::IsInnerProductKernel, true);
+  BOOST_REQUIRE_EQUAL(
+      (bool) KernelTraits<HyperbolicTangentKernel>::IsInnerProductKernel, true);
+
+  BOOST_REQUIRE_EQUAL(
+      (bool) KernelTraits<CosineDistance>::IsInnerProductKernel, false);
+  BOOST_REQUIRE_EQUAL(
+      (bool) KernelTraits<GaussianKernel>::IsInnerProductKernel, false);
+  BOOST_REQUIRE_EQUAL(
+      (bool) KernelTraits<PSpectrumStringKernel>::IsInnerProductKernel, false);
+}
+
+/**
+ * Check the IsDistanceKernel trait, which marks kernels that are a function of
+ * the distance only.
+ */
+BOOST_AUTO_TEST_CASE(IsDistanceKernelTest)
+{
+  BOOST_REQUIRE_EQUAL((bool) KernelTraits<int>::IsDistanceKernel, false);
+
+  BOOST_REQUIRE_EQUAL((bool) KernelTraits<GaussianKernel>::IsDistanceKernel,
+      true);
+  BOOST_REQUIRE_EQUAL(
+      (bool) KernelTraits<EpanechnikovKernel>::IsDistanceKernel, true);
+  BOOST_REQUIRE_EQUAL((bool) KernelTraits<LaplacianKernel>::IsDistanceKernel,
+      true);
+  BOOST_REQUIRE_EQUAL((bool) KernelTraits<SphericalKernel>::IsDistanceKernel,
+      true);
+  BOOST_REQUIRE_EQUAL((bool) KernelTraits<TriangularKernel>::IsDistanceKernel,
+      true);
+
+  BOOST_REQUIRE_EQUAL((bool) KernelTraits<CosineDistance>::IsDistanceKernel,
+      false);
+  BOOST_REQUIRE_EQUAL((bool) KernelTraits<LinearKernel>::IsDistanceKernel,
+      false);
+  BOOST_REQUIRE_EQUAL(
+      (bool) KernelTraits<PSpectrumStringKernel>::IsDistanceKernel, false);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
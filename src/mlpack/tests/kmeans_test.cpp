@@ -14,10 +14,16 @@
 #include <mlpack/methods/kmeans/refined_start.hpp>
 #include <mlpack/methods/kmeans/elkan_kmeans.hpp>
 #include <mlpack/methods/kmeans/hamerly_kmeans.hpp>
+#include <mlpack/methods/kmeans/yinyang_kmeans.hpp>
+#include <mlpack/methods/kmeans/blocked_kmeans.hpp>
+#include <mlpack/methods/kmeans/sparse_kmeans.hpp>
+#include <mlpack/methods/kmeans/mini_batch_kmeans.hpp>
 #include <mlpack/methods/kmeans/pelleg_moore_kmeans.hpp>
 #include <mlpack/methods/kmeans/dual_tree_kmeans.hpp>
 #include <mlpack/methods/kmeans/sample_initialization.hpp>
 #include <mlpack/methods/kmeans/random_partition.hpp>
+#include <mlpack/methods/kmeans/kmeans_plus_plus_initialization.hpp>
+#include <mlpack/methods/kmeans/kmeans_parallel_initialization.hpp>
 
 #include <mlpack/core/tree/cover_tree/cover_tree.hpp>
 #include <mlpack/methods/neighbor_search/neighbor_search.hpp>
@@ -195,6 +201,79 @@ BOOST_AUTO_TEST_CASE(MaxVarianceNewClusterTest)
   BOOST_REQUIRE_EQUAL(counts[2], 1);
 }
 
+/**
+ * Make sure the max variance method finds the correct point when the Lloyd
+ * step gives the cluster statistics, instead of scanning the dataset.
+ */
+BOOST_AUTO_TEST_CASE(MaxVarianceNewClusterStatisticsTest)
+{
+  arma::mat data("0.4 1.0 5.0 -2.0 -2.5;"
+                 "1.0 0.8 0.7  5.1  5.2;");
+
+  arma::mat centroids(2, 3);
+  centroids.col(0) = (1.0 / 3.0) * (data.col(0) + data.col(1) + data.col(2));
+  centroids.col(1) = 0.5 * (data.col(3) + data.col(4));
+  centroids(0, 2) = DBL_MAX;
+  centroids(1, 2) = DBL_MAX;
+
+  arma::Col<size_t> counts("3 2 0");
+  arma::Col<size_t> assignments("0 0 0 1 1");
+  arma::vec squaredNormSums(3, arma::fill::zeros);
+  for (size_t i = 0; i < data.n_cols; ++i)
+    squaredNormSums[assignments[i]] += arma::dot(data.col(i), data.col(i));
+
+  metric::EuclideanDistance metric;
+  MaxVarianceNewCluster mvnc;
+  mvnc.ClusterStatistics(assignments, squaredNormSums, 0);
+  BOOST_REQUIRE_EQUAL(mvnc.EmptyCluster(data, 2, centroids, centroids, counts,
+      metric, 0), 1);
+
+  // Point 2 is taken from cluster 0.
+  BOOST_REQUIRE_EQUAL(counts[0], 2);
+  BOOST_REQUIRE_EQUAL(counts[1], 2);
+  BOOST_REQUIRE_EQUAL(counts[2], 1);
+  BOOST_REQUIRE_CLOSE(centroids(0, 2), 5.0, 1e-5);
+  BOOST_REQUIRE_CLOSE(centroids(1, 2), 0.7, 1e-5);
+  BOOST_REQUIRE_CLOSE(centroids(0, 0), 0.7, 1e-5);
+  BOOST_REQUIRE_CLOSE(centroids(1, 0), 0.9, 1e-5);
+}
+
+/**
+ * Make sure the Lloyd steps that share cluster statistics with the empty
+ * cluster policy compute them correctly.
+ */
+BOOST_AUTO_TEST_CASE(LloydStepSquaredNormSumsTest)
+{
+  arma::mat dataset(4, 500, arma::fill::randu);
+  arma::mat centroids(4, 12, arma::fill::randu);
+  metric::EuclideanDistance metric;
+
+  NaiveKMeans<metric::EuclideanDistance, arma::mat> naive(dataset, metric);
+  HamerlyKMeans<metric::EuclideanDistance, arma::mat> hamerly(dataset, metric);
+
+  arma::mat naiveCentroids, hamerlyCentroids, nextCentroids;
+  arma::Col<size_t> naiveCounts, hamerlyCounts;
+  naive.Iterate(centroids, naiveCentroids, naiveCounts);
+  hamerly.Iterate(centroids, hamerlyCentroids, hamerlyCounts);
+  // Run another iteration, where Hamerly's bounds prune points.
+  naive.Iterate(naiveCentroids, nextCentroids, naiveCounts);
+  hamerly.Iterate(hamerlyCentroids, nextCentroids, hamerlyCounts);
+
+  arma::vec expected(centroids.n_cols, arma::fill::zeros);
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(naive.Assignments()[i], hamerly.Assignments()[i]);
+    expected[naive.Assignments()[i]] += arma::dot(dataset.col(i),
+        dataset.col(i));
+  }
+
+  for (size_t c = 0; c < centroids.n_cols; ++c)
+  {
+    BOOST_REQUIRE_CLOSE(naive.SquaredNormSums()[c], expected[c], 1e-5);
+    BOOST_REQUIRE_CLOSE(hamerly.SquaredNormSums()[c], expected[c], 1e-5);
+  }
+}
+
 /**
  * Make sure the random partitioner seems to return valid results.
  */
@@ -572,6 +651,483 @@ BOOST_AUTO_TEST_CASE(HamerlyTest)
   }
 }
 
+BOOST_AUTO_TEST_CASE(YinyangTest)
+{
+  const size_t trials = 5;
+
+  for (size_t t = 0; t < trials; ++t)
+  {
+    arma::mat dataset(10, 1000);
+    dataset.randu();
+
+    // Use enough centroids to have several groups.
+    const size_t k = 10 * (t + 1);
+    arma::mat centroids(10, k);
+    centroids.randu();
+
+    // Make sure the Yinyang algorithm and the naive method return the same
+    // clusters.
+    arma::mat naiveCentroids(centroids);
+    KMeans<> km;
+    arma::Row<size_t> assignments;
+    km.Cluster(dataset, k, assignments, naiveCentroids, false, true);
+
+    KMeans<metric::EuclideanDistance, RandomPartition, MaxVarianceNewCluster,
+        YinyangKMeans> yinyang;
+    arma::Row<size_t> yinyangAssignments;
+    arma::mat yinyangCentroids(centroids);
+    yinyang.Cluster(dataset, k, yinyangAssignments, yinyangCentroids, false,
+        true);
+
+    for (size_t i = 0; i < dataset.n_cols; ++i)
+      BOOST_REQUIRE_EQUAL(assignments[i], yinyangAssignments[i]);
+
+    for (size_t i = 0; i < centroids.n_elem; ++i)
+      BOOST_REQUIRE_CLOSE(naiveCentroids[i], yinyangCentroids[i], 1e-5);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(BlockedTest)
+{
+  const size_t trials = 5;
+
+  for (size_t t = 0; t < trials; ++t)
+  {
+    arma::mat dataset(10, 1000);
+    dataset.randu();
+
+    const size_t k = 5 * (t + 1);
+    arma::mat centroids(10, k);
+    centroids.randu();
+
+    // Make sure the blocked algorithm and the naive method return the same
+    // clusters.
+    arma::mat naiveCentroids(centroids);
+    KMeans<> km;
+    arma::Row<size_t> assignments;
+    km.Cluster(dataset, k, assignments, naiveCentroids, false, true);
+
+    KMeans<metric::EuclideanDistance, RandomPartition, MaxVarianceNewCluster,
+        BlockedKMeans> blocked;
+    arma::Row<size_t> blockedAssignments;
+    arma::mat blockedCentroids(centroids);
+    blocked.Cluster(dataset, k, blockedAssignments, blockedCentroids, false,
+        true);
+
+    for (size_t i = 0; i < dataset.n_cols; ++i)
+      BOOST_REQUIRE_EQUAL(assignments[i], blockedAssignments[i]);
+
+    for (size_t i = 0; i < centroids.n_elem; ++i)
+      BOOST_REQUIRE_CLOSE(naiveCentroids[i], blockedCentroids[i], 1e-5);
+  }
+}
+
+/**
+ * Make sure that one blocked Lloyd step gives the same result as one naive
+ * step when there are several blocks of points and of centroids, with the
+ * squared Euclidean distance.
+ */
+BOOST_AUTO_TEST_CASE(BlockedManyBlocksTest)
+{
+  arma::mat dataset(40, 3000, arma::fill::randu);
+  arma::mat centroids(40, 1500, arma::fill::randu);
+
+  metric::SquaredEuclideanDistance metric;
+  NaiveKMeans<metric::SquaredEuclideanDistance, arma::mat> naive(dataset,
+      metric);
+  BlockedKMeans<metric::SquaredEuclideanDistance, arma::mat> blocked(dataset,
+      metric);
+
+  arma::mat naiveCentroids, blockedCentroids;
+  arma::Col<size_t> naiveCounts, blockedCounts;
+  const double naiveNorm = naive.Iterate(centroids, naiveCentroids,
+      naiveCounts);
+  const double blockedNorm = blocked.Iterate(centroids, blockedCentroids,
+      blockedCounts);
+
+  BOOST_REQUIRE_CLOSE(naiveNorm, blockedNorm, 1e-5);
+  for (size_t i = 0; i < naiveCounts.n_elem; ++i)
+    BOOST_REQUIRE_EQUAL(naiveCounts[i], blockedCounts[i]);
+  for (size_t i = 0; i < naiveCentroids.n_elem; ++i)
+  {
+    if (naiveCounts[i / naiveCentroids.n_rows] != 0)
+      BOOST_REQUIRE_CLOSE(naiveCentroids[i], blockedCentroids[i], 1e-5);
+  }
+  BOOST_REQUIRE_EQUAL(naive.DistanceCalculations(),
+      blocked.DistanceCalculations());
+}
+
+/**
+ * Make sure that one sparse Lloyd step gives the same result as one naive step
+ * on sparse data with several blocks of points.
+ */
+BOOST_AUTO_TEST_CASE(SparseLloydStepTest)
+{
+  arma::sp_mat dataset;
+  dataset.sprandu(2000, 1000, 0.01);
+  arma::mat centroids(2000, 20);
+  for (size_t i = 0; i < centroids.n_cols; ++i)
+    centroids.col(i) = arma::vec(dataset.col(i * 50));
+
+  metric::EuclideanDistance metric;
+  NaiveKMeans<metric::EuclideanDistance, arma::sp_mat> naive(dataset, metric);
+  SparseKMeans<metric::EuclideanDistance, arma::sp_mat> sparse(dataset,
+      metric);
+
+  arma::mat naiveCentroids, sparseCentroids;
+  arma::Col<size_t> naiveCounts, sparseCounts;
+  const double naiveNorm = naive.Iterate(centroids, naiveCentroids,
+      naiveCounts);
+  const double sparseNorm = sparse.Iterate(centroids, sparseCentroids,
+      sparseCounts);
+
+  BOOST_REQUIRE_CLOSE(naiveNorm, sparseNorm, 1e-5);
+  for (size_t i = 0; i < naiveCounts.n_elem; ++i)
+    BOOST_REQUIRE_EQUAL(naiveCounts[i], sparseCounts[i]);
+  for (size_t i = 0; i < naiveCentroids.n_elem; ++i)
+  {
+    if (naiveCounts[i / naiveCentroids.n_rows] != 0)
+      BOOST_REQUIRE_SMALL(naiveCentroids[i] - sparseCentroids[i], 1e-8);
+  }
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+    BOOST_REQUIRE_EQUAL(naive.Assignments()[i], sparse.Assignments()[i]);
+  for (size_t i = 0; i < naiveCounts.n_elem; ++i)
+  {
+    BOOST_REQUIRE_CLOSE(naive.SquaredNormSums()[i],
+        sparse.SquaredNormSums()[i], 1e-5);
+  }
+  BOOST_REQUIRE_EQUAL(naive.DistanceCalculations(),
+      sparse.DistanceCalculations());
+}
+
+/**
+ * Make sure that k-means with restarts returns the objective of the clustering
+ * it keeps, and that it is no worse than the first restart alone.
+ */
+BOOST_AUTO_TEST_CASE(KMeansRestartsTest)
+{
+  arma::mat dataset(5, 1000, arma::fill::randu);
+  const size_t k = 8;
+
+  KMeans<> kmeans;
+  arma::Row<size_t> assignments;
+  arma::mat centroids;
+  const double objective = kmeans.Cluster(dataset, k, 5, assignments,
+      centroids);
+
+  BOOST_REQUIRE_EQUAL(assignments.n_elem, dataset.n_cols);
+  BOOST_REQUIRE_EQUAL(centroids.n_cols, k);
+  double expected = 0.0;
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+  {
+    expected += std::pow(arma::norm(dataset.col(i) -
+        centroids.col(assignments[i])), 2.0);
+  }
+  BOOST_REQUIRE_CLOSE(objective, expected, 1e-5);
+
+  // The first restart uses the random stream of task 0.
+  arma::Row<size_t> firstAssignments;
+  arma::mat firstCentroids;
+  {
+    math::TaskRandomStreamScope scope(0);
+    kmeans.Cluster(dataset, k, firstAssignments, firstCentroids);
+  }
+  double firstObjective = 0.0;
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+  {
+    firstObjective += std::pow(arma::norm(dataset.col(i) -
+        firstCentroids.col(firstAssignments[i])), 2.0);
+  }
+  BOOST_REQUIRE_LE(objective, firstObjective * (1 + 1e-10));
+}
+
+#ifdef HAS_OPENMP
+/**
+ * Cluster with the given Lloyd step type using the given number of threads.
+ */
+template<template<class, class> class LloydStepType>
+void ClusterWithThreads(const arma::mat& dataset,
+                        const size_t k,
+                        const size_t threads,
+                        arma::Row<size_t>& assignments,
+                        arma::mat& centroids)
+{
+  const size_t prevNumThreads = omp_get_max_threads();
+  omp_set_num_threads(threads);
+
+  KMeans<metric::EuclideanDistance, RandomPartition, MaxVarianceNewCluster,
+      LloydStepType> km;
+  km.Cluster(dataset, k, assignments, centroids, false, true);
+
+  omp_set_num_threads(prevNumThreads);
+}
+
+/**
+ * Make sure that the naive, Elkan, Hamerly and Yinyang Lloyd steps give the
+ * same clustering with several threads as with one thread.
+ */
+BOOST_AUTO_TEST_CASE(ParallelLloydStepTest)
+{
+  arma::mat dataset(10, 5000, arma::fill::randu);
+  const size_t k = 20;
+  arma::mat initialCentroids(10, k, arma::fill::randu);
+
+  arma::Row<size_t> assignments[8];
+  arma::mat centroids[8];
+  for (size_t i = 0; i < 8; ++i)
+    centroids[i] = initialCentroids;
+
+  ClusterWithThreads<NaiveKMeans>(dataset, k, 1, assignments[0], centroids[0]);
+  ClusterWithThreads<NaiveKMeans>(dataset, k, 4, assignments[1], centroids[1]);
+  ClusterWithThreads<ElkanKMeans>(dataset, k, 1, assignments[2], centroids[2]);
+  ClusterWithThreads<ElkanKMeans>(dataset, k, 4, assignments[3], centroids[3]);
+  ClusterWithThreads<HamerlyKMeans>(dataset, k, 1, assignments[4],
+      centroids[4]);
+  ClusterWithThreads<HamerlyKMeans>(dataset, k, 4, assignments[5],
+      centroids[5]);
+  ClusterWithThreads<YinyangKMeans>(dataset, k, 1, assignments[6],
+      centroids[6]);
+  ClusterWithThreads<YinyangKMeans>(dataset, k, 4, assignments[7],
+      centroids[7]);
+
+  for (size_t j = 1; j < 8; ++j)
+  {
+    for (size_t i = 0; i < dataset.n_cols; ++i)
+      BOOST_REQUIRE_EQUAL(assignments[0][i], assignments[j][i]);
+
+    for (size_t i = 0; i < centroids[0].n_elem; ++i)
+      BOOST_REQUIRE_CLOSE(centroids[0][i], centroids[j][i], 1e-5);
+  }
+}
+
+/**
+ * Make sure that the dual-tree and Pelleg-Moore Lloyd steps give the same
+ * clustering with several threads as the naive step.
+ */
+BOOST_AUTO_TEST_CASE(ParallelTreeLloydStepTest)
+{
+  arma::mat dataset(5, 3000, arma::fill::randu);
+  const size_t k = 25;
+  arma::mat initialCentroids(5, k, arma::fill::randu);
+
+  arma::Row<size_t> assignments[4];
+  arma::mat centroids[4];
+  for (size_t i = 0; i < 4; ++i)
+    centroids[i] = initialCentroids;
+
+  ClusterWithThreads<NaiveKMeans>(dataset, k, 1, assignments[0], centroids[0]);
+  ClusterWithThreads<DefaultDualTreeKMeans>(dataset, k, 4, assignments[1],
+      centroids[1]);
+  ClusterWithThreads<CoverTreeDualTreeKMeans>(dataset, k, 4, assignments[2],
+      centroids[2]);
+  ClusterWithThreads<PellegMooreKMeans>(dataset, k, 4, assignments[3],
+      centroids[3]);
+
+  for (size_t j = 1; j < 4; ++j)
+  {
+    for (size_t i = 0; i < dataset.n_cols; ++i)
+      BOOST_REQUIRE_EQUAL(assignments[0][i], assignments[j][i]);
+
+    for (size_t i = 0; i < centroids[0].n_elem; ++i)
+      BOOST_REQUIRE_CLOSE(centroids[0][i], centroids[j][i], 1e-5);
+  }
+}
+
+/**
+ * Make sure that k-means with restarts gives the same clustering with one
+ * thread and with four threads.
+ */
+BOOST_AUTO_TEST_CASE(ParallelKMeansRestartsTest)
+{
+  arma::mat dataset(5, 2000, arma::fill::randu);
+  const size_t k = 10;
+  const size_t prevNumThreads = omp_get_max_threads();
+
+  KMeans<metric::EuclideanDistance, RandomPartition, MaxVarianceNewCluster,
+      HamerlyKMeans> kmeans;
+  arma::Row<size_t> assignments, parallelAssignments;
+  arma::mat centroids, parallelCentroids;
+
+  omp_set_num_threads(1);
+  const double objective = kmeans.Cluster(dataset, k, 6, assignments,
+      centroids);
+  omp_set_num_threads(4);
+  const double parallelObjective = kmeans.Cluster(dataset, k, 6,
+      parallelAssignments, parallelCentroids);
+  omp_set_num_threads(prevNumThreads);
+
+  BOOST_REQUIRE_CLOSE(objective, parallelObjective, 1e-5);
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+    BOOST_REQUIRE_EQUAL(assignments[i], parallelAssignments[i]);
+  for (size_t i = 0; i < centroids.n_elem; ++i)
+    BOOST_REQUIRE_CLOSE(centroids[i], parallelCentroids[i], 1e-5);
+}
+#endif
+
+/**
+ * Make sure that mini-batch k-means finds the centers of well-separated
+ * Gaussian clusters.
+ */
+BOOST_AUTO_TEST_CASE(MiniBatchKMeansTest)
+{
+  math::RandomSeed(std::time(NULL));
+
+  arma::mat centers("0.0 10.0 0.0;"
+                    "0.0 0.0 10.0");
+  arma::mat dataset(2, 3000);
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+    dataset.col(i) = centers.col(i % 3) + 0.5 * arma::randn<arma::vec>(2);
+
+  // Start from one point of each cluster so that no cluster is missed.
+  arma::mat centroids(2, 3);
+  for (size_t i = 0; i < 3; ++i)
+    centroids.col(i) = dataset.col(i);
+
+  MiniBatchKMeans<> kmeans(100, 200);
+  arma::Row<size_t> assignments;
+  kmeans.Cluster(dataset, 3, assignments, centroids, true);
+
+  BOOST_REQUIRE_EQUAL(assignments.n_elem, dataset.n_cols);
+  for (size_t i = 0; i < 3; ++i)
+  {
+    BOOST_REQUIRE_SMALL(arma::norm(centroids.col(i) - centers.col(i), 2), 0.3);
+    for (size_t j = i; j < dataset.n_cols; j += 3)
+      BOOST_REQUIRE_EQUAL(assignments[j], i);
+  }
+}
+
+/**
+ * Make sure that mini-batch k-means stops early when the centroids stop
+ * moving, and that it throws when it can't initialize the centroids.
+ */
+BOOST_AUTO_TEST_CASE(MiniBatchKMeansToleranceTest)
+{
+  // Every centroid is already at its only point, so nothing moves.
+  arma::mat dataset("0.0 1.0 2.0");
+  arma::mat centroids(dataset);
+
+  MiniBatchKMeans<> kmeans(10, 1000, 1e-10);
+  kmeans.Cluster(dataset, 3, centroids, true);
+  for (size_t i = 0; i < 3; ++i)
+    BOOST_REQUIRE_SMALL(centroids[i] - dataset[i], 1e-10);
+
+  // A batch of 2 points can't give 3 centroids.
+  MiniBatchKMeans<> smallBatches(2);
+  arma::Row<size_t> assignments;
+  BOOST_REQUIRE_THROW(smallBatches.Cluster(dataset, 3, assignments,
+      centroids), std::invalid_argument);
+
+  BOOST_REQUIRE_THROW(MiniBatchKMeans<>(0), std::invalid_argument);
+}
+
+/**
+ * Make sure that StreamBatchSource reads points correctly, rewinds at the end
+ * of the stream, and complains about malformed lines.
+ */
+BOOST_AUTO_TEST_CASE(StreamBatchSourceTest)
+{
+  std::istringstream stream("1.0, 2.0\n3.0 4.0\n\n5.0,\t6.0\n");
+  StreamBatchSource source(stream);
+
+  arma::mat batch;
+  BOOST_REQUIRE_EQUAL(source.NextBatch(2, batch), 2);
+  BOOST_REQUIRE_EQUAL(source.Dimensionality(), 2);
+  BOOST_REQUIRE_EQUAL(batch.n_rows, 2);
+  BOOST_REQUIRE_EQUAL(batch.n_cols, 2);
+  BOOST_REQUIRE_CLOSE(batch(0, 0), 1.0, 1e-5);
+  BOOST_REQUIRE_CLOSE(batch(1, 0), 2.0, 1e-5);
+  BOOST_REQUIRE_CLOSE(batch(0, 1), 3.0, 1e-5);
+  BOOST_REQUIRE_CLOSE(batch(1, 1), 4.0, 1e-5);
+
+  // The second batch goes past the end of the stream and starts again.
+  BOOST_REQUIRE_EQUAL(source.NextBatch(2, batch), 2);
+  BOOST_REQUIRE_CLOSE(batch(0, 0), 5.0, 1e-5);
+  BOOST_REQUIRE_CLOSE(batch(1, 0), 6.0, 1e-5);
+  BOOST_REQUIRE_CLOSE(batch(0, 1), 1.0, 1e-5);
+  BOOST_REQUIRE_CLOSE(batch(1, 1), 2.0, 1e-5);
+
+  // Without rewinding, the source runs out of points.
+  std::istringstream onceStream("1.0 2.0\n3.0 4.0\n");
+  StreamBatchSource onceSource(onceStream, false);
+  BOOST_REQUIRE_EQUAL(onceSource.NextBatch(5, batch), 2);
+  BOOST_REQUIRE_EQUAL(onceSource.NextBatch(5, batch), 0);
+
+  std::istringstream mismatchStream("1.0 2.0\n3.0\n");
+  StreamBatchSource mismatchSource(mismatchStream);
+  BOOST_REQUIRE_THROW(mismatchSource.NextBatch(2, batch), std::runtime_error);
+
+  std::istringstream badStream("1.0 abc\n");
+  StreamBatchSource badSource(badStream);
+  BOOST_REQUIRE_THROW(badSource.NextBatch(1, batch), std::runtime_error);
+}
+
+/**
+ * Make sure that mini-batch k-means can cluster points read from a stream.
+ */
+BOOST_AUTO_TEST_CASE(MiniBatchKMeansStreamTest)
+{
+  std::ostringstream oss;
+  for (size_t i = 0; i < 200; ++i)
+    oss << (i % 2 == 0 ? 0.0 : 10.0) + 0.1 * math::Random() << ", 0.0\n";
+
+  std::istringstream stream(oss.str());
+  StreamBatchSource source(stream);
+
+  arma::mat centroids("1.0 9.0;"
+                      "0.0 0.0");
+  MiniBatchKMeans<> kmeans(50, 20);
+  kmeans.Cluster(source, 2, centroids, true);
+
+  BOOST_REQUIRE_SMALL(centroids(0, 0) - 0.05, 0.1);
+  BOOST_REQUIRE_SMALL(centroids(0, 1) - 10.05, 0.1);
+  BOOST_REQUIRE_SMALL(centroids(1, 0), 1e-5);
+  BOOST_REQUIRE_SMALL(centroids(1, 1), 1e-5);
+}
+
+/**
+ * Make sure that ChunkedBatchSource cuts batches across blocks and starts a
+ * new pass of the reader when one is over.
+ */
+BOOST_AUTO_TEST_CASE(ChunkedBatchSourceTest)
+{
+  arma::mat dataset(2, 25);
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+  {
+    dataset(0, i) = i;
+    dataset(1, i) = 2 * i;
+  }
+  data::Save("test.csv", dataset);
+
+  data::ChunkedReader reader("test.csv", 7);
+  ChunkedBatchSource source(reader);
+  BOOST_REQUIRE_EQUAL(source.Dimensionality(), 2);
+
+  // Ten batches of 10 points go through the data four times.
+  arma::mat batch;
+  for (size_t b = 0; b < 10; ++b)
+  {
+    BOOST_REQUIRE_EQUAL(source.NextBatch(10, batch), 10);
+    BOOST_REQUIRE_EQUAL(batch.n_rows, 2);
+    BOOST_REQUIRE_EQUAL(batch.n_cols, 10);
+    for (size_t i = 0; i < 10; ++i)
+    {
+      const size_t index = (10 * b + i) % dataset.n_cols;
+      BOOST_REQUIRE_CLOSE(batch(0, i) + 1, index + 1.0, 1e-5);
+      BOOST_REQUIRE_CLOSE(batch(1, i) + 1, 2 * index + 1.0, 1e-5);
+    }
+  }
+
+  // Without rewinding, the source runs out of points after one pass.
+  data::ChunkedReader onceReader("test.csv", 7);
+  ChunkedBatchSource onceSource(onceReader, false);
+  BOOST_REQUIRE_EQUAL(onceSource.NextBatch(20, batch), 20);
+  BOOST_REQUIRE_EQUAL(onceSource.NextBatch(20, batch), 5);
+  BOOST_REQUIRE_EQUAL(batch.n_cols, 5);
+  BOOST_REQUIRE_EQUAL(onceSource.NextBatch(20, batch), 0);
+
+  remove("test.csv");
+}
+
 BOOST_AUTO_TEST_CASE(PellegMooreTest)
 {
   const size_t trials = 5;
@@ -670,6 +1226,58 @@ BOOST_AUTO_TEST_CASE(DTNNCoverTreeTest)
   }
 }
 
+/**
+ * Make sure that the dual-tree Lloyd step gives the same centroids as the naive
+ * step whether the centroid tree is refit or rebuilt, and that the rebuild
+ * threshold controls how often it is rebuilt.
+ */
+BOOST_AUTO_TEST_CASE(DTNNCentroidTreeRefitTest)
+{
+  arma::mat dataset(5, 2000, arma::fill::randu);
+  arma::mat centroids(5, 30, arma::fill::randu);
+  metric::EuclideanDistance metric;
+
+  NaiveKMeans<metric::EuclideanDistance, arma::mat> naive(dataset, metric);
+  DefaultDualTreeKMeans<metric::EuclideanDistance, arma::mat> refit(dataset,
+      metric);
+  DefaultDualTreeKMeans<metric::EuclideanDistance, arma::mat> rebuild(dataset,
+      metric);
+  refit.RebuildThreshold() = DBL_MAX;
+  rebuild.RebuildThreshold() = -1.0;
+
+  const size_t iterations = 10;
+  for (size_t it = 0; it < iterations; ++it)
+  {
+    arma::mat naiveCentroids, refitCentroids, rebuildCentroids;
+    arma::Col<size_t> naiveCounts, refitCounts, rebuildCounts;
+    naive.Iterate(centroids, naiveCentroids, naiveCounts);
+    refit.Iterate(centroids, refitCentroids, refitCounts);
+    rebuild.Iterate(centroids, rebuildCentroids, rebuildCounts);
+
+    for (size_t c = 0; c < centroids.n_cols; ++c)
+    {
+      BOOST_REQUIRE_EQUAL(naiveCounts[c], refitCounts[c]);
+      BOOST_REQUIRE_EQUAL(naiveCounts[c], rebuildCounts[c]);
+
+      // Empty clusters keep their centroid.
+      if (naiveCounts[c] == 0)
+        continue;
+
+      for (size_t d = 0; d < centroids.n_rows; ++d)
+      {
+        BOOST_REQUIRE_CLOSE(naiveCentroids(d, c), refitCentroids(d, c), 1e-5);
+        BOOST_REQUIRE_CLOSE(naiveCentroids(d, c), rebuildCentroids(d, c),
+            1e-5);
+      }
+
+      centroids.col(c) = naiveCentroids.col(c);
+    }
+  }
+
+  BOOST_REQUIRE_EQUAL(refit.CentroidTreeBuilds(), 1);
+  BOOST_REQUIRE_EQUAL(rebuild.CentroidTreeBuilds(), iterations);
+}
+
 /**
  * Make sure that the sample initialization strategy successfully samples points
  * from the dataset.
@@ -704,4 +1312,114 @@ BOOST_AUTO_TEST_CASE(SampleInitializationTest)
   }
 }
 
+/**
+ * Generate points around the given centers, with a small spread, so that
+ * a good initialization takes one centroid from each center.
+ */
+arma::mat SeparatedClusters(const arma::mat& centers, const size_t points)
+{
+  arma::mat dataset(centers.n_rows, points);
+  for (size_t i = 0; i < points; ++i)
+    dataset.col(i) = centers.col(i % centers.n_cols) +
+        0.01 * arma::randn<arma::vec>(centers.n_rows);
+
+  return dataset;
+}
+
+/**
+ * Make sure that the given centroids have exactly one centroid close to each
+ * center.
+ */
+void CheckOneCentroidPerCenter(const arma::mat& centroids,
+                               const arma::mat& centers)
+{
+  BOOST_REQUIRE_EQUAL(centroids.n_rows, centers.n_rows);
+  BOOST_REQUIRE_EQUAL(centroids.n_cols, centers.n_cols);
+
+  std::vector<bool> found(centers.n_cols, false);
+  for (size_t i = 0; i < centroids.n_cols; ++i)
+  {
+    size_t j;
+    for (j = 0; j < centers.n_cols; ++j)
+      if (arma::norm(centroids.col(i) - centers.col(j), 2) < 0.5)
+        break;
+
+    BOOST_REQUIRE_LT(j, centers.n_cols);
+    BOOST_REQUIRE(!found[j]);
+    found[j] = true;
+  }
+}
+
+/**
+ * Make sure k-means++ takes one centroid from each of several well-separated
+ * clusters, and that it never takes points of weight zero.
+ */
+BOOST_AUTO_TEST_CASE(KMeansPlusPlusInitializationTest)
+{
+  arma::mat centers("0.0 100.0 0.0 100.0;"
+                    "0.0 0.0 100.0 100.0");
+  arma::mat dataset = SeparatedClusters(centers, 400);
+
+  arma::mat centroids;
+  KMeansPlusPlusInitialization::Cluster(dataset, 4, centroids);
+  CheckOneCentroidPerCenter(centroids, centers);
+
+  // Only the points of the first two clusters have any weight.
+  arma::vec weights(dataset.n_cols, arma::fill::zeros);
+  for (size_t i = 0; i < dataset.n_cols; i += 4)
+  {
+    weights[i] = 1.0;
+    weights[i + 1] = 2.0;
+  }
+
+  KMeansPlusPlusInitialization::WeightedCluster(dataset, weights, 2,
+      centroids);
+  CheckOneCentroidPerCenter(centroids, centers.cols(0, 1));
+}
+
+/**
+ * Make sure k-means|| takes one centroid from each of several well-separated
+ * clusters, and that k-means converges from it.
+ */
+BOOST_AUTO_TEST_CASE(KMeansParallelInitializationTest)
+{
+  arma::mat centers("0.0 100.0 0.0 100.0 50.0;"
+                    "0.0 0.0 100.0 100.0 50.0");
+  arma::mat dataset = SeparatedClusters(centers, 1000);
+
+  KMeansParallelInitialization kmpi(2.0, 5);
+  arma::mat centroids;
+  kmpi.Cluster(dataset, 5, centroids);
+  CheckOneCentroidPerCenter(centroids, centers);
+
+  KMeans<EuclideanDistance, KMeansParallelInitialization> kmeans(1000,
+      EuclideanDistance(), kmpi);
+  arma::Row<size_t> assignments;
+  kmeans.Cluster(dataset, 5, assignments, centroids);
+  CheckOneCentroidPerCenter(centroids, centers);
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+    BOOST_REQUIRE_EQUAL(assignments[i], assignments[i % 5]);
+}
+
+/**
+ * Make sure k-means|| still gives all the centroids when there are fewer
+ * distinct points than clusters, or no oversampling rounds.
+ */
+BOOST_AUTO_TEST_CASE(KMeansParallelInitializationFewPointsTest)
+{
+  arma::mat dataset("1.0 1.0 2.0 2.0");
+  arma::mat centroids;
+
+  KMeansParallelInitialization kmpi;
+  kmpi.Cluster(dataset, 3, centroids);
+  BOOST_REQUIRE_EQUAL(centroids.n_rows, 1);
+  BOOST_REQUIRE_EQUAL(centroids.n_cols, 3);
+  for (size_t i = 0; i < 3; ++i)
+    BOOST_REQUIRE(centroids[i] == 1.0 || centroids[i] == 2.0);
+
+  KMeansParallelInitialization noRounds(2.0, 0);
+  noRounds.Cluster(dataset, 2, centroids);
+  BOOST_REQUIRE_EQUAL(centroids.n_cols, 2);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
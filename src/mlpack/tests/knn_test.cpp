@@ -9,13 +9,22 @@
  * http://www.opensource.org/licenses/BSD-3-Clause for more information.
  */
 #include <mlpack/core.hpp>
+#include <mlpack/core/util/numa.hpp>
 #include <mlpack/methods/neighbor_search/neighbor_search.hpp>
 #include <mlpack/methods/neighbor_search/unmap.hpp>
 #include <mlpack/methods/neighbor_search/ns_model.hpp>
+#include <mlpack/methods/neighbor_search/chunked_neighbor_search.hpp>
+#include <mlpack/methods/neighbor_search/sharded_neighbor_search.hpp>
+#include <mlpack/methods/neighbor_search/transformed_neighbor_search.hpp>
+#include <mlpack/methods/neighbor_search/hnsw_search.hpp>
+#include <mlpack/methods/neighbor_search/pq_search.hpp>
+#include <mlpack/methods/neighbor_search/nn_descent.hpp>
+#include <mlpack/methods/neighbor_search/inverted_index_search.hpp>
 #include <mlpack/core/tree/cover_tree.hpp>
 #include <mlpack/core/tree/example_tree.hpp>
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
+#include "serialization.hpp"
 
 using namespace mlpack;
 using namespace mlpack::neighbor;
@@ -1143,6 +1152,44 @@ BOOST_AUTO_TEST_CASE(KNNModelTest)
   }
 }
 
+/**
+ * Make sure that NSModel reports the size of the reference tree and the number
+ * of base cases and scores of the last search.
+ */
+BOOST_AUTO_TEST_CASE(KNNModelTreeSizeTest)
+{
+  typedef NSModel<NearestNeighborSort> KNNModel;
+
+  arma::mat referenceData = arma::randu<arma::mat>(3, 1000);
+
+  KNNModel knn(KNNModel::TreeTypes::KD_TREE);
+  arma::mat referenceCopy(referenceData);
+  knn.BuildModel(std::move(referenceCopy), 20, SINGLE_TREE_MODE);
+
+  size_t numNodes, numBytes;
+  knn.TreeSize(numNodes, numBytes);
+
+  // Every leaf of a kd-tree holds at most 20 points, and every node has zero
+  // or two children.
+  BOOST_REQUIRE_GE(numNodes, 2 * (1000 / 20) - 1);
+  BOOST_REQUIRE_EQUAL(numNodes % 2, 1);
+  BOOST_REQUIRE_EQUAL(numBytes, numNodes * sizeof(NSType<NearestNeighborSort,
+      KDTree>::Tree));
+
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  knn.Search(3, neighbors, distances);
+  BOOST_REQUIRE_GT(knn.BaseCases(), 0);
+  BOOST_REQUIRE_GT(knn.Scores(), 0);
+
+  // Naive search doesn't build a tree.
+  referenceCopy = referenceData;
+  knn.BuildModel(std::move(referenceCopy), 20, NAIVE_MODE);
+  knn.TreeSize(numNodes, numBytes);
+  BOOST_REQUIRE_EQUAL(numNodes, 0);
+  BOOST_REQUIRE_EQUAL(numBytes, 0);
+}
+
 BOOST_AUTO_TEST_CASE(KNNModelMonochromaticTest)
 {
   // Ensure that we can build an NSModel<NearestNeighborSearch> and get correct
@@ -1434,4 +1481,1129 @@ BOOST_AUTO_TEST_CASE(MoveOperatorNaiveTest)
   CheckMatrices(distances, distances2);
 }
 
+/**
+ * Make sure that a kd-tree that has had points inserted and removed still gives
+ * correct results when used for search, without removing its free columns.
+ */
+BOOST_AUTO_TEST_CASE(KNNUpdatedTreeTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(3, 1000);
+
+  typedef KNN::Tree TreeType;
+  TreeType tree(dataset);
+
+  for (size_t i = 0; i < 200; ++i)
+    tree.InsertPoint(arma::vec(1.2 * arma::randu<arma::vec>(3)));
+  for (size_t i = 0; i < 200; ++i)
+    tree.DeletePoint(tree.Descendant(math::RandInt(tree.NumDescendants())));
+
+  // The naive search is run on the points of the tree, in the order of the
+  // tree; the tree doesn't map points, so its results are columns of its
+  // dataset.
+  std::vector<size_t> columns(tree.NumDescendants());
+  arma::mat points(3, columns.size());
+  for (size_t i = 0; i < columns.size(); ++i)
+  {
+    columns[i] = tree.Descendant(i);
+    points.col(i) = tree.Dataset().col(columns[i]);
+  }
+  BOOST_REQUIRE_GT(tree.Dataset().n_cols, columns.size());
+  const size_t numColumns = tree.Dataset().n_cols;
+
+  KNN naive(points, NAIVE_MODE);
+  KNN knn(std::move(tree));
+
+  arma::mat querySet = arma::randu<arma::mat>(3, 50);
+  arma::Mat<size_t> naiveNeighbors, naiveQueryNeighbors;
+  arma::mat naiveDistances, naiveQueryDistances;
+  naive.Search(5, naiveNeighbors, naiveDistances);
+  naive.Search(querySet, 5, naiveQueryNeighbors, naiveQueryDistances);
+
+  const NeighborSearchMode modes[] = { DUAL_TREE_MODE, SINGLE_TREE_MODE,
+      NAIVE_MODE };
+  for (size_t m = 0; m < 3; ++m)
+  {
+    knn.SearchMode() = modes[m];
+
+    arma::Mat<size_t> neighbors;
+    arma::mat distances;
+    knn.Search(5, neighbors, distances);
+
+    BOOST_REQUIRE_EQUAL(neighbors.n_cols, columns.size());
+    BOOST_REQUIRE_EQUAL(distances.n_cols, columns.size());
+    for (size_t i = 0; i < neighbors.n_cols; ++i)
+      for (size_t j = 0; j < neighbors.n_rows; ++j)
+        BOOST_REQUIRE_EQUAL(neighbors(j, i), columns[naiveNeighbors(j, i)]);
+    CheckMatrices(distances, naiveDistances);
+
+    knn.Search(querySet, 5, neighbors, distances);
+
+    BOOST_REQUIRE_EQUAL(neighbors.n_cols, querySet.n_cols);
+    for (size_t i = 0; i < neighbors.n_cols; ++i)
+    {
+      for (size_t j = 0; j < neighbors.n_rows; ++j)
+      {
+        BOOST_REQUIRE_EQUAL(neighbors(j, i),
+            columns[naiveQueryNeighbors(j, i)]);
+      }
+    }
+    CheckMatrices(distances, naiveQueryDistances);
+
+    // The free columns aren't counted as points.
+    BOOST_REQUIRE_THROW(knn.Search(querySet, columns.size() + 1, neighbors,
+        distances), std::invalid_argument);
+  }
+
+  // No search removed the free columns.
+  BOOST_REQUIRE_EQUAL(knn.ReferenceSet().n_cols, numColumns);
+}
+
+/**
+ * Make sure that the reference tree of a KNN object can be updated through
+ * ReferenceTree() and OldFromNewReferences(), and that the results are then
+ * given with the original indices of the points.
+ */
+BOOST_AUTO_TEST_CASE(KNNUpdateReferenceTreeTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(3, 500);
+  KNN knn(dataset);
+
+  // The points of the original and inserted indices.
+  arma::mat allPoints(3, 700);
+  allPoints.cols(0, 499) = dataset;
+  std::vector<bool> removed(700, false);
+  for (size_t i = 0; i < 200; ++i)
+  {
+    allPoints.col(500 + i) = 1.2 * arma::randu<arma::vec>(3);
+    knn.ReferenceTree().InsertPoint(allPoints.col(500 + i), 500 + i,
+        knn.OldFromNewReferences());
+
+    const size_t column = knn.ReferenceTree().Descendant(
+        math::RandInt(knn.ReferenceTree().NumDescendants()));
+    removed[knn.OldFromNewReferences()[column]] = true;
+    BOOST_REQUIRE(knn.ReferenceTree().DeletePoint(column,
+        knn.OldFromNewReferences()));
+  }
+
+  // The naive search is run on the points that are left, in the order of their
+  // indices.
+  std::vector<size_t> indices, positions(700, 0);
+  for (size_t i = 0; i < 700; ++i)
+  {
+    if (!removed[i])
+    {
+      positions[i] = indices.size();
+      indices.push_back(i);
+    }
+  }
+  BOOST_REQUIRE_EQUAL(indices.size(), knn.ReferenceTree().NumDescendants());
+
+  arma::mat points(3, indices.size());
+  for (size_t i = 0; i < indices.size(); ++i)
+    points.col(i) = allPoints.col(indices[i]);
+  KNN naive(points, NAIVE_MODE);
+
+  arma::mat querySet = arma::randu<arma::mat>(3, 50);
+  arma::Mat<size_t> neighbors, naiveNeighbors;
+  arma::mat distances, naiveDistances;
+  knn.Search(querySet, 5, neighbors, distances);
+  naive.Search(querySet, 5, naiveNeighbors, naiveDistances);
+
+  for (size_t i = 0; i < neighbors.n_cols; ++i)
+    for (size_t j = 0; j < neighbors.n_rows; ++j)
+      BOOST_REQUIRE_EQUAL(neighbors(j, i), indices[naiveNeighbors(j, i)]);
+  CheckMatrices(distances, naiveDistances);
+
+  // Column i of the monochromatic results is the point Descendant(i).
+  knn.Search(5, neighbors, distances);
+  naive.Search(5, naiveNeighbors, naiveDistances);
+
+  BOOST_REQUIRE_EQUAL(neighbors.n_cols, indices.size());
+  for (size_t i = 0; i < neighbors.n_cols; ++i)
+  {
+    const size_t index = knn.OldFromNewReferences()[
+        knn.ReferenceTree().Descendant(i)];
+    const size_t position = positions[index];
+    for (size_t j = 0; j < neighbors.n_rows; ++j)
+    {
+      BOOST_REQUIRE_EQUAL(neighbors(j, i),
+          indices[naiveNeighbors(j, position)]);
+      BOOST_REQUIRE_CLOSE(distances(j, i), naiveDistances(j, position),
+          1e-5);
+    }
+  }
+}
+
+/**
+ * Make sure that an NSModel saved as a flat image and loaded again gives the
+ * same results, for every tree type that supports flat images.
+ */
+BOOST_AUTO_TEST_CASE(KNNModelFlatImageTest)
+{
+  typedef NSModel<NearestNeighborSort> KNNModel;
+
+  arma::mat queryData = arma::randu<arma::mat>(10, 50);
+  arma::mat referenceData = arma::randu<arma::mat>(10, 200);
+
+  const KNNModel::TreeTypes treeTypes[] = { KNNModel::TreeTypes::KD_TREE,
+      KNNModel::TreeTypes::BALL_TREE, KNNModel::TreeTypes::VP_TREE,
+      KNNModel::TreeTypes::RP_TREE, KNNModel::TreeTypes::MAX_RP_TREE,
+      KNNModel::TreeTypes::UB_TREE };
+
+  for (size_t i = 0; i < 6; ++i)
+  {
+    for (size_t j = 0; j < 2; ++j)
+    {
+      KNNModel model(treeTypes[i], (j == 1));
+      arma::mat referenceCopy(referenceData);
+      model.BuildModel(std::move(referenceCopy), 5, DUAL_TREE_MODE);
+
+      model.SaveFlat("knn_flat_model.bin");
+      KNNModel flatModel;
+      flatModel.LoadFlat("knn_flat_model.bin");
+
+      BOOST_REQUIRE_EQUAL(flatModel.TreeType(), model.TreeType());
+      BOOST_REQUIRE_EQUAL(flatModel.RandomBasis(), model.RandomBasis());
+      BOOST_REQUIRE_EQUAL(flatModel.SearchMode(), model.SearchMode());
+      CheckMatrices(flatModel.Dataset(), model.Dataset());
+
+      arma::Mat<size_t> neighbors, flatNeighbors;
+      arma::mat distances, flatDistances;
+      arma::mat queryCopy(queryData);
+      model.Search(std::move(queryCopy), 3, neighbors, distances);
+      queryCopy = queryData;
+      flatModel.Search(std::move(queryCopy), 3, flatNeighbors, flatDistances);
+
+      CheckMatrices(flatNeighbors, neighbors);
+      CheckMatrices(flatDistances, distances);
+
+      // Monochromatic search should also map the indices correctly.
+      model.Search(3, neighbors, distances);
+      flatModel.Search(3, flatNeighbors, flatDistances);
+
+      CheckMatrices(flatNeighbors, neighbors);
+      CheckMatrices(flatDistances, distances);
+    }
+  }
+
+  // Trees that aren't BinarySpaceTrees can't be saved as flat images.
+  KNNModel coverTreeModel(KNNModel::TreeTypes::COVER_TREE);
+  arma::mat referenceCopy(referenceData);
+  coverTreeModel.BuildModel(std::move(referenceCopy), 5, DUAL_TREE_MODE);
+  BOOST_REQUIRE_THROW(coverTreeModel.SaveFlat("knn_flat_model.bin"),
+      std::invalid_argument);
+
+  remove("knn_flat_model.bin");
+}
+
+/**
+ * Make sure that search with a compacted tree gives the right results.
+ */
+BOOST_AUTO_TEST_CASE(KNNCompactTreeTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(5, 1000);
+
+  KNN naive(dataset, NAIVE_MODE);
+  KNN knn(dataset);
+  knn.ReferenceTree().Compact(KNN::Tree::VAN_EMDE_BOAS_ORDER);
+
+  arma::Mat<size_t> neighbors, naiveNeighbors;
+  arma::mat distances, naiveDistances;
+  naive.Search(5, naiveNeighbors, naiveDistances);
+
+  knn.Search(5, neighbors, distances);
+  CheckMatrices(neighbors, naiveNeighbors);
+  CheckMatrices(distances, naiveDistances);
+
+  knn.SearchMode() = SINGLE_TREE_MODE;
+  knn.Search(5, neighbors, distances);
+  CheckMatrices(neighbors, naiveNeighbors);
+  CheckMatrices(distances, naiveDistances);
+}
+
+/**
+ * Search a single-precision dataset with the given tree type, and make sure
+ * that the dual-tree and single-tree results are the same as the results of a
+ * naive search on the same data.
+ */
+template<template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void FloatSearchTest()
+{
+  typedef NeighborSearch<NearestNeighborSort, EuclideanDistance, arma::fmat,
+      TreeType> KNNType;
+
+  arma::fmat referenceData = arma::randu<arma::fmat>(4, 800);
+  arma::fmat queryData = arma::randu<arma::fmat>(4, 300);
+
+  KNNType naive(referenceData, NAIVE_MODE);
+  KNNType knn(referenceData);
+
+  arma::Mat<size_t> neighbors, naiveNeighbors;
+  arma::mat distances, naiveDistances;
+
+  naive.Search(queryData, 5, naiveNeighbors, naiveDistances);
+  knn.Search(queryData, 5, neighbors, distances);
+  CheckMatrices(neighbors, naiveNeighbors);
+  CheckMatrices(distances, naiveDistances);
+
+  naive.Search(5, naiveNeighbors, naiveDistances);
+  knn.Search(5, neighbors, distances);
+  CheckMatrices(neighbors, naiveNeighbors);
+  CheckMatrices(distances, naiveDistances);
+
+  knn.SearchMode() = SINGLE_TREE_MODE;
+  knn.Search(queryData, 5, neighbors, distances);
+  naive.Search(queryData, 5, naiveNeighbors, naiveDistances);
+  CheckMatrices(neighbors, naiveNeighbors);
+  CheckMatrices(distances, naiveDistances);
+}
+
+/**
+ * Make sure that kd-trees built on float data give exact results.
+ */
+BOOST_AUTO_TEST_CASE(KNNFloatKDTreeTest)
+{
+  FloatSearchTest<KDTree>();
+}
+
+/**
+ * Make sure that ball trees built on float data give exact results.
+ */
+BOOST_AUTO_TEST_CASE(KNNFloatBallTreeTest)
+{
+  FloatSearchTest<BallTree>();
+}
+
+/**
+ * Make sure that vantage point trees built on float data give exact results.
+ */
+BOOST_AUTO_TEST_CASE(KNNFloatVPTreeTest)
+{
+  FloatSearchTest<VPTree>();
+}
+
+/**
+ * Make sure that cover trees built on float data give exact results.
+ */
+BOOST_AUTO_TEST_CASE(KNNFloatCoverTreeTest)
+{
+  FloatSearchTest<StandardCoverTree>();
+}
+
+/**
+ * Make sure that R trees built on float data give exact results.
+ */
+BOOST_AUTO_TEST_CASE(KNNFloatRTreeTest)
+{
+  FloatSearchTest<RTree>();
+}
+
+/**
+ * Make sure that octrees built on float data give exact results.
+ */
+BOOST_AUTO_TEST_CASE(KNNFloatOctreeTest)
+{
+  FloatSearchTest<Octree>();
+}
+
+/**
+ * Split a reference set into chunk files, and make sure that ChunkedKNN gives
+ * the same results as a search on the whole reference set.  The chunks have
+ * different sizes, and one of them has fewer than k points.
+ */
+BOOST_AUTO_TEST_CASE(ChunkedKNNTest)
+{
+  arma::mat referenceData = arma::randu<arma::mat>(4, 1000);
+  arma::mat queryData = arma::randu<arma::mat>(4, 200);
+
+  const size_t chunkEnds[] = { 300, 303, 750, 1000 };
+  std::vector<std::string> chunkFiles;
+  size_t begin = 0;
+  for (size_t i = 0; i < 4; ++i)
+  {
+    std::ostringstream filename;
+    filename << "knn_chunk_" << i << ".bin";
+    chunkFiles.push_back(filename.str());
+
+    arma::mat chunk = referenceData.cols(begin, chunkEnds[i] - 1);
+    data::Save(filename.str(), chunk, true);
+    begin = chunkEnds[i];
+  }
+
+  KNN knn(referenceData);
+  arma::Mat<size_t> neighbors, chunkedNeighbors;
+  arma::mat distances, chunkedDistances;
+  knn.Search(queryData, 10, neighbors, distances);
+
+  ChunkedKNN chunkedKNN(chunkFiles);
+  chunkedKNN.Search(queryData, 10, chunkedNeighbors, chunkedDistances);
+  CheckMatrices(chunkedNeighbors, neighbors);
+  CheckMatrices(chunkedDistances, distances);
+
+  chunkedKNN.SearchMode() = SINGLE_TREE_MODE;
+  chunkedKNN.Search(queryData, 10, chunkedNeighbors, chunkedDistances);
+  CheckMatrices(chunkedNeighbors, neighbors);
+  CheckMatrices(chunkedDistances, distances);
+
+  // Asking for more neighbors than there are points is an error.
+  BOOST_REQUIRE_THROW(chunkedKNN.Search(queryData, 1001, chunkedNeighbors,
+      chunkedDistances), std::invalid_argument);
+
+  // So is a chunk that can't be loaded.
+  chunkFiles.push_back("knn_chunk_missing.bin");
+  ChunkedKNN missingKNN(chunkFiles);
+  BOOST_REQUIRE_THROW(missingKNN.Search(queryData, 10, chunkedNeighbors,
+      chunkedDistances), std::runtime_error);
+
+  for (size_t i = 0; i < 4; ++i)
+    remove(chunkFiles[i].c_str());
+}
+
+/**
+ * Make sure that ShardedKNN gives the same results as a search on the whole
+ * reference set, both when the shards are spatially separated (so that most
+ * shards are pruned) and when they are not.
+ */
+BOOST_AUTO_TEST_CASE(ShardedKNNTest)
+{
+  arma::mat referenceData = arma::randu<arma::mat>(3, 1000);
+  arma::mat queryData = arma::randu<arma::mat>(3, 200);
+
+  KNN knn(referenceData);
+  arma::Mat<size_t> neighbors, shardedNeighbors;
+  arma::mat distances, shardedDistances;
+
+  // Sort the points along the first dimension so that each shard covers a
+  // slab of the space.  The last shard is empty.
+  const arma::uvec order = arma::sort_index(referenceData.row(0).t());
+  referenceData = referenceData.cols(order);
+  knn.Train(referenceData);
+  knn.Search(queryData, 8, neighbors, distances);
+
+  const size_t shardEnds[] = { 250, 500, 503, 1000, 1000 };
+  std::vector<arma::mat> shards;
+  size_t begin = 0;
+  for (size_t i = 0; i < 5; ++i)
+  {
+    shards.push_back(referenceData.cols(begin, shardEnds[i] - 1));
+    begin = shardEnds[i];
+  }
+  shards[4].set_size(3, 0);
+
+  std::vector<size_t> sizes;
+  std::vector<ShardedKNN::BoundType> bounds;
+  for (size_t i = 0; i < 5; ++i)
+  {
+    sizes.push_back(shards[i].n_cols);
+    bounds.push_back(ShardedKNN::BoundType(3));
+    bounds.back() |= shards[i];
+  }
+
+  std::vector<std::vector<size_t>> routes;
+  ShardedKNN::RouteQueries(queryData, 8, bounds, sizes, routes);
+  size_t routed = 0;
+  for (size_t i = 0; i < 5; ++i)
+    routed += routes[i].size();
+  BOOST_REQUIRE(routes[4].empty());
+  BOOST_REQUIRE_LT(routed, 4 * queryData.n_cols);
+
+  ShardedKNN shardedKNN(std::move(shards));
+  BOOST_REQUIRE_EQUAL(shardedKNN.NumShards(), 5);
+  BOOST_REQUIRE_EQUAL(shardedKNN.NumPoints(), 1000);
+  BOOST_REQUIRE_EQUAL(shardedKNN.ShardOffset(3), 503);
+
+  shardedKNN.Search(queryData, 8, shardedNeighbors, shardedDistances);
+  CheckMatrices(shardedNeighbors, neighbors);
+  CheckMatrices(shardedDistances, distances);
+
+  // Now use shards that all cover the whole space.
+  const arma::uvec shuffled = arma::shuffle(
+      arma::linspace<arma::uvec>(0, 999, 1000));
+  referenceData = referenceData.cols(shuffled);
+  knn.Train(referenceData);
+  knn.Search(queryData, 8, neighbors, distances);
+
+  std::vector<arma::mat> randomShards;
+  randomShards.push_back(referenceData.cols(0, 399));
+  randomShards.push_back(referenceData.cols(400, 999));
+
+  ShardedKNN randomShardedKNN(std::move(randomShards), SINGLE_TREE_MODE);
+  randomShardedKNN.Search(queryData, 8, shardedNeighbors, shardedDistances);
+  CheckMatrices(shardedNeighbors, neighbors);
+  CheckMatrices(shardedDistances, distances);
+
+  BOOST_REQUIRE_THROW(randomShardedKNN.Search(queryData, 1001,
+      shardedNeighbors, shardedDistances), std::invalid_argument);
+}
+
+// These tests are only compiled if the user has specified OpenMP to be used.
+#ifdef HAS_OPENMP
+/**
+ * Run a dual-tree search with one thread and with all available threads, and
+ * make sure that the results are identical.
+ */
+template<template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void ParallelDualTreeSearchTest()
+{
+  typedef NeighborSearch<NearestNeighborSort, EuclideanDistance, arma::mat,
+      TreeType> KNNType;
+
+  arma::mat referenceData = arma::randu<arma::mat>(5, 2000);
+  arma::mat queryData = arma::randu<arma::mat>(5, 1500);
+
+  KNNType knn(referenceData);
+
+  // Make sure that we actually use more than one thread.
+  const size_t prevNumThreads = omp_get_max_threads();
+  omp_set_num_threads(std::max(prevNumThreads, (size_t) 4));
+
+  arma::Mat<size_t> parallelNeighbors, parallelMonoNeighbors;
+  arma::mat parallelDistances, parallelMonoDistances;
+  knn.Search(queryData, 10, parallelNeighbors, parallelDistances);
+  knn.Search(10, parallelMonoNeighbors, parallelMonoDistances);
+
+  omp_set_num_threads(1);
+
+  arma::Mat<size_t> neighbors, monoNeighbors;
+  arma::mat distances, monoDistances;
+  knn.Search(queryData, 10, neighbors, distances);
+  knn.Search(10, monoNeighbors, monoDistances);
+
+  omp_set_num_threads(prevNumThreads);
+
+  CheckMatrices(neighbors, parallelNeighbors);
+  CheckMatrices(distances, parallelDistances);
+  CheckMatrices(monoNeighbors, parallelMonoNeighbors);
+  CheckMatrices(monoDistances, parallelMonoDistances);
+}
+
+/**
+ * Make sure the parallel dual-tree search gives the same results as the serial
+ * search with kd-trees.
+ */
+BOOST_AUTO_TEST_CASE(ParallelDualTreeKDTreeTest)
+{
+  ParallelDualTreeSearchTest<KDTree>();
+}
+
+/**
+ * Make sure the parallel dual-tree search gives the same results as the serial
+ * search with ball trees.
+ */
+BOOST_AUTO_TEST_CASE(ParallelDualTreeBallTreeTest)
+{
+  ParallelDualTreeSearchTest<BallTree>();
+}
+
+/**
+ * Make sure the parallel dual-tree search gives the same results as the serial
+ * search with cover trees.
+ */
+BOOST_AUTO_TEST_CASE(ParallelDualTreeCoverTreeTest)
+{
+  ParallelDualTreeSearchTest<StandardCoverTree>();
+}
+
+/**
+ * Make sure the parallel dual-tree search gives the same results as the serial
+ * search with R trees.
+ */
+BOOST_AUTO_TEST_CASE(ParallelDualTreeRTreeTest)
+{
+  ParallelDualTreeSearchTest<RTree>();
+}
+/**
+ * Make sure that batched single-tree search gives the same results with one
+ * thread and with many threads, including when the same object is used for
+ * several searches (so the candidate lists are reused).
+ */
+BOOST_AUTO_TEST_CASE(ParallelSingleTreeSearchTest)
+{
+  arma::mat referenceData = arma::randu<arma::mat>(5, 2000);
+
+  KNN knn(referenceData, SINGLE_TREE_MODE);
+  KNN greedy(referenceData, GREEDY_SINGLE_TREE_MODE);
+
+  const size_t prevNumThreads = omp_get_max_threads();
+  for (size_t batch = 0; batch < 3; ++batch)
+  {
+    arma::mat queryData = arma::randu<arma::mat>(5, 1000 + 500 * batch);
+
+    omp_set_num_threads(std::max(prevNumThreads, (size_t) 4));
+
+    arma::Mat<size_t> parallelNeighbors, parallelGreedyNeighbors;
+    arma::mat parallelDistances, parallelGreedyDistances;
+    knn.Search(queryData, 5, parallelNeighbors, parallelDistances);
+    greedy.Search(queryData, 5, parallelGreedyNeighbors,
+        parallelGreedyDistances);
+
+    omp_set_num_threads(1);
+
+    arma::Mat<size_t> neighbors, greedyNeighbors;
+    arma::mat distances, greedyDistances;
+    knn.Search(queryData, 5, neighbors, distances);
+    greedy.Search(queryData, 5, greedyNeighbors, greedyDistances);
+
+    omp_set_num_threads(prevNumThreads);
+
+    CheckMatrices(neighbors, parallelNeighbors);
+    CheckMatrices(distances, parallelDistances);
+    CheckMatrices(greedyNeighbors, parallelGreedyNeighbors);
+    CheckMatrices(greedyDistances, parallelGreedyDistances);
+  }
+}
+
+/**
+ * Make sure that NUMA placement keeps the contents of the matrices it places,
+ * and doesn't change the results of parallel dual-tree and single-tree search.
+ * (On a machine with one node, nothing is placed, but the static schedule is
+ * still used.)
+ */
+BOOST_AUTO_TEST_CASE(NUMAPlacementKNNTest)
+{
+  arma::mat referenceData = arma::randu<arma::mat>(5, 20000);
+  arma::mat queryData = arma::randu<arma::mat>(5, 1500);
+
+  const size_t prevNumThreads = omp_get_max_threads();
+  omp_set_num_threads(std::max(prevNumThreads, (size_t) 4));
+
+  KNN knn(referenceData);
+  KNN singleKNN(referenceData, SINGLE_TREE_MODE);
+  arma::Mat<size_t> neighbors, singleNeighbors;
+  arma::mat distances, singleDistances;
+  knn.Search(queryData, 5, neighbors, distances);
+  singleKNN.Search(queryData, 5, singleNeighbors, singleDistances);
+
+  NUMA::Enable();
+
+  arma::mat placed(referenceData);
+  NUMA::FirstTouch(placed);
+  CheckMatrices(referenceData, placed);
+
+  KNN numaKNN(referenceData);
+  KNN numaSingleKNN(referenceData, SINGLE_TREE_MODE);
+  arma::Mat<size_t> numaNeighbors, numaSingleNeighbors;
+  arma::mat numaDistances, numaSingleDistances;
+  numaKNN.Search(queryData, 5, numaNeighbors, numaDistances);
+  numaSingleKNN.Search(queryData, 5, numaSingleNeighbors, numaSingleDistances);
+
+  NUMA::Enable(false);
+  omp_set_num_threads(prevNumThreads);
+
+  CheckMatrices(neighbors, numaNeighbors);
+  CheckMatrices(distances, numaDistances);
+  CheckMatrices(singleNeighbors, numaSingleNeighbors);
+  CheckMatrices(singleDistances, numaSingleDistances);
+}
+#endif
+
+/**
+ * Make sure that a wider beam improves the recall of greedy search, and that a
+ * backtracking budget large enough gives the exact neighbors, with kd-trees
+ * and with cover trees (whose Score() computes base cases).
+ */
+BOOST_AUTO_TEST_CASE(GreedyBeamSearchTest)
+{
+  arma::mat referenceData = arma::randu<arma::mat>(5, 2000);
+  arma::mat queryData = arma::randu<arma::mat>(5, 200);
+
+  KNN knn(referenceData);
+  arma::Mat<size_t> trueNeighbors;
+  arma::mat trueDistances;
+  knn.Search(queryData, 5, trueNeighbors, trueDistances);
+
+  KNN greedy(referenceData, GREEDY_SINGLE_TREE_MODE);
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  greedy.Search(queryData, 5, neighbors, distances);
+  const double greedyRecall = KNN::Recall(neighbors, trueNeighbors);
+
+  greedy.BeamWidth() = 8;
+  greedy.Search(queryData, 5, neighbors, distances);
+  const double beamRecall = KNN::Recall(neighbors, trueNeighbors);
+  BOOST_REQUIRE_GE(beamRecall, greedyRecall);
+  BOOST_REQUIRE_GT(beamRecall, 0.7);
+
+  greedy.BacktrackBudget() = 10 * referenceData.n_cols;
+  greedy.Search(queryData, 5, neighbors, distances);
+  CheckMatrices(neighbors, trueNeighbors);
+  CheckMatrices(distances, trueDistances);
+
+  // With a cover tree, each node holds a point.
+  NeighborSearch<NearestNeighborSort, EuclideanDistance, arma::mat,
+      StandardCoverTree> coverGreedy(referenceData, GREEDY_SINGLE_TREE_MODE);
+  coverGreedy.BeamWidth() = 4;
+  coverGreedy.BacktrackBudget() = 10 * referenceData.n_cols;
+  coverGreedy.Search(queryData, 5, neighbors, distances);
+  CheckMatrices(neighbors, trueNeighbors);
+  CheckMatrices(distances, trueDistances);
+}
+
+/**
+ * Make sure the traversal statistics match the counts of the search.
+ */
+BOOST_AUTO_TEST_CASE(KNNTraversalStatisticsTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(3, 500);
+  arma::mat queryData = arma::randu<arma::mat>(3, 200);
+
+  KNN knn(dataset);
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  knn.Search(queryData, 3, neighbors, distances);
+
+  const tree::TraversalStatistics& statistics = knn.Statistics();
+  BOOST_REQUIRE_EQUAL(statistics.BaseCases(), knn.BaseCases());
+  BOOST_REQUIRE_EQUAL(statistics.Scores(), knn.Scores());
+  BOOST_REQUIRE_GT(statistics.Prunes(), 0);
+  BOOST_REQUIRE_GE(statistics.TreeBuildingTime(), 0.0);
+  BOOST_REQUIRE_GE(statistics.TraversalTime(), 0.0);
+
+  // The statistics are reset by each search, and naive search doesn't prune.
+  KNN naive(dataset, NAIVE_MODE);
+  naive.Search(queryData, 3, neighbors, distances);
+  BOOST_REQUIRE_EQUAL(naive.Statistics().BaseCases(), (size_t) (500 * 200));
+  BOOST_REQUIRE_EQUAL(naive.Statistics().Prunes(), (size_t) 0);
+}
+
+/**
+ * Check the neighbors found by TransformedNeighborSearch against the
+ * neighbors found by brute force with the original metric.
+ */
+template<typename MetricType>
+void CheckTransformedKNN(MetricType& metric,
+                         const arma::mat& referenceSet,
+                         const arma::mat& querySet)
+{
+  const size_t k = 5;
+  TransformedNeighborSearch<NearestNeighborSort, MetricType> knn(referenceSet,
+      metric);
+
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  knn.Search(querySet, k, neighbors, distances);
+
+  BOOST_REQUIRE_EQUAL(neighbors.n_rows, k);
+  BOOST_REQUIRE_EQUAL(neighbors.n_cols, querySet.n_cols);
+  for (size_t q = 0; q < querySet.n_cols; ++q)
+  {
+    arma::vec trueDistances(referenceSet.n_cols);
+    for (size_t r = 0; r < referenceSet.n_cols; ++r)
+      trueDistances[r] = metric.Evaluate(querySet.col(q), referenceSet.col(r));
+    const arma::vec sorted = arma::sort(trueDistances);
+
+    for (size_t i = 0; i < k; ++i)
+    {
+      BOOST_REQUIRE_CLOSE(distances(i, q), sorted[i], 1e-5);
+      BOOST_REQUIRE_CLOSE(trueDistances[neighbors(i, q)], sorted[i], 1e-5);
+    }
+  }
+}
+
+/**
+ * Search with the Mahalanobis distance, with a full-rank and a low-rank
+ * matrix, and with the metric of the cosine distance, on transformed data.
+ */
+BOOST_AUTO_TEST_CASE(TransformedKNNTest)
+{
+  const arma::mat referenceSet = arma::randu<arma::mat>(4, 300);
+  const arma::mat querySet = arma::randu<arma::mat>(4, 50);
+
+  // A full-rank, positive definite matrix.
+  const arma::mat a = arma::randu<arma::mat>(4, 4);
+  MahalanobisDistance<> mahalanobis(a.t() * a + arma::eye<arma::mat>(4, 4));
+  CheckTransformedKNN(mahalanobis, referenceSet, querySet);
+
+  // A rank-2 matrix, like a matrix learned by NCA with fewer dimensions.
+  const arma::mat b = arma::randu<arma::mat>(2, 4);
+  MahalanobisDistance<> lowRank(b.t() * b);
+  CheckTransformedKNN(lowRank, referenceSet, querySet);
+
+  IPMetric<kernel::CosineDistance> cosine;
+  CheckTransformedKNN(cosine, referenceSet, querySet);
+}
+
+/**
+ * Check the blocked naive search against the dual-tree search, with several
+ * blocks of query and reference points.
+ */
+template<typename SortPolicy, typename MetricType>
+void CheckBlockedNaiveSearch(const arma::mat& referenceSet,
+                             const arma::mat& querySet,
+                             const size_t k)
+{
+  typedef NeighborSearch<SortPolicy, MetricType> SearchType;
+  SearchType tree(referenceSet);
+  SearchType naive(referenceSet, NAIVE_MODE);
+
+  arma::Mat<size_t> treeNeighbors, naiveNeighbors;
+  arma::mat treeDistances, naiveDistances;
+  tree.Search(querySet, k, treeNeighbors, treeDistances);
+  naive.Search(querySet, k, naiveNeighbors, naiveDistances);
+  BOOST_REQUIRE_EQUAL(naive.Statistics().BaseCases(),
+      querySet.n_cols * referenceSet.n_cols);
+  CheckMatrices(naiveNeighbors, treeNeighbors);
+  CheckMatrices(naiveDistances, treeDistances);
+
+  // Now the monochromatic search.
+  tree.Search(k, treeNeighbors, treeDistances);
+  naive.Search(k, naiveNeighbors, naiveDistances);
+  CheckMatrices(naiveNeighbors, treeNeighbors);
+  CheckMatrices(naiveDistances, treeDistances);
+}
+
+/**
+ * Make sure the naive search with the Euclidean distance, which computes
+ * blocks of distances with matrix products, gives exact results.
+ */
+BOOST_AUTO_TEST_CASE(BlockedNaiveSearchTest)
+{
+  const arma::mat referenceSet = arma::randu<arma::mat>(120, 700);
+  const arma::mat querySet = arma::randu<arma::mat>(120, 300);
+
+  CheckBlockedNaiveSearch<NearestNeighborSort, EuclideanDistance>(
+      referenceSet, querySet, 7);
+  CheckBlockedNaiveSearch<NearestNeighborSort, SquaredEuclideanDistance>(
+      referenceSet, querySet, 1);
+  CheckBlockedNaiveSearch<FurthestNeighborSort, EuclideanDistance>(
+      referenceSet, querySet, 5);
+
+  // Every point is a neighbor.
+  CheckBlockedNaiveSearch<NearestNeighborSort, EuclideanDistance>(
+      referenceSet.cols(0, 20), querySet, 20);
+}
+
+/**
+ * Make sure the HNSW graph finds most of the true neighbors, respects the
+ * maximum number of links, and survives serialization.
+ */
+BOOST_AUTO_TEST_CASE(HNSWSearchTest)
+{
+  const arma::mat referenceSet = arma::randu<arma::mat>(10, 2000);
+  const arma::mat querySet = arma::randu<arma::mat>(10, 200);
+
+  KNN knn(referenceSet);
+  arma::Mat<size_t> trueNeighbors;
+  arma::mat trueDistances;
+  knn.Search(querySet, 5, trueNeighbors, trueDistances);
+
+  HNSWSearch<> hnsw(referenceSet, 8, 100, 100);
+  BOOST_REQUIRE_EQUAL(hnsw.M(), 8);
+  BOOST_REQUIRE_EQUAL(hnsw.EfConstruction(), 100);
+
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  hnsw.Search(querySet, 5, neighbors, distances);
+  BOOST_REQUIRE_EQUAL(neighbors.n_rows, 5);
+  BOOST_REQUIRE_EQUAL(neighbors.n_cols, querySet.n_cols);
+  BOOST_REQUIRE_GE(KNN::Recall(neighbors, trueNeighbors), 0.9);
+
+  // The distances are right and sorted.
+  for (size_t i = 0; i < querySet.n_cols; ++i)
+  {
+    for (size_t j = 0; j < 5; ++j)
+    {
+      BOOST_REQUIRE_CLOSE(distances(j, i), EuclideanDistance::Evaluate(
+          querySet.col(i), referenceSet.col(neighbors(j, i))), 1e-5);
+      if (j > 0)
+        BOOST_REQUIRE_LE(distances(j - 1, i), distances(j, i));
+    }
+  }
+
+  // Every point has at most 2 * M links in the bottom layer and M links in
+  // the others.
+  for (size_t i = 0; i < referenceSet.n_cols; ++i)
+  {
+    BOOST_REQUIRE_LE(hnsw.Level(i), hnsw.MaxLevel());
+    BOOST_REQUIRE_LE(hnsw.Links(i, 0).size(), 16);
+    for (size_t l = 1; l <= hnsw.Level(i); ++l)
+      BOOST_REQUIRE_LE(hnsw.Links(i, l).size(), 8);
+  }
+
+  // The monochromatic search doesn't return the point itself.
+  hnsw.Search(5, neighbors, distances);
+  BOOST_REQUIRE_EQUAL(neighbors.n_cols, referenceSet.n_cols);
+  for (size_t i = 0; i < referenceSet.n_cols; ++i)
+    for (size_t j = 0; j < 5; ++j)
+      BOOST_REQUIRE_NE(neighbors(j, i), i);
+
+  // The serialized graph gives the same results.
+  hnsw.Search(querySet, 5, neighbors, distances);
+  HNSWSearch<> xmlHNSW, textHNSW, binaryHNSW;
+  SerializeObjectAll(hnsw, xmlHNSW, textHNSW, binaryHNSW);
+
+  arma::Mat<size_t> xmlNeighbors, textNeighbors, binaryNeighbors;
+  arma::mat xmlDistances, textDistances, binaryDistances;
+  xmlHNSW.Search(querySet, 5, xmlNeighbors, xmlDistances);
+  textHNSW.Search(querySet, 5, textNeighbors, textDistances);
+  binaryHNSW.Search(querySet, 5, binaryNeighbors, binaryDistances);
+  CheckMatrices(neighbors, xmlNeighbors, textNeighbors, binaryNeighbors);
+  CheckMatrices(distances, xmlDistances, textDistances, binaryDistances);
+
+  // k can't be larger than the reference set.
+  BOOST_REQUIRE_THROW(hnsw.Search(querySet, 2001, neighbors, distances),
+      std::invalid_argument);
+}
+
+/**
+ * Make sure product quantization finds the true neighbors when the candidates
+ * are re-ranked, with and without inverted lists, and survives serialization.
+ */
+BOOST_AUTO_TEST_CASE(PQSearchTest)
+{
+  const arma::mat referenceSet = arma::randu<arma::mat>(8, 2000);
+  const arma::mat querySet = arma::randu<arma::mat>(8, 100);
+
+  KNN knn(referenceSet);
+  arma::Mat<size_t> trueNeighbors;
+  arma::mat trueDistances;
+  knn.Search(querySet, 5, trueNeighbors, trueDistances);
+
+  PQSearch<> pq(referenceSet, 4, 64);
+  BOOST_REQUIRE_EQUAL(pq.Size(), referenceSet.n_cols);
+  BOOST_REQUIRE_EQUAL(pq.Dimensionality(), 8);
+  BOOST_REQUIRE_EQUAL(pq.ListCodes(0).size(), 4 * referenceSet.n_cols);
+
+  // The compressed distances only give approximate neighbors.
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  pq.Search(querySet, 5, neighbors, distances);
+  BOOST_REQUIRE_EQUAL(neighbors.n_rows, 5);
+  BOOST_REQUIRE_EQUAL(neighbors.n_cols, querySet.n_cols);
+  BOOST_REQUIRE_GE(KNN::Recall(neighbors, trueNeighbors), 0.5);
+  for (size_t i = 0; i < querySet.n_cols; ++i)
+    for (size_t j = 1; j < 5; ++j)
+      BOOST_REQUIRE_LE(distances(j - 1, i), distances(j, i));
+
+  // Re-ranking gives exact distances.
+  pq.Search(querySet, referenceSet, 5, 50, neighbors, distances);
+  BOOST_REQUIRE_GE(KNN::Recall(neighbors, trueNeighbors), 0.95);
+  for (size_t i = 0; i < querySet.n_cols; ++i)
+  {
+    for (size_t j = 0; j < 5; ++j)
+    {
+      BOOST_REQUIRE_CLOSE(distances(j, i), EuclideanDistance::Evaluate(
+          querySet.col(i), referenceSet.col(neighbors(j, i))), 1e-5);
+    }
+  }
+
+  // The same holds with inverted lists when all of them are probed.
+  PQSearch<> ivfpq(4, 64, 8, 8);
+  ivfpq.Train(referenceSet);
+  ivfpq.Add(referenceSet.cols(0, 999));
+  ivfpq.Add(referenceSet.cols(1000, 1999));
+  BOOST_REQUIRE_EQUAL(ivfpq.Size(), referenceSet.n_cols);
+  size_t listed = 0;
+  for (size_t l = 0; l < ivfpq.Lists(); ++l)
+    listed += ivfpq.ListIndices(l).size();
+  BOOST_REQUIRE_EQUAL(listed, referenceSet.n_cols);
+
+  ivfpq.Search(querySet, referenceSet, 5, 50, neighbors, distances);
+  BOOST_REQUIRE_GE(KNN::Recall(neighbors, trueNeighbors), 0.95);
+
+  // The serialized index gives the same results.
+  ivfpq.Probes() = 2;
+  ivfpq.Search(querySet, 5, neighbors, distances);
+  PQSearch<> xmlPQ, textPQ, binaryPQ;
+  SerializeObjectAll(ivfpq, xmlPQ, textPQ, binaryPQ);
+  BOOST_REQUIRE_EQUAL(binaryPQ.Probes(), 2);
+
+  arma::Mat<size_t> xmlNeighbors, textNeighbors, binaryNeighbors;
+  arma::mat xmlDistances, textDistances, binaryDistances;
+  xmlPQ.Search(querySet, 5, xmlNeighbors, xmlDistances);
+  textPQ.Search(querySet, 5, textNeighbors, textDistances);
+  binaryPQ.Search(querySet, 5, binaryNeighbors, binaryDistances);
+  CheckMatrices(neighbors, xmlNeighbors, textNeighbors, binaryNeighbors);
+  CheckMatrices(distances, xmlDistances, textDistances, binaryDistances);
+
+  // Invalid parameters are rejected.
+  BOOST_REQUIRE_THROW(PQSearch<>(4, 257), std::invalid_argument);
+  BOOST_REQUIRE_THROW(PQSearch<>(9).Train(referenceSet), std::invalid_argument);
+  BOOST_REQUIRE_THROW(pq.Search(querySet, referenceSet.cols(0, 99), 5, 50,
+      neighbors, distances), std::invalid_argument);
+}
+
+/**
+ * Make sure NN-Descent finds most of the true neighbors of each point, with and
+ * without random projection trees to seed the lists.
+ */
+BOOST_AUTO_TEST_CASE(NNDescentTest)
+{
+  const arma::mat dataset = arma::randu<arma::mat>(8, 2000);
+
+  KNN knn(dataset);
+  arma::Mat<size_t> trueNeighbors;
+  arma::mat trueDistances;
+  knn.Search(10, trueNeighbors, trueDistances);
+
+  for (size_t trees = 0; trees < 8; trees += 4)
+  {
+    NNDescent<> nnd(trees, 20, 20);
+
+    arma::Mat<size_t> neighbors;
+    arma::mat distances;
+    nnd.Search(dataset, 10, neighbors, distances);
+    BOOST_REQUIRE_EQUAL(neighbors.n_rows, 10);
+    BOOST_REQUIRE_EQUAL(neighbors.n_cols, dataset.n_cols);
+    BOOST_REQUIRE_EQUAL(distances.n_rows, 10);
+    BOOST_REQUIRE_EQUAL(distances.n_cols, dataset.n_cols);
+    BOOST_REQUIRE_GE(nnd.Iterations(), 1);
+    BOOST_REQUIRE_LE(nnd.Iterations(), 20);
+    BOOST_REQUIRE_GE(KNN::Recall(neighbors, trueNeighbors), 0.9);
+
+    // The distances are right and sorted, and no point is its own neighbor.
+    for (size_t i = 0; i < dataset.n_cols; ++i)
+    {
+      for (size_t j = 0; j < 10; ++j)
+      {
+        BOOST_REQUIRE_NE(neighbors(j, i), i);
+        BOOST_REQUIRE_CLOSE(distances(j, i), EuclideanDistance::Evaluate(
+            dataset.col(i), dataset.col(neighbors(j, i))), 1e-5);
+        if (j > 0)
+          BOOST_REQUIRE_LE(distances(j - 1, i), distances(j, i));
+      }
+    }
+  }
+
+  // With k = N - 1, every other point is a neighbor.
+  NNDescent<> nnd;
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  nnd.Search(dataset.cols(0, 5), 5, neighbors, distances);
+  for (size_t i = 0; i < 6; ++i)
+  {
+    const arma::Col<size_t> sorted = arma::sort(neighbors.col(i));
+    for (size_t j = 0; j < 5; ++j)
+      BOOST_REQUIRE_EQUAL(sorted[j], (j < i) ? j : j + 1);
+  }
+
+  // k must be less than the number of points.
+  BOOST_REQUIRE_THROW(nnd.Search(dataset.cols(0, 5), 6, neighbors, distances),
+      std::invalid_argument);
+  BOOST_REQUIRE_THROW(NNDescent<>(4, 20, 10, 0.001, 0.0),
+      std::invalid_argument);
+}
+
+/**
+ * Make sure the inverted index finds the same neighbors as a brute-force
+ * search on sparse data, with the inner product and the cosine similarity.
+ */
+BOOST_AUTO_TEST_CASE(InvertedIndexSearchTest)
+{
+  const arma::sp_mat referenceSet = arma::sprandu<arma::sp_mat>(1000, 500,
+      0.02);
+  const arma::sp_mat querySet = arma::sprandu<arma::sp_mat>(1000, 50, 0.02);
+
+  for (size_t cosine = 0; cosine < 2; ++cosine)
+  {
+    InvertedIndexSearch index(referenceSet, cosine == 1);
+    BOOST_REQUIRE_EQUAL(index.Size(), 500);
+    BOOST_REQUIRE_EQUAL(index.Dimensionality(), 1000);
+
+    arma::Mat<size_t> neighbors;
+    arma::mat similarities;
+    index.Search(querySet, 10, neighbors, similarities);
+    BOOST_REQUIRE_EQUAL(neighbors.n_rows, 10);
+    BOOST_REQUIRE_EQUAL(neighbors.n_cols, querySet.n_cols);
+
+    // Compute all the similarities by brute force.
+    arma::mat exact(querySet.t() * referenceSet);
+    if (cosine == 1)
+    {
+      for (size_t i = 0; i < exact.n_rows; ++i)
+      {
+        for (size_t j = 0; j < exact.n_cols; ++j)
+        {
+          if (exact(i, j) != 0.0)
+            exact(i, j) /= arma::norm(querySet.col(i)) *
+                arma::norm(referenceSet.col(j));
+        }
+      }
+    }
+
+    for (size_t i = 0; i < querySet.n_cols; ++i)
+    {
+      // Only the points with a common feature are candidates.
+      const arma::vec best = arma::sort(arma::nonzeros(exact.row(i)),
+          "descend");
+      for (size_t j = 0; j < 10; ++j)
+      {
+        if (j >= best.n_elem)
+        {
+          BOOST_REQUIRE_EQUAL(neighbors(j, i), size_t() - 1);
+          BOOST_REQUIRE_EQUAL(similarities(j, i), -DBL_MAX);
+          continue;
+        }
+
+        BOOST_REQUIRE_CLOSE(similarities(j, i), best[j], 1e-5);
+        BOOST_REQUIRE_CLOSE(exact(i, neighbors(j, i)), best[j], 1e-5);
+      }
+    }
+  }
+
+  // The serialized index gives the same results.
+  InvertedIndexSearch index(referenceSet, true);
+  arma::Mat<size_t> neighbors;
+  arma::mat similarities;
+  index.Search(querySet, 5, neighbors, similarities);
+
+  InvertedIndexSearch xmlIndex, textIndex, binaryIndex;
+  SerializeObjectAll(index, xmlIndex, textIndex, binaryIndex);
+  BOOST_REQUIRE_EQUAL(binaryIndex.Cosine(), true);
+
+  arma::Mat<size_t> xmlNeighbors, textNeighbors, binaryNeighbors;
+  arma::mat xmlSimilarities, textSimilarities, binarySimilarities;
+  xmlIndex.Search(querySet, 5, xmlNeighbors, xmlSimilarities);
+  textIndex.Search(querySet, 5, textNeighbors, textSimilarities);
+  binaryIndex.Search(querySet, 5, binaryNeighbors, binarySimilarities);
+  CheckMatrices(neighbors, xmlNeighbors, textNeighbors, binaryNeighbors);
+  CheckMatrices(similarities, xmlSimilarities, textSimilarities,
+      binarySimilarities);
+
+  // Invalid parameters are rejected.
+  BOOST_REQUIRE_THROW(index.Search(querySet, 501, neighbors, similarities),
+      std::invalid_argument);
+  BOOST_REQUIRE_THROW(index.Search(arma::sp_mat(999, 5), 5, neighbors,
+      similarities), std::invalid_argument);
+}
+
+/**
+ * Make sure that NeighborSearchRules can't be copied, and that rules built with
+ * the ShareCandidates constructor write into the candidate lists of the rules
+ * they were built from.
+ */
+BOOST_AUTO_TEST_CASE(NeighborSearchRulesShareCandidatesTest)
+{
+  typedef KDTree<EuclideanDistance, NeighborSearchStat<NearestNeighborSort>,
+      arma::mat> TreeType;
+  typedef NeighborSearchRules<NearestNeighborSort, EuclideanDistance, TreeType>
+      RuleType;
+  static_assert(!std::is_copy_constructible<RuleType>::value,
+      "NeighborSearchRules must not be copy constructible.");
+
+  arma::mat dataset("0.0 1.0 3.0");
+  EuclideanDistance metric;
+  std::vector<RuleType::CandidateList> storage;
+  RuleType rules(dataset, dataset, 1, metric, storage, 0, true);
+  {
+    RuleType threadRules(rules, RuleType::ShareCandidates());
+    threadRules.BaseCase(0, 1);
+    threadRules.BaseCase(2, 1);
+    BOOST_REQUIRE_EQUAL(threadRules.BaseCases(), 2);
+  }
+  BOOST_REQUIRE_EQUAL(rules.BaseCases(), 0);
+
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  rules.GetResults(neighbors, distances);
+  BOOST_REQUIRE_EQUAL(neighbors(0, 0), 1);
+  BOOST_REQUIRE_CLOSE(distances(0, 0), 1.0, 1e-5);
+  BOOST_REQUIRE_EQUAL(neighbors(0, 2), 1);
+  BOOST_REQUIRE_CLOSE(distances(0, 2), 2.0, 1e-5);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
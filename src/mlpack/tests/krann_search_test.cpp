@@ -715,4 +715,80 @@ BOOST_AUTO_TEST_CASE(RAModelTest)
   }
 }
 
+/**
+ * Make sure that parallel single-tree search gives the same results every time
+ * for a given seed and number of threads.
+ */
+BOOST_AUTO_TEST_CASE(ParallelSingleTreeReproducibilityTest)
+{
+  arma::mat refData = arma::randu<arma::mat>(3, 2000);
+  arma::mat queryData = arma::randu<arma::mat>(3, 500);
+
+  RASearch<> rann(refData, false, true, 5.0, 0.95, false, false);
+  rann.NumThreads() = 4;
+
+  arma::Mat<size_t> neighbors, otherNeighbors;
+  arma::mat distances, otherDistances;
+
+  math::RandomSeed(42);
+  rann.Search(queryData, 3, neighbors, distances);
+  math::RandomSeed(42);
+  rann.Search(queryData, 3, otherNeighbors, otherDistances);
+
+  CheckMatrices(neighbors, otherNeighbors);
+  CheckMatrices(distances, otherDistances);
+}
+
+/**
+ * Make sure that the rank-approximation guarantee holds for parallel
+ * single-tree search.
+ */
+BOOST_AUTO_TEST_CASE(ParallelSingleTreeSearch)
+{
+  arma::mat refData;
+  arma::mat queryData;
+
+  data::Load("rann_test_r_3_900.csv", refData, true);
+  data::Load("rann_test_q_3_100.csv", queryData, true);
+
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+
+  RASearch<> tssRann(refData, false, true, 1.0, 0.95, false, false);
+  tssRann.NumThreads() = 4;
+
+  // The relative ranks for the given query reference pair.
+  arma::Mat<size_t> qrRanks;
+  data::Load("rann_test_qr_ranks.csv", qrRanks, true, false); // No transpose.
+
+  size_t numRounds = 1000;
+  arma::Col<size_t> numSuccessRounds(queryData.n_cols);
+  numSuccessRounds.fill(0);
+
+  // 1% of 900 is 9, so the rank is expected to be less than 10.
+  size_t expectedRankErrorUB = 10;
+
+  for (size_t rounds = 0; rounds < numRounds; rounds++)
+  {
+    tssRann.Search(queryData, 1, neighbors, distances);
+
+    for (size_t i = 0; i < queryData.n_cols; i++)
+      if (qrRanks(i, neighbors(0, i)) < expectedRankErrorUB)
+        numSuccessRounds[i]++;
+  }
+
+  // Find the 95%-tile threshold so that 95% of the queries should pass this
+  // threshold.
+  size_t threshold = floor(numRounds *
+      (0.95 - (1.96 * sqrt(0.95 * 0.05 / numRounds))));
+  size_t numQueriesFail = 0;
+  for (size_t i = 0; i < queryData.n_cols; i++)
+    if (numSuccessRounds[i] < threshold)
+      numQueriesFail++;
+
+  // Assert that at most 5% of the queries fall out of this threshold.
+  size_t maxNumQueriesFail = 6;
+  BOOST_REQUIRE_LT(numQueriesFail, maxNumQueriesFail);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -13,6 +13,7 @@
 // Note: We don't use BOOST_REQUIRE_CLOSE in the code below because we need
 // to use FPC_WEAK, and it's not at all intuitive how to do that.
 #include <mlpack/methods/lars/lars.hpp>
+#include <mlpack/methods/lars/lars_solver.hpp>
 #include <mlpack/core/data/load.hpp>
 
 #include <boost/test/unit_test.hpp>
@@ -352,4 +353,124 @@ BOOST_AUTO_TEST_CASE(TrainingConstructorWithNonDefaultsTest)
     BOOST_REQUIRE_CLOSE(beta[i], lars2.Beta()[i], 1e-5);
 }
 
+/**
+ * Make sure the LARSSolver finds the same solutions as LARS with Cholesky
+ * decomposition, for a batch of responses sharing one Gram matrix, with the
+ * LASSO and the elastic net.
+ */
+void LARSSolverTest(const bool elasticNet)
+{
+  const size_t nPoints = 100;
+  const size_t nDims = 10;
+
+  arma::mat X = arma::randn(nDims, nPoints);
+  arma::mat responses = arma::randn(nPoints, 20);
+
+  // The LARSSolver takes row-major data, like LARS with transposeData = false.
+  arma::mat rowMajorX = trans(X);
+  arma::mat gram = trans(rowMajorX) * rowMajorX;
+
+  const double lambda1 = 0.1 * arma::max(arma::max(arma::abs(X * responses)));
+  const double lambda2 = elasticNet ? lambda1 / 2 : 0.0;
+
+  LARSSolver solver(gram, lambda1, lambda2);
+  arma::mat betas;
+  solver.Solve(rowMajorX, responses, betas);
+
+  BOOST_REQUIRE_EQUAL(betas.n_rows, nDims);
+  BOOST_REQUIRE_EQUAL(betas.n_cols, responses.n_cols);
+
+  for (size_t i = 0; i < responses.n_cols; ++i)
+  {
+    LARS lars(true, gram, lambda1, lambda2);
+    arma::vec beta;
+    lars.Train(rowMajorX, arma::rowvec(trans(responses.col(i))), beta, false);
+
+    for (size_t j = 0; j < nDims; ++j)
+    {
+      if (std::abs(beta[j]) < 1e-10)
+        BOOST_REQUIRE_SMALL(betas(j, i), 1e-10);
+      else
+        BOOST_REQUIRE_CLOSE(betas(j, i), beta[j], 1e-6);
+    }
+
+    arma::vec errCorr = (X * trans(X) + lambda2 *
+        arma::eye(nDims, nDims)) * betas.col(i) - X * responses.col(i);
+    LARSVerifyCorrectness(betas.col(i), errCorr, lambda1);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(LARSSolverLassoTest)
+{
+  LARSSolverTest(false);
+}
+
+BOOST_AUTO_TEST_CASE(LARSSolverElasticNetTest)
+{
+  LARSSolverTest(true);
+}
+
+/**
+ * Make sure that solving with scales gives the solution for the scaled data.
+ */
+BOOST_AUTO_TEST_CASE(LARSSolverScalesTest)
+{
+  arma::mat X = arma::randn(100, 10);
+  arma::vec y = arma::randn(100);
+  arma::vec scales = arma::randu(10) + 0.5;
+
+  arma::mat gram = trans(X) * X;
+  arma::mat scaledX = X * arma::diagmat(scales);
+  arma::mat scaledGram = trans(scaledX) * scaledX;
+  arma::vec correlations = trans(scaledX) * y;
+
+  const double lambda1 = 0.1 * arma::max(arma::abs(correlations));
+
+  LARSSolver solver(gram, lambda1);
+  arma::vec beta;
+  solver.Solve(correlations, scales, beta);
+
+  LARSSolver scaledSolver(scaledGram, lambda1);
+  arma::vec scaledBeta;
+  scaledSolver.Solve(correlations, scaledBeta);
+
+  BOOST_REQUIRE_EQUAL(beta.n_elem, 10);
+  for (size_t j = 0; j < 10; ++j)
+  {
+    if (std::abs(scaledBeta[j]) < 1e-10)
+      BOOST_REQUIRE_SMALL(beta[j], 1e-10);
+    else
+      BOOST_REQUIRE_CLOSE(beta[j], scaledBeta[j], 1e-6);
+  }
+}
+
+/**
+ * Make sure the LARSSolver doesn't crash when the data has linearly dependent
+ * features (see CholeskySingularityTest).
+ */
+BOOST_AUTO_TEST_CASE(LARSSolverSingularityTest)
+{
+  arma::mat X;
+  arma::mat Y;
+
+  data::Load("lars_dependent_x.csv", X);
+  data::Load("lars_dependent_y.csv", Y);
+
+  arma::rowvec y = Y.row(0);
+  arma::mat gram = X * X.t();
+  arma::vec correlations = X * y.t();
+
+  // Test for a couple values of lambda1.
+  for (double lambda1 = 0.0; lambda1 < 1.0; lambda1 += 0.1)
+  {
+    LARSSolver solver(gram, lambda1, 0.0);
+    arma::vec betaOpt;
+    solver.Solve(correlations, betaOpt);
+
+    arma::vec errCorr = (X * X.t()) * betaOpt - X * y.t();
+
+    LARSVerifyCorrectness(betaOpt, errCorr, lambda1);
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -13,12 +13,14 @@
 #include <mlpack/core.hpp>
 #include <mlpack/core/optimizers/lbfgs/lbfgs.hpp>
 #include <mlpack/core/optimizers/lbfgs/test_functions.hpp>
+#include <mlpack/methods/logistic_regression/logistic_regression_function.hpp>
 
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
 
 using namespace mlpack::optimization;
 using namespace mlpack::optimization::test;
+using namespace mlpack::regression;
 
 BOOST_AUTO_TEST_SUITE(LBFGSTest);
 
@@ -117,4 +119,54 @@ BOOST_AUTO_TEST_CASE(RosenbrockWoodFunctionTest)
   }
 }
 
+/**
+ * Make sure the objective and gradient of a separable function reduced over
+ * blocks of points are the same as the ones computed over the whole dataset.
+ */
+BOOST_AUTO_TEST_CASE(ParallelEvaluateGradientTest)
+{
+  arma::mat data = arma::randu<arma::mat>(5, 1003);
+  arma::Row<size_t> responses(1003);
+  for (size_t i = 0; i < responses.n_elem; ++i)
+    responses[i] = (data(1, i) > 0.4) ? 1 : 0;
+
+  LogisticRegressionFunction<> lrf(data, responses, 0.5);
+  const arma::mat parameters = arma::randu<arma::vec>(6);
+
+  BOOST_REQUIRE(HasConstBatchEvaluate<LogisticRegressionFunction<>>::value);
+  BOOST_REQUIRE(HasConstBatchGradient<LogisticRegressionFunction<>>::value);
+  BOOST_REQUIRE(!HasConstBatchEvaluate<RosenbrockFunction>::value);
+
+  BOOST_REQUIRE_CLOSE(ParallelEvaluate(lrf, parameters),
+      lrf.Evaluate(parameters), 1e-8);
+
+  arma::mat gradient, parallelGradient;
+  std::vector<arma::mat> blockGradients;
+  lrf.Gradient(parameters, gradient);
+  ParallelGradient(lrf, parameters, parallelGradient, blockGradients);
+  CheckMatrices(parallelGradient, gradient, 1e-8);
+}
+
+/**
+ * Optimize a logistic regression objective, whose evaluations are split over
+ * the threads, and make sure the gradient at the result is small.
+ */
+BOOST_AUTO_TEST_CASE(LogisticRegressionFunctionTest)
+{
+  arma::mat data = arma::randn<arma::mat>(5, 1000);
+  arma::Row<size_t> responses(1000);
+  for (size_t i = 0; i < responses.n_elem; ++i)
+    responses[i] = (data(1, i) + 0.3 * data(2, i) > 0.1) ? 1 : 0;
+
+  LogisticRegressionFunction<> lrf(data, responses, 1.0);
+  L_BFGS<LogisticRegressionFunction<>> lbfgs(lrf);
+
+  arma::mat coords = lrf.GetInitialPoint();
+  lbfgs.Optimize(coords);
+
+  arma::mat gradient;
+  lrf.Gradient(coords, gradient);
+  BOOST_REQUIRE_SMALL(arma::norm(gradient, 2), 1e-3);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
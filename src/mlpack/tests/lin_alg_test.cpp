@@ -78,6 +78,42 @@ BOOST_AUTO_TEST_CASE(TestCenterB)
       BOOST_REQUIRE_CLOSE(tmp_out(row, col), (double) (col - 2.5) * row, 1e-5);
 }
 
+/**
+ * Make sure the blocked mean, the in-place centering and the blocked
+ * covariance match Armadillo, on enough columns for several blocks.
+ */
+BOOST_AUTO_TEST_CASE(TestBlockedCenterCovariance)
+{
+  arma::mat x = arma::randu<arma::mat>(7, 3001) + 100.0;
+
+  arma::vec mean;
+  RowMean(x, mean);
+  const arma::vec expectedMean = arma::mean(x, 1);
+  for (size_t i = 0; i < mean.n_elem; ++i)
+    BOOST_REQUIRE_CLOSE(mean[i], expectedMean[i], 1e-8);
+
+  arma::mat covariance;
+  Covariance(x, covariance);
+  const arma::mat expectedCovariance = arma::cov(x.t());
+  BOOST_REQUIRE_EQUAL(covariance.n_rows, 7);
+  BOOST_REQUIRE_EQUAL(covariance.n_cols, 7);
+  for (size_t i = 0; i < covariance.n_elem; ++i)
+    BOOST_REQUIRE_CLOSE(covariance[i], expectedCovariance[i], 1e-6);
+
+  arma::mat centered;
+  Center(x, centered);
+  arma::vec centeredMean;
+  CenterInPlace(x, centeredMean);
+  CheckMatrices(x, centered);
+  for (size_t i = 0; i < mean.n_elem; ++i)
+    BOOST_REQUIRE_CLOSE(centeredMean[i], expectedMean[i], 1e-8);
+
+  arma::vec zeroMean;
+  RowMean(x, zeroMean);
+  for (size_t i = 0; i < zeroMean.n_elem; ++i)
+    BOOST_REQUIRE_SMALL(zeroMean[i], 1e-10);
+}
+
 BOOST_AUTO_TEST_CASE(TestWhitenUsingEig)
 {
   // After whitening using eigendecomposition, the covariance of
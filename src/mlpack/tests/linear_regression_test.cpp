@@ -199,4 +199,104 @@ BOOST_AUTO_TEST_CASE(LinearRegressionTrainTest)
     BOOST_REQUIRE_CLOSE(lr.Parameters()[i], lrTrain.Parameters()[i], 1e-5);
 }
 
+/**
+ * Make sure that the normal equations give the same model as Train(), with and
+ * without ridge regularization and an intercept term, on data far from the
+ * origin and large enough to be split into several chunks.
+ */
+BOOST_AUTO_TEST_CASE(NormalEquationsTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(6, 10000) + 10.0;
+  arma::vec coeffs = arma::randu<arma::vec>(6) + 1.0;
+  arma::rowvec responses = coeffs.t() * dataset + 3.0 +
+      0.1 * arma::randn<arma::rowvec>(10000);
+
+  for (size_t i = 0; i < 4; ++i)
+  {
+    const double lambda = (i % 2 == 0) ? 0.0 : 0.5;
+    const bool intercept = (i < 2);
+
+    LinearRegression lr(dataset, responses, lambda, intercept);
+
+    NormalEquations equations(intercept);
+    equations.Update(dataset, responses);
+    LinearRegression lrNormal(equations, lambda);
+
+    BOOST_REQUIRE_EQUAL(equations.Count(), 10000);
+    BOOST_REQUIRE_EQUAL(lrNormal.Intercept(), intercept);
+    BOOST_REQUIRE_EQUAL(lr.Parameters().n_elem, lrNormal.Parameters().n_elem);
+    for (size_t j = 0; j < lr.Parameters().n_elem; ++j)
+      BOOST_REQUIRE_CLOSE(lr.Parameters()[j], lrNormal.Parameters()[j], 1e-3);
+  }
+}
+
+/**
+ * Make sure that weighted normal equations give the same model as Train() with
+ * weights, and that points with zero weight are ignored.
+ */
+BOOST_AUTO_TEST_CASE(NormalEquationsWeightedTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(4, 5000);
+  arma::rowvec responses = arma::randu<arma::rowvec>(5000);
+  arma::rowvec weights = arma::randu<arma::rowvec>(5000);
+  weights.subvec(0, 99).zeros();
+
+  LinearRegression lr(dataset, responses, weights, 0.1);
+
+  NormalEquations equations;
+  equations.Update(dataset, responses, weights);
+  LinearRegression lrNormal(equations, 0.1);
+
+  BOOST_REQUIRE_CLOSE(equations.TotalWeight(), arma::accu(weights), 1e-8);
+  BOOST_REQUIRE_EQUAL(lr.Parameters().n_elem, lrNormal.Parameters().n_elem);
+  for (size_t i = 0; i < lr.Parameters().n_elem; ++i)
+    BOOST_REQUIRE_CLOSE(lr.Parameters()[i], lrNormal.Parameters()[i], 1e-3);
+}
+
+/**
+ * Make sure that accumulating the normal equations block by block, or merging
+ * the normal equations of parts of the dataset, gives the same statistics as
+ * accumulating the whole dataset at once.
+ */
+BOOST_AUTO_TEST_CASE(NormalEquationsMergeTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(5, 3000);
+  arma::rowvec responses = arma::randu<arma::rowvec>(3000);
+
+  NormalEquations all;
+  all.Update(dataset, responses);
+
+  NormalEquations blocks, first, second;
+  for (size_t i = 0; i < 3000; i += 700)
+  {
+    const size_t end = std::min((size_t) 3000, i + 700) - 1;
+    blocks.Update(dataset.cols(i, end), responses.subvec(i, end));
+  }
+  first.Update(dataset.cols(0, 1234), responses.subvec(0, 1234));
+  second.Update(dataset.cols(1235, 2999), responses.subvec(1235, 2999));
+  first.Merge(second);
+
+  const NormalEquations* others[] = { &blocks, &first };
+  for (size_t k = 0; k < 2; ++k)
+  {
+    const NormalEquations& other = *others[k];
+    BOOST_REQUIRE_EQUAL(other.Count(), 3000);
+    BOOST_REQUIRE_CLOSE(other.ResponseMean(), all.ResponseMean(), 1e-8);
+    for (size_t i = 0; i < all.Mean().n_elem; ++i)
+    {
+      BOOST_REQUIRE_CLOSE(other.Mean()[i], all.Mean()[i], 1e-8);
+      BOOST_REQUIRE_CLOSE(other.ResponseScatter()[i],
+          all.ResponseScatter()[i], 1e-6);
+    }
+    for (size_t i = 0; i < all.Scatter().n_elem; ++i)
+      BOOST_REQUIRE_CLOSE(other.Scatter()[i], all.Scatter()[i], 1e-6);
+  }
+
+  // Points of another dimensionality can't be added.
+  BOOST_REQUIRE_THROW(all.Update(arma::randu<arma::mat>(4, 10),
+      arma::randu<arma::rowvec>(10)), std::invalid_argument);
+  BOOST_REQUIRE_THROW(all.Merge(NormalEquations(false)),
+      std::invalid_argument);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
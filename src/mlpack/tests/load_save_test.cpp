@@ -9,10 +9,15 @@
  * 3-clause BSD license along with mlpack.  If not, see
  * http://www.opensource.org/licenses/BSD-3-Clause for more information.
  */
+#include <iomanip>
 #include <sstream>
 
 #include <mlpack/core.hpp>
 #include <mlpack/core/data/load_arff.hpp>
+#include <mlpack/core/data/arff_parser.hpp>
+#include <mlpack/core/data/data_loader.hpp>
+#include <mlpack/core/data/csv_parser.hpp>
+#include <mlpack/core/data/chunked_reader.hpp>
 
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
@@ -50,6 +55,38 @@ BOOST_AUTO_TEST_CASE(NotExistLoad)
   BOOST_REQUIRE(data::Load("nonexistentfile_______________.csv", out) == false);
 }
 
+/**
+ * Make sure a sparse matrix is loaded correctly from a coordinate list, with
+ * one point per row of the file.
+ */
+BOOST_AUTO_TEST_CASE(LoadSparseCoordinateListTest)
+{
+  fstream f;
+  f.open("test_sparse_file.coo", fstream::out);
+
+  f << "0 1 2.5" << endl;
+  f << "2 0 -1" << endl;
+  f << "3 3 4" << endl;
+
+  f.close();
+
+  arma::sp_mat test;
+  BOOST_REQUIRE(data::Load("test_sparse_file.coo", test) == true);
+
+  BOOST_REQUIRE_EQUAL(test.n_rows, 4);
+  BOOST_REQUIRE_EQUAL(test.n_cols, 4);
+  BOOST_REQUIRE_EQUAL(test.n_nonzero, 3);
+  BOOST_REQUIRE_CLOSE(test(1, 0), 2.5, 1e-5);
+  BOOST_REQUIRE_CLOSE(test(0, 2), -1.0, 1e-5);
+  BOOST_REQUIRE_CLOSE(test(3, 3), 4.0, 1e-5);
+
+  // An unknown extension fails.
+  BOOST_REQUIRE(data::Load("test_sparse_file.csv", test) == false);
+
+  // Remove the file.
+  remove("test_sparse_file.coo");
+}
+
 /**
  * Make sure a CSV is loaded correctly.
  */
@@ -770,6 +807,36 @@ BOOST_AUTO_TEST_CASE(SaveHDF5Test)
   remove("test_file.hdf5");
   remove("test_file.he5");
 }
+
+/**
+ * Make sure an HDF5 dataset loads untransposed, including one that is read in
+ * several blocks.
+ */
+BOOST_AUTO_TEST_CASE(LoadHDF5NoTransposeTest)
+{
+  arma::mat test = "1 5;"
+                   "2 6;"
+                   "3 7;"
+                   "4 8;";
+  BOOST_REQUIRE(data::Save("test_file.h5", test) == true);
+
+  arma::mat loaded;
+  BOOST_REQUIRE(data::Load("test_file.h5", loaded, true, false) == true);
+
+  BOOST_REQUIRE_EQUAL(loaded.n_rows, 2);
+  BOOST_REQUIRE_EQUAL(loaded.n_cols, 4);
+  BOOST_REQUIRE_EQUAL(arma::accu(loaded != test.t()), 0);
+
+  arma::mat large(3, 500000, arma::fill::randu);
+  BOOST_REQUIRE(data::Save("test_file.h5", large) == true);
+  BOOST_REQUIRE(data::Load("test_file.h5", loaded, true, false) == true);
+
+  BOOST_REQUIRE_EQUAL(loaded.n_rows, 500000);
+  BOOST_REQUIRE_EQUAL(loaded.n_cols, 3);
+  BOOST_REQUIRE_EQUAL(arma::accu(loaded != large.t()), 0);
+
+  remove("test_file.h5");
+}
 #else
 /**
  * Ensure saving as HDF5 fails.
@@ -948,6 +1015,72 @@ BOOST_AUTO_TEST_CASE(LoadTextTest)
   BOOST_REQUIRE_EQUAL(y.inb.s, x.inb.s);
 }
 
+/**
+ * Make sure we can load and save with the native archive.
+ */
+BOOST_AUTO_TEST_CASE(LoadNativeTest)
+{
+  Test x(10, 12);
+
+  BOOST_REQUIRE_EQUAL(data::Save("test.mlb", "x", x, false), true);
+
+  // Now reload.
+  Test y(11, 14);
+
+  BOOST_REQUIRE_EQUAL(data::Load("test.mlb", "x", y, false), true);
+
+  BOOST_REQUIRE_EQUAL(y.x, x.x);
+  BOOST_REQUIRE_EQUAL(y.y, x.y);
+  BOOST_REQUIRE_EQUAL(y.ina.c, x.ina.c);
+  BOOST_REQUIRE_EQUAL(y.ina.s, x.ina.s);
+  BOOST_REQUIRE_EQUAL(y.inb.c, x.inb.c);
+  BOOST_REQUIRE_EQUAL(y.inb.s, x.inb.s);
+
+  remove("test.mlb");
+}
+
+/**
+ * Make sure the matrices of a model saved with the native archive are read
+ * back exactly, and that their elements are aligned in the file.
+ */
+BOOST_AUTO_TEST_CASE(NativeArchiveMatrixTest)
+{
+  arma::mat m = arma::randu<arma::mat>(7, 1000);
+  distribution::GaussianDistribution d(arma::randu<arma::vec>(7),
+      m * m.t() / m.n_cols);
+
+  BOOST_REQUIRE_EQUAL(data::Save("test.model", "d", d, false,
+      data::format::native), true);
+
+  distribution::GaussianDistribution e;
+  BOOST_REQUIRE_EQUAL(data::Load("test.model", "d", e, false,
+      data::format::native), true);
+  CheckMatrices(d.Mean(), e.Mean());
+  CheckMatrices(d.Covariance(), e.Covariance());
+
+  BOOST_REQUIRE_EQUAL(data::Save("test.model", "m", m, false,
+      data::format::native), true);
+
+  // The elements of the matrix are the last bytes of the file, and they start
+  // at an aligned offset.
+  std::ifstream in("test.model", std::ios::binary | std::ios::ate);
+  const size_t size = in.tellg();
+  in.close();
+  BOOST_REQUIRE_GE(size, sizeof(double) * m.n_elem);
+  BOOST_REQUIRE_EQUAL((size - sizeof(double) * m.n_elem) %
+      data::NativeOArchive::Alignment, 0);
+
+  arma::mat n;
+  BOOST_REQUIRE_EQUAL(data::Load("test.model", "m", n, false,
+      data::format::native), true);
+  BOOST_REQUIRE_EQUAL(n.n_rows, m.n_rows);
+  BOOST_REQUIRE_EQUAL(n.n_cols, m.n_cols);
+  for (size_t i = 0; i < m.n_elem; ++i)
+    BOOST_REQUIRE_EQUAL(n[i], m[i]);
+
+  remove("test.model");
+}
+
 /**
  * Test DatasetInfo by making a map for a dimension.
  */
@@ -996,6 +1129,44 @@ BOOST_AUTO_TEST_CASE(DatasetInfoTest)
   BOOST_REQUIRE_EQUAL(strThird, "test_mapping_3");
 }
 
+/**
+ * Make sure StringMap finds strings and values after it grows, and handles
+ * strings that aren't terminated.
+ */
+BOOST_AUTO_TEST_CASE(StringMapTest)
+{
+  data::StringMap<size_t> map;
+  for (size_t i = 0; i < 10000; ++i)
+    BOOST_REQUIRE_EQUAL(map.Insert("s" + std::to_string(i), i), i);
+
+  // Inserting a string again doesn't change it.
+  BOOST_REQUIRE_EQUAL(map.Insert("s17", 5), 17);
+  BOOST_REQUIRE_EQUAL(map.Size(), 10000);
+
+  for (size_t i = 0; i < 10000; ++i)
+  {
+    const std::string string = "s" + std::to_string(i);
+    BOOST_REQUIRE(map.Find(string) != NULL);
+    BOOST_REQUIRE_EQUAL(*map.Find(string), i);
+    BOOST_REQUIRE_EQUAL(map.FindValue(i), i);
+    BOOST_REQUIRE_EQUAL(map.String(i), string);
+  }
+
+  const char* line = "s12,s3,unknown";
+  BOOST_REQUIRE_EQUAL(*map.Find(line, 3), 12);
+  BOOST_REQUIRE_EQUAL(*map.Find(line + 4, 2), 3);
+  BOOST_REQUIRE(map.Find(line + 7, 7) == NULL);
+  BOOST_REQUIRE_EQUAL(map.FindValue(10000), map.Size());
+
+  // NaN values can be found too.
+  data::StringMap<double> missing;
+  missing.Insert("?", std::numeric_limits<double>::quiet_NaN());
+  missing.Insert("NA", std::numeric_limits<double>::quiet_NaN());
+  BOOST_REQUIRE_EQUAL(missing.FindValue(
+      std::numeric_limits<double>::quiet_NaN()), 0);
+  BOOST_REQUIRE_EQUAL(missing.FindValue(1.0), 2);
+}
+
 /**
  * Test loading regular CSV with DatasetInfo.  Everything should be numeric.
  */
@@ -1725,6 +1896,36 @@ BOOST_AUTO_TEST_CASE(SimpleARFFCategoricalTest)
   remove("test.arff");
 }
 
+/**
+ * Make sure an ARFF dataset loads untransposed.
+ */
+BOOST_AUTO_TEST_CASE(NoTransposeARFFTest)
+{
+  fstream f;
+  f.open("test.arff", fstream::out);
+  f << "@relation test" << endl;
+  f << "@attribute one STRING" << endl;
+  f << "@attribute two REAL" << endl;
+  f << "@data" << endl;
+  f << "hello, 1" << endl;
+  f << "cheese, 2.34" << endl;
+  f << "hello, -1.3" << endl;
+  f.close();
+
+  arma::mat dataset, ntDataset;
+  DatasetInfo info, ntInfo;
+  data::Load("test.arff", dataset, info);
+  data::Load("test.arff", ntDataset, ntInfo, true, false);
+
+  BOOST_REQUIRE_EQUAL(ntInfo.Dimensionality(), 2);
+  BOOST_REQUIRE_EQUAL(ntInfo.NumMappings(0), 2);
+  BOOST_REQUIRE_EQUAL(ntDataset.n_rows, 3);
+  BOOST_REQUIRE_EQUAL(ntDataset.n_cols, 2);
+  BOOST_REQUIRE_EQUAL(arma::accu(ntDataset != dataset.t()), 0);
+
+  remove("test.arff");
+}
+
 /**
  * A harder ARFF test, where we have each type of supported value, and some
  * random whitespace too.
@@ -1840,6 +2041,116 @@ BOOST_AUTO_TEST_CASE(CaseTest)
   BOOST_CHECK_EQUAL(dataset.n_cols, 3);
 }
 
+/**
+ * Make sure nominal ARFF attributes are mapped in the order they are declared,
+ * and that a value that isn't declared is an error.
+ */
+BOOST_AUTO_TEST_CASE(NominalARFFTest)
+{
+  fstream f;
+  f.open("test.arff", fstream::out);
+  f << "@relation test" << endl;
+  f << "@attribute color {red, 'dark green', blue}" << endl;
+  f << "@attribute size numeric" << endl;
+  f << "@data" << endl;
+  f << "blue, 1" << endl;
+  f << "'dark green', 2" << endl;
+  f << "blue, 3" << endl;
+  f.close();
+
+  arma::mat dataset;
+  DatasetInfo info;
+  BOOST_REQUIRE(data::Load("test.arff", dataset, info));
+
+  BOOST_REQUIRE(info.Type(0) == Datatype::categorical);
+  BOOST_REQUIRE_EQUAL(info.NumMappings(0), 3);
+  BOOST_REQUIRE_EQUAL(info.UnmapString(0, 0), "red");
+  BOOST_REQUIRE_EQUAL(info.UnmapString(1, 0), "dark green");
+  BOOST_REQUIRE_EQUAL(dataset(0, 0), 2.0);
+  BOOST_REQUIRE_EQUAL(dataset(0, 1), 1.0);
+  BOOST_REQUIRE_EQUAL(dataset(0, 2), 2.0);
+  BOOST_REQUIRE_EQUAL(dataset(1, 2), 3.0);
+
+  f.open("test.arff", fstream::out | fstream::app);
+  f << "yellow, 4" << endl;
+  f.close();
+
+  DatasetInfo badInfo;
+  BOOST_REQUIRE_THROW(data::LoadARFF("test.arff", dataset, badInfo),
+      std::runtime_error);
+
+  remove("test.arff");
+}
+
+/**
+ * Load an ARFF file with sparse and dense instances into a dense and a sparse
+ * matrix, split into different numbers of chunks.
+ */
+BOOST_AUTO_TEST_CASE(SparseARFFTest)
+{
+  fstream f;
+  f.open("test.arff", fstream::out);
+  f << "@relation test" << endl;
+  f << "@attribute a numeric" << endl;
+  f << "@attribute b {x, y}" << endl;
+  f << "@attribute c numeric" << endl;
+  f << "@attribute d string" << endl;
+  f << "@data" << endl;
+  for (size_t i = 0; i < 600; ++i)
+  {
+    if (i % 3 == 0)
+      f << "{0 " << i << ", 1 y, 3 s" << (i % 5) << "}" << endl;
+    else if (i % 3 == 1)
+      f << i << ", x, " << (0.5 * i) << ", s" << (i % 5) << endl;
+    else
+      f << "{2 " << i << "}" << endl << "% comment" << endl << endl;
+  }
+  f.close();
+
+  arma::mat serial;
+  DatasetInfo serialInfo;
+  ARFFParser("test.arff", 1).Parse(serial, serialInfo);
+
+  BOOST_REQUIRE_EQUAL(serial.n_rows, 4);
+  BOOST_REQUIRE_EQUAL(serial.n_cols, 600);
+  BOOST_REQUIRE_EQUAL(serialInfo.NumMappings(1), 2);
+  BOOST_REQUIRE_EQUAL(serialInfo.NumMappings(3), 5);
+  for (size_t i = 0; i < 600; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(serial(0, i), (i % 3 == 2) ? 0.0 : double(i));
+    BOOST_REQUIRE_EQUAL(serial(1, i), (i % 3 == 0) ? 1.0 : 0.0);
+    BOOST_REQUIRE_EQUAL(serial(2, i), (i % 3 == 0) ? 0.0 :
+        (i % 3 == 1) ? 0.5 * i : double(i));
+  }
+
+  for (size_t numChunks = 2; numChunks <= 1000; numChunks *= 7)
+  {
+    ARFFParser parser("test.arff", numChunks);
+    BOOST_REQUIRE_EQUAL(parser.NumChunks(), numChunks);
+    BOOST_REQUIRE_EQUAL(parser.NumPoints(), 600);
+    BOOST_REQUIRE(parser.Sparse());
+
+    arma::mat dataset;
+    DatasetInfo info;
+    parser.Parse(dataset, info);
+    BOOST_REQUIRE_EQUAL(arma::accu(dataset != serial), 0);
+
+    arma::sp_mat sparse;
+    DatasetInfo sparseInfo;
+    parser.Parse(sparse, sparseInfo);
+    BOOST_REQUIRE_EQUAL(sparse.n_rows, 4);
+    BOOST_REQUIRE_EQUAL(sparse.n_cols, 600);
+    BOOST_REQUIRE_EQUAL(arma::accu(arma::mat(sparse) != serial), 0);
+  }
+
+  arma::sp_mat sparse;
+  DatasetInfo info;
+  data::LoadARFF("test.arff", sparse, info);
+  BOOST_REQUIRE_EQUAL(sparse.n_nonzero, arma::accu(serial != 0));
+
+  remove("test.arff");
+}
+
 /**
  * Test that a CSV with the wrong number of columns fails.
  */
@@ -1992,4 +2303,532 @@ BOOST_AUTO_TEST_CASE(LoadCSVNoTransposeTXTTest)
   remove("test.txt");
 }
 
+/**
+ * Make sure that each epoch of a DataLoader returns every point of the shards
+ * once, with the transformation applied, and that the order is reproducible.
+ */
+BOOST_AUTO_TEST_CASE(DataLoaderEpochTest)
+{
+  // The only predictor of each point is its index, and the response is twice
+  // the index.
+  std::vector<std::string> shards;
+  const size_t shardEnds[] = { 70, 71, 200 };
+  size_t begin = 0;
+  for (size_t i = 0; i < 3; ++i)
+  {
+    std::ostringstream filename;
+    filename << "data_loader_shard_" << i << ".bin";
+    shards.push_back(filename.str());
+
+    arma::mat shard(2, shardEnds[i] - begin);
+    for (size_t j = 0; j < shard.n_cols; ++j)
+    {
+      shard(0, j) = begin + j;
+      shard(1, j) = 2 * (begin + j);
+    }
+    data::Save(filename.str(), shard, true);
+    begin = shardEnds[i];
+  }
+
+  DataLoader loader(shards, 16, DataLoader::SplitReader(1),
+      [](arma::mat& predictors, arma::mat&) { predictors += 1; }, 2, 3);
+
+  math::RandomSeed(3);
+  arma::mat predictors, responses;
+  std::vector<double> firstOrder;
+  for (size_t epoch = 1; epoch <= 2; ++epoch)
+  {
+    std::vector<double> order;
+    arma::uvec seen = arma::zeros<arma::uvec>(200);
+    while (loader.Next(predictors, responses))
+    {
+      BOOST_REQUIRE_LE(predictors.n_cols, 16);
+      BOOST_REQUIRE_EQUAL(predictors.n_cols, responses.n_cols);
+      for (size_t j = 0; j < predictors.n_cols; ++j)
+      {
+        const size_t point = (size_t) predictors(0, j) - 1;
+        BOOST_REQUIRE_EQUAL(responses(0, j), 2.0 * point);
+        ++seen[point];
+        order.push_back(point);
+      }
+    }
+
+    BOOST_REQUIRE_EQUAL(loader.Epoch(), epoch);
+    BOOST_REQUIRE_EQUAL(arma::accu(seen == 1), 200);
+    if (epoch == 1)
+      firstOrder = order;
+    else
+      BOOST_REQUIRE(order != firstOrder);
+  }
+
+  // With one thread the batches come in the order of the shards, so the same
+  // seed gives the same order.
+  DataLoader serialLoader(shards, 16, DataLoader::SplitReader(1),
+      DataLoader::TransformType(), 1);
+  std::vector<double> orders[2];
+  for (size_t trial = 0; trial < 2; ++trial)
+  {
+    math::RandomSeed(3);
+    while (serialLoader.Next(predictors, responses))
+      for (size_t j = 0; j < predictors.n_cols; ++j)
+        orders[trial].push_back(predictors(0, j));
+  }
+  BOOST_REQUIRE(orders[0] == orders[1]);
+
+  // A shard that can't be read stops the epoch with an exception.
+  shards.push_back("data_loader_shard_missing.bin");
+  DataLoader missingLoader(shards, 16, DataLoader::SplitReader(1));
+  BOOST_REQUIRE_THROW(while (missingLoader.Next(predictors, responses)) { },
+      std::runtime_error);
+
+  math::RandomSeed(std::time(NULL));
+  for (size_t i = 0; i < 3; ++i)
+    remove(shards[i].c_str());
+}
+
+/**
+ * Make sure CSVParser gives the same matrix however the file is split into
+ * chunks, in both layouts, and that blank lines are skipped.
+ */
+BOOST_AUTO_TEST_CASE(CSVParserChunksTest)
+{
+  fstream f;
+  f.open("test.csv", fstream::out);
+  for (size_t i = 0; i < 500; ++i)
+  {
+    f << "  " << i << ", " << (0.25 * i) << ",\t" << -double(i) << "e-2\r\n";
+    if (i % 37 == 0)
+      f << endl << " " << endl;
+  }
+  f.close();
+
+  for (size_t numChunks = 1; numChunks <= 1000; numChunks *= 7)
+  {
+    CSVParser parser("test.csv", CSVParser::COMMA, numChunks);
+    BOOST_REQUIRE_EQUAL(parser.NumChunks(), numChunks);
+    BOOST_REQUIRE_EQUAL(parser.NumLines(), 500);
+    BOOST_REQUIRE_EQUAL(parser.NumFields(), 3);
+
+    arma::mat dataset, ntDataset;
+    parser.Parse(dataset);
+    parser.Parse(ntDataset, false);
+
+    BOOST_REQUIRE_EQUAL(dataset.n_rows, 3);
+    BOOST_REQUIRE_EQUAL(dataset.n_cols, 500);
+    BOOST_REQUIRE_EQUAL(ntDataset.n_rows, 500);
+    BOOST_REQUIRE_EQUAL(ntDataset.n_cols, 3);
+    for (size_t i = 0; i < 500; ++i)
+    {
+      BOOST_REQUIRE_EQUAL(dataset(0, i), double(i));
+      BOOST_REQUIRE_EQUAL(dataset(1, i), 0.25 * i);
+      BOOST_REQUIRE_EQUAL(dataset(2, i), -double(i) / 100.0);
+      for (size_t j = 0; j < 3; ++j)
+        BOOST_REQUIRE_EQUAL(ntDataset(i, j), dataset(j, i));
+    }
+  }
+
+  // data::Load() gives the same matrix.
+  arma::mat dataset;
+  BOOST_REQUIRE(data::Load("test.csv", dataset));
+  BOOST_REQUIRE_EQUAL(dataset.n_rows, 3);
+  BOOST_REQUIRE_EQUAL(dataset.n_cols, 500);
+  BOOST_REQUIRE_EQUAL(dataset(2, 499), -4.99);
+
+  remove("test.csv");
+}
+
+/**
+ * Make sure the mappings of CSVParser don't depend on how the file is split
+ * into chunks.
+ */
+BOOST_AUTO_TEST_CASE(CSVParserMappingsTest)
+{
+  const char* colors[] = { "red", "green", "blue", "" };
+  fstream f;
+  f.open("test.csv", fstream::out);
+  for (size_t i = 0; i < 300; ++i)
+  {
+    f << colors[i % 4] << ", " << i << ", " << ((i % 50 == 49) ? "?" :
+        "1") << ", " << (0.5 * i) << endl;
+  }
+  f.close();
+
+  arma::mat serial;
+  DatasetInfo serialInfo;
+  CSVParser("test.csv", CSVParser::COMMA, 1).Parse(serial, serialInfo);
+
+  BOOST_REQUIRE_EQUAL(serialInfo.Dimensionality(), 4);
+  BOOST_REQUIRE(serialInfo.Type(0) == Datatype::categorical);
+  BOOST_REQUIRE(serialInfo.Type(1) == Datatype::numeric);
+  BOOST_REQUIRE(serialInfo.Type(2) == Datatype::categorical);
+  BOOST_REQUIRE(serialInfo.Type(3) == Datatype::numeric);
+  BOOST_REQUIRE_EQUAL(serialInfo.NumMappings(0), 4);
+  BOOST_REQUIRE_EQUAL(serialInfo.NumMappings(2), 2);
+  BOOST_REQUIRE_EQUAL(serial(2, 0), 0.0); // "1" was seen first.
+  BOOST_REQUIRE_EQUAL(serial(2, 49), 1.0);
+
+  for (size_t numChunks = 2; numChunks <= 64; numChunks *= 2)
+  {
+    arma::mat dataset;
+    DatasetInfo info;
+    CSVParser("test.csv", CSVParser::COMMA, numChunks).Parse(dataset, info);
+
+    BOOST_REQUIRE_EQUAL(dataset.n_rows, serial.n_rows);
+    BOOST_REQUIRE_EQUAL(dataset.n_cols, serial.n_cols);
+    BOOST_REQUIRE_EQUAL(arma::accu(dataset != serial), 0);
+    for (size_t d = 0; d < 4; ++d)
+    {
+      BOOST_REQUIRE(info.Type(d) == serialInfo.Type(d));
+      BOOST_REQUIRE_EQUAL(info.NumMappings(d), serialInfo.NumMappings(d));
+    }
+    BOOST_REQUIRE_EQUAL(info.UnmapString(0, 0), colors[0]);
+    BOOST_REQUIRE_EQUAL(info.UnmapString(1, 0), colors[1]);
+  }
+
+  remove("test.csv");
+}
+
+/**
+ * Make sure CSVParser::ParseFloat() gives the same results as strtod(), and
+ * only reads decimal numbers.
+ */
+BOOST_AUTO_TEST_CASE(CSVParserParseFloatTest)
+{
+  for (size_t i = 0; i < 10000; ++i)
+  {
+    std::ostringstream oss;
+    oss << std::setprecision(1 + i % 20)
+        << (math::Random(-1.0, 1.0) * std::pow(10.0, math::RandInt(-30, 30)));
+    const std::string token = oss.str();
+
+    double value;
+    BOOST_REQUIRE(CSVParser::ParseFloat(token.data(),
+        token.data() + token.size(), value));
+    BOOST_REQUIRE_EQUAL(value, std::strtod(token.c_str(), NULL));
+  }
+
+  const char* numbers[] = { "0", "-0.0", "+3", "5.", ".5", "1e22", "1e23",
+      "9007199254740993", "4.9e-324", "1.7976931348623157e308",
+      "12345678901234567890123456789e-10" };
+  for (const char* token : numbers)
+  {
+    double value;
+    BOOST_REQUIRE(CSVParser::ParseFloat(token, token + strlen(token), value));
+    BOOST_REQUIRE_EQUAL(value, std::strtod(token, NULL));
+  }
+
+  // "nan" and "inf" are read in any case, as strtod() reads them.
+  const char* specials[] = { "nan", "NaN", "-nan", "inf", "-inf", "+Inf",
+      "INFINITY", "-Infinity" };
+  for (const char* token : specials)
+  {
+    double value;
+    BOOST_REQUIRE(CSVParser::ParseFloat(token, token + strlen(token), value));
+    const double expected = std::strtod(token, NULL);
+    if (std::isnan(expected))
+      BOOST_REQUIRE(std::isnan(value));
+    else
+      BOOST_REQUIRE_EQUAL(value, expected);
+  }
+
+  const char* notNumbers[] = { "", "-", ".", "e5", "1e", "1e+", "1.2.3", "na",
+      "nanx", "in", "infin", ".inf", "0x10", "1,2", " 1" };
+  for (const char* token : notNumbers)
+  {
+    double value;
+    BOOST_REQUIRE(!CSVParser::ParseFloat(token, token + strlen(token), value));
+  }
+}
+
+/**
+ * Make sure CSVParser rejects lines with the wrong number of fields, whichever
+ * chunk they are in.
+ */
+BOOST_AUTO_TEST_CASE(CSVParserRaggedTest)
+{
+  fstream f;
+  f.open("test.csv", fstream::out);
+  for (size_t i = 0; i < 100; ++i)
+    f << i << ", " << i << ((i == 83) ? "" : ", 1") << endl;
+  f.close();
+
+  for (size_t numChunks = 1; numChunks <= 16; numChunks *= 2)
+  {
+    arma::mat dataset;
+    DatasetInfo info;
+    CSVParser parser("test.csv", CSVParser::COMMA, numChunks);
+    BOOST_REQUIRE_THROW(parser.Parse(dataset), std::runtime_error);
+    BOOST_REQUIRE_THROW(parser.Parse(dataset, info), std::runtime_error);
+  }
+
+  arma::mat dataset;
+  BOOST_REQUIRE(!data::Load("test.csv", dataset, false));
+
+  remove("test.csv");
+}
+
+/**
+ * Make sure NaN and infinite fields of a CSV file are loaded as they are, with
+ * and without a DatasetInfo; they must not be mapped as categories.
+ */
+BOOST_AUTO_TEST_CASE(LoadNaNInfCSVTest)
+{
+  fstream f;
+  f.open("test.csv", fstream::out);
+  f << "1, nan, inf" << endl;
+  f << "NaN, -inf, 2" << endl;
+  f << "-Inf, 3, INFINITY" << endl;
+  f.close();
+
+  arma::mat dataset;
+  BOOST_REQUIRE(data::Load("test.csv", dataset) == true);
+
+  BOOST_REQUIRE_EQUAL(dataset.n_rows, 3);
+  BOOST_REQUIRE_EQUAL(dataset.n_cols, 3);
+  const double inf = std::numeric_limits<double>::infinity();
+  BOOST_REQUIRE_EQUAL(dataset(0, 0), 1.0);
+  BOOST_REQUIRE(std::isnan(dataset(1, 0)));
+  BOOST_REQUIRE_EQUAL(dataset(2, 0), inf);
+  BOOST_REQUIRE(std::isnan(dataset(0, 1)));
+  BOOST_REQUIRE_EQUAL(dataset(1, 1), -inf);
+  BOOST_REQUIRE_EQUAL(dataset(2, 1), 2.0);
+  BOOST_REQUIRE_EQUAL(dataset(0, 2), -inf);
+  BOOST_REQUIRE_EQUAL(dataset(1, 2), 3.0);
+  BOOST_REQUIRE_EQUAL(dataset(2, 2), inf);
+
+  arma::mat infoDataset;
+  DatasetInfo info;
+  BOOST_REQUIRE(data::Load("test.csv", infoDataset, info) == true);
+
+  BOOST_REQUIRE_EQUAL(infoDataset.n_rows, 3);
+  BOOST_REQUIRE_EQUAL(infoDataset.n_cols, 3);
+  for (size_t i = 0; i < 3; ++i)
+    BOOST_REQUIRE(info.Type(i) == Datatype::numeric);
+  for (size_t i = 0; i < dataset.n_elem; ++i)
+  {
+    if (std::isnan(dataset[i]))
+      BOOST_REQUIRE(std::isnan(infoDataset[i]));
+    else
+      BOOST_REQUIRE_EQUAL(infoDataset[i], dataset[i]);
+  }
+
+  remove("test.csv");
+}
+
+/**
+ * Make sure integer matrices load from text files of floating-point numbers,
+ * as labels saved from a floating-point matrix are.
+ */
+BOOST_AUTO_TEST_CASE(LoadIntegerFromFloatCSVTest)
+{
+  arma::mat labels = "0 1 2 2 1 0";
+  BOOST_REQUIRE(data::Save("test.csv", labels) == true);
+
+  arma::Mat<size_t> loaded;
+  BOOST_REQUIRE(data::Load("test.csv", loaded) == true);
+
+  BOOST_REQUIRE_EQUAL(loaded.n_rows, 1);
+  BOOST_REQUIRE_EQUAL(loaded.n_cols, 6);
+  for (size_t i = 0; i < 6; ++i)
+    BOOST_REQUIRE_EQUAL(loaded[i], (size_t) labels[i]);
+
+  remove("test.csv");
+}
+
+/**
+ * Make sure ChunkedReader gives every block of CSV and binary files (and HDF5
+ * files, if available) once per pass, in order or shuffled, with or without
+ * prefetching.
+ */
+BOOST_AUTO_TEST_CASE(ChunkedReaderTest)
+{
+  // The first dimension of each point is its index; the values are integers,
+  // so they are read back exactly from text.
+  arma::mat dataset = arma::floor(100 * arma::randu<arma::mat>(3, 103));
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+    dataset(0, i) = i;
+
+  std::vector<std::string> filenames = { "test.csv", "test.bin" };
+#if defined(ARMA_USE_HDF5)
+  filenames.push_back("test.h5");
+#endif
+
+  for (size_t f = 0; f < filenames.size(); ++f)
+  {
+    BOOST_REQUIRE(data::Save(filenames[f], dataset) == true);
+
+    for (size_t options = 0; options < 4; ++options)
+    {
+      const bool shuffle = (options & 1);
+      const bool prefetch = (options & 2);
+      data::ChunkedReader reader(filenames[f], 10, shuffle, prefetch);
+      BOOST_REQUIRE_EQUAL(reader.NumPoints(), 103);
+      BOOST_REQUIRE_EQUAL(reader.Dimensionality(), 3);
+      BOOST_REQUIRE_EQUAL(reader.NumBlocks(), 11);
+
+      arma::mat block;
+      for (size_t pass = 1; pass <= 2; ++pass)
+      {
+        arma::Col<size_t> seen(dataset.n_cols, arma::fill::zeros);
+        size_t blocks = 0;
+        while (reader.Next(block))
+        {
+          BOOST_REQUIRE_EQUAL(reader.Pass(), pass);
+          BOOST_REQUIRE_EQUAL(block.n_rows, 3);
+          BOOST_REQUIRE_GT(block.n_cols, 0);
+
+          const size_t first = (size_t) block(0, 0);
+          BOOST_REQUIRE_EQUAL(first % 10, 0);
+          if (!shuffle)
+            BOOST_REQUIRE_EQUAL(first, 10 * blocks);
+          BOOST_REQUIRE_EQUAL(block.n_cols, std::min((size_t) 10,
+              (size_t) dataset.n_cols - first));
+
+          for (size_t i = 0; i < block.n_cols; ++i)
+          {
+            ++seen[first + i];
+            for (size_t d = 0; d < 3; ++d)
+              BOOST_REQUIRE_EQUAL(block(d, i), dataset(d, first + i));
+          }
+
+          ++blocks;
+        }
+
+        BOOST_REQUIRE_EQUAL(blocks, 11);
+        for (size_t i = 0; i < seen.n_elem; ++i)
+          BOOST_REQUIRE_EQUAL(seen[i], 1);
+      }
+    }
+
+    remove(filenames[f].c_str());
+  }
+
+  BOOST_REQUIRE_THROW(data::ChunkedReader("test.csv", 0), std::exception);
+  BOOST_REQUIRE_THROW(data::ChunkedReader("test.arff", 10),
+      std::runtime_error);
+}
+
+/**
+ * Make sure mlpack binary matrix files hold the matrix as it is in memory, can
+ * be loaded or mapped, and are rejected for the wrong element type.
+ */
+BOOST_AUTO_TEST_CASE(MatrixFileTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(7, 53);
+  BOOST_REQUIRE(data::Save("test.mlm", dataset) == true);
+
+  // The matrix is never transposed.
+  arma::mat loaded, untransposed;
+  BOOST_REQUIRE(data::Load("test.mlm", loaded) == true);
+  BOOST_REQUIRE(data::Load("test.mlm", untransposed, false, false) == true);
+  CheckMatrices(loaded, dataset);
+  CheckMatrices(untransposed, dataset);
+
+  data::MappedMatrix<> mapped;
+  BOOST_REQUIRE(!mapped.Mapped());
+  BOOST_REQUIRE(data::Load("test.mlm", mapped) == true);
+  BOOST_REQUIRE(mapped.Mapped());
+  BOOST_REQUIRE_EQUAL((size_t) mapped.Matrix().memptr() %
+      data::MatrixFileAlignment, 0);
+  CheckMatrices(mapped.Matrix(), dataset);
+
+  // A copy of the mapped matrix owns its memory.
+  arma::mat copy = mapped.Matrix();
+  BOOST_REQUIRE(copy.memptr() != mapped.Matrix().memptr());
+  CheckMatrices(copy, dataset);
+
+  arma::fmat floats;
+  data::MappedMatrix<float> mappedFloats;
+  BOOST_REQUIRE(data::Load("test.mlm", floats) == false);
+  BOOST_REQUIRE(data::Load("test.mlm", mappedFloats) == false);
+  BOOST_REQUIRE(!mappedFloats.Mapped());
+
+  // Labels keep their type.
+  arma::Row<size_t> labels = "0 1 2 2 1 0";
+  arma::Row<size_t> loadedLabels;
+  BOOST_REQUIRE(data::Save("labels.mlm", labels) == true);
+  BOOST_REQUIRE(data::Load("labels.mlm", loadedLabels) == true);
+  BOOST_REQUIRE_EQUAL(loadedLabels.n_elem, 6);
+  for (size_t i = 0; i < 6; ++i)
+    BOOST_REQUIRE_EQUAL(loadedLabels[i], labels[i]);
+
+  // A file that isn't a matrix file is rejected, and the current mapping is
+  // kept.
+  std::fstream f("bad.mlm", std::fstream::out);
+  f << "1, 2, 3" << std::endl;
+  f.close();
+  BOOST_REQUIRE(data::Load("bad.mlm", loaded) == false);
+  BOOST_REQUIRE(data::Load("bad.mlm", mapped) == false);
+  BOOST_REQUIRE(mapped.Mapped());
+  BOOST_REQUIRE_EQUAL(mapped.Matrix().n_cols, dataset.n_cols);
+
+  remove("bad.mlm");
+  remove("labels.mlm");
+  remove("test.mlm");
+}
+
+#if defined(HAS_ZSTD) || defined(HAS_LZ4)
+/**
+ * Make sure matrices and models can be saved to and loaded from compressed
+ * files.
+ */
+BOOST_AUTO_TEST_CASE(CompressedLoadSaveTest)
+{
+  std::vector<std::string> compressions;
+#ifdef HAS_ZSTD
+  compressions.push_back(".zst");
+#endif
+#ifdef HAS_LZ4
+  compressions.push_back(".lz4");
+#endif
+
+  arma::mat dataset = arma::randu<arma::mat>(5, 20000);
+  for (size_t c = 0; c < compressions.size(); ++c)
+  {
+    const std::string extensions[] = { ".csv", ".txt", ".bin" };
+    for (size_t e = 0; e < 3; ++e)
+    {
+      const std::string filename = "test" + extensions[e] + compressions[c];
+      BOOST_REQUIRE(data::Save(filename, dataset) == true);
+
+      arma::mat loaded;
+      BOOST_REQUIRE(data::Load(filename, loaded) == true);
+      BOOST_REQUIRE_EQUAL(loaded.n_rows, dataset.n_rows);
+      BOOST_REQUIRE_EQUAL(loaded.n_cols, dataset.n_cols);
+      for (size_t i = 0; i < dataset.n_elem; ++i)
+        BOOST_REQUIRE_CLOSE(loaded[i], dataset[i], 1e-3);
+
+      remove(filename.c_str());
+    }
+
+    // Mapped matrices can't be compressed.
+    BOOST_REQUIRE(data::Save("test.mlm" + compressions[c], dataset) ==
+        false);
+
+    const std::string modelName = "test.bin" + compressions[c];
+    Test x(10, 12);
+    BOOST_REQUIRE_EQUAL(data::Save(modelName, "x", x, false), true);
+
+    Test y(11, 14);
+    BOOST_REQUIRE_EQUAL(data::Load(modelName, "x", y, false), true);
+    BOOST_REQUIRE_EQUAL(y.x, x.x);
+    BOOST_REQUIRE_EQUAL(y.y, x.y);
+    BOOST_REQUIRE_EQUAL(y.ina.c, x.ina.c);
+    BOOST_REQUIRE_EQUAL(y.inb.s, x.inb.s);
+
+    // A truncated file is an error.
+    std::ifstream in(modelName, std::ios::binary);
+    std::string contents((std::istreambuf_iterator<char>(in)),
+        std::istreambuf_iterator<char>());
+    in.close();
+    std::ofstream out(modelName, std::ios::binary);
+    out.write(contents.data(), contents.size() / 2);
+    out.close();
+    BOOST_REQUIRE_EQUAL(data::Load(modelName, "x", y, false), false);
+
+    remove(modelName.c_str());
+  }
+}
+#endif
+
 BOOST_AUTO_TEST_SUITE_END();
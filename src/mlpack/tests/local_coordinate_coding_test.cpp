@@ -87,6 +87,58 @@ BOOST_AUTO_TEST_CASE(LocalCoordinateCodingTestCodingStep)
   }
 }
 
+/**
+ * Make sure that when only the nearest atoms are used to code each point, the
+ * code of each point is the solution of the problem restricted to its nearest
+ * atoms, and is zero for the other atoms.
+ */
+BOOST_AUTO_TEST_CASE(LocalCoordinateCodingTestNearestAtomsCodingStep)
+{
+  double lambda1 = 0.1;
+  uword nAtoms = 25;
+  const size_t neighbors = 8;
+
+  mat X;
+  X.load("mnist_first250_training_4s_and_9s.arm");
+  uword nPoints = X.n_cols;
+
+  // normalize each point since these are images
+  for (uword i = 0; i < nPoints; i++)
+    X.col(i) /= norm(X.col(i), 2);
+
+  mat Z;
+  LocalCoordinateCoding lcc(X, nAtoms, lambda1, 10);
+  lcc.Encode(X, Z, neighbors);
+
+  BOOST_REQUIRE_EQUAL(Z.n_rows, nAtoms);
+  BOOST_REQUIRE_EQUAL(Z.n_cols, nPoints);
+
+  mat D = lcc.Dictionary();
+
+  for (uword i = 0; i < nPoints; i++)
+  {
+    vec sqDists = vec(nAtoms);
+    for (uword j = 0; j < nAtoms; j++)
+    {
+      vec diff = D.unsafe_col(j) - X.unsafe_col(i);
+      sqDists[j] = dot(diff, diff);
+    }
+
+    // Only the nearest atoms may be used.
+    uvec order = sort_index(sqDists);
+    uvec nearest = order.subvec(0, neighbors - 1);
+    for (uword j = neighbors; j < nAtoms; j++)
+      BOOST_REQUIRE_EQUAL(Z(order[j], i), 0.0);
+
+    mat Dprime = D.cols(nearest) * diagmat(1.0 / sqDists.elem(nearest));
+    vec zPrime = Z.col(i);
+    zPrime = zPrime.elem(nearest) % sqDists.elem(nearest);
+
+    vec errCorr = trans(Dprime) * (Dprime * zPrime - X.unsafe_col(i));
+    VerifyCorrectness(zPrime, errCorr, 0.5 * lambda1);
+  }
+}
+
 BOOST_AUTO_TEST_CASE(LocalCoordinateCodingTestDictionaryStep)
 {
   const double tol = 1e-12;
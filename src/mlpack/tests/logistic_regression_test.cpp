@@ -13,6 +13,7 @@
 #include <mlpack/core.hpp>
 #include <mlpack/methods/logistic_regression/logistic_regression.hpp>
 #include <mlpack/core/optimizers/sgd/sgd.hpp>
+#include <mlpack/core/optimizers/hogwild_sgd/hogwild_sgd.hpp>
 
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
@@ -272,6 +273,63 @@ BOOST_AUTO_TEST_CASE(LogisticRegressionFunctionRegularizationSeparableEvaluate)
   }
 }
 
+/**
+ * Make sure that the batch objective and gradient of the
+ * LogisticRegressionFunction are the sums of the separable ones.
+ */
+BOOST_AUTO_TEST_CASE(LogisticRegressionFunctionBatchEvaluateGradient)
+{
+  arma::mat data = arma::randu<arma::mat>(4, 50);
+  arma::Row<size_t> responses(50);
+  for (size_t i = 0; i < responses.n_elem; ++i)
+    responses[i] = (data(0, i) > 0.5) ? 1 : 0;
+
+  LogisticRegressionFunction<> lrf(data, responses, 0.3);
+  const arma::mat parameters = arma::randu<arma::vec>(5);
+
+  arma::vec gradient, pointGradient, sumGradient;
+  lrf.Gradient(parameters, 10, gradient, 25);
+
+  double objective = 0;
+  sumGradient.zeros(5);
+  for (size_t i = 10; i < 35; ++i)
+  {
+    objective += lrf.Evaluate(parameters, i);
+    lrf.Gradient(parameters, i, pointGradient);
+    sumGradient += pointGradient;
+  }
+
+  BOOST_REQUIRE_CLOSE(lrf.Evaluate(parameters, 10, 25), objective, 1e-5);
+  CheckMatrices(gradient, sumGradient, 1e-5);
+
+  // The whole dataset is one batch.
+  BOOST_REQUIRE_CLOSE(lrf.Evaluate(parameters, 0, 50),
+      lrf.Evaluate(parameters), 1e-5);
+}
+
+/**
+ * Make sure that the batch EvaluateWithGradient() gives the same objective and
+ * gradient as the batch Evaluate() and Gradient().
+ */
+BOOST_AUTO_TEST_CASE(LogisticRegressionFunctionEvaluateWithGradient)
+{
+  arma::mat data = arma::randu<arma::mat>(4, 50);
+  arma::Row<size_t> responses(50);
+  for (size_t i = 0; i < responses.n_elem; ++i)
+    responses[i] = (data(0, i) > 0.5) ? 1 : 0;
+
+  LogisticRegressionFunction<> lrf(data, responses, 0.3);
+  const arma::mat parameters = arma::randu<arma::vec>(5);
+
+  arma::vec gradient, batchGradient;
+  const double objective = lrf.EvaluateWithGradient(parameters, 10, gradient,
+      25);
+  lrf.Gradient(parameters, 10, batchGradient, 25);
+
+  BOOST_REQUIRE_CLOSE(objective, lrf.Evaluate(parameters, 10, 25), 1e-5);
+  CheckMatrices(gradient, batchGradient, 1e-5);
+}
+
 /**
  * Test separable gradient of the LogisticRegressionFunction.
  */
@@ -813,6 +871,97 @@ BOOST_AUTO_TEST_CASE(LogisticRegressionSparseSGDTest)
     BOOST_REQUIRE_CLOSE(lr.Parameters()[i], lrSparse.Parameters()[i], 1e-5);
 }
 
+/**
+ * Make sure the sparse gradient of a point matches the dense gradient of the
+ * point on the intercept and the nonzero features of the point, and is zero
+ * elsewhere.
+ */
+BOOST_AUTO_TEST_CASE(LogisticRegressionFunctionSparseGradient)
+{
+  arma::sp_mat dataset;
+  dataset.sprandu(10, 50, 0.3);
+  arma::Row<size_t> labels(50);
+  for (size_t i = 0; i < 50; ++i)
+    labels[i] = math::RandInt(0, 2);
+
+  LogisticRegressionFunction<arma::sp_mat> lrf(dataset, labels, 0.3);
+  const arma::mat parameters = arma::randu<arma::vec>(11);
+
+  arma::mat gradient;
+  arma::sp_mat sparseGradient;
+  for (size_t i = 0; i < 50; ++i)
+  {
+    lrf.Gradient(parameters, i, gradient);
+    lrf.Gradient(parameters, i, sparseGradient);
+
+    BOOST_REQUIRE_EQUAL(sparseGradient.n_rows, 11);
+    BOOST_REQUIRE_EQUAL(sparseGradient.n_cols, 1);
+    BOOST_REQUIRE_CLOSE(sparseGradient(0, 0), gradient[0], 1e-5);
+    for (size_t j = 0; j < 10; ++j)
+    {
+      if (dataset(j, i) == 0)
+        BOOST_REQUIRE_EQUAL(sparseGradient(j + 1, 0), 0.0);
+      else
+        BOOST_REQUIRE_CLOSE(sparseGradient(j + 1, 0), gradient[j + 1], 1e-5);
+    }
+  }
+}
+
+/**
+ * Make sure the linear model functions used by SAGA put together the
+ * separable gradient of each point.
+ */
+BOOST_AUTO_TEST_CASE(LogisticRegressionFunctionLinearGradient)
+{
+  arma::mat data = arma::randu<arma::mat>(4, 50);
+  arma::Row<size_t> responses(50);
+  for (size_t i = 0; i < responses.n_elem; ++i)
+    responses[i] = (data(0, i) > 0.5) ? 1 : 0;
+
+  LogisticRegressionFunction<> lrf(data, responses, 0.3);
+  const arma::mat parameters = arma::randu<arma::vec>(5);
+
+  arma::mat gradient, linearGradient;
+  for (size_t i = 0; i < 50; ++i)
+  {
+    lrf.Gradient(parameters, i, gradient);
+    lrf.RegularizationGradient(parameters, linearGradient);
+    lrf.AddLinearGradient(i, lrf.LinearGradient(parameters, i),
+        linearGradient);
+    CheckMatrices(linearGradient, gradient, 1e-5);
+  }
+}
+
+/**
+ * Train logistic regression on sparse data with HogwildSGD, which takes the
+ * sparse gradient steps of the points.
+ */
+BOOST_AUTO_TEST_CASE(LogisticRegressionSparseHogwildTest)
+{
+  arma::sp_mat dataset;
+  dataset.sprandu(10, 800, 0.3);
+  arma::Row<size_t> labels(800);
+  for (size_t i = 0; i < 800; ++i)
+    labels[i] = (dataset(0, i) > 0.5) ? 1 : 0;
+
+  LogisticRegressionFunction<arma::sp_mat> lrf(dataset, labels, 0.0);
+  HogwildSGD<LogisticRegressionFunction<arma::sp_mat>> optimizer(lrf, 32, 0.5,
+      50, 0);
+
+  arma::mat parameters = lrf.GetInitialPoint();
+  const double initialObjective = lrf.Evaluate(parameters);
+  const double objective = optimizer.Optimize(parameters);
+  BOOST_REQUIRE_LT(objective, initialObjective);
+
+  LogisticRegression<arma::sp_mat> lr(10, 0.0);
+  lr.Parameters() = parameters;
+  arma::Row<size_t> predictions;
+  lr.Classify(dataset, predictions);
+
+  const double accuracy = arma::accu(predictions == labels) / 800.0;
+  BOOST_REQUIRE_GT(accuracy, 0.9);
+}
+
 /**
  * Test multi-point classification (Classify()).
  */
@@ -963,4 +1112,81 @@ BOOST_AUTO_TEST_CASE(ClassifyProbabilitiesTest)
   }
 }
 
+/**
+ * Make sure the objective is finite and correct when the sigmoids of the points
+ * round to 0 or 1.
+ */
+BOOST_AUTO_TEST_CASE(LogisticRegressionFunctionLargeExponentTest)
+{
+  // The exponents of the points are 1000, -1000, 1000 and -1000.
+  const arma::mat data("1 -1 1 -1");
+  const arma::Row<size_t> responses("1 1 0 0");
+  const arma::vec parameters("0 1000");
+
+  LogisticRegressionFunction<> lrf(data, responses, 0.0);
+
+  // The two misclassified points each contribute log(1 + exp(1000)).
+  const double objective = lrf.Evaluate(parameters);
+  BOOST_REQUIRE(std::isfinite(objective));
+  BOOST_REQUIRE_CLOSE(objective, 2000.0, 1e-5);
+
+  BOOST_REQUIRE_SMALL(lrf.Evaluate(parameters, 0), 1e-5);
+  BOOST_REQUIRE_CLOSE(lrf.Evaluate(parameters, 1), 1000.0, 1e-5);
+  BOOST_REQUIRE_CLOSE(lrf.Evaluate(parameters, 0, 4), 2000.0, 1e-5);
+
+  arma::mat gradient;
+  BOOST_REQUIRE_CLOSE(lrf.EvaluateWithGradient(parameters, 0, gradient, 4),
+      2000.0, 1e-5);
+
+  // For small exponents, the objective is the usual one.
+  const arma::vec smallParameters("0.3 -0.2");
+  double expected = 0.0;
+  for (size_t i = 0; i < 4; ++i)
+  {
+    const double sigmoid = 1.0 / (1.0 + std::exp(-0.3 + 0.2 * data[i]));
+    expected -= (responses[i] == 1) ? std::log(sigmoid) :
+        std::log(1.0 - sigmoid);
+  }
+  BOOST_REQUIRE_CLOSE(lrf.Evaluate(smallParameters), expected, 1e-5);
+}
+
+/**
+ * Make sure that classifying many points, which are split between threads,
+ * gives the same results as classifying the points one at a time.
+ */
+BOOST_AUTO_TEST_CASE(ClassifyManyPointsTest)
+{
+  arma::mat data;
+  data.randn(5, 10000);
+  arma::Row<size_t> responses(10000);
+  for (size_t i = 0; i < data.n_cols; ++i)
+    responses[i] = (data(0, i) + data(3, i) > 0.0) ? 1 : 0;
+
+  LogisticRegression<> lr(data, responses, 0.001);
+
+  arma::Row<size_t> labels;
+  arma::mat probabilities;
+  lr.Classify(data, labels);
+  lr.Classify(data, probabilities);
+
+  BOOST_REQUIRE_EQUAL(labels.n_elem, data.n_cols);
+  BOOST_REQUIRE_EQUAL(probabilities.n_cols, data.n_cols);
+
+  size_t correct = 0;
+  for (size_t i = 0; i < data.n_cols; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(labels[i], lr.Classify(data.col(i)));
+
+    const double sigmoid = 1.0 / (1.0 + std::exp(-lr.Parameters()[0] -
+        arma::dot(data.col(i), lr.Parameters().tail(5))));
+    BOOST_REQUIRE_CLOSE(probabilities(1, i), sigmoid, 1e-5);
+
+    if (labels[i] == responses[i])
+      ++correct;
+  }
+
+  BOOST_REQUIRE_CLOSE(lr.ComputeAccuracy(data, responses),
+      100.0 * correct / data.n_cols, 1e-5);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -276,6 +276,77 @@ BOOST_AUTO_TEST_CASE(GaussianMatrixSensingSDP)
   BOOST_REQUIRE_SMALL(err, 1e-3);
 }
 
+/**
+ * Make sure that the constraints, the augmented Lagrangian and its gradient,
+ * which are computed without forming R R^T, match the values computed through
+ * R R^T, for a random SDP with both sparse and dense (symmetric) constraints.
+ */
+BOOST_AUTO_TEST_CASE(LowRankEvaluationTest)
+{
+  const size_t n = 30, r = 3, numSparse = 20, numDense = 4;
+
+  SDP<arma::sp_mat> sdp(n, numSparse, numDense);
+  sdp.C().sprandu(n, n, 0.1);
+  sdp.C() += trans(sdp.C());
+  for (size_t i = 0; i < numSparse; ++i)
+  {
+    sdp.SparseA()[i].sprandu(n, n, 0.05);
+    sdp.SparseA()[i] += trans(sdp.SparseA()[i]);
+    sdp.SparseB()[i] = math::Random();
+  }
+  for (size_t i = 0; i < numDense; ++i)
+  {
+    sdp.DenseA()[i].randu(n, n);
+    sdp.DenseA()[i] += trans(sdp.DenseA()[i]);
+    sdp.DenseB()[i] = math::Random();
+  }
+
+  const arma::mat coordinates(n, r, arma::fill::randu);
+  const arma::mat rrt = coordinates * trans(coordinates);
+  const arma::vec lambda(numSparse + numDense, arma::fill::randu);
+  const double sigma = 5.0;
+
+  arma::vec expected(numSparse + numDense);
+  for (size_t i = 0; i < numSparse; ++i)
+    expected[i] = arma::accu(sdp.SparseA()[i] % rrt) - sdp.SparseB()[i];
+  for (size_t i = 0; i < numDense; ++i)
+    expected[numSparse + i] = arma::accu(sdp.DenseA()[i] % rrt) -
+        sdp.DenseB()[i];
+
+  LRSDPFunction<SDP<arma::sp_mat>> function(sdp, coordinates);
+  arma::vec constraints;
+  function.EvaluateConstraints(coordinates, constraints);
+  BOOST_REQUIRE_EQUAL(constraints.n_elem, expected.n_elem);
+  for (size_t i = 0; i < expected.n_elem; ++i)
+  {
+    BOOST_REQUIRE_CLOSE(constraints[i], expected[i], 1e-8);
+    BOOST_REQUIRE_CLOSE(function.EvaluateConstraint(i, coordinates),
+        expected[i], 1e-8);
+  }
+
+  AugLagrangianFunction<LRSDPFunction<SDP<arma::sp_mat>>> augLag(function,
+      lambda, sigma);
+  const double objective = arma::accu(sdp.C() % rrt) -
+      arma::dot(lambda, expected) + (sigma / 2.) * arma::dot(expected,
+      expected);
+  BOOST_REQUIRE_CLOSE(augLag.Evaluate(coordinates), objective, 1e-8);
+
+  arma::mat s(sdp.C());
+  for (size_t i = 0; i < numSparse; ++i)
+    s -= (lambda[i] - sigma * expected[i]) * sdp.SparseA()[i];
+  for (size_t i = 0; i < numDense; ++i)
+    s -= (lambda[numSparse + i] - sigma * expected[numSparse + i]) *
+        sdp.DenseA()[i];
+  const arma::mat expectedGradient = 2 * s * coordinates;
+
+  arma::mat gradient;
+  augLag.Gradient(coordinates, gradient);
+  BOOST_REQUIRE_EQUAL(gradient.n_rows, n);
+  BOOST_REQUIRE_EQUAL(gradient.n_cols, r);
+  for (size_t i = 0; i < gradient.n_elem; ++i)
+    BOOST_REQUIRE_CLOSE(gradient[i], expectedGradient[i], 1e-6);
+}
+
 /**
  * keller4.co test case for Lovasz-Theta LRSDP.
  * This is commented out because it takes a long time to run.
@@ -12,8 +12,10 @@
 #include <mlpack/core/metrics/lmetric.hpp>
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
+#include "serialization.hpp"
 
 #include <mlpack/methods/lsh/lsh_search.hpp>
+#include <mlpack/methods/lsh/simhash_search.hpp>
 #include <mlpack/methods/neighbor_search/neighbor_search.hpp>
 
 using namespace std;
@@ -912,4 +914,256 @@ BOOST_AUTO_TEST_CASE(MoveOperatorTest)
   CheckMatrices(distances, distances2);
 }
 
+/**
+ * Make sure that the buckets of the second hash table are laid out one after
+ * the other, that each point is in one bucket per table when the buckets have
+ * no maximum size, and that the maximum size is enforced otherwise.
+ */
+BOOST_AUTO_TEST_CASE(BucketLayoutTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(10, 5000);
+  const size_t numTables = 8;
+
+  LSHSearch<> lsh(dataset, 6, numTables, 0.5, 99901, 0);
+
+  const arma::Col<size_t>& offsets = lsh.BucketOffsets();
+  const arma::Col<size_t>& contents = lsh.BucketContents();
+  BOOST_REQUIRE_GT(offsets.n_elem, 1);
+  BOOST_REQUIRE_EQUAL(offsets[0], 0);
+  BOOST_REQUIRE_EQUAL(offsets[offsets.n_elem - 1], contents.n_elem);
+  BOOST_REQUIRE_EQUAL(contents.n_elem, numTables * dataset.n_cols);
+
+  arma::Col<size_t> counts(dataset.n_cols, arma::fill::zeros);
+  for (size_t i = 0; i + 1 < offsets.n_elem; ++i)
+  {
+    // Buckets are never empty.
+    BOOST_REQUIRE_LT(offsets[i], offsets[i + 1]);
+    for (size_t j = offsets[i]; j < offsets[i + 1]; ++j)
+      counts[contents[j]]++;
+  }
+
+  for (size_t i = 0; i < counts.n_elem; ++i)
+    BOOST_REQUIRE_EQUAL(counts[i], numTables);
+
+  // Now limit the size of the buckets.
+  lsh.Train(dataset, 6, numTables, 0.5, 99901, 3);
+  for (size_t i = 0; i + 1 < lsh.BucketOffsets().n_elem; ++i)
+  {
+    BOOST_REQUIRE_LE(lsh.BucketOffsets()[i + 1] - lsh.BucketOffsets()[i],
+        3);
+  }
+}
+
+/**
+ * With a very large hash width, every point is in the same bucket of each
+ * table, so each point must be a candidate exactly once, and the results must
+ * be the exact nearest neighbors, in both bichromatic and monochromatic mode.
+ */
+BOOST_AUTO_TEST_CASE(ExhaustiveCandidatesTest)
+{
+  arma::mat rdata = arma::randu<arma::mat>(5, 2000);
+  arma::mat qdata = arma::randu<arma::mat>(5, 300);
+  const size_t k = 5;
+
+  LSHSearch<> lsh(rdata, 4, 6, 1e6, 99901, 0);
+
+  arma::Mat<size_t> neighbors, trueNeighbors;
+  arma::mat distances, trueDistances;
+  lsh.Search(qdata, k, neighbors, distances);
+  BOOST_REQUIRE_EQUAL(lsh.DistanceEvaluations(), rdata.n_cols * qdata.n_cols);
+
+  KNN knn(rdata);
+  knn.Search(qdata, k, trueNeighbors, trueDistances);
+  CheckMatrices(neighbors, trueNeighbors);
+  CheckMatrices(distances, trueDistances);
+
+  lsh.Search(k, neighbors, distances);
+  knn.Search(k, trueNeighbors, trueDistances);
+  CheckMatrices(neighbors, trueNeighbors);
+  CheckMatrices(distances, trueDistances);
+}
+
+/**
+ * Inserting points into a model must give the same results as training the
+ * model on all the points, with the same random projections.
+ */
+BOOST_AUTO_TEST_CASE(InsertTest)
+{
+  arma::mat rdata = arma::randu<arma::mat>(4, 3000);
+  arma::mat qdata = arma::randu<arma::mat>(4, 200);
+
+  // The hash width is given, so the random numbers drawn by Train() don't
+  // depend on the reference set.
+  math::RandomSeed(42);
+  LSHSearch<> lsh(rdata.cols(0, 1999), 5, 8, 0.3, 99901, 0);
+  lsh.Insert(rdata.cols(2000, 2499));
+  lsh.Insert(rdata.cols(2500, 2999));
+
+  math::RandomSeed(42);
+  LSHSearch<> fullLsh(rdata, 5, 8, 0.3, 99901, 0);
+
+  BOOST_REQUIRE_EQUAL(lsh.ReferenceSet().n_cols, rdata.n_cols);
+  BOOST_REQUIRE_EQUAL(lsh.BucketContents().n_elem,
+      fullLsh.BucketContents().n_elem);
+
+  arma::Mat<size_t> neighbors, fullNeighbors;
+  arma::mat distances, fullDistances;
+  lsh.Search(qdata, 3, neighbors, distances);
+  fullLsh.Search(qdata, 3, fullNeighbors, fullDistances);
+
+  CheckMatrices(neighbors, fullNeighbors);
+  CheckMatrices(distances, fullDistances);
+
+  // Points of the wrong dimensionality can't be inserted.
+  BOOST_REQUIRE_THROW(lsh.Insert(arma::randu<arma::mat>(3, 10)),
+      std::invalid_argument);
+}
+
+/**
+ * Removed points must never be returned, before and after the buckets are
+ * compacted.
+ */
+BOOST_AUTO_TEST_CASE(RemoveTest)
+{
+  arma::mat rdata = arma::randu<arma::mat>(5, 2000);
+  arma::mat qdata = arma::randu<arma::mat>(5, 100);
+  const size_t numTables = 6;
+
+  // Every point is in the same bucket of each table.
+  LSHSearch<> lsh(rdata, 4, numTables, 1e6, 99901, 0);
+
+  // Remove a few points, which doesn't compact the buckets.
+  arma::Col<size_t> toRemove = arma::linspace<arma::Col<size_t>>(0, 1990,
+      200);
+  lsh.Remove(toRemove);
+  BOOST_REQUIRE_EQUAL(lsh.BucketContents().n_elem, numTables * rdata.n_cols);
+
+  arma::Mat<size_t> neighbors, compactNeighbors;
+  arma::mat distances, compactDistances;
+  lsh.Search(qdata, 5, neighbors, distances);
+  BOOST_REQUIRE_EQUAL(lsh.DistanceEvaluations(),
+      (rdata.n_cols - toRemove.n_elem) * qdata.n_cols);
+  for (size_t i = 0; i < neighbors.n_elem; ++i)
+    BOOST_REQUIRE(!arma::any(toRemove == neighbors[i]));
+
+  lsh.Compact();
+  BOOST_REQUIRE_EQUAL(lsh.BucketContents().n_elem,
+      numTables * (rdata.n_cols - toRemove.n_elem));
+
+  lsh.Search(qdata, 5, compactNeighbors, compactDistances);
+  CheckMatrices(neighbors, compactNeighbors);
+  CheckMatrices(distances, compactDistances);
+
+  // Removing many points compacts the buckets.
+  lsh.Remove(arma::linspace<arma::Col<size_t>>(1000, 1999, 1000));
+  BOOST_REQUIRE_LT(lsh.BucketContents().n_elem, numTables * 1000);
+
+  BOOST_REQUIRE_THROW(lsh.Remove(arma::Col<size_t>("2000")),
+      std::invalid_argument);
+}
+
+/**
+ * Make sure that SimHash finds the same codes as a brute-force scan, with and
+ * without multi-index hashing, and that close points get close codes.
+ */
+BOOST_AUTO_TEST_CASE(SimHashTest)
+{
+  const arma::mat referenceSet = arma::randn<arma::mat>(10, 1000);
+  const arma::mat querySet = referenceSet.cols(0, 99) +
+      0.01 * arma::randn<arma::mat>(10, 100);
+
+  // 100 bits span two words, and the substrings span the word boundary.
+  SimHashSearch<> simhash(referenceSet, 100, 6);
+  BOOST_REQUIRE_EQUAL(simhash.Size(), referenceSet.n_cols);
+  BOOST_REQUIRE_EQUAL(simhash.Words(), 2);
+
+  // Compute the Hamming distances by brute force, one bit at a time.
+  arma::Mat<size_t> hamming(querySet.n_cols, referenceSet.n_cols);
+  std::vector<uint64_t> queryCode(simhash.Words());
+  for (size_t i = 0; i < querySet.n_cols; ++i)
+  {
+    simhash.Hash(querySet.col(i), queryCode.data());
+    for (size_t j = 0; j < referenceSet.n_cols; ++j)
+    {
+      size_t distance = 0;
+      for (size_t b = 0; b < simhash.Bits(); ++b)
+      {
+        if (((queryCode[b / 64] ^ simhash.Code(j)[b / 64]) >> (b % 64)) & 1)
+          ++distance;
+      }
+      hamming(i, j) = distance;
+    }
+  }
+
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  simhash.Search(querySet, 5, neighbors, distances);
+  size_t found = 0;
+  for (size_t i = 0; i < querySet.n_cols; ++i)
+  {
+    const arma::Row<size_t> sorted = arma::sort(hamming.row(i));
+    for (size_t j = 0; j < 5; ++j)
+    {
+      BOOST_REQUIRE_EQUAL(distances(j, i), sorted[j]);
+      BOOST_REQUIRE_EQUAL(hamming(i, neighbors(j, i)), sorted[j]);
+    }
+
+    if (neighbors(0, i) == i)
+      ++found;
+  }
+
+  // A query point is a slightly perturbed reference point, which should have
+  // the closest code.
+  BOOST_REQUIRE_GE(found, 95);
+
+  // The range search is exact.
+  std::vector<std::vector<size_t>> rangeNeighbors;
+  std::vector<std::vector<double>> rangeDistances;
+  simhash.RangeSearch(querySet, 20, rangeNeighbors, rangeDistances);
+  BOOST_REQUIRE_EQUAL(rangeNeighbors.size(), querySet.n_cols);
+  for (size_t i = 0; i < querySet.n_cols; ++i)
+  {
+    const arma::uvec within = arma::find(hamming.row(i) <= 20);
+    BOOST_REQUIRE_EQUAL(rangeNeighbors[i].size(), within.n_elem);
+    for (size_t j = 0; j < rangeNeighbors[i].size(); ++j)
+    {
+      BOOST_REQUIRE_EQUAL(rangeDistances[i][j],
+          hamming(i, rangeNeighbors[i][j]));
+      if (j > 0)
+        BOOST_REQUIRE_LE(rangeDistances[i][j - 1], rangeDistances[i][j]);
+    }
+  }
+
+  // The serialized index gives the same results.
+  SimHashSearch<> xmlSimHash, textSimHash, binarySimHash;
+  SerializeObjectAll(simhash, xmlSimHash, textSimHash, binarySimHash);
+  BOOST_REQUIRE_EQUAL(binarySimHash.Bits(), 100);
+
+  arma::Mat<size_t> xmlNeighbors, textNeighbors, binaryNeighbors;
+  arma::mat xmlDistances, textDistances, binaryDistances;
+  xmlSimHash.Search(querySet, 5, xmlNeighbors, xmlDistances);
+  textSimHash.Search(querySet, 5, textNeighbors, textDistances);
+  binarySimHash.Search(querySet, 5, binaryNeighbors, binaryDistances);
+  CheckMatrices(distances, xmlDistances, textDistances, binaryDistances);
+
+  std::vector<std::vector<size_t>> binaryRangeNeighbors;
+  std::vector<std::vector<double>> binaryRangeDistances;
+  binarySimHash.RangeSearch(querySet, 20, binaryRangeNeighbors,
+      binaryRangeDistances);
+  for (size_t i = 0; i < querySet.n_cols; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(binaryRangeNeighbors[i].size(),
+        rangeNeighbors[i].size());
+  }
+
+  // Invalid parameters are rejected.
+  BOOST_REQUIRE_THROW(SimHashSearch<>(0), std::invalid_argument);
+  BOOST_REQUIRE_THROW(SimHashSearch<>(128, 1), std::invalid_argument);
+  BOOST_REQUIRE_THROW(SimHashSearch<>(8, 9), std::invalid_argument);
+  BOOST_REQUIRE_THROW(simhash.Search(querySet, 1001, neighbors, distances),
+      std::invalid_argument);
+  BOOST_REQUIRE_THROW(simhash.Search(arma::randn<arma::mat>(9, 10), 5,
+      neighbors, distances), std::invalid_argument);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -12,6 +12,10 @@
 #include <mlpack/core/math/clamp.hpp>
 #include <mlpack/core/math/random.hpp>
 #include <mlpack/core/math/range.hpp>
+#include <mlpack/core/math/streaming_statistics.hpp>
+
+#include <thread>
+
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
 
@@ -583,4 +587,262 @@ BOOST_AUTO_TEST_CASE(RangeContainsRange)
   BOOST_REQUIRE_EQUAL(b.Contains(a), true);
 }
 
+/**
+ * Check the blocks of the random streams against the known answers of the
+ * reference Philox4x32-10 implementation.
+ */
+BOOST_AUTO_TEST_CASE(RandomStreamKnownAnswerTest)
+{
+  uint32_t output[4];
+
+  const uint32_t zeroKey[2] = { 0, 0 };
+  RandomStream::Block(zeroKey, 0, 0, output);
+  BOOST_REQUIRE_EQUAL(output[0], 0x6627e8d5u);
+  BOOST_REQUIRE_EQUAL(output[1], 0xe169c58du);
+  BOOST_REQUIRE_EQUAL(output[2], 0xbc57ac4cu);
+  BOOST_REQUIRE_EQUAL(output[3], 0x9b00dbd8u);
+
+  const uint32_t onesKey[2] = { 0xffffffffu, 0xffffffffu };
+  RandomStream::Block(onesKey, ~(uint64_t) 0, ~(uint64_t) 0, output);
+  BOOST_REQUIRE_EQUAL(output[0], 0x408f276du);
+  BOOST_REQUIRE_EQUAL(output[1], 0x41c83b0eu);
+  BOOST_REQUIRE_EQUAL(output[2], 0xa20bc7c6u);
+  BOOST_REQUIRE_EQUAL(output[3], 0x6d5451fdu);
+
+  const uint32_t piKey[2] = { 0xa4093822u, 0x299f31d0u };
+  RandomStream::Block(piKey, 0x0370734413198a2eull, 0x85a308d3243f6a88ull,
+      output);
+  BOOST_REQUIRE_EQUAL(output[0], 0xd16cfe09u);
+  BOOST_REQUIRE_EQUAL(output[1], 0x94fdccebu);
+  BOOST_REQUIRE_EQUAL(output[2], 0x5001e420u);
+  BOOST_REQUIRE_EQUAL(output[3], 0x24126ea1u);
+}
+
+/**
+ * Make sure the bulk fillers give the numbers of Random(), that streams are
+ * reproducible and distinct, and that the distributions are right.
+ */
+BOOST_AUTO_TEST_CASE(RandomStreamFillTest)
+{
+  RandomStream stream(42, 3);
+  arma::mat uniform(101, 7);
+  stream.Randu(uniform);
+
+  RandomStream other(42, 3);
+  for (size_t i = 0; i < uniform.n_elem; ++i)
+    BOOST_REQUIRE_EQUAL(uniform[i], other.Random());
+
+  RandomStream otherStream(42, 4);
+  arma::mat otherUniform(101, 7);
+  otherStream.Randu(otherUniform);
+  BOOST_REQUIRE_GT(arma::accu(uniform != otherUniform), 700);
+
+  BOOST_REQUIRE_GT(uniform.min(), 0.0);
+  BOOST_REQUIRE_LT(uniform.max(), 1.0);
+  BOOST_REQUIRE_CLOSE(arma::mean(arma::vectorise(uniform)), 0.5, 5.0);
+
+  arma::mat normal(1000, 11);
+  stream.Randn(normal);
+  BOOST_REQUIRE_SMALL(arma::mean(arma::vectorise(normal)), 0.05);
+  BOOST_REQUIRE_CLOSE(arma::var(arma::vectorise(normal)), 1.0, 5.0);
+}
+
+/**
+ * Make sure the thread stream is restarted by RandomSeed().
+ */
+BOOST_AUTO_TEST_CASE(ThreadRandomStreamSeedTest)
+{
+  RandomSeed(17);
+  arma::mat first(50, 3);
+  ThreadRandomStream().Randu(first);
+
+  arma::mat second(50, 3);
+  ThreadRandomStream().Randu(second);
+  BOOST_REQUIRE_GT(arma::accu(first != second), 100);
+
+  RandomSeed(17);
+  arma::mat repeated(50, 3);
+  ThreadRandomStream().Randu(repeated);
+  CheckMatrices(first, repeated);
+
+  RandomSeed(std::time(NULL));
+}
+
+/**
+ * Make sure the random functions are reproducible for a fixed seed, and that
+ * the streams of tasks don't depend on the thread that uses them.
+ */
+BOOST_AUTO_TEST_CASE(RandomFunctionsSeedTest)
+{
+  RandomSeed(23);
+  arma::vec first(200);
+  for (size_t i = 0; i < first.n_elem; i += 4)
+  {
+    first[i] = Random();
+    first[i + 1] = Random(-3.0, 2.0);
+    first[i + 2] = RandInt(5, 50);
+    first[i + 3] = RandNormal(1.0, 2.0);
+  }
+
+  RandomSeed(23);
+  arma::vec repeated(200);
+  for (size_t i = 0; i < repeated.n_elem; i += 4)
+  {
+    repeated[i] = Random();
+    repeated[i + 1] = Random(-3.0, 2.0);
+    repeated[i + 2] = RandInt(5, 50);
+    repeated[i + 3] = RandNormal(1.0, 2.0);
+  }
+  CheckMatrices(first, repeated);
+
+  // Fill the columns from the streams of their tasks, in parallel.
+  arma::mat tasks(20, 16);
+  #pragma omp parallel for schedule(dynamic)
+  for (intmax_t t = 0; t < (intmax_t) tasks.n_cols; ++t)
+  {
+    RandomStream stream = TaskRandomStream(t);
+    stream.FillUniform(tasks.colptr(t), tasks.n_rows);
+  }
+
+  for (size_t t = 0; t < tasks.n_cols; ++t)
+  {
+    RandomStream stream = TaskRandomStream(t);
+    for (size_t i = 0; i < tasks.n_rows; ++i)
+      BOOST_REQUIRE_EQUAL(tasks(i, t), stream.Random());
+  }
+  BOOST_REQUIRE_GT(arma::accu(tasks.col(0) != tasks.col(1)), 15);
+
+  RandomSeed(std::time(NULL));
+}
+
+/**
+ * Make sure that threads not created by OpenMP get streams of their own, so
+ * they don't draw the numbers of the main thread or of each other.
+ */
+BOOST_AUTO_TEST_CASE(ThreadRandomStreamStdThreadTest)
+{
+  RandomSeed(29);
+  arma::vec mainNumbers(20), firstNumbers(20), secondNumbers(20);
+  ThreadRandomStream().Randu(mainNumbers);
+
+  uint64_t indices[2];
+  std::thread first([&]()
+  {
+    indices[0] = ThreadRandomStreamIndex();
+    ThreadRandomStream().Randu(firstNumbers);
+  });
+  std::thread second([&]()
+  {
+    indices[1] = ThreadRandomStreamIndex();
+    ThreadRandomStream().Randu(secondNumbers);
+  });
+  first.join();
+  second.join();
+
+  BOOST_REQUIRE_NE(indices[0], 0);
+  BOOST_REQUIRE_NE(indices[1], 0);
+  BOOST_REQUIRE_NE(indices[0], indices[1]);
+  BOOST_REQUIRE_GT(arma::accu(mainNumbers != firstNumbers), 15);
+  BOOST_REQUIRE_GT(arma::accu(mainNumbers != secondNumbers), 15);
+  BOOST_REQUIRE_GT(arma::accu(firstNumbers != secondNumbers), 15);
+
+  RandomSeed(std::time(NULL));
+}
+
+/**
+ * Make sure that the statistics of a MomentAccumulator fed in uneven blocks
+ * (and merged with another one) match the statistics of the whole dataset.
+ */
+BOOST_AUTO_TEST_CASE(MomentAccumulatorTest)
+{
+  arma::mat dataset = arma::pow(arma::randu<arma::mat>(4, 5003), 3.0) + 1e4;
+
+  MomentAccumulator first, second;
+  for (size_t i = 0; i < 3000; i += 313)
+    first.Update(dataset.cols(i, std::min((size_t) 2999, i + 312)));
+  second.Update(dataset.cols(3000, 5002));
+  first.Merge(second);
+
+  BOOST_REQUIRE_EQUAL(first.Count(), 5003);
+  BOOST_REQUIRE_EQUAL(first.Dimensionality(), 4);
+  for (size_t d = 0; d < 4; ++d)
+  {
+    const arma::rowvec x = dataset.row(d);
+    const double mean = arma::mean(x);
+    const arma::rowvec deviations = x - mean;
+    const double n = x.n_elem;
+    const double m2 = arma::accu(arma::square(deviations));
+    const double m3 = arma::accu(arma::pow(deviations, 3.0));
+    const double m4 = arma::accu(arma::pow(deviations, 4.0));
+    const double s = std::sqrt(m2 / n);
+
+    BOOST_REQUIRE_CLOSE(first.Mean()[d], mean, 1e-8);
+    BOOST_REQUIRE_CLOSE(first.Variance()[d], arma::var(x), 1e-6);
+    BOOST_REQUIRE_CLOSE(first.Variance(true)[d], arma::var(x, 1), 1e-6);
+    BOOST_REQUIRE_CLOSE(first.Stddev()[d], arma::stddev(x), 1e-6);
+    BOOST_REQUIRE_CLOSE(first.Skewness(true)[d], m3 / (n * s * s * s), 1e-5);
+    BOOST_REQUIRE_CLOSE(first.Kurtosis(true)[d], n * m4 / (m2 * m2) - 3.0,
+        1e-5);
+    BOOST_REQUIRE_EQUAL(first.Min()[d], arma::min(x));
+    BOOST_REQUIRE_EQUAL(first.Max()[d], arma::max(x));
+  }
+
+  // Points of the wrong dimensionality can't be added.
+  BOOST_REQUIRE_THROW(first.Update(arma::mat(3, 10)), std::invalid_argument);
+}
+
+/**
+ * Make sure the quantiles of a QuantileSketch are exact for few values, and
+ * close in rank for many values.
+ */
+BOOST_AUTO_TEST_CASE(QuantileSketchTest)
+{
+  QuantileSketch small;
+  for (size_t i = 1; i <= 10; ++i)
+    small.Insert((double) i);
+  BOOST_REQUIRE_CLOSE(small.Quantile(0.5), 5.5, 1e-10);
+  BOOST_REQUIRE_CLOSE(small.Quantile(0.0), 1.0, 1e-10);
+  BOOST_REQUIRE_CLOSE(small.Quantile(1.0), 10.0, 1e-10);
+
+  // A permutation of 0, ..., n - 1, inserted into two sketches; the value of
+  // each quantile is then its rank.
+  const size_t n = 200000;
+  arma::uvec order = arma::shuffle(arma::regspace<arma::uvec>(0, n - 1));
+  QuantileSketch first(256), second(256);
+  for (size_t i = 0; i < n; ++i)
+    ((i % 2 == 0) ? first : second).Insert((double) order[i]);
+  first.Merge(second);
+
+  BOOST_REQUIRE_EQUAL(first.Count(), n);
+  for (const double q : { 0.01, 0.25, 0.5, 0.75, 0.99 })
+    BOOST_REQUIRE_SMALL(first.Quantile(q) / (n - 1) - q, 0.02);
+
+  BOOST_REQUIRE_THROW(QuantileSketch().Quantile(0.5), std::invalid_argument);
+}
+
+/**
+ * Make sure the estimate of a CardinalitySketch is close to the number of
+ * distinct values, for a few values and for many.
+ */
+BOOST_AUTO_TEST_CASE(CardinalitySketchTest)
+{
+  CardinalitySketch small;
+  for (size_t i = 0; i < 1000; ++i)
+    small.Insert((double) (i % 20));
+  small.Insert(-0.0);
+  BOOST_REQUIRE_SMALL(small.Estimate() - 20.0, 1.0);
+
+  CardinalitySketch first, second;
+  for (size_t i = 0; i < 100000; ++i)
+  {
+    first.Insert(0.5 * i);
+    second.Insert(0.5 * (i + 50000));
+  }
+  first.Merge(second);
+  BOOST_REQUIRE_CLOSE(first.Estimate(), 150000.0, 6.0);
+
+  BOOST_REQUIRE_THROW(first.Merge(CardinalitySketch(10)),
+      std::invalid_argument);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
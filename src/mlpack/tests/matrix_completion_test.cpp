@@ -11,6 +11,7 @@
  */
 #include <mlpack/core.hpp>
 #include <mlpack/methods/matrix_completion/matrix_completion.hpp>
+#include <mlpack/methods/matrix_completion/soft_impute.hpp>
 
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
@@ -64,4 +65,43 @@ BOOST_AUTO_TEST_CASE(UniformMatrixCompletionSDP)
   }
 }
 
+/**
+ * Recover a random low-rank matrix from about two thirds of its entries with
+ * SoftImpute, and make sure the unknown entries are close.
+ */
+BOOST_AUTO_TEST_CASE(SoftImputeLowRankTest)
+{
+  const arma::mat Xorig = arma::randu<arma::mat>(60, 2) *
+      arma::randu<arma::mat>(2, 50);
+
+  std::vector<size_t> known;
+  for (size_t i = 0; i < Xorig.n_elem; ++i)
+    if (math::Random() < 0.65)
+      known.push_back(i);
+
+  arma::umat indices(2, known.size());
+  arma::vec values(known.size());
+  for (size_t i = 0; i < known.size(); ++i)
+  {
+    indices(0, i) = known[i] % Xorig.n_rows;
+    indices(1, i) = known[i] / Xorig.n_rows;
+    values[i] = Xorig[known[i]];
+  }
+
+  SoftImpute si(Xorig.n_rows, Xorig.n_cols, indices, values, 1e-3, 5, 1000,
+      1e-10);
+  arma::mat u, v;
+  arma::vec s;
+  si.Recover(u, s, v);
+
+  BOOST_REQUIRE_EQUAL(u.n_rows, Xorig.n_rows);
+  BOOST_REQUIRE_EQUAL(v.n_rows, Xorig.n_cols);
+  BOOST_REQUIRE_LE(s.n_elem, 5);
+
+  const arma::mat recovered = u * arma::diagmat(s) * v.t();
+  const double err = arma::norm(Xorig - recovered, "fro") /
+      arma::norm(Xorig, "fro");
+  BOOST_REQUIRE_SMALL(err, 0.05);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -144,4 +144,40 @@ BOOST_AUTO_TEST_CASE(GaussianClustering)
       BOOST_REQUIRE_NE(minIndices[i], minIndices[j]);
 }
 
+#ifdef HAS_OPENMP
+/**
+ * Make sure that mean shift gives the same centroids and assignments with one
+ * thread and with four threads, with and without seeds.
+ */
+BOOST_AUTO_TEST_CASE(ParallelMeanShiftTest)
+{
+  arma::mat dataset(2, 1000, arma::fill::randu);
+  dataset.cols(500, 999) += 3.0;
+  const size_t prevNumThreads = omp_get_max_threads();
+
+  for (size_t useSeeds = 0; useSeeds < 2; ++useSeeds)
+  {
+    MeanShift<> meanShift(0.8);
+    arma::Col<size_t> assignments, parallelAssignments;
+    arma::mat centroids, parallelCentroids;
+
+    omp_set_num_threads(1);
+    meanShift.Cluster(dataset, assignments, centroids, useSeeds == 1);
+
+    omp_set_num_threads(4);
+    meanShift.Cluster(dataset, parallelAssignments, parallelCentroids,
+        useSeeds == 1);
+
+    BOOST_REQUIRE_GE(centroids.n_cols, 2);
+    BOOST_REQUIRE_EQUAL(centroids.n_cols, parallelCentroids.n_cols);
+    for (size_t i = 0; i < centroids.n_elem; ++i)
+      BOOST_REQUIRE_EQUAL(centroids[i], parallelCentroids[i]);
+    for (size_t i = 0; i < assignments.n_elem; ++i)
+      BOOST_REQUIRE_EQUAL(assignments[i], parallelAssignments[i]);
+  }
+
+  omp_set_num_threads(prevNumThreads);
+}
+#endif
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -87,4 +87,60 @@ BOOST_AUTO_TEST_CASE(LINFMetricTest)
                       lMetric.Evaluate(a2, b2), 1e-5);
 }
 
+/**
+ * Make sure the dense column overloads of LMetric give the same results as the
+ * generic implementation, for dimensionalities that don't divide evenly into
+ * the unrolled loops.
+ */
+template<typename MatType>
+void CheckDenseColumns(const size_t dimensionality)
+{
+  typedef typename MatType::elem_type ElemType;
+
+  MatType data(dimensionality, 5);
+  data.randn();
+
+  for (size_t i = 0; i < data.n_cols; ++i)
+  {
+    for (size_t j = 0; j < data.n_cols; ++j)
+    {
+      const arma::Col<ElemType> a = data.col(i);
+      const arma::Col<ElemType> b = data.col(j);
+      const arma::Col<ElemType> diff = arma::abs(a - b);
+
+      const double l1 = arma::accu(diff);
+      const double l2Squared = arma::accu(arma::square(diff));
+      const double lInf = arma::as_scalar(arma::max(diff));
+
+      BOOST_REQUIRE_CLOSE((double) ManhattanDistance::Evaluate(a, b), l1,
+          1e-3);
+      BOOST_REQUIRE_CLOSE((double) ManhattanDistance::Evaluate(data.col(i),
+          data.col(j)), l1, 1e-3);
+      BOOST_REQUIRE_CLOSE((double) SquaredEuclideanDistance::Evaluate(
+          data.unsafe_col(i), data.unsafe_col(j)), l2Squared, 1e-3);
+      BOOST_REQUIRE_CLOSE((double) EuclideanDistance::Evaluate(a, b),
+          std::sqrt(l2Squared), 1e-3);
+      BOOST_REQUIRE_CLOSE((double) EuclideanDistance::Evaluate(data.col(i),
+          data.col(j)), std::sqrt(l2Squared), 1e-3);
+      BOOST_REQUIRE_CLOSE((double) ChebyshevDistance::Evaluate(a, b), lInf,
+          1e-3);
+      BOOST_REQUIRE_CLOSE((double) ChebyshevDistance::Evaluate(data.col(i),
+          data.col(j)), lInf, 1e-3);
+      BOOST_REQUIRE_CLOSE((double) LMetric<3, true>::Evaluate(data.col(i),
+          data.col(j)), std::pow(arma::accu(arma::pow(diff, 3)), 1.0 / 3.0),
+          1e-3);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(LMetricDenseColumnTest)
+{
+  const size_t dimensionalities[] = { 1, 2, 3, 4, 7, 13, 64 };
+  for (size_t d : dimensionalities)
+  {
+    CheckDenseColumns<arma::mat>(d);
+    CheckDenseColumns<arma::fmat>(d);
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
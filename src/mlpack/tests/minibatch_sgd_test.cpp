@@ -12,6 +12,7 @@
 #include <mlpack/core.hpp>
 #include <mlpack/core/optimizers/sgd/sgd.hpp>
 #include <mlpack/core/optimizers/minibatch_sgd/minibatch_sgd.hpp>
+#include <mlpack/core/optimizers/adam/adam_update.hpp>
 #include <mlpack/core/optimizers/lbfgs/test_functions.hpp>
 #include <mlpack/core/optimizers/sgd/test_function.hpp>
 
@@ -159,4 +160,143 @@ BOOST_AUTO_TEST_CASE(ZeroBatchSizeTest)
   BOOST_REQUIRE_EQUAL(finite, true);
 }
 
+/**
+ * Make sure that the epoch decay policies change the step size as documented.
+ */
+BOOST_AUTO_TEST_CASE(EpochDecayPoliciesTest)
+{
+  arma::mat iterate;
+
+  // The step decay halves the step size every other epoch.
+  StepDecay step(2, 0.5);
+  double stepSize = 1.0;
+  for (size_t epoch = 1; epoch <= 5; ++epoch)
+  {
+    step.EpochUpdate(iterate, stepSize, 1.0);
+    BOOST_REQUIRE_CLOSE(stepSize, std::pow(0.5, epoch / 2), 1e-10);
+  }
+
+  // The exponential decay is bounded below.
+  ExponentialDecay exponential(1.0, 0.1);
+  stepSize = 1.0;
+  exponential.EpochUpdate(iterate, stepSize, 1.0);
+  BOOST_REQUIRE_CLOSE(stepSize, std::exp(-1.0), 1e-10);
+  exponential.EpochUpdate(iterate, stepSize, 1.0);
+  exponential.EpochUpdate(iterate, stepSize, 1.0);
+  BOOST_REQUIRE_CLOSE(stepSize, 0.1, 1e-10);
+
+  // The plateau decay only decays when the objective stops improving for
+  // the given number of epochs.
+  PlateauDecay plateau(2, 0.1, 1e-4);
+  stepSize = 1.0;
+  plateau.EpochUpdate(iterate, stepSize, 10.0);
+  plateau.EpochUpdate(iterate, stepSize, 9.0);
+  plateau.EpochUpdate(iterate, stepSize, 9.0);
+  BOOST_REQUIRE_CLOSE(stepSize, 1.0, 1e-10);
+  plateau.EpochUpdate(iterate, stepSize, 9.5);
+  BOOST_REQUIRE_CLOSE(stepSize, 0.1, 1e-10);
+  plateau.EpochUpdate(iterate, stepSize, 8.0);
+  plateau.EpochUpdate(iterate, stepSize, 8.0);
+  BOOST_REQUIRE_CLOSE(stepSize, 0.1, 1e-10);
+}
+
+/**
+ * Run mini-batch SGD with each epoch decay policy on logistic regression, and
+ * make sure the step size is decayed and the results are acceptable.
+ */
+BOOST_AUTO_TEST_CASE(EpochDecayLogisticRegressionTest)
+{
+  GaussianDistribution g1(arma::vec("1.0 1.0 1.0"), arma::eye<arma::mat>(3, 3));
+  GaussianDistribution g2(arma::vec("9.0 9.0 9.0"), arma::eye<arma::mat>(3, 3));
+
+  arma::mat data(3, 500);
+  arma::Row<size_t> responses(500);
+  for (size_t i = 0; i < 250; ++i)
+  {
+    data.col(i) = g1.Random();
+    responses[i] = 0;
+  }
+  for (size_t i = 250; i < 500; ++i)
+  {
+    data.col(i) = g2.Random();
+    responses[i] = 1;
+  }
+
+  LogisticRegressionFunction<> lrf(data, responses, 0.5);
+
+  // 100 passes over the data.
+  MiniBatchSGDType<LogisticRegressionFunction<>, VanillaUpdate, StepDecay>
+      stepSGD(lrf, 10, 0.01, 5000, -1, true, VanillaUpdate(), StepDecay(10));
+  MiniBatchSGDType<LogisticRegressionFunction<>, VanillaUpdate,
+      ExponentialDecay> exponentialSGD(lrf, 10, 0.01, 5000, -1, true,
+      VanillaUpdate(), ExponentialDecay(0.05));
+  MiniBatchSGDType<LogisticRegressionFunction<>, VanillaUpdate, PlateauDecay>
+      plateauSGD(lrf, 10, 0.01, 5000, -1, true, VanillaUpdate(),
+      PlateauDecay(2, 0.5, 1e-2));
+
+  LogisticRegression<> stepLR(data.n_rows, 0.5);
+  stepLR.Train(stepSGD);
+  BOOST_REQUIRE_LT(stepSGD.StepSize(), 0.01);
+  BOOST_REQUIRE_CLOSE(stepLR.ComputeAccuracy(data, responses), 100.0, 0.3);
+
+  LogisticRegression<> exponentialLR(data.n_rows, 0.5);
+  exponentialLR.Train(exponentialSGD);
+  BOOST_REQUIRE_LT(exponentialSGD.StepSize(), 0.01);
+  BOOST_REQUIRE_CLOSE(exponentialLR.ComputeAccuracy(data, responses), 100.0,
+      0.3);
+
+  LogisticRegression<> plateauLR(data.n_rows, 0.5);
+  plateauLR.Train(plateauSGD);
+  BOOST_REQUIRE_LT(plateauSGD.StepSize(), 0.01);
+  BOOST_REQUIRE_CLOSE(plateauLR.ComputeAccuracy(data, responses), 100.0, 0.3);
+}
+
+/**
+ * Make sure that training that is stopped, checkpointed and resumed gives the
+ * same result as training that is never stopped, with an update policy that
+ * has a state (the moment estimates and the step counter of Adam).
+ */
+BOOST_AUTO_TEST_CASE(CheckpointResumeTest)
+{
+  SGDTestFunction f;
+
+  // 30 mini-batches (10 passes) at a time; the tolerance is negative so that
+  // the optimization never terminates early.
+  typedef MiniBatchSGDType<SGDTestFunction, AdamUpdate> OptimizerType;
+  OptimizerType optimizer(f, 1, 0.01, 31, -1.0, false);
+  optimizer.Checkpoint("minibatch_sgd_checkpoint.bin", 3);
+
+  arma::mat coordinates = f.GetInitialPoint();
+  optimizer.Optimize(coordinates);
+
+  // The checkpoint is written by the time Optimize() returns.
+  arma::mat resumedCoordinates;
+  OptimizerType resumed(f, 1, 0.01, 31, -1.0, false);
+  BOOST_REQUIRE(resumed.Resume("minibatch_sgd_checkpoint.bin",
+      resumedCoordinates));
+  BOOST_REQUIRE_EQUAL(resumed.ResetPolicy(), false);
+  BOOST_REQUIRE_EQUAL(resumed.Passes(), optimizer.Passes());
+  CheckMatrices(resumedCoordinates, coordinates);
+
+  const double resumedObjective = resumed.Optimize(resumedCoordinates);
+
+  // Now train for the 60 mini-batches at once.
+  OptimizerType continuous(f, 1, 0.01, 61, -1.0, false);
+  arma::mat continuousCoordinates = f.GetInitialPoint();
+  const double continuousObjective =
+      continuous.Optimize(continuousCoordinates);
+
+  BOOST_REQUIRE_CLOSE(resumedObjective, continuousObjective, 1e-5);
+  CheckMatrices(resumedCoordinates, continuousCoordinates);
+
+  // If the policy is reset instead, the result is different.
+  OptimizerType restarted(f, 1, 0.01, 31, -1.0, false);
+  arma::mat restartedCoordinates = coordinates;
+  restarted.Optimize(restartedCoordinates);
+  BOOST_REQUIRE_GT(arma::norm(restartedCoordinates - continuousCoordinates),
+      1e-5);
+
+  remove("minibatch_sgd_checkpoint.bin");
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -314,4 +314,95 @@ BOOST_AUTO_TEST_CASE(SeparateTrainIndividualIncrementalTest)
   }
 }
 
+/**
+ * Make sure that incremental training on chunks of a dataset gives the same
+ * model as training on the whole dataset, and that classifying the points in
+ * a batch gives the same results as classifying them one by one.
+ */
+BOOST_AUTO_TEST_CASE(ChunkedIncrementalTrainTest)
+{
+  // Enough points for the training to be split into several blocks.
+  arma::mat data = arma::randu<arma::mat>(5, 5000);
+  arma::Row<size_t> labels(5000);
+  for (size_t i = 0; i < 5000; ++i)
+  {
+    labels[i] = math::RandInt(3);
+    data.col(i) += 3.0 * labels[i];
+  }
+
+  NaiveBayesClassifier<> nbc(data, labels, 3, false);
+  NaiveBayesClassifier<> nbcChunks(data.n_rows, 3);
+  nbcChunks.Train(data.cols(0, 1499), labels.subvec(0, 1499), true);
+  nbcChunks.Train(data.cols(1500, 1500), labels.subvec(1500, 1500), true);
+  nbcChunks.Train(data.cols(1501, 4999), labels.subvec(1501, 4999), true);
+
+  for (size_t i = 0; i < nbc.Means().n_elem; ++i)
+    BOOST_REQUIRE_CLOSE(nbc.Means()[i], nbcChunks.Means()[i], 1e-5);
+  for (size_t i = 0; i < nbc.Variances().n_elem; ++i)
+    BOOST_REQUIRE_CLOSE(nbc.Variances()[i], nbcChunks.Variances()[i], 1e-5);
+  for (size_t i = 0; i < nbc.Probabilities().n_elem; ++i)
+    BOOST_REQUIRE_CLOSE(nbc.Probabilities()[i], nbcChunks.Probabilities()[i],
+        1e-5);
+
+  arma::Row<size_t> predictions;
+  arma::mat probabilities;
+  nbc.Classify(data, predictions, probabilities);
+
+  for (size_t i = 0; i < data.n_cols; ++i)
+  {
+    size_t prediction;
+    arma::vec pointProbabilities;
+    nbc.Classify(data.col(i), prediction, pointProbabilities);
+
+    BOOST_REQUIRE_EQUAL(predictions[i], prediction);
+    for (size_t j = 0; j < 3; ++j)
+    {
+      if (pointProbabilities[j] < 1e-5)
+        BOOST_REQUIRE_SMALL(probabilities(j, i), 1e-5);
+      else
+        BOOST_REQUIRE_CLOSE(probabilities(j, i), pointProbabilities[j], 1e-5);
+    }
+  }
+}
+
+/**
+ * Make sure that training on the blocks of a ChunkedReader gives the same
+ * model as training on the whole dataset at once.
+ */
+BOOST_AUTO_TEST_CASE(NaiveBayesChunkedReaderTest)
+{
+  arma::mat data(4, 1000, arma::fill::randn);
+  arma::Row<size_t> labels(data.n_cols);
+  for (size_t i = 0; i < data.n_cols; ++i)
+  {
+    labels[i] = math::RandInt(3);
+    data.col(i) += 3.0 * labels[i];
+  }
+
+  // The labels are stored as the last dimension.
+  arma::mat dataset = arma::join_cols(data,
+      arma::conv_to<arma::rowvec>::from(labels));
+  data::Save("test.bin", dataset);
+
+  NaiveBayesClassifier<> nbc(data, labels, 3, false);
+  NaiveBayesClassifier<> nbcReader(data.n_rows, 3);
+  data::ChunkedReader reader("test.bin", 128, true);
+  nbcReader.Train(reader, false);
+
+  for (size_t i = 0; i < nbc.Means().n_elem; ++i)
+    BOOST_REQUIRE_CLOSE(nbc.Means()[i], nbcReader.Means()[i], 1e-5);
+  for (size_t i = 0; i < nbc.Variances().n_elem; ++i)
+    BOOST_REQUIRE_CLOSE(nbc.Variances()[i], nbcReader.Variances()[i], 1e-5);
+  for (size_t i = 0; i < nbc.Probabilities().n_elem; ++i)
+    BOOST_REQUIRE_CLOSE(nbc.Probabilities()[i], nbcReader.Probabilities()[i],
+        1e-5);
+
+  // A reader without a row of labels is rejected.
+  data::Save("test.bin", data);
+  data::ChunkedReader badReader("test.bin", 128);
+  BOOST_REQUIRE_THROW(nbcReader.Train(badReader), std::invalid_argument);
+
+  remove("test.bin");
+}
+
 BOOST_AUTO_TEST_SUITE_END();
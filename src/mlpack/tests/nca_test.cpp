@@ -249,6 +249,79 @@ BOOST_AUTO_TEST_CASE(SoftmaxSeparableGradient)
   BOOST_REQUIRE_CLOSE(gradient(1, 1), -2.0 * -0.1435886, 0.01);
 }
 
+/**
+ * On a dataset large enough to be split into several blocks, the
+ * non-separable objective and gradient must be the sums of the separable ones.
+ */
+BOOST_AUTO_TEST_CASE(SoftmaxBlockedGradient)
+{
+  arma::mat data;
+  data.randu(3, 300);
+  arma::Row<size_t> labels(300);
+  for (size_t i = 0; i < labels.n_elem; ++i)
+    labels[i] = (data(0, i) + data(2, i) > 1.0) ? 1 : 0;
+
+  SoftmaxErrorFunction<SquaredEuclideanDistance> sef(data, labels);
+
+  arma::mat coordinates;
+  coordinates.randu(3, 3);
+
+  double objective = 0.0;
+  arma::mat sumGradient(3, 3, arma::fill::zeros), pointGradient;
+  for (size_t i = 0; i < data.n_cols; ++i)
+  {
+    objective += sef.Evaluate(coordinates, i);
+    sef.Gradient(coordinates, i, pointGradient);
+    sumGradient += pointGradient;
+  }
+
+  arma::mat gradient;
+  sef.Gradient(coordinates, gradient);
+
+  BOOST_REQUIRE_CLOSE(sef.Evaluate(coordinates), objective, 1e-5);
+  CheckMatrices(gradient, sumGradient, 1e-5);
+}
+
+/**
+ * When the classes are far apart, truncating the softmax to the nearest
+ * neighbors of each point loses almost nothing.
+ */
+BOOST_AUTO_TEST_CASE(SoftmaxApproximateNeighbors)
+{
+  // Three tight clusters of 20 points, each with both labels.
+  arma::mat data(2, 60);
+  arma::Row<size_t> labels(60);
+  for (size_t i = 0; i < 60; ++i)
+  {
+    data.col(i) = 0.3 * arma::randn<arma::vec>(2) +
+        100.0 * (i / 20) * arma::ones<arma::vec>(2);
+    labels[i] = (data(0, i) > 100.0 * (i / 20)) ? 1 : 0;
+  }
+
+  SoftmaxErrorFunction<SquaredEuclideanDistance> exact(data, labels);
+  SoftmaxErrorFunction<SquaredEuclideanDistance> approximate(data, labels);
+  approximate.Neighbors() = 25;
+
+  const arma::mat coordinates = arma::eye<arma::mat>(2, 2);
+
+  BOOST_REQUIRE_CLOSE(approximate.Evaluate(coordinates),
+      exact.Evaluate(coordinates), 1e-5);
+
+  arma::mat exactGradient, approximateGradient;
+  exact.Gradient(coordinates, exactGradient);
+  approximate.Gradient(coordinates, approximateGradient);
+  CheckMatrices(approximateGradient, exactGradient, 1e-3);
+
+  // Changing the number of neighbors changes the result, even for the same
+  // coordinates.
+  approximate.Neighbors() = 2;
+  BOOST_REQUIRE_GT(std::abs(approximate.Evaluate(coordinates) -
+      exact.Evaluate(coordinates)), 1e-5);
+  approximate.Neighbors() = 0;
+  BOOST_REQUIRE_CLOSE(approximate.Evaluate(coordinates),
+      exact.Evaluate(coordinates), 1e-10);
+}
+
 //
 // Tests for the NCA algorithm.
 //
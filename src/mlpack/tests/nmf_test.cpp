@@ -16,6 +16,11 @@
 #include <mlpack/methods/amf/update_rules/nmf_mult_div.hpp>
 #include <mlpack/methods/amf/update_rules/nmf_als.hpp>
 #include <mlpack/methods/amf/update_rules/nmf_mult_dist.hpp>
+#include <mlpack/methods/amf/update_rules/nmf_mult_dist_blocked.hpp>
+#include <mlpack/methods/amf/update_rules/nmf_mult_div_blocked.hpp>
+#include <mlpack/methods/amf/update_rules/sparse_als.hpp>
+#include <mlpack/methods/amf/termination_policies/max_iteration_termination.hpp>
+#include <mlpack/methods/amf/termination_policies/sparse_residue_termination.hpp>
 
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
@@ -220,4 +225,155 @@ BOOST_AUTO_TEST_CASE(SparseNMFALSTest)
       1e-5);
 }
 
+/**
+ * Make sure that sparse ALS recovers a low-rank matrix from some of its
+ * entries, and gives the same factorization for a sparse matrix and its dense
+ * copy.
+ */
+BOOST_AUTO_TEST_CASE(SparseALSTest)
+{
+  const mat w0 = randu<mat>(50, 3);
+  const mat h0 = randu<mat>(3, 40);
+  const mat full = w0 * h0;
+
+  // Observe 40% of the entries.
+  const mat mask = conv_to<mat>::from(randu<mat>(50, 40) < 0.4);
+  sp_mat v(full % mask);
+  mat dv(v);
+
+  MaxIterationTermination mit(50);
+  AMF<MaxIterationTermination, RandomAcolInitialization<>, SparseALSUpdate>
+      als(mit, RandomAcolInitialization<>(), SparseALSUpdate(1e-5));
+
+  mat w, h, dw, dh;
+  const size_t seed = mlpack::math::RandInt(1000000);
+  mlpack::math::RandomSeed(seed);
+  als.Apply(v, 3, w, h);
+  mlpack::math::RandomSeed(seed);
+  als.Apply(dv, 3, dw, dh);
+
+  const mat vp = w * h;
+  BOOST_REQUIRE_SMALL(norm((vp - full) % mask, "fro") /
+      norm(full % mask, "fro"), 0.01);
+  BOOST_REQUIRE_SMALL(norm((vp - full) % (1 - mask), "fro") /
+      norm(full % (1 - mask), "fro"), 0.1);
+
+  BOOST_REQUIRE_SMALL(norm(vp - dw * dh, "fro") / norm(vp, "fro"), 1e-5);
+}
+
+/**
+ * Make sure that implicit sparse ALS estimates the observed entries (the
+ * preferences of 1) higher than the others.
+ */
+BOOST_AUTO_TEST_CASE(SparseImplicitALSTest)
+{
+  // Two blocks of users, each of which interacted with its own block of items.
+  sp_mat v(60, 40);
+  for (size_t j = 0; j < 40; ++j)
+    for (size_t i = (j < 20) ? 0 : 30; i < ((j < 20) ? 30 : 60); ++i)
+      v(i, j) = 1.0 + (i % 3);
+
+  MaxIterationTermination mit(20);
+  AMF<MaxIterationTermination, RandomAcolInitialization<>, SparseALSUpdate>
+      als(mit, RandomAcolInitialization<>(), SparseALSUpdate(0.1, 10.0));
+
+  mat w, h;
+  als.Apply(v, 2, w, h);
+  const mat vp = w * h;
+
+  const mat observed = conv_to<mat>::from(mat(v) != 0.0);
+  BOOST_REQUIRE(vp.is_finite());
+  BOOST_REQUIRE_GT(accu(vp % observed) / accu(observed),
+      accu(vp % (1 - observed)) / accu(1 - observed) + 0.5);
+}
+
+/**
+ * Make sure the error on the observed entries is computed correctly for sparse
+ * and dense matrices, and that sparse ALS converges with it when the error is
+ * only checked every few iterations.
+ */
+BOOST_AUTO_TEST_CASE(SparseResidueTerminationTest)
+{
+  const mat w0 = randu<mat>(50, 3);
+  const mat h0 = randu<mat>(3, 40);
+  const mat mask = conv_to<mat>::from(randu<mat>(50, 40) < 0.4);
+  sp_mat v((w0 * h0) % mask);
+  const mat dv(v);
+
+  // The error of another factorization, computed from W * H.
+  const mat w = randu<mat>(50, 3);
+  const mat h = randu<mat>(3, 40);
+  const double expected = std::sqrt(accu(square((dv - w * h) % mask)) /
+      accu(mask));
+  BOOST_REQUIRE_CLOSE(SparseResidueTermination<>::ObservedRMSE(v, w, h),
+      expected, 1e-8);
+  BOOST_REQUIRE_CLOSE(SparseResidueTermination<mat>::ObservedRMSE(dv, w, h),
+      expected, 1e-8);
+
+  SparseResidueTermination<> srt(1e-4, 1000, 5);
+  AMF<SparseResidueTermination<>, RandomAcolInitialization<>, SparseALSUpdate>
+      als(srt, RandomAcolInitialization<>(), SparseALSUpdate(1e-5));
+
+  mat wa, ha;
+  als.Apply(v, 3, wa, ha);
+
+  BOOST_REQUIRE_LT(als.TerminationPolicy().Iteration(), 1000);
+  BOOST_REQUIRE_SMALL(als.TerminationPolicy().Index(), 0.02);
+  BOOST_REQUIRE_CLOSE(als.TerminationPolicy().Index(),
+      SparseResidueTermination<>::ObservedRMSE(v, wa, ha), 1e-5);
+}
+
+/**
+ * Make sure the blocked multiplicative update rules take the same steps as the
+ * element-wise rules, for dense and sparse matrices, including when the block
+ * size doesn't divide the number of columns.
+ */
+BOOST_AUTO_TEST_CASE(BlockedMultiplicativeUpdateTest)
+{
+  sp_mat sparse;
+  sparse.sprandu(70, 50, 0.3);
+  const mat dense(sparse);
+  const mat w = randu<mat>(70, 5) + 0.1;
+  const mat h = randu<mat>(5, 50) + 0.1;
+
+  // The element-wise rules, on the dense matrix.
+  mat distW = w, distH = h;
+  NMFMultiplicativeDistanceUpdate::WUpdate(dense, distW, distH);
+  NMFMultiplicativeDistanceUpdate::HUpdate(dense, distW, distH);
+  mat divW = w, divH = h;
+  NMFMultiplicativeDivergenceUpdate::WUpdate(dense, divW, divH);
+  NMFMultiplicativeDivergenceUpdate::HUpdate(dense, divW, divH);
+
+  for (size_t s = 0; s < 2; ++s)
+  {
+    BlockedNMFMultiplicativeDistanceUpdate dist(16);
+    BlockedNMFMultiplicativeDivergenceUpdate div(16);
+    mat blockedDistW = w, blockedDistH = h;
+    mat blockedDivW = w, blockedDivH = h;
+    if (s == 0)
+    {
+      dist.Initialize(dense, 5);
+      dist.WUpdate(dense, blockedDistW, blockedDistH);
+      dist.HUpdate(dense, blockedDistW, blockedDistH);
+      div.Initialize(dense, 5);
+      div.WUpdate(dense, blockedDivW, blockedDivH);
+      div.HUpdate(dense, blockedDivW, blockedDivH);
+    }
+    else
+    {
+      dist.Initialize(sparse, 5);
+      dist.WUpdate(sparse, blockedDistW, blockedDistH);
+      dist.HUpdate(sparse, blockedDistW, blockedDistH);
+      div.Initialize(sparse, 5);
+      div.WUpdate(sparse, blockedDivW, blockedDivH);
+      div.HUpdate(sparse, blockedDivW, blockedDivH);
+    }
+
+    CheckMatrices(blockedDistW, distW, 1e-7);
+    CheckMatrices(blockedDistH, distH, 1e-7);
+    CheckMatrices(blockedDivW, divW, 1e-7);
+    CheckMatrices(blockedDivH, divH, 1e-7);
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
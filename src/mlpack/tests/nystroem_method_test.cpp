@@ -18,6 +18,7 @@
 #include <mlpack/methods/nystroem_method/ordered_selection.hpp>
 #include <mlpack/methods/nystroem_method/random_selection.hpp>
 #include <mlpack/methods/nystroem_method/kmeans_selection.hpp>
+#include <mlpack/methods/nystroem_method/kmeans_plus_plus_selection.hpp>
 #include <mlpack/methods/nystroem_method/nystroem_method.hpp>
 
 using namespace mlpack;
@@ -202,4 +203,135 @@ BOOST_AUTO_TEST_CASE(GermanTest)
   }
 }
 
+/**
+ * Make sure the blocked kernel evaluation gives the same mini-kernel and
+ * semi-kernel matrices as evaluating the kernel on each pair of points, for
+ * more points than fit in one block, with a squared distance kernel, an inner
+ * product kernel, and a kernel with neither property.
+ */
+template<typename KernelType>
+void CheckBlockedKernelMatrix(KernelType& kernel)
+{
+  arma::mat data;
+  data.randu(4, 2500);
+
+  arma::Col<size_t> selectedPoints;
+  selectedPoints << 3 << 1200 << 2499 << 17 << 1024 << 800 << 5 << 2048;
+
+  NystroemMethod<KernelType, RandomSelection> nm(data, kernel,
+      selectedPoints.n_elem);
+
+  arma::mat miniKernel, semiKernel;
+  nm.GetKernelMatrix(selectedPoints, miniKernel, semiKernel);
+
+  BOOST_REQUIRE_EQUAL(miniKernel.n_rows, selectedPoints.n_elem);
+  BOOST_REQUIRE_EQUAL(miniKernel.n_cols, selectedPoints.n_elem);
+  BOOST_REQUIRE_EQUAL(semiKernel.n_rows, data.n_cols);
+  BOOST_REQUIRE_EQUAL(semiKernel.n_cols, selectedPoints.n_elem);
+
+  for (size_t j = 0; j < selectedPoints.n_elem; ++j)
+  {
+    for (size_t i = 0; i < selectedPoints.n_elem; ++i)
+    {
+      const double value = kernel.Evaluate(data.col(selectedPoints[i]),
+          data.col(selectedPoints[j]));
+      if (std::abs(value) < 1e-8)
+        BOOST_REQUIRE_SMALL(miniKernel(i, j), 1e-8);
+      else
+        BOOST_REQUIRE_CLOSE(miniKernel(i, j), value, 1e-5);
+    }
+
+    for (size_t i = 0; i < data.n_cols; ++i)
+    {
+      const double value = kernel.Evaluate(data.col(i),
+          data.col(selectedPoints[j]));
+      if (std::abs(value) < 1e-8)
+        BOOST_REQUIRE_SMALL(semiKernel(i, j), 1e-8);
+      else
+        BOOST_REQUIRE_CLOSE(semiKernel(i, j), value, 1e-5);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(BlockedKernelMatrixTest)
+{
+  GaussianKernel gk(0.5);
+  CheckBlockedKernelMatrix(gk);
+
+  PolynomialKernel pk(2.0, 1.0);
+  CheckBlockedKernelMatrix(pk);
+
+  TriangularKernel tk(2.0);
+  CheckBlockedKernelMatrix(tk);
+}
+
+/**
+ * Make sure the k-means++ selection selects distinct points when there are
+ * enough distinct points, and that all of them are valid indices.
+ */
+BOOST_AUTO_TEST_CASE(KMeansPlusPlusSelectionTest)
+{
+  arma::mat data;
+  data.randu(3, 300);
+
+  arma::Col<size_t> selectedPoints = KMeansPlusPlusSelection::Select(data, 40);
+
+  BOOST_REQUIRE_EQUAL(selectedPoints.n_elem, 40);
+  BOOST_REQUIRE_EQUAL(arma::Col<size_t>(arma::unique(selectedPoints)).n_elem,
+      40);
+  BOOST_REQUIRE_LT(arma::max(selectedPoints), data.n_cols);
+
+  // With only three distinct points, all of them must be selected first.
+  arma::mat copies(2, 90);
+  for (size_t i = 0; i < 90; ++i)
+    copies.col(i) = arma::vec("0.0 1.0") * double(i % 3);
+
+  selectedPoints = KMeansPlusPlusSelection::Select(copies, 5);
+  std::set<size_t> clusters;
+  for (size_t i = 0; i < 3; ++i)
+    clusters.insert(selectedPoints[i] % 3);
+  BOOST_REQUIRE_EQUAL(clusters.size(), 3);
+}
+
+/**
+ * Make sure the approximation with points selected by k-means++ is about as
+ * good as with the k-means selection on the german dataset (see GermanTest).
+ */
+BOOST_AUTO_TEST_CASE(GermanKMeansPlusPlusTest)
+{
+  arma::mat dataset;
+  data::Load("german.csv", dataset, true);
+
+  GaussianKernel gk(16.461);
+
+  arma::mat kernel(dataset.n_cols, dataset.n_cols);
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+    for (size_t j = 0; j < dataset.n_cols; ++j)
+      kernel(i, j) = gk.Evaluate(dataset.col(i), dataset.col(j));
+
+  // This is a little looser than the tolerance of GermanTest for rank = 0.1n,
+  // since the selected points are not optimized by k-means iterations.
+  double avgError = 0.0;
+  for (size_t z = 1; z < 11; ++z)
+  {
+    NystroemMethod<GaussianKernel, KMeansPlusPlusSelection> nm(dataset, gk,
+        size_t(0.1 * dataset.n_cols));
+    arma::mat g;
+    nm.Apply(g);
+
+    const double error = arma::norm(kernel - g * g.t(), "fro");
+    if (error != error)
+    {
+      // Sometimes K' is singular.  Unlucky.
+      --z;
+      continue;
+    }
+
+    avgError += error;
+  }
+
+  avgError /= 10;
+  BOOST_REQUIRE_LT(avgError, 12.0);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -151,6 +151,37 @@ BOOST_AUTO_TEST_CASE(ReverseMappingsTest)
   }
 }
 
+/**
+ * Check that the points of each node lie in its bound, that the children of
+ * each node hold its points in consecutive ranges, and that no leaf holds too
+ * many points.
+ */
+template<typename TreeType>
+void CheckNodePoints(TreeType& node, const size_t maxLeafSize)
+{
+  for (size_t i = 0; i < node.NumDescendants(); ++i)
+  {
+    BOOST_REQUIRE(node.Bound().Contains(
+        node.Dataset().col(node.Descendant(i))));
+  }
+
+  if (node.NumChildren() == 0)
+  {
+    BOOST_REQUIRE_LE(node.NumPoints(), maxLeafSize);
+    return;
+  }
+
+  size_t offset = 0;
+  for (size_t i = 0; i < node.NumChildren(); ++i)
+  {
+    BOOST_REQUIRE_EQUAL(node.Child(i).Descendant(0),
+        node.Descendant(0) + offset);
+    offset += node.Child(i).NumDescendants();
+    CheckNodePoints(node.Child(i), maxLeafSize);
+  }
+  BOOST_REQUIRE_EQUAL(offset, node.NumDescendants());
+}
+
 /**
  * Make sure no children at the same level are overlapping.
  */
@@ -179,6 +210,39 @@ BOOST_AUTO_TEST_CASE(OverlapTest)
   CheckOverlap(t2);
 }
 
+/**
+ * Build large octrees, in parallel when possible, and check their nodes and
+ * mappings.  The points of the second dataset are so close together that
+ * nodes must still be split past the levels held by the Morton codes.
+ */
+BOOST_AUTO_TEST_CASE(MortonBuildTest)
+{
+  arma::mat dataset(3, 20000, arma::fill::randu);
+  arma::mat clustered = 1e-6 * arma::randu<arma::mat>(8, 3000);
+  clustered.col(0).fill(1.0);
+
+  for (size_t pass = 0; pass < 2; ++pass)
+  {
+    const arma::mat& data = (pass == 0) ? dataset : clustered;
+    std::vector<size_t> oldFromNew;
+    Octree<> t(data, oldFromNew, 5);
+
+    BOOST_REQUIRE_EQUAL(t.NumDescendants(), data.n_cols);
+    BOOST_REQUIRE_GT(t.NumChildren(), 0);
+    CheckNodePoints(t, 5);
+    CheckOverlap(t);
+
+    std::vector<bool> seen(data.n_cols, false);
+    for (size_t i = 0; i < oldFromNew.size(); ++i)
+    {
+      BOOST_REQUIRE(!seen[oldFromNew[i]]);
+      seen[oldFromNew[i]] = true;
+      BOOST_REQUIRE_EQUAL(arma::norm(data.col(oldFromNew[i]) -
+          t.Dataset().col(i)), 0.0);
+    }
+  }
+}
+
 /**
  * Make sure no points are further than the furthest point distance, and that no
  * descendants are further than the furthest descendant distance.
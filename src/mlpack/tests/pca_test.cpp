@@ -16,6 +16,7 @@
 #include <mlpack/methods/pca/decomposition_policies/quic_svd_method.hpp>
 #include <mlpack/methods/pca/decomposition_policies/randomized_svd_method.hpp>
 #include <mlpack/methods/pca/decomposition_policies/randomized_block_krylov_method.hpp>
+#include <mlpack/methods/pca/decomposition_policies/incremental_svd_method.hpp>
 
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
@@ -191,6 +192,15 @@ BOOST_AUTO_TEST_CASE(ArmaComparisonRandomizedPCATest)
   ArmaComparisonPCA<RandomizedSVDPolicy>();
 }
 
+/**
+ * Compare the output of our incremental PCA implementation with Armadillo's.
+ */
+BOOST_AUTO_TEST_CASE(ArmaComparisonIncrementalPCATest)
+{
+  IncrementalSVDPolicy decomposition(128);
+  ArmaComparisonPCA<IncrementalSVDPolicy>(false, decomposition);
+}
+
 /**
  * Test that dimensionality reduction with exact-svd PCA works the same way
  * MATLAB does (which should be correct!).
@@ -220,6 +230,84 @@ BOOST_AUTO_TEST_CASE(RandomizedPCADimensionalityReductionTest)
   PCADimensionalityReduction<RandomizedSVDPolicy>();
 }
 
+/**
+ * Test that dimensionality reduction with incremental PCA works the same way
+ * MATLAB does (which should be correct!), with blocks of two points.
+ */
+BOOST_AUTO_TEST_CASE(IncrementalPCADimensionalityReductionTest)
+{
+  IncrementalSVDPolicy decomposition(2);
+  PCADimensionalityReduction<IncrementalSVDPolicy>(false, decomposition);
+}
+
+/**
+ * Make sure IncrementalPCA finds the leading components of data when it keeps
+ * fewer components than the dimensionality, that merging decompositions of
+ * parts of the data gives the same result as adding the parts one after the
+ * other, and that the total variance is exact.
+ */
+BOOST_AUTO_TEST_CASE(IncrementalPCATruncatedTest)
+{
+  // Points close to a 3-dimensional subspace of a 10-dimensional space.
+  const arma::mat basis = arma::orth(arma::randn<arma::mat>(10, 3));
+  arma::mat data = basis * (arma::diagmat(arma::vec("10 5 2")) *
+      arma::randn<arma::mat>(3, 2000));
+  data += 0.01 * arma::randn<arma::mat>(10, 2000);
+  data.each_col() += arma::linspace<arma::vec>(1, 10, 10);
+
+  IncrementalPCA sequential(3), first(3), second(3);
+  for (size_t begin = 0; begin < 2000; begin += 100)
+  {
+    sequential.Update(data.cols(begin, begin + 99));
+    if (begin < 1000)
+      first.Update(data.cols(begin, begin + 99));
+    else
+      second.Update(data.cols(begin, begin + 99));
+  }
+  first.Merge(second);
+
+  arma::mat coeff, score;
+  arma::vec eigVal;
+  princomp(coeff, score, eigVal, trans(data));
+
+  BOOST_REQUIRE_EQUAL(sequential.Count(), 2000);
+  BOOST_REQUIRE_EQUAL(first.Count(), 2000);
+  BOOST_REQUIRE_EQUAL(sequential.Components().n_cols, 3);
+  BOOST_REQUIRE_CLOSE(sequential.TotalVariance(), arma::accu(eigVal), 1e-5);
+  BOOST_REQUIRE_CLOSE(first.TotalVariance(), arma::accu(eigVal), 1e-5);
+  for (size_t d = 0; d < 10; ++d)
+  {
+    BOOST_REQUIRE_CLOSE(sequential.Mean()[d], arma::mean(data.row(d)), 1e-5);
+    BOOST_REQUIRE_CLOSE(first.Mean()[d], arma::mean(data.row(d)), 1e-5);
+  }
+
+  const arma::vec sequentialEigVal = sequential.Eigenvalues();
+  const arma::vec mergedEigVal = first.Eigenvalues();
+  for (size_t i = 0; i < 3; ++i)
+  {
+    BOOST_REQUIRE_CLOSE(sequentialEigVal[i], eigVal[i], 0.1);
+    BOOST_REQUIRE_CLOSE(mergedEigVal[i], eigVal[i], 0.1);
+    BOOST_REQUIRE_CLOSE(std::abs(arma::dot(sequential.Components().col(i),
+        coeff.col(i))), 1.0, 0.1);
+    BOOST_REQUIRE_CLOSE(std::abs(arma::dot(first.Components().col(i),
+        coeff.col(i))), 1.0, 0.1);
+  }
+
+  // The transformed points are the projections of the centered points.
+  arma::mat transformed;
+  sequential.Transform(data, transformed);
+  BOOST_REQUIRE_EQUAL(transformed.n_rows, 3);
+  BOOST_REQUIRE_EQUAL(transformed.n_cols, 2000);
+  for (size_t i = 0; i < 3; ++i)
+  {
+    BOOST_REQUIRE_CLOSE(std::abs(arma::dot(transformed.row(i),
+        score.col(i).t())), arma::dot(score.col(i), score.col(i)), 0.1);
+  }
+
+  BOOST_REQUIRE_THROW(sequential.Update(arma::mat(5, 10, arma::fill::randu)),
+      std::invalid_argument);
+}
+
 /**
  * Test that dimensionality reduction with QUIC-SVD PCA works the same way
  * as the Exact-SVD PCA method.
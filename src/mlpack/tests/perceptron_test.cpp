@@ -255,4 +255,59 @@ BOOST_AUTO_TEST_CASE(SecondaryConstructor)
   Perceptron<> p2(p1);
 }
 
+/**
+ * Classifying many points at once, in blocks, must give the same labels as
+ * classifying them one at a time.
+ */
+BOOST_AUTO_TEST_CASE(ClassifyManyPoints)
+{
+  Perceptron<> p(4, 6);
+  p.Weights().randn();
+  p.Biases().randn();
+
+  mat testData(6, 10000, fill::randn);
+  Row<size_t> predictedLabels;
+  p.Classify(testData, predictedLabels);
+
+  BOOST_REQUIRE_EQUAL(predictedLabels.n_elem, testData.n_cols);
+  for (size_t i = 0; i < testData.n_cols; ++i)
+  {
+    uword maxIndex;
+    vec scores = p.Weights().t() * testData.col(i) + p.Biases();
+    scores.max(maxIndex);
+    BOOST_REQUIRE_EQUAL(predictedLabels[i], maxIndex);
+  }
+}
+
+/**
+ * Training on shards with iterative parameter mixing should separate linearly
+ * separable data, and with one shard it should be the same as Train().
+ */
+BOOST_AUTO_TEST_CASE(ParallelTrainSeparable)
+{
+  // Three well-separated classes.
+  mat trainData(2, 600);
+  Row<size_t> labels(600);
+  for (size_t i = 0; i < 600; ++i)
+  {
+    labels[i] = i % 3;
+    trainData.col(i) = 0.5 * randu<vec>(2);
+    trainData(labels[i] == 2 ? 1 : 0, i) += 3.0 * (labels[i] > 0);
+  }
+
+  Perceptron<> p(3, 2, 1000);
+  p.ParallelTrain(trainData, labels, 4);
+
+  Row<size_t> predictedLabels;
+  p.Classify(trainData, predictedLabels);
+  for (size_t i = 0; i < labels.n_elem; ++i)
+    BOOST_REQUIRE_EQUAL(predictedLabels[i], labels[i]);
+
+  Perceptron<> serial(3, 2, 1000), oneShard(3, 2, 1000);
+  serial.Train(trainData, labels);
+  oneShard.ParallelTrain(trainData, labels, 1);
+  CheckMatrices(oneShard.Weights(), serial.Weights());
+  CheckMatrices(oneShard.Biases(), serial.Biases());
+}
+
 BOOST_AUTO_TEST_SUITE_END();
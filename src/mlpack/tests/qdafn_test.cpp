@@ -208,4 +208,44 @@ BOOST_AUTO_TEST_CASE(SparseTest)
   BOOST_REQUIRE_EQUAL(distances.n_cols, 1000);
 }
 
+// With one projection that holds every point, the search is exhaustive, so the
+// results must be exact.
+BOOST_AUTO_TEST_CASE(QDAFNExhaustiveExactTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(5, 100);
+
+  QDAFN<> qdafn(dataset, 1, 100);
+
+  arma::mat distances, distancesTrue;
+  arma::Mat<size_t> neighbors, neighborsTrue;
+  qdafn.Search(dataset, 5, neighbors, distances);
+
+  AllkFN kfn(dataset);
+  kfn.Search(dataset, 5, neighborsTrue, distancesTrue);
+
+  for (size_t i = 0; i < distances.n_elem; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(neighbors[i], neighborsTrue[i]);
+    BOOST_REQUIRE_CLOSE(distances[i], distancesTrue[i], 1e-5);
+  }
+}
+
+// The results must not depend on the number of threads.
+BOOST_AUTO_TEST_CASE(QDAFNThreadsTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(10, 2000);
+
+  QDAFN<> qdafn(dataset, 10, 40);
+
+  arma::mat distances, singleDistances;
+  arma::Mat<size_t> neighbors, singleNeighbors;
+  qdafn.Search(dataset, 3, neighbors, distances);
+
+  qdafn.NumThreads() = 1;
+  qdafn.Search(dataset, 3, singleNeighbors, singleDistances);
+
+  CheckMatrices(neighbors, singleNeighbors);
+  CheckMatrices(distances, singleDistances);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -74,6 +74,30 @@ BOOST_AUTO_TEST_CASE(QUICSVDSingularValueError)
   BOOST_REQUIRE_SMALL(error, 0.05);
 }
 
+/**
+ * The reconstruction error of the SVD obtained by splitting several cosine tree
+ * nodes at each step should also be small.
+ */
+BOOST_AUTO_TEST_CASE(QUICSVDBatchSplitReconstructionError)
+{
+  // Load the dataset.
+  arma::mat dataset;
+  data::Load("test_data_3_1000.csv", dataset);
+
+  // Obtain the SVD, splitting up to four nodes at once.
+  arma::mat u, v, sigma;
+  svd::QUIC_SVD quicsvd(dataset, u, v, sigma, 0.03, 0.1, 4);
+
+  // Reconstruct the matrix using the SVD.
+  arma::mat reconstruct;
+  reconstruct = u * sigma * v.t();
+
+  // The relative reconstruction error should be small.
+  double relativeError = arma::norm(dataset - reconstruct, "frob") /
+                         arma::norm(dataset, "frob");
+  BOOST_REQUIRE_SMALL(relativeError, 1e-5);
+}
+
 BOOST_AUTO_TEST_CASE(QUICSVDSameDimensionTest)
 {
   arma::mat dataset = arma::randn<arma::mat>(10, 10);
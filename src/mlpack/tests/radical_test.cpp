@@ -57,4 +57,47 @@ BOOST_AUTO_TEST_CASE(Radical_Test_Radical3D)
   BOOST_REQUIRE_CLOSE(valBest, valEst, 0.25);
 }
 
+/**
+ * Make sure that the two-dimensional search, which splits the angles between
+ * threads and updates the sorted projections from one angle to the next,
+ * finds the same angle as sorting every projection again.
+ */
+BOOST_AUTO_TEST_CASE(Radical2DMatchesBruteForce)
+{
+  // Two independent uniform sources, rotated; each row is a point.
+  mat sources = randu<mat>(2000, 2) - 0.5;
+  const double rotation = 0.3;
+  mat rotationMatrix(2, 2);
+  rotationMatrix(0, 0) = cos(rotation);
+  rotationMatrix(1, 0) = sin(rotation);
+  rotationMatrix(0, 1) = -sin(rotation);
+  rotationMatrix(1, 1) = cos(rotation);
+  const mat matX = sources * rotationMatrix;
+
+  const size_t angles = 150;
+  Radical rad(0.175, 3, angles, 0, 60);
+
+  // Find the perturbed data that DoRadical2D() will use.
+  math::RandomSeed(42);
+  mat perturbed;
+  rad.CopyAndPerturb(perturbed, matX);
+
+  vec values(angles);
+  for (size_t i = 0; i < angles; ++i)
+  {
+    const double theta = (i / (double) angles) * M_PI / 2.0;
+    vec y1 = cos(theta) * perturbed.col(0) - sin(theta) * perturbed.col(1);
+    vec y2 = sin(theta) * perturbed.col(0) + cos(theta) * perturbed.col(1);
+    values[i] = rad.Vasicek(y1) + rad.Vasicek(y2);
+  }
+
+  uword indOpt = 0;
+  values.min(indOpt);
+
+  math::RandomSeed(42);
+  const double theta = rad.DoRadical2D(matX);
+
+  BOOST_REQUIRE_CLOSE(theta, (indOpt / (double) angles) * M_PI / 2.0, 1e-5);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
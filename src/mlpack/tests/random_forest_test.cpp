@@ -0,0 +1,281 @@
+/**
+ * @file random_forest_test.cpp
+ *
+ * Tests for the RandomForest class and the MultipleRandomDimensionSelect
+ * dimension selection policy.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include <mlpack/core.hpp>
+#include <mlpack/methods/random_forest/random_forest.hpp>
+
+#include <boost/test/unit_test.hpp>
+#include "test_tools.hpp"
+#include "serialization.hpp"
+
+using namespace mlpack;
+using namespace mlpack::tree;
+
+BOOST_AUTO_TEST_SUITE(RandomForestTest);
+
+/**
+ * Make sure that MultipleRandomDimensionSelect selects the right number of
+ * distinct dimensions.
+ */
+BOOST_AUTO_TEST_CASE(MultipleRandomDimensionSelectTest)
+{
+  MultipleRandomDimensionSelect select(3);
+  select.Dimensions(10);
+
+  for (size_t trial = 0; trial < 20; ++trial)
+  {
+    std::set<size_t> dimensions;
+    for (size_t dim = select.Begin(); dim != select.End(); dim = select.Next())
+    {
+      BOOST_REQUIRE_LT(dim, 10);
+      dimensions.insert(dim);
+    }
+
+    BOOST_REQUIRE_EQUAL(dimensions.size(), 3);
+  }
+
+  // The default selects the square root of the number of dimensions.
+  MultipleRandomDimensionSelect defaultSelect;
+  defaultSelect.Dimensions(17);
+  size_t count = 0;
+  for (size_t dim = defaultSelect.Begin(); dim != defaultSelect.End();
+       dim = defaultSelect.Next())
+    ++count;
+
+  BOOST_REQUIRE_EQUAL(count, 4);
+
+  // Never more dimensions than there are.
+  MultipleRandomDimensionSelect bigSelect(5);
+  bigSelect.Dimensions(2);
+  count = 0;
+  for (size_t dim = bigSelect.Begin(); dim != bigSelect.End();
+       dim = bigSelect.Next())
+    ++count;
+
+  BOOST_REQUIRE_EQUAL(count, 2);
+}
+
+/**
+ * Make sure that the same generator seed gives the same dimensions.
+ */
+BOOST_AUTO_TEST_CASE(MultipleRandomDimensionSelectGeneratorTest)
+{
+  std::mt19937 generator(42), otherGenerator(42);
+  MultipleRandomDimensionSelect select(4), otherSelect(4);
+  select.Generator(generator);
+  otherSelect.Generator(otherGenerator);
+  select.Dimensions(20);
+  otherSelect.Dimensions(20);
+
+  size_t dim = select.Begin();
+  size_t otherDim = otherSelect.Begin();
+  while (dim != select.End())
+  {
+    BOOST_REQUIRE_EQUAL(dim, otherDim);
+    dim = select.Next();
+    otherDim = otherSelect.Next();
+  }
+  BOOST_REQUIRE_EQUAL(otherDim, otherSelect.End());
+}
+
+/**
+ * Make sure that a random forest does reasonably well on the vc2 dataset.
+ */
+BOOST_AUTO_TEST_CASE(RandomForestAccuracyTest)
+{
+  arma::mat dataset, testData;
+  arma::Row<size_t> labels, testLabels;
+  if (!data::Load("vc2.csv", dataset))
+    BOOST_FAIL("Cannot load test dataset vc2.csv!");
+  if (!data::Load("vc2_labels.txt", labels))
+    BOOST_FAIL("Cannot load labels for vc2_labels.txt");
+  if (!data::Load("vc2_test.csv", testData))
+    BOOST_FAIL("Cannot load test dataset vc2_test.csv!");
+  if (!data::Load("vc2_test_labels.txt", testLabels))
+    BOOST_FAIL("Cannot load labels for vc2_test_labels.txt");
+
+  RandomForest<> rf(dataset, labels, 3, 20, 5);
+  BOOST_REQUIRE_EQUAL(rf.NumTrees(), 20);
+
+  arma::Row<size_t> predictions;
+  rf.Classify(testData, predictions);
+  BOOST_REQUIRE_EQUAL(predictions.n_elem, testData.n_cols);
+
+  const size_t correct = arma::accu(predictions == testLabels);
+  BOOST_REQUIRE_GT(double(correct) / double(testData.n_cols), 0.75);
+}
+
+/**
+ * Make sure that classifying a dataset at once gives the same results as
+ * classifying each point.
+ */
+BOOST_AUTO_TEST_CASE(RandomForestBatchClassifyTest)
+{
+  arma::mat dataset(5, 1000, arma::fill::randu);
+  arma::Row<size_t> labels(1000);
+  for (size_t i = 0; i < 1000; ++i)
+    labels[i] = (dataset(2, i) > 0.5) ? ((dataset(0, i) > 0.3) ? 2 : 1) : 0;
+
+  RandomForest<> rf(dataset, labels, 3, 10, 3);
+
+  arma::Row<size_t> predictions;
+  arma::mat probabilities;
+  rf.Classify(dataset, predictions, probabilities);
+
+  BOOST_REQUIRE_EQUAL(probabilities.n_rows, 3);
+  BOOST_REQUIRE_EQUAL(probabilities.n_cols, 1000);
+  for (size_t i = 0; i < 1000; ++i)
+  {
+    size_t prediction;
+    arma::vec pointProbabilities;
+    rf.Classify(dataset.col(i), prediction, pointProbabilities);
+
+    BOOST_REQUIRE_EQUAL(prediction, predictions[i]);
+    BOOST_REQUIRE_EQUAL(prediction, rf.Classify(dataset.col(i)));
+    for (size_t j = 0; j < 3; ++j)
+      BOOST_REQUIRE_CLOSE(pointProbabilities[j] + 1.0,
+          probabilities(j, i) + 1.0, 1e-5);
+  }
+}
+
+/**
+ * Make sure that a random forest on categorical data can be trained and makes
+ * sensible probabilities.
+ */
+BOOST_AUTO_TEST_CASE(RandomForestCategoricalTest)
+{
+  arma::mat dataset(3, 500);
+  arma::Row<size_t> labels(500);
+  data::DatasetInfo di(3);
+  di.Type(0) = data::Datatype::categorical;
+  di.MapString<double>("a", 0);
+  di.MapString<double>("b", 0);
+  di.MapString<double>("c", 0);
+  for (size_t i = 0; i < 500; ++i)
+  {
+    dataset(0, i) = i % 3;
+    dataset(1, i) = math::Random();
+    dataset(2, i) = math::Random();
+    labels[i] = (i % 3 == 0) ? 1 : 0;
+  }
+
+  RandomForest<> rf(dataset, di, labels, 2, 10);
+
+  arma::Row<size_t> predictions;
+  arma::mat probabilities;
+  rf.Classify(dataset, predictions, probabilities);
+
+  for (size_t i = 0; i < 500; ++i)
+    BOOST_REQUIRE_CLOSE(arma::accu(probabilities.col(i)), 1.0, 1e-5);
+
+  const size_t correct = arma::accu(predictions == labels);
+  BOOST_REQUIRE_GT(double(correct) / 500.0, 0.9);
+}
+
+/**
+ * Make sure that the forest only depends on the random seed, and not on the
+ * number of threads.
+ */
+BOOST_AUTO_TEST_CASE(RandomForestSeedTest)
+{
+  arma::mat dataset(6, 2000, arma::fill::randu);
+  arma::Row<size_t> labels(2000);
+  for (size_t i = 0; i < 2000; ++i)
+  {
+    labels[i] = (dataset(1, i) + 0.3 * math::Random() > 0.6) ?
+        ((dataset(4, i) > 0.5) ? 2 : 1) : 0;
+  }
+
+#ifdef HAS_OPENMP
+  const size_t prevNumThreads = omp_get_max_threads();
+  omp_set_num_threads(std::max(prevNumThreads, (size_t) 4));
+#endif
+
+  math::RandomSeed(17);
+  RandomForest<> rf(dataset, labels, 3, 8, 2);
+
+#ifdef HAS_OPENMP
+  omp_set_num_threads(1);
+#endif
+
+  math::RandomSeed(17);
+  RandomForest<> otherRf(dataset, labels, 3, 8, 2);
+
+#ifdef HAS_OPENMP
+  omp_set_num_threads(prevNumThreads);
+#endif
+
+  arma::Row<size_t> predictions, otherPredictions;
+  arma::mat probabilities, otherProbabilities;
+  rf.Classify(dataset, predictions, probabilities);
+  otherRf.Classify(dataset, otherPredictions, otherProbabilities);
+
+  for (size_t i = 0; i < predictions.n_elem; ++i)
+    BOOST_REQUIRE_EQUAL(predictions[i], otherPredictions[i]);
+  for (size_t i = 0; i < probabilities.n_elem; ++i)
+    BOOST_REQUIRE_CLOSE(probabilities[i] + 1.0, otherProbabilities[i] + 1.0,
+        1e-5);
+}
+
+/**
+ * Make sure that a random forest can be serialized and deserialized.
+ */
+BOOST_AUTO_TEST_CASE(RandomForestSerializationTest)
+{
+  arma::mat dataset(4, 500, arma::fill::randu);
+  arma::Row<size_t> labels(500);
+  for (size_t i = 0; i < 500; ++i)
+    labels[i] = (dataset(3, i) > 0.4) ? 1 : 0;
+
+  RandomForest<> rf(dataset, labels, 2, 5);
+
+  arma::mat otherData(4, 10, arma::fill::randu);
+  RandomForest<> xmlRf(otherData, arma::Row<size_t>(10, arma::fill::zeros), 1,
+      2);
+  RandomForest<> textRf, binaryRf;
+
+  SerializeObjectAll(rf, xmlRf, textRf, binaryRf);
+
+  BOOST_REQUIRE_EQUAL(xmlRf.NumTrees(), 5);
+  BOOST_REQUIRE_EQUAL(textRf.NumTrees(), 5);
+  BOOST_REQUIRE_EQUAL(binaryRf.NumTrees(), 5);
+
+  arma::Row<size_t> predictions, xmlPredictions, textPredictions,
+      binaryPredictions;
+  rf.Classify(dataset, predictions);
+  xmlRf.Classify(dataset, xmlPredictions);
+  textRf.Classify(dataset, textPredictions);
+  binaryRf.Classify(dataset, binaryPredictions);
+
+  for (size_t i = 0; i < predictions.n_elem; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(predictions[i], xmlPredictions[i]);
+    BOOST_REQUIRE_EQUAL(predictions[i], textPredictions[i]);
+    BOOST_REQUIRE_EQUAL(predictions[i], binaryPredictions[i]);
+  }
+}
+
+/**
+ * Make sure that invalid parameters are rejected.
+ */
+BOOST_AUTO_TEST_CASE(RandomForestInvalidTest)
+{
+  arma::mat dataset(4, 100, arma::fill::randu);
+  arma::Row<size_t> labels(99, arma::fill::zeros);
+
+  RandomForest<> rf;
+  BOOST_REQUIRE_THROW(rf.Train(dataset, labels, 2), std::invalid_argument);
+
+  labels.zeros(100);
+  BOOST_REQUIRE_THROW(rf.Train(dataset, labels, 2, 0), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -64,4 +64,103 @@ BOOST_AUTO_TEST_CASE(RandomizedSVDReconstructionError)
   BOOST_REQUIRE_SMALL(error, 1e-5);
 }
 
+/**
+ * The SVD obtained with a CountSketch test matrix should also have small
+ * reconstruction and singular value errors, whether there are more points
+ * than dimensions or not.
+ */
+BOOST_AUTO_TEST_CASE(RandomizedSVDCountSketchReconstructionError)
+{
+  arma::mat U = arma::randn<arma::mat>(200, 3);
+  arma::mat V = arma::randn<arma::mat>(100, 3);
+
+  arma::mat R;
+  arma::qr_econ(U, R, U);
+  arma::qr_econ(V, R, V);
+
+  arma::vec s("1 0.1 0.01");
+
+  for (size_t trial = 0; trial < 2; ++trial)
+  {
+    arma::mat data = U * arma::diagmat(s) * V.t();
+    if (trial == 1)
+      arma::inplace_trans(data);
+
+    // Center the data into a temporary matrix.
+    arma::mat centeredData;
+    math::Center(data, centeredData);
+
+    arma::mat U1, U2, V1, V2;
+    arma::vec s1, s2, s3;
+
+    arma::svd_econ(U1, s1, V1, centeredData);
+
+    svd::RandomizedSVD rSVD(20, 10, 1e-7, svd::RandomSketch::COUNT_SKETCH);
+    rSVD.Apply(data, U2, s2, V2, 3);
+
+    // Use the same amount of data for the comparison.
+    s3 = s1.subvec(0, s2.n_elem - 1);
+
+    // The sigular value error should be small.
+    double error = arma::norm(s2 - s3, "frob") / arma::norm(s2, "frob");
+    BOOST_REQUIRE_SMALL(error, 1e-5);
+
+    arma::mat reconstruct = U2 * arma::diagmat(s2) * V2.t();
+
+    // The relative reconstruction error should be small.
+    error = arma::norm(centeredData - reconstruct, "frob") /
+        arma::norm(centeredData, "frob");
+    BOOST_REQUIRE_SMALL(error, 1e-5);
+  }
+}
+
+/**
+ * The Gaussian matrices drawn in parallel should only depend on the seed, and
+ * have the moments of the standard normal distribution.
+ */
+BOOST_AUTO_TEST_CASE(RandomSketchRandnTest)
+{
+  arma::mat first(1000, 100), second(1000, 100), other(1000, 100);
+  svd::RandomSketch::Randn(first, 42, 1000);
+  svd::RandomSketch::Randn(second, 42, 1000);
+  svd::RandomSketch::Randn(other, 43, 1000);
+
+  CheckMatrices(first, second);
+  BOOST_REQUIRE_GT(arma::accu(arma::abs(first - other)), 1.0);
+
+  BOOST_REQUIRE_SMALL(arma::mean(arma::vectorise(first)), 0.02);
+  BOOST_REQUIRE_CLOSE(arma::var(arma::vectorise(first)), 1.0, 2.0);
+}
+
+/**
+ * Both kinds of sketches should give the same product with a matrix and with
+ * its transpose, and their column sums should be the product with a vector of
+ * ones.
+ */
+BOOST_AUTO_TEST_CASE(RandomSketchApplyTest)
+{
+  arma::mat data = arma::randn<arma::mat>(70, 300);
+  arma::mat dataT = data.t();
+
+  for (size_t type = 0; type < 2; ++type)
+  {
+    svd::RandomSketch sketch((svd::RandomSketch::SketchType) type);
+    sketch.Reset(300, 12);
+
+    arma::mat product, transposedProduct;
+    sketch.Apply(data, product);
+    sketch.ApplyTransposed(dataT, transposedProduct);
+
+    BOOST_REQUIRE_EQUAL(product.n_rows, 70);
+    BOOST_REQUIRE_EQUAL(product.n_cols, 12);
+    CheckMatrices(product, transposedProduct);
+
+    arma::rowvec sums;
+    arma::mat onesProduct;
+    sketch.ColumnSums(sums);
+    sketch.ApplyTransposed(arma::ones<arma::mat>(300, 1), onesProduct);
+    CheckMatrices(arma::mat(sums), onesProduct);
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
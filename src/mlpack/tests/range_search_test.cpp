@@ -13,6 +13,7 @@
 #include <mlpack/methods/range_search/range_search.hpp>
 #include <mlpack/core/tree/cover_tree.hpp>
 #include <mlpack/methods/range_search/rs_model.hpp>
+#include <mlpack/methods/range_search/transformed_range_search.hpp>
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
 
@@ -1696,4 +1697,507 @@ BOOST_AUTO_TEST_CASE(MoveOperatorNaiveTest)
   }
 }
 
+/**
+ * Make sure that an RSModel saved as a flat image and loaded again gives the
+ * same results, for every tree type that supports flat images.
+ */
+BOOST_AUTO_TEST_CASE(RSModelFlatImageTest)
+{
+  arma::mat queryData = arma::randu<arma::mat>(10, 50);
+  arma::mat referenceData = arma::randu<arma::mat>(10, 200);
+
+  const RSModel::TreeTypes treeTypes[] = { RSModel::TreeTypes::KD_TREE,
+      RSModel::TreeTypes::BALL_TREE, RSModel::TreeTypes::VP_TREE,
+      RSModel::TreeTypes::RP_TREE, RSModel::TreeTypes::MAX_RP_TREE,
+      RSModel::TreeTypes::UB_TREE };
+
+  for (size_t i = 0; i < 6; ++i)
+  {
+    RSModel model(treeTypes[i], false);
+    arma::mat referenceCopy(referenceData);
+    model.BuildModel(std::move(referenceCopy), 5, false, false);
+
+    model.SaveFlat("rs_flat_model.bin");
+    RSModel flatModel;
+    flatModel.LoadFlat("rs_flat_model.bin");
+
+    BOOST_REQUIRE_EQUAL(flatModel.TreeType(), model.TreeType());
+    BOOST_REQUIRE_EQUAL(flatModel.SingleMode(), model.SingleMode());
+
+    vector<vector<size_t>> neighbors, flatNeighbors;
+    vector<vector<double>> distances, flatDistances;
+    arma::mat queryCopy(queryData);
+    model.Search(std::move(queryCopy), math::Range(0.25, 0.75), neighbors,
+        distances);
+    queryCopy = queryData;
+    flatModel.Search(std::move(queryCopy), math::Range(0.25, 0.75),
+        flatNeighbors, flatDistances);
+
+    vector<vector<pair<double, size_t>>> sorted, flatSorted;
+    SortResults(neighbors, distances, sorted);
+    SortResults(flatNeighbors, flatDistances, flatSorted);
+
+    BOOST_REQUIRE_EQUAL(flatSorted.size(), sorted.size());
+    for (size_t k = 0; k < sorted.size(); ++k)
+    {
+      BOOST_REQUIRE_EQUAL(flatSorted[k].size(), sorted[k].size());
+      for (size_t l = 0; l < sorted[k].size(); ++l)
+      {
+        BOOST_REQUIRE_EQUAL(flatSorted[k][l].second, sorted[k][l].second);
+        BOOST_REQUIRE_CLOSE(flatSorted[k][l].first, sorted[k][l].first, 1e-5);
+      }
+    }
+  }
+
+  remove("rs_flat_model.bin");
+}
+
+/**
+ * Search a single-precision dataset with the given tree type, and make sure
+ * that the results are the same as the results of a naive search.
+ */
+template<template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void FloatRangeSearchTest()
+{
+  typedef RangeSearch<EuclideanDistance, arma::fmat, TreeType> RSType;
+
+  arma::fmat referenceData = arma::randu<arma::fmat>(4, 500);
+  arma::fmat queryData = arma::randu<arma::fmat>(4, 100);
+
+  RSType naive(referenceData, true);
+  RSType dualTree(referenceData);
+  RSType singleTree(referenceData, false, true);
+
+  vector<vector<size_t>> naiveNeighbors;
+  vector<vector<double>> naiveDistances;
+  naive.Search(queryData, math::Range(0.2, 0.4), naiveNeighbors,
+      naiveDistances);
+  vector<vector<pair<double, size_t>>> naiveSorted;
+  SortResults(naiveNeighbors, naiveDistances, naiveSorted);
+
+  for (size_t mode = 0; mode < 2; ++mode)
+  {
+    vector<vector<size_t>> neighbors;
+    vector<vector<double>> distances;
+    if (mode == 0)
+      dualTree.Search(queryData, math::Range(0.2, 0.4), neighbors, distances);
+    else
+      singleTree.Search(queryData, math::Range(0.2, 0.4), neighbors,
+          distances);
+
+    vector<vector<pair<double, size_t>>> sorted;
+    SortResults(neighbors, distances, sorted);
+
+    BOOST_REQUIRE_EQUAL(sorted.size(), naiveSorted.size());
+    for (size_t i = 0; i < sorted.size(); ++i)
+    {
+      BOOST_REQUIRE_EQUAL(sorted[i].size(), naiveSorted[i].size());
+      for (size_t j = 0; j < sorted[i].size(); ++j)
+      {
+        BOOST_REQUIRE_EQUAL(sorted[i][j].second, naiveSorted[i][j].second);
+        BOOST_REQUIRE_CLOSE(sorted[i][j].first, naiveSorted[i][j].first,
+            1e-5);
+      }
+    }
+  }
+}
+
+/**
+ * Make sure range search with float data works with kd-trees.
+ */
+BOOST_AUTO_TEST_CASE(RangeSearchFloatKDTreeTest)
+{
+  FloatRangeSearchTest<KDTree>();
+}
+
+/**
+ * Make sure range search with float data works with ball trees.
+ */
+BOOST_AUTO_TEST_CASE(RangeSearchFloatBallTreeTest)
+{
+  FloatRangeSearchTest<BallTree>();
+}
+
+/**
+ * Make sure range search with float data works with cover trees.
+ */
+BOOST_AUTO_TEST_CASE(RangeSearchFloatCoverTreeTest)
+{
+  FloatRangeSearchTest<StandardCoverTree>();
+}
+
+/**
+ * Make sure range search with float data works with R trees.
+ */
+BOOST_AUTO_TEST_CASE(RangeSearchFloatRTreeTest)
+{
+  FloatRangeSearchTest<RTree>();
+}
+
+/**
+ * Make sure that the CSR results are the same as the vector results, in the
+ * same order, for each search mode, with and without a query set.
+ */
+BOOST_AUTO_TEST_CASE(RangeSearchCSRTest)
+{
+  arma::mat referenceData = arma::randu<arma::mat>(3, 400);
+  arma::mat queryData = arma::randu<arma::mat>(3, 150);
+  const math::Range range(0.1, 0.3);
+
+  for (size_t mode = 0; mode < 3; ++mode)
+  {
+    RangeSearch<> rs(referenceData, mode == 0, mode == 1);
+
+    for (size_t mono = 0; mono < 2; ++mono)
+    {
+      vector<vector<size_t>> neighbors;
+      vector<vector<double>> distances;
+      vector<size_t> offsets, csrNeighbors;
+      vector<double> csrDistances;
+      if (mono == 0)
+      {
+        rs.Search(queryData, range, neighbors, distances);
+        rs.Search(queryData, range, offsets, csrNeighbors, csrDistances);
+      }
+      else
+      {
+        rs.Search(range, neighbors, distances);
+        rs.Search(range, offsets, csrNeighbors, csrDistances);
+      }
+
+      BOOST_REQUIRE_EQUAL(offsets.size(), neighbors.size() + 1);
+      BOOST_REQUIRE_EQUAL(offsets[0], 0);
+      for (size_t i = 0; i < neighbors.size(); ++i)
+      {
+        BOOST_REQUIRE_EQUAL(offsets[i + 1] - offsets[i], neighbors[i].size());
+        for (size_t j = 0; j < neighbors[i].size(); ++j)
+        {
+          BOOST_REQUIRE_EQUAL(csrNeighbors[offsets[i] + j], neighbors[i][j]);
+          BOOST_REQUIRE_EQUAL(csrDistances[offsets[i] + j], distances[i][j]);
+        }
+      }
+      BOOST_REQUIRE_EQUAL(csrNeighbors.size(), offsets.back());
+      BOOST_REQUIRE_EQUAL(csrDistances.size(), offsets.back());
+    }
+  }
+}
+
+/**
+ * Make sure that a callback receives exactly the results that are returned in
+ * vectors, with the original indices, for each search mode and a tree type
+ * that rearranges the dataset as well as one that doesn't.
+ */
+template<typename RSType>
+void CallbackRangeSearchTest()
+{
+  arma::mat referenceData = arma::randu<arma::mat>(3, 300);
+  arma::mat queryData = arma::randu<arma::mat>(3, 100);
+  const math::Range range(0.0, 0.25);
+
+  for (size_t mode = 0; mode < 3; ++mode)
+  {
+    RSType rs(referenceData, mode == 0, mode == 1);
+
+    vector<vector<size_t>> neighbors;
+    vector<vector<double>> distances;
+    rs.Search(queryData, range, neighbors, distances);
+
+    vector<vector<size_t>> callbackNeighbors(queryData.n_cols);
+    vector<vector<double>> callbackDistances(queryData.n_cols);
+    size_t calls = 0;
+    auto store = [&](const size_t q, const size_t r, const double d)
+    {
+      callbackNeighbors[q].push_back(r);
+      callbackDistances[q].push_back(d);
+      ++calls;
+    };
+    rs.Search(queryData, range, store);
+
+    vector<vector<pair<double, size_t>>> sorted, callbackSorted;
+    SortResults(neighbors, distances, sorted);
+    SortResults(callbackNeighbors, callbackDistances, callbackSorted);
+
+    size_t total = 0;
+    for (size_t i = 0; i < sorted.size(); ++i)
+    {
+      BOOST_REQUIRE_EQUAL(callbackSorted[i].size(), sorted[i].size());
+      for (size_t j = 0; j < sorted[i].size(); ++j)
+      {
+        BOOST_REQUIRE_EQUAL(callbackSorted[i][j].second, sorted[i][j].second);
+        BOOST_REQUIRE_CLOSE(callbackSorted[i][j].first, sorted[i][j].first,
+            1e-5);
+      }
+      total += sorted[i].size();
+    }
+    BOOST_REQUIRE_EQUAL(calls, total);
+  }
+}
+
+/**
+ * Make sure callbacks work with kd-trees, which rearrange the dataset.
+ */
+BOOST_AUTO_TEST_CASE(RangeSearchCallbackKDTreeTest)
+{
+  CallbackRangeSearchTest<RangeSearch<>>();
+}
+
+/**
+ * Make sure callbacks work with cover trees, which don't rearrange the dataset.
+ */
+BOOST_AUTO_TEST_CASE(RangeSearchCallbackCoverTreeTest)
+{
+  CallbackRangeSearchTest<RangeSearch<EuclideanDistance, arma::mat,
+      StandardCoverTree>>();
+}
+
+/**
+ * Make sure that Count() and KernelSum() agree with the results of Search() in
+ * every mode, with and without a query set.
+ */
+template<typename RSType>
+void RangeCountTest()
+{
+  arma::mat referenceData = arma::randu<arma::mat>(3, 500);
+  arma::mat queryData = arma::randu<arma::mat>(3, 200);
+  const kernel::GaussianKernel kernel(0.2);
+
+  for (size_t run = 0; run < 12; ++run)
+  {
+    const size_t mode = run % 3;
+    const bool mono = ((run / 3) % 2 == 1);
+    const math::Range range = (run < 6) ? math::Range(0.0, 0.3) :
+        math::Range(0.1, 0.3);
+
+    RSType rs(referenceData, mode == 0, mode == 1);
+
+    vector<vector<size_t>> neighbors;
+    vector<vector<double>> distances;
+    arma::Col<size_t> counts;
+    arma::vec sums, approximateSums;
+    if (mono)
+    {
+      rs.Search(range, neighbors, distances);
+      rs.Count(range, counts);
+      rs.KernelSum(range, kernel, sums);
+      rs.KernelSum(range, kernel, approximateSums, 0.05);
+    }
+    else
+    {
+      rs.Search(queryData, range, neighbors, distances);
+      rs.Count(queryData, range, counts);
+      rs.KernelSum(queryData, range, kernel, sums);
+      rs.KernelSum(queryData, range, kernel, approximateSums, 0.05);
+    }
+
+    BOOST_REQUIRE_EQUAL(counts.n_elem, neighbors.size());
+    BOOST_REQUIRE_EQUAL(sums.n_elem, neighbors.size());
+    for (size_t i = 0; i < neighbors.size(); ++i)
+    {
+      BOOST_REQUIRE_EQUAL(counts[i], neighbors[i].size());
+
+      double sum = 0.0;
+      for (size_t j = 0; j < distances[i].size(); ++j)
+        sum += kernel.Evaluate(distances[i][j]);
+
+      if (sum == 0.0)
+      {
+        BOOST_REQUIRE_SMALL(sums[i], 1e-10);
+        BOOST_REQUIRE_SMALL(approximateSums[i], 1e-10);
+      }
+      else
+      {
+        BOOST_REQUIRE_CLOSE(sums[i], sum, 1e-5);
+        BOOST_REQUIRE_CLOSE(approximateSums[i], sum, 6.0);
+      }
+    }
+  }
+}
+
+/**
+ * Make sure range counts and kernel sums are right with kd-trees.
+ */
+BOOST_AUTO_TEST_CASE(RangeCountKDTreeTest)
+{
+  RangeCountTest<RangeSearch<>>();
+}
+
+/**
+ * Make sure range counts and kernel sums are right with cover trees, which
+ * compute base cases in Score().
+ */
+BOOST_AUTO_TEST_CASE(RangeCountCoverTreeTest)
+{
+  RangeCountTest<RangeSearch<EuclideanDistance, arma::mat,
+      StandardCoverTree>>();
+}
+
+// These tests are only compiled if the user has specified OpenMP to be used.
+#ifdef HAS_OPENMP
+/**
+ * Run dual-tree, single-tree and naive searches with one thread and with four
+ * threads, and make sure that the results are the same (up to order).
+ */
+template<template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void ParallelRangeSearchTest()
+{
+  typedef RangeSearch<EuclideanDistance, arma::mat, TreeType> RSType;
+
+  arma::mat referenceData = arma::randu<arma::mat>(3, 2000);
+  arma::mat queryData = arma::randu<arma::mat>(3, 1500);
+  const math::Range range(0.05, 0.15);
+
+  RSType rs(referenceData);
+
+  for (size_t run = 0; run < 6; ++run)
+  {
+    const size_t mono = run % 2;
+    rs.SingleMode() = (run / 2 == 1);
+    rs.Naive() = (run / 2 == 2);
+
+    vector<vector<size_t>> neighbors, parallelNeighbors;
+    vector<vector<double>> distances, parallelDistances;
+
+    rs.NumThreads() = 1;
+    if (mono == 0)
+      rs.Search(queryData, range, neighbors, distances);
+    else
+      rs.Search(range, neighbors, distances);
+
+    rs.NumThreads() = 4;
+    if (mono == 0)
+      rs.Search(queryData, range, parallelNeighbors, parallelDistances);
+    else
+      rs.Search(range, parallelNeighbors, parallelDistances);
+
+    vector<vector<pair<double, size_t>>> sorted, parallelSorted;
+    SortResults(neighbors, distances, sorted);
+    SortResults(parallelNeighbors, parallelDistances, parallelSorted);
+
+    BOOST_REQUIRE_EQUAL(parallelSorted.size(), sorted.size());
+    for (size_t i = 0; i < sorted.size(); ++i)
+    {
+      BOOST_REQUIRE_EQUAL(parallelSorted[i].size(), sorted[i].size());
+      for (size_t j = 0; j < sorted[i].size(); ++j)
+      {
+        BOOST_REQUIRE_EQUAL(parallelSorted[i][j].second, sorted[i][j].second);
+        BOOST_REQUIRE_CLOSE(parallelSorted[i][j].first, sorted[i][j].first,
+            1e-5);
+      }
+    }
+  }
+}
+
+/**
+ * Make sure parallel range search gives the same results as serial search with
+ * kd-trees.
+ */
+BOOST_AUTO_TEST_CASE(ParallelRangeSearchKDTreeTest)
+{
+  ParallelRangeSearchTest<KDTree>();
+}
+
+/**
+ * Make sure parallel range search gives the same results as serial search with
+ * cover trees.
+ */
+BOOST_AUTO_TEST_CASE(ParallelRangeSearchCoverTreeTest)
+{
+  ParallelRangeSearchTest<StandardCoverTree>();
+}
+
+/**
+ * Make sure parallel range search gives the same results as serial search with
+ * R trees.
+ */
+BOOST_AUTO_TEST_CASE(ParallelRangeSearchRTreeTest)
+{
+  ParallelRangeSearchTest<RTree>();
+}
+
+/**
+ * Make sure that RSModel passes the number of threads on, and that a parallel
+ * search through the model gives the same results as a serial one.
+ */
+BOOST_AUTO_TEST_CASE(ParallelRSModelTest)
+{
+  arma::mat referenceData = arma::randu<arma::mat>(3, 1000);
+  arma::mat queryData = arma::randu<arma::mat>(3, 800);
+  const math::Range range(0.05, 0.2);
+
+  RSModel model(RSModel::BALL_TREE);
+  model.BuildModel(std::move(referenceData), 20, false, false);
+
+  model.NumThreads() = 1;
+  BOOST_REQUIRE_EQUAL(model.NumThreads(), 1);
+  vector<vector<size_t>> neighbors, parallelNeighbors;
+  vector<vector<double>> distances, parallelDistances;
+  model.Search(arma::mat(queryData), range, neighbors, distances);
+
+  model.NumThreads() = 4;
+  BOOST_REQUIRE_EQUAL(model.NumThreads(), 4);
+  model.Search(arma::mat(queryData), range, parallelNeighbors,
+      parallelDistances);
+
+  vector<vector<pair<double, size_t>>> sorted, parallelSorted;
+  SortResults(neighbors, distances, sorted);
+  SortResults(parallelNeighbors, parallelDistances, parallelSorted);
+
+  BOOST_REQUIRE_EQUAL(parallelSorted.size(), sorted.size());
+  for (size_t i = 0; i < sorted.size(); ++i)
+  {
+    BOOST_REQUIRE_EQUAL(parallelSorted[i].size(), sorted[i].size());
+    for (size_t j = 0; j < sorted[i].size(); ++j)
+      BOOST_REQUIRE_EQUAL(parallelSorted[i][j].second, sorted[i][j].second);
+  }
+}
+#endif
+
+/**
+ * TransformedRangeSearch with the Mahalanobis distance should find the same
+ * points as brute force with the Mahalanobis distance.
+ */
+BOOST_AUTO_TEST_CASE(TransformedRangeSearchTest)
+{
+  const arma::mat referenceSet = arma::randu<arma::mat>(3, 300);
+  const arma::mat querySet = arma::randu<arma::mat>(3, 40);
+  const arma::mat a = arma::randu<arma::mat>(3, 3);
+  MahalanobisDistance<> mahalanobis(a.t() * a + arma::eye<arma::mat>(3, 3));
+
+  TransformedRangeSearch<> rs(referenceSet, mahalanobis);
+  const Range range(0.3, 0.8);
+  vector<vector<size_t>> neighbors;
+  vector<vector<double>> distances;
+  rs.Search(querySet, range, neighbors, distances);
+
+  BOOST_REQUIRE_EQUAL(neighbors.size(), querySet.n_cols);
+  for (size_t q = 0; q < querySet.n_cols; ++q)
+  {
+    vector<size_t> trueNeighbors;
+    for (size_t r = 0; r < referenceSet.n_cols; ++r)
+    {
+      const double d = mahalanobis.Evaluate(querySet.col(q),
+          referenceSet.col(r));
+      if (range.Contains(d))
+        trueNeighbors.push_back(r);
+    }
+
+    // The distances are the Mahalanobis distances.
+    for (size_t i = 0; i < neighbors[q].size(); ++i)
+    {
+      BOOST_REQUIRE_CLOSE(distances[q][i], mahalanobis.Evaluate(
+          querySet.col(q), referenceSet.col(neighbors[q][i])), 1e-5);
+    }
+
+    vector<size_t> found = neighbors[q];
+    sort(found.begin(), found.end());
+    BOOST_REQUIRE_EQUAL(found.size(), trueNeighbors.size());
+    for (size_t i = 0; i < found.size(); ++i)
+      BOOST_REQUIRE_EQUAL(found[i], trueNeighbors[i]);
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -1384,4 +1384,114 @@ BOOST_AUTO_TEST_CASE(RectangleTreeMoveDatasetTest)
   BOOST_REQUIRE_EQUAL(tree.Dataset().n_cols, 1000);
 }
 
+/**
+ * Bulk load a tree with the given packing, check that it is valid and balanced
+ * and that its nodes are full enough, and make sure that it gives the same
+ * results as a naive search.
+ */
+template<template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         typename PackingType>
+void CheckBulkLoad(const arma::mat& dataset)
+{
+  typedef TreeType<EuclideanDistance, NeighborSearchStat<NearestNeighborSort>,
+      arma::mat> Tree;
+  Tree tree(dataset, PackingType(), 20, 6, 5, 2);
+
+  BOOST_REQUIRE_EQUAL(tree.NumDescendants(), dataset.n_cols);
+  CheckContainment(tree);
+  CheckExactContainment(tree);
+  CheckHierarchy(tree);
+  CheckNumDescendants(tree);
+  CheckFills(tree);
+  BOOST_REQUIRE_EQUAL(GetMinLevel(tree), GetMaxLevel(tree));
+
+  // 1000 points with leaves of 20 points and 5 children per node need four
+  // levels, so the root has two children of 500 points, and every leaf is
+  // full.
+  BOOST_REQUIRE_EQUAL(tree.TreeDepth(), 4);
+  BOOST_REQUIRE_EQUAL(tree.NumChildren(), 2);
+
+  arma::Mat<size_t> neighbors1, neighbors2;
+  arma::mat distances1, distances2;
+  NeighborSearch<NearestNeighborSort, metric::EuclideanDistance, arma::mat,
+      TreeType> knn1(std::move(tree));
+  knn1.Search(5, neighbors1, distances1);
+
+  KNN knn2(dataset, NAIVE_MODE);
+  knn2.Search(5, neighbors2, distances2);
+
+  for (size_t i = 0; i < neighbors1.size(); i++)
+  {
+    BOOST_REQUIRE_EQUAL(neighbors1[i], neighbors2[i]);
+    BOOST_REQUIRE_EQUAL(distances1[i], distances2[i]);
+  }
+}
+
+// Make sure that bulk loading works for each tree type that supports it.
+BOOST_AUTO_TEST_CASE(RectangleTreeBulkLoadTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(3, 1000);
+
+  CheckBulkLoad<RTree, STRPacking>(dataset);
+  CheckBulkLoad<RTree, HilbertPacking>(dataset);
+  CheckBulkLoad<RStarTree, STRPacking>(dataset);
+  CheckBulkLoad<XTree, STRPacking>(dataset);
+  CheckBulkLoad<HilbertRTree, HilbertPacking>(dataset);
+}
+
+// A bulk loaded Hilbert R tree should keep its points and children ordered by
+// Hilbert value, and the Hilbert values it holds should match the points.
+BOOST_AUTO_TEST_CASE(HilbertRTreeBulkLoadOrderingTest)
+{
+  arma::mat dataset;
+  dataset.randu(8, 1000); // 1000 points in 8 dimensions.
+
+  typedef HilbertRTree<EuclideanDistance,
+      NeighborSearchStat<NearestNeighborSort>, arma::mat> TreeType;
+  TreeType hilbertRTree(dataset, HilbertPacking(), 20, 6, 5, 2);
+
+  CheckHilbertOrdering(hilbertRTree);
+  CheckDiscreteHilbertValueSync(hilbertRTree);
+}
+
+// STR packing should give leaves whose bounds hardly overlap: on a grid of
+// points, no two leaves should share any volume.
+BOOST_AUTO_TEST_CASE(STRPackingGridTest)
+{
+  // A 40x40 grid of 1600 points, which gives 80 full leaves.
+  arma::mat dataset(2, 1600);
+  for (size_t i = 0; i < 1600; ++i)
+  {
+    dataset(0, i) = i / 40;
+    dataset(1, i) = i % 40;
+  }
+
+  typedef RTree<EuclideanDistance, EmptyStatistic, arma::mat> TreeType;
+  TreeType tree(dataset, STRPacking(), 20, 6, 5, 2);
+
+  // Collect the leaves.
+  std::vector<const TreeType*> leaves;
+  std::vector<const TreeType*> stack(1, &tree);
+  while (!stack.empty())
+  {
+    const TreeType* node = stack.back();
+    stack.pop_back();
+    if (node->IsLeaf())
+      leaves.push_back(node);
+    for (size_t i = 0; i < node->NumChildren(); ++i)
+      stack.push_back(&node->Child(i));
+  }
+
+  BOOST_REQUIRE_EQUAL(leaves.size(), 80);
+  for (size_t i = 0; i < leaves.size(); ++i)
+  {
+    BOOST_REQUIRE_EQUAL(leaves[i]->Count(), 20);
+    for (size_t j = i + 1; j < leaves.size(); ++j)
+      BOOST_REQUIRE_SMALL(leaves[i]->Bound().Overlap(leaves[j]->Bound()),
+          1e-10);
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
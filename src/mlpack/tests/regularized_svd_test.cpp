@@ -11,6 +11,8 @@
  */
 #include <mlpack/core.hpp>
 #include <mlpack/methods/regularized_svd/regularized_svd.hpp>
+#include <mlpack/methods/regularized_svd/parallel_regularized_svd.hpp>
+#include <mlpack/core/optimizers/hogwild_sgd/hogwild_sgd.hpp>
 
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
@@ -194,6 +196,97 @@ BOOST_AUTO_TEST_CASE(RegularizedSVDFunctionGradient)
   }
 }
 
+/**
+ * Make sure the sparse gradients of the examples sum to the full gradient, and
+ * only touch the columns of the user and the item of the example.
+ */
+BOOST_AUTO_TEST_CASE(RegularizedSVDFunctionSparseGradient)
+{
+  const size_t numUsers = 50;
+  const size_t numItems = 50;
+  const size_t numRatings = 100;
+  const size_t maxRating = 5;
+  const size_t rank = 10;
+
+  arma::mat data = arma::randu(3, numRatings);
+  data.row(0) = floor(data.row(0) * numUsers);
+  data.row(1) = floor(data.row(1) * numItems);
+  data.row(2) = floor(data.row(2) * maxRating + 0.5);
+  data(0, numRatings - 1) = numUsers - 1;
+  data(1, numRatings - 1) = numItems - 1;
+
+  arma::mat parameters = arma::randu(rank, numUsers + numItems);
+  RegularizedSVDFunction rSVDFunc(data, rank, 0.5);
+
+  arma::mat gradient;
+  rSVDFunc.Gradient(parameters, gradient);
+
+  arma::mat sum(rank, numUsers + numItems, arma::fill::zeros);
+  arma::sp_mat sparseGradient;
+  for (size_t i = 0; i < numRatings; ++i)
+  {
+    rSVDFunc.Gradient(parameters, i, sparseGradient);
+    BOOST_REQUIRE_LE(sparseGradient.n_nonzero, 2 * rank);
+    sum += sparseGradient;
+  }
+
+  for (size_t i = 0; i < gradient.n_elem; ++i)
+  {
+    if (std::abs(gradient[i]) <= 1e-10)
+      BOOST_REQUIRE_SMALL(sum[i], 1e-10);
+    else
+      BOOST_REQUIRE_CLOSE(sum[i], gradient[i], 1e-8);
+  }
+}
+
+/**
+ * Make sure HogwildSGD, which takes the sparse gradient steps of the examples,
+ * can factorize a rating matrix.
+ */
+BOOST_AUTO_TEST_CASE(RegularizedSVDFunctionHogwildOptimize)
+{
+  const size_t numUsers = 50;
+  const size_t numItems = 50;
+  const size_t numRatings = 100;
+  const size_t iterations = 30;
+  const size_t rank = 10;
+  const double lambda = 0.01;
+
+  arma::mat parameters = arma::randu(rank, numUsers + numItems);
+
+  arma::mat data = arma::randu(3, numRatings);
+  data.row(0) = floor(data.row(0) * numUsers);
+  data.row(1) = floor(data.row(1) * numItems);
+  data(0, numRatings - 1) = numUsers - 1;
+  data(1, numRatings - 1) = numItems - 1;
+  for (size_t i = 0; i < numRatings; i++)
+  {
+    data(2, i) = arma::dot(parameters.col(data(0, i)),
+                           parameters.col(numUsers + data(1, i)));
+  }
+
+  // The gradient of the function is twice the step of the StandardSGD
+  // specialization, so half its step size is used.
+  RegularizedSVDFunction rSVDFunc(data, rank, lambda);
+  mlpack::optimization::HogwildSGD<RegularizedSVDFunction> optimizer(rSVDFunc,
+      32, 0.005, iterations, 0);
+
+  arma::mat optParameters = arma::randu(rank, numUsers + numItems);
+  optimizer.Optimize(optParameters);
+
+  arma::mat predictedData(1, numRatings);
+  for (size_t i = 0; i < numRatings; i++)
+  {
+    predictedData(0, i) = arma::dot(optParameters.col(data(0, i)),
+                                    optParameters.col(numUsers + data(1, i)));
+  }
+
+  const double relativeError = arma::norm(data.row(2) - predictedData, "frob") /
+                               arma::norm(data, "frob");
+
+  BOOST_REQUIRE_SMALL(relativeError, 2e-2);
+}
+
 BOOST_AUTO_TEST_CASE(RegularizedSVDFunctionOptimize)
 {
   // Define useful constants.
@@ -249,4 +342,59 @@ BOOST_AUTO_TEST_CASE(RegularizedSVDFunctionOptimize)
   BOOST_REQUIRE_SMALL(relativeError, 1e-2);
 }
 
+/**
+ * Make sure both schemes of ParallelRegularizedSVD fit a low-rank set of
+ * ratings, with the outputs laid out like those of RegularizedSVD.
+ */
+BOOST_AUTO_TEST_CASE(ParallelRegularizedSVDTest)
+{
+  const size_t numUsers = 40;
+  const size_t numItems = 30;
+  const size_t rank = 3;
+
+  // Rate most of the items of every user with a rank 3 model.
+  const arma::mat users = arma::randu(rank, numUsers);
+  const arma::mat items = arma::randu(rank, numItems);
+  arma::mat data(3, numUsers * numItems);
+  size_t numRatings = 0;
+  for (size_t i = 0; i < numUsers; ++i)
+  {
+    for (size_t j = 0; j < numItems; ++j)
+    {
+      if ((i + j) % 4 == 0 && !(i == numUsers - 1 && j == numItems - 1))
+        continue;
+
+      data(0, numRatings) = i;
+      data(1, numRatings) = j;
+      data(2, numRatings) = arma::dot(users.col(i), items.col(j));
+      ++numRatings;
+    }
+  }
+  data.resize(3, numRatings);
+
+  for (size_t stratified = 0; stratified < 2; ++stratified)
+  {
+    ParallelRegularizedSVD rSVD(200, 0.05, 0.001, stratified == 1);
+    BOOST_REQUIRE_EQUAL(rSVD.Stratified(), stratified == 1);
+
+    arma::mat u, v;
+    rSVD.Apply(data, rank, u, v);
+    BOOST_REQUIRE_EQUAL(u.n_rows, numItems);
+    BOOST_REQUIRE_EQUAL(u.n_cols, rank);
+    BOOST_REQUIRE_EQUAL(v.n_rows, rank);
+    BOOST_REQUIRE_EQUAL(v.n_cols, numUsers);
+
+    arma::rowvec predictions(numRatings);
+    for (size_t i = 0; i < numRatings; ++i)
+    {
+      predictions[i] = arma::dot(u.row(data(1, i)),
+          v.col(data(0, i)).t());
+    }
+
+    const double relativeError = arma::norm(data.row(2) - predictions, 2) /
+        arma::norm(data.row(2), 2);
+    BOOST_REQUIRE_SMALL(relativeError, 0.02);
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
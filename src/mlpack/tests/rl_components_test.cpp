@@ -14,9 +14,16 @@
 
 #include <mlpack/methods/reinforcement_learning/environment/mountain_car.hpp>
 #include <mlpack/methods/reinforcement_learning/environment/cart_pole.hpp>
+#include <mlpack/methods/reinforcement_learning/environment/vector_environment.hpp>
 #include <mlpack/methods/reinforcement_learning/replay/random_replay.hpp>
+#include <mlpack/methods/reinforcement_learning/replay/concurrent_replay.hpp>
+#include <mlpack/methods/reinforcement_learning/replay/prioritized_replay.hpp>
+#include <mlpack/methods/reinforcement_learning/replay/transition_queue.hpp>
 #include <mlpack/methods/reinforcement_learning/policy/greedy_policy.hpp>
 
+#include <atomic>
+#include <thread>
+
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
 
@@ -122,4 +129,427 @@ BOOST_AUTO_TEST_CASE(GreedyPolicyTest)
   BOOST_REQUIRE_CLOSE(actionValue[action], actionValue.max(), 1e-5);
 }
 
+/**
+ * Make sure the batched dynamics of CartPole and MountainCar match the
+ * dynamics of each single state.
+ */
+BOOST_AUTO_TEST_CASE(BatchSampleTest)
+{
+  const CartPole cartPole;
+  arma::mat cartStates(CartPole::State::dimension, 50);
+  std::vector<CartPole::Action> cartActions(50);
+  for (size_t i = 0; i < 50; ++i)
+  {
+    cartStates.col(i) = cartPole.InitialSample().Encode();
+    cartActions[i] = (i % 2 == 0) ? CartPole::Action::backward :
+        CartPole::Action::forward;
+  }
+
+  arma::mat cartNextStates;
+  arma::colvec cartRewards;
+  cartPole.Sample(cartStates, cartActions, cartNextStates, cartRewards);
+  const arma::icolvec cartTerminal = cartPole.IsTerminal(cartNextStates);
+
+  for (size_t i = 0; i < 50; ++i)
+  {
+    CartPole::State nextState;
+    const double reward = cartPole.Sample(
+        CartPole::State(cartStates.col(i)), cartActions[i], nextState);
+    BOOST_REQUIRE_EQUAL(cartRewards[i], reward);
+    BOOST_REQUIRE_EQUAL(cartTerminal[i], cartPole.IsTerminal(nextState));
+    for (size_t d = 0; d < CartPole::State::dimension; ++d)
+    {
+      BOOST_REQUIRE_CLOSE(cartNextStates(d, i) + 1.0,
+          nextState.Encode()[d] + 1.0, 1e-10);
+    }
+  }
+
+  const MountainCar mountainCar;
+  arma::mat carStates(MountainCar::State::dimension, 60);
+  std::vector<MountainCar::Action> carActions(60);
+  for (size_t i = 0; i < 60; ++i)
+  {
+    carStates.col(i) = mountainCar.InitialSample().Encode();
+    carActions[i] = MountainCar::Action(i % 3);
+  }
+  // Put some cars at the edges, so the velocity and position are clamped.
+  carStates(1, 0) = -1.2;
+  carStates(1, 1) = 0.5;
+  carStates(0, 1) = 0.07;
+
+  arma::mat carNextStates;
+  arma::colvec carRewards;
+  mountainCar.Sample(carStates, carActions, carNextStates, carRewards);
+  const arma::icolvec carTerminal = mountainCar.IsTerminal(carNextStates);
+
+  for (size_t i = 0; i < 60; ++i)
+  {
+    MountainCar::State nextState;
+    const double reward = mountainCar.Sample(
+        MountainCar::State(carStates.col(i)), carActions[i], nextState);
+    BOOST_REQUIRE_EQUAL(carRewards[i], reward);
+    BOOST_REQUIRE_EQUAL(carTerminal[i], mountainCar.IsTerminal(nextState));
+    for (size_t d = 0; d < MountainCar::State::dimension; ++d)
+    {
+      BOOST_REQUIRE_CLOSE(carNextStates(d, i) + 1.0,
+          nextState.Encode()[d] + 1.0, 1e-10);
+    }
+  }
+  BOOST_REQUIRE_EQUAL(carTerminal[1], 1);
+}
+
+/**
+ * Make sure that a vectorized environment only restarts the lanes whose
+ * episode ended.
+ */
+BOOST_AUTO_TEST_CASE(VectorEnvironmentTest)
+{
+  VectorEnvironment<CartPole> env(32);
+  BOOST_REQUIRE_EQUAL(env.NumEnvironments(), 32);
+  BOOST_REQUIRE_EQUAL(env.States().n_rows, CartPole::State::dimension);
+
+  // Always pushing forward makes every pole fall eventually.
+  const std::vector<CartPole::Action> actions(32, CartPole::Action::forward);
+  arma::mat nextStates;
+  arma::colvec rewards;
+  arma::icolvec terminal;
+  size_t episodes = 0;
+  for (size_t step = 0; step < 200; ++step)
+  {
+    env.Step(actions, nextStates, rewards, terminal);
+
+    BOOST_REQUIRE_EQUAL(nextStates.n_cols, 32);
+    BOOST_REQUIRE_EQUAL(rewards.n_elem, 32);
+    for (size_t i = 0; i < 32; ++i)
+    {
+      if (terminal[i])
+      {
+        // The lane was restarted within [-0.05, 0.05].
+        ++episodes;
+        BOOST_REQUIRE(env.Environment().IsTerminal(
+            CartPole::State(nextStates.col(i))));
+        BOOST_REQUIRE_LE(arma::abs(env.States().col(i)).max(), 0.05);
+      }
+      else
+      {
+        CheckMatrices(env.States().col(i), nextStates.col(i));
+      }
+    }
+  }
+
+  BOOST_REQUIRE_GE(episodes, 32);
+
+  // The wrong number of actions is rejected.
+  BOOST_REQUIRE_THROW(env.Step(std::vector<CartPole::Action>(3), nextStates,
+      rewards, terminal), std::invalid_argument);
+}
+
+/**
+ * Make sure that sampling from a random replay reuses the given objects.
+ */
+BOOST_AUTO_TEST_CASE(RandomReplayNoAllocationTest)
+{
+  RandomReplay<MountainCar> replay(32, 100);
+  MountainCar env;
+  for (size_t i = 0; i < 50; ++i)
+  {
+    MountainCar::State state = env.InitialSample();
+    MountainCar::State nextState;
+    const double reward = env.Sample(state, MountainCar::Action::stop,
+        nextState);
+    replay.Store(state, MountainCar::Action::stop, reward, nextState, false);
+  }
+
+  arma::mat sampledState, sampledNextState;
+  arma::icolvec sampledAction, sampledTerminal;
+  arma::colvec sampledReward;
+  replay.Sample(sampledState, sampledAction, sampledReward, sampledNextState,
+      sampledTerminal);
+  BOOST_REQUIRE_EQUAL(sampledState.n_cols, 32);
+
+  const double* statePtr = sampledState.memptr();
+  const double* nextStatePtr = sampledNextState.memptr();
+  replay.Sample(sampledState, sampledAction, sampledReward, sampledNextState,
+      sampledTerminal);
+  BOOST_REQUIRE_EQUAL(sampledState.memptr(), statePtr);
+  BOOST_REQUIRE_EQUAL(sampledNextState.memptr(), nextStatePtr);
+}
+
+/**
+ * Make sure that a sum tree finds the index of each prefix sum.
+ */
+BOOST_AUTO_TEST_CASE(SumTreeTest)
+{
+  SumTree tree(5);
+  const double values[] = { 1.0, 0.0, 2.0, 0.5, 1.5 };
+  for (size_t i = 0; i < 5; ++i)
+    tree.Set(i, values[i]);
+
+  BOOST_REQUIRE_CLOSE(tree.Sum(), 5.0, 1e-10);
+  BOOST_REQUIRE_EQUAL(tree.Find(0.0), 0);
+  BOOST_REQUIRE_EQUAL(tree.Find(0.99), 0);
+  BOOST_REQUIRE_EQUAL(tree.Find(1.0), 2);
+  BOOST_REQUIRE_EQUAL(tree.Find(2.9), 2);
+  BOOST_REQUIRE_EQUAL(tree.Find(3.2), 3);
+  BOOST_REQUIRE_EQUAL(tree.Find(4.9), 4);
+
+  // Values past the sum give the last nonzero index.
+  BOOST_REQUIRE_EQUAL(tree.Find(5.0), 4);
+  tree.Set(4, 0.0);
+  BOOST_REQUIRE_CLOSE(tree.Sum(), 3.5, 1e-10);
+  BOOST_REQUIRE_EQUAL(tree.Find(3.5), 3);
+}
+
+/**
+ * Make sure that a prioritized replay samples experiences in proportion to
+ * their priorities, and weights them accordingly.
+ */
+BOOST_AUTO_TEST_CASE(PrioritizedReplayTest)
+{
+  PrioritizedReplay<MountainCar> replay(10, 4, 1.0, 1.0);
+  MountainCar env;
+  std::vector<MountainCar::State> states;
+  for (size_t i = 0; i < 4; ++i)
+  {
+    states.push_back(env.InitialSample());
+    MountainCar::State nextState;
+    const double reward = env.Sample(states[i], MountainCar::Action::forward,
+        nextState);
+    replay.Store(states[i], MountainCar::Action::forward, reward, nextState,
+        false);
+  }
+  BOOST_REQUIRE_EQUAL(replay.Size(), 4);
+
+  // The priorities are 1, 1, 1, 97.
+  arma::Col<size_t> indices("0 1 2 3");
+  replay.UpdatePriorities(indices, arma::colvec("1 -1 1 -97"));
+
+  arma::mat sampledState, sampledNextState;
+  arma::icolvec sampledAction, sampledTerminal;
+  arma::colvec sampledReward, weights;
+  arma::Col<size_t> sampledIndices;
+  size_t lastCount = 0;
+  for (size_t trial = 0; trial < 100; ++trial)
+  {
+    replay.Sample(sampledState, sampledAction, sampledReward, sampledNextState,
+        sampledTerminal, sampledIndices, weights);
+
+    for (size_t i = 0; i < 10; ++i)
+    {
+      const size_t index = sampledIndices[i];
+      CheckMatrices(sampledState.col(i), states[index].Encode());
+      if (index == 3)
+      {
+        ++lastCount;
+        // The weights are relative to the rarest sampled experience.
+        if (sampledIndices.min() != 3)
+          BOOST_REQUIRE_CLOSE(weights[i], 1.0 / 97.0, 1e-5);
+      }
+      else
+      {
+        BOOST_REQUIRE_CLOSE(weights[i], 1.0, 1e-5);
+      }
+    }
+  }
+
+  // Of the ten segments of the priorities, only the first, [0, 10), holds the
+  // first three experiences.
+  BOOST_REQUIRE_GE(lastCount, 900);
+}
+
+/**
+ * Fill a small transition queue from many threads while it is emptied, and
+ * make sure every transition arrives once, in the order of its producer.
+ */
+BOOST_AUTO_TEST_CASE(TransitionQueueTest)
+{
+  TransitionQueue<MountainCar> queue(64);
+  BOOST_REQUIRE_EQUAL(queue.Capacity(), 64);
+
+  // Each producer encodes its index in the velocity and the number of the
+  // transition in the position.
+  const size_t producers = 4;
+  const size_t transitions = 5000;
+  std::vector<std::thread> threads;
+  for (size_t p = 0; p < producers; ++p)
+  {
+    threads.push_back(std::thread([&queue, p, transitions]()
+    {
+      MountainCar::State state, nextState;
+      for (size_t i = 0; i < transitions; ++i)
+      {
+        state.Velocity() = p;
+        state.Position() = i;
+        nextState.Velocity() = p;
+        nextState.Position() = i + 1;
+        while (!queue.Push(state, MountainCar::Action(i % 3), (double) i,
+            nextState, i + 1 == transitions))
+          std::this_thread::yield();
+      }
+    }));
+  }
+
+  std::vector<size_t> received(producers, 0);
+  MountainCar::State state, nextState;
+  MountainCar::Action action;
+  double reward;
+  bool isEnd;
+  size_t total = 0;
+  while (total < producers * transitions)
+  {
+    if (!queue.Pop(state, action, reward, nextState, isEnd))
+    {
+      std::this_thread::yield();
+      continue;
+    }
+
+    const size_t p = (size_t) state.Velocity();
+    const size_t i = (size_t) state.Position();
+    BOOST_REQUIRE_LT(p, producers);
+    BOOST_REQUIRE_EQUAL(i, received[p]);
+    BOOST_REQUIRE_EQUAL((size_t) action, i % 3);
+    BOOST_REQUIRE_EQUAL(reward, (double) i);
+    BOOST_REQUIRE_EQUAL((size_t) nextState.Position(), i + 1);
+    BOOST_REQUIRE_EQUAL(isEnd, i + 1 == transitions);
+    ++received[p];
+    ++total;
+  }
+
+  for (size_t p = 0; p < producers; ++p)
+    threads[p].join();
+
+  BOOST_REQUIRE(!queue.Pop(state, action, reward, nextState, isEnd));
+}
+
+/**
+ * Store experiences from 32 threads into a small ConcurrentReplay while other
+ * threads sample from it, and make sure each sampled experience is one that
+ * was stored whole.
+ */
+BOOST_AUTO_TEST_CASE(ConcurrentReplayTest)
+{
+  ConcurrentReplay<MountainCar> replay(16, 64);
+  BOOST_REQUIRE_EQUAL(replay.Size(), 0);
+
+  // Each experience encodes one number k in all of its fields.
+  const size_t producers = 32;
+  const size_t experiences = 500;
+  std::atomic<size_t> finished(0);
+  std::vector<std::thread> threads;
+  for (size_t p = 0; p < producers; ++p)
+  {
+    threads.push_back(std::thread([&replay, &finished, p, experiences]()
+    {
+      MountainCar::State state, nextState;
+      for (size_t i = 0; i < experiences; ++i)
+      {
+        const size_t k = p * experiences + i;
+        state.Position() = k;
+        state.Velocity() = k;
+        nextState.Position() = k + 1;
+        nextState.Velocity() = k + 1;
+        replay.Store(state, MountainCar::Action(k % 3), (double) k, nextState,
+            k % 2 == 0);
+      }
+      ++finished;
+    }));
+  }
+
+  const size_t samplers = 2;
+  std::atomic<size_t> mismatches(0);
+  for (size_t s = 0; s < samplers; ++s)
+  {
+    threads.push_back(std::thread([&replay, &finished, &mismatches,
+        producers, s]()
+    {
+      math::RandomStream stream(math::randStreamSeed, s);
+      arma::mat states, nextStates;
+      arma::icolvec actions, isTerminal;
+      arma::colvec rewards;
+      while (finished < producers)
+      {
+        replay.Sample(states, actions, rewards, nextStates, isTerminal,
+            stream);
+        for (size_t i = 0; i < rewards.n_elem; ++i)
+        {
+          const size_t k = (size_t) rewards[i];
+          if (states(0, i) != k || states(1, i) != k ||
+              nextStates(0, i) != k + 1 || nextStates(1, i) != k + 1 ||
+              (size_t) actions[i] != k % 3 ||
+              (size_t) isTerminal[i] != (size_t) (k % 2 == 0))
+            ++mismatches;
+        }
+      }
+    }));
+  }
+
+  for (size_t i = 0; i < threads.size(); ++i)
+    threads[i].join();
+
+  BOOST_REQUIRE_EQUAL(mismatches, 0);
+  BOOST_REQUIRE_EQUAL(replay.Size(), 64);
+
+  // Once the producers are done, each slot holds a whole experience.
+  arma::mat states, nextStates;
+  arma::icolvec actions, isTerminal;
+  arma::colvec rewards;
+  replay.Sample(states, actions, rewards, nextStates, isTerminal);
+  BOOST_REQUIRE_EQUAL(rewards.n_elem, 16);
+  for (size_t i = 0; i < rewards.n_elem; ++i)
+  {
+    BOOST_REQUIRE_EQUAL(states(0, i), rewards[i]);
+    BOOST_REQUIRE_EQUAL(nextStates(0, i), rewards[i] + 1);
+    BOOST_REQUIRE_LT(rewards[i], producers * experiences);
+  }
+}
+
+/**
+ * Sample from a ConcurrentReplay on two threads at once, with their own random
+ * streams and with the random streams of the threads, and make sure the
+ * threads get different batches.
+ */
+BOOST_AUTO_TEST_CASE(ConcurrentReplayThreadSamplesTest)
+{
+  ConcurrentReplay<MountainCar> replay(16, 64);
+  MountainCar::State state, nextState;
+  for (size_t k = 0; k < 64; ++k)
+  {
+    state.Position() = k;
+    nextState.Position() = k + 1;
+    replay.Store(state, MountainCar::Action(k % 3), (double) k, nextState,
+        false);
+  }
+
+  for (size_t ownStreams = 0; ownStreams < 2; ++ownStreams)
+  {
+    arma::colvec rewards[2];
+    std::vector<std::thread> threads;
+    for (size_t s = 0; s < 2; ++s)
+    {
+      threads.push_back(std::thread([&replay, &rewards, ownStreams, s]()
+      {
+        arma::mat states, nextStates;
+        arma::icolvec actions, isTerminal;
+        if (ownStreams)
+        {
+          math::RandomStream stream(17, s);
+          replay.Sample(states, actions, rewards[s], nextStates, isTerminal,
+              stream);
+        }
+        else
+        {
+          replay.Sample(states, actions, rewards[s], nextStates, isTerminal);
+        }
+      }));
+    }
+
+    for (size_t s = 0; s < threads.size(); ++s)
+      threads[s].join();
+
+    BOOST_REQUIRE_EQUAL(rewards[0].n_elem, 16);
+    BOOST_REQUIRE_EQUAL(rewards[1].n_elem, 16);
+    BOOST_REQUIRE_GT(arma::accu(rewards[0] != rewards[1]), 0);
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -132,4 +132,88 @@ BOOST_AUTO_TEST_CASE(RastrigrinFunctionTest)
   BOOST_REQUIRE_GE(successes, 1);
 }
 
+/**
+ * Run several chains with exchanges on the Rastrigrin function.  As with one
+ * chain, this only has to work once in a few tries.
+ */
+BOOST_AUTO_TEST_CASE(ParallelTemperingRastrigrinTest)
+{
+  size_t successes = 0;
+
+  for (size_t trial = 0; trial < 8; ++trial)
+  {
+    RastrigrinFunction f;
+    ExponentialSchedule schedule(3e-6);
+    SA<RastrigrinFunction> sa(f, schedule, 20000000, 100, 50, 1000, 1e-12, 2,
+        0.2, 0.01, 0.1, 4, 10, 0.5);
+    arma::mat coordinates = f.GetInitialPoint();
+
+    const double result = sa.Optimize(coordinates);
+
+    // The result is the energy of the returned point.
+    BOOST_REQUIRE_CLOSE(result + 1.0, f.Evaluate(coordinates) + 1.0, 1e-5);
+
+    if ((std::abs(result) < 1e-3) &&
+        (std::abs(coordinates[0]) < 1e-3) &&
+        (std::abs(coordinates[1]) < 1e-3))
+    {
+      ++successes;
+      break; // No need to continue.
+    }
+  }
+
+  BOOST_REQUIRE_GE(successes, 1);
+}
+
+/**
+ * A sum of squares that implements EvaluateDelta(), so that each move of SA
+ * only evaluates the changed coordinate.
+ */
+class SquaresDeltaFunction
+{
+ public:
+  double Evaluate(const arma::mat& coordinates) const
+  {
+    return arma::accu(arma::square(coordinates));
+  }
+
+  double EvaluateDelta(const arma::mat& coordinates,
+                       const size_t i,
+                       const double value) const
+  {
+    return value * value - coordinates[i] * coordinates[i];
+  }
+
+  arma::mat GetInitialPoint() const
+  {
+    return arma::mat(10, 1).fill(5.0);
+  }
+};
+
+/**
+ * Make sure that EvaluateDelta() is detected and that SA minimizes a function
+ * with it, with one chain and with several.
+ */
+BOOST_AUTO_TEST_CASE(EvaluateDeltaTest)
+{
+  BOOST_REQUIRE_EQUAL(HasEvaluateDelta<SquaresDeltaFunction>::value, true);
+  BOOST_REQUIRE_EQUAL(HasEvaluateDelta<RosenbrockFunction>::value, false);
+
+  for (size_t chains = 1; chains <= 3; chains += 2)
+  {
+    SquaresDeltaFunction f;
+    ExponentialSchedule schedule(1e-5);
+    SA<SquaresDeltaFunction> sa(f, schedule, 10000000, 1000., 1000, 100,
+        1e-11, 3, 20, 0.3, 0.3, chains);
+    arma::mat coordinates = f.GetInitialPoint();
+
+    const double result = sa.Optimize(coordinates);
+
+    BOOST_REQUIRE_SMALL(result, 1e-6);
+    BOOST_REQUIRE_SMALL(result - f.Evaluate(coordinates), 1e-12);
+    for (size_t j = 0; j < coordinates.n_elem; ++j)
+      BOOST_REQUIRE_SMALL(coordinates[j], 1e-2);
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
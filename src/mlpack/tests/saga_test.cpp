@@ -0,0 +1,149 @@
+/**
+ * @file saga_test.cpp
+ *
+ * Tests the SAGA optimizer.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include <mlpack/core.hpp>
+
+#include <mlpack/core/optimizers/saga/saga.hpp>
+#include <mlpack/core/optimizers/lbfgs/lbfgs.hpp>
+#include <mlpack/core/optimizers/sgd/test_function.hpp>
+#include <mlpack/methods/logistic_regression/logistic_regression.hpp>
+
+#include <boost/test/unit_test.hpp>
+#include "test_tools.hpp"
+
+using namespace arma;
+using namespace mlpack::optimization;
+using namespace mlpack::optimization::test;
+
+using namespace mlpack::distribution;
+using namespace mlpack::regression;
+
+using namespace mlpack;
+
+BOOST_AUTO_TEST_SUITE(SAGATest);
+
+/**
+ * A logistic regression objective that hides the linear model functions, so
+ * that SAGA keeps a table of full gradients.
+ */
+class DenseLogisticRegressionFunction
+{
+ public:
+  DenseLogisticRegressionFunction(LogisticRegressionFunction<>& function) :
+      function(function) { }
+
+  size_t NumFunctions() const { return function.NumFunctions(); }
+
+  double Evaluate(const arma::mat& coordinates, const size_t i) const
+  {
+    return function.Evaluate(coordinates, i);
+  }
+
+  void Gradient(const arma::mat& coordinates,
+                const size_t i,
+                arma::mat& gradient) const
+  {
+    function.Gradient(coordinates, i, gradient);
+  }
+
+ private:
+  LogisticRegressionFunction<>& function;
+};
+
+//! Generate a two-Gaussian dataset.
+void GaussianDataset(arma::mat& data, arma::Row<size_t>& responses)
+{
+  GaussianDistribution g1(arma::vec("1.0 1.0 1.0"), arma::eye<arma::mat>(3, 3));
+  GaussianDistribution g2(arma::vec("3.0 3.0 3.0"), arma::eye<arma::mat>(3, 3));
+
+  data.set_size(3, 1000);
+  responses.set_size(1000);
+  for (size_t i = 0; i < 500; ++i)
+  {
+    data.col(i) = g1.Random();
+    responses[i] = 0;
+  }
+  for (size_t i = 500; i < 1000; ++i)
+  {
+    data.col(i) = g2.Random();
+    responses[i] = 1;
+  }
+}
+
+/**
+ * Tests the SAGA optimizer using a simple test function.
+ */
+BOOST_AUTO_TEST_CASE(SimpleSAGATestFunction)
+{
+  SGDTestFunction f;
+  SAGA<SGDTestFunction> optimizer(f, 1e-3, 500000, 1e-12, true);
+
+  arma::mat coordinates = f.GetInitialPoint();
+  optimizer.Optimize(coordinates);
+
+  BOOST_REQUIRE_SMALL(coordinates[0], 0.1);
+  BOOST_REQUIRE_SMALL(coordinates[1], 0.1);
+  BOOST_REQUIRE_SMALL(coordinates[2], 0.1);
+}
+
+/**
+ * Make sure the compact table is used for logistic regression, and that SAGA
+ * reaches the optimum found by L-BFGS with it.
+ */
+BOOST_AUTO_TEST_CASE(SAGALogisticRegressionTest)
+{
+  BOOST_REQUIRE(HasLinearGradient<LogisticRegressionFunction<>>::value);
+  BOOST_REQUIRE(!HasLinearGradient<DenseLogisticRegressionFunction>::value);
+
+  arma::mat data;
+  arma::Row<size_t> responses;
+  GaussianDataset(data, responses);
+
+  LogisticRegressionFunction<> lrf(data, responses, 10.0);
+
+  arma::mat optimum = lrf.GetInitialPoint();
+  L_BFGS<LogisticRegressionFunction<>> lbfgs(lrf);
+  const double minimum = lbfgs.Optimize(optimum);
+
+  arma::mat coordinates = lrf.GetInitialPoint();
+  SAGA<LogisticRegressionFunction<>> saga(lrf, 0.01, 30, 0);
+  const double objective = saga.Optimize(coordinates);
+
+  BOOST_REQUIRE_CLOSE(objective, minimum, 0.1);
+  BOOST_REQUIRE_SMALL(arma::norm(coordinates - optimum, 2) /
+      arma::norm(optimum, 2), 0.05);
+}
+
+/**
+ * Make sure SAGA with a table of full gradients reaches the same optimum.
+ */
+BOOST_AUTO_TEST_CASE(SAGADenseTableTest)
+{
+  arma::mat data;
+  arma::Row<size_t> responses;
+  GaussianDataset(data, responses);
+
+  LogisticRegressionFunction<> lrf(data, responses, 10.0);
+
+  arma::mat optimum = lrf.GetInitialPoint();
+  L_BFGS<LogisticRegressionFunction<>> lbfgs(lrf);
+  const double minimum = lbfgs.Optimize(optimum);
+
+  DenseLogisticRegressionFunction f(lrf);
+  arma::mat coordinates = lrf.GetInitialPoint();
+  SAGA<DenseLogisticRegressionFunction> saga(f, 0.01, 30, 0);
+  const double objective = saga.Optimize(coordinates);
+
+  BOOST_REQUIRE_CLOSE(objective, minimum, 0.1);
+  BOOST_REQUIRE_SMALL(arma::norm(coordinates - optimum, 2) /
+      arma::norm(optimum, 2), 0.05);
+}
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -360,12 +360,12 @@ BOOST_AUTO_TEST_CASE(BallBoundTest)
 
 BOOST_AUTO_TEST_CASE(MahalanobisBallBoundTest)
 {
-  BallBound<MahalanobisDistance<>, arma::vec> b(100);
+  BallBound<MahalanobisDistance<>, double, arma::vec> b(100);
   b.Center().randu();
   b.Radius() = 14.0;
   b.Metric().Covariance().randu(100, 100);
 
-  BallBound<MahalanobisDistance<>, arma::vec> xmlB, textB, binaryB;
+  BallBound<MahalanobisDistance<>, double, arma::vec> xmlB, textB, binaryB;
 
   SerializeObjectAll(b, xmlB, textB, binaryB);
 
@@ -1232,16 +1232,10 @@ BOOST_AUTO_TEST_CASE(LSHTest)
   BOOST_REQUIRE_EQUAL(lsh.BucketSize(), textLsh.BucketSize());
   BOOST_REQUIRE_EQUAL(lsh.BucketSize(), binaryLsh.BucketSize());
 
-  BOOST_REQUIRE_EQUAL(lsh.SecondHashTable().size(),
-      xmlLsh.SecondHashTable().size());
-  BOOST_REQUIRE_EQUAL(lsh.SecondHashTable().size(),
-      textLsh.SecondHashTable().size());
-  BOOST_REQUIRE_EQUAL(lsh.SecondHashTable().size(),
-      binaryLsh.SecondHashTable().size());
-
-  for (size_t i = 0; i < lsh.SecondHashTable().size(); ++i)
-  CheckMatrices(lsh.SecondHashTable()[i], xmlLsh.SecondHashTable()[i],
-      textLsh.SecondHashTable()[i], binaryLsh.SecondHashTable()[i]);
+  CheckMatrices(lsh.BucketOffsets(), xmlLsh.BucketOffsets(),
+      textLsh.BucketOffsets(), binaryLsh.BucketOffsets());
+  CheckMatrices(lsh.BucketContents(), xmlLsh.BucketContents(),
+      textLsh.BucketContents(), binaryLsh.BucketContents());
 }
 
 // Make sure serialization works for the decision stump.
@@ -1690,4 +1684,41 @@ BOOST_AUTO_TEST_CASE(HoeffdingTreeTest)
   }
 }
 
+/**
+ * Make sure the mappings of a DatasetInfo survive serialization.
+ */
+BOOST_AUTO_TEST_CASE(DatasetInfoSerializationTest)
+{
+  data::DatasetInfo info(3);
+  info.MapString<double>("x", 0);
+  info.MapString<double>("", 0);
+  info.MapString<double>("y", 0);
+  info.MapString<double>("b", 2);
+  info.MapString<double>("a", 2);
+
+  data::DatasetInfo xmlInfo(1), textInfo(4), binaryInfo(2);
+  SerializeObjectAll(info, xmlInfo, textInfo, binaryInfo);
+
+  data::DatasetInfo* infos[] = { &xmlInfo, &textInfo, &binaryInfo };
+  for (size_t i = 0; i < 3; ++i)
+  {
+    data::DatasetInfo& other = *infos[i];
+    BOOST_REQUIRE_EQUAL(other.Dimensionality(), 3);
+    BOOST_REQUIRE(other.Type(0) == data::Datatype::categorical);
+    BOOST_REQUIRE(other.Type(1) == data::Datatype::numeric);
+    BOOST_REQUIRE(other.Type(2) == data::Datatype::categorical);
+    BOOST_REQUIRE_EQUAL(other.NumMappings(0), 3);
+    BOOST_REQUIRE_EQUAL(other.NumMappings(1), 0);
+    BOOST_REQUIRE_EQUAL(other.NumMappings(2), 2);
+    BOOST_REQUIRE_EQUAL(other.UnmapString(0, 0), "x");
+    BOOST_REQUIRE_EQUAL(other.UnmapString(1, 0), "");
+    BOOST_REQUIRE_EQUAL(other.UnmapString(2, 0), "y");
+    BOOST_REQUIRE_EQUAL(other.UnmapValue("a", 2), 1);
+
+    // New strings get the next values.
+    BOOST_REQUIRE_EQUAL(other.MapString<size_t>("c", 2), 2);
+    BOOST_REQUIRE_EQUAL(other.MapString<size_t>("b", 2), 0);
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -12,6 +12,7 @@
 #include <mlpack/core.hpp>
 #include <mlpack/core/optimizers/sgdr/cyclical_decay.hpp>
 #include <mlpack/core/optimizers/sgdr/sgdr.hpp>
+#include <mlpack/core/optimizers/sgd/test_function.hpp>
 #include <mlpack/methods/logistic_regression/logistic_regression.hpp>
 
 #include <boost/test/unit_test.hpp>
@@ -21,6 +22,7 @@ using namespace std;
 using namespace arma;
 using namespace mlpack;
 using namespace mlpack::optimization;
+using namespace mlpack::optimization::test;
 
 using namespace mlpack::distribution;
 using namespace mlpack::regression;
@@ -128,4 +130,35 @@ BOOST_AUTO_TEST_CASE(LogisticRegressionTest)
   }
 }
 
+/**
+ * Make sure that SGDR that is checkpointed and resumed continues the schedule
+ * of restarts where it stopped.
+ */
+BOOST_AUTO_TEST_CASE(CheckpointResumeTest)
+{
+  SGDTestFunction f;
+
+  // Restart every 2 passes; 30 mini-batches (10 passes) at a time.
+  SGDR<SGDTestFunction> optimizer(f, 2, 2.0, 1, 1e-4, 31, -1.0, false);
+  optimizer.Checkpoint("sgdr_checkpoint.xml");
+
+  arma::mat coordinates = f.GetInitialPoint();
+  optimizer.Optimize(coordinates);
+
+  SGDR<SGDTestFunction> resumed(f, 2, 2.0, 1, 1e-4, 31, -1.0, false);
+  arma::mat resumedCoordinates;
+  BOOST_REQUIRE(resumed.Resume("sgdr_checkpoint.xml", resumedCoordinates));
+  BOOST_REQUIRE_CLOSE(resumed.StepSize(), optimizer.StepSize(), 1e-5);
+  resumed.Optimize(resumedCoordinates);
+
+  SGDR<SGDTestFunction> continuous(f, 2, 2.0, 1, 1e-4, 61, -1.0, false);
+  arma::mat continuousCoordinates = f.GetInitialPoint();
+  continuous.Optimize(continuousCoordinates);
+
+  BOOST_REQUIRE_CLOSE(resumed.StepSize(), continuous.StepSize(), 1e-5);
+  CheckMatrices(resumedCoordinates, continuousCoordinates, 1e-3);
+
+  remove("sgdr_checkpoint.xml");
+}
+
 BOOST_AUTO_TEST_SUITE_END();
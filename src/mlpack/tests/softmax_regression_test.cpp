@@ -11,6 +11,7 @@
  */
 #include <mlpack/core.hpp>
 #include <mlpack/methods/softmax_regression/softmax_regression.hpp>
+#include <mlpack/core/optimizers/sgd/batch_function.hpp>
 
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
@@ -39,7 +40,7 @@ BOOST_AUTO_TEST_CASE(SoftmaxRegressionFunctionEvaluate)
     labels(i) = math::RandInt(0, numClasses);
 
   // Create a SoftmaxRegressionFunction. Regularization term ignored.
-  SoftmaxRegressionFunction srf(data, labels, numClasses, 0);
+  SoftmaxRegressionFunction<> srf(data, labels, numClasses, 0);
 
   // Run a number of trials.
   for (size_t i = 0; i < trials; i++)
@@ -84,9 +85,9 @@ BOOST_AUTO_TEST_CASE(SoftmaxRegressionFunctionRegularizationEvaluate)
     labels(i) = math::RandInt(0, numClasses);
 
   // 3 objects for comparing regularization costs.
-  SoftmaxRegressionFunction srfNoReg(data, labels, numClasses, 0);
-  SoftmaxRegressionFunction srfSmallReg(data, labels, numClasses, 1);
-  SoftmaxRegressionFunction srfBigReg(data, labels, numClasses, 20);
+  SoftmaxRegressionFunction<> srfNoReg(data, labels, numClasses, 0);
+  SoftmaxRegressionFunction<> srfSmallReg(data, labels, numClasses, 1);
+  SoftmaxRegressionFunction<> srfBigReg(data, labels, numClasses, 20);
 
   // Run a number of trials.
   for (size_t i = 0; i < trials; i++)
@@ -126,8 +127,8 @@ BOOST_AUTO_TEST_CASE(SoftmaxRegressionFunctionGradient)
 
   // 2 objects for 2 terms in the cost function. Each term contributes towards
   // the gradient and thus need to be checked independently.
-  SoftmaxRegressionFunction srf1(data, labels, numClasses, 0);
-  SoftmaxRegressionFunction srf2(data, labels, numClasses, 20);
+  SoftmaxRegressionFunction<> srf1(data, labels, numClasses, 0);
+  SoftmaxRegressionFunction<> srf2(data, labels, numClasses, 20);
 
   // Create a random set of parameters.
   arma::mat parameters;
@@ -172,6 +173,63 @@ BOOST_AUTO_TEST_CASE(SoftmaxRegressionFunctionGradient)
   }
 }
 
+/**
+ * Make sure that the objectives and gradients of the batches of points sum to
+ * the full objective and gradient, and that the optimizers see the batch
+ * functions.
+ */
+BOOST_AUTO_TEST_CASE(SoftmaxRegressionFunctionBatchTest)
+{
+  const size_t points = 100;
+  const size_t inputSize = 6;
+  const size_t numClasses = 4;
+
+  arma::mat data;
+  data.randu(inputSize, points);
+
+  arma::Row<size_t> labels(points);
+  for (size_t i = 0; i < points; i++)
+    labels(i) = math::RandInt(0, numClasses);
+
+  BOOST_REQUIRE(HasBatchEvaluate<SoftmaxRegressionFunction<>>::value);
+  BOOST_REQUIRE(HasBatchGradient<SoftmaxRegressionFunction<>>::value);
+
+  for (size_t intercept = 0; intercept < 2; ++intercept)
+  {
+    SoftmaxRegressionFunction<> srf(data, labels, numClasses, 0.5, intercept);
+    BOOST_REQUIRE_EQUAL(srf.NumFunctions(), points);
+
+    arma::mat parameters;
+    parameters.randu(numClasses, inputSize + intercept);
+
+    arma::mat gradient;
+    srf.Gradient(parameters, gradient);
+
+    // Uneven batches, so that the last one is smaller.
+    double objective = 0;
+    arma::mat batchGradient, sumGradient(arma::size(parameters),
+        arma::fill::zeros);
+    for (size_t begin = 0; begin < points; begin += 30)
+    {
+      const size_t batchSize = std::min((size_t) 30, points - begin);
+      objective += srf.Evaluate(parameters, begin, batchSize);
+      srf.Gradient(parameters, begin, batchGradient, batchSize);
+      sumGradient += batchGradient;
+    }
+
+    BOOST_REQUIRE_CLOSE(objective, srf.Evaluate(parameters), 1e-5);
+    CheckMatrices(sumGradient, gradient, 1e-5);
+
+    // One point is a batch of one.
+    srf.Gradient(parameters, 7, batchGradient);
+    arma::mat pointGradient;
+    srf.Gradient(parameters, 7, pointGradient, 1);
+    CheckMatrices(batchGradient, pointGradient);
+    BOOST_REQUIRE_CLOSE(srf.Evaluate(parameters, 7),
+        srf.Evaluate(parameters, 7, 1), 1e-10);
+  }
+}
+
 BOOST_AUTO_TEST_CASE(SoftmaxRegressionTwoClasses)
 {
   const size_t points = 1000;
@@ -362,8 +420,8 @@ BOOST_AUTO_TEST_CASE(SoftmaxRegressionTrainTest)
 
   // This should be the same as the default parameters given by
   // SoftmaxRegression.
-  SoftmaxRegressionFunction srf(dataset, labels, 2, 0.0001, false);
-  L_BFGS<SoftmaxRegressionFunction> lbfgs(srf);
+  SoftmaxRegressionFunction<> srf(dataset, labels, 2, 0.0001, false);
+  L_BFGS<SoftmaxRegressionFunction<>> lbfgs(srf);
   SoftmaxRegression<> sr(lbfgs);
 
   SoftmaxRegression<> sr2(dataset.n_rows, 2);
@@ -392,12 +450,12 @@ BOOST_AUTO_TEST_CASE(SoftmaxRegressionOptimizerTrainTest)
   for (size_t i = 500; i < 1000; ++i)
     labels[i] = size_t(1.0);
 
-  SoftmaxRegressionFunction srf(dataset, labels, 2, 0.01, true);
-  L_BFGS<SoftmaxRegressionFunction> lbfgs(srf);
+  SoftmaxRegressionFunction<> srf(dataset, labels, 2, 0.01, true);
+  L_BFGS<SoftmaxRegressionFunction<>> lbfgs(srf);
   SoftmaxRegression<> sr(lbfgs);
 
   SoftmaxRegression<> sr2(dataset.n_rows, 2, true);
-  L_BFGS<SoftmaxRegressionFunction> lbfgs2(srf);
+  L_BFGS<SoftmaxRegressionFunction<>> lbfgs2(srf);
   sr2.Parameters() = srf.GetInitialPoint();
   sr2.Train(lbfgs2);
 
@@ -671,4 +729,215 @@ BOOST_AUTO_TEST_CASE(SoftmaxRegressionComputeProbabilitiesAndLabelsTest)
   }
 }
 
+/**
+ * Make sure that the function gives the same objective and gradients on sparse
+ * data as on the same data stored densely.
+ */
+BOOST_AUTO_TEST_CASE(SoftmaxRegressionFunctionSparseTest)
+{
+  const size_t points = 200;
+  const size_t inputSize = 20;
+  const size_t numClasses = 3;
+
+  arma::sp_mat sparseData;
+  sparseData.sprandu(inputSize, points, 0.2);
+  const arma::mat denseData(sparseData);
+
+  arma::Row<size_t> labels(points);
+  for (size_t i = 0; i < points; i++)
+    labels(i) = math::RandInt(0, numClasses);
+
+  for (size_t intercept = 0; intercept < 2; ++intercept)
+  {
+    SoftmaxRegressionFunction<> dense(denseData, labels, numClasses, 0.3,
+        intercept);
+    SoftmaxRegressionFunction<arma::sp_mat> sparse(sparseData, labels,
+        numClasses, 0.3, intercept);
+
+    arma::mat parameters;
+    parameters.randu(numClasses, inputSize + intercept);
+
+    BOOST_REQUIRE_CLOSE(sparse.Evaluate(parameters),
+        dense.Evaluate(parameters), 1e-5);
+    BOOST_REQUIRE_CLOSE(sparse.Evaluate(parameters, 10, 50),
+        dense.Evaluate(parameters, 10, 50), 1e-5);
+
+    arma::mat denseGradient, sparseGradient;
+    dense.Gradient(parameters, denseGradient);
+    sparse.Gradient(parameters, sparseGradient);
+    CheckMatrices(sparseGradient, denseGradient, 1e-5);
+
+    // The sparse gradient of one point is the gradient of a batch of one,
+    // restricted to the intercept and the nonzero features of the point.
+    for (size_t i = 0; i < points; i += 17)
+    {
+      arma::sp_mat pointGradient;
+      sparse.Gradient(parameters, i, pointGradient);
+      dense.Gradient(parameters, i, denseGradient, 1);
+
+      BOOST_REQUIRE_EQUAL(pointGradient.n_rows, parameters.n_rows);
+      BOOST_REQUIRE_EQUAL(pointGradient.n_cols, parameters.n_cols);
+      for (size_t c = 0; c < parameters.n_cols; ++c)
+      {
+        const bool used = (intercept && c == 0) ||
+            (sparseData(c - intercept, i) != 0.0);
+        for (size_t r = 0; r < parameters.n_rows; ++r)
+        {
+          if (used)
+            BOOST_REQUIRE_CLOSE(pointGradient(r, c), denseGradient(r, c), 1e-5);
+          else
+            BOOST_REQUIRE_EQUAL(pointGradient(r, c), 0.0);
+        }
+      }
+    }
+  }
+}
+
+/**
+ * Train on sparse data and on the same data stored densely, and make sure the
+ * models are the same.
+ */
+BOOST_AUTO_TEST_CASE(SoftmaxRegressionSparseTrainTest)
+{
+  const size_t points = 300;
+  const size_t inputSize = 30;
+  const size_t numClasses = 3;
+
+  // Each class has its own set of active features.
+  arma::sp_mat sparseData(inputSize, points);
+  arma::Row<size_t> labels(points);
+  for (size_t i = 0; i < points; ++i)
+  {
+    labels(i) = i % numClasses;
+    for (size_t j = 0; j < 4; ++j)
+    {
+      const size_t feature = labels(i) * (inputSize / numClasses) +
+          math::RandInt(0, inputSize / numClasses);
+      sparseData(feature, i) = math::Random(0.5, 1.5);
+    }
+  }
+  const arma::mat denseData(sparseData);
+
+  // Start from the same point.
+  const arma::mat initialPoint =
+      SoftmaxRegressionFunction<>::InitializeWeights(inputSize, numClasses,
+      false);
+
+  SoftmaxRegressionFunction<> denseFunction(denseData, labels, numClasses,
+      0.01);
+  SoftmaxRegressionFunction<arma::sp_mat> sparseFunction(sparseData, labels,
+      numClasses, 0.01);
+
+  arma::mat denseParameters(initialPoint), sparseParameters(initialPoint);
+  L_BFGS<SoftmaxRegressionFunction<>> denseLbfgs(denseFunction);
+  L_BFGS<SoftmaxRegressionFunction<arma::sp_mat>> sparseLbfgs(sparseFunction);
+  denseLbfgs.Optimize(denseParameters);
+  sparseLbfgs.Optimize(sparseParameters);
+
+  CheckMatrices(sparseParameters, denseParameters, 1e-3);
+
+  // The model class takes sparse data too.
+  SoftmaxRegression<> sr(sparseData, labels, numClasses, 0.01);
+  BOOST_REQUIRE_GE(sr.ComputeAccuracy(sparseData, labels), 95.0);
+
+  arma::Row<size_t> sparsePredictions, densePredictions;
+  sr.Classify(sparseData, sparsePredictions);
+  sr.Classify(denseData, densePredictions);
+  for (size_t i = 0; i < points; ++i)
+    BOOST_REQUIRE_EQUAL(sparsePredictions(i), densePredictions(i));
+}
+
+/**
+ * Compare the blocked objective and gradient with a direct computation from the
+ * full probability matrix, with enough classes that the points are split into
+ * several blocks.
+ */
+BOOST_AUTO_TEST_CASE(SoftmaxRegressionFunctionBlockTest)
+{
+  const size_t points = 2500;
+  const size_t inputSize = 5;
+  const size_t numClasses = 1000;
+  const double lambda = 0.1;
+
+  arma::mat data;
+  data.randu(inputSize, points);
+
+  arma::Row<size_t> labels(points);
+  for (size_t i = 0; i < points; i++)
+    labels(i) = math::RandInt(0, numClasses);
+
+  BOOST_REQUIRE(HasBatchEvaluateWithGradient<SoftmaxRegressionFunction<>>::
+      value);
+
+  for (size_t intercept = 0; intercept < 2; ++intercept)
+  {
+    SoftmaxRegressionFunction<> srf(data, labels, numClasses, lambda,
+        intercept);
+
+    arma::mat parameters;
+    parameters.randn(numClasses, inputSize + intercept);
+
+    // Direct computation.
+    arma::mat scores = parameters.cols(intercept, inputSize + intercept - 1) *
+        data;
+    if (intercept)
+      scores.each_col() += parameters.col(0);
+    arma::mat probabilities = arma::exp(scores);
+    probabilities.each_row() /= arma::sum(probabilities, 0);
+
+    double objective = 0.0;
+    arma::mat inner = probabilities;
+    for (size_t i = 0; i < points; ++i)
+    {
+      objective -= std::log(probabilities(labels(i), i));
+      inner(labels(i), i) -= 1.0;
+    }
+    objective = objective / points + 0.5 * lambda *
+        arma::accu(parameters % parameters);
+
+    arma::mat expectedGradient(numClasses, inputSize + intercept);
+    if (intercept)
+      expectedGradient.col(0) = arma::sum(inner, 1);
+    expectedGradient.cols(intercept, inputSize + intercept - 1) =
+        inner * data.t();
+    expectedGradient = expectedGradient / points + lambda * parameters;
+
+    BOOST_REQUIRE_CLOSE(srf.Evaluate(parameters), objective, 1e-5);
+
+    arma::mat gradient;
+    srf.Gradient(parameters, gradient);
+    CheckMatrices(gradient, expectedGradient, 1e-5);
+
+    // A batch that doesn't start on a block boundary.
+    arma::mat batchGradient, fusedGradient;
+    srf.Gradient(parameters, 300, batchGradient, 1700);
+    const double fusedObjective = srf.EvaluateWithGradient(parameters, 300,
+        fusedGradient, 1700);
+    BOOST_REQUIRE_CLOSE(fusedObjective, srf.Evaluate(parameters, 300, 1700),
+        1e-5);
+    CheckMatrices(fusedGradient, batchGradient, 1e-5);
+  }
+}
+
+/**
+ * Make sure the objective is finite when the scores of the classes are too
+ * large to be exponentiated directly.
+ */
+BOOST_AUTO_TEST_CASE(SoftmaxRegressionFunctionLargeScoresTest)
+{
+  const arma::mat data("1 2 3");
+  const arma::Row<size_t> labels("0 1 1");
+
+  SoftmaxRegressionFunction<> srf(data, labels, 2, 0.0);
+
+  // The scores of the points are (1000, 0), (2000, 0) and (3000, 0), so the
+  // two last points each contribute their first score.
+  const arma::mat parameters("1000; 0");
+  BOOST_REQUIRE_CLOSE(srf.Evaluate(parameters), 5000.0 / 3.0, 1e-5);
+
+  arma::mat gradient;
+  srf.Gradient(parameters, gradient);
+  BOOST_REQUIRE(gradient.is_finite());
+}
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -11,12 +11,14 @@
  */
 #include <mlpack/core.hpp>
 #include <mlpack/methods/sparse_autoencoder/sparse_autoencoder.hpp>
+#include <mlpack/core/optimizers/minibatch_sgd/minibatch_sgd.hpp>
 
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
 
 using namespace mlpack;
 using namespace mlpack::nn;
+using namespace mlpack::optimization;
 
 BOOST_AUTO_TEST_SUITE(SparseAutoencoderTest);
 
@@ -268,4 +270,76 @@ BOOST_AUTO_TEST_CASE(SparseAutoencoderFunctionGradient)
   }
 }
 
+/**
+ * Make sure that the batch objectives and gradients are consistent with the
+ * objective and gradient of the whole dataset, which spans several blocks.
+ */
+BOOST_AUTO_TEST_CASE(SparseAutoencoderFunctionBatches)
+{
+  const size_t points = 10000;
+  const size_t vSize = 20;
+  const size_t hSize = 10;
+
+  arma::mat data;
+  data.randu(vSize, points);
+
+  SparseAutoencoderFunction saf(data, vSize, hSize, 0.5, 2);
+  const arma::mat parameters = saf.GetInitialPoint();
+
+  // The whole dataset as one batch.
+  arma::mat gradient, batchGradient;
+  saf.Gradient(parameters, gradient);
+  const double objective = saf.EvaluateWithGradient(parameters, 0,
+      batchGradient, points);
+
+  BOOST_REQUIRE_CLOSE(objective, saf.Evaluate(parameters), 1e-8);
+  BOOST_REQUIRE_EQUAL(batchGradient.n_rows, gradient.n_rows);
+  BOOST_REQUIRE_EQUAL(batchGradient.n_cols, gradient.n_cols);
+  for (size_t i = 0; i < gradient.n_elem; ++i)
+    BOOST_REQUIRE_SMALL(batchGradient[i] - gradient[i], 1e-10);
+
+  // Without the KL divergence, the batches sum to the whole objective and
+  // gradient.
+  SparseAutoencoderFunction saf2(data, vSize, hSize, 0.5, 0);
+  saf2.Gradient(parameters, gradient);
+
+  double sum = 0.0;
+  arma::mat sumGradient(gradient.n_rows, gradient.n_cols, arma::fill::zeros);
+  for (size_t begin = 0; begin < points; begin += 3000)
+  {
+    const size_t batchSize = std::min((size_t) 3000, points - begin);
+    sum += saf2.Evaluate(parameters, begin, batchSize);
+    saf2.Gradient(parameters, begin, batchGradient, batchSize);
+    sumGradient += batchGradient;
+  }
+
+  BOOST_REQUIRE_CLOSE(sum, saf2.Evaluate(parameters), 1e-8);
+  for (size_t i = 0; i < gradient.n_elem; ++i)
+    BOOST_REQUIRE_SMALL(sumGradient[i] - gradient[i], 1e-10);
+}
+
+/**
+ * Train a sparse autoencoder with mini-batch SGD, and make sure the objective
+ * decreases.
+ */
+BOOST_AUTO_TEST_CASE(SparseAutoencoderMiniBatchSGD)
+{
+  const size_t vSize = 10;
+  const size_t hSize = 5;
+
+  arma::mat data;
+  data.randu(vSize, 2000);
+
+  SparseAutoencoderFunction saf(data, vSize, hSize);
+  const double initialObjective = saf.Evaluate(saf.GetInitialPoint());
+
+  // Each batch has its share of the objective of the whole dataset, so the
+  // step size is scaled by the number of points.
+  MiniBatchSGD<SparseAutoencoderFunction> optimizer(saf, 100, 200.0, 2000);
+  arma::mat parameters = saf.GetInitialPoint();
+  optimizer.Optimize(parameters);
+
+  BOOST_REQUIRE_LT(saf.Evaluate(parameters), 0.5 * initialObjective);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
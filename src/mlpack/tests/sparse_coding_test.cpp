@@ -137,6 +137,96 @@ BOOST_AUTO_TEST_CASE(SparseCodingTestDictionaryStep)
   BOOST_REQUIRE_SMALL(normGradient, tol);
 }
 
+/**
+ * Make sure the codes computed in parallel (by blocks of points, with the
+ * LARSSolver) are the ones LARS finds for each point on its own.
+ */
+BOOST_AUTO_TEST_CASE(SparseCodingTestParallelEncode)
+{
+  double lambda1 = 0.1;
+  uword nAtoms = 25;
+
+  mat X;
+  X.load("mnist_first250_training_4s_and_9s.arm");
+  uword nPoints = X.n_cols;
+
+  // Normalize each point since these are images.
+  for (uword i = 0; i < nPoints; ++i)
+    X.col(i) /= norm(X.col(i), 2);
+
+  SparseCoding sc(nAtoms, lambda1);
+  mat Z;
+  DataDependentRandomInitializer::Initialize(X, 25, sc.Dictionary());
+  sc.Encode(X, Z);
+
+  BOOST_REQUIRE_EQUAL(Z.n_rows, nAtoms);
+  BOOST_REQUIRE_EQUAL(Z.n_cols, nPoints);
+
+  mat D = sc.Dictionary();
+  mat matGram = trans(D) * D;
+  for (uword i = 0; i < nPoints; ++i)
+  {
+    LARS lars(true, matGram, lambda1);
+    vec code;
+    lars.Train(D, rowvec(trans(X.col(i))), code, false);
+
+    for (uword j = 0; j < nAtoms; ++j)
+    {
+      if (code(j) == 0.0)
+        BOOST_REQUIRE_SMALL(Z(j, i), 1e-12);
+      else
+        BOOST_REQUIRE_CLOSE(Z(j, i), code(j), 1e-8);
+    }
+  }
+}
+
+/**
+ * Make sure the dictionary step gives the same dictionary whether the products
+ * of the codes are computed with a sparse matrix or not.  The sparse products
+ * are used when there are few adjacencies, so an empty list of adjacencies
+ * forces them and a list of all the entries forces the dense products.
+ */
+BOOST_AUTO_TEST_CASE(SparseCodingTestSparseDictionaryStep)
+{
+  double lambda1 = 0.1;
+  uword nAtoms = 25;
+
+  mat X;
+  X.load("mnist_first250_training_4s_and_9s.arm");
+  uword nPoints = X.n_cols;
+
+  // Normalize each point since these are images.
+  for (uword i = 0; i < nPoints; ++i)
+    X.col(i) /= norm(X.col(i), 2);
+
+  SparseCoding sc(nAtoms, lambda1, 0.0, 0, 0.01, 1e-6);
+  mat Z;
+  DataDependentRandomInitializer::Initialize(X, 25, sc.Dictionary());
+  sc.Encode(X, Z);
+
+  SparseCoding sc2(sc);
+
+  sc.OptimizeDictionary(X, Z, uvec());
+  sc2.OptimizeDictionary(X, Z, linspace<uvec>(0, Z.n_elem - 1, Z.n_elem));
+
+  // Atoms that were inactive are reinitialized randomly, so only compare atoms
+  // that were used.
+  for (uword j = 0; j < nAtoms; ++j)
+  {
+    if (accu(Z.row(j) != 0) == 0)
+      continue;
+
+    for (uword i = 0; i < X.n_rows; ++i)
+    {
+      if (std::abs(sc2.Dictionary()(i, j)) < 1e-8)
+        BOOST_REQUIRE_SMALL(sc.Dictionary()(i, j), 1e-8);
+      else
+        BOOST_REQUIRE_CLOSE(sc.Dictionary()(i, j), sc2.Dictionary()(i, j),
+            1e-5);
+    }
+  }
+}
+
 BOOST_AUTO_TEST_CASE(SerializationTest)
 {
   mat X = randu<mat>(100, 100);
@@ -308,4 +308,47 @@ BOOST_AUTO_TEST_CASE(SpillTreeMoveDatasetTest)
   BOOST_REQUIRE_EQUAL(tree.Dataset().n_cols, 1000);
 }
 
+#ifdef HAS_OPENMP
+/**
+ * Check that two spill trees have the same structure and that each leaf holds
+ * the same points.
+ */
+template<typename TreeType>
+void CheckSameSpillTree(const TreeType& a, const TreeType& b)
+{
+  BOOST_REQUIRE_EQUAL(a.NumDescendants(), b.NumDescendants());
+  BOOST_REQUIRE_EQUAL(a.NumChildren(), b.NumChildren());
+  BOOST_REQUIRE_EQUAL(a.Overlap(), b.Overlap());
+  BOOST_REQUIRE_EQUAL(a.NumPoints(), b.NumPoints());
+  for (size_t i = 0; i < a.NumPoints(); ++i)
+    BOOST_REQUIRE_EQUAL(a.Point(i), b.Point(i));
+
+  for (size_t i = 0; i < a.NumChildren(); ++i)
+    CheckSameSpillTree(a.Child(i), b.Child(i));
+}
+
+/**
+ * Make sure that a spill tree with overlapping nodes built with several threads
+ * is the same as one built with one thread.
+ */
+BOOST_AUTO_TEST_CASE(ParallelSpillTreeBuildTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(3, 20000);
+  typedef SPTree<EuclideanDistance, EmptyStatistic, arma::mat> TreeType;
+
+  const size_t prevNumThreads = omp_get_max_threads();
+  omp_set_num_threads(std::max(prevNumThreads, (size_t) 4));
+
+  TreeType parallelTree(dataset, 0.05);
+
+  omp_set_num_threads(1);
+
+  TreeType tree(dataset, 0.05);
+
+  omp_set_num_threads(prevNumThreads);
+
+  CheckSameSpillTree(tree, parallelTree);
+}
+#endif
+
 BOOST_AUTO_TEST_SUITE_END();
@@ -170,4 +170,129 @@ BOOST_AUTO_TEST_CASE(SplitLabeledDataLargerTest)
   CheckDuplication(std::get<2>(value), std::get<3>(value));
 }
 
+/**
+ * Check that the given training and test indices hold every point of a
+ * dataset of the given size exactly once.
+ */
+void CheckPartition(const uvec& trainIndices,
+                    const uvec& testIndices,
+                    const size_t numPoints)
+{
+  BOOST_REQUIRE_EQUAL(trainIndices.n_elem + testIndices.n_elem, numPoints);
+  const uvec all = sort(join_cols(trainIndices, testIndices));
+  for (size_t i = 0; i < numPoints; ++i)
+    BOOST_REQUIRE_EQUAL(all[i], i);
+}
+
+/**
+ * Make sure index splits hold each point once, keep the class ratios when
+ * stratified, and give the same split as Split() with the same seed.
+ */
+BOOST_AUTO_TEST_CASE(SplitIndicesTest)
+{
+  uvec trainIndices, testIndices;
+  SplitIndices(497, 0.3, trainIndices, testIndices);
+  BOOST_REQUIRE_EQUAL(testIndices.n_elem, size_t(0.3 * 497));
+  CheckPartition(trainIndices, testIndices, 497);
+
+  SplitIndices(10, 0.3, trainIndices, testIndices, false);
+  for (size_t i = 0; i < 7; ++i)
+    BOOST_REQUIRE_EQUAL(trainIndices[i], i);
+  for (size_t i = 0; i < 3; ++i)
+    BOOST_REQUIRE_EQUAL(testIndices[i], 7 + i);
+
+  mat input = randu<mat>(3, 100);
+  mat trainData, testData;
+  math::RandomSeed(42);
+  Split(input, trainData, testData, 0.25);
+  math::RandomSeed(42);
+  SplitIndices(100, 0.25, trainIndices, testIndices);
+  CheckMatrices(trainData, mat(input.cols(trainIndices)));
+  CheckMatrices(testData, mat(input.cols(testIndices)));
+
+  // Three classes of 100, 50 and 10 points.
+  Row<size_t> labels(160);
+  labels.subvec(0, 99).fill(0);
+  labels.subvec(100, 149).fill(1);
+  labels.subvec(150, 159).fill(2);
+  StratifiedSplitIndices(labels, 0.2, trainIndices, testIndices);
+  CheckPartition(trainIndices, testIndices, 160);
+  const Row<size_t> testLabels = labels.cols(testIndices);
+  BOOST_REQUIRE_EQUAL(accu(testLabels == 0), 20);
+  BOOST_REQUIRE_EQUAL(accu(testLabels == 1), 10);
+  BOOST_REQUIRE_EQUAL(accu(testLabels == 2), 2);
+}
+
+/**
+ * Make sure each point is in the test set of exactly one fold, and that the
+ * folds (and the classes in them) are balanced.
+ */
+BOOST_AUTO_TEST_CASE(KFoldIndicesTest)
+{
+  const size_t k = 7;
+  Row<size_t> labels(103);
+  for (size_t i = 0; i < labels.n_elem; ++i)
+    labels[i] = (i < 80) ? 0 : 1;
+
+  for (size_t s = 0; s < 3; ++s)
+  {
+    const Row<size_t> folds = (s == 0) ? KFoldAssignments(103, k) :
+        (s == 1) ? KFoldAssignments(103, k, false) :
+        StratifiedKFoldAssignments(labels, k);
+
+    Col<size_t> tested(103, fill::zeros);
+    for (size_t fold = 0; fold < k; ++fold)
+    {
+      uvec trainIndices, testIndices;
+      FoldIndices(folds, fold, trainIndices, testIndices);
+      CheckPartition(trainIndices, testIndices, 103);
+      BOOST_REQUIRE_GE(testIndices.n_elem, 103 / k);
+      BOOST_REQUIRE_LE(testIndices.n_elem, 103 / k + 1);
+      for (size_t i = 0; i < testIndices.n_elem; ++i)
+        ++tested[testIndices[i]];
+
+      // Unshuffled folds are contiguous.
+      if (s == 1)
+      {
+        BOOST_REQUIRE_EQUAL(testIndices.back() - testIndices.front() + 1,
+            testIndices.n_elem);
+      }
+
+      if (s == 2)
+      {
+        const Row<size_t> testLabels = labels.cols(testIndices);
+        const size_t ones = accu(testLabels == 1);
+        BOOST_REQUIRE_GE(ones, 23 / k);
+        BOOST_REQUIRE_LE(ones, 23 / k + 1);
+      }
+    }
+
+    for (size_t i = 0; i < tested.n_elem; ++i)
+      BOOST_REQUIRE_EQUAL(tested[i], 1);
+  }
+
+  BOOST_REQUIRE_THROW(KFoldAssignments(5, 6), std::invalid_argument);
+  BOOST_REQUIRE_THROW(KFoldAssignments(5, 1), std::invalid_argument);
+}
+
+/**
+ * Make sure time series folds train on the past and test on what follows.
+ */
+BOOST_AUTO_TEST_CASE(TimeSeriesFoldIndicesTest)
+{
+  uvec trainIndices, testIndices;
+  for (size_t fold = 0; fold < 4; ++fold)
+  {
+    TimeSeriesFoldIndices(100, 4, fold, trainIndices, testIndices);
+    BOOST_REQUIRE_EQUAL(trainIndices.n_elem, 20 * (fold + 1));
+    BOOST_REQUIRE_EQUAL(testIndices.n_elem, 20);
+    BOOST_REQUIRE_EQUAL(trainIndices[0], 0);
+    BOOST_REQUIRE_EQUAL(trainIndices.back() + 1, testIndices[0]);
+    BOOST_REQUIRE_EQUAL(testIndices.back(), 20 * (fold + 2) - 1);
+  }
+
+  BOOST_REQUIRE_THROW(TimeSeriesFoldIndices(100, 4, 4, trainIndices,
+      testIndices), std::invalid_argument);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
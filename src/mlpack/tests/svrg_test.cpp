@@ -0,0 +1,119 @@
+/**
+ * @file svrg_test.cpp
+ *
+ * Tests the SVRG optimizer.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include <mlpack/core.hpp>
+
+#include <mlpack/core/optimizers/svrg/svrg.hpp>
+#include <mlpack/core/optimizers/lbfgs/lbfgs.hpp>
+#include <mlpack/core/optimizers/sgd/test_function.hpp>
+#include <mlpack/methods/logistic_regression/logistic_regression.hpp>
+
+#include <boost/test/unit_test.hpp>
+#include "test_tools.hpp"
+
+using namespace arma;
+using namespace mlpack::optimization;
+using namespace mlpack::optimization::test;
+
+using namespace mlpack::distribution;
+using namespace mlpack::regression;
+
+using namespace mlpack;
+
+BOOST_AUTO_TEST_SUITE(SVRGTest);
+
+/**
+ * Tests the SVRG optimizer using a simple test function.
+ */
+BOOST_AUTO_TEST_CASE(SimpleSVRGTestFunction)
+{
+  SGDTestFunction f;
+  SVRG<SGDTestFunction> optimizer(f, 1e-3, 500000, 0, 1e-12, true);
+
+  arma::mat coordinates = f.GetInitialPoint();
+  optimizer.Optimize(coordinates);
+
+  BOOST_REQUIRE_SMALL(coordinates[0], 0.1);
+  BOOST_REQUIRE_SMALL(coordinates[1], 0.1);
+  BOOST_REQUIRE_SMALL(coordinates[2], 0.1);
+}
+
+/**
+ * Run SVRG on logistic regression and make sure it reaches the optimum found
+ * by L-BFGS.
+ */
+BOOST_AUTO_TEST_CASE(SVRGLogisticRegressionTest)
+{
+  // Generate a two-Gaussian dataset.
+  GaussianDistribution g1(arma::vec("1.0 1.0 1.0"), arma::eye<arma::mat>(3, 3));
+  GaussianDistribution g2(arma::vec("3.0 3.0 3.0"), arma::eye<arma::mat>(3, 3));
+
+  arma::mat data(3, 1000);
+  arma::Row<size_t> responses(1000);
+  for (size_t i = 0; i < 500; ++i)
+  {
+    data.col(i) = g1.Random();
+    responses[i] = 0;
+  }
+  for (size_t i = 500; i < 1000; ++i)
+  {
+    data.col(i) = g2.Random();
+    responses[i] = 1;
+  }
+
+  LogisticRegressionFunction<> lrf(data, responses, 10.0);
+
+  arma::mat optimum = lrf.GetInitialPoint();
+  L_BFGS<LogisticRegressionFunction<>> lbfgs(lrf);
+  const double minimum = lbfgs.Optimize(optimum);
+
+  // With a constant step size the iterate converges to the optimum, so the
+  // objective gets close to the minimum within a few passes.
+  arma::mat coordinates = lrf.GetInitialPoint();
+  SVRG<LogisticRegressionFunction<>> svrg(lrf, 0.01, 30, 0, 0);
+  const double objective = svrg.Optimize(coordinates);
+
+  BOOST_REQUIRE_CLOSE(objective, minimum, 0.1);
+  BOOST_REQUIRE_SMALL(arma::norm(coordinates - optimum, 2) /
+      arma::norm(optimum, 2), 0.05);
+}
+
+/**
+ * Make sure SVRG with the number of inner iterations set trains a logistic
+ * regression model through LogisticRegression::Train().
+ */
+BOOST_AUTO_TEST_CASE(SVRGLogisticRegressionTrainTest)
+{
+  GaussianDistribution g1(arma::vec("1.0 1.0 1.0"), arma::eye<arma::mat>(3, 3));
+  GaussianDistribution g2(arma::vec("9.0 9.0 9.0"), arma::eye<arma::mat>(3, 3));
+
+  arma::mat data(3, 1000);
+  arma::Row<size_t> responses(1000);
+  for (size_t i = 0; i < 500; ++i)
+  {
+    data.col(i) = g1.Random();
+    responses[i] = 0;
+  }
+  for (size_t i = 500; i < 1000; ++i)
+  {
+    data.col(i) = g2.Random();
+    responses[i] = 1;
+  }
+
+  LogisticRegression<> lr(data.n_rows, 0.5);
+  LogisticRegressionFunction<> lrf(data, responses, 0.5);
+  SVRG<LogisticRegressionFunction<>> svrg(lrf, 0.01, 20, 2000);
+  lr.Train(svrg);
+
+  const double acc = lr.ComputeAccuracy(data, responses);
+  BOOST_REQUIRE_CLOSE(acc, 100.0, 0.3); // 0.3% error tolerance.
+}
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -19,6 +19,8 @@
 #endif
 
 #include <mlpack/core.hpp>
+#include <mlpack/core/util/arena_allocator.hpp>
+#include <cstring>
 
 #include <boost/test/unit_test.hpp>
 #include "test_tools.hpp"
@@ -90,4 +92,269 @@ BOOST_AUTO_TEST_CASE(TwiceStartTimerTest)
   BOOST_REQUIRE_THROW(Timer::Start("test_timer"), std::runtime_error);
 }
 
+/**
+ * Nested profiled regions should be timed, counted and reported under the
+ * region they ran in.
+ */
+BOOST_AUTO_TEST_CASE(ProfilerNestingTest)
+{
+  Profiler::Reset();
+  Profiler::Enable();
+
+  for (size_t i = 0; i < 3; ++i)
+  {
+    MLPACK_PROFILE_SCOPE("profiler_test_outer");
+    {
+      MLPACK_PROFILE_SCOPE("profiler_test_inner");
+      #ifdef _WIN32
+      Sleep(10);
+      #else
+      usleep(10000);
+      #endif
+    }
+  }
+
+  Profiler::Disable();
+
+  BOOST_REQUIRE_EQUAL(Profiler::Count("profiler_test_outer"), 3);
+  BOOST_REQUIRE_EQUAL(Profiler::Count("profiler_test_inner"), 3);
+  BOOST_REQUIRE_GE(Profiler::Total("profiler_test_inner").count(), 30000);
+  BOOST_REQUIRE_GE(Profiler::Total("profiler_test_outer").count(),
+      Profiler::Total("profiler_test_inner").count());
+
+  std::ostringstream report;
+  Profiler::Report(report);
+  const std::string str = report.str();
+  const size_t outer = str.find("  profiler_test_outer: ");
+  const size_t inner = str.find("    profiler_test_inner: ");
+  BOOST_REQUIRE(outer != std::string::npos);
+  BOOST_REQUIRE(inner != std::string::npos);
+  BOOST_REQUIRE_GT(inner, outer);
+}
+
+/**
+ * Nothing should be measured while the profiler is disabled.
+ */
+BOOST_AUTO_TEST_CASE(ProfilerDisabledTest)
+{
+  Profiler::Reset();
+  Profiler::Disable();
+
+  {
+    MLPACK_PROFILE_SCOPE("profiler_test_disabled");
+  }
+
+  BOOST_REQUIRE_EQUAL(Profiler::Count("profiler_test_disabled"), 0);
+}
+
+/**
+ * Stopping a region that isn't the last one started should throw.
+ */
+BOOST_AUTO_TEST_CASE(ProfilerMismatchTest)
+{
+  Profiler::Reset();
+  const size_t a = Profiler::Register("profiler_test_a");
+  const size_t b = Profiler::Register("profiler_test_b");
+  BOOST_REQUIRE_EQUAL(Profiler::Register("profiler_test_a"), a);
+  BOOST_REQUIRE_EQUAL(Profiler::Name(b), "profiler_test_b");
+
+  Profiler::Start(a);
+  BOOST_REQUIRE_THROW(Profiler::Stop(b), std::runtime_error);
+  Profiler::Stop(a);
+  BOOST_REQUIRE_THROW(Profiler::Stop(a), std::runtime_error);
+}
+
+/**
+ * Regions run by many threads should all be counted, and each run should be
+ * in the trace when tracing.
+ */
+BOOST_AUTO_TEST_CASE(ProfilerThreadsTest)
+{
+  Profiler::Reset();
+  Profiler::Enable(true);
+
+  #pragma omp parallel for
+  for (int i = 0; i < 100; ++i)
+  {
+    MLPACK_PROFILE_SCOPE("profiler_test_parallel");
+  }
+
+  Profiler::Disable();
+  BOOST_REQUIRE_EQUAL(Profiler::Count("profiler_test_parallel"), 100);
+
+  std::ostringstream trace;
+  Profiler::WriteTrace(trace);
+  const std::string str = trace.str();
+  BOOST_REQUIRE_EQUAL(str.find("{\"traceEvents\":["), 0);
+
+  size_t events = 0;
+  size_t position = str.find("\"name\":\"profiler_test_parallel\"");
+  while (position != std::string::npos)
+  {
+    ++events;
+    position = str.find("\"name\":\"profiler_test_parallel\"", position + 1);
+  }
+  BOOST_REQUIRE_EQUAL(events, 100);
+
+  Profiler::Reset();
+}
+
+/**
+ * Hardware counters should count the events of a region if they are available,
+ * and nothing otherwise.
+ */
+BOOST_AUTO_TEST_CASE(PerfCountersTest)
+{
+  PerfCounters counters;
+  BOOST_REQUIRE(!counters.Enabled());
+
+  // Nothing is counted before the counters are enabled.
+  counters.Start("perf_test");
+  counters.Stop("perf_test");
+  BOOST_REQUIRE(counters.Counts().empty());
+
+  // The counters may not be available (for instance in a container, or if
+  // perf_event_paranoid forbids them).
+  if (!counters.Enable())
+    return;
+
+  double sum = 0.0;
+  for (size_t run = 0; run < 2; ++run)
+  {
+    counters.Start("perf_test");
+    for (size_t i = 0; i < 100000; ++i)
+      sum += std::sqrt((double) i);
+    counters.Stop("perf_test");
+  }
+  BOOST_REQUIRE_GT(sum, 0.0);
+
+  BOOST_REQUIRE_EQUAL(counters.Counts().size(), 1);
+  const std::vector<unsigned long long>& counts =
+      counters.Counts().at("perf_test");
+  BOOST_REQUIRE_EQUAL(counts.size(), PerfCounters::NumEvents);
+  if (counters.Available(1))
+    BOOST_REQUIRE_GE(counts[1], 200000);
+
+  std::ostringstream printed;
+  counters.Print(printed);
+  BOOST_REQUIRE_NE(printed.str().find("perf_test:"), std::string::npos);
+}
+
+/**
+ * The allocation counters should count the Armadillo temporaries of a region,
+ * and the peak of nested regions, when the allocations are tracked.
+ */
+BOOST_AUTO_TEST_CASE(AllocationCountersTest)
+{
+  AllocationCounters counters;
+  if (!AllocationCounters::Enabled())
+  {
+    counters.Start("allocation_test");
+    counters.Stop("allocation_test");
+    BOOST_REQUIRE(counters.RegionCounts().empty());
+    return;
+  }
+
+  // Large enough that Armadillo doesn't use the memory inside the object.
+  arma::mat a(100, 100, arma::fill::ones);
+  arma::mat b(100, 100, arma::fill::ones);
+  double sum = 0.0;
+
+  counters.Start("allocation_test");
+  for (size_t i = 0; i < 10; ++i)
+  {
+    counters.Start("allocation_test_inner");
+    // Each iteration makes one temporary for the product.
+    const arma::mat c = a * b;
+    sum += c(0, 0);
+    counters.Stop("allocation_test_inner");
+  }
+  counters.Stop("allocation_test");
+  BOOST_REQUIRE_CLOSE(sum, 1000.0, 1e-5);
+
+  const size_t bytes = 100 * 100 * sizeof(double);
+  const AllocationCounters::Counts& outer =
+      counters.RegionCounts().at("allocation_test");
+  const AllocationCounters::Counts& inner =
+      counters.RegionCounts().at("allocation_test_inner");
+  BOOST_REQUIRE_GE(inner.allocations, 10);
+  BOOST_REQUIRE_GE(inner.bytes, 10 * bytes);
+  BOOST_REQUIRE_GE(inner.peak, bytes);
+  BOOST_REQUIRE_EQUAL(outer.allocations, inner.allocations);
+  BOOST_REQUIRE_EQUAL(outer.bytes, inner.bytes);
+  BOOST_REQUIRE_GE(outer.peak, inner.peak);
+
+  std::ostringstream printed;
+  counters.Print(printed);
+  BOOST_REQUIRE_NE(printed.str().find("allocation_test:"), std::string::npos);
+}
+
+/**
+ * Make sure that the arena gives aligned blocks, reuses released blocks of
+ * about the same size, and gives the pool back to the system when it is
+ * trimmed; and that Armadillo's large allocations come from the arena when it
+ * is used.
+ */
+BOOST_AUTO_TEST_CASE(ArenaAllocatorTest)
+{
+  ArenaAllocator::Trim();
+  const size_t prevThreshold = ArenaAllocator::Threshold();
+  const bool prevHugePages = ArenaAllocator::HugePages();
+  const size_t prevPoolLimit = ArenaAllocator::PoolLimit();
+
+  for (size_t huge = 0; huge < 2; ++huge)
+  {
+    ArenaAllocator::Configure(prevThreshold, (huge == 1), 64 * 1024 * 1024);
+    const size_t alignment = (huge == 1) ? 2 * 1024 * 1024 :
+        ArenaAllocator::Alignment;
+
+    size_t capacity;
+    void* block = ArenaAllocator::Allocate(1000000, capacity);
+    BOOST_REQUIRE(block != NULL);
+    BOOST_REQUIRE_GE(capacity, 1000000);
+    BOOST_REQUIRE_EQUAL((size_t) block % alignment, 0);
+    // The block must be writable.
+    std::memset(block, 1, capacity);
+
+    const ArenaAllocator::Usage before = ArenaAllocator::CurrentUsage();
+    ArenaAllocator::Free(block, capacity);
+    BOOST_REQUIRE_EQUAL(ArenaAllocator::CurrentUsage().pooledBytes,
+        before.pooledBytes + capacity);
+
+    // A slightly smaller block is taken from the pool.
+    size_t reusedCapacity;
+    void* reused = ArenaAllocator::Allocate(990000, reusedCapacity);
+    const ArenaAllocator::Usage after = ArenaAllocator::CurrentUsage();
+    BOOST_REQUIRE(reused == block);
+    BOOST_REQUIRE_EQUAL(reusedCapacity, capacity);
+    BOOST_REQUIRE_EQUAL(after.mappedBlocks, before.mappedBlocks);
+    BOOST_REQUIRE_EQUAL(after.reusedBlocks, before.reusedBlocks + 1);
+
+    ArenaAllocator::Free(reused, reusedCapacity);
+    ArenaAllocator::Trim();
+    BOOST_REQUIRE_EQUAL(ArenaAllocator::CurrentUsage().pooledBytes, 0);
+    BOOST_REQUIRE_EQUAL(ArenaAllocator::CurrentUsage().heldBytes,
+        before.heldBytes - capacity);
+  }
+
+  if (ArenaAllocator::Available())
+  {
+    ArenaAllocator::Configure(64 * 1024, false, 64 * 1024 * 1024);
+
+    AllocationCounters counters;
+    counters.Start("arena_test");
+    arma::mat large(100, 100, arma::fill::ones); // 80000 bytes.
+    arma::mat small(10, 10, arma::fill::ones);
+    counters.Stop("arena_test");
+
+    BOOST_REQUIRE_EQUAL((size_t) large.memptr() % ArenaAllocator::Alignment,
+        0);
+    BOOST_REQUIRE_EQUAL(arma::accu(large), 10000.0);
+    BOOST_REQUIRE_EQUAL(
+        counters.RegionCounts().at("arena_test").arenaAllocations, 1);
+  }
+
+  ArenaAllocator::Configure(prevThreshold, prevHugePages, prevPoolLimit);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
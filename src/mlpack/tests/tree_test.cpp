@@ -16,6 +16,7 @@
 #include <mlpack/core/tree/rectangle_tree.hpp>
 
 #include <queue>
+#include <set>
 #include <stack>
 
 #include <boost/test/unit_test.hpp>
@@ -1013,6 +1014,68 @@ BOOST_AUTO_TEST_CASE(HRectBoundRootRangeDistancePoint)
   }
 }
 
+/**
+ * Compare the point distances of HRectBound with other LMetrics against the
+ * metric evaluated at the closest and furthest corners of the bound.
+ */
+template<typename MetricType>
+void CheckHRectBoundPointDistances()
+{
+  for (int i = 0; i < 20; i++)
+  {
+    const size_t dim = math::RandInt(1, 20);
+
+    HRectBound<MetricType> a(dim);
+    arma::vec lo(dim, arma::fill::randu);
+    arma::vec width(dim, arma::fill::randu);
+    for (size_t j = 0; j < dim; j++)
+      a[j] = Range(lo[j], lo[j] + width[j]);
+
+    for (int j = 0; j < 10; j++)
+    {
+      // Points both inside and outside of the bound.
+      arma::vec point = 3.0 * arma::randu<arma::vec>(dim) - 1.0;
+
+      arma::vec closest(dim), furthest(dim);
+      for (size_t d = 0; d < dim; d++)
+      {
+        closest[d] = std::min(std::max(point[d], a[d].Lo()), a[d].Hi());
+        furthest[d] = (point[d] - a[d].Lo() > a[d].Hi() - point[d]) ?
+            a[d].Lo() : a[d].Hi();
+      }
+
+      const double minDistance = MetricType::Evaluate(point, closest);
+      const double maxDistance = MetricType::Evaluate(point, furthest);
+
+      if (minDistance < 1e-10)
+        BOOST_REQUIRE_SMALL(a.MinDistance(point), 1e-10);
+      else
+        BOOST_REQUIRE_CLOSE(a.MinDistance(point), minDistance, 1e-5);
+      BOOST_REQUIRE_CLOSE(a.MaxDistance(point), maxDistance, 1e-5);
+
+      Range r = a.RangeDistance(point);
+      if (minDistance < 1e-10)
+        BOOST_REQUIRE_SMALL(r.Lo(), 1e-10);
+      else
+        BOOST_REQUIRE_CLOSE(r.Lo(), minDistance, 1e-5);
+      BOOST_REQUIRE_CLOSE(r.Hi(), maxDistance, 1e-5);
+    }
+  }
+}
+
+/**
+ * Ensure that the point distances of HRectBound are right for the Manhattan
+ * distance and for LMetrics with and without the root.
+ */
+BOOST_AUTO_TEST_CASE(HRectBoundLMetricDistancePoint)
+{
+  CheckHRectBoundPointDistances<ManhattanDistance>();
+  CheckHRectBoundPointDistances<EuclideanDistance>();
+  CheckHRectBoundPointDistances<SquaredEuclideanDistance>();
+  CheckHRectBoundPointDistances<LMetric<3, true>>();
+  CheckHRectBoundPointDistances<LMetric<3, false>>();
+}
+
 /**
  * Ensure that HRectBound::Diameter() works properly.
  */
@@ -2252,4 +2315,584 @@ BOOST_AUTO_TEST_CASE(CoverTreeDescendantTest)
   CheckDescendants(&tree);
 }
 
+// Recursively check that the ranges and counts of each node are consistent
+// with its children, and that no leaf is too large.
+template<typename TreeType>
+void CheckNodeRanges(const TreeType& node, const size_t maxLeafSize)
+{
+  if (node.IsLeaf())
+  {
+    BOOST_REQUIRE_LE(node.Count(), maxLeafSize);
+    BOOST_REQUIRE_LE(node.Count(), node.Capacity());
+    return;
+  }
+
+  BOOST_REQUIRE_EQUAL(node.Left()->Parent(), &node);
+  BOOST_REQUIRE_EQUAL(node.Right()->Parent(), &node);
+  BOOST_REQUIRE_EQUAL(node.Left()->Begin(), node.Begin());
+  BOOST_REQUIRE_EQUAL(node.Right()->Begin(),
+      node.Begin() + node.Left()->Capacity());
+  BOOST_REQUIRE_EQUAL(node.Left()->Capacity() + node.Right()->Capacity(),
+      node.Capacity());
+  BOOST_REQUIRE_EQUAL(node.Left()->Count() + node.Right()->Count(),
+      node.Count());
+  BOOST_REQUIRE_GT(node.Left()->Count(), 0);
+  BOOST_REQUIRE_GT(node.Right()->Count(), 0);
+
+  CheckNodeRanges(*node.Left(), maxLeafSize);
+  CheckNodeRanges(*node.Right(), maxLeafSize);
+}
+
+/**
+ * Insert points into and remove points from a binary space tree, and make sure
+ * that the tree stays valid and the mappings stay correct.
+ */
+template<typename TreeType>
+void BinarySpaceTreeInsertDeleteTest()
+{
+  arma::mat dataset = arma::randu<arma::mat>(4, 1000);
+  std::vector<size_t> oldFromNew;
+  TreeType root(dataset, oldFromNew, 10);
+
+  // Insert a lot of points, some of them outside of the original bounds; this
+  // is enough to rebuild subtrees, and the whole tree too.  Each new point
+  // gets the next old index.
+  arma::mat newPoints = 1.5 * arma::randu<arma::mat>(4, 1500) - 0.25;
+  for (size_t i = 0; i < newPoints.n_cols; ++i)
+  {
+    const size_t oldIndex = dataset.n_cols + i;
+    const size_t index = root.InsertPoint(newPoints.col(i), oldIndex,
+        oldFromNew, 10);
+    BOOST_REQUIRE_SMALL(arma::norm(root.Dataset().col(index) -
+        newPoints.col(i)), 1e-10);
+    BOOST_REQUIRE_EQUAL(oldFromNew[index], oldIndex);
+  }
+  dataset = arma::join_rows(dataset, newPoints);
+
+  // Now remove a lot of points, from the original dataset too.
+  std::vector<bool> removed(dataset.n_cols, false);
+  for (size_t i = 0; i < 1500; ++i)
+  {
+    const size_t index = root.Descendant(math::RandInt(root.NumDescendants()));
+    removed[oldFromNew[index]] = true;
+    BOOST_REQUIRE(root.DeletePoint(index, oldFromNew, 10));
+  }
+
+  // Removing a point that isn't in the tree should fail.
+  BOOST_REQUIRE(!root.DeletePoint(root.Dataset().n_cols, oldFromNew, 10));
+  for (size_t i = 0; i < oldFromNew.size(); ++i)
+  {
+    if (oldFromNew[i] == size_t(-1))
+    {
+      BOOST_REQUIRE(!root.DeletePoint(i, oldFromNew, 10));
+      break;
+    }
+  }
+
+  BOOST_REQUIRE_EQUAL(root.NumDescendants(), 1000);
+  BOOST_REQUIRE_EQUAL(root.Capacity(), root.Dataset().n_cols);
+  BOOST_REQUIRE_EQUAL(oldFromNew.size(), root.Dataset().n_cols);
+
+  // Every point that wasn't removed must be in the tree exactly once.
+  std::vector<size_t> seen(dataset.n_cols, 0);
+  for (size_t i = 0; i < root.NumDescendants(); ++i)
+  {
+    const size_t index = root.Descendant(i);
+    BOOST_REQUIRE(!removed[oldFromNew[index]]);
+    ++seen[oldFromNew[index]];
+    for (size_t j = 0; j < dataset.n_rows; ++j)
+      BOOST_REQUIRE_EQUAL(root.Dataset()(j, index),
+          dataset(j, oldFromNew[index]));
+  }
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+    BOOST_REQUIRE_EQUAL(seen[i], removed[i] ? 0 : 1);
+
+  CheckNodeRanges(root, 10);
+  BOOST_REQUIRE(CheckPointBounds(root));
+
+  // Without the free columns, the points are the columns of the dataset again.
+  root.ShrinkToFit(oldFromNew);
+  BOOST_REQUIRE_EQUAL(root.Dataset().n_cols, 1000);
+  BOOST_REQUIRE_EQUAL(oldFromNew.size(), 1000);
+  for (size_t i = 0; i < oldFromNew.size(); ++i)
+  {
+    BOOST_REQUIRE_EQUAL(root.Descendant(i), i);
+    for (size_t j = 0; j < dataset.n_rows; ++j)
+      BOOST_REQUIRE_EQUAL(root.Dataset()(j, i), dataset(j, oldFromNew[i]));
+  }
+
+  CheckNodeRanges(root, 10);
+  BOOST_REQUIRE(CheckPointBounds(root));
+}
+
+/**
+ * Make sure insertion and deletion work for the kd-tree.
+ */
+BOOST_AUTO_TEST_CASE(KDTreeInsertDeleteTest)
+{
+  BinarySpaceTreeInsertDeleteTest<KDTree<EuclideanDistance, EmptyStatistic,
+      arma::mat>>();
+}
+
+/**
+ * Make sure insertion and deletion work for the ball tree.
+ */
+BOOST_AUTO_TEST_CASE(BallTreeInsertDeleteTest)
+{
+  BinarySpaceTreeInsertDeleteTest<BallTree<EuclideanDistance, EmptyStatistic,
+      arma::mat>>();
+}
+
+/**
+ * Make sure that inserting points without a mapping returns the right index,
+ * and that deleting every point leaves an empty tree.
+ */
+BOOST_AUTO_TEST_CASE(KDTreeInsertDeleteAllTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(3, 50);
+  KDTree<EuclideanDistance, EmptyStatistic, arma::mat> root(dataset, 5);
+
+  for (size_t i = 0; i < 100; ++i)
+  {
+    arma::vec point = arma::randu<arma::vec>(3);
+    const size_t index = root.InsertPoint(point, 5);
+    BOOST_REQUIRE_SMALL(arma::norm(root.Dataset().col(index) - point), 1e-10);
+  }
+
+  CheckNodeRanges(root, 5);
+  BOOST_REQUIRE(CheckPointBounds(root));
+
+  while (root.NumDescendants() > 0)
+  {
+    BOOST_REQUIRE(root.DeletePoint(root.Descendant(root.NumDescendants() / 2),
+        5));
+  }
+
+  BOOST_REQUIRE(root.IsLeaf());
+  root.ShrinkToFit();
+  BOOST_REQUIRE_EQUAL(root.Dataset().n_cols, 0);
+}
+
+// Append the nodes of the given subtree to the vector.
+template<typename TreeType>
+void GetSubtreeNodes(TreeType& node, std::vector<TreeType*>& nodes)
+{
+  nodes.push_back(&node);
+  for (size_t i = 0; i < node.NumChildren(); ++i)
+    GetSubtreeNodes(node.Child(i), nodes);
+}
+
+/**
+ * Make sure that inserting a point into a leaf with free columns, or removing a
+ * point from a leaf that doesn't become empty, only changes the nodes on the
+ * path to that leaf and the columns of the leaf.
+ */
+BOOST_AUTO_TEST_CASE(KDTreeLocalUpdateTest)
+{
+  typedef KDTree<EuclideanDistance, EmptyStatistic, arma::mat> TreeType;
+
+  arma::mat dataset = arma::randu<arma::mat>(3, 1000);
+  TreeType root(dataset, 10);
+
+  // The first insertion finds no free column, so the dataset grows, and the
+  // free columns are spread out over all of the leaves.
+  root.InsertPoint(arma::vec(arma::randu<arma::vec>(3)), 10);
+  BOOST_REQUIRE_GT(root.Capacity(), root.NumDescendants());
+  CheckNodeRanges(root, 10);
+
+  // Every internal node holds at least eleven points, so four updates are too
+  // few to rebuild any of them.
+  size_t localUpdates = 0;
+  for (size_t i = 0; i < 3; ++i)
+  {
+    std::vector<TreeType*> nodes;
+    GetSubtreeNodes(root, nodes);
+    std::vector<size_t> begins, counts, capacities;
+    for (size_t j = 0; j < nodes.size(); ++j)
+    {
+      begins.push_back(nodes[j]->Begin());
+      counts.push_back(nodes[j]->Count());
+      capacities.push_back(nodes[j]->Capacity());
+    }
+    const arma::mat oldDataset = root.Dataset();
+
+    // Insert and remove points in turn.
+    size_t index;
+    if (i % 2 == 0)
+      index = root.InsertPoint(arma::vec(arma::randu<arma::vec>(3)), 10);
+    else
+      index = root.Descendant(math::RandInt(root.NumDescendants()));
+
+    // Find the leaf the point is in, as it was before the update.
+    std::set<TreeType*> path;
+    size_t leaf = 0;
+    TreeType* node = &root;
+    while (true)
+    {
+      const size_t j = std::find(nodes.begin(), nodes.end(), node) -
+          nodes.begin();
+      if (j == nodes.size())
+        break;
+
+      path.insert(node);
+      leaf = j;
+      if (node->IsLeaf())
+        break;
+      node = (index < node->Right()->Begin()) ? node->Left() : node->Right();
+    }
+    if (i % 2 == 1)
+      BOOST_REQUIRE(root.DeletePoint(index, 10));
+
+    // A full leaf needs room from elsewhere, and an empty leaf is removed.
+    if ((i % 2 == 0) ? (counts[leaf] == capacities[leaf]) : (counts[leaf] == 1))
+      continue;
+    ++localUpdates;
+
+    std::vector<TreeType*> newNodes;
+    GetSubtreeNodes(root, newNodes);
+    const std::set<TreeType*> newNodeSet(newNodes.begin(), newNodes.end());
+    for (size_t j = 0; j < nodes.size(); ++j)
+    {
+      if (path.count(nodes[j]))
+        continue;
+
+      BOOST_REQUIRE(newNodeSet.count(nodes[j]));
+      BOOST_REQUIRE_EQUAL(nodes[j]->Begin(), begins[j]);
+      BOOST_REQUIRE_EQUAL(nodes[j]->Count(), counts[j]);
+      BOOST_REQUIRE_EQUAL(nodes[j]->Capacity(), capacities[j]);
+    }
+
+    BOOST_REQUIRE_EQUAL(root.Dataset().n_cols, oldDataset.n_cols);
+    for (size_t c = 0; c < oldDataset.n_cols; ++c)
+    {
+      if (c >= begins[leaf] && c < begins[leaf] + capacities[leaf])
+        continue;
+      BOOST_REQUIRE_EQUAL(arma::accu(root.Dataset().col(c) !=
+          oldDataset.col(c)), 0);
+    }
+  }
+
+  BOOST_REQUIRE_GT(localUpdates, 0);
+  CheckNodeRanges(root, 10);
+  BOOST_REQUIRE(CheckPointBounds(root));
+}
+
+/**
+ * Make sure that RefitBounds() gives valid bounds after the points of the tree
+ * have moved, and that the bound of the root is tight.
+ */
+BOOST_AUTO_TEST_CASE(KDTreeRefitBoundsTest)
+{
+  arma::mat dataset = arma::randu<arma::mat>(3, 500);
+  KDTree<EuclideanDistance, EmptyStatistic, arma::mat> root(dataset, 10);
+
+  // Move every point, some of them far away.
+  root.Dataset() += 0.1 * arma::randn<arma::mat>(3, 500);
+  root.Dataset().col(0) += 10.0;
+  root.RefitBounds();
+
+  CheckNodeRanges(root, 10);
+  BOOST_REQUIRE(CheckPointBounds(root));
+
+  const arma::vec minValues = arma::min(root.Dataset(), 1);
+  const arma::vec maxValues = arma::max(root.Dataset(), 1);
+  for (size_t d = 0; d < 3; ++d)
+  {
+    BOOST_REQUIRE_CLOSE(root.Bound()[d].Lo(), minValues[d], 1e-5);
+    BOOST_REQUIRE_CLOSE(root.Bound()[d].Hi(), maxValues[d], 1e-5);
+  }
+  BOOST_REQUIRE_CLOSE(root.FurthestDescendantDistance(),
+      0.5 * root.Bound().Diameter(), 1e-5);
+}
+
+/**
+ * Make sure the given trees have the same structure, bounds and distances.
+ */
+template<typename TreeType>
+void CheckFlatTrees(const TreeType& a, const TreeType& b)
+{
+  BOOST_REQUIRE_EQUAL(a.Begin(), b.Begin());
+  BOOST_REQUIRE_EQUAL(a.Count(), b.Count());
+  BOOST_REQUIRE_EQUAL(a.NumChildren(), b.NumChildren());
+  BOOST_REQUIRE_CLOSE(a.ParentDistance(), b.ParentDistance(), 1e-10);
+  BOOST_REQUIRE_CLOSE(a.FurthestDescendantDistance(),
+      b.FurthestDescendantDistance(), 1e-10);
+  BOOST_REQUIRE_CLOSE(a.MinimumBoundDistance(), b.MinimumBoundDistance(),
+      1e-10);
+
+  arma::vec aCenter, bCenter;
+  a.Center(aCenter);
+  b.Center(bCenter);
+  CheckMatrices(aCenter, bCenter);
+
+  for (size_t i = 0; i < a.NumChildren(); ++i)
+    CheckFlatTrees(a.Child(i), b.Child(i));
+}
+
+/**
+ * Save a tree as a flat image, load it, and make sure the trees are the same.
+ */
+template<typename TreeType>
+void BinarySpaceTreeFlatImageTest()
+{
+  arma::mat dataset = arma::randu<arma::mat>(5, 1000);
+  TreeType tree(dataset, 10);
+
+  std::ostringstream stream(std::ios::binary);
+  tree.SaveFlat(stream);
+  const std::string image = stream.str();
+
+  // Make sure the image is suitably aligned.
+  std::vector<uint64_t> buffer(image.size() / sizeof(uint64_t) + 1);
+  std::memcpy(buffer.data(), image.data(), image.size());
+  TreeType flatTree(reinterpret_cast<char*>(buffer.data()), image.size());
+
+  CheckMatrices(flatTree.Dataset(), tree.Dataset());
+  CheckFlatTrees(flatTree, tree);
+
+  // The dataset must not have been copied.
+  BOOST_REQUIRE(reinterpret_cast<const char*>(flatTree.Dataset().memptr()) >=
+      reinterpret_cast<const char*>(buffer.data()));
+  BOOST_REQUIRE(reinterpret_cast<const char*>(flatTree.Dataset().memptr()) <
+      reinterpret_cast<const char*>(buffer.data()) + image.size());
+
+  // A corrupted image should not be accepted.
+  buffer[0] = 0;
+  BOOST_REQUIRE_THROW(TreeType(reinterpret_cast<char*>(buffer.data()),
+      image.size()), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(KDTreeFlatImageTest)
+{
+  BinarySpaceTreeFlatImageTest<KDTree<EuclideanDistance, EmptyStatistic,
+      arma::mat>>();
+}
+
+BOOST_AUTO_TEST_CASE(BallTreeFlatImageTest)
+{
+  BinarySpaceTreeFlatImageTest<BallTree<EuclideanDistance, EmptyStatistic,
+      arma::mat>>();
+}
+
+BOOST_AUTO_TEST_CASE(VPTreeFlatImageTest)
+{
+  BinarySpaceTreeFlatImageTest<VPTree<EuclideanDistance, EmptyStatistic,
+      arma::mat>>();
+}
+
+/**
+ * Make sure that compacting a tree keeps its structure, puts all the nodes in
+ * one block of memory, and still allows the tree to be modified.
+ */
+template<typename TreeType>
+void BinarySpaceTreeCompactTest(const typename TreeType::NodeOrder order)
+{
+  arma::mat dataset = arma::randu<arma::mat>(5, 1000);
+  TreeType tree(dataset, 10);
+  TreeType original(tree);
+
+  BOOST_REQUIRE(!tree.IsCompact());
+  tree.Compact(order);
+  BOOST_REQUIRE(tree.IsCompact());
+  CheckFlatTrees(tree, original);
+
+  // Every node but the root should be in one block.
+  std::vector<const TreeType*> nodes;
+  std::queue<const TreeType*> queue;
+  queue.push(&tree);
+  while (!queue.empty())
+  {
+    const TreeType* node = queue.front();
+    queue.pop();
+    if (node != &tree)
+      nodes.push_back(node);
+    for (size_t i = 0; i < node->NumChildren(); ++i)
+      queue.push(&node->Child(i));
+  }
+
+  const TreeType* first = *std::min_element(nodes.begin(), nodes.end(),
+      std::less<const TreeType*>());
+  const TreeType* last = *std::max_element(nodes.begin(), nodes.end(),
+      std::less<const TreeType*>());
+  BOOST_REQUIRE_EQUAL((size_t) (last - first), nodes.size() - 1);
+
+  // The first node after the root must be its left child in both orders.
+  BOOST_REQUIRE_EQUAL(first, &tree.Child(0));
+
+  // The compacted tree can still be modified, and compacted again.
+  for (size_t i = 0; i < 200; ++i)
+    tree.InsertPoint(arma::vec(arma::randu<arma::vec>(5)), 10);
+  for (size_t i = 0; i < 500; ++i)
+    tree.DeletePoint(tree.Descendant(math::RandInt(tree.NumDescendants())), 10);
+  CheckNodeRanges(tree, 10);
+  BOOST_REQUIRE(CheckPointBounds(tree));
+
+  tree.Compact(order);
+  CheckNodeRanges(tree, 10);
+  BOOST_REQUIRE(CheckPointBounds(tree));
+
+  // Copies of the compacted tree are ordinary trees.
+  TreeType copy(tree);
+  BOOST_REQUIRE(!copy.IsCompact());
+  CheckFlatTrees(copy, tree);
+}
+
+BOOST_AUTO_TEST_CASE(KDTreeCompactTest)
+{
+  typedef KDTree<EuclideanDistance, EmptyStatistic, arma::mat> TreeType;
+  BinarySpaceTreeCompactTest<TreeType>(TreeType::DEPTH_FIRST_ORDER);
+  BinarySpaceTreeCompactTest<TreeType>(TreeType::VAN_EMDE_BOAS_ORDER);
+}
+
+BOOST_AUTO_TEST_CASE(BallTreeCompactTest)
+{
+  typedef BallTree<EuclideanDistance, EmptyStatistic, arma::mat> TreeType;
+  BinarySpaceTreeCompactTest<TreeType>(TreeType::DEPTH_FIRST_ORDER);
+  BinarySpaceTreeCompactTest<TreeType>(TreeType::VAN_EMDE_BOAS_ORDER);
+}
+
+/**
+ * Make sure that trees built on float data hold their bounds in float, so that
+ * they take as little memory as possible, and that the bounds are still valid.
+ */
+BOOST_AUTO_TEST_CASE(FloatBinarySpaceTreeBoundTest)
+{
+  arma::fmat dataset = arma::randu<arma::fmat>(4, 1000);
+
+  typedef KDTree<EuclideanDistance, EmptyStatistic, arma::fmat> FloatKDTree;
+  typedef BallTree<EuclideanDistance, EmptyStatistic, arma::fmat>
+      FloatBallTree;
+  typedef VPTree<EuclideanDistance, EmptyStatistic, arma::fmat> FloatVPTree;
+
+  BOOST_REQUIRE((std::is_same<typename std::remove_reference<decltype(
+      std::declval<FloatKDTree>().Bound())>::type,
+      HRectBound<EuclideanDistance, float>>::value));
+  BOOST_REQUIRE((std::is_same<typename std::remove_reference<decltype(
+      std::declval<FloatBallTree>().Bound())>::type,
+      BallBound<EuclideanDistance, float>>::value));
+  BOOST_REQUIRE((std::is_same<typename std::remove_reference<decltype(
+      std::declval<FloatVPTree>().Bound())>::type,
+      HollowBallBound<EuclideanDistance, float>>::value));
+
+  FloatKDTree kdTree(dataset);
+  BOOST_REQUIRE(CheckPointBounds(kdTree));
+
+  FloatBallTree ballTree(dataset);
+  BOOST_REQUIRE_EQUAL(ballTree.Bound().Center().n_elem, dataset.n_rows);
+  BOOST_REQUIRE_EQUAL(ballTree.NumDescendants(), dataset.n_cols);
+}
+
+#ifdef HAS_OPENMP
+/**
+ * Check that two binary space trees have the same structure: every node holds
+ * the same range of points as the node in the same place in the other tree.
+ */
+template<typename TreeType>
+void CheckSameStructure(const TreeType& a, const TreeType& b)
+{
+  BOOST_REQUIRE_EQUAL(a.Begin(), b.Begin());
+  BOOST_REQUIRE_EQUAL(a.Count(), b.Count());
+  BOOST_REQUIRE_EQUAL(a.NumChildren(), b.NumChildren());
+
+  for (size_t i = 0; i < a.NumChildren(); ++i)
+    CheckSameStructure(a.Child(i), b.Child(i));
+}
+
+/**
+ * Build a tree with several threads and with one thread, and make sure that
+ * the trees, the rearranged datasets, and the oldFromNew mappings are the
+ * same.  The dataset is big enough that the split of the root is also done in
+ * parallel.
+ */
+template<typename TreeType>
+void ParallelBuildTest()
+{
+  arma::mat dataset = arma::randu<arma::mat>(3, 40000);
+
+  const size_t prevNumThreads = omp_get_max_threads();
+  omp_set_num_threads(std::max(prevNumThreads, (size_t) 4));
+
+  std::vector<size_t> parallelOldFromNew;
+  TreeType parallelTree(dataset, parallelOldFromNew);
+
+  omp_set_num_threads(1);
+
+  std::vector<size_t> oldFromNew;
+  TreeType tree(dataset, oldFromNew);
+
+  omp_set_num_threads(prevNumThreads);
+
+  BOOST_REQUIRE(oldFromNew == parallelOldFromNew);
+  BOOST_REQUIRE_EQUAL(arma::accu(tree.Dataset() != parallelTree.Dataset()), 0);
+  CheckSameStructure(tree, parallelTree);
+}
+
+/**
+ * Make sure a kd-tree built in parallel is the same as one built serially.
+ */
+BOOST_AUTO_TEST_CASE(ParallelKDTreeBuildTest)
+{
+  ParallelBuildTest<KDTree<EuclideanDistance, EmptyStatistic, arma::mat>>();
+}
+
+/**
+ * Make sure a mean-split kd-tree built in parallel is the same as one built
+ * serially.
+ */
+BOOST_AUTO_TEST_CASE(ParallelMeanSplitKDTreeBuildTest)
+{
+  ParallelBuildTest<MeanSplitKDTree<EuclideanDistance, EmptyStatistic,
+      arma::mat>>();
+}
+
+/**
+ * Make sure a ball tree built in parallel is the same as one built serially.
+ */
+BOOST_AUTO_TEST_CASE(ParallelBallTreeBuildTest)
+{
+  ParallelBuildTest<BallTree<EuclideanDistance, EmptyStatistic, arma::mat>>();
+}
+
+/**
+ * Check that two cover trees have the same structure.
+ */
+template<typename TreeType>
+void CheckSameCoverTree(const TreeType& a, const TreeType& b)
+{
+  BOOST_REQUIRE_EQUAL(a.Point(), b.Point());
+  BOOST_REQUIRE_EQUAL(a.Scale(), b.Scale());
+  BOOST_REQUIRE_EQUAL(a.NumDescendants(), b.NumDescendants());
+  BOOST_REQUIRE_EQUAL(a.NumChildren(), b.NumChildren());
+  BOOST_REQUIRE_CLOSE(a.FurthestDescendantDistance(),
+      b.FurthestDescendantDistance(), 1e-5);
+
+  for (size_t i = 0; i < a.NumChildren(); ++i)
+    CheckSameCoverTree(a.Child(i), b.Child(i));
+}
+
+/**
+ * Make sure that a cover tree whose distances are computed in parallel is the
+ * same as one built with one thread.
+ */
+BOOST_AUTO_TEST_CASE(ParallelCoverTreeBuildTest)
+{
+  typedef StandardCoverTree<EuclideanDistance, EmptyStatistic, arma::mat>
+      TreeType;
+  arma::mat dataset = arma::randu<arma::mat>(10, 10000);
+
+  const size_t prevNumThreads = omp_get_max_threads();
+  omp_set_num_threads(std::max(prevNumThreads, (size_t) 4));
+
+  TreeType parallelTree(dataset);
+
+  omp_set_num_threads(1);
+
+  TreeType tree(dataset);
+
+  omp_set_num_threads(prevNumThreads);
+
+  CheckSameCoverTree(tree, parallelTree);
+}
+#endif
+
 BOOST_AUTO_TEST_SUITE_END();
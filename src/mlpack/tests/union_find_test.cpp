@@ -51,4 +51,40 @@ BOOST_AUTO_TEST_CASE(TestUnion)
   BOOST_REQUIRE(testUnionFind.Find(6) == testUnionFind.Find(3));
 }
 
+#ifdef HAS_OPENMP
+
+/**
+ * Make sure that unions and finds from several threads at once give the same
+ * components as the same unions made by one thread.
+ */
+BOOST_AUTO_TEST_CASE(TestConcurrentUnion)
+{
+  static const size_t testSize = 10000;
+  UnionFind serial(testSize), parallel(testSize);
+
+  arma::Mat<size_t> pairs = arma::randi<arma::Mat<size_t>>(2, 8000,
+      arma::distr_param(0, (int) testSize - 1));
+
+  for (size_t i = 0; i < pairs.n_cols; ++i)
+    serial.Union(pairs(0, i), pairs(1, i));
+
+  #pragma omp parallel for num_threads(4)
+  for (intmax_t i = 0; i < (intmax_t) pairs.n_cols; ++i)
+  {
+    parallel.Union(pairs(0, i), pairs(1, i));
+    parallel.Find(pairs(1, i));
+  }
+
+  for (size_t i = 0; i < testSize; ++i)
+  {
+    const size_t other = (7 * i) % testSize;
+    BOOST_REQUIRE_EQUAL(serial.Find(i) == serial.Find(other),
+        parallel.Find(i) == parallel.Find(other));
+    BOOST_REQUIRE_EQUAL(serial.Find(i) == serial.Find(pairs(0, i % 8000)),
+        parallel.Find(i) == parallel.Find(pairs(0, i % 8000)));
+  }
+}
+
+#endif
+
 BOOST_AUTO_TEST_SUITE_END();